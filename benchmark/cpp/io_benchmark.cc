@@ -0,0 +1,434 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file io_benchmark.cc
+ * \brief throughput of the data iterators on synthetic data
+ *
+ *  io_benchmark generate dir=DIR [num_images=N] [image_size=S] [num_features=F]
+ *    writes synthetic JPEG RecordIO files for classification and detection, with their index
+ *    files, and CSV and LibSVM files of as many rows to DIR
+ *  io_benchmark run iter=NAME dir=DIR [threads=T] [batch_size=B] [epochs=E] [warmup=W]
+ *    reads the files of DIR with the iterator NAME using T threads, and prints its samples/sec,
+ *    the latency of its batches, the CPU cores it kept busy and the latency of each stage of
+ *    the pipeline run alone on one thread, as one line of JSON
+ *
+ *  The iterators are ImageRecordIter, ImageRecordIter_v1, ImageDetRecordIter,
+ *  ThreadedDataLoader (over an ImageRecordFileDataset), CSVIter and LibSVMIter.
+ * \sa benchmark/python/io/benchmark_io.py
+ */
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+#include <dmlc/recordio.h>
+#include <dmlc/timer.h>
+#include <mxnet/c_api.h>
+#include <opencv2/opencv.hpp>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif  // _WIN32
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../../src/io/image_recordio.h"
+
+#define CHECK_MX(call) CHECK_EQ((call), 0) << MXGetLastError()
+
+namespace {
+
+using Args = std::map<std::string, std::string>;
+
+/*! \brief number of objects of each image in the detection records */
+constexpr int kNumObjects = 4;
+/*! \brief width of the detection labels: a header of 2, then 5 values per object */
+constexpr int kDetLabelWidth = 2 + 5 * kNumObjects;
+
+std::string GetArg(const Args& args, const std::string& key, const std::string& default_value) {
+  auto it = args.find(key);
+  return it == args.end() ? default_value : it->second;
+}
+
+int GetIntArg(const Args& args, const std::string& key, int default_value) {
+  return std::atoi(GetArg(args, key, std::to_string(default_value)).c_str());
+}
+
+/*! \brief user and system CPU time of the process in seconds, -1 where it is not available */
+double CPUTime() {
+#ifndef _WIN32
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         1e-6 * (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+#else
+  return -1;
+#endif  // _WIN32
+}
+
+/*! \brief a smooth random image with some edges, which JPEG compresses as it does photos */
+cv::Mat SyntheticImage(int size, std::mt19937* rng) {
+  std::uniform_int_distribution<int> color(0, 255), pos(0, size - 1);
+  cv::Mat coarse(8, 8, CV_8UC3);
+  cv::randu(coarse, cv::Scalar::all(0), cv::Scalar::all(255));
+  cv::Mat img;
+  cv::resize(coarse, img, cv::Size(size, size), 0, 0, cv::INTER_CUBIC);
+  for (int i = 0; i < 8; ++i) {
+    cv::rectangle(img,
+                  cv::Point(pos(*rng), pos(*rng)),
+                  cv::Point(pos(*rng), pos(*rng)),
+                  cv::Scalar(color(*rng), color(*rng), color(*rng)),
+                  -1);
+  }
+  cv::Mat noise(size, size, CV_8UC3);
+  cv::randn(noise, cv::Scalar::all(0), cv::Scalar::all(8));
+  return img + noise;
+}
+
+/*! \brief write the records and the index file of the images, labelled by label_fn */
+template <typename LabelFn>
+void WriteImageRecords(const std::string& prefix,
+                       const std::vector<std::vector<unsigned char>>& images,
+                       const LabelFn& label_fn) {
+  std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create((prefix + ".rec").c_str(), "w"));
+  std::ofstream idx(prefix + ".idx");
+  dmlc::RecordIOWriter writer(fo.get());
+  std::string blob;
+  for (size_t i = 0; i < images.size(); ++i) {
+    std::vector<float> label = label_fn(i);
+    mxnet::io::ImageRecordIO rec;
+    rec.header.image_id[0] = i;
+    rec.header.label       = label[0];
+    rec.header.flag        = label.size() > 1 ? static_cast<uint32_t>(label.size()) : 0;
+    rec.SaveHeader(&blob);
+    if (rec.header.flag > 0) {
+      blob.append(reinterpret_cast<const char*>(label.data()), label.size() * sizeof(float));
+    }
+    blob.append(reinterpret_cast<const char*>(images[i].data()), images[i].size());
+    idx << i << '\t' << writer.Tell() << '\n';
+    writer.WriteRecord(blob.data(), blob.size());
+  }
+}
+
+void Generate(const Args& args) {
+  const std::string dir  = GetArg(args, "dir", ".");
+  const int num_images   = GetIntArg(args, "num_images", 2048);
+  const int image_size   = GetIntArg(args, "image_size", 256);
+  const int num_features = GetIntArg(args, "num_features", 512);
+  const int quality      = GetIntArg(args, "quality", 90);
+  std::mt19937 rng(GetIntArg(args, "seed", 0));
+  std::vector<std::vector<unsigned char>> images(num_images);
+  const std::vector<int> encode_params{cv::IMWRITE_JPEG_QUALITY, quality};
+  for (auto& image : images) {
+    CHECK(cv::imencode(".jpg", SyntheticImage(image_size, &rng), image, encode_params));
+  }
+  WriteImageRecords(dir + "/images", images, [](size_t i) {
+    return std::vector<float>{static_cast<float>(i % 1000)};
+  });
+  std::uniform_real_distribution<float> coord(0.0f, 0.5f);
+  WriteImageRecords(dir + "/det", images, [&](size_t i) {
+    std::vector<float> label{2, 5};
+    for (int k = 0; k < kNumObjects; ++k) {
+      const float xmin = coord(rng), ymin = coord(rng);
+      label.insert(label.end(),
+                   {static_cast<float>((i + k) % 20), xmin, ymin, xmin + 0.5f, ymin + 0.5f});
+    }
+    return label;
+  });
+  // dense rows for CSVIter, sparse ones with a tenth of the features set for LibSVMIter
+  std::ofstream csv(dir + "/data.csv"), csv_label(dir + "/label.csv"), libsvm(dir + "/data.libsvm");
+  std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+  std::bernoulli_distribution nonzero(0.1);
+  for (int i = 0; i < num_images; ++i) {
+    csv_label << i % 10 << '\n';
+    libsvm << i % 10;
+    for (int j = 0; j < num_features; ++j) {
+      const float v = value(rng);
+      csv << (j ? "," : "") << v;
+      if (j > 0 && nonzero(rng))
+        libsvm << ' ' << j << ':' << v;
+    }
+    csv << '\n';
+    libsvm << '\n';
+  }
+  LOG(INFO) << "Wrote " << num_images << " samples to " << dir;
+}
+
+/*! \brief mean, median and 99th percentile in milliseconds of latencies in seconds */
+std::string LatencyJSON(std::vector<double> latencies) {
+  std::ostringstream os;
+  if (latencies.empty()) {
+    os << "null";
+    return os.str();
+  }
+  std::sort(latencies.begin(), latencies.end());
+  double sum = 0;
+  for (double l : latencies)
+    sum += l;
+  const size_t p99 = std::min(latencies.size() - 1, latencies.size() * 99 / 100);
+  os << "{\"mean_ms\": " << 1e3 * sum / latencies.size()
+     << ", \"p50_ms\": " << 1e3 * latencies[latencies.size() / 2]
+     << ", \"p99_ms\": " << 1e3 * latencies[p99] << "}";
+  return os.str();
+}
+
+/*!
+ * \brief latency of each stage of the image pipelines on one thread: reading a record,
+ *  decoding its JPEG, and the default augmentation of a random crop and mirror
+ */
+std::string ImageStagesJSON(const std::string& rec_file, int crop_size, int max_records) {
+  std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(rec_file.c_str(), "r"));
+  dmlc::RecordIOReader reader(fi.get());
+  std::mt19937 rng(0);
+  std::vector<double> read, decode, augment;
+  std::string record;
+  for (int i = 0; i < max_records; ++i) {
+    double start = dmlc::GetTime();
+    if (!reader.NextRecord(&record))
+      break;
+    read.push_back(dmlc::GetTime() - start);
+    mxnet::io::ImageRecordIO rec;
+    rec.Load(&record[0], record.size());
+    start = dmlc::GetTime();
+    cv::Mat img = cv::imdecode(cv::Mat(1, static_cast<int>(rec.content_size), CV_8U, rec.content),
+                               cv::IMREAD_COLOR);
+    decode.push_back(dmlc::GetTime() - start);
+    CHECK(img.data != nullptr) << "Failed to decode a record of " << rec_file;
+    start = dmlc::GetTime();
+    std::uniform_int_distribution<int> x(0, std::max(img.cols - crop_size, 0));
+    std::uniform_int_distribution<int> y(0, std::max(img.rows - crop_size, 0));
+    cv::Mat crop = img(cv::Rect(x(rng),
+                                y(rng),
+                                std::min(crop_size, img.cols),
+                                std::min(crop_size, img.rows)));
+    cv::Mat res;
+    if (rng() % 2)
+      cv::flip(crop, res, 1);
+    else
+      res = crop.clone();
+    augment.push_back(dmlc::GetTime() - start);
+  }
+  return "{\"read\": " + LatencyJSON(read) + ", \"decode\": " + LatencyJSON(decode) +
+         ", \"augment\": " + LatencyJSON(augment) + "}";
+}
+
+/*! \brief latency of reading the text files in chunks of 1MB */
+std::string TextStagesJSON(const std::string& file) {
+  std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(file.c_str(), "r"));
+  std::vector<char> buf(1 << 20);
+  std::vector<double> read;
+  while (true) {
+    const double start = dmlc::GetTime();
+    const size_t nread = fi->Read(buf.data(), buf.size());
+    if (nread == 0)
+      break;
+    read.push_back(dmlc::GetTime() - start);
+  }
+  return "{\"read\": " + LatencyJSON(read) + "}";
+}
+
+/*! \brief the creator named name, listed by list and described by info */
+void* FindCreator(int (*list)(uint32_t*, void***),
+                  int (*info)(void*,
+                              const char**,
+                              const char**,
+                              uint32_t*,
+                              const char***,
+                              const char***,
+                              const char***),
+                  const std::string& name) {
+  uint32_t size;
+  void** creators;
+  CHECK_MX(list(&size, &creators));
+  for (uint32_t i = 0; i < size; ++i) {
+    const char *creator_name, *description, **arg_names, **arg_types, **arg_descs;
+    uint32_t num_args;
+    CHECK_MX(info(
+        creators[i], &creator_name, &description, &num_args, &arg_names, &arg_types, &arg_descs));
+    if (name == creator_name)
+      return creators[i];
+  }
+  LOG(FATAL) << name << " is not registered";
+  return nullptr;
+}
+
+void* Create(int (*create)(void*, uint32_t, const char**, const char**, void**),
+             void* creator,
+             const Args& params) {
+  std::vector<const char*> keys, vals;
+  for (const auto& p : params) {
+    keys.push_back(p.first.c_str());
+    vals.push_back(p.second.c_str());
+  }
+  void* out;
+  CHECK_MX(create(creator, keys.size(), keys.data(), vals.data(), &out));
+  return out;
+}
+
+void Run(const Args& args) {
+  const std::string iter = GetArg(args, "iter", "ImageRecordIter");
+  const std::string dir  = GetArg(args, "dir", ".");
+  const int threads      = GetIntArg(args, "threads", 1);
+  const int batch_size   = GetIntArg(args, "batch_size", 64);
+  const int epochs       = GetIntArg(args, "epochs", 2);
+  const int warmup       = GetIntArg(args, "warmup", 4);
+  const int num_features = GetIntArg(args, "num_features", 512);
+  const int crop_size    = GetIntArg(args, "crop_size", 224);
+
+  const std::string data_shape = "(3," + std::to_string(crop_size) + "," +
+                                 std::to_string(crop_size) + ")";
+  Args params{{"batch_size", std::to_string(batch_size)}};
+  std::string stages;
+  DatasetHandle dataset                    = nullptr;
+  DataIterHandle sampler                   = nullptr;
+  BatchifyFunctionHandle batchify_function = nullptr;
+  if (iter == "ImageRecordIter" || iter == "ImageRecordIter_v1") {
+    params.insert({{"path_imgrec", dir + "/images.rec"},
+                   {"data_shape", data_shape},
+                   {"preprocess_threads", std::to_string(threads)},
+                   {"rand_crop", "1"},
+                   {"rand_mirror", "1"},
+                   {"verbose", "0"}});
+    stages = ImageStagesJSON(dir + "/images.rec", crop_size, 256);
+  } else if (iter == "ImageDetRecordIter") {
+    params.insert({{"path_imgrec", dir + "/det.rec"},
+                   {"data_shape", data_shape},
+                   {"preprocess_threads", std::to_string(threads)},
+                   {"label_pad_width", std::to_string(kDetLabelWidth)},
+                   {"rand_mirror_prob", "0.5"},
+                   {"verbose", "0"}});
+    stages = ImageStagesJSON(dir + "/det.rec", crop_size, 256);
+  } else if (iter == "ThreadedDataLoader") {
+    dataset = Create(MXDatasetCreateDataset,
+                     FindCreator(MXListDatasets, MXDatasetGetDatasetInfo, "ImageRecordFileDataset"),
+                     {{"rec_file", dir + "/images.rec"}, {"idx_file", dir + "/images.idx"}});
+    uint64_t length;
+    CHECK_MX(MXDatasetGetLen(dataset, &length));
+    sampler = Create(MXDataIterCreateIter,
+                     FindCreator(MXListDataIters, MXDataIterGetIterInfo, "SequentialSampler"),
+                     {{"length", std::to_string(length)},
+                      {"batch_size", std::to_string(batch_size)},
+                      {"last_batch", "keep"}});
+    batchify_function = Create(
+        MXBatchifyFunctionCreateFunction,
+        FindCreator(MXListBatchifyFunctions, MXBatchifyFunctionGetFunctionInfo, "StackBatchify"),
+        {});
+    params = {{"num_workers", std::to_string(threads)},
+              {"dataset", std::to_string(reinterpret_cast<intptr_t>(dataset))},
+              {"sampler", std::to_string(reinterpret_cast<intptr_t>(sampler))},
+              {"batchify_fn", std::to_string(reinterpret_cast<intptr_t>(batchify_function))}};
+    stages = ImageStagesJSON(dir + "/images.rec", crop_size, 256);
+  } else if (iter == "CSVIter") {
+    params.insert({{"data_csv", dir + "/data.csv"},
+                   {"label_csv", dir + "/label.csv"},
+                   {"data_shape", "(" + std::to_string(num_features) + ",)"},
+                   {"preprocess_threads", std::to_string(threads)}});
+    stages = TextStagesJSON(dir + "/data.csv");
+  } else if (iter == "LibSVMIter") {
+    params.insert({{"data_libsvm", dir + "/data.libsvm"},
+                   {"data_shape", "(" + std::to_string(num_features) + ",)"},
+                   {"preprocess_threads", std::to_string(threads)}});
+    stages = TextStagesJSON(dir + "/data.libsvm");
+  } else {
+    LOG(FATAL) << "Unknown iterator " << iter;
+  }
+  DataIterHandle handle = Create(
+      MXDataIterCreateIter, FindCreator(MXListDataIters, MXDataIterGetIterInfo, iter), params);
+
+  // the first batches, which wait for the threads to start and the buffers to fill, are not
+  // measured
+  std::vector<double> latencies;
+  size_t samples = 0;
+  int batches    = 0;
+  double start = 0, cpu_start = 0;
+  for (int epoch = 0; epoch < epochs; ++epoch) {
+    CHECK_MX(MXDataIterBeforeFirst(handle));
+    while (true) {
+      if (batches == warmup) {
+        start     = dmlc::GetTime();
+        cpu_start = CPUTime();
+      }
+      const double batch_start = dmlc::GetTime();
+      int next;
+      CHECK_MX(MXDataIterNext(handle, &next));
+      if (!next)
+        break;
+      NDArrayHandle data;
+      CHECK_MX(MXDataIterGetData(handle, &data));
+      CHECK_MX(MXNDArrayWaitToRead(data));
+      int ndim;
+      const int* shape;
+      CHECK_MX(MXNDArrayGetShape(data, &ndim, &shape));
+      int pad;
+      CHECK_MX(MXDataIterGetPadNum(handle, &pad));
+      CHECK_MX(MXNDArrayFree(data));
+      if (batches++ >= warmup) {
+        latencies.push_back(dmlc::GetTime() - batch_start);
+        samples += shape[0] - pad;
+      }
+    }
+  }
+  const double elapsed = dmlc::GetTime() - start;
+  const double cpu     = cpu_start >= 0 ? CPUTime() - cpu_start : -1;
+  CHECK_GT(samples, 0U) << "No batch measured, increase epochs or decrease warmup";
+  CHECK_MX(MXDataIterFree(handle));
+  if (dataset != nullptr) {
+    CHECK_MX(MXDataIterFree(sampler));
+    CHECK_MX(MXDatasetFree(dataset));
+    CHECK_MX(MXBatchifyFunctionFree(batchify_function));
+  }
+  std::cout << "{\"iter\": \"" << iter << "\", \"threads\": " << threads
+            << ", \"batch_size\": " << batch_size << ", \"samples\": " << samples
+            << ", \"seconds\": " << elapsed << ", \"samples_per_sec\": " << samples / elapsed
+            << ", \"cpu_cores\": " << (cpu >= 0 ? cpu / elapsed : -1)
+            << ", \"batch_latency\": " << LatencyJSON(latencies) << ", \"stages\": " << stages
+            << "}" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 2 || (strcmp(argv[1], "generate") && strcmp(argv[1], "run"))) {
+    LOG(INFO) << "Usage:\n"
+              << "  io_benchmark generate dir=DIR [num_images=2048] [image_size=256]"
+              << " [num_features=512] [quality=90] [seed=0]\n"
+              << "  io_benchmark run iter=NAME dir=DIR [threads=1] [batch_size=64] [epochs=2]"
+              << " [warmup=4] [num_features=512] [crop_size=224]\n"
+              << "NAME is ImageRecordIter, ImageRecordIter_v1, ImageDetRecordIter,"
+              << " ThreadedDataLoader, CSVIter or LibSVMIter";
+    return 0;
+  }
+  Args args;
+  for (int i = 2; i < argc; ++i) {
+    const char* eq = strchr(argv[i], '=');
+    CHECK(eq != nullptr) << "Arguments are key=value, got " << argv[i];
+    args[std::string(argv[i], eq - argv[i])] = eq + 1;
+  }
+  if (!strcmp(argv[1], "generate"))
+    Generate(args);
+  else
+    Run(args);
+  return 0;
+}
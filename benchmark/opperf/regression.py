@@ -0,0 +1,237 @@
+#!/usr/bin/env python3
+#
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+#
+# -*- coding: utf-8 -*-
+
+"""Commandline utility to run the performance regression suite.
+
+Runs the pinned operator and model matrix of rules/regression_matrix.py, writes the
+results as JSON and, given a baseline written by an earlier run, reports the benchmarks
+that got slower than the threshold. The exit status is 1 when there is a regression, so
+that the suite can gate a CI job.
+"""
+
+import argparse
+import json
+import logging
+import sys
+
+import mxnet as mx
+from mxnet import gluon, np, npx, profiler
+from mxnet.gluon import nn
+
+from benchmark.opperf.rules.regression_matrix import REGRESSION_OPS, REGRESSION_MODELS
+from benchmark.opperf.utils.ndarray_utils import get_mx_ndarray, nd_forward_and_profile, \
+    nd_forward_backward_and_profile
+from benchmark.opperf.utils.regression_utils import summarize, measure, compare_to_baseline, \
+    load_baseline, save_results
+
+
+def _benchmark_name(entry):
+    shapes = ",".join(f"{key}={'x'.join(map(str, value))}" for key, value in entry["inputs"].items()
+                      if isinstance(value, tuple) and key not in ("kernel", "pad", "stride"))
+    return f"op/{entry['op']}/{shapes}/{'fwd_bwd' if entry['backward'] else 'fwd'}"
+
+
+def run_op_benchmarks(ctx, dtype, warmup, runs, max_deviations):
+    """Time every operator of the matrix, one sample per call."""
+    results = {}
+    for entry in REGRESSION_OPS:
+        mx.random.seed(41)
+        op = getattr(mx.nd, entry["op"])
+        kwargs = {}
+        for key, value in entry["inputs"].items():
+            if isinstance(value, tuple) and key not in ("kernel", "pad", "stride"):
+                kwargs[key] = get_mx_ndarray(ctx=ctx, in_tensor=value, dtype=dtype,
+                                             initializer=mx.nd.normal,
+                                             attach_grad=entry["backward"])
+            else:
+                kwargs[key] = value
+        helper = nd_forward_backward_and_profile if entry["backward"] else nd_forward_and_profile
+        name = _benchmark_name(entry)
+        logging.info(f"Begin Benchmark - {name}")
+        samples = measure(lambda: helper(op, 1, **kwargs), warmup, runs)
+        results[name] = summarize(samples, max_deviations)
+    return results
+
+
+@mx.util.use_np
+class _BertLayer(gluon.HybridBlock):
+    """Post-norm transformer encoder layer of BERT."""
+    def __init__(self, units, hidden_size, num_heads, **kwargs):
+        super(_BertLayer, self).__init__(**kwargs)
+        self._num_heads = num_heads
+        self.qkv = nn.Dense(3 * units, flatten=False, in_units=units)
+        self.proj = nn.Dense(units, flatten=False, in_units=units)
+        self.ln_attn = nn.LayerNorm(in_channels=units)
+        self.ffn_1 = nn.Dense(hidden_size, flatten=False, activation='relu', in_units=units)
+        self.ffn_2 = nn.Dense(units, flatten=False, in_units=hidden_size)
+        self.ln_ffn = nn.LayerNorm(in_channels=units)
+
+    def forward(self, x):
+        # x is (seq_length, batch_size, units), the layout of the interleaved attention ops
+        qkv = self.qkv(x)
+        scores = npx.interleaved_matmul_selfatt_qk(qkv, heads=self._num_heads)
+        attn = npx.softmax(scores, axis=-1)
+        context = npx.interleaved_matmul_selfatt_valatt(qkv, attn, heads=self._num_heads)
+        x = self.ln_attn(x + self.proj(context))
+        return self.ln_ffn(x + self.ffn_2(self.ffn_1(x)))
+
+
+@mx.util.use_np
+class _BertEncoder(gluon.HybridBlock):
+    """Encoder of BERT base: 12 layers, 768 units, 12 heads, without the embeddings."""
+    def __init__(self, num_layers=12, units=768, hidden_size=3072, num_heads=12, **kwargs):
+        super(_BertEncoder, self).__init__(**kwargs)
+        self.layers = nn.HybridSequential()
+        for _ in range(num_layers):
+            self.layers.add(_BertLayer(units, hidden_size, num_heads))
+
+    def forward(self, x):
+        return self.layers(x)
+
+
+def _get_model(name, config, ctx):
+    if name == "bert_base":
+        net = _BertEncoder()
+        data = np.random.normal(size=(config["seq_length"], config["batch_size"], 768), ctx=ctx)
+    else:
+        net = gluon.model_zoo.vision.get_model(name)
+        data = np.random.normal(size=(config["batch_size"],) + config["input_shape"], ctx=ctx)
+    net.initialize(ctx=ctx)
+    net.hybridize(static_alloc=True, static_shape=True)
+    return net, data
+
+
+def _op_breakdown(step, iterations):
+    """Average time per iteration of each operator of a model, from the aggregate stats."""
+    profiler.set_config(profile_symbolic=True, profile_imperative=True, aggregate_stats=True,
+                        continuous_dump=False)
+    profiler.dumps(reset=True)
+    profiler.set_state('run')
+    for _ in range(iterations):
+        step()
+    profiler.set_state('stop')
+    stats = json.loads(profiler.dumps(format='json', reset=True))
+    breakdown = {}
+    for category, ops in stats.get("Time", {}).items():
+        if category.startswith("operator"):
+            for op, data in ops.items():
+                breakdown[op] = breakdown.get(op, 0.0) + data.get("Total", 0.0) / iterations
+    return dict(sorted(breakdown.items(), key=lambda item: -item[1]))
+
+
+def run_model_benchmarks(models, ctx, warmup, runs, train, max_deviations, breakdown_runs):
+    """Time an iteration of each hybridized model, with its per operator breakdown."""
+    results = {}
+    for name in models:
+        config = REGRESSION_MODELS[name]
+        net, data = _get_model(name, config, ctx)
+        if train:
+            data.attach_grad()
+
+        def step():
+            if train:
+                with mx.autograd.record():
+                    out = net(data)
+                out.backward()
+            else:
+                net(data)
+            mx.nd.waitall()
+
+        bench = f"model/{name}/{'train' if train else 'inference'}"
+        logging.info(f"Begin Benchmark - {bench}")
+        summary = summarize(measure(step, warmup, runs), max_deviations)
+        summary["throughput"] = config["batch_size"] * 1000.0 / summary["mean"]
+        if breakdown_runs > 0:
+            summary["breakdown"] = _op_breakdown(step, breakdown_runs)
+        results[bench] = summary
+    return results
+
+
+def print_report(report, threshold):
+    print(f"{'Benchmark':<72} {'Baseline (ms)':>14} {'Current (ms)':>14} {'Change':>8}  Status")
+    for entry in report:
+        if "change" in entry:
+            print(f"{entry['name']:<72} {entry['baseline']:>14.4f} {entry['current']:>14.4f} "
+                  f"{entry['change']:>+8.1%}  {entry['status']}")
+        else:
+            print(f"{entry['name']:<72} {'':>14} {'':>14} {'':>8}  {entry['status']}")
+    regressions = [entry for entry in report if entry["status"] == "regression"]
+    print(f"\n{len(regressions)} regression(s) above {threshold:.1%}")
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Run the MXNet performance regression suite')
+    parser.add_argument('--ctx', type=str, default='cpu',
+                        help='Context to run the benchmarks. Valid Inputs - cpu, gpu, gpu(0), ...')
+    parser.add_argument('--dtype', type=str, default='float32',
+                        help='DType of the operator inputs. By default, float32')
+    parser.add_argument('-o', '--output-file', type=str, default='./mxnet_regression_results.json',
+                        help='Name and path for the output file')
+    parser.add_argument('-b', '--baseline', type=str, default=None,
+                        help='Results of an earlier run to compare with')
+    parser.add_argument('-t', '--threshold', type=float, default=0.05,
+                        help='Relative slowdown reported as a regression. By default, 0.05')
+    parser.add_argument('-w', '--warmup', type=int, default=25,
+                        help='Number of untimed runs before the measurements')
+    parser.add_argument('-r', '--runs', type=int, default=100,
+                        help='Number of timed runs of each operator')
+    parser.add_argument('--max-deviations', type=float, default=3.5,
+                        help='Samples whose modified z-score is larger are dropped as outliers')
+    parser.add_argument('--models', type=str, default='',
+                        help='Comma separated models for end-to-end runs, among '
+                             + ', '.join(REGRESSION_MODELS) + '. By default, none')
+    parser.add_argument('--model-runs', type=int, default=20,
+                        help='Number of timed iterations of each model')
+    parser.add_argument('--train', action='store_true',
+                        help='Time a forward and backward pass of the models')
+    parser.add_argument('--breakdown-runs', type=int, default=5,
+                        help='Iterations profiled for the per operator breakdown of the models, '
+                             '0 to skip it')
+    parser.add_argument('--skip-ops', action='store_true', help='Only run the models')
+
+    args = parser.parse_args()
+    logging.info(f"Running MXNet performance regression suite with the following options: {args}")
+    ctx = mx.gpu(int(args.ctx[4:-1])) if args.ctx.startswith('gpu(') else mx.context.Context(args.ctx)
+    models = [model for model in args.models.split(',') if model]
+    for model in models:
+        if model not in REGRESSION_MODELS:
+            raise ValueError(f"Unknown model {model}, valid inputs - {list(REGRESSION_MODELS)}")
+
+    results = {}
+    if not args.skip_ops:
+        results.update(run_op_benchmarks(ctx, args.dtype, args.warmup, args.runs,
+                                         args.max_deviations))
+    if models:
+        results.update(run_model_benchmarks(models, ctx, min(args.warmup, 5), args.model_runs,
+                                            args.train, args.max_deviations,
+                                            args.breakdown_runs))
+    save_results(args.output_file, results, vars(args))
+    logging.info(f"Results written to {args.output_file}")
+
+    if args.baseline:
+        report = compare_to_baseline(results, load_baseline(args.baseline), args.threshold)
+        if print_report(report, args.threshold):
+            sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,68 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Pinned operators, shapes and models of the performance regression suite.
+
+The matrix is part of the baseline: changing an entry changes what its results mean, so
+add new entries rather than editing existing ones, and regenerate the baseline when an
+entry has to change. Tensor inputs are given by shape, everything else is passed as is.
+"""
+
+REGRESSION_OPS = [
+    # elementwise, memory bound
+    {"op": "relu", "inputs": {"data": (1024, 1024)}, "backward": True},
+    {"op": "sigmoid", "inputs": {"data": (1024, 1024)}, "backward": True},
+    {"op": "exp", "inputs": {"data": (1024, 1024)}, "backward": False},
+    {"op": "broadcast_add", "inputs": {"lhs": (1024, 1024), "rhs": (1024, 1)}, "backward": True},
+    {"op": "elemwise_mul", "inputs": {"lhs": (1024, 1024), "rhs": (1024, 1024)}, "backward": True},
+    # reductions
+    {"op": "sum", "inputs": {"data": (1024, 1024), "axis": 1}, "backward": False},
+    {"op": "softmax", "inputs": {"data": (128, 1000)}, "backward": True},
+    # gemm and convolution, compute bound
+    {"op": "dot", "inputs": {"lhs": (1024, 1024), "rhs": (1024, 1024)}, "backward": True},
+    {"op": "batch_dot", "inputs": {"lhs": (32, 128, 64), "rhs": (32, 64, 128)},
+     "backward": True},
+    {"op": "FullyConnected",
+     "inputs": {"data": (128, 1024), "weight": (1024, 1024), "bias": (1024,),
+                "num_hidden": 1024}, "backward": True},
+    {"op": "Convolution",
+     "inputs": {"data": (32, 64, 56, 56), "weight": (64, 64, 3, 3), "bias": (64,),
+                "kernel": (3, 3), "pad": (1, 1), "num_filter": 64}, "backward": True},
+    {"op": "Convolution",
+     "inputs": {"data": (32, 256, 14, 14), "weight": (256, 256, 1, 1), "bias": (256,),
+                "kernel": (1, 1), "num_filter": 256}, "backward": True},
+    # normalization and pooling
+    {"op": "BatchNorm",
+     "inputs": {"data": (32, 64, 56, 56), "gamma": (64,), "beta": (64,),
+                "moving_mean": (64,), "moving_var": (64,)}, "backward": True},
+    {"op": "LayerNorm",
+     "inputs": {"data": (128, 768), "gamma": (768,), "beta": (768,)}, "backward": True},
+    {"op": "Pooling",
+     "inputs": {"data": (32, 64, 56, 56), "kernel": (3, 3), "stride": (2, 2),
+                "pool_type": "max"}, "backward": True},
+    # data movement
+    {"op": "transpose", "inputs": {"data": (1024, 1024)}, "backward": False},
+    {"op": "concat", "inputs": {"args0": (512, 1024), "args1": (512, 1024), "dim": 0},
+     "backward": False},
+    {"op": "take", "inputs": {"a": (10000, 256), "indices": (1024,)}, "backward": False},
+]
+
+# end-to-end throughput of hybridized models, per iteration of batch_size samples
+REGRESSION_MODELS = {
+    "resnet50_v1": {"batch_size": 32, "input_shape": (3, 224, 224)},
+    "bert_base": {"batch_size": 8, "seq_length": 128},
+}
@@ -0,0 +1,176 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Statistics and baseline comparison for the operator performance regression suite."""
+
+import json
+import math
+import platform
+import time
+
+import mxnet as mx
+
+# two sided 95% quantiles of the Student t distribution by degrees of freedom,
+# the normal quantile is used from 30 on
+_T_95 = [12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+         2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+         2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045]
+
+
+def _median(values):
+    values = sorted(values)
+    n = len(values)
+    mid = n // 2
+    return values[mid] if n % 2 else (values[mid - 1] + values[mid]) / 2.0
+
+
+def reject_outliers(samples, max_deviations=3.5):
+    """Drop the samples far from the median.
+
+    Uses the modified z-score of Iglewicz and Hoaglin, based on the median absolute
+    deviation, so that the outliers themselves do not widen the acceptance band.
+
+    Parameters
+    ----------
+    samples: [float]
+        Measured times.
+    max_deviations: float, default 3.5
+        Samples with a larger modified z-score are dropped.
+
+    Returns
+    -------
+    The samples kept, in their original order, and the number of samples dropped.
+    """
+    if len(samples) < 3:
+        return list(samples), 0
+    median = _median(samples)
+    mad = _median([abs(s - median) for s in samples])
+    if mad == 0:
+        return list(samples), 0
+    kept = [s for s in samples if 0.6745 * abs(s - median) / mad <= max_deviations]
+    return kept, len(samples) - len(kept)
+
+
+def summarize(samples, max_deviations=3.5):
+    """Summary statistics of the samples once the outliers are dropped.
+
+    Returns
+    -------
+    map with the mean, median, standard deviation, min and max of the samples kept, the
+    bounds of the 95% confidence interval of the mean and the number of samples kept and
+    dropped.
+    """
+    kept, dropped = reject_outliers(samples, max_deviations)
+    n = len(kept)
+    if n == 0:
+        raise ValueError("No samples to summarize")
+    mean = sum(kept) / n
+    stdev = math.sqrt(sum((s - mean) ** 2 for s in kept) / (n - 1)) if n > 1 else 0.0
+    t = _T_95[n - 2] if 1 < n <= len(_T_95) + 1 else 1.96
+    half_width = t * stdev / math.sqrt(n)
+    return {"mean": mean,
+            "median": _median(kept),
+            "stdev": stdev,
+            "min": min(kept),
+            "max": max(kept),
+            "ci_low": mean - half_width,
+            "ci_high": mean + half_width,
+            "samples": n,
+            "outliers": dropped}
+
+
+def measure(func, warmup, runs):
+    """Time func, that must block until its work is done, after warmup untimed calls.
+
+    Returns
+    -------
+    list of the times of the runs calls in ms.
+    """
+    for _ in range(warmup):
+        func()
+    samples = []
+    for _ in range(runs):
+        start = time.perf_counter()
+        func()
+        samples.append((time.perf_counter() - start) * 1000)
+    return samples
+
+
+def environment():
+    """What the results were measured on, stored with them to tell apart baselines."""
+    features = mx.runtime.Features()
+    return {"mxnet": mx.__version__,
+            "python": platform.python_version(),
+            "machine": platform.machine(),
+            "processor": platform.processor(),
+            "features": sorted(name for name in features.keys() if features.is_enabled(name))}
+
+
+def compare_to_baseline(results, baseline, threshold):
+    """Compare the benchmark results against a baseline.
+
+    A benchmark regresses when its mean is more than threshold slower than the baseline
+    and the two 95% confidence intervals do not overlap, so that a noisy benchmark is not
+    reported for a slowdown it cannot resolve. Lower is better for every metric, throughput
+    is stored as time per sample.
+
+    Parameters
+    ----------
+    results: map
+        benchmark name -> summary, as returned by summarize.
+    baseline: map
+        benchmark name -> summary of the baseline run.
+    threshold: float
+        allowed relative slowdown, 0.05 for 5%.
+
+    Returns
+    -------
+    list of the comparison of each benchmark, with its status among regression,
+    improvement, unchanged, new (not in the baseline) and missing (only in the baseline).
+    """
+    report = []
+    for name in sorted(set(results) | set(baseline)):
+        current, base = results.get(name), baseline.get(name)
+        entry = {"name": name}
+        if base is None:
+            entry["status"] = "new"
+        elif current is None:
+            entry["status"] = "missing"
+        else:
+            change = current["mean"] / base["mean"] - 1 if base["mean"] > 0 else 0.0
+            entry.update({"baseline": base["mean"], "current": current["mean"], "change": change})
+            if change > threshold and current["ci_low"] > base["ci_high"]:
+                entry["status"] = "regression"
+            elif change < -threshold and current["ci_high"] < base["ci_low"]:
+                entry["status"] = "improvement"
+            else:
+                entry["status"] = "unchanged"
+        report.append(entry)
+    return report
+
+
+def load_baseline(filename):
+    """The benchmark summaries of a results file written by the regression suite."""
+    with open(filename) as f:
+        return json.load(f)["results"]
+
+
+def save_results(filename, results, config):
+    """Write the benchmark summaries with the environment and settings of the run."""
+    with open(filename, 'w') as f:
+        json.dump({"environment": environment(), "config": config, "results": results},
+                  f, indent=2, sort_keys=True)
@@ -81,7 +81,44 @@ def test_np_einsum():
     cost = measure_cost(50, np.einsum, *args)
     print(f'Basic einsum: {cost * 1000} ms')
 
+    print('Batched Matrix Product:')
+    a = np.ones(2097152).reshape(32, 256, 256)
+    b = np.ones(2097152).reshape(32, 256, 256)
+    args = ['bij, bjk->bik', a, b]
+    cost = measure_cost(50, np.matmul, a, b)
+    print(f'Matmul: {cost * 1000} ms')
+    greedy = measure_cost(50, np.einsum, *args, optimize=True)
+    print(f'Greedy einsum: {greedy * 1000} ms')
+    basic = measure_cost(5, np.einsum, *args)
+    print(f'Basic einsum: {basic * 1000} ms')
+    print(f'Speedup: {basic / greedy}x')
+
+    print('Batched Contraction with Transposes:')
+    a = np.random.uniform(0, 1, size=(16, 64, 8, 32))
+    b = np.random.uniform(0, 1, size=(16, 8, 64, 32))
+    args = ['bqhd, bhkd->bhqk', a, b]
+    greedy = measure_cost(50, np.einsum, *args, optimize=True)
+    print(f'Greedy einsum: {greedy * 1000} ms')
+    basic = measure_cost(5, np.einsum, *args)
+    print(f'Basic einsum: {basic * 1000} ms')
+    print(f'Speedup: {basic / greedy}x')
+
+
+def test_np_einsum_repeated():
+    print('Repeated small contractions:')
+    # the path of a contraction seen before is not searched again
+    a = np.ones((8, 4, 16))
+    b = np.ones((8, 16, 4))
+    c = np.ones((8, 4, 4))
+    args = ['bij, bjk, bkl->bil', a, b, c]
+    greedy = measure_cost(1000, np.einsum, *args, optimize=True)
+    print(f'Greedy einsum: {greedy * 1000} ms')
+    basic = measure_cost(1000, np.einsum, *args)
+    print(f'Basic einsum: {basic * 1000} ms')
+    print(f'Speedup: {basic / greedy}x')
+
 
 if __name__ == "__main__":
     npx.set_np(dtype=False)
     test_np_einsum()
+    test_np_einsum_repeated()
@@ -0,0 +1,84 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Benchmark the construction time of the backward graph of hybridized blocks.
+
+The first backward pass of a hybridized block builds its gradient graph, which
+dominates the first iteration of long unrolled or heavily weight-sharing models.
+The time of the first iteration is reported next to that of a steady-state one.
+
+Example::
+
+    python benchmark_gradient_graph.py --steps 100 1000 10000
+"""
+
+import argparse
+from time import time
+
+import mxnet as mx
+from mxnet import gluon
+
+
+_parser = argparse.ArgumentParser(description='Benchmark the gradient graph construction.')
+_parser.add_argument('--steps', type=int, nargs='+', default=[100, 1000, 5000],
+                     help='number of unrolled steps')
+_parser.add_argument('--hidden', type=int, default=16)
+_parser.add_argument('--memory_opt', action='store_true',
+                     help='enable backward mirroring (MXNET_MEMORY_OPT=1)')
+args = _parser.parse_args()
+
+
+class UnrolledCell(gluon.HybridBlock):
+    """A recurrent cell unrolled `steps` times, sharing one weight across all the steps."""
+    def __init__(self, steps, hidden):
+        super(UnrolledCell, self).__init__()
+        self.steps = steps
+        self.dense = gluon.nn.Dense(hidden, in_units=hidden, use_bias=False)
+
+    def forward(self, x):
+        h = x
+        for _ in range(self.steps):
+            h = mx.np.tanh(self.dense(h)) + mx.npx.sigmoid(h)
+        return h.sum()
+
+
+def _iteration(net, x):
+    tick = time()
+    with mx.autograd.record():
+        loss = net(x)
+    loss.backward()
+    mx.npx.waitall()
+    return (time() - tick) * 1000.0
+
+
+def main():
+    mx.npx.set_np()
+    if args.memory_opt:
+        mx.util.setenv('MXNET_MEMORY_OPT', '1')
+    for steps in args.steps:
+        net = UnrolledCell(steps, args.hidden)
+        net.initialize()
+        net.hybridize()
+        x = mx.np.random.uniform(size=(4, args.hidden))
+        first = _iteration(net, x)
+        steady = min(_iteration(net, x) for _ in range(3))
+        print(f"steps: {steps:6d}  first iteration: {first:10.1f} ms  "
+              f"steady state: {steady:8.1f} ms  construction: {first - steady:10.1f} ms")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,182 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Throughput of the data iterators on synthetic data, across thread counts.
+
+Drives io_benchmark, built with -DBUILD_IO_BENCHMARK=ON: it generates synthetic RecordIO, CSV
+and LibSVM files once, then runs each iterator in a fresh process per thread count, and
+prints its samples/sec, the speedup and parallel efficiency over the smallest thread count,
+the latency of its batches, the CPU cores it kept busy, and the latency of the read, decode
+and augment stages run alone on one thread.
+
+Example::
+
+    python benchmark/python/io/benchmark_io.py --binary build/io_benchmark \\
+        --iters ImageRecordIter,CSVIter --threads 1,2,4,8 --output results.json --plot scaling.png
+"""
+
+import argparse
+import csv
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+ITERS = ['ImageRecordIter', 'ImageRecordIter_v1', 'ImageDetRecordIter', 'ThreadedDataLoader',
+         'CSVIter', 'LibSVMIter']
+
+
+def find_binary(path):
+    candidates = [path] if path else [os.path.join(d, 'io_benchmark')
+                                      for d in ('build', 'build/Release', '.')]
+    for candidate in candidates:
+        if os.path.isfile(candidate) and os.access(candidate, os.X_OK):
+            return candidate
+    found = shutil.which('io_benchmark')
+    if found is None:
+        sys.exit('io_benchmark not found, build it with -DBUILD_IO_BENCHMARK=ON and pass --binary')
+    return found
+
+
+def run_binary(binary, command, **kwargs):
+    args = [binary, command] + ['{}={}'.format(k, v) for k, v in kwargs.items()]
+    out = subprocess.run(args, stdout=subprocess.PIPE, check=True, universal_newlines=True)
+    return out.stdout
+
+
+def run_iter(binary, data_dir, name, threads, args):
+    out = run_binary(binary, 'run', iter=name, dir=data_dir, threads=threads,
+                     batch_size=args.batch_size, epochs=args.epochs, warmup=args.warmup,
+                     num_features=args.num_features, crop_size=args.crop_size)
+    # the result is the last line, after the logs of the iterator
+    return json.loads(out.strip().splitlines()[-1])
+
+
+def print_results(results):
+    print('{:<20}{:>8}{:>14}{:>9}{:>8}{:>12}{:>12}{:>11}'.format(
+        'Iterator', 'Threads', 'Samples/sec', 'Speedup', 'Eff.', 'Batch p50', 'Batch p99',
+        'CPU cores'))
+    print('{:-^94}'.format(''))
+    for name in sorted(set(r['iter'] for r in results), key=ITERS.index):
+        runs = sorted((r for r in results if r['iter'] == name), key=lambda r: r['threads'])
+        base = runs[0]
+        for r in runs:
+            speedup = r['samples_per_sec'] / base['samples_per_sec']
+            efficiency = speedup * base['threads'] / r['threads']
+            print('{:<20}{:>8}{:>14.1f}{:>9.2f}{:>8.0%}{:>10.2f}ms{:>10.2f}ms{:>11.2f}'.format(
+                name, r['threads'], r['samples_per_sec'], speedup, efficiency,
+                r['batch_latency']['p50_ms'], r['batch_latency']['p99_ms'], r['cpu_cores']))
+    print('\nLatency of each stage alone on one thread, per record or per 1MB of text')
+    print('{:<20}{:<10}{:>12}{:>12}{:>12}'.format('Iterator', 'Stage', 'Mean', 'p50', 'p99'))
+    print('{:-^66}'.format(''))
+    for name in sorted(set(r['iter'] for r in results), key=ITERS.index):
+        stages = next(r['stages'] for r in results if r['iter'] == name)
+        for stage, latency in stages.items():
+            if latency is None:
+                continue
+            print('{:<20}{:<10}{:>10.3f}ms{:>10.3f}ms{:>10.3f}ms'.format(
+                name, stage, latency['mean_ms'], latency['p50_ms'], latency['p99_ms']))
+
+
+def save_results(results, path):
+    if path.endswith('.csv'):
+        with open(path, 'w', newline='') as f:
+            writer = csv.writer(f)
+            writer.writerow(['iter', 'threads', 'samples_per_sec', 'cpu_cores', 'batch_mean_ms',
+                             'batch_p50_ms', 'batch_p99_ms'])
+            for r in results:
+                latency = r['batch_latency']
+                writer.writerow([r['iter'], r['threads'], r['samples_per_sec'], r['cpu_cores'],
+                                 latency['mean_ms'], latency['p50_ms'], latency['p99_ms']])
+    else:
+        with open(path, 'w') as f:
+            json.dump(results, f, indent=2)
+
+
+def plot_results(results, path):
+    try:
+        import matplotlib
+        matplotlib.use('Agg')
+        import matplotlib.pyplot as plt
+    except ImportError:
+        print('matplotlib is not installed, skipping the plot', file=sys.stderr)
+        return
+    fig, (ax_rate, ax_cpu) = plt.subplots(1, 2, figsize=(12, 5))
+    for name in sorted(set(r['iter'] for r in results), key=ITERS.index):
+        runs = sorted((r for r in results if r['iter'] == name), key=lambda r: r['threads'])
+        threads = [r['threads'] for r in runs]
+        ax_rate.plot(threads, [r['samples_per_sec'] for r in runs], marker='o', label=name)
+        ax_cpu.plot(threads, [r['cpu_cores'] for r in runs], marker='o', label=name)
+    for ax, ylabel in [(ax_rate, 'samples/sec'), (ax_cpu, 'CPU cores busy')]:
+        ax.set_xscale('log', base=2)
+        ax.set_xlabel('threads')
+        ax.set_ylabel(ylabel)
+        ax.grid(True)
+    ax_rate.legend()
+    fig.tight_layout()
+    fig.savefig(path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--binary', default=None, help='path of io_benchmark')
+    parser.add_argument('--data-dir', default=None,
+                        help='directory of the synthetic data, generated if it has none; '
+                             'a temporary directory by default')
+    parser.add_argument('--iters', default=','.join(ITERS),
+                        help='comma separated iterators, of ' + ', '.join(ITERS))
+    parser.add_argument('--threads', default='1,2,4,8', help='comma separated thread counts')
+    parser.add_argument('--num-images', type=int, default=2048)
+    parser.add_argument('--image-size', type=int, default=256)
+    parser.add_argument('--crop-size', type=int, default=224)
+    parser.add_argument('--num-features', type=int, default=512,
+                        help='features of the CSV and LibSVM rows')
+    parser.add_argument('--batch-size', type=int, default=64)
+    parser.add_argument('--epochs', type=int, default=2)
+    parser.add_argument('--warmup', type=int, default=4, help='batches not measured')
+    parser.add_argument('--output', default=None, help='save the results to a .json or .csv file')
+    parser.add_argument('--plot', default=None, help='save the scaling curves to an image')
+    args = parser.parse_args()
+
+    iters = args.iters.split(',')
+    for name in iters:
+        if name not in ITERS:
+            parser.error('unknown iterator {}'.format(name))
+    threads = [int(t) for t in args.threads.split(',')]
+    binary = find_binary(args.binary)
+    data_dir = args.data_dir or tempfile.mkdtemp(prefix='io_benchmark_')
+    try:
+        if not os.path.exists(os.path.join(data_dir, 'images.rec')):
+            os.makedirs(data_dir, exist_ok=True)
+            run_binary(binary, 'generate', dir=data_dir, num_images=args.num_images,
+                       image_size=args.image_size, num_features=args.num_features)
+        results = [run_iter(binary, data_dir, name, t, args) for name in iters for t in threads]
+    finally:
+        if args.data_dir is None:
+            shutil.rmtree(data_dir, ignore_errors=True)
+    print_results(results)
+    if args.output:
+        save_results(results, args.output)
+    if args.plot:
+        plot_results(results, args.plot)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,64 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Measures the bandwidth of the CPU reduction of the local kvstore.
+
+Every push sums one array per CPU context in CommCPU. The bandwidth counts
+the bytes read from all sources and written to the result, e.g.
+
+    MXNET_KVSTORE_REDUCTION_NTHREADS=8 python3 cpu_reduce.py --num-sources 8
+"""
+
+import argparse
+import time
+
+import mxnet as mx
+
+
+def measure(kv, key, grads, repeat):
+    kv.push(key, grads)
+    mx.nd.waitall()
+    tic = time.time()
+    for _ in range(repeat):
+        kv.push(key, grads)
+    mx.nd.waitall()
+    return (time.time() - tic) / repeat
+
+
+def main():
+    parser = argparse.ArgumentParser(description='benchmark the CPU reduction of kvstore')
+    parser.add_argument('--num-sources', type=int, default=8,
+                        help='number of arrays summed by every push')
+    parser.add_argument('--sizes', type=str, default='1000,100000,1000000,10000000',
+                        help='comma separated numbers of elements of the arrays')
+    parser.add_argument('--dtype', type=str, default='float32')
+    parser.add_argument('--repeat', type=int, default=20)
+    args = parser.parse_args()
+
+    kv = mx.kv.create('local')
+    print('%12s %12s %12s' % ('size', 'time (ms)', 'GB/s'))
+    for key, size in enumerate(int(s) for s in args.sizes.split(',')):
+        grads = [mx.nd.ones((size,), ctx=mx.cpu(i), dtype=args.dtype)
+                 for i in range(args.num_sources)]
+        kv.init(key, mx.nd.zeros((size,), dtype=args.dtype))
+        cost = measure(kv, key, grads, args.repeat)
+        nbytes = (args.num_sources + 1) * grads[0].size * grads[0].dtype.itemsize
+        print('%12d %12.3f %12.2f' % (size, cost * 1e3, nbytes / cost / 1e9))
+
+
+if __name__ == '__main__':
+    main()
@@ -24,9 +24,13 @@ import argparse
 
 from mxnet.base import check_call, _LIB
 
-parser = argparse.ArgumentParser(description="Benchmark cast storage operators",
+parser = argparse.ArgumentParser(description="Benchmark cast storage and sparse_retain operators",
                                  formatter_class=argparse.ArgumentDefaultsHelpFormatter)
 parser.add_argument('--num-omp-threads', type=int, default=1, help='number of omp threads to set in MXNet')
+parser.add_argument('--device', type=str, default='gpu', choices=['cpu', 'gpu'],
+                    help='device to benchmark')
+parser.add_argument('--benchmarks', type=str, default='dns_to_csr,dns_to_rsp,sparse_retain',
+                    help='comma separated benchmarks among dns_to_csr, dns_to_rsp and sparse_retain')
 args = parser.parse_args()
 
 def measure_cost(repeat, f, *args, **kwargs):
@@ -54,6 +58,23 @@ def run_cast_storage_synthetic():
         results = f'{density*100:10.1f} {str(ctx):>10} {m:8d} {n:8d} {cost * 1000:10.2f}'
         print(results)
 
+    def retain_rows(m, n, density, ctx, repeat, stype):
+        set_default_device(ctx)
+        rsp_data = rand_ndarray((m, n), 'row_sparse', density)
+        # retain half of the rows, the rows missing from the input included
+        indices = mx.nd.array(np.sort(np.random.choice(m, m // 2, replace=False)), dtype='int64')
+        rsp_data.wait_to_read()
+
+        # do one warm up run, verify correctness
+        expected = rsp_data.asnumpy()[indices.asnumpy()]
+        out = mx.nd.sparse.retain(rsp_data, indices)
+        assert same(out.data.asnumpy(), expected)
+
+        # start benchmarking
+        cost = measure_cost(repeat, mx.nd.sparse.retain, rsp_data, indices)
+        results = f'{density*100:10.1f} {str(ctx):>10} {m:8d} {n:8d} {cost * 1000:10.2f}'
+        print(results)
+
     check_call(_LIB.MXSetNumOMPThreads(ctypes.c_int(args.num_omp_threads)))
 
     # params
@@ -61,26 +82,30 @@ def run_cast_storage_synthetic():
     # n           number of columns
     # density     density of the matrix
     # num_repeat  number of benchmark runs to average over
-    # contexts    mx.cpu(), mx.gpu()
-    #             note: benchmark different contexts separately; to benchmark cpu, compile without CUDA
-    # benchmarks  dns_to_csr, dns_to_rsp
+    # contexts    mx.cpu() or mx.gpu(), from --device
+    # benchmarks  dns_to_csr, dns_to_rsp, sparse_retain
     m = [  512,    512]
     n = [50000, 100000]
     density = [1.00, 0.80, 0.60, 0.40, 0.20, 0.10, 0.05, 0.02, 0.01]
     num_repeat = 10
-    contexts = [mx.gpu()]
-    benchmarks = ["dns_to_csr", "dns_to_rsp"]
+    contexts = [mx.gpu() if args.device == 'gpu' else mx.cpu()]
+    benchmarks = args.benchmarks.split(',')
 
     # run benchmark
     for b in benchmarks:
         stype = ''
+        bench = dense_to_sparse
         print("==================================================")
-        if b is "dns_to_csr":
+        if b == "dns_to_csr":
             stype = 'csr'
             print(" cast_storage benchmark: dense to csr, size m x n ")
-        elif b is "dns_to_rsp":
+        elif b == "dns_to_rsp":
             stype = 'row_sparse'
             print(" cast_storage benchmark: dense to rsp, size m x n ")
+        elif b == "sparse_retain":
+            stype = 'row_sparse'
+            bench = retain_rows
+            print(" sparse_retain benchmark: half of the rows, size m x n ")
         else:
             print(f"invalid benchmark: {b}")
             continue
@@ -90,7 +115,7 @@ def run_cast_storage_synthetic():
         for i in range(len(n)):
             for ctx in contexts:
                 for den in density:
-                    dense_to_sparse(m[i], n[i], den, ctx, num_repeat, stype)
+                    bench(m[i], n[i], den, ctx, num_repeat, stype)
             print("")
         print("")
 
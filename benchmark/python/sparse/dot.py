@@ -107,6 +107,19 @@ SYNTHETIC2 = {
     'num_repeat': 10
 }
 
+# the sparse input layer of a wide-and-deep model, a few dozen features per example
+WIDE_DEEP = {
+    'feature_dim': [1000000, 10000000],
+    'm': [16, 64, 256],
+    'density': [0.00001, 0.00005, 0.0001],
+    'batch_size': [512, 1024],
+    'default_index': {'batch_size': 0,
+                      'density': 1,
+                      'output_dim': 1,
+                      'feature_dim': 0},
+    'num_repeat': 10
+}
+
 def measure_cost(repeat, scipy_trans_lhs, scipy_dns_lhs, func_name, *args, **kwargs):
     """Measure time cost of running a function
     """
@@ -459,5 +472,6 @@ if __name__ == "__main__":
     test_dot_real(CRITEO)
     test_dot_synthetic(SYNTHETIC1)
     test_dot_synthetic(SYNTHETIC2)
+    test_dot_synthetic(WIDE_DEEP)
     total_time = time.time() - begin_time
     print(f"total time is {total_time}")
@@ -0,0 +1,102 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+import time
+import mxnet as mx
+import numpy as np
+import argparse
+
+mx.random.seed(0)
+np.random.seed(0)
+
+parser = argparse.ArgumentParser(description='Benchmark lazy embedding updates of unsorted ids '
+                                             'against the row_sparse gradient')
+parser.add_argument('--optimizer', type=str, default='adam',
+                    choices=['adam', 'adamw', 'ftrl', 'adagrad'])
+parser.add_argument('--dim-in', type=int, default=240000, help='weight.shape[0]')
+parser.add_argument('--dim-out', type=int, default=512, help='weight.shape[1]')
+parser.add_argument('--num-ids', type=int, default=20000,
+                    help='number of looked up ids, with duplicates')
+parser.add_argument('--num-unique', type=int, default=5000,
+                    help='number of distinct ids among them')
+parser.add_argument('--repeat', type=int, default=100, help='num repeat')
+parser.add_argument('--cpu', action='store_true')
+
+
+args = parser.parse_args()
+ctx = mx.cpu() if args.cpu else mx.gpu()
+dim_in, dim_out = args.dim_in, args.dim_out
+
+unique = np.random.permutation(dim_in)[:args.num_unique]
+ids = mx.nd.array(np.random.choice(unique, args.num_ids), ctx=ctx)
+out_grad = mx.nd.random.uniform(shape=(args.num_ids, dim_out), ctx=ctx)
+weight = mx.nd.ones((dim_in, dim_out), ctx=ctx)
+num_states = 1 if args.optimizer == 'adagrad' else 2
+states = [mx.nd.zeros((dim_in, dim_out), ctx=ctx) for _ in range(num_states)]
+kwargs = {'lr': 0.01, 'wd': 0., 'rescale_grad': 0.5}
+if args.optimizer == 'adamw':
+    kwargs['eta'] = 1.
+
+# row_sparse path: the gradient of the embedding sorts and deduplicates the ids
+if args.optimizer == 'adamw':
+    sparse_update = None
+else:
+    rsp_kwargs = dict(kwargs)
+    if args.optimizer == 'ftrl':
+        sparse_update = mx.nd.ftrl_update
+    elif args.optimizer == 'adagrad':
+        sparse_update = mx.nd.sparse.adagrad_update
+    else:
+        sparse_update = mx.nd.adam_update
+        rsp_kwargs['lazy_update'] = True
+rsp_weight = weight.copy()
+rsp_states = [state.copy() for state in states]
+rsp_weight.attach_grad(stype='row_sparse')
+# the row_sparse ftrl_update requires row_sparse weight and states
+if args.optimizer == 'ftrl':
+    rsp_targets = [rsp_weight.tostype('row_sparse')] + \
+                  [state.tostype('row_sparse') for state in rsp_states]
+else:
+    rsp_targets = [rsp_weight] + rsp_states
+
+def rsp_step():
+    with mx.autograd.record():
+        emb = mx.nd.Embedding(ids, rsp_weight, input_dim=dim_in, output_dim=dim_out,
+                              sparse_grad=True)
+    emb.backward(out_grad)
+    sparse_update(rsp_targets[0], rsp_weight.grad, *rsp_targets[1:], out=rsp_targets[0],
+                  **rsp_kwargs)
+
+indexed_update = getattr(mx.nd.contrib, 'indexed_{}_update'.format(args.optimizer))
+
+def indexed_step():
+    indexed_update(weight, out_grad, *states, ids, out=weight, **kwargs)
+
+def measure(step):
+    # warmup
+    for _ in range(10):
+        step()
+    mx.nd.waitall()
+    a = time.time()
+    for _ in range(args.repeat):
+        step()
+    mx.nd.waitall()
+    return time.time() - a
+
+if sparse_update is not None:
+    print('row_sparse gradient and update: %.4f s' % measure(rsp_step))
+print('indexed update: %.4f s' % measure(indexed_step))
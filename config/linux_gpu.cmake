@@ -129,3 +129,4 @@ set(USE_NCCL "Use NVidia NCCL with CUDA" OFF)
 set(NCCL_ROOT "" CACHE BOOL "NCCL install path. Supports autodetection.")
 set(USE_NVML OFF CACHE BOOL "Build with NVML support")
 set(USE_NVTX ON CACHE BOOL "Build with NVTX support")
+set(USE_NVJPEG OFF CACHE BOOL "Build with nvJPEG support for decoding images on the GPU")
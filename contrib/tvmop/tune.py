@@ -0,0 +1,144 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# coding: utf-8
+"""Auto-schedule TVM operators for the shapes they are called with.
+
+MXNet run with MXNET_TVM_OP_TUNE_LOG logs the calls of the TVM operators which have no tuned
+kernel for their shapes. This script specializes the kernels of those calls for their shapes, tunes
+them with the meta scheduler of TVM and saves them in a library of the tuned directory. MXNet loads
+the libraries of MXNET_TVM_OP_TUNED_DIR at start and calls their kernels in place of the generic
+ones for those shapes.
+"""
+import os
+import re
+import json
+import time
+import logging
+import argparse
+import multiprocessing
+import sys
+import tvm
+
+logging.basicConfig(level=logging.INFO)
+
+
+def tuned_name(func_name, shapes):
+    """Name of the tuned kernel of a call, as looked up by TVMOpModule"""
+    return func_name + "shape" + "".join("_" + "x".join(str(d) for d in shape)
+                                         for shape in shapes)
+
+
+def read_log(path, ops):
+    """The distinct logged calls of the operators whose kernel names match ops"""
+    calls = {}
+    with open(path) as f:
+        for line in f:
+            if not line.strip():
+                continue
+            call = json.loads(line)
+            if ops is not None and re.match(ops, call["func"]) is None:
+                continue
+            calls[(tuned_name(call["func"], call["shapes"]), call["device"])] = call
+    return calls
+
+
+def find_defs():
+    """The definition and the tensors of the generic kernel of each name"""
+    from tvmop.opdef import __OP_DEF__
+    defs = {}
+    for operator_def in __OP_DEF__:
+        for _, args, name in operator_def.invoke_all():
+            defs[operator_def.get_op_name(name, args)] = (operator_def, args)
+    return defs
+
+
+def specialize(operator_def, args, shapes, name):
+    """The unscheduled kernel of the computation of args for the shapes of a call"""
+    func = tvm.te.create_prim_func(args)
+    # the buffers of the broadcast operators get a zero stride on their axes of size 1
+    buffer_type = "auto_broadcast" if operator_def.auto_broadcast else ""
+    buffers = {}
+    tensors = [param for param in func.params if param in func.buffer_map]
+    assert len(tensors) == len(shapes), \
+        "The call of {} has {} tensors, the kernel {}".format(name, len(shapes), len(tensors))
+    for param, shape in zip(tensors, shapes):
+        buffers[param] = tvm.tir.decl_buffer(shape, func.buffer_map[param].dtype,
+                                             buffer_type=buffer_type)
+    return func.specialize(buffers).with_attr("global_symbol", name)
+
+
+def get_target(device, gpu_target):
+    if device == "cpu":
+        return tvm.target.Target("llvm -num-cores {}".format(multiprocessing.cpu_count()))
+    return tvm.target.Target(gpu_target, host="llvm")
+
+
+def tune(func, target, trials, work_dir):
+    """The kernel scheduled by the best schedule the meta scheduler found, or None"""
+    from tvm import meta_schedule as ms
+    mod = tvm.IRModule({"main": func})
+    database = ms.tune_tir(mod=mod, target=target, max_trials_global=trials,
+                           work_dir=work_dir)
+    sch = ms.tir_integration.compile_tir(database, mod, target)
+    if sch is None:
+        return None
+    return sch.mod["main"]
+
+
+if __name__ == "__main__":
+    sys.path.append(os.path.dirname(sys.path[0]))
+    parser = argparse.ArgumentParser(description="Tune tvm operators for their logged shapes")
+    parser.add_argument("--log", action="store", required=True, dest="log_path",
+                        help="Calls logged by MXNet to MXNET_TVM_OP_TUNE_LOG")
+    parser.add_argument("-o", action="store", required=True, dest="tuned_dir",
+                        help="Directory of the tuned kernel libraries, MXNET_TVM_OP_TUNED_DIR")
+    parser.add_argument("--ops", action="store", default=None, dest="ops",
+                        help="Regular expression of the kernel names to tune, all by default")
+    parser.add_argument("--trials", type=int, default=64, dest="trials",
+                        help="Number of schedules measured per kernel")
+    parser.add_argument("--gpu-target", action="store", default="cuda", dest="gpu_target",
+                        help="TVM target of the kernels running on GPU")
+    arguments = parser.parse_args()
+    if not hasattr(tvm, "meta_schedule"):
+        raise RuntimeError("The meta scheduler of TVM is needed to tune the operators")
+
+    defs = find_defs()
+    funcs = {}
+    for (name, device), call in read_log(arguments.log_path, arguments.ops).items():
+        if call["func"] not in defs:
+            logging.warning("No definition of the kernel %s, skipping it", call["func"])
+            continue
+        operator_def, args = defs[call["func"]]
+        target = get_target(device, arguments.gpu_target)
+        logging.info("Tuning %s on %s", name, target)
+        func = specialize(operator_def, args, call["shapes"], name)
+        work_dir = os.path.join(arguments.tuned_dir, "work", name)
+        func = tune(func, target, arguments.trials, work_dir)
+        if func is None:
+            logging.warning("No valid schedule was found for %s, skipping it", name)
+            continue
+        funcs.setdefault(device, {})[name] = func
+
+    os.makedirs(arguments.tuned_dir, exist_ok=True)
+    for device, device_funcs in funcs.items():
+        lib = tvm.build(tvm.IRModule(device_funcs), target=get_target(device, arguments.gpu_target))
+        # a new library per run, the kernels of the former runs are no more logged
+        path = os.path.join(arguments.tuned_dir,
+                            "tvmop_tuned_{}_{}.so".format(device, int(time.time())))
+        lib.export_library(path)
+        logging.info("Saved %d tuned kernels to %s", len(device_funcs), path)
@@ -0,0 +1,84 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * This example runs a model with the inference runtime of the C++ package, which only needs
+ * the C API of MXNet: neither the generated operator wrappers nor the executor.
+ * 1. Load the model and its parameters into a thread safe cached op.
+ * 2. Wrap the buffers of the inputs of each thread without copying them.
+ * 3. Run the forward passes of all the threads on the model and report the latency.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mxnet-cpp/inference.hpp"
+
+using namespace mxnet::cpp;
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cout << "Usage: " << argv[0]
+              << " <symbol file> <params file> [gpu id, -1 for cpu] [threads] [batch size]"
+              << std::endl;
+    return 1;
+  }
+  const int gpu         = argc > 3 ? std::atoi(argv[3]) : -1;
+  const int threads     = argc > 4 ? std::atoi(argv[4]) : 1;
+  const int batch_size  = argc > 5 ? std::atoi(argv[5]) : 1;
+  const int iterations  = 100;
+  const Context context = gpu < 0 ? Context::cpu() : Context::gpu(gpu);
+  InferenceModel model(argv[1], argv[2], {"data"}, context, threads);
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t]() {
+      // the input stays owned by the thread, the model reads it in place
+      const std::vector<int64_t> shape = {batch_size, 3, 224, 224};
+      std::vector<float> image(batch_size * 3 * 224 * 224, 0.5f);
+      UniqueNDArray data = UniqueNDArray::FromBuffer(image.data(), shape, Context::cpu());
+      if (gpu >= 0) {
+        const std::vector<mx_uint> dims(shape.begin(), shape.end());
+        UniqueNDArray staged = UniqueNDArray::Create(dims, context);
+        CHECK_EQ(MXNDArraySyncCopyFromCPU(staged.GetHandle(), image.data(), image.size()), 0)
+            << MXGetLastError();
+        data = std::move(staged);
+      }
+      // the outputs of the first run are reused by the next ones
+      std::vector<UniqueNDArray> outputs;
+      model.Forward(&data, &outputs);
+      outputs[0].WaitToRead();
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < iterations; ++i) {
+        model.Forward(&data, &outputs);
+        outputs[0].WaitToRead();
+      }
+      const double ms =
+          std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+              .count();
+      LG << "thread " << t << ": " << ms / iterations << " ms per batch of " << batch_size;
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file inference.h
+ * \brief inference runtime over a thread safe cached op, without the generated operators
+ */
+
+#ifndef MXNET_CPP_INFERENCE_H_
+#define MXNET_CPP_INFERENCE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include "mxnet-cpp/base.h"
+#include "mxnet-cpp/ndarray.h"
+
+namespace mxnet {
+namespace cpp {
+
+/*!
+ * \brief An NDArray handle owned by a single object, freed with it. Moving it moves the handle.
+ */
+class UniqueNDArray {
+ public:
+  UniqueNDArray() : handle_(nullptr) {}
+  explicit UniqueNDArray(NDArrayHandle handle) : handle_(handle) {}
+  UniqueNDArray(UniqueNDArray&& other) noexcept : handle_(other.Release()) {}
+  UniqueNDArray& operator=(UniqueNDArray&& other) noexcept {
+    Reset(other.Release());
+    return *this;
+  }
+  UniqueNDArray(const UniqueNDArray&) = delete;
+  UniqueNDArray& operator=(const UniqueNDArray&) = delete;
+  ~UniqueNDArray() {
+    Reset(nullptr);
+  }
+  /*!
+   * \brief an array allocated on a context
+   * \param dtype the mshadow type flag of the array, float32 by default
+   */
+  static UniqueNDArray Create(const std::vector<mx_uint>& shape,
+                              const Context& context,
+                              int dtype = 0);
+  /*!
+   * \brief an array reading and writing a buffer of the caller on a context, without copy.
+   *  The buffer must outlive the array and the runs using it.
+   */
+  static UniqueNDArray FromBuffer(void* data,
+                                  const std::vector<int64_t>& shape,
+                                  const Context& context,
+                                  int dtype = 0);
+  NDArrayHandle GetHandle() const {
+    return handle_;
+  }
+  explicit operator bool() const {
+    return handle_ != nullptr;
+  }
+  /*! \brief gives up the ownership of the handle */
+  NDArrayHandle Release() {
+    NDArrayHandle handle = handle_;
+    handle_              = nullptr;
+    return handle;
+  }
+  /*! \brief frees the owned handle and takes the ownership of another one */
+  void Reset(NDArrayHandle handle);
+  /*! \brief blocks until the computations writing the array are done */
+  void WaitToRead() const;
+  /*! \brief the data of the array, on its context */
+  const void* GetData() const;
+  /*!
+   * \brief the shape of the array, valid until it is written
+   * \param ndim set to the number of dimensions
+   */
+  const int* GetShape(int* ndim) const;
+
+ private:
+  NDArrayHandle handle_;
+};
+
+/*!
+ * \brief Runs a model exported by HybridBlock.export with a thread safe cached op, with static
+ *  memory and shapes. Runs from concurrent threads are safe, and they do not allocate memory
+ *  once the outputs (and the inputs) of a thread have been created.
+ */
+class InferenceModel {
+ public:
+  /*!
+   * \param symbol_file the symbol of the model
+   * \param params_file the parameters of the model, bound to the inputs of their names
+   * \param data_names the inputs given to Forward, in order
+   * \param context the context the model runs on
+   * \param num_concurrent the runs in flight at the same time, each with its own buffers
+   * \param flags other flags of the cached op
+   */
+  InferenceModel(const std::string& symbol_file,
+                 const std::string& params_file,
+                 const std::vector<std::string>& data_names,
+                 const Context& context,
+                 int num_concurrent                              = 1,
+                 const std::map<std::string, std::string>& flags = {});
+  InferenceModel(const InferenceModel&) = delete;
+  InferenceModel& operator=(const InferenceModel&) = delete;
+  ~InferenceModel();
+  size_t NumData() const {
+    return data_indices_.size();
+  }
+  size_t NumOutputs() const {
+    return num_outputs_;
+  }
+  /*!
+   * \brief runs the model, asynchronously until the outputs are read
+   * \param data the arrays of data_names, on the context of the model
+   * \param outputs the outputs of the run. The arrays it already holds, from a former run of the
+   *  same shapes, are written in place; it is filled with new arrays otherwise.
+   */
+  void Forward(const UniqueNDArray* data, std::vector<UniqueNDArray>* outputs) const;
+
+ private:
+  CachedOpHandle handle_;
+  Context context_;
+  SymbolHandle symbol_;
+  // the parameters at their positions among the inputs, nullptr at the positions of the data
+  std::vector<NDArrayHandle> inputs_;
+  std::vector<UniqueNDArray> params_;
+  std::vector<size_t> data_indices_;
+  size_t num_outputs_;
+};
+
+}  // namespace cpp
+}  // namespace mxnet
+
+#endif  // MXNET_CPP_INFERENCE_H_
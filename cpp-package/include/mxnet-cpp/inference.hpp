@@ -0,0 +1,254 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file inference.hpp
+ * \brief implementation of the inference runtime
+ */
+
+#ifndef MXNET_CPP_INFERENCE_HPP_
+#define MXNET_CPP_INFERENCE_HPP_
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "dlpack/dlpack.h"
+#include "dmlc/logging.h"
+#include "mxnet-cpp/inference.h"
+
+namespace mxnet {
+namespace cpp {
+
+inline UniqueNDArray UniqueNDArray::Create(const std::vector<mx_uint>& shape,
+                                           const Context& context,
+                                           int dtype) {
+  NDArrayHandle handle;
+  CHECK_EQ(MXNDArrayCreate(shape.data(),
+                           shape.size(),
+                           context.GetDeviceType(),
+                           context.GetDeviceId(),
+                           false,
+                           dtype,
+                           &handle),
+           0)
+      << MXGetLastError();
+  return UniqueNDArray(handle);
+}
+
+inline UniqueNDArray UniqueNDArray::FromBuffer(void* data,
+                                               const std::vector<int64_t>& shape,
+                                               const Context& context,
+                                               int dtype) {
+  // the tensor handed to MXNet, deleted with the array, the buffer is left to the caller
+  struct BufferTensor {
+    DLManagedTensor tensor;
+    std::vector<int64_t> shape;
+  };
+  static const DLDataType dl_types[] = {{kDLFloat, 32, 1},
+                                        {kDLFloat, 64, 1},
+                                        {kDLFloat, 16, 1},
+                                        {kDLUInt, 8, 1},
+                                        {kDLInt, 32, 1},
+                                        {kDLInt, 8, 1},
+                                        {kDLInt, 64, 1}};
+  CHECK(dtype >= 0 && dtype < static_cast<int>(sizeof(dl_types) / sizeof(dl_types[0])))
+      << "Unsupported dtype " << dtype << " of a buffer";
+  BufferTensor* buffer       = new BufferTensor();
+  buffer->shape              = shape;
+  DLTensor& tensor           = buffer->tensor.dl_tensor;
+  tensor.data                = data;
+  tensor.ctx.device_type     = static_cast<DLDeviceType>(context.GetDeviceType());
+  tensor.ctx.device_id       = context.GetDeviceId();
+  tensor.ndim                = static_cast<int>(buffer->shape.size());
+  tensor.dtype               = dl_types[dtype];
+  tensor.shape               = buffer->shape.data();
+  tensor.strides             = nullptr;
+  tensor.byte_offset         = 0;
+  buffer->tensor.manager_ctx = buffer;
+  buffer->tensor.deleter     = [](DLManagedTensor* self) {
+    delete static_cast<BufferTensor*>(self->manager_ctx);
+  };
+  NDArrayHandle handle;
+  if (MXNDArrayFromDLPack(&buffer->tensor, false, &handle) != 0) {
+    delete buffer;
+    LOG(FATAL) << MXGetLastError();
+  }
+  return UniqueNDArray(handle);
+}
+
+inline void UniqueNDArray::Reset(NDArrayHandle handle) {
+  if (handle_ != nullptr)
+    MXNDArrayFree(handle_);
+  handle_ = handle;
+}
+
+inline void UniqueNDArray::WaitToRead() const {
+  CHECK_EQ(MXNDArrayWaitToRead(handle_), 0) << MXGetLastError();
+}
+
+inline const void* UniqueNDArray::GetData() const {
+  void* data;
+  CHECK_EQ(MXNDArrayGetData(handle_, &data), 0) << MXGetLastError();
+  return data;
+}
+
+inline const int* UniqueNDArray::GetShape(int* ndim) const {
+  const int* shape;
+  CHECK_EQ(MXNDArrayGetShape(handle_, ndim, &shape), 0) << MXGetLastError();
+  return shape;
+}
+
+inline InferenceModel::InferenceModel(const std::string& symbol_file,
+                                      const std::string& params_file,
+                                      const std::vector<std::string>& data_names,
+                                      const Context& context,
+                                      int num_concurrent,
+                                      const std::map<std::string, std::string>& flags)
+    : context_(context), data_indices_(data_names.size()) {
+  CHECK_EQ(MXSymbolCreateFromFile(symbol_file.c_str(), &symbol_), 0) << MXGetLastError();
+  mx_uint num_inputs, num_outputs;
+  const char** input_names;
+  CHECK_EQ(NNSymbolListInputNames(symbol_, 0, &num_inputs, &input_names), 0) << MXGetLastError();
+  const std::vector<std::string> names(input_names, input_names + num_inputs);
+  CHECK_EQ(MXSymbolGetNumOutputs(symbol_, &num_outputs), 0) << MXGetLastError();
+  num_outputs_ = num_outputs;
+
+  // the parameters by name, without the arg: and aux: prefixes of the saved models
+  mx_uint num_arrays, num_names;
+  NDArrayHandle* arrays;
+  const char** array_names;
+  CHECK_EQ(MXNDArrayLoad(params_file.c_str(), &num_arrays, &arrays, &num_names, &array_names), 0)
+      << MXGetLastError();
+  CHECK_EQ(num_arrays, num_names) << "The parameters of " << params_file << " must have names";
+  std::map<std::string, UniqueNDArray> loaded;
+  for (mx_uint i = 0; i < num_arrays; ++i) {
+    std::string name(array_names[i]);
+    if (name.compare(0, 4, "arg:") == 0 || name.compare(0, 4, "aux:") == 0)
+      name = name.substr(4);
+    loaded[name] = UniqueNDArray(arrays[i]);
+  }
+
+  AtomicSymbolCreator copyto;
+  CHECK_EQ(NNGetOpHandle("_copyto", &copyto), 0) << MXGetLastError();
+  inputs_.resize(num_inputs, nullptr);
+  std::string data_indices, param_indices;
+  for (mx_uint i = 0; i < num_inputs; ++i) {
+    auto data = std::find(data_names.begin(), data_names.end(), names[i]);
+    if (data != data_names.end()) {
+      data_indices_[data - data_names.begin()] = i;
+      data_indices += (data_indices.empty() ? "" : ", ") + std::to_string(i);
+      continue;
+    }
+    auto it = loaded.find(names[i]);
+    CHECK(it != loaded.end()) << "The input " << names[i] << " is neither a data nor a parameter";
+    UniqueNDArray param;
+    if (context_.GetDeviceType() == kCPU) {
+      param = std::move(it->second);
+    } else {
+      int ndim, dtype;
+      const int* shape = it->second.GetShape(&ndim);
+      CHECK_EQ(MXNDArrayGetDType(it->second.GetHandle(), &dtype), 0) << MXGetLastError();
+      param = Create(std::vector<mx_uint>(shape, shape + ndim), context_, dtype);
+      NDArrayHandle from    = it->second.GetHandle();
+      NDArrayHandle to      = param.GetHandle();
+      NDArrayHandle* to_ptr = &to;
+      int num_to            = 1;
+      CHECK_EQ(MXImperativeInvoke(copyto, 1, &from, &num_to, &to_ptr, 0, nullptr, nullptr, nullptr),
+               0)
+          << MXGetLastError();
+    }
+    inputs_[i] = param.GetHandle();
+    params_.push_back(std::move(param));
+    param_indices += (param_indices.empty() ? "" : ", ") + std::to_string(i);
+  }
+  for (size_t i = 0; i < data_names.size(); ++i) {
+    CHECK(std::find(names.begin(), names.end(), data_names[i]) != names.end())
+        << "The model has no input " << data_names[i];
+  }
+
+  std::map<std::string, std::string> op_flags = {
+      {"data_indices", "[" + data_indices + "]"},
+      {"param_indices", "[" + param_indices + "]"},
+      {"static_alloc", "true"},
+      {"static_shape", "true"},
+      {"num_concurrent_states", std::to_string(num_concurrent)}};
+  for (const auto& flag : flags) {
+    op_flags[flag.first] = flag.second;
+  }
+  std::vector<const char*> keys, vals;
+  for (const auto& flag : op_flags) {
+    keys.push_back(flag.first.c_str());
+    vals.push_back(flag.second.c_str());
+  }
+  CHECK_EQ(MXCreateCachedOp(symbol_, keys.size(), keys.data(), vals.data(), &handle_, true), 0)
+      << MXGetLastError();
+}
+
+inline InferenceModel::~InferenceModel() {
+  MXFreeCachedOp(handle_);
+  MXSymbolFree(symbol_);
+}
+
+inline void InferenceModel::Forward(const UniqueNDArray* data,
+                                    std::vector<UniqueNDArray>* outputs) const {
+  // the handles of the runs of a thread, their capacity is kept from run to run
+  thread_local std::vector<NDArrayHandle> input_handles;
+  thread_local std::vector<NDArrayHandle> output_handles;
+  input_handles.assign(inputs_.begin(), inputs_.end());
+  for (size_t i = 0; i < data_indices_.size(); ++i) {
+    input_handles[data_indices_[i]] = data[i].GetHandle();
+  }
+  const bool reuse = outputs->size() == num_outputs_ &&
+                     std::all_of(outputs->begin(), outputs->end(), [](const UniqueNDArray& a) {
+                       return static_cast<bool>(a);
+                     });
+  int num_outputs         = num_outputs_;
+  NDArrayHandle* out_ptrs = nullptr;
+  if (reuse) {
+    output_handles.resize(num_outputs_);
+    for (size_t i = 0; i < num_outputs_; ++i) {
+      output_handles[i] = (*outputs)[i].GetHandle();
+    }
+    out_ptrs = output_handles.data();
+  }
+  CHECK_EQ(MXInvokeCachedOp(handle_,
+                            input_handles.size(),
+                            input_handles.data(),
+                            context_.GetDeviceType(),
+                            context_.GetDeviceId(),
+                            &num_outputs,
+                            &out_ptrs,
+                            nullptr),
+           0)
+      << MXGetLastError();
+  if (!reuse) {
+    // the new arrays are owned by the caller
+    outputs->clear();
+    for (int i = 0; i < num_outputs; ++i) {
+      outputs->emplace_back(out_ptrs[i]);
+    }
+  }
+}
+
+}  // namespace cpp
+}  // namespace mxnet
+
+#endif  // MXNET_CPP_INFERENCE_HPP_
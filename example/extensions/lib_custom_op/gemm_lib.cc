@@ -174,12 +174,28 @@ MXReturnValue inferShape(const std::unordered_map<std::string, std::string>& att
   return MX_SUCCESS;
 }
 
+MXReturnValue workspaceSize(const std::unordered_map<std::string, std::string>& attrs,
+                            const std::vector<std::vector<unsigned int>>& inshapes,
+                            const std::vector<int>& intypes,
+                            bool backward,
+                            size_t* workspace_size) {
+  // the backward transposes both inputs, the forward needs no workspace
+  if (backward) {
+    unsigned n      = inshapes[0][0];
+    unsigned k      = inshapes[0][1];
+    unsigned m      = inshapes[1][1];
+    *workspace_size = (k * n + m * k) * sizeof(float);
+  }
+  return MX_SUCCESS;
+}
+
 REGISTER_OP(my_gemm)
     .setForward(forward, "cpu")
     .setBackward(backward, "cpu")
     .setParseAttrs(parseAttrs)
     .setInferType(inferType)
-    .setInferShape(inferShape);
+    .setInferShape(inferShape)
+    .setWorkspaceSize(workspaceSize);
 
 /* ------------------------------------------------------------------------- */
 
@@ -234,6 +250,7 @@ REGISTER_OP(state_gemm)
     .setInferType(inferType)
     .setInferShape(inferShape)
     .setMutateInputs(mutateInputs)
+    .setWorkspaceSize(workspaceSize)
     .setCreateOpState(createOpState, "cpu");
 
 MXReturnValue initialize(int version) {
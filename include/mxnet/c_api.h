@@ -78,6 +78,8 @@ typedef const void* FunctionHandle;
 typedef void* AtomicSymbolCreator;
 /*! \brief handle to cached operator */
 typedef void* CachedOpHandle;
+/*! \brief handle to a batcher of the requests of a cached operator */
+typedef void* CachedOpBatcherHandle;
 /*! \brief handle to a symbol that can be bind as operator */
 typedef void* SymbolHandle;
 /*! \brief handle to a AtomicSymbol */
@@ -125,6 +127,12 @@ typedef void (*EngineSyncFunc)(void*, void*);
 typedef void (*EngineFuncParamDeleter)(void*);
 /*! \brief Monitor callback called at operator level for cached op */
 typedef void (*CachedOpMonitorCallback)(const char*, const char*, NDArrayHandle);
+/*!
+ * \brief Callback receiving the outputs of a request of a cached op batcher: the number of
+ *  outputs, the outputs, which the callee must free, the error message or nullptr on success,
+ *  and the handle given with the request
+ */
+typedef void (*CachedOpBatcherCallback)(int, NDArrayHandle*, const char*, void*);
 
 struct NativeOpInfo {
   void (*forward)(int, float**, int*, unsigned**, int*, void*);
@@ -181,7 +189,8 @@ enum CustomOpPropCallbacks {
   kCustomOpPropCreateOperator,
   kCustomOpPropInferType,
   kCustomOpPropInferStorageType,
-  kCustomOpPropBackwardInferStorageType
+  kCustomOpPropBackwardInferStorageType,
+  kCustomOpPropRunOnEngine
 };
 
 typedef int (*CustomOpFBFunc)(int /*size*/,
@@ -202,6 +211,7 @@ typedef int (*CustomOpBackwardInferStorageTypeFunc)(int /*num_input*/,
                                                     int* /*tags*/,
                                                     void* /*state*/);
 typedef int (*CustomOpInferTypeFunc)(int /*num_input*/, int* /*types*/, void* /*state*/);
+typedef int (*CustomOpRunOnEngineFunc)(int* /*run_on_engine*/, void* /*state*/);
 typedef int (*CustomOpBwdDepFunc)(const int* /*out_grad*/,
                                   const int* /*in_data*/,
                                   const int* /*out_data*/,
@@ -293,6 +303,24 @@ MXNET_DLL int MXRandomSeedContext(int seed, int dev_type, int dev_id);
  */
 MXNET_DLL int MXSetFlushDenorms(bool value, bool* prev_state);
 
+/*!
+ * \brief Enable or disable the audit of the storage fallbacks, which records the conversions
+ *  between storage types made around the operators without a kernel for their storage types.
+ * \param enabled whether to record the storage fallbacks
+ * \param prev whether the audit was enabled before the call
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXSetStorageFallbackAudit(int enabled, int* prev);
+
+/*!
+ * \brief Print the storage fallbacks recorded, per operator, conversion and device,
+ *  with the number of conversions and the bytes of the dense arrays converted.
+ * \param reset whether to clear the recorded fallbacks
+ * \param out_str the table of the storage fallbacks
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXStorageFallbackAuditDumps(int reset, const char** out_str);
+
 /*!
  * \brief Notify the engine about a shutdown,
  *  This can help engine to print less messages into display.
@@ -390,6 +418,65 @@ MXNET_DLL int MXAggregateProfileStatsPrint(const char** out_str,
                                            int sort_by,
                                            int ascending);
 
+/*!
+ * \brief Set the rate of the sampling profiler, one in rate operator executions of
+ *        each engine thread is timed, 0 turns sampling off
+ * \param rate the sampling rate
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXSetProfilerSampleRate(int rate);
+
+/*!
+ * \brief Print the per-operator latency percentiles of the sampling profiler
+ *        to a string in json format
+ * \param out_str will receive a pointer to the output string
+ * \param reset clear the sampled stats after printing
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXSampledProfileStatsPrint(const char** out_str, int reset);
+
+/*!
+ * \brief Print the peak memory snapshot of the memory timeline to a string in json format:
+ *        for each device the peak live bytes and the operators holding memory at the peak
+ * \param out_str will receive a pointer to the output string
+ * \param reset restart the peak tracking from the memory currently in use after printing
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXMemoryPeakSnapshotPrint(const char** out_str, int reset);
+
+/*!
+ * \brief Set a request on the calling thread for request-scoped latency tracing: the
+ *        operators pushed by the thread until MXRequestTraceEnd are traced as part of it.
+ *        Independent of the profiler state.
+ * \param name name of the root span of the request
+ * \param trace_id 32 hex digits to join the trace of a caller, NULL for a new trace id
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXRequestTraceBegin(const char* name, const char* trace_id);
+
+/*!
+ * \brief End the request set on the calling thread, its trace is kept for MXRequestTraceDump
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXRequestTraceEnd();
+
+/*!
+ * \brief Print the finished request traces to a string in the OTLP/JSON format of
+ *        OpenTelemetry, an ExportTraceServiceRequest
+ * \param out_str will receive a pointer to the output string
+ * \param reset drop the printed traces
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXRequestTraceDump(const char** out_str, int reset);
+
+/*!
+ * \brief Get a snapshot of the live metrics of the engine, the storage pools, the kvstores
+ *        and the data iterators in the OpenMetrics text format
+ * \param out_str will receive a pointer to the output string
+ * \return 0 when success, -1 when failure happens.
+ */
+MXNET_DLL int MXGetMetrics(const char** out_str);
+
 /*!
  * \brief Pause profiler tuning collection
  * \param paused If nonzero, profiling pauses. Otherwise, profiling resumes/continues
@@ -572,6 +659,14 @@ MXNET_DLL int MXGetCommitHash(const char** out);
 #if MXNET_USE_TVM_OP
 MXNET_DLL int MXLoadTVMOp(const char* libpath);
 
+/*!
+ * \brief Load TVM operator kernels tuned for the shapes they are called with, which take the
+ * place of the kernels loaded by MXLoadTVMOp for those shapes
+ * \param libpath library of tuned kernels built by contrib/tvmop/tune.py
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXLoadTVMTunedOp(const char* libpath);
+
 struct OtherOptionEntity {
   int val;
 };
@@ -760,6 +855,20 @@ MXNET_DLL int MXNDArraySave(const char* fname,
                             uint32_t num_args,
                             NDArrayHandle* args,
                             const char** keys);
+/*!
+ * \brief Save list of narray into a compressed npz file, deflating its members in parallel.
+ * \param fname name of the file.
+ * \param num_args number of arguments to save.
+ * \param args the array of NDArrayHandles to be saved.
+ * \param keys the name of the NDArray, optional, can be NULL
+ * \param level the deflate level, from 1 to 10
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArraySaveCompressed(const char* fname,
+                                      uint32_t num_args,
+                                      NDArrayHandle* args,
+                                      const char** keys,
+                                      int level);
 /*!
  * \brief Load list of narray from the file.
  * \param fname name of the file.
@@ -774,6 +883,22 @@ MXNET_DLL int MXNDArrayLoad(const char* fname,
                             NDArrayHandle** out_arr,
                             uint32_t* out_name_size,
                             const char*** out_names);
+/*!
+ * \brief Load list of narray from the file as MXNDArrayLoad, keeping the dense arrays of a
+ *  file in the NDArray format in a copy-on-write mapping of the file on the CPU, which is
+ *  paged in on demand and shared in the page cache across processes.
+ * \param fname name of the file.
+ * \param out_size number of narray loaded.
+ * \param out_arr head of the returning narray handles.
+ * \param out_name_size size of output name arrray.
+ * \param out_names the names of returning NDArrays, can be NULL
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayLoadMapped(const char* fname,
+                                  uint32_t* out_size,
+                                  NDArrayHandle** out_arr,
+                                  uint32_t* out_name_size,
+                                  const char*** out_names);
 
 /*!
  * \brief Load list / dictionary of narrays from file content loaded into memory.
@@ -821,6 +946,38 @@ MXNET_DLL int MXNDArraySyncCopyFromCPU(NDArrayHandle handle, const void* data, s
  */
 MXNET_DLL int MXNDArraySyncCopyToCPU(NDArrayHandle handle, void* data, size_t size);
 
+/*!
+ * \brief Perform an asynchronous copy to a contiguous CPU memory region.
+ *
+ *  The copy runs in the engine after the pending writes to the array, this function doesn't
+ *  wait for them. The memory region must stay valid until the copy completes.
+ *
+ * \param handle the NDArray handle
+ * \param data the data source to copy into.
+ * \param size the memory size we want to copy into.
+ * \param out the handle of the copy, to wait for with MXNDArrayWaitAsyncCopy and to free
+ *  with MXNDArrayFreeAsyncCopy.
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayAsyncCopyToCPU(NDArrayHandle handle,
+                                      void* data,
+                                      size_t size,
+                                      EngineVarHandle* out);
+
+/*!
+ * \brief Wait until an asynchronous copy to CPU memory is finished.
+ * \param copy the handle of the copy
+ * \return 0 when success, -1 when the copy or an operation writing the array failed
+ */
+MXNET_DLL int MXNDArrayWaitAsyncCopy(EngineVarHandle copy);
+
+/*!
+ * \brief Free the handle of an asynchronous copy to CPU memory, once the copy is finished.
+ * \param copy the handle of the copy
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayFreeAsyncCopy(EngineVarHandle copy);
+
 /*!
  * \brief Copy src.data() to dst.data() if i = -1, else dst.aux_data(i) if i >= 0
  * This function blocks. Do not use it in performance critical code.
@@ -1008,6 +1165,18 @@ MXNET_DLL int MXNDArrayFromDLPack(DLManagedTensorHandle dlpack,
                                   const bool transient_handle,
                                   NDArrayHandle* out_handle);
 
+/*!
+ * \brief Deduplicate the memory of an NDArray with the NDArrays of the same content, shape,
+ *        type and context deduplicated before in the process, e.g. the shared weights of
+ *        the models served together. The memory is freed with the last NDArray sharing it.
+ *        The NDArrays returned are read only.
+ * \param handle the NDArray to deduplicate
+ * \param out pointer holder to get the deduplicated NDArray
+ * \param saved_bytes if not null, bytes of the memory shared by the live deduplicated NDArrays
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayDeduplicate(NDArrayHandle handle, NDArrayHandle* out, uint64_t* saved_bytes);
+
 /*!
  * \brief Delete a dlpack tensor
  * \param dlpack the pointer of the input DLManagedTensor
@@ -1372,6 +1541,85 @@ MXNET_DLL int MXInvokeCachedOp(CachedOpHandle handle,
                                NDArrayHandle** outputs,
                                const int** out_stypes);
 
+/*!
+ * \brief invoke a cached op on caller-owned DLPack tensors, without copying them
+ *
+ * The tensors are bound to the graph directly: the outputs are written in place and must
+ * have the shapes and types inferred for them. MXNet takes the ownership of all the
+ * tensors and calls their deleters once the operations reading or writing them complete,
+ * so the deleter of a tensor being called means that its buffer can be reused. With
+ * static_shape, the parameters stay referenced by the cached op until they are replaced.
+ *
+ * \param handle the handle to the cached op
+ * \param num_inputs number of input tensors
+ * \param inputs the DLManagedTensor of each input
+ * \param num_outputs number of output tensors, which must match the cached op
+ * \param outputs the preallocated DLManagedTensor of each output
+ * \param default_dev_type the default context type
+ * \param default_dev_id the default context device id
+ * \param wait_to_read whether to return only once the outputs are computed
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXInvokeCachedOpDLPack(CachedOpHandle handle,
+                                     int num_inputs,
+                                     DLManagedTensorHandle* inputs,
+                                     int num_outputs,
+                                     DLManagedTensorHandle* outputs,
+                                     int default_dev_type,
+                                     int default_dev_id,
+                                     bool wait_to_read);
+
+/*!
+ * \brief create a batcher coalescing the concurrent requests of single samples of a model
+ *  into batches of a cached op, created per batch size bucket.
+ *
+ * The flags of the batcher are max_batch_size, batch_buckets, max_delay_us, latency_slo_us
+ * and max_concurrency, the other flags are the ones of a thread safe cached op. The inputs
+ * at param_indices are bound to params, the others are the data of the requests.
+ *
+ * \param symbol the symbol of the model, whose data inputs and outputs are batch major
+ * \param num_flags number of flags
+ * \param keys the keys of the flags
+ * \param vals the values of the flags
+ * \param num_params number of parameters
+ * \param params the parameters, in the order of param_indices
+ * \param dev_type the context type the model runs on
+ * \param dev_id the context device id the model runs on
+ * \param out the created batcher
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXCachedOpBatcherCreate(SymbolHandle symbol,
+                                      int num_flags,
+                                      const char** keys,
+                                      const char** vals,
+                                      int num_params,
+                                      NDArrayHandle* params,
+                                      int dev_type,
+                                      int dev_id,
+                                      CachedOpBatcherHandle* out);
+
+/*!
+ * \brief queue a request to a cached op batcher
+ * \param handle the handle to the batcher
+ * \param num_inputs number of data inputs
+ * \param inputs the data inputs of the request, with a batch of 1
+ * \param callback called from a worker of the batcher once the request is computed
+ * \param callback_handle passed to the callback
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXCachedOpBatcherSubmit(CachedOpBatcherHandle handle,
+                                      int num_inputs,
+                                      NDArrayHandle* inputs,
+                                      CachedOpBatcherCallback callback,
+                                      void* callback_handle);
+
+/*!
+ * \brief free a cached op batcher, once its pending requests are computed
+ * \param handle the handle to the batcher
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXCachedOpBatcherFree(CachedOpBatcherHandle handle);
+
 /*!
  * \brief cached op set monitor callback
  */
@@ -1425,6 +1673,23 @@ MXNET_DLL int MXNDArrayGetDeferredComputeSymbol(NDArrayHandle* output_handles,
  */
 MXNET_DLL int MXNDArrayClearDeferredCompute(NDArrayHandle* arrays, int num);
 
+/*!
+ * \brief Get current status of lazy evaluation mode
+ * \param curr returns the current status.
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArrayIsLazyEvaluation(int* curr);
+
+/*!
+ * \brief set whether to evaluate the elementwise operators lazily. The operators invoked
+ *  imperatively are recorded, and the ones an array depends on run as a single graph when it is
+ *  read. Disabling the mode computes the operators still pending.
+ * \param lazy_eval 1 to enable, 0 to disable.
+ * \param prev returns the previous status before this set.
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXNDArraySetIsLazyEvaluation(int lazy_eval, int* prev);
+
 //--------------------------------------------
 // Part 3: symbolic configuration generation
 //--------------------------------------------
@@ -1980,7 +2245,8 @@ MXNET_DLL int MXSymbolInferTypePartial(SymbolHandle sym,
  * \param quantized_dtype the quantized destination type for input data
  * \param calib_quantize **Deprecated**. quantize op will always be calibrated if could
  * \param quantize_mode quantize mode to be used in quantize pass
- * \param quantize_granularity quantize granularity, tensor-wise or channel-wise
+ * \param quantize_granularity quantize granularity, tensor-wise, channel-wise or
+ *  group-wise:<size>, with the number of input features of the weights sharing a scale
  * \param out_num_calib_names return the number of nodes to be calibrated
  * \param out_calib_names return the node names to be calibrated
  */
@@ -2993,6 +3259,20 @@ MXNET_DLL int MXRtcCudaKernelCall(CudaKernelHandle handle,
  */
 MXNET_DLL int MXNDArrayGetSharedMemHandle(NDArrayHandle handle, int* shared_pid, int* shared_id);
 
+/*!
+ * \brief Get shared memory handle from NDArray, which may be a block of a pooled shared memory
+ *  segment, see MXNET_CPU_SHARED_MEM_POOL_SIZE.
+ * \param handle NDArray handle.
+ * \param shared_pid output PID
+ * \param shared_id output shared memory id.
+ * \param shared_offset output offset of the NDArray in the shared memory segment, 0 when the
+ *  segment holds only the NDArray.
+ */
+MXNET_DLL int MXNDArrayGetSharedMemHandleEx(NDArrayHandle handle,
+                                            int* shared_pid,
+                                            int* shared_id,
+                                            uint64_t* shared_offset);
+
 /*!
  * \brief Release all unreferenced memory from the devices storage managers memory pool
  * \param dev_type device type, specify device we want to take
@@ -3000,6 +3280,34 @@ MXNET_DLL int MXNDArrayGetSharedMemHandle(NDArrayHandle handle, int* shared_pid,
  */
 MXNET_DLL int MXStorageEmptyCache(int dev_type, int dev_id);
 
+/*!
+ * \brief Create the unique id of a new NCCL group of SyncBatchNorm with comm='nccl', which all
+ *  the processes of the group pass to MXSyncBatchNormInitNCCL.
+ * \param unique_id buffer of at least 128 bytes receiving the id
+ * \param size the size of the id
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXSyncBatchNormGetNCCLUniqueId(char* unique_id, int* size);
+
+/*!
+ * \brief Set up the NCCL group of SyncBatchNorm with comm='nccl' in this process, which is a
+ *  collective of all the processes of the group. The GPU dev_ids[i] has the rank
+ *  proc_rank * num_devices + i in the group.
+ * \param unique_id the id created by MXSyncBatchNormGetNCCLUniqueId in one of the processes
+ * \param size the size of the id
+ * \param num_procs the number of processes of the group
+ * \param proc_rank the rank of this process
+ * \param num_devices the number of GPUs of every process
+ * \param dev_ids the ids of the GPUs of this process
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXSyncBatchNormInitNCCL(const char* unique_id,
+                                      int size,
+                                      int num_procs,
+                                      int proc_rank,
+                                      int num_devices,
+                                      const int* dev_ids);
+
 /*!
  * \brief Reconstruct NDArray from shared memory handle
  * \param shared_pid shared PID
@@ -3016,6 +3324,55 @@ MXNET_DLL int MXNDArrayCreateFromSharedMem(int shared_pid,
                                            int dtype,
                                            NDArrayHandle* out);
 
+/*!
+ * \brief Reconstruct NDArray from a shared memory handle of MXNDArrayGetSharedMemHandleEx
+ * \param shared_pid shared PID
+ * \param shared_id shared memory id
+ * \param shared_offset offset of the NDArray in the shared memory segment
+ * \param shape pointer to NDArray dimensions
+ * \param ndim number of NDArray dimensions
+ * \param dtype data type of NDArray
+ * \param out constructed NDArray
+ */
+MXNET_DLL int MXNDArrayCreateFromSharedMemEx(int shared_pid,
+                                             int shared_id,
+                                             uint64_t shared_offset,
+                                             const int* shape,
+                                             int ndim,
+                                             int dtype,
+                                             NDArrayHandle* out);
+
+/*!
+ * \brief Export a GPU NDArray to the other processes through CUDA IPC. The NDArray is copied to
+ *        an allocation of its own, kept until MXNDArrayReleaseCudaIpcHandle is called.
+ * \param handle NDArray handle, on a GPU
+ * \param out_handle buffer of 64 bytes receiving the CUDA IPC memory handle
+ */
+MXNET_DLL int MXNDArrayGetCudaIpcHandle(NDArrayHandle handle, char* out_handle);
+
+/*!
+ * \brief Free the copy of an NDArray exported with MXNDArrayGetCudaIpcHandle
+ * \param ipc_handle the 64 bytes of the CUDA IPC memory handle
+ */
+MXNET_DLL int MXNDArrayReleaseCudaIpcHandle(const char* ipc_handle);
+
+/*!
+ * \brief Map an NDArray exported by another process with MXNDArrayGetCudaIpcHandle, without
+ *        a copy. The NDArray is read only, and valid until the exporting process releases it.
+ * \param ipc_handle the 64 bytes of the CUDA IPC memory handle
+ * \param shape pointer to NDArray dimensions
+ * \param ndim number of NDArray dimensions
+ * \param dtype data type of NDArray
+ * \param dev_id the GPU of the exported NDArray
+ * \param out constructed NDArray
+ */
+MXNET_DLL int MXNDArrayCreateFromCudaIpcHandle(const char* ipc_handle,
+                                               const int* shape,
+                                               int ndim,
+                                               int dtype,
+                                               int dev_id,
+                                               NDArrayHandle* out);
+
 /*!
  * \brief Push an asynchronous operation to the engine.
  * \param async_func Execution function whici takes a parameter on_complete
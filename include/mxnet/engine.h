@@ -29,6 +29,7 @@
 #include <memory>
 #include <functional>
 #endif
+#include <string>
 #include <utility>
 #include <vector>
 #include "./base.h"
@@ -135,10 +136,14 @@ struct Var {
 
 /*! \brief Internal representation of operator.  */
 struct Opr;
+/*! \brief Internal representation of a captured sequence of operations. */
+struct Graph;
 /*! \brief Variable pointer type, usually hold by user used to specify dependencies. */
 typedef Var* VarHandle;
 /*! \brief Operator pointer type, usually hold by user.*/
 typedef Opr* OprHandle;
+/*! \brief Captured graph pointer type, usually hold by user.*/
+typedef Graph* GraphHandle;
 /*!
  * \brief OnStart callback to the engine,
  *  called by AsyncFn before the action
@@ -224,6 +229,8 @@ class MXNET_API Engine {
   typedef engine::VarHandle VarHandle;
   /*! \brief Operator pointer */
   typedef engine::OprHandle OprHandle;
+  /*! \brief Captured graph pointer */
+  typedef engine::GraphHandle GraphHandle;
   /*!
    * \brief Notify the engine about a shutdown,
    *  This can help engine to print less messages into display.
@@ -251,6 +258,17 @@ class MXNET_API Engine {
    * \return The new variable allocated.
    */
   virtual VarHandle NewVariable() = 0;
+  /*!
+   * \brief Allocate a new variable for a region of the data of var. The operations using var
+   *        also depend on the new variable, while the operations using the variables of
+   *        disjoint regions of the same data don't depend on each other. The variable is
+   *        deleted along with var.
+   * \param var The variable of the whole data, not a region variable itself.
+   * \return The variable of the region, var itself if the engine doesn't track regions.
+   */
+  virtual VarHandle NewRegionVariable(VarHandle var) {
+    return var;
+  }
   /*!
    * \brief Create a new operator. The returned operator could be saved
    *        externally so that it could be resued for scheduling.
@@ -426,6 +444,50 @@ class MXNET_API Engine {
     }
     read_vars->resize(rtop - read_vars->begin());
   }
+  /*!
+   * \brief Start recording the operations pushed by the calling thread.
+   *
+   *  Recorded operations are still executed as usual. Operations of the
+   *  engine itself, such as WaitForVar or the deletion of variables and
+   *  operators, are not recorded.
+   */
+  virtual void BeginCapture() {
+    LOG(FATAL) << "Engine does not support graph capture";
+  }
+  /*!
+   * \brief Stop recording and build a graph from the recorded operations.
+   *
+   *  The dependencies between the recorded operations are resolved once here,
+   *  so that replaying the graph costs a single push regardless of its size.
+   * \return The captured graph, or nullptr if it cannot be replayed because
+   *         a variable it uses was deleted during the capture.
+   */
+  virtual GraphHandle EndCapture() {
+    LOG(FATAL) << "Engine does not support graph capture";
+    return nullptr;
+  }
+  /*!
+   * \brief Push all operations of a captured graph again.
+   *
+   *  To other operations the replay looks like one operation that reads and
+   *  mutates all variables used by the graph. Replays of the same graph run
+   *  one after another. All variables used by the graph must stay alive
+   *  until the graph is deleted.
+   * \param graph The graph returned by EndCapture.
+   * \param priority Priority of the replay, as hint to the engine.
+   */
+  virtual void Replay(GraphHandle graph, int priority = 0) {
+    LOG(FATAL) << "Engine does not support graph capture";
+  }
+  /*!
+   * \brief Delete a captured graph.
+   *  The delete will not happen immediately, but will wait until pending
+   *  replays of the graph are completed.
+   * \param graph The graph to delete.
+   */
+  virtual void DeleteGraph(GraphHandle graph) {
+    LOG(FATAL) << "Engine does not support graph capture";
+  }
   /*! \brief query current limit for bulk size */
   virtual int bulk_size() const {
     return 0;
@@ -434,6 +496,17 @@ class MXNET_API Engine {
   virtual int set_bulk_size(int) {
     return 0;
   }
+  /*!
+   * \brief set the scope that the following bulks belong to
+   *
+   *  With adaptive bulking (MXNET_EXEC_BULK_EXEC_ADAPTIVE) the engine tunes
+   *  the bulk size of each scope within the limit set by set_bulk_size.
+   * \param scope name of the code region pushing the operations, empty for none
+   * \return the previous scope
+   */
+  virtual std::string set_bulk_scope(std::string scope) {
+    return std::string();
+  }
 };      // class Engine
 #endif  // DMLC_USE_CXX11
 }  // namespace mxnet
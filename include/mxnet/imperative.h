@@ -169,6 +169,9 @@ class Imperative {
 
     /*! \brief Remember if the outputs associated with this DCInfo have been computed already */
     bool is_computed_ = false;
+
+    /*! \brief Whether the operator was recorded in lazy evaluation mode */
+    bool is_lazy_ = false;
   };
 
   /*! \brief whether operator recording is on. */
@@ -197,10 +200,25 @@ class Imperative {
   }
   /*! \brief turn on or turn off operator recording for autograd. */
   bool set_is_deferred_compute(bool is_deferred_compute) {
+    // the recording cannot start from arrays pending lazy evaluation
+    if (is_deferred_compute && is_lazy_eval_)
+      FlushLazyEval();
     bool old             = is_deferred_compute_;
     is_deferred_compute_ = is_deferred_compute;
     return old;
   }
+  /*! \brief whether lazy evaluation of the elementwise operators is on. */
+  bool is_lazy_eval() const {
+    return is_lazy_eval_;
+  }
+  /*! \brief turn on or turn off lazy evaluation, computing the pending arrays when turned off. */
+  bool set_is_lazy_eval(bool is_lazy_eval) {
+    bool old      = is_lazy_eval_;
+    is_lazy_eval_ = is_lazy_eval;
+    if (old && !is_lazy_eval)
+      FlushLazyEval();
+    return old;
+  }
   /*! \brief return current numpy compatibility status,
    *  GlobalOn(2), ThreadLocalOn(1), Off(0).
    * */
@@ -274,6 +292,17 @@ class Imperative {
   void SetDeferredComputeVariable(NDArrayHandle* arrays, SymbolHandle* variables, const int num);
   /*! \brief clear info node associated with array */
   void DeferredComputeClear(NDArrayHandle* arrays, const int num);
+  /*!
+   * \brief record an operator invoked in lazy evaluation mode, its outputs being computed
+   *  with the other pending operators they depend on when they are read.
+   * \return false when the operator is to be invoked now, the pending arrays having been
+   *  computed if it writes to existing arrays
+   */
+  bool RecordLazyEval(const nnvm::NodeAttrs& attrs,
+                      const std::vector<NDArray*>& inputs,
+                      const std::vector<NDArray*>& outputs);
+  /*! \brief compute the arrays pending lazy evaluation which are still referenced */
+  void FlushLazyEval();
   /*! \brief */
   OpStatePtr Invoke(const Context& default_ctx,
                     const nnvm::NodeAttrs& attrs,
@@ -336,11 +365,17 @@ class Imperative {
                              uint32_t num_outputs,
                              std::vector<bool>* p_save_inputs,
                              std::vector<bool>* p_save_outputs);
+  /*!
+   * \brief run the operators pending lazy evaluation which the arrays depend on as a cached op
+   * \param arrays the arrays to compute, all the pending arrays when empty
+   */
+  void ComputeLazyEval(const std::vector<NDArray>& arrays);
   /*! \brief indicate whether is training. */
 #if DMLC_CXX11_THREAD_LOCAL
   static thread_local bool is_train_;
   static thread_local bool is_recording_;
   static thread_local bool is_deferred_compute_;
+  static thread_local bool is_lazy_eval_;
   static thread_local OptConstraint opt_constraints_;
   // TOOD(junwu): Added numpy compatibility switch for backward compatibility.
   // Delete it in the next major release.
@@ -349,6 +384,7 @@ class Imperative {
   static MX_THREAD_LOCAL bool is_train_;
   static MX_THREAD_LOCAL bool is_recording_;
   static MX_THREAD_LOCAL bool is_deferred_compute_;
+  static MX_THREAD_LOCAL bool is_lazy_eval_;
   static MX_THREAD_LOCAL OptConstraint opt_constraints_;
   // TOOD(junwu): Added numpy compatibility switch for backward compatibility.
   // Delete it in the next major release.
@@ -135,6 +135,11 @@ class Dataset {
    *  \param ret the returned ndarray items
    */
   virtual bool GetItem(uint64_t idx, std::vector<NDArray>* ret) = 0;
+  /*!
+   *  \brief Hint the indices GetItem is called for next, so that their data can be read ahead
+   *  \param indices the indices of the upcoming items
+   */
+  virtual void Prefetch(const std::vector<uint64_t>& indices) {}
   // virtual destructor
   virtual ~Dataset(void) {}
 };  // class Dataset
@@ -171,6 +176,11 @@ class BatchifyFunction {
   /*! \brief The batchify logic */
   virtual bool Batchify(const std::vector<std::vector<NDArray> >& inputs,
                         std::vector<NDArray>* outputs) = 0;
+  /*!
+   * \brief Set the context of the outputs, a CPU context such as the pinned memory
+   *  the batches are copied to a GPU from. Outputs are on the CPU by default.
+   */
+  virtual void SetOutputContext(const Context& ctx) {}
 };  // class BatchifyFunction
 
 using BatchifyFunctionPtr = std::shared_ptr<BatchifyFunction>;
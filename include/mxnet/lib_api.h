@@ -52,7 +52,7 @@
 #endif
 
 /* Make sure to update the version number everytime you make changes */
-#define MX_LIBRARY_VERSION 11
+#define MX_LIBRARY_VERSION 12
 
 /*!
  * \brief For loading multiple custom op libraries in Linux, exporting same symbol multiple
@@ -409,6 +409,9 @@ typedef std::mt19937 mx_cpu_rand_t;
 #define MX_NUM_CPU_RANDOM_STATES 1024
 #define MX_NUM_GPU_RANDOM_STATES 32768
 
+/*! \brief alignment of the allocations of an operator served from its declared workspace */
+#define MX_WORKSPACE_ALIGNMENT 256
+
 /* \brief Class to help allocate new args/aux params in graph passes */
 class PassResource {
  public:
@@ -766,6 +769,15 @@ typedef MXReturnValue (*inferShape_t)(
 typedef MXReturnValue (*mutateInputs_t)(
     const std::unordered_map<std::string, std::string>& attributes,
     std::vector<int>* input_indices);
+typedef MXReturnValue (*workspaceSize_t)(
+    const std::unordered_map<std::string, std::string>& attributes,
+    const std::vector<std::vector<unsigned int> >& in_shapes,
+    const std::vector<int>& in_types,
+    bool backward,
+    size_t* workspace_size);
+typedef MXReturnValue (*inplaceOption_t)(
+    const std::unordered_map<std::string, std::string>& attributes,
+    std::vector<std::pair<int, int> >* inplace_pairs);
 typedef MXReturnValue (*createOpState_t)(
     const std::unordered_map<std::string, std::string>& attributes,
     const MXContext& ctx,
@@ -794,6 +806,17 @@ class CustomOp {
 
   CustomOp& setMutateInputs(mutateInputs_t func);
 
+  /*!
+   * \brief sets the function returning the bytes of workspace of the forward or backward pass for
+   *  the shapes and types of the forward inputs. MXNet requests the workspace once per call and
+   *  serves the alloc_cpu/alloc_gpu calls on the device of the operator from it, each allocation
+   *  starting at a multiple of MX_WORKSPACE_ALIGNMENT bytes
+   */
+  CustomOp& setWorkspaceSize(workspaceSize_t func);
+
+  /*! \brief sets the function returning the (input, output) pairs which can share memory */
+  CustomOp& setInplaceOption(inplaceOption_t func);
+
   CustomOp& setCreateOpState(createOpState_t func, const char* ctx);
 
   CustomOp& setIsSubgraphOp();
@@ -809,6 +832,8 @@ class CustomOp {
   inferSType_t infer_storage_type;
   inferShape_t infer_shape;
   mutateInputs_t mutate_inputs;
+  workspaceSize_t workspace_size;
+  inplaceOption_t inplace_option;
   bool isSGop;
 
   /*! \brief vector repr of ctx map to be easily loaded from c_api */
@@ -996,7 +1021,9 @@ typedef int (*opRegGet_t)(int idx,
                           mxnet::ext::inferType_t* type,
                           mxnet::ext::inferSType_t* stype,
                           mxnet::ext::inferShape_t* shape,
-                          mxnet::ext::mutateInputs_t* mutate);
+                          mxnet::ext::mutateInputs_t* mutate,
+                          mxnet::ext::workspaceSize_t* workspace,
+                          mxnet::ext::inplaceOption_t* inplace);
 
 #define MXLIB_OPCALLFREE_STR "_opCallFree"
 typedef int (*opCallFree_t)(void* ptr);
@@ -1092,6 +1119,26 @@ typedef int (*opCallMutateInputs_t)(mutateInputs_t mutate,
                                     int** mutate_indices,
                                     int* indices_size);
 
+#define MXLIB_OPCALLWORKSPACESIZE_STR "_opCallWorkspaceSize"
+typedef int (*opCallWorkspaceSize_t)(workspaceSize_t workspace,
+                                     const char* const* keys,
+                                     const char* const* vals,
+                                     int num,
+                                     unsigned int** inshapes,
+                                     int* indims,
+                                     int num_in,
+                                     const int* intypes,
+                                     int backward,
+                                     size_t* workspace_size);
+
+#define MXLIB_OPCALLINPLACEOPTION_STR "_opCallInplaceOption"
+typedef int (*opCallInplaceOption_t)(inplaceOption_t inplace,
+                                     const char* const* keys,
+                                     const char* const* vals,
+                                     int num,
+                                     int** inplace_pairs,
+                                     int* num_pairs);
+
 #define MXLIB_OPCALLCREATEOPSTATE_STR "_opCallCreateOpState"
 typedef int (*opCallCreateOpState_t)(createOpState_t create_op,
                                      const char* const* keys,
@@ -1282,15 +1329,26 @@ typedef int (*msgGet_t)(int idx, const char** msg);
 class CustomStatefulOpWrapper {
  public:
   ~CustomStatefulOpWrapper();
-  explicit CustomStatefulOpWrapper(CustomStatefulOp* inst, opCallDestroyOpState_t destroy)
-      : instance(inst), destroy_(destroy) {}
+  explicit CustomStatefulOpWrapper(CustomStatefulOp* inst,
+                                   opCallDestroyOpState_t destroy,
+                                   size_t forward_workspace  = 0,
+                                   size_t backward_workspace = 0)
+      : instance(inst),
+        destroy_(destroy),
+        forward_workspace_(forward_workspace),
+        backward_workspace_(backward_workspace) {}
   CustomStatefulOp* get_instance() {
     return instance;
   }
+  /*! \brief bytes of workspace declared for the shapes the state was created with */
+  size_t workspace_size(bool backward) const {
+    return backward ? backward_workspace_ : forward_workspace_;
+  }
 
  private:
   CustomStatefulOp* instance;
   opCallDestroyOpState_t destroy_;
+  size_t forward_workspace_, backward_workspace_;
 };
 
 #if defined(_WIN32) || defined(_WIN64) || defined(__WINDOWS__)
@@ -1328,7 +1386,9 @@ MX_VOID_RET _opRegGet(int idx,
                       mxnet::ext::inferType_t* type,
                       mxnet::ext::inferSType_t* stype,
                       mxnet::ext::inferShape_t* shape,
-                      mxnet::ext::mutateInputs_t* mutate);
+                      mxnet::ext::mutateInputs_t* mutate,
+                      mxnet::ext::workspaceSize_t* workspace,
+                      mxnet::ext::inplaceOption_t* inplace);
 
 /*! \brief calls free from the external library for library allocated arrays */
 MX_VOID_RET _opCallFree(void* ptr);
@@ -1424,6 +1484,26 @@ MX_INT_RET _opCallMutateInputs(mxnet::ext::mutateInputs_t mutate,
                                int** mutate_indices,
                                int* indices_size);
 
+/*! \brief returns status of calling workspaceSize function for operator from library */
+MX_INT_RET _opCallWorkspaceSize(mxnet::ext::workspaceSize_t workspace,
+                                const char* const* keys,
+                                const char* const* vals,
+                                int num,
+                                unsigned int** inshapes,
+                                int* indims,
+                                int num_in,
+                                const int* intypes,
+                                int backward,
+                                size_t* workspace_size);
+
+/*! \brief returns status of calling inplaceOption function for operator from library */
+MX_INT_RET _opCallInplaceOption(mxnet::ext::inplaceOption_t inplace,
+                                const char* const* keys,
+                                const char* const* vals,
+                                int num,
+                                int** inplace_pairs,
+                                int* num_pairs);
+
 /*! \brief returns status of calling createStatefulOp function for operator from library */
 MX_INT_RET _opCallCreateOpState(mxnet::ext::createOpState_t create_op,
                                 const char* const* keys,
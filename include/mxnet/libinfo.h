@@ -66,6 +66,10 @@
 #define MXNET_USE_NCCL 0
 #endif
 
+#ifndef MXNET_USE_NVJPEG
+#define MXNET_USE_NVJPEG 0
+#endif
+
 /*!
  *\brief whether to use cusolver library
  */
@@ -141,6 +145,7 @@ enum : unsigned {
   NCCL,
   TENSORRT,
   CUTENSOR,
+  NVJPEG,
 
   // CPU Features / optimizations
   CPU_SSE,
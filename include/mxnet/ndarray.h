@@ -34,7 +34,9 @@
 #include <algorithm>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 #include "./base.h"
 #include "./engine.h"
@@ -58,11 +60,17 @@ namespace rowsparse {
 enum RowSparseAuxType { kIdx };
 }
 
+// block compressed sparse row: the indptr and the column indices are of the blocks
+namespace bsr {
+enum BSRAuxType { kIndPtr, kIdx };
+}
+
 enum NDArrayStorageType {
   kUndefinedStorage = -1,  // undefined storage
   kDefaultStorage,         // dense
   kRowSparseStorage,       // row sparse
   kCSRStorage,             // csr
+  kBSRStorage,             // block csr
 };
 
 enum NDArrayFormatErr {
@@ -94,7 +102,7 @@ class NDArray {
           Context ctx,
           bool delay_alloc = false,
           int dtype        = mshadow::default_type_flag)
-      : ptr_(std::make_shared<Chunk>(shape, ctx, delay_alloc, dtype)),
+      : ptr_(NewChunk(shape, ctx, delay_alloc, dtype)),
         shape_(shape),
         dtype_(dtype),
         storage_type_(kDefaultStorage),
@@ -118,7 +126,7 @@ class NDArray {
    * \param dtype data type of this ndarray
    */
   explicit NDArray(Context ctx, int dtype = mshadow::default_type_flag)
-      : ptr_(std::make_shared<Chunk>(mxnet::TShape(mshadow::Shape1(0)), ctx, true, dtype)),
+      : ptr_(NewChunk(mxnet::TShape(mshadow::Shape1(0)), ctx, true, dtype)),
         shape_(),
         dtype_(dtype),
         storage_type_(kDefaultStorage),
@@ -131,7 +139,7 @@ class NDArray {
    * \param dev_id the device id this tensor sits at
    */
   NDArray(const TBlob& data, int dev_id)
-      : ptr_(std::make_shared<Chunk>(data, dev_id)),
+      : ptr_(NewChunk(data, dev_id)),
         shape_(data.shape_),
         dtype_(data.type_flag_),
         storage_type_(kDefaultStorage),
@@ -143,22 +151,28 @@ class NDArray {
    *  make sure the memory region is available through out the life of NDArray
    * \param data the memory content of static data
    * \param dev_id the device id this tensor sits at
-   * \param deleter the function pointer of custom deleter
+   * \param deleter the function pointer of custom deleter, called once the operations
+   *  pending on the NDArray when it is destructed complete
    */
   NDArray(const TBlob& data, int dev_id, const std::function<void()>& deleter)
-      : ptr_(new Chunk(data, dev_id),
-             [deleter](Chunk* p) {
-               deleter();  // call custom deleter
-               delete p;   // delete Chunk object
-             }),
+      : ptr_(NewChunk(data, dev_id)),
         shape_(data.shape_),
         dtype_(data.type_flag_),
         storage_type_(kDefaultStorage),
-        autograd_entry_(nullptr) {}
+        autograd_entry_(nullptr) {
+    ptr_->static_data_deleter = deleter;
+  }
 
-  /*! \brief create ndarray from shared memory */
-  NDArray(int shared_pid, int shared_id, const mxnet::TShape& shape, int dtype)
-      : ptr_(std::make_shared<Chunk>(shared_pid, shared_id, shape, dtype)),
+  /*!
+   * \brief create ndarray from shared memory
+   * \param shared_offset offset of the block of the data in the pooled shared memory segment
+   */
+  NDArray(int shared_pid,
+          int shared_id,
+          const mxnet::TShape& shape,
+          int dtype,
+          size_t shared_offset = 0)
+      : ptr_(NewChunk(shared_pid, shared_id, shape, dtype, shared_offset)),
         shape_(shape),
         dtype_(dtype),
         storage_type_(kDefaultStorage),
@@ -179,7 +193,7 @@ class NDArray {
           const TBlob& data,
           const std::vector<TBlob>& aux_data,
           int dev_id)
-      : ptr_(std::make_shared<Chunk>(stype, data, aux_data, dev_id)),
+      : ptr_(NewChunk(stype, data, aux_data, dev_id)),
         shape_(shape),
         dtype_(data.type_flag_),
         storage_type_(stype),
@@ -316,7 +330,7 @@ class NDArray {
     auto type  = aux_type(i);
     MSHADOW_TYPE_SWITCH(type, DType, {
       auto dptr = static_cast<DType*>(ptr_->aux_handles[i].dptr);
-      CHECK(stype == kRowSparseStorage || stype == kCSRStorage)
+      CHECK(stype == kRowSparseStorage || stype == kCSRStorage || stype == kBSRStorage)
           << "Unexpected storage type: " << stype;
       res = TBlob(dptr, shape, ptr_->aux_handles[i].ctx.dev_mask(), type);
     });
@@ -371,6 +385,11 @@ class NDArray {
           << "inconsistent storage shape " << storage_shape() << " vs. aux shape "
           << aux_shape(csr::kIdx);
       return aux_shape(csr::kIdx).Size() != 0;
+    } else if (stype == kBSRStorage) {
+      CHECK_EQ(aux_shape(bsr::kIdx)[0], storage_shape()[0])
+          << "inconsistent storage shape " << storage_shape() << " vs. aux shape "
+          << aux_shape(bsr::kIdx);
+      return aux_shape(bsr::kIdx).Size() != 0;
     } else {
       LOG(FATAL) << "Unknown storage type";
     }
@@ -407,9 +426,9 @@ class NDArray {
    * \param stream a pointer to the stream provided by consumer.
    */
   void StreamSync(int stream) const;
-  /*! \return the associated variable of the ndarray.*/
+  /*! \return the associated variable of the ndarray, the one of its region for a view.*/
   inline Engine::VarHandle var() const {
-    return ptr_->var;
+    return region_var_ != nullptr ? region_var_ : ptr_->var;
   }
   /*! \return byte offset in chunk of the ndarray*/
   inline size_t byte_offset() const {
@@ -532,6 +551,19 @@ class NDArray {
    * \param size the memory size we want to copy into, in sizeof(DType) not raw btyes.
    */
   void SyncCopyToCPU(void* data, size_t size) const;
+  /*!
+   * \brief Do an asynchronous copy to a contiguous CPU memory region.
+   *
+   *  The copy is pushed to the engine after the pending writes to the array instead of
+   *  waiting for them. The content of a GPU array is staged through pooled pinned memory
+   *  on the copy stream of its device.
+   *
+   * \param data the memory region to copy into, which must stay valid until the copy completes.
+   * \param size the memory size we want to copy into, in sizeof(DType) not raw btyes.
+   * \param done the engine variable mutated by the copy. Waiting for it waits for the copy and
+   *  rethrows the errors of the operations writing the array.
+   */
+  void AsyncCopyToCPU(void* data, size_t size, Engine::VarHandle done) const;
   /*!
    * \brief check whether the NDArray format is valid
    * \param full_check if `True`, rigorous check, O(N) operations
@@ -609,6 +641,32 @@ class NDArray {
     reuse_ = true;
   }
 
+  /*!
+   * \brief Make this a view of the bytes of src from byte_offset, like a slice of it.
+   * \param src the array holding the data of the view.
+   * \param shape the shape of the view.
+   * \param dtype the data type of the view.
+   * \param byte_offset the offset of the view in the data of src.
+   */
+  inline void InitAsView(const NDArray& src,
+                         const mxnet::TShape& shape,
+                         int dtype,
+                         size_t byte_offset) {
+    CHECK_EQ(src.storage_type(), kDefaultStorage)
+        << "InitAsView is intended only for kDefaultStorage.";
+    const size_t nbytes = shape.Size() * mshadow::mshadow_sizeof(dtype);
+    CHECK_GE(src.ptr_->shandle.size, byte_offset + nbytes)
+        << "NDArray.InitAsView: the view ends after what was allocated.";
+    CHECK(!src.IsView());
+    *this        = src;
+    shape_       = shape;
+    dtype_       = dtype;
+    byte_offset_ = byte_offset;
+    reuse_       = false;
+    // writes to the view don't wait for the ones to disjoint views
+    region_var_ = ptr_->RegionVar(byte_offset, byte_offset + nbytes);
+  }
+
   /*!
    * \brief Create a reference view of NDArray that
    *  represents as DLManagedTensor.
@@ -846,6 +904,18 @@ class NDArray {
    * \param keys the name of the NDArray, if saved in the file.
    */
   static void Load(dmlc::Stream* fi, std::vector<NDArray>* data, std::vector<std::string>* keys);
+  /*!
+   * \brief Load list of ndarray from a local file written by Save, mapping it instead of
+   *  reading it. The dense arrays point into a private file mapping on the CPU: their pages
+   *  are read on first access and shared in the page cache with the other processes that
+   *  map the file, while writes only copy the written pages. The other arrays are copied.
+   * \param fname The name of the file.
+   * \param data the NDArrays to be loaded
+   * \param keys the name of the NDArray, if saved in the file.
+   */
+  static void LoadMapped(const std::string& fname,
+                         std::vector<NDArray>* data,
+                         std::vector<std::string>* keys);
 
  private:
   friend class Imperative;
@@ -870,12 +940,24 @@ class NDArray {
 #endif
     /*! \brief variable from engine */
     Engine::VarHandle var;
+    /*!
+     * \brief the variables of the disjoint byte ranges of the views of the data, by the begin
+     *  of the range. They are deleted by the engine along with var.
+     */
+    std::map<size_t, std::pair<size_t, Engine::VarHandle>> region_vars;
+    /*! \brief protects region_vars */
+    std::mutex region_mutex;
     /*!
      * \brief if this is true, this means the data do not come
      * from Storage, and do not need to be freed
      */
     /*! \brief construct from static data */
     bool static_data;
+    /*!
+     * \brief releases the memory of static data owned by the caller, called by the engine once
+     *  the operations reading or writing var complete
+     */
+    std::function<void()> static_data_deleter;
     /*! \brief whether data allocation is delayed. This doesn't indicate whether aux data
                allocation is delayed. */
     bool delay_alloc;
@@ -897,6 +979,8 @@ class NDArray {
     std::shared_ptr<Storage> storage_ref_;
     /*! \brief Reference to the engine to ensure we cleanup without calling a destructed engine */
     std::weak_ptr<Engine> engine_ref_;
+    /*! \brief Reference to the pool of the data of the small arrays, see AllocHandle */
+    std::shared_ptr<void> small_data_ref_ = SmallDataPoolRef();
 
     /*! \brief default constructor */
     Chunk()
@@ -943,17 +1027,22 @@ class NDArray {
       storage_shape = data.shape_;
     }
 
-    Chunk(int shared_pid, int shared_id, const mxnet::TShape& shape, int dtype)
+    Chunk(int shared_pid,
+          int shared_id,
+          const mxnet::TShape& shape,
+          int dtype,
+          size_t shared_offset)
         : static_data(false),
           delay_alloc(false),
           storage_ref_(Storage::_GetSharedRef()),
           engine_ref_(Engine::_GetSharedRef()) {
-      var                = Engine::Get()->NewVariable();
-      ctx                = Context::CPUShared(0);
-      shandle.size       = shape.Size() * mshadow::mshadow_sizeof(dtype);
-      shandle.ctx        = ctx;
-      shandle.shared_pid = shared_pid;
-      shandle.shared_id  = shared_id;
+      var                   = Engine::Get()->NewVariable();
+      ctx                   = Context::CPUShared(0);
+      shandle.size          = shape.Size() * mshadow::mshadow_sizeof(dtype);
+      shandle.ctx           = ctx;
+      shandle.shared_pid    = shared_pid;
+      shandle.shared_id     = shared_id;
+      shandle.shared_offset = shared_offset;
       Storage::Get()->Alloc(&shandle);
       storage_shape = shape;
     }
@@ -1033,14 +1122,28 @@ class NDArray {
           storage_shape[0] = shape[0];
         } else if (storage_type == kCSRStorage && i == csr::kIdx) {
           storage_shape[0] = shape[0];
+        } else if (storage_type == kBSRStorage && i == bsr::kIdx) {
+          storage_shape[0] = shape[0];
         }
       }
     }
 
+    /*!
+     * \brief allocate shandle with its current size and context.
+     *  With MXNET_GPU_MEM_POOL_STREAM_ORDERED, pending device work on reused GPU
+     *  memory is handed to the engine variable instead of blocking this thread.
+     */
+    void AllocHandle();
+    /*!
+     * \brief free a handle allocated by AllocHandle. The data of the CPU arrays of at most
+     *  kSmallDataBytes bytes comes from a pool of fixed size blocks instead of the storage.
+     */
+    static void FreeHandle(const Storage::Handle& handle);
+    static std::shared_ptr<void> SmallDataPoolRef();
     /*! \brief check if delay alloc is on, do alloc if not yet done */
     inline void CheckAndAlloc(void) {
       if (delay_alloc) {
-        Storage::Get()->Alloc(&shandle);
+        AllocHandle();
 #if MXNET_USE_ONEDNN == 1
         dnnl_mem_ = nullptr;
 #endif
@@ -1056,17 +1159,17 @@ class NDArray {
       dbytes = std::max(dbytes, static_cast<uint64_t>(shandle.size));
       if (delay_alloc) {
         shandle.size = dbytes;
-        Storage::Get()->Alloc(&shandle);
+        AllocHandle();
 #if MXNET_USE_ONEDNN == 1
         dnnl_mem_ = nullptr;
 #endif
         delay_alloc = false;
       } else if (shandle.size < dbytes) {
         // free storage
-        Storage::Get()->Free(shandle);
+        FreeHandle(shandle);
         // init storage
         shandle.size = dbytes;
-        Storage::Get()->Alloc(&shandle);
+        AllocHandle();
 #if MXNET_USE_ONEDNN == 1
         dnnl_mem_ = nullptr;
 #endif
@@ -1094,6 +1197,14 @@ class NDArray {
         CheckAndAllocAuxData(csr::kIndPtr, aux_shapes[csr::kIndPtr]);
         CheckAndAllocAuxData(csr::kIdx, aux_shapes[csr::kIdx]);
         CheckAndAllocData(aux_shapes[csr::kIdx], dtype);
+      } else if (kBSRStorage == storage_type) {
+        // the data holds a (block rows, block columns) block per column index
+        CHECK_EQ(this->storage_shape.ndim(), 3) << "the block shape of a bsr is unknown";
+        CheckAndAllocAuxData(bsr::kIndPtr, aux_shapes[bsr::kIndPtr]);
+        CheckAndAllocAuxData(bsr::kIdx, aux_shapes[bsr::kIdx]);
+        mxnet::TShape storage_shape(this->storage_shape);
+        storage_shape[0] = aux_shapes[bsr::kIdx][0];
+        CheckAndAllocData(storage_shape, dtype);
       } else {
         LOG(FATAL) << "Storage type " << storage_type << " not implemented for CheckAndAlloc";
       }
@@ -1141,10 +1252,55 @@ class NDArray {
       // init shape
       set_aux_shape(i, shape);
     }
+    /*!
+     * \brief the variable of the views of the byte range [begin, end) of the data.
+     * \return the variable of the region holding the range, or nullptr for the views which
+     *  have to use var: the whole data, a range overlapping another region, or data whose
+     *  memory or layout may still change.
+     */
+    Engine::VarHandle RegionVar(size_t begin, size_t end);
     /*! \brief destructor */
     ~Chunk();
   };  // struct Chunk
 
+  /*! \brief a block of the pool the chunks and their reference counts are allocated from */
+  struct ChunkBlock;
+  /*!
+   * \brief allocates the chunks of the arrays with std::allocate_shared from a pool of blocks,
+   *  which also holds their reference counts, instead of the heap.
+   */
+  template <typename T>
+  struct ChunkAllocator {
+    using value_type = T;
+    ChunkAllocator() : pool(ChunkPoolRef()) {}
+    template <typename U>
+    ChunkAllocator(const ChunkAllocator<U>& other) : pool(other.pool) {}  // NOLINT(*)
+    T* allocate(size_t n) {
+      return static_cast<T*>(AllocChunkBlock(n * sizeof(T)));
+    }
+    void deallocate(T* ptr, size_t n) {
+      FreeChunkBlock(ptr, n * sizeof(T));
+    }
+    template <typename U>
+    bool operator==(const ChunkAllocator<U>&) const {
+      return true;
+    }
+    template <typename U>
+    bool operator!=(const ChunkAllocator<U>&) const {
+      return false;
+    }
+    /*! \brief keeps the pool alive until the last chunk is freed */
+    std::shared_ptr<void> pool;
+  };
+  static std::shared_ptr<void> ChunkPoolRef();
+  /*! \brief allocate size bytes from the pool, or from the heap when larger than a block */
+  static void* AllocChunkBlock(size_t size);
+  static void FreeChunkBlock(void* ptr, size_t size);
+  template <typename... Args>
+  static std::shared_ptr<Chunk> NewChunk(Args&&... args) {
+    return std::allocate_shared<Chunk>(ChunkAllocator<Chunk>(), std::forward<Args>(args)...);
+  }
+
   /*!
    * \brief initialize the NDArray
    */
@@ -1154,6 +1310,7 @@ class NDArray {
     storage_type_   = stype;
     reuse_          = false;
     byte_offset_    = 0;
+    region_var_     = nullptr;
     autograd_entry_ = nnvm::NodeEntry(nullptr);
   }
 
@@ -1168,6 +1325,8 @@ class NDArray {
   mutable mxnet::TShape shape_;
   /*! \brief byte offset in chunk */
   size_t byte_offset_ = 0;
+  /*! \brief variable of the region of the chunk of a view, nullptr for the chunk var */
+  Engine::VarHandle region_var_ = nullptr;
   /*! \brief type of data */
   int dtype_ = -1;
   /*! \brief whether the NDArray uses memory of another NDArray. */
@@ -227,6 +227,15 @@ using FCreateOpState = std::function<OpStatePtr(const NodeAttrs& attrs,
  */
 using THasDeterministicOutput = bool;
 
+/*!
+ * \brief Whether the attribute parser of the operator does more than parsing the
+ *        attribute dict, like creating objects of the frontend, so that an imperative
+ *        call cannot reuse the attributes parsed by an earlier call with the same dict.
+ *
+ * \note Register under "TAttrParserNoCache"
+ */
+using TAttrParserNoCache = bool;
+
 /*!
  * \brief Execution mode of this operator.
  */
@@ -303,6 +312,25 @@ using FComputeEx = std::function<void(const nnvm::NodeAttrs& attrs,
                                       const std::vector<OpReqType>& req,
                                       const std::vector<NDArray>& outputs)>;
 
+/*!
+ * \brief Work done by one execution of an operator, for the roofline report of the profiler
+ */
+struct OpCost {
+  /*! \brief floating point operations, a multiply-add counts as two */
+  double flops = 0;
+  /*! \brief bytes read from and written to memory, assuming each tensor is accessed once */
+  double bytes = 0;
+};
+/*!
+ * \brief Register a function estimating the work done by an operator.
+ *  Only the shapes and types of the blobs may be used, their data may not be allocated.
+ *
+ * \note Register under "FOpCost", only called while the aggregate profiler runs
+ */
+using FOpCost = std::function<OpCost(const nnvm::NodeAttrs& attrs,
+                                     const std::vector<TBlob>& inputs,
+                                     const std::vector<TBlob>& outputs)>;
+
 /*!
  * \brief Register a storage and dispatch mode inference function based on
  *        storage types of the inputs and outputs, and the dev_mask for the operator.
@@ -370,6 +398,27 @@ using FNeedCalibrateInput = std::function<std::vector<int>(const NodeAttrs& attr
  */
 using FNeedCalibrateOutput = std::function<std::vector<int>(const NodeAttrs& attrs)>;
 
+/*!
+ * \brief Register the axis along which an operator concatenates its inputs, in order, into its
+ *  only output, given the number of dimensions of the output. Returns -1 when it does not.
+ *  When the axes before it have one element the slices of the output are contiguous, and the
+ *  memory planner may let the producers of the inputs write them in place. The operator must
+ *  then not copy the inputs already in their slice.
+ *
+ * \note Register under "FConcatAxis"
+ */
+using FConcatAxis = std::function<int(const NodeAttrs& attrs, int ndim)>;
+
+/*!
+ * \brief Register the axis along which an operator splits its only input, in order, into its
+ *  outputs, given the number of dimensions of the input. Returns -1 when it does not.
+ *  When the axes before it have one element the memory planner may make the outputs views of
+ *  the input. The operator must then not copy the outputs already in their slice.
+ *
+ * \note Register under "FSplitAxis"
+ */
+using FSplitAxis = std::function<int(const NodeAttrs& attrs, int ndim)>;
+
 #if MXNET_USE_CUDA
 
 /*!
@@ -24,8 +24,11 @@
 #ifndef MXNET_RANDOM_GENERATOR_H_
 #define MXNET_RANDOM_GENERATOR_H_
 
+#include <cmath>
+#include <limits>
 #include <random>
 #include <new>
+#include <type_traits>
 #include "./base.h"
 
 #if MXNET_USE_CUDA
@@ -40,6 +43,55 @@ namespace random {
 template <typename Device, typename DType MSHADOW_DEFAULT_DTYPE>
 class RandGenerator;
 
+/*!
+ * \brief Philox-4x32-10 counter-based generator, the one curand uses on GPU. A block of 4 numbers
+ *  is a function of the key and the counter only, so any part of a stream is computed without
+ *  its previous numbers. Generate computes kLanes consecutive blocks in a loop over the lanes,
+ *  which the compiler vectorizes for the SIMD width of the target (16 lanes fill AVX-512).
+ */
+struct Philox4x32 {
+  static const int kLanes     = 16;
+  static const int kBatchSize = 4 * kLanes;
+
+  /*!
+   * \brief the blocks of the counters (offset + l, subsequence) for l in [0, kLanes)
+   * \param out kBatchSize numbers, the 4 numbers of each block in turn
+   */
+  MSHADOW_XINLINE static void Generate(uint32_t seed,
+                                       uint64_t subsequence,
+                                       uint64_t offset,
+                                       uint32_t* out) {
+    uint32_t c0[kLanes], c1[kLanes], c2[kLanes], c3[kLanes];
+    for (int l = 0; l < kLanes; ++l) {
+      uint32_t x0 = static_cast<uint32_t>(offset + l);
+      uint32_t x1 = static_cast<uint32_t>((offset + l) >> 32);
+      uint32_t x2 = static_cast<uint32_t>(subsequence);
+      uint32_t x3 = static_cast<uint32_t>(subsequence >> 32);
+      uint32_t k0 = seed, k1 = 0;
+      for (int round = 0; round < 10; ++round) {
+        const uint64_t p0 = static_cast<uint64_t>(0xD2511F53U) * x0;
+        const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57U) * x2;
+        x0                = static_cast<uint32_t>(p1 >> 32) ^ x1 ^ k0;
+        x1                = static_cast<uint32_t>(p1);
+        x2                = static_cast<uint32_t>(p0 >> 32) ^ x3 ^ k1;
+        x3                = static_cast<uint32_t>(p0);
+        k0 += 0x9E3779B9U;
+        k1 += 0xBB67AE85U;
+      }
+      c0[l] = x0;
+      c1[l] = x1;
+      c2[l] = x2;
+      c3[l] = x3;
+    }
+    for (int l = 0; l < kLanes; ++l) {
+      out[4 * l]     = c0[l];
+      out[4 * l + 1] = c1[l];
+      out[4 * l + 2] = c2[l];
+      out[4 * l + 3] = c3[l];
+    }
+  }
+};
+
 template <typename DType>
 class RandGenerator<cpu, DType> {
  public:
@@ -49,53 +101,104 @@ class RandGenerator<cpu, DType> {
   static const int kNumRandomStates;
 
   // implementation class for random number generator
+  // The numbers of a state are its Philox subsequence, with the offset of its next block kept
+  // in the generator, as the curand states on GPU. The samplers give each state a fixed range
+  // of the outputs, so the samples do not depend on the number of threads.
   // TODO(alexzai): move impl class to separate file - tracked in MXNET-948
   class Impl {
    public:
     typedef
         typename std::conditional<std::is_floating_point<DType>::value, DType, double>::type FType;
     explicit Impl(RandGenerator<cpu, DType>* gen, int state_idx)
-        : engine_(gen->states_ + state_idx) {}
+        : gen_(gen), state_idx_(state_idx), offset_(gen->offsets_[state_idx]) {}
+
+    ~Impl() {
+      gen_->offsets_[state_idx_] = offset_;
+    }
 
     Impl(const Impl&) = delete;
     Impl& operator=(const Impl&) = delete;
 
     MSHADOW_XINLINE int rand() {
-      return engine_->operator()();
+      return static_cast<int>(next());
     }
 
     MSHADOW_XINLINE int64_t rand_int64() {
-      return static_cast<int64_t>(engine_->operator()() << 31) + engine_->operator()();
+      const uint32_t hi = next();
+      const uint32_t lo = next();
+      return (static_cast<int64_t>(hi) << 31) + lo;
     }
 
     MSHADOW_XINLINE FType uniform() {
-      typedef typename std::conditional<std::is_integral<DType>::value,
-                                        std::uniform_int_distribution<DType>,
-                                        std::uniform_real_distribution<FType>>::type GType;
-      GType dist_uniform;
-      return dist_uniform(*engine_);
+      return uniform(std::is_integral<DType>());
     }
 
     MSHADOW_XINLINE FType normal() {
-      std::normal_distribution<FType> dist_normal;
-      return dist_normal(*engine_);
+      // Box-Muller, keeping the second number for the next call
+      if (has_normal_) {
+        has_normal_ = false;
+        return normal_;
+      }
+      const FType radius = std::sqrt(-2 * std::log(1 - uniform(std::false_type())));
+      const FType theta  = static_cast<FType>(6.283185307179586) * uniform(std::false_type());
+      normal_            = radius * std::sin(theta);
+      has_normal_        = true;
+      return radius * std::cos(theta);
     }
 
    private:
-    std::mt19937* engine_;
+    MSHADOW_XINLINE uint32_t next() {
+      if (pos_ == Philox4x32::kBatchSize) {
+        Philox4x32::Generate(gen_->seed_, state_idx_, offset_, buffer_);
+        offset_ += Philox4x32::kLanes;
+        pos_ = 0;
+      }
+      return buffer_[pos_++];
+    }
+
+    // in [0, 1)
+    MSHADOW_XINLINE FType uniform(std::false_type) {
+      if (sizeof(FType) == sizeof(float)) {
+        return static_cast<FType>(next() >> 8) * static_cast<FType>(1.0 / (1 << 24));
+      }
+      const uint64_t hi = next() >> 5;
+      const uint64_t lo = next() >> 6;
+      return static_cast<FType>((hi << 26) + lo) * static_cast<FType>(1.0 / (1ULL << 53));
+    }
+
+    // in [0, the largest DType], as std::uniform_int_distribution<DType>()
+    MSHADOW_XINLINE FType uniform(std::true_type) {
+      const uint64_t hi = next();
+      const uint64_t lo = next();
+      return static_cast<FType>(((hi << 32) | lo) &
+                                static_cast<uint64_t>(std::numeric_limits<DType>::max()));
+    }
+
+    RandGenerator<cpu, DType>* gen_;
+    int state_idx_;
+    uint64_t offset_;
+    uint32_t buffer_[Philox4x32::kBatchSize];
+    int pos_         = Philox4x32::kBatchSize;
+    bool has_normal_ = false;
+    FType normal_;
   };  // class RandGenerator<cpu, DType>::Impl
 
   static void AllocState(RandGenerator<cpu, DType>* inst) {
-    inst->states_ = new std::mt19937[kNumRandomStates];
+    inst->states_  = new std::mt19937[kNumRandomStates];
+    inst->offsets_ = new uint64_t[kNumRandomStates]();
   }
 
   static void FreeState(RandGenerator<cpu, DType>* inst) {
     delete[] inst->states_;
+    delete[] inst->offsets_;
   }
 
   MSHADOW_XINLINE void Seed(mshadow::Stream<cpu>*, uint32_t seed) {
-    for (int i = 0; i < kNumRandomStates; ++i)
+    seed_ = seed;
+    for (int i = 0; i < kNumRandomStates; ++i) {
       (states_ + i)->seed(seed + i);
+      offsets_[i] = 0;
+    }
   }
 
   // export global random states, used by c++ custom operator
@@ -104,7 +207,10 @@ class RandGenerator<cpu, DType> {
   }
 
  private:
+  // the std::mt19937 states are only those of the c++ custom operators
   std::mt19937* states_;
+  uint32_t seed_ = 0;
+  uint64_t* offsets_;
 };  // class RandGenerator<cpu, DType>
 
 template <typename DType>
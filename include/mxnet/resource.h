@@ -181,7 +181,7 @@ struct Resource {
       const std::string& name = MXNET_RESOURCE_DEFAULT_NAME_FARG("temp_space")) const {
     CHECK_EQ(req.type, ResourceRequest::kTempSpace);
     return mshadow::Tensor<xpu, ndim, DType>(
-        reinterpret_cast<DType*>(get_space_internal(shape.Size() * sizeof(DType), name)),
+        reinterpret_cast<DType*>(get_space_internal(shape.Size() * sizeof(DType), name, stream)),
         shape,
         shape[ndim - 1],
         stream);
@@ -224,9 +224,13 @@ struct Resource {
    * \brief internal function to get space from resources.
    * \param size the Size of the space.
    * \param name the Name of the operator requesting the resource.
+   * \param stream the stream using the space, which selects the space of a resource without
+   *        engine variable.
    * \return The allocated space.
    */
-  void* get_space_internal(size_t size, const std::string& name) const;
+  void* get_space_internal(size_t size,
+                           const std::string& name,
+                           const void* stream = nullptr) const;
   /*!
    * \brief internal function to get cpu space from resources.
    * \param size The size of space.
@@ -247,6 +251,16 @@ class ResourceManager {
    *       still hold by the manager singleton.
    */
   virtual Resource Request(Context ctx, const ResourceRequest& req) = 0;
+  /*!
+   * \brief Get the temporary space of an operator pushed to the engine by an executor.
+   *  With MXNET_STREAM_TEMP_SPACE, the space comes from an arena of the thread and the stream
+   *  running the operator, and the resource has no engine variable (var is nullptr), so that the
+   *  operators using temporary space do not depend on each other. Otherwise this is
+   *  Request(ctx, ResourceRequest::kTempSpace).
+   * \param ctx the context of the request.
+   * \return the requested resource, whose variable must only be pushed when not nullptr.
+   */
+  virtual Resource RequestOpTempSpace(Context ctx) = 0;
   /*!
    * \brief Seed all the allocated random number generators.
    * \param seed the seed to the random number generators on all devices.
@@ -26,6 +26,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include "./base.h"
 
@@ -48,6 +49,11 @@ class Storage {
      * \brief All the events from the engine variable.
      */
     std::vector<std::weak_ptr<cudaEvent_t>> events;
+    /*!
+     * \brief Stream and event pool index of each entry in events, if known.
+     *  Needed to turn a pending reuse into a device-side dependency.
+     */
+    std::vector<std::pair<cudaStream_t, uint64_t>> event_streams;
 #endif
   };
   /*!
@@ -71,6 +77,11 @@ class Storage {
      */
     int shared_pid{-1};
     int shared_id{-1};
+    /*!
+     * \brief Byte offset of the block holding the data in its shared memory segment, 0 when
+     *  the segment holds only this data.
+     */
+    size_t shared_offset{0};
     /*!
      * \brief Attributes for tracking storage allocations.
      */
@@ -81,6 +92,13 @@ class Storage {
      * and the storage manager.
      */
     SyncObj sync_obj;
+    /*!
+     * \brief If true, a pooled GPU storage manager may hand out memory whose previous
+     *  users are still running on the device instead of waiting for them on the host.
+     *  Their events are returned in sync_obj and the caller must make its consumers
+     *  wait for them.
+     */
+    bool stream_ordered{false};
   };
   /*!
    * \brief Allocate a new contiguous memory for a given size.
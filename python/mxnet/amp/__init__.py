@@ -20,3 +20,4 @@
 """Automatic mixed precision module."""
 
 from .amp import *
+from .fp8_scaler import *
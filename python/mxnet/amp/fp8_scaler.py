@@ -0,0 +1,93 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# coding: utf-8
+"""Delayed scaling of the FP8 casts of a tensor."""
+
+from .. import autograd as ag
+from .. import ndarray
+from ..util import is_np_array
+
+__all__ = ['FP8DelayedScaler']
+
+
+class FP8DelayedScaler(object):
+    """Delayed scaling of the FP8 casts of one tensor, such as the input or the weight of a
+    FullyConnected layer: each cast uses the scale computed from the amax of the previous
+    steps, and `update` pushes the amax of the current step.
+
+    Parameters
+    ----------
+    fp8_format : {'e4m3', 'e5m2'}, default 'e4m3'
+        FP8 format of the tensor.
+    amax_history_len : int, default 1024
+        Number of steps the scale is computed from.
+    margin : int, default 0
+        The scale maps the amax to the maximum of the format divided by 2^margin.
+    amax_compute_algo : {'max', 'most_recent'}, default 'max'
+        Amax the scale is computed from.
+
+    Properties
+    ----------
+    scale : NDArray
+        The scale of the next cast, float32 of shape (1,)
+    """
+    def __init__(self, fp8_format='e4m3', amax_history_len=1024, margin=0,
+                 amax_compute_algo='max'):
+        self._fp8_format = fp8_format
+        self._amax_history_len = amax_history_len
+        self._margin = margin
+        self._amax_compute_algo = amax_compute_algo
+        self._scale = None
+        self._amax_history = None
+        self._amax = None
+
+    @property
+    def scale(self):
+        return self._scale
+
+    def _ops(self):
+        if is_np_array():
+            return (ndarray.numpy_extension.fp8_cast, ndarray.numpy_extension.fp8_scale_update,
+                    lambda ctx: ndarray.numpy.ones((1,), device=ctx),
+                    lambda n, ctx: ndarray.numpy.zeros((n,), device=ctx))
+        return (ndarray.contrib.fp8_cast, ndarray.contrib.fp8_scale_update,
+                lambda ctx: ndarray.ones((1,), ctx=ctx),
+                lambda n, ctx: ndarray.zeros((n,), ctx=ctx))
+
+    def cast(self, data):
+        """Round the data to the FP8 format with the current scale, the gradient goes
+        straight through. The amax of the data is kept for `update`."""
+        fp8_cast, _, ones_f, zeros_f = self._ops()
+        if self._scale is None:
+            self._scale = ones_f(data.context)
+            self._amax_history = zeros_f(self._amax_history_len, data.context)
+        out, amax = fp8_cast(data, self._scale, fp8_format=self._fp8_format)
+        self._amax = amax
+        return out
+
+    def update(self):
+        """Push the amax of the last cast into the history and compute the scale of the next
+        step. Call it once per step, after the backward pass."""
+        if self._amax is None:
+            return
+        _, fp8_scale_update, _, _ = self._ops()
+        with ag.pause():
+            fp8_scale_update(self._amax, self._amax_history, self._scale,
+                             fp8_format=self._fp8_format, margin=self._margin,
+                             amax_compute_algo=self._amax_compute_algo, out=self._scale)
+        self._amax = None
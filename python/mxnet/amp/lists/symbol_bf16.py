@@ -73,6 +73,21 @@ BF16_FP32_FUNCS = [
     'stack',
     'space_to_depth',
     '_split_v2',
+    'Embedding',
+    # exact or rounded once in bfloat16:
+    'relu',
+    '_npx_relu',
+    'max',
+    'min',
+    '_npi_max',
+    '_npi_min',
+    '_npi_broadcast_to',
+    '_plus_scalar',
+    '_mul_scalar',
+    '_div_scalar',
+    '_npi_add_scalar',
+    '_npi_multiply_scalar',
+    '_npi_true_divide_scalar',
 
     # no oneDNN support:
     'Cast',
@@ -124,7 +139,6 @@ FP32_FUNCS = [
     'Crop',
     'Custom',
     'Dropout',
-    'Embedding',
     'GridGenerator',
     'GroupNorm',
     'IdentityAttachKLSparseReg',
@@ -232,7 +246,6 @@ FP32_FUNCS = [
     '_cvimdecode',
     '_cvimread',
     '_cvimresize',
-    '_div_scalar',
     '_equal',
     '_equal_scalar',
     '_eye',
@@ -264,6 +277,7 @@ FP32_FUNCS = [
     '_image_random_saturation',
     '_image_resize',
     '_image_to_tensor',
+    '_image_to_tensor_normalize',
     '_imdecode',
     '_lesser',
     '_lesser_equal',
@@ -302,7 +316,6 @@ FP32_FUNCS = [
     '_mod_scalar',
     '_mp_adabelief_update',
     '_mp_adamw_update',
-    '_mul_scalar',
     '_multi_adabelief_update',
     '_multi_adamw_update',
     '_multi_lamb_update',
@@ -315,7 +328,6 @@ FP32_FUNCS = [
     '_not_equal_scalar',
     '_np_reshape',
     '_npi_absolute',
-    '_npi_add_scalar',
     '_npi_advanced_indexing',
     '_npi_advanced_indexing_multiple',
     '_npi_all',
@@ -352,7 +364,6 @@ FP32_FUNCS = [
     '_npi_blackman',
     '_npi_boolean_mask_assign_scalar',
     '_npi_boolean_mask_assign_tensor',
-    '_npi_broadcast_to',
     '_npi_cbrt',
     '_npi_ceil',
     '_npi_choice',
@@ -453,13 +464,10 @@ FP32_FUNCS = [
     '_npi_matmul',
     '_npi_matrix_rank',
     '_npi_matrix_rank_none_tol',
-    '_npi_max',
-    '_npi_min',
     '_npi_mod',
     '_npi_mod_scalar',
     '_npi_moveaxis',
     '_npi_multinomial',
-    '_npi_multiply_scalar',
     '_npi_nan_to_num',
     '_npi_negative',
     '_npi_norm',
@@ -517,7 +525,6 @@ FP32_FUNCS = [
     '_npi_tril',
     '_npi_tril_indices',
     '_npi_triu',
-    '_npi_true_divide_scalar',
     '_npi_trunc',
     '_npi_uniform',
     '_npi_uniform_n',
@@ -539,12 +546,10 @@ FP32_FUNCS = [
     '_npx_nonzero',
     '_npx_quantized_reshape',
     '_npx_quantized_transpose',
-    '_npx_relu',
     '_npx_sigmoid',
     '_npx_while_loop',
     '_onehot_encode',
     '_ones',
-    '_plus_scalar',
     '_power',
     '_power_scalar',
     '_random_binomial',
@@ -670,8 +675,6 @@ FP32_FUNCS = [
     'logical_not',
     'make_loss',
     'masked_log_softmax',
-    'max',
-    'min',
     'mish',
     'moments',
     'mp_lamb_update_phase1',
@@ -702,7 +705,6 @@ FP32_FUNCS = [
     'radians',
     'rcbrt',
     'reciprocal',
-    'relu',
     'repeat',
     'reset_arrays',
     'reshape_like',
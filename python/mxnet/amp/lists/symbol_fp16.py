@@ -150,6 +150,7 @@ FP16_FP32_FUNCS = [
     '_image_random_saturation',
     '_image_resize',
     '_image_to_tensor',
+    '_image_to_tensor_normalize',
     '_imdecode',
     '_lesser_scalar',
     '_lesser_equal_scalar',
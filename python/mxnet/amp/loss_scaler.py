@@ -60,6 +60,12 @@ class LossScaler(object):
                              num_arrays=len(valid_params[idx:idx+chunk_size]),
                              init_output=False, out=gpu_output)
         has_overflow = not bool(gpu_output.asnumpy())
+        self.update_scale(has_overflow)
+        return has_overflow
+
+    def update_scale(self, has_overflow):
+        """Updates the loss scale after a step whose gradients are checked for overflow
+        by the caller, e.g. with the global norm computed by `multi_global_norm`."""
         self._loss_scale = self._next_loss_scale
         if has_overflow:
             self._next_loss_scale = self._loss_scale / 2.
@@ -71,4 +77,3 @@ class LossScaler(object):
             self._unskipped = 0
             self._next_loss_scale = min(self._max_loss_scale, self._loss_scale * 2.)
             logging.info("AMP: increasing loss scale to %f", self._next_loss_scale)
-        return has_overflow
@@ -18,6 +18,7 @@
 
 import abc
 import ctypes
+import json
 import logging
 import os
 import warnings
@@ -104,7 +105,7 @@ def _quantize_params(qsym, params, min_max_dict):
 
 def _quantize_symbol(sym, device, excluded_symbols=None, excluded_operators=None,
                      offline_params=None, quantized_dtype='int8', quantize_mode='smart',
-                     quantize_granularity='tensor-wise'):
+                     quantize_granularity='tensor-wise', weight_group_size=None):
     """Given a symbol object representing a neural network of data type FP32,
     quantize it into a INT8 network.
 
@@ -129,9 +130,14 @@ def _quantize_symbol(sym, device, excluded_symbols=None, excluded_operators=None
     quantize_mode : str
         The mode that quantization pass to apply.
     quantize_granularity : str
-        The granularity of quantization, currently supports 'tensor-wise' and 'channel-wise'
-        quantization. The default value is 'tensor-wise'.
+        The granularity of quantization, currently supports 'tensor-wise', 'channel-wise' and
+        'group-wise' quantization. The default value is 'tensor-wise'.
+    weight_group_size : int
+        For 'group-wise' quantization, the number of input features of the weights that share
+        a scale.
     """
+    if quantize_granularity == 'group-wise':
+        quantize_granularity = f'group-wise:{weight_group_size}'
     num_excluded_symbols = 0
     if excluded_symbols is not None:
         assert isinstance(excluded_symbols, list)
@@ -183,6 +189,7 @@ class CalibrationCollector(object):
     def __init__(self):
         self.include_layers = None
         self.min_max_dict = {}
+        self.num_passes = 1
 
     @abc.abstractmethod
     def collect(self, name, op_name, arr):
@@ -200,6 +207,11 @@ class CalibrationCollector(object):
             NDArray containing data of monitored node.
         """
 
+    def next_pass(self):
+        """Function called before each pass over the calibration data after the first one, for
+        collectors setting `self.num_passes` above 1.
+        """
+
     def post_collect(self):
         """ Function called after collecting parameters. Returns dictionary of min and max values
         for each calibrated layer. If not overriden, returns content of `self.min_max_dict`.
@@ -211,6 +223,10 @@ class _LayerHistogramCollector(CalibrationCollector):
     """Saves layer histogram in a dict with layer names as keys and lists of NDArrays as
     values. The collected histogram will be used for calculating the optimal thresholds for
     quantization using KL divergence.
+
+    The calibration data is run twice: the first pass takes the min and max values of the
+    layers, the second accumulates their histograms over that range with `calib_histogram`.
+    Both stay on the device of the layers until `post_collect`.
     """
     def __init__(self, quantized_dtype, num_bins=8001, include_layers=None, logger=None):
         super(_LayerHistogramCollector, self).__init__()
@@ -219,24 +235,60 @@ class _LayerHistogramCollector(CalibrationCollector):
         self.include_layers = include_layers
         self.logger = logger
         self.quantized_dtype = quantized_dtype
+        self.num_passes = 2
+        self._pass = 0
+        self._min_max_arrays = {}
+        self._hist_arrays = {}
 
     def collect(self, name, op_name, arr):
         """Callback function for collecting layer output NDArrays."""
         if name not in self.include_layers:
             return
-        arr = arr.copyto(cpu()).asnumpy()
-        if self.logger:
-            self.logger.debug(f"Collecting layer {name} histogram of shape {arr.shape}")
-        min_range = np.min(arr)
-        max_range = np.max(arr)
-        th = max(abs(min_range), abs(max_range))
-        if name in self.hist_dict:
-            self.hist_dict[name] = self.combine_histogram(self.hist_dict[name], arr, min_range, max_range, th)
-        else:
-            hist, hist_edges = np.histogram(arr, bins=self.num_bins, range=(-th, th))
-            self.hist_dict[name] = (hist, hist_edges, min_range, max_range, th)
+        if self._pass == 0:
+            min_range = ndarray.min(arr).astype('float32')
+            max_range = ndarray.max(arr).astype('float32')
+            if name in self._min_max_arrays:
+                cur_min, cur_max = self._min_max_arrays[name]
+                min_range = ndarray.minimum(cur_min, min_range)
+                max_range = ndarray.maximum(cur_max, max_range)
+            self._min_max_arrays[name] = (min_range, max_range)
+        elif name in self.hist_dict:
+            if self.logger:
+                self.logger.debug(f"Collecting layer {name} histogram of shape {arr.shape}")
+            hist = self._hist_arrays[name]
+            ndarray.contrib.calib_histogram(arr, hist, max_range=self.hist_dict[name][4],
+                                            out=hist)
+
+    def next_pass(self):
+        """Take the ranges of the histograms from the min and max values of the first pass."""
+        self._pass += 1
+        names = list(self._min_max_arrays.keys())
+        if not names:
+            return
+        min_max = ndarray.concat(*[ndarray.concat(*self._min_max_arrays[name], dim=0)
+                                   .as_in_context(cpu()) for name in names], dim=0).asnumpy()
+        for i, name in enumerate(names):
+            min_range, max_range = float(min_max[2 * i]), float(min_max[2 * i + 1])
+            th = max(abs(min_range), abs(max_range))
+            # as np.histogram does for an empty range
+            th = th if th > 0 else 0.5
+            device = self._min_max_arrays[name][0].context
+            self._hist_arrays[name] = ndarray.zeros((self.num_bins,), ctx=device)
+            self.hist_dict[name] = (None, np.linspace(-th, th, self.num_bins + 1),
+                                    min_range, max_range, th)
+        self._min_max_arrays = {}
 
     def post_collect(self):
+        if self._pass == 0:
+            # the data was run once, without histograms there are only the min and max values
+            warnings.warn('entropy calibration needs two passes over the calibration data,'
+                          ' falling back to the min and max values of the layers')
+            return {name: (float(min_range.asscalar()), float(max_range.asscalar()))
+                    for name, (min_range, max_range) in self._min_max_arrays.items()}
+        for name, hist in self._hist_arrays.items():
+            _, hist_edges, min_range, max_range, th = self.hist_dict[name]
+            self.hist_dict[name] = (hist.asnumpy(), hist_edges, min_range, max_range, th)
+        self._hist_arrays = {}
         min_max_dict = self.get_optimal_thresholds(self.hist_dict, self.quantized_dtype, logger=self.logger)
         return min_max_dict
 
@@ -285,26 +337,37 @@ class _LayerHistogramCollector(CalibrationCollector):
 
     @staticmethod
     def get_optimal_thresholds(hist_dict, quantized_dtype, num_quantized_bins=255, logger=None):
-        """Given a ndarray dict, find the optimal threshold for quantizing each value of the key."""
+        """Given a ndarray dict, find the optimal threshold for quantizing each value of the key.
+        The layers whose histograms have the same number of bins are searched in one call of
+        `calibrate_entropy`, in parallel."""
         assert isinstance(hist_dict, dict)
         if logger is not None:
             logger.info('Calculating optimal thresholds for quantization using KL divergence'
                         f' with num_quantized_bins={num_quantized_bins}')
+        groups = {}
+        for name, (hist, _, min_val, _, _) in hist_dict.items():
+            # We need to move negative bins to positive bins to fit uint8 range.
+            unsigned = min_val >= 0 and quantized_dtype in ['auto', 'uint8']
+            group_bins = num_quantized_bins * 2 + 1 if unsigned else num_quantized_bins
+            groups.setdefault((len(hist), group_bins), []).append(name)
         th_dict = {}
-        # copy hist_dict keys since the keys() only returns a view in python3
-        layer_names = list(hist_dict.keys())
-        for name in layer_names:
-            assert name in hist_dict
-            min_val, max_val, th, divergence = \
-                _LayerHistogramCollector.get_optimal_threshold(hist_dict[name], quantized_dtype,
-                                                               num_quantized_bins=num_quantized_bins)
-            if min_val >= 0 and quantized_dtype in ['auto', 'uint8']:
-                th_dict[name] = (0, th)
-            else:
-                th_dict[name] = (-th, th)
-            del hist_dict[name]  # release the memory
-            if logger:
-                logger.debug(f"layer={name}, min_val={min_val}, max_val={max_val}, th={th}, divergence={divergence}")
+        for (_, group_bins), names in groups.items():
+            hist = ndarray.array(np.stack([hist_dict[name][0] for name in names]),
+                                 ctx=cpu(), dtype='float32')
+            hist_edges = ndarray.array(np.stack([hist_dict[name][1] for name in names]),
+                                       ctx=cpu(), dtype='float32')
+            thresholds, divergences = ndarray.contrib.calibrate_entropy(
+                hist=hist, hist_edges=hist_edges, num_quantized_bins=group_bins)
+            for name, th, divergence in zip(names, thresholds.asnumpy(), divergences.asnumpy()):
+                min_val, max_val = hist_dict[name][2], hist_dict[name][3]
+                th = float(th)
+                if min_val >= 0 and quantized_dtype in ['auto', 'uint8']:
+                    th_dict[name] = (0, th)
+                else:
+                    th_dict[name] = (-th, th)
+                del hist_dict[name]  # release the memory
+                if logger:
+                    logger.debug(f"layer={name}, min_val={min_val}, max_val={max_val}, th={th}, divergence={divergence}")
         return th_dict
 
 
@@ -365,15 +428,20 @@ def _collect_layer_statistics(sym_block, data, collector, num_inputs, num_calib_
     if not isinstance(data, mx.gluon.data.DataLoader):
         raise ValueError(f'Only supports data as a type of DataLoader, while received type {str(type(data))}')
     sym_block.register_op_hook(collector.collect, monitor_all=True)
-    num_batches = 0
-    for batch in data:
-        if not isinstance(batch, list):
-            batch = [batch]
-        batch = _multilist_iterator(batch, lambda b: b.as_in_context(mx.cpu()))
-        sym_block(*batch[:num_inputs])
-        num_batches += 1
-        if num_calib_batches is not None and num_batches >= num_calib_batches:
-            break
+    # collectors such as the histogram one run the calibration data more than once
+    num_passes = getattr(collector, 'num_passes', 1)
+    for i in range(num_passes):
+        if i > 0:
+            collector.next_pass()
+        num_batches = 0
+        for batch in data:
+            if not isinstance(batch, list):
+                batch = [batch]
+            batch = _multilist_iterator(batch, lambda b: b.as_in_context(mx.cpu()))
+            sym_block(*batch[:num_inputs])
+            num_batches += 1
+            if num_calib_batches is not None and num_batches >= num_calib_batches:
+                break
     if logger is not None:
         logger.info(f"Collected statistics from {num_batches} batches")
     return num_batches
@@ -614,7 +682,7 @@ def quantize_graph(sym, arg_params, aux_params, device=cpu(),
                    excluded_sym_names=None, excluded_op_names=None,
                    calib_mode='entropy', quantized_dtype='int8',
                    quantize_mode='full', quantize_granularity='tensor-wise',
-                   LayerOutputCollector=None, logger=None):
+                   LayerOutputCollector=None, logger=None, weight_group_size=128):
     """User-level API for generating a quantized model from a FP32 model w/o calibration
     and a collector for naive or entropy calibration.
     The backend quantized operators are only enabled for Linux systems. Please do not run
@@ -655,13 +723,21 @@ def quantize_graph(sym, arg_params, aux_params, device=cpu(),
         'full' means quantize all operator if possible.
         'smart' means quantization pass will smartly choice which operator should be quantized.
     quantize_granularity : str
-        The granularity of quantization, currently supports 'tensor-wise' and 'channel-wise'
-        quantization. The default value is 'tensor-wise'.
+        The granularity of quantization, currently supports 'tensor-wise', 'channel-wise' and
+        'group-wise' quantization. The default value is 'tensor-wise'.
+        'channel-wise' quantizes the weights of the FullyConnected layers with one scale per
+        output channel. 'group-wise' also splits the input features of each output channel
+        into groups of `weight_group_size` with a scale each. Convolution weights always have
+        one scale per output channel when their output is requantized or dequantized.
     LayerOutputCollector : subclass of CalibrationCollector
         For custom calibration method usage.
         Passed object's include_layers attribute will be feed with names of layers which needs calibration
     logger : Object
         A logging object for printing information during the process of quantization.
+    weight_group_size : int
+        For 'group-wise' quantization, the number of consecutive input features of the weights
+        of each output channel that share a scale. Layers whose number of input features is
+        not a multiple of it have one scale per output channel.
     Returns
     -------
     quantized_model : tuple
@@ -681,15 +757,18 @@ def quantize_graph(sym, arg_params, aux_params, device=cpu(),
     if quantized_dtype not in ('int8', 'uint8', 'auto'):
         raise ValueError(f'unknown quantized_dtype {quantized_dtype} received,'
                          ' expected `int8`, `uint8` or `auto`')
-    if quantize_granularity not in ('tensor-wise', 'channel-wise'):
+    if quantize_granularity not in ('tensor-wise', 'channel-wise', 'group-wise'):
         raise ValueError(f'unkonwn quantize_granularity {quantize_granularity} received,'
-                         ' expected `tensor-wise` or `channel-wise`.')
+                         ' expected `tensor-wise`, `channel-wise` or `group-wise`.')
+    if quantize_granularity == 'group-wise' and weight_group_size <= 0:
+        raise ValueError(f'weight_group_size must be positive, while received {weight_group_size}')
     qsym, calib_layers = _quantize_symbol(sym, device, excluded_symbols=excluded_sym_names,
                                           excluded_operators=excluded_op_names,
                                           offline_params=list(arg_params.keys()),
                                           quantized_dtype=quantized_dtype,
                                           quantize_mode=quantize_mode,
-                                          quantize_granularity=quantize_granularity)
+                                          quantize_granularity=quantize_granularity,
+                                          weight_group_size=weight_group_size)
 
     collector = None
     if calib_mode is not None and calib_mode != 'none':
@@ -795,11 +874,203 @@ def calib_graph(qsym, arg_params, aux_params, collector,
 
     return qsym, qarg_params, aux_params
 
+
+_QAT_OPS = ('Convolution', 'FullyConnected')
+
+
+def _link_graph(sym):
+    """Load the json graph of a symbol, with the node entries pointing to the node dicts so
+    that nodes can be inserted and removed."""
+    graph = json.loads(sym.tojson())
+    nodes = graph['nodes']
+    for node in nodes:
+        node['inputs'] = [[nodes[e[0]]] + e[1:] for e in node['inputs']]
+    graph['heads'] = [[nodes[e[0]]] + e[1:] for e in graph['heads']]
+    return graph
+
+
+def _graph_to_symbol(graph, heads=None):
+    """Build the symbol of the nodes of a linked graph leading to the heads, by default the
+    heads of the graph."""
+    heads = graph['heads'] if heads is None else heads
+    order, ids = [], {}
+    for head in heads:
+        stack = [(head[0], False)]
+        while stack:
+            node, visited = stack.pop()
+            if id(node) in ids:
+                continue
+            if visited:
+                ids[id(node)] = len(order)
+                order.append(node)
+            else:
+                stack.append((node, True))
+                stack.extend((e[0], False) for e in reversed(node['inputs'])
+                             if id(e[0]) not in ids)
+    nodes = [dict(node, inputs=[[ids[id(e[0])]] + e[1:] for e in node['inputs']])
+             for node in order]
+    out = {'nodes': nodes,
+           'arg_nodes': [i for i, node in enumerate(nodes) if node['op'] == 'null'],
+           'heads': [[ids[id(e[0])]] + e[1:] for e in heads],
+           'attrs': graph.get('attrs', {})}
+    return mx.sym.load_json(json.dumps(out))
+
+
+def _graph_consumers(graph):
+    """Map the id of each node to its (consumer, entry) pairs, with None for the heads."""
+    consumers = {id(node): [] for node in graph['nodes']}
+    for node in graph['nodes']:
+        for e in node['inputs']:
+            consumers[id(e[0])].append((node, e))
+    for e in graph['heads']:
+        consumers[id(e[0])].append((None, e))
+    return consumers
+
+
+def _entry_name(graph, entry):
+    """Name of a node entry, as used for the keys of the calibration table."""
+    return _graph_to_symbol(graph, heads=[entry]).list_outputs()[0]
+
+
+def _is_true(value):
+    return value in ('True', 'true', '1')
+
+
+def _fold_batch_norm(graph, args, auxs):
+    """Fold the BatchNorm layers that follow a Convolution into its weight and bias, with the
+    moving statistics, so that quantization-aware training sees the weights of inference."""
+    arr_fn = mx.np if is_np_array() else mx.nd
+    consumers = _graph_consumers(graph)
+    removed = set()
+    for bn in graph['nodes']:
+        if bn['op'] != 'BatchNorm':
+            continue
+        attrs = bn.get('attrs', {})
+        conv, index = bn['inputs'][0][0], bn['inputs'][0][1]
+        params = [e[0] for e in bn['inputs'][1:]]
+        if conv['op'] != 'Convolution' or index != 0 or len(consumers[id(conv)]) != 1 or \
+                int(attrs.get('axis', 1)) != 1 or any(e[1] != 0 for _, e in consumers[id(bn)]):
+            continue
+        if any(p['op'] != 'null' or (p['name'] not in args and p['name'] not in auxs)
+               or len(consumers[id(p)]) != 1 for p in params):
+            continue
+        conv_attrs = conv.setdefault('attrs', {})
+        layout = conv_attrs.get('layout', 'None')
+        if layout != 'None' and not layout.startswith('NC'):
+            continue
+        weight = conv['inputs'][1][0]
+        no_bias = _is_true(conv_attrs.get('no_bias', 'False'))
+        bias = None if no_bias else conv['inputs'][2][0]
+        if any(p['op'] != 'null' or p['name'] not in args or len(consumers[id(p)]) != 1
+               for p in [weight] + ([] if no_bias else [bias])):
+            continue
+
+        gamma, beta, mean, var = [(args if p['name'] in args else auxs)[p['name']].asnumpy()
+                                  for p in params]
+        if _is_true(attrs.get('fix_gamma', 'True')):
+            gamma = np.ones_like(gamma)
+        factor = gamma / np.sqrt(var + float(attrs.get('eps', 1e-3)))
+        w = args[weight['name']].asnumpy()
+        args[weight['name']] = arr_fn.array(
+            w * factor.reshape((-1,) + (1,) * (w.ndim - 1)), dtype=w.dtype)
+        if no_bias:
+            bias = {'op': 'null', 'name': conv['name'] + '_bias', 'inputs': []}
+            graph['nodes'].append(bias)
+            conv['inputs'].append([bias, 0, 0])
+            conv_attrs['no_bias'] = 'False'
+            b = np.zeros(factor.shape, dtype=w.dtype)
+        else:
+            b = args[bias['name']].asnumpy()
+        args[bias['name']] = arr_fn.array((b - mean) * factor + beta, dtype=w.dtype)
+
+        for _, e in consumers[id(bn)]:
+            e[0] = conv
+        consumers[id(conv)] = consumers[id(bn)]
+        removed.add(id(bn))
+        for p in params:
+            removed.add(id(p))
+            (args if p['name'] in args else auxs).pop(p['name'])
+    graph['nodes'] = [node for node in graph['nodes'] if id(node) not in removed]
+
+
+def _fake_quantize_range(quantized_dtype):
+    return (0., 255.) if quantized_dtype == 'uint8' else (-127., 127.)
+
+
+def _strip_fake_quantize(sym, args):
+    """Remove the fake_quantize nodes of a network trained with quantization-aware training.
+    The weights are replaced by their fake-quantized values and the trained scales of the
+    data give the calibration table of the quantized graph.
+
+    Returns
+    -------
+    tuple
+        The symbol without fake_quantize nodes, and the dict of the min and max thresholds of
+        the quantized inputs.
+    """
+    arr_fn = mx.np if is_np_array() else mx.nd
+    graph = _link_graph(sym)
+    consumers = _graph_consumers(graph)
+    min_max_dict = {}
+    removed = set()
+    for fq in graph['nodes']:
+        if fq['op'] != '_contrib_fake_quantize':
+            continue
+        attrs = fq.get('attrs', {})
+        qmin, qmax = _fake_quantize_range(attrs.get('quantized_dtype', 'int8'))
+        entry, scale_node = fq['inputs'][0], fq['inputs'][1][0]
+        if scale_node['op'] != 'null' or scale_node['name'] not in args:
+            raise ValueError(f'the scale of {fq["name"]} has to be a parameter')
+        scale = args.pop(scale_node['name']).asnumpy().astype(np.float32)
+        src = entry[0]
+        if src['op'] == 'null' and src['name'] in args:
+            # a weight, which the offline quantization takes on the grid it was trained on
+            w = args[src['name']].asnumpy()
+            axis = attrs.get('axis', 'None')
+            if axis != 'None':
+                shape = [1] * w.ndim
+                shape[int(axis)] = -1
+                scale = scale.reshape(shape)
+            args[src['name']] = arr_fn.array(
+                np.clip(np.rint(w / scale), qmin, qmax) * scale, dtype=w.dtype)
+        else:
+            th = (qmin * float(scale.max()), qmax * float(scale.max()))
+            if src['op'] == 'null':
+                # the quantize node of a network input is named after its consumer
+                keys = [f'{node["name"]}_{name}' for node, _ in consumers[id(fq)]
+                        if node is not None for name in (src['name'], 'data')]
+            else:
+                keys = [_entry_name(graph, entry)]
+            for key in keys:
+                if key in min_max_dict:
+                    # an entry quantized once for several consumers takes the widest range
+                    th = (min(th[0], min_max_dict[key][0]), max(th[1], min_max_dict[key][1]))
+                min_max_dict[key] = th
+        for _, e in consumers[id(fq)]:
+            e[:] = list(entry)
+        consumers[id(src)] += consumers[id(fq)]
+        removed.update((id(fq), id(scale_node)))
+    graph['nodes'] = [node for node in graph['nodes'] if id(node) not in removed]
+    return _graph_to_symbol(graph), min_max_dict
+
+
+class _FakeQuantizeCollector(CalibrationCollector):
+    """Gives the thresholds of the inputs trained with fake quantization, no data is
+    collected.
+    """
+    def __init__(self, min_max_dict):
+        super(_FakeQuantizeCollector, self).__init__()
+        self.min_max_dict = min_max_dict
+
+    def collect(self, name, op_name, arr):
+        """Nothing to collect, the thresholds come from the trained scales."""
+
 @wrap_ctx_to_device_func
 def quantize_net(network, quantized_dtype='auto', quantize_mode='full', quantize_granularity='tensor-wise',
                  exclude_layers=None, exclude_layers_match=None, exclude_operators=None,
                  calib_data=None, data_shapes=None, calib_mode='none',
-                 num_calib_batches=None, device=cpu(), LayerOutputCollector=None, logger=None):
+                 num_calib_batches=None, device=cpu(), LayerOutputCollector=None, logger=None,
+                 weight_group_size=128):
     """User-level API for Gluon users to generate a quantized SymbolBlock from a FP32 HybridBlock w/ or w/o calibration.
     The backend quantized operators are only enabled for Linux systems. Please do not run
     inference using the quantized models on Windows for now.
@@ -817,8 +1088,11 @@ def quantize_net(network, quantized_dtype='auto', quantize_mode='full', quantize
         'full' means quantize all operator if possible.
         'smart' means quantization pass will smartly choice which operator should be quantized.
     quantize_granularity: str
-        The granularity of quantization, currently supports 'tensor-wise' and 'channel-wise'
-        quantization. The default value is 'tensor-wise'.
+        The granularity of quantization, currently supports 'tensor-wise', 'channel-wise' and
+        'group-wise' quantization. The default value is 'tensor-wise'.
+        'channel-wise' quantizes the weights of the FullyConnected layers with one scale per
+        output channel. 'group-wise' also splits the input features of each output channel
+        into groups of `weight_group_size` with a scale each.
     exclude_layers : list of strings
         A list of strings representing the names of the symbols that users want to excluding
     exclude_layers_match : list of strings
@@ -844,6 +1118,15 @@ def quantize_net(network, quantized_dtype='auto', quantize_mode='full', quantize
         If calib_mode='custom', the provided LayerOutputCollector will be used to determine
         the thresholds for quantization. For more information refer to CalibrationCollector
         documentation.
+        If calib_mode='dynamic', no calibration will be used and the quantized FullyConnected
+        and self-attention layers whose outputs are dequantized compute the scales of their
+        inputs at runtime for every batch, with their oneDNN primitives created once. The
+        weights stay quantized offline. Suited to models whose activation ranges change
+        between batches, such as NLP models.
+        If calib_mode='qat', the network is the result of `quantize_aware_net`, trained with
+        fake quantization. The trained scales give the thresholds of the quantized inputs,
+        no calibration data is run, and the weights are quantized from their fake-quantized
+        values.
     num_calib_batches : int or None
         The maximum number of batches that user would like to use for calibration. If not provided,
         the whole calibration dataset will be used.
@@ -855,6 +1138,9 @@ def quantize_net(network, quantized_dtype='auto', quantize_mode='full', quantize
         Passed object's include_layers attribute will be feed with names of layers which needs calibration
     logger : Object
         A logging object for printing information during the process of quantization.
+    weight_group_size : int
+        For 'group-wise' quantization, the number of consecutive input features of the weights
+        of each output channel that share a scale.
 
     Returns
     -------
@@ -867,6 +1153,13 @@ def quantize_net(network, quantized_dtype='auto', quantize_mode='full', quantize
         raise ValueError('Quantization currently supports only CPU device')
     backend = 'ONEDNN_QUANTIZE'
 
+    dynamic_quantize = calib_mode == 'dynamic'
+    if dynamic_quantize:
+        calib_mode = 'none'
+    qat = calib_mode == 'qat'
+    if qat:
+        calib_mode = 'custom'
+
     network.hybridize(static_alloc=False, static_shape=False)
     data_types = None
     if data_shapes is None:
@@ -926,6 +1219,12 @@ def quantize_net(network, quantized_dtype='auto', quantize_mode='full', quantize
         else:
             auxs[pname] = v
 
+    if qat:
+        symnet, min_max_dict = _strip_fake_quantize(symnet, args)
+        if is_np_array():
+            symnet = symnet.as_np_ndarray()
+        LayerOutputCollector = _FakeQuantizeCollector(min_max_dict)
+
     if exclude_layers is None:
         exclude_layers = []
     if exclude_layers_match is None:
@@ -944,28 +1243,29 @@ def quantize_net(network, quantized_dtype='auto', quantize_mode='full', quantize
         excluded_sym_names=exclude_layers, excluded_op_names=exclude_operators,
         calib_mode=calib_mode, quantized_dtype=quantized_dtype, quantize_mode=quantize_mode,
         quantize_granularity=quantize_granularity, LayerOutputCollector=LayerOutputCollector,
-        logger=logger)
+        logger=logger, weight_group_size=weight_group_size)
 
     if calib_mode is not None and calib_mode != 'none':
         if not isinstance(device, Device):
             raise ValueError(
                 f'currently only supports single device, while received {str(device)}')
-        if calib_data is None:
+        if calib_data is None and not qat:
             raise ValueError(
                 f'calib_data must be provided when calib_mode={calib_mode}')
         if calib_mode in ['naive', 'entropy', 'custom']:
             inputs = _multilist_iterator(data_descs, lambda dd: mx.sym.var(dd.name))
-            calib_net = SymbolBlock(symnet, inputs)
-            for k, v in calib_net.collect_params().items():
-               v.grad_req = 'null'
+            if not qat:
+                calib_net = SymbolBlock(symnet, inputs)
+                for k, v in calib_net.collect_params().items():
+                   v.grad_req = 'null'
 
-            calib_net.load_dict(params, cast_dtype=True, dtype_source='saved')
-            calib_net.hybridize(static_alloc=False, static_shape=False)
-            num_batches = _collect_layer_statistics(calib_net, calib_data, collector, num_inputs,
-                                                    num_calib_batches, logger)
+                calib_net.load_dict(params, cast_dtype=True, dtype_source='saved')
+                calib_net.hybridize(static_alloc=False, static_shape=False)
+                num_batches = _collect_layer_statistics(calib_net, calib_data, collector, num_inputs,
+                                                        num_calib_batches, logger)
 
-            if logger:
-                logger.info(f'Collected layer output values from FP32 model using {num_batches} batches')
+                if logger:
+                    logger.info(f'Collected layer output values from FP32 model using {num_batches} batches')
 
             qsym, qarg_params, aux_params = calib_graph(
                 qsym=qsym, arg_params=args, aux_params=auxs, collector=collector,
@@ -982,5 +1282,145 @@ def quantize_net(network, quantized_dtype='auto', quantize_mode='full', quantize
     all_params = {(f'arg:{k}'): v.as_in_context(cpu()) for k, v in qarg_params.items()}
     all_params.update({(f'aux:{k}'): v.as_in_context(cpu()) for k, v in aux_params.items()})
     net.load_dict(all_params, cast_dtype=True, dtype_source='saved')
-    net.optimize_for(data_nd, backend=backend, skip_infer=True)
+    if dynamic_quantize:
+        net.optimize_for(data_nd, backend=backend, skip_infer=True, dynamic_quantize=True)
+    else:
+        net.optimize_for(data_nd, backend=backend, skip_infer=True)
+    return net
+
+
+def _collect_entry_ranges(graph, entries, input_names, data, args, auxs):
+    """Min and max values of node entries of a linked graph, from a forward pass of data."""
+    from ..gluon import SymbolBlock
+
+    sym = _graph_to_symbol(graph, heads=entries)
+    if is_np_array():
+        sym = sym.as_np_ndarray()
+    used = [i for i, name in enumerate(input_names) if name in sym.list_inputs()]
+    block = SymbolBlock(sym, [mx.sym.var(input_names[i]) for i in used])
+    all_params = {f'arg:{k}': v for k, v in args.items()}
+    all_params.update({f'aux:{k}': v for k, v in auxs.items()})
+    block.load_dict(all_params, device=data[0].device, ignore_extra=True, cast_dtype=True,
+                    dtype_source='saved')
+    outs = block(*[data[i] for i in used])
+    if not isinstance(outs, (list, tuple)):
+        outs = [outs]
+    return [(float(out.asnumpy().min()), float(out.asnumpy().max())) for out in outs]
+
+
+def quantize_aware_net(network, data, quantized_dtype='auto', quantize_granularity='tensor-wise',
+                       exclude_layers=None, exclude_layers_match=None, fold_batch_norm=True,
+                       logger=None):
+    """User-level API for quantization-aware training: returns a FP32 SymbolBlock of a Gluon
+    HybridBlock with the inputs and weights of its Convolution and FullyConnected layers
+    fake-quantized with learnable scales. Once trained, `quantize_net` with calib_mode='qat'
+    converts it to a quantized SymbolBlock whose thresholds are the trained scales.
+
+    Parameters
+    ----------
+    network : Gluon HybridBlock
+        Defines the structure of a neural network for FP32 data types, usually pretrained.
+    data : NDArray or list of NDArrays
+        A batch of the input data. The initial scales of the inputs of the layers are taken
+        from their absolute maximum on this batch, the ones of the weights from the weights.
+    quantized_dtype : str
+        The quantized type of the inputs of the layers. Currently support 'int8', 'uint8' and
+        'auto'. 'auto' means uint8 for the inputs that are not negative on `data`, int8 for
+        the others. Should match the quantized_dtype given to `quantize_net`.
+    quantize_granularity: str
+        The granularity of the weight scales, 'tensor-wise' or 'channel-wise', with one scale
+        per output channel. Should match the quantize_granularity given to `quantize_net`.
+    exclude_layers : list of strings
+        A list of strings representing the names of the layers that users want to excluding
+        from fake quantization.
+    exclude_layers_match : list of strings
+        A list of strings wildcard matching the names of the layers that users want to excluding
+        from fake quantization.
+    fold_batch_norm : bool
+        Fold the BatchNorm layers that follow a Convolution into its weight and bias, with the
+        moving statistics of the network, so that the weights are trained as they are quantized.
+    logger : Object
+        A logging object for printing information during the process of quantization.
+
+    Returns
+    -------
+    network : Gluon SymbolBlock
+        The network with fake_quantize nodes, trainable with the scales as parameters.
+    """
+    from ..gluon import SymbolBlock
+
+    if quantized_dtype not in ('auto', 'int8', 'uint8'):
+        raise ValueError(f'unknown quantized_dtype {quantized_dtype} received,'
+                         ' expected `auto`, `int8` or `uint8`')
+    if quantize_granularity not in ('tensor-wise', 'channel-wise'):
+        raise ValueError(f'unknown quantize_granularity {quantize_granularity} received,'
+                         ' expected `tensor-wise` or `channel-wise`')
+    if not isinstance(data, (list, tuple)):
+        data = [data]
+    arr_fn = mx.np if is_np_array() else mx.nd
+
+    network.hybridize(static_alloc=False, static_shape=False)
+    network(*data)
+    symnet, params = network.export(None)
+    args, auxs = dict(), dict()
+    for k, v in params.items():
+        ptype, pname = k[:3], k[4:]
+        if ptype == "arg":
+            args[pname] = v
+        else:
+            auxs[pname] = v
+
+    graph = _link_graph(symnet)
+    if fold_batch_norm:
+        _fold_batch_norm(graph, args, auxs)
+
+    exclude_layers = list(exclude_layers) if exclude_layers is not None else []
+    for name_match in exclude_layers_match or []:
+        exclude_layers += [node['name'] for node in graph['nodes']
+                           if node['name'].find(name_match) != -1]
+    if logger:
+        logger.info(f'These layers have been excluded {exclude_layers}')
+    layers = [node for node in graph['nodes'] if node['op'] in _QAT_OPS and
+              node['name'] not in exclude_layers and node['inputs'][1][0]['op'] == 'null' and
+              node['inputs'][1][0]['name'] in args]
+
+    input_names = ['data'] if len(data) == 1 else [f'data{i}' for i in range(len(data))]
+    ranges = _collect_entry_ranges(graph, [node['inputs'][0] for node in layers],
+                                   input_names, data, args, auxs)
+    for node, (min_range, max_range) in zip(layers, ranges):
+        dtype = quantized_dtype
+        if dtype == 'auto':
+            dtype = 'uint8' if min_range >= 0 else 'int8'
+        th = max(abs(min_range), abs(max_range))
+        data_scale = (th if th > 0 else 1.) / _fake_quantize_range(dtype)[1]
+        weight = args[node['inputs'][1][0]['name']].asnumpy()
+        if quantize_granularity == 'channel-wise':
+            th = np.abs(weight.reshape((weight.shape[0], -1))).max(axis=1)
+            weight_attrs = {'quantized_dtype': 'int8', 'axis': '0'}
+        else:
+            th = np.abs(weight).max(keepdims=True).reshape((1,))
+            weight_attrs = {'quantized_dtype': 'int8'}
+        weight_scale = np.where(th > 0, th, 1.) / 127.
+        if logger:
+            logger.debug(f'{node["name"]}: {dtype} data with scale {data_scale}')
+
+        for index, input_name, attrs, scale in ((0, 'data', {'quantized_dtype': dtype},
+                                                 np.array([data_scale])),
+                                                (1, 'weight', weight_attrs, weight_scale)):
+            scale_node = {'op': 'null', 'name': f'{node["name"]}_{input_name}_scale',
+                          'inputs': []}
+            fq_node = {'op': '_contrib_fake_quantize',
+                       'name': f'{node["name"]}_{input_name}_fake_quantize', 'attrs': attrs,
+                       'inputs': [list(node['inputs'][index]), [scale_node, 0, 0]]}
+            graph['nodes'] += [scale_node, fq_node]
+            node['inputs'][index] = [fq_node, 0, 0]
+            args[scale_node['name']] = arr_fn.array(scale, dtype='float32')
+
+    sym = _graph_to_symbol(graph)
+    if is_np_array():
+        sym = sym.as_np_ndarray()
+    net = SymbolBlock(sym, [mx.sym.var(name) for name in input_names])
+    all_params = {f'arg:{k}': v for k, v in args.items()}
+    all_params.update({f'aux:{k}': v for k, v in auxs.items()})
+    net.load_dict(all_params, device=data[0].device, cast_dtype=True, dtype_source='saved')
     return net
@@ -29,8 +29,10 @@ from collections import OrderedDict, defaultdict
 import contextlib
 import contextvars
 
+import os
 import re
 import json
+import shutil
 import numpy as np
 
 from ..base import mx_real_t, MXNetError, NDArrayHandle, SymbolHandle, py_str, check_call, _LIB
@@ -48,6 +50,10 @@ from .. util import is_np_array, np_shape, np_array, wrap_ctx_to_device_func
 
 
 _naming_counter = contextvars.ContextVar('namecounter')
+# caches of the backend artifacts of a compiled model package, and their directory in it
+_COMPILED_CACHES = [('MXNET_RTC_CACHE_DIR', 'rtc'), ('MXNET_TENSORRT_ENGINE_CACHE_DIR', 'trt')]
+_COMPILED_FLAGS = ['static_alloc', 'static_shape', 'inline_limit', 'forward_bulk_size',
+                   'backward_bulk_size']
 _prefix = contextvars.ContextVar('prefix', default='')
 
 
@@ -379,7 +385,8 @@ class Block:
 
     @wrap_ctx_to_device_func
     def load_parameters(self, filename, device=None, allow_missing=False,
-                        ignore_extra=False, cast_dtype=False, dtype_source='current'):
+                        ignore_extra=False, cast_dtype=False, dtype_source='current',
+                        mmap=False, deduplicate=False):
         """Load parameters from file previously saved by `save_parameters`.
 
         Parameters
@@ -400,6 +407,16 @@ class Block:
             must be in {'current', 'saved'}
             Only valid if cast_dtype=True, specify the source of the dtype for casting
             the parameters
+        mmap : bool, default False
+            Whether to map the parameters of a file in the legacy MXNet format instead of
+            reading it, see ``mxnet.ndarray.load``. The parameters loaded on the CPU keep
+            pointing into the mapping, so that processes serving the same model share its
+            pages and only read the pages they use.
+        deduplicate : bool, default False
+            Whether the parameters share their memory with the parameters of the same content
+            loaded before with `deduplicate`, e.g. the weights of a backbone shared by the
+            models served from a GPU, see ``mxnet.ndarray.deduplicate``. The parameters are
+            read only, and must be loaded on a single device.
         References
         ----------
         `Saving and Loading Gluon Models \
@@ -409,7 +426,7 @@ class Block:
             # failure may happen when loading parameters saved as NDArrays within
             # NumPy semantics. Check the failure type and recover from it if it happens.
             try:
-                loaded = _mx_npx.load(filename)
+                loaded = _mx_npx.load(filename, mmap=mmap)
             except MXNetError as e:
                 err_msg = str(e)
                 if 'is_np_shape' in err_msg:
@@ -419,22 +436,28 @@ class Block:
                     # numpy ndarray covers is a superset of the legacy ndarray's.
                     with np_array(False):
                         with np_shape(False):
-                            loaded_nds = ndarray.load(filename)
+                            loaded_nds = ndarray.load(filename, mmap=mmap)
                     assert isinstance(loaded_nds, dict),\
                         'expecting a dict type, got {}'.format(str(type(loaded_nds)))
                     loaded = {k: loaded_nds[k].as_np_ndarray() for k in loaded_nds}
                 else:
                     raise ValueError(err_msg)
         else:
-            loaded = ndarray.load(filename)
+            loaded = ndarray.load(filename, mmap=mmap)
 
         if not loaded:
             return
-        full_dict = {'params': loaded, 'filename': filename}
+        if deduplicate:
+            devices = device if isinstance(device, list) else [device or _device.cpu()]
+            assert len(devices) == 1, \
+                "Deduplicated parameters must be loaded on a single device, got " + str(device)
+            loaded = ndarray.deduplicate({k: v.copyto(devices[0]) if v.device != devices[0]
+                                          else v for k, v in loaded.items()})
+        full_dict = {'params': loaded, 'filename': filename, 'share': mmap or deduplicate}
         self.load_dict(full_dict, device, allow_missing, ignore_extra, cast_dtype, dtype_source)
 
     def load_dict(self, param_dict, device=None, allow_missing=False,
-                  ignore_extra=False, cast_dtype=False, dtype_source="current"):
+                  ignore_extra=False, cast_dtype=False, dtype_source="current", share=False):
         """Load parameters from dict
 
         Parameters
@@ -456,10 +479,14 @@ class Block:
             must be in {'current', 'saved'}
             Only valid if cast_dtype=True, specify the source of the dtype for casting
             the parameters
+        share : bool, default False
+            Whether the parameters keep the arrays of `param_dict` on their device instead of
+            copies, e.g. the arrays mapped with ``mxnet.ndarray.import_cuda_ipc``.
         """
         if isinstance(param_dict.get('filename'), str):
             # pass from load_parameters
             filename = param_dict['filename']
+            share = param_dict.get('share', False)
             param_dict = param_dict['params']
         else:
             filename = None
@@ -489,7 +516,8 @@ class Block:
                 param = loaded[name]
                 if isinstance(param, np.ndarray):
                     param = _mx_np.array(param) if is_np_array() else nd.array(param)
-                params[name]._load_init(param, device, cast_dtype=cast_dtype, dtype_source=dtype_source)
+                params[name]._load_init(param, device, cast_dtype=cast_dtype,
+                                        dtype_source=dtype_source, share=share)
 
     def register_child(self, block, name=None):
         """Registers block as a child of self. :py:class:`Block` s assigned to self as
@@ -1393,6 +1421,69 @@ class HybridBlock(Block):
         self._backend = None
         self._backend_opts = {}
 
+    def warmup(self, shapes, dtype=None, device=None):
+        """Runs forward passes of the block on zero inputs of the expected shapes, so that
+        the first requests do not pay for the creation of the kernels.
+
+        With oneDNN, the first forward pass of each input shape creates and JIT compiles the
+        convolution and FullyConnected primitives and reorders the weights to their layout.
+        Warming up every shape the model will be served with moves this out of the first
+        requests. The block should be hybridized, or optimized with `optimize_for`, as it
+        will be served.
+
+        Examples
+        --------
+        >>> net.hybridize(static_alloc=True)
+        >>> net.warmup([(1, 3, 224, 224), (8, 3, 224, 224)])
+        >>> net.export('net', warmup_shapes=[(1, 3, 224, 224), (8, 3, 224, 224)])
+        >>> net2 = gluon.SymbolBlock.imports('net-symbol.json', ['data'], 'net-0000.params')
+        >>> net2.warmup('net-warmup.json')
+
+        Parameters
+        ----------
+        shapes : list or str
+            Input shapes to warm up. Each item is the shape of the input of a block with
+            one input, or the list of the shapes of its inputs. A str is the path of a
+            manifest saved by `export`.
+        dtype : str or list of str, optional
+            Data type of the inputs, or of each input. Defaults to the type saved in the
+            manifest, or float32.
+        device : Device, optional
+            Device of the inputs. Defaults to the current device.
+
+        Returns
+        -------
+        HybridBlock
+            The block itself.
+        """
+        if isinstance(shapes, str):
+            with open(shapes, 'r') as f:
+                manifest = json.load(f)
+            shapes = manifest['shapes']
+            if dtype is None:
+                dtype = manifest.get('dtype')
+        if device is None:
+            device = _device.current_device()
+        def zeros(shape, dtype):
+            if is_np_array():
+                return _mx_np.zeros(shape, dtype=dtype, device=device)
+            return nd.zeros(shape, ctx=device, dtype=dtype)
+        for entry in shapes:
+            if all(isinstance(dim, int) for dim in entry):
+                entry = [entry]
+            dtypes = dtype if isinstance(dtype, (list, tuple)) else [dtype] * len(entry)
+            if len(dtypes) != len(entry):
+                raise ValueError('Expected a data type for each of the {} inputs, got {}'
+                                 .format(len(entry), dtypes))
+            inputs = [zeros(tuple(shape), t or mx_real_t)
+                      for shape, t in zip(entry, dtypes)]
+            with autograd.predict_mode():
+                out = self(*inputs)
+            for arr in _flatten(out, "output")[0]:
+                if arr is not None:
+                    arr.wait_to_read()
+        return self
+
     def _clear_cached_op(self):
         self._cached_graph = ()
         self._cached_op = None
@@ -1417,7 +1508,8 @@ class HybridBlock(Block):
                   static_shape=False,
                   inline_limit=2,
                   forward_bulk_size=None,
-                  backward_bulk_size=None):
+                  backward_bulk_size=None,
+                  memory_group=None):
         """Activates or deactivates :py:class:`HybridBlock` s recursively. Has no effect on
         non-hybrid children.
 
@@ -1439,6 +1531,10 @@ class HybridBlock(Block):
             Segment size of bulk execution during forward pass.
         backward_bulk_size : optional int, default None
             Segment size of bulk execution during backward pass.
+        memory_group : optional str, default None
+            With static_alloc, name of a group of blocks sharing the memory of their static
+            allocations on a device, e.g. the models served one after another from a GPU.
+            The passes of the blocks of a group running at the same time are serialized.
         """
 
         self._active = active
@@ -1449,6 +1545,8 @@ class HybridBlock(Block):
             self._flags.append(("forward_bulk_size", forward_bulk_size))
         if backward_bulk_size is not None:
             self._flags.append(("backward_bulk_size", backward_bulk_size))
+        if memory_group is not None:
+            self._flags.append(("memory_group", memory_group))
         self._clear_cached_op()
         if active and self._forward_hooks or self._forward_pre_hooks:
             warnings.warn('"{block}" is being hybridized while still having forward hook/pre-hook. '
@@ -1459,7 +1557,8 @@ class HybridBlock(Block):
                                            static_shape=static_shape,
                                            inline_limit=inline_limit,
                                            forward_bulk_size=forward_bulk_size,
-                                           backward_bulk_size=backward_bulk_size)
+                                           backward_bulk_size=backward_bulk_size,
+                                           memory_group=memory_group)
 
     def cast(self, dtype):
         if self._active:
@@ -1503,7 +1602,7 @@ class HybridBlock(Block):
         """Infers data type of Parameters from inputs."""
         self._infer_attrs('infer_type', 'dtype', *args)
 
-    def export(self, path, epoch=0, remove_amp_cast=True):
+    def export(self, path, epoch=0, remove_amp_cast=True, warmup_shapes=None, warmup_dtype=None):
         """Export HybridBlock to json format that can be loaded by
         `gluon.SymbolBlock.imports` or the C++ interface.
 
@@ -1521,6 +1620,11 @@ class HybridBlock(Block):
             Epoch number of saved model.
         remove_amp_cast : bool, optional
             Whether to remove the amp_cast and amp_multicast operators, before saving the model.
+        warmup_shapes : list, optional
+            Input shapes the model will be served with, saved in `path-warmup.json` for
+            `warmup` to create their kernels before the first requests. See `warmup`.
+        warmup_dtype : str or list of str, optional
+            Data type of the inputs, or of each input, saved with `warmup_shapes`.
 
         Returns
         -------
@@ -1567,6 +1671,11 @@ class HybridBlock(Block):
                         arg_dict[f'aux:{name}'] = param._reduce()
         params_filename = f'{path_string}-{epoch:04d}.params'
 
+        if path is not None and warmup_shapes is not None:
+            with open(f'{path_string}-warmup.json', 'w') as f:
+                json.dump({'shapes': [list(shape) for shape in warmup_shapes],
+                           'dtype': warmup_dtype}, f)
+
         if path is not None:
             if is_np_array():
                 _mx_npx.savez(params_filename, **arg_dict)
@@ -1580,6 +1689,54 @@ class HybridBlock(Block):
             sym = type(sym)(handle)
         return sym, arg_dict
 
+    def export_compiled(self, path, warmup_shapes=None, warmup_dtype=None, remove_amp_cast=True):
+        """Export HybridBlock as a compiled model package, that `gluon.SymbolBlock.imports_compiled`
+        loads ready to serve.
+
+        The package is a directory holding the graph as optimized by `optimize_for`, the
+        parameters, which are mapped instead of read at load time, the flags of `hybridize`
+        and the input shapes to warm up. The kernels compiled at runtime and the TensorRT
+        engines found in `MXNET_RTC_CACHE_DIR` and `MXNET_TENSORRT_ENGINE_CACHE_DIR` are
+        copied into the package, so that the processes loading it skip their compilation.
+
+        Examples
+        --------
+        >>> net.optimize_for(x, backend='ONEDNN', static_alloc=True)
+        >>> net.export_compiled('net.mxc', warmup_shapes=[(1, 3, 224, 224)])
+        >>> net2 = gluon.SymbolBlock.imports_compiled('net.mxc')
+
+        Parameters
+        ----------
+        path : str
+            Directory of the package.
+        warmup_shapes : list, optional
+            Input shapes the model will be served with, see `warmup`.
+        warmup_dtype : str or list of str, optional
+            Data type of the inputs, or of each input, saved with `warmup_shapes`.
+        remove_amp_cast : bool, optional
+            Whether to remove the amp_cast and amp_multicast operators, before saving the model.
+        """
+        if not self._cached_graph:
+            raise RuntimeError(
+                "Please first call block.hybridize() and then run forward with "
+                "this block at least once before calling export_compiled.")
+        os.makedirs(path, exist_ok=True)
+        _, params_filename = self.export(os.path.join(path, 'model'),
+                                         remove_amp_cast=remove_amp_cast,
+                                         warmup_shapes=warmup_shapes, warmup_dtype=warmup_dtype)
+        for var, name in _COMPILED_CACHES:
+            cache = os.environ.get(var)
+            if cache and os.path.isdir(cache):
+                shutil.copytree(cache, os.path.join(path, 'cache', name), dirs_exist_ok=True,
+                                ignore=shutil.ignore_patterns('*.tmp*'))
+        manifest = {'version': 1,
+                    'inputs': [var.name for var in self._cached_graph[0]],
+                    'flags': {k: v for k, v in self._flags if k in _COMPILED_FLAGS},
+                    'params': params_filename is not None,
+                    'warmup': warmup_shapes is not None}
+        with open(os.path.join(path, 'manifest.json'), 'w') as f:
+            json.dump(manifest, f)
+
     def register_op_hook(self, callback, monitor_all=False):
         """Install op hook for block recursively.
 
@@ -1710,7 +1867,7 @@ class SymbolBlock(HybridBlock):
     @staticmethod
     @wrap_ctx_to_device_func
     def imports(symbol_file, input_names, param_file=None, device=None, allow_missing=False,
-                ignore_extra=False):
+                ignore_extra=False, mmap=False):
         """Import model previously saved by `gluon.HybridBlock.export`
         as a `gluon.SymbolBlock` for use in Gluon.
 
@@ -1729,6 +1886,8 @@ class SymbolBlock(HybridBlock):
         ignore_extra : bool, default False
             Whether to silently ignore parameters from the file that are not
             present in this Block.
+        mmap : bool, default False
+            Whether to map the parameter file instead of reading it, see `load_parameters`.
 
         Returns
         -------
@@ -1761,7 +1920,49 @@ class SymbolBlock(HybridBlock):
             inputs = [symbol.var(i).as_np_ndarray() if is_np_array() else symbol.var(i) for i in input_names]
         ret = SymbolBlock(sym, inputs)
         if param_file is not None:
-            ret.load_parameters(param_file, device, allow_missing, ignore_extra, True, 'saved')
+            ret.load_parameters(param_file, device, allow_missing, ignore_extra, True, 'saved',
+                                mmap=mmap)
+        return ret
+
+    @staticmethod
+    def imports_compiled(path, device=None, warmup=True):
+        """Import a compiled model package saved by `gluon.HybridBlock.export_compiled`,
+        hybridized with the flags of the exported block.
+
+        The parameters are mapped from the package. The kernels compiled at runtime and the
+        TensorRT engines of the package are used unless `MXNET_RTC_CACHE_DIR` and
+        `MXNET_TENSORRT_ENGINE_CACHE_DIR` are already set.
+
+        Parameters
+        ----------
+        path : str
+            Directory of the package.
+        device : Device, default None
+            The device to initialize `gluon.SymbolBlock` on.
+        warmup : bool, default True
+            Whether to warm up the input shapes saved in the package, see `warmup`.
+
+        Returns
+        -------
+        gluon.SymbolBlock
+            `gluon.SymbolBlock` loaded from the package.
+        """
+        with open(os.path.join(path, 'manifest.json'), 'r') as f:
+            manifest = json.load(f)
+        if manifest.get('version') != 1:
+            raise ValueError('Unsupported compiled model package version {}'
+                             .format(manifest.get('version')))
+        for var, name in _COMPILED_CACHES:
+            cache = os.path.join(path, 'cache', name)
+            if os.path.isdir(cache) and not os.environ.get(var):
+                os.environ[var] = cache
+        prefix = os.path.join(path, 'model')
+        param_file = prefix + '-0000.params' if manifest['params'] else None
+        ret = SymbolBlock.imports(prefix + '-symbol.json', manifest['inputs'], param_file, device,
+                                  mmap=True)
+        ret.hybridize(**manifest['flags'])
+        if warmup and manifest['warmup']:
+            ret.warmup(prefix + '-warmup.json', device=device)
         return ret
 
     def __repr__(self):
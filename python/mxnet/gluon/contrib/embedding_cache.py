@@ -0,0 +1,192 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# coding: utf-8
+"""Embedding whose table lives in host memory, the hot rows being cached on a device.
+
+The rows looked up by a batch are served from a fixed number of cache slots on the device.
+The rows missing from the cache are gathered from the host table and copied to the device in
+one transfer per batch, replacing the least recently or least frequently used rows. The rows
+updated on the device are only written back to the host table when they are evicted or when
+the cache is flushed, so that skewed accesses mostly stay on the device."""
+
+import numpy as onp
+
+from ..block import Block
+from ... import autograd
+from ... import initializer
+from ..parameter import Parameter
+from ... import np, npx
+from ...device import cpu
+from ...util import use_np
+
+__all__ = ['CachedEmbedding']
+
+
+@use_np
+class CachedEmbedding(Block):
+    """Embedding with a host-resident table and a device cache of its hot rows.
+
+    The `weight` parameter holds the whole table on `host_device` and is not trained
+    directly. The `cache` parameter holds `cache_size` rows of the table on `device`, and is
+    the one trained. It is given to a :py:class:`mxnet.gluon.Trainer` without `weight`, the
+    parameters of a trainer having to share their devices. The rows looked up
+    while recording are marked dirty, and written back to `weight` when they are evicted or
+    by :py:meth:`flush`. The optimizer states of the cache are kept per slot, so stateless
+    optimizers such as SGD are the ones giving the same updates as an uncached table.
+
+    The slot of each row is tracked on the host with one 32 bit integer per row of the table.
+
+    Parameters
+    ----------
+    input_dim : int
+        Size of the vocabulary.
+    output_dim : int
+        Dimension of the embeddings.
+    cache_size : int
+        Number of rows cached on `device`, at least the number of distinct rows of a batch.
+    device : Device
+        Device of the cache and of the output.
+    policy : {'lru', 'lfu'}, default 'lru'
+        Whether the rows evicted for the missing ones are the least recently used or the
+        least frequently used since they were cached.
+    host_device : Device, default cpu()
+        Device of the table.
+    dtype, weight_initializer
+        As for :py:class:`mxnet.gluon.nn.Embedding`.
+    """
+    def __init__(self, input_dim, output_dim, cache_size, device, policy='lru',
+                 host_device=None, dtype='float32', weight_initializer=None):
+        super(CachedEmbedding, self).__init__()
+        if policy not in ('lru', 'lfu'):
+            raise ValueError("policy must be 'lru' or 'lfu', but got '%s'" % policy)
+        if not 0 < cache_size <= input_dim:
+            raise ValueError('cache_size %d must be in [1, input_dim]' % cache_size)
+        self._input_dim = input_dim
+        self._output_dim = output_dim
+        self._cache_size = cache_size
+        self._device = device
+        self._host_device = host_device if host_device is not None else cpu()
+        self._policy = policy
+        self._dtype = dtype
+        self.weight = Parameter('weight', shape=(input_dim, output_dim), init=weight_initializer,
+                                dtype=dtype, grad_req='null')
+        self.cache = Parameter('cache', shape=(cache_size, output_dim), init='zeros',
+                               dtype=dtype)
+        self._reset_cache()
+
+    def _reset_cache(self):
+        index_dtype = onp.int32 if self._cache_size < 2**31 else onp.int64
+        self._slot_of_row = onp.full(self._input_dim, -1, dtype=index_dtype)
+        self._row_of_slot = onp.full(self._cache_size, -1, dtype=onp.int64)
+        # step of the last use with 'lru', number of uses since cached with 'lfu'
+        self._score = onp.zeros(self._cache_size, dtype=onp.int64)
+        self._dirty = onp.zeros(self._cache_size, dtype=bool)
+        self._step = 0
+        self.hits = 0
+        self.misses = 0
+
+    def _place(self):
+        for param, device in [(self.weight, self._host_device), (self.cache, self._device)]:
+            if param._data is not None and param.list_device() != [device]:
+                param.reset_device(device)
+
+    def initialize(self, init=initializer.Uniform(), device=None, verbose=False,
+                   force_reinit=False):
+        """Initializes the table on `host_device` and the cache on `device`, whatever `device`
+        is. When the block is initialized through a parent block instead, the parameters are
+        moved to their devices by the first forward pass."""
+        self.weight.initialize(None, self._host_device, default_init=init,
+                               force_reinit=force_reinit)
+        self.cache.initialize(None, self._device, force_reinit=force_reinit)
+        self._reset_cache()
+
+    def _write_back(self, slots):
+        """Copies the rows of the cache slots to the table."""
+        rows = np.take(self.cache.data(self._device),
+                       np.array(slots, dtype='int64', device=self._device), axis=0)
+        table = self.weight.data(self._host_device)
+        table[np.array(self._row_of_slot[slots], dtype='int64', device=self._host_device)] = \
+            rows.to_device(self._host_device)
+        self._dirty[slots] = False
+
+    def _lookup(self, rows):
+        """Returns the cache slots of the distinct `rows`, caching the missing ones."""
+        if rows.size > self._cache_size:
+            raise ValueError('A batch looks up %d distinct rows, more than the %d cache slots'
+                             % (rows.size, self._cache_size))
+        self._step += 1
+        slots = self._slot_of_row[rows].astype(onp.int64)
+        missing = slots < 0
+        num_missing = int(missing.sum())
+        if num_missing:
+            # the free slots go first, then the lowest scores, but not the slots of the batch
+            score = onp.where(self._row_of_slot < 0, -1, self._score)
+            score[slots[~missing]] = onp.iinfo(onp.int64).max
+            victims = onp.argpartition(score, num_missing - 1)[:num_missing]
+            evicted = victims[self._row_of_slot[victims] >= 0]
+            dirty = evicted[self._dirty[evicted]]
+            if dirty.size:
+                self._write_back(dirty)
+            self._slot_of_row[self._row_of_slot[evicted]] = -1
+            missing_rows = rows[missing]
+            self._row_of_slot[victims] = missing_rows
+            self._slot_of_row[missing_rows] = victims
+            self._score[victims] = 0
+            # one gather on the host and one transfer for all the missing rows
+            fetched = np.take(self.weight.data(self._host_device),
+                              np.array(missing_rows, dtype='int64', device=self._host_device),
+                              axis=0)
+            cache = self.cache.data(self._device)
+            cache[np.array(victims, dtype='int64', device=self._device)] = \
+                fetched.to_device(self._device)
+            slots[missing] = victims
+        if self._policy == 'lru':
+            self._score[slots] = self._step
+        else:
+            self._score[slots] += 1
+        if autograd.is_recording():
+            self._dirty[slots] = True
+        self.hits += rows.size - num_missing
+        self.misses += num_missing
+        return slots
+
+    def flush(self):
+        """Writes the dirty rows of the cache back to the table."""
+        dirty = onp.nonzero(self._dirty)[0]
+        if dirty.size:
+            self._write_back(dirty)
+
+    @property
+    def hit_rate(self):
+        """Fraction of the distinct rows of the batches found in the cache."""
+        total = self.hits + self.misses
+        return self.hits / total if total else 0.0
+
+    def forward(self, x):
+        self._place()
+        with autograd.pause():
+            rows, inverse = onp.unique(x.asnumpy().astype(onp.int64).ravel(),
+                                       return_inverse=True)
+            if rows.size and (rows[0] < 0 or rows[-1] >= self._input_dim):
+                raise ValueError('Indices must be in [0, %d)' % self._input_dim)
+            slots = self._lookup(rows)
+            local = np.array(slots[inverse].reshape(x.shape), dtype='int64',
+                             device=self._device)
+        return npx.embedding(local, self.cache.data(self._device),
+                             input_dim=self._cache_size, output_dim=self._output_dim,
+                             dtype=self._dtype)
@@ -0,0 +1,291 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# coding: utf-8
+"""Pipeline-parallel training of a sequential block split into stages across devices."""
+
+import json
+
+from ... import autograd, profiler
+from ...ndarray import waitall
+from ..nn import HybridSequential
+from ..utils import split_data
+
+__all__ = ['profile_costs', 'partition_stages', 'PipelineParallel']
+
+
+def profile_costs(blocks, *args):
+    """Measures the forward time of each of a chain of blocks with the profiler.
+
+    The blocks are run once to warm up, then once more with each block in a profiler
+    task of the ``'pipeline'`` domain. This resets the aggregate profiler statistics and
+    must not be called while the profiler is running.
+
+    Parameters
+    ----------
+    blocks : list of Block
+        Initialized blocks, the outputs of each being the inputs of the next one.
+    *args : NDArray
+        Inputs of the first block.
+
+    Returns
+    -------
+    list of float
+        Forward time of each block in milliseconds.
+    """
+    def run(tasks):
+        inputs = args
+        for i, block in enumerate(blocks):
+            if tasks:
+                tasks[i].start()
+            out = block(*inputs)
+            waitall()
+            if tasks:
+                tasks[i].stop()
+            inputs = out if isinstance(out, (list, tuple)) else (out,)
+
+    domain = profiler.Domain('pipeline')
+    tasks = [profiler.Task(domain, 'block%d' % i) for i in range(len(blocks))]
+    with autograd.pause():
+        run(None)
+        profiler.set_config(profile_all=True, aggregate_stats=True, continuous_dump=False)
+        profiler.dumps(reset=True)
+        profiler.set_state('run')
+        try:
+            run(tasks)
+        finally:
+            profiler.set_state('stop')
+    stats = json.loads(profiler.dumps(format='json', reset=True))['Time']['pipeline']
+    return [stats[task.name]['Total'] for task in tasks]
+
+
+def partition_stages(costs, num_stages):
+    """Splits a chain of blocks into contiguous stages minimizing the cost of the most
+    expensive stage, which bounds the throughput of the pipeline.
+
+    Parameters
+    ----------
+    costs : list of float
+        Cost of each block, e.g. from `profile_costs`.
+    num_stages : int
+        Number of stages, at most ``len(costs)``.
+
+    Returns
+    -------
+    list of (int, int)
+        Half-open ranges of the block indices of each stage.
+    """
+    num_blocks = len(costs)
+    if not 0 < num_stages <= num_blocks:
+        raise ValueError('Cannot split %d blocks into %d stages' % (num_blocks, num_stages))
+    prefix = [0.]
+    for cost in costs:
+        prefix.append(prefix[-1] + cost)
+    # best[k][i]: lowest bottleneck of the first i blocks in k stages, split[k][i]: start
+    # of the last of these stages
+    inf = float('inf')
+    best = [[inf] * (num_blocks + 1) for _ in range(num_stages + 1)]
+    split = [[0] * (num_blocks + 1) for _ in range(num_stages + 1)]
+    best[0][0] = 0.
+    for k in range(1, num_stages + 1):
+        for i in range(k, num_blocks + 1):
+            for j in range(k - 1, i):
+                bottleneck = max(best[k - 1][j], prefix[i] - prefix[j])
+                if bottleneck < best[k][i]:
+                    best[k][i], split[k][i] = bottleneck, j
+    ranges = []
+    end = num_blocks
+    for k in range(num_stages, 0, -1):
+        ranges.append((split[k][end], end))
+        end = split[k][end]
+    return ranges[::-1]
+
+
+def _schedule(schedule, num_stages, num_micro_batches):
+    """Per-stage order of the forward ('F') and backward ('B') passes of micro-batches."""
+    orders = []
+    for s in range(num_stages):
+        if schedule == 'gpipe':
+            order = [('F', i) for i in range(num_micro_batches)] + \
+                    [('B', i) for i in reversed(range(num_micro_batches))]
+        else:
+            # 1F1B: the stages ahead of the last one warm up with as many forward passes
+            # as there are stages after them, then alternate forward and backward
+            warmup = min(num_stages - s - 1, num_micro_batches)
+            order = [('F', i) for i in range(warmup)]
+            for i in range(num_micro_batches - warmup):
+                order += [('F', warmup + i), ('B', i)]
+            order += [('B', i) for i in range(num_micro_batches - warmup, num_micro_batches)]
+        orders.append(order)
+    return orders
+
+
+class PipelineParallel(object):
+    """Pipeline-parallel training of a chain of stages placed on different devices.
+
+    A batch is split into micro-batches which flow through the stages. Each stage runs
+    its (hybridized) forward and backward passes on its own device, and the activations
+    and their gradients are copied between the devices of neighbouring stages. Since the
+    engine runs the operators of different devices and the copies between them
+    asynchronously, the stages work on different micro-batches at the same time.
+
+    The gradients of the micro-batches are accumulated in the parameters, whose grad_req
+    is set to ``'add'``, and are zeroed at the start of each `forward_backward`. Update
+    them with a Trainer over `collect_params()` after each `forward_backward`.
+
+    Parameters
+    ----------
+    stages : list of HybridBlock
+        Initialized stages, the outputs of each being the inputs of the next one.
+    devices : list of Device
+        Device of each stage. The parameters of the stages are moved there.
+    loss : Loss
+        Loss of the output of the last stage and the label.
+    num_micro_batches : int, default 4
+        Number of micro-batches each batch is split into.
+    schedule : {'1f1b', 'gpipe'}, default '1f1b'
+        ``'gpipe'`` runs the forward passes of all micro-batches before their backward
+        passes. ``'1f1b'`` alternates them after a warm-up, so that each stage holds the
+        activations of at most as many micro-batches as there are stages.
+    hybridize : bool, default True
+        Whether to hybridize the stages.
+    """
+    def __init__(self, stages, devices, loss, num_micro_batches=4, schedule='1f1b',
+                 hybridize=True):
+        if len(stages) != len(devices):
+            raise ValueError('Got %d stages but %d devices' % (len(stages), len(devices)))
+        if schedule not in ('1f1b', 'gpipe'):
+            raise ValueError("schedule must be '1f1b' or 'gpipe', but got '%s'" % schedule)
+        self._stages = list(stages)
+        self._devices = list(devices)
+        self._loss = loss
+        self._num_micro_batches = num_micro_batches
+        self._orders = _schedule(schedule, len(stages), num_micro_batches)
+        for stage, device in zip(self._stages, self._devices):
+            stage.reset_device(device)
+            stage.setattr('grad_req', 'add')
+            if hybridize:
+                stage.hybridize()
+
+    @classmethod
+    def from_sequential(cls, net, devices, loss, *args, **kwargs):
+        """Splits the children of a sequential block into one stage per device, balancing
+        their forward time measured by `profile_costs` on the sample inputs `args`.
+
+        The remaining keyword arguments are those of `PipelineParallel`, and ``costs``
+        which gives the cost of each child instead of profiling them.
+        """
+        blocks = [net[i] for i in range(len(net))]
+        costs = kwargs.pop('costs', None)
+        if costs is None:
+            costs = profile_costs(blocks, *args)
+        stages = []
+        for begin, end in partition_stages(costs, len(devices)):
+            stage = HybridSequential()
+            stage.add(*blocks[begin:end])
+            stages.append(stage)
+        return cls(stages, devices, loss, **kwargs)
+
+    @property
+    def stages(self):
+        """The stages of the pipeline."""
+        return self._stages
+
+    def collect_params(self):
+        """Returns the parameters of all stages."""
+        params = {}
+        for s, stage in enumerate(self._stages):
+            for name, param in stage.collect_params().items():
+                params['stage%d.%s' % (s, name)] = param
+        return params
+
+    def forward_backward(self, data, label, batch_axis=0):
+        """Runs the forward and backward passes of a batch through the pipeline.
+
+        Parameters
+        ----------
+        data : NDArray
+            Input batch of the first stage.
+        label : NDArray
+            Labels of the batch.
+        batch_axis : int, default 0
+            Axis along which the batch is split into micro-batches.
+
+        Returns
+        -------
+        list of NDArray
+            Loss of each micro-batch, on the device of the last stage.
+        """
+        num_stages = len(self._stages)
+        last = num_stages - 1
+        for stage in self._stages:
+            stage.zero_grad()
+        datas = split_data(data, self._num_micro_batches, batch_axis)
+        labels = split_data(label, self._num_micro_batches, batch_axis)
+        # inputs[s][i] and outputs[s][i]: input and output of stage s on micro-batch i
+        inputs = [[None] * self._num_micro_batches for _ in range(num_stages)]
+        outputs = [[None] * self._num_micro_batches for _ in range(num_stages)]
+        losses = [None] * self._num_micro_batches
+
+        def forward(s, i):
+            if s == 0:
+                x = datas[i].copyto(self._devices[0])
+            else:
+                x = outputs[s - 1][i].copyto(self._devices[s])
+                x.attach_grad()
+            inputs[s][i] = x
+            with autograd.record():
+                out = self._stages[s](x)
+                if s == last:
+                    out = self._loss(out, labels[i].copyto(self._devices[s]))
+                    losses[i] = out
+            outputs[s][i] = out
+
+        def backward(s, i):
+            if s == last:
+                outputs[s][i].backward()
+            else:
+                ograd = inputs[s + 1][i].grad.copyto(self._devices[s])
+                autograd.backward(outputs[s][i], ograd)
+                # release the activations of the micro-batch between the two stages
+                inputs[s + 1][i] = None
+                outputs[s][i] = None
+
+        done = set()
+        positions = [0] * num_stages
+        while any(p < len(order) for p, order in zip(positions, self._orders)):
+            progressed = False
+            # one pass issues the next ready step of each stage, as a clock of the pipeline
+            for s in range(num_stages):
+                if positions[s] == len(self._orders[s]):
+                    continue
+                kind, i = self._orders[s][positions[s]]
+                if kind == 'F':
+                    ready = s == 0 or ('F', s - 1, i) in done
+                else:
+                    ready = ('F', s, i) in done and (s == last or ('B', s + 1, i) in done)
+                if not ready:
+                    continue
+                if kind == 'F':
+                    forward(s, i)
+                else:
+                    backward(s, i)
+                done.add((kind, s, i))
+                positions[s] += 1
+                progressed = True
+            assert progressed, 'Deadlock in the pipeline schedule'
+        return losses
@@ -0,0 +1,224 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# coding: utf-8
+"""Tensor-parallel layers whose weights are sharded across the devices of one process.
+
+Each shard computes its part of the layer on its own device. The partial results are
+gathered or summed across the devices with differentiable copies, which the engine runs
+asynchronously, so the copies of a shard overlap with the GEMMs of the other shards."""
+
+from ..block import Block
+from ... import initializer
+from ..nn import Dense, Embedding
+from ..parameter import Parameter
+from ... import np
+from ...util import use_np
+
+__all__ = ['ColumnParallelDense', 'RowParallelDense', 'VocabParallelEmbedding']
+
+
+def _place(params, device):
+    """Moves the initialized parameters to `device`, e.g. after the parent block was
+    initialized on a single device."""
+    for param in params:
+        if param._data is not None and param.list_device() != [device]:
+            param.reset_device(device)
+
+
+def _split_size(size, num_shards, what):
+    if size % num_shards:
+        raise ValueError('%s %d is not divisible by the number of devices %d'
+                         % (what, size, num_shards))
+    return size // num_shards
+
+
+class _ShardedBlock(Block):
+    """Block holding one shard per device, each shard being placed on its device."""
+    def __init__(self, devices):
+        super(_ShardedBlock, self).__init__()
+        if not devices:
+            raise ValueError('At least one device is required')
+        self._devices = list(devices)
+        self._shards = []
+
+    def _add_shards(self, shards):
+        for i, shard in enumerate(shards):
+            self.register_child(shard, 'shard%d' % i)
+        self._shards = list(shards)
+
+    def _place_shards(self):
+        for shard, device in zip(self._shards, self._devices):
+            _place(shard.collect_params().values(), device)
+
+    def initialize(self, init=initializer.Uniform(), device=None, verbose=False,
+                   force_reinit=False):
+        """Initializes the parameters of each shard on the device of the shard, whatever
+        `device` is. When the block is initialized through a parent block instead, the
+        shards are moved to their devices by the first forward pass."""
+        super(_ShardedBlock, self).initialize(init, self._devices[0], verbose, force_reinit)
+        self._place_shards()
+
+    @property
+    def devices(self):
+        """Device of each shard."""
+        return self._devices
+
+
+@use_np
+class ColumnParallelDense(_ShardedBlock):
+    """Dense layer whose output units are split across devices.
+
+    Shard `i` holds rows ``[i * units / n, (i + 1) * units / n)`` of the weight and
+    computes these output units from the whole input on its device.
+
+    Parameters
+    ----------
+    units : int
+        Number of output units, divisible by the number of devices.
+    in_units : int
+        Number of input units.
+    devices : list of Device
+        Device of each shard.
+    activation : str, default None
+        Activation applied to each shard of the output.
+    use_bias : bool, default True
+        Whether the layer uses a bias vector.
+    gather_output : bool, default True
+        Whether to concatenate the outputs of the shards on the device of the input. If
+        False, the list of the outputs of the shards on their devices is returned, as the
+        input of a `RowParallelDense` with ``input_is_parallel=True``.
+    dtype, weight_initializer, bias_initializer
+        As for :py:class:`mxnet.gluon.nn.Dense`.
+    """
+    def __init__(self, units, in_units, devices, activation=None, use_bias=True,
+                 gather_output=True, dtype='float32', weight_initializer=None,
+                 bias_initializer='zeros'):
+        super(ColumnParallelDense, self).__init__(devices)
+        shard_units = _split_size(units, len(self._devices), 'units')
+        self._gather_output = gather_output
+        self._add_shards([Dense(shard_units, activation=activation, use_bias=use_bias,
+                                flatten=False, dtype=dtype,
+                                weight_initializer=weight_initializer,
+                                bias_initializer=bias_initializer, in_units=in_units)
+                          for _ in self._devices])
+
+    def forward(self, x):
+        self._place_shards()
+        outs = [shard(x.to_device(device)) for shard, device in zip(self._shards, self._devices)]
+        if not self._gather_output:
+            return outs
+        return np.concatenate([out.to_device(x.device) for out in outs], axis=-1)
+
+
+@use_np
+class RowParallelDense(_ShardedBlock):
+    """Dense layer whose input units are split across devices.
+
+    Shard `i` holds columns ``[i * in_units / n, (i + 1) * in_units / n)`` of the weight
+    and computes a partial output from these input units on its device. The partial
+    outputs are summed on the first device, which holds the bias.
+
+    Parameters
+    ----------
+    units : int
+        Number of output units.
+    in_units : int
+        Number of input units, divisible by the number of devices.
+    devices : list of Device
+        Device of each shard.
+    use_bias : bool, default True
+        Whether the layer uses a bias vector.
+    input_is_parallel : bool, default False
+        Whether the input is the list of the input shards on the devices, e.g. the output
+        of a `ColumnParallelDense` with ``gather_output=False``. Otherwise the input is
+        split along its last axis.
+    dtype, weight_initializer, bias_initializer
+        As for :py:class:`mxnet.gluon.nn.Dense`.
+    """
+    def __init__(self, units, in_units, devices, use_bias=True, input_is_parallel=False,
+                 dtype='float32', weight_initializer=None, bias_initializer='zeros'):
+        super(RowParallelDense, self).__init__(devices)
+        shard_in_units = _split_size(in_units, len(self._devices), 'in_units')
+        self._input_is_parallel = input_is_parallel
+        self._add_shards([Dense(units, use_bias=False, flatten=False, dtype=dtype,
+                                weight_initializer=weight_initializer,
+                                in_units=shard_in_units)
+                          for _ in self._devices])
+        if use_bias:
+            self.bias = Parameter('bias', shape=(units,), init=bias_initializer, dtype=dtype)
+        else:
+            self.bias = None
+
+    def _place_shards(self):
+        super(RowParallelDense, self)._place_shards()
+        if self.bias is not None:
+            _place([self.bias], self._devices[0])
+
+    def forward(self, x):
+        self._place_shards()
+        if self._input_is_parallel:
+            xs = x
+        else:
+            xs = np.split(x, len(self._devices), axis=-1)
+        out = None
+        for shard, device, xi in zip(self._shards, self._devices, xs):
+            partial = shard(xi.to_device(device)).to_device(self._devices[0])
+            out = partial if out is None else out + partial
+        if self.bias is not None:
+            out = out + self.bias.data(self._devices[0])
+        return out
+
+
+@use_np
+class VocabParallelEmbedding(_ShardedBlock):
+    """Embedding whose vocabulary is split across devices.
+
+    Shard `i` holds the rows ``[i * input_dim / n, (i + 1) * input_dim / n)`` of the
+    weight and looks up the indices in its range, the other indices giving zeros. The
+    lookups of the shards are summed on the device of the input.
+
+    Parameters
+    ----------
+    input_dim : int
+        Size of the vocabulary, divisible by the number of devices.
+    output_dim : int
+        Dimension of the embeddings.
+    devices : list of Device
+        Device of each shard.
+    dtype, weight_initializer
+        As for :py:class:`mxnet.gluon.nn.Embedding`.
+    """
+    def __init__(self, input_dim, output_dim, devices, dtype='float32',
+                 weight_initializer=None):
+        super(VocabParallelEmbedding, self).__init__(devices)
+        self._shard_dim = _split_size(input_dim, len(self._devices), 'input_dim')
+        self._dtype = dtype
+        self._add_shards([Embedding(self._shard_dim, output_dim, dtype=dtype,
+                                    weight_initializer=weight_initializer)
+                          for _ in self._devices])
+
+    def forward(self, x):
+        self._place_shards()
+        out = None
+        for i, (shard, device) in enumerate(zip(self._shards, self._devices)):
+            local = x.to_device(device) - i * self._shard_dim
+            mask = (local >= 0).astype(self._dtype) * (local < self._shard_dim).astype(self._dtype)
+            emb = shard(np.clip(local, 0, self._shard_dim - 1)) * np.expand_dims(mask, -1)
+            emb = emb.to_device(x.device)
+            out = emb if out is None else out + emb
+        return out
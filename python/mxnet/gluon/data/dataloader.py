@@ -53,19 +53,19 @@ if sys.platform == 'darwin' or sys.platform == 'win32':
         """Reduce ndarray to shared memory handle"""
         return rebuild_ndarray, data._to_shared_mem()
 else:
-    def rebuild_ndarray(pid, fd, shape, dtype):
+    def rebuild_ndarray(pid, fd, shape, dtype, offset):
         """Rebuild ndarray from pickled shared memory"""
         # pylint: disable=no-value-for-parameter
         fd = fd.detach()
-        return nd.NDArray(nd.ndarray._new_from_shared_mem(pid, fd, shape, dtype))
+        return nd.NDArray(nd.ndarray._new_from_shared_mem(pid, fd, shape, dtype, offset))
 
     def reduce_ndarray(data):
         """Reduce ndarray to shared memory handle"""
         # keep a local ref before duplicating fd
         data = data.as_in_context(context.Context('cpu_shared', 0))
-        pid, fd, shape, dtype = data._to_shared_mem()
+        pid, fd, shape, dtype, offset = data._to_shared_mem()
         fd = multiprocessing.reduction.DupFd(fd)
-        return rebuild_ndarray, (pid, fd, shape, dtype)
+        return rebuild_ndarray, (pid, fd, shape, dtype, offset)
 
 ForkingPickler.register(nd.NDArray, reduce_ndarray)
 
@@ -79,19 +79,19 @@ if sys.platform == 'darwin' or sys.platform == 'win32':
         """Reduce ndarray to shared memory handle"""
         return rebuild_np_ndarray, data._to_shared_mem()
 else:
-    def rebuild_np_ndarray(pid, fd, shape, dtype):
+    def rebuild_np_ndarray(pid, fd, shape, dtype, offset):
         """Rebuild ndarray from pickled shared memory"""
         # pylint: disable=no-value-for-parameter
         fd = fd.detach()
-        return _mx_np.ndarray(nd.ndarray._new_from_shared_mem(pid, fd, shape, dtype))
+        return _mx_np.ndarray(nd.ndarray._new_from_shared_mem(pid, fd, shape, dtype, offset))
 
     def reduce_np_ndarray(data):
         """Reduce ndarray to shared memory handle"""
         # keep a local ref before duplicating fd
         data = data.as_in_context(context.Context('cpu_shared', 0))
-        pid, fd, shape, dtype = data._to_shared_mem()
+        pid, fd, shape, dtype, offset = data._to_shared_mem()
         fd = multiprocessing.reduction.DupFd(fd)
-        return rebuild_np_ndarray, (pid, fd, shape, dtype)
+        return rebuild_np_ndarray, (pid, fd, shape, dtype, offset)
 
 ForkingPickler.register(_mx_np.ndarray, reduce_np_ndarray)
 
@@ -764,8 +764,8 @@ class _MXThreadedDataLoader(object):
     num_workers : int, default 0
         The number of multiprocessing workers to use for data preprocessing.
     pin_memory : boolean, default False
-        If ``True``, the dataloader will copy NDArrays into pinned memory
-        before returning them. Copying from CPU pinned memory to GPU is faster
+        If ``True``, the batchify function batchifies into pinned memory, which the batches
+        are returned in. Copying from CPU pinned memory to GPU is faster
         than from normal CPU memory.
     pin_device_id : int, default 0
         The device id to use for allocating pinned memory if pin_memory is ``True``
@@ -777,10 +777,14 @@ class _MXThreadedDataLoader(object):
         but will consume more shared_memory. Using smaller number may forfeit the purpose of using
         multiple worker processes, try reduce `num_workers` in this case.
         By default it defaults to `num_workers * 2`, maximum prefetch size is `16`.
+    num_batchify_workers : int, default 1
+        The number of threads batchifying batches while the workers get the items of the next ones.
+    queue_depth : int, default 2
+        The maximum number of batches being read, transformed or batchified at once.
     """
     def __init__(self, dataset, batch_sampler, batchify_fn,
                  num_workers=0, pin_memory=False, pin_device_id=0,
-                 prefetch=4):
+                 prefetch=4, num_batchify_workers=1, queue_depth=2):
         from ._internal import MXDataset, MXSampler, MXBatchifyFunction
         from ...io.io import ThreadedDataLoader
         assert isinstance(dataset, MXDataset)
@@ -798,7 +802,9 @@ class _MXThreadedDataLoader(object):
         self._iter = ThreadedDataLoader(num_workers=num_workers, dataset=dataset,
                                         sampler=batch_sampler, batchify_fn=batchify_fn,
                                         prefetch_buffer=prefetch, ctx=ctx,
-                                        device_id=pin_device_id)
+                                        device_id=pin_device_id,
+                                        num_batchify_workers=num_batchify_workers,
+                                        queue_depth=queue_depth)
 
     def __iter__(self):
         while self._iter.iter_next():
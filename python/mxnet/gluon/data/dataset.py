@@ -19,10 +19,12 @@
 # pylint: disable=
 """Dataset container."""
 __all__ = ['Dataset', 'SimpleDataset', 'ArrayDataset',
-           'RecordFileDataset']
+           'RecordFileDataset', 'ColumnarDataset']
 
 import os
 
+import numpy as np
+
 from ... import recordio, ndarray
 from ...util import default_array
 
@@ -395,10 +397,14 @@ class RecordFileDataset(Dataset):
     ----------
     filename : str
         Path to rec file.
+    use_mmap : bool, default False
+        Whether the C++ dataset of `__mx_handle__` maps a local rec file into memory and
+        returns records pointing into the mapping, instead of reading and copying each record.
     """
-    def __init__(self, filename):
+    def __init__(self, filename, use_mmap=False):
         self.idx_file = os.path.splitext(filename)[0] + '.idx'
         self.filename = filename
+        self._use_mmap = use_mmap
         self._record = recordio.MXIndexedRecordIO(self.idx_file, self.filename, 'r')
 
     def __getitem__(self, idx):
@@ -409,7 +415,58 @@ class RecordFileDataset(Dataset):
 
     def __mx_handle__(self):
         from ._internal import RecordFileDataset as _RecordFileDataset
-        return _RecordFileDataset(rec_file=self.filename, idx_file=self.idx_file)
+        return _RecordFileDataset(rec_file=self.filename, idx_file=self.idx_file,
+                                  use_mmap=self._use_mmap)
+
+
+class ColumnarDataset(Dataset):
+    """A dataset over the rows of a columnar dataset, a directory of npy files
+    that `mx.io.save_columnar` writes.
+
+    Each sample is a tuple with a row of each column, or the row itself for one column.
+    Rows of CSR columns are returned dense.
+
+    Parameters
+    ----------
+    path : str
+        The directory of the dataset.
+    columns : list of str
+        The columns of a sample.
+    """
+    def __init__(self, path, columns):
+        self._path = path
+        self._columns = list(columns)
+        self._arrays = []
+        for name in self._columns:
+            prefix = os.path.join(path, name)
+            if os.path.exists(prefix + '.npy'):
+                self._arrays.append(np.load(prefix + '.npy', mmap_mode='r'))
+            else:
+                suffixes = ('.data.npy', '.indices.npy', '.indptr.npy', '.shape.npy')
+                self._arrays.append(tuple(np.load(prefix + suffix, mmap_mode='r')
+                                          for suffix in suffixes))
+        self._length = len(self._arrays[0]) if isinstance(self._arrays[0], np.ndarray) \
+            else int(self._arrays[0][3][0])
+
+    def _row(self, array, idx):
+        if isinstance(array, np.ndarray):
+            return np.array(array[idx])
+        data, indices, indptr, shape = array
+        row = np.zeros(int(shape[1]), dtype=data.dtype)
+        row[indices[indptr[idx]:indptr[idx + 1]]] = data[indptr[idx]:indptr[idx + 1]]
+        return row
+
+    def __getitem__(self, idx):
+        if len(self._arrays) == 1:
+            return self._row(self._arrays[0], idx)
+        return tuple(self._row(array, idx) for array in self._arrays)
+
+    def __len__(self):
+        return self._length
+
+    def __mx_handle__(self):
+        from ._internal import ColumnarDataset as _ColumnarDataset
+        return _ColumnarDataset(path=self._path, columns=','.join(self._columns))
 
 
 class _DownloadedDataset(Dataset):
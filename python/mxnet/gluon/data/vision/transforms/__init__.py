@@ -16,7 +16,7 @@
 # under the License.
 
 # coding: utf-8
-# pylint: disable= arguments-differ, wildcard-import
+# pylint: disable= arguments-differ, wildcard-import, protected-access
 "Vision transforms."
 
 import warnings
@@ -31,6 +31,22 @@ from . image import *
 from .image import _append_return
 
 
+def _fuse(transforms):
+    """Fuses the adjacent transforms that have a single-pass equivalent: ToTensor then
+    Normalize, and RandomColorJitter then RandomLighting."""
+    fused = []
+    for t in transforms:
+        prev = fused[-1] if fused else None
+        if type(prev) is ToTensor and type(t) is Normalize:
+            fused[-1] = ToTensorNormalize(t._mean, t._std)
+        elif type(prev) is RandomColorJitter and type(t) is RandomLighting and \
+                prev._args[-1] == 0:
+            fused[-1] = RandomColorJitter(*(prev._args[:-1] + (t._alpha,)))
+        else:
+            fused.append(t)
+    return fused
+
+
 class Compose(Sequential):
     """Sequentially composes multiple transforms.
 
@@ -57,6 +73,7 @@ class Compose(Sequential):
     """
     def __init__(self, transforms):
         super(Compose, self).__init__()
+        transforms = _fuse(transforms)
         transforms.append(None)
         hybrid = []
         for i in transforms:
@@ -104,7 +121,7 @@ class HybridCompose(HybridSequential):
     """
     def __init__(self, transforms):
         super(HybridCompose, self).__init__()
-        for i in transforms:
+        for i in _fuse(transforms):
             if not isinstance(i, HybridBlock):
                 raise ValueError("{} is not a HybridBlock, try use `Compose` instead".format(i))
             self.add(i)
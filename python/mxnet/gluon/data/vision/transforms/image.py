@@ -26,7 +26,7 @@ from .....base import numeric_types
 from .....util import use_np
 from ..... import np, npx
 
-__all__ = ['ToTensor', 'Normalize', 'Rotate', 'RandomRotation',
+__all__ = ['ToTensor', 'Normalize', 'ToTensorNormalize', 'Rotate', 'RandomRotation',
            'RandomResizedCrop', 'CropResize', 'CropResize', 'RandomCrop',
            'CenterCrop', 'Resize', 'RandomFlipLeftRight', 'RandomFlipTopBottom',
            'RandomBrightness', 'RandomContrast', 'RandomSaturation', 'RandomHue',
@@ -140,6 +140,46 @@ class Normalize(HybridBlock):
         return _append_return(npx.image.normalize(x, self._mean, self._std), *args)
 
 
+@use_np
+class ToTensorNormalize(HybridBlock):
+    """Converts an image NDArray or batch of image NDArray to a tensor NDArray and
+    normalizes it with mean and standard deviation.
+
+    This is the same as `ToTensor` followed by `Normalize`, in a single pass over the image::
+
+        output[i] = (input[i] / 255 - mi) / si
+
+    Parameters
+    ----------
+    mean : float or tuple of floats
+        The mean values.
+    std : float or tuple of floats
+        The standard deviation values.
+
+
+    Inputs:
+        - **data**: input tensor with (H x W x C) or (N x H x W x C) shape and uint8 type.
+
+    Outputs:
+        - **out**: output tensor with (C x H x W) or (N x C x H x W) shape and float32 type.
+
+    Examples
+    --------
+    >>> transformer = transforms.ToTensorNormalize(mean=(0.485, 0.456, 0.406),
+    ...                                            std=(0.229, 0.224, 0.225))
+    >>> image = mx.nd.random.uniform(0, 255, (4, 2, 3)).astype(dtype=np.uint8)
+    >>> transformer(image)
+    <NDArray 3x4x2 @cpu(0)>
+    """
+    def __init__(self, mean=0.0, std=1.0):
+        super(ToTensorNormalize, self).__init__()
+        self._mean = mean
+        self._std = std
+
+    def forward(self, x, *args):
+        return _append_return(npx.image.to_tensor_normalize(x, self._mean, self._std), *args)
+
+
 @use_np
 class Rotate(Block):
     """Rotate the input image by a given angle. Keeps the original image shape.
@@ -620,6 +660,9 @@ class RandomColorJitter(HybridBlock):
     hue : float
         How much to jitter hue. hue factor is randomly
         chosen from `[max(0, 1 - hue), 1 + hue]`.
+    lighting : float
+        Intensity of the AlexNet-style PCA-based noise added after the
+        other jitters, as in `RandomLighting`. 0 adds none.
 
 
     Inputs:
@@ -628,9 +671,9 @@ class RandomColorJitter(HybridBlock):
     Outputs:
         - **out**: output tensor with same shape as `data`.
     """
-    def __init__(self, brightness=0, contrast=0, saturation=0, hue=0):
+    def __init__(self, brightness=0, contrast=0, saturation=0, hue=0, lighting=0):
         super(RandomColorJitter, self).__init__()
-        self._args = (brightness, contrast, saturation, hue)
+        self._args = (brightness, contrast, saturation, hue, lighting)
 
     def forward(self, x, *args):
         return _append_return(npx.image.random_color_jitter(x, *self._args), *args)
@@ -1052,6 +1052,15 @@ class SyncBatchNorm(BatchNorm):
         Initializer for the running mean.
     running_variance_initializer: str or `Initializer`, default 'ones'
         Initializer for the running variance.
+    axis : int, default 1
+        The axis that should be normalized. This is typically the channels
+        (C) axis, e.g. 3 for data in NHWC layout.
+    comm : str, default 'shared'
+        How the statistics are synchronized. 'shared' averages them through the host
+        memory across the `num_devices` GPUs of this process. 'nccl' reduces them with
+        NCCL on the GPU streams across all the GPUs of the group set up by
+        :meth:`init_nccl`, which may span processes and machines, and merges the
+        variances of GPUs with different batch sizes exactly.
 
 
     Inputs:
@@ -1068,9 +1077,9 @@ class SyncBatchNorm(BatchNorm):
     def __init__(self, in_channels=0, num_devices=None, momentum=0.9, epsilon=1e-5,
                  center=True, scale=True, use_global_stats=False, beta_initializer='zeros',
                  gamma_initializer='ones', running_mean_initializer='zeros',
-                 running_variance_initializer='ones', **kwargs):
+                 running_variance_initializer='ones', axis=1, comm='shared', **kwargs):
         super(SyncBatchNorm, self).__init__(
-            axis=1, momentum=momentum, epsilon=epsilon,
+            axis=axis, momentum=momentum, epsilon=epsilon,
             center=center, scale=scale,
             use_global_stats=use_global_stats,
             beta_initializer=beta_initializer,
@@ -1078,10 +1087,47 @@ class SyncBatchNorm(BatchNorm):
             running_mean_initializer=running_mean_initializer,
             running_variance_initializer=running_variance_initializer,
             in_channels=in_channels, **kwargs)
-        num_devices = self._get_num_devices() if num_devices is None else num_devices
+        if num_devices is None:
+            num_devices = 1 if comm == 'nccl' else self._get_num_devices()
         self._kwargs = {'eps': epsilon, 'momentum': momentum,
                         'fix_gamma': not scale, 'use_global_stats': use_global_stats,
-                        'ndev': num_devices, 'key': uuid.uuid4()}
+                        'ndev': num_devices, 'key': uuid.uuid4(), 'axis': axis,
+                        'comm': comm}
+
+    @staticmethod
+    def init_nccl(kvstore, devices):
+        """Sets up the NCCL group of the SyncBatchNorm layers with ``comm='nccl'``.
+
+        All the workers of `kvstore` call it once, before the first forward pass, with
+        the same number of GPUs each. The group then holds the GPUs `devices` of every
+        worker, and a layer normalizes over the batches of all of them.
+
+        Parameters
+        ----------
+        kvstore : KVStore
+            The kvstore of the workers, such as a 'dist_sync' or 'horovod' kvstore, or
+            a 'device' kvstore for a single process. It broadcasts the NCCL unique id
+            of the worker of rank 0 to the others.
+        devices : list of Device
+            The GPUs of this worker running SyncBatchNorm.
+        """
+        import ctypes
+        from ...base import _LIB, check_call
+        from ... import ndarray as nd
+        buf = ctypes.create_string_buffer(128)
+        size = ctypes.c_int(0)
+        if kvstore.rank == 0:
+            check_call(_LIB.MXSyncBatchNormGetNCCLUniqueId(buf, ctypes.byref(size)))
+        # the size and bytes of the id, exact in float32
+        uid = nd.array([size.value] + list(bytearray(buf.raw)), dtype='float32')
+        out = nd.zeros_like(uid)
+        kvstore.broadcast('__sync_batch_norm_nccl_id__', uid, out)
+        uid = [int(v) for v in out.asnumpy()]
+        dev_ids = (ctypes.c_int * len(devices))(*[d.device_id for d in devices])
+        check_call(_LIB.MXSyncBatchNormInitNCCL(bytes(uid[1:]), ctypes.c_int(uid[0]),
+                                                ctypes.c_int(kvstore.num_workers),
+                                                ctypes.c_int(kvstore.rank),
+                                                ctypes.c_int(len(devices)), dev_ids))
 
     def _get_num_devices(self):
         warnings.warn("Caution using SyncBatchNorm: "
@@ -89,6 +89,11 @@ class Parameter(object):
         The storage type of the parameter.
     grad_stype: {'default', 'row_sparse', 'csr'}, defaults to 'default'.
         The storage type of the parameter's gradient.
+    grad_dtype : numpy.dtype or str, default None
+        Data type of the parameter's gradient, the same as ``dtype`` by default. Setting
+        ``'float32'`` for a float16 parameter keeps its gradient in float32: backward casts
+        the float16 gradient into it, accumulating in float32 with ``grad_req='add'``, and
+        the optimizer uses it without another copy.
 
     Attributes
     ----------
@@ -105,7 +110,7 @@ class Parameter(object):
     """
     def __init__(self, name='weight', grad_req='write', shape=None, dtype=mx_real_t,
                  lr_mult=1.0, wd_mult=1.0, init=None, allow_deferred_init=False,
-                 differentiable=True, stype='default', grad_stype='default'):
+                 differentiable=True, stype='default', grad_stype='default', grad_dtype=None):
         self._var = None
         self._uuid = str(uuid.uuid4())
         self._var_name = None
@@ -135,6 +140,7 @@ class Parameter(object):
             f"one of 'default', 'row_sparse', or 'csr', but got '{stype}'"
         self._grad_stype = grad_stype
         self._stype = stype
+        self._grad_dtype = grad_dtype
 
     def __repr__(self):
         s = 'Parameter (shape={shape}, dtype={dtype})'
@@ -175,6 +181,20 @@ class Parameter(object):
     def dtype(self, dtype):
         self.cast(dtype)
 
+    @property
+    def grad_dtype(self):
+        """The type of the gradient of the parameter, None for the type of the parameter.
+
+        Setting it reallocates the gradient of an initialized parameter.
+        """
+        return self._grad_dtype
+
+    @grad_dtype.setter
+    def grad_dtype(self, dtype):
+        self._grad_dtype = dtype
+        if self._data is not None and self._grad is not None:
+            self._init_grad()
+
     @property
     def shape(self):
         """The shape of the parameter.
@@ -265,7 +285,7 @@ class Parameter(object):
         return results
 
     @wrap_ctx_to_device_func
-    def _load_init(self, data, device, cast_dtype=False, dtype_source='current'):
+    def _load_init(self, data, device, cast_dtype=False, dtype_source='current', share=False):
         """
         (Re)initializes by loading from data.
         Parameters
@@ -280,6 +300,9 @@ class Parameter(object):
             must be in {'current', 'saved'}
             Only valid if cast_dtype=True, specify the source of the dtype for casting
             the parameters
+        share : bool, default False
+            Whether the parameter may keep `data` itself on the device of `data` instead of
+            a copy, e.g. to keep pointing into a mapped file.
         """
         if cast_dtype:
             assert dtype_source in ['current', 'saved']
@@ -314,7 +337,7 @@ class Parameter(object):
                 device = self._deferred_init[1]
             elif device is None:
                 device = [cpu()]
-            self._init_impl(data, device)
+            self._init_impl(data, device, share)
         else:
             assert device is None or set(device) == set(self.list_device()), \
                 f"Failed to load Parameter '{self.name}' on {str(device)} because it was " \
@@ -352,8 +375,8 @@ class Parameter(object):
 
             self._init_impl(data, device)
 
-    def _init_impl(self, data, device_list):
-        """Sets data and grad."""
+    def _init_impl(self, data, device_list, share=False):
+        """Sets data and grad, keeping `data` itself on its device if `share`."""
         self._device_list = list(device_list)
         self._device_map = [[], []]
         for i, device in enumerate(self._device_list):
@@ -362,7 +385,8 @@ class Parameter(object):
                 dev_list.append(None)
             dev_list[device.device_id] = i
 
-        self._data = [data.copyto(device) for device in self._device_list]
+        self._data = [data if share and data.device == device else data.copyto(device)
+                      for device in self._device_list]
         self._init_grad()
 
     def _init_grad(self):
@@ -375,11 +399,12 @@ class Parameter(object):
             if self._grad_stype != 'default':
                 raise ValueError("Currently stype {} is not supported in NumPy interface and Gluon2.0"
                                  .format(self._grad_stype))
-            self._grad = [_mx_np.zeros(shape=i.shape, dtype=i.dtype, device=i.device)
-                          for i in self._data]
+            self._grad = [_mx_np.zeros(shape=i.shape, dtype=self._grad_dtype or i.dtype,
+                                       device=i.device) for i in self._data]
         else:
-            self._grad = [ndarray.zeros(shape=i.shape, dtype=i.dtype, ctx=i.context,
-                                        stype=self._grad_stype) for i in self._data]
+            self._grad = [ndarray.zeros(shape=i.shape, dtype=self._grad_dtype or i.dtype,
+                                        ctx=i.context, stype=self._grad_stype)
+                          for i in self._data]
 
         autograd.mark_variables(self._check_and_get(self._data, list),
                                 self._grad, self.grad_req)
@@ -676,7 +701,7 @@ class Parameter(object):
             self._data = [i.astype(dtype) for i in self._data]
             if self._grad is None:
                 return
-            self._grad = [i.astype(dtype) for i in self._grad]
+            self._grad = [i.astype(self._grad_dtype or dtype) for i in self._grad]
             autograd.mark_variables(self._data, self._grad, self.grad_req)
 
     def _check_and_setattr(self, **kwargs):
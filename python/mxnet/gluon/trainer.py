@@ -23,10 +23,14 @@ __all__ = ['Trainer']
 import warnings
 from collections import OrderedDict
 
+import numpy
+
+from .. import autograd, ndarray
 from .. import optimizer as opt
 from ..model import _create_kvstore, _create_sparse_kvstore
 from .parameter import Parameter
 from ..kvstore import KVStore
+from ..util import is_np_array
 
 
 class Trainer(object):
@@ -66,9 +70,16 @@ class Trainer(object):
     update_on_kvstore : bool, default None
         Whether to perform parameter updates on kvstore. If None and optimizer.aggregate_num <= 1,
         then trainer will choose the more suitable option depending on the type of kvstore.
-        If None and optimizer.aggregate_num > 1, `update_on_kvstore` is set to False.
+        If None and optimizer.aggregate_num > 1 or optimizer.flat_update is set,
+        `update_on_kvstore` is set to False.
         If the `update_on_kvstore` argument is provided,
         environment variable `MXNET_UPDATE_ON_KVSTORE` will be ignored.
+    clip_global_norm : float, default None
+        If set, the gradients are rescaled so that their global L2 norm is at most
+        `clip_global_norm`. The norm and the overflow check of AMP are computed in one pass
+        over the gradients, and the unscaling and clipping are applied by the update, so that
+        the gradients are read twice per step. Steps whose gradients are not finite are
+        skipped. Requires `update_on_kvstore` to be False and dense gradients.
 
     Properties
     ----------
@@ -77,7 +88,7 @@ class Trainer(object):
         optimizer, its learning rate can be accessed as optimizer.learning_rate.
     """
     def __init__(self, params, optimizer, optimizer_params=None, kvstore='device',
-                 compression_params=None, update_on_kvstore=None):
+                 compression_params=None, update_on_kvstore=None, clip_global_norm=None):
         param_list = []
         if isinstance(params, (dict, OrderedDict)):
             for key in sorted(list(params.keys())):
@@ -118,6 +129,24 @@ class Trainer(object):
                                  "when optimizer.aggregate_num > 1.")
         if update_on_kvstore is None and self._optimizer.aggregate_num > 1:
             update_on_kvstore = False
+        self._flat_update = getattr(self._optimizer, 'flat_update', False)
+        self._flat_groups = None
+        if self._flat_update:
+            if type(self._optimizer).flat_step is opt.Optimizer.flat_step:
+                raise ValueError(f"Optimizer {type(self._optimizer).__name__} does not "
+                                 "support flat_update.")
+            if update_on_kvstore:
+                raise ValueError("Cannot set update_on_kvstore=True "
+                                 "when optimizer.flat_update is set.")
+            update_on_kvstore = False
+        self._clip_global_norm = clip_global_norm
+        if clip_global_norm is not None:
+            if update_on_kvstore:
+                raise ValueError("Cannot set update_on_kvstore=True "
+                                 "when clip_global_norm is set.")
+            if self._contains_sparse_grad:
+                raise ValueError("clip_global_norm is not supported with sparse gradients.")
+            update_on_kvstore = False
         self._kvstore_params = {'kvstore': kvstore, 'update_on_kvstore': update_on_kvstore}
         self._kv_initialized = False
         self._kvstore = None
@@ -450,7 +479,16 @@ class Trainer(object):
 
     def _update(self, ignore_stale_grad=False):
         loss_scaler = getattr(self, '_amp_loss_scaler', None)
-        if loss_scaler is not None:
+        if self._clip_global_norm is not None:
+            has_overflow = not self._clip_by_global_norm()
+            if loss_scaler is not None:
+                loss_scaler.update_scale(has_overflow)
+            elif has_overflow:
+                warnings.warn(UserWarning('nan or inf is detected in the gradients, '
+                                          'the update is skipped.'), stacklevel=2)
+            if has_overflow:
+                return  # skip on overflow
+        elif loss_scaler is not None:
             if loss_scaler.has_overflow(self._params):
                 return  # skip on overflow
 
@@ -480,11 +518,117 @@ class Trainer(object):
                     arr._fresh_grad = False
 
         if not (self._kvstore and self._update_on_kvstore):
+            if self._flat_update:
+                updates = self._update_flat(updates)
             for updater, upd in zip(self._updaters, updates):
                 if upd:
                     i, g, w = zip(*upd)
                     updater(i, g, w)
 
+    def _clip_by_global_norm(self):
+        """Computes the global norm of the gradients, unscaled by `optimizer.rescale_grad`,
+        with one `multi_global_norm` per dtype, and folds its clipping into the rescale_grad
+        of the update. The gradients of the first device are the reduced ones of all devices.
+        Returns False if the norm is not finite."""
+        if is_np_array():
+            global_norm_f = ndarray.numpy._internal.multi_global_norm
+        else:
+            global_norm_f = ndarray.multi_global_norm
+        groups = OrderedDict()
+        for param in self._params:
+            if param.grad_req != 'null' and param._grad is not None:
+                grad = param._grad[0]
+                groups.setdefault(numpy.dtype(grad.dtype), []).append(grad)
+        scale = self._optimizer.rescale_grad
+        with autograd.pause():
+            norms = [global_norm_f(*grads, num_arrays=len(grads), scale=scale)[0]
+                     for grads in groups.values()]
+        # the only synchronization of the step
+        total_norm = float(numpy.sqrt(sum(float(norm.asnumpy()[0]) ** 2 for norm in norms)))
+        if not numpy.isfinite(total_norm):
+            return False
+        if total_norm > self._clip_global_norm:
+            self._optimizer.rescale_grad = scale * self._clip_global_norm / (total_norm + 1e-8)
+        return True
+
+    def _init_flat_groups(self):
+        """Moves the dense parameters of each device and dtype into flat buffers of the
+        weights and gradients. The parameters keep views into the buffers, so that their
+        whole group is updated by a single `Optimizer.flat_step`."""
+        groups = OrderedDict()
+        for i, param in enumerate(self._params):
+            if param.grad_req == 'null' or param._data is None or param._grad is None or \
+                    param._stype != 'default' or param._grad_stype != 'default':
+                continue
+            data = param._data[0]
+            # fp16 weights with a master copy, bf16 weights, weights with gradients of
+            # another dtype and empty weights take the per-parameter path
+            if data.size == 0 or (self._optimizer.multi_precision and
+                                  numpy.dtype(data.dtype) == numpy.float16) or \
+                    data.dtype == ndarray.bfloat16 or \
+                    numpy.dtype(param._grad[0].dtype) != numpy.dtype(data.dtype):
+                continue
+            groups.setdefault(numpy.dtype(data.dtype), []).append(i)
+
+        self._flat_groups = [[] for _ in self._updaters]
+        with autograd.pause():
+            for indices in groups.values():
+                params = [self._params[i] for i in indices]
+                sizes = [param._data[0].size for param in params]
+                offsets = numpy.cumsum([0] + sizes).tolist()
+                for d, device_groups in enumerate(self._flat_groups):
+                    datas = [param._data[d] for param in params]
+                    grads = [param._grad[d] for param in params]
+                    device = datas[0].context
+                    flat_weight = _flat_concat(datas)
+                    flat_grad = _flat_concat(grads)
+                    weights = _flat_views(flat_weight, offsets, datas)
+                    grads_views = _flat_views(flat_grad, offsets, grads)
+                    for param, old, weight, grad in zip(params, datas, weights, grads_views):
+                        weight._fresh_grad = old._fresh_grad
+                        param._data[d] = weight
+                        param._grad[d] = grad
+                    device_groups.append({
+                        'indices': indices, 'weight': flat_weight, 'grad': flat_grad,
+                        'offsets': ndarray.array(offsets, ctx=device, dtype='int64'),
+                        'weights': weights, 'grads': grads_views})
+            for params in ([self._params[i] for i in indices] for indices in groups.values()):
+                for param in params:
+                    autograd.mark_variables(param._data, param._grad, param.grad_req)
+
+    def _flat_groups_valid(self):
+        """Whether the parameters still hold the views into the flat buffers, which they
+        do not after, e.g., `Parameter.cast` or `Parameter.reset_device`."""
+        if self._flat_groups is None or len(self._flat_groups) != len(self._updaters):
+            return False
+        for d, device_groups in enumerate(self._flat_groups):
+            for group in device_groups:
+                for i, weight, grad in zip(group['indices'], group['weights'], group['grads']):
+                    param = self._params[i]
+                    if param.grad_req == 'null' or param._data is None or \
+                            param._grad is None or len(param._data) != len(self._updaters) or \
+                            param._data[d] is not weight or param._grad[d] is not grad:
+                        return False
+        return True
+
+    def _update_flat(self, updates):
+        """Updates the flat groups whose parameters all have fresh gradients with
+        `Updater.update_flat`, and returns the remaining per-parameter updates."""
+        if not self._flat_groups_valid():
+            self._init_flat_groups()
+        remaining = []
+        for updater, upd, device_groups in zip(self._updaters, updates, self._flat_groups):
+            pending = {i: (g, w) for i, g, w in upd}
+            for group in device_groups:
+                if any(i not in pending for i in group['indices']):
+                    continue
+                for i in group['indices']:
+                    del pending[i]
+                updater.update_flat(group['indices'], group['grad'], group['weight'],
+                                    group['offsets'], group['weights'])
+            remaining.append([(i, g, w) for i, g, w in upd if i in pending])
+        return remaining
+
     def save_states(self, fname):
         """Saves trainer states (e.g. optimizer, momentum) to a file.
 
@@ -545,3 +689,18 @@ class Trainer(object):
             self._optimizer = self._updaters[0].optimizer
         param_dict = {i: param for i, param in enumerate(self._params)}
         self._optimizer.param_dict = param_dict
+
+
+def _flat_concat(arrays):
+    """Concatenates the flattened arrays into one flat buffer."""
+    flat = ndarray.concat(*[a.as_nd_ndarray().reshape((-1,)) if is_np_array() else
+                            a.reshape((-1,)) for a in arrays], dim=0)
+    return flat.as_np_ndarray() if is_np_array() else flat
+
+
+def _flat_views(flat, offsets, arrays):
+    """Views into a flat buffer with the shapes of the arrays."""
+    classic = flat.as_nd_ndarray() if is_np_array() else flat
+    views = [classic[begin:end].reshape(a.shape)
+             for begin, end, a in zip(offsets[:-1], offsets[1:], arrays)]
+    return [v.as_np_ndarray() for v in views] if is_np_array() else views
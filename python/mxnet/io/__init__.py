@@ -22,9 +22,9 @@
 """ Data iterators for common data formats and utility functions."""
 
 from . import io
-from .io import CSVIter, DataBatch, DataDesc, DataIter, ImageDetRecordIter, ImageRecordInt8Iter, ImageRecordIter,\
+from .io import ColumnarIter, CSVIter, DataBatch, DataDesc, DataIter, ImageDetRecordIter, ImageRecordInt8Iter, ImageRecordIter,\
     ImageRecordIter_v1, ImageRecordUInt8Iter, ImageRecordUInt8Iter_v1, LibSVMIter, MNISTIter, MXDataIter, NDArrayIter,\
-    PrefetchingIter, ResizeIter
+    PrefetchingIter, ResizeIter, save_columnar
 
 from . import utils
 from .utils import _init_data, _getdata_by_idx, _has_instance
@@ -22,6 +22,7 @@ from collections import namedtuple
 
 import sys
 import ctypes
+import os
 import logging
 import threading
 import numpy as np
@@ -931,6 +932,29 @@ class MXDataIter(DataIter):
         return length.value
 
 
+def save_columnar(path, columns):
+    """Saves columns of the same number of rows as a columnar dataset,
+    which `ColumnarIter` and `gluon.data.ColumnarDataset` read.
+
+    Parameters
+    ----------
+    path : str
+        The directory of the dataset, created if missing.
+    columns : dict of str to numpy.ndarray or scipy.sparse.csr_matrix
+        The columns by name. A dense column is saved as ``name.npy``, a CSR column
+        as ``name.data.npy``, ``name.indices.npy``, ``name.indptr.npy`` and ``name.shape.npy``.
+    """
+    os.makedirs(path, exist_ok=True)
+    for name, column in columns.items():
+        prefix = os.path.join(path, name)
+        if hasattr(column, 'indptr'):
+            np.save(prefix + '.data.npy', np.ascontiguousarray(column.data))
+            np.save(prefix + '.indices.npy', np.asarray(column.indices, dtype=np.int64))
+            np.save(prefix + '.indptr.npy', np.asarray(column.indptr, dtype=np.int64))
+            np.save(prefix + '.shape.npy', np.asarray(column.shape, dtype=np.int64))
+        else:
+            np.save(prefix + '.npy', np.ascontiguousarray(column))
+
 def _make_io_iterator(handle):
     """Create an io iterator by handle."""
     name = ctypes.c_char_p()
@@ -46,7 +46,9 @@ def _get_kvstore_server_command_type(command):
                      'kStopServer': 2,
                      'kSyncMode': 3,
                      'kSetGradientCompression': 4,
-                     'kSetProfilerParams': 5}
+                     'kSetProfilerParams': 5,
+                     'kSetNumPushers': 6,
+                     'kSaveCheckpoint': 7}
     assert (command in command_types), "Unknown command type to send to server"
     return command_types[command]
 
@@ -538,13 +540,20 @@ class KVStore(KVStoreBase):
         a dictionary which includes `threshold` like:
         {'type': '2bit', 'threshold': 0.5}
 
+        With `type` `topk`, only the largest value of every `1 / ratio` consecutive
+        gradient values is sent, e.g. {'type': 'topk', 'ratio': 0.01}.
+        With `type` `powersgd`, blocks of `block_size` x `block_size` gradient values
+        are sent as a rank `rank` approximation, e.g.
+        {'type': 'powersgd', 'rank': 1, 'block_size': 64}.
+        Both keep the difference to the sent values as residual.
+
         Parameters
         ----------
         compression_params : dict
             A dictionary specifying the type and parameters for gradient compression.
             The key `type` in this dictionary is a
             required string argument and specifies the type of gradient compression.
-            Currently `type` can be only `1bit` and `2bit`
+            Currently `type` can be `1bit`, `2bit`, `topk` or `powersgd`
             Other keys in this dictionary are optional and specific to the type
             of gradient compression.
         """
@@ -563,6 +572,8 @@ class KVStore(KVStoreBase):
         If using multiple machines and this operation is invoked from a worker node,
         it will serialized the optimizer with pickle and send it to all servers.
         The function returns after all servers have been updated.
+        With `dist_sync_nccl`, parameters are not stored on the servers and every worker
+        updates its local optimizer instead.
 
         Parameters
         ----------
@@ -590,7 +601,8 @@ class KVStore(KVStoreBase):
         check_call(_LIB.MXKVStoreIsWorkerNode(ctypes.byref(is_worker)))
 
         # pylint: disable=invalid-name
-        if 'dist' in self.type and is_worker.value: # pylint: disable=unsupported-membership-test
+        # pylint: disable=unsupported-membership-test
+        if 'dist' in self.type and 'nccl' not in self.type and is_worker.value:
             # send the optimizer to server
             try:
                 # use ASCII protocol 0, might be slower, but not a big ideal
@@ -671,6 +683,28 @@ class KVStore(KVStoreBase):
         assert self._updater is not None, "Cannot load states for distributed training"
         self._updater.set_states(open(fname, 'rb').read())
 
+    def save_server_checkpoint(self, prefix):
+        """Saves the values stored on the servers of a distributed kvstore to files.
+
+        Every server saves the keys, or the parts of big keys, it holds to
+        ``prefix-server<rank>.params``, in the format of :py:func:`mxnet.nd.save`
+        with the integer keys as names. The servers take a consistent snapshot of
+        their values and write it in the background, so this function returns
+        without waiting for the files and training goes on meanwhile. Only the
+        worker of rank 0 sends the command.
+
+        Parameters
+        ----------
+        prefix : str
+            Path prefix of the files, which is relative to the working directory
+            of the servers.
+        """
+        assert 'dist' in self.type and 'nccl' not in self.type, \
+            "Only distributed kvstore with servers can save server checkpoints"
+        if self.rank == 0:
+            cmd = _get_kvstore_server_command_type('kSaveCheckpoint')
+            self._send_command_to_servers(cmd, prefix)
+
     def _set_updater(self, updater):
         """Sets a push updater into the store.
 
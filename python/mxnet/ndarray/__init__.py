@@ -27,7 +27,8 @@ from . import register
 from .op import *
 from .ndarray import *
 # pylint: enable=wildcard-import
-from .utils import load, load_frombuffer, save, zeros, empty, array
+from .utils import load, load_frombuffer, save, zeros, empty, array, save_sharded, load_sharded, \
+    deduplicate, export_cuda_ipc, import_cuda_ipc, release_cuda_ipc
 from .sparse import _ndarray_cls
 from .ndarray import _GRAD_REQ_MAP, dtype_mx_to_np, dtype_np_to_mx, _new_empty_handle
 from . import numpy as np
@@ -60,6 +60,7 @@ _STORAGE_TYPE_UNDEFINED = -1
 _STORAGE_TYPE_DEFAULT = 0
 _STORAGE_TYPE_ROW_SPARSE = 1
 _STORAGE_TYPE_CSR = 2
+_STORAGE_TYPE_BSR = 3
 _SIGNED_INT32_UPPER_LIMIT = (2**31 - 1)
 
 bfloat16 = np.dtype([('bfloat16', np.uint16)])
@@ -141,6 +142,7 @@ _STORAGE_TYPE_STR_TO_ID = {
     'default': _STORAGE_TYPE_DEFAULT,
     'row_sparse': _STORAGE_TYPE_ROW_SPARSE,
     'csr': _STORAGE_TYPE_CSR,
+    'bsr': _STORAGE_TYPE_BSR,
 }
 
 _STORAGE_TYPE_ID_TO_STR = {
@@ -148,6 +150,7 @@ _STORAGE_TYPE_ID_TO_STR = {
     _STORAGE_TYPE_DEFAULT: 'default',
     _STORAGE_TYPE_ROW_SPARSE: 'row_sparse',
     _STORAGE_TYPE_CSR: 'csr',
+    _STORAGE_TYPE_BSR: 'bsr',
 }
 
 _GRAD_REQ_MAP = {
@@ -192,6 +195,37 @@ def _new_empty_handle():
     return hdl
 
 
+class AsyncCopy(object):
+    """Handle of a copy of an NDArray into a numpy.ndarray started by
+    ``NDArray.asnumpy_async``."""
+    __slots__ = ['handle', '_data', '_src']
+
+    def __init__(self, handle, data, src):
+        self.handle = handle
+        self._data = data
+        # keeps the source alive until the copy is done
+        self._src = src
+
+    def __del__(self):
+        if self.handle is not None:
+            if self._src is not None:
+                # the copy may still write into the data, which is freed with this handle
+                _LIB.MXNDArrayWaitAsyncCopy(self.handle)
+            check_call(_LIB.MXNDArrayFreeAsyncCopy(self.handle))
+            self.handle = None
+
+    def wait(self):
+        """Blocks until the copy is done, raising the error of the copy or of the operations
+        writing the source array."""
+        check_call(_LIB.MXNDArrayWaitAsyncCopy(self.handle))
+        self._src = None
+
+    def result(self):
+        """Waits for the copy and returns the numpy.ndarray holding it."""
+        self.wait()
+        return self._data
+
+
 def _new_alloc_handle(shape, ctx, delay_alloc, dtype=mx_real_t):
     """Return a new handle with specified shape and context.
 
@@ -233,11 +267,12 @@ def _new_alloc_handle(shape, ctx, delay_alloc, dtype=mx_real_t):
     return hdl
 
 
-def _new_from_shared_mem(shared_pid, shared_id, shape, dtype):
+def _new_from_shared_mem(shared_pid, shared_id, shape, dtype, shared_offset=0):
     hdl = NDArrayHandle()
-    check_call(_LIB.MXNDArrayCreateFromSharedMem(
+    check_call(_LIB.MXNDArrayCreateFromSharedMemEx(
         ctypes.c_int(shared_pid),
         ctypes.c_int(shared_id),
+        ctypes.c_uint64(shared_offset),
         c_array(mx_int, shape),
         mx_int(len(shape)),
         ctypes.c_int(int(dtype_np_to_mx(dtype))),
@@ -245,6 +280,18 @@ def _new_from_shared_mem(shared_pid, shared_id, shape, dtype):
     return hdl
 
 
+def _new_from_cuda_ipc(ipc_handle, shape, dtype, device_id):
+    hdl = NDArrayHandle()
+    check_call(_LIB.MXNDArrayCreateFromCudaIpcHandle(
+        ctypes.c_char_p(ipc_handle),
+        c_array(mx_int, shape),
+        mx_int(len(shape)),
+        ctypes.c_int(int(dtype_np_to_mx(dtype))),
+        ctypes.c_int(device_id),
+        ctypes.byref(hdl)))
+    return hdl
+
+
 def waitall():
     """Wait for all async operations to finish in MXNet.
 
@@ -311,9 +358,16 @@ fixed-size items.
     def _to_shared_mem(self):
         shared_pid = ctypes.c_int()
         shared_id = ctypes.c_int()
-        check_call(_LIB.MXNDArrayGetSharedMemHandle(
-            self.handle, ctypes.byref(shared_pid), ctypes.byref(shared_id)))
-        return shared_pid.value, shared_id.value, self.shape, self.dtype
+        shared_offset = ctypes.c_uint64()
+        check_call(_LIB.MXNDArrayGetSharedMemHandleEx(
+            self.handle, ctypes.byref(shared_pid), ctypes.byref(shared_id),
+            ctypes.byref(shared_offset)))
+        return shared_pid.value, shared_id.value, self.shape, self.dtype, shared_offset.value
+
+    def _to_cuda_ipc(self):
+        ipc_handle = ctypes.create_string_buffer(64)
+        check_call(_LIB.MXNDArrayGetCudaIpcHandle(self.handle, ipc_handle))
+        return ipc_handle.raw, self.shape, self.dtype, self.ctx.device_id
 
     def __abs__(self):
         """x.__abs__() <=> abs(x) <=> x.abs() <=> mx.nd.abs(x, y)"""
@@ -2658,6 +2712,48 @@ fixed-size items.
             ctypes.c_size_t(data.size)))
         return data
 
+    def asnumpy_async(self, out=None):
+        """Starts copying this array into a ``numpy.ndarray`` without waiting for it.
+
+        The copy runs in the engine once the pending writes to this array are done, from a
+        GPU through a pinned staging buffer, and doesn't block the pushing of the other
+        operations. The returned handle waits for this array only, not for all the engine.
+
+        Parameters
+        ----------
+        out : numpy.ndarray, optional
+            A C contiguous array with the shape and the dtype of this array to copy into.
+            It must not be used until the copy is done.
+
+        Returns
+        -------
+        AsyncCopy
+            The handle of the copy, whose ``result()`` waits and returns the ``numpy.ndarray``.
+
+        Examples
+        --------
+        >>> x = mx.nd.ones((2,3))
+        >>> copy = x.asnumpy_async()
+        >>> copy.result()
+        array([[ 1.,  1.,  1.],
+               [ 1.,  1.,  1.]], dtype=float32)
+        """
+        if self.dtype == bfloat16:
+            return self.astype(np.float32).asnumpy_async(out)
+        if out is None:
+            out = np.empty(self.shape, dtype=self.dtype)
+        elif not isinstance(out, np.ndarray) or out.shape != self.shape or \
+                out.dtype != self.dtype or not out.flags['C_CONTIGUOUS']:
+            raise ValueError('out must be a C contiguous numpy.ndarray of shape %s and dtype %s'
+                             % (str(self.shape), str(self.dtype)))
+        handle = ctypes.c_void_p()
+        check_call(_LIB.MXNDArrayAsyncCopyToCPU(
+            self.handle,
+            out.ctypes.data_as(ctypes.c_void_p),
+            ctypes.c_size_t(out.size),
+            ctypes.byref(handle)))
+        return AsyncCopy(handle, out, self)
+
     def asscalar(self):
         """Returns a scalar whose value is copied from this array.
 
@@ -2969,22 +3065,32 @@ fixed-size items.
             ctypes.c_void_p(0),
             ctypes.c_void_p(0)))
 
-    def tostype(self, stype):
+    def tostype(self, stype, block_shape=None):
         """Return a copy of the array with chosen storage type.
 
         See Also
         ----------
         :meth:`mxnet.ndarray.cast_storage`.
 
+        Parameters
+        ----------
+        stype : str
+            The storage type of the copy.
+        block_shape : tuple of int, optional
+            The (rows, columns) shape of the blocks of a 'bsr' copy, (1, 1) by default.
+
         Returns
         -------
-        NDArray, CSRNDArray or RowSparseNDArray
+        NDArray, CSRNDArray, RowSparseNDArray or BSRNDArray
             A copy of the array with the chosen storage stype
         """
-        if stype == 'csr' and len(self.shape) != 2:
-            raise ValueError("To convert to a CSR, the NDArray should be 2 Dimensional. Current "
-                             f"shape is {str(self.shape)}")
-
+        if stype in ('csr', 'bsr') and len(self.shape) != 2:
+            raise ValueError(f"To convert to a {stype.upper()}, the NDArray should be 2 "
+                             f"Dimensional. Current shape is {str(self.shape)}")
+        if block_shape is not None:
+            if stype != 'bsr':
+                raise ValueError("block_shape is only supported when converting to bsr")
+            return op.cast_storage(self, stype=stype, block_shape=block_shape)
         return op.cast_storage(self, stype=stype)
 
     def to_dlpack_for_read(self):
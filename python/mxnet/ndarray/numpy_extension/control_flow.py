@@ -150,7 +150,7 @@ def _construct_subgraph(sym_out, sym_states):
     return symbol.Group(flat_out)
 
 @set_module('mxnet.ndarray.numpy_extension')
-def foreach(body, data, init_states, name="foreach"):
+def foreach(body, data, init_states, name="foreach", compiled=False):
     """Run a for loop with user-defined computation over NDArrays on dimension 0.
 
     This operator simulates a for loop and body has the computation for an iteration
@@ -189,6 +189,10 @@ def foreach(body, data, init_states, name="foreach"):
         The input data.
     init_states: an NDArray or nested lists of NDArrays.
         The initial values of the loop states.
+    compiled: bool, optional
+        For inference, run body on the same arrays in every iteration, so that it is planned
+        once and pushed as a whole instead of dispatching its operators in each iteration.
+        body must have static shapes. Training runs the loop as usual.
 
     Returns
     -------
@@ -295,7 +299,7 @@ def foreach(body, data, init_states, name="foreach"):
     ordered_ins = in_data + in_states + params
 
     ndoutput = _api_internal.foreach(g.handle, *ordered_ins, num_outputs, num_out_data, in_state_locs,
-                                     in_data_locs, remain_locs, in_state_index)
+                                     in_data_locs, remain_locs, in_state_index, compiled)
     if isinstance(ndoutput, NDArrayBase):
         ret = ndoutput
     else:
@@ -314,7 +318,7 @@ def foreach(body, data, init_states, name="foreach"):
 
 #pylint: disable=W0621
 @set_module('mxnet.ndarray.numpy_extension')
-def while_loop(cond, func, loop_vars, max_iterations=None, name="while_loop"):
+def while_loop(cond, func, loop_vars, max_iterations=None, name="while_loop", compiled=False):
     """Run a while loop with user-defined computation and loop condition.
 
     This operator simulates a while loop which iterately does customized computation
@@ -368,6 +372,12 @@ def while_loop(cond, func, loop_vars, max_iterations=None, name="while_loop"):
         The initial values of the loop variables.
     max_iterations: a python int.
         Maximum number of iterations.
+    compiled: bool, optional
+        For inference, run `cond` and `func` on the same arrays in every step, so that they
+        are planned once and pushed as a whole, and push `func` before waiting for `cond`
+        so that the device runs it while the host reads `cond`. `func` must have static
+        shapes and be safe to run once more on the `loop_vars` ending the loop.
+        Training runs the loop as usual.
 
     Returns
     ------
@@ -553,7 +563,8 @@ def while_loop(cond, func, loop_vars, max_iterations=None, name="while_loop"):
         func_input_locs,
         func_var_locs,
         num_out_data,
-        num_outputs
+        num_outputs,
+        compiled
     )
     if isinstance(result, np_ndarray):
         ret = [result]
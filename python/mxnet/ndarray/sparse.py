@@ -31,8 +31,8 @@ import warnings
 import operator
 from array import array as native_array
 
-__all__ = ["_ndarray_cls", "csr_matrix", "row_sparse_array",
-           "BaseSparseNDArray", "CSRNDArray", "RowSparseNDArray",
+__all__ = ["_ndarray_cls", "csr_matrix", "row_sparse_array", "bsr_matrix",
+           "BaseSparseNDArray", "CSRNDArray", "RowSparseNDArray", "BSRNDArray",
            "add", "subtract", "multiply", "divide"]
 
 import numpy as np
@@ -50,6 +50,7 @@ except ImportError:
 from ._internal import _set_ndarray_class
 from .ndarray import NDArray, _storage_type, dtype_np_to_mx, dtype_mx_to_np
 from .ndarray import _STORAGE_TYPE_STR_TO_ID, _STORAGE_TYPE_ROW_SPARSE, _STORAGE_TYPE_CSR, _int64_enabled
+from .ndarray import _STORAGE_TYPE_BSR
 from .ndarray import _STORAGE_TYPE_UNDEFINED, _STORAGE_TYPE_DEFAULT
 from .ndarray import zeros as _zeros_ndarray
 from .ndarray import array as _array
@@ -63,7 +64,8 @@ except ImportError:
 
 _STORAGE_AUX_TYPES = {
     'row_sparse': [np.int64],
-    'csr': [np.int64, np.int64]
+    'csr': [np.int64, np.int64],
+    'bsr': [np.int64, np.int64]
 }
 
 
@@ -806,6 +808,146 @@ class RowSparseNDArray(BaseSparseNDArray):
             raise ImportError("gen_sparse could not be imported")
         return gs_retain(*args, **kwargs)
 
+# pylint: disable=abstract-method
+class BSRNDArray(BaseSparseNDArray):
+    """A sparse representation of 2D NDArray in the Block Compressed Sparse Row format.
+
+    A BSRNDArray splits a matrix into blocks of a fixed (rows, columns) shape and keeps its
+    non-zero blocks in three separate arrays: `data`, `indptr` and `indices`. The block column
+    indices of block row i are stored in ``indices[indptr[i]:indptr[i+1]]`` and the
+    corresponding blocks in ``data[indptr[i]:indptr[i+1]]``, so that `data` has the shape
+    (number of non-zero blocks, block rows, block columns). The dense blocks suit the
+    adjacency matrices of graph neural networks and the masks of block sparse attention.
+
+    Example
+    -------
+    >>> a = mx.nd.array([[0, 1, 0, 0], [2, 0, 0, 0], [0, 0, 0, 0], [0, 0, 3, 0]])
+    >>> a = a.tostype('bsr', block_shape=(2, 2))
+    >>> a.data.asnumpy()
+    array([[[ 0.,  1.],
+            [ 2.,  0.]],
+    <BLANKLINE>
+           [[ 0.,  0.],
+            [ 3.,  0.]]], dtype=float32)
+    >>> a.indices.asnumpy()
+    array([0, 1])
+    >>> a.indptr.asnumpy()
+    array([0, 1, 2])
+
+    See Also
+    --------
+    bsr_matrix: Several ways to construct a BSRNDArray
+    """
+
+    def __reduce__(self):
+        return BSRNDArray, (None,), super(BSRNDArray, self).__getstate__()
+
+    @property
+    def block_shape(self):
+        """The (rows, columns) shape of the blocks of the BSRNDArray."""
+        return self._data().shape[1:]
+
+    @property
+    def indices(self):
+        """A deep copy NDArray of the block column indices array of the BSRNDArray.
+
+        Returns
+        -------
+        NDArray
+            This BSRNDArray's indices array.
+        """
+        return self._aux_data(1)
+
+    @property
+    def indptr(self):
+        """A deep copy NDArray of the block indptr array of the BSRNDArray.
+
+        Returns
+        -------
+        NDArray
+            This BSRNDArray's indptr array.
+        """
+        return self._aux_data(0)
+
+    @property
+    def data(self):
+        """A deep copy NDArray of the blocks of the BSRNDArray.
+
+        Returns
+        -------
+        NDArray
+            This BSRNDArray's data array.
+        """
+        return self._data()
+
+    @indices.setter
+    def indices(self, indices):
+        raise NotImplementedError()
+
+    @indptr.setter
+    def indptr(self, indptr):
+        raise NotImplementedError()
+
+    @data.setter
+    def data(self, data):
+        raise NotImplementedError()
+
+    def tostype(self, stype):
+        """Return a copy of the array with chosen storage type.
+
+        Returns
+        -------
+        NDArray or BSRNDArray
+            A copy of the array with the chosen storage stype
+        """
+        # pylint: disable= no-member, protected-access
+        if stype not in ('default', 'bsr'):
+            raise ValueError(f"cast_storage from bsr to {stype} is not supported")
+        return op.cast_storage(self, stype=stype)
+        # pylint: enable= no-member, protected-access
+
+    def copyto(self, other):
+        """Copies the value of this array to another array.
+
+        If ``other`` is a ``NDArray`` or ``BSRNDArray`` object, then ``other.shape`` and
+        ``self.shape`` should be the same. This function copies the value from
+        ``self`` to ``other``. A ``BSRNDArray`` destination takes the block shape of ``self``.
+
+        If ``other`` is a context, a new ``BSRNDArray`` will be first created on
+        the target context, and the value of ``self`` is copied.
+
+        Parameters
+        ----------
+        other : NDArray or BSRNDArray or Context
+            The destination array or context.
+
+        Returns
+        -------
+        NDArray or BSRNDArray
+            The copied array.
+        """
+        if isinstance(other, Device):
+            return super(BSRNDArray, self).copyto(other)
+        elif isinstance(other, NDArray):
+            stype = other.stype
+            if stype in ('default', 'bsr'):
+                return super(BSRNDArray, self).copyto(other)
+            else:
+                raise TypeError('copyto does not support destination NDArray stype ' + str(stype))
+        else:
+            raise TypeError('copyto does not support type ' + str(type(other)))
+
+    def asscipy(self):
+        """Returns a ``scipy.sparse.bsr_matrix`` object with value copied from this array
+        """
+        data = self.data.asnumpy()
+        indices = self.indices.asnumpy()
+        indptr = self.indptr.asnumpy()
+        if not spsp:
+            raise ImportError("scipy could not be imported. "
+                              "Please make sure that the scipy is installed.")
+        return spsp.bsr_matrix((data, indices, indptr), shape=self.shape, dtype=self.dtype)
+
 def _prepare_src_array(source_array, dtype):
     """Prepare `source_array` so that it can be used to construct NDArray.
     `source_array` is converted to a `np.ndarray` if it's neither an `NDArray` \
@@ -1190,6 +1332,122 @@ def _row_sparse_ndarray_from_definition(data, indices, shape=None, ctx=None,
     check_call(_LIB.MXNDArraySyncCopyFromNDArray(result.handle, indices.handle, ctypes.c_int(0)))
     return result
 
+def bsr_matrix(arg1, shape=None, ctx=None, dtype=None, block_shape=None):
+    """Creates a `BSRNDArray`, an 2D array with block compressed sparse row (BSR) format.
+
+    The BSRNDArray can be instantiated in several ways:
+
+    - bsr_matrix(D, block_shape=(R, C)):
+        to construct a BSRNDArray with a dense 2D array ``D`` split into blocks of R x C
+            -  **D** (*array_like*) - An object exposing the array interface, an object whose \
+            `__array__` method returns an array, or any (nested) sequence.
+            - **ctx** (*Context, optional*) - Device context \
+            (default is the current default context).
+            - **dtype** (*str or numpy.dtype, optional*) - The data type of the output array. \
+            The default dtype is ``D.dtype`` if ``D`` is an NDArray or numpy.ndarray, \
+            float32 otherwise.
+
+    - bsr_matrix(S):
+        to construct a BSRNDArray with a sparse 2D array ``S``
+            -  **S** (*scipy.sparse.bsr_matrix*) - A sparse matrix in BSR format.
+
+    - bsr_matrix((data, indices, indptr), shape=None):
+        to construct a BSRNDArray based on the definition of block compressed sparse row \
+        format, where the blocks of block row i are ``data[indptr[i]:indptr[i+1]]`` and \
+        their block column indices are ``indices[indptr[i]:indptr[i+1]]``.
+            - **data** (*array_like*) - An object of shape (number of blocks, R, C).
+            - **indices** (*array_like*) - An object exposing the array interface, which \
+            stores the block column index for each block in `data`.
+            - **indptr** (*array_like*) - An object exposing the array interface, which \
+            stores the offset into `data` of the first block of each block row.
+
+    Parameters
+    ----------
+    arg1: tuple of array_like, scipy.sparse.bsr_matrix or array_like
+        The argument to help instantiate the bsr matrix. See above for further details.
+    shape : tuple of int, optional
+        The shape of the bsr matrix.
+    ctx: Context, optional
+        Device context (default is the current default context).
+    dtype: str or numpy.dtype, optional
+        The data type of the output array.
+    block_shape: tuple of int, optional
+        The (rows, columns) shape of the blocks of a dense ``arg1``, (1, 1) by default.
+
+    Returns
+    -------
+    BSRNDArray
+        A `BSRNDArray` with the `bsr` storage representation.
+
+    Example
+    -------
+    >>> a = mx.nd.sparse.bsr_matrix(([[[1, 2], [3, 4]]], [1], [0, 1, 1]), shape=(4, 4))
+    >>> a.asnumpy()
+    array([[ 0.,  0.,  1.,  2.],
+           [ 0.,  0.,  3.,  4.],
+           [ 0.,  0.,  0.,  0.],
+           [ 0.,  0.,  0.,  0.]], dtype=float32)
+    """
+    # pylint: disable= no-member, protected-access
+    if isinstance(arg1, tuple) and len(arg1) == 3:
+        data, indices, indptr = arg1
+        return _bsr_matrix_from_definition(data, indices, indptr, shape=shape, ctx=ctx,
+                                           dtype=dtype)
+    if spsp and isinstance(arg1, spsp.bsr_matrix):
+        _check_shape(arg1.shape, shape)
+        return _bsr_matrix_from_definition(arg1.data, arg1.indices, arg1.indptr,
+                                           shape=arg1.shape, ctx=ctx, dtype=dtype)
+    if isinstance(arg1, BSRNDArray):
+        _check_shape(arg1.shape, shape)
+        return arg1.copyto(current_device() if ctx is None else ctx)
+    # construct a bsr matrix from a dense one
+    dtype = _prepare_default_dtype(arg1, dtype)
+    dns = _array(arg1, dtype=dtype)
+    if ctx is not None and dns.context != ctx:
+        dns = dns.as_in_context(ctx)
+    _check_shape(dns.shape, shape)
+    return dns.tostype('bsr', block_shape=(1, 1) if block_shape is None else block_shape)
+    # pylint: enable= no-member, protected-access
+
+def _bsr_matrix_from_definition(data, indices, indptr, shape=None, ctx=None, dtype=None):
+    """Create a `BSRNDArray` based on data, indices and indptr"""
+    # pylint: disable= no-member, protected-access
+    storage_type = 'bsr'
+    # context
+    ctx = current_device() if ctx is None else ctx
+    # types
+    dtype = _prepare_default_dtype(data, dtype)
+    indptr_type, indices_type = _STORAGE_AUX_TYPES[storage_type]
+    # prepare src array and types
+    data = _prepare_src_array(data, dtype)
+    indptr = _prepare_src_array(indptr, indptr_type)
+    indices = _prepare_src_array(indices, indices_type)
+    if not isinstance(data, NDArray):
+        data = _array(data, ctx, dtype)
+    if not isinstance(indptr, NDArray):
+        indptr = _array(indptr, ctx, indptr_type)
+    if not isinstance(indices, NDArray):
+        indices = _array(indices, ctx, indices_type)
+    if data.ndim != 3 or indptr.ndim != 1 or indices.ndim != 1 or indptr.shape[0] == 0:
+        raise ValueError('invalid shape')
+    if shape is None:
+        if indices.shape[0] == 0:
+            raise ValueError('invalid shape')
+        shape = ((len(indptr) - 1) * data.shape[1],
+                 (op.max(indices).asscalar() + 1) * data.shape[2])
+    if len(shape) != 2 or shape[0] != (len(indptr) - 1) * data.shape[1] or \
+        shape[1] % data.shape[2] != 0:
+        raise ValueError('invalid shape')
+    aux_shapes = [indptr.shape, indices.shape]
+    result = BSRNDArray(_new_alloc_handle(storage_type, shape, ctx, False, dtype,
+                                          [indptr_type, indices_type], aux_shapes))
+    check_call(_LIB.MXNDArraySyncCopyFromNDArray(result.handle, indptr.handle, ctypes.c_int(0)))
+    check_call(_LIB.MXNDArraySyncCopyFromNDArray(result.handle, indices.handle, ctypes.c_int(1)))
+    # the blocks set the block shape of the result
+    check_call(_LIB.MXNDArraySyncCopyFromNDArray(result.handle, data.handle, ctypes.c_int(-1)))
+    return result
+    # pylint: enable= no-member, protected-access
+
 def _ndarray_cls(handle, writable=True, stype=_STORAGE_TYPE_UNDEFINED):
     if stype == _STORAGE_TYPE_UNDEFINED:
         stype = _storage_type(handle)
@@ -1199,6 +1457,8 @@ def _ndarray_cls(handle, writable=True, stype=_STORAGE_TYPE_UNDEFINED):
         return CSRNDArray(handle, writable=writable)
     elif stype == _STORAGE_TYPE_ROW_SPARSE:
         return RowSparseNDArray(handle, writable=writable)
+    elif stype == _STORAGE_TYPE_BSR:
+        return BSRNDArray(handle, writable=writable)
     else:
         raise Exception(f"unknown storage type: {stype}")
 
@@ -1551,7 +1811,7 @@ def zeros(stype, shape, ctx=None, dtype=None, **kwargs):
     if ctx is None:
         ctx = current_device()
     dtype = mx_real_t if dtype is None else dtype
-    if stype in ('row_sparse', 'csr'):
+    if stype in ('row_sparse', 'csr', 'bsr'):
         aux_types = _STORAGE_AUX_TYPES[stype]
     else:
         raise ValueError("unknown storage type: " + stype)
@@ -1586,7 +1846,7 @@ def empty(stype, shape, ctx=None, dtype=None):
     if dtype is None:
         dtype = mx_real_t
     assert(stype is not None)
-    if stype in ('csr', 'row_sparse'):
+    if stype in ('csr', 'row_sparse', 'bsr'):
         return zeros(stype, shape, ctx=ctx, dtype=dtype)
     else:
         raise Exception("unknown stype : " + str(stype))
@@ -18,12 +18,21 @@
 # coding: utf-8
 """Utility functions for NDArray and BaseSparseNDArray."""
 import ctypes
+import json
+import os
+from collections.abc import Mapping
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
 
 from ..base import _LIB, check_call, py_str, c_str, string_types, mx_uint, NDArrayHandle
 from ..base import c_array, c_handle_array, c_str_array
+from ..device import cpu_pinned
 from .ndarray import NDArray
+from .ndarray import from_numpy as _from_numpy
 from .ndarray import array as _array
 from .ndarray import empty as _empty_ndarray
+from .ndarray import _new_from_cuda_ipc
 from .ndarray import zeros as _zeros_ndarray
 from .sparse import zeros as _zeros_sparse_ndarray
 from .sparse import empty as _empty_sparse_ndarray
@@ -34,7 +43,9 @@ try:
 except ImportError:
     spsp = None
 
-__all__ = ['zeros', 'empty', 'array', 'load', 'load_frombuffer', 'save']
+__all__ = ['zeros', 'empty', 'array', 'load', 'load_frombuffer', 'save', 'save_sharded',
+           'load_sharded', 'ShardedCheckpoint', 'deduplicate', 'export_cuda_ipc',
+           'import_cuda_ipc', 'release_cuda_ipc']
 
 
 def zeros(shape, ctx=None, dtype=None, stype=None, **kwargs):
@@ -146,7 +157,7 @@ def array(source_array, ctx=None, dtype=None):
         return _array(source_array, ctx=ctx, dtype=dtype)
 
 
-def load(fname):
+def load(fname, mmap=False):
     """Loads an array from file.
 
     See more details in ``save``.
@@ -155,6 +166,11 @@ def load(fname):
     ----------
     fname : str
         The filename.
+    mmap : bool, default False
+        Whether to map the dense arrays of a local file in the NDArray format on the CPU
+        instead of reading them. They are then paged in on first access and shared in the
+        page cache with the other processes mapping the file. The mapping is
+        copy-on-write, so writes to the arrays do not change the file.
 
     Returns
     -------
@@ -168,11 +184,12 @@ def load(fname):
     out_name_size = mx_uint()
     handles = ctypes.POINTER(NDArrayHandle)()
     names = ctypes.POINTER(ctypes.c_char_p)()
-    check_call(_LIB.MXNDArrayLoad(c_str(fname),
-                                  ctypes.byref(out_size),
-                                  ctypes.byref(handles),
-                                  ctypes.byref(out_name_size),
-                                  ctypes.byref(names)))
+    load_fn = _LIB.MXNDArrayLoadMapped if mmap else _LIB.MXNDArrayLoad
+    check_call(load_fn(c_str(fname),
+                       ctypes.byref(out_size),
+                       ctypes.byref(handles),
+                       ctypes.byref(out_name_size),
+                       ctypes.byref(names)))
     if out_name_size.value == 0:
         return [_ndarray_cls(NDArrayHandle(handles[i])) for i in range(out_size.value)]
     else:
@@ -182,6 +199,97 @@ def load(fname):
             for i in range(out_size.value))
 
 
+def deduplicate(data):
+    """Shares the memory of arrays with the arrays of the same content, shape, type and
+    context deduplicated before in the process, e.g. the weights of a backbone shared by the
+    models served from a GPU. The memory is freed with the last array sharing it.
+
+    The arrays returned are read only: a write to one of them is seen by all the models
+    sharing it.
+
+    Parameters
+    ----------
+    data : NDArray, list of NDArray or dict of str to NDArray
+        The arrays to deduplicate.
+
+    Returns
+    -------
+    NDArray, list of NDArray or dict of str to NDArray
+        The deduplicated arrays, in the structure of `data`.
+    """
+    def _dedup(arr):
+        handle = NDArrayHandle()
+        check_call(_LIB.MXNDArrayDeduplicate(arr.handle, ctypes.byref(handle), None))
+        out = _ndarray_cls(handle)
+        return out.as_np_ndarray() if type(arr) is not type(out) else out
+
+    if isinstance(data, NDArray):
+        return _dedup(data)
+    if isinstance(data, Mapping):
+        return {k: _dedup(v) for k, v in data.items()}
+    return [_dedup(v) for v in data]
+
+
+def export_cuda_ipc(data):
+    """Exports GPU arrays to the other processes through CUDA IPC, e.g. from a sidecar process
+    holding the parameters of the served models, so that restarted serving processes map them
+    with `import_cuda_ipc` instead of loading them again.
+
+    The arrays are copied to allocations of their own, kept by this process until
+    `release_cuda_ipc` is called. A process cannot import the arrays it exported.
+
+    Parameters
+    ----------
+    data : dict of str to NDArray
+        The arrays to export, on GPUs.
+
+    Returns
+    -------
+    dict of str to tuple
+        The picklable descriptions of the exported arrays, to give to `import_cuda_ipc`.
+    """
+    return {k: v._to_cuda_ipc() for k, v in data.items()}
+
+
+def import_cuda_ipc(exported, np_array=False):
+    """Maps GPU arrays exported by another process with `export_cuda_ipc`, without copying
+    them. The arrays are read only, and valid until the exporting process releases them.
+
+    The parameters of a block can keep the mapped arrays with
+    ``block.load_dict(arrays, device, share=True)``.
+
+    Parameters
+    ----------
+    exported : dict of str to tuple
+        The descriptions returned by `export_cuda_ipc`.
+    np_array : bool, default False
+        Whether to return `mxnet.numpy.ndarray` instead of `NDArray`.
+
+    Returns
+    -------
+    dict of str to NDArray
+        The mapped arrays.
+    """
+    arrays = {}
+    for k, (ipc_handle, shape, dtype, device_id) in exported.items():
+        arr = NDArray(_new_from_cuda_ipc(ipc_handle, shape, dtype, device_id))
+        arrays[k] = arr.as_np_ndarray() if np_array else arr
+    return arrays
+
+
+def release_cuda_ipc(exported):
+    """Frees the copies of the arrays exported by this process with `export_cuda_ipc`. The
+    processes which mapped them must not use them anymore.
+
+    Parameters
+    ----------
+    exported : dict of str to tuple
+        The descriptions returned by `export_cuda_ipc`.
+    """
+    for ipc_handle, _, _, _ in exported.values():
+        check_call(_LIB.MXNDArrayReleaseCudaIpcHandle(ctypes.c_char_p(ipc_handle)))
+
+
 def load_frombuffer(buf):
     """Loads an array dictionary or list from a buffer
 
@@ -269,3 +377,181 @@ def save(fname, data):
         raise ValueError("data needs to either be a NDArray, dict of str, NDArray pairs "
                          "or a list of NDarrays.")
     check_call(_LIB.MXNDArrayLegacySave(c_str(fname), mx_uint(len(handles)), handles, keys))
+
+
+_SHARDED_FORMAT = 'mxnet-sharded-v1'
+_SHARDED_ALIGNMENT = 4096
+
+
+def _shard_name(k, num_shards):
+    return 'shard-%05d-of-%05d.bin' % (k, num_shards)
+
+
+def save_sharded(dirname, data, num_shards=1, num_threads=8):
+    """Saves a list of arrays or a dict of str->array to a sharded checkpoint directory.
+
+    The tensors are spread over `num_shards` binary files, balancing their sizes, at
+    offsets aligned to 4096 bytes, and ``index.json`` records the name, dtype, shape,
+    shard and offset of each of them. `num_threads` threads copy the tensors to the
+    host, through pinned memory for device arrays, and write them in parallel. The
+    index is written last, so an interrupted save leaves no loadable checkpoint.
+
+    Parameters
+    ----------
+    dirname : str
+        The directory of the checkpoint, created if needed.
+    data : NDArray, or list of NDArray, or dict of str to NDArray
+        The dense arrays to save.
+    num_shards : int, default 1
+        Number of shard files.
+    num_threads : int, default 8
+        Number of threads copying and writing the tensors.
+
+    Examples
+    --------
+    >>> mx.nd.save_sharded('ckpt', {'x': mx.nd.zeros((2, 3)), 'y': mx.nd.ones((4,))},
+    ...                    num_shards=2)
+    >>> ckpt = mx.nd.load_sharded('ckpt')
+    >>> ckpt['y']
+    [1. 1. 1. 1.]
+    <NDArray 4 @cpu(0)>
+    """
+    if isinstance(data, NDArray):
+        data = [data]
+    if isinstance(data, dict):
+        if any(not isinstance(k, string_types) for k in data.keys()):
+            raise TypeError('save_sharded only accept dict str->NDArray or list of NDArray')
+        names, arrays = list(data.keys()), list(data.values())
+    elif isinstance(data, list):
+        names, arrays = [str(i) for i in range(len(data))], data
+    else:
+        raise ValueError("data needs to either be a NDArray, dict of str, NDArray pairs "
+                         "or a list of NDarrays.")
+    if any(not isinstance(v, NDArray) or v.stype != 'default' for v in arrays):
+        raise TypeError('save_sharded only accept dense NDArrays')
+    if num_shards < 1:
+        raise ValueError('num_shards must be positive, but got %d' % num_shards)
+
+    # largest tensors first, each to the least filled shard
+    nbytes = [v.size * np.dtype(v.dtype).itemsize for v in arrays]
+    sizes = [0] * num_shards
+    tensors = {}
+    for i in sorted(range(len(arrays)), key=lambda i: -nbytes[i]):
+        k = sizes.index(min(sizes))
+        tensors[names[i]] = {'shard': k, 'offset': sizes[k], 'nbytes': nbytes[i],
+                             'dtype': np.dtype(arrays[i].dtype).name,
+                             'shape': list(arrays[i].shape)}
+        sizes[k] += -(-nbytes[i] // _SHARDED_ALIGNMENT) * _SHARDED_ALIGNMENT
+
+    os.makedirs(dirname, exist_ok=True)
+    index_path = os.path.join(dirname, 'index.json')
+    if os.path.exists(index_path):
+        os.remove(index_path)
+    shards = [_shard_name(k, num_shards) for k in range(num_shards)]
+    for shard, size in zip(shards, sizes):
+        with open(os.path.join(dirname, shard), 'wb') as f:
+            f.truncate(size)
+
+    def write(i):
+        arr = arrays[i]
+        if nbytes[i] == 0:
+            return
+        if arr.device.device_type != 'cpu':
+            arr = arr.copyto(cpu_pinned(arr.device.device_id))
+        entry = tensors[names[i]]
+        with open(os.path.join(dirname, shards[entry['shard']]), 'r+b') as f:
+            f.seek(entry['offset'])
+            f.write(arr.asnumpy().reshape(-1).view(np.uint8))
+
+    with ThreadPoolExecutor(max_workers=max(1, num_threads)) as pool:
+        list(pool.map(write, range(len(arrays))))
+
+    index = {'format': _SHARDED_FORMAT, 'alignment': _SHARDED_ALIGNMENT,
+             'is_list': not isinstance(data, dict), 'shards': shards,
+             'names': names, 'tensors': tensors}
+    with open(index_path + '.tmp', 'w') as f:
+        json.dump(index, f)
+    os.replace(index_path + '.tmp', index_path)
+
+
+class ShardedCheckpoint(Mapping):
+    """Lazily loaded dict of str->NDArray of a checkpoint saved by `save_sharded`.
+
+    The shard files are memory-mapped copy-on-write, and looking a tensor up maps it in
+    place on the CPU without a copy, or copies it to `ctx` otherwise. Only the pages of the tensors
+    that are used are read from disk.
+
+    Parameters
+    ----------
+    dirname : str
+        The directory of the checkpoint.
+    ctx : Context, default None
+        The context of the loaded arrays. None maps them on the CPU.
+    """
+    def __init__(self, dirname, ctx=None):
+        with open(os.path.join(dirname, 'index.json')) as f:
+            index = json.load(f)
+        if index.get('format') != _SHARDED_FORMAT:
+            raise ValueError('%s is not a sharded checkpoint' % dirname)
+        self._dirname = dirname
+        self._ctx = ctx
+        self._index = index
+        self._maps = {}
+
+    @property
+    def is_list(self):
+        """Whether the checkpoint was saved from a list of arrays."""
+        return self._index['is_list']
+
+    def _map(self, k):
+        if k not in self._maps:
+            path = os.path.join(self._dirname, self._index['shards'][k])
+            # copy-on-write, so that in-place updates of the arrays leave the file intact
+            self._maps[k] = np.memmap(path, dtype=np.uint8, mode='c')
+        return self._maps[k]
+
+    def __getitem__(self, name):
+        entry = self._index['tensors'][name]
+        dtype = np.dtype(entry['dtype'])
+        if entry['nbytes'] == 0:
+            value = np.zeros(entry['shape'], dtype=dtype)
+        else:
+            offset = entry['offset']
+            value = self._map(entry['shard'])[offset:offset + entry['nbytes']]
+            value = value.view(dtype).reshape(entry['shape'])
+        if entry['nbytes'] and (self._ctx is None or (self._ctx.device_type == 'cpu' and
+                                                      self._ctx.device_id == 0)):
+            return _from_numpy(value, zero_copy=True)
+        return _array(value, ctx=self._ctx, dtype=dtype)
+
+    def __iter__(self):
+        return iter(self._index['names'])
+
+    def __len__(self):
+        return len(self._index['names'])
+
+
+def load_sharded(dirname, ctx=None, lazy=True):
+    """Loads a checkpoint saved by `save_sharded`.
+
+    Parameters
+    ----------
+    dirname : str
+        The directory of the checkpoint.
+    ctx : Context, default None
+        The context of the loaded arrays. None maps them on the CPU without a copy.
+    lazy : bool, default True
+        Whether to return a `ShardedCheckpoint` which loads each tensor when it is looked
+        up. Otherwise all tensors are loaded.
+
+    Returns
+    -------
+    ShardedCheckpoint, or list of NDArray, or dict of str to NDArray
+        Loaded data.
+    """
+    ckpt = ShardedCheckpoint(dirname, ctx)
+    if lazy:
+        return ckpt
+    if ckpt.is_list:
+        return [ckpt[name] for name in ckpt]
+    return {name: ckpt[name] for name in ckpt}
@@ -25,7 +25,7 @@ __all__ = ["foreach", "while_loop", "cond"]
 
 
 @set_module('mxnet.numpy_extension')
-def foreach(body, data, init_states):
+def foreach(body, data, init_states, compiled=False):
     """Run a for loop with user-defined computation over NDArrays on dimension 0.
 
     This operator simulates a for loop and body has the computation for an iteration
@@ -64,6 +64,10 @@ def foreach(body, data, init_states):
         The input data.
     init_states: an NDArray or nested lists of NDArrays.
         The initial values of the loop states.
+    compiled: bool, optional
+        For inference, run body on the same arrays in every iteration, so that it is planned
+        once and pushed as a whole instead of dispatching its operators in each iteration.
+        body must have static shapes. Training runs the loop as usual.
 
     Returns
     -------
@@ -79,12 +83,12 @@ def foreach(body, data, init_states):
     >>> states = [mx.np.random.uniform(size=(10))]
     >>> outs, states = npx.control_flow.foreach(step, data, states)
     """
-    return _mx_nd_npx.foreach(body, data, init_states)
+    return _mx_nd_npx.foreach(body, data, init_states, compiled=compiled)
 
 
 #pylint: disable=W0621
 @set_module('mxnet.numpy_extension')
-def while_loop(cond, func, loop_vars, max_iterations=None):
+def while_loop(cond, func, loop_vars, max_iterations=None, compiled=False):
     """Run a while loop with user-defined computation and loop condition.
 
     This operator simulates a while loop which iterately does customized computation
@@ -138,6 +142,12 @@ def while_loop(cond, func, loop_vars, max_iterations=None):
         The initial values of the loop variables.
     max_iterations: a python int.
         Maximum number of iterations.
+    compiled: bool, optional
+        For inference, run `cond` and `func` on the same arrays in every step, so that they
+        are planned once and pushed as a whole, and push `func` before waiting for `cond`
+        so that the device runs it while the host reads `cond`. `func` must have static
+        shapes and be safe to run once more on the `loop_vars` ending the loop.
+        Training runs the loop as usual.
 
     Returns
     ------
@@ -166,7 +176,8 @@ def while_loop(cond, func, loop_vars, max_iterations=None):
     >>> states
     [array([6], dtype=int64), array([16], dtype=int64)]
     """
-    return _mx_nd_npx.while_loop(cond, func, loop_vars, max_iterations=max_iterations)
+    return _mx_nd_npx.while_loop(cond, func, loop_vars, max_iterations=max_iterations,
+                                 compiled=compiled)
 
 
 @set_module('mxnet.numpy_extension')
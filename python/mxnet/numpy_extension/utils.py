@@ -20,6 +20,7 @@
 
 
 import ctypes
+import contextlib
 from ..util import is_np_array, is_np_shape
 from ..base import _LIB, check_call, string_types, c_str_array
 from ..base import c_handle_array, c_str, mx_uint, NDArrayHandle, py_str
@@ -28,8 +29,8 @@ from ..dlpack import ndarray_from_dlpack, ndarray_from_numpy
 from ..numpy import ndarray, array
 from ..ndarray import NDArray
 
-__all__ = ['save', 'savez', 'load', 'to_dlpack_for_read', 'to_dlpack_for_write',
-           'from_dlpack', 'from_numpy']
+__all__ = ['save', 'savez', 'savez_compressed', 'load', 'to_dlpack_for_read',
+           'to_dlpack_for_write', 'from_dlpack', 'from_numpy', 'is_lazy', 'set_lazy', 'lazy']
 
 def save(file, arr):
     """Save an array to a binary file in NumPy ``.npy`` format.
@@ -121,7 +122,50 @@ def savez(file, *args, **kwds):
     check_call(_LIB.MXNDArraySave(c_str(file), mx_uint(len(handles)), handles, keys))
 
 
-def load(file):
+def savez_compressed(file, *args, **kwds):
+    """Save several arrays into a single file in compressed ``.npz`` format.
+
+    The arguments are named as in `savez`. The members of the archive are deflated by
+    chunks in parallel.
+
+    Parameters
+    ----------
+    file : str
+        The filename where the data will be saved.
+    args : Arguments, optional
+        Arrays to save to the file, with the names "arr_0", "arr_1", and so on.
+    kwds : Keyword arguments, optional
+        Arrays to save to the file, with the keyword names. ``level``, the deflate level
+        from 1 to 10, defaults to 6 and can not name an array.
+
+    Returns
+    -------
+    None
+
+    See Also
+    --------
+    savez : Save several arrays into a single file in uncompressed ``.npz`` format.
+    """
+    level = kwds.pop('level', 6)
+    if len(args):
+        for i, arg in enumerate(args):
+            name = 'arr_{}'.format(str(i))
+            assert name not in kwds, 'Naming conflict between arg {} and kwargs.'.format(str(i))
+            kwds[name] = arg
+
+    str_keys = kwds.keys()
+    nd_vals = kwds.values()
+    if any(not isinstance(k, string_types) for k in str_keys) or \
+            any(not isinstance(v, NDArray) for v in nd_vals):
+        raise TypeError('Only accepts dict str->ndarray or list of ndarrays')
+
+    keys = c_str_array(str_keys)
+    handles = c_handle_array(nd_vals)
+    check_call(_LIB.MXNDArraySaveCompressed(c_str(file), mx_uint(len(handles)), handles, keys,
+                                            ctypes.c_int(level)))
+
+
+def load(file, mmap=False):
     """Load arrays from ``.npy``, ``.npz`` or legacy MXNet file format.
 
     See more details in ``save``.
@@ -130,6 +174,11 @@ def load(file):
     ----------
     file : str
         The filename.
+    mmap : bool, default False
+        Whether to map the dense arrays of a local file on the CPU instead of reading
+        them, see ``mxnet.ndarray.load``. The arrays of ``.npy`` files and of the
+        uncompressed members of ``.npz`` files are mapped when they are in C order, the
+        others are read.
 
     Returns
     -------
@@ -151,11 +200,12 @@ def load(file):
     out_name_size = mx_uint()
     handles = ctypes.POINTER(NDArrayHandle)()
     names = ctypes.POINTER(ctypes.c_char_p)()
-    check_call(_LIB.MXNDArrayLoad(c_str(file),
-                                  ctypes.byref(out_size),
-                                  ctypes.byref(handles),
-                                  ctypes.byref(out_name_size),
-                                  ctypes.byref(names)))
+    load_fn = _LIB.MXNDArrayLoadMapped if mmap else _LIB.MXNDArrayLoad
+    check_call(load_fn(c_str(file),
+                       ctypes.byref(out_size),
+                       ctypes.byref(handles),
+                       ctypes.byref(out_name_size),
+                       ctypes.byref(names)))
     if out_name_size.value == 0:
         if out_size.value != 1:
             return [ndarray(NDArrayHandle(handles[i])) for i in range(out_size.value)]
@@ -282,3 +332,60 @@ as DLManagedTensor until all previous read/write operations on the current array
            [2., 2., 2.]])
     """
 to_dlpack_for_write.__doc__ = to_dlpack_for_write_doc
+
+
+def is_lazy():
+    """Get status of lazy evaluation mode."""
+    curr = ctypes.c_int()
+    check_call(_LIB.MXNDArrayIsLazyEvaluation(ctypes.byref(curr)))
+    return bool(curr.value)
+
+
+def set_lazy(state):
+    """Enable / Disable lazy evaluation of the elementwise operators.
+
+    Disabling the mode computes the operators still pending.
+
+    Parameters
+    ----------
+    state: bool
+
+    Returns
+    -------
+    Previous lazy evaluation state.
+    """
+    prev = ctypes.c_int()
+    check_call(_LIB.MXNDArraySetIsLazyEvaluation(ctypes.c_int(state), ctypes.byref(prev)))
+    return bool(prev.value)
+
+
+@contextlib.contextmanager
+def lazy(state=True):
+    """Evaluate the elementwise operators lazily within the scope.
+
+    The elementwise operators invoked within the scope are recorded instead of run. When an
+    array is read, the pending operators it depends on run as a single graph, so that the
+    pointwise operators are fused and the intermediate arrays which are no longer referenced are
+    never allocated. The pointwise fusion on the CPU needs ``MXNET_USE_FUSION_CPU=1``. Writing
+    to an existing array, recording with autograd and leaving the scope compute the operators
+    still pending.
+
+    Parameters
+    ----------
+    state: bool, default True
+        Whether to evaluate lazily within the scope.
+
+    Examples
+    --------
+    >>> a, b, c = mx.np.ones((2, 3)), mx.np.ones((2, 3)), mx.np.ones((2, 3))
+    >>> with mx.npx.lazy():
+    ...     d = mx.np.exp(a * b + c)
+    ...     print(d)
+    [[7.389056 7.389056 7.389056]
+     [7.389056 7.389056 7.389056]]
+    """
+    prev = set_lazy(state)
+    try:
+        yield
+    finally:
+        set_lazy(prev)
@@ -2945,6 +2945,9 @@ def convert_matmul_selfatt_qk(node, **kwargs):
     name, input_nodes, attrs = get_inputs(node, kwargs)
 
     heads = int(attrs.get('heads'))
+    if int(attrs.get('kv_heads', 0)) not in (0, heads):
+        raise NotImplementedError('interleaved_matmul_selfatt_qk currently does not support '
+                                  'kv_heads different from heads')
 
     # a, b, c, d, e are seq_len, batch_size, num_heads, 3, head_dim respectively
     create_tensor([0], name+"_0", kwargs["initializer"])
@@ -3011,6 +3014,9 @@ def convert_contrib_interleaved_matmul_selfatt_valatt(node, **kwargs):
     qkv = input_nodes[0]
     att = input_nodes[1]
     num_heads = int(attrs.get('heads'))
+    if int(attrs.get('kv_heads', 0)) not in (0, num_heads):
+        raise NotImplementedError('interleaved_matmul_selfatt_valatt currently does not support '
+                                  'kv_heads different from heads')
 
     create_tensor([num_heads], name+"_const_num_heads", kwargs["initializer"])
     create_tensor([0], name+"_const_0", kwargs["initializer"])
@@ -492,9 +492,16 @@ class CustomOpProp(object):
     need_top_grad : bool
         The default declare_backward_dependency function. Use this value
         to determine whether this operator needs gradient input.
+    run_on_engine : bool
+        Whether forward and backward run directly on the engine thread executing the
+        operator, instead of being handed to a custom operator worker thread. This saves
+        a thread switch per call, but is only safe for operators which only call
+        asynchronous NDArray operations and never wait for an NDArray, e.g. with
+        ``asnumpy`` or ``wait_to_read``, since waiting blocks an engine thread.
     """
-    def __init__(self, need_top_grad=True):
+    def __init__(self, need_top_grad=True, run_on_engine=False):
         self.need_top_grad_ = need_top_grad
+        self.run_on_engine_ = run_on_engine
 
     def infer_shape(self, in_shape):
         """infer_shape interface. Can override when creating new operators.
@@ -727,6 +734,7 @@ def register(reg_name):
         createop_functype = CFUNCTYPE(c_int, c_char_p, c_int, POINTER(POINTER(mx_uint)),
                                       POINTER(c_int), POINTER(c_int),
                                       POINTER(MXCallbackList), c_void_p)
+        run_on_engine_functype = CFUNCTYPE(c_int, POINTER(c_int), c_void_p)
         req_enum = ('null', 'write', 'inplace', 'add')
         create_ndarray_fn = _np_ndarray_cls if is_np_array() else _ndarray_cls
 
@@ -783,6 +791,15 @@ def register(reg_name):
                     return False
                 return True
 
+            def run_on_engine_entry(run_on_engine, _):
+                """C Callback for CustomOpProp::RunOnEngine"""
+                try:
+                    run_on_engine[0] = int(getattr(op_prop, 'run_on_engine_', False))
+                except Exception:
+                    print(f'Error in {reg_name}.run_on_engine: {traceback.format_exc()}')
+                    return False
+                return True
+
             def infer_storage_type_backward_entry(num_tensor, tensor_stypes, tags, _):
                 # pylint: disable=C0301
                 """C Callback for CustomOpProp::InferStorageTypeBackward"""
@@ -1100,7 +1117,8 @@ def register(reg_name):
                          createop_functype(create_operator_entry),
                          infertype_functype(infer_type_entry),
                          inferstorage_functype(infer_storage_type_entry),
-                         inferstorage_backward_functype(infer_storage_type_backward_entry)]
+                         inferstorage_backward_functype(infer_storage_type_backward_entry),
+                         run_on_engine_functype(run_on_engine_entry)]
             callbacks = [cast(i, CFUNCTYPE(c_int)) for i in callbacks]
             contexts = [None]*len(callbacks)
             ret[0] = MXCallbackList(c_int(len(callbacks)),
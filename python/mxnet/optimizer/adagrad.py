@@ -19,6 +19,7 @@
 from __future__ import absolute_import
 from ..ndarray import (zeros, clip, sqrt, square)
 from ..ndarray import sparse
+from ..ndarray.contrib import flat_adagrad_update
 from .optimizer import Optimizer, register
 
 __all__ = ['AdaGrad']
@@ -142,3 +143,32 @@ class AdaGrad(Optimizer):
             else:
                 # When the grad is not sparse, the func step is called to update weight and state
                 self.step([index], [weight], [grad], [state])
+
+    def flat_step(self, indices, weight, grad, state, offsets):
+        """Perform an optimization step of a group of parameters stored in flat buffers.
+        A single fused kernel updates the whole group.
+
+        Parameters
+        ----------
+        indices : list of int
+            List of unique indices of the parameters into the individual learning rates
+            and weight decays. Learning rates and weight decay may be set via `set_lr_mult()`
+            and `set_wd_mult()`, respectively.
+        weight : NDArray
+            Flat buffer of the parameters.
+        grad : NDArray
+            Flat buffer of the gradients.
+        state : any obj
+            State returned by `create_state()` for the flat buffer of the parameters.
+        offsets : NDArray
+            Offsets of the parameters in the buffers, int64 of size ``len(indices) + 1``.
+        """
+        self._update_count(indices)
+        lrs, wds = self._flat_per_tensor(weight, self._get_lrs(indices), self._get_wds(indices))
+
+        kwargs = {'epsilon': self.epsilon, 'rescale_grad': self.rescale_grad}
+        if self.clip_gradient:
+            kwargs['clip_gradient'] = self.clip_gradient
+
+        history = state
+        flat_adagrad_update(weight, grad, history, lrs, wds, offsets, out=weight, **kwargs)
@@ -20,6 +20,7 @@ from __future__ import absolute_import
 import math
 from ..ndarray import (zeros, clip, sqrt, square)
 from ..ndarray import adam_update
+from ..ndarray.contrib import flat_adam_update
 from .optimizer import Optimizer, register
 
 __all__ = ['Adam']
@@ -184,3 +185,39 @@ class Adam(Optimizer):
             # update weight with fused kernel
             adam_update(weight, grad, mean, var, out=weight,
                         lazy_update=self.lazy_update, lr=lr, wd=wd, **kwargs)
+
+    def flat_step(self, indices, weight, grad, state, offsets):
+        """Perform an optimization step of a group of parameters stored in flat buffers.
+        A single fused kernel updates the whole group.
+
+        Parameters
+        ----------
+        indices : list of int
+            List of unique indices of the parameters into the individual learning rates
+            and weight decays. Learning rates and weight decay may be set via `set_lr_mult()`
+            and `set_wd_mult()`, respectively.
+        weight : NDArray
+            Flat buffer of the parameters.
+        grad : NDArray
+            Flat buffer of the gradients.
+        state : any obj
+            State returned by `create_state()` for the flat buffer of the parameters.
+        offsets : NDArray
+            Offsets of the parameters in the buffers, int64 of size ``len(indices) + 1``.
+        """
+        self._update_count(indices)
+        lrs = self._get_lrs(indices)
+        for i, index in enumerate(indices):
+            t = self._index_update_count[index]
+            coef1 = 1. - self.beta1**t
+            coef2 = 1. - self.beta2**t
+            lrs[i] *= math.sqrt(coef2)/coef1
+        lrs, wds = self._flat_per_tensor(weight, lrs, self._get_wds(indices))
+
+        kwargs = {'beta1': self.beta1, 'beta2': self.beta2, 'epsilon': self.epsilon,
+                  'rescale_grad': self.rescale_grad}
+        if self.clip_gradient:
+            kwargs['clip_gradient'] = self.clip_gradient
+
+        mean, var = state
+        flat_adam_update(weight, grad, mean, var, lrs, wds, offsets, out=weight, **kwargs)
@@ -19,6 +19,7 @@
 from __future__ import absolute_import
 from ..ndarray import (zeros, clip, sqrt, square)
 from ..ndarray import ftml_update
+from ..ndarray.contrib import flat_ftml_update
 from .optimizer import Optimizer, register
 
 __all__ = ['FTML']
@@ -156,3 +157,35 @@ class FTML(Optimizer):
 
             # update weight with fused kernel
             ftml_update(weight, grad, d, v, z, out=weight, lr=lr, wd=wd, **kwargs)
+
+    def flat_step(self, indices, weight, grad, state, offsets):
+        """Perform an optimization step of a group of parameters stored in flat buffers.
+        A single fused kernel updates the whole group.
+
+        Parameters
+        ----------
+        indices : list of int
+            List of unique indices of the parameters into the individual learning rates
+            and weight decays. Learning rates and weight decay may be set via `set_lr_mult()`
+            and `set_wd_mult()`, respectively.
+        weight : NDArray
+            Flat buffer of the parameters.
+        grad : NDArray
+            Flat buffer of the gradients.
+        state : any obj
+            State returned by `create_state()` for the flat buffer of the parameters.
+        offsets : NDArray
+            Offsets of the parameters in the buffers, int64 of size ``len(indices) + 1``.
+        """
+        self._update_count(indices)
+        ts = [self._index_update_count[index] for index in indices]
+        lrs, wds, ts = self._flat_per_tensor(weight, self._get_lrs(indices),
+                                             self._get_wds(indices), ts)
+
+        kwargs = {'beta1': self.beta1, 'beta2': self.beta2, 'epsilon': self.epsilon,
+                  'rescale_grad': self.rescale_grad}
+        if self.clip_gradient:
+            kwargs['clip_gradient'] = self.clip_gradient
+
+        d, v, z = state
+        flat_ftml_update(weight, grad, d, v, z, lrs, wds, ts, offsets, out=weight, **kwargs)
@@ -20,6 +20,7 @@ from __future__ import absolute_import
 import numpy
 from ..ndarray import (zeros, clip)
 from ..ndarray import (sgd_update, mp_sgd_update, nag_mom_update, mp_nag_mom_update)
+from ..ndarray.contrib import (flat_sgd_update, flat_nag_mom_update)
 from .optimizer import Optimizer, register
 
 __all__ = ['NAG']
@@ -153,6 +154,38 @@ class NAG(Optimizer):
                     mp_sgd_update(weight, grad, weight32, out=weight,
                                   lr=lr, wd=wd, **kwargs)
 
+    def flat_step(self, indices, weight, grad, state, offsets):
+        """Perform an optimization step of a group of parameters stored in flat buffers.
+        A single fused kernel updates the whole group.
+
+        Parameters
+        ----------
+        indices : list of int
+            List of unique indices of the parameters into the individual learning rates
+            and weight decays. Learning rates and weight decay may be set via `set_lr_mult()`
+            and `set_wd_mult()`, respectively.
+        weight : NDArray
+            Flat buffer of the parameters.
+        grad : NDArray
+            Flat buffer of the gradients.
+        state : any obj
+            State returned by `create_state()` for the flat buffer of the parameters.
+        offsets : NDArray
+            Offsets of the parameters in the buffers, int64 of size ``len(indices) + 1``.
+        """
+        self._update_count(indices)
+        lrs, wds = self._flat_per_tensor(weight, self._get_lrs(indices), self._get_wds(indices))
+
+        kwargs = {'rescale_grad': self.rescale_grad}
+        if self.clip_gradient:
+            kwargs['clip_gradient'] = self.clip_gradient
+
+        if state is not None:
+            flat_nag_mom_update(weight, grad, state, lrs, wds, offsets, out=weight,
+                                momentum=self.momentum, **kwargs)
+        else:
+            flat_sgd_update(weight, grad, lrs, wds, offsets, out=weight, **kwargs)
+
     def update_multi_precision(self, indices, weights, grads, states):
         """Override update_multi_precision.
         """
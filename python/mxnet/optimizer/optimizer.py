@@ -20,7 +20,7 @@
 """Base Optimizer class."""
 import warnings
 import numpy
-from ..ndarray import (NDArray, zeros, cast)
+from ..ndarray import (NDArray, array, zeros, cast)
 from ..util import is_np_array
 
 __all__ = ['Optimizer', 'Test', 'create', 'register']
@@ -82,6 +82,12 @@ class Optimizer(object):
         When use_fused_step=False, step is called,
         otherwise, fused_step is called.
 
+    flat_update : bool, optional, default False
+        Whether the Trainer stores the dense parameters, gradients and states of each
+        device and dtype in flat buffers, updated by a single `flat_step` per group
+        instead of one kernel per parameter. Only optimizers implementing `flat_step`
+        support it.
+
     Properties
     ----------
     learning_rate : float
@@ -92,7 +98,7 @@ class Optimizer(object):
                  clip_gradient=None, learning_rate=None,
                  lr_scheduler=None, sym=None, begin_num_update=0,
                  multi_precision=False, param_dict=None, aggregate_num=None,
-                 use_fused_step=None, **kwargs):
+                 use_fused_step=None, flat_update=False, **kwargs):
         super(Optimizer, self).__init__(**kwargs)
         self.rescale_grad = rescale_grad
         self.lr_scheduler = lr_scheduler
@@ -130,6 +136,7 @@ class Optimizer(object):
         self.allow_np_array = is_np_array()
         self.use_fused_step = use_fused_step \
             if use_fused_step is not None else False
+        self.flat_update = flat_update
 
         self.set_lr_mult({})
         self.set_wd_mult({})
@@ -252,6 +259,10 @@ class Optimizer(object):
                           "optimizer")
         return self.create_state(index, weight)
 
+    def _fuses_grad_dtype(self, weight, grad):
+        """Whether `fused_step` updates `weight` from `grad` of another dtype by itself."""
+        return False
+
     def step(self, indices, weights, grads, states):
         """Perform an optimization step using gradients and states.
 
@@ -289,6 +300,34 @@ class Optimizer(object):
         """
         raise NotImplementedError
 
+    def flat_step(self, indices, weight, grad, state, offsets):
+        """Perform an optimization step of a group of parameters stored in flat buffers,
+        with a single kernel for the whole group.
+
+        Parameters
+        ----------
+        indices : list of int
+            List of unique indices of the parameters into the individual learning rates
+            and weight decays. Learning rates and weight decay may be set via `set_lr_mult()`
+            and `set_wd_mult()`, respectively.
+        weight : NDArray
+            Flat buffer of the parameters, the parameter `indices[j]` holding the elements
+            ``[offsets[j], offsets[j + 1])``.
+        grad : NDArray
+            Flat buffer of the gradients.
+        state : any obj
+            State returned by `create_state()` for the flat buffer of the parameters.
+        offsets : NDArray
+            Offsets of the parameters in the buffers, int64 of size ``len(indices) + 1``.
+        """
+        raise NotImplementedError
+
+    @staticmethod
+    def _flat_per_tensor(weight, *values):
+        """Lists of per-parameter values of `flat_step`, as float32 arrays on the device
+        of the flat weight."""
+        return [array(v, ctx=weight.context, dtype=numpy.float32) for v in values]
+
     def update(self, indices, weights, grads, states):
         """Call step to perform a single optimization update if use_fused_step is False,
          otherwise fused_step is called.
@@ -338,10 +377,14 @@ class Optimizer(object):
             if self.multi_precision and weight.dtype == numpy.float16:
                 weights_master_copy.append(state[0])
                 original_states.append(state[1])
-                grads32.append(grad.astype(numpy.float32))
+                # float32 gradient buffers are used as they are
+                grads32.append(grad if grad.dtype == numpy.float32
+                               else grad.astype(numpy.float32))
             else:
                 weights_master_copy.append(weight)
                 original_states.append(state)
+                if grad.dtype != weight.dtype and not self._fuses_grad_dtype(weight, grad):
+                    grad = grad.astype(weight.dtype)
                 grads32.append(grad)
         self.update(indices, weights_master_copy, grads32, original_states)
         for weight_master_copy, weight in zip(weights_master_copy, weights):
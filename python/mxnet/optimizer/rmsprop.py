@@ -18,6 +18,7 @@
 from __future__ import absolute_import
 from ..ndarray import (zeros, clip, sqrt, square)
 from ..ndarray import (rmsprop_update, rmspropalex_update)
+from ..ndarray.contrib import (flat_rmsprop_update, flat_rmspropalex_update)
 from .optimizer import Optimizer, register
 
 __all__ = ['RMSProp']
@@ -185,3 +186,42 @@ class RMSProp(Optimizer):
                 mean, var, mom = state
                 rmspropalex_update(weight, grad, mean, var, mom, out=weight,
                                    lr=lr, wd=wd, **kwargs)
+
+    def flat_step(self, indices, weight, grad, state, offsets):
+        """Perform an optimization step of a group of parameters stored in flat buffers.
+        A single fused kernel updates the whole group.
+
+        Parameters
+        ----------
+        indices : list of int
+            List of unique indices of the parameters into the individual learning rates
+            and weight decays. Learning rates and weight decay may be set via `set_lr_mult()`
+            and `set_wd_mult()`, respectively.
+        weight : NDArray
+            Flat buffer of the parameters.
+        grad : NDArray
+            Flat buffer of the gradients.
+        state : any obj
+            State returned by `create_state()` for the flat buffer of the parameters.
+        offsets : NDArray
+            Offsets of the parameters in the buffers, int64 of size ``len(indices) + 1``.
+        """
+        self._update_count(indices)
+        lrs, wds = self._flat_per_tensor(weight, self._get_lrs(indices), self._get_wds(indices))
+
+        kwargs = {'rho': self.rho, 'epsilon': self.epsilon,
+                  'rescale_grad': self.rescale_grad}
+        if self.centered:
+            kwargs['momentum'] = self.momentum
+        if self.clip_gradient:
+            kwargs['clip_gradient'] = self.clip_gradient
+        if self.clip_weights:
+            kwargs['clip_weights'] = self.clip_weights
+
+        if not self.centered:
+            var = state
+            flat_rmsprop_update(weight, grad, var, lrs, wds, offsets, out=weight, **kwargs)
+        else:
+            mean, var, mom = state
+            flat_rmspropalex_update(weight, grad, mean, var, mom, lrs, wds, offsets,
+                                    out=weight, **kwargs)
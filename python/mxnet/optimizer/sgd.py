@@ -23,8 +23,10 @@ from ..ndarray import (sgd_update, sgd_mom_update,
                        mp_sgd_update, mp_sgd_mom_update,
                        multi_sgd_update, multi_sgd_mom_update,
                        multi_mp_sgd_update, multi_mp_sgd_mom_update)
+from ..ndarray.contrib import (flat_sgd_update, flat_sgd_mom_update, multi_bf16_sgd_update)
 from .optimizer import Optimizer, register
-from .utils import _flatten_list
+from .utils import (_flatten_list, _is_bf16_fused, _split_bf16_fused, _bf16_fused_state,
+                    _bf16_fused_inputs)
 
 __all__ = ['SGD']
 
@@ -84,6 +86,12 @@ class SGD(Optimizer):
         True: makes internal 32-bit copy of the weights and applies gradients
         in 32-bit precision even if actual weights used in the model have lower precision.
         Turning this on can improve convergence and accuracy when training with float16.
+        The bfloat16 weights on CPU are updated by vectorized kernels from their float32
+        master copies, with float32 momentum.
+    stochastic_rounding : bool, default False
+        If True, the bfloat16 weights on CPU are updated without master copies by vectorized
+        kernels, which stochastically round the float32 update to bfloat16. This halves the
+        memory of the optimizer state with respect to `multi_precision`.
     aggregate_num : int, default 1
         Number of weights to be aggregated in a list.
         They are passed to the optimizer for a single optimization step.
@@ -93,7 +101,8 @@ class SGD(Optimizer):
         otherwise, fused_step is called.
     """
     def __init__(self, learning_rate=0.1, momentum=0.0, lazy_update=False,
-                 multi_precision=False, use_fused_step=True, aggregate_num=1, **kwargs):
+                 multi_precision=False, use_fused_step=True, aggregate_num=1,
+                 stochastic_rounding=False, **kwargs):
         super(SGD, self).__init__(learning_rate=learning_rate,
                                   multi_precision=multi_precision,
                                   aggregate_num=aggregate_num,
@@ -107,6 +116,15 @@ class SGD(Optimizer):
                 'When lazy_update is set to True, multi_precision has be turned off.'
         self.momentum = momentum
         self.lazy_update = lazy_update
+        self.stochastic_rounding = stochastic_rounding
+
+    def create_state_multi_precision(self, index, weight):
+        if _is_bf16_fused(self, weight):
+            return _bf16_fused_state(self, weight, 1 if self.momentum != 0.0 else 0)
+        return super(SGD, self).create_state_multi_precision(index, weight)
+
+    def _fuses_grad_dtype(self, weight, grad):
+        return _is_bf16_fused(self, weight) and grad.dtype == numpy.float32
 
     def create_state(self, index, weight):
         momentum = None
@@ -170,6 +188,8 @@ class SGD(Optimizer):
         states : List of any obj
             List of state returned by `create_state()`.
         """
+        if _split_bf16_fused(self, indices, weights, grads, states):
+            return
         # When either weight or gradient is sparse, aggregate is False.
         aggregate = self.aggregate_num > 1
         for weight, grad in zip(weights, grads):
@@ -186,7 +206,11 @@ class SGD(Optimizer):
         if self.clip_gradient:
             kwargs['clip_gradient'] = self.clip_gradient
 
-        if aggregate:
+        if _is_bf16_fused(self, weights[0]):
+            multi_bf16_sgd_update(*_bf16_fused_inputs(weights, grads, states), out=weights,
+                                  num_weights=len(weights), lrs=lrs, wds=wds,
+                                  stochastic_rounding=self.stochastic_rounding, **kwargs)
+        elif aggregate:
             # update `aggregate_num` number of weights in a single kernel.
             # this does not support sparse weight or gradient.
             multi_precision = self.multi_precision and weights[0].dtype == numpy.float16
@@ -233,6 +257,38 @@ class SGD(Optimizer):
                         mp_sgd_update(weight, grad, weight32, out=weight,
                                       lr=lr, wd=wd, **kwargs)
 
+    def flat_step(self, indices, weight, grad, state, offsets):
+        """Perform an optimization step of a group of parameters stored in flat buffers.
+        A single fused kernel updates the whole group.
+
+        Parameters
+        ----------
+        indices : list of int
+            List of unique indices of the parameters into the individual learning rates
+            and weight decays. Learning rates and weight decay may be set via `set_lr_mult()`
+            and `set_wd_mult()`, respectively.
+        weight : NDArray
+            Flat buffer of the parameters.
+        grad : NDArray
+            Flat buffer of the gradients.
+        state : any obj
+            State returned by `create_state()` for the flat buffer of the parameters.
+        offsets : NDArray
+            Offsets of the parameters in the buffers, int64 of size ``len(indices) + 1``.
+        """
+        self._update_count(indices)
+        lrs, wds = self._flat_per_tensor(weight, self._get_lrs(indices), self._get_wds(indices))
+
+        kwargs = {'rescale_grad': self.rescale_grad}
+        if self.clip_gradient:
+            kwargs['clip_gradient'] = self.clip_gradient
+
+        if state is not None:
+            flat_sgd_mom_update(weight, grad, state, lrs, wds, offsets, out=weight,
+                                momentum=self.momentum, **kwargs)
+        else:
+            flat_sgd_update(weight, grad, lrs, wds, offsets, out=weight, **kwargs)
+
     def update_multi_precision(self, indices, weights, grads, states):
         """Override update_multi_precision.
         """
@@ -20,10 +20,11 @@ from __future__ import absolute_import
 import pickle
 import numpy
 from ..base import py_str
-from ..ndarray import NDArray
+from ..ndarray import NDArray, concat
 from ..profiler import scope as profiler_scope
 from ..util import is_np_array
 from .utils import _as_classic
+from .optimizer import Optimizer
 
 __all__ = ['Updater', 'get_updater']
 
@@ -35,6 +36,7 @@ class Updater(object):
         self.states = {}
         self.states_synced = {}
         self.aggregate_updates = optimizer.aggregate_num > 1
+        self.flat_states = {}
 
     def __call__(self, index, grad, weight):
         """Updates weight given gradient and index."""
@@ -62,6 +64,18 @@ class Updater(object):
                 self.states[idx] = \
                     self.sync_state_context(self.states[idx], weights[i].context)
                 self.states_synced[idx] = True
+        # gradients kept in a wider dtype than their weights go through the generic mixed
+        # precision update, as most fused multi-precision kernels take them in the weight dtype
+        wide = [k for k, (w, g) in enumerate(zip(weights, grads))
+                if w.dtype != g.dtype and not self.optimizer._fuses_grad_dtype(w, g)]
+        if wide:
+            Optimizer.update_multi_precision(
+                self.optimizer, [indices[k] for k in wide], [weights[k] for k in wide],
+                [grads[k] for k in wide], [self.states[indices[k]] for k in wide])
+            rest = sorted(set(range(len(indices))) - set(wide))
+            indices = [indices[k] for k in rest]
+            weights = [weights[k] for k in rest]
+            grads = [grads[k] for k in rest]
         if self.aggregate_updates:
             # segregate values based on type
             if self.optimizer.aggregate_num is not numpy.inf:
@@ -92,6 +106,49 @@ class Updater(object):
             for i, w, g in zip(indices, weights, grads):
                 self.optimizer.update_multi_precision([i], [w], [g], [self.states[i]])
 
+    def update_flat(self, indices, grad, weight, offsets, weights):
+        """Updates a group of weights stored in one flat buffer with a single `flat_step`.
+
+        Parameters
+        ----------
+        indices : list of int
+            Indices of the weights of the group.
+        grad : NDArray
+            Flat buffer of the gradients.
+        weight : NDArray
+            Flat buffer of the weights.
+        offsets : NDArray
+            int64 offsets of the weights in the buffers, of size ``len(indices) + 1``.
+        weights : list of NDArray
+            The weights, views into the flat buffer.
+
+        The state of the group is a flat buffer too, and `self.states` keeps a view into it
+        for each weight, so that the states are saved and loaded as those of the weights.
+        The flat state is rebuilt from `self.states` whenever they are not these views, for
+        instance after `set_states`.
+        """
+        allow_np = self.optimizer.allow_np_array if hasattr(self.optimizer, "allow_np_array") else is_np_array()
+        grad = _as_classic(grad, allow_np)
+        weight = _as_classic(weight, allow_np)
+        weights = _as_classic(weights, allow_np)
+        self.optimizer._set_current_device(weight.context.device_id)
+        key = tuple(indices)
+        flat_state, views = self.flat_states.get(key, (None, None))
+        if views is None or any(self.states.get(i) is not v for i, v in zip(indices, views)):
+            for i, w in zip(indices, weights):
+                if i not in self.states:
+                    with profiler_scope("updater:optimizer_state"):
+                        self.states[i] = self.optimizer.create_state_multi_precision(i, w)
+                elif not self.states_synced[i]:
+                    self.states[i] = self.sync_state_context(self.states[i], w.context)
+                self.states_synced[i] = True
+            flat_state = _flatten_states([self.states[i] for i in indices])
+            views = _state_views(flat_state, weights)
+            for i, v in zip(indices, views):
+                self.states[i] = v
+            self.flat_states[key] = (flat_state, views)
+        self.optimizer.flat_step(list(indices), weight, grad, flat_state, offsets)
+
     def sync_state_context(self, state, context):
         """sync state context."""
         if isinstance(state, NDArray):
@@ -126,6 +183,36 @@ class Updater(object):
         return pickle.dumps((self.states, self.optimizer) if dump_optimizer else self.states)
 
 
+def _flatten_states(states):
+    """Concatenates the flattened states of several weights into one flat state of the
+    same structure."""
+    first = states[0]
+    if isinstance(first, NDArray):
+        return concat(*[s.reshape((-1,)) for s in states], dim=0)
+    if isinstance(first, (tuple, list)):
+        flat = [_flatten_states([s[j] for s in states]) for j in range(len(first))]
+        return tuple(flat) if isinstance(first, tuple) else flat
+    return first
+
+
+def _state_views(flat_state, weights):
+    """Views into a flat state with the shapes of the weights, one state per weight."""
+    if isinstance(flat_state, NDArray):
+        views = []
+        begin = 0
+        for w in weights:
+            views.append(flat_state[begin:begin + w.size].reshape(w.shape))
+            begin += w.size
+        return views
+    if isinstance(flat_state, (tuple, list)):
+        per_state = [_state_views(s, weights) for s in flat_state]
+        views = list(zip(*per_state))
+        if isinstance(flat_state, list):
+            views = [list(v) for v in views]
+        return views
+    return [flat_state for _ in weights]
+
+
 def get_updater(optimizer):
     """Returns a closure of the updater needed for kvstore.
 
@@ -23,6 +23,49 @@ def _flatten_list(nested_list):
     return [item for sublist in nested_list for item in sublist]
 
 
+def _is_bf16_fused(optimizer, weight):
+    """Whether the bfloat16 `weight` on CPU is updated by the bfloat16 kernels of `optimizer`,
+    with a float32 master copy if `multi_precision` or with stochastic rounding if
+    `stochastic_rounding`."""
+    from ..ndarray import bfloat16
+    return (optimizer.use_fused_step and weight.dtype == bfloat16 and
+            weight.stype == 'default' and weight.context.device_type == 'cpu' and
+            (optimizer.multi_precision or optimizer.stochastic_rounding))
+
+
+def _split_bf16_fused(optimizer, indices, weights, grads, states):
+    """Runs `optimizer.fused_step` separately on the weights updated by the bfloat16 kernels
+    and on the other weights if `weights` mixes them, and returns whether it did."""
+    fused = [_is_bf16_fused(optimizer, weight) for weight in weights]
+    if all(fused) or not any(fused):
+        return False
+    for selected in (True, False):
+        ks = [k for k, f in enumerate(fused) if f == selected]
+        optimizer.fused_step([indices[k] for k in ks], [weights[k] for k in ks],
+                             [grads[k] for k in ks], [states[k] for k in ks])
+    return True
+
+
+def _bf16_fused_state(optimizer, weight, num_states):
+    """The state (weight32, states) of a weight updated by the bfloat16 kernels: its float32
+    master copy, None with stochastic rounding, and `num_states` float32 zero states."""
+    from ..ndarray import zeros
+    weight32 = None if optimizer.stochastic_rounding else weight.astype('float32')
+    states = [zeros(weight.shape, weight.context, dtype='float32') for _ in range(num_states)]
+    return weight32, states
+
+
+def _bf16_fused_inputs(weights, grads, states):
+    """Inputs of the bfloat16 kernels: weight, gradient, float32 states and master weight of
+    each weight, from the states of `_bf16_fused_state`."""
+    inputs = []
+    for weight, grad, (weight32, opt_states) in zip(weights, grads, states):
+        inputs += [weight, grad] + list(opt_states)
+        if weight32 is not None:
+            inputs.append(weight32)
+    return inputs
+
+
 def _as_classic(a, allow_np):
     # TODO(junwu): This is a temp solution for allowing converting
     # np.ndarray to mx.nd.NDArray to be fed into the optimizer since
@@ -21,7 +21,9 @@
 """Profiler setting methods."""
 import ctypes
 import contextlib
+import json
 import contextvars
+import uuid
 import warnings
 from .base import _LIB, check_call, c_str, ProfileHandle, c_str_array, py_str, KVStoreHandle
 
@@ -47,7 +49,7 @@ def set_config(**kwargs):
     profile_imperative : boolean,
         whether to profile imperative operators
     profile_memory : boolean,
-        whether to profile memory usage
+        whether to profile memory usage, with the live bytes of each operator on a timeline
     profile_api : boolean,
         whether to profile the C API
     continuous_dump : boolean,
@@ -57,6 +59,16 @@ def set_config(**kwargs):
     aggregate_stats : boolean,
         whether to maintain aggregate stats in memory for console
         dump.  Has some negative performance impact.
+    profile_dependencies : boolean,
+        whether to record the engine variables each operator reads and writes
+        in the trace, which tools/profile/critical_path.py turns into a
+        critical path and the causes of the idle time of each device
+    profile_hw_counters : boolean,
+        whether each operator samples hardware counters into the aggregate
+        stats: IPC, last level cache misses and, with the raw event in
+        MXNET_PROFILER_FP_EVENT, floating point instructions of the CPU
+        thread, and the time and theoretical occupancy of the GPU kernels.
+        Requires aggregate_stats; GPU operators wait for their kernels.
     profile_process : string
         whether to profile kvstore `server` or `worker`.
         server can only be profiled when kvstore is of type dist.
@@ -169,6 +181,11 @@ def dumps(reset=False, format='table', sort_by='total', ascending=False):
     ascending: boolean
         whether to sort ascendingly
         defaults to False
+
+    Operators that estimate their work, such as FullyConnected, Convolution, dot and the
+    elementwise operators, also report the GFLOP/s and GB/s they achieved and, when the
+    peaks of the device are set with MXNET_PROFILER_{CPU,GPU}_PEAK_{GFLOPS,GBPS}, the
+    percentage of the roofline bound they reached.
     """
     debug_str = ctypes.c_char_p()
     reset_to_int = {False: 0, True: 1}
@@ -193,6 +210,175 @@ def dumps(reset=False, format='table', sort_by='total', ascending=False):
     return py_str(debug_str.value)
 
 
+def set_sample_rate(rate):
+    """Set the rate of the sampling profiler.
+
+    One in `rate` operator executions of each engine thread is timed into latency histograms,
+    whatever the state of the profiler, so it can stay on in production. The initial rate
+    comes from the MXNET_PROFILER_SAMPLE_RATE environment variable.
+
+    Parameters
+    ----------
+    rate: int
+        the sampling rate, 0 turns sampling off
+    """
+    assert rate >= 0, "Invalid value provided for rate: {0}. Must be non-negative".format(rate)
+    check_call(_LIB.MXSetProfilerSampleRate(ctypes.c_int(rate)))
+
+
+def sampled_stats(reset=False):
+    """Return the latency statistics of the sampling profiler.
+
+    Parameters
+    ----------
+    reset: boolean
+        indicates whether to clean the samples collected up to this point
+
+    Returns
+    -------
+    dict
+        the sample rate, the number of samples dropped, and the count, total, min, max,
+        average and 50th, 90th and 99th percentile latencies in ms of each sampled operator
+    """
+    debug_str = ctypes.c_char_p()
+    check_call(_LIB.MXSampledProfileStatsPrint(ctypes.byref(debug_str), int(bool(reset))))
+    return json.loads(py_str(debug_str.value))
+
+
+def memory_peak_snapshot(reset=False):
+    """Return the peak memory of each device recorded by the memory timeline.
+
+    The timeline runs while the profiler is running with ``profile_memory=True``. Every
+    allocation is charged to the operator that made it, or that the memory planner made it
+    for, until it is freed.
+
+    Parameters
+    ----------
+    reset: boolean
+        indicates whether to restart the peak tracking from the memory currently in use
+
+    Returns
+    -------
+    dict
+        for each device the peak live bytes, the bytes cached by the memory pool and the time
+        of the peak, and the operators holding memory at the peak, largest first, with
+        whether the memory was planned or allocated dynamically
+    """
+    debug_str = ctypes.c_char_p()
+    check_call(_LIB.MXMemoryPeakSnapshotPrint(ctypes.byref(debug_str), int(bool(reset))))
+    return json.loads(py_str(debug_str.value))
+
+
+@contextlib.contextmanager
+def request_trace(name='request', trace_id=None):
+    """Trace the latency of one request, such as one inference call of a server.
+
+    The operators pushed by the calling thread inside the context, including those of
+    hybridized blocks, are traced as spans of the request, with the time they waited for
+    their inputs and for a worker. The calls of ``CachedOp::Forward`` and the waits of the
+    thread are traced too. Unlike the profiler, tracing only affects the calling thread, so
+    that it can stay on in production. The finished traces are returned by `request_traces()`.
+
+    Parameters
+    ----------
+    name : string
+        name of the root span of the request
+    trace_id : string, optional
+        32 hex digits to join the trace of the caller, such as the trace id of the
+        ``traceparent`` header of the request. By default, a new trace id
+
+    Yields
+    ------
+    string
+        the trace id
+    """
+    if trace_id is None:
+        trace_id = uuid.uuid4().hex
+    check_call(_LIB.MXRequestTraceBegin(c_str(name), c_str(trace_id)))
+    try:
+        yield trace_id
+    finally:
+        check_call(_LIB.MXRequestTraceEnd())
+
+
+def request_traces(reset=False):
+    """Return the finished request traces as an OTLP/JSON ``ExportTraceServiceRequest``.
+
+    The last ``MXNET_REQUEST_TRACE_BUFFER`` requests are kept. The root span of each request
+    sums up its host, queue, dispatch, compute and sync time in its attributes. Operators
+    still running when the request ends add their span when they complete, so wait for the
+    outputs inside the request to trace all of them.
+
+    Parameters
+    ----------
+    reset: boolean
+        indicates whether to drop the returned traces
+
+    Returns
+    -------
+    dict
+        the traces, that can be posted as is to the ``/v1/traces`` endpoint of an
+        OpenTelemetry collector
+    """
+    debug_str = ctypes.c_char_p()
+    check_call(_LIB.MXRequestTraceDump(ctypes.byref(debug_str), int(bool(reset))))
+    return json.loads(py_str(debug_str.value))
+
+
+def metrics():
+    """Return a snapshot of the live metrics in the OpenMetrics text format.
+
+    The metrics are always collected, whatever the state of the profiler: the pending
+    operators and queue depths of the engine, the used and cached bytes of each memory pool,
+    the bytes pushed to and pulled from kvstores per key group and the batches produced by
+    the data iterators.
+    """
+    debug_str = ctypes.c_char_p()
+    check_call(_LIB.MXGetMetrics(ctypes.byref(debug_str)))
+    return py_str(debug_str.value)
+
+
+def start_metrics_server(port, addr=''):
+    """Serve the metrics over HTTP for a Prometheus or OpenMetrics scraper.
+
+    Every GET request is answered with a fresh snapshot of `metrics()`. The server runs in a
+    daemon thread until the process exits.
+
+    Parameters
+    ----------
+    port: int
+        the port to listen on, 0 picks a free one
+    addr: string
+        the address to listen on, defaults to all interfaces
+
+    Returns
+    -------
+    http.server.HTTPServer
+        the server, `server_address` holds the port it listens on
+    """
+    import http.server
+    import threading
+
+    class _MetricsHandler(http.server.BaseHTTPRequestHandler):
+        def do_GET(self):  # pylint: disable=invalid-name
+            body = metrics().encode('utf-8')
+            self.send_response(200)
+            self.send_header('Content-Type',
+                             'application/openmetrics-text; version=1.0.0; charset=utf-8')
+            self.send_header('Content-Length', str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+        def log_message(self, format, *args):  # pylint: disable=redefined-builtin
+            pass
+
+    server = http.server.ThreadingHTTPServer((addr, port), _MetricsHandler)
+    server.daemon_threads = True
+    thread = threading.Thread(target=server.serve_forever, name='mxnet-metrics', daemon=True)
+    thread.start()
+    return server
+
+
 def pause(profile_process='worker'):
     """Pause profiling.
 
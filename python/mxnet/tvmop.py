@@ -22,6 +22,7 @@ from .runtime import Features
 if Features().is_enabled("TVM_OP"):
     import json
     import logging
+    import os
 
     from ._ctypes.space import _set_tvm_op_config
     from .base import check_call, _LIB, c_str
@@ -41,3 +42,25 @@ if Features().is_enabled("TVM_OP"):
         with open(_CONF_TVM_OP[0], "r") as f:
             ret = ConfigSpaces.from_json_dict(json.load(f))
         _set_tvm_op_config(ret)
+
+    def load_tuned(path):
+        """Load the TVM operator kernels tuned by contrib/tvmop/tune.py for the shapes they are
+        called with. They are called in place of the generic kernels for those shapes.
+
+        Parameters
+        ----------
+        path : str
+            A library of tuned kernels, or a directory whose libraries are all loaded.
+        """
+        if os.path.isdir(path):
+            libs = [os.path.join(path, f) for f in sorted(os.listdir(path)) if f.endswith(".so")]
+        else:
+            libs = [path]
+        for lib in libs:
+            check_call(_LIB.MXLoadTVMTunedOp(c_str(lib)))
+        if libs:
+            logging.info("TVM op tuned kernels have been loaded from %s", path)
+
+    _TUNED_TVM_OP = os.environ.get("MXNET_TVM_OP_TUNED_DIR")
+    if _TUNED_TVM_OP and os.path.isdir(_TUNED_TVM_OP):
+        load_tuned(_TUNED_TVM_OP)
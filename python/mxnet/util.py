@@ -1336,6 +1336,46 @@ def set_flush_denorms(value):
     return ret.value
 
 
+def set_storage_fallback_audit(enabled=True):
+    """Enable or disable the audit of the storage fallbacks. While enabled, every conversion
+    between storage types made around an operator without a kernel for the storage types of its
+    arrays is recorded, with the bytes of the dense array converted. The audit is also enabled
+    by setting the environment variable MXNET_STORAGE_FALLBACK_AUDIT to 1, which prints it at exit.
+
+    Parameters
+    ----------
+    enabled : bool
+        Whether to record the storage fallbacks.
+
+    Returns
+    -------
+    prev : bool
+        Whether the audit was enabled before the call.
+    """
+    prev = ctypes.c_int()
+    check_call(_LIB.MXSetStorageFallbackAudit(ctypes.c_int(enabled), ctypes.byref(prev)))
+    return bool(prev.value)
+
+
+def storage_fallback_audit(reset=False):
+    """Return the table of the storage fallbacks recorded since the audit was enabled, with a row
+    per operator, conversion and device giving the number of conversions and the bytes
+    converted, by decreasing bytes.
+
+    Parameters
+    ----------
+    reset : bool
+        Whether to clear the recorded fallbacks.
+
+    Returns
+    -------
+    str
+        The table of the storage fallbacks.
+    """
+    table = ctypes.c_char_p()
+    check_call(_LIB.MXStorageFallbackAuditDumps(ctypes.c_int(reset), ctypes.byref(table)))
+    return py_str(table.value)
+
 def dtype_from_number(number):
     """Get the data type from the given int or float number
     """
@@ -37,7 +37,7 @@ MXNET_REGISTER_API("_npx.foreach")
       const nnvm::Op* op = Op::Get("_npx_foreach");
       op::NPXForeachParam param = {};
       int args_size  = args.size();
-      int num_inputs = args_size - 7;
+      int num_inputs = args_size - 8;
       // inputs
       nnvm::Symbol* sym = static_cast<nnvm::Symbol*>(args[0].value().v_handle);
       std::vector<std::shared_ptr<nnvm::Symbol> > subgraphs;
@@ -71,6 +71,7 @@ MXNET_REGISTER_API("_npx.foreach")
       } else {
         param.in_state_index = mxnet::Tuple<int64_t>(args[6 + num_inputs].operator ObjectRef());
       }
+      param.compiled  = args[7 + num_inputs].operator bool();
       attrs.parsed    = param;
       attrs.op        = op;
       attrs.subgraphs = subgraphs;
@@ -96,7 +97,7 @@ MXNET_REGISTER_API("_npx.while_loop")
       const nnvm::Op* op = Op::Get("_npx_while_loop");
       op::NPXWhileLoopParam param = {};
       int args_size  = args.size();
-      int num_inputs = args_size - 8;
+      int num_inputs = args_size - 9;
       // inputs
       std::vector<std::shared_ptr<nnvm::Symbol> > subgraphs;
       subgraphs.reserve(2);
@@ -129,6 +130,7 @@ MXNET_REGISTER_API("_npx.while_loop")
       }
       param.num_out_data = args[6 + num_inputs].operator int();
       param.num_outputs  = args[7 + num_inputs].operator int();
+      param.compiled     = args[8 + num_inputs].operator bool();
       attrs.parsed       = param;
       attrs.op           = op;
       attrs.subgraphs    = subgraphs;
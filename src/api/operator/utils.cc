@@ -98,6 +98,9 @@ std::vector<NDArray*> Invoke(const nnvm::Op* op,
 
   if (Imperative::Get()->is_deferred_compute()) {
     Imperative::Get()->RecordDeferredCompute(std::move(*attrs), ndinputs, ndoutputs);
+  } else if (Imperative::Get()->is_lazy_eval() &&
+             Imperative::Get()->RecordLazyEval(*attrs, ndinputs, ndoutputs)) {
+    // computed when the outputs are read
   } else {
     for (NDArray* input : ndinputs) {
       Imperative::DCInfo::Compute(*input);
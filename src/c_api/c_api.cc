@@ -21,6 +21,7 @@
  * \file c_api.cc
  * \brief C API of mxnet
  */
+#include <cstring>
 #include <vector>
 #include <sstream>
 #include <string>
@@ -47,7 +48,9 @@
 #include "mxnet/imperative.h"
 #include "mxnet/lib_api.h"
 #include "../initialize.h"
+#include "../ndarray/parameter_store.h"
 #include "./c_api_common.h"
+#include "../operator/contrib/sync_batch_norm_nccl.h"
 #include "../operator/custom/custom-inl.h"
 #include "../operator/operator_common.h"
 #include "../operator/subgraph/common.h"
@@ -56,9 +59,12 @@
 #include "../operator/subgraph/partitioner/custom_subgraph_property.h"
 #include "../operator/subgraph/subgraph_property.h"
 #include "../common/alm.h"
+#include "../common/exec_utils.h"
 #include "../common/utils.h"
+#include "../profiler/metrics.h"
 #include "../profiler/profiler.h"
 #include "../serialization/cnpy.h"
+#include "../storage/gpu_ipc_storage.h"
 #include "miniz.h"
 #include "nnvm/pass_functions.h"
 
@@ -141,6 +147,7 @@ std::string getExtensionMsgs(mxnet::ext::msgSize_t msgSize, mxnet::ext::msgGet_t
 /*!
  * \brief Common compute function dispatcher for forward/backward and stateful forward/backward
  * state_ptr will be nullptr for regular ops; fcomp_fp is nullptr for stateful ops
+ * workspace_size is the workspace the operator declared for the pass, 0 for none
  */
 void CustomFComputeDispatcher(const std::string op_name,
                               const mxnet::ext::opCallFComp_t callFComp,
@@ -153,6 +160,7 @@ void CustomFComputeDispatcher(const std::string op_name,
                               const std::vector<NDArray>& inputs,
                               const std::vector<OpReqType>& req,
                               const std::vector<NDArray>& outputs,
+                              size_t workspace_size,
                               mxnet::ext::msgSize_t msgSize,
                               mxnet::ext::msgGet_t msgGet) {
   using namespace mxnet::ext;
@@ -238,14 +246,45 @@ void CustomFComputeDispatcher(const std::string op_name,
   mshadow::Stream<mxnet::cpu>* cpu_stream = ctx.get_stream<mxnet::cpu>();
   mshadow::Stream<mxnet::gpu>* gpu_stream = ctx.get_stream<mxnet::gpu>();
 
+  // the declared workspace is requested once on the device of the operator, and its
+  // allocations are served from consecutive slices of it instead of each one requesting the
+  // temp space from its start again
+  const bool on_gpu     = ctx.run_ctx.ctx.dev_mask() == Context::kGPU;
+  char* declared_space  = nullptr;
+  size_t workspace_used = 0;
+  if (workspace_size > 0 && on_gpu) {
+    declared_space = resource
+                         .get_space_typed<mxnet::gpu, 1, char>(mshadow::Shape1(workspace_size),
+                                                               gpu_stream)
+                         .dptr_;
+  } else if (workspace_size > 0) {
+    declared_space = resource
+                         .get_space_typed<mxnet::cpu, 1, char>(mshadow::Shape1(workspace_size),
+                                                               cpu_stream)
+                         .dptr_;
+  }
+  auto workspace_alloc = [&](int size) {
+    const size_t offset = workspace_used;
+    CHECK_LE(offset + size, workspace_size)
+        << "Custom operator '" << op_name << "' allocated more than the " << workspace_size
+        << " bytes of workspace it declared";
+    workspace_used = (offset + size + MX_WORKSPACE_ALIGNMENT - 1) / MX_WORKSPACE_ALIGNMENT *
+                     MX_WORKSPACE_ALIGNMENT;
+    return declared_space + offset;
+  };
+
   // create lambda that captures stream & resource objects
   // this temp workspace holds memory allocated by custom library via OpResource
   auto cpu_alloc = [&](int size) {
+    if (declared_space != nullptr && !on_gpu)
+      return workspace_alloc(size);
     mshadow::Tensor<mxnet::cpu, 1, char> workspace =
         resource.get_space_typed<mxnet::cpu, 1, char>(mshadow::Shape1(size), cpu_stream);
     return workspace.dptr_;
   };
   auto gpu_alloc = [&](int size) {
+    if (declared_space != nullptr && on_gpu)
+      return workspace_alloc(size);
     mshadow::Tensor<mxnet::gpu, 1, char> workspace =
         resource.get_space_typed<mxnet::gpu, 1, char>(mshadow::Shape1(size), gpu_stream);
     return workspace.dptr_;
@@ -438,6 +477,8 @@ template <typename RescReq,
           typename InferShape,
           typename InferSType,
           typename MutateInputs,
+          typename WorkspaceSize,
+          typename InplaceOption,
           typename SubgraphNumInputs,
           typename SubgraphInferType,
           typename SubgraphInferShape,
@@ -456,6 +497,8 @@ void registerOp(const char* name,
                 InferShape infer_shape,
                 InferSType infer_storage_type,
                 MutateInputs mutate_inputs,
+                WorkspaceSize workspace_size,
+                InplaceOption inplace_option,
                 SubgraphNumInputs num_subgraph_inputs,
                 SubgraphInferType infer_subgraph_type,
                 SubgraphInferShape infer_subgraph_shape,
@@ -463,6 +506,7 @@ void registerOp(const char* name,
                 CreateOpState create_opstate,
                 GradReg grad_reg,
                 mxnet::ext::mutateInputs_t mutate_fp,
+                mxnet::ext::inplaceOption_t inplace_fp,
                 const std::unordered_map<std::string, mxnet::ext::createOpState_t>& createop_map,
                 const std::unordered_map<std::string, mxnet::ext::fcomp_t>& forward_ctx_map,
                 const std::unordered_map<std::string, mxnet::ext::fcomp_t>& backward_ctx_map,
@@ -495,6 +539,9 @@ void registerOp(const char* name,
     // optionally add fmutate inputs if user specified a function
     if (mutate_fp != nullptr)
       regOp.set_attr<nnvm::FMutateInputs>("FMutateInputs", mutate_inputs, plevel);
+    // optionally add finplace option if user specified a function
+    if (inplace_fp != nullptr)
+      regOp.set_attr<nnvm::FInplaceOption>("FInplaceOption", inplace_option, plevel);
   } else {
     using namespace mxnet::op;
     regOp.set_num_inputs(num_subgraph_inputs);
@@ -504,6 +551,20 @@ void registerOp(const char* name,
     regOp.set_attr<FInferStorageType>("FInferStorageType", infer_subgraph_storage_type, plevel);
     regOp.set_attr<nnvm::FMutateInputs>("FMutateInputs", DefaultSubgraphOpMutableInputs, plevel);
   }
+  // workspace declared for a pass, from the count inputs of the forward starting at begin
+  auto pass_workspace = [=](const nnvm::NodeAttrs& attrs,
+                            const std::vector<NDArray>& inputs,
+                            size_t begin,
+                            size_t count,
+                            bool backward) {
+    std::vector<TShape> in_shapes;
+    std::vector<int> in_types;
+    for (size_t i = begin; i < begin + count; ++i) {
+      in_shapes.push_back(inputs[i].shape());
+      in_types.push_back(inputs[i].dtype());
+    }
+    return workspace_size(attrs, in_shapes, in_types, backward);
+  };
   // optionally add stateful forward
   if (createop_map.size() != 0) {
     regOp.set_attr<FCreateOpState>("FCreateOpState", create_opstate, plevel);
@@ -512,6 +573,7 @@ void registerOp(const char* name,
                               const std::vector<NDArray>& inputs,
                               const std::vector<OpReqType>& req,
                               const std::vector<NDArray>& outputs) {
+      const CustomStatefulOpWrapper& op = state_ptr.get_state<CustomStatefulOpWrapper>();
       CustomFComputeDispatcher(name_str,
                                nullptr,
                                nullptr,
@@ -523,6 +585,7 @@ void registerOp(const char* name,
                                inputs,
                                req,
                                outputs,
+                               op.workspace_size(false),
                                msgSize,
                                msgGet);
     };
@@ -550,6 +613,7 @@ void registerOp(const char* name,
                                  inputs,
                                  req,
                                  outputs,
+                                 pass_workspace(attrs, inputs, 0, inputs.size(), false),
                                  msgSize,
                                  msgGet);
       } else if (ctx.run_ctx.ctx.dev_mask() == Context::kGPU) {
@@ -566,6 +630,7 @@ void registerOp(const char* name,
                                  inputs,
                                  req,
                                  outputs,
+                                 pass_workspace(attrs, inputs, 0, inputs.size(), false),
                                  msgSize,
                                  msgGet);
       }
@@ -610,6 +675,7 @@ void registerOp(const char* name,
                                  const std::vector<NDArray>& inputs,
                                  const std::vector<OpReqType>& req,
                                  const std::vector<NDArray>& outputs) {
+        const CustomStatefulOpWrapper& op = state_ptr.get_state<CustomStatefulOpWrapper>();
         CustomFComputeDispatcher(name_str,
                                  nullptr,
                                  nullptr,
@@ -621,6 +687,7 @@ void registerOp(const char* name,
                                  inputs,
                                  req,
                                  outputs,
+                                 op.workspace_size(true),
                                  msgSize,
                                  msgGet);
       };
@@ -635,6 +702,9 @@ void registerOp(const char* name,
                                        const std::vector<NDArray>& inputs,
                                        const std::vector<OpReqType>& req,
                                        const std::vector<NDArray>& outputs) {
+          // the inputs are the output gradients, the inputs and the outputs of the forward
+          const size_t num_fwd_in  = outputs.size();
+          const size_t num_fwd_out = (inputs.size() - num_fwd_in) / 2;
           CustomFComputeDispatcher(name_str,
                                    callFComp,
                                    fcomp_back_cpu,
@@ -646,6 +716,7 @@ void registerOp(const char* name,
                                    inputs,
                                    req,
                                    outputs,
+                                   pass_workspace(attrs, inputs, num_fwd_out, num_fwd_in, true),
                                    msgSize,
                                    msgGet);
         };
@@ -658,6 +729,9 @@ void registerOp(const char* name,
                                        const std::vector<NDArray>& inputs,
                                        const std::vector<OpReqType>& req,
                                        const std::vector<NDArray>& outputs) {
+          // the inputs are the output gradients, the inputs and the outputs of the forward
+          const size_t num_fwd_in  = outputs.size();
+          const size_t num_fwd_out = (inputs.size() - num_fwd_in) / 2;
           CustomFComputeDispatcher(name_str,
                                    callFComp,
                                    fcomp_back_gpu,
@@ -669,6 +743,7 @@ void registerOp(const char* name,
                                    inputs,
                                    req,
                                    outputs,
+                                   pass_workspace(attrs, inputs, num_fwd_out, num_fwd_in, true),
                                    msgSize,
                                    msgGet);
         };
@@ -705,6 +780,12 @@ void registerOperators(void* lib,
   opCallMutateInputs_t callMutateInputs =
       get_func<opCallMutateInputs_t>(lib, const_cast<char*>(MXLIB_OPCALLMUTATEINPUTS_STR));
 
+  opCallWorkspaceSize_t callWorkspaceSize =
+      get_func<opCallWorkspaceSize_t>(lib, const_cast<char*>(MXLIB_OPCALLWORKSPACESIZE_STR));
+
+  opCallInplaceOption_t callInplaceOption =
+      get_func<opCallInplaceOption_t>(lib, const_cast<char*>(MXLIB_OPCALLINPLACEOPTION_STR));
+
   opCallCreateOpState_t callCreateOpState =
       get_func<opCallCreateOpState_t>(lib, const_cast<char*>(MXLIB_OPCALLCREATEOPSTATE_STR));
 
@@ -733,9 +814,11 @@ void registerOperators(void* lib,
     inferSType_t stype_fp = nullptr;
     inferShape_t shape_fp = nullptr;
     // optional attributes
-    mutateInputs_t mutate_fp = nullptr;
-    bool isSubgraphOp        = false;
-    int _isSubgraphOp        = 0;
+    mutateInputs_t mutate_fp     = nullptr;
+    workspaceSize_t workspace_fp = nullptr;
+    inplaceOption_t inplace_fp   = nullptr;
+    bool isSubgraphOp            = false;
+    int _isSubgraphOp            = 0;
     // lists of forward and backward function associated with each context
     const char **forward_ctx, **backward_ctx, **createop_ctx;
     fcomp_t *forward_fcomp, *backward_fcomp;
@@ -759,7 +842,9 @@ void registerOperators(void* lib,
              &type_fp,
              &stype_fp,
              &shape_fp,
-             &mutate_fp);
+             &mutate_fp,
+             &workspace_fp,
+             &inplace_fp);
 
     // construct maps of context to forward/backward custom library function
     std::unordered_map<std::string, fcomp_t> forward_ctx_map;
@@ -1172,6 +1257,80 @@ void registerOperators(void* lib,
       return mutate_indices_list;
     };
 
+    // lambda function to get the bytes of workspace the operator declared for a pass
+    auto workspace_size = [=](const nnvm::NodeAttrs& attrs,
+                              const std::vector<TShape>& in_shapes,
+                              const std::vector<int>& in_types,
+                              bool backward) -> size_t {
+      if (workspace_fp == nullptr)
+        return 0;
+      // convert attributes to vector of char*
+      std::vector<const char*> attr_keys, attr_vals;
+      for (auto& kv : attrs.dict) {
+        attr_keys.push_back(kv.first.c_str());
+        attr_vals.push_back(kv.second.c_str());
+      }
+
+      // copy input shapes to raw memory layout
+      std::vector<std::vector<uint32_t>> inbuff(in_shapes.size());
+      std::vector<uint32_t*> inshapes(in_shapes.size());
+      std::vector<int> indims(in_shapes.size());
+      for (size_t i = 0; i < in_shapes.size(); ++i) {
+        for (int j = 0; j < in_shapes[i].ndim(); ++j)
+          inbuff[i].push_back(static_cast<uint32_t>(in_shapes[i][j]));
+        inshapes[i] = inbuff[i].data();
+        indims[i]   = in_shapes[i].ndim();
+      }
+
+      size_t size      = 0;
+      int retval       = callWorkspaceSize(workspace_fp,
+                                     attr_keys.data(),
+                                     attr_vals.data(),
+                                     attr_keys.size(),
+                                     inshapes.data(),
+                                     indims.data(),
+                                     in_shapes.size(),
+                                     in_types.data(),
+                                     backward,
+                                     &size);
+      std::string msgs = getExtensionMsgs(msgSize, msgGet);
+      CHECK(retval) << "Error calling WorkspaceSize for custom operator '" << name_str << "'"
+                    << msgs;
+      return size;
+    };
+
+    // lambda function to convert from external inplace_option to internal MXNet types
+    auto inplace_option = [=](const nnvm::NodeAttrs& attrs) {
+      // convert attributes to vector of char*
+      std::vector<const char*> attr_keys, attr_vals;
+      for (auto& kv : attrs.dict) {
+        attr_keys.push_back(kv.first.c_str());
+        attr_vals.push_back(kv.second.c_str());
+      }
+
+      // C type placeholder for the flattened (input, output) pairs
+      int* inplace_pairs = nullptr;
+      int num_pairs      = 0;
+
+      int retval       = callInplaceOption(inplace_fp,
+                                     attr_keys.data(),
+                                     attr_vals.data(),
+                                     attr_keys.size(),
+                                     &inplace_pairs,
+                                     &num_pairs);
+      std::string msgs = getExtensionMsgs(msgSize, msgGet);
+      CHECK(retval) << "Error calling InplaceOption for custom operator '" << name_str << "'"
+                    << msgs;
+
+      std::vector<std::pair<int, int>> pairs(num_pairs);
+      for (int i = 0; i < num_pairs; i++) {
+        pairs[i] = {inplace_pairs[2 * i], inplace_pairs[2 * i + 1]};
+      }
+      callFree(inplace_pairs);
+
+      return pairs;
+    };
+
     // lambda function to set storage types
     auto infer_storage_type = [=](const nnvm::NodeAttrs& attrs,
                                   const int dev_mask,
@@ -1393,7 +1552,12 @@ void registerOperators(void* lib,
                   << "allocated with 'new' since it will be destructed with 'delete'. "
                   << "To suppress this message without calling CustomStatefulOp::create() "
                   << "set ignore_warn to 'true' on custom stateful op instance.";
-      return OpStatePtr::Create<CustomStatefulOpWrapper>(state_op, callDestroyOpState);
+      // the state keeps the workspace of the shapes it is created with
+      return OpStatePtr::Create<CustomStatefulOpWrapper>(
+          state_op,
+          callDestroyOpState,
+          workspace_size(attrs, in_shapes, in_types, false),
+          workspace_size(attrs, in_shapes, in_types, true));
     };
 
     /* -------------- BELOW IS THE REGISTRATION FOR CUSTOM OPERATORS --------------- */
@@ -1410,6 +1574,8 @@ void registerOperators(void* lib,
                infer_shape,
                infer_storage_type,
                mutate_inputs,
+               workspace_size,
+               inplace_option,
                num_subgraph_inputs,
                infer_subgraph_type,
                infer_subgraph_shape,
@@ -1417,6 +1583,7 @@ void registerOperators(void* lib,
                create_opstate,
                grad_reg,
                mutate_fp,
+               inplace_fp,
                createop_map,
                forward_ctx_map,
                backward_ctx_map,
@@ -1910,6 +2077,21 @@ int MXSetFlushDenorms(bool value, bool* prev_state) {
   API_END();
 }
 
+int MXSetStorageFallbackAudit(int enabled, int* prev) {
+  API_BEGIN();
+  *prev = common::StorageFallbackAudit::Get()->set_enabled(enabled != 0);
+  API_END();
+}
+
+int MXStorageFallbackAuditDumps(int reset, const char** out_str) {
+  MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+  API_BEGIN();
+  CHECK_NOTNULL(out_str);
+  ret->ret_str = common::StorageFallbackAudit::Get()->Dump(reset != 0);
+  *out_str     = ret->ret_str.c_str();
+  API_END();
+}
+
 int MXNotifyShutdown() {
   API_BEGIN();
   mxnet::op::custom::CustomOperator::Get()->Stop();
@@ -1987,6 +2169,12 @@ int MXLoadTVMOp(const char* libpath) {
   API_END();
 }
 
+int MXLoadTVMTunedOp(const char* libpath) {
+  API_BEGIN();
+  tvm::runtime::TVMOpModule::Get()->LoadTuned(libpath);
+  API_END();
+}
+
 int MXLoadTVMConfig(ConfigSpaces config) {
   API_BEGIN();
   for (int k = 0; k < config.spaces_size; ++k) {
@@ -2191,6 +2379,32 @@ int MXNDArraySyncCopyToCPU(NDArrayHandle handle, void* data, size_t size) {
   API_END();
 }
 
+int MXNDArrayAsyncCopyToCPU(NDArrayHandle handle, void* data, size_t size, EngineVarHandle* out) {
+  API_BEGIN();
+  Engine::VarHandle done = Engine::Get()->NewVariable();
+  try {
+    static_cast<NDArray*>(handle)->AsyncCopyToCPU(data, size, done);
+  } catch (...) {
+    Engine::Get()->DeleteVariable([](RunContext) {}, Context::CPU(), done);
+    throw;
+  }
+  *out = done;
+  API_END();
+}
+
+int MXNDArrayWaitAsyncCopy(EngineVarHandle copy) {
+  API_BEGIN();
+  Engine::Get()->WaitForVar(static_cast<Engine::VarHandle>(copy));
+  API_END();
+}
+
+int MXNDArrayFreeAsyncCopy(EngineVarHandle copy) {
+  API_BEGIN();
+  Engine::Get()->DeleteVariable(
+      [](RunContext) {}, Context::CPU(), static_cast<Engine::VarHandle>(copy));
+  API_END();
+}
+
 /*!
  * \brief Copy src.data() to dst.data() if i = -1, else dst.aux_data(i) if i >= 0
  * This function blocks. Do not use it in performance critical code.
@@ -2256,6 +2470,30 @@ int MXNDArrayLegacySave(const char* fname,
   API_END();
 }
 
+/*! \brief save arrays to an npz file, with the deflate level of its members or 0 */
+static void SaveNPZ(const char* fname,
+                    uint32_t num_args,
+                    NDArrayHandle* args,
+                    const char** keys,
+                    int level) {
+  std::vector<std::string> names(num_args);
+  std::vector<NDArray> arrays(num_args);
+  for (uint32_t i = 0; i < num_args; ++i) {
+    names[i]  = keys == nullptr ? "arr_" + std::to_string(i) : keys[i];
+    arrays[i] = *static_cast<NDArray*>(args[i]);
+  }
+  mz_zip_archive archive{};
+  CHECK(mz_zip_writer_init_file(&archive, fname, 0))
+      << "Failed to open archive " << fname << ": "
+      << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
+  npz::save_arrays(&archive, names, arrays, level);
+  CHECK(mz_zip_writer_finalize_archive(&archive))
+      << "Failed to finalize archive " << fname
+      << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
+  CHECK(mz_zip_writer_end(&archive)) << "Failed to end archive " << fname
+                                     << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
+}
+
 int MXNDArraySave(const char* fname, uint32_t num_args, NDArrayHandle* args, const char** keys) {
   API_BEGIN();
 
@@ -2282,29 +2520,29 @@ int MXNDArraySave(const char* fname, uint32_t num_args, NDArrayHandle* args, con
           << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
     }
   } else {
-    mz_zip_archive archive{};
-    CHECK(mz_zip_writer_init_file(&archive, fname, 0))
-        << "Failed to open archive " << fname << ": "
-        << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
-    for (uint32_t i = 0; i < num_args; ++i) {
-      NDArray* array              = static_cast<NDArray*>(args[i]);
-      const std::string array_key = keys == nullptr ? "arr_" + std::to_string(i) : keys[i];
-      npz::save_array(&archive, array_key, *array);
-    }
-    CHECK(mz_zip_writer_finalize_archive(&archive))
-        << "Failed to finalize archive " << fname
-        << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
-    CHECK(mz_zip_writer_end(&archive)) << "Failed to end archive " << fname
-                                       << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
+    SaveNPZ(fname, num_args, args, keys, 0);
   }
   API_END();
 }
 
-int MXNDArrayLoad(const char* fname,
-                  uint32_t* out_size,
-                  NDArrayHandle** out_arr,
-                  uint32_t* out_name_size,
-                  const char*** out_names) {
+int MXNDArraySaveCompressed(const char* fname,
+                            uint32_t num_args,
+                            NDArrayHandle* args,
+                            const char** keys,
+                            int level) {
+  API_BEGIN();
+  CHECK_NOTNULL(fname);
+  CHECK(level >= 1 && level <= MZ_UBER_COMPRESSION) << "Invalid compression level " << level;
+  SaveNPZ(fname, num_args, args, keys, level);
+  API_END();
+}
+
+static int NDArrayLoad(const char* fname,
+                       bool mapped,
+                       uint32_t* out_size,
+                       NDArrayHandle** out_arr,
+                       uint32_t* out_name_size,
+                       const char*** out_names) {
   MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
   ret->ret_vec_str.clear();
   API_BEGIN();
@@ -2317,8 +2555,8 @@ int MXNDArrayLoad(const char* fname,
   }
 
   if (magic == 0x04034b50 || magic == 0x504b0304 || magic == 0x06054b50 ||
-      magic == 0x504b0506) {                       // zip file format; assumed to be npz
-    auto [data, names] = npz::load_arrays(fname);  // NOLINT
+      magic == 0x504b0506) {                               // zip file format; assumed to be npz
+    auto [data, names] = npz::load_arrays(fname, mapped);  // NOLINT
     ret->ret_handles.resize(data.size());
     for (size_t i = 0; i < data.size(); ++i) {
       NDArray* ptr        = new NDArray();
@@ -2341,13 +2579,16 @@ int MXNDArrayLoad(const char* fname,
     *out_size = 1;
     ret->ret_handles.resize(1);
     NDArray* ptr = new NDArray();
-    *ptr         = npy::load_array(fname);  // Only supports local filesystem at this point in time
+    // Only supports local filesystem at this point in time
+    *ptr                = npy::load_array(fname, mapped);
     ret->ret_handles[0] = ptr;
     *out_arr            = dmlc::BeginPtr(ret->ret_handles);
   } else {
     std::vector<NDArray> data;
     std::vector<std::string>& names = ret->ret_vec_str;
-    {
+    if (mapped) {
+      mxnet::NDArray::LoadMapped(fname, &data, &names);
+    } else {
       std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(fname, "r"));
       mxnet::NDArray::Load(fi.get(), &data, &names);
     }
@@ -2369,6 +2610,22 @@ int MXNDArrayLoad(const char* fname,
   API_END();
 }
 
+int MXNDArrayLoad(const char* fname,
+                  uint32_t* out_size,
+                  NDArrayHandle** out_arr,
+                  uint32_t* out_name_size,
+                  const char*** out_names) {
+  return NDArrayLoad(fname, false, out_size, out_arr, out_name_size, out_names);
+}
+
+int MXNDArrayLoadMapped(const char* fname,
+                        uint32_t* out_size,
+                        NDArrayHandle** out_arr,
+                        uint32_t* out_name_size,
+                        const char*** out_names) {
+  return NDArrayLoad(fname, true, out_size, out_arr, out_name_size, out_names);
+}
+
 int MXNDArrayLoadFromBuffer(const void* ndarray_buffer,
                             size_t size,
                             uint32_t* out_size,
@@ -2599,6 +2856,15 @@ int MXNDArrayFromDLPack(DLManagedTensorHandle dlpack,
   API_END();
 }
 
+int MXNDArrayDeduplicate(NDArrayHandle handle, NDArrayHandle* out, uint64_t* saved_bytes) {
+  API_BEGIN();
+  ParameterStore* store = ParameterStore::Get();
+  *out                  = new NDArray(store->Deduplicate(*static_cast<NDArray*>(handle)));
+  if (saved_bytes != nullptr)
+    *saved_bytes = store->saved_bytes();
+  API_END();
+}
+
 int MXNDArrayCallDLPackDeleter(DLManagedTensorHandle dlpack) {
   API_BEGIN();
   if (dlpack != nullptr) {
@@ -2823,6 +3089,11 @@ int MXDataIterGetLenHint(DataIterHandle handle, int64_t* len) {
 int MXDataIterNext(DataIterHandle handle, int* out) {
   API_BEGIN();
   *out = static_cast<IIterator<DataBatch>*>(handle)->Next();
+  if (*out) {
+    static profiler::MetricCounter* batches = profiler::Metrics::Get()->GetCounter(
+        "mxnet_dataiter_batches", "Batches produced by the data iterators.");
+    batches->Add(1);
+  }
   API_END();
 }
 
@@ -3143,6 +3414,57 @@ int MXKVStoreInitEx(KVStoreHandle handle, uint32_t num, const char** keys, NDArr
   API_END();
 }
 
+namespace {
+
+inline const NDArray& KVStoreValue(const NDArray& value) {
+  return value;
+}
+
+inline const NDArray& KVStoreValue(const NDArray* value) {
+  return *value;
+}
+
+/*! \brief the key group of an integer key, a range of MXNET_METRICS_KVSTORE_KEY_GROUP_SIZE */
+std::string KVStoreKeyGroup(int key) {
+  static const int group_size =
+      std::max(1, dmlc::GetEnv("MXNET_METRICS_KVSTORE_KEY_GROUP_SIZE", 16));
+  const int first = key / group_size * group_size;
+  return std::to_string(first) + "-" + std::to_string(first + group_size - 1);
+}
+
+/*! \brief the key group of a string key, the part of the name before the first '.' */
+std::string KVStoreKeyGroup(const std::string& key) {
+  return key.substr(0, key.find('.'));
+}
+
+/*!
+ * \brief count the bytes of the values of a kvstore request in the metrics, by store type,
+ *  direction and key group
+ */
+template <typename Key, typename Value>
+void RecordKVStoreBytes(KVStore* kvstore,
+                        const char* direction,
+                        const std::vector<Key>& keys,
+                        const std::vector<Value>& values) {
+  std::unordered_map<std::string, uint64_t> group_bytes;
+  for (size_t i = 0; i < keys.size() && i < values.size(); ++i) {
+    const NDArray& value = KVStoreValue(values[i]);
+    if (value.is_none())
+      continue;
+    group_bytes[KVStoreKeyGroup(keys[i])] +=
+        value.shape().Size() * mshadow::mshadow_sizeof(value.dtype());
+  }
+  for (const auto& group : group_bytes) {
+    profiler::Metrics::Get()
+        ->GetCounter("mxnet_kvstore_bytes",
+                     "Bytes of the values pushed to and pulled from a kvstore.",
+                     {{"store", kvstore->type()}, {"direction", direction}, {"group", group.first}})
+        ->Add(group.second);
+  }
+}
+
+}  // namespace
+
 int MXKVStorePush(KVStoreHandle handle,
                   uint32_t num,
                   const int* keys,
@@ -3156,6 +3478,7 @@ int MXKVStorePush(KVStoreHandle handle,
     v_vals[i] = *static_cast<NDArray*>(vals[i]);
   }
   static_cast<KVStore*>(handle)->Push(v_keys, v_vals, priority);
+  RecordKVStoreBytes(static_cast<KVStore*>(handle), "push", v_keys, v_vals);
   API_END();
 }
 
@@ -3172,6 +3495,7 @@ int MXKVStorePushEx(KVStoreHandle handle,
     v_vals[i] = *static_cast<NDArray*>(vals[i]);
   }
   static_cast<KVStore*>(handle)->Push(v_keys, v_vals, priority);
+  RecordKVStoreBytes(static_cast<KVStore*>(handle), "push", v_keys, v_vals);
   API_END();
 }
 
@@ -3188,6 +3512,7 @@ int MXKVStorePull(KVStoreHandle handle,
     v_vals[i] = static_cast<NDArray*>(vals[i]);
   }
   static_cast<KVStore*>(handle)->Pull(v_keys, v_vals, priority, true);
+  RecordKVStoreBytes(static_cast<KVStore*>(handle), "pull", v_keys, v_vals);
   API_END();
 }
 
@@ -3204,6 +3529,7 @@ int MXKVStorePullEx(KVStoreHandle handle,
     v_vals[i] = static_cast<NDArray*>(vals[i]);
   }
   static_cast<KVStore*>(handle)->Pull(v_keys, v_vals, priority, true);
+  RecordKVStoreBytes(static_cast<KVStore*>(handle), "pull", v_keys, v_vals);
   API_END();
 }
 
@@ -3229,6 +3555,8 @@ int MXKVStoreBroadcast(KVStoreHandle handle,
     v_outs[i]  = static_cast<NDArray*>(outs[i]);
   }
   static_cast<KVStore*>(handle)->Broadcast(v_vkeys, v_okeys, v_vals, v_outs, priority);
+  RecordKVStoreBytes(static_cast<KVStore*>(handle), "push", v_vkeys, v_vals);
+  RecordKVStoreBytes(static_cast<KVStore*>(handle), "pull", v_okeys, v_outs);
   API_END();
 }
 
@@ -3254,6 +3582,8 @@ int MXKVStoreBroadcastEx(KVStoreHandle handle,
     v_outs[i]  = static_cast<NDArray*>(outs[i]);
   }
   static_cast<KVStore*>(handle)->Broadcast(v_vkeys, v_okeys, v_vals, v_outs, priority);
+  RecordKVStoreBytes(static_cast<KVStore*>(handle), "push", v_vkeys, v_vals);
+  RecordKVStoreBytes(static_cast<KVStore*>(handle), "pull", v_okeys, v_outs);
   API_END();
 }
 
@@ -3279,6 +3609,8 @@ int MXKVStorePushPull(KVStoreHandle handle,
     v_outs[i]  = static_cast<NDArray*>(outs[i]);
   }
   static_cast<KVStore*>(handle)->PushPull(v_vkeys, v_okeys, v_vals, v_outs, priority);
+  RecordKVStoreBytes(static_cast<KVStore*>(handle), "push", v_vkeys, v_vals);
+  RecordKVStoreBytes(static_cast<KVStore*>(handle), "pull", v_okeys, v_outs);
   API_END();
 }
 
@@ -3304,6 +3636,8 @@ int MXKVStorePushPullEx(KVStoreHandle handle,
     v_outs[i]  = static_cast<NDArray*>(outs[i]);
   }
   static_cast<KVStore*>(handle)->PushPull(v_vkeys, v_okeys, v_vals, v_outs, priority);
+  RecordKVStoreBytes(static_cast<KVStore*>(handle), "push", v_vkeys, v_vals);
+  RecordKVStoreBytes(static_cast<KVStore*>(handle), "pull", v_okeys, v_outs);
   API_END();
 }
 
@@ -3321,6 +3655,7 @@ int MXKVStorePullWithSparse(KVStoreHandle handle,
     v_vals[i] = static_cast<NDArray*>(vals[i]);
   }
   static_cast<KVStore*>(handle)->Pull(v_keys, v_vals, priority, ignore_sparse);
+  RecordKVStoreBytes(static_cast<KVStore*>(handle), "pull", v_keys, v_vals);
   API_END();
 }
 
@@ -3338,6 +3673,7 @@ int MXKVStorePullWithSparseEx(KVStoreHandle handle,
     v_vals[i] = static_cast<NDArray*>(vals[i]);
   }
   static_cast<KVStore*>(handle)->Pull(v_keys, v_vals, priority, ignore_sparse);
+  RecordKVStoreBytes(static_cast<KVStore*>(handle), "pull", v_keys, v_vals);
   API_END();
 }
 
@@ -3742,23 +4078,45 @@ int MXRtcCudaKernelCall(CudaKernelHandle handle,
   API_END();
 }
 
-int MXNDArrayGetSharedMemHandle(NDArrayHandle handle, int* shared_pid, int* shared_id) {
-  API_BEGIN();
+/*!
+ * \brief Get the shared storage of an NDArray for another process, copying it to shared memory
+ *  when it is not there, and count the reference of the other process.
+ */
+static Storage::Handle ExportSharedMem(NDArrayHandle handle, bool allow_pooled) {
   NDArray* arr = reinterpret_cast<NDArray*>(handle);
-  Storage::Handle shandle;
+  NDArray shared_arr;
   if (arr->ctx().dev_type == Context::kCPUShared) {
-    arr->WaitToRead();
-    shandle = arr->storage_handle();
-    Storage::Get()->SharedIncrementRefCount(shandle);
+    shared_arr = *arr;
   } else {
-    NDArray new_arr(arr->shape(), Context::CPUShared(0), false, arr->dtype());
-    CopyFromTo(*arr, new_arr);
-    new_arr.WaitToRead();
-    shandle = new_arr.storage_handle();
-    Storage::Get()->SharedIncrementRefCount(shandle);
+    shared_arr = NDArray(arr->shape(), Context::CPUShared(0), false, arr->dtype());
+    CopyFromTo(*arr, shared_arr);
   }
-  *shared_pid = shandle.shared_pid;
-  *shared_id  = shandle.shared_id;
+  shared_arr.WaitToRead();
+  Storage::Handle shandle = shared_arr.storage_handle();
+  CHECK(allow_pooled || shandle.shared_offset == 0)
+      << "The NDArray is a block of a pooled shared memory segment, use "
+      << "MXNDArrayGetSharedMemHandleEx or set MXNET_CPU_SHARED_MEM_POOL_SIZE=0";
+  Storage::Get()->SharedIncrementRefCount(shandle);
+  return shandle;
+}
+
+int MXNDArrayGetSharedMemHandle(NDArrayHandle handle, int* shared_pid, int* shared_id) {
+  API_BEGIN();
+  Storage::Handle shandle = ExportSharedMem(handle, false);
+  *shared_pid             = shandle.shared_pid;
+  *shared_id              = shandle.shared_id;
+  API_END();
+}
+
+int MXNDArrayGetSharedMemHandleEx(NDArrayHandle handle,
+                                  int* shared_pid,
+                                  int* shared_id,
+                                  uint64_t* shared_offset) {
+  API_BEGIN();
+  Storage::Handle shandle = ExportSharedMem(handle, true);
+  *shared_pid             = shandle.shared_pid;
+  *shared_id              = shandle.shared_id;
+  *shared_offset          = shandle.shared_offset;
   API_END();
 }
 
@@ -3776,6 +4134,46 @@ int MXNDArrayCreateFromSharedMem(int shared_pid,
   API_END();
 }
 
+int MXNDArrayCreateFromSharedMemEx(int shared_pid,
+                                   int shared_id,
+                                   uint64_t shared_offset,
+                                   const int* shape,
+                                   int ndim,
+                                   int dtype,
+                                   NDArrayHandle* out) {
+  API_BEGIN();
+  NDArray* nd = new NDArray(
+      shared_pid, shared_id, mxnet::TShape(shape, shape + ndim), dtype, shared_offset);
+  nd->AssignStorageInfo(profiler::ProfilerScope::Get()->GetCurrentProfilerScope(),
+                        MXNET_STORAGE_DEFAULT_NAME_CSTR);
+  *out = nd;
+  API_END();
+}
+
+int MXNDArrayGetCudaIpcHandle(NDArrayHandle handle, char* out_handle) {
+  API_BEGIN();
+  storage::GPUIpcStorage::Get()->Export(*static_cast<NDArray*>(handle), out_handle);
+  API_END();
+}
+
+int MXNDArrayReleaseCudaIpcHandle(const char* ipc_handle) {
+  API_BEGIN();
+  storage::GPUIpcStorage::Get()->Release(ipc_handle);
+  API_END();
+}
+
+int MXNDArrayCreateFromCudaIpcHandle(const char* ipc_handle,
+                                     const int* shape,
+                                     int ndim,
+                                     int dtype,
+                                     int dev_id,
+                                     NDArrayHandle* out) {
+  API_BEGIN();
+  *out = new NDArray(storage::GPUIpcStorage::Import(
+      ipc_handle, mxnet::TShape(shape, shape + ndim), dtype, dev_id));
+  API_END();
+}
+
 using VarHandle          = Engine::VarHandle;
 using CallbackOnStart    = Engine::CallbackOnStart;
 using CallbackOnComplete = Engine::CallbackOnComplete;
@@ -3951,6 +4349,38 @@ int MXStorageEmptyCache(int dev_type, int dev_id) {
   API_END();
 }
 
+int MXSyncBatchNormGetNCCLUniqueId(char* unique_id, int* size) {
+  API_BEGIN();
+#if MXNET_USE_NCCL
+  ncclUniqueId id;
+  CHECK_EQ(ncclGetUniqueId(&id), ncclSuccess) << "Failed to create an NCCL unique id";
+  std::memcpy(unique_id, &id, sizeof(id));
+  *size = sizeof(id);
+#else
+  LOG(FATAL) << "Compile with USE_NCCL=1 to have SyncBatchNorm with comm='nccl'.";
+#endif
+  API_END();
+}
+
+int MXSyncBatchNormInitNCCL(const char* unique_id,
+                            int size,
+                            int num_procs,
+                            int proc_rank,
+                            int num_devices,
+                            const int* dev_ids) {
+  API_BEGIN();
+#if MXNET_USE_NCCL
+  ncclUniqueId id;
+  CHECK_EQ(size, static_cast<int>(sizeof(id))) << "Invalid NCCL unique id";
+  std::memcpy(&id, unique_id, sizeof(id));
+  op::syncbatchnorm::NCCLComm::Get()->Init(
+      id, num_procs, proc_rank, std::vector<int>(dev_ids, dev_ids + num_devices));
+#else
+  LOG(FATAL) << "Compile with USE_NCCL=1 to have SyncBatchNorm with comm='nccl'.";
+#endif
+  API_END();
+}
+
 int MXShallowCopyNDArray(NDArrayHandle src_handle, NDArrayHandle* out) {
   NDArray* ret = nullptr;
   API_BEGIN();
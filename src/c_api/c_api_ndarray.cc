@@ -36,6 +36,7 @@
 #include "../common/exec_utils.h"
 #include "../imperative/imperative_utils.h"
 #include "../imperative/cached_op.h"
+#include "../imperative/cached_op_batcher.h"
 #include "../imperative/cached_op_threadsafe.h"
 #include "../profiler/profiler.h"
 
@@ -121,6 +122,9 @@ void MXImperativeInvokeImpl(AtomicSymbolCreator creator,
 
   if (Imperative::Get()->is_deferred_compute()) {
     Imperative::Get()->RecordDeferredCompute(std::move(attrs), ndinputs, ndoutputs);
+  } else if (Imperative::Get()->is_lazy_eval() &&
+             Imperative::Get()->RecordLazyEval(attrs, ndinputs, ndoutputs)) {
+    // computed when the outputs are read
   } else {
     for (NDArray* input : ndinputs) {
       Imperative::DCInfo::Compute(*input);
@@ -244,6 +248,9 @@ int MXInvokeCachedOp(CachedOpHandle handle,
   }
   // construct default context
   Context ctx = Context::Create(static_cast<Context::DeviceType>(default_dev_type), default_dev_id);
+  // the cached op reads the arrays pending lazy evaluation, and may write the arrays they read
+  if (Imperative::Get()->is_lazy_eval())
+    Imperative::Get()->FlushLazyEval();
   op->Forward(op_shared, ndinputs, ndoutputs, ctx);
 
   if (*outputs == nullptr) {
@@ -267,6 +274,114 @@ int MXInvokeCachedOp(CachedOpHandle handle,
   API_END();
 }
 
+int MXInvokeCachedOpDLPack(CachedOpHandle handle,
+                           int num_inputs,
+                           DLManagedTensorHandle* inputs,
+                           int num_outputs,
+                           DLManagedTensorHandle* outputs,
+                           int default_dev_type,
+                           int default_dev_id,
+                           bool wait_to_read) {
+  API_BEGIN();
+  // the arrays own the tensors from here on, and their chunks release them through the engine
+  std::vector<NDArray> bound_inputs, bound_outputs;
+  bound_inputs.reserve(num_inputs);
+  bound_outputs.reserve(num_outputs);
+  for (int i = 0; i < num_inputs; ++i) {
+    bound_inputs.push_back(NDArray::FromDLPack(static_cast<DLManagedTensor*>(inputs[i]), false));
+  }
+  for (int i = 0; i < num_outputs; ++i) {
+    bound_outputs.push_back(NDArray::FromDLPack(static_cast<DLManagedTensor*>(outputs[i]), false));
+  }
+  CachedOpPtr op_shared = *static_cast<CachedOpPtr*>(handle);
+  CachedOp* op          = dynamic_cast<CachedOp*>(op_shared.get());
+  CHECK_EQ(num_outputs, op->num_outputs()) << "CachedOp expects " << op->num_outputs()
+                                           << " outputs, but " << num_outputs << " was given.";
+  std::vector<NDArray*> ndinputs, ndoutputs;
+  ndinputs.reserve(num_inputs);
+  for (auto& arr : bound_inputs) {
+    ndinputs.push_back(&arr);
+  }
+  // the forward may rebind an output which aliases an input or another output
+  std::vector<NDArray> results(bound_outputs);
+  ndoutputs.reserve(num_outputs);
+  for (auto& arr : results) {
+    ndoutputs.push_back(&arr);
+  }
+  Context ctx = Context::Create(static_cast<Context::DeviceType>(default_dev_type), default_dev_id);
+  op->Forward(op_shared, ndinputs, ndoutputs, ctx);
+  for (int i = 0; i < num_outputs; ++i) {
+    if (!results[i].IsSame(bound_outputs[i])) {
+      CopyFromTo(results[i], &bound_outputs[i]);
+    }
+    if (wait_to_read) {
+      bound_outputs[i].WaitToRead();
+    }
+  }
+  API_END();
+}
+
+int MXCachedOpBatcherCreate(SymbolHandle symbol,
+                            int num_flags,
+                            const char** keys,
+                            const char** vals,
+                            int num_params,
+                            NDArrayHandle* params,
+                            int dev_type,
+                            int dev_id,
+                            CachedOpBatcherHandle* out) {
+  nnvm::Symbol* sym = static_cast<nnvm::Symbol*>(symbol);
+  API_BEGIN();
+  std::vector<std::pair<std::string, std::string> > flags;
+  flags.reserve(num_flags);
+  for (int i = 0; i < num_flags; ++i) {
+    flags.emplace_back(keys[i], vals[i]);
+  }
+  std::vector<NDArray> ndparams;
+  ndparams.reserve(num_params);
+  for (int i = 0; i < num_params; ++i) {
+    ndparams.push_back(*reinterpret_cast<NDArray*>(params[i]));
+  }
+  Context ctx = Context::Create(static_cast<Context::DeviceType>(dev_type), dev_id);
+  *out        = new CachedOpBatcher(*sym, flags, ndparams, ctx);
+  API_END();
+}
+
+int MXCachedOpBatcherSubmit(CachedOpBatcherHandle handle,
+                            int num_inputs,
+                            NDArrayHandle* inputs,
+                            CachedOpBatcherCallback callback,
+                            void* callback_handle) {
+  API_BEGIN();
+  std::vector<NDArray> ndinputs;
+  ndinputs.reserve(num_inputs);
+  for (int i = 0; i < num_inputs; ++i) {
+    ndinputs.push_back(*reinterpret_cast<NDArray*>(inputs[i]));
+  }
+  static_cast<CachedOpBatcher*>(handle)->Submit(
+      ndinputs,
+      [callback, callback_handle](const std::vector<NDArray>& outputs, const std::string& error) {
+        if (!error.empty()) {
+          callback(0, nullptr, error.c_str(), callback_handle);
+          return;
+        }
+        std::vector<NDArrayHandle> handles;
+        handles.reserve(outputs.size());
+        for (const auto& output : outputs) {
+          handles.push_back(new NDArray(output));
+        }
+        const int num_outputs = static_cast<int>(handles.size());
+        callback(num_outputs, dmlc::BeginPtr(handles), nullptr, callback_handle);
+      });
+  API_END();
+}
+
+int MXCachedOpBatcherFree(CachedOpBatcherHandle handle) {
+  API_BEGIN();
+  delete static_cast<CachedOpBatcher*>(handle);
+  API_END();
+}
+
 int MXAutogradIsTraining(bool* curr) {
   API_BEGIN();
   *curr = Imperative::Get()->is_training();
@@ -467,6 +582,18 @@ int MXNDArraySetIsDeferredCompute(int deferred_compute, int* prev) {
   API_END();
 }
 
+int MXNDArrayIsLazyEvaluation(int* curr) {
+  API_BEGIN();
+  *curr = Imperative::Get()->is_lazy_eval();
+  API_END();
+}
+
+int MXNDArraySetIsLazyEvaluation(int lazy_eval, int* prev) {
+  API_BEGIN();
+  *prev = Imperative::Get()->set_is_lazy_eval(static_cast<bool>(lazy_eval));
+  API_END();
+}
+
 int MXNDArraySetDeferredComputeVariable(NDArrayHandle* arrays, SymbolHandle* variables, int num) {
   API_BEGIN();
   Imperative::Get()->SetDeferredComputeVariable(arrays, variables, num);
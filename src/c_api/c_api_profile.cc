@@ -32,7 +32,10 @@
 #include <stack>
 #include "./c_api_common.h"
 #include "../profiler/storage_profiler.h"
+#include "../profiler/metrics.h"
 #include "../profiler/profiler.h"
+#include "../profiler/request_trace.h"
+#include "../profiler/sampling_profiler.h"
 
 namespace mxnet {
 
@@ -172,6 +175,8 @@ struct ProfileConfigParam : public dmlc::Parameter<ProfileConfigParam> {
   bool continuous_dump;
   float dump_period;
   bool aggregate_stats;
+  bool profile_dependencies;
+  bool profile_hw_counters;
   int profile_process;
   DMLC_DECLARE_PARAMETER(ProfileConfigParam) {
     DMLC_DECLARE_FIELD(profile_all).set_default(false).describe("Profile all. Default is False.");
@@ -208,6 +213,17 @@ struct ProfileConfigParam : public dmlc::Parameter<ProfileConfigParam> {
         .describe(
             "Maintain aggregate stats, required for MXDumpAggregateStats.  Note that "
             "this can have a negative performance impact. Default is False.");
+    DMLC_DECLARE_FIELD(profile_dependencies)
+        .set_default(false)
+        .describe(
+            "Record the engine variables each profiled operator reads and writes, for the "
+            "critical path analysis of tools/profile/critical_path.py. Default is False.");
+    DMLC_DECLARE_FIELD(profile_hw_counters)
+        .set_default(false)
+        .describe(
+            "Sample the hardware counters of each operator execution into the aggregate stats: "
+            "perf_event counters of the CPU thread and CUPTI kernel activity on GPUs. "
+            "Requires aggregate_stats and makes GPU operators synchronous. Default is False.");
     DMLC_DECLARE_FIELD(profile_process)
         .add_enum("worker", static_cast<int>(ProfileProcess::kWorker))
         .add_enum("server", static_cast<int>(ProfileProcess::kServer))
@@ -283,7 +299,9 @@ int MXSetProcessProfilerConfig(int num_params,
                                          std::string(param.filename),
                                          param.continuous_dump,
                                          param.dump_period,
-                                         param.aggregate_stats);
+                                         param.aggregate_stats,
+                                         param.profile_dependencies,
+                                         param.profile_hw_counters);
 #if MXNET_USE_CUDA
     profiler::GpuDeviceStorageProfiler::Get()->SetConfig(param.gpu_memory_profile_filename_prefix);
 #endif  // MXNET_USE_CUDA
@@ -325,6 +343,70 @@ int MXAggregateProfileStatsPrint(const char** out_str,
   API_END();
 }
 
+int MXSetProfilerSampleRate(int rate) {
+  API_BEGIN();
+  CHECK_GE(rate, 0) << "The sample rate must be non-negative";
+  profiler::SamplingProfiler::Get()->SetSampleRate(static_cast<uint32_t>(rate));
+  API_END();
+}
+
+int MXSampledProfileStatsPrint(const char** out_str, int reset) {
+  MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+  API_BEGIN();
+  CHECK_NOTNULL(out_str);
+  std::ostringstream os;
+  profiler::SamplingProfiler::Get()->DumpJson(os, reset != 0);
+  ret->ret_str = os.str();
+  *out_str     = (ret->ret_str).c_str();
+  API_END();
+}
+
+int MXMemoryPeakSnapshotPrint(const char** out_str, int reset) {
+  MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+  API_BEGIN();
+  CHECK_NOTNULL(out_str);
+  std::ostringstream os;
+  profiler::MemoryTimeline::Get()->DumpPeak(os, reset != 0);
+  ret->ret_str = os.str();
+  *out_str     = (ret->ret_str).c_str();
+  API_END();
+}
+
+int MXRequestTraceBegin(const char* name, const char* trace_id) {
+  API_BEGIN();
+  CHECK_NOTNULL(name);
+  profiler::RequestTracer::Get()->Begin(name, trace_id ? trace_id : "");
+  API_END();
+}
+
+int MXRequestTraceEnd() {
+  API_BEGIN();
+  profiler::RequestTracer::Get()->End();
+  API_END();
+}
+
+int MXRequestTraceDump(const char** out_str, int reset) {
+  MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+  API_BEGIN();
+  CHECK_NOTNULL(out_str);
+  std::ostringstream os;
+  profiler::RequestTracer::Get()->DumpJson(os, reset != 0);
+  ret->ret_str = os.str();
+  *out_str     = (ret->ret_str).c_str();
+  API_END();
+}
+
+int MXGetMetrics(const char** out_str) {
+  MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+  API_BEGIN();
+  CHECK_NOTNULL(out_str);
+  std::ostringstream os;
+  profiler::Metrics::Get()->WriteOpenMetrics(os);
+  ret->ret_str = os.str();
+  *out_str     = (ret->ret_str).c_str();
+  API_END();
+}
+
 int MXDumpProfile(int finished) {
   return MXDumpProcessProfile(finished, static_cast<int>(ProfileProcess::kWorker), nullptr);
 }
@@ -33,6 +33,7 @@
 #include "../operator/operator_common.h"
 #include "../imperative/exec_pass.h"
 #include "../operator/subgraph/subgraph_property.h"
+#include "../initialize.h"
 
 namespace mxnet {
 namespace op {
@@ -79,12 +80,14 @@ std::vector<uint32_t> ReadOnlyArgIndices(const nnvm::IndexedGraph& idx) {
 // symbolic configuration generation API.
 // Redirect to NNVM's C API
 int MXListAllOpNames(nn_uint* out_size, const char*** out_array) {
+  mxnet::LibraryInitializer::Get()->record_library_loaded();
   mxnet::op::RegisterLegacyOpProp();
   mxnet::op::RegisterLegacyNDFunc();
   return NNListAllOpNames(out_size, out_array);
 }
 
 int MXSymbolListAtomicSymbolCreators(uint32_t* out_size, AtomicSymbolCreator** out_array) {
+  mxnet::LibraryInitializer::Get()->record_library_loaded();
   mxnet::op::RegisterLegacyOpProp();
   mxnet::op::RegisterLegacyNDFunc();
   return NNListUniqueOps(out_size, out_array);
@@ -948,6 +951,16 @@ int MXQuantizeSymbol(SymbolHandle sym_handle,
   std::string quantized_type(quantized_dtype);
   std::string quantized_mode(quantize_mode);
   std::string quantized_granularity(quantize_granularity);
+  // group-wise:<size>, the number of input features of the weights sharing a scale
+  int weight_group_size = 0;
+  const size_t size_pos = quantized_granularity.find(':');
+  if (size_pos != std::string::npos) {
+    weight_group_size     = std::stoi(quantized_granularity.substr(size_pos + 1));
+    quantized_granularity = quantized_granularity.substr(0, size_pos);
+    CHECK_EQ(quantized_granularity, "group-wise")
+        << "Only the group-wise quantize granularity takes a group size";
+    CHECK_GT(weight_group_size, 0) << "Invalid weight group size " << weight_group_size;
+  }
   g.attrs["excluded_nodes"]       = std::make_shared<nnvm::any>(std::move(excluded_node_names));
   g.attrs["excluded_ops"]         = std::make_shared<nnvm::any>(std::move(excluded_op));
   g.attrs["offline_params"]       = std::make_shared<nnvm::any>(std::move(offline));
@@ -955,6 +968,7 @@ int MXQuantizeSymbol(SymbolHandle sym_handle,
   g.attrs["target_ctx"]           = std::make_shared<nnvm::any>(target_dev);
   g.attrs["quantize_mode"]        = std::make_shared<nnvm::any>(std::move(quantized_mode));
   g.attrs["quantize_granularity"] = std::make_shared<nnvm::any>(std::move(quantized_granularity));
+  g.attrs["weight_group_size"]    = std::make_shared<nnvm::any>(weight_group_size);
   g                               = ApplyPass(std::move(g), "QuantizeGraph");
   const auto& calib_nodes         = g.GetAttr<std::vector<std::string>>("calib_nodes");
   MXAPIThreadLocalEntry<>* ret    = MXAPIThreadLocalStore<>::Get();
@@ -1058,6 +1072,9 @@ int MXGenBackendSubgraph(SymbolHandle sym_handle,
   *s                = sym->Copy();
   auto backend      = mxnet::op::SubgraphBackendRegistry::Get()->GetSubgraphBackend(backend_name);
   const auto& subgraph_prop_list = backend->GetSubgraphProperties();
+  nnvm::Graph g;
+  // the graph left by a property which changed nothing is kept with its indexed graph
+  bool reuse_graph = false;
   for (auto property : subgraph_prop_list) {
     if (property->HasAttr("disable") && property->GetAttr<bool>("disable") == true) {
       auto full_name = property->HasAttr("property_name") ?
@@ -1067,14 +1084,16 @@ int MXGenBackendSubgraph(SymbolHandle sym_handle,
                 << " is disabled.";
       continue;
     }
-    nnvm::Graph g = Symbol2Graph(*s);
+    if (!reuse_graph)
+      g = Symbol2Graph(*s);
     property->SetAttr("graph", g);
     g.attrs["subgraph_property"] = std::make_shared<nnvm::any>(property);
     g                            = ApplyPass(std::move(g), "EliminateCommonNodesPass");
     g                            = ApplyPass(std::move(g), "BuildSubgraph");
     property->RemoveAttr("graph");
     g.attrs.erase("subgraph_property");
-    s->outputs = g.outputs;
+    s->outputs  = g.outputs;
+    reuse_graph = g.GetAttr<size_t>("subgraph_num_changed") == 0;
   }
   *ret_sym_handle = s;
   API_END_HANDLE_ERROR(delete s);
@@ -1272,6 +1291,10 @@ int MXOptimizeForBackend(SymbolHandle sym_handle,
     const auto backend =
         mxnet::op::SubgraphBackendRegistry ::Get()->GetSubgraphBackend(backend_name);
     const auto& subgraph_prop_list = backend->GetSubgraphProperties();
+    nnvm::Graph g;
+    // the graph left by a property which changed nothing is kept with its indexed graph and
+    // inferred shapes and types, instead of being built and inferred again for the next one
+    bool reuse_graph = false;
     for (auto property : subgraph_prop_list) {
       if (property->HasAttr("disable") && property->GetAttr<bool>("disable") == true) {
         auto full_name = property->HasAttr("property_name") ?
@@ -1281,13 +1304,15 @@ int MXOptimizeForBackend(SymbolHandle sym_handle,
                   << " is disabled.";
         continue;
       }
-      nnvm::Graph g = init_graph(s);
+      if (!reuse_graph)
+        g = init_graph(s);
       property->PrePartition(g, options_map);
       g.attrs["subgraph_property"] = std::make_shared<nnvm::any>(property);
       g                            = ApplyPass(std::move(g), "BuildSubgraph");
       g.attrs.erase("subgraph_property");
       property->PostPartition(g);
-      s->outputs = g.outputs;
+      s->outputs  = g.outputs;
+      reuse_graph = g.GetAttr<size_t>("subgraph_num_changed") == 0;
     }
   } else if (dmlc::Registry<nnvm::PassFunctionReg>::Find(backend_name) != nullptr) {
     // use graph pass
@@ -205,5 +205,20 @@ Transpose FactorCommonTranspose(std::vector<Transpose>* axes) {
   return ret;
 }
 
+Transpose FactorCommonTransposeAll(std::vector<Transpose>* axes) {
+  std::vector<bool> pending(axes->size());
+  for (size_t i = 0; i < axes->size(); ++i)
+    pending[i] = !IsIdentity(axes->at(i));
+  Transpose ret = FactorCommonTranspose(axes);
+  if (IsIdentity(ret))
+    return ret;
+  const Transpose rev = Reverse(ret);
+  for (size_t i = 0; i < axes->size(); ++i) {
+    if (!pending[i])
+      axes->at(i) = rev;
+  }
+  return ret;
+}
+
 }  // namespace alm
 }  // namespace mxnet
@@ -94,6 +94,12 @@ using FChangeLayout = std::function<bool(nnvm::NodeAttrs*,
  */
 Transpose FactorCommonTranspose(std::vector<Transpose>* axes);
 
+/*!
+ * \brief Like FactorCommonTranspose, for inputs of the same rank which all take the common
+ * transpose: the inputs without pending transpose get the reverse of the common one.
+ */
+Transpose FactorCommonTransposeAll(std::vector<Transpose>* axes);
+
 }  // namespace alm
 }  // namespace mxnet
 
@@ -23,7 +23,10 @@
 
 #include <nvrtc.h>
 
+#include <cstdint>
+#include <cstdio>
 #include <mutex>
+#include <random>
 #include <string>
 #include <fstream>
 #include <unordered_map>
@@ -31,6 +34,10 @@
 #include <tuple>
 #include <algorithm>
 
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+
 #include "rtc.h"
 #include "../../initialize.h"
 #include "rtc/half-inl.h"
@@ -161,6 +168,107 @@ std::tuple<bool, std::string> GetArchString(const int sm_arch) {
   }
 }
 
+/*! \brief 64-bit FNV-1a hash, unlike std::hash it is the same in every process */
+uint64_t StableHash(const std::string& s, uint64_t hash = 0xcbf29ce484222325ULL) {
+  for (const unsigned char c : s) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+/*! \brief compiled kernel in the persistent cache of MXNET_RTC_CACHE_DIR */
+struct DiskCacheEntry {
+  /*! \brief file of the kernel, empty if the persistent cache is disabled */
+  std::string path;
+  /*! \brief second hash of the key, guards against collisions of file names */
+  uint64_t check;
+};
+
+constexpr char kDiskCacheMagic[8] = "MXRTC01";
+
+/*!
+ * \brief Locate the cached kernel compiled from the given source with the given options.
+ *  The key covers the full source, the options, the target architecture and the NVRTC
+ *  version, so the cache can be shared by processes running different kernels or GPUs.
+ */
+DiskCacheEntry GetDiskCacheEntry(const std::string& source,
+                                 const std::string& kernel_name,
+                                 const std::vector<const char*>& opts) {
+  const std::string dir = dmlc::GetEnv("MXNET_RTC_CACHE_DIR", std::string());
+  if (dir.empty())
+    return {std::string(), 0};
+#if !defined(_WIN32)
+  mkdir(dir.c_str(), 0755);
+#endif
+  int major, minor;
+  NVRTC_CALL(nvrtcVersion(&major, &minor));
+  std::string key = std::to_string(major) + "." + std::to_string(minor) + "\n" + kernel_name;
+  for (const char* opt : opts)
+    key += std::string("\n") + opt;
+  key += "\n" + source;
+  char name[17];
+  snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(StableHash(key)));
+  return {dir + "/" + name + ".rtc", StableHash(key, 0x84222325cbf29ce4ULL)};
+}
+
+/*! \brief Read a kernel from the persistent cache, returns false if it is missing or invalid */
+bool LoadFromDiskCache(const DiskCacheEntry& entry,
+                       std::string* compiled_code,
+                       std::string* mangled_name) {
+  std::ifstream f(entry.path, std::ios::binary);
+  if (!f)
+    return false;
+  char magic[sizeof(kDiskCacheMagic)];
+  uint64_t check = 0, name_size = 0, code_size = 0;
+  f.read(magic, sizeof(magic));
+  f.read(reinterpret_cast<char*>(&check), sizeof(check));
+  f.read(reinterpret_cast<char*>(&name_size), sizeof(name_size));
+  if (!f || std::string(magic) != kDiskCacheMagic || check != entry.check)
+    return false;
+  std::string name(name_size, '\0');
+  f.read(&name[0], name_size);
+  f.read(reinterpret_cast<char*>(&code_size), sizeof(code_size));
+  if (!f)
+    return false;
+  std::string code(code_size, '\0');
+  f.read(&code[0], code_size);
+  if (!f)
+    return false;
+  *mangled_name  = std::move(name);
+  *compiled_code = std::move(code);
+  return true;
+}
+
+/*!
+ * \brief Write a kernel to the persistent cache. The file is written under a temporary
+ *  name and renamed, so concurrent processes never read a partial kernel.
+ */
+void StoreToDiskCache(const DiskCacheEntry& entry,
+                      const std::string& compiled_code,
+                      const std::string& mangled_name) {
+  const std::string tmp_path = entry.path + ".tmp" + std::to_string(std::random_device()());
+  {
+    std::ofstream f(tmp_path, std::ios::binary);
+    const uint64_t name_size = mangled_name.size();
+    const uint64_t code_size = compiled_code.size();
+    f.write(kDiskCacheMagic, sizeof(kDiskCacheMagic));
+    f.write(reinterpret_cast<const char*>(&entry.check), sizeof(entry.check));
+    f.write(reinterpret_cast<const char*>(&name_size), sizeof(name_size));
+    f.write(mangled_name.data(), name_size);
+    f.write(reinterpret_cast<const char*>(&code_size), sizeof(code_size));
+    f.write(compiled_code.data(), code_size);
+    if (!f) {
+      LOG(WARNING) << "Could not write the compiled kernel to " << entry.path;
+      f.close();
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), entry.path.c_str()) != 0)
+    std::remove(tmp_path.c_str());
+}
+
 }  // namespace
 
 CUfunction get_function(const std::string& parameters,
@@ -205,16 +313,9 @@ CUfunction get_function(const std::string& parameters,
                    << CACHESIZE_WARN_THRESHOLD
                    << ".  Set MXNET_RTC_SIZE_WARNING=0 to quiet this warning.";
     }
-    nvrtcProgram program;
-    NVRTC_CALL(nvrtcCreateProgram(&program,                              // prog
-                                  &code_with_header[0],                  // buffer
-                                  (kernel_name + "_kernel.cu").c_str(),  // name
-                                  0,                                     // num headers
-                                  nullptr,                               // headers
-                                  nullptr));                             // include names
-    const auto [use_cubin, gpu_arch] = GetArchString(sm_arch);           // NOLINT(*)
-    std::string gpu_arch_arg         = "--gpu-architecture=" + gpu_arch;
-    const char* opts[]               = {
+    const auto [use_cubin, gpu_arch]    = GetArchString(sm_arch);  // NOLINT(*)
+    std::string gpu_arch_arg            = "--gpu-architecture=" + gpu_arch;
+    const std::vector<const char*> opts = {
       gpu_arch_arg.c_str(),
 #if NDEBUG == 0
       "-G",
@@ -222,28 +323,42 @@ CUfunction get_function(const std::string& parameters,
       "--std=c++14"
     };
     const std::string& kernel_name_demangled = kernel_name;
-    NVRTC_CALL(nvrtcAddNameExpression(program, (kernel_name_demangled).c_str()));
-
-    nvrtcResult compileResult          = nvrtcCompileProgram(program,  // prog
-                                                    sizeof(opts) / sizeof(opts[0]),  // num options
-                                                    opts);  // options
-    static const std::string dump_file = "mxnet_rtc_debug_code.log";
-    if (compileResult != NVRTC_SUCCESS) {
-      std::ofstream f(dump_file);
-      f << code_with_header;
-      f.close();
+
+    const DiskCacheEntry cache_entry = GetDiskCacheEntry(code_with_header, kernel_name, opts);
+    if (cache_entry.path.empty() ||
+        !LoadFromDiskCache(cache_entry, &kinfo.ptx, &kinfo.mangled_name)) {
+      nvrtcProgram program;
+      NVRTC_CALL(nvrtcCreateProgram(&program,                              // prog
+                                    &code_with_header[0],                  // buffer
+                                    (kernel_name + "_kernel.cu").c_str(),  // name
+                                    0,                                     // num headers
+                                    nullptr,                               // headers
+                                    nullptr));                             // include names
+      NVRTC_CALL(nvrtcAddNameExpression(program, (kernel_name_demangled).c_str()));
+
+      nvrtcResult compileResult          = nvrtcCompileProgram(program,       // prog
+                                                      opts.size(),   // num options
+                                                      opts.data());  // options
+      static const std::string dump_file = "mxnet_rtc_debug_code.log";
+      if (compileResult != NVRTC_SUCCESS) {
+        std::ofstream f(dump_file);
+        f << code_with_header;
+        f.close();
+      }
+      CHECK_EQ(compileResult, NVRTC_SUCCESS)
+          << "NVRTC Compilation failed.\n"
+          << "The generated code was stored in " << dump_file << "\n"
+          << GetCompileLog(program);
+
+      kinfo.ptx = GetCompiledCode(program, use_cubin);
+      const char* mangled_name;
+      NVRTC_CALL(nvrtcGetLoweredName(program, kernel_name_demangled.c_str(), &mangled_name));
+      kinfo.mangled_name = mangled_name;
+      // Destroy the program.
+      NVRTC_CALL(nvrtcDestroyProgram(&program));
+      if (!cache_entry.path.empty())
+        StoreToDiskCache(cache_entry, kinfo.ptx, kinfo.mangled_name);
     }
-    CHECK_EQ(compileResult, NVRTC_SUCCESS)
-        << "NVRTC Compilation failed.\n"
-        << "The generated code was stored in " << dump_file << "\n"
-        << GetCompileLog(program);
-
-    kinfo.ptx = GetCompiledCode(program, use_cubin);
-    const char* mangled_name;
-    NVRTC_CALL(nvrtcGetLoweredName(program, kernel_name_demangled.c_str(), &mangled_name));
-    kinfo.mangled_name = mangled_name;
-    // Destroy the program.
-    NVRTC_CALL(nvrtcDestroyProgram(&program));
   }
   // Ensure function array is deep enough to index by dev_id
   while (kinfo.functions.size() <= static_cast<size_t>(dev_id))
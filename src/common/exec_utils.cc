@@ -23,6 +23,9 @@
  */
 
 #include "exec_utils.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
 #include <unordered_set>
 #include <unordered_map>
 #include <string>
@@ -75,5 +78,68 @@ bool CheckForInputNameDuplicates(const nnvm::IndexedGraph& idx) {
   return true;
 }
 
+StorageFallbackAudit* StorageFallbackAudit::Get() {
+  static StorageFallbackAudit inst;
+  return &inst;
+}
+
+StorageFallbackAudit::StorageFallbackAudit()
+    : enabled_(dmlc::GetEnv("MXNET_STORAGE_FALLBACK_AUDIT", false)),
+      print_at_exit_(enabled_.load()) {}
+
+StorageFallbackAudit::~StorageFallbackAudit() {
+  if (print_at_exit_ && !entries_.empty())
+    LOG(INFO) << "\n" << Dump(false);
+}
+
+void StorageFallbackAudit::Record(const nnvm::NodeAttrs& attrs,
+                                  const NDArray& src,
+                                  const NDArray& dst) {
+  const auto layout = [](const NDArray& nd) {
+#if MXNET_USE_ONEDNN == 1
+    // oneDNN arrays fall back by a reorder to the default layout
+    if (nd.IsDNNLData())
+      return std::string("dnnl");
+#endif
+    return stype_string(nd.storage_type());
+  };
+  std::array<std::string, 3> key = {attrs.op != nullptr ? attrs.op->name : attrs.name,
+                                    layout(src) + " -> " + layout(dst),
+                                    src.ctx().dev_mask() == gpu::kDevMask ? "gpu" : "cpu"};
+  const uint64_t bytes = src.shape().Size() * mshadow::mshadow_sizeof(src.dtype());
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry& entry = entries_[key];
+  entry.count += 1;
+  entry.bytes += bytes;
+}
+
+std::string StorageFallbackAudit::Dump(bool reset) {
+  std::vector<std::pair<std::array<std::string, 3>, Entry>> entries;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries.assign(entries_.begin(), entries_.end());
+    if (reset)
+      entries_.clear();
+  }
+  std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+    return a.second.bytes > b.second.bytes;
+  });
+  size_t op_width = 8;
+  for (const auto& e : entries)
+    op_width = std::max(op_width, e.first[0].size());
+  std::ostringstream os;
+  os << "Storage Fallback Audit\n"
+     << "======================\n"
+     << std::left << std::setw(op_width + 2) << "Operator" << std::setw(28) << "Conversion"
+     << std::setw(8) << "Device" << std::right << std::setw(12) << "Count" << std::setw(20)
+     << "Bytes" << "\n";
+  for (const auto& e : entries) {
+    os << std::left << std::setw(op_width + 2) << e.first[0] << std::setw(28) << e.first[1]
+       << std::setw(8) << e.first[2] << std::right << std::setw(12) << e.second.count
+       << std::setw(20) << e.second.bytes << "\n";
+  }
+  return os.str();
+}
+
 }  // namespace common
 }  // namespace mxnet
@@ -26,7 +26,10 @@
 
 #include <nnvm/graph.h>
 #include <nnvm/pass_functions.h>
+#include <array>
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <vector>
 #include <string>
 #include <utility>
@@ -162,19 +165,60 @@ inline void SetupDefaultBlobsInOut(const std::vector<NDArray>& ndinputs,
   }
 }
 
+/*!
+ * \brief Audit of the storage fallbacks: counts the conversions between storage types made
+ *        around the operators running without a kernel for their storage types, and the bytes
+ *        of the dense arrays converted. Enabled by MXNET_STORAGE_FALLBACK_AUDIT, which also
+ *        prints the audit at exit, or through MXSetStorageFallbackAudit.
+ */
+class StorageFallbackAudit {
+ public:
+  static StorageFallbackAudit* Get();
+  bool enabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+  /*! \brief enables or disables the audit, returns whether it was enabled */
+  bool set_enabled(bool enabled) {
+    return enabled_.exchange(enabled);
+  }
+  /*! \brief records the cast of src into dst around the operator */
+  void Record(const nnvm::NodeAttrs& attrs, const NDArray& src, const NDArray& dst);
+  /*! \brief prints the conversions recorded per operator, by decreasing bytes */
+  std::string Dump(bool reset);
+
+ private:
+  StorageFallbackAudit();
+  ~StorageFallbackAudit();
+
+  struct Entry {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+  };
+  std::atomic<bool> enabled_;
+  bool print_at_exit_;
+  std::mutex mutex_;
+  // entries by operator, conversion and device
+  std::map<std::array<std::string, 3>, Entry> entries_;
+};
+
 /*
  * \brief cast the NDArrays in `src` and store the result in NDArrays in `dst`.
  *        This is only used for storage fallback in executor.
  * \param src list of source NDArray to cast
  * \param dst list of destionation NDArray which hold the result of cast_storage operation
  * \param ctx operator context for cast_storage operation
+ * \param attrs the operator falling back, recorded by the storage fallback audit
  */
 inline void CastNonDefaultStorage(const std::vector<NDArray>& src,
                                   const std::vector<NDArray>& dst,
                                   const OpContext& ctx,
-                                  const bool is_gpu) {
+                                  const bool is_gpu,
+                                  const nnvm::NodeAttrs* attrs = nullptr) {
   CHECK_EQ(dst.size(), src.size());
+  StorageFallbackAudit* audit = attrs != nullptr ? StorageFallbackAudit::Get() : nullptr;
   for (size_t i = 0; i < src.size(); i++) {
+    if (audit != nullptr && audit->enabled())
+      audit->Record(*attrs, src[i], dst[i]);
     if (is_gpu) {
 #if MXNET_USE_CUDA
       CastStorageDispatch<gpu>(ctx, src[i], dst[i]);
@@ -0,0 +1,163 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file numa.cc
+ * \brief NUMA helpers, implemented with raw Linux syscalls so that no libnuma is needed.
+ */
+#include "./numa.h"
+
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <cerrno>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace mxnet {
+namespace common {
+
+namespace {
+
+/*! \brief parse a kernel cpu/node list such as "0-3,8-11" */
+std::vector<int> ParseRangeList(const std::string& list) {
+  std::vector<int> ret;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (item.empty() || item == "\n")
+      continue;
+    const auto dash = item.find('-');
+    const int first = std::stoi(item.substr(0, dash));
+    const int last  = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+    for (int i = first; i <= last; ++i) {
+      ret.push_back(i);
+    }
+  }
+  return ret;
+}
+
+bool ReadFirstLine(const std::string& path, std::string* line) {
+  std::ifstream in(path);
+  return in.good() && std::getline(in, *line) && !line->empty();
+}
+
+}  // namespace
+
+NumaTopology::NumaTopology() {
+#if defined(__linux__)
+  std::string online;
+  if (ReadFirstLine("/sys/devices/system/node/online", &online)) {
+    for (int node : ParseRangeList(online)) {
+      if (node >= static_cast<int>(node_cpus_.size()))
+        node_cpus_.resize(node + 1);
+      std::string cpulist;
+      const std::string path =
+          "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+      if (ReadFirstLine(path, &cpulist)) {
+        node_cpus_[node] = ParseRangeList(cpulist);
+      }
+    }
+  }
+#endif
+  if (node_cpus_.empty())
+    node_cpus_.resize(1);
+  enabled_ = dmlc::GetEnv("MXNET_CPU_NUMA", false) && node_cpus_.size() > 1;
+  if (dmlc::GetEnv("MXNET_CPU_NUMA", false) && !enabled_) {
+    LOG(INFO) << "MXNET_CPU_NUMA is set but only one NUMA node was found, ignoring it";
+  }
+}
+
+const NumaTopology* NumaTopology::Get() {
+  static NumaTopology inst;
+  return &inst;
+}
+
+const std::vector<int>& NumaTopology::cpus(int node) const {
+  static const std::vector<int> empty;
+  return node >= 0 && node < num_nodes() ? node_cpus_[node] : empty;
+}
+
+int NumaTopology::NodeOfDevice(int dev_id) const {
+  if (!enabled_ || dev_id < 0)
+    return -1;
+  return dev_id % num_nodes();
+}
+
+void NumaBindMemory(void* ptr, size_t size, int node) {
+#if defined(__linux__) && defined(SYS_mbind)
+  const NumaTopology* topo = NumaTopology::Get();
+  if (!topo->enabled() || node < 0 || node >= topo->num_nodes())
+    return;
+  // only whole pages can be bound, the partial ones at the edges keep the default policy
+  const uintptr_t page  = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  const uintptr_t begin = (reinterpret_cast<uintptr_t>(ptr) + page - 1) & ~(page - 1);
+  const uintptr_t end   = (reinterpret_cast<uintptr_t>(ptr) + size) & ~(page - 1);
+  if (end <= begin)
+    return;
+  constexpr int kMPolBind      = 2;
+  constexpr unsigned kMPolMove = 1 << 1;
+  std::vector<unsigned long> mask(node / (8 * sizeof(unsigned long)) + 1, 0);  // NOLINT(*)
+  mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+  if (syscall(SYS_mbind,
+              reinterpret_cast<void*>(begin),
+              end - begin,
+              kMPolBind,
+              mask.data(),
+              mask.size() * 8 * sizeof(unsigned long) + 1,
+              kMPolMove) != 0) {
+    static bool warned = false;
+    LOG_IF(WARNING, !warned) << "mbind to NUMA node " << node << " failed, errno " << errno;
+    warned = true;
+  }
+#endif
+}
+
+void PinCurrentThreadToCPUs(const std::vector<int>& cpus) {
+#if defined(__linux__)
+  if (cpus.empty())
+    return;
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (int cpu : cpus) {
+    CPU_SET(cpu, &cpuset);
+  }
+  const int err = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+  LOG_IF(WARNING, err != 0) << "Failed to pin thread to " << cpus.size() << " CPUs, error "
+                            << err;
+#endif
+}
+
+void NumaPinCurrentThread(int node) {
+  const NumaTopology* topo = NumaTopology::Get();
+  if (!topo->enabled() || node < 0)
+    return;
+  PinCurrentThreadToCPUs(topo->cpus(node));
+}
+
+}  // namespace common
+}  // namespace mxnet
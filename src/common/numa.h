@@ -0,0 +1,87 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file numa.h
+ * \brief NUMA topology discovery, memory binding and thread pinning.
+ *
+ *  When MXNET_CPU_NUMA=1, the device id of a CPU context selects a NUMA node:
+ *  memory of mx.cpu(n) is bound to node n and the engine workers of mx.cpu(n)
+ *  are pinned to the cores of node n. Without the variable, or on platforms
+ *  without NUMA support, all functions are no-ops.
+ */
+#ifndef MXNET_COMMON_NUMA_H_
+#define MXNET_COMMON_NUMA_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace mxnet {
+namespace common {
+
+/*!
+ * \brief NUMA nodes of the machine and the CPUs belonging to each of them.
+ */
+class NumaTopology {
+ public:
+  /*! \return the singleton topology, read once from the system */
+  static const NumaTopology* Get();
+  /*! \return whether MXNET_CPU_NUMA is set and the system has more than one node */
+  bool enabled() const {
+    return enabled_;
+  }
+  /*! \return number of NUMA nodes, at least 1 */
+  int num_nodes() const {
+    return static_cast<int>(node_cpus_.size());
+  }
+  /*! \return CPUs of a node, empty if unknown */
+  const std::vector<int>& cpus(int node) const;
+  /*!
+   * \brief Map a CPU device id to a node.
+   * \return the node, or -1 if NUMA placement does not apply to this device id.
+   */
+  int NodeOfDevice(int dev_id) const;
+
+ private:
+  NumaTopology();
+  bool enabled_{false};
+  std::vector<std::vector<int>> node_cpus_;
+};
+
+/*!
+ * \brief Bind the pages fully covered by [ptr, ptr + size) to a node.
+ *  No-op if NUMA placement is disabled or node is negative.
+ */
+void NumaBindMemory(void* ptr, size_t size, int node);
+
+/*!
+ * \brief Pin the calling thread to a set of CPUs.
+ *  No-op if cpus is empty or the platform has no thread affinity.
+ */
+void PinCurrentThreadToCPUs(const std::vector<int>& cpus);
+
+/*!
+ * \brief Pin the calling thread to the CPUs of a node.
+ *  No-op if NUMA placement is disabled or node is negative.
+ */
+void NumaPinCurrentThread(int node);
+
+}  // namespace common
+}  // namespace mxnet
+#endif  // MXNET_COMMON_NUMA_H_
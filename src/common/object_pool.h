@@ -21,6 +21,7 @@
 #define MXNET_COMMON_OBJECT_POOL_H_
 #include <dmlc/logging.h>
 #include <cstdlib>
+#include <memory>
 #include <mutex>
 #include <utility>
 #include <vector>
@@ -29,6 +30,10 @@ namespace mxnet {
 namespace common {
 /*!
  * \brief Object pool for fast allocation and deallocation.
+ *
+ *  Each thread keeps a small cache of free objects, so New and Delete only take
+ *  the pool lock when a batch of objects is moved between the thread cache and
+ *  the global free list.
  */
 template <typename T>
 class ObjectPool {
@@ -78,12 +83,35 @@ class ObjectPool {
     };
 #endif
   };
+  /*!
+   * \brief Per-thread free list, flushed back to the pool when the thread exits.
+   */
+  struct ThreadCache {
+    explicit ThreadCache(bool* destroyed) : destroyed_(destroyed) {}
+    ~ThreadCache() {
+      if (pool && head != nullptr) {
+        pool->ReturnChain(head);
+      }
+      *destroyed_ = true;
+    }
+    LinkedList* head{nullptr};
+    std::size_t size{0};
+    /*! \brief keeps the pool alive while this cache holds its objects */
+    std::shared_ptr<ObjectPool> pool;
+
+   private:
+    bool* destroyed_;
+  };
   /*!
    * \brief Page size of allocation.
    *
    * Currently defined to be 4KB.
    */
   constexpr static std::size_t kPageSize = 1 << 12;
+  /*!
+   * \brief Number of objects moved between a thread cache and the pool at once.
+   */
+  constexpr static std::size_t kBatchSize = 32;
   /*! \brief internal mutex */
   std::mutex m_;
   /*!
@@ -104,6 +132,19 @@ class ObjectPool {
    * This function is not protected and must be called with caution.
    */
   void AllocateChunk();
+  /*!
+   * \brief Get the cache of the calling thread.
+   * \return nullptr if the cache was already destroyed during thread exit.
+   */
+  static ThreadCache* LocalCache();
+  /*!
+   * \brief Move a batch of free objects from the pool into a thread cache.
+   */
+  void Refill(ThreadCache* cache);
+  /*!
+   * \brief Return a null-terminated chain of free objects to the pool.
+   */
+  void ReturnChain(LinkedList* chain);
   DISALLOW_COPY_AND_ASSIGN(ObjectPool);
 };  // class ObjectPool
 
@@ -142,9 +183,17 @@ template <typename T>
 template <typename... Args>
 T* ObjectPool<T>::New(Args&&... args) {
   LinkedList* ret;
-  {
+  ThreadCache* cache = LocalCache();
+  if (cache != nullptr) {
+    if (cache->head == nullptr) {
+      Refill(cache);
+    }
+    ret         = cache->head;
+    cache->head = ret->next;
+    --cache->size;
+  } else {
     std::lock_guard<std::mutex> lock{m_};
-    if (head_->next == nullptr) {
+    if (head_ == nullptr) {
       AllocateChunk();
     }
     ret   = head_;
@@ -157,11 +206,66 @@ template <typename T>
 void ObjectPool<T>::Delete(T* ptr) {
   ptr->~T();
   auto linked_list_ptr = reinterpret_cast<LinkedList*>(ptr);
-  {
+  ThreadCache* cache   = LocalCache();
+  if (cache == nullptr) {
     std::lock_guard<std::mutex> lock{m_};
     linked_list_ptr->next = head_;
     head_                 = linked_list_ptr;
+    return;
+  }
+  linked_list_ptr->next = cache->head;
+  cache->head           = linked_list_ptr;
+  if (++cache->size >= 2 * kBatchSize) {
+    // keep kBatchSize objects locally and hand the rest back
+    LinkedList* tail = cache->head;
+    for (std::size_t i = 1; i < kBatchSize; ++i) {
+      tail = tail->next;
+    }
+    LinkedList* rest = tail->next;
+    tail->next       = nullptr;
+    cache->size      = kBatchSize;
+    ReturnChain(rest);
+  }
+}
+
+template <typename T>
+typename ObjectPool<T>::ThreadCache* ObjectPool<T>::LocalCache() {
+  // trivially destructible, so it stays valid while other thread locals are destroyed
+  static thread_local bool destroyed = false;
+  if (destroyed) {
+    return nullptr;
+  }
+  static thread_local ThreadCache cache(&destroyed);
+  return &cache;
+}
+
+template <typename T>
+void ObjectPool<T>::Refill(ThreadCache* cache) {
+  if (!cache->pool) {
+    cache->pool = _GetSharedRef();
+  }
+  std::lock_guard<std::mutex> lock{m_};
+  for (std::size_t i = 0; i < kBatchSize; ++i) {
+    if (head_ == nullptr) {
+      AllocateChunk();
+    }
+    LinkedList* node = head_;
+    head_            = head_->next;
+    node->next       = cache->head;
+    cache->head      = node;
+  }
+  cache->size += kBatchSize;
+}
+
+template <typename T>
+void ObjectPool<T>::ReturnChain(LinkedList* chain) {
+  LinkedList* tail = chain;
+  while (tail->next != nullptr) {
+    tail = tail->next;
   }
+  std::lock_guard<std::mutex> lock{m_};
+  tail->next = head_;
+  head_      = chain;
 }
 
 template <typename T>
@@ -410,6 +410,8 @@ inline std::string stype_string(const int x) {
       return "csr";
     case kRowSparseStorage:
       return "row_sparse";
+    case kBSRStorage:
+      return "bsr";
   }
   return "unknown";
 }
@@ -586,6 +588,45 @@ V ParallelAccumulate(const T* a, const int n, V start) {
   return sum;
 }
 
+/*!
+ * \brief In-place inclusive prefix sum of a. Each thread scans a contiguous chunk, then adds
+ *  the total of the chunks before it, so that a is read and written twice whatever the number
+ *  of threads.
+ */
+template <typename T>
+void ParallelPrefixSum(T* a, const int64_t n) {
+  const int num_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  // below a few pages the serial scan is faster than waking up the threads
+  if (num_threads <= 1 || n < (int64_t{1} << 14)) {
+    for (int64_t i = 1; i < n; ++i) {
+      a[i] += a[i - 1];
+    }
+    return;
+  }
+  std::vector<T> offsets(num_threads + 1, T(0));
+#pragma omp parallel num_threads(num_threads)
+  {
+    const int tid       = omp_get_thread_num();
+    const int nthreads  = omp_get_num_threads();
+    const int64_t chunk = (n + nthreads - 1) / nthreads;
+    const int64_t begin = std::min(n, tid * chunk);
+    const int64_t end   = std::min(n, begin + chunk);
+    for (int64_t i = begin + 1; i < end; ++i) {
+      a[i] += a[i - 1];
+    }
+    offsets[tid + 1] = begin < end ? a[end - 1] : T(0);
+#pragma omp barrier
+#pragma omp single
+    for (int t = 0; t < nthreads; ++t) {
+      offsets[t + 1] += offsets[t];
+    }
+    const T offset = offsets[tid];
+    for (int64_t i = begin; i < end; ++i) {
+      a[i] += offset;
+    }
+  }
+}
+
 /*!
  * \brief
  * Helper function for ParallelSort.
@@ -636,6 +677,38 @@ void ParallelSort(RandomIt first, RandomIt last, size_t num_threads) {
       first, last, num_threads, std::less<typename std::iterator_traits<RandomIt>::value_type>());
 }
 
+/*!
+ * \brief
+ * Helper function for ParallelStableSort.
+ * DO NOT call this function directly.
+ * Use the interface ParallelStableSort instead.
+ */
+template <typename RandomIt, typename Compare>
+void ParallelStableSortHelper(RandomIt first, size_t len, size_t grainsize, const Compare& comp) {
+  if (len < grainsize) {
+    std::stable_sort(first, first + len, comp);
+  } else {
+    std::thread thr(ParallelStableSortHelper<RandomIt, Compare>, first, len / 2, grainsize, comp);
+    ParallelStableSortHelper(first + len / 2, len - len / 2, grainsize, comp);
+    thr.join();
+    std::inplace_merge(first, first + len / 2, first + len, comp);
+  }
+}
+
+/*!
+ * \brief
+ * Sort the elements in the range [first, last) into the ascending order defined by
+ * the comparator comp, keeping the order of the equivalent elements.
+ * Like ParallelSort, the ranges greater than a certain threshold are divided into two
+ * halves sorted by two threads, which std::inplace_merge then merges stably.
+ */
+template <typename RandomIt, typename Compare>
+void ParallelStableSort(RandomIt first, RandomIt last, size_t num_threads, Compare comp) {
+  const auto num   = std::distance(first, last);
+  size_t grainsize = std::max(num / num_threads + 5, static_cast<size_t>(1024 * 16));
+  ParallelStableSortHelper(first, num, grainsize, comp);
+}
+
 /*!
  * \brief Random Engine
  */
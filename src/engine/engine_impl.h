@@ -46,6 +46,20 @@ struct Opr {
   inline T* Cast();
 };  // struct Opr
 
+/*! \brief base class of captured graphs, used for type checking */
+struct Graph {
+#if ENGINE_DEBUG
+  virtual ~Graph() = default;
+#endif
+  /*!
+   * \brief cast graph to derived type T
+   * \tparam T the type we want to cast into.
+   * \return A casted graph.
+   */
+  template <typename T>
+  inline T* Cast();
+};  // struct Graph
+
 // implementation of the inline functions
 template <typename T>
 inline T* Var::Cast() {
@@ -67,6 +81,16 @@ inline T* Opr::Cast() {
 #endif
 }
 
+template <typename T>
+inline T* Graph::Cast() {
+  static_assert(std::is_base_of<Graph, T>::value, "must inherit `mxnet::engine::Graph`");
+#if ENGINE_DEBUG
+  return dynamic_cast<T*>(this);
+#else
+  return static_cast<T*>(this);
+#endif
+}
+
 /*! \brief Maximum number of GPUs */
 static constexpr std::size_t kMaxNumGPUs = 16;
 
@@ -78,6 +102,8 @@ Engine* CreateNaiveEngine();
 Engine* CreateThreadedEnginePooled();
 /*! \return ThreadedEnginePerDevie instance */
 Engine* CreateThreadedEnginePerDevice();
+/*! \return ThreadedEnginePerDevice instance whose CPU workers use work stealing */
+Engine* CreateThreadedEngineWorkStealing();
 #endif
 }  // namespace engine
 }  // namespace mxnet
@@ -31,6 +31,8 @@
 #include "./openmp.h"
 #include "../common/object_pool.h"
 #include "../profiler/custom_op_profiler.h"
+#include "../profiler/request_trace.h"
+#include "../profiler/storage_profiler.h"
 
 namespace mxnet {
 namespace engine {
@@ -127,8 +129,12 @@ class NaiveEngine final : public Engine {
             opr->opr_profile =
                 std::make_unique<profiler::ProfileOperator>(opr->opr_name.c_str(), attrs.release());
             opr->opr_profile->startForDevice(exec_ctx.dev_type, exec_ctx.dev_id);
+            if (profiler->AggregateEnabled()) {
+              profiler::ProfileOperator::Current() = opr->opr_profile.get();
+            }
           }
           opr->fn(ctx, on_start, on_complete);
+          profiler::ProfileOperator::Current() = nullptr;
           if (opr->profiling) {
             opr->opr_profile->stop();
           }
@@ -176,7 +182,14 @@ class NaiveEngine final : public Engine {
       opr->opr_profile =
           std::make_unique<profiler::ProfileOperator>(opr->opr_name.c_str(), attrs.release());
       opr->opr_profile->startForDevice(exec_ctx.dev_type, exec_ctx.dev_id);
+      if (profiler->AggregateEnabled()) {
+        profiler::ProfileOperator::Current() = opr->opr_profile.get();
+      }
     }
+    profiler::MemoryTimeline::Scope memory_scope(opr_name, false);
+    // operators run on the pushing thread, with no queueing or dispatch
+    profiler::RequestTrace::Scope trace_span(wait ? nullptr : opr_name,
+                                             profiler::RequestTrace::kOperator);
     if (exec_ctx.dev_mask() == gpu::kDevMask) {
 #if MXNET_USE_CUDA
       size_t dev_id = static_cast<size_t>(exec_ctx.dev_id);
@@ -198,6 +211,7 @@ class NaiveEngine final : public Engine {
       exec_fun(RunContext{exec_ctx, &cpu_stream_, nullptr}, on_start, callback);
     }
     future.wait();
+    profiler::ProfileOperator::Current() = nullptr;
     // increment mutable var version
     for (auto var : mutable_vars) {
       ++var->version_;
@@ -0,0 +1,194 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file parallel_for.cc
+ * \brief Pool of threads shared by the parallel loops of the CPU operators.
+ */
+#include "./parallel_for.h"
+
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <mxnet/base.h>
+#include <string>
+
+#include "./openmp.h"
+#include "./thread_budget.h"
+
+namespace mxnet {
+namespace engine {
+
+namespace {
+/*! \brief whether the thread runs chunks of a parallel loop */
+MX_THREAD_LOCAL bool in_parallel_region = false;
+
+/*! \brief marks the thread as running chunks for its lifetime */
+class ParallelRegionScope {
+ public:
+  ParallelRegionScope() : outer_(in_parallel_region) {
+    in_parallel_region = true;
+  }
+  ~ParallelRegionScope() {
+    in_parallel_region = outer_;
+  }
+
+ private:
+  const bool outer_;
+};
+
+bool NativeRuntimeSelected() {
+  const std::string runtime = dmlc::GetEnv("MXNET_CPU_PARALLEL_RUNTIME", std::string("omp"));
+  CHECK(runtime == "omp" || runtime == "native")
+      << "MXNET_CPU_PARALLEL_RUNTIME must be omp or native, got " << runtime;
+  return runtime == "native";
+}
+}  // namespace
+
+/*! \brief a loop published to the pool */
+struct ParallelRuntime::Loop {
+  RangeFn fn;
+  const void* body;
+  int64_t begin;
+  int64_t end;
+  int64_t chunk;
+  int64_t num_chunks;
+  /*! \brief maximum number of pool threads helping */
+  int max_helpers;
+  /*! \brief number of pool threads helping, incremented under the mutex of the runtime */
+  std::atomic<int> helpers{0};
+  /*! \brief next chunk to claim */
+  std::atomic<int64_t> next{0};
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  bool has_chunks() const {
+    return next.load(std::memory_order_relaxed) < num_chunks;
+  }
+
+  /*! \brief run chunks until none is left */
+  void RunChunks() {
+    while (true) {
+      const int64_t c = next.fetch_add(1, std::memory_order_relaxed);
+      if (c >= num_chunks)
+        return;
+      const int64_t b = begin + c * chunk;
+      try {
+        fn(body, b, std::min(end, b + chunk));
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error)
+          error = std::current_exception();
+      }
+    }
+  }
+};
+
+ParallelRuntime::ParallelRuntime() : enabled_(NativeRuntimeSelected()) {}
+
+ParallelRuntime* ParallelRuntime::Get() {
+  // never destroyed, the pool threads sleep until the process exits
+  static ParallelRuntime* inst = new ParallelRuntime();
+  return inst;
+}
+
+bool ParallelRuntime::InParallelRegion() {
+#ifdef _OPENMP
+  return in_parallel_region || omp_in_parallel();
+#else
+  return in_parallel_region;
+#endif
+}
+
+void ParallelRuntime::Start() {
+  // the callers run chunks too, so the pool needs one thread less than the largest team
+  const int max_threads = std::max(OpenMP::Get()->thread_max(),
+                                   OpenMP::Get()->GetRecommendedOMPThreadCount(false));
+  num_workers_ = dmlc::GetEnv("MXNET_CPU_PARALLEL_NTHREADS", std::max(0, max_threads - 1));
+  for (int i = 0; i < num_workers_; ++i) {
+    workers_.emplace_back([this]() { WorkerLoop(); });
+  }
+}
+
+ParallelRuntime::Loop* ParallelRuntime::FindLoop() const {
+  for (Loop* loop : loops_) {
+    if (loop->has_chunks() && loop->helpers.load(std::memory_order_relaxed) < loop->max_helpers)
+      return loop;
+  }
+  return nullptr;
+}
+
+void ParallelRuntime::WorkerLoop() {
+  ThreadBudget::Get()->PinComputeThread(-1);
+  ParallelRegionScope region;
+  while (true) {
+    Loop* loop = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this, &loop]() { return (loop = FindLoop()) != nullptr; });
+      loop->helpers.fetch_add(1, std::memory_order_relaxed);
+    }
+    loop->RunChunks();
+    loop->helpers.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+void ParallelRuntime::Run(int64_t begin,
+                          int64_t end,
+                          int64_t chunk,
+                          int num_threads,
+                          RangeFn fn,
+                          const void* body) {
+  std::call_once(start_, [this]() { Start(); });
+  Loop loop;
+  loop.fn          = fn;
+  loop.body        = body;
+  loop.begin       = begin;
+  loop.end         = end;
+  loop.chunk       = chunk;
+  loop.num_chunks  = (end - begin + chunk - 1) / chunk;
+  loop.max_helpers = static_cast<int>(
+      std::min<int64_t>(std::min(num_threads - 1, num_workers_), loop.num_chunks - 1));
+  if (loop.max_helpers > 0) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      loops_.push_back(&loop);
+    }
+    for (int i = 0; i < loop.max_helpers; ++i) {
+      cond_.notify_one();
+    }
+  }
+  {
+    ParallelRegionScope region;
+    loop.RunChunks();
+  }
+  if (loop.max_helpers > 0) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      loops_.erase(std::find(loops_.begin(), loops_.end(), &loop));
+    }
+    // no helper joins once the loop is unpublished, wait for those running its last chunks
+    while (loop.helpers.load(std::memory_order_acquire) > 0) {
+      std::this_thread::yield();
+    }
+  }
+  if (loop.error)
+    std::rethrow_exception(loop.error);
+}
+
+}  // namespace engine
+}  // namespace mxnet
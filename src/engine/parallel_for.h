@@ -0,0 +1,150 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file parallel_for.h
+ * \brief Parallel loops of the CPU operators, run by OpenMP or by a pool shared by the engine.
+ *
+ *  By default ParallelFor splits a loop into one contiguous range per thread of an OpenMP
+ *  team, as `#pragma omp parallel for` does. When MXNET_CPU_PARALLEL_RUNTIME=native, the
+ *  ranges are run instead by the calling thread and by the threads of a single pool that all
+ *  engine workers share: the caller publishes the loop, and idle pool threads claim its
+ *  chunks until none is left. So operators running at the same time on several engine
+ *  workers split the pool between them rather than each starting a team, a loop starts
+ *  without waiting for any thread to wake up, and the chunks of a late helper are taken by
+ *  the others.
+ *
+ *  In both modes, a loop no larger than its grain, or started from inside another parallel
+ *  loop, runs serially on the calling thread.
+ */
+#ifndef MXNET_ENGINE_PARALLEL_FOR_H_
+#define MXNET_ENGINE_PARALLEL_FOR_H_
+
+#include <dmlc/omp.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mxnet {
+namespace engine {
+
+/*!
+ * \brief Pool of threads running the chunks of the parallel loops of all engine workers.
+ */
+class ParallelRuntime {
+ public:
+  /*! \brief body of a loop called on a range [begin, end) */
+  using RangeFn = void (*)(const void* body, int64_t begin, int64_t end);
+
+  /*! \return the runtime of the process */
+  static ParallelRuntime* Get();
+
+  /*! \return whether MXNET_CPU_PARALLEL_RUNTIME selects the native pool */
+  bool enabled() const {
+    return enabled_;
+  }
+
+  /*! \return whether the calling thread runs a chunk of a parallel loop */
+  static bool InParallelRegion();
+
+  /*!
+   * \brief Run a loop on the calling thread and on at most num_threads - 1 pool threads.
+   * \param begin first index of the loop
+   * \param end index past the last one
+   * \param chunk number of indices a thread claims at once
+   * \param num_threads maximum number of threads running the loop
+   * \param fn function calling body on a range
+   * \param body the body of the loop
+   * \note rethrows the first exception thrown by the body, once all chunks have run
+   */
+  void Run(int64_t begin,
+           int64_t end,
+           int64_t chunk,
+           int num_threads,
+           RangeFn fn,
+           const void* body);
+
+ private:
+  struct Loop;
+
+  ParallelRuntime();
+  /*! \brief start the pool on the first loop */
+  void Start();
+  void WorkerLoop();
+  /*! \return a loop with chunks to claim and room for a helper, guarded by mutex_ */
+  Loop* FindLoop() const;
+
+  const bool enabled_;
+  /*! \brief number of pool threads */
+  int num_workers_{0};
+  std::once_flag start_;
+  std::vector<std::thread> workers_;
+  /*! \brief loops with chunks to claim */
+  std::vector<Loop*> loops_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+};
+
+/*!
+ * \brief Run body(b, e) over ranges covering [begin, end) on num_threads threads at most.
+ * \param grain minimum number of indices of a range
+ * \param body callable taking the first index and the index past the last one of a range
+ */
+template <typename F>
+inline void ParallelFor(int64_t begin, int64_t end, int64_t grain, int num_threads, const F& body) {
+  const int64_t n = end - begin;
+  if (n <= 0)
+    return;
+  grain = std::max<int64_t>(grain, 1);
+  if (num_threads < 2 || n <= grain || ParallelRuntime::InParallelRegion()) {
+    body(begin, end);
+    return;
+  }
+  ParallelRuntime* runtime = ParallelRuntime::Get();
+  if (runtime->enabled()) {
+    // a few chunks per thread so that the threads that start early take on the others' work
+    constexpr int64_t kChunksPerThread = 4;
+    const int64_t chunks               = kChunksPerThread * num_threads;
+    const int64_t chunk                = std::max(grain, (n + chunks - 1) / chunks);
+    runtime->Run(
+        begin,
+        end,
+        chunk,
+        num_threads,
+        [](const void* f, int64_t b, int64_t e) { (*static_cast<const F*>(f))(b, e); },
+        &body);
+    return;
+  }
+#ifdef _OPENMP
+  const int ranges = static_cast<int>(std::min<int64_t>(num_threads, (n + grain - 1) / grain));
+#pragma omp parallel for num_threads(ranges)
+  for (int r = 0; r < ranges; ++r) {
+    body(begin + n * r / ranges, begin + n * (r + 1) / ranges);
+  }
+#else
+  body(begin, end);
+#endif
+}
+
+}  // namespace engine
+}  // namespace mxnet
+#endif  // MXNET_ENGINE_PARALLEL_FOR_H_
@@ -0,0 +1,161 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file scheduling_queue.h
+ * \brief Blocking task queue of the engine workers with optional priority ordering.
+ */
+#ifndef MXNET_ENGINE_SCHEDULING_QUEUE_H_
+#define MXNET_ENGINE_SCHEDULING_QUEUE_H_
+
+#include <dmlc/base.h>
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <vector>
+#include "mxnet/base.h"
+
+namespace mxnet {
+namespace engine {
+
+/*!
+ * \brief Blocking queue with the interface of dmlc::ConcurrentBlockingQueue.
+ *
+ *  By default it is a plain FIFO. With MXNET_ENGINE_PRIORITY_SCHEDULING=1, ready
+ *  tasks are popped by decreasing priority, and in push order among equal priorities.
+ *  With MXNET_ENGINE_PRIORITY_AGING=N > 0, a waiting task gains one priority level
+ *  for every N tasks pushed after it, so low-priority work cannot starve.
+ * \tparam T task type.
+ */
+template <typename T>
+class SchedulingQueue {
+ public:
+  SchedulingQueue()
+      : use_priority_(dmlc::GetEnv("MXNET_ENGINE_PRIORITY_SCHEDULING", false)),
+        aging_period_(dmlc::GetEnv("MXNET_ENGINE_PRIORITY_AGING", int64_t{0})) {
+    CHECK_GE(aging_period_, 0) << "MXNET_ENGINE_PRIORITY_AGING must not be negative";
+  }
+  /*!
+   * \brief Push a task.
+   * \param item the task.
+   * \param priority larger values are popped first in priority mode.
+   */
+  void Push(T item, int priority = 0) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (use_priority_) {
+        heap_.push_back(Entry{item, Key(priority), seq_++});
+        std::push_heap(heap_.begin(), heap_.end());
+      } else {
+        fifo_.push_back(item);
+      }
+    }
+    cv_.notify_one();
+  }
+  /*!
+   * \brief Push a task that is popped before all others.
+   */
+  void PushFront(T item, int priority = 0) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (use_priority_) {
+        heap_.push_back(Entry{item, std::numeric_limits<int64_t>::max(), seq_++});
+        std::push_heap(heap_.begin(), heap_.end());
+      } else {
+        fifo_.push_front(item);
+      }
+    }
+    cv_.notify_one();
+  }
+  /*!
+   * \brief Pop a task, blocks until one is available.
+   * \return false if the queue was signaled for kill.
+   */
+  bool Pop(T* out) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !Empty() || exit_now_; });
+    if (exit_now_)
+      return false;
+    if (use_priority_) {
+      std::pop_heap(heap_.begin(), heap_.end());
+      *out = heap_.back().item;
+      heap_.pop_back();
+    } else {
+      *out = fifo_.front();
+      fifo_.pop_front();
+    }
+    return true;
+  }
+  /*! \brief Make all current and future Pop calls return false */
+  void SignalForKill() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      exit_now_ = true;
+    }
+    cv_.notify_all();
+  }
+  /*! \return number of queued tasks */
+  size_t Size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return use_priority_ ? heap_.size() : fifo_.size();
+  }
+
+ private:
+  struct Entry {
+    T item;
+    /*! \brief effective priority, aging is folded into it at push time */
+    int64_t key;
+    uint64_t seq;
+    /*! \brief heap order: larger key first, then older entries first */
+    bool operator<(const Entry& other) const {
+      return key != other.key ? key < other.key : seq > other.seq;
+    }
+  };
+  /*!
+   * \brief With aging, a task pushed aging_period_ pushes later than another one
+   *  has one priority level less relative to it, so waiting tasks move up
+   *  without re-sorting the heap.
+   */
+  inline int64_t Key(int priority) const {
+    if (aging_period_ == 0)
+      return priority;
+    return static_cast<int64_t>(priority) * aging_period_ - static_cast<int64_t>(seq_);
+  }
+  inline bool Empty() const {
+    return use_priority_ ? heap_.empty() : fifo_.empty();
+  }
+  const bool use_priority_;
+  const int64_t aging_period_;
+  uint64_t seq_{0};
+  bool exit_now_{false};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<T> fifo_;
+  std::vector<Entry> heap_;
+  DISALLOW_COPY_AND_ASSIGN(SchedulingQueue);
+};
+
+}  // namespace engine
+}  // namespace mxnet
+#endif  // MXNET_ENGINE_SCHEDULING_QUEUE_H_
@@ -23,10 +23,12 @@
 #include <dmlc/base.h>
 #include <mxnet/base.h>
 #include <cstddef>
+#include <algorithm>
 #include <array>
 #include <string>
 #include <memory>
 #include <mutex>
+#include <vector>
 #include "./engine_impl.h"
 #include "../common/cuda/utils.h"
 
@@ -176,6 +178,82 @@ void StreamManager<kNumGpus, kStreams>::Finalize() {
 #endif  // MXNET_USE_CUDA
 }
 
+#if MXNET_USE_CUDA
+/*!
+ * \brief Streams of one GPU worker, among which its operators are spread so that the independent
+ *        ones can run concurrently.
+ *
+ * An operator continues the stream whose last operator wrote one of its variables, which keeps
+ * chains of operators on one stream. When no stream does, or another operator already continued
+ * it, as with the branches reading the same input, it takes the next stream in round-robin order.
+ * The dependencies across streams are synchronized by the events of the asynchronous engines.
+ */
+class GPUWorkerStreamPool {
+ public:
+  /*!
+   * \brief constructor.
+   * \param dev_id the device of the streams.
+   * \param num_streams the number of streams.
+   * \param is_copy whether the streams only copy, with neither library handle nor aux stream.
+   */
+  GPUWorkerStreamPool(int dev_id, std::size_t num_streams, bool is_copy)
+      : last_writes_(std::max<std::size_t>(num_streams, 1)) {
+    for (std::size_t i = 0; i < last_writes_.size(); ++i) {
+      if (is_copy) {
+        streams_.push_back(mshadow::NewStream<gpu>(false, false, dev_id));
+        aux_streams_.push_back(nullptr);
+      } else {
+        streams_.push_back(mshadow::NewStream<gpu>(true, MXNET_USE_CUDNN != 0, dev_id));
+        aux_streams_.push_back(new GPUAuxStream(streams_.back()));
+      }
+    }
+  }
+
+  std::size_t size() const {
+    return streams_.size();
+  }
+  mshadow::Stream<gpu>* stream(std::size_t i) const {
+    return streams_[i];
+  }
+  GPUAuxStream* aux_stream(std::size_t i) const {
+    return aux_streams_[i];
+  }
+
+  /*! \brief the index of the stream of the next operator, reading and writing the given vars */
+  template <typename VarType>
+  std::size_t Assign(const std::vector<VarType*>& const_vars,
+                     const std::vector<VarType*>& mutable_vars) {
+    if (streams_.size() == 1)
+      return 0;
+    std::size_t i = 0;
+    for (; i < last_writes_.size(); ++i) {
+      const auto& writes = last_writes_[i];
+      auto written       = [&writes](const VarType* v) {
+        return std::find(writes.begin(), writes.end(), v) != writes.end();
+      };
+      if (std::any_of(const_vars.begin(), const_vars.end(), written) ||
+          std::any_of(mutable_vars.begin(), mutable_vars.end(), written))
+        break;
+    }
+    if (i == last_writes_.size()) {
+      i     = next_;
+      next_ = (next_ + 1) % streams_.size();
+    }
+    last_writes_[i].assign(mutable_vars.begin(), mutable_vars.end());
+    return i;
+  }
+
+ private:
+  std::vector<mshadow::Stream<gpu>*> streams_;
+  std::vector<GPUAuxStream*> aux_streams_;
+  /*! \brief the vars written by the last operator of each stream */
+  std::vector<std::vector<const void*>> last_writes_;
+  /*! \brief the next stream of the operators continuing no stream */
+  std::size_t next_ = 0;
+  DISALLOW_COPY_AND_ASSIGN(GPUWorkerStreamPool);
+};
+#endif  // MXNET_USE_CUDA
+
 }  // namespace engine
 }  // namespace mxnet
 
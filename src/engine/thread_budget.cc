@@ -0,0 +1,170 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file thread_budget.cc
+ * \brief Partition of the cores among the engine workers, the OMP teams and the data loaders.
+ */
+#include "./thread_budget.h"
+
+#include <dmlc/logging.h>
+#include <dmlc/omp.h>
+#include <dmlc/parameter.h>
+#include <mxnet/base.h>
+#include <algorithm>
+#include <thread>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "./openmp.h"
+#include "../common/numa.h"
+
+namespace mxnet {
+namespace engine {
+
+namespace {
+
+/*! \brief CPUs the process may run on */
+std::vector<int> ProcessCPUs() {
+  std::vector<int> cpus;
+#if defined(__linux__)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  if (sched_getaffinity(0, sizeof(cpuset), &cpuset) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &cpuset))
+        cpus.push_back(cpu);
+    }
+  }
+#endif
+  if (cpus.empty()) {
+    const int n = std::max(1U, std::thread::hardware_concurrency());
+    for (int cpu = 0; cpu < n; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+}  // namespace
+
+ThreadBudget::ThreadBudget(const std::vector<int>& cpus, int loader_cores, int omp_thread_max)
+    : enabled_(true), omp_thread_max_(omp_thread_max) {
+  Partition(cpus, loader_cores);
+}
+
+ThreadBudget::ThreadBudget() : enabled_(dmlc::GetEnv("MXNET_THREAD_BUDGET", false)) {
+  if (!enabled_)
+    return;
+  const std::vector<int> cpus = ProcessCPUs();
+  omp_thread_max_             = OpenMP::Get()->thread_max();
+  Partition(cpus,
+            dmlc::GetEnv("MXNET_THREAD_BUDGET_LOADER_CORES",
+                         std::max(1, static_cast<int>(cpus.size()) / 8)));
+}
+
+ThreadBudget* ThreadBudget::Get() {
+  static ThreadBudget inst;
+  return &inst;
+}
+
+void ThreadBudget::Partition(const std::vector<int>& cpus, int loader_cores) {
+  CHECK(!cpus.empty()) << "The thread budget needs at least one CPU";
+  const int n = static_cast<int>(cpus.size());
+  // the compute set keeps a CPU, and without CPUs of their own the loaders share them all
+  const int loaders = std::min(std::max(loader_cores, 0), n - 1);
+  compute_cpus_.assign(cpus.begin(), cpus.end() - loaders);
+  loader_cpus_.assign(cpus.end() - loaders, cpus.end());
+  if (loader_cpus_.empty())
+    loader_cpus_ = compute_cpus_;
+}
+
+int ThreadBudget::EngineWorkers(int requested) const {
+  if (!enabled_)
+    return requested;
+  return std::max(1, std::min(requested, static_cast<int>(compute_cpus_.size())));
+}
+
+int ThreadBudget::AcquireLoaderThreads(int requested) {
+  if (!enabled_)
+    return requested;
+  std::lock_guard<std::mutex> lock(mutex_);
+  const int available = static_cast<int>(loader_cpus_.size()) - loader_threads_;
+  const int granted   = std::max(1, std::min(requested, available));
+  loader_threads_ += granted;
+  return granted;
+}
+
+void ThreadBudget::ReleaseLoaderThreads(int granted) {
+  if (!enabled_)
+    return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  loader_threads_ = std::max(0, loader_threads_ - granted);
+}
+
+int ThreadBudget::OMPTeamSize(int running_ops) const {
+  const int team = std::max(1, static_cast<int>(compute_cpus_.size()) / std::max(1, running_ops));
+  return omp_thread_max_ > 0 ? std::min(team, omp_thread_max_) : team;
+}
+
+void ThreadBudget::PinComputeThread(int numa_node) const {
+  if (!enabled_) {
+    common::NumaPinCurrentThread(numa_node);
+    return;
+  }
+  // the compute CPUs of the node, all of them if the node has none
+  std::vector<int> cpus;
+  for (int cpu : common::NumaTopology::Get()->cpus(numa_node)) {
+    if (std::find(compute_cpus_.begin(), compute_cpus_.end(), cpu) != compute_cpus_.end())
+      cpus.push_back(cpu);
+  }
+  common::PinCurrentThreadToCPUs(cpus.empty() ? compute_cpus_ : cpus);
+}
+
+void ThreadBudget::PinLoaderThread() const {
+  static MX_THREAD_LOCAL bool pinned = false;
+  if (!enabled_ || pinned)
+    return;
+  common::PinCurrentThreadToCPUs(loader_cpus_);
+  pinned = true;
+}
+
+ThreadBudget::OperatorScope::OperatorScope(ThreadBudget* budget)
+    : budget_(budget->enabled() ? budget : nullptr) {
+  if (budget_ == nullptr)
+    return;
+  const int team = budget_->OMPTeamSize(++budget_->running_ops_);
+#ifdef _OPENMP
+  // omp_set_num_threads only sets the team size of the regions the calling thread starts
+  static MX_THREAD_LOCAL int team_size = 0;
+  if (team != team_size) {
+    omp_set_num_threads(team);
+    team_size = team;
+  }
+#endif
+}
+
+ThreadBudget::OperatorScope::~OperatorScope() {
+  if (budget_ != nullptr)
+    --budget_->running_ops_;
+}
+
+}  // namespace engine
+}  // namespace mxnet
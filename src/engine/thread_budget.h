@@ -0,0 +1,132 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file thread_budget.h
+ * \brief Partition of the cores among the engine workers, the OMP teams of the operators
+ *        and the data loaders.
+ *
+ *  When MXNET_THREAD_BUDGET=1, the CPUs the process may run on are split in two sets. The
+ *  last MXNET_THREAD_BUDGET_LOADER_CORES of them are shared by the threads of the data
+ *  loaders, which are pinned to them and get at most as many threads as the set has CPUs.
+ *  The others are shared by the CPU engine workers, which are pinned to them, and by the OMP
+ *  teams of the operators these workers run: an operator gets the compute CPUs divided among
+ *  the operators running at the same time. Without the variable, thread counts and placement
+ *  are left to the other settings.
+ */
+#ifndef MXNET_ENGINE_THREAD_BUDGET_H_
+#define MXNET_ENGINE_THREAD_BUDGET_H_
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace mxnet {
+namespace engine {
+
+class ThreadBudget {
+ public:
+  /*!
+   * \brief Create an enabled budget.
+   * \param cpus CPUs to partition
+   * \param loader_cores number of the last CPUs given to the data loaders, clamped so that
+   *        the compute set keeps at least one CPU
+   * \param omp_thread_max maximum size of an OMP team, 0 for no maximum
+   */
+  ThreadBudget(const std::vector<int>& cpus, int loader_cores, int omp_thread_max);
+
+  /*! \return the budget of the process, read once from the environment */
+  static ThreadBudget* Get();
+
+  /*! \return whether MXNET_THREAD_BUDGET is set */
+  bool enabled() const {
+    return enabled_;
+  }
+  /*! \return CPUs of the engine workers and the OMP teams */
+  const std::vector<int>& compute_cpus() const {
+    return compute_cpus_;
+  }
+  /*! \return CPUs of the data loaders */
+  const std::vector<int>& loader_cpus() const {
+    return loader_cpus_;
+  }
+
+  /*!
+   * \brief Number of engine workers to start for a device.
+   * \param requested number of workers asked by the configuration
+   * \return requested if disabled, else at most the number of compute CPUs
+   */
+  int EngineWorkers(int requested) const;
+
+  /*!
+   * \brief Take threads of the data loaders from the budget.
+   * \param requested number of threads asked by the loader
+   * \return requested if disabled, else between 1 and the loader CPUs not taken yet
+   *         by the other loaders
+   */
+  int AcquireLoaderThreads(int requested);
+  /*! \brief Give back the threads returned by AcquireLoaderThreads */
+  void ReleaseLoaderThreads(int granted);
+
+  /*!
+   * \brief OMP team size of an operator.
+   * \param running_ops number of operators running on the CPU, this one included
+   */
+  int OMPTeamSize(int running_ops) const;
+
+  /*!
+   * \brief Pin the calling engine worker to the compute CPUs, or to the ones of a NUMA node.
+   * \param numa_node the node of the device of the worker, or -1
+   */
+  void PinComputeThread(int numa_node) const;
+  /*! \brief Pin the calling thread of a data loader to the loader CPUs, once per thread */
+  void PinLoaderThread() const;
+
+  /*!
+   * \brief Marks an operator running on a CPU engine worker for its lifetime and sizes
+   *        the OMP team of the worker's thread for it.
+   */
+  class OperatorScope {
+   public:
+    explicit OperatorScope(ThreadBudget* budget);
+    ~OperatorScope();
+    OperatorScope(const OperatorScope&) = delete;
+    OperatorScope& operator=(const OperatorScope&) = delete;
+
+   private:
+    ThreadBudget* budget_;
+  };
+
+ private:
+  ThreadBudget();
+  void Partition(const std::vector<int>& cpus, int loader_cores);
+
+  bool enabled_{false};
+  int omp_thread_max_{0};
+  std::vector<int> compute_cpus_;
+  std::vector<int> loader_cpus_;
+  /*! \brief number of operators running on CPU engine workers */
+  std::atomic<int> running_ops_{0};
+  /*! \brief number of loader threads taken, guarded by mutex_ */
+  int loader_threads_{0};
+  std::mutex mutex_;
+};
+
+}  // namespace engine
+}  // namespace mxnet
+#endif  // MXNET_ENGINE_THREAD_BUDGET_H_
@@ -27,6 +27,7 @@
 #include <algorithm>
 #include <condition_variable>
 #include <mutex>
+#include <unordered_map>
 #include <utility>
 #include "./threaded_engine.h"
 #include "../common/cuda/utils.h"
@@ -41,7 +42,9 @@ std::atomic<std::size_t> ThreadedVar::counter{0};
 std::atomic<std::size_t> ThreadedOpr::counter{0};
 #endif  // ENGINE_DEBUG
 
-ThreadedVar::ThreadedVar(VersionedVarBlock* head) : head_{head} {
+std::atomic<uint64_t> ThreadedVar::next_uid_{0};
+
+ThreadedVar::ThreadedVar(VersionedVarBlock* head) : head_{head}, uid_{next_uid_++} {
 #if ENGINE_DEBUG
   LOG(INFO) << __func__ << " " << ++counter;
 #endif  // ENGINE_DEBUG
@@ -197,7 +200,7 @@ inline bool ThreadedVar::ready_to_read() {
   return this->is_ready_to_read();
 }
 
-inline size_t ThreadedVar::version() {
+size_t ThreadedVar::version() {
   std::lock_guard<std::mutex> lock{mutex_};
   return this->version_;
 }
@@ -207,6 +210,24 @@ ThreadedVar* ThreadedEngine::NewVariable() {
   return ThreadedVar::New(VersionedVarBlock::New());
 }
 
+VarHandle ThreadedEngine::NewRegionVariable(VarHandle var) {
+  ThreadedVar* region = NewVariable();
+  ThreadedVar::CastFromBase(var)->AddRegionVar(region);
+  // the operations of the region wait for the operations of the whole data pushed before it
+  this->PushAsync(
+      [](RunContext, CallbackOnStart on_start, CallbackOnComplete on_complete) {
+        on_start();
+        on_complete();
+      },
+      Context::CPU(),
+      {var},
+      {region},
+      FnProperty::kNormal,
+      0,
+      "NewRegionVariable");
+  return region;
+}
+
 ThreadedOpr* ThreadedEngine::NewOperator(ThreadedEngine::AsyncFn fn,
                                          std::vector<VarHandle> const& const_vars,
                                          std::vector<VarHandle> const& mutable_vars,
@@ -265,6 +286,35 @@ void ThreadedEngine::CheckDuplicate(std::vector<VarHandle> const& const_vars,
   }
 }
 
+bool ThreadedEngine::AddRegionVars(std::vector<ThreadedVar*>* const_vars,
+                                   std::vector<ThreadedVar*>* mutable_vars) {
+  bool added = false;
+  for (std::vector<ThreadedVar*>* vars : {const_vars, mutable_vars}) {
+    const size_t num_vars = vars->size();
+    for (size_t i = 0; i < num_vars; ++i) {
+      if ((*vars)[i]->num_region_vars() != 0) {
+        (*vars)[i]->AppendRegionVars(vars);
+        added = true;
+      }
+    }
+  }
+  if (!added)
+    return false;
+  for (std::vector<ThreadedVar*>* vars : {const_vars, mutable_vars}) {
+    std::sort(vars->begin(), vars->end());
+    vars->erase(std::unique(vars->begin(), vars->end()), vars->end());
+  }
+  // a region both read and mutated is only mutated
+  const_vars->erase(std::remove_if(const_vars->begin(),
+                                   const_vars->end(),
+                                   [mutable_vars](ThreadedVar* var) {
+                                     return std::binary_search(
+                                         mutable_vars->begin(), mutable_vars->end(), var);
+                                   }),
+                    const_vars->end());
+  return true;
+}
+
 void ThreadedEngine::DeleteOperator(OprHandle op) {
   ThreadedOpr* threaded_opr = ThreadedOpr::CastFromBase(op);
   std::vector<VarHandle> deps;
@@ -288,10 +338,36 @@ void ThreadedEngine::DeleteOperator(OprHandle op) {
 void ThreadedEngine::Push(OprHandle op, Context exec_ctx, int priority, bool profiling) {
   BulkFlush();
   ThreadedOpr* threaded_opr = ThreadedOpr::CastFromBase(op);
+  if (std::any_of(threaded_opr->const_vars.begin(),
+                  threaded_opr->const_vars.end(),
+                  [](ThreadedVar* var) { return var->num_region_vars() != 0; }) ||
+      std::any_of(threaded_opr->mutable_vars.begin(),
+                  threaded_opr->mutable_vars.end(),
+                  [](ThreadedVar* var) { return var->num_region_vars() != 0; })) {
+    if (!threaded_opr->temporary) {
+      // the pushes of a persistent operator in flight complete with its own variables, the
+      // region variables go to a temporary copy
+      ThreadedOpr* copy   = ThreadedOpr::New();
+      copy->fn            = threaded_opr->fn;
+      copy->const_vars    = threaded_opr->const_vars;
+      copy->mutable_vars  = threaded_opr->mutable_vars;
+      copy->prop          = threaded_opr->prop;
+      copy->opr_name      = threaded_opr->opr_name;
+      copy->wait          = threaded_opr->wait;
+      copy->opr_exception = threaded_opr->opr_exception;
+      copy->temporary     = true;
+      threaded_opr        = copy;
+    }
+    AddRegionVars(&threaded_opr->const_vars, &threaded_opr->mutable_vars);
+  }
   if (profiling) {
     threaded_opr->opr_name =
         profiler::CustomOpProfiler::Get()->GenerateDisplayName(threaded_opr->opr_name.c_str());
   }
+  if (CaptureStatusStore::Get()->graph && !threaded_opr->wait &&
+      threaded_opr->prop != FnProperty::kDeleteVar) {
+    CaptureOperator(threaded_opr, exec_ctx, priority, profiling);
+  }
   OprBlock* opr_block = OprBlock::New();
   opr_block->opr      = threaded_opr;
 
@@ -300,6 +376,14 @@ void ThreadedEngine::Push(OprHandle op, Context exec_ctx, int priority, bool pro
   opr_block->ctx       = exec_ctx;
   opr_block->priority  = priority;
   opr_block->profiling = profiling;
+  // operators of a traced request add their span when they complete, the internal
+  // operators of waits are covered by the sync span of the wait
+  std::shared_ptr<profiler::RequestTrace>& trace = profiler::RequestTrace::Current();
+  if (trace != nullptr && !threaded_opr->wait) {
+    opr_block->trace           = trace;
+    opr_block->trace_parent    = profiler::RequestTrace::CurrentSpan();
+    opr_block->trace_push_time = profiler::RequestTrace::NowInNanosec();
+  }
   ++pending_;
   // Add read dependencies.
   for (auto&& i : threaded_opr->const_vars) {
@@ -310,6 +394,7 @@ void ThreadedEngine::Push(OprHandle op, Context exec_ctx, int priority, bool pro
     i->AppendWriteDependency(opr_block);
   }
   if (opr_block->decr_wait() == 0) {
+    opr_block->trace_ready();
     this->PushToExecute(opr_block, true);
   }
 }
@@ -372,6 +457,10 @@ void ThreadedEngine::PushSync(SyncFn exec_fn,
 
 void ThreadedEngine::DeleteVariable(SyncFn delete_fn, Context exec_ctx, VarHandle var) {
   ThreadedVar* threaded_var = ThreadedVar::CastFromBase(var);
+  CaptureStatus& capture    = *CaptureStatusStore::Get();
+  if (capture.graph && capture.vars.count(threaded_var)) {
+    capture.invalid = true;
+  }
   this->PushAsync(
       [delete_fn, threaded_var](
           RunContext ctx, CallbackOnStart on_start, CallbackOnComplete on_complete) {
@@ -379,6 +468,12 @@ void ThreadedEngine::DeleteVariable(SyncFn delete_fn, Context exec_ctx, VarHandl
         // so during `ThreadedEngine::OnComplete` it could be recycled.
         on_start();
         threaded_var->SetToDelete();
+        // the regions were mutated by this operation as well
+        std::vector<ThreadedVar*> region_vars;
+        threaded_var->AppendRegionVars(&region_vars);
+        for (ThreadedVar* region : region_vars) {
+          region->SetToDelete();
+        }
         delete_fn(ctx);
         on_complete();
       },
@@ -391,9 +486,10 @@ void ThreadedEngine::DeleteVariable(SyncFn delete_fn, Context exec_ctx, VarHandl
 }
 
 void ThreadedEngine::WaitForVar(VarHandle var) {
+  profiler::RequestTrace::Scope trace_span("WaitForVar", profiler::RequestTrace::kSync);
   BulkFlush();
   ThreadedVar* threaded_var = ThreadedVar::CastFromBase(var);
-  if (threaded_var->ready_to_read()) {
+  if (threaded_var->num_region_vars() == 0 && threaded_var->ready_to_read()) {
     ThrowException(threaded_var);
     return;
   }
@@ -434,6 +530,7 @@ void ThreadedEngine::WaitForVar(VarHandle var) {
 }
 
 void ThreadedEngine::WaitForAll() {
+  profiler::RequestTrace::Scope trace_span("WaitForAll", profiler::RequestTrace::kSync);
   BulkFlush();
   std::unique_lock<std::mutex> lock{finished_m_};
   finished_cv_.wait(lock, [this]() { return pending_.load() == 0 || kill_.load(); });
@@ -460,7 +557,10 @@ inline void ThreadedEngine::OnComplete(ThreadedOpr* threaded_opr) {
   bool is_temporary_opr = threaded_opr->temporary;
   // Mark complete for read variables
   for (auto&& i : threaded_opr->const_vars) {
-    i->CompleteReadDependency([this](OprBlock* opr) { this->PushToExecute(opr, false); });
+    i->CompleteReadDependency([this](OprBlock* opr) {
+      opr->trace_ready();
+      this->PushToExecute(opr, false);
+    });
   }
   // Mark complete for write variables.
   for (auto&& i : threaded_opr->mutable_vars) {
@@ -479,6 +579,7 @@ inline void ThreadedEngine::OnComplete(ThreadedOpr* threaded_opr) {
         LOG(INFO) << "PushToExecute " << opr;
         debug_push_opr_ = opr;
       }
+      opr->trace_ready();
       this->PushToExecute(opr, false);
       if (debug_info) {
         LOG(INFO) << "Fin PushToExecute " << opr;
@@ -517,6 +618,189 @@ inline void ThreadedEngine::OnComplete(ThreadedOpr* threaded_opr) {
   }
 }
 
+inline void ThreadedEngine::OnCompleteGraphNode(OprBlock* opr_block) {
+  ThreadedGraph* graph      = opr_block->graph;
+  ThreadedOpr* threaded_opr = opr_block->opr;
+  if (threaded_opr->opr_exception && *threaded_opr->opr_exception) {
+    for (auto&& i : threaded_opr->mutable_vars) {
+      i->var_exception = threaded_opr->opr_exception;
+    }
+    AddToGlobalExceptions(threaded_opr->opr_exception);
+  }
+  for (uint32_t next : graph->nodes[opr_block->node].outputs) {
+    if (graph->wait[next].fetch_sub(1) == 1) {
+      PushGraphNode(graph, next);
+    }
+  }
+  if (--graph->remaining == 0) {
+    // the graph may be deleted as soon as the gate completes
+    CallbackOnComplete on_complete = graph->on_complete;
+    on_complete();
+  }
+}
+
+void ThreadedEngine::CaptureOperator(ThreadedOpr* threaded_opr,
+                                     Context exec_ctx,
+                                     int priority,
+                                     bool profiling) {
+  CaptureStatus& capture = *CaptureStatusStore::Get();
+  ThreadedGraph::Node node;
+  node.opr               = ThreadedOpr::New();
+  node.opr->fn           = threaded_opr->fn;
+  node.opr->const_vars   = threaded_opr->const_vars;
+  node.opr->mutable_vars = threaded_opr->mutable_vars;
+  node.opr->prop         = threaded_opr->prop;
+  node.opr->opr_name     = threaded_opr->opr_name;
+  node.ctx               = exec_ctx;
+  node.priority          = priority;
+  node.profiling         = profiling;
+  capture.vars.insert(node.opr->const_vars.begin(), node.opr->const_vars.end());
+  capture.vars.insert(node.opr->mutable_vars.begin(), node.opr->mutable_vars.end());
+  capture.graph->nodes.push_back(std::move(node));
+}
+
+void ThreadedEngine::BeginCapture() {
+  BulkFlush();
+  CaptureStatus& capture = *CaptureStatusStore::Get();
+  CHECK(!capture.graph) << "BeginCapture called while already capturing";
+  capture.graph.reset(new ThreadedGraph());
+  capture.vars.clear();
+  capture.invalid = false;
+}
+
+GraphHandle ThreadedEngine::EndCapture() {
+  // pending bulked operations belong to the capture
+  BulkFlush();
+  CaptureStatus& capture = *CaptureStatusStore::Get();
+  CHECK(capture.graph) << "EndCapture called without BeginCapture";
+  std::unique_ptr<ThreadedGraph> graph = std::move(capture.graph);
+  capture.vars.clear();
+  std::vector<ThreadedGraph::Node>& nodes = graph->nodes;
+  if (capture.invalid) {
+    LOG(WARNING) << "A variable used by the captured operations was deleted during the capture, "
+                 << "the graph cannot be replayed";
+    for (auto& node : nodes) {
+      ThreadedOpr::Delete(node.opr);
+    }
+    return nullptr;
+  }
+  // resolve dependencies in push order: readers wait for the last writer,
+  // writers wait for the readers since the last write, or for the last writer
+  struct VarState {
+    int64_t writer{-1};
+    std::vector<uint32_t> readers;
+  };
+  std::unordered_map<ThreadedVar*, VarState> var_states;
+  for (uint32_t i = 0; i < nodes.size(); ++i) {
+    for (auto&& v : nodes[i].opr->const_vars) {
+      VarState& state = var_states[v];
+      if (state.writer >= 0) {
+        nodes[state.writer].outputs.push_back(i);
+      }
+      state.readers.push_back(i);
+    }
+    for (auto&& v : nodes[i].opr->mutable_vars) {
+      VarState& state = var_states[v];
+      if (!state.readers.empty()) {
+        for (uint32_t r : state.readers) {
+          nodes[r].outputs.push_back(i);
+        }
+        state.readers.clear();
+      } else if (state.writer >= 0) {
+        nodes[state.writer].outputs.push_back(i);
+      }
+      state.writer = i;
+    }
+  }
+  for (auto& node : nodes) {
+    std::sort(node.outputs.begin(), node.outputs.end());
+    node.outputs.resize(std::unique(node.outputs.begin(), node.outputs.end()) -
+                        node.outputs.begin());
+    for (uint32_t next : node.outputs) {
+      ++nodes[next].num_inputs;
+    }
+  }
+  for (uint32_t i = 0; i < nodes.size(); ++i) {
+    if (nodes[i].num_inputs == 0) {
+      graph->roots.push_back(i);
+    }
+  }
+  graph->wait.reset(new std::atomic<int>[nodes.size()]);
+  graph->var = NewVariable();
+  std::vector<VarHandle> const_vars, mutable_vars{graph->var};
+  for (auto&& kv : var_states) {
+    if (kv.second.writer >= 0) {
+      mutable_vars.push_back(kv.first);
+    } else {
+      const_vars.push_back(kv.first);
+    }
+  }
+  ThreadedGraph* ret = graph.release();
+  ret->gate          = NewOperator(
+      [this, ret](RunContext, CallbackOnStart on_start, CallbackOnComplete on_complete) {
+        on_start();
+        this->StartGraph(ret, on_complete);
+      },
+      const_vars,
+      mutable_vars,
+      FnProperty::kAsync,
+      "CapturedGraph");
+  return ret;
+}
+
+void ThreadedEngine::StartGraph(ThreadedGraph* graph, CallbackOnComplete on_complete) {
+  const size_t num_nodes = graph->nodes.size();
+  if (num_nodes == 0) {
+    on_complete();
+    return;
+  }
+  graph->on_complete = on_complete;
+  graph->remaining.store(static_cast<int>(num_nodes));
+  for (size_t i = 0; i < num_nodes; ++i) {
+    graph->wait[i].store(graph->nodes[i].num_inputs, std::memory_order_relaxed);
+    // exceptions of the previous replay were already propagated to the variables
+    graph->nodes[i].opr->opr_exception.reset();
+  }
+  for (uint32_t i : graph->roots) {
+    PushGraphNode(graph, i);
+  }
+}
+
+void ThreadedEngine::Replay(GraphHandle graph, int priority) {
+  CHECK(graph != nullptr) << "Cannot replay a null graph";
+  CHECK(!CaptureStatusStore::Get()->graph) << "Cannot replay a graph while capturing";
+  // the nodes are profiled as captured, the gate itself does no work
+  Push(ThreadedGraph::CastFromBase(graph)->gate, Context::CPU(), priority, false);
+}
+
+void ThreadedEngine::DeleteGraph(GraphHandle graph) {
+  ThreadedGraph* threaded_graph = ThreadedGraph::CastFromBase(graph);
+  ThreadedOpr* gate             = threaded_graph->gate;
+  ThreadedVar* var              = threaded_graph->var;
+  std::vector<VarHandle> deps;
+  deps.reserve(gate->const_vars.size() + gate->mutable_vars.size());
+  deps.insert(deps.end(), gate->const_vars.begin(), gate->const_vars.end());
+  deps.insert(deps.end(), gate->mutable_vars.begin(), gate->mutable_vars.end());
+  // same as DeleteOperator, wait until the last replay released all variables
+  this->PushAsync(
+      [threaded_graph](RunContext, CallbackOnStart on_start, CallbackOnComplete on_complete) {
+        on_start();
+        for (auto& node : threaded_graph->nodes) {
+          ThreadedOpr::Delete(node.opr);
+        }
+        ThreadedOpr::Delete(threaded_graph->gate);
+        delete threaded_graph;
+        on_complete();
+      },
+      Context::CPU(),
+      {},
+      deps,
+      FnProperty::kDeleteVar,
+      0,
+      "DeleteGraph");
+  DeleteVariable([](RunContext) {}, Context::CPU(), var);
+}
+
 inline void ThreadedEngine::ThrowException(ThreadedVar* threaded_var) {
   if (threaded_var->var_exception && *threaded_var->var_exception) {
     std::exception_ptr tmp       = *threaded_var->var_exception;
@@ -541,8 +825,32 @@ void ThreadedEngine::OnCompleteStatic(Engine* engine, void* opr_block_, const dm
   if (opr_block->profiling && threaded_opr->opr_name.size()) {
     // record operator end timestamp
     opr_block->opr_profile->stop();
+  } else if (opr_block->sample_start_time != 0) {
+    profiler::SamplingProfiler::Get()->Record(threaded_opr->opr_name,
+                                              opr_block->sample_start_time,
+                                              profiler::ProfileStat::NowInMicrosec());
+  }
+  if (opr_block->trace != nullptr) {
+    profiler::RequestTrace::Span span;
+    span.name_       = threaded_opr->opr_name.empty() ? "operator" : threaded_opr->opr_name;
+    span.kind_       = profiler::RequestTrace::kOperator;
+    span.span_id_    = profiler::RequestTrace::NewSpanId();
+    span.parent_id_  = opr_block->trace_parent;
+    span.start_      = opr_block->trace_start_time;
+    span.end_        = profiler::RequestTrace::NowInNanosec();
+    span.queue_      = opr_block->trace_ready_time - opr_block->trace_push_time;
+    span.dispatch_   = opr_block->trace_start_time - opr_block->trace_ready_time;
+    span.device_     = opr_block->ctx.dev_mask() == Context::kGPU
+                           ? "gpu(" + std::to_string(opr_block->ctx.dev_id) + ")"
+                           : "cpu";
+    opr_block->trace->AddSpan(std::move(span));
+    opr_block->trace.reset();
+  }
+  if (opr_block->graph != nullptr) {
+    static_cast<ThreadedEngine*>(engine)->OnCompleteGraphNode(opr_block);
+  } else {
+    static_cast<ThreadedEngine*>(engine)->OnComplete(threaded_opr);
   }
-  static_cast<ThreadedEngine*>(engine)->OnComplete(threaded_opr);
   OprBlock::Delete(opr_block);
 }
 
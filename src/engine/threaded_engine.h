@@ -30,19 +30,28 @@
 #include <dmlc/logging.h>
 #include <dmlc/omp.h>
 #include <mxnet/storage.h>
+#include <memory>
+#include <unordered_set>
 #include <vector>
 #include <functional>
 #include <condition_variable>
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <utility>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include "./engine_impl.h"
 #include "../profiler/profiler.h"
 #include "./openmp.h"
 #include "../common/object_pool.h"
 #include "../profiler/custom_op_profiler.h"
+#include "../profiler/metrics.h"
+#include "../profiler/request_trace.h"
+#include "../profiler/sampling_profiler.h"
+#include "../profiler/storage_profiler.h"
 
 namespace mxnet {
 namespace engine {
@@ -63,6 +72,7 @@ namespace engine {
 
 // Forward declarations
 struct ThreadedOpr;
+struct ThreadedGraph;
 
 /*! shared_ptr to exception_ptr, used for exception handling */
 typedef std::shared_ptr<std::exception_ptr> ExceptionRef;
@@ -86,6 +96,21 @@ struct OprBlock : public common::ObjectPoolAllocatable<OprBlock> {
   bool profiling{false};
   /*! \brief operator execution statistics */
   std::unique_ptr<profiler::ProfileOperator> opr_profile;
+  /*! \brief start time in microseconds of a sampled execution, 0 if it is not sampled */
+  uint64_t sample_start_time{0};
+  /*! \brief the replayed graph this block is a node of, nullptr for normal pushes */
+  ThreadedGraph* graph{nullptr};
+  /*! \brief index of the node in graph */
+  uint32_t node{0};
+  /*! \brief the request traced by the pushing thread, null if there is none */
+  std::shared_ptr<profiler::RequestTrace> trace;
+  /*! \brief span open on the pushing thread, the parent of the span of this operator */
+  uint64_t trace_parent{0};
+  /*! \brief nanoseconds since the unix epoch of the push, of the dependencies being
+   *  satisfied and of the start of the execution of a traced block */
+  uint64_t trace_push_time{0};
+  uint64_t trace_ready_time{0};
+  uint64_t trace_start_time{0};
   // define possible debug information
   DEFINE_ENGINE_DEBUG_INFO(OprBlock);
   /*!
@@ -98,6 +123,12 @@ struct OprBlock : public common::ObjectPoolAllocatable<OprBlock> {
     CHECK_GE(ret, 0);
     return ret;
   }
+  /*! \brief record that the dependencies are satisfied, call before dispatching */
+  inline void trace_ready() {
+    if (trace != nullptr) {
+      trace_ready_time = profiler::RequestTrace::NowInNanosec();
+    }
+  }
 };  // struct OprBlock
 
 /*!
@@ -168,7 +199,26 @@ class ThreadedVar final : public Var, public common::ObjectPoolAllocatable<Threa
   inline void SetToDelete();
   /*! \return whether this variable is ready to read. */
   inline bool ready_to_read();
-  inline size_t version() override;
+  size_t version() override;
+  /*! \return id of the variable, unique over the lifetime of the process */
+  inline uint64_t uid() const {
+    return uid_;
+  }
+  /*! \brief add the variable of a region of the data of this variable */
+  inline void AddRegionVar(ThreadedVar* var) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    region_vars_.push_back(var);
+    num_region_vars_.store(region_vars_.size());
+  }
+  /*! \return the number of the variables of the regions of the data of this variable */
+  inline size_t num_region_vars() const {
+    return num_region_vars_.load();
+  }
+  /*! \brief append the variables of the regions of the data of this variable to vars */
+  inline void AppendRegionVars(std::vector<ThreadedVar*>* vars) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    vars->insert(vars->end(), region_vars_.begin(), region_vars_.end());
+  }
   /*!
    * \brief Cast a Var pointer to ThreadedVar pointer
    * \param ptr pointer from base.
@@ -220,6 +270,14 @@ class ThreadedVar final : public Var, public common::ObjectPoolAllocatable<Threa
    * \brief If true, delete after operation completes.
    */
   bool to_delete_{false};
+  /*! \brief the variables of the disjoint regions of the data of this variable */
+  std::vector<ThreadedVar*> region_vars_;
+  /*! \brief size of region_vars_, read without the lock when pushing */
+  std::atomic<size_t> num_region_vars_{0};
+  /*! \brief unique id, the addresses of variables are reused by the object pool */
+  const uint64_t uid_;
+  /*! \brief next unique id */
+  static std::atomic<uint64_t> next_uid_;
   /*! \brief special const on num_pending_reads_ to mark write being triggered */
   static constexpr int kWriteTriggered = -1;
   /*!
@@ -272,6 +330,108 @@ struct ThreadedOpr final : public Opr, public common::ObjectPoolAllocatable<Thre
   ExceptionRef opr_exception;
 };  // struct ThreadedOpr
 
+/*!
+ * \brief Sequence of operations captured by ThreadedEngine.
+ *  The dependencies between the nodes are resolved at capture time. A replay
+ *  pushes only the gate operator, which reads and mutates every variable of
+ *  the graph; once it runs, the nodes trigger each other through precomputed
+ *  wait counts without touching the variable queues, and the last node
+ *  completes the gate.
+ */
+struct ThreadedGraph final : public Graph {
+  /*! \brief a captured operation */
+  struct Node {
+    /*! \brief copy of the pushed operator, owned by the graph */
+    ThreadedOpr* opr{nullptr};
+    Context ctx;
+    int priority{0};
+    bool profiling{false};
+    /*! \brief number of nodes this node has to wait for */
+    int num_inputs{0};
+    /*! \brief nodes that wait for this node */
+    std::vector<uint32_t> outputs;
+  };
+  std::vector<Node> nodes;
+  /*! \brief nodes without inputs, started by the gate */
+  std::vector<uint32_t> roots;
+  /*! \brief operator pushed by each replay */
+  ThreadedOpr* gate{nullptr};
+  /*! \brief private variable mutated by the gate, serializes replays and deletion */
+  ThreadedVar* var{nullptr};
+  /*!
+   * \brief state of the running replay, replays are serialized through var
+   *  so it can be reused.
+   */
+  std::unique_ptr<std::atomic<int>[]> wait;
+  std::atomic<int> remaining{0};
+  CallbackOnComplete on_complete;
+  /*!
+   * \brief Cast a Graph pointer to ThreadedGraph pointer
+   * \param ptr pointer from base.
+   * \return a casted pointer.
+   */
+  inline static ThreadedGraph* CastFromBase(Graph* ptr) {
+    return ptr->Cast<ThreadedGraph>();
+  }
+};  // struct ThreadedGraph
+
+/*!
+ * \brief Adaptive bulk size of one bulking scope, e.g. the forward pass of a CachedOp.
+ *  Bulks report how long their operations took, and the size is chosen so that
+ *  a bulk runs for about a target duration. When few operations are queued in the
+ *  engine the size is halved, so that independent work is not serialized.
+ */
+struct BulkTuner {
+  BulkTuner(const std::string& name, profiler::ProfileDomain* domain)
+      : counter(("Bulk size: " + name).c_str(), domain) {}
+  /*! \brief record the execution of a bulk, called by the worker that ran it */
+  inline void Record(size_t num_ops, int64_t elapsed_ns) {
+    exec_ops.fetch_add(static_cast<int64_t>(num_ops), std::memory_order_relaxed);
+    exec_ns.fetch_add(elapsed_ns, std::memory_order_relaxed);
+  }
+  /*!
+   * \brief choose the size of the next bulks, called when a bulk is flushed
+   * \param max_size the configured bulk size, upper bound of the result
+   * \param queue_depth number of operations pending in the engine
+   * \param target_ns target execution time of a bulk
+   */
+  inline void Update(int max_size, int queue_depth, int64_t target_ns) {
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock())
+      return;
+    const int64_t ops = exec_ops.exchange(0, std::memory_order_relaxed);
+    const int64_t ns  = exec_ns.exchange(0, std::memory_order_relaxed);
+    if (ops > 0) {
+      const double op_ns = static_cast<double>(ns) / ops;
+      avg_op_ns          = avg_op_ns > 0 ? 0.8 * avg_op_ns + 0.2 * op_ns : op_ns;
+    }
+    int64_t target = max_size;
+    if (avg_op_ns > 0) {
+      target = std::min<int64_t>(static_cast<int64_t>(target_ns / avg_op_ns), max_size);
+    }
+    if (queue_depth < kMinQueueDepth) {
+      target /= 2;
+    }
+    const int new_size = static_cast<int>(std::max<int64_t>(target, 1));
+    if (new_size != size.load(std::memory_order_relaxed)) {
+      size.store(new_size, std::memory_order_relaxed);
+      counter = static_cast<uint64_t>(new_size);
+    }
+  }
+  /*! \brief below this number of pending operations the engine is considered idle */
+  static constexpr int kMinQueueDepth = 2;
+  /*! \brief tuned bulk size, 0 until the first update */
+  std::atomic<int> size{0};
+  /*! \brief operations and their execution time since the last update */
+  std::atomic<int64_t> exec_ops{0};
+  std::atomic<int64_t> exec_ns{0};
+  /*! \brief moving average of the execution time of one operation, guarded by mutex */
+  double avg_op_ns{0};
+  std::mutex mutex;
+  /*! \brief exposes the tuned size to the profiler */
+  profiler::ProfileCounter counter;
+};  // struct BulkTuner
+
 /*!
  * \brief Base class of all ThreadedEngine.
  *  This class implements a thread safe version of engine.
@@ -285,6 +445,7 @@ class ThreadedEngine : public Engine {
  public:
   // implementing all the functions from Engine.
   ThreadedVar* NewVariable() override;
+  VarHandle NewRegionVariable(VarHandle var) override;
   ThreadedOpr* NewOperator(AsyncFn fn,
                            std::vector<VarHandle> const& const_vars,
                            std::vector<VarHandle> const& mutable_vars,
@@ -312,12 +473,18 @@ class ThreadedEngine : public Engine {
   void WaitForVar(VarHandle var) override;
   void WaitForAll() override;
   void Throw(VarHandle var) override;
+  void BeginCapture() override;
+  GraphHandle EndCapture() override;
+  void Replay(GraphHandle graph, int priority = 0) override;
+  void DeleteGraph(GraphHandle graph) override;
   void NotifyShutdown() override {
     shutdown_phase_.store(true);
   }
 
   ThreadedEngine() {
-    engine_info_ = dmlc::GetEnv("MXNET_ENGINE_INFO", false);
+    engine_info_    = dmlc::GetEnv("MXNET_ENGINE_INFO", false);
+    adaptive_bulk_  = dmlc::GetEnv("MXNET_EXEC_BULK_EXEC_ADAPTIVE", false);
+    bulk_target_ns_ = dmlc::GetEnv("MXNET_EXEC_BULK_EXEC_ADAPTIVE_TARGET_US", 200) * 1000LL;
 
     objpool_opr_ref_    = common::ObjectPool<ThreadedOpr>::_GetSharedRef();
     objpool_blk_ref_    = common::ObjectPool<OprBlock>::_GetSharedRef();
@@ -328,8 +495,16 @@ class ThreadedEngine : public Engine {
 
     // Get a ref to the profiler so that it doesn't get killed before us
     profiler::Profiler::Get(&profiler_);
+    metrics_collector_ =
+        profiler::Metrics::Get()->AddCollector([this](profiler::MetricsWriter* writer) {
+          writer->Gauge("mxnet_engine_pending_ops",
+                        "Operators pushed to the engine that have not completed.",
+                        {},
+                        pending_.load());
+        });
   }
   ~ThreadedEngine() {
+    profiler::Metrics::Get()->RemoveCollector(metrics_collector_);
     {
       std::unique_lock<std::mutex> lock{finished_m_};
       kill_.store(true);
@@ -347,6 +522,23 @@ class ThreadedEngine : public Engine {
    * \param pusher_thread whether the caller is the thread that calls push
    */
   virtual void PushToExecute(OprBlock* opr_block, bool pusher_thread) = 0;
+  /*!
+   * \brief The variables an operator reads and writes with their versions, for the profiler
+   * \param threaded_opr the operator, about to be executed
+   */
+  static profiler::ProfileOperator::Dependencies* GetDependencies(ThreadedOpr* threaded_opr) {
+    auto* dependencies = new profiler::ProfileOperator::Dependencies();
+    dependencies->reads_.reserve(threaded_opr->const_vars.size());
+    for (ThreadedVar* var : threaded_opr->const_vars) {
+      dependencies->reads_.emplace_back(var->uid(), var->version());
+    }
+    // the write completes once the operator does, producing the next version
+    dependencies->writes_.reserve(threaded_opr->mutable_vars.size());
+    for (ThreadedVar* var : threaded_opr->mutable_vars) {
+      dependencies->writes_.emplace_back(var->uid(), var->version() + 1);
+    }
+    return dependencies;
+  }
   /*!
    * \brief Call this function to actually execute an opr_block
    *  This function also deletes the opr_block after execution.
@@ -358,6 +550,8 @@ class ThreadedEngine : public Engine {
                        CallbackOnStart on_start,
                        CallbackOnComplete callback) {
     ThreadedOpr* threaded_opr = opr_block->opr;
+    // the operator collecting the work reported by the operator function, see FOpCost
+    profiler::ProfileOperator* cost_profile = nullptr;
     if (opr_block->profiling && threaded_opr->opr_name.size()) {
       std::unique_ptr<profiler::ProfileOperator::Attributes> attrs;
       if (profiler_->AggregateEnabled()) {
@@ -366,7 +560,19 @@ class ThreadedEngine : public Engine {
       const Context& ctx = opr_block->ctx;
       opr_block->opr_profile.reset(
           new profiler::ProfileOperator(threaded_opr->opr_name.c_str(), attrs.release()));
+      if (profiler_->DependenciesEnabled()) {
+        opr_block->opr_profile->SetDependencies(GetDependencies(threaded_opr));
+      }
       opr_block->opr_profile->startForDevice(ctx.dev_type, ctx.dev_id);
+      if (profiler_->AggregateEnabled()) {
+        cost_profile = opr_block->opr_profile.get();
+      }
+    } else if (threaded_opr->opr_name.size() &&
+               profiler::SamplingProfiler::Get()->ShouldSample()) {
+      opr_block->sample_start_time = profiler::ProfileStat::NowInMicrosec();
+    }
+    if (opr_block->trace != nullptr) {
+      opr_block->trace_start_time = profiler::RequestTrace::NowInNanosec();
     }
     const bool debug_info = (engine_info_ && debug_push_opr_ == opr_block);
     if (debug_info) {
@@ -383,12 +589,18 @@ class ThreadedEngine : public Engine {
           if ((!(threaded_opr->opr_exception && *threaded_opr->opr_exception) ||
                threaded_opr->prop == FnProperty::kNoSkip) ||
               threaded_opr->wait) {
+            profiler::MemoryTimeline::Scope memory_scope(
+                threaded_opr->opr_name.empty() ? nullptr : threaded_opr->opr_name.c_str(), false);
+            // opr_block may be deleted by the callback, only the pointer is reset after fn
+            profiler::ProfileOperator::Current() = cost_profile;
             threaded_opr->fn(run_ctx, on_start, callback);
+            profiler::ProfileOperator::Current() = nullptr;
           } else {
             on_start();
             callback();
           }
         } catch (const std::exception& e) {
+          profiler::ProfileOperator::Current() = nullptr;
           on_start();
           threaded_opr->opr_exception =
               std::make_shared<std::exception_ptr>(std::current_exception());
@@ -434,6 +646,19 @@ class ThreadedEngine : public Engine {
     return bulk_size;
   }
 
+  std::string set_bulk_scope(std::string scope) override {
+    if (!adaptive_bulk_)
+      return std::string();
+    BulkStatus& bulk_status = *BulkStatusStore::Get();
+    if (scope == bulk_status.scope)
+      return scope;
+    // operations of different scopes are tuned separately
+    BulkFlush();
+    std::swap(bulk_status.scope, scope);
+    bulk_status.tuner = bulk_status.scope.empty() ? nullptr : GetBulkTuner(bulk_status.scope);
+    return scope;
+  }
+
  protected:
   static void OnStartStatic(Engine* engine, void* opr_block, const dmlc::Error* error);
   static void OnCompleteStatic(Engine* engine, void* threaded_opr, const dmlc::Error* error);
@@ -465,9 +690,24 @@ class ThreadedEngine : public Engine {
     std::vector<VarHandle> const_vars;
     /*! \brief mutable variables */
     std::vector<VarHandle> mutable_vars;
+    /*! \brief current scope of adaptive bulking */
+    std::string scope;
+    /*! \brief tuner of the current scope, nullptr if not adaptive */
+    std::shared_ptr<BulkTuner> tuner;
   };
   /*! thread local store for bulk */
   typedef dmlc::ThreadLocalStore<BulkStatus> BulkStatusStore;
+  /*! \brief structure for holding graph capture status */
+  struct CaptureStatus {
+    /*! \brief graph being captured, nullptr if not capturing */
+    std::unique_ptr<ThreadedGraph> graph;
+    /*! \brief variables used by the captured operations */
+    std::unordered_set<ThreadedVar*> vars;
+    /*! \brief whether a variable in vars was deleted during the capture */
+    bool invalid{false};
+  };
+  /*! thread local store for graph capture */
+  typedef dmlc::ThreadLocalStore<CaptureStatus> CaptureStatusStore;
 
   /*!
    * \brief check if thee is duplication in const_vars and mutable_vars.
@@ -476,12 +716,43 @@ class ThreadedEngine : public Engine {
    */
   void CheckDuplicate(std::vector<VarHandle> const& const_vars,
                       std::vector<VarHandle> const& mutable_vars);
+  /*!
+   * \brief add the region variables of the variables of an operator to its dependencies,
+   *  an operator reading or mutating the whole data reads or mutates all of its regions.
+   * \param const_vars the variables to read from.
+   * \param mutable_vars the variables to mutate.
+   * \return whether there were region variables to add.
+   */
+  static bool AddRegionVars(std::vector<ThreadedVar*>* const_vars,
+                            std::vector<ThreadedVar*>* mutable_vars);
   /*!
    * \brief Callback on operation completion.
    *
    * On operation completion, this will trigger subsequent operations.
    */
   inline void OnComplete(ThreadedOpr* threaded_opr);
+  /*!
+   * \brief Callback on completion of a node of a replayed graph.
+   *
+   * Triggers the nodes that wait for it, and completes the gate after the last node.
+   */
+  inline void OnCompleteGraphNode(OprBlock* opr_block);
+  /*! \brief record a pushed operator into the graph being captured */
+  void CaptureOperator(ThreadedOpr* threaded_opr, Context exec_ctx, int priority, bool profiling);
+  /*! \brief start the nodes of a graph, called by its gate operator */
+  void StartGraph(ThreadedGraph* graph, CallbackOnComplete on_complete);
+  /*! \brief push a node of a replayed graph to execution */
+  inline void PushGraphNode(ThreadedGraph* graph, uint32_t index) {
+    const ThreadedGraph::Node& node = graph->nodes[index];
+    OprBlock* opr_block  = OprBlock::New();
+    opr_block->opr       = node.opr;
+    opr_block->ctx       = node.ctx;
+    opr_block->priority  = node.priority;
+    opr_block->profiling = node.profiling;
+    opr_block->graph     = graph;
+    opr_block->node      = index;
+    this->PushToExecute(opr_block, false);
+  }
   /*!
    * \brief rethrow caught exception in WaitForVar
    * \param threaded_var the var that we are waiting to read
@@ -544,9 +815,24 @@ class ThreadedEngine : public Engine {
     bulk_status.mutable_vars.insert(
         bulk_status.mutable_vars.end(), mutable_vars.begin(), mutable_vars.end());
 
-    if (bulk_status.count >= bulk_status.bulk_size)
+    if (bulk_status.count >= MaxBulkCount(bulk_status))
       BulkFlush();
   }
+  /*! \brief number of operations after which the current bulk is flushed */
+  inline int MaxBulkCount(const BulkStatus& bulk_status) const {
+    const int tuned =
+        bulk_status.tuner ? bulk_status.tuner->size.load(std::memory_order_relaxed) : 0;
+    return tuned > 0 ? std::min(tuned, bulk_status.bulk_size) : bulk_status.bulk_size;
+  }
+  /*! \brief get or create the tuner of an adaptive bulking scope */
+  std::shared_ptr<BulkTuner> GetBulkTuner(const std::string& scope) {
+    std::lock_guard<std::mutex> lock(bulk_tuners_mutex_);
+    auto& tuner = bulk_tuners_[scope];
+    if (!tuner) {
+      tuner = std::make_shared<BulkTuner>(scope, &bulk_domain_);
+    }
+    return tuner;
+  }
   /*! \brief flush current bulk to execution */
   inline void BulkFlush() {
     BulkStatus& bulk_status = *BulkStatusStore::Get();
@@ -555,12 +841,22 @@ class ThreadedEngine : public Engine {
     bulk_status.count = 0;
     DeduplicateVarHandle(&bulk_status.const_vars, &bulk_status.mutable_vars);
     auto functions = bulk_status.functions;
+    auto tuner     = bulk_status.tuner;
     this->PushAsync(
-        [functions](RunContext ctx, CallbackOnStart on_start, CallbackOnComplete on_complete) {
+        [functions, tuner](
+            RunContext ctx, CallbackOnStart on_start, CallbackOnComplete on_complete) {
           on_start();
+          const auto start = tuner ? std::chrono::steady_clock::now() :
+                                     std::chrono::steady_clock::time_point();
           for (auto& fn : *functions) {
             fn(ctx);
           }
+          if (tuner) {
+            tuner->Record(functions->size(),
+                          std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now() - start)
+                              .count());
+          }
           on_complete();
         },
         bulk_status.ctx,
@@ -573,17 +869,31 @@ class ThreadedEngine : public Engine {
     bulk_status.functions->reserve(bulk_status.bulk_size);
     bulk_status.const_vars.clear();
     bulk_status.mutable_vars.clear();
+    if (tuner) {
+      tuner->Update(bulk_status.bulk_size, pending_.load(), bulk_target_ns_);
+    }
   }
   /*!
    * \brief Number of pending operations.
    */
   std::atomic<int> pending_{0};
+  /*! \brief id of the collector reporting pending_ to the metrics */
+  uint64_t metrics_collector_{0};
   /*! \brief whether we want to kill the waiters */
   std::atomic<bool> kill_{false};
   /*! \brief whether it is during shutdown phase*/
   std::atomic<bool> shutdown_phase_{false};
   /*!\brief show more information from engine actions */
   bool engine_info_{false};
+  /*! \brief whether bulk sizes are tuned per scope, see set_bulk_scope */
+  bool adaptive_bulk_{false};
+  /*! \brief target execution time of an adaptive bulk */
+  int64_t bulk_target_ns_{0};
+  /*! \brief profiler domain of the tuned bulk sizes */
+  profiler::ProfileDomain bulk_domain_{"Engine Bulk"};
+  /*! \brief tuners of all adaptive bulking scopes */
+  std::mutex bulk_tuners_mutex_;
+  std::unordered_map<std::string, std::shared_ptr<BulkTuner>> bulk_tuners_;
   /*! \brief debug information about wait for var. */
   std::atomic<ThreadedVar*> debug_wait_var_{nullptr};
   /*! \brief debug information about wait for var. */
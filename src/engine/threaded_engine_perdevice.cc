@@ -30,10 +30,16 @@
 
 #include <mutex>
 #include <memory>
+#include <type_traits>
 #include "../initialize.h"
 #include "./threaded_engine.h"
+#include "./scheduling_queue.h"
 #include "./thread_pool.h"
+#include "./work_stealing_queue.h"
+#include "./stream_manager.h"
+#include "./thread_budget.h"
 #include "../common/lazy_alloc_array.h"
+#include "../common/numa.h"
 #include "../common/utils.h"
 #include "../common/cuda/nvtx.h"
 
@@ -45,7 +51,8 @@ namespace engine {
  *  - Execute Async operation immediately if pushed from Pusher.
  *  - Use fixed amount of threads for each device.
  *  - Use special threads for copy operations.
- *  - Each stream is allocated and bound to each of the thread.
+ *  - Each thread is bound to a pool of streams, among which it spreads independent operators.
+ *  - Optionally, CPU workers of a device share tasks through work stealing.
  */
 class ThreadedEnginePerDevice : public ThreadedEngine {
  public:
@@ -56,15 +63,19 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
   static auto constexpr kWorkerQueue   = kFIFO;
   static int constexpr kMaxStreams     = 256;
 
-  ThreadedEnginePerDevice() noexcept(false) {
+  explicit ThreadedEnginePerDevice(bool work_stealing = false) noexcept(false)
+      : work_stealing_(work_stealing) {
 #if MXNET_USE_CUDA
     // Make sure that the pool is not destroyed before the engine
     objpool_gpu_sync_ref_ = common::ObjectPool<GPUWorkerSyncInfo>::_GetSharedRef();
     streams_.reserve(kMaxStreams);
 #endif
     this->Start();
+    queue_metrics_collector_ = profiler::Metrics::Get()->AddCollector(
+        [this](profiler::MetricsWriter* writer) { WriteQueueDepths(writer); });
   }
   ~ThreadedEnginePerDevice() noexcept(false) override {
+    profiler::Metrics::Get()->RemoveCollector(queue_metrics_collector_);
     this->StopNoWait();
   }
 
@@ -74,6 +85,7 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     gpu_priority_workers_.Clear();
     gpu_copy_workers_.Clear();
     cpu_normal_workers_.Clear();
+    cpu_stealing_workers_.Clear();
     cpu_priority_worker_.reset(nullptr);
 #if MXNET_USE_CUDA
     streams_.clear();
@@ -101,8 +113,10 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     if (is_worker_)
       return;
     gpu_worker_nthreads_ = common::GetNumThreadsPerGPU();
+    gpu_worker_nstreams_ = dmlc::GetEnv("MXNET_GPU_WORKER_STREAM_POOL_SIZE", 1);
     // MXNET_CPU_WORKER_NTHREADS
-    cpu_worker_nthreads_ = LibraryInitializer::Get()->cpu_worker_nthreads_;
+    cpu_worker_nthreads_ =
+        ThreadBudget::Get()->EngineWorkers(LibraryInitializer::Get()->cpu_worker_nthreads_);
     gpu_copy_nthreads_   = dmlc::GetEnv("MXNET_GPU_COPY_NTHREADS", 2);
     // create CPU task
     int cpu_priority_nthreads  = dmlc::GetEnv("MXNET_CPU_PRIORITY_NTHREADS", 4);
@@ -136,6 +150,22 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
         // CPU execution.
         if (opr_block->opr->prop == FnProperty::kCPUPrioritized) {
           cpu_priority_worker_->task_queue.Push(opr_block, opr_block->priority);
+        } else if (work_stealing_) {
+          int dev_id  = ctx.dev_id;
+          int nthread = cpu_worker_nthreads_;
+          auto ptr    = cpu_stealing_workers_.Get(dev_id, [this, ctx, nthread]() {
+            auto blk  = new WorkStealingWorkerBlock<OprBlock*>(nthread);
+            blk->pool = std::make_unique<ThreadPool>(
+                nthread,
+                [this, ctx, blk](std::shared_ptr<dmlc::ManualEvent> ready_event) {
+                  this->CPUStealingWorker(ctx, blk, ready_event);
+                },
+                true);
+            return blk;
+          });
+          if (ptr) {
+            ptr->Push(opr_block, opr_block->opr->prop == FnProperty::kDeleteVar);
+          }
         } else {
           int dev_id  = ctx.dev_id;
           int nthread = cpu_worker_nthreads_;
@@ -233,8 +263,10 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
   // working unit for each of the task.
   template <dmlc::ConcurrentQueueType type>
   struct ThreadWorkerBlock {
-    // task queue on this task
-    dmlc::ConcurrentBlockingQueue<OprBlock*, type> task_queue;
+    // task queue on this task, FIFO worker queues can order by priority at runtime
+    typename std::conditional<type == kFIFO,
+                              SchedulingQueue<OprBlock*>,
+                              dmlc::ConcurrentBlockingQueue<OprBlock*, type>>::type task_queue;
     // thread pool that works on this task
     std::unique_ptr<ThreadPool> pool;
     // constructor
@@ -243,16 +275,48 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     ~ThreadWorkerBlock() = default;
   };
 
+  /*! \brief report the number of operators waiting in each worker block */
+  void WriteQueueDepths(profiler::MetricsWriter* writer) {
+    auto write = [writer](const char* queue, const std::string& device, size_t depth) {
+      writer->Gauge("mxnet_engine_queue_depth",
+                    "Operators waiting in the task queue of an engine worker block.",
+                    {{"queue", queue}, {"device", device}},
+                    depth);
+    };
+    auto visit = [&write](const char* queue, const char* dev_type) {
+      return [&write, queue, dev_type](size_t dev_id, auto* block) {
+        write(queue,
+              std::string(dev_type) + "(" + std::to_string(dev_id) + ")",
+              block->task_queue.Size());
+      };
+    };
+    cpu_normal_workers_.ForEach(visit("normal", "cpu"));
+    gpu_normal_workers_.ForEach(visit("normal", "gpu"));
+    gpu_copy_workers_.ForEach(visit("copy", "gpu"));
+    gpu_priority_workers_.ForEach(visit("priority", "gpu"));
+    if (cpu_priority_worker_) {
+      write("priority", "cpu(0)", cpu_priority_worker_->task_queue.Size());
+    }
+  }
+
   /*! \brief whether this is a worker thread. */
   static MX_THREAD_LOCAL bool is_worker_;
+  /*! \brief whether CPU workers use work-stealing deques instead of a shared queue */
+  const bool work_stealing_;
   /*! \brief number of concurrent thread cpu worker uses */
   size_t cpu_worker_nthreads_;
   /*! \brief number of concurrent thread each gpu worker uses */
   size_t gpu_worker_nthreads_;
+  /*! \brief number of streams among which each gpu worker spreads independent operators */
+  size_t gpu_worker_nstreams_;
   /*! \brief number of concurrent thread each gpu copy worker uses */
   size_t gpu_copy_nthreads_;
+  /*! \brief id of the collector reporting the queue depths to the metrics */
+  uint64_t queue_metrics_collector_{0};
   // cpu worker
   common::LazyAllocArray<ThreadWorkerBlock<kWorkerQueue>> cpu_normal_workers_;
+  // cpu worker sharing tasks through work stealing
+  common::LazyAllocArray<WorkStealingWorkerBlock<OprBlock*>> cpu_stealing_workers_;
   // cpu priority worker
   std::unique_ptr<ThreadWorkerBlock<kPriorityQueue>> cpu_priority_worker_;
   // workers doing normal works on GPU
@@ -281,25 +345,21 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     this->is_worker_ = true;
 #if MXNET_USE_CUDA
     CHECK(block != nullptr);
-    mshadow::Stream<gpu>* stream = nullptr;
-    GPUAuxStream* aux_stream     = nullptr;
-    CUDAEventPool* event_pool    = nullptr;
+    std::unique_ptr<GPUWorkerStreamPool> streams;
+    CUDAEventPool* event_pool = nullptr;
     do {
       ThreadPool::SetReadyOnDestroy setReady(ready_event);
-      // allocate stream
+      // allocate streams
       mshadow::SetDevice<gpu>(ctx.dev_id);
-      if (is_copy_worker) {
-        stream = mshadow::NewStream<gpu>(false, false, ctx.dev_id);
-      } else {
-        stream     = mshadow::NewStream<gpu>(true, MXNET_USE_CUDNN != 0, ctx.dev_id);
-        aux_stream = new GPUAuxStream(stream);
-      }
+      streams = std::make_unique<GPUWorkerStreamPool>(
+          ctx.dev_id, is_copy_worker ? 1 : gpu_worker_nstreams_, is_copy_worker);
       // With thread safety...
       {
         static std::mutex m;
         std::lock_guard<std::mutex> lock(m);
-        // register stream
-        streams_.push_back(stream);
+        // register streams
+        for (size_t i = 0; i < streams->size(); ++i)
+          streams_.push_back(streams->stream(i));
         auto event_pool_it = cuda_event_pool_per_worker_.find(ctx.dev_id);
         if (event_pool_it != cuda_event_pool_per_worker_.end()) {
           event_pool = event_pool_it->second.get();
@@ -312,7 +372,6 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     } while (false);
     // execute task
     OprBlock* opr_block;
-    RunContext run_ctx{ctx, stream, aux_stream};
     auto* task_queue = &(block->task_queue);
 
     // Don't eat up omp threads for GPU jobs.  They're probably best used elsewhere,
@@ -327,9 +386,11 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
       auto color           = common::cuda::nvtx::nameToColor(nvtx_name, name_prefix_len);
       common::cuda::nvtx::gpuRangeStart(color, nvtx_name);
 #endif
+      const size_t i = streams->Assign(opr_block->opr->const_vars, opr_block->opr->mutable_vars);
+      RunContext run_ctx{ctx, streams->stream(i), streams->aux_stream(i)};
       auto* info                  = ThreadedEngine::GPUWorkerSyncInfo::New();
       info->opr_block             = opr_block;
-      info->stream                = stream;
+      info->stream                = streams->stream(i);
       info->event_pool            = event_pool;
       CallbackOnStart on_start    = this->CreateOnStart(ThreadedEngine::OnStartGPU, info);
       CallbackOnComplete callback = this->CreateCallback(ThreadedEngine::OnCompleteGPU, info);
@@ -353,6 +414,11 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     this->is_worker_ = true;
     auto* task_queue = &(block->task_queue);
     RunContext run_ctx{ctx, nullptr, nullptr};
+    // priority workers serve every device, only the per-device workers are pinned
+    if (type == kWorkerQueue && ctx.dev_mask() == Context::kCPU) {
+      ThreadBudget::Get()->PinComputeThread(
+          common::NumaTopology::Get()->NodeOfDevice(ctx.dev_id));
+    }
 
     // execute task
     OprBlock* opr_block;
@@ -369,6 +435,39 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
 #endif
       CallbackOnComplete callback =
           this->CreateCallback(ThreadedEngine::OnCompleteStatic, opr_block);
+      ThreadBudget::OperatorScope budget_scope(ThreadBudget::Get());
+      this->ExecuteOprBlock(run_ctx, opr_block, on_start, callback);
+    }
+  }
+
+  /*!
+   * \brief CPU worker that executes tasks of its own deque and steals from its peers.
+   * \param block The work-stealing block of the worker.
+   */
+  inline void CPUStealingWorker(Context ctx,
+                                WorkStealingWorkerBlock<OprBlock*>* block,
+                                const std::shared_ptr<dmlc::ManualEvent>& ready_event) {
+    this->is_worker_   = true;
+    const size_t index = block->RegisterWorker();
+    RunContext run_ctx{ctx, nullptr, nullptr};
+    ThreadBudget::Get()->PinComputeThread(common::NumaTopology::Get()->NodeOfDevice(ctx.dev_id));
+
+    // execute task
+    OprBlock* opr_block;
+    ready_event->signal();
+
+    // Set default number of threads for OMP parallel regions initiated by this thread
+    OpenMP::Get()->on_start_worker_thread(true);
+
+    while (block->Pop(index, &opr_block)) {
+#if MXNET_USE_CUDA
+      CallbackOnStart on_start = this->CreateOnStart(ThreadedEngine::OnStartCPU, opr_block);
+#else
+      CallbackOnStart on_start = this->CreateOnStart(ThreadedEngine::OnStartStatic, opr_block);
+#endif
+      CallbackOnComplete callback =
+          this->CreateCallback(ThreadedEngine::OnCompleteStatic, opr_block);
+      ThreadBudget::OperatorScope budget_scope(ThreadBudget::Get());
       this->ExecuteOprBlock(run_ctx, opr_block, on_start, callback);
     }
   }
@@ -406,6 +505,8 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     SignalQueueForKill(&gpu_normal_workers_);
     SignalQueueForKill(&gpu_copy_workers_);
     SignalQueueForKill(&cpu_normal_workers_);
+    cpu_stealing_workers_.ForEach(
+        [](size_t i, WorkStealingWorkerBlock<OprBlock*>* block) { block->SignalForKill(); });
     if (cpu_priority_worker_) {
       cpu_priority_worker_->task_queue.SignalForKill();
     }
@@ -416,6 +517,10 @@ Engine* CreateThreadedEnginePerDevice() {
   return new ThreadedEnginePerDevice();
 }
 
+Engine* CreateThreadedEngineWorkStealing() {
+  return new ThreadedEnginePerDevice(true);
+}
+
 MX_THREAD_LOCAL bool ThreadedEnginePerDevice::is_worker_ = false;
 
 }  // namespace engine
@@ -0,0 +1,292 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file work_stealing_queue.h
+ * \brief Lock-free work-stealing deque and the worker block built on top of it.
+ */
+#ifndef MXNET_ENGINE_WORK_STEALING_QUEUE_H_
+#define MXNET_ENGINE_WORK_STEALING_QUEUE_H_
+
+#include <dmlc/base.h>
+#include <dmlc/logging.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "./thread_pool.h"
+
+namespace mxnet {
+namespace engine {
+
+/*!
+ * \brief Chase-Lev work-stealing deque.
+ *  The owner thread pushes and pops at the bottom without locking,
+ *  other threads steal from the top with a single CAS.
+ * \tparam T element type, must be trivially copyable (usually a pointer).
+ */
+template <typename T>
+class WorkStealingQueue {
+ public:
+  explicit WorkStealingQueue(int64_t capacity = 256) {
+    CHECK_GT(capacity, 0);
+    CHECK_EQ(capacity & (capacity - 1), 0) << "capacity must be a power of 2";
+    arrays_.emplace_back(new Array(capacity));
+    array_.store(arrays_.back().get(), std::memory_order_relaxed);
+  }
+  /*!
+   * \brief Push an element, only called by the owner thread.
+   */
+  void Push(T item) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    Array* a  = array_.load(std::memory_order_relaxed);
+    if (b - t > a->capacity - 1) {
+      a = Grow(a, b, t);
+    }
+    a->Put(b, item);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+  /*!
+   * \brief Pop the most recently pushed element, only called by the owner thread.
+   * \return false if the queue is empty.
+   */
+  bool Pop(T* out) {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Array* a  = array_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    *out = a->Get(b);
+    if (t == b) {
+      // last element, race against thieves
+      bool won = top_.compare_exchange_strong(
+          t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+  /*!
+   * \brief Steal the oldest element, can be called by any thread.
+   * \return false if the queue is empty or the steal lost a race.
+   */
+  bool Steal(T* out) {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b)
+      return false;
+    Array* a = array_.load(std::memory_order_acquire);
+    T item   = a->Get(t);
+    if (!top_.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return false;
+    }
+    *out = item;
+    return true;
+  }
+  /*! \return approximate number of elements in the queue */
+  int64_t Size() const {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    return b > t ? b - t : 0;
+  }
+
+ private:
+  /*! \brief circular buffer, old buffers are kept alive until destruction */
+  struct Array {
+    explicit Array(int64_t cap) : capacity(cap), mask(cap - 1), data(new std::atomic<T>[cap]) {}
+    inline T Get(int64_t i) const {
+      return data[i & mask].load(std::memory_order_relaxed);
+    }
+    inline void Put(int64_t i, T item) {
+      data[i & mask].store(item, std::memory_order_relaxed);
+    }
+    int64_t capacity;
+    int64_t mask;
+    std::unique_ptr<std::atomic<T>[]> data;
+  };
+  Array* Grow(Array* a, int64_t b, int64_t t) {
+    Array* next = new Array(a->capacity * 2);
+    for (int64_t i = t; i < b; ++i) {
+      next->Put(i, a->Get(i));
+    }
+    // thieves may still read from the old buffer, so it is retired rather than freed
+    arrays_.emplace_back(next);
+    array_.store(next, std::memory_order_release);
+    return next;
+  }
+  alignas(64) std::atomic<int64_t> top_{0};
+  alignas(64) std::atomic<int64_t> bottom_{0};
+  std::atomic<Array*> array_{nullptr};
+  /*! \brief all buffers ever allocated, only touched by the owner */
+  std::vector<std::unique_ptr<Array>> arrays_;
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingQueue);
+};
+
+/*!
+ * \brief A group of worker threads that share tasks through work stealing.
+ *  Each worker owns a lock-free deque. Tasks pushed by a worker of this block
+ *  go to its own deque; tasks pushed from other threads are spread round-robin
+ *  over small per-worker inboxes so pushers never serialize on a single lock.
+ *  Idle workers steal from their peers before going to sleep.
+ * \tparam T task type, must be trivially copyable (usually a pointer).
+ */
+template <typename T>
+class WorkStealingWorkerBlock {
+ public:
+  explicit WorkStealingWorkerBlock(size_t nworkers) : slots_(nworkers) {
+    CHECK_GT(nworkers, 0);
+    for (auto& slot : slots_) {
+      slot = std::make_unique<Slot>();
+    }
+  }
+  /*!
+   * \brief Register the calling thread as a worker of this block.
+   * \return the worker index to pass to Pop.
+   */
+  size_t RegisterWorker() {
+    size_t index = num_registered_.fetch_add(1);
+    CHECK_LT(index, slots_.size());
+    current_block_ = this;
+    current_index_ = index;
+    return index;
+  }
+  /*!
+   * \brief Push a task, can be called from any thread.
+   * \param item the task.
+   * \param front whether the task should be picked up as soon as possible.
+   */
+  void Push(T item, bool front = false) {
+    if (current_block_ == this && !front) {
+      slots_[current_index_]->deque.Push(item);
+    } else {
+      size_t index = next_inbox_.fetch_add(1, std::memory_order_relaxed) % slots_.size();
+      Slot* slot   = slots_[index].get();
+      std::lock_guard<std::mutex> lock(slot->inbox_mutex);
+      if (front) {
+        slot->inbox.push_front(item);
+      } else {
+        slot->inbox.push_back(item);
+      }
+    }
+    pending_.fetch_add(1);
+    if (num_sleeping_.load() > 0) {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      sleep_cond_.notify_one();
+    }
+  }
+  /*!
+   * \brief Get the next task for a worker, blocks until one is available.
+   * \param index the worker index returned by RegisterWorker.
+   * \return false if the block was signaled for kill.
+   */
+  bool Pop(size_t index, T* out) {
+    while (true) {
+      for (int spin = 0; spin < kSpinRounds; ++spin) {
+        if (kill_.load(std::memory_order_relaxed))
+          return false;
+        if (TryPop(index, out)) {
+          pending_.fetch_sub(1);
+          return true;
+        }
+        std::this_thread::yield();
+      }
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      num_sleeping_.fetch_add(1);
+      sleep_cond_.wait(lock, [this]() { return pending_.load() > 0 || kill_.load(); });
+      num_sleeping_.fetch_sub(1);
+    }
+  }
+  /*! \brief Wake up all workers and make Pop return false */
+  void SignalForKill() {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    kill_.store(true);
+    sleep_cond_.notify_all();
+  }
+  /*! \brief thread pool that works on this block */
+  std::unique_ptr<ThreadPool> pool;
+
+ private:
+  /*! \brief number of stealing rounds before a worker goes to sleep */
+  static constexpr int kSpinRounds = 16;
+  struct Slot {
+    WorkStealingQueue<T> deque;
+    std::mutex inbox_mutex;
+    std::deque<T> inbox;
+  };
+  static bool PopInbox(Slot* slot, T* out, bool blocking) {
+    std::unique_lock<std::mutex> lock(slot->inbox_mutex, std::defer_lock);
+    if (blocking) {
+      lock.lock();
+    } else if (!lock.try_lock()) {
+      return false;
+    }
+    if (slot->inbox.empty())
+      return false;
+    *out = slot->inbox.front();
+    slot->inbox.pop_front();
+    return true;
+  }
+  bool TryPop(size_t index, T* out) {
+    Slot* own = slots_[index].get();
+    // inbox first so that externally pushed and prioritized tasks are not starved
+    if (PopInbox(own, out, true) || own->deque.Pop(out))
+      return true;
+    const size_t n = slots_.size();
+    for (size_t i = 1; i < n; ++i) {
+      Slot* victim = slots_[(index + i) % n].get();
+      if (victim->deque.Steal(out) || PopInbox(victim, out, false))
+        return true;
+    }
+    return false;
+  }
+  std::vector<std::unique_ptr<Slot>> slots_;
+  std::atomic<size_t> num_registered_{0};
+  std::atomic<size_t> next_inbox_{0};
+  /*! \brief number of tasks pushed but not yet popped */
+  std::atomic<int64_t> pending_{0};
+  std::atomic<int> num_sleeping_{0};
+  std::atomic<bool> kill_{false};
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cond_;
+  /*! \brief block and worker index of the calling thread, if it is a worker */
+  static MX_THREAD_LOCAL WorkStealingWorkerBlock* current_block_;
+  static MX_THREAD_LOCAL size_t current_index_;
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingWorkerBlock);
+};
+
+template <typename T>
+MX_THREAD_LOCAL WorkStealingWorkerBlock<T>* WorkStealingWorkerBlock<T>::current_block_ = nullptr;
+template <typename T>
+MX_THREAD_LOCAL size_t WorkStealingWorkerBlock<T>::current_index_ = 0;
+
+}  // namespace engine
+}  // namespace mxnet
+#endif  // MXNET_ENGINE_WORK_STEALING_QUEUE_H_
@@ -97,12 +97,12 @@ class StorageFallbackOpExecutor : public OpExecutor {
                            &post_temp_dst_,
                            &in_temp_idx_map_,
                            mutate_idx_);
-    common::CastNonDefaultStorage(pre_temp_src_, pre_temp_dst_, op_ctx, is_gpu);
+    common::CastNonDefaultStorage(pre_temp_src_, pre_temp_dst_, op_ctx, is_gpu, &attrs);
   }
 
   // storage fallback after fcompute is completed
   void PostFCompute(bool is_gpu) {
-    common::CastNonDefaultStorage(post_temp_src_, post_temp_dst_, op_ctx, is_gpu);
+    common::CastNonDefaultStorage(post_temp_src_, post_temp_dst_, op_ctx, is_gpu, &attrs);
     req = tmp_req;
   }
 
@@ -132,6 +132,7 @@ class StatefulComputeExecutor : public StorageFallbackOpExecutor {
     op_ctx.run_ctx = rctx;
     INVALIDATE_OUTPUTS(out_array, req);
     PreFCompute(is_gpu);
+    imperative::RecordOpCost(attrs, in_data_, out_data_);
     fcompute_(state_, op_ctx, in_data_, req, out_data_);
     PostFCompute(is_gpu);
   }
@@ -173,6 +174,7 @@ class StatefulComputeExExecutor : public OpExecutor {
     INVALIDATE_OUTPUTS(out_array, req);
     std::vector<NDArray>* pInArray = &in_array;
     CREATE_DEFAULT_INPUTS_DNNL(in_array, pInArray = &in_array_fallback, attrs);
+    imperative::RecordOpCost(attrs, *pInArray, out_array);
     fcompute_(state_, op_ctx, *pInArray, req, out_array);
   }
 
@@ -214,6 +216,7 @@ class FComputeExecutor : public StorageFallbackOpExecutor {
     op_ctx.run_ctx = rctx;
     INVALIDATE_OUTPUTS(out_array, req);
     PreFCompute(is_gpu);
+    imperative::RecordOpCost(attrs, in_data_, out_data_);
     fcompute_(attrs, op_ctx, in_data_, req, out_data_);
     PostFCompute(is_gpu);
   }
@@ -244,6 +247,7 @@ class FComputeExExecutor : public OpExecutor {
     INVALIDATE_OUTPUTS(out_array, req);
     std::vector<NDArray>* pInArray = &in_array;
     CREATE_DEFAULT_INPUTS_DNNL(in_array, pInArray = &in_array_fallback, attrs);
+    imperative::RecordOpCost(attrs, *pInArray, out_array);
     fcompute_(attrs, op_ctx, *pInArray, req, out_array);
   }
 
@@ -63,7 +63,7 @@ void AttachOpResources(const Graph& g,
             if (cached_temp.count(ctx) != 0) {
               requested.push_back(cached_temp.at(ctx));
             } else {
-              Resource r = ResourceManager::Get()->Request(ctx, req);
+              Resource r = ResourceManager::Get()->RequestOpTempSpace(ctx);
               requested.push_back(r);
               cached_temp[ctx] = r;
             }
@@ -91,7 +91,7 @@ void AttachOpResources(const Graph& g,
     }
     // extra resource requests for storage fallback
     if (vdispatch[nid] == DispatchMode::kFComputeFallback) {
-      requested.push_back(ResourceManager::Get()->Request(ctx, ResourceRequest::kTempSpace));
+      requested.push_back(ResourceManager::Get()->RequestOpTempSpace(ctx));
     }
   }
 }
@@ -16,13 +16,23 @@
  * specific language governing permissions and limitations
  * under the License.
  */
+#include <algorithm>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <sstream>
+#include <tuple>
 #include <unordered_set>
 #include <iostream>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // _WIN32
 #include "./imperative_utils.h"
 #include "./cached_op.h"
 #include "./exec_pass.h"
 #include "../profiler/profiler.h"
+#include "../profiler/request_trace.h"
 #include "../operator/operator_common.h"
 #include "../operator/subgraph/common.h"
 
@@ -32,6 +42,167 @@ DMLC_REGISTER_PARAMETER(CachedOpConfig);
 
 constexpr uint32_t kEidNotExist = std::numeric_limits<uint32_t>::max();
 
+namespace {
+
+/*!
+ * \brief The storage shared by the static allocations of the cached ops of a memory group on a
+ *        context. The i-th largest storage of a pass of each cached op is the i-th buffer of the
+ *        group, grown to the largest of them. The engine variables of the buffers order the
+ *        passes of the cached ops sharing them.
+ */
+class MemoryGroup {
+ public:
+  static std::shared_ptr<MemoryGroup> Get(const std::string& name,
+                                          const Context& ctx,
+                                          bool backward) {
+    static std::mutex mutex;
+    static std::map<std::tuple<std::string, Context, bool>, std::shared_ptr<MemoryGroup>> groups;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& group = groups[std::make_tuple(name, ctx, backward)];
+    if (!group)
+      group = std::make_shared<MemoryGroup>();
+    return group;
+  }
+
+  /*! \brief the pool of the buffers of the group for the storage sizes of a pass */
+  std::multimap<size_t, NDArray> Acquire(std::vector<size_t> sizes, const Context& ctx) {
+    std::sort(sizes.begin(), sizes.end(), std::greater<size_t>());
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::multimap<size_t, NDArray> pool;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      if (i == buffers_.size())
+        buffers_.emplace_back();
+      // the cached ops holding the smaller buffer keep it until they allocate again
+      if (buffers_[i].is_none() || buffers_[i].shape().Size() < sizes[i]) {
+        buffers_[i] = NDArray(mxnet::TShape({static_cast<nnvm::dim_t>(sizes[i])}),
+                              ctx,
+                              true,
+                              mshadow::kUint8);
+      }
+      pool.emplace(buffers_[i].shape().Size(), buffers_[i]);
+    }
+    return pool;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<NDArray> buffers_;
+};
+
+/*!
+ * \brief Positions of the forward inputs in the order of their first use by the operators,
+ *  only those of param_indices if it is set. The unused inputs are left out.
+ */
+std::vector<uint32_t> ParamPrefetchOrder(const nnvm::IndexedGraph& idx,
+                                         const mxnet::Tuple<uint32_t>& param_indices) {
+  std::unordered_map<uint32_t, uint32_t> positions;
+  for (uint32_t i = 0; i < idx.input_nodes().size(); ++i)
+    positions[idx.input_nodes()[i]] = i;
+  const std::unordered_set<uint32_t> params(param_indices.begin(), param_indices.end());
+  std::vector<bool> seen(idx.input_nodes().size(), false);
+  std::vector<uint32_t> order;
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    for (const auto& e : idx[nid].inputs) {
+      auto it = positions.find(e.node_id);
+      if (it == positions.end() || seen[it->second])
+        continue;
+      seen[it->second] = true;
+      if (params.empty() || params.count(it->second))
+        order.push_back(it->second);
+    }
+  }
+  return order;
+}
+
+/*!
+ * \brief Ask the kernel to read in the pages of the CPU inputs in order, e.g. of parameters
+ *  mapped from a file or swapped out. The reads are asynchronous, so that the first operators
+ *  run while the pages of the inputs of the later ones are read.
+ */
+void PrefetchParams(const std::vector<NDArray*>& inputs, const std::vector<uint32_t>& order) {
+#ifndef _WIN32
+  static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  // the ranges adjacent in memory are merged, as the arrays mapped from a file are
+  std::vector<std::pair<uintptr_t, uintptr_t>> ranges;
+  for (const uint32_t i : order) {
+    const NDArray& arr = *inputs[i];
+    if (arr.is_none() || arr.storage_type() != kDefaultStorage ||
+        arr.ctx().dev_mask() != cpu::kDevMask || arr.shape().Size() == 0)
+      continue;
+    const uintptr_t addr  = reinterpret_cast<uintptr_t>(arr.data().dptr_);
+    const uintptr_t begin = addr / page_size * page_size;
+    const uintptr_t end   = addr + arr.shape().Size() * mshadow::mshadow_sizeof(arr.dtype());
+    if (!ranges.empty() && begin >= ranges.back().first && begin <= ranges.back().second)
+      ranges.back().second = std::max(ranges.back().second, end);
+    else
+      ranges.emplace_back(begin, end);
+  }
+  for (const auto& range : ranges) {
+    // a failure only loses the prefetch
+    madvise(reinterpret_cast<void*>(range.first), range.second - range.first, MADV_WILLNEED);
+  }
+#endif  // _WIN32
+}
+
+/*!
+ * \brief How each forward entry of full_graph may be compressed between forward and backward:
+ *  kCompressReLU if its backward uses only read its sign, as the backward of ReLU does from
+ *  its output, kCompressFloat16 if they tolerate a rounded value, kCompressNone otherwise or
+ *  if backward does not use it. The lossy uses are those of a list of backward operators
+ *  computing gradients from the values of their inputs, not from comparisons or indices.
+ */
+std::vector<int> ActivationCompressionModes(const nnvm::IndexedGraph& fwd_idx,
+                                            const nnvm::IndexedGraph& full_idx) {
+  static const std::unordered_set<std::string> lossy_ops = {"_backward_Activation",
+                                                            "_backward_BatchNorm",
+                                                            "_backward_Convolution",
+                                                            "_backward_Deconvolution",
+                                                            "_backward_FullyConnected",
+                                                            "_backward_LayerNorm",
+                                                            "_backward_batch_dot",
+                                                            "_backward_dot",
+                                                            "_backward_mul",
+                                                            "_backward_relu",
+                                                            "_backward_sigmoid",
+                                                            "_backward_softmax",
+                                                            "_backward_tanh"};
+  std::vector<int> modes(fwd_idx.num_node_entries(), kCompressNone);
+  std::vector<bool> lossy_only(fwd_idx.num_node_entries(), true);
+  std::vector<bool> sign_only(fwd_idx.num_node_entries(), true);
+  std::vector<bool> used(fwd_idx.num_node_entries(), false);
+  for (uint32_t nid = fwd_idx.num_nodes(); nid < full_idx.num_nodes(); ++nid) {
+    const nnvm::Node* node = full_idx[nid].source;
+    if (node->op() == nullptr)
+      continue;
+    const std::string& name = node->op()->name;
+    auto act_type           = node->attrs.dict.find("act_type");
+    const bool relu_backward =
+        name == "_backward_relu" ||
+        (name == "_backward_Activation" && act_type != node->attrs.dict.end() &&
+         act_type->second == "relu");
+    for (size_t i = 0; i < full_idx[nid].inputs.size(); ++i) {
+      const uint32_t eid = full_idx.entry_id(full_idx[nid].inputs[i]);
+      if (eid >= modes.size())
+        continue;
+      used[eid] = true;
+      // the output of ReLU is the second input of its backward, after the output gradient
+      sign_only[eid] = sign_only[eid] && relu_backward && i == 1;
+      lossy_only[eid] = lossy_only[eid] && lossy_ops.count(name);
+    }
+  }
+  for (uint32_t eid = 0; eid < modes.size(); ++eid) {
+    if (used[eid] && sign_only[eid])
+      modes[eid] = kCompressReLU;
+    else if (used[eid] && lossy_only[eid])
+      modes[eid] = kCompressFloat16;
+  }
+  for (const auto& e : fwd_idx.outputs())
+    modes[fwd_idx.entry_id(e)] = kCompressNone;
+  return modes;
+}
+
+}  // namespace
+
 nnvm::Symbol CachedOp::GetOptimizedSymbol() const {
   nnvm::Symbol ret;
   ret.outputs = std::vector<nnvm::NodeEntry>(full_graph_.outputs.begin(),
@@ -66,6 +237,9 @@ CachedOp::CachedOp(const nnvm::Symbol& sym,
   }
 
   SetInputIndices(fwd_graph_, config_.param_indices, &config_.data_indices);
+  if (config_.prefetch_params) {
+    prefetch_order_ = ParamPrefetchOrder(fwd_graph_.indexed_graph(), config_.param_indices);
+  }
 
   // Set the backward dependency vectors
   {
@@ -90,6 +264,15 @@ CachedOp::CachedOp(const nnvm::Symbol& sym,
   }
 
   SetRefCounts(&fwd_graph_, full_graph_);
+  if (config_.compress_activations != kCompressNone) {
+    compression_modes_ =
+        ActivationCompressionModes(fwd_graph_.indexed_graph(), full_graph_.indexed_graph());
+  }
+
+  const std::vector<std::string> outputs = ListForwardOutputNames();
+  const std::string name                 = outputs.empty() ? std::string() : outputs[0];
+  fwd_bulk_scope_                        = "CachedOp " + name + " forward";
+  bwd_bulk_scope_                        = "CachedOp " + name + " backward";
 }
 
 CachedOp::~CachedOp() = default;
@@ -166,6 +349,298 @@ bool CachedOp::CheckDynamicShapeExists(const Context& default_ctx,
   return contain_dynamic_shape;
 }
 
+namespace {
+
+/*! \brief signature of the forward inputs, key of the plan caches */
+GraphAttrCache::Key PlanCacheKey(const mxnet::ShapeVector& shapes,
+                                 const nnvm::DTypeVector& dtypes,
+                                 const StorageTypeVector& stypes) {
+  GraphAttrCache::Key key;
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    key.push_back(shapes[i].ndim());
+    for (int j = 0; j < shapes[i].ndim(); ++j)
+      key.push_back(shapes[i][j]);
+    key.push_back(dtypes[i]);
+    key.push_back(stypes[i]);
+  }
+  return key;
+}
+
+/*! \brief round every nonzero dimension up to the next bucket boundary, if there is one */
+mxnet::TShape BucketShape(mxnet::TShape shape, const mxnet::Tuple<uint32_t>& buckets) {
+  for (int j = 0; j < shape.ndim(); ++j) {
+    if (shape[j] <= 0)
+      continue;
+    for (const uint32_t b : buckets) {
+      if (static_cast<dim_t>(b) >= shape[j]) {
+        shape[j] = b;
+        break;
+      }
+    }
+  }
+  return shape;
+}
+
+/*!
+ * \brief Set the forward memory plan of g to the one made for the bucketed input
+ *  shapes, taken from the cache or planned on a copy of the graph.
+ * \return false if the bucketed shapes cannot be inferred or the plan does not fit g
+ */
+bool PlanBucketedMemory(nnvm::Graph* p_g,
+                        mxnet::ShapeVector&& bucket_shapes,
+                        const nnvm::StorageVector& storage,
+                        const std::string& prefix,
+                        const GraphAttrCache::Key& key,
+                        GraphAttrCache* cache,
+                        size_t cache_size) {
+  using namespace imperative;
+  nnvm::Graph& g                      = *p_g;
+  const std::string mem_plan_key      = AddPrefix(prefix, MEM_PLAN);
+  const std::string storage_plan_key  = AddPrefix(prefix, STORAGE_PLAN);
+  const GraphAttrCache::Attrs* cached = cache->Get(key);
+  GraphAttrCache::Attrs plan;
+  if (cached != nullptr)
+    plan = *cached;
+  if (!plan.count(mem_plan_key)) {
+    nnvm::Graph bg       = g;
+    bool contain_unknown = false;
+    try {
+      CheckAndInferShape(&bg, std::move(bucket_shapes), true, {0, 0}, {0, 0}, &contain_unknown);
+    } catch (const dmlc::Error& e) {
+      return false;
+    }
+    if (contain_unknown)
+      return false;
+    auto mem_plan = MXPlanMemory(&bg,
+                                 nnvm::StorageVector(storage),
+                                 bg.GetAttr<std::vector<uint32_t> >(AddPrefix(prefix, REF_COUNT)),
+                                 storage_plan_key);
+    plan[mem_plan_key]     = std::make_shared<dmlc::any>(std::move(mem_plan));
+    plan[storage_plan_key] = bg.attrs.at(storage_plan_key);
+    cache->Put(key, plan, cache_size);
+  }
+  // a plan made for larger shapes only fits if every entry stays within its storage,
+  // and the offsets of the slices in their storage only fit the shapes they were planned for
+  const auto& idx      = g.indexed_graph();
+  const auto& mem_plan = nnvm::get<MemoryPlanVector>(*plan.at(mem_plan_key));
+  const auto& shapes   = g.GetAttr<mxnet::ShapeVector>("shape");
+  const auto& dtypes   = g.GetAttr<nnvm::DTypeVector>("dtype");
+  for (uint32_t i = 0; i < idx.num_node_entries(); ++i) {
+    if (mem_plan[i].slice_offset >= 0)
+      return false;
+    if (mem_plan[i].storage_id >= 0 &&
+        mshadow::mshadow_sizeof(dtypes[i]) * shapes[i].Size() > mem_plan[mem_plan[i].root].size)
+      return false;
+  }
+  g.attrs[mem_plan_key]     = plan.at(mem_plan_key);
+  g.attrs[storage_plan_key] = plan.at(storage_plan_key);
+  return true;
+}
+
+/*! \brief whether the static segments of a state on ctx are run as CUDA graphs */
+bool UseCudaGraphs(const Context& ctx, bool static_shape) {
+#if CUDA_GRAPHS_AVAILABLE
+  return dmlc::GetEnv("MXNET_ENABLE_CUDA_GRAPHS", false) && static_shape && ctx.dev_mask() == gpu::kDevMask;
+#else
+  return false;
+#endif
+}
+
+/*!
+ * \brief Copy the earliest forward activations kept for backward in buff to pinned host memory,
+ *  and drop their device arrays, until the ones left on the device fit in budget bytes. The
+ *  entries sharing a storage are offloaded together, the storage being released with the last.
+ * \return the offloaded entries and their host copies
+ */
+std::vector<std::pair<uint32_t, NDArray>> OffloadActivations(std::vector<NDArray>* p_buff,
+                                                             size_t budget) {
+  // below this size, the latency of the transfers costs more than the memory saved
+  constexpr size_t kMinOffloadBytes = 64 << 10;
+  std::vector<NDArray>& buff        = *p_buff;
+  // bytes and entries of each kept storage, in the order of their first entry
+  std::vector<Engine::VarHandle> order;
+  std::unordered_map<Engine::VarHandle, std::pair<size_t, std::vector<uint32_t>>> storages;
+  size_t kept = 0;
+  for (uint32_t eid = 0; eid < buff.size(); ++eid) {
+    const NDArray& arr = buff[eid];
+    if (arr.is_none() || arr.storage_type() != kDefaultStorage)
+      continue;
+    auto& storage = storages[arr.var()];
+    if (storage.second.empty())
+      order.push_back(arr.var());
+    const size_t bytes = arr.shape().Size() * mshadow::mshadow_sizeof(arr.dtype());
+    if (bytes > storage.first) {
+      kept += bytes - storage.first;
+      storage.first = bytes;
+    }
+    storage.second.push_back(eid);
+  }
+  std::vector<std::pair<uint32_t, NDArray>> offloaded;
+  for (Engine::VarHandle var : order) {
+    if (kept <= budget)
+      break;
+    const auto& storage = storages.at(var);
+    if (storage.first < kMinOffloadBytes)
+      continue;
+    for (uint32_t eid : storage.second) {
+      const NDArray& arr = buff[eid];
+      NDArray host(arr.shape(), Context::CPUPinned(arr.ctx().dev_id), true, arr.dtype());
+      CopyFromTo(arr, host);
+      offloaded.emplace_back(eid, std::move(host));
+      buff[eid] = NDArray();
+    }
+    kept -= storage.first;
+  }
+  return offloaded;
+}
+
+/*!
+ * \brief Schedule the prefetch of the entries during the backward nodes of idx from
+ *  node_start, each after the operator distance operators ahead of its first use.
+ * \return pairs of the node the backward pass is pushed up to before a prefetch (node_start
+ *  for the prefetches issued first) and the index of the prefetched entry in entries,
+ *  ordered by node
+ */
+std::vector<std::pair<uint32_t, size_t>> SchedulePrefetches(const nnvm::IndexedGraph& idx,
+                                                            const uint32_t node_start,
+                                                            const std::vector<uint32_t>& entries,
+                                                            const uint32_t distance) {
+  std::unordered_map<uint32_t, size_t> pending;
+  for (size_t i = 0; i < entries.size(); ++i)
+    pending.emplace(entries[i], i);
+  std::vector<std::pair<uint32_t, size_t>> schedule;
+  std::vector<uint32_t> op_nodes;
+  for (uint32_t nid = node_start; nid < idx.num_nodes() && !pending.empty(); ++nid) {
+    if (idx[nid].source->op() == nullptr)
+      continue;
+    const size_t pos = op_nodes.size();
+    const uint32_t end =
+        distance > 0 && pos >= distance ? op_nodes[pos - distance] + 1 : node_start;
+    for (const auto& e : idx[nid].inputs) {
+      auto it = pending.find(idx.entry_id(e));
+      if (it != pending.end()) {
+        schedule.emplace_back(end, it->second);
+        pending.erase(it);
+      }
+    }
+    op_nodes.push_back(nid);
+  }
+  // entries without a backward use are restored at once, in case the graph is retained
+  for (const auto& p : pending)
+    schedule.emplace_back(node_start, p.second);
+  std::stable_sort(schedule.begin(), schedule.end(), [](const auto& a, const auto& b) {
+    return a.first < b.first;
+  });
+  return schedule;
+}
+
+/*!
+ * \brief Compress the forward activations kept for backward in buff, and drop their arrays.
+ *  The activations whose backward uses only read their sign are stored as bitmasks, the
+ *  others tolerating a rounded value as float16 or int8 blocks, following the mode of
+ *  compress_activations. The entries sharing a storage are compressed together, or not at all.
+ * \return the compressed entries
+ */
+std::vector<CachedOp::CompressedActivation> CompressActivations(
+    std::vector<NDArray>* p_buff,
+    const std::vector<int>& modes,
+    const int mode) {
+  // below this size, the kernels cost more than the memory saved
+  constexpr size_t kMinCompressBytes = 16 << 10;
+  static const nnvm::Op* compress_op = nnvm::Op::Get("_contrib_compress_activation");
+  static const auto& finfer_shape    = nnvm::Op::GetAttr<mxnet::FInferShape>("FInferShape");
+  static const auto& finfer_type     = nnvm::Op::GetAttr<nnvm::FInferType>("FInferType");
+  std::vector<NDArray>& buff         = *p_buff;
+  // compression of each entry, grouped by storage in the order of their first entry
+  std::vector<Engine::VarHandle> order;
+  std::unordered_map<Engine::VarHandle, std::vector<std::pair<uint32_t, std::string>>> storages;
+  std::unordered_set<Engine::VarHandle> excluded;
+  for (uint32_t eid = 0; eid < buff.size() && eid < modes.size(); ++eid) {
+    const NDArray& arr = buff[eid];
+    if (arr.is_none())
+      continue;
+    const bool is_float = arr.dtype() == mshadow::kFloat32 || arr.dtype() == mshadow::kFloat64 ||
+                          arr.dtype() == mshadow::kFloat16;
+    const char* entry_mode = nullptr;
+    if (modes[eid] == kCompressReLU)
+      entry_mode = "bitmask";
+    else if (modes[eid] == kCompressFloat16 && mode == kCompressFloat16 &&
+             arr.dtype() != mshadow::kFloat16)
+      entry_mode = "float16";
+    else if (modes[eid] == kCompressFloat16 && mode == kCompressInt8)
+      entry_mode = "int8";
+    const size_t bytes = arr.shape().Size() * mshadow::mshadow_sizeof(arr.dtype());
+    if (entry_mode == nullptr || !is_float || arr.storage_type() != kDefaultStorage ||
+        bytes < kMinCompressBytes) {
+      excluded.insert(arr.var());
+      continue;
+    }
+    auto& storage = storages[arr.var()];
+    if (storage.empty())
+      order.push_back(arr.var());
+    storage.emplace_back(eid, entry_mode);
+  }
+  std::vector<CachedOp::CompressedActivation> compressed;
+  for (Engine::VarHandle var : order) {
+    if (excluded.count(var))
+      continue;
+    for (const auto& entry : storages.at(var)) {
+      NDArray* arr = &buff[entry.first];
+      nnvm::NodeAttrs attrs;
+      attrs.op           = compress_op;
+      attrs.name         = "_compress_activation";
+      attrs.dict["mode"] = entry.second;
+      attrs.op->attr_parser(&attrs);
+      const uint32_t num_outputs = attrs.op->get_num_outputs(attrs);
+      mxnet::ShapeVector in_shapes{arr->shape()}, out_shapes(num_outputs);
+      std::vector<int> in_types{arr->dtype()}, out_types(num_outputs, -1);
+      finfer_shape[compress_op](attrs, &in_shapes, &out_shapes);
+      finfer_type[compress_op](attrs, &in_types, &out_types);
+      CachedOp::CompressedActivation activation;
+      activation.eid   = entry.first;
+      activation.mode  = entry.second;
+      activation.shape = arr->shape();
+      activation.dtype = arr->dtype();
+      std::vector<NDArray*> outputs;
+      for (uint32_t i = 0; i < num_outputs; ++i) {
+        activation.data.emplace_back(out_shapes[i], arr->ctx(), true, out_types[i]);
+        outputs.push_back(&activation.data.back());
+      }
+      Imperative::Get()->InvokeOp(arr->ctx(),
+                                  attrs,
+                                  {arr},
+                                  outputs,
+                                  std::vector<OpReqType>(num_outputs, kWriteTo),
+                                  DispatchMode::kFCompute);
+      compressed.push_back(std::move(activation));
+      buff[entry.first] = NDArray();
+    }
+  }
+  return compressed;
+}
+
+/*! \brief Restore a compressed activation to dst, a new array on ctx */
+void DecompressActivation(const CachedOp::CompressedActivation& activation,
+                          const Context& ctx,
+                          NDArray* dst) {
+  static const nnvm::Op* decompress_op = nnvm::Op::Get("_contrib_decompress_activation");
+  std::ostringstream shape;
+  shape << activation.shape;
+  nnvm::NodeAttrs attrs;
+  attrs.op            = decompress_op;
+  attrs.name          = "_decompress_activation";
+  attrs.dict["mode"]  = activation.mode;
+  attrs.dict["shape"] = shape.str();
+  attrs.dict["dtype"] = common::mshadow_type_info(activation.dtype).name;
+  attrs.op->attr_parser(&attrs);
+  std::vector<NDArray*> inputs;
+  for (const NDArray& arr : activation.data)
+    inputs.push_back(const_cast<NDArray*>(&arr));
+  Imperative::Get()->InvokeOp(ctx, attrs, inputs, {dst}, {kWriteTo}, DispatchMode::kFCompute);
+}
+
+}  // namespace
+
 bool CachedOp::SetForwardGraph(const Context& default_ctx,
                                GraphInfo* info,
                                const bool recording,
@@ -184,6 +659,34 @@ bool CachedOp::SetForwardGraph(const Context& default_ctx,
     storage_type_inputs[i] = inputs[info->input_map[i]]->storage_type();
   }
 
+  // a cached plan replaces all attributes of the graph, so the checks below pass;
+  // it still is a change of plan if it differs from the one of the previous call
+  const bool use_cache = config_.plan_cache_size > 0;
+  bool plan_restored   = false;
+  GraphAttrCache::Key key, bucket_key;
+  ShapeVector bucket_shapes;
+  if (use_cache) {
+    key = PlanCacheKey(shape_inputs, dtype_inputs, storage_type_inputs);
+    if (config_.shape_buckets.ndim() > 0) {
+      bucket_shapes = shape_inputs;
+      for (const uint32_t i : config_.data_indices) {
+        for (size_t j = 0; j < bucket_shapes.size(); ++j) {
+          if (info->input_map[j] == i)
+            bucket_shapes[j] = BucketShape(bucket_shapes[j], config_.shape_buckets);
+        }
+      }
+      bucket_key = PlanCacheKey(bucket_shapes, dtype_inputs, storage_type_inputs);
+    }
+    const GraphAttrCache::Attrs* attrs = info->fwd_plan_cache.Get(key);
+    if (attrs != nullptr) {
+      auto prev     = g.attrs.find("shape_inputs");
+      auto cached   = attrs->find("shape_inputs");
+      plan_restored = prev == g.attrs.end() || cached == attrs->end() ||
+                      prev->second != cached->second;
+      g.attrs       = *attrs;
+    }
+  }
+
   bool match                 = true;
   bool contain_dynamic_shape = false;
   match &=
@@ -203,7 +706,7 @@ bool CachedOp::SetForwardGraph(const Context& default_ctx,
     g.attrs.erase(AddPrefix(FORWARD, MEM_PLAN));
     g.attrs.erase(AddPrefix(FULL, MEM_PLAN));
   } else if (g.attrs.count(AddPrefix(prefix, MEM_PLAN))) {
-    return true;
+    return !plan_restored;
   }
 
   const auto& idx = g.indexed_graph();
@@ -222,11 +725,25 @@ bool CachedOp::SetForwardGraph(const Context& default_ctx,
     storage[idx.entry_id(idx.outputs()[i])] = exec::kExternalStorageID;
   }
 
-  auto mem_plan                        = MXPlanMemory(&g,
-                               std::move(storage),
-                               g.GetAttr<std::vector<uint32_t> >(AddPrefix(prefix, REF_COUNT)),
-                               AddPrefix(prefix, STORAGE_PLAN));
-  g.attrs[AddPrefix(prefix, MEM_PLAN)] = std::make_shared<dmlc::any>(std::move(mem_plan));
+  bool bucketed = false;
+  if (!bucket_key.empty()) {
+    bucketed = PlanBucketedMemory(&g,
+                                  std::move(bucket_shapes),
+                                  storage,
+                                  prefix,
+                                  bucket_key,
+                                  &info->bucket_plan_cache,
+                                  config_.plan_cache_size);
+  }
+  if (!bucketed) {
+    auto mem_plan = MXPlanMemory(&g,
+                                 std::move(storage),
+                                 g.GetAttr<std::vector<uint32_t> >(AddPrefix(prefix, REF_COUNT)),
+                                 AddPrefix(prefix, STORAGE_PLAN));
+    g.attrs[AddPrefix(prefix, MEM_PLAN)] = std::make_shared<dmlc::any>(std::move(mem_plan));
+  }
+  if (use_cache)
+    info->fwd_plan_cache.Put(key, g.attrs, config_.plan_cache_size);
 
   return false;
 }
@@ -390,12 +907,81 @@ OpStatePtr CachedOp::GetCachedOpState(const Context& ctx) {
       return i;
     }
   }
-  auto state_ptr = OpStatePtr::Create<CachedOpState>(ctx, fwd_graph_, full_graph_, inlining_);
+  auto state_ptr = OpStatePtr::Create<CachedOpState>(ctx,
+                                                     fwd_graph_,
+                                                     full_graph_,
+                                                     inlining_,
+                                                     recompute_shapes_,
+                                                     recompute_dtypes_,
+                                                     size_t{config_.recompute_budget} << 20);
 
   cached_op_states_[ctx].push_back(state_ptr);
   return state_ptr;
 }
 
+OpStatePtr CachedOp::GetCachedOpState(const Context& ctx, const std::vector<NDArray*>& inputs) {
+  const size_t cache_limit = dmlc::GetEnv("MXNET_CUDA_GRAPHS_SHAPE_CACHE_MB", size_t{0}) << 20;
+  if (cache_limit == 0 || !config_.static_alloc || !UseCudaGraphs(ctx, config_.static_shape))
+    return GetCachedOpState(ctx);
+
+  ShapeVector shapes;
+  nnvm::DTypeVector dtypes;
+  StorageTypeVector stypes;
+  for (const NDArray* input : inputs) {
+    shapes.push_back(input->shape());
+    dtypes.push_back(input->dtype());
+    stypes.push_back(input->storage_type());
+  }
+  const GraphAttrCache::Key key = PlanCacheKey(shapes, dtypes, stypes);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& states = cached_op_states_[ctx];
+  OpStatePtr unassigned;
+  size_t cached_bytes = 0;
+  for (const auto& i : states) {
+    auto& state = i.get_state<CachedOpState>();
+    if (i.unique() && state.shape_key == key) {
+      state.last_use = ++state_use_count_;
+      return i;
+    }
+    if (i.unique() && state.shape_key.empty() && !unassigned)
+      unassigned = i;
+    cached_bytes += state.fwd_alloc_bytes + state.bwd_alloc_bytes;
+  }
+  // drop the least recently used idle states, with their memory and CUDA graphs,
+  // until the new one fits
+  while (cached_bytes > cache_limit) {
+    auto lru = states.end();
+    for (auto it = states.begin(); it != states.end(); ++it) {
+      // unassigned is held here, so it is not unique
+      if (it->unique() &&
+          (lru == states.end() ||
+           it->get_state<CachedOpState>().last_use < lru->get_state<CachedOpState>().last_use))
+        lru = it;
+    }
+    if (lru == states.end())
+      break;
+    const auto& evicted = lru->get_state<CachedOpState>();
+    cached_bytes -= evicted.fwd_alloc_bytes + evicted.bwd_alloc_bytes;
+    states.erase(lru);
+  }
+  OpStatePtr state_ptr = unassigned;
+  if (!state_ptr) {
+    state_ptr = OpStatePtr::Create<CachedOpState>(ctx,
+                                                  fwd_graph_,
+                                                  full_graph_,
+                                                  inlining_,
+                                                  recompute_shapes_,
+                                                  recompute_dtypes_,
+                                                  size_t{config_.recompute_budget} << 20);
+    states.push_back(state_ptr);
+  }
+  auto& state     = state_ptr.get_state<CachedOpState>();
+  state.shape_key = key;
+  state.last_use  = ++state_use_count_;
+  return state_ptr;
+}
+
 void CachedOp::StaticAllocMemory(const OpStatePtr& state_ptr, bool recording, bool keep_fwd) {
   using namespace nnvm;
   using namespace imperative;
@@ -450,7 +1036,16 @@ void CachedOp::StaticAllocMemory(const OpStatePtr& state_ptr, bool recording, bo
   }
 
   auto& reuse_pool = keep_fwd ? state.bwd_reuse_pool : state.fwd_reuse_pool;
-  reuse_pool       = imperative::AllocateMemory(g,
+  if (!config_.memory_group.empty()) {
+    std::vector<size_t> sizes;
+    for (size_t i = start_eid; i < end_eid; ++i) {
+      if (mem_plan[i].storage_id >= 0 && mem_plan[i].root == i)
+        sizes.push_back(mem_plan[i].size);
+    }
+    reuse_pool = MemoryGroup::Get(config_.memory_group, default_ctx, keep_fwd)
+                     ->Acquire(sizes, default_ctx);
+  }
+  reuse_pool = imperative::AllocateMemory(g,
                                           idx,
                                           default_ctx,
                                           start_eid,
@@ -458,7 +1053,19 @@ void CachedOp::StaticAllocMemory(const OpStatePtr& state_ptr, bool recording, bo
                                           mem_plan,
                                           state.arrays,
                                           &state.array_reqs,
-                                          std::move(reuse_pool));
+                                          std::move(reuse_pool),
+                                          config_.static_arena && config_.memory_group.empty());
+  size_t alloc_bytes = 0;
+  for (size_t i = start_eid; i < end_eid; ++i) {
+    if (mem_plan[i].storage_id >= 0 && mem_plan[i].root == i)
+      alloc_bytes += mem_plan[i].size;
+  }
+  if (keep_fwd) {
+    state.bwd_alloc_bytes = alloc_bytes;
+  } else {
+    state.fwd_alloc_bytes = alloc_bytes;
+    state.bwd_alloc_bytes = 0;
+  }
 
   state.recording = recording;
   if (keep_fwd) {
@@ -667,6 +1274,7 @@ static void PrepareOutputs(const nnvm::Graph& g,
     // An input and an output may share the same array.
     if (detach)
       INIT_DETACHED(outputs[i], arrays[eid]);
+    CheckPreallocatedOutput(g, eid, *outputs[i]);
 
     arrays[eid] = outputs[i];
     if (arrays[eid]->is_none())
@@ -680,11 +1288,17 @@ static void PrepareOutputs(const nnvm::Graph& g,
 OpStatePtr CachedOp::StaticForward(const Context& default_ctx,
                                    const std::vector<NDArray*>& inputs,
                                    const std::vector<NDArray*>& outputs) {
+  return StaticForward(default_ctx, inputs, outputs, GetCachedOpState(default_ctx, inputs));
+}
+
+OpStatePtr CachedOp::StaticForward(const Context& default_ctx,
+                                   const std::vector<NDArray*>& inputs,
+                                   const std::vector<NDArray*>& outputs,
+                                   const OpStatePtr& state_ptr) {
   using namespace nnvm;
   using namespace imperative;
 
   bool recording = Imperative::Get()->is_recording();
-  auto state_ptr = GetCachedOpState(default_ctx);
   auto& state    = state_ptr.get_state<CachedOpState>();
 
   // Need to lock the mutex on the state, this allows
@@ -802,6 +1416,16 @@ OpStatePtr CachedOp::DynamicForward(const Context& default_ctx,
              nullptr,
              monitor_callback_,
              monitor_all_);
+    if (recording && !inlining_ && config_.compress_activations != kCompressNone &&
+        compression_modes_.size() == buff.size()) {
+      runtime.compressed =
+          CompressActivations(&buff, compression_modes_, config_.compress_activations);
+    }
+    if (recording && !inlining_ && config_.offload_budget > 0 &&
+        default_ctx.dev_mask() == gpu::kDevMask) {
+      runtime.offloaded =
+          OffloadActivations(&buff, static_cast<size_t>(config_.offload_budget) << 20);
+    }
   } else {
     mxnet::ShapeVector shapes = g.GetAttr<mxnet::ShapeVector>("shape");
     NaiveRunGraph(false,
@@ -835,6 +1459,8 @@ OpStatePtr CachedOp::Forward(const std::shared_ptr<CachedOp>& op_ptr,
                              const std::vector<NDArray*>& outputs,
                              const Context& default_ctx) {
   static const auto cached_op = nnvm::Op::Get("_CachedOp");
+  // host time of the call, the operators it pushes are children of this span
+  profiler::RequestTrace::Scope trace_span("CachedOp::Forward", profiler::RequestTrace::kHost);
 
   CHECK_EQ(inputs.size(), num_inputs());
   // Assign the storage information for the input arguments. Similar to the
@@ -854,6 +1480,17 @@ OpStatePtr CachedOp::Forward(const std::shared_ptr<CachedOp>& op_ptr,
     }
   }
 
+  if (config_.recompute_budget > 0) {
+    // recomputation is planned once, for the shapes of the first call
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (recompute_shapes_.empty()) {
+      for (const NDArray* input : inputs) {
+        recompute_shapes_.push_back(input->shape());
+        recompute_dtypes_.push_back(input->dtype());
+      }
+    }
+  }
+
   {
     auto state_ptr = GetCachedOpState(default_ctx);
     auto& state    = state_ptr.get_state<CachedOpState>();
@@ -866,8 +1503,12 @@ OpStatePtr CachedOp::Forward(const std::shared_ptr<CachedOp>& op_ptr,
           << idx[idx.input_nodes()[i]].source->attrs.name << " is on " << inputs[i]->ctx();
     }
   }
+  if (config_.prefetch_params && default_ctx.dev_mask() == cpu::kDevMask) {
+    PrefetchParams(inputs, prefetch_order_);
+  }
 
-  int prev_bulk_size = Engine::Get()->set_bulk_size(config_.forward_bulk_size);
+  int prev_bulk_size          = Engine::Get()->set_bulk_size(config_.forward_bulk_size);
+  std::string prev_bulk_scope = Engine::Get()->set_bulk_scope(fwd_bulk_scope_);
 
   OpStatePtr op_state;
   try {
@@ -881,10 +1522,12 @@ OpStatePtr CachedOp::Forward(const std::shared_ptr<CachedOp>& op_ptr,
       op_state = DynamicForward(default_ctx, inputs, outputs, false);
     }
   } catch (const dmlc::Error& e) {
+    Engine::Get()->set_bulk_scope(prev_bulk_scope);
     Engine::Get()->set_bulk_size(prev_bulk_size);
     throw e;
   }
 
+  Engine::Get()->set_bulk_scope(prev_bulk_scope);
   Engine::Get()->set_bulk_size(prev_bulk_size);
 
   if (Imperative::Get()->is_recording() && !inlining_) {
@@ -980,18 +1623,74 @@ void CachedOp::DynamicBackward(const bool retain_graph,
 
   const auto& dispatch_modes = g.GetAttr<DispatchModeVector>("dispatch_mode");
 
-  RunGraph(retain_graph,
-           idx,
-           arrays,
-           num_forward_nodes,
-           idx.num_nodes(),
-           std::move(array_reqs),
-           std::move(ref_count),
-           &states,
-           dispatch_modes,
-           Imperative::Get()->is_recording(),
-           nullptr,
-           monitor_callback_);
+  // The offloaded activations are copied back while the backward operators are pushed, each
+  // copy waiting for the operator it is scheduled after, and the compressed ones decompressed
+  // after the operator ahead of their first use. RunGraph updates array_reqs and ref_count in
+  // place, so that the nodes are run in segments between the restores.
+  size_t node_start = num_forward_nodes;
+  auto run_nodes    = [&](size_t node_end) {
+    RunGraph(retain_graph,
+             idx,
+             arrays,
+             node_start,
+             node_end,
+             std::move(array_reqs),
+             std::move(ref_count),
+             &states,
+             dispatch_modes,
+             Imperative::Get()->is_recording(),
+             nullptr,
+             monitor_callback_);
+    node_start = node_end;
+  };
+  std::vector<uint32_t> offloaded, compressed;
+  for (const auto& entry : runtime.offloaded)
+    offloaded.push_back(entry.first);
+  for (const auto& activation : runtime.compressed)
+    compressed.push_back(activation.eid);
+  // the restores of compressed entries are indexed after the offloaded ones
+  auto schedule =
+      SchedulePrefetches(idx, num_forward_nodes, offloaded, config_.offload_prefetch);
+  for (const auto& restore : SchedulePrefetches(idx, num_forward_nodes, compressed, 1))
+    schedule.emplace_back(restore.first, restore.second + offloaded.size());
+  std::stable_sort(schedule.begin(), schedule.end(), [](const auto& a, const auto& b) {
+    return a.first < b.first;
+  });
+  for (const auto& prefetch : schedule) {
+    if (prefetch.first > node_start)
+      run_nodes(prefetch.first);
+    const bool is_offloaded = prefetch.second < offloaded.size();
+    const uint32_t eid      = is_offloaded ? offloaded[prefetch.second] :
+                                             compressed[prefetch.second - offloaded.size()];
+    NDArray* dst            = arrays[eid];
+    if (is_offloaded) {
+      const NDArray& host = runtime.offloaded[prefetch.second].second;
+      *dst                = NDArray(host.shape(), default_ctx, true, host.dtype());
+    } else {
+      const auto& activation = runtime.compressed[prefetch.second - offloaded.size()];
+      *dst                   = NDArray(activation.shape, default_ctx, true, activation.dtype);
+    }
+    const NDArray* after =
+        node_start > num_forward_nodes ? arrays[idx.entry_id(node_start - 1, 0)] : nullptr;
+    if (after != nullptr && !after->is_none()) {
+      Engine::Get()->PushSync([](RunContext) {},
+                              Context::CPU(),
+                              {after->var()},
+                              {dst->var()},
+                              FnProperty::kNormal,
+                              0,
+                              "PrefetchActivation");
+    }
+    if (is_offloaded) {
+      CopyFromTo(runtime.offloaded[prefetch.second].second, *dst);
+    } else {
+      DecompressActivation(
+          runtime.compressed[prefetch.second - offloaded.size()], default_ctx, dst);
+    }
+  }
+  runtime.offloaded.clear();
+  runtime.compressed.clear();
+  run_nodes(idx.num_nodes());
 
   if (retain_graph) {
     buff.resize(num_forward_entries);
@@ -1027,12 +1726,38 @@ void CachedOp::StaticBackward(const bool retain_graph,
   // We are going to add input and output arrays to the array list.
   // The input and output arrays should only be valid for this run,
   // so we shouldn't modify the state's array list.
+  // With CUDA graphs, the output gradients are copied into arrays of the state,
+  // so that the ops reading them keep their addresses and can be captured too.
+  const bool stage_ograds    = UseCudaGraphs(default_ctx, config_.static_shape);
+  const auto num_fwd_entries = state.info.fwd_graph.indexed_graph().num_node_entries();
+  for (size_t i = 0; stage_ograds && i < state.info.bwd_input_eid.size(); ++i) {
+    auto eid = state.info.bwd_input_eid[i];
+    if (eid == kEidNotExist || eid < num_fwd_entries)
+      continue;
+    const NDArray* ograd = inputs[BwdOriginalInput(state.info.input_map, i)];
+    if (ograd->storage_type() != kDefaultStorage)
+      continue;
+    auto& buff = state.buff[eid];
+    if (state.dynamic_entries[eid] || buff.shape() != ograd->shape() ||
+        buff.dtype() != ograd->dtype()) {
+      buff                       = NDArray(ograd->shape(), default_ctx, false, ograd->dtype());
+      state.arrays[eid]          = &buff;
+      state.dynamic_entries[eid] = false;
+      match                      = false;
+    }
+  }
+
   state.arrays_with_in_out = state.arrays;
   auto& arrays             = state.arrays_with_in_out;
   for (size_t i = 0; i < state.info.bwd_input_eid.size(); ++i) {
     auto eid = state.info.bwd_input_eid[i];
-    if (eid == kEidNotExist || !state.dynamic_entries[eid])
+    if (eid == kEidNotExist)
       continue;
+    if (!state.dynamic_entries[eid]) {
+      if (stage_ograds && eid >= num_fwd_entries)
+        CopyFromTo(*inputs[BwdOriginalInput(state.info.input_map, i)], arrays[eid]);
+      continue;
+    }
     arrays[eid] = inputs[BwdOriginalInput(state.info.input_map, i)];
   }
 
@@ -1117,7 +1842,8 @@ void CachedOp::Backward(const bool retain_graph,
       << "If you want to do backward with create_graph=True please "
       << "do not use hybridize.";
 
-  int prev_bulk_size = Engine::Get()->set_bulk_size(config_.backward_bulk_size);
+  int prev_bulk_size          = Engine::Get()->set_bulk_size(config_.backward_bulk_size);
+  std::string prev_bulk_scope = Engine::Get()->set_bulk_scope(bwd_bulk_scope_);
 
   try {
     if (config_.static_alloc) {
@@ -1126,10 +1852,12 @@ void CachedOp::Backward(const bool retain_graph,
       DynamicBackward(retain_graph, state, inputs, reqs, outputs);
     }
   } catch (const dmlc::Error& e) {
+    Engine::Get()->set_bulk_scope(prev_bulk_scope);
     Engine::Get()->set_bulk_size(prev_bulk_size);
     throw e;
   }
 
+  Engine::Get()->set_bulk_scope(prev_bulk_scope);
   Engine::Get()->set_bulk_size(prev_bulk_size);
 }
 
@@ -28,6 +28,8 @@
 #include <string>
 #include <unordered_map>
 #include <map>
+#include <list>
+#include <memory>
 #include "../common/alm.h"
 #include "../operator/operator_common.h"
 #include "../operator/subgraph/common.h"
@@ -128,6 +130,26 @@ nnvm::NodeEntry AggregateGradient(std::vector<nnvm::NodeEntry>&& v) {
   }
 }
 
+/* \brief check that a preallocated output matches the entry of the graph
+ * it is bound to, since the operators write it with the inferred shape and type*/
+void CheckPreallocatedOutput(const nnvm::Graph& g,
+                             const size_t eid,
+                             const NDArray& out) DMLC_ATTRIBUTE_UNUSED;
+void CheckPreallocatedOutput(const nnvm::Graph& g, const size_t eid, const NDArray& out) {
+  if (out.is_none() || out.storage_type() != kDefaultStorage)
+    return;
+  const auto& shapes = g.GetAttr<mxnet::ShapeVector>("shape");
+  const auto& dtypes = g.GetAttr<nnvm::DTypeVector>("dtype");
+  if (shape_is_known(shapes[eid])) {
+    CHECK_EQ(out.shape(), shapes[eid])
+        << "The preallocated output does not have the shape inferred for it";
+  }
+  if (dtypes[eid] != -1) {
+    CHECK_EQ(out.dtype(), dtypes[eid])
+        << "The preallocated output does not have the type inferred for it";
+  }
+}
+
 /* \brief collect pointers to input and output ndarrays
  * into a single data structure, this data structure can
  * be used for Memory allocation pass*/
@@ -151,6 +173,7 @@ void CollectInputOutputNDRefs(const nnvm::Graph& g,
     auto eid = idx.entry_id(idx.outputs()[i]);
     if (!(*arrays)[eid]->is_none())
       *outputs[i] = (*arrays)[eid]->Detach();
+    CheckPreallocatedOutput(g, eid, *outputs[i]);
     (*arrays)[eid] = outputs[i];
   }
 }
@@ -213,11 +236,17 @@ void CreateForwardGraph(const nnvm::Symbol& sym, nnvm::Graph* fwd_graph) {
     *fwd_graph = alm::OptimizeLayout(std::move(*fwd_graph));
 }
 
-/* \brief construct grad_graph from fwd_graph and ograd_entries*/
+/*
+ * \brief construct grad_graph from fwd_graph and ograd_entries, with a nonzero
+ *  recompute_budget the activations exceeding it are recomputed in backward
+ */
 void CreateBackwardGraph(nnvm::Graph* fwd_graph,
                          nnvm::Graph* grad_graph,
                          std::vector<nnvm::NodeEntry>* ograd_entries,
-                         std::unordered_map<uint32_t, uint32_t>* fwd_input_to_grad_output) {
+                         std::unordered_map<uint32_t, uint32_t>* fwd_input_to_grad_output,
+                         const mxnet::ShapeVector& arg_shapes = mxnet::ShapeVector(),
+                         const nnvm::DTypeVector& arg_dtypes  = nnvm::DTypeVector(),
+                         size_t recompute_budget              = 0) {
   using namespace nnvm;
   static const std::vector<const Op*> zero_ops{Op::Get("zeros_like"), Op::Get("_zeros")};
   ograd_entries->reserve(fwd_graph->outputs.size());
@@ -247,15 +276,24 @@ void CreateBackwardGraph(nnvm::Graph* fwd_graph,
 
   // There are inputs in computation graph that require gradients
   if (!xs.empty()) {
+    std::function<int(const Node&)> mirror_fun = nullptr;
+    if (recompute_budget > 0 && !arg_shapes.empty()) {
+      mirror_fun = exec::PlanRecompute(*fwd_graph,
+                                       mxnet::ShapeVector(arg_shapes),
+                                       nnvm::DTypeVector(arg_dtypes),
+                                       recompute_budget);
+    }
     try {
       *grad_graph = pass::MXGradient(*fwd_graph,
                                      fwd_graph->outputs,
                                      xs,
                                      *ograd_entries,
                                      mxnet::AggregateGradient,
-                                     nullptr,
+                                     mirror_fun,
                                      zero_ops,
-                                     "_copy");
+                                     "_copy",
+                                     arg_shapes,
+                                     arg_dtypes);
     } catch (const nnvm::pass::InvalidGraphError& e) {
       *grad_graph = nnvm::Graph();
     }
@@ -270,7 +308,10 @@ void CreateFullGraph(const nnvm::Symbol& sym,
                      nnvm::Graph* grad_graph,
                      nnvm::Graph* full_graph,
                      std::vector<nnvm::NodeEntry>* ograd_entries,
-                     std::unordered_map<uint32_t, uint32_t>* fwd_input_to_grad_output) {
+                     std::unordered_map<uint32_t, uint32_t>* fwd_input_to_grad_output,
+                     const mxnet::ShapeVector& arg_shapes = mxnet::ShapeVector(),
+                     const nnvm::DTypeVector& arg_dtypes  = nnvm::DTypeVector(),
+                     size_t recompute_budget              = 0) {
   using namespace nnvm;
   CreateForwardGraph(sym, fwd_graph);
 
@@ -279,7 +320,13 @@ void CreateFullGraph(const nnvm::Symbol& sym,
     *fwd_graph = exec::EliminateCommonExpr(std::move(*fwd_graph));
 
   // construct backward graph
-  CreateBackwardGraph(fwd_graph, grad_graph, ograd_entries, fwd_input_to_grad_output);
+  CreateBackwardGraph(fwd_graph,
+                      grad_graph,
+                      ograd_entries,
+                      fwd_input_to_grad_output,
+                      arg_shapes,
+                      arg_dtypes,
+                      recompute_budget);
 
   full_graph->outputs = fwd_graph->outputs;
   // add backward graph outputs to full graph
@@ -340,12 +387,21 @@ void OptimizeGraph(nnvm::Graph* full_graph,
   input_map->resize(full_graph->indexed_graph().input_nodes().size());
   std::iota(input_map->begin(), input_map->end(), 0);
 #if MXNET_USE_CUDA && !defined(_WIN32)
-  if (context.dev_mask() == kGPU && !inlining && dmlc::GetEnv("MXNET_USE_FUSION", true)) {
+  bool fuse = context.dev_mask() == kGPU && dmlc::GetEnv("MXNET_USE_FUSION", true);
+#else
+  bool fuse = false;
+  // Only warn user if MXNET_USE_FUSION env var is explicitly set
+  if (context.dev_mask() == kGPU && !inlining && dmlc::GetEnv("MXNET_USE_FUSION", false)) {
+    exec::WarnFusionNotSupported();
+  }
+#endif  // MXNET_USE_CUDA && !defined(_WIN32)
+  fuse = fuse || (context.dev_mask() == kCPU && dmlc::GetEnv("MXNET_USE_FUSION_CPU", false));
+  if (fuse && !inlining) {
     nnvm::Graph unoptimized_graph;
     common::CopyGraph(&unoptimized_graph, *full_graph, false);
 
     if (common::CheckForInputNameDuplicates(unoptimized_graph.indexed_graph())) {
-      *full_graph = exec::FusePointwise(*full_graph, num_forward_outputs);
+      *full_graph = exec::FusePointwise(*full_graph, num_forward_outputs, context.dev_mask());
       // Fill in input_map - mapping from the new to the original input indices.
       const auto& original_inputs = unoptimized_graph.indexed_graph().input_nodes();
       const auto& new_inputs      = full_graph->indexed_graph().input_nodes();
@@ -372,12 +428,6 @@ void OptimizeGraph(nnvm::Graph* full_graph,
           << "Graph contains duplicate names for some of its inputs - fusion is NOT enabled!";
     }
   }
-#else
-  // Only warn user if MXNET_USE_FUSION env var is explicitly set
-  if (context.dev_mask() == kGPU && !inlining && dmlc::GetEnv("MXNET_USE_FUSION", false)) {
-    exec::WarnFusionNotSupported();
-  }
-#endif  // MXNET_USE_CUDA && !defined(_WIN32)
 
   *fwd_graph         = nnvm::Graph();
   fwd_graph->outputs = std::vector<nnvm::NodeEntry>(
@@ -411,6 +461,48 @@ void SetInputIndices(const nnvm::Graph& fwd_graph,
 
 }  // namespace
 
+/*!
+ * \brief LRU cache of the attributes of a graph, i.e. its inferred shapes, types
+ *  and memory plans, keyed by the signature of the inputs they were computed for.
+ *  Attributes are shared, not copied, graph passes replace attributes instead of
+ *  modifying them in place.
+ */
+class GraphAttrCache {
+ public:
+  using Key   = std::vector<int64_t>;
+  using Attrs = std::unordered_map<std::string, std::shared_ptr<dmlc::any>>;
+  /*! \return attributes cached for the key or nullptr, the entry becomes the most recent one */
+  const Attrs* Get(const Key& key) {
+    auto it = index_.find(key);
+    if (it == index_.end())
+      return nullptr;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return &it->second->second;
+  }
+  /*! \brief insert or update an entry, and evict the least recent ones beyond capacity */
+  void Put(const Key& key, const Attrs& attrs, size_t capacity) {
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      it->second->second = attrs;
+      entries_.splice(entries_.begin(), entries_, it->second);
+    } else {
+      entries_.emplace_front(key, attrs);
+      index_.emplace(key, entries_.begin());
+    }
+    while (entries_.size() > capacity) {
+      index_.erase(entries_.back().first);
+      entries_.pop_back();
+    }
+  }
+
+ private:
+  std::list<std::pair<Key, Attrs>> entries_;
+  std::map<Key, std::list<std::pair<Key, Attrs>>::iterator> index_;
+};
+
+/*! \brief Compression of the forward activations kept for backward */
+enum ActivationCompression { kCompressNone, kCompressReLU, kCompressFloat16, kCompressInt8 };
+
 /*! \brief CachedOp Parameters */
 struct CachedOpConfig : public dmlc::Parameter<CachedOpConfig> {
   uint32_t inline_limit;
@@ -422,6 +514,15 @@ struct CachedOpConfig : public dmlc::Parameter<CachedOpConfig> {
   mxnet::Tuple<uint32_t> data_indices;
   mxnet::Tuple<uint32_t> param_indices;
   std::string subgraph;
+  uint32_t recompute_budget;
+  uint32_t plan_cache_size;
+  mxnet::Tuple<uint32_t> shape_buckets;
+  bool static_arena;
+  std::string memory_group;
+  uint32_t offload_budget;
+  uint32_t offload_prefetch;
+  int compress_activations;
+  bool prefetch_params;
   DMLC_DECLARE_PARAMETER(CachedOpConfig) {
     DMLC_DECLARE_FIELD(static_alloc)
         .set_default(false)
@@ -455,6 +556,65 @@ struct CachedOpConfig : public dmlc::Parameter<CachedOpConfig> {
     DMLC_DECLARE_FIELD(is_dynamic)
         .set_default(false)
         .describe("Whether the graph contains dynamic shape operators.");
+    DMLC_DECLARE_FIELD(recompute_budget)
+        .set_default(dmlc::GetEnv("MXNET_RECOMPUTE_BUDGET_MB", 0U))
+        .describe(
+            "Memory budget in MB for the forward activations kept for backward. "
+            "Activations beyond it are recomputed during backward. 0 disables recomputation.");
+    DMLC_DECLARE_FIELD(plan_cache_size)
+        .set_default(dmlc::GetEnv("MXNET_CACHEDOP_PLAN_CACHE_SIZE", 0U))
+        .describe(
+            "Number of input signatures whose inferred forward graph and memory plan "
+            "are cached, so that recurring input shapes skip inference and planning. "
+            "0 only keeps the plan of the last call.");
+    DMLC_DECLARE_FIELD(shape_buckets)
+        .set_default(mxnet::Tuple<uint32_t>())
+        .describe(
+            "Ascending bucket boundaries. With plan_cache_size > 0, the memory plan of a "
+            "call is made for the input shapes whose data dimensions are rounded up to "
+            "the next boundary, and shared by all shapes in the same buckets.");
+    DMLC_DECLARE_FIELD(static_arena)
+        .set_default(dmlc::GetEnv("MXNET_CACHEDOP_STATIC_ARENA", false))
+        .describe(
+            "With static_alloc, allocate all planned storage of a pass as one "
+            "contiguous arena, every intermediate array being an offset into it.");
+    DMLC_DECLARE_FIELD(memory_group)
+        .set_default(std::string(""))
+        .describe(
+            "With static_alloc, name of a group of cached ops sharing the storage of their "
+            "passes on a context, e.g. the models served one after another from a GPU. The "
+            "group only holds the storage of its largest pass, the passes of its cached ops "
+            "running at the same time are serialized on the shared storage. Overrides "
+            "static_arena.");
+    DMLC_DECLARE_FIELD(offload_budget)
+        .set_default(dmlc::GetEnv("MXNET_OFFLOAD_BUDGET_MB", 0U))
+        .describe(
+            "Without static_alloc, GPU memory budget in MB for the forward activations kept "
+            "for backward. The earliest activations beyond it are copied to pinned host "
+            "memory after forward and prefetched back during backward. 0 disables offloading.");
+    DMLC_DECLARE_FIELD(offload_prefetch)
+        .set_default(dmlc::GetEnv("MXNET_OFFLOAD_PREFETCH", 4U))
+        .describe(
+            "Number of backward operators an offloaded activation is prefetched ahead of "
+            "its first use. 0 prefetches all of them when backward starts.");
+    DMLC_DECLARE_FIELD(compress_activations)
+        .add_enum("none", kCompressNone)
+        .add_enum("relu", kCompressReLU)
+        .add_enum("float16", kCompressFloat16)
+        .add_enum("int8", kCompressInt8)
+        .set_default(dmlc::GetEnv("MXNET_COMPRESS_ACTIVATIONS", static_cast<int>(kCompressNone)))
+        .describe(
+            "Without static_alloc, compression of the forward activations kept for "
+            "backward. relu stores the ones only read by the backward of ReLU as bitmasks, "
+            "which is exact. float16 and int8 also store the inputs of the backward of "
+            "convolutions, FullyConnected, normalizations and activations as float16, or as "
+            "int8 blocks of 256 elements with a scale each, which rounds their gradients.");
+    DMLC_DECLARE_FIELD(prefetch_params)
+        .set_default(dmlc::GetEnv("MXNET_CACHEDOP_PREFETCH_PARAMS", false))
+        .describe(
+            "On CPU, ask the kernel before each forward pass to read in the pages of the "
+            "parameters, e.g. loaded with mmap or swapped out, in the order of their first "
+            "use, so that the first operators run while the later parameters are read.");
   }
 };
 
@@ -522,6 +682,16 @@ class CachedOp {
     return sym;
   }
   void RegisterOpHook(const CachedOp::CachedOpMonCallback& callback, bool monitor_all = false);
+  /*! \brief a forward entry kept compressed until backward */
+  struct CompressedActivation {
+    uint32_t eid;
+    /*! \brief mode of _contrib_compress_activation */
+    std::string mode;
+    mxnet::TShape shape;
+    int dtype;
+    /*! \brief outputs of the compression */
+    std::vector<NDArray> data;
+  };
 
  protected:
   struct GraphInfo {
@@ -533,13 +703,20 @@ class CachedOp {
     std::unordered_map<uint32_t, uint32_t> fwd_input_to_grad_output;
     std::vector<OpReqType> bwd_output_reqs;
     std::vector<uint32_t> bwd_input_eid;
+    /*! \brief planned forward graph attributes by exact input signature */
+    GraphAttrCache fwd_plan_cache;
+    /*! \brief forward memory plans by bucketed input signature */
+    GraphAttrCache bucket_plan_cache;
   };
 
   struct CachedOpState {
     CachedOpState(const Context& context_,
                   const nnvm::Graph& fwd_graph_,
                   const nnvm::Graph& full_graph_,
-                  const bool inlining_) {
+                  const bool inlining_,
+                  const mxnet::ShapeVector& arg_shapes = mxnet::ShapeVector(),
+                  const nnvm::DTypeVector& arg_dtypes  = nnvm::DTypeVector(),
+                  size_t recompute_budget              = 0) {
       context = context_;
       nnvm::Symbol sym;
       sym.outputs = fwd_graph_.outputs;
@@ -548,7 +725,10 @@ class CachedOp {
                       &info.grad_graph,
                       &info.full_graph,
                       &info.ograd_entries,
-                      &info.fwd_input_to_grad_output);
+                      &info.fwd_input_to_grad_output,
+                      arg_shapes,
+                      arg_dtypes,
+                      recompute_budget);
 
       OptimizeGraph(&info.full_graph,
                     &info.fwd_graph,
@@ -596,9 +776,22 @@ class CachedOp {
     std::vector<bool> dynamic_entries;
     std::multimap<size_t, NDArray> fwd_reuse_pool;
     std::multimap<size_t, NDArray> bwd_reuse_pool;
+
+    /*! \brief input signature the state is dedicated to, when caching CUDA graphs per shape */
+    std::vector<int64_t> shape_key;
+    /*! \brief last use of the state in the CUDA graphs shape cache */
+    uint64_t last_use      = 0;
+    size_t fwd_alloc_bytes = 0;
+    size_t bwd_alloc_bytes = 0;
   };
 
   OpStatePtr GetCachedOpState(const Context& ctx);
+  /*!
+   * \brief Get a state for static execution with the shapes of the inputs. With
+   *  MXNET_CUDA_GRAPHS_SHAPE_CACHE_MB set, every input signature keeps its own state,
+   *  so the CUDA graphs captured for it are replayed when the signature recurs.
+   */
+  OpStatePtr GetCachedOpState(const Context& ctx, const std::vector<NDArray*>& inputs);
   bool SetForwardGraph(const Context& default_ctx,
                        GraphInfo* info,
                        const bool recording,
@@ -621,6 +814,11 @@ class CachedOp {
   OpStatePtr StaticForward(const Context& default_ctx,
                            const std::vector<NDArray*>& inputs,
                            const std::vector<NDArray*>& outputs);
+  /*! \brief Static forward on a given state, which the caller does not share during the call */
+  OpStatePtr StaticForward(const Context& default_ctx,
+                           const std::vector<NDArray*>& inputs,
+                           const std::vector<NDArray*>& outputs,
+                           const OpStatePtr& state_ptr);
   struct DynamicRuntime;
 
  private:
@@ -649,12 +847,22 @@ class CachedOp {
   std::vector<uint32_t> bwd_in_dep_, bwd_out_dep_, bwd_ograd_dep_;
   std::vector<bool> save_inputs_, save_outputs_;
   std::vector<OpReqType> bwd_output_reqs_;
+  /*! \brief scopes of adaptive bulking for the forward and backward pass */
+  std::string fwd_bulk_scope_, bwd_bulk_scope_;
+  /*! \brief forward inputs prefetched by prefetch_params, in the order of their first use */
+  std::vector<uint32_t> prefetch_order_;
+  /*! \brief how each forward entry may be compressed for compress_activations */
+  std::vector<int> compression_modes_;
+  /*! \brief input shapes and types the recomputation of the states is planned for */
+  mxnet::ShapeVector recompute_shapes_;
+  nnvm::DTypeVector recompute_dtypes_;
 
   std::function<void(const char*, const char*, NDArrayHandle)> monitor_callback_{nullptr};
   bool monitor_all_{false};
 
   std::mutex mutex_;
   std::unordered_map<Context, std::vector<OpStatePtr>> cached_op_states_;
+  uint64_t state_use_count_{0};
 
   friend class ::mxnet::io::LazyTransformDataset;
   nnvm::Symbol sym_;
@@ -665,6 +873,10 @@ struct CachedOp::DynamicRuntime {
   GraphInfo info;
   std::vector<NDArray> buff;
   std::vector<OpStatePtr> op_states;
+  /*! \brief forward entries offloaded to host memory, with their host copies */
+  std::vector<std::pair<uint32_t, NDArray>> offloaded;
+  /*! \brief forward entries stored compressed */
+  std::vector<CompressedActivation> compressed;
 };
 
 using CachedOpPtr = std::shared_ptr<CachedOp>;
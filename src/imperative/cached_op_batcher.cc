@@ -0,0 +1,253 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <algorithm>
+#include <exception>
+#include "./cached_op_batcher.h"
+
+namespace mxnet {
+
+DMLC_REGISTER_PARAMETER(CachedOpBatcherConfig);
+
+CachedOpBatcher::CachedOpBatcher(const nnvm::Symbol& sym,
+                                 const std::vector<std::pair<std::string, std::string>>& flags,
+                                 const std::vector<NDArray>& params,
+                                 const Context& ctx)
+    : params_(params), ctx_(ctx), is_np_shape_(Imperative::Get()->is_np_shape()) {
+  std::vector<std::pair<std::string, std::string>> op_flags = config_.InitAllowUnknown(flags);
+  // each of the concurrent batches of a bucket needs its own forward state
+  const bool has_states = std::any_of(
+      op_flags.begin(), op_flags.end(), [](const std::pair<std::string, std::string>& f) {
+        return f.first == "num_concurrent_states";
+      });
+  if (!has_states) {
+    op_flags.emplace_back("num_concurrent_states", std::to_string(config_.max_concurrency));
+  }
+  CachedOpThreadSafeConfig op_config;
+  op_config.Init(op_flags);
+
+  num_inputs_ = sym.ListInputNames(nnvm::Symbol::kAll).size();
+  param_indices_.assign(op_config.param_indices.begin(), op_config.param_indices.end());
+  if (op_config.data_indices.ndim() > 0) {
+    data_indices_.assign(op_config.data_indices.begin(), op_config.data_indices.end());
+  } else {
+    for (uint32_t i = 0; i < num_inputs_; ++i) {
+      if (std::find(param_indices_.begin(), param_indices_.end(), i) == param_indices_.end())
+        data_indices_.push_back(i);
+    }
+  }
+  CHECK_EQ(params_.size(), param_indices_.size())
+      << "CachedOpBatcher expects " << param_indices_.size() << " parameters, but "
+      << params_.size() << " were given.";
+  CHECK_EQ(data_indices_.size() + param_indices_.size(), num_inputs_)
+      << "The data and the parameters must cover the " << num_inputs_ << " inputs of the symbol.";
+
+  buckets_.assign(config_.batch_buckets.begin(), config_.batch_buckets.end());
+  if (buckets_.empty()) {
+    for (uint32_t b = 1; b < config_.max_batch_size; b *= 2)
+      buckets_.push_back(b);
+    buckets_.push_back(config_.max_batch_size);
+  }
+  std::sort(buckets_.begin(), buckets_.end());
+  buckets_.erase(std::unique(buckets_.begin(), buckets_.end()), buckets_.end());
+  CHECK_GT(buckets_.front(), 0) << "The batch buckets must be positive.";
+  CHECK_EQ(buckets_.back(), config_.max_batch_size)
+      << "The largest batch bucket must be max_batch_size.";
+  // a cached op per bucket keeps the memory plans of its shapes
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    ops_.push_back(std::make_shared<CachedOpThreadSafe>(sym, op_flags));
+  }
+  run_time_us_.assign(buckets_.size(), 0);
+
+  for (uint32_t i = 0; i < config_.max_concurrency; ++i) {
+    workers_.emplace_back([this]() { Work(); });
+  }
+}
+
+CachedOpBatcher::~CachedOpBatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cond_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void CachedOpBatcher::Submit(const std::vector<NDArray>& inputs, Callback callback) {
+  CHECK_EQ(inputs.size(), data_indices_.size())
+      << "CachedOpBatcher expects " << data_indices_.size() << " data inputs, but "
+      << inputs.size() << " were given.";
+  for (const auto& input : inputs) {
+    CHECK(input.shape().ndim() > 0 && input.shape()[0] == 1)
+        << "The data inputs of a request must have a batch of 1, got " << input.shape();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CHECK(!stop_) << "CachedOpBatcher is stopping";
+    queue_.push_back(Request{inputs, std::move(callback), Clock::now()});
+  }
+  // the worker coalescing a batch waits on the same condition as the idle ones
+  cond_.notify_all();
+}
+
+size_t CachedOpBatcher::Bucket(size_t n) const {
+  return std::lower_bound(buckets_.begin(), buckets_.end(), n) - buckets_.begin();
+}
+
+CachedOpBatcher::Clock::time_point CachedOpBatcher::Deadline(
+    const Clock::time_point& oldest) const {
+  double delay_us = config_.max_delay_us;
+  if (config_.latency_slo_us > 0) {
+    // leave the time to run the largest batch within the objective
+    delay_us = std::min(delay_us, std::max(0.0, config_.latency_slo_us - run_time_us_.back()));
+  }
+  return oldest + std::chrono::microseconds(static_cast<int64_t>(delay_us));
+}
+
+size_t CachedOpBatcher::BatchSize(size_t queued,
+                                  const Clock::time_point& oldest,
+                                  const Clock::time_point& now) const {
+  size_t n = std::min<size_t>(queued, config_.max_batch_size);
+  if (config_.latency_slo_us == 0)
+    return n;
+  // the largest batch whose bucket is estimated to run within the objective of the oldest request
+  const double waited_us = std::chrono::duration<double, std::micro>(now - oldest).count();
+  size_t b               = Bucket(n);
+  while (b > 0 && waited_us + run_time_us_[b] > config_.latency_slo_us) {
+    --b;
+    n = buckets_[b];
+  }
+  return n;
+}
+
+std::vector<CachedOpBatcher::Request> CachedOpBatcher::NextBatch() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cond_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+    if (queue_.empty())
+      return {};
+    // another worker may have taken the requests while this one was waiting for more
+    const Clock::time_point deadline = Deadline(queue_.front().arrival);
+    if (stop_ || queue_.size() >= config_.max_batch_size || Clock::now() >= deadline)
+      break;
+    cond_.wait_until(lock, deadline);
+  }
+  const size_t n = BatchSize(queue_.size(), queue_.front().arrival, Clock::now());
+  // the requests whose inputs have the shapes and types of the oldest one, in order
+  std::vector<Request> batch;
+  for (auto it = queue_.begin(); it != queue_.end() && batch.size() < n;) {
+    bool same = true;
+    for (size_t i = 0; !batch.empty() && i < it->inputs.size(); ++i) {
+      same = same && it->inputs[i].shape() == batch[0].inputs[i].shape() &&
+             it->inputs[i].dtype() == batch[0].inputs[i].dtype();
+    }
+    if (same) {
+      batch.push_back(std::move(*it));
+      it = queue_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return batch;
+}
+
+void CachedOpBatcher::Work() {
+  Imperative::Get()->set_is_np_shape(is_np_shape_);
+  while (true) {
+    std::vector<Request> batch = NextBatch();
+    if (batch.empty())
+      return;
+    Run(&batch);
+  }
+}
+
+void CachedOpBatcher::Run(std::vector<Request>* batch) {
+  const size_t n                = batch->size();
+  const size_t bucket           = Bucket(n);
+  const uint32_t size           = buckets_[bucket];
+  const Clock::time_point start = Clock::now();
+  std::vector<NDArray> outputs;
+  std::string error;
+  try {
+    // gather the requests into the batch of the bucket, padded with zeros
+    std::vector<NDArray> data;
+    data.reserve(data_indices_.size());
+    for (size_t i = 0; i < data_indices_.size(); ++i) {
+      const NDArray& sample = (*batch)[0].inputs[i];
+      mxnet::TShape shape   = sample.shape();
+      shape[0]              = size;
+      data.emplace_back(shape, ctx_, false, sample.dtype());
+      for (size_t j = 0; j < n; ++j) {
+        NDArray row = data.back().Slice(j, j + 1);
+        CopyFromTo((*batch)[j].inputs[i], &row);
+      }
+      if (n < size) {
+        NDArray padding = data.back().Slice(n, size);
+        padding         = 0;
+      }
+    }
+    std::vector<NDArray*> inputs(num_inputs_);
+    for (size_t i = 0; i < data_indices_.size(); ++i) {
+      inputs[data_indices_[i]] = &data[i];
+    }
+    for (size_t i = 0; i < param_indices_.size(); ++i) {
+      inputs[param_indices_[i]] = &params_[i];
+    }
+    const CachedOpThreadSafePtr& op = ops_[bucket];
+    outputs.resize(op->num_outputs());
+    std::vector<NDArray*> output_ptrs;
+    for (auto& output : outputs) {
+      output_ptrs.push_back(&output);
+    }
+    op->Forward(op, inputs, output_ptrs, ctx_);
+    for (const auto& output : outputs) {
+      CHECK(output.shape().ndim() > 0 && output.shape()[0] == size)
+          << "The outputs of a batched model must have the batch on their first axis, got "
+          << output.shape() << " for a batch of " << size;
+      output.WaitToRead();
+    }
+  } catch (const std::exception& e) {
+    error = e.what();
+  }
+  if (error.empty()) {
+    const double run_time_us =
+        std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(mutex_);
+    double& estimate = run_time_us_[bucket];
+    estimate         = estimate == 0 ? run_time_us : 0.9 * estimate + 0.1 * run_time_us;
+  }
+  // scatter the rows of the outputs back to the requests
+  for (size_t j = 0; j < n; ++j) {
+    std::vector<NDArray> result;
+    if (error.empty()) {
+      for (const auto& output : outputs) {
+        result.push_back(output.Slice(j, j + 1));
+      }
+    }
+    try {
+      (*batch)[j].callback(result, error);
+    } catch (const std::exception& e) {
+      LOG(WARNING) << "The callback of a CachedOpBatcher request failed: " << e.what();
+    }
+  }
+}
+
+}  // namespace mxnet
@@ -0,0 +1,138 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Dynamic batching of the inference requests of a cached op
+#ifndef MXNET_IMPERATIVE_CACHED_OP_BATCHER_H_
+#define MXNET_IMPERATIVE_CACHED_OP_BATCHER_H_
+
+#include <mxnet/ndarray.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "./cached_op_threadsafe.h"
+
+namespace mxnet {
+/*! \brief CachedOpBatcher Parameters, the other flags go to the cached ops */
+struct CachedOpBatcherConfig : public dmlc::Parameter<CachedOpBatcherConfig> {
+  uint32_t max_batch_size;
+  // batch sizes the cached ops run with
+  mxnet::Tuple<uint32_t> batch_buckets;
+  uint32_t max_delay_us;
+  uint32_t latency_slo_us;
+  uint32_t max_concurrency;
+  DMLC_DECLARE_PARAMETER(CachedOpBatcherConfig) {
+    DMLC_DECLARE_FIELD(max_batch_size)
+        .set_default(8)
+        .set_lower_bound(1)
+        .describe("Maximum number of requests coalesced into a batch.");
+    DMLC_DECLARE_FIELD(batch_buckets)
+        .set_default(mxnet::Tuple<uint32_t>())
+        .describe(
+            "Batch sizes the cached op runs with, a batch being padded to the smallest "
+            "bucket holding it. Powers of two up to max_batch_size by default.");
+    DMLC_DECLARE_FIELD(max_delay_us)
+        .set_default(1000)
+        .describe("Maximum time the oldest request waits for more requests, in microseconds.");
+    DMLC_DECLARE_FIELD(latency_slo_us)
+        .set_default(0)
+        .describe(
+            "Latency objective of the requests in microseconds, 0 for none. The batches are "
+            "launched earlier and smaller so that the measured run time of their bucket keeps "
+            "their oldest request within the objective.");
+    DMLC_DECLARE_FIELD(max_concurrency)
+        .set_default(1)
+        .set_lower_bound(1)
+        .describe("Maximum number of batches of the model running at the same time.");
+  }
+};
+
+/*!
+ * \brief Inference server core of a model: coalesces the concurrent requests of single samples
+ *  into batches, runs them through a cached op per batch size bucket, and scatters the outputs
+ *  back to the requests. The data inputs and the outputs have the batch on their first axis.
+ */
+class CachedOpBatcher {
+ public:
+  /*! \brief receives the outputs of a request, or the error which failed it */
+  using Callback =
+      std::function<void(const std::vector<NDArray>& outputs, const std::string& error)>;
+
+  CachedOpBatcher(const nnvm::Symbol& sym,
+                  const std::vector<std::pair<std::string, std::string>>& flags,
+                  const std::vector<NDArray>& params,
+                  const Context& ctx);
+  /*! \brief runs the pending requests, then stops the workers */
+  ~CachedOpBatcher();
+  /*!
+   * \brief queues a request
+   * \param inputs the data inputs of the request, with a batch of 1
+   * \param callback called from a worker thread with the outputs of the request
+   */
+  void Submit(const std::vector<NDArray>& inputs, Callback callback);
+  uint32_t num_data() const {
+    return data_indices_.size();
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  struct Request {
+    std::vector<NDArray> inputs;
+    Callback callback;
+    Clock::time_point arrival;
+  };
+
+  void Work();
+  /*! \brief index of the smallest bucket holding n requests */
+  size_t Bucket(size_t n) const;
+  /*! \brief deadline of the coalescing of the requests after the oldest one */
+  Clock::time_point Deadline(const Clock::time_point& oldest) const;
+  /*! \brief number of the queued requests to launch in a batch now */
+  size_t BatchSize(size_t queued, const Clock::time_point& oldest, const Clock::time_point& now)
+      const;
+  /*! \brief takes the next batch from the queue, empty when stopping */
+  std::vector<Request> NextBatch();
+  void Run(std::vector<Request>* batch);
+
+  CachedOpBatcherConfig config_;
+  std::vector<uint32_t> buckets_;
+  std::vector<CachedOpThreadSafePtr> ops_;
+  std::vector<NDArray> params_;
+  std::vector<uint32_t> data_indices_;
+  std::vector<uint32_t> param_indices_;
+  size_t num_inputs_;
+  Context ctx_;
+  // numpy shape semantics of the creating thread, applied to the workers
+  int is_np_shape_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<Request> queue_;
+  // exponential moving average of the run time of each bucket in microseconds, 0 until measured
+  std::vector<double> run_time_us_;
+  bool stop_ = false;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace mxnet
+#endif  // MXNET_IMPERATIVE_CACHED_OP_BATCHER_H_
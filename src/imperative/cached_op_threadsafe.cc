@@ -39,7 +39,23 @@ struct CachedOpThreadSafe::DynamicRuntime {
   std::vector<OpStatePtr> op_states;
 };
 
+namespace {
+
+/*! \brief flags of the CachedOp base, without the ones only the thread-safe version knows */
+std::vector<std::pair<std::string, std::string>> BaseFlags(
+    const std::vector<std::pair<std::string, std::string>>& flags) {
+  std::vector<std::pair<std::string, std::string>> base_flags;
+  for (const auto& flag : flags) {
+    if (flag.first != "num_concurrent_states")
+      base_flags.push_back(flag);
+  }
+  return base_flags;
+}
+
+}  // namespace
+
 OpStatePtr CachedOpThreadSafe::GetCachedOpState(const Context& ctx) {
+  std::lock_guard<std::mutex> lock(states_mutex_);
   for (const auto& i : cached_op_states_[ctx]) {
     // only create one state per device when not using static memory
     if (!config_.static_alloc || i.unique()) {
@@ -53,10 +69,33 @@ OpStatePtr CachedOpThreadSafe::GetCachedOpState(const Context& ctx) {
   return state_ptr;
 }
 
+OpStatePtr CachedOpThreadSafe::AcquireState(const Context& ctx) {
+  std::unique_lock<std::mutex> lock(states_mutex_);
+  auto& free_states = free_states_[ctx];
+  auto& states      = cached_op_states_[ctx];
+  if (free_states.empty() && states.size() < config_.num_concurrent_states) {
+    nnvm::Graph full_graph;
+    states.push_back(OpStatePtr::Create<CachedOpState>(ctx, fwd_graph_, full_graph, false));
+    return states.back();
+  }
+  state_released_.wait(lock, [&free_states] { return !free_states.empty(); });
+  OpStatePtr state = free_states.back();
+  free_states.pop_back();
+  return state;
+}
+
+void CachedOpThreadSafe::ReleaseState(const Context& ctx, const OpStatePtr& state) {
+  {
+    std::lock_guard<std::mutex> lock(states_mutex_);
+    free_states_[ctx].push_back(state);
+  }
+  state_released_.notify_one();
+}
+
 CachedOpThreadSafe::CachedOpThreadSafe(
     const nnvm::Symbol& sym,
     const std::vector<std::pair<std::string, std::string>>& flags)
-    : CachedOp(sym, flags) {
+    : CachedOp(sym, BaseFlags(flags)) {
   using namespace nnvm;
   using namespace imperative;
   static const std::vector<const Op*> zero_ops{Op::Get("zeros_like"), Op::Get("_zeros")};
@@ -163,7 +202,10 @@ OpStatePtr CachedOpThreadSafe::Forward(const std::shared_ptr<CachedOp>& op_ptr,
   // in the accept4 call in CUDA lib.
   // TODO(anirudh2290): Investigate this issue more as it also prevents parallel
   // push of ops for different contexts
-  std::lock_guard<std::mutex> lock(mutex_);
+  // With num_concurrent_states, concurrent calls run on separate states instead.
+  std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+  if (config_.num_concurrent_states == 0)
+    lock.lock();
   CHECK_EQ(inputs.size(), num_inputs());
   const auto& idx = fwd_graph_.indexed_graph();
   for (size_t i = 0; i < inputs.size(); ++i) {
@@ -179,7 +221,17 @@ OpStatePtr CachedOpThreadSafe::Forward(const std::shared_ptr<CachedOp>& op_ptr,
     if (CheckDynamicShapeExists(default_ctx, inputs, true)) {
       LOG(FATAL) << "Dynamic shapes aren't supported with thread-safe cached op";
     }
-    if (config_.static_alloc) {
+    if (config_.static_alloc && config_.num_concurrent_states > 0) {
+      OpStatePtr state_ptr = AcquireState(default_ctx);
+      try {
+        op_state = StaticForward(default_ctx, inputs, outputs, state_ptr);
+      } catch (const dmlc::Error& e) {
+        ReleaseState(default_ctx, state_ptr);
+        throw e;
+      }
+      // the state may be reused right away, the engine orders the accesses to its buffers
+      ReleaseState(default_ctx, state_ptr);
+    } else if (config_.static_alloc) {
       op_state = StaticForward(default_ctx, inputs, outputs);
     } else {
       op_state = DynamicForward(default_ctx, inputs, outputs);
@@ -25,6 +25,8 @@
 #include <mxnet/imperative.h>
 #include <vector>
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <utility>
 #include <string>
 #include <unordered_map>
@@ -44,6 +46,8 @@ struct CachedOpThreadSafeConfig : public dmlc::Parameter<CachedOpThreadSafeConfi
   uint32_t forward_bulk_size;
   bool static_alloc;
   bool static_shape;
+  // number of forward states per context that concurrent calls may use
+  uint32_t num_concurrent_states;
   DMLC_DECLARE_PARAMETER(CachedOpThreadSafeConfig) {
     DMLC_DECLARE_FIELD(static_alloc)
         .set_default(false)
@@ -65,6 +69,13 @@ struct CachedOpThreadSafeConfig : public dmlc::Parameter<CachedOpThreadSafeConfi
     DMLC_DECLARE_FIELD(param_indices)
         .set_default(mxnet::Tuple<uint32_t>())
         .describe("Position of parameters.");
+    DMLC_DECLARE_FIELD(num_concurrent_states)
+        .set_default(0)
+        .describe(
+            "Maximum number of forward states per context used by concurrent calls. "
+            "Each state has its own memory plan, buffers and operator states, "
+            "the parameters are shared. With static_alloc, a call waits for a free state "
+            "once all of them are in use. 0 runs the calls one at a time.");
   }
 };
 
@@ -114,6 +125,10 @@ class CachedOpThreadSafe : public CachedOp {
   struct DynamicRuntime;
 
   OpStatePtr GetCachedOpState(const Context& ctx);
+  /*! \brief take a forward state for exclusive use, waits if all states are in use */
+  OpStatePtr AcquireState(const Context& ctx);
+  /*! \brief give a state taken with AcquireState back to the pool */
+  void ReleaseState(const Context& ctx, const OpStatePtr& state);
 
   OpStatePtr DynamicForward(const Context& default_ctx,
                             const std::vector<NDArray*>& inputs,
@@ -123,6 +138,10 @@ class CachedOpThreadSafe : public CachedOp {
   nnvm::Graph fwd_graph_;
   std::mutex mutex_;
   std::unordered_map<Context, std::vector<OpStatePtr>> cached_op_states_;
+  /*! \brief guards the states and the pool of free states */
+  std::mutex states_mutex_;
+  std::condition_variable state_released_;
+  std::unordered_map<Context, std::vector<OpStatePtr>> free_states_;
 };
 
 using CachedOpThreadSafePtr = std::shared_ptr<CachedOpThreadSafe>;
@@ -30,6 +30,7 @@
 #include <mxnet/graph_attr_types.h>
 #include <nnvm/graph.h>
 #include <nnvm/graph_attr_types.h>
+#include <functional>
 #include <utility>
 #include <vector>
 #include <memory>
@@ -225,16 +226,36 @@ Graph EliminateCommonExpr(Graph&& g);
  *
  * \param g input graph (needs to be entire graph, not just forward part)
  * \param num_forward_outputs number of outputs in the graph produced by the forward pass
+ * \param dev_mask device the fused operations run on
  *
  * \return copy of the graph with fused pointwise operations
  */
-Graph FusePointwise(const Graph& g, const size_t num_forward_outputs);
+Graph FusePointwise(const Graph& g,
+                    const size_t num_forward_outputs,
+                    const int dev_mask = Context::kGPU);
 
 /*!
  * \brief Issue a one-time warning that fusion is not possible for this platform or build.
  */
 void WarnFusionNotSupported();
 
+/*!
+ * \brief Select the forward nodes whose outputs are dropped after forward and
+ *        recomputed in backward, so that the kept activations fit a memory budget.
+ *        Nodes are picked greedily by estimated FLOPs of recomputation per byte saved.
+ *
+ * \param fwd_graph input forward graph
+ * \param arg_shapes shapes of the inputs of the graph
+ * \param arg_dtypes data types of the inputs of the graph
+ * \param budget bytes of activations that may be kept for backward
+ *
+ * \return mirror function for the gradient pass, nullptr if no recomputation is needed
+ */
+std::function<int(const nnvm::Node&)> PlanRecompute(const Graph& fwd_graph,
+                                                    mxnet::ShapeVector&& arg_shapes,
+                                                    nnvm::DTypeVector&& arg_dtypes,
+                                                    size_t budget);
+
 /*!
  * \brief Infer shapes in the graph given the information.
  * \param graph The input graph.
@@ -18,6 +18,7 @@
  */
 #include <algorithm>
 #include <iostream>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -33,16 +34,125 @@ namespace mxnet {
 thread_local bool Imperative::is_train_                 = false;
 thread_local bool Imperative::is_recording_             = false;
 thread_local bool Imperative::is_deferred_compute_      = false;
+thread_local bool Imperative::is_lazy_eval_             = false;
 thread_local OptConstraint Imperative::opt_constraints_ = OptConstraint::None;
 thread_local bool Imperative::is_np_shape_thread_local_ = false;
 #else
 MX_THREAD_LOCAL bool Imperative::is_train_                 = false;
 MX_THREAD_LOCAL bool Imperative::is_recording_             = false;
 MX_THREAD_LOCAL bool Imperative::is_deferred_compute_      = false;
+MX_THREAD_LOCAL bool Imperative::is_lazy_eval_             = false;
 MX_THREAD_LOCAL OptConstraint Imperative::opt_constraints_ = OptConstraint::None;
 MX_THREAD_LOCAL bool Imperative::is_np_shape_thread_local_ = false;
 #endif
 
+namespace {
+
+/*!
+ * \brief Per thread cache of the inferred output attributes and dispatch mode of
+ *  imperative operator calls. Repeated calls of the same operator with the same attributes
+ *  and the same input and output shapes, types and storage types skip the inference.
+ *  Only stateless operators with static shape inference are cached.
+ */
+class DispatchCache {
+ public:
+  struct Entry {
+    mxnet::ShapeVector out_shapes;
+    std::vector<int> out_types;
+    std::vector<int> out_storage_types;
+    DispatchMode dispatch_mode;
+  };
+
+  DispatchCache()
+      : capacity_(dmlc::GetEnv("MXNET_IMPERATIVE_DISPATCH_CACHE_SIZE", size_t{4096})) {}
+
+  static DispatchCache* Get() {
+    return dmlc::ThreadLocalStore<DispatchCache>::Get();
+  }
+
+  /*! \return whether the inference results of the call only depend on the key */
+  bool Cacheable(const nnvm::NodeAttrs& attrs,
+                 const std::vector<NDArray*>& inputs,
+                 const std::vector<NDArray*>& outputs) const {
+    static auto& infershape        = nnvm::Op::GetAttr<mxnet::FInferShape>("FInferShape");
+    static auto& createop          = nnvm::Op::GetAttr<FCreateOpState>("FCreateOpState");
+    static auto& is_layer_backward = Op::GetAttr<bool>("TIsLayerOpBackward");
+    if (capacity_ == 0 || !infershape.count(attrs.op) || createop.count(attrs.op) ||
+        is_layer_backward.get(attrs.op, false))
+      return false;
+    for (const NDArray* i : inputs) {
+      if (!shape_is_known(i->shape()))
+        return false;
+    }
+    for (const NDArray* o : outputs) {
+      if (!o->is_none() && !shape_is_known(o->shape()))
+        return false;
+    }
+    return true;
+  }
+
+  /*! \brief serialize everything the inference results depend on */
+  static std::string Key(const Context& ctx,
+                         const nnvm::NodeAttrs& attrs,
+                         const std::vector<NDArray*>& inputs,
+                         const std::vector<NDArray*>& outputs) {
+    std::string key;
+    Append(&key, attrs.op);
+    Append(&key, ctx.dev_type);
+    Append(&key, ctx.dev_id);
+    Append(&key, Imperative::Get()->is_np_shape());
+    Append(&key, Imperative::Get()->is_training());
+    for (const auto& kv : attrs.dict) {
+      AppendString(&key, kv.first);
+      AppendString(&key, kv.second);
+    }
+    for (const NDArray* i : inputs)
+      AppendArray(&key, *i);
+    Append(&key, outputs.size());
+    for (const NDArray* o : outputs) {
+      Append(&key, o->is_none());
+      if (!o->is_none())
+        AppendArray(&key, *o);
+    }
+    return key;
+  }
+
+  const Entry* Find(const std::string& key) const {
+    auto it = entries_.find(key);
+    return it == entries_.end() ? nullptr : &it->second;
+  }
+
+  void Insert(std::string&& key, Entry&& entry) {
+    // unbounded sets of keys, e.g. from ever changing shapes, start over instead of growing
+    if (entries_.size() >= capacity_)
+      entries_.clear();
+    entries_.emplace(std::move(key), std::move(entry));
+  }
+
+ private:
+  template <typename T>
+  static void Append(std::string* key, const T& value) {
+    key->append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+  static void AppendString(std::string* key, const std::string& str) {
+    Append(key, str.size());
+    key->append(str);
+  }
+  static void AppendArray(std::string* key, const NDArray& arr) {
+    const mxnet::TShape& shape = arr.shape();
+    Append(key, shape.ndim());
+    for (int i = 0; i < shape.ndim(); ++i)
+      Append(key, shape[i]);
+    Append(key, arr.dtype());
+    Append(key, arr.storage_type());
+  }
+
+  const size_t capacity_;
+  std::unordered_map<std::string, Entry> entries_;
+};
+
+}  // namespace
+
 Imperative* Imperative::Get() {
   static Imperative inst;
   return &inst;
@@ -123,7 +233,32 @@ OpStatePtr Imperative::Invoke(const Context& default_ctx,
   // TODO(piiswrong): infer ctx
   DispatchMode dispatch_mode = DispatchMode::kUndefined;
   Context ctx                = GetContext(attrs, inputs, outputs, default_ctx);
-  SetShapeType(ctx, attrs, inputs, outputs, &dispatch_mode);
+  DispatchCache* cache       = DispatchCache::Get();
+  const bool cacheable       = cache->Cacheable(attrs, inputs, outputs);
+  std::string key;
+  const DispatchCache::Entry* cached = nullptr;
+  if (cacheable) {
+    key    = DispatchCache::Key(ctx, attrs, inputs, outputs);
+    cached = cache->Find(key);
+  }
+  if (cached != nullptr) {
+    // the preallocated outputs were already checked when the entry was created
+    dispatch_mode = cached->dispatch_mode;
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      if (outputs[i]->is_none()) {
+        const auto storage_type = static_cast<NDArrayStorageType>(cached->out_storage_types[i]);
+        outputs[i]->ReInit(storage_type, cached->out_shapes[i], ctx, cached->out_types[i]);
+        outputs[i]->AssignStorageInfo(common::NodeAttrsGetProfilerScope(attrs), attrs.name);
+      }
+    }
+  } else {
+    SetShapeType(ctx, attrs, inputs, outputs, &dispatch_mode);
+    if (cacheable) {
+      MXAPIThreadLocalEntry<>* ret = MXAPIThreadLocalStore<>::Get();
+      cache->Insert(std::move(key),
+                    {ret->out_shapes, ret->out_types, ret->out_storage_types, dispatch_mode});
+    }
+  }
   std::vector<OpReqType> req;
   SetWriteInplaceReq(inputs, outputs, &req);
   OpStatePtr ret = InvokeOp(ctx, attrs, inputs, outputs, req, dispatch_mode);
@@ -491,6 +626,9 @@ std::vector<NDArray*> Imperative::Backward(const std::vector<NDArray*>& outputs,
   std::vector<NodeEntry> xs;
   std::vector<NDArray*> x_grads;
   std::vector<OpReqType> x_reqs;
+  std::vector<NDArray> cast_grads;
+  std::vector<NDArray*> cast_dsts;
+  std::vector<OpReqType> cast_reqs;
   if (variables.size()) {
     xs.reserve(variables.size());
     x_grads.reserve(variables.size());
@@ -509,13 +647,30 @@ std::vector<NDArray*> Imperative::Backward(const std::vector<NDArray*>& outputs,
     xs.reserve(args.size());
     x_grads.reserve(args.size());
     x_reqs.reserve(args.size());
+    cast_grads.reserve(args.size());
     for (const auto& i : args) {
       AGInfo& info = AGInfo::Get(i);
       if (info.grad_req == kNullOp)
         continue;
       xs.emplace_back(NodeEntry{i, 0, 0});
-      x_grads.push_back(&info.out_grads[0]);
-      x_reqs.push_back(info.grad_req);
+      NDArray& grad = info.out_grads[0];
+      if (!info.outputs.empty() && grad.storage_type() == kDefaultStorage &&
+          grad.dtype() != info.outputs[0].dtype()) {
+        // The gradient buffer is wider than its variable (e.g. fp32 gradients of fp16
+        // parameters). Compute the gradient in the variable dtype and cast it into the
+        // buffer afterwards with the buffer's req, so that grad_req='add' accumulates
+        // micro-batches straight into the wide buffer.
+        CHECK(!create_graph) << "Cannot create the gradient graph of a variable whose "
+                             << "gradient dtype differs from its own dtype.";
+        cast_grads.emplace_back(grad.shape(), grad.ctx(), true, info.outputs[0].dtype());
+        cast_dsts.push_back(&grad);
+        cast_reqs.push_back(info.grad_req);
+        x_grads.push_back(&cast_grads.back());
+        x_reqs.push_back(kWriteTo);
+      } else {
+        x_grads.push_back(&grad);
+        x_reqs.push_back(info.grad_req);
+      }
       info.fresh_out_grad = true;
     }
     CHECK_GT(xs.size(), 0) << "There are no inputs in computation graph that require gradients.";
@@ -731,6 +886,22 @@ std::vector<NDArray*> Imperative::Backward(const std::vector<NDArray*>& outputs,
              &states,
              dispatch_modes,
              is_recording());
+    if (!cast_grads.empty()) {
+      static const Op* amp_cast_op = Op::Get("amp_cast");
+      for (size_t i = 0; i < cast_grads.size(); ++i) {
+        nnvm::NodeAttrs attrs;
+        attrs.op            = amp_cast_op;
+        attrs.name          = "_grad_cast";
+        attrs.dict["dtype"] = common::mshadow_type_info(cast_dsts[i]->dtype()).name;
+        attrs.op->attr_parser(&attrs);
+        InvokeOp(cast_dsts[i]->ctx(),
+                 attrs,
+                 {&cast_grads[i]},
+                 {cast_dsts[i]},
+                 {cast_reqs[i]},
+                 DispatchMode::kFCompute);
+      }
+    }
   } catch (const dmlc::Error& e) {
     Engine::Get()->set_bulk_size(prev_bulk_size);
     set_is_recording(prev_recording);
@@ -795,7 +966,11 @@ void Imperative::DCInfo::Compute(const NDArray& arr) {
     return;
   }
 
-  DCInfo& info      = Imperative::DCInfo::Get(arr.deferredcompute_entry_.node);
+  DCInfo& info = Imperative::DCInfo::Get(arr.deferredcompute_entry_.node);
+  if (info.is_lazy_) {
+    Imperative::Get()->ComputeLazyEval({arr});
+    return;
+  }
   info.is_computed_ = true;  // We will Invoke at the end of this function.
 
   // Recursively compute input arrays
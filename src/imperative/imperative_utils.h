@@ -19,11 +19,13 @@
 // The first two includes below need to be in unalphabetical for the miscellaneous CI to pass.
 #include <mxnet/operator.h>
 #include <mxnet/imperative.h>
+#include <dmlc/thread_local.h>
 #include <nnvm/pass_functions.h>
 
 #include <algorithm>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -34,6 +36,8 @@
 #include "../common/utils.h"
 #include "../operator/nn/dnnl/dnnl_base-inl.h"
 #include "../operator/operator_common.h"
+#include "../profiler/profiler.h"
+#include "../profiler/storage_profiler.h"
 #include "./exec_pass.h"
 
 #ifndef MXNET_IMPERATIVE_IMPERATIVE_UTILS_H_
@@ -123,6 +127,8 @@ struct MemoryPlanInfo {
   uint32_t root;
   size_t size;
   bool inplace;
+  // the byte offset of the entry in its storage when it is a slice of it, or -1
+  int64_t slice_offset;
 };
 
 struct EngineOprDeleter {
@@ -361,6 +367,10 @@ inline void SetDependency(const nnvm::NodeAttrs& attrs,
       switch (req.type) {
         case ResourceRequest::kTempSpace:
           ++ntmp;
+          requested.push_back(ResourceManager::Get()->RequestOpTempSpace(ctx));
+          if (requested.back().var != nullptr)
+            write_vars.push_back(requested.back().var);
+          break;
         case ResourceRequest::kRandom:
           requested.push_back(ResourceManager::Get()->Request(ctx, req));
           write_vars.push_back(requested.back().var);
@@ -384,8 +394,9 @@ inline void SetDependency(const nnvm::NodeAttrs& attrs,
 
   // append extra resource requests for storage fallback
   if (dispatch_mode == DispatchMode::kFComputeFallback) {
-    requested.push_back(ResourceManager::Get()->Request(ctx, ResourceRequest::kTempSpace));
-    write_vars.push_back(requested.back().var);
+    requested.push_back(ResourceManager::Get()->RequestOpTempSpace(ctx));
+    if (requested.back().var != nullptr)
+      write_vars.push_back(requested.back().var);
   }
 
   read_vars.reserve(inputs.size());
@@ -425,8 +436,13 @@ inline void SetWriteInplaceReq(const std::vector<NDArray*>& inputs,
   }
 }
 
+/*! \brief The attributes parsed by the imperative calls of a thread, by operator and dict */
+using ParsedAttrsCache = std::unordered_map<std::string, nnvm::NodeAttrs>;
+
 /*!
- * \brief Parse parameter attributes into a nnvm::NodeAttrs structure
+ * \brief Parse parameter attributes into a nnvm::NodeAttrs structure. The attributes parsed
+ *  for the same operator and parameters by an earlier call of the thread are copied instead,
+ *  see MXNET_IMPERATIVE_ATTRS_CACHE_SIZE.
  * \param op Pointer to the nnvm Operator object
  * \param num_inputs Number of operator inputs
  * \param num_params Number of parameters
@@ -439,7 +455,32 @@ inline nnvm::NodeAttrs ParseAttrs(const nnvm::Op* op,
                                   const int num_params,
                                   const char** param_keys,
                                   const char** param_vals) {
-  static auto& num_args = nnvm::Op::GetAttr<std::string>("key_var_num_args");
+  static auto& num_args         = nnvm::Op::GetAttr<std::string>("key_var_num_args");
+  static auto& no_cache         = nnvm::Op::GetAttr<TAttrParserNoCache>("TAttrParserNoCache");
+  static const size_t cache_size = dmlc::GetEnv("MXNET_IMPERATIVE_ATTRS_CACHE_SIZE", size_t{4096});
+
+  // the key holds everything the parsers read: the operator, the inputs and the dict, and the
+  // numpy shape semantics some of them check
+  const bool use_cache = cache_size > 0 && op->attr_parser != nullptr && !no_cache.get(op, false);
+
+  ParsedAttrsCache* cache = nullptr;
+  std::string key;
+  if (use_cache) {
+    cache = dmlc::ThreadLocalStore<ParsedAttrsCache>::Get();
+    key.append(reinterpret_cast<const char*>(&op), sizeof(op));
+    key.push_back(static_cast<char>(Imperative::Get()->is_np_shape()));
+    key.append(std::to_string(num_inputs));
+    for (int i = 0; i < num_params; ++i) {
+      key.push_back('\0');
+      key.append(param_keys[i]);
+      key.push_back('\0');
+      key.append(param_vals[i]);
+    }
+    auto it = cache->find(key);
+    if (it != cache->end()) {
+      return it->second;
+    }
+  }
 
   nnvm::NodeAttrs attrs;
   attrs.op = op;
@@ -453,6 +494,13 @@ inline nnvm::NodeAttrs ParseAttrs(const nnvm::Op* op,
   if (op->attr_parser != nullptr) {
     op->attr_parser(&attrs);
   }
+  // the subgraphs are owned by the node, copies would share them
+  if (use_cache && attrs.subgraphs.empty()) {
+    if (cache->size() >= cache_size) {
+      cache->clear();
+    }
+    cache->emplace(std::move(key), attrs);
+  }
 
   return attrs;
 }
@@ -527,6 +575,47 @@ inline void DerefInputOutputRelease(const std::vector<NDArray*>& inputs,
     delete i;
 }
 
+/*!
+ * \brief add the work estimated by the FOpCost of the operator to the operator being profiled
+ *        on this thread, if aggregate statistics are collected
+ */
+inline void RecordOpCost(const nnvm::NodeAttrs& attrs,
+                         const std::vector<TBlob>& inputs,
+                         const std::vector<TBlob>& outputs) {
+  profiler::ProfileOperator* profile = profiler::ProfileOperator::Current();
+  if (profile == nullptr || attrs.op == nullptr) {
+    return;
+  }
+  static auto& fop_cost = nnvm::Op::GetAttr<FOpCost>("FOpCost");
+  if (fop_cost.count(attrs.op)) {
+    const OpCost cost = fop_cost[attrs.op](attrs, inputs, outputs);
+    profile->AddCost(cost.flops, cost.bytes);
+  }
+}
+
+/*!
+ * \brief RecordOpCost of NDArrays, only the dense ones, whose shapes describe the data moved
+ */
+inline void RecordOpCost(const nnvm::NodeAttrs& attrs,
+                         const std::vector<NDArray>& inputs,
+                         const std::vector<NDArray>& outputs) {
+  if (profiler::ProfileOperator::Current() == nullptr) {
+    return;
+  }
+  std::vector<TBlob> input_blobs, output_blobs;
+  for (const auto& p : {std::make_pair(&inputs, &input_blobs),
+                        std::make_pair(&outputs, &output_blobs)}) {
+    for (const NDArray& nd : *p.first) {
+      if (nd.is_none() || nd.storage_type() != kDefaultStorage) {
+        return;
+      }
+      // the data is not touched, a layout-converted array keeps its logical shape
+      p.second->emplace_back(nullptr, nd.shape(), nd.ctx().dev_mask(), nd.dtype());
+    }
+  }
+  RecordOpCost(attrs, input_blobs, output_blobs);
+}
+
 /*
  * \brief setup default-storage tblobs from source NDArrays. If any source NDArray has non-default
  *        storage, it creates a temp NDArray with default storage and uses the temp tblob. The
@@ -696,10 +785,11 @@ inline void PushFCompute(const FCompute& fn,
     OpContext opctx{need_grad, is_train, rctx, engine::CallbackOnComplete(), requested};
     bool is_gpu = ctx.dev_mask() == gpu::kDevMask;
     // pre-fcompute fallback, cast to default storage type
-    CastNonDefaultStorage(pre_temp_src, pre_temp_dst, opctx, is_gpu);
+    CastNonDefaultStorage(pre_temp_src, pre_temp_dst, opctx, is_gpu, &attrs);
+    RecordOpCost(attrs, input_blobs, output_blobs);
     fn(attrs, opctx, input_blobs, tmp_req, output_blobs);
     // post-fcompute fallback, cast to original storage type
-    CastNonDefaultStorage(post_temp_src, post_temp_dst, opctx, is_gpu);
+    CastNonDefaultStorage(post_temp_src, post_temp_dst, opctx, is_gpu, &attrs);
     DerefInputOutputRelease(inputs, outputs);
   };
   if (CheckIfSkipEngine(attrs)) {
@@ -734,6 +824,7 @@ inline void PushFComputeEx(const FComputeEx& fn,
     REDEFINE_INPUTS_OUTPUTS(inputs, outputs, inputsA, outputsA);
     INVALIDATE_OUTPUTS_COND(!cross_device_copy, outputsA, req);
     CREATE_DEFAULT_INPUTS(!cross_device_copy, attrs, CreateDefaultInputs(&inputsA));
+    RecordOpCost(attrs, inputsA, outputsA);
     fn(attrs, opctx, inputsA, req, outputsA);
   };
   if (cross_device_copy || CheckIfSkipEngine(attrs)) {
@@ -779,6 +870,7 @@ inline void PushOperator(const OpStatePtr& state,
                             attrs,
                             CreateDefaultInputs(&inputsA));
       on_start();
+      RecordOpCost(attrs, inputsA, outputsA);
       fcompute_ex(state, opctx, inputsA, req, outputsA);
     };
 
@@ -839,10 +931,11 @@ inline void PushOperator(const OpStatePtr& state,
       // setup contexts
       const bool is_gpu = rctx.get_ctx().dev_mask() == gpu::kDevMask;
       // pre-fcompute fallback
-      CastNonDefaultStorage(pre_temp_src, pre_temp_dst, opctx, is_gpu);
+      CastNonDefaultStorage(pre_temp_src, pre_temp_dst, opctx, is_gpu, &attrs);
+      RecordOpCost(attrs, input_blobs, output_blobs);
       fcompute(state, opctx, input_blobs, tmp_req, output_blobs);
       // post-fcompute fallback, cast to original storage type, if necessary
-      CastNonDefaultStorage(post_temp_src, post_temp_dst, opctx, is_gpu);
+      CastNonDefaultStorage(post_temp_src, post_temp_dst, opctx, is_gpu, &attrs);
       DerefInputOutputRelease(inputs, outputs);
     };
 
@@ -868,6 +961,73 @@ inline void PushOperator(const OpStatePtr& state,
   }
 }
 
+/*!
+ * \brief Re-infer the shapes of a graph whose input shapes changed only in part of the inputs,
+ *        e.g. the batch dimension of the data inputs.
+ *
+ * Only the nodes depending on a changed input are inferred again, the shapes of all other
+ * entries are kept from the previous inference. Falls back to a full inference (returns false
+ * and leaves the graph untouched) when the previous shapes are not complete or the partial
+ * inference does not succeed.
+ */
+inline bool InferShapeIncremental(nnvm::Graph* p_g, const mxnet::ShapeVector& shapes) {
+  static const bool enabled = dmlc::GetEnv("MXNET_INCREMENTAL_SHAPE_INFERENCE", true);
+  nnvm::Graph& g            = *p_g;
+  if (!enabled || !g.attrs.count("shape") || !g.attrs.count("shape_inputs") ||
+      !g.attrs.count("shape_num_unknown_nodes") ||
+      g.GetAttr<size_t>("shape_num_unknown_nodes") != 0U)
+    return false;
+  const auto& idx         = g.indexed_graph();
+  const auto& prev_inputs = g.GetAttr<mxnet::ShapeVector>("shape_inputs");
+  if (prev_inputs.size() != shapes.size())
+    return false;
+  std::vector<bool> dirty(idx.num_nodes(), false);
+  size_t num_changed = 0;
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    if (prev_inputs[i] != shapes[i]) {
+      dirty[idx.input_nodes()[i]] = true;
+      ++num_changed;
+    }
+  }
+  if (num_changed == 0 || num_changed == shapes.size())
+    return false;
+  // mark all nodes reachable from a changed input, including backward nodes through their
+  // control dependencies on the forward nodes
+  mxnet::ShapeVector rshape = g.GetAttr<mxnet::ShapeVector>("shape");
+  size_t num_dirty          = 0;
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    const auto& inode = idx[nid];
+    if (!dirty[nid]) {
+      for (const auto& e : inode.inputs)
+        dirty[nid] = dirty[nid] || dirty[e.node_id];
+      for (const uint32_t dep : inode.control_deps)
+        dirty[nid] = dirty[nid] || dirty[dep];
+      if (!dirty[nid])
+        continue;
+      for (uint32_t i = 0; i < inode.source->num_outputs(); ++i)
+        rshape[idx.entry_id(nid, i)] = mxnet::TShape();
+    }
+    ++num_dirty;
+  }
+  if (num_dirty == idx.num_nodes())
+    return false;
+  // infer on a shallow copy sharing the indexed graph, so that g is intact on failure
+  nnvm::Graph ig        = g;
+  ig.attrs["shape"]     = std::make_shared<dmlc::any>(std::move(rshape));
+  ig.attrs["node_mask"] = std::make_shared<dmlc::any>(std::move(dirty));
+  ig.attrs.erase("shape_inputs");
+  try {
+    ig = exec::InferShape(std::move(ig), mxnet::ShapeVector(shapes));
+  } catch (const dmlc::Error&) {
+    // an entry outside of the dependent nodes was inferred from a changed shape
+    return false;
+  }
+  if (ig.GetAttr<size_t>("shape_num_unknown_nodes") != 0U)
+    return false;
+  g.attrs = std::move(ig.attrs);
+  return true;
+}
+
 inline bool CheckAndInferShape(nnvm::Graph* p_g,
                                mxnet::ShapeVector&& shapes,
                                bool use_inputs,
@@ -901,6 +1061,8 @@ inline bool CheckAndInferShape(nnvm::Graph* p_g,
         return true;
     }
   }
+  if (use_inputs && InferShapeIncremental(&g, shapes))
+    return false;
   g.attrs.erase("shape");
   g.attrs.erase("shape_inputs");
   if (node_range.second > node_range.first) {
@@ -1100,6 +1262,9 @@ inline MemoryPlanVector MXPlanMemory(nnvm::Graph* p_g,
   const auto& storage_inplace = g.GetAttr<std::vector<int> >("storage_inplace_index");
   g.attrs[storage_plan]       = std::make_shared<any>(storage_inplace);
   const auto& storage_ids     = g.GetAttr<StorageVector>("storage_id");
+  const auto* slice_offsets   = g.attrs.count("storage_slice_offset") ?
+                                  &g.GetAttr<std::vector<int64_t> >("storage_slice_offset") :
+                                  nullptr;
   uint32_t entry_start        = entry_range.first;
   uint32_t entry_end =
       entry_range.second > entry_start ? entry_range.second : idx.num_node_entries();
@@ -1107,18 +1272,20 @@ inline MemoryPlanVector MXPlanMemory(nnvm::Graph* p_g,
   std::unordered_map<int, uint32_t> sid_to_root;
 
   for (uint32_t i = entry_start; i < entry_end; ++i) {
+    const int64_t slice_offset = slice_offsets != nullptr ? slice_offsets->at(i) : -1;
+    // the storage has to hold the entry from its offset in it
+    const size_t end = std::max<int64_t>(slice_offset, 0) +
+                       mshadow::mshadow_sizeof(dtypes[i]) * shapes[i].Size();
     if (storage_ids[i] < 0) {
-      mem_plan[i] = {storage_ids[i], i, 0, false};
+      mem_plan[i] = {storage_ids[i], i, 0, false, -1};
     } else if (!sid_to_root.count(storage_ids[i])) {
       CHECK_LT(storage_inplace[i], 0);
       sid_to_root[storage_ids[i]] = i;
-      mem_plan[i]                 = {
-          storage_ids[i], i, mshadow::mshadow_sizeof(dtypes[i]) * shapes[i].Size(), false};
+      mem_plan[i]                 = {storage_ids[i], i, end, false, slice_offset};
     } else {
-      uint32_t root = sid_to_root[storage_ids[i]];
-      mem_plan[i]   = {storage_ids[i], root, 0, storage_inplace[i] >= 0};
-      mem_plan[root].size =
-          std::max(mem_plan[root].size, mshadow::mshadow_sizeof(dtypes[i]) * shapes[i].Size());
+      uint32_t root       = sid_to_root[storage_ids[i]];
+      mem_plan[i]         = {storage_ids[i], root, 0, storage_inplace[i] >= 0, slice_offset};
+      mem_plan[root].size = std::max(mem_plan[root].size, end);
     }
   }
 
@@ -1134,16 +1301,44 @@ inline std::multimap<size_t, NDArray> AllocateMemory(
     const MemoryPlanVector& mem_plan,
     const std::vector<NDArray*>& arrays,
     std::vector<OpReqType>* array_reqs,
-    std::multimap<size_t, NDArray>&& pool = std::multimap<size_t, NDArray>()) {
+    std::multimap<size_t, NDArray>&& pool = std::multimap<size_t, NDArray>(),
+    bool contiguous                       = false) {
   using namespace nnvm;
   const auto& dtypes = g.GetAttr<DTypeVector>("dtype");
   const auto& shapes = g.GetAttr<mxnet::ShapeVector>("shape");
   const auto& stypes = g.GetAttr<StorageTypeVector>("storage_type");
   std::vector<std::string> data_entry_profiler_scopes(entry_end - entry_start);
   std::vector<std::string> data_entry_names(entry_end - entry_start);
+  std::vector<std::string> data_entry_ops(entry_end - entry_start);
 
   std::multimap<size_t, NDArray> new_pool;
 
+  // With contiguous, all storage roots are carved from one arena instead of being
+  // allocated one by one. Each root keeps the arena alive and has its own engine variable.
+  std::vector<size_t> arena_offset;
+  std::shared_ptr<NDArray> arena;
+  if (contiguous) {
+    constexpr size_t kArenaAlignment = 256;
+    size_t arena_size                = 0;
+    arena_offset.resize(entry_end - entry_start, 0);
+    for (uint32_t i = entry_start; i < entry_end; ++i) {
+      const auto& plan = mem_plan[i];
+      if (plan.storage_id >= 0 && plan.root == i) {
+        arena_offset[i - entry_start] = arena_size;
+        arena_size += (plan.size + kArenaAlignment - 1) / kArenaAlignment * kArenaAlignment;
+      }
+    }
+    if (arena_size > 0) {
+      profiler::MemoryTimeline::Scope memory_scope("memory arena", true);
+      arena = std::make_shared<NDArray>(mxnet::TShape({static_cast<nnvm::dim_t>(arena_size)}),
+                                        default_ctx,
+                                        false,
+                                        mshadow::kUint8);
+    }
+    // the roots of the pool are replaced by the arena
+    pool.clear();
+  }
+
   for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
     const std::string profiler_scope = common::NodeAttrsGetProfilerScope(idx[nid].source->attrs);
     for (uint32_t i = 0; i < idx[nid].source->num_outputs(); ++i) {
@@ -1153,9 +1348,13 @@ inline std::multimap<size_t, NDArray> AllocateMemory(
       }
       data_entry_profiler_scopes[eid - entry_start] = profiler_scope;
       data_entry_names[eid - entry_start]           = idx[nid].source->attrs.name;
+      data_entry_ops[eid - entry_start] =
+          idx[nid].source->op() ? idx[nid].source->op()->name : "null";
     }
   }
 
+  // the buffers of the storage roots, which the other entries of their storage share
+  std::vector<const NDArray*> buffers(entry_end - entry_start, nullptr);
   const NDArray* pntr;
   for (uint32_t i = entry_start; i < entry_end; ++i) {
     const auto& plan = mem_plan[i];
@@ -1172,7 +1371,16 @@ inline std::multimap<size_t, NDArray> AllocateMemory(
     CHECK_EQ(stypes[i], kDefaultStorage);
     if (plan.root == i) {
       auto iter = pool.lower_bound(plan.size);
-      if (iter != pool.end()) {
+      if (arena) {
+        uint8_t* dptr = static_cast<uint8_t*>(arena->data().dptr_) + arena_offset[i - entry_start];
+        const TBlob blob(dptr,
+                         mxnet::TShape({static_cast<nnvm::dim_t>(plan.size)}),
+                         default_ctx.dev_mask(),
+                         mshadow::kUint8,
+                         default_ctx.dev_id);
+        NDArray buff(blob, default_ctx.dev_id, [arena]() {});
+        pntr = &new_pool.insert({plan.size, buff})->second;
+      } else if (iter != pool.end()) {
         pntr = &new_pool.insert(*iter)->second;
         pool.erase(iter);
       } else {
@@ -1182,15 +1390,27 @@ inline std::multimap<size_t, NDArray> AllocateMemory(
                      mshadow::kUint8);
         buff.AssignStorageInfo(data_entry_profiler_scopes[i - entry_start],
                                data_entry_names[i - entry_start]);
+        if (profiler::MemoryTimeline::IsProfiling()) {
+          // allocate now rather than in the first operator writing it, so that the memory
+          // timeline attributes the buffer to the planner for the operator it was planned for
+          profiler::MemoryTimeline::Scope memory_scope(data_entry_ops[i - entry_start].c_str(),
+                                                       true);
+          buff.CheckAndAlloc();
+        }
         pntr = &new_pool.insert({plan.size, buff})->second;
       }
+      buffers[i - entry_start] = pntr;
     } else {
       CHECK_GE(mem_plan[plan.root].storage_id, 0);
-      pntr = arrays[plan.root];
+      pntr = buffers[plan.root - entry_start];
       if (plan.inplace && array_reqs->at(i) == kWriteTo)
         array_reqs->at(i) = kWriteInplace;
     }
-    arrays[i]->InitAsArray(*pntr, shapes[i], dtypes[i]);
+    if (plan.slice_offset >= 0) {
+      arrays[i]->InitAsView(*pntr, shapes[i], dtypes[i], plan.slice_offset);
+    } else {
+      arrays[i]->InitAsArray(*pntr, shapes[i], dtypes[i]);
+    }
   }
 
   return new_pool;
@@ -1235,7 +1455,9 @@ inline Engine::OprHandle CreateEngineOp(
       use_vars.push_back(nd.var());
     }
     for (auto& r : exec->op_ctx.requested) {
-      mutate_vars.push_back(r.var);
+      // the temp space of the streams has no variable
+      if (r.var != nullptr)
+        mutate_vars.push_back(r.var);
     }
     for (auto& nd : exec->out_array) {
       mutate_vars.push_back(nd.var());
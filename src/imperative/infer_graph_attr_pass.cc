@@ -635,6 +635,15 @@ nnvm::Graph InferShapeAttr(nnvm::Graph&& ret,
     CHECK_LE(entry_end, idx.num_node_entries());
     ret.attrs.erase("entry_range");
   }
+  // limit inference to the nodes set in the mask, the others keep the provided shapes
+  if (ret.attrs.count("node_mask")) {
+    const auto& mask = ret.GetAttr<std::vector<bool>>("node_mask");
+    CHECK_EQ(mask.size(), idx.num_nodes());
+    for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+      inference_finished[nid] = !mask[nid];
+    }
+    ret.attrs.erase("node_mask");
+  }
   // populate the node attribute vector
   if (dispatch_mode_name != nullptr) {
     if (ret.attrs.count(dispatch_mode_name) != 0) {
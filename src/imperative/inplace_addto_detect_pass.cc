@@ -35,6 +35,10 @@ Graph DetectInplaceAddTo(Graph g) {
   nnvm::StorageVector storage_id = g.MoveCopyAttr<nnvm::StorageVector>("storage_id");
   std::vector<int> storage_inplace_index =
       g.MoveCopyAttr<std::vector<int> >("storage_inplace_index");
+  std::vector<int64_t> storage_slice_offset;
+  if (g.attrs.count("storage_slice_offset")) {
+    storage_slice_offset = g.MoveCopyAttr<std::vector<int64_t> >("storage_slice_offset");
+  }
   static const Op* ewise_plus_op = Op::Get("_grad_add");
   auto& idx                      = g.indexed_graph();
   // reference cont.
@@ -80,12 +84,19 @@ Graph DetectInplaceAddTo(Graph g) {
     addto_entry[eid_rhs]           = 1;
     storage_inplace_index[eid_rhs] = -1;
     skip_plus_node[nid]            = 1;
+    // the rhs is added to the lhs where it is, which may be a slice of its storage
+    if (!storage_slice_offset.empty()) {
+      storage_slice_offset[eid_rhs] = storage_slice_offset[idx.entry_id(inode.inputs[0])];
+    }
   }
 
   g.attrs["storage_id"]            = std::make_shared<nnvm::any>(std::move(storage_id));
   g.attrs["storage_inplace_index"] = std::make_shared<nnvm::any>(std::move(storage_inplace_index));
   g.attrs["addto_entry"]           = std::make_shared<nnvm::any>(std::move(addto_entry));
   g.attrs["skip_plus_node"]        = std::make_shared<nnvm::any>(std::move(skip_plus_node));
+  if (!storage_slice_offset.empty()) {
+    g.attrs["storage_slice_offset"] = std::make_shared<nnvm::any>(std::move(storage_slice_offset));
+  }
   return g;
 }
 
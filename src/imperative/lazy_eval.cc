@@ -0,0 +1,317 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file lazy_eval.cc
+ * \brief Lazy evaluation of the elementwise operators invoked imperatively. The operators are
+ *  recorded into the deferred compute graph of their outputs, and the pending operators an
+ *  array depends on run as a single cached op when it is read, the graph passes of the cached op
+ *  fusing the pointwise operators and planning the memory of the intermediate arrays.
+ */
+#include <mxnet/imperative.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "./cached_op.h"
+#include "./imperative_utils.h"
+#include "../operator/fusion/fused_op-inl.h"
+
+namespace nnvm {
+ObjectPtr CreateVariableNode(const std::string& name);
+}
+
+namespace mxnet {
+
+namespace {
+
+// numpy elementwise operators, in addition to the ones with a pointwise fusion description
+const std::unordered_set<std::string> lazy_eval_ops = {"_npi_add",
+                                                       "_npi_subtract",
+                                                       "_npi_multiply",
+                                                       "_npi_true_divide",
+                                                       "_npi_power",
+                                                       "_npi_add_scalar",
+                                                       "_npi_subtract_scalar",
+                                                       "_npi_rsubtract_scalar",
+                                                       "_npi_multiply_scalar",
+                                                       "_npi_true_divide_scalar",
+                                                       "_npi_rtrue_divide_scalar",
+                                                       "_npi_power_scalar",
+                                                       "_npi_rpower_scalar",
+                                                       "_npi_negative",
+                                                       "_npi_absolute",
+                                                       "_npi_exp",
+                                                       "_npi_log",
+                                                       "_npi_sqrt",
+                                                       "_npi_square",
+                                                       "_npi_sin",
+                                                       "_npi_cos",
+                                                       "_npi_tanh"};
+
+/*!
+ * \brief Per thread state of lazy evaluation: the operators pending evaluation, the variables
+ *  the arrays they read are associated with, and the cached ops of the pending graphs.
+ */
+class LazyEvalState {
+ public:
+  LazyEvalState() : capacity_(dmlc::GetEnv("MXNET_LAZY_EVAL_CACHE_SIZE", size_t{64})) {}
+
+  static LazyEvalState* Get() {
+    return dmlc::ThreadLocalStore<LazyEvalState>::Get();
+  }
+
+  CachedOpPtr GetCachedOp(const std::string& key, const nnvm::Symbol& sym) {
+    auto it = ops_.find(key);
+    if (it != ops_.end())
+      return it->second;
+    if (ops_.size() >= capacity_)
+      ops_.clear();
+    CachedOpPtr op =
+        std::make_shared<CachedOp>(sym, std::vector<std::pair<std::string, std::string>>());
+    ops_.emplace(key, op);
+    return op;
+  }
+
+  std::vector<nnvm::ObjectPtr> nodes;
+  std::vector<nnvm::ObjectPtr> variables;
+
+ private:
+  const size_t capacity_;
+  std::unordered_map<std::string, CachedOpPtr> ops_;
+};
+
+bool IsLazyEvalCompatible(const nnvm::NodeAttrs& attrs, const Context& ctx) {
+  static auto& fcompute_cpu = Op::GetAttr<FCompute>("FCompute<cpu>");
+  static auto& fcompute_gpu = Op::GetAttr<FCompute>("FCompute<gpu>");
+  static auto& createop     = Op::GetAttr<FCreateOpState>("FCreateOpState");
+  const nnvm::Op* op        = attrs.op;
+  if (op == nullptr || createop.count(op))
+    return false;
+  if (!(ctx.dev_mask() == gpu::kDevMask ? fcompute_gpu : fcompute_cpu).count(op))
+    return false;
+  return fusion::ops_desc.count(op->name) || lazy_eval_ops.count(op->name);
+}
+
+template <typename T>
+void Append(std::string* key, const T& value) {
+  key->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendString(std::string* key, const std::string& str) {
+  Append(key, str.size());
+  key->append(str);
+}
+
+}  // namespace
+
+bool Imperative::RecordLazyEval(const nnvm::NodeAttrs& attrs,
+                                const std::vector<NDArray*>& inputs,
+                                const std::vector<NDArray*>& outputs) {
+  bool writes_existing = false;
+  for (const NDArray* output : outputs)
+    writes_existing = writes_existing || !output->is_none();
+  bool lazy = !writes_existing && !is_recording() && !is_deferred_compute();
+  for (const NDArray* input : inputs) {
+    lazy = lazy && shape_is_known(input->shape()) && input->storage_type() == kDefaultStorage &&
+           (DCInfo::IsNone(*input) || DCInfo::Get(input->deferredcompute_entry_.node).is_lazy_ ||
+            input->deferredcompute_entry_.node->is_variable());
+  }
+  Context ctx = imperative::GetContext(attrs, inputs, outputs, Context::CPU());
+  if (!lazy || !IsLazyEvalCompatible(attrs, ctx)) {
+    // the pending operators may read the arrays written now
+    if (writes_existing)
+      FlushLazyEval();
+    return false;
+  }
+  LazyEvalState* state = LazyEvalState::Get();
+
+  DispatchMode dispatch_mode = DispatchMode::kUndefined;
+  imperative::SetShapeType(ctx, attrs, inputs, outputs, &dispatch_mode);
+
+  nnvm::ObjectPtr node = nnvm::Node::Create();
+  node->attrs          = attrs;
+  node->attrs.name     = "lazy_" + std::to_string(node_count_++);
+  node->inputs.reserve(inputs.size());
+  for (NDArray* input : inputs) {
+    // the arrays computed already enter the graph as variables
+    if (DCInfo::IsNone(*input)) {
+      nnvm::ObjectPtr variable      = nnvm::CreateVariableNode("lazy_input");
+      input->deferredcompute_entry_ = nnvm::NodeEntry{variable, 0, 0};
+      DCInfo::Create(variable, {}, {}).is_computed_ = true;
+      state->variables.push_back(variable);
+    }
+    node->inputs.emplace_back(input->deferredcompute_entry_);
+  }
+  for (uint32_t i = 0; i < outputs.size(); ++i) {
+    outputs[i]->deferredcompute_entry_ = nnvm::NodeEntry{node, i, 0};
+  }
+  DCInfo::Create(node, inputs, outputs).is_lazy_ = true;
+  state->nodes.push_back(node);
+  return true;
+}
+
+void Imperative::FlushLazyEval() {
+  LazyEvalState* state = LazyEvalState::Get();
+  if (!state->nodes.empty())
+    ComputeLazyEval({});
+  for (const nnvm::ObjectPtr& variable : state->variables)
+    DCInfo::Clear(variable);
+  state->variables.clear();
+}
+
+void Imperative::ComputeLazyEval(const std::vector<NDArray>& arrays) {
+  LazyEvalState* state = LazyEvalState::Get();
+  // the pending operators the arrays depend on, in topological order
+  std::vector<nnvm::ObjectPtr> nodes;
+  std::unordered_map<const nnvm::Node*, uint32_t> node_ids;
+  std::vector<std::pair<nnvm::ObjectPtr, uint32_t>> stack;
+  auto is_pending = [](const nnvm::ObjectPtr& node) {
+    if (node == nullptr || node->info.empty())
+      return false;
+    const DCInfo& info = DCInfo::Get(node);
+    return !info.is_computed_ && info.is_lazy_;
+  };
+  auto visit = [&](const nnvm::ObjectPtr& node) {
+    if (is_pending(node) && !node_ids.count(node.get())) {
+      node_ids[node.get()] = static_cast<uint32_t>(-1);
+      stack.emplace_back(node, 0);
+    }
+  };
+  std::vector<nnvm::ObjectPtr> roots;
+  if (arrays.empty()) {
+    roots = state->nodes;
+  } else {
+    for (const NDArray& arr : arrays)
+      roots.push_back(arr.deferredcompute_entry_.node);
+  }
+  for (const nnvm::ObjectPtr& root : roots) {
+    visit(root);
+    while (!stack.empty()) {
+      auto& top = stack.back();
+      if (top.second < top.first->inputs.size()) {
+        visit(top.first->inputs[top.second++].node);
+      } else {
+        node_ids[top.first.get()] = nodes.size();
+        nodes.push_back(top.first);
+        stack.pop_back();
+      }
+    }
+  }
+  if (nodes.empty())
+    return;
+
+  // the entries read by other nodes of the graph
+  std::map<std::pair<const nnvm::Node*, uint32_t>, size_t> graph_reads;
+  for (const nnvm::ObjectPtr& node : nodes) {
+    for (const nnvm::NodeEntry& e : node->inputs) {
+      if (node_ids.count(e.node.get()))
+        ++graph_reads[{e.node.get(), e.index}];
+    }
+  }
+  std::unordered_set<const NDArray::Chunk*> requested;
+  for (const NDArray& arr : arrays)
+    requested.insert(arr.ptr_.get());
+
+  // copy the graph: the inputs from outside become variables, and the outputs are the requested
+  // arrays and the ones referenced by anything but the copies kept to compute the graph
+  nnvm::Symbol sym;
+  std::vector<nnvm::ObjectPtr> copies;
+  std::map<std::pair<const nnvm::Node*, uint32_t>, nnvm::ObjectPtr> input_variables;
+  std::unordered_map<const nnvm::Node*, NDArray> input_arrays;
+  std::vector<NDArray> output_arrays;
+  std::string key;
+  Append(&key, is_np_shape());
+  for (const nnvm::ObjectPtr& node : nodes) {
+    DCInfo& info         = DCInfo::Get(node);
+    nnvm::ObjectPtr copy = nnvm::Node::Create();
+    copy->attrs          = node->attrs;
+    copy->attrs.name     = "node_" + std::to_string(copies.size());
+    AppendString(&key, copy->attrs.op->name);
+    std::map<std::string, std::string> dict(copy->attrs.dict.begin(), copy->attrs.dict.end());
+    for (const auto& kv : dict) {
+      AppendString(&key, kv.first);
+      AppendString(&key, kv.second);
+    }
+    for (size_t j = 0; j < node->inputs.size(); ++j) {
+      const nnvm::NodeEntry& e = node->inputs[j];
+      auto it                  = node_ids.find(e.node.get());
+      if (it != node_ids.end()) {
+        copy->inputs.emplace_back(copies[it->second], e.index, 0);
+        Append(&key, it->second);
+      } else {
+        nnvm::ObjectPtr& variable = input_variables[{e.node.get(), e.index}];
+        if (variable == nullptr) {
+          variable = nnvm::CreateVariableNode("data" + std::to_string(input_variables.size() - 1));
+          input_arrays.emplace(variable.get(), info.inputs_[j]);
+        }
+        copy->inputs.emplace_back(variable, 0, 0);
+        Append(&key, static_cast<uint32_t>(-1));
+        AppendString(&key, variable->attrs.name);
+      }
+      Append(&key, e.index);
+    }
+    for (uint32_t i = 0; i < info.outputs_.size(); ++i) {
+      const NDArray& out = info.outputs_[i];
+      const size_t refs  = 1 + graph_reads[{node.get(), i}];
+      if (requested.count(out.ptr_.get()) || static_cast<size_t>(out.ptr_.use_count()) > refs) {
+        sym.outputs.emplace_back(copy, i, 0);
+        output_arrays.push_back(out);
+        Append(&key, copies.size());
+        Append(&key, i);
+      }
+    }
+    copies.push_back(copy);
+  }
+
+  if (!output_arrays.empty()) {
+    std::vector<NDArray> inputs;
+    std::vector<NDArray*> input_ptrs, output_ptrs;
+    for (const nnvm::ObjectPtr& variable : sym.ListInputs(nnvm::Symbol::kAll)) {
+      inputs.push_back(input_arrays.at(variable.get()));
+      DCInfo::Compute(inputs.back());
+    }
+    for (NDArray& input : inputs)
+      input_ptrs.push_back(&input);
+    for (NDArray& output : output_arrays)
+      output_ptrs.push_back(&output);
+    const Context ctx = inputs.empty() ? output_arrays[0].ctx() : inputs[0].ctx();
+    CachedOpPtr op    = state->GetCachedOp(key, sym);
+    op->Forward(op, input_ptrs, output_ptrs, ctx);
+  }
+
+  // the arrays which are not outputs are no longer referenced, and are never allocated
+  std::unordered_set<const nnvm::Node*> computed;
+  for (const nnvm::ObjectPtr& node : nodes) {
+    computed.insert(node.get());
+    DCInfo::Clear(node);
+    node->inputs.clear();
+  }
+  auto& pending_nodes = state->nodes;
+  pending_nodes.erase(
+      std::remove_if(pending_nodes.begin(),
+                     pending_nodes.end(),
+                     [&](const nnvm::ObjectPtr& n) { return computed.count(n.get()) > 0; }),
+      pending_nodes.end());
+}
+
+}  // namespace mxnet
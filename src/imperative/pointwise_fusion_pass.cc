@@ -30,6 +30,7 @@
 #include <nnvm/pass_functions.h>
 #include <algorithm>
 #include <queue>
+#include <tuple>
 #include <chrono>
 #include "./simple_partition_pass.h"
 #include "../operator/fusion/fused_op-inl.h"
@@ -54,8 +55,6 @@ void WarnFusionNotSupported() {
   }
 }
 
-#if MXNET_USE_CUDA
-
 namespace {
 
 bool IsFusionCompatible(const nnvm::Node* n) {
@@ -133,6 +132,27 @@ inline int SetInsert(const EntryInfo& new_elem, std::vector<EntryInfo>* elements
   return elements->size() - 1;
 }
 
+/*!
+ * \brief Whether the fused op can run the node on CPU, with its FCompute<cpu> kernel and
+ *  without any resources.
+ */
+bool IsCPUFusionCompatible(const nnvm::Node* n) {
+  static const auto& fcompute    = Op::GetAttr<FCompute>("FCompute<cpu>");
+  static const auto& fstateful   = Op::GetAttr<FCreateOpState>("FCreateOpState");
+  static const auto& fresource   = Op::GetAttr<FResourceRequest>("FResourceRequest");
+  static const auto& fresourceex = Op::GetAttr<FResourceRequestEx>("FResourceRequestEx");
+  if (!IsFusionCompatible(n))
+    return false;
+  const Op* op = n->op();
+  if (!fcompute.count(op) || fstateful.count(op))
+    return false;
+  if (fresourceex.count(op))
+    return fresourceex[op](n->attrs, Context::kCPU, DispatchMode::kFCompute).empty();
+  if (fresource.count(op))
+    return fresource[op](n->attrs).empty();
+  return true;
+}
+
 }  // namespace
 
 /* \brief Create (if necessary) copy of the graph, replacing subgraphs with
@@ -331,12 +351,19 @@ Graph CopyAndReplaceSubgraphs(const Graph& g,
   return ret;
 }
 
-Graph FusePointwise(const Graph& g, const size_t num_forward_outputs) {
-  auto start                            = std::chrono::steady_clock::now();
-  auto [subset_assignment, num_subsets] = GetCompatibleSubsets(g,                    // NOLINT(*)
-                                                               num_forward_outputs,  // NOLINT(*)
-                                                               IsFusionCompatible,
-                                                               IsInputsOnlyCompatible);
+Graph FusePointwise(const Graph& g, const size_t num_forward_outputs, const int dev_mask) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<int> subset_assignment;
+  int num_subsets;
+  if (dev_mask == Context::kCPU) {
+    // the CPU fused op runs the original kernels, which gain nothing from reading
+    // slices of the inputs, so only elementwise nodes are fused
+    std::tie(subset_assignment, num_subsets) = GetCompatibleSubsets(
+        g, num_forward_outputs, IsCPUFusionCompatible, [](const nnvm::Node*) { return false; });
+  } else {
+    std::tie(subset_assignment, num_subsets) = GetCompatibleSubsets(
+        g, num_forward_outputs, IsFusionCompatible, IsInputsOnlyCompatible);
+  }
   Graph ret = CopyAndReplaceSubgraphs(g, subset_assignment, num_subsets, CreateSubgraphNode);
   auto end  = std::chrono::steady_clock::now();
   if (dmlc::GetEnv("MXNET_RTC_VERBOSE", false)) {
@@ -346,7 +373,6 @@ Graph FusePointwise(const Graph& g, const size_t num_forward_outputs) {
   }
   return ret;
 }
-#endif  // MXNET_USE_CUDA
 
 }  // namespace exec
 }  // namespace mxnet
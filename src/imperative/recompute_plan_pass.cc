@@ -0,0 +1,187 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file recompute_plan_pass.cc
+ * \brief Select the forward activations to recompute in backward under a memory budget
+ */
+
+#include <mxnet/base.h>
+#include <mxnet/op_attr_types.h>
+#include <mxnet/resource.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "./exec_pass.h"
+
+namespace mxnet {
+namespace exec {
+
+namespace {
+
+using nnvm::Graph;
+using nnvm::IndexedGraph;
+using nnvm::Node;
+
+/*! \brief forward node that may be dropped and recomputed */
+struct RecomputeCandidate {
+  const Node* node;
+  /*! \brief bytes of the outputs that would otherwise stay alive until backward */
+  size_t bytes;
+  /*! \brief estimated floating point operations of recomputing the node */
+  double flops;
+};
+
+/*!
+ * \brief Whether the node is dominated by a contraction over a shared dimension,
+ *  e.g. matrix products and convolutions.
+ */
+bool IsContraction(const Node& node) {
+  static const std::unordered_set<std::string> contraction_ops = {
+      "FullyConnected",
+      "Convolution",
+      "Deconvolution",
+      "dot",
+      "batch_dot",
+      "_npi_matmul",
+      "_npi_dot",
+      "_npi_tensordot",
+      "_npi_einsum",
+      "RNN",
+      "_contrib_interleaved_matmul_selfatt_qk",
+      "_contrib_interleaved_matmul_selfatt_valatt",
+      "_contrib_interleaved_matmul_encdec_qk",
+      "_contrib_interleaved_matmul_encdec_valatt"};
+  return contraction_ops.count(node.op()->name) != 0;
+}
+
+/*!
+ * \brief Whether running the node a second time gives the same outputs without side effects.
+ *  Random operators, operators updating their inputs (e.g. the moving statistics of
+ *  BatchNorm) and stateful operators are never recomputed.
+ */
+bool CanRecompute(const Node& node) {
+  static const auto& fmutate     = nnvm::Op::GetAttr<nnvm::FMutateInputs>("FMutateInputs");
+  static const auto& fstateful   = nnvm::Op::GetAttr<FCreateOpState>("FCreateOpState");
+  static const auto& fresource   = nnvm::Op::GetAttr<FResourceRequest>("FResourceRequest");
+  static const auto& fresourceex = nnvm::Op::GetAttr<FResourceRequestEx>("FResourceRequestEx");
+  const nnvm::Op* op             = node.op();
+  if (fmutate.count(op) || fstateful.count(op) || !node.attrs.subgraphs.empty())
+    return false;
+  std::vector<ResourceRequest> reqs;
+  if (fresourceex.count(op)) {
+    reqs = fresourceex[op](node.attrs, Context::kCPU, DispatchMode::kFCompute);
+  } else if (fresource.count(op)) {
+    reqs = fresource[op](node.attrs);
+  }
+  for (const auto& req : reqs) {
+    if (req.type == ResourceRequest::kRandom || req.type == ResourceRequest::kParallelRandom)
+      return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+std::function<int(const Node&)> PlanRecompute(const Graph& fwd_graph,
+                                              mxnet::ShapeVector&& arg_shapes,
+                                              nnvm::DTypeVector&& arg_dtypes,
+                                              size_t budget) {
+  Graph g;
+  g.outputs = fwd_graph.outputs;
+  g         = InferShape(std::move(g), std::move(arg_shapes));
+  g         = InferType(std::move(g), std::move(arg_dtypes));
+  if (g.GetAttr<size_t>("shape_num_unknown_nodes") != 0U ||
+      g.GetAttr<size_t>("dtype_num_unknown_nodes") != 0U) {
+    LOG(WARNING) << "Activation recomputation is disabled because not all shapes and "
+                 << "data types of the graph can be inferred.";
+    return nullptr;
+  }
+  const IndexedGraph& idx         = g.indexed_graph();
+  const mxnet::ShapeVector& shape = g.GetAttr<mxnet::ShapeVector>("shape");
+  const nnvm::DTypeVector& dtype  = g.GetAttr<nnvm::DTypeVector>("dtype");
+
+  // graph outputs are kept alive anyway, so dropping them saves nothing
+  std::unordered_set<uint32_t> output_eids;
+  for (const auto& e : idx.outputs())
+    output_eids.insert(idx.entry_id(e));
+
+  size_t kept = 0;
+  std::vector<RecomputeCandidate> candidates;
+  for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+    const auto& inode = idx[nid];
+    if (inode.source->is_variable())
+      continue;
+    size_t bytes        = 0;
+    double out_elems    = 0;
+    const uint32_t nout = inode.source->num_outputs();
+    for (uint32_t i = 0; i < nout; ++i) {
+      const uint32_t eid = idx.entry_id(nid, i);
+      out_elems += shape[eid].Size();
+      if (output_eids.count(eid) == 0)
+        bytes += shape[eid].Size() * mshadow::mshadow_sizeof(dtype[eid]);
+    }
+    kept += bytes;
+    if (bytes == 0 || !CanRecompute(*inode.source))
+      continue;
+    std::vector<double> in_elems;
+    for (const auto& e : inode.inputs)
+      in_elems.push_back(shape[idx.entry_id(e)].Size());
+    double flops = out_elems;
+    if (IsContraction(*inode.source) && in_elems.size() >= 2) {
+      // for A(m, k) x B(k, n) = C(m, n), sqrt(|A||B||C|) = mkn; this also gives the
+      // order of the cost of convolutions without knowing their layout
+      flops = 2 * std::sqrt(in_elems[0] * in_elems[1] * out_elems);
+    } else {
+      for (double n : in_elems)
+        flops += n;
+    }
+    candidates.push_back(RecomputeCandidate{inode.source, bytes, flops});
+  }
+  if (kept <= budget)
+    return nullptr;
+
+  // greedily drop the activations that are cheapest to recompute per byte
+  std::sort(candidates.begin(),
+            candidates.end(),
+            [](const RecomputeCandidate& a, const RecomputeCandidate& b) {
+              return a.flops * b.bytes < b.flops * a.bytes;
+            });
+  auto selected = std::make_shared<std::unordered_set<const Node*>>();
+  for (const auto& c : candidates) {
+    if (kept <= budget)
+      break;
+    selected->insert(c.node);
+    kept -= c.bytes;
+  }
+  if (kept > budget) {
+    LOG(WARNING) << "Activation recomputation cannot meet the memory budget of " << (budget >> 20)
+                 << " MB, at least " << (kept >> 20) << " MB of activations are kept.";
+  }
+  return [selected](const Node& node) { return static_cast<int>(selected->count(&node)); };
+}
+
+}  // namespace exec
+}  // namespace mxnet
@@ -93,15 +93,41 @@ LibraryInitializer::LibraryInitializer()
     : original_pid_(common::current_process_id()),
       mp_worker_nthreads_(dmlc::GetEnv("MXNET_MP_WORKER_NTHREADS", 1)),
       cpu_worker_nthreads_(dmlc::GetEnv("MXNET_CPU_WORKER_NTHREADS", 1)),
-      mp_cv_num_threads_(dmlc::GetEnv("MXNET_MP_OPENCV_NUM_THREADS", 0)) {
+      mp_cv_num_threads_(dmlc::GetEnv("MXNET_MP_OPENCV_NUM_THREADS", 0)),
+      load_start_(std::chrono::steady_clock::now()),
+      log_startup_phases_(dmlc::GetEnv("MXNET_STARTUP_PROFILE", false)) {
   dmlc::InitLogging("mxnet");
+  startup_tick_t start = std::chrono::steady_clock::now();
   init_mkl_dynamic_library();
+  record_startup_phase("MKL initialization", start);
+  start = std::chrono::steady_clock::now();
   engine::OpenMP::Get();  // force OpenMP initialization
+  record_startup_phase("OpenMP initialization", start);
   install_pthread_atfork_handlers();
 }
 
 LibraryInitializer::~LibraryInitializer() = default;
 
+void LibraryInitializer::record_startup_phase(const std::string& name,
+                                              const startup_tick_t& start) {
+  const double ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  if (log_startup_phases_) {
+    LOG(INFO) << "Startup: " << name << " took " << ms << " ms";
+  }
+  std::lock_guard<std::mutex> lock(startup_mutex_);
+  startup_phases_.emplace_back(name, ms);
+}
+
+void LibraryInitializer::record_library_loaded() {
+  std::call_once(library_loaded_, [this]() { record_startup_phase("library load", load_start_); });
+}
+
+std::vector<std::pair<std::string, double>> LibraryInitializer::startup_phases() const {
+  std::lock_guard<std::mutex> lock(startup_mutex_);
+  return startup_phases_;
+}
+
 bool LibraryInitializer::lib_is_loaded(const std::string& path) const {
   return loaded_libs_.count(path) > 0;
 }
@@ -22,9 +22,13 @@
  * \brief Library initialization
  */
 
+#include <chrono>
 #include <cstdlib>
 #include <map>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "dmlc/io.h"
 
@@ -61,6 +65,26 @@ class LibraryInitializer {
    */
   bool was_forked() const;
 
+  typedef std::chrono::steady_clock::time_point startup_tick_t;
+
+  /**
+   * Record how long a phase of the library startup took, logged if MXNET_STARTUP_PROFILE is set.
+   * @param name name of the phase
+   * @param start when the phase started
+   */
+  void record_startup_phase(const std::string& name, const startup_tick_t& start);
+
+  /**
+   * Record the library load, from this constructor to the end of the static initializers, the
+   * first time it is called.
+   */
+  void record_library_loaded();
+
+  /**
+   * @return the startup phases recorded so far with their durations in milliseconds
+   */
+  std::vector<std::pair<std::string, double>> startup_phases() const;
+
   // Library loading
   bool lib_is_loaded(const std::string& path) const;
   void* lib_load(const char* path);
@@ -105,6 +129,13 @@ class LibraryInitializer {
   void close_open_libs();
 
   loaded_libs_t loaded_libs_;
+
+  /** When the library started loading */
+  startup_tick_t load_start_;
+  bool log_startup_phases_;
+  std::once_flag library_loaded_;
+  mutable std::mutex startup_mutex_;
+  std::vector<std::pair<std::string, double>> startup_phases_;
 };
 
 /*!
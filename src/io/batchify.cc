@@ -28,10 +28,12 @@
 #include <mshadow/extension.h>
 #include <mshadow/extension/slice.h>
 
+#include <algorithm>
 #include <stack>
 #include <cmath>
 
 #include "./inst_vector.h"
+#include "../engine/openmp.h"
 #include "../ndarray/ndarray_function.h"
 
 namespace mxnet {
@@ -49,6 +51,11 @@ namespace io {
 #define omp_parallel(t) _Pragma(tostr(omp parallel for num_threads(t)))
 #endif
 
+/*! \brief threads batchifying the samples of a batch, the OpenMP threads of the engine */
+inline int NumThreads(int batch_size) {
+  return std::max(1, std::min(batch_size, engine::OpenMP::Get()->GetRecommendedOMPThreadCount()));
+}
+
 struct GroupBatchifyParam : public dmlc::Parameter<GroupBatchifyParam> {
   mxnet::Tuple<std::intptr_t> functions;
   // declare parameters
@@ -86,7 +93,11 @@ class GroupBatchify : public BatchifyFunction {
         std::vector<NDArray> curr({input[i]});
         inp.emplace_back(curr);
       }
+      // hand the output down, so that the function can batchify into it
       std::vector<NDArray> tmp;
+      if (!(*outputs)[i].is_none()) {
+        tmp.push_back((*outputs)[i]);
+      }
       if (!fs_[i]->Batchify(inp, &tmp))
         return false;
       (*outputs)[i] = tmp[0];
@@ -94,6 +105,12 @@ class GroupBatchify : public BatchifyFunction {
     return true;
   }
 
+  void SetOutputContext(const Context& ctx) override {
+    for (auto& f : fs_) {
+      f->SetOutputContext(ctx);
+    }
+  }
+
  private:
   /*! \brief params */
   GroupBatchifyParam param_;
@@ -150,23 +167,24 @@ class StackBatchify : public BatchifyFunction {
       }
 
       int dtype = inputs[0][i].dtype();
-      if (!(*outputs)[i].is_none() && (*outputs)[i].ctx() == mxnet::Context::CPU(0) &&
+      if (!(*outputs)[i].is_none() && (*outputs)[i].ctx() == ctx_ &&
           (*outputs)[i].dtype() == dtype && (*outputs)[i].storage_type() == kDefaultStorage) {
         if ((*outputs)[i].shape() != sshape) {
           // realloc
           (*outputs)[i].ReshapeAndAlloc(sshape);
         }
       } else {
-        (*outputs)[i] = NDArray(sshape, mxnet::Context::CPU(0), false, inputs[0][i].dtype());
+        (*outputs)[i] = NDArray(sshape, ctx_, false, inputs[0][i].dtype());
       }
-      int sbs = static_cast<int>(bs);
+      int sbs     = static_cast<int>(bs);
+      int nthread = NumThreads(sbs);
       MSHADOW_TYPE_SWITCH_WITH_BOOL(dtype, DType, {
-        omp_parallel(bs) for (int j = 0; j < sbs; ++j) {
+        omp_parallel(nthread) for (int j = 0; j < sbs; ++j) {
           omp_exc_.Run([&] {
             // inputs[j][i].WaitToRead();
             DType* ptr = (*outputs)[i].data().dptr<DType>();
             auto asize = ashape.Size();
-            RunContext rctx{(*outputs)[i].ctx(), nullptr, nullptr};
+            RunContext rctx{Context::CPU(), nullptr, nullptr};
             auto dst = TBlob(ptr + asize * j, inputs[j][i].data().shape_, cpu::kDevMask, dtype, 0);
             mxnet::ndarray::Copy<cpu, cpu>(
                 inputs[j][i].data(), &dst, Context::CPU(), Context::CPU(), rctx);
@@ -178,9 +196,15 @@ class StackBatchify : public BatchifyFunction {
     return true;
   }
 
+  void SetOutputContext(const Context& ctx) override {
+    ctx_ = ctx;
+  }
+
  private:
   /*! \brief parameters */
   StackBatchifyParam param_;
+  /*! \brief context of the outputs */
+  Context ctx_ = Context::CPU();
   /*! \brief OMPException obj to store and rethrow exceptions from omp blocks*/
   dmlc::OMPException omp_exc_;
 
@@ -264,103 +288,112 @@ class PadBatchify : public BatchifyFunction {
       }
 
       int dtype = param_.dtype > -1 ? param_.dtype : inputs[0][i].dtype();
-      if (!(*outputs)[i].is_none() && (*outputs)[i].ctx() == mxnet::Context::CPU(0) &&
+      if (!(*outputs)[i].is_none() && (*outputs)[i].ctx() == ctx_ &&
           (*outputs)[i].dtype() == dtype && (*outputs)[i].storage_type() == kDefaultStorage) {
         if ((*outputs)[i].shape() != sshape) {
           // realloc
           (*outputs)[i].ReshapeAndAlloc(sshape);
         }
       } else {
-        (*outputs)[i] = NDArray(sshape, mxnet::Context::CPU(0), false, inputs[0][i].dtype());
+        (*outputs)[i] = NDArray(sshape, ctx_, false, inputs[0][i].dtype());
       }
       MSHADOW_TYPE_SWITCH_WITH_BOOL(dtype, DType, {
-        // fill pad value first
-        std::fill((*outputs)[i].data().dptr<DType>(),
-                  (*outputs)[i].data().dptr<DType>() + sshape.Size(),
-                  static_cast<DType>(param_.pad_val));
-        DType* ptr = (*outputs)[i].data().dptr<DType>();
-        auto asize = ashape.Size();
-        int sbs    = static_cast<int>(bs);
-        omp_parallel(bs) for (int j = 0; j < sbs; ++j) {
-          using namespace mshadow::expr;
-          auto compact_shapes = CompactShapes(ashape, inputs[j][i].shape());
-          // inputs[j][i].WaitToRead();
-          auto& fshape = compact_shapes.first;
-          auto& cshape = compact_shapes.second;
-          switch (fshape.size()) {
-            case 1U: {
-              mshadow::Tensor<cpu, 1, DType> dst =
-                  TBlob(ptr + asize * j, ashape, cpu::kDevMask, dtype, 0)
-                      .get_with_shape<cpu, 1, DType>(mshadow::Shape1(fshape[0]));
-              mshadow::Tensor<cpu, 1, DType> src =
-                  inputs[j][i].data().get_with_shape<cpu, 1, DType>(mshadow::Shape1(cshape[0]));
-              slice<0>(dst, 0, cshape[0]) = src;
-              break;
-            }
-            case 2U: {
-              mshadow::Tensor<cpu, 2, DType> dst =
-                  TBlob(ptr + asize * j, ashape, cpu::kDevMask, dtype, 0)
-                      .get_with_shape<cpu, 2, DType>(mshadow::Shape2(fshape[0], fshape[1]));
-              mshadow::Tensor<cpu, 2, DType> src =
-                  inputs[j][i].data().get_with_shape<cpu, 2, DType>(
-                      mshadow::Shape2(cshape[0], cshape[1]));
-              slice<1>(slice<0>(dst, 0, cshape[0]), 0, cshape[1]) = src;
-              break;
-            }
-            case 3U: {
-              mshadow::Tensor<cpu, 3, DType> dst =
-                  TBlob(ptr + asize * j, ashape, cpu::kDevMask, dtype, 0)
-                      .get_with_shape<cpu, 3, DType>(
-                          mshadow::Shape3(fshape[0], fshape[1], fshape[2]));
-              mshadow::Tensor<cpu, 3, DType> src =
-                  inputs[j][i].data().get_with_shape<cpu, 3, DType>(
-                      mshadow::Shape3(cshape[0], cshape[1], cshape[2]));
-              slice<2>(slice<1>(slice<0>(dst, 0, cshape[0]), 0, cshape[1]), 0, cshape[2]) = src;
-              break;
-            }
-            case 4U: {
-              mshadow::Tensor<cpu, 4, DType> dst =
-                  TBlob(ptr + asize * j, ashape, cpu::kDevMask, dtype, 0)
-                      .get_with_shape<cpu, 4, DType>(
-                          mshadow::Shape4(fshape[0], fshape[1], fshape[2], fshape[3]));
-              mshadow::Tensor<cpu, 4, DType> src =
-                  inputs[j][i].data().get_with_shape<cpu, 4, DType>(
-                      mshadow::Shape4(cshape[0], cshape[1], cshape[2], cshape[3]));
-              slice<3>(slice<2>(slice<1>(slice<0>(dst, 0, cshape[0]), 0, cshape[1]), 0, cshape[2]),
-                       0,
-                       cshape[3]) = src;
-              break;
-            }
-            case 5U: {
-              mshadow::Tensor<cpu, 5, DType> dst =
-                  TBlob(ptr + asize * j, ashape, cpu::kDevMask, dtype, 0)
-                      .get_with_shape<cpu, 5, DType>(
-                          mshadow::Shape5(fshape[0], fshape[1], fshape[2], fshape[3], fshape[4]));
-              mshadow::Tensor<cpu, 5, DType> src =
-                  inputs[j][i].data().get_with_shape<cpu, 5, DType>(
-                      mshadow::Shape5(cshape[0], cshape[1], cshape[2], cshape[3], cshape[4]));
-              slice<4>(
-                  slice<3>(
-                      slice<2>(slice<1>(slice<0>(dst, 0, cshape[0]), 0, cshape[1]), 0, cshape[2]),
-                      0,
-                      cshape[3]),
-                  0,
-                  cshape[4]) = src;
-              break;
-            }
-            default: {
-              LOG(FATAL) << "# dim to pad: " << cshape.size() << " exceeds limit of 5.";
+        DType* ptr  = (*outputs)[i].data().dptr<DType>();
+        auto asize  = ashape.Size();
+        int sbs     = static_cast<int>(bs);
+        int nthread = NumThreads(sbs);
+        omp_parallel(nthread) for (int j = 0; j < sbs; ++j) {
+          omp_exc_.Run([&] {
+            using namespace mshadow::expr;
+            // fill the pad value of each sample on its thread, then copy the sample over it
+            std::fill(ptr + asize * j, ptr + asize * (j + 1), static_cast<DType>(param_.pad_val));
+            auto compact_shapes = CompactShapes(ashape, inputs[j][i].shape());
+            // inputs[j][i].WaitToRead();
+            auto& fshape = compact_shapes.first;
+            auto& cshape = compact_shapes.second;
+            switch (fshape.size()) {
+              case 1U: {
+                mshadow::Tensor<cpu, 1, DType> dst =
+                    TBlob(ptr + asize * j, ashape, cpu::kDevMask, dtype, 0)
+                        .get_with_shape<cpu, 1, DType>(mshadow::Shape1(fshape[0]));
+                mshadow::Tensor<cpu, 1, DType> src =
+                    inputs[j][i].data().get_with_shape<cpu, 1, DType>(mshadow::Shape1(cshape[0]));
+                slice<0>(dst, 0, cshape[0]) = src;
+                break;
+              }
+              case 2U: {
+                mshadow::Tensor<cpu, 2, DType> dst =
+                    TBlob(ptr + asize * j, ashape, cpu::kDevMask, dtype, 0)
+                        .get_with_shape<cpu, 2, DType>(mshadow::Shape2(fshape[0], fshape[1]));
+                mshadow::Tensor<cpu, 2, DType> src =
+                    inputs[j][i].data().get_with_shape<cpu, 2, DType>(
+                        mshadow::Shape2(cshape[0], cshape[1]));
+                slice<1>(slice<0>(dst, 0, cshape[0]), 0, cshape[1]) = src;
+                break;
+              }
+              case 3U: {
+                mshadow::Tensor<cpu, 3, DType> dst =
+                    TBlob(ptr + asize * j, ashape, cpu::kDevMask, dtype, 0)
+                        .get_with_shape<cpu, 3, DType>(
+                            mshadow::Shape3(fshape[0], fshape[1], fshape[2]));
+                mshadow::Tensor<cpu, 3, DType> src =
+                    inputs[j][i].data().get_with_shape<cpu, 3, DType>(
+                        mshadow::Shape3(cshape[0], cshape[1], cshape[2]));
+                slice<2>(slice<1>(slice<0>(dst, 0, cshape[0]), 0, cshape[1]), 0, cshape[2]) = src;
+                break;
+              }
+              case 4U: {
+                mshadow::Tensor<cpu, 4, DType> dst =
+                    TBlob(ptr + asize * j, ashape, cpu::kDevMask, dtype, 0)
+                        .get_with_shape<cpu, 4, DType>(
+                            mshadow::Shape4(fshape[0], fshape[1], fshape[2], fshape[3]));
+                mshadow::Tensor<cpu, 4, DType> src =
+                    inputs[j][i].data().get_with_shape<cpu, 4, DType>(
+                        mshadow::Shape4(cshape[0], cshape[1], cshape[2], cshape[3]));
+                slice<3>(
+                    slice<2>(slice<1>(slice<0>(dst, 0, cshape[0]), 0, cshape[1]), 0, cshape[2]),
+                    0,
+                    cshape[3]) = src;
+                break;
+              }
+              case 5U: {
+                mshadow::Tensor<cpu, 5, DType> dst =
+                    TBlob(ptr + asize * j, ashape, cpu::kDevMask, dtype, 0)
+                        .get_with_shape<cpu, 5, DType>(
+                            mshadow::Shape5(fshape[0], fshape[1], fshape[2], fshape[3], fshape[4]));
+                mshadow::Tensor<cpu, 5, DType> src =
+                    inputs[j][i].data().get_with_shape<cpu, 5, DType>(
+                        mshadow::Shape5(cshape[0], cshape[1], cshape[2], cshape[3], cshape[4]));
+                slice<4>(
+                    slice<3>(
+                        slice<2>(slice<1>(slice<0>(dst, 0, cshape[0]), 0, cshape[1]), 0, cshape[2]),
+                        0,
+                        cshape[3]),
+                    0,
+                    cshape[4]) = src;
+                break;
+              }
+              default: {
+                LOG(FATAL) << "# dim to pad: " << cshape.size() << " exceeds limit of 5.";
+              }
             }
-          }
+          });
         }
+        omp_exc_.Rethrow();
       })
     }
     return true;
   }
 
+  void SetOutputContext(const Context& ctx) override {
+    ctx_ = ctx;
+  }
+
  private:
   /*! \brief parameters */
   PadBatchifyParam param_;
+  /*! \brief context of the outputs */
+  Context ctx_ = Context::CPU();
   /*! \brief OMPException obj to store and rethrow exceptions from omp blocks*/
   dmlc::OMPException omp_exc_;
 
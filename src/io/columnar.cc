@@ -0,0 +1,232 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file columnar.cc
+ * \brief columns of a dataset stored as npy files, mapped into memory
+ */
+#include "./columnar.h"
+
+#include <dmlc/logging.h>
+#include <algorithm>
+#include <cstring>
+#include "../serialization/cnpy.h"
+
+namespace mxnet {
+namespace io {
+
+namespace {
+/*! \brief the i-th value of an int32 or int64 index array */
+inline int64_t IndexAt(const TBlob& blob, size_t i) {
+  return blob.type_flag_ == mshadow::kInt64 ? blob.dptr<int64_t>()[i] : blob.dptr<int32_t>()[i];
+}
+}  // namespace
+
+ColumnarTable::ColumnarTable(const std::string& path,
+                             const std::vector<std::string>& names,
+                             bool random_access) {
+#ifdef _WIN32
+  LOG(FATAL) << "Columnar datasets are not supported on Windows";
+#else
+  CHECK(!names.empty()) << "No columns to read from " << path;
+  for (const auto& name : names) {
+    const std::string prefix = path + "/" + name;
+    Column column;
+    if (access((prefix + ".npy").c_str(), F_OK) == 0) {
+      column.stype = kDefaultStorage;
+      column.arrays.push_back(Map(prefix + ".npy", random_access));
+      column.shape = column.arrays[0].blob.shape_;
+      CHECK_GE(column.shape.ndim(), 1) << prefix << ".npy has no rows";
+    } else {
+      CHECK_EQ(access((prefix + ".indptr.npy").c_str(), F_OK), 0)
+          << "Neither " << prefix << ".npy nor " << prefix << ".indptr.npy exists";
+      column.stype = kCSRStorage;
+      column.arrays.push_back(Map(prefix + ".data.npy", random_access));
+      column.arrays.push_back(Map(prefix + ".indices.npy", random_access));
+      column.arrays.push_back(Map(prefix + ".indptr.npy", random_access));
+      const MappedArray shape = Map(prefix + ".shape.npy", random_access);
+      CHECK(shape.blob.type_flag_ == mshadow::kInt64 && shape.blob.Size() == 2)
+          << prefix << ".shape.npy must hold the number of rows and columns as int64";
+      const int64_t* dims = shape.blob.dptr<int64_t>();
+      column.shape        = mxnet::TShape({dims[0], dims[1]});
+      for (size_t i = 1; i < 3; ++i) {
+        const int type_flag = column.arrays[i].blob.type_flag_;
+        CHECK(type_flag == mshadow::kInt32 || type_flag == mshadow::kInt64)
+            << "The indices and indptr of " << prefix << " must be int32 or int64";
+      }
+      CHECK_EQ(column.arrays[0].blob.Size(), column.arrays[1].blob.Size())
+          << "The data and indices of " << prefix << " differ in size";
+      CHECK_EQ(column.arrays[2].blob.Size(), static_cast<size_t>(dims[0] + 1))
+          << "The indptr of " << prefix << " does not match its number of rows";
+    }
+    if (columns_.empty()) {
+      num_rows_ = column.shape[0];
+    }
+    CHECK_EQ(static_cast<size_t>(column.shape[0]), num_rows_)
+        << "Column " << name << " has " << column.shape[0] << " rows instead of " << num_rows_;
+    columns_.push_back(std::move(column));
+  }
+#endif  // _WIN32
+}
+
+ColumnarTable::MappedArray ColumnarTable::Map(const std::string& file, bool random_access) const {
+  MappedArray array;
+#ifndef _WIN32
+  array.file = std::make_shared<MappedFile>(file, random_access);
+  int type_flag;
+  std::vector<dim_t> dims;
+  const size_t offset =
+      npy::parse_npy_header(array.file->data(), array.file->size(), &type_flag, &dims);
+  const mxnet::TShape shape(dims.begin(), dims.end());
+  CHECK_LE(offset + shape.Size() * mshadow::mshadow_sizeof(type_flag), array.file->size())
+      << file << " is truncated";
+  array.blob = TBlob(array.file->data() + offset, shape, cpu::kDevMask, type_flag, 0);
+#endif  // _WIN32
+  return array;
+}
+
+size_t ColumnarTable::RowBytes(const Column& column) const {
+  const TBlob& values = column.arrays[0].blob;
+  return column.shape.ProdShape(1, column.shape.ndim()) *
+         mshadow::mshadow_sizeof(values.type_flag_);
+}
+
+NDArray ColumnarTable::Rows(size_t col,
+                            const std::vector<RowRange>& ranges,
+                            size_t num_rows) const {
+  const Column& column = columns_[col];
+  const TBlob& values  = column.arrays[0].blob;
+  const char* src      = static_cast<const char*>(values.dptr_);
+  if (column.stype == kDefaultStorage) {
+    mxnet::TShape shape    = column.shape;
+    shape[0]               = num_rows;
+    const size_t row_bytes = RowBytes(column);
+#ifndef _WIN32
+    if (ranges.size() == 1 && ranges[0].second - ranges[0].first == num_rows) {
+      // the NDArray keeps the mapping alive
+      auto file = column.arrays[0].file;
+      const TBlob data(const_cast<char*>(src) + ranges[0].first * row_bytes,
+                       shape,
+                       cpu::kDevMask,
+                       values.type_flag_,
+                       0);
+      return NDArray(data, 0, [file]() mutable { file.reset(); });
+    }
+#endif  // _WIN32
+    NDArray out(shape, Context::CPU(), false, values.type_flag_);
+    char* dst = static_cast<char*>(out.data().dptr_);
+    for (const auto& range : ranges) {
+      const size_t bytes = (range.second - range.first) * row_bytes;
+      std::memcpy(dst, src + range.first * row_bytes, bytes);
+      dst += bytes;
+    }
+    std::memset(dst, 0, static_cast<char*>(out.data().dptr_) + num_rows * row_bytes - dst);
+    return out;
+  }
+  const TBlob& indices = column.arrays[1].blob;
+  const TBlob& indptr  = column.arrays[2].blob;
+  size_t nnz           = 0;
+  for (const auto& range : ranges) {
+    nnz += IndexAt(indptr, range.second) - IndexAt(indptr, range.first);
+  }
+  NDArray out(kCSRStorage,
+              mxnet::TShape({static_cast<dim_t>(num_rows), column.shape[1]}),
+              Context::CPU(),
+              true,
+              values.type_flag_);
+  out.CheckAndAllocAuxData(csr::kIdx, mshadow::Shape1(nnz));
+  out.CheckAndAllocData(mshadow::Shape1(nnz));
+  out.CheckAndAllocAuxData(csr::kIndPtr, mshadow::Shape1(num_rows + 1));
+  const size_t value_bytes = mshadow::mshadow_sizeof(values.type_flag_);
+  char* out_values         = static_cast<char*>(out.data().dptr_);
+  int64_t* out_indices     = out.aux_data(csr::kIdx).dptr<int64_t>();
+  int64_t* out_indptr      = out.aux_data(csr::kIndPtr).dptr<int64_t>();
+  out_indptr[0]            = 0;
+  size_t pos = 0, row = 0;
+  for (const auto& range : ranges) {
+    const int64_t begin = IndexAt(indptr, range.first);
+    const int64_t end   = IndexAt(indptr, range.second);
+    std::memcpy(
+        out_values + pos * value_bytes, src + begin * value_bytes, (end - begin) * value_bytes);
+    for (int64_t k = begin; k < end; ++k) {
+      out_indices[pos + k - begin] = IndexAt(indices, k);
+    }
+    for (size_t r = range.first; r < range.second; ++r) {
+      out_indptr[++row] = pos + IndexAt(indptr, r + 1) - begin;
+    }
+    pos += end - begin;
+  }
+  while (row < num_rows) {
+    out_indptr[++row] = pos;
+  }
+  return out;
+}
+
+NDArray ColumnarTable::Row(size_t col, size_t row) const {
+  CHECK_LT(row, num_rows_) << "Row " << row << " out of bound: " << num_rows_;
+  const Column& column = columns_[col];
+  mxnet::TShape shape;
+  shape.assign(column.shape.begin() + 1, column.shape.end());
+  if (column.stype == kDefaultStorage) {
+    // a row of a column of scalars is a scalar, as in NDArrayDataset
+    return Rows(col, {RowRange(row, row + 1)}, 1).Reshape(shape.ndim() ? shape : TShape(0, 1));
+  }
+  const TBlob& values  = column.arrays[0].blob;
+  const TBlob& indices = column.arrays[1].blob;
+  const TBlob& indptr  = column.arrays[2].blob;
+  NDArray out(shape, Context::CPU(), false, values.type_flag_);
+  MSHADOW_TYPE_SWITCH(values.type_flag_, DType, {
+    DType* dst = out.data().dptr<DType>();
+    std::fill(dst, dst + shape.Size(), DType(0));
+    for (int64_t k = IndexAt(indptr, row); k < IndexAt(indptr, row + 1); ++k) {
+      dst[IndexAt(indices, k)] = values.dptr<DType>()[k];
+    }
+  });
+  return out;
+}
+
+void ColumnarTable::WillNeed(size_t begin, size_t end) const {
+#ifndef _WIN32
+  end = std::min(end, num_rows_);
+  if (begin >= end) {
+    return;
+  }
+  // ask for the bytes of the elements [first, last) of each array
+  auto will_need = [](const MappedArray& array, size_t first, size_t last, size_t bytes) {
+    const size_t offset = static_cast<const char*>(array.blob.dptr_) - array.file->data();
+    array.file->WillNeed(offset + first * bytes, offset + last * bytes);
+  };
+  for (const auto& column : columns_) {
+    if (column.stype == kDefaultStorage) {
+      will_need(column.arrays[0], begin, end, RowBytes(column));
+      continue;
+    }
+    const TBlob& indptr = column.arrays[2].blob;
+    const size_t first  = IndexAt(indptr, begin);
+    const size_t last   = IndexAt(indptr, end);
+    for (size_t i = 0; i < 2; ++i) {
+      const MappedArray& array = column.arrays[i];
+      will_need(array, first, last, mshadow::mshadow_sizeof(array.blob.type_flag_));
+    }
+  }
+#endif  // _WIN32
+}
+
+}  // namespace io
+}  // namespace mxnet
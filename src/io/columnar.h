@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file columnar.h
+ * \brief columns of a dataset stored as npy files, mapped into memory
+ */
+#ifndef MXNET_IO_COLUMNAR_H_
+#define MXNET_IO_COLUMNAR_H_
+
+#include <mxnet/ndarray.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "./mapped_file.h"
+
+namespace mxnet {
+namespace io {
+
+/*!
+ * \brief the columns of a columnar dataset
+ *
+ * A columnar dataset is a directory with npy files, rows first:
+ * - a dense column <name> is <name>.npy, of any fixed-width dtype and shape;
+ * - a CSR column <name> is <name>.data.npy, <name>.indices.npy, <name>.indptr.npy and
+ *   <name>.shape.npy, the arrays scipy.sparse.save_npz stores.
+ *
+ * The files are mapped into memory. Rows of dense columns become NDArrays pointing into the
+ * mapping, which they keep alive, so nothing is parsed or copied.
+ */
+class ColumnarTable {
+ public:
+  /*! \brief rows [first, second) */
+  using RowRange = std::pair<size_t, size_t>;
+
+  /*!
+   * \param path the directory of the dataset
+   * \param names the columns to read
+   * \param random_access whether the rows are read in random order, else sequentially
+   */
+  ColumnarTable(const std::string& path, const std::vector<std::string>& names, bool random_access);
+
+  size_t num_rows() const {
+    return num_rows_;
+  }
+  size_t num_columns() const {
+    return columns_.size();
+  }
+  NDArrayStorageType storage_type(size_t col) const {
+    return columns_[col].stype;
+  }
+
+  /*!
+   * \brief the rows of ranges, one after the other, of a column
+   * \param num_rows number of rows of the result, rows after those of ranges are zero
+   *
+   * A single range of a dense column points into the mapping, all else is copied.
+   */
+  NDArray Rows(size_t col, const std::vector<RowRange>& ranges, size_t num_rows) const;
+  /*! \brief a row of a column without the row dimension, CSR rows are made dense */
+  NDArray Row(size_t col, size_t row) const;
+  /*! \brief ask the kernel to read rows [begin, end) of all columns ahead */
+  void WillNeed(size_t begin, size_t end) const;
+
+ private:
+  /*! \brief an array of an npy file, mapped into memory */
+  struct MappedArray {
+#ifndef _WIN32
+    std::shared_ptr<MappedFile> file;
+#endif  // _WIN32
+    TBlob blob;
+  };
+  struct Column {
+    NDArrayStorageType stype;
+    /*! \brief the shape of the whole column */
+    mxnet::TShape shape;
+    /*! \brief the values of a dense column, or data, indices and indptr of a CSR column */
+    std::vector<MappedArray> arrays;
+  };
+
+  MappedArray Map(const std::string& file, bool random_access) const;
+  /*! \brief the bytes of row of a dense column in its npy file */
+  size_t RowBytes(const Column& column) const;
+
+  size_t num_rows_ = 0;
+  std::vector<Column> columns_;
+};
+
+}  // namespace io
+}  // namespace mxnet
+#endif  // MXNET_IO_COLUMNAR_H_
@@ -25,15 +25,31 @@
 #include <dmlc/omp.h>
 #include <mxnet/io.h>
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
 #include "./inst_vector.h"
 #include "./iter_prefetcher.h"
+#include "../engine/thread_budget.h"
 #include "../profiler/custom_op_profiler.h"
+#include "../profiler/data_profiler.h"
 
 namespace mxnet {
 namespace io {
 struct ThreadedDataLoaderParam : public dmlc::Parameter<ThreadedDataLoaderParam> {
   /*! \brief Multithread worker number. */
   int num_workers;
+  /*! \brief number of threads batchifying the batches */
+  int num_batchify_workers;
+  /*! \brief number of batches in the pipeline */
+  int queue_depth;
   /*! \brief dataset pointer.*/
   std::intptr_t dataset;
   /*! \brief sampler pointer.*/
@@ -45,23 +61,47 @@ struct ThreadedDataLoaderParam : public dmlc::Parameter<ThreadedDataLoaderParam>
   // declare parameters
   DMLC_DECLARE_PARAMETER(ThreadedDataLoaderParam) {
     DMLC_DECLARE_FIELD(num_workers).set_default(0).describe("Number of thread workers.");
+    DMLC_DECLARE_FIELD(num_batchify_workers)
+        .set_default(1)
+        .describe("Number of threads batchifying batches while the workers get the next ones.");
+    DMLC_DECLARE_FIELD(queue_depth)
+        .set_default(2)
+        .describe(
+            "Maximum number of batches sampled and not returned yet. "
+            "The sampler waits while this many batches are being read, transformed or batchified.");
     DMLC_DECLARE_FIELD(dataset).describe("Pointer to shared Dataset.");
     DMLC_DECLARE_FIELD(sampler).describe("Pointer to Sampler.");
     DMLC_DECLARE_FIELD(batchify_fn).describe("Pointer to Batchify function.");
     DMLC_DECLARE_FIELD(pin_device_id)
         .set_default(-1)
-        .describe("If not negative, will move data to pinned memory.");
+        .describe(
+            "If not negative, batchify into pinned memory of this device. "
+            "Defaults to the device_id of the prefetcher when its ctx is cpu_pinned.");
   }
 };  // struct ThreadedDataLoaderParam
 
 DMLC_REGISTER_PARAMETER(ThreadedDataLoaderParam);
 
+/*!
+ * \brief loads batches through a pipeline of bounded queues
+ *
+ * A sampler thread draws the indices of up to queue_depth batches ahead and hints them to
+ * the dataset, num_workers threads get the items of all these batches, and as soon as all
+ * items of a batch are in, one of num_batchify_workers threads batchifies it. So the items
+ * of the next batches are read and transformed while a batch is batchified, and the
+ * PrefetcherIter wrapping the loader copies it to pinned memory meanwhile, or else takes
+ * its arrays and gives them back to be batchified into once they are consumed. Batches
+ * are returned in the order of the sampler.
+ */
 template <typename DType = real_t>
-class ThreadedDataLoader : public IIterator<TBlobBatch> {
+class ThreadedDataLoader : public IIterator<TBlobBatch>, public HandoffBatchLoader {
  public:
   ThreadedDataLoader() = default;
   // destructor
-  ~ThreadedDataLoader() override = default;
+  ~ThreadedDataLoader() override {
+    Stop();
+    engine::ThreadBudget::Get()->ReleaseLoaderThreads(budget_threads_);
+  }
   // constructor
   void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) override {
     param_.InitAllowUnknown(kwargs);
@@ -74,16 +114,31 @@ class ThreadedDataLoader : public IIterator<TBlobBatch> {
     param_.num_workers = std::min(maxthread, param_.num_workers);
 #pragma omp parallel num_threads(param_.num_workers)
     { threadget = omp_get_num_threads(); }
-    param_.num_workers = std::max(1, threadget);
+    // the workers share the cores of the data loaders when a thread budget is set
+    engine::ThreadBudget::Get()->ReleaseLoaderThreads(budget_threads_);
+    param_.num_workers = engine::ThreadBudget::Get()->AcquireLoaderThreads(std::max(1, threadget));
+    budget_threads_    = param_.num_workers;
+    CHECK_GT(param_.num_batchify_workers, 0) << "num_batchify_workers must be positive";
+    CHECK_GT(param_.queue_depth, 0) << "queue_depth must be positive";
     dataset_     = *static_cast<std::shared_ptr<Dataset>*>(reinterpret_cast<void*>(param_.dataset));
     dataset_len_ = dataset_->GetLen();
     sampler_     = static_cast<IIterator<DataBatch>*>(reinterpret_cast<void*>(param_.sampler));
     batchify_fn_ = *static_cast<BatchifyFunctionPtr*>(reinterpret_cast<void*>(param_.batchify_fn));
+    PrefetcherParam prefetch_param;
+    prefetch_param.InitAllowUnknown(kwargs);
+    if (param_.pin_device_id < 0 && prefetch_param.ctx == PrefetcherParam::kCPUPinned) {
+      param_.pin_device_id = prefetch_param.device_id;
+    }
+    // batchify into the pinned memory the prefetcher would copy to, so that it takes the batches
+    ctx_ = param_.pin_device_id >= 0 ? Context::CPUPinned(param_.pin_device_id) : Context::CPU();
+    batchify_fn_->SetOutputContext(ctx_);
     this->BeforeFirst();
   }
   // before first
   void BeforeFirst() override {
+    Stop();
     sampler_->BeforeFirst();
+    Start();
   }
 
   int64_t GetLenHint() const override {
@@ -91,55 +146,31 @@ class ThreadedDataLoader : public IIterator<TBlobBatch> {
   }
 
   bool Next() override {
-    bool has_next = sampler_->Next();
-    if (!has_next)
-      return false;
-    auto samples           = sampler_->Value();
-    auto batch_size        = samples.data[0].shape().Size();
-    int real_batch_size    = batch_size - samples.num_batch_padd;
-    const int64_t* idx_ptr = static_cast<int64_t*>(samples.data[0].data().dptr_);
-    std::vector<int64_t> idx_ptrs;
-    idx_ptrs.assign(idx_ptr, idx_ptr + real_batch_size);
-
-    // __getitem__
-    std::vector<std::vector<NDArray> > inputs(batch_size);
-    std::vector<int> is_scalars;
-    bool profiling = profiler::Profiler::Get()->IsProfiling(profiler::Profiler::kImperative);
-    if (profiling) {
-      profiler::CustomOpProfiler::Get()->OnCustomBegin("MXThreadedDataLoaderGetItems");
-    }
-#pragma omp parallel for num_threads(param_.num_workers)
-    for (int i = 0; i < real_batch_size; ++i) {
-      omp_exc_.Run([&] {
-        auto idx = idx_ptrs[i];
-        CHECK(dataset_->GetItem(idx, &inputs[i])) << "Error getting data # " << idx;
+    std::shared_ptr<Batch> batch;
+    {
+      profiler::DataSpan span("prefetch wait", false);
+      std::unique_lock<std::mutex> lock(mu_);
+      out_cv_.wait(lock, [this]() {
+        return error_ != nullptr || (!batches_.empty() && batches_.front()->batchified) ||
+               (batches_.empty() && sampled_all_);
       });
+      if (error_ != nullptr) {
+        std::rethrow_exception(error_);
+      }
+      if (batches_.empty()) {
+        return false;
+      }
+      batch = std::move(batches_.front());
+      batches_.pop_front();
     }
-    if (profiling) {
-      profiler::CustomOpProfiler::Get()->OnCustomEnd();
-    }
-    omp_exc_.Rethrow();
-
-    // pad to normal batch size
-    for (size_t i = real_batch_size; i < batch_size; ++i) {
-      inputs[i] = inputs[0];
-    }
-
-    // batchify
-    if (profiling) {
-      profiler::CustomOpProfiler::Get()->OnCustomBegin("MXThreadedDataLoaderBatchify");
-    }
-    CHECK(batchify_fn_->Batchify(inputs, &batched_buffer_))
-        << "Error call batchify inside dataloader";
-    if (profiling) {
-      profiler::CustomOpProfiler::Get()->OnCustomEnd();
-    }
+    sample_cv_.notify_one();
+    batched_buffer_ = std::move(batch->outputs);
     out_.batch_size = batched_buffer_.size();
     out_.data.resize(batched_buffer_.size());
     for (size_t i = 0; i < batched_buffer_.size(); ++i) {
       out_.data[i] = batched_buffer_[i].data();
     }
-    out_.num_batch_padd = samples.num_batch_padd;
+    out_.num_batch_padd = batch->num_batch_padd;
     return true;
   }
 
@@ -147,7 +178,208 @@ class ThreadedDataLoader : public IIterator<TBlobBatch> {
     return out_;
   }
 
+  void TakeArrays(std::vector<NDArray>* arrays) override {
+    *arrays = std::move(batched_buffer_);
+    batched_buffer_.clear();
+  }
+
+  void RecycleArrays(std::vector<NDArray>* arrays) override {
+    std::lock_guard<std::mutex> lock(mu_);
+    free_outputs_.push_back(std::move(*arrays));
+    arrays->clear();
+  }
+
+  Context ArraysContext() const override {
+    return ctx_;
+  }
+
  private:
+  /*! \brief a batch going through the pipeline */
+  struct Batch {
+    /*! \brief indices of the items, without the padding */
+    std::vector<int64_t> indices;
+    /*! \brief items padded to the batch size */
+    std::vector<std::vector<NDArray> > inputs;
+    int num_batch_padd;
+    /*! \brief number of items not got yet */
+    size_t pending;
+    std::vector<NDArray> outputs;
+    bool batchified = false;
+  };
+
+  /*!
+   * \brief pull batches from the sampler while fewer than queue_depth are in the pipeline
+   */
+  void SampleLoop() {
+    engine::ThreadBudget::Get()->PinLoaderThread();
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mu_);
+        sample_cv_.wait(lock, [this]() {
+          return stop_ || static_cast<int>(batches_.size()) < param_.queue_depth;
+        });
+        if (stop_) {
+          return;
+        }
+      }
+      auto batch = std::make_shared<Batch>();
+      try {
+        if (!sampler_->Next()) {
+          std::lock_guard<std::mutex> lock(mu_);
+          sampled_all_ = true;
+          out_cv_.notify_all();
+          return;
+        }
+        const auto& samples     = sampler_->Value();
+        const size_t batch_size = samples.data[0].shape().Size();
+        const int64_t* idx_ptr  = static_cast<int64_t*>(samples.data[0].data().dptr_);
+        batch->num_batch_padd   = samples.num_batch_padd;
+        batch->indices.assign(idx_ptr, idx_ptr + batch_size - samples.num_batch_padd);
+        batch->inputs.resize(batch_size);
+        batch->pending = batch->indices.size();
+        CHECK_GT(batch->pending, 0U) << "the sampler returned a batch of padding only";
+        // let the dataset read the items ahead while the workers get the items before them
+        dataset_->Prefetch(std::vector<uint64_t>(batch->indices.begin(), batch->indices.end()));
+      } catch (...) {
+        Fail(std::current_exception());
+        return;
+      }
+      std::lock_guard<std::mutex> lock(mu_);
+      batches_.push_back(batch);
+      for (size_t i = 0; i < batch->indices.size(); ++i) {
+        items_.emplace_back(batch, i);
+      }
+      item_cv_.notify_all();
+    }
+  }
+
+  /*!
+   * \brief get the items of the batches in the pipeline, in the order they were sampled
+   */
+  void GetItemLoop() {
+    engine::ThreadBudget::Get()->PinLoaderThread();
+    const bool profiling = profiler::Profiler::Get()->IsProfiling(profiler::Profiler::kImperative);
+    while (true) {
+      std::shared_ptr<Batch> batch;
+      size_t i;
+      {
+        std::unique_lock<std::mutex> lock(mu_);
+        item_cv_.wait(lock, [this]() { return stop_ || !items_.empty(); });
+        if (stop_) {
+          return;
+        }
+        std::tie(batch, i) = std::move(items_.front());
+        items_.pop_front();
+      }
+      try {
+        if (profiling) {
+          profiler::CustomOpProfiler::Get()->OnCustomBegin("MXThreadedDataLoaderGetItems");
+        }
+        const auto idx = batch->indices[i];
+        profiler::DataSpan span("read");
+        CHECK(dataset_->GetItem(idx, &batch->inputs[i])) << "Error getting data # " << idx;
+        if (profiling) {
+          profiler::CustomOpProfiler::Get()->OnCustomEnd();
+        }
+      } catch (...) {
+        Fail(std::current_exception());
+        return;
+      }
+      std::lock_guard<std::mutex> lock(mu_);
+      if (--batch->pending == 0) {
+        batchify_queue_.push_back(std::move(batch));
+        batchify_cv_.notify_one();
+      }
+    }
+  }
+
+  /*!
+   * \brief batchify the batches whose items are all in
+   */
+  void BatchifyLoop() {
+    engine::ThreadBudget::Get()->PinLoaderThread();
+    const bool profiling = profiler::Profiler::Get()->IsProfiling(profiler::Profiler::kImperative);
+    while (true) {
+      std::shared_ptr<Batch> batch;
+      {
+        std::unique_lock<std::mutex> lock(mu_);
+        batchify_cv_.wait(lock, [this]() { return stop_ || !batchify_queue_.empty(); });
+        if (stop_) {
+          return;
+        }
+        batch = std::move(batchify_queue_.front());
+        batchify_queue_.pop_front();
+        // batchify into the arrays of a batch the prefetcher is done with
+        if (!free_outputs_.empty()) {
+          batch->outputs = std::move(free_outputs_.back());
+          free_outputs_.pop_back();
+        }
+      }
+      try {
+        // pad to normal batch size
+        for (size_t i = batch->indices.size(); i < batch->inputs.size(); ++i) {
+          batch->inputs[i] = batch->inputs[0];
+        }
+        if (profiling) {
+          profiler::CustomOpProfiler::Get()->OnCustomBegin("MXThreadedDataLoaderBatchify");
+        }
+        profiler::DataSpan span("batchify");
+        CHECK(batchify_fn_->Batchify(batch->inputs, &batch->outputs))
+            << "Error call batchify inside dataloader";
+        if (profiling) {
+          profiler::CustomOpProfiler::Get()->OnCustomEnd();
+        }
+        batch->inputs.clear();
+      } catch (...) {
+        Fail(std::current_exception());
+        return;
+      }
+      std::lock_guard<std::mutex> lock(mu_);
+      batch->batchified = true;
+      out_cv_.notify_all();
+    }
+  }
+
+  /*! \brief stop the pipeline on the first error, which Next rethrows */
+  void Fail(std::exception_ptr error) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (error_ == nullptr) {
+      error_ = error;
+    }
+    out_cv_.notify_all();
+  }
+
+  void Start() {
+    stop_        = false;
+    sampled_all_ = false;
+    error_       = nullptr;
+    threads_.emplace_back([this]() { SampleLoop(); });
+    for (int i = 0; i < param_.num_workers; ++i) {
+      threads_.emplace_back([this]() { GetItemLoop(); });
+    }
+    for (int i = 0; i < param_.num_batchify_workers; ++i) {
+      threads_.emplace_back([this]() { BatchifyLoop(); });
+    }
+  }
+
+  /*! \brief stop the threads and drop the batches in the pipeline */
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      stop_ = true;
+    }
+    sample_cv_.notify_all();
+    item_cv_.notify_all();
+    batchify_cv_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+    threads_.clear();
+    batches_.clear();
+    items_.clear();
+    batchify_queue_.clear();
+  }
+
   /*! \brief Params */
   ThreadedDataLoaderParam param_;
   /*! \brief output */
@@ -162,8 +394,29 @@ class ThreadedDataLoader : public IIterator<TBlobBatch> {
   IIterator<DataBatch>* sampler_;
   /*! \brief pointer to batchify function */
   BatchifyFunctionPtr batchify_fn_;
-  /*! \brief OMPException obj to store and rethrow exceptions from omp blocks*/
-  dmlc::OMPException omp_exc_;
+  /*! \brief context of the batches */
+  Context ctx_;
+  /*! \brief sampler, worker and batchify threads */
+  std::vector<std::thread> threads_;
+  /*! \brief number of worker threads taken from the thread budget */
+  int budget_threads_ = 0;
+  /*! \brief guards the queues and flags below */
+  std::mutex mu_;
+  std::condition_variable sample_cv_;
+  std::condition_variable item_cv_;
+  std::condition_variable batchify_cv_;
+  std::condition_variable out_cv_;
+  /*! \brief batches sampled and not returned yet, in the order of the sampler */
+  std::deque<std::shared_ptr<Batch> > batches_;
+  /*! \brief items to get, as their batch and position in it */
+  std::deque<std::pair<std::shared_ptr<Batch>, size_t> > items_;
+  /*! \brief batches whose items are all in */
+  std::deque<std::shared_ptr<Batch> > batchify_queue_;
+  /*! \brief arrays given back by the prefetcher, to batchify into */
+  std::vector<std::vector<NDArray> > free_outputs_;
+  bool stop_        = false;
+  bool sampled_all_ = false;
+  std::exception_ptr error_;
 };  // class ThreadedDataLoader
 
 MXNET_REGISTER_IO_ITER(ThreadedDataLoader)
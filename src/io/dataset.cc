@@ -32,11 +32,15 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <cstring>
+#include <limits>
 #include <thread>
 
 #include "../imperative/cached_op.h"
 #include "../imperative/naive_cached_op.h"
 #include "../ndarray/ndarray_function.h"
+#include "./columnar.h"
+#include "./mapped_file.h"
 
 #if MXNET_USE_OPENCV
 #include <opencv2/opencv.hpp>
@@ -49,10 +53,14 @@ namespace io {
 struct RecordFileDatasetParam : public dmlc::Parameter<RecordFileDatasetParam> {
   std::string rec_file;
   std::string idx_file;
+  bool use_mmap;
   // declare parameters
   DMLC_DECLARE_PARAMETER(RecordFileDatasetParam) {
     DMLC_DECLARE_FIELD(rec_file).describe("The absolute path of record file.");
     DMLC_DECLARE_FIELD(idx_file).describe("The path of the idx file.");
+    DMLC_DECLARE_FIELD(use_mmap).set_default(false).describe(
+        "Map a local record file into memory and return records pointing into the mapping, "
+        "instead of reading and copying each record.");
   }
 };  // struct RecordFileDatasetParam
 
@@ -71,6 +79,29 @@ class RecordFileDataset final : public Dataset {
       idx_[key] = idx;
     }
     delete idx_stream;
+    if (param_.use_mmap) {
+#ifndef _WIN32
+      file_ = std::make_shared<MappedFile>(param_.rec_file, true);
+      // flat arrays of the offsets and of where each record ends at the latest, by key
+      std::vector<size_t> sorted;
+      sorted.reserve(idx_.size());
+      for (const auto& kv : idx_) {
+        if (kv.first >= offsets_.size()) {
+          offsets_.resize(kv.first + 1, kNoRecord);
+        }
+        offsets_[kv.first] = kv.second;
+        sorted.push_back(kv.second);
+      }
+      std::sort(sorted.begin(), sorted.end());
+      ends_.resize(offsets_.size());
+      for (size_t k = 0; k < offsets_.size(); ++k) {
+        auto next = std::upper_bound(sorted.begin(), sorted.end(), offsets_[k]);
+        ends_[k]  = next == sorted.end() ? file_->size() : *next;
+      }
+#else
+      LOG(FATAL) << "use_mmap is not supported on Windows";
+#endif  // _WIN32
+    }
   }
 
   uint64_t GetLen() const override {
@@ -80,6 +111,11 @@ class RecordFileDataset final : public Dataset {
   bool GetItem(uint64_t idx, std::vector<NDArray>* ret) override {
     ret->resize(1);
     auto& out = (*ret)[0];
+#ifndef _WIN32
+    if (file_ != nullptr) {
+      return GetMappedItem(idx, &out);
+    }
+#endif  // _WIN32
     static thread_local std::unique_ptr<dmlc::Stream> stream;
     static thread_local std::unique_ptr<dmlc::RecordIOReader> reader;
     if (!reader) {
@@ -109,7 +145,77 @@ class RecordFileDataset final : public Dataset {
     return true;
   }
 
+  void Prefetch(const std::vector<uint64_t>& indices) override {
+#ifndef _WIN32
+    if (file_ == nullptr) {
+      return;
+    }
+    for (uint64_t idx : indices) {
+      if (idx < offsets_.size() && offsets_[idx] != kNoRecord) {
+        file_->WillNeed(offsets_[idx], ends_[idx]);
+      }
+    }
+#endif  // _WIN32
+  }
+
  private:
+#ifndef _WIN32
+  /*!
+   * \brief point out into the mapping at the record, only records split into
+   *  several parts by the writer are copied to be joined
+   */
+  bool GetMappedItem(uint64_t idx, NDArray* out) {
+    CHECK(idx < offsets_.size() && offsets_[idx] != kNoRecord)
+        << "Record " << idx << " is not in " << param_.idx_file;
+    const uint32_t kMagic = dmlc::RecordIOWriter::kMagic;
+    size_t pos            = offsets_[idx];
+    std::string joined;
+    char* record = nullptr;
+    size_t size  = 0;
+    while (true) {
+      CHECK_LE(pos + 2 * sizeof(uint32_t), file_->size()) << "Invalid RecordIO file";
+      uint32_t header[2];
+      std::memcpy(header, file_->data() + pos, sizeof(header));
+      CHECK_EQ(header[0], kMagic) << "Invalid RecordIO file";
+      const uint32_t cflag = dmlc::RecordIOWriter::DecodeFlag(header[1]);
+      const uint32_t len   = dmlc::RecordIOWriter::DecodeLength(header[1]);
+      pos += sizeof(header);
+      CHECK_LE(pos + len, file_->size()) << "Invalid RecordIO file";
+      if (cflag == 0U) {
+        record = file_->data() + pos;
+        size   = len;
+        break;
+      }
+      // the writer split the record where its content held the magic number
+      joined.append(file_->data() + pos, len);
+      if (cflag == 3U) {
+        break;
+      }
+      joined.append(reinterpret_cast<const char*>(&kMagic), sizeof(kMagic));
+      pos += ((len + 3U) >> 2U) << 2U;
+    }
+    const TShape shape({static_cast<dim_t>(record != nullptr ? size : joined.size())});
+    if (record != nullptr) {
+      // the NDArray keeps the mapping alive
+      auto file = file_;
+      const TBlob data(record, shape, cpu::kDevMask, mshadow::kInt8, 0);
+      *out = NDArray(data, 0, [file]() mutable { file.reset(); });
+    } else {
+      *out = NDArray(shape, Context::CPU(), false, mshadow::kInt8);
+      std::memcpy(out->data().dptr_, joined.data(), joined.size());
+    }
+    return true;
+  }
+
+  /*! \brief offset of keys missing from the idx file */
+  static constexpr size_t kNoRecord = std::numeric_limits<size_t>::max();
+  /*! \brief the mapped record file if use_mmap */
+  std::shared_ptr<MappedFile> file_;
+  /*! \brief offset of each record by key, when mapped */
+  std::vector<size_t> offsets_;
+  /*! \brief offset of the next record or end of the file by key, when mapped */
+  std::vector<size_t> ends_;
+#endif  // _WIN32
   /*! \brief parameters */
   RecordFileDatasetParam param_;
   /*! \brief indices */
@@ -127,12 +233,15 @@ struct ImageRecordFileDatasetParam : public dmlc::Parameter<ImageRecordFileDatas
   std::string rec_file;
   std::string idx_file;
   int flag;
+  bool use_mmap;
   // declare parameters
   DMLC_DECLARE_PARAMETER(ImageRecordFileDatasetParam) {
     DMLC_DECLARE_FIELD(rec_file).describe("The absolute path of record file.");
     DMLC_DECLARE_FIELD(idx_file).describe("The path of the idx file.");
     DMLC_DECLARE_FIELD(flag).set_default(1).describe(
         "If 1, always convert to colored, if 0 always convert to grayscale.");
+    DMLC_DECLARE_FIELD(use_mmap).set_default(false).describe(
+        "Map a local record file into memory and decode the images from the mapping.");
   }
 };  // struct ImageRecordFileDatasetParam
 
@@ -198,6 +307,10 @@ class ImageRecordFileDataset : public Dataset {
     return base_->GetLen();
   }
 
+  void Prefetch(const std::vector<uint64_t>& indices) override {
+    base_->Prefetch(indices);
+  }
+
   bool GetItem(uint64_t idx, std::vector<NDArray>* ret) override {
     CHECK_LT(idx, GetLen());
     std::vector<NDArray> raw;
@@ -398,6 +511,61 @@ MXNET_REGISTER_IO_DATASET(NDArrayDataset)
       return new NDArrayDataset(kwargs);
     });
 
+struct ColumnarDatasetParam : public dmlc::Parameter<ColumnarDatasetParam> {
+  /*! \brief directory of the dataset */
+  std::string path;
+  /*! \brief comma separated columns */
+  std::string columns;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(ColumnarDatasetParam) {
+    DMLC_DECLARE_FIELD(path).describe("The directory of the npy files of the columns.");
+    DMLC_DECLARE_FIELD(columns).describe("The comma separated columns of an item.");
+  }
+};  // struct ColumnarDatasetParam
+
+DMLC_REGISTER_PARAMETER(ColumnarDatasetParam);
+
+class ColumnarDataset final : public Dataset {
+ public:
+  explicit ColumnarDataset(const std::vector<std::pair<std::string, std::string>>& kwargs) {
+    param_.InitAllowUnknown(kwargs);
+    table_ = std::make_unique<ColumnarTable>(param_.path, dmlc::Split(param_.columns, ','), true);
+  }
+
+  uint64_t GetLen() const override {
+    return table_->num_rows();
+  }
+
+  bool GetItem(uint64_t idx, std::vector<NDArray>* rets) override {
+    CHECK_LT(idx, table_->num_rows())
+        << "GetItem index: " << idx << " out of bound: " << table_->num_rows();
+    rets->resize(table_->num_columns());
+    for (size_t i = 0; i < table_->num_columns(); ++i) {
+      (*rets)[i] = table_->Row(i, idx);
+    }
+    return true;
+  }
+
+  void Prefetch(const std::vector<uint64_t>& indices) override {
+    for (uint64_t idx : indices) {
+      table_->WillNeed(idx, idx + 1);
+    }
+  }
+
+ private:
+  /*! \brief parameters */
+  ColumnarDatasetParam param_;
+  /*! \brief the mapped columns */
+  std::unique_ptr<ColumnarTable> table_;
+};  // class ColumnarDataset
+
+MXNET_REGISTER_IO_DATASET(ColumnarDataset)
+    .describe("Columnar Dataset of npy files, mapped into memory")
+    .add_arguments(ColumnarDatasetParam::__FIELDS__())
+    .set_body([](const std::vector<std::pair<std::string, std::string>>& kwargs) {
+      return new ColumnarDataset(kwargs);
+    });
+
 struct GroupDatasetParam : public dmlc::Parameter<GroupDatasetParam> {
   /*! \brief the source ndarray */
   Tuple<std::intptr_t> datasets;
@@ -446,6 +614,12 @@ class GroupDataset final : public Dataset {
     return true;
   }
 
+  void Prefetch(const std::vector<uint64_t>& indices) override {
+    for (const auto& child : childs_) {
+      child->Prefetch(indices);
+    }
+  }
+
  private:
   /*! \brief parameters */
   GroupDatasetParam param_;
@@ -499,6 +673,17 @@ class IndexedDataset final : public Dataset {
     return base_data_->GetItem(new_idx, ret);
   }
 
+  void Prefetch(const std::vector<uint64_t>& indices) override {
+    std::vector<uint64_t> base_indices;
+    base_indices.reserve(indices.size());
+    for (uint64_t idx : indices) {
+      if (idx < param_.indices.ndim()) {
+        base_indices.push_back(param_.indices[idx]);
+      }
+    }
+    base_data_->Prefetch(base_indices);
+  }
+
  private:
   /*! \brief parameters */
   IndexedDatasetParam param_;
@@ -632,6 +817,10 @@ class LazyTransformDataset final : public Dataset {
     return true;
   }
 
+  void Prefetch(const std::vector<uint64_t>& indices) override {
+    base_data_->Prefetch(indices);
+  }
+
  private:
   /*! \brief parameters */
   LazyTransformDatasetParam param_;
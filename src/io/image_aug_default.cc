@@ -26,6 +26,7 @@
 #include <utility>
 #include <string>
 #include <algorithm>
+#include <cmath>
 #include <vector>
 #include "./image_augmenter.h"
 #include "../common/utils.h"
@@ -226,6 +227,142 @@ std::vector<dmlc::ParamFieldInfo> ListDefaultAugParams() {
   return DefaultImageAugmentParam::__FIELDS__();
 }
 
+bool ImageCropSampler::Supported(
+    const std::vector<std::pair<std::string, std::string> >& kwargs) {
+  DefaultImageAugmentParam param;
+  param.InitAllowUnknown(kwargs);
+  bool has_rotate_list = false;
+  for (const auto& kwarg : kwargs) {
+    has_rotate_list = has_rotate_list || kwarg.first == "rotate_list";
+  }
+  // aspect ratio changes without random_resized_crop are affine transforms
+  const bool aspect = param.min_aspect_ratio.has_value()
+                          ? param.min_aspect_ratio.value() != 1.0f || param.max_aspect_ratio != 1.0f
+                          : param.max_aspect_ratio != 0.0f;
+  return param.max_rotate_angle == 0 && param.rotate <= 0 && !has_rotate_list &&
+         param.max_shear_ratio == 0.0f && param.max_random_scale == 1.0f &&
+         param.min_random_scale == 1.0f && param.max_img_size == 1e10f &&
+         param.min_img_size == 0.0f && param.pad == 0 && param.brightness == 0.0f &&
+         param.contrast == 0.0f && param.saturation == 0.0f && param.pca_noise == 0.0f &&
+         param.random_h == 0 && param.random_s == 0 && param.random_l == 0 &&
+         (param.random_resized_crop || !aspect);
+}
+
+ImageCropSampler::ImageCropSampler(
+    const std::vector<std::pair<std::string, std::string> >& kwargs) {
+  CHECK(Supported(kwargs))
+      << "Only resize and the crop options of the default augmenter are supported "
+         "when decoding on the device, not rotate, shear, random scale or aspect ratio "
+         "without random_resized_crop, image size, pad or color augmentations";
+  DefaultImageAugmentParam param;
+  param.InitAllowUnknown(kwargs);
+  if (param.min_aspect_ratio.has_value()) {
+    max_aspect_ratio_ = param.max_aspect_ratio;
+    min_aspect_ratio_ = param.min_aspect_ratio.value();
+  } else {
+    max_aspect_ratio_ = 1 + param.max_aspect_ratio;
+    min_aspect_ratio_ = 1 - param.max_aspect_ratio;
+  }
+  if (param.random_resized_crop) {
+    CHECK(param.min_crop_size == -1 && param.max_crop_size == -1 && !param.rand_crop)
+        << "\nSetting random_resized_crop to true conflicts with "
+           "min_crop_size, max_crop_size, and rand_crop.";
+    CHECK(min_aspect_ratio_ > 0.0f);
+    CHECK(param.min_random_area <= param.max_random_area);
+    CHECK(min_aspect_ratio_ <= max_aspect_ratio_);
+  }
+  resize_              = param.resize;
+  rand_crop_           = param.rand_crop;
+  random_resized_crop_ = param.random_resized_crop;
+  min_crop_size_       = param.min_crop_size;
+  max_crop_size_       = param.max_crop_size;
+  min_random_area_     = param.min_random_area;
+  max_random_area_     = param.max_random_area;
+  out_height_          = param.data_shape[1];
+  out_width_           = param.data_shape[2];
+  inter_method_        = param.inter_method;
+}
+
+ImageCropBox ImageCropSampler::Sample(int width, int height, common::RANDOM_ENGINE* prnd) const {
+  // size after resizing the shorter edge, as in DefaultImageAugmenter::Process
+  int rows = height, cols = width;
+  if (resize_ != -1) {
+    if (height > width) {
+      rows = resize_ * height / width;
+      cols = resize_;
+    } else {
+      rows = resize_;
+      cols = resize_ * width / height;
+    }
+  }
+  // map a box of an image of rows x cols back to the source image
+  auto to_source = [width, height](index_t x, index_t y, index_t w, index_t h, int r, int c) {
+    const float sx = static_cast<float>(width) / c;
+    const float sy = static_cast<float>(height) / r;
+    return ImageCropBox{x * sx, y * sy, w * sx, h * sy};
+  };
+
+  if (random_resized_crop_) {
+    if (max_random_area_ != 1.0f || min_random_area_ != 1.0f || max_aspect_ratio_ != 1.0f ||
+        min_aspect_ratio_ != 1.0f) {
+      std::uniform_real_distribution<float> rand_uniform_area(min_random_area_, max_random_area_);
+      std::uniform_real_distribution<float> rand_uniform_ratio(min_aspect_ratio_,
+                                                               max_aspect_ratio_);
+      std::uniform_real_distribution<float> rand_uniform(0, 1);
+      float area = rows * cols;
+      for (int i = 0; i < 10; ++i) {
+        float rand_area   = rand_uniform_area(*prnd);
+        float ratio       = rand_uniform_ratio(*prnd);
+        float target_area = area * rand_area;
+        int y_area        = std::round(std::sqrt(target_area / ratio));
+        int x_area        = std::round(std::sqrt(target_area * ratio));
+        if (rand_uniform(*prnd) > 0.5) {
+          std::swap(x_area, y_area);
+        }
+        if (y_area <= rows && x_area <= cols) {
+          index_t y = std::uniform_int_distribution<index_t>(0, rows - y_area)(*prnd);
+          index_t x = std::uniform_int_distribution<index_t>(0, cols - x_area)(*prnd);
+          return to_source(x, y, x_area, y_area, rows, cols);
+        }
+      }
+    }
+  } else if (max_crop_size_ != -1 || min_crop_size_ != -1) {
+    CHECK(cols >= max_crop_size_ && rows >= max_crop_size_ && max_crop_size_ >= min_crop_size_)
+        << "input image size smaller than max_crop_size";
+    index_t size = std::uniform_int_distribution<index_t>(min_crop_size_, max_crop_size_)(*prnd);
+    index_t y    = rows - size;
+    index_t x    = cols - size;
+    if (rand_crop_) {
+      y = std::uniform_int_distribution<index_t>(0, y)(*prnd);
+      x = std::uniform_int_distribution<index_t>(0, x)(*prnd);
+    } else {
+      y /= 2;
+      x /= 2;
+    }
+    return to_source(x, y, size, size, rows, cols);
+  }
+
+  // center crop, enlarging images smaller than the output first
+  if (rows < out_height_) {
+    cols = static_cast<index_t>(static_cast<float>(out_height_) / rows * cols);
+    rows = out_height_;
+  }
+  if (cols < out_width_) {
+    rows = static_cast<index_t>(static_cast<float>(out_width_) / cols * rows);
+    cols = out_width_;
+  }
+  index_t y = rows - out_height_;
+  index_t x = cols - out_width_;
+  if (rand_crop_) {
+    y = std::uniform_int_distribution<index_t>(0, y)(*prnd);
+    x = std::uniform_int_distribution<index_t>(0, x)(*prnd);
+  } else {
+    y /= 2;
+    x /= 2;
+  }
+  return to_source(x, y, out_width_, out_height_, rows, cols);
+}
+
 #if MXNET_USE_OPENCV
 
 #ifdef _MSC_VER
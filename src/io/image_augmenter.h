@@ -25,15 +25,16 @@
 #define MXNET_IO_IMAGE_AUGMENTER_H_
 
 #include <dmlc/registry.h>
-
-#if MXNET_USE_OPENCV
-#include <opencv2/opencv.hpp>
+#include <memory>   // NOLINT(*)
 #include <vector>   // NOLINT(*)
 #include <utility>  // NOLINT(*)
 #include <string>   // NOLINT(*)
 
 #include "../common/utils.h"
 
+#if MXNET_USE_OPENCV
+#include <opencv2/opencv.hpp>
+
 namespace mxnet {
 namespace io {
 /*!
@@ -102,6 +103,101 @@ namespace io {
 /*! \return the parameter of default augmenter */
 std::vector<dmlc::ParamFieldInfo> ListDefaultAugParams();
 std::vector<dmlc::ParamFieldInfo> ListDefaultDetAugParams();
+
+/*! \brief region of a source image an output image is resampled from */
+struct ImageCropBox {
+  float x;
+  float y;
+  float width;
+  float height;
+};
+
+/*!
+ * \brief samples the crop of the default augmenter without touching the pixels,
+ *  for decoders which crop and resize the images themselves, on the device or
+ *  while decoding. Only resize and the crop options of the default augmenter are supported.
+ */
+class ImageCropSampler {
+ public:
+  /*!
+   * \param kwargs the keyword arguments of the default augmenter
+   */
+  explicit ImageCropSampler(const std::vector<std::pair<std::string, std::string> >& kwargs);
+  /*!
+   * \return whether the default augmenter with these arguments only resizes and crops
+   */
+  static bool Supported(const std::vector<std::pair<std::string, std::string> >& kwargs);
+  /*!
+   * \brief crop of a source image, resized to the data shape by the caller
+   * \param width width of the source image
+   * \param height height of the source image
+   * \param prnd pointer to random number generator.
+   */
+  ImageCropBox Sample(int width, int height, common::RANDOM_ENGINE* prnd) const;
+  /*! \return the inter_method argument of the default augmenter */
+  int inter_method() const {
+    return inter_method_;
+  }
+
+ private:
+  int resize_;
+  bool rand_crop_;
+  bool random_resized_crop_;
+  int min_crop_size_;
+  int max_crop_size_;
+  float min_random_area_;
+  float max_random_area_;
+  float min_aspect_ratio_;
+  float max_aspect_ratio_;
+  int out_height_;
+  int out_width_;
+  int inter_method_;
+};
+
+struct DefaultImageDetAugmentParam;
+
+/*! \brief augmentation of an image sampled by ImageDetCropSampler */
+struct ImageDetCrop {
+  /*! \brief region of the source image resized to the data shape, before mirroring */
+  ImageCropBox box;
+  /*! \brief whether the output image is mirrored */
+  bool mirror;
+  /*! \brief whether the region extends beyond the source image, padded with fill_value */
+  bool pad;
+  /*! \brief factor of the random contrast */
+  float contrast;
+};
+
+/*!
+ * \brief samples the mirror, padding, crop and contrast of the default detection
+ *  augmenter without touching the pixels, and transforms the label of the image
+ *  accordingly. Hue, saturation and illumination, and resize modes keeping the aspect
+ *  ratio are not supported.
+ */
+class ImageDetCropSampler {
+ public:
+  /*!
+   * \param kwargs the keyword arguments of the default detection augmenter
+   */
+  explicit ImageDetCropSampler(const std::vector<std::pair<std::string, std::string> >& kwargs);
+  ~ImageDetCropSampler();
+  /*!
+   * \brief augmentation of a source image
+   * \param width width of the source image
+   * \param height height of the source image
+   * \param label detection label of the image, transformed in place
+   * \param prnd pointer to random number generator.
+   */
+  ImageDetCrop Sample(int width,
+                      int height,
+                      std::vector<float>* label,
+                      common::RANDOM_ENGINE* prnd) const;
+  /*! \return the fill_value argument of the default detection augmenter */
+  int fill_value() const;
+
+ private:
+  std::unique_ptr<DefaultImageDetAugmentParam> param_;
+};
 }  // namespace io
 }  // namespace mxnet
 #endif  // MXNET_IO_IMAGE_AUGMENTER_H_
@@ -0,0 +1,208 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file image_decode_gpu.cc
+ * \brief batched decoding of images with nvJPEG
+ */
+
+#include "./image_decode_gpu.h"
+
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+
+#include <algorithm>
+#include <cstring>
+#if MXNET_USE_OPENCV
+#include <opencv2/opencv.hpp>
+#endif
+#include "../common/cuda/utils.h"
+
+namespace mxnet {
+namespace io {
+
+GPUImageDecoder::GPUImageDecoder(int dev_id, int channels, int height, int width)
+    : dev_id_(dev_id), channels_(channels), height_(height), width_(width) {
+  CHECK(channels_ == 1 || channels_ == 3)
+      << "Decoding on the device supports 1 or 3 channels, not " << channels_;
+  mxnet::common::cuda::DeviceStore device_store(dev_id_);
+  NVJPEG_CALL(nvjpegCreateSimple(&handle_));
+  NVJPEG_CALL(nvjpegJpegStateCreate(handle_, &state_));
+  CUDA_CALL(cudaStreamCreateWithFlags(&stream_, cudaStreamNonBlocking));
+}
+
+GPUImageDecoder::~GPUImageDecoder() {
+  mxnet::common::cuda::DeviceStore device_store(dev_id_);
+  for (auto* buf : {&decoded_, &staging_, &crops_, &mean_img_}) {
+    if (buf->dptr != nullptr) {
+      Storage::Get()->DirectFree(*buf);
+    }
+  }
+  CUDA_CALL(cudaStreamDestroy(stream_));
+  nvjpegJpegStateDestroy(state_);
+  nvjpegDestroy(handle_);
+}
+
+void GPUImageDecoder::Reserve(Storage::Handle* buf, size_t size, Context ctx) {
+  if (size == 0 || (buf->dptr != nullptr && buf->size >= size)) {
+    return;
+  }
+  if (buf->dptr != nullptr) {
+    Storage::Get()->DirectFree(*buf);
+  }
+  // grow geometrically, as the sizes of the images of a batch vary
+  *buf = Storage::Get()->Alloc(std::max(size, buf->size * 3 / 2), ctx);
+}
+
+void GPUImageDecoder::SetMeanImage(const float* mean_img) {
+  mxnet::common::cuda::DeviceStore device_store(dev_id_);
+  const size_t size = sizeof(float) * channels_ * height_ * width_;
+  Reserve(&mean_img_, size, Context::GPU(dev_id_));
+  CUDA_CALL(cudaMemcpy(mean_img_.dptr, mean_img, size, cudaMemcpyHostToDevice));
+}
+
+template <typename DType>
+void GPUImageDecoder::Decode(const std::vector<std::string>& images,
+                             const CropFn& crop,
+                             const float* mean,
+                             DType* out) {
+  mxnet::common::cuda::DeviceStore device_store(dev_id_);
+  const int n = images.size();
+  std::vector<int> widths(n), heights(n);
+  std::vector<bool> on_device(n);
+#if MXNET_USE_OPENCV
+  std::vector<cv::Mat> decoded(n);
+#endif
+  // sizes of the images, decoding on the CPU what nvJPEG cannot
+  size_t device_size = 0, host_size = 0;
+  for (int i = 0; i < n; ++i) {
+    const auto* data = reinterpret_cast<const unsigned char*>(images[i].data());
+    int components;
+    nvjpegChromaSubsampling_t subsampling;
+    int w[NVJPEG_MAX_COMPONENT], h[NVJPEG_MAX_COMPONENT];
+    on_device[i] = images[i].size() > 2 && data[0] == 255 && data[1] == 216 &&
+                   nvjpegGetImageInfo(
+                       handle_, data, images[i].size(), &components, &subsampling, w, h) ==
+                       NVJPEG_STATUS_SUCCESS;
+    if (on_device[i]) {
+      widths[i]  = w[0];
+      heights[i] = h[0];
+    } else {
+#if MXNET_USE_OPENCV
+      cv::Mat buf(1, images[i].size(), CV_8U, const_cast<char*>(images[i].data()));
+      cv::Mat img = cv::imdecode(buf, channels_ == 3 ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE);
+      CHECK(!img.empty()) << "cannot decode image " << i << " of the batch";
+      if (channels_ == 3) {
+        cv::cvtColor(img, img, cv::COLOR_BGR2RGB);
+      }
+      decoded[i] = img;
+      widths[i]  = img.cols;
+      heights[i] = img.rows;
+      host_size += static_cast<size_t>(channels_) * widths[i] * heights[i];
+#else
+      LOG(FATAL) << "Decoding images other than JPEG needs OpenCV";
+#endif
+    }
+    device_size += static_cast<size_t>(channels_) * widths[i] * heights[i];
+  }
+  Reserve(&decoded_, device_size, Context::GPU(dev_id_));
+  Reserve(&staging_, host_size, Context::CPUPinned(dev_id_));
+
+  std::vector<GPUImageCrop> crops(n);
+  std::vector<const unsigned char*> jpegs;
+  std::vector<size_t> jpeg_sizes;
+  std::vector<nvjpegImage_t> dests;
+  auto* device_ptr = static_cast<uint8_t*>(decoded_.dptr);
+  auto* host_ptr   = static_cast<uint8_t*>(staging_.dptr);
+  for (int i = 0; i < n; ++i) {
+    const size_t plane = static_cast<size_t>(widths[i]) * heights[i];
+    crop(i, widths[i], heights[i], &crops[i]);
+    crops[i].src        = device_ptr;
+    crops[i].src_width  = widths[i];
+    crops[i].src_height = heights[i];
+    if (on_device[i]) {
+      nvjpegImage_t dest;
+      std::memset(&dest, 0, sizeof(dest));
+      for (int c = 0; c < channels_; ++c) {
+        dest.channel[c] = device_ptr + c * plane;
+        dest.pitch[c]   = widths[i];
+      }
+      jpegs.push_back(reinterpret_cast<const unsigned char*>(images[i].data()));
+      jpeg_sizes.push_back(images[i].size());
+      dests.push_back(dest);
+    } else {
+#if MXNET_USE_OPENCV
+      // planar like the output of nvJPEG
+      std::vector<cv::Mat> planes;
+      for (int c = 0; c < channels_; ++c) {
+        planes.emplace_back(heights[i], widths[i], CV_8UC1, host_ptr + c * plane);
+      }
+      cv::split(decoded[i], planes);
+      CUDA_CALL(cudaMemcpyAsync(
+          device_ptr, host_ptr, channels_ * plane, cudaMemcpyHostToDevice, stream_));
+      host_ptr += channels_ * plane;
+#endif
+    }
+    device_ptr += channels_ * plane;
+  }
+
+  if (!jpegs.empty()) {
+    if (batched_size_ != static_cast<int>(jpegs.size())) {
+      batched_size_ = jpegs.size();
+      NVJPEG_CALL(nvjpegDecodeBatchedInitialize(
+          handle_, state_, batched_size_, 1, channels_ == 3 ? NVJPEG_OUTPUT_RGB : NVJPEG_OUTPUT_Y));
+    }
+    NVJPEG_CALL(nvjpegDecodeBatched(
+        handle_, state_, jpegs.data(), jpeg_sizes.data(), dests.data(), stream_));
+  }
+
+  Reserve(&crops_, sizeof(GPUImageCrop) * n, Context::GPU(dev_id_));
+  CUDA_CALL(cudaMemcpyAsync(
+      crops_.dptr, crops.data(), sizeof(GPUImageCrop) * n, cudaMemcpyHostToDevice, stream_));
+  GPUImageMean image_mean;
+  std::memcpy(image_mean.mean, mean, sizeof(image_mean.mean));
+  image_mean.mean_img = static_cast<const float*>(mean_img_.dptr);
+  CropResizeNormalize(stream_,
+                      static_cast<const GPUImageCrop*>(crops_.dptr),
+                      n,
+                      image_mean,
+                      channels_,
+                      height_,
+                      width_,
+                      out);
+  // the staging buffer and crops are reused by the next batch
+  CUDA_CALL(cudaStreamSynchronize(stream_));
+}
+
+template void GPUImageDecoder::Decode<float>(const std::vector<std::string>&,
+                                             const CropFn&,
+                                             const float*,
+                                             float*);
+template void GPUImageDecoder::Decode<uint8_t>(const std::vector<std::string>&,
+                                               const CropFn&,
+                                               const float*,
+                                               uint8_t*);
+template void GPUImageDecoder::Decode<int8_t>(const std::vector<std::string>&,
+                                              const CropFn&,
+                                              const float*,
+                                              int8_t*);
+
+}  // namespace io
+}  // namespace mxnet
+
+#endif  // MXNET_USE_CUDA && MXNET_USE_NVJPEG
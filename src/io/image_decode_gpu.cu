@@ -0,0 +1,122 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file image_decode_gpu.cu
+ * \brief resampling and normalization of decoded images on the GPU
+ */
+
+#include "./image_decode_gpu.h"
+
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+
+#include <type_traits>
+#include "../common/cuda/utils.h"
+
+namespace mxnet {
+namespace io {
+
+namespace {
+
+constexpr int kCropThreads = 256;
+
+/*!
+ * \brief one output pixel per thread, over all channels, and one image per blockIdx.y
+ */
+template <typename DType>
+__global__ void CropResizeNormalizeKernel(const GPUImageCrop* crops,
+                                          const GPUImageMean mean,
+                                          const int channels,
+                                          const int height,
+                                          const int width,
+                                          DType* out) {
+  const int pixel = blockIdx.x * blockDim.x + threadIdx.x;
+  if (pixel >= height * width) {
+    return;
+  }
+  const GPUImageCrop& crop = crops[blockIdx.y];
+  const int i              = pixel / width;
+  const int j              = pixel % width;
+  // mirror as in iter_normalize.h, by the column written to
+  const int out_j = crop.mirror ? width - j - 1 : j;
+  // bilinear sampling at pixel centers, clamped to the decoded image
+  const float uy = crop.y + (i + 0.5f) * crop.scale_y - 0.5f;
+  const float ux = crop.x + (j + 0.5f) * crop.scale_x - 0.5f;
+  const bool outside = crop.fill && (uy < -0.5f || uy > crop.src_height - 0.5f || ux < -0.5f ||
+                                     ux > crop.src_width - 0.5f);
+  const float sy = fminf(fmaxf(uy, 0.f), static_cast<float>(crop.src_height - 1));
+  const float sx = fminf(fmaxf(ux, 0.f), static_cast<float>(crop.src_width - 1));
+  const int y0   = static_cast<int>(sy);
+  const int x0   = static_cast<int>(sx);
+  const int y1   = min(y0 + 1, crop.src_height - 1);
+  const int x1   = min(x0 + 1, crop.src_width - 1);
+  const float wy = sy - y0;
+  const float wx = sx - x0;
+  const size_t plane     = static_cast<size_t>(crop.src_width) * crop.src_height;
+  const size_t out_plane = static_cast<size_t>(height) * width;
+  DType* dst = out + blockIdx.y * channels * out_plane + static_cast<size_t>(i) * width + out_j;
+  for (int c = 0; c < channels; ++c) {
+    const uint8_t* src = crop.src + c * plane;
+    const float top = src[y0 * crop.src_width + x0] * (1 - wx) + src[y0 * crop.src_width + x1] * wx;
+    const float bottom =
+        src[y1 * crop.src_width + x0] * (1 - wx) + src[y1 * crop.src_width + x1] * wx;
+    const float value = outside ? crop.fill_value : top * (1 - wy) + bottom * wy;
+    const float m =
+        mean.mean_img != nullptr ? mean.mean_img[c * out_plane + i * width + j] : mean.mean[c];
+    if (std::is_same<DType, uint8_t>::value) {
+      dst[c * out_plane] = static_cast<DType>(fminf(value + 0.5f, 255.f));
+    } else if (std::is_same<DType, int8_t>::value) {
+      dst[c * out_plane] = static_cast<DType>(fminf(fmaxf(rintf(value) - rintf(m), -128.f), 127.f));
+    } else {
+      dst[c * out_plane] = static_cast<DType>((value - m) * crop.mult[c] + crop.bias[c]);
+    }
+  }
+}
+
+}  // namespace
+
+template <typename DType>
+void CropResizeNormalize(cudaStream_t stream,
+                         const GPUImageCrop* crops,
+                         int num_images,
+                         const GPUImageMean& mean,
+                         int channels,
+                         int height,
+                         int width,
+                         DType* out) {
+  if (num_images == 0) {
+    return;
+  }
+  const dim3 blocks((height * width + kCropThreads - 1) / kCropThreads, num_images);
+  CropResizeNormalizeKernel<<<blocks, kCropThreads, 0, stream>>>(
+      crops, mean, channels, height, width, out);
+  CUDA_CALL(cudaGetLastError());
+}
+
+template void CropResizeNormalize<float>(
+    cudaStream_t, const GPUImageCrop*, int, const GPUImageMean&, int, int, int, float*);
+template void CropResizeNormalize<uint8_t>(
+    cudaStream_t, const GPUImageCrop*, int, const GPUImageMean&, int, int, int, uint8_t*);
+template void CropResizeNormalize<int8_t>(
+    cudaStream_t, const GPUImageCrop*, int, const GPUImageMean&, int, int, int, int8_t*);
+
+}  // namespace io
+}  // namespace mxnet
+
+#endif  // MXNET_USE_CUDA && MXNET_USE_NVJPEG
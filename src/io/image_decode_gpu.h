@@ -0,0 +1,167 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file image_decode_gpu.h
+ * \brief batched decoding of images with nvJPEG, resized, cropped and normalized on the GPU
+ */
+#ifndef MXNET_IO_IMAGE_DECODE_GPU_H_
+#define MXNET_IO_IMAGE_DECODE_GPU_H_
+
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+
+#include <cuda_runtime.h>
+#include <nvjpeg.h>
+#include <mxnet/storage.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Protected nvJPEG call.
+ * \param func Expression to call.
+ *
+ * It checks for nvJPEG errors after invocation of the expression.
+ */
+#define NVJPEG_CALL(func)                                        \
+  {                                                              \
+    nvjpegStatus_t e = (func);                                   \
+    CHECK_EQ(e, NVJPEG_STATUS_SUCCESS) << "nvJPEG: error " << e; \
+  }
+
+namespace mxnet {
+namespace io {
+
+/*!
+ * \brief where an output image is resampled from, with the normalization of iter_normalize.h
+ */
+struct GPUImageCrop {
+  /*! \brief planar channels of the decoded image on the device */
+  const uint8_t* src;
+  int src_width;
+  int src_height;
+  /*! \brief top left corner of the crop in the decoded image */
+  float x;
+  float y;
+  /*! \brief pixels of the decoded image per output pixel */
+  float scale_x;
+  float scale_y;
+  bool mirror;
+  /*!
+   * \brief whether the pixels outside the decoded image are fill_value, else they are
+   *  clamped to its borders
+   */
+  bool fill;
+  float fill_value;
+  /*! \brief contrast and illumination, divided by the std of each channel */
+  float mult[4];
+  float bias[4];
+};
+
+/*! \brief mean subtracted from the output images before GPUImageCrop::mult is applied */
+struct GPUImageMean {
+  float mean[4];
+  /*! \brief mean image of shape (channels, height, width) on the device, or nullptr */
+  const float* mean_img;
+};
+
+/*!
+ * \brief resample the images of a batch by bilinear interpolation and normalize them
+ * \param crops crop of each image, on the device
+ * \param out batch of shape (num_images, channels, height, width) on the device
+ */
+template <typename DType>
+void CropResizeNormalize(cudaStream_t stream,
+                         const GPUImageCrop* crops,
+                         int num_images,
+                         const GPUImageMean& mean,
+                         int channels,
+                         int height,
+                         int width,
+                         DType* out);
+
+/*!
+ * \brief decodes batches of images on a GPU into batches of the data shape
+ *
+ * The JPEG images of a batch are decoded together by nvJPEG. Other images, and
+ * JPEG images nvJPEG cannot parse, are decoded by OpenCV on the CPU and copied to
+ * the device. All images are then resampled into the output batch by one kernel.
+ * Not thread safe.
+ */
+class GPUImageDecoder {
+ public:
+  /*!
+   * \brief function choosing the crop of image i from its decoded width and height,
+   *  without GPUImageCrop::src which is set by the decoder
+   */
+  using CropFn = std::function<void(int i, int width, int height, GPUImageCrop* crop)>;
+
+  /*!
+   * \param dev_id the GPU decoding the images and holding the batches
+   * \param channels channels of the output images, 1 or 3
+   */
+  GPUImageDecoder(int dev_id, int channels, int height, int width);
+  ~GPUImageDecoder();
+
+  /*!
+   * \brief copy the mean image of shape (channels, height, width) to the device
+   */
+  void SetMeanImage(const float* mean_img);
+
+  /*!
+   * \brief decode images into the first images.size() images of a batch
+   * \param images encoded images
+   * \param crop chooses the crop of each image
+   * \param mean mean of the channels, the mean image set by SetMeanImage is used instead if any
+   * \param out batch on the device, written when the call returns
+   */
+  template <typename DType>
+  void Decode(const std::vector<std::string>& images,
+              const CropFn& crop,
+              const float* mean,
+              DType* out);
+
+ private:
+  /*! \brief grow a buffer to at least size bytes, dropping its content */
+  void Reserve(Storage::Handle* buf, size_t size, Context ctx);
+
+  int dev_id_;
+  int channels_;
+  int height_;
+  int width_;
+  nvjpegHandle_t handle_;
+  nvjpegJpegState_t state_;
+  /*! \brief batch size nvJPEG was initialized for */
+  int batched_size_ = 0;
+  cudaStream_t stream_;
+  /*! \brief decoded images on the device */
+  Storage::Handle decoded_;
+  /*! \brief images decoded on the CPU, before the copy to decoded_ */
+  Storage::Handle staging_;
+  /*! \brief crops of a batch on the device */
+  Storage::Handle crops_;
+  Storage::Handle mean_img_;
+};
+
+}  // namespace io
+}  // namespace mxnet
+
+#endif  // MXNET_USE_CUDA && MXNET_USE_NVJPEG
+#endif  // MXNET_IO_IMAGE_DECODE_GPU_H_
@@ -448,36 +448,41 @@ class DefaultImageDetAugmenter : public ImageAugmenter {
   DefaultImageDetAugmenter() = default;
 
   void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) override {
-    std::vector<std::pair<std::string, std::string> > kwargs_left;
-    kwargs_left = param_.InitAllowUnknown(kwargs);
+    InitParam(kwargs, &param_);
+  }
+
+  /*! rief initialize and validate the parameters */
+  static void InitParam(const std::vector<std::pair<std::string, std::string> >& kwargs,
+                        DefaultImageDetAugmentParam* param) {
+    param->InitAllowUnknown(kwargs);
 
-    CHECK((param_.inter_method >= 0 && param_.inter_method <= 4) ||
-          (param_.inter_method >= 9 && param_.inter_method <= 10))
+    CHECK((param->inter_method >= 0 && param->inter_method <= 4) ||
+          (param->inter_method >= 9 && param->inter_method <= 10))
         << "invalid inter_method: valid value 0,1,2,3,9,10";
 
     // validate crop parameters
-    ValidateCropParameters(&param_.min_crop_scales, param_.num_crop_sampler);
-    ValidateCropParameters(&param_.max_crop_scales, param_.num_crop_sampler);
-    ValidateCropParameters(&param_.min_crop_aspect_ratios, param_.num_crop_sampler);
-    ValidateCropParameters(&param_.max_crop_aspect_ratios, param_.num_crop_sampler);
-    ValidateCropParameters(&param_.min_crop_overlaps, param_.num_crop_sampler);
-    ValidateCropParameters(&param_.max_crop_overlaps, param_.num_crop_sampler);
-    ValidateCropParameters(&param_.min_crop_sample_coverages, param_.num_crop_sampler);
-    ValidateCropParameters(&param_.max_crop_sample_coverages, param_.num_crop_sampler);
-    ValidateCropParameters(&param_.min_crop_object_coverages, param_.num_crop_sampler);
-    ValidateCropParameters(&param_.max_crop_object_coverages, param_.num_crop_sampler);
-    ValidateCropParameters(&param_.max_crop_trials, param_.num_crop_sampler);
-    for (int i = 0; i < param_.num_crop_sampler; ++i) {
-      CHECK_GE(param_.min_crop_scales[i], 0.0f);
-      CHECK_LE(param_.max_crop_scales[i], 1.0f);
-      CHECK_GT(param_.max_crop_scales[i], param_.min_crop_scales[i]);
-      CHECK_GE(param_.min_crop_aspect_ratios[i], 0.0f);
-      CHECK_GE(param_.max_crop_aspect_ratios[i], param_.min_crop_aspect_ratios[i]);
-      CHECK_GE(param_.max_crop_overlaps[i], param_.min_crop_overlaps[i]);
-      CHECK_GE(param_.max_crop_sample_coverages[i], param_.min_crop_sample_coverages[i]);
-      CHECK_GE(param_.max_crop_object_coverages[i], param_.min_crop_object_coverages[i]);
+    ValidateCropParameters(&param->min_crop_scales, param->num_crop_sampler);
+    ValidateCropParameters(&param->max_crop_scales, param->num_crop_sampler);
+    ValidateCropParameters(&param->min_crop_aspect_ratios, param->num_crop_sampler);
+    ValidateCropParameters(&param->max_crop_aspect_ratios, param->num_crop_sampler);
+    ValidateCropParameters(&param->min_crop_overlaps, param->num_crop_sampler);
+    ValidateCropParameters(&param->max_crop_overlaps, param->num_crop_sampler);
+    ValidateCropParameters(&param->min_crop_sample_coverages, param->num_crop_sampler);
+    ValidateCropParameters(&param->max_crop_sample_coverages, param->num_crop_sampler);
+    ValidateCropParameters(&param->min_crop_object_coverages, param->num_crop_sampler);
+    ValidateCropParameters(&param->max_crop_object_coverages, param->num_crop_sampler);
+    ValidateCropParameters(&param->max_crop_trials, param->num_crop_sampler);
+    for (int i = 0; i < param->num_crop_sampler; ++i) {
+      CHECK_GE(param->min_crop_scales[i], 0.0f);
+      CHECK_LE(param->max_crop_scales[i], 1.0f);
+      CHECK_GT(param->max_crop_scales[i], param->min_crop_scales[i]);
+      CHECK_GE(param->min_crop_aspect_ratios[i], 0.0f);
+      CHECK_GE(param->max_crop_aspect_ratios[i], param->min_crop_aspect_ratios[i]);
+      CHECK_GE(param->max_crop_overlaps[i], param->min_crop_overlaps[i]);
+      CHECK_GE(param->max_crop_sample_coverages[i], param->min_crop_sample_coverages[i]);
+      CHECK_GE(param->max_crop_object_coverages[i], param->min_crop_object_coverages[i]);
     }
-    CHECK_GE(param_.emit_overlap_thresh, 0.0f);
+    CHECK_GE(param->emit_overlap_thresh, 0.0f);
   }
   /*!
    * \brief get interpolation method with given inter_method, 0-CV_INTER_NN 1-CV_INTER_LINEAR
@@ -508,7 +513,7 @@ class DefaultImageDetAugmenter : public ImageAugmenter {
 
   /*! \brief Check number of crop samplers and given parameters */
   template <typename DType>
-  void ValidateCropParameters(mxnet::Tuple<DType>* param, const int num_sampler) {
+  static void ValidateCropParameters(mxnet::Tuple<DType>* param, const int num_sampler) {
     if (num_sampler == 1) {
       CHECK_EQ(param->ndim(), 1);
     } else if (num_sampler > 1) {
@@ -522,12 +527,12 @@ class DefaultImageDetAugmenter : public ImageAugmenter {
   }
 
   /*! \brief Generate crop box region given cropping parameters */
-  Rect GenerateCropBox(const float min_crop_scale,
-                       const float max_crop_scale,
-                       const float min_crop_aspect_ratio,
-                       const float max_crop_aspect_ratio,
-                       common::RANDOM_ENGINE* prnd,
-                       const float img_aspect_ratio) {
+  static Rect GenerateCropBox(const float min_crop_scale,
+                              const float max_crop_scale,
+                              const float min_crop_aspect_ratio,
+                              const float max_crop_aspect_ratio,
+                              common::RANDOM_ENGINE* prnd,
+                              const float img_aspect_ratio) {
     float new_scale =
         std::uniform_real_distribution<float>(min_crop_scale, max_crop_scale)(*prnd) + 1e-12f;
     float min_ratio =
@@ -543,9 +548,9 @@ class DefaultImageDetAugmenter : public ImageAugmenter {
   }
 
   /*! \brief Generate padding box region given padding parameters */
-  Rect GeneratePadBox(const float max_pad_scale,
-                      common::RANDOM_ENGINE* prnd,
-                      const float threshold = 1.05f) {
+  static Rect GeneratePadBox(const float max_pad_scale,
+                             common::RANDOM_ENGINE* prnd,
+                             const float threshold = 1.05f) {
     float new_scale = std::uniform_real_distribution<float>(1.f, max_pad_scale)(*prnd);
     if (new_scale < threshold)
       return Rect(0, 0, 0, 0);
@@ -555,6 +560,45 @@ class DefaultImageDetAugmenter : public ImageAugmenter {
     return Rect(-x0, -y0, new_scale, new_scale);
   }
 
+  /*!
+   * \brief random crop sampling logic: randomly pick a sampler, return if success
+   *  continue to next sampler if failed(exceed max_trial)
+   *  return false, keeping the original sample, if every sampler has failed
+   */
+  static bool SampleCropBox(const DefaultImageDetAugmentParam& param,
+                            const float img_aspect_ratio,
+                            ImageDetLabel* det_label,
+                            common::RANDOM_ENGINE* prnd,
+                            Rect* crop_box) {
+    std::vector<int> indices(param.num_crop_sampler);
+    for (int i = 0; i < param.num_crop_sampler; ++i) {
+      indices[i] = i;
+    }
+    std::shuffle(indices.begin(), indices.end(), *prnd);
+    for (auto idx : indices) {
+      for (int t = 0; t < param.max_crop_trials[idx]; ++t) {
+        *crop_box = GenerateCropBox(param.min_crop_scales[idx],
+                                    param.max_crop_scales[idx],
+                                    param.min_crop_aspect_ratios[idx],
+                                    param.max_crop_aspect_ratios[idx],
+                                    prnd,
+                                    img_aspect_ratio);
+        if (det_label->TryCrop(*crop_box,
+                               param.min_crop_overlaps[idx],
+                               param.max_crop_overlaps[idx],
+                               param.min_crop_sample_coverages[idx],
+                               param.max_crop_sample_coverages[idx],
+                               param.min_crop_object_coverages[idx],
+                               param.max_crop_object_coverages[idx],
+                               param.crop_emit_mode,
+                               param.emit_overlap_thresh)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
   cv::Mat Process(const cv::Mat& src,
                   std::vector<float>* label,
                   common::RANDOM_ENGINE* prnd) override {
@@ -651,46 +695,16 @@ class DefaultImageDetAugmenter : public ImageAugmenter {
 
     // random crop logic
     if (param_.rand_crop_prob > 0 && param_.num_crop_sampler > 0) {
-      if (rand_uniform(*prnd) < param_.rand_crop_prob) {
-        // random crop sampling logic: randomly pick a sampler, return if success
-        // continue to next sampler if failed(exceed max_trial)
-        // return original sample if every sampler has failed
-        std::vector<int> indices(param_.num_crop_sampler);
-        for (int i = 0; i < param_.num_crop_sampler; ++i) {
-          indices[i] = i;
-        }
-        std::shuffle(indices.begin(), indices.end(), *prnd);
-        int num_processed = 0;
-        for (auto idx : indices) {
-          if (num_processed > 0)
-            break;
-          for (int t = 0; t < param_.max_crop_trials[idx]; ++t) {
-            Rect crop_box = GenerateCropBox(param_.min_crop_scales[idx],
-                                            param_.max_crop_scales[idx],
-                                            param_.min_crop_aspect_ratios[idx],
-                                            param_.max_crop_aspect_ratios[idx],
-                                            prnd,
-                                            static_cast<float>(res.cols) / res.rows);
-            if (det_label.TryCrop(crop_box,
-                                  param_.min_crop_overlaps[idx],
-                                  param_.max_crop_overlaps[idx],
-                                  param_.min_crop_sample_coverages[idx],
-                                  param_.max_crop_sample_coverages[idx],
-                                  param_.min_crop_object_coverages[idx],
-                                  param_.max_crop_object_coverages[idx],
-                                  param_.crop_emit_mode,
-                                  param_.emit_overlap_thresh)) {
-              ++num_processed;
-              // crop image
-              int left   = static_cast<int>(crop_box.x * res.cols);
-              int top    = static_cast<int>(crop_box.y * res.rows);
-              int width  = static_cast<int>(crop_box.width * res.cols);
-              int height = static_cast<int>(crop_box.height * res.rows);
-              res        = res(cv::Rect(left, top, width, height));
-              break;
-            }
-          }
-        }
+      Rect crop_box;
+      if (rand_uniform(*prnd) < param_.rand_crop_prob &&
+          SampleCropBox(
+              param_, static_cast<float>(res.cols) / res.rows, &det_label, prnd, &crop_box)) {
+        // crop image
+        int left   = static_cast<int>(crop_box.x * res.cols);
+        int top    = static_cast<int>(crop_box.y * res.rows);
+        int width  = static_cast<int>(crop_box.width * res.cols);
+        int height = static_cast<int>(crop_box.height * res.rows);
+        res        = res(cv::Rect(left, top, width, height));
       }
     }
 
@@ -735,6 +749,84 @@ class DefaultImageDetAugmenter : public ImageAugmenter {
   DefaultImageDetAugmentParam param_;
 };
 
+ImageDetCropSampler::ImageDetCropSampler(
+    const std::vector<std::pair<std::string, std::string> >& kwargs)
+    : param_(new DefaultImageDetAugmentParam()) {
+  DefaultImageDetAugmenter::InitParam(kwargs, param_.get());
+  CHECK(param_->random_hue_prob <= 0.f && param_->random_saturation_prob <= 0.f &&
+        param_->random_illumination_prob <= 0.f)
+      << "Hue, saturation and illumination augmentations are not supported "
+         "when decoding on the device";
+  CHECK(param_->random_contrast_prob <= 0.f || param_->max_random_contrast < 1.f)
+      << "max_random_contrast must be smaller than 1 when decoding on the device";
+  CHECK_EQ(param_->resize_mode, image_det_aug_default_enum::kForce)
+      << "Only resize_mode=force is supported when decoding on the device";
+}
+
+ImageDetCropSampler::~ImageDetCropSampler() = default;
+
+int ImageDetCropSampler::fill_value() const {
+  return param_->fill_value;
+}
+
+ImageDetCrop ImageDetCropSampler::Sample(int width,
+                                         int height,
+                                         std::vector<float>* label,
+                                         common::RANDOM_ENGINE* prnd) const {
+  const DefaultImageDetAugmentParam& param = *param_;
+  // draws from prnd in the order of DefaultImageDetAugmenter::Process, tracking the
+  // region of the mirrored source image the output is resampled from, relative to its size
+  ImageDetLabel det_label(*label);
+  std::uniform_real_distribution<float> rand_uniform(0, 1);
+  ImageDetCrop out{{0.f, 0.f, 1.f, 1.f}, false, false, 1.f};
+  if (param.random_contrast_prob > 0.f) {
+    std::uniform_real_distribution<float> uniform_range(-1.f, 1.f);
+    for (int i = 0; i < 3; ++i) {
+      uniform_range(*prnd);
+    }
+    float c = uniform_range(*prnd) * param.max_random_contrast;
+    for (int i = 0; i < 3; ++i) {
+      rand_uniform(*prnd);
+    }
+    c = rand_uniform(*prnd) < param.random_contrast_prob ? c : 0;
+    if (std::fabs(c) > 1e-3) {
+      out.contrast = c + 1.f;
+    }
+  }
+  if (param.rand_mirror_prob > 0 && rand_uniform(*prnd) < param.rand_mirror_prob) {
+    out.mirror = det_label.TryMirror();
+  }
+  Rect region(0.f, 0.f, 1.f, 1.f);
+  if (param.rand_pad_prob > 0 && param.max_pad_scale > 1.f) {
+    if (rand_uniform(*prnd) < param.rand_pad_prob) {
+      Rect pad_box = DefaultImageDetAugmenter::GeneratePadBox(param.max_pad_scale, prnd);
+      if (pad_box.area() > 0 && det_label.TryPad(pad_box)) {
+        region  = pad_box;
+        out.pad = true;
+      }
+    }
+  }
+  if (param.rand_crop_prob > 0 && param.num_crop_sampler > 0) {
+    Rect crop_box;
+    if (rand_uniform(*prnd) < param.rand_crop_prob &&
+        DefaultImageDetAugmenter::SampleCropBox(
+            param, static_cast<float>(width) / height, &det_label, prnd, &crop_box)) {
+      region = Rect(region.x + crop_box.x * region.width,
+                    region.y + crop_box.y * region.height,
+                    crop_box.width * region.width,
+                    crop_box.height * region.height);
+    }
+  }
+  // the output is mirrored after resampling, so the region is mirrored back
+  if (out.mirror) {
+    region.x = 1.f - region.x - region.width;
+  }
+  out.box = ImageCropBox{
+      region.x * width, region.y * height, region.width * width, region.height * height};
+  *label = det_label.ToArray();
+  return out;
+}
+
 MXNET_REGISTER_IMAGE_AUGMENTER(det_aug_default)
     .describe("default detection augmenter")
     .set_body([]() { return new DefaultImageDetAugmenter(); });
@@ -104,6 +104,7 @@ class ImageLabelMap {
 
 // Define image record parser parameters
 struct ImageRecParserParam : public dmlc::Parameter<ImageRecParserParam> {
+  enum DecodeDevice { kDecodeCPU = 0, kDecodeGPU };
   /*! \brief path to image list */
   std::string path_imglist;
   /*! \brief path to image recordio */
@@ -130,8 +131,18 @@ struct ImageRecParserParam : public dmlc::Parameter<ImageRecParserParam> {
   size_t shuffle_chunk_size;
   /*! \brief the seed for chunk shuffling */
   int shuffle_chunk_seed;
+  /*! \brief whether path_imgrec lists shards streamed whole */
+  bool read_shards;
+  /*! \brief number of records shuffled in a buffer when reading shards */
+  size_t shuffle_buffer;
+  /*! \brief number of shards read ahead */
+  int prefetch_shards;
+  /*! \brief number of concurrent range reads per shard */
+  int num_range_reads;
   /*! \brief random seed for augmentations */
   dmlc::optional<int> seed_aug;
+  /*! \brief device decoding and augmenting the images */
+  int decode_device;
 
   // declare parameters
   DMLC_DECLARE_PARAMETER(ImageRecParserParam) {
@@ -184,9 +195,38 @@ struct ImageRecParserParam : public dmlc::Parameter<ImageRecParserParam> {
         .set_default(0)
         .describe("The data shuffle buffer size in MB. Only valid if shuffle is true.");
     DMLC_DECLARE_FIELD(shuffle_chunk_seed).set_default(0).describe("The random seed for shuffling");
+    DMLC_DECLARE_FIELD(read_shards)
+        .set_default(false)
+        .describe(
+            "Read path_imgrec as a ';' separated list of RecordIO shards, or of directories "
+            "holding .rec shards, for instance on S3. The shards are split across the parts "
+            "shard by shard and read whole in the background, so that reading does not seek. "
+            "With shuffle, the shards are shuffled every epoch and the records within "
+            "shuffle_buffer. Only used by ImageRecordIter, and path_imgidx is ignored.");
+    DMLC_DECLARE_FIELD(shuffle_buffer)
+        .set_default(8192)
+        .describe("The number of records shuffled in a buffer with read_shards and shuffle.");
+    DMLC_DECLARE_FIELD(prefetch_shards)
+        .set_default(2)
+        .describe("The number of shards read ahead with read_shards.");
+    DMLC_DECLARE_FIELD(num_range_reads)
+        .set_default(4)
+        .describe("The number of concurrent range reads of a shard with read_shards.");
     DMLC_DECLARE_FIELD(seed_aug)
         .set_default(dmlc::optional<int>())
-        .describe("Random seed for augmentations.");
+        .describe(
+            "Random seed for augmentations. If set, the augmentations of a record depend on "
+            "the seed, the epoch and its index only, whatever the number of threads.");
+    DMLC_DECLARE_FIELD(decode_device)
+        .set_default(kDecodeCPU)
+        .add_enum("cpu", kDecodeCPU)
+        .add_enum("gpu", kDecodeGPU)
+        .describe(
+            "The device decoding and augmenting the images, only used by ImageRecordIter. "
+            "With gpu, the images are decoded by nvJPEG, resized, cropped, mirrored and "
+            "normalized on GPU device_id, and the data of the batches is on that GPU. "
+            "Only resize and the crop options of the default augmenter are supported. "
+            "Requires MXNet built with USE_NVJPEG.");
   }
 };
 
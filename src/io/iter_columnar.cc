@@ -0,0 +1,194 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file iter_columnar.cc
+ * \brief define a iterator over the batches of a columnar dataset, mapped into memory
+ */
+#include <mxnet/io.h>
+#include <dmlc/base.h>
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include "./columnar.h"
+#include "./image_iter_common.h"
+
+namespace mxnet {
+namespace io {
+// Columnar parameters
+struct ColumnarIterParam : public dmlc::Parameter<ColumnarIterParam> {
+  /*! \brief directory of the dataset */
+  std::string path;
+  /*! \brief column of the data */
+  std::string data_column;
+  /*! \brief column of the label */
+  std::string label_column;
+  /*! \brief whether to shuffle the batches */
+  bool shuffle;
+  /*! \brief seed of the shuffle */
+  int seed;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(ColumnarIterParam) {
+    DMLC_DECLARE_FIELD(path).describe("The directory of the npy files of the columns.");
+    DMLC_DECLARE_FIELD(data_column).describe("The column of the data.");
+    DMLC_DECLARE_FIELD(label_column)
+        .set_default("NULL")
+        .describe("The column of the label. If NULL, all labels will be returned as 0.");
+    DMLC_DECLARE_FIELD(shuffle).set_default(false).describe(
+        "Whether to shuffle the order of the batches every epoch. "
+        "The rows of a batch are consecutive rows of the dataset.");
+    DMLC_DECLARE_FIELD(seed).set_default(0).describe("The random seed of the shuffle.");
+  }
+};
+
+class ColumnarIter : public IIterator<DataBatch> {
+ public:
+  ColumnarIter()           = default;
+  ~ColumnarIter() override = default;
+
+  // intialize iterator loads data in
+  void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) override {
+    param_.InitAllowUnknown(kwargs);
+    batch_param_.InitAllowUnknown(kwargs);
+    std::vector<std::string> columns{param_.data_column};
+    if (param_.label_column != "NULL") {
+      columns.push_back(param_.label_column);
+    }
+    table_                  = std::make_unique<ColumnarTable>(param_.path, columns, false);
+    const size_t batch_size = batch_param_.batch_size;
+    CHECK_GT(batch_size, 0U) << "batch_size must be positive";
+    if (batch_param_.round_batch) {
+      CHECK_GE(table_->num_rows(), batch_size) << "number of input must be bigger than batch size";
+    }
+    order_.resize((table_->num_rows() + batch_size - 1) / batch_size);
+    std::iota(order_.begin(), order_.end(), 0);
+    rnd_.seed(param_.seed);
+    if (param_.label_column == "NULL") {
+      dummy_label_ = NDArray(mshadow::Shape1(batch_size), Context::CPU(), false, mshadow::kFloat32);
+      std::fill_n(dummy_label_.data().dptr<float>(), batch_size, 0.f);
+    }
+    BeforeFirst();
+  }
+
+  void BeforeFirst() override {
+    cursor_ = 0;
+    if (param_.shuffle) {
+      std::shuffle(order_.begin(), order_.end(), rnd_);
+    }
+    if (!order_.empty()) {
+      WillNeed(order_[0]);
+    }
+  }
+
+  int64_t GetLenHint() const override {
+    return order_.size();
+  }
+
+  bool Next() override {
+    if (cursor_ == order_.size()) {
+      return false;
+    }
+    const size_t batch_size = batch_param_.batch_size;
+    const size_t begin      = order_[cursor_++] * batch_size;
+    const size_t end        = std::min(begin + batch_size, table_->num_rows());
+    std::vector<ColumnarTable::RowRange> ranges{{begin, end}};
+    out_.num_batch_padd = batch_size - (end - begin);
+    if (out_.num_batch_padd != 0 && batch_param_.round_batch) {
+      // fill the last batch with the first rows
+      ranges.emplace_back(0, out_.num_batch_padd);
+    }
+    out_.data.clear();
+    for (size_t i = 0; i < table_->num_columns(); ++i) {
+      out_.data.push_back(table_->Rows(i, ranges, batch_size));
+    }
+    if (param_.label_column == "NULL") {
+      out_.data.push_back(dummy_label_);
+    }
+    out_.index.clear();
+    for (const auto& range : ranges) {
+      for (size_t row = range.first; row < range.second; ++row) {
+        out_.index.push_back(row);
+      }
+    }
+    out_.index.resize(batch_size, 0);
+    // the kernel reads the next batch while this one is used
+    if (cursor_ < order_.size()) {
+      WillNeed(order_[cursor_]);
+    }
+    return true;
+  }
+
+  const DataBatch& Value() const override {
+    return out_;
+  }
+
+ private:
+  void WillNeed(size_t batch) const {
+    table_->WillNeed(batch * batch_param_.batch_size, (batch + 1) * batch_param_.batch_size);
+  }
+
+  ColumnarIterParam param_;
+  BatchParam batch_param_;
+  std::unique_ptr<ColumnarTable> table_;
+  /*! \brief the batches of the epoch, in order */
+  std::vector<size_t> order_;
+  size_t cursor_ = 0;
+  std::mt19937 rnd_;
+  NDArray dummy_label_;
+  DataBatch out_;
+};
+
+DMLC_REGISTER_PARAMETER(ColumnarIterParam);
+
+MXNET_REGISTER_IO_ITER(ColumnarIter)
+    .describe(R"code(Returns the iterator over a columnar dataset.
+
+A columnar dataset is a directory of npy files, which ``mx.io.save_columnar`` writes:
+
+- a dense column ``name`` is ``name.npy``, of any fixed-width dtype and of shape
+  ``(num_rows, ...)``;
+- a CSR column ``name`` is ``name.data.npy``, ``name.indices.npy``, ``name.indptr.npy``
+  and ``name.shape.npy``, the arrays of a ``scipy.sparse.csr_matrix``.
+
+The files are mapped into memory and nothing is parsed. A batch of a dense column points into
+the mapping, a batch of a CSR column is a `csr` NDArray copied from it. The rows of a batch are
+consecutive rows of the dataset, `shuffle` shuffles the order of the batches.
+
+Examples::
+
+  >>> mx.io.save_columnar('data', {'x': np.random.uniform(size=(1000, 8)),
+  ...                              'y': np.arange(1000)})
+  >>> data_iter = mx.io.ColumnarIter(path='data', data_column='x', label_column='y',
+  ...                                batch_size=100, shuffle=True)
+  >>> batch = data_iter.next()
+  >>> batch.data[0].shape, batch.label[0].shape
+  ((100, 8), (100,))
+
+)code" ADD_FILELINE)
+    .add_arguments(ColumnarIterParam::__FIELDS__())
+    .add_arguments(BatchParam::__FIELDS__())
+    .set_body([]() { return new ColumnarIter(); });
+
+}  // namespace io
+}  // namespace mxnet
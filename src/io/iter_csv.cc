@@ -28,6 +28,7 @@
 #include <dmlc/data.h>
 #include "./iter_prefetcher.h"
 #include "./iter_batchloader.h"
+#include "./text_block_parser.h"
 
 namespace mxnet {
 namespace io {
@@ -41,6 +42,8 @@ struct CSVIterParam : public dmlc::Parameter<CSVIterParam> {
   std::string label_csv;
   /*! \brief label shape */
   mxnet::TShape label_shape;
+  /*! \brief number of threads parsing a chunk of the files */
+  int preprocess_threads;
   // declare parameters
   DMLC_DECLARE_PARAMETER(CSVIterParam) {
     DMLC_DECLARE_FIELD(data_csv).describe("The input CSV file or a directory path.");
@@ -52,6 +55,10 @@ struct CSVIterParam : public dmlc::Parameter<CSVIterParam> {
     DMLC_DECLARE_FIELD(label_shape)
         .set_default(mxnet::TShape(shape1, shape1 + 1))
         .describe("The shape of one label.");
+    DMLC_DECLARE_FIELD(preprocess_threads)
+        .set_lower_bound(1)
+        .set_default(4)
+        .describe("The number of threads parsing each chunk of the files.");
   }
 };
 
@@ -82,10 +89,6 @@ class CSVIterBase : public IIterator<DataInst> {
   unsigned inst_counter_{0};
   // at end
   bool end_{false};
-
-  // label parser
-  size_t label_ptr_{0}, label_size_{0};
-  size_t data_ptr_{0}, data_size_{0};
 };
 
 template <typename DType>
@@ -95,10 +98,13 @@ class CSVIterTyped : public CSVIterBase {
   // intialize iterator loads data in
   void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) override {
     param_.InitAllowUnknown(kwargs);
-    data_parser_.reset(dmlc::Parser<uint32_t, DType>::Create(param_.data_csv.c_str(), 0, 1, "csv"));
+    data_parser_ = std::make_unique<TextBlockParser<DType> >(
+        param_.data_csv, 0, 1, TextFormat::kCSV, param_.preprocess_threads);
+    data_reader_ = std::make_unique<TextRowReader<DType> >(data_parser_.get());
     if (param_.label_csv != "NULL") {
-      label_parser_.reset(
-          dmlc::Parser<uint32_t, DType>::Create(param_.label_csv.c_str(), 0, 1, "csv"));
+      label_parser_ = std::make_unique<TextBlockParser<DType> >(
+          param_.label_csv, 0, 1, TextFormat::kCSV, param_.preprocess_threads);
+      label_reader_ = std::make_unique<TextRowReader<DType> >(label_parser_.get());
     } else {
       dummy_label.set_pad(false);
       dummy_label.Resize(mshadow::Shape1(1));
@@ -107,40 +113,32 @@ class CSVIterTyped : public CSVIterBase {
   }
 
   void BeforeFirst() override {
-    data_parser_->BeforeFirst();
-    if (label_parser_.get() != nullptr) {
-      label_parser_->BeforeFirst();
+    data_reader_->BeforeFirst();
+    if (label_reader_.get() != nullptr) {
+      label_reader_->BeforeFirst();
     }
-    data_ptr_ = label_ptr_ = 0;
-    data_size_ = label_size_ = 0;
-    inst_counter_            = 0;
-    end_                     = false;
+    inst_counter_ = 0;
+    end_          = false;
   }
 
   bool Next() override {
     if (end_)
       return false;
-    while (data_ptr_ >= data_size_) {
-      if (!data_parser_->Next()) {
-        end_ = true;
-        return false;
-      }
-      data_ptr_  = 0;
-      data_size_ = data_parser_->Value().size;
+    // the row returned before is in the chunk read from, the chunks before can go
+    data_reader_->Release();
+    spans_.clear();
+    if (data_reader_->Take(1, &spans_) == 0) {
+      end_ = true;
+      return false;
     }
-    out_.index = inst_counter_++;
-    CHECK_LT(data_ptr_, data_size_);
-    out_.data[0] = AsTBlob(data_parser_->Value()[data_ptr_++], param_.data_shape);
-
-    if (label_parser_.get() != nullptr) {
-      while (label_ptr_ >= label_size_) {
-        CHECK(label_parser_->Next())
-            << "Data CSV's row is smaller than the number of rows in label_csv";
-        label_ptr_  = 0;
-        label_size_ = label_parser_->Value().size;
-      }
-      CHECK_LT(label_ptr_, label_size_);
-      out_.data[1] = AsTBlob(label_parser_->Value()[label_ptr_++], param_.label_shape);
+    out_.index   = inst_counter_++;
+    out_.data[0] = AsTBlob(spans_.back(), param_.data_shape);
+
+    if (label_reader_.get() != nullptr) {
+      label_reader_->Release();
+      CHECK_EQ(label_reader_->Take(1, &spans_), 1U)
+          << "Data CSV's row is smaller than the number of rows in label_csv";
+      out_.data[1] = AsTBlob(spans_.back(), param_.label_shape);
     } else {
       out_.data[1] = dummy_label;
     }
@@ -148,17 +146,24 @@ class CSVIterTyped : public CSVIterBase {
   }
 
  private:
-  inline TBlob AsTBlob(const dmlc::Row<uint32_t, DType>& row, const mxnet::TShape& shape) {
-    CHECK_EQ(row.length, shape.Size())
-        << "The data size in CSV do not match size of shape: "
-        << "specified shape=" << shape << ", the csv row-length=" << row.length;
-    const DType* ptr = row.value;
+  inline TBlob AsTBlob(const typename TextRowReader<DType>::Span& span,
+                       const mxnet::TShape& shape) {
+    const size_t begin  = span.block->offset[span.begin];
+    const size_t length = span.block->offset[span.begin + 1] - begin;
+    CHECK_EQ(length, shape.Size()) << "The data size in CSV do not match size of shape: "
+                                   << "specified shape=" << shape
+                                   << ", the csv row-length=" << length;
+    const DType* ptr = span.block->value.data() + begin;
     return TBlob((DType*)ptr, shape, cpu::kDevMask, 0);  // NOLINT(*)
   }
   // dummy label
   mshadow::TensorContainer<cpu, 1, DType> dummy_label;
-  std::unique_ptr<dmlc::Parser<uint32_t, DType> > label_parser_;
-  std::unique_ptr<dmlc::Parser<uint32_t, DType> > data_parser_;
+  std::unique_ptr<TextBlockParser<DType> > label_parser_;
+  std::unique_ptr<TextBlockParser<DType> > data_parser_;
+  // readers of the rows of the parsers, destroyed before them
+  std::unique_ptr<TextRowReader<DType> > label_reader_;
+  std::unique_ptr<TextRowReader<DType> > data_reader_;
+  std::vector<typename TextRowReader<DType>::Span> spans_;
 };
 
 class CSVIter : public IIterator<DataInst> {
@@ -31,17 +31,22 @@
 #include <dmlc/parameter.h>
 #include <dmlc/recordio.h>
 #include <dmlc/threadediter.h>
+#include <deque>
 #include <memory>
+#include <queue>
+#include <string>
 #include <unordered_map>
 #include <vector>
 #include <cstdlib>
 #include "./inst_vector.h"
+#include "./sample_random.h"
 #include "./image_recordio.h"
 #include "./image_augmenter.h"
 #include "./image_iter_common.h"
 #include "./iter_prefetcher.h"
 #include "./iter_normalize.h"
 #include "./iter_batchloader.h"
+#include "./image_decode_gpu.h"
 
 namespace mxnet {
 namespace io {
@@ -175,6 +180,12 @@ struct ImageDetRecParserParam : public dmlc::Parameter<ImageDetRecParserParam> {
   int label_pad_width;
   /*! \brief labe padding value */
   float label_pad_value;
+  /*! \brief random seed for augmentations */
+  dmlc::optional<int> seed_aug;
+  /*! \brief whether to output the labels as values and offsets instead of padding them */
+  bool label_ragged;
+  /*! \brief device decoding and augmenting the images */
+  int decode_device;
 
   // declare parameters
   DMLC_DECLARE_PARAMETER(ImageDetRecParserParam) {
@@ -216,9 +227,148 @@ struct ImageDetRecParserParam : public dmlc::Parameter<ImageDetRecParserParam> {
     DMLC_DECLARE_FIELD(label_pad_value)
         .set_default(-1.f)
         .describe("label padding value if enabled");
+    DMLC_DECLARE_FIELD(seed_aug)
+        .set_default(dmlc::optional<int>())
+        .describe(
+            "Random seed for augmentations. If set, the augmentations of a record depend on "
+            "the seed, the epoch and its index only, whatever the number of threads.");
+    DMLC_DECLARE_FIELD(label_ragged)
+        .set_default(false)
+        .describe(
+            "Output the labels of a batch unpadded, as the concatenated labels after the "
+            "augmentations, and the batch_size + 1 offsets of the label of each image in them, "
+            "read with getitems(). label_pad_width and label_pad_value are then not used.");
+    DMLC_DECLARE_FIELD(decode_device)
+        .set_default(ImageRecParserParam::kDecodeCPU)
+        .add_enum("cpu", ImageRecParserParam::kDecodeCPU)
+        .add_enum("gpu", ImageRecParserParam::kDecodeGPU)
+        .describe(
+            "The device decoding and augmenting the images. With gpu, the images are decoded "
+            "by nvJPEG, mirrored, padded, cropped, resized and normalized on GPU device_id, "
+            "and the data of the batches is on that GPU. The labels are transformed on the "
+            "CPU. Only the mirror, pad, crop and contrast options of the default detection "
+            "augmenter are supported, with resize_mode force and bilinear interpolation. "
+            "Requires MXNet built with USE_NVJPEG.");
   }
 };
 
+/*! \brief load the label of a record from the image list, or from the record if there is none */
+inline std::vector<float> LoadDetLabel(const ImageDetRecParserParam& param,
+                                       const ImageDetLabelMap* label_map,
+                                       const ImageRecordIO& rec) {
+  std::vector<float> label_buf;
+  if (label_map != nullptr) {
+    label_buf = label_map->FindCopy(rec.image_index());
+  } else if (rec.label != nullptr) {
+    if (param.label_width > 0) {
+      CHECK_EQ(param.label_width, rec.num_label) << "rec file provide " << rec.num_label
+                                                 << "-dimensional label "
+                                                    "but label_width is set to "
+                                                 << param.label_width;
+    }
+    label_buf.assign(rec.label, rec.label + rec.num_label);
+  } else {
+    LOG(FATAL) << "Not enough label packed in img_list or rec file.";
+  }
+  return label_buf;
+}
+
+/*!
+ * \brief set label_pad_width to the maximum width of the labels if it is not larger,
+ *  reading all the records when there is no image list
+ */
+inline void EstimateLabelPadWidth(const ImageDetLabelMap* label_map,
+                                  ImageDetRecParserParam* param) {
+  int max_label_width = 0;
+  if (label_map != nullptr) {
+    max_label_width = label_map->MaxLabelWidth();
+  } else {
+    // iterate through recordio
+    std::unique_ptr<dmlc::InputSplit> source(dmlc::InputSplit::Create(
+        param->path_imgrec.c_str(), param->part_index, param->num_parts, "recordio"));
+    dmlc::OMPException omp_exc;
+    dmlc::InputSplit::Blob chunk;
+    while (source->NextChunk(&chunk)) {
+#pragma omp parallel num_threads(param->preprocess_threads)
+      {
+        omp_exc.Run([&] {
+          int max_width = 0;
+          int tid       = omp_get_thread_num();
+          dmlc::RecordIOChunkReader reader(chunk, tid, omp_get_num_threads());
+          ImageRecordIO rec;
+          dmlc::InputSplit::Blob blob;
+          while (reader.NextRecord(&blob)) {
+            rec.Load(blob.dptr, blob.size);
+            if (rec.label != nullptr) {
+              if (param->label_width > 0) {
+                CHECK_EQ(param->label_width, rec.num_label) << "rec file provide " << rec.num_label
+                                                            << "-dimensional label "
+                                                               "but label_width is set to "
+                                                            << param->label_width;
+              }
+              // update max value
+              max_width = std::max(max_width, rec.num_label);
+            } else {
+              LOG(FATAL) << "Not enough label packed in img_list or rec file.";
+            }
+          }
+#pragma omp critical
+          { max_label_width = std::max(max_label_width, max_width); }
+        });
+      }
+      omp_exc.Rethrow();
+    }
+  }
+  if (max_label_width > param->label_pad_width) {
+    if (param->label_pad_width > 0) {
+      LOG(FATAL) << "ImageDetRecordIOParser: label_pad_width: " << param->label_pad_width
+                 << " smaller than estimated width: " << max_label_width;
+    }
+    param->label_pad_width = max_label_width;
+  }
+  if (param->verbose) {
+    LOG(INFO) << "ImageDetRecordIOParser: " << param->path_imgrec
+              << ", label padding width: " << param->label_pad_width;
+  }
+}
+
+/*! \brief create the split of the records, shuffling its chunks if shuffle_chunk_size is set */
+inline dmlc::InputSplit* CreateDetRecordSplit(const ImageDetRecParserParam& param) {
+  dmlc::InputSplit* source = dmlc::InputSplit::Create(
+      param.path_imgrec.c_str(), param.part_index, param.num_parts, "recordio");
+
+  if (param.shuffle_chunk_size > 0) {
+    if (param.shuffle_chunk_size > 4096) {
+      LOG(INFO) << "Chunk size: " << param.shuffle_chunk_size
+                << " MB which is larger than 4096 MB, please set "
+                   "smaller chunk size";
+    }
+    if (param.shuffle_chunk_size < 4) {
+      LOG(INFO) << "Chunk size: " << param.shuffle_chunk_size
+                << " MB which is less than 4 MB, please set "
+                   "larger chunk size";
+    }
+    // 1.1 ratio is for a bit more shuffle parts to avoid boundary issue
+    unsigned num_shuffle_parts = std::ceil(
+        source->GetTotalSize() * 1.1 / (param.num_parts * (param.shuffle_chunk_size << 20UL)));
+
+    if (num_shuffle_parts > 1) {
+      delete source;
+      source = dmlc::InputSplitShuffle::Create(param.path_imgrec.c_str(),
+                                               param.part_index,
+                                               param.num_parts,
+                                               "recordio",
+                                               num_shuffle_parts,
+                                               param.shuffle_chunk_seed);
+    }
+    source->HintChunkSize(param.shuffle_chunk_size << 17UL);
+  } else {
+    // use 64 MB chunk when possible
+    source->HintChunkSize(8 << 20UL);
+  }
+  return source;
+}
+
 // parser to parse image recordio
 template <typename DType>
 class ImageDetRecordIOParser {
@@ -228,6 +378,7 @@ class ImageDetRecordIOParser {
 
   // set record to the head
   inline void BeforeFirst() {
+    ++epoch_;
     return source_->BeforeFirst();
   }
   // parse next set of records, return an array of
@@ -251,6 +402,8 @@ class ImageDetRecordIOParser {
   std::unique_ptr<ImageDetLabelMap> label_map_;
   /*! \brief temp space */
   mshadow::TensorContainer<cpu, 3> img_;
+  /*! \brief number of passes over the data started, keys the random streams of the records */
+  size_t epoch_ = 0;
   /*! \brief OMPException obj to store and rethrow exceptions from omp blocks*/
   dmlc::OMPException omp_exc_;
 };
@@ -294,91 +447,9 @@ inline void ImageDetRecordIOParser<DType>::Init(
     LOG(INFO) << "ImageDetRecordIOParser: " << param_.path_imgrec << ", use " << threadget
               << " threads for decoding..";
   }
-  source_.reset(dmlc::InputSplit::Create(
-      param_.path_imgrec.c_str(), param_.part_index, param_.num_parts, "recordio"));
-
   // estimate padding width for labels
-  int max_label_width = 0;
-  if (label_map_ != nullptr) {
-    max_label_width = label_map_->MaxLabelWidth();
-  } else {
-    // iterate through recordio
-    dmlc::InputSplit::Blob chunk;
-    while (source_->NextChunk(&chunk)) {
-#pragma omp parallel num_threads(param_.preprocess_threads)
-      {
-        omp_exc_.Run([&] {
-          CHECK(omp_get_num_threads() == param_.preprocess_threads);
-          int max_width = 0;
-          int tid       = omp_get_thread_num();
-          dmlc::RecordIOChunkReader reader(chunk, tid, param_.preprocess_threads);
-          ImageRecordIO rec;
-          dmlc::InputSplit::Blob blob;
-          while (reader.NextRecord(&blob)) {
-            rec.Load(blob.dptr, blob.size);
-            if (rec.label != nullptr) {
-              if (param_.label_width > 0) {
-                CHECK_EQ(param_.label_width, rec.num_label) << "rec file provide " << rec.num_label
-                                                            << "-dimensional label "
-                                                               "but label_width is set to "
-                                                            << param_.label_width;
-              }
-              // update max value
-              max_width = std::max(max_width, rec.num_label);
-            } else {
-              LOG(FATAL) << "Not enough label packed in img_list or rec file.";
-            }
-          }
-#pragma omp critical
-          { max_label_width = std::max(max_label_width, max_width); }
-        });
-      }
-      omp_exc_.Rethrow();
-    }
-  }
-  if (max_label_width > param_.label_pad_width) {
-    if (param_.label_pad_width > 0) {
-      LOG(FATAL) << "ImageDetRecordIOParser: label_pad_width: " << param_.label_pad_width
-                 << " smaller than estimated width: " << max_label_width;
-    }
-    param_.label_pad_width = max_label_width;
-  }
-  if (param_.verbose) {
-    LOG(INFO) << "ImageDetRecordIOParser: " << param_.path_imgrec
-              << ", label padding width: " << param_.label_pad_width;
-  }
-
-  source_.reset(dmlc::InputSplit::Create(
-      param_.path_imgrec.c_str(), param_.part_index, param_.num_parts, "recordio"));
-
-  if (param_.shuffle_chunk_size > 0) {
-    if (param_.shuffle_chunk_size > 4096) {
-      LOG(INFO) << "Chunk size: " << param_.shuffle_chunk_size
-                << " MB which is larger than 4096 MB, please set "
-                   "smaller chunk size";
-    }
-    if (param_.shuffle_chunk_size < 4) {
-      LOG(INFO) << "Chunk size: " << param_.shuffle_chunk_size
-                << " MB which is less than 4 MB, please set "
-                   "larger chunk size";
-    }
-    // 1.1 ratio is for a bit more shuffle parts to avoid boundary issue
-    unsigned num_shuffle_parts = std::ceil(
-        source_->GetTotalSize() * 1.1 / (param_.num_parts * (param_.shuffle_chunk_size << 20UL)));
-
-    if (num_shuffle_parts > 1) {
-      source_.reset(dmlc::InputSplitShuffle::Create(param_.path_imgrec.c_str(),
-                                                    param_.part_index,
-                                                    param_.num_parts,
-                                                    "recordio",
-                                                    num_shuffle_parts,
-                                                    param_.shuffle_chunk_seed));
-    }
-    source_->HintChunkSize(param_.shuffle_chunk_size << 17UL);
-  } else {
-    // use 64 MB chunk when possible
-    source_->HintChunkSize(8 << 20UL);
-  }
+  EstimateLabelPadWidth(label_map_.get(), &param_);
+  source_.reset(CreateDetRecordSplit(param_));
 #else
   LOG(FATAL) << "ImageDetRec need opencv to process";
 #endif
@@ -428,19 +499,10 @@ inline bool ImageDetRecordIOParser<DType>::ParseNext(std::vector<InstVector<DTyp
         }
         const int n_channels = res.channels();
         // load label before augmentations
-        std::vector<float> label_buf;
-        if (this->label_map_ != nullptr) {
-          label_buf = label_map_->FindCopy(rec.image_index());
-        } else if (rec.label != nullptr) {
-          if (param_.label_width > 0) {
-            CHECK_EQ(param_.label_width, rec.num_label) << "rec file provide " << rec.num_label
-                                                        << "-dimensional label "
-                                                           "but label_width is set to "
-                                                        << param_.label_width;
-          }
-          label_buf.assign(rec.label, rec.label + rec.num_label);
-        } else {
-          LOG(FATAL) << "Not enough label packed in img_list or rec file.";
+        std::vector<float> label_buf = LoadDetLabel(param_, label_map_.get(), rec);
+        if (param_.seed_aug.has_value()) {
+          SeedSampleStream(
+              this->prnds_[tid].get(), param_.seed_aug.value(), epoch_, rec.image_index());
         }
         for (auto& aug : this->augmenters_[tid]) {
           res = aug->Process(res, &label_buf, this->prnds_[tid].get());
@@ -599,6 +661,388 @@ class ImageDetRecordIter : public IIterator<DataInst> {
   common::RANDOM_ENGINE rnd_;
 };
 
+/*!
+ * \brief replaces the padded labels of the batches by the concatenated labels and their
+ *  offsets, see ImageDetRecParserParam::label_ragged
+ */
+class ImageDetRaggedLabelIter : public IIterator<TBlobBatch> {
+ public:
+  explicit ImageDetRaggedLabelIter(IIterator<TBlobBatch>* base) : base_(base) {}
+
+  void Init(const std::vector<std::pair<std::string, std::string>>& kwargs) override {
+    param_.InitAllowUnknown(kwargs);
+    base_->Init(kwargs);
+    out_.inst_index = new unsigned[param_.batch_size];
+  }
+
+  void BeforeFirst() override {
+    base_->BeforeFirst();
+  }
+
+  int64_t GetLenHint() const override {
+    return base_->GetLenHint();
+  }
+
+  bool Next() override {
+    if (!base_->Next())
+      return false;
+    const TBlobBatch& batch = base_->Value();
+    // each padded label starts with the shape of the image and the width of the label
+    mshadow::Tensor<cpu, 2> label = batch.data[1].get<cpu, 2, real_t>();
+    // without round_batch, the padding instances are left over from the previous batch
+    const index_t num_real =
+        param_.round_batch != 0 ? batch.batch_size : batch.batch_size - batch.num_batch_padd;
+    offsets_.Resize(mshadow::Shape1(batch.batch_size + 1));
+    offsets_[0] = 0;
+    for (index_t i = 0; i < batch.batch_size; ++i) {
+      offsets_[i + 1] = offsets_[i] + (i < num_real ? label[i][3] : 0);
+    }
+    values_.Resize(mshadow::Shape1(static_cast<index_t>(offsets_[batch.batch_size])));
+    for (index_t i = 0; i < num_real; ++i) {
+      const index_t begin = static_cast<index_t>(offsets_[i]);
+      const index_t end   = static_cast<index_t>(offsets_[i + 1]);
+      mshadow::Copy(values_.Slice(begin, end), label[i].Slice(4, 4 + end - begin));
+    }
+    std::copy(batch.inst_index, batch.inst_index + batch.batch_size, out_.inst_index);
+    out_.batch_size     = batch.batch_size;
+    out_.num_batch_padd = batch.num_batch_padd;
+    out_.data           = {batch.data[0], TBlob(values_), TBlob(offsets_)};
+    return true;
+  }
+
+  const TBlobBatch& Value() const override {
+    return out_;
+  }
+
+ private:
+  /*! \brief batch parameters */
+  BatchParam param_;
+  /*! \brief base iterator */
+  std::unique_ptr<IIterator<TBlobBatch>> base_;
+  /*! \brief output data */
+  TBlobBatch out_;
+  /*! \brief concatenated labels of the batch */
+  mshadow::TensorContainer<cpu, 1> values_;
+  /*! \brief offset of the label of each instance in values_, and their total width */
+  mshadow::TensorContainer<cpu, 1> offsets_;
+};
+
+#if MXNET_USE_OPENCV && MXNET_USE_CUDA && MXNET_USE_NVJPEG
+/*!
+ * \brief iterator decoding the batches with nvJPEG and resampling them into the data shape on
+ *  a GPU, with the mirror, padding, crop and contrast sampled by ImageDetCropSampler
+ */
+class ImageDetRecordIterGPU : public IIterator<DataBatch> {
+ public:
+  ~ImageDetRecordIterGPU() override {
+    iter_.Destroy();
+    while (!recycle_queue_.empty()) {
+      delete recycle_queue_.front();
+      recycle_queue_.pop();
+    }
+    delete out_;
+  }
+
+  void Init(const std::vector<std::pair<std::string, std::string>>& kwargs) override {
+    param_.InitAllowUnknown(kwargs);
+    record_param_.InitAllowUnknown(kwargs);
+    batch_param_.InitAllowUnknown(kwargs);
+    prefetch_param_.InitAllowUnknown(kwargs);
+    normalize_param_.InitAllowUnknown(kwargs);
+    CHECK(prefetch_param_.ctx != PrefetcherParam::CtxType::kCPU)
+        << "decode_device=gpu cannot be used with ctx=cpu";
+    CHECK_GE(prefetch_param_.device_id, 0) << "decode_device=gpu needs the device_id of a GPU";
+    CHECK_EQ(param_.aug_seq, "det_aug_default")
+        << "decode_device=gpu only supports the default detection augmenter";
+    CHECK(param_.data_shape[0] == 1 || param_.data_shape[0] == 3)
+        << "decode_device=gpu only supports 1 or 3 channels";
+    CHECK(!prefetch_param_.dtype.has_value() || prefetch_param_.dtype.value() == mshadow::kFloat32)
+        << "decode_device=gpu only supports float32 data";
+    CHECK_EQ(normalize_param_.mean_img, "") << "decode_device=gpu does not support mean_img";
+    CHECK(param_.path_imgrec.length() != 0) << "ImageDetRecordIOIterator: must specify image_rec";
+    sampler_ = std::make_unique<ImageDetCropSampler>(kwargs);
+    decoder_ = std::make_unique<GPUImageDecoder>(prefetch_param_.device_id,
+                                                 param_.data_shape[0],
+                                                 param_.data_shape[1],
+                                                 param_.data_shape[2]);
+    if (param_.path_imglist.length() != 0) {
+      label_map_ = std::make_unique<ImageDetLabelMap>(
+          param_.path_imglist.c_str(), param_.label_width, !param_.verbose);
+    }
+    if (!param_.label_ragged) {
+      EstimateLabelPadWidth(label_map_.get(), &param_);
+    }
+    source_.reset(CreateDetRecordSplit(param_));
+    rnd_.seed(kRandMagic + record_param_.seed);
+    prnd_.seed(kRandMagic);
+    if (param_.verbose) {
+      LOG(INFO) << "ImageDetRecordIOParser: " << param_.path_imgrec << ", decoding on gpu("
+                << prefetch_param_.device_id << ")";
+    }
+    // maximum prefetch threaded iter internal size
+    const int kMaxPrefetchBuffer = 16;
+    iter_.set_max_capacity(kMaxPrefetchBuffer);
+    iter_.Init(
+        [this](DataBatch** dptr) {
+          if (*dptr == nullptr) {
+            *dptr = new DataBatch();
+          }
+          return ParseNext(*dptr);
+        },
+        [this]() { ResetSource(); });
+  }
+
+  void BeforeFirst() override {
+    iter_.BeforeFirst();
+  }
+
+  bool Next() override {
+    if (out_ != nullptr) {
+      recycle_queue_.push(out_);
+      out_ = nullptr;
+    }
+    // do recycle
+    if (recycle_queue_.size() == prefetch_param_.prefetch_buffer) {
+      DataBatch* old_batch = recycle_queue_.front();
+      for (NDArray& arr : old_batch->data) {
+        arr.WaitToWrite();
+      }
+      recycle_queue_.pop();
+      iter_.Recycle(&old_batch);
+    }
+    return iter_.Next(&out_);
+  }
+
+  const DataBatch& Value() const override {
+    return *out_;
+  }
+
+ private:
+  /*! \brief an encoded image read but not output yet */
+  struct PendingRecord {
+    std::string image;
+    std::vector<float> label;
+    unsigned index;
+  };
+
+  // set record to the head
+  void ResetSource() {
+    if (batch_param_.round_batch == 0 || !overflow_) {
+      pending_.clear();
+      ++epoch_;
+      source_->BeforeFirst();
+    } else {
+      overflow_ = false;
+    }
+  }
+
+  // append the records of a chunk to pending_
+  void ReadChunk(const dmlc::InputSplit::Blob& chunk) {
+    dmlc::RecordIOChunkReader reader(chunk, 0, 1);
+    dmlc::InputSplit::Blob blob;
+    ImageRecordIO rec;
+    const size_t first = pending_.size();
+    while (reader.NextRecord(&blob)) {
+      rec.Load(blob.dptr, blob.size);
+      pending_.push_back({std::string(reinterpret_cast<char*>(rec.content), rec.content_size),
+                          LoadDetLabel(param_, label_map_.get(), rec),
+                          static_cast<unsigned>(rec.image_index())});
+    }
+    // shuffle instance order if needed
+    if (record_param_.shuffle) {
+      std::shuffle(pending_.begin() + first, pending_.end(), rnd_);
+    }
+  }
+
+  // decode and augment the next batch, the records beyond the batch are kept encoded
+  bool ParseNext(DataBatch* out) {
+    const index_t batch_size = batch_param_.batch_size;
+    const int channels       = param_.data_shape[0];
+    const int height         = param_.data_shape[1];
+    const int width          = param_.data_shape[2];
+    if (out->data.empty()) {
+      const int dev_id        = prefetch_param_.device_id;
+      const Context label_ctx = Context::CPUPinned(dev_id);
+      out->data.resize(param_.label_ragged ? 3 : 2);
+      out->data[0] = NDArray(TShape({batch_size, channels, height, width}),
+                             Context::GPU(dev_id),
+                             false,
+                             mshadow::kFloat32);
+      if (param_.label_ragged) {
+        out->data[1] = NDArray(TShape({batch_size}), label_ctx, false, mshadow::kFloat32);
+        out->data[2] = NDArray(TShape({batch_size + 1}), label_ctx, false, mshadow::kFloat32);
+      } else {
+        out->data[1] = NDArray(TShape({batch_size, static_cast<dim_t>(param_.label_pad_width + 4)}),
+                               label_ctx,
+                               false,
+                               mshadow::kFloat32);
+      }
+    }
+    out->num_batch_padd = 0;
+    while (pending_.size() < batch_size) {
+      dmlc::InputSplit::Blob chunk;
+      if (source_->NextChunk(&chunk)) {
+        ReadChunk(chunk);
+        continue;
+      }
+      if (pending_.empty()) {
+        return false;
+      }
+      CHECK(!overflow_) << "number of input images must be bigger than the batch size";
+      out->num_batch_padd = batch_size - pending_.size();
+      if (batch_param_.round_batch == 0) {
+        break;
+      }
+      overflow_ = true;
+      ++epoch_;
+      source_->BeforeFirst();
+    }
+
+    const size_t n = std::min<size_t>(batch_size, pending_.size());
+    std::vector<std::string> images(n);
+    std::vector<std::vector<float>> labels(n);
+    out->index.resize(batch_size);
+    for (size_t i = 0; i < n; ++i) {
+      images[i]     = std::move(pending_.front().image);
+      labels[i]     = std::move(pending_.front().label);
+      out->index[i] = pending_.front().index;
+      pending_.pop_front();
+    }
+
+    const float mean[4] = {normalize_param_.mean_r,
+                           normalize_param_.mean_g,
+                           normalize_param_.mean_b,
+                           normalize_param_.mean_a};
+    const float stds[4] = {normalize_param_.std_r,
+                           normalize_param_.std_g,
+                           normalize_param_.std_b,
+                           normalize_param_.std_a};
+    auto sample_crop = [&](int i, int src_width, int src_height, GPUImageCrop* crop) {
+      if (param_.seed_aug.has_value()) {
+        SeedSampleStream(&prnd_, param_.seed_aug.value(), epoch_, out->index[i]);
+      }
+      // the labels are transformed here, the crop is chosen from the boxes it keeps
+      const ImageDetCrop det = sampler_->Sample(src_width, src_height, &labels[i], &prnd_);
+      crop->x                = det.box.x;
+      crop->y                = det.box.y;
+      crop->scale_x          = det.box.width / width;
+      crop->scale_y          = det.box.height / height;
+      crop->mirror           = det.mirror;
+      crop->fill             = det.pad;
+      // the contrast scales the pixels before the mean is subtracted, but not the padding
+      crop->fill_value = sampler_->fill_value() / det.contrast;
+      for (int k = 0; k < 4; ++k) {
+        const float scale = normalize_param_.scale / (stds[k] > 0.0f ? stds[k] : 1.0f);
+        crop->mult[k]     = det.contrast * scale;
+        crop->bias[k]     = mean[k] * (det.contrast - 1) * scale;
+      }
+    };
+    decoder_->Decode(images, sample_crop, mean, static_cast<real_t*>(out->data[0].data().dptr_));
+
+    if (param_.label_ragged) {
+      real_t* offsets = static_cast<real_t*>(out->data[2].data().dptr_);
+      offsets[0]      = 0;
+      for (size_t i = 0; i < batch_size; ++i) {
+        offsets[i + 1] = offsets[i] + (i < n ? labels[i].size() : 0);
+      }
+      PrefetcherIter::ReshapeWithCapacity(TShape({static_cast<dim_t>(offsets[batch_size])}),
+                                          &out->data[1]);
+      real_t* values = static_cast<real_t*>(out->data[1].data().dptr_);
+      for (size_t i = 0; i < n; ++i) {
+        std::copy(labels[i].begin(), labels[i].end(), values + static_cast<size_t>(offsets[i]));
+      }
+    } else {
+      mshadow::Tensor<cpu, 2> label = out->data[1].data().get<cpu, 2, real_t>();
+      label                         = param_.label_pad_value;
+      for (size_t i = 0; i < n; ++i) {
+        // store info for real data_shape and label_width
+        label[i][0] = channels;
+        label[i][1] = height;
+        label[i][2] = width;
+        label[i][3] = labels[i].size();
+        std::copy(labels[i].begin(), labels[i].end(), label[i].dptr_ + 4);
+      }
+    }
+    return true;
+  }
+
+  // random magic
+  static const int kRandMagic = 233;
+  /*! \brief parameters */
+  ImageDetRecParserParam param_;
+  ImageDetRecordParam record_param_;
+  BatchParam batch_param_;
+  PrefetcherParam prefetch_param_;
+  ImageDetNormalizeParam normalize_param_;
+  /*! \brief samples the augmentations and transforms the labels */
+  std::unique_ptr<ImageDetCropSampler> sampler_;
+  /*! \brief decoder of the batches */
+  std::unique_ptr<GPUImageDecoder> decoder_;
+  /*! \brief data source */
+  std::unique_ptr<dmlc::InputSplit> source_;
+  /*! \brief label information, if any */
+  std::unique_ptr<ImageDetLabelMap> label_map_;
+  /*! \brief encoded images and labels read but not output yet */
+  std::deque<PendingRecord> pending_;
+  /*! \brief random number generator of the record order */
+  common::RANDOM_ENGINE rnd_;
+  /*! \brief random number generator of the augmentations */
+  common::RANDOM_ENGINE prnd_;
+  /*! \brief number of passes over the data started, keys the random streams of the records */
+  size_t epoch_ = 0;
+  /*! \brief overflow marker */
+  bool overflow_ = false;
+  /*! \brief backend thread */
+  dmlc::ThreadedIter<DataBatch> iter_;
+  /*! \brief output data */
+  DataBatch* out_ = nullptr;
+  /*! \brief queue to be recycled */
+  std::queue<DataBatch*> recycle_queue_;
+};
+#endif  // MXNET_USE_OPENCV && MXNET_USE_CUDA && MXNET_USE_NVJPEG
+
+/*! \brief chooses the pipeline of ImageDetRecordIter from decode_device and label_ragged */
+class ImageDetRecordIterWrapper : public IIterator<DataBatch> {
+ public:
+  void Init(const std::vector<std::pair<std::string, std::string>>& kwargs) override {
+    ImageDetRecParserParam param;
+    param.InitAllowUnknown(kwargs);
+    if (param.decode_device == ImageRecParserParam::kDecodeGPU) {
+#if MXNET_USE_OPENCV && MXNET_USE_CUDA && MXNET_USE_NVJPEG
+      iter_ = std::make_unique<ImageDetRecordIterGPU>();
+#else
+      LOG(FATAL) << "decode_device=gpu requires MXNet built with USE_CUDA and USE_NVJPEG";
+#endif
+    } else if (param.label_ragged) {
+      iter_ = std::make_unique<PrefetcherIter>(new ImageDetRaggedLabelIter(
+          new BatchLoader(new ImageDetNormalizeIter(new ImageDetRecordIter<real_t>()))));
+    } else {
+      iter_ = std::make_unique<PrefetcherIter>(
+          new BatchLoader(new ImageDetNormalizeIter(new ImageDetRecordIter<real_t>())));
+    }
+    iter_->Init(kwargs);
+  }
+
+  void BeforeFirst() override {
+    iter_->BeforeFirst();
+  }
+
+  int64_t GetLenHint() const override {
+    return iter_->GetLenHint();
+  }
+
+  bool Next() override {
+    return iter_->Next();
+  }
+
+  const DataBatch& Value() const override {
+    return iter_->Value();
+  }
+
+ private:
+  std::unique_ptr<IIterator<DataBatch>> iter_;
+};
+
 DMLC_REGISTER_PARAMETER(ImageDetRecParserParam);
 DMLC_REGISTER_PARAMETER(ImageDetRecordParam);
 
@@ -610,9 +1054,6 @@ MXNET_REGISTER_IO_ITER(ImageDetRecordIter)
     .add_arguments(PrefetcherParam::__FIELDS__())
     .add_arguments(ListDefaultDetAugParams())
     .add_arguments(ImageDetNormalizeParam::__FIELDS__())
-    .set_body([]() {
-      return new PrefetcherIter(
-          new BatchLoader(new ImageDetNormalizeIter(new ImageDetRecordIter<real_t>())));
-    });
+    .set_body([]() { return new ImageDetRecordIterWrapper(); });
 }  // namespace io
 }  // namespace mxnet
@@ -37,6 +37,7 @@
 #include <cstdlib>
 #include "./image_iter_common.h"
 #include "./inst_vector.h"
+#include "./sample_random.h"
 #include "./image_recordio.h"
 #include "./image_augmenter.h"
 #include "./iter_prefetcher.h"
@@ -54,6 +55,7 @@ class ImageRecordIOParser {
 
   // set record to the head
   inline void BeforeFirst() {
+    ++epoch_;
     return source_->BeforeFirst();
   }
   // parse next set of records, return an array of
@@ -77,6 +79,8 @@ class ImageRecordIOParser {
   std::unique_ptr<ImageLabelMap> label_map_;
   /*! \brief temp space */
   mshadow::TensorContainer<cpu, 3> img_;
+  /*! \brief number of passes over the data started, keys the random streams of the records */
+  size_t epoch_ = 0;
 };
 
 template <typename DType>
@@ -194,6 +198,9 @@ inline bool ImageRecordIOParser<DType>::ParseNext(std::vector<InstVector<DType>>
           LOG(FATAL) << "Invalid output shape " << param_.data_shape;
       }
       const int n_channels = res.channels();
+      if (param_.seed_aug.has_value()) {
+        SeedSampleStream(prnds_[tid].get(), param_.seed_aug.value(), epoch_, rec.image_index());
+      }
       for (auto& aug : augmenters_[tid]) {
         res = aug->Process(res, nullptr, prnds_[tid].get());
       }
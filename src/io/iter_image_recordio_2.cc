@@ -32,16 +32,24 @@
 #include <dmlc/omp.h>
 #include <dmlc/common.h>
 #include <dmlc/timer.h>
+#include <deque>
 #include <memory>
+#include <optional>
 #include <type_traits>
+#include <utility>
 #if MXNET_USE_LIBJPEG_TURBO
 #include <turbojpeg.h>
 #endif
 #include "./image_recordio.h"
 #include "./image_augmenter.h"
+#include "./image_decode_gpu.h"
 #include "./image_iter_common.h"
 #include "./inst_vector.h"
+#include "./sample_random.h"
+#include "./sharded_input_split.h"
 #include "../common/utils.h"
+#include "../engine/thread_budget.h"
+#include "../profiler/data_profiler.h"
 #include "../profiler/profiler.h"
 
 namespace mxnet {
@@ -51,6 +59,9 @@ namespace io {
 template <typename DType>
 class ImageRecordIOParser2 {
  public:
+  ~ImageRecordIOParser2() {
+    engine::ThreadBudget::Get()->ReleaseLoaderThreads(budget_threads_);
+  }
   // initialize the parser
   inline void Init(const std::vector<std::pair<std::string, std::string>>& kwargs);
 
@@ -58,6 +69,11 @@ class ImageRecordIOParser2 {
   inline void BeforeFirst() {
     if (batch_param_.round_batch == 0 || !overflow) {
       n_parsed_ = 0;
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+      pending_.clear();
+      n_decoded_ = 0;
+#endif
+      ++epoch_;
       return source_->BeforeFirst();
     } else {
       overflow = false;
@@ -77,12 +93,24 @@ class ImageRecordIOParser2 {
                     const float illumination_scaled);
 #if MXNET_USE_LIBJPEG_TURBO
   cv::Mat TJimdecode(cv::Mat buf, int color);
+  bool TJimdecodeCrop(cv::Mat buf, int color, common::RANDOM_ENGINE* prnd, cv::Mat* res);
 #endif
 #endif
   inline size_t ParseChunk(DType* data_dptr,
                            real_t* label_dptr,
                            const size_t current_size,
                            dmlc::InputSplit::Blob* chunk);
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+  // decode and augment the next batch on the GPU
+  inline bool ParseNextGPU(DataBatch* out);
+  // append the records of a chunk to pending_
+  inline void ReadChunk(dmlc::InputSplit::Blob* chunk);
+#endif
+  inline void LoadLabel(const ImageRecordIO& rec, std::vector<float>* label_buf);
+  inline void SampleNormalize(common::RANDOM_ENGINE* prnd,
+                              bool* is_mirrored,
+                              float* contrast_scaled,
+                              float* illumination_scaled);
   inline void CreateMeanImg();
 
   // magic number to seed prng
@@ -114,6 +142,8 @@ class ImageRecordIOParser2 {
   size_t inst_index_;
   /*! \brief internal counter tracking number of already parsed entries */
   size_t n_parsed_;
+  /*! \brief number of passes over the data started, keys the random streams of the records */
+  size_t epoch_ = 0;
   /*! \brief overflow marker */
   bool overflow;
   /*! \brief unit size */
@@ -127,6 +157,20 @@ class ImageRecordIOParser2 {
   bool meanfile_ready_;
   /*! \brief OMPException obj to store and rethrow exceptions from omp blocks*/
   dmlc::OMPException omp_exc_;
+  /*! \brief number of preprocess threads taken from the thread budget */
+  int budget_threads_ = 0;
+  // whether decode_device is gpu
+  bool decode_on_gpu_ = false;
+  /*! \brief crops of the default augmenter when decoding on the GPU or cropping while decoding */
+  std::unique_ptr<ImageCropSampler> crop_sampler_;
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+  /*! \brief decoder when decoding on the GPU */
+  std::unique_ptr<GPUImageDecoder> gpu_decoder_;
+  /*! \brief encoded images and labels read but not output yet, when decoding on the GPU */
+  std::deque<std::pair<std::string, std::vector<float>>> pending_;
+  /*! \brief number of images decoded on the GPU in this epoch */
+  size_t n_decoded_ = 0;
+#endif
 };
 
 template <typename DType>
@@ -157,7 +201,10 @@ inline void ImageRecordIOParser2<DType>::Init(
 #pragma omp parallel num_threads(param_.preprocess_threads)
     { threadget = omp_get_num_threads(); }
   }
-  param_.preprocess_threads = threadget;
+  // the decoding threads share the cores of the data loaders when a thread budget is set
+  engine::ThreadBudget::Get()->ReleaseLoaderThreads(budget_threads_);
+  param_.preprocess_threads = engine::ThreadBudget::Get()->AcquireLoaderThreads(threadget);
+  budget_threads_           = param_.preprocess_threads;
 
   std::vector<std::string> aug_names = dmlc::Split(param_.aug_seq, ',');
   augmenters_.clear();
@@ -175,13 +222,52 @@ inline void ImageRecordIOParser2<DType>::Init(
         param_.path_imglist.c_str(), param_.label_width, !param_.verbose);
   }
   CHECK(param_.path_imgrec.length() != 0) << "ImageRecordIter2: must specify image_rec";
+  decode_on_gpu_ = param_.decode_device == ImageRecParserParam::kDecodeGPU;
+  if (decode_on_gpu_) {
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+    CHECK(prefetch_param.ctx != PrefetcherParam::CtxType::kCPU)
+        << "decode_device=gpu cannot be used with ctx=cpu";
+    CHECK_GE(param_.device_id, 0) << "decode_device=gpu needs the device_id of a GPU";
+    CHECK_EQ(param_.aug_seq, "aug_default")
+        << "decode_device=gpu only supports the default augmenter";
+    crop_sampler_ = std::make_unique<ImageCropSampler>(kwargs);
+    gpu_decoder_  = std::make_unique<GPUImageDecoder>(
+        param_.device_id, param_.data_shape[0], param_.data_shape[1], param_.data_shape[2]);
+    if (param_.verbose) {
+      LOG(INFO) << "ImageRecordIOParser2: decoding on gpu(" << param_.device_id << ")";
+    }
+#else
+    LOG(FATAL) << "decode_device=gpu requires MXNet built with USE_CUDA and USE_NVJPEG";
+#endif
+  }
+#if MXNET_USE_LIBJPEG_TURBO
+  // when the default augmenter only resizes and crops, JPEG images are cropped
+  // while decoding, at the smallest DCT scale keeping the crop larger than the output
+  if (!decode_on_gpu_ && dmlc::GetEnv("MXNET_IMAGE_FUSED_DECODE", true) &&
+      param_.aug_seq == "aug_default" && ImageCropSampler::Supported(kwargs)) {
+    crop_sampler_ = std::make_unique<ImageCropSampler>(kwargs);
+    // inter_method 9 and 10 are chosen per image by the augmenter
+    if (crop_sampler_->inter_method() < 0 || crop_sampler_->inter_method() > 4) {
+      crop_sampler_.reset();
+    }
+  }
+#endif
 
   if (param_.verbose) {
     LOG(INFO) << "ImageRecordIOParser2: " << param_.path_imgrec << ", use " << threadget
               << " threads for decoding..";
   }
   legacy_shuffle_ = false;
-  if (param_.path_imgidx.length() != 0) {
+  if (param_.read_shards) {
+    source_.reset(new ShardedInputSplit(param_.path_imgrec,
+                                        param_.part_index,
+                                        param_.num_parts,
+                                        record_param_.shuffle,
+                                        param_.shuffle_chunk_seed,
+                                        param_.shuffle_buffer,
+                                        param_.prefetch_shards,
+                                        param_.num_range_reads));
+  } else if (param_.path_imgidx.length() != 0) {
     source_.reset(dmlc::InputSplit::Create(param_.path_imgrec.c_str(),
                                            param_.path_imgidx.c_str(),
                                            param_.part_index,
@@ -257,6 +343,12 @@ inline void ImageRecordIOParser2<DType>::Init(
         }
       }
     }
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+    if (meanfile_ready_ && gpu_decoder_ != nullptr) {
+      CHECK_EQ(meanimg_.shape_.Size(), param_.data_shape.Size()) << "Invalid mean image shape";
+      gpu_decoder_->SetMeanImage(meanimg_.dptr_);
+    }
+#endif
   }
 #else
   LOG(FATAL) << "ImageRec need opencv to process";
@@ -302,19 +394,32 @@ inline bool ImageRecordIOParser2<DType>::ParseNext(DataBatch* out) {
     const std::string profiler_scope =
         profiler::ProfilerScope::Get()->GetCurrentProfilerScope() + "image_io:";
 
-    out->data.at(0) = NDArray(data_shape, ctx, false, mshadow::DataType<DType>::kFlag);
+    out->data.at(0) = NDArray(data_shape,
+                              decode_on_gpu_ ? Context::GPU(dev_id) : ctx,
+                              false,
+                              mshadow::DataType<DType>::kFlag);
     out->data.at(0).AssignStorageInfo(profiler_scope, "data");
     out->data.at(1) = NDArray(label_shape, ctx, false, mshadow::DataType<real_t>::kFlag);
     out->data.at(1).AssignStorageInfo(profiler_scope, "label");
     unit_size_[0] = param_.data_shape.Size();
     unit_size_[1] = param_.label_width;
   }
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+  if (decode_on_gpu_) {
+    return ParseNextGPU(out);
+  }
+#endif
 
   while (current_size < batch_param_.batch_size) {
     // int n_to_copy;
     size_t n_to_out = 0;
     if (n_parsed_ == 0) {
-      if (source_->NextBatch(&chunk, batch_param_.batch_size)) {
+      bool has_chunk;
+      {
+        profiler::DataSpan span("read");
+        has_chunk = source_->NextBatch(&chunk, batch_param_.batch_size);
+      }
+      if (has_chunk) {
         inst_order_.clear();
         inst_index_        = 0;
         DType* data_dptr   = static_cast<DType*>(out->data[0].data().dptr_);
@@ -337,6 +442,7 @@ inline bool ImageRecordIOParser2<DType>::ParseNext(DataBatch* out) {
         CHECK(!overflow) << "number of input images must be bigger than the batch size";
         if (batch_param_.round_batch != 0) {
           overflow = true;
+          ++epoch_;
           source_->BeforeFirst();
         } else {
           current_size = batch_param_.batch_size;
@@ -348,6 +454,7 @@ inline bool ImageRecordIOParser2<DType>::ParseNext(DataBatch* out) {
       size_t n_to_copy =
           std::min(n_parsed_, static_cast<size_t>(batch_param_.batch_size) - current_size);
       n_parsed_ -= n_to_copy;
+      profiler::DataSpan span("batchify");
 // Copy
 #pragma omp parallel for num_threads(param_.preprocess_threads)
       for (int i = 0; i < static_cast<int>(n_to_copy); ++i) {
@@ -504,6 +611,73 @@ cv::Mat ImageRecordIOParser2<DType>::TJimdecode(cv::Mat image, int color) {
   tjDestroy(handle);
   return ret;
 }
+
+// Decode and crop a JPEG image in place of the default augmenter. The image is decoded at
+// the smallest DCT scaling factor keeping the sampled crop at least as large as the output,
+// and the crop is resized to the output. Returns false if buf is not a JPEG image.
+template <typename DType>
+bool ImageRecordIOParser2<DType>::TJimdecodeCrop(cv::Mat image,
+                                                 int color,
+                                                 common::RANDOM_ENGINE* prnd,
+                                                 cv::Mat* res) {
+  unsigned char* jpeg = image.ptr();
+  size_t jpeg_size    = image.rows * image.cols;
+  if (!is_jpeg(jpeg)) {
+    return false;
+  }
+  tjhandle handle = tjInitDecompress();
+  int h, w, subsamp;
+  if (tjDecompressHeader2(handle, jpeg, jpeg_size, &w, &h, &subsamp) != 0) {
+    tjDestroy(handle);
+    return false;
+  }
+  const ImageCropBox box = crop_sampler_->Sample(w, h, prnd);
+  const int out_h        = param_.data_shape[1];
+  const int out_w        = param_.data_shape[2];
+  tjscalingfactor scale  = {1, 1};
+  int num_factors;
+  const tjscalingfactor* factors = tjGetScalingFactors(&num_factors);
+  for (int i = 0; i < num_factors; ++i) {
+    const tjscalingfactor& f = factors[i];
+    if (f.num * scale.denom < scale.num * f.denom && box.width * f.num >= out_w * f.denom &&
+        box.height * f.num >= out_h * f.denom) {
+      scale = f;
+    }
+  }
+  cv::Mat decoded(TJSCALED(h, scale), TJSCALED(w, scale), color ? CV_8UC3 : CV_8UC1);
+  int err = tjDecompress2(handle,
+                          jpeg,
+                          jpeg_size,
+                          decoded.ptr(),
+                          decoded.cols,
+                          0,
+                          decoded.rows,
+                          color ? TJPF_BGR : TJPF_GRAY,
+                          0);
+  tjDestroy(handle);
+  if (err != 0) {
+    // If it is a malformed JPEG then fall back to OpenCV, the crop is sampled already
+    decoded = cv::imdecode(image, color);
+    CHECK(!decoded.empty()) << "cannot decode image";
+  }
+  const float sx = static_cast<float>(decoded.cols) / w;
+  const float sy = static_cast<float>(decoded.rows) / h;
+  const int x0   = std::min(std::max(static_cast<int>(box.x * sx), 0), decoded.cols - 1);
+  const int y0   = std::min(std::max(static_cast<int>(box.y * sy), 0), decoded.rows - 1);
+  const int x1 =
+      std::min(std::max(static_cast<int>(std::round((box.x + box.width) * sx)), x0 + 1),
+               decoded.cols);
+  const int y1 =
+      std::min(std::max(static_cast<int>(std::round((box.y + box.height) * sy)), y0 + 1),
+               decoded.rows);
+  cv::resize(decoded(cv::Rect(x0, y0, x1 - x0, y1 - y0)),
+             *res,
+             cv::Size(out_w, out_h),
+             0,
+             0,
+             crop_sampler_->inter_method());
+  return true;
+}
 #endif
 #endif
 
@@ -520,6 +694,7 @@ inline size_t ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr,
   size_t gl_idx = current_size;
 #pragma omp parallel num_threads(param_.preprocess_threads)
   {
+    engine::ThreadBudget::Get()->PinLoaderThread();
     omp_exc_.Run([&] {
       CHECK(omp_get_num_threads() == param_.preprocess_threads);
       int tid = omp_get_thread_num();
@@ -549,23 +724,32 @@ inline size_t ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr,
         rec.Load(blob.dptr, blob.size);
         cv::Mat buf(1, rec.content_size, CV_8U, rec.content);
 
-        // If augmentation seed is supplied
-        // Re-seed RNG to guarantee reproducible results
+        // If augmentation seed is supplied, draw from the stream of the record
+        // for results independent of the threads
         if (param_.seed_aug.has_value()) {
-          prnds_[tid]->seed(idx + param_.seed_aug.value() + kRandMagic);
+          SeedSampleStream(prnds_[tid].get(), param_.seed_aug.value(), epoch_, rec.image_index());
         }
 
+        // whether the image was cropped and resized while decoding
+        bool cropped = false;
+        std::optional<profiler::DataSpan> span(std::in_place, "decode");
         switch (param_.data_shape[0]) {
           case 1:
 #if MXNET_USE_LIBJPEG_TURBO
-            res = TJimdecode(buf, 0);
+            cropped = crop_sampler_ != nullptr &&
+                      TJimdecodeCrop(buf, 0, prnds_[tid].get(), &res);
+            if (!cropped)
+              res = TJimdecode(buf, 0);
 #else
             res = cv::imdecode(buf, 0);
 #endif
             break;
           case 3:
 #if MXNET_USE_LIBJPEG_TURBO
-            res = TJimdecode(buf, 1);
+            cropped = crop_sampler_ != nullptr &&
+                      TJimdecodeCrop(buf, 1, prnds_[tid].get(), &res);
+            if (!cropped)
+              res = TJimdecode(buf, 1);
 #else
             res = cv::imdecode(buf, 1);
 #endif
@@ -582,23 +766,14 @@ inline size_t ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr,
         const int n_channels = res.channels();
         // load label before augmentations
         std::vector<float> label_buf;
-        if (label_map_ != nullptr) {
-          label_buf = label_map_->FindCopy(rec.image_index());
-        } else if (rec.label != nullptr) {
-          CHECK_EQ(param_.label_width, rec.num_label) << "rec file provide " << rec.num_label
-                                                      << "-dimensional label "
-                                                         "but label_width is set to "
-                                                      << param_.label_width;
-          label_buf.assign(rec.label, rec.label + rec.num_label);
-        } else {
-          CHECK_EQ(param_.label_width, 1)
-              << "label_width must be 1 unless an imglist is provided "
-                 "or the rec file is packed with multi dimensional label";
-          label_buf.assign(&rec.header.label, &rec.header.label + 1);
-        }
-        for (auto& aug : augmenters_[tid]) {
-          res = aug->Process(res, &label_buf, prnds_[tid].get());
+        LoadLabel(rec, &label_buf);
+        span.reset();
+        span.emplace("augment");
+        for (size_t i = 0; i < augmenters_[tid].size() && !cropped; ++i) {
+          res = augmenters_[tid][i]->Process(res, &label_buf, prnds_[tid].get());
         }
+        span.reset();
+        span.emplace("normalize");
         mshadow::Tensor<cpu, 3, DType> data;
         if (idx < batch_param_.batch_size) {
           data = mshadow::Tensor<cpu, 3, DType>(data_dptr + idx * unit_size_[0],
@@ -610,22 +785,9 @@ inline size_t ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr,
           data = out_tmp.data().Back();
         }
 
-        std::uniform_real_distribution<float> rand_uniform(0, 1);
-        std::bernoulli_distribution coin_flip(0.5);
-        bool is_mirrored =
-            (normalize_param_.rand_mirror && coin_flip(*(prnds_[tid]))) || normalize_param_.mirror;
-        float contrast_scaled     = 1;
-        float illumination_scaled = 0;
-        if (!std::is_same<DType, uint8_t>::value) {
-          contrast_scaled =
-              (rand_uniform(*(prnds_[tid])) * normalize_param_.max_random_contrast * 2 -
-               normalize_param_.max_random_contrast + 1) *
-              normalize_param_.scale;
-          illumination_scaled =
-              (rand_uniform(*(prnds_[tid])) * normalize_param_.max_random_illumination * 2 -
-               normalize_param_.max_random_illumination) *
-              normalize_param_.scale;
-        }
+        bool is_mirrored;
+        float contrast_scaled, illumination_scaled;
+        SampleNormalize(prnds_[tid].get(), &is_mirrored, &contrast_scaled, &illumination_scaled);
         // For RGB or RGBA data, swap the B and R channel:
         // OpenCV store as BGR (or BGRA) and we want RGB (or RGBA)
         if (n_channels == 1) {
@@ -648,6 +810,7 @@ inline size_t ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr,
             label,
             mshadow::Tensor<cpu, 1>(dmlc::BeginPtr(label_buf), mshadow::Shape1(label_buf.size())));
         res.release();
+        span.reset();
       }
     });
   }
@@ -659,6 +822,133 @@ inline size_t ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr,
 #endif
 }
 
+template <typename DType>
+inline void ImageRecordIOParser2<DType>::LoadLabel(const ImageRecordIO& rec,
+                                                   std::vector<float>* label_buf) {
+  if (label_map_ != nullptr) {
+    *label_buf = label_map_->FindCopy(rec.image_index());
+  } else if (rec.label != nullptr) {
+    CHECK_EQ(param_.label_width, rec.num_label) << "rec file provide " << rec.num_label
+                                                << "-dimensional label "
+                                                   "but label_width is set to "
+                                                << param_.label_width;
+    label_buf->assign(rec.label, rec.label + rec.num_label);
+  } else {
+    CHECK_EQ(param_.label_width, 1) << "label_width must be 1 unless an imglist is provided "
+                                       "or the rec file is packed with multi dimensional label";
+    label_buf->assign(&rec.header.label, &rec.header.label + 1);
+  }
+}
+
+// sample the mirror, contrast and illumination of iter_normalize.h for an image
+template <typename DType>
+inline void ImageRecordIOParser2<DType>::SampleNormalize(common::RANDOM_ENGINE* prnd,
+                                                         bool* is_mirrored,
+                                                         float* contrast_scaled,
+                                                         float* illumination_scaled) {
+  std::uniform_real_distribution<float> rand_uniform(0, 1);
+  std::bernoulli_distribution coin_flip(0.5);
+  *is_mirrored = (normalize_param_.rand_mirror && coin_flip(*prnd)) || normalize_param_.mirror;
+  *contrast_scaled     = 1;
+  *illumination_scaled = 0;
+  if (!std::is_same<DType, uint8_t>::value) {
+    *contrast_scaled = (rand_uniform(*prnd) * normalize_param_.max_random_contrast * 2 -
+                        normalize_param_.max_random_contrast + 1) *
+                       normalize_param_.scale;
+    *illumination_scaled = (rand_uniform(*prnd) * normalize_param_.max_random_illumination * 2 -
+                            normalize_param_.max_random_illumination) *
+                           normalize_param_.scale;
+  }
+}
+
+#if MXNET_USE_CUDA && MXNET_USE_NVJPEG
+template <typename DType>
+inline void ImageRecordIOParser2<DType>::ReadChunk(dmlc::InputSplit::Blob* chunk) {
+  dmlc::RecordIOChunkReader reader(*chunk, 0, 1);
+  dmlc::InputSplit::Blob blob;
+  ImageRecordIO rec;
+  const size_t first = pending_.size();
+  while (reader.NextRecord(&blob)) {
+    rec.Load(blob.dptr, blob.size);
+    std::vector<float> label_buf;
+    LoadLabel(rec, &label_buf);
+    pending_.emplace_back(std::string(reinterpret_cast<char*>(rec.content), rec.content_size),
+                          std::move(label_buf));
+  }
+  if (legacy_shuffle_) {
+    std::shuffle(pending_.begin() + first, pending_.end(), rnd_);
+  }
+}
+
+// Read whole chunks and decode the images of a batch together, the records
+// beyond the batch are kept encoded for the next one
+template <typename DType>
+inline bool ImageRecordIOParser2<DType>::ParseNextGPU(DataBatch* out) {
+  const size_t batch_size = batch_param_.batch_size;
+  out->num_batch_padd     = 0;
+  while (pending_.size() < batch_size) {
+    dmlc::InputSplit::Blob chunk;
+    if (source_->NextBatch(&chunk, batch_size)) {
+      ReadChunk(&chunk);
+      continue;
+    }
+    if (pending_.empty()) {
+      return false;
+    }
+    CHECK(!overflow) << "number of input images must be bigger than the batch size";
+    out->num_batch_padd = batch_size - pending_.size();
+    if (batch_param_.round_batch == 0) {
+      break;
+    }
+    overflow = true;
+    ++epoch_;
+    source_->BeforeFirst();
+  }
+
+  const size_t n = std::min(batch_size, pending_.size());
+  std::vector<std::string> images(n);
+  real_t* label_dptr = static_cast<real_t*>(out->data[1].data().dptr_);
+  for (size_t i = 0; i < n; ++i) {
+    images[i]                       = std::move(pending_.front().first);
+    const std::vector<float>& label = pending_.front().second;
+    CHECK_EQ(label.size(), unit_size_[1]);
+    std::copy(label.begin(), label.end(), label_dptr + i * unit_size_[1]);
+    pending_.pop_front();
+  }
+
+  const float stds[4] = {normalize_param_.std_r,
+                          normalize_param_.std_g,
+                          normalize_param_.std_b,
+                          normalize_param_.std_a};
+  const float mean[4] = {normalize_param_.mean_r,
+                          normalize_param_.mean_g,
+                          normalize_param_.mean_b,
+                          normalize_param_.mean_a};
+  common::RANDOM_ENGINE* prnd = prnds_[0].get();
+  auto sample_crop = [&](int i, int width, int height, GPUImageCrop* crop) {
+    // If augmentation seed is supplied, draw from the stream of the position in the epoch
+    if (param_.seed_aug.has_value()) {
+      SeedSampleStream(prnd, param_.seed_aug.value(), epoch_, n_decoded_ + i);
+    }
+    const ImageCropBox box = crop_sampler_->Sample(width, height, prnd);
+    crop->x                = box.x;
+    crop->y                = box.y;
+    crop->scale_x          = box.width / param_.data_shape[2];
+    crop->scale_y          = box.height / param_.data_shape[1];
+    float contrast_scaled, illumination_scaled;
+    SampleNormalize(prnd, &crop->mirror, &contrast_scaled, &illumination_scaled);
+    for (int k = 0; k < 4; ++k) {
+      crop->mult[k] = contrast_scaled / stds[k];
+      crop->bias[k] = illumination_scaled / stds[k];
+    }
+  };
+  gpu_decoder_->Decode(
+      images, sample_crop, mean, static_cast<DType*>(out->data[0].data().dptr_));
+  n_decoded_ += n;
+  return true;
+}
+#endif
+
 // create mean image.
 template <typename DType>
 inline void ImageRecordIOParser2<DType>::CreateMeanImg() {
@@ -725,6 +1015,7 @@ class ImageRecordIter2 : public IIterator<DataBatch> {
           if (*dptr == nullptr) {
             *dptr = new DataBatch();
           }
+          profiler::DataSpan span("load batch");
           return parser_.ParseNext(*dptr);
         },
         [this]() { parser_.BeforeFirst(); });
@@ -750,6 +1041,7 @@ class ImageRecordIter2 : public IIterator<DataBatch> {
       recycle_queue_.pop();
       iter_.Recycle(&old_batch);
     }
+    profiler::DataSpan span("prefetch wait", false);
     return iter_.Next(&out_);
   }
 
@@ -26,8 +26,9 @@
 #include <dmlc/logging.h>
 #include <dmlc/parameter.h>
 #include <dmlc/data.h>
+#include <memory>
 #include "./iter_sparse_prefetcher.h"
-#include "./iter_sparse_batchloader.h"
+#include "./text_block_parser.h"
 
 namespace mxnet {
 namespace io {
@@ -45,6 +46,8 @@ struct LibSVMIterParam : public dmlc::Parameter<LibSVMIterParam> {
   int num_parts;
   /*! \brief the index of the part will read*/
   int part_index;
+  /*! \brief number of threads parsing a chunk of the files */
+  int preprocess_threads;
   // declare parameters
   DMLC_DECLARE_PARAMETER(LibSVMIterParam) {
     DMLC_DECLARE_FIELD(data_libsvm)
@@ -61,10 +64,20 @@ struct LibSVMIterParam : public dmlc::Parameter<LibSVMIterParam> {
         .describe("The shape of one label.");
     DMLC_DECLARE_FIELD(num_parts).set_default(1).describe("partition the data into multiple parts");
     DMLC_DECLARE_FIELD(part_index).set_default(0).describe("the index of the part will read");
+    DMLC_DECLARE_FIELD(preprocess_threads)
+        .set_lower_bound(1)
+        .set_default(4)
+        .describe("The number of threads parsing each chunk of the files.");
   }
 };
 
-class LibSVMIter : public SparseIIterator<DataInst> {
+/*!
+ * \brief batches of LibSVM data, built straight into CSR NDArrays
+ *
+ * The rows of a batch are spans of the blocks of a TextBlockParser, copied block by block. The
+ * arrays are handed over to the SparsePrefetcherIter, which gives them back once consumed.
+ */
+class LibSVMIter : public SparseIIterator<TBlobBatch>, public HandoffBatchLoader {
  public:
   LibSVMIter()           = default;
   ~LibSVMIter() override = default;
@@ -72,82 +85,115 @@ class LibSVMIter : public SparseIIterator<DataInst> {
   // intialize iterator loads data in
   void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) override {
     param_.InitAllowUnknown(kwargs);
+    batch_param_.InitAllowUnknown(kwargs);
     CHECK_EQ(param_.data_shape.ndim(), 1) << "dimension of data_shape is expected to be 1";
     CHECK_GT(param_.num_parts, 0) << "number of parts should be positive";
     CHECK_GE(param_.part_index, 0) << "part index should be non-negative";
-    data_parser_.reset(dmlc::Parser<uint64_t>::Create(
-        param_.data_libsvm.c_str(), param_.part_index, param_.num_parts, "libsvm"));
+    if (!batch_param_.round_batch) {
+      LOG(FATAL) << "sparse batch loader doesn't support round_batch == false yet";
+    }
+    data_parser_ = std::make_unique<TextBlockParser<real_t> >(param_.data_libsvm,
+                                                              param_.part_index,
+                                                              param_.num_parts,
+                                                              TextFormat::kLibSVM,
+                                                              param_.preprocess_threads);
+    data_reader_ = std::make_unique<TextRowReader<real_t> >(data_parser_.get());
     if (param_.label_libsvm != "NULL") {
-      label_parser_.reset(dmlc::Parser<uint64_t>::Create(
-          param_.label_libsvm.c_str(), param_.part_index, param_.num_parts, "libsvm"));
+      label_parser_ = std::make_unique<TextBlockParser<real_t> >(param_.label_libsvm,
+                                                                 param_.part_index,
+                                                                 param_.num_parts,
+                                                                 TextFormat::kLibSVM,
+                                                                 param_.preprocess_threads);
+      label_reader_ = std::make_unique<TextRowReader<real_t> >(label_parser_.get());
       CHECK_GT(param_.label_shape.Size(), 1)
           << "label_shape is not expected to be (1,) when param_.label_libsvm is set.";
     } else {
       CHECK_EQ(param_.label_shape.Size(), 1)
           << "label_shape is expected to be (1,) when param_.label_libsvm is NULL";
     }
-    // both data and label are of CSRStorage in libsvm format
-    if (param_.label_shape.Size() > 1) {
-      out_.data.resize(6);
-    } else {
-      // only data is of CSRStorage in libsvm format.
-      out_.data.resize(4);
-    }
+    inst_index_.resize(batch_param_.batch_size);
+    out_.inst_index = inst_index_.data();
   }
 
   void BeforeFirst() override {
-    data_parser_->BeforeFirst();
-    if (label_parser_.get() != nullptr) {
-      label_parser_->BeforeFirst();
+    if (num_overflow_ != 0) {
+      // the readers already started over to fill the last batch
+      num_overflow_ = 0;
+      return;
+    }
+    data_reader_->BeforeFirst();
+    if (label_reader_.get() != nullptr) {
+      label_reader_->BeforeFirst();
     }
-    data_ptr_ = label_ptr_ = 0;
-    data_size_ = label_size_ = 0;
-    inst_counter_            = 0;
-    end_                     = false;
+    inst_counter_ = 0;
   }
 
   bool Next() override {
-    if (end_)
+    const size_t batch_size = batch_param_.batch_size;
+    out_.num_batch_padd     = 0;
+    out_.batch_size         = batch_size;
+    // if overflown from previous round, directly return false, until before first is called
+    if (num_overflow_ != 0)
       return false;
-    while (data_ptr_ >= data_size_) {
-      if (!data_parser_->Next()) {
-        end_ = true;
-        return false;
-      }
-      data_ptr_  = 0;
-      data_size_ = data_parser_->Value().size;
+    data_reader_->Release();
+    data_spans_.clear();
+    if (label_reader_.get() != nullptr) {
+      label_reader_->Release();
+      label_spans_.clear();
     }
-    out_.index = inst_counter_++;
-    CHECK_LT(data_ptr_, data_size_);
-    const auto data_row = data_parser_->Value()[data_ptr_++];
-    // data, indices and indptr
-    out_.data[0] = AsDataBlob(data_row);
-    out_.data[1] = AsIdxBlob(data_row);
-    out_.data[2] = AsIndPtrPlaceholder(data_row);
-
-    if (label_parser_.get() != nullptr) {
-      while (label_ptr_ >= label_size_) {
-        CHECK(label_parser_->Next())
-            << "Data LibSVM's row is smaller than the number of rows in label_libsvm";
-        label_ptr_  = 0;
-        label_size_ = label_parser_->Value().size;
+    size_t top = TakeRows(batch_size);
+    if (top == 0) {
+      return false;
+    }
+    if (top < batch_size) {
+      // fill the batch with the first rows
+      data_reader_->Rewind();
+      if (label_reader_.get() != nullptr) {
+        label_reader_->Rewind();
+      }
+      inst_counter_ = 0;
+      while (top < batch_size) {
+        const size_t n = TakeRows(batch_size - top);
+        CHECK_GT(n, 0U) << "number of input must be bigger than batch size";
+        num_overflow_ += n;
+        top += n;
       }
-      CHECK_LT(label_ptr_, label_size_);
-      const auto label_row = label_parser_->Value()[label_ptr_++];
-      // data, indices and indptr
-      out_.data[3] = AsDataBlob(label_row);
-      out_.data[4] = AsIdxBlob(label_row);
-      out_.data[5] = AsIndPtrPlaceholder(label_row);
+      out_.num_batch_padd = num_overflow_;
+    }
+    if (arrays_.empty()) {
+      NewArrays();
+    }
+    FillCSR(data_spans_, &arrays_[0]);
+    if (label_reader_.get() != nullptr) {
+      FillCSR(label_spans_, &arrays_[1]);
     } else {
-      out_.data[3] = AsScalarLabelBlob(data_row);
+      FillLabel(data_spans_, &arrays_[1]);
+    }
+    out_.data.clear();
+    for (const auto& arr : arrays_) {
+      out_.data.push_back(arr.data());
+      if (arr.storage_type() == kCSRStorage) {
+        out_.data.push_back(arr.aux_data(csr::kIdx));
+        out_.data.push_back(arr.aux_data(csr::kIndPtr));
+      }
     }
     return true;
   }
 
-  const DataInst& Value() const override {
+  const TBlobBatch& Value() const override {
     return out_;
   }
 
+  void TakeArrays(std::vector<NDArray>* arrays) override {
+    *arrays = std::move(arrays_);
+    arrays_.clear();
+  }
+
+  void RecycleArrays(std::vector<NDArray>* arrays) override {
+    free_arrays_.push_back(std::move(*arrays));
+    arrays->clear();
+  }
+
   const NDArrayStorageType GetStorageType(bool is_data) const override {
     if (is_data)
       return kCSRStorage;
@@ -155,45 +201,115 @@ class LibSVMIter : public SparseIIterator<DataInst> {
   }
 
   const mxnet::TShape GetShape(bool is_data) const override {
-    if (is_data)
-      return param_.data_shape;
-    return param_.label_shape;
+    const mxnet::TShape& inst_shape = is_data ? param_.data_shape : param_.label_shape;
+    std::vector<index_t> shape_vec;
+    shape_vec.push_back(batch_param_.batch_size);
+    for (index_t dim = 0; dim < inst_shape.ndim(); ++dim) {
+      shape_vec.push_back(inst_shape[dim]);
+    }
+    return mxnet::TShape(shape_vec.begin(), shape_vec.end());
   }
 
  private:
-  inline TBlob AsDataBlob(const dmlc::Row<uint64_t>& row) {
-    const real_t* ptr = row.value;
-    mxnet::TShape shape(mshadow::Shape1(row.length));
-    return TBlob((real_t*)ptr, shape, cpu::kDevMask);  // NOLINT(*)
+  using Span = TextRowReader<real_t>::Span;
+
+  /*! \brief take at most n rows of data and as many of label, and return their number */
+  size_t TakeRows(size_t n) {
+    const size_t taken = data_reader_->Take(n, &data_spans_);
+    if (label_reader_.get() != nullptr) {
+      CHECK_EQ(label_reader_->Take(taken, &label_spans_), taken)
+          << "Data LibSVM's row is smaller than the number of rows in label_libsvm";
+    }
+    const size_t top = data_spans_.empty() ? 0 : NumRows(data_spans_) - taken;
+    for (size_t i = 0; i < taken; ++i) {
+      inst_index_[top + i] = inst_counter_++;
+    }
+    return taken;
+  }
+
+  static size_t NumRows(const std::vector<Span>& spans) {
+    size_t n = 0;
+    for (const auto& span : spans) {
+      n += span.end - span.begin;
+    }
+    return n;
   }
 
-  inline TBlob AsIdxBlob(const dmlc::Row<uint64_t>& row) {
-    const uint64_t* ptr = row.index;
-    mxnet::TShape shape(mshadow::Shape1(row.length));
-    return TBlob((int64_t*)ptr, shape, cpu::kDevMask, mshadow::kInt64);  // NOLINT(*)
+  /*! \brief the arrays of a batch the prefetcher is done with, or new ones */
+  void NewArrays() {
+    if (!free_arrays_.empty()) {
+      arrays_ = std::move(free_arrays_.back());
+      free_arrays_.pop_back();
+      return;
+    }
+    arrays_.emplace_back(kCSRStorage, GetShape(true), Context::CPU(), true, mshadow::kFloat32);
+    if (GetStorageType(false) == kCSRStorage) {
+      arrays_.emplace_back(kCSRStorage, GetShape(false), Context::CPU(), true, mshadow::kFloat32);
+    } else {
+      // a dense label is one value per row
+      const mxnet::TShape label_shape(mshadow::Shape1(batch_param_.batch_size));
+      arrays_.emplace_back(label_shape, Context::CPU(), false, mshadow::kFloat32);
+    }
   }
 
-  inline TBlob AsIndPtrPlaceholder(const dmlc::Row<uint64_t>& row) {
-    return TBlob(nullptr, mshadow::Shape1(0), cpu::kDevMask, mshadow::kInt64);
+  /*! \brief copy the rows of spans into a CSR array, one block after the other */
+  static void FillCSR(const std::vector<Span>& spans, NDArray* arr) {
+    size_t nnz = 0;
+    for (const auto& span : spans) {
+      nnz += span.block->offset[span.end] - span.block->offset[span.begin];
+    }
+    arr->CheckAndAllocAuxData(csr::kIdx, mshadow::Shape1(nnz));
+    arr->CheckAndAllocData(mshadow::Shape1(nnz));
+    arr->CheckAndAllocAuxData(csr::kIndPtr, mshadow::Shape1(NumRows(spans) + 1));
+    real_t* value   = arr->data().dptr<real_t>();
+    int64_t* index  = arr->aux_data(csr::kIdx).dptr<int64_t>();
+    int64_t* indptr = arr->aux_data(csr::kIndPtr).dptr<int64_t>();
+    indptr[0]       = 0;
+    size_t pos      = 0;
+    for (const auto& span : spans) {
+      const TextBlock<real_t>& block = *span.block;
+      const size_t begin             = block.offset[span.begin];
+      const size_t end               = block.offset[span.end];
+      std::copy(block.value.begin() + begin, block.value.begin() + end, value + pos);
+      std::copy(block.index.begin() + begin, block.index.begin() + end, index + pos);
+      for (size_t r = span.begin; r < span.end; ++r) {
+        *++indptr = pos + block.offset[r + 1] - begin;
+      }
+      pos += end - begin;
+    }
   }
 
-  inline TBlob AsScalarLabelBlob(const dmlc::Row<uint64_t>& row) {
-    const real_t* ptr = row.label;
-    return TBlob((real_t*)ptr, mshadow::Shape1(1), cpu::kDevMask);  // NOLINT(*)
+  /*! \brief copy the labels of the rows of spans into a dense array */
+  static void FillLabel(const std::vector<Span>& spans, NDArray* arr) {
+    real_t* label = arr->data().dptr<real_t>();
+    for (const auto& span : spans) {
+      label = std::copy(span.block->label.begin() + span.begin,
+                        span.block->label.begin() + span.end,
+                        label);
+    }
   }
 
   LibSVMIterParam param_;
-  // output instance
-  DataInst out_;
+  BatchParam batch_param_;
+  // output batch
+  TBlobBatch out_;
+  std::vector<unsigned> inst_index_;
   // internal instance counter
   unsigned inst_counter_{0};
-  // at end
-  bool end_{false};
-  // label parser
-  size_t label_ptr_{0}, label_size_{0};
-  size_t data_ptr_{0}, data_size_{0};
-  std::unique_ptr<dmlc::Parser<uint64_t> > label_parser_;
-  std::unique_ptr<dmlc::Parser<uint64_t> > data_parser_;
+  // number of rows from the start the last batch was filled with
+  size_t num_overflow_{0};
+  std::unique_ptr<TextBlockParser<real_t> > label_parser_;
+  std::unique_ptr<TextBlockParser<real_t> > data_parser_;
+  // readers of the rows of the parsers, destroyed before them
+  std::unique_ptr<TextRowReader<real_t> > label_reader_;
+  std::unique_ptr<TextRowReader<real_t> > data_reader_;
+  // rows of the batch
+  std::vector<Span> data_spans_;
+  std::vector<Span> label_spans_;
+  // data and label of the batch
+  std::vector<NDArray> arrays_;
+  // arrays given back by the prefetcher
+  std::vector<std::vector<NDArray> > free_arrays_;
 };
 
 DMLC_REGISTER_PARAMETER(LibSVMIterParam);
@@ -300,7 +416,7 @@ Example::
     .add_arguments(LibSVMIterParam::__FIELDS__())
     .add_arguments(BatchParam::__FIELDS__())
     .add_arguments(PrefetcherParam::__FIELDS__())
-    .set_body([]() { return new SparsePrefetcherIter(new SparseBatchLoader(new LibSVMIter())); });
+    .set_body([]() { return new SparsePrefetcherIter(new LibSVMIter()); });
 
 }  // namespace io
 }  // namespace mxnet
@@ -39,9 +39,31 @@
 #include <algorithm>
 #include "./inst_vector.h"
 #include "./image_iter_common.h"
+#include "../profiler/data_profiler.h"
 
 namespace mxnet {
 namespace io {
+/*!
+ * \brief interface of a batch loader whose batches are NDArrays it can hand over to the
+ *  prefetcher
+ *
+ * When the prefetcher needs neither another context nor another type, it takes the arrays
+ * of each batch instead of copying them, and gives the arrays of the batches it recycles
+ * back to the loader, which loads later batches into them.
+ */
+class HandoffBatchLoader {
+ public:
+  virtual ~HandoffBatchLoader() {}
+  /*! \brief move the arrays of the batch returned by the last Next into arrays */
+  virtual void TakeArrays(std::vector<NDArray>* arrays) = 0;
+  /*! \brief give back arrays from TakeArrays which are not read or written anymore */
+  virtual void RecycleArrays(std::vector<NDArray>* arrays) = 0;
+  /*! \brief the context of the arrays TakeArrays moves */
+  virtual Context ArraysContext() const {
+    return Context::CPU();
+  }
+};
+
 // iterator on image recordio
 class PrefetcherIter : public IIterator<DataBatch> {
  public:
@@ -74,38 +96,34 @@ class PrefetcherIter : public IIterator<DataBatch> {
     // use the kwarg to init batch loader
     loader_->Init(kwargs);
     length_hint_ = loader_->GetLenHint();
+    // take the arrays of the loader when they are in the context of the batches already
+    auto* handoff     = dynamic_cast<HandoffBatchLoader*>(loader_.get());
+    const Context ctx = UsePinned() ? Context::CPUPinned(param_.device_id) : Context::CPU();
+    if (handoff != nullptr && handoff->ArraysContext() == ctx) {
+      handoff_ = handoff;
+    }
     iter.Init(
         [this](DataBatch** dptr) {
+          if (*dptr == nullptr) {
+            *dptr = new DataBatch();
+          } else if (handoff_ != nullptr) {
+            // the consumer is done with the recycled batch, load a later batch into its arrays
+            handoff_->RecycleArrays(&(*dptr)->data);
+          }
           if (!loader_->Next())
             return false;
           const TBlobBatch& batch = loader_->Value();
-          if (*dptr == nullptr) {
-            // allocate databatch
-            *dptr                   = new DataBatch();
-            (*dptr)->num_batch_padd = batch.num_batch_padd;
-            (*dptr)->data.resize(batch.data.size());
-            (*dptr)->index.resize(batch.batch_size);
-            for (size_t i = 0; i < batch.data.size(); ++i) {
-              auto dtype = param_.dtype ? param_.dtype.value() : batch.data[i].type_flag_;
-              auto ctx = ((param_.ctx == PrefetcherParam::kCPUPinned) && (param_.device_id >= 0)) ?
-                             Context::CPUPinned(param_.device_id) :
-                             Context::CPU();
-              (*dptr)->data.at(i) = NDArray(batch.data[i].shape_, ctx, false, dtype);
-            }
+          (*dptr)->num_batch_padd = batch.num_batch_padd;
+          (*dptr)->index.resize(batch.batch_size);
+          if (handoff_ != nullptr && !CanHandOff(batch)) {
+            // the arrays need another type, copy this and all later batches
+            handoff_ = nullptr;
           }
-          CHECK(batch.data.size() == (*dptr)->data.size());
-          // copy data over
-          for (size_t i = 0; i < batch.data.size(); ++i) {
-            if ((*dptr)->data.at(i).shape() != batch.data[i].shape_) {
-              // TODO(zhreshold): memory pool for dynamic shaped data
-              (*dptr)->data.at(i).ReshapeAndAlloc(batch.data[i].shape_);
-            }
-            CHECK_EQ((*dptr)->data.at(i).shape(), batch.data[i].shape_);
-            MSHADOW_TYPE_SWITCH(batch.data[i].type_flag_, DType, {
-              mshadow::Copy(((*dptr)->data)[i].data().FlatTo2D<cpu, DType>(),
-                            batch.data[i].FlatTo2D<cpu, DType>());
-            });
-            (*dptr)->num_batch_padd = batch.num_batch_padd;
+          if (handoff_ != nullptr) {
+            handoff_->TakeArrays(&(*dptr)->data);
+          } else {
+            profiler::DataSpan span("batchify");
+            CopyBatch(batch, *dptr);
           }
           if (batch.inst_index) {
             std::copy(
@@ -142,12 +160,29 @@ class PrefetcherIter : public IIterator<DataBatch> {
       recycle_queue_.pop();
       iter.Recycle(&old_batch);
     }
+    profiler::DataSpan span("prefetch wait", false);
     return iter.Next(&out_);
   }
   virtual const DataBatch& Value(void) const {
     return *out_;
   }
 
+  /*!
+   * \brief reshape an array of a batch in place when its storage is large enough, else onto
+   *  a storage larger than needed, so that batches of varying shapes soon stop allocating
+   */
+  static void ReshapeWithCapacity(const TShape& shape, NDArray* arr) {
+    if (arr->shape() == shape) {
+      return;
+    }
+    const size_t bytes = shape.Size() * mshadow::mshadow_sizeof(arr->dtype());
+    if (arr->storage_handle().size < bytes) {
+      const TShape capacity({static_cast<dim_t>(shape.Size() + shape.Size() / 2)});
+      *arr = NDArray(capacity, arr->ctx(), false, arr->dtype());
+    }
+    *arr = arr->AsArray(shape, arr->dtype());
+  }
+
  protected:
   /*! \brief prefetcher parameters */
   PrefetcherParam param_;
@@ -156,7 +191,45 @@ class PrefetcherIter : public IIterator<DataBatch> {
   /*! \brief internal batch loader */
   std::unique_ptr<IIterator<TBlobBatch> > loader_;
 
+  /*! \brief whether the arrays of the loader can be used as they are */
+  bool CanHandOff(const TBlobBatch& batch) const {
+    for (const auto& blob : batch.data) {
+      if (param_.dtype && param_.dtype.value() != blob.type_flag_) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /*! \brief the loader if it hands its arrays over */
+  HandoffBatchLoader* handoff_ = nullptr;
+
  private:
+  bool UsePinned() const {
+    return param_.ctx == PrefetcherParam::kCPUPinned && param_.device_id >= 0;
+  }
+
+  /*! \brief copy a batch into the arrays of out, allocated the first time */
+  void CopyBatch(const TBlobBatch& batch, DataBatch* out) {
+    if (out->data.size() != batch.data.size()) {
+      out->data.resize(batch.data.size());
+      for (size_t i = 0; i < batch.data.size(); ++i) {
+        auto dtype = param_.dtype ? param_.dtype.value() : batch.data[i].type_flag_;
+        auto ctx   = UsePinned() ? Context::CPUPinned(param_.device_id) : Context::CPU();
+        out->data.at(i) = NDArray(batch.data[i].shape_, ctx, false, dtype);
+      }
+    }
+    // copy data over
+    for (size_t i = 0; i < batch.data.size(); ++i) {
+      ReshapeWithCapacity(batch.data[i].shape_, &out->data.at(i));
+      CHECK_EQ(out->data.at(i).shape(), batch.data[i].shape_);
+      MSHADOW_TYPE_SWITCH(batch.data[i].type_flag_, DType, {
+        mshadow::Copy(out->data[i].data().FlatTo2D<cpu, DType>(),
+                      batch.data[i].FlatTo2D<cpu, DType>());
+      });
+    }
+  }
+
   /*! \brief output data */
   DataBatch* out_;
   /*! \brief queue to be recycled */
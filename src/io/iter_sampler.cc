@@ -26,11 +26,13 @@
 #include <mxnet/io.h>
 #include <mxnet/base.h>
 #include <mxnet/resource.h>
+#include <algorithm>
 #include <memory>
 #include <numeric>
 #include "../common/utils.h"
 #include "./iter_batchloader.h"
 #include "./iter_prefetcher.h"
+#include "./sample_random.h"
 
 namespace mxnet {
 namespace io {
@@ -175,5 +177,162 @@ MXNET_REGISTER_IO_ITER(RandomSampler)
     .add_arguments(BatchSamplerParam::__FIELDS__())
     .set_body([]() { return new BatchSampler(new RandomSampler()); });
 
+struct ShardedBlockSamplerParam : public dmlc::Parameter<ShardedBlockSamplerParam> {
+  /*! \brief Length of the sequence. */
+  size_t length;
+  /*! \brief number of parts the sequence is split into */
+  int num_parts;
+  /*! \brief the part sampled */
+  int part_index;
+  /*! \brief number of contiguous records shuffled together */
+  size_t block_size;
+  /*! \brief number of records of the part shuffled together after the blocks */
+  size_t window_size;
+  /*! \brief seed of the orders, which must be the same in all the parts */
+  int seed;
+  /*! \brief epoch of the first pass */
+  size_t epoch;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(ShardedBlockSamplerParam) {
+    DMLC_DECLARE_FIELD(length).describe("Length of the sequence.");
+    DMLC_DECLARE_FIELD(num_parts).set_default(1).describe(
+        "Number of parts the sequence is split into, usually the number of workers.");
+    DMLC_DECLARE_FIELD(part_index).set_default(0).describe(
+        "The part sampled, usually the rank of the worker.");
+    DMLC_DECLARE_FIELD(block_size)
+        .set_default(64)
+        .describe(
+            "Number of contiguous indices whose blocks are shuffled, "
+            "so that the records of a block are read together.");
+    DMLC_DECLARE_FIELD(window_size)
+        .set_default(1024)
+        .describe("Number of consecutive indices of the part shuffled together after the blocks.");
+    DMLC_DECLARE_FIELD(seed).set_default(0).describe(
+        "Seed of the orders, which must be the same for all the parts.");
+    DMLC_DECLARE_FIELD(epoch).set_default(0).describe(
+        "Epoch of the first pass, to resume the orders of a run.");
+  }
+};  // struct ShardedBlockSamplerParam
+
+DMLC_REGISTER_PARAMETER(ShardedBlockSamplerParam);
+
+/*!
+ * \brief samples a part of [0, length) in shuffled blocks of contiguous indices, shuffled
+ *  again within windows
+ *
+ * The blocks are shuffled the same way in all the parts, and each part takes a contiguous
+ * range of the shuffled blocks, so the parts are disjoint. The orders only depend on the seed,
+ * the epoch and the part.
+ */
+class ShardedBlockSampler : public IIterator<DataInst> {
+ public:
+  void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) override {
+    param_.InitAllowUnknown(kwargs);
+    CHECK_GT(param_.num_parts, 0) << "num_parts must be positive";
+    CHECK(param_.part_index >= 0 && param_.part_index < param_.num_parts)
+        << "part_index must be in [0, num_parts)";
+    CHECK_GT(param_.block_size, 0) << "block_size must be positive";
+    CHECK_GT(param_.window_size, 0) << "window_size must be positive";
+    epoch_ = param_.epoch;
+    out_.data.resize(1);
+    Shuffle();
+  }
+
+  void BeforeFirst() override {
+    // a pass which has not sampled anything does not start another epoch
+    if (pos_ > 0) {
+      ++epoch_;
+      Shuffle();
+    }
+  }
+
+  int64_t GetLenHint() const override {
+    return static_cast<int64_t>(indices_.size());
+  }
+
+  bool Next() override {
+    if (pos_ < indices_.size()) {
+      int64_t* ptr = indices_.data() + pos_;
+      out_.data[0] = TBlob(ptr,
+                           TShape({
+                               1,
+                           }),
+                           cpu::kDevMask,
+                           0);
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  const DataInst& Value() const override {
+    return out_;
+  }
+
+ private:
+  /*! \brief sample the indices of the part for epoch_ */
+  void Shuffle() {
+    const size_t length     = param_.length;
+    const size_t block_size = param_.block_size;
+    std::vector<size_t> blocks((length + block_size - 1) / block_size);
+    std::iota(std::begin(blocks), std::end(blocks), 0);
+    common::RANDOM_ENGINE rng;
+    SeedSampleStream(&rng, param_.seed, epoch_, 0);
+    std::shuffle(std::begin(blocks), std::end(blocks), rng);
+    // all parts have the same length, the last ones wrapping around the shuffled blocks
+    const size_t part_length = (length + param_.num_parts - 1) / param_.num_parts;
+    const size_t begin       = param_.part_index * part_length;
+    indices_.clear();
+    indices_.reserve(part_length);
+    size_t pos = 0;
+    for (size_t b = 0; indices_.size() < part_length; b = (b + 1) % blocks.size()) {
+      const size_t first = blocks[b] * block_size;
+      const size_t last  = std::min(first + block_size, length);
+      for (size_t i = first; i < last && indices_.size() < part_length; ++i, ++pos) {
+        if (pos >= begin) {
+          indices_.push_back(static_cast<int64_t>(i));
+        }
+      }
+    }
+    SeedSampleStream(&rng, param_.seed, epoch_, 1 + param_.part_index);
+    for (size_t w = 0; w < indices_.size(); w += param_.window_size) {
+      const size_t end = std::min(w + param_.window_size, indices_.size());
+      std::shuffle(indices_.begin() + w, indices_.begin() + end, rng);
+    }
+    pos_ = 0;
+  }
+
+  /*! \brief Stored integer indices */
+  std::vector<int64_t> indices_;
+  /*! \brief current position for iteration */
+  std::size_t pos_ = 0;
+  /*! \brief number of the current pass */
+  size_t epoch_ = 0;
+  /*! \brief data for next value */
+  DataInst out_;
+  /*! \brief arguments */
+  ShardedBlockSamplerParam param_;
+};  // class ShardedBlockSampler
+
+MXNET_REGISTER_IO_ITER(ShardedBlockSampler)
+    .describe(R"code(Returns a sampler iterator of a part of the sequence, for distributed training.
+
+The sequence is split into blocks of ``block_size`` contiguous indices, the blocks are shuffled
+and split into ``num_parts`` contiguous parts of the same size, and the indices of the part
+``part_index`` are shuffled again within windows of ``window_size`` indices. The records of a
+block are thus read close together, which keeps reads over network filesystems near sequential.
+The orders only depend on ``seed``, the epoch and the part, and change at each pass.
+
+Example::
+
+  sampler = mx.gluon.data._internal.MXSampler(
+      'ShardedBlockSampler', length=len(dataset), num_parts=kv.num_workers,
+      part_index=kv.rank, batch_size=64, last_batch='discard')
+  loader = mx.gluon.data.DataLoader(dataset, batch_sampler=sampler)
+)code" ADD_FILELINE)
+    .add_arguments(ShardedBlockSamplerParam::__FIELDS__())
+    .add_arguments(BatchSamplerParam::__FIELDS__())
+    .set_body([]() { return new BatchSampler(new ShardedBlockSampler()); });
+
 }  // namespace io
 }  // namespace mxnet
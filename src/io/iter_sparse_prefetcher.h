@@ -56,60 +56,29 @@ class SparsePrefetcherIter : public PrefetcherIter {
     PrefetcherIter::InitParams(kwargs);
     // use the kwarg to init batch loader
     sparse_loader_->Init(kwargs);
+    handoff_ = dynamic_cast<HandoffBatchLoader*>(sparse_loader_);
     iter.Init(
         [this](DataBatch** dptr) {
+          if (*dptr != nullptr && handoff_ != nullptr) {
+            // build a later batch into the arrays of the recycled one
+            handoff_->RecycleArrays(&(*dptr)->data);
+          }
           if (!sparse_loader_->Next())
             return false;
           const TBlobBatch& batch = sparse_loader_->Value();
           if (*dptr == nullptr) {
-            // allocate databatch
-            *dptr                   = new DataBatch();
-            (*dptr)->num_batch_padd = batch.num_batch_padd;
-            // (*dptr)->data.at(0) => data
-            // (*dptr)->data.at(1) => label
-            (*dptr)->data.resize(2);
-            (*dptr)->index.resize(batch.batch_size);
-            size_t data_iter = 0;
-            for (size_t i = 0; i < (*dptr)->data.size(); ++i) {
-              bool is_data = i == 0;
-              auto stype   = this->GetStorageType(is_data);
-              auto dtype   = param_.dtype ? param_.dtype.value() : batch.data[data_iter].type_flag_;
-              if (stype == kDefaultStorage) {
-                (*dptr)->data.at(i) =
-                    NDArray(batch.data[data_iter].shape_, Context::CPU(), false, dtype);
-              } else {
-                (*dptr)->data.at(i) =
-                    NDArray(stype, this->GetShape(is_data), Context::CPU(), false, dtype);
-              }
-              data_iter += num_aux_data(stype) + 1;
-            }
+            *dptr = new DataBatch();
+          }
+          (*dptr)->num_batch_padd = batch.num_batch_padd;
+          (*dptr)->index.resize(batch.batch_size);
+          if (handoff_ != nullptr && !CanHandOffValues(batch)) {
+            // the arrays need another type, copy this and all later batches
+            handoff_ = nullptr;
           }
-          // copy data over
-          size_t data_iter = 0;
-          for (size_t i = 0; i < (*dptr)->data.size(); ++i) {
-            auto& nd     = ((*dptr)->data)[i];
-            auto stype   = nd.storage_type();
-            auto& data_i = ((*dptr)->data)[i];
-            if (stype == kDefaultStorage) {
-              CopyFromTo(data_i.data(), batch.data[data_iter]);
-            } else if (stype == kCSRStorage) {
-              auto& values  = batch.data[data_iter];
-              auto& indices = batch.data[data_iter + 1];
-              auto& indptr  = batch.data[data_iter + 2];
-              // allocate memory
-              CHECK_EQ(indices.shape_.Size(), values.shape_.Size());
-              nd.CheckAndAllocAuxData(csr::kIdx, indices.shape_);
-              nd.CheckAndAllocData(values.shape_);
-              nd.CheckAndAllocAuxData(csr::kIndPtr, indptr.shape_);
-              // copy values, indices and indptr
-              CopyFromTo(data_i.data(), values);
-              CopyFromTo(data_i.aux_data(csr::kIdx), indices);
-              CopyFromTo(data_i.aux_data(csr::kIndPtr), indptr);
-            } else {
-              LOG(FATAL) << "Storage type not implemented: " << stype;
-            }
-            data_iter += num_aux_data(stype) + 1;
-            (*dptr)->num_batch_padd = batch.num_batch_padd;
+          if (handoff_ != nullptr) {
+            handoff_->TakeArrays(&(*dptr)->data);
+          } else {
+            CopySparseBatch(batch, *dptr);
           }
           if (batch.inst_index) {
             std::copy(
@@ -143,6 +112,62 @@ class SparsePrefetcherIter : public PrefetcherIter {
   /*! \brief internal sparse batch loader */
   SparseIIterator<TBlobBatch>* sparse_loader_;
 
+  /*! \brief whether the values of data and label have the type to return */
+  bool CanHandOffValues(const TBlobBatch& batch) const {
+    if (!param_.dtype) {
+      return true;
+    }
+    const size_t label_iter = num_aux_data(this->GetStorageType(true)) + 1;
+    return batch.data[0].type_flag_ == param_.dtype.value() &&
+           batch.data[label_iter].type_flag_ == param_.dtype.value();
+  }
+
+  /*! \brief copy a batch into the arrays of out, allocated the first time */
+  void CopySparseBatch(const TBlobBatch& batch, DataBatch* out) {
+    if (out->data.empty()) {
+      // out->data.at(0) => data
+      // out->data.at(1) => label
+      out->data.resize(2);
+      size_t data_iter = 0;
+      for (size_t i = 0; i < out->data.size(); ++i) {
+        bool is_data = i == 0;
+        auto stype   = this->GetStorageType(is_data);
+        auto dtype   = param_.dtype ? param_.dtype.value() : batch.data[data_iter].type_flag_;
+        if (stype == kDefaultStorage) {
+          out->data.at(i) = NDArray(batch.data[data_iter].shape_, Context::CPU(), false, dtype);
+        } else {
+          out->data.at(i) = NDArray(stype, this->GetShape(is_data), Context::CPU(), false, dtype);
+        }
+        data_iter += num_aux_data(stype) + 1;
+      }
+    }
+    // copy data over
+    size_t data_iter = 0;
+    for (size_t i = 0; i < out->data.size(); ++i) {
+      auto& nd   = out->data[i];
+      auto stype = nd.storage_type();
+      if (stype == kDefaultStorage) {
+        CopyFromTo(nd.data(), batch.data[data_iter]);
+      } else if (stype == kCSRStorage) {
+        auto& values  = batch.data[data_iter];
+        auto& indices = batch.data[data_iter + 1];
+        auto& indptr  = batch.data[data_iter + 2];
+        // allocate memory
+        CHECK_EQ(indices.shape_.Size(), values.shape_.Size());
+        nd.CheckAndAllocAuxData(csr::kIdx, indices.shape_);
+        nd.CheckAndAllocData(values.shape_);
+        nd.CheckAndAllocAuxData(csr::kIndPtr, indptr.shape_);
+        // copy values, indices and indptr
+        CopyFromTo(nd.data(), values);
+        CopyFromTo(nd.aux_data(csr::kIdx), indices);
+        CopyFromTo(nd.aux_data(csr::kIndPtr), indptr);
+      } else {
+        LOG(FATAL) << "Storage type not implemented: " << stype;
+      }
+      data_iter += num_aux_data(stype) + 1;
+    }
+  }
+
   inline void CopyFromTo(TBlob dst, const TBlob src) {
     MSHADOW_TYPE_SWITCH(src.type_flag_, DType, {
       mshadow::Copy(dst.FlatTo1D<cpu, DType>(), src.FlatTo1D<cpu, DType>());
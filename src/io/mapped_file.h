@@ -0,0 +1,98 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file mapped_file.h
+ * \brief a local file mapped into memory
+ */
+#ifndef MXNET_IO_MAPPED_FILE_H_
+#define MXNET_IO_MAPPED_FILE_H_
+
+#ifndef _WIN32
+#include <dmlc/logging.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+namespace mxnet {
+namespace io {
+
+/*! \brief a local file mapped into memory, copy-on-write */
+class MappedFile {
+ public:
+  /*!
+   * \param path the file
+   * \param random_access whether the file is read in random order, else sequentially
+   */
+  MappedFile(const std::string& path, bool random_access) {
+    int fd = open(path.c_str(), O_RDONLY);
+    CHECK_NE(fd, -1) << "Failed to open " << path << ": " << strerror(errno);
+    struct stat st;
+    CHECK_EQ(fstat(fd, &st), 0) << "Failed to stat " << path << ": " << strerror(errno);
+    size_ = st.st_size;
+    if (size_ > 0) {
+      // private and writable, so that in-place changes of the data never reach the file
+      void* addr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      CHECK_NE(addr, MAP_FAILED) << "Failed to map " << path << ": " << strerror(errno);
+      data_ = static_cast<char*>(addr);
+      // with random access, the reader reads ahead by WillNeed
+      madvise(data_, size_, random_access ? MADV_RANDOM : MADV_SEQUENTIAL);
+    }
+    close(fd);
+    page_size_ = sysconf(_SC_PAGESIZE);
+  }
+
+  ~MappedFile() {
+    if (data_ != nullptr) {
+      munmap(data_, size_);
+    }
+  }
+
+  char* data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  /*! \brief ask the kernel to read the bytes [begin, end) of the file ahead */
+  void WillNeed(size_t begin, size_t end) const {
+    end   = std::min(end, size_);
+    begin = begin / page_size_ * page_size_;
+    if (begin < end) {
+      madvise(data_ + begin, end - begin, MADV_WILLNEED);
+    }
+  }
+
+ private:
+  char* data_ = nullptr;
+  size_t size_;
+  size_t page_size_;
+};
+
+}  // namespace io
+}  // namespace mxnet
+#endif  // _WIN32
+#endif  // MXNET_IO_MAPPED_FILE_H_
@@ -0,0 +1,73 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sample_random.h
+ * \brief counter-based random streams of the samples of an epoch
+ */
+#ifndef MXNET_IO_SAMPLE_RANDOM_H_
+#define MXNET_IO_SAMPLE_RANDOM_H_
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include "../common/utils.h"
+
+namespace mxnet {
+namespace io {
+
+/*! \brief the Philox4x32-10 bijection of counter under key, as curand's Philox4_32_10 */
+inline std::array<uint32_t, 4> Philox4x32(std::array<uint32_t, 4> ctr,
+                                          std::array<uint32_t, 2> key) {
+  for (int round = 0; round < 10; ++round) {
+    const uint64_t p0 = static_cast<uint64_t>(0xD2511F53U) * ctr[0];
+    const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57U) * ctr[2];
+    const uint32_t c1 = ctr[1], c3 = ctr[3];
+    ctr[0]            = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ key[0];
+    ctr[1]            = static_cast<uint32_t>(p1);
+    ctr[2]            = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ key[1];
+    ctr[3]            = static_cast<uint32_t>(p0);
+    key[0] += 0x9E3779B9U;
+    key[1] += 0xBB67AE85U;
+  }
+  return ctr;
+}
+
+/*!
+ * \brief seed the engine of a thread with the stream of a sample
+ *
+ * The stream depends on (seed, epoch, index) only, so that the augmentations of a sample do
+ * not depend on which thread processes it, nor on the samples that thread processed before.
+ */
+inline void SeedSampleStream(common::RANDOM_ENGINE* prnd,
+                             uint32_t seed,
+                             uint64_t epoch,
+                             uint64_t index) {
+  const std::array<uint32_t, 4> words = Philox4x32({static_cast<uint32_t>(index),
+                                                    static_cast<uint32_t>(index >> 32),
+                                                    static_cast<uint32_t>(epoch),
+                                                    static_cast<uint32_t>(epoch >> 32)},
+                                                   {seed, 0x6D786E65U});
+  std::seed_seq seq(words.begin(), words.end());
+  prnd->seed(seq);
+}
+
+}  // namespace io
+}  // namespace mxnet
+#endif  // MXNET_IO_SAMPLE_RANDOM_H_
@@ -0,0 +1,270 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sharded_input_split.cc
+ * \brief streaming of records from RecordIO shards, read whole by concurrent range reads
+ */
+#include "./sharded_input_split.h"
+
+#include <dmlc/common.h>
+#include <dmlc/logging.h>
+#include <dmlc/memory_io.h>
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <numeric>
+#include <thread>
+
+namespace mxnet {
+namespace io {
+
+ShardedInputSplit::ShardedInputSplit(const std::string& uri,
+                                     unsigned part_index,
+                                     unsigned num_parts,
+                                     bool shuffle,
+                                     int seed,
+                                     size_t shuffle_buffer,
+                                     int prefetch_shards,
+                                     int num_range_reads)
+    : part_index_(part_index),
+      num_parts_(num_parts),
+      shuffle_(shuffle),
+      seed_(seed),
+      shuffle_buffer_(shuffle_buffer),
+      num_range_reads_(num_range_reads),
+      rnd_(seed) {
+  CHECK_LT(part_index_, num_parts_) << "part_index must be smaller than num_parts";
+  CHECK_GT(prefetch_shards, 0) << "prefetch_shards must be positive";
+  CHECK_GT(num_range_reads_, 0) << "num_range_reads must be positive";
+  ListShards(uri);
+  CHECK_GE(shards_.size(), num_parts_)
+      << "Only " << shards_.size() << " shards in " << uri << " to split in " << num_parts_
+      << " parts";
+  NextEpoch();
+  prefetcher_.set_max_capacity(prefetch_shards);
+  prefetcher_.Init(
+      [this](std::string** dptr) {
+        if (next_shard_ == epoch_shards_.size()) {
+          return false;
+        }
+        if (*dptr == nullptr) {
+          *dptr = new std::string();
+        }
+        ReadShard(shards_[epoch_shards_[next_shard_++]], *dptr);
+        return true;
+      },
+      [this]() { NextEpoch(); });
+}
+
+ShardedInputSplit::~ShardedInputSplit() {
+  reader_.reset();
+  if (shard_ != nullptr) {
+    prefetcher_.Recycle(&shard_);
+  }
+  prefetcher_.Destroy();
+}
+
+void ShardedInputSplit::ListShards(const std::string& uri) {
+  for (const std::string& name : dmlc::Split(uri, ';')) {
+    if (name.empty()) {
+      continue;
+    }
+    const dmlc::io::URI path(name.c_str());
+    dmlc::io::FileSystem* fs      = dmlc::io::FileSystem::GetInstance(path);
+    const dmlc::io::FileInfo info = fs->GetPathInfo(path);
+    if (info.type != dmlc::io::kDirectory) {
+      shards_.push_back(info);
+      continue;
+    }
+    // the .rec files of a directory, without the .idx files next to them
+    std::vector<dmlc::io::FileInfo> files;
+    fs->ListDirectory(path, &files);
+    for (const auto& file : files) {
+      const std::string file_name = file.path.str();
+      if (file.type == dmlc::io::kFile && file_name.size() > 4 &&
+          file_name.compare(file_name.size() - 4, 4, ".rec") == 0) {
+        shards_.push_back(file);
+      }
+    }
+  }
+  std::sort(shards_.begin(), shards_.end(), [](const auto& a, const auto& b) {
+    return a.path.str() < b.path.str();
+  });
+}
+
+void ShardedInputSplit::NextEpoch() {
+  std::vector<size_t> order(shards_.size());
+  std::iota(order.begin(), order.end(), 0);
+  if (shuffle_) {
+    // the same order on all parts, so that the parts read disjoint shards
+    std::mt19937 rnd(seed_ + epoch_);
+    std::shuffle(order.begin(), order.end(), rnd);
+  }
+  epoch_shards_.clear();
+  for (size_t i = part_index_; i < order.size(); i += num_parts_) {
+    epoch_shards_.push_back(order[i]);
+  }
+  next_shard_ = 0;
+  ++epoch_;
+}
+
+void ShardedInputSplit::ReadShard(const dmlc::io::FileInfo& shard, std::string* data) const {
+  // range reads of at least 1 MB
+  const size_t kMinRangeSize = 1 << 20UL;
+  const size_t size          = shard.size;
+  const size_t num_ranges =
+      std::max<size_t>(1, std::min<size_t>(num_range_reads_, size / kMinRangeSize));
+  const size_t range_size = (size + num_ranges - 1) / num_ranges;
+  const std::string path  = shard.path.str();
+  data->resize(size);
+  std::vector<std::exception_ptr> errors(num_ranges);
+  std::vector<std::thread> threads;
+  for (size_t r = 0; r < num_ranges; ++r) {
+    threads.emplace_back([&, r]() {
+      try {
+        const size_t begin = r * range_size;
+        const size_t end   = std::min(size, begin + range_size);
+        std::unique_ptr<dmlc::SeekStream> stream(dmlc::SeekStream::CreateForRead(path.c_str()));
+        stream->Seek(begin);
+        for (size_t pos = begin; pos < end;) {
+          const size_t n = stream->Read(&(*data)[pos], end - pos);
+          CHECK_GT(n, 0U) << "Unexpected end of " << path;
+          pos += n;
+        }
+      } catch (...) {
+        errors[r] = std::current_exception();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& error : errors) {
+    if (error != nullptr) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+bool ShardedInputSplit::NextShardRecord(std::string* record) {
+  while (true) {
+    if (reader_ != nullptr) {
+      Blob rec;
+      if (reader_->NextRecord(&rec)) {
+        record->assign(static_cast<const char*>(rec.dptr), rec.size);
+        return true;
+      }
+      reader_.reset();
+      prefetcher_.Recycle(&shard_);
+    }
+    if (!prefetcher_.Next(&shard_)) {
+      return false;
+    }
+    Blob chunk;
+    chunk.dptr = &(*shard_)[0];
+    chunk.size = shard_->size();
+    reader_    = std::make_unique<dmlc::RecordIOChunkReader>(chunk);
+  }
+}
+
+bool ShardedInputSplit::Pop(std::string* record) {
+  const size_t capacity = shuffle_ ? std::max<size_t>(shuffle_buffer_, 1) : 1;
+  while (buffer_.size() < capacity) {
+    std::string next;
+    if (!NextShardRecord(&next)) {
+      break;
+    }
+    buffer_.push_back(std::move(next));
+  }
+  if (buffer_.empty()) {
+    return false;
+  }
+  size_t i = buffer_.size() - 1;
+  if (shuffle_ && i > 0) {
+    i = std::uniform_int_distribution<size_t>(0, i)(rnd_);
+  }
+  std::swap(buffer_[i], buffer_.back());
+  record->swap(buffer_.back());
+  buffer_.pop_back();
+  return true;
+}
+
+bool ShardedInputSplit::FillChunk(size_t n_records, size_t n_bytes, Blob* out_chunk) {
+  chunk_.clear();
+  dmlc::MemoryStringStream stream(&chunk_);
+  dmlc::RecordIOWriter writer(&stream);
+  size_t n = 0;
+  while (n < n_records && chunk_.size() < n_bytes && Pop(&record_)) {
+    writer.WriteRecord(record_);
+    ++n;
+  }
+  if (n == 0) {
+    return false;
+  }
+  out_chunk->dptr = &chunk_[0];
+  out_chunk->size = chunk_.size();
+  return true;
+}
+
+size_t ShardedInputSplit::GetTotalSize() {
+  size_t size = 0;
+  for (const auto& shard : shards_) {
+    size += shard.size;
+  }
+  return size;
+}
+
+void ShardedInputSplit::BeforeFirst() {
+  reader_.reset();
+  if (shard_ != nullptr) {
+    prefetcher_.Recycle(&shard_);
+  }
+  buffer_.clear();
+  prefetcher_.BeforeFirst();
+}
+
+bool ShardedInputSplit::NextRecord(Blob* out_rec) {
+  if (!Pop(&record_)) {
+    return false;
+  }
+  out_rec->dptr = &record_[0];
+  out_rec->size = record_.size();
+  return true;
+}
+
+bool ShardedInputSplit::NextChunk(Blob* out_chunk) {
+  return FillChunk(std::numeric_limits<size_t>::max(), chunk_size_, out_chunk);
+}
+
+bool ShardedInputSplit::NextBatch(Blob* out_chunk, size_t n_records) {
+  return FillChunk(n_records, std::numeric_limits<size_t>::max(), out_chunk);
+}
+
+void ShardedInputSplit::ResetPartition(unsigned part_index, unsigned num_parts) {
+  CHECK_LT(part_index, num_parts) << "part_index must be smaller than num_parts";
+  CHECK_GE(shards_.size(), num_parts)
+      << "Only " << shards_.size() << " shards to split in " << num_parts << " parts";
+  part_index_ = part_index;
+  num_parts_  = num_parts;
+  BeforeFirst();
+}
+
+}  // namespace io
+}  // namespace mxnet
@@ -0,0 +1,119 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sharded_input_split.h
+ * \brief streaming of records from RecordIO shards, read whole by concurrent range reads
+ */
+#ifndef MXNET_IO_SHARDED_INPUT_SPLIT_H_
+#define MXNET_IO_SHARDED_INPUT_SPLIT_H_
+
+#include <dmlc/io.h>
+#include <dmlc/recordio.h>
+#include <dmlc/threadediter.h>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace mxnet {
+namespace io {
+
+/*!
+ * \brief an input split over many RecordIO shards, for instance on S3
+ *
+ * The shards are split across the parts shard by shard, so each part reads its shards from
+ * beginning to end and never seeks to a record. Whole shards are prefetched in the background,
+ * each by several concurrent range reads through the filesystems of dmlc-core. With shuffle,
+ * the order of the shards changes every epoch, the same on all parts, and the records are
+ * shuffled within a buffer. Chunks and batches are returned in RecordIO format.
+ */
+class ShardedInputSplit : public dmlc::InputSplit {
+ public:
+  /*!
+   * \param uri ';' separated list of shards or of directories holding shards
+   * \param shuffle whether to shuffle the shards and the records
+   * \param seed seed of the shuffles
+   * \param shuffle_buffer number of records the records are drawn from when shuffling
+   * \param prefetch_shards number of shards read ahead
+   * \param num_range_reads number of concurrent reads per shard
+   */
+  ShardedInputSplit(const std::string& uri,
+                    unsigned part_index,
+                    unsigned num_parts,
+                    bool shuffle,
+                    int seed,
+                    size_t shuffle_buffer,
+                    int prefetch_shards,
+                    int num_range_reads);
+  ~ShardedInputSplit() override;
+
+  void HintChunkSize(size_t chunk_size) override {
+    chunk_size_ = chunk_size;
+  }
+  size_t GetTotalSize() override;
+  void BeforeFirst() override;
+  bool NextRecord(Blob* out_rec) override;
+  bool NextChunk(Blob* out_chunk) override;
+  bool NextBatch(Blob* out_chunk, size_t n_records) override;
+  void ResetPartition(unsigned part_index, unsigned num_parts) override;
+
+ private:
+  /*! \brief list the shards in uri */
+  void ListShards(const std::string& uri);
+  /*! \brief choose the shards of this part for the next epoch, on the prefetch thread */
+  void NextEpoch();
+  /*! \brief read a whole shard by concurrent range reads */
+  void ReadShard(const dmlc::io::FileInfo& shard, std::string* data) const;
+  /*! \brief the next record of the shards in order */
+  bool NextShardRecord(std::string* record);
+  /*! \brief the next record, drawn from the shuffle buffer */
+  bool Pop(std::string* record);
+  /*! \brief append records to chunk_ until it holds n_records or chunk_size_ bytes */
+  bool FillChunk(size_t n_records, size_t n_bytes, Blob* out_chunk);
+
+  unsigned part_index_;
+  unsigned num_parts_;
+  bool shuffle_;
+  int seed_;
+  size_t shuffle_buffer_;
+  int num_range_reads_;
+  size_t chunk_size_ = 64 << 20UL;
+  /*! \brief all shards, sorted by path */
+  std::vector<dmlc::io::FileInfo> shards_;
+  /*! \brief indices of the shards of this part in this epoch, used by the prefetch thread */
+  std::vector<size_t> epoch_shards_;
+  size_t next_shard_ = 0;
+  unsigned epoch_    = 0;
+  /*! \brief reads the shards ahead */
+  dmlc::ThreadedIter<std::string> prefetcher_;
+  /*! \brief the shard records are read from, and its reader */
+  std::string* shard_ = nullptr;
+  std::unique_ptr<dmlc::RecordIOChunkReader> reader_;
+  /*! \brief records to draw from when shuffling */
+  std::vector<std::string> buffer_;
+  std::mt19937 rnd_;
+  /*! \brief storage of the record or chunk last returned */
+  std::string record_;
+  std::string chunk_;
+};
+
+}  // namespace io
+}  // namespace mxnet
+#endif  // MXNET_IO_SHARDED_INPUT_SPLIT_H_
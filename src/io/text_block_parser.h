@@ -0,0 +1,437 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file text_block_parser.h
+ * \brief parsing of CSV and LibSVM text into flat arrays, by several threads per chunk
+ */
+#ifndef MXNET_IO_TEXT_BLOCK_PARSER_H_
+#define MXNET_IO_TEXT_BLOCK_PARSER_H_
+
+#include <mxnet/base.h>
+#include <dmlc/common.h>
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+#include <dmlc/omp.h>
+#include <dmlc/threadediter.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace mxnet {
+namespace io {
+
+/*! \brief format of the text parsed by TextBlockParser */
+enum class TextFormat { kCSV, kLibSVM };
+
+/*!
+ * \brief rows parsed from a piece of a chunk of text
+ * \tparam DType type of the values
+ */
+template <typename DType>
+struct TextBlock {
+  /*! \brief the values of the rows, one row after the other */
+  std::vector<DType> value;
+  /*! \brief the column of each value, LibSVM only */
+  std::vector<int64_t> index;
+  /*! \brief the label of each row, LibSVM only */
+  std::vector<real_t> label;
+  /*! \brief where each row starts in value, and where the last row ends */
+  std::vector<size_t> offset{0};
+
+  size_t Size() const {
+    return offset.size() - 1;
+  }
+  void Clear() {
+    value.clear();
+    index.clear();
+    label.clear();
+    offset.assign(1, 0);
+  }
+};
+
+/*!
+ * \brief parses the chunks of a text input split ahead in the background
+ *
+ * Each chunk is cut at line ends into one piece per thread, and the threads parse their pieces
+ * into blocks at the same time. Lines are found with memchr, which the C library vectorizes,
+ * and numbers are read in one pass without copying them to a terminated string first.
+ * \tparam DType type of the values
+ */
+template <typename DType>
+class TextBlockParser {
+ public:
+  /*! \brief the blocks of a chunk, in the order of the text */
+  using Chunk = std::vector<TextBlock<DType> >;
+
+  TextBlockParser(const std::string& uri,
+                  unsigned part_index,
+                  unsigned num_parts,
+                  TextFormat format,
+                  int nthread)
+      : format_(format), nthread_(std::max(nthread, 1)) {
+    source_.reset(dmlc::InputSplit::Create(uri.c_str(), part_index, num_parts, "text"));
+    iter_.set_max_capacity(4);
+    iter_.Init([this](Chunk** dptr) { return ParseChunk(dptr); },
+               [this]() { source_->BeforeFirst(); });
+  }
+  ~TextBlockParser() {
+    iter_.Destroy();
+  }
+
+  void BeforeFirst() {
+    iter_.BeforeFirst();
+  }
+  /*! \brief take the next parsed chunk, to be given back by Recycle */
+  bool Next(Chunk** chunk) {
+    return iter_.Next(chunk);
+  }
+  void Recycle(Chunk** chunk) {
+    iter_.Recycle(chunk);
+  }
+
+ private:
+  /*! \brief pieces of chunks are not made smaller than this */
+  static const size_t kMinPieceSize = 1 << 16UL;
+
+  bool ParseChunk(Chunk** dptr) {
+    dmlc::InputSplit::Blob chunk;
+    if (!source_->NextChunk(&chunk)) {
+      return false;
+    }
+    if (*dptr == nullptr) {
+      *dptr = new Chunk();
+    }
+    const char* head = static_cast<const char*>(chunk.dptr);
+    const char* end  = head + chunk.size;
+    const int nthread =
+        std::max(1, std::min<int>(nthread_, static_cast<int>(chunk.size / kMinPieceSize)));
+    // cut the chunk into pieces of whole lines
+    std::vector<const char*> bounds(nthread + 1, end);
+    bounds[0] = head;
+    for (int t = 1; t < nthread; ++t) {
+      const char* p  = std::max(head + chunk.size * t / nthread, bounds[t - 1]);
+      const void* nl = std::memchr(p, '\n', end - p);
+      bounds[t]      = nl == nullptr ? end : static_cast<const char*>(nl) + 1;
+    }
+    (*dptr)->resize(nthread);
+#pragma omp parallel for num_threads(nthread)
+    for (int t = 0; t < nthread; ++t) {
+      omp_exc_.Run([&] { ParsePiece(bounds[t], bounds[t + 1], &(**dptr)[t]); });
+    }
+    omp_exc_.Rethrow();
+    return true;
+  }
+
+  void ParsePiece(const char* begin, const char* end, TextBlock<DType>* block) const {
+    block->Clear();
+    while (begin != end) {
+      const void* nl   = std::memchr(begin, '\n', end - begin);
+      const char* lend = nl == nullptr ? end : static_cast<const char*>(nl);
+      if (format_ == TextFormat::kCSV) {
+        ParseCSVLine(begin, lend, block);
+      } else {
+        ParseLibSVMLine(begin, lend, block);
+      }
+      begin = nl == nullptr ? end : lend + 1;
+    }
+  }
+
+  static bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+  }
+  static bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+  }
+  static const char* SkipSpace(const char* p, const char* end) {
+    while (p != end && IsSpace(*p)) {
+      ++p;
+    }
+    return p;
+  }
+
+  void ParseCSVLine(const char* p, const char* end, TextBlock<DType>* block) const {
+    p = SkipSpace(p, end);
+    if (p == end) {
+      return;
+    }
+    while (true) {
+      DType value = 0;
+      p           = SkipSpace(p, end);
+      // an empty field is 0
+      if (p != end && *p != ',') {
+        p = ParseValue(p, end, &value);
+      }
+      block->value.push_back(value);
+      p = SkipSpace(p, end);
+      if (p == end) {
+        break;
+      }
+      CHECK_EQ(*p, ',') << "Invalid CSV value in line: " << std::string(p, end);
+      ++p;
+    }
+    block->offset.push_back(block->value.size());
+  }
+
+  void ParseLibSVMLine(const char* p, const char* end, TextBlock<DType>* block) const {
+    // anything after # is a comment
+    const void* comment = std::memchr(p, '#', end - p);
+    if (comment != nullptr) {
+      end = static_cast<const char*>(comment);
+    }
+    p = SkipSpace(p, end);
+    if (p == end) {
+      return;
+    }
+    real_t label;
+    p = ParseValue(p, end, &label);
+    block->label.push_back(label);
+    if (p != end && *p == ':') {
+      // the weight of the instance is not used
+      real_t weight;
+      p = ParseValue(p + 1, end, &weight);
+    }
+    while ((p = SkipSpace(p, end)) != end) {
+      if (*p == 'q') {
+        // skip qid:<n>
+        while (p != end && !IsSpace(*p)) {
+          ++p;
+        }
+        continue;
+      }
+      int64_t index;
+      p = ParseValue(p, end, &index);
+      CHECK(p != end && *p == ':') << "Invalid LibSVM feature in line: " << std::string(p, end);
+      CHECK_GE(index, 0) << "Invalid LibSVM feature index " << index;
+      DType value;
+      p = ParseValue(p + 1, end, &value);
+      block->index.push_back(index);
+      block->value.push_back(value);
+    }
+    block->offset.push_back(block->value.size());
+  }
+
+  /*! \brief parse the number at p into out, and return where it ends */
+  template <typename T>
+  static const char* ParseValue(const char* p, const char* end, T* out) {
+    if (std::is_integral<T>::value) {
+      int64_t value;
+      const char* q = ParseInteger(p, end, &value);
+      if (q != nullptr && (q == end || (*q != '.' && *q != 'e' && *q != 'E'))) {
+        *out = static_cast<T>(value);
+        return q;
+      }
+    }
+    double value;
+    p    = ParseReal(p, end, &value);
+    *out = static_cast<T>(value);
+    return p;
+  }
+
+  /*! \brief parse an integer, nullptr if there are no digits or too many */
+  static const char* ParseInteger(const char* p, const char* end, int64_t* out) {
+    bool negative = false;
+    if (p != end && (*p == '-' || *p == '+')) {
+      negative = *p++ == '-';
+    }
+    const char* digits = p;
+    uint64_t value     = 0;
+    for (; p != end && IsDigit(*p); ++p) {
+      value = value * 10 + (*p - '0');
+    }
+    if (p == digits || p - digits > 18) {
+      return nullptr;
+    }
+    *out = negative ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+    return p;
+  }
+
+  /*!
+   * \brief parse a real number
+   *
+   * Numbers of at most 19 significant digits whose mantissa and power of ten are both exact
+   * doubles are converted with a single rounding, like strtod does. Other numbers, such as
+   * inf or nan, go to strtod.
+   */
+  static const char* ParseReal(const char* p, const char* end, double* out) {
+    static const double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                    1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char* begin = p;
+    bool negative     = false;
+    if (p != end && (*p == '-' || *p == '+')) {
+      negative = *p++ == '-';
+    }
+    uint64_t mantissa = 0;
+    int digits        = 0;
+    int exponent      = 0;
+    bool exact        = true;
+    const char* start = p;
+    for (; p != end && IsDigit(*p); ++p) {
+      if (digits < 19) {
+        mantissa = mantissa * 10 + (*p - '0');
+        digits += mantissa != 0;
+      } else {
+        exact = exact && *p == '0';
+        ++exponent;
+      }
+    }
+    if (p != end && *p == '.') {
+      for (++p; p != end && IsDigit(*p); ++p) {
+        if (digits < 19) {
+          mantissa = mantissa * 10 + (*p - '0');
+          digits += mantissa != 0;
+          --exponent;
+        } else {
+          exact = exact && *p == '0';
+        }
+      }
+    }
+    const bool has_digits = p != start && !(p == start + 1 && *start == '.');
+    if (has_digits && p != end && (*p == 'e' || *p == 'E')) {
+      int64_t e;
+      const char* q = ParseInteger(p + 1, end, &e);
+      if (q != nullptr && e > -1000 && e < 1000) {
+        exponent += static_cast<int>(e);
+        p = q;
+      } else {
+        exact = false;
+      }
+    }
+    if (has_digits && exact && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+      double value = static_cast<double>(mantissa);
+      value        = exponent < 0 ? value / kPow10[-exponent] : value * kPow10[exponent];
+      *out         = negative ? -value : value;
+      return p;
+    }
+    // the token ends at a separator
+    const char* token_end = begin;
+    while (token_end != end && !IsSpace(*token_end) && *token_end != ',' && *token_end != ':') {
+      ++token_end;
+    }
+    const std::string token(begin, token_end);
+    char* parsed_end;
+    *out = std::strtod(token.c_str(), &parsed_end);
+    CHECK_NE(parsed_end, token.c_str()) << "Invalid number: " << token;
+    return begin + (parsed_end - token.c_str());
+  }
+
+  TextFormat format_;
+  int nthread_;
+  std::unique_ptr<dmlc::InputSplit> source_;
+  dmlc::ThreadedIter<Chunk> iter_;
+  /*! \brief OMPException obj to store and rethrow exceptions from omp blocks*/
+  dmlc::OMPException omp_exc_;
+};
+
+/*!
+ * \brief reads the rows of the chunks of a TextBlockParser in order
+ *
+ * The rows taken are spans of the blocks, which stay valid until Release.
+ */
+template <typename DType>
+class TextRowReader {
+ public:
+  /*! \brief rows [begin, end) of a block */
+  struct Span {
+    const TextBlock<DType>* block;
+    size_t begin;
+    size_t end;
+  };
+
+  explicit TextRowReader(TextBlockParser<DType>* parser) : parser_(parser) {}
+  ~TextRowReader() {
+    HoldCurrent();
+    Release();
+  }
+
+  /*! \brief give back all chunks and start over */
+  void BeforeFirst() {
+    Rewind();
+    Release();
+  }
+  /*! \brief start over, keeping the spans taken so far valid until Release */
+  void Rewind() {
+    HoldCurrent();
+    parser_->BeforeFirst();
+  }
+  /*! \brief give back the chunks of the spans taken, but the chunk read from now */
+  void Release() {
+    for (auto* chunk : held_) {
+      parser_->Recycle(&chunk);
+    }
+    held_.clear();
+  }
+  /*! \brief append the spans of at most n next rows, and return the number of rows */
+  size_t Take(size_t n, std::vector<Span>* spans) {
+    size_t taken = 0;
+    while (taken < n && Advance()) {
+      const TextBlock<DType>& block = (*chunk_)[block_];
+      const size_t m                = std::min(n - taken, block.Size() - row_);
+      spans->push_back(Span{&block, row_, row_ + m});
+      row_ += m;
+      taken += m;
+    }
+    return taken;
+  }
+
+ private:
+  void HoldCurrent() {
+    if (chunk_ != nullptr) {
+      held_.push_back(chunk_);
+      chunk_ = nullptr;
+    }
+  }
+  /*! \brief move on to a block with rows left, false at the end */
+  bool Advance() {
+    while (chunk_ == nullptr || row_ == (*chunk_)[block_].Size()) {
+      if (chunk_ != nullptr && block_ + 1 < chunk_->size()) {
+        ++block_;
+        row_ = 0;
+        continue;
+      }
+      HoldCurrent();
+      if (!parser_->Next(&chunk_)) {
+        chunk_ = nullptr;
+        return false;
+      }
+      block_ = 0;
+      row_   = 0;
+    }
+    return true;
+  }
+
+  TextBlockParser<DType>* parser_;
+  /*! \brief the chunk rows are read from, and the position in it */
+  typename TextBlockParser<DType>::Chunk* chunk_ = nullptr;
+  size_t block_                                  = 0;
+  size_t row_                                    = 0;
+  /*! \brief chunks spans were taken from, not given back yet */
+  std::vector<typename TextBlockParser<DType>::Chunk*> held_;
+};
+
+}  // namespace io
+}  // namespace mxnet
+#endif  // MXNET_IO_TEXT_BLOCK_PARSER_H_
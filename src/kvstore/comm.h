@@ -30,6 +30,7 @@
 #include "mxnet/ndarray.h"
 #include "gradient_compression.h"
 #include "../ndarray/ndarray_function.h"
+#include "../operator/tensor/elemwise_sum.h"
 #include "../operator/tensor/sparse_retain-inl.h"
 #include "../profiler/profiler.h"
 #include "./kvstore_utils.h"
@@ -143,38 +144,41 @@ class CommCPU : public Comm {
     NDArray& buf_merged = buf.merged_buf(stype);
     // normal dense reduce
     if (stype == kDefaultStorage) {
-      std::vector<Engine::VarHandle> const_vars(src.size() - 1);
+      std::vector<Engine::VarHandle> const_vars;
       std::vector<NDArray> reduce(src.size());
-      CopyFromTo(src[0], &buf_merged, priority);
-      reduce[0] = buf_merged;
-
-      if (buf.copy_buf.empty()) {
-        buf.copy_buf.resize(src.size() - 1);
-        for (size_t j = 0; j < src.size() - 1; ++j) {
-          // allocate copy buffer
-          buf.copy_buf[j] = NDArray(src[0].shape(), pinned_ctx_, false, src[0].dtype());
+      buf.copy_buf.resize(src.size());
+      for (size_t i = 0; i < src.size(); ++i) {
+        if (src[i].ctx().dev_mask() == cpu::kDevMask) {
+          // sources in CPU memory are summed where they are, without staging copies
+          reduce[i] = src[i];
+        } else {
+          if (buf.copy_buf[i].is_none()) {
+            // allocate copy buffer
+            buf.copy_buf[i] = NDArray(src[0].shape(), pinned_ctx_, false, src[0].dtype());
+          }
+          CHECK(stype == buf.copy_buf[i].storage_type())
+              << "Storage type mismatch detected. " << stype << "(src) vs. "
+              << buf.copy_buf[i].storage_type() << "(buf.copy_buf)";
+          CopyFromTo(src[i], &(buf.copy_buf[i]), priority);
+          reduce[i] = buf.copy_buf[i];
         }
+        const_vars.push_back(reduce[i].var());
       }
-      CHECK(stype == buf.copy_buf[0].storage_type())
-          << "Storage type mismatch detected. " << stype << "(src) vs. "
-          << buf.copy_buf[0].storage_type() << "(buf.copy_buf)";
-      for (size_t i = 1; i < src.size(); ++i) {
-        CopyFromTo(src[i], &(buf.copy_buf[i - 1]), priority);
-        reduce[i]         = buf.copy_buf[i - 1];
-        const_vars[i - 1] = reduce[i].var();
-      }
+      // the same array may be pushed more than once
+      std::sort(const_vars.begin(), const_vars.end());
+      const_vars.erase(std::unique(const_vars.begin(), const_vars.end()), const_vars.end());
 
       Engine::Get()->PushAsync(
-          [reduce, this](RunContext rctx,
-                         Engine::CallbackOnStart on_start,
-                         Engine::CallbackOnComplete on_complete) {
+          [reduce, buf_merged, this](RunContext rctx,
+                                     Engine::CallbackOnStart on_start,
+                                     Engine::CallbackOnComplete on_complete) {
             on_start();
-            ReduceSumCPU(reduce);
+            ReduceSumCPU(reduce, buf_merged);
             on_complete();
           },
           Context::CPU(),
           const_vars,
-          {reduce[0].var()},
+          {buf_merged.var()},
           FnProperty::kCPUPrioritized,
           priority,
           "KVStoreReduce");
@@ -298,16 +302,17 @@ class CommCPU : public Comm {
   }
 
  private:
-  // reduce sum into val[0]
-  inline void ReduceSumCPU(const std::vector<NDArray>& in_data) {
-    MSHADOW_TYPE_SWITCH(in_data[0].dtype(), DType, {
-      std::vector<DType*> dptr(in_data.size());
+  // reduce sum of in_data into out
+  inline void ReduceSumCPU(const std::vector<NDArray>& in_data, const NDArray& out) {
+    MSHADOW_TYPE_SWITCH(out.dtype(), DType, {
+      std::vector<DType*> dptr(in_data.size() + 1);
+      dptr[0] = out.data().FlatTo2D<cpu, DType>().dptr_;
       for (size_t i = 0; i < in_data.size(); ++i) {
         TBlob data = in_data[i].data();
         CHECK(data.CheckContiguous());
-        dptr[i] = data.FlatTo2D<cpu, DType>().dptr_;
+        dptr[i + 1] = data.FlatTo2D<cpu, DType>().dptr_;
       }
-      size_t total = in_data[0].shape().Size();
+      size_t total = out.shape().Size();
       ReduceSumCPUImpl(dptr, total);
     });
   }
@@ -385,58 +390,29 @@ class CommCPU : public Comm {
     });
   }
 
+  // sum dptr[1], dptr[2], ... into dptr[0] over [offset, offset + size), which is small
+  // enough to stay in cache while all the sources are accumulated in one pass
   template <typename DType>
   inline static void ReduceSumCPU(const std::vector<DType*>& dptr, size_t offset, index_t size) {
-    using namespace mshadow;  // NOLINT(*)
-    Tensor<cpu, 1, DType> in_0(dptr[0] + offset, Shape1(size));
-    for (size_t i = 1; i < dptr.size(); i += 4) {
-      switch (dptr.size() - i) {
-        case 1: {
-          Tensor<cpu, 1, DType> in_1(dptr[i] + offset, Shape1(size));
-          in_0 += in_1;
-          break;
-        }
-        case 2: {
-          Tensor<cpu, 1, DType> in_1(dptr[i] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_2(dptr[i + 1] + offset, Shape1(size));
-          in_0 += in_1 + in_2;
-          break;
-        }
-        case 3: {
-          Tensor<cpu, 1, DType> in_1(dptr[i] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_2(dptr[i + 1] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_3(dptr[i + 2] + offset, Shape1(size));
-          in_0 += in_1 + in_2 + in_3;
-          break;
-        }
-        default: {
-          Tensor<cpu, 1, DType> in_1(dptr[i] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_2(dptr[i + 1] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_3(dptr[i + 2] + offset, Shape1(size));
-          Tensor<cpu, 1, DType> in_4(dptr[i + 3] + offset, Shape1(size));
-          in_0 += in_1 + in_2 + in_3 + in_4;
-          break;
-        }
-      }
-    }
+    op::ElementWiseSumRange<DType>(
+        dptr.data() + 1, dptr.size() - 1, dptr[0], kWriteTo, offset, offset + size);
   }
 
   template <typename DType>
   inline void ReduceSumCPUImpl(std::vector<DType*> dptr, size_t total) {
     const size_t step = std::min(bigarray_bound_, static_cast<size_t>(4 << 10));
     long ntask        = (total + step - 1) / step;  // NOLINT(*)
-    if (total < bigarray_bound_ || nthread_reduction_ <= 1) {
-      ReduceSumCPU(dptr, 0, total);
-    } else {
-#pragma omp parallel for schedule(static) num_threads(nthread_reduction_)
-      for (long j = 0; j < ntask; ++j) {  // NOLINT(*)
-        size_t k     = static_cast<size_t>(j);
-        size_t begin = std::min(k * step, total);
-        size_t end   = std::min((k + 1) * step, total);
-        if (j == ntask - 1)
-          CHECK_EQ(end, total);
-        ReduceSumCPU(dptr, begin, static_cast<index_t>(end - begin));
-      }
+    // small arrays are summed block by block too, so that the output stays in cache;
+    // static scheduling gives every thread a contiguous range of the arrays
+    const bool parallel = total >= bigarray_bound_ && nthread_reduction_ > 1;
+#pragma omp parallel for schedule(static) num_threads(nthread_reduction_) if (parallel)
+    for (long j = 0; j < ntask; ++j) {  // NOLINT(*)
+      size_t k     = static_cast<size_t>(j);
+      size_t begin = std::min(k * step, total);
+      size_t end   = std::min((k + 1) * step, total);
+      if (j == ntask - 1)
+        CHECK_EQ(end, total);
+      ReduceSumCPU(dptr, begin, static_cast<index_t>(end - begin));
     }
   }
 
@@ -608,6 +584,8 @@ class CommDevice : public Comm {
         buf.compressed_send_buf[i] =
             NDArray(mxnet::TShape{small_size}, src[i].ctx(), false, buf.merged.dtype());
         buf.compressed_send_buf[i].AssignStorageInfo(profiler_scope, "compressed_send_buf");
+        // powersgd compression starts from the previous compressed values
+        buf.compressed_send_buf[i] = 0;
       }
     }
 
@@ -0,0 +1,158 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file   comm_scheduler.h
+ * @brief  priority-ordered scheduling of the requests of a kvstore under a credit
+ */
+#ifndef MXNET_KVSTORE_COMM_SCHEDULER_H_
+#define MXNET_KVSTORE_COMM_SCHEDULER_H_
+
+#include <dmlc/logging.h>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace mxnet {
+namespace kvstore {
+
+/**
+ * \brief issues the requests of a kvstore in priority order while bounding the
+ * number of bytes in flight
+ *
+ * Requests of higher priority are issued first. As long as the credit is used
+ * up, the others wait, so that the pulls of the first layers, which have the
+ * highest priority, overtake the pushes and pulls of later layers queued before
+ * them instead of waiting behind them on the network.
+ *
+ * A request ordered before all requests in flight is issued even without
+ * credit. Requests are ordered by priority, key and chunk, which is the same
+ * order on all workers, so the first of the requests waiting on any worker can
+ * always be issued. This keeps synchronous training, where the servers answer
+ * a push only once all workers pushed the key, from deadlocking when workers
+ * queue their requests in different orders.
+ */
+class CommScheduler {
+ public:
+  /**
+   * \brief issues a request and calls the argument once it has completed
+   */
+  using Request = std::function<void(const std::function<void()>&)>;
+
+  /**
+   * \param credit number of bytes in flight above which requests wait
+   */
+  explicit CommScheduler(size_t credit) : credit_(credit) {
+    CHECK_GT(credit_, 0U) << "the credit of the communication scheduler must be positive";
+  }
+
+  /**
+   * \brief issue a request now or once the credit allows it
+   * \param priority the priority of the push or pull, higher is more urgent
+   * \param key the key the request belongs to
+   * \param chunk index of the part of the key the request sends or receives
+   * \param bytes size of the request
+   */
+  void Submit(int priority, int key, int chunk, size_t bytes, Request request) {
+    std::vector<Task> ready;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      const Order order{-priority, key, chunk, seq_++};
+      pending_.emplace(order, Task{order, bytes, std::move(request)});
+      Dequeue(&ready);
+    }
+    Issue(&ready);
+  }
+
+ private:
+  /// \brief (-priority, key, chunk, arrival) so that std::less puts the most urgent first
+  using Order = std::tuple<int, int, int, uint64_t>;
+
+  /// \brief whether a is more urgent than b, regardless of their arrival
+  static bool Before(const Order& a, const Order& b) {
+    return std::tie(std::get<0>(a), std::get<1>(a), std::get<2>(a)) <
+           std::tie(std::get<0>(b), std::get<1>(b), std::get<2>(b));
+  }
+
+  struct Task {
+    Order order;
+    size_t bytes;
+    Request request;
+  };
+
+  /**
+   * \brief move the requests that may be issued from pending_ to ready, with mu_ held
+   */
+  void Dequeue(std::vector<Task>* ready) {
+    while (!pending_.empty()) {
+      auto it            = pending_.begin();
+      const Order& order = it->first;
+      const bool fits    = in_flight_bytes_ == 0 || in_flight_bytes_ + it->second.bytes <= credit_;
+      const bool first   = in_flight_.empty() || Before(order, *in_flight_.begin());
+      if (!fits && !first) {
+        break;
+      }
+      in_flight_bytes_ += it->second.bytes;
+      in_flight_.insert(order);
+      ready->push_back(std::move(it->second));
+      pending_.erase(it);
+    }
+  }
+
+  /**
+   * \brief issue the dequeued requests, without mu_ held as requests may complete at once
+   */
+  void Issue(std::vector<Task>* ready) {
+    for (auto& task : *ready) {
+      const Order order  = task.order;
+      const size_t bytes = task.bytes;
+      task.request([this, order, bytes]() { Complete(order, bytes); });
+    }
+  }
+
+  void Complete(const Order& order, size_t bytes) {
+    std::vector<Task> ready;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      in_flight_bytes_ -= bytes;
+      in_flight_.erase(order);
+      Dequeue(&ready);
+    }
+    Issue(&ready);
+  }
+
+  std::mutex mu_;
+  const size_t credit_;
+  size_t in_flight_bytes_ = 0;
+  uint64_t seq_           = 0;
+  /// \brief requests waiting for credit, the most urgent first
+  std::map<Order, Task> pending_;
+  /// \brief requests issued and not completed yet
+  std::set<Order> in_flight_;
+};
+
+}  // namespace kvstore
+}  // namespace mxnet
+
+#endif  // MXNET_KVSTORE_COMM_SCHEDULER_H_
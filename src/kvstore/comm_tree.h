@@ -51,6 +51,8 @@ class CommDeviceTree : public CommDevice {
     gpuarray_bound_     = dmlc::GetEnv("MXNET_KVSTORE_TREE_ARRAY_BOUND", 10000000);
     backtrack_          = dmlc::GetEnv("MXNET_KVSTORE_TREE_BACKTRACK", 0);
     link_usage_penalty_ = dmlc::GetEnv("MXNET_KVSTORE_TREE_LINK_USAGE_PENALTY", 0.7);
+    stripe_size_        = dmlc::GetEnv("MXNET_KVSTORE_TREE_STRIPE_SIZE", 1000000);
+    calibrate_mb_       = dmlc::GetEnv("MXNET_KVSTORE_TREE_CALIBRATE_MB", 16);
   }
 
   virtual ~CommDeviceTree() {}
@@ -190,28 +192,20 @@ class CommDeviceTree : public CommDevice {
     }
 
     InitBuffersAndComm(src);
-    std::vector<std::vector<NDArray>> slice(devs_.size());
-    std::vector<std::vector<NDArray*>> broadcast_slice(devs_.size());
-    std::vector<int> slice_scan(devs_.size() + 1);
-
-    int total_size      = src[0].shape().Size();
-    unsigned first_size = src[0].shape()[0];
+    const std::vector<int>& roots = KeyRoots(key);
+    std::vector<std::vector<NDArray>> slice(roots.size());
+    std::vector<std::vector<NDArray*>> broadcast_slice(roots.size());
 
     const NDArrayStorageType stype = src[0].storage_type();
     // normal dense reduce
     if (stype == kDefaultStorage) {
-      if (total_size > gpuarray_bound_ && first_size >= 2 * devs_.size()) {
-        // Find slice bounds
-        slice_scan[0]  = 0;
-        int slice_size = first_size / devs_.size();
-        for (unsigned i = 1; i < devs_.size(); ++i) {
-          slice_scan[i] = slice_scan[i - 1] + slice_size;
-        }
-        slice_scan[devs_.size()] = src[0].shape()[0];
+      if (roots.size() > 1) {
+        std::vector<int> slice_scan;
+        StripeBounds(src[0].shape()[0], roots.size(), &slice_scan);
 
         // row: which slice
         // col: which gpu
-        for (unsigned row = 0; row < devs_.size(); ++row) {
+        for (unsigned row = 0; row < roots.size(); ++row) {
           for (unsigned col = 0; col < devs_.size(); ++col) {
             TreeBufferEntry& buf = tree_merge_buf_[col][key];
             NDArray curr_slice   = src[col].Slice(slice_scan[row], slice_scan[row + 1]);
@@ -220,18 +214,19 @@ class CommDeviceTree : public CommDevice {
           }
         }
 
-        // Do reduce-scatter (multiroot reduce)
+        // Do reduce-scatter (multiroot reduce), every slice over its own tree
         // input:  slice (src)
         // output: buf.merge_buf
-        for (unsigned i = 0; i < devs_.size(); ++i) {
-          ReduceInner(key, slice[i], i, i, priority);
+        for (unsigned i = 0; i < roots.size(); ++i) {
+          ReduceInner(key, slice[i], roots[i], i, priority);
         }
 
-        for (unsigned i = 0; i < devs_.size(); ++i) {
-          BroadcastInner(key, *(broadcast_slice[i][i]), broadcast_slice[i], i, i, priority);
+        for (unsigned i = 0; i < roots.size(); ++i) {
+          BroadcastInner(
+              key, *(broadcast_slice[i][roots[i]]), broadcast_slice[i], roots[i], i, priority);
         }
       } else {
-        int root = 0;
+        int root = roots[0];
         ReduceInner(key, src, root, 0, priority);
 
         TreeBufferEntry& buf = tree_merge_buf_[root][key];
@@ -295,23 +290,17 @@ class CommDeviceTree : public CommDevice {
         }
       }
     } else {
-      int total_size                 = src.shape().Size();
-      unsigned first_size            = src.shape()[0];
+      const std::vector<int>& roots  = KeyRoots(key);
       const NDArrayStorageType stype = src.storage_type();
       // normal dense reduce
       if (stype == kDefaultStorage) {
-        if (total_size > gpuarray_bound_ && first_size >= 2 * devs_.size()) {
-          std::vector<int> slice_scan(devs_.size() + 1);
-          slice_scan[0]  = 0;
-          int slice_size = (dst[0]->shape()[0]) / devs_.size();
-          for (unsigned i = 1; i < devs_.size(); ++i) {
-            slice_scan[i] = slice_scan[i - 1] + slice_size;
-          }
-          slice_scan[devs_.size()] = dst[0]->shape()[0];
+        if (roots.size() > 1) {
+          std::vector<int> slice_scan;
+          StripeBounds(dst[0]->shape()[0], roots.size(), &slice_scan);
 
           for (unsigned gpu_id = 0; gpu_id < dst.size(); ++gpu_id) {
             TreeBufferEntry& buf = tree_merge_buf_[gpu_id][key];
-            for (unsigned i = 0; i < devs_.size(); ++i) {
+            for (unsigned i = 0; i < roots.size(); ++i) {
               if (devs_[gpu_id] == dst[gpu_id]->ctx()) {
                 NDArray curr_slice = dst[gpu_id]->Slice(slice_scan[i], slice_scan[i + 1]);
                 CopyFromTo(buf.merged[i], &curr_slice, priority);
@@ -319,7 +308,7 @@ class CommDeviceTree : public CommDevice {
             }
           }
         } else {
-          int root = 0;
+          int root = roots[0];
           BroadcastInner(key, src, dst, root, -1, priority);
         }
       } else {
@@ -378,6 +367,15 @@ class CommDeviceTree : public CommDevice {
     std::vector<int> p2p_matrix(devs_.size() * devs_.size());
     EnableP2P(&p2p_matrix);
     GetP2PWeight(devs_, p2p_matrix, &link_matrix);
+    if (calibrate_mb_ > 0) {
+      // measure the links instead of relying on the performance rank of the driver,
+      // which does not tell NVSwitch, NVLink generations and PCI-E apart well
+      std::vector<float> bandwidth;
+      if (MeasureP2PBandwidth(devs_, static_cast<size_t>(calibrate_mb_) << 20, link_matrix,
+                              &bandwidth)) {
+        ScaleP2PWeight(bandwidth, devs_.size(), &link_matrix);
+      }
+    }
     if (backtrack_)
       LOG(INFO) << "Using Backtracking to generate trees";
     else
@@ -389,6 +387,54 @@ class CommDeviceTree : public CommDevice {
   }
 
   using KeyAttrs = std::tuple<int, mxnet::TShape, int>;
+
+  /**
+   * \brief Roots of the trees the key is reduced over, one per stripe of the key
+   */
+  const std::vector<int>& KeyRoots(int key) const {
+    static const std::vector<int> kDefaultRoots = {0};
+    auto it                                     = key_roots_.find(key);
+    return it == key_roots_.end() ? kDefaultRoots : it->second;
+  }
+
+  /**
+   * \brief Bounds of the stripes of an array along its first dimension
+   */
+  static void StripeBounds(int first_size, int num_stripes, std::vector<int>* slice_scan) {
+    slice_scan->resize(num_stripes + 1);
+    (*slice_scan)[0] = 0;
+    int slice_size   = first_size / num_stripes;
+    for (int i = 1; i < num_stripes; ++i) {
+      (*slice_scan)[i] = (*slice_scan)[i - 1] + slice_size;
+    }
+    (*slice_scan)[num_stripes] = first_size;
+  }
+
+  /**
+   * \brief Select the trees of every key. The number of trees a key is striped over
+   *        grows with its size, and the trees are assigned by the bytes they
+   *        already reduce, largest keys first, so that small keys do not all
+   *        share the tree of the first GPU.
+   */
+  void AssignTrees() {
+    std::vector<KeyAttrs> keys = tree_sorted_key_attrs_;
+    auto bytes                 = [](const KeyAttrs& attrs) {
+      return std::get<1>(attrs).Size() * mshadow::mshadow_sizeof(std::get<2>(attrs));
+    };
+    std::stable_sort(keys.begin(), keys.end(), [&bytes](const KeyAttrs& a, const KeyAttrs& b) {
+      return bytes(a) > bytes(b);
+    });
+    std::vector<size_t> load(devs_.size(), 0);
+    for (const auto& attrs : keys) {
+      const mxnet::TShape& shape = std::get<1>(attrs);
+      int num_stripes            = ComputeNumStripes(
+          shape.Size(), shape[0], devs_.size(), gpuarray_bound_, stripe_size_);
+      SelectTrees(bytes(attrs), num_stripes, &load, &key_roots_[std::get<0>(attrs)]);
+    }
+    if (kLogTree)
+      PrintVector("Bytes reduced per tree", load);
+  }
+
   // try to allocate buff on device evenly
   void InitMergeBufferTree() {
     LOG(INFO) << "Using Tree";
@@ -399,6 +445,7 @@ class CommDeviceTree : public CommDevice {
     // 3) Do not use greedy assignment; all keys are assigned to each GPU
     for (unsigned i = 0; i < devs_.size(); ++i)
       tree_merge_buf_.emplace_back();
+    AssignTrees();
 
     bool delay_alloc = true;
     std::map<int, int> key_dist;
@@ -450,18 +497,15 @@ class CommDeviceTree : public CommDevice {
 
         // buf.merged enforces that we only visit each GPU once
         if (buf.merged.empty()) {
-          mxnet::TShape shape_copy = shape;
-          int total_size           = shape.Size();
-          unsigned first_size      = shape[0];
-          if (total_size > gpuarray_bound_ && first_size >= 2 * devs_.size()) {
+          mxnet::TShape shape_copy   = shape;
+          const unsigned num_stripes = key_roots_[key].size();
+          if (num_stripes > 1) {
             // Find slice bounds
-            int slice_size = first_size / devs_.size();
-            int last_slice = first_size - (devs_.size() - 1) * slice_size;
-            shape_copy[0]  = slice_size;
-            buf.merged.resize(devs_.size());
-            for (unsigned row = 0; row < devs_.size(); ++row) {
-              if (row == devs_.size() - 1)
-                shape_copy[0] = last_slice;
+            std::vector<int> slice_scan;
+            StripeBounds(shape[0], num_stripes, &slice_scan);
+            buf.merged.resize(num_stripes);
+            for (unsigned row = 0; row < num_stripes; ++row) {
+              shape_copy[0]   = slice_scan[row + 1] - slice_scan[row];
               buf.merged[row] = NDArray(shape_copy, ctx, delay_alloc, type);
               buf.merged[row].AssignStorageInfo(profiler_scope, "merged_" + std::to_string(key));
               buf.copy_buf.emplace_back();
@@ -526,10 +570,15 @@ class CommDeviceTree : public CommDevice {
   std::vector<std::vector<size_t>> scan_;
   std::vector<Context> devs_;
 
+  /// \brief for every key, the roots of the trees its stripes are reduced over
+  std::unordered_map<int, std::vector<int>> key_roots_;
+
   int depth_;
   int gpuarray_bound_;
   bool backtrack_;
   float link_usage_penalty_;
+  int stripe_size_;
+  int calibrate_mb_;
 
   /// \brief constant for maximum size of recv buffer per GPU
   ///        2: only receive from 1 other GPU
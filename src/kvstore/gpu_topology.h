@@ -22,6 +22,7 @@
 #if MXNET_USE_CUDA
 #include <cuda_runtime_api.h>
 #include <cuda.h>
+#include "../common/cuda/utils.h"
 #endif
 #include <iostream>
 #include <vector>
@@ -1166,6 +1167,171 @@ inline void ComputeTrees(const std::vector<T>& W,
     PrintMatrix("Links", adj, num_elements, num_elements);
   }
 }
+
+/**
+ * \brief Replace the assumed link weights by ones proportional to measured bandwidths
+ * \param bandwidth is the matrix of measured bandwidths, where row sends to col
+ * \param num_gpus is the number of GPUs
+ * \param matrix is the adjacency matrix of link weights computed by GetP2PWeight.
+ *        Links of weight 0 stay unused. The others are set proportionally to the
+ *        bandwidth averaged over both directions, scaled such that the sum of the
+ *        weights is kept, so that the link usage penalty keeps its meaning.
+ */
+template <typename T>
+inline void ScaleP2PWeight(const std::vector<float>& bandwidth,
+                           int num_gpus,
+                           std::vector<T>* matrix) {
+  double weight_sum = 0., bandwidth_sum = 0.;
+  for (int row = 0; row < num_gpus; ++row) {
+    for (int col = 0; col < num_gpus; ++col) {
+      const int i = row * num_gpus + col;
+      if (row != col && (*matrix)[i] > 0) {
+        weight_sum += (*matrix)[i];
+        bandwidth_sum += 0.5 * (bandwidth[i] + bandwidth[col * num_gpus + row]);
+      }
+    }
+  }
+  if (bandwidth_sum <= 0.) {
+    LOG(WARNING) << "No link bandwidth measured, keeping the assumed link weights";
+    return;
+  }
+  const double scale = weight_sum / bandwidth_sum;
+  for (int row = 0; row < num_gpus; ++row) {
+    for (int col = 0; col < num_gpus; ++col) {
+      const int i = row * num_gpus + col;
+      if (row != col && (*matrix)[i] > 0) {
+        (*matrix)[i] =
+            static_cast<T>(scale * 0.5 * (bandwidth[i] + bandwidth[col * num_gpus + row]));
+      }
+    }
+  }
+  if (kLogTree)
+    PrintMatrix("Calibrated weight", *matrix, num_gpus, num_gpus);
+}
+
+/**
+ * \brief Measure the bandwidth of the links used by the reduction trees
+ * \param devs is a vector of GPU contexts
+ * \param bytes is the size of the transfers used for measuring
+ * \param matrix is adjacency matrix of link weights, only links of nonzero weight
+ *        are measured
+ * \param bandwidth stores measured bandwidths in GB/s, where row sends to col
+ * \return whether all the links could be measured
+ */
+template <typename T>
+inline bool MeasureP2PBandwidth(const std::vector<Context>& devs,
+                                size_t bytes,
+                                const std::vector<T>& matrix,
+                                std::vector<float>* bandwidth) {
+  const int num_gpus = devs.size();
+  bandwidth->assign(num_gpus * num_gpus, 0.f);
+#if MXNET_USE_CUDA
+  const int kRepeat = 5;
+  std::vector<void*> bufs(num_gpus, nullptr);
+  bool success = true;
+  for (int i = 0; i < num_gpus && success; ++i) {
+    mxnet::common::cuda::DeviceStore device_store(devs[i].dev_id);
+    success = cudaMalloc(&bufs[i], 2 * bytes) == cudaSuccess;
+  }
+  for (int row = 0; row < num_gpus && success; ++row) {
+    mxnet::common::cuda::DeviceStore device_store(devs[row].dev_id);
+    cudaStream_t stream;
+    cudaEvent_t start, stop;
+    success = cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking) == cudaSuccess;
+    if (!success)
+      break;
+    cudaEventCreate(&start);
+    cudaEventCreate(&stop);
+    for (int col = 0; col < num_gpus && success; ++col) {
+      if (row == col || matrix[row * num_gpus + col] <= 0)
+        continue;
+      // the first transfer is not timed, it pays for establishing the mapping
+      void* dst = static_cast<char*>(bufs[col]) + bytes;
+      for (int r = 0; r <= kRepeat && success; ++r) {
+        if (r == 1)
+          cudaEventRecord(start, stream);
+        success = cudaMemcpyPeerAsync(
+                      dst, devs[col].dev_id, bufs[row], devs[row].dev_id, bytes, stream) ==
+                  cudaSuccess;
+      }
+      cudaEventRecord(stop, stream);
+      float ms = 0.f;
+      success  = success && cudaEventSynchronize(stop) == cudaSuccess &&
+                cudaEventElapsedTime(&ms, start, stop) == cudaSuccess && ms > 0.f;
+      if (success)
+        (*bandwidth)[row * num_gpus + col] = kRepeat * bytes / (ms * 1e6f);
+    }
+    cudaEventDestroy(start);
+    cudaEventDestroy(stop);
+    cudaStreamDestroy(stream);
+  }
+  for (int i = 0; i < num_gpus; ++i) {
+    if (bufs[i] != nullptr) {
+      mxnet::common::cuda::DeviceStore device_store(devs[i].dev_id);
+      cudaFree(bufs[i]);
+    }
+  }
+  if (!success) {
+    // clear the sticky error of the failed call
+    cudaGetLastError();
+    LOG(WARNING) << "Measuring the GPU link bandwidth failed, keeping the assumed link weights";
+  }
+  if (success && kLogTree)
+    PrintMatrix("Bandwidth (GB/s)", *bandwidth, num_gpus, num_gpus);
+  return success;
+#else
+  LOG(WARNING) << "GPU required for link topology";
+  return false;
+#endif
+}
+
+/**
+ * \brief Number of trees a dense array is striped over
+ * \param total_size is the number of elements of the array
+ * \param first_size is the size of the first dimension, along which it is striped
+ * \param num_gpus is the number of GPUs, i.e. of trees
+ * \param array_bound is the size above which an array is striped over all the trees
+ * \param stripe_size is the minimum number of elements per stripe for arrays not
+ *        bigger than array_bound, 0 to not stripe them
+ */
+inline int ComputeNumStripes(size_t total_size,
+                             size_t first_size,
+                             int num_gpus,
+                             size_t array_bound,
+                             size_t stripe_size) {
+  int num_stripes = 1;
+  if (total_size > array_bound) {
+    num_stripes = num_gpus;
+  } else if (stripe_size > 0) {
+    num_stripes = std::min<size_t>(num_gpus, total_size / stripe_size);
+  }
+  // every stripe must be made of at least two rows
+  num_stripes = std::min<size_t>(num_stripes, first_size / 2);
+  return std::max(num_stripes, 1);
+}
+
+/**
+ * \brief Select the trees a message is reduced over, by their load
+ * \param bytes is the size of the message
+ * \param num_stripes is the number of trees the message is striped over
+ * \param load is the number of bytes already assigned to the tree of every root,
+ *        the stripes of the message are added to it
+ * \param roots stores the roots of the selected trees, the least loaded first
+ */
+inline void SelectTrees(size_t bytes,
+                        int num_stripes,
+                        std::vector<size_t>* load,
+                        std::vector<int>* roots) {
+  std::vector<int> order(load->size());
+  for (unsigned i = 0; i < order.size(); ++i)
+    order[i] = i;
+  // ties are broken by the root, so that the assignment is deterministic
+  std::stable_sort(
+      order.begin(), order.end(), [load](int a, int b) { return (*load)[a] < (*load)[b]; });
+  roots->assign(order.begin(), order.begin() + num_stripes);
+  for (const int root : *roots)
+    (*load)[root] += bytes / num_stripes;
+}
 }  // namespace kvstore
 }  // namespace mxnet
 #endif  // MXNET_KVSTORE_GPU_TOPOLOGY_H_
@@ -25,6 +25,7 @@
 #ifndef MXNET_KVSTORE_GRADIENT_COMPRESSION_INL_H_
 #define MXNET_KVSTORE_GRADIENT_COMPRESSION_INL_H_
 
+#include <cmath>
 #include <vector>
 #include "../operator/mxnet_op.h"
 
@@ -44,6 +45,20 @@ void Quantize2BitImpl(mshadow::Stream<mshadow::gpu>* s,
 void Dequantize2BitImpl(mshadow::Stream<mshadow::gpu>* s,
                         const std::vector<mxnet::TBlob>& inputs,
                         const float threshold);
+void QuantizeTopKImpl(mshadow::Stream<mshadow::gpu>* s,
+                      const std::vector<mxnet::TBlob>& inputs,
+                      const int chunk_size);
+void DequantizeTopKImpl(mshadow::Stream<mshadow::gpu>* s,
+                        const std::vector<mxnet::TBlob>& inputs,
+                        const int chunk_size);
+void QuantizePowerSGDImpl(mshadow::Stream<mshadow::gpu>* s,
+                          const std::vector<mxnet::TBlob>& inputs,
+                          const int rank,
+                          const int block_size);
+void DequantizePowerSGDImpl(mshadow::Stream<mshadow::gpu>* s,
+                            const std::vector<mxnet::TBlob>& inputs,
+                            const int rank,
+                            const int block_size);
 
 struct quantize_1bit {
   MSHADOW_XINLINE static void Map(int out_byte_id,
@@ -232,6 +247,204 @@ void Dequantize2BitKernelLaunch(mshadow::Stream<xpu>* s,
       threshold);               // positive threshold
 }
 
+struct quantize_topk {
+  MSHADOW_XINLINE static void Map(int out_id,
+                                  int original_size,
+                                  float* out,
+                                  float* grad,
+                                  float* residual,
+                                  const int chunk_size) {
+    // start and end are indices in original grad array
+    const int start = out_id * chunk_size;
+    const int end   = (start + chunk_size <= original_size) ? start + chunk_size : original_size;
+    int top         = start;
+    for (int i = start; i < end; ++i) {
+      // adds gradient to existing residual to get updated grad
+      residual[i] += grad[i];
+      if (fabsf(residual[i]) > fabsf(residual[top]))
+        top = i;
+    }
+    // send the value of largest magnitude as half, clipped to its range,
+    // and keep what is not sent in the residual
+    const float kHalfMax = 65504.f;
+    const mshadow::half::half_t sent(fminf(fmaxf(residual[top], -kHalfMax), kHalfMax));
+    residual[top] -= static_cast<float>(sent);
+    // the upper 16 bits hold the position in the chunk, the lower 16 bits the value
+    reinterpret_cast<uint32_t*>(out)[out_id] =
+        (static_cast<uint32_t>(top - start) << 16) | static_cast<uint32_t>(sent.half_);
+  }
+};
+
+template <typename xpu>
+void QuantizeTopKKernelLaunch(mshadow::Stream<xpu>* s,
+                              const std::vector<mxnet::TBlob>& inputs,
+                              const int chunk_size) {
+  mxnet::op::mxnet_op::Kernel<quantize_topk, xpu>::Launch(
+      s,
+      inputs[2].Size(),         // compressed array size
+      inputs[0].Size(),         // original size
+      inputs[2].dptr<float>(),  // compressed array
+      inputs[0].dptr<float>(),  // original array
+      inputs[1].dptr<float>(),  // residual array
+      chunk_size);              // number of values per compressed value
+}
+
+struct dequantize_topk {
+  MSHADOW_XINLINE static void Map(int i, float* out, float* in, const int chunk_size) {
+    const uint32_t packed = reinterpret_cast<uint32_t*>(in)[i / chunk_size];
+    if (static_cast<int>(packed >> 16) == i % chunk_size) {
+      out[i] = static_cast<float>(mshadow::half::half_t::Binary(packed & 0xffff));
+    } else {
+      out[i] = 0;
+    }
+  }
+};
+
+template <typename xpu>
+void DequantizeTopKKernelLaunch(mshadow::Stream<xpu>* s,
+                                const std::vector<mxnet::TBlob>& inputs,
+                                const int chunk_size) {
+  mxnet::op::mxnet_op::Kernel<dequantize_topk, xpu>::Launch(
+      s,
+      inputs[1].Size(),         // original size
+      inputs[1].dptr<float>(),  // out array
+      inputs[0].dptr<float>(),  // compressed array
+      chunk_size);              // number of values per compressed value
+}
+
+/*!
+ * \brief Approximates a block_size x block_size block of the residual, stored row major in
+ *  the flattened gradient, by P * Q^T with one step of power iteration, where P and Q
+ *  are block_size x rank. The Q of the previous step, left in the compressed array,
+ *  is used as starting point. The compressed block holds P followed by Q, row major.
+ */
+struct quantize_powersgd {
+  MSHADOW_XINLINE static void Map(int block_id,
+                                  int original_size,
+                                  float* out,
+                                  float* grad,
+                                  float* residual,
+                                  const int rank,
+                                  const int block_size) {
+    const int n     = block_size;
+    const int start = block_id * n * n;
+    // number of values of this block, the last block may be partial
+    const int size = (start + n * n <= original_size) ? n * n : original_size - start;
+    float* m       = residual + start;
+    float* p       = out + block_id * 2 * n * rank;
+    float* q       = p + n * rank;
+    for (int i = 0; i < size; ++i) {
+      m[i] += grad[start + i];
+    }
+    float q_norm = 0;
+    for (int i = 0; i < n * rank; ++i) {
+      q_norm += q[i] * q[i];
+    }
+    if (!(q_norm > 0 && q_norm < 1e30f)) {
+      // first push of the block, start from a fixed pseudo random sign pattern
+      for (int i = 0; i < n * rank; ++i) {
+        q[i] = ((static_cast<uint32_t>(i) * 2654435761u) >> 16) & 1 ? 1.f : -1.f;
+      }
+    }
+    // P = M * Q
+    for (int r = 0; r < n; ++r) {
+      for (int k = 0; k < rank; ++k) {
+        float sum = 0;
+        for (int c = 0; c < n && r * n + c < size; ++c) {
+          sum += m[r * n + c] * q[c * rank + k];
+        }
+        p[r * rank + k] = sum;
+      }
+    }
+    // orthonormalize the columns of P with Gram-Schmidt
+    for (int k = 0; k < rank; ++k) {
+      for (int l = 0; l < k; ++l) {
+        float dot = 0;
+        for (int r = 0; r < n; ++r) {
+          dot += p[r * rank + l] * p[r * rank + k];
+        }
+        for (int r = 0; r < n; ++r) {
+          p[r * rank + k] -= dot * p[r * rank + l];
+        }
+      }
+      float norm = 0;
+      for (int r = 0; r < n; ++r) {
+        norm += p[r * rank + k] * p[r * rank + k];
+      }
+      const float scale = norm > 1e-30f ? 1.f / sqrtf(norm) : 0.f;
+      for (int r = 0; r < n; ++r) {
+        p[r * rank + k] *= scale;
+      }
+    }
+    // Q = M^T * P
+    for (int c = 0; c < n; ++c) {
+      for (int k = 0; k < rank; ++k) {
+        float sum = 0;
+        for (int r = 0; r < n && r * n + c < size; ++r) {
+          sum += m[r * n + c] * p[r * rank + k];
+        }
+        q[c * rank + k] = sum;
+      }
+    }
+    // keep what is not sent in the residual
+    for (int i = 0; i < size; ++i) {
+      const int r = i / n;
+      const int c = i % n;
+      for (int k = 0; k < rank; ++k) {
+        m[i] -= p[r * rank + k] * q[c * rank + k];
+      }
+    }
+  }
+};
+
+template <typename xpu>
+void QuantizePowerSGDKernelLaunch(mshadow::Stream<xpu>* s,
+                                  const std::vector<mxnet::TBlob>& inputs,
+                                  const int rank,
+                                  const int block_size) {
+  mxnet::op::mxnet_op::Kernel<quantize_powersgd, xpu>::Launch(
+      s,
+      inputs[2].Size() / (2 * block_size * rank),  // number of blocks
+      inputs[0].Size(),                            // original size
+      inputs[2].dptr<float>(),                     // compressed array
+      inputs[0].dptr<float>(),                     // original array
+      inputs[1].dptr<float>(),                     // residual array
+      rank,                                        // rank of the approximation
+      block_size);                                 // block size
+}
+
+struct dequantize_powersgd {
+  MSHADOW_XINLINE static void Map(int i,
+                                  float* out,
+                                  float* in,
+                                  const int rank,
+                                  const int block_size) {
+    const int n     = block_size;
+    const int local = i % (n * n);
+    const float* p  = in + (i / (n * n)) * 2 * n * rank + (local / n) * rank;
+    const float* q  = in + (i / (n * n)) * 2 * n * rank + n * rank + (local % n) * rank;
+    float sum       = 0;
+    for (int k = 0; k < rank; ++k) {
+      sum += p[k] * q[k];
+    }
+    out[i] = sum;
+  }
+};
+
+template <typename xpu>
+void DequantizePowerSGDKernelLaunch(mshadow::Stream<xpu>* s,
+                                    const std::vector<mxnet::TBlob>& inputs,
+                                    const int rank,
+                                    const int block_size) {
+  mxnet::op::mxnet_op::Kernel<dequantize_powersgd, xpu>::Launch(
+      s,
+      inputs[1].Size(),         // original size
+      inputs[1].dptr<float>(),  // out array
+      inputs[0].dptr<float>(),  // compressed array
+      rank,                     // rank of the approximation
+      block_size);              // block size
+}
+
 inline void Quantize1BitImpl(mshadow::Stream<mshadow::cpu>* s,
                              const std::vector<mxnet::TBlob>& inputs,
                              const float threshold) {
@@ -255,6 +468,32 @@ inline void Dequantize2BitImpl(mshadow::Stream<mshadow::cpu>* s,
                                const float threshold) {
   Dequantize2BitKernelLaunch(s, inputs, threshold);
 }
+
+inline void QuantizeTopKImpl(mshadow::Stream<mshadow::cpu>* s,
+                             const std::vector<mxnet::TBlob>& inputs,
+                             const int chunk_size) {
+  QuantizeTopKKernelLaunch(s, inputs, chunk_size);
+}
+
+inline void DequantizeTopKImpl(mshadow::Stream<mshadow::cpu>* s,
+                               const std::vector<mxnet::TBlob>& inputs,
+                               const int chunk_size) {
+  DequantizeTopKKernelLaunch(s, inputs, chunk_size);
+}
+
+inline void QuantizePowerSGDImpl(mshadow::Stream<mshadow::cpu>* s,
+                                 const std::vector<mxnet::TBlob>& inputs,
+                                 const int rank,
+                                 const int block_size) {
+  QuantizePowerSGDKernelLaunch(s, inputs, rank, block_size);
+}
+
+inline void DequantizePowerSGDImpl(mshadow::Stream<mshadow::cpu>* s,
+                                   const std::vector<mxnet::TBlob>& inputs,
+                                   const int rank,
+                                   const int block_size) {
+  DequantizePowerSGDKernelLaunch(s, inputs, rank, block_size);
+}
 }  // namespace kvstore
 }  // namespace mxnet
 
@@ -23,6 +23,7 @@
  * \author Rahul Huilgol
  */
 
+#include <cmath>
 #include <vector>
 #include "kvstore_local.h"
 #include "gradient_compression.h"
@@ -46,6 +47,18 @@ void GradientCompression::SetParams(
   } else if (params.type == "2bit") {
     CHECK_GT(params.threshold, 0) << "threshold must be greater than 0 for two bit compression";
     SetTwoBitCompression(params.threshold);
+  } else if (params.type == "topk") {
+    CHECK(params.ratio > 0 && params.ratio <= 0.5)
+        << "ratio must be in (0, 0.5] for topk compression";
+    const int chunk_size = static_cast<int>(std::round(1 / params.ratio));
+    // the position in a chunk is stored in 16 bits
+    CHECK_LE(chunk_size, 1 << 16) << "ratio must be at least 1/65536 for topk compression";
+    SetTopKCompression(chunk_size);
+  } else if (params.type == "powersgd") {
+    CHECK_GT(params.rank, 0) << "rank must be greater than 0 for powersgd compression";
+    CHECK(params.block_size % (2 * params.rank) == 0 && params.block_size <= 1024)
+        << "block_size must be a multiple of 2 * rank and at most 1024 for powersgd compression";
+    SetPowerSGDCompression(params.rank, params.block_size);
   } else {
     LOG(FATAL) << "Unknown type for gradient compression " << params.type;
   }
@@ -69,11 +82,23 @@ void GradientCompression::SetTwoBitCompression(const float threshold) {
   threshold_ = threshold;
 }
 
+void GradientCompression::SetTopKCompression(const int chunk_size) {
+  type_       = CompressionType::kTopK;
+  chunk_size_ = chunk_size;
+}
+
+void GradientCompression::SetPowerSGDCompression(const int rank, const int block_size) {
+  type_       = CompressionType::kPowerSGD;
+  rank_       = rank;
+  block_size_ = block_size;
+}
+
 std::string GradientCompression::EncodeParams() {
   using namespace std;  // to reduce length of next line
   string rval = get_type_str();
   if (type_ != CompressionType::kNone) {
     rval += "," + to_string(threshold_);
+    rval += "," + to_string(chunk_size_) + "," + to_string(rank_) + "," + to_string(block_size_);
   }
   return rval;
 }
@@ -87,6 +112,11 @@ void GradientCompression::DecodeParams(const std::string& s) {
       threshold_ = stof(elems[1]);
     }
   }
+  if (elems.size() > 4) {
+    chunk_size_ = stoi(elems[2]);
+    rank_       = stoi(elems[3]);
+    block_size_ = stoi(elems[4]);
+  }
 }
 
 int GradientCompression::GetCompressionFactor() {
@@ -94,15 +124,27 @@ int GradientCompression::GetCompressionFactor() {
     return 32;
   } else if (type_ == CompressionType::kTwoBit) {
     return 16;
+  } else if (type_ == CompressionType::kTopK) {
+    // one packed position and value per chunk
+    return chunk_size_;
+  } else if (type_ == CompressionType::kPowerSGD) {
+    // two block_size x rank factors per block of block_size x block_size values
+    return block_size_ / (2 * rank_);
   } else {
     LOG(FATAL) << "Unsupported compression type: " << get_type_str();
     return 0;
   }
 }
 
+int GradientCompression::GetCompressedBlockSize() {
+  return type_ == CompressionType::kPowerSGD ? 2 * block_size_ * rank_ : 1;
+}
+
 int64_t GradientCompression::GetCompressedSize(const int64_t original_size) {
-  const int bits = GetCompressionFactor();
-  return ((original_size % bits == 0) ? original_size / bits : original_size / bits + 1);
+  const int64_t block     = GetCompressedBlockSize();
+  const int64_t orig_size = GetCompressionFactor() * block;
+  const int64_t blocks    = (original_size + orig_size - 1) / orig_size;
+  return blocks * block;
 }
 
 void GradientCompression::Quantize(const mxnet::NDArray& from,
@@ -115,6 +157,9 @@ void GradientCompression::Quantize(const mxnet::NDArray& from,
   const int a           = from.ctx().dev_mask();
   const int b           = to->ctx().dev_mask();
   const float threshold = threshold_;
+  const int chunk_size  = chunk_size_;
+  const int rank        = rank_;
+  const int block_size  = block_size_;
   if (a == mshadow::cpu::kDevMask && b == mshadow::cpu::kDevMask) {
     if (type_ == CompressionType::kOneBit) {
       mxnet::Engine::Get()->PushSync(
@@ -140,6 +185,30 @@ void GradientCompression::Quantize(const mxnet::NDArray& from,
           mxnet::FnProperty::kNormal,
           priority,
           "QuantizeCPU");
+    } else if (type_ == CompressionType::kTopK) {
+      mxnet::Engine::Get()->PushSync(
+          [from, to, residual, chunk_size](mxnet::RunContext ctx) {
+            std::vector<mxnet::TBlob> inputs = {from.data(), residual->data(), to->data()};
+            QuantizeTopKImpl(ctx.get_stream<mshadow::cpu>(), inputs, chunk_size);
+          },
+          from.ctx(),
+          {from.var()},
+          {to->var(), residual->var()},
+          mxnet::FnProperty::kNormal,
+          priority,
+          "QuantizeCPU");
+    } else if (type_ == CompressionType::kPowerSGD) {
+      mxnet::Engine::Get()->PushSync(
+          [from, to, residual, rank, block_size](mxnet::RunContext ctx) {
+            std::vector<mxnet::TBlob> inputs = {from.data(), residual->data(), to->data()};
+            QuantizePowerSGDImpl(ctx.get_stream<mshadow::cpu>(), inputs, rank, block_size);
+          },
+          from.ctx(),
+          {from.var()},
+          {to->var(), residual->var()},
+          mxnet::FnProperty::kNormal,
+          priority,
+          "QuantizeCPU");
     } else {
       LOG(FATAL) << "Unsupported quantization of type " << get_type_str();
     }
@@ -170,6 +239,30 @@ void GradientCompression::Quantize(const mxnet::NDArray& from,
             mxnet::FnProperty::kNormal,
             priority,
             "QuantizeGPU");
+      } else if (type_ == CompressionType::kTopK) {
+        mxnet::Engine::Get()->PushSync(
+            [from, to, residual, chunk_size](mxnet::RunContext ctx) {
+              std::vector<mxnet::TBlob> inputs = {from.data(), residual->data(), to->data()};
+              QuantizeTopKImpl(ctx.get_stream<mshadow::gpu>(), inputs, chunk_size);
+            },
+            from.ctx(),
+            {from.var()},
+            {to->var(), residual->var()},
+            mxnet::FnProperty::kNormal,
+            priority,
+            "QuantizeGPU");
+      } else if (type_ == CompressionType::kPowerSGD) {
+        mxnet::Engine::Get()->PushSync(
+            [from, to, residual, rank, block_size](mxnet::RunContext ctx) {
+              std::vector<mxnet::TBlob> inputs = {from.data(), residual->data(), to->data()};
+              QuantizePowerSGDImpl(ctx.get_stream<mshadow::gpu>(), inputs, rank, block_size);
+            },
+            from.ctx(),
+            {from.var()},
+            {to->var(), residual->var()},
+            mxnet::FnProperty::kNormal,
+            priority,
+            "QuantizeGPU");
       } else {
         LOG(FATAL) << "Unsupported quantization of type " << get_type_str();
       }
@@ -190,6 +283,9 @@ void GradientCompression::Dequantize(const mxnet::NDArray& from,
   const int a           = from.ctx().dev_mask();
   const int b           = to->ctx().dev_mask();
   const float threshold = threshold_;
+  const int chunk_size  = chunk_size_;
+  const int rank        = rank_;
+  const int block_size  = block_size_;
   if (a == mshadow::cpu::kDevMask && b == mshadow::cpu::kDevMask) {
     if (type_ == CompressionType::kOneBit) {
       mxnet::Engine::Get()->PushSync(
@@ -215,6 +311,30 @@ void GradientCompression::Dequantize(const mxnet::NDArray& from,
           mxnet::FnProperty::kNormal,
           priority,
           "DequantizeCPU");
+    } else if (type_ == CompressionType::kTopK) {
+      mxnet::Engine::Get()->PushSync(
+          [from, to, chunk_size](mxnet::RunContext ctx) {
+            std::vector<mxnet::TBlob> inputs = {from.data(), to->data()};
+            DequantizeTopKImpl(ctx.get_stream<mshadow::cpu>(), inputs, chunk_size);
+          },
+          from.ctx(),
+          {from.var()},
+          {to->var()},
+          mxnet::FnProperty::kNormal,
+          priority,
+          "DequantizeCPU");
+    } else if (type_ == CompressionType::kPowerSGD) {
+      mxnet::Engine::Get()->PushSync(
+          [from, to, rank, block_size](mxnet::RunContext ctx) {
+            std::vector<mxnet::TBlob> inputs = {from.data(), to->data()};
+            DequantizePowerSGDImpl(ctx.get_stream<mshadow::cpu>(), inputs, rank, block_size);
+          },
+          from.ctx(),
+          {from.var()},
+          {to->var()},
+          mxnet::FnProperty::kNormal,
+          priority,
+          "DequantizeCPU");
     } else {
       LOG(FATAL) << "Unsupported dequantization of type " << get_type_str();
     }
@@ -249,6 +369,34 @@ void GradientCompression::Dequantize(const mxnet::NDArray& from,
             mxnet::FnProperty::kNormal,
             priority,
             "DequantizeGPU");
+      } else if (type_ == CompressionType::kTopK) {
+        mxnet::Engine::Get()->PushSync(
+            [from, to, chunk_size](mxnet::RunContext ctx) {
+              std::vector<mxnet::TBlob> inputs = {from.data(), to->data()};
+              DequantizeTopKImpl(ctx.get_stream<mshadow::gpu>(), inputs, chunk_size);
+              // Wait GPU kernel to complete
+              ctx.get_stream<mshadow::gpu>()->Wait();
+            },
+            from.ctx(),
+            {from.var()},
+            {to->var()},
+            mxnet::FnProperty::kNormal,
+            priority,
+            "DequantizeGPU");
+      } else if (type_ == CompressionType::kPowerSGD) {
+        mxnet::Engine::Get()->PushSync(
+            [from, to, rank, block_size](mxnet::RunContext ctx) {
+              std::vector<mxnet::TBlob> inputs = {from.data(), to->data()};
+              DequantizePowerSGDImpl(ctx.get_stream<mshadow::gpu>(), inputs, rank, block_size);
+              // Wait GPU kernel to complete
+              ctx.get_stream<mshadow::gpu>()->Wait();
+            },
+            from.ctx(),
+            {from.var()},
+            {to->var()},
+            mxnet::FnProperty::kNormal,
+            priority,
+            "DequantizeGPU");
       } else {
         LOG(FATAL) << "Unsupported dequantization of type " << get_type_str();
       }
@@ -50,5 +50,31 @@ void Dequantize2BitImpl(mshadow::Stream<gpu>* s,
                         const float threshold) {
   Dequantize2BitKernelLaunch(s, inputs, threshold);
 }
+
+void QuantizeTopKImpl(mshadow::Stream<gpu>* s,
+                      const std::vector<TBlob>& inputs,
+                      const int chunk_size) {
+  QuantizeTopKKernelLaunch(s, inputs, chunk_size);
+}
+
+void DequantizeTopKImpl(mshadow::Stream<gpu>* s,
+                        const std::vector<TBlob>& inputs,
+                        const int chunk_size) {
+  DequantizeTopKKernelLaunch(s, inputs, chunk_size);
+}
+
+void QuantizePowerSGDImpl(mshadow::Stream<gpu>* s,
+                          const std::vector<TBlob>& inputs,
+                          const int rank,
+                          const int block_size) {
+  QuantizePowerSGDKernelLaunch(s, inputs, rank, block_size);
+}
+
+void DequantizePowerSGDImpl(mshadow::Stream<gpu>* s,
+                            const std::vector<TBlob>& inputs,
+                            const int rank,
+                            const int block_size) {
+  DequantizePowerSGDKernelLaunch(s, inputs, rank, block_size);
+}
 }  // namespace kvstore
 }  // namespace mxnet
@@ -34,16 +34,25 @@
 namespace mxnet {
 namespace kvstore {
 
-enum class CompressionType { kNone, kOneBit, kTwoBit };
+enum class CompressionType { kNone, kOneBit, kTwoBit, kTopK, kPowerSGD };
 
 struct GradientCompressionParam : public dmlc::Parameter<GradientCompressionParam> {
   std::string type;
   float threshold;
+  float ratio;
+  int rank;
+  int block_size;
   DMLC_DECLARE_PARAMETER(GradientCompressionParam) {
     DMLC_DECLARE_FIELD(type).describe(
         "Type of gradient compression to use, like `2bit` for example");
     DMLC_DECLARE_FIELD(threshold).set_default(0.5).describe(
         "Threshold to use for 2bit gradient compression");
+    DMLC_DECLARE_FIELD(ratio).set_default(0.01).describe(
+        "Fraction of the gradient values sent with topk gradient compression");
+    DMLC_DECLARE_FIELD(rank).set_default(1).describe(
+        "Rank of the approximation with powersgd gradient compression");
+    DMLC_DECLARE_FIELD(block_size).set_default(64).describe(
+        "Size of the square blocks approximated with powersgd gradient compression");
   }
 };
 
@@ -82,6 +91,19 @@ class GradientCompression {
    */
   void SetTwoBitCompression(const float threshold);
 
+  /*!
+   * \brief sets top-k gradient compression with error feedback
+   * \param chunk_size the largest value of every chunk of chunk_size values is sent
+   */
+  void SetTopKCompression(const int chunk_size);
+
+  /*!
+   * \brief sets low rank gradient compression with error feedback
+   * \param rank rank of the approximation
+   * \param block_size the gradient is approximated in blocks of block_size x block_size values
+   */
+  void SetPowerSGDCompression(const int rank, const int block_size);
+
   /*!
    * \brief encodes parameters of gc into a string
    */
@@ -98,6 +120,12 @@ class GradientCompression {
    */
   int GetCompressionFactor();
 
+  /*!
+   * \brief returns the number of compressed values which can only be decompressed together.
+   * Parts of a compressed gradient sent to different servers hold whole blocks.
+   */
+  int GetCompressedBlockSize();
+
   /*!
    * \brief returns the size of compressed gradients given an original sized gradient array
    */
@@ -138,6 +166,17 @@ class GradientCompression {
    * all negative gradients will be thresholded to -1*`threshold_`
    */
   float threshold_ = 0;
+
+  /*!
+   * \brief number of consecutive values from which top-k compression sends the largest one
+   */
+  int chunk_size_ = 0;
+
+  /*!
+   * \brief rank and block size of powersgd compression
+   */
+  int rank_       = 0;
+  int block_size_ = 0;
 };
 }  // namespace kvstore
 }  // namespace mxnet
@@ -28,6 +28,9 @@
 #if MXNET_USE_DIST_KVSTORE
 #include "./kvstore_dist.h"
 #include "./p3store_dist.h"
+#if MXNET_USE_NCCL
+#include "./kvstore_dist_nccl.h"
+#endif  // MXNET_USE_NCCL
 std::atomic<int> mxnet::kvstore::KVStoreDist::customer_id_{0};
 #endif  // MXNET_USE_DIST_KVSTORE
 #if MXNET_USE_NCCL
@@ -53,7 +56,15 @@ KVStore* KVStore::Create(const char* type_name) {
   if (has("dist")) {
 #if MXNET_USE_DIST_KVSTORE
     auto ps_type = dmlc::GetEnv("DMLC_PS_VAN_TYPE", std::string("none"));
-    if (ps_type == "p3") {
+    if (has("nccl")) {
+#if MXNET_USE_NCCL
+      CHECK(!has("async")) << "Asynchronous update is not supported in KVStoreDistNCCL";
+      kv = new kvstore::KVStoreDistNCCL();
+#else
+      LOG(FATAL) << "compile with USE_NCCL=1 to use " << tname;
+      return nullptr;
+#endif  // MXNET_USE_NCCL
+    } else if (ps_type == "p3") {
       CHECK(!has("async")) << "Asynchronous update is not supported in P3StoreDist";
       kv = new kvstore::P3StoreDist(use_device_comm);
     } else {
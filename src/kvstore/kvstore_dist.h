@@ -26,11 +26,16 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <memory>
 #include <utility>
 #include "./kvstore_local.h"
 #include "mxnet/engine.h"
 #include "ps/ps.h"
 #include "./kvstore_dist_server.h"
+#include "./comm_scheduler.h"
+#if MXNET_USE_NCCL
+#include "./kvstore_dist_node_group.h"
+#endif  // MXNET_USE_NCCL
 namespace mxnet {
 namespace kvstore {
 
@@ -52,15 +57,32 @@ class KVStoreDist : public KVStoreLocal {
         ps::Postoffice::Get()->Barrier(new_customer_id,
                                        ps::kWorkerGroup + ps::kServerGroup + ps::kScheduler);
       }
+#if MXNET_USE_NCCL
+      if (dmlc::GetEnv("MXNET_KVSTORE_HIERARCHICAL", false)) {
+        node_group_.reset(new NodeGroup(ps_worker_, get_rank(), get_group_size()));
+        if (get_rank() == 0) {
+          SendCommandToServers(static_cast<int>(CommandType::kSetNumPushers),
+                               std::to_string(node_group_->num_leaders()));
+        }
+      }
+#endif  // MXNET_USE_NCCL
     }
     bigarray_bound_ = dmlc::GetEnv("MXNET_KVSTORE_BIGARRAY_BOUND", 1000 * 1000);
     log_verbose_    = dmlc::GetEnv("MXNET_KVSTORE_DIST_ROW_SPARSE_VERBOSE", false);
+    chunk_bytes_    = dmlc::GetEnv("MXNET_KVSTORE_SCHEDULE_CHUNK_SIZE", size_t{0});
+    if (chunk_bytes_ > 0) {
+      scheduler_.reset(new CommScheduler(
+          dmlc::GetEnv("MXNET_KVSTORE_SCHEDULE_CREDIT", 4 * chunk_bytes_)));
+    }
   }
 
   virtual ~KVStoreDist() {
     Engine::Get()->WaitForAll();
     customer_id_ = 0;
     if (IsWorkerNode()) {
+#if MXNET_USE_NCCL
+      node_group_.reset();
+#endif  // MXNET_USE_NCCL
       if (barrier_before_exit_) {
         Barrier();
         if (get_rank() == 0 && ps_worker_->get_customer()->customer_id() == 0) {
@@ -235,7 +257,7 @@ class KVStoreDist : public KVStoreLocal {
       const auto& vals = grouped_vals[i];
       const auto& outs = grouped_outs[i];
 
-      NDArray merged = comm_->Reduce(key, vals, priority);
+      NDArray merged = ReduceOverNode(key, comm_->Reduce(key, vals, priority), priority);
 
       const auto push_stype = merged.storage_type();
       const auto pull_stype = outs[0]->storage_type();
@@ -246,20 +268,23 @@ class KVStoreDist : public KVStoreLocal {
       const int pull_dtype = outs[0]->dtype();
       CHECK_EQ(push_dtype, pull_dtype) << "Output buffer dtype is different";
 
-      auto& comm_buf = comm_buf_[key];
-      if (merged.ctx().dev_mask() == cpu::kDevMask) {
-        comm_buf = merged;  // avoid memory copy
-      } else {
-        if (comm_buf.is_none()) {
-          comm_buf = NDArray(outs[0]->shape(), pinned_ctx_, true, pull_dtype);
+      if (IsNodeLeader()) {
+        auto& comm_buf = comm_buf_[key];
+        if (merged.ctx().dev_mask() == cpu::kDevMask) {
+          comm_buf = merged;  // avoid memory copy
+        } else {
+          if (comm_buf.is_none()) {
+            comm_buf = NDArray(outs[0]->shape(), pinned_ctx_, true, pull_dtype);
+          }
+          CopyFromTo(merged, &comm_buf);
         }
-        CopyFromTo(merged, &comm_buf);
-      }
 
-      CHECK(gradient_compression_->get_type() == CompressionType::kNone)
-          << "Compression not supported with PushPull";
-      PushPullDefault(key, comm_buf, priority);
-      comm_->Broadcast(key, comm_buf, outs, priority);
+        CHECK(gradient_compression_->get_type() == CompressionType::kNone)
+            << "Compression not supported with PushPull";
+        PushPullDefault(key, comm_buf, priority);
+        merged = comm_buf;
+      }
+      comm_->Broadcast(key, BroadcastOverNode(key, merged, priority), outs, priority);
     }
   }
 
@@ -290,15 +315,20 @@ class KVStoreDist : public KVStoreLocal {
         recv_buf =
             NDArray(grouped_vals[i][0]->shape(), pinned_ctx_, true, grouped_vals[i][0]->dtype());
       }
-      PullDefault(key, recv_buf, priority);
+      if (IsNodeLeader()) {
+        PullDefault(key, recv_buf, priority);
+      }
 
-      comm_->Broadcast(key, recv_buf, grouped_vals[i], priority);
+      comm_->Broadcast(key, BroadcastOverNode(key, recv_buf, priority), grouped_vals[i], priority);
     }
   }
 
   void PullRowSparseImpl(const std::vector<int>& keys,
                          const std::vector<std::pair<NDArray*, NDArray>>& val_rowids,
                          int priority = 0) override {
+#if MXNET_USE_NCCL
+    CHECK(!node_group_) << "PullRowSparse is not supported by hierarchical KVStoreDist";
+#endif  // MXNET_USE_NCCL
     std::vector<int> uniq_keys;
     std::vector<std::vector<std::pair<NDArray*, NDArray>>> grouped_val_rowids;
     GroupKVPairsPullRsp(keys, val_rowids, &uniq_keys, &grouped_val_rowids, false);
@@ -352,7 +382,12 @@ class KVStoreDist : public KVStoreLocal {
       // merge over devices
       int key          = uniq_keys[i];
       const auto& vals = grouped_vals[i];
-      NDArray merged   = do_merge ? comm_->Reduce(key, vals, priority) : vals[0];
+      NDArray merged =
+          do_merge ? ReduceOverNode(key, comm_->Reduce(key, vals, priority), priority) : vals[0];
+      if (do_merge && !IsNodeLeader()) {
+        // the leader pushes the sum over the node
+        continue;
+      }
 
       const auto storage_type = merged.storage_type();
       auto& comm_buf          = comm_buf_[key];
@@ -418,6 +453,8 @@ class KVStoreDist : public KVStoreLocal {
       res_buf =
           NDArray(mxnet::TShape{static_cast<int64_t>(original_size)}, comm_buf.ctx(), false, dtype);
       res_buf = 0;
+      // powersgd compression starts from the previous content of small_buf
+      small_buf = 0;
     }
     gradient_compression_->Quantize(comm_buf, &small_buf, &res_buf, priority);
     auto push_to_servers = [this, key, dtype, pskv, small_buf](RunContext rctx,
@@ -443,9 +480,9 @@ class KVStoreDist : public KVStoreLocal {
   }
 
   virtual void PushDefault(int key, const NDArray& send_buf, const PSKV& pskv, int priority) {
-    auto push_to_servers = [this, key, pskv, send_buf](RunContext rctx,
-                                                       Engine::CallbackOnStart on_start,
-                                                       Engine::CallbackOnComplete cb) {
+    auto push_to_servers = [this, key, pskv, send_buf, priority](RunContext rctx,
+                                                                 Engine::CallbackOnStart on_start,
+                                                                 Engine::CallbackOnComplete cb) {
       on_start();
       const int dtype = send_buf.dtype();
       // convert to ps keys
@@ -454,6 +491,23 @@ class KVStoreDist : public KVStoreLocal {
       // do push. false means no delete
       ps::SArray<char> vals(data, size, false);
       int cmd = GetCommandType(RequestType::kDefaultPushPull, dtype);
+      if (scheduler_) {
+        Schedule(key,
+                 pskv,
+                 priority,
+                 cb,
+                 [this, pskv, vals, cmd, priority](
+                     size_t idx, size_t off, const std::function<void()>& done) {
+                   CHECK_NOTNULL(ps_worker_)
+                       ->ZPush(pskv.keys.segment(idx, idx + 1),
+                               vals.segment(off, off + pskv.lens[idx]),
+                               pskv.lens.segment(idx, idx + 1),
+                               cmd,
+                               done,
+                               priority);
+                 });
+        return;
+      }
       CHECK_NOTNULL(ps_worker_)->ZPush(pskv.keys, vals, pskv.lens, cmd, [cb]() { cb(); });
     };
     Engine::Get()->PushAsync(push_to_servers,
@@ -499,9 +553,9 @@ class KVStoreDist : public KVStoreLocal {
   }
 
   virtual void PullDefault(int key, const NDArray& recv_buf, int priority) {
-    auto pull_from_servers = [this, key, recv_buf](RunContext rctx,
-                                                   Engine::CallbackOnStart on_start,
-                                                   Engine::CallbackOnComplete cb) {
+    auto pull_from_servers = [this, key, recv_buf, priority](RunContext rctx,
+                                                             Engine::CallbackOnStart on_start,
+                                                             Engine::CallbackOnComplete cb) {
       on_start();
       // convert to ps keys
       size_t size         = recv_buf.shape().Size();
@@ -511,13 +565,37 @@ class KVStoreDist : public KVStoreLocal {
                        EncodeDefaultKey(key, size, num_bytes) :
                        EncodeCompressedKey(key, size, false, num_bytes);
       char* data = static_cast<char*>(recv_buf.data().dptr_);
-      // false means not to delete data when SArray is deleted
-      auto vals = new ps::SArray<char>(data, size * num_bytes, false);
       // issue pull
       RequestType mode = (gradient_compression_->get_type() != CompressionType::kNone) ?
                              RequestType::kCompressedPushPull :
                              RequestType::kDefaultPushPull;
       const int cmd = GetCommandType(mode, dtype);
+      if (scheduler_) {
+        Schedule(key,
+                 pskv,
+                 priority,
+                 cb,
+                 [this, pskv, data, cmd, priority](
+                     size_t idx, size_t off, const std::function<void()>& done) {
+                   auto vals = new ps::SArray<char>(data + off, pskv.lens[idx], false);
+                   auto lens = new ps::SArray<int>(1, pskv.lens[idx]);
+                   CHECK_NOTNULL(ps_worker_)
+                       ->ZPull(
+                           pskv.keys.segment(idx, idx + 1),
+                           vals,
+                           lens,
+                           cmd,
+                           [vals, lens, done]() {
+                             delete vals;
+                             delete lens;
+                             done();
+                           },
+                           priority);
+                 });
+        return;
+      }
+      // false means not to delete data when SArray is deleted
+      auto vals = new ps::SArray<char>(data, size * num_bytes, false);
       CHECK_NOTNULL(ps_worker_)->ZPull(pskv.keys, vals, &pskv.lens, cmd, [vals, cb]() {
         delete vals;
         cb();
@@ -562,6 +640,8 @@ class KVStoreDist : public KVStoreLocal {
         LOG(INFO) << "worker " << get_rank() << " pull lens: " << pskv.lens
                   << " keys: " << pskv.keys << " size: " << size;
       }
+      // receive into the storage of recv_buf, which keeps its memory for pulls of fewer
+      // rows, so that it stays registered with RDMA vans
       auto vals     = new ps::SArray<char>(data, size * num_bytes, false);
       const int cmd = GetCommandType(RequestType::kRowSparsePushPull, recv_buf.dtype());
       // copy indices to recv_buf. this needs to be done before ZPull
@@ -585,9 +665,9 @@ class KVStoreDist : public KVStoreLocal {
   }
 
   virtual void PushPullDefault(int key, const NDArray& comm_buf, int priority) {
-    auto pushpull = [this, key, comm_buf](RunContext rctx,
-                                          Engine::CallbackOnStart on_start,
-                                          Engine::CallbackOnComplete cb) {
+    auto pushpull = [this, key, comm_buf, priority](RunContext rctx,
+                                                    Engine::CallbackOnStart on_start,
+                                                    Engine::CallbackOnComplete cb) {
       on_start();
       size_t size         = comm_buf.shape().Size();
       const int dtype     = comm_buf.dtype();
@@ -596,7 +676,32 @@ class KVStoreDist : public KVStoreLocal {
 
       PSKV& pskv = EncodeDefaultKey(key, size, num_bytes);
       char* data = static_cast<char*>(comm_buf.data().dptr_);
-      auto vals  = new ps::SArray<char>(data, size * num_bytes, false);
+      if (scheduler_) {
+        Schedule(key,
+                 pskv,
+                 priority,
+                 cb,
+                 [this, pskv, data, cmd, priority](
+                     size_t idx, size_t off, const std::function<void()>& done) {
+                   auto vals = new ps::SArray<char>(data + off, pskv.lens[idx], false);
+                   auto lens = new ps::SArray<int>(1, pskv.lens[idx]);
+                   CHECK_NOTNULL(ps_worker_)
+                       ->ZPushPull(
+                           pskv.keys.segment(idx, idx + 1),
+                           *vals,
+                           vals,
+                           lens,
+                           cmd,
+                           [vals, lens, done]() {
+                             delete vals;
+                             delete lens;
+                             done();
+                           },
+                           priority);
+                 });
+        return;
+      }
+      auto vals = new ps::SArray<char>(data, size * num_bytes, false);
 
       CHECK_NOTNULL(ps_worker_)->ZPushPull(pskv.keys, *vals, vals, &pskv.lens, cmd, [vals, cb]() {
         delete vals;
@@ -614,6 +719,75 @@ class KVStoreDist : public KVStoreLocal {
                     "KVStoreDistDefaultStoragePushPull");
   }
 
+  /**
+   * \brief whether this worker pushes to and pulls from the servers, which only
+   * the leader of each node does with MXNET_KVSTORE_HIERARCHICAL=1
+   */
+  bool IsNodeLeader() const {
+#if MXNET_USE_NCCL
+    return !node_group_ || node_group_->is_leader();
+#else
+    return true;
+#endif  // MXNET_USE_NCCL
+  }
+
+  /**
+   * \brief sum the reduced value of a key over the workers of the node, see NodeGroup
+   */
+  NDArray ReduceOverNode(int key, const NDArray& src, int priority) {
+#if MXNET_USE_NCCL
+    if (node_group_) {
+      return node_group_->Reduce(key, src, priority);
+    }
+#endif  // MXNET_USE_NCCL
+    return src;
+  }
+
+  /**
+   * \brief broadcast the pulled value of a key from the leader to the workers of the node
+   */
+  NDArray BroadcastOverNode(int key, const NDArray& src, int priority) {
+#if MXNET_USE_NCCL
+    if (node_group_) {
+      return node_group_->Broadcast(key, src, priority);
+    }
+#endif  // MXNET_USE_NCCL
+    return src;
+  }
+
+  /**
+   * \brief send the parts of a key in pskv as separate requests through scheduler_
+   * \param cb called once all parts have completed
+   * \param issue issues the request of the part of index idx, at byte offset off,
+   * and calls its last argument once the request has completed
+   */
+  template <typename FIssue>
+  void Schedule(int key,
+                const PSKV& pskv,
+                int priority,
+                Engine::CallbackOnComplete cb,
+                FIssue issue) {
+    auto counter = new std::atomic<int>(pskv.keys.size());
+    size_t off   = 0;
+    for (size_t idx = 0; idx < pskv.keys.size(); ++idx) {
+      scheduler_->Submit(
+          priority,
+          key,
+          idx,
+          pskv.lens[idx],
+          [issue, idx, off, counter, cb](const std::function<void()>& done) {
+            issue(idx, off, [done, counter, cb]() {
+              done();
+              if (--(*counter) == 0) {
+                delete counter;
+                cb();
+              }
+            });
+          });
+      off += pskv.lens[idx];
+    }
+  }
+
   /**
    * \brief check if the keys are all unique
    */
@@ -647,7 +821,26 @@ class KVStoreDist : public KVStoreLocal {
       CHECK_GT(num_servers, 0);
 
       // a simple heuristic for load balance
-      if (num_arr_elems < bigarray_bound_) {
+      if (scheduler_) {
+        // chunks of at most chunk_bytes_ spread over the servers, scheduled one by one
+        CHECK_LT(key, 1 << kChunkKeyShift) << "too many keys for MXNET_KVSTORE_SCHEDULE_CHUNK_SIZE";
+        const size_t num_chunks = std::min(
+            std::max((pskv_size + chunk_bytes_ - 1) / chunk_bytes_, size_t{1}), kMaxChunks);
+        pskv.size = 0;
+        for (size_t i = 0; i < num_chunks; ++i) {
+          size_t part_size =
+              static_cast<size_t>(
+                  round(static_cast<double>(num_arr_elems) / num_chunks * (i + 1))) -
+              static_cast<size_t>(round(static_cast<double>(num_arr_elems) / num_chunks * i));
+          const int server = (key * 9973 + i) % num_servers;
+          ps::Key ps_key   = krs[server].begin() + key + (i << kChunkKeyShift);
+          CHECK_LT(ps_key, krs[server].end());
+          pskv.keys.push_back(ps_key);
+          const int total_bytes = part_size * num_bytes;
+          pskv.lens.push_back(total_bytes);
+          pskv.size += total_bytes;
+        }
+      } else if (num_arr_elems < bigarray_bound_) {
         // send it to a single random picked server
         int server     = (key * 9973) % num_servers;
         ps::Key ps_key = krs[server].begin() + key;
@@ -733,9 +926,11 @@ class KVStoreDist : public KVStoreLocal {
         push_pskv.size = compr_size;
         pull_pskv.size = original_size;
       } else {
-        // partition it to all servers
-        push_pskv.size = 0;
-        pull_pskv.size = 0;
+        // partition it to all servers, in whole compressed blocks
+        push_pskv.size            = 0;
+        pull_pskv.size            = 0;
+        const size_t compr_block  = gradient_compression_->GetCompressedBlockSize();
+        const size_t compr_blocks = compr_num_elem / compr_block;
 
         for (int i = 0; i < num_servers; ++i) {
           size_t part_compr, part_orig;
@@ -745,9 +940,10 @@ class KVStoreDist : public KVStoreLocal {
           } else {
             part_compr =
                 static_cast<size_t>(
-                    round(static_cast<double>(compr_num_elem) / num_servers * (i + 1))) -
-                static_cast<size_t>(round(static_cast<double>(compr_num_elem) / num_servers * (i)));
-            part_orig = part_compr * gradient_compression_->GetCompressionFactor();
+                    round(static_cast<double>(compr_blocks) / num_servers * (i + 1))) -
+                static_cast<size_t>(round(static_cast<double>(compr_blocks) / num_servers * (i)));
+            part_compr *= compr_block;
+            part_orig  = part_compr * gradient_compression_->GetCompressionFactor();
           }
 
           // meta info
@@ -847,10 +1043,29 @@ class KVStoreDist : public KVStoreLocal {
    * \brief the server handle
    */
   KVStoreDistServer* server_;
+#if MXNET_USE_NCCL
+  /**
+   * \brief the workers on the same machine in hierarchical mode
+   */
+  std::unique_ptr<NodeGroup> node_group_;
+#endif  // MXNET_USE_NCCL
   /**
    * \brief threshold for partition
    */
   size_t bigarray_bound_;
+  /**
+   * \brief size of the chunks scheduled by scheduler_, 0 if there is no scheduler
+   */
+  size_t chunk_bytes_;
+  /**
+   * \brief the server key of a chunk is the key plus the chunk index shifted by this
+   */
+  static constexpr int kChunkKeyShift = 20;
+  static constexpr size_t kMaxChunks  = 512;
+  /**
+   * \brief issues pushes and pulls by priority with MXNET_KVSTORE_SCHEDULE_CHUNK_SIZE set
+   */
+  std::unique_ptr<CommScheduler> scheduler_;
   /**
    * \brief buffer for non-compressed data.
    * When gradient compression is active, this is used
@@ -0,0 +1,423 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file   kvstore_dist_nccl.h
+ * @brief  distributed implementation based on NCCL allreduce across workers
+ */
+#ifndef MXNET_KVSTORE_KVSTORE_DIST_NCCL_H_
+#define MXNET_KVSTORE_KVSTORE_DIST_NCCL_H_
+
+#if MXNET_USE_DIST_KVSTORE && MXNET_USE_NCCL
+
+#include <nccl.h>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "./kvstore_dist.h"
+#include "../common/cuda/utils.h"
+
+namespace mxnet {
+namespace kvstore {
+
+/**
+ * \brief distributed kvstore without parameter traffic through the servers
+ *
+ * Gradients are first reduced over the GPUs of a worker by comm_ (the tree
+ * reduction of CommDeviceTree with MXNET_KVSTORE_USETREE=1), then summed across
+ * workers by ncclAllReduce on one GPU of every worker, and the updater runs on
+ * every worker as in KVStoreLocal. Each gradient thus crosses the network once
+ * in a ring instead of being pushed to and pulled from the servers.
+ *
+ * ps-lite is only used to start the workers and to exchange the NCCL unique id,
+ * so a single server next to the scheduler is sufficient. Only dense arrays and
+ * synchronous training are supported.
+ *
+ * With MXNET_KVSTORE_SHARD_OPTIMIZER=1 the optimizer states are sharded across the
+ * workers: each key is split in one contiguous shard per worker, the gradients are
+ * reduce-scattered instead of allreduced, every worker runs the updater on its shard
+ * only, and the updated shards are allgathered back into the weights. The states
+ * created by the updater, including fp32 master weights, then take 1/N of the memory.
+ */
+class KVStoreDistNCCL : public KVStoreDist {
+ public:
+  KVStoreDistNCCL() : KVStoreDist(true) {
+    if (IsWorkerNode()) {
+      // workers sharing a machine must not share a device
+      nccl_ctx_       = Context::GPU(get_rank() % Context::GetGPUCount());
+      nccl_var_       = Engine::Get()->NewVariable();
+      shard_optimizer_ = dmlc::GetEnv("MXNET_KVSTORE_SHARD_OPTIMIZER", false);
+      ExchangeUniqueId();
+    }
+  }
+
+  virtual ~KVStoreDistNCCL() {
+    if (IsWorkerNode()) {
+      Engine::Get()->WaitForAll();
+      Engine::Get()->DeleteVariable([](RunContext ctx) {}, Context::CPU(), nccl_var_);
+      if (comm_inited_) {
+        CUDA_CALL(cudaStreamDestroy(stream_));
+        ncclCommDestroy(nccl_comm_);
+      }
+    }
+  }
+
+  void PullRowSparse(const std::vector<int>& str_keys,
+                     const std::vector<std::pair<NDArray*, NDArray>>& val_rowids,
+                     int priority) final {
+    LOG(FATAL) << "NotImplementedError: PullRowSparse not supported in KVStoreDistNCCL.";
+  }
+
+  void PullRowSparse(const std::vector<std::string>& str_keys,
+                     const std::vector<std::pair<NDArray*, NDArray>>& val_rowids,
+                     int priority) final {
+    LOG(FATAL) << "NotImplementedError: PullRowSparse not supported in KVStoreDistNCCL.";
+  }
+
+  void SetGradientCompression(
+      const std::vector<std::pair<std::string, std::string>>& kwargs) final {
+    LOG(FATAL) << "NotImplementedError: Gradient compression not supported in KVStoreDistNCCL.";
+  }
+
+ private:
+  /**
+   * \brief server key holding the NCCL unique id, above the range of keys of
+   * parameters small enough to be stored on server 0
+   */
+  static constexpr int kUniqueIdKey = std::numeric_limits<int>::max();
+
+  /**
+   * \brief the worker of rank 0 creates the NCCL unique id and stores it on
+   * server 0, from where the other workers pull it
+   */
+  void ExchangeUniqueId() {
+    const auto& krs = ps::Postoffice::Get()->GetServerKeyRanges();
+    ps::SArray<ps::Key> keys(1, krs[0].begin() + kUniqueIdKey);
+    ps::SArray<int> lens(1, sizeof(ncclUniqueId));
+    // the server stores the first push to a key as is
+    const int cmd = GetCommandType(RequestType::kDefaultPushPull, mshadow::kFloat32);
+    if (get_rank() == 0) {
+      ncclGetUniqueId(&unique_id_);
+      ps::SArray<char> vals(reinterpret_cast<char*>(&unique_id_), sizeof(ncclUniqueId), false);
+      ps_worker_->Wait(ps_worker_->ZPush(keys, vals, lens, cmd));
+    }
+    Barrier();
+    if (get_rank() != 0) {
+      ps::SArray<char> vals;
+      ps_worker_->Wait(ps_worker_->ZPull(keys, &vals, &lens, cmd));
+      CHECK_EQ(vals.size(), sizeof(ncclUniqueId)) << "invalid NCCL unique id";
+      std::memcpy(&unique_id_, vals.data(), sizeof(ncclUniqueId));
+    }
+  }
+
+  /**
+   * \brief run a collective on a buffer of nccl_ctx_
+   *
+   * All collectives mutate nccl_var_, so that they are issued in program order,
+   * which is the same on all workers. The communicator is created by the first
+   * collective, as ncclCommInitRank blocks until all workers have called it.
+   */
+  template <typename FCollective>
+  void PushCollective(const NDArray& buf,
+                      int priority,
+                      const char* opr_name,
+                      FCollective collective) {
+    Engine::Get()->PushSync(
+        [buf, collective, this](RunContext rctx) {
+          std::lock_guard<std::mutex> l(Storage::Get()->GetMutex(Context::kGPU));
+          mxnet::common::cuda::DeviceStore device_store(nccl_ctx_.dev_id);
+          if (!comm_inited_) {
+            ncclCommInitRank(&nccl_comm_, get_group_size(), unique_id_, get_rank());
+            CUDA_CALL(cudaStreamCreate(&stream_));
+            comm_inited_ = true;
+          }
+          collective(buf);
+          CUDA_CALL(cudaStreamSynchronize(stream_));
+        },
+        Context::CPU(),
+        {},
+        {buf.var(), nccl_var_},
+        FnProperty::kCPUPrioritized,
+        priority,
+        opr_name);
+  }
+
+  /**
+   * \brief size of the buffers of a key of size n, padded to a multiple of the
+   * number of workers when the optimizer is sharded
+   */
+  size_t CommBufSize(size_t n) const {
+    if (!shard_optimizer_) {
+      return n;
+    }
+    const size_t num_workers = get_group_size();
+    return (n + num_workers - 1) / num_workers * num_workers;
+  }
+
+  /**
+   * \brief flat buffer on nccl_ctx_ of the size of CommBufSize, with a zero padding,
+   * and the view of its first elements with the given shape
+   */
+  NDArray NewCommBuf(const mxnet::TShape& shape, int dtype, NDArray* view) {
+    const size_t n = shape.Size();
+    NDArray buf(mshadow::Shape1(CommBufSize(n)), nccl_ctx_, false, dtype);
+    if (buf.shape().Size() != n) {
+      buf = 0.0f;
+    }
+    *view = buf.Slice(0, n).Reshape(shape);
+    return buf;
+  }
+
+  /**
+   * \brief copy src to the buffer of the key on nccl_ctx_
+   */
+  NDArray& CopyToCommBuf(int key, const NDArray& src, int priority) {
+    CHECK_EQ(src.storage_type(), kDefaultStorage)
+        << "KVStoreDistNCCL does not support sparse storage type";
+    auto& buf  = nccl_buf_[key];
+    auto& view = nccl_buf_view_[key];
+    if (buf.is_none()) {
+      buf = NewCommBuf(src.shape(), src.dtype(), &view);
+    }
+    CopyFromTo(src, &view, priority);
+    return buf;
+  }
+
+  void InitImpl(const std::vector<int>& keys, const std::vector<NDArray>& values) override {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      const int key = keys[i];
+      CHECK(local_.find(key) == local_.end()) << "duplicate init of key " << key;
+      comm_->Init(key, values[i].storage_type(), values[i].shape(), values[i].dtype());
+      // all workers start from the values of rank 0
+      NDArray& buf = CopyToCommBuf(key, values[i], 0);
+      PushCollective(buf, 0, "KVStoreDistNCCLBcast", [this](const NDArray& dst) {
+        MSHADOW_TYPE_SWITCH(dst.dtype(), DType, {
+          ncclBcast(dst.data().dptr<DType>(),
+                    dst.shape().Size(),
+                    GetNCCLType(dst.dtype()),
+                    0,
+                    nccl_comm_,
+                    stream_);
+        });
+      });
+      if (shard_optimizer_) {
+        // the weights stay on nccl_ctx_, where the updated shards are gathered
+        weight_buf_[key] = NewCommBuf(values[i].shape(), values[i].dtype(), &local_[key]);
+        CopyFromTo(buf, &weight_buf_[key]);
+      } else {
+        const NDArray& view = nccl_buf_view_[key];
+        local_[key]         = NDArray(view.shape(), pinned_ctx_, false, view.dtype());
+        CopyFromTo(view, &local_[key]);
+      }
+    }
+  }
+
+  void AllReduce(const NDArray& buf, int priority) {
+    PushCollective(buf, priority, "KVStoreDistNCCLAllReduce", [this](const NDArray& dst) {
+      MSHADOW_TYPE_SWITCH(dst.dtype(), DType, {
+        ncclAllReduce(dst.data().dptr<DType>(),
+                      dst.data().dptr<DType>(),
+                      dst.shape().Size(),
+                      GetNCCLType(dst.dtype()),
+                      ncclSum,
+                      nccl_comm_,
+                      stream_);
+      });
+    });
+  }
+
+  /**
+   * \brief sum the buffer across workers into the shard of this worker, in place:
+   * the shard of rank r is the r-th of the equal parts of the buffer
+   */
+  void ReduceScatter(const NDArray& buf, int priority) {
+    PushCollective(buf, priority, "KVStoreDistNCCLReduceScatter", [this](const NDArray& dst) {
+      const size_t shard_size = dst.shape().Size() / get_group_size();
+      MSHADOW_TYPE_SWITCH(dst.dtype(), DType, {
+        DType* data = dst.data().dptr<DType>();
+        ncclReduceScatter(data,
+                          data + get_rank() * shard_size,
+                          shard_size,
+                          GetNCCLType(dst.dtype()),
+                          ncclSum,
+                          nccl_comm_,
+                          stream_);
+      });
+    });
+  }
+
+  /**
+   * \brief gather the shards of all workers into the buffer, in place
+   */
+  void AllGather(const NDArray& buf, int priority) {
+    PushCollective(buf, priority, "KVStoreDistNCCLAllGather", [this](const NDArray& dst) {
+      const size_t shard_size = dst.shape().Size() / get_group_size();
+      MSHADOW_TYPE_SWITCH(dst.dtype(), DType, {
+        DType* data = dst.data().dptr<DType>();
+        ncclAllGather(data + get_rank() * shard_size,
+                      data,
+                      shard_size,
+                      GetNCCLType(dst.dtype()),
+                      nccl_comm_,
+                      stream_);
+      });
+    });
+  }
+
+  /**
+   * \brief shard of this worker of a buffer of CommBufSize
+   */
+  NDArray Shard(const NDArray& buf) const {
+    const size_t shard_size = buf.shape().Size() / get_group_size();
+    return buf.Slice(get_rank() * shard_size, (get_rank() + 1) * shard_size);
+  }
+
+  void PushImpl(const std::vector<int>& keys,
+                const std::vector<NDArray>& values,
+                int priority) override {
+    std::vector<int> uniq_keys;
+    std::vector<std::vector<NDArray>> grouped_vals;
+    GroupKVPairsPush(keys, values, &uniq_keys, &grouped_vals, false);
+    for (size_t i = 0; i < uniq_keys.size(); ++i) {
+      const int key = uniq_keys[i];
+      NDArray& buf  = CopyToCommBuf(key, comm_->Reduce(key, grouped_vals[i], priority), priority);
+      if (shard_optimizer_ && updater_ != nullptr) {
+        ReduceScatter(buf, priority);
+        UpdateShard(key, buf, priority);
+      } else {
+        AllReduce(buf, priority);
+        Update(key, nccl_buf_view_[key]);
+      }
+    }
+  }
+
+  /**
+   * \brief apply the updater to the shard of this worker of the weights of a key,
+   * with the shard of the reduce-scattered gradients, then gather all shards
+   */
+  void UpdateShard(int key, const NDArray& grad_buf, int priority) {
+    CHECK(!local_[key].is_none()) << "key " << key << " has not been inited";
+    NDArray& weight_buf = weight_buf_[key];
+    NDArray grad        = Shard(grad_buf);
+    NDArray weight      = Shard(weight_buf);
+    if (key_type_ == kStringKey && str_updater_ != nullptr) {
+      str_updater_(reverse_str_key_dict_[key], grad, &weight);
+    } else {
+      updater_(key, grad, &weight);
+    }
+    AllGather(weight_buf, priority);
+  }
+
+  /**
+   * \brief apply the updater to the stored value of a key, or replace it if no
+   * updater is set, same as KVStoreLocal
+   */
+  void Update(int key, const NDArray& merged) {
+    NDArray& local = local_[key];
+    CHECK(!local.is_none()) << "key " << key << " has not been inited";
+    if (updater_ == nullptr) {
+      if (shard_optimizer_) {
+        // local is a view of the gathered weights
+        CopyFromTo(merged, &local);
+      } else {
+        local = merged;
+      }
+      return;
+    }
+    if (local.ctx().dev_mask() == cpu::kDevMask) {
+      local = local.Copy(merged.ctx());
+    }
+    if (key_type_ == kStringKey && str_updater_ != nullptr) {
+      str_updater_(reverse_str_key_dict_[key], merged, &local);
+    } else {
+      updater_(key, merged, &local);
+    }
+  }
+
+  void PullImpl(const std::vector<int>& keys,
+                const std::vector<NDArray*>& values,
+                int priority,
+                bool ignore_sparse) override {
+    CHECK(ignore_sparse) << "dist kvstore pull doesn't support ignore_sparse=False";
+    std::vector<int> uniq_keys;
+    std::vector<std::vector<NDArray*>> grouped_vals;
+    GroupKVPairsPull(keys, values, &uniq_keys, &grouped_vals, true);
+    for (size_t i = 0; i < uniq_keys.size(); ++i) {
+      const int key        = uniq_keys[i];
+      const NDArray& local = local_[key];
+      CHECK(!local.is_none()) << "key " << key << " has not been inited";
+      comm_->Broadcast(key, local, grouped_vals[i], priority);
+    }
+  }
+
+  void PushPullImpl(const std::vector<int>& vkeys,
+                    const std::vector<int>& okeys,
+                    const std::vector<NDArray>& values,
+                    const std::vector<NDArray*>& outputs,
+                    int priority) override {
+    PushImpl(vkeys, values, priority);
+    PullImpl(okeys, outputs, priority, true);
+  }
+
+  ncclDataType_t GetNCCLType(int dtype) {
+    switch (dtype) {
+      case mshadow::kFloat32:
+        return ncclFloat;
+      case mshadow::kFloat16:
+        return ncclHalf;
+      case mshadow::kFloat64:
+        return ncclDouble;
+      case mshadow::kUint8:
+        return ncclChar;
+      case mshadow::kInt32:
+        return ncclInt;
+      case mshadow::kInt64:
+        return ncclInt64;
+      default:
+        LOG(FATAL) << "Unknown type passed to KVStoreDistNCCL";
+    }
+    return ncclNumTypes;
+  }
+
+  /// \brief device running the collectives across workers
+  Context nccl_ctx_;
+  /// \brief buffers of the keys on nccl_ctx_
+  std::unordered_map<int, NDArray> nccl_buf_;
+  /// \brief views of the buffers with the shapes of the keys
+  std::unordered_map<int, NDArray> nccl_buf_view_;
+  /// \brief weights of the keys on nccl_ctx_ when the optimizer is sharded, local_ views them
+  std::unordered_map<int, NDArray> weight_buf_;
+  /// \brief whether each worker only updates its shard of the keys
+  bool shard_optimizer_ = false;
+  /// \brief serializes the collectives
+  Engine::VarHandle nccl_var_ = nullptr;
+  ncclUniqueId unique_id_;
+  ncclComm_t nccl_comm_;
+  cudaStream_t stream_;
+  bool comm_inited_ = false;
+};
+
+}  // namespace kvstore
+}  // namespace mxnet
+
+#endif  // MXNET_USE_DIST_KVSTORE && MXNET_USE_NCCL
+#endif  // MXNET_KVSTORE_KVSTORE_DIST_NCCL_H_
@@ -0,0 +1,297 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file   kvstore_dist_node_group.h
+ * @brief  NCCL reduction among the workers of a machine for hierarchical KVStoreDist
+ */
+#ifndef MXNET_KVSTORE_KVSTORE_DIST_NODE_GROUP_H_
+#define MXNET_KVSTORE_KVSTORE_DIST_NODE_GROUP_H_
+
+#if MXNET_USE_DIST_KVSTORE && MXNET_USE_NCCL
+
+#include <nccl.h>
+#include <unistd.h>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "mxnet/engine.h"
+#include "mxnet/ndarray.h"
+#include "mxnet/storage.h"
+#include "ps/ps.h"
+#include "./kvstore_dist_server.h"
+#include "../common/cuda/utils.h"
+
+namespace mxnet {
+namespace kvstore {
+
+/**
+ * \brief the workers of KVStoreDist running on the same machine
+ *
+ * The worker of the lowest rank of a machine is its leader. A node group sums
+ * the gradients of its workers on the leader over NVLink or PCIe by ncclReduce,
+ * so that only the leader pushes to and pulls from the servers, and hands the
+ * pulled weights back to the other workers by ncclBcast. The group is found by
+ * exchanging the host names through server 0 when the kvstore is created.
+ *
+ * All collectives of a group mutate one engine variable, so they are issued in
+ * program order, which is the same on all workers of the group.
+ */
+class NodeGroup {
+ public:
+  NodeGroup(ps::KVWorker<char>* ps_worker, int rank, int num_workers) : ps_worker_(ps_worker) {
+    CHECK_GT(Context::GetGPUCount(), 0) << "Hierarchical KVStoreDist requires GPUs";
+    const auto& krs = ps::Postoffice::Get()->GetServerKeyRanges();
+    // the server stores the first push to a key as is
+    const int cmd = GetCommandType(RequestType::kDefaultPushPull, mshadow::kFloat32);
+
+    HostName host;
+    std::memset(host.name, 0, sizeof(host.name));
+    CHECK_EQ(gethostname(host.name, sizeof(host.name) - 1), 0) << "gethostname failed";
+    ps::SArray<ps::Key> host_key(1, krs[0].begin() + kHostNameKey + rank);
+    ps::SArray<int> host_len(1, sizeof(HostName));
+    ps::SArray<char> host_val(reinterpret_cast<char*>(&host), sizeof(HostName), false);
+    ps_worker_->Wait(ps_worker_->ZPush(host_key, host_val, host_len, cmd));
+    Barrier();
+
+    ps::SArray<ps::Key> host_keys;
+    for (int r = 0; r < num_workers; ++r) {
+      host_keys.push_back(krs[0].begin() + kHostNameKey + r);
+    }
+    ps::SArray<char> hosts;
+    ps::SArray<int> host_lens;
+    ps_worker_->Wait(ps_worker_->ZPull(host_keys, &hosts, &host_lens, cmd));
+    CHECK_EQ(hosts.size(), num_workers * sizeof(HostName)) << "invalid host names";
+    for (int r = 0; r < num_workers; ++r) {
+      const char* name = hosts.data() + r * sizeof(HostName);
+      if (std::strncmp(name, host.name, sizeof(HostName)) == 0) {
+        if (size_ == 0) {
+          leader_ = r;
+        }
+        if (r == rank) {
+          local_rank_ = size_;
+        }
+        ++size_;
+      }
+      bool first = true;
+      for (int q = 0; q < r && first; ++q) {
+        first = std::strncmp(hosts.data() + q * sizeof(HostName), name, sizeof(HostName)) != 0;
+      }
+      num_leaders_ += first;
+    }
+
+    // leaders publish the NCCL unique id of their group
+    ps::SArray<ps::Key> id_key(1, krs[0].begin() + kUniqueIdKey + leader_);
+    ps::SArray<int> id_len(1, sizeof(ncclUniqueId));
+    if (size_ > 1 && is_leader()) {
+      ncclGetUniqueId(&unique_id_);
+      ps::SArray<char> vals(reinterpret_cast<char*>(&unique_id_), sizeof(ncclUniqueId), false);
+      ps_worker_->Wait(ps_worker_->ZPush(id_key, vals, id_len, cmd));
+    }
+    Barrier();
+    if (size_ > 1 && !is_leader()) {
+      ps::SArray<char> vals;
+      ps_worker_->Wait(ps_worker_->ZPull(id_key, &vals, &id_len, cmd));
+      CHECK_EQ(vals.size(), sizeof(ncclUniqueId)) << "invalid NCCL unique id";
+      std::memcpy(&unique_id_, vals.data(), sizeof(ncclUniqueId));
+    }
+    if (size_ > 1) {
+      // workers sharing a machine must not share a device
+      ctx_ = Context::GPU(local_rank_ % Context::GetGPUCount());
+      var_ = Engine::Get()->NewVariable();
+    }
+    LOG(INFO) << "worker " << rank << " is worker " << local_rank_ << " of " << size_
+              << " on its node, led by worker " << leader_;
+  }
+
+  ~NodeGroup() {
+    if (var_ != nullptr) {
+      Engine::Get()->WaitForAll();
+      Engine::Get()->DeleteVariable([](RunContext ctx) {}, Context::CPU(), var_);
+    }
+    if (comm_inited_) {
+      CUDA_CALL(cudaStreamDestroy(stream_));
+      ncclCommDestroy(nccl_comm_);
+    }
+  }
+
+  /// \brief whether this worker talks to the servers on behalf of its node
+  bool is_leader() const {
+    return local_rank_ == 0;
+  }
+
+  /// \brief number of node leaders, i.e. of workers pushing to the servers
+  int num_leaders() const {
+    return num_leaders_;
+  }
+
+  /**
+   * \brief sum src over the workers of the node
+   * \return the sum on the leader, an unspecified value on the other workers
+   */
+  NDArray Reduce(int key, const NDArray& src, int priority) {
+    if (size_ == 1) {
+      return src;
+    }
+    NDArray& buf = CopyToBuf(key, src, priority);
+    PushCollective(buf, priority, "KVStoreDistNodeReduce", [this](const NDArray& dst) {
+      MSHADOW_TYPE_SWITCH(dst.dtype(), DType, {
+        ncclReduce(dst.data().dptr<DType>(),
+                   dst.data().dptr<DType>(),
+                   dst.shape().Size(),
+                   GetNCCLType(dst.dtype()),
+                   ncclSum,
+                   0,
+                   nccl_comm_,
+                   stream_);
+      });
+    });
+    return buf;
+  }
+
+  /**
+   * \brief broadcast src of the leader to the workers of the node
+   * \param src the value on the leader, only its shape and type are used on the other workers
+   */
+  NDArray Broadcast(int key, const NDArray& src, int priority) {
+    if (size_ == 1) {
+      return src;
+    }
+    NDArray& buf = is_leader() ? CopyToBuf(key, src, priority) : GetBuf(key, src);
+    PushCollective(buf, priority, "KVStoreDistNodeBcast", [this](const NDArray& dst) {
+      MSHADOW_TYPE_SWITCH(dst.dtype(), DType, {
+        ncclBcast(dst.data().dptr<DType>(),
+                  dst.shape().Size(),
+                  GetNCCLType(dst.dtype()),
+                  0,
+                  nccl_comm_,
+                  stream_);
+      });
+    });
+    return buf;
+  }
+
+ private:
+  /// \brief host name as exchanged through the server, a multiple of 4 bytes
+  struct HostName {
+    char name[256];
+  };
+  /**
+   * \brief server keys for the host name of every worker and the unique id of
+   * every leader, above the range of keys of parameters stored on server 0
+   */
+  static constexpr int kHostNameKey = std::numeric_limits<int>::max() / 2;
+  static constexpr int kUniqueIdKey = kHostNameKey + std::numeric_limits<int>::max() / 4;
+
+  void Barrier() {
+    ps::Postoffice::Get()->Barrier(ps_worker_->get_customer()->customer_id(), ps::kWorkerGroup);
+  }
+
+  NDArray& GetBuf(int key, const NDArray& like) {
+    CHECK_EQ(like.storage_type(), kDefaultStorage)
+        << "Hierarchical KVStoreDist does not support sparse storage type";
+    auto& buf = buf_[key];
+    if (buf.is_none()) {
+      buf = NDArray(like.shape(), ctx_, false, like.dtype());
+    }
+    return buf;
+  }
+
+  NDArray& CopyToBuf(int key, const NDArray& src, int priority) {
+    NDArray& buf = GetBuf(key, src);
+    CopyFromTo(src, &buf, priority);
+    return buf;
+  }
+
+  /**
+   * \brief run a collective on a buffer of ctx_, the communicator is created by
+   * the first collective as ncclCommInitRank blocks until the group has called it
+   */
+  template <typename FCollective>
+  void PushCollective(const NDArray& buf,
+                      int priority,
+                      const char* opr_name,
+                      FCollective collective) {
+    Engine::Get()->PushSync(
+        [buf, collective, this](RunContext rctx) {
+          std::lock_guard<std::mutex> l(Storage::Get()->GetMutex(Context::kGPU));
+          mxnet::common::cuda::DeviceStore device_store(ctx_.dev_id);
+          if (!comm_inited_) {
+            ncclCommInitRank(&nccl_comm_, size_, unique_id_, local_rank_);
+            CUDA_CALL(cudaStreamCreate(&stream_));
+            comm_inited_ = true;
+          }
+          collective(buf);
+          CUDA_CALL(cudaStreamSynchronize(stream_));
+        },
+        Context::CPU(),
+        {},
+        {buf.var(), var_},
+        FnProperty::kCPUPrioritized,
+        priority,
+        opr_name);
+  }
+
+  ncclDataType_t GetNCCLType(int dtype) {
+    switch (dtype) {
+      case mshadow::kFloat32:
+        return ncclFloat;
+      case mshadow::kFloat16:
+        return ncclHalf;
+      case mshadow::kFloat64:
+        return ncclDouble;
+      case mshadow::kUint8:
+        return ncclChar;
+      case mshadow::kInt32:
+        return ncclInt;
+      case mshadow::kInt64:
+        return ncclInt64;
+      default:
+        LOG(FATAL) << "Unknown type passed to NodeGroup";
+    }
+    return ncclNumTypes;
+  }
+
+  ps::KVWorker<char>* ps_worker_;
+  /// \brief rank of the leader among all workers
+  int leader_ = 0;
+  /// \brief rank among the workers of the node
+  int local_rank_ = 0;
+  /// \brief number of workers of the node
+  int size_        = 0;
+  int num_leaders_ = 0;
+  /// \brief device running the collectives of the node
+  Context ctx_;
+  /// \brief buffers of the keys on ctx_
+  std::unordered_map<int, NDArray> buf_;
+  /// \brief serializes the collectives
+  Engine::VarHandle var_ = nullptr;
+  ncclUniqueId unique_id_;
+  ncclComm_t nccl_comm_;
+  cudaStream_t stream_;
+  bool comm_inited_ = false;
+};
+
+}  // namespace kvstore
+}  // namespace mxnet
+
+#endif  // MXNET_USE_DIST_KVSTORE && MXNET_USE_NCCL
+#endif  // MXNET_KVSTORE_KVSTORE_DIST_NODE_GROUP_H_
@@ -23,16 +23,22 @@
  */
 #ifndef MXNET_KVSTORE_KVSTORE_DIST_SERVER_H_
 #define MXNET_KVSTORE_KVSTORE_DIST_SERVER_H_
+#include <dmlc/io.h>
 #include <mxnet/c_api.h>
 #include <mxnet/kvstore.h>
 #include <ps/ps.h>
+#include <atomic>
+#include <chrono>
 #include <queue>
+#include <set>
 #include <string>
 #include <mutex>
 #include <condition_variable>
 #include <memory>
 #include <functional>
 #include <future>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include "../profiler/profiler.h"
 #include "../operator/tensor/elemwise_binary_op-inl.h"
@@ -48,7 +54,9 @@ enum class CommandType {
   kStopServer,
   kSyncMode,
   kSetGradientCompression,
-  kSetProfilerParams
+  kSetProfilerParams,
+  kSetNumPushers,
+  kSaveCheckpoint
 };
 
 enum class RequestType { kDefaultPushPull, kRowSparsePushPull, kCompressedPushPull };
@@ -136,6 +144,16 @@ class Executor {
     fut.wait();
   }
 
+  /**
+   * \brief let the thread called \ref Start exec a function without waiting for it.
+   * threadsafe
+   */
+  void Post(const Func& func) {
+    std::lock_guard<std::mutex> lk(mu_);
+    queue_.push(Block(func));
+    cond_.notify_one();
+  }
+
   /**
    * \brief stop the thread, threadsafe
    */
@@ -154,6 +172,43 @@ class Executor {
   std::condition_variable cond_;
 };
 
+/**
+ * \brief map from keys to values, partitioned over the update shards of the server so
+ * that each shard only inserts into its own map
+ */
+template <typename V>
+class ShardedMap {
+ public:
+  explicit ShardedMap(size_t num_shards = 1) : maps_(num_shards) {}
+
+  V& operator[](int key) {
+    return maps_[key % maps_.size()][key];
+  }
+
+  /**
+   * \brief call f(key, value) for all entries, not threadsafe
+   */
+  template <typename F>
+  void ForEach(F f) {
+    for (size_t i = 0; i < maps_.size(); ++i) {
+      ForEachInShard(i, f);
+    }
+  }
+
+  /**
+   * \brief call f(key, value) for the entries of one shard, only on the thread of the shard
+   */
+  template <typename F>
+  void ForEachInShard(size_t shard, F f) {
+    for (auto& kv : maps_[shard]) {
+      f(kv.first, kv.second);
+    }
+  }
+
+ private:
+  std::vector<std::unordered_map<int, V>> maps_;
+};
+
 class KVStoreDistServer {
  public:
   KVStoreDistServer() {
@@ -163,11 +218,48 @@ class KVStoreDistServer {
         ->set_request_handle(std::bind(&KVStoreDistServer::CommandHandle, this, _1, _2));
     ps_server_->set_request_handle(std::bind(&KVStoreDistServer::DataHandleEx, this, _1, _2, _3));
     sync_mode_            = false;
+    num_pushers_          = 0;
     gradient_compression_ = std::make_shared<GradientCompression>();
     log_verbose_          = dmlc::GetEnv("MXNET_KVSTORE_DIST_ROW_SPARSE_VERBOSE", false);
+    // with one shard, requests are handled on the thread of ps-lite
+    const int num_shards = dmlc::GetEnv("MXNET_KVSTORE_SERVER_UPDATE_THREADS", 1);
+    CHECK_GE(num_shards, 1) << "MXNET_KVSTORE_SERVER_UPDATE_THREADS must be positive";
+    store_       = ShardedMap<NDArray>(num_shards);
+    store_realt_ = ShardedMap<NDArray>(num_shards);
+    update_buf_  = ShardedMap<UpdateBuf>(num_shards);
+    decomp_buf_  = ShardedMap<NDArray>(num_shards);
+    pull_buf_    = ShardedMap<std::unordered_map<int, ps::SArray<char>>>(num_shards);
+    // the deadlines are checked on the shards, so that they need no locking
+    sync_timeout_ = dmlc::GetEnv("MXNET_KVSTORE_SYNC_TIMEOUT", 0);
+    CHECK_GE(sync_timeout_, 0) << "MXNET_KVSTORE_SYNC_TIMEOUT must not be negative";
+    for (int i = 0; (num_shards > 1 || sync_timeout_ > 0) && i < num_shards; ++i) {
+      shards_.emplace_back(new Executor());
+      shard_threads_.emplace_back(&Executor::Start, shards_.back().get());
+    }
+    if (sync_timeout_ > 0) {
+      watchdog_ = std::thread([this]() {
+        while (!stop_watchdog_) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(100));
+          for (size_t i = 0; i < shards_.size(); ++i) {
+            shards_[i]->Post([this, i]() { CheckDeadlines(i); });
+          }
+        }
+      });
+    }
   }
 
   ~KVStoreDistServer() {
+    if (watchdog_.joinable()) {
+      stop_watchdog_ = true;
+      watchdog_.join();
+    }
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      shards_[i]->Stop();
+      shard_threads_[i].join();
+    }
+    if (checkpoint_thread_.joinable()) {
+      checkpoint_thread_.join();
+    }
     profiler::Profiler::Get()->SetState(profiler::Profiler::ProfilerState(0));
     delete ps_server_;
   }
@@ -195,9 +287,16 @@ class KVStoreDistServer {
     NDArray merged;
     // temp_array is used to cast received values as float32 for computation if required
     NDArray temp_array;
+    /// \brief arrival of the first push of the pending round, with MXNET_KVSTORE_SYNC_TIMEOUT
+    std::chrono::steady_clock::time_point start;
+    /// \brief type and keys of the pending round, to respond when it is applied on a deadline
+    DataHandleType type;
+    ps::KVPairs<char> req_keys;
   };
 
   void CommandHandle(const ps::SimpleData& recved, ps::SimpleApp* app) {
+    // commands apply after the data requests received before them
+    WaitShards();
     CommandType recved_type = static_cast<CommandType>(recved.head);
     switch (recved_type) {
       case CommandType::kStopServer:
@@ -214,6 +313,13 @@ class KVStoreDistServer {
         ProcessServerProfilerCommands(
             static_cast<KVStoreServerProfilerCommand>(recved.body.back() - '0'), recved.body);
         break;
+      case CommandType::kSetNumPushers:
+        // only the leaders of the nodes push in hierarchical mode
+        num_pushers_ = std::stoi(recved.body);
+        break;
+      case CommandType::kSaveCheckpoint:
+        SaveCheckpoint(recved.body);
+        break;
       case CommandType::kSetMultiPrecision:
         // uses value 1 for message id from frontend
         if (!multi_precision_) {
@@ -233,15 +339,58 @@ class KVStoreDistServer {
     app->Response(recved);
   }
 
+  /**
+   * \brief save the stored values to prefix-server<rank>.params without pausing training
+   *
+   * The values are copied by the engine, after the updates applied so far and before
+   * later ones, and the copies are written by a background thread while the server
+   * goes on with the next requests. Every server writes the keys, or the parts of the
+   * big keys, it holds, so the files are sharded like the servers. The float32 copies
+   * of multi precision training are saved instead of the low precision values.
+   */
+  void SaveCheckpoint(const std::string& prefix) {
+    if (checkpoint_thread_.joinable()) {
+      // one checkpoint is written at a time
+      checkpoint_thread_.join();
+    }
+    std::unordered_map<int, NDArray> sources;
+    store_realt_.ForEach([&sources](const int key, const NDArray& stored) {
+      if (!stored.is_none())
+        sources[key] = stored;
+    });
+    store_.ForEach([&sources](const int key, const NDArray& stored) {
+      if (!stored.is_none() && sources.find(key) == sources.end())
+        sources[key] = stored;
+    });
+    std::vector<NDArray> snapshot;
+    std::vector<std::string> names;
+    for (const auto& kv : sources) {
+      const NDArray& stored = kv.second;
+      NDArray copy;
+      if (stored.storage_type() == kDefaultStorage) {
+        copy = NDArray(stored.shape(), Context(), false, stored.dtype());
+      } else {
+        copy = NDArray(stored.storage_type(), stored.shape(), Context(), true, stored.dtype());
+      }
+      CopyFromTo(stored, &copy);
+      snapshot.push_back(copy);
+      names.push_back(std::to_string(kv.first));
+    }
+    const std::string fname = prefix + "-server" + std::to_string(ps::MyRank()) + ".params";
+    checkpoint_thread_ = std::thread([snapshot, names, fname]() {
+      std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(fname.c_str(), "w"));
+      NDArray::Save(fo.get(), snapshot, names);
+      LOG(INFO) << "saved " << snapshot.size() << " keys to " << fname;
+    });
+  }
+
   /*
    * For keys already initialized, if necessary create stored_realt.
    * This will only be used if by some wrong usage of kvstore,
    * some keys are initialized before optimizer is set.
    */
   void CreateMultiPrecisionCopies() {
-    for (auto const& stored_entry : store_) {
-      const int key         = stored_entry.first;
-      const NDArray& stored = stored_entry.second;
+    store_.ForEach([this](const int key, const NDArray& stored) {
       if (stored.dtype() != mshadow::kFloat32) {
         auto& stored_realt = store_realt_[key];
         if (stored.storage_type() == kRowSparseStorage) {
@@ -270,10 +419,10 @@ class KVStoreDistServer {
 
         CopyFromTo(stored, stored_realt);
       }
-    }
-    for (auto const& stored_realt_entry : store_realt_) {
-      stored_realt_entry.second.WaitToRead();
-    }
+    });
+    store_realt_.ForEach([](const int key, const NDArray& stored_realt) {
+      stored_realt.WaitToRead();
+    });
   }
 
   void ProcessServerProfilerCommands(KVStoreServerProfilerCommand type, const std::string& body) {
@@ -325,9 +474,33 @@ class KVStoreDistServer {
     }
   }
 
+  /**
+   * \brief wait until the shards have handled all requests posted to them
+   */
+  void WaitShards() {
+    for (auto& shard : shards_) {
+      shard->Exec([]() {});
+    }
+  }
+
   void DataHandleEx(const ps::KVMeta& req_meta,
                     const ps::KVPairs<char>& req_data,
                     ps::KVServer<char>* server) {
+    if (shards_.empty()) {
+      DataHandle(req_meta, req_data, server);
+      return;
+    }
+    // all requests of a key go to the same shard, in the order they were received
+    DataHandleType type     = DepairDataHandleType(req_meta.cmd);
+    const bool has_size_key = type.requestType == RequestType::kCompressedPushPull && req_meta.push;
+    const int key           = DecodeKey(req_data.keys[has_size_key ? 1 : 0]);
+    shards_[key % shards_.size()]->Post(
+        [this, req_meta, req_data, server]() { DataHandle(req_meta, req_data, server); });
+  }
+
+  void DataHandle(const ps::KVMeta& req_meta,
+                  const ps::KVPairs<char>& req_data,
+                  ps::KVServer<char>* server) {
     DataHandleType type = DepairDataHandleType(req_meta.cmd);
     switch (type.requestType) {
       case RequestType::kRowSparsePushPull:
@@ -350,8 +523,19 @@ class KVStoreDistServer {
                            const int key,
                            const ps::KVPairs<char>& req_data,
                            UpdateBuf* update_buf,
-                           ps::KVServer<char>* server) {
-    if (!sync_mode_ || update_buf->request.size() == (size_t)ps::NumWorkers()) {
+                           ps::KVServer<char>* server,
+                           bool on_deadline = false) {
+    if (sync_mode_ && sync_timeout_ > 0 && !on_deadline) {
+      Arrived(update_buf->request.back().sender);
+      if (update_buf->request.size() == 1) {
+        update_buf->start         = std::chrono::steady_clock::now();
+        update_buf->type          = type;
+        update_buf->req_keys.keys = req_data.keys;
+      }
+    }
+    const int num_pushers = (num_pushers_ > 0 ? num_pushers_ : ps::NumWorkers()) - NumDropped();
+    if (!sync_mode_ || on_deadline ||
+        update_buf->request.size() >= static_cast<size_t>(num_pushers)) {
       // let the main thread to execute updater_, which is necessary for python
       auto& stored = has_multi_precision_copy(type) ? store_realt_[key] : store_[key];
       auto& update = sync_mode_ ? update_buf->merged : update_buf->temp_array;
@@ -404,6 +588,59 @@ class KVStoreDistServer {
     }
   }
 
+  /**
+   * \brief note a push of a worker, which rejoins synchronous training if it was dropped
+   *
+   * The first gradient of a rejoining worker may have been computed on the weights
+   * of an earlier round.
+   */
+  void Arrived(int sender) {
+    std::lock_guard<std::mutex> lock(members_mu_);
+    members_.insert(sender);
+    if (dropped_.erase(sender)) {
+      LOG(INFO) << "worker " << sender << " rejoined synchronous training";
+    }
+  }
+
+  int NumDropped() {
+    if (sync_timeout_ == 0) {
+      return 0;
+    }
+    std::lock_guard<std::mutex> lock(members_mu_);
+    return dropped_.size();
+  }
+
+  /**
+   * \brief apply the rounds of the keys of a shard still waiting for pushes after
+   * MXNET_KVSTORE_SYNC_TIMEOUT seconds, dropping the workers they wait for, which
+   * are then no longer waited for until they push again
+   */
+  void CheckDeadlines(size_t shard) {
+    if (!sync_mode_) {
+      return;
+    }
+    const auto deadline = std::chrono::steady_clock::now() - std::chrono::seconds(sync_timeout_);
+    update_buf_.ForEachInShard(shard, [this, deadline](const int key, UpdateBuf& buf) {
+      if (buf.request.empty() || buf.start > deadline) {
+        return;
+      }
+      std::set<int> pushed;
+      for (const auto& req : buf.request) {
+        pushed.insert(req.sender);
+      }
+      {
+        std::lock_guard<std::mutex> lock(members_mu_);
+        for (const int member : members_) {
+          if (!pushed.count(member) && dropped_.insert(member).second) {
+            LOG(WARNING) << "dropping worker " << member << " from synchronous training, it did "
+                         << "not push key " << key << " within " << sync_timeout_ << "s";
+          }
+        }
+      }
+      ApplyUpdates(buf.type, key, buf.req_keys, &buf, ps_server_, true);
+    });
+  }
+
   void DecodeRowIds(const ps::SArray<ps::Key>& keys,
                     int64_t* indices,
                     const int64_t master_key,
@@ -474,8 +711,11 @@ class KVStoreDistServer {
     const int unit_size = unit_len * num_bytes;
     const char* data    = static_cast<char*>(stored.data().dptr_);
     auto len            = num_rows * unit_size;
-    // concat values
-    response.vals.resize(len);
+    // concat values into the buffer of the sender, whose previous pull of this key has
+    // completed, so that the response memory is reused and stays registered with RDMA vans
+    auto& buf = pull_buf_[master_key][req_meta.sender];
+    buf.resize(len);
+    response.vals = buf;
 #pragma omp parallel for
     for (size_t i = 1; i <= num_rows; i++) {
       int key        = DecodeKey(req_data.keys[i]);
@@ -817,29 +1057,61 @@ class KVStoreDistServer {
    * \brief user defined mode for push
    */
   bool sync_mode_;
+  /**
+   * \brief number of workers pushing each key in sync mode, 0 for all workers
+   */
+  int num_pushers_;
   KVStore::Controller controller_;
   KVStore::Updater updater_;
 
   /**
    * \brief store_ contains the value at kvstore for each key
    */
-  std::unordered_map<int, NDArray> store_;
-  std::unordered_map<int, NDArray> store_realt_;
+  ShardedMap<NDArray> store_;
+  ShardedMap<NDArray> store_realt_;
 
   /**
    * \brief merge_buf_ is a buffer used if sync_mode is true. It represents
    * values from different workers being merged. The store will be updated
    * to this value when values from all workers are pushed into this buffer.
    */
-  std::unordered_map<int, UpdateBuf> update_buf_;
+  ShardedMap<UpdateBuf> update_buf_;
 
   /**
    * \brief decomp_buf_ is a buffer into which compressed values are
    * decompressed before merging to the store. used when compress_!='none'
    */
-  std::unordered_map<int, NDArray> decomp_buf_;
+  ShardedMap<NDArray> decomp_buf_;
+
+  /**
+   * \brief pull_buf_ holds the responses to row sparse pulls of each key, by
+   * sender. A buffer keeps its memory when later pulls use fewer rows.
+   */
+  ShardedMap<std::unordered_map<int, ps::SArray<char>>> pull_buf_;
+
+  /**
+   * \brief writes the last checkpoint requested by \a kSaveCheckpoint
+   */
+  std::thread checkpoint_thread_;
+  /**
+   * \brief seconds a synchronous round waits for the pushes of all workers, 0 to wait forever
+   */
+  int sync_timeout_;
+  /// \brief posts the checks of the deadlines to the shards
+  std::thread watchdog_;
+  std::atomic<bool> stop_watchdog_{false};
+  std::mutex members_mu_;
+  /// \brief the workers which pushed so far, and those not waited for as they missed a deadline
+  std::set<int> members_;
+  std::set<int> dropped_;
 
   Executor exec_;
+  /**
+   * \brief executors handling the data requests when more than one update thread is
+   * used, keys are assigned to them by key % shards_.size()
+   */
+  std::vector<std::unique_ptr<Executor>> shards_;
+  std::vector<std::thread> shard_threads_;
   ps::KVServer<char>* ps_server_;
 
   // whether to LOG verbose information
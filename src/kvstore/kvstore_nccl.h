@@ -64,8 +64,9 @@ class KVStoreNCCL : public KVStoreLocal {
   KVStoreNCCL() : KVStoreLocal() {
     // Due to aggregation, we do not use the Comm interface
     comm_       = nullptr;
-    pinned_ctx_ = Context::CPUPinned(0);
-    inited_     = false;
+    pinned_ctx_  = Context::CPUPinned(0);
+    inited_      = false;
+    bucket_size_ = dmlc::GetEnv("MXNET_KVSTORE_NCCL_BUCKET_SIZE", size_t{0});
   }
 
   virtual ~KVStoreNCCL() {
@@ -256,15 +257,39 @@ class KVStoreNCCL : public KVStoreLocal {
       (*merged_ptrs)[k] = &reduce;
       // Need to pass NDArrays by value to the engine
       reduces[k] = reduce;
+    }
 
-      for (size_t i = 0; i < src.size(); ++i) {
-        const_vars.push_back(src[i].var());
+    // small values are reduced in buckets, the others one by one
+    std::vector<const NDArray*> candidates(keys.size(), nullptr);
+    for (size_t k = 0; k < keys.size(); ++k) {
+      if (srcs[k].size() > 1)
+        candidates[k] = &reduces[k];
+    }
+    const std::vector<Bucket> buckets = MakeBuckets(candidates);
+    std::vector<bool> bucketed(keys.size(), false);
+    for (const auto& bucket : buckets) {
+      for (size_t k : bucket.keys)
+        bucketed[k] = true;
+    }
+    for (size_t k = 0; k < keys.size(); ++k) {
+      if (srcs[k].size() <= 1 || bucketed[k])
+        continue;
+      for (size_t i = 0; i < srcs[k].size(); ++i) {
+        const_vars.push_back(srcs[k][i].var());
       }
-      mutate_vars.push_back(reduce.var());
+      mutate_vars.push_back(reduces[k].var());
     }
 
+    // buckets are pushed first, in the order their gradients are produced
+    std::unordered_map<int, size_t> slots;
+    for (const auto& bucket : buckets) {
+      PushReduceBucket(bucket, srcs, reduces, slots[bucket.dtype]++, priority);
+    }
+    if (mutate_vars.empty())
+      return;
+
     Engine::Get()->PushSync(
-        [srcs, reduces, root_ids, this](RunContext rctx) {
+        [srcs, reduces, root_ids, bucketed, this](RunContext rctx) {
           std::lock_guard<std::mutex> l(Storage::Get()->GetMutex(Context::kGPU));
 #if (NCCL_MAJOR > 2 || (NCCL_MAJOR == 2 && NCCL_MINOR > 1))
           ncclGroupStart();
@@ -273,7 +298,7 @@ class KVStoreNCCL : public KVStoreLocal {
             auto& src     = srcs[k];
             auto& root_id = root_ids[k];
             auto& reduce  = reduces[k];
-            if (src.size() <= 1) {
+            if (src.size() <= 1 || bucketed[k]) {
               continue;
             }
             int root = nccl_data_[src[root_id].ctx().dev_id].rank;
@@ -358,11 +383,6 @@ class KVStoreNCCL : public KVStoreLocal {
 
         // On root perform simple copy to the output
         CopyFromTo(src, *dst[root_id], priority);
-        for (size_t i = 0; i < dst.size(); ++i) {
-          if (i != root_id)
-            mutable_vars.push_back(dst[i]->var());
-        }
-        const_vars.push_back(src.var());
       }
     }
 
@@ -371,6 +391,28 @@ class KVStoreNCCL : public KVStoreLocal {
       return;
     }
 
+    // small values are broadcast in buckets, the others one by one
+    std::vector<const NDArray*> candidates(keys.size(), nullptr);
+    for (size_t k = 0; k < keys.size(); ++k) {
+      if (dsts[k].size() > 1)
+        candidates[k] = &srcs[k];
+    }
+    const std::vector<Bucket> buckets = MakeBuckets(candidates);
+    std::vector<bool> bucketed(keys.size(), false);
+    for (const auto& bucket : buckets) {
+      for (size_t k : bucket.keys)
+        bucketed[k] = true;
+    }
+    for (size_t k = 0; k < keys.size(); ++k) {
+      if (bucketed[k])
+        continue;
+      for (size_t i = 0; i < dsts[k].size(); ++i) {
+        if (i != root_ids[k])
+          mutable_vars.push_back(dsts[k][i]->var());
+      }
+      const_vars.push_back(srcs[k].var());
+    }
+
     // We need to capture NDArrays by value
     // in order to push to the engine
     std::vector<std::vector<NDArray>> broadcasts(dsts.size());
@@ -382,8 +424,15 @@ class KVStoreNCCL : public KVStoreLocal {
       }
     }
 
+    std::unordered_map<int, size_t> slots;
+    for (const auto& bucket : buckets) {
+      PushBroadcastBucket(bucket, srcs, broadcasts, root_ids, slots[bucket.dtype]++, priority);
+    }
+    if (const_vars.empty())
+      return;
+
     Engine::Get()->PushSync(
-        [srcs, broadcasts, root_ids, this](RunContext rctx) {
+        [srcs, broadcasts, root_ids, bucketed, this](RunContext rctx) {
           std::lock_guard<std::mutex> l(Storage::Get()->GetMutex(Context::kGPU));
 #if (NCCL_MAJOR > 2 || (NCCL_MAJOR == 2 && NCCL_MINOR > 1))
           ncclGroupStart();
@@ -392,7 +441,7 @@ class KVStoreNCCL : public KVStoreLocal {
             auto& src     = srcs[k];
             auto& dst     = broadcasts[k];
             auto& root_id = root_ids[k];
-            if (dst.size() <= 1) {
+            if (dst.size() <= 1 || bucketed[k]) {
               continue;
             }
 
@@ -538,6 +587,218 @@ class KVStoreNCCL : public KVStoreLocal {
     return root_id;
   }
 
+  /// \brief keys whose values are packed into one flat buffer for a single NCCL call
+  struct Bucket {
+    /// \brief data type of the values
+    int dtype;
+    /// \brief number of elements of the packed values
+    size_t size;
+    /// \brief indices of the keys in the call
+    std::vector<size_t> keys;
+    /// \brief offsets of the values in the flat buffer, in elements
+    std::vector<size_t> offsets;
+  };
+
+  /**
+   * \brief Group the values smaller than the bucket size into buckets of one data type.
+   *  The backward pass produces the gradients of the last keys first, so the keys are
+   *  visited from the last to the first and early buckets can be communicated while the
+   *  remaining gradients are computed. Values given as nullptr are not bucketed.
+   */
+  std::vector<Bucket> MakeBuckets(const std::vector<const NDArray*>& values) const {
+    std::vector<Bucket> buckets;
+    if (bucket_size_ == 0)
+      return buckets;
+    // index of the bucket being filled for each data type
+    std::unordered_map<int, size_t> open;
+    for (size_t k = values.size(); k-- > 0;) {
+      if (values[k] == nullptr)
+        continue;
+      const int dtype       = values[k]->dtype();
+      const size_t size     = values[k]->shape().Size();
+      const size_t capacity = bucket_size_ / mshadow::mshadow_sizeof(dtype);
+      if (size >= capacity)
+        continue;
+      auto it = open.find(dtype);
+      if (it == open.end() || buckets[it->second].size + size > capacity) {
+        open[dtype] = buckets.size();
+        buckets.push_back(Bucket{dtype, 0, {}, {}});
+      }
+      Bucket& bucket = buckets[open[dtype]];
+      bucket.keys.push_back(k);
+      bucket.offsets.push_back(bucket.size);
+      bucket.size += size;
+    }
+    // packing a single value only adds copies
+    buckets.erase(std::remove_if(buckets.begin(),
+                                 buckets.end(),
+                                 [](const Bucket& b) { return b.keys.size() < 2; }),
+                  buckets.end());
+    return buckets;
+  }
+
+  /// \brief flat buffers of a bucket on every device, reused by the buckets with the same slot
+  std::unordered_map<int, NDArray> BucketBuffers(int dtype, size_t slot) {
+    auto& slots = bucket_bufs_[dtype];
+    if (slots.size() <= slot)
+      slots.resize(slot + 1);
+    auto& bufs = slots[slot];
+    if (bufs.empty()) {
+      const size_t capacity = bucket_size_ / mshadow::mshadow_sizeof(dtype);
+      for (int dev_id : device_ids_) {
+        bufs[dev_id] = NDArray(mxnet::TShape(1, capacity), Context::GPU(dev_id), false, dtype);
+      }
+    }
+    return bufs;
+  }
+
+  /// \brief copy a range of bytes on the NCCL stream of a device
+  void CopyOnStream(void* dst, const void* src, size_t bytes, int dev_id) {
+    CUDA_CALL(
+        cudaMemcpyAsync(dst, src, bytes, cudaMemcpyDeviceToDevice, nccl_data_[dev_id].stream));
+  }
+
+  /// \brief reduce the values of a bucket with one NCCL call per device
+  void PushReduceBucket(const Bucket& bucket,
+                        const std::vector<std::vector<NDArray>>& all_srcs,
+                        const std::vector<NDArray>& all_reduces,
+                        size_t slot,
+                        int priority) {
+    std::vector<std::vector<NDArray>> srcs;
+    std::vector<NDArray> reduces;
+    std::vector<Engine::VarHandle> const_vars;
+    std::vector<Engine::VarHandle> mutate_vars;
+    for (size_t k : bucket.keys) {
+      srcs.push_back(all_srcs[k]);
+      reduces.push_back(all_reduces[k]);
+      for (const auto& src : all_srcs[k])
+        const_vars.push_back(src.var());
+      mutate_vars.push_back(all_reduces[k].var());
+    }
+    const auto bufs = BucketBuffers(bucket.dtype, slot);
+    for (const auto& kv : bufs)
+      mutate_vars.push_back(kv.second.var());
+
+    Engine::Get()->PushSync(
+        [bucket, srcs, reduces, bufs, this](RunContext rctx) {
+          std::lock_guard<std::mutex> l(Storage::Get()->GetMutex(Context::kGPU));
+          mxnet::common::cuda::DeviceStore device_store;
+          const size_t elem_size = mshadow::mshadow_sizeof(bucket.dtype);
+          const int root         = reduces[0].ctx().dev_id;
+          for (size_t k = 0; k < srcs.size(); ++k) {
+            for (const auto& src : srcs[k]) {
+              const int dev_id = src.ctx().dev_id;
+              device_store.SetDevice(dev_id);
+              CopyOnStream(static_cast<char*>(bufs.at(dev_id).data().dptr_) +
+                               bucket.offsets[k] * elem_size,
+                           src.data().dptr_,
+                           src.shape().Size() * elem_size,
+                           dev_id);
+            }
+          }
+          ncclGroupStart();
+          for (const auto& kv : bufs) {
+            NCCLEntry cur = nccl_data_[kv.first];
+            void* buf     = kv.second.data().dptr_;
+            ncclReduce(buf,
+                       kv.first == root ? buf : nullptr,
+                       bucket.size,
+                       GetNCCLType(bucket.dtype),
+                       ncclSum,
+                       nccl_data_[root].rank,
+                       cur.comm,
+                       cur.stream);
+          }
+          ncclGroupEnd();
+          device_store.SetDevice(root);
+          for (size_t k = 0; k < reduces.size(); ++k) {
+            CopyOnStream(reduces[k].data().dptr_,
+                         static_cast<char*>(bufs.at(root).data().dptr_) +
+                             bucket.offsets[k] * elem_size,
+                         reduces[k].shape().Size() * elem_size,
+                         root);
+          }
+        },
+        Context::CPU(),
+        const_vars,
+        mutate_vars,
+        FnProperty::kCPUPrioritized,
+        priority,
+        "KVStoreReduceBucket");
+  }
+
+  /// \brief broadcast the values of a bucket with one NCCL call per device
+  void PushBroadcastBucket(const Bucket& bucket,
+                           const std::vector<NDArray>& all_srcs,
+                           const std::vector<std::vector<NDArray>>& all_dsts,
+                           const std::vector<size_t>& all_root_ids,
+                           size_t slot,
+                           int priority) {
+    std::vector<NDArray> srcs;
+    std::vector<std::vector<NDArray>> dsts;
+    std::vector<Engine::VarHandle> const_vars;
+    std::vector<Engine::VarHandle> mutate_vars;
+    for (size_t k : bucket.keys) {
+      srcs.push_back(all_srcs[k]);
+      const_vars.push_back(all_srcs[k].var());
+      // the root output is copied from the source directly
+      dsts.emplace_back();
+      for (size_t i = 0; i < all_dsts[k].size(); ++i) {
+        if (i == all_root_ids[k])
+          continue;
+        dsts.back().push_back(all_dsts[k][i]);
+        mutate_vars.push_back(all_dsts[k][i].var());
+      }
+    }
+    const auto bufs = BucketBuffers(bucket.dtype, slot);
+    for (const auto& kv : bufs)
+      mutate_vars.push_back(kv.second.var());
+
+    Engine::Get()->PushSync(
+        [bucket, srcs, dsts, bufs, this](RunContext rctx) {
+          std::lock_guard<std::mutex> l(Storage::Get()->GetMutex(Context::kGPU));
+          mxnet::common::cuda::DeviceStore device_store;
+          const size_t elem_size = mshadow::mshadow_sizeof(bucket.dtype);
+          const int root         = srcs[0].ctx().dev_id;
+          device_store.SetDevice(root);
+          for (size_t k = 0; k < srcs.size(); ++k) {
+            CopyOnStream(static_cast<char*>(bufs.at(root).data().dptr_) +
+                             bucket.offsets[k] * elem_size,
+                         srcs[k].data().dptr_,
+                         srcs[k].shape().Size() * elem_size,
+                         root);
+          }
+          ncclGroupStart();
+          for (const auto& kv : bufs) {
+            NCCLEntry cur = nccl_data_[kv.first];
+            ncclBcast(kv.second.data().dptr_,
+                      bucket.size,
+                      GetNCCLType(bucket.dtype),
+                      nccl_data_[root].rank,
+                      cur.comm,
+                      cur.stream);
+          }
+          ncclGroupEnd();
+          for (size_t k = 0; k < dsts.size(); ++k) {
+            for (const auto& dst : dsts[k]) {
+              const int dev_id = dst.ctx().dev_id;
+              device_store.SetDevice(dev_id);
+              CopyOnStream(dst.data().dptr_,
+                           static_cast<char*>(bufs.at(dev_id).data().dptr_) +
+                               bucket.offsets[k] * elem_size,
+                           dst.shape().Size() * elem_size,
+                           dev_id);
+            }
+          }
+        },
+        Context::CPU(),
+        const_vars,
+        mutate_vars,
+        FnProperty::kCPUPrioritized,
+        priority,
+        "KVStoreBCastBucket");
+  }
+
   std::vector<KeyAttrs> key_attrs_;
   /// \brief temporal space for pushing and pulling
   struct BufferEntry {
@@ -559,6 +820,10 @@ class KVStoreNCCL : public KVStoreLocal {
   bool inited_;
   // \brief devices used with this KVStore
   std::vector<int> device_ids_;
+  /// \brief maximum size in bytes of a bucket, 0 disables bucketing
+  size_t bucket_size_;
+  /// \brief flat buffers of the buckets by data type and slot, then by device ID
+  std::unordered_map<int, std::vector<std::unordered_map<int, NDArray>>> bucket_bufs_;
 };
 }  // namespace kvstore
 }  // namespace mxnet
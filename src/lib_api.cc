@@ -856,6 +856,8 @@ mxnet::ext::CustomOp::CustomOp(const char* op_name)
       infer_storage_type(nullptr),
       infer_shape(nullptr),
       mutate_inputs(nullptr),
+      workspace_size(nullptr),
+      inplace_option(nullptr),
       isSGop(false) {}
 
 mxnet::ext::CustomOp& mxnet::ext::CustomOp::setForward(mxnet::ext::fcomp_t fcomp, const char* ctx) {
@@ -898,6 +900,16 @@ mxnet::ext::CustomOp& mxnet::ext::CustomOp::setMutateInputs(mxnet::ext::mutateIn
   return *this;
 }
 
+mxnet::ext::CustomOp& mxnet::ext::CustomOp::setWorkspaceSize(mxnet::ext::workspaceSize_t func) {
+  workspace_size = func;
+  return *this;
+}
+
+mxnet::ext::CustomOp& mxnet::ext::CustomOp::setInplaceOption(mxnet::ext::inplaceOption_t func) {
+  inplace_option = func;
+  return *this;
+}
+
 mxnet::ext::CustomOp& mxnet::ext::CustomOp::setCreateOpState(mxnet::ext::createOpState_t func,
                                                              const char* ctx) {
   if (create_op_ctx_map.count(ctx) > 0)
@@ -1029,7 +1041,9 @@ MX_VOID_RET _opRegGet(int idx,
                       mxnet::ext::inferType_t* type,
                       mxnet::ext::inferSType_t* stype,
                       mxnet::ext::inferShape_t* shape,
-                      mxnet::ext::mutateInputs_t* mutate) {
+                      mxnet::ext::mutateInputs_t* mutate,
+                      mxnet::ext::workspaceSize_t* workspace,
+                      mxnet::ext::inplaceOption_t* inplace) {
   mxnet::ext::CustomOp& op = mxnet::ext::Registry<mxnet::ext::CustomOp>::get()->get(idx);
   *name                    = op.name;
   *parse                   = op.parse_attrs;
@@ -1037,6 +1051,8 @@ MX_VOID_RET _opRegGet(int idx,
   *stype                   = op.infer_storage_type;
   *shape                   = op.infer_shape;
   *mutate                  = op.mutate_inputs;
+  *workspace               = op.workspace_size;
+  *inplace                 = op.inplace_option;
   *isSGop                  = op.isSGop;
   op.mapToVector();
   *forward_ctx     = op.forward_ctx_cstr.data();
@@ -1383,6 +1399,66 @@ MX_INT_RET _opCallMutateInputs(mxnet::ext::mutateInputs_t mutate,
   return retval;
 }
 
+/*! \brief returns status of calling workspaceSize function for operator from library */
+MX_INT_RET _opCallWorkspaceSize(mxnet::ext::workspaceSize_t workspace,
+                                const char* const* keys,
+                                const char* const* vals,
+                                int num,
+                                unsigned int** inshapes,
+                                int* indims,
+                                int num_in,
+                                const int* intypes,
+                                int backward,
+                                size_t* workspace_size) {
+  // create map of attributes from list
+  std::unordered_map<std::string, std::string> attrs;
+  for (int i = 0; i < num; i++) {
+    attrs[std::string(keys[i])] = std::string(vals[i]);
+  }
+
+  // create a vector of shapes and types for inputs
+  std::vector<std::vector<unsigned int> > in_shapes(num_in);
+  std::vector<int> in_types(num_in);
+  for (int i = 0; i < num_in; i++) {
+    for (int j = 0; j < indims[i]; j++) {
+      in_shapes[i].push_back(inshapes[i][j]);
+    }
+    in_types[i] = intypes[i];
+  }
+
+  *workspace_size = 0;
+  return workspace(attrs, in_shapes, in_types, backward != 0, workspace_size);
+}
+
+/*! \brief returns status of calling inplaceOption function for operator from library */
+MX_INT_RET _opCallInplaceOption(mxnet::ext::inplaceOption_t inplace,
+                                const char* const* keys,
+                                const char* const* vals,
+                                int num,
+                                int** inplace_pairs,
+                                int* num_pairs) {
+  // create map of attributes from list
+  std::unordered_map<std::string, std::string> attrs;
+  for (int i = 0; i < num; i++) {
+    attrs[std::string(keys[i])] = std::string(vals[i]);
+  }
+
+  std::vector<std::pair<int, int> > pairs;
+  int retval = inplace(attrs, &pairs);
+  if (!retval)
+    return retval;
+
+  // output the pairs flattened as input, output indices
+  *num_pairs     = pairs.size();
+  *inplace_pairs = static_cast<int*>(malloc(2 * *num_pairs * sizeof(int)));
+  for (int i = 0; i < *num_pairs; i++) {
+    (*inplace_pairs)[2 * i]     = pairs[i].first;
+    (*inplace_pairs)[2 * i + 1] = pairs[i].second;
+  }
+
+  return retval;
+}
+
 /*! \brief returns status of calling createStatefulOp function for operator from library */
 MX_INT_RET _opCallCreateOpState(mxnet::ext::createOpState_t create_op,
                                 const char* const* keys,
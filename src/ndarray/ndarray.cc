@@ -31,6 +31,7 @@
 #include <mxnet/ndarray.h>
 #include <mxnet/resource.h>
 
+#include "../common/object_pool.h"
 #include "../common/utils.h"
 #include "../operator/nn/dnnl/dnnl_base-inl.h"
 #include "../operator/tensor/init_op.h"
@@ -43,6 +44,14 @@
 #if MXNET_USE_OPENCV
 #include <opencv2/opencv.hpp>
 #endif  // MXNET_USE_OPENCV
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
 
 namespace dmlc {
 DMLC_REGISTRY_ENABLE(::mxnet::NDArrayFunctionReg);
@@ -61,7 +70,7 @@ void NDArray::ReInit(const NDArrayStorageType stype,
   Init(stype, shape, dtype);
   if (stype != kDefaultStorage) {
     const auto sparseStorage = stype == kRowSparseStorage;
-    if (!sparseStorage && stype != kCSRStorage)
+    if (!sparseStorage && stype != kCSRStorage && stype != kBSRStorage)
       LOG(FATAL) << "Unknown storage type " << stype;
 
     const auto& aux_types = (pAux_types && pAux_types->size()) ?
@@ -77,16 +86,18 @@ void NDArray::ReInit(const NDArrayStorageType stype,
       if (sparseStorage) {
         storage_shape    = shape;
         storage_shape[0] = aux_shapes[rowsparse::kIdx][0];
+      } else if (stype == kBSRStorage) {
+        // 1x1 blocks until the operator writing the array allocates it with its block shape
+        storage_shape = mxnet::TShape(mshadow::Shape3(aux_shapes[bsr::kIdx][0], 1, 1));
       } else {
         storage_shape = aux_shapes[csr::kIdx];
       }
     } else {
       storage_shape = *pStorage_shapes;
     }
-    ptr_ = std::make_shared<Chunk>(
-        stype, storage_shape, ctx, delay_alloc, dtype, aux_types, aux_shapes);
+    ptr_ = NewChunk(stype, storage_shape, ctx, delay_alloc, dtype, aux_types, aux_shapes);
   } else {
-    ptr_ = std::make_shared<Chunk>(shape, ctx, delay_alloc, dtype);
+    ptr_ = NewChunk(shape, ctx, delay_alloc, dtype);
   }
 }
 
@@ -118,6 +129,7 @@ void NDArray::SetShapeFromChunk() const {
 struct ChunkMem {
   Storage::Handle h;
   std::vector<Storage::Handle> aux_h;
+  std::shared_ptr<void> small_data_ref;
 #if MXNET_USE_ONEDNN == 1
   std::shared_ptr<DNNLMemory> mem;
 #endif
@@ -126,26 +138,35 @@ struct ChunkMem {
 NDArray::Chunk::~Chunk() {
   bool skip_free = static_data || delay_alloc;
   ChunkMem mem;
-  mem.h     = this->shandle;
-  mem.aux_h = this->aux_handles;
+  mem.h              = this->shandle;
+  mem.aux_h          = this->aux_handles;
+  mem.small_data_ref = this->small_data_ref_;
 #if MXNET_USE_ONEDNN == 1
   // We want to delete dnnl memory after deleting the variable.
   mem.mem = this->dnnl_mem_;
 #endif
+  // the engine deletes the region variables along with var
+  std::vector<Engine::VarHandle> vars{this->var};
+  for (const auto& region : region_vars) {
+    vars.push_back(region.second.second);
+  }
   if (auto engine = engine_ref_.lock()) {
     engine->DeleteVariable(
-        [mem, skip_free, var = this->var](RunContext s) mutable {
+        [mem, skip_free, vars, deleter = this->static_data_deleter](RunContext s) mutable {
 #if MXNET_USE_CUDA
-          auto& sync_obj = var->sync_object;
+          // the memory may still be used by the kernels of the views of the regions
           Storage::SyncObj storage_sync_obj;
-          {
+          for (Engine::VarHandle var : vars) {
+            auto& sync_obj = var->sync_object;
             std::lock_guard<std::mutex> l(sync_obj.mutex);
             for (auto& ev : sync_obj.reader_events) {
               storage_sync_obj.events.push_back(ev.event);
+              storage_sync_obj.event_streams.emplace_back(ev.stream, ev.pool_index);
             }
             if (!sync_obj.writer_event.empty()) {
               auto ev = sync_obj.writer_event[0];
               storage_sync_obj.events.push_back(ev.event);
+              storage_sync_obj.event_streams.emplace_back(ev.stream, ev.pool_index);
             }
           }
           mem.h.sync_obj = storage_sync_obj;
@@ -157,17 +178,141 @@ NDArray::Chunk::~Chunk() {
               CHECK_EQ(mem.mem->GetDataHandle(), mem.h.dptr);
             }
 #endif
-            Storage::Get()->Free(mem.h);
+            FreeHandle(mem.h);
             for (const auto& aux : mem.aux_h) {
               Storage::Get()->Free(aux);
             }
           }
+          if (deleter) {
+#if MXNET_USE_CUDA
+            // the asynchronous engines complete the operations before their kernels do
+            for (auto ev : mem.h.sync_obj.events) {
+              auto valid_ev = ev.lock();
+              if (valid_ev) {
+                MSHADOW_CUDA_CALL(cudaEventSynchronize(*valid_ev));
+              }
+            }
+#endif
+            deleter();
+          }
         },
         shandle.ctx,
         var);
+  } else if (static_data_deleter) {
+    static_data_deleter();
   }
 }
 
+Engine::VarHandle NDArray::Chunk::RegionVar(size_t begin, size_t end) {
+  static const size_t max_region_vars = dmlc::GetEnv("MXNET_NDARRAY_MAX_REGION_VARS", 64);
+  if (begin >= end || (begin == 0 && end >= shandle.size) || max_region_vars == 0)
+    return nullptr;
+  // the memory and the layout of the data are changed by the operations on the whole data
+  if (storage_type != kDefaultStorage || delay_alloc)
+    return nullptr;
+#if MXNET_USE_ONEDNN == 1
+  if (IsDNNL())
+    return nullptr;
+#endif
+  std::lock_guard<std::mutex> lock(region_mutex);
+  auto next = region_vars.upper_bound(begin);
+  if (next != region_vars.begin()) {
+    auto prev = std::prev(next);
+    if (prev->second.first > begin) {
+      // a view of a view uses the region of its source
+      return end <= prev->second.first ? prev->second.second : nullptr;
+    }
+  }
+  if ((next != region_vars.end() && next->first < end) || region_vars.size() >= max_region_vars)
+    return nullptr;
+  Engine::VarHandle region = Engine::Get()->NewRegionVariable(var);
+  if (region == var)
+    return nullptr;
+  region_vars.emplace(begin, std::make_pair(end, region));
+  return region;
+}
+
+/*! \brief the largest data of the CPU arrays allocated from the pool of small data */
+constexpr size_t kSmallDataBytes = 64;
+/*! \brief the data of a small CPU array, aligned like the data of the CPU storage */
+struct alignas(64) SmallData {
+  char data[kSmallDataBytes];
+};
+
+static bool IsSmallData(const Storage::Handle& handle) {
+  return handle.ctx.dev_type == Context::kCPU && handle.size > 0 &&
+         handle.size <= kSmallDataBytes;
+}
+
+std::shared_ptr<void> NDArray::Chunk::SmallDataPoolRef() {
+  return common::ObjectPool<SmallData>::_GetSharedRef();
+}
+
+void NDArray::Chunk::FreeHandle(const Storage::Handle& handle) {
+  if (IsSmallData(handle)) {
+    if (handle.dptr != nullptr)
+      common::ObjectPool<SmallData>::Get()->Delete(static_cast<SmallData*>(handle.dptr));
+  } else {
+    Storage::Get()->Free(handle);
+  }
+}
+
+/*!
+ * \brief a chunk with the reference counts of std::allocate_shared, whose size depends on the
+ *  standard library
+ */
+struct NDArray::ChunkBlock {
+  alignas(alignof(std::max_align_t)) char data[sizeof(NDArray::Chunk) + 64];
+};
+
+std::shared_ptr<void> NDArray::ChunkPoolRef() {
+  return common::ObjectPool<ChunkBlock>::_GetSharedRef();
+}
+
+void* NDArray::AllocChunkBlock(size_t size) {
+  if (size > sizeof(ChunkBlock))
+    return ::operator new(size);
+  return common::ObjectPool<ChunkBlock>::Get()->New();
+}
+
+void NDArray::FreeChunkBlock(void* ptr, size_t size) {
+  if (size > sizeof(ChunkBlock)) {
+    ::operator delete(ptr);
+  } else {
+    common::ObjectPool<ChunkBlock>::Get()->Delete(static_cast<ChunkBlock*>(ptr));
+  }
+}
+
+void NDArray::Chunk::AllocHandle() {
+  if (IsSmallData(shandle)) {
+    // the small arrays of the imperative code, like scalars and shapes, skip the storage
+    shandle.dptr = common::ObjectPool<SmallData>::Get()->New();
+    return;
+  }
+#if MXNET_USE_CUDA
+  static const bool stream_ordered = dmlc::GetEnv("MXNET_GPU_MEM_POOL_STREAM_ORDERED", false);
+  shandle.stream_ordered           = stream_ordered && shandle.ctx.dev_mask() == gpu::kDevMask;
+#endif
+  Storage::Get()->Alloc(&shandle);
+#if MXNET_USE_CUDA
+  if (shandle.stream_ordered && !shandle.sync_obj.events.empty()) {
+    // the previous users of reused memory become readers of this variable,
+    // so the first writer waits for them on its own stream
+    auto& storage_sync_obj = shandle.sync_obj;
+    auto& sync_obj         = var->sync_object;
+    {
+      std::lock_guard<std::mutex> l(sync_obj.mutex);
+      for (size_t i = 0; i < storage_sync_obj.events.size(); ++i) {
+        const auto& stream_info = storage_sync_obj.event_streams[i];
+        sync_obj.reader_events.push_back(
+            {storage_sync_obj.events[i], stream_info.first, stream_info.second});
+      }
+    }
+    storage_sync_obj = Storage::SyncObj();
+  }
+#endif
+}
+
 void NDArray::Chunk::CheckAndAllocData(const mxnet::TShape& shape, int dtype) {
   CHECK_NE(aux_shapes.size(), 0) << "data is expected to be allocated after aux_data";
   auto dbytes = shape.Size() * mshadow::mshadow_sizeof(dtype);
@@ -178,10 +323,10 @@ void NDArray::Chunk::CheckAndAllocData(const mxnet::TShape& shape, int dtype) {
   }
   if (shandle.size < dbytes) {
     // free storage
-    Storage::Get()->Free(shandle);
+    FreeHandle(shandle);
     // init storage
     shandle.size = dbytes;
-    Storage::Get()->Alloc(&shandle);
+    AllocHandle();
 #if MXNET_USE_ONEDNN == 1
     dnnl_mem_ = nullptr;
 #endif
@@ -217,7 +362,7 @@ NDArray::NDArray(const void* md_desc) : storage_type_(kDefaultStorage), autograd
   dnnl::memory::desc md = *static_cast<const dnnl::memory::desc*>(md_desc);
   shape_                = mxnet::TShape(md.data.dims, md.data.dims + md.data.ndims);
   dtype_                = get_mxnet_type(md.data.data_type);
-  ptr_                  = std::make_shared<Chunk>(shape_, Context::CPU(), true, dtype_);
+  ptr_                  = NewChunk(shape_, Context::CPU(), true, dtype_);
   ptr_->CheckAndAlloc(md.get_size());
   ptr_->dnnl_mem_ = std::make_shared<DNNLMemory>(md, ptr_->shandle.dptr);
 }
@@ -227,7 +372,7 @@ NDArray::NDArray(const std::shared_ptr<dnnl::memory>& dnnl_mem)
   auto mem_desc      = dnnl_mem->get_desc();
   shape_             = mxnet::TShape(mem_desc.data.dims, mem_desc.data.dims + mem_desc.data.ndims);
   dtype_             = get_mxnet_type(mem_desc.data.data_type);
-  ptr_               = std::make_shared<Chunk>(shape_, Context::CPU(), true, dtype_);
+  ptr_               = NewChunk(shape_, Context::CPU(), true, dtype_);
   ptr_->shandle.dptr = dnnl_mem->get_data_handle();
   ptr_->shandle.size = mem_desc.get_size();
   ptr_->delay_alloc  = false;
@@ -357,6 +502,9 @@ NDArray NDArray::Slice(index_t begin, index_t end) const {
       ret.dtype(), DType, { ret.byte_offset_ += begin * length * sizeof(DType); });
   ret.reuse_    = false;
   ret.shape_[0] = end - begin;
+  // writes to the view don't wait for the ones to disjoint views
+  ret.region_var_ = ptr_->RegionVar(
+      ret.byte_offset_, ret.byte_offset_ + ret.shape_.Size() * mshadow::mshadow_sizeof(dtype_));
   return ret;
 }
 
@@ -935,7 +1083,7 @@ void NDArray::SetTBlob() const {
                          << "Please use Reorder2Default() to generate a new NDArray first";
 #endif
     dptr += byte_offset_;
-  } else if (stype == kCSRStorage || stype == kRowSparseStorage) {
+  } else if (stype == kCSRStorage || stype == kRowSparseStorage || stype == kBSRStorage) {
     CHECK_EQ(byte_offset_, 0);
     shape = storage_shape();
   } else {
@@ -1260,6 +1408,7 @@ size_t num_aux_data(NDArrayStorageType stype) {
       num = 0;
       break;
     case kCSRStorage:
+    case kBSRStorage:
       num = 2;
       break;
     case kRowSparseStorage:
@@ -1295,6 +1444,23 @@ inline void CopyFromToCsrImpl(const NDArray& from, const NDArray& to, RunContext
   ndarray::Copy<from_xpu, to_xpu>(from.aux_data(csr::kIdx), &idx, from.ctx(), to.ctx(), ctx);
 }
 
+// Make a copy of a BSR NDArray, with the block shape of the source
+template <typename from_xpu, typename to_xpu>
+inline void CopyFromToBsrImpl(const NDArray& from, const NDArray& to, RunContext ctx) {
+  using namespace mshadow;
+  CHECK_EQ(from.storage_type(), to.storage_type()) << "Copying with different storage type";
+  // Allocate storage
+  to.CheckAndAllocAuxData(bsr::kIndPtr, from.aux_shape(bsr::kIndPtr));
+  to.CheckAndAllocAuxData(bsr::kIdx, from.aux_shape(bsr::kIdx));
+  to.CheckAndAllocData(from.storage_shape());
+  TBlob val    = to.data();
+  TBlob indptr = to.aux_data(bsr::kIndPtr);
+  TBlob idx    = to.aux_data(bsr::kIdx);
+  ndarray::Copy<from_xpu, to_xpu>(from.data(), &val, from.ctx(), to.ctx(), ctx);
+  ndarray::Copy<from_xpu, to_xpu>(from.aux_data(bsr::kIndPtr), &indptr, from.ctx(), to.ctx(), ctx);
+  ndarray::Copy<from_xpu, to_xpu>(from.aux_data(bsr::kIdx), &idx, from.ctx(), to.ctx(), ctx);
+}
+
 // Make a copy of a row-sparse NDArray
 template <typename from_xpu, typename to_xpu>
 inline void CopyFromToRspImpl(const NDArray& from, const NDArray& to, RunContext ctx) {
@@ -1403,6 +1569,8 @@ void CopyFromToImpl(const NDArray& from,
       CopyFromToRspImpl<from_xpu, to_xpu>(casted_nd, to, rctx);
     } else if (to_stype == kCSRStorage) {
       CopyFromToCsrImpl<from_xpu, to_xpu>(casted_nd, to, rctx);
+    } else if (to_stype == kBSRStorage) {
+      CopyFromToBsrImpl<from_xpu, to_xpu>(casted_nd, to, rctx);
     } else {
       LOG(FATAL) << "unknown storage type" << to_stype;
     }
@@ -2147,6 +2315,95 @@ void NDArray::Load(dmlc::Stream* fi, std::vector<NDArray>* data, std::vector<std
   CHECK(keys->size() == 0 || keys->size() == data->size()) << "Invalid NDArray file format";
 }
 
+#ifndef _WIN32
+/*! \brief private mapping of a whole file, unmapped with the last array pointing into it */
+struct MappedNDArrayFile {
+  void* addr  = nullptr;
+  size_t size = 0;
+  ~MappedNDArrayFile() {
+    if (addr != nullptr)
+      munmap(addr, size);
+  }
+};
+
+/*!
+ * \brief load one ndarray written by NDArray::Save, pointing into the mapping when it is a
+ *  dense array whose data is aligned to its type, and copying it otherwise.
+ */
+static bool LoadMappedNDArray(dmlc::SeekStream* strm,
+                              const std::shared_ptr<MappedNDArrayFile>& file,
+                              NDArray* out) {
+  const size_t start = strm->Tell();
+  const int np_shape = Imperative::Get()->is_np_shape();
+  uint32_t magic;
+  int32_t stype, type_flag;
+  mxnet::TShape shape;
+  Context ctx;
+  // legacy arrays and arrays of the other shape semantics are left to Load, which
+  // converts or reports them
+  bool mappable = strm->Read(&magic, sizeof(magic)) == sizeof(magic);
+  if (magic == NDARRAY_V3_MAGIC) {
+    mappable = mappable && np_shape;
+  } else {
+    mappable = mappable && magic == NDARRAY_V2_MAGIC && (np_shape == GlobalOn || !np_shape);
+  }
+  mappable = mappable && strm->Read(&stype, sizeof(stype)) == sizeof(stype) &&
+             stype == kDefaultStorage && shape.Load(strm) && shape.ndim() > 0 &&
+             shape_is_known(shape) && ctx.Load(strm) &&
+             strm->Read(&type_flag, sizeof(type_flag)) == sizeof(type_flag);
+  if (mappable) {
+    const size_t offset    = strm->Tell();
+    const size_t type_size = mshadow::mshadow_sizeof(type_flag);
+    const size_t nbytes    = type_size * shape.Size();
+    if (offset % type_size == 0 && offset + nbytes <= file->size) {
+      TBlob data(static_cast<char*>(file->addr) + offset, shape, cpu::kDevMask, type_flag, 0);
+      *out = NDArray(data, 0, [file]() {});
+      strm->Seek(offset + nbytes);
+      return true;
+    }
+  }
+  strm->Seek(start);
+  return out->Load(strm);
+}
+#endif  // _WIN32
+
+void NDArray::LoadMapped(const std::string& fname,
+                         std::vector<NDArray>* data,
+                         std::vector<std::string>* keys) {
+#ifndef _WIN32
+  int fd = open(fname.c_str(), O_RDONLY);
+  CHECK_GE(fd, 0) << "Failed to open " << fname << ": " << strerror(errno);
+  struct stat st;
+  CHECK_EQ(fstat(fd, &st), 0) << "Failed to stat " << fname << ": " << strerror(errno);
+  auto file  = std::make_shared<MappedNDArrayFile>();
+  file->size = static_cast<size_t>(st.st_size);
+  // copy-on-write: untouched pages stay shared in the page cache with the other processes
+  // mapping the file, and written pages get private copies
+  void* addr = file->size == 0 ?
+                   MAP_FAILED :
+                   mmap(nullptr, file->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  CHECK_NE(addr, MAP_FAILED) << "Failed to map " << fname << ": " << strerror(errno);
+  file->addr = addr;
+
+  dmlc::MemoryFixedSizeStream strm(file->addr, file->size);
+  uint64_t header, reserved, size;
+  CHECK(strm.Read(&header)) << "Invalid NDArray file format";
+  CHECK(strm.Read(&reserved)) << "Invalid NDArray file format";
+  CHECK(header == kMXAPINDArrayListMagic) << "Invalid NDArray file format";
+  CHECK(strm.Read(&size)) << "Invalid NDArray file format";
+  data->resize(size);
+  for (size_t i = 0; i < size; ++i) {
+    CHECK(LoadMappedNDArray(&strm, file, &(*data)[i])) << "Invalid NDArray file format";
+  }
+  CHECK(strm.Read(keys)) << "Invalid NDArray file format";
+  CHECK(keys->size() == 0 || keys->size() == data->size()) << "Invalid NDArray file format";
+#else
+  std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(fname.c_str(), "r"));
+  Load(fi.get(), data, keys);
+#endif  // _WIN32
+}
+
 NDArray NDArray::Copy(Context ctx) const {
   NDArray ret;
   if (kDefaultStorage == storage_type()) {
@@ -2180,6 +2437,9 @@ void NDArray::SyncCopyFromCPU(const void* data, size_t size) const {
   if (size == 0U) {
     return;
   }
+  // the operators pending lazy evaluation may read or write the array
+  if (Imperative::Get()->is_lazy_eval())
+    Imperative::Get()->FlushLazyEval();
   TBlob src((void*)data, dshape, cpu::kDevMask, this->dtype_, 0);  // NOLINT(*)
 
   if (this->ctx().dev_mask() == cpu::kDevMask) {
@@ -2239,10 +2499,11 @@ void NDArray::SyncCopyFromNDArray(const NDArray& src, int i, int j) {
   // get or create a dst tblob for copying src to it
   // if dst is a dense format and has not been allocated, allocate memory for it
   // else if dst is not initialized, allocate corresponding data blob for it
+  // the blocks copied to a bsr always reallocate its data, as they set its block shape
   auto get_dst_data = [&](const mxnet::TShape& src_shape) {
     if (this->storage_type() == kDefaultStorage) {
       this->ReshapeAndAlloc(src_shape);
-    } else if (!this->storage_initialized()) {
+    } else if (!this->storage_initialized() || (j < 0 && this->storage_type() == kBSRStorage)) {
       if (j < 0) {
         this->CheckAndAllocData(src_shape);
       } else {
@@ -2338,6 +2599,40 @@ void NDArray::SyncCopyFromNDArray(const NDArray& src, int i, int j) {
   WaitToRead();
 }
 
+#if MXNET_USE_CUDA
+/*!
+ * \brief waits for the events of the operations on the streams of the other workers using var
+ */
+static void SyncStreamEvents(Engine::VarHandle var) {
+  auto& sync_obj = var->sync_object;
+  std::lock_guard<std::mutex> lock{sync_obj.mutex};
+  bool has_writer = false;
+  std::shared_ptr<cudaEvent_t> w_ev_ptr;
+  if (!sync_obj.writer_event.empty()) {
+    w_ev_ptr   = sync_obj.writer_event[0].event.lock();
+    has_writer = w_ev_ptr ? true : false;
+  }
+  for (auto ev : sync_obj.reader_events) {
+    auto event_ptr = ev.event.lock();
+    if (!event_ptr) {
+      continue;
+    }
+    cudaEvent_t event = *event_ptr;
+    if (has_writer) {
+      auto w_ev = sync_obj.writer_event[0];
+      if (w_ev.stream == ev.stream) {
+        event      = w_ev.pool_index > ev.pool_index ? *w_ev_ptr : *event_ptr;
+        has_writer = false;
+      }
+    }
+    CUDA_CALL(cudaEventSynchronize(event));
+  }
+  if (has_writer) {
+    CUDA_CALL(cudaEventSynchronize(*w_ev_ptr));
+  }
+}
+#endif
+
 void NDArray::SyncCopyToCPU(void* data, size_t size) const {
   mxnet::TShape dshape = this->shape();
   if (!features::is_enabled(features::INT64_TENSOR_SIZE)) {
@@ -2369,35 +2664,7 @@ void NDArray::SyncCopyToCPU(void* data, size_t size) const {
             Engine::CallbackOnStart on_start,
             Engine::CallbackOnComplete on_complete) {
           on_start();
-          {
-            auto var       = this->var();
-            auto& sync_obj = var->sync_object;
-            std::lock_guard<std::mutex> lock{sync_obj.mutex};
-            bool has_writer = false;
-            std::shared_ptr<cudaEvent_t> w_ev_ptr;
-            if (!sync_obj.writer_event.empty()) {
-              w_ev_ptr   = sync_obj.writer_event[0].event.lock();
-              has_writer = w_ev_ptr ? true : false;
-            }
-            for (auto ev : sync_obj.reader_events) {
-              auto event_ptr = ev.event.lock();
-              if (!event_ptr) {
-                continue;
-              }
-              cudaEvent_t event = *event_ptr;
-              if (has_writer) {
-                auto w_ev = sync_obj.writer_event[0];
-                if (w_ev.stream == ev.stream) {
-                  event      = w_ev.pool_index > ev.pool_index ? *w_ev_ptr : *event_ptr;
-                  has_writer = false;
-                }
-              }
-              CUDA_CALL(cudaEventSynchronize(event));
-            }
-            if (has_writer) {
-              CUDA_CALL(cudaEventSynchronize(*w_ev_ptr));
-            }
-          }
+          SyncStreamEvents(this->var());
           ndarray::Copy<gpu, cpu>(this->data(), &dst, this->ctx(), Context::CPU(), rctx);
           on_complete();
         },
@@ -2414,6 +2681,71 @@ void NDArray::SyncCopyToCPU(void* data, size_t size) const {
   }
 }
 
+void NDArray::AsyncCopyToCPU(void* data, size_t size, Engine::VarHandle done) const {
+  mxnet::TShape dshape = this->shape();
+  if (!features::is_enabled(features::INT64_TENSOR_SIZE)) {
+    CHECK_LT(size, (int64_t{1} << 31) - 1)
+        << "[AsyncCopyToCPU] Size of tensor you are trying to allocate is larger than "
+           "2^31 elements. Please build with flag USE_INT64_TENSOR_SIZE=1";
+  }
+  CHECK_EQ(dshape.Size(), size) << "Memory size do not match";
+  TBlob dst(data, dshape, cpu::kDevMask, this->dtype_, 0);  // NOLINT(*)
+  NDArray src = *this;
+#if MXNET_USE_ONEDNN == 1
+  if (src.IsDNNLData()) {
+    // the reorder of the layout reads the data on the calling thread
+    this->SyncCopyToCPU(data, size);
+    Engine::Get()->PushSync(
+        [](RunContext) {}, Context::CPU(), {}, {done}, FnProperty::kNormal, 0, "AsyncCopyCPU2CPU");
+    return;
+  }
+#endif
+  if (this->ctx().dev_mask() == cpu::kDevMask) {
+    Engine::Get()->PushSync(
+        [src, dst](RunContext rctx) {
+          TBlob to = dst;
+          if (to.Size() != 0)
+            ndarray::Copy<cpu, cpu>(src.data(), &to, Context::CPU(), Context::CPU(), rctx);
+        },
+        src.ctx(),
+        {src.var()},
+        {done},
+        FnProperty::kNormal,
+        0,
+        "AsyncCopyCPU2CPU");
+  } else {
+#if MXNET_USE_CUDA
+    Engine::Get()->PushAsync(
+        [src, dst](RunContext rctx,
+                   Engine::CallbackOnStart on_start,
+                   Engine::CallbackOnComplete on_complete) {
+          on_start();
+          const size_t bytes = dst.Size() * mshadow::mshadow_sizeof(dst.type_flag_);
+          if (bytes != 0) {
+            SyncStreamEvents(src.var());
+            const Context pinned_ctx = Context::CPUPinned(src.ctx().dev_id);
+            Storage::Handle staging  = Storage::Get()->Alloc(bytes, pinned_ctx);
+            TBlob pinned(staging.dptr, dst.shape_, cpu::kDevMask, dst.type_flag_, 0);
+            ndarray::Copy<gpu, cpu>(src.data(), &pinned, src.ctx(), pinned_ctx, rctx);
+            // the copy is asynchronous on the copy stream, only this worker waits for it
+            rctx.get_stream<gpu>()->Wait();
+            std::memcpy(dst.dptr_, staging.dptr, bytes);
+            Storage::Get()->Free(staging);
+          }
+          on_complete();
+        },
+        src.ctx(),
+        {src.var()},
+        {done},
+        FnProperty::kCopyFromGPU,
+        0,
+        "AsyncCopyGPU2CPU");
+#else
+    LOG(FATAL) << "GPU is not enabled";
+#endif
+  }
+}
+
 void NDArray::SyncCheckFormat(const bool full_check) const {
   int32_t err = kNormalErr;
   TBlob err_cpu(&err, mshadow::Shape1(1), cpu::kDevMask, 0);
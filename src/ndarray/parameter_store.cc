@@ -0,0 +1,110 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file parameter_store.cc
+ * \brief implementation of the store deduplicating the parameters
+ */
+#include <cstring>
+#include "./parameter_store.h"
+
+namespace mxnet {
+
+namespace {
+
+/*! \brief 64-bit FNV-1a hash */
+uint64_t Hash(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+}  // namespace
+
+ParameterStore* ParameterStore::Get() {
+  static ParameterStore store;
+  return &store;
+}
+
+std::vector<uint8_t> ParameterStore::Content(const NDArray& arr) {
+  std::vector<uint8_t> content(arr.shape().Size() * mshadow::mshadow_sizeof(arr.dtype()));
+  if (!content.empty())
+    arr.SyncCopyToCPU(content.data(), arr.shape().Size());
+  return content;
+}
+
+NDArray ParameterStore::Share(const std::shared_ptr<NDArray>& owner,
+                              const std::shared_ptr<std::atomic<size_t>>& count) {
+  ++*count;
+  return NDArray(owner->data(), owner->ctx().dev_id, [owner, count]() { --*count; });
+}
+
+NDArray ParameterStore::Deduplicate(const NDArray& arr) {
+  if (arr.is_none() || arr.storage_type() != kDefaultStorage)
+    return arr;
+  const std::vector<uint8_t> content = Content(arr);
+  const mxnet::TShape& shape         = arr.shape();
+  const Context ctx                  = arr.ctx();
+  const int dtype                    = arr.dtype();
+  uint64_t key                       = Hash(content.data(), content.size());
+  key                                = Hash(&dtype, sizeof(dtype), key);
+  key                                = Hash(shape.data(), shape.ndim() * sizeof(dim_t), key);
+  key                                = Hash(&ctx.dev_type, sizeof(ctx.dev_type), key);
+  key                                = Hash(&ctx.dev_id, sizeof(ctx.dev_id), key);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto range = entries_.equal_range(key);
+  for (auto it = range.first; it != range.second;) {
+    std::shared_ptr<NDArray> owner = it->second.owner.lock();
+    if (!owner) {
+      it = entries_.erase(it);
+      continue;
+    }
+    // a collision of the hashes is told apart by the content
+    if (owner->shape() == shape && owner->dtype() == dtype && owner->ctx() == ctx &&
+        Content(*owner) == content) {
+      return Share(owner, it->second.num_shared);
+    }
+    ++it;
+  }
+  // the last of the arrays sharing the memory frees the owner, expiring the entry
+  auto owner      = std::make_shared<NDArray>(arr);
+  auto num_shared = std::make_shared<std::atomic<size_t>>(0);
+  entries_.emplace(key, Entry{owner, num_shared});
+  return Share(owner, num_shared);
+}
+
+size_t ParameterStore::saved_bytes() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t bytes = 0;
+  for (const auto& entry : entries_) {
+    std::shared_ptr<NDArray> owner = entry.second.owner.lock();
+    const size_t num_shared        = *entry.second.num_shared;
+    if (owner && num_shared > 1) {
+      bytes += (num_shared - 1) * owner->shape().Size() *
+               mshadow::mshadow_sizeof(owner->dtype());
+    }
+  }
+  return bytes;
+}
+
+}  // namespace mxnet
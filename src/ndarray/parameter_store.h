@@ -0,0 +1,73 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file parameter_store.h
+ * \brief process wide store deduplicating the parameters of the models loaded in a process
+ */
+#ifndef MXNET_NDARRAY_PARAMETER_STORE_H_
+#define MXNET_NDARRAY_PARAMETER_STORE_H_
+
+#include <mxnet/base.h>
+#include <mxnet/ndarray.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mxnet {
+
+/*!
+ * \brief Deduplicates the parameters of the models sharing weights, e.g. the variants of a
+ *        backbone served from one GPU. The arrays of the same content, shape, type and context
+ *        are given the memory of the first one. The memory is refcounted by the deduplicated
+ *        arrays, and freed with the last of them.
+ */
+class ParameterStore {
+ public:
+  static ParameterStore* Get();
+  /*!
+   * \brief An array of the content of arr, sharing the memory of the arrays of the same content
+   *        deduplicated before. The arrays returned are read only: a write to one of them is seen
+   *        by the models sharing it. Arrays of the other storage types are returned as is.
+   */
+  NDArray Deduplicate(const NDArray& arr);
+  /*! \brief bytes of the memory shared by the live deduplicated arrays */
+  size_t saved_bytes();
+
+ private:
+  struct Entry {
+    std::weak_ptr<NDArray> owner;
+    /*! \brief number of the live deduplicated arrays sharing the memory of owner */
+    std::shared_ptr<std::atomic<size_t>> num_shared;
+  };
+  /*! \brief bytes of arr, read back to the CPU if needed */
+  static std::vector<uint8_t> Content(const NDArray& arr);
+  /*! \brief an array viewing the memory of owner which keeps it alive */
+  static NDArray Share(const std::shared_ptr<NDArray>& owner,
+                       const std::shared_ptr<std::atomic<size_t>>& count);
+
+  std::mutex mutex_;
+  std::unordered_multimap<uint64_t, Entry> entries_;
+};
+
+}  // namespace mxnet
+#endif  // MXNET_NDARRAY_PARAMETER_STORE_H_
@@ -33,6 +33,7 @@
 #include <functional>
 #include <queue>
 #include <sstream>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -55,11 +56,14 @@ struct GradEntry {
 /*!
  * \brief Build the backward graph from the mirror map. This function will be
  *        invoked twice if backward mirroring has been enabled.
+ *        `output_grads` holds the gradient entries of every node of `topo_order`,
+ *        at the position of the node given by `topo_index`.
  */
 Graph BuildGradientGraph(const Graph& src,
                          const std::vector<NodeEntry>& xs,
                          const std::vector<ObjectPtr>& topo_order,
-                         std::unordered_map<const Node*, std::vector<GradEntry> > output_grads,
+                         const std::unordered_map<const Node*, uint32_t>& topo_index,
+                         std::vector<std::vector<GradEntry> > output_grads,
                          std::function<int(const Node&)> mirror_fun,
                          const std::unordered_map<const Node*, ObjectPtr>& mirror_map,
                          const std::vector<NodeEntry>& us = std::vector<NodeEntry>());
@@ -91,24 +95,24 @@ Graph Gradient(Graph src) {
   const std::vector<NodeEntry>& us = src.GetAttr<std::vector<NodeEntry> >("grad_us");
 
   // initialize a topological order of the graph nodes and `output_grads`
-  // that maps every operator node to its gradient entries
+  // that holds the gradient entries of every node, indexed by its position in the order
   std::vector<ObjectPtr> topo_order;
-  std::unordered_map<const Node*, std::vector<GradEntry> > output_grads;
+  std::unordered_map<const Node*, uint32_t> topo_index;
+  std::vector<std::vector<GradEntry> > output_grads;
 
   DFSVisit(ys, [&](const ObjectPtr& node) {
-    if (output_grads.count(node.get()) == 0) {
-      output_grads[node.get()].resize(node->num_outputs());
-    }
+    topo_index.emplace(node.get(), topo_order.size());
     topo_order.push_back(node);
+    output_grads.emplace_back(node->num_outputs());
   });
 
   for (size_t i = 0; i < ys.size(); ++i) {
-    output_grads[ys[i].node.get()][ys[i].index].grads = {ys_out_grad[i]};
+    output_grads[topo_index.at(ys[i].node.get())][ys[i].index].grads = {ys_out_grad[i]};
   }
 
   // check that all xs are reachable from ys
   for (size_t i = 0; i < xs.size(); ++i) {
-    CHECK(output_grads.find(xs[i].node.get()) != output_grads.end())
+    CHECK(topo_index.count(xs[i].node.get()) != 0)
         << "Cannot differentiate with respect to the " << (i + 1) << "-th variable "
         << "because it is unreachable from the outputs.";
   }
@@ -121,11 +125,28 @@ Graph Gradient(Graph src) {
   std::unordered_map<const Node*, ObjectPtr> mirror_map;
 
   // complete the backward graph of the src, but without backward mirroring
-  nnvm::Graph gsrc = BuildGradientGraph(src, xs, topo_order, output_grads, nullptr, mirror_map, us);
   if (mirror_fun == nullptr) {
-    return gsrc;  // Gradient pass without mirroring ends here.
+    // Gradient pass without mirroring ends here.
+    return BuildGradientGraph(
+        src, xs, topo_order, topo_index, std::move(output_grads), nullptr, mirror_map, us);
   }
+  nnvm::Graph gsrc =
+      BuildGradientGraph(src, xs, topo_order, topo_index, output_grads, nullptr, mirror_map, us);
   const IndexedGraph &idx = src.indexed_graph(), &gidx = gsrc.indexed_graph();
+  // The mirroring decision of every forward node is made once, all the
+  // traversals below query it many times.
+  std::vector<int8_t> mirror_decisions(idx.num_nodes(), -1);
+  auto can_mirror = [&mirror_decisions, &mirror_fun, &idx](const Node& n) {
+    int8_t& decision = mirror_decisions[idx.node_id(&n)];
+    if (decision < 0) {
+      decision = mirror_fun(n) ? 1 : 0;
+    }
+    return decision != 0;
+  };
+  std::unordered_set<const Node*> y_nodes;
+  for (const NodeEntry& y : ys) {
+    y_nodes.insert(y.node.get());
+  }
   // ===========================================================================
   // ----- Gradient Pass w/ Backward Mirroring -----
   // ===========================================================================
@@ -195,23 +216,24 @@ Graph Gradient(Graph src) {
     // After invoking this function. `subgraph` will become {A, B}.
     // Note that this function will be invoked multiple times.
     auto subworklist_backprop =
-        [&subworklist, &subgraph, &subgraph_topo_order, &mirror_fun, &worklist]() {
+        [&subworklist, &subgraph, &subgraph_topo_order, &can_mirror, &worklist]() {
           std::deque<const Node*> subworklist_topo_order;
           for (; !subworklist.empty(); subworklist.pop()) {
             const Node* const subworkitem = subworklist.front();
-            if (subgraph.find(subworkitem) == subgraph.end()) {
-              subgraph.insert(subworkitem);
-              subworklist_topo_order.push_front(subworkitem);
+            // the inputs of a node already in the subgraph have been visited
+            if (!subgraph.insert(subworkitem).second) {
+              continue;
             }
+            subworklist_topo_order.push_front(subworkitem);
             for (const NodeEntry& e : subworkitem->inputs) {
-              if (!mirror_fun(*(e.node))) {
+              if (!can_mirror(*(e.node))) {
                 worklist.push(e.node.get());
               } else {
                 subworklist.push(e.node.get());
               }
             }
             for (const ObjectPtr& n : subworkitem->control_deps) {
-              if (!mirror_fun(*n)) {
+              if (!can_mirror(*n)) {
                 worklist.push(n.get());
               } else {
                 subworklist.push(n.get());
@@ -247,73 +269,60 @@ Graph Gradient(Graph src) {
     // three branches share the same node entries (i.e., the outputs of D) and
     // hence they are all affected by the decision on whether D should be put
     // onto the mirror path or not.
-    bool has_subgraph_converged;
-    do {
-      has_subgraph_converged = true;
-      for (const Node* const subgraph_node : subgraph_topo_order) {
-        for (const NodeEntry& subgraph_node_entry : subgraph_node->inputs) {
-          const std::unordered_set<const Node*> ref_nodes =
-              node_entry_ref_map[gidx.entry_id(subgraph_node_entry)];
-
-          for (const Node* const ref_node : ref_nodes) {
-            // If there are other nodes that reference the node entry and that
-            // node satisfies the following conditions:
-            //   (1) belongs to the forward graph, and
-            //   (2) is not part of the subgraph
-            // We add that node to the subgraph and adjust the topological order
-            // accordingly.
-            if (ref_node != subgraph_node && idx.exist(ref_node) &&
-                subgraph.find(ref_node) == subgraph.end()) {
-              // Forward propagate from the reference node until the mirroring
-              // function returns false. This indicates that the head of the
-              // branch has been reached (i.e., B or C in our previously
-              // illustrated example), and we add it to the subworklist for
-              // another backpropagation.
-              std::queue<const Node*> ref_node_heads;
-              ref_node_heads.push(ref_node);
-              for (; !ref_node_heads.empty(); ref_node_heads.pop()) {
-                const Node* const ref_node_head = ref_node_heads.front();
-                bool is_ref_node_head_output    = false;
-                for (const NodeEntry& y : ys) {
-                  if (ref_node_head == y.node.get()) {
-                    is_ref_node_head_output = true;
-                  }
-                }
-                if (!mirror_fun(*ref_node_head) || is_ref_node_head_output) {
-                  subworklist.push(ref_node_head);
-                  continue;
-                }
+    //
+    // Nodes are only ever appended to the topological order and the subgraph
+    // only grows, so a node that has been scanned never needs to be scanned
+    // again, and a single scan over the growing order suffices.
+    for (size_t k = 0; k < subgraph_topo_order.size(); ++k) {
+      const Node* const subgraph_node = subgraph_topo_order[k];
+      for (const NodeEntry& subgraph_node_entry : subgraph_node->inputs) {
+        const std::unordered_set<const Node*>& ref_nodes =
+            node_entry_ref_map[gidx.entry_id(subgraph_node_entry)];
+
+        for (const Node* const ref_node : ref_nodes) {
+          // If there are other nodes that reference the node entry and that
+          // node satisfies the following conditions:
+          //   (1) belongs to the forward graph, and
+          //   (2) is not part of the subgraph
+          // We add that node to the subgraph and adjust the topological order
+          // accordingly.
+          if (ref_node != subgraph_node && idx.exist(ref_node) &&
+              subgraph.find(ref_node) == subgraph.end()) {
+            // Forward propagate from the reference node until the mirroring
+            // function returns false. This indicates that the head of the
+            // branch has been reached (i.e., B or C in our previously
+            // illustrated example), and we add it to the subworklist for
+            // another backpropagation.
+            std::queue<const Node*> ref_node_heads;
+            std::unordered_set<const Node*> visited_ref_nodes{ref_node};
+            ref_node_heads.push(ref_node);
+            for (; !ref_node_heads.empty(); ref_node_heads.pop()) {
+              const Node* const ref_node_head = ref_node_heads.front();
+              if (!can_mirror(*ref_node_head) || y_nodes.count(ref_node_head) != 0) {
+                subworklist.push(ref_node_head);
+                continue;
+              }
 
-                uint32_t gnid = gidx.node_id(ref_node_head);
-                for (uint32_t oid = 0; oid < ref_node_head->num_outputs(); ++oid) {
-                  uint32_t geid = gidx.entry_id(gnid, oid);
-                  for (const Node* const n : node_entry_ref_map[geid]) {
-                    if (idx.exist(n)) {
-                      ref_node_heads.push(n);
-                    }
+              uint32_t gnid = gidx.node_id(ref_node_head);
+              for (uint32_t oid = 0; oid < ref_node_head->num_outputs(); ++oid) {
+                uint32_t geid = gidx.entry_id(gnid, oid);
+                for (const Node* const n : node_entry_ref_map[geid]) {
+                  if (idx.exist(n) && visited_ref_nodes.insert(n).second) {
+                    ref_node_heads.push(n);
                   }
-                }  // for (oid ∈ [0, ref_node_head->num_outputs()))
-              }    // for (ref_node_head ∈ ref_node_heads)
-              // Do the backpropagation again. The topological order of the
-              // subworklist can be directly appended to the end of the existing
-              // order. E,g, in our previous example, we expect to have
-              // `subgraph_topo_order` = {D, A} + {B} + {C}
-              subworklist_backprop();
-              // indicate that the subgraph has not changed the quit the loop
-              has_subgraph_converged = false;
-              break;
-            }  // if (ref_node != subgraph_node && idx.exist(ref_node) &&
-               //     subgraph.find(ref_node) == subgraph.end()
-          }    // for (ref_node ∈ ref_nodes)
-          if (!has_subgraph_converged) {
-            break;
-          }
-        }  // for (subgraph_node_entry ∈ subgraph_node->inputs)
-        if (!has_subgraph_converged) {
-          break;
-        }
-      }  // for (subgraph_node ∈ subgraph_topo_order)
-    } while (!has_subgraph_converged);
+                }
+              }  // for (oid ∈ [0, ref_node_head->num_outputs()))
+            }    // for (ref_node_head ∈ ref_node_heads)
+            // Do the backpropagation again. The topological order of the
+            // subworklist can be directly appended to the end of the existing
+            // order. E,g, in our previous example, we expect to have
+            // `subgraph_topo_order` = {D, A} + {B} + {C}
+            subworklist_backprop();
+          }  // if (ref_node != subgraph_node && idx.exist(ref_node) &&
+             //     subgraph.find(ref_node) == subgraph.end()
+        }    // for (ref_node ∈ ref_nodes)
+      }      // for (subgraph_node_entry ∈ subgraph_node->inputs)
+    }        // for (subgraph_node ∈ subgraph_topo_order)
     // =========================================================================
     // --- Forward Pass ---
     // =========================================================================
@@ -322,6 +331,7 @@ Graph Gradient(Graph src) {
     // from the subgraph frontier. The propagation is successful if the amount
     // of storage released by removing the frontier nodes off the mirror path is
     // greater or equal to the storage allocated.
+    bool has_subgraph_converged;
     do {
       has_subgraph_converged = true;
       // Obtain the subgraph frontier. The subgraph frontier denotes a group of
@@ -339,7 +349,7 @@ Graph Gradient(Graph src) {
       // the mirror path (and hence the forward propagation) starts.
       subgraph_frontier.clear();
       for (const Node* const subgraph_node : subgraph) {
-        if (!mirror_fun(*subgraph_node)) {
+        if (!can_mirror(*subgraph_node)) {
           mirror_map[subgraph_node] = nullptr;
           continue;
         }
@@ -349,13 +359,13 @@ Graph Gradient(Graph src) {
         bool is_frontier = true;
         for (const NodeEntry& e : subgraph_node->inputs) {
           auto iter = mirror_map.find(e.node.get());
-          if (mirror_fun(*(e.node)) && !(iter != mirror_map.end() && iter->second == nullptr)) {
+          if (can_mirror(*(e.node)) && !(iter != mirror_map.end() && iter->second == nullptr)) {
             is_frontier = false;
           }
         }
         for (const ObjectPtr& n : subgraph_node->control_deps) {
           auto iter = mirror_map.find(n.get());
-          if (mirror_fun(*n) && !(iter != mirror_map.end() && iter->second == nullptr)) {
+          if (can_mirror(*n) && !(iter != mirror_map.end() && iter->second == nullptr)) {
             is_frontier = false;
           }
         }
@@ -381,31 +391,24 @@ Graph Gradient(Graph src) {
         // A      B       C
         std::unordered_set<const Node*> forward_candidates{frontier_node.first};
         frontier_node.second = true;
-        bool has_forward_candidates_converged;
-        do {
-          has_forward_candidates_converged = true;
-          for (const Node* const candidate : forward_candidates) {
-            for (const NodeEntry& candidate_input : candidate->inputs) {
-              uint32_t geid                                    = gidx.entry_id(candidate_input);
-              const std::unordered_set<const Node*>& ref_nodes = node_entry_ref_map[geid];
-              for (const Node* const ref_node : ref_nodes) {
-                if (ref_node != frontier_node.first &&
-                    subgraph_frontier.find(ref_node) != subgraph_frontier.end() &&
-                    forward_candidates.find(ref_node) == forward_candidates.end()) {
-                  subgraph_frontier[ref_node] = true;
-                  forward_candidates.insert(ref_node);
-                  has_forward_candidates_converged = false;
-                }
-              }  // for (ref_node ∈ ref_nodes)
-              if (!has_forward_candidates_converged) {
-                break;
+        // every candidate is expanded once, when it is added
+        std::queue<const Node*> candidate_worklist;
+        candidate_worklist.push(frontier_node.first);
+        for (; !candidate_worklist.empty(); candidate_worklist.pop()) {
+          const Node* const candidate = candidate_worklist.front();
+          for (const NodeEntry& candidate_input : candidate->inputs) {
+            uint32_t geid                                    = gidx.entry_id(candidate_input);
+            const std::unordered_set<const Node*>& ref_nodes = node_entry_ref_map[geid];
+            for (const Node* const ref_node : ref_nodes) {
+              auto frontier_iter = subgraph_frontier.find(ref_node);
+              if (frontier_iter != subgraph_frontier.end() &&
+                  forward_candidates.insert(ref_node).second) {
+                frontier_iter->second = true;
+                candidate_worklist.push(ref_node);
               }
-            }  // for (candidate_input ∈ candidate->inputs)
-            if (!has_forward_candidates_converged) {
-              break;
-            }
-          }  // for (candidate ∈ forward_candidates)
-        } while (!has_forward_candidates_converged);
+            }  // for (ref_node ∈ ref_nodes)
+          }    // for (candidate_input ∈ candidate->inputs)
+        }      // for (candidate ∈ candidate_worklist)
         // Record the node entries that are newly allocated and those that are
         // released. A node entry can be released if all its referencing nodes
         // are part of the subgraph frontier. Otherwise, it is in the allocated set.
@@ -481,7 +484,8 @@ Graph Gradient(Graph src) {
       node->attrs.dict["__mirror_stage__"] = "0";
     }
   });
-  return BuildGradientGraph(src, xs, topo_order, output_grads, mirror_fun, mirror_map);
+  return BuildGradientGraph(
+      src, xs, topo_order, topo_index, std::move(output_grads), mirror_fun, mirror_map);
 }
 
 /*!
@@ -508,7 +512,8 @@ inline bool CheckGradAllZero(const std::vector<NodeEntry>& grads,
 Graph BuildGradientGraph(const Graph& src,
                          const std::vector<NodeEntry>& xs,
                          const std::vector<ObjectPtr>& topo_order,
-                         std::unordered_map<const Node*, std::vector<GradEntry> > output_grads,
+                         const std::unordered_map<const Node*, uint32_t>& topo_index,
+                         std::vector<std::vector<GradEntry> > output_grads,
                          std::function<int(const Node&)> mirror_fun,
                          const std::unordered_map<const Node*, ObjectPtr>& mirror_map,
                          const std::vector<NodeEntry>& us) {
@@ -549,15 +554,14 @@ Graph BuildGradientGraph(const Graph& src,
                           nullptr;
 
   std::vector<NodeEntry> out_agg_grads;
-  for (auto topo_order_rit = topo_order.rbegin(); topo_order_rit != topo_order.rend();
-       ++topo_order_rit) {
-    const ObjectPtr& src_fwd_node = *topo_order_rit;
+  for (size_t topo_pos = topo_order.size(); topo_pos != 0; --topo_pos) {
+    const ObjectPtr& src_fwd_node = topo_order[topo_pos - 1];
     if (src_fwd_node->is_variable())
       continue;
 
     // gather all the output gradient entries and apply the aggregation function
     out_agg_grads.clear();
-    auto& out_grad_vec = output_grads.at(src_fwd_node.get());
+    auto& out_grad_vec = output_grads[topo_pos - 1];
     for (auto& e : out_grad_vec) {
       e.sum = agg_fun(std::move(e.grads));
       out_agg_grads.push_back(e.sum);
@@ -620,18 +624,18 @@ Graph BuildGradientGraph(const Graph& src,
       for (auto input_iter = src_fwd_node->inputs.begin(); input_iter != src_fwd_node->inputs.end();
            ++input_iter, ++input_grad_iter) {
         // propagate the input_grads to the corresponding GradEntries mapped by output_grads
-        output_grads[input_iter->node.get()][input_iter->index].grads.emplace_back(
+        output_grads[topo_index.at(input_iter->node.get())][input_iter->index].grads.emplace_back(
             std::move(*input_grad_iter));
       }
     }  // if (src_fwd_node->inputs.size() != 0)
-  }    // for (topo_order_rit ∈ reverse(topo_order))
+  }    // for (topo_pos ∈ reverse(topo_order))
   // take out the xs' grads
   Graph ret;
   ret.outputs.resize(xs.size());
   NodeEntryMap<std::pair<size_t, size_t> > unique_grads;
   size_t counter = 0;
   for (const NodeEntry& e : xs) {
-    GradEntry& entry = output_grads[e.node.get()][e.index];
+    GradEntry& entry = output_grads[topo_index.at(e.node.get())][e.index];
     // aggregate sum if there haven't been
     if (entry.sum.node.get() == nullptr) {
       entry.sum = agg_fun(std::move(entry.grads));
@@ -668,7 +672,7 @@ Graph BuildGradientGraph(const Graph& src,
   std::vector<NodeEntry> nleaf_grads;
   nleaf_grads.reserve(us.size());
   for (const NodeEntry& e : us) {
-    GradEntry& entry = output_grads[e.node.get()][e.index];
+    GradEntry& entry = output_grads[topo_index.at(e.node.get())][e.index];
     // aggregate sum if it hasn't been
     if (entry.sum.node.get() == nullptr) {
       entry.sum = agg_fun(std::move(entry.grads));
@@ -193,6 +193,87 @@ class MXGraphAllocator {
   const IndexedGraph* idx_;
 };
 
+/*!
+ * \brief Whether the slices of shape along axis are contiguous, that is whether the axes before
+ *  it have one element.
+ */
+bool MXSlicesAreContiguous(const mxnet::TShape& shape, int axis) {
+  if (!mxnet::shape_is_known(shape) || axis < 0 || axis >= shape.ndim())
+    return false;
+  return shape.ProdShape(0, axis) == 1;
+}
+
+/*!
+ * \brief The inputs of the concats that their producers write in their slice of the output.
+ *  The output of a concat, by the first producer of these: the node which allocates it.
+ */
+struct MXConcatSlices {
+  // the concat node
+  uint32_t nid;
+  // the entries of its inputs in place, and their byte offset in the output
+  std::vector<std::pair<uint32_t, int64_t> > inputs;
+};
+
+std::vector<std::vector<MXConcatSlices> > MXPlanConcatSlices(
+    const Graph& ret,
+    const IndexedGraph& idx,
+    const std::pair<uint32_t, uint32_t>& node_range,
+    const StorageVector& storage,
+    const std::vector<uint32_t>& entry_ref_count) {
+  static auto& fconcat_axis           = Op::GetAttr<mxnet::FConcatAxis>("FConcatAxis");
+  const mxnet::ShapeVector& shape_vec = ret.GetAttr<mxnet::ShapeVector>("shape");
+  const DTypeVector& dtype_vec        = ret.GetAttr<DTypeVector>("dtype");
+  const DeviceVector* device_vec      = nullptr;
+  if (ret.attrs.count("device") != 0) {
+    device_vec = &(ret.GetAttr<DeviceVector>("device"));
+  }
+  std::vector<std::vector<MXConcatSlices> > concats(idx.num_nodes());
+  std::vector<bool> taken(idx.num_node_entries(), false);
+  for (uint32_t nid = node_range.first; nid < node_range.second; ++nid) {
+    const auto& inode = idx[nid];
+    if (inode.source->is_variable() || fconcat_axis.count(inode.source->op()) == 0 ||
+        inode.source->num_outputs() != 1)
+      continue;
+    const uint32_t eid_out = idx.entry_id(nid, 0);
+    const auto& oshape     = shape_vec[eid_out];
+    if (storage[eid_out] != MXGraphAllocator::kBadStorageID || entry_ref_count[eid_out] == 0 ||
+        !MXSlicesAreContiguous(oshape,
+                               fconcat_axis[inode.source->op()](inode.source->attrs,
+                                                                oshape.ndim())))
+      continue;
+    MXConcatSlices slices{nid, {}};
+    uint32_t first  = nid;
+    int64_t offset  = 0;
+    size_t elements = 0;
+    for (const auto& e : inode.inputs) {
+      const uint32_t eid   = idx.entry_id(e);
+      const auto& ishape   = shape_vec[eid];
+      const bool known     = mxnet::shape_is_known(ishape);
+      const int64_t nbytes = known ? ishape.Size() * MXGetDTypeSize(dtype_vec[eid]) : 0;
+      // the input must be produced in the plan, on the device of the concat
+      if (!taken[eid] && storage[eid] == MXGraphAllocator::kBadStorageID &&
+          e.node_id >= node_range.first && !idx[e.node_id].source->is_variable() &&
+          (device_vec == nullptr || device_vec->at(e.node_id) == device_vec->at(nid)) &&
+          dtype_vec[eid] == dtype_vec[eid_out] && nbytes > 0) {
+        taken[eid] = true;
+        slices.inputs.emplace_back(eid, offset);
+        first = std::min(first, e.node_id);
+      }
+      offset += nbytes;
+      elements += known ? ishape.Size() : 0;
+    }
+    // the inputs must cover the output, one after the other
+    if (elements != oshape.Size()) {
+      for (const auto& input : slices.inputs)
+        taken[input.first] = false;
+      continue;
+    }
+    if (!slices.inputs.empty())
+      concats[first].push_back(std::move(slices));
+  }
+  return concats;
+}
+
 /*
  * Internal method to perform the memory allocation for a graph
  * */
@@ -201,15 +282,19 @@ size_t MXAllocMemory(const Graph& ret,
                      const std::pair<uint32_t, uint32_t>& node_range,
                      StorageVector* storage_ptr,
                      std::vector<int>* storage_inplace_index_ptr,
+                     std::vector<int64_t>* storage_slice_offset_ptr,
                      const std::vector<uint32_t>& entry_ref_count,
                      MXGraphAllocator* allocator) {
   static auto& finplace_option   = Op::GetAttr<FInplaceOption>("FInplaceOption");
   static auto& finplace_identity = Op::GetAttr<FInplaceIdentity>("FInplaceIdentity");
   static auto& fignore_inputs    = Op::GetAttr<FIgnoreInputs>("FIgnoreInputs");
+  static auto& fsplit_axis       = Op::GetAttr<mxnet::FSplitAxis>("FSplitAxis");
+  static const bool alias_slices = dmlc::GetEnv("MXNET_MEMORY_ALIAS_SLICES", true);
 
   // Get reference
   auto& storage               = *storage_ptr;
   auto& storage_inplace_index = *storage_inplace_index_ptr;
+  auto& storage_slice_offset  = *storage_slice_offset_ptr;
 
   // Get attributes from the graph
   const mxnet::ShapeVector& shape_vec = ret.GetAttr<mxnet::ShapeVector>("shape");
@@ -221,11 +306,59 @@ size_t MXAllocMemory(const Graph& ret,
   }
   size_t num_not_allocated = 0;
   std::vector<MXGraphAllocator::StorageID> storage_ref_count(idx.num_node_entries(), 0);
+  std::vector<std::vector<MXConcatSlices> > concat_slices;
+  if (alias_slices) {
+    concat_slices = MXPlanConcatSlices(ret, idx, node_range, storage, entry_ref_count);
+  }
 
   for (uint32_t nid = node_range.first; nid < node_range.second; ++nid) {
     const auto& inode = idx[nid];
     if (inode.source->is_variable())
       continue;
+    // allocate the outputs of the concats whose inputs are written in place from here on
+    for (const auto& slices : concat_slices[nid]) {
+      const uint32_t eid_out = idx.entry_id(slices.nid, 0);
+      const int dev_id       = (device_vec != nullptr) ? device_vec->at(slices.nid) : 0;
+      auto sid = allocator->Request(dev_id, dtype_vec[eid_out], shape_vec[eid_out], nid);
+      if (sid < 0)
+        continue;
+      storage[eid_out]       = sid;
+      storage_ref_count[sid] = entry_ref_count[eid_out];
+      for (const auto& input : slices.inputs) {
+        storage[input.first]              = sid;
+        storage_slice_offset[input.first] = input.second;
+        storage_ref_count[sid] += entry_ref_count[input.first];
+      }
+    }
+    // make the outputs of a split views of its input
+    if (alias_slices && fsplit_axis.count(inode.source->op()) != 0 && inode.inputs.size() == 1) {
+      const uint32_t eid_in = idx.entry_id(inode.inputs[0]);
+      const auto sid_in     = storage[eid_in];
+      const auto& ishape    = shape_vec[eid_in];
+      const int axis        = fsplit_axis[inode.source->op()](inode.source->attrs, ishape.ndim());
+      size_t elements       = 0;
+      for (uint32_t index = 0; index < inode.source->num_outputs(); ++index) {
+        const auto& oshape = shape_vec[idx.entry_id(nid, index)];
+        elements += mxnet::shape_is_known(oshape) ? oshape.Size() : 0;
+      }
+      // the outputs must cover the input, one after the other, on the device of the input
+      if (sid_in >= 0 && MXSlicesAreContiguous(ishape, axis) && elements == ishape.Size() &&
+          (device_vec == nullptr ||
+           device_vec->at(inode.inputs[0].node_id) == device_vec->at(nid))) {
+        int64_t offset = std::max<int64_t>(storage_slice_offset[eid_in], 0);
+        for (uint32_t index = 0; index < inode.source->num_outputs(); ++index) {
+          const uint32_t eid_out = idx.entry_id(nid, index);
+          if (storage[eid_out] == MXGraphAllocator::kBadStorageID &&
+              dtype_vec[eid_out] == dtype_vec[eid_in]) {
+            storage[eid_out]              = sid_in;
+            storage_slice_offset[eid_out] = offset;
+            // the input is kept until the last of the views is released
+            storage_ref_count[sid_in] += entry_ref_count[eid_out];
+          }
+          offset += shape_vec[eid_out].Size() * MXGetDTypeSize(dtype_vec[eid_out]);
+        }
+      }
+    }
     // check inplace option
     if (finplace_option.count(inode.source->op()) != 0) {
       auto inplace_pairs = finplace_option[inode.source->op()](inode.source->attrs);
@@ -259,8 +392,9 @@ size_t MXAllocMemory(const Graph& ret,
             (dtype_vec[eid_out] == dtype_vec[eid_in] ||
              MXGetDTypeSize(dtype_vec[eid_out]) == MXGetDTypeSize(dtype_vec[eid_in]))) {
           // inplace optimization
-          taken[kv.first]  = true;
-          storage[eid_out] = sid_in;
+          taken[kv.first]               = true;
+          storage[eid_out]              = sid_in;
+          storage_slice_offset[eid_out] = storage_slice_offset[eid_in];
           // Reuse storage for output and add ref count of output
           // to storage. This will get substracted later in free
           // input section.
@@ -386,19 +520,27 @@ Graph MXPlanMemory(Graph ret) {
     // Make a copy of related fields
     StorageVector storage_vec(storage);
     std::vector<int> storage_inplace_index(idx.num_node_entries(), -1);
+    std::vector<int64_t> storage_slice_offset(idx.num_node_entries(), -1);
 
     // the allocator
     MXGraphAllocator allocator(&idx, match_range);
 
     // number of entries that are not statically allocated.
-    size_t storage_num_not_allocated = MXAllocMemory(
-        ret, idx, node_range, &storage_vec, &storage_inplace_index, ref_count, &allocator);
+    size_t storage_num_not_allocated = MXAllocMemory(ret,
+                                                     idx,
+                                                     node_range,
+                                                     &storage_vec,
+                                                     &storage_inplace_index,
+                                                     &storage_slice_offset,
+                                                     ref_count,
+                                                     &allocator);
     size_t storage_allocated_bytes = allocator.TotalAllocBytes();
 
     // Choose the plan which leads to minimal memory usage
     if (min_allocated_bytes > storage_allocated_bytes) {
       ret.attrs["storage_id"]            = std::make_shared<any>(std::move(storage_vec));
       ret.attrs["storage_inplace_index"] = std::make_shared<any>(std::move(storage_inplace_index));
+      ret.attrs["storage_slice_offset"]  = std::make_shared<any>(std::move(storage_slice_offset));
       ret.attrs["storage_allocated_bytes"]   = std::make_shared<any>(storage_allocated_bytes);
       ret.attrs["storage_num_not_allocated"] = std::make_shared<any>(storage_num_not_allocated);
       min_allocated_bytes                    = storage_allocated_bytes;
@@ -418,7 +560,8 @@ NNVM_REGISTER_PASS(MXPlanMemory)
     .depend_graph_attr("dtype")
     .depend_graph_attr("shape")
     .provide_graph_attr("storage_id")
-    .provide_graph_attr("storage_inplace_index");
+    .provide_graph_attr("storage_inplace_index")
+    .provide_graph_attr("storage_slice_offset");
 
 }  // namespace
 }  // namespace pass
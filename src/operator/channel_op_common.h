@@ -32,6 +32,18 @@
 namespace mxnet {
 namespace op {
 
+/*!
+ * \brief Whether part already is the slice of tensor along cdim from begin, as it is when
+ *  the memory planner made the inputs of a concat or the outputs of a split share its memory.
+ */
+template <int cdim, typename xpu, int dim, typename DType>
+inline bool IsSliceInPlace(const mshadow::Tensor<xpu, dim, DType>& tensor,
+                           index_t begin,
+                           const mshadow::Tensor<xpu, dim, DType>& part) {
+  return tensor.shape_.ProdShape(0, cdim) == 1 &&
+         part.dptr_ == tensor.dptr_ + begin * tensor.shape_.ProdShape(cdim + 1, dim);
+}
+
 template <typename xpu, int dim, int cdim, typename DType>
 inline void concatenate_helper(const std::vector<mshadow::Tensor<xpu, dim, DType> >& input,
                                mshadow::Tensor<xpu, dim, DType>* output,
@@ -49,7 +61,8 @@ inline void concatenate_helper(const std::vector<mshadow::Tensor<xpu, dim, DType
       if (input[i].shape_.Size() == 0)
         continue;
       index_t end = begin + input[i].size(cdim);
-      Assign(slice<cdim>(out, begin, end), req, input[i]);
+      if (req == kAddTo || !IsSliceInPlace<cdim>(out, begin, input[i]))
+        Assign(slice<cdim>(out, begin, end), req, input[i]);
       begin = end;
     }
   } else {
@@ -88,7 +101,8 @@ void split_helper(const mshadow::Tensor<xpu, dim, DType>& input,
       if (out[i].shape_.Size() == 0)
         continue;
       index_t end = begin + out[i].size(cdim);
-      Assign(out[i], req[i], slice<cdim>(input, begin, end));
+      if (req[i] == kAddTo || !IsSliceInPlace<cdim>(input, begin, out[i]))
+        Assign(out[i], req[i], slice<cdim>(input, begin, end));
       begin = end;
     }
   } else {
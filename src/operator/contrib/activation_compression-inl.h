@@ -0,0 +1,280 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file activation_compression-inl.h
+ * \brief compressed storage of the activations kept for backward: a sign bitmask, float16, or
+ *  int8 quantized by blocks with a float32 scale per block
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_ACTIVATION_COMPRESSION_INL_H_
+#define MXNET_OPERATOR_CONTRIB_ACTIVATION_COMPRESSION_INL_H_
+
+#include <dmlc/parameter.h>
+#include <mxnet/operator_util.h>
+#include <cmath>
+#include <vector>
+#include "../mshadow_op.h"
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+
+namespace mxnet {
+namespace op {
+
+namespace actcomp {
+enum ActivationCompressionMode { kBitmask, kFloat16, kInt8 };
+enum CompressedOutputs { kData, kScale };
+/*! \brief number of elements sharing a scale in int8 mode */
+constexpr index_t kBlockSize = 256;
+}  // namespace actcomp
+
+struct CompressActivationParam : public dmlc::Parameter<CompressActivationParam> {
+  int mode;
+  DMLC_DECLARE_PARAMETER(CompressActivationParam) {
+    DMLC_DECLARE_FIELD(mode)
+        .add_enum("bitmask", actcomp::kBitmask)
+        .add_enum("float16", actcomp::kFloat16)
+        .add_enum("int8", actcomp::kInt8)
+        .describe(
+            "bitmask keeps whether each element is positive in a bit, float16 rounds the "
+            "elements to float16, int8 quantizes blocks of 256 elements to int8 with a "
+            "float32 scale each.");
+  }
+};
+
+struct DecompressActivationParam : public dmlc::Parameter<DecompressActivationParam> {
+  int mode;
+  mxnet::TShape shape;
+  int dtype;
+  DMLC_DECLARE_PARAMETER(DecompressActivationParam) {
+    DMLC_DECLARE_FIELD(mode)
+        .add_enum("bitmask", actcomp::kBitmask)
+        .add_enum("float16", actcomp::kFloat16)
+        .add_enum("int8", actcomp::kInt8)
+        .describe("Mode the data was compressed with.");
+    DMLC_DECLARE_FIELD(shape).describe("Shape of the data before compression.");
+    DMLC_DECLARE_FIELD(dtype) MXNET_ADD_ALL_TYPES.describe(
+        "Type of the data before compression.");
+  }
+};
+
+inline int CompressedArrays(int mode) {
+  return mode == actcomp::kInt8 ? 2 : 1;
+}
+
+/*! \brief bit b of mask[i] is whether data[8 * i + b] is positive */
+struct compress_bitmask {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i, uint8_t* mask, const DType* data, index_t n) {
+    uint8_t bits = 0;
+    for (index_t b = 0; b < 8 && 8 * i + b < n; ++b) {
+      bits |= static_cast<uint8_t>(data[8 * i + b] > DType(0)) << b;
+    }
+    mask[i] = bits;
+  }
+};
+
+/*! \brief 1 where the bit of the element is set, 0 elsewhere */
+struct decompress_bitmask {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i, DType* out, const uint8_t* mask) {
+    out[i] = (mask[i >> 3] >> (i & 7)) & 1 ? DType(1) : DType(0);
+  }
+};
+
+struct activation_cast {
+  template <typename OType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i, OType* out, const IType* in) {
+    out[i] = OType(static_cast<float>(in[i]));
+  }
+};
+
+/*! \brief scale of block i, its absolute maximum over 127 */
+struct quantize_block_scale {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i, float* scale, const DType* data, index_t n) {
+    const index_t end = (i + 1) * actcomp::kBlockSize < n ? (i + 1) * actcomp::kBlockSize : n;
+    float amax        = 0.0f;
+    for (index_t j = i * actcomp::kBlockSize; j < end; ++j) {
+      amax = fmaxf(amax, fabsf(static_cast<float>(data[j])));
+    }
+    scale[i] = amax / 127.0f;
+  }
+};
+
+struct quantize_block_int8 {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i, int8_t* out, const DType* data, const float* scale) {
+    const float s = scale[i / actcomp::kBlockSize];
+    const float q = s > 0.0f ? rintf(static_cast<float>(data[i]) / s) : 0.0f;
+    out[i]        = static_cast<int8_t>(fminf(fmaxf(q, -127.0f), 127.0f));
+  }
+};
+
+struct dequantize_block_int8 {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i, DType* out, const int8_t* data, const float* scale) {
+    out[i] = DType(static_cast<float>(data[i]) * scale[i / actcomp::kBlockSize]);
+  }
+};
+
+inline bool CompressActivationShape(const nnvm::NodeAttrs& attrs,
+                                    mxnet::ShapeVector* in_attrs,
+                                    mxnet::ShapeVector* out_attrs) {
+  const CompressActivationParam& param = nnvm::get<CompressActivationParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), 1U);
+  CHECK_EQ(out_attrs->size(), CompressedArrays(param.mode));
+  const mxnet::TShape& dshape = in_attrs->at(0);
+  if (!shape_is_known(dshape)) {
+    return false;
+  }
+  const index_t n = dshape.Size();
+  switch (param.mode) {
+    case actcomp::kBitmask:
+      SHAPE_ASSIGN_CHECK(*out_attrs, actcomp::kData, Shape1((n + 7) / 8));
+      break;
+    case actcomp::kFloat16:
+      SHAPE_ASSIGN_CHECK(*out_attrs, actcomp::kData, dshape);
+      break;
+    case actcomp::kInt8:
+      SHAPE_ASSIGN_CHECK(*out_attrs, actcomp::kData, dshape);
+      SHAPE_ASSIGN_CHECK(*out_attrs,
+                         actcomp::kScale,
+                         Shape1((n + actcomp::kBlockSize - 1) / actcomp::kBlockSize));
+      break;
+  }
+  return true;
+}
+
+inline bool CompressActivationType(const nnvm::NodeAttrs& attrs,
+                                   std::vector<int>* in_attrs,
+                                   std::vector<int>* out_attrs) {
+  const CompressActivationParam& param = nnvm::get<CompressActivationParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), 1U);
+  CHECK_EQ(out_attrs->size(), CompressedArrays(param.mode));
+  switch (param.mode) {
+    case actcomp::kBitmask:
+      TYPE_ASSIGN_CHECK(*out_attrs, actcomp::kData, mshadow::kUint8);
+      break;
+    case actcomp::kFloat16:
+      TYPE_ASSIGN_CHECK(*out_attrs, actcomp::kData, mshadow::kFloat16);
+      break;
+    case actcomp::kInt8:
+      TYPE_ASSIGN_CHECK(*out_attrs, actcomp::kData, mshadow::kInt8);
+      TYPE_ASSIGN_CHECK(*out_attrs, actcomp::kScale, mshadow::kFloat32);
+      break;
+  }
+  return in_attrs->at(0) != -1;
+}
+
+template <typename xpu>
+void CompressActivationForward(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const CompressActivationParam& param = nnvm::get<CompressActivationParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s              = ctx.get_stream<xpu>();
+  const TBlob& data                    = inputs[0];
+  const index_t n                      = data.shape_.Size();
+  if (req[actcomp::kData] == kNullOp) {
+    return;
+  }
+  MSHADOW_REAL_TYPE_SWITCH(data.type_flag_, DType, {
+    switch (param.mode) {
+      case actcomp::kBitmask:
+        Kernel<compress_bitmask, xpu>::Launch(
+            s, (n + 7) / 8, outputs[actcomp::kData].dptr<uint8_t>(), data.dptr<DType>(), n);
+        break;
+      case actcomp::kFloat16:
+        Kernel<activation_cast, xpu>::Launch(
+            s, n, outputs[actcomp::kData].dptr<mshadow::half::half_t>(), data.dptr<DType>());
+        break;
+      case actcomp::kInt8: {
+        float* scale = outputs[actcomp::kScale].dptr<float>();
+        Kernel<quantize_block_scale, xpu>::Launch(
+            s, outputs[actcomp::kScale].Size(), scale, data.dptr<DType>(), n);
+        Kernel<quantize_block_int8, xpu>::Launch(
+            s, n, outputs[actcomp::kData].dptr<int8_t>(), data.dptr<DType>(), scale);
+        break;
+      }
+    }
+  });
+}
+
+inline bool DecompressActivationShape(const nnvm::NodeAttrs& attrs,
+                                      mxnet::ShapeVector* in_attrs,
+                                      mxnet::ShapeVector* out_attrs) {
+  const DecompressActivationParam& param = nnvm::get<DecompressActivationParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), CompressedArrays(param.mode));
+  CHECK_EQ(out_attrs->size(), 1U);
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, param.shape);
+  return shape_is_known(param.shape);
+}
+
+inline bool DecompressActivationType(const nnvm::NodeAttrs& attrs,
+                                     std::vector<int>* in_attrs,
+                                     std::vector<int>* out_attrs) {
+  const DecompressActivationParam& param = nnvm::get<DecompressActivationParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), CompressedArrays(param.mode));
+  CHECK_EQ(out_attrs->size(), 1U);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, param.dtype);
+  return true;
+}
+
+template <typename xpu>
+void DecompressActivationForward(const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const DecompressActivationParam& param = nnvm::get<DecompressActivationParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s                = ctx.get_stream<xpu>();
+  const TBlob& out                       = outputs[0];
+  const index_t n                        = out.shape_.Size();
+  if (req[0] == kNullOp) {
+    return;
+  }
+  CHECK_EQ(req[0], kWriteTo) << "decompress_activation only supports write to its output";
+  MSHADOW_REAL_TYPE_SWITCH(out.type_flag_, DType, {
+    switch (param.mode) {
+      case actcomp::kBitmask:
+        Kernel<decompress_bitmask, xpu>::Launch(
+            s, n, out.dptr<DType>(), inputs[actcomp::kData].dptr<uint8_t>());
+        break;
+      case actcomp::kFloat16:
+        Kernel<activation_cast, xpu>::Launch(
+            s, n, out.dptr<DType>(), inputs[actcomp::kData].dptr<mshadow::half::half_t>());
+        break;
+      case actcomp::kInt8:
+        Kernel<dequantize_block_int8, xpu>::Launch(s,
+                                                   n,
+                                                   out.dptr<DType>(),
+                                                   inputs[actcomp::kData].dptr<int8_t>(),
+                                                   inputs[actcomp::kScale].dptr<float>());
+        break;
+    }
+  });
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_ACTIVATION_COMPRESSION_INL_H_
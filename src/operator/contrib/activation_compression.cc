@@ -0,0 +1,89 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file activation_compression.cc
+ * \brief compressed storage of the activations kept for backward, CPU implementation
+ */
+#include "./activation_compression-inl.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(CompressActivationParam);
+DMLC_REGISTER_PARAMETER(DecompressActivationParam);
+
+NNVM_REGISTER_OP(_contrib_compress_activation)
+    .describe(R"code(Compress an activation kept for backward, see decompress_activation.
+
+With ``mode='bitmask'``, returns a uint8 array of ``ceil(size / 8)`` bytes whose bits tell which
+elements are positive, all that the backward of ReLU reads from its output. With
+``mode='float16'``, returns the data rounded to float16. With ``mode='int8'``, returns the data
+quantized to int8 by blocks of 256 elements, and the float32 scale of each block, its absolute
+maximum over 127.
+
+CachedOp inserts this operator after forward for the ``compress_activations`` flag.
+)code" ADD_FILELINE)
+    .set_attr_parser(ParamParser<CompressActivationParam>)
+    .set_num_inputs(1)
+    .set_num_outputs([](const NodeAttrs& attrs) {
+      return CompressedArrays(nnvm::get<CompressActivationParam>(attrs.parsed).mode);
+    })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        const int mode =
+                                            nnvm::get<CompressActivationParam>(attrs.parsed).mode;
+                                        return mode == actcomp::kInt8 ?
+                                                   std::vector<std::string>{"data", "scale"} :
+                                                   std::vector<std::string>{"data"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape", CompressActivationShape)
+    .set_attr<nnvm::FInferType>("FInferType", CompressActivationType)
+    .set_attr<FCompute>("FCompute<cpu>", CompressActivationForward<cpu>)
+    .add_argument("data", "NDArray-or-Symbol", "Activation to compress.")
+    .add_arguments(CompressActivationParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_decompress_activation)
+    .describe(R"code(Restore an activation compressed by compress_activation.
+
+A bitmask is restored as 1 for the positive elements and 0 for the others, float16 and int8
+data as their nearest values in the original type.
+)code" ADD_FILELINE)
+    .set_attr_parser(ParamParser<DecompressActivationParam>)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      return CompressedArrays(nnvm::get<DecompressActivationParam>(attrs.parsed).mode);
+    })
+    .set_num_outputs(1)
+    .set_attr<mxnet::FInferShape>("FInferShape", DecompressActivationShape)
+    .set_attr<nnvm::FInferType>("FInferType", DecompressActivationType)
+    .set_attr<FCompute>("FCompute<cpu>", DecompressActivationForward<cpu>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       const int mode =
+                                           nnvm::get<DecompressActivationParam>(attrs.parsed).mode;
+                                       return mode == actcomp::kInt8 ?
+                                                  std::vector<std::string>{"data", "scale"} :
+                                                  std::vector<std::string>{"data"};
+                                     })
+    .add_argument("data", "NDArray-or-Symbol", "Compressed data.")
+    .add_argument("scale", "NDArray-or-Symbol", "Scales of the blocks, in int8 mode only.")
+    .add_arguments(DecompressActivationParam::__FIELDS__());
+
+}  // namespace op
+}  // namespace mxnet
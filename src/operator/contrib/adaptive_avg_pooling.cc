@@ -130,10 +130,43 @@ static void SpatialAdaptiveAveragePooling_updateGradInput_frame(real* gradInput_
   }
 }
 
+/*!
+ * \brief Whether the output size divides the input size, so that the windows of the adaptive
+ *  pooling have one size and move by it: a regular average pooling without padding.
+ * \param kernel the kernel and the stride of that pooling.
+ */
+static bool AdaptivePoolIsUniform(const mxnet::TShape& ishape,
+                                  const mxnet::TShape& oshape,
+                                  mxnet::TShape* kernel) {
+  *kernel = mxnet::TShape(2, 0);
+  for (int i = 0; i < 2; ++i) {
+    if (oshape[i + 2] == 0 || ishape[i + 2] % oshape[i + 2] != 0)
+      return false;
+    (*kernel)[i] = ishape[i + 2] / oshape[i + 2];
+  }
+  return true;
+}
+
 template <typename xpu, typename DType, typename AccReal>
 void AdaptiveAvgPoolUpdateOutput(mshadow::Stream<cpu>* s,
                                  const std::vector<TBlob>& input,
                                  const std::vector<TBlob>& output) {
+  mxnet::TShape kernel;
+  if (AdaptivePoolIsUniform(input[0].shape_, output[0].shape_, &kernel)) {
+    pool<DType, 1>(s,
+                   input[0].dptr<DType>(),
+                   input[0].shape_,
+                   output[0].shape_,
+                   kernel,
+                   mxnet::TShape(2, 0),
+                   kernel,
+                   pool_enum::kAvgPooling,
+                   kWriteTo,
+                   output[0].dptr<DType>(),
+                   true,
+                   mshadow::kNCHW);
+    return;
+  }
   Tensor<xpu, 4, DType> itensor = input[0].get<xpu, 4, DType>(s);
   Tensor<xpu, 4, DType> otensor = output[0].get<xpu, 4, DType>(s);
 
@@ -265,6 +298,26 @@ template <typename xpu, typename DType, typename AccReal>
 void AdaptiveAvgPoolUpdateGradInput(mshadow::Stream<cpu>* s,
                                     const std::vector<TBlob>& input,
                                     const std::vector<TBlob>& output) {
+  mxnet::TShape kernel;
+  if (AdaptivePoolIsUniform(output[0].shape_, input[0].shape_, &kernel)) {
+    // the gradient was zeroed unless it is added to; the average pooling doesn't read the data,
+    // which the gradients stand in for
+    unpool<DType, 1>(s,
+                     input[0].dptr<DType>(),
+                     output[0].dptr<DType>(),
+                     input[0].dptr<DType>(),
+                     output[0].shape_,
+                     input[0].shape_,
+                     kernel,
+                     mxnet::TShape(2, 0),
+                     kernel,
+                     pool_enum::kAvgPooling,
+                     kAddTo,
+                     output[0].dptr<DType>(),
+                     true,
+                     mshadow::kNCHW);
+    return;
+  }
   Tensor<xpu, 4, DType> gradOut = input[0].get<xpu, 4, DType>(s);
   Tensor<xpu, 4, DType> gradIn  = output[0].get<xpu, 4, DType>(s);
 
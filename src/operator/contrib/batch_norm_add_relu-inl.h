@@ -0,0 +1,189 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file batch_norm_add_relu-inl.h
+ * \brief Batch normalization followed by the addition of a residual and a ReLU
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_BATCH_NORM_ADD_RELU_INL_H_
+#define MXNET_OPERATOR_CONTRIB_BATCH_NORM_ADD_RELU_INL_H_
+
+#include <mxnet/storage.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "../mxnet_op.h"
+#include "../nn/batch_norm-inl.h"
+
+namespace mxnet {
+namespace op {
+
+namespace batchnormaddrelu {
+// the inputs are those of BatchNorm followed by the addend
+enum BatchNormAddReluInputs { kAddend = 5 };
+// the backward pass also reads the output, the outputs are the gradients of the inputs but
+// the moving statistics
+enum BatchNormAddReluGradInputs { kGradOut = 8 };
+enum BatchNormAddReluGradOutputs { kGradAddend = 3 };
+}  // namespace batchnormaddrelu
+
+/*!
+ * \brief State shared by the forward and backward passes: the node attributes, the reserve
+ *        space the fused forward pass leaves to the backward pass, and the buffer of the
+ *        gradient before the ReLU when it cannot be written to the gradient of the addend.
+ */
+struct BatchNormAddReluState {
+  nnvm::NodeAttrs attrs;
+  Storage::Handle reserve;
+  Storage::Handle dsum;
+  bool fused = false;
+
+  explicit BatchNormAddReluState(const nnvm::NodeAttrs& attrs) : attrs(attrs) {}
+
+  ~BatchNormAddReluState() {
+    if (reserve.dptr)
+      Storage::Get()->Free(reserve);
+    if (dsum.dptr)
+      Storage::Get()->Free(dsum);
+  }
+};
+
+/*! \brief out = max(out + addend, 0) */
+struct batch_norm_add_relu_fwd {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i, DType* out, const DType* addend) {
+    const DType sum = out[i] + addend[i];
+    out[i]          = sum > DType(0) ? sum : DType(0);
+  }
+};
+
+/*! \brief gradient of the sum before the ReLU, from the gradient of the output */
+struct batch_norm_add_relu_bwd {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i, DType* dsum, const DType* dout, const DType* out) {
+    dsum[i] = out[i] > DType(0) ? dout[i] : DType(0);
+  }
+};
+
+template <typename xpu>
+void BatchNormAddReluForwardImpl(const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 6U);
+  CHECK_EQ(req[batchnorm::kOut], kWriteTo);
+  std::vector<TBlob> bn_inputs(inputs.begin(), inputs.begin() + batchnormaddrelu::kAddend);
+  BatchNormCompute<xpu>(attrs, ctx, bn_inputs, req, outputs);
+  const TBlob& out = outputs[batchnorm::kOut];
+  MSHADOW_REAL_TYPE_SWITCH(out.type_flag_, DType, {
+    Kernel<batch_norm_add_relu_fwd, xpu>::Launch(ctx.get_stream<xpu>(),
+                                                 out.Size(),
+                                                 out.dptr<DType>(),
+                                                 inputs[batchnormaddrelu::kAddend].dptr<DType>());
+  });
+}
+
+/*!
+ * \brief Backward pass from BatchNorm, dsum being the buffer of the gradient of the sum
+ *        before the ReLU, which can be the gradient of the addend when it is written.
+ */
+template <typename xpu>
+void BatchNormAddReluBackwardImpl(const nnvm::NodeAttrs& attrs,
+                                  const OpContext& ctx,
+                                  const std::vector<TBlob>& inputs,
+                                  const std::vector<OpReqType>& req,
+                                  const std::vector<TBlob>& outputs,
+                                  const TBlob& dsum) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 9U);
+  CHECK_EQ(outputs.size(), 4U);
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  const TBlob& dout       = inputs[0];
+  const TBlob& daddend    = outputs[batchnormaddrelu::kGradAddend];
+  MSHADOW_REAL_TYPE_SWITCH(dout.type_flag_, DType, {
+    Kernel<batch_norm_add_relu_bwd, xpu>::Launch(s,
+                                                 dout.Size(),
+                                                 dsum.dptr<DType>(),
+                                                 dout.dptr<DType>(),
+                                                 inputs[batchnormaddrelu::kGradOut].dptr<DType>());
+    if (dsum.dptr_ != daddend.dptr_) {
+      MXNET_ASSIGN_REQ_SWITCH(req[batchnormaddrelu::kGradAddend], Req, {
+        Kernel<op_with_req<mshadow_op::identity, Req>, xpu>::Launch(
+            s, daddend.Size(), daddend.dptr<DType>(), dsum.dptr<DType>());
+      });
+    }
+  });
+  std::vector<TBlob> bn_inputs(inputs.begin(), inputs.begin() + batchnormaddrelu::kGradOut);
+  bn_inputs[0] = dsum;
+  BatchNormGradCompute<xpu>(attrs,
+                            ctx,
+                            bn_inputs,
+                            {req.begin(), req.begin() + batchnormaddrelu::kGradAddend},
+                            {outputs.begin(), outputs.begin() + batchnormaddrelu::kGradAddend});
+}
+
+/*! \brief buffer of the gradient of the sum before the ReLU, see BatchNormAddReluBackwardImpl */
+inline TBlob BatchNormAddReluGradSum(BatchNormAddReluState* state,
+                                     const OpContext& ctx,
+                                     const std::vector<OpReqType>& req,
+                                     const std::vector<TBlob>& outputs) {
+  const TBlob& daddend = outputs[batchnormaddrelu::kGradAddend];
+  if (req[batchnormaddrelu::kGradAddend] == kWriteTo)
+    return daddend;
+  const size_t bytes = daddend.Size() * mshadow::mshadow_sizeof(daddend.type_flag_);
+  if (state->dsum.size < bytes) {
+    if (state->dsum.dptr)
+      Storage::Get()->Free(state->dsum);
+    state->dsum = Storage::Get()->Alloc(bytes, ctx.run_ctx.ctx);
+  }
+  return TBlob(state->dsum.dptr,
+               daddend.shape_,
+               daddend.dev_mask(),
+               daddend.type_flag_,
+               daddend.dev_id());
+}
+
+template <typename xpu>
+void BatchNormAddReluForward(const OpStatePtr& state_ptr,
+                             const OpContext& ctx,
+                             const std::vector<TBlob>& inputs,
+                             const std::vector<OpReqType>& req,
+                             const std::vector<TBlob>& outputs) {
+  auto& state = state_ptr.get_state<BatchNormAddReluState>();
+  state.fused = false;
+  BatchNormAddReluForwardImpl<xpu>(state.attrs, ctx, inputs, req, outputs);
+}
+
+template <typename xpu>
+void BatchNormAddReluBackward(const OpStatePtr& state_ptr,
+                              const OpContext& ctx,
+                              const std::vector<TBlob>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<TBlob>& outputs) {
+  auto& state = state_ptr.get_state<BatchNormAddReluState>();
+  BatchNormAddReluBackwardImpl<xpu>(
+      state.attrs, ctx, inputs, req, outputs, BatchNormAddReluGradSum(&state, ctx, req, outputs));
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_BATCH_NORM_ADD_RELU_INL_H_
@@ -0,0 +1,167 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file batch_norm_add_relu.cc
+ * \brief Batch normalization followed by the addition of a residual and a ReLU
+ */
+#include "./batch_norm_add_relu-inl.h"
+
+namespace mxnet {
+namespace op {
+
+static bool BatchNormAddReluShape(const nnvm::NodeAttrs& attrs,
+                                  mxnet::ShapeVector* in_shape,
+                                  mxnet::ShapeVector* out_shape) {
+  static auto& finfer_shape = Op::GetAttr<mxnet::FInferShape>("FInferShape");
+  CHECK_EQ(in_shape->size(), 6U) << "Input:[data, gamma, beta, moving_mean, moving_var, addend]";
+  // the addend has the shape of the data
+  SHAPE_ASSIGN_CHECK(*in_shape, batchnormaddrelu::kAddend, in_shape->at(batchnorm::kData));
+  SHAPE_ASSIGN_CHECK(*in_shape, batchnorm::kData, in_shape->at(batchnormaddrelu::kAddend));
+  mxnet::ShapeVector bn_in(in_shape->begin(), in_shape->begin() + batchnormaddrelu::kAddend);
+  const bool ret = finfer_shape[Op::Get("BatchNorm")](attrs, &bn_in, out_shape);
+  std::copy(bn_in.begin(), bn_in.end(), in_shape->begin());
+  return ret;
+}
+
+static bool BatchNormAddReluType(const nnvm::NodeAttrs& attrs,
+                                 std::vector<int>* in_type,
+                                 std::vector<int>* out_type) {
+  static auto& finfer_type = Op::GetAttr<nnvm::FInferType>("FInferType");
+  CHECK_EQ(in_type->size(), 6U);
+  TYPE_ASSIGN_CHECK(*in_type, batchnormaddrelu::kAddend, in_type->at(batchnorm::kData));
+  TYPE_ASSIGN_CHECK(*in_type, batchnorm::kData, in_type->at(batchnormaddrelu::kAddend));
+  std::vector<int> bn_in(in_type->begin(), in_type->begin() + batchnormaddrelu::kAddend);
+  const bool ret = finfer_type[Op::Get("BatchNorm")](attrs, &bn_in, out_type);
+  std::copy(bn_in.begin(), bn_in.end(), in_type->begin());
+  return ret;
+}
+
+static OpStatePtr CreateBatchNormAddReluState(const nnvm::NodeAttrs& attrs,
+                                              const Context ctx,
+                                              const mxnet::ShapeVector& in_shapes,
+                                              const std::vector<int>& in_types) {
+  return OpStatePtr::Create<BatchNormAddReluState>(attrs);
+}
+
+static std::vector<nnvm::NodeEntry> BatchNormAddReluGrad(
+    const nnvm::ObjectPtr& n,
+    const std::vector<nnvm::NodeEntry>& ograds) {
+  std::vector<nnvm::NodeEntry> heads;
+  heads.reserve(9);
+  heads.emplace_back(ograds.at(0));
+  heads.emplace_back(n, batchnorm::kMean, 0);
+  heads.emplace_back(n, batchnorm::kVar, 0);
+  for (size_t i = 0; i < batchnormaddrelu::kAddend; ++i)
+    heads.emplace_back(n->inputs.at(i));
+  heads.emplace_back(n, batchnorm::kOut, 0);
+
+  nnvm::ObjectPtr gnode = nnvm::Node::Create();
+  gnode->inputs         = std::move(heads);
+  gnode->control_deps.emplace_back(n);
+  gnode->attrs      = n->attrs;
+  gnode->attrs.op   = nnvm::Op::Get("_backward_contrib_BatchNormAddRelu");
+  gnode->attrs.name = n->attrs.name + "_backward";
+  // no gradient of the moving statistics
+  nnvm::ObjectPtr ng = nnvm::Node::Create();
+  ng->attrs.op       = Op::Get("_NoGradient");
+  ng->attrs.name     = "NoGradient";
+  std::vector<nnvm::NodeEntry> in_grad;
+  in_grad.reserve(6);
+  for (uint32_t i = 0; i < 3; ++i)
+    in_grad.emplace_back(gnode, i, 0);
+  in_grad.emplace_back(ng);
+  in_grad.emplace_back(ng);
+  in_grad.emplace_back(gnode, batchnormaddrelu::kGradAddend, 0);
+  return in_grad;
+}
+
+NNVM_REGISTER_OP(_contrib_BatchNormAddRelu)
+    .describe(R"code(Batch normalization followed by the addition of ``addend`` and a ReLU::
+
+  out = relu(BatchNorm(data, gamma, beta, moving_mean, moving_var) + addend)
+
+The parameters, the auxiliary states and the outputs ``mean`` and ``var`` are those of BatchNorm,
+and ``addend`` has the shape of ``data``. This is the tail of the residual blocks of ResNets,
+which the CUDNN subgraph backend fuses from BatchNorm, add and relu nodes. On GPU the training
+passes run as one cuDNN kernel each for float16 data in NHWC layout with a multiple of 4
+channels, the other cases falling back to BatchNorm followed by a fused add and ReLU.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(6)
+    .set_num_outputs(3)
+    .set_attr_parser(ParamParser<BatchNormParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data",
+                                                                       "gamma",
+                                                                       "beta",
+                                                                       "moving_mean",
+                                                                       "moving_var",
+                                                                       "addend"};
+                                     })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output", "mean", "var"};
+                                      })
+    .set_attr<nnvm::FNumVisibleOutputs>("FNumVisibleOutputs",
+                                        [](const NodeAttrs& attrs) {
+                                          const BatchNormParam& param =
+                                              nnvm::get<BatchNormParam>(attrs.parsed);
+                                          return param.output_mean_var ? 3 : 1;
+                                        })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{3, 4};
+                                   })
+    .set_attr<mxnet::FInferShape>("FInferShape", BatchNormAddReluShape)
+    .set_attr<nnvm::FInferType>("FInferType", BatchNormAddReluType)
+    .set_attr<FCreateOpState>("FCreateOpState", CreateBatchNormAddReluState)
+    .set_attr<FStatefulCompute>("FStatefulCompute<cpu>", BatchNormAddReluForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", BatchNormAddReluGrad)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& n) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .add_argument("data", "NDArray-or-Symbol", "Input data to batch normalization")
+    .add_argument("gamma", "NDArray-or-Symbol", "gamma array")
+    .add_argument("beta", "NDArray-or-Symbol", "beta array")
+    .add_argument("moving_mean", "NDArray-or-Symbol", "running mean of input")
+    .add_argument("moving_var", "NDArray-or-Symbol", "running variance of input")
+    .add_argument("addend", "NDArray-or-Symbol", "residual added to the normalized data")
+    .add_arguments(BatchNormParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_contrib_BatchNormAddRelu)
+    .set_num_inputs(9)
+    .set_num_outputs(4)
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{6, 7};  // moving_mean, moving_var
+                                   })
+    .set_attr<bool>("TIsLayerOpBackward", true)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& n) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr_parser(ParamParser<BatchNormParam>)
+    .set_attr<FStatefulCompute>("FStatefulCompute<cpu>", BatchNormAddReluBackward<cpu>);
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,88 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file batch_norm_add_relu.cu
+ * \brief Batch normalization followed by the addition of a residual and a ReLU, fused by cuDNN
+ */
+#include "./batch_norm_add_relu-inl.h"
+#if MXNET_USE_CUDNN == 1
+#include "../nn/cudnn/cudnn_batch_norm.h"
+#endif  // MXNET_USE_CUDNN == 1
+
+namespace mxnet {
+namespace op {
+
+template <>
+void BatchNormAddReluForward<gpu>(const OpStatePtr& state_ptr,
+                                  const OpContext& ctx,
+                                  const std::vector<TBlob>& inputs,
+                                  const std::vector<OpReqType>& req,
+                                  const std::vector<TBlob>& outputs) {
+  auto& state = state_ptr.get_state<BatchNormAddReluState>();
+  state.fused = false;
+#if MXNET_USE_CUDNN == 1
+  BatchNormParam param = nnvm::get<BatchNormParam>(state.attrs.parsed);
+  const TBlob& data    = inputs[batchnorm::kData];
+  param.axis           = batchnorm::GetRealAxis(data.shape_, param.axis);
+  if (ctx.is_train && CudnnBatchNormAddReluSupports(param, data)) {
+    const size_t reserve_size = CudnnBatchNormAddReluReserveSize(param, ctx, data);
+    if (state.reserve.size < reserve_size) {
+      if (state.reserve.dptr)
+        Storage::Get()->Free(state.reserve);
+      state.reserve = Storage::Get()->Alloc(reserve_size, ctx.run_ctx.ctx);
+    }
+    CudnnBatchNormAddReluForward(
+        param, ctx, inputs, req, outputs, state.reserve.dptr, reserve_size);
+    state.fused = true;
+    return;
+  }
+#endif  // MXNET_USE_CUDNN == 1
+  BatchNormAddReluForwardImpl<gpu>(state.attrs, ctx, inputs, req, outputs);
+}
+
+template <>
+void BatchNormAddReluBackward<gpu>(const OpStatePtr& state_ptr,
+                                   const OpContext& ctx,
+                                   const std::vector<TBlob>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& outputs) {
+  auto& state = state_ptr.get_state<BatchNormAddReluState>();
+#if MXNET_USE_CUDNN == 1
+  // cuDNN writes the gradient of the addend, and reads the ReLU mask of the reserve space
+  if (state.fused && req[batchnormaddrelu::kGradAddend] == kWriteTo) {
+    BatchNormParam param = nnvm::get<BatchNormParam>(state.attrs.parsed);
+    param.axis = batchnorm::GetRealAxis(inputs[3 + batchnorm::kData].shape_, param.axis);
+    CudnnBatchNormAddReluBackward(
+        param, ctx, inputs, req, outputs, state.reserve.dptr, state.reserve.size);
+    return;
+  }
+#endif  // MXNET_USE_CUDNN == 1
+  BatchNormAddReluBackwardImpl<gpu>(
+      state.attrs, ctx, inputs, req, outputs, BatchNormAddReluGradSum(&state, ctx, req, outputs));
+}
+
+NNVM_REGISTER_OP(_contrib_BatchNormAddRelu)
+    .set_attr<FStatefulCompute>("FStatefulCompute<gpu>", BatchNormAddReluForward<gpu>);
+
+NNVM_REGISTER_OP(_backward_contrib_BatchNormAddRelu)
+    .set_attr<FStatefulCompute>("FStatefulCompute<gpu>", BatchNormAddReluBackward<gpu>);
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,429 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file bf16_optimizer-inl.h
+ * \brief Multi-tensor SGD and AdamW updates of bfloat16 weights on CPU. The update is computed
+ *  in float32 on blocks of 16 elements, converted from and to bfloat16 with AVX-512 when
+ *  available, and either kept in float32 master weights or stochastically rounded to bfloat16.
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_BF16_OPTIMIZER_INL_H_
+#define MXNET_OPERATOR_CONTRIB_BF16_OPTIMIZER_INL_H_
+
+#include <dmlc/parameter.h>
+#include <mxnet/operator_util.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../elemwise_op_common.h"
+#include "../mshadow_op.h"
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#endif  // __AVX512F__
+
+namespace mxnet {
+namespace op {
+
+struct MultiBF16SGDParam : public dmlc::Parameter<MultiBF16SGDParam> {
+  mxnet::Tuple<float> lrs;
+  mxnet::Tuple<float> wds;
+  float momentum;
+  float rescale_grad;
+  float clip_gradient;
+  bool stochastic_rounding;
+  int num_weights;
+  DMLC_DECLARE_PARAMETER(MultiBF16SGDParam) {
+    DMLC_DECLARE_FIELD(lrs).describe("Learning rates.");
+    DMLC_DECLARE_FIELD(wds).describe("Weight decay of each weight.");
+    DMLC_DECLARE_FIELD(momentum).set_default(0.0f).describe(
+        "The decay rate of momentum estimates at each epoch. If it is 0, the weights have no "
+        "momentum input.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+        .set_default(-1.0f)
+        .describe(
+            "Clip gradient to the range of [-clip_gradient, clip_gradient] "
+            "If clip_gradient <= 0, gradient clipping is turned off. "
+            "grad = max(min(grad, clip_gradient), -clip_gradient).");
+    DMLC_DECLARE_FIELD(stochastic_rounding)
+        .set_default(false)
+        .describe(
+            "If true, the updated weights are stochastically rounded to bfloat16 and the "
+            "weights have no float32 master copy input.");
+    DMLC_DECLARE_FIELD(num_weights).set_default(1).describe("Number of updated weights.");
+  }
+};
+
+struct MultiBF16AdamWParam : public dmlc::Parameter<MultiBF16AdamWParam> {
+  mxnet::Tuple<float> lrs;
+  mxnet::Tuple<float> wds;
+  mxnet::Tuple<float> etas;
+  float beta1;
+  float beta2;
+  float epsilon;
+  float rescale_grad;
+  float clip_gradient;
+  bool stochastic_rounding;
+  int num_weights;
+  DMLC_DECLARE_PARAMETER(MultiBF16AdamWParam) {
+    DMLC_DECLARE_FIELD(lrs).describe("Learning rates.");
+    DMLC_DECLARE_FIELD(wds).describe("Weight decay of each weight.");
+    DMLC_DECLARE_FIELD(etas).describe("Learning rate schedule multiplier of each weight.");
+    DMLC_DECLARE_FIELD(beta1).set_default(0.9f).describe("The decay rate for the 1st moment.");
+    DMLC_DECLARE_FIELD(beta2).set_default(0.999f).describe("The decay rate for the 2nd moment.");
+    DMLC_DECLARE_FIELD(epsilon).set_default(1e-8f).describe(
+        "A small constant for numerical stability.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+        .set_default(-1.0f)
+        .describe(
+            "Clip gradient to the range of [-clip_gradient, clip_gradient] "
+            "If clip_gradient <= 0, gradient clipping is turned off. "
+            "grad = max(min(grad, clip_gradient), -clip_gradient).");
+    DMLC_DECLARE_FIELD(stochastic_rounding)
+        .set_default(false)
+        .describe(
+            "If true, the updated weights are stochastically rounded to bfloat16 and the "
+            "weights have no float32 master copy input.");
+    DMLC_DECLARE_FIELD(num_weights).set_default(1).describe("Number of updated weights.");
+  }
+};
+
+/*! \brief number of inputs of each weight: weight, grad, float32 states and master weight */
+inline int BF16InputStride(const MultiBF16SGDParam& param) {
+  return 2 + (param.momentum != 0.0f) + !param.stochastic_rounding;
+}
+
+inline int BF16InputStride(const MultiBF16AdamWParam& param) {
+  return 4 + !param.stochastic_rounding;
+}
+
+inline int BF16NumStates(const MultiBF16SGDParam& param) {
+  return param.momentum != 0.0f;
+}
+
+inline int BF16NumStates(const MultiBF16AdamWParam& param) {
+  return 2;
+}
+
+namespace bf16 {
+
+/*! \brief block of elements converted at once, the floats of an AVX-512 register */
+const index_t kBlock = 16;
+
+/*! \brief noise of element i for the stochastic rounding, from a counter-based hash */
+inline uint32_t Noise(uint32_t seed, uint64_t i) {
+  uint64_t z = (i + seed) * 0x9E3779B97F4A7C15ULL;
+  z          = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z          = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return static_cast<uint32_t>(z ^ (z >> 31));
+}
+
+/*! \brief dst[0:n] = float(src[0:n]), n <= kBlock */
+inline void Widen(const uint16_t* src, index_t n, float* dst) {
+#if defined(__AVX512F__)
+  if (n == kBlock) {
+    const __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    _mm512_storeu_ps(dst, _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(h), 16)));
+    return;
+  }
+#endif  // __AVX512F__
+  for (index_t j = 0; j < n; ++j) {
+    const uint32_t bits = static_cast<uint32_t>(src[j]) << 16;
+    std::memcpy(dst + j, &bits, sizeof(bits));
+  }
+}
+
+inline void Widen(const float* src, index_t n, float* dst) {
+  std::memcpy(dst, src, n * sizeof(float));
+}
+
+/*!
+ * \brief dst[0:n] = bfloat16(src[0:n]), n <= kBlock, rounded to nearest even, or stochastically
+ *  with the noise of the elements [offset, offset + n) if stochastic. NaNs stay quiet NaNs.
+ */
+inline void Narrow(const float* src,
+                   index_t n,
+                   bool stochastic,
+                   uint32_t seed,
+                   uint64_t offset,
+                   uint16_t* dst) {
+  uint32_t add[kBlock];
+  for (index_t j = 0; j < n; ++j) {
+    uint32_t bits;
+    std::memcpy(&bits, src + j, sizeof(bits));
+    add[j] = stochastic ? Noise(seed, offset + j) & 0xFFFFU : 0x7FFFU + ((bits >> 16) & 1U);
+  }
+#if defined(__AVX512F__)
+  if (n == kBlock) {
+    const __m512 x = _mm512_loadu_ps(src);
+#if defined(__AVX512BF16__)
+    if (!stochastic) {
+      const __m256bh h = _mm512_cvtneps_pbh(x);
+      std::memcpy(dst, &h, sizeof(h));
+      return;
+    }
+#endif  // __AVX512BF16__
+    const __m512i bits  = _mm512_castps_si512(x);
+    const __m512i upper = _mm512_srli_epi32(bits, 16);
+    __m512i r           = _mm512_srli_epi32(
+        _mm512_add_epi32(bits, _mm512_loadu_si512(reinterpret_cast<const void*>(add))), 16);
+    const __mmask16 nan = _mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q);
+    r = _mm512_mask_mov_epi32(r, nan, _mm512_or_si512(upper, _mm512_set1_epi32(0x40)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm512_cvtepi32_epi16(r));
+    return;
+  }
+#endif  // __AVX512F__
+  for (index_t j = 0; j < n; ++j) {
+    uint32_t bits;
+    std::memcpy(&bits, src + j, sizeof(bits));
+    dst[j] = src[j] != src[j] ? static_cast<uint16_t>((bits >> 16) | 0x40U) :
+                                static_cast<uint16_t>((bits + add[j]) >> 16);
+  }
+}
+
+/*!
+ * \brief updates a bfloat16 weight of size elements by blocks of kBlock elements. The float32
+ *  weight of each block, read from weight32 if it is not null and from weight otherwise, is
+ *  updated by update(begin, n, w, g) along with the states of the elements [begin, begin + n),
+ *  then written to weight32 and rounded to out.
+ */
+template <typename GType, typename Update>
+void BlockUpdate(index_t size,
+                 const uint16_t* weight,
+                 const GType* grad,
+                 float* weight32,
+                 uint16_t* out,
+                 bool stochastic,
+                 uint32_t seed,
+                 const Update& update) {
+  const int nthreads    = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const index_t nblocks = (size + kBlock - 1) / kBlock;
+#pragma omp parallel for num_threads(nthreads)
+  for (index_t b = 0; b < nblocks; ++b) {
+    const index_t begin = b * kBlock;
+    const index_t n     = std::min(kBlock, size - begin);
+    float w[kBlock], g[kBlock];
+    if (weight32 != nullptr) {
+      Widen(weight32 + begin, n, w);
+    } else {
+      Widen(weight + begin, n, w);
+    }
+    Widen(grad + begin, n, g);
+    update(begin, n, w, g);
+    if (weight32 != nullptr) {
+      std::memcpy(weight32 + begin, w, n * sizeof(float));
+    }
+    Narrow(w, n, stochastic, seed, begin, out + begin);
+  }
+}
+
+}  // namespace bf16
+
+template <typename ParamType>
+inline bool MultiBF16Shape(const nnvm::NodeAttrs& attrs,
+                           mxnet::ShapeVector* in_attrs,
+                           mxnet::ShapeVector* out_attrs) {
+  const ParamType& param = nnvm::get<ParamType>(attrs.parsed);
+  const int stride       = BF16InputStride(param);
+  CHECK_EQ(in_attrs->size(), static_cast<size_t>(stride * param.num_weights));
+  CHECK_EQ(out_attrs->size(), static_cast<size_t>(param.num_weights));
+  CHECK_EQ(param.lrs.ndim(), param.num_weights)
+      << "Number of learning rates is inconsistent with num_weights";
+  CHECK_EQ(param.wds.ndim(), param.num_weights)
+      << "Number of weight decays is inconsistent with num_weights";
+  bool all_inferred = true;
+  for (int i = 0; i < param.num_weights; ++i) {
+    mxnet::ShapeVector in_vec(in_attrs->begin() + i * stride,
+                              in_attrs->begin() + (i + 1) * stride);
+    mxnet::ShapeVector out_vec({(*out_attrs)[i]});
+    all_inferred = ElemwiseShape<-1, 1>(attrs, &in_vec, &out_vec) && all_inferred;
+    std::copy(in_vec.begin(), in_vec.end(), in_attrs->begin() + i * stride);
+    (*out_attrs)[i] = out_vec[0];
+  }
+  return all_inferred;
+}
+
+template <typename ParamType>
+inline bool MultiBF16Type(const nnvm::NodeAttrs& attrs,
+                          std::vector<int>* in_attrs,
+                          std::vector<int>* out_attrs) {
+  const ParamType& param = nnvm::get<ParamType>(attrs.parsed);
+  const int stride       = BF16InputStride(param);
+  CHECK_EQ(in_attrs->size(), static_cast<size_t>(stride * param.num_weights));
+  CHECK_EQ(out_attrs->size(), static_cast<size_t>(param.num_weights));
+  for (int i = 0; i < param.num_weights; ++i) {
+    TYPE_ASSIGN_CHECK(*in_attrs, i * stride, mshadow::kBfloat16);
+    TYPE_ASSIGN_CHECK(*out_attrs, i, mshadow::kBfloat16);
+    const int grad_type = (*in_attrs)[i * stride + 1];
+    CHECK(grad_type == -1 || grad_type == mshadow::kBfloat16 || grad_type == mshadow::kFloat32)
+        << "Gradient " << i << " of " << attrs.op->name << " must be bfloat16 or float32";
+    // states and master weights
+    for (int j = 2; j < stride; ++j) {
+      TYPE_ASSIGN_CHECK(*in_attrs, i * stride + j, mshadow::kFloat32);
+    }
+  }
+  return true;
+}
+
+template <typename ParamType>
+inline std::vector<uint32_t> MultiBF16MutateInputs(const nnvm::NodeAttrs& attrs) {
+  const ParamType& param = nnvm::get<ParamType>(attrs.parsed);
+  const int stride       = BF16InputStride(param);
+  std::vector<uint32_t> ret;
+  for (int i = 0; i < param.num_weights; ++i) {
+    for (int j = 2; j < stride; ++j) {
+      ret.push_back(i * stride + j);
+    }
+  }
+  return ret;
+}
+
+/*!
+ * \brief updates each weight i by blocks with the functor update(i, states) returns, states
+ *  being its float32 state inputs
+ */
+template <typename ParamType, typename Update>
+void MultiBF16Update(const nnvm::NodeAttrs& attrs,
+                     const OpContext& ctx,
+                     const std::vector<TBlob>& inputs,
+                     const std::vector<OpReqType>& req,
+                     const std::vector<TBlob>& outputs,
+                     const Update& update) {
+  const ParamType& param  = nnvm::get<ParamType>(attrs.parsed);
+  const int stride        = BF16InputStride(param);
+  const int num_states    = BF16NumStates(param);
+  mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
+  const uint32_t seed =
+      param.stochastic_rounding ? ctx.requested[0].get_random<cpu, unsigned>(s)->GetRandInt() : 0;
+  for (int i = 0; i < param.num_weights; ++i) {
+    if (req[i] == kNullOp) {
+      continue;
+    }
+    CHECK_NE(req[i], kAddTo) << attrs.op->name << " does not support req kAddTo";
+    const TBlob& weight = inputs[i * stride];
+    const TBlob& grad   = inputs[i * stride + 1];
+    std::vector<float*> states;
+    for (int j = 0; j < num_states; ++j) {
+      states.push_back(inputs[i * stride + 2 + j].dptr<float>());
+    }
+    float* weight32 =
+        param.stochastic_rounding ? nullptr : inputs[i * stride + stride - 1].dptr<float>();
+    auto run = [&](auto grad_ptr) {
+      bf16::BlockUpdate(weight.Size(),
+                        reinterpret_cast<const uint16_t*>(weight.dptr_),
+                        grad_ptr,
+                        weight32,
+                        reinterpret_cast<uint16_t*>(outputs[i].dptr_),
+                        param.stochastic_rounding,
+                        bf16::Noise(seed, i),
+                        update(i, states));
+    };
+    // bfloat16 gradients are read as their bits
+    if (grad.type_flag_ == mshadow::kBfloat16) {
+      run(reinterpret_cast<const uint16_t*>(grad.dptr_));
+    } else {
+      run(grad.dptr<float>());
+    }
+  }
+}
+
+/*! \brief the SGD update of the elements of weight i, with float32 states */
+struct BF16SGDBlock {
+  const MultiBF16SGDParam& param;
+  float lr, wd;
+  float* mom;
+  void operator()(index_t begin, index_t n, float* w, const float* g) const {
+    for (index_t j = 0; j < n; ++j) {
+      float grad = param.rescale_grad * g[j];
+      if (param.clip_gradient >= 0.0f) {
+        grad = mshadow_op::clip::Map(grad, param.clip_gradient);
+      }
+      grad += wd * w[j];
+      if (mom != nullptr) {
+        mom[begin + j] = param.momentum * mom[begin + j] - lr * grad;
+        w[j] += mom[begin + j];
+      } else {
+        w[j] -= lr * grad;
+      }
+    }
+  }
+};
+
+inline void MultiBF16SGDUpdate(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  const MultiBF16SGDParam& param = nnvm::get<MultiBF16SGDParam>(attrs.parsed);
+  MultiBF16Update<MultiBF16SGDParam>(
+      attrs, ctx, inputs, req, outputs, [&](int i, const std::vector<float*>& states) {
+        return BF16SGDBlock{
+            param, param.lrs[i], param.wds[i], states.empty() ? nullptr : states[0]};
+      });
+}
+
+/*! \brief the AdamW update of the elements of weight i, with float32 moments */
+struct BF16AdamWBlock {
+  const MultiBF16AdamWParam& param;
+  float lr, wd, eta;
+  float* mean;
+  float* var;
+  void operator()(index_t begin, index_t n, float* w, const float* g) const {
+    for (index_t j = 0; j < n; ++j) {
+      float grad = param.rescale_grad * g[j];
+      if (param.clip_gradient >= 0.0f) {
+        grad = mshadow_op::clip::Map(grad, param.clip_gradient);
+      }
+      const float m   = param.beta1 * mean[begin + j] + (1.0f - param.beta1) * grad;
+      const float v   = param.beta2 * var[begin + j] + (1.0f - param.beta2) * grad * grad;
+      mean[begin + j] = m;
+      var[begin + j]  = v;
+      w[j] -= eta * (lr * m / (sqrtf(v) + param.epsilon) + wd * w[j]);
+    }
+  }
+};
+
+inline void MultiBF16AdamWUpdate(const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<TBlob>& outputs) {
+  const MultiBF16AdamWParam& param = nnvm::get<MultiBF16AdamWParam>(attrs.parsed);
+  CHECK_EQ(param.etas.ndim(), param.num_weights)
+      << "Number of learning rate schedule multipliers is inconsistent with num_weights";
+  MultiBF16Update<MultiBF16AdamWParam>(
+      attrs, ctx, inputs, req, outputs, [&](int i, const std::vector<float*>& states) {
+        return BF16AdamWBlock{
+            param, param.lrs[i], param.wds[i], param.etas[i], states[0], states[1]};
+      });
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_BF16_OPTIMIZER_INL_H_
@@ -0,0 +1,137 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file bf16_optimizer.cc
+ * \brief Multi-tensor SGD and AdamW updates of bfloat16 weights on CPU
+ */
+#include "./bf16_optimizer-inl.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(MultiBF16SGDParam);
+DMLC_REGISTER_PARAMETER(MultiBF16AdamWParam);
+
+/*! \brief names of the inputs of each weight, states being the names of its float32 states */
+template <typename ParamType>
+static std::vector<std::string> MultiBF16InputNames(const NodeAttrs& attrs,
+                                                    const std::vector<std::string>& states) {
+  const ParamType& param = nnvm::get<ParamType>(attrs.parsed);
+  std::vector<std::string> ret;
+  for (int i = 0; i < param.num_weights; ++i) {
+    const std::string index = std::to_string(i);
+    ret.push_back("weight_" + index);
+    ret.push_back("grad_" + index);
+    for (int j = 0; j < BF16NumStates(param); ++j) {
+      ret.push_back(states[j] + "_" + index);
+    }
+    if (!param.stochastic_rounding) {
+      ret.push_back("weight32_" + index);
+    }
+  }
+  return ret;
+}
+
+NNVM_REGISTER_OP(_contrib_multi_bf16_sgd_update)
+    .describe(R"code(SGD update of bfloat16 weights on CPU, with float32 momentum.
+
+The update of each weight is computed in float32 from its bfloat16 or float32 gradient::
+
+  grad = rescale_grad * gradient + wds[i] * weight
+  mom = momentum * mom - lrs[i] * grad
+  weight = weight + mom
+
+The weights are read from and written to their float32 master copies ``weight32``, and
+rounded to nearest even into the bfloat16 weights. With ``stochastic_rounding``, the weights
+have no master copies and the updates are stochastically rounded to bfloat16, which keeps
+their expectation when they are smaller than the spacing of the bfloat16 values.
+
+The inputs of each weight are its weight, gradient, momentum if momentum is not 0 and master
+weight unless stochastic_rounding. The bfloat16 values are converted with AVX-512 when the
+library is built for it.
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiBF16SGDParam& param = dmlc::get<MultiBF16SGDParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights * BF16InputStride(param));
+    })
+    .set_num_outputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiBF16SGDParam& param = dmlc::get<MultiBF16SGDParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights);
+    })
+    .set_attr_parser(ParamParser<MultiBF16SGDParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", MultiBF16Shape<MultiBF16SGDParam>)
+    .set_attr<nnvm::FInferType>("FInferType", MultiBF16Type<MultiBF16SGDParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return MultiBF16InputNames<MultiBF16SGDParam>(attrs,
+                                                                                     {"mom"});
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs", MultiBF16MutateInputs<MultiBF16SGDParam>)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kRandom};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", MultiBF16SGDUpdate)
+    .add_argument("data", "NDArray-or-Symbol[]", "Weights, gradients, momentum and master weights")
+    .add_arguments(MultiBF16SGDParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_multi_bf16_adamw_update)
+    .describe(R"code(AdamW update of bfloat16 weights on CPU, with float32 moments.
+
+The update of each weight is computed in float32 from its bfloat16 or float32 gradient::
+
+  grad = clip(rescale_grad * gradient, clip_gradient)
+  mean = beta1 * mean + (1 - beta1) * grad
+  var = beta2 * var + (1 - beta2) * grad^2
+  weight = weight - etas[i] * (lrs[i] * mean / (sqrt(var) + epsilon) + wds[i] * weight)
+
+The weights are kept in float32 master copies or stochastically rounded as in
+_contrib_multi_bf16_sgd_update. The inputs of each weight are its weight, gradient, mean, var
+and master weight unless stochastic_rounding.
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiBF16AdamWParam& param = dmlc::get<MultiBF16AdamWParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights * BF16InputStride(param));
+    })
+    .set_num_outputs([](const nnvm::NodeAttrs& attrs) {
+      const MultiBF16AdamWParam& param = dmlc::get<MultiBF16AdamWParam>(attrs.parsed);
+      return static_cast<uint32_t>(param.num_weights);
+    })
+    .set_attr_parser(ParamParser<MultiBF16AdamWParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", MultiBF16Shape<MultiBF16AdamWParam>)
+    .set_attr<nnvm::FInferType>("FInferType", MultiBF16Type<MultiBF16AdamWParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return MultiBF16InputNames<MultiBF16AdamWParam>(
+                                           attrs, {"mean", "var"});
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs", MultiBF16MutateInputs<MultiBF16AdamWParam>)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kRandom};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", MultiBF16AdamWUpdate)
+    .add_argument("data", "NDArray-or-Symbol[]", "Weights, gradients, moments and master weights")
+    .add_arguments(MultiBF16AdamWParam::__FIELDS__());
+
+}  // namespace op
+}  // namespace mxnet
@@ -65,6 +65,7 @@ struct BilinearSampleParam : public dmlc::Parameter<BilinearSampleParam> {
   dmlc::optional<float> scale_width;
   int mode;
   bool align_corners;
+  dmlc::optional<int> layout;
   DMLC_DECLARE_PARAMETER(BilinearSampleParam) {
     DMLC_DECLARE_FIELD(height).set_default(1).set_lower_bound(1).describe(
         "output height (required, but ignored if scale_height is defined or mode is not "
@@ -113,9 +114,95 @@ struct BilinearSampleParam : public dmlc::Parameter<BilinearSampleParam> {
         .describe(
             "With align_corners = True, the interpolating doesn't proportionally align the"
             "output and input pixels, and thus the output values can depend on the input size.");
+    DMLC_DECLARE_FIELD(layout)
+        .add_enum("NCHW", mshadow::kNCHW)
+        .add_enum("NHWC", mshadow::kNHWC)
+        .set_default(dmlc::optional<int>())
+        .describe("Set layout for input, like and output. Empty for default layout NCHW.");
   }
 };
 
+inline bool BilinearSampleIsNHWC(const BilinearSampleParam& param) {
+  return param.layout.has_value() && param.layout.value() == mshadow::kNHWC;
+}
+
+/*! \brief batch, channels, height and width of an NCHW or NHWC tensor */
+inline mshadow::Shape<4> BilinearSampleDims(const TBlob& data, bool nhwc) {
+  return nhwc ? mshadow::Shape4(data.size(0), data.size(3), data.size(1), data.size(2)) :
+                mshadow::Shape4(data.size(0), data.size(1), data.size(2), data.size(3));
+}
+
+/*! \brief strides of the images, channels, rows and columns of an NCHW or NHWC tensor */
+struct BilinearSampleStrides {
+  index_t n;
+  index_t c;
+  index_t h;
+  index_t w;
+  BilinearSampleStrides(const mshadow::Shape<4>& dims, bool nhwc)
+      : n(dims[1] * dims[2] * dims[3]), c(nhwc ? 1 : dims[2] * dims[3]),
+        h(nhwc ? dims[3] * dims[1] : dims[3]), w(nhwc ? dims[1] : 1) {}
+};
+
+/*!
+ * \brief The input neighbours of an output row or column: the first one, the offset to the
+ *        second one and the weight of the second one.
+ */
+template <typename AccReal>
+MSHADOW_XINLINE void BilinearSource(AccReal scale,
+                                    int dst_index,
+                                    int input_size,
+                                    bool align_corners,
+                                    int* src_index,
+                                    int* offset,
+                                    AccReal* lambda) {
+  AccReal src = align_corners ? scale * dst_index :
+                                scale * (dst_index + AccReal(0.5)) - AccReal(0.5);
+  src         = src < AccReal(0) ? AccReal(0) : src;
+  *src_index  = static_cast<int>(src);
+  *offset     = *src_index < input_size - 1 ? 1 : 0;
+  *lambda     = src - *src_index;
+}
+
+/*! \brief weight of input index src_index in output index dst_index of a bilinear resize */
+template <typename AccReal>
+MSHADOW_XINLINE AccReal BilinearWeight(AccReal scale,
+                                       int dst_index,
+                                       int src_index,
+                                       int input_size,
+                                       bool align_corners) {
+  int first, offset;
+  AccReal lambda;
+  BilinearSource(scale, dst_index, input_size, align_corners, &first, &offset, &lambda);
+  return (first == src_index ? AccReal(1) - lambda : AccReal(0)) +
+         (first + offset == src_index ? lambda : AccReal(0));
+}
+
+/*!
+ * \brief The outputs [*begin, *end) whose source may lie within one of input index src_index,
+ *        with a margin for rounding. The gradient of the input is gathered from them, which
+ *        unlike scattering to the inputs needs no atomics and is deterministic.
+ */
+template <typename AccReal>
+MSHADOW_XINLINE void BilinearGatherRange(AccReal scale,
+                                         int src_index,
+                                         int output_size,
+                                         bool align_corners,
+                                         int* begin,
+                                         int* end) {
+  if (scale == AccReal(0)) {
+    *begin = 0;
+    *end   = output_size;
+    return;
+  }
+  const AccReal shift = align_corners ? AccReal(0) : AccReal(0.5);
+  const AccReal low   = (src_index - 1 + shift) / scale - shift;
+  const AccReal high  = (src_index + 1 + shift) / scale - shift;
+  *begin              = low < AccReal(0) ? 0 : static_cast<int>(low) - 1;
+  *begin              = *begin < 0 ? 0 : *begin;
+  *end                = static_cast<int>(high) + 2;
+  *end                = *end > output_size ? output_size : *end;
+}
+
 template <typename DType>
 static inline DType area_pixel_compute_scale(int64_t input_size,
                                              int64_t output_size,
@@ -164,36 +251,36 @@ static inline DType area_pixel_compute_source_index(DType scale,
   }
 }
 
-static inline bool IsWriting(const OpReqType ort) {
-  return ort == kWriteTo || ort == kWriteInplace;
-}
-
 template <typename xpu, typename DType, typename AccReal>
 void SpatialUpSamplingBilinearUpdateOutput(mshadow::Stream<cpu>* s,
                                            const std::vector<TBlob>& input,
                                            const std::vector<TBlob>& output,
-                                           bool align_corners);
+                                           bool align_corners,
+                                           bool nhwc);
 
 template <typename xpu, typename DType, typename AccReal>
 void SpatialUpSamplingBilinearUpdateGradInput(mshadow::Stream<cpu>* s,
                                               const std::vector<TBlob>& input,
                                               const std::vector<TBlob>& output,
-                                              bool modeLike,
-                                              bool align_corners);
+                                              OpReqType req,
+                                              bool align_corners,
+                                              bool nhwc);
 
 #if MXNET_USE_CUDA
 template <typename xpu, typename DType, typename AccReal>
 void SpatialUpSamplingBilinearUpdateOutput(mshadow::Stream<gpu>* s,
                                            const std::vector<TBlob>& input,
                                            const std::vector<TBlob>& output,
-                                           bool align_corners);
+                                           bool align_corners,
+                                           bool nhwc);
 
 template <typename xpu, typename DType, typename AccReal>
 void SpatialUpSamplingBilinearUpdateGradInput(mshadow::Stream<gpu>* s,
                                               const std::vector<TBlob>& input,
                                               const std::vector<TBlob>& output,
-                                              bool modeLike,
-                                              bool align_corners);
+                                              OpReqType req,
+                                              bool align_corners,
+                                              bool nhwc);
 #endif  // MXNET_USE_CUDA
 
 template <typename xpu>
@@ -213,9 +300,11 @@ inline void BilinearSampleOpForward(const nnvm::NodeAttrs& attrs,
   CHECK_EQ(outputs[0].CheckContiguous(), true);
 
   bool align_corners      = param.align_corners;
+  bool nhwc               = BilinearSampleIsNHWC(param);
   mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
   MSHADOW_REAL_TYPE_SWITCH_EX(inputs[0].type_flag_, DType, AccReal, {
-    SpatialUpSamplingBilinearUpdateOutput<xpu, DType, AccReal>(s, inputs, outputs, align_corners);
+    SpatialUpSamplingBilinearUpdateOutput<xpu, DType, AccReal>(
+        s, inputs, outputs, align_corners, nhwc);
   });
 }
 
@@ -229,17 +318,20 @@ inline void BilinearSampleOpBackward(const nnvm::NodeAttrs& attrs,
   CHECK_EQ(inputs.size(), 1U);
   bool modeLike      = param.mode == bilinear_resize::like;
   bool align_corners = param.align_corners;
+  bool nhwc          = BilinearSampleIsNHWC(param);
   size_t expected    = modeLike ? 2 : 1;
   CHECK_EQ(outputs.size(), expected);
   mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
-  if (IsWriting(req[0])) {
-    // zero grad before backwarding
-    MSHADOW_TYPE_SWITCH(inputs[0].type_flag_, DType, { Fill<false>(s, outputs[0], kWriteTo, 0); })
+  if (req[0] != kNullOp) {
+    MSHADOW_REAL_TYPE_SWITCH_EX(inputs[0].type_flag_, DType, AccReal, {
+      SpatialUpSamplingBilinearUpdateGradInput<xpu, DType, AccReal>(
+          s, inputs, outputs, req[0], align_corners, nhwc);
+    });
+  }
+  if (modeLike) {
+    // the shape of like is all that the output depends on
+    MSHADOW_TYPE_SWITCH(outputs[1].type_flag_, DType, { Fill<false>(s, outputs[1], req[1], 0); })
   }
-  MSHADOW_REAL_TYPE_SWITCH_EX(inputs[0].type_flag_, DType, AccReal, {
-    SpatialUpSamplingBilinearUpdateGradInput<xpu, DType, AccReal>(
-        s, inputs, outputs, modeLike, align_corners);
-  });
 }
 
 static bool BilinearSampleOpInferShape(const nnvm::NodeAttrs& attrs,
@@ -253,57 +345,61 @@ static bool BilinearSampleOpInferShape(const nnvm::NodeAttrs& attrs,
   mxnet::TShape dshape(in_shape->at(0));
   if (mxnet::op::shape_is_none(dshape))
     return false;
+  CHECK_EQ(dshape.ndim(), 4) << "BilinearResize2D expects a 4D input, got " << dshape;
+  // the height and width axes
+  const int hax      = BilinearSampleIsNHWC(param) ? 1 : 2;
+  const int wax      = hax + 1;
   int16_t new_height = -1;
   int16_t new_width  = -1;
   switch (param.mode) {
     case bilinear_resize::simple: {
       if (param.scale_height.has_value()) {
-        new_height = static_cast<int>(param.scale_height.value() * in_shape->at(0)[2]);
+        new_height = static_cast<int>(param.scale_height.value() * in_shape->at(0)[hax]);
       } else {
         new_height = param.height;
       }
       if (param.scale_height.has_value()) {
-        new_width = static_cast<int>(param.scale_width.value() * in_shape->at(0)[3]);
+        new_width = static_cast<int>(param.scale_width.value() * in_shape->at(0)[wax]);
       } else {
         new_width = param.width;
       }
       break;
     }
     case bilinear_resize::odd_scale: {
-      new_height = ((dshape[2] % 2) == 0) ?
-                       (int16_t)(dshape[2] * param.scale_height.value()) :
-                       (int16_t)((dshape[2] - 1) * param.scale_height.value()) + 1;
-      new_width = ((dshape[3] % 2) == 0) ?
-                      (int16_t)(dshape[3] * param.scale_width.value()) :
-                      (int16_t)((dshape[3] - 1) * param.scale_width.value()) + 1;
+      new_height = ((dshape[hax] % 2) == 0) ?
+                       (int16_t)(dshape[hax] * param.scale_height.value()) :
+                       (int16_t)((dshape[hax] - 1) * param.scale_height.value()) + 1;
+      new_width = ((dshape[wax] % 2) == 0) ?
+                      (int16_t)(dshape[wax] * param.scale_width.value()) :
+                      (int16_t)((dshape[wax] - 1) * param.scale_width.value()) + 1;
       break;
     }
     case bilinear_resize::like: {
       TShape like_shape(in_shape->at(1));
       if (dshape.ndim() == 0)
         return false;
-      new_height = like_shape[2];
-      new_width  = like_shape[3];
+      new_height = like_shape[hax];
+      new_width  = like_shape[wax];
       break;
     }
     case bilinear_resize::to_even_down: {
-      new_height = ((dshape[2] % 2) == 0) ? dshape[2] : dshape[2] - 1;
-      new_width  = ((dshape[3] % 2) == 0) ? dshape[3] : dshape[3] - 1;
+      new_height = ((dshape[hax] % 2) == 0) ? dshape[hax] : dshape[hax] - 1;
+      new_width  = ((dshape[wax] % 2) == 0) ? dshape[wax] : dshape[wax] - 1;
       break;
     }
     case bilinear_resize::to_even_up: {
-      new_height = ((dshape[2] % 2) == 0) ? dshape[2] : dshape[2] + 1;
-      new_width  = ((dshape[3] % 2) == 0) ? dshape[3] : dshape[3] + 1;
+      new_height = ((dshape[hax] % 2) == 0) ? dshape[hax] : dshape[hax] + 1;
+      new_width  = ((dshape[wax] % 2) == 0) ? dshape[wax] : dshape[wax] + 1;
       break;
     }
     case bilinear_resize::to_odd_down: {
-      new_height = ((dshape[2] % 2) == 1) ? dshape[2] : dshape[2] - 1;
-      new_width  = ((dshape[3] % 2) == 1) ? dshape[3] : dshape[3] - 1;
+      new_height = ((dshape[hax] % 2) == 1) ? dshape[hax] : dshape[hax] - 1;
+      new_width  = ((dshape[wax] % 2) == 1) ? dshape[wax] : dshape[wax] - 1;
       break;
     }
     case bilinear_resize::to_odd_up: {
-      new_height = ((dshape[2] % 2) == 1) ? dshape[2] : dshape[2] + 1;
-      new_width  = ((dshape[3] % 2) == 1) ? dshape[3] : dshape[3] + 1;
+      new_height = ((dshape[hax] % 2) == 1) ? dshape[hax] : dshape[hax] + 1;
+      new_width  = ((dshape[wax] % 2) == 1) ? dshape[wax] : dshape[wax] + 1;
       break;
     }
     default: {
@@ -311,8 +407,8 @@ static bool BilinearSampleOpInferShape(const nnvm::NodeAttrs& attrs,
     }
   }
 
-  dshape[2] = new_height;
-  dshape[3] = new_width;
+  dshape[hax] = new_height;
+  dshape[wax] = new_width;
 
   out_shape->clear();
   out_shape->push_back(dshape);
@@ -33,71 +33,85 @@ template <typename xpu, typename DType, typename AccReal>
 void SpatialUpSamplingBilinearUpdateOutput(mshadow::Stream<cpu>* s,
                                            const std::vector<TBlob>& input,
                                            const std::vector<TBlob>& output,
-                                           bool align_corners) {
-  Tensor<xpu, 4, DType> itensor = input[0].get<xpu, 4, DType>(s);
-  Tensor<xpu, 4, DType> otensor = output[0].get<xpu, 4, DType>(s);
-  int nbatch                    = otensor.size(0);
-  int channels                  = otensor.size(1);
-  int outputHeight              = otensor.size(2);
-  int outputWidth               = otensor.size(3);
-  int inputHeight               = itensor.size(2);
-  int inputWidth                = itensor.size(3);
-
-  const auto nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
-
-  DType* idata                       = itensor.dptr_;
-  DType* odata                       = otensor.dptr_;
-  channels                           = nbatch * channels;
-  const int input_elems_per_channel  = inputWidth * inputHeight;
-  const int output_elems_per_channel = outputWidth * outputHeight;
+                                           bool align_corners,
+                                           bool nhwc) {
+  const mshadow::Shape<4> idims = BilinearSampleDims(input[0], nhwc);
+  const mshadow::Shape<4> odims = BilinearSampleDims(output[0], nhwc);
+  const int nbatch              = odims[0];
+  const int channels            = odims[1];
+  const int outputHeight        = odims[2];
+  const int outputWidth         = odims[3];
+  const int inputHeight         = idims[2];
+  const int inputWidth          = idims[3];
+  const DType* idata            = input[0].dptr<DType>();
+  DType* odata                  = output[0].dptr<DType>();
 
   // special case: just copy
   if (inputHeight == outputHeight && inputWidth == outputWidth) {
+    std::copy(idata, idata + input[0].Size(), odata);
+    return;
+  }
+  const BilinearSampleStrides istride(idims, nhwc);
+  const BilinearSampleStrides ostride(odims, nhwc);
+  const AccReal rheight =
+      area_pixel_compute_scale<AccReal>(inputHeight, outputHeight, align_corners);
+  const AccReal rwidth = area_pixel_compute_scale<AccReal>(inputWidth, outputWidth, align_corners);
+  const auto nthreads  = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+
 #pragma omp parallel for num_threads(nthreads)
-    for (int index = 0; index < output_elems_per_channel; index++) {
-      const int h2      = index / outputWidth;
-      const int h1      = h2;
-      const int w2      = index % outputWidth;
-      const int w1      = w2;
-      const DType* pos1 = &idata[h1 * inputWidth + w1];
-      DType* pos2       = &odata[index];
+  for (int row = 0; row < nbatch * outputHeight; ++row) {
+    const int n  = row / outputHeight;
+    const int h2 = row % outputHeight;
+    int h1, h1p;
+    AccReal h1lambda;
+    BilinearSource(rheight, h2, inputHeight, align_corners, &h1, &h1p, &h1lambda);
+    const AccReal h0lambda = AccReal(1) - h1lambda;
+    for (int w2 = 0; w2 < outputWidth; ++w2) {
+      int w1, w1p;
+      AccReal w1lambda;
+      BilinearSource(rwidth, w2, inputWidth, align_corners, &w1, &w1p, &w1lambda);
+      const AccReal w0lambda = AccReal(1) - w1lambda;
+      const DType* pos1 = idata + n * istride.n + h1 * istride.h + w1 * istride.w;
+      const DType* pos2 = pos1 + h1p * istride.h;
+      const index_t dw  = w1p * istride.w;
+      DType* out        = odata + n * ostride.n + h2 * ostride.h + w2 * ostride.w;
       for (int c = 0; c < channels; ++c) {
-        *pos2 = *pos1;
-        pos1 += input_elems_per_channel;
-        pos2 += output_elems_per_channel;
+        const index_t i = c * istride.c;
+        const AccReal val =
+            h0lambda * (w0lambda * static_cast<AccReal>(pos1[i]) +
+                        w1lambda * static_cast<AccReal>(pos1[i + dw])) +
+            h1lambda * (w0lambda * static_cast<AccReal>(pos2[i]) +
+                        w1lambda * static_cast<AccReal>(pos2[i + dw]));
+        out[c * ostride.c] = static_cast<DType>(val);
       }
     }
-    return;
   }
-  const float rheight = area_pixel_compute_scale<float>(inputHeight, outputHeight, align_corners);
-  const float rwidth  = area_pixel_compute_scale<float>(inputWidth, outputWidth, align_corners);
-
-#pragma omp parallel for num_threads(nthreads)
-  for (int index = 0; index < output_elems_per_channel; index++) {
-    const int h2 = index / outputWidth;
-    const int w2 = index % outputWidth;
-
-    const float h1r = area_pixel_compute_source_index<float>(rheight, h2, align_corners, false);
-    const int h1    = h1r;
-    const int h1p   = (h1 < inputHeight - 1) ? 1 : 0;
-    const DType h1lambda = h1r - h1;
-    const DType h0lambda = (DType)1. - h1lambda;
-
-    const float w1r      = area_pixel_compute_source_index<float>(rwidth, w2, align_corners, false);
-    const int w1         = w1r;
-    const int w1p        = (w1 < inputWidth - 1) ? 1 : 0;
-    const DType w1lambda = w1r - w1;
-    const DType w0lambda = (DType)1. - w1lambda;
-    const DType* pos1    = &idata[h1 * inputWidth + w1];
-    DType* pos2          = &odata[index];
+}
 
-    for (int c = 0; c < channels; ++c) {
-      *pos2 = h0lambda * (w0lambda * (*pos1) + w1lambda * *(pos1 + w1p)) +
-              h1lambda * (w0lambda * *(pos1 + h1p * inputWidth) +
-                          w1lambda * *(pos1 + h1p * inputWidth + w1p));
-      pos1 += input_elems_per_channel;
-      pos2 += output_elems_per_channel;
+/*!
+ * \brief The outputs of each input row or column of a bilinear resize and their weights, as
+ *        offsets into them: the outputs of input i are [(*offsets)[i], (*offsets)[i + 1]).
+ */
+template <typename AccReal>
+static void BilinearGatherTable(AccReal scale,
+                                int input_size,
+                                int output_size,
+                                bool align_corners,
+                                std::vector<int>* offsets,
+                                std::vector<int>* outputs,
+                                std::vector<AccReal>* weights) {
+  offsets->assign(1, 0);
+  for (int i = 0; i < input_size; ++i) {
+    int begin, end;
+    BilinearGatherRange(scale, i, output_size, align_corners, &begin, &end);
+    for (int o = begin; o < end; ++o) {
+      const AccReal weight = BilinearWeight(scale, o, i, input_size, align_corners);
+      if (weight != AccReal(0)) {
+        outputs->push_back(o);
+        weights->push_back(weight);
+      }
     }
+    offsets->push_back(outputs->size());
   }
 }
 
@@ -105,92 +119,52 @@ template <typename xpu, typename DType, typename AccReal>
 void SpatialUpSamplingBilinearUpdateGradInput(mshadow::Stream<cpu>* s,
                                               const std::vector<TBlob>& input,
                                               const std::vector<TBlob>& output,
-                                              bool modeLike,
-                                              bool align_corners) {
-  Tensor<xpu, 4, DType> gradOutput = input[0].get<xpu, 4, DType>(s);
-  Tensor<xpu, 4, DType> gradInput  = output[0].get<xpu, 4, DType>(s);
-
-  int nbatch       = gradInput.size(0);
-  int channels     = gradInput.size(1);
-  int outputHeight = gradOutput.size(2);
-  int outputWidth  = gradOutput.size(3);
-  int inputHeight  = gradInput.size(2);
-  int inputWidth   = gradInput.size(3);
-
+                                              OpReqType req,
+                                              bool align_corners,
+                                              bool nhwc) {
+  const mshadow::Shape<4> idims = BilinearSampleDims(output[0], nhwc);
+  const mshadow::Shape<4> odims = BilinearSampleDims(input[0], nhwc);
+  const int nbatch              = idims[0];
+  const int channels            = idims[1];
+  const int outputHeight        = odims[2];
+  const int outputWidth         = odims[3];
+  const int inputHeight         = idims[2];
+  const int inputWidth          = idims[3];
+  DType* dataInput              = output[0].dptr<DType>();
+  const DType* dataOutput       = input[0].dptr<DType>();
+
+  const BilinearSampleStrides istride(idims, nhwc);
+  const BilinearSampleStrides ostride(odims, nhwc);
+  const AccReal rheight =
+      area_pixel_compute_scale<AccReal>(inputHeight, outputHeight, align_corners);
+  const AccReal rwidth = area_pixel_compute_scale<AccReal>(inputWidth, outputWidth, align_corners);
+  std::vector<int> rows_offset, rows, cols_offset, cols;
+  std::vector<AccReal> rows_weight, cols_weight;
+  BilinearGatherTable(
+      rheight, inputHeight, outputHeight, align_corners, &rows_offset, &rows, &rows_weight);
+  BilinearGatherTable(
+      rwidth, inputWidth, outputWidth, align_corners, &cols_offset, &cols, &cols_weight);
   const auto nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
 
-  DType* dataInput                   = gradInput.dptr_;
-  DType* dataOutput                  = gradOutput.dptr_;
-  channels                           = nbatch * channels;
-  const int input_elems_per_channel  = inputWidth * inputHeight;
-  const int output_elems_per_channel = outputWidth * outputHeight;
-
-  // special case: same-size matching grids
-  if (inputHeight == outputHeight && inputWidth == outputWidth) {
+  // each input gathers the gradients of the outputs it was interpolated into
 #pragma omp parallel for num_threads(nthreads)
-    for (int index = 0; index < output_elems_per_channel; index++) {
-      const int h2      = index / outputWidth;
-      const int h1      = h2;
-      const int w2      = index % outputWidth;
-      const int w1      = w2;
-      DType* pos1       = &dataInput[h1 * inputWidth + w1];
-      const DType* pos2 = &dataOutput[index];
+  for (int row = 0; row < nbatch * inputHeight; ++row) {
+    const int n           = row / inputHeight;
+    const int h1          = row % inputHeight;
+    const DType* grad_out = dataOutput + n * ostride.n;
+    DType* grad_in        = dataInput + n * istride.n + h1 * istride.h;
+    for (int w1 = 0; w1 < inputWidth; ++w1) {
       for (int c = 0; c < channels; ++c) {
-        *pos1 += *pos2;
-        pos1 += input_elems_per_channel;
-        pos2 += output_elems_per_channel;
-      }
-    }
-    return;
-  }
-  const float rheight = area_pixel_compute_scale<float>(inputHeight, outputHeight, align_corners);
-  const float rwidth  = area_pixel_compute_scale<float>(inputWidth, outputWidth, align_corners);
-#pragma omp parallel for num_threads(nthreads)
-  for (int index = 0; index < output_elems_per_channel; index++) {
-    const int h2 = index / outputWidth;
-    const int w2 = index % outputWidth;
-
-    const float h1r = area_pixel_compute_source_index<float>(rheight, h2, align_corners, false);
-    const int h1    = h1r;
-    const int h1p   = (h1 < inputHeight - 1) ? 1 : 0;
-    const DType h1lambda = h1r - h1;
-    const DType h0lambda = (DType)1. - h1lambda;
-
-    const float w1r      = area_pixel_compute_source_index<float>(rwidth, w2, align_corners, false);
-    const int w1         = w1r;
-    const int w1p        = (w1 < inputWidth - 1) ? 1 : 0;
-    const DType w1lambda = w1r - w1;
-    const DType w0lambda = (DType)1. - w1lambda;
-
-    DType* posInput        = &dataInput[h1 * inputWidth + w1];
-    const DType* posOutput = &dataOutput[index];
-    for (int c = 0; c < channels; ++c) {
-#pragma omp critical
-      {
-        *posInput += h0lambda * w0lambda * (*posOutput);
-        *(posInput + w1p) += h0lambda * w1lambda * (*posOutput);
-        *(posInput + h1p * inputWidth) += h1lambda * w0lambda * (*posOutput);
-        *(posInput + h1p * inputWidth + w1p) += h1lambda * w1lambda * (*posOutput);
-      }
-      posInput += input_elems_per_channel;
-      posOutput += output_elems_per_channel;
-    }
-  }
-
-  if (modeLike) {
-    Tensor<xpu, 4, DType> gradInputLike = output[1].get<xpu, 4, DType>(s);
-    int inputHeightLike                 = gradInputLike.size(2);
-    int inputWidthLike                  = gradInputLike.size(3);
-    DType* dataInputLike                = gradInputLike.dptr_;
-    int channelsLike                    = nbatch * gradInputLike.size(1);
-
-    const int inputLike_elems_per_channel = inputHeightLike * inputWidthLike;
-#pragma omp parallel for num_threads(nthreads)
-    for (int index = 0; index < inputLike_elems_per_channel; index++) {
-      DType* posInput = &dataInputLike[index];
-      for (int c = 0; c < channelsLike; ++c) {
-        *posInput = 0;
-        posInput += inputLike_elems_per_channel;
+        AccReal sum = 0;
+        for (int i = rows_offset[h1]; i < rows_offset[h1 + 1]; ++i) {
+          const DType* grad_row = grad_out + rows[i] * ostride.h + c * ostride.c;
+          AccReal row_sum       = 0;
+          for (int j = cols_offset[w1]; j < cols_offset[w1 + 1]; ++j) {
+            row_sum += cols_weight[j] * static_cast<AccReal>(grad_row[cols[j] * ostride.w]);
+          }
+          sum += rows_weight[i] * row_sum;
+        }
+        KERNEL_ASSIGN(grad_in[w1 * istride.w + c * istride.c], req, static_cast<DType>(sum));
       }
     }
   }
@@ -31,177 +31,296 @@ namespace op {
 
 using namespace mshadow;
 
-// fastSpecializedAtomicAdd adapted from Torch
-// https://github.com/pytorch/pytorch/blob/master/aten/src/ATen/native/cuda/KernelUtils.cuh
-template <
-    typename Dtype,
-    typename std::enable_if<std::is_same<mshadow::half::half_t, Dtype>::value>::type* = nullptr>
-__device__ MSHADOW_FORCE_INLINE void fastSpecializedAtomicAdd(Dtype* tensor,
-                                                              size_t index,
-                                                              const size_t numel,
-                                                              Dtype value) {
-#if ((CUDA_VERSION < 10000) || (defined(__CUDA_ARCH__) && (__CUDA_ARCH__ < 700)))
-  atomicAdd(reinterpret_cast<mshadow::half::half_t*>(tensor) + index,
-            static_cast<mshadow::half::half_t>(value));
-#else
-  bool low_bit =
-      (index % 2 == 0) && (reinterpret_cast<std::uintptr_t>(tensor) % sizeof(__half2) == 0);
+/*! \brief nvec consecutive elements of a row or pixel, loaded and stored at once */
+template <typename DType, int nvec>
+struct alignas(sizeof(DType) * nvec) BilinearVector {
+  DType val[nvec];
+};
 
-  if (low_bit && index < (numel - 1)) {
-    __half2 value2;
-    value2.x = value;
-    value2.y = __int2half_rz(0);
-    atomicAdd(reinterpret_cast<__half2*>(tensor) + index / 2, value2);
-  } else if (!low_bit && index > 0) {
-    __half2 value2;
-    value2.x = __int2half_rz(0);
-    value2.y = value;
-    atomicAdd(reinterpret_cast<__half2*>(tensor) + index / 2, value2);
-
-  } else {
-    atomicAdd(reinterpret_cast<__half*>(tensor) + index, static_cast<__half>(value));
-  }
-#endif
+/*! \brief whether the rows of the tensors can be accessed in vectors of nvec elements */
+template <int nvec, typename DType>
+inline bool BilinearCanVectorize(index_t row_size, const DType* a, const DType* b) {
+  const uintptr_t bytes = sizeof(DType) * nvec;
+  return row_size % nvec == 0 && reinterpret_cast<uintptr_t>(a) % bytes == 0 &&
+         reinterpret_cast<uintptr_t>(b) % bytes == 0;
 }
 
-template <
-    typename Dtype,
-    typename std::enable_if<!std::is_same<mshadow::half::half_t, Dtype>::value>::type* = nullptr>
-__device__ MSHADOW_FORCE_INLINE void fastSpecializedAtomicAdd(Dtype* tensor,
-                                                              size_t index,
-                                                              const size_t numel,
-                                                              Dtype value) {
-  atomicAdd(tensor + index, value);
-}
+/*!
+ * \brief Forward of NCHW: each thread interpolates nvec consecutive outputs of a row, whose
+ *        sources share the input rows, and stores them at once.
+ */
+template <int nvec>
+struct BilinearResizeNCHW {
+  template <typename DType, typename AccReal>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  int iheight,
+                                  int iwidth,
+                                  int oheight,
+                                  int owidth,
+                                  AccReal rheight,
+                                  AccReal rwidth,
+                                  bool align_corners,
+                                  const DType* idata,
+                                  DType* odata) {
+    const index_t row   = i / (owidth / nvec);
+    const int w2        = (i % (owidth / nvec)) * nvec;
+    const index_t plane = row / oheight;
+    const int h2        = row % oheight;
+    int h1, h1p;
+    AccReal h1lambda;
+    BilinearSource(rheight, h2, iheight, align_corners, &h1, &h1p, &h1lambda);
+    const AccReal h0lambda = AccReal(1) - h1lambda;
+    const DType* pos1      = idata + (plane * iheight + h1) * iwidth;
+    const DType* pos2      = pos1 + h1p * iwidth;
+    BilinearVector<DType, nvec> out;
+#pragma unroll
+    for (int j = 0; j < nvec; ++j) {
+      int w1, w1p;
+      AccReal w1lambda;
+      BilinearSource(rwidth, w2 + j, iwidth, align_corners, &w1, &w1p, &w1lambda);
+      const AccReal w0lambda = AccReal(1) - w1lambda;
+      out.val[j] = static_cast<DType>(h0lambda * (w0lambda * static_cast<AccReal>(pos1[w1]) +
+                                                  w1lambda * static_cast<AccReal>(pos1[w1 + w1p])) +
+                                      h1lambda * (w0lambda * static_cast<AccReal>(pos2[w1]) +
+                                                  w1lambda * static_cast<AccReal>(pos2[w1 + w1p])));
+    }
+    *reinterpret_cast<BilinearVector<DType, nvec>*>(odata + row * owidth + w2) = out;
+  }
+};
 
-template <class Dtype>
-__device__ MSHADOW_FORCE_INLINE void fastAtomicAdd(Dtype* tensor,
-                                                   size_t index,
-                                                   const size_t numel,
-                                                   Dtype value,
-                                                   bool fast_atomics) {
-  if (fast_atomics) {
-    fastSpecializedAtomicAdd(tensor, index, numel, value);
-  } else {
-    atomicAdd(tensor + index, value);
+/*!
+ * \brief Forward of NHWC: each thread interpolates nvec consecutive channels of an output
+ *        pixel from vectors of the four input pixels.
+ */
+template <int nvec>
+struct BilinearResizeNHWC {
+  template <typename DType, typename AccReal>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  int channels,
+                                  int iheight,
+                                  int iwidth,
+                                  int oheight,
+                                  int owidth,
+                                  AccReal rheight,
+                                  AccReal rwidth,
+                                  bool align_corners,
+                                  const DType* idata,
+                                  DType* odata) {
+    typedef BilinearVector<DType, nvec> Vector;
+    const int c         = (i % (channels / nvec)) * nvec;
+    const index_t pixel = i / (channels / nvec);
+    const int w2        = pixel % owidth;
+    const int h2        = (pixel / owidth) % oheight;
+    const index_t n     = pixel / owidth / oheight;
+    int h1, h1p, w1, w1p;
+    AccReal h1lambda, w1lambda;
+    BilinearSource(rheight, h2, iheight, align_corners, &h1, &h1p, &h1lambda);
+    BilinearSource(rwidth, w2, iwidth, align_corners, &w1, &w1p, &w1lambda);
+    const AccReal h0lambda = AccReal(1) - h1lambda;
+    const AccReal w0lambda = AccReal(1) - w1lambda;
+    const DType* pos1      = idata + ((n * iheight + h1) * iwidth + w1) * channels + c;
+    const DType* pos2      = pos1 + h1p * iwidth * channels;
+    const Vector v11       = *reinterpret_cast<const Vector*>(pos1);
+    const Vector v12       = *reinterpret_cast<const Vector*>(pos1 + w1p * channels);
+    const Vector v21       = *reinterpret_cast<const Vector*>(pos2);
+    const Vector v22       = *reinterpret_cast<const Vector*>(pos2 + w1p * channels);
+    Vector out;
+#pragma unroll
+    for (int j = 0; j < nvec; ++j) {
+      const AccReal val = h0lambda * (w0lambda * static_cast<AccReal>(v11.val[j]) +
+                                      w1lambda * static_cast<AccReal>(v12.val[j])) +
+                          h1lambda * (w0lambda * static_cast<AccReal>(v21.val[j]) +
+                                      w1lambda * static_cast<AccReal>(v22.val[j]));
+      out.val[j] = static_cast<DType>(val);
+    }
+    *reinterpret_cast<Vector*>(odata + pixel * channels + c) = out;
   }
-}
+};
 
-template <typename xpu, typename Dtype, typename Acctype>
-__global__ void like_mode_kernel_backward(const int n, Tensor<xpu, 4, Dtype> dataLike) {
-  int index           = threadIdx.x + blockIdx.x * blockDim.x;
-  const int batchsize = dataLike.size(0);
-  const int channels  = dataLike.size(1);
-  const int height    = dataLike.size(2);
-  const int width     = dataLike.size(3);
-  if (index < n) {
-    const int w = index % width;
-    const int h = index / width;
-    for (int n = 0; n < batchsize; n++) {
-      for (int c = 0; c < channels; ++c) {
-        dataLike[n][c][h][w] = 0;
+/*!
+ * \brief Backward of NCHW: each thread gathers the gradient of an input from the outputs
+ *        interpolated from it, which needs no atomics and is deterministic.
+ */
+struct BilinearResizeNCHWGrad {
+  template <typename DType, typename AccReal>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  int iheight,
+                                  int iwidth,
+                                  int oheight,
+                                  int owidth,
+                                  AccReal rheight,
+                                  AccReal rwidth,
+                                  bool align_corners,
+                                  OpReqType req,
+                                  DType* igrad,
+                                  const DType* ograd) {
+    const int w1        = i % iwidth;
+    const int h1        = (i / iwidth) % iheight;
+    const index_t plane = i / iwidth / iheight;
+    int hbegin, hend, wbegin, wend;
+    BilinearGatherRange(rheight, h1, oheight, align_corners, &hbegin, &hend);
+    BilinearGatherRange(rwidth, w1, owidth, align_corners, &wbegin, &wend);
+    AccReal sum = 0;
+    for (int h2 = hbegin; h2 < hend; ++h2) {
+      const AccReal hweight = BilinearWeight(rheight, h2, h1, iheight, align_corners);
+      if (hweight == AccReal(0))
+        continue;
+      const DType* grad_row = ograd + (plane * oheight + h2) * owidth;
+      AccReal row_sum       = 0;
+      for (int w2 = wbegin; w2 < wend; ++w2) {
+        row_sum += BilinearWeight(rwidth, w2, w1, iwidth, align_corners) *
+                   static_cast<AccReal>(grad_row[w2]);
       }
+      sum += hweight * row_sum;
     }
-    return;
+    KERNEL_ASSIGN(igrad[i], req, static_cast<DType>(sum));
   }
-}
-
-// caffe_gpu_interp2_kernel_backward adapted from Torch
-// https://github.com/pytorch/pytorch/blob/master/aten/src/ATen/native/cuda/UpSampleBilinear2d.cu
-// Backward (adjoint) operation 1 <- 2 (accumulates)
-template <typename xpu, typename Dtype, typename Acctype>
-__global__ void caffe_gpu_interp2_kernel_backward(const size_t nc,
-                                                  const int height1,
-                                                  const int width1,
-                                                  const int height2,
-                                                  const int width2,
-                                                  const Acctype rheight,
-                                                  const Acctype rwidth,
-                                                  const bool align_corners,
-                                                  Dtype* __restrict__ idata,
-                                                  const Dtype* __restrict__ odata) {
-  const size_t o_numel = nc * width2 * height2;
-  const size_t i_numel = nc * width1 * height1;
-  for (size_t index = blockDim.x * blockIdx.x + threadIdx.x; index < o_numel;
-       index += blockDim.x * gridDim.x) {
-    size_t index_temp = index;
-    const int w2      = index_temp % width2;  // 0:width2-1
-    index_temp /= width2;
-    const int h2    = index_temp % height2;  // 0:height2-1
-    const size_t nc = index_temp / height2;
-    //
-    const Acctype h1r =
-        cu_area_pixel_compute_source_index<Acctype>(rheight, h2, align_corners, false);
-    const int h1           = h1r;
-    const int h1p          = (h1 < height1 - 1) ? 1 : 0;
-    const Acctype h1lambda = h1r - h1;
-    const Acctype h0lambda = static_cast<Acctype>(1) - h1lambda;
-    //
-    const Acctype w1r =
-        cu_area_pixel_compute_source_index<Acctype>(rwidth, w2, align_corners, false);
-    const int w1           = w1r;
-    const int w1p          = (w1 < width1 - 1) ? 1 : 0;
-    const Acctype w1lambda = w1r - w1;
-    const Acctype w0lambda = static_cast<Acctype>(1) - w1lambda;
+};
 
-    const Dtype d2val = odata[index];
-    fastAtomicAdd(idata,
-                  idx(nc, height1, width1, h1, w1),
-                  i_numel,
-                  ScalarConvert<Acctype, Dtype>::to(h0lambda * w0lambda * d2val),
-                  true);
-    fastAtomicAdd(idata,
-                  idx(nc, height1, width1, h1, w1 + w1p),
-                  i_numel,
-                  ScalarConvert<Acctype, Dtype>::to(h0lambda * w1lambda * d2val),
-                  true);
-    fastAtomicAdd(idata,
-                  idx(nc, height1, width1, h1 + h1p, w1),
-                  i_numel,
-                  ScalarConvert<Acctype, Dtype>::to(h1lambda * w0lambda * d2val),
-                  true);
-    fastAtomicAdd(idata,
-                  idx(nc, height1, width1, h1 + h1p, w1 + w1p),
-                  i_numel,
-                  ScalarConvert<Acctype, Dtype>::to(h1lambda * w1lambda * d2val),
-                  true);
+/*!
+ * \brief Backward of NHWC: each thread gathers the gradients of nvec consecutive channels of
+ *        an input pixel from vectors of the outputs interpolated from it.
+ */
+template <int nvec>
+struct BilinearResizeNHWCGrad {
+  template <typename DType, typename AccReal>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  int channels,
+                                  int iheight,
+                                  int iwidth,
+                                  int oheight,
+                                  int owidth,
+                                  AccReal rheight,
+                                  AccReal rwidth,
+                                  bool align_corners,
+                                  OpReqType req,
+                                  DType* igrad,
+                                  const DType* ograd) {
+    typedef BilinearVector<DType, nvec> Vector;
+    const int c         = (i % (channels / nvec)) * nvec;
+    const index_t pixel = i / (channels / nvec);
+    const int w1        = pixel % iwidth;
+    const int h1        = (pixel / iwidth) % iheight;
+    const index_t n     = pixel / iwidth / iheight;
+    int hbegin, hend, wbegin, wend;
+    BilinearGatherRange(rheight, h1, oheight, align_corners, &hbegin, &hend);
+    BilinearGatherRange(rwidth, w1, owidth, align_corners, &wbegin, &wend);
+    AccReal sum[nvec];
+#pragma unroll
+    for (int j = 0; j < nvec; ++j)
+      sum[j] = 0;
+    for (int h2 = hbegin; h2 < hend; ++h2) {
+      const AccReal hweight = BilinearWeight(rheight, h2, h1, iheight, align_corners);
+      if (hweight == AccReal(0))
+        continue;
+      const DType* grad_row = ograd + (n * oheight + h2) * owidth * channels + c;
+      for (int w2 = wbegin; w2 < wend; ++w2) {
+        const AccReal weight = hweight * BilinearWeight(rwidth, w2, w1, iwidth, align_corners);
+        if (weight == AccReal(0))
+          continue;
+        const Vector grad = *reinterpret_cast<const Vector*>(grad_row + w2 * channels);
+#pragma unroll
+        for (int j = 0; j < nvec; ++j)
+          sum[j] += weight * static_cast<AccReal>(grad.val[j]);
+      }
+    }
+    Vector* out = reinterpret_cast<Vector*>(igrad + pixel * channels + c);
+    Vector res;
+    if (req == kAddTo)
+      res = *out;
+#pragma unroll
+    for (int j = 0; j < nvec; ++j)
+      KERNEL_ASSIGN(res.val[j], req, static_cast<DType>(sum[j]));
+    *out = res;
   }
-}
+};
 
 template <typename xpu, typename DType, typename AccReal>
 void SpatialUpSamplingBilinearUpdateOutput(mshadow::Stream<gpu>* s,
                                            const std::vector<TBlob>& input,
                                            const std::vector<TBlob>& output,
-                                           bool align_corners) {
-  Tensor<xpu, 4, DType> idata = input[0].get<xpu, 4, DType>(s);
-  Tensor<xpu, 4, DType> odata = output[0].get<xpu, 4, DType>(s);
-  int outputHeight            = odata.size(2);
-  int outputWidth             = odata.size(3);
-  int nbatch                  = idata.size(0);
-  int channels                = idata.size(1);
-  int inputHeight             = idata.size(2);
-  int inputWidth              = idata.size(3);
+                                           bool align_corners,
+                                           bool nhwc) {
+  using namespace mxnet_op;
+  const mshadow::Shape<4> idims = BilinearSampleDims(input[0], nhwc);
+  const mshadow::Shape<4> odims = BilinearSampleDims(output[0], nhwc);
+  const int channels            = odims[1];
+  const int outputHeight        = odims[2];
+  const int outputWidth         = odims[3];
+  const int inputHeight         = idims[2];
+  const int inputWidth          = idims[3];
+  const DType* idata            = input[0].dptr<DType>();
+  DType* odata                  = output[0].dptr<DType>();
+  const index_t size            = output[0].Size();
+  constexpr int nvec            = 16 / sizeof(DType);
 
+  if (inputHeight == outputHeight && inputWidth == outputWidth) {
+    CUDA_CALL(cudaMemcpyAsync(odata,
+                              idata,
+                              size * sizeof(DType),
+                              cudaMemcpyDeviceToDevice,
+                              mshadow::Stream<gpu>::GetStream(s)));
+    return;
+  }
   const AccReal rheight =
       cu_area_pixel_compute_scale<AccReal>(inputHeight, outputHeight, align_corners);
   const AccReal rwidth =
       cu_area_pixel_compute_scale<AccReal>(inputWidth, outputWidth, align_corners);
-
-  const int num_kernels = nbatch * channels * outputHeight * outputWidth;
-  const int num_threads = getNumThreads(inputHeight * inputWidth, false);
-  dim3 blocks(static_cast<int>(num_kernels / num_threads) + 1);
-  dim3 threads(num_threads);
-  cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
-  caffe_gpu_interp2_kernel<xpu, DType, AccReal><<<blocks, threads, 0, stream>>>(nbatch * channels,
-                                                                                inputHeight,
-                                                                                inputWidth,
-                                                                                outputHeight,
-                                                                                outputWidth,
-                                                                                rheight,
-                                                                                rwidth,
-                                                                                align_corners,
-                                                                                idata.dptr_,
-                                                                                odata.dptr_);
+  if (nhwc) {
+    // the four neighbours of a pixel are loaded in vectors along the channels
+    if (BilinearCanVectorize<nvec>(channels, idata, odata)) {
+      Kernel<BilinearResizeNHWC<nvec>, gpu>::Launch(s,
+                                                    size / nvec,
+                                                    channels,
+                                                    inputHeight,
+                                                    inputWidth,
+                                                    outputHeight,
+                                                    outputWidth,
+                                                    rheight,
+                                                    rwidth,
+                                                    align_corners,
+                                                    idata,
+                                                    odata);
+    } else {
+      Kernel<BilinearResizeNHWC<1>, gpu>::Launch(s,
+                                                 size,
+                                                 channels,
+                                                 inputHeight,
+                                                 inputWidth,
+                                                 outputHeight,
+                                                 outputWidth,
+                                                 rheight,
+                                                 rwidth,
+                                                 align_corners,
+                                                 idata,
+                                                 odata);
+    }
+  } else if (BilinearCanVectorize<nvec>(outputWidth, odata, odata)) {
+    // the sources of a row are not contiguous, so only its outputs are stored in vectors
+    Kernel<BilinearResizeNCHW<nvec>, gpu>::Launch(s,
+                                                  size / nvec,
+                                                  inputHeight,
+                                                  inputWidth,
+                                                  outputHeight,
+                                                  outputWidth,
+                                                  rheight,
+                                                  rwidth,
+                                                  align_corners,
+                                                  idata,
+                                                  odata);
+  } else {
+    Kernel<BilinearResizeNCHW<1>, gpu>::Launch(s,
+                                               size,
+                                               inputHeight,
+                                               inputWidth,
+                                               outputHeight,
+                                               outputWidth,
+                                               rheight,
+                                               rwidth,
+                                               align_corners,
+                                               idata,
+                                               odata);
+  }
   MSHADOW_CUDA_POST_KERNEL_CHECK(SpatialUpSamplingBilinearUpdateOutput);
 }
 
@@ -209,50 +328,68 @@ template <typename xpu, typename DType, typename AccReal>
 void SpatialUpSamplingBilinearUpdateGradInput(mshadow::Stream<gpu>* s,
                                               const std::vector<TBlob>& input,
                                               const std::vector<TBlob>& output,
-                                              bool modeLike,
-                                              bool align_corners) {
-  Tensor<xpu, 4, DType> gradOutput = input[0].get<xpu, 4, DType>(s);
-  Tensor<xpu, 4, DType> gradInput  = output[0].get<xpu, 4, DType>(s);
-  int outputHeight                 = gradOutput.size(2);
-  int outputWidth                  = gradOutput.size(3);
-  int nbatch                       = gradInput.size(0);
-  int channels                     = gradInput.size(1);
-  int inputHeight                  = gradInput.size(2);
-  int inputWidth                   = gradInput.size(3);
+                                              OpReqType req,
+                                              bool align_corners,
+                                              bool nhwc) {
+  using namespace mxnet_op;
+  const mshadow::Shape<4> idims = BilinearSampleDims(output[0], nhwc);
+  const mshadow::Shape<4> odims = BilinearSampleDims(input[0], nhwc);
+  const int channels            = idims[1];
+  const int outputHeight        = odims[2];
+  const int outputWidth         = odims[3];
+  const int inputHeight         = idims[2];
+  const int inputWidth          = idims[3];
+  DType* igrad                  = output[0].dptr<DType>();
+  const DType* ograd            = input[0].dptr<DType>();
+  const index_t size            = output[0].Size();
+  constexpr int nvec            = 16 / sizeof(DType);
 
   const AccReal rheight =
       cu_area_pixel_compute_scale<AccReal>(inputHeight, outputHeight, align_corners);
   const AccReal rwidth =
       cu_area_pixel_compute_scale<AccReal>(inputWidth, outputWidth, align_corners);
-  const int num_kernels = nbatch * channels * outputHeight * outputWidth;
-  const int num_threads = getNumThreads(inputHeight * inputWidth, false);
-  dim3 blocks(static_cast<int>(num_kernels / num_threads) + 1);
-  dim3 threads(num_threads);
-  cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
-  caffe_gpu_interp2_kernel_backward<xpu, DType, AccReal>
-      <<<blocks, threads, 0, stream>>>(nbatch * channels,
-                                       inputHeight,
-                                       inputWidth,
-                                       outputHeight,
-                                       outputWidth,
-                                       rheight,
-                                       rwidth,
-                                       align_corners,
-                                       gradInput.dptr_,
-                                       gradOutput.dptr_);
-
-  if (modeLike) {
-    Tensor<xpu, 4, DType> dataLike = output[1].get<xpu, 4, DType>(s);
-    int heightLike                 = dataLike.size(2);
-    int widthLike                  = dataLike.size(3);
-    const int num_kernels_like     = heightLike * widthLike;
-    const int num_threads_like     = getNumThreads(num_kernels_like, false);
-    dim3 blocksLike(static_cast<int>(num_kernels_like / num_threads_like) + 1);
-    dim3 threadsLike(num_threads_like);
-    like_mode_kernel_backward<xpu, DType, AccReal>
-        <<<blocksLike, threadsLike, 0, stream>>>(num_kernels_like, dataLike);
+  if (!nhwc) {
+    Kernel<BilinearResizeNCHWGrad, gpu>::Launch(s,
+                                                size,
+                                                inputHeight,
+                                                inputWidth,
+                                                outputHeight,
+                                                outputWidth,
+                                                rheight,
+                                                rwidth,
+                                                align_corners,
+                                                req,
+                                                igrad,
+                                                ograd);
+  } else if (BilinearCanVectorize<nvec>(channels, igrad, ograd)) {
+    Kernel<BilinearResizeNHWCGrad<nvec>, gpu>::Launch(s,
+                                                      size / nvec,
+                                                      channels,
+                                                      inputHeight,
+                                                      inputWidth,
+                                                      outputHeight,
+                                                      outputWidth,
+                                                      rheight,
+                                                      rwidth,
+                                                      align_corners,
+                                                      req,
+                                                      igrad,
+                                                      ograd);
+  } else {
+    Kernel<BilinearResizeNHWCGrad<1>, gpu>::Launch(s,
+                                                   size,
+                                                   channels,
+                                                   inputHeight,
+                                                   inputWidth,
+                                                   outputHeight,
+                                                   outputWidth,
+                                                   rheight,
+                                                   rwidth,
+                                                   align_corners,
+                                                   req,
+                                                   igrad,
+                                                   ograd);
   }
-
   MSHADOW_CUDA_POST_KERNEL_CHECK(SpatialUpSamplingBilinearUpdateGradInput);
 }
 
@@ -0,0 +1,314 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file bitmask_nms-inl.cuh
+ * \brief Batched non-maximum suppression of sorted boxes with 64-bit suppression masks
+ *
+ * The IoU of every pair of boxes of an image is computed once by tiles of 64x64 boxes, each
+ * box of a tile row getting a 64-bit word of the boxes of the tile column it suppresses. One
+ * block per image then walks the boxes once in order of decreasing score, keeping the boxes
+ * not suppressed yet and OR-ing their masks into the suppressed set, so that the result stays
+ * on the device without any synchronization with the host.
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_BITMASK_NMS_INL_CUH_
+#define MXNET_OPERATOR_CONTRIB_BITMASK_NMS_INL_CUH_
+
+#include <mshadow/tensor.h>
+#include <cstdint>
+#include "../mxnet_op.h"
+#include "./bounding_box-common.h"
+
+namespace mxnet {
+namespace op {
+namespace bitmask_nms {
+
+/*! \brief boxes per word of the masks, which is also the size of the tiles of the IoU */
+constexpr int kBoxesPerWord = sizeof(uint64_t) * 8;
+/*! \brief threads of the block reducing the masks of an image */
+constexpr int kReduceThreads = 256;
+/*! \brief largest suppressed set kept in shared memory by the reduction */
+constexpr size_t kMaxSharedRemoved = 48 * 1024;
+
+/*! \brief layout of the boxes of an image, sorted by decreasing score */
+struct BoxLayout {
+  /*! \brief number of values of each box */
+  index_t element_width;
+  /*! \brief position of the first of the 4 coordinates */
+  int coord_index;
+  /*! \brief position of the score, a score of -1 marking invalid boxes, or -1 if all boxes are
+   * valid */
+  int score_index;
+  /*! \brief position of the class id, or -1 to suppress boxes of any class */
+  int class_index;
+  /*! \brief added to the widths and heights of the boxes, e.g. 1 for pixel coordinates */
+  float offset;
+};
+
+inline index_t NumWords(const index_t num_boxes) {
+  return (num_boxes + kBoxesPerWord - 1) / kBoxesPerWord;
+}
+
+/*! \brief bytes of the workspace of BatchedNMS */
+inline size_t WorkspaceSize(const index_t num_batches, const index_t num_boxes) {
+  const index_t num_words = NumWords(num_boxes);
+  return (num_batches * num_boxes * num_words + num_batches * num_words) * sizeof(uint64_t);
+}
+
+template <int encode, typename DType>
+__device__ __forceinline__ void LoadCorners(const DType* box, DType* corners) {
+  if (encode == box_common_enum::kCorner) {
+#pragma unroll
+    for (int i = 0; i < 4; ++i) {
+      corners[i] = box[i];
+    }
+  } else {
+    const DType half_width  = box[2] / DType(2);
+    const DType half_height = box[3] / DType(2);
+    corners[0]              = box[0] - half_width;
+    corners[1]              = box[1] - half_height;
+    corners[2]              = box[0] + half_width;
+    corners[3]              = box[1] + half_height;
+  }
+}
+
+template <typename DType>
+__device__ __forceinline__ DType CornersArea(const DType* corners, const DType offset) {
+  const DType width  = corners[2] - corners[0] + offset;
+  const DType height = corners[3] - corners[1] + offset;
+  return width < DType(0) || height < DType(0) ? DType(0) : width * height;
+}
+
+/*!
+ * \brief Computes the suppression masks of tile (blockIdx.y, blockIdx.x) of image blockIdx.z.
+ * Word w of box i has bit k set when box i overlaps box 64 * w + k > i by more than threshold.
+ * Only the words w >= i / 64 are written, being the only ones read by the reduction.
+ */
+template <int encode, typename DType>
+__global__ __launch_bounds__(kBoxesPerWord) void MaskKernel(const DType* boxes,
+                                                            const index_t batch_stride,
+                                                            const index_t num_boxes,
+                                                            const BoxLayout layout,
+                                                            const float threshold,
+                                                            uint64_t* mask) {
+  const index_t row_word = blockIdx.y;
+  const index_t col_word = blockIdx.x;
+  if (col_word < row_word)
+    return;
+  const index_t num_words = NumWords(num_boxes);
+  boxes += blockIdx.z * batch_stride;
+  mask += blockIdx.z * num_boxes * num_words;
+  const DType offset = DType(layout.offset);
+
+  __shared__ DType col_corners[kBoxesPerWord][4];
+  __shared__ DType col_areas[kBoxesPerWord];
+  __shared__ DType col_classes[kBoxesPerWord];
+  const index_t col_start = col_word * kBoxesPerWord;
+  const int col_size      = min(num_boxes - col_start, static_cast<index_t>(kBoxesPerWord));
+  if (static_cast<int>(threadIdx.x) < col_size) {
+    const DType* box = boxes + (col_start + threadIdx.x) * layout.element_width;
+    LoadCorners<encode>(box + layout.coord_index, col_corners[threadIdx.x]);
+    col_areas[threadIdx.x] = CornersArea(col_corners[threadIdx.x], offset);
+    if (layout.class_index >= 0) {
+      col_classes[threadIdx.x] = box[layout.class_index];
+    }
+  }
+  __syncthreads();
+
+  const index_t i = row_word * kBoxesPerWord + threadIdx.x;
+  if (i >= num_boxes)
+    return;
+  const DType* box = boxes + i * layout.element_width;
+  DType corners[4];
+  LoadCorners<encode>(box + layout.coord_index, corners);
+  const DType area     = CornersArea(corners, offset);
+  const DType my_class = layout.class_index >= 0 ? box[layout.class_index] : DType(0);
+  uint64_t bits        = 0;
+  for (int k = row_word == col_word ? threadIdx.x + 1 : 0; k < col_size; ++k) {
+    if (layout.class_index >= 0 && col_classes[k] != my_class)
+      continue;
+    const DType* other = col_corners[k];
+    const DType left   = corners[0] > other[0] ? corners[0] : other[0];
+    const DType top    = corners[1] > other[1] ? corners[1] : other[1];
+    const DType right  = corners[2] < other[2] ? corners[2] : other[2];
+    const DType bottom = corners[3] < other[3] ? corners[3] : other[3];
+    const DType width  = right - left + offset;
+    const DType height = bottom - top + offset;
+    if (width <= DType(0) || height <= DType(0))
+      continue;
+    const DType intersect = width * height;
+    if (intersect > DType(threshold) * (area + col_areas[k] - intersect)) {
+      bits |= 1ULL << k;
+    }
+  }
+  mask[i * num_words + col_word] = bits;
+}
+
+/*!
+ * \brief Keeps the boxes of image blockIdx.x not suppressed by a kept box of higher score, up
+ * to max_keep of them. The indices of the kept boxes are written to keep and their number to
+ * num_kept when given, and the scores of the other boxes are set to -1 when suppress is true.
+ * The suppressed set is in shared memory unless global_removed is given.
+ */
+template <typename DType>
+__global__ __launch_bounds__(kReduceThreads) void ReduceKernel(const uint64_t* mask,
+                                                               DType* boxes,
+                                                               const index_t batch_stride,
+                                                               const index_t num_boxes,
+                                                               const BoxLayout layout,
+                                                               const bool suppress,
+                                                               const index_t max_keep,
+                                                               int* keep,
+                                                               int* num_kept,
+                                                               uint64_t* global_removed) {
+  extern __shared__ uint64_t shared_removed[];
+  __shared__ uint64_t kept_word;
+  __shared__ index_t kept_start;
+  __shared__ index_t kept_count;
+  const index_t batch     = blockIdx.x;
+  const index_t num_words = NumWords(num_boxes);
+  const int score_index   = layout.score_index;
+  mask += batch * num_boxes * num_words;
+  boxes += batch * batch_stride;
+  uint64_t* removed =
+      global_removed != nullptr ? global_removed + batch * num_words : shared_removed;
+
+  // the invalid boxes and the bits past the last box are never kept
+  for (index_t w = threadIdx.x; w < num_words; w += blockDim.x) {
+    uint64_t bits = 0;
+    for (int k = 0; k < kBoxesPerWord; ++k) {
+      const index_t i = w * kBoxesPerWord + k;
+      if (i >= num_boxes ||
+          (score_index >= 0 && boxes[i * layout.element_width + score_index] == DType(-1))) {
+        bits |= 1ULL << k;
+      }
+    }
+    removed[w] = bits;
+  }
+  if (threadIdx.x == 0) {
+    kept_count = 0;
+  }
+  __syncthreads();
+
+  for (index_t w = 0; w < num_words; ++w) {
+    if (threadIdx.x == 0) {
+      // the boxes of a word suppress each other in order, through the diagonal of the masks
+      uint64_t removed_bits = removed[w];
+      uint64_t kept         = 0;
+      index_t count         = kept_count;
+      kept_start            = count;
+      for (int k = 0; k < kBoxesPerWord && count < max_keep; ++k) {
+        if (!(removed_bits & (1ULL << k))) {
+          kept |= 1ULL << k;
+          ++count;
+          removed_bits |= mask[(w * kBoxesPerWord + k) * num_words + w];
+        }
+      }
+      kept_word  = kept;
+      kept_count = count;
+    }
+    __syncthreads();
+    const uint64_t kept = kept_word;
+    const bool done     = !suppress && kept_count >= max_keep;
+    for (index_t v = w + 1 + threadIdx.x; v < num_words; v += blockDim.x) {
+      uint64_t bits = removed[v];
+      for (uint64_t k = kept; k != 0; k &= k - 1) {
+        bits |= mask[(w * kBoxesPerWord + __ffsll(static_cast<int64_t>(k)) - 1) * num_words + v];
+      }
+      removed[v] = bits;
+    }
+    const index_t i = w * kBoxesPerWord + threadIdx.x;
+    if (threadIdx.x < kBoxesPerWord && i < num_boxes) {
+      if (kept & (1ULL << threadIdx.x)) {
+        if (keep != nullptr) {
+          const uint64_t before = kept & ((1ULL << threadIdx.x) - 1);
+          keep[batch * max_keep + kept_start + __popcll(before)] = i;
+        }
+      } else if (suppress && score_index >= 0) {
+        boxes[i * layout.element_width + score_index] = DType(-1);
+      }
+    }
+    __syncthreads();
+    if (done)
+      break;
+  }
+  if (threadIdx.x == 0 && num_kept != nullptr) {
+    num_kept[batch] = kept_count;
+  }
+}
+
+/*!
+ * \brief Non-maximum suppression of num_boxes boxes of each of num_batches images, the boxes
+ * of image b starting at boxes + b * batch_stride and being sorted by decreasing score, e.g.
+ * the top-k boxes of the image. See ReduceKernel for the outputs, keep holding max_keep
+ * indices per image. The workspace holds WorkspaceSize(num_batches, num_boxes) bytes.
+ */
+template <typename DType>
+void BatchedNMS(cudaStream_t stream,
+                DType* boxes,
+                const index_t num_batches,
+                const index_t batch_stride,
+                const index_t num_boxes,
+                const BoxLayout& layout,
+                const int in_format,
+                const float threshold,
+                const bool suppress,
+                const index_t max_keep,
+                int* keep,
+                int* num_kept,
+                void* workspace) {
+  if (num_batches == 0 || num_boxes == 0)
+    return;
+  const index_t num_words = NumWords(num_boxes);
+  CHECK_LE(num_words, 65535) << "Too many boxes for NMS: " << num_boxes;
+  CHECK_LE(num_batches, 65535) << "Too many images for NMS: " << num_batches;
+  uint64_t* mask = reinterpret_cast<uint64_t*>(workspace);
+  const dim3 tiles(num_words, num_words, num_batches);
+  if (in_format == box_common_enum::kCorner) {
+    MaskKernel<box_common_enum::kCorner><<<tiles, kBoxesPerWord, 0, stream>>>(
+        boxes, batch_stride, num_boxes, layout, threshold, mask);
+  } else {
+    MaskKernel<box_common_enum::kCenter><<<tiles, kBoxesPerWord, 0, stream>>>(
+        boxes, batch_stride, num_boxes, layout, threshold, mask);
+  }
+  MSHADOW_CUDA_POST_KERNEL_CHECK(MaskKernel);
+  const size_t removed_size = num_words * sizeof(uint64_t);
+  uint64_t* global_removed =
+      removed_size > kMaxSharedRemoved ? mask + num_batches * num_boxes * num_words : nullptr;
+  ReduceKernel<<<num_batches,
+                 kReduceThreads,
+                 global_removed == nullptr ? removed_size : 0,
+                 stream>>>(mask,
+                           boxes,
+                           batch_stride,
+                           num_boxes,
+                           layout,
+                           suppress,
+                           max_keep,
+                           keep,
+                           num_kept,
+                           global_removed);
+  MSHADOW_CUDA_POST_KERNEL_CHECK(ReduceKernel);
+}
+
+}  // namespace bitmask_nms
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_BITMASK_NMS_INL_CUH_
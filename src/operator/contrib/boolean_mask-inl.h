@@ -37,6 +37,9 @@
 #include "../tensor/init_op.h"
 #include "../mshadow_op.h"
 #include "../elemwise_op_common.h"
+#ifdef __CUDACC__
+#include <cub/cub.cuh>
+#endif
 
 namespace mxnet {
 namespace op {
@@ -104,6 +107,53 @@ struct BooleanMaskBackwardKernel {
   }
 };
 
+/*! \brief Flags the non-zero elements of a mask with 1. */
+struct MaskFlagKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(int i, int32_t* flag, const DType* mask) {
+    flag[i] = mask[i] ? 1 : 0;
+  }
+};
+
+/*! \brief Writes the number of selected elements, the last of the inclusive prefix sums. */
+struct MaskValidNumKernel {
+  MSHADOW_XINLINE static void Map(int i,
+                                  int64_t* valid_num,
+                                  const int32_t* prefix_sum,
+                                  const index_t size) {
+    valid_num[0] = size > 0 ? prefix_sum[size - 1] : 0;
+  }
+};
+
+#ifdef __CUDACC__
+/*!
+ * \brief Computes the inclusive prefix sum of the non-zero flags of mask in the temp space,
+ *  without synchronizing the stream.
+ */
+inline int32_t* MaskPrefixSumGPU(const OpContext& ctx, const TBlob& mask) {
+  using namespace mshadow;
+  Stream<gpu>* s            = ctx.get_stream<gpu>();
+  cudaStream_t stream       = Stream<gpu>::GetStream(s);
+  size_t size               = mask.shape_.Size();
+  int32_t* prefix_sum       = nullptr;
+  void* d_temp_storage      = nullptr;
+  size_t temp_storage_bytes = 0;
+  cub::DeviceScan::InclusiveSum(
+      d_temp_storage, temp_storage_bytes, prefix_sum, prefix_sum, size, stream);
+  size_t buffer_size = size * sizeof(int32_t);
+  Tensor<gpu, 1, char> workspace =
+      ctx.requested[0].get_space_typed<gpu, 1, char>(Shape1(buffer_size + temp_storage_bytes), s);
+  prefix_sum     = reinterpret_cast<int32_t*>(workspace.dptr_);
+  d_temp_storage = workspace.dptr_ + buffer_size;
+  MSHADOW_TYPE_SWITCH_WITH_BOOL(mask.type_flag_, MType, {
+    mxnet_op::Kernel<MaskFlagKernel, gpu>::Launch(s, size, prefix_sum, mask.dptr<MType>());
+  });
+  cub::DeviceScan::InclusiveSum(
+      d_temp_storage, temp_storage_bytes, prefix_sum, prefix_sum, size, stream);
+  return prefix_sum;
+}
+#endif  // __CUDACC__
+
 template <typename xpu>
 inline void BooleanMaskForward(const nnvm::NodeAttrs& attrs,
                                const OpContext& ctx,
@@ -118,6 +168,25 @@ inline void BooleanMaskBackward(const nnvm::NodeAttrs& attrs,
                                 const std::vector<OpReqType>& req,
                                 const std::vector<NDArray>& outputs);
 
+/*!
+ * \brief The padded boolean mask keeps the shape of data, the selected rows being followed by
+ *  zeros, and outputs the number of selected rows on the device, so that it does not wait for
+ *  the mask to size its output.
+ */
+template <typename xpu>
+void BooleanMaskPaddedForward(const nnvm::NodeAttrs& attrs,
+                              const OpContext& ctx,
+                              const std::vector<TBlob>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<TBlob>& outputs);
+
+template <typename xpu>
+void BooleanMaskPaddedBackward(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs);
+
 }  // namespace op
 }  // namespace mxnet
 
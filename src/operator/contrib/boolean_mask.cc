@@ -73,6 +73,34 @@ bool BooleanMaskBackStorageType(const nnvm::NodeAttrs& attrs,
   return true;
 }
 
+bool BooleanMaskPaddedShape(const nnvm::NodeAttrs& attrs,
+                            mxnet::ShapeVector* in_attrs,
+                            mxnet::ShapeVector* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 2U);
+  const BooleanMaskParam& param = nnvm::get<BooleanMaskParam>(attrs.parsed);
+  CHECK_EQ(param.axis, 0) << "Not supported yet";
+  const mxnet::TShape& data = in_attrs->at(0);
+  SHAPE_ASSIGN_CHECK(*out_attrs, 1, mxnet::TShape(1, 1));
+  if (!ndim_is_known(data))
+    return false;
+  CHECK_GE(data.ndim(), 1) << "boolean_mask_padded does not support scalar data";
+  SHAPE_ASSIGN_CHECK(*in_attrs, 1, mxnet::TShape(1, data[0]));
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, data);
+  return shape_is_known(data);
+}
+
+bool BooleanMaskPaddedType(const nnvm::NodeAttrs& attrs,
+                           std::vector<int>* in_attrs,
+                           std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 2U);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(0));
+  TYPE_ASSIGN_CHECK(*in_attrs, 0, out_attrs->at(0));
+  TYPE_ASSIGN_CHECK(*out_attrs, 1, mshadow::kInt64);
+  return in_attrs->at(0) != -1 && in_attrs->at(1) != -1;
+}
+
 struct BooleanMaskBackwardCPUWriteKernel {
   template <typename DType>
   static void Map(int i,
@@ -195,6 +223,84 @@ inline void BooleanMaskBackward<cpu>(const nnvm::NodeAttrs& attrs,
   });
 }
 
+template <>
+void BooleanMaskPaddedForward<cpu>(const nnvm::NodeAttrs& attrs,
+                                   const OpContext& ctx,
+                                   const std::vector<TBlob>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 2U);
+  const TBlob& data            = inputs[0];
+  const TBlob& idx             = inputs[1];
+  const TBlob& out             = outputs[0];
+  mshadow::Stream<cpu>* stream = ctx.get_stream<cpu>();
+  size_t idx_size              = idx.shape_[0];
+  std::vector<int32_t> prefix_sum(idx_size, 0);
+  int32_t valid_num = 0;
+  MSHADOW_TYPE_SWITCH_WITH_BOOL(idx.type_flag_, IType, {
+    const IType* idx_dptr = idx.dptr<IType>();
+    for (size_t i = 0; i < idx_size; i++) {
+      valid_num += idx_dptr[i] ? 1 : 0;
+      prefix_sum[i] = valid_num;
+    }
+  });
+  MSHADOW_TYPE_SWITCH_EXT_WITH_BOOL(data.type_flag_, DType, {
+    Kernel<set_zero, cpu>::Launch(stream, out.Size(), out.dptr<DType>());
+    if (valid_num > 0) {
+      Kernel<BooleanMaskForwardCPUKernel, cpu>::Launch(stream,
+                                                       idx_size,
+                                                       out.dptr<DType>(),
+                                                       data.dptr<DType>(),
+                                                       prefix_sum.data(),
+                                                       data.Size() / idx_size);
+    }
+  });
+  *outputs[1].dptr<int64_t>() = valid_num;
+}
+
+template <>
+void BooleanMaskPaddedBackward<cpu>(const nnvm::NodeAttrs& attrs,
+                                    const OpContext& ctx,
+                                    const std::vector<TBlob>& inputs,
+                                    const std::vector<OpReqType>& req,
+                                    const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 2U);
+  // inputs: {ograd, idx}
+  // outputs: {igrad_data, igrad_idx}
+  const TBlob& ograd           = inputs[0];
+  const TBlob& idx             = inputs[1];
+  mshadow::Stream<cpu>* stream = ctx.get_stream<cpu>();
+  if (req[1] != kNullOp) {
+    MSHADOW_TYPE_SWITCH_WITH_BOOL(outputs[1].type_flag_, IType, {
+      Kernel<set_zero, cpu>::Launch(stream, outputs[1].Size(), outputs[1].dptr<IType>());
+    });
+  }
+  size_t input_size = outputs[0].Size();
+  if (req[0] == kNullOp || input_size == 0)
+    return;
+  size_t idx_size = idx.shape_[0];
+  std::vector<int32_t> prefix_sum(idx_size, 0);
+  MSHADOW_TYPE_SWITCH_WITH_BOOL(idx.type_flag_, IType, {
+    const IType* idx_dptr = idx.dptr<IType>();
+    for (size_t i = 0; i < idx_size; i++) {
+      prefix_sum[i] = ((i == 0) ? 0 : prefix_sum[i - 1]) + (idx_dptr[i] ? 1 : 0);
+    }
+  });
+  MSHADOW_TYPE_SWITCH(outputs[0].type_flag_, DType, {
+    Kernel<BooleanMaskBackwardKernel, cpu>::Launch(stream,
+                                                   input_size,
+                                                   outputs[0].dptr<DType>(),
+                                                   req[0],
+                                                   ograd.dptr<DType>(),
+                                                   prefix_sum.data(),
+                                                   input_size / idx_size);
+  });
+}
+
 NNVM_REGISTER_OP(_contrib_boolean_mask)
     .add_alias("_npi_boolean_mask")
     .describe(R"code(
@@ -234,5 +340,65 @@ NNVM_REGISTER_OP(_backward_contrib_boolean_mask)
     .set_attr<FComputeEx>("FComputeEx<cpu>", BooleanMaskBackward<cpu>)
     .add_arguments(BooleanMaskParam::__FIELDS__());
 
+NNVM_REGISTER_OP(_contrib_boolean_mask_padded)
+    .add_alias("_npx_boolean_mask_padded")
+    .describe(R"code(
+Given an n-d NDArray data, and a 1-d NDArray index, selects the rows of data where the
+corresponding element of index is non-zero, like boolean_mask, but into an output of the
+shape of data. The selected rows are followed by zeros, and the number of selected rows is
+returned as a second output of shape (1,).
+
+Since the shapes of its outputs do not depend on the values of index, the operator does not
+wait for index to be computed, and may be hybridized with static shapes and captured in CUDA
+graphs. The following operators read the number of valid rows from the second output.
+
+>>> data = mx.nd.array([[1, 2, 3],[4, 5, 6],[7, 8, 9]])
+>>> index = mx.nd.array([0, 1, 1])
+>>> out, valid_num = mx.nd.contrib.boolean_mask_padded(data, index)
+>>> out
+
+[[4. 5. 6.]
+ [7. 8. 9.]
+ [0. 0. 0.]]
+<NDArray 3x3 @cpu(0)>
+>>> valid_num
+
+[2]
+<NDArray 1 @cpu(0)>
+
+)code" ADD_FILELINE)
+    .set_attr_parser(ParamParser<BooleanMaskParam>)
+    .set_num_inputs(2)
+    .set_num_outputs(2)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data", "index"};
+                                     })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output", "valid_num"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape", BooleanMaskPaddedShape)
+    .set_attr<nnvm::FInferType>("FInferType", BooleanMaskPaddedType)
+    .set_attr<FCompute>("FCompute<cpu>", BooleanMaskPaddedForward<cpu>)
+    .set_attr<nnvm::FGradient>(
+        "FGradient",
+        [](const nnvm::ObjectPtr& n, const std::vector<nnvm::NodeEntry>& ograds) {
+          return MakeGradNode("_backward_contrib_boolean_mask_padded",
+                              n,
+                              {ograds[0], n->inputs[1]},
+                              n->attrs.dict);
+        })
+    .add_argument("data", "NDArray-or-Symbol", "Data")
+    .add_argument("index", "NDArray-or-Symbol", "Mask")
+    .add_arguments(BooleanMaskParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_contrib_boolean_mask_padded)
+    .set_attr_parser(ParamParser<BooleanMaskParam>)
+    .set_num_inputs(2)
+    .set_num_outputs(2)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FCompute>("FCompute<cpu>", BooleanMaskPaddedBackward<cpu>);
+
 }  // namespace op
 }  // namespace mxnet
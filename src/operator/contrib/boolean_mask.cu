@@ -144,6 +144,70 @@ inline void BooleanMaskBackward<gpu>(const nnvm::NodeAttrs& attrs,
   });
 }
 
+template <>
+void BooleanMaskPaddedForward<gpu>(const nnvm::NodeAttrs& attrs,
+                                   const OpContext& ctx,
+                                   const std::vector<TBlob>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 2U);
+  const TBlob& data       = inputs[0];
+  const TBlob& idx        = inputs[1];
+  const TBlob& out        = outputs[0];
+  mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+  size_t idx_size         = idx.shape_[0];
+  // the number of selected rows stays on the device
+  const int32_t* prefix_sum = MaskPrefixSumGPU(ctx, idx);
+  MSHADOW_TYPE_SWITCH_WITH_BOOL(data.type_flag_, DType, {
+    Kernel<set_zero, gpu>::Launch(s, out.Size(), out.dptr<DType>());
+    if (data.Size() > 0) {
+      Kernel<BooleanMaskForwardKernel, gpu>::Launch(s,
+                                                    data.Size(),
+                                                    out.dptr<DType>(),
+                                                    data.dptr<DType>(),
+                                                    prefix_sum,
+                                                    data.Size() / idx_size);
+    }
+  });
+  Kernel<MaskValidNumKernel, gpu>::Launch(s, 1, outputs[1].dptr<int64_t>(), prefix_sum, idx_size);
+}
+
+template <>
+void BooleanMaskPaddedBackward<gpu>(const nnvm::NodeAttrs& attrs,
+                                    const OpContext& ctx,
+                                    const std::vector<TBlob>& inputs,
+                                    const std::vector<OpReqType>& req,
+                                    const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 2U);
+  // inputs: {ograd, idx}
+  // outputs: {igrad_data, igrad_idx}
+  const TBlob& ograd      = inputs[0];
+  const TBlob& idx        = inputs[1];
+  mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+  if (req[1] != kNullOp) {
+    MSHADOW_TYPE_SWITCH_WITH_BOOL(outputs[1].type_flag_, IType, {
+      Kernel<set_zero, gpu>::Launch(s, outputs[1].Size(), outputs[1].dptr<IType>());
+    });
+  }
+  size_t input_size = outputs[0].Size();
+  if (req[0] == kNullOp || input_size == 0)
+    return;
+  const int32_t* prefix_sum = MaskPrefixSumGPU(ctx, idx);
+  MSHADOW_TYPE_SWITCH(outputs[0].type_flag_, DType, {
+    Kernel<BooleanMaskBackwardKernel, gpu>::Launch(s,
+                                                   input_size,
+                                                   outputs[0].dptr<DType>(),
+                                                   req[0],
+                                                   ograd.dptr<DType>(),
+                                                   prefix_sum,
+                                                   input_size / idx.shape_[0]);
+  });
+}
+
 NNVM_REGISTER_OP(_contrib_boolean_mask)
     .set_attr<FResourceRequest>("FResourceRequest",
                                 [](const NodeAttrs& attrs) {
@@ -159,5 +223,19 @@ NNVM_REGISTER_OP(_backward_contrib_boolean_mask)
                                 })
     .set_attr<FComputeEx>("FComputeEx<gpu>", BooleanMaskBackward<gpu>);
 
+NNVM_REGISTER_OP(_contrib_boolean_mask_padded)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<gpu>", BooleanMaskPaddedForward<gpu>);
+
+NNVM_REGISTER_OP(_backward_contrib_boolean_mask_padded)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<gpu>", BooleanMaskPaddedBackward<gpu>);
+
 }  // namespace op
 }  // namespace mxnet
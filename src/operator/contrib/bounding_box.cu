@@ -24,6 +24,7 @@
  */
 #include <cub/cub.cuh>
 
+#include "./bitmask_nms-inl.cuh"
 #include "./bounding_box-inl.cuh"
 #include "./bounding_box-inl.h"
 #include "../elemwise_op_common.h"
@@ -560,6 +561,14 @@ __launch_bounds__(512) __global__
   }
 }
 
+// The masks of the bitmask NMS grow with the square of topk, larger ones are replaced by the
+// chunked NMS, whose scratch only grows with topk
+constexpr size_t kMaxBitmaskNMSWorkspace = 256 << 20;
+
+inline bool UseBitmaskNMS(const index_t num_batch, const index_t topk) {
+  return bitmask_nms::WorkspaceSize(num_batch, topk) <= kMaxBitmaskNMSWorkspace;
+}
+
 template <typename DType>
 TempWorkspace<DType> GetWorkspace(const index_t num_batch,
                                   const index_t num_elem,
@@ -576,9 +585,13 @@ TempWorkspace<DType> GetWorkspace(const index_t num_batch,
   WorkspaceForSort(num_elem, topk, alignment, &workspace);
   // Place for a buffer
   workspace.buffer_space = align(num_batch * num_elem * width_elem * sizeof(DType), alignment);
-  workspace.nms_scratch_space =
-      align(NMS<DType>::THRESHOLD / (sizeof(uint32_t) * 8) * num_batch * topk * sizeof(uint32_t),
-            alignment);
+  if (UseBitmaskNMS(num_batch, topk)) {
+    workspace.nms_scratch_space = align(bitmask_nms::WorkspaceSize(num_batch, topk), alignment);
+  } else {
+    workspace.nms_scratch_space = align(
+        NMS<DType>::THRESHOLD / (sizeof(uint32_t) * 8) * num_batch * topk * sizeof(uint32_t),
+        alignment);
+  }
 
   const size_t workspace_size = workspace.scores_temp_space + workspace.scratch_space +
                                 workspace.buffer_space + workspace.nms_scratch_space +
@@ -703,10 +716,6 @@ void BoxNMSForwardGPU_notemp(const nnvm::NodeAttrs& attrs,
     Tensor<gpu, 1, char> scratch(
         reinterpret_cast<char*>(workspace.scratch), Shape1(workspace.scratch_space), s);
     Tensor<gpu, 3, DType> buffer(workspace.buffer, Shape3(num_batch, num_elem, width_elem), s);
-    Tensor<gpu, 2, uint32_t> nms_scratch(
-        workspace.nms_scratch,
-        Shape2(NMS<DType>::THRESHOLD / (sizeof(uint32_t) * 8), topk * num_batch),
-        s);
     indices = mshadow::expr::range<index_t>(0, num_batch * num_elem);
     for (index_t i = 0; i < num_batch; ++i) {
       // Sort each batch separately
@@ -726,8 +735,33 @@ void BoxNMSForwardGPU_notemp(const nnvm::NodeAttrs& attrs,
                            &sorted_indices_batch);
     }
     CompactData<false>(sorted_indices, out, &buffer, topk, -1, s);
-    NMS<DType> nms;
-    nms(&buffer, &nms_scratch, topk, param, s);
+    if (UseBitmaskNMS(num_batch, topk)) {
+      const bitmask_nms::BoxLayout layout = {width_elem,
+                                             param.coord_start,
+                                             param.score_index,
+                                             param.force_suppress ? -1 : param.id_index,
+                                             0.f};
+      bitmask_nms::BatchedNMS(Stream<gpu>::GetStream(s),
+                              buffer.dptr_,
+                              num_batch,
+                              num_elem * width_elem,
+                              topk,
+                              layout,
+                              param.in_format,
+                              param.overlap_thresh,
+                              true,
+                              topk,
+                              nullptr,
+                              nullptr,
+                              workspace.nms_scratch);
+    } else {
+      Tensor<gpu, 2, uint32_t> nms_scratch(
+          workspace.nms_scratch,
+          Shape2(NMS<DType>::THRESHOLD / (sizeof(uint32_t) * 8), topk * num_batch),
+          s);
+      NMS<DType> nms;
+      nms(&buffer, &nms_scratch, topk, param, s);
+    }
     CompactNMSResults(buffer,
                       &out,
                       &indices,
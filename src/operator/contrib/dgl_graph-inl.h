@@ -62,6 +62,470 @@ void DGLAdjacencyForwardEx(const nnvm::NodeAttrs& attrs,
   mxnet_op::copy(s, outputs[0].aux_data(csr::kIndPtr), in_indptr);
 }
 
+///////////////////////// Message passing ///////////////////////////
+
+namespace gspmm {
+enum GSpMMOpType { kCopyLhs, kMul, kAdd };
+enum GSpMMReducerType { kSum, kMax, kMean };
+}  // namespace gspmm
+
+namespace gsddmm {
+enum GSDDMMOpType { kDot, kAdd, kMul };
+}  // namespace gsddmm
+
+struct GSpMMParam : public dmlc::Parameter<GSpMMParam> {
+  int op;
+  int reducer;
+  DMLC_DECLARE_PARAMETER(GSpMMParam) {
+    DMLC_DECLARE_FIELD(op)
+        .add_enum("copy_lhs", gspmm::kCopyLhs)
+        .add_enum("mul", gspmm::kMul)
+        .add_enum("add", gspmm::kAdd)
+        .set_default(gspmm::kCopyLhs)
+        .describe(
+            "The message of an edge: the feature of its column vertex (copy_lhs), or the feature "
+            "multiplied by (mul) or added to (add) the value of the edge.");
+    DMLC_DECLARE_FIELD(reducer)
+        .add_enum("sum", gspmm::kSum)
+        .add_enum("max", gspmm::kMax)
+        .add_enum("mean", gspmm::kMean)
+        .set_default(gspmm::kSum)
+        .describe("The reduction of the messages of the edges of a row vertex.");
+  }
+};
+
+struct GSDDMMParam : public dmlc::Parameter<GSDDMMParam> {
+  int op;
+  DMLC_DECLARE_PARAMETER(GSDDMMParam) {
+    DMLC_DECLARE_FIELD(op)
+        .add_enum("dot", gsddmm::kDot)
+        .add_enum("add", gsddmm::kAdd)
+        .add_enum("mul", gsddmm::kMul)
+        .set_default(gsddmm::kDot)
+        .describe(
+            "The value of an edge from the features of its row and column vertices. add and mul "
+            "need features of size 1.");
+  }
+};
+
+template <typename DType>
+MSHADOW_XINLINE DType GSpMMMessage(const int op, const DType u, const DType e) {
+  return op == gspmm::kMul ? u * e : (op == gspmm::kAdd ? u + e : u);
+}
+
+/*! \brief the derivative of the message of an edge by the feature of its column vertex */
+template <typename DType>
+MSHADOW_XINLINE DType GSpMMMessageGradLhs(const int op, const DType e) {
+  return op == gspmm::kMul ? e : DType(1);
+}
+
+/*! \brief the first edge of the non empty range [begin, end) with the max message of feature d */
+template <typename DType, typename EType, typename IType>
+MSHADOW_XINLINE IType GSpMMArgMax(const int op,
+                                  const EType* edata,
+                                  const IType* indices,
+                                  const IType begin,
+                                  const IType end,
+                                  const DType* ufeat,
+                                  const index_t dim,
+                                  const index_t d) {
+  IType best = begin;
+  DType best_val =
+      GSpMMMessage(op, ufeat[indices[begin] * dim + d], static_cast<DType>(edata[begin]));
+  for (IType e = begin + 1; e < end; ++e) {
+    const DType val = GSpMMMessage(op, ufeat[indices[e] * dim + d], static_cast<DType>(edata[e]));
+    if (val > best_val) {
+      best     = e;
+      best_val = val;
+    }
+  }
+  return best;
+}
+
+/*! \brief out[row, d] = reduce of the messages of the edges of row, a thread per (row, d) */
+template <int req>
+struct gspmm_forward {
+  template <typename DType, typename EType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const EType* edata,
+                                  const IType* indices,
+                                  const IType* indptr,
+                                  const DType* ufeat,
+                                  const index_t dim,
+                                  const int op,
+                                  const int reducer) {
+    using AType       = typename mxnet_op::AccType<DType>::type;
+    const index_t row = i / dim;
+    const index_t d   = i % dim;
+    const IType begin = indptr[row];
+    const IType end   = indptr[row + 1];
+    if (begin == end) {
+      KERNEL_ASSIGN(out[i], req, DType(0));
+      return;
+    }
+    AType acc = 0;
+    if (reducer == gspmm::kMax) {
+      const IType best = GSpMMArgMax(op, edata, indices, begin, end, ufeat, dim, d);
+      acc              = AType(
+          GSpMMMessage(op, ufeat[indices[best] * dim + d], static_cast<DType>(edata[best])));
+    } else {
+      for (IType e = begin; e < end; ++e) {
+        acc += AType(GSpMMMessage(op, ufeat[indices[e] * dim + d], static_cast<DType>(edata[e])));
+      }
+      if (reducer == gspmm::kMean)
+        acc /= AType(end - begin);
+    }
+    KERNEL_ASSIGN(out[i], req, DType(acc));
+  }
+};
+
+/*! \brief the gradient of the values of the edges of a row, a thread per row */
+struct gspmm_backward_graph {
+  template <typename DType, typename EType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t row,
+                                  EType* dedata,
+                                  const DType* ograd,
+                                  const EType* edata,
+                                  const IType* indices,
+                                  const IType* indptr,
+                                  const DType* ufeat,
+                                  const index_t dim,
+                                  const int op,
+                                  const int reducer) {
+    using AType       = typename mxnet_op::AccType<DType>::type;
+    const IType begin = indptr[row];
+    const IType end   = indptr[row + 1];
+    if (reducer == gspmm::kMax) {
+      for (IType e = begin; e < end; ++e)
+        dedata[e] = EType(0);
+      for (index_t d = 0; begin < end && d < dim; ++d) {
+        const IType best = GSpMMArgMax(op, edata, indices, begin, end, ufeat, dim, d);
+        const AType g    = AType(ograd[row * dim + d]);
+        dedata[best] +=
+            static_cast<EType>(op == gspmm::kMul ? g * AType(ufeat[indices[best] * dim + d]) : g);
+      }
+      return;
+    }
+    const AType scale = reducer == gspmm::kMean ? AType(1) / AType(end - begin) : AType(1);
+    for (IType e = begin; e < end; ++e) {
+      AType acc = 0;
+      for (index_t d = 0; d < dim; ++d) {
+        const AType g = AType(ograd[row * dim + d]);
+        acc += op == gspmm::kMul ? g * AType(ufeat[indices[e] * dim + d]) : g;
+      }
+      dedata[e] = static_cast<EType>(acc * scale);
+    }
+  }
+};
+
+/*! \brief out[e] = op(lhs[row], rhs[col]) for the edges of a row, a thread per row */
+struct gsddmm_forward {
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t row,
+                                  DType* out,
+                                  const IType* indices,
+                                  const IType* indptr,
+                                  const DType* lhs,
+                                  const DType* rhs,
+                                  const index_t dim,
+                                  const int op) {
+    using AType = typename mxnet_op::AccType<DType>::type;
+    for (IType e = indptr[row]; e < indptr[row + 1]; ++e) {
+      const DType* r = rhs + indices[e] * dim;
+      if (op == gsddmm::kDot) {
+        AType acc = 0;
+        for (index_t d = 0; d < dim; ++d)
+          acc += AType(lhs[row * dim + d]) * AType(r[d]);
+        out[e] = DType(acc);
+      } else {
+        out[e] = op == gsddmm::kAdd ? lhs[row] + r[0] : lhs[row] * r[0];
+      }
+    }
+  }
+};
+
+/*! \brief gathers the gradient of the edges of a row from a dense gradient, a thread per row */
+struct gsddmm_gather_ograd {
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t row,
+                                  DType* out,
+                                  const DType* ograd,
+                                  const IType* indices,
+                                  const IType* indptr,
+                                  const index_t num_cols) {
+    for (IType e = indptr[row]; e < indptr[row + 1]; ++e)
+      out[e] = ograd[row * num_cols + indices[e]];
+  }
+};
+
+/*! \brief the gradient of lhs, a thread per (row, d) */
+template <int req>
+struct gsddmm_backward_lhs {
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* dlhs,
+                                  const DType* ograd,
+                                  const IType* indices,
+                                  const IType* indptr,
+                                  const DType* rhs,
+                                  const index_t dim,
+                                  const int op) {
+    using AType       = typename mxnet_op::AccType<DType>::type;
+    const index_t row = i / dim;
+    const index_t d   = i % dim;
+    AType acc         = 0;
+    for (IType e = indptr[row]; e < indptr[row + 1]; ++e) {
+      acc += op == gsddmm::kAdd ? AType(ograd[e])
+                                : AType(ograd[e]) * AType(rhs[indices[e] * dim + d]);
+    }
+    KERNEL_ASSIGN(dlhs[i], req, DType(acc));
+  }
+};
+
+/*!
+ * \brief Adds the gradient of the messages of gspmm to the features of their column vertices.
+ *  The scatter is device specific: the cpu one is split between the features, the gpu one uses
+ *  atomics.
+ */
+template <typename xpu>
+void GSpMMScatterUFeat(mshadow::Stream<xpu>* s,
+                       const GSpMMParam& param,
+                       const TBlob& ograd,
+                       const NDArray& graph,
+                       const TBlob& ufeat,
+                       const TBlob& dufeat);
+
+/*! \brief Adds the gradient of the edges of gsddmm to the features of their column vertices. */
+template <typename xpu>
+void GSDDMMScatterRhs(mshadow::Stream<xpu>* s,
+                      const GSDDMMParam& param,
+                      const TBlob& ograd,
+                      const NDArray& graph,
+                      const TBlob& lhs,
+                      const TBlob& drhs);
+
+template <typename xpu>
+void GSpMMForwardEx(const nnvm::NodeAttrs& attrs,
+                    const OpContext& ctx,
+                    const std::vector<NDArray>& inputs,
+                    const std::vector<OpReqType>& req,
+                    const std::vector<NDArray>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 1U);
+  CHECK_EQ(inputs[0].storage_type(), kCSRStorage);
+  CHECK_EQ(outputs[0].storage_type(), kDefaultStorage);
+  if (req[0] == kNullOp)
+    return;
+  const GSpMMParam& param = nnvm::get<GSpMMParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  const NDArray& graph    = inputs[0];
+  const TBlob& out        = outputs[0].data();
+  if (!graph.storage_initialized() || out.Size() == 0) {
+    Fill<false>(s, out, req[0], 0);
+    return;
+  }
+  const index_t dim = out.Size() / out.shape_[0];
+  MSHADOW_REAL_TYPE_SWITCH(out.type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH(graph.dtype(), EType, {
+      MSHADOW_IDX_TYPE_SWITCH(graph.aux_type(csr::kIdx), IType, {
+        MXNET_ASSIGN_REQ_SWITCH(req[0], Req, {
+          Kernel<gspmm_forward<Req>, xpu>::Launch(s,
+                                                  out.Size(),
+                                                  out.dptr<DType>(),
+                                                  graph.data().dptr<EType>(),
+                                                  graph.aux_data(csr::kIdx).dptr<IType>(),
+                                                  graph.aux_data(csr::kIndPtr).dptr<IType>(),
+                                                  inputs[1].data().dptr<DType>(),
+                                                  dim,
+                                                  param.op,
+                                                  param.reducer);
+        });
+      });
+    });
+  });
+}
+
+template <typename xpu>
+void GSpMMBackwardEx(const nnvm::NodeAttrs& attrs,
+                     const OpContext& ctx,
+                     const std::vector<NDArray>& inputs,
+                     const std::vector<OpReqType>& req,
+                     const std::vector<NDArray>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 3U);
+  CHECK_EQ(outputs.size(), 2U);
+  CHECK_EQ(outputs[0].storage_type(), kCSRStorage);
+  CHECK_NE(req[0], kAddTo) << "gspmm does not support kAddTo for the gradient of the graph";
+  const GSpMMParam& param = nnvm::get<GSpMMParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  const TBlob& ograd      = inputs[0].data();
+  const NDArray& graph    = inputs[1];
+  const NDArray& dgraph   = outputs[0];
+  const TBlob& dufeat     = outputs[1].data();
+  // the gradient of ufeat is scattered, kAddTo adds to the gradient in place
+  Fill<false>(s, dufeat, req[1], 0);
+  if (!graph.storage_initialized() || ograd.Size() == 0) {
+    if (req[0] != kNullOp)
+      FillZerosCsrImpl(s, dgraph);
+    return;
+  }
+  if (req[1] != kNullOp)
+    GSpMMScatterUFeat<xpu>(s, param, ograd, graph, inputs[2].data(), dufeat);
+  if (req[0] == kNullOp)
+    return;
+  if (param.op == gspmm::kCopyLhs) {
+    // the messages don't depend on the values of the edges
+    FillZerosCsrImpl(s, dgraph);
+    return;
+  }
+  const TBlob& in_idx    = graph.aux_data(csr::kIdx);
+  const TBlob& in_indptr = graph.aux_data(csr::kIndPtr);
+  dgraph.CheckAndAllocData(in_idx.shape_);
+  dgraph.CheckAndAllocAuxData(csr::kIdx, in_idx.shape_);
+  dgraph.CheckAndAllocAuxData(csr::kIndPtr, in_indptr.shape_);
+  mxnet_op::copy(s, dgraph.aux_data(csr::kIdx), in_idx);
+  mxnet_op::copy(s, dgraph.aux_data(csr::kIndPtr), in_indptr);
+  const index_t num_rows = graph.shape()[0];
+  const index_t dim      = ograd.Size() / num_rows;
+  MSHADOW_REAL_TYPE_SWITCH(ograd.type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH(graph.dtype(), EType, {
+      MSHADOW_IDX_TYPE_SWITCH(graph.aux_type(csr::kIdx), IType, {
+        Kernel<gspmm_backward_graph, xpu>::Launch(s,
+                                                  num_rows,
+                                                  dgraph.data().dptr<EType>(),
+                                                  ograd.dptr<DType>(),
+                                                  graph.data().dptr<EType>(),
+                                                  in_idx.dptr<IType>(),
+                                                  in_indptr.dptr<IType>(),
+                                                  inputs[2].data().dptr<DType>(),
+                                                  dim,
+                                                  param.op,
+                                                  param.reducer);
+      });
+    });
+  });
+}
+
+template <typename xpu>
+void GSDDMMForwardEx(const nnvm::NodeAttrs& attrs,
+                     const OpContext& ctx,
+                     const std::vector<NDArray>& inputs,
+                     const std::vector<OpReqType>& req,
+                     const std::vector<NDArray>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 3U);
+  CHECK_EQ(outputs.size(), 1U);
+  CHECK_EQ(inputs[0].storage_type(), kCSRStorage);
+  CHECK_EQ(outputs[0].storage_type(), kCSRStorage);
+  if (req[0] == kNullOp)
+    return;
+  CHECK_EQ(req[0], kWriteTo) << "gsddmm only supports kWriteTo";
+  const GSDDMMParam& param = nnvm::get<GSDDMMParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s  = ctx.get_stream<xpu>();
+  const NDArray& graph     = inputs[0];
+  const NDArray& out       = outputs[0];
+  if (!graph.storage_initialized()) {
+    FillZerosCsrImpl(s, out);
+    return;
+  }
+  const TBlob& in_idx    = graph.aux_data(csr::kIdx);
+  const TBlob& in_indptr = graph.aux_data(csr::kIndPtr);
+  out.CheckAndAllocData(in_idx.shape_);
+  out.CheckAndAllocAuxData(csr::kIdx, in_idx.shape_);
+  out.CheckAndAllocAuxData(csr::kIndPtr, in_indptr.shape_);
+  mxnet_op::copy(s, out.aux_data(csr::kIdx), in_idx);
+  mxnet_op::copy(s, out.aux_data(csr::kIndPtr), in_indptr);
+  const TBlob& lhs       = inputs[1].data();
+  const index_t num_rows = graph.shape()[0];
+  const index_t dim      = num_rows == 0 ? 0 : lhs.Size() / num_rows;
+  MSHADOW_REAL_TYPE_SWITCH(lhs.type_flag_, DType, {
+    MSHADOW_IDX_TYPE_SWITCH(graph.aux_type(csr::kIdx), IType, {
+      Kernel<gsddmm_forward, xpu>::Launch(s,
+                                          num_rows,
+                                          out.data().dptr<DType>(),
+                                          in_idx.dptr<IType>(),
+                                          in_indptr.dptr<IType>(),
+                                          lhs.dptr<DType>(),
+                                          inputs[2].data().dptr<DType>(),
+                                          dim,
+                                          param.op);
+    });
+  });
+}
+
+template <typename xpu>
+void GSDDMMBackwardEx(const nnvm::NodeAttrs& attrs,
+                      const OpContext& ctx,
+                      const std::vector<NDArray>& inputs,
+                      const std::vector<OpReqType>& req,
+                      const std::vector<NDArray>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 4U);
+  CHECK_EQ(outputs.size(), 3U);
+  CHECK_EQ(outputs[0].storage_type(), kCSRStorage);
+  CHECK_NE(req[0], kAddTo) << "gsddmm does not support kAddTo for the gradient of the graph";
+  const GSDDMMParam& param = nnvm::get<GSDDMMParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s  = ctx.get_stream<xpu>();
+  const NDArray& ograd     = inputs[0];
+  const NDArray& graph     = inputs[1];
+  const TBlob& lhs         = inputs[2].data();
+  const TBlob& rhs         = inputs[3].data();
+  const TBlob& dlhs        = outputs[1].data();
+  const TBlob& drhs        = outputs[2].data();
+  // the values of the edges of the graph are not used by gsddmm
+  if (req[0] != kNullOp)
+    FillZerosCsrImpl(s, outputs[0]);
+  // the gradient of rhs is scattered like the one of the features of gspmm
+  Fill<false>(s, drhs, req[2], 0);
+  const bool csr_ograd = ograd.storage_type() == kCSRStorage;
+  if (!graph.storage_initialized() || (csr_ograd && !ograd.storage_initialized())) {
+    Fill<false>(s, dlhs, req[1], 0);
+    return;
+  }
+  const TBlob& in_idx    = graph.aux_data(csr::kIdx);
+  const TBlob& in_indptr = graph.aux_data(csr::kIndPtr);
+  const index_t nnz      = in_idx.Size();
+  const index_t num_rows = graph.shape()[0];
+  const index_t dim      = num_rows == 0 ? 0 : lhs.Size() / num_rows;
+  if (csr_ograd) {
+    CHECK_EQ(ograd.aux_shape(csr::kIdx)[0], nnz)
+        << "The gradient of gsddmm must have the sparsity of the graph";
+  }
+  MSHADOW_REAL_TYPE_SWITCH(lhs.type_flag_, DType, {
+    MSHADOW_IDX_TYPE_SWITCH(graph.aux_type(csr::kIdx), IType, {
+      TBlob edge_grad = ograd.data();
+      if (!csr_ograd) {
+        // the gradient of the edges of the graph
+        mshadow::Tensor<xpu, 1, DType> workspace =
+            ctx.requested[0].get_space_typed<xpu, 1, DType>(mshadow::Shape1(nnz), s);
+        edge_grad = TBlob(workspace);
+        Kernel<gsddmm_gather_ograd, xpu>::Launch(s,
+                                                 num_rows,
+                                                 edge_grad.dptr<DType>(),
+                                                 ograd.data().dptr<DType>(),
+                                                 in_idx.dptr<IType>(),
+                                                 in_indptr.dptr<IType>(),
+                                                 static_cast<index_t>(graph.shape()[1]));
+      }
+      MXNET_ASSIGN_REQ_SWITCH(req[1], Req, {
+        Kernel<gsddmm_backward_lhs<Req>, xpu>::Launch(s,
+                                                      dlhs.Size(),
+                                                      dlhs.dptr<DType>(),
+                                                      edge_grad.dptr<DType>(),
+                                                      in_idx.dptr<IType>(),
+                                                      in_indptr.dptr<IType>(),
+                                                      rhs.dptr<DType>(),
+                                                      dim,
+                                                      param.op);
+      });
+      if (req[2] != kNullOp)
+        GSDDMMScatterRhs<xpu>(s, param, edge_grad, graph, lhs, drhs);
+    });
+  });
+}
+
 }  // namespace op
 }  // namespace mxnet
 
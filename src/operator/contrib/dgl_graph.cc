@@ -548,74 +548,89 @@ static void SampleSubgraph(const NDArray& csr,
       sub_vers.emplace_back(seed[i], 0);
     }
   }
-  std::vector<dgl_id_t> tmp_sampled_src_list;
-  std::vector<dgl_id_t> tmp_sampled_edge_list;
+  // the sampled neighbors and edges of the vertices of a hop
+  std::vector<std::vector<dgl_id_t> > hop_src_lists;
+  std::vector<std::vector<dgl_id_t> > hop_edge_lists;
   // ver_id, position
   std::vector<std::pair<dgl_id_t, size_t> > neigh_pos;
   neigh_pos.reserve(num_seeds);
   std::vector<dgl_id_t> neighbor_list;
-  size_t num_edges = 0;
+  size_t num_edges      = 0;
+  const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
 
   // sub_vers is used both as a node collection and a queue.
-  // In the while loop, we iterate over sub_vers and new nodes are added to the vector.
-  // A vertex in the vector only needs to be accessed once. If there is a vertex behind idx
-  // isn't in the last level, we will sample its neighbors. If not, the while loop terminates.
+  // In the while loop, we iterate over sub_vers one hop at a time and new nodes are added to
+  // the vector. A vertex in the vector only needs to be accessed once. If there is a vertex
+  // behind idx isn't in the last level, we will sample its neighbors. If not, the while loop
+  // terminates. The neighbors of the vertices of a hop are sampled in parallel, each vertex
+  // with a generator seeded by its id, then added to the queue in order.
   size_t idx = 0;
   while (idx < sub_vers.size() && sub_ver_mp.size() < max_num_vertices) {
-    dgl_id_t dst_id    = sub_vers[idx].first;
-    int cur_node_level = sub_vers[idx].second;
-    idx++;
-    // If the node is in the last level, we don't need to sample neighbors
-    // from this node.
+    const int cur_node_level = sub_vers[idx].second;
+    // If the nodes are in the last level, we don't need to sample neighbors
+    // from them.
     if (cur_node_level >= num_hops)
-      continue;
-
-    tmp_sampled_src_list.clear();
-    tmp_sampled_edge_list.clear();
-    dgl_id_t ver_len = *(indptr + dst_id + 1) - *(indptr + dst_id);
-    if (probability == nullptr) {  // uniform-sample
-      GetUniformSample(val_list + *(indptr + dst_id),
-                       col_list + *(indptr + dst_id),
-                       ver_len,
-                       num_neighbor,
-                       &tmp_sampled_src_list,
-                       &tmp_sampled_edge_list,
-                       random_seed);
-    } else {  // non-uniform-sample
-      GetNonUniformSample(probability,
-                          val_list + *(indptr + dst_id),
-                          col_list + *(indptr + dst_id),
-                          ver_len,
-                          num_neighbor,
-                          &tmp_sampled_src_list,
-                          &tmp_sampled_edge_list,
-                          random_seed);
-    }
-    CHECK_EQ(tmp_sampled_src_list.size(), tmp_sampled_edge_list.size());
-    size_t pos = neighbor_list.size();
-    neigh_pos.emplace_back(dst_id, pos);
-    // First we push the size of neighbor vector
-    neighbor_list.push_back(tmp_sampled_edge_list.size());
-    // Then push the vertices
-    for (dgl_id_t& i : tmp_sampled_src_list) {
-      neighbor_list.push_back(i);
-    }
-    // Finally we push the edge list
-    for (dgl_id_t& i : tmp_sampled_edge_list) {
-      neighbor_list.push_back(i);
+      break;
+    size_t hop_end = idx;
+    while (hop_end < sub_vers.size() && sub_vers[hop_end].second == cur_node_level)
+      hop_end++;
+    const size_t hop_begin = idx;
+    hop_src_lists.resize(hop_end - hop_begin);
+    hop_edge_lists.resize(hop_end - hop_begin);
+#pragma omp parallel for num_threads(omp_threads) schedule(dynamic, 16)
+    for (int64_t j = 0; j < static_cast<int64_t>(hop_end - hop_begin); ++j) {
+      const dgl_id_t dst_id  = sub_vers[hop_begin + j].first;
+      const dgl_id_t ver_len = *(indptr + dst_id + 1) - *(indptr + dst_id);
+      const unsigned int ver_seed =
+          random_seed + static_cast<unsigned int>(dst_id) * 2654435761U;
+      hop_src_lists[j].clear();
+      hop_edge_lists[j].clear();
+      if (probability == nullptr) {  // uniform-sample
+        GetUniformSample(val_list + *(indptr + dst_id),
+                         col_list + *(indptr + dst_id),
+                         ver_len,
+                         num_neighbor,
+                         &hop_src_lists[j],
+                         &hop_edge_lists[j],
+                         ver_seed);
+      } else {  // non-uniform-sample
+        GetNonUniformSample(probability,
+                            val_list + *(indptr + dst_id),
+                            col_list + *(indptr + dst_id),
+                            ver_len,
+                            num_neighbor,
+                            &hop_src_lists[j],
+                            &hop_edge_lists[j],
+                            ver_seed);
+      }
     }
-    num_edges += tmp_sampled_src_list.size();
-    for (dgl_id_t& i : tmp_sampled_src_list) {
-      // If we have sampled the max number of vertices, we have to stop.
-      if (sub_ver_mp.size() >= max_num_vertices)
-        break;
-      // We need to add the neighbor in the hashtable here. This ensures that
-      // the vertex in the queue is unique. If we see a vertex before, we don't
-      // need to add it to the queue again.
-      auto ret = sub_ver_mp.insert(i);
-      // If the sampled neighbor is inserted to the map successfully.
-      if (ret.second)
-        sub_vers.emplace_back(i, cur_node_level + 1);
+    for (; idx < hop_end && sub_ver_mp.size() < max_num_vertices; idx++) {
+      const dgl_id_t dst_id                          = sub_vers[idx].first;
+      const std::vector<dgl_id_t>& sampled_src_list  = hop_src_lists[idx - hop_begin];
+      const std::vector<dgl_id_t>& sampled_edge_list = hop_edge_lists[idx - hop_begin];
+      CHECK_EQ(sampled_src_list.size(), sampled_edge_list.size());
+      size_t pos = neighbor_list.size();
+      neigh_pos.emplace_back(dst_id, pos);
+      // First we push the size of neighbor vector
+      neighbor_list.push_back(sampled_edge_list.size());
+      // Then push the vertices
+      neighbor_list.insert(neighbor_list.end(), sampled_src_list.begin(), sampled_src_list.end());
+      // Finally we push the edge list
+      neighbor_list.insert(
+          neighbor_list.end(), sampled_edge_list.begin(), sampled_edge_list.end());
+      num_edges += sampled_src_list.size();
+      for (const dgl_id_t i : sampled_src_list) {
+        // If we have sampled the max number of vertices, we have to stop.
+        if (sub_ver_mp.size() >= max_num_vertices)
+          break;
+        // We need to add the neighbor in the hashtable here. This ensures that
+        // the vertex in the queue is unique. If we see a vertex before, we don't
+        // need to add it to the queue again.
+        auto ret = sub_ver_mp.insert(i);
+        // If the sampled neighbor is inserted to the map successfully.
+        if (ret.second)
+          sub_vers.emplace_back(i, cur_node_level + 1);
+      }
     }
   }
   // Let's check if there is a vertex that we haven't sampled its neighbors.
@@ -714,7 +729,9 @@ static void CSRNeighborUniformSampleComputeExCPU(const nnvm::NodeAttrs& attrs,
   mshadow::Random<cpu, unsigned int>* prnd = ctx.requested[0].get_random<cpu, unsigned int>(s);
   unsigned int seed                        = prnd->GetRandInt();
 
-#pragma omp parallel for
+  // a single subgraph is sampled by the threads of the hops instead
+  const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads) if (num_subgraphs > 1)
   for (int i = 0; i < num_subgraphs; i++) {
     SampleSubgraph(inputs[0],                       // graph_csr
                    inputs[i + 1],                   // seed vector
@@ -726,11 +743,7 @@ static void CSRNeighborUniformSampleComputeExCPU(const nnvm::NodeAttrs& attrs,
                    params.num_hops,
                    params.num_neighbor,
                    params.max_num_vertices,
-#if defined(_OPENMP)
-                   seed + omp_get_thread_num());
-#else
-                   seed);
-#endif
+                   seed + i);
   }
 }
 
@@ -817,7 +830,9 @@ static void CSRNeighborNonUniformSampleComputeExCPU(const nnvm::NodeAttrs& attrs
   mshadow::Random<cpu, unsigned int>* prnd = ctx.requested[0].get_random<cpu, unsigned int>(s);
   unsigned int seed                        = prnd->GetRandInt();
 
-#pragma omp parallel for
+  // a single subgraph is sampled by the threads of the hops instead
+  const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads) if (num_subgraphs > 1)
   for (int i = 0; i < num_subgraphs; i++) {
     float* sub_prob = outputs[i + 2 * num_subgraphs].data().dptr<float>();
     SampleSubgraph(inputs[0],                       // graph_csr
@@ -830,11 +845,7 @@ static void CSRNeighborNonUniformSampleComputeExCPU(const nnvm::NodeAttrs& attrs
                    params.num_hops,
                    params.num_neighbor,
                    params.max_num_vertices,
-#if defined(_OPENMP)
-                   seed + omp_get_thread_num());
-#else
-                   seed);
-#endif
+                   seed + i);
   }
 }
 
@@ -1640,5 +1651,387 @@ Example:
     .add_argument("graph_data", "NDArray-or-Symbol[]", "Input graphs and input vertex Ids.")
     .add_arguments(SubgraphCompactParam::__FIELDS__());
 
+///////////////////////// Message passing ///////////////////////////
+
+DMLC_REGISTER_PARAMETER(GSpMMParam);
+DMLC_REGISTER_PARAMETER(GSDDMMParam);
+
+/*! \brief dufeat[indices[e], d] += ograd[row, d] * dmessage, a thread per feature d */
+struct gspmm_backward_ufeat_cpu {
+  template <typename DType, typename EType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t d,
+                                  DType* dufeat,
+                                  const DType* ograd,
+                                  const EType* edata,
+                                  const IType* indices,
+                                  const IType* indptr,
+                                  const DType* ufeat,
+                                  const index_t num_rows,
+                                  const index_t dim,
+                                  const int op,
+                                  const int reducer) {
+    for (index_t row = 0; row < num_rows; ++row) {
+      const IType begin = indptr[row];
+      const IType end   = indptr[row + 1];
+      if (begin == end)
+        continue;
+      const DType g = ograd[row * dim + d];
+      if (reducer == gspmm::kMax) {
+        const IType e = GSpMMArgMax(op, edata, indices, begin, end, ufeat, dim, d);
+        dufeat[indices[e] * dim + d] += g * GSpMMMessageGradLhs(op, static_cast<DType>(edata[e]));
+        continue;
+      }
+      const DType scale = reducer == gspmm::kMean ? g / DType(end - begin) : g;
+      for (IType e = begin; e < end; ++e) {
+        dufeat[indices[e] * dim + d] +=
+            scale * GSpMMMessageGradLhs(op, static_cast<DType>(edata[e]));
+      }
+    }
+  }
+};
+
+/*! \brief drhs[indices[e], d] += ograd[e] * dvalue, a thread per feature d */
+struct gsddmm_backward_rhs_cpu {
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t d,
+                                  DType* drhs,
+                                  const DType* ograd,
+                                  const IType* indices,
+                                  const IType* indptr,
+                                  const DType* lhs,
+                                  const index_t num_rows,
+                                  const index_t dim,
+                                  const int op) {
+    for (index_t row = 0; row < num_rows; ++row) {
+      const DType l = op == gsddmm::kAdd ? DType(1) : lhs[row * dim + d];
+      for (IType e = indptr[row]; e < indptr[row + 1]; ++e)
+        drhs[indices[e] * dim + d] += ograd[e] * l;
+    }
+  }
+};
+
+template <>
+void GSpMMScatterUFeat<cpu>(mshadow::Stream<cpu>* s,
+                            const GSpMMParam& param,
+                            const TBlob& ograd,
+                            const NDArray& graph,
+                            const TBlob& ufeat,
+                            const TBlob& dufeat) {
+  using namespace mxnet_op;
+  const index_t num_rows = graph.shape()[0];
+  const index_t dim      = ograd.Size() / num_rows;
+  MSHADOW_REAL_TYPE_SWITCH(ograd.type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH(graph.dtype(), EType, {
+      MSHADOW_IDX_TYPE_SWITCH(graph.aux_type(csr::kIdx), IType, {
+        Kernel<gspmm_backward_ufeat_cpu, cpu>::Launch(s,
+                                                      dim,
+                                                      dufeat.dptr<DType>(),
+                                                      ograd.dptr<DType>(),
+                                                      graph.data().dptr<EType>(),
+                                                      graph.aux_data(csr::kIdx).dptr<IType>(),
+                                                      graph.aux_data(csr::kIndPtr).dptr<IType>(),
+                                                      ufeat.dptr<DType>(),
+                                                      num_rows,
+                                                      dim,
+                                                      param.op,
+                                                      param.reducer);
+      });
+    });
+  });
+}
+
+template <>
+void GSDDMMScatterRhs<cpu>(mshadow::Stream<cpu>* s,
+                           const GSDDMMParam& param,
+                           const TBlob& ograd,
+                           const NDArray& graph,
+                           const TBlob& lhs,
+                           const TBlob& drhs) {
+  using namespace mxnet_op;
+  const index_t num_rows = graph.shape()[0];
+  const index_t dim      = lhs.Size() / num_rows;
+  MSHADOW_REAL_TYPE_SWITCH(ograd.type_flag_, DType, {
+    MSHADOW_IDX_TYPE_SWITCH(graph.aux_type(csr::kIdx), IType, {
+      Kernel<gsddmm_backward_rhs_cpu, cpu>::Launch(s,
+                                                   dim,
+                                                   drhs.dptr<DType>(),
+                                                   ograd.dptr<DType>(),
+                                                   graph.aux_data(csr::kIdx).dptr<IType>(),
+                                                   graph.aux_data(csr::kIndPtr).dptr<IType>(),
+                                                   lhs.dptr<DType>(),
+                                                   num_rows,
+                                                   dim,
+                                                   param.op);
+    });
+  });
+}
+
+static bool GSpMMShape(const nnvm::NodeAttrs& attrs,
+                       mxnet::ShapeVector* in_attrs,
+                       mxnet::ShapeVector* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  const mxnet::TShape& gshape = in_attrs->at(0);
+  const mxnet::TShape& ushape = in_attrs->at(1);
+  if (!mxnet::ndim_is_known(gshape) || !mxnet::ndim_is_known(ushape))
+    return false;
+  CHECK_EQ(gshape.ndim(), 2U) << "gspmm only works for 2D graphs";
+  CHECK_GE(ushape.ndim(), 1U);
+  CHECK_EQ(gshape[1], ushape[0])
+      << "The features of gspmm must have a row per column of the graph, got " << ushape
+      << " for a graph of shape " << gshape;
+  mxnet::TShape oshape = ushape;
+  oshape[0]            = gshape[0];
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, oshape);
+  return shape_is_known(out_attrs->at(0));
+}
+
+static bool GSpMMType(const nnvm::NodeAttrs& attrs,
+                      std::vector<int>* in_attrs,
+                      std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(1));
+  TYPE_ASSIGN_CHECK(*in_attrs, 1, out_attrs->at(0));
+  return in_attrs->at(0) != -1 && out_attrs->at(0) != -1;
+}
+
+static bool GSpMMStorageType(const nnvm::NodeAttrs& attrs,
+                             const int dev_mask,
+                             DispatchMode* dispatch_mode,
+                             std::vector<int>* in_attrs,
+                             std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  bool dispatched = false;
+  if (in_attrs->at(0) == kCSRStorage && in_attrs->at(1) == kDefaultStorage) {
+    dispatched = storage_type_assign(
+        &out_attrs->at(0), kDefaultStorage, dispatch_mode, DispatchMode::kFComputeEx);
+  }
+  if (!dispatched) {
+    LOG(ERROR) << "Cannot dispatch gspmm storage type, only works for a csr graph and "
+               << "default features";
+  }
+  return dispatched;
+}
+
+static bool GSpMMBackwardStorageType(const nnvm::NodeAttrs& attrs,
+                                     const int dev_mask,
+                                     DispatchMode* dispatch_mode,
+                                     std::vector<int>* in_attrs,
+                                     std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 3U);
+  CHECK_EQ(out_attrs->size(), 2U);
+  bool dispatched = false;
+  if (in_attrs->at(0) == kDefaultStorage && in_attrs->at(1) == kCSRStorage &&
+      in_attrs->at(2) == kDefaultStorage) {
+    dispatched = storage_type_assign(
+                     &out_attrs->at(0), kCSRStorage, dispatch_mode, DispatchMode::kFComputeEx) &&
+        storage_type_assign(
+            &out_attrs->at(1), kDefaultStorage, dispatch_mode, DispatchMode::kFComputeEx);
+  }
+  return dispatched;
+}
+
+NNVM_REGISTER_OP(_contrib_dgl_gspmm)
+    .describe(R"code(This operator implements the message passing of a graph neural
+network on a graph stored in a CSR matrix, a generalized sparse-dense matrix
+multiplication (gSpMM). The features of the vertices of the columns are sent along
+the edges as messages, which are reduced into the features of the vertices of the rows:
+out[i] = reducer over the edges (i, j) of op(ufeat[j], graph[i, j]).
+
+``op`` is copy_lhs (the message is ufeat[j]), mul or add (ufeat[j] multiplied by or
+added to the value of the edge). ``reducer`` is sum, max or mean. The rows without
+edges get 0.
+
+Example:
+
+   .. code:: python
+
+  x = [[ 0, 1, 1 ],
+       [ 0, 0, 2 ],
+       [ 0, 0, 0 ]]
+  ufeat = [[ 1, 2 ],
+           [ 3, 4 ],
+           [ 5, 6 ]]
+  dgl_gspmm(x, ufeat, op='copy_lhs', reducer='sum') =
+      [[ 8, 10 ],
+       [ 5,  6 ],
+       [ 0,  0 ]]
+  dgl_gspmm(x, ufeat, op='mul', reducer='max') =
+      [[ 5,  6 ],
+       [ 10, 12 ],
+       [ 0,  0 ]]
+
+The storage type of ``dgl_gspmm`` output depends on storage types of inputs
+  - dgl_gspmm(csr, default) = default
+
+)code" ADD_FILELINE)
+    .set_attr_parser(ParamParser<GSpMMParam>)
+    .set_num_inputs(2)
+    .set_num_outputs(1)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"graph", "ufeat"};
+                                     })
+    .set_attr<mxnet::FInferShape>("FInferShape", GSpMMShape)
+    .set_attr<nnvm::FInferType>("FInferType", GSpMMType)
+    .set_attr<FInferStorageType>("FInferStorageType", GSpMMStorageType)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", GSpMMForwardEx<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", ElemwiseGradUseIn{"_backward_contrib_dgl_gspmm"})
+    .add_argument("graph", "NDArray-or-Symbol", "The graph, a CSR matrix")
+    .add_argument("ufeat", "NDArray-or-Symbol", "The features of the vertices of the columns")
+    .add_arguments(GSpMMParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_contrib_dgl_gspmm)
+    .set_attr_parser(ParamParser<GSpMMParam>)
+    .set_num_inputs(3)
+    .set_num_outputs(2)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FInferStorageType>("FInferStorageType", GSpMMBackwardStorageType)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", GSpMMBackwardEx<cpu>);
+
+static bool GSDDMMShape(const nnvm::NodeAttrs& attrs,
+                        mxnet::ShapeVector* in_attrs,
+                        mxnet::ShapeVector* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 3U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  const GSDDMMParam& param    = nnvm::get<GSDDMMParam>(attrs.parsed);
+  const mxnet::TShape& gshape = in_attrs->at(0);
+  const mxnet::TShape& lshape = in_attrs->at(1);
+  const mxnet::TShape& rshape = in_attrs->at(2);
+  if (mxnet::ndim_is_known(gshape)) {
+    CHECK_EQ(gshape.ndim(), 2U) << "gsddmm only works for 2D graphs";
+    SHAPE_ASSIGN_CHECK(*out_attrs, 0, gshape);
+  }
+  if (!shape_is_known(gshape) || !shape_is_known(lshape) || !shape_is_known(rshape))
+    return false;
+  CHECK_EQ(lshape[0], gshape[0]) << "lhs of gsddmm must have a row per row of the graph";
+  CHECK_EQ(rshape[0], gshape[1]) << "rhs of gsddmm must have a row per column of the graph";
+  const index_t ldim = lshape.Size() / lshape[0];
+  CHECK_EQ(ldim, rshape.Size() / rshape[0])
+      << "lhs and rhs of gsddmm must have the same feature size, got " << lshape << " and "
+      << rshape;
+  if (param.op != gsddmm::kDot) {
+    CHECK_EQ(ldim, 1) << "add and mul of gsddmm need features of size 1";
+  }
+  return true;
+}
+
+static bool GSDDMMType(const nnvm::NodeAttrs& attrs,
+                       std::vector<int>* in_attrs,
+                       std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 3U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(1));
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(2));
+  TYPE_ASSIGN_CHECK(*in_attrs, 1, out_attrs->at(0));
+  TYPE_ASSIGN_CHECK(*in_attrs, 2, out_attrs->at(0));
+  return in_attrs->at(0) != -1 && out_attrs->at(0) != -1;
+}
+
+static bool GSDDMMStorageType(const nnvm::NodeAttrs& attrs,
+                              const int dev_mask,
+                              DispatchMode* dispatch_mode,
+                              std::vector<int>* in_attrs,
+                              std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 3U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  bool dispatched = false;
+  if (in_attrs->at(0) == kCSRStorage && in_attrs->at(1) == kDefaultStorage &&
+      in_attrs->at(2) == kDefaultStorage) {
+    dispatched = storage_type_assign(
+        &out_attrs->at(0), kCSRStorage, dispatch_mode, DispatchMode::kFComputeEx);
+  }
+  if (!dispatched) {
+    LOG(ERROR) << "Cannot dispatch gsddmm storage type, only works for a csr graph and "
+               << "default features";
+  }
+  return dispatched;
+}
+
+static bool GSDDMMBackwardStorageType(const nnvm::NodeAttrs& attrs,
+                                      const int dev_mask,
+                                      DispatchMode* dispatch_mode,
+                                      std::vector<int>* in_attrs,
+                                      std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 4U);
+  CHECK_EQ(out_attrs->size(), 3U);
+  const int ograd_stype = in_attrs->at(0);
+  bool dispatched       = false;
+  if ((ograd_stype == kCSRStorage || ograd_stype == kDefaultStorage) &&
+      in_attrs->at(1) == kCSRStorage && in_attrs->at(2) == kDefaultStorage &&
+      in_attrs->at(3) == kDefaultStorage) {
+    dispatched = storage_type_assign(
+                     &out_attrs->at(0), kCSRStorage, dispatch_mode, DispatchMode::kFComputeEx);
+    for (size_t i = 1; dispatched && i < out_attrs->size(); ++i) {
+      dispatched = storage_type_assign(
+          &out_attrs->at(i), kDefaultStorage, dispatch_mode, DispatchMode::kFComputeEx);
+    }
+  }
+  return dispatched;
+}
+
+NNVM_REGISTER_OP(_contrib_dgl_gsddmm)
+    .describe(R"code(This operator computes the values of the edges of a graph stored
+in a CSR matrix from the features of their vertices, a generalized sampled dense-dense
+matrix multiplication (SDDMM). The output is a CSR matrix with the sparsity of the graph:
+out[i, j] = op(lhs[i], rhs[j]) for the edges (i, j) of the graph.
+
+``op`` is dot (the dot product of the features), add or mul. add and mul need
+features of size 1, for instance the attention scores of the row and column vertices
+of a graph attention network.
+
+Example:
+
+   .. code:: python
+
+  x = [[ 0, 1, 1 ],
+       [ 0, 0, 2 ],
+       [ 0, 0, 0 ]]
+  lhs = [[ 1, 2 ],
+         [ 3, 4 ],
+         [ 5, 6 ]]
+  rhs = [[ 1, 0 ],
+         [ 0, 1 ],
+         [ 1, 1 ]]
+  dgl_gsddmm(x, lhs, rhs, op='dot') =
+      [[ 0, 2, 3 ],
+       [ 0, 0, 7 ],
+       [ 0, 0, 0 ]]
+
+The storage type of ``dgl_gsddmm`` output depends on storage types of inputs
+  - dgl_gsddmm(csr, default, default) = csr
+
+)code" ADD_FILELINE)
+    .set_attr_parser(ParamParser<GSDDMMParam>)
+    .set_num_inputs(3)
+    .set_num_outputs(1)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"graph", "lhs", "rhs"};
+                                     })
+    .set_attr<mxnet::FInferShape>("FInferShape", GSDDMMShape)
+    .set_attr<nnvm::FInferType>("FInferType", GSDDMMType)
+    .set_attr<FInferStorageType>("FInferStorageType", GSDDMMStorageType)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", GSDDMMForwardEx<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", ElemwiseGradUseIn{"_backward_contrib_dgl_gsddmm"})
+    .add_argument("graph", "NDArray-or-Symbol", "The graph, a CSR matrix")
+    .add_argument("lhs", "NDArray-or-Symbol", "The features of the vertices of the rows")
+    .add_argument("rhs", "NDArray-or-Symbol", "The features of the vertices of the columns")
+    .add_arguments(GSDDMMParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_contrib_dgl_gsddmm)
+    .set_attr_parser(ParamParser<GSDDMMParam>)
+    .set_num_inputs(4)
+    .set_num_outputs(3)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FInferStorageType>("FInferStorageType", GSDDMMBackwardStorageType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FComputeEx>("FComputeEx<cpu>", GSDDMMBackwardEx<cpu>);
+
 }  // namespace op
 }  // namespace mxnet
@@ -18,6 +18,7 @@
  */
 
 #include "dgl_graph-inl.h"
+#include "../../common/cuda/utils.h"
 
 namespace mxnet {
 namespace op {
@@ -25,5 +26,123 @@ namespace op {
 NNVM_REGISTER_OP(_contrib_dgl_adjacency)
     .set_attr<FComputeEx>("FComputeEx<gpu>", DGLAdjacencyForwardEx<gpu>);
 
+/*! \brief dufeat[indices[e], d] += ograd[row, d] * dmessage, a thread per (row, d) */
+struct gspmm_backward_ufeat_gpu {
+  template <typename DType, typename EType, typename IType>
+  __device__ __forceinline__ static void Map(index_t i,
+                                             DType* dufeat,
+                                             const DType* ograd,
+                                             const EType* edata,
+                                             const IType* indices,
+                                             const IType* indptr,
+                                             const DType* ufeat,
+                                             const index_t dim,
+                                             const int op,
+                                             const int reducer) {
+    const index_t row = i / dim;
+    const index_t d   = i % dim;
+    const IType begin = indptr[row];
+    const IType end   = indptr[row + 1];
+    if (begin == end)
+      return;
+    const DType g = ograd[i];
+    if (reducer == gspmm::kMax) {
+      const IType e = GSpMMArgMax(op, edata, indices, begin, end, ufeat, dim, d);
+      atomicAdd(dufeat + indices[e] * dim + d,
+                g * GSpMMMessageGradLhs(op, static_cast<DType>(edata[e])));
+      return;
+    }
+    const DType scale = reducer == gspmm::kMean ? g / DType(end - begin) : g;
+    for (IType e = begin; e < end; ++e) {
+      atomicAdd(dufeat + indices[e] * dim + d,
+                scale * GSpMMMessageGradLhs(op, static_cast<DType>(edata[e])));
+    }
+  }
+};
+
+/*! \brief drhs[indices[e], d] += ograd[e] * dvalue, a thread per (row, d) */
+struct gsddmm_backward_rhs_gpu {
+  template <typename DType, typename IType>
+  __device__ __forceinline__ static void Map(index_t i,
+                                             DType* drhs,
+                                             const DType* ograd,
+                                             const IType* indices,
+                                             const IType* indptr,
+                                             const DType* lhs,
+                                             const index_t dim,
+                                             const int op) {
+    const index_t row = i / dim;
+    const index_t d   = i % dim;
+    const DType l     = op == gsddmm::kAdd ? DType(1) : lhs[i];
+    for (IType e = indptr[row]; e < indptr[row + 1]; ++e)
+      atomicAdd(drhs + indices[e] * dim + d, ograd[e] * l);
+  }
+};
+
+template <>
+void GSpMMScatterUFeat<gpu>(mshadow::Stream<gpu>* s,
+                            const GSpMMParam& param,
+                            const TBlob& ograd,
+                            const NDArray& graph,
+                            const TBlob& ufeat,
+                            const TBlob& dufeat) {
+  using namespace mxnet_op;
+  const index_t num_rows = graph.shape()[0];
+  const index_t dim      = ograd.Size() / num_rows;
+  MSHADOW_REAL_TYPE_SWITCH(ograd.type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH(graph.dtype(), EType, {
+      MSHADOW_IDX_TYPE_SWITCH(graph.aux_type(csr::kIdx), IType, {
+        Kernel<gspmm_backward_ufeat_gpu, gpu>::Launch(s,
+                                                      ograd.Size(),
+                                                      dufeat.dptr<DType>(),
+                                                      ograd.dptr<DType>(),
+                                                      graph.data().dptr<EType>(),
+                                                      graph.aux_data(csr::kIdx).dptr<IType>(),
+                                                      graph.aux_data(csr::kIndPtr).dptr<IType>(),
+                                                      ufeat.dptr<DType>(),
+                                                      dim,
+                                                      param.op,
+                                                      param.reducer);
+      });
+    });
+  });
+}
+
+template <>
+void GSDDMMScatterRhs<gpu>(mshadow::Stream<gpu>* s,
+                           const GSDDMMParam& param,
+                           const TBlob& ograd,
+                           const NDArray& graph,
+                           const TBlob& lhs,
+                           const TBlob& drhs) {
+  using namespace mxnet_op;
+  const index_t num_rows = graph.shape()[0];
+  const index_t dim      = lhs.Size() / num_rows;
+  MSHADOW_REAL_TYPE_SWITCH(ograd.type_flag_, DType, {
+    MSHADOW_IDX_TYPE_SWITCH(graph.aux_type(csr::kIdx), IType, {
+      Kernel<gsddmm_backward_rhs_gpu, gpu>::Launch(s,
+                                                   lhs.Size(),
+                                                   drhs.dptr<DType>(),
+                                                   ograd.dptr<DType>(),
+                                                   graph.aux_data(csr::kIdx).dptr<IType>(),
+                                                   graph.aux_data(csr::kIndPtr).dptr<IType>(),
+                                                   lhs.dptr<DType>(),
+                                                   dim,
+                                                   param.op);
+    });
+  });
+}
+
+NNVM_REGISTER_OP(_contrib_dgl_gspmm).set_attr<FComputeEx>("FComputeEx<gpu>", GSpMMForwardEx<gpu>);
+
+NNVM_REGISTER_OP(_backward_contrib_dgl_gspmm)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", GSpMMBackwardEx<gpu>);
+
+NNVM_REGISTER_OP(_contrib_dgl_gsddmm)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", GSDDMMForwardEx<gpu>);
+
+NNVM_REGISTER_OP(_backward_contrib_dgl_gsddmm)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", GSDDMMBackwardEx<gpu>);
+
 }  // namespace op
 }  // namespace mxnet
@@ -0,0 +1,262 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fake_quantize-inl.h
+ * \brief Fake quantization with a learnable scale, for quantization-aware training: the data is
+ *  rounded to the int8 or uint8 grid of the scale, per tensor or per channel, and the gradients
+ *  of the data and of the scale are the ones of the learned step size quantizer
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_FAKE_QUANTIZE_INL_H_
+#define MXNET_OPERATOR_CONTRIB_FAKE_QUANTIZE_INL_H_
+
+#include <dmlc/parameter.h>
+#include <mxnet/operator_util.h>
+#include <vector>
+#include "../mshadow_op.h"
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+#include "../tensor/broadcast_reduce_op.h"
+
+namespace mxnet {
+namespace op {
+
+namespace fake_quantize {
+enum FakeQuantizeOpInputs { kData, kScale };
+enum FakeQuantizeBackwardOpInputs { kOutGrad, kBwdData, kBwdScale };
+enum FakeQuantizeBackwardOpOutputs { kDataGrad, kScaleGrad };
+enum FakeQuantizeDType { kInt8, kUint8 };
+}  // namespace fake_quantize
+
+struct FakeQuantizeParam : public dmlc::Parameter<FakeQuantizeParam> {
+  int quantized_dtype;
+  dmlc::optional<int> axis;
+  DMLC_DECLARE_PARAMETER(FakeQuantizeParam) {
+    DMLC_DECLARE_FIELD(quantized_dtype)
+        .add_enum("int8", fake_quantize::kInt8)
+        .add_enum("uint8", fake_quantize::kUint8)
+        .set_default(fake_quantize::kInt8)
+        .describe(
+            "Quantized type the data is rounded to: int8, to the integers in [-127, 127], or "
+            "uint8, to the integers in [0, 255].");
+    DMLC_DECLARE_FIELD(axis)
+        .set_default(dmlc::optional<int>())
+        .describe(
+            "Axis of the channels for one scale per channel, of shape (data.shape[axis],). "
+            "If not set, the scale is of the whole tensor, of shape (1,).");
+  }
+};
+
+/*! \brief bounds of the quantized grid */
+MSHADOW_XINLINE void FakeQuantizeRange(int dtype, float* qmin, float* qmax) {
+  *qmin = dtype == fake_quantize::kInt8 ? -127.0f : 0.0f;
+  *qmax = dtype == fake_quantize::kInt8 ? 127.0f : 255.0f;
+}
+
+/*! \brief out = clip(round(data / scale), qmin, qmax) * scale */
+template <int req>
+struct fake_quantize_forward {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const DType* data,
+                                  const float* scale,
+                                  index_t channels,
+                                  index_t inner,
+                                  int dtype) {
+    float qmin, qmax;
+    FakeQuantizeRange(dtype, &qmin, &qmax);
+    const float s = scale[(i / inner) % channels];
+    const float q = fminf(fmaxf(rintf(static_cast<float>(data[i]) / s), qmin), qmax);
+    KERNEL_ASSIGN(out[i], req, DType(q * s));
+  }
+};
+
+/*!
+ * \brief gradient of the data, passed through within the range of the grid, and the term of
+ *  each element in the gradient of its scale: round(v) - v within the range, the bound outside
+ */
+struct fake_quantize_backward {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* data_grad,
+                                  float* scale_grad_terms,
+                                  const DType* out_grad,
+                                  const DType* data,
+                                  const float* scale,
+                                  index_t channels,
+                                  index_t inner,
+                                  int dtype,
+                                  OpReqType req) {
+    float qmin, qmax;
+    FakeQuantizeRange(dtype, &qmin, &qmax);
+    const float g = static_cast<float>(out_grad[i]);
+    const float v = static_cast<float>(data[i]) / scale[(i / inner) % channels];
+    if (v < qmin) {
+      KERNEL_ASSIGN(data_grad[i], req, DType(0.0f));
+      scale_grad_terms[i] = g * qmin;
+    } else if (v > qmax) {
+      KERNEL_ASSIGN(data_grad[i], req, DType(0.0f));
+      scale_grad_terms[i] = g * qmax;
+    } else {
+      KERNEL_ASSIGN(data_grad[i], req, DType(g));
+      scale_grad_terms[i] = g * (rintf(v) - v);
+    }
+  }
+};
+
+/*! \brief the data seen as (outer, channels, inner), with channels = 1 for a tensor scale */
+inline void FakeQuantizeDims(const FakeQuantizeParam& param,
+                             const mxnet::TShape& dshape,
+                             index_t* outer,
+                             index_t* channels,
+                             index_t* inner) {
+  *outer    = dshape.Size();
+  *channels = 1;
+  *inner    = 1;
+  if (param.axis.has_value()) {
+    const int axis = CheckAxis(param.axis.value(), dshape.ndim());
+    *channels      = dshape[axis];
+    *outer         = dshape.ProdShape(0, axis);
+    *inner         = dshape.ProdShape(axis + 1, dshape.ndim());
+  }
+}
+
+inline bool FakeQuantizeShape(const nnvm::NodeAttrs& attrs,
+                              mxnet::ShapeVector* in_attrs,
+                              mxnet::ShapeVector* out_attrs) {
+  const FakeQuantizeParam& param = nnvm::get<FakeQuantizeParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(fake_quantize::kData));
+  SHAPE_ASSIGN_CHECK(*in_attrs, fake_quantize::kData, out_attrs->at(0));
+  const mxnet::TShape& dshape = in_attrs->at(fake_quantize::kData);
+  if (!param.axis.has_value()) {
+    SHAPE_ASSIGN_CHECK(*in_attrs, fake_quantize::kScale, Shape1(1));
+  } else if (mxnet::ndim_is_known(dshape)) {
+    const int axis = CheckAxis(param.axis.value(), dshape.ndim());
+    if (mxnet::dim_size_is_known(dshape, axis)) {
+      SHAPE_ASSIGN_CHECK(*in_attrs, fake_quantize::kScale, Shape1(dshape[axis]));
+    }
+  }
+  return shape_is_known(dshape) && shape_is_known(in_attrs->at(fake_quantize::kScale));
+}
+
+inline bool FakeQuantizeType(const nnvm::NodeAttrs& attrs,
+                             std::vector<int>* in_attrs,
+                             std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  TYPE_ASSIGN_CHECK(*in_attrs, fake_quantize::kScale, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(fake_quantize::kData));
+  TYPE_ASSIGN_CHECK(*in_attrs, fake_quantize::kData, out_attrs->at(0));
+  return in_attrs->at(fake_quantize::kData) != -1;
+}
+
+template <typename xpu>
+void FakeQuantizeForward(const nnvm::NodeAttrs& attrs,
+                         const OpContext& ctx,
+                         const std::vector<TBlob>& inputs,
+                         const std::vector<OpReqType>& req,
+                         const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const FakeQuantizeParam& param = nnvm::get<FakeQuantizeParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s        = ctx.get_stream<xpu>();
+  const TBlob& data              = inputs[fake_quantize::kData];
+  index_t outer, channels, inner;
+  FakeQuantizeDims(param, data.shape_, &outer, &channels, &inner);
+  MSHADOW_REAL_TYPE_SWITCH(data.type_flag_, DType, {
+    MXNET_ASSIGN_REQ_SWITCH(req[0], Req, {
+      Kernel<fake_quantize_forward<Req>, xpu>::Launch(s,
+                                                      data.shape_.Size(),
+                                                      outputs[0].dptr<DType>(),
+                                                      data.dptr<DType>(),
+                                                      inputs[fake_quantize::kScale].dptr<float>(),
+                                                      channels,
+                                                      inner,
+                                                      param.quantized_dtype);
+    });
+  });
+}
+
+template <typename xpu>
+void FakeQuantizeBackward(const nnvm::NodeAttrs& attrs,
+                          const OpContext& ctx,
+                          const std::vector<TBlob>& inputs,
+                          const std::vector<OpReqType>& req,
+                          const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  using namespace mshadow;
+  const FakeQuantizeParam& param = nnvm::get<FakeQuantizeParam>(attrs.parsed);
+  Stream<xpu>* s                 = ctx.get_stream<xpu>();
+  const TBlob& data              = inputs[fake_quantize::kBwdData];
+  const index_t n                = data.shape_.Size();
+  index_t outer, channels, inner;
+  FakeQuantizeDims(param, data.shape_, &outer, &channels, &inner);
+
+  // the terms of the scale gradient are summed over all but the channel axis
+  const TBlob scale_grad =
+      outputs[fake_quantize::kScaleGrad].reshape(mxnet::TShape({1, channels, 1}));
+  const mxnet::TShape terms_shape({outer, channels, inner});
+  mxnet::TShape src_shape, dst_shape;
+  BroadcastReduceShapeCompact(terms_shape, scale_grad.shape_, &src_shape, &dst_shape);
+  const size_t reduce_ws_size =
+      broadcast::ReduceWorkspaceSize(s, dst_shape, req[fake_quantize::kScaleGrad], src_shape);
+  const size_t terms_size = (n * sizeof(float) + 7) / 8 * 8;
+  Tensor<xpu, 1, char> workspace =
+      ctx.requested[0].get_space_typed<xpu, 1, char>(Shape1(terms_size + reduce_ws_size), s);
+  const TBlob terms(reinterpret_cast<float*>(workspace.dptr_), terms_shape, xpu::kDevMask);
+  Tensor<xpu, 1, char> reduce_ws(workspace.dptr_ + terms_size, Shape1(reduce_ws_size), s);
+
+  MSHADOW_REAL_TYPE_SWITCH(data.type_flag_, DType, {
+    // the terms are needed even when the data gets no gradient
+    Kernel<fake_quantize_backward, xpu>::Launch(s,
+                                                n,
+                                                outputs[fake_quantize::kDataGrad].dptr<DType>(),
+                                                terms.dptr<float>(),
+                                                inputs[fake_quantize::kOutGrad].dptr<DType>(),
+                                                data.dptr<DType>(),
+                                                inputs[fake_quantize::kBwdScale].dptr<float>(),
+                                                channels,
+                                                inner,
+                                                param.quantized_dtype,
+                                                req[fake_quantize::kDataGrad]);
+  });
+  if (req[fake_quantize::kScaleGrad] == kNullOp) {
+    return;
+  }
+#if !defined(__CUDACC__)
+  ReduceAxesComputeImpl<xpu, mshadow::red::sum, false, false>(
+      ctx, {terms}, {req[fake_quantize::kScaleGrad]}, {scale_grad}, scale_grad.shape_, &reduce_ws);
+#else
+  ReduceAxesRTCComputeImpl(ctx,
+                           {terms},
+                           {req[fake_quantize::kScaleGrad]},
+                           {scale_grad},
+                           scale_grad.shape_,
+                           "red::sum{}",
+                           &reduce_ws,
+                           false);
+#endif
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_FAKE_QUANTIZE_INL_H_
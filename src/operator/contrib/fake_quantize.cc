@@ -0,0 +1,82 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fake_quantize.cc
+ * \brief Fake quantization with a learnable scale, CPU implementation
+ */
+#include "./fake_quantize-inl.h"
+#include "../elemwise_op_common.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(FakeQuantizeParam);
+
+NNVM_REGISTER_OP(_contrib_fake_quantize)
+    .add_alias("_npx_fake_quantize")
+    .describe(R"code(Round the data to the int8 or uint8 grid of a learnable scale, for
+quantization-aware training.
+
+Returns ``clip(round(data / scale), qmin, qmax) * scale``, with [qmin, qmax] = [-127, 127] for int8
+and [0, 255] for uint8, the ranges of the quantized operators. The scale is of the whole tensor, or
+of each channel along ``axis``, as for the weights of a convolution with ``axis=0``.
+
+In backward pass, the gradient of the data is the gradient of the output within the range of the
+grid and 0 outside (straight-through estimator). The gradient of the scale is the one of the learned
+step size quantizer: the gradient of the output times ``round(data / scale) - data / scale`` within
+the range, and times the bound outside, summed over each channel.
+
+The range of a trained scale, ``[qmin * scale, qmax * scale]``, is the calibration range of the
+quantized operator, see `mxnet.contrib.quantization.quantize_net` with ``calib_mode='qat'``.
+
+Example::
+  fake_quantize([0.26, -0.31, 20.0], scale=[0.1], quantized_dtype='int8')
+  = [0.3, -0.3, 12.7]
+)code" ADD_FILELINE)
+    .set_attr_parser(ParamParser<FakeQuantizeParam>)
+    .set_num_inputs(2)
+    .set_num_outputs(1)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data", "scale"};
+                                     })
+    .set_attr<mxnet::FInferShape>("FInferShape", FakeQuantizeShape)
+    .set_attr<nnvm::FInferType>("FInferType", FakeQuantizeType)
+    .set_attr<FCompute>("FCompute<cpu>", FakeQuantizeForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", ElemwiseGradUseIn{"_backward_contrib_fake_quantize"})
+    .add_argument("data", "NDArray-or-Symbol", "Input data.")
+    .add_argument("scale",
+                  "NDArray-or-Symbol",
+                  "Scale, float32 of shape (1,), or (data.shape[axis],) with an axis.")
+    .add_arguments(FakeQuantizeParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_contrib_fake_quantize)
+    .set_attr_parser(ParamParser<FakeQuantizeParam>)
+    .set_num_inputs(3)
+    .set_num_outputs(2)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", FakeQuantizeBackward<cpu>);
+
+}  // namespace op
+}  // namespace mxnet
@@ -26,13 +26,18 @@
 #define MXNET_OPERATOR_CONTRIB_FFT_INL_H_
 #include <dmlc/logging.h>
 #include <dmlc/parameter.h>
+#include <cmath>
+#include <complex>
 #include <map>
+#include <memory>
 #include <vector>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <iostream>
 #include "../operator_common.h"
 #include "../mshadow_op.h"
+#include "../mxnet_op.h"
 
 #if MXNET_USE_CUDA
 #include <cufft.h>
@@ -55,16 +60,225 @@ struct FFTParam : public dmlc::Parameter<FFTParam> {
   }
 };
 
-#if MXNET_USE_CUDA
+namespace fft {
+/*!
+ * \brief Plan of the unnormalized complex transforms of a length on the CPU, radix-2 for the
+ *  powers of two and Bluestein's algorithm over a power of two for the other lengths.
+ */
+template <typename AType>
+class CPUPlan {
+ public:
+  typedef std::complex<AType> Complex;
+
+  explicit CPUPlan(index_t n) : n_(n), m_(1) {
+    while (m_ < n)
+      m_ <<= 1;
+    if (m_ != n) {
+      // the convolution with the chirp has 2n - 1 terms
+      while (m_ < 2 * n - 1)
+        m_ <<= 1;
+    }
+    twiddles_.resize(m_ / 2);
+    for (index_t j = 0; j < m_ / 2; ++j) {
+      const double phase = -2.0 * M_PI * j / m_;
+      twiddles_[j]       = Complex(std::cos(phase), std::sin(phase));
+    }
+    if (m_ != n) {
+      chirp_.resize(n);
+      for (index_t k = 0; k < n; ++k) {
+        // k^2 modulo 2n keeps the phase accurate for the long transforms
+        const uint64_t k2  = static_cast<uint64_t>(k) * k % (2 * static_cast<uint64_t>(n));
+        const double phase = -M_PI * k2 / n;
+        chirp_[k]          = Complex(std::cos(phase), std::sin(phase));
+      }
+      kernel_.assign(m_, Complex(0));
+      kernel_[0] = std::conj(chirp_[0]);
+      for (index_t k = 1; k < n; ++k) {
+        kernel_[k] = kernel_[m_ - k] = std::conj(chirp_[k]);
+      }
+      Radix2(kernel_.data(), false);
+    }
+  }
+
+  index_t size() const {
+    return n_;
+  }
+
+  /*! \brief number of complex values of the workspace of Execute */
+  index_t workspace_size() const {
+    return m_ == n_ ? 0 : m_;
+  }
+
+  /*! \brief transform the n values of data in place, forward or inverse */
+  void Execute(Complex* data, bool inverse, Complex* workspace) const {
+    if (m_ == n_) {
+      Radix2(data, inverse);
+      return;
+    }
+    // X_k = chirp_k sum_j (x_j chirp_j) conj(chirp_(k - j)), and the inverse conjugates
+    for (index_t j = 0; j < n_; ++j) {
+      workspace[j] = (inverse ? std::conj(data[j]) : data[j]) * chirp_[j];
+    }
+    std::fill(workspace + n_, workspace + m_, Complex(0));
+    Radix2(workspace, false);
+    for (index_t i = 0; i < m_; ++i) {
+      workspace[i] *= kernel_[i];
+    }
+    Radix2(workspace, true);
+    const AType scale = AType(1) / m_;
+    for (index_t k = 0; k < n_; ++k) {
+      const Complex y = workspace[k] * chirp_[k] * scale;
+      data[k]         = inverse ? std::conj(y) : y;
+    }
+  }
+
+ private:
+  void Radix2(Complex* data, bool inverse) const {
+    for (index_t i = 1, j = 0; i < m_; ++i) {
+      index_t bit = m_ >> 1;
+      for (; j & bit; bit >>= 1)
+        j ^= bit;
+      j ^= bit;
+      if (i < j)
+        std::swap(data[i], data[j]);
+    }
+    for (index_t len = 2; len <= m_; len <<= 1) {
+      const index_t half = len / 2;
+      const index_t step = m_ / len;
+      for (index_t i = 0; i < m_; i += len) {
+        for (index_t j = 0; j < half; ++j) {
+          const Complex w    = inverse ? std::conj(twiddles_[j * step]) : twiddles_[j * step];
+          const Complex u    = data[i + j];
+          const Complex v    = data[i + j + half] * w;
+          data[i + j]        = u + v;
+          data[i + j + half] = u - v;
+        }
+      }
+    }
+  }
+
+  index_t n_, m_;
+  std::vector<Complex> twiddles_, chirp_, kernel_;
+};
+}  // namespace fft
+
 template <typename xpu, typename DType>
-class FFTOp : public Operator {
+class FFTOp;
+
+template <typename DType>
+class FFTOp<cpu, DType> : public Operator {
+ public:
+  // half precision is transformed in single precision
+  typedef typename std::conditional<std::is_same<DType, double>::value, double, float>::type AType;
+  typedef typename fft::CPUPlan<AType>::Complex Complex;
+
+  explicit FFTOp(FFTParam p) : param_(p) {}
+
+  virtual void Forward(const OpContext& ctx,
+                       const std::vector<TBlob>& in_data,
+                       const std::vector<OpReqType>& req,
+                       const std::vector<TBlob>& out_data,
+                       const std::vector<TBlob>& aux_args) {
+    CHECK_EQ(in_data.size(), 1);
+    CHECK_EQ(out_data.size(), 1);
+    const OpReqType out_req = req[fft::kOutComplex];
+    if (out_req == kNullOp)
+      return;
+    const mxnet::TShape& shape      = in_data[fft::kData].shape_;
+    const index_t dim               = shape[shape.ndim() - 1];
+    const index_t n_ffts            = shape.ProdShape(0, shape.ndim() - 1);
+    const fft::CPUPlan<AType>& plan = Plan(dim);
+    const DType* data               = in_data[fft::kData].dptr<DType>();
+    DType* out                      = out_data[fft::kOutComplex].dptr<DType>();
+    const int nthreads              = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel num_threads(nthreads)
+    {
+      std::vector<Complex> row(dim), workspace(plan.workspace_size());
+#pragma omp for
+      for (index_t i = 0; i < n_ffts; ++i) {
+        for (index_t j = 0; j < dim; ++j) {
+          row[j] = Complex(static_cast<AType>(data[i * dim + j]), 0);
+        }
+        plan.Execute(row.data(), false, workspace.data());
+        // the format is [real0, imag0, real1, imag1, ...]
+        for (index_t j = 0; j < dim; ++j) {
+          KERNEL_ASSIGN(out[2 * (i * dim + j)], out_req, static_cast<DType>(row[j].real()));
+          KERNEL_ASSIGN(out[2 * (i * dim + j) + 1], out_req, static_cast<DType>(row[j].imag()));
+        }
+      }
+    }
+  }
+
+  virtual void Backward(const OpContext& ctx,
+                        const std::vector<TBlob>& out_grad,
+                        const std::vector<TBlob>& in_data,
+                        const std::vector<TBlob>& out_data,
+                        const std::vector<OpReqType>& req,
+                        const std::vector<TBlob>& in_grad,
+                        const std::vector<TBlob>& aux_args) {
+    CHECK_EQ(out_grad.size(), 1);
+    CHECK(in_data.size() == 1 && in_grad.size() == 1);
+    CHECK_EQ(req.size(), 1);
+    const OpReqType grad_req = req[fft::kData];
+    if (grad_req == kNullOp)
+      return;
+    const mxnet::TShape& shape      = in_grad[fft::kData].shape_;
+    const index_t dim               = shape[shape.ndim() - 1];
+    const index_t n_ffts            = shape.ProdShape(0, shape.ndim() - 1);
+    const fft::CPUPlan<AType>& plan = Plan(dim);
+    const DType* grad               = out_grad[fft::kOutComplex].dptr<DType>();
+    DType* gdata                    = in_grad[fft::kData].dptr<DType>();
+    const int nthreads              = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+    // the unnormalized inverse transform, keeping the real part as the GPU implementation
+#pragma omp parallel num_threads(nthreads)
+    {
+      std::vector<Complex> row(dim), workspace(plan.workspace_size());
+#pragma omp for
+      for (index_t i = 0; i < n_ffts; ++i) {
+        for (index_t j = 0; j < dim; ++j) {
+          row[j] = Complex(static_cast<AType>(grad[2 * (i * dim + j)]),
+                           static_cast<AType>(grad[2 * (i * dim + j) + 1]));
+        }
+        plan.Execute(row.data(), true, workspace.data());
+        for (index_t j = 0; j < dim; ++j) {
+          KERNEL_ASSIGN(gdata[i * dim + j], grad_req, static_cast<DType>(row[j].real()));
+        }
+      }
+    }
+  }
+
+ private:
+  // the twiddles and chirp of the length are reused while it does not change
+  const fft::CPUPlan<AType>& Plan(index_t dim) {
+    if (plan_ == nullptr || plan_->size() != dim)
+      plan_.reset(new fft::CPUPlan<AType>(dim));
+    return *plan_;
+  }
+
+  FFTParam param_;
+  std::unique_ptr<fft::CPUPlan<AType>> plan_;
+};  // class FFTOp<cpu>
+
+#if MXNET_USE_CUDA
+template <typename DType>
+class FFTOp<gpu, DType> : public Operator {
  public:
+  typedef gpu xpu;
+
   explicit FFTOp(FFTParam p) {
     this->param_ = p;
     init_cufft_  = false;
     dim_         = 0;
   }
 
+  ~FFTOp() {
+    if (init_cufft_) {
+      cufftDestroy(plan_);
+      if (remain_num_ > 0)
+        cufftDestroy(plan_remain_);
+    }
+  }
+
   virtual void Forward(const OpContext& ctx,
                        const std::vector<TBlob>& in_data,
                        const std::vector<OpReqType>& req,
@@ -75,20 +289,8 @@ class FFTOp : public Operator {
     CHECK_EQ(in_data.size(), 1);
     CHECK_EQ(out_data.size(), 1);
 
-    // the last dimention should be the dimension of fft vector
-    if (!init_cufft_) {
-      n_ffts = in_data[fft::kData].shape_.ProdShape(0, in_data[fft::kData].ndim() - 1);
-      dim_   = in_data[fft::kData].shape_[in_data[fft::kData].ndim() - 1];
-
-      stride_ = param_.compute_size * dim_;
-
-      init_cufft_ = true;
-
-      // will handle the (possibly) incomplete group later
-      num_compute = n_ffts / param_.compute_size;
-    }
-
     Stream<xpu>* s = ctx.get_stream<xpu>();
+    Init(in_data[fft::kData].shape_, s);
     // const mxnet::TShape& oshape = out_data[fft::kOutComplex].shape_;
     Tensor<xpu, 2, DType> data =
         in_data[fft::kData].get_with_shape<xpu, 2, DType>(Shape2(n_ffts, dim_), s);
@@ -101,8 +303,6 @@ class FFTOp : public Operator {
     Tensor<xpu, 2, DType> complex_data =
         Tensor<xpu, 2, DType>(workspace.dptr_, Shape2(param_.compute_size, dim_ * 2), s);
     // start fft
-    cufftHandle plan;
-    cufftPlanMany(&plan, 1, &dim_, nullptr, 0, 0, nullptr, 0, 0, CUFFT_C2C, param_.compute_size);
     for (size_t idx = 0; idx < num_compute; ++idx) {
       complex_data = complex_pad_imag(
           data.Slice(idx * param_.compute_size, idx * param_.compute_size + param_.compute_size));
@@ -110,16 +310,12 @@ class FFTOp : public Operator {
       cufftComplex* in_tmp =
           const_cast<cufftComplex*>(reinterpret_cast<const cufftComplex*>(complex_data.dptr_));
       cufftComplex* out_tmp = reinterpret_cast<cufftComplex*>(out.dptr_ + 2 * idx * stride_);
-      CHECK_EQ(cufftExecC2C(plan, in_tmp, out_tmp, CUFFT_FORWARD), CUFFT_SUCCESS);
+      CHECK_EQ(cufftExecC2C(plan_, in_tmp, out_tmp, CUFFT_FORWARD), CUFFT_SUCCESS);
     }
-    cufftDestroy(plan);
 
     // handle the remaining samples
-    size_t remain_num = n_ffts - param_.compute_size * num_compute;
+    const size_t remain_num = remain_num_;
     if (remain_num > 0) {
-      cufftHandle plan_remain;
-      cufftPlanMany(&plan_remain, 1, &dim_, nullptr, 0, 0, nullptr, 0, 0, CUFFT_C2C, remain_num);
-
       complex_data = Tensor<xpu, 2, DType>(workspace.dptr_, Shape2(remain_num, dim_ * 2), s);
       complex_data = complex_pad_imag(data.Slice(num_compute * param_.compute_size,
                                                  num_compute * param_.compute_size + remain_num));
@@ -128,8 +324,7 @@ class FFTOp : public Operator {
           const_cast<cufftComplex*>(reinterpret_cast<const cufftComplex*>(complex_data.dptr_));
       cufftComplex* out_tmp =
           reinterpret_cast<cufftComplex*>(out.dptr_ + 2 * num_compute * stride_);
-      CHECK_EQ(cufftExecC2C(plan_remain, in_tmp, out_tmp, CUFFT_FORWARD), CUFFT_SUCCESS);
-      cufftDestroy(plan_remain);
+      CHECK_EQ(cufftExecC2C(plan_remain_, in_tmp, out_tmp, CUFFT_FORWARD), CUFFT_SUCCESS);
     }
   }
 
@@ -147,6 +342,7 @@ class FFTOp : public Operator {
     CHECK_EQ(req.size(), 1);
 
     Stream<xpu>* s = ctx.get_stream<xpu>();
+    Init(in_grad[fft::kData].shape_, s);
 
     Tensor<xpu, 2, DType> gdata =
         in_grad[fft::kData].get_with_shape<xpu, 2, DType>(Shape2(n_ffts, dim_), s);
@@ -162,37 +358,31 @@ class FFTOp : public Operator {
     // In this solution, out_grad must comes from a fft of real signal,
     // so that it is Hermitian symmetric, giving a real output
     // but if it is not, remember that we have implemented complex_take_real, and use this
-    cufftHandle plan;
-    cufftPlanMany(&plan, 1, &dim_, nullptr, 0, 0, nullptr, 0, 0, CUFFT_C2C, param_.compute_size);
     for (size_t idx = 0; idx < num_compute; ++idx) {
       cufftComplex* in_tmp = const_cast<cufftComplex*>(
           reinterpret_cast<const cufftComplex*>(grad.dptr_ + 2 * idx * stride_));
       cufftComplex* out_tmp = reinterpret_cast<cufftComplex*>(complex_data.dptr_);
-      CHECK_EQ(cufftExecC2C(plan, in_tmp, out_tmp, CUFFT_INVERSE), CUFFT_SUCCESS);
+      CHECK_EQ(cufftExecC2C(plan_, in_tmp, out_tmp, CUFFT_INVERSE), CUFFT_SUCCESS);
 
       Assign(gdata.Slice(idx * param_.compute_size, (idx + 1) * param_.compute_size),
              req[fft::kData],
              complex_toreal(complex_data));
     }
-    cufftDestroy(plan);
 
     // handle the remaining samples
-    size_t remain_num = n_ffts - param_.compute_size * num_compute;
+    const size_t remain_num = remain_num_;
     if (remain_num > 0) {
-      cufftHandle plan_remain;
-      cufftPlanMany(&plan_remain, 1, &dim_, nullptr, 0, 0, nullptr, 0, 0, CUFFT_C2C, remain_num);
       complex_data = Tensor<xpu, 2, DType>(workspace.dptr_, Shape2(remain_num, dim_ * 2), s);
 
       cufftComplex* in_tmp = const_cast<cufftComplex*>(
           reinterpret_cast<const cufftComplex*>(grad.dptr_ + 2 * num_compute * stride_));
       cufftComplex* out_tmp = reinterpret_cast<cufftComplex*>(complex_data.dptr_);
-      CHECK_EQ(cufftExecC2C(plan_remain, in_tmp, out_tmp, CUFFT_INVERSE), CUFFT_SUCCESS);
+      CHECK_EQ(cufftExecC2C(plan_remain_, in_tmp, out_tmp, CUFFT_INVERSE), CUFFT_SUCCESS);
 
       Assign(gdata.Slice(param_.compute_size * num_compute,
                          param_.compute_size * num_compute + remain_num),
              req[fft::kData],
              complex_toreal(complex_data));
-      cufftDestroy(plan_remain);
     }
     // for bp, we should not divide it
     // but for comparison with np.fft.ifft, we should do it.
@@ -200,9 +390,38 @@ class FFTOp : public Operator {
   }
 
  private:
+  // the shape is fixed by the first call, whose plans are reused on the stream of each call
+  void Init(const mxnet::TShape& shape, mshadow::Stream<xpu>* s) {
+    if (!init_cufft_) {
+      // the last dimention should be the dimension of fft vector
+      n_ffts  = shape.ProdShape(0, shape.ndim() - 1);
+      dim_    = shape[shape.ndim() - 1];
+      stride_ = param_.compute_size * dim_;
+      // will handle the (possibly) incomplete group later
+      num_compute = n_ffts / param_.compute_size;
+      remain_num_ = n_ffts - param_.compute_size * num_compute;
+
+      CHECK_EQ(cufftPlanMany(
+                   &plan_, 1, &dim_, nullptr, 0, 0, nullptr, 0, 0, CUFFT_C2C, param_.compute_size),
+               CUFFT_SUCCESS);
+      if (remain_num_ > 0) {
+        CHECK_EQ(
+            cufftPlanMany(
+                &plan_remain_, 1, &dim_, nullptr, 0, 0, nullptr, 0, 0, CUFFT_C2C, remain_num_),
+            CUFFT_SUCCESS);
+      }
+      init_cufft_ = true;
+    }
+    cudaStream_t stream = mshadow::Stream<xpu>::GetStream(s);
+    CHECK_EQ(cufftSetStream(plan_, stream), CUFFT_SUCCESS);
+    if (remain_num_ > 0)
+      CHECK_EQ(cufftSetStream(plan_remain_, stream), CUFFT_SUCCESS);
+  }
+
   FFTParam param_;
   int dim_, stride_, n_ffts;
-  size_t num_compute;
+  size_t num_compute, remain_num_;
+  cufftHandle plan_, plan_remain_;
   bool init_cufft_;
 };      // class FFTOp
 #endif  // MXNET_USE_CUDA
@@ -28,8 +28,9 @@ namespace mxnet {
 namespace op {
 template <>
 Operator* CreateOp<cpu>(FFTParam param, int dtype) {
-  LOG(FATAL) << "fft is only available for GPU.";
-  return nullptr;
+  Operator* op = nullptr;
+  MSHADOW_REAL_TYPE_SWITCH(dtype, DType, { op = new FFTOp<cpu, DType>(param); })
+  return op;
 }
 
 Operator* FFTProp::CreateOperatorEx(Context ctx,
@@ -43,7 +44,8 @@ DMLC_REGISTER_PARAMETER(FFTParam);
 MXNET_REGISTER_OP_PROPERTY(_contrib_fft, FFTProp)
     .describe(R"code(Apply 1D FFT to input"
 
-.. note:: `fft` is only available on GPU.
+.. note:: On GPU `fft` uses cuFFT. On CPU the lengths which are not powers of two are
+   transformed with Bluestein's algorithm, and `compute_size` is ignored.
 
 Currently accept 2 input data shapes: (N, d) or (N1, N2, N3, d), data can only be real numbers.
 The output data has shape: (N, 2*d) or (N1, N2, N3, 2*d). The format is: [real0, imag0, real1, imag1, ...].
@@ -0,0 +1,728 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file flat_optimizer-inl.h
+ * \brief Optimizer updates of a group of tensors stored in one flat buffer: the weights,
+ *  gradients and states of the tensors are contiguous, tensor k holding the elements in
+ *  [offsets[k], offsets[k + 1]), and the whole group is updated by a single kernel with the
+ *  learning rate and weight decay of each tensor
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_FLAT_OPTIMIZER_INL_H_
+#define MXNET_OPERATOR_CONTRIB_FLAT_OPTIMIZER_INL_H_
+
+#include <dmlc/parameter.h>
+#include <mxnet/operator_util.h>
+#include <algorithm>
+#include <vector>
+#include "../elemwise_op_common.h"
+#include "../mshadow_op.h"
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+
+namespace mxnet {
+namespace op {
+
+struct FlatSGDParam : public dmlc::Parameter<FlatSGDParam> {
+  float rescale_grad;
+  float clip_gradient;
+  DMLC_DECLARE_PARAMETER(FlatSGDParam) {
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+        .set_default(-1.0f)
+        .describe(
+            "Clip gradient to the range of [-clip_gradient, clip_gradient] "
+            "If clip_gradient <= 0, gradient clipping is turned off. "
+            "grad = max(min(grad, clip_gradient), -clip_gradient).");
+  }
+};
+
+struct FlatSGDMomParam : public dmlc::Parameter<FlatSGDMomParam> {
+  float momentum;
+  float rescale_grad;
+  float clip_gradient;
+  DMLC_DECLARE_PARAMETER(FlatSGDMomParam) {
+    DMLC_DECLARE_FIELD(momentum).set_default(0.0f).describe(
+        "The decay rate of momentum estimates at each epoch.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+        .set_default(-1.0f)
+        .describe(
+            "Clip gradient to the range of [-clip_gradient, clip_gradient] "
+            "If clip_gradient <= 0, gradient clipping is turned off. "
+            "grad = max(min(grad, clip_gradient), -clip_gradient).");
+  }
+};
+
+struct FlatAdamParam : public dmlc::Parameter<FlatAdamParam> {
+  float beta1;
+  float beta2;
+  float epsilon;
+  float rescale_grad;
+  float clip_gradient;
+  DMLC_DECLARE_PARAMETER(FlatAdamParam) {
+    DMLC_DECLARE_FIELD(beta1).set_default(0.9f).describe(
+        "The decay rate for the 1st moment estimates.");
+    DMLC_DECLARE_FIELD(beta2).set_default(0.999f).describe(
+        "The decay rate for the 2nd moment estimates.");
+    DMLC_DECLARE_FIELD(epsilon).set_default(1e-8f).describe(
+        "A small constant for numerical stability.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+        .set_default(-1.0f)
+        .describe(
+            "Clip gradient to the range of [-clip_gradient, clip_gradient] "
+            "If clip_gradient <= 0, gradient clipping is turned off. "
+            "grad = max(min(grad, clip_gradient), -clip_gradient).");
+  }
+};
+
+struct FlatRMSPropParam : public dmlc::Parameter<FlatRMSPropParam> {
+  float rho;
+  float epsilon;
+  float rescale_grad;
+  float clip_gradient;
+  float clip_weights;
+  DMLC_DECLARE_PARAMETER(FlatRMSPropParam) {
+    DMLC_DECLARE_FIELD(rho).set_default(0.95f).describe("The decay rate of momentum estimates.");
+    DMLC_DECLARE_FIELD(epsilon).set_default(1e-8f).describe(
+        "A small constant for numerical stability.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+        .set_default(-1.0f)
+        .describe(
+            "Clip gradient to the range of [-clip_gradient, clip_gradient] "
+            "If clip_gradient <= 0, gradient clipping is turned off. "
+            "grad = max(min(grad, clip_gradient), -clip_gradient).");
+    DMLC_DECLARE_FIELD(clip_weights)
+        .set_default(-1.0f)
+        .describe(
+            "Clip weights to the range of [-clip_weights, clip_weights] "
+            "If clip_weights <= 0, weight clipping is turned off. "
+            "weights = max(min(weights, clip_weights), -clip_weights).");
+  }
+};
+
+struct FlatRMSPropAlexParam : public dmlc::Parameter<FlatRMSPropAlexParam> {
+  float rho;
+  float momentum;
+  float epsilon;
+  float rescale_grad;
+  float clip_gradient;
+  float clip_weights;
+  DMLC_DECLARE_PARAMETER(FlatRMSPropAlexParam) {
+    DMLC_DECLARE_FIELD(rho).set_default(0.95f).describe("Decay rate.");
+    DMLC_DECLARE_FIELD(momentum).set_default(0.9f).describe("Decay rate.");
+    DMLC_DECLARE_FIELD(epsilon).set_default(1e-8f).describe(
+        "A small constant for numerical stability.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+        .set_default(-1.0f)
+        .describe(
+            "Clip gradient to the range of [-clip_gradient, clip_gradient] "
+            "If clip_gradient <= 0, gradient clipping is turned off. "
+            "grad = max(min(grad, clip_gradient), -clip_gradient).");
+    DMLC_DECLARE_FIELD(clip_weights)
+        .set_default(-1.0f)
+        .describe(
+            "Clip weights to the range of [-clip_weights, clip_weights] "
+            "If clip_weights <= 0, weight clipping is turned off. "
+            "weights = max(min(weights, clip_weights), -clip_weights).");
+  }
+};
+
+struct FlatFTMLParam : public dmlc::Parameter<FlatFTMLParam> {
+  float beta1;
+  float beta2;
+  float epsilon;
+  float rescale_grad;
+  float clip_gradient;
+  DMLC_DECLARE_PARAMETER(FlatFTMLParam) {
+    DMLC_DECLARE_FIELD(beta1)
+        .set_default(0.6f)
+        .set_range(0.0f, 1.0f)
+        .describe("Generally close to 0.5.");
+    DMLC_DECLARE_FIELD(beta2)
+        .set_default(0.999f)
+        .set_range(0.0f, 1.0f)
+        .describe("Generally close to 1.");
+    DMLC_DECLARE_FIELD(epsilon).set_default(1e-8f).describe("Epsilon to prevent div 0.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+        .set_default(-1.0f)
+        .describe(
+            "Clip gradient to the range of [-clip_gradient, clip_gradient] "
+            "If clip_gradient <= 0, gradient clipping is turned off. "
+            "grad = max(min(grad, clip_gradient), -clip_gradient).");
+  }
+};
+
+struct FlatAdaGradParam : public dmlc::Parameter<FlatAdaGradParam> {
+  float epsilon;
+  float rescale_grad;
+  float clip_gradient;
+  DMLC_DECLARE_PARAMETER(FlatAdaGradParam) {
+    DMLC_DECLARE_FIELD(epsilon).set_default(1e-6f).describe(
+        "A small constant for numerical stability.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+        .set_default(-1.0f)
+        .describe(
+            "Clip gradient to the range of [-clip_gradient, clip_gradient] "
+            "If clip_gradient <= 0, gradient clipping is turned off. "
+            "grad = max(min(grad, clip_gradient), -clip_gradient).");
+  }
+};
+
+/*!
+ * \brief Shape inference of a flat update: the weight, gradient and states share one shape,
+ *  the per-tensor inputs (learning rates, weight decays and update counts) are of shape
+ *  (num_tensors,) and the offsets, the last input, of shape (num_tensors + 1,)
+ */
+template <int num_flat, int num_per_tensor>
+inline bool FlatUpdateShape(const nnvm::NodeAttrs& attrs,
+                            mxnet::ShapeVector* in_attrs,
+                            mxnet::ShapeVector* out_attrs) {
+  CHECK_EQ(in_attrs->size(), num_flat + num_per_tensor + 1);
+  CHECK_EQ(out_attrs->size(), 1U);
+  mxnet::ShapeVector flat_attrs(in_attrs->begin(), in_attrs->begin() + num_flat);
+  const bool flat_inferred = ElemwiseShape<num_flat, 1>(attrs, &flat_attrs, out_attrs);
+  std::copy(flat_attrs.begin(), flat_attrs.end(), in_attrs->begin());
+
+  const mxnet::TShape& offsets = in_attrs->at(num_flat + num_per_tensor);
+  if (!mxnet::shape_is_known(offsets)) {
+    return false;
+  }
+  CHECK_EQ(offsets.ndim(), 1) << "offsets must be a 1D array of size num_tensors + 1";
+  CHECK_GE(offsets[0], 2) << "offsets must hold the start and end of at least one tensor";
+  for (int i = 0; i < num_per_tensor; ++i) {
+    SHAPE_ASSIGN_CHECK(*in_attrs, num_flat + i, Shape1(offsets[0] - 1));
+  }
+  return flat_inferred;
+}
+
+template <int num_flat, int num_per_tensor>
+inline bool FlatUpdateType(const nnvm::NodeAttrs& attrs,
+                           std::vector<int>* in_attrs,
+                           std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), num_flat + num_per_tensor + 1);
+  CHECK_EQ(out_attrs->size(), 1U);
+  std::vector<int> flat_attrs(in_attrs->begin(), in_attrs->begin() + num_flat);
+  const bool flat_inferred = ElemwiseType<num_flat, 1>(attrs, &flat_attrs, out_attrs);
+  std::copy(flat_attrs.begin(), flat_attrs.end(), in_attrs->begin());
+  for (int i = 0; i < num_per_tensor; ++i) {
+    TYPE_ASSIGN_CHECK(*in_attrs, num_flat + i, mshadow::kFloat32);
+  }
+  TYPE_ASSIGN_CHECK(*in_attrs, num_flat + num_per_tensor, mshadow::kInt64);
+  return flat_inferred;
+}
+
+/*!
+ * \brief index of the tensor holding the element i of the flat buffer, the last k with
+ *  offsets[k] <= i, so that empty tensors are skipped
+ */
+MSHADOW_XINLINE index_t FlatTensorIndex(const int64_t* offsets, index_t num_tensors, index_t i) {
+  index_t lo = 0;
+  index_t hi = num_tensors - 1;
+  while (lo < hi) {
+    const index_t mid = (lo + hi + 1) / 2;
+    if (offsets[mid] <= i) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return lo;
+}
+
+/*! \brief rescaled and clipped gradient with the weight decay of its tensor */
+template <typename DType>
+MSHADOW_XINLINE DType FlatRescaleGrad(const DType grad,
+                                      const DType weight,
+                                      const DType wd,
+                                      const DType rescale_grad,
+                                      const DType clip_gradient) {
+  DType grad_rescaled = rescale_grad * grad;
+  if (clip_gradient >= 0.0f) {
+    grad_rescaled = mshadow_op::clip::Map(grad_rescaled, clip_gradient);
+  }
+  return grad_rescaled + wd * weight;
+}
+
+struct FlatSGDKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out_data,
+                                  const DType* weight_data,
+                                  const DType* grad_data,
+                                  const float* lrs,
+                                  const float* wds,
+                                  const int64_t* offsets,
+                                  const index_t num_tensors,
+                                  const DType rescale_grad,
+                                  const DType clip_gradient,
+                                  const OpReqType req) {
+    const index_t k = FlatTensorIndex(offsets, num_tensors, i);
+    const DType lr  = static_cast<DType>(lrs[k]);
+    const DType grad_rescaled =
+        FlatRescaleGrad(grad_data[i], weight_data[i], DType(wds[k]), rescale_grad, clip_gradient);
+    KERNEL_ASSIGN(out_data[i], req, weight_data[i] - lr * grad_rescaled);
+  }
+};
+
+struct FlatSGDMomKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out_data,
+                                  DType* mom_data,
+                                  const DType* weight_data,
+                                  const DType* grad_data,
+                                  const float* lrs,
+                                  const float* wds,
+                                  const int64_t* offsets,
+                                  const index_t num_tensors,
+                                  const DType momentum,
+                                  const DType rescale_grad,
+                                  const DType clip_gradient,
+                                  const OpReqType req) {
+    const index_t k = FlatTensorIndex(offsets, num_tensors, i);
+    const DType lr  = static_cast<DType>(lrs[k]);
+    const DType grad_rescaled =
+        FlatRescaleGrad(grad_data[i], weight_data[i], DType(wds[k]), rescale_grad, clip_gradient);
+    mom_data[i] = momentum * mom_data[i] - lr * grad_rescaled;
+    KERNEL_ASSIGN(out_data[i], req, weight_data[i] + mom_data[i]);
+  }
+};
+
+struct FlatNAGMomKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out_data,
+                                  DType* mom_data,
+                                  const DType* weight_data,
+                                  const DType* grad_data,
+                                  const float* lrs,
+                                  const float* wds,
+                                  const int64_t* offsets,
+                                  const index_t num_tensors,
+                                  const DType momentum,
+                                  const DType rescale_grad,
+                                  const DType clip_gradient,
+                                  const OpReqType req) {
+    const index_t k = FlatTensorIndex(offsets, num_tensors, i);
+    const DType lr  = static_cast<DType>(lrs[k]);
+    const DType grad_rescaled =
+        FlatRescaleGrad(grad_data[i], weight_data[i], DType(wds[k]), rescale_grad, clip_gradient);
+    mom_data[i] = momentum * mom_data[i] - lr * grad_rescaled;
+    KERNEL_ASSIGN(
+        out_data[i], req, weight_data[i] + momentum * mom_data[i] - lr * grad_rescaled);
+  }
+};
+
+/*! \brief Adam update, the bias correction is folded into the learning rates */
+struct FlatAdamKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out_data,
+                                  DType* mean_data,
+                                  DType* var_data,
+                                  const DType* weight_data,
+                                  const DType* grad_data,
+                                  const float* lrs,
+                                  const float* wds,
+                                  const int64_t* offsets,
+                                  const index_t num_tensors,
+                                  const DType beta1,
+                                  const DType beta2,
+                                  const DType epsilon,
+                                  const DType rescale_grad,
+                                  const DType clip_gradient,
+                                  const OpReqType req) {
+    using namespace mshadow_op;
+    const index_t k = FlatTensorIndex(offsets, num_tensors, i);
+    const DType lr  = static_cast<DType>(lrs[k]);
+    const DType grad_rescaled =
+        FlatRescaleGrad(grad_data[i], weight_data[i], DType(wds[k]), rescale_grad, clip_gradient);
+    mean_data[i] = beta1 * mean_data[i] + (1.f - beta1) * grad_rescaled;
+    var_data[i]  = beta2 * var_data[i] + (1.f - beta2) * grad_rescaled * grad_rescaled;
+    KERNEL_ASSIGN(out_data[i],
+                  req,
+                  weight_data[i] - lr * mean_data[i] / (square_root::Map(var_data[i]) + epsilon));
+  }
+};
+
+struct FlatRMSPropKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out_data,
+                                  DType* state_n_data,
+                                  const DType* weight_data,
+                                  const DType* grad_data,
+                                  const float* lrs,
+                                  const float* wds,
+                                  const int64_t* offsets,
+                                  const index_t num_tensors,
+                                  const DType rho,
+                                  const DType epsilon,
+                                  const DType rescale_grad,
+                                  const DType clip_gradient,
+                                  const DType clip_weights,
+                                  const OpReqType req) {
+    using namespace mshadow_op;
+    const index_t k = FlatTensorIndex(offsets, num_tensors, i);
+    const DType lr  = static_cast<DType>(lrs[k]);
+    const DType grad_rescaled =
+        FlatRescaleGrad(grad_data[i], weight_data[i], DType(wds[k]), rescale_grad, clip_gradient);
+    state_n_data[i] = (1.f - rho) * square::Map(grad_rescaled) + rho * state_n_data[i];
+    DType weight =
+        weight_data[i] - lr * grad_rescaled / (square_root::Map(state_n_data[i]) + epsilon);
+    if (clip_weights >= 0.0f) {
+      weight = clip::Map(weight, clip_weights);
+    }
+    KERNEL_ASSIGN(out_data[i], req, weight);
+  }
+};
+
+struct FlatRMSPropAlexKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out_data,
+                                  DType* state_n_data,
+                                  DType* state_g_data,
+                                  DType* delta_data,
+                                  const DType* weight_data,
+                                  const DType* grad_data,
+                                  const float* lrs,
+                                  const float* wds,
+                                  const int64_t* offsets,
+                                  const index_t num_tensors,
+                                  const DType rho,
+                                  const DType momentum,
+                                  const DType epsilon,
+                                  const DType rescale_grad,
+                                  const DType clip_gradient,
+                                  const DType clip_weights,
+                                  const OpReqType req) {
+    using namespace mshadow_op;
+    const index_t k = FlatTensorIndex(offsets, num_tensors, i);
+    const DType lr  = static_cast<DType>(lrs[k]);
+    const DType grad_rescaled =
+        FlatRescaleGrad(grad_data[i], weight_data[i], DType(wds[k]), rescale_grad, clip_gradient);
+    state_n_data[i] = (1.f - rho) * square::Map(grad_rescaled) + rho * state_n_data[i];
+    state_g_data[i] = (1.f - rho) * grad_rescaled + rho * state_g_data[i];
+    delta_data[i]   = momentum * delta_data[i] -
+                    lr * grad_rescaled /
+                        square_root::Map(state_n_data[i] - square::Map(state_g_data[i]) + epsilon);
+    DType weight = weight_data[i] + delta_data[i];
+    if (clip_weights >= 0.0f) {
+      weight = clip::Map(weight, clip_weights);
+    }
+    KERNEL_ASSIGN(out_data[i], req, weight);
+  }
+};
+
+struct FlatFTMLKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out_data,
+                                  DType* d_data,
+                                  DType* v_data,
+                                  DType* z_data,
+                                  const DType* weight_data,
+                                  const DType* grad_data,
+                                  const float* lrs,
+                                  const float* wds,
+                                  const float* ts,
+                                  const int64_t* offsets,
+                                  const index_t num_tensors,
+                                  const DType beta1,
+                                  const DType beta2,
+                                  const DType epsilon,
+                                  const DType rescale_grad,
+                                  const DType clip_gradient,
+                                  const OpReqType req) {
+    using namespace mshadow_op;
+    const index_t k = FlatTensorIndex(offsets, num_tensors, i);
+    const DType lr  = static_cast<DType>(lrs[k]);
+    const DType t   = static_cast<DType>(ts[k]);
+    const DType grad_rescaled =
+        FlatRescaleGrad(grad_data[i], weight_data[i], DType(wds[k]), rescale_grad, clip_gradient);
+    v_data[i]       = beta2 * v_data[i] + (1 - beta2) * square::Map(grad_rescaled);
+    const DType d_t = (1 - power::Map(beta1, t)) / lr *
+                      (square_root::Map(v_data[i] / (1 - power::Map(beta2, t))) + epsilon);
+    z_data[i] = beta1 * z_data[i] + (1 - beta1) * grad_rescaled -
+                (d_t - beta1 * d_data[i]) * weight_data[i];
+    d_data[i] = d_t;
+    KERNEL_ASSIGN(out_data[i], req, -z_data[i] / d_t);
+  }
+};
+
+struct FlatAdaGradKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out_data,
+                                  DType* history_data,
+                                  const DType* weight_data,
+                                  const DType* grad_data,
+                                  const float* lrs,
+                                  const float* wds,
+                                  const int64_t* offsets,
+                                  const index_t num_tensors,
+                                  const DType epsilon,
+                                  const DType rescale_grad,
+                                  const DType clip_gradient,
+                                  const OpReqType req) {
+    using namespace mshadow_op;
+    const index_t k = FlatTensorIndex(offsets, num_tensors, i);
+    const DType lr  = static_cast<DType>(lrs[k]);
+    const DType grad_rescaled =
+        FlatRescaleGrad(grad_data[i], weight_data[i], DType(wds[k]), rescale_grad, clip_gradient);
+    history_data[i] += square::Map(grad_rescaled);
+    KERNEL_ASSIGN(out_data[i],
+                  req,
+                  weight_data[i] - lr * grad_rescaled /
+                                       (square_root::Map(history_data[i]) + epsilon));
+  }
+};
+
+/*! \brief number of tensors of the group, from the offsets given as the last input */
+inline index_t FlatNumTensors(const std::vector<TBlob>& inputs) {
+  return static_cast<index_t>(inputs.back().Size()) - 1;
+}
+
+template <typename xpu>
+inline void FlatSGDUpdate(const nnvm::NodeAttrs& attrs,
+                          const OpContext& ctx,
+                          const std::vector<TBlob>& inputs,
+                          const std::vector<OpReqType>& req,
+                          const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const FlatSGDParam& param = nnvm::get<FlatSGDParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s   = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    Kernel<FlatSGDKernel, xpu>::Launch(s,
+                                       inputs[0].Size(),
+                                       outputs[0].dptr<DType>(),
+                                       inputs[0].dptr<DType>(),
+                                       inputs[1].dptr<DType>(),
+                                       inputs[2].dptr<float>(),
+                                       inputs[3].dptr<float>(),
+                                       inputs[4].dptr<int64_t>(),
+                                       FlatNumTensors(inputs),
+                                       static_cast<DType>(param.rescale_grad),
+                                       static_cast<DType>(param.clip_gradient),
+                                       req[0]);
+  });
+}
+
+template <typename xpu, typename MomKernel>
+inline void FlatMomUpdate(const nnvm::NodeAttrs& attrs,
+                          const OpContext& ctx,
+                          const std::vector<TBlob>& inputs,
+                          const std::vector<OpReqType>& req,
+                          const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const FlatSGDMomParam& param = nnvm::get<FlatSGDMomParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s      = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    Kernel<MomKernel, xpu>::Launch(s,
+                                   inputs[0].Size(),
+                                   outputs[0].dptr<DType>(),
+                                   inputs[2].dptr<DType>(),
+                                   inputs[0].dptr<DType>(),
+                                   inputs[1].dptr<DType>(),
+                                   inputs[3].dptr<float>(),
+                                   inputs[4].dptr<float>(),
+                                   inputs[5].dptr<int64_t>(),
+                                   FlatNumTensors(inputs),
+                                   static_cast<DType>(param.momentum),
+                                   static_cast<DType>(param.rescale_grad),
+                                   static_cast<DType>(param.clip_gradient),
+                                   req[0]);
+  });
+}
+
+template <typename xpu>
+inline void FlatAdamUpdate(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const FlatAdamParam& param = nnvm::get<FlatAdamParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s    = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    Kernel<FlatAdamKernel, xpu>::Launch(s,
+                                        inputs[0].Size(),
+                                        outputs[0].dptr<DType>(),
+                                        inputs[2].dptr<DType>(),
+                                        inputs[3].dptr<DType>(),
+                                        inputs[0].dptr<DType>(),
+                                        inputs[1].dptr<DType>(),
+                                        inputs[4].dptr<float>(),
+                                        inputs[5].dptr<float>(),
+                                        inputs[6].dptr<int64_t>(),
+                                        FlatNumTensors(inputs),
+                                        static_cast<DType>(param.beta1),
+                                        static_cast<DType>(param.beta2),
+                                        static_cast<DType>(param.epsilon),
+                                        static_cast<DType>(param.rescale_grad),
+                                        static_cast<DType>(param.clip_gradient),
+                                        req[0]);
+  });
+}
+
+template <typename xpu>
+inline void FlatRMSPropUpdate(const nnvm::NodeAttrs& attrs,
+                              const OpContext& ctx,
+                              const std::vector<TBlob>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const FlatRMSPropParam& param = nnvm::get<FlatRMSPropParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s       = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    Kernel<FlatRMSPropKernel, xpu>::Launch(s,
+                                           inputs[0].Size(),
+                                           outputs[0].dptr<DType>(),
+                                           inputs[2].dptr<DType>(),
+                                           inputs[0].dptr<DType>(),
+                                           inputs[1].dptr<DType>(),
+                                           inputs[3].dptr<float>(),
+                                           inputs[4].dptr<float>(),
+                                           inputs[5].dptr<int64_t>(),
+                                           FlatNumTensors(inputs),
+                                           static_cast<DType>(param.rho),
+                                           static_cast<DType>(param.epsilon),
+                                           static_cast<DType>(param.rescale_grad),
+                                           static_cast<DType>(param.clip_gradient),
+                                           static_cast<DType>(param.clip_weights),
+                                           req[0]);
+  });
+}
+
+template <typename xpu>
+inline void FlatRMSPropAlexUpdate(const nnvm::NodeAttrs& attrs,
+                                  const OpContext& ctx,
+                                  const std::vector<TBlob>& inputs,
+                                  const std::vector<OpReqType>& req,
+                                  const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const FlatRMSPropAlexParam& param = nnvm::get<FlatRMSPropAlexParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s           = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    Kernel<FlatRMSPropAlexKernel, xpu>::Launch(s,
+                                               inputs[0].Size(),
+                                               outputs[0].dptr<DType>(),
+                                               inputs[2].dptr<DType>(),
+                                               inputs[3].dptr<DType>(),
+                                               inputs[4].dptr<DType>(),
+                                               inputs[0].dptr<DType>(),
+                                               inputs[1].dptr<DType>(),
+                                               inputs[5].dptr<float>(),
+                                               inputs[6].dptr<float>(),
+                                               inputs[7].dptr<int64_t>(),
+                                               FlatNumTensors(inputs),
+                                               static_cast<DType>(param.rho),
+                                               static_cast<DType>(param.momentum),
+                                               static_cast<DType>(param.epsilon),
+                                               static_cast<DType>(param.rescale_grad),
+                                               static_cast<DType>(param.clip_gradient),
+                                               static_cast<DType>(param.clip_weights),
+                                               req[0]);
+  });
+}
+
+template <typename xpu>
+inline void FlatFTMLUpdate(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const FlatFTMLParam& param = nnvm::get<FlatFTMLParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s    = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    Kernel<FlatFTMLKernel, xpu>::Launch(s,
+                                        inputs[0].Size(),
+                                        outputs[0].dptr<DType>(),
+                                        inputs[2].dptr<DType>(),
+                                        inputs[3].dptr<DType>(),
+                                        inputs[4].dptr<DType>(),
+                                        inputs[0].dptr<DType>(),
+                                        inputs[1].dptr<DType>(),
+                                        inputs[5].dptr<float>(),
+                                        inputs[6].dptr<float>(),
+                                        inputs[7].dptr<float>(),
+                                        inputs[8].dptr<int64_t>(),
+                                        FlatNumTensors(inputs),
+                                        static_cast<DType>(param.beta1),
+                                        static_cast<DType>(param.beta2),
+                                        static_cast<DType>(param.epsilon),
+                                        static_cast<DType>(param.rescale_grad),
+                                        static_cast<DType>(param.clip_gradient),
+                                        req[0]);
+  });
+}
+
+template <typename xpu>
+inline void FlatAdaGradUpdate(const nnvm::NodeAttrs& attrs,
+                              const OpContext& ctx,
+                              const std::vector<TBlob>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const FlatAdaGradParam& param = nnvm::get<FlatAdaGradParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s       = ctx.get_stream<xpu>();
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    Kernel<FlatAdaGradKernel, xpu>::Launch(s,
+                                           inputs[0].Size(),
+                                           outputs[0].dptr<DType>(),
+                                           inputs[2].dptr<DType>(),
+                                           inputs[0].dptr<DType>(),
+                                           inputs[1].dptr<DType>(),
+                                           inputs[3].dptr<float>(),
+                                           inputs[4].dptr<float>(),
+                                           inputs[5].dptr<int64_t>(),
+                                           FlatNumTensors(inputs),
+                                           static_cast<DType>(param.epsilon),
+                                           static_cast<DType>(param.rescale_grad),
+                                           static_cast<DType>(param.clip_gradient),
+                                           req[0]);
+  });
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_FLAT_OPTIMIZER_INL_H_
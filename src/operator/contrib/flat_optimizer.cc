@@ -0,0 +1,314 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file flat_optimizer.cc
+ * \brief Optimizer updates of a group of tensors stored in one flat buffer
+ */
+#include "./flat_optimizer-inl.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(FlatSGDParam);
+DMLC_REGISTER_PARAMETER(FlatSGDMomParam);
+DMLC_REGISTER_PARAMETER(FlatAdamParam);
+DMLC_REGISTER_PARAMETER(FlatRMSPropParam);
+DMLC_REGISTER_PARAMETER(FlatRMSPropAlexParam);
+DMLC_REGISTER_PARAMETER(FlatFTMLParam);
+DMLC_REGISTER_PARAMETER(FlatAdaGradParam);
+
+NNVM_REGISTER_OP(_contrib_flat_sgd_update)
+    .describe(R"code(Stochastic Gradient Descent (SGD) update of a group of tensors stored in
+one flat buffer.
+
+The tensor k holds the elements ``[offsets[k], offsets[k + 1])`` of the weight and the gradient,
+and is updated with its own learning rate and weight decay::
+
+  weight = weight - lrs[k] * (gradient + wds[k] * weight)
+
+)code" ADD_FILELINE)
+    .set_num_inputs(5)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<FlatSGDParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", FlatUpdateShape<2, 2>)
+    .set_attr<nnvm::FInferType>("FInferType", FlatUpdateType<2, 2>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{
+                                           "weight", "grad", "lrs", "wds", "offsets"};
+                                     })
+    .set_attr<FCompute>("FCompute<cpu>", FlatSGDUpdate<cpu>)
+    .add_argument("weight", "NDArray-or-Symbol", "Flat weight")
+    .add_argument("grad", "NDArray-or-Symbol", "Flat gradient")
+    .add_argument("lrs", "NDArray-or-Symbol", "Learning rate of each tensor")
+    .add_argument("wds", "NDArray-or-Symbol", "Weight decay of each tensor")
+    .add_argument("offsets", "NDArray-or-Symbol", "Offsets of the tensors, int64")
+    .add_arguments(FlatSGDParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_flat_sgd_mom_update)
+    .describe(R"code(Momentum SGD update of a group of tensors stored in one flat buffer.
+
+The tensor k holds the elements ``[offsets[k], offsets[k + 1])`` of the weight, the gradient
+and the momentum, and is updated with its own learning rate and weight decay::
+
+  mom = momentum * mom - lrs[k] * (gradient + wds[k] * weight)
+  weight = weight + mom
+
+)code" ADD_FILELINE)
+    .set_num_inputs(6)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<FlatSGDMomParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", FlatUpdateShape<3, 2>)
+    .set_attr<nnvm::FInferType>("FInferType", FlatUpdateType<3, 2>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{
+                                           "weight", "grad", "mom", "lrs", "wds", "offsets"};
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{2};
+                                   })
+    .set_attr<FCompute>("FCompute<cpu>", FlatMomUpdate<cpu, FlatSGDMomKernel>)
+    .add_argument("weight", "NDArray-or-Symbol", "Flat weight")
+    .add_argument("grad", "NDArray-or-Symbol", "Flat gradient")
+    .add_argument("mom", "NDArray-or-Symbol", "Flat momentum")
+    .add_argument("lrs", "NDArray-or-Symbol", "Learning rate of each tensor")
+    .add_argument("wds", "NDArray-or-Symbol", "Weight decay of each tensor")
+    .add_argument("offsets", "NDArray-or-Symbol", "Offsets of the tensors, int64")
+    .add_arguments(FlatSGDMomParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_flat_nag_mom_update)
+    .describe(R"code(Nesterov momentum update of a group of tensors stored in one flat buffer.
+
+The tensor k holds the elements ``[offsets[k], offsets[k + 1])`` of the weight, the gradient
+and the momentum, and is updated with its own learning rate and weight decay::
+
+  grad = gradient + wds[k] * weight
+  mom = momentum * mom - lrs[k] * grad
+  weight = weight + momentum * mom - lrs[k] * grad
+
+)code" ADD_FILELINE)
+    .set_num_inputs(6)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<FlatSGDMomParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", FlatUpdateShape<3, 2>)
+    .set_attr<nnvm::FInferType>("FInferType", FlatUpdateType<3, 2>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{
+                                           "weight", "grad", "mom", "lrs", "wds", "offsets"};
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{2};
+                                   })
+    .set_attr<FCompute>("FCompute<cpu>", FlatMomUpdate<cpu, FlatNAGMomKernel>)
+    .add_argument("weight", "NDArray-or-Symbol", "Flat weight")
+    .add_argument("grad", "NDArray-or-Symbol", "Flat gradient")
+    .add_argument("mom", "NDArray-or-Symbol", "Flat momentum")
+    .add_argument("lrs", "NDArray-or-Symbol", "Learning rate of each tensor")
+    .add_argument("wds", "NDArray-or-Symbol", "Weight decay of each tensor")
+    .add_argument("offsets", "NDArray-or-Symbol", "Offsets of the tensors, int64")
+    .add_arguments(FlatSGDMomParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_flat_adam_update)
+    .describe(R"code(Adam update of a group of tensors stored in one flat buffer.
+
+The tensor k holds the elements ``[offsets[k], offsets[k + 1])`` of the weight, the gradient,
+the mean and the variance, and is updated with its own learning rate and weight decay::
+
+  grad = gradient + wds[k] * weight
+  mean = beta1 * mean + (1 - beta1) * grad
+  var = beta2 * var + (1 - beta2) * grad ** 2
+  weight = weight - lrs[k] * mean / (sqrt(var) + epsilon)
+
+The bias correction of each tensor is to be folded into its learning rate.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(7)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<FlatAdamParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", FlatUpdateShape<4, 2>)
+    .set_attr<nnvm::FInferType>("FInferType", FlatUpdateType<4, 2>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{"weight", "grad", "mean", "var", "lrs", "wds", "offsets"};
+        })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{2, 3};
+                                   })
+    .set_attr<FCompute>("FCompute<cpu>", FlatAdamUpdate<cpu>)
+    .add_argument("weight", "NDArray-or-Symbol", "Flat weight")
+    .add_argument("grad", "NDArray-or-Symbol", "Flat gradient")
+    .add_argument("mean", "NDArray-or-Symbol", "Flat moving mean")
+    .add_argument("var", "NDArray-or-Symbol", "Flat moving variance")
+    .add_argument("lrs", "NDArray-or-Symbol", "Learning rate of each tensor")
+    .add_argument("wds", "NDArray-or-Symbol", "Weight decay of each tensor")
+    .add_argument("offsets", "NDArray-or-Symbol", "Offsets of the tensors, int64")
+    .add_arguments(FlatAdamParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_flat_rmsprop_update)
+    .describe(R"code(RMSProp update of a group of tensors stored in one flat buffer.
+
+The tensor k holds the elements ``[offsets[k], offsets[k + 1])`` of the weight, the gradient
+and the decaying average of the squared gradient, and is updated with its own learning rate and
+weight decay::
+
+  grad = gradient + wds[k] * weight
+  n = (1 - rho) * grad ** 2 + rho * n
+  weight = weight - lrs[k] * grad / (sqrt(n) + epsilon)
+
+)code" ADD_FILELINE)
+    .set_num_inputs(6)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<FlatRMSPropParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", FlatUpdateShape<3, 2>)
+    .set_attr<nnvm::FInferType>("FInferType", FlatUpdateType<3, 2>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{
+                                           "weight", "grad", "n", "lrs", "wds", "offsets"};
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{2};
+                                   })
+    .set_attr<FCompute>("FCompute<cpu>", FlatRMSPropUpdate<cpu>)
+    .add_argument("weight", "NDArray-or-Symbol", "Flat weight")
+    .add_argument("grad", "NDArray-or-Symbol", "Flat gradient")
+    .add_argument("n", "NDArray-or-Symbol", "Flat decaying average of the squared gradient")
+    .add_argument("lrs", "NDArray-or-Symbol", "Learning rate of each tensor")
+    .add_argument("wds", "NDArray-or-Symbol", "Weight decay of each tensor")
+    .add_argument("offsets", "NDArray-or-Symbol", "Offsets of the tensors, int64")
+    .add_arguments(FlatRMSPropParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_flat_rmspropalex_update)
+    .describe(R"code(Centered RMSProp update of a group of tensors stored in one flat buffer.
+
+The tensor k holds the elements ``[offsets[k], offsets[k + 1])`` of the weight, the gradient
+and the states, and is updated with its own learning rate and weight decay::
+
+  grad = gradient + wds[k] * weight
+  n = (1 - rho) * grad ** 2 + rho * n
+  g = (1 - rho) * grad + rho * g
+  delta = momentum * delta - lrs[k] * grad / sqrt(n - g ** 2 + epsilon)
+  weight = weight + delta
+
+)code" ADD_FILELINE)
+    .set_num_inputs(8)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<FlatRMSPropAlexParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", FlatUpdateShape<5, 2>)
+    .set_attr<nnvm::FInferType>("FInferType", FlatUpdateType<5, 2>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{
+              "weight", "grad", "n", "g", "delta", "lrs", "wds", "offsets"};
+        })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{2, 3, 4};
+                                   })
+    .set_attr<FCompute>("FCompute<cpu>", FlatRMSPropAlexUpdate<cpu>)
+    .add_argument("weight", "NDArray-or-Symbol", "Flat weight")
+    .add_argument("grad", "NDArray-or-Symbol", "Flat gradient")
+    .add_argument("n", "NDArray-or-Symbol", "Flat decaying average of the squared gradient")
+    .add_argument("g", "NDArray-or-Symbol", "Flat decaying average of the gradient")
+    .add_argument("delta", "NDArray-or-Symbol", "Flat momentum")
+    .add_argument("lrs", "NDArray-or-Symbol", "Learning rate of each tensor")
+    .add_argument("wds", "NDArray-or-Symbol", "Weight decay of each tensor")
+    .add_argument("offsets", "NDArray-or-Symbol", "Offsets of the tensors, int64")
+    .add_arguments(FlatRMSPropAlexParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_flat_ftml_update)
+    .describe(R"code(FTML update of a group of tensors stored in one flat buffer.
+
+The tensor k holds the elements ``[offsets[k], offsets[k + 1])`` of the weight, the gradient
+and the states, and is updated with its own learning rate, weight decay and number of updates
+``t = ts[k]``, as in ``ftml_update``.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(9)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<FlatFTMLParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", FlatUpdateShape<5, 3>)
+    .set_attr<nnvm::FInferType>("FInferType", FlatUpdateType<5, 3>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{
+              "weight", "grad", "d", "v", "z", "lrs", "wds", "ts", "offsets"};
+        })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{2, 3, 4};
+                                   })
+    .set_attr<FCompute>("FCompute<cpu>", FlatFTMLUpdate<cpu>)
+    .add_argument("weight", "NDArray-or-Symbol", "Flat weight")
+    .add_argument("grad", "NDArray-or-Symbol", "Flat gradient")
+    .add_argument("d", "NDArray-or-Symbol", "Flat internal state ``d_t``")
+    .add_argument("v", "NDArray-or-Symbol", "Flat internal state ``v_t``")
+    .add_argument("z", "NDArray-or-Symbol", "Flat internal state ``z_t``")
+    .add_argument("lrs", "NDArray-or-Symbol", "Learning rate of each tensor")
+    .add_argument("wds", "NDArray-or-Symbol", "Weight decay of each tensor")
+    .add_argument("ts", "NDArray-or-Symbol", "Number of updates of each tensor")
+    .add_argument("offsets", "NDArray-or-Symbol", "Offsets of the tensors, int64")
+    .add_arguments(FlatFTMLParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_flat_adagrad_update)
+    .describe(R"code(AdaGrad update of a group of tensors stored in one flat buffer.
+
+The tensor k holds the elements ``[offsets[k], offsets[k + 1])`` of the weight, the gradient
+and the history, and is updated with its own learning rate and weight decay::
+
+  grad = gradient + wds[k] * weight
+  history = history + grad ** 2
+  weight = weight - lrs[k] * grad / (sqrt(history) + epsilon)
+
+)code" ADD_FILELINE)
+    .set_num_inputs(6)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<FlatAdaGradParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", FlatUpdateShape<3, 2>)
+    .set_attr<nnvm::FInferType>("FInferType", FlatUpdateType<3, 2>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{
+                                           "weight", "grad", "history", "lrs", "wds", "offsets"};
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{2};
+                                   })
+    .set_attr<FCompute>("FCompute<cpu>", FlatAdaGradUpdate<cpu>)
+    .add_argument("weight", "NDArray-or-Symbol", "Flat weight")
+    .add_argument("grad", "NDArray-or-Symbol", "Flat gradient")
+    .add_argument("history", "NDArray-or-Symbol", "Flat history")
+    .add_argument("lrs", "NDArray-or-Symbol", "Learning rate of each tensor")
+    .add_argument("wds", "NDArray-or-Symbol", "Weight decay of each tensor")
+    .add_argument("offsets", "NDArray-or-Symbol", "Offsets of the tensors, int64")
+    .add_arguments(FlatAdaGradParam::__FIELDS__());
+
+}  // namespace op
+}  // namespace mxnet
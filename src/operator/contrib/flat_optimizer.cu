@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file flat_optimizer.cu
+ * \brief Optimizer updates of a group of tensors stored in one flat buffer, GPU implementation
+ */
+#include "./flat_optimizer-inl.h"
+
+namespace mxnet {
+namespace op {
+
+NNVM_REGISTER_OP(_contrib_flat_sgd_update)
+    .set_attr<FCompute>("FCompute<gpu>", FlatSGDUpdate<gpu>);
+
+NNVM_REGISTER_OP(_contrib_flat_sgd_mom_update)
+    .set_attr<FCompute>("FCompute<gpu>", FlatMomUpdate<gpu, FlatSGDMomKernel>);
+
+NNVM_REGISTER_OP(_contrib_flat_nag_mom_update)
+    .set_attr<FCompute>("FCompute<gpu>", FlatMomUpdate<gpu, FlatNAGMomKernel>);
+
+NNVM_REGISTER_OP(_contrib_flat_adam_update)
+    .set_attr<FCompute>("FCompute<gpu>", FlatAdamUpdate<gpu>);
+
+NNVM_REGISTER_OP(_contrib_flat_rmsprop_update)
+    .set_attr<FCompute>("FCompute<gpu>", FlatRMSPropUpdate<gpu>);
+
+NNVM_REGISTER_OP(_contrib_flat_rmspropalex_update)
+    .set_attr<FCompute>("FCompute<gpu>", FlatRMSPropAlexUpdate<gpu>);
+
+NNVM_REGISTER_OP(_contrib_flat_ftml_update)
+    .set_attr<FCompute>("FCompute<gpu>", FlatFTMLUpdate<gpu>);
+
+NNVM_REGISTER_OP(_contrib_flat_adagrad_update)
+    .set_attr<FCompute>("FCompute<gpu>", FlatAdaGradUpdate<gpu>);
+
+}  // namespace op
+}  // namespace mxnet
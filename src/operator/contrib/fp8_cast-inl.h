@@ -0,0 +1,314 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fp8_cast-inl.h
+ * \brief FP8 (E4M3 and E5M2) casts with per-tensor delayed scaling, for mixed precision
+ *  training: tensors are rounded to the values of the FP8 format after scaling by a factor
+ *  computed from the history of their absolute maximum
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_FP8_CAST_INL_H_
+#define MXNET_OPERATOR_CONTRIB_FP8_CAST_INL_H_
+
+#include <dmlc/parameter.h>
+#include <mxnet/operator_util.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+#include "../mshadow_op.h"
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+#if defined(__CUDACC__)
+#include "../../common/cuda/utils.h"
+#endif  // __CUDACC__
+
+namespace mxnet {
+namespace op {
+
+namespace fp8 {
+enum FP8CastOpInputs { kData, kScale };
+enum FP8CastOpOutputs { kOut, kAmax };
+enum FP8ScaleUpdateOpInputs { kCurrentAmax, kAmaxHistory, kPrevScale };
+enum FP8Format { kE4M3, kE5M2 };
+enum FP8AmaxAlgo { kMax, kMostRecent };
+}  // namespace fp8
+
+struct FP8CastParam : public dmlc::Parameter<FP8CastParam> {
+  int fp8_format;
+  DMLC_DECLARE_PARAMETER(FP8CastParam) {
+    DMLC_DECLARE_FIELD(fp8_format)
+        .add_enum("e4m3", fp8::kE4M3)
+        .add_enum("e5m2", fp8::kE5M2)
+        .set_default(fp8::kE4M3)
+        .describe(
+            "FP8 format: e4m3, with 3 mantissa bits and a maximum of 448, usually for the "
+            "activations and weights, or e5m2, with 2 mantissa bits and a maximum of 57344, "
+            "usually for the gradients.");
+  }
+};
+
+struct FP8ScaleUpdateParam : public dmlc::Parameter<FP8ScaleUpdateParam> {
+  int fp8_format;
+  int margin;
+  int amax_compute_algo;
+  DMLC_DECLARE_PARAMETER(FP8ScaleUpdateParam) {
+    DMLC_DECLARE_FIELD(fp8_format)
+        .add_enum("e4m3", fp8::kE4M3)
+        .add_enum("e5m2", fp8::kE5M2)
+        .set_default(fp8::kE4M3)
+        .describe("FP8 format of the tensor, as given to _contrib_fp8_cast.");
+    DMLC_DECLARE_FIELD(margin).set_default(0).set_lower_bound(0).describe(
+        "The scale maps the amax to the maximum of the format divided by 2^margin.");
+    DMLC_DECLARE_FIELD(amax_compute_algo)
+        .add_enum("max", fp8::kMax)
+        .add_enum("most_recent", fp8::kMostRecent)
+        .set_default(fp8::kMax)
+        .describe("Amax the scale is computed from: the maximum of the history, or the last one.");
+  }
+};
+
+/*! \brief largest finite value of an FP8 format */
+MSHADOW_XINLINE float FP8Max(int format) {
+  return format == fp8::kE4M3 ? 448.0f : 57344.0f;
+}
+
+/*!
+ * \brief x rounded to the nearest value of an FP8 format, ties to even, saturating to the
+ *  largest finite value. Values below the smallest normal are rounded to the subnormals.
+ */
+MSHADOW_XINLINE float FP8Round(float x, int format) {
+  const int mantissa_bits = format == fp8::kE4M3 ? 3 : 2;
+  const int min_exponent  = format == fp8::kE4M3 ? -6 : -14;
+  const float max_value   = FP8Max(format);
+  float ax                = fabsf(x);
+  if (ax != ax || ax == 0.0f) {
+    return x;
+  }
+  if (ax >= max_value) {
+    return copysignf(max_value, x);
+  }
+  int exponent;
+  frexpf(ax, &exponent);
+  // frexpf gives ax = m * 2^exponent with m in [0.5, 1)
+  exponent            = exponent - 1 < min_exponent ? min_exponent : exponent - 1;
+  const float quantum = ldexpf(1.0f, exponent - mantissa_bits);
+  ax                  = fminf(rintf(ax / quantum) * quantum, max_value);
+  return copysignf(ax, x);
+}
+
+/*! \brief out = FP8Round(data * scale) / scale */
+template <int req>
+struct fp8_cast_forward {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const DType* data,
+                                  const float* scale,
+                                  int format) {
+    const float s = scale[0];
+    KERNEL_ASSIGN(out[i], req, DType(FP8Round(static_cast<float>(data[i]) * s, format) / s));
+  }
+};
+
+/*!
+ * \brief pushes the amax into the history and computes the next scale, in a single thread.
+ *  A non-finite amax, from a step that overflowed, keeps the history and the scale.
+ */
+struct fp8_scale_update {
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  float* out_scale,
+                                  float* amax_history,
+                                  const float* amax,
+                                  const float* prev_scale,
+                                  index_t history_len,
+                                  int format,
+                                  int margin,
+                                  int algo) {
+    const float a = amax[0];
+    if (!(a <= FLT_MAX)) {
+      out_scale[0] = prev_scale[0];
+      return;
+    }
+    for (index_t k = history_len - 1; k > 0; --k) {
+      amax_history[k] = amax_history[k - 1];
+    }
+    amax_history[0] = a;
+    float m         = a;
+    if (algo == fp8::kMax) {
+      for (index_t k = 1; k < history_len; ++k) {
+        m = fmaxf(m, amax_history[k]);
+      }
+    }
+    out_scale[0] = m > 0.0f ? ldexpf(FP8Max(format) / m, -margin) : prev_scale[0];
+  }
+};
+
+/*! \brief amax[0] = max(|data|), NaNs ignored */
+template <typename DType>
+void FP8Amax(mshadow::Stream<cpu>* s, const DType* data, index_t n, float* amax) {
+  const int nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  float m            = 0.0f;
+#pragma omp parallel for num_threads(nthreads) reduction(max : m)
+  for (index_t i = 0; i < n; ++i) {
+    m = fmaxf(m, fabsf(static_cast<float>(data[i])));
+  }
+  amax[0] = m;
+}
+
+#if defined(__CUDACC__)
+
+template <typename DType>
+__global__ void fp8_amax_kernel(const DType* data, index_t n, float* amax) {
+  using mxnet::common::cuda::warp_size;
+  float m = 0.0f;
+  for (index_t i = static_cast<index_t>(blockIdx.x) * blockDim.x + threadIdx.x; i < n;
+       i += static_cast<index_t>(blockDim.x) * gridDim.x) {
+    m = fmaxf(m, fabsf(static_cast<float>(data[i])));
+  }
+  m = mxnet::common::cuda::warp_reduce(m, [](float x, float y) { return fmaxf(x, y); });
+  if (threadIdx.x % warp_size == 0) {
+    // the order of non-negative floats is the order of their bits
+    atomicMax(reinterpret_cast<int*>(amax), __float_as_int(m));
+  }
+}
+
+template <typename DType>
+void FP8Amax(mshadow::Stream<gpu>* s, const DType* data, index_t n, float* amax) {
+  cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
+  CUDA_CALL(cudaMemsetAsync(amax, 0, sizeof(float), stream));
+  if (n == 0) {
+    return;
+  }
+  fp8_amax_kernel<<<mxnet_op::cuda_get_num_blocks(n), mshadow::cuda::kBaseThreadNum, 0, stream>>>(
+      data, n, amax);
+  MSHADOW_CUDA_POST_KERNEL_CHECK(fp8_amax_kernel);
+}
+
+#endif  // __CUDACC__
+
+inline bool FP8CastShape(const nnvm::NodeAttrs& attrs,
+                         mxnet::ShapeVector* in_attrs,
+                         mxnet::ShapeVector* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 2U);
+  SHAPE_ASSIGN_CHECK(*in_attrs, fp8::kScale, Shape1(1));
+  SHAPE_ASSIGN_CHECK(*out_attrs, fp8::kOut, in_attrs->at(fp8::kData));
+  SHAPE_ASSIGN_CHECK(*in_attrs, fp8::kData, out_attrs->at(fp8::kOut));
+  SHAPE_ASSIGN_CHECK(*out_attrs, fp8::kAmax, Shape1(1));
+  return shape_is_known(in_attrs->at(fp8::kData));
+}
+
+inline bool FP8CastType(const nnvm::NodeAttrs& attrs,
+                        std::vector<int>* in_attrs,
+                        std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 2U);
+  TYPE_ASSIGN_CHECK(*in_attrs, fp8::kScale, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_attrs, fp8::kOut, in_attrs->at(fp8::kData));
+  TYPE_ASSIGN_CHECK(*in_attrs, fp8::kData, out_attrs->at(fp8::kOut));
+  TYPE_ASSIGN_CHECK(*out_attrs, fp8::kAmax, mshadow::kFloat32);
+  return in_attrs->at(fp8::kData) != -1;
+}
+
+template <typename xpu>
+void FP8CastForward(const nnvm::NodeAttrs& attrs,
+                    const OpContext& ctx,
+                    const std::vector<TBlob>& inputs,
+                    const std::vector<OpReqType>& req,
+                    const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const FP8CastParam& param = nnvm::get<FP8CastParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s   = ctx.get_stream<xpu>();
+  const TBlob& data         = inputs[fp8::kData];
+  const index_t n           = data.shape_.Size();
+  MSHADOW_REAL_TYPE_SWITCH(data.type_flag_, DType, {
+    // the amax is of the data before this cast, for the scale of the next steps
+    if (req[fp8::kAmax] != kNullOp) {
+      FP8Amax(s, data.dptr<DType>(), n, outputs[fp8::kAmax].dptr<float>());
+    }
+    MXNET_ASSIGN_REQ_SWITCH(req[fp8::kOut], Req, {
+      Kernel<fp8_cast_forward<Req>, xpu>::Launch(s,
+                                                 n,
+                                                 outputs[fp8::kOut].dptr<DType>(),
+                                                 data.dptr<DType>(),
+                                                 inputs[fp8::kScale].dptr<float>(),
+                                                 param.fp8_format);
+    });
+  });
+}
+
+inline bool FP8ScaleUpdateShape(const nnvm::NodeAttrs& attrs,
+                                mxnet::ShapeVector* in_attrs,
+                                mxnet::ShapeVector* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 3U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  SHAPE_ASSIGN_CHECK(*in_attrs, fp8::kCurrentAmax, Shape1(1));
+  SHAPE_ASSIGN_CHECK(*in_attrs, fp8::kPrevScale, Shape1(1));
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, Shape1(1));
+  const mxnet::TShape& hshape = in_attrs->at(fp8::kAmaxHistory);
+  if (!shape_is_known(hshape)) {
+    return false;
+  }
+  CHECK_EQ(hshape.ndim(), 1) << "The amax history must be 1D, (history_len,)";
+  CHECK_GT(hshape[0], 0) << "The amax history must not be empty";
+  return true;
+}
+
+inline bool FP8ScaleUpdateType(const nnvm::NodeAttrs& attrs,
+                               std::vector<int>* in_attrs,
+                               std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 3U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  for (size_t i = 0; i < in_attrs->size(); ++i) {
+    TYPE_ASSIGN_CHECK(*in_attrs, i, mshadow::kFloat32);
+  }
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, mshadow::kFloat32);
+  return true;
+}
+
+template <typename xpu>
+void FP8ScaleUpdateForward(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const FP8ScaleUpdateParam& param = nnvm::get<FP8ScaleUpdateParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s          = ctx.get_stream<xpu>();
+  if (req[0] == kNullOp) {
+    return;
+  }
+  // the history is updated in place, the scale may be: both are read before being written
+  Kernel<fp8_scale_update, xpu>::Launch(s,
+                                        1,
+                                        outputs[0].dptr<float>(),
+                                        inputs[fp8::kAmaxHistory].dptr<float>(),
+                                        inputs[fp8::kCurrentAmax].dptr<float>(),
+                                        inputs[fp8::kPrevScale].dptr<float>(),
+                                        inputs[fp8::kAmaxHistory].shape_.Size(),
+                                        param.fp8_format,
+                                        param.margin,
+                                        param.amax_compute_algo);
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_FP8_CAST_INL_H_
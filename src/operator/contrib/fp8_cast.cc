@@ -0,0 +1,117 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fp8_cast.cc
+ * \brief FP8 casts with delayed scaling, CPU implementation
+ */
+#include "./fp8_cast-inl.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(FP8CastParam);
+DMLC_REGISTER_PARAMETER(FP8ScaleUpdateParam);
+
+NNVM_REGISTER_OP(_contrib_fp8_cast)
+    .add_alias("_npx_fp8_cast")
+    .describe(R"code(Round the data to the values of an FP8 format, after scaling it.
+
+Returns ``round_fp8(data * scale) / scale``, in the type of the data, and the absolute maximum of
+the data, from which _contrib_fp8_scale_update computes the scale of the next steps. Values
+beyond the range of the format saturate to its largest value.
+
+In backward pass, the gradient of the data is the gradient of the output (straight-through
+estimator), the scale gets no gradient.
+
+Example::
+  out, amax = fp8_cast([0.3, -1.1, 500.0], scale=[1.0], fp8_format='e4m3')
+  out = [0.3125, -1.125, 448.0]
+  amax = [500.0]
+)code" ADD_FILELINE)
+    .set_attr_parser(ParamParser<FP8CastParam>)
+    .set_num_inputs(2)
+    .set_num_outputs(2)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data", "scale"};
+                                     })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output", "amax"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape", FP8CastShape)
+    .set_attr<nnvm::FInferType>("FInferType", FP8CastType)
+    .set_attr<FCompute>("FCompute<cpu>", FP8CastForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient",
+                               [](const nnvm::ObjectPtr& n,
+                                  const std::vector<nnvm::NodeEntry>& ograds) {
+                                 std::vector<nnvm::NodeEntry> ret;
+                                 ret.emplace_back(ograds[fp8::kOut]);
+                                 ret.emplace_back(MakeNode("zeros_like",
+                                                           n->attrs.name + "_scale_backward",
+                                                           {n->inputs[fp8::kScale]},
+                                                           nullptr,
+                                                           &n));
+                                 return ret;
+                               })
+    .add_argument("data", "NDArray-or-Symbol", "Input data.")
+    .add_argument("scale", "NDArray-or-Symbol", "Scale, float32 of shape (1,).")
+    .add_arguments(FP8CastParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_fp8_scale_update)
+    .add_alias("_npx_fp8_scale_update")
+    .describe(R"code(Push the amax of a step into the amax history of a tensor, in place, and
+return the delayed scale of the next step of its FP8 casts.
+
+The scale is ``fp8_max / amax / 2^margin``, with amax the maximum of the history, or the last
+amax with ``amax_compute_algo='most_recent'``. The scale is left as is while the amax is 0. A
+non-finite amax, from a step that overflowed, is not pushed and keeps the scale, so the update
+can run on every step like the dynamic loss scaler.
+)code" ADD_FILELINE)
+    .set_attr_parser(ParamParser<FP8ScaleUpdateParam>)
+    .set_num_inputs(3)
+    .set_num_outputs(1)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{"amax", "amax_history", "scale"};
+        })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{fp8::kAmaxHistory};
+                                   })
+    .set_attr<nnvm::FInplaceOption>("FInplaceOption",
+                                    [](const NodeAttrs& attrs) {
+                                      return std::vector<std::pair<int, int>>{
+                                          {fp8::kPrevScale, 0}};
+                                    })
+    .set_attr<mxnet::FInferShape>("FInferShape", FP8ScaleUpdateShape)
+    .set_attr<nnvm::FInferType>("FInferType", FP8ScaleUpdateType)
+    .set_attr<FCompute>("FCompute<cpu>", FP8ScaleUpdateForward<cpu>)
+    .add_argument("amax", "NDArray-or-Symbol", "Amax of the step, as returned by fp8_cast.")
+    .add_argument("amax_history",
+                  "NDArray-or-Symbol",
+                  "Amax of the previous steps, the most recent first, float32 of shape "
+                  "(history_len,). Updated in place.")
+    .add_argument("scale", "NDArray-or-Symbol", "Scale of the previous step.")
+    .add_arguments(FP8ScaleUpdateParam::__FIELDS__());
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,567 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file indexed_optimizer-inl.h
+ * \brief Lazy optimizer updates of the rows of a dense weight given by unsorted, possibly
+ *  duplicated row ids, e.g. the ids looked up by an embedding and the gradient of its output.
+ *  The gradients of the duplicated ids of a row are summed into the one of its first id by
+ *  scattering with atomics instead of sorting the ids, then every updated row is updated once.
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_INDEXED_OPTIMIZER_INL_H_
+#define MXNET_OPERATOR_CONTRIB_INDEXED_OPTIMIZER_INL_H_
+
+#include <dmlc/parameter.h>
+#include <mxnet/operator_util.h>
+#include <climits>
+#include <vector>
+#include "../mshadow_op.h"
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+
+namespace mxnet {
+namespace op {
+
+namespace indexed_optimizer {
+enum IndexedUpdateResource { kTempSpace };
+}  // namespace indexed_optimizer
+
+struct IndexedAdamParam : public dmlc::Parameter<IndexedAdamParam> {
+  float lr;
+  float beta1;
+  float beta2;
+  float epsilon;
+  float wd;
+  float rescale_grad;
+  float clip_gradient;
+  DMLC_DECLARE_PARAMETER(IndexedAdamParam) {
+    DMLC_DECLARE_FIELD(lr).describe("Learning rate");
+    DMLC_DECLARE_FIELD(beta1).set_default(0.9f).describe(
+        "The decay rate for the 1st moment estimates.");
+    DMLC_DECLARE_FIELD(beta2).set_default(0.999f).describe(
+        "The decay rate for the 2nd moment estimates.");
+    DMLC_DECLARE_FIELD(epsilon).set_default(1e-8f).describe(
+        "A small constant for numerical stability.");
+    DMLC_DECLARE_FIELD(wd).set_default(0.0f).describe(
+        "Weight decay augments the objective function with a "
+        "regularization term that penalizes large weights. "
+        "The penalty scales with the square of the magnitude of each weight.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+        .set_default(-1.0f)
+        .describe(
+            "Clip gradient to the range of [-clip_gradient, clip_gradient] "
+            "If clip_gradient <= 0, gradient clipping is turned off. "
+            "grad = max(min(grad, clip_gradient), -clip_gradient).");
+  }
+};
+
+struct IndexedAdamWParam : public dmlc::Parameter<IndexedAdamWParam> {
+  float lr;
+  float beta1;
+  float beta2;
+  float epsilon;
+  float wd;
+  float eta;
+  float rescale_grad;
+  float clip_gradient;
+  DMLC_DECLARE_PARAMETER(IndexedAdamWParam) {
+    DMLC_DECLARE_FIELD(lr).describe("Learning rate");
+    DMLC_DECLARE_FIELD(beta1).set_default(0.9f).describe(
+        "The decay rate for the 1st moment estimates.");
+    DMLC_DECLARE_FIELD(beta2).set_default(0.999f).describe(
+        "The decay rate for the 2nd moment estimates.");
+    DMLC_DECLARE_FIELD(epsilon).set_default(1e-8f).describe(
+        "A small constant for numerical stability.");
+    DMLC_DECLARE_FIELD(wd).set_default(0.0f).describe(
+        "Weight decay augments the objective function with a "
+        "regularization term that penalizes large weights. "
+        "The penalty scales with the square of the magnitude of each weight.");
+    DMLC_DECLARE_FIELD(eta).set_default(1.0f).describe("Learning rate schedule multiplier");
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+        .set_default(-1.0f)
+        .describe(
+            "Clip gradient to the range of [-clip_gradient, clip_gradient] "
+            "If clip_gradient <= 0, gradient clipping is turned off. "
+            "grad = max(min(grad, clip_gradient), -clip_gradient).");
+  }
+};
+
+struct IndexedFtrlParam : public dmlc::Parameter<IndexedFtrlParam> {
+  float lr;
+  float lamda1;
+  float beta;
+  float wd;
+  float rescale_grad;
+  float clip_gradient;
+  DMLC_DECLARE_PARAMETER(IndexedFtrlParam) {
+    DMLC_DECLARE_FIELD(lr).describe("Learning rate");
+    DMLC_DECLARE_FIELD(lamda1).set_default(0.01f).describe("The L1 regularization coefficient.");
+    DMLC_DECLARE_FIELD(beta).set_default(1.0f).describe("Per-Coordinate Learning Rate beta.");
+    DMLC_DECLARE_FIELD(wd).set_default(0.0f).describe(
+        "Weight decay augments the objective function with a "
+        "regularization term that penalizes large weights. "
+        "The penalty scales with the square of the magnitude of each weight.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+        .set_default(-1.0f)
+        .describe(
+            "Clip gradient to the range of [-clip_gradient, clip_gradient] "
+            "If clip_gradient <= 0, gradient clipping is turned off. "
+            "grad = max(min(grad, clip_gradient), -clip_gradient).");
+  }
+};
+
+struct IndexedAdaGradParam : public dmlc::Parameter<IndexedAdaGradParam> {
+  float lr;
+  float epsilon;
+  float wd;
+  float rescale_grad;
+  float clip_gradient;
+  DMLC_DECLARE_PARAMETER(IndexedAdaGradParam) {
+    DMLC_DECLARE_FIELD(lr).describe("Learning rate");
+    DMLC_DECLARE_FIELD(epsilon).set_default(1.0e-7).describe("epsilon");
+    DMLC_DECLARE_FIELD(wd).set_default(0.0f).describe("weight decay");
+    DMLC_DECLARE_FIELD(rescale_grad)
+        .set_default(1.0f)
+        .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+        .set_default(-1.0f)
+        .describe(
+            "Clip gradient to the range of [-clip_gradient, clip_gradient] "
+            "If clip_gradient <= 0, gradient clipping is turned off. "
+            "grad = max(min(grad, clip_gradient), -clip_gradient).");
+  }
+};
+
+/*!
+ * \brief the inputs are the weight, the gradient rows, the num_states states and the row ids:
+ *  the weight and the states are of shape (num_rows, ...), the gradient of (num_ids, ...)
+ */
+template <int num_states>
+inline bool IndexedUpdateShape(const nnvm::NodeAttrs& attrs,
+                               mxnet::ShapeVector* in_attrs,
+                               mxnet::ShapeVector* out_attrs) {
+  CHECK_EQ(in_attrs->size(), num_states + 3);
+  CHECK_EQ(out_attrs->size(), 1U);
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(0));
+  for (int i = 0; i < num_states; ++i) {
+    SHAPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(2 + i));
+  }
+  const mxnet::TShape& wshape = out_attrs->at(0);
+  SHAPE_ASSIGN_CHECK(*in_attrs, 0, wshape);
+  for (int i = 0; i < num_states; ++i) {
+    SHAPE_ASSIGN_CHECK(*in_attrs, 2 + i, wshape);
+  }
+  const mxnet::TShape& gshape = in_attrs->at(1);
+  if (!mxnet::shape_is_known(wshape) || !mxnet::shape_is_known(gshape)) {
+    return false;
+  }
+  CHECK_EQ(gshape.ndim(), wshape.ndim())
+      << "the gradient rows must be of shape (num_ids,) + weight.shape[1:]";
+  for (int i = 1; i < wshape.ndim(); ++i) {
+    CHECK_EQ(gshape[i], wshape[i])
+        << "the gradient rows must be of shape (num_ids,) + weight.shape[1:]";
+  }
+  SHAPE_ASSIGN_CHECK(*in_attrs, num_states + 2, Shape1(gshape[0]));
+  return true;
+}
+
+/*! \brief the gradient and the states are of the type of the weight, the row ids of any type */
+template <int num_states>
+inline bool IndexedUpdateType(const nnvm::NodeAttrs& attrs,
+                              std::vector<int>* in_attrs,
+                              std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), num_states + 3);
+  CHECK_EQ(out_attrs->size(), 1U);
+  for (int i = 0; i < num_states + 2; ++i) {
+    TYPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(i));
+  }
+  for (int i = 0; i < num_states + 2; ++i) {
+    TYPE_ASSIGN_CHECK(*in_attrs, i, out_attrs->at(0));
+  }
+  return out_attrs->at(0) != -1 && in_attrs->at(num_states + 2) != -1;
+}
+
+/*!
+ * \brief sums the gradient rows of the ids of each row into grad_sum at the position of its
+ *  first id, first[row] being set to that position for every row in the ids. Specialized for
+ *  cpu and gpu.
+ */
+template <typename xpu>
+struct IndexedGradSum;
+
+/*!
+ * \brief position in the weight of the element i of the gradient rows, or -1 if the row of
+ *  its id is updated by another id of the row
+ */
+template <typename IType>
+MSHADOW_XINLINE index_t IndexedWeightPos(index_t i,
+                                         index_t row_length,
+                                         index_t num_rows,
+                                         const IType* ids,
+                                         const int* first) {
+  const index_t k   = i / row_length;
+  const index_t row = static_cast<index_t>(ids[k]);
+  if (row < 0 || row >= num_rows || first[row] != k) {
+    return -1;
+  }
+  return row * row_length + i % row_length;
+}
+
+template <typename AType>
+MSHADOW_XINLINE AType IndexedRescaleGrad(AType grad, float rescale_grad, float clip_gradient) {
+  grad *= static_cast<AType>(rescale_grad);
+  if (clip_gradient >= 0.0f) {
+    grad = mshadow_op::clip::Map(grad, static_cast<AType>(clip_gradient));
+  }
+  return grad;
+}
+
+struct IndexedAdamKernel {
+  template <typename DType, typename AType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  index_t row_length,
+                                  index_t num_rows,
+                                  DType* out_data,
+                                  DType* mean_data,
+                                  DType* var_data,
+                                  const DType* weight_data,
+                                  const AType* grad_sum,
+                                  const IType* ids,
+                                  const int* first,
+                                  const float lr,
+                                  const float beta1,
+                                  const float beta2,
+                                  const float epsilon,
+                                  const float wd,
+                                  const float rescale_grad,
+                                  const float clip_gradient) {
+    const index_t w_i = IndexedWeightPos(i, row_length, num_rows, ids, first);
+    if (w_i < 0) {
+      return;
+    }
+    const AType w    = static_cast<AType>(weight_data[w_i]);
+    const AType g    = IndexedRescaleGrad(grad_sum[i], rescale_grad, clip_gradient) + wd * w;
+    const AType mean = beta1 * static_cast<AType>(mean_data[w_i]) + (1 - beta1) * g;
+    const AType var  = beta2 * static_cast<AType>(var_data[w_i]) + (1 - beta2) * g * g;
+    mean_data[w_i]   = DType(mean);
+    var_data[w_i]    = DType(var);
+    out_data[w_i]    = DType(w - lr * mean / (mshadow_op::square_root::Map(var) + epsilon));
+  }
+};
+
+struct IndexedAdamWKernel {
+  template <typename DType, typename AType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  index_t row_length,
+                                  index_t num_rows,
+                                  DType* out_data,
+                                  DType* mean_data,
+                                  DType* var_data,
+                                  const DType* weight_data,
+                                  const AType* grad_sum,
+                                  const IType* ids,
+                                  const int* first,
+                                  const float lr,
+                                  const float beta1,
+                                  const float beta2,
+                                  const float epsilon,
+                                  const float wd,
+                                  const float eta,
+                                  const float rescale_grad,
+                                  const float clip_gradient) {
+    const index_t w_i = IndexedWeightPos(i, row_length, num_rows, ids, first);
+    if (w_i < 0) {
+      return;
+    }
+    const AType w    = static_cast<AType>(weight_data[w_i]);
+    const AType g    = IndexedRescaleGrad(grad_sum[i], rescale_grad, clip_gradient);
+    const AType mean = beta1 * static_cast<AType>(mean_data[w_i]) + (1 - beta1) * g;
+    const AType var  = beta2 * static_cast<AType>(var_data[w_i]) + (1 - beta2) * g * g;
+    mean_data[w_i]   = DType(mean);
+    var_data[w_i]    = DType(var);
+    out_data[w_i] =
+        DType(w - eta * (lr * mean / (mshadow_op::square_root::Map(var) + epsilon) + wd * w));
+  }
+};
+
+struct IndexedFtrlKernel {
+  template <typename DType, typename AType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  index_t row_length,
+                                  index_t num_rows,
+                                  DType* out_data,
+                                  DType* z_data,
+                                  DType* n_data,
+                                  const DType* weight_data,
+                                  const AType* grad_sum,
+                                  const IType* ids,
+                                  const int* first,
+                                  const float lr,
+                                  const float lamda1,
+                                  const float beta,
+                                  const float wd,
+                                  const float rescale_grad,
+                                  const float clip_gradient) {
+    using namespace mshadow_op;
+    const index_t w_i = IndexedWeightPos(i, row_length, num_rows, ids, first);
+    if (w_i < 0) {
+      return;
+    }
+    const AType w = static_cast<AType>(weight_data[w_i]);
+    const AType g = IndexedRescaleGrad(grad_sum[i], rescale_grad, clip_gradient);
+    const AType n = static_cast<AType>(n_data[w_i]);
+    const AType z = static_cast<AType>(z_data[w_i]) + g -
+                    (square_root::Map(n + g * g) - square_root::Map(n)) * w / lr;
+    const AType n_new = n + g * g;
+    const AType d     = -sign::Map(z) * maximum::Map(abs::Map(z) - lamda1, AType(0));
+    z_data[w_i]       = DType(z);
+    n_data[w_i]       = DType(n_new);
+    out_data[w_i]     = DType(d / ((beta + square_root::Map(n_new)) / lr + wd));
+  }
+};
+
+struct IndexedAdaGradKernel {
+  template <typename DType, typename AType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  index_t row_length,
+                                  index_t num_rows,
+                                  DType* out_data,
+                                  DType* history_data,
+                                  const DType* weight_data,
+                                  const AType* grad_sum,
+                                  const IType* ids,
+                                  const int* first,
+                                  const float lr,
+                                  const float epsilon,
+                                  const float wd,
+                                  const float rescale_grad,
+                                  const float clip_gradient) {
+    const index_t w_i = IndexedWeightPos(i, row_length, num_rows, ids, first);
+    if (w_i < 0) {
+      return;
+    }
+    const AType w       = static_cast<AType>(weight_data[w_i]);
+    const AType g       = IndexedRescaleGrad(grad_sum[i], rescale_grad, clip_gradient) + wd * w;
+    const AType history = static_cast<AType>(history_data[w_i]) + g * g;
+    history_data[w_i]   = DType(history);
+    out_data[w_i]       = DType(w - lr * g / (mshadow_op::square_root::Map(history) + epsilon));
+  }
+};
+
+/*!
+ * \brief sums the gradient rows of the duplicated ids into the temporary space, returning the
+ *  sums and, in first, the first id of each row
+ */
+template <typename xpu, typename DType, typename AType, typename IType>
+AType* IndexedSumGrad(const OpContext& ctx,
+                      const TBlob& weight,
+                      const TBlob& grad,
+                      const TBlob& ids,
+                      int** first) {
+  using namespace mxnet_op;
+  mshadow::Stream<xpu>* s  = ctx.get_stream<xpu>();
+  const index_t num_rows   = weight.shape_[0];
+  const index_t num_ids    = grad.shape_[0];
+  const index_t row_length = weight.shape_.ProdShape(1, weight.ndim());
+  CHECK_LT(num_ids, INT_MAX) << "the number of ids must be smaller than INT_MAX";
+  const size_t first_size = (num_rows * sizeof(int) + 7) / 8 * 8;
+  Tensor<xpu, 1, char> workspace =
+      ctx.requested[indexed_optimizer::kTempSpace].get_space_typed<xpu, 1, char>(
+          Shape1(first_size + grad.shape_.Size() * sizeof(AType)), s);
+  *first          = reinterpret_cast<int*>(workspace.dptr_);
+  AType* grad_sum = reinterpret_cast<AType*>(workspace.dptr_ + first_size);
+  IndexedGradSum<xpu>::Run(
+      s, ids.dptr<IType>(), num_ids, num_rows, row_length, grad.dptr<DType>(), *first, grad_sum);
+  return grad_sum;
+}
+
+template <typename xpu>
+void IndexedAdamUpdate(const nnvm::NodeAttrs& attrs,
+                       const OpContext& ctx,
+                       const std::vector<TBlob>& inputs,
+                       const std::vector<OpReqType>& req,
+                       const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const IndexedAdamParam& param = nnvm::get<IndexedAdamParam>(attrs.parsed);
+  const TBlob& weight           = inputs[0];
+  const TBlob& grad             = inputs[1];
+  const TBlob& ids              = inputs[4];
+  if (req[0] == kNullOp || grad.shape_.Size() == 0) {
+    return;
+  }
+  CHECK_EQ(req[0], kWriteInplace) << "kWriteInplace is expected for indexed_adam_update";
+  MSHADOW_REAL_TYPE_SWITCH_EX(weight.type_flag_, DType, AType, {
+    MSHADOW_TYPE_SWITCH(ids.type_flag_, IType, {
+      int* first      = nullptr;
+      AType* grad_sum = IndexedSumGrad<xpu, DType, AType, IType>(ctx, weight, grad, ids, &first);
+      Kernel<IndexedAdamKernel, xpu>::Launch(ctx.get_stream<xpu>(),
+                                             grad.shape_.Size(),
+                                             weight.shape_.ProdShape(1, weight.ndim()),
+                                             weight.shape_[0],
+                                             outputs[0].dptr<DType>(),
+                                             inputs[2].dptr<DType>(),
+                                             inputs[3].dptr<DType>(),
+                                             weight.dptr<DType>(),
+                                             grad_sum,
+                                             ids.dptr<IType>(),
+                                             first,
+                                             param.lr,
+                                             param.beta1,
+                                             param.beta2,
+                                             param.epsilon,
+                                             param.wd,
+                                             param.rescale_grad,
+                                             param.clip_gradient);
+    });
+  });
+}
+
+template <typename xpu>
+void IndexedAdamWUpdate(const nnvm::NodeAttrs& attrs,
+                        const OpContext& ctx,
+                        const std::vector<TBlob>& inputs,
+                        const std::vector<OpReqType>& req,
+                        const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const IndexedAdamWParam& param = nnvm::get<IndexedAdamWParam>(attrs.parsed);
+  const TBlob& weight            = inputs[0];
+  const TBlob& grad              = inputs[1];
+  const TBlob& ids               = inputs[4];
+  if (req[0] == kNullOp || grad.shape_.Size() == 0) {
+    return;
+  }
+  CHECK_EQ(req[0], kWriteInplace) << "kWriteInplace is expected for indexed_adamw_update";
+  MSHADOW_REAL_TYPE_SWITCH_EX(weight.type_flag_, DType, AType, {
+    MSHADOW_TYPE_SWITCH(ids.type_flag_, IType, {
+      int* first      = nullptr;
+      AType* grad_sum = IndexedSumGrad<xpu, DType, AType, IType>(ctx, weight, grad, ids, &first);
+      Kernel<IndexedAdamWKernel, xpu>::Launch(ctx.get_stream<xpu>(),
+                                              grad.shape_.Size(),
+                                              weight.shape_.ProdShape(1, weight.ndim()),
+                                              weight.shape_[0],
+                                              outputs[0].dptr<DType>(),
+                                              inputs[2].dptr<DType>(),
+                                              inputs[3].dptr<DType>(),
+                                              weight.dptr<DType>(),
+                                              grad_sum,
+                                              ids.dptr<IType>(),
+                                              first,
+                                              param.lr,
+                                              param.beta1,
+                                              param.beta2,
+                                              param.epsilon,
+                                              param.wd,
+                                              param.eta,
+                                              param.rescale_grad,
+                                              param.clip_gradient);
+    });
+  });
+}
+
+template <typename xpu>
+void IndexedFtrlUpdate(const nnvm::NodeAttrs& attrs,
+                       const OpContext& ctx,
+                       const std::vector<TBlob>& inputs,
+                       const std::vector<OpReqType>& req,
+                       const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const IndexedFtrlParam& param = nnvm::get<IndexedFtrlParam>(attrs.parsed);
+  const TBlob& weight           = inputs[0];
+  const TBlob& grad             = inputs[1];
+  const TBlob& ids              = inputs[4];
+  if (req[0] == kNullOp || grad.shape_.Size() == 0) {
+    return;
+  }
+  CHECK_EQ(req[0], kWriteInplace) << "kWriteInplace is expected for indexed_ftrl_update";
+  MSHADOW_REAL_TYPE_SWITCH_EX(weight.type_flag_, DType, AType, {
+    MSHADOW_TYPE_SWITCH(ids.type_flag_, IType, {
+      int* first      = nullptr;
+      AType* grad_sum = IndexedSumGrad<xpu, DType, AType, IType>(ctx, weight, grad, ids, &first);
+      Kernel<IndexedFtrlKernel, xpu>::Launch(ctx.get_stream<xpu>(),
+                                             grad.shape_.Size(),
+                                             weight.shape_.ProdShape(1, weight.ndim()),
+                                             weight.shape_[0],
+                                             outputs[0].dptr<DType>(),
+                                             inputs[2].dptr<DType>(),
+                                             inputs[3].dptr<DType>(),
+                                             weight.dptr<DType>(),
+                                             grad_sum,
+                                             ids.dptr<IType>(),
+                                             first,
+                                             param.lr,
+                                             param.lamda1,
+                                             param.beta,
+                                             param.wd,
+                                             param.rescale_grad,
+                                             param.clip_gradient);
+    });
+  });
+}
+
+template <typename xpu>
+void IndexedAdaGradUpdate(const nnvm::NodeAttrs& attrs,
+                          const OpContext& ctx,
+                          const std::vector<TBlob>& inputs,
+                          const std::vector<OpReqType>& req,
+                          const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const IndexedAdaGradParam& param = nnvm::get<IndexedAdaGradParam>(attrs.parsed);
+  const TBlob& weight              = inputs[0];
+  const TBlob& grad                = inputs[1];
+  const TBlob& ids                 = inputs[3];
+  if (req[0] == kNullOp || grad.shape_.Size() == 0) {
+    return;
+  }
+  CHECK_EQ(req[0], kWriteInplace) << "kWriteInplace is expected for indexed_adagrad_update";
+  MSHADOW_REAL_TYPE_SWITCH_EX(weight.type_flag_, DType, AType, {
+    MSHADOW_TYPE_SWITCH(ids.type_flag_, IType, {
+      int* first      = nullptr;
+      AType* grad_sum = IndexedSumGrad<xpu, DType, AType, IType>(ctx, weight, grad, ids, &first);
+      Kernel<IndexedAdaGradKernel, xpu>::Launch(ctx.get_stream<xpu>(),
+                                                grad.shape_.Size(),
+                                                weight.shape_.ProdShape(1, weight.ndim()),
+                                                weight.shape_[0],
+                                                outputs[0].dptr<DType>(),
+                                                inputs[2].dptr<DType>(),
+                                                weight.dptr<DType>(),
+                                                grad_sum,
+                                                ids.dptr<IType>(),
+                                                first,
+                                                param.lr,
+                                                param.epsilon,
+                                                param.wd,
+                                                param.rescale_grad,
+                                                param.clip_gradient);
+    });
+  });
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_INDEXED_OPTIMIZER_INL_H_
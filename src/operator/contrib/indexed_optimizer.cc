@@ -0,0 +1,240 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file indexed_optimizer.cc
+ * \brief Lazy optimizer updates of the rows of a dense weight given by unsorted row ids
+ */
+#include "./indexed_optimizer-inl.h"
+
+namespace mxnet {
+namespace op {
+
+template <>
+struct IndexedGradSum<cpu> {
+  template <typename IType, typename DType, typename AType>
+  static void Run(mshadow::Stream<cpu>* s,
+                  const IType* ids,
+                  const index_t num_ids,
+                  const index_t num_rows,
+                  const index_t row_length,
+                  const DType* grad,
+                  int* first,
+                  AType* grad_sum) {
+    for (index_t k = 0; k < num_ids; ++k) {
+      const index_t row = static_cast<index_t>(ids[k]);
+      if (row >= 0 && row < num_rows) {
+        first[row] = INT_MAX;
+      }
+    }
+    // only the rows of the first ids are written and read
+    for (index_t k = 0; k < num_ids; ++k) {
+      const index_t row = static_cast<index_t>(ids[k]);
+      if (row < 0 || row >= num_rows) {
+        continue;
+      }
+      const DType* src = grad + k * row_length;
+      if (first[row] == INT_MAX) {
+        first[row] = k;
+        AType* dst = grad_sum + k * row_length;
+        for (index_t j = 0; j < row_length; ++j) {
+          dst[j] = static_cast<AType>(src[j]);
+        }
+      } else {
+        AType* dst = grad_sum + first[row] * row_length;
+        for (index_t j = 0; j < row_length; ++j) {
+          dst[j] += static_cast<AType>(src[j]);
+        }
+      }
+    }
+  }
+};
+
+DMLC_REGISTER_PARAMETER(IndexedAdamParam);
+DMLC_REGISTER_PARAMETER(IndexedAdamWParam);
+DMLC_REGISTER_PARAMETER(IndexedFtrlParam);
+DMLC_REGISTER_PARAMETER(IndexedAdaGradParam);
+
+NNVM_REGISTER_OP(_contrib_indexed_adam_update)
+    .describe(R"code(Lazy Adam update of the rows of a dense weight given by unsorted, possibly
+duplicated row ids.
+
+The row ``ids[k]`` of the weight gets the gradient row ``grad[k]``, e.g. ``ids`` are the ids looked
+up by an embedding and ``grad`` the gradient of its output. The gradient rows of the duplicated ids
+of a row are summed, then the weight, mean and var rows of every id are updated once::
+
+  grad = sum(grad[k] for k with ids[k] == row) + wd * weight[row]
+  mean[row] = beta1 * mean[row] + (1 - beta1) * grad
+  var[row] = beta2 * var[row] + (1 - beta2) * grad ** 2
+  weight[row] = weight[row] - lr * mean[row] / (sqrt(var[row]) + epsilon)
+
+The ids are neither sorted nor made unique: on GPU, the gradient rows are summed with atomics.
+Out of range ids are ignored.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(5)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<IndexedAdamParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", IndexedUpdateShape<2>)
+    .set_attr<nnvm::FInferType>("FInferType", IndexedUpdateType<2>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{
+                                           "weight", "grad", "mean", "var", "ids"};
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{2, 3};
+                                   })
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", IndexedAdamUpdate<cpu>)
+    .add_argument("weight", "NDArray-or-Symbol", "Weight")
+    .add_argument("grad", "NDArray-or-Symbol", "Gradient rows of the ids")
+    .add_argument("mean", "NDArray-or-Symbol", "Moving mean")
+    .add_argument("var", "NDArray-or-Symbol", "Moving variance")
+    .add_argument("ids", "NDArray-or-Symbol", "Row ids of the gradient rows")
+    .add_arguments(IndexedAdamParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_indexed_adamw_update)
+    .describe(R"code(Lazy AdamW update of the rows of a dense weight given by unsorted, possibly
+duplicated row ids.
+
+The gradient rows of the duplicated ids of a row are summed, then the weight, mean and var rows
+of every id are updated once, with the weight decay decoupled from the gradient::
+
+  grad = sum(grad[k] for k with ids[k] == row)
+  mean[row] = beta1 * mean[row] + (1 - beta1) * grad
+  var[row] = beta2 * var[row] + (1 - beta2) * grad ** 2
+  weight[row] = weight[row] - eta * (lr * mean[row] / (sqrt(var[row]) + epsilon) + wd * weight[row])
+
+Out of range ids are ignored.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(5)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<IndexedAdamWParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", IndexedUpdateShape<2>)
+    .set_attr<nnvm::FInferType>("FInferType", IndexedUpdateType<2>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{
+                                           "weight", "grad", "mean", "var", "ids"};
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{2, 3};
+                                   })
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", IndexedAdamWUpdate<cpu>)
+    .add_argument("weight", "NDArray-or-Symbol", "Weight")
+    .add_argument("grad", "NDArray-or-Symbol", "Gradient rows of the ids")
+    .add_argument("mean", "NDArray-or-Symbol", "Moving mean")
+    .add_argument("var", "NDArray-or-Symbol", "Moving variance")
+    .add_argument("ids", "NDArray-or-Symbol", "Row ids of the gradient rows")
+    .add_arguments(IndexedAdamWParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_indexed_ftrl_update)
+    .describe(R"code(Lazy FTRL update of the rows of a dense weight given by unsorted, possibly
+duplicated row ids.
+
+The gradient rows of the duplicated ids of a row are summed, then the weight, z and n rows of
+every id are updated once::
+
+  grad = sum(grad[k] for k with ids[k] == row)
+  z[row] += grad - (sqrt(n[row] + grad ** 2) - sqrt(n[row])) * weight[row] / lr
+  n[row] += grad ** 2
+  d = (sign(z[row]) * lamda1 - z[row]) * (abs(z[row]) > lamda1)
+  weight[row] = d / ((beta + sqrt(n[row])) / lr + wd)
+
+Out of range ids are ignored.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(5)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<IndexedFtrlParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", IndexedUpdateShape<2>)
+    .set_attr<nnvm::FInferType>("FInferType", IndexedUpdateType<2>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{
+                                           "weight", "grad", "z", "n", "ids"};
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{2, 3};
+                                   })
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", IndexedFtrlUpdate<cpu>)
+    .add_argument("weight", "NDArray-or-Symbol", "Weight")
+    .add_argument("grad", "NDArray-or-Symbol", "Gradient rows of the ids")
+    .add_argument("z", "NDArray-or-Symbol", "z")
+    .add_argument("n", "NDArray-or-Symbol", "Square of grad")
+    .add_argument("ids", "NDArray-or-Symbol", "Row ids of the gradient rows")
+    .add_arguments(IndexedFtrlParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_indexed_adagrad_update)
+    .describe(R"code(Lazy AdaGrad update of the rows of a dense weight given by unsorted,
+possibly duplicated row ids.
+
+The gradient rows of the duplicated ids of a row are summed, then the weight and history rows of
+every id are updated once::
+
+  grad = sum(grad[k] for k with ids[k] == row) + wd * weight[row]
+  history[row] += grad ** 2
+  weight[row] = weight[row] - lr * grad / (sqrt(history[row]) + epsilon)
+
+Out of range ids are ignored.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(4)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<IndexedAdaGradParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", IndexedUpdateShape<1>)
+    .set_attr<nnvm::FInferType>("FInferType", IndexedUpdateType<1>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{
+                                           "weight", "grad", "history", "ids"};
+                                     })
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{2};
+                                   })
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", IndexedAdaGradUpdate<cpu>)
+    .add_argument("weight", "NDArray-or-Symbol", "Weight")
+    .add_argument("grad", "NDArray-or-Symbol", "Gradient rows of the ids")
+    .add_argument("history", "NDArray-or-Symbol", "History of the squared gradients")
+    .add_argument("ids", "NDArray-or-Symbol", "Row ids of the gradient rows")
+    .add_arguments(IndexedAdaGradParam::__FIELDS__());
+
+}  // namespace op
+}  // namespace mxnet
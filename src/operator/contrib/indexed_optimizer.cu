@@ -0,0 +1,105 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file indexed_optimizer.cu
+ * \brief Lazy optimizer updates of the rows of a dense weight given by unsorted row ids, GPU
+ *  implementation
+ */
+#include "./indexed_optimizer-inl.h"
+
+namespace mxnet {
+namespace op {
+
+struct IndexedResetFirstKernel {
+  template <typename IType>
+  MSHADOW_XINLINE static void Map(index_t k, const IType* ids, index_t num_rows, int* first) {
+    const index_t row = static_cast<index_t>(ids[k]);
+    if (row >= 0 && row < num_rows) {
+      first[row] = INT_MAX;
+    }
+  }
+};
+
+/*! \brief the first id of a row is the smallest k, so that the sums do not depend on the order */
+struct IndexedClaimFirstKernel {
+  template <typename IType>
+  MSHADOW_XINLINE static void Map(index_t k, const IType* ids, index_t num_rows, int* first) {
+    const index_t row = static_cast<index_t>(ids[k]);
+    if (row >= 0 && row < num_rows) {
+      atomicMin(&first[row], static_cast<int>(k));
+    }
+  }
+};
+
+/*!
+ * \brief scatters the element i of the gradient rows into the row of the first id of its row,
+ *  the atomics only contend on the duplicated ids
+ */
+struct IndexedScatterGradKernel {
+  template <typename IType, typename DType, typename AType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  const IType* ids,
+                                  index_t num_rows,
+                                  index_t row_length,
+                                  const DType* grad,
+                                  const int* first,
+                                  AType* grad_sum) {
+    const index_t row = static_cast<index_t>(ids[i / row_length]);
+    if (row >= 0 && row < num_rows) {
+      atomicAdd(&grad_sum[first[row] * row_length + i % row_length], static_cast<AType>(grad[i]));
+    }
+  }
+};
+
+template <>
+struct IndexedGradSum<gpu> {
+  template <typename IType, typename DType, typename AType>
+  static void Run(mshadow::Stream<gpu>* s,
+                  const IType* ids,
+                  const index_t num_ids,
+                  const index_t num_rows,
+                  const index_t row_length,
+                  const DType* grad,
+                  int* first,
+                  AType* grad_sum) {
+    using namespace mxnet_op;
+    const index_t size = num_ids * row_length;
+    CUDA_CALL(cudaMemsetAsync(grad_sum, 0, size * sizeof(AType), Stream<gpu>::GetStream(s)));
+    Kernel<IndexedResetFirstKernel, gpu>::Launch(s, num_ids, ids, num_rows, first);
+    Kernel<IndexedClaimFirstKernel, gpu>::Launch(s, num_ids, ids, num_rows, first);
+    Kernel<IndexedScatterGradKernel, gpu>::Launch(
+        s, size, ids, num_rows, row_length, grad, first, grad_sum);
+  }
+};
+
+NNVM_REGISTER_OP(_contrib_indexed_adam_update)
+    .set_attr<FCompute>("FCompute<gpu>", IndexedAdamUpdate<gpu>);
+
+NNVM_REGISTER_OP(_contrib_indexed_adamw_update)
+    .set_attr<FCompute>("FCompute<gpu>", IndexedAdamWUpdate<gpu>);
+
+NNVM_REGISTER_OP(_contrib_indexed_ftrl_update)
+    .set_attr<FCompute>("FCompute<gpu>", IndexedFtrlUpdate<gpu>);
+
+NNVM_REGISTER_OP(_contrib_indexed_adagrad_update)
+    .set_attr<FCompute>("FCompute<gpu>", IndexedAdaGradUpdate<gpu>);
+
+}  // namespace op
+}  // namespace mxnet
@@ -28,6 +28,7 @@
 
 #include <mxnet/operator.h>
 #include <vector>
+#include "../mxnet_op.h"
 #include "../operator_common.h"
 
 namespace multi_sum_sq {
@@ -82,6 +83,59 @@ inline bool MultiSumSqType(const NodeAttrs& attrs,
   return true;
 }
 
+struct MultiGlobalNormParam : public dmlc::Parameter<MultiGlobalNormParam> {
+  int num_arrays;
+  float scale;
+  float max_norm;
+
+  DMLC_DECLARE_PARAMETER(MultiGlobalNormParam) {
+    DMLC_DECLARE_FIELD(num_arrays).describe("number of input arrays.");
+    DMLC_DECLARE_FIELD(scale).set_default(1.0f).describe(
+        "Scaling factor of the arrays, e.g. the inverse of the loss scale times the gradient "
+        "normalization.");
+    DMLC_DECLARE_FIELD(max_norm).set_default(-1.0f).describe(
+        "Maximum of the global norm of the scaled arrays. If max_norm <= 0, the rescale output "
+        "is the scale.");
+  }
+};
+
+inline bool MultiGlobalNormShape(const NodeAttrs& attrs,
+                                 std::vector<mxnet::TShape>* in_shape,
+                                 std::vector<mxnet::TShape>* out_shape) {
+  const auto& p = dmlc::get<MultiGlobalNormParam>(attrs.parsed);
+  out_shape->resize(2);
+
+  SHAPE_ASSIGN_CHECK(*out_shape, 0, mxnet::TShape{1});
+  SHAPE_ASSIGN_CHECK(*out_shape, 1, mxnet::TShape{1});
+
+  CHECK_EQ(in_shape->size(), p.num_arrays);
+  for (auto s : *in_shape) {
+    if (s.ndim() == 0)
+      return false;
+  }
+  return true;
+}
+
+inline bool MultiGlobalNormType(const NodeAttrs& attrs,
+                                std::vector<int>* in_type,
+                                std::vector<int>* out_type) {
+  const auto& p = dmlc::get<MultiGlobalNormParam>(attrs.parsed);
+  CHECK_EQ(in_type->size(), p.num_arrays);
+  int dtype = (*in_type)[0];
+  CHECK_NE(dtype, -1) << "First input must have specified type";
+  for (size_t i = 0; i < in_type->size(); ++i) {
+    if ((*in_type)[i] == -1) {
+      (*in_type)[i] = dtype;
+    } else {
+      UNIFORM_TYPE_CHECK((*in_type)[i], dtype, "array_" + std::to_string(i));
+    }
+  }
+  out_type->clear();
+  out_type->push_back(mshadow::kFloat32);
+  out_type->push_back(mshadow::kFloat32);
+  return true;
+}
+
 template <typename xpu>
 size_t GetRequiredStorageMultiSumSq(const std::vector<TBlob>& inputs,
                                     int* param_max_chunks_per_tensor = nullptr);
@@ -105,6 +159,56 @@ void MultiSumSq(const nnvm::NodeAttrs& attrs,
   MultiSumSqRun<xpu>(inputs, p.num_arrays, out_ptr, ctx, p.scale);
 }
 
+/*!
+ * \brief global norm of the sums of squares of the arrays, and the factor the arrays are
+ *  rescaled by to clip it: a non-finite element makes the norm non-finite
+ */
+struct MultiGlobalNormKernel {
+  MSHADOW_XINLINE static void Map(int i,
+                                  float* norm,
+                                  float* rescale,
+                                  const float* sum_sq,
+                                  int num_arrays,
+                                  float scale,
+                                  float max_norm) {
+    float sum = 0;
+    for (int j = 0; j < num_arrays; ++j) {
+      sum += sum_sq[j];
+    }
+    const float total_norm = sqrtf(sum);
+    const bool clip        = max_norm > 0 && !(total_norm <= max_norm);
+    norm[0]                = total_norm;
+    rescale[0]             = clip ? scale * max_norm / (total_norm + 1e-8f) : scale;
+  }
+};
+
+template <typename xpu>
+void MultiGlobalNorm(const nnvm::NodeAttrs& attrs,
+                     const OpContext& ctx,
+                     const std::vector<TBlob>& inputs,
+                     const std::vector<OpReqType>& req,
+                     const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  auto s        = ctx.get_stream<xpu>();
+  const auto& p = dmlc::get<MultiGlobalNormParam>(attrs.parsed);
+  // the sums of squares of the arrays go after the storage MultiSumSqRun requests itself
+  const size_t required_storage_multi_sum_sq = GetRequiredStorageMultiSumSq<xpu>(inputs);
+  Tensor<xpu, 1, char> workspace =
+      ctx.requested[multi_sum_sq::kTempSpace].get_space_typed<xpu, 1, char>(
+          Shape1(required_storage_multi_sum_sq + p.num_arrays * sizeof(float)), s);
+  float* sum_sq = reinterpret_cast<float*>(&workspace[required_storage_multi_sum_sq]);
+  // the arrays are read once, every further step runs on the sums
+  MultiSumSqRun<xpu>(inputs, p.num_arrays, sum_sq, ctx, p.scale);
+  Kernel<MultiGlobalNormKernel, xpu>::Launch(s,
+                                             1,
+                                             outputs[0].dptr<float>(),
+                                             outputs[1].dptr<float>(),
+                                             sum_sq,
+                                             p.num_arrays,
+                                             p.scale,
+                                             p.max_norm);
+}
+
 }  // namespace op
 }  // namespace mxnet
 
@@ -58,6 +58,52 @@ NNVM_REGISTER_OP(multi_sum_sq)
     .add_argument("data", "NDArray-or-Symbol[]", "Arrays")
     .add_arguments(MultiSumSqParam::__FIELDS__());
 
+DMLC_REGISTER_PARAMETER(MultiGlobalNormParam);
+
+NNVM_REGISTER_OP(multi_global_norm)
+    .add_alias("_npi_multi_global_norm")
+    .describe(R"code(Compute the global L2 norm of multiple scaled arrays, and the factor that
+clips it to `max_norm`, reading every array once.
+
+The outputs are:
+
+- **norm**: sqrt(sum_i sum((scale * array_i) ** 2)), which is not finite if any element of the
+  arrays is not finite, so that it is also the overflow check of AMP.
+- **rescale**: scale * min(1, max_norm / norm) if max_norm > 0, otherwise scale. It is used as the
+  `rescale_grad` of the optimizer update, which unscales and clips the gradients in the same pass
+  as the update.
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const nnvm::NodeAttrs& attrs) {
+      return static_cast<uint32_t>(dmlc::get<MultiGlobalNormParam>(attrs.parsed).num_arrays);
+    })
+    .set_num_outputs(2)
+    .set_attr_parser(ParamParser<MultiGlobalNormParam>)
+    .set_attr<mxnet::FInferShape>("FInferShape", MultiGlobalNormShape)
+    .set_attr<nnvm::FInferType>("FInferType", MultiGlobalNormType)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       const auto& param =
+                                           dmlc::get<MultiGlobalNormParam>(attrs.parsed);
+                                       const uint32_t num_args = param.num_arrays;
+                                       std::vector<std::string> ret;
+                                       for (uint32_t i = 0; i < num_args; ++i) {
+                                         ret.push_back(std::string("array_") + std::to_string(i));
+                                       }
+                                       return ret;
+                                     })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"norm", "rescale"};
+                                      })
+    .set_attr<FCompute>("FCompute<cpu>", MultiGlobalNorm<cpu>)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .add_argument("data", "NDArray-or-Symbol[]", "Arrays")
+    .add_arguments(MultiGlobalNormParam::__FIELDS__());
+
 template <>
 size_t GetRequiredStorageMultiSumSq<cpu>(const std::vector<TBlob>& inputs,
                                          int* param_max_chunks_per_tensor) {
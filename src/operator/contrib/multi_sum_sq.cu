@@ -208,5 +208,7 @@ void MultiSumSqRun<gpu>(const std::vector<TBlob>& inputs,
 
 NNVM_REGISTER_OP(multi_sum_sq).set_attr<FCompute>("FCompute<gpu>", MultiSumSq<gpu>);
 
+NNVM_REGISTER_OP(multi_global_norm).set_attr<FCompute>("FCompute<gpu>", MultiGlobalNorm<gpu>);
+
 }  // namespace op
 }  // namespace mxnet
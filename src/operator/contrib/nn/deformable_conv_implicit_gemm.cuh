@@ -0,0 +1,154 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file deformable_conv_implicit_gemm.cuh
+ * \brief GPU kernel of the forward of the deformable convolutions as an implicit GEMM
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_NN_DEFORMABLE_CONV_IMPLICIT_GEMM_CUH_
+#define MXNET_OPERATOR_CONTRIB_NN_DEFORMABLE_CONV_IMPLICIT_GEMM_CUH_
+
+#include <mxnet/base.h>
+#include <algorithm>
+#include "../../mxnet_op.h"
+#include "../../../common/cuda/utils.h"
+
+namespace mxnet {
+namespace op {
+namespace cuda {
+
+/*! \brief the output channels, output pixels and reduction rows of a tile of the GEMM */
+constexpr int kDeformableTileM = 64;
+constexpr int kDeformableTileN = 64;
+constexpr int kDeformableTileK = 16;
+/*! \brief the threads of a block along each dimension, each computing 4x4 outputs */
+constexpr int kDeformableThreads = 16;
+
+/*!
+ * \brief Computes a kDeformableTileM x kDeformableTileN tile of the output of one group of one
+ *        image. The tiles of the im2col matrix are sampled into shared memory by the block, one
+ *        kDeformableTileK rows slice at a time, with the threads of a warp sampling consecutive
+ *        output pixels so that the reads of the offsets and masks are coalesced.
+ *        blockIdx.z strides over the images and the groups.
+ */
+template <bool modulated, typename DType>
+__global__ void __launch_bounds__(kDeformableThreads * kDeformableThreads)
+    deformable_conv_implicit_gemm_kernel(const DeformableConvGeometry geo,
+                                         const DType* data,
+                                         const DType* offset,
+                                         const DType* mask,
+                                         const DType* weight,
+                                         const DType* bias,
+                                         DType* out) {
+  using AType = typename mxnet_op::AccType<DType>::type;
+  __shared__ AType w_tile[kDeformableTileK][kDeformableTileM];
+  __shared__ AType col_tile[kDeformableTileK][kDeformableTileN];
+  constexpr int kThreads = kDeformableThreads * kDeformableThreads;
+  constexpr int kPerM    = kDeformableTileM / kDeformableThreads;
+  constexpr int kPerN    = kDeformableTileN / kDeformableThreads;
+  const index_t M        = geo.M();
+  const index_t N        = geo.N();
+  const index_t K        = geo.K();
+  const index_t m0       = static_cast<index_t>(blockIdx.y) * kDeformableTileM;
+  const index_t p0       = static_cast<index_t>(blockIdx.x) * kDeformableTileN;
+  const int tid          = threadIdx.y * kDeformableThreads + threadIdx.x;
+  for (index_t z = blockIdx.z; z < geo.num * geo.group; z += gridDim.z) {
+    const index_t n = z / geo.group;
+    const index_t g = z % geo.group;
+    AType acc[kPerM][kPerN];
+    for (int i = 0; i < kPerM; ++i) {
+      for (int j = 0; j < kPerN; ++j)
+        acc[i][j] = 0;
+    }
+    const DType* w = weight + g * M * K;
+    for (index_t k0 = 0; k0 < K; k0 += kDeformableTileK) {
+      for (int e = tid; e < kDeformableTileM * kDeformableTileK; e += kThreads) {
+        const index_t m = m0 + e / kDeformableTileK;
+        const index_t k = k0 + e % kDeformableTileK;
+        w_tile[e % kDeformableTileK][e / kDeformableTileK] =
+            m < M && k < K ? AType(w[m * K + k]) : AType(0);
+      }
+      for (int e = tid; e < kDeformableTileK * kDeformableTileN; e += kThreads) {
+        const index_t k = k0 + e / kDeformableTileN;
+        const index_t p = p0 + e % kDeformableTileN;
+        col_tile[e / kDeformableTileN][e % kDeformableTileN] =
+            k < K && p < N ? AType(geo.Sample<modulated>(data, offset, mask, n, g, k, p))
+                           : AType(0);
+      }
+      __syncthreads();
+#pragma unroll
+      for (int kk = 0; kk < kDeformableTileK; ++kk) {
+        AType a[kPerM], b[kPerN];
+        for (int i = 0; i < kPerM; ++i)
+          a[i] = w_tile[kk][threadIdx.y + i * kDeformableThreads];
+        for (int j = 0; j < kPerN; ++j)
+          b[j] = col_tile[kk][threadIdx.x + j * kDeformableThreads];
+        for (int i = 0; i < kPerM; ++i) {
+          for (int j = 0; j < kPerN; ++j)
+            acc[i][j] += a[i] * b[j];
+        }
+      }
+      __syncthreads();
+    }
+    for (int i = 0; i < kPerM; ++i) {
+      const index_t m = m0 + threadIdx.y + i * kDeformableThreads;
+      if (m >= M)
+        continue;
+      const AType b = bias ? AType(bias[g * M + m]) : AType(0);
+      DType* dst    = out + (n * geo.num_filter + g * M + m) * N;
+      for (int j = 0; j < kPerN; ++j) {
+        const index_t p = p0 + threadIdx.x + j * kDeformableThreads;
+        if (p < N)
+          dst[p] = DType(acc[i][j] + b);
+      }
+    }
+  }
+}
+
+}  // namespace cuda
+
+/*!
+ * \brief Forward of the deformable convolution on GPU.
+ * \param mask the mask of the modulated convolution, nullptr for the other one.
+ * \param bias the bias, or nullptr.
+ */
+template <bool modulated, typename DType>
+inline void deformable_conv_implicit_gemm(mshadow::Stream<gpu>* s,
+                                          const DeformableConvGeometry& geo,
+                                          const DType* data,
+                                          const DType* offset,
+                                          const DType* mask,
+                                          const DType* weight,
+                                          const DType* bias,
+                                          DType* out) {
+  using namespace cuda;
+  const dim3 block(kDeformableThreads, kDeformableThreads);
+  const dim3 grid((geo.N() + kDeformableTileN - 1) / kDeformableTileN,
+                  (geo.M() + kDeformableTileM - 1) / kDeformableTileM,
+                  std::min<index_t>(geo.num * geo.group, mshadow::cuda::kMaxGridNum));
+  deformable_conv_implicit_gemm_kernel<modulated, DType>
+      <<<grid, block, 0, mshadow::Stream<gpu>::GetStream(s)>>>(
+          geo, data, offset, mask, weight, bias, out);
+  MSHADOW_CUDA_POST_KERNEL_CHECK(deformable_conv_implicit_gemm_kernel);
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_NN_DEFORMABLE_CONV_IMPLICIT_GEMM_CUH_
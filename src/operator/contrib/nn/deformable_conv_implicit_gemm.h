@@ -0,0 +1,218 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file deformable_conv_implicit_gemm.h
+ * \brief Forward of the deformable convolutions as an implicit GEMM, which samples the input
+ *        bilinearly for each tile of the GEMM instead of materializing the deformable im2col
+ *        buffer of the whole image.
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_NN_DEFORMABLE_CONV_IMPLICIT_GEMM_H_
+#define MXNET_OPERATOR_CONTRIB_NN_DEFORMABLE_CONV_IMPLICIT_GEMM_H_
+
+#include <mxnet/base.h>
+#include <mxnet/operator.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "../../mxnet_op.h"
+
+namespace mxnet {
+namespace op {
+
+/*! \brief the geometry of a 2D deformable convolution in NCHW */
+struct DeformableConvGeometry {
+  index_t num, channels, height, width;
+  index_t num_filter, group, deformable_group;
+  index_t kernel_h, kernel_w, pad_h, pad_w, stride_h, stride_w, dilation_h, dilation_w;
+  index_t height_col, width_col;
+
+  DeformableConvGeometry(const mxnet::TShape& im_shape,
+                         const mxnet::TShape& out_shape,
+                         const mxnet::TShape& kernel,
+                         const mxnet::TShape& pad,
+                         const mxnet::TShape& stride,
+                         const mxnet::TShape& dilation,
+                         index_t num_group,
+                         index_t num_deformable_group)
+      : num(im_shape[0]),
+        channels(im_shape[1]),
+        height(im_shape[2]),
+        width(im_shape[3]),
+        num_filter(out_shape[1]),
+        group(num_group),
+        deformable_group(num_deformable_group),
+        kernel_h(kernel[0]),
+        kernel_w(kernel[1]),
+        pad_h(pad[0]),
+        pad_w(pad[1]),
+        stride_h(stride[0]),
+        stride_w(stride[1]),
+        dilation_h(dilation[0]),
+        dilation_w(dilation[1]),
+        height_col(out_shape[2]),
+        width_col(out_shape[3]) {}
+
+  /*! \brief rows of the GEMM of a group: its output channels */
+  MSHADOW_XINLINE index_t M() const {
+    return num_filter / group;
+  }
+  /*! \brief columns of the GEMM: the output pixels */
+  MSHADOW_XINLINE index_t N() const {
+    return height_col * width_col;
+  }
+  /*! \brief reduction of the GEMM of a group: its input channels by the kernel taps */
+  MSHADOW_XINLINE index_t K() const {
+    return channels / group * kernel_h * kernel_w;
+  }
+
+  /*!
+   * \brief The element (k, p) of the deformable im2col matrix of group g of image n: input channel
+   *        k / (kernel_h * kernel_w) of the group sampled at the tap k % (kernel_h * kernel_w) of
+   *        output pixel p, moved by its offset and scaled by its mask when given.
+   *        The modulated convolution samples the pixels partly outside of the image with zeros,
+   *        the other one clamps the samples to the image.
+   */
+  template <bool modulated, typename DType>
+  MSHADOW_XINLINE DType Sample(const DType* data,
+                               const DType* offset,
+                               const DType* mask,
+                               index_t n,
+                               index_t g,
+                               index_t k,
+                               index_t p) const {
+    const index_t taps = kernel_h * kernel_w;
+    const index_t c    = g * (channels / group) + k / taps;
+    const index_t tap  = k % taps;
+    const index_t dg   = c / (channels / deformable_group);
+    const index_t base = (n * deformable_group + dg) * taps;
+    const index_t h_in = p / width_col * stride_h - pad_h + tap / kernel_w * dilation_h;
+    const index_t w_in = p % width_col * stride_w - pad_w + tap % kernel_w * dilation_w;
+    const DType h      = static_cast<DType>(h_in) + offset[(2 * (base + tap)) * N() + p];
+    const DType w      = static_cast<DType>(w_in) + offset[(2 * (base + tap) + 1) * N() + p];
+    const DType* im    = data + (n * channels + c) * height * width;
+    DType val          = 0;
+    if (modulated) {
+      if (h > -1 && w > -1 && h < height && w < width) {
+        const index_t h_low = floor(h), w_low = floor(w);
+        const DType lh      = h - h_low, lw = w - w_low;
+        const DType hh      = 1 - lh, hw = 1 - lw;
+        const bool top      = h_low >= 0, bottom = h_low + 1 <= height - 1;
+        const bool left     = w_low >= 0, right = w_low + 1 <= width - 1;
+        const DType* row    = im + h_low * width + w_low;
+        if (top && left)
+          val += hh * hw * row[0];
+        if (top && right)
+          val += hh * lw * row[1];
+        if (bottom && left)
+          val += lh * hw * row[width];
+        if (bottom && right)
+          val += lh * lw * row[width + 1];
+      }
+      return val * mask[(base + tap) * N() + p];
+    }
+    if (h >= 0 && w >= 0 && h < height && w < width) {
+      index_t h_low  = floor(h), w_low = floor(w);
+      index_t h_high = h_low + 1, w_high = w_low + 1;
+      DType hs       = h, ws = w;
+      if (h_low >= height - 1) {
+        h_high = h_low = height - 1;
+        hs             = static_cast<DType>(h_low);
+      }
+      if (w_low >= width - 1) {
+        w_high = w_low = width - 1;
+        ws             = static_cast<DType>(w_low);
+      }
+      const DType lh = hs - h_low, lw = ws - w_low;
+      const DType hh = 1 - lh, hw = 1 - lw;
+      val            = hh * hw * im[h_low * width + w_low] + hh * lw * im[h_low * width + w_high] +
+            lh * hw * im[h_high * width + w_low] + lh * lw * im[h_high * width + w_high];
+    }
+    return val;
+  }
+};
+
+/*! \brief the output pixels and the reduction rows of the panels sampled on CPU */
+constexpr index_t kDeformablePanelCols = 64;
+constexpr index_t kDeformablePanelRows = 64;
+
+/*!
+ * \brief Forward of the deformable convolution on CPU. Each task computes the output of a block
+ *        of kDeformablePanelCols pixels of one group of one image, sampling the im2col matrix in
+ *        panels of kDeformablePanelRows rows small enough to stay in the L1 and L2 caches.
+ * \param mask the mask of the modulated convolution, nullptr for the other one.
+ * \param bias the bias, or nullptr.
+ */
+template <bool modulated, typename DType>
+inline void deformable_conv_implicit_gemm(mshadow::Stream<cpu>* s,
+                                          const DeformableConvGeometry& geo,
+                                          const DType* data,
+                                          const DType* offset,
+                                          const DType* mask,
+                                          const DType* weight,
+                                          const DType* bias,
+                                          DType* out) {
+  const index_t M          = geo.M();
+  const index_t N          = geo.N();
+  const index_t K          = geo.K();
+  const index_t col_blocks = (N + kDeformablePanelCols - 1) / kDeformablePanelCols;
+  const index_t num_tasks  = geo.num * geo.group * col_blocks;
+#pragma omp parallel num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
+  {
+    std::vector<DType> panel(kDeformablePanelRows * kDeformablePanelCols);
+#pragma omp for
+    for (index_t t = 0; t < num_tasks; ++t) {
+      const index_t n  = t / (geo.group * col_blocks);
+      const index_t g  = t / col_blocks % geo.group;
+      const index_t p0 = t % col_blocks * kDeformablePanelCols;
+      const index_t np = std::min(kDeformablePanelCols, N - p0);
+      DType* dst       = out + (n * geo.num_filter + g * M) * N + p0;
+      for (index_t m = 0; m < M; ++m) {
+        const DType b = bias ? bias[g * M + m] : DType(0);
+        std::fill(dst + m * N, dst + m * N + np, b);
+      }
+      for (index_t k0 = 0; k0 < K; k0 += kDeformablePanelRows) {
+        const index_t nk = std::min(kDeformablePanelRows, K - k0);
+        for (index_t k = 0; k < nk; ++k) {
+          for (index_t p = 0; p < np; ++p) {
+            panel[k * kDeformablePanelCols + p] =
+                geo.Sample<modulated>(data, offset, mask, n, g, k0 + k, p0 + p);
+          }
+        }
+        const DType* w = weight + g * M * K + k0;
+        for (index_t m = 0; m < M; ++m) {
+          DType* row = dst + m * N;
+          for (index_t k = 0; k < nk; ++k) {
+            const DType a    = w[m * K + k];
+            const DType* col = &panel[k * kDeformablePanelCols];
+            for (index_t p = 0; p < np; ++p)
+              row[p] += a * col[p];
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace op
+}  // namespace mxnet
+#ifdef __CUDACC__
+#include "./deformable_conv_implicit_gemm.cuh"
+#endif
+#endif  // MXNET_OPERATOR_CONTRIB_NN_DEFORMABLE_CONV_IMPLICIT_GEMM_H_
@@ -0,0 +1,282 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file paged_attention-inl.h
+ * \brief a key/value cache split into fixed size blocks for incremental decoding, and the
+ *  attention of the new tokens of each sequence over its blocks in place
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_PAGED_ATTENTION_INL_H_
+#define MXNET_OPERATOR_CONTRIB_PAGED_ATTENTION_INL_H_
+
+#include <dmlc/logging.h>
+#include <dmlc/optional.h>
+#include <dmlc/parameter.h>
+#include <mxnet/operator_util.h>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+
+namespace mxnet {
+namespace op {
+
+namespace paged_kv {
+enum AppendKVOpInputs { kKeyCache, kValueCache, kKey, kValue, kBlockTable, kPositions };
+enum PagedAttentionOpInputs { kQuery, kQueryKeyCache, kQueryValueCache, kQueryBlockTable, kSeqLens };
+}  // namespace paged_kv
+
+struct PagedAttentionParam : public dmlc::Parameter<PagedAttentionParam> {
+  dmlc::optional<float> scale;
+  DMLC_DECLARE_PARAMETER(PagedAttentionParam) {
+    DMLC_DECLARE_FIELD(scale)
+        .set_default(dmlc::optional<float>())
+        .describe("The scale of the scores, 1 / sqrt(head_dim) if not given.");
+  }
+};
+
+/*!
+ * \brief the sizes of a paged cache and of the tokens of a batch. A cache of shape
+ *  (num_blocks, heads, block_size, dim) holds block_size consecutive tokens of one sequence in
+ *  each block, logical block p of sequence b is block_table[b, p].
+ */
+struct PagedKVDims {
+  index_t batch;
+  index_t heads;
+  index_t tokens;
+  index_t num_blocks;
+  index_t block_size;
+  index_t max_blocks;
+  index_t dim;
+};
+
+/*! \brief the offset in a cache of the given row of token pos of sequence b and head h */
+MSHADOW_XINLINE index_t PagedKVOffset(const int32_t* block_table,
+                                      const PagedKVDims& dims,
+                                      const index_t b,
+                                      const index_t h,
+                                      const index_t pos) {
+  // out of range blocks are rejected on CPU, on GPU they are clipped
+  const index_t logical = pos / dims.block_size;
+  index_t block = block_table[b * dims.max_blocks +
+                              (logical < dims.max_blocks ? logical : dims.max_blocks - 1)];
+  block = block < 0 ? 0 : (block >= dims.num_blocks ? dims.num_blocks - 1 : block);
+  return ((block * dims.heads + h) * dims.block_size + pos % dims.block_size) * dims.dim;
+}
+
+/*!
+ * \brief copies element i of the (batch, heads, tokens, dim) keys or values into the cache,
+ *  token t of sequence b goes to position positions[b] + t
+ */
+struct paged_kv_append {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* cache,
+                                  const DType* data,
+                                  const int32_t* block_table,
+                                  const int32_t* positions,
+                                  const PagedKVDims dims) {
+    const index_t d = i % dims.dim;
+    const index_t t = (i / dims.dim) % dims.tokens;
+    const index_t h = (i / (dims.dim * dims.tokens)) % dims.heads;
+    const index_t b = i / (dims.dim * dims.tokens * dims.heads);
+    cache[PagedKVOffset(block_table, dims, b, h, positions[b] + t) + d] = data[i];
+  }
+};
+
+inline PagedKVDims PagedKVGetDims(const TBlob& tokens,
+                                  const TBlob& cache,
+                                  const TBlob& block_table) {
+  return {tokens.shape_[0],
+          tokens.shape_[1],
+          tokens.shape_[2],
+          cache.shape_[0],
+          cache.shape_[2],
+          block_table.shape_[1],
+          cache.shape_[3]};
+}
+
+/*!
+ * \brief checks on CPU that tokens [begins[b], ends[b]) of every sequence have a valid block
+ *  in the table, the GPU kernels clip instead
+ */
+inline void PagedKVCheckBlocks(const PagedKVDims& dims,
+                               const int32_t* block_table,
+                               const int32_t* begins,
+                               const int32_t* ends) {
+  for (index_t b = 0; b < dims.batch; ++b) {
+    const index_t begin = begins == nullptr ? 0 : begins[b];
+    const index_t end   = ends[b];
+    CHECK(begin >= 0 && end <= dims.max_blocks * dims.block_size)
+        << "tokens [" << begin << ", " << end << ") of sequence " << b
+        << " do not fit in the block table of " << dims.max_blocks << " blocks of size "
+        << dims.block_size;
+    for (index_t pos = begin; pos < end; pos += dims.block_size) {
+      const int32_t block = block_table[b * dims.max_blocks + pos / dims.block_size];
+      CHECK(block >= 0 && block < dims.num_blocks)
+          << "block " << block << " of sequence " << b << " is out of range [0, "
+          << dims.num_blocks << ")";
+    }
+  }
+}
+
+inline bool AppendKVOpShape(const nnvm::NodeAttrs& attrs,
+                            mxnet::ShapeVector* in_attrs,
+                            mxnet::ShapeVector* out_attrs) {
+  using namespace paged_kv;
+  CHECK_EQ(in_attrs->size(), 6U);
+  CHECK_EQ(out_attrs->size(), 0U);
+  const mxnet::TShape& kcache = (*in_attrs)[kKeyCache];
+  const mxnet::TShape& vcache = (*in_attrs)[kValueCache];
+  const mxnet::TShape& kshape = (*in_attrs)[kKey];
+  const mxnet::TShape& vshape = (*in_attrs)[kValue];
+  const mxnet::TShape& table  = (*in_attrs)[kBlockTable];
+  if (!mxnet::shape_is_known(kcache) || !mxnet::shape_is_known(vcache) ||
+      !mxnet::shape_is_known(kshape) || !mxnet::shape_is_known(vshape) ||
+      !mxnet::ndim_is_known(table)) {
+    return false;
+  }
+  CHECK_EQ(kcache.ndim(), 4) << "key_cache should be of shape (num_blocks, heads, block_size, dim)";
+  CHECK_EQ(kshape.ndim(), 4) << "key should be of shape (batch, heads, tokens, dim)";
+  CHECK(kcache[0] == vcache[0] && kcache[1] == vcache[1] && kcache[2] == vcache[2])
+      << "key_cache " << kcache << " and value_cache " << vcache << " do not match";
+  CHECK(kshape[1] == kcache[1] && kshape[3] == kcache[3])
+      << "key " << kshape << " does not match key_cache " << kcache;
+  SHAPE_ASSIGN_CHECK(*in_attrs, kValue, mxnet::TShape({kshape[0], kshape[1], kshape[2], vcache[3]}));
+  CHECK_EQ(table.ndim(), 2) << "block_table should be of shape (batch, max_blocks)";
+  CHECK_EQ(table[0], kshape[0]) << "block_table " << table << " does not match key " << kshape;
+  SHAPE_ASSIGN_CHECK(*in_attrs, kPositions, mxnet::TShape(1, kshape[0]));
+  return true;
+}
+
+inline bool AppendKVOpType(const nnvm::NodeAttrs& attrs,
+                           std::vector<int>* in_attrs,
+                           std::vector<int>* out_attrs) {
+  using namespace paged_kv;
+  CHECK_EQ(in_attrs->size(), 6U);
+  CHECK_EQ(out_attrs->size(), 0U);
+  const int dtype = (*in_attrs)[kKeyCache];
+  if (dtype == -1)
+    return false;
+  for (int i : {kValueCache, kKey, kValue}) {
+    TYPE_ASSIGN_CHECK(*in_attrs, i, dtype);
+  }
+  TYPE_ASSIGN_CHECK(*in_attrs, kBlockTable, mshadow::kInt32);
+  TYPE_ASSIGN_CHECK(*in_attrs, kPositions, mshadow::kInt32);
+  return true;
+}
+
+inline bool PagedAttentionOpShape(const nnvm::NodeAttrs& attrs,
+                                  mxnet::ShapeVector* in_attrs,
+                                  mxnet::ShapeVector* out_attrs) {
+  using namespace paged_kv;
+  CHECK_EQ(in_attrs->size(), 5U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  const mxnet::TShape& qshape = (*in_attrs)[kQuery];
+  const mxnet::TShape& kcache = (*in_attrs)[kQueryKeyCache];
+  const mxnet::TShape& vcache = (*in_attrs)[kQueryValueCache];
+  const mxnet::TShape& table  = (*in_attrs)[kQueryBlockTable];
+  if (!mxnet::shape_is_known(qshape) || !mxnet::shape_is_known(kcache) ||
+      !mxnet::shape_is_known(vcache) || !mxnet::ndim_is_known(table)) {
+    return false;
+  }
+  CHECK_EQ(qshape.ndim(), 4) << "query should be of shape (batch, heads, tokens, dim)";
+  CHECK_EQ(kcache.ndim(), 4) << "key_cache should be of shape (num_blocks, heads, block_size, dim)";
+  CHECK(kcache[0] == vcache[0] && kcache[1] == vcache[1] && kcache[2] == vcache[2])
+      << "key_cache " << kcache << " and value_cache " << vcache << " do not match";
+  CHECK(qshape[1] == kcache[1] && qshape[3] == kcache[3])
+      << "query " << qshape << " does not match key_cache " << kcache;
+  CHECK_EQ(table.ndim(), 2) << "block_table should be of shape (batch, max_blocks)";
+  CHECK_EQ(table[0], qshape[0]) << "block_table " << table << " does not match query " << qshape;
+  SHAPE_ASSIGN_CHECK(*in_attrs, kSeqLens, mxnet::TShape(1, qshape[0]));
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, mxnet::TShape({qshape[0], qshape[1], qshape[2], vcache[3]}));
+  return true;
+}
+
+inline bool PagedAttentionOpType(const nnvm::NodeAttrs& attrs,
+                                 std::vector<int>* in_attrs,
+                                 std::vector<int>* out_attrs) {
+  using namespace paged_kv;
+  CHECK_EQ(in_attrs->size(), 5U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  int dtype = (*in_attrs)[kQuery];
+  if (dtype == -1)
+    dtype = (*in_attrs)[kQueryKeyCache];
+  if (dtype == -1)
+    return false;
+  for (int i : {kQuery, kQueryKeyCache, kQueryValueCache}) {
+    TYPE_ASSIGN_CHECK(*in_attrs, i, dtype);
+  }
+  TYPE_ASSIGN_CHECK(*in_attrs, kQueryBlockTable, mshadow::kInt32);
+  TYPE_ASSIGN_CHECK(*in_attrs, kSeqLens, mshadow::kInt32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, dtype);
+  return true;
+}
+
+template <typename xpu>
+void AppendKVOpForward(const nnvm::NodeAttrs& attrs,
+                       const OpContext& ctx,
+                       const std::vector<TBlob>& inputs,
+                       const std::vector<OpReqType>& req,
+                       const std::vector<TBlob>& outputs) {
+  using namespace paged_kv;
+  using namespace mxnet_op;
+  mshadow::Stream<xpu>* s    = ctx.get_stream<xpu>();
+  const TBlob& block_table   = inputs[kBlockTable];
+  const TBlob& positions     = inputs[kPositions];
+  const PagedKVDims key_dims = PagedKVGetDims(inputs[kKey], inputs[kKeyCache], block_table);
+  PagedKVDims value_dims     = key_dims;
+  value_dims.dim             = inputs[kValueCache].shape_[3];
+  if (std::is_same<xpu, cpu>::value) {
+    std::vector<int32_t> ends(key_dims.batch);
+    for (index_t b = 0; b < key_dims.batch; ++b) {
+      ends[b] = positions.dptr<int32_t>()[b] + key_dims.tokens;
+    }
+    PagedKVCheckBlocks(key_dims, block_table.dptr<int32_t>(), positions.dptr<int32_t>(), ends.data());
+  }
+  MSHADOW_TYPE_SWITCH(inputs[kKeyCache].type_flag_, DType, {
+    Kernel<paged_kv_append, xpu>::Launch(s,
+                                         inputs[kKey].Size(),
+                                         inputs[kKeyCache].dptr<DType>(),
+                                         inputs[kKey].dptr<DType>(),
+                                         block_table.dptr<int32_t>(),
+                                         positions.dptr<int32_t>(),
+                                         key_dims);
+    Kernel<paged_kv_append, xpu>::Launch(s,
+                                         inputs[kValue].Size(),
+                                         inputs[kValueCache].dptr<DType>(),
+                                         inputs[kValue].dptr<DType>(),
+                                         block_table.dptr<int32_t>(),
+                                         positions.dptr<int32_t>(),
+                                         value_dims);
+  });
+}
+
+template <typename xpu>
+void PagedAttentionOpForward(const nnvm::NodeAttrs& attrs,
+                             const OpContext& ctx,
+                             const std::vector<TBlob>& inputs,
+                             const std::vector<OpReqType>& req,
+                             const std::vector<TBlob>& outputs);
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_PAGED_ATTENTION_INL_H_
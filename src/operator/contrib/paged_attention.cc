@@ -0,0 +1,232 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file paged_attention.cc
+ * \brief CPU implementation of the paged key/value cache operators
+ */
+#include <algorithm>
+#include <limits>
+#include "./paged_attention-inl.h"
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * \brief the attention of token t of sequence b and head h over the tokens of the sequence up to
+ *  its own, one block of the cache at a time with an online softmax
+ */
+template <typename DType, typename AType>
+void PagedAttentionRowCPU(const PagedKVDims& key_dims,
+                          const PagedKVDims& value_dims,
+                          const index_t b,
+                          const index_t h,
+                          const index_t t,
+                          const AType scale,
+                          const DType* query,
+                          const DType* key_cache,
+                          const DType* value_cache,
+                          const int32_t* block_table,
+                          const int32_t* seq_lens,
+                          const OpReqType req,
+                          DType* out,
+                          AType* scores,
+                          AType* acc) {
+  const index_t row  = (b * key_dims.heads + h) * key_dims.tokens + t;
+  const index_t len  = seq_lens[b] - key_dims.tokens + t + 1;
+  const DType* q_row = query + row * key_dims.dim;
+  AType row_max      = -std::numeric_limits<AType>::infinity();
+  AType row_sum      = 0;
+  std::fill(acc, acc + value_dims.dim, AType(0));
+  for (index_t p0 = 0; p0 < len; p0 += key_dims.block_size) {
+    const index_t n         = std::min(key_dims.block_size, len - p0);
+    const DType* k_block    = key_cache + PagedKVOffset(block_table, key_dims, b, h, p0);
+    const DType* v_block    = value_cache + PagedKVOffset(block_table, value_dims, b, h, p0);
+    AType tile_max          = -std::numeric_limits<AType>::infinity();
+    for (index_t c = 0; c < n; ++c) {
+      const DType* k_row = k_block + c * key_dims.dim;
+      AType dot          = 0;
+#pragma omp simd reduction(+ : dot)
+      for (index_t d = 0; d < key_dims.dim; ++d) {
+        dot += static_cast<AType>(q_row[d]) * static_cast<AType>(k_row[d]);
+      }
+      scores[c] = scale * dot;
+      tile_max  = std::max(tile_max, scores[c]);
+    }
+    const AType new_max = std::max(row_max, tile_max);
+    const AType correct = std::exp(row_max - new_max);
+    row_sum *= correct;
+#pragma omp simd
+    for (index_t d = 0; d < value_dims.dim; ++d) {
+      acc[d] *= correct;
+    }
+    for (index_t c = 0; c < n; ++c) {
+      const AType p      = std::exp(scores[c] - new_max);
+      const DType* v_row = v_block + c * value_dims.dim;
+      row_sum += p;
+#pragma omp simd
+      for (index_t d = 0; d < value_dims.dim; ++d) {
+        acc[d] += p * static_cast<AType>(v_row[d]);
+      }
+    }
+    row_max = new_max;
+  }
+  DType* out_row = out + row * value_dims.dim;
+  for (index_t d = 0; d < value_dims.dim; ++d) {
+    KERNEL_ASSIGN(out_row[d], req, static_cast<DType>(acc[d] / row_sum));
+  }
+}
+
+template <>
+void PagedAttentionOpForward<cpu>(const nnvm::NodeAttrs& attrs,
+                                  const OpContext& ctx,
+                                  const std::vector<TBlob>& inputs,
+                                  const std::vector<OpReqType>& req,
+                                  const std::vector<TBlob>& outputs) {
+  using namespace paged_kv;
+  const PagedAttentionParam& param = nnvm::get<PagedAttentionParam>(attrs.parsed);
+  if (req[0] == kNullOp)
+    return;
+  const TBlob& block_table = inputs[kQueryBlockTable];
+  const int32_t* seq_lens  = inputs[kSeqLens].dptr<int32_t>();
+  const PagedKVDims key_dims =
+      PagedKVGetDims(inputs[kQuery], inputs[kQueryKeyCache], block_table);
+  PagedKVDims value_dims = key_dims;
+  value_dims.dim         = inputs[kQueryValueCache].shape_[3];
+  for (index_t b = 0; b < key_dims.batch; ++b) {
+    CHECK_GE(seq_lens[b], key_dims.tokens)
+        << "sequence " << b << " of length " << seq_lens[b] << " does not hold the "
+        << key_dims.tokens << " tokens of the query, append them to the cache first";
+  }
+  PagedKVCheckBlocks(key_dims, block_table.dptr<int32_t>(), nullptr, seq_lens);
+  const index_t rows = key_dims.batch * key_dims.heads * key_dims.tokens;
+  const float scale  = param.scale.has_value() ?
+                          param.scale.value() :
+                          1.0f / std::sqrt(static_cast<float>(key_dims.dim));
+  MSHADOW_REAL_TYPE_SWITCH_EX(inputs[kQuery].type_flag_, DType, AType, {
+#pragma omp parallel num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
+    {
+      std::vector<AType> scores(key_dims.block_size), acc(value_dims.dim);
+      // the sequences of a batch differ in length, hand the rows out one at a time
+#pragma omp for schedule(dynamic)
+      for (index_t r = 0; r < rows; ++r) {
+        PagedAttentionRowCPU(key_dims,
+                             value_dims,
+                             r / (key_dims.heads * key_dims.tokens),
+                             (r / key_dims.tokens) % key_dims.heads,
+                             r % key_dims.tokens,
+                             static_cast<AType>(scale),
+                             inputs[kQuery].dptr<DType>(),
+                             inputs[kQueryKeyCache].dptr<DType>(),
+                             inputs[kQueryValueCache].dptr<DType>(),
+                             block_table.dptr<int32_t>(),
+                             seq_lens,
+                             req[0],
+                             outputs[0].dptr<DType>(),
+                             scores.data(),
+                             acc.data());
+      }
+    }
+  });
+}
+
+DMLC_REGISTER_PARAMETER(PagedAttentionParam);
+
+NNVM_REGISTER_OP(_contrib_append_kv)
+    .describe(R"code(Writes the keys and values of new tokens into a paged key/value cache in place.
+
+The caches ``key_cache`` of shape ``(num_blocks, heads, block_size, head_dim)`` and
+``value_cache`` of shape ``(num_blocks, heads, block_size, value_dim)`` are pools of blocks of
+``block_size`` tokens. Row ``b`` of ``block_table``, of shape ``(batch, max_blocks)``, lists the
+blocks that hold the tokens of sequence ``b`` in order, so token ``pos`` of the sequence is row
+``pos % block_size`` of block ``block_table[b, pos // block_size]``.
+
+The ``tokens`` new keys of shape ``(batch, heads, tokens, head_dim)`` and values of shape
+``(batch, heads, tokens, value_dim)`` of sequence ``b`` are written to its positions
+``positions[b]`` to ``positions[b] + tokens - 1``. Nothing is copied or reallocated as the
+sequences grow, a new block only has to be added to the table every ``block_size`` tokens. The
+blocks of a finished sequence can be given to the next one by the caller, the blocks of a
+batch do not need to be contiguous or in order.
+
+The caches are updated in place and the operator has no output. On CPU, positions outside of
+the table and blocks out of range raise an error, on GPU they are clipped.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(6)
+    .set_num_outputs(0)
+    .set_attr<nnvm::FMutateInputs>("FMutateInputs",
+                                   [](const nnvm::NodeAttrs& attrs) {
+                                     return std::vector<uint32_t>{paged_kv::kKeyCache,
+                                                                  paged_kv::kValueCache};
+                                   })
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{
+              "key_cache", "value_cache", "key", "value", "block_table", "positions"};
+        })
+    .set_attr<mxnet::FInferShape>("FInferShape", AppendKVOpShape)
+    .set_attr<nnvm::FInferType>("FInferType", AppendKVOpType)
+    .set_attr<FCompute>("FCompute<cpu>", AppendKVOpForward<cpu>)
+    .add_argument("key_cache", "NDArray-or-Symbol", "The paged key cache, updated in place.")
+    .add_argument("value_cache", "NDArray-or-Symbol", "The paged value cache, updated in place.")
+    .add_argument("key", "NDArray-or-Symbol", "The keys of the new tokens.")
+    .add_argument("value", "NDArray-or-Symbol", "The values of the new tokens.")
+    .add_argument("block_table", "NDArray-or-Symbol", "The int32 blocks of each sequence.")
+    .add_argument("positions",
+                  "NDArray-or-Symbol",
+                  "The int32 position of the first new token of each sequence.");
+
+NNVM_REGISTER_OP(_contrib_paged_attention)
+    .describe(R"code(Scaled dot-product attention of new tokens over a paged key/value cache.
+
+For ``query`` of shape ``(batch, heads, tokens, head_dim)`` and the caches and ``block_table``
+described in ``append_kv``, the ``tokens`` queries of sequence ``b`` are its last tokens, the
+ones at positions ``seq_lens[b] - tokens`` to ``seq_lens[b] - 1``. Each attends to the keys of
+the sequence up to its own position, which have to be in the cache already. The output has
+shape ``(batch, heads, tokens, value_dim)``.
+
+The blocks are read in place, one at a time with an online softmax, so a decoding step costs
+one pass over the cached tokens of each sequence and no temporary of their size.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(5)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<PagedAttentionParam>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          return std::vector<std::string>{
+              "query", "key_cache", "value_cache", "block_table", "seq_lens"};
+        })
+    .set_attr<mxnet::FInferShape>("FInferShape", PagedAttentionOpShape)
+    .set_attr<nnvm::FInferType>("FInferType", PagedAttentionOpType)
+    .set_attr<FCompute>("FCompute<cpu>", PagedAttentionOpForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .add_argument("query", "NDArray-or-Symbol", "The queries of the new tokens.")
+    .add_argument("key_cache", "NDArray-or-Symbol", "The paged key cache.")
+    .add_argument("value_cache", "NDArray-or-Symbol", "The paged value cache.")
+    .add_argument("block_table", "NDArray-or-Symbol", "The int32 blocks of each sequence.")
+    .add_argument("seq_lens",
+                  "NDArray-or-Symbol",
+                  "The int32 length of each sequence, including the new tokens.")
+    .add_arguments(PagedAttentionParam::__FIELDS__());
+
+}  // namespace op
+}  // namespace mxnet
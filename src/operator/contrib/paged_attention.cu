@@ -0,0 +1,159 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file paged_attention.cu
+ * \brief GPU implementation of the paged key/value cache operators
+ */
+#include "./paged_attention-inl.h"
+
+namespace mxnet {
+namespace op {
+
+constexpr int kPagedAttentionThreadsGPU = 128;
+
+/*!
+ * \brief one block per query row: the threads share the scores of a block of the cache, then
+ *  the weighted sum of its values, one element of the output row each
+ */
+template <typename DType, typename AType>
+__global__ void PagedAttentionKernel(const PagedKVDims key_dims,
+                                     const PagedKVDims value_dims,
+                                     const AType scale,
+                                     const DType* query,
+                                     const DType* key_cache,
+                                     const DType* value_cache,
+                                     const int32_t* block_table,
+                                     const int32_t* seq_lens,
+                                     const OpReqType req,
+                                     DType* out) {
+  extern __shared__ char paged_attention_buf[];
+  AType* q_s     = reinterpret_cast<AType*>(paged_attention_buf);
+  AType* acc     = q_s + key_dims.dim;
+  AType* p_s     = acc + value_dims.dim;
+  AType* row_max = p_s + key_dims.block_size;
+  AType* row_sum = row_max + 1;
+  AType* correct = row_sum + 1;
+
+  const index_t row = blockIdx.x;
+  const index_t t   = row % key_dims.tokens;
+  const index_t h   = (row / key_dims.tokens) % key_dims.heads;
+  const index_t b   = row / (key_dims.tokens * key_dims.heads);
+  // a sequence shorter than its query sees its first token only
+  const index_t len = max(seq_lens[b] - key_dims.tokens + t + 1, static_cast<index_t>(1));
+  for (index_t d = threadIdx.x; d < key_dims.dim; d += blockDim.x) {
+    q_s[d] = scale * static_cast<AType>(query[row * key_dims.dim + d]);
+  }
+  for (index_t d = threadIdx.x; d < value_dims.dim; d += blockDim.x) {
+    acc[d] = 0;
+  }
+  if (threadIdx.x == 0) {
+    *row_max = -INFINITY;
+    *row_sum = 0;
+  }
+  __syncthreads();
+  for (index_t p0 = 0; p0 < len; p0 += key_dims.block_size) {
+    const index_t n      = min(key_dims.block_size, len - p0);
+    const DType* k_block = key_cache + PagedKVOffset(block_table, key_dims, b, h, p0);
+    const DType* v_block = value_cache + PagedKVOffset(block_table, value_dims, b, h, p0);
+    for (index_t c = threadIdx.x; c < n; c += blockDim.x) {
+      AType dot = 0;
+      for (index_t d = 0; d < key_dims.dim; ++d) {
+        dot += q_s[d] * static_cast<AType>(k_block[c * key_dims.dim + d]);
+      }
+      p_s[c] = dot;
+    }
+    __syncthreads();
+    if (threadIdx.x == 0) {
+      AType new_max = *row_max;
+      for (index_t c = 0; c < n; ++c) {
+        new_max = max(new_max, p_s[c]);
+      }
+      *correct  = exp(*row_max - new_max);
+      AType sum = *row_sum * *correct;
+      for (index_t c = 0; c < n; ++c) {
+        p_s[c] = exp(p_s[c] - new_max);
+        sum += p_s[c];
+      }
+      *row_max = new_max;
+      *row_sum = sum;
+    }
+    __syncthreads();
+    for (index_t d = threadIdx.x; d < value_dims.dim; d += blockDim.x) {
+      AType sum = acc[d] * *correct;
+      for (index_t c = 0; c < n; ++c) {
+        sum += p_s[c] * static_cast<AType>(v_block[c * value_dims.dim + d]);
+      }
+      acc[d] = sum;
+    }
+    __syncthreads();
+  }
+  for (index_t d = threadIdx.x; d < value_dims.dim; d += blockDim.x) {
+    KERNEL_ASSIGN(out[row * value_dims.dim + d], req, static_cast<DType>(acc[d] / *row_sum));
+  }
+}
+
+template <>
+void PagedAttentionOpForward<gpu>(const nnvm::NodeAttrs& attrs,
+                                  const OpContext& ctx,
+                                  const std::vector<TBlob>& inputs,
+                                  const std::vector<OpReqType>& req,
+                                  const std::vector<TBlob>& outputs) {
+  using namespace paged_kv;
+  const PagedAttentionParam& param = nnvm::get<PagedAttentionParam>(attrs.parsed);
+  if (req[0] == kNullOp)
+    return;
+  mshadow::Stream<gpu>* s  = ctx.get_stream<gpu>();
+  const TBlob& block_table = inputs[kQueryBlockTable];
+  const PagedKVDims key_dims =
+      PagedKVGetDims(inputs[kQuery], inputs[kQueryKeyCache], block_table);
+  PagedKVDims value_dims = key_dims;
+  value_dims.dim         = inputs[kQueryValueCache].shape_[3];
+  const index_t rows     = key_dims.batch * key_dims.heads * key_dims.tokens;
+  const float scale      = param.scale.has_value() ?
+                          param.scale.value() :
+                          1.0f / std::sqrt(static_cast<float>(key_dims.dim));
+  if (rows == 0)
+    return;
+  MSHADOW_REAL_TYPE_SWITCH_EX(inputs[kQuery].type_flag_, DType, AType, {
+    const size_t shared =
+        sizeof(AType) * (key_dims.dim + value_dims.dim + key_dims.block_size + 3);
+    PagedAttentionKernel<DType, AType>
+        <<<rows, kPagedAttentionThreadsGPU, shared, mshadow::Stream<gpu>::GetStream(s)>>>(
+            key_dims,
+            value_dims,
+            static_cast<AType>(scale),
+            inputs[kQuery].dptr<DType>(),
+            inputs[kQueryKeyCache].dptr<DType>(),
+            inputs[kQueryValueCache].dptr<DType>(),
+            block_table.dptr<int32_t>(),
+            inputs[kSeqLens].dptr<int32_t>(),
+            req[0],
+            outputs[0].dptr<DType>());
+    MSHADOW_CUDA_POST_KERNEL_CHECK(PagedAttentionKernel);
+  });
+}
+
+NNVM_REGISTER_OP(_contrib_append_kv).set_attr<FCompute>("FCompute<gpu>", AppendKVOpForward<gpu>);
+
+NNVM_REGISTER_OP(_contrib_paged_attention)
+    .set_attr<FCompute>("FCompute<gpu>", PagedAttentionOpForward<gpu>);
+
+}  // namespace op
+}  // namespace mxnet
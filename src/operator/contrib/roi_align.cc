@@ -627,6 +627,10 @@ NNVM_REGISTER_OP(_backward_ROIAlign)
     .set_num_outputs(2)
     .set_attr<nnvm::TIsBackward>("TIsBackward", true)
     .set_attr_parser(ParamParser<ROIAlignParam>)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& n) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
     .set_attr<FCompute>("FCompute<cpu>", ROIAlignBackwardCompute<cpu>);
 
 }  // namespace op
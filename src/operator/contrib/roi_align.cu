@@ -22,6 +22,8 @@
  * \author Hang Zhang, Shesung
  * Adapted from Caffe2
  */
+#include <algorithm>
+#include <type_traits>
 #include "./roi_align-inl.h"
 #include "../mxnet_op.h"
 
@@ -30,304 +32,413 @@ namespace op {
 
 using namespace mshadow::cuda;
 
-// The maximum number of blocks to use in the default kernel call.
-constexpr int ROI_MAXIMUM_NUM_BLOCKS = 4096;
+// The threads per block of the ROIAlign kernels.
+constexpr int kRoIAlignThreads = 256;
+// The samples along each axis of a ROI whose interpolation weights are cached in shared memory.
+constexpr int kRoIAlignMaxCachedSamples = 512;
 
-/**
- * @brief Compute the number of blocks needed to run N threads.
+/*!
+ * \brief The sampling grid of a ROI, shared by all its channels and bins. The coordinates are
+ *        computed in AType so that FP16 inputs keep the accuracy of the sampling points.
  */
-inline int ROI_GET_BLOCKS(const int N) {
-  return std::max(
-      std::min((N + kMaxThreadsPerBlock - 1) / kMaxThreadsPerBlock, ROI_MAXIMUM_NUM_BLOCKS),
-      // Use at least 1 block, since CUDA does not allow empty block
-      1);
-}
-
-template <typename T>
-__device__ T bilinear_interpolate(const T* bottom_data,
-                                  const int height,
-                                  const int width,
-                                  T y,
-                                  T x,
-                                  const int index /* index for debug only*/) {
-  // deal with cases that inverse elements are out of feature map boundary
-  if (y < -1.0 || y > height || x < -1.0 || x > width) {
-    // empty
-    return 0;
+template <typename AType>
+struct RoIAlignBox {
+  int batch;
+  AType start_h, start_w, bin_h, bin_w;
+  int grid_h, grid_w;
+
+  template <typename DType>
+  __device__ RoIAlignBox(const DType* roi,
+                         const AType spatial_scale,
+                         const bool continuous_coordinate,
+                         const int pooled_height,
+                         const int pooled_width,
+                         const int sampling_ratio) {
+    batch = static_cast<int>(static_cast<AType>(roi[0]));
+    // Do not using rounding; this implementation detail is critical
+    const AType roi_offset = continuous_coordinate ? AType(0.5) : AType(0);
+    start_w                = static_cast<AType>(roi[1]) * spatial_scale - roi_offset;
+    start_h                = static_cast<AType>(roi[2]) * spatial_scale - roi_offset;
+    AType roi_width        = static_cast<AType>(roi[3]) * spatial_scale - roi_offset - start_w;
+    AType roi_height       = static_cast<AType>(roi[4]) * spatial_scale - roi_offset - start_h;
+    if (!continuous_coordinate) {  // backward compatiblity
+      // Force malformed ROIs to be 1x1
+      roi_width  = max(roi_width, AType(1));
+      roi_height = max(roi_height, AType(1));
+    }
+    bin_h = roi_height / static_cast<AType>(pooled_height);
+    bin_w = roi_width / static_cast<AType>(pooled_width);
+    // We use roi_bin_grid to sample the grid and mimic integral
+    grid_h = (sampling_ratio > 0) ? sampling_ratio : ceil(roi_height / pooled_height);
+    grid_w = (sampling_ratio > 0) ? sampling_ratio : ceil(roi_width / pooled_width);
   }
 
-  if (y <= 0) {
-    y = 0;
+  /*! \brief coordinate of the sample iy of the bins of row ph */
+  __device__ AType SampleY(const int ph, const int iy) const {
+    return start_h + ph * bin_h + static_cast<AType>(iy + .5f) * bin_h / static_cast<AType>(grid_h);
   }
-  if (x <= 0) {
-    x = 0;
+  /*! \brief coordinate of the sample ix of the bins of column pw */
+  __device__ AType SampleX(const int pw, const int ix) const {
+    return start_w + pw * bin_w + static_cast<AType>(ix + .5f) * bin_w / static_cast<AType>(grid_w);
   }
+};
 
-  int y_low = static_cast<int>(y);
-  int x_low = static_cast<int>(x);
-  int y_high;
-  int x_high;
-
-  if (y_low >= height - 1) {
-    y_high = y_low = height - 1;
-    y              = (T)y_low;
-  } else {
-    y_high = y_low + 1;
+/*!
+ * \brief The bilinear interpolation of a sampling point along one axis. The 2D weights are the
+ *        products of the weights of both axes, so that the weights of the samples of a ROI are
+ *        computed once per row and once per column instead of once per output element.
+ */
+template <typename AType>
+struct RoIAlignAxisSample {
+  int low, high;
+  AType lw, hw;
+  bool valid;
+};
+
+template <typename AType>
+__device__ RoIAlignAxisSample<AType> roi_align_axis_sample(AType y, const int size) {
+  RoIAlignAxisSample<AType> s;
+  // deal with cases that inverse elements are out of feature map boundary
+  s.valid = !(y < -1.0 || y > size);
+  if (!s.valid) {
+    s.low = s.high = 0;
+    s.lw = s.hw = 0;
+    return s;
   }
-
-  if (x_low >= width - 1) {
-    x_high = x_low = width - 1;
-    x              = (T)x_low;
+  if (y <= 0) {
+    y = 0;
+  }
+  s.low = static_cast<int>(y);
+  if (s.low >= size - 1) {
+    s.high = s.low = size - 1;
+    y              = static_cast<AType>(s.low);
   } else {
-    x_high = x_low + 1;
+    s.high = s.low + 1;
   }
+  s.lw = y - s.low;
+  s.hw = 1 - s.lw;
+  return s;
+}
 
-  T ly = y - y_low;
-  T lx = x - x_low;
-  T hy = 1. - ly, hx = 1. - lx;
-  // do bilinear interpolation
-  T v1 = bottom_data[y_low * width + x_low];
-  T v2 = bottom_data[y_low * width + x_high];
-  T v3 = bottom_data[y_high * width + x_low];
-  T v4 = bottom_data[y_high * width + x_high];
-  T w1 = hy * hx, w2 = hy * lx, w3 = ly * hx, w4 = ly * lx;
-
-  T val = (w1 * v1 + w2 * v2 + w3 * v3 + w4 * v4);
-
-  return val;
+/*!
+ * \brief Fills the samples of all the bins of a ROI along one axis, when they fit into the cache.
+ */
+template <typename AType>
+__device__ bool roi_align_cache_samples(const RoIAlignBox<AType>& box,
+                                        const int pooled_height,
+                                        const int pooled_width,
+                                        const int height,
+                                        const int width,
+                                        RoIAlignAxisSample<AType>* ys,
+                                        RoIAlignAxisSample<AType>* xs) {
+  const int ny = pooled_height * box.grid_h;
+  const int nx = pooled_width * box.grid_w;
+  if (ny > kRoIAlignMaxCachedSamples || nx > kRoIAlignMaxCachedSamples)
+    return false;
+  for (int i = threadIdx.x; i < ny; i += blockDim.x)
+    ys[i] = roi_align_axis_sample(box.SampleY(i / box.grid_h, i % box.grid_h), height);
+  for (int i = threadIdx.x; i < nx; i += blockDim.x)
+    xs[i] = roi_align_axis_sample(box.SampleX(i / box.grid_w, i % box.grid_w), width);
+  return true;
 }
 
-template <typename T>
-__global__ void RoIAlignForwardKernel(const int nthreads,
-                                      const T* bottom_data,
-                                      const T spatial_scale,
-                                      const bool position_sensitive,
-                                      const bool continuous_coordinate,
-                                      const int channels,
-                                      const int height,
-                                      const int width,
-                                      const int pooled_height,
-                                      const int pooled_width,
-                                      const int sampling_ratio,
-                                      const T* bottom_rois,
-                                      T* top_data) {
-  CUDA_KERNEL_LOOP(index, nthreads) {
-    // (n, c, ph, pw) is an element in the pooled output
-    int pw = index % pooled_width;
-    int ph = (index / pooled_width) % pooled_height;
-    int c  = (index / pooled_width / pooled_height) % channels;
-    int n  = index / pooled_width / pooled_height / channels;
-
-    const T* offset_bottom_rois = bottom_rois + n * 5;
-    int roi_batch_ind           = offset_bottom_rois[0];
-
-    if (roi_batch_ind < 0) {
-      top_data[index] = 0.;
+/*!
+ * \brief blockIdx.x strides over the ROIs and blockIdx.y over the output elements of a ROI. The
+ *        threads of a warp compute consecutive bins of a channel, reading neighbouring pixels of
+ *        the same rows, with the interpolation weights broadcast from shared memory.
+ */
+template <typename DType>
+__global__ void __launch_bounds__(kRoIAlignThreads)
+    RoIAlignForwardKernel(const int num_rois,
+                          const DType* bottom_data,
+                          const float spatial_scale,
+                          const bool position_sensitive,
+                          const bool continuous_coordinate,
+                          const int channels,
+                          const int height,
+                          const int width,
+                          const int pooled_height,
+                          const int pooled_width,
+                          const int sampling_ratio,
+                          const DType* bottom_rois,
+                          DType* top_data) {
+  using AType = typename mxnet_op::AccType<DType>::type;
+  __shared__ RoIAlignAxisSample<AType> ys[kRoIAlignMaxCachedSamples];
+  __shared__ RoIAlignAxisSample<AType> xs[kRoIAlignMaxCachedSamples];
+  const int roi_elems = channels * pooled_height * pooled_width;
+  for (int n = blockIdx.x; n < num_rois; n += gridDim.x) {
+    const RoIAlignBox<AType> box(bottom_rois + n * 5,
+                                 spatial_scale,
+                                 continuous_coordinate,
+                                 pooled_height,
+                                 pooled_width,
+                                 sampling_ratio);
+    DType* offset_top_data = top_data + n * roi_elems;
+    if (box.batch < 0) {
+      for (int e = blockIdx.y * blockDim.x + threadIdx.x; e < roi_elems;
+           e += gridDim.y * blockDim.x)
+        offset_top_data[e] = 0;
       continue;
     }
-
-    // Do not using rounding; this implementation detail is critical
-    T roi_offset  = continuous_coordinate ? static_cast<T>(0.5) : static_cast<T>(0);
-    T roi_start_w = offset_bottom_rois[1] * spatial_scale - roi_offset;
-    T roi_start_h = offset_bottom_rois[2] * spatial_scale - roi_offset;
-    T roi_end_w   = offset_bottom_rois[3] * spatial_scale - roi_offset;
-    T roi_end_h   = offset_bottom_rois[4] * spatial_scale - roi_offset;
-
-    T roi_width  = roi_end_w - roi_start_w;
-    T roi_height = roi_end_h - roi_start_h;
-    if (!continuous_coordinate) {  // backward compatiblity
-      // Force malformed ROIs to be 1x1
-      roi_width  = max(roi_width, (T)1.);
-      roi_height = max(roi_height, (T)1.);
-    }
-    T bin_size_h = static_cast<T>(roi_height) / static_cast<T>(pooled_height);
-    T bin_size_w = static_cast<T>(roi_width) / static_cast<T>(pooled_width);
-
-    int c_unpooled        = c;
-    int channels_unpooled = channels;
-    if (position_sensitive) {
-      c_unpooled        = c * pooled_height * pooled_width + ph * pooled_width + pw;
-      channels_unpooled = channels * pooled_height * pooled_width;
-    }
-    const T* offset_bottom_data =
-        bottom_data + (roi_batch_ind * channels_unpooled + c_unpooled) * height * width;
-
-    // We use roi_bin_grid to sample the grid and mimic integral
-    int roi_bin_grid_h =
-        (sampling_ratio > 0) ? sampling_ratio : ceil(roi_height / pooled_height);  // e.g., = 2
-    int roi_bin_grid_w = (sampling_ratio > 0) ? sampling_ratio : ceil(roi_width / pooled_width);
-
+    const bool cached =
+        roi_align_cache_samples(box, pooled_height, pooled_width, height, width, ys, xs);
+    __syncthreads();
     // We do average (integral) pooling inside a bin
-    const T count = roi_bin_grid_h * roi_bin_grid_w;  // e.g. = 4
-
-    T output_val = 0.;
-    for (int iy = 0; iy < roi_bin_grid_h; iy++) {  // e.g., iy = 0, 1
-      const T y =
-          roi_start_h + ph * bin_size_h +
-          static_cast<T>(iy + .5f) * bin_size_h / static_cast<T>(roi_bin_grid_h);  // e.g., 0.5, 1.5
-      for (int ix = 0; ix < roi_bin_grid_w; ix++) {
-        const T x = roi_start_w + pw * bin_size_w +
-                    static_cast<T>(ix + .5f) * bin_size_w / static_cast<T>(roi_bin_grid_w);
-
-        T val = bilinear_interpolate(offset_bottom_data, height, width, y, x, index);
-        output_val += val;
+    const AType count = box.grid_h * box.grid_w;
+    for (int e = blockIdx.y * blockDim.x + threadIdx.x; e < roi_elems;
+         e += gridDim.y * blockDim.x) {
+      // (c, ph, pw) is an element in the pooled output of the ROI
+      const int pw = e % pooled_width;
+      const int ph = (e / pooled_width) % pooled_height;
+      const int c  = e / pooled_width / pooled_height;
+
+      int c_unpooled        = c;
+      int channels_unpooled = channels;
+      if (position_sensitive) {
+        c_unpooled        = c * pooled_height * pooled_width + ph * pooled_width + pw;
+        channels_unpooled = channels * pooled_height * pooled_width;
+      }
+      const DType* offset_bottom_data =
+          bottom_data + (box.batch * channels_unpooled + c_unpooled) * height * width;
+
+      AType output_val = 0;
+      for (int iy = 0; iy < box.grid_h; ++iy) {
+        const RoIAlignAxisSample<AType> y =
+            cached ? ys[ph * box.grid_h + iy] :
+                     roi_align_axis_sample(box.SampleY(ph, iy), height);
+        if (!y.valid)
+          continue;
+        const DType* row_low  = offset_bottom_data + y.low * width;
+        const DType* row_high = offset_bottom_data + y.high * width;
+        for (int ix = 0; ix < box.grid_w; ++ix) {
+          const RoIAlignAxisSample<AType> x =
+              cached ? xs[pw * box.grid_w + ix] :
+                       roi_align_axis_sample(box.SampleX(pw, ix), width);
+          if (!x.valid)
+            continue;
+          output_val += y.hw * (x.hw * static_cast<AType>(row_low[x.low]) +
+                                x.lw * static_cast<AType>(row_low[x.high])) +
+                        y.lw * (x.hw * static_cast<AType>(row_high[x.low]) +
+                                x.lw * static_cast<AType>(row_high[x.high]));
+        }
       }
+      offset_top_data[e] = static_cast<DType>(output_val / count);
     }
-    output_val /= count;
-
-    top_data[index] = output_val;
+    __syncthreads();
   }
 }
 
-template <typename T>
-__device__ void bilinear_interpolate_gradient(const int height,
-                                              const int width,
-                                              T y,
-                                              T x,
-                                              T* w1,
-                                              T* w2,
-                                              T* w3,
-                                              T* w4,
-                                              int* x_low,
-                                              int* x_high,
-                                              int* y_low,
-                                              int* y_high,
-                                              const int /*index*/ /* index for debug only*/) {
-  // deal with cases that inverse elements are out of feature map boundary
-  if (y < -1.0 || y > height || x < -1.0 || x > width) {
-    // empty
-    *w1 = *w2 = *w3 = *w4 = 0.;
-    *x_low = *x_high = *y_low = *y_high = -1;
-    return;
-  }
-
-  if (y <= 0) {
-    y = 0;
-  }
-  if (x <= 0) {
-    x = 0;
-  }
-
-  *y_low = static_cast<int>(y);
-  *x_low = static_cast<int>(x);
-
-  if (*y_low >= height - 1) {
-    *y_high = *y_low = height - 1;
-    y                = (T)*y_low;
-  } else {
-    *y_high = *y_low + 1;
-  }
-
-  if (*x_low >= width - 1) {
-    *x_high = *x_low = width - 1;
-    x                = (T)*x_low;
-  } else {
-    *x_high = *x_low + 1;
+/*!
+ * \brief Scatters the gradient of the bins into bottom_diff with atomics, in AType since the
+ *        atomics of the reduced precision types are both slow and inaccurate.
+ */
+template <typename DType, typename AType>
+__global__ void __launch_bounds__(kRoIAlignThreads)
+    RoIAlignBackwardKernel(const int num_rois,
+                           const DType* top_diff,
+                           const float spatial_scale,
+                           const bool position_sensitive,
+                           const bool continuous_coordinate,
+                           const int channels,
+                           const int height,
+                           const int width,
+                           const int pooled_height,
+                           const int pooled_width,
+                           const int sampling_ratio,
+                           AType* bottom_diff,
+                           const DType* bottom_rois) {
+  __shared__ RoIAlignAxisSample<AType> ys[kRoIAlignMaxCachedSamples];
+  __shared__ RoIAlignAxisSample<AType> xs[kRoIAlignMaxCachedSamples];
+  const int roi_elems = channels * pooled_height * pooled_width;
+  for (int n = blockIdx.x; n < num_rois; n += gridDim.x) {
+    const RoIAlignBox<AType> box(bottom_rois + n * 5,
+                                 spatial_scale,
+                                 continuous_coordinate,
+                                 pooled_height,
+                                 pooled_width,
+                                 sampling_ratio);
+    if (box.batch < 0)
+      continue;
+    const bool cached =
+        roi_align_cache_samples(box, pooled_height, pooled_width, height, width, ys, xs);
+    __syncthreads();
+    const AType count = box.grid_h * box.grid_w;
+    for (int e = blockIdx.y * blockDim.x + threadIdx.x; e < roi_elems;
+         e += gridDim.y * blockDim.x) {
+      const int pw = e % pooled_width;
+      const int ph = (e / pooled_width) % pooled_height;
+      const int c  = e / pooled_width / pooled_height;
+
+      int c_unpooled        = c;
+      int channels_unpooled = channels;
+      if (position_sensitive) {
+        c_unpooled        = c * pooled_height * pooled_width + ph * pooled_width + pw;
+        channels_unpooled = channels * pooled_height * pooled_width;
+      }
+      AType* offset_bottom_diff =
+          bottom_diff + (box.batch * channels_unpooled + c_unpooled) * height * width;
+      const AType top_diff_this_bin = static_cast<AType>(top_diff[n * roi_elems + e]) / count;
+
+      for (int iy = 0; iy < box.grid_h; ++iy) {
+        const RoIAlignAxisSample<AType> y =
+            cached ? ys[ph * box.grid_h + iy] :
+                     roi_align_axis_sample(box.SampleY(ph, iy), height);
+        if (!y.valid)
+          continue;
+        AType* row_low  = offset_bottom_diff + y.low * width;
+        AType* row_high = offset_bottom_diff + y.high * width;
+        for (int ix = 0; ix < box.grid_w; ++ix) {
+          const RoIAlignAxisSample<AType> x =
+              cached ? xs[pw * box.grid_w + ix] :
+                       roi_align_axis_sample(box.SampleX(pw, ix), width);
+          if (!x.valid)
+            continue;
+          atomicAdd(row_low + x.low, top_diff_this_bin * y.hw * x.hw);
+          atomicAdd(row_low + x.high, top_diff_this_bin * y.hw * x.lw);
+          atomicAdd(row_high + x.low, top_diff_this_bin * y.lw * x.hw);
+          atomicAdd(row_high + x.high, top_diff_this_bin * y.lw * x.lw);
+        }
+      }
+    }
+    __syncthreads();
   }
-
-  T ly = y - *y_low;
-  T lx = x - *x_low;
-  T hy = 1. - ly, hx = 1. - lx;
-
-  *w1 = hy * hx, *w2 = hy * lx, *w3 = ly * hx, *w4 = ly * lx;
-
-  return;
 }
 
-template <typename T>
-__global__ void RoIAlignBackwardKernel(const int nthreads,
-                                       const T* top_diff,
-                                       const int num_rois,
-                                       const T spatial_scale,
-                                       const bool position_sensitive,
-                                       const bool continuous_coordinate,
-                                       const int channels,
-                                       const int height,
-                                       const int width,
-                                       const int pooled_height,
-                                       const int pooled_width,
-                                       const int sampling_ratio,
-                                       T* bottom_diff,
-                                       const T* bottom_rois) {
-  CUDA_KERNEL_LOOP(index, nthreads) {
-    // (n, c, ph, pw) is an element in the pooled output
-    int pw = index % pooled_width;
-    int ph = (index / pooled_width) % pooled_height;
-    int c  = (index / pooled_width / pooled_height) % channels;
-    int n  = index / pooled_width / pooled_height / channels;
-
-    const T* offset_bottom_rois = bottom_rois + n * 5;
-    int roi_batch_ind           = offset_bottom_rois[0];
-    if (roi_batch_ind < 0)
-      continue;
-
-    // Do not using rounding; this implementation detail is critical
-    T roi_offset  = continuous_coordinate ? static_cast<T>(0.5) : static_cast<T>(0);
-    T roi_start_w = offset_bottom_rois[1] * spatial_scale - roi_offset;
-    T roi_start_h = offset_bottom_rois[2] * spatial_scale - roi_offset;
-    T roi_end_w   = offset_bottom_rois[3] * spatial_scale - roi_offset;
-    T roi_end_h   = offset_bottom_rois[4] * spatial_scale - roi_offset;
-
-    T roi_width  = roi_end_w - roi_start_w;
-    T roi_height = roi_end_h - roi_start_h;
-    if (!continuous_coordinate) {  // backward compatiblity
-      // Force malformed ROIs to be 1x1
-      roi_width  = max(roi_width, (T)1.);
-      roi_height = max(roi_height, (T)1.);
-    }
-    T bin_size_h = static_cast<T>(roi_height) / static_cast<T>(pooled_height);
-    T bin_size_w = static_cast<T>(roi_width) / static_cast<T>(pooled_width);
+/*!
+ * \brief Narrows the range [*begin, *end) of the samples along an axis, spaced by step from
+ *        start, to the ones which may interpolate pixel i, with a margin of one sample for the
+ *        rounding.
+ */
+template <typename AType>
+__device__ void roi_align_sample_range(const AType start,
+                                       const AType step,
+                                       const int i,
+                                       const int size,
+                                       int* begin,
+                                       int* end) {
+  if (!(step > 0))
+    return;
+  // the samples in [-1, 0] and [size - 1, size] are clamped to the borders
+  const AType lo    = static_cast<AType>(i == 0 ? -1 : i - 1);
+  const AType hi    = static_cast<AType>(i == size - 1 ? size : i + 1);
+  // clamped to the range before the conversion to int, as the ROI may be far from pixel i
+  const AType b     = static_cast<AType>(*begin);
+  const AType e     = static_cast<AType>(*end);
+  const AType first = min(max((lo - start) / step - AType(1.5), b), e);
+  const AType last  = min(max((hi - start) / step + AType(0.5), b), e);
+  *begin            = max(*begin, static_cast<int>(ceil(first)));
+  *end              = min(*end, static_cast<int>(floor(last)) + 1);
+}
 
-    int c_unpooled        = c;
-    int channels_unpooled = channels;
+/*!
+ * \brief Deterministic backward: each thread gathers the gradient of one input element over the
+ *        ROIs in order, instead of the ROIs scattering it with atomics. The block loads the ROIs
+ *        into shared memory cooperatively, and only the samples which may interpolate the element
+ *        are visited.
+ */
+template <typename DType, int req>
+__global__ void __launch_bounds__(kRoIAlignThreads)
+    RoIAlignBackwardGatherKernel(const index_t nthreads,
+                                 const DType* top_diff,
+                                 const int num_rois,
+                                 const float spatial_scale,
+                                 const bool position_sensitive,
+                                 const bool continuous_coordinate,
+                                 const int channels,
+                                 const int height,
+                                 const int width,
+                                 const int pooled_height,
+                                 const int pooled_width,
+                                 const int sampling_ratio,
+                                 DType* bottom_diff,
+                                 const DType* bottom_rois) {
+  using AType = typename mxnet_op::AccType<DType>::type;
+  __shared__ AType rois[kRoIAlignThreads * 5];
+  const int channels_unpooled =
+      position_sensitive ? channels * pooled_height * pooled_width : channels;
+  for (index_t base = static_cast<index_t>(blockIdx.x) * blockDim.x; base < nthreads;
+       base += static_cast<index_t>(gridDim.x) * blockDim.x) {
+    const index_t index  = base + threadIdx.x;
+    const bool active    = index < nthreads;
+    const int w          = index % width;
+    const int h          = (index / width) % height;
+    const int c_unpooled = (index / width / height) % channels_unpooled;
+    const int batch      = index / width / height / channels_unpooled;
+    // the output channel and the bins reading the plane of the element
+    int c = c_unpooled, ph_begin = 0, ph_end = pooled_height, pw_begin = 0, pw_end = pooled_width;
     if (position_sensitive) {
-      c_unpooled        = c * pooled_height * pooled_width + ph * pooled_width + pw;
-      channels_unpooled = channels * pooled_height * pooled_width;
+      c        = c_unpooled / (pooled_height * pooled_width);
+      ph_begin = c_unpooled / pooled_width % pooled_height;
+      pw_begin = c_unpooled % pooled_width;
+      ph_end   = ph_begin + 1;
+      pw_end   = pw_begin + 1;
     }
-    T* offset_bottom_diff =
-        bottom_diff + (roi_batch_ind * channels_unpooled + c_unpooled) * height * width;
-
-    int top_offset            = (n * channels + c) * pooled_height * pooled_width;
-    const T* offset_top_diff  = top_diff + top_offset;
-    const T top_diff_this_bin = offset_top_diff[ph * pooled_width + pw];
+    AType grad = 0;
+    for (int r0 = 0; r0 < num_rois; r0 += kRoIAlignThreads) {
+      const int nr = min(kRoIAlignThreads, num_rois - r0);
+      __syncthreads();
+      for (int i = threadIdx.x; i < nr * 5; i += blockDim.x)
+        rois[i] = static_cast<AType>(bottom_rois[r0 * 5 + i]);
+      __syncthreads();
+      if (!active)
+        continue;
+      for (int r = 0; r < nr; ++r) {
+        if (static_cast<int>(rois[r * 5]) != batch)
+          continue;
+        const RoIAlignBox<AType> box(rois + r * 5,
+                                     spatial_scale,
+                                     continuous_coordinate,
+                                     pooled_height,
+                                     pooled_width,
+                                     sampling_ratio);
+        if (box.grid_h <= 0 || box.grid_w <= 0)
+          continue;
+        int jy_begin = ph_begin * box.grid_h, jy_end = ph_end * box.grid_h;
+        int jx_begin = pw_begin * box.grid_w, jx_end = pw_end * box.grid_w;
+        roi_align_sample_range(box.start_h, box.bin_h / box.grid_h, h, height, &jy_begin, &jy_end);
+        roi_align_sample_range(box.start_w, box.bin_w / box.grid_w, w, width, &jx_begin, &jx_end);
+        const DType* offset_top_diff =
+            top_diff + ((r0 + r) * channels + c) * pooled_height * pooled_width;
+        AType roi_grad = 0;
+        for (int jy = jy_begin; jy < jy_end; ++jy) {
+          const int ph = jy / box.grid_h;
+          const RoIAlignAxisSample<AType> y =
+              roi_align_axis_sample(box.SampleY(ph, jy % box.grid_h), height);
+          const AType wy = (y.low == h ? y.hw : AType(0)) + (y.high == h ? y.lw : AType(0));
+          if (!y.valid || wy == 0)
+            continue;
+          for (int jx = jx_begin; jx < jx_end; ++jx) {
+            const int pw = jx / box.grid_w;
+            const RoIAlignAxisSample<AType> x =
+                roi_align_axis_sample(box.SampleX(pw, jx % box.grid_w), width);
+            const AType wx = (x.low == w ? x.hw : AType(0)) + (x.high == w ? x.lw : AType(0));
+            if (!x.valid || wx == 0)
+              continue;
+            roi_grad += static_cast<AType>(offset_top_diff[ph * pooled_width + pw]) * wy * wx;
+          }
+        }
+        grad += roi_grad / static_cast<AType>(box.grid_h * box.grid_w);
+      }
+    }
+    if (active)
+      KERNEL_ASSIGN(bottom_diff[index], req, static_cast<DType>(grad));
+  }
+}
 
-    // We use roi_bin_grid to sample the grid and mimic integral
-    int roi_bin_grid_h =
-        (sampling_ratio > 0) ? sampling_ratio : ceil(roi_height / pooled_height);  // e.g., = 2
-    int roi_bin_grid_w = (sampling_ratio > 0) ? sampling_ratio : ceil(roi_width / pooled_width);
+/*! \brief writes the gradient accumulated in AType to the gradient of the data */
+template <int req>
+struct roi_align_cast_grad {
+  template <typename DType, typename AType>
+  MSHADOW_XINLINE static void Map(index_t i, DType* out, const AType* in) {
+    KERNEL_ASSIGN(out[i], req, static_cast<DType>(in[i]));
+  }
+};
 
-    // We do average (integral) pooling inside a bin
-    const T count = roi_bin_grid_h * roi_bin_grid_w;  // e.g. = 4
-
-    for (int iy = 0; iy < roi_bin_grid_h; iy++) {  // e.g., iy = 0, 1
-      const T y =
-          roi_start_h + ph * bin_size_h +
-          static_cast<T>(iy + .5f) * bin_size_h / static_cast<T>(roi_bin_grid_h);  // e.g., 0.5, 1.5
-      for (int ix = 0; ix < roi_bin_grid_w; ix++) {
-        const T x = roi_start_w + pw * bin_size_w +
-                    static_cast<T>(ix + .5f) * bin_size_w / static_cast<T>(roi_bin_grid_w);
-
-        T w1, w2, w3, w4;
-        int x_low, x_high, y_low, y_high;
-
-        bilinear_interpolate_gradient(
-            height, width, y, x, &w1, &w2, &w3, &w4, &x_low, &x_high, &y_low, &y_high, index);
-
-        T g1 = top_diff_this_bin * w1 / count;
-        T g2 = top_diff_this_bin * w2 / count;
-        T g3 = top_diff_this_bin * w3 / count;
-        T g4 = top_diff_this_bin * w4 / count;
-
-        if (x_low >= 0 && x_high >= 0 && y_low >= 0 && y_high >= 0) {
-          atomicAdd(offset_bottom_diff + y_low * width + x_low, static_cast<T>(g1));
-          atomicAdd(offset_bottom_diff + y_low * width + x_high, static_cast<T>(g2));
-          atomicAdd(offset_bottom_diff + y_high * width + x_low, static_cast<T>(g3));
-          atomicAdd(offset_bottom_diff + y_high * width + x_high, static_cast<T>(g4));
-        }  // if
-      }    // ix
-    }      // iy
-  }        // CUDA_KERNEL_LOOP
-}  // RoIAlignBackward
+/*! \brief the grid of the ROIAlign kernels: the ROIs by the blocks of the elements of a ROI */
+inline dim3 RoIAlignGrid(const int num_rois, const int roi_elems) {
+  return dim3(std::max(std::min(num_rois, kMaxGridNum), 1),
+              std::min((roi_elems + kRoIAlignThreads - 1) / kRoIAlignThreads, kMaxGridNum));
+}
 
 template <typename xpu>
 void ROIAlignForwardCompute(const nnvm::NodeAttrs& attrs,
@@ -352,6 +463,8 @@ void ROIAlignForwardCompute(const nnvm::NodeAttrs& attrs,
   const int pooled_height = out_data[roialign::kOut].size(2);
   const int pooled_width  = out_data[roialign::kOut].size(3);
 
+  if (count == 0)
+    return;
   Stream<gpu>* s      = ctx.get_stream<gpu>();
   cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
   MSHADOW_REAL_TYPE_SWITCH(in_data[0].type_flag_, DType, {
@@ -359,19 +472,21 @@ void ROIAlignForwardCompute(const nnvm::NodeAttrs& attrs,
     const DType* bottom_rois = in_data[roialign::kBox].dptr<DType>();
     DType* top_data          = out_data[roialign::kOut].dptr<DType>();
     RoIAlignForwardKernel<DType>
-        <<<ROI_GET_BLOCKS(count), kMaxThreadsPerBlock, 0, stream>>>(count,
-                                                                    bottom_data,
-                                                                    param.spatial_scale,
-                                                                    param.position_sensitive,
-                                                                    param.aligned,
-                                                                    channels,
-                                                                    height,
-                                                                    width,
-                                                                    pooled_height,
-                                                                    pooled_width,
-                                                                    param.sample_ratio,
-                                                                    bottom_rois,
-                                                                    top_data);
+        <<<RoIAlignGrid(num_rois, count / num_rois), kRoIAlignThreads, 0, stream>>>(
+            num_rois,
+            bottom_data,
+            param.spatial_scale,
+            param.position_sensitive,
+            param.aligned,
+            channels,
+            height,
+            width,
+            pooled_height,
+            pooled_width,
+            param.sample_ratio,
+            bottom_rois,
+            top_data);
+    MSHADOW_CUDA_POST_KERNEL_CHECK(RoIAlignForwardKernel);
   })
 }
 
@@ -406,36 +521,77 @@ void ROIAlignBackwardCompute(const nnvm::NodeAttrs& attrs,
 
   Stream<gpu>* s      = ctx.get_stream<gpu>();
   cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
+  // the scatter of the gradient with atomics is not deterministic, its gather is but is slower
+  const bool deterministic = dmlc::GetEnv("MXNET_ENFORCE_DETERMINISM", false);
 
   // assume all the data and gradient have the same type
   MSHADOW_REAL_TYPE_SWITCH(out_grad[0].type_flag_, DType, {
+    using AType              = typename mxnet_op::AccType<DType>::type;
     const DType* top_diff    = out_grad[0].dptr<DType>();
     const DType* bottom_rois = in_data[0].dptr<DType>();
     DType* grad_in           = outputs[0].dptr<DType>();
+    const index_t grad_size  = outputs[0].Size();
 
     if (kWriteTo == req[roialign::kBox]) {
       Fill<false>(s, outputs[1], kWriteTo, static_cast<DType>(0));
     }
-    if (kNullOp == req[roialign::kData])
+    if (kNullOp == req[roialign::kData] || grad_size == 0)
+      return;
+    if (deterministic) {
+      const int blocks = std::min<index_t>((grad_size + kRoIAlignThreads - 1) / kRoIAlignThreads,
+                                           kMaxGridNum);
+      MXNET_ASSIGN_REQ_SWITCH(req[roialign::kData], Req, {
+        RoIAlignBackwardGatherKernel<DType, Req>
+            <<<blocks, kRoIAlignThreads, 0, stream>>>(grad_size,
+                                                      top_diff,
+                                                      num_rois,
+                                                      param.spatial_scale,
+                                                      param.position_sensitive,
+                                                      param.aligned,
+                                                      channels,
+                                                      height,
+                                                      width,
+                                                      pooled_height,
+                                                      pooled_width,
+                                                      param.sample_ratio,
+                                                      grad_in,
+                                                      bottom_rois);
+      });
+      MSHADOW_CUDA_POST_KERNEL_CHECK(RoIAlignBackwardGatherKernel);
       return;
-    if (kWriteTo == req[roialign::kData]) {
+    }
+    // the reduced precision types accumulate into an AType workspace, cast at the end
+    const bool accumulate_in_place = std::is_same<DType, AType>::value;
+    AType* grad_acc                = reinterpret_cast<AType*>(grad_in);
+    if (!accumulate_in_place) {
+      grad_acc = ctx.requested[0].get_space_typed<gpu, 1, AType>(Shape1(grad_size), s).dptr_;
+      CUDA_CALL(cudaMemsetAsync(grad_acc, 0, grad_size * sizeof(AType), stream));
+    } else if (kWriteTo == req[roialign::kData]) {
       Fill<false>(s, outputs[0], kWriteTo, static_cast<DType>(0));
     }
-    RoIAlignBackwardKernel<DType>
-        <<<ROI_GET_BLOCKS(count), kMaxThreadsPerBlock, 0, stream>>>(count,
-                                                                    top_diff,
-                                                                    num_rois,
-                                                                    param.spatial_scale,
-                                                                    param.position_sensitive,
-                                                                    param.aligned,
-                                                                    channels,
-                                                                    height,
-                                                                    width,
-                                                                    pooled_height,
-                                                                    pooled_width,
-                                                                    param.sample_ratio,
-                                                                    grad_in,
-                                                                    bottom_rois);
+    if (count > 0) {
+      RoIAlignBackwardKernel<DType, AType>
+          <<<RoIAlignGrid(num_rois, count / num_rois), kRoIAlignThreads, 0, stream>>>(
+              num_rois,
+              top_diff,
+              param.spatial_scale,
+              param.position_sensitive,
+              param.aligned,
+              channels,
+              height,
+              width,
+              pooled_height,
+              pooled_width,
+              param.sample_ratio,
+              grad_acc,
+              bottom_rois);
+      MSHADOW_CUDA_POST_KERNEL_CHECK(RoIAlignBackwardKernel);
+    }
+    if (!accumulate_in_place) {
+      MXNET_ASSIGN_REQ_SWITCH(req[roialign::kData], Req, {
+        mxnet_op::Kernel<roi_align_cast_grad<Req>, gpu>::Launch(s, grad_size, grad_in, grad_acc);
+      });
+    }
   })
 }
 
@@ -0,0 +1,257 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file sdp_attention-inl.h
+ * \brief scaled dot-product attention with an online softmax, without materializing the scores
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_SDP_ATTENTION_INL_H_
+#define MXNET_OPERATOR_CONTRIB_SDP_ATTENTION_INL_H_
+
+#include <dmlc/logging.h>
+#include <dmlc/optional.h>
+#include <dmlc/parameter.h>
+#include <mxnet/operator_util.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+
+namespace mxnet {
+namespace op {
+
+namespace sdp_attention {
+// the backward takes the ograd, then the inputs and all the outputs of the forward,
+// and returns the gradients of the inputs of the forward
+enum SDPAttentionOpInputs { kQuery, kKey, kValue, kMask };
+enum SDPAttentionOpOutputs { kOut, kLogSumExp, kSeed };
+}  // namespace sdp_attention
+
+struct SDPAttentionParam : public dmlc::Parameter<SDPAttentionParam> {
+  dmlc::optional<float> scale;
+  bool causal;
+  float dropout;
+  bool use_mask;
+  DMLC_DECLARE_PARAMETER(SDPAttentionParam) {
+    DMLC_DECLARE_FIELD(scale)
+        .set_default(dmlc::optional<float>())
+        .describe("The scale of the scores, 1 / sqrt(head_dim) if not given.");
+    DMLC_DECLARE_FIELD(causal).set_default(false).describe(
+        "Whether query i only attends to the keys j <= i.");
+    DMLC_DECLARE_FIELD(dropout)
+        .set_default(0.0f)
+        .set_range(0.0f, 1.0f)
+        .describe("The dropout probability of the attention weights, only applied in training.");
+    DMLC_DECLARE_FIELD(use_mask).set_default(false).describe(
+        "Whether the input mask of shape (batch, query_len, key_len) selects the keys each "
+        "query attends to.");
+  }
+};
+
+/*! \brief the sizes of an attention problem, all offsets are derived from them */
+struct SDPAttentionDims {
+  index_t batch;
+  index_t heads;
+  index_t q_len;
+  index_t kv_len;
+  index_t dim;
+  index_t v_dim;
+};
+
+/*!
+ * \brief whether the dropout keeps the attention weight of key j for query i of head bh, a
+ *  counter based hash of the seed so that the backward recomputes the same decision
+ */
+MSHADOW_XINLINE bool SDPAttentionKeep(const uint32_t seed,
+                                      const uint32_t threshold,
+                                      const index_t bh,
+                                      const index_t i,
+                                      const index_t j,
+                                      const SDPAttentionDims& dims) {
+  uint64_t x = (static_cast<uint64_t>(bh * dims.q_len + i) * dims.kv_len + j) ^
+               (static_cast<uint64_t>(seed) << 32);
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  x ^= x >> 31;
+  return static_cast<uint32_t>(x >> 32) >= threshold;
+}
+
+/*! \brief whether query i may attend to key j of a batch whose mask is mask_row (or null) */
+template <typename MType>
+MSHADOW_XINLINE bool SDPAttentionVisible(const MType* mask_row,
+                                         const index_t i,
+                                         const index_t j,
+                                         const bool causal) {
+  return (!causal || j <= i) && (mask_row == nullptr || mask_row[j] != MType(0));
+}
+
+/*! \brief the dropout threshold of SDPAttentionKeep, 0 keeps every weight */
+inline uint32_t SDPAttentionDropThreshold(const float dropout) {
+  return static_cast<uint32_t>(std::min(static_cast<double>(dropout) * 4294967296.0, 4294967295.0));
+}
+
+/*! \brief the scale of the attention weights the dropout keeps */
+inline float SDPAttentionKeepScale(const float dropout) {
+  return dropout < 1.0f ? 1.0f / (1.0f - dropout) : 0.0f;
+}
+
+inline SDPAttentionDims SDPAttentionGetDims(const TBlob& query, const TBlob& value) {
+  return {query.shape_[0],
+          query.shape_[1],
+          query.shape_[2],
+          value.shape_[2],
+          query.shape_[3],
+          value.shape_[3]};
+}
+
+inline float SDPAttentionScale(const SDPAttentionParam& param, const index_t dim) {
+  return param.scale.has_value() ? param.scale.value() :
+                                   1.0f / std::sqrt(static_cast<float>(dim));
+}
+
+inline bool SDPAttentionOpShape(const nnvm::NodeAttrs& attrs,
+                                mxnet::ShapeVector* in_attrs,
+                                mxnet::ShapeVector* out_attrs) {
+  using namespace sdp_attention;
+  const SDPAttentionParam& param = nnvm::get<SDPAttentionParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), param.use_mask ? 4U : 3U);
+  CHECK_EQ(out_attrs->size(), 3U);
+  const mxnet::TShape& qshape = (*in_attrs)[kQuery];
+  const mxnet::TShape& kshape = (*in_attrs)[kKey];
+  const mxnet::TShape& vshape = (*in_attrs)[kValue];
+  if (!mxnet::ndim_is_known(qshape) || !mxnet::ndim_is_known(kshape) ||
+      !mxnet::ndim_is_known(vshape)) {
+    return false;
+  }
+  CHECK_EQ(qshape.ndim(), 4) << "query should be of shape (batch, heads, query_len, head_dim)";
+  CHECK_EQ(kshape.ndim(), 4) << "key should be of shape (batch, heads, key_len, head_dim)";
+  CHECK_EQ(vshape.ndim(), 4) << "value should be of shape (batch, heads, key_len, value_dim)";
+  CHECK(qshape[0] == kshape[0] && qshape[1] == kshape[1] && qshape[3] == kshape[3])
+      << "query " << qshape << " and key " << kshape << " do not match";
+  CHECK(kshape[0] == vshape[0] && kshape[1] == vshape[1] && kshape[2] == vshape[2])
+      << "key " << kshape << " and value " << vshape << " do not match";
+  if (param.use_mask) {
+    SHAPE_ASSIGN_CHECK(*in_attrs, kMask, mxnet::TShape({qshape[0], qshape[2], kshape[2]}));
+  }
+  SHAPE_ASSIGN_CHECK(*out_attrs, kOut, mxnet::TShape({qshape[0], qshape[1], qshape[2], vshape[3]}));
+  SHAPE_ASSIGN_CHECK(*out_attrs, kLogSumExp, mxnet::TShape({qshape[0], qshape[1], qshape[2]}));
+  SHAPE_ASSIGN_CHECK(*out_attrs, kSeed, mxnet::TShape(1, 1));
+  return true;
+}
+
+inline bool SDPAttentionOpType(const nnvm::NodeAttrs& attrs,
+                               std::vector<int>* in_attrs,
+                               std::vector<int>* out_attrs) {
+  using namespace sdp_attention;
+  const SDPAttentionParam& param = nnvm::get<SDPAttentionParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), param.use_mask ? 4U : 3U);
+  CHECK_EQ(out_attrs->size(), 3U);
+  int dtype = (*in_attrs)[kQuery];
+  for (int i : {kKey, kValue}) {
+    if (dtype == -1)
+      dtype = (*in_attrs)[i];
+  }
+  if (dtype == -1)
+    dtype = (*out_attrs)[kOut];
+  if (dtype == -1)
+    return false;
+  for (int i : {kQuery, kKey, kValue}) {
+    TYPE_ASSIGN_CHECK(*in_attrs, i, dtype);
+  }
+  if (param.use_mask && (*in_attrs)[kMask] == -1) {
+    (*in_attrs)[kMask] = dtype;
+  }
+  TYPE_ASSIGN_CHECK(*out_attrs, kOut, dtype);
+  // the log-sum-exp of the scores is kept in the accumulation type
+  TYPE_ASSIGN_CHECK(
+      *out_attrs, kLogSumExp, dtype == mshadow::kFloat64 ? mshadow::kFloat64 : mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_attrs, kSeed, mshadow::kInt32);
+  return true;
+}
+
+template <typename xpu>
+void SDPAttentionOpForward(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<TBlob>& outputs);
+
+template <typename xpu>
+void SDPAttentionOpBackward(const nnvm::NodeAttrs& attrs,
+                            const OpContext& ctx,
+                            const std::vector<TBlob>& inputs,
+                            const std::vector<OpReqType>& req,
+                            const std::vector<TBlob>& outputs);
+
+/*!
+ * \brief draws the dropout seed of a training forward into the seed output, the backward
+ *  reads it back to recompute the same dropout. A zero seed, as written outside of training,
+ *  turns the dropout off in both passes.
+ */
+template <typename xpu>
+inline void SDPAttentionDrawSeed(const OpContext& ctx,
+                                 const SDPAttentionParam& param,
+                                 const TBlob& seed) {
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  mshadow::Tensor<xpu, 1, unsigned> seed_tensor(
+      reinterpret_cast<unsigned*>(seed.dptr<int>()), mshadow::Shape1(1), s);
+  if (ctx.is_train && param.dropout > 0) {
+    ctx.requested[0].get_random<xpu, unsigned>(s)->GetRandInt(seed_tensor);
+  } else {
+    seed_tensor = 0U;
+  }
+}
+
+/*!
+ * \brief delta[i] = sum_d ograd[i, d] * out[i, d], the row sums of the attention weights times
+ *  their gradient that the backward needs for the gradient of the scores
+ */
+struct sdp_attention_delta {
+  template <typename DType, typename AType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  AType* delta,
+                                  const DType* ograd,
+                                  const DType* out,
+                                  const index_t v_dim) {
+    AType sum = 0;
+    for (index_t d = 0; d < v_dim; ++d) {
+      sum += static_cast<AType>(ograd[i * v_dim + d]) * static_cast<AType>(out[i * v_dim + d]);
+    }
+    delta[i] = sum;
+  }
+};
+
+/*! \brief the mask gets no gradient */
+template <typename xpu>
+inline void SDPAttentionZeroMaskGrad(mshadow::Stream<xpu>* s,
+                                     const OpReqType req,
+                                     const TBlob& grad) {
+  if (req == kNullOp || req == kAddTo)
+    return;
+  MSHADOW_TYPE_SWITCH_WITH_BOOL(grad.type_flag_, MType, {
+    mxnet_op::Kernel<mxnet_op::set_zero, xpu>::Launch(s, grad.Size(), grad.dptr<MType>());
+  });
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_SDP_ATTENTION_INL_H_
@@ -0,0 +1,546 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sdp_attention.cc
+ * \brief CPU implementation of the scaled dot-product attention operator
+ */
+#include <limits>
+#include "./sdp_attention-inl.h"
+
+namespace mxnet {
+namespace op {
+
+// the queries of a tile share each key and value row loaded from memory
+constexpr index_t kSDPAttentionQueryTileCPU = 16;
+constexpr index_t kSDPAttentionKeyTileCPU   = 64;
+
+template <typename DType, typename AType>
+inline AType SDPAttentionDotCPU(const DType* a, const DType* b, const index_t n) {
+  AType sum = 0;
+#pragma omp simd reduction(+ : sum)
+  for (index_t d = 0; d < n; ++d) {
+    sum += static_cast<AType>(a[d]) * static_cast<AType>(b[d]);
+  }
+  return sum;
+}
+
+/*!
+ * \brief the forward of one tile of queries of head bh: the scores of a tile of keys are
+ *  folded into a running max, sum and weighted sum of the values for each query, and
+ *  thrown away before the next tile of keys
+ */
+template <typename DType, typename AType, typename MType>
+void SDPAttentionForwardTileCPU(const SDPAttentionDims& dims,
+                                const index_t bh,
+                                const index_t q0,
+                                const AType scale,
+                                const bool causal,
+                                const uint32_t seed,
+                                const uint32_t threshold,
+                                const AType keep_scale,
+                                const DType* query,
+                                const DType* key,
+                                const DType* value,
+                                const MType* mask,
+                                const OpReqType req,
+                                DType* out,
+                                AType* lse,
+                                AType* scores,
+                                AType* acc,
+                                AType* row_max,
+                                AType* row_sum) {
+  const AType kNegInf    = -std::numeric_limits<AType>::infinity();
+  const index_t rows     = std::min(kSDPAttentionQueryTileCPU, dims.q_len - q0);
+  const index_t kv_end   = causal ? std::min(dims.kv_len, q0 + rows) : dims.kv_len;
+  const DType* k_head    = key + bh * dims.kv_len * dims.dim;
+  const DType* v_head    = value + bh * dims.kv_len * dims.v_dim;
+  const MType* mask_base =
+      mask == nullptr ? nullptr : mask + (bh / dims.heads) * dims.q_len * dims.kv_len;
+  std::fill(acc, acc + rows * dims.v_dim, AType(0));
+  std::fill(row_max, row_max + rows, kNegInf);
+  std::fill(row_sum, row_sum + rows, AType(0));
+  for (index_t k0 = 0; k0 < kv_end; k0 += kSDPAttentionKeyTileCPU) {
+    const index_t cols = std::min(kSDPAttentionKeyTileCPU, kv_end - k0);
+    for (index_t r = 0; r < rows; ++r) {
+      const index_t i        = q0 + r;
+      const DType* q_row     = query + (bh * dims.q_len + i) * dims.dim;
+      const MType* mask_row  = mask_base == nullptr ? nullptr : mask_base + i * dims.kv_len;
+      AType* s               = scores + r * kSDPAttentionKeyTileCPU;
+      AType tile_max         = kNegInf;
+      for (index_t c = 0; c < cols; ++c) {
+        const index_t j = k0 + c;
+        s[c]            = SDPAttentionVisible(mask_row, i, j, causal) ?
+                   scale * SDPAttentionDotCPU<DType, AType>(q_row, k_head + j * dims.dim, dims.dim) :
+                   kNegInf;
+        tile_max = std::max(tile_max, s[c]);
+      }
+      if (tile_max == kNegInf)
+        continue;
+      // rescale what was accumulated under the previous max
+      const AType new_max = std::max(row_max[r], tile_max);
+      const AType correct = std::exp(row_max[r] - new_max);
+      AType* acc_row      = acc + r * dims.v_dim;
+      row_sum[r] *= correct;
+#pragma omp simd
+      for (index_t d = 0; d < dims.v_dim; ++d) {
+        acc_row[d] *= correct;
+      }
+      for (index_t c = 0; c < cols; ++c) {
+        if (s[c] == kNegInf)
+          continue;
+        AType p = std::exp(s[c] - new_max);
+        row_sum[r] += p;
+        if (threshold != 0) {
+          if (!SDPAttentionKeep(seed, threshold, bh, i, k0 + c, dims))
+            continue;
+          p *= keep_scale;
+        }
+        const DType* v_row = v_head + (k0 + c) * dims.v_dim;
+#pragma omp simd
+        for (index_t d = 0; d < dims.v_dim; ++d) {
+          acc_row[d] += p * static_cast<AType>(v_row[d]);
+        }
+      }
+      row_max[r] = new_max;
+    }
+  }
+  for (index_t r = 0; r < rows; ++r) {
+    const index_t i      = bh * dims.q_len + q0 + r;
+    const AType inv_sum  = row_sum[r] > 0 ? AType(1) / row_sum[r] : AType(0);
+    const AType* acc_row = acc + r * dims.v_dim;
+    DType* out_row       = out + i * dims.v_dim;
+    for (index_t d = 0; d < dims.v_dim; ++d) {
+      KERNEL_ASSIGN(out_row[d], req, static_cast<DType>(acc_row[d] * inv_sum));
+    }
+    // a query that attends to no key has a zero output and no gradient
+    lse[i] = row_sum[r] > 0 ? row_max[r] + std::log(row_sum[r]) : kNegInf;
+  }
+}
+
+/*!
+ * \brief the gradient of the score of query i and key j given the recomputed weight, and the
+ *  dropout scaled weight that multiplies value j in the output
+ */
+template <typename DType, typename AType>
+inline AType SDPAttentionScoreGradCPU(const SDPAttentionDims& dims,
+                                      const AType p,
+                                      const AType delta,
+                                      const AType keep,
+                                      const DType* ograd_row,
+                                      const DType* v_row,
+                                      AType* weight) {
+  const AType dp = keep * SDPAttentionDotCPU<DType, AType>(ograd_row, v_row, dims.v_dim);
+  *weight        = keep * p;
+  return p * (dp - delta);
+}
+
+/*! \brief the gradient of one tile of queries of head bh, the keys are recomputed tile by tile */
+template <typename DType, typename AType, typename MType>
+void SDPAttentionQueryGradTileCPU(const SDPAttentionDims& dims,
+                                  const index_t bh,
+                                  const index_t q0,
+                                  const AType scale,
+                                  const bool causal,
+                                  const uint32_t seed,
+                                  const uint32_t threshold,
+                                  const AType keep_scale,
+                                  const DType* ograd,
+                                  const DType* query,
+                                  const DType* key,
+                                  const DType* value,
+                                  const MType* mask,
+                                  const AType* lse,
+                                  const AType* delta,
+                                  const OpReqType req,
+                                  DType* query_grad,
+                                  AType* acc) {
+  const index_t rows     = std::min(kSDPAttentionQueryTileCPU, dims.q_len - q0);
+  const index_t kv_end   = causal ? std::min(dims.kv_len, q0 + rows) : dims.kv_len;
+  const DType* k_head    = key + bh * dims.kv_len * dims.dim;
+  const DType* v_head    = value + bh * dims.kv_len * dims.v_dim;
+  const MType* mask_base =
+      mask == nullptr ? nullptr : mask + (bh / dims.heads) * dims.q_len * dims.kv_len;
+  std::fill(acc, acc + rows * dims.dim, AType(0));
+  for (index_t k0 = 0; k0 < kv_end; k0 += kSDPAttentionKeyTileCPU) {
+    const index_t cols = std::min(kSDPAttentionKeyTileCPU, kv_end - k0);
+    for (index_t r = 0; r < rows; ++r) {
+      const index_t i      = q0 + r;
+      const index_t row    = bh * dims.q_len + i;
+      const MType* mask_row = mask_base == nullptr ? nullptr : mask_base + i * dims.kv_len;
+      const DType* q_row   = query + row * dims.dim;
+      AType* acc_row       = acc + r * dims.dim;
+      for (index_t c = 0; c < cols; ++c) {
+        const index_t j = k0 + c;
+        if (!SDPAttentionVisible(mask_row, i, j, causal))
+          continue;
+        const DType* k_row = k_head + j * dims.dim;
+        const AType p =
+            std::exp(scale * SDPAttentionDotCPU<DType, AType>(q_row, k_row, dims.dim) - lse[row]);
+        const AType keep = threshold == 0 ? AType(1) :
+                           SDPAttentionKeep(seed, threshold, bh, i, j, dims) ? keep_scale :
+                                                                               AType(0);
+        AType weight;
+        const AType ds = SDPAttentionScoreGradCPU(dims,
+                                                  p,
+                                                  delta[row],
+                                                  keep,
+                                                  ograd + row * dims.v_dim,
+                                                  v_head + j * dims.v_dim,
+                                                  &weight);
+#pragma omp simd
+        for (index_t d = 0; d < dims.dim; ++d) {
+          acc_row[d] += ds * static_cast<AType>(k_row[d]);
+        }
+      }
+    }
+  }
+  for (index_t r = 0; r < rows; ++r) {
+    const AType* acc_row = acc + r * dims.dim;
+    DType* grad_row      = query_grad + (bh * dims.q_len + q0 + r) * dims.dim;
+    for (index_t d = 0; d < dims.dim; ++d) {
+      KERNEL_ASSIGN(grad_row[d], req, static_cast<DType>(scale * acc_row[d]));
+    }
+  }
+}
+
+/*!
+ * \brief the gradients of one tile of keys and values of head bh, the queries that see them
+ *  are streamed one by one against the cached tile
+ */
+template <typename DType, typename AType, typename MType>
+void SDPAttentionKeyValueGradTileCPU(const SDPAttentionDims& dims,
+                                     const index_t bh,
+                                     const index_t k0,
+                                     const AType scale,
+                                     const bool causal,
+                                     const uint32_t seed,
+                                     const uint32_t threshold,
+                                     const AType keep_scale,
+                                     const DType* ograd,
+                                     const DType* query,
+                                     const DType* key,
+                                     const DType* value,
+                                     const MType* mask,
+                                     const AType* lse,
+                                     const AType* delta,
+                                     const OpReqType key_req,
+                                     const OpReqType value_req,
+                                     DType* key_grad,
+                                     DType* value_grad,
+                                     AType* key_acc,
+                                     AType* value_acc) {
+  const index_t cols     = std::min(kSDPAttentionKeyTileCPU, dims.kv_len - k0);
+  const DType* k_head    = key + bh * dims.kv_len * dims.dim;
+  const DType* v_head    = value + bh * dims.kv_len * dims.v_dim;
+  const MType* mask_base =
+      mask == nullptr ? nullptr : mask + (bh / dims.heads) * dims.q_len * dims.kv_len;
+  std::fill(key_acc, key_acc + cols * dims.dim, AType(0));
+  std::fill(value_acc, value_acc + cols * dims.v_dim, AType(0));
+  // with a causal mask the queries before the first key of the tile see none of it
+  for (index_t i = causal ? std::min(k0, dims.q_len) : 0; i < dims.q_len; ++i) {
+    const index_t row       = bh * dims.q_len + i;
+    const MType* mask_row   = mask_base == nullptr ? nullptr : mask_base + i * dims.kv_len;
+    const DType* q_row      = query + row * dims.dim;
+    const DType* ograd_row  = ograd + row * dims.v_dim;
+    for (index_t c = 0; c < cols; ++c) {
+      const index_t j = k0 + c;
+      if (!SDPAttentionVisible(mask_row, i, j, causal))
+        continue;
+      const AType p = std::exp(
+          scale * SDPAttentionDotCPU<DType, AType>(q_row, k_head + j * dims.dim, dims.dim) -
+          lse[row]);
+      const AType keep = threshold == 0 ? AType(1) :
+                         SDPAttentionKeep(seed, threshold, bh, i, j, dims) ? keep_scale :
+                                                                             AType(0);
+      AType weight;
+      const AType ds = SDPAttentionScoreGradCPU(
+          dims, p, delta[row], keep, ograd_row, v_head + j * dims.v_dim, &weight);
+      AType* key_row   = key_acc + c * dims.dim;
+      AType* value_row = value_acc + c * dims.v_dim;
+#pragma omp simd
+      for (index_t d = 0; d < dims.dim; ++d) {
+        key_row[d] += ds * static_cast<AType>(q_row[d]);
+      }
+#pragma omp simd
+      for (index_t d = 0; d < dims.v_dim; ++d) {
+        value_row[d] += weight * static_cast<AType>(ograd_row[d]);
+      }
+    }
+  }
+  DType* key_grad_tile   = key_grad + (bh * dims.kv_len + k0) * dims.dim;
+  DType* value_grad_tile = value_grad + (bh * dims.kv_len + k0) * dims.v_dim;
+  if (key_req != kNullOp) {
+    for (index_t n = 0; n < cols * dims.dim; ++n) {
+      KERNEL_ASSIGN(key_grad_tile[n], key_req, static_cast<DType>(scale * key_acc[n]));
+    }
+  }
+  if (value_req != kNullOp) {
+    for (index_t n = 0; n < cols * dims.v_dim; ++n) {
+      KERNEL_ASSIGN(value_grad_tile[n], value_req, static_cast<DType>(value_acc[n]));
+    }
+  }
+}
+
+template <>
+void SDPAttentionOpForward<cpu>(const nnvm::NodeAttrs& attrs,
+                                const OpContext& ctx,
+                                const std::vector<TBlob>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<TBlob>& outputs) {
+  using namespace sdp_attention;
+  const SDPAttentionParam& param = nnvm::get<SDPAttentionParam>(attrs.parsed);
+  if (req[kOut] == kNullOp)
+    return;
+  SDPAttentionDrawSeed<cpu>(ctx, param, outputs[kSeed]);
+  const SDPAttentionDims dims = SDPAttentionGetDims(inputs[kQuery], inputs[kValue]);
+  const uint32_t seed         = static_cast<uint32_t>(*outputs[kSeed].dptr<int>());
+  const uint32_t threshold    = seed == 0 ? 0 : SDPAttentionDropThreshold(param.dropout);
+  const index_t q_tiles = (dims.q_len + kSDPAttentionQueryTileCPU - 1) / kSDPAttentionQueryTileCPU;
+  const index_t tasks   = dims.batch * dims.heads * q_tiles;
+  const int mask_type   = param.use_mask ? inputs[kMask].type_flag_ : mshadow::kBool;
+  MSHADOW_REAL_TYPE_SWITCH_EX(inputs[kQuery].type_flag_, DType, AType, {
+    MSHADOW_TYPE_SWITCH_WITH_BOOL(mask_type, MType, {
+      const MType* mask  = param.use_mask ? inputs[kMask].dptr<MType>() : nullptr;
+      const AType scale      = SDPAttentionScale(param, dims.dim);
+      const AType keep_scale = SDPAttentionKeepScale(param.dropout);
+#pragma omp parallel num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
+      {
+        std::vector<AType> scores(kSDPAttentionQueryTileCPU * kSDPAttentionKeyTileCPU);
+        std::vector<AType> acc(kSDPAttentionQueryTileCPU * dims.v_dim);
+        std::vector<AType> row_max(kSDPAttentionQueryTileCPU), row_sum(kSDPAttentionQueryTileCPU);
+        // causal tiles differ in length, hand them out one at a time
+#pragma omp for schedule(dynamic)
+        for (index_t t = 0; t < tasks; ++t) {
+          SDPAttentionForwardTileCPU(dims,
+                                     t / q_tiles,
+                                     (t % q_tiles) * kSDPAttentionQueryTileCPU,
+                                     scale,
+                                     param.causal,
+                                     seed,
+                                     threshold,
+                                     keep_scale,
+                                     inputs[kQuery].dptr<DType>(),
+                                     inputs[kKey].dptr<DType>(),
+                                     inputs[kValue].dptr<DType>(),
+                                     mask,
+                                     req[kOut],
+                                     outputs[kOut].dptr<DType>(),
+                                     outputs[kLogSumExp].dptr<AType>(),
+                                     scores.data(),
+                                     acc.data(),
+                                     row_max.data(),
+                                     row_sum.data());
+        }
+      }
+    });
+  });
+}
+
+template <>
+void SDPAttentionOpBackward<cpu>(const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<TBlob>& outputs) {
+  using namespace sdp_attention;
+  using namespace mshadow;
+  const SDPAttentionParam& param = nnvm::get<SDPAttentionParam>(attrs.parsed);
+  const size_t num_in            = param.use_mask ? 4U : 3U;
+  CHECK_EQ(inputs.size(), 1U + num_in + 3U);
+  CHECK_EQ(outputs.size(), num_in);
+  Stream<cpu>* s         = ctx.get_stream<cpu>();
+  const TBlob& ograd     = inputs[0];
+  const TBlob& query     = inputs[1 + kQuery];
+  const TBlob& key       = inputs[1 + kKey];
+  const TBlob& value     = inputs[1 + kValue];
+  const TBlob& out       = inputs[1 + num_in + kOut];
+  const TBlob& lse       = inputs[1 + num_in + kLogSumExp];
+  const TBlob& seed_blob = inputs[1 + num_in + kSeed];
+  if (param.use_mask)
+    SDPAttentionZeroMaskGrad(s, req[kMask], outputs[kMask]);
+  const SDPAttentionDims dims = SDPAttentionGetDims(query, value);
+  const uint32_t seed         = static_cast<uint32_t>(*seed_blob.dptr<int>());
+  const uint32_t threshold    = seed == 0 ? 0 : SDPAttentionDropThreshold(param.dropout);
+  const index_t heads         = dims.batch * dims.heads;
+  const index_t q_tiles = (dims.q_len + kSDPAttentionQueryTileCPU - 1) / kSDPAttentionQueryTileCPU;
+  const index_t k_tiles = (dims.kv_len + kSDPAttentionKeyTileCPU - 1) / kSDPAttentionKeyTileCPU;
+  const int mask_type   = param.use_mask ? inputs[1 + kMask].type_flag_ : mshadow::kBool;
+  const int nthreads    = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  MSHADOW_REAL_TYPE_SWITCH_EX(query.type_flag_, DType, AType, {
+    MSHADOW_TYPE_SWITCH_WITH_BOOL(mask_type, MType, {
+      const MType* mask = param.use_mask ? inputs[1 + kMask].dptr<MType>() : nullptr;
+      const AType scale      = SDPAttentionScale(param, dims.dim);
+      const AType keep_scale = SDPAttentionKeepScale(param.dropout);
+      Tensor<cpu, 1, AType> delta =
+          ctx.requested[0].get_space_typed<cpu, 1, AType>(Shape1(heads * dims.q_len), s);
+      mxnet_op::Kernel<sdp_attention_delta, cpu>::Launch(s,
+                                                         heads * dims.q_len,
+                                                         delta.dptr_,
+                                                         ograd.dptr<DType>(),
+                                                         out.dptr<DType>(),
+                                                         dims.v_dim);
+      // the query and the key/value gradients are two passes over the scores so that every
+      // tile of a gradient is owned by one thread
+      if (req[kQuery] != kNullOp) {
+#pragma omp parallel num_threads(nthreads)
+        {
+          std::vector<AType> acc(kSDPAttentionQueryTileCPU * dims.dim);
+#pragma omp for schedule(dynamic)
+          for (index_t t = 0; t < heads * q_tiles; ++t) {
+            SDPAttentionQueryGradTileCPU(dims,
+                                         t / q_tiles,
+                                         (t % q_tiles) * kSDPAttentionQueryTileCPU,
+                                         scale,
+                                         param.causal,
+                                         seed,
+                                         threshold,
+                                         keep_scale,
+                                         ograd.dptr<DType>(),
+                                         query.dptr<DType>(),
+                                         key.dptr<DType>(),
+                                         value.dptr<DType>(),
+                                         mask,
+                                         lse.dptr<AType>(),
+                                         delta.dptr_,
+                                         req[kQuery],
+                                         outputs[kQuery].dptr<DType>(),
+                                         acc.data());
+          }
+        }
+      }
+      if (req[kKey] != kNullOp || req[kValue] != kNullOp) {
+#pragma omp parallel num_threads(nthreads)
+        {
+          std::vector<AType> key_acc(kSDPAttentionKeyTileCPU * dims.dim);
+          std::vector<AType> value_acc(kSDPAttentionKeyTileCPU * dims.v_dim);
+#pragma omp for schedule(dynamic)
+          for (index_t t = 0; t < heads * k_tiles; ++t) {
+            SDPAttentionKeyValueGradTileCPU(dims,
+                                            t / k_tiles,
+                                            (t % k_tiles) * kSDPAttentionKeyTileCPU,
+                                            scale,
+                                            param.causal,
+                                            seed,
+                                            threshold,
+                                            keep_scale,
+                                            ograd.dptr<DType>(),
+                                            query.dptr<DType>(),
+                                            key.dptr<DType>(),
+                                            value.dptr<DType>(),
+                                            mask,
+                                            lse.dptr<AType>(),
+                                            delta.dptr_,
+                                            req[kKey],
+                                            req[kValue],
+                                            outputs[kKey].dptr<DType>(),
+                                            outputs[kValue].dptr<DType>(),
+                                            key_acc.data(),
+                                            value_acc.data());
+          }
+        }
+      }
+    });
+  });
+}
+
+DMLC_REGISTER_PARAMETER(SDPAttentionParam);
+
+NNVM_REGISTER_OP(_contrib_sdp_attention)
+    .describe(R"code(Scaled dot-product attention, without materializing the attention scores.
+
+For ``query`` of shape ``(batch, heads, query_len, head_dim)``, ``key`` of shape
+``(batch, heads, key_len, head_dim)`` and ``value`` of shape ``(batch, heads, key_len, value_dim)``
+computes
+
+.. math::
+
+  out = dropout(softmax(scale * query * key^T)) * value
+
+of shape ``(batch, heads, query_len, value_dim)``. The scores are computed a tile of keys at a
+time and folded into a running softmax, so memory stays linear in the sequence length instead of
+holding the ``(batch, heads, query_len, key_len)`` scores. The backward recomputes the scores tile
+by tile from the saved log-sum-exp of each row.
+
+If ``causal`` is True query ``i`` only attends to the keys ``j <= i``. If ``use_mask`` is True the
+nonzero entries of ``mask``, of shape ``(batch, query_len, key_len)``, select the keys each query
+attends to, shared by all heads. A query that attends to no key has a zero output. ``dropout`` is
+only applied in training, to the attention weights after the softmax.
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      return nnvm::get<SDPAttentionParam>(attrs.parsed).use_mask ? 4 : 3;
+    })
+    .set_num_outputs(3)
+    .set_attr<nnvm::FNumVisibleOutputs>("FNumVisibleOutputs",
+                                        [](const NodeAttrs& attrs) { return 1; })
+    .set_attr_parser(ParamParser<SDPAttentionParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       std::vector<std::string> names{"query", "key", "value"};
+                                       if (nnvm::get<SDPAttentionParam>(attrs.parsed).use_mask) {
+                                         names.emplace_back("mask");
+                                       }
+                                       return names;
+                                     })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output", "lse", "seed"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape", SDPAttentionOpShape)
+    .set_attr<nnvm::FInferType>("FInferType", SDPAttentionOpType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kRandom};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", SDPAttentionOpForward<cpu>)
+    .set_attr<nnvm::FGradient>(
+        "FGradient",
+        [](const nnvm::ObjectPtr& n, const std::vector<nnvm::NodeEntry>& ograds) {
+          std::vector<nnvm::NodeEntry> heads;
+          heads.push_back(ograds[sdp_attention::kOut]);
+          heads.insert(heads.end(), n->inputs.begin(), n->inputs.end());
+          for (uint32_t i = 0; i < 3; ++i) {
+            heads.emplace_back(n, i, 0);
+          }
+          return MakeGradNode("_backward_contrib_sdp_attention", n, heads, n->attrs.dict);
+        })
+    .add_argument("query", "NDArray-or-Symbol", "The queries.")
+    .add_argument("key", "NDArray-or-Symbol", "The keys.")
+    .add_argument("value", "NDArray-or-Symbol", "The values.")
+    .add_argument("mask", "NDArray-or-Symbol", "The mask, only if use_mask is True.")
+    .add_arguments(SDPAttentionParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_contrib_sdp_attention)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      return nnvm::get<SDPAttentionParam>(attrs.parsed).use_mask ? 8 : 7;
+    })
+    .set_num_outputs([](const NodeAttrs& attrs) {
+      return nnvm::get<SDPAttentionParam>(attrs.parsed).use_mask ? 4 : 3;
+    })
+    .set_attr_parser(ParamParser<SDPAttentionParam>)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FCompute>("FCompute<cpu>", SDPAttentionOpBackward<cpu>);
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,562 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sdp_attention.cu
+ * \brief GPU implementation of the scaled dot-product attention operator. One thread block
+ *  works on one tile of queries (or keys) of one head, the other side is staged through shared
+ *  memory a tile at a time, so the scores only ever exist as a tile x tile block.
+ */
+#include "./sdp_attention-inl.h"
+
+namespace mxnet {
+namespace op {
+
+// the number of queries and keys in a tile, and the threads of a block
+constexpr int kSDPAttentionTileGPU    = 16;
+constexpr int kSDPAttentionThreadsGPU = 128;
+
+template <typename AType>
+__device__ inline AType SDPAttentionDotGPU(const AType* a, const AType* b, const index_t n) {
+  AType sum = 0;
+  for (index_t d = 0; d < n; ++d) {
+    sum += a[d] * b[d];
+  }
+  return sum;
+}
+
+/*! \brief copies rows x width elements from global to shared memory, times scale */
+template <typename DType, typename AType>
+__device__ inline void SDPAttentionLoadTileGPU(AType* to,
+                                               const DType* from,
+                                               const index_t size,
+                                               const AType scale = AType(1)) {
+  for (index_t n = threadIdx.x; n < size; n += blockDim.x) {
+    to[n] = scale * static_cast<AType>(from[n]);
+  }
+}
+
+/*!
+ * \brief the forward of one tile of queries: each tile of scores is folded into a running max
+ *  and sum per query, which rescale the weighted sum of the values kept in shared memory
+ */
+template <typename DType, typename AType, typename MType>
+__global__ void SDPAttentionForwardKernel(const SDPAttentionDims dims,
+                                          const AType scale,
+                                          const bool causal,
+                                          const int* seed_ptr,
+                                          const uint32_t drop_threshold,
+                                          const AType keep_scale,
+                                          const DType* query,
+                                          const DType* key,
+                                          const DType* value,
+                                          const MType* mask,
+                                          const OpReqType req,
+                                          DType* out,
+                                          AType* lse) {
+  constexpr index_t T = kSDPAttentionTileGPU;
+  extern __shared__ char sdp_attention_buf[];
+  AType* q_s     = reinterpret_cast<AType*>(sdp_attention_buf);
+  AType* acc     = q_s + T * dims.dim;
+  AType* k_s     = acc + T * dims.v_dim;
+  AType* v_s     = k_s + T * dims.dim;
+  AType* p_s     = v_s + T * dims.v_dim;
+  AType* row_max = p_s + T * T;
+  AType* row_sum = row_max + T;
+  AType* correct = row_sum + T;
+
+  const AType kNegInf     = -INFINITY;
+  const uint32_t seed     = static_cast<uint32_t>(*seed_ptr);
+  const uint32_t threshold = seed == 0 ? 0 : drop_threshold;
+  const index_t q_tiles   = (dims.q_len + T - 1) / T;
+  const index_t bh        = blockIdx.x / q_tiles;
+  const index_t q0        = (blockIdx.x % q_tiles) * T;
+  const index_t rows      = min(T, dims.q_len - q0);
+  const index_t kv_end    = causal ? min(dims.kv_len, q0 + rows) : dims.kv_len;
+  const MType* mask_base =
+      mask == nullptr ? nullptr : mask + (bh / dims.heads) * dims.q_len * dims.kv_len;
+
+  SDPAttentionLoadTileGPU(q_s, query + (bh * dims.q_len + q0) * dims.dim, rows * dims.dim, scale);
+  for (index_t n = threadIdx.x; n < rows * dims.v_dim; n += blockDim.x) {
+    acc[n] = 0;
+  }
+  for (index_t r = threadIdx.x; r < rows; r += blockDim.x) {
+    row_max[r] = kNegInf;
+    row_sum[r] = 0;
+  }
+  __syncthreads();
+  for (index_t k0 = 0; k0 < kv_end; k0 += T) {
+    const index_t cols = min(T, kv_end - k0);
+    SDPAttentionLoadTileGPU(k_s, key + (bh * dims.kv_len + k0) * dims.dim, cols * dims.dim);
+    SDPAttentionLoadTileGPU(v_s, value + (bh * dims.kv_len + k0) * dims.v_dim, cols * dims.v_dim);
+    __syncthreads();
+    for (index_t n = threadIdx.x; n < rows * T; n += blockDim.x) {
+      const index_t r       = n / T;
+      const index_t c       = n % T;
+      const MType* mask_row = mask_base == nullptr ? nullptr : mask_base + (q0 + r) * dims.kv_len;
+      p_s[n]                = c < cols && SDPAttentionVisible(mask_row, q0 + r, k0 + c, causal) ?
+                   SDPAttentionDotGPU(q_s + r * dims.dim, k_s + c * dims.dim, dims.dim) :
+                   kNegInf;
+    }
+    __syncthreads();
+    for (index_t r = threadIdx.x; r < rows; r += blockDim.x) {
+      AType* p       = p_s + r * T;
+      AType tile_max = kNegInf;
+      for (index_t c = 0; c < cols; ++c) {
+        tile_max = max(tile_max, p[c]);
+      }
+      if (tile_max == kNegInf) {
+        correct[r] = 1;
+        for (index_t c = 0; c < T; ++c) {
+          p[c] = 0;
+        }
+        continue;
+      }
+      const AType new_max = max(row_max[r], tile_max);
+      correct[r]          = exp(row_max[r] - new_max);
+      AType sum           = row_sum[r] * correct[r];
+      for (index_t c = 0; c < T; ++c) {
+        const AType weight = c < cols && p[c] != kNegInf ? exp(p[c] - new_max) : AType(0);
+        sum += weight;
+        const bool keep =
+            threshold == 0 || SDPAttentionKeep(seed, threshold, bh, q0 + r, k0 + c, dims);
+        p[c] = keep ? (threshold == 0 ? weight : weight * keep_scale) : AType(0);
+      }
+      row_max[r] = new_max;
+      row_sum[r] = sum;
+    }
+    __syncthreads();
+    for (index_t n = threadIdx.x; n < rows * dims.v_dim; n += blockDim.x) {
+      const index_t r = n / dims.v_dim;
+      const index_t d = n % dims.v_dim;
+      AType sum       = acc[n] * correct[r];
+      for (index_t c = 0; c < cols; ++c) {
+        sum += p_s[r * T + c] * v_s[c * dims.v_dim + d];
+      }
+      acc[n] = sum;
+    }
+    __syncthreads();
+  }
+  for (index_t n = threadIdx.x; n < rows * dims.v_dim; n += blockDim.x) {
+    const AType sum = row_sum[n / dims.v_dim];
+    KERNEL_ASSIGN(out[(bh * dims.q_len + q0) * dims.v_dim + n],
+                  req,
+                  static_cast<DType>(sum > 0 ? acc[n] / sum : AType(0)));
+  }
+  for (index_t r = threadIdx.x; r < rows; r += blockDim.x) {
+    lse[bh * dims.q_len + q0 + r] = row_sum[r] > 0 ? row_max[r] + log(row_sum[r]) : kNegInf;
+  }
+}
+
+/*!
+ * \brief recomputes the weight of query i and key j from the log-sum-exp of its row,
+ *  and returns the gradient of its score, weight is the dropout scaled weight
+ */
+template <typename AType, typename MType>
+__device__ inline AType SDPAttentionScoreGradGPU(const SDPAttentionDims& dims,
+                                                 const index_t bh,
+                                                 const index_t i,
+                                                 const index_t j,
+                                                 const AType scale,
+                                                 const bool causal,
+                                                 const uint32_t seed,
+                                                 const uint32_t threshold,
+                                                 const AType keep_scale,
+                                                 const MType* mask_base,
+                                                 const AType* q_row,
+                                                 const AType* k_row,
+                                                 const AType* ograd_row,
+                                                 const AType* v_row,
+                                                 const AType lse,
+                                                 const AType delta,
+                                                 AType* weight) {
+  const MType* mask_row = mask_base == nullptr ? nullptr : mask_base + i * dims.kv_len;
+  if (!SDPAttentionVisible(mask_row, i, j, causal)) {
+    *weight = 0;
+    return 0;
+  }
+  const AType p    = exp(scale * SDPAttentionDotGPU(q_row, k_row, dims.dim) - lse);
+  const AType keep = threshold == 0 ? AType(1) :
+                     SDPAttentionKeep(seed, threshold, bh, i, j, dims) ? keep_scale :
+                                                                         AType(0);
+  *weight = keep * p;
+  return p * (keep * SDPAttentionDotGPU(ograd_row, v_row, dims.v_dim) - delta);
+}
+
+/*! \brief the gradient of one tile of queries, the keys and values are staged tile by tile */
+template <typename DType, typename AType, typename MType>
+__global__ void SDPAttentionQueryGradKernel(const SDPAttentionDims dims,
+                                            const AType scale,
+                                            const bool causal,
+                                            const int* seed_ptr,
+                                            const uint32_t drop_threshold,
+                                            const AType keep_scale,
+                                            const DType* ograd,
+                                            const DType* query,
+                                            const DType* key,
+                                            const DType* value,
+                                            const MType* mask,
+                                            const AType* lse,
+                                            const AType* delta,
+                                            const OpReqType req,
+                                            DType* query_grad) {
+  constexpr index_t T = kSDPAttentionTileGPU;
+  extern __shared__ char sdp_attention_buf[];
+  AType* q_s  = reinterpret_cast<AType*>(sdp_attention_buf);
+  AType* do_s = q_s + T * dims.dim;
+  AType* dq   = do_s + T * dims.v_dim;
+  AType* k_s  = dq + T * dims.dim;
+  AType* v_s  = k_s + T * dims.dim;
+  AType* ds_s = v_s + T * dims.v_dim;
+
+  const uint32_t seed      = static_cast<uint32_t>(*seed_ptr);
+  const uint32_t threshold = seed == 0 ? 0 : drop_threshold;
+  const index_t q_tiles    = (dims.q_len + T - 1) / T;
+  const index_t bh         = blockIdx.x / q_tiles;
+  const index_t q0         = (blockIdx.x % q_tiles) * T;
+  const index_t rows       = min(T, dims.q_len - q0);
+  const index_t kv_end     = causal ? min(dims.kv_len, q0 + rows) : dims.kv_len;
+  const index_t row0       = bh * dims.q_len + q0;
+  const MType* mask_base =
+      mask == nullptr ? nullptr : mask + (bh / dims.heads) * dims.q_len * dims.kv_len;
+
+  SDPAttentionLoadTileGPU(q_s, query + row0 * dims.dim, rows * dims.dim);
+  SDPAttentionLoadTileGPU(do_s, ograd + row0 * dims.v_dim, rows * dims.v_dim);
+  for (index_t n = threadIdx.x; n < rows * dims.dim; n += blockDim.x) {
+    dq[n] = 0;
+  }
+  for (index_t k0 = 0; k0 < kv_end; k0 += T) {
+    const index_t cols = min(T, kv_end - k0);
+    SDPAttentionLoadTileGPU(k_s, key + (bh * dims.kv_len + k0) * dims.dim, cols * dims.dim);
+    SDPAttentionLoadTileGPU(v_s, value + (bh * dims.kv_len + k0) * dims.v_dim, cols * dims.v_dim);
+    __syncthreads();
+    for (index_t n = threadIdx.x; n < rows * T; n += blockDim.x) {
+      const index_t r = n / T;
+      const index_t c = n % T;
+      AType weight;
+      ds_s[n] = c < cols ? SDPAttentionScoreGradGPU(dims,
+                                                           bh,
+                                                           q0 + r,
+                                                           k0 + c,
+                                                           scale,
+                                                           causal,
+                                                           seed,
+                                                           threshold,
+                                                           keep_scale,
+                                                           mask_base,
+                                                           q_s + r * dims.dim,
+                                                           k_s + c * dims.dim,
+                                                           do_s + r * dims.v_dim,
+                                                           v_s + c * dims.v_dim,
+                                                           lse[row0 + r],
+                                                           delta[row0 + r],
+                                                           &weight) :
+                           AType(0);
+    }
+    __syncthreads();
+    for (index_t n = threadIdx.x; n < rows * dims.dim; n += blockDim.x) {
+      const index_t r = n / dims.dim;
+      const index_t d = n % dims.dim;
+      AType sum       = dq[n];
+      for (index_t c = 0; c < cols; ++c) {
+        sum += ds_s[r * T + c] * k_s[c * dims.dim + d];
+      }
+      dq[n] = sum;
+    }
+    __syncthreads();
+  }
+  for (index_t n = threadIdx.x; n < rows * dims.dim; n += blockDim.x) {
+    KERNEL_ASSIGN(query_grad[row0 * dims.dim + n], req, static_cast<DType>(scale * dq[n]));
+  }
+}
+
+/*!
+ * \brief the gradients of one tile of keys and values, the queries that see them are staged
+ *  tile by tile
+ */
+template <typename DType, typename AType, typename MType>
+__global__ void SDPAttentionKeyValueGradKernel(const SDPAttentionDims dims,
+                                               const AType scale,
+                                               const bool causal,
+                                               const int* seed_ptr,
+                                               const uint32_t drop_threshold,
+                                               const AType keep_scale,
+                                               const DType* ograd,
+                                               const DType* query,
+                                               const DType* key,
+                                               const DType* value,
+                                               const MType* mask,
+                                               const AType* lse,
+                                               const AType* delta,
+                                               const OpReqType key_req,
+                                               const OpReqType value_req,
+                                               DType* key_grad,
+                                               DType* value_grad) {
+  constexpr index_t T = kSDPAttentionTileGPU;
+  extern __shared__ char sdp_attention_buf[];
+  AType* k_s  = reinterpret_cast<AType*>(sdp_attention_buf);
+  AType* v_s  = k_s + T * dims.dim;
+  AType* dk   = v_s + T * dims.v_dim;
+  AType* dv   = dk + T * dims.dim;
+  AType* q_s  = dv + T * dims.v_dim;
+  AType* do_s = q_s + T * dims.dim;
+  AType* w_s  = do_s + T * dims.v_dim;
+  AType* ds_s = w_s + T * T;
+
+  const uint32_t seed      = static_cast<uint32_t>(*seed_ptr);
+  const uint32_t threshold = seed == 0 ? 0 : drop_threshold;
+  const index_t k_tiles    = (dims.kv_len + T - 1) / T;
+  const index_t bh         = blockIdx.x / k_tiles;
+  const index_t k0         = (blockIdx.x % k_tiles) * T;
+  const index_t cols       = min(T, dims.kv_len - k0);
+  const MType* mask_base =
+      mask == nullptr ? nullptr : mask + (bh / dims.heads) * dims.q_len * dims.kv_len;
+
+  SDPAttentionLoadTileGPU(k_s, key + (bh * dims.kv_len + k0) * dims.dim, cols * dims.dim);
+  SDPAttentionLoadTileGPU(v_s, value + (bh * dims.kv_len + k0) * dims.v_dim, cols * dims.v_dim);
+  for (index_t n = threadIdx.x; n < cols * dims.dim; n += blockDim.x) {
+    dk[n] = 0;
+  }
+  for (index_t n = threadIdx.x; n < cols * dims.v_dim; n += blockDim.x) {
+    dv[n] = 0;
+  }
+  // with a causal mask the query tiles before the first key of the tile see none of it
+  const index_t q_begin = causal ? min(k0, dims.q_len) / T * T : 0;
+  for (index_t q0 = q_begin; q0 < dims.q_len; q0 += T) {
+    const index_t rows = min(T, dims.q_len - q0);
+    const index_t row0 = bh * dims.q_len + q0;
+    SDPAttentionLoadTileGPU(q_s, query + row0 * dims.dim, rows * dims.dim);
+    SDPAttentionLoadTileGPU(do_s, ograd + row0 * dims.v_dim, rows * dims.v_dim);
+    __syncthreads();
+    for (index_t n = threadIdx.x; n < T * T; n += blockDim.x) {
+      const index_t r = n / T;
+      const index_t c = n % T;
+      AType weight    = 0;
+      ds_s[n] = r < rows && c < cols ? SDPAttentionScoreGradGPU(dims,
+                                                                       bh,
+                                                                       q0 + r,
+                                                                       k0 + c,
+                                                                       scale,
+                                                                       causal,
+                                                                       seed,
+                                                                       threshold,
+                                                                       keep_scale,
+                                                                       mask_base,
+                                                                       q_s + r * dims.dim,
+                                                                       k_s + c * dims.dim,
+                                                                       do_s + r * dims.v_dim,
+                                                                       v_s + c * dims.v_dim,
+                                                                       lse[row0 + r],
+                                                                       delta[row0 + r],
+                                                                       &weight) :
+                                       AType(0);
+      w_s[n] = weight;
+    }
+    __syncthreads();
+    for (index_t n = threadIdx.x; n < cols * dims.dim; n += blockDim.x) {
+      const index_t c = n / dims.dim;
+      const index_t d = n % dims.dim;
+      AType sum       = dk[n];
+      for (index_t r = 0; r < rows; ++r) {
+        sum += ds_s[r * T + c] * q_s[r * dims.dim + d];
+      }
+      dk[n] = sum;
+    }
+    for (index_t n = threadIdx.x; n < cols * dims.v_dim; n += blockDim.x) {
+      const index_t c = n / dims.v_dim;
+      const index_t d = n % dims.v_dim;
+      AType sum       = dv[n];
+      for (index_t r = 0; r < rows; ++r) {
+        sum += w_s[r * T + c] * do_s[r * dims.v_dim + d];
+      }
+      dv[n] = sum;
+    }
+    __syncthreads();
+  }
+  if (key_req != kNullOp) {
+    for (index_t n = threadIdx.x; n < cols * dims.dim; n += blockDim.x) {
+      KERNEL_ASSIGN(key_grad[(bh * dims.kv_len + k0) * dims.dim + n],
+                    key_req,
+                    static_cast<DType>(scale * dk[n]));
+    }
+  }
+  if (value_req != kNullOp) {
+    for (index_t n = threadIdx.x; n < cols * dims.v_dim; n += blockDim.x) {
+      KERNEL_ASSIGN(value_grad[(bh * dims.kv_len + k0) * dims.v_dim + n],
+                    value_req,
+                    static_cast<DType>(dv[n]));
+    }
+  }
+}
+
+/*! \brief shared memory beyond the default 48KB has to be asked for per kernel */
+template <typename Kernel>
+inline void SDPAttentionReserveSharedMemory(Kernel kernel, const size_t bytes) {
+  if (bytes > 48 * 1024) {
+    CUDA_CALL(cudaFuncSetAttribute(
+        kernel, cudaFuncAttributeMaxDynamicSharedMemorySize, static_cast<int>(bytes)));
+  }
+}
+
+template <>
+void SDPAttentionOpForward<gpu>(const nnvm::NodeAttrs& attrs,
+                                const OpContext& ctx,
+                                const std::vector<TBlob>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<TBlob>& outputs) {
+  using namespace sdp_attention;
+  const SDPAttentionParam& param = nnvm::get<SDPAttentionParam>(attrs.parsed);
+  if (req[kOut] == kNullOp)
+    return;
+  mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+  SDPAttentionDrawSeed<gpu>(ctx, param, outputs[kSeed]);
+  const SDPAttentionDims dims = SDPAttentionGetDims(inputs[kQuery], inputs[kValue]);
+  const index_t T             = kSDPAttentionTileGPU;
+  const index_t blocks        = dims.batch * dims.heads * ((dims.q_len + T - 1) / T);
+  const int mask_type         = param.use_mask ? inputs[kMask].type_flag_ : mshadow::kBool;
+  if (blocks == 0)
+    return;
+  MSHADOW_REAL_TYPE_SWITCH_EX(inputs[kQuery].type_flag_, DType, AType, {
+    MSHADOW_TYPE_SWITCH_WITH_BOOL(mask_type, MType, {
+      const size_t shared = sizeof(AType) * (2 * T * (dims.dim + dims.v_dim) + T * T + 3 * T);
+      auto kernel         = SDPAttentionForwardKernel<DType, AType, MType>;
+      SDPAttentionReserveSharedMemory(kernel, shared);
+      kernel<<<blocks, kSDPAttentionThreadsGPU, shared, mshadow::Stream<gpu>::GetStream(s)>>>(
+          dims,
+          SDPAttentionScale(param, dims.dim),
+          param.causal,
+          outputs[kSeed].dptr<int>(),
+          SDPAttentionDropThreshold(param.dropout),
+          SDPAttentionKeepScale(param.dropout),
+          inputs[kQuery].dptr<DType>(),
+          inputs[kKey].dptr<DType>(),
+          inputs[kValue].dptr<DType>(),
+          param.use_mask ? inputs[kMask].dptr<MType>() : nullptr,
+          req[kOut],
+          outputs[kOut].dptr<DType>(),
+          outputs[kLogSumExp].dptr<AType>());
+      MSHADOW_CUDA_POST_KERNEL_CHECK(SDPAttentionForwardKernel);
+    });
+  });
+}
+
+template <>
+void SDPAttentionOpBackward<gpu>(const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<TBlob>& outputs) {
+  using namespace sdp_attention;
+  using namespace mshadow;
+  const SDPAttentionParam& param = nnvm::get<SDPAttentionParam>(attrs.parsed);
+  const size_t num_in            = param.use_mask ? 4U : 3U;
+  CHECK_EQ(inputs.size(), 1U + num_in + 3U);
+  CHECK_EQ(outputs.size(), num_in);
+  Stream<gpu>* s         = ctx.get_stream<gpu>();
+  cudaStream_t stream    = Stream<gpu>::GetStream(s);
+  const TBlob& ograd     = inputs[0];
+  const TBlob& query     = inputs[1 + kQuery];
+  const TBlob& key       = inputs[1 + kKey];
+  const TBlob& value     = inputs[1 + kValue];
+  const TBlob& out       = inputs[1 + num_in + kOut];
+  const TBlob& lse       = inputs[1 + num_in + kLogSumExp];
+  const TBlob& seed_blob = inputs[1 + num_in + kSeed];
+  if (param.use_mask)
+    SDPAttentionZeroMaskGrad(s, req[kMask], outputs[kMask]);
+  const SDPAttentionDims dims = SDPAttentionGetDims(query, value);
+  const index_t T             = kSDPAttentionTileGPU;
+  const index_t heads         = dims.batch * dims.heads;
+  const index_t q_blocks      = heads * ((dims.q_len + T - 1) / T);
+  const index_t k_blocks      = heads * ((dims.kv_len + T - 1) / T);
+  const int mask_type         = param.use_mask ? inputs[1 + kMask].type_flag_ : mshadow::kBool;
+  if (heads * dims.q_len == 0)
+    return;
+  MSHADOW_REAL_TYPE_SWITCH_EX(query.type_flag_, DType, AType, {
+    MSHADOW_TYPE_SWITCH_WITH_BOOL(mask_type, MType, {
+      const MType* mask            = param.use_mask ? inputs[1 + kMask].dptr<MType>() : nullptr;
+      const AType scale            = SDPAttentionScale(param, dims.dim);
+      const AType keep_scale       = SDPAttentionKeepScale(param.dropout);
+      const uint32_t threshold     = SDPAttentionDropThreshold(param.dropout);
+      Tensor<gpu, 1, AType> delta =
+          ctx.requested[0].get_space_typed<gpu, 1, AType>(Shape1(heads * dims.q_len), s);
+      mxnet_op::Kernel<sdp_attention_delta, gpu>::Launch(s,
+                                                         heads * dims.q_len,
+                                                         delta.dptr_,
+                                                         ograd.dptr<DType>(),
+                                                         out.dptr<DType>(),
+                                                         dims.v_dim);
+      // the query and the key/value gradients are two kernels so that every tile of a
+      // gradient is owned by one block, without atomics
+      if (req[kQuery] != kNullOp) {
+        const size_t shared = sizeof(AType) * (T * (3 * dims.dim + 2 * dims.v_dim) + T * T);
+        auto kernel         = SDPAttentionQueryGradKernel<DType, AType, MType>;
+        SDPAttentionReserveSharedMemory(kernel, shared);
+        kernel<<<q_blocks, kSDPAttentionThreadsGPU, shared, stream>>>(dims,
+                                                                      scale,
+                                                                      param.causal,
+                                                                      seed_blob.dptr<int>(),
+                                                                      threshold,
+                                                                      keep_scale,
+                                                                      ograd.dptr<DType>(),
+                                                                      query.dptr<DType>(),
+                                                                      key.dptr<DType>(),
+                                                                      value.dptr<DType>(),
+                                                                      mask,
+                                                                      lse.dptr<AType>(),
+                                                                      delta.dptr_,
+                                                                      req[kQuery],
+                                                                      outputs[kQuery].dptr<DType>());
+        MSHADOW_CUDA_POST_KERNEL_CHECK(SDPAttentionQueryGradKernel);
+      }
+      if ((req[kKey] != kNullOp || req[kValue] != kNullOp) && k_blocks > 0) {
+        const size_t shared =
+            sizeof(AType) * (3 * T * (dims.dim + dims.v_dim) + 2 * T * T);
+        auto kernel = SDPAttentionKeyValueGradKernel<DType, AType, MType>;
+        SDPAttentionReserveSharedMemory(kernel, shared);
+        kernel<<<k_blocks, kSDPAttentionThreadsGPU, shared, stream>>>(dims,
+                                                                      scale,
+                                                                      param.causal,
+                                                                      seed_blob.dptr<int>(),
+                                                                      threshold,
+                                                                      keep_scale,
+                                                                      ograd.dptr<DType>(),
+                                                                      query.dptr<DType>(),
+                                                                      key.dptr<DType>(),
+                                                                      value.dptr<DType>(),
+                                                                      mask,
+                                                                      lse.dptr<AType>(),
+                                                                      delta.dptr_,
+                                                                      req[kKey],
+                                                                      req[kValue],
+                                                                      outputs[kKey].dptr<DType>(),
+                                                                      outputs[kValue].dptr<DType>());
+        MSHADOW_CUDA_POST_KERNEL_CHECK(SDPAttentionKeyValueGradKernel);
+      }
+    });
+  });
+}
+
+NNVM_REGISTER_OP(_contrib_sdp_attention)
+    .set_attr<FCompute>("FCompute<gpu>", SDPAttentionOpForward<gpu>);
+
+NNVM_REGISTER_OP(_backward_contrib_sdp_attention)
+    .set_attr<FCompute>("FCompute<gpu>", SDPAttentionOpBackward<gpu>);
+
+}  // namespace op
+}  // namespace mxnet
@@ -43,6 +43,19 @@ enum BatchNormOpInputs { kData, kGamma, kBeta };
 enum BatchNormOpOutputs { kOut, kMean, kVar };
 enum BatchNormOpAuxiliary { kMovingMean, kMovingVar };
 enum BatchNormBackResource { kTempSpace };
+enum SyncBatchNormComm { kShared, kNCCL };
+
+/*! \brief view of data as (outer, channel, 1, inner) around its channel axis */
+inline mshadow::Shape<4> DataShape4(const mxnet::TShape& shape, int axis) {
+  if (shape.ndim() == 1)
+    return mshadow::Shape4(shape[0], 1, 1, 1);
+  if (axis < 0)
+    axis += shape.ndim();
+  CHECK(axis >= 0 && axis < shape.ndim()) << "Invalid axis " << axis << " for data of "
+                                          << shape.ndim() << " dimensions";
+  return mshadow::Shape4(
+      shape.ProdShape(0, axis), shape[axis], 1, shape.ProdShape(axis + 1, shape.ndim()));
+}
 }  // namespace syncbatchnorm
 
 struct SyncBatchNormParam : public dmlc::Parameter<SyncBatchNormParam> {
@@ -53,6 +66,8 @@ struct SyncBatchNormParam : public dmlc::Parameter<SyncBatchNormParam> {
   bool output_mean_var;
   int ndev;
   std::string key;
+  int axis;
+  int comm;
   DMLC_DECLARE_PARAMETER(SyncBatchNormParam) {
     DMLC_DECLARE_FIELD(eps).set_default(1e-3f).describe("Epsilon to prevent div 0");
     DMLC_DECLARE_FIELD(momentum).set_default(0.9f).describe("Momentum for moving average");
@@ -69,9 +84,34 @@ struct SyncBatchNormParam : public dmlc::Parameter<SyncBatchNormParam> {
     DMLC_DECLARE_FIELD(key).describe(
         "Hash key for synchronization, please set the same hash key for same layer, "
         "Block.prefix is typically used as in :class:`gluon.nn.contrib.SyncBatchNorm`.");
+    DMLC_DECLARE_FIELD(axis).set_default(1).describe(
+        "Specify which shape axis the channel is specified, e.g. 3 for NHWC data");
+    DMLC_DECLARE_FIELD(comm)
+        .add_enum("shared", syncbatchnorm::kShared)
+        .add_enum("nccl", syncbatchnorm::kNCCL)
+        .set_default(syncbatchnorm::kShared)
+        .describe(
+            "How the statistics are synchronized. 'shared' averages them through the host memory "
+            "across the ndev GPUs of this process. 'nccl' reduces them with NCCL on the GPU "
+            "streams across all the GPUs of the group set up by "
+            ":meth:`gluon.nn.SyncBatchNorm.init_nccl`, which may span processes and machines.");
   }
 };
 
+/*!
+ * \brief mean and variance of data over the GPUs of the NCCL group, merged from the count, mean
+ *        and sum of squared deviations of every GPU with the parallel algorithm of Welford
+ */
+template <typename xpu>
+void SyncBatchNormNCCLMeanVar(const OpContext& ctx,
+                              const mshadow::Tensor<xpu, 4>& data,
+                              mshadow::Tensor<xpu, 1> mean,
+                              mshadow::Tensor<xpu, 1> var);
+
+/*! \brief sums the contiguous buf in place over the GPUs of the NCCL group */
+template <typename xpu>
+void SyncBatchNormNCCLAllReduce(const OpContext& ctx, mshadow::Tensor<xpu, 1> buf);
+
 // Modified from https://github.com/brucechin/SharedTensor
 template <class T>
 class SharedND {
@@ -274,24 +314,13 @@ class SyncBatchNorm : public Operator {
       CHECK_EQ(req[syncbatchnorm::kOut], kWriteTo);
     }
 
-    Stream<xpu>* s     = ctx.get_stream<xpu>();
-    const real_t scale = static_cast<real_t>(in_data[syncbatchnorm::kData].shape_[1]) /
-                         static_cast<real_t>(in_data[syncbatchnorm::kData].shape_.Size());
-    Tensor<xpu, 4> data;
-    Tensor<xpu, 4> out;
-    if (in_data[syncbatchnorm::kData].ndim() == 4) {
-      data = in_data[syncbatchnorm::kData].get<xpu, 4, real_t>(s);
-      out  = out_data[syncbatchnorm::kOut].get<xpu, 4, real_t>(s);
-    } else {
-      index_t num_channels =
-          in_data[syncbatchnorm::kData].ndim() > 1 ? in_data[syncbatchnorm::kData].shape_[1] : 1;
-      index_t spatial_size =
-          in_data[syncbatchnorm::kData].shape_.ProdShape(2, in_data[syncbatchnorm::kData].ndim());
-      Shape<4> dshape =
-          Shape4(in_data[syncbatchnorm::kData].shape_[0], num_channels, 1, spatial_size);
-      data = in_data[syncbatchnorm::kData].get_with_shape<xpu, 4, real_t>(dshape, s);
-      out  = out_data[syncbatchnorm::kOut].get_with_shape<xpu, 4, real_t>(dshape, s);
-    }
+    Stream<xpu>* s = ctx.get_stream<xpu>();
+    const Shape<4> dshape =
+        syncbatchnorm::DataShape4(in_data[syncbatchnorm::kData].shape_, param_.axis);
+    const real_t scale  = static_cast<real_t>(dshape[1]) / static_cast<real_t>(dshape.Size());
+    Tensor<xpu, 4> data = in_data[syncbatchnorm::kData].get_with_shape<xpu, 4, real_t>(dshape, s);
+    Tensor<xpu, 4> out  = out_data[syncbatchnorm::kOut].get_with_shape<xpu, 4, real_t>(dshape, s);
+
     Tensor<xpu, 1> slope       = in_data[syncbatchnorm::kGamma].get<xpu, 1, real_t>(s);
     Tensor<xpu, 1> bias        = in_data[syncbatchnorm::kBeta].get<xpu, 1, real_t>(s);
     Tensor<xpu, 1> moving_mean = aux_states[syncbatchnorm::kMovingMean].get<xpu, 1, real_t>(s);
@@ -301,7 +330,18 @@ class SyncBatchNorm : public Operator {
       slope = 1.f;
 
     // whether use global statistics
-    if (ctx.is_train && !param_.use_global_stats) {
+    if (ctx.is_train && !param_.use_global_stats && param_.comm == syncbatchnorm::kNCCL) {
+      Tensor<xpu, 1> mean = out_data[syncbatchnorm::kMean].get<xpu, 1, real_t>(s);
+      Tensor<xpu, 1> var  = out_data[syncbatchnorm::kVar].get<xpu, 1, real_t>(s);
+      CHECK(req[syncbatchnorm::kMean] == kNullOp || req[syncbatchnorm::kMean] == kWriteTo);
+      CHECK(req[syncbatchnorm::kVar] == kNullOp || req[syncbatchnorm::kVar] == kWriteTo);
+      SyncBatchNormNCCLMeanVar(ctx, data, mean, var);
+      Assign(out,
+             req[syncbatchnorm::kOut],
+             broadcast<1>(slope, out.shape_) * (data - broadcast<1>(mean, data.shape_)) /
+                     F<mshadow_op::square_root>(broadcast<1>(var + param_.eps, data.shape_)) +
+                 broadcast<1>(bias, out.shape_));
+    } else if (ctx.is_train && !param_.use_global_stats) {
       // get my rank
       Barrier* global_barrier = global_shared_barrier_forward.Register(param_.key, param_.ndev);
       int myRank              = global_shared_rank_forward.Register(param_.key, param_.ndev);
@@ -364,24 +404,13 @@ class SyncBatchNorm : public Operator {
     CHECK_EQ(in_grad.size(), 3U);
 
     Stream<xpu>* s = ctx.get_stream<xpu>();
-    Tensor<xpu, 4> data, grad, grad_in;
-    const real_t scale = static_cast<real_t>(out_grad[syncbatchnorm::kOut].shape_[1]) /
-                         static_cast<real_t>(out_grad[syncbatchnorm::kOut].shape_.Size());
-    if (in_data[syncbatchnorm::kData].ndim() == 4) {
-      data    = in_data[syncbatchnorm::kData].get<xpu, 4, real_t>(s);
-      grad    = out_grad[syncbatchnorm::kOut].get<xpu, 4, real_t>(s);
-      grad_in = in_grad[syncbatchnorm::kData].get<xpu, 4, real_t>(s);
-    } else {
-      index_t num_channels =
-          out_grad[syncbatchnorm::kOut].ndim() > 1 ? out_grad[syncbatchnorm::kOut].shape_[1] : 1;
-      index_t spatial_size =
-          out_grad[syncbatchnorm::kOut].shape_.ProdShape(2, out_grad[syncbatchnorm::kOut].ndim());
-      Shape<4> dshape =
-          Shape4(out_grad[syncbatchnorm::kOut].shape_[0], num_channels, 1, spatial_size);
-      data    = in_data[syncbatchnorm::kData].get_with_shape<xpu, 4, real_t>(dshape, s);
-      grad    = out_grad[syncbatchnorm::kOut].get_with_shape<xpu, 4, real_t>(dshape, s);
-      grad_in = in_grad[syncbatchnorm::kData].get_with_shape<xpu, 4, real_t>(dshape, s);
-    }
+    const Shape<4> dshape =
+        syncbatchnorm::DataShape4(out_grad[syncbatchnorm::kOut].shape_, param_.axis);
+    const real_t scale  = static_cast<real_t>(dshape[1]) / static_cast<real_t>(dshape.Size());
+    Tensor<xpu, 4> data = in_data[syncbatchnorm::kData].get_with_shape<xpu, 4, real_t>(dshape, s);
+    Tensor<xpu, 4> grad = out_grad[syncbatchnorm::kOut].get_with_shape<xpu, 4, real_t>(dshape, s);
+    Tensor<xpu, 4> grad_in =
+        in_grad[syncbatchnorm::kData].get_with_shape<xpu, 4, real_t>(dshape, s);
 
     Tensor<xpu, 1> mean  = out_data[syncbatchnorm::kMean].get<xpu, 1, real_t>(s);
     Tensor<xpu, 1> var   = out_data[syncbatchnorm::kVar].get<xpu, 1, real_t>(s);
@@ -396,7 +425,47 @@ class SyncBatchNorm : public Operator {
     if (param_.fix_gamma)
       slope = 1.f;
 
-    if (ctx.is_train && !param_.use_global_stats) {
+    if (ctx.is_train && !param_.use_global_stats && param_.comm == syncbatchnorm::kNCCL) {
+      const index_t channels = mean.shape_[0];
+      // get requested temp space, of the sums of grad and grad * (data - mean) and the count
+      Tensor<xpu, 1> workspace = ctx.requested[syncbatchnorm::kTempSpace].get_space<xpu>(
+          mshadow::Shape1(4 * channels + 1), s);
+      Tensor<xpu, 1> gmean   = workspace.Slice(0, channels);
+      Tensor<xpu, 1> gvar    = workspace.Slice(channels, 2 * channels);
+      Tensor<xpu, 1> sums    = workspace.Slice(2 * channels, 4 * channels + 1);
+      Tensor<xpu, 1> sumGrad = sums.Slice(0, channels);
+      Tensor<xpu, 1> sumProd = sums.Slice(channels, 2 * channels);
+      Tensor<xpu, 1> count   = sums.Slice(2 * channels, 2 * channels + 1);
+
+      moving_mean = moving_mean * param_.momentum + mean * (1 - param_.momentum);
+      moving_var  = moving_var * param_.momentum + var * (1 - param_.momentum);
+      // the local sums give the gradients of gamma and beta, which the kvstore sums over the
+      // GPUs, and are summed over the GPUs with the counts for the gradient of the data
+      sumGrad = sumall_except_dim<1>(grad);
+      sumProd = sumall_except_dim<1>(grad * (data - broadcast<1>(mean, data.shape_)));
+      if (!param_.fix_gamma) {
+        Assign(gslope,
+               req[syncbatchnorm::kGamma],
+               sumProd / F<mshadow_op::square_root>(var + param_.eps));
+      } else {
+        Assign(gslope, req[syncbatchnorm::kGamma], 0.0f);
+      }
+      Assign(gbias, req[syncbatchnorm::kBeta], F<mshadow_op::identity>(sumGrad));
+      count = static_cast<real_t>(dshape.Size() / channels);
+      SyncBatchNormNCCLAllReduce(ctx, sums);
+
+      gvar = -1.0f * sumProd * slope * F<mshadow_op::power>(var + param_.eps, -1.5f) /
+             broadcast_scalar(count, gvar.shape_);
+      gmean = -1.0f * sumGrad * slope / F<mshadow_op::square_root>(var + param_.eps) /
+              broadcast_scalar(count, gmean.shape_);
+      Assign(grad_in,
+             req[syncbatchnorm::kData],
+             (grad * broadcast<1>(slope, data.shape_)) *
+                     broadcast<1>(1.0f / F<mshadow_op::square_root>(var + param_.eps),
+                                  data.shape_) +
+                 broadcast<1>(gvar, data.shape_) * (data - broadcast<1>(mean, data.shape_)) +
+                 broadcast<1>(gmean, data.shape_));
+    } else if (ctx.is_train && !param_.use_global_stats) {
       // get my rank
       Barrier* global_barrier = global_shared_barrier_backward.Register(param_.key, param_.ndev);
       int myRank              = global_shared_rank_backward.Register(param_.key, param_.ndev);
@@ -498,16 +567,17 @@ class SyncBatchNormProp : public OperatorProperty {
     const mxnet::TShape& dshape = in_shape->at(0);
     if (mxnet::op::shape_is_none(dshape))
       return false;
-    in_shape->at(1) = mxnet::TShape(Shape1(dshape[1]));
-    in_shape->at(2) = mxnet::TShape(Shape1(dshape[1]));
+    const index_t channels = syncbatchnorm::DataShape4(dshape, param_.axis)[1];
+    in_shape->at(1)        = mxnet::TShape(Shape1(channels));
+    in_shape->at(2)        = mxnet::TShape(Shape1(channels));
     out_shape->clear();
     out_shape->push_back(dshape);
-    out_shape->push_back(Shape1(dshape[1]));
-    out_shape->push_back(Shape1(dshape[1]));
+    out_shape->push_back(Shape1(channels));
+    out_shape->push_back(Shape1(channels));
 
     aux_shape->clear();
-    aux_shape->push_back(Shape1(dshape[1]));
-    aux_shape->push_back(Shape1(dshape[1]));
+    aux_shape->push_back(Shape1(channels));
+    aux_shape->push_back(Shape1(channels));
     return true;
   }
 
@@ -566,6 +636,12 @@ class SyncBatchNormProp : public OperatorProperty {
             in_data[syncbatchnorm::kGamma]};
   }
 
+  std::vector<ResourceRequest> ForwardResource(const mxnet::ShapeVector& in_shape) const override {
+    if (param_.comm == syncbatchnorm::kNCCL)
+      return {ResourceRequest::kTempSpace};
+    return {};
+  }
+
   std::vector<ResourceRequest> BackwardResource(const mxnet::ShapeVector& in_shape) const override {
     return {ResourceRequest::kTempSpace};
   }
@@ -24,6 +24,9 @@
 
 #include "sync_batch_norm-inl.h"
 #include <nnvm/op_attr_types.h>
+#include "../../common/alm.h"
+#include "../../common/cuda/utils.h"
+#include "./sync_batch_norm_nccl.h"
 
 namespace mxnet {
 namespace op {
@@ -32,6 +35,65 @@ Operator* CreateOp<cpu>(SyncBatchNormParam param, int dtype) {
   return new SyncBatchNorm<cpu>(param);
 }
 
+template <>
+void SyncBatchNormNCCLMeanVar<cpu>(const OpContext& ctx,
+                                   const mshadow::Tensor<cpu, 4>& data,
+                                   mshadow::Tensor<cpu, 1> mean,
+                                   mshadow::Tensor<cpu, 1> var) {
+  LOG(FATAL) << "SyncBatchNorm with comm='nccl' only runs on GPU";
+}
+
+template <>
+void SyncBatchNormNCCLAllReduce<cpu>(const OpContext& ctx, mshadow::Tensor<cpu, 1> buf) {
+  LOG(FATAL) << "SyncBatchNorm with comm='nccl' only runs on GPU";
+}
+
+#if MXNET_USE_NCCL
+namespace syncbatchnorm {
+
+NCCLComm* NCCLComm::Get() {
+  static NCCLComm inst;
+  return &inst;
+}
+
+void NCCLComm::Init(const ncclUniqueId& id,
+                    int num_procs,
+                    int proc_rank,
+                    const std::vector<int>& dev_ids) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CHECK(comms_.empty()) << "The NCCL group of SyncBatchNorm is already set up";
+  CHECK(!dev_ids.empty());
+  CHECK(proc_rank >= 0 && proc_rank < num_procs);
+  const int ndev = dev_ids.size();
+  size_          = num_procs * ndev;
+  std::vector<ncclComm_t> comms(ndev);
+  // the communicators of several GPUs of a process must be created together
+  ncclGroupStart();
+  for (int i = 0; i < ndev; ++i) {
+    mxnet::common::cuda::DeviceStore device_store(dev_ids[i]);
+    ncclCommInitRank(&comms[i], size_, id, proc_rank * ndev + i);
+  }
+  ncclGroupEnd();
+  for (int i = 0; i < ndev; ++i)
+    comms_[dev_ids[i]] = comms[i];
+}
+
+ncclComm_t NCCLComm::comm(int dev_id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = comms_.find(dev_id);
+  CHECK(it != comms_.end()) << "GPU " << dev_id << " is not in the NCCL group of SyncBatchNorm, "
+                            << "set up by gluon.nn.SyncBatchNorm.init_nccl";
+  return it->second;
+}
+
+NCCLComm::~NCCLComm() {
+  for (auto& kv : comms_)
+    ncclCommDestroy(kv.second);
+}
+
+}  // namespace syncbatchnorm
+#endif  // MXNET_USE_NCCL
+
 // DO_BIND_DISPATCH comes from operator_common.h
 Operator* SyncBatchNormProp::CreateOperatorEx(Context ctx,
                                               mxnet::ShapeVector* in_shape,
@@ -43,6 +105,25 @@ Operator* SyncBatchNormProp::CreateOperatorEx(Context ctx,
   DO_BIND_DISPATCH(CreateOp, param_, (*in_type)[0]);
 }
 
+static bool SyncBNChangeLayout(nnvm::NodeAttrs* attrs,
+                               mshadow::LayoutFlag target_layout,
+                               std::vector<alm::Transpose>* in_axes,
+                               std::vector<alm::Transpose>* out_axes) {
+  CHECK_EQ(target_layout, mshadow::kUNKNOWN);
+  auto t = alm::FactorCommonTranspose(in_axes);
+  out_axes->assign(1, t);
+  if (alm::IsIdentity(t))
+    return false;
+  // the parsed attributes of the legacy operator are its OperatorProperty, read the string
+  auto it  = attrs->dict.find("axis");
+  int axis = it == attrs->dict.end() ? 1 : std::stoi(it->second);
+  if (axis < 0)
+    axis += t.size();
+  CHECK(axis >= 0 && axis < static_cast<int>(t.size()));
+  attrs->dict["axis"] = std::to_string(t[axis]);
+  return true;
+}
+
 DMLC_REGISTER_PARAMETER(SyncBatchNormParam);
 
 MXNET_REGISTER_OP_PROPERTY(_contrib_SyncBatchNorm, SyncBatchNormProp)
@@ -104,6 +185,7 @@ Reference:
 
 NNVM_REGISTER_OP(_contrib_SyncBatchNorm)
     .add_alias("_npx_sync_batch_norm")
+    .set_attr<mxnet::alm::FChangeLayout>("FChangeLayout", SyncBNChangeLayout)
     .set_attr<nnvm::FSetInputVarAttrOnCompose>(
         "FSetInputVarAttrOnCompose",
         [](const nnvm::NodeAttrs& attrs, nnvm::ObjectPtr var, const int index) {
@@ -23,6 +23,8 @@
  */
 
 #include "sync_batch_norm-inl.h"
+#include "../mxnet_op.h"
+#include "./sync_batch_norm_nccl.h"
 
 namespace mxnet {
 namespace op {
@@ -31,5 +33,94 @@ Operator* CreateOp<gpu>(SyncBatchNormParam param, int dtype) {
   return new SyncBatchNorm<gpu>(param);
 }
 
+#if MXNET_USE_NCCL
+/*!
+ * \brief mean and variance of channel c merged over the ranks from stats, which holds for every
+ *        rank its count, the means and the sums of squared deviations of all the channels
+ */
+struct sync_batch_norm_welford_merge {
+  MSHADOW_XINLINE static void Map(index_t c,
+                                  real_t* mean,
+                                  real_t* var,
+                                  const real_t* stats,
+                                  int num_ranks,
+                                  index_t channels) {
+    real_t count = 0, m = 0, m2 = 0;
+    for (int r = 0; r < num_ranks; ++r) {
+      const real_t* rank_stats = stats + r * (2 * channels + 1);
+      const real_t rank_count  = rank_stats[0];
+      if (rank_count == 0)
+        continue;
+      const real_t delta = rank_stats[1 + c] - m;
+      const real_t total = count + rank_count;
+      m += delta * rank_count / total;
+      m2 += rank_stats[1 + channels + c] + delta * delta * count * rank_count / total;
+      count = total;
+    }
+    mean[c] = m;
+    var[c]  = count > 0 ? m2 / count : 0;
+  }
+};
+#endif  // MXNET_USE_NCCL
+
+template <>
+void SyncBatchNormNCCLMeanVar<gpu>(const OpContext& ctx,
+                                   const mshadow::Tensor<gpu, 4>& data,
+                                   mshadow::Tensor<gpu, 1> mean,
+                                   mshadow::Tensor<gpu, 1> var) {
+#if MXNET_USE_NCCL
+  using namespace mshadow;
+  using namespace mshadow::expr;
+  Stream<gpu>* s              = ctx.get_stream<gpu>();
+  syncbatchnorm::NCCLComm* nc = syncbatchnorm::NCCLComm::Get();
+  const ncclComm_t comm       = nc->comm(ctx.run_ctx.ctx.dev_id);
+  const index_t channels      = mean.shape_[0];
+  const index_t stats_size    = 2 * channels + 1;
+  const real_t count          = static_cast<real_t>(data.shape_.Size() / channels);
+  // the statistics of this GPU, followed by those of all the GPUs
+  Tensor<gpu, 1> workspace = ctx.requested[syncbatchnorm::kTempSpace].get_space<gpu>(
+      Shape1(stats_size * (nc->size() + 1)), s);
+  Tensor<gpu, 1> stats       = workspace.Slice(0, stats_size);
+  Tensor<gpu, 1> local_count = stats.Slice(0, 1);
+  Tensor<gpu, 1> local_mean  = stats.Slice(1, channels + 1);
+  Tensor<gpu, 1> local_m2    = stats.Slice(channels + 1, stats_size);
+  local_count                = count;
+  local_mean                 = (1.0f / count) * sumall_except_dim<1>(data);
+  local_m2 =
+      sumall_except_dim<1>(F<mshadow_op::square>(data - broadcast<1>(local_mean, data.shape_)));
+  {
+    std::lock_guard<std::mutex> l(Storage::Get()->GetMutex(Context::kGPU));
+    ncclAllGather(stats.dptr_,
+                  workspace.dptr_ + stats_size,
+                  stats_size,
+                  ncclFloat,
+                  comm,
+                  Stream<gpu>::GetStream(s));
+  }
+  mxnet_op::Kernel<sync_batch_norm_welford_merge, gpu>::Launch(
+      s, channels, mean.dptr_, var.dptr_, workspace.dptr_ + stats_size, nc->size(), channels);
+#else
+  LOG(FATAL) << "SyncBatchNorm with comm='nccl' requires MXNet built with USE_NCCL=1";
+#endif  // MXNET_USE_NCCL
+}
+
+template <>
+void SyncBatchNormNCCLAllReduce<gpu>(const OpContext& ctx, mshadow::Tensor<gpu, 1> buf) {
+#if MXNET_USE_NCCL
+  mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+  const ncclComm_t comm   = syncbatchnorm::NCCLComm::Get()->comm(ctx.run_ctx.ctx.dev_id);
+  std::lock_guard<std::mutex> l(Storage::Get()->GetMutex(Context::kGPU));
+  ncclAllReduce(buf.dptr_,
+                buf.dptr_,
+                buf.shape_.Size(),
+                ncclFloat,
+                ncclSum,
+                comm,
+                mshadow::Stream<gpu>::GetStream(s));
+#else
+  LOG(FATAL) << "SyncBatchNorm with comm='nccl' requires MXNet built with USE_NCCL=1";
+#endif  // MXNET_USE_NCCL
+}
+
 }  // namespace op
 }  // namespace mxnet
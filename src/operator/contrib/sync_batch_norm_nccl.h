@@ -0,0 +1,74 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file sync_batch_norm_nccl.h
+ * \brief NCCL communicators of SyncBatchNorm with comm='nccl'
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_SYNC_BATCH_NORM_NCCL_H_
+#define MXNET_OPERATOR_CONTRIB_SYNC_BATCH_NORM_NCCL_H_
+
+#if MXNET_USE_NCCL
+
+#include <nccl.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mxnet {
+namespace op {
+namespace syncbatchnorm {
+
+/*!
+ * \brief The communicators of the GPUs of this process in the group of all the GPUs running
+ *        SyncBatchNorm, shared by all its layers.
+ *
+ * Every process calls Init once with the same unique id, created by one of them and sent to
+ * the others through the kvstore. The GPU dev_ids[i] of the process of rank proc_rank then
+ * has the rank proc_rank * dev_ids.size() + i in the group.
+ */
+class NCCLComm {
+ public:
+  static NCCLComm* Get();
+
+  void Init(const ncclUniqueId& id, int num_procs, int proc_rank, const std::vector<int>& dev_ids);
+
+  /*! \brief the communicator of the GPU dev_id */
+  ncclComm_t comm(int dev_id) const;
+
+  /*! \brief the number of GPUs in the group */
+  int size() const {
+    return size_;
+  }
+
+  ~NCCLComm();
+
+ private:
+  NCCLComm() = default;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<int, ncclComm_t> comms_;
+  int size_ = 0;
+};
+
+}  // namespace syncbatchnorm
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_USE_NCCL
+#endif  // MXNET_OPERATOR_CONTRIB_SYNC_BATCH_NORM_NCCL_H_
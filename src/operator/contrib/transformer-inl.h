@@ -34,9 +34,44 @@ namespace op {
 
 struct InterleavedMatMulParam : public dmlc::Parameter<InterleavedMatMulParam> {
   int heads;
+  int kv_heads;
   bool bwd_ignore_zero_init;
   DMLC_DECLARE_PARAMETER(InterleavedMatMulParam) {
     DMLC_DECLARE_FIELD(heads).describe("Set number of heads");
+    DMLC_DECLARE_FIELD(kv_heads)
+        .set_default(0)
+        .set_lower_bound(0)
+        .describe("Number of key and value heads, each shared by heads / kv_heads query heads "
+                  "(grouped-query attention, multi-query attention for 1). "
+                  "0 means heads. Only supported by the self-attention operators.");
+  }
+};
+
+/*!
+ * \brief Layout of the interleaved projections of self-attention. The query heads are split
+ *  into kv_heads groups sharing a key and a value head, and the projections of a group are its
+ *  group_size queries followed by its key and its value, so that kv_heads == heads is the
+ *  [query key value] per head layout. The products run one strided batched gemm per query of
+ *  a group, batched over the sequences * kv_heads groups.
+ */
+struct InterleavedSelfAttLayout {
+  index_t head_dim;
+  index_t group_size;    // query heads sharing a key and a value head
+  index_t groups;        // sequences * kv_heads, the batch count of the gemms
+  index_t lead_dim;      // length of a row of the projections
+  index_t batch_stride;  // distance between the projections of two groups
+  index_t key_offset;    // offset of the key of a group from its first query
+  index_t value_offset;  // offset of the value of a group from its first query
+
+  InterleavedSelfAttLayout(const InterleavedMatMulParam& params, const mxnet::TShape& qkv_shape) {
+    const index_t kv_heads = params.kv_heads > 0 ? params.kv_heads : params.heads;
+    group_size             = params.heads / kv_heads;
+    head_dim               = qkv_shape[2] / (params.heads + 2 * kv_heads);
+    groups                 = kv_heads * qkv_shape[1];
+    lead_dim               = qkv_shape[1] * qkv_shape[2];
+    batch_stride           = (group_size + 2) * head_dim;
+    key_offset             = group_size * head_dim;
+    value_offset           = (group_size + 1) * head_dim;
   }
 };
 
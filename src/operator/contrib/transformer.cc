@@ -30,6 +30,45 @@ namespace op {
 
 DMLC_REGISTER_PARAMETER(InterleavedMatMulParam);
 
+/*!
+ * \brief FOpCost of the attention products: the score products reduce over the head dimension,
+ *  the products with the attention weights over the key sequence length
+ */
+template <int kNumProj>
+static OpCost InterleavedMatMulQKCost(const nnvm::NodeAttrs& attrs,
+                                      const std::vector<TBlob>& inputs,
+                                      const std::vector<TBlob>& outputs) {
+  const auto& params     = nnvm::get<InterleavedMatMulParam>(attrs.parsed);
+  const index_t head_dim = kNumProj == 3
+                               ? InterleavedSelfAttLayout(params, inputs[0].shape_).head_dim
+                               : inputs[0].shape_[2] / kNumProj / params.heads;
+  return MatMulCost(static_cast<double>(outputs[0].Size()) * head_dim, inputs, outputs);
+}
+
+static OpCost InterleavedMatMulValAttCost(const nnvm::NodeAttrs& attrs,
+                                          const std::vector<TBlob>& inputs,
+                                          const std::vector<TBlob>& outputs) {
+  const index_t kv_seq_len = inputs[1].shape_[2];
+  return MatMulCost(static_cast<double>(outputs[0].Size()) * kv_seq_len, inputs, outputs);
+}
+
+static void CheckInterleavedSelfAttHeads(const InterleavedMatMulParam& params,
+                                         const mxnet::TShape& qkv_shape) {
+  const int kv_heads = params.kv_heads > 0 ? params.kv_heads : params.heads;
+  CHECK_GT(params.heads, 0) << "heads should be positive, currently is " << params.heads;
+  CHECK_EQ(params.heads % kv_heads, 0)
+      << "heads should be a multiple of kv_heads, currently are " << params.heads << " and "
+      << kv_heads;
+  CHECK_EQ(qkv_shape[2] % (params.heads + 2 * kv_heads), 0)
+      << "queries_keys_values.shape[2] should be a multiple of heads + 2 * kv_heads, "
+      << "currently are " << qkv_shape[2] << " and " << params.heads + 2 * kv_heads;
+}
+
+static void CheckInterleavedEncDecHeads(const InterleavedMatMulParam& params) {
+  CHECK(params.kv_heads == 0 || params.kv_heads == params.heads)
+      << "kv_heads is only supported by the self-attention operators";
+}
+
 static bool InterleavedMatMulSelfAttQKShape(const NodeAttrs& attrs,
                                             mxnet::ShapeVector* in_shape,
                                             mxnet::ShapeVector* out_shape) {
@@ -40,6 +79,7 @@ static bool InterleavedMatMulSelfAttQKShape(const NodeAttrs& attrs,
   CHECK_EQ(qkv_shape.ndim(), 3U)
       << "Input queries_keys_values should be 3D in seq_length-batch-proj_dim, "
       << "currently is: " << qkv_shape.ndim() << "D";
+  CheckInterleavedSelfAttHeads(params, qkv_shape);
   out_shape->resize(1);
   SHAPE_ASSIGN_CHECK(
       *out_shape, 0, mxnet::TShape({params.heads * qkv_shape[1], qkv_shape[0], qkv_shape[0]}));
@@ -49,6 +89,7 @@ static bool InterleavedMatMulSelfAttQKShape(const NodeAttrs& attrs,
 static bool InterleavedMatMulSelfAttValAttShape(const NodeAttrs& attrs,
                                                 mxnet::ShapeVector* in_shape,
                                                 mxnet::ShapeVector* out_shape) {
+  const auto& params = nnvm::get<InterleavedMatMulParam>(attrs.parsed);
   CHECK_EQ(in_shape->size(), 2U) << "Input:[queries_keys_values, attention] currently have, "
                                  << in_shape->size() << " inputs";
   auto qkv_shape = in_shape->at(0);
@@ -64,9 +105,10 @@ static bool InterleavedMatMulSelfAttValAttShape(const NodeAttrs& attrs,
   CHECK_EQ(qkv_shape[0], att_shape[2])
       << "queries_keys_values.shape[0] and attention.shape[2] should be the same, "
       << "currently are " << qkv_shape[0] << " and " << att_shape[2];
-  CHECK_EQ(qkv_shape[2] % 3, 0) << "queries_keys_values.shape[2] should be a multiple of 3, "
-                                << "currently is " << qkv_shape[2];
-  SHAPE_ASSIGN_CHECK(*out_shape, 0, mxnet::TShape({qkv_shape[0], qkv_shape[1], qkv_shape[2] / 3}));
+  CheckInterleavedSelfAttHeads(params, qkv_shape);
+  const index_t head_dim = InterleavedSelfAttLayout(params, qkv_shape).head_dim;
+  SHAPE_ASSIGN_CHECK(
+      *out_shape, 0, mxnet::TShape({qkv_shape[0], qkv_shape[1], params.heads * head_dim}));
   return true;
 }
 
@@ -85,6 +127,7 @@ static bool InterleavedMatMulEncDecQKShape(const NodeAttrs& attrs,
   CHECK_EQ(q_shape[2] * 2, kv_shape[2])
       << "keys_values.shape[2] should be equal to queries.shape[2] * 2, "
       << "currently are: " << kv_shape[2] << " and " << q_shape[2];
+  CheckInterleavedEncDecHeads(params);
   CHECK_EQ(q_shape[1], kv_shape[1]) << "queries.shape[1] should be equal to keys_values.shape[1], "
                                     << "currently are: " << q_shape[1] << " and " << kv_shape[1];
   SHAPE_ASSIGN_CHECK(
@@ -104,6 +147,7 @@ static bool InterleavedMatMulEncDecValAttShape(const NodeAttrs& attrs,
                                 << "currently is " << kv_shape.ndim() << "D";
   CHECK_EQ(att_shape.ndim(), 3U) << "Input attention should be 3D in batch-seq_length-seq_length, "
                                  << "currently is " << att_shape.ndim() << "D";
+  CheckInterleavedEncDecHeads(params);
   CHECK_EQ(kv_shape[0], att_shape[2])
       << "keys_values.shape[0] should be equal to attention.shape[2], currently are " << kv_shape[0]
       << " and " << att_shape[2];
@@ -214,34 +258,31 @@ void InterleavedMatMulSelfAttQKCPU(const nnvm::NodeAttrs& attrs,
   const float* queries_keys_values = inputs[0].FlatTo2D<cpu, float>(s).dptr_;
   float* output                    = outputs[0].FlatTo2D<cpu, float>(s).dptr_;
 
-  const index_t qkv_seq_len    = inputs[0].shape_[0];
-  const index_t sequences      = inputs[0].shape_[1];
-  const index_t output_lin_dim = inputs[0].shape_[2];
-  const index_t embed_dim      = output_lin_dim / 3;
-  const index_t head_dim       = embed_dim / params.heads;
-  const index_t attn_batches   = params.heads * sequences;
-  const index_t lead_dim       = attn_batches * 3 * head_dim;
-  const index_t batch_stride   = 3 * head_dim;
-  const float beta             = req[0] == kAddTo ? 1.f : 0.f;
-  const float scale            = 1.0 / sqrt(static_cast<float>(head_dim));
+  const InterleavedSelfAttLayout layout(params, inputs[0].shape_);
+  const index_t qkv_seq_len = inputs[0].shape_[0];
+  const index_t att_stride  = qkv_seq_len * qkv_seq_len;
+  const float beta          = req[0] == kAddTo ? 1.f : 0.f;
+  const float scale         = 1.0 / sqrt(static_cast<float>(layout.head_dim));
 
-  strided_batch_sgemm(true,
-                      false,
-                      qkv_seq_len,
-                      qkv_seq_len,
-                      head_dim,
-                      scale,
-                      queries_keys_values + head_dim,
-                      lead_dim,
-                      batch_stride,
-                      queries_keys_values,
-                      lead_dim,
-                      batch_stride,
-                      beta,
-                      output,
-                      qkv_seq_len,
-                      qkv_seq_len * qkv_seq_len,
-                      attn_batches);
+  for (index_t j = 0; j < layout.group_size; ++j) {
+    strided_batch_sgemm(true,
+                        false,
+                        qkv_seq_len,
+                        qkv_seq_len,
+                        layout.head_dim,
+                        scale,
+                        queries_keys_values + layout.key_offset,
+                        layout.lead_dim,
+                        layout.batch_stride,
+                        queries_keys_values + j * layout.head_dim,
+                        layout.lead_dim,
+                        layout.batch_stride,
+                        beta,
+                        output + j * att_stride,
+                        qkv_seq_len,
+                        layout.group_size * att_stride,
+                        layout.groups);
+  }
 }
 
 void BackwardInterleavedMatMulSelfAttQKCPU(const nnvm::NodeAttrs& attrs,
@@ -260,56 +301,54 @@ void BackwardInterleavedMatMulSelfAttQKCPU(const nnvm::NodeAttrs& attrs,
   const float* output_grads        = inputs[0].FlatTo2D<cpu, float>(s).dptr_;
   const float* queries_keys_values = inputs[1].FlatTo2D<cpu, float>(s).dptr_;
   float* queries_keys_values_grads = outputs[0].FlatTo2D<cpu, float>(s).dptr_;
-  const index_t qkv_seq_len        = inputs[1].shape_[0];
-  const index_t sequences          = inputs[1].shape_[1];
-  const index_t output_lin_dim     = inputs[1].shape_[2];
-  const index_t embed_dim          = output_lin_dim / 3;
-  const index_t head_dim           = embed_dim / params.heads;
-  const index_t attn_batches       = params.heads * sequences;
-  const index_t lead_dim           = attn_batches * 3 * head_dim;
-  const index_t batch_stride       = 3 * head_dim;
-  const float scale                = 1.0 / sqrt(static_cast<float>(head_dim));
-  const float beta                 = req[0] == kAddTo ? 1.f : 0.f;
+  const InterleavedSelfAttLayout layout(params, inputs[1].shape_);
+  const index_t qkv_seq_len = inputs[1].shape_[0];
+  const index_t att_stride  = qkv_seq_len * qkv_seq_len;
+  const float scale         = 1.0 / sqrt(static_cast<float>(layout.head_dim));
+  const float beta          = req[0] == kAddTo ? 1.f : 0.f;
 
   if (req[0] == kWriteTo) {
     memset(queries_keys_values_grads, 0, outputs[0].shape_.Size() * sizeof(float));
   }
 
-  strided_batch_sgemm(false,
-                      false,
-                      head_dim,
-                      qkv_seq_len,
-                      qkv_seq_len,
-                      scale,
-                      queries_keys_values + head_dim,
-                      lead_dim,
-                      batch_stride,
-                      output_grads,
-                      qkv_seq_len,
-                      qkv_seq_len * qkv_seq_len,
-                      beta,
-                      queries_keys_values_grads,
-                      lead_dim,
-                      batch_stride,
-                      attn_batches);
+  for (index_t j = 0; j < layout.group_size; ++j) {
+    strided_batch_sgemm(false,
+                        false,
+                        layout.head_dim,
+                        qkv_seq_len,
+                        qkv_seq_len,
+                        scale,
+                        queries_keys_values + layout.key_offset,
+                        layout.lead_dim,
+                        layout.batch_stride,
+                        output_grads + j * att_stride,
+                        qkv_seq_len,
+                        layout.group_size * att_stride,
+                        beta,
+                        queries_keys_values_grads + j * layout.head_dim,
+                        layout.lead_dim,
+                        layout.batch_stride,
+                        layout.groups);
 
-  strided_batch_sgemm(false,
-                      true,
-                      head_dim,
-                      qkv_seq_len,
-                      qkv_seq_len,
-                      scale,
-                      queries_keys_values,
-                      lead_dim,
-                      batch_stride,
-                      output_grads,
-                      qkv_seq_len,
-                      qkv_seq_len * qkv_seq_len,
-                      beta,
-                      queries_keys_values_grads + head_dim,
-                      lead_dim,
-                      batch_stride,
-                      attn_batches);
+    // the key of a group accumulates the gradients of all its queries
+    strided_batch_sgemm(false,
+                        true,
+                        layout.head_dim,
+                        qkv_seq_len,
+                        qkv_seq_len,
+                        scale,
+                        queries_keys_values + j * layout.head_dim,
+                        layout.lead_dim,
+                        layout.batch_stride,
+                        output_grads + j * att_stride,
+                        qkv_seq_len,
+                        layout.group_size * att_stride,
+                        j > 0 ? 1.f : beta,
+                        queries_keys_values_grads + layout.key_offset,
+                        layout.lead_dim,
+                        layout.batch_stride,
+                        layout.groups);
+  }
 }
 
 void InterleavedMatMulSelfAttValAttCPU(const nnvm::NodeAttrs& attrs,
@@ -328,34 +367,32 @@ void InterleavedMatMulSelfAttValAttCPU(const nnvm::NodeAttrs& attrs,
   const float* queries_keys_values = inputs[0].FlatTo2D<cpu, float>(s).dptr_;
   const float* attention_maps      = inputs[1].FlatTo2D<cpu, float>(s).dptr_;
   float* output                    = outputs[0].FlatTo2D<cpu, float>(s).dptr_;
-  const index_t qkv_seq_len        = inputs[0].shape_[0];
-  const index_t sequences          = inputs[0].shape_[1];
-  const index_t output_lin_dim     = inputs[0].shape_[2];
-  const index_t embed_dim          = output_lin_dim / 3;
-  const index_t head_dim           = embed_dim / params.heads;
-  const index_t attn_batches       = params.heads * sequences;
-  const index_t lead_dim           = attn_batches * 3 * head_dim;
-  const index_t batch_stride       = 3 * head_dim;
-  const float alpha                = 1.f;
-  const float beta                 = req[0] == kAddTo ? 1.f : 0.f;
-
-  strided_batch_sgemm(false,
-                      false,
-                      head_dim,
-                      qkv_seq_len,
-                      qkv_seq_len,
-                      alpha,
-                      queries_keys_values + 2 * head_dim,
-                      lead_dim,
-                      batch_stride,
-                      attention_maps,
-                      qkv_seq_len,
-                      qkv_seq_len * qkv_seq_len,
-                      beta,
-                      output,
-                      head_dim * attn_batches,
-                      head_dim,
-                      attn_batches);
+  const InterleavedSelfAttLayout layout(params, inputs[0].shape_);
+  const index_t qkv_seq_len = inputs[0].shape_[0];
+  const index_t att_stride  = qkv_seq_len * qkv_seq_len;
+  const index_t output_dim  = outputs[0].shape_[1] * outputs[0].shape_[2];
+  const float alpha         = 1.f;
+  const float beta          = req[0] == kAddTo ? 1.f : 0.f;
+
+  for (index_t j = 0; j < layout.group_size; ++j) {
+    strided_batch_sgemm(false,
+                        false,
+                        layout.head_dim,
+                        qkv_seq_len,
+                        qkv_seq_len,
+                        alpha,
+                        queries_keys_values + layout.value_offset,
+                        layout.lead_dim,
+                        layout.batch_stride,
+                        attention_maps + j * att_stride,
+                        qkv_seq_len,
+                        layout.group_size * att_stride,
+                        beta,
+                        output + j * layout.head_dim,
+                        output_dim,
+                        layout.group_size * layout.head_dim,
+                        layout.groups);
+  }
 }
 
 void BackwardInterleavedMatMulSelfAttValAttCPU(const nnvm::NodeAttrs& attrs,
@@ -376,58 +413,59 @@ void BackwardInterleavedMatMulSelfAttValAttCPU(const nnvm::NodeAttrs& attrs,
   const float* attention_maps      = inputs[2].FlatTo2D<cpu, float>(s).dptr_;
   float* queries_keys_values_grads = outputs[0].FlatTo2D<cpu, float>(s).dptr_;
   float* attention_maps_grads      = outputs[1].FlatTo2D<cpu, float>(s).dptr_;
-  const index_t qkv_seq_len        = inputs[1].shape_[0];
-  const index_t sequences          = inputs[1].shape_[1];
-  const index_t output_lin_dim     = inputs[1].shape_[2];
-  const index_t embed_dim          = output_lin_dim / 3;
-  const index_t head_dim           = embed_dim / params.heads;
-  const index_t attn_batches       = params.heads * sequences;
-  const index_t lead_dim           = attn_batches * 3 * head_dim;
-  const index_t batch_stride       = 3 * head_dim;
-  const float alpha                = 1.f;
+  const InterleavedSelfAttLayout layout(params, inputs[1].shape_);
+  const index_t qkv_seq_len = inputs[1].shape_[0];
+  const index_t att_stride  = qkv_seq_len * qkv_seq_len;
+  const index_t output_dim  = inputs[0].shape_[1] * inputs[0].shape_[2];
+  const float alpha         = 1.f;
   if (req[0] != kNullOp) {
     if (req[0] == kWriteTo) {
       memset(queries_keys_values_grads, 0, outputs[0].shape_.Size() * sizeof(float));
     }
 
     const float beta = req[0] == kAddTo ? 1.f : 0.f;
-    strided_batch_sgemm(false,
-                        true,
-                        head_dim,
-                        qkv_seq_len,
-                        qkv_seq_len,
-                        alpha,
-                        output_grads,
-                        head_dim * attn_batches,
-                        head_dim,
-                        attention_maps,
-                        qkv_seq_len,
-                        qkv_seq_len * qkv_seq_len,
-                        beta,
-                        queries_keys_values_grads + 2 * head_dim,
-                        lead_dim,
-                        batch_stride,
-                        attn_batches);
+    // the value of a group accumulates the gradients of the outputs of all its queries
+    for (index_t j = 0; j < layout.group_size; ++j) {
+      strided_batch_sgemm(false,
+                          true,
+                          layout.head_dim,
+                          qkv_seq_len,
+                          qkv_seq_len,
+                          alpha,
+                          output_grads + j * layout.head_dim,
+                          output_dim,
+                          layout.group_size * layout.head_dim,
+                          attention_maps + j * att_stride,
+                          qkv_seq_len,
+                          layout.group_size * att_stride,
+                          j > 0 ? 1.f : beta,
+                          queries_keys_values_grads + layout.value_offset,
+                          layout.lead_dim,
+                          layout.batch_stride,
+                          layout.groups);
+    }
   }
   if (req[1] != kNullOp) {
     const float beta = req[1] == kAddTo ? 1.f : 0.f;
-    strided_batch_sgemm(true,
-                        false,
-                        qkv_seq_len,
-                        qkv_seq_len,
-                        head_dim,
-                        alpha,
-                        queries_keys_values + 2 * head_dim,
-                        lead_dim,
-                        batch_stride,
-                        output_grads,
-                        head_dim * attn_batches,
-                        head_dim,
-                        beta,
-                        attention_maps_grads,
-                        qkv_seq_len,
-                        qkv_seq_len * qkv_seq_len,
-                        attn_batches);
+    for (index_t j = 0; j < layout.group_size; ++j) {
+      strided_batch_sgemm(true,
+                          false,
+                          qkv_seq_len,
+                          qkv_seq_len,
+                          layout.head_dim,
+                          alpha,
+                          queries_keys_values + layout.value_offset,
+                          layout.lead_dim,
+                          layout.batch_stride,
+                          output_grads + j * layout.head_dim,
+                          output_dim,
+                          layout.group_size * layout.head_dim,
+                          beta,
+                          attention_maps_grads + j * att_stride,
+                          qkv_seq_len,
+                          layout.group_size * att_stride,
+                          layout.groups);
+    }
   }
 }
 
@@ -691,6 +729,13 @@ the equivalent code would be::
     k_proj = mx.nd.reshape(k_proj, shape=(-1, 0, 0), reverse=True)
     output = mx.nd.batch_dot(q_proj, k_proj, transpose_b=True)
 
+with kv_heads smaller than num_heads (grouped-query attention), the query heads are split
+into kv_heads groups of num_heads / kv_heads heads sharing a key and a value head,
+and the projections follow the layout:
+(seq_length, batch_size, kv_heads * (num_heads / kv_heads + 2) * head_dim)
+where each group holds its queries followed by its key and its value.
+The output keeps the layout (batch_size * num_heads, seq_length, seq_length).
+
 )code" ADD_FILELINE)
     .set_num_inputs(1)
     .set_num_outputs(1)
@@ -706,6 +751,7 @@ the equivalent code would be::
     .set_attr<mxnet::FInferShape>("FInferShape", InterleavedMatMulSelfAttQKShape)
     .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<1, 1>)
     .set_attr<FCompute>("FCompute<cpu>", InterleavedMatMulSelfAttQKCPU)
+    .set_attr<FOpCost>("FOpCost", InterleavedMatMulQKCost<3>)
     .set_attr<nnvm::FGradient>("FGradient",
                                ElemwiseGradUseIn{"_backward_interleaved_matmul_selfatt_qk"})
     .add_argument("queries_keys_values",
@@ -742,6 +788,10 @@ the equivalent code would be::
     output = mx.nd.transpose(output, axes=(2, 0, 1, 3))
     output = mx.nd.reshape(output, shape=(0, 0, -1))
 
+with kv_heads smaller than num_heads (grouped-query attention), the projections follow the
+grouped layout described in interleaved_matmul_selfatt_qk, and the value head of a group
+is shared by the attention weights of all its query heads.
+
 )code" ADD_FILELINE)
     .set_num_inputs(2)
     .set_num_outputs(1)
@@ -758,6 +808,7 @@ the equivalent code would be::
     .set_attr<mxnet::FInferShape>("FInferShape", InterleavedMatMulSelfAttValAttShape)
     .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<2, 1>)
     .set_attr<FCompute>("FCompute<cpu>", InterleavedMatMulSelfAttValAttCPU)
+    .set_attr<FOpCost>("FOpCost", InterleavedMatMulValAttCost)
     .set_attr<nnvm::FGradient>("FGradient",
                                ElemwiseGradUseIn{"_backward_interleaved_matmul_selfatt_valatt"})
     .add_argument("queries_keys_values",
@@ -809,6 +860,7 @@ the equivalent code would be::
     .set_attr<mxnet::FInferShape>("FInferShape", InterleavedMatMulEncDecQKShape)
     .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<2, 1>)
     .set_attr<FCompute>("FCompute<cpu>", InterleavedMatMulEncDecQKCPU)
+    .set_attr<FOpCost>("FOpCost", InterleavedMatMulQKCost<1>)
     .set_attr<nnvm::FGradient>("FGradient",
                                ElemwiseGradUseIn{"_backward_interleaved_matmul_encdec_qk"})
     .add_argument("queries", "NDArray-or-Symbol", "Queries")
@@ -859,6 +911,7 @@ the equivalent code would be::
     .set_attr<mxnet::FInferShape>("FInferShape", InterleavedMatMulEncDecValAttShape)
     .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<2, 1>)
     .set_attr<FCompute>("FCompute<cpu>", InterleavedMatMulEncDecValAttCPU)
+    .set_attr<FOpCost>("FOpCost", InterleavedMatMulValAttCost)
     .set_attr<nnvm::FGradient>("FGradient",
                                ElemwiseGradUseIn{"_backward_interleaved_matmul_encdec_valatt"})
     .add_argument("keys_values", "NDArray-or-Symbol", "Keys and values interleaved")
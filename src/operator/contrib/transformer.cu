@@ -255,40 +255,40 @@ void InterleavedMatMulSelfAttQKGPU(const nnvm::NodeAttrs& attrs,
   MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
     const DType* queries_keys_values = inputs[0].FlatTo2D<gpu, DType>(s).dptr_;
     DType* output                    = outputs[0].FlatTo2D<gpu, DType>(s).dptr_;
-    const int32_t qkv_seq_len        = inputs[0].shape_[0];
-    const int32_t sequences          = inputs[0].shape_[1];
-    const int32_t output_lin_dim     = inputs[0].shape_[2];
-    const int32_t embed_dim          = output_lin_dim / 3;
-    const int32_t head_dim           = embed_dim / params.heads;
-    const int32_t attn_batches       = params.heads * sequences;
-    const int32_t lead_dim           = attn_batches * 3 * head_dim;
-    const int32_t batch_stride       = 3 * head_dim;
-    const float beta                 = req[0] == kAddTo ? 1.f : 0.f;
-    const float scale                = 1.0 / sqrt(static_cast<float>(head_dim));
-    const bool using_fp16            = inputs[0].type_flag_ == mshadow::kFloat16;
+    const InterleavedSelfAttLayout layout(params, inputs[0].shape_);
+    const int32_t qkv_seq_len  = inputs[0].shape_[0];
+    const int32_t head_dim     = layout.head_dim;
+    const int32_t lead_dim     = layout.lead_dim;
+    const int32_t batch_stride = layout.batch_stride;
+    const int32_t att_stride   = qkv_seq_len * qkv_seq_len;
+    const float beta           = req[0] == kAddTo ? 1.f : 0.f;
+    const float scale          = 1.0 / sqrt(static_cast<float>(head_dim));
+    const bool using_fp16      = inputs[0].type_flag_ == mshadow::kFloat16;
 
     if (req[0] == kNullOp)
       return;
 
-    gemm_switch_fp32accum(s,
-                          true,
-                          false,
-                          qkv_seq_len,
-                          qkv_seq_len,
-                          head_dim,
-                          scale,
-                          queries_keys_values + head_dim,
-                          lead_dim,
-                          batch_stride,
-                          queries_keys_values,
-                          lead_dim,
-                          batch_stride,
-                          beta,
-                          output,
-                          qkv_seq_len,
-                          qkv_seq_len * qkv_seq_len,
-                          attn_batches,
-                          using_fp16);
+    for (index_t j = 0; j < layout.group_size; ++j) {
+      gemm_switch_fp32accum(s,
+                            true,
+                            false,
+                            qkv_seq_len,
+                            qkv_seq_len,
+                            head_dim,
+                            scale,
+                            queries_keys_values + layout.key_offset,
+                            lead_dim,
+                            batch_stride,
+                            queries_keys_values + j * head_dim,
+                            lead_dim,
+                            batch_stride,
+                            beta,
+                            output + j * att_stride,
+                            qkv_seq_len,
+                            layout.group_size * att_stride,
+                            layout.groups,
+                            using_fp16);
+    }
   })
 }
 
@@ -303,17 +303,15 @@ void BackwardInterleavedMatMulSelfAttQKGPU(const nnvm::NodeAttrs& attrs,
     const DType* output_grads        = inputs[0].FlatTo2D<gpu, DType>(s).dptr_;
     const DType* queries_keys_values = inputs[1].FlatTo2D<gpu, DType>(s).dptr_;
     DType* queries_keys_values_grads = outputs[0].FlatTo2D<gpu, DType>(s).dptr_;
-    const int32_t qkv_seq_len        = inputs[1].shape_[0];
-    const int32_t sequences          = inputs[1].shape_[1];
-    const int32_t output_lin_dim     = inputs[1].shape_[2];
-    const int32_t embed_dim          = output_lin_dim / 3;
-    const int32_t head_dim           = embed_dim / params.heads;
-    const int32_t attn_batches       = params.heads * sequences;
-    const int32_t lead_dim           = attn_batches * 3 * head_dim;
-    const int32_t batch_stride       = 3 * head_dim;
-    const float scale                = 1.0 / sqrt(static_cast<float>(head_dim));
-    const float beta                 = req[0] == kAddTo ? 1.f : 0.f;
-    const bool using_fp16            = inputs[0].type_flag_ == mshadow::kFloat16;
+    const InterleavedSelfAttLayout layout(params, inputs[1].shape_);
+    const int32_t qkv_seq_len  = inputs[1].shape_[0];
+    const int32_t head_dim     = layout.head_dim;
+    const int32_t lead_dim     = layout.lead_dim;
+    const int32_t batch_stride = layout.batch_stride;
+    const int32_t att_stride   = qkv_seq_len * qkv_seq_len;
+    const float scale          = 1.0 / sqrt(static_cast<float>(head_dim));
+    const float beta           = req[0] == kAddTo ? 1.f : 0.f;
+    const bool using_fp16      = inputs[0].type_flag_ == mshadow::kFloat16;
 
     if (req[0] == kNullOp)
       return;
@@ -325,44 +323,47 @@ void BackwardInterleavedMatMulSelfAttQKGPU(const nnvm::NodeAttrs& attrs,
                       mshadow::Stream<gpu>::GetStream(s));
     }
 
-    gemm_switch_fp32accum(s,
-                          false,
-                          false,
-                          head_dim,
-                          qkv_seq_len,
-                          qkv_seq_len,
-                          scale,
-                          queries_keys_values + head_dim,
-                          lead_dim,
-                          batch_stride,
-                          output_grads,
-                          qkv_seq_len,
-                          qkv_seq_len * qkv_seq_len,
-                          beta,
-                          queries_keys_values_grads,
-                          lead_dim,
-                          batch_stride,
-                          attn_batches,
-                          using_fp16);
-    gemm_switch_fp32accum(s,
-                          false,
-                          true,
-                          head_dim,
-                          qkv_seq_len,
-                          qkv_seq_len,
-                          scale,
-                          queries_keys_values,
-                          lead_dim,
-                          batch_stride,
-                          output_grads,
-                          qkv_seq_len,
-                          qkv_seq_len * qkv_seq_len,
-                          beta,
-                          queries_keys_values_grads + head_dim,
-                          lead_dim,
-                          batch_stride,
-                          attn_batches,
-                          using_fp16);
+    for (index_t j = 0; j < layout.group_size; ++j) {
+      gemm_switch_fp32accum(s,
+                            false,
+                            false,
+                            head_dim,
+                            qkv_seq_len,
+                            qkv_seq_len,
+                            scale,
+                            queries_keys_values + layout.key_offset,
+                            lead_dim,
+                            batch_stride,
+                            output_grads + j * att_stride,
+                            qkv_seq_len,
+                            layout.group_size * att_stride,
+                            beta,
+                            queries_keys_values_grads + j * head_dim,
+                            lead_dim,
+                            batch_stride,
+                            layout.groups,
+                            using_fp16);
+      // the key of a group accumulates the gradients of all its queries
+      gemm_switch_fp32accum(s,
+                            false,
+                            true,
+                            head_dim,
+                            qkv_seq_len,
+                            qkv_seq_len,
+                            scale,
+                            queries_keys_values + j * head_dim,
+                            lead_dim,
+                            batch_stride,
+                            output_grads + j * att_stride,
+                            qkv_seq_len,
+                            layout.group_size * att_stride,
+                            j > 0 ? 1.f : beta,
+                            queries_keys_values_grads + layout.key_offset,
+                            lead_dim,
+                            batch_stride,
+                            layout.groups,
+                            using_fp16);
+    }
   })
 }
 
@@ -377,40 +378,41 @@ void InterleavedMatMulSelfAttValAttGPU(const nnvm::NodeAttrs& attrs,
     const DType* queries_keys_values = inputs[0].FlatTo2D<gpu, DType>(s).dptr_;
     const DType* attention_maps      = inputs[1].FlatTo2D<gpu, DType>(s).dptr_;
     DType* output                    = outputs[0].FlatTo2D<gpu, DType>(s).dptr_;
-    const int32_t qkv_seq_len        = inputs[0].shape_[0];
-    const int32_t sequences          = inputs[0].shape_[1];
-    const int32_t output_lin_dim     = inputs[0].shape_[2];
-    const int32_t embed_dim          = output_lin_dim / 3;
-    const int32_t head_dim           = embed_dim / params.heads;
-    const int32_t attn_batches       = params.heads * sequences;
-    const int32_t lead_dim           = attn_batches * 3 * head_dim;
-    const int32_t batch_stride       = 3 * head_dim;
-    const float alpha                = 1.f;
-    const float beta                 = req[0] == kAddTo ? 1.f : 0.f;
-    const bool using_fp16            = inputs[0].type_flag_ == mshadow::kFloat16;
+    const InterleavedSelfAttLayout layout(params, inputs[0].shape_);
+    const int32_t qkv_seq_len  = inputs[0].shape_[0];
+    const int32_t head_dim     = layout.head_dim;
+    const int32_t lead_dim     = layout.lead_dim;
+    const int32_t batch_stride = layout.batch_stride;
+    const int32_t att_stride   = qkv_seq_len * qkv_seq_len;
+    const int32_t output_dim   = outputs[0].shape_[1] * outputs[0].shape_[2];
+    const float alpha          = 1.f;
+    const float beta           = req[0] == kAddTo ? 1.f : 0.f;
+    const bool using_fp16      = inputs[0].type_flag_ == mshadow::kFloat16;
 
     if (req[0] == kNullOp)
       return;
 
-    gemm_switch_fp32accum(s,
-                          false,
-                          false,
-                          head_dim,
-                          qkv_seq_len,
-                          qkv_seq_len,
-                          alpha,
-                          queries_keys_values + 2 * head_dim,
-                          lead_dim,
-                          batch_stride,
-                          attention_maps,
-                          qkv_seq_len,
-                          qkv_seq_len * qkv_seq_len,
-                          beta,
-                          output,
-                          head_dim * attn_batches,
-                          head_dim,
-                          attn_batches,
-                          using_fp16);
+    for (index_t j = 0; j < layout.group_size; ++j) {
+      gemm_switch_fp32accum(s,
+                            false,
+                            false,
+                            head_dim,
+                            qkv_seq_len,
+                            qkv_seq_len,
+                            alpha,
+                            queries_keys_values + layout.value_offset,
+                            lead_dim,
+                            batch_stride,
+                            attention_maps + j * att_stride,
+                            qkv_seq_len,
+                            layout.group_size * att_stride,
+                            beta,
+                            output + j * head_dim,
+                            output_dim,
+                            layout.group_size * head_dim,
+                            layout.groups,
+                            using_fp16);
+    }
   })
 }
 
@@ -427,16 +429,15 @@ void BackwardInterleavedMatMulSelfAttValAttGPU(const nnvm::NodeAttrs& attrs,
     const DType* attention_maps      = inputs[2].FlatTo2D<gpu, DType>(s).dptr_;
     DType* queries_keys_values_grads = outputs[0].FlatTo2D<gpu, DType>(s).dptr_;
     DType* attention_maps_grads      = outputs[1].FlatTo2D<gpu, DType>(s).dptr_;
-    const int32_t qkv_seq_len        = inputs[1].shape_[0];
-    const int32_t sequences          = inputs[1].shape_[1];
-    const int32_t output_lin_dim     = inputs[1].shape_[2];
-    const int32_t embed_dim          = output_lin_dim / 3;
-    const int32_t head_dim           = embed_dim / params.heads;
-    const int32_t attn_batches       = params.heads * sequences;
-    const int32_t lead_dim           = attn_batches * 3 * head_dim;
-    const int32_t batch_stride       = 3 * head_dim;
-    const float alpha                = 1.f;
-    const bool using_fp16            = inputs[0].type_flag_ == mshadow::kFloat16;
+    const InterleavedSelfAttLayout layout(params, inputs[1].shape_);
+    const int32_t qkv_seq_len  = inputs[1].shape_[0];
+    const int32_t head_dim     = layout.head_dim;
+    const int32_t lead_dim     = layout.lead_dim;
+    const int32_t batch_stride = layout.batch_stride;
+    const int32_t att_stride   = qkv_seq_len * qkv_seq_len;
+    const int32_t output_dim   = inputs[0].shape_[1] * inputs[0].shape_[2];
+    const float alpha          = 1.f;
+    const bool using_fp16      = inputs[0].type_flag_ == mshadow::kFloat16;
 
     if (req[0] != kNullOp) {
       if (req[0] == kWriteTo) {
@@ -446,47 +447,52 @@ void BackwardInterleavedMatMulSelfAttValAttGPU(const nnvm::NodeAttrs& attrs,
                         mshadow::Stream<gpu>::GetStream(s));
       }
       const float beta = req[0] == kAddTo ? 1.f : 0.f;
-      gemm_switch_fp32accum(s,
-                            false,
-                            true,
-                            head_dim,
-                            qkv_seq_len,
-                            qkv_seq_len,
-                            alpha,
-                            output_grads,
-                            head_dim * attn_batches,
-                            head_dim,
-                            attention_maps,
-                            qkv_seq_len,
-                            qkv_seq_len * qkv_seq_len,
-                            beta,
-                            queries_keys_values_grads + 2 * head_dim,
-                            lead_dim,
-                            batch_stride,
-                            attn_batches,
-                            using_fp16);
+      // the value of a group accumulates the gradients of the outputs of all its queries
+      for (index_t j = 0; j < layout.group_size; ++j) {
+        gemm_switch_fp32accum(s,
+                              false,
+                              true,
+                              head_dim,
+                              qkv_seq_len,
+                              qkv_seq_len,
+                              alpha,
+                              output_grads + j * head_dim,
+                              output_dim,
+                              layout.group_size * head_dim,
+                              attention_maps + j * att_stride,
+                              qkv_seq_len,
+                              layout.group_size * att_stride,
+                              j > 0 ? 1.f : beta,
+                              queries_keys_values_grads + layout.value_offset,
+                              lead_dim,
+                              batch_stride,
+                              layout.groups,
+                              using_fp16);
+      }
     }
     if (req[1] != kNullOp) {
       const float beta = req[1] == kAddTo ? 1.f : 0.f;
-      gemm_switch_fp32accum(s,
-                            true,
-                            false,
-                            qkv_seq_len,
-                            qkv_seq_len,
-                            head_dim,
-                            alpha,
-                            queries_keys_values + 2 * head_dim,
-                            lead_dim,
-                            batch_stride,
-                            output_grads,
-                            head_dim * attn_batches,
-                            head_dim,
-                            beta,
-                            attention_maps_grads,
-                            qkv_seq_len,
-                            qkv_seq_len * qkv_seq_len,
-                            attn_batches,
-                            using_fp16);
+      for (index_t j = 0; j < layout.group_size; ++j) {
+        gemm_switch_fp32accum(s,
+                              true,
+                              false,
+                              qkv_seq_len,
+                              qkv_seq_len,
+                              head_dim,
+                              alpha,
+                              queries_keys_values + layout.value_offset,
+                              lead_dim,
+                              batch_stride,
+                              output_grads + j * head_dim,
+                              output_dim,
+                              layout.group_size * head_dim,
+                              beta,
+                              attention_maps_grads + j * att_stride,
+                              qkv_seq_len,
+                              layout.group_size * att_stride,
+                              layout.groups,
+                              using_fp16);
+      }
     }
   })
 }
@@ -0,0 +1,511 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file weight_only_fc-inl.h
+ * \brief FullyConnected with int8 or packed int4 weights and float data, for inference
+ *  bound on the bandwidth of the weights, such as decoding with small batches
+ */
+#ifndef MXNET_OPERATOR_CONTRIB_WEIGHT_ONLY_FC_INL_H_
+#define MXNET_OPERATOR_CONTRIB_WEIGHT_ONLY_FC_INL_H_
+
+#include <dmlc/parameter.h>
+#include <mxnet/operator_util.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "../mshadow_op.h"
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+#include "../linalg.h"
+#include "../nn/fully_connected-inl.h"
+#if defined(__CUDACC__)
+#include "../../common/cuda/utils.h"
+#endif  // __CUDACC__
+
+namespace mxnet {
+namespace op {
+
+namespace woq {
+enum WeightOnlyFCOpInputs { kData, kWeight, kScale, kBias };
+enum WeightOnlyQuantizeOpOutputs { kQuantizedWeight, kQuantizedScale };
+}  // namespace woq
+
+/*! \brief rows of the data up to which the weights are dequantized while multiplying */
+constexpr int kWeightOnlyGemvMaxRows = 8;
+
+#define WEIGHT_ONLY_SCALE_TYPE_SWITCH(type, SType, ...)                                       \
+  switch (type) {                                                                             \
+    case mshadow::kFloat32: {                                                                 \
+      typedef float SType;                                                                    \
+      { __VA_ARGS__ }                                                                         \
+    } break;                                                                                  \
+    case mshadow::kFloat16: {                                                                 \
+      typedef mshadow::half::half_t SType;                                                    \
+      { __VA_ARGS__ }                                                                         \
+    } break;                                                                                  \
+    case mshadow::kBfloat16: {                                                                \
+      typedef mshadow::bfloat::bf16_t SType;                                                  \
+      { __VA_ARGS__ }                                                                         \
+    } break;                                                                                  \
+    default:                                                                                  \
+      LOG(FATAL) << "Unsupported scale type " << type << " of the weight-only quantization, " \
+                 << "expected float32, float16 or bfloat16";                                  \
+  }
+
+#define WEIGHT_ONLY_BITS_SWITCH(num_bits, NumBits, ...)                           \
+  if (num_bits == 4) {                                                            \
+    constexpr int NumBits = 4;                                                    \
+    { __VA_ARGS__ }                                                               \
+  } else {                                                                        \
+    CHECK_EQ(num_bits, 8) << "The weight-only quantization supports 4 or 8 bits"; \
+    constexpr int NumBits = 8;                                                    \
+    { __VA_ARGS__ }                                                               \
+  }
+
+struct WeightOnlyQuantizeParam : public dmlc::Parameter<WeightOnlyQuantizeParam> {
+  int num_bits;
+  int group_size;
+  int scale_dtype;
+  DMLC_DECLARE_PARAMETER(WeightOnlyQuantizeParam) {
+    DMLC_DECLARE_FIELD(num_bits).set_default(8).describe(
+        "Bits of the quantized weights, 8 or 4. 4-bit weights are packed two per byte, the "
+        "even input feature in the low nibble.");
+    DMLC_DECLARE_FIELD(group_size)
+        .set_default(128)
+        .set_lower_bound(1)
+        .describe(
+            "Number of consecutive input features of each output channel sharing a scale. It "
+            "must divide the number of input features, and be even for 4-bit weights.");
+    DMLC_DECLARE_FIELD(scale_dtype)
+        .add_enum("float32", mshadow::kFloat32)
+        .add_enum("float16", mshadow::kFloat16)
+        .add_enum("bfloat16", mshadow::kBfloat16)
+        .set_default(mshadow::kFloat16)
+        .describe("Type of the scales.");
+  }
+};
+
+struct WeightOnlyFCParam : public dmlc::Parameter<WeightOnlyFCParam> {
+  int num_hidden;
+  bool no_bias;
+  bool flatten;
+  int num_bits;
+  int group_size;
+  DMLC_DECLARE_PARAMETER(WeightOnlyFCParam) {
+    DMLC_DECLARE_FIELD(num_hidden).set_lower_bound(1).describe(
+        "Number of hidden nodes of the output.");
+    DMLC_DECLARE_FIELD(no_bias).set_default(false).describe("Whether to disable bias parameter.");
+    DMLC_DECLARE_FIELD(flatten).set_default(true).describe(
+        "Whether to collapse all but the first axis of the input data tensor.");
+    DMLC_DECLARE_FIELD(num_bits).set_default(8).describe(
+        "Bits of the quantized weights, as given to _contrib_weight_only_quantize.");
+    DMLC_DECLARE_FIELD(group_size)
+        .set_default(128)
+        .set_lower_bound(1)
+        .describe(
+            "Number of consecutive input features sharing a scale, as given to "
+            "_contrib_weight_only_quantize.");
+  }
+};
+
+/*! \brief bytes of the quantized weights of an output channel */
+MSHADOW_XINLINE index_t WeightOnlyRowBytes(index_t in_features, int num_bits) {
+  return num_bits == 4 ? in_features / 2 : in_features;
+}
+
+/*! \brief the quantized weight of input feature k of a row */
+template <int num_bits>
+MSHADOW_XINLINE int WeightOnlyValue(const uint8_t* row, index_t k) {
+  if (num_bits == 4) {
+    return ((row[k >> 1] >> ((k & 1) * 4)) & 0xF) - 8;
+  }
+  return static_cast<int8_t>(row[k]);
+}
+
+/*! \brief scale and quantize the weights of group i, symmetric around 0 */
+template <int num_bits>
+struct weight_only_quantize {
+  template <typename DType, typename SType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  uint8_t* qweight,
+                                  SType* scale,
+                                  const DType* weight,
+                                  index_t in_features,
+                                  index_t group_size) {
+    const index_t groups = in_features / group_size;
+    const index_t k0     = (i % groups) * group_size;
+    const DType* w       = weight + (i / groups) * in_features + k0;
+    uint8_t* row         = qweight + (i / groups) * WeightOnlyRowBytes(in_features, num_bits);
+    const float qmax     = num_bits == 4 ? 7.0f : 127.0f;
+    float amax           = 0.0f;
+    for (index_t k = 0; k < group_size; ++k) {
+      amax = fmaxf(amax, fabsf(static_cast<float>(w[k])));
+    }
+    // quantized with the scale as stored, which may be rounded to 16 bits
+    scale[i]              = SType(amax / qmax);
+    const float stored    = static_cast<float>(scale[i]);
+    const float inv_scale = stored > 0.0f ? 1.0f / stored : 0.0f;
+    for (index_t k = 0; k < group_size; ++k) {
+      const int q =
+          static_cast<int>(fminf(fmaxf(roundf(static_cast<float>(w[k]) * inv_scale), -qmax), qmax));
+      if (num_bits == 4) {
+        // group_size is even, the even feature of a byte is written first
+        const index_t pos = k0 + k;
+        if (pos & 1) {
+          row[pos >> 1] |= static_cast<uint8_t>((q + 8) << 4);
+        } else {
+          row[pos >> 1] = static_cast<uint8_t>(q + 8);
+        }
+      } else {
+        row[k0 + k] = static_cast<uint8_t>(static_cast<int8_t>(q));
+      }
+    }
+  }
+};
+
+/*! \brief dequantize weight i, of output channel i / in_features */
+template <int num_bits>
+struct weight_only_dequantize {
+  template <typename DType, typename SType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* weight,
+                                  const uint8_t* qweight,
+                                  const SType* scale,
+                                  index_t in_features,
+                                  index_t group_size) {
+    const index_t c    = i / in_features;
+    const index_t k    = i % in_features;
+    const uint8_t* row = qweight + c * WeightOnlyRowBytes(in_features, num_bits);
+    weight[i]          = DType(WeightOnlyValue<num_bits>(row, k) *
+                      static_cast<float>(scale[c * (in_features / group_size) + k / group_size]));
+  }
+};
+
+/*!
+ * \brief out = data * weight^T + bias for a few rows of data. Each thread streams the weights
+ *  of its output channels once and dequantizes them a group at a time into a buffer that
+ *  stays in L1, the data stays in cache.
+ */
+template <int num_bits, typename DType, typename SType>
+void WeightOnlyGemv(mshadow::Stream<cpu>* s,
+                    const DType* data,
+                    const uint8_t* qweight,
+                    const SType* scale,
+                    const DType* bias,
+                    DType* out,
+                    index_t rows,
+                    index_t channels,
+                    index_t in_features,
+                    index_t group_size) {
+  const index_t groups    = in_features / group_size;
+  const index_t row_bytes = WeightOnlyRowBytes(in_features, num_bits);
+  const int nthreads      = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel num_threads(nthreads)
+  {
+    std::vector<float> w(group_size);
+    std::vector<float> acc(rows);
+#pragma omp for
+    for (index_t c = 0; c < channels; ++c) {
+      const uint8_t* wrow = qweight + c * row_bytes;
+      std::fill(acc.begin(), acc.end(), 0.0f);
+      for (index_t g = 0; g < groups; ++g) {
+        const index_t k0 = g * group_size;
+        for (index_t k = 0; k < group_size; ++k) {
+          w[k] = WeightOnlyValue<num_bits>(wrow, k0 + k);
+        }
+        const float group_scale = static_cast<float>(scale[c * groups + g]);
+        for (index_t r = 0; r < rows; ++r) {
+          const DType* x = data + r * in_features + k0;
+          float dot      = 0.0f;
+#pragma omp simd reduction(+ : dot)
+          for (index_t k = 0; k < group_size; ++k) {
+            dot += static_cast<float>(x[k]) * w[k];
+          }
+          acc[r] += dot * group_scale;
+        }
+      }
+      const float b = bias != nullptr ? static_cast<float>(bias[c]) : 0.0f;
+      for (index_t r = 0; r < rows; ++r) {
+        out[r * channels + c] = DType(acc[r] + b);
+      }
+    }
+  }
+}
+
+#if defined(__CUDACC__)
+
+/*!
+ * \brief one warp per output channel: the lanes read consecutive weights, dequantize them
+ *  in registers and multiply them with every row of the data
+ */
+template <int num_bits, typename DType, typename SType>
+__global__ void weight_only_gemv_kernel(const DType* data,
+                                        const uint8_t* qweight,
+                                        const SType* scale,
+                                        const DType* bias,
+                                        DType* out,
+                                        index_t rows,
+                                        index_t channels,
+                                        index_t in_features,
+                                        index_t group_size) {
+  using mxnet::common::cuda::warp_size;
+  const index_t c = (static_cast<index_t>(blockIdx.x) * blockDim.x + threadIdx.x) / warp_size;
+  const int lane  = threadIdx.x % warp_size;
+  if (c >= channels) {
+    return;
+  }
+  const index_t groups = in_features / group_size;
+  const uint8_t* wrow  = qweight + c * WeightOnlyRowBytes(in_features, num_bits);
+  float acc[kWeightOnlyGemvMaxRows];
+#pragma unroll
+  for (int r = 0; r < kWeightOnlyGemvMaxRows; ++r) {
+    acc[r] = 0.0f;
+  }
+  for (index_t k = lane; k < in_features; k += warp_size) {
+    const float w = WeightOnlyValue<num_bits>(wrow, k) *
+                    static_cast<float>(scale[c * groups + k / group_size]);
+#pragma unroll
+    for (int r = 0; r < kWeightOnlyGemvMaxRows; ++r) {
+      if (r < rows) {
+        acc[r] += static_cast<float>(data[r * in_features + k]) * w;
+      }
+    }
+  }
+  const float b = bias != nullptr ? static_cast<float>(bias[c]) : 0.0f;
+#pragma unroll
+  for (int r = 0; r < kWeightOnlyGemvMaxRows; ++r) {
+    const float sum =
+        mxnet::common::cuda::warp_reduce(acc[r], [](float x, float y) { return x + y; });
+    if (lane == 0 && r < rows) {
+      out[r * channels + c] = DType(sum + b);
+    }
+  }
+}
+
+template <int num_bits, typename DType, typename SType>
+void WeightOnlyGemv(mshadow::Stream<gpu>* s,
+                    const DType* data,
+                    const uint8_t* qweight,
+                    const SType* scale,
+                    const DType* bias,
+                    DType* out,
+                    index_t rows,
+                    index_t channels,
+                    index_t in_features,
+                    index_t group_size) {
+  using mxnet::common::cuda::warp_size;
+  constexpr int nthreads = 256;
+  const index_t nblocks  = (channels * warp_size + nthreads - 1) / nthreads;
+  weight_only_gemv_kernel<num_bits>
+      <<<nblocks, nthreads, 0, mshadow::Stream<gpu>::GetStream(s)>>>(
+          data, qweight, scale, bias, out, rows, channels, in_features, group_size);
+  MSHADOW_CUDA_POST_KERNEL_CHECK(weight_only_gemv_kernel);
+}
+
+#endif  // __CUDACC__
+
+inline bool WeightOnlyQuantizeShape(const nnvm::NodeAttrs& attrs,
+                                    mxnet::ShapeVector* in_attrs,
+                                    mxnet::ShapeVector* out_attrs) {
+  const WeightOnlyQuantizeParam& param = nnvm::get<WeightOnlyQuantizeParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), 1U);
+  CHECK_EQ(out_attrs->size(), 2U);
+  const mxnet::TShape& wshape = in_attrs->at(0);
+  if (!shape_is_known(wshape)) {
+    return false;
+  }
+  CHECK_EQ(wshape.ndim(), 2) << "The weight to quantize must be 2D, (num_hidden, input_dim)";
+  CHECK_EQ(wshape[1] % param.group_size, 0)
+      << "group_size " << param.group_size << " does not divide the " << wshape[1]
+      << " input features of the weight";
+  CHECK(param.num_bits == 8 || (param.num_bits == 4 && param.group_size % 2 == 0))
+      << "The weight-only quantization supports 8 bits, or 4 bits with an even group_size";
+  SHAPE_ASSIGN_CHECK(*out_attrs,
+                     woq::kQuantizedWeight,
+                     Shape2(wshape[0], WeightOnlyRowBytes(wshape[1], param.num_bits)));
+  SHAPE_ASSIGN_CHECK(
+      *out_attrs, woq::kQuantizedScale, Shape2(wshape[0], wshape[1] / param.group_size));
+  return true;
+}
+
+inline bool WeightOnlyQuantizeType(const nnvm::NodeAttrs& attrs,
+                                   std::vector<int>* in_attrs,
+                                   std::vector<int>* out_attrs) {
+  const WeightOnlyQuantizeParam& param = nnvm::get<WeightOnlyQuantizeParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), 1U);
+  CHECK_EQ(out_attrs->size(), 2U);
+  TYPE_ASSIGN_CHECK(
+      *out_attrs, woq::kQuantizedWeight, param.num_bits == 4 ? mshadow::kUint8 : mshadow::kInt8);
+  TYPE_ASSIGN_CHECK(*out_attrs, woq::kQuantizedScale, param.scale_dtype);
+  return in_attrs->at(0) != -1;
+}
+
+template <typename xpu>
+void WeightOnlyQuantizeForward(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const WeightOnlyQuantizeParam& param = nnvm::get<WeightOnlyQuantizeParam>(attrs.parsed);
+  mshadow::Stream<xpu>* s   = ctx.get_stream<xpu>();
+  const TBlob& weight       = inputs[0];
+  const index_t in_features = weight.shape_[1];
+  const index_t num_groups  = weight.shape_[0] * (in_features / param.group_size);
+  MSHADOW_REAL_TYPE_SWITCH(weight.type_flag_, DType, {
+    WEIGHT_ONLY_SCALE_TYPE_SWITCH(outputs[woq::kQuantizedScale].type_flag_, SType, {
+      WEIGHT_ONLY_BITS_SWITCH(param.num_bits, NumBits, {
+        Kernel<weight_only_quantize<NumBits>, xpu>::Launch(
+            s,
+            num_groups,
+            reinterpret_cast<uint8_t*>(outputs[woq::kQuantizedWeight].dptr_),
+            outputs[woq::kQuantizedScale].dptr<SType>(),
+            weight.dptr<DType>(),
+            in_features,
+            static_cast<index_t>(param.group_size));
+      });
+    });
+  });
+}
+
+inline bool WeightOnlyFCShape(const nnvm::NodeAttrs& attrs,
+                              mxnet::ShapeVector* in_attrs,
+                              mxnet::ShapeVector* out_attrs) {
+  const WeightOnlyFCParam& param = nnvm::get<WeightOnlyFCParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), param.no_bias ? 3U : 4U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  const mxnet::TShape& dshape = in_attrs->at(woq::kData);
+  if (!mxnet::ndim_is_known(dshape)) {
+    return false;
+  }
+  index_t in_features;
+  mxnet::TShape oshape = dshape;
+  if (param.flatten) {
+    in_features = dshape.ProdShape(1, dshape.ndim());
+    oshape      = Shape2(dshape[0], param.num_hidden);
+  } else {
+    in_features               = dshape[dshape.ndim() - 1];
+    oshape[dshape.ndim() - 1] = param.num_hidden;
+  }
+  if (in_features <= 0) {
+    return false;
+  }
+  CHECK_EQ(in_features % param.group_size, 0)
+      << "group_size " << param.group_size << " does not divide the " << in_features
+      << " input features";
+  SHAPE_ASSIGN_CHECK(*in_attrs,
+                     woq::kWeight,
+                     Shape2(param.num_hidden, WeightOnlyRowBytes(in_features, param.num_bits)));
+  SHAPE_ASSIGN_CHECK(
+      *in_attrs, woq::kScale, Shape2(param.num_hidden, in_features / param.group_size));
+  if (!param.no_bias) {
+    SHAPE_ASSIGN_CHECK(*in_attrs, woq::kBias, Shape1(param.num_hidden));
+  }
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, oshape);
+  return shape_is_known(oshape);
+}
+
+inline bool WeightOnlyFCType(const nnvm::NodeAttrs& attrs,
+                             std::vector<int>* in_attrs,
+                             std::vector<int>* out_attrs) {
+  const WeightOnlyFCParam& param = nnvm::get<WeightOnlyFCParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), param.no_bias ? 3U : 4U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  TYPE_ASSIGN_CHECK(
+      *in_attrs, woq::kWeight, param.num_bits == 4 ? mshadow::kUint8 : mshadow::kInt8);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(woq::kData));
+  TYPE_ASSIGN_CHECK(*in_attrs, woq::kData, out_attrs->at(0));
+  if (!param.no_bias) {
+    TYPE_ASSIGN_CHECK(*in_attrs, woq::kBias, out_attrs->at(0));
+  }
+  return out_attrs->at(0) != -1 && in_attrs->at(woq::kScale) != -1;
+}
+
+template <typename xpu>
+void WeightOnlyFCForward(const nnvm::NodeAttrs& attrs,
+                         const OpContext& ctx,
+                         const std::vector<TBlob>& inputs,
+                         const std::vector<OpReqType>& req,
+                         const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  const WeightOnlyFCParam& param = nnvm::get<WeightOnlyFCParam>(attrs.parsed);
+  if (req[0] == kNullOp)
+    return;
+  CHECK_EQ(req[0], kWriteTo);
+  Stream<xpu>* s = ctx.get_stream<xpu>();
+  const TBlob& qweight       = inputs[woq::kWeight];
+  const TBlob& scale         = inputs[woq::kScale];
+  const index_t channels     = param.num_hidden;
+  const index_t group_size   = param.group_size;
+  const index_t in_features  = scale.shape_[1] * group_size;
+  const uint8_t* qweight_ptr = reinterpret_cast<const uint8_t*>(qweight.dptr_);
+  MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
+    Tensor<xpu, 2, DType> data, out;
+    if (!param.flatten) {
+      data = FlattenAs2DHead<xpu, DType>(inputs[woq::kData], ctx);
+      out  = FlattenAs2DHead<xpu, DType>(outputs[0], ctx);
+    } else {
+      data = FlattenAs2DTail<xpu, DType>(inputs[woq::kData], ctx);
+      out  = FlattenAs2DTail<xpu, DType>(outputs[0], ctx);
+    }
+    const index_t rows = data.size(0);
+    const DType* bias  = param.no_bias ? nullptr : inputs[woq::kBias].dptr<DType>();
+    WEIGHT_ONLY_SCALE_TYPE_SWITCH(scale.type_flag_, SType, {
+      WEIGHT_ONLY_BITS_SWITCH(param.num_bits, NumBits, {
+        if (rows <= kWeightOnlyGemvMaxRows) {
+          WeightOnlyGemv<NumBits>(s,
+                                  data.dptr_,
+                                  qweight_ptr,
+                                  scale.dptr<SType>(),
+                                  bias,
+                                  out.dptr_,
+                                  rows,
+                                  channels,
+                                  in_features,
+                                  group_size);
+        } else {
+          // enough rows to reuse the weights from cache: dequantize them once for the GEMM
+          Tensor<xpu, 2, DType> wmat = ctx.requested[0].get_space_typed<xpu, 2, DType>(
+              Shape2(channels, in_features), s);
+          Kernel<weight_only_dequantize<NumBits>, xpu>::Launch(s,
+                                                               wmat.shape_.Size(),
+                                                               wmat.dptr_,
+                                                               qweight_ptr,
+                                                               scale.dptr<SType>(),
+                                                               in_features,
+                                                               group_size);
+          linalg_gemm(data, wmat, out, false, true, s);
+          if (!param.no_bias) {
+            AddBias(inputs[woq::kBias].get_with_shape<xpu, 1, DType>(Shape1(channels), s),
+                    data,
+                    out,
+                    s);
+          }
+        }
+      });
+    });
+  });
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_CONTRIB_WEIGHT_ONLY_FC_INL_H_
@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file weight_only_fc.cc
+ * \brief weight-only quantization of FullyConnected, CPU implementation
+ */
+#include "./weight_only_fc-inl.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(WeightOnlyQuantizeParam);
+DMLC_REGISTER_PARAMETER(WeightOnlyFCParam);
+
+NNVM_REGISTER_OP(_contrib_weight_only_quantize)
+    .add_alias("_npx_weight_only_quantize")
+    .describe(R"code(Quantize the weight of a FullyConnected layer for
+_contrib_weight_only_fully_connected.
+
+The weight of shape (num_hidden, input_dim) is split into groups of `group_size` consecutive
+input features of each output channel, each with a scale such that weight = quantized * scale.
+Returns the quantized weight, int8 of shape (num_hidden, input_dim) for 8 bits or two 4-bit
+values per uint8 of shape (num_hidden, input_dim / 2) for 4 bits, and the scales of shape
+(num_hidden, input_dim / group_size).
+)code" ADD_FILELINE)
+    .set_attr_parser(ParamParser<WeightOnlyQuantizeParam>)
+    .set_num_inputs(1)
+    .set_num_outputs(2)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"weight"};
+                                     })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"weight", "scale"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape", WeightOnlyQuantizeShape)
+    .set_attr<nnvm::FInferType>("FInferType", WeightOnlyQuantizeType)
+    .set_attr<FCompute>("FCompute<cpu>", WeightOnlyQuantizeForward<cpu>)
+    .add_argument("weight", "NDArray-or-Symbol", "Float weight, (num_hidden, input_dim).")
+    .add_arguments(WeightOnlyQuantizeParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_weight_only_fully_connected)
+    .add_alias("_npx_weight_only_fully_connected")
+    .describe(R"code(FullyConnected with weights quantized by _contrib_weight_only_quantize.
+
+out = dot(data, dequantized weight.T) + bias, computed in the type of the data. Only the
+weights are quantized: with a few rows of data, the layer is bound on the bandwidth of the
+weights, which shrinks by 2 or 4 times with 8 or 4 bits compared to float16 or float32. The
+weights are then dequantized while multiplying and never written back to memory. With more
+than 8 rows they are dequantized into a temporary buffer for a float GEMM.
+)code" ADD_FILELINE)
+    .set_attr_parser(ParamParser<WeightOnlyFCParam>)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      return nnvm::get<WeightOnlyFCParam>(attrs.parsed).no_bias ? 3 : 4;
+    })
+    .set_num_outputs(1)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          if (nnvm::get<WeightOnlyFCParam>(attrs.parsed).no_bias) {
+            return std::vector<std::string>{"data", "weight", "scale"};
+          }
+          return std::vector<std::string>{"data", "weight", "scale", "bias"};
+        })
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<mxnet::FInferShape>("FInferShape", WeightOnlyFCShape)
+    .set_attr<nnvm::FInferType>("FInferType", WeightOnlyFCType)
+    .set_attr<FCompute>("FCompute<cpu>", WeightOnlyFCForward<cpu>)
+    .add_argument("data", "NDArray-or-Symbol", "Input data, float32 or float16.")
+    .add_argument("weight", "NDArray-or-Symbol", "Quantized weight.")
+    .add_argument("scale", "NDArray-or-Symbol", "Scales of the groups of the weight.")
+    .add_argument("bias", "NDArray-or-Symbol", "Bias, in the type of the data.")
+    .add_arguments(WeightOnlyFCParam::__FIELDS__());
+
+}  // namespace op
+}  // namespace mxnet
@@ -28,11 +28,19 @@
 #if MXNET_USE_CUDNN == 1
 
 #include <dmlc/parameter.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif  // _WIN32
 
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <iomanip>
 #include <iterator>
 #include <limits>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -546,29 +554,216 @@ std::unordered_set<int64_t> ExcludeEngines(const std::string& env_var) {
                                      std::istream_iterator<int64_t>());
 }
 
-Descriptor SelectPlan(const OpContext& ctx,
-                      const ConvParam& param,
-                      Descriptor op,
-                      size_t n_fallbacks,
-                      const std::function<std::string()>& make_op_str,
-                      const std::vector<int64_t>& ids,
-                      const std::vector<void*>& tensor_ptrs,
-                      int64_t out_size,
-                      const std::string& excl_engines_var) {
-  auto s = ctx.get_stream<gpu>();
-  auto op_graph = MakeOpGraph(s->dnn_handle_, std::move(op));
+/*!
+ * \brief On-disk cache of the plans selected by auto-tuning, set by MXNET_CUDNN_AUTOTUNE_CACHE.
+ *
+ * The file holds one line per tuned op, its key and its plan separated by a tab. It is shared
+ * by the processes of a job: the tuning of a key is done under a lock of the key, so that the
+ * other processes wait for its plan instead of tuning it again.
+ */
+class AutotuneCache {
+ public:
+  static AutotuneCache* Get() {
+    static AutotuneCache inst;
+    return &inst;
+  }
 
-  int verbose = dmlc::GetEnv("MXNET_CUDNN_ALGO_VERBOSE_LEVEL", 0);
-  if (verbose > 0)
-    LOG(INFO) << "Selecting plan for " << make_op_str() << ":";
+  bool Enabled() const {
+    return fd_ >= 0;
+  }
 
-  auto tune = param.cudnn_tune ?
-                  param.cudnn_tune.value() :
-                  dmlc::GetEnv("MXNET_CUDNN_AUTOTUNE_DEFAULT", static_cast<int>(conv::kLimited));
+  /*! \brief Exclusive lock of a key, against the other threads and processes. */
+  class Lock {
+   public:
+    Lock(AutotuneCache* cache, const std::string& key) : cache_(cache), lk_(cache->mutex_) {
+      offset_ = kLockBase + std::hash<std::string>()(key) % kLockSlots;
+      cache_->LockRange(offset_, true);
+    }
+    ~Lock() {
+      cache_->LockRange(offset_, false);
+    }
+
+   private:
+    AutotuneCache* cache_;
+    std::unique_lock<std::mutex> lk_;
+    int64_t offset_;
+  };
+
+  /*! \brief Reads the file for the last plan stored for key. */
+  bool Find(const std::string& key, std::string* plan) const {
+    std::string contents;
+#ifndef _WIN32
+    char buf[4096];
+    ssize_t n;
+    for (off_t off = 0; (n = pread(fd_, buf, sizeof(buf), off)) > 0; off += n)
+      contents.append(buf, n);
+#endif  // _WIN32
+    std::istringstream ss(contents);
+    bool found = false;
+    for (std::string line; std::getline(ss, line);) {
+      auto tab = line.find('\t');
+      if (tab == std::string::npos || line.compare(0, tab, key) != 0)
+        continue;
+      *plan = line.substr(tab + 1);
+      found = true;
+    }
+    return found;
+  }
+
+  void Insert(const std::string& key, const std::string& plan) const {
+#ifndef _WIN32
+    auto line = key + '\t' + plan + '\n';
+    if (write(fd_, line.data(), line.size()) != static_cast<ssize_t>(line.size()))
+      LOG(WARNING) << "Failed to write the cuDNN autotune cache: " << strerror(errno);
+#endif  // _WIN32
+  }
+
+ private:
+  // The locks are taken on bytes past the end of the file, which they do not change.
+  static constexpr int64_t kLockBase = int64_t(1) << 40;
+  static constexpr size_t kLockSlots = 1 << 16;
+
+  AutotuneCache() {
+    auto path = dmlc::GetEnv("MXNET_CUDNN_AUTOTUNE_CACHE", std::string());
+    if (path.empty())
+      return;
+#ifndef _WIN32
+    // The descriptor stays open: closing any descriptor of the file releases its locks.
+    fd_ = open(path.c_str(), O_RDWR | O_APPEND | O_CREAT, 0644);
+    if (fd_ < 0)
+      LOG(WARNING) << "Cannot open the cuDNN autotune cache " << path << ": " << strerror(errno);
+#else
+    LOG(WARNING) << "MXNET_CUDNN_AUTOTUNE_CACHE is not supported on Windows";
+#endif  // _WIN32
+  }
+
+  void LockRange(int64_t offset, bool lock) {
+#ifndef _WIN32
+    struct flock fl = {};
+    fl.l_type       = lock ? F_WRLCK : F_UNLCK;
+    fl.l_whence     = SEEK_SET;
+    fl.l_start      = offset;
+    fl.l_len        = 1;
+    while (fcntl(fd_, F_SETLKW, &fl) == -1 && errno == EINTR) {
+    }
+#endif  // _WIN32
+  }
+
+  int fd_ = -1;
+  // fcntl locks are owned by the process, the threads are serialized by the mutex.
+  std::mutex mutex_;
+};
+
+/*! \brief Key of an op in the autotune cache, covering all that the selected plan depends on. */
+std::string AutotuneKey(const OpContext& ctx,
+                        const std::string& op_str,
+                        const std::vector<mxnet::TShape>& shapes,
+                        bool add_to,
+                        int tune,
+                        const std::string& excl_engines_var) {
+  cudaDeviceProp prop;
+  CUDA_CALL(cudaGetDeviceProperties(&prop, ctx.run_ctx.ctx.dev_id));
+  std::ostringstream ss;
+  ss << prop.name << " sm_" << prop.major << prop.minor << " cudnn " << cudnnGetVersion();
+  ss << " " << op_str;
+  for (const auto& shape : shapes)
+    ss << " " << shape;
+  ss << " add_to: " << add_to << " tune: " << tune << " excluded:";
+  for (auto note : ExcludeNumerics())
+    ss << " " << static_cast<int>(note);
+  ss << " " << dmlc::GetEnv(excl_engines_var.c_str(), std::string());
+  auto ret = ss.str();
+  std::replace(ret.begin(), ret.end(), '\t', ' ');
+  return ret;
+}
+
+/*! \brief The engine index and knob choices of a plan, as stored in the autotune cache. */
+std::string PlanEntry(const Descriptor& plan) {
+  auto cfg =
+      GetAttr(plan, CUDNN_ATTR_EXECUTION_PLAN_ENGINE_CONFIG, CUDNN_BACKEND_ENGINECFG_DESCRIPTOR);
+  auto engine = GetAttr(cfg, CUDNN_ATTR_ENGINECFG_ENGINE, CUDNN_BACKEND_ENGINE_DESCRIPTOR);
+  std::ostringstream ss;
+  ss << GetAttr<int64_t>(engine, CUDNN_ATTR_ENGINE_GLOBAL_INDEX);
+  auto choices = GetSomeAttrs(CUDNN_KNOB_TYPE_COUNTS,
+                              cfg,
+                              CUDNN_ATTR_ENGINECFG_KNOB_CHOICES,
+                              CUDNN_BACKEND_KNOB_CHOICE_DESCRIPTOR);
+  for (const auto& choice : choices) {
+    ss << " " << static_cast<int>(GetAttr<cudnnBackendKnobType_t>(choice,
+                                                                  CUDNN_ATTR_KNOB_CHOICE_KNOB_TYPE))
+       << "=" << GetAttr<int64_t>(choice, CUDNN_ATTR_KNOB_CHOICE_KNOB_VALUE);
+  }
+  return ss.str();
+}
+
+/*!
+ * \brief Builds the plan of an autotune cache entry for op_graph, or returns an empty
+ *  descriptor if the entry is malformed or cuDNN does not support it.
+ */
+Descriptor PlanFromEntry(cudnnHandle_t handle,
+                         const Descriptor& op_graph,
+                         const std::string& entry) {
+  std::istringstream ss(entry);
+  int64_t engine_idx;
+  if (!(ss >> engine_idx))
+    return Descriptor();
+  auto engine = cudnn_cxx::Make(CUDNN_BACKEND_ENGINE_DESCRIPTOR,
+                                CUDNN_ATTR_ENGINE_OPERATION_GRAPH,
+                                op_graph,
+                                CUDNN_ATTR_ENGINE_GLOBAL_INDEX,
+                                engine_idx);
+  if (cudnnBackendFinalize(engine.get()) != CUDNN_STATUS_SUCCESS)
+    return Descriptor();
+  std::vector<Descriptor> choices;
+  int type;
+  char eq;
+  int64_t value;
+  while (ss >> type >> eq >> value) {
+    if (eq != '=')
+      return Descriptor();
+    auto choice = cudnn_cxx::Make(CUDNN_BACKEND_KNOB_CHOICE_DESCRIPTOR,
+                                  CUDNN_ATTR_KNOB_CHOICE_KNOB_TYPE,
+                                  static_cast<cudnnBackendKnobType_t>(type),
+                                  CUDNN_ATTR_KNOB_CHOICE_KNOB_VALUE,
+                                  value);
+    if (cudnnBackendFinalize(choice.get()) != CUDNN_STATUS_SUCCESS)
+      return Descriptor();
+    choices.push_back(std::move(choice));
+  }
+  if (!ss.eof())
+    return Descriptor();
+  auto cfg = cudnn_cxx::Make(CUDNN_BACKEND_ENGINECFG_DESCRIPTOR,
+                             CUDNN_ATTR_ENGINECFG_ENGINE,
+                             engine,
+                             CUDNN_ATTR_ENGINECFG_KNOB_CHOICES,
+                             choices);
+  if (cudnnBackendFinalize(cfg.get()) != CUDNN_STATUS_SUCCESS)
+    return Descriptor();
+  auto plan = cudnn_cxx::Make(CUDNN_BACKEND_EXECUTION_PLAN_DESCRIPTOR,
+                              CUDNN_ATTR_EXECUTION_PLAN_HANDLE,
+                              handle,
+                              CUDNN_ATTR_EXECUTION_PLAN_ENGINE_CONFIG,
+                              cfg);
+  if (cudnnBackendFinalize(plan.get()) != CUDNN_STATUS_SUCCESS)
+    return Descriptor();
+  return plan;
+}
+
+Descriptor TunePlan(const OpContext& ctx,
+                    const ConvParam& param,
+                    const Descriptor& op_graph,
+                    size_t n_fallbacks,
+                    const std::function<std::string()>& make_op_str,
+                    const std::vector<int64_t>& ids,
+                    const std::vector<void*>& tensor_ptrs,
+                    int64_t out_size,
+                    const std::string& excl_engines_var,
+                    int tune,
+                    size_t workspace_limit,
+                    int verbose) {
+  auto s = ctx.get_stream<gpu>();
   size_t workspace_size = 0;
-  size_t workspace_limit =
-      tune != conv::kFastest ? param.workspace << 20 : std::numeric_limits<size_t>::max();
-  auto excl_engines = ExcludeEngines(excl_engines_var);
+  auto excl_engines     = ExcludeEngines(excl_engines_var);
   auto plans        = GetPlans(HeurMode(),
                         s->dnn_handle_,
                         op_graph,
@@ -595,6 +790,14 @@ Descriptor SelectPlan(const OpContext& ctx,
   //       alloc the workspace from the tempspace if its current size > workspace_size?
   auto workspace = AllocWorkspace(&plans, &workspace_size);
 
+  if (plans.empty() && n_fallbacks == 0) {
+    // fused graphs have no fallback engines, the caller runs the unfused ops instead
+    Storage::Get()->DirectFree(out_space);
+    Storage::Get()->DirectFree(workspace);
+    if (verbose > 0)
+      LOG(INFO) << " no engine";
+    return Descriptor();
+  }
   if (plans.empty()) {
     std::vector<int64_t> ixs(n_fallbacks);
     std::iota(ixs.begin(), ixs.end(), 0);
@@ -658,6 +861,88 @@ Descriptor SelectPlan(const OpContext& ctx,
   return std::move(top[0].plan);
 }
 
+Descriptor SelectPlan(const OpContext& ctx,
+                      const ConvParam& param,
+                      const std::vector<Descriptor>& ops,
+                      size_t n_fallbacks,
+                      const std::function<std::string()>& make_op_str,
+                      const std::vector<int64_t>& ids,
+                      const std::vector<void*>& tensor_ptrs,
+                      const std::vector<mxnet::TShape>& shapes,
+                      int64_t out_size,
+                      const std::string& excl_engines_var) {
+  auto s = ctx.get_stream<gpu>();
+  auto op_graph = MakeOpGraph(s->dnn_handle_, ops);
+
+  int verbose = dmlc::GetEnv("MXNET_CUDNN_ALGO_VERBOSE_LEVEL", 0);
+  if (verbose > 0)
+    LOG(INFO) << "Selecting plan for " << make_op_str() << ":";
+
+  auto tune = param.cudnn_tune ?
+                  param.cudnn_tune.value() :
+                  dmlc::GetEnv("MXNET_CUDNN_AUTOTUNE_DEFAULT", static_cast<int>(conv::kLimited));
+  size_t workspace_limit =
+      tune != conv::kFastest ? param.workspace << 20 : std::numeric_limits<size_t>::max();
+  auto tune_plan = [&]() {
+    return TunePlan(ctx,
+                    param,
+                    op_graph,
+                    n_fallbacks,
+                    make_op_str,
+                    ids,
+                    tensor_ptrs,
+                    out_size,
+                    excl_engines_var,
+                    tune,
+                    workspace_limit,
+                    verbose);
+  };
+  auto cache = AutotuneCache::Get();
+  if (tune == conv::kOff || !cache->Enabled())
+    return tune_plan();
+
+  auto key = AutotuneKey(ctx, make_op_str(), shapes, param.add_to, tune, excl_engines_var);
+  AutotuneCache::Lock lock(cache, key);
+  std::string entry;
+  if (cache->Find(key, &entry)) {
+    auto plan = PlanFromEntry(s->dnn_handle_, op_graph, entry);
+    if (plan && GetWorkspace(plan) <= workspace_limit) {
+      if (verbose > 0)
+        LOG(INFO) << " cached: " << PlanStr(plan);
+      return plan;
+    }
+    LOG(WARNING) << "Ignoring the unusable cached plan of " << make_op_str();
+  }
+  auto plan = tune_plan();
+  if (plan)
+    cache->Insert(key, PlanEntry(plan));
+  return plan;
+}
+
+Descriptor SelectPlan(const OpContext& ctx,
+                      const ConvParam& param,
+                      Descriptor op,
+                      size_t n_fallbacks,
+                      const std::function<std::string()>& make_op_str,
+                      const std::vector<int64_t>& ids,
+                      const std::vector<void*>& tensor_ptrs,
+                      const std::vector<mxnet::TShape>& shapes,
+                      int64_t out_size,
+                      const std::string& excl_engines_var) {
+  std::vector<Descriptor> ops;
+  ops.push_back(std::move(op));
+  return SelectPlan(ctx,
+                    param,
+                    ops,
+                    n_fallbacks,
+                    make_op_str,
+                    ids,
+                    tensor_ptrs,
+                    shapes,
+                    out_size,
+                    excl_engines_var);
+}
+
 size_t Size(const TBlob& t) {
   return t.Size() * mshadow::mshadow_sizeof(t.type_flag_);
 }
@@ -688,6 +973,7 @@ cudnn_cxx::Descriptor Conv::Make(const OpContext& ctx,
                     make_op_str,
                     ids,
                     ptrs,
+                    {x.shape_, w.shape_, y.shape_},
                     Size(y),
                     "MXNET_CUDNN_DISABLED_CONV_FWD_ENGINES");
 }
@@ -712,7 +998,7 @@ void Conv::Exec(const cudnn_cxx::Descriptor& plan,
                 const TBlob& y) {
   auto s              = ctx.get_stream<gpu>();
   auto workspace_size = GetAttr<int64_t>(plan, CUDNN_ATTR_EXECUTION_PLAN_WORKSPACE_SIZE);
-  auto workspace      = ctx.requested[0].get_space_internal(workspace_size, "Conv");
+  auto workspace      = ctx.requested[0].get_space_internal(workspace_size, "Conv", s);
 
   std::vector<int64_t> ids{ID_X, ID_W, ID_Y};
   std::vector<void*> ptrs{x.dptr_, w.dptr_, y.dptr_};
@@ -749,6 +1035,7 @@ cudnn_cxx::Descriptor ConvDgrad::Make(const OpContext& ctx,
                     make_op_str,
                     ids,
                     ptrs,
+                    {w.shape_, dy.shape_, dx.shape_},
                     Size(dx),
                     "MXNET_CUDNN_DISABLED_CONV_DGRAD_ENGINES");
 }
@@ -773,7 +1060,7 @@ void ConvDgrad::Exec(const cudnn_cxx::Descriptor& plan,
                      const TBlob& dx) {
   auto s              = ctx.get_stream<gpu>();
   auto workspace_size = GetAttr<int64_t>(plan, CUDNN_ATTR_EXECUTION_PLAN_WORKSPACE_SIZE);
-  auto workspace      = ctx.requested[0].get_space_internal(workspace_size, "ConvDgrad");
+  auto workspace      = ctx.requested[0].get_space_internal(workspace_size, "ConvDgrad", s);
 
   std::vector<int64_t> ids{ID_W, ID_DY, ID_DX};
   std::vector<void*> ptrs{w.dptr_, dy.dptr_, dx.dptr_};
@@ -810,6 +1097,7 @@ cudnn_cxx::Descriptor ConvWgrad::Make(const OpContext& ctx,
                     make_op_str,
                     ids,
                     ptrs,
+                    {x.shape_, dy.shape_, dw.shape_},
                     Size(dw),
                     "MXNET_CUDNN_DISABLED_CONV_WGRAD_ENGINES");
 }
@@ -834,7 +1122,7 @@ void ConvWgrad::Exec(const cudnn_cxx::Descriptor& plan,
                      const TBlob& dw) {
   auto s              = ctx.get_stream<gpu>();
   auto workspace_size = GetAttr<int64_t>(plan, CUDNN_ATTR_EXECUTION_PLAN_WORKSPACE_SIZE);
-  auto workspace      = ctx.requested[0].get_space_internal(workspace_size, "ConvWgrad");
+  auto workspace      = ctx.requested[0].get_space_internal(workspace_size, "ConvWgrad", s);
 
   std::vector<int64_t> ids{ID_X, ID_DY, ID_DW};
   std::vector<void*> ptrs{x.dptr_, dy.dptr_, dw.dptr_};
@@ -848,6 +1136,155 @@ void ConvWgrad::Exec(const cudnn_cxx::Descriptor& plan,
   CUDNN_CALL(cudnnBackendExecute(s->dnn_handle_, plan.get(), var_pack.get()));
 }
 
+Descriptor MakePointwiseOp(cudnnPointwiseMode_t mode,
+                           const Descriptor& x,
+                           const Descriptor* b,
+                           const Descriptor& y) {
+  auto pw =
+      MakeFinalized(CUDNN_BACKEND_POINTWISE_DESCRIPTOR,
+                    CUDNN_ATTR_POINTWISE_MODE,
+                    mode,
+                    CUDNN_ATTR_POINTWISE_MATH_PREC,
+                    CUDNN_DATA_FLOAT);
+  auto ret = Make(CUDNN_BACKEND_OPERATION_POINTWISE_DESCRIPTOR,
+                  CUDNN_ATTR_OPERATION_POINTWISE_PW_DESCRIPTOR,
+                  pw,
+                  CUDNN_ATTR_OPERATION_POINTWISE_XDESC,
+                  x,
+                  CUDNN_ATTR_OPERATION_POINTWISE_YDESC,
+                  y);
+  if (b)
+    SetAttr(ret, CUDNN_ATTR_OPERATION_POINTWISE_BDESC, *b);
+  CUDNN_CALL(cudnnBackendFinalize(ret.get()));
+  return ret;
+}
+
+std::vector<Descriptor> ConvBiasAddRelu::MakeOps(const OpContext& ctx,
+                                                 const Param& param,
+                                                 const TBlob& x,
+                                                 const TBlob& w,
+                                                 const TBlob& b,
+                                                 const TBlob& z,
+                                                 const TBlob& y) {
+  auto dtype  = static_cast<mshadow::TypeFlag>(x.type_flag_);
+  auto conv   = MakeConvDesc(param.conv, dtype);
+  auto li     = GetLayoutInfo(static_cast<mshadow::LayoutFlag>(param.conv.layout.value()));
+  auto x_desc = MakeTensorDesc(ID_X, x, li, true, false);
+  auto w_desc = MakeTensorDesc(ID_W, w, li, true, false);
+  auto y_desc = MakeTensorDesc(ID_Y, y, li, true, false);
+  // the intermediate results stay in float32 registers
+  auto virtual_desc = [&](int64_t uid) {
+    TBlob v(nullptr, y.shape_, y.dev_mask(), mshadow::kFloat32, y.dev_id());
+    return MakeTensorDesc(uid, v, li, true, true);
+  };
+  // the bias broadcasts over all the dims but the channel one, expanded as x for 1D
+  std::vector<int64_t> b_dims(li.n_space_dims + 2, 1);
+  b_dims[1]      = b.shape_[0];
+  auto b_strides = li.Strides(b_dims);
+  li.ExpandIf1d(&b_dims, &b_strides);
+  auto b_desc = MakeTensorDesc(
+      ID_B, CudnnType(static_cast<mshadow::TypeFlag>(b.type_flag_)), b_dims, b_strides, false);
+
+  const bool bias_last = !param.with_add && !param.with_relu;
+  const bool add_last  = param.with_add && !param.with_relu;
+  std::vector<Descriptor> ops;
+  auto conv_y = virtual_desc(ID_CONV_Y);
+  ops.push_back(cudnn::MakeConvFwdOp(conv, x_desc, w_desc, conv_y, false));
+  auto bias_y = bias_last ? std::move(y_desc) : virtual_desc(ID_BIAS_Y);
+  ops.push_back(MakePointwiseOp(CUDNN_POINTWISE_ADD, conv_y, &b_desc, bias_y));
+  if (param.with_add) {
+    auto z_desc = MakeTensorDesc(ID_Z, z, li, true, false);
+    auto add_y  = add_last ? std::move(y_desc) : virtual_desc(ID_ADD_Y);
+    ops.push_back(MakePointwiseOp(CUDNN_POINTWISE_ADD, bias_y, &z_desc, add_y));
+    bias_y = std::move(add_y);
+  }
+  if (param.with_relu)
+    ops.push_back(MakePointwiseOp(CUDNN_POINTWISE_RELU_FWD, bias_y, nullptr, y_desc));
+  return ops;
+}
+
+cudnn_cxx::Descriptor ConvBiasAddRelu::Make(const OpContext& ctx,
+                                            const Param& param,
+                                            const TBlob& x,
+                                            const TBlob& w,
+                                            const TBlob& b,
+                                            const TBlob& z,
+                                            const TBlob& y) {
+  auto ops = MakeOps(ctx, param, x, w, b, z, y);
+
+  auto make_op_str = [&param, &x]() {
+    std::ostringstream ss;
+    ss << "fused fprop " << mshadow::dtype_string(x.type_flag_) << " "
+       << ConvParamStr(param.conv) << (param.with_add ? " add" : "")
+       << (param.with_relu ? " relu" : "");
+    return ss.str();
+  };
+
+  std::vector<int64_t> ids{ID_X, ID_W, ID_B, ID_Y};
+  std::vector<void*> ptrs{x.dptr_, w.dptr_, b.dptr_, y.dptr_};
+  std::vector<mxnet::TShape> shapes{x.shape_, w.shape_, b.shape_, y.shape_};
+  if (param.with_add) {
+    ids.insert(ids.end() - 1, ID_Z);
+    ptrs.insert(ptrs.end() - 1, z.dptr_);
+    shapes.insert(shapes.end() - 1, z.shape_);
+  }
+
+  return SelectPlan(ctx,
+                    param.conv,
+                    ops,
+                    0,
+                    make_op_str,
+                    ids,
+                    ptrs,
+                    shapes,
+                    Size(y),
+                    "MXNET_CUDNN_DISABLED_CONV_FWD_ENGINES");
+}
+
+cudnn_cxx::Descriptor ConvBiasAddRelu::Clone(const cudnn_cxx::Descriptor& plan,
+                                             const OpContext& ctx,
+                                             const Param& param,
+                                             const TBlob& x,
+                                             const TBlob& w,
+                                             const TBlob& b,
+                                             const TBlob& z,
+                                             const TBlob& y) {
+  if (!plan)
+    return Descriptor();
+  auto ops         = MakeOps(ctx, param, x, w, b, z, y);
+  auto handle      = ctx.get_stream<gpu>()->dnn_handle_;
+  auto op_graph    = MakeOpGraph(handle, ops);
+  auto cloned_plan = ClonePlan(handle, std::move(op_graph), plan);
+  return cloned_plan;
+}
+
+void ConvBiasAddRelu::Exec(const cudnn_cxx::Descriptor& plan,
+                           const OpContext& ctx,
+                           const TBlob& x,
+                           const TBlob& w,
+                           const TBlob& b,
+                           const TBlob& z,
+                           const TBlob& y) {
+  auto s              = ctx.get_stream<gpu>();
+  auto workspace_size = GetAttr<int64_t>(plan, CUDNN_ATTR_EXECUTION_PLAN_WORKSPACE_SIZE);
+  auto workspace      = ctx.requested[0].get_space_internal(workspace_size, "ConvBiasAddRelu", s);
+
+  std::vector<int64_t> ids{ID_X, ID_W, ID_B, ID_Y};
+  std::vector<void*> ptrs{x.dptr_, w.dptr_, b.dptr_, y.dptr_};
+  if (z.dptr_) {
+    ids.push_back(ID_Z);
+    ptrs.push_back(z.dptr_);
+  }
+  auto var_pack = MakeFinalized(CUDNN_BACKEND_VARIANT_PACK_DESCRIPTOR,
+                                CUDNN_ATTR_VARIANT_PACK_UNIQUE_IDS,
+                                ids,
+                                CUDNN_ATTR_VARIANT_PACK_DATA_POINTERS,
+                                ptrs,
+                                CUDNN_ATTR_VARIANT_PACK_WORKSPACE,
+                                workspace);
+  CUDNN_CALL(cudnnBackendExecute(s->dnn_handle_, plan.get(), var_pack.get()));
+}
+
 struct LegacyTensorDestroyer {
   using pointer = cudnnTensorDescriptor_t;
 
@@ -142,12 +142,14 @@ bool Exec(const OpContext& ctx, const typename Op::Param& param, Args&&... args)
   auto match_it = [&]() {
     // Some cuDNN Op implementations require that the thread's cuDNN handle
     // (used in cudnnBackendExecute()) matches the one used in making the plan.
+    // An empty Op, for which no plan was found, matches any handle.
     const bool ignore_handles = false;
     auto range                = op_map.equal_range(key);
     auto handle               = ctx.get_stream<gpu>()->dnn_handle_;
     for (auto it = range.first; it != range.second; ++it) {
-      if (ignore_handles || handle == cudnn_cxx::GetAttr<cudnnHandle_t>(
-                                          it->second, CUDNN_ATTR_EXECUTION_PLAN_HANDLE)) {
+      if (ignore_handles || !it->second ||
+          handle == cudnn_cxx::GetAttr<cudnnHandle_t>(it->second,
+                                                      CUDNN_ATTR_EXECUTION_PLAN_HANDLE)) {
         return it;
       }
     }
@@ -327,6 +329,78 @@ struct ConvWgrad {
                                                const TBlob& dw);
 };
 
+// A convolution followed by its epilogue, y = relu(conv(x, w) + b + z), where the residual z
+// and the ReLU are optional. The epilogue is fused into the convolution by cuDNN runtime fusion,
+// so Exec() returns false when cuDNN has no engine for the fused graph.
+struct ConvBiasAddReluParam {
+  ConvParam conv;
+  bool with_add;
+  bool with_relu;
+};
+
+struct ConvBiasAddRelu {
+  using Param = ConvBiasAddReluParam;
+  enum UIDs { ID_X = 1, ID_W, ID_B, ID_Z, ID_Y, ID_CONV_Y, ID_BIAS_Y, ID_ADD_Y };
+
+  static auto MakeKey(const Param& p,
+                      const TBlob& x,
+                      const TBlob& w,
+                      const TBlob& b,
+                      const TBlob& z,
+                      const TBlob& y) {
+    return std::make_tuple(p.conv.kernel,
+                           p.conv.stride,
+                           p.conv.dilate,
+                           p.conv.pad,
+                           p.conv.num_filter,
+                           p.conv.num_group,
+                           p.conv.workspace,
+                           p.conv.layout,
+                           p.with_add,
+                           p.with_relu,
+                           x.shape_,
+                           x.type_flag_,
+                           w.shape_,
+                           w.type_flag_,
+                           b.type_flag_,
+                           y.shape_);
+  }
+
+  static cudnn_cxx::Descriptor Make(const OpContext& ctx,
+                                    const Param& param,
+                                    const TBlob& x,
+                                    const TBlob& w,
+                                    const TBlob& b,
+                                    const TBlob& z,
+                                    const TBlob& y);
+
+  static cudnn_cxx::Descriptor Clone(const cudnn_cxx::Descriptor& plan,
+                                     const OpContext& ctx,
+                                     const Param& param,
+                                     const TBlob& x,
+                                     const TBlob& w,
+                                     const TBlob& b,
+                                     const TBlob& z,
+                                     const TBlob& y);
+
+  static void Exec(const cudnn_cxx::Descriptor& plan,
+                   const OpContext& ctx,
+                   const TBlob& x,
+                   const TBlob& w,
+                   const TBlob& b,
+                   const TBlob& z,
+                   const TBlob& y);
+
+ private:
+  static std::vector<cudnn_cxx::Descriptor> MakeOps(const OpContext& ctx,
+                                                    const Param& param,
+                                                    const TBlob& x,
+                                                    const TBlob& w,
+                                                    const TBlob& b,
+                                                    const TBlob& z,
+                                                    const TBlob& y);
+};
+
 bool LegacyAddBias(const OpContext& ctx, const LayoutInfo& li, const TBlob& y, const TBlob& b);
 
 bool LegacyBiasGrad(const OpContext& ctx,
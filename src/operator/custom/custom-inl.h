@@ -72,6 +72,8 @@ class CustomOperator {
   // inputs and outputs unlike the dense case. Passing vector of inputs and
   // outputs ndarrays as args and updating the inputs and outputs ndarray
   // chunk pointers to be same as the copied ndarrays.
+  // With run_on_engine, func runs right away on the calling engine thread instead of being
+  // queued for a worker thread, for the operators which never wait for an NDArray.
   template <typename Func>
   void Push(const Func& func,
             const OpContext& ctx,
@@ -81,7 +83,8 @@ class CustomOperator {
             const std::vector<int>& tags,
             const std::unordered_set<int>& output_tags,
             const std::vector<NDArray>& outputs,
-            const std::string op_type = "") {
+            const std::string op_type = "",
+            bool run_on_engine        = false) {
     if (naive_engine_) {
       if (profiler::Profiler::Get()->IsProfiling(profiler::Profiler::kImperative)) {
         profiler::CustomOpProfiler::Get()->OnCustomBegin(op_type);
@@ -102,8 +105,7 @@ class CustomOperator {
       ctx.async_on_complete();
       return;
     }
-    std::unique_lock<std::mutex> lock(mutex_);
-    q_.push([=]() mutable {
+    auto task = [=]() mutable {
       bool prev_recording = Imperative::Get()->set_is_recording(recording);
       bool prev_training  = Imperative::Get()->set_is_training(training);
 
@@ -164,11 +166,18 @@ class CustomOperator {
           FnProperty::kNoSkip,
           0,
           "CustomOperatorWait");
-    });
+    };
+    if (run_on_engine) {
+      task();
+      return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    q_.push(std::move(task));
     // increase num_threads if there is not enough threads to execute custom operator
     if (q_.size() > num_free_threads_)
       CreateThreads(q_.size() - num_free_threads_);
-    cv_.notify_all();
+    // one task wakes one worker, the others would only contend on the lock and the GIL
+    cv_.notify_one();
   }
 
   static CustomOperator* Get() {
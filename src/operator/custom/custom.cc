@@ -36,6 +36,8 @@ namespace custom {
 struct CustomParam {
   std::string op_type;
   size_t num_args, num_outs, num_auxs;
+  // whether forward and backward run on the engine thread instead of a worker
+  bool run_on_engine{false};
   std::vector<int> bwd_idx;
   std::shared_ptr<MXCallbackList> info;
 };
@@ -118,6 +120,14 @@ void AttrParser(NodeAttrs* attrs) {
       &rdeps,
       params.info->contexts[kCustomOpPropDeclareBackwardDependency]));
   params.bwd_idx.insert(params.bwd_idx.end(), rdeps, rdeps + num_dep);
+
+  if (params.info->num_callbacks > kCustomOpPropRunOnEngine) {
+    int run_on_engine = 0;
+    CHECK(reinterpret_cast<CustomOpRunOnEngineFunc>(
+        params.info->callbacks[kCustomOpPropRunOnEngine])(
+        &run_on_engine, params.info->contexts[kCustomOpPropRunOnEngine]));
+    params.run_on_engine = run_on_engine != 0;
+  }
 }
 
 bool InferShape(const NodeAttrs& attrs,
@@ -346,7 +356,8 @@ void ForwardEx(const OpStatePtr& state,
       tags,
       output_tags,
       outputs,
-      params.op_type);
+      params.op_type,
+      params.run_on_engine);
 }
 
 void BackwardEx(const OpStatePtr& state,
@@ -427,7 +438,8 @@ void BackwardEx(const OpStatePtr& state,
       tags,
       output_tags,
       outputs,
-      "_backward_" + params.op_type);
+      "_backward_" + params.op_type,
+      params.run_on_engine);
 }
 
 // infer storage backward function for custom op which assigns kDefaultStorage for
@@ -568,6 +580,7 @@ Please check the tutorial here: https://mxnet.incubator.apache.org/api/faq/new_o
       return params.num_outs;
     })
     .set_attr_parser(AttrParser)
+    .set_attr<TAttrParserNoCache>("TAttrParserNoCache", true)
     .set_attr<mxnet::FInferShape>("FInferShape", InferShape)
     .set_attr<nnvm::FInferType>("FInferType", InferType)
     .set_attr<nnvm::FListInputNames>("FListInputNames",
@@ -25,6 +25,7 @@
 #include "./operator_common.h"
 #include "./nn/im2col.h"
 #include "./contrib/nn/deformable_im2col.h"
+#include "./contrib/nn/deformable_conv_implicit_gemm.h"
 #include "./linalg.h"
 
 namespace mxnet {
@@ -105,55 +106,24 @@ class DeformableConvolutionOp : public Operator {
     LayerSetUp(
         in_data[conv::kData].shape_, in_data[conv::kOffset].shape_, out_data[conv::kOut].shape_);
     Stream<xpu>* s = ctx.get_stream<xpu>();
-    // allocate workspace for col_buffer
-    Tensor<xpu, 1, DType> workspace =
-        ctx.requested[conv::kTempSpace].get_space_typed<xpu, 1, DType>(Shape1(col_buffer_size_), s);
-    // calculate the shape of col_buffer
-    mxnet::TShape col_buffer_shape(num_spatial_axes_ + 1, -1);
-    col_buffer_shape[0] = conv_in_channels_ * param_.kernel.Size();
-    for (int i = 1; i < col_buffer_shape.ndim(); ++i) {
-      col_buffer_shape[i] = out_data[0].shape_[i + 1];
-    }
-    // create a column buffer using workspace and col_buffer_shape
-    TBlob col_buffer(workspace.dptr_, col_buffer_shape, xpu::kDevMask, DataType<DType>::kFlag);
-
-    // initialize weight and col_buffer 3D tensors for using gemm
-    index_t M = conv_out_channels_ / group_;
-    index_t N = conv_out_spatial_dim_;
-    index_t K = kernel_dim_;
-    Tensor<xpu, 3, DType> weight_3d =
-        in_data[conv::kWeight].get_with_shape<xpu, 3, DType>(Shape3(group_, M, K), s);
-    Tensor<xpu, 3, DType> col_buffer_3d =
-        col_buffer.get_with_shape<xpu, 3, DType>(Shape3(group_, K, N), s);
-    Tensor<xpu, 4, DType> output_4d =
-        out_data[conv::kOut].get_with_shape<xpu, 4, DType>(Shape4(num_, group_, M, N), s);
-    for (index_t n = 0; n < num_; ++n) {
-      // transform image to col_buffer in order to use gemm
-      deformable_im2col(s,
-                        in_data[conv::kData].dptr<DType>() + n * input_dim_,
-                        in_data[conv::kOffset].dptr<DType>() + n * input_offset_dim_,
-                        in_data[conv::kData].shape_,
-                        col_buffer.shape_,
-                        param_.kernel,
-                        param_.pad,
-                        param_.stride,
-                        param_.dilate,
-                        param_.num_deformable_group,
-                        col_buffer.dptr<DType>());
-      Tensor<xpu, 3, DType> output_3d = output_4d[n];
-      for (index_t g = 0; g < group_; ++g) {
-        // Legacy approach shown here for comparison:
-        //   Assign(output_3d[g], req[conv::kOut], dot(weight_3d[g], col_buffer_3d[g]));
-        linalg_gemm(weight_3d[g], col_buffer_3d[g], output_3d[g], false, false, s, req[conv::kOut]);
-      }
-    }
-    if (bias_term_) {
-      Tensor<xpu, 1, DType> bias      = in_data[conv::kBias].get<xpu, 1, DType>(s);
-      Tensor<xpu, 3, DType> output_3d = out_data[conv::kOut].get_with_shape<xpu, 3, DType>(
-          Shape3(num_, conv_out_channels_, conv_out_spatial_dim_), s);
-      // has bias term, broadcast it to the same shape of output_3d in channel dim
-      output_3d += mshadow::expr::broadcast<1>(bias, output_3d.shape_);
-    }
+    // the im2col matrix is sampled tile by tile within the GEMM, so that no workspace is needed
+    const DeformableConvGeometry geo(in_data[conv::kData].shape_,
+                                     out_data[conv::kOut].shape_,
+                                     param_.kernel,
+                                     param_.pad,
+                                     param_.stride,
+                                     param_.dilate,
+                                     group_,
+                                     param_.num_deformable_group);
+    deformable_conv_implicit_gemm<false>(
+        s,
+        geo,
+        in_data[conv::kData].dptr<DType>(),
+        in_data[conv::kOffset].dptr<DType>(),
+        static_cast<const DType*>(nullptr),
+        in_data[conv::kWeight].dptr<DType>(),
+        bias_term_ ? in_data[conv::kBias].dptr<DType>() : nullptr,
+        out_data[conv::kOut].dptr<DType>());
   }
 
   virtual void Backward(const OpContext& ctx,
@@ -203,6 +203,27 @@ inline bool ElemwiseChangeLayout(nnvm::NodeAttrs* attrs,
                                  std::vector<alm::Transpose>* inpTransposes,
                                  std::vector<alm::Transpose>* outTransposes) {
   CHECK_EQ(targetLayout, mshadow::kUNKNOWN);
+  outTransposes->assign(attrs->op->num_outputs, alm::FactorCommonTransposeAll(inpTransposes));
+  return false;
+}
+
+/*!
+ * \brief FChangeLayout of the broadcasting operators, whose inputs may have different ranks.
+ * The layout only changes when all inputs have a pending transpose of the same rank, e.g. both
+ * sides of a residual addition.
+ */
+inline bool BroadcastChangeLayout(nnvm::NodeAttrs* attrs,
+                                  mshadow::LayoutFlag targetLayout,
+                                  std::vector<alm::Transpose>* inpTransposes,
+                                  std::vector<alm::Transpose>* outTransposes) {
+  CHECK_EQ(targetLayout, mshadow::kUNKNOWN);
+  const size_t ndim = inpTransposes->at(0).size();
+  for (const auto& t : *inpTransposes) {
+    if (alm::IsIdentity(t) || t.size() != ndim) {
+      outTransposes->assign(attrs->op->num_outputs, alm::Transpose());
+      return false;
+    }
+  }
   outTransposes->assign(attrs->op->num_outputs, alm::FactorCommonTranspose(inpTransposes));
   return false;
 }
@@ -17,14 +17,16 @@
  * under the License.
  */
 
+#include <algorithm>
+#include <cstring>
 #include <tuple>
+#include <utility>
 
 #include "./fused_op.h"
+#include "../mxnet_op.h"
 #include "../operator_common.h"
 #include "../../imperative/exec_pass.h"
 
-#if MXNET_USE_CUDA
-
 namespace mxnet {
 
 DMLC_REGISTER_PARAMETER(FusedOpConfig);
@@ -170,6 +172,181 @@ std::tuple<const nnvm::ObjectPtr, std::vector<Attr>, std::vector<Attr>> FusedOp:
   return std::make_tuple(node.weak_ref.lock(), inputs, outputs);
 }
 
+namespace {
+
+/*! \brief elements of one tile of a fused elementwise subgraph on CPU */
+inline size_t CPUFusedTileSize(size_t bytes_per_element) {
+  // keep the tile buffers of all entries within the L2 cache of a core
+  static const size_t tile_bytes = dmlc::GetEnv("MXNET_CPU_FUSION_TILE_BYTES", size_t{256} << 10);
+  const size_t tile              = tile_bytes / std::max<size_t>(bytes_per_element, 1);
+  return std::max<size_t>(tile / 64 * 64, 64);
+}
+
+inline size_t AlignCacheLine(size_t bytes) {
+  return (bytes + 63) / 64 * 64;
+}
+
+}  // namespace
+
+/*!
+ * \brief Run the subgraph with the CPU kernels of its nodes. When all entries have the
+ *  same number of elements the subgraph is elementwise, so it is run over flattened tiles
+ *  small enough for the intermediate results to stay in cache and the fused inputs and
+ *  outputs are read and written once. Tiles are distributed over the OpenMP threads.
+ */
+template <>
+void FusedOp::Forward<cpu>(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<TBlob>& outputs) {
+  static const auto& fcompute = Op::GetAttr<FCompute>("FCompute<cpu>");
+  std::lock_guard<std::mutex> lock(my_mutex_);
+  CHECK_EQ(inputs.size(), inputs_.size());
+  CHECK_EQ(outputs.size(), outputs_.size());
+
+  std::vector<mxnet::TShape> in_shapes, out_shapes;
+  std::vector<int> in_dtypes, out_dtypes;
+  for (const auto& blob : inputs) {
+    in_shapes.push_back(blob.shape_);
+    in_dtypes.push_back(blob.type_flag_);
+  }
+  for (const auto& blob : outputs) {
+    out_shapes.push_back(blob.shape_);
+    out_dtypes.push_back(blob.type_flag_);
+  }
+  auto select = [](auto* intermediate, const auto& in_attr, const auto& out_attr) {
+    for (auto it = intermediate->begin(); it != intermediate->end(); ++it) {
+      if (it->input_attr == in_attr && it->output_attr == out_attr) {
+        intermediate->erase(intermediate->begin(), it);
+        break;
+      }
+    }
+    CHECK(!intermediate->empty()) << "Fused op has no inferred attributes";
+    return intermediate->front().internal_attr;
+  };
+  const mxnet::ShapeVector node_shapes = select(&intermediate_shapes_, in_shapes, out_shapes);
+  const nnvm::DTypeVector node_dtypes  = select(&intermediate_dtypes_, in_dtypes, out_dtypes);
+
+  const auto& g            = subgraph_.indexed_graph();
+  const auto& input_nids   = g.input_nodes();
+  const size_t num_entries = g.num_node_entries();
+  const size_t N           = node_shapes[g.entry_id(g.outputs()[0])].Size();
+  bool tiled               = N > 0;
+  for (const auto& shape : node_shapes)
+    tiled = tiled && shape.Size() == N;
+
+  std::vector<FCompute> kernels(g.num_nodes());
+  for (uint32_t nid = 0; nid < g.num_nodes(); ++nid) {
+    const nnvm::Node* node = g[nid].source;
+    if (node->is_variable())
+      continue;
+    kernels[nid] = fcompute.get(node->op(), nullptr);
+    CHECK(kernels[nid] != nullptr) << "Operator " << node->op()->name
+                                   << " cannot be fused on CPU, it has no FCompute<cpu>";
+  }
+
+  // entries read from the fused op inputs or written directly to its outputs
+  std::vector<void*> external(num_entries, nullptr);
+  for (size_t i = 0; i < input_nids.size(); ++i)
+    external[g.entry_id(input_nids[i], 0)] = inputs[i].dptr_;
+  auto overlaps_input = [&inputs](const TBlob& out) {
+    const char* begin = static_cast<const char*>(out.dptr_);
+    const char* end   = begin + out.Size() * mshadow::mshadow_sizeof(out.type_flag_);
+    for (const auto& in : inputs) {
+      const char* in_begin = static_cast<const char*>(in.dptr_);
+      const char* in_end   = in_begin + in.Size() * mshadow::mshadow_sizeof(in.type_flag_);
+      if (begin < in_end && in_begin < end)
+        return true;
+    }
+    return false;
+  };
+  // outputs computed in the workspace first, because they are accumulated or alias an input
+  // which later nodes still read
+  std::vector<std::pair<uint32_t, size_t>> staged_outputs;
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    const uint32_t eid = g.entry_id(g.outputs()[i]);
+    if (req[i] == kNullOp)
+      continue;
+    if (req[i] != kAddTo && !overlaps_input(outputs[i])) {
+      external[eid] = outputs[i].dptr_;
+    } else {
+      staged_outputs.emplace_back(eid, i);
+    }
+  }
+
+  // every other entry gets a slot of the workspace of each thread
+  size_t bytes_per_element = 0;
+  for (size_t eid = 0; eid < num_entries; ++eid) {
+    if (external[eid] == nullptr)
+      bytes_per_element += mshadow::mshadow_sizeof(node_dtypes[eid]);
+  }
+  const size_t tile   = tiled ? std::min(CPUFusedTileSize(bytes_per_element), N) : 0;
+  const int num_tiles = tiled ? static_cast<int>((N + tile - 1) / tile) : 1;
+  const int omp_threads =
+      std::min(num_tiles, engine::OpenMP::Get()->GetRecommendedOMPThreadCount());
+  std::vector<size_t> slot_offset(num_entries, 0);
+  size_t thread_bytes = 0;
+  for (size_t eid = 0; eid < num_entries; ++eid) {
+    if (external[eid] != nullptr)
+      continue;
+    const size_t elements = tiled ? tile : node_shapes[eid].Size();
+    slot_offset[eid]      = thread_bytes;
+    thread_bytes += AlignCacheLine(elements * mshadow::mshadow_sizeof(node_dtypes[eid]));
+  }
+  if (cpu_workspace_.size() < thread_bytes * omp_threads + 64)
+    cpu_workspace_.resize(thread_bytes * omp_threads + 64);
+  uint8_t* workspace = reinterpret_cast<uint8_t*>(
+      AlignCacheLine(reinterpret_cast<size_t>(cpu_workspace_.data())));
+
+  auto run_tile = [&](int tile_id, uint8_t* slots) {
+    const size_t begin = tiled ? tile_id * tile : 0;
+    const size_t len   = tiled ? std::min(tile, N - begin) : 0;
+    auto blob          = [&](uint32_t eid) {
+      const int dtype            = node_dtypes[eid];
+      const mxnet::TShape& shape = tiled ? mxnet::TShape(1, len) : node_shapes[eid];
+      void* dptr                 = slots + slot_offset[eid];
+      if (external[eid] != nullptr)
+        dptr = static_cast<uint8_t*>(external[eid]) + begin * mshadow::mshadow_sizeof(dtype);
+      return TBlob(dptr, shape, cpu::kDevMask, dtype);
+    };
+    for (uint32_t nid = 0; nid < g.num_nodes(); ++nid) {
+      const auto& node = g[nid];
+      if (node.source->is_variable())
+        continue;
+      std::vector<TBlob> node_inputs, node_outputs;
+      for (const auto& e : node.inputs)
+        node_inputs.push_back(blob(g.entry_id(e)));
+      for (uint32_t i = 0; i < node.source->num_outputs(); ++i)
+        node_outputs.push_back(blob(g.entry_id(nid, i)));
+      std::vector<OpReqType> node_req(node_outputs.size(), kWriteTo);
+      kernels[nid](node.source->attrs, ctx, node_inputs, node_req, node_outputs);
+    }
+    for (const auto& staged : staged_outputs) {
+      const TBlob src  = blob(staged.first);
+      const TBlob& out = outputs[staged.second];
+      MSHADOW_TYPE_SWITCH_WITH_BOOL(out.type_flag_, DType, {
+        const DType* in = src.dptr<DType>();
+        DType* dst      = out.dptr<DType>() + begin;
+        const size_t n  = src.Size();
+        if (req[staged.second] == kAddTo) {
+          for (size_t i = 0; i < n; ++i)
+            dst[i] += in[i];
+        } else {
+          std::memcpy(dst, in, n * sizeof(DType));
+        }
+      });
+    }
+  };
+#pragma omp parallel num_threads(omp_threads)
+  {
+    uint8_t* slots = workspace + omp_get_thread_num() * thread_bytes;
+#pragma omp for
+    for (int t = 0; t < num_tiles; ++t)
+      run_tile(t, slots);
+  }
+}
+
 bool FusedOpInferShape(const nnvm::NodeAttrs& attrs,
                        std::vector<mxnet::TShape>* in_attrs,
                        std::vector<mxnet::TShape>* out_attrs) {
@@ -184,6 +361,15 @@ bool FusedOpInferType(const nnvm::NodeAttrs& attrs,
   return op->InferType(attrs, in_attrs, out_attrs);
 }
 
+void FusedOpForwardCPU(const nnvm::NodeAttrs& attrs,
+                       const OpContext& ctx,
+                       const std::vector<TBlob>& inputs,
+                       const std::vector<OpReqType>& req,
+                       const std::vector<TBlob>& outputs) {
+  const FusedOpPtr& op = nnvm::get<FusedOpPtr>(attrs.parsed);
+  op->Forward<cpu>(attrs, ctx, inputs, req, outputs);
+}
+
 void FusedOpProvideShape(const nnvm::NodeAttrs& attrs,
                          const std::vector<nnvm::ObjectPtr>& nodes,
                          const std::vector<std::vector<mxnet::TShape>>& in_attrs,
@@ -234,6 +420,7 @@ NNVM_REGISTER_OP(_FusedOp)
                                                  FusedOpProvideStorageType)
     .set_attr<mxnet::FInferShape>("FInferShape", FusedOpInferShape)
     .set_attr<nnvm::FInferType>("FInferType", FusedOpInferType)
+    .set_attr<FCompute>("FCompute<cpu>", FusedOpForwardCPU)
     .set_attr_parser(FusedOpParamParser)
     .add_argument("data", "NDArray-or-Symbol[]", "Data");
 
@@ -286,5 +473,3 @@ NNVM_REGISTER_OP(_FusedOpOutHelper)
     .set_attr<exec::FAccessSubgraphType>("FAccessSubgraphType", FusedOpOutHelperType);
 
 }  // namespace mxnet
-
-#endif  // MXNET_USE_CUDA
@@ -28,8 +28,6 @@
 #include <mutex>
 #include <tuple>
 
-#if MXNET_USE_CUDA
-
 namespace mxnet {
 
 namespace fusion {
@@ -115,6 +113,7 @@ class FusedOp {
   }
 
  private:
+#if MXNET_USE_CUDA
   std::string GenerateCode(const std::vector<OpReqType>& req,
                            const std::vector<int>& in_dtypes,
                            const std::vector<int>& out_dtypes,
@@ -135,6 +134,7 @@ class FusedOp {
                            std::vector<int>* out_dtypes,
                            std::vector<int>* out_ndims,
                            int* nvec);
+#endif  // MXNET_USE_CUDA
 
   std::vector<FusedOpEntry> inputs_;
   std::vector<FusedOpEntry> outputs_;
@@ -166,7 +166,11 @@ class FusedOp {
   std::vector<uint32_t> extra_shape_args_;
   std::vector<uint32_t> check_shape_args_;
 
+#if MXNET_USE_CUDA
   CUfunction kernel_functions_[fusion::kNumKernelVariants];
+#endif  // MXNET_USE_CUDA
+  /*! \brief buffers of the entries computed inside the subgraph on CPU */
+  std::vector<uint8_t> cpu_workspace_;
   bool initialized_;
   int kernel_function_dev_id_;
 
@@ -187,6 +191,4 @@ using FusedOpHelperParamPtr = std::shared_ptr<FusedOpHelperParam>;
 
 }  // namespace mxnet
 
-#endif  // MXNET_USE_CUDA
-
 #endif  // MXNET_OPERATOR_FUSION_FUSED_OP_H_
@@ -117,24 +117,45 @@ inline bool ToTensorType(const nnvm::NodeAttrs& attrs,
 }
 
 // Operator Implementation
+/*! \brief number of pixels a thread converts at once */
+constexpr int kToTensorBlock = 1024;
+
+/*!
+ * \brief Converts the interleaved channels of an image to planes, as out = in * scale + shift.
+ *        Pixels are read in order, so that the loads of an RGB image deinterleave.
+ */
 template <typename DType, int req>
 inline void ToTensor(float* out_data,
                      const DType* in_data,
                      const int length,
                      const int channels,
-                     const float normalize_factor,
+                     const float* scale,
+                     const float* shift,
                      const int step) {
-// Microsoft Visual C++ compiler does not support omp collapse
-#ifdef _MSC_VER
+  const DType* in = in_data + step;
+  float* out      = out_data + step;
 #pragma omp parallel for
-#else
-#pragma omp parallel for collapse(2)
-#endif  // _MSC_VER
-  for (int c = 0; c < channels; ++c) {
-    for (int i = 0; i < length; ++i) {
-      KERNEL_ASSIGN(out_data[step + c * length + i],
-                    req,
-                    (in_data[step + i * channels + c]) / normalize_factor);
+  for (int b = 0; b < length; b += kToTensorBlock) {
+    const int e = std::min(length, b + kToTensorBlock);
+    if (channels == 3) {
+      float* out_r = out;
+      float* out_g = out + length;
+      float* out_b = out + 2 * length;
+#pragma omp simd
+      for (int i = b; i < e; ++i) {
+        KERNEL_ASSIGN(out_r[i], req, static_cast<float>(in[3 * i]) * scale[0] + shift[0]);
+        KERNEL_ASSIGN(out_g[i], req, static_cast<float>(in[3 * i + 1]) * scale[1] + shift[1]);
+        KERNEL_ASSIGN(out_b[i], req, static_cast<float>(in[3 * i + 2]) * scale[2] + shift[2]);
+      }
+    } else {
+      for (int c = 0; c < channels; ++c) {
+#pragma omp simd
+        for (int i = b; i < e; ++i) {
+          KERNEL_ASSIGN(out[c * length + i],
+                        req,
+                        static_cast<float>(in[i * channels + c]) * scale[c] + shift[c]);
+        }
+      }
     }
   }
 }
@@ -144,17 +165,44 @@ inline void ToTensorImpl(const std::vector<TBlob>& inputs,
                          const std::vector<OpReqType>& req,
                          const int length,
                          const int channel,
-                         const float normalize_factor,
+                         const float* scale,
+                         const float* shift,
                          const int step) {
   MSHADOW_TYPE_SWITCH(inputs[0].type_flag_, DType, {
     MXNET_ASSIGN_REQ_SWITCH(req[0], req_type, {
       float* output = outputs[0].dptr<float>();
       DType* input  = inputs[0].dptr<DType>();
-      ToTensor<DType, req_type>(output, input, length, channel, normalize_factor, step);
+      ToTensor<DType, req_type>(output, input, length, channel, scale, shift, step);
     });
   });
 }
 
+/*! \brief CPU to_tensor of images of 3 or 4 dimensions, as out = in * scale + shift */
+inline void ToTensorCPU(const std::vector<TBlob>& inputs,
+                        const std::vector<OpReqType>& req,
+                        const std::vector<TBlob>& outputs,
+                        const float* scale,
+                        const float* shift) {
+  if (inputs[0].ndim() == 3) {
+    // 3D Input - (h, w, c)
+    const int length  = inputs[0].shape_[0] * inputs[0].shape_[1];
+    const int channel = static_cast<int>(inputs[0].shape_[2]);
+    const int step    = 0;
+    ToTensorImpl(inputs, outputs, req, length, channel, scale, shift, step);
+  } else if (inputs[0].ndim() == 4) {
+    // 4D input (n, h, w, c)
+    const int batch_size = inputs[0].shape_[0];
+    const int length     = inputs[0].shape_[1] * inputs[0].shape_[2];
+    const int channel    = static_cast<int>(inputs[0].shape_[3]);
+    const int step       = channel * length;
+
+#pragma omp parallel for
+    for (auto n = 0; n < batch_size; ++n) {
+      ToTensorImpl(inputs, outputs, req, length, channel, scale, shift, n * step);
+    }
+  }
+}
+
 template <typename xpu>
 void ToTensorOpForward(const nnvm::NodeAttrs& attrs,
                        const OpContext& ctx,
@@ -192,23 +240,11 @@ void ToTensorOpForward(const nnvm::NodeAttrs& attrs,
 #else
     LOG(FATAL) << "Compile with USE_CUDA=1 to use ToTensor operator on GPU.";
 #endif  // MXNET_USE_CUDA
-  } else if (inputs[0].ndim() == 3) {
-    // 3D Input - (h, w, c)
-    const int length  = inputs[0].shape_[0] * inputs[0].shape_[1];
-    const int channel = static_cast<int>(inputs[0].shape_[2]);
-    const int step    = 0;
-    ToTensorImpl(inputs, outputs, req, length, channel, normalize_factor, step);
-  } else if (inputs[0].ndim() == 4) {
-    // 4D input (n, h, w, c)
-    const int batch_size = inputs[0].shape_[0];
-    const int length     = inputs[0].shape_[1] * inputs[0].shape_[2];
-    const int channel    = static_cast<int>(inputs[0].shape_[3]);
-    const int step       = channel * length;
-
-#pragma omp parallel for
-    for (auto n = 0; n < batch_size; ++n) {
-      ToTensorImpl(inputs, outputs, req, length, channel, normalize_factor, n * step);
-    }
+  } else {
+    const int channels = inputs[0].shape_[inputs[0].ndim() - 1];
+    const std::vector<float> scale(channels, 1.0f / normalize_factor);
+    const std::vector<float> shift(channels, 0.0f);
+    ToTensorCPU(inputs, req, outputs, scale.data(), shift.data());
   }
 }
 
@@ -230,6 +266,18 @@ struct NormalizeParam : public dmlc::Parameter<NormalizeParam> {
   }
 };
 
+// Mean and Std can be 1 or 3D only.
+inline void NormalizeMeanStd(const NormalizeParam& param,
+                             std::vector<float>* mean,
+                             std::vector<float>* std) {
+  mean->resize(3);
+  std->resize(3);
+  for (int c = 0; c < 3; ++c) {
+    (*mean)[c] = param.mean[param.mean.ndim() == 1 ? 0 : c];
+    (*std)[c]  = param.std[param.std.ndim() == 1 ? 0 : c];
+  }
+}
+
 // Shape and Type inference for image Normalize operator
 
 // Shape inference
@@ -334,24 +382,9 @@ void NormalizeOpForward(const nnvm::NodeAttrs& attrs,
 
   const NormalizeParam& param = nnvm::get<NormalizeParam>(attrs.parsed);
 
-  // Mean and Std can be 1 or 3D only.
-  std::vector<float> mean(3);
-  std::vector<float> std(3);
-  if (param.mean.ndim() == 1) {
-    mean[0] = mean[1] = mean[2] = param.mean[0];
-  } else {
-    mean[0] = param.mean[0];
-    mean[1] = param.mean[1];
-    mean[2] = param.mean[2];
-  }
-
-  if (param.std.ndim() == 1) {
-    std[0] = std[1] = std[2] = param.std[0];
-  } else {
-    std[0] = param.std[0];
-    std[1] = param.std[1];
-    std[2] = param.std[2];
-  }
+  std::vector<float> mean;
+  std::vector<float> std;
+  NormalizeMeanStd(param, &mean, &std);
 
   if (std::is_same<xpu, gpu>::value) {
 #if MXNET_USE_CUDA
@@ -415,6 +448,88 @@ void NormalizeOpForward(const nnvm::NodeAttrs& attrs,
   }
 }
 
+// Shape inference of to_tensor followed by normalize
+inline bool ToTensorNormalizeShape(const nnvm::NodeAttrs& attrs,
+                                   mxnet::ShapeVector* in_attrs,
+                                   mxnet::ShapeVector* out_attrs) {
+  if (!ToTensorShape(attrs, in_attrs, out_attrs))
+    return false;
+  mxnet::ShapeVector tensor_shape{(*out_attrs)[0]};
+  mxnet::ShapeVector normalized_shape(1);
+  return NormalizeOpShape(attrs, &tensor_shape, &normalized_shape);
+}
+
+/*!
+ * \brief to_tensor followed by normalize. On CPU both are a single multiply-add of each
+ *        value as it is transposed, with scale 1 / (255 std) and shift -mean / std.
+ */
+template <typename xpu>
+void ToTensorNormalizeOpForward(const nnvm::NodeAttrs& attrs,
+                                const OpContext& ctx,
+                                const std::vector<TBlob>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<TBlob>& outputs) {
+  CHECK_EQ(inputs.size(), 1U);
+  CHECK_EQ(outputs.size(), 1U);
+  CHECK_EQ(req.size(), 1U);
+  CHECK_EQ(req[0], kWriteTo) << "`to_tensor_normalize` does not support inplace updates";
+
+  const NormalizeParam& param  = nnvm::get<NormalizeParam>(attrs.parsed);
+  const float normalize_factor = 255.0f;
+  std::vector<float> mean;
+  std::vector<float> std;
+  NormalizeMeanStd(param, &mean, &std);
+
+  if (std::is_same<xpu, gpu>::value) {
+#if MXNET_USE_CUDA
+    mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+    const TBlob& out        = outputs[0];
+    const int N             = out.ndim() == 3 ? 1 : static_cast<int>(out.shape_[0]);
+    const int C             = static_cast<int>(out.shape_[out.ndim() - 3]);
+    const int H             = static_cast<int>(out.shape_[out.ndim() - 2]);
+    const int W             = static_cast<int>(out.shape_[out.ndim() - 1]);
+    MSHADOW_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+      if (inputs[0].ndim() == 3) {
+        Tensor<gpu, 3, DType> input  = inputs[0].get<gpu, 3, DType>(s);
+        Tensor<gpu, 3, float> output = out.get<gpu, 3, float>(s);
+        ToTensorImplCUDA<DType, Tensor<gpu, 3, DType>, Tensor<gpu, 3, float>>(
+            s, input, output, kWriteTo, normalize_factor);
+      } else {
+        Tensor<gpu, 4, DType> input  = inputs[0].get<gpu, 4, DType>(s);
+        Tensor<gpu, 4, float> output = out.get<gpu, 4, float>(s);
+        ToTensorImplCUDA<DType, Tensor<gpu, 4, DType>, Tensor<gpu, 4, float>>(
+            s, input, output, kWriteTo, normalize_factor);
+      }
+    });
+    // normalizing in place reads each value once it is written
+    NormalizeImplCUDA<float>(s,
+                             out.dptr<float>(),
+                             out.dptr<float>(),
+                             kWriteTo,
+                             N,
+                             C,
+                             H,
+                             W,
+                             mean[0],
+                             mean[1],
+                             mean[2],
+                             std[0],
+                             std[1],
+                             std[2]);
+#else
+    LOG(FATAL) << "Compile with USE_CUDA=1 to use to_tensor_normalize operator on GPU.";
+#endif  // MXNET_USE_CUDA
+  } else {
+    std::vector<float> scale(3);
+    std::vector<float> shift(3);
+    for (int c = 0; c < 3; ++c) {
+      scale[c] = 1.0f / (normalize_factor * std[c]);
+      shift[c] = -mean[c] / std[c];
+    }
+    ToTensorCPU(inputs, req, outputs, scale.data(), shift.data());
+  }
+}
+
 // Backward function
 template <typename DType, int req>
 inline void NormalizeBackward(const DType* out_grad,
@@ -655,22 +770,232 @@ struct RandomEnhanceParam : public dmlc::Parameter<RandomEnhanceParam> {
   }
 };
 
+namespace color {
+enum ColorStepType { kBrightness, kContrast, kSaturation, kHue, kLighting };
+/*! \brief pixels a chain of steps runs over at once */
+constexpr int kBlock = 256;
+}  // namespace color
+
+/*! \brief a color transform of a chain */
+struct ColorStep {
+  int type;
+  /*! \brief factor of brightness, contrast and saturation, or hue shift in turns */
+  float alpha;
+  /*! \brief offsets of the R, G and B channels added by lighting */
+  float pca[3];
+};
+
+/*! \brief a value as the step that computes it stores it in DType */
+template <typename DType>
+inline float StoredValue(const float& x) {
+  return static_cast<float>(saturate_cast<DType>(x));
+}
+
+template <>
+inline float StoredValue<uint8_t>(const float& x) {
+  // truncates through int, which vectorizes unlike the conversion to uint8_t
+  return static_cast<float>(static_cast<int>(std::min(std::max(x, 0.f), 255.f)));
+}
+
+/*! \brief the result of a step that stores DType, written to a buffer of Out */
+template <typename DType, typename Out>
+struct ColorResult {
+  static Out Get(const float& x) {
+    return saturate_cast<DType>(x);
+  }
+};
+
+template <typename DType>
+struct ColorResult<DType, float> {
+  static float Get(const float& x) {
+    return StoredValue<DType>(x);
+  }
+};
+
+/*! \brief weight of a primary in a color of hue h in [-4, 6), in sixths of a turn from it */
+inline float HueWeight(float h) {
+  h             = h > 3.f ? h - 6.f : h < -3.f ? h + 6.f : h;
+  const float d = h < 0.f ? -h : h;
+  return std::min(std::max(2.f - d, 0.f), 1.f);
+}
+
+/*!
+ * \brief Rotates the hue of n interleaved RGB values in [0, 255] by alpha turns, through HLS.
+ *        The conversions select instead of branching, so that the loop vectorizes.
+ */
+template <typename DType, typename In, typename Out>
+inline void ShiftHue(float alpha, int n, const In* src, Out* dst) {
+  // the shift in sixths of a turn, in [0, 6)
+  const float shift = (alpha - std::floor(alpha)) * 6.f;
+#pragma omp simd
+  for (int i = 0; i < n; ++i) {
+    const float r     = static_cast<float>(src[3 * i]) / 255.f;
+    const float g     = static_cast<float>(src[3 * i + 1]) / 255.f;
+    const float b     = static_cast<float>(src[3 * i + 2]) / 255.f;
+    const float vmax  = std::max(std::max(r, g), b);
+    const float vmin  = std::min(std::min(r, g), b);
+    const float diff  = vmax - vmin;
+    const float l     = (vmax + vmin) * 0.5f;
+    const bool chroma = diff > std::numeric_limits<float>::epsilon();
+    // saturation and hue, in sixths of a turn, which are 0 for grays
+    const float s  = !chroma ? 0.f : diff / (l < 0.5f ? vmax + vmin : 2.f - vmax - vmin);
+    const float d6 = 1.f / (chroma ? diff : 1.f);
+    float h        = vmax == r ? (g - b) * d6 : vmax == g ? (b - r) * d6 + 2.f : (r - g) * d6 + 4.f;
+    h              = chroma ? h + (h < 0.f) * 6.f : 0.f;
+    h += shift;
+    h = h >= 6.f ? h - 6.f : h;
+    // back to RGB, between the lightest and darkest values of the lightness and saturation
+    const float p2 = l <= 0.5f ? l * (1.f + s) : l + s - l * s;
+    const float p1 = 2.f * l - p2;
+    dst[3 * i]     = ColorResult<DType, Out>::Get((p1 + (p2 - p1) * HueWeight(h)) * 255.f);
+    dst[3 * i + 1] = ColorResult<DType, Out>::Get((p1 + (p2 - p1) * HueWeight(h - 2.f)) * 255.f);
+    dst[3 * i + 2] = ColorResult<DType, Out>::Get((p1 + (p2 - p1) * HueWeight(h - 4.f)) * 255.f);
+  }
+}
+
+/*!
+ * \brief Runs a step of a chain over n interleaved pixels, rounding each result as the step
+ *        would store it in DType, so that the chain matches the steps run one by one.
+ * \param beta offset of a contrast step, from the mean gray level of its input
+ */
+template <typename DType, typename In, typename Out>
+inline void RunColorStep(const ColorStep& step,
+                         float beta,
+                         int n,
+                         int channels,
+                         const In* src,
+                         Out* dst) {
+  using namespace color;
+  using Result              = ColorResult<DType, Out>;
+  static const float coef[] = {0.299f, 0.587f, 0.114f};
+  const float alpha         = step.alpha;
+  const int size            = n * channels;
+  if (channels != 3 && step.type != kBrightness && step.type != kContrast) {
+    // saturation, hue and lighting leave other than RGB images as they are
+#pragma omp simd
+    for (int i = 0; i < size; ++i)
+      dst[i] = Result::Get(static_cast<float>(src[i]));
+    return;
+  }
+  switch (step.type) {
+    case kBrightness:
+#pragma omp simd
+      for (int i = 0; i < size; ++i)
+        dst[i] = Result::Get(static_cast<float>(src[i]) * alpha);
+      break;
+    case kContrast:
+#pragma omp simd
+      for (int i = 0; i < size; ++i)
+        dst[i] = Result::Get(static_cast<float>(src[i]) * alpha + beta);
+      break;
+    case kSaturation:
+#pragma omp simd
+      for (int i = 0; i < n; ++i) {
+        const float r    = static_cast<float>(src[3 * i]);
+        const float g    = static_cast<float>(src[3 * i + 1]);
+        const float b    = static_cast<float>(src[3 * i + 2]);
+        const float gray = (r * coef[0] + g * coef[1] + b * coef[2]) * (1.f - alpha);
+        dst[3 * i]       = Result::Get(gray + r * alpha);
+        dst[3 * i + 1]   = Result::Get(gray + g * alpha);
+        dst[3 * i + 2]   = Result::Get(gray + b * alpha);
+      }
+      break;
+    case kHue:
+      ShiftHue<DType>(alpha, n, src, dst);
+      break;
+    case kLighting:
+#pragma omp simd
+      for (int i = 0; i < n; ++i) {
+        dst[3 * i]     = Result::Get(static_cast<float>(src[3 * i]) + step.pca[0]);
+        dst[3 * i + 1] = Result::Get(static_cast<float>(src[3 * i + 1]) + step.pca[1]);
+        dst[3 * i + 2] = Result::Get(static_cast<float>(src[3 * i + 2]) + step.pca[2]);
+      }
+      break;
+    default:
+      LOG(FATAL) << "Unknown color step " << step.type;
+  }
+}
+
+/*! \brief the sum of the gray levels of n interleaved pixels */
+template <typename DType>
+inline float GraySum(const DType* src, int n, int channels) {
+  static const float coef[] = {0.299f, 0.587f, 0.114f};
+  float sum                 = 0.f;
+  if (channels == 3) {
+#pragma omp simd reduction(+ : sum)
+    for (int i = 0; i < n; ++i) {
+      sum += static_cast<float>(src[3 * i]) * coef[0] +
+             static_cast<float>(src[3 * i + 1]) * coef[1] +
+             static_cast<float>(src[3 * i + 2]) * coef[2];
+    }
+  } else {
+#pragma omp simd reduction(+ : sum)
+    for (int i = 0; i < n; ++i)
+      sum += static_cast<float>(src[i * channels]);
+  }
+  return sum;
+}
+
+/*!
+ * \brief Applies a chain of color transforms to an image of length pixels, a block of pixels
+ *        at a time, with the first step of the block reading in and the last writing out. Each
+ *        contrast step needs the mean gray level of its input, so the steps up to it run in one
+ *        pass that stores its input in out, and the following steps run in a pass from there.
+ */
+template <typename DType>
+inline void ColorAugment(const DType* in,
+                         DType* out,
+                         const int length,
+                         const int channels,
+                         const std::vector<ColorStep>& steps) {
+  using namespace color;
+  std::vector<float> beta(steps.size(), 0.f);
+  float block[kBlock * 3];
+  const DType* src = in;
+  size_t first     = 0;
+  for (size_t last = 0; last <= steps.size(); ++last) {
+    if (last < steps.size() && steps[last].type != kContrast)
+      continue;
+    double sum = 0;
+    for (int p = 0; p < length; p += kBlock) {
+      const int n       = std::min(kBlock, length - p);
+      const DType* from = src + p * channels;
+      DType* to         = out + p * channels;
+      if (last == first + 1) {
+        RunColorStep<DType>(steps[first], beta[first], n, channels, from, to);
+      } else if (last > first + 1) {
+        RunColorStep<DType>(steps[first], beta[first], n, channels, from, block);
+        for (size_t k = first + 1; k + 1 < last; ++k)
+          RunColorStep<DType>(steps[k], beta[k], n, channels, block, block);
+        RunColorStep<DType>(steps[last - 1], beta[last - 1], n, channels, block, to);
+      }
+      if (last < steps.size())
+        sum += GraySum(last > first ? to : from, n, channels);
+    }
+    if (last < steps.size())
+      beta[last] = (1.f - steps[last].alpha) * static_cast<float>(sum / length);
+    src   = last > first ? out : src;
+    first = last;
+  }
+}
+
+/*! \brief Applies a chain of color transforms to an (H x W x C) image */
+inline void ColorAugment(const TBlob& input,
+                         const TBlob& output,
+                         const std::vector<ColorStep>& steps) {
+  const int length   = input.shape_[0] * input.shape_[1];
+  const int channels = input.shape_[2];
+  MSHADOW_TYPE_SWITCH(output.type_flag_, DType, {
+    ColorAugment<DType>(input.dptr<DType>(), output.dptr<DType>(), length, channels, steps);
+  });
+}
+
 inline void AdjustBrightnessImpl(const float& alpha_b,
                                  const OpContext& ctx,
                                  const std::vector<TBlob>& inputs,
                                  const std::vector<OpReqType>& req,
                                  const std::vector<TBlob>& outputs) {
-  using namespace mshadow;
-  int length = inputs[0].Size();
-
-  MSHADOW_TYPE_SWITCH(outputs[0].type_flag_, DType, {
-    DType* output = outputs[0].dptr<DType>();
-    DType* input  = inputs[0].dptr<DType>();
-    for (int l = 0; l < length; ++l) {
-      float val = static_cast<float>(input[l]) * alpha_b;
-      output[l] = saturate_cast<DType>(val);
-    }
-  });
+  ColorAugment(inputs[0], outputs[0], {ColorStep{color::kBrightness, alpha_b, {}}});
 }
 
 inline void RandomBrightness(const nnvm::NodeAttrs& attrs,
@@ -694,34 +1019,7 @@ inline void AdjustContrastImpl(const float& alpha_c,
                                const std::vector<TBlob>& inputs,
                                const std::vector<OpReqType>& req,
                                const std::vector<TBlob>& outputs) {
-  using namespace mshadow;
-  static const float coef[] = {0.299f, 0.587f, 0.114f};
-
-  int length    = inputs[0].shape_[0] * inputs[0].shape_[1];
-  int nchannels = inputs[0].shape_[2];
-
-  MSHADOW_TYPE_SWITCH(outputs[0].type_flag_, DType, {
-    DType* output = outputs[0].dptr<DType>();
-    DType* input  = inputs[0].dptr<DType>();
-
-    float sum = 0.f;
-    if (nchannels > 1) {
-      for (int l = 0; l < length; ++l) {
-        for (int c = 0; c < 3; ++c)
-          sum += input[l * 3 + c] * coef[c];
-      }
-    } else {
-      for (int l = 0; l < length; ++l)
-        sum += input[l];
-    }
-    float gray_mean = sum / static_cast<float>(length);
-    float beta      = (1 - alpha_c) * gray_mean;
-
-    for (int l = 0; l < length * nchannels; ++l) {
-      float val = input[l] * alpha_c + beta;
-      output[l] = saturate_cast<DType>(val);
-    }
-  });
+  ColorAugment(inputs[0], outputs[0], {ColorStep{color::kContrast, alpha_c, {}}});
 }
 
 inline void RandomContrast(const nnvm::NodeAttrs& attrs,
@@ -745,35 +1043,7 @@ inline void AdjustSaturationImpl(const float& alpha_s,
                                  const std::vector<TBlob>& inputs,
                                  const std::vector<OpReqType>& req,
                                  const std::vector<TBlob>& outputs) {
-  static const float coef[] = {0.299f, 0.587f, 0.114f};
-
-  int length    = inputs[0].shape_[0] * inputs[0].shape_[1];
-  int nchannels = inputs[0].shape_[2];
-
-  float alpha_o = 1.f - alpha_s;
-
-  MSHADOW_TYPE_SWITCH(outputs[0].type_flag_, DType, {
-    DType* output = outputs[0].dptr<DType>();
-    DType* input  = inputs[0].dptr<DType>();
-
-    if (nchannels == 1) {
-      for (int l = 0; l < length; ++l)
-        output[l] = input[l];
-      return;
-    }
-
-    for (int l = 0; l < length; ++l) {
-      float gray = 0.f;
-      for (int c = 0; c < 3; ++c) {
-        gray = input[l * 3 + c] * coef[c];
-      }
-      gray *= alpha_o;
-      for (int c = 0; c < 3; ++c) {
-        float val         = gray + input[l * 3 + c] * alpha_s;
-        output[l * 3 + c] = saturate_cast<DType>(val);
-      }
-    }
-  });
+  ColorAugment(inputs[0], outputs[0], {ColorStep{color::kSaturation, alpha_s, {}}});
 }
 
 inline void RandomSaturation(const nnvm::NodeAttrs& attrs,
@@ -792,120 +1062,12 @@ inline void RandomSaturation(const nnvm::NodeAttrs& attrs,
   AdjustSaturationImpl(alpha_s, ctx, inputs, req, outputs);
 }
 
-inline void RGB2HLSConvert(const float& src_r,
-                           const float& src_g,
-                           const float& src_b,
-                           float* dst_h,
-                           float* dst_l,
-                           float* dst_s) {
-  float b = src_b / 255.f, g = src_g / 255.f, r = src_r / 255.f;
-  float h = 0.f, s = 0.f, l;
-  float vmin;
-  float vmax;
-  float diff;
-
-  vmax = vmin = r;
-  vmax        = std::fmax(vmax, g);
-  vmax        = std::fmax(vmax, b);
-  vmin        = std::fmin(vmin, g);
-  vmin        = std::fmin(vmin, b);
-
-  diff = vmax - vmin;
-  l    = (vmax + vmin) * 0.5f;
-
-  if (diff > std::numeric_limits<float>::epsilon()) {
-    s = (l < 0.5f) * diff / (vmax + vmin);
-    s += (l >= 0.5f) * diff / (2.0f - vmax - vmin);
-
-    diff = 60.f / diff;
-
-    h = (vmax == r) * (g - b) * diff;
-    h += (vmax != r && vmax == g) * ((b - r) * diff + 120.f);
-    h += (vmax != r && vmax != g) * ((r - g) * diff + 240.f);
-    h += (h < 0.f) * 360.f;
-  }
-
-  *dst_h = h;
-  *dst_l = l;
-  *dst_s = s;
-}
-
-inline void HLS2RGBConvert(const float& src_h,
-                           const float& src_l,
-                           const float& src_s,
-                           float* dst_r,
-                           float* dst_g,
-                           float* dst_b) {
-  static const int c_HlsSectorData[6][3] = {
-      {1, 3, 0}, {1, 0, 2}, {3, 0, 1}, {0, 2, 1}, {0, 1, 3}, {2, 1, 0}};
-
-  float h = src_h, l = src_l, s = src_s;
-  float b = l, g = l, r = l;
-
-  if (s != 0) {
-    float p2 = (l <= 0.5f) * l * (1 + s);
-    p2 += (l > 0.5f) * (l + s - l * s);
-    float p1 = 2 * l - p2;
-
-    h *= 1.f / 60.f;
-
-    if (h < 0) {
-      do {
-        h += 6;
-      } while (h < 0);
-    }
-    if (h >= 6) {  // h + 6 >= 6 holds true for some h < 0
-      do {
-        h -= 6;
-      } while (h >= 6);
-    }
-
-    int sector = static_cast<int>(h);
-
-    h -= sector;
-
-    float tab[4];
-    tab[0] = p2;
-    tab[1] = p1;
-    tab[2] = p1 + (p2 - p1) * (1 - h);
-    tab[3] = p1 + (p2 - p1) * h;
-
-    b = tab[c_HlsSectorData[sector][0]];
-    g = tab[c_HlsSectorData[sector][1]];
-    r = tab[c_HlsSectorData[sector][2]];
-  }
-
-  *dst_b = b * 255.f;
-  *dst_g = g * 255.f;
-  *dst_r = r * 255.f;
-}
-
 inline void AdjustHueImpl(float alpha,
                           const OpContext& ctx,
                           const std::vector<TBlob>& inputs,
                           const std::vector<OpReqType>& req,
                           const std::vector<TBlob>& outputs) {
-  int length = inputs[0].shape_[0] * inputs[0].shape_[1];
-  if (inputs[0].shape_[2] == 1)
-    return;
-
-  MSHADOW_TYPE_SWITCH(outputs[0].type_flag_, DType, {
-    DType* input  = inputs[0].dptr<DType>();
-    DType* output = outputs[0].dptr<DType>();
-
-    for (int i = 0; i < length; ++i) {
-      float h, l, s;
-      float r = static_cast<float>(*(input++));
-      float g = static_cast<float>(*(input++));
-      float b = static_cast<float>(*(input++));
-      RGB2HLSConvert(r, g, b, &h, &l, &s);
-      h += alpha * 360.f;
-      HLS2RGBConvert(h, l, s, &r, &g, &b);
-      *(output++) = saturate_cast<DType>(r);
-      *(output++) = saturate_cast<DType>(g);
-      *(output++) = saturate_cast<DType>(b);
-    }
-  });
+  ColorAugment(inputs[0], outputs[0], {ColorStep{color::kHue, alpha, {}}});
 }
 
 inline void RandomHue(const nnvm::NodeAttrs& attrs,
@@ -929,14 +1091,52 @@ struct RandomColorJitterParam : public dmlc::Parameter<RandomColorJitterParam> {
   float contrast;
   float saturation;
   float hue;
+  float alpha_std;
   DMLC_DECLARE_PARAMETER(RandomColorJitterParam) {
     DMLC_DECLARE_FIELD(brightness).describe("How much to jitter brightness.");
     DMLC_DECLARE_FIELD(contrast).describe("How much to jitter contrast.");
     DMLC_DECLARE_FIELD(saturation).describe("How much to jitter saturation.");
     DMLC_DECLARE_FIELD(hue).describe("How much to jitter hue.");
+    DMLC_DECLARE_FIELD(alpha_std)
+        .set_default(0.0)
+        .describe("Level of the lighting noise added after the other jitters. 0 adds none.");
+  }
+};
+
+struct AdjustLightingParam : public dmlc::Parameter<AdjustLightingParam> {
+  mxnet::Tuple<float> alpha;
+  DMLC_DECLARE_PARAMETER(AdjustLightingParam) {
+    DMLC_DECLARE_FIELD(alpha).describe("The lighting alphas for the R, G, B channels.");
   }
 };
 
+struct RandomLightingParam : public dmlc::Parameter<RandomLightingParam> {
+  float alpha_std;
+  DMLC_DECLARE_PARAMETER(RandomLightingParam) {
+    DMLC_DECLARE_FIELD(alpha_std).set_default(0.05).describe("Level of the lighting noise.");
+  }
+};
+
+/*! \brief the RGB offsets of AlexNet-style lighting of the given alphas */
+inline ColorStep LightingStep(const mxnet::Tuple<float>& alpha) {
+  static const float eig[3][3] = {{55.46 * -0.5675, 4.794 * 0.7192, 1.148 * 0.4009},
+                                  {55.46 * -0.5808, 4.794 * -0.0045, 1.148 * -0.8140},
+                                  {55.46 * -0.5836, 4.794 * -0.6948, 1.148 * 0.4203}};
+  ColorStep step{color::kLighting, 0.f, {}};
+  for (int c = 0; c < 3; ++c) {
+    step.pca[c] = eig[c][0] * alpha[0] + eig[c][1] * alpha[1] + eig[c][2] * alpha[2];
+  }
+  return step;
+}
+
+inline void AdjustLightingImpl(const mxnet::Tuple<float>& alpha,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  ColorAugment(inputs[0], outputs[0], {LightingStep(alpha)});
+}
+
 inline void RandomColorJitter(const nnvm::NodeAttrs& attrs,
                               const OpContext& ctx,
                               const std::vector<TBlob>& inputs,
@@ -949,7 +1149,8 @@ inline void RandomColorJitter(const nnvm::NodeAttrs& attrs,
 
   int order[4] = {0, 1, 2, 3};
   std::shuffle(order, order + 4, prnd->GetRndEngine());
-  bool flag = false;
+  // the jitters, in their random order, run as one chain over the image
+  std::vector<ColorStep> steps;
 
   for (int i = 0; i < 4; ++i) {
     switch (order[i]) {
@@ -957,84 +1158,40 @@ inline void RandomColorJitter(const nnvm::NodeAttrs& attrs,
         if (param.brightness > 0) {
           float alpha_b = 1.0 + std::uniform_real_distribution<float>(
                                     -param.brightness, param.brightness)(prnd->GetRndEngine());
-          AdjustBrightnessImpl(alpha_b, ctx, flag ? outputs : inputs, req, outputs);
-          flag = true;
+          steps.push_back(ColorStep{color::kBrightness, alpha_b, {}});
         }
         break;
       case 1:
         if (param.contrast > 0) {
           float alpha_c = 1.0 + std::uniform_real_distribution<float>(
                                     -param.contrast, param.contrast)(prnd->GetRndEngine());
-          AdjustContrastImpl(alpha_c, ctx, flag ? outputs : inputs, req, outputs);
-          flag = true;
+          steps.push_back(ColorStep{color::kContrast, alpha_c, {}});
         }
         break;
       case 2:
         if (param.saturation > 0) {
           float alpha_s = 1.f + std::uniform_real_distribution<float>(
                                     -param.saturation, param.saturation)(prnd->GetRndEngine());
-          AdjustSaturationImpl(alpha_s, ctx, flag ? outputs : inputs, req, outputs);
-          flag = true;
+          steps.push_back(ColorStep{color::kSaturation, alpha_s, {}});
         }
         break;
       case 3:
         if (param.hue > 0) {
           float alpha_h =
               std::uniform_real_distribution<float>(-param.hue, param.hue)(prnd->GetRndEngine());
-          AdjustHueImpl(alpha_h, ctx, flag ? outputs : inputs, req, outputs);
-          flag = true;
+          steps.push_back(ColorStep{color::kHue, alpha_h, {}});
         }
         break;
     }
   }
-}
-
-struct AdjustLightingParam : public dmlc::Parameter<AdjustLightingParam> {
-  mxnet::Tuple<float> alpha;
-  DMLC_DECLARE_PARAMETER(AdjustLightingParam) {
-    DMLC_DECLARE_FIELD(alpha).describe("The lighting alphas for the R, G, B channels.");
-  }
-};
-
-struct RandomLightingParam : public dmlc::Parameter<RandomLightingParam> {
-  float alpha_std;
-  DMLC_DECLARE_PARAMETER(RandomLightingParam) {
-    DMLC_DECLARE_FIELD(alpha_std).set_default(0.05).describe("Level of the lighting noise.");
+  if (param.alpha_std > 0) {
+    std::normal_distribution<float> dist(0, param.alpha_std);
+    float alpha_r = dist(prnd->GetRndEngine());
+    float alpha_g = dist(prnd->GetRndEngine());
+    float alpha_b = dist(prnd->GetRndEngine());
+    steps.push_back(LightingStep({alpha_r, alpha_g, alpha_b}));
   }
-};
-
-inline void AdjustLightingImpl(const mxnet::Tuple<float>& alpha,
-                               const OpContext& ctx,
-                               const std::vector<TBlob>& inputs,
-                               const std::vector<OpReqType>& req,
-                               const std::vector<TBlob>& outputs) {
-  static const float eig[3][3] = {{55.46 * -0.5675, 4.794 * 0.7192, 1.148 * 0.4009},
-                                  {55.46 * -0.5808, 4.794 * -0.0045, 1.148 * -0.8140},
-                                  {55.46 * -0.5836, 4.794 * -0.6948, 1.148 * 0.4203}};
-
-  int length   = inputs[0].shape_[0] * inputs[0].shape_[1];
-  int channels = inputs[0].shape_[2];
-  if (channels == 1)
-    return;
-
-  float pca_r = eig[0][0] * alpha[0] + eig[0][1] * alpha[1] + eig[0][2] * alpha[2];
-  float pca_g = eig[1][0] * alpha[0] + eig[1][1] * alpha[1] + eig[1][2] * alpha[2];
-  float pca_b = eig[2][0] * alpha[0] + eig[2][1] * alpha[1] + eig[2][2] * alpha[2];
-
-  MSHADOW_TYPE_SWITCH(outputs[0].type_flag_, DType, {
-    DType* output = outputs[0].dptr<DType>();
-    DType* input  = inputs[0].dptr<DType>();
-
-    for (int i = 0; i < length; i++) {
-      int base_ind         = 3 * i;
-      float in_r           = static_cast<float>(input[base_ind]);
-      float in_g           = static_cast<float>(input[base_ind + 1]);
-      float in_b           = static_cast<float>(input[base_ind + 2]);
-      output[base_ind]     = saturate_cast<DType>(in_r + pca_r);
-      output[base_ind + 1] = saturate_cast<DType>(in_g + pca_g);
-      output[base_ind + 2] = saturate_cast<DType>(in_b + pca_b);
-    }
-  });
+  ColorAugment(inputs[0], outputs[0], steps);
 }
 
 inline void AdjustLighting(const nnvm::NodeAttrs& attrs,
@@ -194,6 +194,40 @@ NNVM_REGISTER_OP(_backward_image_normalize)
     .set_attr<nnvm::TIsBackward>("TIsBackward", true)
     .set_attr<FCompute>("FCompute<cpu>", NormalizeOpBackward<cpu>);
 
+NNVM_REGISTER_OP(_image_to_tensor_normalize)
+    .add_alias("_npx__image_to_tensor_normalize")
+    .describe(R"code(Converts an image NDArray of shape (H x W x C) or (N x H x W x C) with
+values in the range [0, 255] to a tensor of shape (C x H x W) or (N x C x H x W) and normalizes
+it with mean and standard deviation, in a single pass over the image.
+
+It is the same as `to_tensor` followed by `normalize`:
+
+.. math::
+
+        output[i] = (input[i] / 255 - m\ :sub:`i`\ ) / s\ :sub:`i`
+
+Example:
+
+.. code-block:: python
+
+    image = mx.nd.random.uniform(0, 255, (4, 2, 3)).astype(dtype=np.uint8)
+    to_tensor_normalize(image, mean=(0.485, 0.456, 0.406), std=(0.229, 0.224, 0.225))
+
+)code" ADD_FILELINE)
+    .set_attr_parser(ParamParser<NormalizeParam>)
+    .set_num_inputs(1)
+    .set_num_outputs(1)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data"};
+                                     })
+    .set_attr<mxnet::FInferShape>("FInferShape", ToTensorNormalizeShape)
+    .set_attr<nnvm::FInferType>("FInferType", ToTensorType)
+    .set_attr<FCompute>("FCompute<cpu>", ToTensorNormalizeOpForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .add_argument("data", "NDArray-or-Symbol", "Input ndarray")
+    .add_arguments(NormalizeParam::__FIELDS__());
+
 MXNET_REGISTER_IMAGE_AUG_OP(_image_flip_left_right)
     .add_alias("_npx__image_flip_left_right")
     .describe(R"code()code" ADD_FILELINE)
@@ -243,6 +243,9 @@ NNVM_REGISTER_OP(_image_to_tensor).set_attr<FCompute>("FCompute<gpu>", ToTensorO
 
 NNVM_REGISTER_OP(_image_normalize).set_attr<FCompute>("FCompute<gpu>", NormalizeOpForward<gpu>);
 
+NNVM_REGISTER_OP(_image_to_tensor_normalize)
+    .set_attr<FCompute>("FCompute<gpu>", ToTensorNormalizeOpForward<gpu>);
+
 NNVM_REGISTER_OP(_backward_image_normalize)
     .set_attr<FCompute>("FCompute<gpu>", NormalizeOpBackward<gpu>);
 
@@ -24,6 +24,7 @@
  */
 
 #include "./instance_norm-inl.h"
+#include "./nn/group_norm_cpu.h"
 
 namespace mxnet {
 namespace op {
@@ -50,6 +51,78 @@ struct InstanceNormGrad {
   }
 };
 
+/* InstanceNorm is GroupNorm with one channel per group, so run the fused
+ * GroupNormCPUKernel on float32 data and fall back to the generic
+ * implementation otherwise.
+ */
+static void InstanceNormForwardCPU(const nnvm::NodeAttrs& attrs,
+                                   const OpContext& ctx,
+                                   const std::vector<TBlob>& in_data,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& out_data) {
+  const InstanceNormParam& param = nnvm::get<InstanceNormParam>(attrs.parsed);
+  const TBlob& data              = in_data[instance_norm::kData];
+  if (data.type_flag_ != mshadow::kFloat32 || data.ndim() < 3 || data.Size() == 0 ||
+      (req[instance_norm::kOut] != kWriteTo && req[instance_norm::kOut] != kWriteInplace)) {
+    InstanceNormForward<cpu>(attrs, ctx, in_data, req, out_data);
+    return;
+  }
+  const size_t batch    = data.shape_[0];
+  const size_t channels = data.shape_[1];
+  GroupNormCPUKernel<float, float>(batch,
+                                   channels,
+                                   1,
+                                   data.Size() / batch / channels,
+                                   param.eps,
+                                   data.dptr<float>(),
+                                   in_data[instance_norm::kGamma].dptr<float>(),
+                                   in_data[instance_norm::kBeta].dptr<float>(),
+                                   out_data[instance_norm::kOut].dptr<float>(),
+                                   out_data[instance_norm::kMean].dptr<float>(),
+                                   out_data[instance_norm::kVar].dptr<float>(),
+                                   true);
+}
+
+static void InstanceNormBackwardCPU(const nnvm::NodeAttrs& attrs,
+                                    const OpContext& ctx,
+                                    const std::vector<TBlob>& inputs,
+                                    const std::vector<OpReqType>& req,
+                                    const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  CHECK_EQ(inputs.size(), 5U);
+  CHECK_EQ(outputs.size(), 3U);
+  const InstanceNormParam& param = nnvm::get<InstanceNormParam>(attrs.parsed);
+  const TBlob& data              = inputs[3];
+  if (data.type_flag_ != kFloat32 || data.ndim() < 3 || data.Size() == 0) {
+    InstanceNormBackward<cpu>(attrs, ctx, inputs, req, outputs);
+    return;
+  }
+  const size_t batch              = data.shape_[0];
+  const size_t channels           = data.shape_[1];
+  Tensor<cpu, 1, float> workspace = ctx.requested[instance_norm::kTempSpace]
+                                        .get_space_typed<cpu, 1, float>(
+                                            Shape1(GroupNormGradCPUWorkspaceSize(batch, channels)),
+                                            ctx.get_stream<cpu>());
+  GroupNormGradCPUKernel<float, float>(batch,
+                                       channels,
+                                       1,
+                                       data.Size() / batch / channels,
+                                       inputs[0].dptr<float>(),
+                                       data.dptr<float>(),
+                                       inputs[4].dptr<float>(),
+                                       inputs[1].dptr<float>(),
+                                       inputs[2].dptr<float>(),
+                                       true,
+                                       param.eps,
+                                       outputs[instance_norm::kData].dptr<float>(),
+                                       outputs[instance_norm::kGamma].dptr<float>(),
+                                       outputs[instance_norm::kBeta].dptr<float>(),
+                                       req[instance_norm::kData],
+                                       req[instance_norm::kGamma],
+                                       req[instance_norm::kBeta],
+                                       workspace.dptr_);
+}
+
 NNVM_REGISTER_OP(InstanceNorm)
     .add_alias("_npx_instance_norm")
     .describe(R"code(Applies instance normalization to the n-dimensional input array.
@@ -121,7 +194,7 @@ Examples::
     .set_attr<mxnet::FInferShape>("FInferShape", InstanceNormShape)
     .set_attr<THasDeterministicOutput>("THasDeterministicOutput", true)
     .set_attr<nnvm::FGradient>("FGradient", InstanceNormGrad{"_backward_instance_norm"})
-    .set_attr<FCompute>("FCompute<cpu>", InstanceNormForward<cpu>);
+    .set_attr<FCompute>("FCompute<cpu>", InstanceNormForwardCPU);
 
 NNVM_REGISTER_OP(_backward_instance_norm)
     .set_num_inputs(5)
@@ -132,7 +205,7 @@ NNVM_REGISTER_OP(_backward_instance_norm)
                                   return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
                                 })
     .set_attr<nnvm::TIsBackward>("TIsBackward", true)
-    .set_attr<FCompute>("FCompute<cpu>", InstanceNormBackward<cpu>);
+    .set_attr<FCompute>("FCompute<cpu>", InstanceNormBackwardCPU);
 
 }  // namespace op
 }  // namespace mxnet
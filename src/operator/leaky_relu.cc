@@ -151,6 +151,11 @@ static bool LRChangeLayout(nnvm::NodeAttrs* attrs,
                            std::vector<alm::Transpose>* in_axes,
                            std::vector<alm::Transpose>* out_axes) {
   CHECK_EQ(target_layout, mshadow::kUNKNOWN);
+  // gamma of prelu broadcasts over the channel axis 1, the layout stays
+  if (attrs->dict["act_type"] == "prelu") {
+    out_axes->assign(1, alm::Transpose());
+    return false;
+  }
   out_axes->assign(1, alm::FactorCommonTranspose(in_axes));
   if (attrs->dict["act_type"] == "rrelu")
     out_axes->resize(2);
@@ -28,6 +28,7 @@
 #include <mxnet/op_attr_types.h>
 
 #include <algorithm>
+#include <cmath>
 
 #include "../common/cuda/utils.h"
 #include "mxnet_op.h"
@@ -729,6 +730,359 @@ LINALG_CPU_GEMM_NO_CBLAS(double)
 
 #endif  // (MSHADOW_USE_CBLAS == 0 && MSHADOW_USE_MKL == 0)
 
+//////////////////////////////// SMALL MATRICES ////////////////////////////////////
+
+// CPU-kernels for batches of many small matrices, where the per-matrix calls into
+// BLAS/LAPACK dominate the run time. The size is a template parameter so that the loops
+// unroll and a matrix is held in registers, and the batch is split over the OpenMP threads.
+// The kernels follow the conventions of the LAPACK functions they replace, leave the
+// same triangles untouched, and return false where these report an error.
+
+const int kLinalgSmallMaxSize = 16;
+
+inline bool linalg_is_small(index_t n) {
+  return n > 0 && n <= kLinalgSmallMaxSize;
+}
+
+#define LINALG_SMALL_CASE(n, N, ...) \
+  case n: {                          \
+    const int N = n;                 \
+    __VA_ARGS__                      \
+  } break;
+
+// Runs the statements with the compile time constant N set to the small size n.
+#define LINALG_SMALL_SWITCH(n, N, ...)                         \
+  switch (n) {                                                 \
+    LINALG_SMALL_CASE(1, N, __VA_ARGS__)                       \
+    LINALG_SMALL_CASE(2, N, __VA_ARGS__)                       \
+    LINALG_SMALL_CASE(3, N, __VA_ARGS__)                       \
+    LINALG_SMALL_CASE(4, N, __VA_ARGS__)                       \
+    LINALG_SMALL_CASE(5, N, __VA_ARGS__)                       \
+    LINALG_SMALL_CASE(6, N, __VA_ARGS__)                       \
+    LINALG_SMALL_CASE(7, N, __VA_ARGS__)                       \
+    LINALG_SMALL_CASE(8, N, __VA_ARGS__)                       \
+    LINALG_SMALL_CASE(9, N, __VA_ARGS__)                       \
+    LINALG_SMALL_CASE(10, N, __VA_ARGS__)                      \
+    LINALG_SMALL_CASE(11, N, __VA_ARGS__)                      \
+    LINALG_SMALL_CASE(12, N, __VA_ARGS__)                      \
+    LINALG_SMALL_CASE(13, N, __VA_ARGS__)                      \
+    LINALG_SMALL_CASE(14, N, __VA_ARGS__)                      \
+    LINALG_SMALL_CASE(15, N, __VA_ARGS__)                      \
+    LINALG_SMALL_CASE(16, N, __VA_ARGS__)                      \
+    default:                                                   \
+      LOG(FATAL) << "Matrix size " << (n) << " is not small."; \
+  }
+
+// Applies f to the indices of a batch in parallel, false if any of the calls is.
+template <typename F>
+inline bool linalg_small_batch(index_t batch_size, const F& f) {
+  bool ok               = true;
+  const int omp_threads = mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads) reduction(&& : ok)
+  for (index_t i = 0; i < batch_size; ++i) {
+    ok = f(i) && ok;
+  }
+  return ok;
+}
+
+// Loads the row-major matrix at a, or its transpose.
+template <int N, typename DType>
+inline void linalg_small_load(DType (&m)[N][N], const DType* a, index_t lda, bool trans) {
+  for (int i = 0; i < N; ++i) {
+    for (int j = 0; j < N; ++j) {
+      m[i][j] = trans ? a[j * lda + i] : a[i * lda + j];
+    }
+  }
+}
+
+// Stores the lower triangle of m to the matrix at a, or to its transpose.
+template <int N, typename DType>
+inline void linalg_small_store_lower(const DType (&m)[N][N], DType* a, index_t lda, bool trans) {
+  for (int i = 0; i < N; ++i) {
+    for (int j = 0; j <= i; ++j) {
+      (trans ? a[j * lda + i] : a[i * lda + j]) = m[i][j];
+    }
+  }
+}
+
+// Inverts the lower triangle of m into x, false if it is singular.
+template <int N, typename DType>
+inline bool linalg_small_trtri_lower(const DType (&m)[N][N], DType (&x)[N][N]) {
+  for (int j = 0; j < N; ++j) {
+    if (m[j][j] == DType(0))
+      return false;
+  }
+  for (int j = 0; j < N; ++j) {
+    x[j][j] = DType(1) / m[j][j];
+    for (int i = j + 1; i < N; ++i) {
+      DType sum(0);
+      for (int k = j; k < i; ++k) {
+        sum += m[i][k] * x[k][j];
+      }
+      x[i][j] = -sum / m[i][i];
+    }
+  }
+  return true;
+}
+
+// Cholesky factorization as "potrf" of a row-major matrix.
+template <int N, typename DType>
+inline bool linalg_small_potrf(DType* a, index_t lda, bool lower) {
+  // the upper factor is the transpose of the lower one of the transposed matrix
+  DType m[N][N];
+  linalg_small_load(m, a, lda, !lower);
+  for (int j = 0; j < N; ++j) {
+    DType d(m[j][j]);
+    for (int k = 0; k < j; ++k) {
+      d -= m[j][k] * m[j][k];
+    }
+    if (!(d > DType(0)))
+      return false;
+    d       = std::sqrt(d);
+    m[j][j] = d;
+    for (int i = j + 1; i < N; ++i) {
+      DType v(m[i][j]);
+      for (int k = 0; k < j; ++k) {
+        v -= m[i][k] * m[j][k];
+      }
+      m[i][j] = v / d;
+    }
+  }
+  linalg_small_store_lower(m, a, lda, !lower);
+  return true;
+}
+
+// Inverse from the Cholesky factor as "potri" of a row-major matrix.
+template <int N, typename DType>
+inline bool linalg_small_potri(DType* a, index_t lda, bool lower) {
+  // inv(L * L^T) = inv(L)^T * inv(L), and the same holds for U^T * U with L = U^T
+  DType m[N][N], x[N][N];
+  linalg_small_load(m, a, lda, !lower);
+  if (!linalg_small_trtri_lower(m, x))
+    return false;
+  for (int i = 0; i < N; ++i) {
+    for (int j = 0; j <= i; ++j) {
+      DType sum(0);
+      for (int k = i; k < N; ++k) {
+        sum += x[k][i] * x[k][j];
+      }
+      m[i][j] = sum;
+    }
+  }
+  linalg_small_store_lower(m, a, lda, !lower);
+  return true;
+}
+
+// B = alpha * op(A)^-1 * B or B = alpha * B * op(A)^-1 as "trsm" of row-major matrices,
+// A being the small one.
+template <int N, typename DType>
+inline void linalg_small_trsm(const DType* a,
+                              index_t lda,
+                              DType* b,
+                              index_t ldb,
+                              index_t m,
+                              index_t n,
+                              DType alpha,
+                              bool rightside,
+                              bool lower,
+                              bool transpose) {
+  // X * op(A) = B is op(A)^T * X^T = B^T, so both sides solve T * x = alpha * v for vectors
+  // v, being the columns of B on the left side and its rows on the right side.
+  const bool trans    = transpose != rightside;
+  const bool tlower   = lower != trans;
+  const index_t count = rightside ? m : n;
+  const index_t inc   = rightside ? 1 : ldb;
+  const index_t step  = rightside ? ldb : 1;
+  DType t[N][N];
+  linalg_small_load(t, a, lda, trans);
+  for (index_t v = 0; v < count; ++v) {
+    DType* p = b + v * step;
+    DType x[N];
+    for (int i = 0; i < N; ++i) {
+      x[i] = alpha * p[i * inc];
+    }
+    if (tlower) {
+      for (int i = 0; i < N; ++i) {
+        for (int k = 0; k < i; ++k) {
+          x[i] -= t[i][k] * x[k];
+        }
+        x[i] /= t[i][i];
+      }
+    } else {
+      for (int i = N - 1; i >= 0; --i) {
+        for (int k = i + 1; k < N; ++k) {
+          x[i] -= t[i][k] * x[k];
+        }
+        x[i] /= t[i][i];
+      }
+    }
+    for (int i = 0; i < N; ++i) {
+      p[i * inc] = x[i];
+    }
+  }
+}
+
+// LU factorization with partial pivoting as "getrf" of a col-major matrix, so the rows of
+// m are the columns of the matrix. Returns the info of "getrf".
+template <int N, typename DType, typename IndexT>
+inline int linalg_small_getrf(DType* a, index_t lda, IndexT* pivot) {
+  DType m[N][N];
+  linalg_small_load(m, a, lda, false);
+  int info(0);
+  for (int k = 0; k < N; ++k) {
+    int p(k);
+    DType pmax(std::abs(m[k][k]));
+    for (int r = k + 1; r < N; ++r) {
+      if (std::abs(m[k][r]) > pmax) {
+        p    = r;
+        pmax = std::abs(m[k][r]);
+      }
+    }
+    pivot[k] = p + 1;
+    if (m[k][p] != DType(0)) {
+      if (p != k) {
+        for (int c = 0; c < N; ++c) {
+          std::swap(m[c][k], m[c][p]);
+        }
+      }
+      for (int r = k + 1; r < N; ++r) {
+        m[k][r] /= m[k][k];
+      }
+    } else if (info == 0) {
+      info = k + 1;
+    }
+    for (int c = k + 1; c < N; ++c) {
+      for (int r = k + 1; r < N; ++r) {
+        m[c][r] -= m[k][r] * m[c][k];
+      }
+    }
+  }
+  for (int c = 0; c < N; ++c) {
+    for (int r = 0; r < N; ++r) {
+      a[c * lda + r] = m[c][r];
+    }
+  }
+  return info;
+}
+
+// Inverse from the LU factorization as "getri" of a col-major matrix.
+template <int N, typename DType, typename IndexT>
+inline bool linalg_small_getri(DType* a, index_t lda, const IndexT* pivot) {
+  // inv(P^T * L * U) = inv(U) * inv(L) * P, with [r][c] indexing the matrices from here on
+  DType lu[N][N], inv_u[N][N], inv_l[N][N];
+  linalg_small_load(lu, a, lda, true);
+  for (int c = 0; c < N; ++c) {
+    if (lu[c][c] == DType(0))
+      return false;
+    inv_u[c][c] = DType(1) / lu[c][c];
+    for (int r = c - 1; r >= 0; --r) {
+      DType sum(0);
+      for (int k = r + 1; k <= c; ++k) {
+        sum += lu[r][k] * inv_u[k][c];
+      }
+      inv_u[r][c] = -sum / lu[r][r];
+    }
+    inv_l[c][c] = DType(1);
+    for (int r = c + 1; r < N; ++r) {
+      DType sum(0);
+      for (int k = c; k < r; ++k) {
+        sum += lu[r][k] * inv_l[k][c];
+      }
+      inv_l[r][c] = -sum;
+    }
+  }
+  // the product goes to the rows of lu, which are the columns of the result
+  for (int r = 0; r < N; ++r) {
+    for (int c = 0; c < N; ++c) {
+      DType sum(0);
+      for (int k = std::max(r, c); k < N; ++k) {
+        sum += inv_u[r][k] * inv_l[k][c];
+      }
+      lu[c][r] = sum;
+    }
+  }
+  for (int k = N - 2; k >= 0; --k) {
+    const int p(pivot[k] - 1);
+    if (p != k) {
+      for (int r = 0; r < N; ++r) {
+        std::swap(lu[k][r], lu[p][r]);
+      }
+    }
+  }
+  for (int c = 0; c < N; ++c) {
+    for (int r = 0; r < N; ++r) {
+      a[c * lda + r] = lu[c][r];
+    }
+  }
+  return true;
+}
+
+template <int N, typename DType>
+inline bool linalg_small_batch_potrf(const Tensor<cpu, 3, DType>& A, bool lower) {
+  return linalg_small_batch(
+      A.size(0), [&](index_t i) { return linalg_small_potrf<N>(A[i].dptr_, A.stride_, lower); });
+}
+
+template <int N, typename DType>
+inline bool linalg_small_batch_potri(const Tensor<cpu, 3, DType>& A, bool lower) {
+  return linalg_small_batch(
+      A.size(0), [&](index_t i) { return linalg_small_potri<N>(A[i].dptr_, A.stride_, lower); });
+}
+
+template <int N, typename DType>
+inline void linalg_small_batch_trsm(const Tensor<cpu, 3, DType>& A,
+                                    const Tensor<cpu, 3, DType>& B,
+                                    DType alpha,
+                                    bool rightside,
+                                    bool lower,
+                                    bool transpose) {
+  linalg_small_batch(A.size(0), [&](index_t i) {
+    linalg_small_trsm<N>(A[i].dptr_,
+                         A.stride_,
+                         B[i].dptr_,
+                         B.stride_,
+                         B.size(1),
+                         B.size(2),
+                         alpha,
+                         rightside,
+                         lower,
+                         transpose);
+    return true;
+  });
+}
+
+// Batched "getrf" of square matrices, false if one is singular and check_singular set.
+template <int N, typename DType, typename IndexT>
+inline bool linalg_small_batch_getrf(const Tensor<cpu, 3, DType>& A,
+                                     const Tensor<cpu, 2, IndexT>& pivot,
+                                     bool check_singular) {
+  return linalg_small_batch(A.size(0), [&](index_t i) {
+    const int info(linalg_small_getrf<N>(A[i].dptr_, A.stride_, pivot[i].dptr_));
+    return !check_singular || info == 0;
+  });
+}
+
+// Batched inverse by "getrf" and "getri" in place, false if a matrix is singular.
+template <int N, typename DType>
+inline bool linalg_small_batch_inverse(const Tensor<cpu, 3, DType>& A) {
+  return linalg_small_batch(A.size(0), [&](index_t i) {
+    lapack_index_t pivot[N];
+    return linalg_small_getrf<N>(A[i].dptr_, A.stride_, pivot) == 0 &&
+           linalg_small_getri<N>(A[i].dptr_, A.stride_, pivot);
+  });
+}
+
+// Batched "getri" of the factorized matrices whose determinant is not zero_det.
+template <int N, typename DType, typename IndexT>
+inline bool linalg_small_batch_getri(const Tensor<cpu, 3, DType>& LU,
+                                     const Tensor<cpu, 2, IndexT>& pivot,
+                                     const Tensor<cpu, 1, DType>& det,
+                                     const DType zero_det) {
+  return linalg_small_batch(LU.size(0), [&](index_t i) {
+    return det[i] == zero_det || linalg_small_getri<N>(LU[i].dptr_, LU.stride_, pivot[i].dptr_);
+  });
+}
+
 //////////////////////////////// TRSM ////////////////////////////////////////////
 
 // CPU/GPU-versions of BLAS3 function "trsm". Please refer to the BLAS3-documentation
@@ -776,19 +1130,26 @@ inline void check_trsm(const Tensor<xpu, 2, DType>& A,
                   B.stride_);                                         \
   }
 
-#define LINALG_XPU_BATCH_TRSM(xpu, DType)                                   \
-  template <>                                                               \
-  inline void linalg_batch_trsm<xpu, DType>(const Tensor<xpu, 3, DType>& A, \
-                                            const Tensor<xpu, 3, DType>& B, \
-                                            DType alpha,                    \
-                                            bool rightside,                 \
-                                            bool lower,                     \
-                                            bool transpose,                 \
-                                            Stream<xpu>* s) {               \
-    linalg_check_batch_size(A.size(0), B.size(0), B.size(0));               \
-    for (index_t i = 0; i < A.size(0); ++i) {                               \
-      linalg_trsm(A[i], B[i], alpha, rightside, lower, transpose, s);       \
-    }                                                                       \
+#define LINALG_CPU_BATCH_TRSM(DType)                                          \
+  template <>                                                                 \
+  inline void linalg_batch_trsm<cpu, DType>(const Tensor<cpu, 3, DType>& A,   \
+                                            const Tensor<cpu, 3, DType>& B,   \
+                                            DType alpha,                      \
+                                            bool rightside,                   \
+                                            bool lower,                       \
+                                            bool transpose,                   \
+                                            Stream<cpu>* s) {                 \
+    linalg_check_batch_size(A.size(0), B.size(0), B.size(0));                 \
+    if (linalg_is_small(A.size(1))) {                                         \
+      check_trsm(A[0], B[0], alpha, rightside, lower, transpose);             \
+      LINALG_SMALL_SWITCH(A.size(1), N, {                                     \
+        linalg_small_batch_trsm<N>(A, B, alpha, rightside, lower, transpose); \
+      })                                                                      \
+      return;                                                                 \
+    }                                                                         \
+    for (index_t i = 0; i < A.size(0); ++i) {                                 \
+      linalg_trsm(A[i], B[i], alpha, rightside, lower, transpose, s);         \
+    }                                                                         \
   }
 
 #else
@@ -805,15 +1166,15 @@ inline void check_trsm(const Tensor<xpu, 2, DType>& A,
     LOG(FATAL) << "linalg_trsm not implemented, needs cblas!";        \
   }
 
-#define LINALG_XPU_BATCH_TRSM(xpu, DType)                                   \
+#define LINALG_CPU_BATCH_TRSM(DType)                                        \
   template <>                                                               \
-  inline void linalg_batch_trsm<xpu, DType>(const Tensor<xpu, 3, DType>& A, \
-                                            const Tensor<xpu, 3, DType>& B, \
+  inline void linalg_batch_trsm<cpu, DType>(const Tensor<cpu, 3, DType>& A, \
+                                            const Tensor<cpu, 3, DType>& B, \
                                             DType alpha,                    \
                                             bool rightside,                 \
                                             bool lower,                     \
                                             bool transpose,                 \
-                                            Stream<xpu>* s) {               \
+                                            Stream<cpu>* s) {               \
     LOG(FATAL) << "linalg_batch_trsm not implemented, needs cblas!";        \
   }
 
@@ -822,11 +1183,25 @@ inline void check_trsm(const Tensor<xpu, 2, DType>& A,
 LINALG_CPU_TRSM(strsm, float)
 LINALG_CPU_TRSM(dtrsm, double)
 
-LINALG_XPU_BATCH_TRSM(cpu, float)
-LINALG_XPU_BATCH_TRSM(cpu, double)
+LINALG_CPU_BATCH_TRSM(float)
+LINALG_CPU_BATCH_TRSM(double)
 
 #ifdef __CUDACC__
 
+// The batched routines of cuBLAS and cuSolver must have DType *matrices[] as input
+// to store the pointers of each batch matrix. This kernel is used to build the
+// pointer array.
+struct set_matrix {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(int i, DType** p, DType* m, int step) {
+    p[i] = m + i * step;
+  }
+};
+
+// Largest matrices for which the batched routines of cuBLAS and cuSolver are used,
+// of a single call for the batch instead of one per matrix.
+const int kLinalgGPUBatchedMaxSize = 32;
+
 // cublas col-major processing accounted for by switching sides and fill mode
 
 #define LINALG_GPU_TRSM(fname, DType)                                                    \
@@ -858,8 +1233,50 @@ LINALG_XPU_BATCH_TRSM(cpu, double)
 LINALG_GPU_TRSM(Strsm, float)
 LINALG_GPU_TRSM(Dtrsm, double)
 
-LINALG_XPU_BATCH_TRSM(gpu, float)
-LINALG_XPU_BATCH_TRSM(gpu, double)
+#define LINALG_GPU_BATCH_TRSM(fname, DType)                                               \
+  template <>                                                                             \
+  inline void linalg_batch_trsm<gpu, DType>(const Tensor<gpu, 3, DType>& A,               \
+                                            const Tensor<gpu, 3, DType>& B,               \
+                                            DType alpha,                                  \
+                                            bool rightside,                               \
+                                            bool lower,                                   \
+                                            bool transpose,                               \
+                                            Stream<gpu>* s) {                             \
+    using namespace mxnet;                                                                \
+    using namespace mxnet::op::mxnet_op;                                                  \
+    linalg_check_batch_size(A.size(0), B.size(0), B.size(0));                             \
+    if (A.size(1) > kLinalgGPUBatchedMaxSize) {                                           \
+      for (index_t i = 0; i < A.size(0); ++i) {                                           \
+        linalg_trsm(A[i], B[i], alpha, rightside, lower, transpose, s);                   \
+      }                                                                                   \
+      return;                                                                             \
+    }                                                                                     \
+    CHECK_NOTNULL(s);                                                                     \
+    check_trsm(A[0], B[0], alpha, rightside, lower, transpose);                           \
+    EPHEMERAL_GPU_STORAGE_ALLOC(linalg_batch_trsm, A_ptr_buf, DType*, A.size(0));         \
+    EPHEMERAL_GPU_STORAGE_ALLOC(linalg_batch_trsm, B_ptr_buf, DType*, B.size(0));         \
+    DType** A_ptr = static_cast<DType**>(A_ptr_buf.dptr);                                 \
+    DType** B_ptr = static_cast<DType**>(B_ptr_buf.dptr);                                 \
+    Kernel<set_matrix, gpu>::Launch(s, A.size(0), A_ptr, A.dptr_, A.size(1) * A.stride_); \
+    Kernel<set_matrix, gpu>::Launch(s, B.size(0), B_ptr, B.dptr_, B.size(1) * B.stride_); \
+    CUBLAS_CALL(cublas##fname(Stream<gpu>::GetBlasHandle(s),                              \
+                              (rightside ? CUBLAS_SIDE_LEFT : CUBLAS_SIDE_RIGHT),         \
+                              (lower ? CUBLAS_FILL_MODE_UPPER : CUBLAS_FILL_MODE_LOWER),  \
+                              (transpose ? CUBLAS_OP_T : CUBLAS_OP_N),                    \
+                              CUBLAS_DIAG_NON_UNIT,                                       \
+                              B.size(2),                                                  \
+                              B.size(1),                                                  \
+                              &alpha,                                                     \
+                              const_cast<const DType**>(A_ptr),                           \
+                              A.stride_,                                                  \
+                              B_ptr,                                                      \
+                              B.stride_,                                                  \
+                              A.size(0)));                                                \
+    Storage::Get()->Free(A_ptr_buf);                                                      \
+    Storage::Get()->Free(B_ptr_buf);                                                      \
+  }
+LINALG_GPU_BATCH_TRSM(StrsmBatched, float)
+LINALG_GPU_BATCH_TRSM(DtrsmBatched, double)
 
 #endif  // __CUDACC__
 
@@ -1014,13 +1431,20 @@ inline void check_potrf(const Tensor<xpu, 2, DType>& A, bool lower) {
 LINALG_CPU_POTRF(spotrf, float)
 LINALG_CPU_POTRF(dpotrf, double)
 
-#define LINALG_CPU_BATCH_POTRF(DType)                               \
-  template <>                                                       \
-  inline void linalg_batch_potrf<cpu, DType>(                       \
-      const Tensor<cpu, 3, DType>& A, bool lower, Stream<cpu>* s) { \
-    for (index_t i = 0; i < A.size(0); ++i) {                       \
-      linalg_potrf(A[i], lower);                                    \
-    }                                                               \
+#define LINALG_CPU_BATCH_POTRF(DType)                                                    \
+  template <>                                                                            \
+  inline void linalg_batch_potrf<cpu, DType>(                                            \
+      const Tensor<cpu, 3, DType>& A, bool lower, Stream<cpu>* s) {                      \
+    if (linalg_is_small(A.size(1))) {                                                    \
+      check_potrf(A[0], lower);                                                          \
+      bool ok(true);                                                                     \
+      LINALG_SMALL_SWITCH(A.size(1), N, { ok = linalg_small_batch_potrf<N>(A, lower); }) \
+      CHECK(ok) << "potrf failed on cpu. " << potrf_errstr;                              \
+      return;                                                                            \
+    }                                                                                    \
+    for (index_t i = 0; i < A.size(0); ++i) {                                            \
+      linalg_potrf(A[i], lower);                                                         \
+    }                                                                                    \
   }
 LINALG_CPU_BATCH_POTRF(float)
 LINALG_CPU_BATCH_POTRF(double)
@@ -1069,6 +1493,44 @@ LINALG_GPU_BUFFSIZE_POTRF(DnDpotrf_bufferSize, double)
 LINALG_GPU_POTRF(DnSpotrf, float)
 LINALG_GPU_POTRF(DnDpotrf, double)
 
+// "potrfBatched" of cuSolver factorizes the whole batch of small matrices in one call.
+#if CUDA_VERSION >= 9010
+
+#define LINALG_GPU_POTRF_BATCHED(fname, DType)                                               \
+  inline void linalg_batch_potrf_batched(                                                    \
+      const Tensor<gpu, 3, DType>& A, bool lower, Stream<gpu>* s) {                          \
+    using namespace mxnet;                                                                   \
+    using namespace mxnet::op::mxnet_op;                                                     \
+    EPHEMERAL_GPU_STORAGE_ALLOC(linalg_batch_potrf, info, int, A.size(0));                   \
+    EPHEMERAL_GPU_STORAGE_ALLOC(linalg_batch_potrf, A_ptr_buf, DType*, A.size(0));           \
+    DType** A_ptr = static_cast<DType**>(A_ptr_buf.dptr);                                    \
+    Kernel<set_matrix, gpu>::Launch(s, A.size(0), A_ptr, A.dptr_, A.size(1) * A.stride_);    \
+    CUSOLVER_CALL(cusolver##fname(Stream<gpu>::GetSolverHandle(s),                           \
+                                  (lower ? CUBLAS_FILL_MODE_UPPER : CUBLAS_FILL_MODE_LOWER), \
+                                  A.size(1),                                                 \
+                                  A_ptr,                                                     \
+                                  A.stride_,                                                 \
+                                  static_cast<int*>(info.dptr),                              \
+                                  A.size(0)));                                               \
+    Storage::Get()->Free(info);                                                              \
+    Storage::Get()->Free(A_ptr_buf);                                                         \
+  }
+
+#else
+
+#define LINALG_GPU_POTRF_BATCHED(fname, DType)                      \
+  inline void linalg_batch_potrf_batched(                           \
+      const Tensor<gpu, 3, DType>& A, bool lower, Stream<gpu>* s) { \
+    for (mshadow::index_t i = 0; i < A.size(0); ++i) {              \
+      linalg_potrf(A[i], lower, s);                                 \
+    }                                                               \
+  }
+
+#endif  // CUDA_VERSION >= 9010
+
+LINALG_GPU_POTRF_BATCHED(DnSpotrfBatched, float)
+LINALG_GPU_POTRF_BATCHED(DnDpotrfBatched, double)
+
 #define LINALG_GPU_BATCH_POTRF(fname, DType)                                                   \
   template <>                                                                                  \
   inline void linalg_batch_potrf<gpu, DType>(                                                  \
@@ -1078,6 +1540,10 @@ LINALG_GPU_POTRF(DnDpotrf, double)
     CHECK_NOTNULL(s);                                                                          \
     CHECK_GT(A.size(0), 0);                                                                    \
     check_potrf(A[0], lower);                                                                  \
+    if (A.size(1) <= kLinalgGPUBatchedMaxSize) {                                               \
+      linalg_batch_potrf_batched(A, lower, s);                                                 \
+      return;                                                                                  \
+    }                                                                                          \
     int buffsize(linalg_potrf_buffsize(A[0], lower, s));                                       \
     EPHEMERAL_GPU_STORAGE_ALLOC(linalg_batch_potrf, buffer, DType, buffsize);                  \
     EPHEMERAL_GPU_STORAGE_ALLOC(linalg_batch_potrf, info, int, 1);                             \
@@ -1127,13 +1593,20 @@ inline void check_potri(const Tensor<xpu, 2, DType>& A, bool lower) {
 LINALG_CPU_POTRI(spotri, float)
 LINALG_CPU_POTRI(dpotri, double)
 
-#define LINALG_CPU_BATCH_POTRI(DType)                               \
-  template <>                                                       \
-  inline void linalg_batch_potri<cpu, DType>(                       \
-      const Tensor<cpu, 3, DType>& A, bool lower, Stream<cpu>* s) { \
-    for (index_t i = 0; i < A.size(0); ++i) {                       \
-      linalg_potri(A[i], lower);                                    \
-    }                                                               \
+#define LINALG_CPU_BATCH_POTRI(DType)                                                    \
+  template <>                                                                            \
+  inline void linalg_batch_potri<cpu, DType>(                                            \
+      const Tensor<cpu, 3, DType>& A, bool lower, Stream<cpu>* s) {                      \
+    if (linalg_is_small(A.size(1))) {                                                    \
+      check_potri(A[0], lower);                                                          \
+      bool ok(true);                                                                     \
+      LINALG_SMALL_SWITCH(A.size(1), N, { ok = linalg_small_batch_potri<N>(A, lower); }) \
+      CHECK(ok) << "potri failed on cpu. " << potri_errstr;                              \
+      return;                                                                            \
+    }                                                                                    \
+    for (index_t i = 0; i < A.size(0); ++i) {                                            \
+      linalg_potri(A[i], lower);                                                         \
+    }                                                                                    \
   }
 LINALG_CPU_BATCH_POTRI(float)
 LINALG_CPU_BATCH_POTRI(double)
@@ -1844,6 +2317,14 @@ LINALG_CPU_GETRF(dgetrf, double)
                                              const Tensor<cpu, 2, IndexT>& pivot, \
                                              bool check_singular,                 \
                                              Stream<cpu>* s) {                    \
+    if (linalg_is_small(A.size(1)) && A.size(1) == A.size(2)) {                   \
+      bool ok(true);                                                              \
+      LINALG_SMALL_SWITCH(A.size(1), N, {                                         \
+        ok = linalg_small_batch_getrf<N>(A, pivot, check_singular);               \
+      })                                                                          \
+      CHECK(ok) << "the input matrix is non-convertible";                         \
+      return;                                                                     \
+    }                                                                             \
     for (IndexT i = 0; i < A.size(0); ++i) {                                      \
       linalg_getrf(A[i], pivot[i], check_singular);                               \
     }                                                                             \
@@ -1854,16 +2335,6 @@ LINALG_CPU_BATCH_GETRF(dgetrf, double, LapackIndex<cpu>::IndexT)
 
 #ifdef __CUDACC__
 
-// "getrfBatched" and "getriBatched" in cuBLAS must have DType *matrices[] as input
-// to store the pointers of each batch matrix. This kernel is used to build the
-// pointer array.
-struct set_matrix {
-  template <typename DType>
-  MSHADOW_XINLINE static void Map(int i, DType** p, DType* m, int step) {
-    p[i] = m + i * step;
-  }
-};
-
 // GETRF only available with cuda8 or higher.
 #if CUDA_VERSION >= 8000
 
@@ -2026,6 +2497,14 @@ LINALG_GPU_BATCH_GETRI(DgetriBatched, double)
                                                const Tensor<xpu, 3, DType>& B,                     \
                                                const mxnet::OpContext& ctx) {                      \
     Stream<xpu>* s = ctx.get_stream<xpu>();                                                        \
+    if (linalg_is_small(A.size(1))) {                                                              \
+      if (A.dptr_ != B.dptr_)                                                                      \
+        Copy(A, B, s);                                                                             \
+      bool ok(true);                                                                               \
+      LINALG_SMALL_SWITCH(A.size(1), N, { ok = linalg_small_batch_inverse<N>(A); })                \
+      CHECK(ok) << "the input matrix is non-convertible";                                          \
+      return;                                                                                      \
+    }                                                                                              \
     lapack_index_t lwork(linalg_getri_workspace_query(A[0], s));                                   \
     lapack_index_t workspace_size =                                                                \
         (sizeof(lapack_index_t) * A.size(1) + sizeof(DType) * lwork + sizeof(DType) - 1) /         \
@@ -2101,6 +2580,14 @@ LINALG_GPU_BATCH_INVERSE(gpu, double)
                                                            const DType zero_det,                \
                                                            const mxnet::OpContext& ctx) {       \
     Stream<xpu>* s = ctx.get_stream<xpu>();                                                     \
+    if (linalg_is_small(LU.size(1))) {                                                          \
+      bool ok(true);                                                                            \
+      LINALG_SMALL_SWITCH(LU.size(1), N, {                                                      \
+        ok = linalg_small_batch_getri<N>(LU, pivot, det, zero_det);                             \
+      })                                                                                        \
+      CHECK(ok) << "getri failed on cpu.";                                                      \
+      return;                                                                                   \
+    }                                                                                           \
     lapack_index_t lwork(linalg_getri_workspace_query(LU[0], s));                               \
     Tensor<xpu, 1, DType> work =                                                                \
         ctx.requested[0].get_space_typed<xpu, 1, DType>(Shape1(lwork), s);                      \
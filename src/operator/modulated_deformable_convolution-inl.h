@@ -25,6 +25,7 @@
 #include "./operator_common.h"
 #include "./nn/im2col.h"
 #include "./contrib/nn/modulated_deformable_im2col.h"
+#include "./contrib/nn/deformable_conv_implicit_gemm.h"
 #include "./linalg.h"
 
 namespace mxnet {
@@ -116,73 +117,25 @@ class ModulatedDeformableConvolutionOp : public Operator {
                in_data[dmconv::kMask].shape_,
                out_data[dmconv::kOut].shape_);
     Stream<xpu>* s = ctx.get_stream<xpu>();
-    // allocate workspace for col_buffer
-    Tensor<xpu, 1, DType> workspace =
-        ctx.requested[dmconv::kTempSpace].get_space_typed<xpu, 1, DType>(
-            Shape1(col_buffer_size_ + num_ * output_dim_), s);
-    // calculate the shape of col_buffer
-    mxnet::TShape col_buffer_shape(num_spatial_axes_ + 2, -1);
-    col_buffer_shape[0] = conv_in_channels_ * param_.kernel.Size();
-    //  for (index_t i = 1; i < col_buffer_shape.ndim(); ++i) {
-    //  col_buffer_shape[i] = out_data[0].shape_[i + 1];
-    col_buffer_shape[1] = im2col_step_;
-    for (index_t i = 2; i < col_buffer_shape.ndim(); ++i) {
-      col_buffer_shape[i] = out_data[0].shape_[i];
-    }
-    // create a column buffer using workspace and col_buffer_shape
-    TBlob col_buffer(workspace.dptr_, col_buffer_shape, xpu::kDevMask, DataType<DType>::kFlag);
-    mxnet::TShape output_buffer_shape(1, -1);
-    output_buffer_shape[0] = num_ * output_dim_;
-    TBlob output_buffer(workspace.dptr_ + col_buffer_size_,
-                        output_buffer_shape,
-                        xpu::kDevMask,
-                        DataType<DType>::kFlag);
-
-    // initialize weight and col_buffer 3D tensors for using gemm
-    index_t M = conv_out_channels_ / group_;
-    index_t N = im2col_step_ * conv_out_spatial_dim_;
-    index_t K = kernel_dim_;
-    Tensor<xpu, 3, DType> weight_3d =
-        in_data[dmconv::kWeight].get_with_shape<xpu, 3, DType>(Shape3(group_, M, K), s);
-    Tensor<xpu, 3, DType> col_buffer_3d =
-        col_buffer.get_with_shape<xpu, 3, DType>(Shape3(group_, K, N), s);
-    Tensor<xpu, 4, DType> output_4d =
-        output_buffer.get_with_shape<xpu, 4, DType>(Shape4(num_ / im2col_step_, group_, M, N), s);
-    for (index_t n = 0; n < num_ / im2col_step_; ++n) {
-      // transform image to col_buffer in order to use gemm
-      modulated_deformable_im2col(
-          s,
-          in_data[dmconv::kData].dptr<DType>() + n * im2col_step_ * input_dim_,
-          in_data[dmconv::kOffset].dptr<DType>() + n * im2col_step_ * input_offset_dim_,
-          in_data[dmconv::kMask].dptr<DType>() + n * im2col_step_ * input_mask_dim_,
-          in_data[dmconv::kData].shape_,
-          col_buffer.shape_,
-          param_.kernel,
-          param_.pad,
-          param_.stride,
-          param_.dilate,
-          param_.num_deformable_group,
-          col_buffer.dptr<DType>());
-      Tensor<xpu, 3, DType> output_3d = output_4d[n];
-      for (index_t g = 0; g < group_; ++g) {
-        // Legacy approach shown here for comparison:
-        //   Assign(output_3d[g], req[dmconv::kOut], dot(weight_3d[g], col_buffer_3d[g]));
-        linalg_gemm(weight_3d[g], col_buffer_3d[g], output_3d[g], false, false, s, kWriteTo);
-      }
-    }
-    Tensor<xpu, 4, DType> trans_output_4d = output_buffer.get_with_shape<xpu, 4, DType>(
-        Shape4(num_ / im2col_step_, conv_out_channels_, im2col_step_, conv_out_spatial_dim_), s);
-    Tensor<xpu, 4, DType> original_output_4d = out_data[dmconv::kOut].get_with_shape<xpu, 4, DType>(
-        Shape4(num_ / im2col_step_, im2col_step_, conv_out_channels_, conv_out_spatial_dim_), s);
-    original_output_4d = swapaxis<2, 1>(trans_output_4d);
-
-    if (bias_term_) {
-      Tensor<xpu, 1, DType> bias      = in_data[dmconv::kBias].get<xpu, 1, DType>(s);
-      Tensor<xpu, 3, DType> output_3d = out_data[dmconv::kOut].get_with_shape<xpu, 3, DType>(
-          Shape3(num_, conv_out_channels_, conv_out_spatial_dim_), s);
-      // has bias term, broadcast it to the same shape of output_3d in channel dim
-      output_3d += mshadow::expr::broadcast<1>(bias, output_3d.shape_);
-    }
+    // the im2col matrix is sampled tile by tile within the GEMM, so that no workspace is needed
+    // and the output is written in NCHW for the whole batch at once, whatever im2col_step
+    const DeformableConvGeometry geo(in_data[dmconv::kData].shape_,
+                                     out_data[dmconv::kOut].shape_,
+                                     param_.kernel,
+                                     param_.pad,
+                                     param_.stride,
+                                     param_.dilate,
+                                     group_,
+                                     param_.num_deformable_group);
+    deformable_conv_implicit_gemm<true>(
+        s,
+        geo,
+        in_data[dmconv::kData].dptr<DType>(),
+        in_data[dmconv::kOffset].dptr<DType>(),
+        in_data[dmconv::kMask].dptr<DType>(),
+        in_data[dmconv::kWeight].dptr<DType>(),
+        bias_term_ ? in_data[dmconv::kBias].dptr<DType>() : nullptr,
+        out_data[dmconv::kOut].dptr<DType>());
   }
 
   virtual void Backward(const OpContext& ctx,
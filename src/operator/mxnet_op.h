@@ -33,6 +33,7 @@
 #include <limits>
 #include "./operator_tune.h"
 #include "../engine/openmp.h"
+#include "../engine/parallel_for.h"
 
 #ifdef __CUDACC__
 #include "../common/cuda/utils.h"
@@ -1011,23 +1012,15 @@ struct Kernel<OP, cpu> {
    */
   template <typename... Args>
   inline static bool Launch(mshadow::Stream<cpu>*, const size_t N, Args... args) {
-#ifdef _OPENMP
-    const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
-    if (omp_threads < 2) {
-      for (size_t i = 0; i < N; ++i) {
-        OP::Map(i, args...);
-      }
-    } else {
-#pragma omp parallel for num_threads(omp_threads)
-      for (index_t i = 0; i < static_cast<index_t>(N); ++i) {
-        OP::Map(i, args...);
-      }
-    }
-#else
-    for (size_t i = 0; i < N; ++i) {
-      OP::Map(i, args...);
-    }
-#endif
+    engine::ParallelFor(0,
+                        N,
+                        1,
+                        engine::OpenMP::Get()->GetRecommendedOMPThreadCount(),
+                        [&](const index_t begin, const index_t end) {
+                          for (index_t i = begin; i < end; ++i) {
+                            OP::Map(i, args...);
+                          }
+                        });
     return true;
   }
 
@@ -1042,9 +1035,18 @@ struct Kernel<OP, cpu> {
    */
   template <typename... Args>
   inline static bool LaunchDynamic(mshadow::Stream<cpu>*, const int64_t N, Args... args) {
-#ifdef _OPENMP
     const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount(false);
-    if (omp_threads < 2) {
+    if (engine::ParallelRuntime::Get()->enabled()) {
+      // the pool balances the chunks between its threads
+      engine::ParallelFor(0, N, 1, omp_threads, [&](const int64_t begin, const int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          OP::Map(i, args...);
+        }
+      });
+      return true;
+    }
+#ifdef _OPENMP
+    if (omp_threads < 2 || engine::ParallelRuntime::InParallelRegion()) {
       for (int64_t i = 0; i < N; ++i) {
         OP::Map(i, args...);
       }
@@ -1075,49 +1077,41 @@ struct Kernel<OP, cpu> {
    */
   template <typename PRIMITIVE_OP, typename DType, typename... Args>
   static void LaunchTuned(mshadow::Stream<cpu>*, const size_t N, Args... args) {
-#ifdef _OPENMP
     const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
-    if (omp_threads < 2 ||
-        !tuned_op<PRIMITIVE_OP, DType>::UseOMP(N, static_cast<size_t>(omp_threads))) {
-      for (size_t i = 0; i < N; ++i) {
-        OP::Map(i, args...);
-      }
-    } else {
-#pragma omp parallel for num_threads(omp_threads)
-      for (index_t i = 0; i < static_cast<index_t>(N); ++i) {
-        OP::Map(i, args...);
-      }
-    }
+#ifdef _OPENMP
+    const bool parallel =
+        omp_threads >= 2 &&
+        tuned_op<PRIMITIVE_OP, DType>::UseOMP(N, static_cast<size_t>(omp_threads));
 #else
-    for (size_t i = 0; i < N; ++i) {
-      OP::Map(i, args...);
-    }
+    const bool parallel = omp_threads >= 2;
 #endif
+    engine::ParallelFor(0,
+                        N,
+                        1,
+                        parallel ? omp_threads : 1,
+                        [&](const index_t begin, const index_t end) {
+                          for (index_t i = begin; i < end; ++i) {
+                            OP::Map(i, args...);
+                          }
+                        });
   }
 
   /*!
    * \brief Launch custom-tuned kernel where each thread is set to
    *        operate on a contiguous partition
-   * \tparam Args Varargs type to eventually pass to the OP::Map() function
+   * \tparam Args Varargs type to eventually pass to the UseOMP() and OP::Map() functions
    * \param N Number of iterations
    * \param args Varargs to eventually pass to the UseOMP() and OP::Map() functions
    */
   template <typename... Args>
   inline static void LaunchEx(mshadow::Stream<cpu>* s, const size_t N, Args... args) {
-#ifdef _OPENMP
-    const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
-    if (omp_threads < 2) {
-      OP::Map(0, N, args...);
-    } else {
-      const auto length = (N + omp_threads - 1) / omp_threads;
-#pragma omp parallel for num_threads(omp_threads)
-      for (index_t i = 0; i < static_cast<index_t>(N); i += length) {
-        OP::Map(i, i + length > N ? N - i : length, args...);
-      }
-    }
-#else
-    OP::Map(0, N, args...);
-#endif
+    engine::ParallelFor(0,
+                        N,
+                        1,
+                        engine::OpenMP::Get()->GetRecommendedOMPThreadCount(),
+                        [&](const index_t begin, const index_t end) {
+                          OP::Map(begin, end - begin, args...);
+                        });
   }
 
   /*!
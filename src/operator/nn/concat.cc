@@ -23,6 +23,7 @@
  * \author Bing Xu
  */
 
+#include "../../common/alm.h"
 #include "../../common/utils.h"
 #include "./concat-inl.h"
 #if MXNET_USE_ONEDNN == 1
@@ -320,6 +321,30 @@ struct ConcatGrad {
   }
 };
 
+static bool ConcatChangeLayout(nnvm::NodeAttrs* attrs,
+                               mshadow::LayoutFlag target_layout,
+                               std::vector<alm::Transpose>* in_axes,
+                               std::vector<alm::Transpose>* out_axes) {
+  CHECK_EQ(target_layout, mshadow::kUNKNOWN);
+  const ConcatParam& param = nnvm::get<ConcatParam>(attrs->parsed);
+  // without dim the inputs are flattened, which needs their original layout
+  if (!param.dim.has_value()) {
+    out_axes->assign(1, alm::Transpose());
+    return false;
+  }
+  auto t = alm::FactorCommonTransposeAll(in_axes);
+  out_axes->assign(1, t);
+  if (alm::IsIdentity(t))
+    return false;
+  const int ndim = t.size();
+  int dim        = param.dim.value();
+  if (dim < 0)
+    dim += ndim;
+  CHECK(dim >= 0 && dim < ndim) << "Invalid concat dim " << param.dim.value();
+  attrs->dict["dim"] = std::to_string(t[dim]);
+  return true;
+}
+
 DMLC_REGISTER_PARAMETER(ConcatParam);
 
 #define CONCAT_FORWARD_ATTRS                                                                      \
@@ -344,6 +369,7 @@ DMLC_REGISTER_PARAMETER(ConcatParam);
           "FListOutputNames",                                                                     \
           [](const NodeAttrs& attrs) { return std::vector<std::string>{"output"}; })              \
       .set_attr<nnvm::FInferType>("FInferType", ConcatType)                                       \
+      .set_attr<mxnet::alm::FChangeLayout>("FChangeLayout", ConcatChangeLayout)                   \
       .set_attr<FInferStorageType>("FInferStorageType", ConcatForwardInferStorageType)            \
       .set_attr<FCompute>("FCompute<cpu>", ConcatCompute<cpu>)                                    \
       .set_attr<FComputeEx>("FComputeEx<cpu>", ConcatComputeExCPU)                                \
@@ -406,6 +432,13 @@ Example::
     .set_attr<bool>("TIsDNNL", true)
 #endif  // MXNET_USE_ONEDNN == 1
         CONCAT_FORWARD_ATTRS.set_attr<mxnet::FInferShape>("FInferShape", ConcatShape)
+    .set_attr<FConcatAxis>("FConcatAxis",
+                           [](const NodeAttrs& attrs, int ndim) {
+                             // without dim the inputs are flattened and joined along axis 0
+                             const ConcatParam& param = nnvm::get<ConcatParam>(attrs.parsed);
+                             const int axis = param.dim.has_value() ? param.dim.value() : 0;
+                             return axis < 0 ? axis + ndim : axis;
+                           })
     .add_argument("data", "NDArray-or-Symbol[]", "List of arrays to concatenate")
     .add_arguments(ConcatParam::__FIELDS__());
 
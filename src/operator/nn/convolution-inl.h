@@ -38,10 +38,12 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include "../operator_common.h"
 #include "../linalg.h"
 #include "./im2col.h"
+#include "./convolution_cpu.h"
 
 namespace mxnet {
 namespace op {
@@ -107,7 +109,7 @@ struct ConvolutionParam : public dmlc::Parameter<ConvolutionParam> {
         .describe(
             "Set layout for input, output and weight. Empty for\n    "
             "default layout: NCW for 1d, NCHW for 2d and NCDHW for 3d."
-            "NHWC and NDHWC are only supported on GPU.");
+            "NHWC and NDHWC are only supported on GPU, and NHWC for inference on CPU.");
   }
   // Adjusts kernel size for effects of dilation in the dimension `dim`.
   index_t DilatedKernelSize(int dim) const {
@@ -230,8 +232,9 @@ class ConvolutionOp {
     param_.workspace = (param_.workspace << 20) / sizeof(DType);
     if (param_.layout.has_value()) {
       CHECK(param_.layout.value() == mshadow::kNCW || param_.layout.value() == mshadow::kNCHW ||
-            param_.layout.value() == mshadow::kNCDHW)
-          << "Only support NCW, NCHW and NCDHW layout";
+            param_.layout.value() == mshadow::kNCDHW ||
+            (std::is_same<xpu, cpu>::value && param_.layout.value() == mshadow::kNHWC))
+          << "Only support NCW, NCHW and NCDHW layout, and NHWC on CPU";
     }
   }
 
@@ -245,6 +248,17 @@ class ConvolutionOp {
     CHECK_EQ(in_data.size(), expected);
     CHECK_EQ(out_data.size(), 1U);
     // CHECK_EQ(req[conv::kOut], kWriteTo);
+    if (is_channels_last()) {
+      const TBlob& data = in_data[conv::kData];
+      DirectConvForwardNHWC(ctx.get_stream<xpu>(),
+                            Geometry2D(data.shape_, out_data[conv::kOut].shape_),
+                            data.dptr<DType>(),
+                            in_data[conv::kWeight].dptr<DType>(),
+                            param_.no_bias ? nullptr : in_data[conv::kBias].dptr<DType>(),
+                            out_data[conv::kOut].dptr<DType>(),
+                            req[conv::kOut]);
+      return;
+    }
     _Forward(ctx,
              in_data[conv::kData],
              in_data[conv::kWeight],
@@ -268,6 +282,7 @@ class ConvolutionOp {
     CHECK_EQ(in_grad.size(), expected);
     CHECK_EQ(req.size(), expected);
     CHECK_EQ(in_data[conv::kWeight].CheckContiguous(), true);
+    CHECK(!is_channels_last()) << "Convolution of NHWC data on CPU only supports inference";
 
     auto workspace = _BackwardData(
         ctx, out_grad[conv::kOut], in_data[conv::kWeight], req[conv::kData], in_grad[conv::kData]);
@@ -314,6 +329,22 @@ class ConvolutionOp {
           linalg_gemm(weight_3d[g], input_3d[g], output_3d[g], false, false, s, req);
         }
       }
+    } else if (num_spatial_axes_ == 2 &&
+               UseWinogradConv<xpu>(Geometry2D(in_data.shape_, out_data.shape_),
+                                    param_.workspace)) {
+      const ConvGeometry2D geometry = Geometry2D(in_data.shape_, out_data.shape_);
+      const index_t size            = WinogradConvWorkspaceSize(geometry, param_.workspace);
+      // the workspace is not a column buffer, so it is not returned for reuse
+      Tensor<xpu, 1, DType> buffer =
+          ctx.requested[conv::kTempSpace].get_space_typed<xpu, 1, DType>(Shape1(size), s);
+      WinogradConvForward(s,
+                          geometry,
+                          in_data.dptr<DType>(),
+                          in_weights.dptr<DType>(),
+                          out_data.dptr<DType>(),
+                          req,
+                          buffer.dptr_,
+                          param_.workspace);
     } else {
       // allocate workspace for col_buffer
       workspace = ctx.requested[conv::kTempSpace].get_space_typed<xpu, 1, DType>(
@@ -540,6 +571,34 @@ class ConvolutionOp {
     num_kernels_col2im_ = input_dim_;
   }
 
+  bool is_channels_last() const {
+    return param_.layout.has_value() && param_.layout.value() == mshadow::kNHWC;
+  }
+
+  // Sizes of a 2D convolution of NCHW data, or of NHWC data for the channels last layout.
+  ConvGeometry2D Geometry2D(const mxnet::TShape& ishape, const mxnet::TShape& oshape) const {
+    const int c = is_channels_last() ? 3 : 1;
+    const int h = is_channels_last() ? 1 : 2;
+    ConvGeometry2D g;
+    g.num        = ishape[0];
+    g.channels   = ishape[c];
+    g.height     = ishape[h];
+    g.width      = ishape[h + 1];
+    g.filters    = oshape[c];
+    g.out_height = oshape[h];
+    g.out_width  = oshape[h + 1];
+    g.groups     = param_.num_group;
+    g.kernel_h   = param_.kernel[0];
+    g.kernel_w   = param_.kernel[1];
+    g.stride_h   = param_.stride[0];
+    g.stride_w   = param_.stride[1];
+    g.dilate_h   = param_.dilate[0];
+    g.dilate_w   = param_.dilate[1];
+    g.pad_h      = param_.pad[0];
+    g.pad_w      = param_.pad[1];
+    return g;
+  }
+
  private:
   ConvolutionParam param_;
   index_t channel_axis_;          // channel axis of the input
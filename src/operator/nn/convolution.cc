@@ -32,6 +32,7 @@
 #if MXNET_USE_ONEDNN == 1
 #include "operator/nn/dnnl/dnnl_base-inl.h"
 #include "operator/nn/dnnl/dnnl_convolution-inl.h"
+#include "operator/nn/dnnl/dnnl_dispatch_tuner-inl.h"
 #endif  // MXNET_USE_ONEDNN
 
 namespace mxnet {
@@ -58,9 +59,16 @@ static void ConvolutionComputeExCPU(const nnvm::NodeAttrs& attrs,
                                     const std::vector<NDArray>& outputs) {
   const ConvolutionParam& params = nnvm::get<ConvolutionParam>(attrs.parsed);
   if (SupportDNNLConv(params, inputs[0])) {
-    DNNL_OPCHECK_INIT(false, outputs.size(), inputs, outputs);
-    DNNLRun(DNNLConvolutionForward, attrs, ctx, inputs, req, outputs);
-    DNNL_OPCHECK_RUN(ConvolutionCompute<cpu>, attrs, ctx, inputs, req, outputs);
+    DNNLDispatch(
+        attrs,
+        inputs,
+        req,
+        [&]() {
+          DNNL_OPCHECK_INIT(false, outputs.size(), inputs, outputs);
+          DNNLRun(DNNLConvolutionForward, attrs, ctx, inputs, req, outputs);
+          DNNL_OPCHECK_RUN(ConvolutionCompute<cpu>, attrs, ctx, inputs, req, outputs);
+        },
+        [&]() { FallBackCompute(ConvolutionCompute<cpu>, attrs, ctx, inputs, req, outputs); });
     return;
   }
   FallBackCompute(ConvolutionCompute<cpu>, attrs, ctx, inputs, req, outputs);
@@ -418,6 +426,27 @@ void ConvolutionParamParser(nnvm::NodeAttrs* attrs) {
   attrs->parsed = std::move(param_);
 }
 
+static OpCost ConvolutionCost(const nnvm::NodeAttrs& attrs,
+                              const std::vector<TBlob>& inputs,
+                              const std::vector<TBlob>& outputs) {
+  const ConvolutionParam& param = nnvm::get<ConvolutionParam>(attrs.parsed);
+  // each output element reduces over one filter, the weight holds num_filter of them
+  const double macs = static_cast<double>(outputs[conv::kOut].Size()) *
+                      inputs[conv::kWeight].Size() / param.num_filter;
+  return MatMulCost(macs, inputs, outputs);
+}
+
+static OpCost BackwardConvolutionCost(const nnvm::NodeAttrs& attrs,
+                                      const std::vector<TBlob>& inputs,
+                                      const std::vector<TBlob>& outputs) {
+  const ConvolutionParam& param = nnvm::get<ConvolutionParam>(attrs.parsed);
+  // inputs are the output gradient followed by the forward inputs, the data and weight
+  // gradients each take as many multiply-adds as the forward pass
+  const double macs =
+      2.0 * inputs[0].Size() * inputs[1 + conv::kWeight].Size() / param.num_filter;
+  return MatMulCost(macs, inputs, outputs);
+}
+
 struct ConvolutionGrad {
   const char* op_name;
   std::vector<nnvm::NodeEntry> operator()(const nnvm::ObjectPtr& n,
@@ -537,6 +566,7 @@ There are other options to tune the performance.
     .set_attr<bool>("TIsDNNL", true)
     .set_attr<FComputeEx>("FComputeEx<cpu>", ConvolutionComputeExCPU)
 #endif
+    .set_attr<FOpCost>("FOpCost", ConvolutionCost)
     .set_attr<nnvm::FGradient>("FGradient", ConvolutionGrad{"_backward_Convolution"})
     .set_attr<FResourceRequest>("FResourceRequest",
                                 [](const NodeAttrs& n) {
@@ -566,6 +596,7 @@ NNVM_REGISTER_OP(_backward_Convolution)
                                   return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
                                 })
     .set_attr_parser(ConvolutionParamParser)
+    .set_attr<FOpCost>("FOpCost", BackwardConvolutionCost)
 #if MXNET_USE_ONEDNN == 1
     .set_attr<bool>("TIsDNNL", true)
     .set_attr<FComputeEx>("FComputeEx<cpu>", ConvolutionGradComputeExCPU)
@@ -0,0 +1,339 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file convolution_cpu.h
+ * \brief CPU kernels of Convolution that do without the column buffer of im2col: Winograd
+ *        F(2x2, 3x3) for 3x3 kernels of stride 1, and a direct convolution of NHWC data.
+ */
+#ifndef MXNET_OPERATOR_NN_CONVOLUTION_CPU_H_
+#define MXNET_OPERATOR_NN_CONVOLUTION_CPU_H_
+
+#include <dmlc/parameter.h>
+#include <algorithm>
+#include "../mxnet_op.h"
+#include "../linalg.h"
+
+namespace mxnet {
+namespace op {
+
+/*! \brief sizes of a 2D convolution, independent of the layout */
+struct ConvGeometry2D {
+  index_t num;
+  index_t channels;
+  index_t height;
+  index_t width;
+  index_t filters;
+  index_t out_height;
+  index_t out_width;
+  index_t groups;
+  index_t kernel_h;
+  index_t kernel_w;
+  index_t stride_h;
+  index_t stride_w;
+  index_t dilate_h;
+  index_t dilate_w;
+  index_t pad_h;
+  index_t pad_w;
+};
+
+namespace winograd {
+/*! \brief the 4x4 input tile of F(2x2, 3x3) gives a 2x2 output tile */
+constexpr index_t kTile = 4;
+constexpr index_t kOutTile = 2;
+constexpr index_t kTileSize = kTile * kTile;
+/*! \brief below these channels per group the transforms cost more than the GEMMs save */
+constexpr index_t kMinChannels = 8;
+
+inline index_t NumTiles(const ConvGeometry2D& g) {
+  return ((g.out_height + kOutTile - 1) / kOutTile) * ((g.out_width + kOutTile - 1) / kOutTile);
+}
+
+/*! \brief number of tiles transformed at once within a workspace of budget elements */
+inline index_t TileBlock(const ConvGeometry2D& g, index_t budget) {
+  const index_t in_channels  = g.channels / g.groups;
+  const index_t out_channels = g.filters / g.groups;
+  const index_t weights      = kTileSize * out_channels * in_channels;
+  if (budget <= weights)
+    return 0;
+  return std::min(g.num * NumTiles(g),
+                  (budget - weights) / (kTileSize * (in_channels + out_channels)));
+}
+}  // namespace winograd
+
+/*!
+ * \brief Whether to run a convolution with Winograd F(2x2, 3x3) rather than im2col and GEMM.
+ *        MXNET_CPU_WINOGRAD_CONV=0 turns it off.
+ * \param budget workspace allowed, in elements
+ */
+template <typename xpu>
+inline bool UseWinogradConv(const ConvGeometry2D& g, index_t budget) {
+  return false;
+}
+
+template <>
+inline bool UseWinogradConv<cpu>(const ConvGeometry2D& g, index_t budget) {
+  static const bool enabled = dmlc::GetEnv("MXNET_CPU_WINOGRAD_CONV", true);
+  return enabled && g.kernel_h == 3 && g.kernel_w == 3 && g.stride_h == 1 && g.stride_w == 1 &&
+         g.dilate_h == 1 && g.dilate_w == 1 && g.channels / g.groups >= winograd::kMinChannels &&
+         g.filters / g.groups >= winograd::kMinChannels && winograd::TileBlock(g, budget) > 0;
+}
+
+/*! \return workspace, in elements, of WinogradConvForward */
+inline index_t WinogradConvWorkspaceSize(const ConvGeometry2D& g, index_t budget) {
+  const index_t in_channels  = g.channels / g.groups;
+  const index_t out_channels = g.filters / g.groups;
+  return winograd::kTileSize *
+         (out_channels * in_channels +
+          (in_channels + out_channels) * winograd::TileBlock(g, budget));
+}
+
+/*!
+ * \brief 3x3 convolution of stride 1 of NCHW data. The weights and the input tiles are
+ *        transformed to 16 products of matrices, computed by GEMM, whose results are
+ *        transformed back to output tiles.
+ * \param workspace WinogradConvWorkspaceSize(g, budget) elements
+ */
+template <typename DType>
+void WinogradConvForward(mshadow::Stream<cpu>* s,
+                         const ConvGeometry2D& g,
+                         const DType* in,
+                         const DType* weight,
+                         DType* out,
+                         OpReqType req,
+                         DType* workspace,
+                         index_t budget) {
+  using namespace winograd;
+  const index_t in_channels  = g.channels / g.groups;
+  const index_t out_channels = g.filters / g.groups;
+  const index_t tiles_w      = (g.out_width + kOutTile - 1) / kOutTile;
+  const index_t tiles        = NumTiles(g);
+  const index_t block        = TileBlock(g, budget);
+  const int nthreads         = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  DType* u                   = workspace;
+  DType* v                   = u + kTileSize * out_channels * in_channels;
+  DType* m                   = v + kTileSize * in_channels * block;
+  for (index_t grp = 0; grp < g.groups; ++grp) {
+    // U = G w G^T of each pair of output and input channels, stored as u[k][o][c]
+    const DType* w = weight + grp * out_channels * in_channels * 9;
+    engine::ParallelFor(0, out_channels * in_channels, 64, nthreads, [&](int64_t b, int64_t e) {
+      for (int64_t oc = b; oc < e; ++oc) {
+        const DType* k3 = w + oc * 9;
+        DType gw[kTile][3];
+        for (int j = 0; j < 3; ++j) {
+          gw[0][j] = k3[j];
+          gw[1][j] = DType(0.5) * (k3[j] + k3[3 + j] + k3[6 + j]);
+          gw[2][j] = DType(0.5) * (k3[j] - k3[3 + j] + k3[6 + j]);
+          gw[3][j] = k3[6 + j];
+        }
+        for (int i = 0; i < kTile; ++i) {
+          const DType row[kTile] = {gw[i][0],
+                                    DType(0.5) * (gw[i][0] + gw[i][1] + gw[i][2]),
+                                    DType(0.5) * (gw[i][0] - gw[i][1] + gw[i][2]),
+                                    gw[i][2]};
+          for (int j = 0; j < kTile; ++j) {
+            u[(i * kTile + j) * out_channels * in_channels + oc] = row[j];
+          }
+        }
+      }
+    });
+    for (index_t t0 = 0; t0 < g.num * tiles; t0 += block) {
+      const index_t nt = std::min(block, g.num * tiles - t0);
+      // V = B^T d B of each input tile, stored as v[k][c][t]
+      engine::ParallelFor(0, in_channels * nt, 64, nthreads, [&](int64_t b, int64_t e) {
+        for (int64_t ct = b; ct < e; ++ct) {
+          const index_t c  = ct / nt;
+          const index_t t  = ct % nt;
+          const index_t n  = (t0 + t) / tiles;
+          const index_t y0 = ((t0 + t) % tiles) / tiles_w * kOutTile - g.pad_h;
+          const index_t x0 = ((t0 + t) % tiles) % tiles_w * kOutTile - g.pad_w;
+          const DType* plane =
+              in + ((n * g.channels + grp * in_channels + c) * g.height) * g.width;
+          DType d[kTile][kTile];
+          for (index_t i = 0; i < kTile; ++i) {
+            for (index_t j = 0; j < kTile; ++j) {
+              const index_t y = y0 + i;
+              const index_t x = x0 + j;
+              d[i][j] = (y >= 0 && y < g.height && x >= 0 && x < g.width) ?
+                            plane[y * g.width + x] :
+                            DType(0);
+            }
+          }
+          DType bd[kTile][kTile];
+          for (int j = 0; j < kTile; ++j) {
+            bd[0][j] = d[0][j] - d[2][j];
+            bd[1][j] = d[1][j] + d[2][j];
+            bd[2][j] = d[2][j] - d[1][j];
+            bd[3][j] = d[1][j] - d[3][j];
+          }
+          DType* dst = v + c * nt + t;
+          for (int i = 0; i < kTile; ++i) {
+            dst[(i * kTile + 0) * in_channels * nt] = bd[i][0] - bd[i][2];
+            dst[(i * kTile + 1) * in_channels * nt] = bd[i][1] + bd[i][2];
+            dst[(i * kTile + 2) * in_channels * nt] = bd[i][2] - bd[i][1];
+            dst[(i * kTile + 3) * in_channels * nt] = bd[i][1] - bd[i][3];
+          }
+        }
+      });
+      // M[k] = U[k] V[k] for each of the 16 elements of a tile
+      for (index_t k = 0; k < kTileSize; ++k) {
+        Tensor<cpu, 2, DType> uk(u + k * out_channels * in_channels,
+                                 Shape2(out_channels, in_channels),
+                                 s);
+        Tensor<cpu, 2, DType> vk(v + k * in_channels * nt, Shape2(in_channels, nt), s);
+        Tensor<cpu, 2, DType> mk(m + k * out_channels * nt, Shape2(out_channels, nt), s);
+        linalg_gemm(uk, vk, mk, DType(1), DType(0), false, false, s);
+      }
+      // Y = A^T M A of each output tile
+      engine::ParallelFor(0, out_channels * nt, 64, nthreads, [&](int64_t b, int64_t e) {
+        for (int64_t ot = b; ot < e; ++ot) {
+          const index_t o   = ot / nt;
+          const index_t t   = ot % nt;
+          const index_t n   = (t0 + t) / tiles;
+          const index_t y0  = ((t0 + t) % tiles) / tiles_w * kOutTile;
+          const index_t x0  = ((t0 + t) % tiles) % tiles_w * kOutTile;
+          const DType* src  = m + o * nt + t;
+          const index_t ldk = out_channels * nt;
+          DType am[kOutTile][kTile];
+          for (int j = 0; j < kTile; ++j) {
+            am[0][j] = src[j * ldk] + src[(kTile + j) * ldk] + src[(2 * kTile + j) * ldk];
+            am[1][j] = src[(kTile + j) * ldk] - src[(2 * kTile + j) * ldk] -
+                       src[(3 * kTile + j) * ldk];
+          }
+          DType* plane =
+              out + ((n * g.filters + grp * out_channels + o) * g.out_height) * g.out_width;
+          for (index_t i = 0; i < kOutTile && y0 + i < g.out_height; ++i) {
+            const DType row[kOutTile] = {am[i][0] + am[i][1] + am[i][2],
+                                         am[i][1] - am[i][2] - am[i][3]};
+            for (index_t j = 0; j < kOutTile && x0 + j < g.out_width; ++j) {
+              KERNEL_ASSIGN(plane[(y0 + i) * g.out_width + x0 + j], req, row[j]);
+            }
+          }
+        }
+      });
+    }
+  }
+}
+
+template <typename DType>
+inline void WinogradConvForward(mshadow::Stream<gpu>* s,
+                                const ConvGeometry2D& g,
+                                const DType* in,
+                                const DType* weight,
+                                DType* out,
+                                OpReqType req,
+                                DType* workspace,
+                                index_t budget) {
+  LOG(FATAL) << "Winograd convolution is only implemented on CPU";
+}
+
+/*!
+ * \brief Convolution of NHWC data with OHWI weights. Each output pixel is a sum over the
+ *        kernel of the products of a matrix of weights with the vector of channels of an input
+ *        pixel, both contiguous. A 1x1 convolution of stride 1 is a single GEMM.
+ * \param bias bias of each filter, or nullptr
+ */
+template <typename DType>
+void DirectConvForwardNHWC(mshadow::Stream<cpu>* s,
+                           const ConvGeometry2D& g,
+                           const DType* in,
+                           const DType* weight,
+                           const DType* bias,
+                           DType* out,
+                           OpReqType req) {
+  const index_t in_channels  = g.channels / g.groups;
+  const index_t out_channels = g.filters / g.groups;
+  const index_t pixels       = g.num * g.out_height * g.out_width;
+  const int nthreads         = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  if (g.kernel_h == 1 && g.kernel_w == 1 && g.stride_h == 1 && g.stride_w == 1 &&
+      g.pad_h == 0 && g.pad_w == 0) {
+    for (index_t grp = 0; grp < g.groups; ++grp) {
+      Tensor<cpu, 2, DType> x(const_cast<DType*>(in) + grp * in_channels,
+                              Shape2(pixels, in_channels),
+                              g.channels,
+                              s);
+      Tensor<cpu, 2, DType> w(const_cast<DType*>(weight) + grp * out_channels * in_channels,
+                              Shape2(out_channels, in_channels),
+                              s);
+      Tensor<cpu, 2, DType> y(out + grp * out_channels, Shape2(pixels, out_channels), g.filters, s);
+      linalg_gemm(x, w, y, DType(1), DType(req == kAddTo ? 1 : 0), false, true, s);
+    }
+    if (bias != nullptr) {
+      engine::ParallelFor(0, pixels, 64, nthreads, [&](int64_t b, int64_t e) {
+        for (int64_t p = b; p < e; ++p) {
+#pragma omp simd
+          for (index_t o = 0; o < g.filters; ++o) {
+            out[p * g.filters + o] += bias[o];
+          }
+        }
+      });
+    }
+    return;
+  }
+  const index_t kernel = g.kernel_h * g.kernel_w * in_channels;
+  engine::ParallelFor(0, pixels, 16, nthreads, [&](int64_t b, int64_t e) {
+    for (int64_t p = b; p < e; ++p) {
+      const index_t n  = p / (g.out_height * g.out_width);
+      const index_t oy = p / g.out_width % g.out_height;
+      const index_t ox = p % g.out_width;
+      DType* dst       = out + p * g.filters;
+      for (index_t grp = 0; grp < g.groups; ++grp) {
+        for (index_t o = 0; o < out_channels; ++o) {
+          const index_t filter = grp * out_channels + o;
+          const DType* w       = weight + filter * kernel;
+          DType sum            = bias != nullptr ? bias[filter] : DType(0);
+          for (index_t ky = 0; ky < g.kernel_h; ++ky) {
+            const index_t y = oy * g.stride_h - g.pad_h + ky * g.dilate_h;
+            if (y < 0 || y >= g.height)
+              continue;
+            for (index_t kx = 0; kx < g.kernel_w; ++kx) {
+              const index_t x = ox * g.stride_w - g.pad_w + kx * g.dilate_w;
+              if (x < 0 || x >= g.width)
+                continue;
+              const DType* src =
+                  in + ((n * g.height + y) * g.width + x) * g.channels + grp * in_channels;
+              const DType* wk = w + (ky * g.kernel_w + kx) * in_channels;
+#pragma omp simd reduction(+ : sum)
+              for (index_t c = 0; c < in_channels; ++c) {
+                sum += wk[c] * src[c];
+              }
+            }
+          }
+          KERNEL_ASSIGN(dst[filter], req, sum);
+        }
+      }
+    }
+  });
+}
+
+template <typename DType>
+inline void DirectConvForwardNHWC(mshadow::Stream<gpu>* s,
+                                  const ConvGeometry2D& g,
+                                  const DType* in,
+                                  const DType* weight,
+                                  const DType* bias,
+                                  DType* out,
+                                  OpReqType req) {
+  LOG(FATAL) << "Convolution of NHWC data without cuDNN is only implemented on CPU";
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_NN_CONVOLUTION_CPU_H_
@@ -34,6 +34,7 @@
 #include "../sequence_op_common.h"
 #include "../operator_common.h"
 #include "../elemwise_op_common.h"
+#include "../../../3rdparty/ctc_include/detail/ctc_helper.h"
 
 namespace mxnet {
 namespace op {
@@ -48,7 +49,6 @@ inline void get_workspace_size(const std::vector<int>* label_lengths,
                                const std::vector<int>* data_lengths,
                                int alphabet_size,
                                int minibatch,
-                               bool isGPU,
                                size_t* size_bytes) {
   // This is the max of all S and T for all examples in the minibatch.
   int maxL = *std::max_element(label_lengths->data(), label_lengths->data() + minibatch);
@@ -58,63 +58,36 @@ inline void get_workspace_size(const std::vector<int>* label_lengths,
 
   *size_bytes = 0;
 
-  if (isGPU) {
-    // GPU storage
-    // nll_forward, nll_backward
-    *size_bytes += 2 * sizeof(T) * minibatch;
+  // GPU storage
+  // nll_forward, nll_backward
+  *size_bytes += 2 * sizeof(T) * minibatch;
 
-    // repeats
-    *size_bytes += sizeof(int) * minibatch;
+  // repeats
+  *size_bytes += sizeof(int) * minibatch;
 
-    // label offsets
-    *size_bytes += sizeof(int) * minibatch;
+  // label offsets
+  *size_bytes += sizeof(int) * minibatch;
 
-    // utt_length
-    *size_bytes += sizeof(int) * minibatch;
+  // utt_length
+  *size_bytes += sizeof(int) * minibatch;
 
-    // label lengths
-    *size_bytes += sizeof(int) * minibatch;
+  // label lengths
+  *size_bytes += sizeof(int) * minibatch;
 
-    // labels without blanks - overallocate for now
-    *size_bytes += sizeof(int) * maxL * minibatch;
+  // labels without blanks - overallocate for now
+  *size_bytes += sizeof(int) * maxL * minibatch;
 
-    // labels with blanks
-    *size_bytes += sizeof(int) * S * minibatch;
+  // labels with blanks
+  *size_bytes += sizeof(int) * S * minibatch;
 
-    // alphas
-    *size_bytes += sizeof(T) * S * maxT * minibatch;
+  // alphas
+  *size_bytes += sizeof(T) * S * maxT * minibatch;
 
-    // denoms
-    *size_bytes += sizeof(T) * maxT * minibatch;
+  // denoms
+  *size_bytes += sizeof(T) * maxT * minibatch;
 
-    // probs (since we will pass in activations)
-    *size_bytes += sizeof(T) * alphabet_size * maxT * minibatch;
-
-  } else {
-    // cpu can eventually replace all minibatch with
-    // max number of concurrent threads if memory is
-    // really tight
-
-    // per minibatch memory
-    size_t per_minibatch_bytes = 0;
-
-    // output
-    per_minibatch_bytes += sizeof(T) * alphabet_size;
-
-    // alphas
-    per_minibatch_bytes += sizeof(T) * S * maxT;
-
-    // betas
-    per_minibatch_bytes += sizeof(T) * S;
-
-    // labels w/blanks, e_inc, s_inc
-    per_minibatch_bytes += 3 * sizeof(int) * S;
-
-    *size_bytes = per_minibatch_bytes * minibatch;
-
-    // probs
-    *size_bytes += sizeof(T) * alphabet_size * maxT * minibatch;
-  }
+  // probs (since we will pass in activations)
+  *size_bytes += sizeof(T) * alphabet_size * maxT * minibatch;
 }
 
 // Takes a tensor of labels, and interprets 0-elements at the end of the vector
@@ -346,28 +319,23 @@ void CTCLossOpForward(const nnvm::NodeAttrs& attrs,
           labels, param.blank_label == 0 ? 0 : -1, &packed_labels, &label_lengths);
     }
 
-    size_t size_bytes;
-    get_workspace_size<real_t>(&label_lengths,
-                               &data_lengths,
-                               alphabet_size,
-                               batch_size,
-                               data.kDevCPU ? false : true,
-                               &size_bytes);
-
-    // round-up so there are enough elems in memory
-    size_t num_tmp_elems = (size_bytes + sizeof(real_t) - 1) / sizeof(real_t);
-    Tensor<xpu, 1, real_t> workspace =
-        ctx.requested[0].get_space_typed<xpu, 1, real_t>(Shape1(num_tmp_elems), s);
-
-    compute_ctc_cost(data,
-                     costs.dptr_,
-                     grad.dptr_,
-                     packed_labels.data(),
-                     label_lengths.data(),
-                     data_lengths.data(),
-                     workspace.dptr_,
-                     req[ctc_loss::kGrad] != mxnet::kNullOp,
-                     param.blank_label == 0 ? 0 : (alphabet_size - 1));
+    for (int i = 0; i < batch_size; ++i) {
+      CHECK(data_lengths[i] >= 0 && data_lengths[i] <= max_seq_len)
+          << "The data length " << data_lengths[i] << " of batch element " << i
+          << " is outside of the sequence length " << max_seq_len;
+    }
+
+    // the workspace is requested by each device, whose implementations need different sizes
+    const ctcStatus_t status = compute_ctc_cost(data,
+                                                costs.dptr_,
+                                                grad.dptr_,
+                                                packed_labels.data(),
+                                                label_lengths.data(),
+                                                data_lengths.data(),
+                                                ctx.requested[0],
+                                                req[ctc_loss::kGrad] != mxnet::kNullOp,
+                                                param.blank_label == 0 ? 0 : (alphabet_size - 1));
+    CHECK_EQ(status, CTC_STATUS_SUCCESS) << "CTC loss computation failed with status " << status;
 
     if (param.use_data_lengths) {
       // baidu warp CTC implementation sometimes includes undefined gradients
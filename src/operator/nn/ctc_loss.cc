@@ -22,7 +22,8 @@
  * \brief CPU Implementation of CTC Loss op
  */
 #include "./ctc_loss-inl.h"
-#include "../../../3rdparty/ctc_include/detail/cpu_ctc.h"
+#include "./ctc_loss_cpu.h"
+#include "../../engine/openmp.h"
 
 namespace mshadow {
 template <typename DType>
@@ -32,17 +33,35 @@ ctcStatus_t compute_ctc_cost(const Tensor<cpu, 3, DType> activations,
                              int* labels,
                              int* label_lengths,
                              int* data_lengths,
-                             void* workspace,
+                             const mxnet::Resource& temp,
                              bool isTraining,
                              int blank_label) {
+  int max_seq_len   = static_cast<int>(activations.size(0));
   int minibatch     = static_cast<int>(activations.size(1));
   int alphabet_size = static_cast<int>(activations.size(2));
-  mxnet_warpctc::CpuCTC<DType> ctc(alphabet_size, minibatch, workspace, blank_label);
-  if (isTraining) {
-    return ctc.cost_and_grad(activations.dptr_, grads, costs, labels, label_lengths, data_lengths);
-  } else {
-    return ctc.score_forward(activations.dptr_, costs, labels, label_lengths, data_lengths);
-  }
+  int max_T         = *std::max_element(data_lengths, data_lengths + minibatch);
+  int max_L         = *std::max_element(label_lengths, label_lengths + minibatch);
+  // each thread computes whole batch elements with its own alphas and betas
+  int num_workers = std::max(
+      1, std::min(minibatch, mxnet::engine::OpenMP::Get()->GetRecommendedOMPThreadCount()));
+
+  size_t size_bytes = mxnet::op::ctc::CTCLossCPUWorkspaceSize<DType>(
+      max_T, max_L, alphabet_size, minibatch, num_workers);
+  Tensor<cpu, 1, DType> workspace = temp.get_space_typed<cpu, 1, DType>(
+      Shape1((size_bytes + sizeof(DType) - 1) / sizeof(DType)), activations.stream_);
+  mxnet::op::ctc::CTCLossCPU(activations.dptr_,
+                             costs,
+                             isTraining ? grads : nullptr,
+                             labels,
+                             label_lengths,
+                             data_lengths,
+                             max_seq_len,
+                             minibatch,
+                             alphabet_size,
+                             blank_label,
+                             workspace.dptr_,
+                             num_workers);
+  return CTC_STATUS_SUCCESS;
 }
 }  // namespace mshadow
 
@@ -22,11 +22,99 @@
  * \brief GPU Implementation of ctc_loss op
  */
 
+#include <type_traits>
+#include <vector>
 #include "./ctc_loss-inl.h"
 #include "../../../3rdparty/ctc_include/detail/gpu_ctc.h"
 
 namespace mshadow {
 
+#if MXNET_USE_CUDNN == 1
+/*!
+ * \brief Whether cuDNN computes the loss of the batch. It needs float data, the blank label
+ *        first, 1 to 256 labels per element and data of the full sequence length long enough
+ *        for them. Inference keeps warp-ctc, whose forward pass skips the gradient.
+ */
+template <typename DType>
+inline bool UseCuDNNCTCLoss(const Tensor<gpu, 3, DType>& activations,
+                            const int* labels,
+                            const int* label_lengths,
+                            const int* input_lengths,
+                            bool train,
+                            int blank_label) {
+  static const bool enabled = dmlc::GetEnv("MXNET_CUDNN_CTC_LOSS", true);
+  if (!enabled || !train || blank_label != 0 || !std::is_same<DType, float>::value)
+    return false;
+  const int max_seq_len = static_cast<int>(activations.size(0));
+  const int minibatch   = static_cast<int>(activations.size(1));
+  for (int b = 0, offset = 0; b < minibatch; offset += label_lengths[b++]) {
+    if (label_lengths[b] < 1 || label_lengths[b] > 256 || input_lengths[b] != max_seq_len)
+      return false;
+    int repeats = 0;
+    for (int i = 1; i < label_lengths[b]; ++i) {
+      repeats += labels[offset + i] == labels[offset + i - 1];
+    }
+    if (label_lengths[b] + repeats > max_seq_len)
+      return false;
+  }
+  return true;
+}
+
+template <typename DType>
+inline ctcStatus_t CuDNNCTCLoss(const Tensor<gpu, 3, DType>& activations,
+                                DType* costs,
+                                DType* grads,
+                                int* labels,
+                                int* label_lengths,
+                                int* input_lengths,
+                                const mxnet::Resource& temp) {
+  Stream<gpu>* s = activations.stream_;
+  CHECK_EQ(s->dnn_handle_ownership_, Stream<gpu>::OwnHandle);
+  const int dims[3]    = {static_cast<int>(activations.size(0)),
+                          static_cast<int>(activations.size(1)),
+                          static_cast<int>(activations.size(2))};
+  const int strides[3] = {dims[1] * dims[2], dims[2], 1};
+  cudnnTensorDescriptor_t probs_desc, grads_desc;
+  cudnnCTCLossDescriptor_t ctc_desc;
+  CUDNN_CALL(cudnnCreateTensorDescriptor(&probs_desc));
+  CUDNN_CALL(cudnnCreateTensorDescriptor(&grads_desc));
+  CUDNN_CALL(cudnnCreateCTCLossDescriptor(&ctc_desc));
+  CUDNN_CALL(cudnnSetTensorNdDescriptor(probs_desc, CUDNN_DATA_FLOAT, 3, dims, strides));
+  CUDNN_CALL(cudnnSetTensorNdDescriptor(grads_desc, CUDNN_DATA_FLOAT, 3, dims, strides));
+  // the softmax of the activations is taken by cuDNN, the gradient is w.r.t. the activations
+  CUDNN_CALL(cudnnSetCTCLossDescriptor(ctc_desc, CUDNN_DATA_FLOAT));
+  size_t size_bytes = 0;
+  CUDNN_CALL(cudnnGetCTCLossWorkspaceSize(s->dnn_handle_,
+                                          probs_desc,
+                                          grads_desc,
+                                          labels,
+                                          label_lengths,
+                                          input_lengths,
+                                          CUDNN_CTC_LOSS_ALGO_DETERMINISTIC,
+                                          ctc_desc,
+                                          &size_bytes));
+  Tensor<gpu, 1, char> workspace =
+      temp.get_space_typed<gpu, 1, char>(Shape1(std::max<size_t>(size_bytes, 1)), s);
+  CUDNN_CALL(cudnnCTCLoss(s->dnn_handle_,
+                          probs_desc,
+                          activations.dptr_,
+                          labels,
+                          label_lengths,
+                          input_lengths,
+                          costs,
+                          grads_desc,
+                          grads,
+                          CUDNN_CTC_LOSS_ALGO_DETERMINISTIC,
+                          ctc_desc,
+                          workspace.dptr_,
+                          size_bytes));
+  CUDNN_CALL(cudnnDestroyCTCLossDescriptor(ctc_desc));
+  CUDNN_CALL(cudnnDestroyTensorDescriptor(grads_desc));
+  CUDNN_CALL(cudnnDestroyTensorDescriptor(probs_desc));
+  return CTC_STATUS_SUCCESS;
+}
+#endif  // MXNET_USE_CUDNN == 1
+
 template <typename DType>
 ctcStatus_t compute_ctc_cost(const Tensor<gpu, 3, DType> activations,
                              DType* costs,
@@ -34,13 +122,26 @@ ctcStatus_t compute_ctc_cost(const Tensor<gpu, 3, DType> activations,
                              int* labels,
                              int* label_lengths,
                              int* input_lengths,
-                             void* workspace,
+                             const mxnet::Resource& temp,
                              int train,
                              int blank_label) {
   int minibatch     = static_cast<int>(activations.size(1));
   int alphabet_size = static_cast<int>(activations.size(2));
+#if MXNET_USE_CUDNN == 1
+  if (UseCuDNNCTCLoss(activations, labels, label_lengths, input_lengths, train, blank_label)) {
+    return CuDNNCTCLoss(activations, costs, grads, labels, label_lengths, input_lengths, temp);
+  }
+#endif  // MXNET_USE_CUDNN == 1
+  std::vector<int> data_lengths(input_lengths, input_lengths + minibatch);
+  std::vector<int> label_length_vec(label_lengths, label_lengths + minibatch);
+  size_t size_bytes;
+  mxnet::op::get_workspace_size<DType>(
+      &label_length_vec, &data_lengths, alphabet_size, minibatch, &size_bytes);
+  // round-up so there are enough elems in memory
+  Tensor<gpu, 1, DType> workspace = temp.get_space_typed<gpu, 1, DType>(
+      Shape1((size_bytes + sizeof(DType) - 1) / sizeof(DType)), activations.stream_);
   mxnet_warpctc::GpuCTC<DType> ctc(
-      alphabet_size, minibatch, workspace, activations.stream_->stream_, blank_label);
+      alphabet_size, minibatch, workspace.dptr_, activations.stream_->stream_, blank_label);
   if (train)
     return ctc.cost_and_grad(activations.dptr_, grads, costs, labels, label_lengths, input_lengths);
   else
@@ -0,0 +1,278 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file ctc_loss_cpu.h
+ * \brief Batch-parallel CPU kernels for the CTC loss, computed in log space.
+ */
+#ifndef MXNET_OPERATOR_NN_CTC_LOSS_CPU_H_
+#define MXNET_OPERATOR_NN_CTC_LOSS_CPU_H_
+
+#include <dmlc/omp.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace mxnet {
+namespace op {
+namespace ctc {
+
+template <typename DType>
+inline DType NegInf() {
+  return -std::numeric_limits<DType>::infinity();
+}
+
+/*! \brief log(exp(a) + exp(b) + exp(c)) without branches, -inf stands for log(0) */
+template <typename DType>
+inline DType LogSumExp(DType a, DType b, DType c = NegInf<DType>()) {
+  const DType m    = std::max(a, std::max(b, c));
+  const DType base = m == NegInf<DType>() ? DType(0) : m;
+  return base + std::log(std::exp(a - base) + std::exp(b - base) + std::exp(c - base));
+}
+
+/*!
+ * \brief Bytes of workspace CTCLossCPU needs
+ * \param max_T The longest data sequence of the batch
+ * \param max_L The longest label sequence of the batch
+ * \param num_workers The number of batch elements computed concurrently
+ */
+template <typename DType>
+inline size_t CTCLossCPUWorkspaceSize(int max_T,
+                                      int max_L,
+                                      int alphabet_size,
+                                      int minibatch,
+                                      int num_workers) {
+  const size_t S = 2 * max_L + 1;
+  // the log probabilities of the whole batch
+  size_t size_bytes = sizeof(DType) * alphabet_size * max_T * minibatch;
+  // alphas, two columns of betas and the gradient sums of each worker, then its labels with
+  // blanks and their skip flags
+  size_bytes += num_workers * (sizeof(DType) * (S * max_T + 2 * S + alphabet_size) +
+                               sizeof(int) * 2 * S);
+  return size_bytes;
+}
+
+/*!
+ * \brief Loss, and gradient w.r.t. the activations if grad is set, of one batch element
+ * \param log_probs The log probabilities of the element at t = 0, a time step is stride apart
+ * \param grad The gradient of the element at t = 0, or nullptr
+ * \param T The length of the data sequence
+ * \param labels The L labels of the element
+ * \param work The workspace of the worker computing the element
+ * \return The negative log likelihood of the labels, 0 if they can't fit in T time steps
+ */
+template <typename DType>
+DType CTCLossElement(const DType* log_probs,
+                     DType* grad,
+                     size_t stride,
+                     int T,
+                     const int* labels,
+                     int L,
+                     int alphabet_size,
+                     int blank_label,
+                     int max_T,
+                     int max_L,
+                     char* work) {
+  const int max_S = 2 * max_L + 1;
+  const int S     = 2 * L + 1;
+  DType* alphas   = reinterpret_cast<DType*>(work);
+  DType* betas    = alphas + max_S * max_T;
+  DType* output   = betas + 2 * max_S;
+  int* lab        = reinterpret_cast<int*>(output + alphabet_size);
+  int* skip       = lab + max_S;
+
+  int repeats = 0;
+  for (int i = 1; i < L; ++i) {
+    repeats += labels[i] == labels[i - 1];
+  }
+  if (L + repeats > T) {
+    if (grad) {
+      for (int t = 0; t < T; ++t) {
+        std::fill(grad + t * stride, grad + t * stride + alphabet_size, DType(0));
+      }
+    }
+    return DType(0);
+  }
+  for (int s = 0; s < S; ++s) {
+    lab[s]  = s % 2 ? labels[s / 2] : blank_label;
+    skip[s] = s >= 2 && lab[s] != blank_label && lab[s] != lab[s - 2];
+  }
+
+  // forward variables, only the band of states that can still reach the end is computed
+  std::fill(alphas, alphas + S, NegInf<DType>());
+  alphas[0] = log_probs[blank_label];
+  if (S > 1)
+    alphas[1] = log_probs[lab[1]];
+  for (int t = 1; t < T; ++t) {
+    const DType* prev = alphas + (t - 1) * S;
+    DType* cur        = alphas + t * S;
+    const DType* lp   = log_probs + t * stride;
+    const int lo      = std::max(0, S - 2 * (T - t));
+    const int hi      = std::min(S, 2 * t + 2);
+    std::fill(cur, cur + lo, NegInf<DType>());
+    std::fill(cur + hi, cur + S, NegInf<DType>());
+    for (int s = lo; s < std::min(hi, 2); ++s) {
+      cur[s] = (s == 0 ? prev[0] : LogSumExp(prev[1], prev[0])) + lp[lab[s]];
+    }
+#pragma omp simd
+    for (int s = std::max(lo, 2); s < hi; ++s) {
+      const DType two = skip[s] ? prev[s - 2] : NegInf<DType>();
+      cur[s]          = LogSumExp(prev[s], prev[s - 1], two) + lp[lab[s]];
+    }
+  }
+  const DType* last = alphas + (T - 1) * S;
+  const DType loglike = S > 1 ? LogSumExp(last[S - 1], last[S - 2]) : last[S - 1];
+  if (!grad)
+    return -loglike;
+
+  // backward variables, two columns at a time, with the gradient of each time step
+  DType* next = betas;
+  DType* cur  = betas + max_S;
+  for (int t = T - 1; t >= 0; --t) {
+    const DType* lp = log_probs + t * stride;
+    const int lo    = std::max(0, S - 2 * (T - t));
+    const int hi    = std::min(S, 2 * t + 2);
+    std::fill(cur, cur + S, NegInf<DType>());
+    if (t == T - 1) {
+      for (int s = lo; s < hi; ++s) {
+        cur[s] = lp[lab[s]];
+      }
+    } else {
+#pragma omp simd
+      for (int s = lo; s < std::min(hi, S - 2); ++s) {
+        const DType two = skip[s + 2] ? next[s + 2] : NegInf<DType>();
+        cur[s]          = LogSumExp(next[s], next[s + 1], two) + lp[lab[s]];
+      }
+      for (int s = std::max(lo, S - 2); s < hi; ++s) {
+        cur[s] = (s == S - 1 ? next[s] : LogSumExp(next[s], next[s + 1])) + lp[lab[s]];
+      }
+    }
+    // sum the probability of the paths through each label at t, a reduce by key
+    const DType* alpha = alphas + t * S;
+    std::fill(output, output + alphabet_size, NegInf<DType>());
+    for (int s = lo; s < hi; ++s) {
+      output[lab[s]] = LogSumExp(output[lab[s]], alpha[s] + cur[s]);
+    }
+    DType* g = grad + t * stride;
+#pragma omp simd
+    for (int k = 0; k < alphabet_size; ++k) {
+      const DType path =
+          output[k] == NegInf<DType>() ? DType(0) : std::exp(output[k] - lp[k] - loglike);
+      g[k] = std::exp(lp[k]) - path;
+    }
+    std::swap(next, cur);
+  }
+  return -loglike;
+}
+
+/*!
+ * \brief CTC loss of a batch, and its gradient w.r.t. the activations if grads is set
+ * \param activations The (max_seq_len, minibatch, alphabet_size) unnormalized activations
+ * \param costs The loss of each batch element
+ * \param grads The gradient, or nullptr. Time steps past the length of an element are zero
+ * \param labels The labels of the batch elements, packed one after the other
+ * \param workspace CTCLossCPUWorkspaceSize bytes
+ * \param num_workers The number of threads, each computes whole batch elements
+ */
+template <typename DType>
+void CTCLossCPU(const DType* activations,
+                DType* costs,
+                DType* grads,
+                const int* labels,
+                const int* label_lengths,
+                const int* data_lengths,
+                int max_seq_len,
+                int minibatch,
+                int alphabet_size,
+                int blank_label,
+                void* workspace,
+                int num_workers) {
+  const int max_T     = *std::max_element(data_lengths, data_lengths + minibatch);
+  const int max_L     = *std::max_element(label_lengths, label_lengths + minibatch);
+  const size_t stride = static_cast<size_t>(minibatch) * alphabet_size;
+  DType* log_probs    = static_cast<DType*>(workspace);
+  char* work          = reinterpret_cast<char*>(log_probs + stride * max_T);
+  const size_t S      = 2 * max_L + 1;
+  const size_t worker_bytes =
+      sizeof(DType) * (S * max_T + 2 * S + alphabet_size) + sizeof(int) * 2 * S;
+
+  // log softmax of every time step within the length of its element
+  const int64_t rows = static_cast<int64_t>(max_seq_len) * minibatch;
+#pragma omp parallel for num_threads(num_workers)
+  for (int64_t r = 0; r < rows; ++r) {
+    const int t = r / minibatch;
+    if (t >= data_lengths[r % minibatch]) {
+      if (grads)
+        std::fill(grads + r * alphabet_size, grads + (r + 1) * alphabet_size, DType(0));
+      continue;
+    }
+    const DType* x = activations + r * alphabet_size;
+    DType* lp      = log_probs + r * alphabet_size;
+    DType m        = NegInf<DType>();
+#pragma omp simd reduction(max : m)
+    for (int k = 0; k < alphabet_size; ++k) {
+      m = std::max(m, x[k]);
+    }
+    DType sum = 0;
+#pragma omp simd reduction(+ : sum)
+    for (int k = 0; k < alphabet_size; ++k) {
+      sum += std::exp(x[k] - m);
+    }
+    const DType log_z = m + std::log(sum);
+#pragma omp simd
+    for (int k = 0; k < alphabet_size; ++k) {
+      lp[k] = x[k] - log_z;
+    }
+  }
+
+  // the longest elements first, so that the threads finish together
+  std::vector<int> offsets(minibatch);
+  std::exclusive_scan(label_lengths, label_lengths + minibatch, offsets.begin(), 0);
+  std::vector<int> order(minibatch);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return static_cast<int64_t>(data_lengths[a]) * (2 * label_lengths[a] + 1) >
+           static_cast<int64_t>(data_lengths[b]) * (2 * label_lengths[b] + 1);
+  });
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_workers)
+  for (int i = 0; i < minibatch; ++i) {
+    const int b = order[i];
+    DType* grad = grads ? grads + b * alphabet_size : nullptr;
+    costs[b]    = CTCLossElement(log_probs + b * alphabet_size,
+                                 grad,
+                                 stride,
+                                 data_lengths[b],
+                                 labels + offsets[b],
+                                 label_lengths[b],
+                                 alphabet_size,
+                                 blank_label,
+                                 max_T,
+                                 max_L,
+                                 work + omp_get_thread_num() * worker_bytes);
+  }
+}
+
+}  // namespace ctc
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_NN_CTC_LOSS_CPU_H_
@@ -37,6 +37,7 @@ namespace {
 struct Globals {
   cudnnTensorDescriptor_t io_desc;
   cudnnTensorDescriptor_t mean_desc;
+  cudnnActivationDescriptor_t relu_desc;
   bool internal_aux_states_lock = false;
 
   static Globals& Get() {
@@ -47,11 +48,15 @@ struct Globals {
   Globals() {
     CUDNN_CALL(cudnnCreateTensorDescriptor(&io_desc));
     CUDNN_CALL(cudnnCreateTensorDescriptor(&mean_desc));
+    CUDNN_CALL(cudnnCreateActivationDescriptor(&relu_desc));
+    CUDNN_CALL(
+        cudnnSetActivationDescriptor(relu_desc, CUDNN_ACTIVATION_RELU, CUDNN_PROPAGATE_NAN, 0.0));
   }
 
   ~Globals() {
     CUDNN_CALL(cudnnDestroyTensorDescriptor(io_desc));
     CUDNN_CALL(cudnnDestroyTensorDescriptor(mean_desc));
+    CUDNN_CALL(cudnnDestroyActivationDescriptor(relu_desc));
   }
 };
 
@@ -122,7 +127,8 @@ void CudnnBatchNormForward(const BatchNormParam& param,
           Globals::Get().mean_desc,
           nullptr,
           &workspace_size));
-      auto workspace = ctx.requested[0].get_space_internal(workspace_size, "CudnnBatchNormForward");
+      auto workspace =
+          ctx.requested[0].get_space_internal(workspace_size, "CudnnBatchNormForward", s);
 
       // If the lock on the auxiliary states is set, then this implies that
       // the preceding call is also a `Forward()` call, which further
@@ -206,7 +212,8 @@ void CudnnBatchNormBackward(const BatchNormParam& param,
                                                                Globals::Get().mean_desc,
                                                                nullptr,
                                                                &workspace_size));
-  auto workspace = ctx.requested[0].get_space_internal(workspace_size, "CudnnBatchNormBackward");
+  auto workspace =
+      ctx.requested[0].get_space_internal(workspace_size, "CudnnBatchNormBackward", s);
   MSHADOW_REAL_TYPE_SWITCH(ParamType(inputs[3 + batchnorm::kData].type_flag_), DType, {
     if (param.fix_gamma)
       inputs[3 + batchnorm::kGamma].FlatTo1D<gpu, DType>(s) = 1.0f;
@@ -258,6 +265,176 @@ void CudnnBatchNormBackward(const BatchNormParam& param,
   Globals::Get().internal_aux_states_lock = false;
 }
 
+bool CudnnBatchNormAddReluSupports(const BatchNormParam& param, const TBlob& x) {
+  int n = x.shape_.ndim();
+  return !param.cudnn_off && !param.use_global_stats && x.type_flag_ == mshadow::kFloat16 &&
+         n == 4 && param.axis == n - 1 && x.shape_[param.axis] % 4 == 0;
+}
+
+size_t CudnnBatchNormAddReluReserveSize(const BatchNormParam& param,
+                                        const OpContext& ctx,
+                                        const TBlob& x) {
+  SetDescriptors(param, x);
+  size_t reserve_size = 0;
+  CUDNN_CALL(
+      cudnnGetBatchNormalizationTrainingExReserveSpaceSize(ctx.get_stream<gpu>()->dnn_handle_,
+                                                           CUDNN_BATCHNORM_SPATIAL_PERSISTENT,
+                                                           CUDNN_BATCHNORM_OPS_BN_ADD_ACTIVATION,
+                                                           Globals::Get().relu_desc,
+                                                           Globals::Get().io_desc,
+                                                           &reserve_size));
+  return reserve_size;
+}
+
+void CudnnBatchNormAddReluForward(const BatchNormParam& param,
+                                  const OpContext& ctx,
+                                  const std::vector<TBlob>& inputs,
+                                  const std::vector<OpReqType>& req,
+                                  const std::vector<TBlob>& outputs,
+                                  void* reserve,
+                                  size_t reserve_size) {
+  CHECK_EQ(inputs.size(), 6);
+  CHECK_EQ(outputs.size(), 3);
+  CHECK(ctx.is_train);
+  CHECK_EQ(req[batchnorm::kOut], kWriteTo);
+  const TBlob& addend = inputs[5];
+
+  SetDescriptors(param, inputs[batchnorm::kData]);
+
+  auto s = ctx.get_stream<gpu>();
+  MSHADOW_REAL_TYPE_SWITCH(ParamType(inputs[batchnorm::kData].type_flag_), DType, {
+    DType a = 1.0f;
+    DType b = 0.0f;
+    if (param.fix_gamma)
+      inputs[batchnorm::kGamma].FlatTo1D<gpu, DType>(s) = 1.0f;
+    size_t workspace_size = 0;
+    CUDNN_CALL(cudnnGetBatchNormalizationForwardTrainingExWorkspaceSize(
+        s->dnn_handle_,
+        CUDNN_BATCHNORM_SPATIAL_PERSISTENT,
+        CUDNN_BATCHNORM_OPS_BN_ADD_ACTIVATION,
+        Globals::Get().io_desc,
+        Globals::Get().io_desc,
+        Globals::Get().io_desc,
+        Globals::Get().mean_desc,
+        Globals::Get().relu_desc,
+        &workspace_size));
+    auto workspace =
+        ctx.requested[0].get_space_internal(workspace_size, "CudnnBatchNormAddReluForward", s);
+    // See CudnnBatchNormForward() for the lock on the auxiliary states.
+    double factor =
+        ((dmlc::GetEnv("MXNET_BACKWARD_DO_MIRROR", 0) || dmlc::GetEnv("MXNET_MEMORY_OPT", 0)) &&
+         Globals::Get().internal_aux_states_lock) ?
+            0 :
+            (1 - param.momentum);
+    CUDNN_CALL(cudnnBatchNormalizationForwardTrainingEx(s->dnn_handle_,
+                                                        CUDNN_BATCHNORM_SPATIAL_PERSISTENT,
+                                                        CUDNN_BATCHNORM_OPS_BN_ADD_ACTIVATION,
+                                                        &a,
+                                                        &b,
+                                                        Globals::Get().io_desc,
+                                                        inputs[batchnorm::kData].dptr_,
+                                                        Globals::Get().io_desc,
+                                                        addend.dptr_,
+                                                        Globals::Get().io_desc,
+                                                        outputs[batchnorm::kOut].dptr_,
+                                                        Globals::Get().mean_desc,
+                                                        inputs[batchnorm::kGamma].dptr_,
+                                                        inputs[batchnorm::kBeta].dptr_,
+                                                        factor,
+                                                        inputs[batchnorm::kInMovingMean].dptr_,
+                                                        inputs[batchnorm::kInMovingVar].dptr_,
+                                                        param.eps,
+                                                        outputs[batchnorm::kMean].dptr_,
+                                                        outputs[batchnorm::kVar].dptr_,
+                                                        Globals::Get().relu_desc,
+                                                        workspace,
+                                                        workspace_size,
+                                                        reserve,
+                                                        reserve_size));
+  })
+  Globals::Get().internal_aux_states_lock = true;
+}
+
+void CudnnBatchNormAddReluBackward(const BatchNormParam& param,
+                                   const OpContext& ctx,
+                                   const std::vector<TBlob>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& outputs,
+                                   void* reserve,
+                                   size_t reserve_size) {
+  CHECK_EQ(inputs.size(), 9);
+  CHECK_EQ(outputs.size(), 4);
+  CHECK_EQ(req.size(), 4);
+  CHECK_NE(req[3], kAddTo) << "the gradient of the addend is always written";
+  const TBlob& out      = inputs[8];
+  const TBlob& d_addend = outputs[3];
+
+  SetDescriptors(param, inputs[3 + batchnorm::kData]);
+  auto s                = ctx.get_stream<gpu>();
+  size_t workspace_size = 0;
+  CUDNN_CALL(cudnnGetBatchNormalizationBackwardExWorkspaceSize(
+      s->dnn_handle_,
+      CUDNN_BATCHNORM_SPATIAL_PERSISTENT,
+      CUDNN_BATCHNORM_OPS_BN_ADD_ACTIVATION,
+      Globals::Get().io_desc,
+      Globals::Get().io_desc,
+      Globals::Get().io_desc,
+      Globals::Get().io_desc,
+      Globals::Get().io_desc,
+      Globals::Get().mean_desc,
+      Globals::Get().relu_desc,
+      &workspace_size));
+  auto workspace =
+      ctx.requested[0].get_space_internal(workspace_size, "CudnnBatchNormAddReluBackward", s);
+  MSHADOW_REAL_TYPE_SWITCH(ParamType(inputs[3 + batchnorm::kData].type_flag_), DType, {
+    if (param.fix_gamma)
+      inputs[3 + batchnorm::kGamma].FlatTo1D<gpu, DType>(s) = 1.0f;
+    bool grad_add_gamma_beta = req[batchnorm::kGamma] == kAddTo || req[batchnorm::kBeta] == kAddTo;
+    if (grad_add_gamma_beta) {
+      if (IsBNWriting(req[batchnorm::kGamma]))
+        outputs[batchnorm::kGamma].FlatTo1D<gpu, DType>(s) = 0.0f;
+      if (IsBNWriting(req[batchnorm::kBeta]))
+        outputs[batchnorm::kBeta].FlatTo1D<gpu, DType>(s) = 0.0f;
+    }
+    DType a     = 1.0f;
+    DType b     = 0.0f;
+    DType b_add = 1.0f;
+    CUDNN_CALL(cudnnBatchNormalizationBackwardEx(s->dnn_handle_,
+                                                 CUDNN_BATCHNORM_SPATIAL_PERSISTENT,
+                                                 CUDNN_BATCHNORM_OPS_BN_ADD_ACTIVATION,
+                                                 &a,
+                                                 req[batchnorm::kData] == kAddTo ? &b_add : &b,
+                                                 &a,
+                                                 grad_add_gamma_beta ? &b_add : &b,
+                                                 Globals::Get().io_desc,
+                                                 inputs[3 + batchnorm::kData].dptr_,
+                                                 Globals::Get().io_desc,
+                                                 out.dptr_,
+                                                 Globals::Get().io_desc,
+                                                 inputs[batchnorm::kOut].dptr_,
+                                                 Globals::Get().io_desc,
+                                                 d_addend.dptr_,
+                                                 Globals::Get().io_desc,
+                                                 outputs[batchnorm::kData].dptr_,
+                                                 Globals::Get().mean_desc,
+                                                 inputs[3 + batchnorm::kGamma].dptr_,
+                                                 inputs[3 + batchnorm::kBeta].dptr_,
+                                                 outputs[batchnorm::kGamma].dptr_,
+                                                 outputs[batchnorm::kBeta].dptr_,
+                                                 param.eps,
+                                                 inputs[batchnorm::kMean].dptr_,
+                                                 inputs[batchnorm::kVar].dptr_,
+                                                 Globals::Get().relu_desc,
+                                                 workspace,
+                                                 workspace_size,
+                                                 reserve,
+                                                 reserve_size));
+    if (param.fix_gamma)
+      outputs[batchnorm::kGamma].FlatTo1D<gpu, DType>(s) = 0.0f;
+  })
+  Globals::Get().internal_aux_states_lock = false;
+}
+
 #endif  // MXNET_USE_CUDNN == 1
 }  // namespace op
 }  // namespace mxnet
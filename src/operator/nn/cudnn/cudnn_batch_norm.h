@@ -51,6 +51,43 @@ void CudnnBatchNormBackward(const BatchNormParam& param,
                             const std::vector<OpReqType>& req,
                             const std::vector<TBlob>& outputs);
 
+/*!
+ * \brief Whether the training pass of relu(batchnorm(x) + z) runs fused in cuDNN, which
+ *        requires float16 NHWC data with a multiple of 4 channels.
+ */
+bool CudnnBatchNormAddReluSupports(const BatchNormParam& param, const TBlob& x);
+
+/*! \brief bytes of the reserve space the fused forward pass leaves to the backward pass */
+size_t CudnnBatchNormAddReluReserveSize(const BatchNormParam& param,
+                                        const OpContext& ctx,
+                                        const TBlob& x);
+
+/*!
+ * \brief Training pass of out = relu(batchnorm(data) + addend).
+ *        The inputs are data, gamma, beta, moving_mean, moving_var and addend, the outputs
+ *        out, mean and var.
+ */
+void CudnnBatchNormAddReluForward(const BatchNormParam& param,
+                                  const OpContext& ctx,
+                                  const std::vector<TBlob>& inputs,
+                                  const std::vector<OpReqType>& req,
+                                  const std::vector<TBlob>& outputs,
+                                  void* reserve,
+                                  size_t reserve_size);
+
+/*!
+ * \brief Backward of CudnnBatchNormAddReluForward, from its reserve space.
+ *        The inputs are the gradient of out, mean, var, the inputs of the forward pass but
+ *        addend, and out. The outputs are the gradients of data, gamma, beta and addend.
+ */
+void CudnnBatchNormAddReluBackward(const BatchNormParam& param,
+                                   const OpContext& ctx,
+                                   const std::vector<TBlob>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& outputs,
+                                   void* reserve,
+                                   size_t reserve_size);
+
 #endif  // MXNET_USE_CUDNN == 1
 
 }  // namespace op
@@ -43,6 +43,7 @@
 #include "mxnet/ndarray.h"
 #include "mxnet/op_attr_types.h"
 #include "mxnet/resource.h"
+#include "dnnl_cache-inl.h"
 
 #define DNNL_REAL_TYPE_SWITCH(type, DType, ...)   \
   switch (type) {                                 \
@@ -214,24 +215,6 @@ static inline bool DNNLEnvSet() {
   return is_dnnl_enabled;
 }
 
-static inline int GetDNNLCacheSize() {
-  static int dnnl_cache_size = dmlc::GetEnv("MXNET_ONEDNN_CACHE_NUM", -1);
-  return dnnl_cache_size;
-}
-
-// TODO(alex): (MXNET-1075) Will remove env variable and calculate cache size during runtime
-template <typename S, typename I, typename H>
-static typename std::unordered_map<S, I, H>::iterator AddToCache(std::unordered_map<S, I, H>* cache,
-                                                                 const S& key,
-                                                                 const I& item) {
-  int dnnl_cache_size = GetDNNLCacheSize();
-  if (dnnl_cache_size != -1 && static_cast<int>(cache->size()) > dnnl_cache_size)
-    cache->erase(cache->begin());
-  auto ins_return = cache->insert(std::pair<S, I>(key, item));
-  CHECK(ins_return.second);
-  return ins_return.first;
-}
-
 /*
  * This is to align address to a certain alignment.
  */
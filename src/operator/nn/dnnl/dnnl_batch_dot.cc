@@ -41,7 +41,7 @@ bool SupportDNNLBatchDot(const std::vector<NDArray>& inputs) {
 DNNLBatchDotFwd& DNNLBatchDotFwd::GetCached(const DNNLDotParam& param,
                                             const std::vector<NDArray>& inputs,
                                             const std::vector<NDArray>& outputs) {
-  using batch_dot_fwd_map = std::unordered_map<BatchDotSignature, DNNLBatchDotFwd, OpHash>;
+  using batch_dot_fwd_map = DNNLCache<BatchDotSignature, DNNLBatchDotFwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
   static thread_local batch_dot_fwd_map fwds;
 #else
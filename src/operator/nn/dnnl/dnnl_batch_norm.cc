@@ -64,9 +64,9 @@ DNNLBNForward& DNNLBNForward::GetCached(const BatchNormParam& param,
                                         bool fuse_relu,
                                         dnnl::normalization_flags flags) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLBNSignature, DNNLBNForward, OpHash> fwds;
+  static thread_local DNNLCache<DNNLBNSignature, DNNLBNForward, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLBNSignature, DNNLBNForward, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLCache<DNNLBNSignature, DNNLBNForward, OpHash> fwds;
 #endif
 
   DNNLBNSignature key(param);
@@ -215,9 +215,9 @@ DNNLBNBackward& DNNLBNBackward::GetCached(const BatchNormParam& param,
                                           const dnnl::memory& diff_mem,
                                           dnnl::normalization_flags flags) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLBNSignature, DNNLBNBackward, OpHash> bwds;
+  static thread_local DNNLCache<DNNLBNSignature, DNNLBNBackward, OpHash> bwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLBNSignature, DNNLBNBackward, OpHash> bwds;
+  static MX_THREAD_LOCAL DNNLCache<DNNLBNSignature, DNNLBNBackward, OpHash> bwds;
 #endif
   DNNLBNSignature key(param);
   key.AddSign(in_data);
@@ -58,7 +58,7 @@ class DNNLBinaryOpFwd {
 template <dnnl::algorithm alg>
 DNNLBinaryOpFwd& DNNLBinaryOpFwd::GetBinaryOpForward(const std::vector<NDArray>& inputs,
                                                      const std::vector<NDArray>& outputs) {
-  using binary_op_fwd_map = std::unordered_map<OpSignature, DNNLBinaryOpFwd, OpHash>;
+  using binary_op_fwd_map = DNNLCache<OpSignature, DNNLBinaryOpFwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
   static thread_local binary_op_fwd_map fwds;
 #else
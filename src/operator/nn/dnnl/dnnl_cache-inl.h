@@ -0,0 +1,296 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file dnnl_cache-inl.h
+ * \brief bounded LRU caches of oneDNN primitives, per thread or shared by all threads
+ */
+
+#ifndef MXNET_OPERATOR_NN_DNNL_DNNL_CACHE_INL_H_
+#define MXNET_OPERATOR_NN_DNNL_DNNL_CACHE_INL_H_
+
+#if MXNET_USE_ONEDNN == 1
+#include <dmlc/parameter.h>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#endif
+
+#include "dnnl.hpp"
+#include "mxnet/ndarray.h"
+#include "../../../profiler/metrics.h"
+
+namespace mxnet {
+
+/*! \brief maximum number of items of each cache, -1 for no limit */
+static inline int GetDNNLCacheSize() {
+  static int dnnl_cache_size = dmlc::GetEnv("MXNET_ONEDNN_CACHE_NUM", -1);
+  return dnnl_cache_size;
+}
+
+/*! \brief maximum estimated bytes of each cache, -1 for no limit */
+static inline int64_t GetDNNLCacheBytes() {
+  static int64_t dnnl_cache_bytes = dmlc::GetEnv("MXNET_ONEDNN_CACHE_BYTES", int64_t(-1));
+  return dnnl_cache_bytes;
+}
+
+/*!
+ * \brief Estimated bytes held by a cached item. The memory of the JIT code of a primitive
+ *  cannot be queried, so primitive wrappers count their scratchpad, which oneDNN allocates
+ *  with the primitive, and cached arrays count their data. Items shared between caches
+ *  count in each of them.
+ */
+template <typename T>
+inline auto DNNLCacheItemBytes(const T& item, int)
+    -> decltype(static_cast<size_t>(item.GetPd().scratchpad_desc().get_size())) {
+  return sizeof(T) + item.GetPd().scratchpad_desc().get_size();
+}
+
+template <typename T>
+inline size_t DNNLCacheItemBytes(const T& item, int64_t) {
+  return sizeof(T);
+}
+
+inline size_t DNNLCacheItemBytes(const std::pair<NDArray, NDArray>& item, int) {
+  size_t bytes = sizeof(item);
+  for (const NDArray* arr : {&item.first, &item.second}) {
+    if (!arr->is_none()) {
+      bytes += arr->shape().Size() * mshadow::mshadow_sizeof(arr->dtype());
+    }
+  }
+  return bytes;
+}
+
+template <typename T>
+inline size_t DNNLCacheItemBytes(const std::shared_ptr<T>& item, int) {
+  return sizeof(item) + DNNLCacheItemBytes(*item, 0);
+}
+
+/*!
+ * \brief Hit, miss and eviction counters of the caches of one kind of item, exported with the
+ *  metrics of the process and forwarded to the profiler while it runs
+ */
+struct DNNLCacheStats {
+  profiler::MetricCounter* hits;
+  profiler::MetricCounter* misses;
+  profiler::MetricCounter* evictions;
+
+  /*! \brief counters of the caches of items of type T, labelled with its name */
+  template <typename T>
+  static DNNLCacheStats* Get() {
+    static DNNLCacheStats* stats = new DNNLCacheStats(CacheName(typeid(T).name()));
+    return stats;
+  }
+
+ private:
+  explicit DNNLCacheStats(const std::string& name) {
+    profiler::Metrics* metrics = profiler::Metrics::Get();
+    hits      = metrics->GetCounter("mxnet_onednn_cache_hits",
+                               "Lookups of oneDNN primitives found in the cache.",
+                               {{"cache", name}});
+    misses    = metrics->GetCounter("mxnet_onednn_cache_misses",
+                                 "Lookups of oneDNN primitives that had to create them.",
+                                 {{"cache", name}});
+    evictions = metrics->GetCounter("mxnet_onednn_cache_evictions",
+                                    "oneDNN primitives evicted from a full cache.",
+                                    {{"cache", name}});
+  }
+
+  /*! \brief the item type without namespaces, e.g. DNNLConvForward */
+  static std::string CacheName(const char* mangled) {
+    std::string name = mangled;
+#if defined(__GNUC__)
+    int status = -4;
+    std::unique_ptr<char, void (*)(void*)> res{
+        abi::__cxa_demangle(mangled, nullptr, nullptr, &status), &std::free};
+    if (status == 0) {
+      name = res.get();
+    }
+#endif
+    for (const std::string prefix : {"class ", "struct ", "mxnet::op::", "mxnet::"}) {
+      for (size_t pos = name.find(prefix); pos != std::string::npos; pos = name.find(prefix)) {
+        name.erase(pos, prefix.size());
+      }
+    }
+    return name;
+  }
+};
+
+/*!
+ * \brief Cache of one thread, evicting the least recently used items beyond
+ *  MXNET_ONEDNN_CACHE_NUM items or MXNET_ONEDNN_CACHE_BYTES estimated bytes.
+ *
+ *  It has the subset of the interface of std::unordered_map the operators use: find() marks
+ *  the item as used, and the iterators and references to items stay valid until the item is
+ *  evicted, which only happens when inserting. Use AddToCache to insert.
+ */
+template <typename S, typename I, typename H>
+class DNNLCache {
+ public:
+  using value_type = std::pair<const S, I>;
+  using iterator   = typename std::list<value_type>::iterator;
+
+  /*!
+   * \param stats counters of the cache, null to not count
+   * \param count_lookups whether lookups count as hits and misses, or only evictions count
+   */
+  explicit DNNLCache(DNNLCacheStats* stats = DNNLCacheStats::Get<I>(), bool count_lookups = true)
+      : stats_(stats), count_lookups_(count_lookups) {}
+
+  iterator find(const S& key) {
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+      if (stats_ != nullptr && count_lookups_) {
+        stats_->misses->Add(1);
+      }
+      return items_.end();
+    }
+    if (stats_ != nullptr && count_lookups_) {
+      stats_->hits->Add(1);
+    }
+    items_.splice(items_.begin(), items_, it->second.first);
+    return it->second.first;
+  }
+
+  iterator end() {
+    return items_.end();
+  }
+
+  /*! \brief insert an item that is not cached yet, evicting the least recently used ones */
+  iterator insert(const S& key, const I& item) {
+    const size_t item_bytes = DNNLCacheItemBytes(item, 0);
+    const int max_size      = GetDNNLCacheSize();
+    const int64_t max_bytes = GetDNNLCacheBytes();
+    while (!items_.empty() &&
+           ((max_size != -1 && static_cast<int>(items_.size()) >= max_size) ||
+            (max_bytes != -1 && static_cast<int64_t>(bytes_ + item_bytes) > max_bytes))) {
+      auto last = index_.find(items_.back().first);
+      bytes_ -= last->second.second;
+      index_.erase(last);
+      items_.pop_back();
+      if (stats_ != nullptr) {
+        stats_->evictions->Add(1);
+      }
+    }
+    items_.emplace_front(key, item);
+    auto ins_return = index_.emplace(key, std::make_pair(items_.begin(), item_bytes));
+    CHECK(ins_return.second);
+    bytes_ += item_bytes;
+    return items_.begin();
+  }
+
+  size_t size() const {
+    return items_.size();
+  }
+
+  /*! \brief estimated bytes held by the items */
+  size_t bytes() const {
+    return bytes_;
+  }
+
+ private:
+  /*! \brief items, the most recently used first */
+  std::list<value_type> items_;
+  /*! \brief the item and its estimated bytes of each key */
+  std::unordered_map<S, std::pair<iterator, size_t>, H> index_;
+  size_t bytes_ = 0;
+  DNNLCacheStats* stats_;
+  const bool count_lookups_;
+};
+
+template <typename S, typename I, typename H>
+static typename DNNLCache<S, I, H>::iterator AddToCache(DNNLCache<S, I, H>* cache,
+                                                        const S& key,
+                                                        const I& item) {
+  return cache->insert(key, item);
+}
+
+/*!
+ * \brief Cache shared by all threads, for primitive wrappers that are immutable once created,
+ *  such as the forward convolution and inner product: executing a oneDNN primitive is thread
+ *  safe, so every engine thread can execute the same one instead of creating its own.
+ *
+ *  Each thread keeps the items it used last in a DNNLCache of its own, so that hits do not
+ *  take the lock. An item evicted from the shared cache stays alive until the threads using
+ *  it evict it too.
+ */
+template <typename S, typename I, typename H>
+class DNNLSharedCache {
+ public:
+  static DNNLSharedCache* Get() {
+    static DNNLSharedCache* inst = new DNNLSharedCache();
+    return inst;
+  }
+
+  /*!
+   * \brief get the item of a key, created with create() if no thread has it
+   * \return the item, valid until the calling thread looks up MXNET_ONEDNN_CACHE_NUM other keys
+   */
+  template <typename F>
+  I& GetOrCreate(const S& key, F create) {
+#if DMLC_CXX11_THREAD_LOCAL
+    static thread_local DNNLCache<S, std::shared_ptr<I>, H> local(nullptr);
+#else
+    static MX_THREAD_LOCAL DNNLCache<S, std::shared_ptr<I>, H> local(nullptr);
+#endif
+    auto local_it = local.find(key);
+    if (local_it != local.end()) {
+      stats_->hits->Add(1);
+      return *local_it->second;
+    }
+    std::shared_ptr<I> item;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = shared_.find(key);
+      if (it != shared_.end()) {
+        item = it->second;
+      }
+    }
+    if (item == nullptr) {
+      // created without the lock, the threads that raced for the same key use the first one
+      std::shared_ptr<I> created = create();
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = shared_.find(key);
+      item    = it != shared_.end() ? it->second : AddToCache(&shared_, key, created)->second;
+      stats_->misses->Add(1);
+    } else {
+      stats_->hits->Add(1);
+    }
+    return *AddToCache(&local, key, item)->second;
+  }
+
+ private:
+  DNNLSharedCache() : shared_(DNNLCacheStats::Get<I>(), false), stats_(DNNLCacheStats::Get<I>()) {}
+
+  std::mutex mutex_;
+  DNNLCache<S, std::shared_ptr<I>, H> shared_;
+  DNNLCacheStats* stats_;
+};
+
+}  // namespace mxnet
+#endif  // MXNET_USE_ONEDNN == 1
+#endif  // MXNET_OPERATOR_NN_DNNL_DNNL_CACHE_INL_H_
@@ -61,9 +61,9 @@ DNNLConcatFwd& DNNLConcatFwd::GetCached(int concat_dim,
                                         const std::vector<dnnl::memory::desc>& data_md,
                                         int stack_axis /*used only by stack op*/) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<OpSignature, DNNLConcatFwd, OpHash> fwds;
+  static thread_local DNNLCache<OpSignature, DNNLConcatFwd, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<OpSignature, DNNLConcatFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLCache<OpSignature, DNNLConcatFwd, OpHash> fwds;
 #endif
 
   OpSignature key;
@@ -40,6 +40,9 @@ DMLC_REGISTER_PARAMETER(DNNLConvParam);
 bool SupportDNNLConv(const ConvolutionParam& params, const NDArray& input) {
   if (params.kernel.ndim() > 3 || params.kernel.ndim() == 0)
     return false;
+  // the memory descriptors assume channels first, NHWC data runs the fallback kernels
+  if (params.layout.has_value() && params.layout.value() == mshadow::kNHWC)
+    return false;
   return SupportDNNL<3, 5, DNNLTypeMode::AllTypes>(input);
 }
 
@@ -432,12 +435,6 @@ DNNLConvForward& GetConvFwd(const DNNLConvFullParam& param,
                             const NDArray& weight,
                             const NDArray* bias,
                             const NDArray& output) {
-  using conv_fwd_map = std::unordered_map<DNNLConvSignature, DNNLConvForward, OpHash>;
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local conv_fwd_map fwds;
-#else
-  static MX_THREAD_LOCAL conv_fwd_map fwds;
-#endif
   // TODO(zhennan): Hash conv_param for now, need to hash full param if we want to enable cache for
   // fused conv
   DNNLConvSignature key(param.conv_param);
@@ -450,12 +447,11 @@ DNNLConvForward& GetConvFwd(const DNNLConvFullParam& param,
   if (bias)
     key.AddSign(*bias);
 
-  auto it = fwds.find(key);
-  if (it == fwds.end()) {
-    auto fwd = DNNLConvForward(param, is_train, data, weight, bias, output);
-    it       = AddToCache(&fwds, key, fwd);
-  }
-  return it->second;
+  // the forward primitive is not modified once created, all the engine threads share it
+  return DNNLSharedCache<DNNLConvSignature, DNNLConvForward, OpHash>::Get()->GetOrCreate(
+      key, [&]() {
+        return std::make_shared<DNNLConvForward>(param, is_train, data, weight, bias, output);
+      });
 }
 
 void DNNLConvolutionForwardFullFeature(const DNNLConvFullParam& param,
@@ -550,7 +546,7 @@ static inline DNNLConvBackward& GetConvBwd(const DNNLConvFullParam& param,
                                            const NDArray& weight,
                                            const NDArray* bias,
                                            const NDArray& output) {
-  using dnnl_conv_bwd_map = std::unordered_map<DNNLConvSignature, DNNLConvBackward, OpHash>;
+  using dnnl_conv_bwd_map = DNNLCache<DNNLConvSignature, DNNLConvBackward, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
   static thread_local dnnl_conv_bwd_map bwds;
 #else
@@ -80,7 +80,7 @@ DNNLDeconvFwd::DNNLDeconvFwd(const DeconvolutionParam& param, const Tensors& ten
 }
 
 DNNLDeconvFwd& DNNLDeconvFwd::GetCached(const DeconvolutionParam& param, const Tensors& tensors) {
-  using deconv_fwd_map = std::unordered_map<DeconvSignature, DNNLDeconvFwd, OpHash>;
+  using deconv_fwd_map = DNNLCache<DeconvSignature, DNNLDeconvFwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
   static thread_local deconv_fwd_map fwds;
 #else
@@ -223,7 +223,7 @@ DNNLDeconvBwd::DNNLDeconvBwd(const DeconvolutionParam& param, const ReadTensors&
 
 DNNLDeconvBwd& DNNLDeconvBwd::GetCached(const DeconvolutionParam& param,
                                         const ReadTensors& read_tensors) {
-  using deconv_bwd_map = std::unordered_map<DeconvSignature, DNNLDeconvBwd, OpHash>;
+  using deconv_bwd_map = DNNLCache<DeconvSignature, DNNLDeconvBwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
   static thread_local deconv_bwd_map bwds;
 #else
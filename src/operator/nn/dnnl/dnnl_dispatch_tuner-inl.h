@@ -0,0 +1,106 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file dnnl_dispatch_tuner-inl.h
+ * \brief selection between the oneDNN and the native CPU kernels of an operator by timing both
+ *  on the first call with each shape
+ */
+
+#ifndef MXNET_OPERATOR_NN_DNNL_DNNL_DISPATCH_TUNER_INL_H_
+#define MXNET_OPERATOR_NN_DNNL_DNNL_DISPATCH_TUNER_INL_H_
+
+#if MXNET_USE_ONEDNN == 1
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mxnet/ndarray.h"
+#include "mxnet/op_attr_types.h"
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * \brief Cache of the fastest implementation of operator calls, enabled by
+ *  MXNET_ONEDNN_DISPATCH_TUNE. The candidates of a call missing from the cache are timed on
+ *  the call itself, which thus runs each of them several times. The winners persist in the
+ *  file set by MXNET_ONEDNN_DISPATCH_CACHE, one line per call with its key and the index of
+ *  its implementation separated by a tab.
+ */
+class DNNLDispatchTuner {
+ public:
+  using Impl = std::function<void()>;
+
+  static DNNLDispatchTuner* Get();
+
+  bool Enabled() const {
+    return enabled_;
+  }
+
+  /*!
+   * \brief Run the implementation selected for key
+   * \param key the operator call, covering all that the fastest implementation depends on
+   * \param impls the equivalent implementations, the first one is the default
+   * \param tunable whether the implementations can run repeatedly, i.e. they overwrite their
+   *  outputs without reading them
+   */
+  void Run(const std::string& key, const std::vector<Impl>& impls, bool tunable);
+
+ private:
+  DNNLDispatchTuner();
+  /*! \brief Time the implementations and return the index of the fastest */
+  size_t Tune(const std::vector<Impl>& impls) const;
+
+  bool enabled_ = false;
+  std::string path_;
+  std::mutex mutex_;
+  std::unordered_map<std::string, size_t> selected_;
+};
+
+/*! \brief Key of an operator call in the dispatch cache */
+std::string DNNLDispatchKey(const nnvm::NodeAttrs& attrs, const std::vector<NDArray>& inputs);
+
+/*!
+ * \brief Run the oneDNN or the native implementation of an operator call, the oneDNN one
+ *  unless the dispatch tuner found the native one faster for the call
+ */
+template <typename DNNLImpl, typename NativeImpl>
+inline void DNNLDispatch(const nnvm::NodeAttrs& attrs,
+                         const std::vector<NDArray>& inputs,
+                         const std::vector<OpReqType>& req,
+                         const DNNLImpl& dnnl_impl,
+                         const NativeImpl& native_impl) {
+  DNNLDispatchTuner* tuner = DNNLDispatchTuner::Get();
+  if (!tuner->Enabled()) {
+    dnnl_impl();
+    return;
+  }
+  bool tunable = true;
+  for (OpReqType r : req)
+    tunable = tunable && (r == kWriteTo || r == kNullOp);
+  tuner->Run(DNNLDispatchKey(attrs, inputs), {dnnl_impl, native_impl}, tunable);
+}
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_USE_ONEDNN == 1
+#endif  // MXNET_OPERATOR_NN_DNNL_DNNL_DISPATCH_TUNER_INL_H_
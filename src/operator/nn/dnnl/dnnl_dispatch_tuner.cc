@@ -0,0 +1,129 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file dnnl_dispatch_tuner.cc
+ * \brief selection between the oneDNN and the native CPU kernels of an operator
+ */
+
+#if MXNET_USE_ONEDNN == 1
+#include <dmlc/parameter.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+
+#include "../../../engine/openmp.h"
+#include "dnnl_base-inl.h"
+#include "dnnl_dispatch_tuner-inl.h"
+
+namespace mxnet {
+namespace op {
+
+DNNLDispatchTuner* DNNLDispatchTuner::Get() {
+  static DNNLDispatchTuner inst;
+  return &inst;
+}
+
+DNNLDispatchTuner::DNNLDispatchTuner() {
+  enabled_ = dmlc::GetEnv("MXNET_ONEDNN_DISPATCH_TUNE", false);
+  path_    = dmlc::GetEnv("MXNET_ONEDNN_DISPATCH_CACHE", std::string());
+  if (!enabled_ || path_.empty())
+    return;
+  std::ifstream file(path_);
+  for (std::string line; std::getline(file, line);) {
+    auto tab = line.rfind('\t');
+    if (tab == std::string::npos)
+      continue;
+    std::istringstream ss(line.substr(tab + 1));
+    size_t impl;
+    if (ss >> impl)
+      selected_[line.substr(0, tab)] = impl;
+  }
+}
+
+void DNNLDispatchTuner::Run(const std::string& key, const std::vector<Impl>& impls, bool tunable) {
+  size_t impl = impls.size();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = selected_.find(key);
+    if (it != selected_.end())
+      impl = std::min(it->second, impls.size() - 1);
+  }
+  if (impl < impls.size()) {
+    impls[impl]();
+    return;
+  }
+  if (!tunable) {
+    // calls accumulating to their outputs or running in place are left to a later call
+    impls[0]();
+    return;
+  }
+  impl = Tune(impls);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!selected_.emplace(key, impl).second || path_.empty())
+    return;
+  std::ofstream file(path_, std::ios::app);
+  file << key << '\t' << impl << '\n';
+  if (!file)
+    LOG(WARNING) << "Failed to write the oneDNN dispatch cache " << path_;
+}
+
+size_t DNNLDispatchTuner::Tune(const std::vector<Impl>& impls) const {
+  // the first run of an implementation creates its primitives and reorders its weights
+  constexpr int kRuns = 3;
+  size_t best         = 0;
+  double best_time    = std::numeric_limits<double>::max();
+  for (size_t i = 0; i < impls.size(); ++i) {
+    impls[i]();
+    double time = std::numeric_limits<double>::max();
+    for (int run = 0; run < kRuns; ++run) {
+      auto start = std::chrono::steady_clock::now();
+      impls[i]();
+      time = std::min(
+          time, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    if (time < best_time) {
+      best      = i;
+      best_time = time;
+    }
+  }
+  return best;
+}
+
+std::string DNNLDispatchKey(const nnvm::NodeAttrs& attrs, const std::vector<NDArray>& inputs) {
+  std::ostringstream ss;
+  ss << "isa " << static_cast<int>(dnnl::get_effective_cpu_isa()) << " threads "
+     << engine::OpenMP::Get()->GetRecommendedOMPThreadCount() << " " << attrs.op->name;
+  // the attributes in a fixed order
+  for (const auto& attr : std::map<std::string, std::string>(attrs.dict.begin(), attrs.dict.end()))
+    ss << " " << attr.first << "=" << attr.second;
+  for (const NDArray& input : inputs)
+    ss << " " << input.shape() << ":" << input.dtype();
+  auto ret = ss.str();
+  std::replace(ret.begin(), ret.end(), '\t', ' ');
+  std::replace(ret.begin(), ret.end(), '\n', ' ');
+  return ret;
+}
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_USE_ONEDNN == 1
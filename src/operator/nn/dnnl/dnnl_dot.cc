@@ -45,7 +45,7 @@ DNNLDotFwd& DNNLDotFwd::GetCached(const DotParam& param,
                                   const std::vector<NDArray>& inputs,
                                   const std::vector<NDArray>& outputs,
                                   const bool isNumpy) {
-  using dot_fwd_map = std::unordered_map<DotSignature, DNNLDotFwd, OpHash>;
+  using dot_fwd_map = DNNLCache<DotSignature, DNNLDotFwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
   static thread_local dot_fwd_map fwds;
 #else
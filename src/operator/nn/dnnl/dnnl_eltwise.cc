@@ -37,9 +37,9 @@ DNNLEltwiseFwd& DNNLEltwiseFwd::GetCached(const NDArray& input,
                                           const NDArray& output,
                                           const dnnl::algorithm algorithm) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLEltwiseSignature, DNNLEltwiseFwd, OpHash> fwds;
+  static thread_local DNNLCache<DNNLEltwiseSignature, DNNLEltwiseFwd, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLEltwiseSignature, DNNLEltwiseFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLCache<DNNLEltwiseSignature, DNNLEltwiseFwd, OpHash> fwds;
 #endif
 
   DNNLEltwiseSignature key;
@@ -46,7 +46,9 @@ struct DNNLFCParam : public dmlc::Parameter<DNNLFCParam> {
   dmlc::optional<float> min_calib_range;  // min float value calculated from calibration dataset
   dmlc::optional<float> max_calib_range;  // max float value calculated from calibration dataset
   dmlc::optional<bool> channel_wise_quantize;
+  int weight_group_size;
   dmlc::optional<int> enabled_float_output;
+  bool dynamic_quantize;
 
   DMLC_DECLARE_PARAMETER(DNNLFCParam) {
     DMLC_DECLARE_FIELD(quantized).set_default(false).describe(
@@ -70,7 +72,19 @@ struct DNNLFCParam : public dmlc::Parameter<DNNLFCParam> {
     DMLC_DECLARE_FIELD(channel_wise_quantize)
         .set_default(dmlc::optional<bool>())
         .describe("Whether support channel-wise-quantize for weight.");
+    DMLC_DECLARE_FIELD(weight_group_size)
+        .set_default(0)
+        .describe(
+            "Number of consecutive input features of each output channel of the weight that "
+            "share a quantization scale, 0 for one scale per output channel. Requires "
+            "channel_wise_quantize.");
     DNNL_DECLARE_ENABLED_FLOAT_OUTPUT_PARAMETER();
+    DMLC_DECLARE_FIELD(dynamic_quantize)
+        .set_default(false)
+        .describe(
+            "Whether the range of the quantized data changes with every batch, computed at "
+            "runtime instead of calibrated. The primitive is then created once and the scales "
+            "are applied at runtime. Requires enabled_float_output.");
   }
 
   bool operator==(const DNNLFCParam& other) const {
@@ -79,7 +93,9 @@ struct DNNLFCParam : public dmlc::Parameter<DNNLFCParam> {
            this->with_eltwise == other.with_eltwise && this->with_sum == other.with_sum &&
            this->min_calib_range == other.min_calib_range &&
            this->max_calib_range == other.max_calib_range &&
-           this->channel_wise_quantize == other.channel_wise_quantize;
+           this->channel_wise_quantize == other.channel_wise_quantize &&
+           this->weight_group_size == other.weight_group_size &&
+           this->dynamic_quantize == other.dynamic_quantize;
   }
 };
 
@@ -255,11 +271,13 @@ struct hash<mxnet::op::DNNLFCParam> {
     ret = dmlc::HashCombine(ret, val.max_calib_range.has_value() ? val.max_calib_range.value() : 0);
     ret = dmlc::HashCombine(
         ret, val.channel_wise_quantize.has_value() ? val.channel_wise_quantize.value() : 0);
+    ret = dmlc::HashCombine(ret, val.weight_group_size);
     ret = dmlc::HashCombine(ret, val.quantized);
     ret = dmlc::HashCombine(
         ret, val.enabled_float_output.has_value() ? val.enabled_float_output.value() : -1);
     ret = dmlc::HashCombine(ret, val.with_eltwise);
     ret = dmlc::HashCombine(ret, val.with_sum);
+    ret = dmlc::HashCombine(ret, val.dynamic_quantize);
 
     return ret;
   }
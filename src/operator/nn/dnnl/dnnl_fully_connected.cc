@@ -129,14 +129,6 @@ DNNLFullyConnectedForward& GetFCFwd(const DNNLFCFullParam& param,
                                     const NDArray& weight,
                                     const NDArray* bias,
                                     const dnnl::memory::desc& out_md) {
-#if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLFullyconSignature, DNNLFullyConnectedForward, OpHash>
-      fcFwds;
-#else
-  static MX_THREAD_LOCAL
-      std::unordered_map<DNNLFullyconSignature, DNNLFullyConnectedForward, OpHash>
-          fcFwds;
-#endif
   DNNLFullyconSignature key(param);
   key.AddSign(is_train);
   key.AddSign(data);
@@ -144,12 +136,12 @@ DNNLFullyConnectedForward& GetFCFwd(const DNNLFCFullParam& param,
   if (bias)
     key.AddSign(*bias);
 
-  auto it = fcFwds.find(key);
-  if (it == fcFwds.end()) {
-    DNNLFullyConnectedForward fcFwd(param, is_train, data, weight, bias, out_md);
-    it = AddToCache(&fcFwds, key, fcFwd);
-  }
-  return it->second;
+  // the forward primitive is not modified once created, all the engine threads share it
+  return DNNLSharedCache<DNNLFullyconSignature, DNNLFullyConnectedForward, OpHash>::Get()
+      ->GetOrCreate(key, [&]() {
+        return std::make_shared<DNNLFullyConnectedForward>(
+            param, is_train, data, weight, bias, out_md);
+      });
 }
 
 void DNNLFCFlattenData(const FullyConnectedParam& param,
@@ -52,8 +52,7 @@ typedef ParamOpSign<MaskedSoftmaxParam> MaskedSoftmaxSignature;
 DNNLMaskedSoftmaxFwd& DNNLMaskedSoftmaxFwd::GetCached(
     const MaskedSoftmaxParam& param,
     const DNNLMaskedSoftmaxFwd::Tensors& tensors) {
-  using maskedsoftmax_fwd_map =
-      std::unordered_map<MaskedSoftmaxSignature, DNNLMaskedSoftmaxFwd, OpHash>;
+  using maskedsoftmax_fwd_map = DNNLCache<MaskedSoftmaxSignature, DNNLMaskedSoftmaxFwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
   static thread_local maskedsoftmax_fwd_map fwds;
 #else
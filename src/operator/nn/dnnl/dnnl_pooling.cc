@@ -276,10 +276,9 @@ DNNLPoolingFwd& GetPoolingFwd(const PoolingParam& param,
                               const NDArray& output,
                               const bool use_adaptive_pooling) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLPoolingSignature, DNNLPoolingFwd, OpHash> pooling_fwds;
+  static thread_local DNNLCache<DNNLPoolingSignature, DNNLPoolingFwd, OpHash> pooling_fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLPoolingSignature, DNNLPoolingFwd, OpHash>
-      pooling_fwds;
+  static MX_THREAD_LOCAL DNNLCache<DNNLPoolingSignature, DNNLPoolingFwd, OpHash> pooling_fwds;
 #endif
 
   const bool with_workspace = is_train && DNNLRequireWorkspace(param);
@@ -339,10 +338,9 @@ DNNLPoolingBwd& GetPoolingBwd(const PoolingParam& param,
                               const NDArray& out_grad,
                               const bool use_adaptive_pooling) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLPoolingSignature, DNNLPoolingBwd, OpHash> pooling_bwds;
+  static thread_local DNNLCache<DNNLPoolingSignature, DNNLPoolingBwd, OpHash> pooling_bwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLPoolingSignature, DNNLPoolingBwd, OpHash>
-      pooling_bwds;
+  static MX_THREAD_LOCAL DNNLCache<DNNLPoolingSignature, DNNLPoolingBwd, OpHash> pooling_bwds;
 #endif
 
   const bool with_workspace = DNNLRequireWorkspace(param);
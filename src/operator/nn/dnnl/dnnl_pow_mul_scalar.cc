@@ -34,11 +34,9 @@ DNNLPowMulScalarFwd& DNNLPowMulScalarFwd::GetCached(const DNNLPowMulScalarParam&
                                                     const NDArray& input,
                                                     const NDArray& output) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLPowMulScalarSignature, DNNLPowMulScalarFwd, OpHash>
-      fwds;
+  static thread_local DNNLCache<DNNLPowMulScalarSignature, DNNLPowMulScalarFwd, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLPowMulScalarSignature, DNNLPowMulScalarFwd, OpHash>
-      fwds;
+  static MX_THREAD_LOCAL DNNLCache<DNNLPowMulScalarSignature, DNNLPowMulScalarFwd, OpHash> fwds;
 #endif
   DNNLPowMulScalarSignature key(param);
   key.AddSign(input);
@@ -139,9 +139,9 @@ DNNLReduceFwd DNNLReduceFwd::GetCached(const NumpyReduceAxesParam& param,
                                        const bool is_train,
                                        const dnnl::algorithm reduction_alg) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLReduceSignature, DNNLReduceFwd, OpHash> fwds;
+  static thread_local DNNLCache<DNNLReduceSignature, DNNLReduceFwd, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLReduceSignature, DNNLReduceFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLCache<DNNLReduceSignature, DNNLReduceFwd, OpHash> fwds;
 #endif
 
   DNNLReduceSignature key(param);
@@ -101,9 +101,9 @@ DNNLReshapeFwd& GetReshapeForward(const OpReqType& req,
                                   const NDArray& input,
                                   const NDArray& output) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLReshapeSignature, DNNLReshapeFwd, OpHash> fwds;
+  static thread_local DNNLCache<DNNLReshapeSignature, DNNLReshapeFwd, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLReshapeSignature, DNNLReshapeFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLCache<DNNLReshapeSignature, DNNLReshapeFwd, OpHash> fwds;
 #endif
   DNNLReshapeSignature key;
   key.AddSign(req);
@@ -68,11 +68,9 @@ static DNNLSoftmaxOutputFwd& GetSoftmaxOutputForward(const SoftmaxOutputParam& p
                                                      const OpContext& ctx,
                                                      const NDArray& in_data) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLSoftmaxOuputSignature, DNNLSoftmaxOutputFwd, OpHash>
-      fwds;
+  static thread_local DNNLCache<DNNLSoftmaxOuputSignature, DNNLSoftmaxOutputFwd, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLSoftmaxOuputSignature, DNNLSoftmaxOutputFwd, OpHash>
-      fwds;
+  static MX_THREAD_LOCAL DNNLCache<DNNLSoftmaxOuputSignature, DNNLSoftmaxOutputFwd, OpHash> fwds;
 #endif
   DNNLSoftmaxOuputSignature key(param);
   key.AddSign(ctx.is_train);
@@ -57,9 +57,9 @@ DNNLSplitFwd& DNNLSplitFwd::GetCached(const SplitParam& param,
                                       const TShape& split_pts,
                                       const int split_axis) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLSplitSignature, DNNLSplitFwd, OpHash> fwds;
+  static thread_local DNNLCache<DNNLSplitSignature, DNNLSplitFwd, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLSplitSignature, DNNLSplitFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLCache<DNNLSplitSignature, DNNLSplitFwd, OpHash> fwds;
 #endif
 
   DNNLSplitSignature key(param);
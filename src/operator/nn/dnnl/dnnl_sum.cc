@@ -37,9 +37,9 @@ namespace op {
 DNNLSumFwd& DNNLSumFwd::GetCached(const std::vector<NDArray>& inputs,
                                   const std::vector<NDArray>& outputs) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLSumSignature, DNNLSumFwd, OpHash> fwds;
+  static thread_local DNNLCache<DNNLSumSignature, DNNLSumFwd, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLSumSignature, DNNLSumFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLCache<DNNLSumSignature, DNNLSumFwd, OpHash> fwds;
 #endif
   DNNLSumSignature key;
   key.AddSign(inputs);
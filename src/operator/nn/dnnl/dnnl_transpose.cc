@@ -96,9 +96,9 @@ void DNNLTransposeFwd::Execute() const {
 
 DNNLTransposeFwd& GetTransposeForward(const NumpyTransposeParam& param, const NDArray& data) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLTransposeSignature, DNNLTransposeFwd, OpHash> fwds;
+  static thread_local DNNLCache<DNNLTransposeSignature, DNNLTransposeFwd, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<DNNLTransposeSignature, DNNLTransposeFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLCache<DNNLTransposeSignature, DNNLTransposeFwd, OpHash> fwds;
 #endif
   DNNLTransposeSignature key(param);
   key.AddSign(data);
@@ -61,7 +61,7 @@ DNNLWhereFwd::Tensors::Tensors(const std::vector<NDArray>& inputs,
     : condition(inputs[0]), left(inputs[1]), right(inputs[2]), output(outputs[0]) {}
 
 DNNLWhereFwd DNNLWhereFwd::GetCached(const Tensors& tensors) {
-  using where_op_fwd_map = std::unordered_map<OpSignature, DNNLWhereFwd, OpHash>;
+  using where_op_fwd_map = DNNLCache<OpSignature, DNNLWhereFwd, OpHash>;
 #if DMLC_CXX11_THREAD_LOCAL
   static thread_local where_op_fwd_map fwds;
 #else
@@ -63,6 +63,14 @@ namespace op {
 
 const int MAX_DIM = 5;
 
+/*!
+ * \brief number of bytes of the mask of a dropout without axes, which keeps a bit per element,
+ *  padded to hold the reserve space of cuDNN
+ */
+inline index_t DropoutMaskBytes(index_t size) {
+  return ((size + 7) / 8 + 127) / 128 * 128;
+}
+
 struct DropoutParam : public dmlc::Parameter<DropoutParam> {
   float p;
   int mode;
@@ -137,11 +145,6 @@ class DropoutOp {
       }
     }
   }
-  static inline bool MKLAvailable() {
-    // BernoulliGenerate expects an array int, so for types smaller than int, the mask buffer
-    // will be too small, so we can;t use MKL in those cases
-    return sizeof(DType) >= sizeof(int);
-  }
 
   // MKL forward pass
   inline void MKLForward(const OpContext& ctx,
@@ -150,44 +153,22 @@ class DropoutOp {
     Stream<xpu>* s                  = ctx.get_stream<xpu>();
     RandGenerator<xpu, DType>* pgen = ctx.requested[0].get_parallel_random<xpu, DType>();
     CHECK_NOTNULL(pgen);
-    Tensor<xpu, 2, DType> mask = out_data[dropout::kMask].FlatTo2D<xpu, DType>(s);
-    Tensor<xpu, 2, DType> data = in_data[dropout::kData].FlatTo2D<xpu, DType>(s);
-    Tensor<xpu, 2, DType> out  = out_data[dropout::kOut].FlatTo2D<xpu, DType>(s);
-    DType* outptr              = out.dptr_;
-    DType* dataptr             = data.dptr_;
-    auto maskptr               = reinterpret_cast<int*>(mask.dptr_);
-    int count                  = mask.shape_[0] * mask.shape_[1];
-    if (sizeof(DType) > sizeof(int)) {
-      // allocating new buffer to avoiding memory overlapping between `mask.dptr_` and `maskptr`
-      Tensor<xpu, 1, int> temp = ctx.requested[1].get_space_typed<xpu, 1, int>(Shape1(count), s);
-      maskptr                  = temp.dptr_;
-    }
-    BernoulliGenerate(*pgen, count, this->pkeep_, maskptr);
+    DType* outptr            = out_data[dropout::kOut].dptr<DType>();
+    const DType* dataptr     = in_data[dropout::kData].dptr<DType>();
+    uint8_t* maskptr         = out_data[dropout::kMask].dptr<uint8_t>();
+    const int count          = in_data[dropout::kData].Size();
+    Tensor<xpu, 1, int> temp = ctx.requested[1].get_space_typed<xpu, 1, int>(Shape1(count), s);
+    BernoulliGenerate(*pgen, count, this->pkeep_, temp.dptr_);
     const float pk_1 = 1.0f / this->pkeep_;
+    // the bits of a byte of the mask are packed by the same thread
 #pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
-    for (int i = 0; i < count; ++i) {
-      const DType maskVal = static_cast<DType>(maskptr[i]) * pk_1;
-      outptr[i]           = dataptr[i] * maskVal;
-      mask.dptr_[i]       = maskVal;
-    }
-  }
-
-  // MKL backward pass
-  inline void MKLBackward(const OpContext& ctx,
-                          const std::vector<TBlob>& in_grad,
-                          const std::vector<TBlob>& out_data,
-                          const std::vector<TBlob>& out_grad) {
-    Stream<xpu>* s              = ctx.get_stream<xpu>();
-    Tensor<xpu, 2, DType> grad  = out_grad[dropout::kOut].FlatTo2D<xpu, DType>(s);
-    Tensor<xpu, 2, DType> mask  = out_data[dropout::kMask].FlatTo2D<xpu, DType>(s);
-    Tensor<xpu, 2, DType> gdata = in_grad[dropout::kData].FlatTo2D<xpu, DType>(s);
-    DType* ingradptr            = gdata.dptr_;
-    const DType* outgradptr     = grad.dptr_;
-    const DType* maskptr        = mask.dptr_;
-    const int count             = mask.shape_[0] * mask.shape_[1];
-#pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
-    for (int i = 0; i < count; ++i) {
-      ingradptr[i] = outgradptr[i] * maskptr[i];
+    for (int b = 0; b < (count + 7) / 8; ++b) {
+      uint8_t bits = 0;
+      for (int i = 8 * b; i < 8 * b + 8 && i < count; ++i) {
+        outptr[i] = dataptr[i] * static_cast<DType>(temp.dptr_[i] * pk_1);
+        bits      = bits | (temp.dptr_[i] << (i - 8 * b));
+      }
+      maskptr[b] = bits;
     }
   }
 
@@ -195,17 +176,18 @@ class DropoutOp {
 
  public:
   /*!
-   * \brief Dropout kernel, compute dropout tensor
+   * \brief Dropout kernel, compute dropout tensor and its mask of a bit per element
    */
   struct DropoutKernel {
     /*!
      * \brief Dropout kernel function
      * \param id Thread number (0-based representing count)
      * \param gen Random number generator
-     * \param N Total number of items in the output
-     * \param step Step between items, related to parallelism
+     * \param N Total number of bytes of the mask
+     * \param step Step between bytes, related to parallelism
+     * \param size Total number of items in the output
      * \param dropout_out Output dropout values
-     * \param mask_out  Output mask (is multiplied to create dropout output, may be 0)
+     * \param mask_out Output mask, bit j of byte i keeping item 8 * i + j
      * \param input_data Input data to perform the dropout on
      * \param pkeep Dropout rate (keep when the generated random number is less than this value)
      */
@@ -213,17 +195,37 @@ class DropoutOp {
                                     RandGenerator<xpu, DType> gen,
                                     const index_t N,
                                     const index_t step,
+                                    const index_t size,
                                     DType* dropout_out,
-                                    DType* mask_out,
+                                    uint8_t* mask_out,
                                     const DType* input_data,
                                     const real_t pkeep) {
       RNG_KERNEL_LOOP(xpu, DType, id, gen, N, step, {
-        const real_t rand_num = static_cast<real_t>(genImpl.uniform());
-        mask_out[i]    = mshadow_op::threshold_eq::Map<real_t>(rand_num, pkeep) * (1.0f / pkeep);
-        dropout_out[i] = input_data[i] * mask_out[i];
+        uint8_t bits = 0;
+        for (index_t j = 8 * i; j < 8 * i + 8 && j < size; ++j) {
+          const real_t rand_num = static_cast<real_t>(genImpl.uniform());
+          const real_t keep     = mshadow_op::threshold_eq::Map<real_t>(rand_num, pkeep);
+          dropout_out[j] = input_data[j] * DType(keep * (1.0f / pkeep));
+          bits           = bits | (static_cast<uint8_t>(keep) << (j - 8 * i));
+        }
+        mask_out[i] = bits;
       });
     }
   };
+  /*!
+   * \brief gradient of a dropout from its mask of a bit per element
+   */
+  template <int req>
+  struct DropoutGradKernel {
+    MSHADOW_XINLINE static void Map(index_t i,
+                                    DType* in_grad,
+                                    const DType* out_grad,
+                                    const uint8_t* mask,
+                                    const real_t pkeep) {
+      const real_t keep = (mask[i >> 3] >> (i & 7)) & 1;
+      KERNEL_ASSIGN(in_grad[i], req, out_grad[i] * DType(keep * (1.0f / pkeep)));
+    }
+  };
   struct BernoulliKernel {
     /*! \brief Bernoulli kernel for generating mask */
     MSHADOW_XINLINE static void Map(index_t id,
@@ -300,8 +302,8 @@ class DropoutOp {
     // perform dropout with cudnn
     CUDNN_CALL(cudnnDropoutGetReserveSpaceSize(x_desc_, &dropout_reserve_byte_));
     // cudnn uses bits to record the positions that are dropped, so reserve bytes is always
-    // 1/8 of input size.
-    CHECK_GE(mask.Size() * sizeof(DType), dropout_reserve_byte_)
+    // 1/8 of input size, as the mask bytes.
+    CHECK_GE(mask.Size(), dropout_reserve_byte_)
         << "The size of the mask space is smaller than the required cudnn reserved space.";
     CUDNN_CALL(cudnnDropoutForward(s->dnn_handle_,
                                    dropout_desc_,
@@ -309,7 +311,7 @@ class DropoutOp {
                                    in.dptr<DType>(),
                                    y_desc_,
                                    out.dptr<DType>(),
-                                   mask.dptr<DType>(),
+                                   mask.dptr_,
                                    dropout_reserve_byte_));
   }
 
@@ -339,7 +341,7 @@ class DropoutOp {
                                     out_grad.dptr<DType>(),
                                     dx_desc_,
                                     in_grad.dptr<DType>(),
-                                    mask.dptr<DType>(),
+                                    mask.dptr_,
                                     dropout_reserve_byte_));
   }
 #endif  // MXNET_USE_CUDNN_DROPOUT && defined(__CUDACC__)
@@ -362,10 +364,8 @@ class DropoutOp {
         this->dropout_passthrough_ = false;
         if (this->axes_.ndim() == 0) {
 #if MXNET_USE_MKL_DROPOUT
-          if (MKLAvailable()) {
-            MKLForward(ctx, in_data, out_data);
-            return;
-          }
+          MKLForward(ctx, in_data, out_data);
+          return;
 #endif  // MXNET_USE_MKL_DROPOUT
 #if MXNET_USE_CUDNN_DROPOUT && defined(__CUDACC__)
           if (CuDNNAvailable()) {
@@ -378,9 +378,10 @@ class DropoutOp {
           CHECK(req[dropout::kOut] != kAddTo);
           LaunchRNG<DropoutKernel, xpu>(s,
                                         pgen,
-                                        out.Size(),
+                                        (out.Size() + 7) / 8,
+                                        static_cast<index_t>(out.Size()),
                                         out.dptr<DType>(),
-                                        mask.dptr<DType>(),
+                                        mask.dptr<uint8_t>(),
                                         in.dptr<DType>(),
                                         this->pkeep_);
           return;
@@ -441,12 +442,6 @@ class DropoutOp {
       const TBlob& grad          = out_grad[dropout::kOut];
       const TBlob& mask          = out_data[dropout::kMask];
       if (this->axes_.ndim() == 0) {
-#if MXNET_USE_MKL_DROPOUT
-        if (MKLAvailable()) {
-          MKLBackward(ctx, in_grad, out_data, out_grad);
-          return;
-        }
-#endif  // MXNET_USE_MKL_DROPOUT
 #if MXNET_USE_CUDNN_DROPOUT && defined(__CUDACC__)
         if (CuDNNAvailable()) {
           CuDNNBackward(ctx, grad, mask, gdata);
@@ -454,10 +449,14 @@ class DropoutOp {
         }
 #endif  // MXNET_USE_CUDNN_DROPOUT && defined(__CUDACC__)
         // standard case for dropout
-        CHECK_EQ(grad.Size(), mask.Size());
+        CHECK_GE(mask.Size() * 8, grad.Size());
         MXNET_ASSIGN_REQ_SWITCH(req[dropout::kData], Req, {
-          mxnet_op::Kernel<mxnet_op::op_with_req<mshadow_op::mul, Req>, xpu>::Launch(
-              s, gdata.Size(), gdata.dptr<DType>(), grad.dptr<DType>(), mask.dptr<DType>());
+          mxnet_op::Kernel<DropoutGradKernel<Req>, xpu>::Launch(s,
+                                                                gdata.Size(),
+                                                                gdata.dptr<DType>(),
+                                                                grad.dptr<DType>(),
+                                                                mask.dptr<uint8_t>(),
+                                                                this->pkeep_);
         });
         return;
       } else {
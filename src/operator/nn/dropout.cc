@@ -25,6 +25,7 @@
 
 #include "./dropout-inl.h"
 #include "../operator_common.h"
+#include "../../common/alm.h"
 #include "mxnet/op_attr_types.h"
 
 namespace mxnet {
@@ -59,6 +60,28 @@ struct DropoutGrad {
   }
 };
 
+static bool DropoutChangeLayout(nnvm::NodeAttrs* attrs,
+                                mshadow::LayoutFlag target_layout,
+                                std::vector<alm::Transpose>* in_axes,
+                                std::vector<alm::Transpose>* out_axes) {
+  CHECK_EQ(target_layout, mshadow::kUNKNOWN);
+  auto t = alm::FactorCommonTranspose(in_axes);
+  out_axes->assign(2, t);
+  const auto& param = nnvm::get<DropoutParam>(attrs->parsed);
+  if (alm::IsIdentity(t) || param.axes.ndim() == 0)
+    return false;
+  // the axes of the shared mask follow the data
+  mxnet::TShape axes(param.axes);
+  for (int i = 0; i < axes.ndim(); ++i) {
+    CHECK_LT(axes[i], t.size());
+    axes[i] = t[axes[i]];
+  }
+  std::ostringstream axes_s;
+  axes_s << axes;
+  attrs->dict["axes"] = axes_s.str();
+  return true;
+}
+
 DMLC_REGISTER_PARAMETER(DropoutParam);
 
 NNVM_REGISTER_OP(Dropout)
@@ -119,6 +142,14 @@ Example::
                                       return false;
                                     out_shape->clear();
                                     out_shape->push_back(dshape);
+                                    if (param.axes.ndim() == 0) {
+                                      // the mask keeps a bit per element
+                                      out_shape->push_back(
+                                          mxnet::shape_is_known(dshape) ?
+                                              mxnet::TShape(1, DropoutMaskBytes(dshape.Size())) :
+                                              mxnet::TShape(1, -1));
+                                      return true;
+                                    }
                                     for (int i = 0; i < param.axes.ndim(); ++i) {
                                       dshape[param.axes[i]] = 1;
                                     }
@@ -137,12 +168,15 @@ Example::
                                     return false;
                                   }
 
-                                  size_t nout = 2;
+                                  const DropoutParam& param =
+                                      nnvm::get<DropoutParam>(attrs.parsed);
                                   out_type->clear();
-                                  for (size_t i = 0; i < nout; ++i)
-                                    out_type->push_back(dtype);
+                                  out_type->push_back(dtype);
+                                  out_type->push_back(param.axes.ndim() == 0 ? mshadow::kUint8 :
+                                                                               dtype);
                                   return true;
                                 })
+    .set_attr<mxnet::alm::FChangeLayout>("FChangeLayout", DropoutChangeLayout)
     .set_attr<FCreateOpState>("FCreateOpState", CreateDropoutState)
     .set_attr<FStatefulCompute>("FStatefulCompute<cpu>", DropoutCompute<cpu>)
     .set_attr<nnvm::FGradient>("FGradient", DropoutGrad{"_backward_Dropout"})
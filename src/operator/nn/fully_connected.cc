@@ -25,6 +25,7 @@
 #include "./fully_connected-inl.h"
 #if MXNET_USE_ONEDNN == 1
 #include "operator/nn/dnnl/dnnl_base-inl.h"
+#include "operator/nn/dnnl/dnnl_dispatch_tuner-inl.h"
 #include "operator/nn/dnnl/dnnl_fully_connected-inl.h"
 #endif  // MXNET_USE_ONEDNN == 1
 
@@ -102,9 +103,18 @@ void FullyConnectedComputeExCPU(const nnvm::NodeAttrs& attrs,
   if (common::ContainsOnlyStorage(inputs, kDefaultStorage) &&
       common::ContainsOnlyStorage(outputs, kDefaultStorage)) {
     if (SupportDNNLFC(inputs[0])) {
-      DNNL_OPCHECK_INIT(false, outputs.size(), inputs, outputs);
-      DNNLRun(DNNLFCForward, attrs, ctx, inputs, req, outputs);
-      DNNL_OPCHECK_RUN(FullyConnectedCompute<cpu>, attrs, ctx, inputs, req, outputs);
+      DNNLDispatch(
+          attrs,
+          inputs,
+          req,
+          [&]() {
+            DNNL_OPCHECK_INIT(false, outputs.size(), inputs, outputs);
+            DNNLRun(DNNLFCForward, attrs, ctx, inputs, req, outputs);
+            DNNL_OPCHECK_RUN(FullyConnectedCompute<cpu>, attrs, ctx, inputs, req, outputs);
+          },
+          [&]() {
+            FallBackCompute(FullyConnectedCompute<cpu>, attrs, ctx, inputs, req, outputs);
+          });
     } else {
       FallBackCompute(FullyConnectedCompute<cpu>, attrs, ctx, inputs, req, outputs);
     }
@@ -250,6 +260,23 @@ static bool BackwardFCStorageType(const nnvm::NodeAttrs& attrs,
   return dispatched;
 }
 
+static OpCost FullyConnectedCost(const nnvm::NodeAttrs& attrs,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<TBlob>& outputs) {
+  const double macs = static_cast<double>(outputs[fullc::kOut].Size()) *
+                      inputs[fullc::kWeight].shape_[1];
+  return MatMulCost(macs, inputs, outputs);
+}
+
+static OpCost BackwardFullyConnectedCost(const nnvm::NodeAttrs& attrs,
+                                         const std::vector<TBlob>& inputs,
+                                         const std::vector<TBlob>& outputs) {
+  // inputs are the output gradient, data and weight, both data and weight gradients are
+  // products as large as the forward one
+  const double macs = 2.0 * inputs[0].Size() * inputs[2].shape_[1];
+  return MatMulCost(macs, inputs, outputs);
+}
+
 DMLC_REGISTER_PARAMETER(FullyConnectedParam);
 
 NNVM_REGISTER_OP(FullyConnected)
@@ -319,6 +346,7 @@ If ``no_bias`` is set to be true, then the ``bias`` term is ignored.
     .set_attr<nnvm::FInferType>("FInferType", FullyConnectedType)
     .set_attr<FCompute>("FCompute<cpu>", FullyConnectedCompute<cpu>)
     .set_attr<FComputeEx>("FComputeEx<cpu>", FullyConnectedComputeExCPU)
+    .set_attr<FOpCost>("FOpCost", FullyConnectedCost)
     .set_attr<nnvm::FGradient>("FGradient", FullyConnectedGrad{"_backward_FullyConnected"})
     .add_argument("data", "NDArray-or-Symbol", "Input data.")
     .add_argument("weight", "NDArray-or-Symbol", "Weight matrix.")
@@ -343,6 +371,7 @@ NNVM_REGISTER_OP(_backward_FullyConnected)
     .set_attr<nnvm::FGradient>("FGradient",
                                FullyConnectedGradGrad{"_backward_backward_FullyConnected"})
     .set_attr<FInferStorageType>("FInferStorageType", BackwardFCStorageType)
+    .set_attr<FOpCost>("FOpCost", BackwardFullyConnectedCost)
     .set_attr_parser(ParamParser<FullyConnectedParam>)
 #if MXNET_USE_ONEDNN == 1
     .set_attr<bool>("TIsDNNL", true)
@@ -25,6 +25,7 @@
 #include "group_norm-inl.h"
 #include <nnvm/op_attr_types.h>
 #include "../elemwise_op_common.h"
+#include "./group_norm_cpu.h"
 
 namespace mxnet {
 namespace op {
@@ -60,6 +61,90 @@ static bool GroupNormShape(const nnvm::NodeAttrs& attrs,
   return true;
 }
 
+/* Run the fused GroupNormCPUKernel, falling back to the generic implementation
+ * for empty inputs.
+ */
+static void GroupNormComputeCPU(const nnvm::NodeAttrs& attrs,
+                                const OpContext& ctx,
+                                const std::vector<TBlob>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<TBlob>& outputs) {
+  const GroupNormParam& param = nnvm::get<GroupNormParam>(attrs.parsed);
+  if (req[groupnorm::kOut] == kNullOp)
+    return;
+  CHECK_NE(req[groupnorm::kOut], kAddTo);
+  const TBlob& data = inputs[groupnorm::kData];
+  if (data.Size() == 0) {
+    GroupNormCompute<cpu>(attrs, ctx, inputs, req, outputs);
+    return;
+  }
+  CHECK_GE(data.ndim(), 3U) << "input should have at least 3 dims and "
+                            << "the first 2 dims should be batch and channel respectively";
+  CHECK_EQ(data.shape_[1] % param.num_groups, 0)
+      << "number of channel should be divisible by num_groups.";
+  const size_t batch    = data.shape_[0];
+  const size_t channels = data.shape_[1];
+  MSHADOW_REAL_TYPE_SWITCH(data.type_flag_, DType, {
+    using AType = NormCPUAccum<DType>;
+    GroupNormCPUKernel<DType, AType>(batch,
+                                     param.num_groups,
+                                     channels / param.num_groups,
+                                     data.Size() / batch / channels,
+                                     param.eps,
+                                     data.dptr<DType>(),
+                                     inputs[groupnorm::kGamma].dptr<DType>(),
+                                     inputs[groupnorm::kBeta].dptr<DType>(),
+                                     outputs[groupnorm::kOut].dptr<DType>(),
+                                     outputs[groupnorm::kMean].dptr<DType>(),
+                                     outputs[groupnorm::kStd].dptr<DType>());
+  });
+}
+
+/* Run the fused GroupNormGradCPUKernel, falling back to the generic implementation
+ * for empty inputs.
+ */
+static void GroupNormGradComputeCPU(const nnvm::NodeAttrs& attrs,
+                                    const OpContext& ctx,
+                                    const std::vector<TBlob>& inputs,
+                                    const std::vector<OpReqType>& req,
+                                    const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  CHECK_EQ(inputs.size(), 5U);
+  CHECK_EQ(outputs.size(), 3U);
+  const GroupNormParam& param = nnvm::get<GroupNormParam>(attrs.parsed);
+  const TBlob& data           = inputs[1];
+  if (data.Size() == 0) {
+    GroupNormGradCompute<cpu>(attrs, ctx, inputs, req, outputs);
+    return;
+  }
+  const size_t batch    = data.shape_[0];
+  const size_t channels = data.shape_[1];
+  Stream<cpu>* s        = ctx.get_stream<cpu>();
+  MSHADOW_REAL_TYPE_SWITCH(data.type_flag_, DType, {
+    using AType = NormCPUAccum<DType>;
+    Tensor<cpu, 1, AType> workspace = ctx.requested[0].get_space_typed<cpu, 1, AType>(
+        Shape1(GroupNormGradCPUWorkspaceSize(batch, channels)), s);
+    GroupNormGradCPUKernel<DType, AType>(batch,
+                                         param.num_groups,
+                                         channels / param.num_groups,
+                                         data.Size() / batch / channels,
+                                         inputs[0].dptr<DType>(),
+                                         data.dptr<DType>(),
+                                         inputs[2].dptr<DType>(),
+                                         inputs[3].dptr<DType>(),
+                                         inputs[4].dptr<DType>(),
+                                         false,
+                                         param.eps,
+                                         outputs[0].dptr<DType>(),
+                                         outputs[1].dptr<DType>(),
+                                         outputs[2].dptr<DType>(),
+                                         req[0],
+                                         req[1],
+                                         req[2],
+                                         workspace.dptr_);
+  });
+}
+
 NNVM_REGISTER_OP(GroupNorm)
     .add_alias("_npx_group_norm")
     .describe(R"code(Group normalization.
@@ -94,7 +179,7 @@ Both ``gamma`` and ``beta`` are learnable parameters.
                                         })
     .set_attr<mxnet::FInferShape>("FInferShape", GroupNormShape)
     .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<3, 3>)
-    .set_attr<FCompute>("FCompute<cpu>", GroupNormCompute<cpu>)
+    .set_attr<FCompute>("FCompute<cpu>", GroupNormComputeCPU)
     .set_attr<nnvm::FGradient>("FGradient",
                                [](const nnvm::ObjectPtr& n,
                                   const std::vector<nnvm::NodeEntry>& ograds) {
@@ -126,7 +211,7 @@ NNVM_REGISTER_OP(_backward_GroupNorm)
     .set_num_outputs(3)
     .set_attr<nnvm::TIsBackward>("TIsBackward", true)
     .set_attr_parser(ParamParser<GroupNormParam>)
-    .set_attr<FCompute>("FCompute<cpu>", GroupNormGradCompute<cpu>)
+    .set_attr<FCompute>("FCompute<cpu>", GroupNormGradComputeCPU)
     .set_attr<FResourceRequest>("FResourceRequest", [](const NodeAttrs& n) {
       return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
     });
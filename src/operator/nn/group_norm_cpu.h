@@ -0,0 +1,203 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file group_norm_cpu.h
+ * \brief Fused single-pass CPU kernels for GroupNorm and InstanceNorm.
+ */
+#ifndef MXNET_OPERATOR_NN_GROUP_NORM_CPU_H_
+#define MXNET_OPERATOR_NN_GROUP_NORM_CPU_H_
+
+#include <algorithm>
+#include <cmath>
+#include "./layer_norm_cpu.h"
+
+namespace mxnet {
+namespace op {
+
+/* CPU optimized forward kernel for GroupNorm.
+ *
+ * data is batch x (groups * group_channels) x spatial and every
+ * group_channels x spatial block is one contiguous normalization problem.
+ * gamma and beta are per channel.  mean and std are batch x groups; when
+ * output_var is set the biased variance is written instead of std, which is
+ * what InstanceNorm (groups = channels, group_channels = 1) exposes.
+ * out can be same as data.
+ */
+template <typename Data, typename Accum = NormCPUAccum<Data>>
+void GroupNormCPUKernel(size_t batch,
+                        size_t groups,
+                        size_t group_channels,
+                        size_t spatial,
+                        Accum eps,
+                        const Data* data,
+                        const Data* gamma,
+                        const Data* beta,
+                        Data* out,
+                        Data* mean,
+                        Data* std,
+                        bool output_var = false) {
+  const size_t width                 = group_channels * spatial;
+  const mshadow::index_t signed_rows = static_cast<mshadow::index_t>(batch * groups);
+#pragma omp parallel for
+  for (nnvm::dim_t r = 0; r < signed_rows; ++r) {
+    const Data* from = data + r * width;
+    Data* to         = out + r * width;
+    Accum mean_value, var;
+    WelfordRowMoments(from, width, &mean_value, &var);
+    const Accum inv_sigma = Accum(1) / std::sqrt(var + eps);
+    mean[r]               = static_cast<Data>(mean_value);
+    std[r]                = static_cast<Data>(output_var ? var : std::sqrt(var + eps));
+    const size_t channel0 = (r % groups) * group_channels;
+    for (size_t c = 0; c < group_channels; ++c) {
+      // Fold the normalization and the affine transform into one multiply-add.
+      const Accum scale = static_cast<Accum>(gamma[channel0 + c]) * inv_sigma;
+      const Accum shift = static_cast<Accum>(beta[channel0 + c]) - mean_value * scale;
+      const Data* x     = from + c * spatial;
+      Data* y           = to + c * spatial;
+#pragma omp simd
+      for (size_t i = 0; i < spatial; ++i) {
+        y[i] = static_cast<Data>(static_cast<Accum>(x[i]) * scale + shift);
+      }
+    }
+  }
+}
+
+/* Number of Accum values GroupNormGradCPUKernel needs as workspace. */
+inline size_t GroupNormGradCPUWorkspaceSize(size_t batch, size_t channels) {
+  return 2 * batch * channels;
+}
+
+/* CPU optimized backward kernel for GroupNorm, see GroupNormGradCompute for the
+ * formulas.  Each group is read once to gather sum(ograd) and sum(ograd * xhat)
+ * for each of its channels, which give both the row sums needed by grad_data and
+ * the batch x channels partials of grad_beta and grad_gamma, and once more to
+ * write grad_data.  The partials are reduced over the batch afterwards.  When
+ * std_is_var is set std holds the biased variance (InstanceNorm) and eps is
+ * added before taking the square root.  grad_data may be the same buffer as
+ * ograd.
+ */
+template <typename Data, typename Accum = NormCPUAccum<Data>>
+void GroupNormGradCPUKernel(size_t batch,
+                            size_t groups,
+                            size_t group_channels,
+                            size_t spatial,
+                            const Data* ograd,
+                            const Data* data,
+                            const Data* gamma,
+                            const Data* mean,
+                            const Data* std,
+                            bool std_is_var,
+                            Accum eps,
+                            Data* grad_data,
+                            Data* grad_gamma,
+                            Data* grad_beta,
+                            const OpReqType req_data,
+                            const OpReqType req_gamma,
+                            const OpReqType req_beta,
+                            Accum* workspace) {
+  const size_t width                 = group_channels * spatial;
+  const size_t channels              = groups * group_channels;
+  const Accum inv_width              = Accum(1) / static_cast<Accum>(width);
+  Accum* part_gamma                  = workspace;
+  Accum* part_beta                   = workspace + batch * channels;
+  const mshadow::index_t signed_rows = static_cast<mshadow::index_t>(batch * groups);
+#pragma omp parallel for
+  for (nnvm::dim_t r = 0; r < signed_rows; ++r) {
+    const Accum m         = static_cast<Accum>(mean[r]);
+    const Accum sigma     = std_is_var ? std::sqrt(static_cast<Accum>(std[r]) + eps) :
+                                         static_cast<Accum>(std[r]);
+    const Accum inv_std   = Accum(1) / sigma;
+    const size_t channel0 = (r % groups) * group_channels;
+    // Row r of the batch x groups moments covers channels [channel0, channel0 + group_channels)
+    // of sample r / groups, so its offset into the batch x channels partials is r * group_channels.
+    Accum* row_gamma = part_gamma + r * group_channels;
+    Accum* row_beta  = part_beta + r * group_channels;
+    Accum sum_g = 0, sum_gx = 0;
+    for (size_t c = 0; c < group_channels; ++c) {
+      const Data* dy = ograd + r * width + c * spatial;
+      const Data* x  = data + r * width + c * spatial;
+      Accum sum_dy = 0, sum_dyx = 0;
+#pragma omp simd reduction(+ : sum_dy, sum_dyx)
+      for (size_t i = 0; i < spatial; ++i) {
+        const Accum d = static_cast<Accum>(dy[i]);
+        sum_dy += d;
+        sum_dyx += d * (static_cast<Accum>(x[i]) - m);
+      }
+      sum_dyx *= inv_std;
+      row_gamma[c] = sum_dyx;
+      row_beta[c]  = sum_dy;
+      sum_g += static_cast<Accum>(gamma[channel0 + c]) * sum_dy;
+      sum_gx += static_cast<Accum>(gamma[channel0 + c]) * sum_dyx;
+    }
+    if (req_data == kNullOp)
+      continue;
+    const Accum mean_g  = sum_g * inv_width;
+    const Accum mean_gx = sum_gx * inv_width;
+    for (size_t c = 0; c < group_channels; ++c) {
+      const Data* dy     = ograd + r * width + c * spatial;
+      const Data* x      = data + r * width + c * spatial;
+      Data* dx           = grad_data + r * width + c * spatial;
+      const Accum gscale = static_cast<Accum>(gamma[channel0 + c]) * inv_std;
+      // grad_data = (ograd * gamma - mean_g - xhat * mean_gx) / std
+      const Accum xscale = -mean_gx * inv_std * inv_std;
+      const Accum bias   = -mean_g * inv_std;
+      if (req_data == kAddTo) {
+#pragma omp simd
+        for (size_t i = 0; i < spatial; ++i) {
+          dx[i] = static_cast<Data>(static_cast<Accum>(dx[i]) +
+                                    static_cast<Accum>(dy[i]) * gscale +
+                                    (static_cast<Accum>(x[i]) - m) * xscale + bias);
+        }
+      } else {
+#pragma omp simd
+        for (size_t i = 0; i < spatial; ++i) {
+          dx[i] = static_cast<Data>(static_cast<Accum>(dy[i]) * gscale +
+                                    (static_cast<Accum>(x[i]) - m) * xscale + bias);
+        }
+      }
+    }
+  }
+  if (req_gamma == kNullOp && req_beta == kNullOp)
+    return;
+  const mshadow::index_t signed_channels = static_cast<mshadow::index_t>(channels);
+#pragma omp parallel for
+  for (nnvm::dim_t ch = 0; ch < signed_channels; ++ch) {
+    Accum sum_gamma = 0, sum_beta = 0;
+    for (size_t n = 0; n < batch; ++n) {
+      sum_gamma += part_gamma[n * channels + ch];
+      sum_beta += part_beta[n * channels + ch];
+    }
+    if (req_gamma == kAddTo) {
+      grad_gamma[ch] = static_cast<Data>(static_cast<Accum>(grad_gamma[ch]) + sum_gamma);
+    } else if (req_gamma != kNullOp) {
+      grad_gamma[ch] = static_cast<Data>(sum_gamma);
+    }
+    if (req_beta == kAddTo) {
+      grad_beta[ch] = static_cast<Data>(static_cast<Accum>(grad_beta[ch]) + sum_beta);
+    } else if (req_beta != kNullOp) {
+      grad_beta[ch] = static_cast<Data>(sum_beta);
+    }
+  }
+}
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_NN_GROUP_NORM_CPU_H_
@@ -307,12 +307,59 @@ void LayerNormGradComputeGeneralImpl<cpu>(const nnvm::NodeAttrs& attrs,
   }
 }
 
+/* Wrap the above LayerNormGradCPUKernel in MXNet's API.  Returns true if it
+ * is able to run.
+ */
+bool LayerNormGradCPU(const nnvm::NodeAttrs& attrs,
+                      const OpContext& ctx,
+                      const std::vector<TBlob>& inputs,
+                      const std::vector<OpReqType>& req,
+                      const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  const LayerNormParam& param = nnvm::get<LayerNormParam>(attrs.parsed);
+  CHECK_EQ(outputs.size(), 3U);
+  const TBlob& ograd = inputs[0];
+  const TBlob& data  = inputs[1];
+  // Axis must be the last one.
+  int axis = GetRealAxis(param.axis, data.ndim());
+  if (axis != data.ndim() - 1 || data.Size() == 0) {
+    return false;
+  }
+  const size_t width     = data.shape_[axis];
+  const size_t instances = data.Size() / width;
+  const int nthreads     = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  Stream<cpu>* s         = ctx.get_stream<cpu>();
+  MSHADOW_REAL_TYPE_SWITCH(data.type_flag_, DType, {
+    using AType = NormCPUAccum<DType>;
+    Tensor<cpu, 1, AType> workspace = ctx.requested[0].get_space_typed<cpu, 1, AType>(
+        Shape1(LayerNormGradCPUWorkspaceSize(width, instances, nthreads)), s);
+    LayerNormGradCPUKernel<DType>(width,
+                                  instances,
+                                  ograd.dptr<DType>(),
+                                  data.dptr<DType>(),
+                                  inputs[2].dptr<DType>(),
+                                  inputs[3].dptr<DType>(),
+                                  inputs[4].dptr<DType>(),
+                                  outputs[0].dptr<DType>(),
+                                  outputs[1].dptr<DType>(),
+                                  outputs[2].dptr<DType>(),
+                                  req[0],
+                                  req[1],
+                                  req[2],
+                                  workspace.dptr_,
+                                  nthreads);
+  });
+  return true;
+}
+
 template <>
 void LayerNormGradCompute<cpu>(const nnvm::NodeAttrs& attrs,
                                const OpContext& ctx,
                                const std::vector<TBlob>& inputs,
                                const std::vector<OpReqType>& req,
                                const std::vector<TBlob>& outputs) {
+  if (LayerNormGradCPU(attrs, ctx, inputs, req, outputs))
+    return;
   return LayerNormGradComputeGeneral<cpu>(attrs, ctx, inputs, req, outputs);
 }
 
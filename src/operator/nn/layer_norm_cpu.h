@@ -32,9 +32,78 @@
 #ifndef MXNET_OPERATOR_NN_LAYER_NORM_CPU_H_
 #define MXNET_OPERATOR_NN_LAYER_NORM_CPU_H_
 
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
 namespace mxnet {
 namespace op {
 
+/* By default accumulate in float32 for float16 and bfloat16.  Otherwise use same type. */
+template <typename Data>
+using NormCPUAccum =
+    typename std::conditional<std::is_same<mshadow::half::half_t, Data>::value ||
+                                  std::is_same<mshadow::bfloat::bf16_t, Data>::value,
+                              float,
+                              Data>::type;
+
+/* Number of independent Welford accumulators kept per row.  Every lane sees the
+ * same number of elements, so the update loop below vectorizes with a scalar 1/n.
+ */
+constexpr int kWelfordLanes = 16;
+
+/* Merge the Welford state (count_b, mean_b, m2_b) into (count_a, mean_a, m2_a). */
+template <typename Accum>
+inline void WelfordMerge(Accum* count_a,
+                         Accum* mean_a,
+                         Accum* m2_a,
+                         Accum count_b,
+                         Accum mean_b,
+                         Accum m2_b) {
+  const Accum count = *count_a + count_b;
+  if (count_b == 0)
+    return;
+  const Accum delta = mean_b - *mean_a;
+  *mean_a += delta * count_b / count;
+  *m2_a += m2_b + delta * delta * *count_a * count_b / count;
+  *count_a = count;
+}
+
+/* Mean and biased variance of width contiguous values, computed in a single pass
+ * with Welford's update so that rows with a large mean do not lose precision the
+ * way the E[x^2] - E[x]^2 formulation does.
+ */
+template <typename Data, typename Accum>
+inline void WelfordRowMoments(const Data* row, size_t width, Accum* mean, Accum* var) {
+  Accum lane_mean[kWelfordLanes] = {0};
+  Accum lane_m2[kWelfordLanes]   = {0};
+  const size_t blocks            = width / kWelfordLanes;
+  for (size_t b = 0; b < blocks; ++b) {
+    const Data* from = row + b * kWelfordLanes;
+    const Accum inv  = Accum(1) / static_cast<Accum>(b + 1);
+#pragma omp simd
+    for (int l = 0; l < kWelfordLanes; ++l) {
+      const Accum x     = static_cast<Accum>(from[l]);
+      const Accum delta = x - lane_mean[l];
+      lane_mean[l] += delta * inv;
+      lane_m2[l] += delta * (x - lane_mean[l]);
+    }
+  }
+  Accum count = 0, m = 0, m2 = 0;
+  for (int l = 0; l < kWelfordLanes; ++l) {
+    WelfordMerge(&count, &m, &m2, static_cast<Accum>(blocks), lane_mean[l], lane_m2[l]);
+  }
+  for (size_t i = blocks * kWelfordLanes; i < width; ++i) {
+    const Accum x     = static_cast<Accum>(row[i]);
+    const Accum delta = x - m;
+    count += 1;
+    m += delta / count;
+    m2 += delta * (x - m);
+  }
+  *mean = m;
+  *var  = count > 0 ? m2 / count : Accum(0);
+}
+
 /* CPU optimized kernel for LayerNorm assuming axis = -1.
  * Data is the underlying storage data type.
  * Accum is the type to use for accumulation.
@@ -54,11 +123,9 @@ namespace op {
  * mean is instances: means of each problem
  * std is instances: standard deviation of each problem
  *
+ * Each row is read twice: once for the Welford moments and once to normalize.
  */
-template <typename Data,
-          typename Accum = typename
-          /* By default accumulate in float32 for float16.  Otherwise use same type. */
-          std::conditional<std::is_same<mshadow::half::half_t, Data>::value, float, Data>::type>
+template <typename Data, typename Accum = NormCPUAccum<Data>>
 void LayerNormCPUKernel(size_t width,
                         size_t instances,
                         Data eps,
@@ -75,30 +142,129 @@ void LayerNormCPUKernel(size_t width,
   for (nnvm::dim_t j = 0; j < signed_instances; ++j) {
     const Data* from = data + j * width;
 
-    // Sum the values to compute mean.
-    Accum sum = 0.f;
-#pragma omp simd reduction(+ : sum)
-    for (size_t i = 0; i < width; ++i) {
-      sum += from[i];
-    }
-    Accum mean_value = sum / width;
-    mean[j]          = static_cast<Data>(mean_value);
-
-    // Sum squares from mean to compute stddev.
-    Accum squares = 0.f;
-#pragma omp simd reduction(+ : squares)
-    for (size_t i = 0; i < width; ++i) {
-      Accum off = from[i] - mean_value;
-      squares += off * off;
-    }
-    Accum sigma = std::sqrt(squares / width + eps);
+    Accum mean_value, var;
+    WelfordRowMoments(from, width, &mean_value, &var);
+    Accum sigma = std::sqrt(var + static_cast<Accum>(eps));
+    mean[j]     = static_cast<Data>(mean_value);
     std[j]      = static_cast<Data>(sigma);
 
     // Write normalized values.
-    Data* to = out + j * width;
+    const Accum inv_sigma = Accum(1) / sigma;
+    Data* to              = out + j * width;
 #pragma omp simd
     for (size_t i = 0; i < width; ++i) {
-      to[i] = (from[i] - mean_value) * gamma[i] / sigma + beta[i];
+      to[i] = static_cast<Data>((static_cast<Accum>(from[i]) - mean_value) *
+                                    static_cast<Accum>(gamma[i]) * inv_sigma +
+                                static_cast<Accum>(beta[i]));
+    }
+  }
+}
+
+/* Number of row chunks LayerNormGradCPUKernel splits the instances into. */
+inline int LayerNormGradCPUChunks(size_t instances, int nthreads) {
+  return static_cast<int>(std::max<size_t>(1, std::min<size_t>(nthreads, instances)));
+}
+
+/* Number of Accum values LayerNormGradCPUKernel needs as workspace. */
+inline size_t LayerNormGradCPUWorkspaceSize(size_t width, size_t instances, int nthreads) {
+  return 2 * width * LayerNormGradCPUChunks(instances, nthreads);
+}
+
+/* CPU optimized backward kernel for LayerNorm assuming axis = -1.
+ *
+ * With xhat = (data - mean) / std and g = ograd * gamma,
+ *   grad_data  = (g - mean(g) - xhat * mean(g * xhat)) / std
+ *   grad_gamma = sum(ograd * xhat, instances)
+ *   grad_beta  = sum(ograd, instances)
+ *
+ * The row sums and the per-thread partial grad_gamma / grad_beta are gathered in
+ * one pass over ograd and data, and grad_data is written in a second pass over
+ * the same (cache resident) row.  The partials are then reduced over threads.
+ * grad_data may be the same buffer as ograd.
+ */
+template <typename Data, typename Accum = NormCPUAccum<Data>>
+void LayerNormGradCPUKernel(size_t width,
+                            size_t instances,
+                            const Data* ograd,
+                            const Data* data,
+                            const Data* gamma,
+                            const Data* mean,
+                            const Data* std,
+                            Data* grad_data,
+                            Data* grad_gamma,
+                            Data* grad_beta,
+                            const OpReqType req_data,
+                            const OpReqType req_gamma,
+                            const OpReqType req_beta,
+                            Accum* workspace,
+                            int nthreads) {
+  const int chunks         = LayerNormGradCPUChunks(instances, nthreads);
+  const size_t chunk_size = (instances + chunks - 1) / chunks;
+  const Accum inv_width   = Accum(1) / static_cast<Accum>(width);
+#pragma omp parallel for num_threads(nthreads)
+  for (int t = 0; t < chunks; ++t) {
+    Accum* part_gamma = workspace + 2 * width * t;
+    Accum* part_beta  = part_gamma + width;
+    std::fill(part_gamma, part_gamma + 2 * width, Accum(0));
+    const size_t end = std::min(instances, (t + 1) * chunk_size);
+    for (size_t j = t * chunk_size; j < end; ++j) {
+      const Data* dy      = ograd + j * width;
+      const Data* x       = data + j * width;
+      const Accum m       = static_cast<Accum>(mean[j]);
+      const Accum inv_std = Accum(1) / static_cast<Accum>(std[j]);
+      Accum sum_g = 0, sum_gx = 0;
+#pragma omp simd reduction(+ : sum_g, sum_gx)
+      for (size_t i = 0; i < width; ++i) {
+        const Accum d    = static_cast<Accum>(dy[i]);
+        const Accum xhat = (static_cast<Accum>(x[i]) - m) * inv_std;
+        const Accum g    = d * static_cast<Accum>(gamma[i]);
+        sum_g += g;
+        sum_gx += g * xhat;
+        part_gamma[i] += d * xhat;
+        part_beta[i] += d;
+      }
+      if (req_data == kNullOp)
+        continue;
+      const Accum mean_g  = sum_g * inv_width;
+      const Accum mean_gx = sum_gx * inv_width;
+      Data* dx            = grad_data + j * width;
+      if (req_data == kAddTo) {
+#pragma omp simd
+        for (size_t i = 0; i < width; ++i) {
+          const Accum xhat = (static_cast<Accum>(x[i]) - m) * inv_std;
+          const Accum g    = static_cast<Accum>(dy[i]) * static_cast<Accum>(gamma[i]);
+          dx[i]            = static_cast<Data>(static_cast<Accum>(dx[i]) +
+                                    (g - mean_g - xhat * mean_gx) * inv_std);
+        }
+      } else {
+#pragma omp simd
+        for (size_t i = 0; i < width; ++i) {
+          const Accum xhat = (static_cast<Accum>(x[i]) - m) * inv_std;
+          const Accum g    = static_cast<Accum>(dy[i]) * static_cast<Accum>(gamma[i]);
+          dx[i]            = static_cast<Data>((g - mean_g - xhat * mean_gx) * inv_std);
+        }
+      }
+    }
+  }
+  if (req_gamma == kNullOp && req_beta == kNullOp)
+    return;
+  const mshadow::index_t signed_width = static_cast<mshadow::index_t>(width);
+#pragma omp parallel for num_threads(nthreads)
+  for (nnvm::dim_t i = 0; i < signed_width; ++i) {
+    Accum sum_gamma = 0, sum_beta = 0;
+    for (int t = 0; t < chunks; ++t) {
+      sum_gamma += workspace[2 * width * t + i];
+      sum_beta += workspace[2 * width * t + width + i];
+    }
+    if (req_gamma == kAddTo) {
+      grad_gamma[i] = static_cast<Data>(static_cast<Accum>(grad_gamma[i]) + sum_gamma);
+    } else if (req_gamma != kNullOp) {
+      grad_gamma[i] = static_cast<Data>(sum_gamma);
+    }
+    if (req_beta == kAddTo) {
+      grad_beta[i] = static_cast<Data>(static_cast<Accum>(grad_beta[i]) + sum_beta);
+    } else if (req_beta != kNullOp) {
+      grad_beta[i] = static_cast<Data>(sum_beta);
     }
   }
 }
@@ -0,0 +1,367 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file linear_cross_entropy-inl.h
+ * \brief Softmax cross entropy fused with the linear layer computing its logits. The logits are
+ *        computed a chunk of the vocabulary at a time and never stored whole.
+ */
+#ifndef MXNET_OPERATOR_NN_LINEAR_CROSS_ENTROPY_INL_H_
+#define MXNET_OPERATOR_NN_LINEAR_CROSS_ENTROPY_INL_H_
+
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <mxnet/operator.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "../mshadow_op.h"
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+#include "../linalg.h"
+#include "../tensor/init_op.h"
+
+namespace mxnet {
+namespace op {
+
+namespace lce {
+enum LinearCrossEntropyOpInputs { kData, kWeight, kBias, kLabel };
+enum LinearCrossEntropyOpOutputs { kOut, kLogSumExp };
+}  // namespace lce
+
+struct LinearCrossEntropyParam : public dmlc::Parameter<LinearCrossEntropyParam> {
+  int num_classes;
+  int chunk_size;
+  bool no_bias;
+  int ignore_label;
+  DMLC_DECLARE_PARAMETER(LinearCrossEntropyParam) {
+    DMLC_DECLARE_FIELD(num_classes)
+        .set_default(0)
+        .set_lower_bound(0)
+        .describe("Size of the vocabulary. 0 takes it from the shape of the weight.");
+    DMLC_DECLARE_FIELD(chunk_size)
+        .set_default(4096)
+        .set_lower_bound(1)
+        .describe(
+            "Number of classes whose logits are computed at a time. The workspace holds "
+            "the logits of every input for one chunk.");
+    DMLC_DECLARE_FIELD(no_bias).set_default(false).describe("Whether to disable bias parameter.");
+    DMLC_DECLARE_FIELD(ignore_label)
+        .set_default(-1)
+        .describe("Inputs with this label, such as padding, have no loss and no gradient.");
+  }
+};
+
+inline uint32_t LinearCrossEntropyNumInputs(const NodeAttrs& attrs) {
+  return nnvm::get<LinearCrossEntropyParam>(attrs.parsed).no_bias ? 3 : 4;
+}
+
+inline std::vector<std::string> LinearCrossEntropyListInputNames(const NodeAttrs& attrs) {
+  if (nnvm::get<LinearCrossEntropyParam>(attrs.parsed).no_bias) {
+    return {"data", "weight", "label"};
+  }
+  return {"data", "weight", "bias", "label"};
+}
+
+inline bool LinearCrossEntropyShape(const nnvm::NodeAttrs& attrs,
+                                    mxnet::ShapeVector* in_shape,
+                                    mxnet::ShapeVector* out_shape) {
+  const LinearCrossEntropyParam& param = nnvm::get<LinearCrossEntropyParam>(attrs.parsed);
+  CHECK_EQ(in_shape->size(), LinearCrossEntropyNumInputs(attrs));
+  const int label_index = param.no_bias ? 2 : lce::kLabel;
+  const mxnet::TShape& dshape = (*in_shape)[lce::kData];
+  if (!mxnet::ndim_is_known(dshape))
+    return false;
+  CHECK_GE(dshape.ndim(), 2) << "linear_cross_entropy expects data of shape (..., hidden)";
+  const dim_t hidden = dshape[dshape.ndim() - 1];
+  dim_t num_classes  = param.num_classes;
+  if (num_classes == 0 && mxnet::ndim_is_known((*in_shape)[lce::kWeight]))
+    num_classes = (*in_shape)[lce::kWeight][0];
+  if (num_classes == 0 && !param.no_bias && mxnet::ndim_is_known((*in_shape)[lce::kBias]))
+    num_classes = (*in_shape)[lce::kBias][0];
+  if (num_classes > 0) {
+    SHAPE_ASSIGN_CHECK(*in_shape, lce::kWeight, Shape2(num_classes, hidden));
+    if (!param.no_bias)
+      SHAPE_ASSIGN_CHECK(*in_shape, lce::kBias, Shape1(num_classes));
+  }
+  mxnet::TShape lshape(dshape.begin(), dshape.end() - 1);
+  SHAPE_ASSIGN_CHECK(*in_shape, label_index, lshape);
+  out_shape->clear();
+  out_shape->push_back(lshape);
+  out_shape->push_back(lshape);
+  return num_classes > 0;
+}
+
+inline bool LinearCrossEntropyType(const nnvm::NodeAttrs& attrs,
+                                   std::vector<int>* in_type,
+                                   std::vector<int>* out_type) {
+  const LinearCrossEntropyParam& param = nnvm::get<LinearCrossEntropyParam>(attrs.parsed);
+  const int dtype = (*in_type)[lce::kData];
+  if (dtype == -1)
+    return false;
+  TYPE_ASSIGN_CHECK(*in_type, lce::kWeight, dtype);
+  if (!param.no_bias)
+    TYPE_ASSIGN_CHECK(*in_type, lce::kBias, dtype);
+  out_type->clear();
+  out_type->push_back(dtype);
+  out_type->push_back(dtype);
+  return (*in_type)[param.no_bias ? 2 : lce::kLabel] != -1;
+}
+
+/*!
+ * \brief Adds the bias to a chunk of logits and folds it into the running maximum and sum of
+ *        exponentials of each row, picking the logit of the label when the chunk holds it
+ */
+struct LinearCrossEntropyChunkForward {
+  template <typename DType, typename LType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  const DType* logits,
+                                  const DType* bias,
+                                  const LType* label,
+                                  index_t offset,
+                                  index_t chunk,
+                                  DType* running_max,
+                                  DType* running_sum,
+                                  DType* target) {
+    const DType* row = logits + i * chunk;
+    DType chunk_max  = mshadow::red::limits::MinValue<DType>();
+    for (index_t j = 0; j < chunk; ++j) {
+      chunk_max = mshadow_op::max::Map(chunk_max, row[j] + (bias ? bias[j] : DType(0)));
+    }
+    DType chunk_sum = 0;
+    for (index_t j = 0; j < chunk; ++j) {
+      chunk_sum += math::exp(row[j] + (bias ? bias[j] : DType(0)) - chunk_max);
+    }
+    const DType m   = mshadow_op::max::Map(running_max[i], chunk_max);
+    running_sum[i]  = running_sum[i] * math::exp(running_max[i] - m) +
+                      chunk_sum * math::exp(chunk_max - m);
+    running_max[i]  = m;
+    const index_t k = static_cast<index_t>(label[i]) - offset;
+    if (k >= 0 && k < chunk)
+      target[i] = row[k] + (bias ? bias[k] : DType(0));
+  }
+};
+
+/*! \brief The loss of each row from its log-sum-exp and the logit of its label */
+struct LinearCrossEntropyLoss {
+  template <typename DType, typename LType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  OpReqType req,
+                                  DType* lse,
+                                  const DType* running_sum,
+                                  const DType* target,
+                                  const LType* label,
+                                  int ignore_label) {
+    lse[i] += math::log(running_sum[i]);
+    KERNEL_ASSIGN(
+        out[i], req, static_cast<int>(label[i]) == ignore_label ? DType(0) : lse[i] - target[i]);
+  }
+};
+
+/*!
+ * \brief Turns a chunk of logits into the gradient of the loss w.r.t. them,
+ *        ograd * (softmax - one_hot(label))
+ */
+struct LinearCrossEntropyChunkBackward {
+  template <typename DType, typename LType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* logits,
+                                  const DType* bias,
+                                  const DType* ograd,
+                                  const LType* label,
+                                  const DType* lse,
+                                  index_t offset,
+                                  index_t chunk,
+                                  int ignore_label) {
+    const index_t r = i / chunk;
+    const index_t j = i % chunk;
+    if (static_cast<int>(label[r]) == ignore_label) {
+      logits[i] = 0;
+      return;
+    }
+    const DType p = math::exp(logits[i] + (bias ? bias[j] : DType(0)) - lse[r]);
+    const bool is_label = static_cast<index_t>(label[r]) - offset == j;
+    logits[i]           = ograd[r] * (is_label ? p - DType(1) : p);
+  }
+};
+
+/*! \brief The gradient of a chunk of the bias, the sum of the logit gradients over the rows */
+struct LinearCrossEntropyBiasGrad {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t j,
+                                  DType* bias_grad,
+                                  OpReqType req,
+                                  const DType* logit_grad,
+                                  index_t rows,
+                                  index_t chunk) {
+    DType sum = 0;
+    for (index_t r = 0; r < rows; ++r) {
+      sum += logit_grad[r * chunk + j];
+    }
+    KERNEL_ASSIGN(bias_grad[j], req, sum);
+  }
+};
+
+template <typename xpu>
+void LinearCrossEntropyForward(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  const LinearCrossEntropyParam& param = nnvm::get<LinearCrossEntropyParam>(attrs.parsed);
+  CHECK_EQ(inputs.size(), LinearCrossEntropyNumInputs(attrs));
+  CHECK_EQ(outputs.size(), 2U);
+  if (req[lce::kOut] == kNullOp)
+    return;
+  Stream<xpu>* s        = ctx.get_stream<xpu>();
+  const TBlob& data     = inputs[lce::kData];
+  const TBlob& weight   = inputs[lce::kWeight];
+  const TBlob& label    = inputs[param.no_bias ? 2 : lce::kLabel];
+  const index_t hidden  = data.shape_[data.ndim() - 1];
+  const index_t rows    = data.Size() / hidden;
+  const index_t classes = weight.shape_[0];
+  const index_t chunk   = std::min<index_t>(param.chunk_size, classes);
+  if (rows == 0)
+    return;
+  MSHADOW_SGL_DBL_TYPE_SWITCH(data.type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH(label.type_flag_, LType, {
+      Tensor<xpu, 1, DType> workspace = ctx.requested[0].get_space_typed<xpu, 1, DType>(
+          Shape1(rows * chunk + 2 * rows), s);
+      DType* logits      = workspace.dptr_;
+      DType* running_sum = logits + rows * chunk;
+      DType* target      = running_sum + rows;
+      // the log-sum-exp output holds the running maximum until the last chunk
+      DType* lse = outputs[lce::kLogSumExp].dptr<DType>();
+      Kernel<set_to_int<0>, xpu>::Launch(s, 2 * rows, running_sum);
+      Fill<false>(s, outputs[lce::kLogSumExp], kWriteTo, red::limits::MinValue<DType>());
+      Tensor<xpu, 2, DType> x(data.dptr<DType>(), Shape2(rows, hidden), s);
+      for (index_t offset = 0; offset < classes; offset += chunk) {
+        const index_t n = std::min(chunk, classes - offset);
+        Tensor<xpu, 2, DType> w(weight.dptr<DType>() + offset * hidden, Shape2(n, hidden), s);
+        Tensor<xpu, 2, DType> z(logits, Shape2(rows, n), s);
+        linalg_gemm(x, w, z, DType(1), DType(0), false, true, s);
+        Kernel<LinearCrossEntropyChunkForward, xpu>::Launch(
+            s,
+            rows,
+            logits,
+            param.no_bias ? nullptr : inputs[lce::kBias].dptr<DType>() + offset,
+            label.dptr<LType>(),
+            offset,
+            n,
+            lse,
+            running_sum,
+            target);
+      }
+      Kernel<LinearCrossEntropyLoss, xpu>::Launch(s,
+                                                  rows,
+                                                  outputs[lce::kOut].dptr<DType>(),
+                                                  req[lce::kOut],
+                                                  lse,
+                                                  running_sum,
+                                                  target,
+                                                  label.dptr<LType>(),
+                                                  param.ignore_label);
+    });
+  });
+}
+
+template <typename xpu>
+void LinearCrossEntropyBackward(const nnvm::NodeAttrs& attrs,
+                                const OpContext& ctx,
+                                const std::vector<TBlob>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  const LinearCrossEntropyParam& param = nnvm::get<LinearCrossEntropyParam>(attrs.parsed);
+  // ograd, data, weight, [bias], label, log-sum-exp
+  CHECK_EQ(inputs.size(), LinearCrossEntropyNumInputs(attrs) + 2);
+  CHECK_EQ(outputs.size(), LinearCrossEntropyNumInputs(attrs));
+  Stream<xpu>* s           = ctx.get_stream<xpu>();
+  const int label_index    = param.no_bias ? 2 : lce::kLabel;
+  const TBlob& ograd       = inputs[0];
+  const TBlob& data        = inputs[1 + lce::kData];
+  const TBlob& weight      = inputs[1 + lce::kWeight];
+  const TBlob& label       = inputs[1 + label_index];
+  const TBlob& lse         = inputs[2 + label_index];
+  const TBlob& data_grad   = outputs[lce::kData];
+  const TBlob& weight_grad = outputs[lce::kWeight];
+  const index_t hidden     = data.shape_[data.ndim() - 1];
+  const index_t rows       = data.Size() / hidden;
+  const index_t classes    = weight.shape_[0];
+  const index_t chunk      = std::min<index_t>(param.chunk_size, classes);
+  MSHADOW_SGL_DBL_TYPE_SWITCH(data.type_flag_, DType, {
+    if (req[label_index] != kNullOp)
+      Fill<false>(s, outputs[label_index], req[label_index], DType(0));
+    if (rows == 0) {
+      // the data gradient is empty, the others receive nothing
+      Fill<false>(s, weight_grad, req[lce::kWeight], DType(0));
+      if (!param.no_bias)
+        Fill<false>(s, outputs[lce::kBias], req[lce::kBias], DType(0));
+      return;
+    }
+    MSHADOW_TYPE_SWITCH(label.type_flag_, LType, {
+      Tensor<xpu, 1, DType> workspace =
+          ctx.requested[0].get_space_typed<xpu, 1, DType>(Shape1(rows * chunk), s);
+      DType* logits = workspace.dptr_;
+      Tensor<xpu, 2, DType> x(data.dptr<DType>(), Shape2(rows, hidden), s);
+      Tensor<xpu, 2, DType> dx(data_grad.dptr<DType>(), Shape2(rows, hidden), s);
+      for (index_t offset = 0; offset < classes; offset += chunk) {
+        const index_t n   = std::min(chunk, classes - offset);
+        const DType* bias = param.no_bias ? nullptr : inputs[1 + lce::kBias].dptr<DType>() + offset;
+        Tensor<xpu, 2, DType> w(weight.dptr<DType>() + offset * hidden, Shape2(n, hidden), s);
+        Tensor<xpu, 2, DType> z(logits, Shape2(rows, n), s);
+        linalg_gemm(x, w, z, DType(1), DType(0), false, true, s);
+        Kernel<LinearCrossEntropyChunkBackward, xpu>::Launch(s,
+                                                             rows * n,
+                                                             logits,
+                                                             bias,
+                                                             ograd.dptr<DType>(),
+                                                             label.dptr<LType>(),
+                                                             lse.dptr<DType>(),
+                                                             offset,
+                                                             n,
+                                                             param.ignore_label);
+        if (req[lce::kData] != kNullOp) {
+          // the first chunk writes the data gradient unless it adds to it, the others add
+          const bool add = offset > 0 || req[lce::kData] == kAddTo;
+          linalg_gemm(z, w, dx, DType(1), DType(add ? 1 : 0), false, false, s);
+        }
+        if (req[lce::kWeight] != kNullOp) {
+          Tensor<xpu, 2, DType> dw(
+              weight_grad.dptr<DType>() + offset * hidden, Shape2(n, hidden), s);
+          const bool add = req[lce::kWeight] == kAddTo;
+          linalg_gemm(z, x, dw, DType(1), DType(add ? 1 : 0), true, false, s);
+        }
+        if (!param.no_bias && req[lce::kBias] != kNullOp) {
+          Kernel<LinearCrossEntropyBiasGrad, xpu>::Launch(
+              s, n, outputs[lce::kBias].dptr<DType>() + offset, req[lce::kBias], logits, rows, n);
+        }
+      }
+    });
+  });
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_NN_LINEAR_CROSS_ENTROPY_INL_H_
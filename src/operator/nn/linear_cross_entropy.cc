@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file linear_cross_entropy.cc
+ * \brief CPU registration of the softmax cross entropy fused with its linear layer.
+ */
+
+#include "./linear_cross_entropy-inl.h"
+#include <nnvm/op_attr_types.h>
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(LinearCrossEntropyParam);
+
+NNVM_REGISTER_OP(linear_cross_entropy)
+    .add_alias("_npx_linear_cross_entropy")
+    .describe(R"code(Softmax cross entropy of the logits of a linear layer, never stored whole.
+
+For ``data`` of shape (..., hidden), ``weight`` of shape (num_classes, hidden) and integer ``label``
+of the shape of ``data`` without its last axis, the output is
+
+.. math::
+
+  logits = dot(data, weight.T) + bias
+  out = log(sum(exp(logits), axis=-1)) - pick(logits, label, axis=-1)
+
+The logits are computed ``chunk_size`` classes at a time. Each chunk updates the running maximum
+and sum of exponentials of every row, so the memory of the operator grows with ``chunk_size``
+rather than the vocabulary. The backward pass recomputes the logits of each chunk and accumulates
+the gradients of ``data``, ``weight`` and ``bias`` from them.
+
+Inputs whose label is ``ignore_label`` have a loss of 0 and no gradient.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(LinearCrossEntropyNumInputs)
+    .set_num_outputs(2)
+    .set_attr_parser(ParamParser<LinearCrossEntropyParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames", LinearCrossEntropyListInputNames)
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output", "logsumexp"};
+                                      })
+    .set_attr<nnvm::FNumVisibleOutputs>("FNumVisibleOutputs",
+                                        [](const NodeAttrs& attrs) { return 1; })
+    .set_attr<mxnet::FInferShape>("FInferShape", LinearCrossEntropyShape)
+    .set_attr<nnvm::FInferType>("FInferType", LinearCrossEntropyType)
+    .set_attr<FCompute>("FCompute<cpu>", LinearCrossEntropyForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient",
+                               [](const nnvm::ObjectPtr& n,
+                                  const std::vector<nnvm::NodeEntry>& ograds) {
+                                 std::vector<nnvm::NodeEntry> heads;
+                                 heads.push_back(ograds[0]);  // ograd
+                                 for (const auto& input : n->inputs) {
+                                   heads.push_back(input);  // data, weight, [bias], label
+                                 }
+                                 heads.emplace_back(nnvm::NodeEntry{n, 1, 0});  // logsumexp
+                                 return MakeGradNode(
+                                     "_backward_linear_cross_entropy", n, heads, n->attrs.dict);
+                               })
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& n) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<THasDeterministicOutput>("THasDeterministicOutput", true)
+    .add_argument("data", "NDArray-or-Symbol", "Input of the linear layer")
+    .add_argument("weight", "NDArray-or-Symbol", "Weight of the linear layer")
+    .add_argument("bias", "NDArray-or-Symbol", "Bias of the linear layer")
+    .add_argument("label", "NDArray-or-Symbol", "Class of each input")
+    .add_arguments(LinearCrossEntropyParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_linear_cross_entropy)
+    .set_num_inputs([](const NodeAttrs& attrs) { return LinearCrossEntropyNumInputs(attrs) + 2; })
+    .set_num_outputs(LinearCrossEntropyNumInputs)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr_parser(ParamParser<LinearCrossEntropyParam>)
+    .set_attr<FCompute>("FCompute<cpu>", LinearCrossEntropyBackward<cpu>)
+    .set_attr<FResourceRequest>("FResourceRequest", [](const NodeAttrs& n) {
+      return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+    });
+
+}  // namespace op
+}  // namespace mxnet
@@ -76,6 +76,12 @@ enum PoolingOpType { kMaxPooling, kAvgPooling, kSumPooling, kLpPooling };
 enum PoolingOpPadConventionType { kValid, kFull, kSame };
 }  // namespace pool_enum
 
+/*!
+ * \brief the channels reduced together by the cpu functions of the channels-last layouts, whose
+ *  accumulators are kept on the stack and whose loops over them are vectorized.
+ */
+constexpr index_t kPoolChannelBlock = 64;
+
 /*!
  * \brief max pooling cpu function for 1-D images in 'ncw' layout.
  * Do not call this kernel directly. Use the interface pool().
@@ -179,31 +185,31 @@ inline void pool_max_2d_nchw_cpu(const DType* in_data,
   const int stride_h = stride[0], stride_w = stride[1];
   const index_t in_data_offset  = ishape[2] * ishape[3];
   const index_t out_data_offset = oshape[2] * oshape[3];
-  for (index_t n = 0; n < oshape[0]; ++n) {
-    for (index_t c = 0; c < oshape[1]; ++c) {
-      for (int ph = 0; ph < pooled_height; ++ph) {
-        for (int pw = 0; pw < pooled_width; ++pw) {
-          int hstart           = ph * stride_h - pad_h;
-          int wstart           = pw * stride_w - pad_w;
-          int hend             = std::min(hstart + kernel_h, height);
-          int wend             = std::min(wstart + kernel_w, width);
-          hstart               = std::max(hstart, 0);
-          wstart               = std::max(wstart, 0);
-          const int pool_index = ph * pooled_width + pw;
-          DType max_val        = MinValue<DType>();
-          for (int h = hstart; h < hend; ++h) {
-            for (int w = wstart; w < wend; ++w) {
-              const int in_index = h * width + w;
-              if (in_data[in_index] > max_val) {
-                max_val = in_data[in_index];
-              }
+  const int omp_threads         = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t i = 0; i < oshape[0] * oshape[1]; ++i) {
+    const DType* in = in_data + i * in_data_offset;
+    DType* out      = out_data + i * out_data_offset;
+    for (int ph = 0; ph < pooled_height; ++ph) {
+      for (int pw = 0; pw < pooled_width; ++pw) {
+        int hstart           = ph * stride_h - pad_h;
+        int wstart           = pw * stride_w - pad_w;
+        int hend             = std::min(hstart + kernel_h, height);
+        int wend             = std::min(wstart + kernel_w, width);
+        hstart               = std::max(hstart, 0);
+        wstart               = std::max(wstart, 0);
+        const int pool_index = ph * pooled_width + pw;
+        DType max_val        = MinValue<DType>();
+        for (int h = hstart; h < hend; ++h) {
+          for (int w = wstart; w < wend; ++w) {
+            const int in_index = h * width + w;
+            if (in[in_index] > max_val) {
+              max_val = in[in_index];
             }
           }
-          out_data[pool_index] = max_val;
         }
+        out[pool_index] = max_val;
       }
-      in_data += in_data_offset;
-      out_data += out_data_offset;
     }
   }
 }
@@ -226,37 +232,38 @@ inline void pool_max_2d_nhwc_cpu(const DType* in_data,
   const int kernel_h = kernel[0], kernel_w = kernel[1];
   const int pad_h = pad[0], pad_w = pad[1];
   const int stride_h = stride[0], stride_w = stride[1];
-  const int features            = oshape[3];
-  const index_t in_data_offset  = ishape[1] * ishape[2] * features;
-  const index_t out_data_offset = oshape[1] * oshape[2] * features;
-  std::vector<DType> max_vals(features);
-  for (index_t n = 0; n < oshape[0]; ++n) {
-    for (int ph = 0; ph < pooled_height; ++ph) {
-      for (int pw = 0; pw < pooled_width; ++pw) {
-        int hstart           = ph * stride_h - pad_h;
-        int wstart           = pw * stride_w - pad_w;
-        int hend             = std::min(hstart + kernel_h, height);
-        int wend             = std::min(wstart + kernel_w, width);
-        hstart               = std::max(hstart, 0);
-        wstart               = std::max(wstart, 0);
-        const int pool_index = ph * pooled_width + pw;
-        std::fill(max_vals.begin(), max_vals.end(), MinValue<DType>());
-        for (int h = hstart; h < hend; ++h) {
-          for (int w = wstart; w < wend; ++w) {
-            const int in_index = h * width + w;
-            for (index_t c = 0; c < features; ++c) {
-              if (in_data[in_index * features + c] > max_vals[c]) {
-                max_vals[c] = in_data[in_index * features + c];
-              }
-            }
+  const index_t features       = oshape[3];
+  const index_t in_data_offset = ishape[1] * ishape[2] * features;
+  const index_t blocks         = (features + kPoolChannelBlock - 1) / kPoolChannelBlock;
+  const int omp_threads        = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  // each task pools a block of channels of a row of the output
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t i = 0; i < oshape[0] * pooled_height * blocks; ++i) {
+    const index_t n     = i / (pooled_height * blocks);
+    const int ph        = i / blocks % pooled_height;
+    const index_t begin = i % blocks * kPoolChannelBlock;
+    const index_t size  = std::min(kPoolChannelBlock, features - begin);
+    const DType* in     = in_data + n * in_data_offset + begin;
+    DType* out          = out_data + (n * pooled_height + ph) * pooled_width * features + begin;
+    DType max_vals[kPoolChannelBlock];
+    for (int pw = 0; pw < pooled_width; ++pw) {
+      int hstart = ph * stride_h - pad_h;
+      int wstart = pw * stride_w - pad_w;
+      int hend   = std::min(hstart + kernel_h, height);
+      int wend   = std::min(wstart + kernel_w, width);
+      hstart     = std::max(hstart, 0);
+      wstart     = std::max(wstart, 0);
+      std::fill(max_vals, max_vals + size, MinValue<DType>());
+      for (int h = hstart; h < hend; ++h) {
+        for (int w = wstart; w < wend; ++w) {
+          const DType* pixel = in + (h * width + w) * features;
+          for (index_t c = 0; c < size; ++c) {
+            max_vals[c] = pixel[c] > max_vals[c] ? pixel[c] : max_vals[c];
           }
         }
-        for (index_t c = 0; c < features; ++c)
-          out_data[pool_index * features + c] = max_vals[c];
       }
+      std::copy(max_vals, max_vals + size, out + pw * features);
     }
-    in_data += in_data_offset;
-    out_data += out_data_offset;
   }
 }
 
@@ -490,33 +497,33 @@ inline void pool_sum_2d_nchw_cpu(const DType* in_data,
   const int stride_h = stride[0], stride_w = stride[1];
   const index_t in_data_offset  = ishape[2] * ishape[3];
   const index_t out_data_offset = oshape[2] * oshape[3];
-  for (index_t n = 0; n < oshape[0]; ++n) {
-    for (index_t c = 0; c < oshape[1]; ++c) {
-      for (int ph = 0; ph < pooled_height; ++ph) {
-        for (int pw = 0; pw < pooled_width; ++pw) {
-          int hstart    = ph * stride_h - pad_h;
-          int wstart    = pw * stride_w - pad_w;
-          int hend      = std::min(hstart + kernel_h, height + pad_h);
-          int wend      = std::min(wstart + kernel_w, width + pad_w);
-          int pool_size = (get_avg ? (hend - hstart) * (wend - wstart) : 1);
-          hstart        = std::max(hstart, 0);
-          wstart        = std::max(wstart, 0);
-          hend          = std::min(hend, height);
-          wend          = std::min(wend, width);
-          if (get_avg && !count_include_pad) {
-            pool_size = (hend - hstart) * (wend - wstart);
-          }
-          AccType sum = 0;
-          for (int h = hstart; h < hend; ++h) {
-            for (int w = wstart; w < wend; ++w) {
-              sum += a_pow_p<AccType, p>::Map(in_data[h * width + w]) / pool_size;
-            }
+  const int omp_threads         = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t i = 0; i < oshape[0] * oshape[1]; ++i) {
+    const DType* in = in_data + i * in_data_offset;
+    DType* out      = out_data + i * out_data_offset;
+    for (int ph = 0; ph < pooled_height; ++ph) {
+      for (int pw = 0; pw < pooled_width; ++pw) {
+        int hstart    = ph * stride_h - pad_h;
+        int wstart    = pw * stride_w - pad_w;
+        int hend      = std::min(hstart + kernel_h, height + pad_h);
+        int wend      = std::min(wstart + kernel_w, width + pad_w);
+        int pool_size = (get_avg ? (hend - hstart) * (wend - wstart) : 1);
+        hstart        = std::max(hstart, 0);
+        wstart        = std::max(wstart, 0);
+        hend          = std::min(hend, height);
+        wend          = std::min(wend, width);
+        if (get_avg && !count_include_pad) {
+          pool_size = (hend - hstart) * (wend - wstart);
+        }
+        AccType sum = 0;
+        for (int h = hstart; h < hend; ++h) {
+          for (int w = wstart; w < wend; ++w) {
+            sum += a_pow_p<AccType, p>::Map(in[h * width + w]);
           }
-          out_data[ph * pooled_width + pw] = a_root_p<AccType, p>::Map(sum);
         }
+        out[ph * pooled_width + pw] = a_root_p<AccType, p>::Map(sum / pool_size);
       }
-      in_data += in_data_offset;
-      out_data += out_data_offset;
     }
   }
 }
@@ -541,41 +548,45 @@ inline void pool_sum_2d_nhwc_cpu(const DType* in_data,
   const int kernel_h = kernel[0], kernel_w = kernel[1];
   const int pad_h = pad[0], pad_w = pad[1];
   const int stride_h = stride[0], stride_w = stride[1];
-  const int features            = oshape[3];
-  const index_t in_data_offset  = ishape[1] * ishape[2] * features;
-  const index_t out_data_offset = oshape[1] * oshape[2] * features;
-  std::vector<AccType> sums(features);
-  for (index_t n = 0; n < oshape[0]; ++n) {
-    for (int ph = 0; ph < pooled_height; ++ph) {
-      for (int pw = 0; pw < pooled_width; ++pw) {
-        int hstart    = ph * stride_h - pad_h;
-        int wstart    = pw * stride_w - pad_w;
-        int hend      = std::min(hstart + kernel_h, height + pad_h);
-        int wend      = std::min(wstart + kernel_w, width + pad_w);
-        int pool_size = (get_avg ? (hend - hstart) * (wend - wstart) : 1);
-        hstart        = std::max(hstart, 0);
-        wstart        = std::max(wstart, 0);
-        hend          = std::min(hend, height);
-        wend          = std::min(wend, width);
-        if (get_avg && !count_include_pad) {
-          pool_size = (hend - hstart) * (wend - wstart);
-        }
-        const int pool_index = ph * pooled_width + pw;
-        std::fill(sums.begin(), sums.end(), 0);
-        for (int h = hstart; h < hend; ++h) {
-          for (int w = wstart; w < wend; ++w) {
-            const int in_index = h * width + w;
-            for (index_t c = 0; c < features; ++c) {
-              sums[c] += a_pow_p<AccType, p>::Map(in_data[in_index * features + c]) / pool_size;
-            }
+  const index_t features       = oshape[3];
+  const index_t in_data_offset = ishape[1] * ishape[2] * features;
+  const index_t blocks         = (features + kPoolChannelBlock - 1) / kPoolChannelBlock;
+  const int omp_threads        = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  // each task pools a block of channels of a row of the output
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t i = 0; i < oshape[0] * pooled_height * blocks; ++i) {
+    const index_t n     = i / (pooled_height * blocks);
+    const int ph        = i / blocks % pooled_height;
+    const index_t begin = i % blocks * kPoolChannelBlock;
+    const index_t size  = std::min(kPoolChannelBlock, features - begin);
+    const DType* in     = in_data + n * in_data_offset + begin;
+    DType* out          = out_data + (n * pooled_height + ph) * pooled_width * features + begin;
+    AccType sums[kPoolChannelBlock];
+    for (int pw = 0; pw < pooled_width; ++pw) {
+      int hstart    = ph * stride_h - pad_h;
+      int wstart    = pw * stride_w - pad_w;
+      int hend      = std::min(hstart + kernel_h, height + pad_h);
+      int wend      = std::min(wstart + kernel_w, width + pad_w);
+      int pool_size = (get_avg ? (hend - hstart) * (wend - wstart) : 1);
+      hstart        = std::max(hstart, 0);
+      wstart        = std::max(wstart, 0);
+      hend          = std::min(hend, height);
+      wend          = std::min(wend, width);
+      if (get_avg && !count_include_pad) {
+        pool_size = (hend - hstart) * (wend - wstart);
+      }
+      std::fill(sums, sums + size, AccType(0));
+      for (int h = hstart; h < hend; ++h) {
+        for (int w = wstart; w < wend; ++w) {
+          const DType* pixel = in + (h * width + w) * features;
+          for (index_t c = 0; c < size; ++c) {
+            sums[c] += a_pow_p<AccType, p>::Map(pixel[c]);
           }
         }
-        for (index_t c = 0; c < features; ++c)
-          out_data[pool_index * features + c] = a_root_p<AccType, p>::Map(sums[c]);
       }
+      for (index_t c = 0; c < size; ++c)
+        out[pw * features + c] = a_root_p<AccType, p>::Map(sums[c] / pool_size);
     }
-    in_data += in_data_offset;
-    out_data += out_data_offset;
   }
 }
 
@@ -1430,6 +1441,128 @@ inline void unpool_sum_3d_ndhwc_cpu(const DType* out_grad,
   }
 }
 
+/*!
+ * \brief Whether the kernel covers the whole unpadded images, so that the pooling reduces each of
+ *  their channels to one value.
+ */
+inline bool IsGlobalPool(const mxnet::TShape& ishape,
+                         const mxnet::TShape& oshape,
+                         const mxnet::TShape& kernel,
+                         const mxnet::TShape& pad,
+                         const bool channels_last) {
+  for (int i = 0; i < kernel.ndim(); ++i) {
+    const int axis = channels_last ? i + 1 : i + 2;
+    if (pad[i] != 0 || oshape[axis] != 1 || kernel[i] < ishape[axis])
+      return false;
+  }
+  return ishape.Size() > 0;
+}
+
+/*!
+ * \brief global max/avg/sum/lp pooling cpu function for 1/2/3-D images: a reduction of the
+ *  contiguous pixels of each channel, or vectorized over blocks of channels when they are last.
+ * Do not call this kernel directly. Use the interface pool().
+ */
+template <typename DType, int p = 1>
+inline void pool_global_cpu(const DType* in_data,
+                            const mxnet::TShape& ishape,
+                            const int pool_type,
+                            DType* out_data,
+                            const bool channels_last) {
+  using AccType = typename PoolingTypes<DType>::AccType;
+  using mshadow::red::limits::MinValue;
+  const index_t batch    = ishape[0];
+  const index_t features = channels_last ? ishape[ishape.ndim() - 1] : ishape[1];
+  const index_t pixels   = ishape.Size() / (batch * features);
+  const bool is_max      = pool_type == pool_enum::kMaxPooling;
+  const AccType scale    = pool_type == pool_enum::kAvgPooling ? AccType(1.0 / pixels) : AccType(1);
+  const int omp_threads  = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  if (!channels_last) {
+#pragma omp parallel for num_threads(omp_threads)
+    for (index_t i = 0; i < batch * features; ++i) {
+      const DType* in = in_data + i * pixels;
+      if (is_max) {
+        DType max_val = MinValue<DType>();
+        for (index_t j = 0; j < pixels; ++j)
+          max_val = in[j] > max_val ? in[j] : max_val;
+        out_data[i] = max_val;
+      } else {
+        AccType sum = 0;
+        for (index_t j = 0; j < pixels; ++j)
+          sum += a_pow_p<AccType, p>::Map(in[j]);
+        out_data[i] = a_root_p<AccType, p>::Map(sum * scale);
+      }
+    }
+    return;
+  }
+  const index_t blocks = (features + kPoolChannelBlock - 1) / kPoolChannelBlock;
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t i = 0; i < batch * blocks; ++i) {
+    const index_t begin = i % blocks * kPoolChannelBlock;
+    const index_t size  = std::min(kPoolChannelBlock, features - begin);
+    const DType* in     = in_data + i / blocks * pixels * features + begin;
+    DType* out          = out_data + i / blocks * features + begin;
+    if (is_max) {
+      DType max_vals[kPoolChannelBlock];
+      std::fill(max_vals, max_vals + size, MinValue<DType>());
+      for (index_t j = 0; j < pixels; ++j) {
+        const DType* pixel = in + j * features;
+        for (index_t c = 0; c < size; ++c)
+          max_vals[c] = pixel[c] > max_vals[c] ? pixel[c] : max_vals[c];
+      }
+      std::copy(max_vals, max_vals + size, out);
+    } else {
+      AccType sums[kPoolChannelBlock];
+      std::fill(sums, sums + size, AccType(0));
+      for (index_t j = 0; j < pixels; ++j) {
+        const DType* pixel = in + j * features;
+        for (index_t c = 0; c < size; ++c)
+          sums[c] += a_pow_p<AccType, p>::Map(pixel[c]);
+      }
+      for (index_t c = 0; c < size; ++c)
+        out[c] = a_root_p<AccType, p>::Map(sums[c] * scale);
+    }
+  }
+}
+
+/*!
+ * \brief global avg/sum unpooling cpu function for 1/2/3-D images: the gradient of each channel
+ *  is broadcast to its pixels.
+ * Do not call this kernel directly. Use the interface unpool().
+ */
+template <typename DType>
+inline void unpool_global_sum_cpu(const DType* out_grad,
+                                  const mxnet::TShape& ishape,
+                                  DType* in_grad,
+                                  const bool is_avg,
+                                  const bool channels_last,
+                                  const OpReqType req_type) {
+  using AccType          = typename PoolingTypes<DType>::AccType;
+  const index_t batch    = ishape[0];
+  const index_t features = channels_last ? ishape[ishape.ndim() - 1] : ishape[1];
+  const index_t pixels   = ishape.Size() / (batch * features);
+  const AccType scale    = is_avg ? AccType(1.0 / pixels) : AccType(1);
+  const bool add         = req_type == kAddTo;
+  const int omp_threads  = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  if (!channels_last) {
+#pragma omp parallel for num_threads(omp_threads)
+    for (index_t i = 0; i < batch * features; ++i) {
+      const DType grad = AccType(out_grad[i]) * scale;
+      DType* in        = in_grad + i * pixels;
+      for (index_t j = 0; j < pixels; ++j)
+        in[j] = add ? DType(in[j] + grad) : grad;
+    }
+    return;
+  }
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t i = 0; i < batch * pixels; ++i) {
+    const DType* grad = out_grad + i / pixels * features;
+    DType* in         = in_grad + i * features;
+    for (index_t c = 0; c < features; ++c)
+      in[c] = add ? DType(in[c] + AccType(grad[c]) * scale) : DType(AccType(grad[c]) * scale);
+  }
+}
+
 /*!
  * \brief This function serves as an interface for 1/2/3-D pooling operations.
  * \param s context stream defining the device in use is cpu
@@ -1458,6 +1591,17 @@ inline void pool(mshadow::Stream<cpu>* s,
                  const bool count_include_pad,
                  int layout) {
   CHECK_EQ(req_type, kWriteTo) << "Only support req=kWriteTo in pooling operations";
+  const bool channels_last =
+      layout == mshadow::kNWC || layout == mshadow::kNHWC || layout == mshadow::kNDHWC;
+  if (kernel.ndim() >= 1 && kernel.ndim() <= 3 &&
+      IsGlobalPool(ishape, oshape, kernel, pad, channels_last)) {
+    if (pool_enum::kLpPooling == pool_type) {
+      pool_global_cpu<DType, p>(in_data, ishape, pool_type, out_data, channels_last);
+    } else {
+      pool_global_cpu(in_data, ishape, pool_type, out_data, channels_last);
+    }
+    return;
+  }
   if (kernel.ndim() == 1) {
     if (layout == mshadow::kNWC) {
       if (pool_enum::kMaxPooling == pool_type) {
@@ -1586,6 +1730,19 @@ inline void unpool(mshadow::Stream<cpu>* s,
                    int layout) {
   if (mxnet::kNullOp == req_type)
     return;
+  const bool channels_last =
+      layout == mshadow::kNWC || layout == mshadow::kNHWC || layout == mshadow::kNDHWC;
+  if ((pool_enum::kAvgPooling == pool_type || pool_enum::kSumPooling == pool_type) &&
+      kernel.ndim() >= 1 && kernel.ndim() <= 3 &&
+      IsGlobalPool(ishape, oshape, kernel, pad, channels_last)) {
+    unpool_global_sum_cpu(out_grad,
+                          ishape,
+                          in_grad,
+                          pool_enum::kAvgPooling == pool_type,
+                          channels_last,
+                          req_type);
+    return;
+  }
   if (mxnet::kAddTo != req_type) {
     mxnet_op::Kernel<mxnet_op::set_zero, cpu>::Launch(s, ishape.Size(), in_grad);
   }
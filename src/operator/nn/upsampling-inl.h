@@ -33,6 +33,7 @@
 #include <vector>
 #include <string>
 #include <utility>
+#include "../mxnet_op.h"
 #include "../operator_common.h"
 #include "./deconvolution-inl.h"
 
@@ -53,6 +54,7 @@ struct UpSamplingParam : public dmlc::Parameter<UpSamplingParam> {
   int num_args;
   int multi_input_mode;
   uint64_t workspace;
+  dmlc::optional<int> layout;
   DMLC_DECLARE_PARAMETER(UpSamplingParam) {
     DMLC_DECLARE_FIELD(scale).set_lower_bound(1).describe("Up sampling scale");
     DMLC_DECLARE_FIELD(num_filter)
@@ -80,84 +82,303 @@ struct UpSamplingParam : public dmlc::Parameter<UpSamplingParam> {
         "same size. For bilinear upsampling this must be 2; 1 input and 1 weight.");
     DMLC_DECLARE_FIELD(workspace).set_default(512).set_lower_bound(0).describe(
         "Tmp workspace for deconvolution (MB)");
+    DMLC_DECLARE_FIELD(layout)
+        .add_enum("NCHW", mshadow::kNCHW)
+        .add_enum("NHWC", mshadow::kNHWC)
+        .set_default(dmlc::optional<int>())
+        .describe(
+            "Set layout for input and output. Empty for default layout NCHW. "
+            "NHWC is only supported by nearest neighbor upsampling.");
   }
 };  // struct UpSamplingParam
 
+inline bool UpSamplingIsNHWC(const UpSamplingParam& param) {
+  return param.layout.has_value() && param.layout.value() == mshadow::kNHWC;
+}
+
+/*!
+ * \brief Nearest neighbor upsampling of NHWC data into the channels
+ * [begin, begin + channels) of an output of out_channels channels.
+ */
+struct UpSamplingNearestNHWC {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const DType* data,
+                                  const OpReqType req,
+                                  const index_t channels,
+                                  const index_t in_height,
+                                  const index_t in_width,
+                                  const index_t out_height,
+                                  const index_t out_width,
+                                  const index_t out_channels,
+                                  const index_t begin,
+                                  const int scale) {
+    const index_t c = i % channels;
+    index_t rest    = i / channels;
+    const index_t x = rest % out_width;
+    rest /= out_width;
+    const index_t y = rest % out_height;
+    const index_t n = rest / out_height;
+    const index_t in_index  = ((n * in_height + y / scale) * in_width + x / scale) * channels + c;
+    const index_t out_index = ((n * out_height + y) * out_width + x) * out_channels + begin + c;
+    KERNEL_ASSIGN(out[out_index], req, data[in_index]);
+  }
+};
+
+/*!
+ * \brief Gradient of UpSamplingNearestNHWC: sums the scale x scale window of each input
+ * element.
+ */
+template <typename AccReal>
+struct UpSamplingNearestNHWCGrad {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* in_grad,
+                                  const DType* out_grad,
+                                  const OpReqType req,
+                                  const index_t channels,
+                                  const index_t in_height,
+                                  const index_t in_width,
+                                  const index_t out_height,
+                                  const index_t out_width,
+                                  const index_t out_channels,
+                                  const index_t begin,
+                                  const int scale) {
+    const index_t c = i % channels;
+    index_t rest    = i / channels;
+    const index_t x = rest % in_width;
+    rest /= in_width;
+    const index_t y = rest % in_height;
+    const index_t n = rest / in_height;
+    AccReal sum     = 0;
+    for (int dy = 0; dy < scale; ++dy) {
+      for (int dx = 0; dx < scale; ++dx) {
+        const index_t out_y = y * scale + dy;
+        const index_t out_x = x * scale + dx;
+        sum += static_cast<AccReal>(
+            out_grad[((n * out_height + out_y) * out_width + out_x) * out_channels + begin + c]);
+      }
+    }
+    KERNEL_ASSIGN(in_grad[i], req, static_cast<DType>(sum));
+  }
+};
+
+/*!
+ * \brief Nearest neighbor upsampling of NCHW data into the channels
+ * [begin, begin + channels) of an output of out_channels channels. Each thread writes the
+ * scale consecutive outputs of an input element in an output row.
+ */
+struct UpSamplingNearestNCHW {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const DType* data,
+                                  const OpReqType req,
+                                  const index_t channels,
+                                  const index_t in_height,
+                                  const index_t in_width,
+                                  const index_t out_height,
+                                  const index_t out_width,
+                                  const index_t out_channels,
+                                  const index_t begin,
+                                  const int scale) {
+    const index_t x = i % in_width;
+    index_t rest    = i / in_width;
+    const index_t y = rest % out_height;
+    rest /= out_height;
+    const index_t c = rest % channels;
+    const index_t n = rest / channels;
+    const DType val = data[((n * channels + c) * in_height + y / scale) * in_width + x];
+    DType* out_row  = out + ((n * out_channels + begin + c) * out_height + y) * out_width;
+    for (int dx = 0; dx < scale; ++dx) {
+      KERNEL_ASSIGN(out_row[x * scale + dx], req, val);
+    }
+  }
+};
+
+/*!
+ * \brief Gradient of UpSamplingNearestNCHW: sums the scale x scale window of each input
+ * element.
+ */
+template <typename AccReal>
+struct UpSamplingNearestNCHWGrad {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* in_grad,
+                                  const DType* out_grad,
+                                  const OpReqType req,
+                                  const index_t channels,
+                                  const index_t in_height,
+                                  const index_t in_width,
+                                  const index_t out_height,
+                                  const index_t out_width,
+                                  const index_t out_channels,
+                                  const index_t begin,
+                                  const int scale) {
+    const index_t x = i % in_width;
+    index_t rest    = i / in_width;
+    const index_t y = rest % in_height;
+    rest /= in_height;
+    const index_t c   = rest % channels;
+    const index_t n   = rest / channels;
+    const DType* grad = out_grad + (n * out_channels + begin + c) * out_height * out_width;
+    AccReal sum       = 0;
+    for (int dy = 0; dy < scale; ++dy) {
+      const DType* grad_row = grad + (y * scale + dy) * out_width + x * scale;
+      for (int dx = 0; dx < scale; ++dx) {
+        sum += static_cast<AccReal>(grad_row[dx]);
+      }
+    }
+    KERNEL_ASSIGN(in_grad[i], req, static_cast<DType>(sum));
+  }
+};
+
+template <typename xpu, typename DType>
+void UpSamplingForwardNHWC(const OpContext& ctx,
+                           const UpSamplingParam& param,
+                           const std::vector<TBlob>& in_data,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<TBlob>& out_data) {
+  using namespace mxnet_op;
+  CHECK_EQ(in_data.size(), static_cast<size_t>(param.num_args));
+  CHECK_EQ(out_data.size(), 1U);
+  if (req[up_enum::kOut] == kNullOp) {
+    return;
+  }
+  mshadow::Stream<xpu>* s  = ctx.get_stream<xpu>();
+  const TBlob& out         = out_data[up_enum::kOut];
+  const index_t out_height = out.size(1);
+  const index_t out_width  = out.size(2);
+  index_t begin            = 0;
+  for (int i = 0; i < param.num_args; ++i) {
+    const TBlob& data      = in_data[i];
+    const index_t channels = data.size(3);
+    const int scale        = out_height / data.size(1);
+    const bool sum         = param.multi_input_mode == up_enum::kSum && param.num_args > 1;
+    // the inputs after the first one are added to the output when summed
+    const OpReqType data_req = sum && i > 0 ? kAddTo : req[up_enum::kOut];
+    Kernel<UpSamplingNearestNHWC, xpu>::Launch(s,
+                                               data.size(0) * out_height * out_width * channels,
+                                               out.dptr<DType>(),
+                                               data.dptr<DType>(),
+                                               data_req,
+                                               channels,
+                                               data.size(1),
+                                               data.size(2),
+                                               out_height,
+                                               out_width,
+                                               out.size(3),
+                                               sum ? 0 : begin,
+                                               scale);
+    begin += channels;
+  }
+}
+
+template <typename xpu, typename DType, typename AccReal>
+void UpSamplingBackwardNHWC(const OpContext& ctx,
+                            const UpSamplingParam& param,
+                            const TBlob& out_grad,
+                            const std::vector<OpReqType>& req,
+                            const std::vector<TBlob>& in_grad) {
+  using namespace mxnet_op;
+  CHECK_EQ(in_grad.size(), static_cast<size_t>(param.num_args));
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  index_t begin           = 0;
+  for (int i = 0; i < param.num_args; ++i) {
+    const TBlob& grad      = in_grad[i];
+    const index_t channels = grad.size(3);
+    const bool sum         = param.multi_input_mode == up_enum::kSum && param.num_args > 1;
+    if (req[i] != kNullOp) {
+      Kernel<UpSamplingNearestNHWCGrad<AccReal>, xpu>::Launch(s,
+                                                              grad.Size(),
+                                                              grad.dptr<DType>(),
+                                                              out_grad.dptr<DType>(),
+                                                              req[i],
+                                                              channels,
+                                                              grad.size(1),
+                                                              grad.size(2),
+                                                              out_grad.size(1),
+                                                              out_grad.size(2),
+                                                              out_grad.size(3),
+                                                              sum ? 0 : begin,
+                                                              out_grad.size(1) / grad.size(1));
+    }
+    begin += channels;
+  }
+}
+
 template <typename xpu, typename DType>
 void UpSamplingForward(const OpContext& ctx,
                        const UpSamplingParam& param,
                        const std::vector<TBlob>& in_data,
                        const std::vector<OpReqType>& req,
                        const std::vector<TBlob>& out_data) {
-  using namespace mshadow;
-  using namespace mshadow::expr;
+  using namespace mxnet_op;
   CHECK_EQ(in_data.size(), static_cast<size_t>(param.num_args));
   CHECK_EQ(out_data.size(), 1U);
   if (req[up_enum::kOut] == kNullOp) {
     return;
   }
-  Stream<xpu>* s            = ctx.get_stream<xpu>();
-  Tensor<xpu, 4, DType> out = out_data[up_enum::kOut].get<xpu, 4, DType>(s);
-  if (param.num_args > 1) {
-    int begin = 0;
-    for (int i = 0; i < param.num_args; ++i) {
-      Tensor<xpu, 4, DType> data = in_data[i].get<xpu, 4, DType>(s);
-      int end                    = begin + data.size(1);
-      int scale                  = out_data[up_enum::kOut].size(2) / in_data[i].size(2);
-      if (param.multi_input_mode == up_enum::kSum) {
-        if (i == 0) {
-          Assign(out, req[up_enum::kOut], upsampling_nearest(data, scale));
-        } else {
-          out += upsampling_nearest(data, scale);
-        }
-      } else {
-        Assign(slice<1>(out, begin, end), req[up_enum::kOut], upsampling_nearest(data, scale));
-      }
-      begin = end;
-    }
-  } else {
-    Tensor<xpu, 4, DType> data = in_data[up_enum::kData].get<xpu, 4, DType>(s);
-    Assign(out, req[up_enum::kOut], upsampling_nearest(data, param.scale));
+  mshadow::Stream<xpu>* s  = ctx.get_stream<xpu>();
+  const TBlob& out         = out_data[up_enum::kOut];
+  const index_t out_height = out.size(2);
+  const index_t out_width  = out.size(3);
+  index_t begin            = 0;
+  for (int i = 0; i < param.num_args; ++i) {
+    const TBlob& data      = in_data[i];
+    const index_t channels = data.size(1);
+    const int scale        = out_height / data.size(2);
+    const bool sum         = param.multi_input_mode == up_enum::kSum && param.num_args > 1;
+    // the inputs after the first one are added to the output when summed
+    const OpReqType data_req = sum && i > 0 ? kAddTo : req[up_enum::kOut];
+    Kernel<UpSamplingNearestNCHW, xpu>::Launch(s,
+                                               data.size(0) * channels * out_height * data.size(3),
+                                               out.dptr<DType>(),
+                                               data.dptr<DType>(),
+                                               data_req,
+                                               channels,
+                                               data.size(2),
+                                               data.size(3),
+                                               out_height,
+                                               out_width,
+                                               out.size(1),
+                                               sum ? 0 : begin,
+                                               scale);
+    begin += channels;
   }
 }
 
-template <typename xpu, typename DType>
+template <typename xpu, typename DType, typename AccReal>
 void UpSamplingBackward(const OpContext& ctx,
                         const UpSamplingParam& param,
                         const TBlob& out_grad,
                         const std::vector<OpReqType>& req,
                         const std::vector<TBlob>& in_grad) {
-  using namespace mshadow;
-  using namespace mshadow::expr;
+  using namespace mxnet_op;
   CHECK_EQ(in_grad.size(), static_cast<size_t>(param.num_args));
-  Stream<xpu>* s             = ctx.get_stream<xpu>();
-  Tensor<xpu, 4, DType> grad = out_grad.get<xpu, 4, DType>(s);
-  if (param.num_args > 1) {
-    int begin = 0;
-    for (int i = 0; i < param.num_args; ++i) {
-      Tensor<xpu, 4, DType> input_grad = in_grad[i].get<xpu, 4, DType>(s);
-      mshadow::Shape<2> in_shape       = Shape2(input_grad.shape_[2], input_grad.shape_[3]);
-      int end                          = begin + input_grad.size(1);
-      int scale                        = grad.size(2) / in_shape[0];
-      if (param.multi_input_mode == up_enum::kSum) {
-        Assign(input_grad,
-               req[i],
-               pool<mshadow::red::sum>(grad, in_shape, scale, scale, scale, scale));
-      } else {
-        Assign(input_grad,
-               req[i],
-               pool<mshadow::red::sum>(
-                   slice<1>(grad, begin, end), in_shape, scale, scale, scale, scale));
-      }
-      begin = end;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  index_t begin           = 0;
+  for (int i = 0; i < param.num_args; ++i) {
+    const TBlob& grad      = in_grad[i];
+    const index_t channels = grad.size(1);
+    const bool sum         = param.multi_input_mode == up_enum::kSum && param.num_args > 1;
+    if (req[i] != kNullOp) {
+      Kernel<UpSamplingNearestNCHWGrad<AccReal>, xpu>::Launch(s,
+                                                              grad.Size(),
+                                                              grad.dptr<DType>(),
+                                                              out_grad.dptr<DType>(),
+                                                              req[i],
+                                                              channels,
+                                                              grad.size(2),
+                                                              grad.size(3),
+                                                              out_grad.size(2),
+                                                              out_grad.size(3),
+                                                              out_grad.size(1),
+                                                              sum ? 0 : begin,
+                                                              out_grad.size(2) / grad.size(2));
     }
-  } else {
-    Tensor<xpu, 4, DType> input_grad = in_grad[up_enum::kData].get<xpu, 4, DType>(s);
-    mshadow::Shape<2> in_shape       = Shape2(input_grad.shape_[2], input_grad.shape_[3]);
-    Assign(input_grad,
-           req[up_enum::kData],
-           pool<mshadow::red::sum>(
-               grad, in_shape, param.scale, param.scale, param.scale, param.scale));
+    begin += channels;
   }
 }
 
@@ -189,8 +410,12 @@ void UpSamplingCompute(const nnvm::NodeAttrs& attrs,
                        const std::vector<TBlob>& outputs) {
   const UpSamplingParam& param = nnvm::get<UpSamplingParam>(attrs.parsed);
   if (param.sample_type == up_enum::kNearest) {
-    MSHADOW_REAL_TYPE_SWITCH(inputs[deconv::kData].type_flag_, DType, {
-      UpSamplingForward<xpu, DType>(ctx, param, inputs, req, outputs);
+    MSHADOW_REAL_TYPE_SWITCH_EX(inputs[deconv::kData].type_flag_, DType, AccReal, {
+      if (UpSamplingIsNHWC(param)) {
+        UpSamplingForwardNHWC<xpu, DType>(ctx, param, inputs, req, outputs);
+      } else {
+        UpSamplingForward<xpu, DType>(ctx, param, inputs, req, outputs);
+      }
     });
   } else if (param.sample_type == up_enum::kBilinear) {
     DeconvolutionParam p = GetDeconvolutionParam(param);
@@ -208,9 +433,13 @@ void UpSamplingGradCompute(const nnvm::NodeAttrs& attrs,
                            const std::vector<TBlob>& outputs) {
   const UpSamplingParam& param = nnvm::get<UpSamplingParam>(attrs.parsed);
   if (param.sample_type == up_enum::kNearest) {
-    MSHADOW_REAL_TYPE_SWITCH(inputs[deconv::kData].type_flag_, DType, {
+    MSHADOW_REAL_TYPE_SWITCH_EX(inputs[deconv::kData].type_flag_, DType, AccReal, {
       CHECK_EQ(inputs.size(), 1U);
-      UpSamplingBackward<xpu, DType>(ctx, param, inputs[0], req, outputs);
+      if (UpSamplingIsNHWC(param)) {
+        UpSamplingBackwardNHWC<xpu, DType, AccReal>(ctx, param, inputs[0], req, outputs);
+      } else {
+        UpSamplingBackward<xpu, DType, AccReal>(ctx, param, inputs[0], req, outputs);
+      }
     });
   } else if (param.sample_type == up_enum::kBilinear) {
     DeconvolutionParam p = GetDeconvolutionParam(param);
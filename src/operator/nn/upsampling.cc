@@ -26,6 +26,7 @@
 #include "./upsampling-inl.h"
 #include <nnvm/op_attr_types.h>
 #include "./deconvolution-inl.h"
+#include "../../common/alm.h"
 
 namespace mxnet {
 namespace op {
@@ -35,28 +36,33 @@ static bool UpSamplingShape(const nnvm::NodeAttrs& attrs,
                             mxnet::ShapeVector* out_shape) {
   const UpSamplingParam& param_ = nnvm::get<UpSamplingParam>(attrs.parsed);
   CHECK_GE(in_shape->size(), 1U);
+  const bool nhwc = UpSamplingIsNHWC(param_);
+  // channel, height and width axes
+  const int c = nhwc ? 3 : 1, y = nhwc ? 1 : 2, x = nhwc ? 2 : 3;
+
   const mxnet::TShape& dshape = (*in_shape)[0];
   mxnet::TShape oshape        = dshape;
   if (param_.sample_type == up_enum::kNearest) {
     CHECK_EQ(in_shape->size(), static_cast<size_t>(param_.num_args));
-    oshape[1] = 0;
+    oshape[c] = 0;
     for (auto& shape : *in_shape) {
-      CHECK_EQ(shape.ndim(), 4U)
-          << "UpSamplingNearest: Input data should be 4D in (batch, channel, y, x)";
-      int oh = dshape[2] * param_.scale, ow = dshape[3] * param_.scale;
-      CHECK_EQ(oh % shape[2], 0U) << "UpSamplingNearest: input height of " << shape[2]
+      CHECK_EQ(shape.ndim(), 4U) << "UpSamplingNearest: Input data should be 4D in "
+                                 << (nhwc ? "(batch, y, x, channel)" : "(batch, channel, y, x)");
+      int oh = dshape[y] * param_.scale, ow = dshape[x] * param_.scale;
+      CHECK_EQ(oh % shape[y], 0U) << "UpSamplingNearest: input height of " << shape[y]
                                   << "does not divide output height of " << oh;
-      CHECK_EQ(ow % shape[3], 0U) << "UpSamplingNearest: input width of " << shape[3]
+      CHECK_EQ(ow % shape[x], 0U) << "UpSamplingNearest: input width of " << shape[x]
                                   << "does not divide output width of " << ow;
       if (param_.multi_input_mode == up_enum::kSum) {
-        CHECK(oshape[1] == 0 || oshape[1] == shape[1])
+        CHECK(oshape[c] == 0 || oshape[c] == shape[c])
             << "Number of channels must be the same when multi_input_mode==sum";
-        oshape[1] = shape[1];
+        oshape[c] = shape[c];
       } else {
-        oshape[1] += shape[1];
+        oshape[c] += shape[c];
       }
     }
   } else {
+    CHECK(!nhwc) << "UpSamplingBilinear: only NCHW layout is supported";
     CHECK_EQ(in_shape->size(), 2U) << "Input:[data, weight]";
     CHECK_EQ(dshape.ndim(), 4U)
         << "UpSamplingBilinear: Input data should be 4D in (batch, channel, y, x)";
@@ -66,13 +72,38 @@ static bool UpSamplingShape(const nnvm::NodeAttrs& attrs,
     SHAPE_ASSIGN_CHECK(*in_shape, up_enum::kWeight, mshadow::Shape4(dshape[1], 1, kernel, kernel));
     oshape = dshape;
   }
-  oshape[2] = dshape[2] * param_.scale;
-  oshape[3] = dshape[3] * param_.scale;
+  oshape[y] = dshape[y] * param_.scale;
+  oshape[x] = dshape[x] * param_.scale;
   out_shape->clear();
   out_shape->push_back(oshape);
   return true;
 }
 
+static bool UpSamplingChangeLayout(nnvm::NodeAttrs* attrs,
+                                   mshadow::LayoutFlag target_layout,
+                                   std::vector<alm::Transpose>* in_axes,
+                                   std::vector<alm::Transpose>* out_axes) {
+  CHECK_EQ(target_layout, mshadow::kUNKNOWN);
+  const UpSamplingParam& param = nnvm::get<UpSamplingParam>(attrs->parsed);
+  out_axes->assign(1, alm::Transpose());
+  if (param.sample_type != up_enum::kNearest)
+    return false;
+  std::vector<alm::Transpose> axes(*in_axes);
+  auto t = alm::FactorCommonTransposeAll(&axes);
+  if (alm::IsIdentity(t) || t.size() != 4)
+    return false;
+  const auto layout = static_cast<mshadow::LayoutFlag>(
+      param.layout.has_value() ? param.layout.value() : mshadow::kNCHW);
+  const std::string new_layout = alm::ApplyTranspose(mshadow::toString(layout), alm::Reverse(t));
+  // only the NCHW and NHWC kernels exist, other layouts keep the pending transposes
+  if (new_layout != "NCHW" && new_layout != "NHWC")
+    return false;
+  *in_axes = std::move(axes);
+  out_axes->assign(1, t);
+  attrs->dict["layout"] = new_layout;
+  return true;
+}
+
 static inline std::vector<std::string> ListArguments(const UpSamplingParam& param) {
   if (param.sample_type == up_enum::kNearest) {
     std::vector<std::string> ret;
@@ -122,6 +153,7 @@ struct UpSamplingGrad {
 DMLC_REGISTER_PARAMETER(UpSamplingParam);
 
 NNVM_REGISTER_OP(UpSampling)
+    .add_alias("_npx_upsampling")
     .describe(R"code(Upsamples the given input data.
 
 Two algorithms (``sample_type``) are available for upsampling:
@@ -131,7 +163,7 @@ Two algorithms (``sample_type``) are available for upsampling:
 
 **Nearest Neighbor Upsampling**
 
-Input data is expected to be NCHW.
+Input data is expected to be NCHW, or NHWC with ``layout='NHWC'``.
 
 Example::
 
@@ -189,6 +221,7 @@ Example::
                                       })
     .set_attr<mxnet::FInferShape>("FInferShape", UpSamplingShape)
     .set_attr<nnvm::FInferType>("FInferType", UpSamplingType)
+    .set_attr<mxnet::alm::FChangeLayout>("FChangeLayout", UpSamplingChangeLayout)
     .set_attr<FResourceRequest>("FResourceRequest",
                                 [](const NodeAttrs& n) {
                                   const UpSamplingParam& param =
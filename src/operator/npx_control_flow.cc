@@ -47,6 +47,52 @@ class ForeachState : public LoopState {
   }
 };
 
+// The inference of a compiled foreach copies the slices of the data and the states to the
+// same subgraph inputs in every iteration, and the outputs from the same subgraph outputs.
+static void ForeachStaticCompute(ForeachState* state,
+                                 const std::vector<NDArray>& inputs,
+                                 const std::vector<NDArray>& outputs) {
+  const NPXForeachParam& params = state->params;
+  const size_t len              = inputs[0].shape()[0];
+  const int num_data            = params.in_data_locs.ndim();
+  const int num_states          = params.in_state_locs.ndim();
+  const auto buffer_like        = [](const NDArray& arr) {
+    return NDArray(arr.shape(), arr.ctx(), false, arr.dtype());
+  };
+  std::vector<NDArray> subg_inputs(inputs.size());
+  for (int j = 0; j < params.remain_locs.ndim(); j++)
+    subg_inputs[params.remain_locs[j]] = inputs[j + num_data + num_states];
+  for (int j = 0; j < num_data; j++)
+    subg_inputs[params.in_data_locs[j]] = buffer_like(inputs[j].At(0));
+  for (int j = 0; j < num_states; j++) {
+    NDArray& in_state = subg_inputs[params.in_state_locs[j]];
+    in_state          = buffer_like(inputs[num_data + j]);
+    CopyFromTo(inputs[num_data + j], &in_state);
+  }
+  std::vector<NDArray> subg_outputs(outputs.size());
+  for (size_t j = 0; j < outputs.size(); j++) {
+    const bool is_data = j < static_cast<size_t>(params.num_out_data);
+    subg_outputs[j]    = buffer_like(is_data ? outputs[j].At(0) : outputs[j]);
+  }
+
+  for (size_t i = 0; i < len; i++) {
+    for (int j = 0; j < num_data; j++)
+      CopyFromTo(inputs[j].At(i), &subg_inputs[params.in_data_locs[j]]);
+    // The states are the outputs of the previous iteration.
+    for (int j = 0; i > 0 && j < num_states; j++) {
+      const NDArray& out_state = subg_outputs[params.num_out_data + params.in_state_index[j]];
+      CopyFromTo(out_state, &subg_inputs[params.in_state_locs[j]]);
+    }
+    state->StaticForward(subg_inputs, &subg_outputs);
+    for (int j = 0; j < params.num_out_data; j++) {
+      NDArray slot = outputs[j].At(i);
+      CopyFromTo(subg_outputs[j], &slot);
+    }
+  }
+  for (size_t j = params.num_out_data; j < outputs.size(); j++)
+    CopyFromTo(subg_outputs[j], outputs[j]);
+}
+
 static void ForeachComputeExCPU(const OpStatePtr& state_ptr,
                                 const OpContext& ctx,
                                 const std::vector<NDArray>& inputs,
@@ -66,6 +112,10 @@ static void ForeachComputeExCPU(const OpStatePtr& state_ptr,
   for (const auto& arr : outputs)
     CHECK_EQ(arr.storage_type(), kDefaultStorage)
         << "The for operator doesn't support the sparse format";
+  if (params.compiled && !ctx.need_grad && len > 0) {
+    ForeachStaticCompute(&state, inputs, outputs);
+    return;
+  }
 
   // Initialize the outputs of the subgraph is a little trickier.
   // The states from the previous iteration are used as the inputs of the next
@@ -509,6 +559,7 @@ class WhileLoopState : public LoopState {
   NPXWhileLoopParam params;
   size_t n_iterations;  // the actual number of steps taken in this while loop, <= max_iterations
   CachedOpPtr cond_op;
+  CachedOpPtr static_cond_op;  // only for a compiled while loop
   // abbrev for output_input_mapping
   // indicates to which index the output of `func' will be copied to the input of `cond'
   std::vector<int> oi_map;
@@ -520,6 +571,7 @@ class WhileLoopState : public LoopState {
         params(params),
         n_iterations(0U),
         cond_op(LoopState::MakeSharedOp(cond)),
+        static_cond_op(params.compiled ? LoopState::MakeStaticOp(cond) : nullptr),
         oi_map(params.func_var_locs.ndim(), -1) {
     const mxnet::Tuple<dim_t>& func_input_locs = params.func_input_locs;
     const mxnet::Tuple<dim_t>& func_var_locs   = params.func_var_locs;
@@ -536,6 +588,75 @@ class WhileLoopState : public LoopState {
   }
 };
 
+// The inference of a compiled while loop runs cond and func on the same arrays in every step.
+// The func of a step is pushed before waiting for its cond, so that the device runs it while
+// the host reads the cond; its outputs are dropped when the cond is false.
+static void WhileLoopStaticCompute(WhileLoopState* state,
+                                   const std::vector<NDArray>& inputs,
+                                   const std::vector<NDArray>& outputs) {
+  const NPXWhileLoopParam& params = state->params;
+  std::vector<NDArray> cond_inputs, cond_outputs(1);
+  std::vector<NDArray> func_inputs, func_outputs(outputs.size());
+  extract_by_loc(inputs, params.cond_input_locs, &cond_inputs);
+  extract_by_loc(inputs, params.func_input_locs, &func_inputs);
+  // The loop_vars get arrays of their own, which all the inputs taking them share.
+  std::vector<NDArray> loop_vars(params.func_var_locs.ndim());
+  for (size_t i = 0; i < loop_vars.size(); ++i) {
+    const dim_t loc     = params.func_input_locs[params.func_var_locs[i]];
+    const NDArray& init = inputs[loc];
+    loop_vars[i]        = NDArray(init.shape(), init.ctx(), false, init.dtype());
+    CopyFromTo(init, &loop_vars[i]);
+    for (size_t m = 0; m < func_inputs.size(); ++m) {
+      if (params.func_input_locs[m] == loc)
+        func_inputs[m] = loop_vars[i];
+    }
+    for (size_t m = 0; m < cond_inputs.size(); ++m) {
+      if (params.cond_input_locs[m] == loc)
+        cond_inputs[m] = loop_vars[i];
+    }
+  }
+  for (size_t& step = state->n_iterations = 0; step < (size_t)params.max_iterations; ++step) {
+    LoopState::RunStaticOp(state->static_cond_op, cond_inputs, &cond_outputs);
+    state->StaticForward(func_inputs, &func_outputs);
+    if (!as_bool_scalar(cond_outputs[0])) {
+      break;
+    }
+    for (int i = 0; i < params.num_out_data; ++i) {
+      if (step == 0) {
+        const mxnet::TShape& step_shape = func_outputs[i].shape();
+        mxnet::TShape shape(step_shape.ndim() + 1, 0);
+        shape[0] = params.max_iterations;
+        for (int j = 0; j < step_shape.ndim(); ++j) {
+          shape[j + 1] = step_shape[j];
+        }
+        const_cast<NDArray&>(outputs[i]).Init(shape);
+      }
+      NDArray slot = outputs[i].At(step);
+      mxnet::CopyFromTo(func_outputs[i], &slot);
+    }
+    for (size_t i = 0; i < loop_vars.size(); ++i) {
+      mxnet::CopyFromTo(func_outputs[params.num_out_data + i], &loop_vars[i]);
+    }
+  }
+  for (size_t i = 0; i < loop_vars.size(); ++i) {
+    const NDArray& output = outputs[params.num_out_data + i];
+    if (!shape_is_known(output.shape())) {
+      const_cast<NDArray&>(output).Init(loop_vars[i].shape());
+    }
+    mxnet::CopyFromTo(loop_vars[i], output);
+  }
+  for (int i = 0; i < params.num_out_data; ++i) {
+    const_cast<NDArray&>(outputs[i]).SetShapeFromChunk();
+  }
+  if (state->n_iterations == 0) {
+    for (const auto& output : outputs) {
+      if (!shape_is_known(output.shape())) {
+        const_cast<NDArray&>(output).ReshapeAndAlloc({1});
+      }
+    }
+  }
+}
+
 static void WhileLoopComputeExCPU(const OpStatePtr& state_ptr,
                                   const OpContext& ctx,
                                   const std::vector<NDArray>& inputs,
@@ -560,6 +681,10 @@ static void WhileLoopComputeExCPU(const OpStatePtr& state_ptr,
   CHECK_EQ(inputs.size(), (size_t)params.num_args);
   CHECK_EQ(outputs.size(), (size_t)params.num_outputs);
   CHECK_EQ(outputs.size(), req.size());
+  if (params.compiled && !ctx.need_grad) {
+    WhileLoopStaticCompute(&state, inputs, outputs);
+    return;
+  }
   // construct inputs and outputs for cond
   std::vector<NDArray> cond_inputs, cond_outputs = {NDArray()};
   extract_by_loc(inputs, params.cond_input_locs, &cond_inputs);
@@ -944,6 +1069,10 @@ static void CondComputeExCPU(const OpStatePtr& state_ptr,
   CHECK_EQ(inputs.size(), (size_t)params.num_args);
   CHECK_EQ(outputs.size(), (size_t)params.num_outputs);
   CHECK_EQ(outputs.size(), req.size());
+  if (params.compiled && !ctx.need_grad) {
+    WhileLoopStaticCompute(&state, inputs, outputs);
+    return;
+  }
   // construct inputs and outputs for cond
   std::vector<NDArray> cond_inputs;
   std::vector<NDArray> cond_outputs = {NDArray()};
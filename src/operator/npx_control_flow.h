@@ -42,6 +42,7 @@ struct NPXForeachParam : public dmlc::Parameter<NPXForeachParam> {
   mxnet::Tuple<dim_t> remain_locs;
   // The index mapping from out_states to in_states.
   mxnet::Tuple<dim_t> in_state_index;
+  bool compiled;
   DMLC_DECLARE_PARAMETER(NPXForeachParam) {
     DMLC_DECLARE_FIELD(num_args).set_lower_bound(1).describe("Number of inputs.");
     DMLC_DECLARE_FIELD(num_outputs).describe("The number of outputs of the subgraph.");
@@ -50,10 +51,13 @@ struct NPXForeachParam : public dmlc::Parameter<NPXForeachParam> {
     DMLC_DECLARE_FIELD(in_data_locs).describe("The locations of input data among the inputs.");
     DMLC_DECLARE_FIELD(remain_locs).describe("The locations of remaining data among the inputs.");
     DMLC_DECLARE_FIELD(in_state_index).describe("The index mapping from out_states to in_states.");
+    DMLC_DECLARE_FIELD(compiled).set_default(false).describe(
+        "Whether the inference runs the body on the same arrays in every iteration, "
+        "so that it is planned once and pushed as a whole.");
   }
   void SetAttrDict(std::unordered_map<std::string, std::string>* dict) {
     std::ostringstream num_args_s, num_outputs_s, num_out_data_s, in_state_locs_s, in_data_locs_s,
-        remain_locs_s, in_state_index_s;
+        remain_locs_s, in_state_index_s, compiled_s;
     num_args_s << num_args;
     num_outputs_s << num_outputs;
     num_out_data_s << num_out_data;
@@ -61,6 +65,7 @@ struct NPXForeachParam : public dmlc::Parameter<NPXForeachParam> {
     in_data_locs_s << in_data_locs;
     remain_locs_s << remain_locs;
     in_state_index_s << in_state_index;
+    compiled_s << compiled;
   }
 };  // struct NPXForeachParam
 
@@ -76,6 +81,7 @@ struct NPXWhileLoopParam : public dmlc::Parameter<NPXWhileLoopParam> {
   mxnet::Tuple<dim_t> cond_input_locs;
   mxnet::Tuple<dim_t> func_input_locs;
   mxnet::Tuple<dim_t> func_var_locs;
+  bool compiled;
   DMLC_DECLARE_PARAMETER(NPXWhileLoopParam) {
     DMLC_DECLARE_FIELD(num_args).set_lower_bound(2).describe(
         "Number of input arguments, including cond and func as two symbol inputs.");
@@ -91,10 +97,14 @@ struct NPXWhileLoopParam : public dmlc::Parameter<NPXWhileLoopParam> {
     DMLC_DECLARE_FIELD(func_input_locs)
         .describe("The locations of func's inputs in the given inputs.");
     DMLC_DECLARE_FIELD(func_var_locs).describe("The locations of loop_vars among func's inputs.");
+    DMLC_DECLARE_FIELD(compiled).set_default(false).describe(
+        "Whether the inference runs cond and func on the same arrays in every step, "
+        "so that they are planned once and pushed as a whole. The func of a step is pushed "
+        "before waiting for its cond, so it also runs once with the loop_vars ending the loop.");
   }
   void SetAttrDict(std::unordered_map<std::string, std::string>* dict) {
     std::ostringstream num_args_s, num_outputs_s, num_out_data_s, max_iterations_s,
-        cond_input_locs_s, func_input_locs_s, func_var_locs_s;
+        cond_input_locs_s, func_input_locs_s, func_var_locs_s, compiled_s;
     num_args_s << num_args;
     num_outputs_s << num_outputs;
     num_out_data_s << num_out_data;
@@ -102,6 +112,7 @@ struct NPXWhileLoopParam : public dmlc::Parameter<NPXWhileLoopParam> {
     cond_input_locs_s << cond_input_locs;
     func_input_locs_s << func_input_locs;
     func_var_locs_s << func_var_locs;
+    compiled_s << compiled;
   }
   template <typename T>
   bool sync_in_out(std::vector<T>* in,
@@ -25,6 +25,7 @@
 #define MXNET_OPERATOR_NUMPY_NP_BINCOUNT_OP_INL_H_
 
 #include <mxnet/operator_util.h>
+#include <algorithm>
 #include <utility>
 #include <vector>
 #include <string>
@@ -32,6 +33,7 @@
 #include "../mxnet_op.h"
 #include "../operator_common.h"
 #include "../elemwise_op_common.h"
+#include "../tensor/histogram-inl.h"
 #include "np_broadcast_reduce_op.h"
 
 namespace mxnet {
@@ -95,6 +97,16 @@ inline bool NumpyBincountStorageType(const nnvm::NodeAttrs& attrs,
   return true;
 }
 
+/*! \brief bin of an element of the nonnegative integers counted */
+template <typename DType>
+struct BincountBin {
+  const DType* data;
+
+  MSHADOW_XINLINE int operator()(index_t i) const {
+    return static_cast<int>(data[i]);
+  }
+};
+
 template <typename xpu>
 void NumpyBincountForwardImpl(const OpContext& ctx,
                               const NDArray& data,
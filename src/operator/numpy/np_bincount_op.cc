@@ -31,36 +31,23 @@ void BinNumberCount(const NDArray& data,
                     const int& minlength,
                     const NDArray& out,
                     const size_t& N) {
-  int bin = minlength;
+  const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  int64_t lowest = 0, highest = -1;
   MSHADOW_TYPE_SWITCH(data.dtype(), DType, {
-    DType* data_ptr = data.data().dptr<DType>();
-    for (size_t i = 0; i < N; i++) {
-      CHECK_GE(data_ptr[i], 0) << "input should be nonnegative number";
-      if (data_ptr[i] + 1 > bin) {
-        bin = data_ptr[i] + 1;
-      }
+    const DType* data_ptr = data.data().dptr<DType>();
+#pragma omp parallel for num_threads(omp_threads) reduction(min : lowest) reduction(max : highest)
+    for (index_t i = 0; i < static_cast<index_t>(N); i++) {
+      const int64_t value = static_cast<int64_t>(data_ptr[i]);
+      lowest              = std::min(lowest, value);
+      highest             = std::max(highest, value);
     }
-  });  // bin number = max(max(data) + 1, minlength)
-  mxnet::TShape s(1, bin);
+  });
+  CHECK_GE(lowest, 0) << "input should be nonnegative number";
+  // bin number = max(max(data) + 1, minlength)
+  mxnet::TShape s(1, std::max<int64_t>(highest + 1, minlength));
   const_cast<NDArray&>(out).Init(s);  // set the output shape forcefully
 }
 
-template <typename DType, typename OType>
-void BincountCpuWeights(const DType* data, const OType* weights, OType* out, const size_t& data_n) {
-  for (size_t i = 0; i < data_n; i++) {
-    int target = data[i];
-    out[target] += weights[i];
-  }
-}
-
-template <typename DType, typename OType>
-void BincountCpu(const DType* data, OType* out, const size_t& data_n) {
-  for (size_t i = 0; i < data_n; i++) {
-    int target = data[i];
-    out[target] += 1;
-  }
-}
-
 template <>
 void NumpyBincountForwardImpl<cpu>(const OpContext& ctx,
                                    const NDArray& data,
@@ -75,10 +62,12 @@ void NumpyBincountForwardImpl<cpu>(const OpContext& ctx,
     MSHADOW_TYPE_SWITCH(weights.dtype(), OType, {
       size_t out_size = out.shape()[0];
       Kernel<set_zero, cpu>::Launch(s, out_size, out.data().dptr<OType>());
-      BincountCpuWeights(data.data().dptr<DType>(),
-                         weights.data().dptr<OType>(),
-                         out.data().dptr<OType>(),
-                         data_n);
+      PrivatizedHistogram(s,
+                          data_n,
+                          out_size,
+                          out.data().dptr<OType>(),
+                          BincountBin<DType>{data.data().dptr<DType>()},
+                          HistogramArrayWeight<OType>{weights.data().dptr<OType>()});
     });
   });
 }
@@ -96,7 +85,12 @@ void NumpyBincountForwardImpl<cpu>(const OpContext& ctx,
     MSHADOW_TYPE_SWITCH(out.dtype(), OType, {
       size_t out_size = out.shape()[0];
       Kernel<set_zero, cpu>::Launch(s, out_size, out.data().dptr<OType>());
-      BincountCpu(data.data().dptr<DType>(), out.data().dptr<OType>(), data_n);
+      PrivatizedHistogram(s,
+                          data_n,
+                          out_size,
+                          out.data().dptr<OType>(),
+                          BincountBin<DType>{data.data().dptr<DType>()},
+                          HistogramUnitWeight<OType>());
     });
   });
 }
@@ -31,20 +31,6 @@
 namespace mxnet {
 namespace op {
 
-struct BincountFusedKernel {
-  template <typename DType, typename OType>
-  static MSHADOW_XINLINE void Map(int i, const DType* data, OType* out) {
-    int idx = data[i];
-    atomicAdd(&out[idx], 1);
-  }
-
-  template <typename DType, typename OType>
-  static MSHADOW_XINLINE void Map(int i, const DType* data, const OType* weights, OType* out) {
-    int idx = data[i];
-    atomicAdd(&out[idx], weights[i]);
-  }
-};
-
 struct is_valid_check {
   template <typename DType>
   MSHADOW_XINLINE static void Map(int i, char* invalid_ptr, const DType* data) {
@@ -111,11 +97,12 @@ void NumpyBincountForwardImpl<gpu>(const OpContext& ctx,
     MSHADOW_TYPE_SWITCH(weights.dtype(), OType, {
       size_t out_size = out.shape().Size();
       Kernel<set_zero, gpu>::Launch(s, out_size, out.data().dptr<OType>());
-      Kernel<BincountFusedKernel, gpu>::Launch(s,
-                                               data_n,
-                                               data.data().dptr<DType>(),
-                                               weights.data().dptr<OType>(),
-                                               out.data().dptr<OType>());
+      PrivatizedHistogram(s,
+                          data_n,
+                          out_size,
+                          out.data().dptr<OType>(),
+                          BincountBin<DType>{data.data().dptr<DType>()},
+                          HistogramArrayWeight<OType>{weights.data().dptr<OType>()});
     });
   });
 }
@@ -159,8 +146,12 @@ void NumpyBincountForwardImpl<gpu>(const OpContext& ctx,
     MSHADOW_TYPE_SWITCH(out.dtype(), OType, {
       size_t out_size = out.shape().Size();
       Kernel<set_zero, gpu>::Launch(s, out_size, out.data().dptr<OType>());
-      Kernel<BincountFusedKernel, gpu>::Launch(
-          s, data_n, data.data().dptr<DType>(), out.data().dptr<OType>());
+      PrivatizedHistogram(s,
+                          data_n,
+                          out_size,
+                          out.data().dptr<OType>(),
+                          BincountBin<DType>{data.data().dptr<DType>()},
+                          HistogramUnitWeight<OType>());
     });
   });
 }
@@ -46,9 +46,11 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <type_traits>
 #include "./np_tensordot_op-inl.h"
 #include "./np_einsum_path_op-inl.h"
 #include "../../common/static_array.h"
+#include "../linalg.h"
 #include "../mxnet_op.h"
 #include "../operator_common.h"
 #include "../mshadow_op.h"
@@ -760,6 +762,173 @@ inline void NumpyEinsumProcess(const std::vector<TBlob>& inputs,
   }
 }
 
+/*!
+ * \brief workspace of a batched GEMM step in elements, the inputs in the GEMM layout and in the
+ *  backward their gradients
+ */
+inline size_t BatchDotWorkspaceSize(const Step& step, bool backward) {
+  const size_t size = step.batch * step.rows * step.inner + step.batch * step.inner * step.cols;
+  return backward ? 2 * size : size;
+}
+
+inline bool BatchDotIdentityAxes(const TShape& axes) {
+  for (int j = 0; j < axes.ndim(); ++j) {
+    if (axes[j] != j) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename xpu, typename DType>
+inline void BatchDotGemm(const mshadow::Tensor<xpu, 3, DType>& A,
+                         const mshadow::Tensor<xpu, 3, DType>& B,
+                         mshadow::Tensor<xpu, 3, DType> C,
+                         const OpReqType req,
+                         bool tA,
+                         bool tB,
+                         mshadow::Stream<xpu>* s) {
+  if constexpr (std::is_same<DType, float>::value || std::is_same<DType, double>::value) {
+    if (C.shape_.Size() == 0) {
+      return;
+    }
+    if (A.shape_.Size() == 0) {
+      if (req == kWriteTo) {
+        C = DType(0);
+      }
+      return;
+    }
+    linalg_batch_gemm(A, B, C, DType(1), DType(req == kAddTo ? 1 : 0), tA, tB, s);
+  } else {
+    LOG(FATAL) << "einsum uses batched GEMM for float32 and float64 only";
+  }
+}
+
+/*!
+ * \brief an input of a batched GEMM step as a (batch, rows, cols) tensor, transposed into space
+ *  unless it is in the GEMM layout already
+ */
+template <typename xpu, typename DType>
+inline mshadow::Tensor<xpu, 3, DType> BatchDotOperand(const OpContext& ctx,
+                                                      const TBlob& operand,
+                                                      const TShape& axes,
+                                                      const mshadow::Shape<3>& shape,
+                                                      DType* space) {
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  if (BatchDotIdentityAxes(axes)) {
+    return operand.get_with_shape<xpu, 3, DType>(shape, s);
+  }
+  TShape tshape(axes.ndim(), -1);
+  for (int j = 0; j < axes.ndim(); ++j) {
+    tshape[j] = operand.shape_[axes[j]];
+  }
+  TransposeImpl<xpu>(ctx.run_ctx, operand, TBlob(space, tshape, xpu::kDevMask), axes);
+  return mshadow::Tensor<xpu, 3, DType>(space, shape, s);
+}
+
+/*!
+ * \brief the gradient of an input of a batched GEMM step, computed directly when the input is in
+ *  the GEMM layout and otherwise in space and transposed back
+ */
+template <typename xpu, typename DType>
+inline void BatchDotOperandGrad(const OpContext& ctx,
+                                const mshadow::Tensor<xpu, 3, DType>& A,
+                                const mshadow::Tensor<xpu, 3, DType>& B,
+                                bool tA,
+                                bool tB,
+                                const TShape& axes,
+                                const mshadow::Shape<3>& shape,
+                                const TBlob& grad,
+                                const OpReqType req,
+                                DType* space) {
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  if (req == kNullOp) {
+    return;
+  }
+  if (BatchDotIdentityAxes(axes)) {
+    BatchDotGemm(A, B, grad.get_with_shape<xpu, 3, DType>(shape, s), req, tA, tB, s);
+    return;
+  }
+  BatchDotGemm(A, B, mshadow::Tensor<xpu, 3, DType>(space, shape, s), kWriteTo, tA, tB, s);
+  TShape tshape(axes.ndim(), -1), inverse(axes.ndim(), -1);
+  for (int j = 0; j < axes.ndim(); ++j) {
+    tshape[j]        = grad.shape_[axes[j]];
+    inverse[axes[j]] = j;
+  }
+  if (req == kAddTo) {
+    TransposeImpl<xpu, true>(ctx.run_ctx, TBlob(space, tshape, xpu::kDevMask), grad, inverse);
+  } else {
+    TransposeImpl<xpu>(ctx.run_ctx, TBlob(space, tshape, xpu::kDevMask), grad, inverse);
+  }
+}
+
+/*!
+ * \brief a pairwise contraction with batch indices as out[b] = left[b] * right[b], with left and
+ *  right transposed to (batch, rows, inner) and (batch, inner, cols)
+ */
+template <typename xpu, typename DType>
+inline void BatchDotForward(const OpContext& ctx,
+                            const Step& step,
+                            const TBlob& left,
+                            const TBlob& right,
+                            const TBlob& out,
+                            const OpReqType req,
+                            DType* space) {
+  using namespace mshadow;
+  if (req == kNullOp) {
+    return;
+  }
+  Stream<xpu>* s = ctx.get_stream<xpu>();
+  const Shape<3> left_shape  = Shape3(step.batch, step.rows, step.inner);
+  const Shape<3> right_shape = Shape3(step.batch, step.inner, step.cols);
+  Tensor<xpu, 3, DType> A    = BatchDotOperand<xpu>(ctx, left, step.left_axes, left_shape, space);
+  Tensor<xpu, 3, DType> B =
+      BatchDotOperand<xpu>(ctx, right, step.right_axes, right_shape, space + left_shape.Size());
+  BatchDotGemm(A,
+               B,
+               out.get_with_shape<xpu, 3, DType>(Shape3(step.batch, step.rows, step.cols), s),
+               req,
+               false,
+               false,
+               s);
+}
+
+template <typename xpu, typename DType>
+inline void BatchDotBackward(const OpContext& ctx,
+                             const Step& step,
+                             const TBlob& out_grad,
+                             const TBlob& left,
+                             const TBlob& right,
+                             const TBlob& left_grad,
+                             const TBlob& right_grad,
+                             const std::vector<OpReqType>& req,
+                             DType* space) {
+  using namespace mshadow;
+  Stream<xpu>* s = ctx.get_stream<xpu>();
+  const Shape<3> left_shape  = Shape3(step.batch, step.rows, step.inner);
+  const Shape<3> right_shape = Shape3(step.batch, step.inner, step.cols);
+  DType* right_space         = space + left_shape.Size();
+  DType* grad_space          = right_space + right_shape.Size();
+  Tensor<xpu, 3, DType> A    = BatchDotOperand<xpu>(ctx, left, step.left_axes, left_shape, space);
+  Tensor<xpu, 3, DType> B =
+      BatchDotOperand<xpu>(ctx, right, step.right_axes, right_shape, right_space);
+  Tensor<xpu, 3, DType> dC =
+      out_grad.get_with_shape<xpu, 3, DType>(Shape3(step.batch, step.rows, step.cols), s);
+  // dA = dC * B^T, dB = A^T * dC
+  BatchDotOperandGrad(
+      ctx, dC, B, false, true, step.left_axes, left_shape, left_grad, req[0], grad_space);
+  BatchDotOperandGrad(ctx,
+                      A,
+                      dC,
+                      true,
+                      false,
+                      step.right_axes,
+                      right_shape,
+                      right_grad,
+                      req[1],
+                      grad_space + left_shape.Size());
+}
+
 template <typename xpu>
 inline void NumpyEinsumForward(const OpStatePtr& state_ptr,
                                const OpContext& ctx,
@@ -780,10 +949,8 @@ inline void NumpyEinsumForward(const OpStatePtr& state_ptr,
     return;
   }
   std::vector<Step>& paths = state.paths;
-  std::vector<std::vector<int> > pos;
-  std::string string_repr;
-  paths         = einsum_path(state.subscripts, inputs, true, ctx.run_ctx, &pos, &string_repr);
-  int paths_len = paths.size();
+  paths                    = einsum_path_cached(state.subscripts, inputs, ctx.run_ctx);
+  int paths_len            = paths.size();
   size_t temp_space_size = 0, max_temp_space_size = 0;
   std::vector<TBlob> operands(inputs), tmp_operands, temp_space_vec(paths_len - 1);
   for (int i = 0; i + 1 < paths_len; ++i) {
@@ -794,8 +961,13 @@ inline void NumpyEinsumForward(const OpStatePtr& state_ptr,
   }
   temp_space_size += max_temp_space_size;
   MSHADOW_TYPE_SWITCH(outputs[0].type_flag_, DType, {
-    state.tempspace.reset<NDArray>(new NDArray(
-        TShape(Shape1(temp_space_size)), ctx.run_ctx.ctx, false, outputs[0].type_flag_));
+    // the intermediate results are kept for the backward, reuse their buffer across calls
+    if (state.tempspace == nullptr || state.tempspace->ctx() != ctx.run_ctx.ctx ||
+        state.tempspace->dtype() != outputs[0].type_flag_ ||
+        state.tempspace->shape().Size() < temp_space_size) {
+      state.tempspace.reset<NDArray>(new NDArray(
+          TShape(Shape1(temp_space_size)), ctx.run_ctx.ctx, false, outputs[0].type_flag_));
+    }
     Tensor<xpu, 1, DType> temp_space = state.tempspace->data().FlatTo1D<xpu, DType>();
     size_t begin                     = max_temp_space_size;
     for (int i = 0; i < paths_len - 1; ++i) {
@@ -861,6 +1033,35 @@ inline void NumpyEinsumForward(const OpStatePtr& state_ptr,
                              std::vector<OpReqType>{OpReqType::kWriteTo},
                              tensordot_tempspace);
         }
+      } else if (paths[i].do_batch_blas) {
+        Tensor<xpu, 1, DType> batch_dot_tempspace =
+            ctx.requested[0].get_space_typed<xpu, 1, DType>(
+                Shape1(BatchDotWorkspaceSize(paths[i], false)), s);
+        if (paths[i].do_einsum) {
+          TBlob max_temp_space = TBlob(temp_space.Slice(0, paths[i].tshape.Size()));
+          max_temp_space       = max_temp_space.reshape(paths[i].tshape);
+          BatchDotForward<xpu>(ctx,
+                               paths[i],
+                               tmp_operands[0],
+                               tmp_operands[1],
+                               max_temp_space,
+                               OpReqType::kWriteTo,
+                               batch_dot_tempspace.dptr_);
+          NumpyEinsumProcess<xpu, 0>(std::vector<TBlob>{max_temp_space},
+                                     handle_out ? req : std::vector<OpReqType>{OpReqType::kWriteTo},
+                                     handle_out ? outputs : std::vector<TBlob>{temp_space_vec[i]},
+                                     paths[i].blas2einsum_str.c_str(),
+                                     1,
+                                     ctx);
+        } else {
+          BatchDotForward<xpu>(ctx,
+                               paths[i],
+                               tmp_operands[0],
+                               tmp_operands[1],
+                               handle_out ? outputs[0] : temp_space_vec[i],
+                               handle_out ? req[0] : OpReqType::kWriteTo,
+                               batch_dot_tempspace.dptr_);
+        }
       } else {
         NumpyEinsumProcess<xpu, 0>(tmp_operands,
                                    handle_out ? req : std::vector<OpReqType>{OpReqType::kWriteTo},
@@ -978,6 +1179,8 @@ inline void NumpyEinsumBackward(const OpStatePtr& state_ptr,
                                                                              temp_outputs[1],
                                                                              temp_req);
         }
+      } else if (paths[i].do_batch_blas) {
+        cur_tensordot_tempspace_size = BatchDotWorkspaceSize(paths[i], true) * sizeof(DType);
       }
       tensordot_tempspace_size.push_back(cur_tensordot_tempspace_size);
       tensordot_max_tempspace_size =
@@ -1073,6 +1276,30 @@ inline void NumpyEinsumBackward(const OpStatePtr& state_ptr,
                                      temp_req,
                                      char_tempspace);
         }
+      } else if (paths[i].do_batch_blas) {
+        CHECK_EQ(temp_inputs.size(), 3U);
+        CHECK_EQ(temp_outputs.size(), 2U);
+        DType* batch_dot_tempspace = temp_space.dptr_ + begin_tensordot_tempspace;
+        TBlob out_grad             = temp_inputs[0];
+        if (paths[i].do_einsum) {
+          out_grad = TBlob(temp_space.Slice(0, paths[i].tshape.Size()));
+          out_grad = out_grad.reshape(paths[i].tshape);
+          NumpyEinsumProcess<xpu, 0>(std::vector<TBlob>{temp_inputs[0]},
+                                     std::vector<OpReqType>{kWriteTo},
+                                     std::vector<TBlob>{out_grad},
+                                     paths[i].einsum2blas_str.c_str(),
+                                     1,
+                                     ctx);
+        }
+        BatchDotBackward<xpu>(ctx,
+                              paths[i],
+                              out_grad,
+                              temp_inputs[1],
+                              temp_inputs[2],
+                              temp_outputs[0],
+                              temp_outputs[1],
+                              temp_req,
+                              batch_dot_tempspace);
       } else {
         NumpyEinsumProcess<xpu, 1>(temp_inputs,
                                    temp_req,
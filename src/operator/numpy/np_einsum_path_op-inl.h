@@ -42,7 +42,9 @@
 #include <mxnet/operator_util.h>
 #include <functional>
 #include <algorithm>
+#include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <bitset>
 
@@ -71,9 +73,12 @@ struct Step {
   std::bitset<MAXAXIS> idx_removed;
   std::string einsum_str, blas2einsum_str, einsum2blas_str;
   std::vector<std::string> input_list;
-  bool do_blas, do_cutensor, do_einsum;
+  bool do_blas, do_cutensor, do_einsum, do_batch_blas;
   TShape oshape, tshape;
   Tuple<int> left_pos, right_pos;
+  // batched GEMM: the transposes of the inputs to (batch, rows, inner) and (batch, inner, cols)
+  TShape left_axes, right_axes;
+  dim_t batch, rows, inner, cols;
 };
 
 inline size_t _compute_size_by_dict(const std::string& indices, const dim_t idx_dict[]) {
@@ -435,6 +440,53 @@ inline bool _can_dot(const std::vector<std::string>& inputs,
   return true;
 }
 
+inline bool _can_batch_dot(const std::vector<std::string>& inputs,
+                           const std::bitset<MAXAXIS>& result,
+                           const std::bitset<MAXAXIS>& idx_removed) {
+  // Only contractions of two operands that remove indices
+  if (!idx_removed.any() || inputs.size() != 2) {
+    return false;
+  }
+
+  const std::string& input_left  = inputs[0];
+  const std::string& input_right = inputs[1];
+
+  // The inputs are brought to the GEMM layout with TransposeImpl
+  if (input_left.size() == 0 || input_right.size() == 0 || input_left.size() > 6 ||
+      input_right.size() > 6) {
+    return false;
+  }
+
+  bool has_batch = false;
+  for (int i = 0; i < 2; ++i) {
+    for (const char& c : inputs[i]) {
+      size_t nl = std::count(input_left.begin(), input_left.end(), c);
+      size_t nr = std::count(input_right.begin(), input_right.end(), c);
+      // can't take diagonals
+      if (nl > 1 || nr > 1) {
+        return false;
+      }
+      // can't do implicit summation over the indices of one operand
+      if (nl + nr == 1 && !result.test(c)) {
+        return false;
+      }
+      // an index of both operands that is kept is a batch index, which `dot` can't handle
+      if (nl + nr == 2 && result.test(c)) {
+        has_batch = true;
+      }
+    }
+  }
+  return has_batch;
+}
+
+inline TShape _transpose_axes(const std::string& src, const std::string& dst) {
+  TShape axes(dst.length(), -1);
+  for (size_t j = 0; j < dst.length(); ++j) {
+    axes[j] = src.find(dst[j]);
+  }
+  return axes;
+}
+
 #if MXNET_USE_CUTENSOR == 1
 inline bool check_cutensor_indices(const std::string& indices,
                                    const TShape& shape,
@@ -713,6 +765,10 @@ inline bool _tensordot_type_check(int type_flag_, const RunContext& run_ctx) {
          (type_flag_ == kFloat16 && run_ctx.ctx.dev_mask() == mshadow::gpu::kDevMask);
 }
 
+inline bool _batch_dot_type_check(int type_flag_) {
+  return type_flag_ == kFloat32 || type_flag_ == kFloat64;
+}
+
 inline std::vector<Step> einsum_path(const std::string& subscripts,
                                      const std::vector<TBlob>& operands,
                                      bool optimize,
@@ -887,6 +943,55 @@ inline std::vector<Step> einsum_path(const std::string& subscripts,
     }
 #endif
 
+    // Batch indices rule out tensordot, the contraction can still be a batched GEMM
+    bool do_batch_blas = false;
+    if (!do_blas && _batch_dot_type_check(operands[0].type_flag_)) {
+      do_batch_blas = _can_batch_dot(tmp_inputs, contract.new_result, contract.idx_removed);
+      for (int c = 0; c < MAXAXIS && do_batch_blas; ++c) {
+        if (bcast.test(c) && dimension_dict[c] != 1) {
+          do_batch_blas = false;
+        }
+      }
+    }
+
+    if (do_batch_blas) {
+      std::string batch_idx, row_idx, inner_idx, col_idx;
+      for (const char& c : tmp_inputs[0]) {
+        if (contract.idx_removed.test(static_cast<int>(c))) {
+          inner_idx += c;
+        } else if (tmp_inputs[1].find(c) != std::string::npos) {
+          batch_idx += c;
+        } else {
+          row_idx += c;
+        }
+      }
+      for (const char& c : tmp_inputs[1]) {
+        if (tmp_inputs[0].find(c) == std::string::npos) {
+          col_idx += c;
+        }
+      }
+      std::string tensor_result = batch_idx + row_idx + col_idx;
+      ret[i].left_axes          = _transpose_axes(tmp_inputs[0], batch_idx + row_idx + inner_idx);
+      ret[i].right_axes         = _transpose_axes(tmp_inputs[1], batch_idx + inner_idx + col_idx);
+      ret[i].batch              = _compute_size_by_dict(batch_idx, dimension_dict);
+      ret[i].rows               = _compute_size_by_dict(row_idx, dimension_dict);
+      ret[i].inner              = _compute_size_by_dict(inner_idx, dimension_dict);
+      ret[i].cols               = _compute_size_by_dict(col_idx, dimension_dict);
+      // Calculate do_einsum
+      ret[i].do_einsum = (tensor_result != idx_result);
+      // Calculate tshape
+      CHECK_EQ(static_cast<int>(tensor_result.length()), len_idx_result)
+          << "batched GEMM produces dim " << tensor_result.length()
+          << ", while einsum produces dim " << len_idx_result << ".";
+      ret[i].tshape = TShape(len_idx_result, -1);
+      for (int j = 0; j < len_idx_result; ++j) {
+        ret[i].tshape[j] = dimension_dict[static_cast<int>(tensor_result[j])];
+      }
+      // Calculate blas2einsum_str
+      ret[i].blas2einsum_str = tensor_result + "->" + idx_result;
+      ret[i].einsum2blas_str = idx_result + "->" + tensor_result;
+    }
+
     if (do_blas) {
       CHECK_EQ(tmp_inputs.size(), 2U) << "BLAS accepts exactly 2 inputs";
       std::string tensor_result = tmp_inputs[0] + tmp_inputs[1];
@@ -946,6 +1051,7 @@ inline std::vector<Step> einsum_path(const std::string& subscripts,
     ret[i].idx_removed   = contract.idx_removed;
     ret[i].input_list    = input_list;
     ret[i].do_blas       = do_blas;
+    ret[i].do_batch_blas = do_batch_blas;
   }
 
   if (ret_path == nullptr || ret_string_repr == nullptr) {
@@ -992,6 +1098,36 @@ inline std::vector<Step> einsum_path(const std::string& subscripts,
   return ret;
 }
 
+/*!
+ * \brief the optimized path of einsum, memoized by the subscripts and the shapes, type and device
+ *  of the operands so that a contraction repeated over iterations skips the path search.
+ *  Each thread keeps up to MXNET_EINSUM_PATH_CACHE_SIZE paths.
+ */
+inline std::vector<Step> einsum_path_cached(const std::string& subscripts,
+                                            const std::vector<TBlob>& operands,
+                                            const RunContext& run_ctx) {
+  static thread_local std::unordered_map<std::string, std::vector<Step> > cache;
+  static const size_t cache_size = dmlc::GetEnv("MXNET_EINSUM_PATH_CACHE_SIZE", 1024);
+  if (cache_size == 0) {
+    return einsum_path(subscripts, operands, true, run_ctx, nullptr, nullptr);
+  }
+  std::ostringstream os;
+  os << subscripts << ';' << run_ctx.ctx.dev_mask() << ';' << operands[0].type_flag_;
+  for (const TBlob& operand : operands) {
+    os << ';' << operand.shape_;
+  }
+  const std::string key = os.str();
+  auto it               = cache.find(key);
+  if (it == cache.end()) {
+    if (cache.size() >= cache_size) {
+      cache.clear();
+    }
+    it = cache.emplace(key, einsum_path(subscripts, operands, true, run_ctx, nullptr, nullptr))
+             .first;
+  }
+  return it->second;
+}
+
 }  // namespace op
 }  // namespace mxnet
 
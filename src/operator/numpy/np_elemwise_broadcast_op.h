@@ -268,33 +268,26 @@ void MixedAllRealBinaryBroadcastCompute(const std::string& op_name,
   Stream<xpu>* s = ctx.get_stream<xpu>();
 
   BROADCAST_NDIM_SWITCH(ndim, NDim, {
-    mshadow::Shape<NDim> oshape  = new_oshape.get<NDim>();
-    mshadow::Shape<NDim> lstride = mxnet_op::calc_stride(new_lshape.get<NDim>());
-    mshadow::Shape<NDim> rstride = mxnet_op::calc_stride(new_rshape.get<NDim>());
     switch (lhs.type_flag_) {
       case mshadow::kFloat32: {
         if (rhs.type_flag_ == mshadow::kFloat16) {
-          mxnet_op::Kernel<mxnet_op::binary_broadcast_kernel<NDim, OP>, xpu>::template LaunchEx(
-              s,
-              new_oshape.Size(),
-              req,
-              rstride,
-              lstride,
-              oshape,
-              rhs.dptr<mshadow::half::half_t>(),
-              lhs.dptr<float>(),
-              out.dptr<float>());
+          broadcast::BinaryBroadcastLaunch<NDim, OP>(s,
+                                                     req,
+                                                     new_rshape,
+                                                     new_lshape,
+                                                     new_oshape,
+                                                     rhs.dptr<mshadow::half::half_t>(),
+                                                     lhs.dptr<float>(),
+                                                     out.dptr<float>());
         } else if (rhs.type_flag_ == mshadow::kBfloat16) {
-          mxnet_op::Kernel<mxnet_op::binary_broadcast_kernel<NDim, OP>, xpu>::template LaunchEx(
-              s,
-              new_oshape.Size(),
-              req,
-              rstride,
-              lstride,
-              oshape,
-              rhs.dptr<mshadow::bfloat::bf16_t>(),
-              lhs.dptr<float>(),
-              out.dptr<float>());
+          broadcast::BinaryBroadcastLaunch<NDim, OP>(s,
+                                                     req,
+                                                     new_rshape,
+                                                     new_lshape,
+                                                     new_oshape,
+                                                     rhs.dptr<mshadow::bfloat::bf16_t>(),
+                                                     lhs.dptr<float>(),
+                                                     out.dptr<float>());
         } else {
           PrintErrorMessage(op_name, lhs.type_flag_, rhs.type_flag_);
         }
@@ -302,38 +295,32 @@ void MixedAllRealBinaryBroadcastCompute(const std::string& op_name,
       }
       case mshadow::kFloat64: {
         if (rhs.type_flag_ == mshadow::kFloat16) {
-          mxnet_op::Kernel<mxnet_op::binary_broadcast_kernel<NDim, OP>, xpu>::template LaunchEx(
-              s,
-              new_oshape.Size(),
-              req,
-              rstride,
-              lstride,
-              oshape,
-              rhs.dptr<mshadow::half::half_t>(),
-              lhs.dptr<double>(),
-              out.dptr<double>());
+          broadcast::BinaryBroadcastLaunch<NDim, OP>(s,
+                                                     req,
+                                                     new_rshape,
+                                                     new_lshape,
+                                                     new_oshape,
+                                                     rhs.dptr<mshadow::half::half_t>(),
+                                                     lhs.dptr<double>(),
+                                                     out.dptr<double>());
         } else if (rhs.type_flag_ == mshadow::kBfloat16) {
-          mxnet_op::Kernel<mxnet_op::binary_broadcast_kernel<NDim, OP>, xpu>::template LaunchEx(
-              s,
-              new_oshape.Size(),
-              req,
-              rstride,
-              lstride,
-              oshape,
-              rhs.dptr<mshadow::bfloat::bf16_t>(),
-              lhs.dptr<double>(),
-              out.dptr<double>());
+          broadcast::BinaryBroadcastLaunch<NDim, OP>(s,
+                                                     req,
+                                                     new_rshape,
+                                                     new_lshape,
+                                                     new_oshape,
+                                                     rhs.dptr<mshadow::bfloat::bf16_t>(),
+                                                     lhs.dptr<double>(),
+                                                     out.dptr<double>());
         } else if (rhs.type_flag_ == mshadow::kFloat32) {
-          mxnet_op::Kernel<mxnet_op::binary_broadcast_kernel<NDim, OP>, xpu>::template LaunchEx(
-              s,
-              new_oshape.Size(),
-              req,
-              rstride,
-              lstride,
-              oshape,
-              rhs.dptr<float>(),
-              lhs.dptr<double>(),
-              out.dptr<double>());
+          broadcast::BinaryBroadcastLaunch<NDim, OP>(s,
+                                                     req,
+                                                     new_rshape,
+                                                     new_lshape,
+                                                     new_oshape,
+                                                     rhs.dptr<float>(),
+                                                     lhs.dptr<double>(),
+                                                     out.dptr<double>());
         } else {
           PrintErrorMessage(op_name, lhs.type_flag_, rhs.type_flag_);
         }
@@ -381,37 +368,30 @@ void MixedBinaryBroadcastCompute(const nnvm::NodeAttrs& attrs,
       CHECK(lhs.type_flag_ == out.type_flag_ || rhs.type_flag_ == out.type_flag_)
           << "One of the input type should be the same as the output";
       BROADCAST_NDIM_SWITCH(ndim, NDim, {
-        mshadow::Shape<NDim> oshape  = new_oshape.get<NDim>();
-        mshadow::Shape<NDim> lstride = mxnet_op::calc_stride(new_lshape.get<NDim>());
-        mshadow::Shape<NDim> rstride = mxnet_op::calc_stride(new_rshape.get<NDim>());
         if (lhs.type_flag_ == out.type_flag_) {
           MSHADOW_REAL_TYPE_SWITCH(out.type_flag_, LType, {
             MXNET_INT_TYPE_SWITCH_EXT_WITH_BOOL(rhs.type_flag_, RType, {
-              mxnet_op::Kernel<mxnet_op::binary_broadcast_kernel<NDim, ROP>,
-                               xpu>::template LaunchEx(s,
-                                                       new_oshape.Size(),
-                                                       req[0],
-                                                       rstride,
-                                                       lstride,
-                                                       oshape,
-                                                       rhs.dptr<RType>(),
-                                                       lhs.dptr<LType>(),
-                                                       out.dptr<LType>());
+              broadcast::BinaryBroadcastLaunch<NDim, ROP>(s,
+                                                          req[0],
+                                                          new_rshape,
+                                                          new_lshape,
+                                                          new_oshape,
+                                                          rhs.dptr<RType>(),
+                                                          lhs.dptr<LType>(),
+                                                          out.dptr<LType>());
             });
           });
         } else {
           MSHADOW_REAL_TYPE_SWITCH(out.type_flag_, RType, {
             MXNET_INT_TYPE_SWITCH_EXT_WITH_BOOL(lhs.type_flag_, LType, {
-              mxnet_op::Kernel<mxnet_op::binary_broadcast_kernel<NDim, LOP>,
-                               xpu>::template LaunchEx(s,
-                                                       new_oshape.Size(),
-                                                       req[0],
-                                                       lstride,
-                                                       rstride,
-                                                       oshape,
-                                                       lhs.dptr<LType>(),
-                                                       rhs.dptr<RType>(),
-                                                       out.dptr<RType>());
+              broadcast::BinaryBroadcastLaunch<NDim, LOP>(s,
+                                                          req[0],
+                                                          new_lshape,
+                                                          new_rshape,
+                                                          new_oshape,
+                                                          lhs.dptr<LType>(),
+                                                          rhs.dptr<RType>(),
+                                                          out.dptr<RType>());
             });
           });
         }
@@ -977,6 +957,7 @@ inline bool NumpyBinaryMixedPrecisionType(const nnvm::NodeAttrs& attrs,
           [](const NodeAttrs& attrs) { return std::vector<std::string>{"output"}; })              \
       .set_attr<mxnet::FInferShape>("FInferShape", BinaryBroadcastShape)                          \
       .set_attr<nnvm::FInferType>("FInferType", NumpyBinaryMixedPrecisionType)                    \
+      .set_attr<mxnet::alm::FChangeLayout>("FChangeLayout", BroadcastChangeLayout)                \
       .set_attr<nnvm::FInplaceOption>("FInplaceOption",                                           \
                                       [](const NodeAttrs& attrs) {                                \
                                         return std::vector<std::pair<int, int> >{{0, 0}, {1, 0}}; \
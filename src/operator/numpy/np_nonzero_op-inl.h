@@ -37,6 +37,7 @@
 #include "../tensor/init_op.h"
 #include "../mshadow_op.h"
 #include "../elemwise_op_common.h"
+#include "../contrib/boolean_mask-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -77,6 +78,35 @@ struct NonzeroForwardKernelGPU {
   }
 };
 
+inline bool NonzeroPaddedShape(const nnvm::NodeAttrs& attrs,
+                               mxnet::ShapeVector* in_attrs,
+                               mxnet::ShapeVector* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 1U);
+  CHECK_EQ(out_attrs->size(), 2U);
+  SHAPE_ASSIGN_CHECK(*out_attrs, 1, mxnet::TShape(1, 1));
+  const mxnet::TShape& in = in_attrs->at(0);
+  if (!shape_is_known(in))
+    return false;
+  CHECK_LE(in.ndim(), 5) << "ndim of input cannot larger than 5";
+  // a scalar has one index of one dimension, as in the unpadded nonzero
+  mxnet::TShape out(2, std::max(in.ndim(), 1));
+  out[0] = in.Size();
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, out);
+  return true;
+}
+
+/*!
+ * \brief The padded nonzero writes the indices of the non-zero elements into an output of one
+ *  row per element of the input, followed by zeros, and the number of non-zero elements into
+ *  a second output on the device, so that it does not wait for the input to size its output.
+ */
+template <typename xpu>
+void NonzeroPaddedForward(const nnvm::NodeAttrs& attrs,
+                          const OpContext& ctx,
+                          const std::vector<TBlob>& inputs,
+                          const std::vector<OpReqType>& req,
+                          const std::vector<TBlob>& outputs);
+
 }  // namespace op
 }  // namespace mxnet
 
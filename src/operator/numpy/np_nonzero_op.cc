@@ -110,6 +110,49 @@ void NonzeroForwardCPU(const nnvm::NodeAttrs& attrs,
   })
 }
 
+bool NonzeroPaddedType(const nnvm::NodeAttrs& attrs,
+                       std::vector<int>* in_attrs,
+                       std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 1);
+  CHECK_EQ(out_attrs->size(), 2);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, mshadow::kInt64);
+  TYPE_ASSIGN_CHECK(*out_attrs, 1, mshadow::kInt64);
+  return in_attrs->at(0) != -1;
+}
+
+template <>
+void NonzeroPaddedForward<cpu>(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  CHECK_EQ(inputs.size(), 1U);
+  CHECK_EQ(outputs.size(), 2U);
+  const TBlob& in              = inputs[0];
+  const TBlob& out             = outputs[0];
+  mshadow::Stream<cpu>* stream = ctx.get_stream<cpu>();
+  size_t in_size               = in.shape_.Size();
+  mxnet_op::Kernel<mxnet_op::set_zero, cpu>::Launch(stream, out.Size(), out.dptr<int64_t>());
+  std::vector<index_t> prefix_sum(in_size, 0);
+  size_t valid_num = 0;
+  MSHADOW_TYPE_SWITCH_WITH_BOOL(in.type_flag_, DType, {
+    const DType* in_dptr = in.dptr<DType>();
+    for (size_t i = 0; i < in_size; i++) {
+      valid_num += (in_dptr[i] != 0);
+      prefix_sum[i] = valid_num;
+    }
+  });
+  *outputs[1].dptr<int64_t>() = valid_num;
+  // the index of a scalar is 0
+  if (0 == in.shape_.ndim() || 0 == valid_num)
+    return;
+  MXNET_NDIM_SWITCH(in.shape_.ndim(), ndim, {
+    mshadow::Shape<ndim> shape = in.shape_.get<ndim>();
+    mxnet_op::Kernel<NonzeroForwardKernel, cpu>::Launch(
+        stream, in_size, out.dptr<int64_t>(), prefix_sum.data(), shape);
+  })
+}
+
 NNVM_REGISTER_OP(_npx_nonzero)
     .add_alias("_npi_nonzero")
     .set_num_inputs(1)
@@ -124,5 +167,29 @@ NNVM_REGISTER_OP(_npx_nonzero)
     .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
     .add_argument("x", "NDArray-or-Symbol", "The input array.");
 
+NNVM_REGISTER_OP(_npx_nonzero_padded)
+    .describe(R"code(Return the indices of the non-zero elements of x, like nonzero, into an
+output of x.size rows of x.ndim indices followed by zeros, and the number of non-zero elements
+as a second output of shape (1,).
+
+Since the shapes of its outputs do not depend on the values of x, the operator does not wait
+for x to be computed, and may be hybridized with static shapes and captured in CUDA graphs.
+)code" ADD_FILELINE)
+    .set_num_inputs(1)
+    .set_num_outputs(2)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"x"};
+                                     })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output", "valid_num"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape", NonzeroPaddedShape)
+    .set_attr<nnvm::FInferType>("FInferType", NonzeroPaddedType)
+    .set_attr<FCompute>("FCompute<cpu>", NonzeroPaddedForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .add_argument("x", "NDArray-or-Symbol", "The input array.");
+
 }  // namespace op
 }  // namespace mxnet
@@ -110,6 +110,34 @@ void NonzeroForwardGPU(const nnvm::NodeAttrs& attrs,
   })
 }
 
+template <>
+void NonzeroPaddedForward<gpu>(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  CHECK_EQ(inputs.size(), 1U);
+  CHECK_EQ(outputs.size(), 2U);
+  const TBlob& in     = inputs[0];
+  const TBlob& out    = outputs[0];
+  Stream<gpu>* stream = ctx.get_stream<gpu>();
+  size_t in_size      = in.shape_.Size();
+  mxnet_op::Kernel<mxnet_op::set_zero, gpu>::Launch(stream, out.Size(), out.dptr<int64_t>());
+  // the number of non-zero elements stays on the device
+  const int32_t* prefix_sum = MaskPrefixSumGPU(ctx, in);
+  mxnet_op::Kernel<MaskValidNumKernel, gpu>::Launch(
+      stream, 1, outputs[1].dptr<int64_t>(), prefix_sum, in_size);
+  // the index of a scalar is 0
+  if (0 == in.shape_.ndim() || 0 == in_size)
+    return;
+  MXNET_NDIM_SWITCH(in.shape_.ndim(), ndim, {
+    mshadow::Shape<ndim> shape = in.shape_.get<ndim>();
+    mxnet_op::Kernel<NonzeroForwardKernelGPU, gpu>::Launch(
+        stream, in_size, out.dptr<int64_t>(), prefix_sum, shape);
+  })
+}
+
 NNVM_REGISTER_OP(_npx_nonzero)
     .set_attr<FResourceRequest>("FResourceRequest",
                                 [](const NodeAttrs& attrs) {
@@ -119,5 +147,12 @@ NNVM_REGISTER_OP(_npx_nonzero)
                                        [](const NodeAttrs& attrs, const bool) { return false; })
     .set_attr<FComputeEx>("FComputeEx<gpu>", NonzeroForwardGPU);
 
+NNVM_REGISTER_OP(_npx_nonzero_padded)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<gpu>", NonzeroPaddedForward<gpu>);
+
 }  // namespace op
 }  // namespace mxnet
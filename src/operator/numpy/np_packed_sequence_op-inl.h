@@ -0,0 +1,782 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file np_packed_sequence_op-inl.h
+ * \brief Operators on packed batches of variable-length sequences. A packed batch stores the
+ *        tokens of every sequence back to back in a (total_tokens, ...) array, together with the
+ *        (batch_size + 1,) cumulative offsets at which each sequence starts, so that no work is
+ *        spent on padding. Token-wise operators such as Embedding, LayerNorm and FullyConnected
+ *        apply to the packed values as they are.
+ */
+#ifndef MXNET_OPERATOR_NUMPY_NP_PACKED_SEQUENCE_OP_INL_H_
+#define MXNET_OPERATOR_NUMPY_NP_PACKED_SEQUENCE_OP_INL_H_
+
+#include <dmlc/logging.h>
+#include <dmlc/optional.h>
+#include <dmlc/parameter.h>
+#include <mxnet/operator.h>
+#include <mxnet/ndarray.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "../mshadow_op.h"
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+#include "../sequence_op_common.h"
+#include "../tensor/init_op.h"
+
+namespace mxnet {
+namespace op {
+
+struct SequencePackParam : public dmlc::Parameter<SequencePackParam> {
+  int axis;
+  DMLC_DECLARE_PARAMETER(SequencePackParam) {
+    DMLC_DECLARE_FIELD(axis).set_default(0).describe(
+        "The sequence axis of the padded data: 0 for (max_length, batch_size, ...) and 1 for "
+        "(batch_size, max_length, ...).");
+  }
+};
+
+struct SequenceUnpackParam : public dmlc::Parameter<SequenceUnpackParam> {
+  int max_length;
+  int axis;
+  DMLC_DECLARE_PARAMETER(SequenceUnpackParam) {
+    DMLC_DECLARE_FIELD(max_length)
+        .set_lower_bound(1)
+        .describe("Length of the padded sequence axis. Longer sequences are truncated.");
+    DMLC_DECLARE_FIELD(axis).set_default(0).describe(
+        "The sequence axis of the padded output: 0 for (max_length, batch_size, ...) and 1 for "
+        "(batch_size, max_length, ...).");
+  }
+};
+
+struct PackedAttentionParam : public dmlc::Parameter<PackedAttentionParam> {
+  int num_heads;
+  bool causal;
+  dmlc::optional<float> scale;
+  DMLC_DECLARE_PARAMETER(PackedAttentionParam) {
+    DMLC_DECLARE_FIELD(num_heads).set_lower_bound(1).describe("Number of attention heads.");
+    DMLC_DECLARE_FIELD(causal).set_default(false).describe(
+        "Whether a token only attends to itself and to the tokens before it in its sequence.");
+    DMLC_DECLARE_FIELD(scale)
+        .set_default(dmlc::optional<float>())
+        .describe("Scale of the attention scores. Defaults to 1 / sqrt(head_dim).");
+  }
+};
+
+/*! \brief Number of head dimensions whose output a packed attention work item accumulates at a
+ *         time in registers. */
+constexpr int kPackedAttentionChunk = 32;
+
+/*!
+ * \brief The sequence a packed row belongs to, that is the largest b with offsets[b] <= row. Empty
+ *        sequences share their offset with the next one and are skipped.
+ */
+template <typename OType>
+MSHADOW_XINLINE index_t PackedSegmentOf(const OType* offsets,
+                                        const index_t batch_size,
+                                        const index_t row) {
+  index_t lo = 0, hi = batch_size - 1;
+  while (lo < hi) {
+    const index_t mid = (lo + hi + 1) / 2;
+    if (static_cast<index_t>(offsets[mid]) <= row) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return lo;
+}
+
+/*!
+ * \brief Gathers the valid tokens of a padded batch into packed rows. Tokens past the padded
+ *        length, which only exist when computing the gradient of a truncating unpack, are zero.
+ */
+struct SequencePackKernel {
+  template <typename DType, typename OType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* packed,
+                                  const DType* padded,
+                                  const OType* offsets,
+                                  const index_t batch_size,
+                                  const index_t max_length,
+                                  const index_t col,
+                                  const int axis,
+                                  const OpReqType req) {
+    const index_t row = i / col;
+    const index_t c   = i % col;
+    const index_t b   = PackedSegmentOf(offsets, batch_size, row);
+    const index_t t   = row - static_cast<index_t>(offsets[b]);
+    const index_t src = (axis == 0 ? t * batch_size + b : b * max_length + t) * col + c;
+    KERNEL_ASSIGN(packed[i], req, t < max_length ? padded[src] : DType(0));
+  }
+};
+
+/*! \brief Scatters packed rows into a zero-padded batch. */
+struct SequenceUnpackKernel {
+  template <typename DType, typename OType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* padded,
+                                  const DType* packed,
+                                  const OType* offsets,
+                                  const index_t batch_size,
+                                  const index_t max_length,
+                                  const index_t col,
+                                  const int axis,
+                                  const OpReqType req) {
+    const index_t pos    = i / col;
+    const index_t c      = i % col;
+    const index_t t      = axis == 0 ? pos / batch_size : pos % max_length;
+    const index_t b      = axis == 0 ? pos % batch_size : pos / max_length;
+    const index_t start  = static_cast<index_t>(offsets[b]);
+    const index_t length = static_cast<index_t>(offsets[b + 1]) - start;
+    KERNEL_ASSIGN(padded[i], req, t < length ? packed[(start + t) * col + c] : DType(0));
+  }
+};
+
+/*! \brief The last token of every packed sequence, zero for empty sequences. */
+struct PackedSequenceLastKernel {
+  template <typename DType, typename OType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const DType* packed,
+                                  const OType* offsets,
+                                  const index_t col,
+                                  const OpReqType req) {
+    const index_t b     = i / col;
+    const index_t start = static_cast<index_t>(offsets[b]);
+    const index_t end   = static_cast<index_t>(offsets[b + 1]);
+    KERNEL_ASSIGN(out[i], req, end > start ? packed[(end - 1) * col + i % col] : DType(0));
+  }
+};
+
+struct PackedSequenceLastBackwardKernel {
+  template <typename DType, typename OType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* igrad,
+                                  const DType* ograd,
+                                  const OType* offsets,
+                                  const index_t batch_size,
+                                  const index_t col,
+                                  const OpReqType req) {
+    const index_t row = i / col;
+    const index_t b   = PackedSegmentOf(offsets, batch_size, row);
+    const bool last   = row == static_cast<index_t>(offsets[b + 1]) - 1;
+    KERNEL_ASSIGN(igrad[i], req, last ? ograd[b * col + i % col] : DType(0));
+  }
+};
+
+/*! \brief Reverses every packed sequence in place of its rows. It is its own gradient. */
+struct PackedSequenceReverseKernel {
+  template <typename DType, typename OType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const DType* packed,
+                                  const OType* offsets,
+                                  const index_t batch_size,
+                                  const index_t col,
+                                  const OpReqType req) {
+    const index_t row = i / col;
+    const index_t b   = PackedSegmentOf(offsets, batch_size, row);
+    const index_t src = static_cast<index_t>(offsets[b]) + static_cast<index_t>(offsets[b + 1]) -
+                        1 - row;
+    KERNEL_ASSIGN(out[i], req, packed[src * col + i % col]);
+  }
+};
+
+template <typename DType, typename AType>
+MSHADOW_XINLINE AType PackedAttentionDot(const DType* a, const DType* b, const int dim) {
+  AType sum = 0;
+  for (int d = 0; d < dim; ++d) {
+    sum += static_cast<AType>(a[d]) * static_cast<AType>(b[d]);
+  }
+  return sum;
+}
+
+/*!
+ * \brief Attention of one query row and head over the keys of its sequence. The softmax is
+ *        computed online: a first pass over the keys finds the log-sum-exp of the scores, which
+ *        is kept for the backward pass, and a second pass accumulates the weighted values a
+ *        chunk of head dimensions at a time. Neither the scores nor the probabilities are stored.
+ */
+struct PackedAttentionForwardKernel {
+  template <typename DType, typename AType, typename OType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  AType* lse,
+                                  const DType* query,
+                                  const DType* key,
+                                  const DType* value,
+                                  const OType* offsets,
+                                  const index_t batch_size,
+                                  const int num_heads,
+                                  const int head_dim,
+                                  const AType scale,
+                                  const bool causal,
+                                  const OpReqType req) {
+    const index_t row    = i / num_heads;
+    const index_t stride = static_cast<index_t>(num_heads) * head_dim;
+    const index_t head   = (i % num_heads) * head_dim;
+    const index_t b      = PackedSegmentOf(offsets, batch_size, row);
+    const index_t start  = static_cast<index_t>(offsets[b]);
+    const index_t end    = causal ? row + 1 : static_cast<index_t>(offsets[b + 1]);
+    const DType* q       = query + row * stride + head;
+    // every query attends at least to itself, so the running maximum starts at a finite score
+    AType m = scale * PackedAttentionDot<DType, AType>(q, key + start * stride + head, head_dim);
+    AType l = 1;
+    for (index_t j = start + 1; j < end; ++j) {
+      const AType s =
+          scale * PackedAttentionDot<DType, AType>(q, key + j * stride + head, head_dim);
+      if (s > m) {
+        l = l * math::exp(m - s) + 1;
+        m = s;
+      } else {
+        l += math::exp(s - m);
+      }
+    }
+    const AType logsumexp = m + math::log(l);
+    lse[i]                = logsumexp;
+    DType* o              = out + row * stride + head;
+    for (int d0 = 0; d0 < head_dim; d0 += kPackedAttentionChunk) {
+      const int width =
+          head_dim - d0 < kPackedAttentionChunk ? head_dim - d0 : kPackedAttentionChunk;
+      AType acc[kPackedAttentionChunk];
+      for (int d = 0; d < width; ++d) {
+        acc[d] = 0;
+      }
+      for (index_t j = start; j < end; ++j) {
+        const AType s =
+            scale * PackedAttentionDot<DType, AType>(q, key + j * stride + head, head_dim);
+        const AType p  = math::exp(s - logsumexp);
+        const DType* v = value + j * stride + head + d0;
+        for (int d = 0; d < width; ++d) {
+          acc[d] += p * static_cast<AType>(v[d]);
+        }
+      }
+      for (int d = 0; d < width; ++d) {
+        KERNEL_ASSIGN(o[d0 + d], req, static_cast<DType>(acc[d]));
+      }
+    }
+  }
+};
+
+/*! \brief delta = dot(ograd, out) for each row and head, the softmax term of the backward pass. */
+struct PackedAttentionDeltaKernel {
+  template <typename DType, typename AType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  AType* delta,
+                                  const DType* ograd,
+                                  const DType* out,
+                                  const int head_dim) {
+    delta[i] = PackedAttentionDot<DType, AType>(ograd + i * head_dim, out + i * head_dim, head_dim);
+  }
+};
+
+/*!
+ * \brief Gradient of one query row and head. With p = exp(s - lse) recomputed from the saved
+ *        log-sum-exp, dq = scale * sum_j p * (dot(ograd, v_j) - delta) * k_j.
+ */
+struct PackedAttentionQueryGradKernel {
+  template <typename DType, typename AType, typename OType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* gquery,
+                                  const DType* ograd,
+                                  const DType* query,
+                                  const DType* key,
+                                  const DType* value,
+                                  const AType* lse,
+                                  const AType* delta,
+                                  const OType* offsets,
+                                  const index_t batch_size,
+                                  const int num_heads,
+                                  const int head_dim,
+                                  const AType scale,
+                                  const bool causal,
+                                  const OpReqType req) {
+    const index_t row    = i / num_heads;
+    const index_t stride = static_cast<index_t>(num_heads) * head_dim;
+    const index_t head   = (i % num_heads) * head_dim;
+    const index_t b      = PackedSegmentOf(offsets, batch_size, row);
+    const index_t start  = static_cast<index_t>(offsets[b]);
+    const index_t end    = causal ? row + 1 : static_cast<index_t>(offsets[b + 1]);
+    const DType* q       = query + row * stride + head;
+    const DType* go      = ograd + row * stride + head;
+    DType* gq            = gquery + row * stride + head;
+    for (int d0 = 0; d0 < head_dim; d0 += kPackedAttentionChunk) {
+      const int width =
+          head_dim - d0 < kPackedAttentionChunk ? head_dim - d0 : kPackedAttentionChunk;
+      AType acc[kPackedAttentionChunk];
+      for (int d = 0; d < width; ++d) {
+        acc[d] = 0;
+      }
+      for (index_t j = start; j < end; ++j) {
+        const DType* k = key + j * stride + head;
+        const AType s  = scale * PackedAttentionDot<DType, AType>(q, k, head_dim);
+        const AType dp = PackedAttentionDot<DType, AType>(go, value + j * stride + head, head_dim);
+        const AType ds = math::exp(s - lse[i]) * (dp - delta[i]);
+        for (int d = 0; d < width; ++d) {
+          acc[d] += ds * static_cast<AType>(k[d0 + d]);
+        }
+      }
+      for (int d = 0; d < width; ++d) {
+        KERNEL_ASSIGN(gq[d0 + d], req, static_cast<DType>(scale * acc[d]));
+      }
+    }
+  }
+};
+
+/*!
+ * \brief Gradients of one key row and head, summed over the queries of the sequence that attend
+ *        to it: dv = sum_i p * ograd_i and
+ *        dk = scale * sum_i p * (dot(ograd_i, v) - delta_i) * q_i.
+ *        Each work item owns its rows of dk and dv, so no atomics are needed.
+ */
+struct PackedAttentionKeyValueGradKernel {
+  template <typename DType, typename AType, typename OType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* gkey,
+                                  DType* gvalue,
+                                  const DType* ograd,
+                                  const DType* query,
+                                  const DType* key,
+                                  const DType* value,
+                                  const AType* lse,
+                                  const AType* delta,
+                                  const OType* offsets,
+                                  const index_t batch_size,
+                                  const int num_heads,
+                                  const int head_dim,
+                                  const AType scale,
+                                  const bool causal,
+                                  const OpReqType req_key,
+                                  const OpReqType req_value) {
+    const index_t row    = i / num_heads;
+    const int h          = i % num_heads;
+    const index_t stride = static_cast<index_t>(num_heads) * head_dim;
+    const index_t head   = h * head_dim;
+    const index_t b      = PackedSegmentOf(offsets, batch_size, row);
+    const index_t start  = causal ? row : static_cast<index_t>(offsets[b]);
+    const index_t end    = static_cast<index_t>(offsets[b + 1]);
+    const DType* k       = key + row * stride + head;
+    const DType* v       = value + row * stride + head;
+    DType* gk            = gkey + row * stride + head;
+    DType* gv            = gvalue + row * stride + head;
+    for (int d0 = 0; d0 < head_dim; d0 += kPackedAttentionChunk) {
+      const int width =
+          head_dim - d0 < kPackedAttentionChunk ? head_dim - d0 : kPackedAttentionChunk;
+      AType acc_key[kPackedAttentionChunk];
+      AType acc_value[kPackedAttentionChunk];
+      for (int d = 0; d < width; ++d) {
+        acc_key[d]   = 0;
+        acc_value[d] = 0;
+      }
+      for (index_t j = start; j < end; ++j) {
+        const index_t qh = j * num_heads + h;
+        const DType* q   = query + j * stride + head;
+        const DType* go  = ograd + j * stride + head;
+        const AType s    = scale * PackedAttentionDot<DType, AType>(q, k, head_dim);
+        const AType p    = math::exp(s - lse[qh]);
+        const AType ds   = p * (PackedAttentionDot<DType, AType>(go, v, head_dim) - delta[qh]);
+        for (int d = 0; d < width; ++d) {
+          acc_value[d] += p * static_cast<AType>(go[d0 + d]);
+          acc_key[d] += ds * static_cast<AType>(q[d0 + d]);
+        }
+      }
+      for (int d = 0; d < width; ++d) {
+        KERNEL_ASSIGN(gk[d0 + d], req_key, static_cast<DType>(scale * acc_key[d]));
+        KERNEL_ASSIGN(gv[d0 + d], req_value, static_cast<DType>(acc_value[d]));
+      }
+    }
+  }
+};
+
+/*! \brief Offsets only index the packed rows, their gradient is zero. */
+template <typename xpu>
+inline void PackedOffsetsZeroGrad(mshadow::Stream<xpu>* s,
+                                  const TBlob& igrad,
+                                  const OpReqType req) {
+  if (req == kNullOp || req == kAddTo)
+    return;
+  MSHADOW_TYPE_SWITCH(igrad.type_flag_, OType, {
+    mxnet_op::Kernel<mxnet_op::set_zero, xpu>::Launch(s, igrad.Size(), igrad.dptr<OType>());
+  });
+}
+
+template <typename xpu>
+void SequencePackForward(const nnvm::NodeAttrs& attrs,
+                         const OpContext& ctx,
+                         const std::vector<NDArray>& inputs,
+                         const std::vector<OpReqType>& req,
+                         const std::vector<NDArray>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 2U);
+  CHECK(req[0] == kWriteTo || req[0] == kWriteInplace);
+  const SequencePackParam& param = nnvm::get<SequencePackParam>(attrs.parsed);
+  const NDArray& data            = inputs[0];
+  const NDArray& sequence_length = inputs[1];
+  const mxnet::TShape& dshape    = data.shape();
+  mshadow::Stream<xpu>* s        = ctx.get_stream<xpu>();
+  CHECK(param.axis == 0 || param.axis == 1) << "sequence_pack only supports axis 0 and 1";
+  CHECK_GE(dshape.ndim(), 2) << "sequence_pack expects padded data of at least 2 dimensions";
+  const index_t max_length = dshape[param.axis];
+  const index_t batch_size = dshape[1 - param.axis];
+  CHECK_EQ(sequence_length.shape().Size(), batch_size)
+      << "sequence_pack expects one length per sequence";
+  // the lengths decide the shape of the packed output, so they are read on the host
+  std::vector<index_t> lengths(batch_size);
+  MSHADOW_TYPE_SWITCH(sequence_length.dtype(), LType, {
+    IndexTensorToVector(sequence_length.data().FlatTo1D<xpu, LType>(s), &lengths);
+  });
+  std::vector<int64_t> offsets(batch_size + 1, 0);
+  for (index_t b = 0; b < batch_size; ++b) {
+    offsets[b + 1] = offsets[b] + std::min(std::max<index_t>(lengths[b], 0), max_length);
+  }
+  mxnet::TShape pshape(dshape.begin() + 1, dshape.end());
+  pshape[0] = offsets[batch_size];
+  const_cast<NDArray&>(outputs[0]).Init(pshape);
+  const_cast<NDArray&>(outputs[1]).Init(mshadow::Shape1(batch_size + 1));
+  mshadow::Tensor<xpu, 1, int64_t> doffsets = outputs[1].data().FlatTo1D<xpu, int64_t>(s);
+  mshadow::Copy(
+      doffsets, mshadow::Tensor<cpu, 1, int64_t>(offsets.data(), doffsets.shape_), s);
+  const index_t col = dshape.ProdShape(2, dshape.ndim());
+  MSHADOW_TYPE_SWITCH(data.dtype(), DType, {
+    Kernel<SequencePackKernel, xpu>::Launch(s,
+                                            pshape.Size(),
+                                            outputs[0].data().dptr<DType>(),
+                                            data.data().dptr<DType>(),
+                                            doffsets.dptr_,
+                                            batch_size,
+                                            max_length,
+                                            col,
+                                            param.axis,
+                                            req[0]);
+  });
+}
+
+template <typename xpu>
+void SequencePackBackward(const nnvm::NodeAttrs& attrs,
+                          const OpContext& ctx,
+                          const std::vector<NDArray>& inputs,
+                          const std::vector<OpReqType>& req,
+                          const std::vector<NDArray>& outputs) {
+  using namespace mxnet_op;
+  // inputs: {ograd, sequence_length, offsets}, outputs: {igrad_data, igrad_sequence_length}
+  CHECK_EQ(inputs.size(), 3U);
+  CHECK_EQ(outputs.size(), 2U);
+  const SequencePackParam& param = nnvm::get<SequencePackParam>(attrs.parsed);
+  const TBlob ograd              = inputs[0].data();
+  const TBlob offsets            = inputs[2].data();
+  const TBlob igrad              = outputs[0].data();
+  mshadow::Stream<xpu>* s        = ctx.get_stream<xpu>();
+  PackedOffsetsZeroGrad(s, outputs[1].data(), req[1]);
+  if (req[0] == kNullOp)
+    return;
+  const index_t max_length = igrad.shape_[param.axis];
+  const index_t batch_size = igrad.shape_[1 - param.axis];
+  const index_t col        = igrad.shape_.ProdShape(2, igrad.ndim());
+  MSHADOW_TYPE_SWITCH(igrad.type_flag_, DType, {
+    Kernel<SequenceUnpackKernel, xpu>::Launch(s,
+                                              igrad.Size(),
+                                              igrad.dptr<DType>(),
+                                              ograd.dptr<DType>(),
+                                              offsets.dptr<int64_t>(),
+                                              batch_size,
+                                              max_length,
+                                              col,
+                                              param.axis,
+                                              req[0]);
+  });
+}
+
+template <typename xpu>
+void SequenceUnpackForward(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 1U);
+  if (req[0] == kNullOp)
+    return;
+  const SequenceUnpackParam& param = nnvm::get<SequenceUnpackParam>(attrs.parsed);
+  const TBlob& out                 = outputs[0];
+  const index_t batch_size         = inputs[1].Size() - 1;
+  mshadow::Stream<xpu>* s          = ctx.get_stream<xpu>();
+  MSHADOW_TYPE_SWITCH(out.type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH(inputs[1].type_flag_, OType, {
+      Kernel<SequenceUnpackKernel, xpu>::Launch(s,
+                                                out.Size(),
+                                                out.dptr<DType>(),
+                                                inputs[0].dptr<DType>(),
+                                                inputs[1].dptr<OType>(),
+                                                batch_size,
+                                                static_cast<index_t>(param.max_length),
+                                                out.shape_.ProdShape(2, out.ndim()),
+                                                param.axis,
+                                                req[0]);
+    });
+  });
+}
+
+template <typename xpu>
+void SequenceUnpackBackward(const nnvm::NodeAttrs& attrs,
+                            const OpContext& ctx,
+                            const std::vector<TBlob>& inputs,
+                            const std::vector<OpReqType>& req,
+                            const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  // inputs: {ograd, offsets}, outputs: {igrad_packed, igrad_offsets}
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 2U);
+  const SequenceUnpackParam& param = nnvm::get<SequenceUnpackParam>(attrs.parsed);
+  const TBlob& igrad               = outputs[0];
+  mshadow::Stream<xpu>* s          = ctx.get_stream<xpu>();
+  PackedOffsetsZeroGrad(s, outputs[1], req[1]);
+  if (req[0] == kNullOp)
+    return;
+  MSHADOW_TYPE_SWITCH(igrad.type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH(inputs[1].type_flag_, OType, {
+      Kernel<SequencePackKernel, xpu>::Launch(s,
+                                              igrad.Size(),
+                                              igrad.dptr<DType>(),
+                                              inputs[0].dptr<DType>(),
+                                              inputs[1].dptr<OType>(),
+                                              static_cast<index_t>(inputs[1].Size() - 1),
+                                              static_cast<index_t>(param.max_length),
+                                              igrad.shape_.ProdShape(1, igrad.ndim()),
+                                              param.axis,
+                                              req[0]);
+    });
+  });
+}
+
+template <typename xpu>
+void PackedSequenceLastForward(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 1U);
+  if (req[0] == kNullOp)
+    return;
+  const TBlob& out        = outputs[0];
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_TYPE_SWITCH(out.type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH(inputs[1].type_flag_, OType, {
+      Kernel<PackedSequenceLastKernel, xpu>::Launch(s,
+                                                    out.Size(),
+                                                    out.dptr<DType>(),
+                                                    inputs[0].dptr<DType>(),
+                                                    inputs[1].dptr<OType>(),
+                                                    out.shape_.ProdShape(1, out.ndim()),
+                                                    req[0]);
+    });
+  });
+}
+
+template <typename xpu>
+void PackedSequenceLastBackward(const nnvm::NodeAttrs& attrs,
+                                const OpContext& ctx,
+                                const std::vector<TBlob>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  // inputs: {ograd, offsets}, outputs: {igrad_packed, igrad_offsets}
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_EQ(outputs.size(), 2U);
+  const TBlob& igrad      = outputs[0];
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  PackedOffsetsZeroGrad(s, outputs[1], req[1]);
+  if (req[0] == kNullOp)
+    return;
+  MSHADOW_TYPE_SWITCH(igrad.type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH(inputs[1].type_flag_, OType, {
+      Kernel<PackedSequenceLastBackwardKernel, xpu>::Launch(
+          s,
+          igrad.Size(),
+          igrad.dptr<DType>(),
+          inputs[0].dptr<DType>(),
+          inputs[1].dptr<OType>(),
+          static_cast<index_t>(inputs[1].Size() - 1),
+          igrad.shape_.ProdShape(1, igrad.ndim()),
+          req[0]);
+    });
+  });
+}
+
+template <typename xpu>
+void PackedSequenceReverseForward(const nnvm::NodeAttrs& attrs,
+                                  const OpContext& ctx,
+                                  const std::vector<TBlob>& inputs,
+                                  const std::vector<OpReqType>& req,
+                                  const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 2U);
+  CHECK_GE(outputs.size(), 1U);
+  if (req[0] == kNullOp)
+    return;
+  CHECK_NE(req[0], kWriteInplace) << "packed_sequence_reverse does not support in-place writes";
+  const TBlob& out        = outputs[0];
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_TYPE_SWITCH(out.type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH(inputs[1].type_flag_, OType, {
+      Kernel<PackedSequenceReverseKernel, xpu>::Launch(s,
+                                                       out.Size(),
+                                                       out.dptr<DType>(),
+                                                       inputs[0].dptr<DType>(),
+                                                       inputs[1].dptr<OType>(),
+                                                       static_cast<index_t>(inputs[1].Size() - 1),
+                                                       out.shape_.ProdShape(1, out.ndim()),
+                                                       req[0]);
+    });
+  });
+}
+
+template <typename xpu>
+void PackedSequenceReverseBackward(const nnvm::NodeAttrs& attrs,
+                                   const OpContext& ctx,
+                                   const std::vector<TBlob>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& outputs) {
+  // inputs: {ograd, offsets}, outputs: {igrad_packed, igrad_offsets}
+  CHECK_EQ(outputs.size(), 2U);
+  PackedOffsetsZeroGrad(ctx.get_stream<xpu>(), outputs[1], req[1]);
+  PackedSequenceReverseForward<xpu>(attrs, ctx, inputs, req, outputs);
+}
+
+template <typename xpu>
+void PackedAttentionForward(const nnvm::NodeAttrs& attrs,
+                            const OpContext& ctx,
+                            const std::vector<TBlob>& inputs,
+                            const std::vector<OpReqType>& req,
+                            const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 4U);
+  CHECK_EQ(outputs.size(), 2U);
+  const PackedAttentionParam& param = nnvm::get<PackedAttentionParam>(attrs.parsed);
+  const TBlob& query                = inputs[0];
+  const int head_dim                = query.shape_[1] / param.num_heads;
+  const index_t batch_size          = inputs[3].Size() - 1;
+  mshadow::Stream<xpu>* s           = ctx.get_stream<xpu>();
+  if (req[0] == kNullOp || query.shape_[0] == 0)
+    return;
+  MSHADOW_REAL_TYPE_SWITCH_EX(query.type_flag_, DType, AType, {
+    MSHADOW_TYPE_SWITCH(inputs[3].type_flag_, OType, {
+      const AType scale = param.scale.has_value() ? static_cast<AType>(param.scale.value()) :
+                                                    1 / math::sqrt(static_cast<AType>(head_dim));
+      Kernel<PackedAttentionForwardKernel, xpu>::Launch(s,
+                                                        outputs[1].Size(),
+                                                        outputs[0].dptr<DType>(),
+                                                        outputs[1].dptr<AType>(),
+                                                        query.dptr<DType>(),
+                                                        inputs[1].dptr<DType>(),
+                                                        inputs[2].dptr<DType>(),
+                                                        inputs[3].dptr<OType>(),
+                                                        batch_size,
+                                                        param.num_heads,
+                                                        head_dim,
+                                                        scale,
+                                                        param.causal,
+                                                        req[0]);
+    });
+  });
+}
+
+template <typename xpu>
+void PackedAttentionBackward(const nnvm::NodeAttrs& attrs,
+                             const OpContext& ctx,
+                             const std::vector<TBlob>& inputs,
+                             const std::vector<OpReqType>& req,
+                             const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  // inputs: {ograd, ograd_lse, query, key, value, offsets, out, lse}
+  // outputs: {igrad_query, igrad_key, igrad_value, igrad_offsets}
+  CHECK_EQ(inputs.size(), 8U);
+  CHECK_EQ(outputs.size(), 4U);
+  const PackedAttentionParam& param = nnvm::get<PackedAttentionParam>(attrs.parsed);
+  const TBlob& ograd                = inputs[0];
+  const TBlob& query                = inputs[2];
+  const TBlob& offsets              = inputs[5];
+  const TBlob& lse                  = inputs[7];
+  const int head_dim                = query.shape_[1] / param.num_heads;
+  const index_t batch_size          = offsets.Size() - 1;
+  mshadow::Stream<xpu>* s           = ctx.get_stream<xpu>();
+  PackedOffsetsZeroGrad(s, outputs[3], req[3]);
+  if (query.shape_[0] == 0)
+    return;
+  MSHADOW_REAL_TYPE_SWITCH_EX(query.type_flag_, DType, AType, {
+    MSHADOW_TYPE_SWITCH(offsets.type_flag_, OType, {
+      const AType scale = param.scale.has_value() ? static_cast<AType>(param.scale.value()) :
+                                                    1 / math::sqrt(static_cast<AType>(head_dim));
+      mshadow::Tensor<xpu, 1, AType> delta =
+          ctx.requested[0].get_space_typed<xpu, 1, AType>(mshadow::Shape1(lse.Size()), s);
+      Kernel<PackedAttentionDeltaKernel, xpu>::Launch(
+          s, lse.Size(), delta.dptr_, ograd.dptr<DType>(), inputs[6].dptr<DType>(), head_dim);
+      if (req[0] != kNullOp) {
+        Kernel<PackedAttentionQueryGradKernel, xpu>::Launch(s,
+                                                            lse.Size(),
+                                                            outputs[0].dptr<DType>(),
+                                                            ograd.dptr<DType>(),
+                                                            query.dptr<DType>(),
+                                                            inputs[3].dptr<DType>(),
+                                                            inputs[4].dptr<DType>(),
+                                                            lse.dptr<AType>(),
+                                                            delta.dptr_,
+                                                            offsets.dptr<OType>(),
+                                                            batch_size,
+                                                            param.num_heads,
+                                                            head_dim,
+                                                            scale,
+                                                            param.causal,
+                                                            req[0]);
+      }
+      if (req[1] != kNullOp || req[2] != kNullOp) {
+        Kernel<PackedAttentionKeyValueGradKernel, xpu>::Launch(s,
+                                                               lse.Size(),
+                                                               outputs[1].dptr<DType>(),
+                                                               outputs[2].dptr<DType>(),
+                                                               ograd.dptr<DType>(),
+                                                               query.dptr<DType>(),
+                                                               inputs[3].dptr<DType>(),
+                                                               inputs[4].dptr<DType>(),
+                                                               lse.dptr<AType>(),
+                                                               delta.dptr_,
+                                                               offsets.dptr<OType>(),
+                                                               batch_size,
+                                                               param.num_heads,
+                                                               head_dim,
+                                                               scale,
+                                                               param.causal,
+                                                               req[1],
+                                                               req[2]);
+      }
+    });
+  });
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_NUMPY_NP_PACKED_SEQUENCE_OP_INL_H_
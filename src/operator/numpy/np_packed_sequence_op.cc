@@ -0,0 +1,372 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file np_packed_sequence_op.cc
+ * \brief CPU registration of the operators on packed variable-length sequences.
+ */
+
+#include "./np_packed_sequence_op-inl.h"
+#include <nnvm/op_attr_types.h>
+#include "../elemwise_op_common.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(SequencePackParam);
+DMLC_REGISTER_PARAMETER(SequenceUnpackParam);
+DMLC_REGISTER_PARAMETER(PackedAttentionParam);
+
+bool SequencePackType(const nnvm::NodeAttrs& attrs,
+                      std::vector<int>* in_attrs,
+                      std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 2U);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(0));
+  TYPE_ASSIGN_CHECK(*in_attrs, 0, out_attrs->at(0));
+  TYPE_ASSIGN_CHECK(*out_attrs, 1, mshadow::kInt64);
+  return in_attrs->at(0) != -1 && in_attrs->at(1) != -1;
+}
+
+bool SequencePackStorageType(const nnvm::NodeAttrs& attrs,
+                             const int dev_mask,
+                             DispatchMode* dispatch_mode,
+                             std::vector<int>* in_attrs,
+                             std::vector<int>* out_attrs) {
+  for (int& attr : *in_attrs) {
+    CHECK_EQ(attr, kDefaultStorage) << "Only default storage is supported";
+  }
+  for (int& attr : *out_attrs) {
+    attr = kDefaultStorage;
+  }
+  *dispatch_mode = DispatchMode::kFComputeEx;
+  return true;
+}
+
+bool SequenceUnpackShape(const nnvm::NodeAttrs& attrs,
+                         mxnet::ShapeVector* in_attrs,
+                         mxnet::ShapeVector* out_attrs) {
+  const SequenceUnpackParam& param = nnvm::get<SequenceUnpackParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  CHECK(param.axis == 0 || param.axis == 1) << "sequence_unpack only supports axis 0 and 1";
+  const mxnet::TShape& pshape = in_attrs->at(0);
+  const mxnet::TShape& oshape = in_attrs->at(1);
+  if (!mxnet::ndim_is_known(pshape) || !mxnet::shape_is_known(oshape))
+    return false;
+  CHECK_GE(pshape.ndim(), 1) << "sequence_unpack expects packed data of shape (total, ...)";
+  CHECK_EQ(oshape.ndim(), 1) << "sequence_unpack expects offsets of shape (batch_size + 1,)";
+  CHECK_GE(oshape[0], 1) << "sequence_unpack expects offsets of shape (batch_size + 1,)";
+  mxnet::TShape out(pshape.ndim() + 1, -1);
+  out[param.axis]     = param.max_length;
+  out[1 - param.axis] = oshape[0] - 1;
+  for (int i = 1; i < pshape.ndim(); ++i) {
+    out[i + 1] = pshape[i];
+  }
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, out);
+  return shape_is_known(out);
+}
+
+bool PackedSequenceLastShape(const nnvm::NodeAttrs& attrs,
+                             mxnet::ShapeVector* in_attrs,
+                             mxnet::ShapeVector* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  const mxnet::TShape& pshape = in_attrs->at(0);
+  const mxnet::TShape& oshape = in_attrs->at(1);
+  if (!mxnet::ndim_is_known(pshape) || !mxnet::shape_is_known(oshape))
+    return false;
+  CHECK_EQ(oshape.ndim(), 1) << "packed_sequence_last expects offsets of shape (batch_size + 1,)";
+  mxnet::TShape out(pshape);
+  out[0] = oshape[0] - 1;
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, out);
+  return shape_is_known(out);
+}
+
+bool PackedSequenceReverseShape(const nnvm::NodeAttrs& attrs,
+                                mxnet::ShapeVector* in_attrs,
+                                mxnet::ShapeVector* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(0));
+  SHAPE_ASSIGN_CHECK(*in_attrs, 0, out_attrs->at(0));
+  return shape_is_known(in_attrs->at(0)) && shape_is_known(in_attrs->at(1));
+}
+
+/*! \brief Packed values take their type from the first input, offsets keep their own. */
+bool PackedSequenceType(const nnvm::NodeAttrs& attrs,
+                        std::vector<int>* in_attrs,
+                        std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(0));
+  TYPE_ASSIGN_CHECK(*in_attrs, 0, out_attrs->at(0));
+  return in_attrs->at(0) != -1 && in_attrs->at(1) != -1;
+}
+
+bool PackedAttentionShape(const nnvm::NodeAttrs& attrs,
+                          mxnet::ShapeVector* in_attrs,
+                          mxnet::ShapeVector* out_attrs) {
+  const PackedAttentionParam& param = nnvm::get<PackedAttentionParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), 4U);
+  CHECK_EQ(out_attrs->size(), 2U);
+  for (int i = 1; i < 3; ++i) {
+    SHAPE_ASSIGN_CHECK(*in_attrs, 0, in_attrs->at(i));
+  }
+  const mxnet::TShape& qshape = in_attrs->at(0);
+  if (!mxnet::shape_is_known(qshape) || !mxnet::shape_is_known(in_attrs->at(3)))
+    return false;
+  CHECK_EQ(qshape.ndim(), 2) << "packed_attention expects query, key and value of shape "
+                             << "(total, num_heads * head_dim)";
+  CHECK_EQ(qshape[1] % param.num_heads, 0)
+      << "The feature size " << qshape[1] << " is not a multiple of num_heads " << param.num_heads;
+  CHECK_EQ(in_attrs->at(3).ndim(), 1)
+      << "packed_attention expects offsets of shape (batch_size + 1,)";
+  SHAPE_ASSIGN_CHECK(*in_attrs, 1, qshape);
+  SHAPE_ASSIGN_CHECK(*in_attrs, 2, qshape);
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, qshape);
+  SHAPE_ASSIGN_CHECK(*out_attrs, 1, mshadow::Shape2(qshape[0], param.num_heads));
+  return true;
+}
+
+bool PackedAttentionType(const nnvm::NodeAttrs& attrs,
+                         std::vector<int>* in_attrs,
+                         std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 4U);
+  CHECK_EQ(out_attrs->size(), 2U);
+  const int dtype = in_attrs->at(0);
+  if (dtype == -1 || in_attrs->at(3) == -1)
+    return false;
+  TYPE_ASSIGN_CHECK(*in_attrs, 1, dtype);
+  TYPE_ASSIGN_CHECK(*in_attrs, 2, dtype);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, dtype);
+  // the log-sum-exp of the scores is kept in the accumulation type
+  TYPE_ASSIGN_CHECK(
+      *out_attrs, 1, dtype == mshadow::kFloat64 ? mshadow::kFloat64 : mshadow::kFloat32);
+  return true;
+}
+
+/*! \brief Gradient node taking the output gradient and the offsets, the last input. */
+struct PackedSequenceGrad {
+  const char* op_name;
+  std::vector<nnvm::NodeEntry> operator()(const nnvm::ObjectPtr& n,
+                                          const std::vector<nnvm::NodeEntry>& ograds) const {
+    std::vector<nnvm::NodeEntry> heads{ograds[0], n->inputs.back()};
+    return MakeGradNode(op_name, n, heads, n->attrs.dict);
+  }
+};
+
+NNVM_REGISTER_OP(_npx_sequence_pack)
+    .describe(R"code(Pack the valid tokens of a padded batch of variable-length sequences.
+
+For ``data`` of shape (max_length, batch_size, ...) with ``axis=0``, or
+(batch_size, max_length, ...) with ``axis=1``, and the ``sequence_length`` of each sequence,
+the outputs are the valid tokens of all the sequences back to back, of shape (total, ...) where
+``total`` is the sum of the lengths, and the offsets of shape (batch_size + 1,) at which every
+sequence starts: ``offsets[0] = 0`` and ``offsets[b + 1] = offsets[b] + sequence_length[b]``.
+
+Token-wise operators such as Embedding, LayerNorm and FullyConnected apply to the packed tokens
+as they are, and ``packed_attention``, ``packed_sequence_last`` and ``packed_sequence_reverse``
+take the offsets to find the sequences, so that no work is spent on padding.
+``sequence_unpack`` restores the padded layout.
+
+The shape of the packed output depends on the lengths, which are read before the operator runs.
+
+Example::
+
+  data = [[1, 2], [3, 4], [5, 6]]            # (max_length=3, batch_size=2)
+  packed, offsets = sequence_pack(data, sequence_length=[3, 1])
+  packed = [1, 3, 5, 2]
+  offsets = [0, 3, 4]
+
+)code" ADD_FILELINE)
+    .set_num_inputs(2)
+    .set_num_outputs(2)
+    .set_attr_parser(ParamParser<SequencePackParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data", "sequence_length"};
+                                     })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output", "offsets"};
+                                      })
+    .set_attr<nnvm::FInferType>("FInferType", SequencePackType)
+    .set_attr<FInferStorageType>("FInferStorageType", SequencePackStorageType)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", SequencePackForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient",
+                               [](const nnvm::ObjectPtr& n,
+                                  const std::vector<nnvm::NodeEntry>& ograds) {
+                                 std::vector<nnvm::NodeEntry> heads;
+                                 heads.push_back(ograds[0]);     // ograd
+                                 heads.push_back(n->inputs[1]);  // sequence_length
+                                 heads.emplace_back(nnvm::NodeEntry{n, 1, 0});  // offsets
+                                 return MakeGradNode(
+                                     "_backward_npx_sequence_pack", n, heads, n->attrs.dict);
+                               })
+    .add_argument("data", "NDArray-or-Symbol", "Padded batch of sequences")
+    .add_argument("sequence_length", "NDArray-or-Symbol", "Length of each sequence")
+    .add_arguments(SequencePackParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_npx_sequence_pack)
+    .set_num_inputs(3)
+    .set_num_outputs(2)
+    .set_attr_parser(ParamParser<SequencePackParam>)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FInferStorageType>("FInferStorageType", SequencePackStorageType)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", SequencePackBackward<cpu>);
+
+NNVM_REGISTER_OP(_npx_sequence_unpack)
+    .describe(R"code(Scatter packed sequences into a zero-padded batch, undoing sequence_pack.
+
+For ``data`` of shape (total, ...) and ``offsets`` of shape (batch_size + 1,), the output has the
+shape (max_length, batch_size, ...) with ``axis=0``, or (batch_size, max_length, ...) with
+``axis=1``. Sequences longer than ``max_length`` are truncated.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(2)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<SequenceUnpackParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data", "offsets"};
+                                     })
+    .set_attr<mxnet::FInferShape>("FInferShape", SequenceUnpackShape)
+    .set_attr<nnvm::FInferType>("FInferType", PackedSequenceType)
+    .set_attr<FCompute>("FCompute<cpu>", SequenceUnpackForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", PackedSequenceGrad{"_backward_npx_sequence_unpack"})
+    .add_argument("data", "NDArray-or-Symbol", "Packed sequences")
+    .add_argument("offsets", "NDArray-or-Symbol", "Offset at which each sequence starts")
+    .add_arguments(SequenceUnpackParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_npx_sequence_unpack)
+    .set_num_inputs(2)
+    .set_num_outputs(2)
+    .set_attr_parser(ParamParser<SequenceUnpackParam>)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FCompute>("FCompute<cpu>", SequenceUnpackBackward<cpu>);
+
+NNVM_REGISTER_OP(_npx_packed_sequence_last)
+    .describe(R"code(The last token of each packed sequence, as SequenceLast of the padded batch.
+
+For ``data`` of shape (total, ...) and ``offsets`` of shape (batch_size + 1,), the output has the
+shape (batch_size, ...). Empty sequences give zeros.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(2)
+    .set_num_outputs(1)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data", "offsets"};
+                                     })
+    .set_attr<mxnet::FInferShape>("FInferShape", PackedSequenceLastShape)
+    .set_attr<nnvm::FInferType>("FInferType", PackedSequenceType)
+    .set_attr<FCompute>("FCompute<cpu>", PackedSequenceLastForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient",
+                               PackedSequenceGrad{"_backward_npx_packed_sequence_last"})
+    .add_argument("data", "NDArray-or-Symbol", "Packed sequences")
+    .add_argument("offsets", "NDArray-or-Symbol", "Offset at which each sequence starts");
+
+NNVM_REGISTER_OP(_backward_npx_packed_sequence_last)
+    .set_num_inputs(2)
+    .set_num_outputs(2)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FCompute>("FCompute<cpu>", PackedSequenceLastBackward<cpu>);
+
+NNVM_REGISTER_OP(_npx_packed_sequence_reverse)
+    .describe(R"code(Reverse each packed sequence, as SequenceReverse of the padded batch.
+
+For ``data`` of shape (total, ...) and ``offsets`` of shape (batch_size + 1,), the tokens of every
+sequence are reversed in its own rows.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(2)
+    .set_num_outputs(1)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data", "offsets"};
+                                     })
+    .set_attr<mxnet::FInferShape>("FInferShape", PackedSequenceReverseShape)
+    .set_attr<nnvm::FInferType>("FInferType", PackedSequenceType)
+    .set_attr<FCompute>("FCompute<cpu>", PackedSequenceReverseForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient",
+                               PackedSequenceGrad{"_backward_npx_packed_sequence_reverse"})
+    .add_argument("data", "NDArray-or-Symbol", "Packed sequences")
+    .add_argument("offsets", "NDArray-or-Symbol", "Offset at which each sequence starts");
+
+NNVM_REGISTER_OP(_backward_npx_packed_sequence_reverse)
+    .set_num_inputs(2)
+    .set_num_outputs(2)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FCompute>("FCompute<cpu>", PackedSequenceReverseBackward<cpu>);
+
+NNVM_REGISTER_OP(_npx_packed_attention)
+    .describe(R"code(Multi-head scaled dot-product attention within each packed sequence.
+
+``query``, ``key`` and ``value`` have the shape (total, num_heads * head_dim), with the tokens of
+all the sequences back to back as given by ``offsets`` of shape (batch_size + 1,). Each token
+attends only to the tokens of its own sequence, and with ``causal=True`` only to itself and the
+tokens before it:
+
+.. math::
+
+  out_i = \sum_j softmax_j(scale * dot(query_i, key_j)) * value_j
+
+The softmax is computed online for each query and head, and neither the scores nor the
+probabilities are stored: the backward pass recomputes them from the log-sum-exp of the scores
+saved by the forward pass. The work grows with the sum of the squared lengths of the sequences
+instead of batch_size times the squared padded length.
+
+)code" ADD_FILELINE)
+    .set_num_inputs(4)
+    .set_num_outputs(2)
+    .set_attr_parser(ParamParser<PackedAttentionParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{
+                                           "query", "key", "value", "offsets"};
+                                     })
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output", "logsumexp"};
+                                      })
+    .set_attr<nnvm::FNumVisibleOutputs>("FNumVisibleOutputs",
+                                        [](const NodeAttrs& attrs) { return 1; })
+    .set_attr<mxnet::FInferShape>("FInferShape", PackedAttentionShape)
+    .set_attr<nnvm::FInferType>("FInferType", PackedAttentionType)
+    .set_attr<FCompute>("FCompute<cpu>", PackedAttentionForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", ElemwiseGradUseInOut{"_backward_npx_packed_attention"})
+    .add_argument("query", "NDArray-or-Symbol", "Packed queries")
+    .add_argument("key", "NDArray-or-Symbol", "Packed keys")
+    .add_argument("value", "NDArray-or-Symbol", "Packed values")
+    .add_argument("offsets", "NDArray-or-Symbol", "Offset at which each sequence starts")
+    .add_arguments(PackedAttentionParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_npx_packed_attention)
+    .set_num_inputs(8)
+    .set_num_outputs(4)
+    .set_attr_parser(ParamParser<PackedAttentionParam>)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FCompute>("FCompute<cpu>", PackedAttentionBackward<cpu>)
+    .set_attr<FResourceRequest>("FResourceRequest", [](const NodeAttrs& n) {
+      return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+    });
+
+}  // namespace op
+}  // namespace mxnet
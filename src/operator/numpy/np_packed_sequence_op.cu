@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file np_packed_sequence_op.cu
+ * \brief GPU registration of the operators on packed variable-length sequences.
+ */
+#include "./np_packed_sequence_op-inl.h"
+
+namespace mxnet {
+namespace op {
+
+NNVM_REGISTER_OP(_npx_sequence_pack)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", SequencePackForward<gpu>);
+
+NNVM_REGISTER_OP(_backward_npx_sequence_pack)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", SequencePackBackward<gpu>);
+
+NNVM_REGISTER_OP(_npx_sequence_unpack)
+    .set_attr<FCompute>("FCompute<gpu>", SequenceUnpackForward<gpu>);
+
+NNVM_REGISTER_OP(_backward_npx_sequence_unpack)
+    .set_attr<FCompute>("FCompute<gpu>", SequenceUnpackBackward<gpu>);
+
+NNVM_REGISTER_OP(_npx_packed_sequence_last)
+    .set_attr<FCompute>("FCompute<gpu>", PackedSequenceLastForward<gpu>);
+
+NNVM_REGISTER_OP(_backward_npx_packed_sequence_last)
+    .set_attr<FCompute>("FCompute<gpu>", PackedSequenceLastBackward<gpu>);
+
+NNVM_REGISTER_OP(_npx_packed_sequence_reverse)
+    .set_attr<FCompute>("FCompute<gpu>", PackedSequenceReverseForward<gpu>);
+
+NNVM_REGISTER_OP(_backward_npx_packed_sequence_reverse)
+    .set_attr<FCompute>("FCompute<gpu>", PackedSequenceReverseBackward<gpu>);
+
+NNVM_REGISTER_OP(_npx_packed_attention)
+    .set_attr<FCompute>("FCompute<gpu>", PackedAttentionForward<gpu>);
+
+NNVM_REGISTER_OP(_backward_npx_packed_attention)
+    .set_attr<FCompute>("FCompute<gpu>", PackedAttentionBackward<gpu>);
+
+}  // namespace op
+}  // namespace mxnet
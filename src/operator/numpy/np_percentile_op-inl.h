@@ -136,6 +136,48 @@ struct percentile_take {
   }
 };
 
+/*!
+ * \brief CPU: Copies the rows of src to a_sort with the order statistics read by percentile_take
+ *  in their sorted positions, which selection finds without sorting the whole rows.
+ */
+template <typename DType, typename QType>
+void PercentileSelect(const DType* src,
+                      DType* a_sort,
+                      index_t rows,
+                      index_t n,
+                      const QType* q,
+                      size_t q_size) {
+  if (n == 0)
+    return;
+  // the ranks below and above each percentile, as computed by percentile_take
+  std::vector<index_t> ranks;
+  for (size_t i = 0; i < q_size; ++i) {
+    float idx           = q[i] * (n - 1) / 100.0;
+    const index_t below = floor(idx);
+    ranks.push_back(below);
+    ranks.push_back(std::min(below + 1, n - 1));
+  }
+  std::sort(ranks.begin(), ranks.end());
+  ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+  // each selection goes over the rest of the row, so a sort is faster for many percentiles
+  const bool full_sort  = ranks.size() > 16;
+  const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t i = 0; i < rows; ++i) {
+    DType* row = a_sort + i * n;
+    std::copy(src + i * n, src + (i + 1) * n, row);
+    if (full_sort) {
+      std::sort(row, row + n);
+      continue;
+    }
+    DType* first = row;
+    for (const index_t rank : ranks) {
+      std::nth_element(first, row + rank, row + n);
+      first = row + rank + 1;
+    }
+  }
+}
+
 template <typename QType, typename xpu>
 bool CheckInvalidInput(mshadow::Stream<xpu>* s,
                        const QType* data,
@@ -285,8 +327,19 @@ void NumpyPercentileForward(const nnvm::NodeAttrs& attrs,
     TBlob src                       = a_trans.reshape(t_shape);
     std::vector<TBlob> ret          = {a_sort, a_idx};
 
-    TopKImplwithWorkspace<xpu, DType, index_t>(
-        ctx.run_ctx, req_TopK, src, ret, topk_param, workspace_curr_ptr, temp_size, s);
+    if (std::is_same<xpu, cpu>::value) {
+      MSHADOW_TYPE_SWITCH(percentile.type_flag_, QType, {
+        PercentileSelect(src.dptr<DType>(),
+                         a_sort.dptr<DType>(),
+                         static_cast<index_t>(t_shape.ProdShape(0, t_shape.ndim() - 1)),
+                         static_cast<index_t>(red_size),
+                         percentile.dptr<QType>(),
+                         percentile.Size());
+      })
+    } else {
+      TopKImplwithWorkspace<xpu, DType, index_t>(
+          ctx.run_ctx, req_TopK, src, ret, topk_param, workspace_curr_ptr, temp_size, s);
+    }
     MSHADOW_TYPE_SWITCH(percentile.type_flag_,
                         QType,
                         {MSHADOW_SGL_DBL_TYPE_SWITCH(
@@ -102,15 +102,17 @@ void NumpyUniqueCPUNoneAxisImpl(const NumpyUniqueParam& param,
   MSHADOW_TYPE_SWITCH(outputs[0].dtype(), DType, {
     mshadow::Stream<cpu>* stream = ctx.get_stream<cpu>();
 
-    DType* input_data = inputs[0].data().dptr<DType>();
-    dim_t input_size  = inputs[0].shape().Size();
+    DType* input_data  = inputs[0].data().dptr<DType>();
+    dim_t input_size   = inputs[0].shape().Size();
+    const int nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
     if (param.return_index || param.return_inverse || param.return_counts) {
       // argsort, result in perm
       std::vector<dim_t> perm(input_size);
       std::iota(perm.begin(), perm.end(), 0);
-      std::stable_sort(perm.begin(), perm.end(), [&input_data](dim_t i1, dim_t i2) {
-        return input_data[i1] < input_data[i2];
-      });
+      common::ParallelStableSort(
+          perm.begin(), perm.end(), nthreads, [&input_data](dim_t i1, dim_t i2) {
+            return input_data[i1] < input_data[i2];
+          });
       // sorted data in aux
       std::vector<DType> aux(input_size);
       mxnet_op::Kernel<UniqueComputeAuxCPUKernel, cpu>::Launch(
@@ -167,10 +169,12 @@ void NumpyUniqueCPUNoneAxisImpl(const NumpyUniqueParam& param,
             stream, valid_num, unique_counts, idx.data());
       }
     } else {
-      std::set<DType> set(input_data, input_data + input_size);
-      mxnet::TShape s(1, set.size());
+      std::vector<DType> sorted(input_data, input_data + input_size);
+      common::ParallelSort(sorted.begin(), sorted.end(), nthreads);
+      sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+      mxnet::TShape s(1, sorted.size());
       const_cast<NDArray&>(outputs[0]).Init(s);
-      std::copy(set.begin(), set.end(), outputs[0].data().dptr<DType>());
+      std::copy(sorted.begin(), sorted.end(), outputs[0].data().dptr<DType>());
     }
   });
 }
@@ -206,7 +210,8 @@ void NumpyUniqueCPUImpl(const NumpyUniqueParam& param,
     // argsort, result in perm
     std::vector<dim_t> perm(temp_shape[0]);
     std::iota(perm.begin(), perm.end(), 0);
-    std::stable_sort(perm.begin(), perm.end(), [&](dim_t a, dim_t b) -> bool {
+    const int nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+    common::ParallelStableSort(perm.begin(), perm.end(), nthreads, [&](dim_t a, dim_t b) -> bool {
       for (dim_t i = 0; i < numel; ++i) {
         DType lhs = input_data[i + a * numel];
         DType rhs = input_data[i + b * numel];
@@ -363,6 +368,54 @@ void NumpyUniqueCPUForward(const nnvm::NodeAttrs& attrs,
   }
 }
 
+template <>
+void NumpyUniquePaddedForward<cpu>(const nnvm::NodeAttrs& attrs,
+                                   const OpContext& ctx,
+                                   const std::vector<TBlob>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& outputs) {
+  CHECK_EQ(inputs.size(), 1U);
+  const NumpyUniqueParam& param = nnvm::get<NumpyUniqueParam>(attrs.parsed);
+  const dim_t input_size        = inputs[0].Size();
+  MSHADOW_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    const DType* input_data = inputs[0].dptr<DType>();
+    DType* unique_data      = outputs[0].dptr<DType>();
+    // the optional outputs follow the unique values
+    int output_flag       = 0;
+    dim_t* unique_indices = param.return_index ? outputs[++output_flag].dptr<dim_t>() : nullptr;
+    dim_t* unique_inverse = param.return_inverse ? outputs[++output_flag].dptr<dim_t>() : nullptr;
+    dim_t* unique_counts  = param.return_counts ? outputs[++output_flag].dptr<dim_t>() : nullptr;
+    std::fill(unique_data, unique_data + input_size, DType(0));
+    if (unique_indices)
+      std::fill(unique_indices, unique_indices + input_size, 0);
+    if (unique_counts)
+      std::fill(unique_counts, unique_counts + input_size, 0);
+    // argsort, the first index of each unique value being kept by the stable sort
+    std::vector<dim_t> perm(input_size);
+    std::iota(perm.begin(), perm.end(), 0);
+    const int nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+    common::ParallelStableSort(
+        perm.begin(), perm.end(), nthreads, [&input_data](dim_t i1, dim_t i2) {
+          return input_data[i1] < input_data[i2];
+        });
+    dim_t valid_num = 0;
+    for (dim_t i = 0; i < input_size; ++i) {
+      const dim_t j = perm[i];
+      if (i == 0 || input_data[perm[i - 1]] < input_data[j]) {
+        unique_data[valid_num] = input_data[j];
+        if (unique_indices)
+          unique_indices[valid_num] = j;
+        ++valid_num;
+      }
+      if (unique_inverse)
+        unique_inverse[j] = valid_num - 1;
+      if (unique_counts)
+        ++unique_counts[valid_num - 1];
+    }
+    *outputs.back().dptr<int64_t>() = valid_num;
+  });
+}
+
 DMLC_REGISTER_PARAMETER(NumpyUniqueParam);
 
 NNVM_REGISTER_OP(_npi_unique)
@@ -394,5 +447,31 @@ NNVM_REGISTER_OP(_npi_unique)
     .add_argument("data", "NDArray-or-Symbol", "The input array")
     .add_arguments(NumpyUniqueParam::__FIELDS__());
 
+NNVM_REGISTER_OP(_npx_unique_padded)
+    .describe(R"code(Find the sorted unique values of the flattened data, like unique, into an
+output of the size of data followed by zeros. The optional indices and counts of the unique
+values are padded with zeros likewise, and the number of unique values is returned as a last
+output of shape (1,).
+
+Since the shapes of its outputs do not depend on the values of data, the operator does not wait
+for data to be computed, and may be hybridized with static shapes and captured in CUDA graphs.
+)code" ADD_FILELINE)
+    .set_attr_parser(ParamParser<NumpyUniqueParam>)
+    .set_num_inputs(1)
+    .set_num_outputs([](const NodeAttrs& attrs) {
+      const NumpyUniqueParam& param = nnvm::get<NumpyUniqueParam>(attrs.parsed);
+      return 2 + param.return_index + param.return_inverse + param.return_counts;
+    })
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data"};
+                                     })
+    .set_attr<mxnet::FInferShape>("FInferShape", NumpyUniquePaddedShape)
+    .set_attr<nnvm::FInferType>("FInferType", NumpyUniqueType)
+    .set_attr<FCompute>("FCompute<cpu>", NumpyUniquePaddedForward<cpu>)
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .add_argument("data", "NDArray-or-Symbol", "The input array")
+    .add_arguments(NumpyUniqueParam::__FIELDS__());
+
 }  // namespace op
 }  // namespace mxnet
@@ -388,7 +388,111 @@ void NumpyUniqueGPUForward(const nnvm::NodeAttrs& attrs,
   }
 }
 
+template <>
+void NumpyUniquePaddedForward<gpu>(const nnvm::NodeAttrs& attrs,
+                                   const OpContext& ctx,
+                                   const std::vector<TBlob>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  CHECK_EQ(inputs.size(), 1U);
+  const NumpyUniqueParam& param = nnvm::get<NumpyUniqueParam>(attrs.parsed);
+  Stream<gpu>* s                = ctx.get_stream<gpu>();
+  cudaStream_t stream           = Stream<gpu>::GetStream(s);
+  const dim_t input_size        = inputs[0].Size();
+  int64_t* valid_num            = outputs.back().dptr<int64_t>();
+  if (input_size == 0) {
+    CUDA_CALL(cudaMemsetAsync(valid_num, 0, sizeof(int64_t), stream));
+    return;
+  }
+  MXNET_NO_FLOAT16_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    const DType* input_data = inputs[0].dptr<DType>();
+    // cub sorts and scans without synchronizing the stream, unlike thrust
+    size_t sort_bytes = 0, scan_bytes = 0;
+    cub::DeviceRadixSort::SortPairs(nullptr,
+                                    sort_bytes,
+                                    input_data,
+                                    static_cast<DType*>(nullptr),
+                                    static_cast<dim_t*>(nullptr),
+                                    static_cast<dim_t*>(nullptr),
+                                    input_size,
+                                    0,
+                                    sizeof(DType) * 8,
+                                    stream);
+    cub::DeviceScan::InclusiveSum(nullptr,
+                                  scan_bytes,
+                                  static_cast<int32_t*>(nullptr),
+                                  static_cast<int32_t*>(nullptr),
+                                  input_size,
+                                  stream);
+    // workspace: the sequence, the permutation sorting the data, the starts of the unique
+    // values, the sorted data, the prefix sum of the unique flags and the temp space of cub
+    auto aligned      = [](size_t bytes) { return (bytes + 7) / 8 * 8; };
+    size_t dim_bytes  = input_size * sizeof(dim_t);
+    size_t data_bytes = aligned(input_size * sizeof(DType));
+    size_t sum_bytes  = aligned(input_size * sizeof(int32_t));
+    size_t temp_bytes = std::max(sort_bytes, scan_bytes);
+
+    Tensor<gpu, 1, char> workspace = ctx.requested[0].get_space_typed<gpu, 1, char>(
+        Shape1(3 * dim_bytes + data_bytes + sum_bytes + temp_bytes), s);
+    dim_t* sequence     = reinterpret_cast<dim_t*>(workspace.dptr_);
+    dim_t* perm         = sequence + input_size;
+    dim_t* starts       = perm + input_size;
+    DType* sorted       = reinterpret_cast<DType*>(workspace.dptr_ + 3 * dim_bytes);
+    int32_t* prefix_sum = reinterpret_cast<int32_t*>(workspace.dptr_ + 3 * dim_bytes + data_bytes);
+    void* temp_storage  = workspace.dptr_ + 3 * dim_bytes + data_bytes + sum_bytes;
+    // argsort, the first index of each unique value being kept by the stable radix sort
+    Kernel<range_fwd, gpu>::Launch(
+        s, input_size, 1, dim_t(0), dim_t(1), static_cast<int>(kWriteTo), sequence);
+    cub::DeviceRadixSort::SortPairs(temp_storage,
+                                    sort_bytes,
+                                    input_data,
+                                    sorted,
+                                    sequence,
+                                    perm,
+                                    input_size,
+                                    0,
+                                    sizeof(DType) * 8,
+                                    stream);
+    Kernel<UniquePaddedFlagKernel, gpu>::Launch(s, input_size, prefix_sum, sorted);
+    cub::DeviceScan::InclusiveSum(
+        temp_storage, scan_bytes, prefix_sum, prefix_sum, input_size, stream);
+    // compact the unique values and their indices, reusing the boolean_mask kernel
+    Kernel<set_zero, gpu>::Launch(s, input_size, outputs[0].dptr<DType>());
+    Kernel<BooleanMaskForwardKernel, gpu>::Launch(
+        s, input_size, outputs[0].dptr<DType>(), sorted, prefix_sum, 1);
+    int output_flag = 0;
+    if (param.return_index) {
+      output_flag += 1;
+      dim_t* unique_indices = outputs[output_flag].dptr<dim_t>();
+      Kernel<set_zero, gpu>::Launch(s, input_size, unique_indices);
+      Kernel<BooleanMaskForwardKernel, gpu>::Launch(
+          s, input_size, unique_indices, perm, prefix_sum, 1);
+    }
+    if (param.return_inverse) {
+      output_flag += 1;
+      Kernel<UniqueReturnInverseKernel, gpu>::Launch(
+          s, input_size, outputs[output_flag].dptr<dim_t>(), prefix_sum, perm);
+    }
+    if (param.return_counts) {
+      output_flag += 1;
+      Kernel<UniquePaddedStartKernel, gpu>::Launch(s, input_size, starts, prefix_sum);
+      Kernel<UniquePaddedCountsKernel, gpu>::Launch(
+          s, input_size, outputs[output_flag].dptr<dim_t>(), starts, prefix_sum, input_size);
+    }
+    Kernel<MaskValidNumKernel, gpu>::Launch(s, 1, valid_num, prefix_sum, input_size);
+  });
+}
+
 NNVM_REGISTER_OP(_npi_unique).set_attr<FComputeEx>("FComputeEx<gpu>", NumpyUniqueGPUForward);
 
+NNVM_REGISTER_OP(_npx_unique_padded)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<gpu>", NumpyUniquePaddedForward<gpu>);
+
 }  // namespace op
 }  // namespace mxnet
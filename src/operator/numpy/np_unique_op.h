@@ -34,6 +34,7 @@
 #include "../operator_common.h"
 #include "../mshadow_op.h"
 #include "../contrib/boolean_mask-inl.h"
+#include "../../common/utils.h"
 #ifdef __CUDACC__
 #include <thrust/device_ptr.h>
 #include <thrust/device_vector.h>
@@ -92,6 +93,67 @@ struct NumpyUniqueParam : public dmlc::Parameter<NumpyUniqueParam> {
   }
 };
 
+struct UniquePaddedFlagKernel {
+  // flags the first of each run of equal values of the sorted data
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(dim_t i, int32_t* flag, const DType* sorted) {
+    flag[i] = (i == 0 || sorted[i - 1] < sorted[i]) ? 1 : 0;
+  }
+};
+
+struct UniquePaddedStartKernel {
+  MSHADOW_XINLINE static void Map(dim_t i, dim_t* starts, const int32_t* prefix_sum) {
+    if (i == 0 || prefix_sum[i] != prefix_sum[i - 1]) {
+      starts[prefix_sum[i] - 1] = i;
+    }
+  }
+};
+
+struct UniquePaddedCountsKernel {
+  // the counts past the number of unique values are 0
+  MSHADOW_XINLINE static void Map(dim_t i,
+                                  dim_t* unique_counts,
+                                  const dim_t* starts,
+                                  const int32_t* prefix_sum,
+                                  const dim_t size) {
+    const dim_t valid_num = prefix_sum[size - 1];
+    if (i < valid_num) {
+      unique_counts[i] = (i + 1 < valid_num ? starts[i + 1] : size) - starts[i];
+    } else {
+      unique_counts[i] = 0;
+    }
+  }
+};
+
+inline bool NumpyUniquePaddedShape(const nnvm::NodeAttrs& attrs,
+                                   mxnet::ShapeVector* in_attrs,
+                                   mxnet::ShapeVector* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 1U);
+  const NumpyUniqueParam& param = nnvm::get<NumpyUniqueParam>(attrs.parsed);
+  CHECK(!param.axis.has_value()) << "unique_padded only supports axis=None";
+  SHAPE_ASSIGN_CHECK(*out_attrs, out_attrs->size() - 1, mxnet::TShape(1, 1));
+  if (!shape_is_known(in_attrs->at(0)))
+    return false;
+  // the input is flattened, the inverse indices having its size too
+  for (size_t i = 0; i + 1 < out_attrs->size(); ++i) {
+    SHAPE_ASSIGN_CHECK(*out_attrs, i, mxnet::TShape(1, in_attrs->at(0).Size()));
+  }
+  return true;
+}
+
+/*!
+ * \brief The padded unique of the flattened input writes the sorted unique values, and their
+ *  indices and counts, into outputs of the size of the input followed by zeros, and the number
+ *  of unique values into a last output on the device, so that it does not wait for the input
+ *  to size its outputs.
+ */
+template <typename xpu>
+void NumpyUniquePaddedForward(const nnvm::NodeAttrs& attrs,
+                              const OpContext& ctx,
+                              const std::vector<TBlob>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<TBlob>& outputs);
+
 }  // namespace op
 }  // namespace mxnet
 
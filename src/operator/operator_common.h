@@ -712,6 +712,44 @@ class ParamOpSign : public OpSignature {
   }
 };
 
+/*! \brief bytes of the blobs, each one read or written once */
+inline double BlobBytes(const std::vector<TBlob>& blobs) {
+  double bytes = 0;
+  for (const TBlob& blob : blobs) {
+    bytes += static_cast<double>(blob.Size()) * mshadow::mshadow_sizeof(blob.type_flag_);
+  }
+  return bytes;
+}
+
+/*!
+ * \brief FOpCost of elementwise, broadcast and reduction operators: one operation per element
+ *  of the largest tensor, each tensor read or written once
+ */
+inline OpCost ElemwiseCost(const nnvm::NodeAttrs& attrs,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<TBlob>& outputs) {
+  OpCost cost;
+  for (const auto* blobs : {&inputs, &outputs}) {
+    for (const TBlob& blob : *blobs) {
+      cost.flops = std::max(cost.flops, static_cast<double>(blob.Size()));
+    }
+  }
+  cost.bytes = BlobBytes(inputs) + BlobBytes(outputs);
+  return cost;
+}
+
+/*!
+ * \brief FOpCost of matrix products doing macs multiply-adds, each tensor read or written once
+ */
+inline OpCost MatMulCost(double macs,
+                         const std::vector<TBlob>& inputs,
+                         const std::vector<TBlob>& outputs) {
+  OpCost cost;
+  cost.flops = 2 * macs;
+  cost.bytes = BlobBytes(inputs) + BlobBytes(outputs);
+  return cost;
+}
+
 }  // namespace op
 }  // namespace mxnet
 #endif  // MXNET_OPERATOR_OPERATOR_COMMON_H_
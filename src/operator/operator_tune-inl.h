@@ -30,10 +30,13 @@
 #include <vector>
 #include <algorithm>
 #include <list>
+#include <mutex>
 #include <random>
+#include <unordered_map>
 #include <unordered_set>
 #include "./mxnet_op.h"
 #include "./operator_tune.h"
+#include "../initialize.h"
 
 #if (__GNUC__ >= 4 || (__GNUC__ >= 3 && __GNUC_MINOR__ >= 4)) && !defined(__mips__)
 #define HAS_CXA_DEMANGLE 1
@@ -78,6 +81,80 @@ inline const char* TuningModeToString(const TuningMode tm) {
       return "<unknown>";
   }
 }
+
+/*!
+ * \brief Number of cores the OMP overhead is measured with
+ * \return MXNET_USE_NUM_CORES_OPERATOR_TUNING, by default half of the processors
+ */
+inline size_t NumTuningCores() {
+  const auto max_cores_default = static_cast<size_t>(omp_get_num_procs()) >> 1;
+  return dmlc::GetEnv("MXNET_USE_NUM_CORES_OPERATOR_TUNING", max_cores_default);
+}
+
+/*!
+ * \brief Tuning results cached across runs, so that later process starts skip the timing
+ *        loops. The cache of the process is a file in MXNET_OPERATOR_TUNING_CACHE_DIR, one per
+ *        host key: the CPU model, the number of cores used for tuning and the settings that
+ *        change the results. Workloads missing from the file are measured and added to it.
+ *        Set MXNET_OPERATOR_TUNING_CACHE_REFRESH=1 to measure everything again.
+ */
+class TuningCache {
+ public:
+  /*! \brief Values of this cache are saved under the given host key */
+  explicit TuningCache(std::string key = HostKey()) : key_(std::move(key)) {}
+
+  /*!
+   * \brief The cache of the process, loaded from its file in MXNET_OPERATOR_TUNING_CACHE_DIR
+   * \return Pointer to the cache, never destroyed
+   */
+  static TuningCache* Get();
+
+  /*!
+   * \brief Key of the tuning results of this host
+   * \return CPU model, tuning cores, processors, weight scale and version as one string
+   */
+  static std::string HostKey();
+
+  /*!
+   * \brief Get a cached value
+   * \param name Name of the value, demangled tuned kernel type for workloads
+   * \param value Receives the value if it is cached
+   * \return true if the value is cached
+   */
+  bool Lookup(const std::string& name, int64_t* value);
+
+  /*!
+   * \brief Cache a measured value, saved by the next Flush()
+   */
+  void Store(const std::string& name, int64_t value);
+
+  /*!
+   * \brief Load the values of a cache file saved with the same key
+   * \return false if the file cannot be read or has another key
+   */
+  bool Load(const std::string& path);
+
+  /*!
+   * \brief Save all values, replacing the file atomically
+   * \return false if the file cannot be written
+   */
+  bool Save(const std::string& path);
+
+  /*!
+   * \brief Save the cache of the process to its file if new values were stored
+   */
+  void Flush();
+
+ private:
+  /*! \brief key the values are valid for */
+  const std::string key_;
+  /*! \brief cache file, empty when caching is disabled */
+  std::string path_;
+  /*! \brief whether values were stored since the last load or save */
+  bool dirty_ = false;
+  std::mutex mutex_;
+  std::unordered_map<std::string, int64_t> values_;
+};
 }  // namespace tune
 
 /*!
@@ -113,7 +190,19 @@ class OperatorTune : public OperatorTuneByType<DType> {
    * \brief Constructor
    */
   OperatorTune() {
-    TuneAll();
+    // In lazy mode the kernels are tuned by their first UseOMP() call instead
+    if (!LazyTuning()) {
+      TuneAll();
+    }
+  }
+
+  /*!
+   * \brief Whether the kernels are tuned when they are first launched instead of at library load
+   * \return true if MXNET_LAZY_INIT is set
+   */
+  static bool LazyTuning() {
+    static const bool lazy = dmlc::GetEnv("MXNET_LAZY_INIT", false);
+    return lazy;
   }
 
   /*!
@@ -171,8 +260,10 @@ class OperatorTune : public OperatorTuneByType<DType> {
         // disabled
         if (!config.empty() && ::isdigit(config[0]) && std::atoi(config.c_str()) == 0) {
           OperatorTuneBase::omp_overhead_ns_ = INT_MAX;
-        } else {
+        } else if (!tune::TuningCache::Get()->Lookup("omp_overhead_ns",
+                                                     &OperatorTuneBase::omp_overhead_ns_)) {
           OperatorTuneBase::omp_overhead_ns_ = GetOMPLoopOverhead();
+          tune::TuningCache::Get()->Store("omp_overhead_ns", OperatorTuneBase::omp_overhead_ns_);
         }
         ParseEnablerConfig(config);
       }
@@ -188,13 +279,19 @@ class OperatorTune : public OperatorTuneByType<DType> {
    * \brief Schedule a tuning run
    * \tparam OP Operator to tune
    * \param tune_func Function to call which tunes the operator
+   * \param workload The workload_ of the tuned_op, in lazy mode the run is deferred until it is
+   *        first needed
    * \return true if the tune operation was scheduled
    */
   template <typename OP>
-  static bool ScheduleTune(void (*tune_func)()) {
+  static bool ScheduleTune(void (*tune_func)(), const void* workload = nullptr) {
 #ifdef MXNET_USE_OPERATOR_TUNING
     if (tune_func) {
-      GetTuningList()->push_back(tune_func);
+      if (workload && LazyTuning()) {
+        (*GetPendingTunes())[workload] = tune_func;
+      } else {
+        GetTuningList()->push_back(tune_func);
+      }
       operator_names_.insert(demangle(typeid(OP).name()));
       return true;
     }
@@ -235,16 +332,46 @@ class OperatorTune : public OperatorTuneByType<DType> {
     for (auto i : *tl) {
       (*i)();
     }
+    for (const auto& pending : *GetPendingTunes()) {
+      (*pending.second)();
+    }
     if (OperatorTuneBase::verbose_tuning_info_) {
       const duration_t duration = OperatorTune::GetDurationInNanoseconds(start);
       LOG(INFO) << "Op Tuning  for " << type_name<DType>() << " took " << (duration / 1000000)
                 << " ms";
     }
+    LibraryInitializer::Get()->record_startup_phase("operator tuning for " + type_name<DType>(),
+                                                    start);
     CHECK_EQ(size_save, tl->size()) << "Tuning list size should not have changed while tuning";
     tl->clear();
+    GetPendingTunes()->clear();
+    tune::TuningCache::Get()->Flush();
     return true;
   }
 
+  /*!
+   * \brief Run the deferred tuning of a kernel, done by its first UseOMP() call in lazy mode
+   * \param workload The workload_ of the tuned_op the tuning run was scheduled for
+   */
+  static void TuneOnFirstUse(const void* workload) {
+    std::lock_guard<std::mutex> lock(OperatorTuneBase::lazy_tuning_mutex_);
+    Initialize();
+    // the kernels scheduled without a workload can't be told apart, they run with the first one
+    std::list<void (*)()>* tl = GetTuningList();
+    for (auto i : *tl) {
+      (*i)();
+    }
+    tl->clear();
+    auto* pending = GetPendingTunes();
+    auto it       = pending->find(workload);
+    if (it != pending->end()) {
+      void (*tune_func)() = it->second;
+      pending->erase(it);
+      (*tune_func)();
+      tune::TuningCache::Get()->Flush();
+    }
+  }
+
   /*!
    * \brief Return set of operator names that were registered to be tuned. Does not imply
    *        that the operator has been tuned.
@@ -261,6 +388,12 @@ class OperatorTune : public OperatorTuneByType<DType> {
    */
   static std::list<void (*)()>* GetTuningList();
 
+  /*!
+   * \brief Get the tuning runs deferred in lazy mode, by the workload_ of their tuned_op
+   * \return Pointer to map of the tuning function calls
+   */
+  static std::unordered_map<const void*, void (*)()>* GetPendingTunes();
+
   /*!
    * \brief Demangle typeid::name() in order to generate source macros
    * \param name C++ Mangled name
@@ -287,6 +420,23 @@ class OperatorTune : public OperatorTuneByType<DType> {
     return demangle(typeid(T).name());
   }
 
+  /*!
+   * \brief Workload of a tuned kernel from the tuning cache, measured if it is not cached
+   * \tparam TunedOP The tuned_op whose workload it is, its type name is the cache key
+   * \param measure Function measuring the workload
+   * \return Duration in nanoseconds for the 'WORKLOAD_COUNT' operations
+   */
+  template <typename TunedOP>
+  static duration_t CachedWorkload(duration_t (*measure)()) {
+    const std::string name = type_name<TunedOP>();
+    duration_t workload;
+    if (!tune::TuningCache::Get()->Lookup(name, &workload)) {
+      workload = measure();
+      tune::TuningCache::Get()->Store(name, workload);
+    }
+    return workload;
+  }
+
   /*! \brief Measure OMP overhead for a trivial OMP loop using all cores
    * \param omp_thread_count - Number of OMP threads to use in the timing test
    * \returns Duration in nanoseconds for the OMP overhead (time to initiate and close the
@@ -357,8 +507,7 @@ class OperatorTune : public OperatorTuneByType<DType> {
   static duration_t GetOMPLoopOverhead() {
     // It was found empirically that OMP times was not heavily tied to number of cores,
     // so take an average across all core counts
-    const auto max_cores_default = static_cast<size_t>(omp_get_num_procs()) >> 1;
-    const auto max_cores = dmlc::GetEnv("MXNET_USE_NUM_CORES_OPERATOR_TUNING", max_cores_default);
+    const size_t max_cores = tune::NumTuningCores();
     if (max_cores >= 2) {
       std::vector<duration_t> core_times;
       // Take care of any OMP lazy-init with a throwaway call
@@ -647,7 +796,8 @@ class UnaryOpTune : public OperatorTune<DType> {
    */
   template <typename OP>
   static void TuneBlankOperator() {
-    mxnet::op::mxnet_op::tuned_op<OP, DType>::workload_[0] = GetBlankWorkload<OP>();
+    using TunedOP = mxnet::op::mxnet_op::tuned_op<OP, DType>;
+    TunedOP::workload_[0] = Super::template CachedWorkload<TunedOP>(&GetBlankWorkload<OP>);
     if (Super::output_tuning_data_) {
       std::cout << "IMPLEMENT_UNARY_WORKLOAD_FWD(" << Super::template type_name<OP>()
                 << ");  // NOLINT()" << std::endl
@@ -663,7 +813,8 @@ class UnaryOpTune : public OperatorTune<DType> {
    */
   template <typename OP>
   static void TuneUnaryOperator() {
-    mxnet::op::mxnet_op::tuned_op<OP, DType>::workload_[0] = GetUnaryWorkload<OP>();
+    using TunedOP = mxnet::op::mxnet_op::tuned_op<OP, DType>;
+    TunedOP::workload_[0] = Super::template CachedWorkload<TunedOP>(&GetUnaryWorkload<OP>);
     if (Super::output_tuning_data_) {
       std::cout << "IMPLEMENT_UNARY_WORKLOAD_FWD(" << Super::template type_name<OP>()
                 << ");  // NOLINT()" << std::endl
@@ -679,8 +830,9 @@ class UnaryOpTune : public OperatorTune<DType> {
    */
   template <typename OP>
   static void TuneUnaryBackwardOperator() {
-    mxnet::op::mxnet_op::tuned_op<mxnet_op::backward_grad_tuned<OP>, DType>::workload_[0] =
-        GetBinaryWorkload<mxnet::op::mxnet_op::backward_grad_tuned<OP>>();
+    using TunedOP = mxnet::op::mxnet_op::tuned_op<mxnet_op::backward_grad_tuned<OP>, DType>;
+    TunedOP::workload_[0] = Super::template CachedWorkload<TunedOP>(
+        &GetBinaryWorkload<mxnet::op::mxnet_op::backward_grad_tuned<OP>>);
     if (Super::output_tuning_data_) {
       std::cout << "IMPLEMENT_UNARY_WORKLOAD_BWD(" << Super::template type_name<OP>()
                 << ");  // NOLINT()" << std::endl
@@ -697,7 +849,8 @@ class UnaryOpTune : public OperatorTune<DType> {
    */
   template <typename OP>
   static void TuneBlankOperatorEx() {
-    mxnet::op::mxnet_op::tuned_op<OP, DType>::workload_[0] = GetBlankWorkloadEx<OP>();
+    using TunedOP = mxnet::op::mxnet_op::tuned_op<OP, DType>;
+    TunedOP::workload_[0] = Super::template CachedWorkload<TunedOP>(&GetBlankWorkloadEx<OP>);
     if (Super::output_tuning_data_) {
       std::cout << "IMPLEMENT_BLANK_WORKLOAD_FWD(" << Super::template type_name<OP>()
                 << ");  // NOLINT()" << std::endl
@@ -715,6 +868,13 @@ class UnaryOpTune : public OperatorTune<DType> {
    */
   template <typename OP>
   inline static bool UseOMP(size_t N, size_t thread_count) {
+#ifdef MXNET_USE_OPERATOR_TUNING
+    static std::atomic<bool> tuned(!Super::LazyTuning());
+    if (!tuned.load(std::memory_order_acquire)) {
+      Super::TuneOnFirstUse(&OP::workload_);
+      tuned.store(true, std::memory_order_release);
+    }
+#endif
     return OperatorTune<DType>::UseOMP(
         N, thread_count, static_cast<uint64_t>(N) * OP::workload_[0]);
   }
@@ -736,7 +896,9 @@ class BinaryOpTune : public UnaryOpTune<DType> {
    */
   template <typename OP>
   static void TuneBinaryOperator() {
-    mxnet_op::tuned_op<OP, DType>::workload_[0] = Super::template GetBinaryWorkload<OP>();
+    using TunedOP = mxnet_op::tuned_op<OP, DType>;
+    TunedOP::workload_[0] =
+        Super::Super::template CachedWorkload<TunedOP>(&Super::template GetBinaryWorkload<OP>);
     if (Super::Super::output_tuning_data_) {
       std::cout << "IMPLEMENT_BINARY_WORKLOAD_FWD(" << Super::template type_name<OP>()
                 << ");  // NOLINT()" << std::endl
@@ -750,8 +912,9 @@ class BinaryOpTune : public UnaryOpTune<DType> {
    */
   template <typename OP>
   static void TuneBinaryBackwardOperator() {
-    mxnet::op::mxnet_op::tuned_op<mxnet_op::backward_grad_tuned<OP>, DType>::workload_[0] =
-        Super::template GetTertiaryWorkload<mxnet::op::mxnet_op::backward_grad_tuned<OP>>();
+    using TunedOP = mxnet::op::mxnet_op::tuned_op<mxnet_op::backward_grad_tuned<OP>, DType>;
+    TunedOP::workload_[0] = Super::Super::template CachedWorkload<TunedOP>(
+        &Super::template GetTertiaryWorkload<mxnet::op::mxnet_op::backward_grad_tuned<OP>>);
     if (Super::Super::output_tuning_data_) {
       std::cout << "IMPLEMENT_BINARY_WORKLOAD_BWD(" << Super::template type_name<OP>()
                 << ");  // NOLINT()" << std::endl
@@ -18,6 +18,13 @@
  */
 #include <cfloat>
 #include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
 #include "./mxnet_op.h"
 #include "./mshadow_op.h"
 #include "./tensor/init_op.h"
@@ -33,6 +40,151 @@ namespace op {
 std::atomic<bool> OperatorTuneBase::calculated_(false);
 bool OperatorTuneBase::verbose_tuning_info_   = false;
 double OperatorTuneBase::tuning_weight_scale_ = 0.0;
+std::mutex OperatorTuneBase::lazy_tuning_mutex_;
+
+namespace tune {
+
+namespace {
+
+constexpr char kCacheHeader[] = "# MXNet operator tuning cache";
+
+/*! \brief FNV-1a, stable across runs and builds unlike std::hash */
+uint64_t StableHash(const std::string& s) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const unsigned char c : s) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+std::string CPUModel() {
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    if (line.compare(0, 10, "model name") == 0) {
+      const size_t colon = line.find(':');
+      if (colon != std::string::npos) {
+        std::string model = line.substr(colon + 1);
+        model.erase(0, model.find_first_not_of(" \t"));
+        return model;
+      }
+    }
+  }
+  return "unknown";
+}
+
+}  // namespace
+
+TuningCache* TuningCache::Get() {
+  static TuningCache* inst = []() {
+    TuningCache* cache    = new TuningCache();
+    const std::string dir = dmlc::GetEnv("MXNET_OPERATOR_TUNING_CACHE_DIR", std::string());
+    if (!dir.empty()) {
+#if !defined(_WIN32)
+      mkdir(dir.c_str(), 0755);
+#endif
+      char name[17];
+      snprintf(
+          name, sizeof(name), "%016llx", static_cast<unsigned long long>(StableHash(cache->key_)));
+      cache->path_ = dir + "/operator_tuning_" + name + ".txt";
+      if (!dmlc::GetEnv("MXNET_OPERATOR_TUNING_CACHE_REFRESH", false) &&
+          cache->Load(cache->path_) && dmlc::GetEnv("MXNET_VERBOSE_TUNING_INFO", false)) {
+        LOG(INFO) << "Loaded " << cache->values_.size() << " tuning results from "
+                  << cache->path_;
+      }
+    }
+    return cache;
+  }();
+  return inst;
+}
+
+std::string TuningCache::HostKey() {
+  std::ostringstream os;
+  os << "cpu=" << CPUModel() << ";cores=" << NumTuningCores() << ";procs=" << omp_get_num_procs()
+     << ";weight_scale=" << dmlc::GetEnv("MXNET_TUNING_WEIGHT_SCALE", 0.0)
+     << ";version=" << MXNET_VERSION;
+  return os.str();
+}
+
+bool TuningCache::Lookup(const std::string& name, int64_t* value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = values_.find(name);
+  if (it == values_.end()) {
+    return false;
+  }
+  *value = it->second;
+  return true;
+}
+
+void TuningCache::Store(const std::string& name, int64_t value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  values_[name] = value;
+  dirty_        = true;
+}
+
+bool TuningCache::Load(const std::string& path) {
+  std::ifstream f(path);
+  std::string header, key;
+  if (!std::getline(f, header) || header != kCacheHeader || !std::getline(f, key) ||
+      key != "key=" + key_) {
+    return false;
+  }
+  std::unordered_map<std::string, int64_t> values;
+  int64_t value;
+  std::string name;
+  while (f >> value && std::getline(f, name)) {
+    const size_t start = name.find_first_not_of(' ');
+    if (start == std::string::npos) {
+      break;
+    }
+    values[name.substr(start)] = value;
+  }
+  if (!f.eof()) {
+    LOG(WARNING) << "Ignoring the invalid operator tuning cache " << path;
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& entry : values) {
+    values_.insert(std::move(entry));
+  }
+  return true;
+}
+
+bool TuningCache::Save(const std::string& path) {
+  // written under a temporary name and renamed, so concurrent processes never read a
+  // partial cache
+  const std::string tmp_path = path + ".tmp" + std::to_string(std::random_device()());
+  {
+    std::ofstream f(tmp_path);
+    f << kCacheHeader << "\n"
+      << "key=" << key_ << "\n";
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : values_) {
+      f << entry.second << " " << entry.first << "\n";
+    }
+    if (!f) {
+      LOG(WARNING) << "Could not write the operator tuning cache " << path;
+      f.close();
+      std::remove(tmp_path.c_str());
+      return false;
+    }
+    dirty_ = false;
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+void TuningCache::Flush() {
+  if (!path_.empty() && dirty_) {
+    Save(path_);
+  }
+}
+
+}  // namespace tune
 
 /*!
  * \brief Instantiate static variables for OperatorTune<DType>, where 'DType' is specified
@@ -54,6 +206,12 @@ double OperatorTuneBase::tuning_weight_scale_ = 0.0;
   std::list<void (*)()>* OperatorTune<__typ$>::GetTuningList() {                    \
     static std::list<void (*)()> ll;                                                \
     return &ll;                                                                     \
+  }                                                                                 \
+  template <>                                                                       \
+  std::unordered_map<const void*, void (*)()>*                                      \
+      OperatorTune<__typ$>::GetPendingTunes() {                                     \
+    static std::unordered_map<const void*, void (*)()> pending;                     \
+    return &pending;                                                                \
   }
 
 /*!
@@ -138,7 +296,8 @@ struct static_init_var {
   template <>                                                                                 \
   bool static_init_var<__op$, __typ$>::init_ =                                                \
       ::mxnet::op::OperatorTune<__typ$>::ScheduleTune<__op$>(                                 \
-          ::mxnet::op::UnaryOpTune<__typ$>::TuneBlankOperatorEx<__op$>)
+          ::mxnet::op::UnaryOpTune<__typ$>::TuneBlankOperatorEx<__op$>,                       \
+          &::mxnet::op::mxnet_op::tuned_op<__op$, __typ$>::workload_)
 
 /*!
  * \brief Implement tuning objects for a forward unary kernel operator
@@ -155,7 +314,8 @@ struct static_init_var {
   template <>                                                                                 \
   bool static_init_var<__op$, __typ$>::init_ =                                                \
       ::mxnet::op::OperatorTune<__typ$>::ScheduleTune<__op$>(                                 \
-          ::mxnet::op::UnaryOpTune<__typ$>::TuneUnaryOperator<__op$>)
+          ::mxnet::op::UnaryOpTune<__typ$>::TuneUnaryOperator<__op$>,                         \
+          &::mxnet::op::mxnet_op::tuned_op<__op$, __typ$>::workload_)
 
 /*!
  * \brief Implement tuning objects for a backward unary kernel operator
@@ -174,7 +334,9 @@ struct static_init_var {
   template <>                                                                                   \
   bool static_init_var<::mxnet::op::mxnet_op::backward_grad_tuned<__op$>, __typ$>::init_ =      \
       ::mxnet::op::OperatorTune<__typ$>::ScheduleTune<__op$>(                                   \
-          ::mxnet::op::UnaryOpTune<__typ$>::TuneUnaryBackwardOperator<__op$>)
+          ::mxnet::op::UnaryOpTune<__typ$>::TuneUnaryBackwardOperator<__op$>,                   \
+          &::mxnet::op::mxnet_op::tuned_op<::mxnet::op::mxnet_op::backward_grad_tuned<__op$>,   \
+                                           __typ$>::workload_)
 
 /*!
  * \brief Implement tuning objects for a forward binary kernel operator
@@ -191,7 +353,8 @@ struct static_init_var {
   template <>                                                                                 \
   bool static_init_var<__op$, __typ$>::init_ =                                                \
       ::mxnet::op::OperatorTune<__typ$>::ScheduleTune<__op$>(                                 \
-          ::mxnet::op::BinaryOpTune<__typ$>::TuneBinaryOperator<__op$>)
+          ::mxnet::op::BinaryOpTune<__typ$>::TuneBinaryOperator<__op$>,                       \
+          &::mxnet::op::mxnet_op::tuned_op<__op$, __typ$>::workload_)
 
 /*!
  * \brief Implement tuning objects for a backward binary kernel operator
@@ -210,7 +373,9 @@ struct static_init_var {
   template <>                                                                                   \
   bool static_init_var<::mxnet::op::mxnet_op::backward_grad_tuned<__op$>, __typ$>::init_ =      \
       ::mxnet::op::OperatorTune<__typ$>::ScheduleTune<__op$>(                                   \
-          ::mxnet::op::BinaryOpTune<__typ$>::TuneBinaryBackwardOperator<__op$>)
+          ::mxnet::op::BinaryOpTune<__typ$>::TuneBinaryBackwardOperator<__op$>,                 \
+          &::mxnet::op::mxnet_op::tuned_op<::mxnet::op::mxnet_op::backward_grad_tuned<__op$>,   \
+                                           __typ$>::workload_)
 
 /*!
  * \brief Implement tuning objects for a custom forward kernel operator
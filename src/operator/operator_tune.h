@@ -24,6 +24,7 @@
 #include <vector>
 #include <set>
 #include <atomic>
+#include <mutex>
 #include <string>
 
 // #define MXNET_DEBUG_TUNING_LAUNCH
@@ -76,6 +77,8 @@ class OperatorTuneBase {
   static bool verbose_tuning_info_;
   /*! \brief Tuning scale factor */
   static double tuning_weight_scale_;
+  /*! \brief Serializes the tuning runs deferred to the first launch of their kernel */
+  static std::mutex lazy_tuning_mutex_;
 
  public:
   typedef std::chrono::high_resolution_clock::time_point Tick;
@@ -41,6 +41,57 @@ struct CalibrateEntropyParam : public dmlc::Parameter<CalibrateEntropyParam> {
   }
 };
 
+struct CalibHistogramParam : public dmlc::Parameter<CalibHistogramParam> {
+  float max_range;
+  DMLC_DECLARE_PARAMETER(CalibHistogramParam) {
+    DMLC_DECLARE_FIELD(max_range).describe(
+        "The bins split [-max_range, max_range] uniformly, values outside are ignored.");
+  }
+};
+
+/*! \brief bin of a value in the histogram of [-max_range, max_range], -1 if outside */
+MSHADOW_XINLINE int CalibHistogramBin(float data, int num_bins, float max_range) {
+  if (!(data >= -max_range && data <= max_range)) {
+    return -1;
+  }
+  const int bin = static_cast<int>((data + max_range) * num_bins / (2.f * max_range));
+  return bin < num_bins ? bin : num_bins - 1;
+}
+
+/*!
+ * \brief add the counts of the bins of data to hist, counted in integers first so that the float
+ *  bins keep growing past 2^24
+ */
+template <typename xpu>
+void CalibHistogramAccumulate(const OpContext& ctx,
+                              const TBlob& data,
+                              float* hist,
+                              int num_bins,
+                              float max_range);
+
+template <typename xpu>
+void CalibHistogramForward(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<TBlob>& outputs) {
+  const CalibHistogramParam& param = nnvm::get<CalibHistogramParam>(attrs.parsed);
+  CHECK_NE(req[0], kAddTo) << "calib_histogram does not support kAddTo";
+  if (req[0] == kNullOp) {
+    return;
+  }
+  CHECK_GT(param.max_range, 0.f) << "max_range of calib_histogram has to be positive";
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  const TBlob& hist       = inputs[1];
+  const TBlob& out        = outputs[0];
+  // the counts are accumulated in the output, usually the histogram itself
+  if (out.dptr_ != hist.dptr_) {
+    mxnet_op::copy(s, out, hist);
+  }
+  CalibHistogramAccumulate<xpu>(
+      ctx, inputs[0], out.dptr<float>(), static_cast<int>(out.Size()), param.max_range);
+}
+
 }  // namespace op
 }  // namespace mxnet
 #endif  // MXNET_OPERATOR_QUANTIZATION_CALIBRATE_INL_H_
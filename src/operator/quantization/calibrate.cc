@@ -22,13 +22,17 @@
  * \brief
  */
 
+#include <algorithm>
 #include <numeric>
+#include <string>
+#include <utility>
 #include "./calibrate-inl.h"
 
 namespace mxnet {
 namespace op {
 
 DMLC_REGISTER_PARAMETER(CalibrateEntropyParam);
+DMLC_REGISTER_PARAMETER(CalibHistogramParam);
 
 // Given a discrete distribution (may have not been normalized to 1),
 // smooth it by replacing zeros with eps multiplied by a scaling factor and taking the
@@ -86,6 +90,68 @@ static float ComputeEntropy(std::vector<float>* p_ptr, std::vector<float>* q_ptr
   return ret;
 }
 
+// KL divergence between the distribution of a histogram clipped to the 2 * i + 1 bins around
+// its zero bin and the distribution quantized to num_quantized_bins bins.
+static float ThresholdDivergence(const float* hist_ptr,
+                                 const size_t num_bins,
+                                 const index_t num_quantized_bins,
+                                 const index_t i) {
+  const int zero_bin_idx       = num_bins / 2;
+  const size_t p_bin_idx_start = zero_bin_idx - i;
+  const size_t p_bin_idx_stop  = zero_bin_idx + i + 1;
+
+  std::vector<size_t> sliced_nd_hist(p_bin_idx_stop - p_bin_idx_start);
+  std::vector<float> p(p_bin_idx_stop - p_bin_idx_start);
+  p[0]     = 0;
+  p.back() = 0;
+  for (size_t j = 0; j < num_bins; j++) {
+    if (j <= p_bin_idx_start) {
+      p[0] += hist_ptr[j];
+    } else if (j >= p_bin_idx_stop) {
+      p.back() += hist_ptr[j];
+    } else {
+      sliced_nd_hist[j - p_bin_idx_start] = hist_ptr[j];
+      p[j - p_bin_idx_start]              = hist_ptr[j];
+    }
+  }
+  // calculate how many bins should be merged to generate quantized distribution q
+  const auto num_merged_bins = sliced_nd_hist.size() / num_quantized_bins;
+  // merge hist into num_quantized_bins bins
+  std::vector<float> quantized_bins(num_quantized_bins, 0);
+  for (index_t j = 0; j < num_quantized_bins; j++) {
+    const int start = j * num_merged_bins;
+    const int stop  = (j + 1) * num_merged_bins;
+    quantized_bins[j] =
+        std::accumulate(sliced_nd_hist.begin() + start, sliced_nd_hist.begin() + stop, 0);
+  }
+  quantized_bins.back() += std::accumulate(
+      sliced_nd_hist.begin() + static_cast<int>(num_quantized_bins * num_merged_bins),
+      sliced_nd_hist.end(),
+      0);
+  // expand quantized_bins into p.size bins
+  std::vector<float> q(sliced_nd_hist.size(), 0);
+  for (index_t j = 0; j < num_quantized_bins; j++) {
+    const int start = j * num_merged_bins;
+    const int stop  = (j == num_quantized_bins - 1) ? q.size() : ((j + 1) * num_merged_bins);
+    int norm        = std::count_if(sliced_nd_hist.begin() + start,
+                             sliced_nd_hist.begin() + stop,
+                             [](size_t i) { return i != 0; });
+    if (norm) {
+      for (index_t k = start; k < stop; k++) {
+        if (p[k])
+          q[k] = quantized_bins[j] / norm;
+      }
+    }
+  }
+  p = SmoothDistribution(p);
+  q = SmoothDistribution(q);
+
+  if (!q.size()) {
+    return std::numeric_limits<float>::infinity();
+  }
+  return ComputeEntropy(&p, &q);
+}
+
 void CalibrateComputeCPU(const nnvm::NodeAttrs& attrs,
                          const OpContext& ctx,
                          const std::vector<TBlob>& inputs,
@@ -98,83 +164,71 @@ void CalibrateComputeCPU(const nnvm::NodeAttrs& attrs,
   const auto& hist_edges_ptr  = hist_edges.dptr<float>();
   float* const out_threshold  = outputs[0].dptr<float>();
   float* const out_divergence = outputs[1].dptr<float>();
-  const auto num_bins         = hist.Size();
-  CHECK_EQ(num_bins + 1, hist_edges.Size());
+  // one histogram per row, the thresholds of all the layers are searched in parallel
+  const index_t num_layers = hist.ndim() == 2 ? hist.shape_[0] : 1;
+  const size_t num_bins    = hist.shape_[hist.ndim() - 1];
+  CHECK_EQ(num_bins + 1, hist_edges.shape_[hist_edges.ndim() - 1]);
+  CHECK_EQ(num_layers * (num_bins + 1), hist_edges.Size());
   int num_quantized_bins = param.num_quantized_bins;
 
   const int zero_bin_idx            = num_bins / 2;
   const int num_half_quantized_bins = num_quantized_bins / 2;
-  std::vector<float> thresholds(num_bins / 2 + 1 - num_quantized_bins / 2, 0.f);
-  std::vector<float> divergence(thresholds.size(), 0.f);
+  const index_t num_thresholds      = num_bins / 2 + 1 - num_quantized_bins / 2;
+  std::vector<float> divergence(num_layers * num_thresholds, 0.f);
 #pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
-  for (index_t i = num_quantized_bins / 2; i <= zero_bin_idx; i++) {
-    const size_t p_bin_idx_start            = zero_bin_idx - i;
-    const size_t p_bin_idx_stop             = zero_bin_idx + i + 1;
-    thresholds[i - num_half_quantized_bins] = hist_edges_ptr[p_bin_idx_stop];
-
-    std::vector<size_t> sliced_nd_hist(p_bin_idx_stop - p_bin_idx_start);
-    std::vector<float> p(p_bin_idx_stop - p_bin_idx_start);
-    p[0]     = 0;
-    p.back() = 0;
-    for (size_t j = 0; j < num_bins; j++) {
-      if (j <= p_bin_idx_start) {
-        p[0] += hist_ptr[j];
-      } else if (j >= p_bin_idx_stop) {
-        p.back() += hist_ptr[j];
-      } else {
-        sliced_nd_hist[j - p_bin_idx_start] = hist_ptr[j];
-        p[j - p_bin_idx_start]              = hist_ptr[j];
+  for (index_t k = 0; k < num_layers * num_thresholds; k++) {
+    const float* layer_hist = hist_ptr + (k / num_thresholds) * num_bins;
+    const index_t i         = k % num_thresholds + num_half_quantized_bins;
+    divergence[k]           = ThresholdDivergence(layer_hist, num_bins, num_quantized_bins, i);
+  }
+
+  for (index_t layer = 0; layer < num_layers; layer++) {
+    size_t min_divergence_idx = 0;
+    float min_divergence      = mshadow::red::limits::MaxValue<float>();
+    for (index_t i = 0; i < num_thresholds; i++) {
+      if (divergence[layer * num_thresholds + i] < min_divergence) {
+        min_divergence     = divergence[layer * num_thresholds + i];
+        min_divergence_idx = i;
       }
     }
-    // calculate how many bins should be merged to generate quantized distribution q
-    const auto num_merged_bins = sliced_nd_hist.size() / num_quantized_bins;
-    // merge hist into num_quantized_bins bins
-    std::vector<float> quantized_bins(num_quantized_bins, 0);
-    for (index_t j = 0; j < num_quantized_bins; j++) {
-      const int start = j * num_merged_bins;
-      const int stop  = (j + 1) * num_merged_bins;
-      quantized_bins[j] =
-          std::accumulate(sliced_nd_hist.begin() + start, sliced_nd_hist.begin() + stop, 0);
-    }
-    quantized_bins.back() += std::accumulate(
-        sliced_nd_hist.begin() + static_cast<int>(num_quantized_bins * num_merged_bins),
-        sliced_nd_hist.end(),
-        0);
-    // expand quantized_bins into p.size bins
-    std::vector<float> q(sliced_nd_hist.size(), 0);
-    for (index_t j = 0; j < num_quantized_bins; j++) {
-      const int start = j * num_merged_bins;
-      const int stop  = (j == num_quantized_bins - 1) ? q.size() : ((j + 1) * num_merged_bins);
-      int norm        = std::count_if(sliced_nd_hist.begin() + start,
-                               sliced_nd_hist.begin() + stop,
-                               [](size_t i) { return i != 0; });
-      if (norm) {
-        for (index_t k = start; k < stop; k++) {
-          if (p[k])
-            q[k] = quantized_bins[j] / norm;
+    const size_t p_bin_idx_stop = zero_bin_idx + min_divergence_idx + num_half_quantized_bins + 1;
+    out_divergence[layer]       = min_divergence;
+    out_threshold[layer]        = hist_edges_ptr[layer * (num_bins + 1) + p_bin_idx_stop];
+  }
+}
+
+template <>
+void CalibHistogramAccumulate<cpu>(const OpContext& ctx,
+                                   const TBlob& data,
+                                   float* hist,
+                                   int num_bins,
+                                   float max_range) {
+  const index_t n    = data.Size();
+  const int nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  // each thread counts in its own histogram, they are summed at the end
+  std::vector<index_t> thread_hist(static_cast<size_t>(nthreads) * num_bins, 0);
+  MSHADOW_REAL_TYPE_SWITCH(data.type_flag_, DType, {
+    const DType* data_ptr = data.dptr<DType>();
+#pragma omp parallel num_threads(nthreads)
+    {
+      index_t* local = thread_hist.data() + static_cast<size_t>(omp_get_thread_num()) * num_bins;
+#pragma omp for
+      for (index_t i = 0; i < n; i++) {
+        const int bin = CalibHistogramBin(static_cast<float>(data_ptr[i]), num_bins, max_range);
+        if (bin >= 0) {
+          local[bin]++;
         }
       }
     }
-    p = SmoothDistribution(p);
-    q = SmoothDistribution(q);
-
-    if (!q.size()) {
-      divergence[i - num_half_quantized_bins] = std::numeric_limits<float>::infinity();
-    } else {
-      divergence[i - num_half_quantized_bins] = ComputeEntropy(&p, &q);
-    }
-  }
-
-  size_t min_divergence_idx = 0;
-  float min_divergence      = mshadow::red::limits::MaxValue<float>();
-  for (size_t i = 0; i < divergence.size(); i++) {
-    if (divergence[i] < min_divergence) {
-      min_divergence     = divergence[i];
-      min_divergence_idx = i;
+  });
+#pragma omp parallel for num_threads(nthreads)
+  for (int bin = 0; bin < num_bins; bin++) {
+    index_t count = 0;
+    for (int t = 0; t < nthreads; t++) {
+      count += thread_hist[static_cast<size_t>(t) * num_bins + bin];
     }
+    hist[bin] += static_cast<float>(count);
   }
-  *out_divergence = min_divergence;
-  *out_threshold  = thresholds[min_divergence_idx];
 }
 
 static inline bool CalibrateShape(const nnvm::NodeAttrs& attrs,
@@ -182,9 +236,18 @@ static inline bool CalibrateShape(const nnvm::NodeAttrs& attrs,
                                   std::vector<TShape>* out_attrs) {
   CHECK_EQ(in_attrs->size(), 2U);
   CHECK_EQ(out_attrs->size(), 2U);
-  SHAPE_ASSIGN_CHECK(*out_attrs, 0, TShape(1, 1));
-  SHAPE_ASSIGN_CHECK(*out_attrs, 1, TShape(1, 1));
-  return (!shape_is_none(in_attrs->at(0))) && (!shape_is_none(in_attrs->at(1)));
+  if (shape_is_none(in_attrs->at(0)) || shape_is_none(in_attrs->at(1))) {
+    return false;
+  }
+  // a 2D input is one histogram per row, with a threshold each
+  const TShape& hshape = in_attrs->at(0);
+  CHECK(hshape.ndim() == 1 || hshape.ndim() == 2)
+      << "hist has to be of shape (num_bins,) or (num_layers, num_bins)";
+  CHECK_EQ(in_attrs->at(1).ndim(), hshape.ndim());
+  const dim_t num_layers = hshape.ndim() == 2 ? hshape[0] : 1;
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, TShape(1, num_layers));
+  SHAPE_ASSIGN_CHECK(*out_attrs, 1, TShape(1, num_layers));
+  return true;
 }
 
 static inline bool CalibrateType(const nnvm::NodeAttrs& attrs,
@@ -203,6 +266,10 @@ NNVM_REGISTER_OP(_contrib_calibrate_entropy)
     .add_alias("_npx_contrib_calibrate_entropy")
     .describe(R"code(Provide calibrated min/max for input histogram.
 
+The histogram can be of shape (num_bins,), or (num_layers, num_bins) with the hist_edges of
+shape (num_layers, num_bins + 1), in which case the thresholds of all the layers are searched in
+parallel and the outputs are of shape (num_layers,).
+
 .. Note::
     This operator only supports forward propagation. DO NOT use it in training.)code" ADD_FILELINE)
     .set_attr_parser(ParamParser<CalibrateEntropyParam>)
@@ -223,5 +290,60 @@ NNVM_REGISTER_OP(_contrib_calibrate_entropy)
     .add_argument("hist_edges", "NDArray-or-Symbol", "A ndarray/symbol of type `float32`")
     .add_arguments(CalibrateEntropyParam::__FIELDS__());
 
+NNVM_REGISTER_OP(_contrib_calib_histogram)
+    .add_alias("_npx_contrib_calib_histogram")
+    .describe(R"code(Accumulate the histogram of the data into hist, in place.
+
+The bins split [-max_range, max_range] uniformly, as the hist_edges given to
+_contrib_calibrate_entropy. Called on every calibration batch with ``out=hist``, the histogram
+of a layer stays on the device of the layer across batches.
+
+Example::
+  hist = calib_histogram([-1.0, 0.1, 0.2, 3.0], hist=[1.0, 0.0, 0.0, 0.0], max_range=2.0)
+  hist = [1.0, 1.0, 2.0, 0.0]
+
+.. Note::
+    This operator only supports forward propagation. DO NOT use it in training.)code" ADD_FILELINE)
+    .set_attr_parser(ParamParser<CalibHistogramParam>)
+    .set_num_inputs(2)
+    .set_num_outputs(1)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"data", "hist"};
+                                     })
+    .set_attr<nnvm::FInplaceOption>("FInplaceOption",
+                                    [](const NodeAttrs& attrs) {
+                                      return std::vector<std::pair<int, int>>{{1, 0}};
+                                    })
+    .set_attr<mxnet::FInferShape>("FInferShape",
+                                  [](const nnvm::NodeAttrs& attrs,
+                                     mxnet::ShapeVector* in_attrs,
+                                     mxnet::ShapeVector* out_attrs) {
+                                    CHECK_EQ(in_attrs->size(), 2U);
+                                    CHECK_EQ(out_attrs->size(), 1U);
+                                    SHAPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(1));
+                                    SHAPE_ASSIGN_CHECK(*in_attrs, 1, out_attrs->at(0));
+                                    return shape_is_known(in_attrs->at(0)) &&
+                                           shape_is_known(out_attrs->at(0));
+                                  })
+    .set_attr<nnvm::FInferType>("FInferType",
+                                [](const nnvm::NodeAttrs& attrs,
+                                   std::vector<int>* in_attrs,
+                                   std::vector<int>* out_attrs) {
+                                  CHECK_EQ(in_attrs->size(), 2U);
+                                  CHECK_EQ(out_attrs->size(), 1U);
+                                  TYPE_ASSIGN_CHECK(*in_attrs, 1, mshadow::kFloat32);
+                                  TYPE_ASSIGN_CHECK(*out_attrs, 0, mshadow::kFloat32);
+                                  return in_attrs->at(0) != -1;
+                                })
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FCompute>("FCompute<cpu>", CalibHistogramForward<cpu>)
+    .add_argument("data", "NDArray-or-Symbol", "Layer output the histogram is taken of.")
+    .add_argument("hist", "NDArray-or-Symbol", "Histogram accumulated so far, float32.")
+    .add_arguments(CalibHistogramParam::__FIELDS__());
+
 }  // namespace op
 }  // namespace mxnet
@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file calibrate.cu
+ * \brief GPU implementation of the histogram of the entropy calibration
+ */
+
+#include "./calibrate-inl.h"
+
+namespace mxnet {
+namespace op {
+
+struct CalibHistogramKernel {
+  template <typename DType>
+  static MSHADOW_XINLINE void Map(index_t i,
+                                  const DType* data,
+                                  unsigned int* counts,
+                                  int num_bins,
+                                  float max_range) {
+    const int bin = CalibHistogramBin(static_cast<float>(data[i]), num_bins, max_range);
+    if (bin >= 0) {
+      atomicAdd(&counts[bin], 1U);
+    }
+  }
+};
+
+struct CalibHistogramAddKernel {
+  MSHADOW_XINLINE static void Map(index_t i, float* hist, const unsigned int* counts) {
+    hist[i] += static_cast<float>(counts[i]);
+  }
+};
+
+template <>
+void CalibHistogramAccumulate<gpu>(const OpContext& ctx,
+                                   const TBlob& data,
+                                   float* hist,
+                                   int num_bins,
+                                   float max_range) {
+  using namespace mxnet_op;
+  mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+  mshadow::Tensor<gpu, 1, unsigned int> counts =
+      ctx.requested[0].get_space_typed<gpu, 1, unsigned int>(mshadow::Shape1(num_bins), s);
+  Kernel<set_zero, gpu>::Launch(s, num_bins, counts.dptr_);
+  MSHADOW_REAL_TYPE_SWITCH(data.type_flag_, DType, {
+    Kernel<CalibHistogramKernel, gpu>::Launch(
+        s, data.Size(), data.dptr<DType>(), counts.dptr_, num_bins, max_range);
+  });
+  Kernel<CalibHistogramAddKernel, gpu>::Launch(s, num_bins, hist, counts.dptr_);
+}
+
+NNVM_REGISTER_OP(_contrib_calib_histogram)
+    .set_attr<FCompute>("FCompute<gpu>", CalibHistogramForward<gpu>);
+
+}  // namespace op
+}  // namespace mxnet
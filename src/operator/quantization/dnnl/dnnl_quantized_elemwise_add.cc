@@ -61,9 +61,9 @@ DNNLQuantizedSumFwd& DNNLQuantizedSumFwd::GetCached(
     const std::vector<float>& scales,
     const std::vector<dnnl::memory::desc>& inputs_md) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<OpSignature, DNNLQuantizedSumFwd, OpHash> fwds;
+  static thread_local DNNLCache<OpSignature, DNNLQuantizedSumFwd, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<OpSignature, DNNLQuantizedSumFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLCache<OpSignature, DNNLQuantizedSumFwd, OpHash> fwds;
 #endif
   OpSignature key;
   key.AddSign(output_md);
@@ -110,9 +110,9 @@ DNNLQuantizedBinAddFwd& DNNLQuantizedBinAddFwd::GetCached(
     const std::vector<float>& scales,
     const std::vector<dnnl::memory::desc>& inputs_md) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<OpSignature, DNNLQuantizedBinAddFwd, OpHash> fwds;
+  static thread_local DNNLCache<OpSignature, DNNLQuantizedBinAddFwd, OpHash> fwds;
 #else
-  static MX_THREAD_LOCAL std::unordered_map<OpSignature, DNNLQuantizedBinAddFwd, OpHash> fwds;
+  static MX_THREAD_LOCAL DNNLCache<OpSignature, DNNLQuantizedBinAddFwd, OpHash> fwds;
 #endif
   OpSignature key;
   key.AddSign(output_md);
@@ -145,7 +145,8 @@ inline QuantizeType NeedQuantize(ObjectPtr node,
                                  const std::unordered_set<std::string>& excluded_ops,
                                  const int& dev_type,
                                  std::unordered_map<ObjectPtr, ObjectPtr>* quantized_node_map,
-                                 const std::string quantize_granularity) {
+                                 const std::string quantize_granularity,
+                                 const int weight_group_size) {
   std::unordered_map<ObjectPtr, ObjectPtr> quantized_node;
   static auto& quantizable_map  = Op::GetAttr<mxnet::FQuantizable>("FQuantizable");
   static auto& quantized_op_map = Op::GetAttr<mxnet::FQuantizedOp>("FQuantizedOp");
@@ -186,9 +187,12 @@ inline QuantizeType NeedQuantize(ObjectPtr node,
       if (!quantized_node->op())
         need = false;
       if (need) {
-        if ((quantize_granularity == "channel-wise") &&
+        if ((quantize_granularity == "channel-wise" || quantize_granularity == "group-wise") &&
             (node->op() == Op::Get("_sg_onednn_fully_connected"))) {
           quantized_node->attrs.dict["channel_wise_quantize"] = "True";
+          if (quantize_granularity == "group-wise") {
+            quantized_node->attrs.dict["weight_group_size"] = std::to_string(weight_group_size);
+          }
         }
         quantized_node_map->insert(std::make_pair(node, quantized_node));
       }
@@ -215,14 +219,21 @@ static void MarkQuantizedNodes(const Graph& src,
   const auto quantize_mode        = src.GetAttr<std::string>("quantize_mode");
   const auto dev_type             = src.GetAttr<int>("target_ctx");
   const auto quantize_granularity = src.GetAttr<std::string>("quantize_granularity");
+  const auto weight_group_size =
+      src.attrs.count("weight_group_size") ? src.GetAttr<int>("weight_group_size") : 0;
 
   std::unordered_map<ObjectPtr, std::vector<ObjectPtr>> node_output_map;
   std::unordered_set<ObjectPtr> must_quantize_nodes;
   std::unordered_map<ObjectPtr, int> support_quantize_nodes;
   // Build node_output_map, must_quantize_nodes and support_quantize_nodes;
   DFSVisit(src.outputs, [&](const ObjectPtr& node) {
-    auto quantize_type = NeedQuantize(
-        node, excluded_nodes, excluded_ops, dev_type, quantized_node_map, quantize_granularity);
+    auto quantize_type = NeedQuantize(node,
+                                      excluded_nodes,
+                                      excluded_ops,
+                                      dev_type,
+                                      quantized_node_map,
+                                      quantize_granularity,
+                                      weight_group_size);
     if (quantize_type == QuantizeType::kMust) {
       must_quantize_nodes.insert(node);
     } else if (quantize_type == QuantizeType::kSupport) {
@@ -297,8 +308,9 @@ Graph QuantizeGraph(Graph&& src) {
   const auto quantize_granularity = src.GetAttr<std::string>("quantize_granularity");
   const auto dev_type             = src.GetAttr<int>("target_ctx");
 
-  if (dev_type == Context::kGPU && quantize_granularity == "channel-wise") {
-    LOG(FATAL) << "`channel-wise` quantization option is not supported yet by GPU,"
+  if (dev_type == Context::kGPU && quantize_granularity != "tensor-wise") {
+    LOG(FATAL) << "`" << quantize_granularity
+               << "` quantization option is not supported yet by GPU,"
                << " please set quantize_granularity to `tensor-wise` when quantizing model.";
   }
 
@@ -28,6 +28,7 @@ namespace op {
 
 DMLC_REGISTER_PARAMETER(SampleCategoricalParam);
 DMLC_REGISTER_PARAMETER(SampleMultinomialParam);
+DMLC_REGISTER_PARAMETER(SampleAliasParam);
 
 NNVM_REGISTER_OP(_sample_categorical)
     .add_alias("sample_categorical")
@@ -138,6 +139,76 @@ Examples::
                   "Probability of every outcome in each experiment. Must sum to 1 on the last axis")
     .add_arguments(SampleMultinomialParam::__FIELDS__());
 
+NNVM_REGISTER_OP(_sample_alias_table)
+    .add_alias("_npx__random_alias_table")
+    .describe(R"code(Builds the alias tables of multiple categorical distributions.
+
+*data* is an *n* dimensional array whose last dimension has length *k*. Each
+distribution is normalized by its sum and turned into a table of *k*
+acceptance probabilities and *k* aliases, such that drawing an outcome
+uniformly, keeping it with its probability and taking its alias otherwise
+samples from the distribution. Building the tables is linear in *k* and
+drawing from them with ``_sample_alias`` takes constant time per sample, which
+pays off when many samples are drawn from the same distributions.
+
+Examples::
+
+   probs = [0.1, 0.2, 0.3, 0.4]
+
+   prob, alias = _sample_alias_table(probs)
+   prob = [0.4, 0.8, 1, 0.8]
+   alias = [3, 3, 2, 2]
+)code")
+    .set_num_inputs(1)
+    .set_num_outputs(2)
+    .set_attr<mxnet::FInferShape>("FInferShape", AliasTableOpShape)
+    .set_attr<nnvm::FInferType>("FInferType", AliasTableOpType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const nnvm::NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .set_attr<FCompute>("FCompute<cpu>", AliasTableForward<cpu>)
+    .add_argument("data",
+                  "NDArray-or-Symbol",
+                  "Unnormalized distribution probabilities on the last axis.");
+
+NNVM_REGISTER_OP(_sample_alias)
+    .add_alias("_npx__random_alias")
+    .describe(R"code(Concurrent sampling from multiple categorical distributions given as
+alias tables built by ``_sample_alias_table``.
+
+*shape* samples are drawn from each distribution. If shape is empty one sample
+will be drawn from each distribution.
+
+Examples::
+
+   prob, alias = _sample_alias_table([[0, 0.1, 0.2, 0.3, 0.4], [0.4, 0.3, 0.2, 0.1, 0]])
+
+   // Draw a vector containing two samples for each distribution
+   _sample_alias(prob, alias, shape=(2)) = [[4, 2],
+                                            [0, 0]]
+)code")
+    .set_num_inputs(2)
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<SampleAliasParam>)
+    .set_attr<nnvm::FListInputNames>("FListInputNames",
+                                     [](const NodeAttrs& attrs) {
+                                       return std::vector<std::string>{"prob", "alias"};
+                                     })
+    .set_attr<mxnet::FInferShape>("FInferShape", SampleAliasOpShape)
+    .set_attr<nnvm::FInferType>("FInferType", SampleAliasOpType)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const nnvm::NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kRandom,
+                                                                      ResourceRequest::kTempSpace};
+                                })
+    .set_attr<nnvm::FGradient>("FGradient", MakeZeroGradNodes)
+    .set_attr<FCompute>("FCompute<cpu>", SampleAliasForward<cpu>)
+    .add_argument("prob", "NDArray-or-Symbol", "Acceptance probabilities of the alias tables.")
+    .add_argument("alias", "NDArray-or-Symbol", "Aliases of the alias tables.")
+    .add_arguments(SampleAliasParam::__FIELDS__());
+
 struct SampleCategoricalBackwardCPUKernel {
   template <typename DType, typename IType>
   MSHADOW_XINLINE static void
@@ -32,6 +32,12 @@ NNVM_REGISTER_OP(_sample_categorical)
 NNVM_REGISTER_OP(_sample_multinomial)
     .set_attr<FCompute>("FCompute<gpu>", SampleMultinomialForward<gpu>);
 
+NNVM_REGISTER_OP(_sample_alias_table)
+    .set_attr<FCompute>("FCompute<gpu>", AliasTableForward<gpu>);
+
+NNVM_REGISTER_OP(_sample_alias)
+    .set_attr<FCompute>("FCompute<gpu>", SampleAliasForward<gpu>);
+
 struct SampleCategoricalBackwardGPUKernel {
   template <typename DType, typename IType>
   MSHADOW_XINLINE static void
@@ -81,6 +81,36 @@ struct SampleMultinomialParam : public dmlc::Parameter<SampleMultinomialParam> {
   }
 };
 
+struct SampleAliasParam : public dmlc::Parameter<SampleAliasParam> {
+  mxnet::TShape shape;
+  int dtype;
+  DMLC_DECLARE_PARAMETER(SampleAliasParam) {
+    DMLC_DECLARE_FIELD(shape)
+        .set_default(mxnet::TShape(0, 1))
+        .describe("Shape to be sampled from each random distribution.");
+    DMLC_DECLARE_FIELD(dtype)
+        .add_enum("int32", mshadow::kInt32)
+        .add_enum("int64", mshadow::kInt64)
+        .set_default(mshadow::kInt32)
+        .describe("DType of the output in case this can't be inferred.");
+  }
+};
+
+/*! \brief shape of the samples drawn from the distributions on the last axis of dshape */
+inline mxnet::TShape SampleDistributionsShape(const mxnet::TShape& dshape,
+                                              const mxnet::TShape& shape) {
+  if (dshape.ndim() == 1)
+    return shape.ndim() > 0 ? shape : mxnet::TShape(1, 1);
+  mxnet::TShape oshape(dshape.ndim() - 1 + shape.ndim(), -1);
+  for (int i = 0; i < dshape.ndim() - 1; ++i) {
+    oshape[i] = dshape[i];
+  }
+  for (int i = 0; i < shape.ndim(); ++i) {
+    oshape[i + dshape.ndim() - 1] = shape[i];
+  }
+  return oshape;
+}
+
 inline bool SampleCategoricalOpShape(const nnvm::NodeAttrs& attrs,
                                      mxnet::ShapeVector* in_attrs,
                                      mxnet::ShapeVector* out_attrs) {
@@ -93,25 +123,13 @@ inline bool SampleCategoricalOpShape(const nnvm::NodeAttrs& attrs,
     return false;
 
   if (ishape.ndim() == 1) {
-    if (param.shape.ndim() > 0) {
-      SHAPE_ASSIGN_CHECK(*out_attrs, 0, param.shape);
-      if (param.get_prob)
-        SHAPE_ASSIGN_CHECK(*out_attrs, 1, param.shape);
-    } else {
-      SHAPE_ASSIGN_CHECK(*out_attrs, 0, mxnet::TShape(1, 1));
-      if (param.get_prob)
-        SHAPE_ASSIGN_CHECK(*out_attrs, 1, mxnet::TShape(1, 1));
-    }
+    SHAPE_ASSIGN_CHECK(*out_attrs, 0, SampleDistributionsShape(ishape, param.shape));
+    if (param.get_prob)
+      SHAPE_ASSIGN_CHECK(*out_attrs, 1, SampleDistributionsShape(ishape, param.shape));
     return true;
   }
 
-  mxnet::TShape oshape(ishape.ndim() - 1 + param.shape.ndim(), -1);
-  for (int i = 0; i < ishape.ndim() - 1; ++i) {
-    oshape[i] = ishape[i];
-  }
-  for (int i = 0; i < param.shape.ndim(); ++i) {
-    oshape[i + ishape.ndim() - 1] = param.shape[i];
-  }
+  mxnet::TShape oshape = SampleDistributionsShape(ishape, param.shape);
   SHAPE_ASSIGN_CHECK(*out_attrs, 0, oshape);
   if (param.get_prob)
     SHAPE_ASSIGN_CHECK(*out_attrs, 1, oshape);
@@ -140,6 +158,54 @@ inline bool SampleCategoricalOpType(const nnvm::NodeAttrs& attrs,
   return true;
 }
 
+inline bool AliasTableOpShape(const nnvm::NodeAttrs& attrs,
+                              mxnet::ShapeVector* in_attrs,
+                              mxnet::ShapeVector* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 1U);
+  CHECK_EQ(out_attrs->size(), 2U);
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, (*in_attrs)[0]);
+  SHAPE_ASSIGN_CHECK(*out_attrs, 1, (*in_attrs)[0]);
+  SHAPE_ASSIGN_CHECK(*in_attrs, 0, (*out_attrs)[0]);
+  return shape_is_known((*out_attrs)[0]);
+}
+
+inline bool AliasTableOpType(const nnvm::NodeAttrs& attrs,
+                             std::vector<int>* in_attrs,
+                             std::vector<int>* out_attrs) {
+  CHECK_EQ(in_attrs->size(), 1U);
+  CHECK_EQ(out_attrs->size(), 2U);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 1, mshadow::kInt32);
+  return (*in_attrs)[0] != -1;
+}
+
+inline bool SampleAliasOpShape(const nnvm::NodeAttrs& attrs,
+                               mxnet::ShapeVector* in_attrs,
+                               mxnet::ShapeVector* out_attrs) {
+  const SampleAliasParam& param = nnvm::get<SampleAliasParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  SHAPE_ASSIGN_CHECK(*in_attrs, 1, (*in_attrs)[0]);
+  SHAPE_ASSIGN_CHECK(*in_attrs, 0, (*in_attrs)[1]);
+  const mxnet::TShape& ishape = (*in_attrs)[0];
+  if (!ndim_is_known(ishape))
+    return false;
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, SampleDistributionsShape(ishape, param.shape));
+  return shape_is_known((*out_attrs)[0]);
+}
+
+inline bool SampleAliasOpType(const nnvm::NodeAttrs& attrs,
+                              std::vector<int>* in_attrs,
+                              std::vector<int>* out_attrs) {
+  const SampleAliasParam& param = nnvm::get<SampleAliasParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), 2U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  TYPE_ASSIGN_CHECK(*in_attrs, 0, mshadow::kFloat32);
+  TYPE_ASSIGN_CHECK(*in_attrs, 1, mshadow::kInt32);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, param.dtype);
+  return true;
+}
+
 inline bool SampleMultinomialOpShape(const nnvm::NodeAttrs& attrs,
                                      mxnet::ShapeVector* in_attrs,
                                      mxnet::ShapeVector* out_attrs) {
@@ -198,42 +264,116 @@ inline bool SampleMultinomialOpType(const nnvm::NodeAttrs& attrs,
   return true;
 }
 
+struct SampleCategoricalCDFKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i, index_t K, const DType* dist, float* cum_table) {
+    double acc = 0.0;
+    for (index_t c = 0; c < K; ++c) {
+      acc += dist[i * K + c];
+      cum_table[i * K + c] = static_cast<float>(acc);
+    }
+  }
+};
+
 struct SampleCategoricalKernel {
   template <typename DType, typename IType>
   MSHADOW_XINLINE static void Map(index_t i,
                                   index_t K,
                                   index_t M,
-                                  DType* dist,
-                                  float* uniform,
-                                  float* cum_table,
+                                  const DType* dist,
+                                  const float* uniform,
+                                  const float* cum_table,
                                   IType* out,
                                   DType* prob) {
-    double acc = 0.0;
-    // CDF table
-    for (index_t c = 0; c < K; ++c) {
-      acc += dist[i * K + c];
-      cum_table[i * K + c] = static_cast<float>(acc);
-    }
-    for (index_t j = 0; j < M; ++j) {
-      index_t left = 0, right = K;
+    // each sample searches the CDF table of its distribution
+    const float* cum = cum_table + (i / M) * K;
+    index_t left = 0, right = K;
+    DType loc    = static_cast<DType>(uniform[i]);
+    while (right - left > 0) {
       index_t middle = left + (right - left) / 2;
-      DType loc      = static_cast<DType>(uniform[i * M + j]);
-      while (right - left > 0) {
-        middle         = left + (right - left) / 2;
-        DType cum_prob = cum_table[i * K + middle];
-        if (cum_prob < loc) {
-          left = middle + 1;
-        } else {
-          right = middle;
-        }
+      DType cum_prob = cum[middle];
+      if (cum_prob < loc) {
+        left = middle + 1;
+      } else {
+        right = middle;
+      }
+    }
+    // the rounding of the table may leave its last entry below one
+    left   = left < K ? left : K - 1;
+    out[i] = static_cast<IType>(left);
+    if (prob != nullptr)
+      prob[i] = logf(dist[(i / M) * K + left]);
+  }
+};
+
+/*!
+ * \brief Builds the alias table of a distribution with Vose's method: an outcome drawn
+ *  uniformly is kept with probability prob, and replaced by its alias otherwise.
+ */
+struct AliasTableKernel {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  index_t K,
+                                  const DType* dist,
+                                  float* prob,
+                                  int32_t* alias,
+                                  int32_t* worklist) {
+    const DType* p = dist + i * K;
+    float* q       = prob + i * K;
+    int32_t* a     = alias + i * K;
+    int32_t* work  = worklist + i * K;
+    double total   = 0.0;
+    for (index_t k = 0; k < K; ++k) {
+      total += p[k];
+    }
+    // the outcomes below the mean are stacked from the front, the others from the back
+    index_t small = 0, large = K;
+    for (index_t k = 0; k < K; ++k) {
+      q[k] = static_cast<float>(p[k] * K / total);
+      a[k] = static_cast<int32_t>(k);
+      if (q[k] < 1.0f) {
+        work[small++] = static_cast<int32_t>(k);
+      } else {
+        work[--large] = static_cast<int32_t>(k);
+      }
+    }
+    while (small > 0 && large < K) {
+      const int32_t s = work[--small];
+      const int32_t l = work[large++];
+      a[s]            = l;
+      q[l]            = static_cast<float>((static_cast<double>(q[l]) + q[s]) - 1.0);
+      if (q[l] < 1.0f) {
+        work[small++] = l;
+      } else {
+        work[--large] = l;
       }
-      out[i * M + j] = static_cast<IType>(left);
-      if (prob != nullptr)
-        prob[i * M + j] = logf(dist[i * K + left]);
+    }
+    // what is left is one up to rounding
+    while (small > 0) {
+      q[work[--small]] = 1.0f;
+    }
+    while (large < K) {
+      q[work[large++]] = 1.0f;
     }
   }
 };
 
+struct SampleAliasKernel {
+  template <typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  index_t K,
+                                  index_t M,
+                                  const float* prob,
+                                  const int32_t* alias,
+                                  const float* uniform,
+                                  IType* out) {
+    const index_t base = (i / M) * K;
+    index_t k          = static_cast<index_t>(uniform[2 * i] * K);
+    k                  = k < K ? k : K - 1;
+    out[i] = static_cast<IType>(uniform[2 * i + 1] < prob[base + k] ? k : alias[base + k]);
+  }
+};
+
 template <typename xpu, typename NType, typename PType, typename OType>
 MSHADOW_XINLINE void SampleMultinomial(NType N,
                                        const PType* p,
@@ -300,10 +440,12 @@ void SampleCategoricalForward(const nnvm::NodeAttrs& attrs,
         ctx.requested[1].get_space_typed<xpu, 1, float>(Shape1(N * M + N * K), s);
     Tensor<xpu, 1, float> uniform(workspace.dptr_, Shape1(N * M));
     prnd->SampleUniform(&uniform, 0, 1);
+    Kernel<SampleCategoricalCDFKernel, xpu>::Launch(
+        s, N, K, inputs[0].dptr<DType>(), workspace.dptr_ + N * M);
     MSHADOW_TYPE_SWITCH(outputs[0].type_flag_, IType, {
       Kernel<SampleCategoricalKernel, xpu>::Launch(
           s,
-          N,
+          N * M,
           K,
           M,
           inputs[0].dptr<DType>(),
@@ -315,6 +457,63 @@ void SampleCategoricalForward(const nnvm::NodeAttrs& attrs,
   });
 }
 
+template <typename xpu>
+void AliasTableForward(const nnvm::NodeAttrs& attrs,
+                       const OpContext& ctx,
+                       const std::vector<TBlob>& inputs,
+                       const std::vector<OpReqType>& req,
+                       const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  const index_t K = inputs[0].shape_[inputs[0].ndim() - 1];
+  const index_t N = inputs[0].Size() / K;
+  if (N == 0 || K == 0)
+    return;
+  Stream<xpu>* s = ctx.get_stream<xpu>();
+  Tensor<xpu, 1, int32_t> worklist =
+      ctx.requested[0].get_space_typed<xpu, 1, int32_t>(Shape1(N * K), s);
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    Kernel<AliasTableKernel, xpu>::Launch(s,
+                                          N,
+                                          K,
+                                          inputs[0].dptr<DType>(),
+                                          outputs[0].dptr<float>(),
+                                          outputs[1].dptr<int32_t>(),
+                                          worklist.dptr_);
+  });
+}
+
+template <typename xpu>
+void SampleAliasForward(const nnvm::NodeAttrs& attrs,
+                        const OpContext& ctx,
+                        const std::vector<TBlob>& inputs,
+                        const std::vector<OpReqType>& req,
+                        const std::vector<TBlob>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  const index_t K = inputs[0].shape_[inputs[0].ndim() - 1];
+  const index_t N = inputs[0].Size() / K;
+  const index_t M = N == 0 ? 0 : outputs[0].Size() / N;
+  if (N * M == 0)
+    return;
+  Stream<xpu>* s           = ctx.get_stream<xpu>();
+  Random<xpu, float>* prnd = ctx.requested[0].get_random<xpu, float>(s);
+  // the outcome and the choice between it and its alias
+  Tensor<xpu, 1, float> uniform =
+      ctx.requested[1].get_space_typed<xpu, 1, float>(Shape1(2 * N * M), s);
+  prnd->SampleUniform(&uniform, 0, 1);
+  MSHADOW_TYPE_SWITCH(outputs[0].type_flag_, IType, {
+    Kernel<SampleAliasKernel, xpu>::Launch(s,
+                                           N * M,
+                                           K,
+                                           M,
+                                           inputs[0].dptr<float>(),
+                                           inputs[1].dptr<int32_t>(),
+                                           uniform.dptr_,
+                                           outputs[0].dptr<IType>());
+  });
+}
+
 template <typename xpu>
 static inline void multinomial_op(const nnvm::NodeAttrs& attrs,
                                   const OpContext& ctx,
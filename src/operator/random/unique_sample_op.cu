@@ -0,0 +1,162 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file unique_sample_op.cu
+ * \brief GPU Implementation of unique sample op
+ */
+#include <climits>
+#include "./unique_sample_op.h"
+
+namespace mxnet {
+namespace op {
+
+/*! \brief number of candidates a block draws in each round */
+constexpr int kUniqueSampleThreads = 256;
+
+/*! \brief inclusive prefix sum of flag over the block, the total is left in warp_sums */
+__device__ __forceinline__ int UniqueSampleBlockScan(int flag, int* warp_sums) {
+  const int lane = threadIdx.x % 32;
+  const int warp = threadIdx.x / 32;
+  int sum        = flag;
+  for (int d = 1; d < 32; d *= 2) {
+    const int prev = __shfl_up_sync(0xffffffff, sum, d);
+    if (lane >= d)
+      sum += prev;
+  }
+  if (lane == 31)
+    warp_sums[warp] = sum;
+  __syncthreads();
+  if (threadIdx.x == 0) {
+    for (int w = 1; w < kUniqueSampleThreads / 32; ++w) {
+      warp_sums[w] += warp_sums[w - 1];
+    }
+  }
+  __syncthreads();
+  return warp > 0 ? sum + warp_sums[warp - 1] : sum;
+}
+
+/*!
+ * \brief Each block samples the rows of the batch in rounds of one candidate per thread.
+ *  The candidates are inserted in a hash table of the block that keeps the index of their
+ *  first draw, so that a candidate is new when its draw is the first one. The new candidates
+ *  are then appended in the order of their draws, as the sequential sampler does.
+ */
+__global__ void UniqueSampleZipfianKernel(RandGenerator<gpu, double> gen,
+                                          const int batch_size,
+                                          const int num_sampled,
+                                          const double log_range_max,
+                                          const int table_size,
+                                          int64_t* table_keys,
+                                          int* table_draws,
+                                          int64_t* samples,
+                                          int64_t* num_tries) {
+  __shared__ int warp_sums[kUniqueSampleThreads / 32];
+  typename RandGenerator<gpu, double>::Impl generator(&gen, blockIdx.x * blockDim.x + threadIdx.x);
+  int64_t* keys        = table_keys + static_cast<size_t>(blockIdx.x) * table_size;
+  int* draws           = table_draws + static_cast<size_t>(blockIdx.x) * table_size;
+  const unsigned mask  = table_size - 1;
+  const int64_t kEmpty = -1;
+  for (int row = blockIdx.x; row < batch_size; row += gridDim.x) {
+    for (int j = threadIdx.x; j < table_size; j += blockDim.x) {
+      keys[j]  = kEmpty;
+      draws[j] = INT_MAX;
+    }
+    if (threadIdx.x == 0)
+      num_tries[row] = 0;
+    __syncthreads();
+    int count = 0;
+    for (int round = 0; count < num_sampled; ++round) {
+      const int draw = round * blockDim.x + threadIdx.x;
+      const int64_t value =
+          static_cast<int64_t>(lround(exp(generator.uniform() * log_range_max)) - 1);
+      unsigned slot = static_cast<unsigned>(
+                          (static_cast<uint64_t>(value) * 0x9E3779B97F4A7C15ULL) >> 32) &
+                      mask;
+      while (true) {
+        const int64_t prev = static_cast<int64_t>(
+            atomicCAS(reinterpret_cast<unsigned long long*>(keys + slot),  // NOLINT(*)
+                      static_cast<unsigned long long>(kEmpty),             // NOLINT(*)
+                      static_cast<unsigned long long>(value)));            // NOLINT(*)
+        if (prev == kEmpty || prev == value)
+          break;
+        slot = (slot + 1) & mask;
+      }
+      atomicMin(draws + slot, draw);
+      __syncthreads();
+      const int is_new = draws[slot] == draw;
+      const int pos    = UniqueSampleBlockScan(is_new, warp_sums);
+      if (is_new && count + pos <= num_sampled) {
+        samples[static_cast<size_t>(row) * num_sampled + count + pos - 1] = value;
+        if (count + pos == num_sampled)
+          num_tries[row] = draw + 1;
+      }
+      count += warp_sums[kUniqueSampleThreads / 32 - 1];
+      __syncthreads();
+    }
+  }
+}
+
+inline void SampleUniqueZifpianGPU(const nnvm::NodeAttrs& attrs,
+                                   const OpContext& ctx,
+                                   const std::vector<TBlob>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<TBlob>& outputs) {
+  using GType                           = double;
+  const SampleUniqueZifpianParam& param = nnvm::get<SampleUniqueZifpianParam>(attrs.parsed);
+  const int batch_size                  = param.shape[0];
+  const int num_sampled                 = param.shape[1];
+  CHECK_EQ(outputs.size(), 2U);
+  CHECK_LE(num_sampled, param.range_max)
+      << "Number of samples cannot exceed the number of possible classes";
+  if (batch_size <= 0)
+    return;
+  // the table holds the samples and the candidates of the last round at most half full
+  int table_size = 1;
+  while (table_size < 2 * (num_sampled + kUniqueSampleThreads))
+    table_size *= 2;
+  const int blocks =
+      std::min(batch_size, RandGenerator<gpu>::kNumRandomStates / kUniqueSampleThreads);
+  const size_t n = static_cast<size_t>(blocks) * table_size;
+  Stream<gpu>* s = ctx.get_stream<gpu>();
+
+  Tensor<gpu, 1, char> workspace = ctx.requested[1].get_space_typed<gpu, 1, char>(
+      Shape1(n * (sizeof(int64_t) + sizeof(int))), s);
+
+  int64_t* table_keys             = reinterpret_cast<int64_t*>(workspace.dptr_);
+  int* table_draws                = reinterpret_cast<int*>(table_keys + n);
+  RandGenerator<gpu, GType>* pgen = ctx.requested[0].get_parallel_random<gpu, GType>();
+  UniqueSampleZipfianKernel<<<blocks, kUniqueSampleThreads, 0, Stream<gpu>::GetStream(s)>>>(
+      *pgen,
+      batch_size,
+      num_sampled,
+      log(param.range_max),
+      table_size,
+      table_keys,
+      table_draws,
+      outputs[0].dptr<int64_t>(),
+      outputs[1].dptr<int64_t>());
+  MSHADOW_CUDA_POST_KERNEL_CHECK(UniqueSampleZipfianKernel);
+}
+
+NNVM_REGISTER_OP(_sample_unique_zipfian)
+    .set_attr<FCompute>("FCompute<gpu>", SampleUniqueZifpianGPU);
+
+}  // namespace op
+}  // namespace mxnet
@@ -81,7 +81,7 @@ inline bool SampleUniqueType(const nnvm::NodeAttrs& attrs,
 }
 
 inline std::vector<ResourceRequest> UniqueSampleResource(const NodeAttrs& attrs) {
-  return {ResourceRequest::kParallelRandom};
+  return {ResourceRequest::kParallelRandom, ResourceRequest::kTempSpace};
 }
 
 /*!
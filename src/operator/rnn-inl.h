@@ -1480,44 +1480,63 @@ class RNNOp {
       // adopt pseudo-fp16 for all architectures
       cudnnDataType_t dtype_with_fallback_ =
           (cudnnGetVersion() >= 7500 && dtype_ == CUDNN_DATA_HALF) ? CUDNN_DATA_FLOAT : dtype_;
-      cudnnRNNAlgo_t rnn_algo = CUDNN_RNN_ALGO_STANDARD;
-      dgrad_sync_needed_      = (rnn_algo == CUDNN_RNN_ALGO_STANDARD) && param_.bidirectional;
-      CUDNN_CALL(cudnnSetRNNDescriptor_v6(s->dnn_handle_,
-                                          rnn_desc_,
-                                          param_.state_size,
-                                          param_.num_layers,
-                                          dropout_desc_,
-                                          input_mode_,
-                                          direction_,
-                                          mode_,
-                                          rnn_algo,
-                                          dtype_with_fallback_));
-      cudnnMathType_t math_type = CUDNN_DEFAULT_MATH;
-      if (cudnn_tensor_core_ && rnn_algo == CUDNN_RNN_ALGO_STANDARD) {
-        math_type = CUDNN_TENSOR_OP_MATH;
-      }
+      auto set_rnn_desc = [&](cudnnRNNAlgo_t rnn_algo) {
+        cudnnStatus_t status = cudnnSetRNNDescriptor_v6(s->dnn_handle_,
+                                                        rnn_desc_,
+                                                        param_.state_size,
+                                                        param_.num_layers,
+                                                        dropout_desc_,
+                                                        input_mode_,
+                                                        direction_,
+                                                        mode_,
+                                                        rnn_algo,
+                                                        dtype_with_fallback_);
+        if (status != CUDNN_STATUS_SUCCESS)
+          return status;
+        cudnnMathType_t math_type = CUDNN_DEFAULT_MATH;
+        if (cudnn_tensor_core_ && rnn_algo == CUDNN_RNN_ALGO_STANDARD) {
+          math_type = CUDNN_TENSOR_OP_MATH;
+        }
 #if CUDNN_VERSION >= 7200
-      if (GetEnvAllowTensorCore() && GetEnvAllowTensorCoreConversion() &&
-          (DataType<DType>::kFlag != kFloat16)) {
-        math_type = CUDNN_TENSOR_OP_MATH_ALLOW_CONVERSION;
-      }
+        if (GetEnvAllowTensorCore() && GetEnvAllowTensorCoreConversion() &&
+            (DataType<DType>::kFlag != kFloat16)) {
+          math_type = CUDNN_TENSOR_OP_MATH_ALLOW_CONVERSION;
+        }
 #endif
-      CUDNN_CALL(cudnnSetRNNMatrixMathType(rnn_desc_, math_type));
+        CUDNN_CALL(cudnnSetRNNMatrixMathType(rnn_desc_, math_type));
 #if MXNET_USE_CUDNN_GE_7200
-      if (param_.projection_size.has_value()) {
-        CUDNN_CALL(cudnnSetRNNProjectionLayers(
-            s->dnn_handle_, rnn_desc_, param_.projection_size.value(), 0));
-      }
-      if (param_.use_sequence_length) {
-        CUDNN_CALL(cudnnSetRNNPaddingMode(rnn_desc_, CUDNN_RNN_PADDED_IO_ENABLED));
-      }
+        if (param_.projection_size.has_value()) {
+          CUDNN_CALL(cudnnSetRNNProjectionLayers(
+              s->dnn_handle_, rnn_desc_, param_.projection_size.value(), 0));
+        }
+        if (param_.use_sequence_length) {
+          CUDNN_CALL(cudnnSetRNNPaddingMode(rnn_desc_, CUDNN_RNN_PADDED_IO_ENABLED));
+        }
 #endif  // MXNET_USE_CUDNN_GE_7200
 
-      // Get temp space sizes
-      CUDNN_CALL(cudnnGetRNNWorkspaceSize(
-          s->dnn_handle_, rnn_desc_, param_.seq_length_, x_desc_vec_.data(), &workspace_byte_));
-      CUDNN_CALL(cudnnGetRNNTrainingReserveSize(
-          s->dnn_handle_, rnn_desc_, param_.seq_length_, x_desc_vec_.data(), &reserve_space_byte_));
+        // Get temp space sizes
+        status = cudnnGetRNNWorkspaceSize(
+            s->dnn_handle_, rnn_desc_, param_.seq_length_, x_desc_vec_.data(), &workspace_byte_);
+        if (status != CUDNN_STATUS_SUCCESS)
+          return status;
+        return cudnnGetRNNTrainingReserveSize(s->dnn_handle_,
+                                              rnn_desc_,
+                                              param_.seq_length_,
+                                              x_desc_vec_.data(),
+                                              &reserve_space_byte_);
+      };
+      // The persistent kernels keep the recurrent weights on chip for the whole sequence, which
+      // pays off when the batch is too small to fill the GPU. cuDNN rejects the configurations
+      // that do not fit, those fall back to the standard algorithm.
+      cudnnRNNAlgo_t rnn_algo = UsePersistentAlgo(s->dev_id) ? CUDNN_RNN_ALGO_PERSIST_STATIC :
+                                                               CUDNN_RNN_ALGO_STANDARD;
+      cudnnStatus_t status = set_rnn_desc(rnn_algo);
+      if (status != CUDNN_STATUS_SUCCESS && rnn_algo != CUDNN_RNN_ALGO_STANDARD) {
+        rnn_algo = CUDNN_RNN_ALGO_STANDARD;
+        status   = set_rnn_desc(rnn_algo);
+      }
+      CUDNN_CALL(status);
+      dgrad_sync_needed_ = (rnn_algo == CUDNN_RNN_ALGO_STANDARD) && param_.bidirectional;
       workspace_size_ = workspace_byte_ / sizeof(DType);
       // Allocate the reserve space
       reserve_space_ = Storage::Get()->Alloc(reserve_space_byte_, Context::GPU(s->dev_id));
@@ -1573,6 +1592,16 @@ class RNNOp {
     }
 #endif  // MXNET_USE_CUDNN == 1 && defined(__CUDACC__)
   }
+#if MXNET_USE_CUDNN == 1 && defined(__CUDACC__)
+  // Whether to try the persistent cuDNN RNN kernels, for small batches of sequences of equal
+  // length. MXNET_CUDNN_RNN_PERSIST_MAX_BATCH is the largest such batch, 0 turns them off.
+  inline bool UsePersistentAlgo(int dev_id) const {
+    static const int max_batch = dmlc::GetEnv("MXNET_CUDNN_RNN_PERSIST_MAX_BATCH", 0);
+    return param_.batch_size_ <= max_batch && !param_.use_sequence_length &&
+           !param_.projection_size.has_value() && SMArch(dev_id) >= 60;
+  }
+#endif  // MXNET_USE_CUDNN == 1 && defined(__CUDACC__)
+
   // naive private variables used in CPU Context
   bool init_space_, temp_init_space_;
   size_t reserve_cpu_space_size_, temp_cpu_space_size_;
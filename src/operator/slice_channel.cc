@@ -106,7 +106,14 @@ Example::
     .add_argument("data", "NDArray-or-Symbol", "The input")
     .add_arguments(SliceChannelParam::__FIELDS__());
 
-NNVM_REGISTER_OP(SliceChannel).add_alias("split").add_alias("_npx_slice_channel");
+NNVM_REGISTER_OP(SliceChannel)
+    .add_alias("split")
+    .add_alias("_npx_slice_channel")
+    .set_attr<FSplitAxis>("FSplitAxis", [](const NodeAttrs& attrs, int ndim) {
+      SliceChannelParam param;
+      param.InitAllowUnknown(attrs.dict);
+      return param.axis < 0 ? param.axis + ndim : param.axis;
+    });
 
 }  // namespace op
 }  // namespace mxnet
@@ -33,8 +33,10 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include "./operator_common.h"
+#include "./mxnet_op.h"
 #include "./linalg.h"
 
 namespace mxnet {
@@ -68,6 +70,113 @@ struct SpatialTransformerParam : public dmlc::Parameter<SpatialTransformerParam>
   }
 };
 
+/*!
+ * \brief normalized target coordinate of pixel i along an axis of the given size, in [-1, 1]
+ */
+template <typename AType>
+MSHADOW_XINLINE AType SpatialTransformerCoord(const index_t i, const index_t size) {
+  return AType(-1) + AType(i) * AType(2) / AType(size - 1);
+}
+
+/*!
+ * \brief fills grid_dst (3, o_h * o_w) with the homogeneous target coordinates (x, y, 1)
+ */
+struct SpatialTransformerGridDst {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* grid_dst,
+                                  const index_t o_h,
+                                  const index_t o_w) {
+    using AType            = typename mxnet_op::AccType<DType>::type;
+    const index_t o_hw     = o_h * o_w;
+    grid_dst[i]            = DType(SpatialTransformerCoord<AType>(i % o_w, o_w));
+    grid_dst[o_hw + i]     = DType(SpatialTransformerCoord<AType>(i / o_w, o_h));
+    grid_dst[2 * o_hw + i] = DType(1);
+  }
+};
+
+/*!
+ * \brief affine grid generation fused with bilinear sampling, one work item per output pixel
+ *  of the whole batch. The source coordinate is computed from loc on the fly, so no per-sample
+ *  gemm is needed, and the four bilinear weights are shared by all channels of the pixel.
+ *  The source coordinate is still stored in grid_src since backward consumes it.
+ */
+struct SpatialTransformerAffineSampler {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  DType* grid_src,
+                                  const DType* data,
+                                  const DType* loc,
+                                  const index_t channels,
+                                  const index_t i_h,
+                                  const index_t i_w,
+                                  const index_t o_h,
+                                  const index_t o_w) {
+    using AType        = typename mxnet_op::AccType<DType>::type;
+    const index_t o_hw = o_h * o_w;
+    const index_t i_hw = i_h * i_w;
+    const index_t n    = i / o_hw;
+    const index_t p    = i % o_hw;
+    const AType x_dst  = SpatialTransformerCoord<AType>(p % o_w, o_w);
+    const AType y_dst  = SpatialTransformerCoord<AType>(p / o_w, o_h);
+    const DType* theta = loc + n * 6;
+    const AType x_src  = AType(theta[0]) * x_dst + AType(theta[1]) * y_dst + AType(theta[2]);
+    const AType y_src  = AType(theta[3]) * x_dst + AType(theta[4]) * y_dst + AType(theta[5]);
+    // the source grid is kept for backward
+    grid_src[n * 2 * o_hw + p]        = DType(x_src);
+    grid_src[n * 2 * o_hw + o_hw + p] = DType(y_src);
+    // map the normalized source coordinate to input pixels
+    const AType y_real   = (y_src + 1) * (i_h - 1) / 2;
+    const AType x_real   = (x_src + 1) * (i_w - 1) / 2;
+    const index_t top    = static_cast<index_t>(floor(y_real));
+    const index_t left   = static_cast<index_t>(floor(x_real));
+    const AType top_w    = 1 - (y_real - top);
+    const AType left_w   = 1 - (x_real - left);
+    const bool top_in    = top >= 0 && top <= i_h - 1;
+    const bool bottom_in = top + 1 >= 0 && top + 1 <= i_h - 1;
+    const bool left_in   = left >= 0 && left <= i_w - 1;
+    const bool right_in  = left + 1 >= 0 && left + 1 <= i_w - 1;
+    const index_t offset = top * i_w + left;
+    const DType* src     = data + n * channels * i_hw;
+    DType* dst           = out + n * channels * o_hw + p;
+    for (index_t c = 0; c < channels; ++c, src += i_hw, dst += o_hw) {
+      AType value = 0;
+      if (top_in && left_in)
+        value += AType(src[offset]) * top_w * left_w;
+      if (top_in && right_in)
+        value += AType(src[offset + 1]) * top_w * (1 - left_w);
+      if (bottom_in && left_in)
+        value += AType(src[offset + i_w]) * (1 - top_w) * left_w;
+      if (bottom_in && right_in)
+        value += AType(src[offset + i_w + 1]) * (1 - top_w) * (1 - left_w);
+      *dst = DType(value);
+    }
+  }
+};
+
+/*!
+ * \brief gloc = dot(grid_src, grid_dst.T()) over the stacked (2N, HW) grid_src, used where
+ *  no gemm is available for DType (fp16 on cpu)
+ */
+struct SpatialTransformerLocGrad {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* gloc,
+                                  const DType* grid_src,
+                                  const DType* grid_dst,
+                                  const index_t o_hw) {
+    using AType    = typename mxnet_op::AccType<DType>::type;
+    const DType* g = grid_src + (i / 3) * o_hw;
+    const DType* d = grid_dst + (i % 3) * o_hw;
+    AType sum      = 0;
+    for (index_t p = 0; p < o_hw; ++p) {
+      sum += AType(g[p]) * AType(d[p]);
+    }
+    gloc[i] = DType(sum);
+  }
+};
+
 template <typename xpu, typename DType>
 class SpatialTransformerOp : public Operator {
  public:
@@ -89,28 +198,24 @@ class SpatialTransformerOp : public Operator {
     Tensor<xpu, 4, DType> out      = out_data[st::kOut].get<xpu, 4, DType>(s);
     Tensor<xpu, 2, DType> grid_dst = out_data[st::kGridDst].get<xpu, 2, DType>(s);
     Tensor<xpu, 3, DType> grid_src = out_data[st::kGridSrc].get<xpu, 3, DType>(s);
-    Shape<3> loc_shape             = Shape3(data.size(0), 2, 3);
-    Tensor<xpu, 3, DType> loc      = in_data[st::kLoc].get_with_shape<xpu, 3, DType>(loc_shape, s);
-    Tensor<cpu, 2, DType> workspace =
-        ctx.requested[st::kTempSpace].get_host_space_typed<2, DType>(grid_dst.shape_);
-    for (index_t i = 1; i <= workspace.size(1); i++) {
-      // grid dst coordinate is (x, y, 1)
-      workspace[0][i - 1] =
-          -1.0 + (i - 1) % param_.target_shape[1] * 2.0 / (param_.target_shape[1] - 1);
-      workspace[1][i - 1] =
-          -1.0 + (i - 1) / param_.target_shape[1] * 2.0 / (param_.target_shape[0] - 1);
-      workspace[2][i - 1] = 1.0;
-    }
-    Copy(grid_dst, workspace, grid_dst.stream_);
-    for (index_t batch = 0; batch < data.size(0); batch++) {
-      if (param_.transform_type == st::kAffine) {
-        // Legacy approach shown here for comparison:
-        //    grid_src[batch] = dot(loc[batch], grid_dst);
-        linalg_gemm(loc[batch], grid_dst, grid_src[batch], false, false, s);
-      }
-    }
-    if (param_.sampler_type == st::kBilinear) {
-      BilinearSamplingForward(out, data, grid_src);
+    Tensor<xpu, 2, DType> loc      = in_data[st::kLoc].get<xpu, 2, DType>(s);
+    const index_t o_h              = out.size(2);
+    const index_t o_w              = out.size(3);
+    mxnet_op::Kernel<SpatialTransformerGridDst, xpu>::Launch(
+        s, o_h * o_w, grid_dst.dptr_, o_h, o_w);
+    if (param_.transform_type == st::kAffine && param_.sampler_type == st::kBilinear) {
+      // grid_src[n] = dot(loc[n], grid_dst), computed inside the sampling kernel
+      mxnet_op::Kernel<SpatialTransformerAffineSampler, xpu>::Launch(s,
+                                                                    out.size(0) * o_h * o_w,
+                                                                    out.dptr_,
+                                                                    grid_src.dptr_,
+                                                                    data.dptr_,
+                                                                    loc.dptr_,
+                                                                    data.size(1),
+                                                                    data.size(2),
+                                                                    data.size(3),
+                                                                    o_h,
+                                                                    o_w);
     }
   }
 
@@ -131,17 +236,22 @@ class SpatialTransformerOp : public Operator {
     Tensor<xpu, 4, DType> gdata    = in_grad[st::kData].get<xpu, 4, DType>(s);
     Tensor<xpu, 2, DType> grid_dst = out_data[st::kGridDst].get<xpu, 2, DType>(s);
     Tensor<xpu, 3, DType> grid_src = out_data[st::kGridSrc].get<xpu, 3, DType>(s);
-    Shape<3> loc_shape             = Shape3(data.size(0), 2, 3);
-    Tensor<xpu, 3, DType> gloc     = in_grad[st::kLoc].get_with_shape<xpu, 3, DType>(loc_shape, s);
     gdata                          = 0.0;
     if (param_.sampler_type == st::kBilinear) {
       BilinearSamplingBackward(gdata, grid_src, grad, data);
     }
-    for (index_t batch = 0; batch < data.size(0); batch++) {
-      if (param_.transform_type == st::kAffine) {
-        // Legacy approach shown here for comparison:
-        //   gloc[batch] = dot(grid_src[batch], grid_dst.T());
-        linalg_gemm(grid_src[batch], grid_dst, gloc[batch], false, true, s);
+    if (param_.transform_type == st::kAffine) {
+      // gloc[n] = dot(grid_src[n], grid_dst.T()) for the whole batch at once
+      const index_t o_hw = grid_dst.size(1);
+      Tensor<xpu, 2, DType> grid_src_2d =
+          out_data[st::kGridSrc].get_with_shape<xpu, 2, DType>(Shape2(data.size(0) * 2, o_hw), s);
+      Tensor<xpu, 2, DType> gloc_2d =
+          in_grad[st::kLoc].get_with_shape<xpu, 2, DType>(Shape2(data.size(0) * 2, 3), s);
+      if (std::is_same<xpu, cpu>::value && std::is_same<DType, mshadow::half::half_t>::value) {
+        mxnet_op::Kernel<SpatialTransformerLocGrad, xpu>::Launch(
+            s, gloc_2d.shape_.Size(), gloc_2d.dptr_, grid_src_2d.dptr_, grid_dst.dptr_, o_hw);
+      } else {
+        linalg_gemm(grid_src_2d, grid_dst, gloc_2d, false, true, s);
       }
     }
   }
@@ -255,10 +365,6 @@ class SpatialTransformerProp : public OperatorProperty {
     return {out_grad[st::kOut], out_data[st::kGridDst], out_data[st::kGridSrc], in_data[st::kData]};
   }
 
-  std::vector<ResourceRequest> ForwardResource(const mxnet::ShapeVector& in_shape) const override {
-    return {ResourceRequest::kTempSpace};
-  }
-
 #if MXNET_USE_CUDNN == 1
   std::vector<ResourceRequest> BackwardResource(const mxnet::ShapeVector& in_shape) const override {
     return {ResourceRequest::kTempSpace};
@@ -33,57 +33,6 @@ static MSHADOW_CINLINE bool between(const DType value,
   return value >= lowerBound && value <= upperBound;
 }
 
-template <typename DType>
-inline void BilinearSamplingForward(const Tensor<cpu, 4, DType>& output,
-                                    const Tensor<cpu, 4, DType>& input,
-                                    const Tensor<cpu, 3, DType> grid_src) {
-  DType* out        = output.dptr_;
-  const DType* data = input.dptr_;
-  const DType* grid = grid_src.dptr_;
-  const index_t o_n = output.size(0), o_c = output.size(1), o_h = output.size(2),
-                o_w = output.size(3);
-  const index_t i_c = input.size(1), i_h = input.size(2), i_w = input.size(3);
-  for (index_t n = 0; n < static_cast<index_t>(o_n); ++n) {
-    for (index_t c = 0; c < static_cast<index_t>(o_c); ++c) {
-      for (index_t h = 0; h < static_cast<index_t>(o_h); ++h) {
-        for (index_t w = 0; w < static_cast<index_t>(o_w); ++w) {
-          const index_t out_index  = n * o_c * o_h * o_w + c * o_h * o_w + h * o_w + w;
-          const index_t grid_index = n * o_h * o_w * 2 + h * o_w + w;
-          const DType y_real       = (*(grid + grid_index + o_h * o_w) + 1) * (i_h - 1) / 2;
-          const DType x_real       = (*(grid + grid_index) + 1) * (i_w - 1) / 2;
-          const auto top_left_y    = static_cast<index_t>(std::floor(y_real));
-          const auto top_left_x    = static_cast<index_t>(std::floor(x_real));
-          const DType top_left_y_w = 1.0 - (y_real - top_left_y);
-          const DType top_left_x_w = 1.0 - (x_real - top_left_x);
-          const index_t data_index =
-              n * i_c * i_h * i_w + c * i_h * i_w + top_left_y * i_w + top_left_x;
-          DType top_left_v     = 0;
-          DType top_right_v    = 0;
-          DType bottom_left_v  = 0;
-          DType bottom_right_v = 0;
-          index_t lower_bound  = 0;
-          if (between(top_left_x, lower_bound, i_w - 1) &&
-              between(top_left_y, lower_bound, i_h - 1))
-            top_left_v = *(data + data_index);
-          if (between(top_left_x + 1, lower_bound, i_w - 1) &&
-              between(top_left_y, lower_bound, i_h - 1))
-            top_right_v = *(data + data_index + 1);
-          if (between(top_left_x, lower_bound, i_w - 1) &&
-              between(top_left_y + 1, lower_bound, i_h - 1))
-            bottom_left_v = *(data + data_index + i_w);
-          if (between(top_left_x + 1, lower_bound, i_w - 1) &&
-              between(top_left_y + 1, lower_bound, i_h - 1))
-            bottom_right_v = *(data + data_index + i_w + 1);
-          *(out + out_index) = top_left_v * top_left_y_w * top_left_x_w +
-                               top_right_v * top_left_y_w * (1.0 - top_left_x_w) +
-                               bottom_left_v * (1.0 - top_left_y_w) * top_left_x_w +
-                               bottom_right_v * (1.0 - top_left_y_w) * (1.0 - top_left_x_w);
-        }
-      }
-    }
-  }
-}
-
 template <typename DType>
 inline void BilinearSamplingBackward(const Tensor<cpu, 4, DType>& input_grad,
                                      const Tensor<cpu, 3, DType>& grid_src_data,
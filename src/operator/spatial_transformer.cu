@@ -35,58 +35,6 @@ __device__ bool between(DType value, int lowerBound, int upperBound) {
   return (value >= lowerBound && value <= upperBound);
 }
 
-template<typename DType>
-__global__ void
-/*
- * In order to not generate the code that uses too many
- * registers (resulting in too many resources requested
- * error) we need to tell the compiler that we will be
- * launching this kernel with cuda::kMaxThreadsPerBlock
- * threads per block. Setting __launch_bounds__ ensures
- * that such configuration can always be launched.
- */
-__launch_bounds__(cuda::kMaxThreadsPerBlock, 1)
-BilinearSamplingForwardKernel(const int i_c, const int i_h,
-                              const int i_w, const DType* data,
-                              const DType* grid, const int o_n,
-                              const int o_c, const int o_h,
-                              const int o_w, DType* out) {
-  for (int index = (blockIdx.x + blockIdx.y * gridDim.x) * blockDim.x + threadIdx.x;
-       index < o_n * o_c * o_h * o_w;
-       index += blockDim.x * gridDim.x * gridDim.y) {
-    // (n, c, h, w) is the element in out
-    int w                = index % o_w;
-    int h                = (index / o_w) % o_h;
-    int c                = (index / o_w / o_h) % o_c;
-    int n                = index / o_w / o_h / o_c;
-    index_t out_index    = n * o_c * o_h * o_w + c * o_h * o_w + h * o_w + w;
-    index_t grid_index   = n * o_h * o_w * 2 + h * o_w + w;
-    DType y_real         = (*(grid + grid_index + o_h * o_w) + 1) * (i_h - 1) / 2;
-    DType x_real         = (*(grid + grid_index) + 1) * (i_w - 1) / 2;
-    int top_left_y       = static_cast<int>(floor(y_real));
-    int top_left_x       = static_cast<int>(floor(x_real));
-    DType top_left_y_w   = 1.0 - (y_real - top_left_y);
-    DType top_left_x_w   = 1.0 - (x_real - top_left_x);
-    int data_index       = n * i_c * i_h * i_w + c * i_h * i_w + top_left_y * i_w + top_left_x;
-    DType top_left_v     = 0;
-    DType top_right_v    = 0;
-    DType bottom_left_v  = 0;
-    DType bottom_right_v = 0;
-    if (between(top_left_x, 0, i_w - 1) && between(top_left_y, 0, i_h - 1))
-      top_left_v = *(data + data_index);
-    if (between(top_left_x + 1, 0, i_w - 1) && between(top_left_y, 0, i_h - 1))
-      top_right_v = *(data + data_index + 1);
-    if (between(top_left_x, 0, i_w - 1) && between(top_left_y + 1, 0, i_h - 1))
-      bottom_left_v = *(data + data_index + i_w);
-    if (between(top_left_x + 1, 0, i_w - 1) && between(top_left_y + 1, 0, i_h - 1))
-      bottom_right_v = *(data + data_index + i_w + 1);
-    *(out + out_index) = top_left_v * top_left_y_w * top_left_x_w +
-                         top_right_v * top_left_y_w * (1.0 - top_left_x_w) +
-                         bottom_left_v * (1.0 - top_left_y_w) * top_left_x_w +
-                         bottom_right_v * (1.0 - top_left_y_w) * (1.0 - top_left_x_w);
-  }
-}
-
 /*
  * In order to not generate the code that uses too many
  * registers (resulting in too many resources requested
@@ -166,26 +114,6 @@ __global__ void __launch_bounds__(cuda::kMaxThreadsPerBlock, 1)
   }
 }
 
-template <typename DType>
-inline void BilinearSamplingForward(const Tensor<gpu, 4, DType>& output,
-                                    const Tensor<gpu, 4, DType>& input,
-                                    const Tensor<gpu, 3, DType> grid_src) {
-  DType* out        = output.dptr_;
-  const DType* data = input.dptr_;
-  const DType* grid = grid_src.dptr_;
-  int o_n = output.size(0), o_c = output.size(1), o_h = output.size(2), o_w = output.size(3);
-  int i_c = input.size(1), i_h = input.size(2), i_w = input.size(3);
-  using namespace cuda;
-  const int max_block = (output.shape_.Size() + kMaxThreadsPerBlock - 1) / kMaxThreadsPerBlock;
-  dim3 num_blocks(kMaxGridDim, (max_block + kMaxGridDim - 1) / kMaxGridDim);
-  dim3 threads_per_block(kMaxThreadsPerBlock);
-  CheckLaunchParam(num_blocks, threads_per_block, "spatial transformer forward");
-  cudaStream_t stream = Stream<gpu>::GetStream(output.stream_);
-  BilinearSamplingForwardKernel<DType><<<num_blocks, threads_per_block, 0, stream>>>(
-      i_c, i_h, i_w, data, grid, o_n, o_c, o_h, o_w, out);
-  MSHADOW_CUDA_POST_KERNEL_CHECK(BilinearSamplingForwardKernel);
-}
-
 template <typename DType>
 inline void BilinearSamplingBackward(const Tensor<gpu, 4, DType>& input_grad,
                                      const Tensor<gpu, 3, DType>& grid_src_data,
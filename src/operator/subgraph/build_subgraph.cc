@@ -21,6 +21,7 @@
  * \file build_subgraph.cc
  * \brief
  */
+#include <dmlc/timer.h>
 #include <nnvm/graph.h>
 #include <nnvm/pass.h>
 #include <unordered_set>
@@ -257,35 +258,37 @@ bool LabelSubgraph(const nnvm::Graph& g,
     non_subgraph_nodes.push_back(kv.first);
   }
   // check whether there is a cycle between the subgraph and its input/output nodes
-  auto is_ancestor = [&](const nnvm::Node* ancestor,
-                         const nnvm::Node* descendant,
-                         const std::vector<BiDirectedNode*>& snodes) {
-    if (ancestor == descendant)
-      return true;
-    std::unordered_set<nnvm::Node*> snode_set;
-    for (const auto& sn : snodes) {
-      snode_set.insert(sn->node);
-    }
+  std::unordered_set<const nnvm::Node*> snode_set;
+  for (const auto& sn : *subgraph_nodes) {
+    snode_set.insert(sn->node);
+  }
+  // the nodes reachable from a node through the output edges up to the node id max_nid, once
+  // each, where the paths cannot cross any subgraph node
+  auto descendants = [&](const nnvm::Node* ancestor, const uint32_t max_nid) {
+    std::unordered_set<const nnvm::Node*> visited{ancestor};
     std::stack<const nnvm::Node*> s;
-    s.push(descendant);
-    size_t count = 0;
-    while (!s.empty() && count < indexed_graph.num_nodes()) {
-      ++count;
+    s.push(ancestor);
+    while (!s.empty()) {
       const nnvm::Node* top = s.top();
       s.pop();
-      if (top == ancestor) {
-        return true;
-      }
-      for (const auto& entry : top->inputs) {
-        // when searching for the ancestor, the path cannot cross any subgraph node
-        if (!snode_set.count(entry.node.get())) {
-          s.push(entry.node.get());
+      for (const auto& kv : simple_nodes[indexed_graph.node_id(top)]->outputs) {
+        if (!indexed_graph.exist(kv.first) || indexed_graph.node_id(kv.first) > max_nid ||
+            snode_set.count(kv.first) || !visited.insert(kv.first).second) {
+          continue;
         }
+        s.push(kv.first);
       }
     }
-    return false;
+    return visited;
   };
   std::sort(non_subgraph_nodes.begin(), non_subgraph_nodes.end(), node_cmp);
+  // the last input node of the subgraph, beyond which no descendant closes a loop
+  uint32_t max_input_nid = 0;
+  for (const auto* node : non_subgraph_nodes) {
+    if (!non_subgraph_node_map.at(node).first.empty()) {
+      max_input_nid = std::max(max_input_nid, indexed_graph.node_id(node));
+    }
+  }
   int excluded_node_id = -1;
   for (size_t i = 0; i < non_subgraph_nodes.size(); ++i) {
     auto it1 = non_subgraph_node_map.find(non_subgraph_nodes[i]);
@@ -298,14 +301,17 @@ bool LabelSubgraph(const nnvm::Graph& g,
                                     indexed_graph.node_id(input_nodes.back()));
       excluded_node_id   = std::max(excluded_node_id, static_cast<int>(node_id));
     } else if (!input_nodes.empty()) {
-      // node i is an input to the subgraph, find out if there is a node j
-      // which is an output of the subgraph and also a child of node i.
+      // node i is an output of the subgraph, find out if there is a node j
+      // which is an input of the subgraph and also a descendant of node i.
+      if (indexed_graph.node_id(it1->first) > max_input_nid)
+        continue;
+      const auto reachable = descendants(it1->first, max_input_nid);
       for (size_t j = i + 1; j < non_subgraph_nodes.size(); ++j) {
         auto it2 = non_subgraph_node_map.find(non_subgraph_nodes[j]);
         CHECK(it2 != non_subgraph_node_map.end());
         // i is topologically before j, j might be a direct/indirect output node of i
         CHECK_LT(indexed_graph.node_id(it1->first), indexed_graph.node_id(it2->first));
-        if (!it2->second.first.empty() && is_ancestor(it1->first, it2->first, *subgraph_nodes)) {
+        if (!it2->second.first.empty() && reachable.count(it2->first)) {
           // found a loop
           const auto node_id = std::max(indexed_graph.node_id(input_nodes.back()),
                                         indexed_graph.node_id(it2->second.first.back()));
@@ -424,18 +430,20 @@ void SelectSubgraphNodes(nnvm::Graph* g,
     std::vector<BiDirectedNode*> filtered_nodes = subgraph_selector->Filter(preselected_nodes);
 
     // reset node labels that are not in filtered nodes
+    const std::unordered_set<BiDirectedNode*> filtered_set(filtered_nodes.begin(),
+                                                           filtered_nodes.end());
     for (const auto n : preselected_nodes) {
-      const auto nit = std::find(filtered_nodes.begin(), filtered_nodes.end(), n);
-      if (nit == filtered_nodes.end()) {
+      if (!filtered_set.count(n)) {
         n->label = -1;
       }
     }
 
     if (filtered_nodes.size()) {
       // make sure filtered_nodes is a subset of preselected_nodes
+      const std::unordered_set<BiDirectedNode*> preselected_set(preselected_nodes.begin(),
+                                                                preselected_nodes.end());
       for (const auto n : filtered_nodes) {
-        const auto nit = std::find(preselected_nodes.begin(), preselected_nodes.end(), n);
-        CHECK(nit != preselected_nodes.end())
+        CHECK(preselected_set.count(n))
             << "Node " << n->node->attrs.name
             << " is not found in the pre-selected subgraph nodes."
                " Please make sure that no new nodes were added in your subgraph"
@@ -667,8 +675,10 @@ void ReattachGraphInputs(const std::vector<nnvm::NodeEntry*>& input_entries,
 /*!
  * \brief Replace a set of nodes belonging to the same subgraph with a subgraph node
  * and keep the subgraph in the subgraph node.
+ * \return whether the subgraph node was created, false when the property rejected it and the
+ * graph is unchanged
  */
-void CreateSubgraphNode(nnvm::Graph* g,
+bool CreateSubgraphNode(nnvm::Graph* g,
                         const std::vector<BiDirectedNodePtr>& simple_nodes,
                         const std::vector<BiDirectedNode*>& subgraph_nodes,
                         const SubgraphSelectorV2Ptr& subgraph_selector,
@@ -773,6 +783,7 @@ void CreateSubgraphNode(nnvm::Graph* g,
     LOG(INFO) << "Subgraph node not created, output_entries not updated.";
   PrintNodeEntries(output_entries);
 #endif
+  return n != nullptr;
 }
 
 /*!
@@ -858,17 +869,19 @@ nnvm::Graph BuildSubgraph(nnvm::Graph&& g) {
       LOG(INFO) << "The graph has no attribute of subgraph_property attached. "
                    "The original graph is returned.";
     }
+    g.attrs["subgraph_num_changed"] = std::make_shared<nnvm::any>(size_t(0));
     return std::move(g);
   }
   using namespace sg;
 
   const SubgraphPropertyPtr& subg_prop = g.GetAttr<SubgraphPropertyPtr>("subgraph_property");
+  const std::string& prop_name = subg_prop->HasAttr("property_name") ?
+                                     subg_prop->GetAttr<std::string>("property_name") :
+                                     "partition graph";
   if (verbose > 1) {
-    const std::string& prop_name = subg_prop->HasAttr("property_name") ?
-                                       subg_prop->GetAttr<std::string>("property_name") :
-                                       "partition graph";
     LOG(INFO) << "start to execute " << prop_name << ".";
   }
+  const double start = dmlc::GetTime();
   // top sort NodeEntry of all the nodes' inputs
   std::unordered_map<const nnvm::NodeEntry*, size_t> entry_top_order_map;
   TopSortEntries(g, &entry_top_order_map);
@@ -880,6 +893,7 @@ nnvm::Graph BuildSubgraph(nnvm::Graph&& g) {
   std::vector<SubgraphSelectorV2Ptr> subgraph_selectors;
   FindSubgraphs(&g, *subg_prop, simple_nodes, &subgraph_nodes, &subgraph_selectors);
   CHECK_EQ(subgraph_nodes.size(), subgraph_selectors.size());
+  size_t num_changed = 0;
   for (size_t i = 0; i < subgraph_nodes.size(); ++i) {
 #if DEBUG_SUBGRAPH
     std::set<BiDirectedNode*> simple_node_set(subgraph_nodes[i].begin(), subgraph_nodes[i].end());
@@ -888,13 +902,22 @@ nnvm::Graph BuildSubgraph(nnvm::Graph&& g) {
 #endif
     auto ptype = subg_prop->GetPropertyType();
     if (ptype == SubgraphProperty::SgPropertyType::kCreate) {
-      CreateSubgraphNode(
+      num_changed += CreateSubgraphNode(
           &g, simple_nodes, subgraph_nodes[i], subgraph_selectors[i], i, &entry_top_order_map);
     } else {
       CHECK_EQ(ptype, SubgraphProperty::SgPropertyType::kAdjust);
       AdjustSubgraphNode(&g, subgraph_nodes[i], subgraph_selectors[i], i);
+      ++num_changed;
     }
   }
+  // the callers applying several properties in a row reuse the graph, its indexed graph and
+  // inferred attributes for the next property when nothing changed
+  g.attrs["subgraph_num_changed"] = std::make_shared<nnvm::any>(num_changed);
+  if (verbose > 1) {
+    LOG(INFO) << "finished " << prop_name << " in " << (dmlc::GetTime() - start) * 1000
+              << " ms over " << simple_nodes.size() << " nodes, changing " << num_changed
+              << " of " << subgraph_nodes.size() << " subgraphs found.";
+  }
   return std::move(g);
 }
 
@@ -0,0 +1,360 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file constant_folding_pass.cc
+ * \brief Graph pass evaluating the subexpressions of the parameters of an inference graph
+ */
+#include <mxnet/imperative.h>
+#include <mxnet/ndarray.h>
+#include <mxnet/op_attr_types.h>
+#include <nnvm/graph.h>
+#include <nnvm/pass.h>
+
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "../nn/batch_norm-inl.h"
+#include "../nn/convolution-inl.h"
+#include "../nn/fully_connected-inl.h"
+#include "../operator_common.h"
+
+namespace mxnet {
+
+namespace {
+
+using nnvm::Graph;
+using nnvm::Node;
+using nnvm::NodeEntry;
+using nnvm::ObjectPtr;
+
+/*! \brief values of the nodes whose outputs do not change between inference calls */
+using ConstantMap = std::unordered_map<const Node*, std::vector<NDArray>>;
+/*! \brief consumers of the outputs of a node, as (node, input index) */
+using UseMap = std::unordered_map<const Node*, std::vector<std::pair<Node*, uint32_t>>>;
+
+/*!
+ * \brief The arguments and auxiliary states given to optimize_for, except for the inputs
+ *  listed in the comma separated option data_names.
+ */
+ConstantMap FindConstants(const Graph& g) {
+  std::unordered_set<std::string> data_names;
+  const auto& options = g.GetAttr<std::unordered_map<std::string, std::string>>("options_map");
+  auto it             = options.find("data_names");
+  if (it != options.end()) {
+    std::istringstream names(it->second);
+    std::string name;
+    while (std::getline(names, name, ','))
+      data_names.insert(name);
+  }
+  std::unordered_map<std::string, NDArray*> values;
+  for (const char* kind : {"arg", "aux"}) {
+    const std::string prefix = std::string("in_") + kind;
+    NDArray** arrays         = g.GetAttr<NDArray**>(prefix);
+    const auto& names        = g.GetAttr<std::vector<std::string>>(prefix + "_names");
+    if (arrays == nullptr)
+      continue;
+    for (size_t i = 0; i < names.size(); ++i) {
+      if (arrays[i] != nullptr && !arrays[i]->is_none() && data_names.count(names[i]) == 0)
+        values.emplace(names[i], arrays[i]);
+    }
+  }
+  ConstantMap constants;
+  nnvm::DFSVisit(g.outputs, [&](const ObjectPtr& node) {
+    if (!node->is_variable())
+      return;
+    auto value = values.find(node->attrs.name);
+    if (value != values.end())
+      constants[node.get()] = {*value->second};
+  });
+  return constants;
+}
+
+/*!
+ * \brief Whether the outputs of the node only depend on its inputs. Random operators,
+ *  operators updating their inputs and stateful operators are never folded.
+ */
+bool CanFold(const Node& node) {
+  static const auto& fmutate     = nnvm::Op::GetAttr<nnvm::FMutateInputs>("FMutateInputs");
+  static const auto& fstateful   = nnvm::Op::GetAttr<FCreateOpState>("FCreateOpState");
+  static const auto& fresource   = nnvm::Op::GetAttr<FResourceRequest>("FResourceRequest");
+  static const auto& fresourceex = nnvm::Op::GetAttr<FResourceRequestEx>("FResourceRequestEx");
+  const nnvm::Op* op             = node.op();
+  if (node.inputs.empty() || fmutate.count(op) || fstateful.count(op) ||
+      !node.attrs.subgraphs.empty())
+    return false;
+  std::vector<ResourceRequest> reqs;
+  if (fresourceex.count(op)) {
+    reqs = fresourceex[op](node.attrs, Context::kCPU, DispatchMode::kFCompute);
+  } else if (fresource.count(op)) {
+    reqs = fresource[op](node.attrs);
+  }
+  for (const auto& req : reqs) {
+    if (req.type == ResourceRequest::kRandom || req.type == ResourceRequest::kParallelRandom)
+      return false;
+  }
+  return true;
+}
+
+UseMap FindUses(const Graph& g) {
+  UseMap uses;
+  nnvm::DFSVisit(g.outputs, [&](const ObjectPtr& node) {
+    for (uint32_t i = 0; i < node->inputs.size(); ++i)
+      uses[node->inputs[i].node.get()].emplace_back(node.get(), i);
+  });
+  return uses;
+}
+
+std::string ScalarString(double value) {
+  std::ostringstream os;
+  os << std::setprecision(std::numeric_limits<double>::max_digits10) << value;
+  return os.str();
+}
+
+ObjectPtr MakeFoldNode(const char* op_name,
+                       const std::string& name,
+                       const std::vector<NodeEntry>& inputs,
+                       const std::unordered_map<std::string, std::string>& dict = {}) {
+  return op::MakeNode(op_name, name, inputs, &dict, nullptr);
+}
+
+/*!
+ * \brief Rewrite the BatchNorm nodes applied to the output of a Convolution or FullyConnected
+ *  node with constant weights into a scaling of the weights and a new bias. The new weights
+ *  and bias are expressions of constants, which FoldConstants evaluates.
+ */
+void FoldBatchNorm(Graph* g, const ConstantMap& constants) {
+  static const Op* bn_op   = Op::Get("BatchNorm");
+  static const Op* conv_op = Op::Get("Convolution");
+  static const Op* fc_op   = Op::Get("FullyConnected");
+  const UseMap uses        = FindUses(*g);
+  std::unordered_map<const Node*, size_t> output_uses;
+  for (const auto& e : g->outputs)
+    ++output_uses[e.node.get()];
+  auto is_constant = [&](const NodeEntry& e) { return constants.count(e.node.get()) != 0; };
+
+  std::vector<ObjectPtr> bn_nodes;
+  nnvm::DFSVisit(g->outputs, [&](const ObjectPtr& node) {
+    if (node->op() == bn_op)
+      bn_nodes.push_back(node);
+  });
+  std::unordered_map<const Node*, ObjectPtr> replaced;
+  for (const auto& bn : bn_nodes) {
+    const auto& bn_param = nnvm::get<op::BatchNormParam>(bn->attrs.parsed);
+    const Node* src      = bn->inputs[0].node.get();
+    if (bn_param.axis != 1 || src->is_variable())
+      continue;
+    if (src->op() == conv_op) {
+      const auto& layout = nnvm::get<op::ConvolutionParam>(src->attrs.parsed).layout;
+      if (layout.has_value() && layout.value() != mshadow::kNCW &&
+          layout.value() != mshadow::kNCHW && layout.value() != mshadow::kNCDHW)
+        continue;
+    } else if (src->op() != fc_op ||
+               !nnvm::get<op::FullyConnectedParam>(src->attrs.parsed).flatten) {
+      continue;
+    }
+    // the unnormalized output and the batch statistics must not be used elsewhere
+    auto src_uses = uses.find(src);
+    if (src_uses == uses.end() || src_uses->second.size() != 1 || output_uses.count(src))
+      continue;
+    bool only_output = true;
+    auto bn_uses     = uses.find(bn.get());
+    if (bn_uses != uses.end()) {
+      for (const auto& use : bn_uses->second)
+        only_output = only_output && use.first->inputs[use.second].index == 0;
+    }
+    for (const auto& e : g->outputs)
+      only_output = only_output && (e.node != bn || e.index == 0);
+    const bool has_bias = src->inputs.size() > 2;
+    if (!only_output || !is_constant(src->inputs[1]) || (has_bias && !is_constant(src->inputs[2])))
+      continue;
+    bool stats_constant = true;
+    for (size_t i = 1; i < bn->inputs.size(); ++i)
+      stats_constant = stats_constant && is_constant(bn->inputs[i]);
+    if (!stats_constant)
+      continue;
+
+    // scale = gamma / sqrt(var + eps), bias' = (bias - mean) * scale + beta
+    const std::string& name = bn->attrs.name;
+    const NodeEntry& gamma  = bn->inputs[1];
+    const NodeEntry& beta   = bn->inputs[2];
+    const NodeEntry& mean   = bn->inputs[3];
+    const NodeEntry& var    = bn->inputs[4];
+    NodeEntry var_eps(MakeFoldNode("_plus_scalar",
+                                   name + "_var_eps",
+                                   {var},
+                                   {{"scalar", ScalarString(bn_param.eps)}, {"is_int", "False"}}));
+    NodeEntry inv_std(MakeFoldNode("rsqrt", name + "_inv_std", {var_eps}));
+    NodeEntry scale = inv_std;
+    if (!bn_param.fix_gamma)
+      scale = NodeEntry(MakeFoldNode("elemwise_mul", name + "_scale", {gamma, inv_std}));
+    std::string scale_shape = "(-1";
+    const int weight_ndim   = constants.at(src->inputs[1].node.get())[0].shape().ndim();
+    for (int i = 1; i < weight_ndim; ++i)
+      scale_shape += ",1";
+    scale_shape += ")";
+    NodeEntry weight_scale(
+        MakeFoldNode("Reshape", name + "_weight_scale", {scale}, {{"shape", scale_shape}}));
+    NodeEntry weight(MakeFoldNode(
+        "broadcast_mul", src->attrs.name + "_folded_weight", {src->inputs[1], weight_scale}));
+    NodeEntry shift(MakeFoldNode("negative", name + "_shift", {mean}));
+    if (has_bias)
+      shift = NodeEntry(MakeFoldNode("elemwise_sub", name + "_shift", {src->inputs[2], mean}));
+    NodeEntry shift_scale(MakeFoldNode("elemwise_mul", name + "_shift_scale", {shift, scale}));
+    NodeEntry bias(
+        MakeFoldNode("elemwise_add", src->attrs.name + "_folded_bias", {shift_scale, beta}));
+
+    auto dict       = src->attrs.dict;
+    dict["no_bias"] = "False";
+    // named after the BatchNorm node, whose outputs it replaces
+    replaced[bn.get()] =
+        MakeFoldNode(src->op()->name.c_str(), name, {src->inputs[0], weight, bias}, dict);
+  }
+
+  if (replaced.empty())
+    return;
+  auto rewire = [&](NodeEntry* e) {
+    auto it = replaced.find(e->node.get());
+    if (it != replaced.end())
+      *e = NodeEntry(it->second);
+  };
+  nnvm::DFSVisit(g->outputs, [&](const ObjectPtr& node) {
+    for (auto& e : node->inputs)
+      rewire(&e);
+  });
+  Graph folded;
+  folded.outputs = g->outputs;
+  for (auto& e : folded.outputs)
+    rewire(&e);
+  folded.attrs = std::move(g->attrs);
+  *g           = std::move(folded);
+}
+
+/*!
+ * \brief Evaluate the nodes whose inputs are all constant and replace the constant entries
+ *  read by the remaining nodes with new variables holding their values.
+ */
+void FoldConstants(Graph* g,
+                   ConstantMap* constants,
+                   std::vector<NDArray*>* new_args,
+                   std::vector<std::string>* new_arg_names) {
+  std::unordered_set<std::string> names;
+  std::vector<ObjectPtr> order;
+  nnvm::DFSVisit(g->outputs, [&](const ObjectPtr& node) {
+    names.insert(node->attrs.name);
+    order.push_back(node);
+  });
+  // inference semantics, e.g. for Dropout, and nothing is recorded for autograd
+  const bool prev_training  = Imperative::Get()->set_is_training(false);
+  const bool prev_recording = Imperative::Get()->set_is_recording(false);
+  for (const auto& node : order) {
+    if (node->is_variable() || !CanFold(*node))
+      continue;
+    std::vector<NDArray*> inputs;
+    for (const auto& e : node->inputs) {
+      auto it = constants->find(e.node.get());
+      if (it == constants->end())
+        break;
+      inputs.push_back(&it->second[e.index]);
+    }
+    if (inputs.size() != node->inputs.size())
+      continue;
+    std::vector<NDArray> outputs(node->num_outputs());
+    std::vector<NDArray*> output_ptrs;
+    for (auto& out : outputs)
+      output_ptrs.push_back(&out);
+    Imperative::Get()->Invoke(inputs[0]->ctx(), node->attrs, inputs, output_ptrs);
+    (*constants)[node.get()] = std::move(outputs);
+  }
+  Imperative::Get()->set_is_recording(prev_recording);
+  Imperative::Get()->set_is_training(prev_training);
+
+  // entries crossing from folded nodes to the others become variables
+  std::unordered_map<std::string, ObjectPtr> variables;
+  auto replace = [&](NodeEntry* e) {
+    const Node* src = e->node.get();
+    if (src->is_variable() || constants->count(src) == 0)
+      return;
+    std::string key = src->attrs.name + "#" + std::to_string(e->index);
+    auto it         = variables.find(key);
+    if (it == variables.end()) {
+      std::string name = src->attrs.name;
+      if (src->num_outputs() > 1)
+        name += "_output" + std::to_string(e->index);
+      while (names.count(name))
+        name += "_folded";
+      names.insert(name);
+      ObjectPtr var   = Node::Create();
+      var->attrs.op   = nullptr;
+      var->attrs.name = name;
+      new_args->push_back(new NDArray(constants->at(src)[e->index]));
+      new_arg_names->push_back(name);
+      it = variables.emplace(key, var).first;
+    }
+    *e = NodeEntry{it->second, 0, 0};
+  };
+  for (const auto& node : order) {
+    if (constants->count(node.get()) == 0) {
+      for (auto& e : node->inputs)
+        replace(&e);
+    }
+  }
+  Graph folded;
+  folded.outputs = g->outputs;
+  for (auto& e : folded.outputs)
+    replace(&e);
+  folded.attrs = std::move(g->attrs);
+  *g           = std::move(folded);
+}
+
+}  // namespace
+
+/*!
+ * \brief Constant folding for deployment. Nodes that only depend on the parameters given to
+ *  optimize_for are evaluated once and replaced by new parameters holding their values, after
+ *  BatchNorm nodes were merged into the weights of the preceding Convolution or FullyConnected
+ *  node. Inputs listed in the data_names option are never folded.
+ */
+nnvm::Graph ConstantFolding(nnvm::Graph&& g) {
+  std::vector<NDArray*> new_args;
+  std::vector<std::string> new_arg_names;
+  ConstantMap constants = FindConstants(g);
+  if (!constants.empty()) {
+    FoldBatchNorm(&g, constants);
+    FoldConstants(&g, &constants, &new_args, &new_arg_names);
+  }
+  g.attrs["new_args"]      = std::make_shared<nnvm::any>(std::move(new_args));
+  g.attrs["new_arg_names"] = std::make_shared<nnvm::any>(std::move(new_arg_names));
+  g.attrs["new_aux"]       = std::make_shared<nnvm::any>(std::vector<NDArray*>());
+  g.attrs["new_aux_names"] = std::make_shared<nnvm::any>(std::vector<std::string>());
+  return std::move(g);
+}
+
+NNVM_REGISTER_PASS(ConstantFolding)
+    .describe("Evaluate the subexpressions of the parameters of an inference graph once.")
+    .set_body(ConstantFolding)
+    .set_change_graph(true);
+
+}  // namespace mxnet
@@ -0,0 +1,160 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef MXNET_OPERATOR_SUBGRAPH_CUDNN_CUDNN_BN_ADD_RELU_PROPERTY_H_
+#define MXNET_OPERATOR_SUBGRAPH_CUDNN_CUDNN_BN_ADD_RELU_PROPERTY_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../nn/batch_norm-inl.h"
+#include "./cudnn_subgraph_base-inl.h"
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * This selects BatchNorm -> add -> relu chains, where the BatchNorm and the add have no other
+ * consumer and the other operand of the add comes from outside of the chain.
+ */
+class SgCuDNNBNAddReLUSelector : public SubgraphSelector {
+ public:
+  enum SelectStatusBNAddReLU { kFail = 0, kStart, kAdd, kSuccess };
+
+  bool Select(const nnvm::Node& n) override {
+    if (n.op() && n.op()->name == "BatchNorm") {
+      status_ = kStart;
+      matched_.assign(1, &n);
+      return true;
+    }
+    return false;
+  }
+
+  bool SelectInput(const nnvm::Node& n, const nnvm::Node& new_node) override {
+    return false;
+  }
+
+  bool SelectOutput(const nnvm::Node& n, const nnvm::Node& new_node) override {
+    if (status_ == kFail)
+      return false;
+    if (matched_.back() != &n) {
+      // another consumer of a matched node would need its intermediate result
+      if (std::find(matched_.begin(), matched_.end(), &n) != matched_.end())
+        status_ = kFail;
+      return false;
+    }
+    if (status_ == kSuccess)
+      return false;
+    if (status_ == kStart && CuDNNIsResidualAdd(new_node, n, matched_)) {
+      matched_.push_back(&new_node);
+      status_ = kAdd;
+      return true;
+    }
+    if (status_ == kAdd && CuDNNIsReLU(new_node)) {
+      matched_.push_back(&new_node);
+      status_ = kSuccess;
+      return true;
+    }
+    status_ = kFail;
+    return false;
+  }
+
+  std::vector<nnvm::Node*> Filter(const std::vector<nnvm::Node*>& candidates) override {
+    if (status_ == kSuccess && candidates.size() == matched_.size())
+      return candidates;
+    return std::vector<nnvm::Node*>();
+  }
+
+  void Reset() override {
+    status_ = kFail;
+    matched_.clear();
+  }
+
+ private:
+  SelectStatusBNAddReLU status_ = kFail;
+  std::vector<const nnvm::Node*> matched_;
+};
+
+/*!
+ * This subgraph property replaces BatchNorm -> add -> relu with _contrib_BatchNormAddRelu, whose
+ * training passes are single cuDNN kernels. It applies to training graphs as well.
+ */
+class SgCuDNNBNAddReLUProperty : public SubgraphProperty {
+ public:
+  static SubgraphPropertyPtr Create() {
+    static const std::string& name = "cuDNN BN + Add + ReLU optimization pass";
+    auto property                  = std::make_shared<SgCuDNNBNAddReLUProperty>();
+    property->SetAttr<std::string>("property_name", name);
+    if (dmlc::GetEnv("MXNET_DISABLE_CUDNN_BN_ADD_RELU_OPT", 0)) {
+      property->SetAttr<bool>("disable", true);
+    }
+    return property;
+  }
+
+  nnvm::ObjectPtr CreateSubgraphNode(const nnvm::Symbol& sym,
+                                     const int subgraph_id = 0) const override {
+    const nnvm::Node* bn = nullptr;
+    DFSVisit(sym.outputs, [&](const nnvm::ObjectPtr& node) {
+      if (node->op() && node->op()->name == "BatchNorm")
+        bn = node.get();
+    });
+    CHECK(bn);
+    nnvm::ObjectPtr n = nnvm::Node::Create();
+    n->attrs.name     = "sg_cudnn_batch_norm_add_relu_" + std::to_string(subgraph_id);
+    n->attrs.op       = Op::Get("_contrib_BatchNormAddRelu");
+    CHECK(n->attrs.op);
+    nnvm::get<BatchNormParam>(bn->attrs.parsed).SetAttrDict(&(n->attrs.dict));
+    n->op()->attr_parser(&(n->attrs));
+    n->attrs.subgraphs.emplace_back(std::make_shared<nnvm::Symbol>(sym));
+    return n;
+  }
+
+  SubgraphSelectorPtr CreateSubgraphSelector() const override {
+    return std::make_shared<SgCuDNNBNAddReLUSelector>();
+  }
+
+  void ConnectSubgraphInputs(const nnvm::ObjectPtr n,
+                             std::vector<nnvm::NodeEntry*>* input_entries,
+                             std::vector<nnvm::NodeEntry>* orig_input_entries) const override {
+    // the inputs of the BatchNorm, then the other operand of the add
+    std::vector<const nnvm::NodeEntry*> order;
+    const nnvm::Node* bn = nullptr;
+    DFSVisit(n->attrs.subgraphs[0]->outputs, [&](const nnvm::ObjectPtr& node) {
+      if (!node->op())
+        return;
+      if (node->op()->name == "BatchNorm") {
+        bn = node.get();
+        for (const auto& e : node->inputs)
+          order.push_back(&e);
+      }
+    });
+    DFSVisit(n->attrs.subgraphs[0]->outputs, [&](const nnvm::ObjectPtr& node) {
+      int other = -1;
+      if (bn && CuDNNIsResidualAdd(*node, *bn, {bn}, &other))
+        order.push_back(&node->inputs[other]);
+    });
+    CuDNNConnectSubgraphInputs(n, order, input_entries, orig_input_entries);
+  }
+};
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_SUBGRAPH_CUDNN_CUDNN_BN_ADD_RELU_PROPERTY_H_
@@ -0,0 +1,232 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cudnn_conv-inl.h
+ * \brief Inference Convolution with its BatchNorm folded in, and its residual addition and ReLU
+ *        applied by the epilogue of the convolution
+ */
+#ifndef MXNET_OPERATOR_SUBGRAPH_CUDNN_CUDNN_CONV_INL_H_
+#define MXNET_OPERATOR_SUBGRAPH_CUDNN_CUDNN_CONV_INL_H_
+
+#include <mxnet/storage.h>
+#include <string>
+#include <vector>
+#include "../../math_functions-inl.h"
+#include "../../mxnet_op.h"
+#include "../../nn/convolution-inl.h"
+
+namespace mxnet {
+namespace op {
+
+struct CuDNNConvFusionParam : public dmlc::Parameter<CuDNNConvFusionParam> {
+  bool with_bn;
+  bool with_add;
+  bool with_relu;
+  float bn_eps;
+  bool bn_fix_gamma;
+  DMLC_DECLARE_PARAMETER(CuDNNConvFusionParam) {
+    DMLC_DECLARE_FIELD(with_bn).set_default(false).describe(
+        "Whether the convolution is followed by an inference BatchNorm, folded into its weight "
+        "and bias.");
+    DMLC_DECLARE_FIELD(with_add).set_default(false).describe(
+        "Whether the addend input is added to the output.");
+    DMLC_DECLARE_FIELD(with_relu).set_default(false).describe(
+        "Whether a ReLU is applied to the output, after the addition.");
+    DMLC_DECLARE_FIELD(bn_eps).set_default(1e-3f).describe("eps of the BatchNorm.");
+    DMLC_DECLARE_FIELD(bn_fix_gamma).set_default(true).describe("fix_gamma of the BatchNorm.");
+  }
+};
+
+struct CuDNNConvFullParam {
+  ConvolutionParam conv;
+  CuDNNConvFusionParam fusion;
+};
+
+/*! \brief index of each input of _sg_cudnn_conv, or -1 for the absent ones */
+struct CuDNNConvInputs {
+  int data = 0, weight = 1, bias = -1, gamma = -1, beta = -1, mean = -1, var = -1, addend = -1;
+  int num = 2;
+
+  explicit CuDNNConvInputs(const CuDNNConvFullParam& param) {
+    if (!param.conv.no_bias)
+      bias = num++;
+    if (param.fusion.with_bn) {
+      gamma = num++;
+      beta  = num++;
+      mean  = num++;
+      var   = num++;
+    }
+    if (param.fusion.with_add)
+      addend = num++;
+  }
+};
+
+/*!
+ * \brief State of _sg_cudnn_conv: the attributes of the plain Convolution computing the folded
+ *        convolution, and the buffers of its folded weight and bias.
+ */
+struct CuDNNConvState {
+  CuDNNConvFullParam param;
+  nnvm::NodeAttrs conv_attrs;
+  Storage::Handle weight;
+  Storage::Handle bias;
+
+  explicit CuDNNConvState(const CuDNNConvFullParam& p) : param(p) {
+    // the folded BatchNorm always gives a bias
+    ConvolutionParam conv_param = p.conv;
+    conv_param.no_bias          = p.conv.no_bias && !p.fusion.with_bn;
+    conv_attrs.parsed           = conv_param;
+  }
+
+  ~CuDNNConvState() {
+    if (weight.dptr)
+      Storage::Get()->Free(weight);
+    if (bias.dptr)
+      Storage::Get()->Free(bias);
+  }
+};
+
+/*!
+ * \brief w_out = w * scale and b_out = (b - mean) * scale + beta per output channel, with
+ *        scale = gamma / sqrt(var + eps), AType being the type of the BatchNorm parameters.
+ */
+struct cudnn_conv_fold_bn {
+  template <typename DType, typename AType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* w_out,
+                                  DType* b_out,
+                                  const DType* w,
+                                  const DType* b,
+                                  const AType* gamma,
+                                  const AType* beta,
+                                  const AType* mean,
+                                  const AType* var,
+                                  index_t channel_size,
+                                  float eps,
+                                  bool fix_gamma) {
+    const index_t c   = i / channel_size;
+    const AType scale = (fix_gamma ? AType(1) : gamma[c]) / math::sqrt(var[c] + AType(eps));
+    w_out[i]          = DType(AType(w[i]) * scale);
+    if (i % channel_size == 0)
+      b_out[c] = DType(((b ? AType(b[c]) : AType(0)) - mean[c]) * scale + beta[c]);
+  }
+};
+
+/*! \brief out = out + addend when addend is given, then out = max(out, 0) when relu is set */
+struct cudnn_conv_add_relu {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i, DType* out, const DType* addend, bool relu) {
+    const DType sum = addend ? DType(out[i] + addend[i]) : out[i];
+    out[i]          = relu && !(sum > DType(0)) ? DType(0) : sum;
+  }
+};
+
+inline TBlob CuDNNConvBuffer(Storage::Handle* handle, const TBlob& like, const Context& ctx) {
+  const size_t bytes = like.Size() * mshadow::mshadow_sizeof(like.type_flag_);
+  if (handle->size < bytes) {
+    if (handle->dptr)
+      Storage::Get()->Free(*handle);
+    *handle = Storage::Get()->Alloc(bytes, ctx);
+  }
+  return TBlob(handle->dptr, like.shape_, like.dev_mask(), like.type_flag_, like.dev_id());
+}
+
+/*!
+ * \brief The weight and bias of the convolution with the BatchNorm folded in, or the inputs as
+ *        they are without BatchNorm. The bias is empty when there is none.
+ */
+template <typename xpu>
+void CuDNNConvFoldWeights(CuDNNConvState* state,
+                          const OpContext& ctx,
+                          const std::vector<TBlob>& inputs,
+                          TBlob* weight,
+                          TBlob* bias) {
+  using namespace mxnet_op;
+  const CuDNNConvFullParam& param = state->param;
+  const CuDNNConvInputs in(param);
+  *weight = inputs[in.weight];
+  *bias   = in.bias >= 0 ? inputs[in.bias] : TBlob();
+  if (!param.fusion.with_bn)
+    return;
+  const TBlob& w = inputs[in.weight];
+  *weight        = CuDNNConvBuffer(&state->weight, w, ctx.run_ctx.ctx);
+  TBlob b_like(nullptr, mshadow::Shape1(param.conv.num_filter), w.dev_mask(), w.type_flag_);
+  *bias = CuDNNConvBuffer(&state->bias, b_like, ctx.run_ctx.ctx);
+  MSHADOW_REAL_TYPE_SWITCH_EX(w.type_flag_, DType, AType, {
+    Kernel<cudnn_conv_fold_bn, xpu>::Launch(ctx.get_stream<xpu>(),
+                                            w.Size(),
+                                            weight->dptr<DType>(),
+                                            bias->dptr<DType>(),
+                                            w.dptr<DType>(),
+                                            in.bias >= 0 ? inputs[in.bias].dptr<DType>() : nullptr,
+                                            inputs[in.gamma].dptr<AType>(),
+                                            inputs[in.beta].dptr<AType>(),
+                                            inputs[in.mean].dptr<AType>(),
+                                            inputs[in.var].dptr<AType>(),
+                                            static_cast<index_t>(w.Size() / w.shape_[0]),
+                                            param.fusion.bn_eps,
+                                            param.fusion.bn_fix_gamma);
+  });
+}
+
+/*! \brief the folded convolution followed by the addition and ReLU kernel */
+template <typename xpu>
+void CuDNNConvForwardImpl(CuDNNConvState* state,
+                          const OpContext& ctx,
+                          const std::vector<TBlob>& inputs,
+                          const TBlob& weight,
+                          const TBlob& bias,
+                          const std::vector<OpReqType>& req,
+                          const TBlob& out) {
+  using namespace mxnet_op;
+  const CuDNNConvFullParam& param = state->param;
+  const CuDNNConvInputs in(param);
+  std::vector<TBlob> conv_inputs{inputs[in.data], weight};
+  if (!nnvm::get<ConvolutionParam>(state->conv_attrs.parsed).no_bias)
+    conv_inputs.push_back(bias);
+  ConvolutionCompute<xpu>(state->conv_attrs, ctx, conv_inputs, req, {out});
+  if (!param.fusion.with_add && !param.fusion.with_relu)
+    return;
+  MSHADOW_REAL_TYPE_SWITCH(out.type_flag_, DType, {
+    Kernel<cudnn_conv_add_relu, xpu>::Launch(
+        ctx.get_stream<xpu>(),
+        out.Size(),
+        out.dptr<DType>(),
+        param.fusion.with_add ? inputs[in.addend].dptr<DType>() : nullptr,
+        param.fusion.with_relu);
+  });
+}
+
+template <typename xpu>
+void CuDNNConvForward(const OpStatePtr& state_ptr,
+                      const OpContext& ctx,
+                      const std::vector<TBlob>& inputs,
+                      const std::vector<OpReqType>& req,
+                      const std::vector<TBlob>& outputs) {
+  auto& state = state_ptr.get_state<CuDNNConvState>();
+  TBlob weight, bias;
+  CuDNNConvFoldWeights<xpu>(&state, ctx, inputs, &weight, &bias);
+  CuDNNConvForwardImpl<xpu>(&state, ctx, inputs, weight, bias, req, outputs[0]);
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_SUBGRAPH_CUDNN_CUDNN_CONV_INL_H_
@@ -0,0 +1,144 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cudnn_conv.cc
+ * \brief Inference Convolution with its BatchNorm folded in, and its residual addition and ReLU
+ *        applied by the epilogue of the convolution
+ */
+#include <algorithm>
+#include <sstream>
+#include "./cudnn_conv-inl.h"
+
+namespace mxnet {
+namespace op {
+
+DMLC_REGISTER_PARAMETER(CuDNNConvFusionParam);
+
+static void CuDNNConvParamParser(nnvm::NodeAttrs* attrs) {
+  CuDNNConvFullParam param;
+  try {
+    param.fusion.Init(attrs->dict, dmlc::parameter::kAllowUnknown);
+  } catch (const dmlc::ParamError& e) {
+    std::ostringstream os;
+    os << e.what();
+    os << ", in operator " << attrs->op->name << "("
+       << "name=\"" << attrs->name << "\"";
+    for (const auto& k : attrs->dict) {
+      os << ", " << k.first << "=\"" << k.second << "\"";
+    }
+    os << ")";
+    throw dmlc::ParamError(os.str());
+  }
+  // the remaining attributes are those of the Convolution, with its defaults
+  nnvm::NodeAttrs conv_attrs = *attrs;
+  for (const auto& kv : param.fusion.__DICT__())
+    conv_attrs.dict.erase(kv.first);
+  ConvolutionParamParser(&conv_attrs);
+  param.conv    = nnvm::get<ConvolutionParam>(conv_attrs.parsed);
+  attrs->parsed = std::move(param);
+}
+
+static std::vector<std::string> CuDNNConvListInputNames(const NodeAttrs& attrs) {
+  const CuDNNConvFullParam& param = nnvm::get<CuDNNConvFullParam>(attrs.parsed);
+  std::vector<std::string> names{"data", "weight"};
+  if (!param.conv.no_bias)
+    names.emplace_back("bias");
+  if (param.fusion.with_bn) {
+    for (const char* name : {"gamma", "beta", "moving_mean", "moving_var"})
+      names.emplace_back(name);
+  }
+  if (param.fusion.with_add)
+    names.emplace_back("addend");
+  return names;
+}
+
+static bool CuDNNConvShape(const nnvm::NodeAttrs& attrs,
+                           mxnet::ShapeVector* in_shape,
+                           mxnet::ShapeVector* out_shape) {
+  static auto& finfer_shape       = Op::GetAttr<mxnet::FInferShape>("FInferShape");
+  const CuDNNConvFullParam& param = nnvm::get<CuDNNConvFullParam>(attrs.parsed);
+  const CuDNNConvInputs in(param);
+  CHECK_EQ(in_shape->size(), static_cast<size_t>(in.num));
+  nnvm::NodeAttrs conv_attrs;
+  conv_attrs.parsed = param.conv;
+  mxnet::ShapeVector conv_in(in_shape->begin(), in_shape->begin() + (in.bias >= 0 ? 3 : 2));
+  if (!finfer_shape[Op::Get("Convolution")](conv_attrs, &conv_in, out_shape))
+    return false;
+  std::copy(conv_in.begin(), conv_in.end(), in_shape->begin());
+  if (param.fusion.with_bn) {
+    for (int i : {in.gamma, in.beta, in.mean, in.var})
+      SHAPE_ASSIGN_CHECK(*in_shape, i, mxnet::TShape(1, param.conv.num_filter));
+  }
+  if (param.fusion.with_add)
+    SHAPE_ASSIGN_CHECK(*in_shape, in.addend, out_shape->at(0));
+  return true;
+}
+
+static bool CuDNNConvType(const nnvm::NodeAttrs& attrs,
+                          std::vector<int>* in_type,
+                          std::vector<int>* out_type) {
+  const CuDNNConvFullParam& param = nnvm::get<CuDNNConvFullParam>(attrs.parsed);
+  const CuDNNConvInputs in(param);
+  CHECK_EQ(in_type->size(), static_cast<size_t>(in.num));
+  const int dtype = in_type->at(in.data);
+  if (type_is_none(dtype))
+    return false;
+  // the BatchNorm parameters of float16 data are float32
+  const int bn_type = dtype == mshadow::kFloat16 ? mshadow::kFloat32 : dtype;
+  for (int i = 0; i < in.num; ++i) {
+    const bool is_bn = param.fusion.with_bn && i >= in.gamma && i <= in.var;
+    TYPE_ASSIGN_CHECK(*in_type, i, is_bn ? bn_type : dtype);
+  }
+  out_type->clear();
+  out_type->push_back(dtype);
+  return true;
+}
+
+static OpStatePtr CreateCuDNNConvState(const nnvm::NodeAttrs& attrs,
+                                       const Context ctx,
+                                       const mxnet::ShapeVector& in_shapes,
+                                       const std::vector<int>& in_types) {
+  return OpStatePtr::Create<CuDNNConvState>(nnvm::get<CuDNNConvFullParam>(attrs.parsed));
+}
+
+NNVM_REGISTER_OP(_sg_cudnn_conv)
+    .describe(R"code(_sg_cudnn_conv)code" ADD_FILELINE)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      const CuDNNConvInputs in(nnvm::get<CuDNNConvFullParam>(attrs.parsed));
+      return static_cast<uint32_t>(in.num);
+    })
+    .set_num_outputs(1)
+    .set_attr_parser(CuDNNConvParamParser)
+    .set_attr<nnvm::FListInputNames>("FListInputNames", CuDNNConvListInputNames)
+    .set_attr<nnvm::FListOutputNames>("FListOutputNames",
+                                      [](const NodeAttrs& attrs) {
+                                        return std::vector<std::string>{"output"};
+                                      })
+    .set_attr<mxnet::FInferShape>("FInferShape", CuDNNConvShape)
+    .set_attr<nnvm::FInferType>("FInferType", CuDNNConvType)
+    .set_attr<FCreateOpState>("FCreateOpState", CreateCuDNNConvState)
+    .set_attr<FStatefulCompute>("FStatefulCompute<cpu>", CuDNNConvForward<cpu>)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& n) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                });
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,71 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cudnn_conv.cu
+ * \brief Inference Convolution with its BatchNorm folded in, and its residual addition and ReLU
+ *        fused into the convolution by cuDNN
+ */
+#include "./cudnn_conv-inl.h"
+#if MXNET_USE_CUDNN == 1
+#include "../../cudnn_ops.h"
+#endif  // MXNET_USE_CUDNN == 1
+
+namespace mxnet {
+namespace op {
+
+template <>
+void CuDNNConvForward<gpu>(const OpStatePtr& state_ptr,
+                           const OpContext& ctx,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<TBlob>& outputs) {
+  auto& state                     = state_ptr.get_state<CuDNNConvState>();
+  const CuDNNConvFullParam& param = state.param;
+  const CuDNNConvInputs in(param);
+  CHECK_EQ(req[0], kWriteTo);
+  TBlob weight, bias;
+  CuDNNConvFoldWeights<gpu>(&state, ctx, inputs, &weight, &bias);
+#if MXNET_USE_CUDNN == 1
+  if (!param.conv.cudnn_off) {
+    if (!bias.dptr_) {
+      // the fused graph always adds a bias
+      TBlob b_like(
+          nullptr, mshadow::Shape1(param.conv.num_filter), weight.dev_mask(), weight.type_flag_);
+      bias = CuDNNConvBuffer(&state.bias, b_like, ctx.run_ctx.ctx);
+      MSHADOW_REAL_TYPE_SWITCH(bias.type_flag_, DType, {
+        bias.FlatTo1D<gpu, DType>(ctx.get_stream<gpu>()) = DType(0);
+      });
+    }
+    cudnn::ConvBiasAddReluParam fused_param{
+        cudnn::ConvParam(param.conv, false), param.fusion.with_add, param.fusion.with_relu};
+    const TBlob addend = param.fusion.with_add ? inputs[in.addend] : TBlob();
+    if (cudnn::Exec<cudnn::ConvBiasAddRelu>(
+            ctx, fused_param, inputs[in.data], weight, bias, addend, outputs[0]))
+      return;
+  }
+#endif  // MXNET_USE_CUDNN == 1
+  CuDNNConvForwardImpl<gpu>(&state, ctx, inputs, weight, bias, req, outputs[0]);
+}
+
+NNVM_REGISTER_OP(_sg_cudnn_conv)
+    .set_attr<FStatefulCompute>("FStatefulCompute<gpu>", CuDNNConvForward<gpu>);
+
+}  // namespace op
+}  // namespace mxnet
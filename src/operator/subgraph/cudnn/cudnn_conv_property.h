@@ -0,0 +1,231 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef MXNET_OPERATOR_SUBGRAPH_CUDNN_CUDNN_CONV_PROPERTY_H_
+#define MXNET_OPERATOR_SUBGRAPH_CUDNN_CUDNN_CONV_PROPERTY_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../nn/batch_norm-inl.h"
+#include "../../nn/convolution-inl.h"
+#include "./cudnn_subgraph_base-inl.h"
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * This selects Convolution -> [BatchNorm] -> [add] -> [relu] chains, where each matched node but
+ * the last one has no other consumer.
+ */
+class SgCuDNNConvSelector : public SubgraphSelector {
+ public:
+  /*! \brief pattern match status_, which changes as kStart -> kBN -> kSum -> kSuccess */
+  enum SelectStatusConv { kFail = 0, kStart, kBN, kSum, kSuccess };
+
+  explicit SgCuDNNConvSelector(bool disable) : disable_(disable) {}
+
+  bool Select(const nnvm::Node& n) override {
+    if (!disable_ && n.op() && n.op()->name == "Convolution") {
+      const auto& param = nnvm::get<ConvolutionParam>(n.attrs.parsed);
+      if (param.kernel.ndim() == 2 && !param.cudnn_off) {
+        status_ = kStart;
+        matched_list_.assign(1, &n);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool SelectInput(const nnvm::Node& n, const nnvm::Node& new_node) override {
+    return false;
+  }
+
+  bool SelectOutput(const nnvm::Node& n, const nnvm::Node& new_node) override {
+    // If n isn't the last matched node, then we encoutered an internal branch, we should pop out
+    // the nodes behind n and stop fusion.
+    if (matched_list_.back() != &n) {
+      if (std::find(matched_list_.begin(), matched_list_.end(), &n) != matched_list_.end()) {
+        while (matched_list_.back() != &n)
+          matched_list_.pop_back();
+      }
+      status_ = kSuccess;
+      return false;
+    }
+    if (status_ == kFail || status_ == kSuccess || new_node.is_variable())
+      return false;
+    if (status_ == kStart && IsChannelBatchNorm(n, new_node)) {
+      matched_list_.push_back(&new_node);
+      status_ = kBN;
+      return true;
+    }
+    if ((status_ == kStart || status_ == kBN) && CuDNNIsResidualAdd(new_node, n, matched_list_)) {
+      matched_list_.push_back(&new_node);
+      status_ = kSum;
+      return true;
+    }
+    if (CuDNNIsReLU(new_node)) {
+      matched_list_.push_back(&new_node);
+      status_ = kSuccess;
+      return true;
+    }
+    status_ = kSuccess;
+    return false;
+  }
+
+  std::vector<nnvm::Node*> Filter(const std::vector<nnvm::Node*>& candidates) override {
+    std::vector<nnvm::Node*> ret;
+    // a lone Convolution gains nothing from the fused operator
+    if (status_ == kFail || matched_list_.size() < 2)
+      return ret;
+    for (auto i : matched_list_) {
+      auto non_const_i = const_cast<nnvm::Node*>(i);
+      if (std::find(candidates.begin(), candidates.end(), non_const_i) != candidates.end())
+        ret.push_back(non_const_i);
+    }
+    return ret;
+  }
+
+  void Reset() override {
+    CHECK_GE(matched_list_.size(), 1);
+    auto new_selector = SgCuDNNConvSelector(disable_);
+    new_selector.Select(*matched_list_[0]);
+    *this = new_selector;
+  }
+
+ private:
+  /*! \brief whether bn normalizes the output channels of the conv, with no visible statistics */
+  static bool IsChannelBatchNorm(const nnvm::Node& conv, const nnvm::Node& bn) {
+    if (bn.op()->name != "BatchNorm" || bn.inputs[0].node.get() != &conv || bn.inputs[0].index != 0)
+      return false;
+    const auto& conv_param = nnvm::get<ConvolutionParam>(conv.attrs.parsed);
+    const auto& bn_param   = nnvm::get<BatchNormParam>(bn.attrs.parsed);
+    const bool nhwc = conv_param.layout.has_value() && conv_param.layout.value() == mshadow::kNHWC;
+    const int axis  = bn_param.axis < 0 ? bn_param.axis + 4 : bn_param.axis;
+    return !bn_param.output_mean_var && axis == (nhwc ? 3 : 1);
+  }
+
+  bool disable_;
+  SelectStatusConv status_ = kFail;
+  std::vector<const nnvm::Node*> matched_list_;
+};
+
+/*!
+ * This subgraph property replaces Convolution -> [BatchNorm] -> [add] -> [relu] with
+ * _sg_cudnn_conv, which folds the BatchNorm into the weights and runs the rest as the epilogue of
+ * the cuDNN convolution. The fused operator has no gradient, so that the pass is skipped for
+ * graphs partitioned with the backend option training=True.
+ */
+class SgCuDNNConvProperty : public SubgraphProperty {
+ public:
+  static SubgraphPropertyPtr Create() {
+    static const std::string& name = "cuDNN convolution optimization pass";
+    auto property                  = std::make_shared<SgCuDNNConvProperty>();
+    property->SetAttr<std::string>("property_name", name);
+    property->SetAttr<bool>("inference_only", true);
+    if (dmlc::GetEnv("MXNET_DISABLE_CUDNN_CONV_OPT", 0)) {
+      property->SetAttr<bool>("disable", true);
+    }
+    return property;
+  }
+
+  void PrePartition(const nnvm::Graph& g,
+                    const std::unordered_map<std::string, std::string>& options_map) override {
+    SubgraphProperty::PrePartition(g, options_map);
+    auto it   = options_map.find("training");
+    training_ = it != options_map.end() && it->second == "True";
+  }
+
+  nnvm::ObjectPtr CreateSubgraphNode(const nnvm::Symbol& sym,
+                                     const int subgraph_id = 0) const override {
+    nnvm::ObjectPtr n = nnvm::Node::Create();
+    DFSVisit(sym.outputs, [&](const nnvm::ObjectPtr& node) {
+      if (node->is_variable())
+        return;
+      const auto& sub_name = node->op()->name;
+      if (sub_name == "Convolution") {
+        nnvm::get<ConvolutionParam>(node->attrs.parsed).SetAttrDict(&(n->attrs.dict));
+      } else if (sub_name == "BatchNorm") {
+        const auto& param             = nnvm::get<BatchNormParam>(node->attrs.parsed);
+        n->attrs.dict["with_bn"]      = "True";
+        n->attrs.dict["bn_eps"]       = std::to_string(param.eps);
+        n->attrs.dict["bn_fix_gamma"] = param.fix_gamma ? "True" : "False";
+      } else if (CuDNNIsReLU(*node)) {
+        n->attrs.dict["with_relu"] = "True";
+      } else {
+        n->attrs.dict["with_add"] = "True";
+      }
+    });
+    n->attrs.name = "sg_cudnn_conv_" + std::to_string(subgraph_id);
+    n->attrs.op   = Op::Get("_sg_cudnn_conv");
+    CHECK(n->attrs.op);
+    n->attrs.subgraphs.emplace_back(std::make_shared<nnvm::Symbol>(sym));
+    n->op()->attr_parser(&(n->attrs));
+    return n;
+  }
+
+  SubgraphSelectorPtr CreateSubgraphSelector() const override {
+    return std::make_shared<SgCuDNNConvSelector>(training_);
+  }
+
+  void ConnectSubgraphOutputs(const nnvm::ObjectPtr n,
+                              std::vector<nnvm::NodeEntry*>* output_entries) const override {
+    // Connect all extern output entries to output[0]
+    for (size_t i = 0; i < output_entries->size(); ++i) {
+      *output_entries->at(i) = nnvm::NodeEntry{n, 0, 0};
+    }
+  }
+
+  void ConnectSubgraphInputs(const nnvm::ObjectPtr n,
+                             std::vector<nnvm::NodeEntry*>* input_entries,
+                             std::vector<nnvm::NodeEntry>* orig_input_entries) const override {
+    // the inputs of the Convolution, the parameters of the BatchNorm, then the addend
+    std::vector<const nnvm::NodeEntry*> order;
+    std::vector<const nnvm::Node*> matched;
+    const nnvm::Node* prev = nullptr;
+    DFSVisit(n->attrs.subgraphs[0]->outputs, [&](const nnvm::ObjectPtr& node) {
+      if (node->is_variable())
+        return;
+      const auto& sub_name = node->op()->name;
+      int other            = -1;
+      if (sub_name == "Convolution") {
+        for (const auto& e : node->inputs)
+          order.push_back(&e);
+      } else if (sub_name == "BatchNorm") {
+        for (size_t i = 1; i < node->inputs.size(); ++i)
+          order.push_back(&node->inputs[i]);
+      } else if (prev && CuDNNIsResidualAdd(*node, *prev, matched, &other)) {
+        order.push_back(&node->inputs[other]);
+      }
+      matched.push_back(node.get());
+      prev = node.get();
+    });
+    CuDNNConnectSubgraphInputs(n, order, input_entries, orig_input_entries);
+  }
+
+ private:
+  bool training_ = false;
+};
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_SUBGRAPH_CUDNN_CUDNN_CONV_PROPERTY_H_
@@ -0,0 +1,94 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef MXNET_OPERATOR_SUBGRAPH_CUDNN_CUDNN_SUBGRAPH_BASE_INL_H_
+#define MXNET_OPERATOR_SUBGRAPH_CUDNN_CUDNN_SUBGRAPH_BASE_INL_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "../../nn/activation-inl.h"
+#include "../common.h"
+#include "../subgraph_property.h"
+
+namespace mxnet {
+namespace op {
+
+static inline bool CuDNNIsReLU(const nnvm::Node& n) {
+  if (!n.op())
+    return false;
+  if (n.op()->name == "relu" || n.op()->name == "_npx_relu")
+    return true;
+  return n.op()->name == "Activation" &&
+         nnvm::get<ActivationParam>(n.attrs.parsed).act_type == activation::kReLU;
+}
+
+/*!
+ * \brief Whether n adds the output 0 of prev to an input from outside of the matched nodes,
+ *        whose index in the inputs of n is returned in other.
+ */
+static inline bool CuDNNIsResidualAdd(const nnvm::Node& n,
+                                      const nnvm::Node& prev,
+                                      const std::vector<const nnvm::Node*>& matched,
+                                      int* other = nullptr) {
+  if (!n.op() || (n.op()->name != "elemwise_add" && n.op()->name != "_npi_add"))
+    return false;
+  CHECK_EQ(n.inputs.size(), 2U);
+  for (int i = 0; i < 2; ++i) {
+    const nnvm::NodeEntry& e = n.inputs[i];
+    const nnvm::Node* o      = n.inputs[1 - i].node.get();
+    if (e.node.get() == &prev && e.index == 0 &&
+        std::find(matched.begin(), matched.end(), o) == matched.end()) {
+      if (other)
+        *other = 1 - i;
+      return true;
+    }
+  }
+  return false;
+}
+
+/*!
+ * \brief Connects the inputs of the fused node n in the order of the entries of the matched nodes
+ *        reading them, which is that of the inputs of the fused operator. CreateSubgraphNode keeps
+ *        the subgraph in n for this, which is dropped here. With dedup_subgraph the entries reading
+ *        the same input share its variable, which is then connected once per reading entry.
+ */
+static inline void CuDNNConnectSubgraphInputs(const nnvm::ObjectPtr& n,
+                                              const std::vector<const nnvm::NodeEntry*>& order,
+                                              std::vector<nnvm::NodeEntry*>* input_entries,
+                                              std::vector<nnvm::NodeEntry>* orig_input_entries) {
+  std::vector<nnvm::NodeEntry*> entries;
+  std::vector<nnvm::NodeEntry> orig_entries;
+  for (const nnvm::NodeEntry* e : order) {
+    auto it = std::find_if(input_entries->begin(), input_entries->end(), [e](nnvm::NodeEntry* i) {
+      return i == e || (i->node == e->node && i->index == e->index);
+    });
+    CHECK(it != input_entries->end());
+    entries.push_back(*it);
+    orig_entries.push_back(orig_input_entries->at(it - input_entries->begin()));
+  }
+  *input_entries      = std::move(entries);
+  *orig_input_entries = std::move(orig_entries);
+  n->inputs           = *orig_input_entries;
+  n->attrs.subgraphs.clear();
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_SUBGRAPH_CUDNN_CUDNN_SUBGRAPH_BASE_INL_H_
@@ -0,0 +1,36 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#if MXNET_USE_CUDNN == 1
+
+#include "cudnn_bn_add_relu_property.h"
+#include "cudnn_conv_property.h"
+
+namespace mxnet {
+namespace op {
+
+MXNET_REGISTER_SUBGRAPH_BACKEND(CUDNN).set_attr("context", Context::GPU());
+
+MXNET_REGISTER_SUBGRAPH_PROPERTY(CUDNN, SgCuDNNConvProperty);
+MXNET_REGISTER_SUBGRAPH_PROPERTY(CUDNN, SgCuDNNBNAddReLUProperty);
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_USE_CUDNN == 1
@@ -31,6 +31,8 @@
 #include <vector>
 
 #include "operator/numpy/np_matrix_op-inl.h"
+#include "operator/numpy/np_repeat_op-inl.h"
+#include "operator/tensor/matrix_op-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -93,6 +95,34 @@ static std::vector<float> GetWeightScales(const NDArray& weight,
   return weight_scales;
 }
 
+/*!
+ * \brief int8 scales of the groups of group_size consecutive input features of each output
+ *  channel of a 2D weight, ordered by group and then by channel
+ */
+template <typename DType>
+static std::vector<float> GetGroupWeightScales(const NDArray& weight, const index_t group_size) {
+  auto nthreads             = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const DType* weight_ptr   = weight.data().dptr<DType>();
+  const index_t channel     = weight.shape()[0];
+  const index_t in_features = weight.shape().ProdShape(1, weight.shape().ndim());
+  const index_t num_groups  = in_features / group_size;
+  std::vector<float> weight_scales(num_groups * channel);
+#pragma omp parallel for num_threads(nthreads)
+  for (index_t c = 0; c < channel; ++c) {
+    for (index_t g = 0; g < num_groups; ++g) {
+      const DType* p1 = weight_ptr + c * in_features + g * group_size;
+      DType g_min     = p1[0];
+      DType g_max     = p1[0];
+      for (index_t k = 1; k < group_size; ++k) {
+        g_min = Min(g_min, p1[k]);
+        g_max = Max(g_max, p1[k]);
+      }
+      weight_scales[g * channel + c] = GetQuantizeScale(mshadow::kInt8, g_min, g_max);
+    }
+  }
+  return weight_scales;
+}
+
 static inline void ConvertWeightBias2DNNL(NDArray* weight,
                                           NDArray* bias,
                                           bool has_bias,
@@ -170,6 +200,39 @@ static inline bool CheckSwapAxisConditions(const nnvm::Node& node) {
   return ((dim1 == 1 && dim2 == 2) || (dim1 == 2 && dim2 == 1));
 }
 
+/*!
+ * \brief Number of query heads sharing each key or value head when node is the np.repeat of the
+ *  heads axis of the keys or values of grouped-query attention, 0 if it is not.
+ */
+static inline int GetHeadRepeats(const nnvm::Node& node) {
+  if (node.op() != Op::Get("_npi_repeats"))
+    return 0;
+  const auto& param = nnvm::get<RepeatsParam>(node.attrs.parsed);
+  if (!param.axis.has_value() || (param.axis.value() != 2 && param.axis.value() != -2) ||
+      !param.repeats.has_value() || param.repeats.value().ndim() != 1 ||
+      param.repeats.value()[0] < 1)
+    return 0;
+  return param.repeats.value()[0];
+}
+
+/*!
+ * \brief Whether node splits the projections into queries, keys and values along the last axis,
+ *  in three equal sections or, when group_size query heads share each key and value head, at
+ *  the indices (0, heads * head_dim, (heads + kv_heads) * head_dim).
+ */
+static inline bool CheckQKVSplitConditions(const nnvm::Node& node, const int group_size) {
+  const auto& param = nnvm::get<SplitParam>(node.attrs.parsed);
+  if (param.axis != -1 || param.squeeze_axis)
+    return false;
+  if (param.sections == 3 && param.indices.ndim() == 0)
+    return group_size == 1;
+  const auto& indices = param.indices;
+  if (param.sections != 0 || indices.ndim() != 3 || indices[0] != 0 || indices[1] <= 0 ||
+      indices[2] <= indices[1])
+    return false;
+  return indices[1] == (indices[2] - indices[1]) * group_size;
+}
+
 }  // namespace op
 }  // namespace mxnet
 
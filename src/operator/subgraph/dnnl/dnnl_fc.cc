@@ -25,6 +25,7 @@
 
 #if MXNET_USE_ONEDNN == 1
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -81,6 +82,13 @@ class SgDNNLFCOp {
   void GetCachedWeightsAndBias(const NDArray& weight,
                                bool support_channelwise_scale,
                                bool has_bias);
+  NDArray FlattenData(const NDArray& data);
+  void InitializePostScale(const NDArray& data,
+                           const std::vector<NDArray>& in_data,
+                           const NDArray& output);
+  void ForwardWithPostScale(const std::vector<NDArray>& in_data,
+                            const NDArray& output,
+                            const std::vector<NDArray>& out_data);
   nnvm::Symbol subgraph_sym_;
   nnvm::NodeAttrs attrs;
   DNNLFCFullParam full_param_;
@@ -107,6 +115,16 @@ class SgDNNLFCOp {
   float cached_output_max_;
   float data_scale_{0.0f};
   std::vector<float> weight_scales_;
+  // dynamic_quantize and group-wise weight scales: the primitive computes the int32
+  // accumulators of each group of the weight, scaled and summed up for each batch
+  bool post_scale_initialized_{false};
+  index_t num_groups_{1};
+  std::shared_ptr<dnnl::matmul> group_fwd_;
+  mxnet::TShape cached_data_shape_;
+  std::shared_ptr<dnnl::memory> cached_acc_mem_;
+  std::shared_ptr<dnnl::memory> cached_acc_float_mem_;  // same buffer, scaled to float
+  std::shared_ptr<dnnl::eltwise_forward> eltwise_fwd_;
+  std::vector<float> float_bias_;
 };
 
 void SgDNNLFCOp::Forward(const OpContext& ctx,
@@ -135,6 +153,11 @@ void SgDNNLFCOp::Forward(const OpContext& ctx,
     return;
   }
 
+  if (dnnl_param.dynamic_quantize || dnnl_param.weight_group_size > 0) {
+    ForwardWithPostScale(in_data, output, out_data);
+    return;
+  }
+
   const bool has_bias = !default_param.no_bias;
   const bool channel_wise =
       dnnl_param.channel_wise_quantize.has_value() && dnnl_param.channel_wise_quantize.value();
@@ -183,20 +206,11 @@ void SgDNNLFCOp::Forward(const OpContext& ctx,
     } else {
       cached_bias_ = NDArray();
     }
-    const mxnet::TShape ishape = data.shape();
-    const auto data_ndim       = ishape.ndim();
     if (data.IsDNNLData()) {
       reorder_data_ = true;
       data          = data.Reorder2Default();
     }
-    if (data_ndim != 2) {
-      if (!default_param.flatten) {
-        data =
-            data.DNNLDataReshape(Shape2(ishape.ProdShape(0, data_ndim - 1), ishape[data_ndim - 1]));
-      } else {
-        data = data.DNNLDataReshape(Shape2(ishape[0], ishape.ProdShape(1, data_ndim)));
-      }
-    }
+    data = FlattenData(data);
 
     // create cached out_md
     dnnl::memory::desc out_md = CreateOutputMemoryDesc(output.shape(), output.dtype());
@@ -242,6 +256,297 @@ void SgDNNLFCOp::Forward(const OpContext& ctx,
   }
 }
 
+NDArray SgDNNLFCOp::FlattenData(const NDArray& data) {
+  const mxnet::TShape ishape = data.shape();
+  const auto data_ndim       = ishape.ndim();
+  if (data_ndim == 2) {
+    return data;
+  }
+  if (!full_param_.default_param.flatten) {
+    return data.DNNLDataReshape(
+        Shape2(ishape.ProdShape(0, data_ndim - 1), ishape[data_ndim - 1]));
+  }
+  return data.DNNLDataReshape(Shape2(ishape[0], ishape.ProdShape(1, data_ndim)));
+}
+
+void SgDNNLFCOp::InitializePostScale(const NDArray& data,
+                                     const std::vector<NDArray>& in_data,
+                                     const NDArray& output) {
+  const auto nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const auto engine   = CpuEngine::Get()->get_engine();
+  const FCInputIndex idx(full_param_);
+  const auto& dnnl_param = full_param_.dnnl_param;
+  const bool has_bias    = !full_param_.default_param.no_bias;
+  const bool channel_wise =
+      dnnl_param.channel_wise_quantize.has_value() && dnnl_param.channel_wise_quantize.value();
+  const NDArray& weight     = in_data[idx.weight];
+  const index_t channels    = weight.shape()[0];
+  const index_t in_features = weight.shape().ProdShape(1, weight.shape().ndim());
+  index_t group_size =
+      dnnl_param.weight_group_size > 0 ? dnnl_param.weight_group_size : in_features;
+  if (in_features % group_size != 0) {
+    LOG(WARNING) << "weight_group_size " << group_size << " of " << attrs.name
+                 << " does not divide its " << in_features
+                 << " input features, using one scale per output channel";
+    group_size = in_features;
+  }
+  CHECK(group_size == in_features || channel_wise)
+      << "weight_group_size of FullyConnected requires channel_wise_quantize, with the weight "
+         "quantized by the operator";
+  CHECK(dnnl_param.enabled_float_output.has_value() || !dnnl_param.with_sum)
+      << "FullyConnected with group-wise weight scales and a fused sum requires a float "
+         "output, with the dequantize fused into it";
+  num_groups_ = in_features / group_size;
+
+  // The primitive only depends on the shapes: the scales, the bias and the post-ops, which
+  // depend on the range of the data, are applied to its int32 output.
+  dnnl::memory::desc acc_md;
+  dnnl::memory::desc src_md;
+  if (num_groups_ == 1) {
+    DNNLFCFullParam acc_param         = full_param_;
+    acc_param.dnnl_param.with_eltwise = false;
+    acc_param.dnnl_param.with_sum     = false;
+    acc_param.output_scales.clear();
+    acc_md = CreateOutputMemoryDesc(output.shape(), mshadow::kInt32);
+    fwd_   = std::make_shared<DNNLFullyConnectedForward>(
+        acc_param, false, data, weight, nullptr, acc_md);
+    src_md = static_cast<const dnnl::memory*>(data.GetDNNLData())->get_desc();
+    if (channel_wise) {
+      MSHADOW_REAL_TYPE_SWITCH(weight.dtype(), DType, {
+        weight_scales_ = GetWeightScales<DType>(weight, nullptr, 0.0f, true);
+      });
+      cached_weight_ = weight;
+      ConvertWeightBias2DNNL(&cached_weight_,
+                             &cached_bias_,
+                             false,
+                             fwd_->fwd_pd.weights_desc(),
+                             nullptr,
+                             1,
+                             0.0f,
+                             weight_scales_);
+    } else {
+      const float weight_min = in_data[idx.weight_min].data().dptr<float>()[0];
+      const float weight_max = in_data[idx.weight_max].data().dptr<float>()[0];
+      weight_scales_.assign(channels, GetQuantizeScale(mshadow::kInt8, weight_min, weight_max));
+      cached_weight_            = weight;
+      const auto def_weight_mem = weight.GetDNNLData();
+      if (def_weight_mem->get_desc() != fwd_->fwd_pd.weights_desc()) {
+        auto weight_desc       = fwd_->fwd_pd.weights_desc();
+        cached_weight_         = NDArray(&weight_desc);
+        auto cached_weight_mem = cached_weight_.GetDNNLData();
+        DNNLStream::Get()->RegisterPrimArgs(
+            dnnl::reorder(*def_weight_mem, *cached_weight_mem),
+            {{DNNL_ARG_FROM, *def_weight_mem}, {DNNL_ARG_TO, *cached_weight_mem}});
+        DNNLStream::Get()->Submit();
+      }
+    }
+  } else {
+    // one matmul per group, batched: the groups of the data are strided views of its rows
+    // and the accumulators of each group are stacked
+    const dnnl::memory::dim G  = num_groups_;
+    const dnnl::memory::dim M  = data.shape()[0];
+    const dnnl::memory::dim N  = channels;
+    const dnnl::memory::dim Kg = group_size;
+    const dnnl::memory::dim K  = in_features;
+    src_md = dnnl::memory::desc({G, M, Kg}, get_dnnl_type(data.dtype()), {Kg, K, 1});
+    const dnnl::memory::desc weight_md(
+        {G, Kg, N}, dnnl::memory::data_type::s8, dnnl::memory::format_tag::any);
+    acc_md = dnnl::memory::desc(
+        {G, M, N}, dnnl::memory::data_type::s32, dnnl::memory::format_tag::abc);
+    const auto matmul_pd = dnnl::matmul::primitive_desc(
+        dnnl::matmul::desc(src_md, weight_md, acc_md), engine);
+    group_fwd_ = std::make_shared<dnnl::matmul>(matmul_pd);
+    fwd_.reset();
+
+    NDArray qweight(Shape2(channels, in_features), Context::CPU(), false, mshadow::kInt8);
+    int8_t* qweight_ptr = qweight.data().dptr<int8_t>();
+    MSHADOW_REAL_TYPE_SWITCH(weight.dtype(), DType, {
+      weight_scales_          = GetGroupWeightScales<DType>(weight, group_size);
+      const DType* weight_ptr = weight.data().dptr<DType>();
+#pragma omp parallel for num_threads(nthreads)
+      for (index_t c = 0; c < channels; ++c) {
+        for (index_t k = 0; k < in_features; ++k) {
+          const float w     = weight_ptr[c * in_features + k];
+          const float scale = weight_scales_[(k / group_size) * channels + c];
+          qweight_ptr[c * in_features + k] =
+              static_cast<int8_t>(Sign(w) * Min(Abs(w) * scale + 0.5f, 127.0f));
+        }
+      }
+    });
+    // the weight is N x K, seen by the matmul as G x Kg x N
+    const dnnl::memory::desc plain_md({G, Kg, N}, dnnl::memory::data_type::s8, {Kg, 1, K});
+    dnnl::memory plain_mem(plain_md, engine, qweight_ptr);
+    auto weight_desc       = matmul_pd.weights_desc();
+    cached_weight_         = NDArray(&weight_desc);
+    auto cached_weight_mem = cached_weight_.GetDNNLData();
+    DNNLStream::Get()->RegisterPrimArgs(
+        dnnl::reorder(plain_mem, *cached_weight_mem),
+        {{DNNL_ARG_FROM, plain_mem}, {DNNL_ARG_TO, *cached_weight_mem}});
+    DNNLStream::Get()->Submit();
+  }
+
+  float_bias_.clear();
+  if (has_bias) {
+    const NDArray& bias = in_data[idx.bias];
+    float_bias_.resize(bias.shape().Size());
+    if (bias.dtype() == mshadow::kInt8) {
+      const float bias_scale = GetQuantizeScale(mshadow::kInt8,
+                                                in_data[idx.bias_min].data().dptr<float>()[0],
+                                                in_data[idx.bias_max].data().dptr<float>()[0]);
+      const int8_t* bias_ptr = bias.data().dptr<int8_t>();
+      for (size_t c = 0; c < float_bias_.size(); ++c) {
+        float_bias_[c] = bias_ptr[c] / bias_scale;
+      }
+    } else {
+      CHECK_EQ(bias.dtype(), mshadow::kFloat32) << "Unsupported bias type of quantized FC";
+      const float* bias_ptr = bias.data().dptr<float>();
+      std::copy(bias_ptr, bias_ptr + float_bias_.size(), float_bias_.begin());
+    }
+  }
+
+  // the float results are written over the accumulators of the first group
+  cached_acc_mem_ = std::make_shared<dnnl::memory>(acc_md, engine);
+  const dnnl::memory::desc float_md = CreateOutputMemoryDesc(output.shape(), mshadow::kFloat32);
+  cached_acc_float_mem_ =
+      std::make_shared<dnnl::memory>(float_md, engine, cached_acc_mem_->get_data_handle());
+  eltwise_fwd_.reset();
+  if (dnnl_param.with_eltwise) {
+    dnnl::eltwise_forward::desc desc(dnnl::prop_kind::forward_scoring,
+                                     full_param_.eltwise_param.alg,
+                                     float_md,
+                                     full_param_.eltwise_param.alpha,
+                                     full_param_.eltwise_param.beta);
+    eltwise_fwd_ = std::make_shared<dnnl::eltwise_forward>(
+        dnnl::eltwise_forward::primitive_desc(desc, engine));
+  }
+
+  cached_data_mem_ = std::make_shared<dnnl::memory>(src_md, engine);
+  args_.clear();
+  args_[DNNL_ARG_SRC]     = *cached_data_mem_;
+  args_[DNNL_ARG_WEIGHTS] = *static_cast<const dnnl::memory*>(cached_weight_.GetDNNLData());
+  args_[DNNL_ARG_DST]     = *cached_acc_mem_;
+  weight_ver_             = weight.version();
+  cached_data_shape_      = in_data[idx.data].shape();
+  post_scale_initialized_ = true;
+}
+
+void SgDNNLFCOp::ForwardWithPostScale(const std::vector<NDArray>& in_data,
+                                      const NDArray& output,
+                                      const std::vector<NDArray>& out_data) {
+  const FCInputIndex idx(full_param_);
+  const auto& dnnl_param = full_param_.dnnl_param;
+  CHECK(dnnl_param.enabled_float_output.has_value() || !dnnl_param.dynamic_quantize)
+      << "dynamic_quantize of FullyConnected requires a float output, with the dequantize "
+         "fused into it";
+
+  NDArray data = in_data[idx.data];
+  if (data.IsDNNLData()) {
+    data = data.Reorder2Default();
+  }
+  data = FlattenData(data);
+  if (!post_scale_initialized_ || in_data[idx.data].shape() != cached_data_shape_ ||
+      in_data[idx.weight].version() != weight_ver_) {
+    InitializePostScale(data, in_data, output);
+  }
+
+  cached_data_mem_->set_data_handle(reinterpret_cast<void*>(data.data().dptr_));
+  if (num_groups_ > 1) {
+    DNNLStream::Get()->RegisterPrimArgs(*group_fwd_, args_);
+  } else {
+    DNNLStream::Get()->RegisterPrimArgs(fwd_->GetFwd(), args_);
+  }
+  DNNLStream::Get()->Submit();
+
+  // dequantize with the scale of this batch,
+  // y = sum over the groups of acc / (data_scale * weight_scale) + bias
+  const float data_scale = GetQuantizeScale(data.dtype(),
+                                            in_data[idx.data_min].data().dptr<float>()[0],
+                                            in_data[idx.data_max].data().dptr<float>()[0]);
+  const index_t channels = in_data[idx.weight].shape()[0];
+  const index_t rows     = output.shape().Size() / channels;
+  const index_t groups   = num_groups_;
+  std::vector<float> scales(weight_scales_.size());
+  for (size_t i = 0; i < scales.size(); ++i) {
+    scales[i] = 1.0f / (data_scale * weight_scales_[i]);
+  }
+  const bool has_bias     = !float_bias_.empty();
+  const bool with_sum     = dnnl_param.with_sum;
+  const bool float_output = output.dtype() == mshadow::kFloat32;
+  const auto nthreads     = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const int32_t* acc      = static_cast<const int32_t*>(cached_acc_mem_->get_data_handle());
+  float* acc_float        = static_cast<float*>(cached_acc_float_mem_->get_data_handle());
+  float* out              = float_output ? output.data().dptr<float>() : nullptr;
+  // the post-ops and the quantization of the output need the scaled values first, they are
+  // scaled in place into the accumulators
+  float* scaled = (eltwise_fwd_ || !float_output) ? acc_float : out;
+#pragma omp parallel for num_threads(nthreads)
+  for (index_t i = 0; i < rows; ++i) {
+    for (index_t c = 0; c < channels; ++c) {
+      const index_t k = i * channels + c;
+      float value     = has_bias ? float_bias_[c] : 0.0f;
+      for (index_t g = 0; g < groups; ++g) {
+        value += acc[(g * rows + i) * channels + c] * scales[g * channels + c];
+      }
+      scaled[k] = (with_sum && scaled == out) ? out[k] + value : value;
+    }
+  }
+  if (eltwise_fwd_) {
+    DNNLStream::Get()->RegisterPrimArgs(
+        *eltwise_fwd_,
+        {{DNNL_ARG_SRC, *cached_acc_float_mem_}, {DNNL_ARG_DST, *cached_acc_float_mem_}});
+    DNNLStream::Get()->Submit();
+  }
+  if (scaled == out) {
+    return;
+  }
+  const index_t size = rows * channels;
+  if (float_output) {
+#pragma omp parallel for num_threads(nthreads)
+    for (index_t k = 0; k < size; ++k) {
+      out[k] = with_sum ? out[k] + acc_float[k] : acc_float[k];
+    }
+    return;
+  }
+  float* output_min_ptr = out_data[1].data().dptr<float>();
+  float* output_max_ptr = out_data[2].data().dptr<float>();
+  if (output.dtype() == mshadow::kInt32) {
+    // not calibrated, the range of the output is the one of this batch
+    float range = 0.0f;
+#pragma omp parallel for reduction(max : range) num_threads(nthreads)
+    for (index_t k = 0; k < size; ++k) {
+      range = Max(range, Abs(acc_float[k]));
+    }
+    int32_t* qout = output.data().dptr<int32_t>();
+#pragma omp parallel for num_threads(nthreads)
+    for (index_t k = 0; k < size; ++k) {
+      qout[k] = FloatToQuantized<int32_t>(acc_float[k], -range, range);
+    }
+    *output_min_ptr = -range;
+    *output_max_ptr = range;
+    return;
+  }
+  CHECK(dnnl_param.min_calib_range.has_value() && dnnl_param.max_calib_range.has_value());
+  const float out_min   = dnnl_param.min_calib_range.value();
+  const float out_max   = dnnl_param.max_calib_range.value();
+  const float out_scale = GetQuantizeScale(output.dtype(), out_min, out_max);
+  if (output.dtype() == mshadow::kUint8) {
+    uint8_t* qout = output.data().dptr<uint8_t>();
+#pragma omp parallel for num_threads(nthreads)
+    for (index_t k = 0; k < size; ++k) {
+      qout[k] = static_cast<uint8_t>(Min(Max(acc_float[k], 0.0f) * out_scale + 0.5f, 255.0f));
+    }
+  } else {
+    int8_t* qout = output.data().dptr<int8_t>();
+#pragma omp parallel for num_threads(nthreads)
+    for (index_t k = 0; k < size; ++k) {
+      qout[k] = static_cast<int8_t>(Sign(acc_float[k]) *
+                                    Min(Abs(acc_float[k]) * out_scale + 0.5f, 127.0f));
+    }
+  }
+  *output_min_ptr = out_min;
+  *output_max_ptr = out_max;
+}
+
 NDArray SgDNNLFCOp::PrepareOutputWithSum(const NDArray& sum_input, const NDArray& output) {
   if (!initialized_) {
     // TODO(zhennan): Currently, dnnl fallback mechanism will break inplace option,
@@ -508,12 +813,11 @@ void SgDNNLFCOp::GetCachedWeightsAndBias(const NDArray& weight,
                                          bool support_channelwise_scale,
                                          bool has_bias) {
 #if DMLC_CXX11_THREAD_LOCAL
-  static thread_local std::unordered_map<DNNLFullyconSignature, std::pair<NDArray, NDArray>, OpHash>
+  static thread_local DNNLCache<DNNLFullyconSignature, std::pair<NDArray, NDArray>, OpHash>
       fcWeightsAndBias;
 #else
-  static MX_THREAD_LOCAL
-      std::unordered_map<DNNLFullyconSignature, std::pair<NDArray, NDArray>, OpHash>
-          fcWeightsAndBias;
+  static MX_THREAD_LOCAL DNNLCache<DNNLFullyconSignature, std::pair<NDArray, NDArray>, OpHash>
+      fcWeightsAndBias;
 #endif
   static const bool use_cache = !(dmlc::GetEnv("MXNET_ONEDNN_DISABLE_FC_CACHE", 0));
   const bool has_id           = attrs.dict.count("__identifier__");
@@ -847,7 +1151,7 @@ static bool SgDNNLAvoidFCQuantizeInput(const NodeAttrs& attrs,
   auto const& full_param = nnvm::get<DNNLFCFullParam>(attrs.parsed);
   std::unordered_set<size_t> avoid_indexes;
   FCInputIndex idx(full_param);
-  if (quantize_granularity == "channel-wise") {
+  if (quantize_granularity == "channel-wise" || quantize_granularity == "group-wise") {
     avoid_indexes.insert(fullc::kWeight);  // weight
     if (!full_param.default_param.no_bias) {
       avoid_indexes.insert(fullc::kBias);  // bias
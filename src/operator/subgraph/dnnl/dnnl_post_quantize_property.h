@@ -24,6 +24,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "operator/nn/dnnl/dnnl_convolution-inl.h"
@@ -51,6 +52,17 @@ bool SupportsRequantizeFusion(const Op* op) {
 
   return support_requantize_fusion_ops.count(op) > 0;
 }
+
+/*! \brief operators that can scale their output at runtime, see dynamic_quantize */
+bool SupportsDynamicQuantize(const Op* op) {
+  static const std::set<const Op*> support_dynamic_quantize_ops = {
+      Op::Get("_sg_onednn_fully_connected"),
+      Op::Get("_sg_onednn_selfatt_qk"),
+      Op::Get("_sg_onednn_selfatt_qk_split"),
+      Op::Get("_sg_onednn_selfatt_valatt")};
+
+  return support_dynamic_quantize_ops.count(op) > 0;
+}
 }  // namespace
 
 class SgDNNLPostQuantizeSelector : public SubgraphSelectorV2 {
@@ -65,18 +77,24 @@ class SgDNNLPostQuantizeSelector : public SubgraphSelectorV2 {
 
   bool fuse_all;
   bool float_output;
+  bool dynamic_quantize;
+  /*! \brief whether the matched requantize has no calibrated range, it then needs a dequantize */
+  bool uncalibrated = false;
   SelectStatusPostQuantize status;
   std::vector<const BiDirectedNode*> matched_list;
 
  public:
-  explicit SgDNNLPostQuantizeSelector(const bool fuse_all, const bool float_output)
-      : fuse_all(fuse_all), float_output(float_output) {}
+  SgDNNLPostQuantizeSelector(const bool fuse_all,
+                             const bool float_output,
+                             const bool dynamic_quantize)
+      : fuse_all(fuse_all), float_output(float_output), dynamic_quantize(dynamic_quantize) {}
 
   bool Select(const BiDirectedNode& n) override {
     const nnvm::Node* raw_node = n.node;
 
     if (fuse_all && raw_node->op() && SupportsRequantizeFusion(raw_node->op())) {
-      status = SelectStatusPostQuantize::kStart;
+      status       = SelectStatusPostQuantize::kStart;
+      uncalibrated = false;
       matched_list.clear();
       matched_list.emplace_back(&n);
       return true;
@@ -124,6 +142,14 @@ class SgDNNLPostQuantizeSelector : public SubgraphSelectorV2 {
             }
             return true;
           }
+          // With no calibrated range, the requantize and the following dequantize are fused as
+          // a float output scaled at runtime from the ranges of the inputs.
+          if (dynamic_quantize && float_output && SupportsDynamicQuantize(raw_node->op())) {
+            matched_list.emplace_back(&new_node);
+            status       = SelectStatusPostQuantize::kRequantize;
+            uncalibrated = true;
+            return true;
+          }
         }
       case SelectStatusPostQuantize::kRequantize:
         if (float_output && raw_new_node->op() == Op::Get("_contrib_dequantize")) {
@@ -150,7 +176,8 @@ class SgDNNLPostQuantizeSelector : public SubgraphSelectorV2 {
   }
 
   std::vector<BiDirectedNode*> Filter(const std::vector<BiDirectedNode*>& candidates) override {
-    if (status != SelectStatusPostQuantize::kSuccess || (matched_list.size() <= 1)) {
+    if (status != SelectStatusPostQuantize::kSuccess || (matched_list.size() <= 1) ||
+        (uncalibrated && matched_list.back()->node->op() != Op::Get("_contrib_dequantize"))) {
       return std::vector<BiDirectedNode*>(0);
     } else {
       std::vector<BiDirectedNode*> ret;
@@ -166,7 +193,7 @@ class SgDNNLPostQuantizeSelector : public SubgraphSelectorV2 {
 
   void Reset() override {
     CHECK_GE(matched_list.size(), 1);
-    auto new_selector = SgDNNLPostQuantizeSelector(fuse_all, float_output);
+    auto new_selector = SgDNNLPostQuantizeSelector(fuse_all, float_output, dynamic_quantize);
     new_selector.Select(*matched_list[0]);
     *this = new_selector;
   }
@@ -176,6 +203,7 @@ class SgDNNLPostQuantizeProperty : public SubgraphProperty {
  private:
   bool fuse_all;
   bool float_output;
+  bool dynamic_quantize = false;
 
  public:
   SgDNNLPostQuantizeProperty() {
@@ -183,6 +211,13 @@ class SgDNNLPostQuantizeProperty : public SubgraphProperty {
     float_output = dmlc::GetEnv("MXNET_ONEDNN_FUSE_DEQUANTIZE", true);
   }
 
+  void PrePartition(const nnvm::Graph& g,
+                    const std::unordered_map<std::string, std::string>& options_map) override {
+    SubgraphProperty::PrePartition(g, options_map);
+    auto it          = options_map.find("dynamic_quantize");
+    dynamic_quantize = it != options_map.end() && it->second == "True";
+  }
+
   static SubgraphPropertyPtr Create() {
     static const std::string& name = "oneDNN post-quantization optimization pass";
     auto property                  = std::make_shared<SgDNNLPostQuantizeProperty>();
@@ -212,12 +247,17 @@ class SgDNNLPostQuantizeProperty : public SubgraphProperty {
     CHECK_NOTNULL(fuse_node);
     CHECK_NOTNULL(requantize_node);
     auto const& requantize_param = nnvm::get<RequantizeParam>(requantize_node->attrs.parsed);
-    CHECK(requantize_param.min_calib_range.has_value());
-    CHECK(requantize_param.max_calib_range.has_value());
+    const bool calibrated        = requantize_param.min_calib_range.has_value() &&
+                                   requantize_param.max_calib_range.has_value();
 
     // When only fused quantized operator and requantize, set min/max_cablib_range,
     // When fused quantized operator + requantize + dequantize, set dequantize flag to true.
-    if (dequantize_node != nullptr) {
+    // When the requantize is not calibrated, the output is scaled at runtime.
+    if (!calibrated) {
+      CHECK_NOTNULL(dequantize_node);
+      fuse_node->attrs.dict["enabled_float_output"] = type_string(mshadow::kFloat32);
+      fuse_node->attrs.dict["dynamic_quantize"]     = "True";
+    } else if (dequantize_node != nullptr) {
       fuse_node->attrs.dict["enabled_float_output"] = type_string(mshadow::kFloat32);
     } else {
       fuse_node->attrs.dict["min_calib_range"] =
@@ -230,7 +270,8 @@ class SgDNNLPostQuantizeProperty : public SubgraphProperty {
   }
 
   SubgraphSelectorV2Ptr CreateSubgraphSelectorV2() const override {
-    auto selector = std::make_shared<SgDNNLPostQuantizeSelector>(fuse_all, float_output);
+    auto selector =
+        std::make_shared<SgDNNLPostQuantizeSelector>(fuse_all, float_output, dynamic_quantize);
     return selector;
   }
 
@@ -19,12 +19,19 @@
 
 /*!
  * \file dnnl_remove_casts_property.h
- * \brief Graph property for removing two unnecessary Cast operations
+ * \brief Graph properties for removing unnecessary Cast operations
  *
  * ... -> Cast(dtype) -> expand_dims -> Cast(dtype) -> Cast(dtype) -> ...
  *                                  ||
  *                                  \/
  *                ... -> Cast(dtype) -> expand_dims -> ...
+ *
+ * and, after the AMP conversion, the round trips through float32
+ *
+ * ... -> amp_cast(float32) -> amp_cast(dtype) -> ...
+ *                          ||
+ *                          \/
+ *               ... -> amp_cast(dtype) -> ...
  */
 
 #ifndef MXNET_OPERATOR_SUBGRAPH_DNNL_DNNL_REMOVE_CASTS_PROPERTY_H_
@@ -36,6 +43,7 @@
 #include <string>
 #include <vector>
 
+#include "operator/tensor/amp_cast.h"
 #include "operator/subgraph/common.h"
 #include "dnnl_subgraph_base-inl.h"
 
@@ -147,6 +155,96 @@ class SgDNNLRemoveCastsProperty : public SubgraphProperty {
   }
 };
 
+/*!
+ * \brief Selects an amp_cast to float32 consumed only by another amp_cast. amp_cast converts
+ *  only float32, float16 and bfloat16 data, so the cast to float32 is exact and the pair is
+ *  equivalent to the second cast alone, which is an in-place identity when it casts back to
+ *  the type of the input, e.g. bfloat16 -> float32 -> bfloat16 between two bfloat16 nodes.
+ */
+class SgDNNLRemoveAMPCastsSelector : public SubgraphSelectorV2 {
+ private:
+  enum CastStatus { kStart, kSuccess, kFail };
+  CastStatus status_ = kFail;
+
+ public:
+  bool Select(const BiDirectedNode& seed_node,
+              const std::shared_ptr<NodeAttr>& node_attr) override {
+    const nnvm::Node* n = seed_node.node;
+    if (n->op() == Op::Get("amp_cast") && seed_node.outputs.size() == 1 &&
+        seed_node.outputs.begin()->second.size() == 1 &&
+        nnvm::get<AMPCastParam>(n->attrs.parsed).dtype == mshadow::kFloat32) {
+      status_ = kStart;
+      return true;
+    }
+    return false;
+  }
+
+  bool SelectInput(const BiDirectedNode& n, const BiDirectedNode& input_node) override {
+    return false;
+  }
+
+  bool SelectOutput(const BiDirectedNode& n, const BiDirectedNode& output_node) override {
+    if (status_ != kStart || output_node.node->is_variable()) {
+      return false;
+    }
+    if (output_node.node->op() == Op::Get("amp_cast")) {
+      status_ = kSuccess;
+      return true;
+    }
+    status_ = kFail;
+    return false;
+  }
+
+  std::vector<BiDirectedNode*> Filter(const std::vector<BiDirectedNode*>& candidates) override {
+    return status_ == kSuccess ? candidates : std::vector<BiDirectedNode*>(0);
+  }
+
+  void Reset() override {
+    status_ = kStart;
+  }
+};
+
+class SgDNNLRemoveAMPCastsProperty : public SubgraphProperty {
+ public:
+  SgDNNLRemoveAMPCastsProperty() {}
+
+  static SubgraphPropertyPtr Create() {
+    static const std::string& name = "Remove AMP Casts optimization pass";
+    auto property                  = std::make_shared<SgDNNLRemoveAMPCastsProperty>();
+    property->SetAttr<std::string>("property_name", name);
+    property->SetAttr<bool>("inference_only", true);
+    if (dmlc::GetEnv("MXNET_DISABLE_REMOVE_CASTS_PROPERTY", 0)) {
+      property->SetAttr<bool>("disable", true);
+    }
+    return property;
+  }
+
+  nnvm::ObjectPtr CreateSubgraphNode(const nnvm::Symbol& sym,
+                                     const int subgraph_id = 0) const override {
+    for (const auto& e : sym.outputs) {
+      // the cast to float32, whose input is outside of the subgraph, is an output of the graph
+      if (e.node->inputs[0].node->is_variable()) {
+        return nullptr;
+      }
+    }
+    nnvm::ObjectPtr n = nnvm::Node::Create();
+    n->attrs          = sym.outputs[0].node->attrs;
+    return n;
+  }
+
+  SubgraphSelectorV2Ptr CreateSubgraphSelectorV2() const override {
+    auto selector = std::make_shared<SgDNNLRemoveAMPCastsSelector>();
+    return selector;
+  }
+
+  void ConnectSubgraphOutputs(const nnvm::ObjectPtr subgraph_node,
+                              std::vector<nnvm::NodeEntry*>* output_entries) const override {
+    for (size_t i = 0; i < output_entries->size(); ++i) {
+      *output_entries->at(i) = nnvm::NodeEntry{subgraph_node, 0, 0};
+    }
+  }
+};
+
 }  // namespace op
 }  // namespace mxnet
 
@@ -29,6 +29,7 @@
 #include "dnnl_post_quantize_property.h"
 #include "dnnl_pow_mul_scalar_property.h"
 #include "dnnl_transformer_qk_property.h"
+#include "dnnl_transformer_softmax_property.h"
 #include "dnnl_transformer_valatt_property.h"
 #include "dnnl_fc_sum_fuse_property.h"
 #include "dnnl_remove_casts_property.h"
@@ -64,11 +65,13 @@ MXNET_REGISTER_SUBGRAPH_PROPERTY(ONEDNN_QUANTIZE, SgDNNLTransformerValAttPropert
 MXNET_REGISTER_SUBGRAPH_PROPERTY(ONEDNN_QUANTIZE, SgDNNLBatchDotProperty)
     .set_attr("quantize", true);
 MXNET_REGISTER_SUBGRAPH_PROPERTY(ONEDNN_QUANTIZE, SgDNNLPostQuantizeProperty);
+MXNET_REGISTER_SUBGRAPH_PROPERTY(ONEDNN_QUANTIZE, SgDNNLTransformerSoftmaxProperty);
 MXNET_REGISTER_SUBGRAPH_PROPERTY(ONEDNN_QUANTIZE, SgDNNLPostQuantizeAlignScaleProperty);
 MXNET_REGISTER_SUBGRAPH_PROPERTY(ONEDNN_QUANTIZE, SgDNNLFCSumFuseProperty)
     .set_attr("quantize", true);
 
 MXNET_REGISTER_SUBGRAPH_BACKEND(ONEDNN_AMP).set_attr("context", Context::CPU());
+MXNET_REGISTER_SUBGRAPH_PROPERTY(ONEDNN_AMP, SgDNNLRemoveAMPCastsProperty);
 MXNET_REGISTER_SUBGRAPH_PROPERTY(ONEDNN_AMP, SgDNNLPostAMPProperty);
 
 }  // namespace op
@@ -28,13 +28,23 @@ namespace op {
 
 struct DNNLSelfAttParam : public dmlc::Parameter<DNNLSelfAttParam> {
   int heads;
+  int kv_heads;
   bool quantized;
   dmlc::optional<float> min_calib_range;     // min float value calculated from calibration dataset
   dmlc::optional<float> max_calib_range;     // max float value calculated from calibration dataset
   dmlc::optional<int> enabled_float_output;  // mshadow dtype of a fused amp_cast node
+  bool dynamic_quantize;
+  bool with_masked_softmax;
+  dmlc::optional<double> temperature;
 
   DMLC_DECLARE_PARAMETER(DNNLSelfAttParam) {
     DMLC_DECLARE_FIELD(heads).describe("Set number of heads.");
+    DMLC_DECLARE_FIELD(kv_heads)
+        .set_default(0)
+        .set_lower_bound(0)
+        .describe(
+            "Number of key and value heads, each shared by heads / kv_heads query heads "
+            "(grouped-query attention). 0 means heads.");
     DMLC_DECLARE_FIELD(quantized).set_default(false).describe(
         "Whether it's a quantized self attention matmul operator.");
     DMLC_DECLARE_FIELD(min_calib_range)
@@ -50,6 +60,19 @@ struct DNNLSelfAttParam : public dmlc::Parameter<DNNLSelfAttParam> {
             "through calibration. If present, it will be used to by "
             "quantized self-attention op to calculate primitive scale.");
     DNNL_DECLARE_ENABLED_FLOAT_OUTPUT_PARAMETER();
+    DMLC_DECLARE_FIELD(dynamic_quantize)
+        .set_default(false)
+        .describe(
+            "Whether the range of the quantized inputs changes with every batch, computed at "
+            "runtime instead of calibrated. The output scale is then set at runtime.");
+    DMLC_DECLARE_FIELD(with_masked_softmax)
+        .set_default(false)
+        .describe(
+            "Whether a masked_softmax of the attention scores and the quantization of its output "
+            "to uint8 are fused, the mask is then the last input.");
+    DMLC_DECLARE_FIELD(temperature)
+        .set_default(dmlc::optional<double>())
+        .describe("Temperature of the fused masked_softmax.");
   }
 };
 
@@ -19,6 +19,8 @@
 
 #if MXNET_USE_ONEDNN == 1
 
+#include <algorithm>
+#include <cfloat>
 #include <string>
 #include <utility>
 #include <vector>
@@ -29,14 +31,21 @@
 #include "operator/subgraph/common.h"
 #include "dnnl_transformer-inl.h"
 
-// 3 tensors within one (queries keys values)
-#define QKV_NUM 3
-
 namespace mxnet {
 namespace op {
 
 DMLC_REGISTER_PARAMETER(DNNLSelfAttParam);
 
+// number of key and value heads, each shared by heads / kv_heads query heads
+static inline int GetKVHeads(const DNNLSelfAttParam& param) {
+  return param.kv_heads > 0 ? param.kv_heads : param.heads;
+}
+
+// head dimension of the [queries | keys | values] projections of proj_dim
+static inline index_t GetHeadDim(const DNNLSelfAttParam& param, const index_t proj_dim) {
+  return proj_dim / (param.heads + 2 * GetKVHeads(param));
+}
+
 template <bool with_split>
 static bool SgDNNLSelfAttShape(const NodeAttrs& attrs,
                                mxnet::ShapeVector* in_shape,
@@ -48,6 +57,9 @@ static bool SgDNNLSelfAttShape(const NodeAttrs& attrs,
   CHECK_EQ(in_shape_0.ndim(), 3U)
       << "Input queries_keys_values should be 3D in batch-seq_length-proj_dim, "
       << "but the given tensor is " << in_shape_0.ndim() << "D";
+  const int kv_heads = GetKVHeads(params);
+  CHECK_EQ(params.heads % kv_heads, 0) << "heads should be a multiple of kv_heads, currently are "
+                                       << params.heads << " and " << kv_heads;
 
   if constexpr (!with_split) {
     in_shape_1 = in_shape->at(1);  // without split we need to consider 2nd input
@@ -55,12 +67,16 @@ static bool SgDNNLSelfAttShape(const NodeAttrs& attrs,
         << "Input queries_keys_values should be 3D in batch-seq_length-proj_dim, "
         << "but the given tensor is " << in_shape_1.ndim() << "D";
     CHECK_EQ(in_shape_0[0], in_shape_1[0]);
-    CHECK_EQ(in_shape_0[2], in_shape_1[2]);
+    // the keys have kv_heads heads of the head dimension of the queries
+    CHECK_EQ(in_shape_0[2] * kv_heads, in_shape_1[2] * params.heads);
     in_shape_num = 2;
+  } else {
+    CHECK_EQ(in_shape_0[2] % (params.heads + 2 * kv_heads), 0)
+        << "Input queries_keys_values.shape[2] should be a multiple of heads + 2 * kv_heads";
   }
 
   if (params.quantized) {
-    CHECK_EQ(in_shape->size(), 3 * in_shape_num)
+    CHECK_EQ(in_shape->size(), 3 * in_shape_num + params.with_masked_softmax)
         << "Input: [queries_keys_values, min_qkv, max_qkv] "
         << "- currently have " << in_shape->size() << " inputs";
     if constexpr (with_split) {
@@ -86,6 +102,21 @@ static bool SgDNNLSelfAttShape(const NodeAttrs& attrs,
 
   SHAPE_ASSIGN_CHECK(
       *out_shape, 0, mxnet::TShape({in_shape_0[0], params.heads, in_shape_0[1], in_shape_1[1]}));
+  if (params.with_masked_softmax) {
+    // the mask is broadcast to the attention scores
+    const mxnet::TShape& mask_shape = in_shape->back();
+    const mxnet::TShape& att_shape  = out_shape->at(0);
+    if (!mxnet::ndim_is_known(mask_shape)) {
+      return false;
+    }
+    CHECK_EQ(mask_shape.ndim(), 4U) << "Mask should be 4D in batch-heads-seq_length-seq_length, "
+                                    << "but the given tensor is " << mask_shape.ndim() << "D";
+    for (int i = 0; i < 4; ++i) {
+      CHECK(mask_shape[i] == 1 || mask_shape[i] == att_shape[i])
+          << "Mask of shape " << mask_shape << " cannot be broadcast to the attention scores "
+          << "of shape " << att_shape;
+    }
+  }
   return true;
 }
 
@@ -100,7 +131,7 @@ static bool SgDNNLSelfAttQKInferType(const nnvm::NodeAttrs& attrs,
     in_shape_num = 2;
   }
   if (params.quantized) {
-    CHECK_EQ(in_types->size(), 3 * in_shape_num);
+    CHECK_EQ(in_types->size(), 3 * in_shape_num + params.with_masked_softmax);
 
     if (in_types->at(0) == mshadow::kBfloat16) {
       return false;
@@ -120,12 +151,19 @@ static bool SgDNNLSelfAttQKInferType(const nnvm::NodeAttrs& attrs,
       TYPE_ASSIGN_CHECK(*in_types, 5, mshadow::kFloat32);
     }
 
+    if (params.with_masked_softmax) {
+      TYPE_ASSIGN_CHECK(*in_types, in_types->size() - 1, mshadow::kBool);
+    }
+
     if (params.enabled_float_output.has_value()) {
       CHECK_EQ(out_types->size(), 1U);
       TYPE_ASSIGN_CHECK(*out_types, 0, params.enabled_float_output.value());
     } else {
       CHECK_EQ(out_types->size(), 3U);
-      if (params.min_calib_range.has_value() && params.max_calib_range.has_value()) {
+      if (params.with_masked_softmax) {
+        // probabilities are not negative
+        TYPE_ASSIGN_CHECK(*out_types, 0, mshadow::kUint8);
+      } else if (params.min_calib_range.has_value() && params.max_calib_range.has_value()) {
         TYPE_ASSIGN_CHECK(*out_types, 0, mshadow::kInt8);
       } else {
         TYPE_ASSIGN_CHECK(*out_types, 0, mshadow::kInt32);
@@ -191,6 +229,12 @@ class SgDNNLSelfAttQKOp {
   }
 
  private:
+  /*! \brief scale of the output from the ranges of the quantized inputs */
+  template <bool with_split>
+  float GetOutputScale(const OpContext& ctx, const std::vector<NDArray>& inputs, int out_dtype);
+  /*! \brief masked softmax of the float scores, quantized to uint8 into the output */
+  void MaskedSoftmaxQuantize(const NDArray& mask, const NDArray& output);
+
   bool initialized_{false};
   DNNLSelfAttParam param_;
   dnnl_args_map_t args_;
@@ -198,6 +242,8 @@ class SgDNNLSelfAttQKOp {
   std::shared_ptr<dnnl::memory> cached_query_mem_;
   std::shared_ptr<dnnl::memory> cached_key_mem_;
   std::shared_ptr<dnnl::memory> cached_out_mem_;
+  std::shared_ptr<dnnl::memory> cached_oscale_mem_;  // runtime output scale, dynamic_quantize
+  std::shared_ptr<dnnl::memory> cached_scores_mem_;  // float scores, with_masked_softmax
   float min_data_0_;
   float max_data_0_;
   float min_data_1_;
@@ -238,6 +284,49 @@ static bool SgDNNLSelfAttStorageType(const nnvm::NodeAttrs& attrs,
   return DNNLStorageType(attrs, dev_mask, true, dispatch_mode, in_attrs, out_attrs);
 }
 
+template <bool with_split>
+float SgDNNLSelfAttQKOp::GetOutputScale(const OpContext& ctx,
+                                        const std::vector<NDArray>& inputs,
+                                        int out_dtype) {
+  const NDArray& in_tensor_0 = inputs[0];
+  if constexpr (with_split) {
+    min_data_0_ = min_data_1_ = inputs[1].data().dptr<float>()[0];
+    max_data_0_ = max_data_1_ = inputs[2].data().dptr<float>()[0];
+    data_scale_0_ = data_scale_1_ =
+        GetQuantizeScale(in_tensor_0.dtype(), min_data_0_, max_data_0_);
+  } else {
+    min_data_0_   = inputs[2].data().dptr<float>()[0];
+    max_data_0_   = inputs[3].data().dptr<float>()[0];
+    min_data_1_   = inputs[4].data().dptr<float>()[0];
+    max_data_1_   = inputs[5].data().dptr<float>()[0];
+    data_scale_0_ = GetQuantizeScale(in_tensor_0.dtype(), min_data_0_, max_data_0_);
+    data_scale_1_ = GetQuantizeScale(inputs[1].dtype(), min_data_1_, max_data_1_);
+  }
+
+  float oscale = 1.0f;
+  if (param_.with_masked_softmax) {
+    // the matmul writes the float scores, divided by the temperature of the softmax
+    min_output_ = param_.min_calib_range.value();
+    max_output_ = param_.max_calib_range.value();
+    oscale      = 1.0f / (data_scale_0_ * data_scale_1_);
+    if (param_.temperature.has_value()) {
+      oscale /= param_.temperature.value();
+    }
+  } else if (param_.min_calib_range.has_value() && param_.max_calib_range.has_value()) {
+    min_output_ = param_.min_calib_range.value();
+    max_output_ = param_.max_calib_range.value();
+    oscale =
+        GetQuantizeScale(out_dtype, min_output_, max_output_) / (data_scale_0_ * data_scale_1_);
+  } else if (param_.enabled_float_output.has_value()) {
+    oscale = 1.0f / (data_scale_0_ * data_scale_1_);
+  } else {
+    mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
+    mxnet_op::Kernel<QuantizationRangeForS8S8MultiplicationStruct, cpu>::Launch(
+        s, 1, &min_output_, &max_output_, &min_data_0_, &max_data_0_, &min_data_1_, &max_data_1_);
+  }
+  return oscale;
+}
+
 template <bool with_split>
 void SgDNNLSelfAttQKOp::Initialize(const OpContext& ctx,
                                    const std::vector<NDArray>& inputs,
@@ -252,66 +341,55 @@ void SgDNNLSelfAttQKOp::Initialize(const OpContext& ctx,
   const auto in_dtype = get_dnnl_type(in_tensor_0.dtype());
 
   const memory::dim heads          = param_.heads;
+  const memory::dim kv_heads       = GetKVHeads(param_);
+  const memory::dim group_size     = heads / kv_heads;
   const memory::dim sequences      = in_tensor_0.shape()[0];
   const memory::dim qkv_seq_len_0  = in_tensor_0.shape()[1];
   const memory::dim output_lin_dim = in_tensor_0.shape()[2];
-  memory::dim embed_dim            = output_lin_dim;
+  memory::dim head_dim;
   if constexpr (with_split) {
-    embed_dim /= QKV_NUM;
+    head_dim = GetHeadDim(param_, output_lin_dim);
   } else {
     in_tensor_1 = inputs[1];  // without split we need to consider 2nd input
+    head_dim    = output_lin_dim / heads;
   }
+  const memory::dim key_lin_dim    = in_tensor_1.shape()[2];
   const memory::dim qkv_seq_len_1  = in_tensor_1.shape()[1];
-  const memory::dim head_dim       = embed_dim / heads;
   const memory::dim batch_stride_0 = output_lin_dim * qkv_seq_len_0;
-  const memory::dim batch_stride_1 = output_lin_dim * qkv_seq_len_1;
-
-  float min_data = 0.0f;
-  float max_data = 0.0f;
+  const memory::dim batch_stride_1 = key_lin_dim * qkv_seq_len_1;
 
   const auto engine = CpuEngine::Get()->get_engine();
 
-  memory::dims query_dims    = {sequences, heads, qkv_seq_len_0, head_dim};
-  memory::dims key_dims      = {sequences, heads, head_dim, qkv_seq_len_1};
-  memory::dims query_strides = {batch_stride_0, head_dim, output_lin_dim, 1};
-  memory::dims key_strides   = {batch_stride_1, head_dim, 1, output_lin_dim};
+  // the heads of the queries are grouped by the key head they share, which is broadcast
+  memory::dims query_dims    = {sequences, kv_heads, group_size, qkv_seq_len_0, head_dim};
+  memory::dims key_dims      = {sequences, kv_heads, 1, head_dim, qkv_seq_len_1};
+  memory::dims out_dims      = {sequences, kv_heads, group_size, qkv_seq_len_0, qkv_seq_len_1};
+  memory::dims query_strides = {batch_stride_0, group_size * head_dim, head_dim, output_lin_dim, 1};
+  memory::dims key_strides   = {batch_stride_1, head_dim, head_dim, 1, key_lin_dim};
 
   auto query_md = memory::desc(query_dims, in_dtype, query_strides);
   auto key_md   = memory::desc(key_dims, in_dtype, key_strides);
 
   float oscale = 1.0f;
   if (param_.quantized) {
-    if constexpr (with_split) {
-      min_data_0_   = inputs[1].data().dptr<float>()[0];
-      max_data_0_   = inputs[2].data().dptr<float>()[0];
-      data_scale_0_ = data_scale_1_ =
-          GetQuantizeScale(in_tensor_0.dtype(), min_data_0_, max_data_0_);
-    } else {
-      min_data_0_   = inputs[2].data().dptr<float>()[0];
-      max_data_0_   = inputs[3].data().dptr<float>()[0];
-      min_data_1_   = inputs[4].data().dptr<float>()[0];
-      max_data_1_   = inputs[5].data().dptr<float>()[0];
-      data_scale_0_ = GetQuantizeScale(in_tensor_0.dtype(), min_data_0_, max_data_0_);
-      data_scale_1_ = GetQuantizeScale(in_tensor_1.dtype(), min_data_1_, max_data_1_);
-    }
-
-    if (param_.min_calib_range.has_value() && param_.max_calib_range.has_value()) {
-      min_output_ = param_.min_calib_range.value();
-      max_output_ = param_.max_calib_range.value();
-      oscale      = GetQuantizeScale(out_tensor.dtype(), min_output_, max_output_) /
-               (data_scale_0_ * data_scale_1_);
-    } else if (param_.enabled_float_output.has_value()) {
-      oscale = 1.0f / (data_scale_0_ * data_scale_1_);
-    } else {
-      mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
-      mxnet_op::Kernel<QuantizationRangeForS8S8MultiplicationStruct, cpu>::Launch(
-          s, 1, &min_output_, &max_output_, &min_data, &max_data, &min_data, &max_data);
-    }
+    oscale = GetOutputScale<with_split>(ctx, inputs, out_tensor.dtype());
   }
 
   dnnl::primitive_attr attr;
-  attr.set_output_scales(0, {oscale});
-  auto matmul_d  = matmul::desc(query_md, key_md, GetMemDesc(out_tensor));
+  if (param_.quantized && param_.dynamic_quantize) {
+    // the ranges of the inputs change with every batch, set the scale at runtime
+    attr.set_output_scales(0, {DNNL_RUNTIME_F32_VAL});
+    cached_oscale_mem_ = std::make_shared<memory>(
+        memory::desc({1}, memory::data_type::f32, memory::format_tag::a), engine);
+    *static_cast<float*>(cached_oscale_mem_->get_data_handle()) = oscale;
+    args_[DNNL_ARG_ATTR_OUTPUT_SCALES]                           = *cached_oscale_mem_;
+  } else {
+    attr.set_output_scales(0, {oscale});
+  }
+  const auto out_dtype =
+      param_.with_masked_softmax ? memory::data_type::f32 : get_dnnl_type(out_tensor.dtype());
+  auto out_md = memory::desc(out_dims, out_dtype, memory::format_tag::abcde);
+  auto matmul_d  = matmul::desc(query_md, key_md, out_md);
   auto matmul_pd = matmul::primitive_desc(matmul_d, attr, engine);
   fwd_           = std::make_shared<matmul>(matmul_pd);
 
@@ -319,7 +397,7 @@ void SgDNNLSelfAttQKOp::Initialize(const OpContext& ctx,
     DType* query_mem_ptr = inputs[0].data().dptr<DType>();
     DType* key_mem_ptr;
     if constexpr (with_split) {
-      key_mem_ptr = query_mem_ptr + embed_dim;
+      key_mem_ptr = query_mem_ptr + heads * head_dim;
     } else {
       key_mem_ptr = inputs[1].data().dptr<DType>();
     }
@@ -327,10 +405,15 @@ void SgDNNLSelfAttQKOp::Initialize(const OpContext& ctx,
     cached_key_mem_   = std::make_shared<memory>(key_md, engine, key_mem_ptr);
   });
 
-  MSHADOW_TYPE_SWITCH(out_tensor.dtype(), DType, {
-    cached_out_mem_ =
-        std::make_shared<memory>(matmul_pd.dst_desc(), engine, out_tensor.data().dptr<DType>());
-  });
+  if (param_.with_masked_softmax) {
+    cached_scores_mem_ = std::make_shared<memory>(matmul_pd.dst_desc(), engine);
+    cached_out_mem_    = cached_scores_mem_;
+  } else {
+    MSHADOW_TYPE_SWITCH(out_tensor.dtype(), DType, {
+      cached_out_mem_ =
+          std::make_shared<memory>(matmul_pd.dst_desc(), engine, out_tensor.data().dptr<DType>());
+    });
+  }
 
   args_[DNNL_ARG_SRC]     = *cached_query_mem_;
   args_[DNNL_ARG_WEIGHTS] = *cached_key_mem_;
@@ -345,14 +428,14 @@ void SgDNNLSelfAttQKOp::Forward(const OpContext& ctx,
                                 const std::vector<NDArray>& outputs,
                                 bool already_prepared) {
   if (!already_prepared) {
-    const size_t output_lin_dim = inputs[0].shape()[2];
-    const size_t embed_dim      = output_lin_dim / QKV_NUM;
+    // the keys follow the heads of the queries
+    const index_t key_offset = param_.heads * GetHeadDim(param_, inputs[0].shape()[2]);
 
     MSHADOW_TYPE_SWITCH(inputs[0].dtype(), DType, {
       DType* query_mem_ptr = inputs[0].data().dptr<DType>();
       DType* key_mem_ptr;
       if constexpr (with_split) {
-        key_mem_ptr = query_mem_ptr + embed_dim;
+        key_mem_ptr = query_mem_ptr + key_offset;
       } else {
         key_mem_ptr = inputs[1].data().dptr<DType>();
       }
@@ -360,13 +443,24 @@ void SgDNNLSelfAttQKOp::Forward(const OpContext& ctx,
       cached_key_mem_->set_data_handle(key_mem_ptr);
     });
 
-    MSHADOW_TYPE_SWITCH(outputs[0].dtype(), DType, {
-      cached_out_mem_->set_data_handle(outputs[0].data().dptr<DType>());
-    });
+    if (!param_.with_masked_softmax) {
+      MSHADOW_TYPE_SWITCH(outputs[0].dtype(), DType, {
+        cached_out_mem_->set_data_handle(outputs[0].data().dptr<DType>());
+      });
+    }
+
+    if (param_.quantized && param_.dynamic_quantize) {
+      *static_cast<float*>(cached_oscale_mem_->get_data_handle()) =
+          GetOutputScale<with_split>(ctx, inputs, outputs[0].dtype());
+    }
   }
   DNNLStream::Get()->RegisterPrimArgs(*fwd_, args_);
   DNNLStream::Get()->Submit();
 
+  if (param_.with_masked_softmax) {
+    MaskedSoftmaxQuantize(inputs.back(), outputs[0]);
+  }
+
   if (param_.quantized && !param_.enabled_float_output.has_value()) {
     float* output_min = outputs[1].data().dptr<float>();
     float* output_max = outputs[2].data().dptr<float>();
@@ -375,6 +469,56 @@ void SgDNNLSelfAttQKOp::Forward(const OpContext& ctx,
   }
 }
 
+void SgDNNLSelfAttQKOp::MaskedSoftmaxQuantize(const NDArray& mask, const NDArray& output) {
+  const mxnet::TShape& att_shape  = output.shape();
+  const mxnet::TShape& mask_shape = mask.shape();
+  const index_t rows              = att_shape[0] * att_shape[1] * att_shape[2];
+  const index_t row_len           = att_shape[3];
+  // strides of the mask over the attention scores, 0 along the broadcast dimensions
+  index_t mask_strides[4];
+  index_t stride = 1;
+  for (int i = 3; i >= 0; --i) {
+    mask_strides[i] = mask_shape[i] == 1 ? 0 : stride;
+    stride *= mask_shape[i];
+  }
+
+  const float* scores  = static_cast<float*>(cached_scores_mem_->get_data_handle());
+  const bool* mask_ptr = mask.data().dptr<bool>();
+  uint8_t* out         = output.data().dptr<uint8_t>();
+  const float scale    = GetQuantizeScale(mshadow::kUint8, min_output_, max_output_);
+
+#pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
+  for (index_t r = 0; r < rows; ++r) {
+    const index_t q      = r % att_shape[2];
+    const index_t h      = (r / att_shape[2]) % att_shape[1];
+    const index_t b      = r / (att_shape[2] * att_shape[1]);
+    const bool* row_mask =
+        mask_ptr + b * mask_strides[0] + h * mask_strides[1] + q * mask_strides[2];
+    const float* row_in  = scores + r * row_len;
+    uint8_t* row_out     = out + r * row_len;
+
+    float max_score = -FLT_MAX;
+    for (index_t k = 0; k < row_len; ++k) {
+      if (row_mask[k * mask_strides[3]] && row_in[k] > max_score) {
+        max_score = row_in[k];
+      }
+    }
+    float sum = 0.0f;
+    for (index_t k = 0; k < row_len; ++k) {
+      if (row_mask[k * mask_strides[3]]) {
+        sum += expf(row_in[k] - max_score);
+      }
+    }
+    // masked scores, or a fully masked row, are 0
+    const float row_scale = sum > 0.0f ? scale / sum : 0.0f;
+    for (index_t k = 0; k < row_len; ++k) {
+      const float val =
+          row_mask[k * mask_strides[3]] ? expf(row_in[k] - max_score) * row_scale : 0.0f;
+      row_out[k] = static_cast<uint8_t>(std::min(rintf(val), 255.0f));
+    }
+  }
+}
+
 template <bool with_split>
 nnvm::ObjectPtr SgDNNLSelfAttQKQuantizedOp(const NodeAttrs& attrs) {
   nnvm::ObjectPtr node = nnvm::Node::Create();
@@ -430,7 +574,7 @@ MXNET_OPERATOR_REGISTER_SELFATT_QK(_sg_onednn_selfatt_qk)
     .set_num_inputs([](const NodeAttrs& attrs) {
       auto const& param = nnvm::get<DNNLSelfAttParam>(attrs.parsed);
       if (param.quantized) {
-        return 6;
+        return 6 + param.with_masked_softmax;
       } else {
         return 2;
       }
@@ -447,6 +591,9 @@ MXNET_OPERATOR_REGISTER_SELFATT_QK(_sg_onednn_selfatt_qk)
                                          input_names.emplace_back("min_k");
                                          input_names.emplace_back("max_k");
                                        }
+                                       if (param.with_masked_softmax) {
+                                         input_names.emplace_back("mask");
+                                       }
                                        return input_names;
                                      })
     .set_attr<mxnet::FInferShape>("FInferShape", SgDNNLSelfAttShape<false>)
@@ -462,7 +609,7 @@ MXNET_OPERATOR_REGISTER_SELFATT_QK(_sg_onednn_selfatt_qk_split)
     .set_num_inputs([](const NodeAttrs& attrs) {
       auto const& param = nnvm::get<DNNLSelfAttParam>(attrs.parsed);
       if (param.quantized) {
-        return 3;
+        return 3 + param.with_masked_softmax;
       } else {
         return 1;
       }
@@ -476,6 +623,9 @@ MXNET_OPERATOR_REGISTER_SELFATT_QK(_sg_onednn_selfatt_qk_split)
                                          input_names.emplace_back("min_qkv");
                                          input_names.emplace_back("max_qkv");
                                        }
+                                       if (param.with_masked_softmax) {
+                                         input_names.emplace_back("mask");
+                                       }
                                        return input_names;
                                      })
     .set_attr<mxnet::FInferShape>("FInferShape", SgDNNLSelfAttShape<true>)
@@ -514,7 +664,7 @@ static bool SgDNNLSelfAttValShape(const NodeAttrs& attrs,
         *out_shape,
         0,
         mxnet::TShape(
-            {att_shape[0], att_shape[2], att_shape[1] * qkv_shape[2] / params.heads / QKV_NUM}));
+            {att_shape[0], att_shape[2], att_shape[1] * GetHeadDim(params, qkv_shape[2])}));
     if (!params.enabled_float_output.has_value()) {
       SHAPE_ASSIGN_CHECK(*out_shape, 1, mxnet::TShape({1}));  // min output
       SHAPE_ASSIGN_CHECK(*out_shape, 2, mxnet::TShape({1}));  // max output
@@ -532,7 +682,7 @@ static bool SgDNNLSelfAttValShape(const NodeAttrs& attrs,
         *out_shape,
         0,
         mxnet::TShape(
-            {att_shape[0], att_shape[2], att_shape[1] * qkv_shape[2] / params.heads / QKV_NUM}));
+            {att_shape[0], att_shape[2], att_shape[1] * GetHeadDim(params, qkv_shape[2])}));
     return true;
   }
 
@@ -563,12 +713,19 @@ static bool SgDNNLSelfAttValInferType(const nnvm::NodeAttrs& attrs,
       TYPE_ASSIGN_CHECK(*in_types, i, mshadow::kFloat32);
     }
 
+    if (params.with_masked_softmax) {
+      TYPE_ASSIGN_CHECK(*in_types, in_types->size() - 1, mshadow::kBool);
+    }
+
     if (params.enabled_float_output.has_value()) {
       CHECK_EQ(out_types->size(), 1U);
       TYPE_ASSIGN_CHECK(*out_types, 0, params.enabled_float_output.value());
     } else {
       CHECK_EQ(out_types->size(), 3U);
-      if (params.min_calib_range.has_value() && params.max_calib_range.has_value()) {
+      if (params.with_masked_softmax) {
+        // probabilities are not negative
+        TYPE_ASSIGN_CHECK(*out_types, 0, mshadow::kUint8);
+      } else if (params.min_calib_range.has_value() && params.max_calib_range.has_value()) {
         TYPE_ASSIGN_CHECK(*out_types, 0, mshadow::kInt8);
       } else {
         TYPE_ASSIGN_CHECK(*out_types, 0, mshadow::kInt32);
@@ -643,6 +800,11 @@ class DNNLSelfAttValAttOp {
   }
 
  private:
+  /*! \brief scale of the output from the ranges of the quantized inputs */
+  float GetOutputScale(const OpContext& ctx, const std::vector<NDArray>& inputs, int out_dtype);
+  /*! \brief masked softmax of the float scores, quantized to uint8 into the output */
+  void MaskedSoftmaxQuantize(const NDArray& mask, const NDArray& output);
+
   bool initialized_{false};
   DNNLSelfAttParam param_;
   dnnl_args_map_t args_;
@@ -654,6 +816,7 @@ class DNNLSelfAttValAttOp {
   std::shared_ptr<dnnl::memory> cached_result_mem_;
   std::shared_ptr<dnnl::memory> cached_tmp_mem_;
   std::shared_ptr<dnnl::memory> cached_transposed_mem_;  // op output
+  std::shared_ptr<dnnl::memory> cached_oscale_mem_;     // runtime output scale, dynamic_quantize
   float min_qkv_;
   float max_qkv_;
   float min_att_;
@@ -685,6 +848,40 @@ static void DNNLSelfAttValAttForward(const OpStatePtr& state_pointer,
   op.Forward(ctx, inputs, req, outputs, already_prepared);
 }
 
+float DNNLSelfAttValAttOp::GetOutputScale(const OpContext& ctx,
+                                          const std::vector<NDArray>& inputs,
+                                          int out_dtype) {
+  min_att_ = inputs[2].data().dptr<float>()[0];
+  max_att_ = inputs[3].data().dptr<float>()[0];
+  min_qkv_ = inputs[4].data().dptr<float>()[0];
+  max_qkv_ = inputs[5].data().dptr<float>()[0];
+
+  att_scale_ = GetQuantizeScale(mshadow::kUint8, min_att_, max_att_);
+  qkv_scale_ = GetQuantizeScale(mshadow::kInt8, min_qkv_, max_qkv_);
+
+  float oscale = 1.0f;
+  if (param_.with_masked_softmax) {
+    // the matmul writes the float scores, divided by the temperature of the softmax
+    min_output_ = param_.min_calib_range.value();
+    max_output_ = param_.max_calib_range.value();
+    oscale      = 1.0f / (att_scale_ * qkv_scale_);
+    if (param_.temperature.has_value()) {
+      oscale /= param_.temperature.value();
+    }
+  } else if (param_.min_calib_range.has_value() && param_.max_calib_range.has_value()) {
+    min_output_ = param_.min_calib_range.value();
+    max_output_ = param_.max_calib_range.value();
+    oscale = GetQuantizeScale(out_dtype, min_output_, max_output_) / (att_scale_ * qkv_scale_);
+  } else if (param_.enabled_float_output.has_value()) {
+    oscale = 1.0f / (att_scale_ * qkv_scale_);
+  } else {
+    mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
+    mxnet_op::Kernel<QuantizationRangeForS8S8MultiplicationStruct, cpu>::Launch(
+        s, 1, &min_output_, &max_output_, &min_att_, &max_att_, &min_qkv_, &max_qkv_);
+  }
+  return oscale;
+}
+
 void DNNLSelfAttValAttOp::Initialize(const OpContext& ctx,
                                      const std::vector<NDArray>& inputs,
                                      const std::vector<OpReqType>& req,
@@ -699,27 +896,29 @@ void DNNLSelfAttValAttOp::Initialize(const OpContext& ctx,
   const auto attn_dtype = get_dnnl_type(attn_tensor.dtype());
 
   const memory::dim heads          = param_.heads;
+  const memory::dim kv_heads       = GetKVHeads(param_);
+  const memory::dim group_size     = heads / kv_heads;
   const memory::dim sequences      = qkv_tensor.shape()[0];
   const memory::dim qkv_seq_len    = qkv_tensor.shape()[1];
   const memory::dim output_lin_dim = qkv_tensor.shape()[2];
-  const memory::dim embed_dim      = output_lin_dim / QKV_NUM;
-  const memory::dim head_dim       = embed_dim / heads;
+  const memory::dim head_dim       = GetHeadDim(param_, output_lin_dim);
   const memory::dim batch_stride   = output_lin_dim * qkv_seq_len;
 
   const auto engine = CpuEngine::Get()->get_engine();
 
-  memory::dims attn_dims  = {sequences, heads, qkv_seq_len, qkv_seq_len};
-  memory::dims value_dims = {sequences, heads, qkv_seq_len, head_dim};
-  memory::dims out_dims   = {sequences, heads, qkv_seq_len, head_dim};
+  // the heads of the attention maps are grouped by the value head they share, which is broadcast
+  memory::dims attn_dims  = {sequences, kv_heads, group_size, qkv_seq_len, qkv_seq_len};
+  memory::dims value_dims = {sequences, kv_heads, 1, qkv_seq_len, head_dim};
+  memory::dims out_dims   = {sequences, kv_heads, group_size, qkv_seq_len, head_dim};
 
   // needed to make transpose on 2nd and 3rd axis with oneDNN
   memory::dims transpose_dims = {sequences, heads, qkv_seq_len, head_dim, 1};
 
-  memory::dims value_strides = {batch_stride, head_dim, output_lin_dim, 1};
+  memory::dims value_strides = {batch_stride, head_dim, head_dim, output_lin_dim, 1};
 
   // for attention tensor just use normal data layout,
   // for value tensor we need to use strides as input tensor consists of queries, keys and values
-  const auto attn_md  = memory::desc(attn_dims, attn_dtype, memory::format_tag::abcd);
+  const auto attn_md  = memory::desc(attn_dims, attn_dtype, memory::format_tag::abcde);
   const auto value_md = memory::desc(value_dims, qkv_dtype, value_strides);
 
   // result = attn * value
@@ -729,35 +928,16 @@ void DNNLSelfAttValAttOp::Initialize(const OpContext& ctx,
 
   float oscale = 1.0f;
   if (param_.quantized) {
-    min_att_ = inputs[2].data().dptr<float>()[0];
-    max_att_ = inputs[3].data().dptr<float>()[0];
-    min_qkv_ = inputs[4].data().dptr<float>()[0];
-    max_qkv_ = inputs[5].data().dptr<float>()[0];
-
-    att_scale_ = GetQuantizeScale(mshadow::kUint8, min_att_, max_att_);
-    qkv_scale_ = GetQuantizeScale(mshadow::kInt8, min_qkv_, max_qkv_);
-
-    if (param_.min_calib_range.has_value() && param_.max_calib_range.has_value()) {
-      min_output_ = param_.min_calib_range.value();
-      max_output_ = param_.max_calib_range.value();
-      oscale      = GetQuantizeScale(out_tensor.dtype(), min_output_, max_output_) /
-               (att_scale_ * qkv_scale_);
-    } else if (param_.enabled_float_output.has_value()) {
-      oscale = 1.0f / (att_scale_ * qkv_scale_);
-    } else {
-      mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
-      mxnet_op::Kernel<QuantizationRangeForS8S8MultiplicationStruct, cpu>::Launch(
-          s, 1, &min_output_, &max_output_, &min_att_, &max_att_, &min_qkv_, &max_qkv_);
-    }
+    oscale = GetOutputScale(ctx, inputs, out_tensor.dtype());
   }
   memory::data_type result_dnnl_dtype = get_dnnl_type(out_tensor.dtype());
 
-  result_md    = memory::desc(out_dims, result_dnnl_dtype, memory::format_tag::abcd);
+  result_md    = memory::desc(out_dims, result_dnnl_dtype, memory::format_tag::abcde);
   tmp_md       = memory::desc(transpose_dims, result_dnnl_dtype, memory::format_tag::abcde);
   transpose_md = memory::desc(transpose_dims, result_dnnl_dtype, memory::format_tag::acbde);
 
-  // multiply by 2 as we need to skip query and key
-  const size_t value_offset = inputs[1].shape()[2] / QKV_NUM * 2;
+  // skip the heads of the queries and keys
+  const size_t value_offset = (heads + kv_heads) * head_dim;
   auto att_buffer           = inputs[0];
   if (att_buffer.IsDNNLData())
     att_buffer = att_buffer.Reorder2Default();
@@ -781,7 +961,16 @@ void DNNLSelfAttValAttOp::Initialize(const OpContext& ctx,
   });
 
   dnnl::primitive_attr attr;
-  attr.set_output_scales(0, {oscale});
+  if (param_.quantized && param_.dynamic_quantize) {
+    // the ranges of the inputs change with every batch, set the scale at runtime
+    attr.set_output_scales(0, {DNNL_RUNTIME_F32_VAL});
+    cached_oscale_mem_ = std::make_shared<memory>(
+        memory::desc({1}, memory::data_type::f32, memory::format_tag::a), engine);
+    *static_cast<float*>(cached_oscale_mem_->get_data_handle()) = oscale;
+    args_[DNNL_ARG_ATTR_OUTPUT_SCALES]                           = *cached_oscale_mem_;
+  } else {
+    attr.set_output_scales(0, {oscale});
+  }
   auto matmul_d           = matmul::desc(attn_md, value_md, result_md);
   auto matmul_pd          = matmul::primitive_desc(matmul_d, attr, engine);
   fwd_                    = std::make_shared<matmul>(matmul_pd);
@@ -803,8 +992,9 @@ void DNNLSelfAttValAttOp::Forward(const OpContext& ctx,
                                   const std::vector<NDArray>& outputs,
                                   bool already_prepared) {
   if (!already_prepared) {
-    // multiply by 2 as we need to skip queries and keys
-    const size_t value_offset = inputs[1].shape()[2] / QKV_NUM * 2;
+    // skip the heads of the queries and keys
+    const size_t value_offset =
+        (param_.heads + GetKVHeads(param_)) * GetHeadDim(param_, inputs[1].shape()[2]);
 
     auto att_buffer = inputs[0];
     if (att_buffer.IsDNNLData())
@@ -824,6 +1014,11 @@ void DNNLSelfAttValAttOp::Forward(const OpContext& ctx,
     MSHADOW_TYPE_SWITCH(outputs[0].dtype(), DType, {
       cached_transposed_mem_->set_data_handle(outputs[0].data().dptr<DType>());
     });
+
+    if (param_.quantized && param_.dynamic_quantize) {
+      *static_cast<float*>(cached_oscale_mem_->get_data_handle()) =
+          GetOutputScale(ctx, inputs, outputs[0].dtype());
+    }
   }
   DNNLStream::Get()->RegisterPrimArgs(*fwd_, args_);
   DNNLStream::Get()->RegisterPrimArgs(*reorder_, reorder_args);
@@ -844,7 +1039,7 @@ NNVM_REGISTER_OP(_sg_onednn_selfatt_valatt)
     .set_num_inputs([](const NodeAttrs& attrs) {
       auto const& param = nnvm::get<DNNLSelfAttParam>(attrs.parsed);
       if (param.quantized) {
-        return 6;
+        return 6 + param.with_masked_softmax;
       } else {
         return 2;
       }
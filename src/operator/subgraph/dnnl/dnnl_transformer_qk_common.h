@@ -52,6 +52,8 @@ enum SelectStatusTransformerQK {
 // OR
 // kStart ---> kFirstSwapAx ---> kSecondSwapAx ---> kFirstReshape ---> kSuccess
 // each status except kStart is connected with kFail
+// in grouped-query attention the keys are repeated to the heads of the queries by a np.repeat
+// between their reshape and SwapAxis, matched on the way without changing the status
 // */
 
 inline bool CheckSwapAxisConditionsQK(const BiDirectedNode& input_node) {
@@ -66,18 +68,70 @@ inline bool CheckReshapeConditionsQK(const BiDirectedNode& input_node, const ind
   return CheckReshapeConditions(*input_node.node, out_index);
 }
 
-inline bool CheckSplitConditions(const std::vector<const BiDirectedNode*>& matched_list,
-                                 const BiDirectedNode& node) {
-  const SplitParam& param = dmlc::get<SplitParam>(node.node->attrs.parsed);
+inline bool CheckRepeatsConditionsQK(const std::vector<const BiDirectedNode*>& matched_list,
+                                     const BiDirectedNode& n,
+                                     const BiDirectedNode& input_node) {
+  if (input_node.outputs.size() != 1 || GetHeadRepeats(*input_node.node) == 0)
+    return false;
+  // only the keys, the second input of batch_dot, are repeated to the heads of the queries
+  const nnvm::Node* batch_dot = matched_list[0]->node;
+  return batch_dot->inputs[1].node.get() == n.node &&
+         input_node.node->inputs[0].node->op() == Op::Get("_npx_reshape");
+}
 
-  if (param.axis != -1 || param.sections != 3 || param.squeeze_axis)
+/*!
+ * \brief heads of the queries and of the keys from their reshapes, the heads of the keys being
+ *  repeated to those of the queries in grouped-query attention
+ */
+inline bool GetQKHeads(const std::vector<const nnvm::Node*>& nodes, int* heads, int* kv_heads) {
+  std::vector<const nnvm::Node*> reshapes;
+  const nnvm::Node* repeats = nullptr;
+  for (const nnvm::Node* node : nodes) {
+    if (node->op() == Op::Get("_npx_reshape")) {
+      reshapes.push_back(node);
+    } else if (GetHeadRepeats(*node) > 0) {
+      repeats = node;
+    }
+  }
+  if (reshapes.size() != 2)
     return false;
+  auto reshape_heads = [](const nnvm::Node* node) {
+    return static_cast<int>(nnvm::get<NumpyXReshapeParam>(node->attrs.parsed).newshape[2]);
+  };
+  if (repeats == nullptr) {
+    *heads = *kv_heads = reshape_heads(reshapes[0]);
+    return *heads > 0 && reshape_heads(reshapes[1]) == *heads;
+  }
+  const nnvm::Node* key_reshape = repeats->inputs[0].node.get();
+  if (key_reshape != reshapes[0] && key_reshape != reshapes[1])
+    return false;
+  *heads    = reshape_heads(reshapes[0] == key_reshape ? reshapes[1] : reshapes[0]);
+  *kv_heads = reshape_heads(key_reshape);
+  return *kv_heads > 0 && *heads == *kv_heads * GetHeadRepeats(*repeats);
+}
+
+inline std::vector<const nnvm::Node*> MatchedNodes(
+    const std::vector<const BiDirectedNode*>& matched_list) {
+  std::vector<const nnvm::Node*> nodes;
+  for (auto bi_node : matched_list) {
+    nodes.push_back(bi_node->node);
+  }
+  return nodes;
+}
 
-  const auto first_reshape  = (*(matched_list.end() - 2))->node;
-  const auto second_reshape = (*(matched_list.end() - 1))->node;
-  if (first_reshape->op() != Op::Get("_npx_reshape") ||
-      second_reshape->op() != Op::Get("_npx_reshape")) {
+inline bool CheckSplitConditions(const std::vector<const BiDirectedNode*>& matched_list,
+                                 const BiDirectedNode& node) {
+  int heads, kv_heads;
+  if (!GetQKHeads(MatchedNodes(matched_list), &heads, &kv_heads) ||
+      !CheckQKVSplitConditions(*node.node, heads / kv_heads))
     return false;
+
+  nnvm::Node* first_reshape  = nullptr;
+  nnvm::Node* second_reshape = nullptr;
+  for (auto bi_node : matched_list) {
+    if (bi_node->node->op() == Op::Get("_npx_reshape")) {
+      (first_reshape ? second_reshape : first_reshape) = bi_node->node;
+    }
   }
   // 3 sections - ensure that every output is used only once
   if (node.outputs.size() == 3 && node.outputs.count(first_reshape) &&
@@ -129,6 +183,10 @@ bool SelectInput(SelectStatusTransformerQK* status,
       }
       break;
     case kSecondSwapAx:
+      if (CheckRepeatsConditionsQK(*matched_list, n, input_node)) {
+        matched_list->push_back(&input_node);
+        return true;
+      }
       if (raw_input_node.op() == Op::Get("_npx_reshape")) {
         // input to reshape must be first or second output from split
         if (CheckReshapeConditionsQK(input_node, 0) || CheckReshapeConditionsQK(input_node, 1)) {
@@ -139,14 +197,23 @@ bool SelectInput(SelectStatusTransformerQK* status,
       }
       break;
     case kFirstReshape:
+      if (CheckRepeatsConditionsQK(*matched_list, n, input_node)) {
+        matched_list->push_back(&input_node);
+        return true;
+      }
       if (raw_input_node.op() == Op::Get("_npx_reshape")) {
         if (CheckReshapeConditionsQK(input_node, 0) || CheckReshapeConditionsQK(input_node, 1)) {
+          matched_list->push_back(&input_node);
           if constexpr (with_split) {
             *status = kSecondReshape;
           } else {
+            int heads, kv_heads;
+            if (!GetQKHeads(MatchedNodes(*matched_list), &heads, &kv_heads)) {
+              matched_list->pop_back();
+              return false;
+            }
             *status = kSuccess;
           }
-          matched_list->push_back(&input_node);
           return true;
         }
       }
@@ -197,13 +264,15 @@ nnvm::ObjectPtr CreateSubgraphNode(const nnvm::Symbol& sym, const int subgraph_i
   new_sym.outputs.emplace_back(last_node);
   std::ostringstream node_name;
 
-  DFSVisit(new_sym.outputs, [&](const nnvm::ObjectPtr& node) {
-    if ((node->op() == Op::Get("_npx_reshape"))) {
-      auto const& reshape_param = nnvm::get<NumpyXReshapeParam>(node->attrs.parsed);
-      // set heads attribute - all necessary conditions are checked before
-      n->attrs.dict["heads"] = std::to_string(reshape_param.newshape[2]);
-    }
-  });
+  std::vector<const nnvm::Node*> nodes;
+  DFSVisit(new_sym.outputs, [&](const nnvm::ObjectPtr& node) { nodes.push_back(node.get()); });
+  // set heads attributes - all necessary conditions are checked before
+  int heads, kv_heads;
+  CHECK(GetQKHeads(nodes, &heads, &kv_heads));
+  n->attrs.dict["heads"] = std::to_string(heads);
+  if (kv_heads != heads) {
+    n->attrs.dict["kv_heads"] = std::to_string(kv_heads);
+  }
 
   node_name << op_name << subgraph_id;
   n->attrs.name = node_name.str();
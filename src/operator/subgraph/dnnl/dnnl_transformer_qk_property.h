@@ -55,6 +55,9 @@ OR
    |            |                 |
    |______________________________|
 
+In grouped-query attention the keys are repeated to the heads of the queries by a np.repeat
+between their _npx_reshape and SwapAxis, which the fused operator broadcasts instead.
+
 */
 namespace mxnet {
 namespace op {
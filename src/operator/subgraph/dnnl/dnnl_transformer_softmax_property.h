@@ -0,0 +1,263 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file dnnl_transformer_softmax_property.h
+ * \brief Fuses the masked_softmax of the attention scores of a quantized self-attention qk
+ *        node, and the quantization of the probabilities, so that they are computed from the
+ *        float scores of the matmul and passed on in uint8 to the valatt node.
+ */
+#ifndef MXNET_OPERATOR_SUBGRAPH_DNNL_DNNL_TRANSFORMER_SOFTMAX_PROPERTY_H_
+#define MXNET_OPERATOR_SUBGRAPH_DNNL_DNNL_TRANSFORMER_SOFTMAX_PROPERTY_H_
+
+#if MXNET_USE_ONEDNN == 1
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "operator/nn/softmax-inl.h"
+#include "operator/quantization/quantization_utils.h"
+#include "operator/quantization/quantize_v2-inl.h"
+#include "operator/subgraph/common.h"
+#include "dnnl_subgraph_base-inl.h"
+#include "dnnl_transformer-inl.h"
+
+/*
+      quantized selfatt_qk         mask
+     (enabled_float_output)         |
+    ____________|___________________|___
+   |            |                   |   |
+   |          masked_softmax -------'   |
+   |            |                       |
+   |      _contrib_quantize_v2 (uint8)  |
+   |____________|_______________________|
+                |
+         quantized selfatt_valatt
+*/
+namespace mxnet {
+namespace op {
+
+class SgDNNLTransformerSoftmaxSelector : public SubgraphSelectorV2 {
+ private:
+  /*! \brief pattern match status */
+  enum class SelectStatus {
+    kFail = 0,
+    kStart,
+    kSoftmax,
+    kSuccess,
+  };
+
+  SelectStatus status_;
+  std::vector<const BiDirectedNode*> matched_list_;
+
+ public:
+  bool Select(const BiDirectedNode& seed_node,
+              const std::shared_ptr<NodeAttr>& node_attr) override {
+    const nnvm::Node* n = seed_node.node;
+    if (n->op() != Op::Get("_sg_onednn_selfatt_qk") &&
+        n->op() != Op::Get("_sg_onednn_selfatt_qk_split")) {
+      return false;
+    }
+    auto const& param = nnvm::get<DNNLSelfAttParam>(n->attrs.parsed);
+    // the fp32 scores of the post-quantize dequantize fusion, with a calibrated scale
+    if (!param.quantized || param.dynamic_quantize || param.with_masked_softmax ||
+        !param.enabled_float_output.has_value() ||
+        param.enabled_float_output.value() != mshadow::kFloat32) {
+      return false;
+    }
+    status_ = SelectStatus::kStart;
+    matched_list_.clear();
+    matched_list_.push_back(&seed_node);
+    return true;
+  }
+
+  bool SelectInput(const BiDirectedNode& n, const BiDirectedNode& input_node) override {
+    return false;
+  }
+
+  bool SelectOutput(const BiDirectedNode& n, const BiDirectedNode& output_node) override {
+    const nnvm::Node* raw_node     = n.node;
+    const nnvm::Node* raw_out_node = output_node.node;
+    if (status_ == SelectStatus::kFail || status_ == SelectStatus::kSuccess ||
+        raw_out_node->is_variable() || matched_list_.back() != &n) {
+      return false;
+    }
+    // the fused node only gives the quantized probabilities
+    if (n.outputs.size() != 1) {
+      status_ = SelectStatus::kFail;
+      return false;
+    }
+
+    switch (status_) {
+      case SelectStatus::kStart:
+        if (raw_out_node->op() == Op::Get("masked_softmax") &&
+            raw_out_node->inputs[0].node.get() == raw_node) {
+          auto const& param = nnvm::get<MaskedSoftmaxParam>(raw_out_node->attrs.parsed);
+          if (param.axis == -1 || param.axis == 3) {
+            matched_list_.push_back(&output_node);
+            status_ = SelectStatus::kSoftmax;
+            return true;
+          }
+        }
+        break;
+      case SelectStatus::kSoftmax:
+        if (raw_out_node->op() == Op::Get("_contrib_quantize_v2")) {
+          auto const& param = nnvm::get<QuantizeV2Param>(raw_out_node->attrs.parsed);
+          if (param.min_calib_range.has_value() && param.max_calib_range.has_value() &&
+              GetQuantizeOutputType(param) == mshadow::kUint8) {
+            matched_list_.push_back(&output_node);
+            status_ = SelectStatus::kSuccess;
+            return true;
+          }
+        }
+        break;
+      default:
+        break;
+    }
+    status_ = SelectStatus::kFail;
+    return false;
+  }
+
+  std::vector<BiDirectedNode*> Filter(const std::vector<BiDirectedNode*>& candidates) override {
+    if (status_ != SelectStatus::kSuccess) {
+      return std::vector<BiDirectedNode*>(0);
+    }
+    std::vector<BiDirectedNode*> ret;
+    for (auto i : matched_list_) {
+      auto non_const_i = const_cast<BiDirectedNode*>(i);
+      if (std::find(candidates.begin(), candidates.end(), non_const_i) != candidates.end()) {
+        ret.push_back(non_const_i);
+      }
+    }
+    return ret;
+  }
+
+  void Reset() override {
+    CHECK_GE(matched_list_.size(), 1);
+    auto new_selector = SgDNNLTransformerSoftmaxSelector();
+    new_selector.Select(*matched_list_[0], nullptr);
+    *this = new_selector;
+  }
+};
+
+class SgDNNLTransformerSoftmaxProperty : public SubgraphProperty {
+ public:
+  SgDNNLTransformerSoftmaxProperty() {}
+
+  static SubgraphPropertyPtr Create() {
+    static const std::string& name = "oneDNN Transformer softmax optimization pass";
+    auto property                  = std::make_shared<SgDNNLTransformerSoftmaxProperty>();
+    property->SetAttr<std::string>("property_name", name);
+    property->SetAttr<bool>("inference_only", true);
+    if (dmlc::GetEnv("MXNET_DISABLE_ONEDNN_TRANSFORMER_OPT", 0) ||
+        dmlc::GetEnv("MXNET_DISABLE_ONEDNN_FUSE_TRANSFORMER_SOFTMAX", 0)) {
+      property->SetAttr<bool>("disable", true);
+    }
+    return property;
+  }
+
+  nnvm::ObjectPtr CreateSubgraphNode(const nnvm::Symbol& sym,
+                                     const int subgraph_id = 0) const override {
+    nnvm::ObjectPtr qk_node       = nullptr;
+    nnvm::ObjectPtr softmax_node  = nullptr;
+    nnvm::ObjectPtr quantize_node = nullptr;
+
+    DFSVisit(sym.outputs, [&](const nnvm::ObjectPtr& node) {
+      if (node->is_variable())
+        return;
+      if (node->op() == Op::Get("masked_softmax")) {
+        softmax_node = node;
+      } else if (node->op() == Op::Get("_contrib_quantize_v2")) {
+        quantize_node = node;
+      } else {
+        qk_node = node;
+      }
+    });
+
+    CHECK_NOTNULL(qk_node);
+    CHECK_NOTNULL(softmax_node);
+    CHECK_NOTNULL(quantize_node);
+    auto const& softmax_param  = nnvm::get<MaskedSoftmaxParam>(softmax_node->attrs.parsed);
+    auto const& quantize_param = nnvm::get<QuantizeV2Param>(quantize_node->attrs.parsed);
+
+    qk_node->attrs.dict.erase("enabled_float_output");
+    qk_node->attrs.dict["with_masked_softmax"] = "True";
+    if (softmax_param.temperature.has_value()) {
+      qk_node->attrs.dict["temperature"] = std::to_string(softmax_param.temperature.value());
+    }
+    qk_node->attrs.dict["min_calib_range"] =
+        std::to_string(quantize_param.min_calib_range.value());
+    qk_node->attrs.dict["max_calib_range"] =
+        std::to_string(quantize_param.max_calib_range.value());
+    qk_node->op()->attr_parser(&(qk_node->attrs));
+    return qk_node;
+  }
+
+  SubgraphSelectorV2Ptr CreateSubgraphSelectorV2() const override {
+    auto selector = std::make_shared<SgDNNLTransformerSoftmaxSelector>();
+    return selector;
+  }
+
+  void ConnectSubgraphOutputs(const nnvm::ObjectPtr n,
+                              std::vector<nnvm::NodeEntry*>* output_entries) const override {
+    // outputs of the quantize node: data, min and max
+    for (size_t i = 0; i < output_entries->size(); ++i) {
+      auto entry_ptr = output_entries->at(i);
+      *entry_ptr     = nnvm::NodeEntry{n, entry_ptr->index, 0};
+    }
+  }
+
+  void ConnectSubgraphInputs(const nnvm::ObjectPtr subgraph_node,
+                             std::vector<nnvm::NodeEntry*>* input_entries,
+                             std::vector<nnvm::NodeEntry>* orig_input_entries) const override {
+    // Entries are in topological order, the mask may come first. Keep the inputs of the qk
+    // node in their order and append the mask of the softmax.
+    std::vector<nnvm::NodeEntry*> qk_entries;
+    std::vector<nnvm::NodeEntry> qk_orig_entries;
+    std::vector<bool> used(input_entries->size(), false);
+    for (auto& e : subgraph_node->inputs) {
+      for (size_t i = 0; i < input_entries->size(); ++i) {
+        if (input_entries->at(i) == &e) {
+          qk_entries.push_back(input_entries->at(i));
+          qk_orig_entries.push_back(orig_input_entries->at(i));
+          used[i] = true;
+          break;
+        }
+      }
+    }
+    for (size_t i = 0; i < input_entries->size(); ++i) {
+      if (!used[i]) {
+        qk_entries.push_back(input_entries->at(i));
+        qk_orig_entries.push_back(orig_input_entries->at(i));
+      }
+    }
+    CHECK_EQ(qk_entries.size(), subgraph_node->inputs.size() + 1);
+    *input_entries        = qk_entries;
+    *orig_input_entries   = qk_orig_entries;
+    subgraph_node->inputs = *orig_input_entries;
+  }
+};
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // if MXNET_USE_ONEDNN == 1
+#endif  // MXNET_OPERATOR_SUBGRAPH_DNNL_DNNL_TRANSFORMER_SOFTMAX_PROPERTY_H_
@@ -68,12 +68,8 @@ bool CheckSwapAxisConditions(const BiDirectedNode& bi_node) {
   return CheckSwapAxisConditions(*rawnode);
 }
 
-bool CheckSplitConditions(const BiDirectedNode& bi_node) {
-  const nnvm::Node* rawnode = bi_node.node;
-  auto const& split_params  = nnvm::get<SplitParam>(rawnode->attrs.parsed);
-
-  if (split_params.axis != -1 || split_params.sections != 3 || split_params.indices.ndim() != 0 ||
-      split_params.squeeze_axis != 0) {
+bool CheckSplitConditions(const BiDirectedNode& bi_node, const int group_size) {
+  if (!CheckQKVSplitConditions(*bi_node.node, group_size)) {
     return false;
   }
 
@@ -83,6 +79,12 @@ bool CheckSplitConditions(const BiDirectedNode& bi_node) {
   return true;
 }
 
+bool CheckRepeatsConditions(const BiDirectedNode& bi_node) {
+  const nnvm::Node* rawnode = bi_node.node;
+  return bi_node.outputs.size() == 1 && GetHeadRepeats(*rawnode) > 0 &&
+         rawnode->inputs[0].node->op() == Op::Get("_npx_reshape");
+}
+
 class SgDNNLTransformerValAttSelector : public SubgraphSelectorV2 {
   enum InStatus { kFail = 0, kStart, kSecondStart, kIgnoreSecond, kSwapAx, kReshape, kSuccess };
   /*                 (custom_op)
@@ -93,6 +95,8 @@ class SgDNNLTransformerValAttSelector : public SubgraphSelectorV2 {
             state to drop second input)
 
   Each status except kStart is connected with kFail
+  In grouped-query attention the np.repeat of the value heads between _npx_reshape and
+  SwapAxis is matched in kSwapAx without changing the status
 */
 
   enum OutStatus { oFail = 0, oStart, oTranspose, oReshape, oSuccess };
@@ -100,6 +104,7 @@ class SgDNNLTransformerValAttSelector : public SubgraphSelectorV2 {
  private:
   InStatus in_status_;
   OutStatus out_status_;
+  int group_size_{1};  // query heads sharing each value head
   std::vector<const BiDirectedNode*> matched_list_;
 
  public:
@@ -108,6 +113,7 @@ class SgDNNLTransformerValAttSelector : public SubgraphSelectorV2 {
     if (seed_node.node->op() == Op::Get("batch_dot")) {
       in_status_  = InStatus::kStart;
       out_status_ = OutStatus::oStart;
+      group_size_ = 1;
       matched_list_.clear();
       matched_list_.push_back(&seed_node);
       return true;
@@ -143,6 +149,11 @@ class SgDNNLTransformerValAttSelector : public SubgraphSelectorV2 {
         }
         break;
       case InStatus::kSwapAx:
+        if (group_size_ == 1 && CheckRepeatsConditions(input_node)) {
+          group_size_ = GetHeadRepeats(*input_node.node);
+          matched_list_.push_back(&input_node);
+          return true;
+        }
         if (input_node.node->op() == Op::Get("_npx_reshape")) {
           if (CheckReshapeConditions(input_node)) {
             in_status_ = InStatus::kReshape;
@@ -155,7 +166,7 @@ class SgDNNLTransformerValAttSelector : public SubgraphSelectorV2 {
         break;
       case InStatus::kReshape:
         if (input_node.node->op() == Op::Get("_split_v2")) {
-          if (CheckSplitConditions(input_node)) {
+          if (CheckSplitConditions(input_node, group_size_)) {
             in_status_ = InStatus::kSuccess;
             matched_list_.push_back(&input_node);
             return true;
@@ -257,14 +268,22 @@ class SgDNNLTransformerValAttProperty : public SubgraphProperty {
     new_sym.outputs.emplace_back(last_node);
     std::ostringstream node_name;
     std::string op_name;
+    int64_t group_size = 1;
+    int64_t kv_heads   = 0;
     DFSVisit(new_sym.outputs, [&](const nnvm::ObjectPtr& node) {
       if ((node->op() == Op::Get("_npx_reshape"))) {
         auto const& reshape_param = nnvm::get<NumpyXReshapeParam>(node->attrs.parsed);
         if (reshape_param.newshape.ndim() == 4)
           // set heads attribute - all necessary conditions are checked before
-          n->attrs.dict["heads"] = std::to_string(reshape_param.newshape[2]);
+          kv_heads = reshape_param.newshape[2];
+      } else if (GetHeadRepeats(*node) > 0) {
+        group_size = GetHeadRepeats(*node);
       }
     });
+    n->attrs.dict["heads"] = std::to_string(kv_heads * group_size);
+    if (group_size > 1) {
+      n->attrs.dict["kv_heads"] = std::to_string(kv_heads);
+    }
     node_name << "_sg_onednn_selfatt_valatt_" << subgraph_id;
     n->attrs.name = node_name.str();
     n->attrs.op   = Op::Get("_sg_onednn_selfatt_valatt");
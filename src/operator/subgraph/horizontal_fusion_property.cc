@@ -0,0 +1,266 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file horizontal_fusion_property.cc
+ * \brief Subgraph property merging independent FullyConnected and Convolution nodes
+ *  that read the same input into one wider node followed by a split.
+ */
+
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "./common.h"
+#include "./subgraph_property.h"
+#include "../nn/convolution-inl.h"
+#include "../nn/fully_connected-inl.h"
+#include "../../imperative/cached_op.h"
+
+namespace mxnet {
+namespace op {
+
+namespace {
+
+/*!
+ * \brief Key under which a node can be merged with its siblings, empty if it cannot be merged.
+ *  Siblings with the same key read the same data entry and differ at most in their number
+ *  of output channels, so their weights (and biases) can be concatenated along axis 0.
+ */
+std::string HorizontalFusionKey(const nnvm::Node& node) {
+  static const Op* fc_op   = Op::Get("FullyConnected");
+  static const Op* conv_op = Op::Get("Convolution");
+  if (node.is_variable() || node.inputs.empty())
+    return std::string();
+  // weights computed inside the graph could depend on a sibling
+  for (size_t i = 1; i < node.inputs.size(); ++i) {
+    if (!node.inputs[i].node->is_variable())
+      return std::string();
+  }
+  std::ostringstream key;
+  key << node.inputs[0].node.get() << ':' << node.inputs[0].index << ':';
+  if (node.op() == fc_op) {
+    const auto& param = nnvm::get<FullyConnectedParam>(node.attrs.parsed);
+    key << "fc:" << param.no_bias << ':' << param.flatten;
+    return key.str();
+  }
+  if (node.op() == conv_op) {
+    ConvolutionParam param = nnvm::get<ConvolutionParam>(node.attrs.parsed);
+    // grouped weights and channel-last outputs cannot be split along axis 1
+    if (param.num_group != 1 ||
+        (param.layout.has_value() && param.layout.value() != mshadow::kNCW &&
+         param.layout.value() != mshadow::kNCHW && param.layout.value() != mshadow::kNCDHW))
+      return std::string();
+    param.num_filter = 0;
+    std::unordered_map<std::string, std::string> dict;
+    param.SetAttrDict(&dict);
+    key << "conv";
+    for (const auto& kv : std::map<std::string, std::string>(dict.begin(), dict.end()))
+      key << ':' << kv.first << '=' << kv.second;
+    return key.str();
+  }
+  return std::string();
+}
+
+/*! \brief number of output channels of a node accepted by HorizontalFusionKey */
+int HorizontalFusionChannels(const nnvm::Node& node) {
+  if (node.op() == Op::Get("FullyConnected"))
+    return nnvm::get<FullyConnectedParam>(node.attrs.parsed).num_hidden;
+  return nnvm::get<ConvolutionParam>(node.attrs.parsed).num_filter;
+}
+
+/*! \brief axis of the outputs of a node accepted by HorizontalFusionKey holding the channels */
+std::string HorizontalFusionSplitAxis(const nnvm::Node& node) {
+  // FullyConnected without flatten keeps the leading axes of the data
+  if (node.op() == Op::Get("FullyConnected") &&
+      !nnvm::get<FullyConnectedParam>(node.attrs.parsed).flatten)
+    return "-1";
+  return "1";
+}
+
+nnvm::ObjectPtr CreateFusionNode(const std::string& op_name,
+                                 const std::string& name,
+                                 const std::unordered_map<std::string, std::string>& dict,
+                                 std::vector<nnvm::NodeEntry>&& inputs) {
+  nnvm::ObjectPtr n = nnvm::Node::Create();
+  n->attrs.op       = Op::Get(op_name);
+  n->attrs.name     = name;
+  n->attrs.dict     = dict;
+  n->inputs         = std::move(inputs);
+  n->op()->attr_parser(&(n->attrs));
+  return n;
+}
+
+}  // namespace
+
+/*!
+ * This selects an operator node together with the FullyConnected or Convolution nodes
+ * reading one of its outputs that can be merged, see HorizontalFusionKey.
+ * Only the seed and its mergeable consumers are part of the subgraph.
+ */
+class HorizontalFusionSelector : public SubgraphSelectorV2 {
+ public:
+  bool Select(const BiDirectedNode& sn) override {
+    fused_.clear();
+    if (sn.node->is_variable())
+      return false;
+    std::unordered_map<std::string, std::vector<const nnvm::Node*>> groups;
+    for (const auto& kv : sn.outputs) {
+      const nnvm::Node* consumer = kv.first;
+      if (consumer->inputs.empty() || consumer->inputs[0].node.get() != sn.node)
+        continue;
+      const std::string key = HorizontalFusionKey(*consumer);
+      if (!key.empty())
+        groups[key].push_back(consumer);
+    }
+    for (const auto& kv : groups) {
+      if (kv.second.size() >= 2)
+        fused_.insert(kv.second.begin(), kv.second.end());
+    }
+    return !fused_.empty();
+  }
+
+  bool SelectInput(const BiDirectedNode& sn, const BiDirectedNode& snew_node) override {
+    return false;
+  }
+
+  bool SelectOutput(const BiDirectedNode& sn, const BiDirectedNode& snew_node) override {
+    return fused_.count(snew_node.node) != 0;
+  }
+
+  std::vector<BiDirectedNode*> Filter(const std::vector<BiDirectedNode*>& candidates) override {
+    // cycle breaking may have left fewer than two siblings
+    return candidates.size() >= 3 ? candidates : std::vector<BiDirectedNode*>();
+  }
+
+  void Reset() override {
+    fused_.clear();
+  }
+
+ private:
+  std::unordered_set<const nnvm::Node*> fused_;
+};
+
+/*!
+ * This subgraph property merges independent FullyConnected or Convolution nodes with
+ * compatible parameters that share their data input, as the per-branch projections of
+ * multi-head or multi-tower models. The branches are executed as one node over the
+ * concatenated weights, whose output is split back per branch, so that one larger kernel
+ * is launched instead of many small ones. The subgraph is executed by _CachedOp.
+ */
+class HorizontalFusionProperty : public SubgraphProperty {
+ public:
+  static SubgraphPropertyPtr Create() {
+    return std::make_shared<HorizontalFusionProperty>();
+  }
+
+  SubgraphSelectorV2Ptr CreateSubgraphSelectorV2() const override {
+    return std::make_shared<HorizontalFusionSelector>();
+  }
+
+  nnvm::ObjectPtr CreateSubgraphNode(const nnvm::Symbol& sym,
+                                     const SubgraphSelectorV2Ptr& subgraph_selector,
+                                     const int subgraph_id = 0) const override {
+    // group the merged nodes again, in topological order of the subgraph
+    std::map<std::string, std::vector<nnvm::ObjectPtr>> groups;
+    std::vector<std::string> group_order;
+    nnvm::DFSVisit(sym.outputs, [&](const nnvm::ObjectPtr& node) {
+      if (node->is_variable() || node->inputs.empty() || node->inputs[0].node->is_variable())
+        return;
+      const std::string key = HorizontalFusionKey(*node);
+      if (key.empty())
+        return;
+      auto& group = groups[key];
+      if (group.empty())
+        group_order.push_back(key);
+      group.push_back(node);
+    });
+
+    std::unordered_map<const nnvm::Node*, nnvm::NodeEntry> replaced;
+    for (const auto& key : group_order) {
+      const auto& group = groups[key];
+      if (group.size() < 2)
+        continue;
+      const nnvm::Node& first    = *group[0];
+      const std::string name     = first.attrs.name + "_hfused";
+      const bool has_bias        = first.inputs.size() > 2;
+      const bool is_fc           = first.op() == Op::Get("FullyConnected");
+      const std::string num_args = std::to_string(group.size());
+      std::vector<nnvm::NodeEntry> weights, biases;
+      int channels = 0;
+      for (const auto& n : group) {
+        weights.push_back(n->inputs[1]);
+        if (has_bias)
+          biases.push_back(n->inputs[2]);
+        channels += HorizontalFusionChannels(*n);
+      }
+      std::vector<nnvm::NodeEntry> inputs{first.inputs[0]};
+      inputs.emplace_back(CreateFusionNode(
+          "Concat", name + "_weight", {{"num_args", num_args}, {"dim", "0"}}, std::move(weights)));
+      if (has_bias) {
+        inputs.emplace_back(CreateFusionNode(
+            "Concat", name + "_bias", {{"num_args", num_args}, {"dim", "0"}}, std::move(biases)));
+      }
+      auto dict                                 = first.attrs.dict;
+      dict[is_fc ? "num_hidden" : "num_filter"] = std::to_string(channels);
+
+      nnvm::ObjectPtr fused  = CreateFusionNode(first.op()->name, name, dict, std::move(inputs));
+      const std::string axis = HorizontalFusionSplitAxis(first);
+      int begin              = 0;
+      for (const auto& n : group) {
+        const int end = begin + HorizontalFusionChannels(*n);
+        nnvm::ObjectPtr slice =
+            CreateFusionNode("slice_axis",
+                             n->attrs.name,
+                             {{"axis", axis},
+                              {"begin", std::to_string(begin)},
+                              {"end", std::to_string(end)}},
+                             {nnvm::NodeEntry{fused, 0, 0}});
+        replaced.emplace(n.get(), nnvm::NodeEntry{slice, 0, 0});
+        begin = end;
+      }
+    }
+
+    nnvm::Symbol fused_sym;
+    for (const auto& e : sym.outputs) {
+      auto it = replaced.find(e.node.get());
+      fused_sym.outputs.push_back(it != replaced.end() ? it->second : e);
+    }
+    nnvm::ObjectPtr n = nnvm::Node::Create();
+    n->attrs.op       = Op::Get("_CachedOp");
+    n->attrs.name     = "_horizontal_fusion_CachedOp" + std::to_string(subgraph_id);
+    n->attrs.subgraphs.push_back(std::make_shared<nnvm::Symbol>(fused_sym));
+
+    std::vector<std::pair<std::string, std::string>> flags{{"static_alloc", "true"}};
+    n->attrs.parsed = std::make_shared<CachedOp>(fused_sym, flags);
+    return n;
+  }
+};
+
+MXNET_REGISTER_SUBGRAPH_BACKEND(horizontal_fusion);
+
+MXNET_REGISTER_SUBGRAPH_PROPERTY(horizontal_fusion, HorizontalFusionProperty);
+
+}  // namespace op
+}  // namespace mxnet
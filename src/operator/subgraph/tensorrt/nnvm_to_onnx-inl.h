@@ -58,6 +58,7 @@ std::unordered_map<std::string, uint32_t> GetOutputLookup(const nnvm::IndexedGra
 void ConvertPlaceholder(const std::string& node_name,
                         const std::unordered_map<std::string, TShape>& placeholder_shapes,
                         const std::unordered_map<std::string, int>& placeholder_dtypes,
+                        bool dynamic_batch,
                         GraphProto* graph_proto);
 
 void ConvertConstant(GraphProto* graph_proto,
@@ -69,7 +70,8 @@ void ConvertOutput(GraphProto* graph_proto,
                    const std::string& node_name,
                    const ShapeVector& shapes,
                    const DTypeVector& dtypes,
-                   const nnvm::IndexedGraph& ig);
+                   const nnvm::IndexedGraph& ig,
+                   bool dynamic_batch);
 
 void DefaultConnectInputsOutputs(const array_view<IndexedGraph::NodeEntry>& inputs,
                                  const nnvm::IndexedGraph& ig,
@@ -62,6 +62,8 @@ std::string ConvertNnvmGraphToOnnx(const nnvm::Graph& g,
   const auto& shapes           = g.GetAttr<ShapeVector>("shape");
   const auto& dtype_inputs     = g.GetAttr<DTypeVector>("dtype_inputs");
   const auto& shape_inputs     = g.GetAttr<ShapeVector>("shape_inputs");
+  // the first axis of the inputs and the outputs is left to the optimization profile
+  const bool dynamic_batch = g.attrs.count("dynamic_batch") && g.GetAttr<bool>("dynamic_batch");
 
   ModelProto model_proto;
 
@@ -119,7 +121,8 @@ std::string ConvertNnvmGraphToOnnx(const nnvm::Graph& g,
           current_input++;
           continue;
         }
-        ConvertPlaceholder(node_name, placeholder_shapes, placeholder_dtypes, graph_proto);
+        ConvertPlaceholder(
+            node_name, placeholder_shapes, placeholder_dtypes, dynamic_batch, graph_proto);
       } else {
         // If it's not a placeholder, then by exclusion it's a constant.
         ConvertConstant(graph_proto, node_name, params_map);
@@ -138,7 +141,7 @@ std::string ConvertNnvmGraphToOnnx(const nnvm::Graph& g,
       auto out_iter = output_lookup.find(node_name);
       // We found an output
       if (out_iter != output_lookup.end()) {
-        ConvertOutput(graph_proto, out_iter, node_name, shapes, dtypes, ig);
+        ConvertOutput(graph_proto, out_iter, node_name, shapes, dtypes, ig, dynamic_batch);
       }  // output found
     }    // conversion function exists
   }      // loop over i from 0 to num_nodes
@@ -742,6 +745,7 @@ std::unordered_map<std::string, uint32_t> GetOutputLookup(const nnvm::IndexedGra
 void ConvertPlaceholder(const std::string& node_name,
                         const std::unordered_map<std::string, TShape>& placeholder_shapes,
                         const std::unordered_map<std::string, int>& placeholder_dtypes,
+                        bool dynamic_batch,
                         GraphProto* const graph_proto) {
   auto val_info_proto = graph_proto->add_input();
   auto type_proto     = val_info_proto->mutable_type()->mutable_tensor_type();
@@ -751,9 +755,13 @@ void ConvertPlaceholder(const std::string& node_name,
   auto entry_shape = placeholder_shapes.find(node_name)->second;
   auto entry_dtype = placeholder_dtypes.find(node_name)->second;
   type_proto->set_elem_type(ConvertDType(entry_dtype));
-  for (const auto& elem : entry_shape) {
+  for (int i = 0; i < entry_shape.ndim(); ++i) {
     TensorShapeProto_Dimension* const tsp_dim = shape_proto->add_dim();
-    tsp_dim->set_dim_value(static_cast<int64>(elem));
+    if (dynamic_batch && i == 0) {
+      tsp_dim->set_dim_param("batch");
+    } else {
+      tsp_dim->set_dim_value(static_cast<int64>(entry_shape[i]));
+    }
   }
 }
 
@@ -812,7 +820,8 @@ void ConvertOutput(GraphProto* const graph_proto,
                    const std::string& node_name,
                    const ShapeVector& shapes,
                    const DTypeVector& dtypes,
-                   const nnvm::IndexedGraph& ig) {
+                   const nnvm::IndexedGraph& ig,
+                   bool dynamic_batch) {
   uint32_t out_idx        = ig.entry_id(ig.outputs()[out_iter->second]);
   int dtype               = dtypes[out_idx];
   auto graph_out          = graph_proto->add_output();
@@ -823,9 +832,14 @@ void ConvertOutput(GraphProto* const graph_proto,
   // Also support fp16.
   tensor_type->set_elem_type(ConvertDType(dtype));
 
-  for (int64_t dim_shp : shapes[out_idx]) {
+  const TShape& shape = shapes[out_idx];
+  for (int i = 0; i < shape.ndim(); ++i) {
     TensorShapeProto_Dimension* const tsp_dim = tensor_shape_proto->add_dim();
-    tsp_dim->set_dim_value(static_cast<int64>(dim_shp));
+    if (dynamic_batch && i == 0) {
+      tsp_dim->set_dim_param("batch");
+    } else {
+      tsp_dim->set_dim_value(static_cast<int64>(shape[i]));
+    }
   }
 }
 
@@ -0,0 +1,1041 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file nnvm_to_tensorrt.cc
+ * \brief Conversion from NNVM to a TensorRT network without ONNX
+ */
+
+#if MXNET_USE_TENSORRT
+
+#include "./nnvm_to_tensorrt.h"
+
+#include <mxnet/base.h>
+#include <nnvm/graph.h>
+#include <nnvm/pass_functions.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <sstream>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "../../../common/cuda/utils.h"
+#include "../../../common/utils.h"
+#include "../../../imperative/exec_pass.h"
+#include "../../pad-inl.h"
+#include "../../leaky_relu-inl.h"
+#include "../../nn/activation-inl.h"
+#include "../../nn/batch_norm-inl.h"
+#include "../../nn/concat-inl.h"
+#include "../../nn/convolution-inl.h"
+#include "../../nn/deconvolution-inl.h"
+#include "../../nn/fully_connected-inl.h"
+#include "../../nn/pooling-inl.h"
+#include "../../nn/softmax-inl.h"
+#include "../../tensor/elemwise_binary_scalar_op.h"
+#include "../../tensor/matrix_op-inl.h"
+
+namespace mxnet {
+namespace op {
+namespace nnvm_to_tensorrt {
+
+namespace {
+
+using ::onnx_to_tensorrt::InferObject;
+
+const std::unordered_map<std::string, nvinfer1::ElementWiseOperation> kElementWiseOps = {
+    {"elemwise_add", nvinfer1::ElementWiseOperation::kSUM},
+    {"elemwise_sub", nvinfer1::ElementWiseOperation::kSUB},
+    {"elemwise_mul", nvinfer1::ElementWiseOperation::kPROD},
+    {"elemwise_div", nvinfer1::ElementWiseOperation::kDIV},
+    {"broadcast_add", nvinfer1::ElementWiseOperation::kSUM},
+    {"broadcast_sub", nvinfer1::ElementWiseOperation::kSUB},
+    {"broadcast_mul", nvinfer1::ElementWiseOperation::kPROD},
+    {"broadcast_div", nvinfer1::ElementWiseOperation::kDIV},
+    {"broadcast_maximum", nvinfer1::ElementWiseOperation::kMAX},
+    {"broadcast_minimum", nvinfer1::ElementWiseOperation::kMIN},
+};
+
+// the operations with a scalar, and whether the scalar is their first operand
+const std::unordered_map<std::string, std::pair<nvinfer1::ElementWiseOperation, bool>>
+    kScalarOps = {
+        {"_plus_scalar", {nvinfer1::ElementWiseOperation::kSUM, false}},
+        {"_minus_scalar", {nvinfer1::ElementWiseOperation::kSUB, false}},
+        {"_rminus_scalar", {nvinfer1::ElementWiseOperation::kSUB, true}},
+        {"_mul_scalar", {nvinfer1::ElementWiseOperation::kPROD, false}},
+        {"_div_scalar", {nvinfer1::ElementWiseOperation::kDIV, false}},
+        {"_rdiv_scalar", {nvinfer1::ElementWiseOperation::kDIV, true}},
+        {"_maximum_scalar", {nvinfer1::ElementWiseOperation::kMAX, false}},
+        {"_minimum_scalar", {nvinfer1::ElementWiseOperation::kMIN, false}},
+};
+
+const std::unordered_map<std::string, nvinfer1::UnaryOperation> kUnaryOps = {
+    {"exp", nvinfer1::UnaryOperation::kEXP},
+    {"log", nvinfer1::UnaryOperation::kLOG},
+    {"sqrt", nvinfer1::UnaryOperation::kSQRT},
+    {"abs", nvinfer1::UnaryOperation::kABS},
+    {"negative", nvinfer1::UnaryOperation::kNEG},
+    {"reciprocal", nvinfer1::UnaryOperation::kRECIP},
+};
+
+const std::unordered_map<int, nvinfer1::ActivationType> kActivations = {
+    {activation::kReLU, nvinfer1::ActivationType::kRELU},
+    {activation::kSigmoid, nvinfer1::ActivationType::kSIGMOID},
+    {activation::kTanh, nvinfer1::ActivationType::kTANH},
+    {activation::kSoftReLU, nvinfer1::ActivationType::kSOFTPLUS},
+    {activation::kSoftSign, nvinfer1::ActivationType::kSOFTSIGN},
+};
+
+const std::unordered_set<std::string> kIdentityOps = {"_copy", "Dropout", "identity"};
+
+bool IsNCHW(const dmlc::optional<int>& layout) {
+  return !layout.has_value() || layout.value() == mshadow::kNCHW ||
+         layout.value() == mshadow::kNCDHW;
+}
+
+nvinfer1::Dims ToDims(const mxnet::TShape& shape) {
+  nvinfer1::Dims dims;
+  dims.nbDims = shape.ndim();
+  for (int i = 0; i < shape.ndim(); ++i) {
+    dims.d[i] = shape[i];
+  }
+  return dims;
+}
+
+uint64_t Fnv1a(const void* data, size_t size, uint64_t hash = 14695981039346656037ULL) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+template <typename T>
+void Write(std::string* buffer, const T& value) {
+  buffer->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void Write(std::string* buffer, const std::string& value) {
+  Write(buffer, static_cast<uint64_t>(value.size()));
+  buffer->append(value);
+}
+
+template <typename T>
+T Read(const char** data) {
+  T value;
+  std::memcpy(&value, *data, sizeof(T));
+  *data += sizeof(T);
+  return value;
+}
+
+std::string ReadString(const char** data) {
+  const uint64_t size = Read<uint64_t>(data);
+  std::string value(*data, size);
+  *data += size;
+  return value;
+}
+
+#if NV_TENSORRT_MAJOR >= 8
+
+constexpr const char* kPluginName    = "MXNetOpPlugin";
+constexpr const char* kPluginVersion = "1";
+
+/*!
+ * \brief Runs an MXNet operator with a GPU kernel inside of an engine, in float32. The running
+ *  _TensorRT node gives the stream and the temporary space of the kernel through PluginContext.
+ */
+class MXNetOpPlugin : public nvinfer1::IPluginV2DynamicExt {
+ public:
+  MXNetOpPlugin(const nnvm::NodeAttrs& attrs,
+                uint32_t num_inputs,
+                const mxnet::ShapeVector& out_shapes,
+                bool dynamic_batch)
+      : num_inputs_(num_inputs), out_shapes_(out_shapes), dynamic_batch_(dynamic_batch) {
+    Init(attrs.op->name, attrs.dict);
+  }
+
+  MXNetOpPlugin(const void* data, size_t length) {
+    const char* p             = static_cast<const char*>(data);
+    const std::string op_name = ReadString(&p);
+    std::unordered_map<std::string, std::string> dict;
+    for (uint64_t n = Read<uint64_t>(&p); n > 0; --n) {
+      std::string key = ReadString(&p);
+      dict[key]       = ReadString(&p);
+    }
+    num_inputs_ = Read<uint32_t>(&p);
+    out_shapes_.resize(Read<uint32_t>(&p));
+    for (auto& shape : out_shapes_) {
+      shape = mxnet::TShape(Read<int32_t>(&p), -1);
+      for (int i = 0; i < shape.ndim(); ++i)
+        shape[i] = Read<int64_t>(&p);
+    }
+    dynamic_batch_ = Read<bool>(&p);
+    CHECK(p == static_cast<const char*>(data) + length) << "Corrupted " << kPluginName;
+    Init(op_name, dict);
+  }
+
+  nvinfer1::IPluginV2DynamicExt* clone() const noexcept override {
+    auto* plugin = new MXNetOpPlugin(attrs_, num_inputs_, out_shapes_, dynamic_batch_);
+    plugin->setPluginNamespace(namespace_.c_str());
+    return plugin;
+  }
+
+  nvinfer1::DimsExprs getOutputDimensions(int32_t index,
+                                          const nvinfer1::DimsExprs* inputs,
+                                          int32_t num_inputs,
+                                          nvinfer1::IExprBuilder& builder) noexcept override {
+    const mxnet::TShape& shape = out_shapes_[index];
+    nvinfer1::DimsExprs dims;
+    dims.nbDims = shape.ndim();
+    for (int i = 0; i < shape.ndim(); ++i) {
+      dims.d[i] = builder.constant(shape[i]);
+    }
+    // the outputs have the batch of the first input
+    if (dynamic_batch_ && shape.ndim() > 0) {
+      dims.d[0] = inputs[0].d[0];
+    }
+    return dims;
+  }
+
+  bool supportsFormatCombination(int32_t pos,
+                                 const nvinfer1::PluginTensorDesc* in_out,
+                                 int32_t num_inputs,
+                                 int32_t num_outputs) noexcept override {
+    return in_out[pos].type == nvinfer1::DataType::kFLOAT &&
+           in_out[pos].format == nvinfer1::TensorFormat::kLINEAR;
+  }
+
+  void configurePlugin(const nvinfer1::DynamicPluginTensorDesc* in,
+                       int32_t num_inputs,
+                       const nvinfer1::DynamicPluginTensorDesc* out,
+                       int32_t num_outputs) noexcept override {}
+
+  size_t getWorkspaceSize(const nvinfer1::PluginTensorDesc* inputs,
+                          int32_t num_inputs,
+                          const nvinfer1::PluginTensorDesc* outputs,
+                          int32_t num_outputs) const noexcept override {
+    return 0;
+  }
+
+  int32_t enqueue(const nvinfer1::PluginTensorDesc* input_desc,
+                  const nvinfer1::PluginTensorDesc* output_desc,
+                  const void* const* inputs,
+                  void* const* outputs,
+                  void* workspace,
+                  cudaStream_t stream) noexcept override {
+    const OpContext* outer = PluginContext::Get();
+    // the builder times the tactics of the layers around the plugin without a running node
+    if (outer == nullptr)
+      return 0;
+    try {
+      int dev_id;
+      CUDA_CALL(cudaGetDevice(&dev_id));
+      OpContext ctx;
+      ctx.need_grad = false;
+      ctx.is_train  = false;
+      ctx.run_ctx   = outer->run_ctx;
+      if (stream != mshadow::Stream<gpu>::GetStream(outer->get_stream<gpu>())) {
+        ctx.run_ctx.stream = WrapStream(stream, dev_id);
+      }
+      ctx.requested.assign(num_requested_, outer->requested[0]);
+      std::vector<TBlob> in_data, out_data;
+      mxnet::ShapeVector in_shapes;
+      for (uint32_t i = 0; i < num_inputs_; ++i) {
+        const nvinfer1::Dims& dims = input_desc[i].dims;
+        in_shapes.emplace_back(dims.d, dims.d + dims.nbDims);
+        in_data.emplace_back(const_cast<void*>(inputs[i]),
+                             in_shapes.back(),
+                             gpu::kDevMask,
+                             mshadow::kFloat32,
+                             dev_id);
+      }
+      for (size_t i = 0; i < out_shapes_.size(); ++i) {
+        const nvinfer1::Dims& dims = output_desc[i].dims;
+        out_data.emplace_back(outputs[i],
+                              mxnet::TShape(dims.d, dims.d + dims.nbDims),
+                              gpu::kDevMask,
+                              mshadow::kFloat32,
+                              dev_id);
+      }
+      const std::vector<OpReqType> req(out_data.size(), kWriteTo);
+      if (fcompute_) {
+        fcompute_(attrs_, ctx, in_data, req, out_data);
+      } else {
+        // the state of a stateful operator depends on the shapes of its inputs
+        if (!state_ || in_shapes != state_shapes_) {
+          state_ = fcreate_(attrs_,
+                            Context::GPU(dev_id),
+                            in_shapes,
+                            std::vector<int>(num_inputs_, mshadow::kFloat32));
+          state_shapes_ = in_shapes;
+        }
+        fstateful_(state_, ctx, in_data, req, out_data);
+      }
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "The TensorRT plugin of " << attrs_.op->name << " failed: " << e.what();
+      return -1;
+    }
+    return 0;
+  }
+
+  nvinfer1::DataType getOutputDataType(int32_t index,
+                                       const nvinfer1::DataType* input_types,
+                                       int32_t num_inputs) const noexcept override {
+    return nvinfer1::DataType::kFLOAT;
+  }
+
+  const char* getPluginType() const noexcept override {
+    return kPluginName;
+  }
+
+  const char* getPluginVersion() const noexcept override {
+    return kPluginVersion;
+  }
+
+  int32_t getNbOutputs() const noexcept override {
+    return out_shapes_.size();
+  }
+
+  int32_t initialize() noexcept override {
+    return 0;
+  }
+
+  void terminate() noexcept override {
+    state_ = OpStatePtr();
+  }
+
+  size_t getSerializationSize() const noexcept override {
+    return Serialize().size();
+  }
+
+  void serialize(void* buffer) const noexcept override {
+    const std::string data = Serialize();
+    std::memcpy(buffer, data.data(), data.size());
+  }
+
+  void destroy() noexcept override {
+    delete this;
+  }
+
+  void setPluginNamespace(const char* plugin_namespace) noexcept override {
+    namespace_ = plugin_namespace;
+  }
+
+  const char* getPluginNamespace() const noexcept override {
+    return namespace_.c_str();
+  }
+
+ private:
+  struct StreamDeleter {
+    void operator()(mshadow::Stream<gpu>* s) const {
+      s->DestroyBlasHandle();
+      delete s;
+    }
+  };
+
+  void Init(const std::string& op_name, const std::unordered_map<std::string, std::string>& dict) {
+    attrs_.op   = nnvm::Op::Get(op_name);
+    attrs_.dict = dict;
+    if (attrs_.op->attr_parser) {
+      attrs_.op->attr_parser(&attrs_);
+    }
+    fcompute_  = nnvm::Op::GetAttr<FCompute>("FCompute<gpu>").get(attrs_.op, nullptr);
+    fcreate_   = nnvm::Op::GetAttr<FCreateOpState>("FCreateOpState").get(attrs_.op, nullptr);
+    fstateful_ =
+        nnvm::Op::GetAttr<FStatefulCompute>("FStatefulCompute<gpu>").get(attrs_.op, nullptr);
+    static auto& fresource = nnvm::Op::GetAttr<FResourceRequest>("FResourceRequest");
+    num_requested_         = fresource.count(attrs_.op) ? fresource[attrs_.op](attrs_).size() : 0;
+  }
+
+  /*! \brief an mshadow stream over a stream of TensorRT, created on its first use */
+  mshadow::Stream<gpu>* WrapStream(cudaStream_t stream, int dev_id) {
+    if (!stream_ || stream_->stream_ != stream) {
+      stream_.reset(new mshadow::Stream<gpu>());
+      stream_->stream_ = stream;
+      stream_->dev_id  = dev_id;
+      stream_->CreateBlasHandle();
+    }
+    return stream_.get();
+  }
+
+  std::string Serialize() const {
+    std::string data;
+    Write(&data, attrs_.op->name);
+    Write(&data, static_cast<uint64_t>(attrs_.dict.size()));
+    for (const auto& kv : attrs_.dict) {
+      Write(&data, kv.first);
+      Write(&data, kv.second);
+    }
+    Write(&data, num_inputs_);
+    Write(&data, static_cast<uint32_t>(out_shapes_.size()));
+    for (const auto& shape : out_shapes_) {
+      Write(&data, static_cast<int32_t>(shape.ndim()));
+      for (int i = 0; i < shape.ndim(); ++i)
+        Write(&data, static_cast<int64_t>(shape[i]));
+    }
+    Write(&data, dynamic_batch_);
+    return data;
+  }
+
+  nnvm::NodeAttrs attrs_;
+  uint32_t num_inputs_;
+  // the shapes of the outputs at build time, their batch following the first input if dynamic
+  mxnet::ShapeVector out_shapes_;
+  bool dynamic_batch_;
+  std::string namespace_;
+  FCompute fcompute_;
+  FCreateOpState fcreate_;
+  FStatefulCompute fstateful_;
+  size_t num_requested_;
+  OpStatePtr state_;
+  mxnet::ShapeVector state_shapes_;
+  std::unique_ptr<mshadow::Stream<gpu>, StreamDeleter> stream_;
+};
+
+class MXNetOpPluginCreator : public nvinfer1::IPluginCreator {
+ public:
+  const char* getPluginName() const noexcept override {
+    return kPluginName;
+  }
+
+  const char* getPluginVersion() const noexcept override {
+    return kPluginVersion;
+  }
+
+  const nvinfer1::PluginFieldCollection* getFieldNames() noexcept override {
+    return &fields_;
+  }
+
+  // the plugins are created by the converter, only their deserialization goes through here
+  nvinfer1::IPluginV2* createPlugin(const char* name,
+                                    const nvinfer1::PluginFieldCollection* fields) noexcept
+      override {
+    return nullptr;
+  }
+
+  nvinfer1::IPluginV2* deserializePlugin(const char* name,
+                                         const void* data,
+                                         size_t length) noexcept override {
+    try {
+      auto* plugin = new MXNetOpPlugin(data, length);
+      plugin->setPluginNamespace(namespace_.c_str());
+      return plugin;
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Could not deserialize the TensorRT plugin " << name << ": " << e.what();
+      return nullptr;
+    }
+  }
+
+  void setPluginNamespace(const char* plugin_namespace) noexcept override {
+    namespace_ = plugin_namespace;
+  }
+
+  const char* getPluginNamespace() const noexcept override {
+    return namespace_.c_str();
+  }
+
+ private:
+  nvinfer1::PluginFieldCollection fields_{0, nullptr};
+  std::string namespace_;
+};
+
+REGISTER_TENSORRT_PLUGIN(MXNetOpPluginCreator);
+
+#endif  // NV_TENSORRT_MAJOR >= 8
+
+/*! \brief Adds the layers of the nodes of a graph to a network, in topological order */
+class NetworkConverter {
+ public:
+  NetworkConverter(const nnvm::Graph& graph,
+                   const std::unordered_map<std::string, NDArray>& params_map,
+                   bool dynamic_batch,
+                   nvinfer1::INetworkDefinition* network)
+      : params_map_(params_map), dynamic_batch_(dynamic_batch), network_(network) {
+    graph_.outputs = graph.outputs;
+    auto shape_inputs = graph.GetAttr<mxnet::ShapeVector>("shape_inputs");
+    auto dtype_inputs = graph.GetAttr<nnvm::DTypeVector>("dtype_inputs");
+    graph_            = exec::InferShape(std::move(graph_), std::move(shape_inputs));
+    graph_            = exec::InferType(std::move(graph_), std::move(dtype_inputs));
+    CHECK_EQ(graph_.GetAttr<size_t>("shape_num_unknown_nodes"), 0U)
+        << "The shapes of the TensorRT subgraph are unknown";
+  }
+
+  void Convert() {
+    const auto& idx    = graph_.indexed_graph();
+    const auto& shapes = graph_.GetAttr<mxnet::ShapeVector>("shape");
+    const auto& dtypes = graph_.GetAttr<nnvm::DTypeVector>("dtype");
+    tensors_.assign(idx.num_node_entries(), nullptr);
+    for (uint32_t nid = 0; nid < idx.num_nodes(); ++nid) {
+      const nnvm::Node& node = *idx[nid].source;
+      if (!node.is_variable()) {
+        ConvertNode(node);
+        continue;
+      }
+      const uint32_t eid = idx.entry_id(nid, 0);
+      // the parameters become constants when used as tensors
+      if (params_map_.count(node.attrs.name))
+        continue;
+      CHECK(dtypes[eid] == mshadow::kFloat32 || dtypes[eid] == mshadow::kFloat16)
+          << "TensorRT input " << node.attrs.name << " must be float32 or float16";
+      nvinfer1::Dims dims = ToDims(shapes[eid]);
+      if (dynamic_batch_ && dims.nbDims > 0) {
+        dims.d[0] = -1;
+      }
+      tensors_[eid] = network_->addInput(
+          node.attrs.name.c_str(),
+          dtypes[eid] == mshadow::kFloat32 ? nvinfer1::DataType::kFLOAT : nvinfer1::DataType::kHALF,
+          dims);
+    }
+    for (const auto& e : graph_.outputs) {
+      nvinfer1::ITensor* tensor = Tensor(e);
+      // an output needs its own tensor when it is an input or another output
+      if (tensor->isNetworkInput() || tensor->isNetworkOutput()) {
+        tensor = network_->addIdentity(*tensor)->getOutput(0);
+      }
+      tensor->setName(e.node->attrs.name.c_str());
+      network_->markOutput(*tensor);
+    }
+  }
+
+ private:
+  const mxnet::TShape& Shape(const nnvm::NodeEntry& e) const {
+    const auto& idx = graph_.indexed_graph();
+    return graph_.GetAttr<mxnet::ShapeVector>("shape")[idx.entry_id(e)];
+  }
+
+  const mxnet::TShape& OutShape(const nnvm::Node& node, uint32_t index) const {
+    const auto& idx = graph_.indexed_graph();
+    return graph_.GetAttr<mxnet::ShapeVector>("shape")[idx.entry_id(idx.node_id(&node), index)];
+  }
+
+  /*! \brief the values of a parameter in float32, kept alive until the engine is built */
+  const std::vector<float>& Param(const nnvm::NodeEntry& e) {
+    auto it = params_map_.find(e.node->attrs.name);
+    CHECK(e.node->is_variable() && it != params_map_.end())
+        << "TensorRT needs " << e.node->attrs.name << " to be a parameter";
+    CHECK_EQ(it->second.dtype(), mshadow::kFloat32)
+        << "TensorRT parameter " << e.node->attrs.name << " must be float32";
+    const float* data = it->second.data().dptr<float>();
+    weights_.emplace_back(data, data + it->second.shape().Size());
+    return weights_.back();
+  }
+
+  nvinfer1::Weights EmptyWeights() const {
+    return nvinfer1::Weights{nvinfer1::DataType::kFLOAT, nullptr, 0};
+  }
+
+  nvinfer1::Weights Weights(const std::vector<float>& values) {
+    return nvinfer1::Weights{
+        nvinfer1::DataType::kFLOAT, values.data(), static_cast<int64_t>(values.size())};
+  }
+
+  nvinfer1::Weights Weights(const nnvm::NodeEntry& e) {
+    return Weights(Param(e));
+  }
+
+  nvinfer1::ITensor* Constant(std::vector<float> values, const nvinfer1::Dims& dims) {
+    weights_.push_back(std::move(values));
+    return network_->addConstant(dims, Weights(weights_.back()))->getOutput(0);
+  }
+
+  nvinfer1::ITensor* Tensor(const nnvm::NodeEntry& e) {
+    const uint32_t eid        = graph_.indexed_graph().entry_id(e);
+    nvinfer1::ITensor*& tensor = tensors_[eid];
+    if (tensor == nullptr && e.node->is_variable()) {
+      tensor = Constant(Param(e), ToDims(Shape(e)));
+    }
+    CHECK(tensor) << "Output " << e.index << " of " << e.node->attrs.name
+                  << " has no TensorRT tensor";
+    return tensor;
+  }
+
+  /*! \brief a tensor with leading axes of size 1 up to a rank, for broadcasting */
+  nvinfer1::ITensor* Unsqueeze(nvinfer1::ITensor* tensor, const mxnet::TShape& shape, int ndim) {
+    if (shape.ndim() >= ndim)
+      return tensor;
+    nvinfer1::Dims dims;
+    dims.nbDims = ndim;
+    for (int i = 0; i < ndim; ++i) {
+      dims.d[i] = i < ndim - shape.ndim() ? 1 : shape[i - (ndim - shape.ndim())];
+    }
+    nvinfer1::IShuffleLayer* layer = network_->addShuffle(*tensor);
+    layer->setReshapeDimensions(dims);
+    return layer->getOutput(0);
+  }
+
+  /*! \brief a tensor of rank 2 keeping the first axis, as Flatten */
+  nvinfer1::ITensor* Flatten(nvinfer1::ITensor* tensor) {
+    nvinfer1::Dims dims;
+    dims.nbDims                    = 2;
+    dims.d[0]                      = 0;
+    dims.d[1]                      = -1;
+    nvinfer1::IShuffleLayer* layer = network_->addShuffle(*tensor);
+    layer->setReshapeDimensions(dims);
+    return layer->getOutput(0);
+  }
+
+  nvinfer1::ITensor* ScalarConstant(float value, int ndim) {
+    nvinfer1::Dims dims;
+    dims.nbDims = ndim;
+    for (int i = 0; i < ndim; ++i)
+      dims.d[i] = 1;
+    return Constant({value}, dims);
+  }
+
+  /*! \brief the activation of Activation and of its shorthands */
+  static int ActType(const nnvm::Node& node) {
+    const std::string& op_name = node.op()->name;
+    if (op_name == "relu")
+      return activation::kReLU;
+    if (op_name == "sigmoid")
+      return activation::kSigmoid;
+    if (op_name == "tanh")
+      return activation::kTanh;
+    return nnvm::get<ActivationParam>(node.attrs.parsed).act_type;
+  }
+
+  void ConvertNode(const nnvm::Node& node) {
+    const std::string& op_name = node.op()->name;
+    const auto& attrs          = node.attrs;
+    nvinfer1::ITensor* out     = nullptr;
+    if (IsPluginOp(node)) {
+      ConvertPlugin(node);
+      return;
+    }
+    if (op_name == "Convolution") {
+      const auto& param      = nnvm::get<ConvolutionParam>(attrs.parsed);
+      nvinfer1::Weights bias = param.no_bias ? EmptyWeights() : Weights(node.inputs[conv::kBias]);
+      nvinfer1::IConvolutionLayer* layer =
+          network_->addConvolutionNd(*Tensor(node.inputs[conv::kData]),
+                                     param.num_filter,
+                                     ToDims(param.kernel),
+                                     Weights(node.inputs[conv::kWeight]),
+                                     bias);
+      layer->setStrideNd(ToDims(param.stride));
+      layer->setPaddingNd(ToDims(param.pad));
+      layer->setDilationNd(ToDims(param.dilate));
+      layer->setNbGroups(param.num_group);
+      out = layer->getOutput(0);
+    } else if (op_name == "Deconvolution") {
+      const auto& param = nnvm::get<DeconvolutionParam>(attrs.parsed);
+      nvinfer1::Weights bias =
+          param.no_bias ? EmptyWeights() : Weights(node.inputs[deconv::kBias]);
+      nvinfer1::IDeconvolutionLayer* layer =
+          network_->addDeconvolutionNd(*Tensor(node.inputs[deconv::kData]),
+                                       param.num_filter,
+                                       ToDims(param.kernel),
+                                       Weights(node.inputs[deconv::kWeight]),
+                                       bias);
+      layer->setStrideNd(ToDims(param.stride));
+      layer->setPaddingNd(ToDims(param.pad));
+      layer->setNbGroups(param.num_group);
+      out = layer->getOutput(0);
+    } else if (op_name == "FullyConnected") {
+      const auto& param     = nnvm::get<FullyConnectedParam>(attrs.parsed);
+      nvinfer1::ITensor* in = Tensor(node.inputs[fullc::kData]);
+      int ndim              = Shape(node.inputs[fullc::kData]).ndim();
+      if (param.flatten) {
+        in   = Flatten(in);
+        ndim = 2;
+      }
+      // y = x.W^T + b, with the constants broadcast over the leading axes of x
+      const mxnet::TShape& wshape = Shape(node.inputs[fullc::kWeight]);
+      mxnet::TShape wdims(ndim, 1);
+      wdims[ndim - 2]           = wshape[0];
+      wdims[ndim - 1]           = wshape[1];
+      nvinfer1::ITensor* weight = Constant(Param(node.inputs[fullc::kWeight]), ToDims(wdims));
+      nvinfer1::IMatrixMultiplyLayer* layer = network_->addMatrixMultiply(
+          *in, nvinfer1::MatrixOperation::kNONE, *weight, nvinfer1::MatrixOperation::kTRANSPOSE);
+      out = layer->getOutput(0);
+      if (!param.no_bias) {
+        mxnet::TShape bdims(ndim, 1);
+        bdims[ndim - 1]         = param.num_hidden;
+        nvinfer1::ITensor* bias = Constant(Param(node.inputs[fullc::kBias]), ToDims(bdims));
+        out = network_->addElementWise(*out, *bias, nvinfer1::ElementWiseOperation::kSUM)
+                  ->getOutput(0);
+      }
+    } else if (op_name == "BatchNorm") {
+      // the inference batch norm is the scale of each channel
+      const auto& param               = nnvm::get<BatchNormParam>(attrs.parsed);
+      const std::vector<float>& gamma = Param(node.inputs[batchnorm::kGamma]);
+      const std::vector<float>& beta  = Param(node.inputs[batchnorm::kBeta]);
+      const std::vector<float>& mean  = Param(node.inputs[batchnorm::kInMovingMean]);
+      const std::vector<float>& var   = Param(node.inputs[batchnorm::kInMovingVar]);
+      std::vector<float> scale(mean.size()), shift(mean.size());
+      for (size_t c = 0; c < mean.size(); ++c) {
+        scale[c] = (param.fix_gamma ? 1.0f : gamma[c]) / std::sqrt(var[c] + param.eps);
+        shift[c] = beta[c] - mean[c] * scale[c];
+      }
+      weights_.push_back(std::move(scale));
+      nvinfer1::Weights scale_weights = Weights(weights_.back());
+      weights_.push_back(std::move(shift));
+      nvinfer1::Weights shift_weights = Weights(weights_.back());
+      const int ndim                  = Shape(node.inputs[batchnorm::kData]).ndim();
+      nvinfer1::IScaleLayer* layer =
+          network_->addScaleNd(*Tensor(node.inputs[batchnorm::kData]),
+                               nvinfer1::ScaleMode::kCHANNEL,
+                               shift_weights,
+                               scale_weights,
+                               EmptyWeights(),
+                               param.axis < 0 ? param.axis + ndim : param.axis);
+      out = layer->getOutput(0);
+    } else if (op_name == "Activation" || op_name == "relu" || op_name == "sigmoid" ||
+               op_name == "tanh") {
+      const int act_type = ActType(node);
+      nvinfer1::IActivationLayer* layer =
+          network_->addActivation(*Tensor(node.inputs[0]), kActivations.at(act_type));
+      if (act_type == activation::kSoftReLU) {
+        layer->setAlpha(1.0f);
+        layer->setBeta(1.0f);
+      }
+      out = layer->getOutput(0);
+    } else if (op_name == "LeakyReLU") {
+      const auto& param                 = nnvm::get<LeakyReLUParam>(attrs.parsed);
+      nvinfer1::IActivationLayer* layer = network_->addActivation(
+          *Tensor(node.inputs[leakyrelu::kData]),
+          param.act_type == leakyrelu::kELU ? nvinfer1::ActivationType::kELU :
+                                              nvinfer1::ActivationType::kLEAKY_RELU);
+      layer->setAlpha(param.slope);
+      out = layer->getOutput(0);
+    } else if (op_name == "clip") {
+      const auto& param                 = nnvm::get<ClipParam>(attrs.parsed);
+      nvinfer1::IActivationLayer* layer =
+          network_->addActivation(*Tensor(node.inputs[0]), nvinfer1::ActivationType::kCLIP);
+      layer->setAlpha(param.a_min);
+      layer->setBeta(param.a_max);
+      out = layer->getOutput(0);
+    } else if (op_name == "Pooling") {
+      const auto& param          = nnvm::get<PoolingParam>(attrs.parsed);
+      const mxnet::TShape& shape = Shape(node.inputs[0]);
+      const int spatial          = shape.ndim() - 2;
+      mxnet::TShape kernel = param.kernel, stride = param.stride, pad = param.pad;
+      if (param.global_pool) {
+        kernel = mxnet::TShape(shape.begin() + 2, shape.end());
+        stride = mxnet::TShape(spatial, 1);
+        pad    = mxnet::TShape(spatial, 0);
+      }
+      nvinfer1::IPoolingLayer* layer = network_->addPoolingNd(
+          *Tensor(node.inputs[0]),
+          param.pool_type == pool_enum::kMaxPooling ? nvinfer1::PoolingType::kMAX :
+                                                      nvinfer1::PoolingType::kAVERAGE,
+          ToDims(kernel));
+      layer->setStrideNd(ToDims(stride));
+      layer->setPaddingNd(ToDims(pad));
+      if (!param.global_pool && param.pooling_convention == pool_enum::kFull) {
+        layer->setPaddingMode(nvinfer1::PaddingMode::kEXPLICIT_ROUND_UP);
+      }
+      const bool count_include_pad =
+          !param.count_include_pad.has_value() || param.count_include_pad.value();
+      layer->setAverageCountExcludesPadding(!count_include_pad);
+      out = layer->getOutput(0);
+    } else if (kElementWiseOps.count(op_name)) {
+      const mxnet::TShape& lshape = Shape(node.inputs[0]);
+      const mxnet::TShape& rshape = Shape(node.inputs[1]);
+      const int ndim              = std::max(lshape.ndim(), rshape.ndim());
+      nvinfer1::IElementWiseLayer* layer =
+          network_->addElementWise(*Unsqueeze(Tensor(node.inputs[0]), lshape, ndim),
+                                   *Unsqueeze(Tensor(node.inputs[1]), rshape, ndim),
+                                   kElementWiseOps.at(op_name));
+      out = layer->getOutput(0);
+    } else if (kScalarOps.count(op_name)) {
+      const auto& param       = nnvm::get<NumpyBinaryScalarParam>(attrs.parsed);
+      const auto& op          = kScalarOps.at(op_name);
+      nvinfer1::ITensor* in   = Tensor(node.inputs[0]);
+      nvinfer1::ITensor* cval = ScalarConstant(param.scalar, Shape(node.inputs[0]).ndim());
+      out = (op.second ? network_->addElementWise(*cval, *in, op.first) :
+                         network_->addElementWise(*in, *cval, op.first))
+                ->getOutput(0);
+    } else if (kUnaryOps.count(op_name)) {
+      out = network_->addUnary(*Tensor(node.inputs[0]), kUnaryOps.at(op_name))->getOutput(0);
+    } else if (op_name == "rsqrt") {
+      out = network_->addUnary(*Tensor(node.inputs[0]), nvinfer1::UnaryOperation::kSQRT)
+                ->getOutput(0);
+      out = network_->addUnary(*out, nvinfer1::UnaryOperation::kRECIP)->getOutput(0);
+    } else if (op_name == "Flatten") {
+      out = Flatten(Tensor(node.inputs[0]));
+    } else if (op_name == "Concat") {
+      const auto& param = nnvm::get<ConcatParam>(attrs.parsed);
+      std::vector<nvinfer1::ITensor*> inputs;
+      for (const auto& e : node.inputs) {
+        inputs.push_back(Tensor(e));
+      }
+      nvinfer1::IConcatenationLayer* layer =
+          network_->addConcatenation(inputs.data(), inputs.size());
+      const int ndim = Shape(node.inputs[0]).ndim();
+      const int axis = param.dim.value();
+      layer->setAxis(axis < 0 ? axis + ndim : axis);
+      out = layer->getOutput(0);
+    } else if (op_name == "softmax") {
+      const auto& param     = nnvm::get<SoftmaxParam>(attrs.parsed);
+      nvinfer1::ITensor* in = Tensor(node.inputs[0]);
+      const int ndim        = Shape(node.inputs[0]).ndim();
+      if (param.temperature.has_value() && param.temperature.value() != 1.0) {
+        nvinfer1::ITensor* temperature = ScalarConstant(param.temperature.value(), ndim);
+        in = network_->addElementWise(*in, *temperature, nvinfer1::ElementWiseOperation::kDIV)
+                 ->getOutput(0);
+      }
+      nvinfer1::ISoftMaxLayer* layer = network_->addSoftMax(*in);
+      layer->setAxes(1U << (param.axis < 0 ? param.axis + ndim : param.axis));
+      out = layer->getOutput(0);
+    } else if (op_name == "transpose") {
+      const auto& param = nnvm::get<TransposeParam>(attrs.parsed);
+      const int ndim    = Shape(node.inputs[0]).ndim();
+      nvinfer1::Permutation perm;
+      for (int i = 0; i < ndim; ++i) {
+        perm.order[i] = param.axes.ndim() == 0 ? ndim - 1 - i : param.axes[i];
+      }
+      nvinfer1::IShuffleLayer* layer = network_->addShuffle(*Tensor(node.inputs[0]));
+      layer->setFirstTranspose(perm);
+      out = layer->getOutput(0);
+    } else if (op_name == "Pad") {
+      // the spatial padding of NCHW
+      const auto& param = nnvm::get<PadParam>(attrs.parsed);
+      nvinfer1::Dims pre, post;
+      pre.nbDims = post.nbDims = 2;
+      for (int i = 0; i < 2; ++i) {
+        pre.d[i]  = param.pad_width[4 + 2 * i];
+        post.d[i] = param.pad_width[5 + 2 * i];
+      }
+      out = network_->addPaddingNd(*Tensor(node.inputs[0]), pre, post)->getOutput(0);
+    } else if (kIdentityOps.count(op_name)) {
+      out = network_->addIdentity(*Tensor(node.inputs[0]))->getOutput(0);
+    } else {
+      LOG(FATAL) << "TensorRT can't convert " << op_name << " (node " << attrs.name << ")";
+    }
+    CHECK(out) << "TensorRT could not convert " << attrs.name;
+    out->setName(attrs.name.c_str());
+    tensors_[graph_.indexed_graph().entry_id(graph_.indexed_graph().node_id(&node), 0)] = out;
+  }
+
+  void ConvertPlugin(const nnvm::Node& node) {
+#if NV_TENSORRT_MAJOR >= 8
+    const auto& idx     = graph_.indexed_graph();
+    const uint32_t nid  = idx.node_id(&node);
+    const uint32_t nout = node.num_outputs();
+    std::vector<nvinfer1::ITensor*> inputs;
+    for (const auto& e : node.inputs) {
+      CHECK_EQ(graph_.GetAttr<nnvm::DTypeVector>("dtype")[idx.entry_id(e)], mshadow::kFloat32)
+          << "The TensorRT plugin of " << node.attrs.name << " runs in float32";
+      inputs.push_back(Tensor(e));
+    }
+    mxnet::ShapeVector out_shapes;
+    for (uint32_t i = 0; i < nout; ++i) {
+      out_shapes.push_back(OutShape(node, i));
+    }
+    MXNetOpPlugin plugin(node.attrs, node.inputs.size(), out_shapes, dynamic_batch_);
+    // the network keeps a clone of the plugin
+    nvinfer1::IPluginV2Layer* layer = network_->addPluginV2(inputs.data(), inputs.size(), plugin);
+    CHECK(layer) << "TensorRT could not add the plugin of " << node.attrs.name;
+    layer->setName(node.attrs.name.c_str());
+    for (uint32_t i = 0; i < nout; ++i) {
+      tensors_[idx.entry_id(nid, i)] = layer->getOutput(i);
+    }
+#else
+    LOG(FATAL) << "The TensorRT plugins of MXNet operators need TensorRT 8 or later";
+#endif  // NV_TENSORRT_MAJOR >= 8
+  }
+
+  nnvm::Graph graph_;
+  const std::unordered_map<std::string, NDArray>& params_map_;
+  bool dynamic_batch_;
+  nvinfer1::INetworkDefinition* network_;
+  std::vector<nvinfer1::ITensor*> tensors_;
+  // the weights of the layers, which must live until the engine is built
+  std::deque<std::vector<float>> weights_;
+};
+
+/*! \brief the key of the engine of a graph: the graph, its input shapes and its parameters */
+std::string GetEngineKey(const nnvm::Graph& graph,
+                         const std::unordered_map<std::string, NDArray>& params_map,
+                         const ::onnx_to_tensorrt::TRTBatchProfile& profile,
+                         size_t max_workspace_size) {
+  nnvm::Graph structure;
+  structure.outputs = graph.outputs;
+  std::ostringstream key;
+  key << ::onnx_to_tensorrt::GetEngineKeyPrefix(profile, max_workspace_size) << "nnvm\n"
+      << nnvm::pass::SaveJSON(structure) << "\n";
+  const auto& idx          = graph.indexed_graph();
+  const auto& shape_inputs = graph.GetAttr<mxnet::ShapeVector>("shape_inputs");
+  const auto& dtype_inputs = graph.GetAttr<nnvm::DTypeVector>("dtype_inputs");
+  for (size_t i = 0; i < idx.input_nodes().size(); ++i) {
+    const std::string& name = idx[idx.input_nodes()[i]].source->attrs.name;
+    key << name << " " << shape_inputs[i] << " " << dtype_inputs[i];
+    auto it = params_map.find(name);
+    if (it != params_map.end()) {
+      const TBlob& data = it->second.data();
+      key << " " << Fnv1a(data.dptr_, data.Size() * mshadow::mshadow_sizeof(data.type_flag_));
+    }
+    key << "\n";
+  }
+  return key.str();
+}
+
+/*! \brief the context of the _TensorRT node running on the thread */
+thread_local const OpContext* running_ctx = nullptr;
+
+/*! \brief the operators running as plugins, MXNET_TENSORRT_PLUGIN_OPS */
+const std::unordered_set<std::string>& PluginOps() {
+  static const std::unordered_set<std::string> ops = []() {
+    std::unordered_set<std::string> names;
+    std::istringstream list(dmlc::GetEnv(
+        "MXNET_TENSORRT_PLUGIN_OPS",
+        std::string(
+            "_contrib_box_nms,_npx_deformable_convolution,_npx_modulated_deformable_convolution")));
+    for (std::string name; std::getline(list, name, ',');) {
+      if (!name.empty())
+        names.insert(name);
+    }
+    return names;
+  }();
+  return ops;
+}
+
+}  // namespace
+
+PluginContext::PluginContext(const OpContext* ctx) : prev_(running_ctx) {
+  running_ctx = ctx;
+}
+
+PluginContext::~PluginContext() {
+  running_ctx = prev_;
+}
+
+const OpContext* PluginContext::Get() {
+  return running_ctx;
+}
+
+bool IsPluginOp(const nnvm::Node& node) {
+#if NV_TENSORRT_MAJOR >= 8
+  if (node.is_variable() || !PluginOps().count(node.op()->name))
+    return false;
+  static auto& fcompute  = nnvm::Op::GetAttr<FCompute>("FCompute<gpu>");
+  static auto& fcreate   = nnvm::Op::GetAttr<FCreateOpState>("FCreateOpState");
+  static auto& fstateful = nnvm::Op::GetAttr<FStatefulCompute>("FStatefulCompute<gpu>");
+  static auto& fresource = nnvm::Op::GetAttr<FResourceRequest>("FResourceRequest");
+  static auto& fresource_ex = nnvm::Op::GetAttr<FResourceRequestEx>("FResourceRequestEx");
+  const nnvm::Op* op        = node.op();
+  if (!fcompute.count(op) && !(fcreate.count(op) && fstateful.count(op)))
+    return false;
+  // the plugins only get the temporary space of the _TensorRT node
+  if (fresource_ex.count(op))
+    return false;
+  if (fresource.count(op)) {
+    for (const auto& req : fresource[op](node.attrs)) {
+      if (req.type != ResourceRequest::kTempSpace)
+        return false;
+    }
+  }
+  return true;
+#else
+  return false;
+#endif  // NV_TENSORRT_MAJOR >= 8
+}
+
+bool IsConvertible(const nnvm::Node& node) {
+  if (node.is_variable())
+    return false;
+  const std::string& op_name = node.op()->name;
+  const auto& attrs          = node.attrs;
+  if (IsPluginOp(node))
+    return true;
+  if (kElementWiseOps.count(op_name) || kScalarOps.count(op_name) || kUnaryOps.count(op_name) ||
+      kIdentityOps.count(op_name)) {
+    return true;
+  }
+  if (op_name == "Convolution") {
+    const auto& param = nnvm::get<ConvolutionParam>(attrs.parsed);
+    return (param.kernel.ndim() == 2 || param.kernel.ndim() == 3) && IsNCHW(param.layout);
+  }
+  if (op_name == "Deconvolution") {
+    const auto& param = nnvm::get<DeconvolutionParam>(attrs.parsed);
+    const auto is     = [](const mxnet::TShape& shape, int value) {
+      return std::all_of(
+          shape.begin(), shape.end(), [value](dim_t v) { return v == value; });
+    };
+    return (param.kernel.ndim() == 2 || param.kernel.ndim() == 3) && IsNCHW(param.layout) &&
+           is(param.adj, 0) && is(param.dilate, 1) && param.target_shape.ndim() <= 0;
+  }
+  if (op_name == "FullyConnected" || op_name == "BatchNorm" || op_name == "Flatten" ||
+      op_name == "Concat" || op_name == "clip" || op_name == "transpose" || op_name == "rsqrt" ||
+      op_name == "relu" || op_name == "sigmoid" || op_name == "tanh") {
+    return true;
+  }
+  if (op_name == "Activation") {
+    return kActivations.count(nnvm::get<ActivationParam>(attrs.parsed).act_type);
+  }
+  if (op_name == "LeakyReLU") {
+    const int act_type = nnvm::get<LeakyReLUParam>(attrs.parsed).act_type;
+    return act_type == leakyrelu::kLeakyReLU || act_type == leakyrelu::kELU;
+  }
+  if (op_name == "Pooling") {
+    const auto& param = nnvm::get<PoolingParam>(attrs.parsed);
+    return (param.pool_type == pool_enum::kMaxPooling ||
+            param.pool_type == pool_enum::kAvgPooling) &&
+           param.pooling_convention != pool_enum::kSame && IsNCHW(param.layout) &&
+           (param.global_pool || param.kernel.ndim() == 2 || param.kernel.ndim() == 3);
+  }
+  if (op_name == "softmax") {
+    const auto& param = nnvm::get<SoftmaxParam>(attrs.parsed);
+    return !param.use_length.has_value() || !param.use_length.value();
+  }
+  if (op_name == "Pad") {
+    const auto& param = nnvm::get<PadParam>(attrs.parsed);
+    return param.mode == pad_enum::kConstant && param.constant_value == 0 &&
+           param.pad_width.ndim() == 8 && param.pad_width[0] == 0 && param.pad_width[1] == 0 &&
+           param.pad_width[2] == 0 && param.pad_width[3] == 0;
+  }
+  return false;
+}
+
+std::shared_ptr<::onnx_to_tensorrt::TRTEngine> GetTrtEngine(
+    const nnvm::Graph& graph,
+    const std::unordered_map<std::string, NDArray>& params_map,
+    const ::onnx_to_tensorrt::TRTBatchProfile& profile,
+    size_t max_workspace_size) {
+  const auto verbosity  = nvinfer1::ILogger::Severity::kWARNING;
+  const std::string key = GetEngineKey(graph, params_map, profile, max_workspace_size);
+  return ::onnx_to_tensorrt::GetCachedTrtEngine(
+      key, verbosity, [&](::onnx_to_tensorrt::TRTEngine* engine) {
+        auto logger  = std::unique_ptr<::onnx_to_tensorrt::TRT_Logger>(
+            new ::onnx_to_tensorrt::TRT_Logger(verbosity));
+        auto builder = InferObject(nvinfer1::createInferBuilder(*logger));
+        const auto explicit_batch =
+            1U << static_cast<uint32_t>(nvinfer1::NetworkDefinitionCreationFlag::kEXPLICIT_BATCH);
+        auto network = InferObject(builder->createNetworkV2(explicit_batch));
+        NetworkConverter converter(graph, params_map, profile.dynamic(), network.get());
+        converter.Convert();
+        engine->engine = ::onnx_to_tensorrt::BuildTrtEngine(builder.get(),
+                                                             network.get(),
+                                                             profile.max_batch_size,
+                                                             profile,
+                                                             max_workspace_size);
+        // the engine keeps the logger of its builder
+        engine->logger = std::move(logger);
+      });
+}
+
+}  // namespace nnvm_to_tensorrt
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_USE_TENSORRT
@@ -0,0 +1,91 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file nnvm_to_tensorrt.h
+ * \brief Conversion from NNVM to a TensorRT network without ONNX, the operators without a
+ *        TensorRT layer running as plugins calling their MXNet kernels
+ */
+
+#ifndef MXNET_OPERATOR_SUBGRAPH_TENSORRT_NNVM_TO_TENSORRT_H_
+#define MXNET_OPERATOR_SUBGRAPH_TENSORRT_NNVM_TO_TENSORRT_H_
+
+#if MXNET_USE_TENSORRT
+
+#include <mxnet/ndarray.h>
+#include <mxnet/op_attr_types.h>
+#include <nnvm/graph.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "./onnx_to_tensorrt.h"
+
+namespace mxnet {
+namespace op {
+namespace nnvm_to_tensorrt {
+
+/*! \brief whether the subgraphs are converted directly, MXNET_TENSORRT_DIRECT_BUILD */
+inline bool UseDirectBuild() {
+  return dmlc::GetEnv("MXNET_TENSORRT_DIRECT_BUILD", false);
+}
+
+/*!
+ * \brief Whether a node runs as a plugin calling its MXNet GPU kernel, for the operators of
+ *        MXNET_TENSORRT_PLUGIN_OPS, box_nms and the deformable convolutions by default.
+ */
+bool IsPluginOp(const nnvm::Node& node);
+
+/*! \brief Whether the direct conversion supports a node, as TensorRT layers or as a plugin */
+bool IsConvertible(const nnvm::Node& node);
+
+/*!
+ * \brief Get the engine of a subgraph on the current GPU, built from the graph directly.
+ * \param graph the subgraph, with the shape_inputs and dtype_inputs of its inputs
+ * \param params_map the parameters of the subgraph, baked into the engine
+ */
+std::shared_ptr<::onnx_to_tensorrt::TRTEngine> GetTrtEngine(
+    const nnvm::Graph& graph,
+    const std::unordered_map<std::string, NDArray>& params_map,
+    const ::onnx_to_tensorrt::TRTBatchProfile& profile,
+    size_t max_workspace_size);
+
+/*!
+ * \brief Gives the plugins of the engines run by the calling thread the context of the
+ *        _TensorRT node running them, for its stream and its temporary space.
+ */
+class PluginContext {
+ public:
+  explicit PluginContext(const OpContext* ctx);
+  ~PluginContext();
+  /*! \brief the context of the running node, nullptr outside of a run, e.g. while building */
+  static const OpContext* Get();
+
+ private:
+  const OpContext* prev_;
+};
+
+}  // namespace nnvm_to_tensorrt
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_USE_TENSORRT
+
+#endif  // MXNET_OPERATOR_SUBGRAPH_TENSORRT_NNVM_TO_TENSORRT_H_
@@ -30,12 +30,20 @@
 #include <onnx/onnx_pb.h>
 
 #include <NvInfer.h>
+#include <cuda_runtime_api.h>
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/text_format.h>
 #include <onnx-tensorrt/NvOnnxParser.h>
 #include <dmlc/logging.h>
 #include <dmlc/parameter.h>
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <unordered_map>
 
 using std::cerr;
 using std::cout;
@@ -58,6 +66,60 @@ void PrintVersion() {
        << NV_TENSORRT_PATCH << endl;
 }
 
+unique_ptr<nvinfer1::ICudaEngine> BuildTrtEngine(nvinfer1::IBuilder* builder,
+                                                 nvinfer1::INetworkDefinition* network,
+                                                 int32_t max_batch_size,
+                                                 const TRTBatchProfile& profile,
+                                                 size_t max_workspace_size,
+                                                 bool debug_builder) {
+#if NV_TENSORRT_MAJOR >= 8
+  auto trt_config = InferObject(builder->createBuilderConfig());
+#endif
+  if (dmlc::GetEnv("MXNET_TENSORRT_USE_FP16", true)) {
+    if (builder->platformHasFastFp16()) {
+#if NV_TENSORRT_MAJOR >= 8
+      trt_config->setFlag(nvinfer1::BuilderFlag::kFP16);
+#else
+      builder->setFp16Mode(true);
+#endif
+    } else {
+      LOG(WARNING) << "TensorRT can't use fp16 on this platform";
+    }
+  }
+  builder->setMaxBatchSize(max_batch_size);
+#if NV_TENSORRT_MAJOR >= 8
+  trt_config->setMaxWorkspaceSize(max_workspace_size);
+  if (debug_builder) {
+    trt_config->setFlag(nvinfer1::BuilderFlag::kDEBUG);
+  }
+  if (profile.dynamic()) {
+    // the inputs with a dynamic batch take any batch size of the profile
+    nvinfer1::IOptimizationProfile* trt_profile = builder->createOptimizationProfile();
+    for (int i = 0; i < network->getNbInputs(); ++i) {
+      const nvinfer1::ITensor* input = network->getInput(i);
+      nvinfer1::Dims dims            = input->getDimensions();
+      if (dims.nbDims == 0 || dims.d[0] != -1)
+        continue;
+      dims.d[0] = profile.min_batch_size;
+      trt_profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kMIN, dims);
+      dims.d[0] = profile.opt_batch_size;
+      trt_profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kOPT, dims);
+      dims.d[0] = profile.max_batch_size;
+      trt_profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kMAX, dims);
+    }
+    trt_config->addOptimizationProfile(trt_profile);
+  }
+  return InferObject(builder->buildEngineWithConfig(*network, *trt_config));
+#else
+  if (profile.dynamic()) {
+    throw dmlc::Error("The dynamic batch of the TensorRT engines needs TensorRT 8 or later");
+  }
+  builder->setMaxWorkspaceSize(max_workspace_size);
+  builder->setDebugSync(debug_builder);
+  return InferObject(builder->buildCudaEngine(*network));
+#endif
+}
+
 std::tuple<unique_ptr<nvinfer1::ICudaEngine>,
            unique_ptr<nvonnxparser::IParser>,
            std::unique_ptr<TRT_Logger> >
@@ -65,7 +127,8 @@ onnxToTrtCtx(const std::string& onnx_model,
              int32_t max_batch_size,
              size_t max_workspace_size,
              nvinfer1::ILogger::Severity verbosity,
-             bool debug_builder) {
+             bool debug_builder,
+             const TRTBatchProfile& profile) {
   GOOGLE_PROTOBUF_VERIFY_VERSION;
 
   auto trt_logger  = std::unique_ptr<TRT_Logger>(new TRT_Logger(verbosity));
@@ -103,33 +166,186 @@ onnxToTrtCtx(const std::string& onnx_model,
     }
     throw dmlc::Error("Cannot parse ONNX into TensorRT Engine");
   }
+  auto trt_engine = BuildTrtEngine(trt_builder.get(),
+                                   trt_network.get(),
+                                   max_batch_size,
+                                   profile,
+                                   max_workspace_size,
+                                   debug_builder);
+  return std::make_tuple(std::move(trt_engine), std::move(trt_parser), std::move(trt_logger));
+}
+
+std::string GetEngineKeyPrefix(const TRTBatchProfile& profile, size_t max_workspace_size) {
+  int dev_id;
+  cudaDeviceProp prop;
+  if (cudaGetDevice(&dev_id) != cudaSuccess ||
+      cudaGetDeviceProperties(&prop, dev_id) != cudaSuccess) {
+    throw dmlc::Error("Could not get the properties of the current GPU");
+  }
+  std::ostringstream key;
+  key << "TensorRT " << NV_TENSORRT_MAJOR << "." << NV_TENSORRT_MINOR << "." << NV_TENSORRT_PATCH
+      << " (" << getInferLibVersion() << ")\n"
+      << prop.name << " sm_" << prop.major << prop.minor << "\n"
+      << "fp16 " << dmlc::GetEnv("MXNET_TENSORRT_USE_FP16", true) << " workspace "
+      << max_workspace_size << " batch " << profile.min_batch_size << " "
+      << profile.opt_batch_size << " " << profile.max_batch_size << "\n";
+  return key.str();
+}
+
+namespace {
+
+/*! \brief 64-bit FNV-1a hash, unlike std::hash it is the same in every process */
+uint64_t StableHash(const std::string& s, uint64_t hash = 0xcbf29ce484222325ULL) {
+  for (const unsigned char c : s) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+/*! \brief serialized engine in the persistent cache of MXNET_TENSORRT_ENGINE_CACHE_DIR */
+struct DiskCacheEntry {
+  /*! \brief file of the engine, empty if the persistent cache is disabled */
+  std::string path;
+  /*! \brief second hash of the key, guards against collisions of file names */
+  uint64_t check;
+};
+
+constexpr char kDiskCacheMagic[8] = "MXTRT01";
+
+/*!
+ * \brief The key of the engine of a model. It covers the model without the name of its graph,
+ *  which counts the subgraphs of the process, the builder options, the TensorRT version and the
+ *  GPU, since a serialized engine only runs on the GPU model and the TensorRT it was built with.
+ */
+std::string GetEngineKey(const std::string& onnx_model,
+                         const TRTBatchProfile& profile,
+                         size_t max_workspace_size) {
+  ::ONNX_NAMESPACE::ModelProto model;
+  if (!model.ParseFromString(onnx_model)) {
+    throw dmlc::Error("Could not parse ONNX from string");
+  }
+  model.mutable_graph()->clear_name();
+  return GetEngineKeyPrefix(profile, max_workspace_size) + model.SerializeAsString();
+}
+
+DiskCacheEntry GetDiskCacheEntry(const std::string& key) {
+  const std::string dir = dmlc::GetEnv("MXNET_TENSORRT_ENGINE_CACHE_DIR", std::string());
+  if (dir.empty())
+    return {std::string(), 0};
+  mkdir(dir.c_str(), 0755);
+  char name[17];
+  snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(StableHash(key)));
+  return {dir + "/" + name + ".trt", StableHash(key, 0x84222325cbf29ce4ULL)};
+}
+
+/*! \brief Read an engine from the persistent cache, returns false if it is missing or invalid */
+bool LoadFromDiskCache(const DiskCacheEntry& entry, std::string* plan) {
+  std::ifstream f(entry.path, std::ios::binary);
+  if (!f)
+    return false;
+  char magic[sizeof(kDiskCacheMagic)];
+  uint64_t check = 0, plan_size = 0;
+  f.read(magic, sizeof(magic));
+  f.read(reinterpret_cast<char*>(&check), sizeof(check));
+  f.read(reinterpret_cast<char*>(&plan_size), sizeof(plan_size));
+  if (!f || std::string(magic) != kDiskCacheMagic || check != entry.check)
+    return false;
+  std::string data(plan_size, '\0');
+  f.read(&data[0], plan_size);
+  if (!f)
+    return false;
+  *plan = std::move(data);
+  return true;
+}
+
+/*!
+ * \brief Write an engine to the persistent cache. The file is written under a temporary
+ *  name and renamed, so concurrent processes never read a partial engine.
+ */
+void StoreToDiskCache(const DiskCacheEntry& entry, const nvinfer1::IHostMemory& plan) {
+  const std::string tmp_path = entry.path + ".tmp" + std::to_string(std::random_device()());
+  {
+    std::ofstream f(tmp_path, std::ios::binary);
+    const uint64_t plan_size = plan.size();
+    f.write(kDiskCacheMagic, sizeof(kDiskCacheMagic));
+    f.write(reinterpret_cast<const char*>(&entry.check), sizeof(entry.check));
+    f.write(reinterpret_cast<const char*>(&plan_size), sizeof(plan_size));
+    f.write(static_cast<const char*>(plan.data()), plan_size);
+    if (!f) {
+      LOG(WARNING) << "Could not write the TensorRT engine to " << entry.path;
+      f.close();
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), entry.path.c_str()) != 0)
+    std::remove(tmp_path.c_str());
+}
+
+}  // namespace
+
+std::shared_ptr<TRTEngine> GetCachedTrtEngine(const std::string& key,
+                                              nvinfer1::ILogger::Severity verbosity,
+                                              const std::function<void(TRTEngine*)>& build) {
+  static std::mutex mutex;
+  // the engines in use in the process, by device and key
+  static std::unordered_map<std::string, std::weak_ptr<TRTEngine> > engines;
+  int dev_id;
+  if (cudaGetDevice(&dev_id) != cudaSuccess) {
+    throw dmlc::Error("Could not get the current GPU");
+  }
+  const std::string process_key = std::to_string(dev_id) + "\n" + key;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = engines.find(process_key);
+  if (it != engines.end()) {
+    if (std::shared_ptr<TRTEngine> engine = it->second.lock()) {
+      return engine;
+    }
+  }
+  auto engine                = std::make_shared<TRTEngine>();
+  const DiskCacheEntry entry = GetDiskCacheEntry(key);
+  std::string plan;
+  if (!entry.path.empty() && LoadFromDiskCache(entry, &plan)) {
+    engine->logger  = std::unique_ptr<TRT_Logger>(new TRT_Logger(verbosity));
+    engine->runtime = InferObject(nvinfer1::createInferRuntime(*engine->logger));
 #if NV_TENSORRT_MAJOR >= 8
-  auto trt_config = InferObject(trt_builder->createBuilderConfig());
-#endif
-  if (dmlc::GetEnv("MXNET_TENSORRT_USE_FP16", true)) {
-    if (trt_builder->platformHasFastFp16()) {
-#if NV_TENSORRT_MAJOR >= 8
-      trt_config->setFlag(nvinfer1::BuilderFlag::kFP16);
+    nvinfer1::ICudaEngine* trt_engine = engine->runtime->deserializeCudaEngine(plan.data(),
+                                                                               plan.size());
 #else
-      trt_builder->setFp16Mode(true);
+    nvinfer1::ICudaEngine* trt_engine =
+        engine->runtime->deserializeCudaEngine(plan.data(), plan.size(), nullptr);
 #endif
+    if (trt_engine) {
+      engine->engine = InferObject(trt_engine);
     } else {
-      LOG(WARNING) << "TensorRT can't use fp16 on this platform";
+      LOG(WARNING) << "Could not load the TensorRT engine " << entry.path << ", rebuilding it";
+      engine->runtime.reset();
     }
   }
-  trt_builder->setMaxBatchSize(max_batch_size);
-#if NV_TENSORRT_MAJOR >= 8
-  trt_config->setMaxWorkspaceSize(max_workspace_size);
-  if (debug_builder) {
-    trt_config->setFlag(nvinfer1::BuilderFlag::kDEBUG);
+  if (!engine->engine) {
+    build(engine.get());
+    if (!entry.path.empty()) {
+      StoreToDiskCache(entry, *InferObject(engine->engine->serialize()));
+    }
   }
-  auto trt_engine = InferObject(trt_builder->buildEngineWithConfig(*trt_network, *trt_config));
-#else
-  trt_builder->setMaxWorkspaceSize(max_workspace_size);
-  trt_builder->setDebugSync(debug_builder);
-  auto trt_engine = InferObject(trt_builder->buildCudaEngine(*trt_network));
-#endif
-  return std::make_tuple(std::move(trt_engine), std::move(trt_parser), std::move(trt_logger));
+  engines[process_key] = engine;
+  return engine;
+}
+
+std::shared_ptr<TRTEngine> GetTrtEngine(const std::string& onnx_model,
+                                        const TRTBatchProfile& profile,
+                                        size_t max_workspace_size,
+                                        nvinfer1::ILogger::Severity verbosity) {
+  const std::string key = GetEngineKey(onnx_model, profile, max_workspace_size);
+  return GetCachedTrtEngine(key, verbosity, [&](TRTEngine* engine) {
+    auto trt_tuple = onnxToTrtCtx(
+        onnx_model, profile.max_batch_size, max_workspace_size, verbosity, false, profile);
+    // the engine keeps the logger of its builder
+    engine->engine = std::move(std::get<0>(trt_tuple));
+    engine->parser = std::move(std::get<1>(trt_tuple));
+    engine->logger = std::move(std::get<2>(trt_tuple));
+  });
 }
 
 }  // namespace onnx_to_tensorrt
@@ -32,6 +32,7 @@
 #include <NvInfer.h>
 
 #include <fstream>
+#include <functional>
 #include <memory>
 #include <iostream>
 #include <sstream>
@@ -85,6 +86,39 @@ class TRT_Logger : public nvinfer1::ILogger {
   }
 };
 
+/*!
+ * \brief The batch sizes of the optimization profile of an engine whose inputs and outputs have
+ *  a dynamic batch on their first axis. The engine has static shapes when min_batch_size is 0.
+ */
+struct TRTBatchProfile {
+  int32_t min_batch_size = 0;
+  int32_t opt_batch_size = 0;
+  int32_t max_batch_size = 0;
+
+  bool dynamic() const {
+    return min_batch_size > 0;
+  }
+};
+
+/*! \brief An engine with the objects it depends on, destroyed in the reverse order */
+struct TRTEngine {
+  std::unique_ptr<TRT_Logger> logger;
+  unique_ptr<nvinfer1::IRuntime> runtime;
+  unique_ptr<nvonnxparser::IParser> parser;
+  unique_ptr<nvinfer1::ICudaEngine> engine;
+};
+
+/*!
+ * \brief Build the engine of a network with the builder options of MXNet: fp16 unless
+ *  MXNET_TENSORRT_USE_FP16 is 0, and the optimization profile of the dynamic batch if any.
+ */
+unique_ptr<nvinfer1::ICudaEngine> BuildTrtEngine(nvinfer1::IBuilder* builder,
+                                                 nvinfer1::INetworkDefinition* network,
+                                                 int32_t max_batch_size,
+                                                 const TRTBatchProfile& profile,
+                                                 size_t max_workspace_size,
+                                                 bool debug_builder = false);
+
 std::tuple<unique_ptr<nvinfer1::ICudaEngine>,
            unique_ptr<nvonnxparser::IParser>,
            std::unique_ptr<TRT_Logger> >
@@ -92,7 +126,34 @@ onnxToTrtCtx(const std::string& onnx_model,
              int32_t max_batch_size                = 32,
              size_t max_workspace_size             = 1L << 30,
              nvinfer1::ILogger::Severity verbosity = nvinfer1::ILogger::Severity::kWARNING,
-             bool debug_builder                    = false);
+             bool debug_builder                    = false,
+             const TRTBatchProfile& profile        = TRTBatchProfile());
+
+/*!
+ * \brief The part of the key of an engine covering the builder options, the TensorRT version
+ *  and the GPU, since a serialized engine only runs on the GPU model and the TensorRT it was
+ *  built with.
+ */
+std::string GetEngineKeyPrefix(const TRTBatchProfile& profile, size_t max_workspace_size);
+
+/*!
+ * \brief Get the engine of a key on the current GPU, shared by the nodes of a process and kept
+ *  in the persistent cache of MXNET_TENSORRT_ENGINE_CACHE_DIR. build makes the engine on a miss.
+ */
+std::shared_ptr<TRTEngine> GetCachedTrtEngine(const std::string& key,
+                                              nvinfer1::ILogger::Severity verbosity,
+                                              const std::function<void(TRTEngine*)>& build);
+
+/*!
+ * \brief Get the engine of an ONNX model on the current GPU. The engines are shared by the nodes
+ *  of a process building the same model, and serialized to MXNET_TENSORRT_ENGINE_CACHE_DIR when
+ *  it is set, so that other processes load them instead of building them again.
+ */
+std::shared_ptr<TRTEngine> GetTrtEngine(
+    const std::string& onnx_model,
+    const TRTBatchProfile& profile,
+    size_t max_workspace_size             = 1L << 30,
+    nvinfer1::ILogger::Severity verbosity = nvinfer1::ILogger::Severity::kWARNING);
 }  // namespace onnx_to_tensorrt
 
 #endif  // MXNET_USE_TENSORRT
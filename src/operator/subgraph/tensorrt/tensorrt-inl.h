@@ -45,6 +45,7 @@
 #include "../common.h"
 #include "../subgraph_property.h"
 #include "nnvm_to_onnx-inl.h"
+#include "./nnvm_to_tensorrt.h"
 #include "./onnx_to_tensorrt.h"
 
 namespace mxnet {
@@ -59,33 +60,29 @@ struct TRTParam {
 };
 
 struct TRTEngineParam {
-  TRTEngineParam(onnx_to_tensorrt::unique_ptr<nvinfer1::ICudaEngine> _trt_engine,
-                 onnx_to_tensorrt::unique_ptr<nvonnxparser::IParser> _trt_parser,
-                 std::unique_ptr<onnx_to_tensorrt::TRT_Logger> _trt_logger,
+  TRTEngineParam(std::shared_ptr<onnx_to_tensorrt::TRTEngine> _trt_engine,
                  const std::unordered_map<std::string, uint32_t>& input_map,
                  const std::unordered_map<std::string, uint32_t>& output_map) {
     trt_engine    = std::move(_trt_engine);
-    trt_logger    = std::move(_trt_logger);
-    trt_parser    = std::move(_trt_parser);
     binding_order = std::make_shared<std::vector<std::pair<uint32_t, bool>>>();
     bindings      = std::make_shared<std::vector<void*>>();
-    binding_order->reserve(trt_engine->getNbBindings());
-    bindings->resize(trt_engine->getNbBindings());
-    for (int b = 0; b < trt_engine->getNbBindings(); ++b) {
-      const std::string& binding_name = trt_engine->getBindingName(b);
-      if (trt_engine->bindingIsInput(b)) {
+    const nvinfer1::ICudaEngine& engine = *trt_engine->engine;
+    binding_order->reserve(engine.getNbBindings());
+    bindings->resize(engine.getNbBindings());
+    for (int b = 0; b < engine.getNbBindings(); ++b) {
+      const std::string& binding_name = engine.getBindingName(b);
+      if (engine.bindingIsInput(b)) {
         binding_order->emplace_back(input_map.at(binding_name), true);
       } else {
         binding_order->emplace_back(output_map.at(binding_name), false);
       }
     }
-    trt_executor = onnx_to_tensorrt::InferObject(trt_engine->createExecutionContext());
+    // each state runs the shared engine with its own execution context
+    trt_executor = onnx_to_tensorrt::InferObject(trt_engine->engine->createExecutionContext());
   }
 
-  onnx_to_tensorrt::unique_ptr<nvinfer1::ICudaEngine> trt_engine;
+  std::shared_ptr<onnx_to_tensorrt::TRTEngine> trt_engine;
   onnx_to_tensorrt::unique_ptr<nvinfer1::IExecutionContext> trt_executor;
-  onnx_to_tensorrt::unique_ptr<nvonnxparser::IParser> trt_parser;
-  std::unique_ptr<onnx_to_tensorrt::TRT_Logger> trt_logger;
   std::shared_ptr<std::vector<std::pair<uint32_t, bool>>> binding_order;
   std::shared_ptr<std::vector<void*>> bindings;
 };
@@ -110,6 +107,9 @@ class TensorrtSelector : public SubgraphSelector {
                                                           "FullyConnected"};
 
   bool isTRTCompatible(const nnvm::Node& n) {
+    if (direct_build_) {
+      return nnvm_to_tensorrt::IsConvertible(n);
+    }
     const std::string op_name = n.op()->name;
     if (op_name == "FullyConnected") {
       const auto& param = nnvm::get<FullyConnectedParam>(n.attrs.parsed);
@@ -230,7 +230,9 @@ class TensorrtSelector : public SubgraphSelector {
 
   bool SelectInput(const nnvm::Node& n, const nnvm::Node& new_node) override {
     if (new_node.is_variable()) {
-      if (withWeightsOps.count(n.op()->name)) {
+      // the plugins take their weights as parameters too
+      if (withWeightsOps.count(n.op()->name) ||
+          (direct_build_ && nnvm_to_tensorrt::IsPluginOp(n))) {
         return n.inputs[0].node->attrs.name != new_node.attrs.name;
       } else {
         return false;
@@ -257,6 +259,9 @@ class TensorrtSelector : public SubgraphSelector {
     }
     return std::vector<nnvm::Node*>();
   }
+
+ private:
+  const bool direct_build_ = nnvm_to_tensorrt::UseDirectBuild();
 };
 
 class TensorrtProperty : public SubgraphProperty {
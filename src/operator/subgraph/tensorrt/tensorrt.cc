@@ -26,6 +26,7 @@
 #if MXNET_USE_TENSORRT
 
 #include "./tensorrt-inl.h"
+#include "../../../common/cuda/utils.h"
 
 namespace mxnet {
 namespace op {
@@ -270,6 +271,21 @@ OpStatePtr TRTCreateState(const nnvm::NodeAttrs& attrs,
               << " instead of: " << max_batch_size;
     max_batch_size = in_shape[0][0];
   }
+  // an engine with a dynamic batch serves every batch size of its profile
+  onnx_to_tensorrt::TRTBatchProfile profile;
+  profile.max_batch_size = max_batch_size;
+  if (dmlc::GetEnv("MXNET_TENSORRT_DYNAMIC_BATCH", false)) {
+    profile.min_batch_size = dmlc::GetEnv("MXNET_TENSORRT_MIN_BATCH_SIZE", 1);
+    profile.opt_batch_size = dmlc::GetEnv("MXNET_TENSORRT_OPT_BATCH_SIZE", profile.max_batch_size);
+    CHECK(profile.min_batch_size > 0 && profile.min_batch_size <= in_shape[0][0] &&
+          profile.min_batch_size <= profile.opt_batch_size &&
+          profile.opt_batch_size <= profile.max_batch_size)
+        << "The TensorRT batch sizes must verify 0 < MXNET_TENSORRT_MIN_BATCH_SIZE ("
+        << profile.min_batch_size << ") <= batch size (" << in_shape[0][0]
+        << ") and MXNET_TENSORRT_MIN_BATCH_SIZE <= MXNET_TENSORRT_OPT_BATCH_SIZE ("
+        << profile.opt_batch_size << ") <= MXNET_TENSORRT_MAX_BATCH_SIZE ("
+        << profile.max_batch_size << ")";
+  }
   std::unordered_map<std::string, NDArray> params_map = node_param.params_map;
   const auto& inputs_to_idx                           = node_param.inputs_to_idx;
   const auto& outputs_to_idx                          = node_param.outputs_to_idx;
@@ -304,17 +320,20 @@ OpStatePtr TRTCreateState(const nnvm::NodeAttrs& attrs,
     dtypes[eid] = out_type[i];
     shapes[eid] = out_shape[i];
   }
-  graph.attrs["dtype_inputs"] = std::make_shared<nnvm::any>(std::move(dtype_inputs));
-  graph.attrs["shape_inputs"] = std::make_shared<nnvm::any>(std::move(shape_inputs));
-  graph.attrs["dtype"]        = std::make_shared<nnvm::any>(std::move(dtypes));
-  graph.attrs["shape"]        = std::make_shared<nnvm::any>(std::move(shapes));
-  auto onnx_graph             = op::nnvm_to_onnx::ConvertNnvmGraphToOnnx(graph, &params_map);
-  auto trt_tuple = ::onnx_to_tensorrt::onnxToTrtCtx(onnx_graph, max_batch_size, 1 << 30);
-  return OpStatePtr::Create<TRTEngineParam>(std::move(std::get<0>(trt_tuple)),
-                                            std::move(std::get<1>(trt_tuple)),
-                                            std::move(std::get<2>(trt_tuple)),
-                                            inputs_to_idx,
-                                            outputs_to_idx);
+  graph.attrs["dtype_inputs"]  = std::make_shared<nnvm::any>(std::move(dtype_inputs));
+  graph.attrs["shape_inputs"]  = std::make_shared<nnvm::any>(std::move(shape_inputs));
+  graph.attrs["dtype"]         = std::make_shared<nnvm::any>(std::move(dtypes));
+  graph.attrs["shape"]         = std::make_shared<nnvm::any>(std::move(shapes));
+  graph.attrs["dynamic_batch"] = std::make_shared<nnvm::any>(profile.dynamic());
+  common::cuda::DeviceStore device_store(ctx.real_dev_id());
+  std::shared_ptr<::onnx_to_tensorrt::TRTEngine> trt_engine;
+  if (nnvm_to_tensorrt::UseDirectBuild()) {
+    trt_engine = nnvm_to_tensorrt::GetTrtEngine(graph, params_map, profile, 1 << 30);
+  } else {
+    auto onnx_graph = op::nnvm_to_onnx::ConvertNnvmGraphToOnnx(graph, &params_map);
+    trt_engine      = ::onnx_to_tensorrt::GetTrtEngine(onnx_graph, profile, 1 << 30);
+  }
+  return OpStatePtr::Create<TRTEngineParam>(std::move(trt_engine), inputs_to_idx, outputs_to_idx);
 }
 
 NNVM_REGISTER_OP(_TensorRT)
@@ -328,6 +347,11 @@ NNVM_REGISTER_OP(_TensorRT)
     .set_attr<nnvm::FListInputNames>("FListInputNames", TRTListInputNames)
     .set_attr<nnvm::FListOutputNames>("FListOutputNames", DefaultSubgraphOpListOutputs)
     .set_attr<FCreateOpState>("FCreateOpState", TRTCreateState)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  // the temporary space of the plugins of the engine
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
     .set_attr<FInferStorageType>("FInferStorageType", TRTInferStorageType);
 
 MXNET_REGISTER_SUBGRAPH_BACKEND(TensorRT);
@@ -58,10 +58,19 @@ void TRTCompute(const OpStatePtr& state,
     auto& p = param.binding_order->at(i);
     if (p.second == true) {
       param.bindings->at(i) = inputs[p.first].dptr_;
+      // the engines with a dynamic batch run with the batch size of the inputs
+      const mxnet::TShape& shape = inputs[p.first].shape_;
+      nvinfer1::Dims dims        = param.trt_executor->getBindingDimensions(i);
+      if (param.trt_engine->engine->getBindingDimensions(i).d[0] == -1 && dims.d[0] != shape[0]) {
+        dims.d[0] = shape[0];
+        CHECK(param.trt_executor->setBindingDimensions(i, dims))
+            << "The batch size " << shape[0] << " is out of the TensorRT optimization profile";
+      }
     } else {
       param.bindings->at(i) = outputs[p.first].dptr_;
     }
   }
+  nnvm_to_tensorrt::PluginContext plugin_ctx(&ctx);
   param.trt_executor->enqueueV2(param.bindings->data(), cuda_s, nullptr);
 }
 
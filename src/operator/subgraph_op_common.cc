@@ -238,6 +238,54 @@ void LoopState::Forward(int iter_no,
   Imperative::Get()->set_is_recording(orig_is_record);
 }
 
+void LoopState::StaticForward(const std::vector<NDArray>& inputs, std::vector<NDArray>* outputs) {
+  if (!static_op)
+    static_op = LoopState::MakeStaticOp(subgraph_sym);
+  LoopState::RunStaticOp(static_op, inputs, outputs);
+}
+
+CachedOpPtr LoopState::MakeStaticOp(const nnvm::Symbol& sym) {
+  // The inputs are parameters of the cached op, which keeps its executors while they
+  // are the same arrays.
+  std::ostringstream param_indices;
+  param_indices << "(";
+  const size_t num_inputs = sym.ListInputNames(nnvm::Symbol::kAll).size();
+  for (size_t i = 0; i < num_inputs; i++)
+    param_indices << (i > 0 ? "," : "") << i;
+  param_indices << ")";
+  std::vector<std::pair<std::string, std::string> > kwargs = {
+      {"inline_limit", "0"},
+      {"static_alloc", "1"},
+      {"static_shape", "1"},
+      {"param_indices", param_indices.str()}};
+  return std::make_shared<CachedOp>(sym, kwargs);
+}
+
+void LoopState::RunStaticOp(const CachedOpPtr& op,
+                            const std::vector<NDArray>& cinputs,
+                            std::vector<NDArray>* coutputs) {
+  CHECK(cinputs.size() > 0) << "loop forward requires at least 1 input";
+  std::vector<NDArray> in_bufs  = cinputs;
+  std::vector<NDArray> out_bufs = *coutputs;
+  std::vector<NDArray*> inputs(in_bufs.size());
+  std::vector<NDArray*> outputs(out_bufs.size());
+  for (size_t i = 0; i < inputs.size(); i++)
+    inputs[i] = &in_bufs[i];
+  for (size_t i = 0; i < outputs.size(); i++)
+    outputs[i] = &out_bufs[i];
+  bool orig_is_record = Imperative::Get()->set_is_recording(false);
+  op->Forward(nullptr, inputs, outputs, cinputs[0].ctx());
+  Imperative::Get()->set_is_recording(orig_is_record);
+  // As in Forward, an output sharing the array of an input is replaced by CachedOp.
+  for (size_t i = 0; i < out_bufs.size(); i++) {
+    NDArray& output = (*coutputs)[i];
+    if (output.is_none())
+      output = out_bufs[i];
+    else if (!out_bufs[i].IsSame(output))
+      CopyFromTo(out_bufs[i], output);
+  }
+}
+
 void LoopState::Backward(int iter_no,
                          const std::vector<NDArray>& ograds,
                          const std::vector<OpReqType>& req,
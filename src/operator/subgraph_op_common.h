@@ -136,6 +136,8 @@ class LoopState {
   // which will be used in the backward.
   std::vector<OpStatePtr> all_states;
   CachedOpPtr iter_op;
+  // Created on the first StaticForward.
+  CachedOpPtr static_op;
   nnvm::Symbol subgraph_sym;
   nnvm::Graph subgraph;
 
@@ -147,6 +149,13 @@ class LoopState {
                const std::vector<OpReqType>& req,
                const std::vector<NDArray>& outputs,
                bool is_recording);
+  /*!
+   * \brief run an iteration for inference on the same arrays as the previous ones, so that
+   *  the subgraph is planned once and its ops are pushed as bulked segments (or replayed as a
+   *  CUDA graph) instead of being dispatched one by one. The outputs which are none are given
+   *  the arrays allocated for them, to be passed again in the next iterations.
+   */
+  void StaticForward(const std::vector<NDArray>& inputs, std::vector<NDArray>* outputs);
   void Backward(int iter_no,
                 const std::vector<NDArray>& ograds,
                 const std::vector<OpReqType>& req,
@@ -169,6 +178,12 @@ class LoopState {
     }
     return std::make_shared<CachedOp>(sym, kwargs);
   }
+  /*! \brief a cached op with the static shapes of its inputs, which are all static arrays */
+  static CachedOpPtr MakeStaticOp(const nnvm::Symbol& sym);
+  /*! \brief runs a static op for inference, see StaticForward */
+  static void RunStaticOp(const CachedOpPtr& op,
+                          const std::vector<NDArray>& inputs,
+                          std::vector<NDArray>* outputs);
 };
 
 }  // namespace op
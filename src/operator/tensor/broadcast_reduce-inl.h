@@ -167,6 +167,53 @@ struct binary_broadcast_kernel {
   }
 };
 
+/*! \brief layouts of a compacted binary broadcast with a dedicated kernel */
+enum BroadcastPattern {
+  // no dedicated kernel
+  kBroadcastGeneral,
+  // one operand has a single element
+  kBroadcastScalar,
+  // one operand is a row repeated along the outer axis of the 2D output
+  kBroadcastRow,
+  // one operand is a column repeated along the inner axis of the 2D output
+  kBroadcastColumn
+};
+
+/*!
+ * \brief binary broadcast kernel of a BroadcastPattern, the other operand having the shape of
+ *  the output. The elements are walked a row of the output at a time, the inner loop accessing
+ *  contiguous elements without computing their coordinates.
+ * \tparam lhs_bcast whether the broadcast operand is the left hand side one
+ */
+template <int pattern, bool lhs_bcast, int req, typename OP>
+struct binary_broadcast_pattern_kernel {
+  /*!
+   * \brief Map function for binary_broadcast_pattern_kernel
+   * \param base   first output element of the chunk
+   * \param length number of output elements of the chunk
+   * \param inner  length of the rows of the output, its size for kBroadcastScalar
+   */
+  template <typename LType, typename RType, typename OType>
+  MSHADOW_XINLINE static void Map(index_t base,
+                                  index_t length,
+                                  const index_t inner,
+                                  LType* lhs,
+                                  RType* rhs,
+                                  OType* out) {
+    const index_t end = base + length;
+    for (index_t row = base / inner, i = base; i < end; ++row) {
+      const index_t row_begin = row * inner;
+      const index_t row_end   = row_begin + inner < end ? row_begin + inner : end;
+      for (; i < row_end; ++i) {
+        const index_t b = pattern == kBroadcastRow ? i - row_begin
+                          : pattern == kBroadcastColumn ? row
+                                                        : 0;
+        KERNEL_ASSIGN(out[i], req, OP::Map(lhs[lhs_bcast ? b : i], rhs[lhs_bcast ? i : b]));
+      }
+    }
+  }
+};
+
 template <int req, typename OP, bool col_vec>
 struct csr_dns_csr_broadcast_kernel {
   /*!
@@ -214,6 +261,35 @@ struct csr_dns_csr_broadcast_kernel {
   }
 };
 
+template <int req, typename OP>
+struct rsp_dns_rsp_broadcast_kernel {
+  /*!
+   * \brief Map function for broadcast between a 2D row_sparse matrix and a dense array
+   *        of at most 2 dimensions
+   * \param i           global thread id, the i-th element of the stored rows
+   * \param rsp_data    ptr to data buffer of row_sparse matrix
+   * \param rsp_idx     ptr to row index buffer of row_sparse matrix
+   * \param dns         ptr to data buffer of the dense array
+   * \param out         ptr to the data buffer of the result row_sparse matrix
+   * \param num_cols    number of columns of the row_sparse matrix
+   * \param row_stride  stride of the dense array along the rows, 0 when broadcast
+   * \param col_stride  stride of the dense array along the columns, 0 when broadcast
+   */
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  const DType* rsp_data,
+                                  const IType* rsp_idx,
+                                  const DType* dns,
+                                  DType* out,
+                                  const nnvm::dim_t num_cols,
+                                  const nnvm::dim_t row_stride,
+                                  const nnvm::dim_t col_stride) {
+    const nnvm::dim_t j = static_cast<nnvm::dim_t>(rsp_idx[i / num_cols]) * row_stride +
+                          (i % num_cols) * col_stride;
+    KERNEL_ASSIGN(out[i], req, OP::Map(rsp_data[i], dns[j]));
+  }
+};
+
 template <int req, typename OP, bool reverse = false>
 struct csr_dns_map_kernel {
   template <typename DType, typename CType, typename RType>
@@ -372,16 +448,17 @@ MSHADOW_XINLINE void seq_reduce_assign(const index_t idx,
   } else {
     const int thread_count = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
     auto pairs             = std::make_unique<std::pair<AType, AType>[]>(thread_count);
-#pragma omp parallel for num_threads(thread_count)
-    for (int i = 0; i < thread_count; ++i) {
-      pairs[i] = seq_reduce_assign_block<Reducer, ndim, AType, DType, OType, OP, IndexOP>(
-          i * (M / thread_count),
-          i < (thread_count - 1) ? (M / thread_count) : (M / thread_count) + M % thread_count,
-          j,
-          big,
-          rshape,
-          rstride);
-    }
+    engine::ParallelFor(0, thread_count, 1, thread_count, [&](const int64_t b, const int64_t e) {
+      for (int64_t i = b; i < e; ++i) {
+        pairs[i] = seq_reduce_assign_block<Reducer, ndim, AType, DType, OType, OP, IndexOP>(
+            i * (M / thread_count),
+            i < (thread_count - 1) ? (M / thread_count) : (M / thread_count) + M % thread_count,
+            j,
+            big,
+            rshape,
+            rstride);
+      }
+    });
     for (int i = 0; i < thread_count; ++i) {
       Reducer::Merge(val, residual, pairs[i].first, pairs[i].second);
     }
@@ -406,25 +483,323 @@ inline int fastest_stride(const TShape& small, const TShape& big, const TShape&
 
 }  // namespace
 
+/*!
+ * \brief classifies a binary broadcast by the compacted shapes of its operands
+ * \param lhs_bcast set to whether the broadcast operand is the left hand side one
+ * \param inner set to the inner size binary_broadcast_pattern_kernel runs with
+ * \return the BroadcastPattern of the operands
+ */
+inline int BinaryBroadcastPattern(const mxnet::TShape& lshape,
+                                  const mxnet::TShape& rshape,
+                                  const mxnet::TShape& oshape,
+                                  bool* lhs_bcast,
+                                  index_t* inner) {
+  using namespace mxnet_op;
+  if (oshape.Size() == 0 || (lshape != oshape && rshape != oshape))
+    return kBroadcastGeneral;
+  *lhs_bcast                = rshape == oshape;
+  const mxnet::TShape& bcast = *lhs_bcast ? lshape : rshape;
+  if (bcast.Size() == 1) {
+    *inner = oshape.Size();
+    return kBroadcastScalar;
+  }
+  // the compaction leaves the broadcast axes first, followed by axes of size 1
+  const int ndim = oshape.ndim();
+  if (ndim < 2 || oshape.Size() != oshape[0] * oshape[1])
+    return kBroadcastGeneral;
+  *inner = oshape[1];
+  if (bcast[0] == 1 && bcast[1] == oshape[1])
+    return kBroadcastRow;
+  if (bcast[0] == oshape[0] && bcast[1] == 1)
+    return kBroadcastColumn;
+  return kBroadcastGeneral;
+}
+
+template <int pattern, int req, typename OP, typename LType, typename RType, typename OType>
+void BinaryBroadcastPatternLaunch(Stream<cpu>* s,
+                                  const bool lhs_bcast,
+                                  const index_t size,
+                                  const index_t inner,
+                                  LType* lhs,
+                                  RType* rhs,
+                                  OType* out) {
+  using namespace mxnet_op;
+  if (lhs_bcast) {
+    Kernel<binary_broadcast_pattern_kernel<pattern, true, req, OP>, cpu>::LaunchEx(
+        s, size, inner, lhs, rhs, out);
+  } else {
+    Kernel<binary_broadcast_pattern_kernel<pattern, false, req, OP>, cpu>::LaunchEx(
+        s, size, inner, lhs, rhs, out);
+  }
+}
+
+/*!
+ * \brief launches the kernel of a binary broadcast of compacted shapes, the pattern of the
+ *  operands being classified once here rather than by the coordinates of every element
+ */
+template <int ndim, typename OP, typename LType, typename RType, typename OType>
+void BinaryBroadcastLaunch(Stream<cpu>* s,
+                           const OpReqType req,
+                           const mxnet::TShape& lshape,
+                           const mxnet::TShape& rshape,
+                           const mxnet::TShape& oshape,
+                           LType* lhs,
+                           RType* rhs,
+                           OType* out) {
+  using namespace mxnet_op;
+  bool lhs_bcast;
+  index_t inner;
+  const int pattern  = BinaryBroadcastPattern(lshape, rshape, oshape, &lhs_bcast, &inner);
+  const index_t size = oshape.Size();
+  if (pattern != kBroadcastGeneral) {
+    MXNET_ASSIGN_REQ_SWITCH(req, Req, {
+      switch (pattern) {
+        case kBroadcastScalar:
+          BinaryBroadcastPatternLaunch<kBroadcastScalar, Req, OP>(
+              s, lhs_bcast, size, inner, lhs, rhs, out);
+          break;
+        case kBroadcastRow:
+          BinaryBroadcastPatternLaunch<kBroadcastRow, Req, OP>(
+              s, lhs_bcast, size, inner, lhs, rhs, out);
+          break;
+        default:
+          BinaryBroadcastPatternLaunch<kBroadcastColumn, Req, OP>(
+              s, lhs_bcast, size, inner, lhs, rhs, out);
+          break;
+      }
+    });
+    return;
+  }
+  Shape<ndim> oshape_nd = oshape.get<ndim>();
+  Shape<ndim> lstride   = calc_stride(lshape.get<ndim>());
+  Shape<ndim> rstride   = calc_stride(rshape.get<ndim>());
+  Kernel<binary_broadcast_kernel<ndim, OP>, cpu>::template LaunchEx(
+      s, size, req, lstride, rstride, oshape_nd, lhs, rhs, out);
+}
+
 template <int ndim, typename DType, typename OP>
 void BinaryBroadcastComputeImpl(Stream<cpu>* s,
                                 const OpReqType req,
                                 const TBlob& lhs,
                                 const TBlob& rhs,
                                 const TBlob& out) {
-  mshadow::Shape<ndim> oshape  = out.shape_.get<ndim>();
-  mshadow::Shape<ndim> lstride = mxnet_op::calc_stride(lhs.shape_.get<ndim>());
-  mshadow::Shape<ndim> rstride = mxnet_op::calc_stride(rhs.shape_.get<ndim>());
-  mxnet_op::Kernel<mxnet_op::binary_broadcast_kernel<ndim, OP>, cpu>::template LaunchEx(
-      s,
-      out.shape_.Size(),
-      req,
-      lstride,
-      rstride,
-      oshape,
-      lhs.dptr<DType>(),
-      rhs.dptr<DType>(),
-      out.dptr<DType>());
+  BinaryBroadcastLaunch<ndim, OP>(s,
+                                  req,
+                                  lhs.shape_,
+                                  rhs.shape_,
+                                  out.shape_,
+                                  lhs.dptr<DType>(),
+                                  rhs.dptr<DType>(),
+                                  out.dptr<DType>());
+}
+
+/*! \brief independent accumulators of a contiguous run of the reduced axes */
+constexpr int kReduceLanes = 8;
+/*! \brief consecutive outputs a reduction over outer axes accumulates at once */
+constexpr index_t kReduceTile = 512;
+
+/*! \brief merges the accumulators [1, num) into the first one */
+template <typename Reducer, typename AType>
+inline void merge_reduce_lanes(AType* val, AType* residual, const int num) {
+  for (int q = 1; q < num; ++q) {
+    Reducer::Merge(val[0], residual[0], val[q], residual[q]);
+  }
+}
+
+/*!
+ * \brief reduces the elements [begin, end) of the reduced axes from big[j] into kReduceLanes
+ *  accumulators, the innermost reduced axis being contiguous and of length inner
+ */
+template <typename Reducer, int ndim, typename AType, typename DType, typename OP>
+inline void seq_reduce_lanes(const DType* __restrict big,
+                             const index_t j,
+                             const size_t begin,
+                             const size_t end,
+                             const size_t inner,
+                             const Shape<ndim>& rshape,
+                             const Shape<ndim>& rstride,
+                             AType* val,
+                             AType* residual) {
+  for (size_t k = begin; k < end;) {
+    const size_t len = std::min(end, (k / inner + 1) * inner) - k;
+    const DType* row = big + j + mxnet_op::dot(mxnet_op::unravel(k, rshape), rstride);
+    size_t l         = 0;
+    for (; l + kReduceLanes <= len; l += kReduceLanes) {
+      for (int q = 0; q < kReduceLanes; ++q) {
+        AType temp = OP::Map(row[l + q]);
+        Reducer::Reduce(val[q], temp, residual[q]);
+      }
+    }
+    for (; l < len; ++l) {
+      AType temp = OP::Map(row[l]);
+      Reducer::Reduce(val[0], temp, residual[0]);
+    }
+    k += len;
+  }
+}
+
+/*!
+ * \brief reduces the elements [begin, end) of the reduced axes from big[j] into width
+ *  consecutive outputs at once, the innermost axis being kept and contiguous
+ */
+template <typename Reducer, int ndim, typename AType, typename DType, typename OP>
+inline void seq_reduce_tile(const DType* __restrict big,
+                            const index_t j,
+                            const size_t begin,
+                            const size_t end,
+                            const index_t width,
+                            const Shape<ndim>& rshape,
+                            const Shape<ndim>& rstride,
+                            AType* val,
+                            AType* residual) {
+  for (size_t k = begin; k < end; ++k) {
+    const DType* row = big + j + mxnet_op::dot(mxnet_op::unravel(k, rshape), rstride);
+    for (index_t l = 0; l < width; ++l) {
+      AType temp = OP::Map(row[l]);
+      Reducer::Reduce(val[l], temp, residual[l]);
+    }
+  }
+}
+
+/*!
+ * \brief reductions whose innermost axis is contiguous, walking big in order
+ *
+ * If the innermost axis is reduced, an output reduces contiguous runs of it into independent
+ * accumulators. If it is kept, a tile of consecutive outputs is reduced at once, which reads rows
+ * instead of striding over them. When there are fewer outputs, or tiles, than threads, the
+ * threads reduce slices of the reduced axes whose partial results are merged.
+ * \return false if there is nothing to tile, the innermost axis or the reduction being trivial
+ */
+template <typename Reducer, int ndim, typename AType, typename DType, typename OType, typename OP>
+bool seq_reduce_compute_tiled(const size_t N,
+                              const size_t M,
+                              const bool addto,
+                              const DType* big,
+                              OType* small,
+                              const Shape<ndim>& bshape,
+                              const Shape<ndim>& sshape,
+                              const Shape<ndim>& rshape,
+                              const Shape<ndim>& rstride) {
+  const int thread_count = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const index_t inner    = bshape[ndim - 1];
+  if (inner == 1 || M <= 1) {
+    return false;
+  }
+  if (sshape[ndim - 1] == 1) {
+    // the innermost axis is reduced
+    auto reduce_output = [&](const index_t idx) {
+      const index_t j = mxnet_op::ravel(mxnet_op::unravel(idx, sshape), bshape);
+      AType val[kReduceLanes], residual[kReduceLanes];
+      if (N >= static_cast<size_t>(thread_count)) {
+        for (int q = 0; q < kReduceLanes; ++q) {
+          Reducer::SetInitValue(val[q], residual[q]);
+        }
+        seq_reduce_lanes<Reducer, ndim, AType, DType, OP>(
+            big, j, 0, M, inner, rshape, rstride, val, residual);
+        merge_reduce_lanes<Reducer>(val, residual, kReduceLanes);
+      } else {
+        auto vals      = std::make_unique<AType[]>(thread_count * kReduceLanes);
+        auto residuals = std::make_unique<AType[]>(thread_count * kReduceLanes);
+        engine::ParallelFor(0, thread_count, 1, thread_count, [&](int64_t b, int64_t e) {
+          for (int64_t t = b; t < e; ++t) {
+            AType* tval      = vals.get() + t * kReduceLanes;
+            AType* tresidual = residuals.get() + t * kReduceLanes;
+            for (int q = 0; q < kReduceLanes; ++q) {
+              Reducer::SetInitValue(tval[q], tresidual[q]);
+            }
+            seq_reduce_lanes<Reducer, ndim, AType, DType, OP>(big,
+                                                              j,
+                                                              M * t / thread_count,
+                                                              M * (t + 1) / thread_count,
+                                                              inner,
+                                                              rshape,
+                                                              rstride,
+                                                              tval,
+                                                              tresidual);
+            merge_reduce_lanes<Reducer>(tval, tresidual, kReduceLanes);
+          }
+        });
+        val[0]      = vals[0];
+        residual[0] = residuals[0];
+        for (int t = 1; t < thread_count; ++t) {
+          Reducer::Merge(val[0], residual[0], vals[t * kReduceLanes], residuals[t * kReduceLanes]);
+        }
+      }
+      Reducer::Finalize(val[0], residual[0]);
+      assign(&small[idx], addto, OType(val[0]));
+    };
+    if (N >= static_cast<size_t>(thread_count)) {
+      engine::ParallelFor(0, N, 1, thread_count, [&](const int64_t b, const int64_t e) {
+        for (index_t idx = b; idx < e; ++idx) {
+          reduce_output(idx);
+        }
+      });
+    } else {
+      for (index_t idx = 0; idx < static_cast<index_t>(N); ++idx) {
+        reduce_output(idx);
+      }
+    }
+    return true;
+  }
+  // the innermost axis is kept, tiles of consecutive outputs are reduced at once
+  const index_t tiles = (inner + kReduceTile - 1) / kReduceTile;
+  const index_t jobs  = static_cast<index_t>(N) / inner * tiles;
+
+  auto reduce_tile = [&](const index_t job, const bool split) {
+    const index_t first = job / tiles * inner + job % tiles * kReduceTile;
+    const index_t width = std::min(kReduceTile, inner - job % tiles * kReduceTile);
+    const index_t j     = mxnet_op::ravel(mxnet_op::unravel(first, sshape), bshape);
+    AType val[kReduceTile], residual[kReduceTile];
+    for (index_t l = 0; l < width; ++l) {
+      Reducer::SetInitValue(val[l], residual[l]);
+    }
+    if (!split) {
+      seq_reduce_tile<Reducer, ndim, AType, DType, OP>(
+          big, j, 0, M, width, rshape, rstride, val, residual);
+    } else {
+      auto vals      = std::make_unique<AType[]>(thread_count * width);
+      auto residuals = std::make_unique<AType[]>(thread_count * width);
+      engine::ParallelFor(0, thread_count, 1, thread_count, [&](int64_t b, int64_t e) {
+        for (int64_t t = b; t < e; ++t) {
+          AType* tval      = vals.get() + t * width;
+          AType* tresidual = residuals.get() + t * width;
+          for (index_t l = 0; l < width; ++l) {
+            Reducer::SetInitValue(tval[l], tresidual[l]);
+          }
+          seq_reduce_tile<Reducer, ndim, AType, DType, OP>(big,
+                                                           j,
+                                                           M * t / thread_count,
+                                                           M * (t + 1) / thread_count,
+                                                           width,
+                                                           rshape,
+                                                           rstride,
+                                                           tval,
+                                                           tresidual);
+        }
+      });
+      for (int t = 0; t < thread_count; ++t) {
+        for (index_t l = 0; l < width; ++l) {
+          Reducer::Merge(val[l], residual[l], vals[t * width + l], residuals[t * width + l]);
+        }
+      }
+    }
+    for (index_t l = 0; l < width; ++l) {
+      Reducer::Finalize(val[l], residual[l]);
+      assign(&small[first + l], addto, OType(val[l]));
+    }
+  };
+  if (jobs >= thread_count) {
+    engine::ParallelFor(0, jobs, 1, thread_count, [&](const int64_t b, const int64_t e) {
+      for (index_t job = b; job < e; ++job) {
+        reduce_tile(job, false);
+      }
+    });
+  } else {
+    for (index_t job = 0; job < jobs; ++job) {
+      reduce_tile(job, true);
+    }
+  }
+  return true;
 }
 
 template <typename Reducer,
@@ -443,13 +818,18 @@ void seq_reduce_compute(const size_t N,
                         const Shape<ndim> sshape,
                         const Shape<ndim> rshape,
                         const Shape<ndim> rstride) {
+  if (!IndexOP::do_op && seq_reduce_compute_tiled<Reducer, ndim, AType, DType, OType, OP>(
+                             N, M, addto, big, small, bshape, sshape, rshape, rstride)) {
+    return;
+  }
   const int thread_count = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
   if (N >= thread_count) {
-#pragma omp parallel for num_threads(thread_count)
-    for (index_t idx = 0; idx < static_cast<index_t>(N); ++idx) {
-      seq_reduce_assign<Reducer, ndim, AType, DType, OType, OP, IndexOP>(
-          idx, M, addto, big, small, bshape, sshape, rshape, rstride, false);
-    }
+    engine::ParallelFor(0, N, 1, thread_count, [&](const int64_t b, const int64_t e) {
+      for (index_t idx = b; idx < e; ++idx) {
+        seq_reduce_assign<Reducer, ndim, AType, DType, OType, OP, IndexOP>(
+            idx, M, addto, big, small, bshape, sshape, rshape, rstride, false);
+      }
+    });
   } else {
     for (index_t idx = 0; idx < static_cast<index_t>(N); ++idx) {
       seq_reduce_assign<Reducer, ndim, AType, DType, OType, OP, IndexOP>(
@@ -469,17 +849,19 @@ void seq_reduce_compute_extra_mem(const size_t N,
                                   const Shape<ndim> rshape,
                                   const Shape<ndim> rstride,
                                   const index_t* ws_dptr) {
-#pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
-  for (index_t idx = 0; idx < static_cast<index_t>(N); ++idx) {
-    Shape<ndim> coord = mxnet_op::unravel(idx, sshape);
-    index_t j         = mxnet_op::ravel(coord, bshape);
-    DType val, residual;
-    Reducer::SetInitValue(val, residual);
-    for (size_t k = 0; k < M; ++k) {
-      Reducer::Reduce(val, OP::Map(big[j + ws_dptr[k]]), residual);
+  const int thread_count = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  engine::ParallelFor(0, N, 1, thread_count, [&](const int64_t b, const int64_t e) {
+    for (index_t idx = b; idx < e; ++idx) {
+      Shape<ndim> coord = mxnet_op::unravel(idx, sshape);
+      index_t j         = mxnet_op::ravel(coord, bshape);
+      DType val, residual;
+      Reducer::SetInitValue(val, residual);
+      for (size_t k = 0; k < M; ++k) {
+        Reducer::Reduce(val, OP::Map(big[j + ws_dptr[k]]), residual);
+      }
+      assign(&small[idx], addto, val);
     }
-    assign(&small[idx], addto, val);
-  }
+  });
 }
 
 template <typename Reducer, int ndim, typename DType, typename OP, bool safe_acc = false>
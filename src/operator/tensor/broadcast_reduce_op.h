@@ -2117,6 +2117,7 @@ Defined in )code";
       .set_attr_parser(AxesParamParser<ReduceAxesParam>)            \
       .set_attr<mxnet::FInferShape>("FInferShape", ReduceAxesShape) \
       .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<1, 1>) \
+      .set_attr<FOpCost>("FOpCost", ElemwiseCost)                   \
       .add_argument("data", "NDArray-or-Symbol", "The input")       \
       .add_arguments(ReduceAxesParam::__FIELDS__())
 
@@ -2127,6 +2128,7 @@ Defined in )code";
       .set_attr_parser(AxesParamParser<ReduceAxesParam>)                  \
       .set_attr<mxnet::FInferShape>("FInferShape", ReduceMinMaxAxesShape) \
       .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<1, 1>)       \
+      .set_attr<FOpCost>("FOpCost", ElemwiseCost)                         \
       .add_argument("data", "NDArray-or-Symbol", "The input")             \
       .add_arguments(ReduceAxesParam::__FIELDS__())
 
@@ -608,6 +608,33 @@ inline void CastStorageDnsCsrImpl(const OpContext& ctx,
   });
 }
 
+/*!
+ * \brief GPU inclusive prefix sum of the block counts of a bsr indptr, which returns the
+ *        number of non-zero blocks.
+ */
+template <typename IType>
+inline IType BsrIndPtrPrefixSum(const OpContext& ctx,
+                                const gpu& gpu_dev,
+                                IType* indptr,
+                                const nnvm::dim_t num_block_rows) {
+  using mshadow::Shape1;
+  mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+  cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
+  size_t temp_storage_bytes = 0;
+  cub::DeviceScan::InclusiveSum(nullptr, temp_storage_bytes, indptr, indptr,
+                                num_block_rows + 1, stream);
+  CHECK_GT(ctx.requested.size(), 0);
+  auto workspace = ctx.requested[ctx.requested.size() - 1].
+      get_space_typed<gpu, 1, char>(Shape1(temp_storage_bytes), s);
+  cub::DeviceScan::InclusiveSum(workspace.dptr_, temp_storage_bytes, indptr, indptr,
+                                num_block_rows + 1, stream);
+  IType nnz = 0;
+  CUDA_CALL(cudaMemcpyAsync(&nnz, &(indptr[num_block_rows]), sizeof(IType),
+                            cudaMemcpyDeviceToHost, stream));
+  CUDA_CALL(cudaStreamSynchronize(stream));
+  return nnz;
+}
+
 }  // namespace op
 }  // namespace mxnet
 
@@ -42,33 +42,36 @@ namespace mxnet {
 namespace op {
 
 /*!
- * \brief CPU Kernel for marking row_idx of a RSP tensor per row.
+ * \brief Returns whether the n elements from data are all zeros. The elements are tested a
+ *        vector sized block at a time, so that the test vectorizes and still stops at the
+ *        first block holding a non-zero.
  */
-struct MarkRspRowIdx {
-  // i represents the row index of the tensor data
-  template <typename DType, typename RType>
-  MSHADOW_CINLINE static void Map(int i,
-                                  RType* row_idx,
-                                  const DType* data,
-                                  const nnvm::dim_t row_length) {
-    using nnvm::dim_t;
-    dim_t j      = 0;
-    dim_t offset = i * row_length;
-    for (; j < row_length; ++j) {
-      if (data[offset + j] != 0) {
-        break;
-      }
-    }
-    if (row_length == j) {
-      row_idx[i] = 0;  // mark as zero for zero row
-    } else {
-      row_idx[i] = 1;  // mark as one for non-zero row
+template <typename DType>
+MSHADOW_CINLINE bool IsAllZeros(const DType* data, const nnvm::dim_t n) {
+  using nnvm::dim_t;
+  constexpr dim_t kBlock = 64;
+  dim_t j                = 0;
+  for (; j + kBlock <= n; j += kBlock) {
+    int nonzero = 0;
+#pragma omp simd reduction(| : nonzero)
+    for (dim_t k = 0; k < kBlock; ++k) {
+      nonzero |= data[j + k] != 0;
     }
+    if (nonzero)
+      return false;
   }
-};
+  for (; j < n; ++j) {
+    if (data[j] != 0)
+      return false;
+  }
+  return true;
+}
 
 /*!
  * \brief CPU implementation of casting a dns tensor to rsp type.
+ *        Each thread stages the indices of the non-zero rows of its contiguous chunk of rows.
+ *        The offsets of the chunks then give the rows of the rsp tensor, which the threads fill
+ *        in parallel, so that the dns tensor is scanned once.
  */
 inline void CastStorageDnsRspImpl(const OpContext& ctx,
                                   const cpu& cpu_dev,
@@ -80,34 +83,48 @@ inline void CastStorageDnsRspImpl(const OpContext& ctx,
   CHECK(rsp != nullptr);
   CHECK_EQ(rsp->storage_type(), kRowSparseStorage);
   CHECK_EQ(dns.shape_, rsp->shape());
-  mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
   MSHADOW_TYPE_SWITCH(dns.type_flag_, DType, {             // data type
     MSHADOW_IDX_TYPE_SWITCH(rsp->aux_type(kIdx), RType, {  // row idx type
       const dim_t num_rows   = dns.shape_[0];
       const dim_t row_length = dns.shape_.ProdShape(1, dns.shape_.ndim());
-      rsp->CheckAndAllocAuxData(kIdx, Shape1(num_rows));
-      TBlob row_idx_blob = rsp->aux_data(kIdx);
-      RType* row_idx     = row_idx_blob.dptr<RType>();
-      dim_t num_threads  = num_rows;
-      mxnet_op::Kernel<MarkRspRowIdx, cpu>::Launch(
-          s, num_threads, row_idx, dns.dptr<DType>(), row_length);
-      dim_t nnr = 0;
-      nnr       = common::ParallelAccumulate(row_idx, num_rows, nnr);
-      rsp->set_aux_shape(kIdx, Shape1(nnr));
+      const DType* dns_data  = dns.dptr<DType>();
+      const int num_threads  = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+      std::vector<std::vector<RType>> staged(num_threads);
+#pragma omp parallel num_threads(num_threads)
+      {
+        const int tid      = omp_get_thread_num();
+        const int nthreads = omp_get_num_threads();
+        const dim_t chunk  = (num_rows + nthreads - 1) / nthreads;
+        const dim_t begin  = std::min(num_rows, tid * chunk);
+        const dim_t end    = std::min(num_rows, begin + chunk);
+
+        std::vector<RType>& rows = staged[tid];
+        for (dim_t i = begin; i < end; ++i) {
+          if (!IsAllZeros(dns_data + i * row_length, row_length))
+            rows.push_back(static_cast<RType>(i));
+        }
+      }
+      std::vector<dim_t> offsets(num_threads + 1, 0);
+      for (int t = 0; t < num_threads; ++t) {
+        offsets[t + 1] = offsets[t] + staged[t].size();
+      }
+      const dim_t nnr = offsets[num_threads];
+      rsp->CheckAndAllocAuxData(kIdx, Shape1(nnr));
       if (0 == nnr)
         return;
       auto storage_shape = dns.shape_;
       storage_shape[0]   = nnr;
       rsp->CheckAndAllocData(storage_shape);
-      auto dns_data = dns.get_with_shape<cpu, 2, DType>(Shape2(num_rows, row_length), s);
-      auto rsp_data = rsp->data().get_with_shape<cpu, 2, DType>(Shape2(nnr, row_length), s);
-      dim_t idx     = 0;
-      for (dim_t i = 0; i < num_rows; ++i) {
-        if (row_idx[i] > 0) {
-          row_idx[idx] = i;
-          Copy(rsp_data[idx], dns_data[i], s);
-          ++idx;
-        }
+      RType* row_idx  = rsp->aux_data(kIdx).dptr<RType>();
+      DType* rsp_data = rsp->data().dptr<DType>();
+#pragma omp parallel for num_threads(num_threads)
+      for (int t = 0; t < num_threads; ++t) {
+        std::copy(staged[t].begin(), staged[t].end(), row_idx + offsets[t]);
+      }
+#pragma omp parallel for num_threads(num_threads)
+      for (dim_t j = 0; j < nnr; ++j) {
+        const DType* src = dns_data + static_cast<dim_t>(row_idx[j]) * row_length;
+        std::copy(src, src + row_length, rsp_data + j * row_length);
       }
     });
   });
@@ -179,13 +196,13 @@ struct FillCsrIndPtr {
                                   const nnvm::dim_t num_rows,
                                   const nnvm::dim_t num_cols) {
     using nnvm::dim_t;
-    indptr[i + 1]      = 0;
-    const dim_t offset = i * num_cols;
+    const DType* row = dns + static_cast<dim_t>(i) * num_cols;
+    dim_t nnz        = 0;
+#pragma omp simd reduction(+ : nnz)
     for (dim_t j = 0; j < num_cols; ++j) {
-      if (dns[offset + j] != 0) {
-        ++indptr[i + 1];
-      }
+      nnz += row[j] != 0;
     }
+    indptr[i + 1] = nnz;
   }
 };
 
@@ -212,13 +229,22 @@ struct FillCsrColIdxAndVals {
                                   const nnvm::dim_t num_rows,
                                   const nnvm::dim_t num_cols) {
     using nnvm::dim_t;
-    const dim_t offset = i * num_cols;
-    IType k            = indptr[i];
-    for (dim_t j = 0; j < num_cols; ++j) {
-      if (dns[offset + j] != 0) {
-        val[k]     = dns[offset + j];
-        col_idx[k] = j;
-        ++k;
+    constexpr dim_t kBlock = 64;
+    const DType* row       = dns + static_cast<dim_t>(i) * num_cols;
+    IType k                = indptr[i];
+    if (k == indptr[i + 1])
+      return;
+    for (dim_t j0 = 0; j0 < num_cols; j0 += kBlock) {
+      const dim_t j1 = std::min(num_cols, j0 + kBlock);
+      // skip the blocks of zeros with a vectorized test
+      if (IsAllZeros(row + j0, j1 - j0))
+        continue;
+      for (dim_t j = j0; j < j1; ++j) {
+        if (row[j] != 0) {
+          val[k]     = row[j];
+          col_idx[k] = j;
+          ++k;
+        }
       }
     }
   }
@@ -249,12 +275,9 @@ inline void CastStorageDnsCsrImpl(const OpContext& ctx,
         dim_t num_threads = num_rows;
         mxnet_op::Kernel<FillCsrIndPtr, cpu>::Launch(
             s, num_threads, indptr, dns_data, num_rows, num_cols);
-        // single thread to accumulate indptr
         // indptr[num_rows] indicates the number of non-zero elements
         indptr[0] = 0;
-        for (dim_t i = 0; i < num_rows; ++i) {
-          indptr[i + 1] += indptr[i];
-        }
+        common::ParallelPrefixSum(indptr, num_rows + 1);
         // allocate column idx array and value array
         csr->CheckAndAllocAuxData(csr::kIdx, Shape1(static_cast<index_t>(indptr[num_rows])));
         csr->CheckAndAllocData(Shape1(static_cast<index_t>(indptr[num_rows])));
@@ -372,6 +395,239 @@ void CastStorageRspRspImpl(const OpContext& ctx, const NDArray& rsp, NDArray* ou
   mxnet_op::copy(s, idx, from_idx);
 }
 
+/*!
+ * \brief Kernel for counting the non-zero blocks of each block row of a dns matrix.
+ */
+struct FillBsrIndPtr {
+  /*!
+   * \brief
+   * \param i           the i-th block row of the dns tensor
+   * \param indptr      the indptr of the bsr tensor
+   * \param dns         the dns tensor
+   * \param num_cols    number of columns of the dns tensor
+   * \param block_rows  number of rows of a block
+   * \param block_cols  number of columns of a block
+   */
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  IType* indptr,
+                                  const DType* dns,
+                                  const nnvm::dim_t num_cols,
+                                  const nnvm::dim_t block_rows,
+                                  const nnvm::dim_t block_cols) {
+    using nnvm::dim_t;
+    if (i == 0)
+      indptr[0] = 0;
+    indptr[i + 1]      = 0;
+    const DType* block = dns + i * block_rows * num_cols;
+    for (dim_t j = 0; j < num_cols; j += block_cols) {
+      bool nonzero = false;
+      for (dim_t r = 0; r < block_rows && !nonzero; ++r) {
+        for (dim_t c = 0; c < block_cols && !nonzero; ++c)
+          nonzero = block[r * num_cols + j + c] != 0;
+      }
+      if (nonzero)
+        ++indptr[i + 1];
+    }
+  }
+};
+
+/*!
+ * \brief Kernel for filling the block column idx and the blocks of a bsr matrix.
+ */
+struct FillBsrColIdxAndVals {
+  /*!
+   * \brief
+   * \param i           the i-th block row of the dns tensor
+   * \param val         blocks of the bsr tensor
+   * \param col_idx     block column idx array of the bsr tensor
+   * \param indptr      indptr array of the bsr tensor
+   * \param dns         dns tensor
+   * \param num_cols    number of columns of the dns tensor
+   * \param block_rows  number of rows of a block
+   * \param block_cols  number of columns of a block
+   */
+  template <typename DType, typename IType, typename CType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* val,
+                                  CType* col_idx,
+                                  const IType* indptr,
+                                  const DType* dns,
+                                  const nnvm::dim_t num_cols,
+                                  const nnvm::dim_t block_rows,
+                                  const nnvm::dim_t block_cols) {
+    using nnvm::dim_t;
+    const DType* block = dns + i * block_rows * num_cols;
+    IType k            = indptr[i];
+    for (dim_t j = 0; j < num_cols; j += block_cols) {
+      bool nonzero = false;
+      for (dim_t r = 0; r < block_rows && !nonzero; ++r) {
+        for (dim_t c = 0; c < block_cols && !nonzero; ++c)
+          nonzero = block[r * num_cols + j + c] != 0;
+      }
+      if (!nonzero)
+        continue;
+      DType* dst = val + k * block_rows * block_cols;
+      for (dim_t r = 0; r < block_rows; ++r) {
+        for (dim_t c = 0; c < block_cols; ++c)
+          dst[r * block_cols + c] = block[r * num_cols + j + c];
+      }
+      col_idx[k] = j / block_cols;
+      ++k;
+    }
+  }
+};
+
+/*!
+ * \brief CPU inclusive prefix sum of the block counts of a bsr indptr, which returns the
+ *        number of non-zero blocks.
+ */
+template <typename IType>
+inline IType BsrIndPtrPrefixSum(const OpContext& ctx,
+                                const cpu& cpu_dev,
+                                IType* indptr,
+                                const nnvm::dim_t num_block_rows) {
+  for (nnvm::dim_t i = 0; i < num_block_rows; ++i) {
+    indptr[i + 1] += indptr[i];
+  }
+  return indptr[num_block_rows];
+}
+
+/*!
+ * \brief Casts a dns matrix to bsr type, with the block shape of the storage shape of the bsr.
+ *        Zero blocks are not retained.
+ */
+template <typename xpu>
+void CastStorageDnsBsrImpl(const OpContext& ctx, const TBlob& dns, NDArray* bsr) {
+  CHECK(bsr != nullptr);
+  CHECK_EQ(bsr->storage_type(), kBSRStorage);
+  CHECK_EQ(dns.shape_.ndim(), 2);
+  CHECK_EQ(dns.shape_, bsr->shape());
+  using mshadow::Shape1;
+  using mshadow::Shape3;
+  using nnvm::dim_t;
+  const dim_t block_rows = bsr->storage_shape()[1];
+  const dim_t block_cols = bsr->storage_shape()[2];
+  const dim_t num_rows   = dns.shape_[0];
+  const dim_t num_cols   = dns.shape_[1];
+  CHECK(num_rows % block_rows == 0 && num_cols % block_cols == 0)
+      << "The shape " << dns.shape_ << " is not a multiple of the block shape (" << block_rows
+      << ", " << block_cols << ")";
+  const dim_t num_block_rows = num_rows / block_rows;
+  mshadow::Stream<xpu>* s    = ctx.get_stream<xpu>();
+  MSHADOW_TYPE_SWITCH(dns.type_flag_, DType, {                     // data type
+    MSHADOW_IDX_TYPE_SWITCH(bsr->aux_type(bsr::kIndPtr), IType, {  // indptr type
+      MSHADOW_IDX_TYPE_SWITCH(bsr->aux_type(bsr::kIdx), CType, {   // col idx type
+        bsr->CheckAndAllocAuxData(bsr::kIndPtr, Shape1(num_block_rows + 1));
+        IType* indptr   = bsr->aux_data(bsr::kIndPtr).dptr<IType>();
+        DType* dns_data = dns.dptr<DType>();
+        mxnet_op::Kernel<FillBsrIndPtr, xpu>::Launch(
+            s, num_block_rows, indptr, dns_data, num_cols, block_rows, block_cols);
+        const dim_t nnz = BsrIndPtrPrefixSum(ctx, xpu(), indptr, num_block_rows);
+        // allocate block column idx array and blocks
+        bsr->CheckAndAllocAuxData(bsr::kIdx, Shape1(nnz));
+        bsr->CheckAndAllocData(Shape3(nnz, block_rows, block_cols));
+        mxnet_op::Kernel<FillBsrColIdxAndVals, xpu>::Launch(s,
+                                                            num_block_rows,
+                                                            bsr->data().dptr<DType>(),
+                                                            bsr->aux_data(bsr::kIdx).dptr<CType>(),
+                                                            indptr,
+                                                            dns_data,
+                                                            num_cols,
+                                                            block_rows,
+                                                            block_cols);
+      });
+    });
+  });
+}
+
+/*!
+ * \brief This is the kernel for copying the blocks of a bsr to its corresponding dns matrix.
+ */
+struct CopyBsrDataToDns {
+  /*!
+   * \brief
+   * \param i           the i-th block row of the dns tensor
+   * \param dns_data    data blob of the dns tensor
+   * \param col_idx     block column idx array of the bsr tensor
+   * \param indptr      indptr array of the bsr tensor
+   * \param bsr_data    blocks of the bsr tensor
+   * \param num_cols    number of columns of the dns tensor
+   * \param block_rows  number of rows of a block
+   * \param block_cols  number of columns of a block
+   */
+  template <typename DType, typename IType, typename CType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* dns_data,
+                                  const CType* col_idx,
+                                  const IType* indptr,
+                                  const DType* bsr_data,
+                                  const nnvm::dim_t num_cols,
+                                  const nnvm::dim_t block_rows,
+                                  const nnvm::dim_t block_cols) {
+    using nnvm::dim_t;
+    DType* block_row = dns_data + i * block_rows * num_cols;
+    for (IType k = indptr[i]; k < indptr[i + 1]; ++k) {
+      DType* dst       = block_row + col_idx[k] * block_cols;
+      const DType* src = bsr_data + k * block_rows * block_cols;
+      for (dim_t r = 0; r < block_rows; ++r) {
+        for (dim_t c = 0; c < block_cols; ++c)
+          dst[r * num_cols + c] = src[r * block_cols + c];
+      }
+    }
+  }
+};
+
+/*!
+ * \brief Casts a bsr matrix to dns format.
+ */
+template <typename xpu>
+void CastStorageBsrDnsImpl(const OpContext& ctx, const NDArray& bsr, TBlob* dns) {
+  CHECK(dns != nullptr);
+  CHECK_EQ(bsr.storage_type(), kBSRStorage);
+  CHECK_EQ(dns->shape_.ndim(), 2);
+  CHECK_EQ(dns->shape_, bsr.shape());
+  using nnvm::dim_t;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  MSHADOW_TYPE_SWITCH(dns->type_flag_, DType, {                   // data type
+    MSHADOW_IDX_TYPE_SWITCH(bsr.aux_type(bsr::kIndPtr), IType, {  // indptr type
+      MSHADOW_IDX_TYPE_SWITCH(bsr.aux_type(bsr::kIdx), CType, {   // col idx type
+        DType* dns_data = dns->dptr<DType>();
+        mxnet_op::Kernel<mxnet_op::set_zero, xpu>::Launch(s, dns->shape_.Size(), dns_data);
+        if (!bsr.storage_initialized())
+          return;
+        const dim_t block_rows = bsr.storage_shape()[1];
+        const dim_t block_cols = bsr.storage_shape()[2];
+        mxnet_op::Kernel<CopyBsrDataToDns, xpu>::Launch(s,
+                                                        dns->shape_[0] / block_rows,
+                                                        dns_data,
+                                                        bsr.aux_data(bsr::kIdx).dptr<CType>(),
+                                                        bsr.aux_data(bsr::kIndPtr).dptr<IType>(),
+                                                        bsr.data().dptr<DType>(),
+                                                        dns->shape_[1],
+                                                        block_rows,
+                                                        block_cols);
+      });
+    });
+  });
+}
+
+/*!
+ * \brief Casts a bsr matrix to another bsr, which takes the block shape of the source.
+ */
+template <typename xpu>
+void CastStorageBsrBsrImpl(const OpContext& ctx, const NDArray& bsr, NDArray* output) {
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  output->CheckAndAllocAuxData(bsr::kIndPtr, bsr.aux_shape(bsr::kIndPtr));
+  output->CheckAndAllocAuxData(bsr::kIdx, bsr.aux_shape(bsr::kIdx));
+  output->CheckAndAllocData(bsr.storage_shape());
+  mxnet_op::copy(s, output->aux_data(bsr::kIndPtr), bsr.aux_data(bsr::kIndPtr));
+  if (!bsr.storage_initialized())
+    return;
+  mxnet_op::copy(s, output->data(), bsr.data());
+  mxnet_op::copy(s, output->aux_data(bsr::kIdx), bsr.aux_data(bsr::kIdx));
+}
+
 template <typename xpu>
 void CastStorageComputeImpl(const OpContext& ctx, const NDArray& input, const NDArray& output) {
   const auto src_stype = input.storage_type();
@@ -394,6 +650,15 @@ void CastStorageComputeImpl(const OpContext& ctx, const NDArray& input, const ND
   } else if (src_stype == kRowSparseStorage && dst_stype == kRowSparseStorage) {
     NDArray ret = output;
     CastStorageRspRspImpl<xpu>(ctx, input, &ret);
+  } else if (src_stype == kDefaultStorage && dst_stype == kBSRStorage) {
+    NDArray ret = output;  // get rid of the const qualifer
+    CastStorageDnsBsrImpl<xpu>(ctx, input.data(), &ret);
+  } else if (src_stype == kBSRStorage && dst_stype == kDefaultStorage) {
+    TBlob ret = output.data();
+    CastStorageBsrDnsImpl<xpu>(ctx, input, &ret);
+  } else if (src_stype == kBSRStorage && dst_stype == kBSRStorage) {
+    NDArray ret = output;
+    CastStorageBsrBsrImpl<xpu>(ctx, input, &ret);
 #if MXNET_USE_ONEDNN == 1
   } else if (src_stype == kDefaultStorage && dst_stype == kDefaultStorage) {
     CHECK_EQ(output.ctx().dev_type, input.ctx().dev_type);
@@ -418,12 +683,19 @@ void CastStorageComputeImpl(const OpContext& ctx, const NDArray& input, const ND
 
 struct CastStorageParam : public dmlc::Parameter<CastStorageParam> {
   int stype;
+  mxnet::Tuple<int> block_shape;
   DMLC_DECLARE_PARAMETER(CastStorageParam) {
     DMLC_DECLARE_FIELD(stype)
         .add_enum("default", kDefaultStorage)
         .add_enum("row_sparse", kRowSparseStorage)
         .add_enum("csr", kCSRStorage)
+        .add_enum("bsr", kBSRStorage)
         .describe("Output storage type.");
+    DMLC_DECLARE_FIELD(block_shape)
+        .set_default(mxnet::Tuple<int>())
+        .describe(
+            "The (rows, columns) shape of the blocks of a dense input cast to bsr, "
+            "(1, 1) by default.");
   }
 };
 
@@ -470,6 +742,12 @@ inline bool CastStorageInferStorageType(const nnvm::NodeAttrs& attrs,
     dispatched =
         storage_type_assign(out_attrs, param_stype, dispatch_mode, DispatchMode::kFComputeEx);
   }
+  if (!dispatched && (in_stype == kDefaultStorage || in_stype == kBSRStorage) &&
+      (param_stype == kBSRStorage || param_stype == kDefaultStorage)) {
+    // dns -> bsr, bsr -> bsr, bsr -> dns
+    dispatched =
+        storage_type_assign(out_attrs, param_stype, dispatch_mode, DispatchMode::kFComputeEx);
+  }
   return dispatched;
 }
 
@@ -484,6 +762,17 @@ void CastStorageComputeEx(const nnvm::NodeAttrs& attrs,
   if (req[0] == kNullOp)
     return;
   CHECK_EQ(req[0], kWriteTo) << "CastStorageComputeEx expects req[0] == kWriteTo";
+  const CastStorageParam& param = nnvm::get<CastStorageParam>(attrs.parsed);
+  if (inputs[0].storage_type() == kDefaultStorage && outputs[0].storage_type() == kBSRStorage) {
+    // the empty blocks of the output set its block shape
+    const mxnet::Tuple<int>& block = param.block_shape;
+    CHECK(block.ndim() == 0 || block.ndim() == 2)
+        << "block_shape must be (rows, columns), got " << block;
+    const NDArray& bsr = outputs[0];
+    bsr.CheckAndAllocAuxData(bsr::kIdx, mshadow::Shape1(0));
+    bsr.CheckAndAllocData(block.ndim() == 2 ? mshadow::Shape3(0, block[0], block[1]) :
+                                              mshadow::Shape3(0, 1, 1));
+  }
   CastStorageComputeImpl<xpu>(ctx, inputs[0], outputs[0]);
 }
 
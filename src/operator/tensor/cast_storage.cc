@@ -39,6 +39,7 @@ the result is compact, which means:
 
 - for csr, zero values will not be retained
 - for row_sparse, row slices of all zeros will not be retained
+- for bsr, the blocks of ``block_shape`` of all zeros will not be retained
 
 The storage type of ``cast_storage`` output depends on stype parameter:
 
@@ -48,6 +49,9 @@ The storage type of ``cast_storage`` output depends on stype parameter:
 - cast_storage(default, 'row_sparse') = row_sparse
 - cast_storage(csr, 'csr') = csr
 - cast_storage(row_sparse, 'row_sparse') = row_sparse
+- cast_storage(default, 'bsr') = bsr
+- cast_storage(bsr, 'default') = default
+- cast_storage(bsr, 'bsr') = bsr
 
 Example::
 
@@ -68,6 +72,13 @@ Example::
     csr.values = [ 1.,  2.,  3.]
     csr.indptr = [0, 1, 3, 3, 3]
 
+    # cast to bsr storage type with 2x3 blocks
+    bsr = cast_storage(dense, 'bsr', block_shape=(2, 3))
+    bsr.indices = [0]
+    bsr.values = [[[ 0.,  1.,  0.],
+                   [ 2.,  0.,  3.]]]
+    bsr.indptr = [0, 1, 1]
+
 )code" ADD_FILELINE)
     .set_num_inputs(1)
     .set_num_outputs(1)
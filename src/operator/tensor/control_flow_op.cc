@@ -53,6 +53,10 @@ Examples::
 
   where(csr_cond, x, y) = [[5, 2], [3, 8]]
 
+  rsp_cond = cast_storage(cond, 'row_sparse')
+
+  where(rsp_cond, x, y) = [[5, 2], [3, 8]]
+
 )code" ADD_FILELINE)
     .set_num_inputs(3)
     .set_num_outputs(1)
@@ -86,6 +86,32 @@ struct where_csr {
   }
 };
 
+/*! \brief Choose elements from x or y depending on condition.
+ * The condition is a row_sparse array, while x and y are both dense.
+ * It either has the shape of x, or is a vector whose size is x's first dim size,
+ * in which case cond_stride is the size of a row of x, otherwise 1.
+ */
+template <int req>
+struct where_rsp {
+  // DType is the output data type
+  // CType is condition data type
+  // i is for i-th element of the rows of x selected by the stored rows of the condition
+  template <typename DType, typename CType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const IType* cond_idx,
+                                  const CType* cond_data,
+                                  const nnvm::dim_t row_size,
+                                  const nnvm::dim_t cond_stride,
+                                  const DType* x) {
+    using nnvm::dim_t;
+    if (cond_data[i / cond_stride] != 0) {
+      const dim_t out_idx = static_cast<dim_t>(cond_idx[i / row_size]) * row_size + i % row_size;
+      KERNEL_ASSIGN(out[out_idx], req, x[out_idx]);
+    }
+  }
+};
+
 /*! \brief Choose elements from x or y depending on condition
  * The condition is a vector whose size is the same as the
  * x's first dim size.
@@ -157,6 +183,36 @@ struct where_backward_csr {
   }
 };
 
+/*!
+ * \brief Template for calculating grad[x] and grad[y].
+ * template argument req is OpReqType; negate indicates
+ * whether the output is grad_x (negate=true)
+ * or grad_y (negate=false).
+ * cond is a row_sparse array, while others are dense ones,
+ * with cond_stride as in where_rsp.
+ */
+template <int req, bool negate>
+struct where_backward_rsp {
+  // DType is the output data type
+  // CType is condition data type
+  // IType is condition aux data type
+  template <typename DType, typename CType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* grad_out,
+                                  const DType* grad_in,
+                                  const CType* cond_data,
+                                  const IType* cond_idx,
+                                  const nnvm::dim_t row_size,
+                                  const nnvm::dim_t cond_stride) {
+    using nnvm::dim_t;
+    const dim_t grad_offset = static_cast<dim_t>(cond_idx[i / row_size]) * row_size + i % row_size;
+    const DType zero        = static_cast<DType>(0);
+    KERNEL_ASSIGN(grad_out[grad_offset],
+                  req,
+                  ((0 == cond_data[i / cond_stride]) ^ negate) ? grad_in[grad_offset] : zero);
+  }
+};
+
 /*!
  * \brief Template for calculating grad[x] and grad[y].
  * template argument req is OpReqType; negate indicates
@@ -257,6 +313,12 @@ inline bool WhereOpForwardStorageType(const nnvm::NodeAttrs& attrs,
     dispatched =
         storage_type_assign(&out_stype, kDefaultStorage, dispatch_mode, DispatchMode::kFComputeEx);
   }
+  if (!dispatched && cond_stype == kRowSparseStorage && x_stype == kDefaultStorage &&
+      y_stype == kDefaultStorage) {
+    // rsp, dns, dns -> dns
+    dispatched =
+        storage_type_assign(&out_stype, kDefaultStorage, dispatch_mode, DispatchMode::kFComputeEx);
+  }
   if (!dispatched) {
     dispatched = dispatch_fallback(out_attrs, dispatch_mode);
   }
@@ -278,8 +340,10 @@ inline bool WhereOpBackwardStorageType(const nnvm::NodeAttrs& attrs,
     dispatched =
         storage_type_assign(out_attrs, kDefaultStorage, dispatch_mode, DispatchMode::kFCompute);
   }
-  if (!dispatched && cond_stype == kCSRStorage && in_grad_stype == kDefaultStorage) {
+  if (!dispatched && (cond_stype == kCSRStorage || cond_stype == kRowSparseStorage) &&
+      in_grad_stype == kDefaultStorage) {
     // dns, csr -> dns, dns
+    // dns, rsp -> dns, dns
     dispatched =
         storage_type_assign(out_attrs, kDefaultStorage, dispatch_mode, DispatchMode::kFComputeEx);
   }
@@ -370,6 +434,43 @@ void WhereOpForwardCsrImpl(mshadow::Stream<xpu>* s,
   });
 }
 
+template <typename xpu>
+void WhereOpForwardRspImpl(mshadow::Stream<xpu>* s,
+                           const NDArray& cond,
+                           const TBlob& x,
+                           const TBlob& y,
+                           const OpReqType req,
+                           const TBlob& out) {
+  using namespace mxnet_op;
+  using namespace rowsparse;
+  if (out.Size() == 0 || req == kNullOp)
+    return;
+  CHECK(req == kWriteInplace || req == kWriteTo)
+      << "WhereOpForwardRspImpl doesn't support req = " << req;
+  MSHADOW_TYPE_SWITCH(out.type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH(cond.dtype(), CType, {
+      MSHADOW_IDX_TYPE_SWITCH(cond.aux_type(kIdx), IType, {
+        MXNET_ASSIGN_REQ_SWITCH(req, req_type, {
+          mshadow::Copy(out.FlatTo1D<xpu, DType>(s), y.FlatTo1D<xpu, DType>(s), s);
+          // no condition is satisfied
+          if (!cond.storage_initialized())
+            return;
+          const nnvm::dim_t row_size    = x.shape_.ProdShape(1, x.shape_.ndim());
+          const nnvm::dim_t cond_stride = cond.shape() == x.shape_ ? 1 : row_size;
+          Kernel<where_rsp<req_type>, xpu>::Launch(s,
+                                                   cond.storage_shape()[0] * row_size,
+                                                   out.dptr<DType>(),
+                                                   cond.aux_data(kIdx).dptr<IType>(),
+                                                   cond.data().dptr<CType>(),
+                                                   row_size,
+                                                   cond_stride,
+                                                   x.dptr<DType>());
+        });
+      });
+    });
+  });
+}
+
 template <typename xpu>
 void WhereOpForwardEx(const nnvm::NodeAttrs& attrs,
                       const OpContext& ctx,
@@ -384,11 +485,14 @@ void WhereOpForwardEx(const nnvm::NodeAttrs& attrs,
   const int y_stype       = inputs[2].storage_type();
   const auto& out_stype   = outputs[0].storage_type();
   mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
-  CHECK_NE(inputs[0].shape().ndim(), 1) << "WhereOpForwardEx with 1-D cond is not implemented";
   if (cond_stype == kCSRStorage && x_stype == kDefaultStorage && y_stype == kDefaultStorage &&
       out_stype == kDefaultStorage) {
     WhereOpForwardCsrImpl(
         s, inputs[0], inputs[1].data(), inputs[2].data(), req[0], outputs[0].data());
+  } else if (cond_stype == kRowSparseStorage && x_stype == kDefaultStorage &&
+             y_stype == kDefaultStorage && out_stype == kDefaultStorage) {
+    WhereOpForwardRspImpl(
+        s, inputs[0], inputs[1].data(), inputs[2].data(), req[0], outputs[0].data());
   } else {
     LogUnimplementedOp(attrs, ctx, inputs, req, outputs);
   }
@@ -517,6 +621,63 @@ void WhereOpBackwardCsrImpl(mshadow::Stream<xpu>* s,
   });
 }
 
+template <typename xpu>
+void WhereOpBackwardRspImpl(mshadow::Stream<xpu>* s,
+                            const TBlob& grad_in,
+                            const NDArray& cond,
+                            const std::vector<OpReqType>& req,
+                            const TBlob& grad_x,
+                            const TBlob& grad_y) {
+  using namespace mxnet_op;
+  using namespace rowsparse;
+  if (grad_in.Size() == 0)
+    return;
+  CHECK_NE(req[0], kAddTo) << "WhereOpBackwardRspImpl doesn't support kAddTo";
+  CHECK_NE(req[1], kAddTo) << "WhereOpBackwardRspImpl doesn't support kAddTo";
+  MSHADOW_TYPE_SWITCH(grad_in.type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH(cond.dtype(), CType, {
+      MSHADOW_IDX_TYPE_SWITCH(cond.aux_type(kIdx), IType, {
+        const nnvm::dim_t row_size    = grad_in.shape_.ProdShape(1, grad_in.shape_.ndim());
+        const nnvm::dim_t cond_stride = cond.shape() == grad_in.shape_ ? 1 : row_size;
+        const index_t num_selected    = cond.storage_shape()[0] * row_size;
+        if (req[0] != kNullOp) {
+          Fill<false>(s, grad_x, req[0], 0);
+          // some conditions are satisfied
+          if (cond.storage_initialized()) {
+            MXNET_ASSIGN_REQ_SWITCH(req[0], req_type_x, {
+              Kernel<where_backward_rsp<req_type_x, true>, xpu>::Launch(
+                  s,
+                  num_selected,
+                  grad_x.dptr<DType>(),
+                  grad_in.dptr<DType>(),
+                  cond.data().dptr<CType>(),
+                  cond.aux_data(kIdx).dptr<IType>(),
+                  row_size,
+                  cond_stride);
+            });
+          }
+        }
+        if (req[1] != kNullOp) {
+          mshadow::Copy(grad_y.FlatTo1D<xpu, DType>(s), grad_in.FlatTo1D<xpu, DType>(s), s);
+          if (cond.storage_initialized()) {
+            MXNET_ASSIGN_REQ_SWITCH(req[1], req_type_y, {
+              Kernel<where_backward_rsp<req_type_y, false>, xpu>::Launch(
+                  s,
+                  num_selected,
+                  grad_y.dptr<DType>(),
+                  grad_in.dptr<DType>(),
+                  cond.data().dptr<CType>(),
+                  cond.aux_data(kIdx).dptr<IType>(),
+                  row_size,
+                  cond_stride);
+            });
+          }
+        }
+      });
+    });
+  });
+}
+
 template <typename xpu>
 void WhereOpBackwardEx(const nnvm::NodeAttrs& attrs,
                        const OpContext& ctx,
@@ -527,9 +688,6 @@ void WhereOpBackwardEx(const nnvm::NodeAttrs& attrs,
   CHECK_EQ(req.size(), 2U);
   CHECK_EQ(outputs.size(), 2U);
   mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
-  if (inputs[1].shape().ndim() == 1) {
-    LOG(FATAL) << "WhereOpBackwardEx with 1-D cond is not implemented";
-  }
   const auto grad_in_stype = inputs[0].storage_type();
   const auto cond_stype    = inputs[1].storage_type();
   const auto grad_x_stype  = outputs[0].storage_type();
@@ -538,6 +696,10 @@ void WhereOpBackwardEx(const nnvm::NodeAttrs& attrs,
       grad_x_stype == kDefaultStorage && grad_y_stype == kDefaultStorage) {
     WhereOpBackwardCsrImpl(
         s, inputs[0].data(), inputs[1], req, outputs[0].data(), outputs[1].data());
+  } else if (grad_in_stype == kDefaultStorage && cond_stype == kRowSparseStorage &&
+             grad_x_stype == kDefaultStorage && grad_y_stype == kDefaultStorage) {
+    WhereOpBackwardRspImpl(
+        s, inputs[0].data(), inputs[1], req, outputs[0].data(), outputs[1].data());
   } else {
     LogUnimplementedOp(attrs, ctx, inputs, req, outputs);
   }
@@ -298,6 +298,15 @@ inline bool DotForwardInferStorageType(const nnvm::NodeAttrs& attrs,
           &out_stype, kDefaultStorage, dispatch_mode, DispatchMode::kFComputeEx);
     }
   }
+  if (!dispatched && lhs_stype == kBSRStorage && rhs_stype == kDefaultStorage &&
+      !param.transpose_a && !param.transpose_b) {
+    // bsr, dns -> dns
+    target_stype = hint_has_value ? target_stype : kDefaultStorage;
+    if (target_stype == kDefaultStorage) {
+      dispatched = storage_type_assign(
+          &out_stype, kDefaultStorage, dispatch_mode, DispatchMode::kFComputeEx);
+    }
+  }
   if (!dispatched && lhs_stype == kDefaultStorage && rhs_stype == kCSRStorage &&
       !param.transpose_a) {
     target_stype = hint_has_value ? target_stype : kCSRStorage;
@@ -382,6 +391,49 @@ inline bool DotBackwardInferStorageType(const nnvm::NodeAttrs& attrs,
   return dispatched;
 }
 
+/*!
+ * \brief out[0:n] += val * row[0:n], the update of a row of the output by one non-zero
+ */
+template <typename DType>
+MSHADOW_CINLINE void DotCsrAxpy(DType* __restrict out,
+                                const DType* __restrict row,
+                                const DType val,
+                                const nnvm::dim_t n) {
+#pragma omp simd
+  for (nnvm::dim_t l = 0; l < n; ++l) {
+    out[l] += row[l] * val;
+  }
+}
+
+/*!
+ * \brief out[0:n] += sum_k data[k] * rhs[col_idx[k]][0:n] for the non-zeros of a csr row,
+ *  four at a time so that each pass loads and stores the output row once for four rhs rows
+ */
+template <typename DType, typename IType, typename CType>
+MSHADOW_CINLINE void DotCsrRowUpdate(DType* __restrict out,
+                                     const DType* data,
+                                     const CType* col_idx,
+                                     const IType nnz,
+                                     const DType* data_r,
+                                     const nnvm::dim_t num_cols) {
+  using nnvm::dim_t;
+  IType k = 0;
+  for (; k + 4 <= nnz; k += 4) {
+    const DType v0 = data[k], v1 = data[k + 1], v2 = data[k + 2], v3 = data[k + 3];
+    const DType* __restrict r0 = data_r + static_cast<dim_t>(col_idx[k]) * num_cols;
+    const DType* __restrict r1 = data_r + static_cast<dim_t>(col_idx[k + 1]) * num_cols;
+    const DType* __restrict r2 = data_r + static_cast<dim_t>(col_idx[k + 2]) * num_cols;
+    const DType* __restrict r3 = data_r + static_cast<dim_t>(col_idx[k + 3]) * num_cols;
+#pragma omp simd
+    for (dim_t l = 0; l < num_cols; ++l) {
+      out[l] += r0[l] * v0 + r1[l] * v1 + r2[l] * v2 + r3[l] * v3;
+    }
+  }
+  for (; k < nnz; ++k) {
+    DotCsrAxpy(out, data_r + static_cast<dim_t>(col_idx[k]) * num_cols, data[k], num_cols);
+  }
+}
+
 /*!
  * \brief CPU Kernel of dot(csr, dns1) = dns2
  * Parallelization by row blocks
@@ -409,21 +461,21 @@ struct DotCsrDnsDnsByRowBlocks {
     for (dim_t j = seg_start; j < seg_end; ++j) {
       if (indptr_l[j] == indptr_l[j + 1])
         continue;
-      const dim_t offset_out = j * num_cols;
-      for (IType k = indptr_l[j]; k < indptr_l[j + 1]; ++k) {
-        const DType val      = data_l[k];
-        const dim_t offset_r = col_idx_l[k] * num_cols;
-        for (dim_t l = 0; l < num_cols; ++l) {
-          out[offset_out + l] += data_r[offset_r + l] * val;
-        }
-      }
+      DotCsrRowUpdate(out + j * num_cols,
+                      data_l + indptr_l[j],
+                      col_idx_l + indptr_l[j],
+                      static_cast<IType>(indptr_l[j + 1] - indptr_l[j]),
+                      data_r,
+                      num_cols);
     }
   }
 };
 
 /*!
  * \brief CPU Kernel of dot(csr.T(), dns1) = dns2
- * Parallelization by row blocks
+ * Parallelization by row blocks of the output. The column indices of a csr row are sorted, so
+ * each thread finds the non-zeros of its block in a row by binary search instead of scanning
+ * all of them.
  */
 struct DotCsrTransDnsDnsByRowBlocks {
   /*!
@@ -449,16 +501,16 @@ struct DotCsrTransDnsDnsByRowBlocks {
     for (dim_t j = 0; j < num_rows_l; ++j) {
       if (indptr_l[j] == indptr_l[j + 1])
         continue;
-      const dim_t offset_r = j * num_cols;
-      for (IType k = indptr_l[j]; k < indptr_l[j + 1]; ++k) {
-        const CType col_idx = col_idx_l[k];
-        if (col_idx < seg_start || col_idx >= seg_end)
-          continue;
-        const dim_t offset_out = col_idx * num_cols;
-        const DType val        = data_l[k];
-        for (dim_t l = 0; l < num_cols; ++l) {
-          out[offset_out + l] += data_r[offset_r + l] * val;
-        }
+      const CType* row_begin = col_idx_l + indptr_l[j];
+      const CType* row_end   = col_idx_l + indptr_l[j + 1];
+      if (*row_begin >= seg_end || *(row_end - 1) < seg_start)
+        continue;
+      const CType* first = std::lower_bound(row_begin, row_end, seg_start);
+      const CType* last  = std::lower_bound(first, row_end, seg_end);
+      const DType* row_r = data_r + j * num_cols;
+      for (const CType* it = first; it != last; ++it) {
+        DotCsrAxpy(
+            out + static_cast<dim_t>(*it) * num_cols, row_r, data_l[it - col_idx_l], num_cols);
       }
     }
   }
@@ -1334,6 +1386,90 @@ inline void DotDnsCsrDnsImpl(const OpContext& ctx,
   });
 }
 
+/*!
+ * \brief Kernel of dot(bsr, dns1) = dns2
+ * Parallelization by output elements, the threads of consecutive output columns reading the
+ * same block and consecutive elements of rhs.
+ */
+template <int req>
+struct DotBsrDnsDnsByElem {
+  /*!
+   * \brief
+   * \param i the i-th element of the output
+   */
+  template <typename DType, typename IType, typename CType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const DType* data_l,
+                                  const IType* indptr_l,
+                                  const CType* col_idx_l,
+                                  const DType* data_r,
+                                  const nnvm::dim_t num_cols,
+                                  const nnvm::dim_t block_rows,
+                                  const nnvm::dim_t block_cols) {
+    using nnvm::dim_t;
+    using AType         = typename mxnet_op::AccType<DType>::type;
+    const dim_t row     = i / num_cols;
+    const dim_t col     = i % num_cols;
+    const dim_t brow    = row / block_rows;
+    const dim_t r       = row % block_rows;
+    const dim_t bstride = block_rows * block_cols;
+    AType sum           = 0;
+    for (IType k = indptr_l[brow]; k < indptr_l[brow + 1]; ++k) {
+      const DType* block = data_l + k * bstride + r * block_cols;
+      const DType* rhs   = data_r + col_idx_l[k] * block_cols * num_cols + col;
+      for (dim_t j = 0; j < block_cols; ++j) {
+        sum += AType(block[j]) * AType(rhs[j * num_cols]);
+      }
+    }
+    KERNEL_ASSIGN(out[i], req, DType(sum));
+  }
+};
+
+/*
+ * \brief Impl of dot(bsr, dns) = dns
+ */
+template <typename xpu>
+inline void DotBsrDnsDnsImpl(const OpContext& ctx,
+                             const NDArray& lhs,
+                             const TBlob& rhs,
+                             const OpReqType req,
+                             TBlob* ret) {
+  if (req == kNullOp)
+    return;
+  CHECK_EQ(lhs.storage_type(), kBSRStorage);
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  if (!lhs.storage_initialized()) {
+    Fill(s, *ret, req, 0);
+    return;
+  }
+
+  using nnvm::dim_t;
+
+  const TBlob data_l    = lhs.data();
+  const TBlob indptr_l  = lhs.aux_data(bsr::kIndPtr);
+  const TBlob col_idx_l = lhs.aux_data(bsr::kIdx);
+
+  MSHADOW_REAL_TYPE_SWITCH(data_l.type_flag_, DType, {        // data type
+    MSHADOW_IDX_TYPE_SWITCH(indptr_l.type_flag_, IType, {     // indptr type
+      MSHADOW_IDX_TYPE_SWITCH(col_idx_l.type_flag_, CType, {  // col idx type
+        MXNET_ASSIGN_REQ_SWITCH(req, Req, {
+          mxnet_op::Kernel<DotBsrDnsDnsByElem<Req>, xpu>::Launch(s,
+                                                                 ret->Size(),
+                                                                 ret->dptr<DType>(),
+                                                                 data_l.dptr<DType>(),
+                                                                 indptr_l.dptr<IType>(),
+                                                                 col_idx_l.dptr<CType>(),
+                                                                 rhs.dptr<DType>(),
+                                                                 rhs.shape_[1],
+                                                                 data_l.shape_[1],
+                                                                 data_l.shape_[2]);
+        });
+      });
+    });
+  });
+}
+
 inline bool DotShape(const nnvm::NodeAttrs& attrs,
                      mxnet::ShapeVector* in_attrs,
                      mxnet::ShapeVector* out_attrs) {
@@ -1474,6 +1610,11 @@ void DotForwardEx(const nnvm::NodeAttrs& attrs,
                      req[DotOut::out],
                      &ret,
                      param.transpose_b);
+  } else if (lhs_stype == kBSRStorage && rhs_stype == kDefaultStorage &&
+             out_stype == kDefaultStorage && !(param.transpose_a || param.transpose_b)) {
+    TBlob ret = outputs[DotOut::out].data();
+    DotBsrDnsDnsImpl<xpu>(
+        ctx, inputs[DotIn::lhs], inputs[DotIn::rhs].data(), req[DotOut::out], &ret);
   } else {
     LogUnimplementedOp(attrs, ctx, inputs, req, outputs);
   }
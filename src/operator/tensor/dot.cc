@@ -32,6 +32,25 @@ namespace mxnet {
 namespace op {
 DMLC_REGISTER_PARAMETER(DotParam);
 
+static OpCost DotCost(const nnvm::NodeAttrs& attrs,
+                      const std::vector<TBlob>& inputs,
+                      const std::vector<TBlob>& outputs) {
+  const DotParam& param = nnvm::get<DotParam>(attrs.parsed);
+  const TShape& lshape  = inputs[0].shape_;
+  // the reduced axis is the last one of lhs, or the first one if it is transposed
+  const index_t k = param.transpose_a ? lshape[0] : lshape[lshape.ndim() - 1];
+  return MatMulCost(static_cast<double>(outputs[0].Size()) * k, inputs, outputs);
+}
+
+static OpCost BatchDotCost(const nnvm::NodeAttrs& attrs,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<TBlob>& outputs) {
+  const DotParam& param = nnvm::get<DotParam>(attrs.parsed);
+  const TShape& lshape  = inputs[0].shape_;
+  const index_t k       = lshape[lshape.ndim() - (param.transpose_a ? 2 : 1)];
+  return MatMulCost(static_cast<double>(outputs[0].Size()) * k, inputs, outputs);
+}
+
 NNVM_REGISTER_OP(dot)
 MXNET_ADD_SPARSE_OP_ALIAS(dot)
     .describe(R"doc(Dot product of two arrays.
@@ -63,6 +82,7 @@ forward_stype option for output storage type. Implemented sparse operations incl
 - dot(csr, default, transpose_a=True) = row_sparse
 - dot(csr, default) = default
 - dot(csr, row_sparse) = default
+- dot(bsr, default) = default
 - dot(default, csr) = csr (CPU only)
 - dot(default, csr, forward_stype='default') = default
 - dot(default, csr, transpose_b=True, forward_stype='default') = default
@@ -99,6 +119,7 @@ above patterns, ``dot`` will fallback and generate output with default storage.
 #if MXNET_USE_ONEDNN == 1
     .set_attr<bool>("TIsMKLDNN", true)
 #endif
+    .set_attr<FOpCost>("FOpCost", DotCost)
     .set_attr<nnvm::FGradient>("FGradient", ElemwiseGradUseIn{"_backward_dot"})
     .add_argument("lhs", "NDArray-or-Symbol", "The first input")
     .add_argument("rhs", "NDArray-or-Symbol", "The second input")
@@ -188,6 +209,7 @@ which is computed by::
                                 })
     .set_attr<THasDeterministicOutput>("THasDeterministicOutput", true)
     .set_attr<FCompute>("FCompute<cpu>", BatchDotForward_<cpu>)
+    .set_attr<FOpCost>("FOpCost", BatchDotCost)
 #if MXNET_USE_ONEDNN == 1
     .set_attr<bool>("TIsDNNL", true)
     .set_attr<FInferStorageType>("FInferStorageType", BatchDotStorageType)
@@ -195,10 +195,13 @@ __global__ void single_side_binary_broadcast_kernel(
     }
 #pragma unroll
     for (int i = 0; i < nvec; ++i) {
-      const index_t rindex = min(max(util::unravel_dot<ndim>(original_idx + i,
-                                                             param.oshape,
-                                                             param.stride[other_side]),
-                                     static_cast<index_t>(0)),
+      // a single element or a column of the 2D output does not need the coordinates
+      const index_t other_idx = other_pattern == 2 ? (original_idx + i) / lead_dim :
+                                util::unravel_dot<ndim>(original_idx + i,
+                                                        param.oshape,
+                                                        param.stride[other_side]);
+      const index_t rindex = other_pattern == 1 ? 0 :
+                             min(max(other_idx, static_cast<index_t>(0)),
                                  param.size[other_side] - 1);
       const auto rinput = IType2::from(
                             reinterpret_cast<const DType2*>(param.inputs[other_side])
@@ -346,6 +349,16 @@ void BinaryBroadcastRTCCompute::operator()(const nnvm::NodeAttrs& attrs,
             "using DType = InputType0;\n"
             "using DType2 = InputType1;\n";
       }
+      // 1 when the other side is a single element, 2 when it is a column of the 2D output
+      const int other_side = 1 - lead_input_num;
+      int other_pattern    = 0;
+      if (params.size[other_side] == 1) {
+        other_pattern = 1;
+      } else if (ndim == 2 && params.oshape[1] == lead_dim && params.stride[other_side][0] == 1 &&
+                 params.stride[other_side][1] == 0) {
+        other_pattern = 2;
+      }
+      code += "const int other_pattern = " + std::to_string(other_pattern) + ";\n";
       VectorizedKernelRTCLauncher(code,
                                   "single_side_binary_broadcast_kernel",
                                   single_side_broadcast_kernel_fwd,
@@ -110,6 +110,10 @@ inline bool BinaryBroadcastMulStorageType(const nnvm::NodeAttrs& attrs,
     dispatched =
         storage_type_assign(&out_stype, kCSRStorage, dispatch_mode, DispatchMode::kFComputeEx);
   }
+  if (!dispatched && lhs_stype == kRowSparseStorage && rhs_stype == kDefaultStorage) {
+    dispatched = storage_type_assign(
+        &out_stype, kRowSparseStorage, dispatch_mode, DispatchMode::kFComputeEx);
+  }
   if (!dispatched) {
     dispatched = dispatch_fallback(out_attrs, dispatch_mode);
   }
@@ -515,6 +519,71 @@ void BinaryBroadcastCsrDnsCsrImpl(const OpContext& ctx,
   }
 }
 
+/*!
+ * \brief broadcast(row_sparse, dense) = row_sparse, for a dense scalar, row vector,
+ *        column vector or matrix of the same shape. Only the stored rows are computed.
+ */
+template <typename xpu, typename OP>
+void BinaryBroadcastRspDnsRspImpl(const OpContext& ctx,
+                                  const NDArray& rsp,
+                                  const NDArray& dns,
+                                  const OpReqType req,
+                                  const NDArray& output) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  using namespace rowsparse;
+  CHECK(req != kAddTo && req != kWriteInplace);
+  CHECK_EQ(rsp.shape().ndim(), 2U)
+      << "broadcast(row_sparse, dense) = row_sparse only supports 2D row_sparse matrices";
+  CHECK(output.shape() == rsp.shape())
+      << "broadcast(row_sparse, dense) = row_sparse does not broadcast the row_sparse matrix";
+  mshadow::Stream<xpu>* s     = ctx.get_stream<xpu>();
+  const nnvm::dim_t num_rows  = rsp.shape()[0];
+  const nnvm::dim_t num_cols  = rsp.shape()[1];
+  const mxnet::TShape& dshape = dns.shape();
+  nnvm::dim_t row_stride = 0, col_stride = 0;
+  if (dshape.Size() == 1) {
+    // scalar
+  } else if (dshape.ndim() == 1 || dshape[0] == 1) {
+    // row vector
+    CHECK_EQ(dshape[dshape.ndim() - 1], num_cols);
+    col_stride = 1;
+  } else if (dshape[1] == 1) {
+    // column vector
+    CHECK_EQ(dshape[0], num_rows);
+    row_stride = 1;
+  } else {
+    CHECK(dshape == rsp.shape());
+    row_stride = num_cols;
+    col_stride = 1;
+  }
+  if (!rsp.storage_initialized()) {
+    FillZerosRspImpl(s, output);
+    return;
+  }
+  const nnvm::dim_t nnr = rsp.storage_shape()[0];
+  output.CheckAndAlloc({Shape1(nnr)});
+  MSHADOW_TYPE_SWITCH(output.dtype(), DType, {
+    MSHADOW_IDX_TYPE_SWITCH(output.aux_type(kIdx), IType, {
+      MXNET_ASSIGN_REQ_SWITCH(req, req_type, {
+        Kernel<rsp_dns_rsp_broadcast_kernel<req_type, OP>, xpu>::Launch(
+            s,
+            nnr * num_cols,
+            rsp.data().dptr<DType>(),
+            rsp.aux_data(kIdx).dptr<IType>(),
+            dns.data().dptr<DType>(),
+            output.data().dptr<DType>(),
+            num_cols,
+            row_stride,
+            col_stride);
+        Copy(output.aux_data(kIdx).FlatTo1D<xpu, IType>(s),
+             rsp.aux_data(kIdx).FlatTo1D<xpu, IType>(s),
+             s);
+      });
+    });
+  });
+}
+
 template <typename xpu, typename OP>
 void BinaryBroadcastCsrDnsDnsImpl(const OpContext& ctx,
                                   const NDArray& csr,
@@ -625,6 +694,12 @@ void BinaryBroadcastComputeSparseEx(const nnvm::NodeAttrs& attrs,
   const auto lhs_stype = lhs.storage_type();
   const auto rhs_stype = rhs.storage_type();
   const auto out_stype = out.storage_type();
+  if (lhs_stype == kRowSparseStorage && rhs_stype == kDefaultStorage &&
+      out_stype == kRowSparseStorage) {
+    // broadcast(RSP, Dense(1D or same shape)) = RSP
+    BinaryBroadcastRspDnsRspImpl<xpu, OP>(ctx, lhs, rhs, req[0], out);
+    return;
+  }
   // If the input is a matrix with the same shape, should be elemwise
   if ((rhs.shape().ndim() != 1U) && (rhs.shape()[0] != 1) && (rhs.shape()[1] != 1)) {
     if (lhs_stype == kCSRStorage && rhs_stype == kDefaultStorage && out_stype == kCSRStorage) {
@@ -825,10 +900,12 @@ void DNNLBinaryOpForward(const nnvm::NodeAttrs& attrs,
                                        })                                                         \
       .set_attr<mxnet::FInferShape>("FInferShape", BinaryBroadcastShape)                          \
       .set_attr<nnvm::FInferType>("FInferType", ElemwiseType<2, 1>)                               \
+      .set_attr<mxnet::alm::FChangeLayout>("FChangeLayout", BroadcastChangeLayout)                \
       .set_attr<nnvm::FInplaceOption>("FInplaceOption",                                           \
                                       [](const NodeAttrs& attrs) {                                \
                                         return std::vector<std::pair<int, int> >{{0, 0}, {1, 0}}; \
                                       })                                                          \
+      .set_attr<FOpCost>("FOpCost", ElemwiseCost)                                                 \
       .add_argument("lhs", "NDArray-or-Symbol", "First input to the function")                    \
       .add_argument("rhs", "NDArray-or-Symbol", "Second input to the function")
 
@@ -217,6 +217,7 @@ Example::
 Supported sparse operations:
 
    broadcast_mul(csr, dense(1D)) = csr
+   broadcast_mul(row_sparse, dense(1D)) = row_sparse
 
 )code" ADD_FILELINE)
     .set_attr<FCompute>("FCompute<cpu>", BinaryBroadcastCompute<cpu, op::mshadow_op::mul>)
@@ -257,6 +258,7 @@ Example::
 Supported sparse operations:
 
    broadcast_div(csr, dense(1D)) = csr
+   broadcast_div(row_sparse, dense(1D)) = row_sparse
 
 )code" ADD_FILELINE)
     .set_attr<FCompute>("FCompute<cpu>", BinaryBroadcastCompute<cpu, op::mshadow_op::div>)
@@ -818,6 +818,7 @@ class ElemwiseBinaryOp : public OpBase {
                                       [](const NodeAttrs& attrs) {                                \
                                         return std::vector<std::pair<int, int> >{{0, 0}, {1, 0}}; \
                                       })                                                          \
+      .set_attr<FOpCost>("FOpCost", ElemwiseCost)                                                 \
       .add_argument("lhs", "NDArray-or-Symbol", "first input")                                    \
       .add_argument("rhs", "NDArray-or-Symbol", "second input")
 
@@ -472,6 +472,7 @@ void PowerComputeExCPU(const nnvm::NodeAttrs& attrs,
           [](const NodeAttrs& attrs) {                                                    \
             return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};             \
           })                                                                              \
+      .set_attr<FOpCost>("FOpCost", ElemwiseCost)                                         \
       .add_argument("data", "NDArray-or-Symbol", "source input")                          \
       .add_arguments(NumpyBinaryScalarParam::__FIELDS__())
 
@@ -188,6 +188,7 @@ The storage type of ``add_n`` output depends on storage types of inputs
 #endif
     .set_attr<mxnet::FInferShape>("FInferShape", ElementWiseSumShape)
     .set_attr<nnvm::FInferType>("FInferType", ElementWiseSumType)
+    .set_attr<mxnet::alm::FChangeLayout>("FChangeLayout", ElemwiseChangeLayout)
     .set_attr<FInferStorageType>("FInferStorageType", ElementWiseSumForwardInferStorageType)
     .set_attr<nnvm::FGradient>("FGradient", ElementWiseSumGrad)
     .add_argument("args", "NDArray-or-Symbol[]", "Positional input arguments");
@@ -31,7 +31,7 @@ namespace op {
 
 namespace {
 
-constexpr size_t num_inputs_per_kernel = 4;
+constexpr size_t num_inputs_per_kernel = 32;
 
 struct elementwise_sum_params {
   int num_inputs;
@@ -40,7 +40,7 @@ struct elementwise_sum_params {
 };
 
 const char elementwise_sum_kernel[] = R"code(
-constexpr size_t num_inputs_per_kernel = 4;
+constexpr size_t num_inputs_per_kernel = 32;
 
 struct elementwise_sum_params {
   int num_inputs;
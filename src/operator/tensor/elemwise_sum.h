@@ -26,6 +26,7 @@
 #define MXNET_OPERATOR_TENSOR_ELEMWISE_SUM_H_
 
 #include <dmlc/logging.h>
+#include <algorithm>
 #include <cstring>
 #include <vector>
 #include "../operator_common.h"
@@ -55,6 +56,99 @@ struct Sum {
   }
 };
 
+/*! \brief the inputs of a pass of SumN, passed to the kernel by value */
+template <typename DType>
+struct SumNInputs {
+  static constexpr int kMaxInputs = 32;
+  const DType* dptr[kMaxInputs];
+  int num;
+};
+
+/*! \brief sums the inputs of a pass in one kernel, accumulating in the wider type of DType */
+struct SumN {
+  template <typename DType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const OpReqType req,
+                                  const SumNInputs<DType> in) {
+    using AType = typename mxnet_op::AccType<DType>::type;
+    AType sum   = 0;
+    for (int j = 0; j < in.num; ++j) {
+      sum += AType(in.dptr[j][i]);
+    }
+    KERNEL_ASSIGN(out[i], req, DType(sum));
+  }
+};
+
+/*!
+ * \brief out[begin, end) = in[0] + ... + in[num_in - 1] on CPU, in one pass over the output.
+ *  The elements are accumulated block by block across all the inputs, in a buffer which stays
+ *  in the L1 cache, so each input is read once and the output is written once.
+ *  The output may be one of the inputs.
+ */
+template <typename DType>
+inline void ElementWiseSumRange(const DType* const* in,
+                                size_t num_in,
+                                DType* out,
+                                OpReqType req,
+                                index_t begin,
+                                index_t end) {
+  using AType              = typename mxnet_op::AccType<DType>::type;
+  constexpr index_t kBlock = 1024;
+  AType acc[kBlock];
+  for (index_t b = begin; b < end; b += kBlock) {
+    const index_t n = std::min(kBlock, end - b);
+    for (index_t i = 0; i < n; ++i) {
+      acc[i] = req == kAddTo ? AType(out[b + i]) : AType(0);
+    }
+    for (size_t j = 0; j < num_in; ++j) {
+      const DType* src = in[j] + b;
+      for (index_t i = 0; i < n; ++i) {
+        acc[i] += AType(src[i]);
+      }
+    }
+    for (index_t i = 0; i < n; ++i) {
+      out[b + i] = DType(acc[i]);
+    }
+  }
+}
+
+/*! \brief out = in[0] + ... + in[n - 1] in passes of up to SumNInputs::kMaxInputs inputs */
+template <typename xpu, typename DType>
+inline void ElementWiseSumN(mshadow::Stream<xpu>* s,
+                            const std::vector<const DType*>& in,
+                            DType* out,
+                            index_t size,
+                            OpReqType req) {
+  using namespace mxnet_op;
+  if (req == kNullOp || size == 0)
+    return;
+  for (size_t i = 0; i < in.size(); i += SumNInputs<DType>::kMaxInputs) {
+    SumNInputs<DType> pass;
+    pass.num = std::min<size_t>(SumNInputs<DType>::kMaxInputs, in.size() - i);
+    std::copy(in.begin() + i, in.begin() + i + pass.num, pass.dptr);
+    Kernel<SumN, xpu>::Launch(s, size, out, i == 0 ? req : kAddTo, pass);
+  }
+}
+
+template <typename DType>
+inline void ElementWiseSumN(mshadow::Stream<cpu>* s,
+                            const std::vector<const DType*>& in,
+                            DType* out,
+                            index_t size,
+                            OpReqType req) {
+  constexpr index_t kGrain = 16384;
+  if (req == kNullOp || size == 0)
+    return;
+  const index_t num_tasks = (size + kGrain - 1) / kGrain;
+  const int omp_threads   = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(omp_threads) if (num_tasks > 1)
+  for (index_t t = 0; t < num_tasks; ++t) {
+    ElementWiseSumRange(
+        in.data(), in.size(), out, req, t * kGrain, std::min(size, (t + 1) * kGrain));
+  }
+}
+
 template <typename xpu, typename DType>
 void ElementWiseSumCompute_(const nnvm::NodeAttrs& attrs,
                             const OpContext& ctx,
@@ -64,44 +158,15 @@ void ElementWiseSumCompute_(const nnvm::NodeAttrs& attrs,
   using namespace mxnet_op;
   if (req[0] == kNullOp)
     return;
-  size_t size      = in_data.size();
   Stream<xpu>* s   = ctx.get_stream<xpu>();
-  DType* out_dptr  = out_data[0].dptr<DType>();
   index_t out_size = static_cast<index_t>((out_data[0].Size() + DataType<DType>::kLanes - 1) /
                                           DataType<DType>::kLanes);
-  switch (size) {
-    case 2: {
-      DType* in_0_dptr = in_data[0].dptr<DType>();
-      DType* in_1_dptr = in_data[1].dptr<DType>();
-      Kernel<Sum, xpu>::Launch(s, out_size, out_dptr, req[0], in_0_dptr, in_1_dptr);
-      break;
-    }
-    case 3: {
-      DType* in_0_dptr = in_data[0].dptr<DType>();
-      DType* in_1_dptr = in_data[1].dptr<DType>();
-      DType* in_2_dptr = in_data[2].dptr<DType>();
-      Kernel<Sum, xpu>::Launch(s, out_size, out_dptr, req[0], in_0_dptr, in_1_dptr, in_2_dptr);
-      break;
-    }
-    case 4: {
-      DType* in_0_dptr = in_data[0].dptr<DType>();
-      DType* in_1_dptr = in_data[1].dptr<DType>();
-      DType* in_2_dptr = in_data[2].dptr<DType>();
-      DType* in_3_dptr = in_data[3].dptr<DType>();
-      Kernel<Sum, xpu>::Launch(
-          s, out_size, out_dptr, req[0], in_0_dptr, in_1_dptr, in_2_dptr, in_3_dptr);
-      break;
-    }
-    default: {
-      DType* in_0_dptr = in_data[0].dptr<DType>();
-      Kernel<Sum, xpu>::Launch(s, out_size, out_dptr, req[0], in_0_dptr);
-      for (size_t i = 1; i < size; ++i) {
-        DType* in_dptr = in_data[i].dptr<DType>();
-        Kernel<Sum, xpu>::Launch(s, out_size, out_dptr, kWriteTo, out_dptr, in_dptr);
-      }
-      break;
-    }
+  std::vector<const DType*> in_dptrs;
+  in_dptrs.reserve(in_data.size());
+  for (const TBlob& in : in_data) {
+    in_dptrs.push_back(in.dptr<DType>());
   }
+  ElementWiseSumN(s, in_dptrs, out_data[0].dptr<DType>(), out_size, req[0]);
 }
 
 template <typename xpu>
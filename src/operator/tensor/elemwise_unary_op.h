@@ -942,6 +942,7 @@ void NumpyNanToNumOpBackward(const nnvm::NodeAttrs& attrs,
                                       [](const NodeAttrs& attrs) {                        \
                                         return std::vector<std::pair<int, int> >{{0, 0}}; \
                                       })                                                  \
+      .set_attr<FOpCost>("FOpCost", ElemwiseCost)                                         \
       .add_argument("data", "NDArray-or-Symbol", "The input array.")
 
 #if MSHADOW_USE_MKL == 1
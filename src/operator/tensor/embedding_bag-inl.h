@@ -0,0 +1,300 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file embedding_bag-inl.h
+ * \brief the embeddings of bags of indices, reduced over each bag without materializing them
+ */
+#ifndef MXNET_OPERATOR_TENSOR_EMBEDDING_BAG_INL_H_
+#define MXNET_OPERATOR_TENSOR_EMBEDDING_BAG_INL_H_
+
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <mxnet/operator_util.h>
+#include <vector>
+#include "../mxnet_op.h"
+#include "../operator_common.h"
+#include "./indexing_op.h"
+
+namespace mxnet {
+namespace op {
+
+namespace embedding_bag {
+// the backward takes the ograd, then data, offsets and, with weights, weight and
+// per_sample_weights, and returns the gradients of the inputs of the forward
+enum EmbeddingBagOpInputs { kData, kOffsets, kWeight, kPerSampleWeights };
+enum EmbeddingBagOpOutputs { kOut };
+enum EmbeddingBagOpResource { kTempSpace };
+enum EmbeddingBagOpMode { kSum, kMean };
+}  // namespace embedding_bag
+
+struct EmbeddingBagParam : public dmlc::Parameter<EmbeddingBagParam> {
+  index_t input_dim;
+  index_t output_dim;
+  int mode;
+  int dtype;
+  bool sparse_grad;
+  bool use_weights;
+  DMLC_DECLARE_PARAMETER(EmbeddingBagParam) {
+    DMLC_DECLARE_FIELD(input_dim).set_lower_bound(1).describe(
+        "Vocabulary size of the input indices.");
+    DMLC_DECLARE_FIELD(output_dim)
+        .set_lower_bound(1)
+        .describe("Dimension of the embedding vectors.");
+    DMLC_DECLARE_FIELD(mode)
+        .add_enum("sum", embedding_bag::kSum)
+        .add_enum("mean", embedding_bag::kMean)
+        .set_default(embedding_bag::kSum)
+        .describe("How the embeddings of the indices of a bag are reduced.");
+    DMLC_DECLARE_FIELD(dtype)
+        .add_enum("float32", mshadow::kFloat32)
+        .add_enum("float64", mshadow::kFloat64)
+        .set_default(mshadow::kFloat32)
+        .describe("Data type of weight.");
+    DMLC_DECLARE_FIELD(sparse_grad)
+        .set_default(false)
+        .describe(
+            "Compute row sparse gradient in the backward calculation. If set to True, "
+            "the grad's storage type is row_sparse.");
+    DMLC_DECLARE_FIELD(use_weights)
+        .set_default(false)
+        .describe("Whether the input per_sample_weights scales the embedding of each index.");
+  }
+};
+
+/*! \brief the indices [*begin, *end) of bag b, clipped to the indices */
+MSHADOW_XINLINE void EmbeddingBagRange(const int64_t* offsets,
+                                       const index_t b,
+                                       const index_t data_size,
+                                       index_t* begin,
+                                       index_t* end) {
+  const index_t first = static_cast<index_t>(offsets[b]);
+  const index_t last  = static_cast<index_t>(offsets[b + 1]);
+  *begin              = first < 0 ? 0 : (first > data_size ? data_size : first);
+  *end                = last < *begin ? *begin : (last > data_size ? data_size : last);
+}
+
+/*! \brief the bag of the k-th index, the last bag whose offset is at most k */
+MSHADOW_XINLINE index_t EmbeddingBagOf(const int64_t* offsets,
+                                       const index_t num_bags,
+                                       const index_t k) {
+  index_t lo = 0, hi = num_bags - 1;
+  while (lo < hi) {
+    const index_t mid = (lo + hi + 1) / 2;
+    if (offsets[mid] <= k) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return lo;
+}
+
+/*! \brief the row of the weight of an index, clipped to the weight */
+template <typename IType>
+MSHADOW_XINLINE index_t EmbeddingBagRow(const IType idx, const index_t input_dim) {
+  const index_t row = static_cast<index_t>(idx);
+  return row < 0 ? 0 : (row >= input_dim ? input_dim - 1 : row);
+}
+
+/*! \brief the scale of the embedding of the k-th index, in a bag of bag_size indices */
+template <typename DType>
+MSHADOW_XINLINE DType EmbeddingBagScale(const DType* per_sample_weights,
+                                        const index_t k,
+                                        const index_t bag_size,
+                                        const int mode) {
+  const DType scale = per_sample_weights ? per_sample_weights[k] : DType(1);
+  return mode == embedding_bag::kMean ? scale / static_cast<DType>(bag_size) : scale;
+}
+
+/*!
+ * \brief the gradient of the per sample weight of the k-th index, the dot product of its
+ *  embedding with the ograd of its bag
+ */
+template <int req>
+struct EmbeddingBagWeightsGradKernel {
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t k,
+                                  DType* grad,
+                                  const DType* ograd,
+                                  const IType* data,
+                                  const int64_t* offsets,
+                                  const DType* weight,
+                                  const index_t num_bags,
+                                  const index_t data_size,
+                                  const index_t input_dim,
+                                  const index_t row_length,
+                                  const int mode) {
+    const index_t b = EmbeddingBagOf(offsets, num_bags, k);
+    index_t begin, end;
+    EmbeddingBagRange(offsets, b, data_size, &begin, &end);
+    DType dot = 0;
+    if (k >= begin && k < end) {
+      const DType* weight_row = weight + EmbeddingBagRow(data[k], input_dim) * row_length;
+      const DType* ograd_row  = ograd + b * row_length;
+      for (index_t j = 0; j < row_length; ++j) {
+        dot += weight_row[j] * ograd_row[j];
+      }
+      dot = EmbeddingBagScale<DType>(nullptr, k, end - begin, mode) * dot;
+    }
+    KERNEL_ASSIGN(grad[k], req, dot);
+  }
+};
+
+inline bool EmbeddingBagOpShape(const nnvm::NodeAttrs& attrs,
+                                mxnet::ShapeVector* in_attrs,
+                                mxnet::ShapeVector* out_attrs) {
+  using namespace mshadow;
+  const EmbeddingBagParam& param = nnvm::get<EmbeddingBagParam>(attrs.parsed);
+  CHECK_EQ(in_attrs->size(), param.use_weights ? 4U : 3U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  SHAPE_ASSIGN_CHECK(*in_attrs, embedding_bag::kWeight, Shape2(param.input_dim, param.output_dim));
+  if (param.use_weights) {
+    // per_sample_weights has the shape of data
+    SHAPE_ASSIGN_CHECK(
+        *in_attrs, embedding_bag::kPerSampleWeights, (*in_attrs)[embedding_bag::kData]);
+    SHAPE_ASSIGN_CHECK(
+        *in_attrs, embedding_bag::kData, (*in_attrs)[embedding_bag::kPerSampleWeights]);
+  }
+  const mxnet::TShape& dshape = (*in_attrs)[embedding_bag::kData];
+  const mxnet::TShape& oshape = (*in_attrs)[embedding_bag::kOffsets];
+  if (!shape_is_known(dshape) || !shape_is_known(oshape))
+    return false;
+  CHECK_EQ(dshape.ndim(), 1) << "EmbeddingBag expects the indices of all bags in a 1-D array";
+  CHECK_EQ(oshape.ndim(), 1) << "EmbeddingBag expects the offsets in a 1-D array";
+  CHECK_GE(oshape[0], 1) << "The offsets of EmbeddingBag hold the begin of each bag "
+                         << "and the end of the last bag";
+  SHAPE_ASSIGN_CHECK(*out_attrs, embedding_bag::kOut, Shape2(oshape[0] - 1, param.output_dim));
+  return true;
+}
+
+inline bool EmbeddingBagOpType(const nnvm::NodeAttrs& attrs,
+                               std::vector<int>* in_type,
+                               std::vector<int>* out_type) {
+  const EmbeddingBagParam& param = nnvm::get<EmbeddingBagParam>(attrs.parsed);
+  CHECK_EQ(in_type->size(), param.use_weights ? 4U : 3U);
+  CHECK_EQ(out_type->size(), 1U);
+  CHECK_NE((*in_type)[embedding_bag::kData], -1) << "First input must have specified type";
+  TYPE_ASSIGN_CHECK(*in_type, embedding_bag::kOffsets, mshadow::kInt64);
+  int dtype = param.dtype;
+  if ((*in_type)[embedding_bag::kWeight] != -1) {
+    dtype = (*in_type)[embedding_bag::kWeight];
+  } else if ((*out_type)[embedding_bag::kOut] != -1) {
+    dtype = (*out_type)[embedding_bag::kOut];
+  }
+  CHECK(dtype == mshadow::kFloat32 || dtype == mshadow::kFloat64)
+      << "EmbeddingBag only supports float32 and float64 weights";
+  TYPE_ASSIGN_CHECK(*in_type, embedding_bag::kWeight, dtype);
+  TYPE_ASSIGN_CHECK(*out_type, embedding_bag::kOut, dtype);
+  if (param.use_weights) {
+    TYPE_ASSIGN_CHECK(*in_type, embedding_bag::kPerSampleWeights, dtype);
+  }
+  return true;
+}
+
+// storage type inference function for _backward_contrib_embedding_bag
+inline bool EmbeddingBagOpBackwardStorageType(const nnvm::NodeAttrs& attrs,
+                                              const int dev_mask,
+                                              DispatchMode* dispatch_mode,
+                                              std::vector<int>* in_attrs,
+                                              std::vector<int>* out_attrs) {
+  const bool sparse_grad = nnvm::get<EmbeddingBagParam>(attrs.parsed).sparse_grad;
+  const NDArrayStorageType target_stype = sparse_grad ? kRowSparseStorage : kDefaultStorage;
+  const auto target_mode = sparse_grad ? DispatchMode::kFComputeEx : DispatchMode::kFCompute;
+  bool dispatched        = false;
+  if (common::ContainsOnlyStorage(*in_attrs, kDefaultStorage)) {
+    dispatched = true;
+    for (size_t i = 0; i < out_attrs->size(); ++i) {
+      const int stype = i == embedding_bag::kWeight ? target_stype : kDefaultStorage;
+      dispatched      = type_assign(&(*out_attrs)[i], stype) && dispatched;
+    }
+    if (dispatched) {
+      dispatched = dispatch_mode_assign(dispatch_mode, target_mode);
+    }
+  }
+  // Print user friendly error message to notify misuses of sparse_grad
+  if ((*out_attrs)[embedding_bag::kWeight] != target_stype) {
+    LOG(FATAL) << "Cannot use sparse_grad = " << sparse_grad
+               << ", while stype of gradients w.r.t embedding weight is "
+               << common::stype_string((*out_attrs)[embedding_bag::kWeight]);
+  }
+  return dispatched;
+}
+
+/*! \brief the gradient of per_sample_weights, the inputs are those of the backward */
+template <typename xpu>
+void EmbeddingBagWeightsGrad(const OpContext& ctx,
+                             const EmbeddingBagParam& param,
+                             const std::vector<TBlob>& inputs,
+                             const OpReqType req,
+                             const TBlob& grad) {
+  using namespace mxnet_op;
+  if (req == kNullOp)
+    return;
+  mshadow::Stream<xpu>* s = ctx.get_stream<xpu>();
+  const TBlob& ograd      = inputs[0];
+  const TBlob& data       = inputs[1 + embedding_bag::kData];
+  const TBlob& offsets    = inputs[1 + embedding_bag::kOffsets];
+  const TBlob& weight     = inputs[1 + embedding_bag::kWeight];
+  MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
+    MSHADOW_SGL_DBL_TYPE_SWITCH(grad.type_flag_, DType, {
+      MXNET_ASSIGN_REQ_SWITCH(req, req_type, {
+        Kernel<EmbeddingBagWeightsGradKernel<req_type>, xpu>::Launch(s,
+                                                                      data.Size(),
+                                                                      grad.dptr<DType>(),
+                                                                      ograd.dptr<DType>(),
+                                                                      data.dptr<IType>(),
+                                                                      offsets.dptr<int64_t>(),
+                                                                      weight.dptr<DType>(),
+                                                                      offsets.Size() - 1,
+                                                                      data.Size(),
+                                                                      param.input_dim,
+                                                                      param.output_dim,
+                                                                      param.mode);
+      });
+    });
+  });
+}
+
+template <typename xpu>
+void EmbeddingBagOpForward(const nnvm::NodeAttrs& attrs,
+                           const OpContext& ctx,
+                           const std::vector<TBlob>& inputs,
+                           const std::vector<OpReqType>& req,
+                           const std::vector<TBlob>& outputs);
+
+// the gradients with a dense gradient of the weight
+template <typename xpu>
+void EmbeddingBagOpBackward(const nnvm::NodeAttrs& attrs,
+                            const OpContext& ctx,
+                            const std::vector<TBlob>& inputs,
+                            const std::vector<OpReqType>& req,
+                            const std::vector<TBlob>& outputs);
+
+// the gradients with a row sparse gradient of the weight
+template <typename xpu>
+void EmbeddingBagOpBackwardEx(const nnvm::NodeAttrs& attrs,
+                              const OpContext& ctx,
+                              const std::vector<NDArray>& inputs,
+                              const std::vector<OpReqType>& req,
+                              const std::vector<NDArray>& outputs);
+
+}  // namespace op
+}  // namespace mxnet
+#endif  // MXNET_OPERATOR_TENSOR_EMBEDDING_BAG_INL_H_
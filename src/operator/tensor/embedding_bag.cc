@@ -0,0 +1,326 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file embedding_bag.cc
+ * \brief CPU implementation of the embedding bag operator
+ */
+#include "./embedding_bag-inl.h"
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * \brief the reduced embeddings of bag b, one thread per bag so that the loop over the row
+ *  is vectorized
+ */
+template <int req>
+struct EmbeddingBagForwardCPU {
+  template <typename DType, typename IType>
+  static void Map(index_t b,
+                  DType* out,
+                  const IType* data,
+                  const int64_t* offsets,
+                  const DType* weight,
+                  const DType* per_sample_weights,
+                  const index_t data_size,
+                  const index_t row_length,
+                  const int mode) {
+    index_t begin, end;
+    EmbeddingBagRange(offsets, b, data_size, &begin, &end);
+    DType* out_row = out + b * row_length;
+    if (req != kAddTo) {
+      std::fill(out_row, out_row + row_length, DType(0));
+    }
+    for (index_t k = begin; k < end; ++k) {
+      const DType scale       = EmbeddingBagScale(per_sample_weights, k, end - begin, mode);
+      const DType* weight_row = weight + static_cast<index_t>(data[k]) * row_length;
+      for (index_t j = 0; j < row_length; ++j) {
+        out_row[j] += scale * weight_row[j];
+      }
+    }
+  }
+};
+
+/*! \brief adds the gradient of the i-th index, the scaled ograd of its bag, into a row */
+template <typename DType>
+struct EmbeddingBagAddRowCPU {
+  const DType* ograd;
+  const int64_t* offsets;
+  const DType* per_sample_weights;
+  index_t num_bags;
+  index_t data_size;
+  index_t row_length;
+  int mode;
+
+  void operator()(DType* grad_row, const nnvm::dim_t i) const {
+    const index_t b = EmbeddingBagOf(offsets, num_bags, i);
+    index_t begin, end;
+    EmbeddingBagRange(offsets, b, data_size, &begin, &end);
+    const DType scale      = EmbeddingBagScale(per_sample_weights, i, end - begin, mode);
+    const DType* ograd_row = ograd + b * row_length;
+    for (index_t j = 0; j < row_length; ++j) {
+      grad_row[j] += scale * ograd_row[j];
+    }
+  }
+};
+
+template <typename DType>
+EmbeddingBagAddRowCPU<DType> MakeEmbeddingBagAddRow(const EmbeddingBagParam& param,
+                                                    const std::vector<TBlob>& inputs) {
+  const TBlob& offsets = inputs[1 + embedding_bag::kOffsets];
+  return {inputs[0].dptr<DType>(),
+          offsets.dptr<int64_t>(),
+          param.use_weights ? inputs[1 + embedding_bag::kPerSampleWeights].dptr<DType>() : nullptr,
+          static_cast<index_t>(offsets.Size()) - 1,
+          static_cast<index_t>(inputs[1 + embedding_bag::kData].Size()),
+          param.output_dim,
+          param.mode};
+}
+
+template <>
+void EmbeddingBagOpForward<cpu>(const nnvm::NodeAttrs& attrs,
+                                const OpContext& ctx,
+                                const std::vector<TBlob>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const EmbeddingBagParam& param = nnvm::get<EmbeddingBagParam>(attrs.parsed);
+  if (req[embedding_bag::kOut] == kNullOp)
+    return;
+  mshadow::Stream<cpu>* s    = ctx.get_stream<cpu>();
+  const TBlob& data          = inputs[embedding_bag::kData];
+  const TBlob& offsets       = inputs[embedding_bag::kOffsets];
+  const TBlob& out           = outputs[embedding_bag::kOut];
+  const index_t data_size    = data.Size();
+  const index_t num_bags     = offsets.Size() - 1;
+  const int64_t* offsets_ptr = offsets.dptr<int64_t>();
+  CHECK(offsets_ptr[0] == 0 && offsets_ptr[num_bags] == data_size)
+      << "The offsets of EmbeddingBag must begin with 0 and end with the number of indices, "
+      << data_size;
+  for (index_t b = 0; b < num_bags; ++b) {
+    CHECK_LE(offsets_ptr[b], offsets_ptr[b + 1]) << "The offsets of EmbeddingBag must not decrease";
+  }
+  MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
+    MSHADOW_SGL_DBL_TYPE_SWITCH(out.type_flag_, DType, {
+      // check out of bound indices, the kernels and the backward rely on it
+      const IType* data_ptr = data.dptr<IType>();
+      bool is_valid         = true;
+      for (index_t k = 0; k < data_size && is_valid; ++k) {
+        const index_t row = static_cast<index_t>(data_ptr[k]);
+        is_valid          = row >= 0 && row < param.input_dim;
+      }
+      CHECK(is_valid) << "EmbeddingBag input contains data out of bound";
+      const DType* per_sample_weights =
+          param.use_weights ? inputs[embedding_bag::kPerSampleWeights].dptr<DType>() : nullptr;
+      MXNET_ASSIGN_REQ_SWITCH(req[embedding_bag::kOut], req_type, {
+        Kernel<EmbeddingBagForwardCPU<req_type>, cpu>::Launch(
+            s,
+            num_bags,
+            out.dptr<DType>(),
+            data_ptr,
+            offsets_ptr,
+            inputs[embedding_bag::kWeight].dptr<DType>(),
+            per_sample_weights,
+            data_size,
+            param.output_dim,
+            param.mode);
+      });
+    });
+  });
+}
+
+template <>
+void EmbeddingBagOpBackward<cpu>(const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const EmbeddingBagParam& param = nnvm::get<EmbeddingBagParam>(attrs.parsed);
+  CHECK_EQ(req[embedding_bag::kData], kNullOp)
+      << "EmbeddingBag layer doesn't support calculate data gradient";
+  CHECK_EQ(req[embedding_bag::kOffsets], kNullOp)
+      << "EmbeddingBag layer doesn't support calculate offsets gradient";
+  mshadow::Stream<cpu>* s  = ctx.get_stream<cpu>();
+  const TBlob& data        = inputs[1 + embedding_bag::kData];
+  const TBlob& weight_grad = outputs[embedding_bag::kWeight];
+  if (req[embedding_bag::kWeight] != kNullOp) {
+    MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
+      MSHADOW_SGL_DBL_TYPE_SWITCH(weight_grad.type_flag_, DType, {
+        if (req[embedding_bag::kWeight] != kAddTo) {
+          Fill<false>(s, weight_grad, kWriteTo, 0);
+        }
+        AddTakeGradDnsCPU(ctx,
+                          data.dptr<IType>(),
+                          static_cast<nnvm::dim_t>(data.Size()),
+                          weight_grad.dptr<DType>(),
+                          param.output_dim,
+                          MakeEmbeddingBagAddRow<DType>(param, inputs));
+      });
+    });
+  }
+  if (param.use_weights) {
+    EmbeddingBagWeightsGrad<cpu>(ctx,
+                                 param,
+                                 inputs,
+                                 req[embedding_bag::kPerSampleWeights],
+                                 outputs[embedding_bag::kPerSampleWeights]);
+  }
+}
+
+template <>
+void EmbeddingBagOpBackwardEx<cpu>(const nnvm::NodeAttrs& attrs,
+                                   const OpContext& ctx,
+                                   const std::vector<NDArray>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<NDArray>& outputs) {
+  const EmbeddingBagParam& param = nnvm::get<EmbeddingBagParam>(attrs.parsed);
+  CHECK_EQ(req[embedding_bag::kData], kNullOp)
+      << "EmbeddingBag layer doesn't support calculate data gradient";
+  CHECK_EQ(req[embedding_bag::kOffsets], kNullOp)
+      << "EmbeddingBag layer doesn't support calculate offsets gradient";
+  std::vector<TBlob> in_blobs;
+  for (const NDArray& input : inputs) {
+    in_blobs.push_back(input.data());
+  }
+  const TBlob& data          = in_blobs[1 + embedding_bag::kData];
+  const NDArray& weight_grad = outputs[embedding_bag::kWeight];
+  const OpReqType weight_req = req[embedding_bag::kWeight];
+  if (weight_req != kNullOp) {
+    CHECK_EQ(weight_req, kWriteTo) << "EmbeddingBag layer doesn't support "
+                                   << "weight gradient calculation with req != write";
+    MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
+      MSHADOW_SGL_DBL_TYPE_SWITCH(weight_grad.dtype(), DType, {
+        MSHADOW_IDX_TYPE_SWITCH(weight_grad.aux_type(rowsparse::kIdx), RType, {
+          AddTakeGradRspCPU<IType, DType, RType>(ctx,
+                                                 data.dptr<IType>(),
+                                                 static_cast<nnvm::dim_t>(data.Size()),
+                                                 param.output_dim,
+                                                 weight_grad,
+                                                 MakeEmbeddingBagAddRow<DType>(param, in_blobs));
+        });
+      });
+    });
+  }
+  if (param.use_weights) {
+    EmbeddingBagWeightsGrad<cpu>(ctx,
+                                 param,
+                                 in_blobs,
+                                 req[embedding_bag::kPerSampleWeights],
+                                 outputs[embedding_bag::kPerSampleWeights].data());
+  }
+}
+
+DMLC_REGISTER_PARAMETER(EmbeddingBagParam);
+
+NNVM_REGISTER_OP(_contrib_embedding_bag)
+    .describe(R"code(Maps bags of integer indices to the sum or mean of their embeddings.
+
+The indices of all bags are given one after the other in the 1-D ``data``, ``offsets`` holds the
+begin of each bag in ``data`` followed by the end of the last bag, as the ``indptr`` of a CSR
+matrix. The output for ``num_bags = len(offsets) - 1`` bags has shape ``(num_bags, output_dim)``,
+its row ``b`` is the sum (or the mean) of the embeddings of ``data[offsets[b]:offsets[b + 1]]``,
+each scaled by its entry of ``per_sample_weights`` if ``use_weights`` is True. An empty bag is
+zero. This is ``Embedding`` followed by a reduction over each bag, without the embeddings of all
+indices ever being in memory.
+
+All the indices should be integers in the range [0, input_dim). On CPU out of bound indices
+and malformed offsets raise an error, on GPU indices are clipped.
+
+Examples::
+
+  weight = [[ 0.,  1.],
+            [ 2.,  3.],
+            [ 4.,  5.]]
+
+  data    = [2, 0, 1, 1]
+  offsets = [0, 2, 2, 4]
+
+  embedding_bag(data, offsets, weight, input_dim=3, output_dim=2) = [[ 4.,  6.],
+                                                                     [ 0.,  0.],
+                                                                     [ 4.,  6.]]
+
+  embedding_bag(data, offsets, weight, input_dim=3, output_dim=2, mode='mean') = [[ 2.,  3.],
+                                                                                  [ 0.,  0.],
+                                                                                  [ 2.,  3.]]
+
+If "sparse_grad" is set to True, the storage type of gradient w.r.t weights will be
+"row_sparse", which only holds the rows of the indices.
+
+)code" ADD_FILELINE)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      return nnvm::get<EmbeddingBagParam>(attrs.parsed).use_weights ? 4 : 3;
+    })
+    .set_num_outputs(1)
+    .set_attr_parser(ParamParser<EmbeddingBagParam>)
+    .set_attr<nnvm::FListInputNames>(
+        "FListInputNames",
+        [](const NodeAttrs& attrs) {
+          std::vector<std::string> names{"data", "offsets", "weight"};
+          if (nnvm::get<EmbeddingBagParam>(attrs.parsed).use_weights) {
+            names.emplace_back("per_sample_weights");
+          }
+          return names;
+        })
+    .set_attr<mxnet::FInferShape>("FInferShape", EmbeddingBagOpShape)
+    .set_attr<nnvm::FInferType>("FInferType", EmbeddingBagOpType)
+    .set_attr<THasDeterministicOutput>("THasDeterministicOutput", true)
+    .set_attr<FCompute>("FCompute<cpu>", EmbeddingBagOpForward<cpu>)
+    .set_attr<nnvm::FGradient>(
+        "FGradient",
+        [](const nnvm::ObjectPtr& n, const std::vector<nnvm::NodeEntry>& ograds) {
+          // the weight is only needed for the gradient of per_sample_weights
+          std::vector<nnvm::NodeEntry> heads(n->inputs.begin(), n->inputs.begin() + 2);
+          if (nnvm::get<EmbeddingBagParam>(n->attrs.parsed).use_weights) {
+            heads.push_back(n->inputs[embedding_bag::kWeight]);
+            heads.push_back(n->inputs[embedding_bag::kPerSampleWeights]);
+          }
+          return MakeNonlossGradNode(
+              "_backward_contrib_embedding_bag", n, ograds, heads, n->attrs.dict);
+        })
+    .add_argument("data", "NDArray-or-Symbol", "The indices of all bags, one bag after the other.")
+    .add_argument("offsets",
+                  "NDArray-or-Symbol",
+                  "The int64 begin of each bag in data, followed by the end of the last bag.")
+    .add_argument("weight", "NDArray-or-Symbol", "The embedding weight matrix.")
+    .add_argument("per_sample_weights",
+                  "NDArray-or-Symbol",
+                  "The weight of each index of data, only if use_weights is True.")
+    .add_arguments(EmbeddingBagParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_contrib_embedding_bag)
+    .set_num_inputs([](const NodeAttrs& attrs) {
+      return nnvm::get<EmbeddingBagParam>(attrs.parsed).use_weights ? 5 : 3;
+    })
+    .set_num_outputs([](const NodeAttrs& attrs) {
+      return nnvm::get<EmbeddingBagParam>(attrs.parsed).use_weights ? 4 : 3;
+    })
+    .set_attr_parser(ParamParser<EmbeddingBagParam>)
+    .set_attr<FResourceRequest>("FResourceRequest",
+                                [](const NodeAttrs& attrs) {
+                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+                                })
+    .set_attr<FInferStorageType>("FInferStorageType", EmbeddingBagOpBackwardStorageType)
+    .set_attr<nnvm::TIsBackward>("TIsBackward", true)
+    .set_attr<FCompute>("FCompute<cpu>", EmbeddingBagOpBackward<cpu>)
+    .set_attr<FComputeEx>("FComputeEx<cpu>", EmbeddingBagOpBackwardEx<cpu>);
+
+}  // namespace op
+}  // namespace mxnet
@@ -0,0 +1,288 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file embedding_bag.cu
+ * \brief GPU implementation of the embedding bag operator
+ */
+#include "./embedding_bag-inl.h"
+#include "./util/tensor_util-inl.cuh"
+#include "./util/tensor_util-inl.h"
+
+namespace mxnet {
+namespace op {
+
+/*! \brief element i of the reduced embeddings, consecutive threads read consecutive columns */
+template <int req>
+struct EmbeddingBagForwardGPU {
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const IType* data,
+                                  const int64_t* offsets,
+                                  const DType* weight,
+                                  const DType* per_sample_weights,
+                                  const index_t data_size,
+                                  const index_t input_dim,
+                                  const index_t row_length,
+                                  const int mode) {
+    const index_t b = i / row_length;
+    const index_t j = i % row_length;
+    index_t begin, end;
+    EmbeddingBagRange(offsets, b, data_size, &begin, &end);
+    DType sum = 0;
+    for (index_t k = begin; k < end; ++k) {
+      const DType scale = EmbeddingBagScale(per_sample_weights, k, end - begin, mode);
+      sum += scale * weight[EmbeddingBagRow(data[k], input_dim) * row_length + j];
+    }
+    KERNEL_ASSIGN(out[i], req, sum);
+  }
+};
+
+/*! \brief marks the rows of the indices, clipped to the weight */
+struct EmbeddingBagMarkRowsGPU {
+  template <typename IType>
+  MSHADOW_XINLINE static void Map(index_t k,
+                                  nnvm::dim_t* row_flg,
+                                  const IType* data,
+                                  const index_t input_dim) {
+    row_flg[EmbeddingBagRow(data[k], input_dim)] = 1;
+  }
+};
+
+/*!
+ * \brief adds column j of the gradient of index k, the scaled ograd of its bag, into the dense
+ *  gradient, or into the row sparse one if prefix_sum, the prefix sum of the marked rows, is given
+ */
+struct EmbeddingBagGradGPU {
+  template <typename DType, typename IType>
+  __device__ __forceinline__ static void Map(index_t tid,
+                                             DType* grad,
+                                             const nnvm::dim_t* prefix_sum,
+                                             const DType* ograd,
+                                             const IType* data,
+                                             const int64_t* offsets,
+                                             const DType* per_sample_weights,
+                                             const index_t num_bags,
+                                             const index_t data_size,
+                                             const index_t input_dim,
+                                             const index_t row_length,
+                                             const int mode) {
+    const index_t k = tid / row_length;
+    const index_t j = tid % row_length;
+    const index_t b = EmbeddingBagOf(offsets, num_bags, k);
+    index_t begin, end;
+    EmbeddingBagRange(offsets, b, data_size, &begin, &end);
+    if (k < begin || k >= end)
+      return;
+    const index_t row      = EmbeddingBagRow(data[k], input_dim);
+    const index_t grad_row = prefix_sum ? prefix_sum[row] - 1 : row;
+    const DType scale      = EmbeddingBagScale(per_sample_weights, k, end - begin, mode);
+    atomicAdd(&grad[grad_row * row_length + j], scale * ograd[b * row_length + j]);
+  }
+};
+
+/*! \brief adds the gradients of the indices into grad, see EmbeddingBagGradGPU */
+template <typename DType, typename IType>
+void EmbeddingBagAddGradGPU(mshadow::Stream<gpu>* s,
+                            const EmbeddingBagParam& param,
+                            const std::vector<TBlob>& inputs,
+                            DType* grad,
+                            const nnvm::dim_t* prefix_sum) {
+  using namespace mxnet_op;
+  const TBlob& data    = inputs[1 + embedding_bag::kData];
+  const TBlob& offsets = inputs[1 + embedding_bag::kOffsets];
+  const DType* per_sample_weights =
+      param.use_weights ? inputs[1 + embedding_bag::kPerSampleWeights].dptr<DType>() : nullptr;
+  Kernel<EmbeddingBagGradGPU, gpu>::Launch(s,
+                                           data.Size() * param.output_dim,
+                                           grad,
+                                           prefix_sum,
+                                           inputs[0].dptr<DType>(),
+                                           data.dptr<IType>(),
+                                           offsets.dptr<int64_t>(),
+                                           per_sample_weights,
+                                           offsets.Size() - 1,
+                                           data.Size(),
+                                           param.input_dim,
+                                           param.output_dim,
+                                           param.mode);
+}
+
+template <>
+void EmbeddingBagOpForward<gpu>(const nnvm::NodeAttrs& attrs,
+                                const OpContext& ctx,
+                                const std::vector<TBlob>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<TBlob>& outputs) {
+  using namespace mxnet_op;
+  const EmbeddingBagParam& param = nnvm::get<EmbeddingBagParam>(attrs.parsed);
+  if (req[embedding_bag::kOut] == kNullOp)
+    return;
+  mshadow::Stream<gpu>* s = ctx.get_stream<gpu>();
+  const TBlob& data       = inputs[embedding_bag::kData];
+  const TBlob& out        = outputs[embedding_bag::kOut];
+  MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
+    MSHADOW_SGL_DBL_TYPE_SWITCH(out.type_flag_, DType, {
+      const DType* per_sample_weights =
+          param.use_weights ? inputs[embedding_bag::kPerSampleWeights].dptr<DType>() : nullptr;
+      MXNET_ASSIGN_REQ_SWITCH(req[embedding_bag::kOut], req_type, {
+        Kernel<EmbeddingBagForwardGPU<req_type>, gpu>::Launch(
+            s,
+            out.Size(),
+            out.dptr<DType>(),
+            data.dptr<IType>(),
+            inputs[embedding_bag::kOffsets].dptr<int64_t>(),
+            inputs[embedding_bag::kWeight].dptr<DType>(),
+            per_sample_weights,
+            data.Size(),
+            param.input_dim,
+            param.output_dim,
+            param.mode);
+      });
+    });
+  });
+}
+
+template <>
+void EmbeddingBagOpBackward<gpu>(const nnvm::NodeAttrs& attrs,
+                                 const OpContext& ctx,
+                                 const std::vector<TBlob>& inputs,
+                                 const std::vector<OpReqType>& req,
+                                 const std::vector<TBlob>& outputs) {
+  const EmbeddingBagParam& param = nnvm::get<EmbeddingBagParam>(attrs.parsed);
+  CHECK_EQ(req[embedding_bag::kData], kNullOp)
+      << "EmbeddingBag layer doesn't support calculate data gradient";
+  CHECK_EQ(req[embedding_bag::kOffsets], kNullOp)
+      << "EmbeddingBag layer doesn't support calculate offsets gradient";
+  mshadow::Stream<gpu>* s  = ctx.get_stream<gpu>();
+  const TBlob& weight_grad = outputs[embedding_bag::kWeight];
+  if (req[embedding_bag::kWeight] != kNullOp) {
+    MSHADOW_TYPE_SWITCH(inputs[1 + embedding_bag::kData].type_flag_, IType, {
+      MSHADOW_SGL_DBL_TYPE_SWITCH(weight_grad.type_flag_, DType, {
+        if (req[embedding_bag::kWeight] != kAddTo) {
+          Fill<false>(s, weight_grad, kWriteTo, 0);
+        }
+        EmbeddingBagAddGradGPU<DType, IType>(s, param, inputs, weight_grad.dptr<DType>(), nullptr);
+      });
+    });
+  }
+  if (param.use_weights) {
+    EmbeddingBagWeightsGrad<gpu>(ctx,
+                                 param,
+                                 inputs,
+                                 req[embedding_bag::kPerSampleWeights],
+                                 outputs[embedding_bag::kPerSampleWeights]);
+  }
+}
+
+template <>
+void EmbeddingBagOpBackwardEx<gpu>(const nnvm::NodeAttrs& attrs,
+                                   const OpContext& ctx,
+                                   const std::vector<NDArray>& inputs,
+                                   const std::vector<OpReqType>& req,
+                                   const std::vector<NDArray>& outputs) {
+  using namespace mshadow;
+  using namespace mxnet_op;
+  using nnvm::dim_t;
+  const EmbeddingBagParam& param = nnvm::get<EmbeddingBagParam>(attrs.parsed);
+  CHECK_EQ(req[embedding_bag::kData], kNullOp)
+      << "EmbeddingBag layer doesn't support calculate data gradient";
+  CHECK_EQ(req[embedding_bag::kOffsets], kNullOp)
+      << "EmbeddingBag layer doesn't support calculate offsets gradient";
+  std::vector<TBlob> in_blobs;
+  for (const NDArray& input : inputs) {
+    in_blobs.push_back(input.data());
+  }
+  Stream<gpu>* s             = ctx.get_stream<gpu>();
+  const TBlob& data          = in_blobs[1 + embedding_bag::kData];
+  const NDArray& weight_grad = outputs[embedding_bag::kWeight];
+  const OpReqType weight_req = req[embedding_bag::kWeight];
+  const dim_t num_rows       = param.input_dim;
+  if (weight_req != kNullOp) {
+    CHECK_EQ(weight_req, kWriteTo) << "EmbeddingBag layer doesn't support "
+                                   << "weight gradient calculation with req != write";
+    MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
+      MSHADOW_SGL_DBL_TYPE_SWITCH(weight_grad.dtype(), DType, {
+        MSHADOW_IDX_TYPE_SWITCH(weight_grad.aux_type(rowsparse::kIdx), RType, {
+          // mark the rows of the indices and number them by an inclusive prefix sum
+          dim_t* prefix_sum         = nullptr;
+          void* d_temp_storage      = nullptr;
+          size_t temp_storage_bytes = 0;
+          cub::DeviceScan::InclusiveSum(d_temp_storage,
+                                        temp_storage_bytes,
+                                        prefix_sum,
+                                        prefix_sum,
+                                        num_rows,
+                                        Stream<gpu>::GetStream(s));
+          Tensor<gpu, 1, char> workspace =
+              ctx.requested[embedding_bag::kTempSpace].get_space_typed<gpu, 1, char>(
+                  Shape1(num_rows * sizeof(dim_t) + temp_storage_bytes), s);
+          prefix_sum     = reinterpret_cast<dim_t*>(workspace.dptr_);
+          d_temp_storage = workspace.dptr_ + num_rows * sizeof(dim_t);
+          Fill<false>(s, TBlob(prefix_sum, Shape1(num_rows), gpu::kDevMask), kWriteTo, 0);
+          Kernel<EmbeddingBagMarkRowsGPU, gpu>::Launch(
+              s, data.Size(), prefix_sum, data.dptr<IType>(), param.input_dim);
+          cub::DeviceScan::InclusiveSum(d_temp_storage,
+                                        temp_storage_bytes,
+                                        prefix_sum,
+                                        prefix_sum,
+                                        num_rows,
+                                        Stream<gpu>::GetStream(s));
+          dim_t nnr = 0;
+          CUDA_CALL(cudaMemcpyAsync(&nnr,
+                                    &prefix_sum[num_rows - 1],
+                                    sizeof(dim_t),
+                                    cudaMemcpyDeviceToHost,
+                                    Stream<gpu>::GetStream(s)));
+          CUDA_CALL(cudaStreamSynchronize(Stream<gpu>::GetStream(s)));
+          if (nnr == 0) {
+            FillZerosRspImpl(s, weight_grad);
+          } else {
+            weight_grad.CheckAndAlloc({Shape1(nnr)});
+            RType* grad_row_idx = weight_grad.aux_data(rowsparse::kIdx).dptr<RType>();
+            Kernel<FillRspRowIdxKernel, gpu>::Launch(
+                s, num_rows, grad_row_idx, prefix_sum, num_rows);
+            DType* grad_data = weight_grad.data().dptr<DType>();
+            Fill<false>(
+                s, TBlob(grad_data, Shape1(nnr * param.output_dim), gpu::kDevMask), kWriteTo, 0);
+            EmbeddingBagAddGradGPU<DType, IType>(s, param, in_blobs, grad_data, prefix_sum);
+          }
+        });
+      });
+    });
+  }
+  if (param.use_weights) {
+    EmbeddingBagWeightsGrad<gpu>(ctx,
+                                 param,
+                                 in_blobs,
+                                 req[embedding_bag::kPerSampleWeights],
+                                 outputs[embedding_bag::kPerSampleWeights].data());
+  }
+}
+
+NNVM_REGISTER_OP(_contrib_embedding_bag)
+    .set_attr<FCompute>("FCompute<gpu>", EmbeddingBagOpForward<gpu>);
+
+NNVM_REGISTER_OP(_backward_contrib_embedding_bag)
+    .set_attr<FCompute>("FCompute<gpu>", EmbeddingBagOpBackward<gpu>)
+    .set_attr<FComputeEx>("FComputeEx<gpu>", EmbeddingBagOpBackwardEx<gpu>);
+
+}  // namespace op
+}  // namespace mxnet
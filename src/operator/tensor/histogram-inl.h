@@ -33,6 +33,7 @@
 #include <nnvm/op.h>
 #include <nnvm/node.h>
 #include <nnvm/op_attr_types.h>
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -42,6 +43,9 @@
 #include "../mshadow_op.h"
 #include "../mxnet_op.h"
 #include "../operator_common.h"
+#if defined(__CUDACC__)
+#include "../../common/cuda/utils.h"
+#endif  // __CUDACC__
 
 namespace mxnet {
 namespace op {
@@ -83,6 +87,192 @@ struct FillBinBoundsKernel {
   }
 };
 
+/*! \brief bin of an element among bin_cnt uniform bins over [min, max], -1 outside */
+template <typename DType>
+struct HistogramUniformBin {
+  const DType* data;
+  const DType* bin_bounds;
+  int bin_cnt;
+  double min;
+  double max;
+
+  MSHADOW_XINLINE int operator()(index_t i) const {
+    const DType value = data[i];
+    int target        = -1;
+    if (value >= min && value <= max) {
+      target = static_cast<int>((value - min) * bin_cnt / (max - min));
+      target = mshadow_op::minimum::Map(bin_cnt - 1, target);
+      // the rounding of the bounds decides the elements at the edge of a bin
+      target -= (value < bin_bounds[target]) ? 1 : 0;
+      target += ((value >= bin_bounds[target + 1]) && (target != bin_cnt - 1)) ? 1 : 0;
+    }
+    return target;
+  }
+};
+
+/*! \brief bin of an element among the bin_cnt bins of sorted bounds, -1 outside */
+template <typename DType>
+struct HistogramBoundsBin {
+  const DType* data;
+  const DType* bin_bounds;
+  int bin_cnt;
+
+  MSHADOW_XINLINE int operator()(index_t i) const {
+    const DType value = data[i];
+    if (!(value >= bin_bounds[0] && value <= bin_bounds[bin_cnt]))
+      return -1;
+    // the last bound not above the value, the last bin including its upper bound
+    int lo = 0, hi = bin_cnt;
+    while (hi - lo > 1) {
+      const int mid = (lo + hi) / 2;
+      if (value >= bin_bounds[mid]) {
+        lo = mid;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+};
+
+/*! \brief weight of the elements counted once */
+template <typename CType>
+struct HistogramUnitWeight {
+  MSHADOW_XINLINE CType operator()(index_t i) const {
+    return CType(1);
+  }
+};
+
+/*! \brief weight of the elements read from an array */
+template <typename CType>
+struct HistogramArrayWeight {
+  const CType* weights;
+
+  MSHADOW_XINLINE CType operator()(index_t i) const {
+    return weights[i];
+  }
+};
+
+/*!
+ * \brief out[bin(i)] += weight(i) for the n elements whose bin is not negative. Each thread
+ *  accumulates a contiguous part of the elements into a local histogram, and the histograms are
+ *  summed into out in the order of the parts, so that weighted sums do not depend on scheduling.
+ */
+template <typename CType, typename BinOp, typename WeightOp>
+void PrivatizedHistogram(mshadow::Stream<cpu>* s,
+                         index_t n,
+                         index_t bin_cnt,
+                         CType* out,
+                         const BinOp& bin,
+                         const WeightOp& weight) {
+  const index_t omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  // a local histogram pays off when its part has a few elements per bin
+  const index_t nthreads = std::max<index_t>(1, std::min(omp_threads, n / (4 * bin_cnt + 1)));
+  if (nthreads == 1) {
+    for (index_t i = 0; i < n; ++i) {
+      const int target = bin(i);
+      if (target >= 0)
+        out[target] += weight(i);
+    }
+    return;
+  }
+  std::vector<CType> local(nthreads * bin_cnt, CType(0));
+#pragma omp parallel for num_threads(nthreads)
+  for (index_t t = 0; t < nthreads; ++t) {
+    CType* hist       = local.data() + t * bin_cnt;
+    const index_t end = n * (t + 1) / nthreads;
+    for (index_t i = n * t / nthreads; i < end; ++i) {
+      const int target = bin(i);
+      if (target >= 0)
+        hist[target] += weight(i);
+    }
+  }
+#pragma omp parallel for num_threads(nthreads)
+  for (index_t b = 0; b < bin_cnt; ++b) {
+    CType sum = out[b];
+    for (index_t t = 0; t < nthreads; ++t) {
+      sum += local[t * bin_cnt + b];
+    }
+    out[b] = sum;
+  }
+}
+
+#if defined(__CUDACC__)
+
+/*! \brief the largest histogram accumulated in shared memory */
+constexpr size_t kMaxPrivatizedHistogramBytes = 32 * 1024;
+
+template <typename CType, typename BinOp, typename WeightOp>
+__global__ void privatized_histogram_kernel(index_t n,
+                                            int bin_cnt,
+                                            CType* out,
+                                            const BinOp bin,
+                                            const WeightOp weight) {
+  extern __shared__ char buf[];
+  CType* hist = reinterpret_cast<CType*>(buf);
+  for (int b = threadIdx.x; b < bin_cnt; b += blockDim.x) {
+    hist[b] = CType(0);
+  }
+  __syncthreads();
+  for (index_t i = static_cast<index_t>(blockIdx.x) * blockDim.x + threadIdx.x; i < n;
+       i += static_cast<index_t>(blockDim.x) * gridDim.x) {
+    const int target = bin(i);
+    if (target >= 0)
+      atomicAdd(&hist[target], weight(i));
+  }
+  __syncthreads();
+  // one global atomic per bin and block
+  for (int b = threadIdx.x; b < bin_cnt; b += blockDim.x) {
+    if (hist[b] != CType(0))
+      atomicAdd(&out[b], hist[b]);
+  }
+}
+
+template <typename CType, typename BinOp, typename WeightOp>
+__global__ void global_histogram_kernel(index_t n,
+                                        CType* out,
+                                        const BinOp bin,
+                                        const WeightOp weight) {
+  for (index_t i = static_cast<index_t>(blockIdx.x) * blockDim.x + threadIdx.x; i < n;
+       i += static_cast<index_t>(blockDim.x) * gridDim.x) {
+    const int target = bin(i);
+    if (target >= 0)
+      atomicAdd(&out[target], weight(i));
+  }
+}
+
+/*!
+ * \brief out[bin(i)] += weight(i) for the n elements whose bin is not negative. Each block
+ *  accumulates into a histogram in shared memory merged into out at the end, unless the bins do
+ *  not fit, in which case the elements are added to out directly.
+ */
+template <typename CType, typename BinOp, typename WeightOp>
+void PrivatizedHistogram(mshadow::Stream<gpu>* s,
+                         index_t n,
+                         index_t bin_cnt,
+                         CType* out,
+                         const BinOp& bin,
+                         const WeightOp& weight) {
+  if (n == 0)
+    return;
+  const int threads     = 256;
+  const size_t smem     = bin_cnt * sizeof(CType);
+  const bool privatized = smem <= kMaxPrivatizedHistogramBytes;
+  cudaStream_t stream   = mshadow::Stream<gpu>::GetStream(s);
+  // few blocks per multiprocessor when each of them has bins to merge
+  const index_t max_blocks = (privatized ? 4 : 32) * MultiprocessorCount(s->dev_id);
+  const int blocks         = static_cast<int>(std::min((n + threads - 1) / threads, max_blocks));
+  if (privatized) {
+    privatized_histogram_kernel<<<blocks, threads, smem, stream>>>(n, bin_cnt, out, bin, weight);
+    MSHADOW_CUDA_POST_KERNEL_CHECK(privatized_histogram_kernel);
+  } else {
+    global_histogram_kernel<<<blocks, threads, 0, stream>>>(n, out, bin, weight);
+    MSHADOW_CUDA_POST_KERNEL_CHECK(global_histogram_kernel);
+  }
+}
+
+#endif  // __CUDACC__
+
 inline bool HistogramOpShape(const nnvm::NodeAttrs& attrs,
                              mxnet::ShapeVector* in_attrs,
                              mxnet::ShapeVector* out_attrs) {
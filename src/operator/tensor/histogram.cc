@@ -26,55 +26,6 @@
 namespace mxnet {
 namespace op {
 
-struct ComputeBinKernel {
-  template <typename DType>
-  MSHADOW_XINLINE static void Map(index_t i,
-                                  const DType* in_data,
-                                  const DType* bin_bounds,
-                                  int* bin_indices,
-                                  int bin_cnt,
-                                  double min,
-                                  double max) {
-    DType data = in_data[i];
-    int target = -1;
-    if (data >= min && data <= max) {
-      target = (data - min) * bin_cnt / (max - min);
-      target = mshadow_op::minimum::Map(bin_cnt - 1, target);
-      target -= (data < bin_bounds[target]) ? 1 : 0;
-      target += ((data >= bin_bounds[target + 1]) && (target != bin_cnt - 1)) ? 1 : 0;
-    }
-    bin_indices[i] = target;
-  }
-
-  template <typename DType>
-  MSHADOW_XINLINE static void Map(index_t i,
-                                  const DType* in_data,
-                                  int* bin_indices,
-                                  const DType* bin_bounds,
-                                  int num_bins) {
-    DType data = in_data[i];
-    int target = -1;
-    if (data >= bin_bounds[0] && data <= bin_bounds[num_bins]) {
-      target = 0;
-      while ((data - bin_bounds[target]) >= 0) {
-        target += 1;
-      }
-      target = mshadow_op::minimum::Map(target - 1, num_bins - 1);
-    }
-    bin_indices[i] = target;
-  }
-};
-
-template <typename CType>
-void ComputeHistogram(const int* bin_indices, CType* out_data, size_t input_size) {
-  for (size_t i = 0; i < input_size; ++i) {
-    int target = bin_indices[i];
-    if (target >= 0) {
-      out_data[target] += 1;
-    }
-  }
-}
-
 template <>
 void HistogramForwardImpl<cpu>(const OpContext& ctx,
                                const TBlob& in_data,
@@ -84,23 +35,21 @@ void HistogramForwardImpl<cpu>(const OpContext& ctx,
   using namespace mshadow;
   using namespace mxnet_op;
   mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
-  Tensor<cpu, 1, int> bin_indices =
-      ctx.requested[0].get_space_typed<cpu, 1, int>(Shape1(in_data.Size()), s);
-  const int bin_cnt = out_data.Size();
+  const int bin_cnt       = out_data.Size();
 
   MSHADOW_TYPE_SWITCH(in_data.type_flag_, DType, {
-    Kernel<ComputeBinKernel, cpu>::Launch(s,
-                                          in_data.Size(),
-                                          in_data.dptr<DType>(),
-                                          bin_indices.dptr_,
-                                          bin_bounds.dptr<DType>(),
-                                          bin_cnt);
     Kernel<op_with_req<mshadow_op::identity, kWriteTo>, cpu>::Launch(
         s, bin_bounds.Size(), out_bins.dptr<DType>(), bin_bounds.dptr<DType>());
-  });
-  MSHADOW_TYPE_SWITCH(out_data.type_flag_, CType, {
-    Kernel<set_zero, cpu>::Launch(s, bin_cnt, out_data.dptr<CType>());
-    ComputeHistogram(bin_indices.dptr_, out_data.dptr<CType>(), in_data.Size());
+    MSHADOW_IDX_TYPE_SWITCH(out_data.type_flag_, CType, {
+      Kernel<set_zero, cpu>::Launch(s, bin_cnt, out_data.dptr<CType>());
+      PrivatizedHistogram(
+          s,
+          in_data.Size(),
+          bin_cnt,
+          out_data.dptr<CType>(),
+          HistogramBoundsBin<DType>{in_data.dptr<DType>(), bin_bounds.dptr<DType>(), bin_cnt},
+          HistogramUnitWeight<CType>());
+    });
   });
 }
 
@@ -115,24 +64,20 @@ void HistogramForwardImpl<cpu>(const OpContext& ctx,
   using namespace mshadow;
   using namespace mxnet_op;
   mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
-  Tensor<cpu, 1, int> bin_indices =
-      ctx.requested[0].get_space_typed<cpu, 1, int>(Shape1(in_data.Size()), s);
 
   MSHADOW_TYPE_SWITCH(in_data.type_flag_, DType, {
     Kernel<FillBinBoundsKernel, cpu>::Launch(
         s, bin_cnt + 1, out_bins.dptr<DType>(), bin_cnt, min, max);
-    Kernel<ComputeBinKernel, cpu>::Launch(s,
-                                          in_data.Size(),
-                                          in_data.dptr<DType>(),
-                                          out_bins.dptr<DType>(),
-                                          bin_indices.dptr_,
-                                          bin_cnt,
-                                          min,
-                                          max);
-  });
-  MSHADOW_TYPE_SWITCH(out_data.type_flag_, CType, {
-    Kernel<set_zero, cpu>::Launch(s, bin_cnt, out_data.dptr<CType>());
-    ComputeHistogram(bin_indices.dptr_, out_data.dptr<CType>(), in_data.Size());
+    MSHADOW_IDX_TYPE_SWITCH(out_data.type_flag_, CType, {
+      Kernel<set_zero, cpu>::Launch(s, bin_cnt, out_data.dptr<CType>());
+      PrivatizedHistogram(s,
+                          in_data.Size(),
+                          bin_cnt,
+                          out_data.dptr<CType>(),
+                          HistogramUniformBin<DType>{
+                              in_data.dptr<DType>(), out_bins.dptr<DType>(), bin_cnt, min, max},
+                          HistogramUnitWeight<CType>());
+    });
   });
 }
 
@@ -165,10 +110,6 @@ Example::
                                                   std::vector<std::string>{"data"} :
                                                   std::vector<std::string>{"data", "bins"};
                                      })
-    .set_attr<FResourceRequest>("FResourceRequest",
-                                [](const NodeAttrs& attrs) {
-                                  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
-                                })
     .set_attr<THasDeterministicOutput>("THasDeterministicOutput", true)
     .set_attr<mxnet::FInferShape>("FInferShape", HistogramOpShape)
     .set_attr<nnvm::FInferType>("FInferType", HistogramOpType)
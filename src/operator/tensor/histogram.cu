@@ -27,49 +27,6 @@
 namespace mxnet {
 namespace op {
 
-struct HistogramFusedKernel {
-  template <typename DType, typename CType>
-  static MSHADOW_XINLINE void Map(int i,
-                                  const DType* in_data,
-                                  const DType* bin_bounds,
-                                  CType* bins,
-                                  const int bin_cnt,
-                                  const double min,
-                                  const double max) {
-    DType data = in_data[i];
-    int target = -1;
-    if (data >= min && data <= max) {
-      target = mshadow_op::floor::Map((data - min) * bin_cnt / (max - min));
-      target = mshadow_op::minimum::Map(bin_cnt - 1, target);
-      target -= (data < bin_bounds[target]) ? 1 : 0;
-      target += ((data >= bin_bounds[target + 1]) && (target != bin_cnt - 1)) ? 1 : 0;
-    }
-    if (target >= 0) {
-      atomicAdd(&bins[target], CType(1));
-    }
-  }
-
-  template <typename DType, typename CType>
-  static MSHADOW_XINLINE void Map(int i,
-                                  const DType* in_data,
-                                  const DType* bin_bounds,
-                                  CType* bins,
-                                  const int bin_cnt) {
-    DType data = in_data[i];
-    int target = -1;
-    if (data >= bin_bounds[0] && data <= bin_bounds[bin_cnt]) {
-      target = 0;
-      while (data >= bin_bounds[target]) {
-        target += 1;
-      }
-      target = min(target - 1, bin_cnt - 1);
-    }
-    if (target >= 0) {
-      atomicAdd(&bins[target], CType(1));
-    }
-  }
-};
-
 template <>
 void HistogramForwardImpl<gpu>(const OpContext& ctx,
                                const TBlob& in_data,
@@ -83,12 +40,13 @@ void HistogramForwardImpl<gpu>(const OpContext& ctx,
     MSHADOW_IDX_TYPE_SWITCH(out_data.type_flag_, CType, {
       int bin_cnt = out_bins.Size() - 1;
       Kernel<set_zero, gpu>::Launch(s, bin_cnt, out_data.dptr<CType>());
-      Kernel<HistogramFusedKernel, gpu>::Launch(s,
-                                                in_data.Size(),
-                                                in_data.dptr<DType>(),
-                                                bin_bounds.dptr<DType>(),
-                                                out_data.dptr<CType>(),
-                                                bin_cnt);
+      PrivatizedHistogram(
+          s,
+          in_data.Size(),
+          bin_cnt,
+          out_data.dptr<CType>(),
+          HistogramBoundsBin<DType>{in_data.dptr<DType>(), bin_bounds.dptr<DType>(), bin_cnt},
+          HistogramUnitWeight<CType>());
       Kernel<op_with_req<mshadow_op::identity, kWriteTo>, gpu>::Launch(
           s, bin_bounds.Size(), out_bins.dptr<DType>(), bin_bounds.dptr<DType>());
     });
@@ -111,14 +69,13 @@ void HistogramForwardImpl<gpu>(const OpContext& ctx,
       Kernel<set_zero, gpu>::Launch(s, bin_cnt, out_data.dptr<CType>());
       Kernel<FillBinBoundsKernel, gpu>::Launch(
           s, bin_cnt + 1, out_bins.dptr<DType>(), bin_cnt, min, max);
-      Kernel<HistogramFusedKernel, gpu>::Launch(s,
-                                                in_data.Size(),
-                                                in_data.dptr<DType>(),
-                                                out_bins.dptr<DType>(),
-                                                out_data.dptr<CType>(),
-                                                bin_cnt,
-                                                min,
-                                                max);
+      PrivatizedHistogram(s,
+                          in_data.Size(),
+                          bin_cnt,
+                          out_data.dptr<CType>(),
+                          HistogramUniformBin<DType>{
+                              in_data.dptr<DType>(), out_bins.dptr<DType>(), bin_cnt, min, max},
+                          HistogramUnitWeight<CType>());
     });
   });
 }
@@ -59,8 +59,16 @@ inline bool IndexModifyOpType(const nnvm::NodeAttrs& attrs,
   return (*out_attrs)[0] != -1;
 }
 
+/*!
+ * \brief Bytes of workspace IndexAddForwardCalc needs to add ind_num rows of val into num_rows
+ * rows of a, 0 if it scatters them with atomics
+ */
+template <typename xpu>
+size_t IndexAddForwardWorkspaceSize(const int ind_num, const index_t num_rows);
+
 template <typename xpu, typename DType>
 void IndexAddForwardCalc(mshadow::Stream<xpu>* s,
+                         const mshadow::Tensor<xpu, 1, char>& workspace,
                          const int ind_num,
                          DType* out,
                          const DType* val,
@@ -148,10 +156,18 @@ void IndexAddOpForward(const nnvm::NodeAttrs& attrs,
   mshadow::Shape<MXNET_SPECIAL_MAX_NDIM> a_pre_stride = calc_stride(a_pre_shape);
   mshadow::Shape<MXNET_SPECIAL_MAX_NDIM> val_stride   = calc_stride(val_shape);
   mxnet_op::copy(s, out, a);
-  TBlob t_ind = TBlob(ctx.requested[0].get_space_typed<xpu, 1, int>(Shape1(ind.shape_.Size()), s));
+  const size_t ind_bytes     = ind.shape_.Size() * sizeof(int);
+  const size_t scatter_bytes =
+      IndexAddForwardWorkspaceSize<xpu>(ind_num, a.shape_.ProdShape(0, ind_ndim));
+  Tensor<xpu, 1, char> workspace =
+      ctx.requested[0].get_space_typed<xpu, 1, char>(Shape1(ind_bytes + scatter_bytes), s);
+  TBlob t_ind = TBlob(Tensor<xpu, 1, int>(
+      reinterpret_cast<int*>(workspace.dptr_), Shape1(ind.shape_.Size()), s));
+  Tensor<xpu, 1, char> scatter_space(workspace.dptr_ + ind_bytes, Shape1(scatter_bytes), s);
   mxnet_op::copy(s, t_ind, ind);
   MSHADOW_TYPE_SWITCH(a.type_flag_, DType, {
     IndexAddForwardCalc<xpu, DType>(s,
+                                    scatter_space,
                                     ind_num,
                                     out.dptr<DType>(),
                                     val.dptr<DType>(),
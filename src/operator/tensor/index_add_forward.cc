@@ -69,8 +69,14 @@ struct IndexAddForwardCPUKernel {
   }
 };
 
+template <>
+size_t IndexAddForwardWorkspaceSize<cpu>(const int ind_num, const index_t num_rows) {
+  return 0;
+}
+
 template <typename xpu, typename DType>
 void IndexAddForwardCalc(mshadow::Stream<xpu>* s,
+                         const mshadow::Tensor<xpu, 1, char>& workspace,
                          const int ind_num,
                          DType* out,
                          const DType* val,
@@ -24,6 +24,7 @@
 
 #include <cub/cub.cuh>
 #include "./index_add-inl.h"
+#include "./indexing_op-inl.cuh"
 #include "../tensor/util/tensor_util-inl.cuh"
 #include "../tensor/util/tensor_util-inl.h"
 
@@ -63,8 +64,57 @@ struct IndexAddForwardGPUKernel {
   }
 };
 
+/*!
+ * \brief row_of functor of SortedScatter: the row of a, flattened over its first ind_ndim axes,
+ * that the i-th index tuple adds to
+ */
+struct IndexAddRow {
+  const int* ind;
+  mshadow::Shape<MXNET_SPECIAL_MAX_NDIM> a_pre_stride;
+  int ind_num;
+  int ind_ndim;
+  int seg;
+  MSHADOW_XINLINE int operator()(const index_t i) const {
+    index_t id = 0;
+    for (int dim = 0; dim < ind_ndim; ++dim) {
+      id += a_pre_stride[seg + dim] * ind[dim * ind_num + i];
+    }
+    return static_cast<int>(id);
+  }
+};
+
+/*!
+ * \brief src functor of SortedScatter: element j of the row of val, broadcast like in
+ * IndexAddForwardGPUKernel, that the i-th index tuple adds
+ */
+template <typename DType>
+struct IndexAddVal {
+  const DType* val;
+  mshadow::Shape<MXNET_SPECIAL_MAX_NDIM> a_tail_shape;
+  mshadow::Shape<MXNET_SPECIAL_MAX_NDIM> val_stride;
+  mshadow::Shape<MXNET_SPECIAL_MAX_NDIM> val_shape;
+  int ind_ndim;
+  int a_ndim;
+  int seg;
+  MSHADOW_XINLINE DType operator()(const index_t i, const index_t j) const {
+    mshadow::Shape<MXNET_SPECIAL_MAX_NDIM> a_tail_id = mxnet_op::unravel(j, a_tail_shape);
+    mshadow::Shape<MXNET_SPECIAL_MAX_NDIM> val_id;
+    for (int _j = seg; _j < seg + a_ndim; ++_j) {
+      val_id[_j] = (val_shape[_j] == 1) ? 0 : a_tail_id[_j];
+    }
+    val_id[seg + ind_ndim - 1] = (val_shape[seg + ind_ndim - 1] == 1) ? 0 : i;
+    return val[mxnet_op::dot(val_id, val_stride)];
+  }
+};
+
+template <>
+size_t IndexAddForwardWorkspaceSize<gpu>(const int ind_num, const index_t num_rows) {
+  return UseSortedScatter(ind_num, num_rows) ? SortedScatterWorkspaceSize(ind_num) : 0;
+}
+
 template <typename xpu, typename DType>
 void IndexAddForwardCalc(mshadow::Stream<xpu>* s,
+                         const mshadow::Tensor<xpu, 1, char>& workspace,
                          const int ind_num,
                          DType* out,
                          const DType* val,
@@ -79,6 +129,25 @@ void IndexAddForwardCalc(mshadow::Stream<xpu>* s,
                          const int a_ndim) {
   using namespace mxnet_op;
   using namespace mshadow;
+  if (workspace.size(0) > 0) {
+    // IndexAddForwardWorkspaceSize chose to sort the rows instead of scattering with atomics
+    using AType      = typename AccType<DType>::type;
+    const int seg    = MXNET_SPECIAL_MAX_NDIM - a_ndim;
+    index_t num_rows = 1;
+    for (int dim = 0; dim < ind_ndim; ++dim) {
+      num_rows *= a_shape[seg + dim];
+    }
+    SortedScatter<AType, true>(
+        s,
+        workspace,
+        out,
+        ind_num,
+        num_rows,
+        a_tail_size,
+        IndexAddRow{ind, a_pre_stride, ind_num, ind_ndim, seg},
+        IndexAddVal<DType>{val, a_tail_shape, val_stride, val_shape, ind_ndim, a_ndim, seg});
+    return;
+  }
   Kernel<IndexAddForwardGPUKernel<DType>, xpu>::Launch(s,
                                                        ind_num,
                                                        out,
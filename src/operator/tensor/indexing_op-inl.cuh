@@ -26,8 +26,12 @@
 #define MXNET_OPERATOR_TENSOR_INDEXING_OP_CUH_
 #include <cub/device/device_run_length_encode.cuh>
 #include <cub/device/device_scan.cuh>
+#include <dmlc/parameter.h>
+#include <limits>
 #include "../mxnet_op.h"
 #include "../mshadow_op.h"
+#include "../../common/utils.h"
+#include "./sort_op.h"
 #include "./util/tensor_util-inl.cuh"
 
 #if CUDA_VERSION >= 9000
@@ -322,6 +326,144 @@ inline void AddTakeGradLargeBatch(mshadow::Tensor<gpu, 2, DType> dst,
                                     num_runs_ptr, dst.size(0));
 }
 
+/*!
+ * \brief Minimum average number of source rows per destination row above which a scatter-add
+ * sorts the destinations instead of contending on atomicAdd, see UseSortedScatter.
+ */
+const int kSortedScatterMinRepeats = 4;
+
+/*!
+ * \brief Whether a GPU scatter of num_items source rows into num_rows destination rows should
+ * use SortedScatter instead of atomicAdd. The sorted path is deterministic, so it is always
+ * taken under MXNET_ENFORCE_DETERMINISM; otherwise only when the destinations repeat so often
+ * that the atomics serialize.
+ */
+inline bool UseSortedScatter(const index_t num_items, const index_t num_rows) {
+  if (num_items <= 1 || num_rows <= 0) {
+    return false;
+  }
+  // the destinations are sorted as int keys
+  if (num_items > std::numeric_limits<int>::max() || num_rows > std::numeric_limits<int>::max()) {
+    return false;
+  }
+  if (dmlc::GetEnv("MXNET_ENFORCE_DETERMINISM", false)) {
+    return true;
+  }
+  return num_items >= kSortedScatterMinRepeats * num_rows;
+}
+
+/*!
+ * \brief Bytes of workspace SortedScatter needs for num_items source rows
+ */
+inline size_t SortedScatterWorkspaceSize(const index_t num_items) {
+  return 2 * num_items * sizeof(int) + SortByKeyWorkspaceSize<int, int, gpu>(num_items);
+}
+
+/*!
+ * \brief fills the destination row and the position of each source row, the keys and values
+ * sorted by SortedScatter
+ */
+struct sorted_scatter_rows {
+  template <typename RowOp>
+  MSHADOW_XINLINE static void Map(index_t i, int* rows, int* positions, const RowOp row_of) {
+    rows[i]      = row_of(i);
+    positions[i] = i;
+  }
+};
+
+/*!
+ * \brief src functor of SortedScatter for source rows stored contiguously
+ */
+template <typename DType>
+struct SortedScatterDenseSrc {
+  const DType* data;
+  index_t row_length;
+  MSHADOW_XINLINE DType operator()(const index_t i, const index_t j) const {
+    return data[i * row_length + j];
+  }
+};
+
+/*!
+ * \brief One thread per (sorted source row, column): the thread of the first source row of each
+ * destination row walks its run in the original order, so no two threads write the same element.
+ * With accumulate the run is added to dst in AType, otherwise the last source row of the run is
+ * written, i.e. the one a sequential scatter would leave.
+ */
+template <typename AType, bool accumulate>
+struct sorted_scatter {
+  template <typename DType, typename SrcOp>
+  MSHADOW_XINLINE static void Map(index_t tid,
+                                  DType* dst,
+                                  const int* sorted_rows,
+                                  const int* positions,
+                                  const index_t num_items,
+                                  const index_t row_length,
+                                  const SrcOp src) {
+    index_t pos       = tid / row_length;
+    const index_t col = tid % row_length;
+    if (pos > 0 && sorted_rows[pos - 1] == sorted_rows[pos]) {
+      return;
+    }
+    const index_t row = sorted_rows[pos];
+    if (accumulate) {
+      AType sum = static_cast<AType>(dst[row * row_length + col]);
+      do {
+        sum += static_cast<AType>(src(positions[pos], col));
+        ++pos;
+      } while (pos < num_items && sorted_rows[pos] == row);
+      dst[row * row_length + col] = static_cast<DType>(sum);
+    } else {
+      while (pos + 1 < num_items && sorted_rows[pos + 1] == row) {
+        ++pos;
+      }
+      dst[row * row_length + col] = src(positions[pos], col);
+    }
+  }
+};
+
+/*!
+ * \brief Deterministic, atomic-free scatter of num_items rows of row_length elements into dst,
+ * a (num_rows, row_length) array: source row i goes to dst row row_of(i), and src(i, j) gives
+ * its j-th element. The destinations are stable-sorted with the source positions, then every
+ * run of equal destinations is reduced by sorted_scatter.
+ * \param workspace at least SortedScatterWorkspaceSize(num_items) bytes
+ */
+template <typename AType, bool accumulate, typename DType, typename RowOp, typename SrcOp>
+inline void SortedScatter(mshadow::Stream<gpu>* s,
+                          const mshadow::Tensor<gpu, 1, char>& workspace,
+                          DType* dst,
+                          const index_t num_items,
+                          const index_t num_rows,
+                          const index_t row_length,
+                          const RowOp& row_of,
+                          const SrcOp& src) {
+  using namespace mxnet_op;
+  if (num_items == 0 || row_length == 0) {
+    return;
+  }
+  CHECK_GE(workspace.size(0), SortedScatterWorkspaceSize(num_items));
+  const size_t keys_bytes = num_items * sizeof(int);
+  mshadow::Tensor<gpu, 1, int> sorted_rows(
+      reinterpret_cast<int*>(workspace.dptr_), mshadow::Shape1(num_items), s);
+  mshadow::Tensor<gpu, 1, int> positions(
+      reinterpret_cast<int*>(workspace.dptr_ + keys_bytes), mshadow::Shape1(num_items), s);
+  mshadow::Tensor<gpu, 1, char> sort_space(
+      workspace.dptr_ + 2 * keys_bytes, mshadow::Shape1(workspace.size(0) - 2 * keys_bytes), s);
+  Kernel<sorted_scatter_rows, gpu>::Launch(
+      s, num_items, sorted_rows.dptr_, positions.dptr_, row_of);
+  // only the bits of the largest destination row take part in the (stable) radix sort
+  const int num_bits = common::ilog2ui(static_cast<unsigned int>(num_rows) - 1);
+  SortByKey(sorted_rows, positions, true, &sort_space, 0, num_bits);
+  Kernel<sorted_scatter<AType, accumulate>, gpu>::Launch(s,
+                                                         num_items * row_length,
+                                                         dst,
+                                                         sorted_rows.dptr_,
+                                                         positions.dptr_,
+                                                         num_items,
+                                                         row_length,
+                                                         src);
+}
+
 }  // namespace op
 }  // namespace mxnet
 #endif  // MXNET_OPERATOR_TENSOR_INDEXING_OP_CUH_
@@ -586,6 +586,65 @@ inline void GatherNDBackwardImpl(index_t N,
   mxnet_op::Kernel<backward_gather_nd_gpu, gpu>::Launch(s, N, N, M, K, strides, out, data, indices);
 }
 
+/*!
+ * \brief row_of functor of SortedScatter for scatter_nd: the row of out picked by the first M
+ * axes of the i-th index tuple, negative indices counting from the end
+ */
+template <typename IType>
+struct ScatterNDRow {
+  const IType* indices;
+  index_t N;
+  index_t M;
+  mshadow::Shape<10> row_strides;
+  mshadow::Shape<10> mshape;
+  MSHADOW_XINLINE int operator()(const index_t i) const {
+    index_t row = 0;
+    for (index_t j = 0; j < M; ++j) {
+      index_t idx = static_cast<index_t>(indices[j * N + i]);
+      row += row_strides[j] * ((idx < 0) ? idx + mshape[j] : idx);
+    }
+    return static_cast<int>(row);
+  }
+};
+
+bool ScatterNDSortedGPU(const OpContext& ctx,
+                        const bool accumulate,
+                        const TBlob& data,
+                        const TBlob& indices,
+                        const TBlob& out) {
+  using namespace mshadow;
+  Stream<gpu>* s              = ctx.get_stream<gpu>();
+  const mxnet::TShape& oshape = out.shape_;
+  const index_t M             = indices.shape_[0];
+  const index_t N             = indices.shape_.Size() / M;
+  const index_t K             = oshape.ProdShape(M, oshape.ndim());
+  const index_t num_rows      = oshape.ProdShape(0, M);
+  if (!UseSortedScatter(N, num_rows)) {
+    return false;
+  }
+  Shape<10> row_strides;
+  Shape<10> mshape;
+  for (index_t i = M - 1, stride = 1; i >= 0; stride *= oshape[i], --i) {
+    row_strides[i] = stride;
+    mshape[i]      = oshape[i];
+  }
+  Tensor<gpu, 1, char> workspace =
+      ctx.requested[0].get_space_typed<gpu, 1, char>(Shape1(SortedScatterWorkspaceSize(N)), s);
+  MSHADOW_TYPE_SWITCH_WITH_BOOL(out.type_flag_, DType, {
+    MSHADOW_TYPE_SWITCH_WITH_BOOL(indices.type_flag_, IType, {
+      using AType = typename mxnet_op::AccType<DType>::type;
+      ScatterNDRow<IType> row_of{indices.dptr<IType>(), N, M, row_strides, mshape};
+      SortedScatterDenseSrc<DType> src{data.dptr<DType>(), K};
+      if (accumulate) {
+        SortedScatter<AType, true>(s, workspace, out.dptr<DType>(), N, num_rows, K, row_of, src);
+      } else {
+        SortedScatter<AType, false>(s, workspace, out.dptr<DType>(), N, num_rows, K, row_of, src);
+      }
+    });
+  });
+  return true;
+}
+
 template <>
 void TakeOpForward<gpu>(const nnvm::NodeAttrs& attrs,
                         const OpContext& ctx,
@@ -891,6 +950,54 @@ void EmbeddingGradKernelCaller(const OpContext& ctx,
   });
 }
 
+/*!
+ * \brief row_of functor of SortedScatter for take along axis 0, clipping or wrapping the
+ * indices like AddTakeGrad
+ */
+template <typename IType>
+struct TakeZeroAxisRow {
+  const IType* idx;
+  index_t K;
+  bool clip;
+  MSHADOW_XINLINE int operator()(const index_t i) const {
+    index_t j = static_cast<index_t>(idx[i]);
+    if (clip) {
+      j = (j <= 0) ? 0 : ((j >= K) ? K - 1 : j);
+    } else {
+      j %= K;
+      j = (j < 0) ? j + K : j;
+    }
+    return static_cast<int>(j);
+  }
+};
+
+template <typename AType, typename DType, typename IType>
+void AddTakeGradSorted(const OpContext& ctx,
+                       mshadow::Tensor<gpu, 2, DType> dst,
+                       const mshadow::Tensor<gpu, 1, IType>& index,
+                       const mshadow::Tensor<gpu, 2, DType>& src,
+                       const bool clip) {
+  using namespace mshadow;
+  Stream<gpu>* s           = ctx.get_stream<gpu>();
+  const index_t num_items  = index.size(0);
+  const index_t num_rows   = dst.size(0);
+  const index_t row_length = dst.size(1);
+  CHECK_EQ(src.size(1), row_length) << "AddTakeGradSorted: shape mismatch";
+  CHECK_EQ(src.size(0), num_items) << "AddTakeGradSorted: shape mismatch";
+  CHECK_LE(num_items, std::numeric_limits<int>::max());
+  CHECK_LE(num_rows, std::numeric_limits<int>::max());
+  Tensor<gpu, 1, char> workspace = ctx.requested[take_::kTempSpace].get_space_typed<gpu, 1, char>(
+      Shape1(SortedScatterWorkspaceSize(num_items)), s);
+  SortedScatter<AType, true>(s,
+                             workspace,
+                             dst.dptr_,
+                             num_items,
+                             num_rows,
+                             row_length,
+                             TakeZeroAxisRow<IType>{index.dptr_, num_rows, clip},
+                             SortedScatterDenseSrc<DType>{src.dptr_, row_length});
+}
+
 template <>
 void EmbeddingOpBackward<gpu>(const nnvm::NodeAttrs& attrs,
                               const OpContext& ctx,
@@ -464,48 +464,200 @@ void EmbeddingOpBackward(const nnvm::NodeAttrs& attrs,
   });
 }
 
-struct AddTakeGradRspKernel {
-  /*!
-   * \brief Each thread i is responsible for row slices in [segment_start, segment_end)
-            of the result gradient
-   * \param tid             global thread id
-   * \param grad            the gradient to calculate
-   * \param prefix_sum      the inclusive prefix sum of row ids of the gradient
-   * \param ograd           output gradient
-   * \param row_length      the length of the row slices of the gradient
-   * \param data_val        the values of input data
-   * \param data_size       number of values of input data
-   * \param segment_length  the length of row segment to process for each thread
-   * \param nnr             total number of non-zero rows of result gradient
-   */
-  template <typename DType, typename IType>
-  MSHADOW_CINLINE static void Map(int tid,
-                                  DType* grad,
-                                  const nnvm::dim_t* prefix_sum,
-                                  const DType* ograd,
-                                  const nnvm::dim_t row_length,
-                                  const IType* data_val,
+/*! \brief the hash of a row of the weight, which partitions the indices of an embedding */
+MSHADOW_XINLINE uint64_t EmbeddingRowHash(const nnvm::dim_t row) {
+  return static_cast<uint64_t>(row) * static_cast<uint64_t>(0x9E3779B97F4A7C15ULL);
+}
+
+/*!
+ * \brief CPU: group the positions of the indices of an embedding by a hash of their row
+ * \param data the indices
+ * \param data_size the number of indices
+ * \param num_threads the number of threads
+ * \param num_parts the number of partitions
+ * \param offsets workspace of num_threads * num_parts offsets
+ * \param part_begin the begin of each partition in order, and the end of the last one
+ * \param order the positions of the indices, increasing within a partition
+ */
+template <typename IType>
+void PartitionEmbeddingIndicesCPU(const IType* data,
                                   const nnvm::dim_t data_size,
-                                  const nnvm::dim_t segment_length,
-                                  const nnvm::dim_t nnr) {
-    using nnvm::dim_t;
-    dim_t segment_start = tid * segment_length;
-    dim_t segment_end   = std::min(nnr, segment_start + segment_length);
-    // scan all data
-    for (dim_t data_i = 0; data_i < data_size; data_i++) {
-      dim_t data        = static_cast<dim_t>(data_val[data_i]);
-      dim_t grad_row_id = prefix_sum[data] - 1;
-      if (grad_row_id < segment_start || grad_row_id >= segment_end)
-        continue;
-      // no projection is performed
-      dim_t ograd_i = data_i * row_length;
-      dim_t grad_i  = grad_row_id * row_length;
-      for (dim_t offset = 0; offset < row_length; offset++) {
-        grad[grad_i + offset] += ograd[ograd_i + offset];
+                                  const int num_threads,
+                                  const nnvm::dim_t num_parts,
+                                  nnvm::dim_t* offsets,
+                                  nnvm::dim_t* part_begin,
+                                  nnvm::dim_t* order) {
+  using nnvm::dim_t;
+  auto part_of = [num_parts](dim_t row) {
+    return static_cast<dim_t>((EmbeddingRowHash(row) >> 32) % num_parts);
+  };
+  const dim_t chunk = (data_size + num_threads - 1) / num_threads;
+#pragma omp parallel for num_threads(num_threads)
+  for (int t = 0; t < num_threads; ++t) {
+    dim_t* count = offsets + t * num_parts;
+    std::fill(count, count + num_parts, 0);
+    const dim_t end = std::min(data_size, (t + 1) * chunk);
+    for (dim_t i = t * chunk; i < end; ++i) {
+      ++count[part_of(static_cast<dim_t>(data[i]))];
+    }
+  }
+  dim_t offset = 0;
+  for (dim_t p = 0; p < num_parts; ++p) {
+    part_begin[p] = offset;
+    for (int t = 0; t < num_threads; ++t) {
+      const dim_t count          = offsets[t * num_parts + p];
+      offsets[t * num_parts + p] = offset;
+      offset += count;
+    }
+  }
+  part_begin[num_parts] = offset;
+#pragma omp parallel for num_threads(num_threads)
+  for (int t = 0; t < num_threads; ++t) {
+    dim_t* next     = offsets + t * num_parts;
+    const dim_t end = std::min(data_size, (t + 1) * chunk);
+    for (dim_t i = t * chunk; i < end; ++i) {
+      order[next[part_of(static_cast<dim_t>(data[i]))]++] = i;
+    }
+  }
+}
+
+/*!
+ * \brief CPU: add the gradients of the indices of an embedding into a dense gradient
+ * \param add_row add_row(grad_row, i) adds the gradient of the i-th index into grad_row
+ *
+ * The indices are partitioned by a hash of their row, each partition adds its rows on a single
+ * thread in the order of the indices, which is free of conflicts and deterministic.
+ */
+template <typename IType, typename DType, typename AddRow>
+void AddTakeGradDnsCPU(const OpContext& ctx,
+                       const IType* data,
+                       const nnvm::dim_t data_size,
+                       DType* grad,
+                       const nnvm::dim_t row_length,
+                       const AddRow& add_row) {
+  using namespace mshadow;
+  using nnvm::dim_t;
+  Stream<cpu>* s        = ctx.get_stream<cpu>();
+  const int num_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  // more partitions than threads balance the partitions of frequent rows
+  const dim_t num_parts = 4 * num_threads;
+  const size_t workspace_size =
+      (num_threads * num_parts + num_parts + 1 + data_size) * sizeof(dim_t);
+  Tensor<cpu, 1, char> workspace =
+      ctx.requested[embedding::kTempSpace].get_space_typed<cpu, 1, char>(Shape1(workspace_size), s);
+  dim_t* offsets    = reinterpret_cast<dim_t*>(workspace.dptr_);
+  dim_t* part_begin = offsets + num_threads * num_parts;
+  dim_t* order      = part_begin + num_parts + 1;
+  PartitionEmbeddingIndicesCPU(data, data_size, num_threads, num_parts, offsets, part_begin, order);
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+  for (dim_t p = 0; p < num_parts; ++p) {
+    for (dim_t k = part_begin[p]; k < part_begin[p + 1]; ++k) {
+      add_row(grad + static_cast<dim_t>(data[order[k]]) * row_length, order[k]);
+    }
+  }
+}
+
+/*!
+ * \brief CPU: the row sparse gradient of the weight of an embedding
+ * \param add_row add_row(grad_row, i) adds the gradient of the i-th index into grad_row
+ *
+ * The indices are partitioned by a hash of their row and each partition finds its unique rows
+ * in a hash table, so that no pass runs over all rows of the weight and only the unique rows
+ * are sorted. Each partition then adds its rows on a single thread in the order of the indices,
+ * which is free of conflicts and deterministic.
+ */
+template <typename IType, typename DType, typename RType, typename AddRow>
+void AddTakeGradRspCPU(const OpContext& ctx,
+                       const IType* data,
+                       const nnvm::dim_t data_size,
+                       const nnvm::dim_t row_length,
+                       const NDArray& output,
+                       const AddRow& add_row) {
+  using namespace mshadow;
+  using nnvm::dim_t;
+  Stream<cpu>* s        = ctx.get_stream<cpu>();
+  const int num_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  // more partitions than threads balance the partitions of frequent rows
+  const dim_t num_parts = 4 * num_threads;
+  // per thread offsets into the partitions, offsets of the partitions and of their unique rows,
+  // then per index its position grouped by partition and its unique slot, and per unique slot
+  // its row, its rank and the slots in the order of their rows
+  const size_t workspace_size =
+      (num_threads * num_parts + 2 * (num_parts + 1) + 5 * data_size) * sizeof(dim_t);
+  Tensor<cpu, 1, char> workspace =
+      ctx.requested[embedding::kTempSpace].get_space_typed<cpu, 1, char>(Shape1(workspace_size), s);
+  dim_t* offsets    = reinterpret_cast<dim_t*>(workspace.dptr_);
+  dim_t* part_begin = offsets + num_threads * num_parts;
+  dim_t* uniq_begin = part_begin + num_parts + 1;
+  dim_t* order      = uniq_begin + num_parts + 1;
+  dim_t* slot       = order + data_size;
+  dim_t* rows       = slot + data_size;
+  dim_t* rank       = rows + data_size;
+  dim_t* sorted     = rank + data_size;
+  PartitionEmbeddingIndicesCPU(data, data_size, num_threads, num_parts, offsets, part_begin, order);
+
+  // the unique rows of each partition, stored from the offset of the partition
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+  for (dim_t p = 0; p < num_parts; ++p) {
+    const dim_t begin = part_begin[p];
+    const dim_t end   = part_begin[p + 1];
+    int log_capacity  = 1;
+    while ((dim_t(1) << log_capacity) < 2 * (end - begin)) {
+      ++log_capacity;
+    }
+    const dim_t mask = (dim_t(1) << log_capacity) - 1;
+    std::vector<dim_t> table(mask + 1, -1);
+    dim_t num_unique = 0;
+    for (dim_t k = begin; k < end; ++k) {
+      const dim_t row = static_cast<dim_t>(data[order[k]]);
+      dim_t h         = static_cast<dim_t>(EmbeddingRowHash(row) >> (64 - log_capacity));
+      while (table[h] >= 0 && rows[begin + table[h]] != row) {
+        h = (h + 1) & mask;
       }
+      if (table[h] < 0) {
+        table[h]                   = num_unique;
+        rows[begin + num_unique++] = row;
+      }
+      slot[k] = begin + table[h];
     }
+    uniq_begin[p + 1] = num_unique;
   }
-};
+  uniq_begin[0] = 0;
+  for (dim_t p = 0; p < num_parts; ++p) {
+    uniq_begin[p + 1] += uniq_begin[p];
+  }
+  // total number of non-zero rows
+  const dim_t nnr = uniq_begin[num_parts];
+  if (nnr == 0) {
+    FillZerosRspImpl(s, output);
+    return;
+  }
+#pragma omp parallel for num_threads(num_threads)
+  for (dim_t p = 0; p < num_parts; ++p) {
+    for (dim_t u = 0; u < uniq_begin[p + 1] - uniq_begin[p]; ++u) {
+      sorted[uniq_begin[p] + u] = part_begin[p] + u;
+    }
+  }
+  common::ParallelSort(
+      sorted, sorted + nnr, num_threads, [rows](dim_t a, dim_t b) { return rows[a] < rows[b]; });
+  output.CheckAndAlloc({Shape1(nnr)});
+  RType* grad_row_idx = output.aux_data(rowsparse::kIdx).dptr<RType>();
+#pragma omp parallel for num_threads(num_threads)
+  for (dim_t r = 0; r < nnr; ++r) {
+    rank[sorted[r]] = r;
+    grad_row_idx[r] = static_cast<RType>(rows[sorted[r]]);
+  }
+  // prefill with zeros
+  DType* grad_data = output.data().dptr<DType>();
+  Fill<false>(s, TBlob(grad_data, Shape1(nnr * row_length), cpu::kDevMask), kWriteTo, 0);
+  // add the final gradients, the rows of a partition are only written by its thread
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+  for (dim_t p = 0; p < num_parts; ++p) {
+    for (dim_t k = part_begin[p]; k < part_begin[p + 1]; ++k) {
+      add_row(grad_data + rank[slot[k]] * row_length, order[k]);
+    }
+  }
+}
 
 template <typename xpu>
 inline void SparseEmbeddingOpBackwardRspImpl(const bool deterministic,
@@ -1049,6 +1201,18 @@ void TakeOpBackwardImpl(mshadow::Stream<gpu>* s,
 }
 #endif
 
+/*!
+ * \brief GPU: dst[index[i], :] += src[i, :] through SortedScatter, accumulating in AType.
+ * Unlike AddTakeGrad, which walks all of the indices in every thread, each destination row
+ * only adds up the source rows that go to it.
+ */
+template <typename AType, typename DType, typename IType>
+void AddTakeGradSorted(const OpContext& ctx,
+                       mshadow::Tensor<gpu, 2, DType> dst,
+                       const mshadow::Tensor<gpu, 1, IType>& index,
+                       const mshadow::Tensor<gpu, 2, DType>& src,
+                       const bool clip);
+
 template <typename xpu>
 void TakeOpBackward(const nnvm::NodeAttrs& attrs,
                     const OpContext& ctx,
@@ -1112,7 +1276,13 @@ void TakeOpBackward(const nnvm::NodeAttrs& attrs,
       // re-using the previous code for axis = 0 case
       if (actual_axis == 0) {
         if (req[take_::kArr] == kWriteTo || req[take_::kArr] == kAddTo) {
-          if (safe_acc) {
+          if constexpr (std::is_same<xpu, gpu>::value) {
+            if (safe_acc) {
+              AddTakeGradSorted<AType>(ctx, grad_in, idx, grad_out, param.mode == take_::kClip);
+            } else {
+              AddTakeGradSorted<DType>(ctx, grad_in, idx, grad_out, param.mode == take_::kClip);
+            }
+          } else if (safe_acc) {
             // Temporary storage for safe accumulation
             size_t temp_space_size = grad_in.size(0) * grad_in.size(1) * sizeof(AType);
             Tensor<xpu, 1, char> temp_space =
@@ -1531,6 +1701,17 @@ struct scatter_nd {
   }
 };
 
+/*!
+ * \brief GPU: scatter the rows of data into out at indices through SortedScatter, adding them
+ * to out with accumulate and otherwise keeping the last of the duplicates. Returns false,
+ * leaving out untouched, when UseSortedScatter prefers the atomic kernels.
+ */
+bool ScatterNDSortedGPU(const OpContext& ctx,
+                        const bool accumulate,
+                        const TBlob& data,
+                        const TBlob& indices,
+                        const TBlob& out);
+
 template <typename xpu>
 void ScatterNDForward(const nnvm::NodeAttrs& attrs,
                       const OpContext& ctx,
@@ -1555,6 +1736,11 @@ void ScatterNDForward(const nnvm::NodeAttrs& attrs,
   if (kWriteTo == req[0]) {
     Fill<true>(s, outputs[0], req[0], 0);
   }
+  if constexpr (std::is_same<xpu, gpu>::value) {
+    if (ScatterNDSortedGPU(ctx, req[0] == kAddTo, inputs[0], inputs[1], outputs[0])) {
+      return;
+    }
+  }
   MSHADOW_TYPE_SWITCH_WITH_BOOL(inputs[0].type_flag_, DType, {    // output data type switch
     MSHADOW_TYPE_SWITCH_WITH_BOOL(inputs[1].type_flag_, IType, {  // indices data type switch
       mxnet_op::Kernel<scatter_nd, xpu>::Launch(s,
@@ -1627,6 +1813,11 @@ void GatherNDBackward(const nnvm::NodeAttrs& attrs,
   if (kWriteTo == req[0]) {
     Fill<true>(s, outputs[0], req[0], 0);
   }
+  if constexpr (std::is_same<xpu, gpu>::value) {
+    if (ScatterNDSortedGPU(ctx, true, inputs[0], inputs[1], outputs[0])) {
+      return;
+    }
+  }
   MXNET_NO_INT8_TYPE_SWITCH(inputs[0].type_flag_, DType, {  // output data type switch
     MSHADOW_TYPE_SWITCH(inputs[1].type_flag_, IType, {      // indices data type switch
       GatherNDBackwardImpl(N,
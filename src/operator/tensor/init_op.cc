@@ -43,7 +43,7 @@ NNVM_REGISTER_OP(_zeros_without_dtype)
     .set_attr<mxnet::FInferShape>("FInferShape", InitShape<InitOpWithoutDTypeParam>)
     .set_attr<nnvm::FInferType>("FInferType", InitType<InitOpWithoutDTypeParam>)
     .set_attr<FInferStorageType>("FInferStorageType",
-                                 InitStorageType<InitOpWithoutDTypeParam, true, true>)
+                                 InitStorageType<InitOpWithoutDTypeParam, true, true, true>)
     .set_attr<FCompute>("FCompute<cpu>", FillCompute<cpu, 0>)
     .set_attr<FComputeEx>("FComputeEx<cpu>", FillComputeZerosEx<cpu>)
     .add_arguments(InitOpWithoutDTypeParam::__FIELDS__());
@@ -55,7 +55,8 @@ NNVM_REGISTER_OP(_zeros)
     .set_attr_parser(ParamParser<InitOpParam>)
     .set_attr<mxnet::FInferShape>("FInferShape", InitShape<InitOpParam>)
     .set_attr<nnvm::FInferType>("FInferType", InitType<InitOpParam>)
-    .set_attr<FInferStorageType>("FInferStorageType", InitStorageType<InitOpParam, true, true>)
+    .set_attr<FInferStorageType>("FInferStorageType",
+                                 InitStorageType<InitOpParam, true, true, true>)
     .set_attr<FCompute>("FCompute<cpu>", FillCompute<cpu, 0>)
     .set_attr<FComputeEx>("FComputeEx<cpu>", FillComputeZerosEx<cpu>)
     .add_arguments(InitOpParam::__FIELDS__());
@@ -378,7 +378,7 @@ inline bool InitNumpyType(const nnvm::NodeAttrs& attrs,
   return true;
 }
 
-template <typename ParamType, bool rsp, bool csr>
+template <typename ParamType, bool rsp, bool csr, bool bsr = false>
 inline bool InitStorageType(const nnvm::NodeAttrs& attrs,
                             const int dev_mask,
                             DispatchMode* dispatch_mode,
@@ -404,6 +404,11 @@ inline bool InitStorageType(const nnvm::NodeAttrs& attrs,
     dispatched =
         storage_type_assign(out_attrs, kCSRStorage, dispatch_mode, DispatchMode::kFComputeEx);
   }
+  if (!dispatched && bsr && out_stype == kBSRStorage) {
+    // bsr
+    dispatched =
+        storage_type_assign(out_attrs, kBSRStorage, dispatch_mode, DispatchMode::kFComputeEx);
+  }
   if (!dispatched) {
     dispatched = dispatch_fallback(out_attrs, dispatch_mode);
   }
@@ -557,6 +562,24 @@ inline void FillZerosCsrImpl(mshadow::Stream<mshadow::cpu>* s, const NDArray& ds
 }
 void FillZerosCsrImpl(mshadow::Stream<mshadow::gpu>* s, const NDArray& dst);
 
+/*!
+ * \brief Fill a BSR NDArray with zeros by updating the aux shape, keeping its block shape.
+ * \param s - The device stream
+ * \param dst - NDArray which is to be set to "all zeroes"
+ */
+template <typename xpu>
+inline void FillZerosBsrImpl(mshadow::Stream<xpu>* s, const NDArray& dst) {
+  CHECK_EQ(dst.storage_type(), kBSRStorage) << "dst is not a BSR NDArray";
+  const nnvm::dim_t block_rows = dst.storage_shape()[1];
+  dst.set_aux_shape(bsr::kIdx, mshadow::Shape1(0));
+  dst.CheckAndAllocAuxData(bsr::kIndPtr, mshadow::Shape1(dst.shape()[0] / block_rows + 1));
+  TBlob indptr_data = dst.aux_data(bsr::kIndPtr);
+  MSHADOW_IDX_TYPE_SWITCH(dst.aux_type(bsr::kIndPtr), IType, {
+    mxnet_op::Kernel<mxnet_op::set_zero, xpu>::Launch(
+        s, indptr_data.Size(), indptr_data.dptr<IType>());
+  });
+}
+
 /*!
  * \brief Fill an NDArray with zeros
  * \tparam xpu - cpu or gpu
@@ -584,6 +607,8 @@ void FillComputeZerosEx(const nnvm::NodeAttrs& attrs,
     FillZerosRspImpl(s, outputs[0]);
   } else if (stype == kCSRStorage) {
     FillZerosCsrImpl(s, outputs[0]);
+  } else if (stype == kBSRStorage) {
+    FillZerosBsrImpl(s, outputs[0]);
   } else {
     LogUnimplementedOp(attrs, ctx, inputs, req, outputs);
   }
@@ -38,6 +38,7 @@
 #include "./init_op.h"
 #include "../../common/static_array.h"
 #include "./slice-inl.h"
+#include "./permute_op-inl.h"
 
 #if MXNET_USE_CUDA
 #include <thrust/device_vector.h>
@@ -45,6 +46,7 @@
 
 #ifdef __CUDACC__
 #include "./pseudo2DTranspose_op-inl.cuh"
+#include "./permute_op-inl.cuh"
 #endif
 
 namespace mxnet {
@@ -279,55 +281,6 @@ struct TransposeParam : public dmlc::Parameter<TransposeParam> {
   }
 };
 
-/*!
- * \brief This function performs transpose operation on a 2D matrix by utilizing the L1 cache
- * \param in  input tensor
- * \param out output tensor
- * \param row shape of dim 0 of input
- * \param col shape of dim 1 of input
- * \tparam DType Data type
- * \tparam is_addto
- */
-template <typename DType, bool is_addto>
-MSHADOW_XINLINE void Transpose2D(const DType* in, DType* out, index_t row, index_t col) {
-  // ensure cache line hits and prevent cache miss for any configuration
-  // L1 cache size to be utilized = 32kb = 2^15
-  // Largest size of a single unit of any dtype <= 8 byte = 2^3
-  // Number of elements - (2^15/2^3) = 2^12
-  // Block-size - 2^6 v 2^6 (64 v 64)
-
-  // But we could leverage unrolling of for loops (for parallelization)
-  // Block-size - 2^5 v 2^5 (32 v 32) with potential 4 pragma for loop unrolled
-  // blocksize * blocksize * num_threads = cache_size / dtype_size
-  // Instead of explicit unroll, let compiler figure out optimal unroll factor
-  const index_t blocksize = 32;
-
-// collapse 2 parallelizes 2 for loops
-// inner 2 for loops aren't parallelized to prevent cache miss
-
-// Microsoft Visual C++ compiler does not support omp collapse
-#ifdef _MSC_VER
-#pragma omp parallel for
-#else
-#pragma omp parallel for collapse(2)
-#endif  // _MSC_VER
-
-  for (index_t i = 0; i < row; i += blocksize) {
-    for (index_t j = 0; j < col; j += blocksize) {
-      // transpose the block
-      for (index_t a = j; (a < blocksize + j) && (a < col); ++a) {
-        for (index_t b = i; (b < blocksize + i) && (b < row); ++b) {
-          if (!is_addto) {
-            out[a * row + b] = in[b * col + a];
-          } else {
-            out[a * row + b] += in[b * col + a];
-          }
-        }
-      }
-    }
-  }
-}
-
 inline bool IsIdentityTranspose(const TShape& axes) {
   for (dim_t i = 0; i < axes.ndim(); i++) {
     if (axes[i] != i)
@@ -374,66 +327,12 @@ bool TransposeCommonImpl(RunContext ctx,
     });
     return true;
   }
-  // Handle the general transpose case
+  // Handle the general transpose case, with the axes which stay adjacent merged
+  PermuteParams p;
+  if (!CollapsePermutation(src.shape_, axes, &p))
+    return false;
   MSHADOW_TYPE_SWITCH(ret.type_flag_, DType, {
-    switch (axes.ndim()) {
-      case 2: {
-        Tensor<xpu, 2, DType> in  = src.get<xpu, 2, DType>(s);
-        Tensor<xpu, 2, DType> out = ret.get<xpu, 2, DType>(s);
-        if (ctx.get_ctx().dev_mask() == cpu::kDevMask) {
-          Transpose2D<DType, is_addto>(in.dptr_, out.dptr_, in.shape_[0], in.shape_[1]);
-        } else {
-          LOG(FATAL) << "Not Implemented. We should never reach here because the 2D case "
-                        "in GPU has been covered by transpose_pseudo2D."
-                        " Report an issue in Github.";
-        }
-        break;
-      }
-      case 3: {
-        Tensor<xpu, 3, DType> in  = src.get<xpu, 3, DType>(s);
-        Tensor<xpu, 3, DType> out = ret.get<xpu, 3, DType>(s);
-        if (!is_addto) {
-          out = transpose(in, axes.get<3>());
-        } else {
-          out += transpose(in, axes.get<3>());
-        }
-        break;
-      }
-      case 4: {
-        Tensor<xpu, 4, DType> in  = src.get<xpu, 4, DType>(s);
-        Tensor<xpu, 4, DType> out = ret.get<xpu, 4, DType>(s);
-        if (!is_addto) {
-          out = transpose(in, axes.get<4>());
-        } else {
-          out += transpose(in, axes.get<4>());
-        }
-        break;
-      }
-      case 5: {
-        Tensor<xpu, 5, DType> in  = src.get<xpu, 5, DType>(s);
-        Tensor<xpu, 5, DType> out = ret.get<xpu, 5, DType>(s);
-        if (!is_addto) {
-          out = transpose(in, axes.get<5>());
-        } else {
-          out += transpose(in, axes.get<5>());
-        }
-        break;
-      }
-      case 6: {
-        Tensor<xpu, 6, DType> in  = src.get<xpu, 6, DType>(s);
-        Tensor<xpu, 6, DType> out = ret.get<xpu, 6, DType>(s);
-        if (!is_addto) {
-          out = transpose(in, axes.get<6>());
-        } else {
-          out += transpose(in, axes.get<6>());
-        }
-        break;
-      }
-      default:
-        // return false when dimensions > 6
-        return false;
-        break;
-    }
+    PermuteImpl<is_addto>(s, p, src.dptr<DType>(), ret.dptr<DType>());
   });
   return true;
 }
@@ -1792,6 +1691,45 @@ struct clip {
   }
 };
 
+/*! \brief clip the stored rows of a row_sparse array into a dense output */
+struct clip_rsp_dns {
+  // i is for i-th element in the stored rows of the input
+  template <typename DType, typename IType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const DType* data,
+                                  const IType* row_idx,
+                                  const nnvm::dim_t row_size,
+                                  const float a_min,
+                                  const float a_max) {
+    using nnvm::dim_t;
+    const dim_t out_idx = static_cast<dim_t>(row_idx[i / row_size]) * row_size + i % row_size;
+    const DType value   = data[i];
+    out[out_idx]        = value > a_max ? DType(a_max) : (value < a_min ? DType(a_min) : value);
+  }
+};
+
+/*! \brief clip the non-zero elements of a csr matrix into a dense output */
+struct clip_csr_dns {
+  // i is for i-th row of the input
+  template <typename DType, typename IType, typename RType>
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  DType* out,
+                                  const DType* data,
+                                  const IType* col_idx,
+                                  const RType* indptr,
+                                  const nnvm::dim_t num_cols,
+                                  const float a_min,
+                                  const float a_max) {
+    using nnvm::dim_t;
+    for (dim_t j = indptr[i]; j < indptr[i + 1]; ++j) {
+      const DType value   = data[j];
+      const dim_t out_idx = i * num_cols + col_idx[j];
+      out[out_idx]        = value > a_max ? DType(a_max) : (value < a_min ? DType(a_min) : value);
+    }
+  }
+};
+
 struct clip_grad {
   template <typename DType>
   MSHADOW_XINLINE static void Map(index_t i,
@@ -1832,6 +1770,55 @@ void Clip(const nnvm::NodeAttrs& attrs,
   });
 }
 
+/*!
+ * \brief clip of a row_sparse or csr input whose zeros are clipped to a non-zero value.
+ *        The output is filled with the clipped zero, then the stored elements are clipped into it.
+ */
+template <typename xpu>
+void ClipSparseDnsImpl(const ClipParam& param,
+                       mshadow::Stream<xpu>* s,
+                       const NDArray& input,
+                       const OpReqType req,
+                       const TBlob& output) {
+  using namespace mxnet_op;
+  if (req == kNullOp || output.Size() == 0)
+    return;
+  CHECK_EQ(req, kWriteTo) << "clip from a sparse input to a dense output only supports kWriteTo";
+  Fill<false>(s, output, req, std::min(std::max(0.0f, param.a_min), param.a_max));
+  if (!input.storage_initialized())
+    return;
+  MSHADOW_TYPE_SWITCH(output.type_flag_, DType, {
+    if (input.storage_type() == kRowSparseStorage) {
+      MSHADOW_IDX_TYPE_SWITCH(input.aux_type(rowsparse::kIdx), IType, {
+        const nnvm::dim_t row_size = output.shape_.ProdShape(1, output.shape_.ndim());
+        Kernel<clip_rsp_dns, xpu>::Launch(s,
+                                          input.storage_shape()[0] * row_size,
+                                          output.dptr<DType>(),
+                                          input.data().dptr<DType>(),
+                                          input.aux_data(rowsparse::kIdx).dptr<IType>(),
+                                          row_size,
+                                          param.a_min,
+                                          param.a_max);
+      });
+    } else {
+      CHECK_EQ(input.storage_type(), kCSRStorage);
+      MSHADOW_IDX_TYPE_SWITCH(input.aux_type(csr::kIdx), IType, {
+        MSHADOW_IDX_TYPE_SWITCH(input.aux_type(csr::kIndPtr), RType, {
+          Kernel<clip_csr_dns, xpu>::Launch(s,
+                                            input.shape()[0],
+                                            output.dptr<DType>(),
+                                            input.data().dptr<DType>(),
+                                            input.aux_data(csr::kIdx).dptr<IType>(),
+                                            input.aux_data(csr::kIndPtr).dptr<RType>(),
+                                            input.shape()[1],
+                                            param.a_min,
+                                            param.a_max);
+        });
+      });
+    }
+  });
+}
+
 template <typename xpu>
 void ClipEx(const nnvm::NodeAttrs& attrs,
             const OpContext& ctx,
@@ -1839,8 +1826,16 @@ void ClipEx(const nnvm::NodeAttrs& attrs,
             const std::vector<OpReqType>& req,
             const std::vector<NDArray>& outputs) {
   CHECK_EQ(inputs[0].dtype(), outputs[0].dtype());
-  CHECK_EQ(inputs[0].storage_type(), outputs[0].storage_type());
   CHECK_NE(inputs[0].storage_type(), kDefaultStorage);
+  if (outputs[0].storage_type() == kDefaultStorage) {
+    ClipSparseDnsImpl<xpu>(nnvm::get<ClipParam>(attrs.parsed),
+                           ctx.get_stream<xpu>(),
+                           inputs[0],
+                           req[0],
+                           outputs[0].data());
+    return;
+  }
+  CHECK_EQ(inputs[0].storage_type(), outputs[0].storage_type());
   UnaryOp::MapToFCompute<xpu>(attrs, ctx, inputs, req, outputs, Clip<xpu>);
 }
 
@@ -3270,9 +3265,14 @@ inline void SplitOpForwardImpl(const nnvm::NodeAttrs& attrs,
   workspace_size += indices.size() * sizeof(size_t);
   MSHADOW_TYPE_SWITCH(input_data.type_flag_, DType, {
     std::vector<DType*> output_data;
-    for (const TBlob& data : outputs) {
-      output_data.push_back(data.dptr<DType>());
+    // the outputs may already be the slices of the input, as the memory planner makes them
+    bool in_place = leading == 1;
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      output_data.push_back(outputs[i].dptr<DType>());
+      in_place = in_place && output_data[i] == input_data.dptr<DType>() + indices[i] * trailing;
     }
+    if (in_place)
+      return;
     workspace_size += output_data.size() * sizeof(DType*);
     Tensor<xpu, 1, char> workspace =
         ctx.requested[0].get_space_typed<xpu, 1, char>(Shape1(workspace_size), s);
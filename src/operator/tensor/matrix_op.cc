@@ -731,8 +731,8 @@ parameter values:
 * clip(csr, a_min <= 0, a_max >= 0) = csr
 * clip(row_sparse, a_min < 0, a_max < 0) = default
 * clip(row_sparse, a_min > 0, a_max > 0) = default
-* clip(csr, a_min < 0, a_max < 0) = csr
-* clip(csr, a_min > 0, a_max > 0) = csr
+* clip(csr, a_min < 0, a_max < 0) = default
+* clip(csr, a_min > 0, a_max > 0) = default
 )code" ADD_FILELINE)
     .set_num_inputs(1)
     .set_num_outputs(1)
@@ -768,6 +768,15 @@ parameter values:
                                            DispatchMode::kFComputeEx);
                                      }
                                    }
+                                   const int in_stype = (*in_attrs)[0];
+                                   if (!dispatched && (in_stype == kRowSparseStorage ||
+                                                       in_stype == kCSRStorage)) {
+                                     // zeros are clipped to a non-zero value, output is dense
+                                     dispatched = storage_type_assign(&(*out_attrs)[0],
+                                                                      kDefaultStorage,
+                                                                      dispatch_mode,
+                                                                      DispatchMode::kFComputeEx);
+                                   }
                                    if (!dispatched) {
                                      // otherwise, output is dense (print warning anyway)
                                      if (!storage_type_assign(&(*out_attrs)[0],
@@ -1174,7 +1183,10 @@ static void SplitForwardEx(const nnvm::NodeAttrs& attrs,
                            const std::vector<OpReqType>& req,
                            const std::vector<NDArray>& outputs) {
   CHECK(!inputs.empty());
-  if (SupportDNNL(inputs[0])) {
+  // the outputs which the memory planner made slices of the input are left to the fallback
+  const bool views =
+      std::any_of(outputs.begin(), outputs.end(), [](const NDArray& a) { return a.IsView(); });
+  if (SupportDNNL(inputs[0]) && !views) {
     DNNL_OPCHECK_INIT(/*is backward*/ false, outputs.size(), inputs, outputs);
     DNNLRun(DNNLSplitForward, attrs, op_ctx, inputs, req, outputs);
     DNNL_OPCHECK_RUN(SplitOpForward<cpu>, attrs, op_ctx, inputs, req, outputs);
@@ -1257,6 +1269,11 @@ Example::
                                      })
     .set_attr<mxnet::FInferShape>("FInferShape", SplitOpShape)
     .set_attr<nnvm::FInferType>("FInferType", SplitOpType)
+    .set_attr<FSplitAxis>("FSplitAxis",
+                          [](const NodeAttrs& attrs, int ndim) {
+                            const int axis = nnvm::get<SplitParam>(attrs.parsed).axis;
+                            return axis < 0 ? axis + ndim : axis;
+                          })
     .set_attr<FCompute>("FCompute<cpu>", SplitOpForward<cpu>)
     .set_attr<FResourceRequest>("FResourceRequest",
                                 [](const NodeAttrs& n) {
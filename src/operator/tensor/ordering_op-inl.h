@@ -28,14 +28,17 @@
 #include <dmlc/optional.h>
 #include <mshadow/tensor.h>
 #include <algorithm>
+#include <numeric>
 #include <vector>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include "../mshadow_op.h"
 #include "../elemwise_op_common.h"
 #include "./sort_op.h"
 #include "./indexing_op.h"
 #include "../../api/operator/op_utils.h"
+#include "../../common/utils.h"
 
 namespace mshadow {
 template <typename xpu, int src_dim, typename DType, int dst_dim>
@@ -262,6 +265,119 @@ struct fill_ind {
   }
 };
 
+/*! \brief whether (v1, i1) comes before (v2, i2) in the top-K, equal values by lower index */
+template <bool is_ascend, typename DType, typename IDXType>
+MSHADOW_XINLINE bool TopKBefore(DType v1, IDXType i1, DType v2, IDXType i2) {
+  return (is_ascend ? v1 < v2 : v1 > v2) || (v1 == v2 && i1 < i2);
+}
+
+/*!
+ * \brief push the values vals[0, n) with indices index(j) into heap, the top-K of which it keeps
+ *  with the last of them in front. Indices must increase with j among equal values.
+ *
+ * Values have to beat the front of the heap to enter it, so whole blocks are checked against it
+ * with compares the compiler vectorizes, and only blocks which hold a candidate are inserted.
+ */
+template <bool is_ascend, typename DType, typename IDXType, typename IndexFn>
+inline void TopKScan(const DType* vals,
+                     IDXType n,
+                     IndexFn index,
+                     IDXType K,
+                     std::vector<std::pair<DType, IDXType>>* heap) {
+  auto before = [](const std::pair<DType, IDXType>& a, const std::pair<DType, IDXType>& b) {
+    return TopKBefore<is_ascend>(a.first, a.second, b.first, b.second);
+  };
+  IDXType j = 0;
+  for (; j < n && static_cast<IDXType>(heap->size()) < K; ++j) {
+    heap->emplace_back(vals[j], index(j));
+    std::push_heap(heap->begin(), heap->end(), before);
+  }
+  const IDXType kBlock = 32;
+  while (j < n) {
+    const IDXType end = std::min(n, j + kBlock);
+    const DType last  = heap->front().first;
+    bool any          = false;
+    for (IDXType t = j; t < end; ++t) {
+      any |= is_ascend ? vals[t] < last : vals[t] > last;
+    }
+    for (; any && j < end; ++j) {
+      // a later index never wins a tie, so only values strictly before the last one enter
+      if (is_ascend ? vals[j] < heap->front().first : vals[j] > heap->front().first) {
+        std::pop_heap(heap->begin(), heap->end(), before);
+        heap->back() = std::make_pair(vals[j], index(j));
+        std::push_heap(heap->begin(), heap->end(), before);
+      }
+    }
+    j = end;
+  }
+}
+
+/*!
+ * \brief select the top-K of each row of vals instead of sorting the rows. When there are
+ *  fewer rows than threads, the rows are split into segments selected in parallel, whose top-K
+ *  are then merged.
+ */
+template <bool is_ascend, typename DType, typename IDXType>
+inline void TopKSelect(const DType* vals,
+                       DType* sorted_vals,
+                       IDXType* indices,
+                       IDXType K,
+                       IDXType N,
+                       index_t M,
+                       int omp_threads) {
+  auto before = [](const std::pair<DType, IDXType>& a, const std::pair<DType, IDXType>& b) {
+    return TopKBefore<is_ascend>(a.first, a.second, b.first, b.second);
+  };
+  // the top-K of segment s of row i go to [i * N + s * K, i * N + (s + 1) * K)
+  const IDXType kMinSegment = 1 << 14;
+  const IDXType segments    = std::max<IDXType>(
+      1,
+      std::min<IDXType>(static_cast<IDXType>(omp_threads / std::max<index_t>(M, 1)),
+                        N / std::max<IDXType>(K * 8, kMinSegment)));
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t t = 0; t < M * segments; ++t) {
+    const index_t i     = t / segments;
+    const IDXType seg   = t % segments;
+    const IDXType begin = static_cast<IDXType>(static_cast<int64_t>(N) * seg / segments);
+    const IDXType end   = static_cast<IDXType>(static_cast<int64_t>(N) * (seg + 1) / segments);
+    const IDXType first = static_cast<IDXType>(i * N + begin);
+    std::vector<std::pair<DType, IDXType>> heap;
+    heap.reserve(K);
+    TopKScan<is_ascend>(
+        vals + first, end - begin, [first](IDXType j) { return first + j; }, K, &heap);
+    std::sort_heap(heap.begin(), heap.end(), before);
+    for (IDXType j = 0; j < K; ++j) {
+      sorted_vals[i * N + seg * K + j] = heap[j].first;
+      indices[i * N + seg * K + j]     = heap[j].second;
+    }
+  }
+  if (segments == 1) {
+    return;
+  }
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t i = 0; i < M; ++i) {
+    // the candidates of later segments have larger indices
+    const IDXType* candidates = indices + i * N;
+    std::vector<std::pair<DType, IDXType>> heap;
+    heap.reserve(K);
+    TopKScan<is_ascend>(
+        sorted_vals + i * N,
+        segments * K,
+        [candidates](IDXType j) { return candidates[j]; },
+        K,
+        &heap);
+    std::sort_heap(heap.begin(), heap.end(), before);
+    for (IDXType j = 0; j < K; ++j) {
+      sorted_vals[i * N + j] = heap[j].first;
+      indices[i * N + j]     = heap[j].second;
+    }
+  }
+}
+
+/*!
+ * \brief sort the top-K of each row of the flattened source in work into dat, and their
+ *  indices into ind, equal values by lower index as the stable sorts on the GPU
+ */
 template <typename DType, typename IDXType>
 MSHADOW_FORCE_INLINE void TopKSort(const Tensor<cpu, 1, DType>& dat,
                                    const Tensor<cpu, 1, IDXType>& ind,
@@ -273,40 +389,47 @@ MSHADOW_FORCE_INLINE void TopKSort(const Tensor<cpu, 1, DType>& dat,
   // Use full sort when K is relatively large.
   const bool full_sort(K * 8 > N);
   // Batch size.
-  const size_t M(work.size(0) / (sizeof(DType) * N));
+  const index_t M(work.size(0) / (sizeof(DType) * N));
   const int omp_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount());
-#pragma omp parallel for num_threads(omp_threads)
-  for (index_t i = 0; i < static_cast<index_t>(M); ++i) {
-    // Tensor `work` stores the flattened source data, while `dat` stores the sorted result.
-    DType* vals        = reinterpret_cast<DType*>(work.dptr_);
+  // Tensor `work` stores the flattened source data, while `dat` stores the sorted result.
+  const DType* vals = reinterpret_cast<const DType*>(work.dptr_);
+  if (!full_sort) {
+    if (is_ascend) {
+      TopKSelect<true>(vals, dat.dptr_, ind.dptr_, K, N, M, omp_threads);
+    } else {
+      TopKSelect<false>(vals, dat.dptr_, ind.dptr_, K, N, M, omp_threads);
+    }
+    return;
+  }
+  auto sort_row = [&](index_t i, int nthreads) {
     DType* sorted_vals = dat.dptr_ + i * N;
     IDXType* indices   = ind.dptr_ + i * N;
+    std::iota(indices, indices + N, static_cast<IDXType>(i * N));
     if (is_ascend) {
-      if (full_sort) {
-        std::sort(indices, indices + N, [&](const IDXType& i1, const IDXType& i2) {
-          return vals[i1] < vals[i2];
-        });
-      } else {
-        std::partial_sort(
-            indices, indices + K, indices + N, [&](const IDXType& i1, const IDXType& i2) {
-              return vals[i1] < vals[i2];
-            });
-      }
+      common::ParallelSort(
+          indices, indices + N, nthreads, [&](const IDXType& i1, const IDXType& i2) {
+            return TopKBefore<true>(vals[i1], i1, vals[i2], i2);
+          });
     } else {
-      if (full_sort) {
-        std::sort(indices, indices + N, [&](const IDXType& i1, const IDXType& i2) {
-          return vals[i1] > vals[i2];
-        });
-      } else {
-        std::partial_sort(
-            indices, indices + K, indices + N, [&](const IDXType& i1, const IDXType& i2) {
-              return vals[i1] > vals[i2];
-            });
-      }
+      common::ParallelSort(
+          indices, indices + N, nthreads, [&](const IDXType& i1, const IDXType& i2) {
+            return TopKBefore<false>(vals[i1], i1, vals[i2], i2);
+          });
     }
     for (IDXType j = 0; j < K; ++j) {
       sorted_vals[j] = vals[indices[j]];
     }
+  };
+  if (M < omp_threads) {
+    // Too few rows to keep the threads busy, so each row is sorted by all of them.
+    for (index_t i = 0; i < M; ++i) {
+      sort_row(i, omp_threads);
+    }
+    return;
+  }
+#pragma omp parallel for num_threads(omp_threads)
+  for (index_t i = 0; i < M; ++i) {
+    sort_row(i, 1);
   }
 }
 
@@ -558,13 +681,16 @@ void TopKImpl(const RunContext& ctx,
     workspace_curr_ptr += temp_size;
   }
 
-  mxnet_op::Kernel<range_fwd, xpu>::Launch(s,
-                                           batch_size * element_num,
-                                           1,
-                                           IDXType{0},
-                                           IDXType{1},
-                                           kWriteTo,
-                                           reinterpret_cast<IDXType*>(indices.dptr_));
+  // the CPU sorts fill in the indices they need
+  if (!std::is_same<xpu, cpu>::value) {
+    mxnet_op::Kernel<range_fwd, xpu>::Launch(s,
+                                             batch_size * element_num,
+                                             1,
+                                             IDXType{0},
+                                             IDXType{1},
+                                             kWriteTo,
+                                             reinterpret_cast<IDXType*>(indices.dptr_));
+  }
   CHECK_EQ(indices.CheckContiguous(), true);
 
   // 2. Perform inplace batch sort.
@@ -791,8 +917,11 @@ void TopKImplwithWorkspace(const RunContext& ctx,
     workspace_curr_ptr += temp_size;
   }
 
-  mxnet_op::Kernel<range_fwd, xpu>::Launch(
-      s, batch_size * element_num, 1, index_t{0}, index_t{1}, kWriteTo, indices.dptr_);
+  // the CPU sorts fill in the indices they need
+  if (!std::is_same<xpu, cpu>::value) {
+    mxnet_op::Kernel<range_fwd, xpu>::Launch(
+        s, batch_size * element_num, 1, index_t{0}, index_t{1}, kWriteTo, indices.dptr_);
+  }
   CHECK_EQ(indices.CheckContiguous(), true);
 
   // 2. Perform inplace batch sort.
@@ -0,0 +1,192 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file permute_op-inl.cuh
+ * \brief GPU kernels of the N-D permutation of the axes of a tensor
+ */
+#ifndef MXNET_OPERATOR_TENSOR_PERMUTE_OP_INL_CUH_
+#define MXNET_OPERATOR_TENSOR_PERMUTE_OP_INL_CUH_
+
+#include <mxnet/base.h>
+#include <algorithm>
+#include <cstdint>
+#include "../../common/cuda/utils.h"
+#include "./permute_op-inl.h"
+
+namespace mxnet {
+namespace op {
+namespace cuda {
+
+/*! \brief the threads per block of the permutation kernels along the tile rows */
+constexpr int kPermuteTileRows = 8;
+
+/*!
+ * \brief Copies the rows of the innermost axis, which stays innermost, as CType vectors.
+ * \param row Length of the rows, in CType.
+ * \param n Total number of CType vectors.
+ * \tparam is_addto Whether to perform out += permute(in), with CType being DType then.
+ */
+template <typename DType, typename CType, bool is_addto>
+__global__ void permute_rows(DType* out,
+                             const DType* in,
+                             const PermuteBatch batch,
+                             const index_t row,
+                             const index_t n) {
+  constexpr index_t TSR = sizeof(CType) / sizeof(DType);
+  CType* c_out          = reinterpret_cast<CType*>(out);
+  const CType* c_in     = reinterpret_cast<const CType*>(in);
+  for (index_t e = blockIdx.x * blockDim.x + threadIdx.x; e < n; e += blockDim.x * gridDim.x) {
+    index_t in_off, out_off;
+    batch.Offsets(e / row, &in_off, &out_off);
+    const index_t k = e % row;
+    if (!is_addto) {
+      c_out[out_off / TSR + k] = c_in[in_off / TSR + k];
+    } else {
+      out[out_off + k] += in[in_off + k];
+    }
+  }
+}
+
+/*!
+ * \brief Moves the tiles of the rows of input axis axes[last] by the columns of the innermost input
+ *        axis through shared memory, so that both the loads along the innermost input axis and the
+ *        stores along the innermost output axis are coalesced. blockIdx.x is the tile and
+ *        blockIdx.y strides over the batch.
+ */
+template <typename DType, bool is_addto>
+__global__ void permute_tiled(DType* out,
+                              const DType* in,
+                              const PermuteBatch batch,
+                              const index_t rows,
+                              const index_t cols,
+                              const index_t col_tiles,
+                              const index_t in_row_stride,
+                              const index_t out_col_stride) {
+  // the padding column avoids the bank conflicts of the transposed reads
+  extern __shared__ char buf[];
+  DType* tile      = reinterpret_cast<DType*>(buf);
+  const index_t r0 = blockIdx.x / col_tiles * kPermuteTile;
+  const index_t c0 = blockIdx.x % col_tiles * kPermuteTile;
+  for (index_t b = blockIdx.y; b < batch.size; b += gridDim.y) {
+    index_t in_off, out_off;
+    batch.Offsets(b, &in_off, &out_off);
+    const index_t c = c0 + threadIdx.x;
+    for (int j = threadIdx.y; j < kPermuteTile; j += blockDim.y) {
+      const index_t r = r0 + j;
+      if (r < rows && c < cols)
+        tile[j * (kPermuteTile + 1) + threadIdx.x] = in[in_off + r * in_row_stride + c];
+    }
+    __syncthreads();
+    const index_t r = r0 + threadIdx.x;
+    for (int j = threadIdx.y; j < kPermuteTile; j += blockDim.y) {
+      const index_t c = c0 + j;
+      if (r < rows && c < cols) {
+        const DType v = tile[threadIdx.x * (kPermuteTile + 1) + j];
+        if (!is_addto) {
+          out[out_off + c * out_col_stride + r] = v;
+        } else {
+          out[out_off + c * out_col_stride + r] += v;
+        }
+      }
+    }
+    __syncthreads();
+  }
+}
+
+/*! \brief the widest copy type, up to 8 bytes, dividing the rows and aligning both pointers */
+inline int PermuteCopyTypeSize(index_t dtype_size, index_t row, const void* in, const void* out) {
+  index_t size = std::max(index_t(8), dtype_size);
+  while (size > dtype_size) {
+    if ((row * dtype_size) % size == 0 && reinterpret_cast<uintptr_t>(in) % size == 0 &&
+        reinterpret_cast<uintptr_t>(out) % size == 0)
+      break;
+    size /= 2;
+  }
+  return size;
+}
+
+}  // namespace cuda
+
+/*!
+ * \brief Permutes the axes of in into out on GPU: rows copied as vectors when the innermost axis
+ *        stays innermost, shared memory tiles otherwise.
+ */
+template <typename DType, bool is_addto>
+void PermuteGPU(const PermuteParams& p, const DType* in, DType* out, mshadow::Stream<gpu>* s) {
+  cudaStream_t stream = mshadow::Stream<gpu>::GetStream(s);
+  const int last      = p.ndim - 1;
+  if (p.axes[last] == last) {
+    const PermuteBatch batch(p, last, -1);
+    // the additions are done per element
+    const int csize =
+        is_addto ? sizeof(DType) : cuda::PermuteCopyTypeSize(sizeof(DType), p.shape[last], in, out);
+    const index_t row = p.shape[last] * sizeof(DType) / csize;
+    const index_t n   = batch.size * row;
+    const int blocks  = std::min<index_t>(mshadow::cuda::kMaxGridNum,
+                                         (n + mshadow::cuda::kBaseThreadNum - 1) /
+                                             mshadow::cuda::kBaseThreadNum);
+    const int threads = mshadow::cuda::kBaseThreadNum;
+    switch (csize) {
+      case 1:
+        cuda::permute_rows<DType, uint8_t, is_addto>
+            <<<blocks, threads, 0, stream>>>(out, in, batch, row, n);
+        break;
+      case 2:
+        cuda::permute_rows<DType, uint16_t, is_addto>
+            <<<blocks, threads, 0, stream>>>(out, in, batch, row, n);
+        break;
+      case 4:
+        cuda::permute_rows<DType, uint32_t, is_addto>
+            <<<blocks, threads, 0, stream>>>(out, in, batch, row, n);
+        break;
+      case 8:
+        cuda::permute_rows<DType, uint64_t, is_addto>
+            <<<blocks, threads, 0, stream>>>(out, in, batch, row, n);
+        break;
+      default:
+        LOG(FATAL) << "Unsupported copy type size " << csize;
+    }
+    MSHADOW_CUDA_POST_KERNEL_CHECK(permute_rows);
+    return;
+  }
+  const int q        = PermuteInnerPos(p);
+  const index_t rows = p.shape[p.axes[last]];
+  const index_t cols = p.shape[last];
+  const PermuteBatch batch(p, q, last);
+  index_t in_row_stride = 1, out_col_stride = 1;
+  for (int j = p.axes[last] + 1; j < p.ndim; ++j)
+    in_row_stride *= p.shape[j];
+  for (int i = q + 1; i < p.ndim; ++i)
+    out_col_stride *= p.shape[p.axes[i]];
+  const index_t row_tiles = (rows + kPermuteTile - 1) / kPermuteTile;
+  const index_t col_tiles = (cols + kPermuteTile - 1) / kPermuteTile;
+  const dim3 grid(row_tiles * col_tiles,
+                  std::min<index_t>(batch.size, mshadow::cuda::kMaxGridNum));
+  const dim3 block(kPermuteTile, cuda::kPermuteTileRows);
+  const int nshared = kPermuteTile * (kPermuteTile + 1) * sizeof(DType);
+  cuda::permute_tiled<DType, is_addto><<<grid, block, nshared, stream>>>(
+      out, in, batch, rows, cols, col_tiles, in_row_stride, out_col_stride);
+  MSHADOW_CUDA_POST_KERNEL_CHECK(permute_tiled);
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_TENSOR_PERMUTE_OP_INL_CUH_
@@ -0,0 +1,247 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file permute_op-inl.h
+ * \brief N-D permutation of the axes of a tensor, after collapsing the axes which stay adjacent
+ */
+#ifndef MXNET_OPERATOR_TENSOR_PERMUTE_OP_INL_H_
+#define MXNET_OPERATOR_TENSOR_PERMUTE_OP_INL_H_
+
+#include <mxnet/base.h>
+#include <mxnet/tuple.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "../../engine/openmp.h"
+
+namespace mxnet {
+namespace op {
+
+/*! \brief the maximum number of axes of a collapsed permutation */
+constexpr int kMaxPermuteDims = 8;
+
+/*! \brief side of the square tiles of the permutations changing the innermost axis */
+constexpr int kPermuteTile = 32;
+
+/*!
+ * \brief A permutation of the axes of a tensor with no axis of size 1 and no two axes adjacent
+ *        in both the input and the output. Output axis i is input axis axes[i].
+ */
+struct PermuteParams {
+  int ndim;
+  index_t shape[kMaxPermuteDims];
+  int axes[kMaxPermuteDims];
+};
+
+/*!
+ * \brief Collapses the permutation axes of a tensor of the given shape, which is false when
+ *        it keeps more than kMaxPermuteDims axes.
+ */
+inline bool CollapsePermutation(const mxnet::TShape& shape,
+                                const mxnet::TShape& axes,
+                                PermuteParams* p) {
+  const int ndim = shape.ndim();
+  // drop the axes of size 1
+  std::vector<int> new_id(ndim, -1);
+  std::vector<index_t> sizes;
+  for (int i = 0; i < ndim; ++i) {
+    if (shape[i] != 1) {
+      new_id[i] = sizes.size();
+      sizes.push_back(shape[i]);
+    }
+  }
+  std::vector<int> perm;
+  for (int i = 0; i < ndim; ++i) {
+    if (new_id[axes[i]] >= 0)
+      perm.push_back(new_id[axes[i]]);
+  }
+  // merge the runs of consecutive input axes of the output, each into its first axis
+  std::vector<int> run_of(sizes.size(), -1);
+  std::vector<int> run_starts;
+  for (size_t i = 0; i < perm.size(); ++i) {
+    if (i == 0 || perm[i] != perm[i - 1] + 1)
+      run_starts.push_back(perm[i]);
+    run_of[perm[i]] = run_starts.size() - 1;
+  }
+  if (run_starts.size() > static_cast<size_t>(kMaxPermuteDims))
+    return false;
+  // the runs in input order, with their sizes
+  std::vector<int> run_order(run_starts.size());
+  for (size_t r = 0; r < run_order.size(); ++r)
+    run_order[r] = r;
+  std::sort(run_order.begin(), run_order.end(), [&](int a, int b) {
+    return run_starts[a] < run_starts[b];
+  });
+  std::vector<int> input_pos(run_starts.size());
+  p->ndim = run_starts.size();
+  for (int j = 0; j < p->ndim; ++j) {
+    const int r  = run_order[j];
+    input_pos[r] = j;
+    p->shape[j]  = 1;
+    for (size_t k = run_starts[r]; k < sizes.size() && run_of[k] == r; ++k)
+      p->shape[j] *= sizes[k];
+  }
+  for (int i = 0; i < p->ndim; ++i)
+    p->axes[i] = input_pos[i];
+  if (p->ndim == 0) {
+    p->ndim     = 1;
+    p->shape[0] = 1;
+    p->axes[0]  = 0;
+  }
+  return true;
+}
+
+/*!
+ * \brief The output axes other than the ones moved as a whole, visited from the outermost,
+ *        with their strides in the input and the output.
+ */
+struct PermuteBatch {
+  int ndim = 0;
+  index_t shape[kMaxPermuteDims];
+  index_t in_stride[kMaxPermuteDims];
+  index_t out_stride[kMaxPermuteDims];
+  index_t size = 1;
+
+  /*! \brief the batch of the output axes of p but the ones of skip, -1 for none */
+  PermuteBatch(const PermuteParams& p, int skip0, int skip1) {
+    index_t in_strides[kMaxPermuteDims], out_strides[kMaxPermuteDims];
+    in_strides[p.ndim - 1]  = 1;
+    out_strides[p.ndim - 1] = 1;
+    for (int i = p.ndim - 2; i >= 0; --i) {
+      in_strides[i]  = in_strides[i + 1] * p.shape[i + 1];
+      out_strides[i] = out_strides[i + 1] * p.shape[p.axes[i + 1]];
+    }
+    for (int i = 0; i < p.ndim; ++i) {
+      if (i == skip0 || i == skip1)
+        continue;
+      shape[ndim]      = p.shape[p.axes[i]];
+      in_stride[ndim]  = in_strides[p.axes[i]];
+      out_stride[ndim] = out_strides[i];
+      size *= shape[ndim];
+      ++ndim;
+    }
+  }
+
+  /*! \brief the offsets in the input and the output of the batch index b */
+  MSHADOW_XINLINE void Offsets(index_t b, index_t* in_off, index_t* out_off) const {
+    *in_off  = 0;
+    *out_off = 0;
+    for (int i = ndim - 1; i >= 0; --i) {
+      const index_t idx = b % shape[i];
+      b /= shape[i];
+      *in_off += idx * in_stride[i];
+      *out_off += idx * out_stride[i];
+    }
+  }
+};
+
+/*! \brief the output position of the innermost input axis of p */
+inline int PermuteInnerPos(const PermuteParams& p) {
+  for (int i = 0; i < p.ndim; ++i) {
+    if (p.axes[i] == p.ndim - 1)
+      return i;
+  }
+  return -1;
+}
+
+/*!
+ * \brief Permutes the axes of in into out on CPU. When the innermost axis stays innermost, the
+ *        rows along it are copied whole. Otherwise the innermost input and output axes are
+ *        moved in square tiles, small enough for both to stay in the L1 cache.
+ */
+template <typename DType, bool is_addto>
+void PermuteCPU(const PermuteParams& p, const DType* in, DType* out) {
+  const int last = p.ndim - 1;
+  if (p.axes[last] == last) {
+    const index_t row = p.shape[last];
+    const PermuteBatch batch(p, last, -1);
+#pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
+    for (index_t b = 0; b < batch.size; ++b) {
+      index_t in_off, out_off;
+      batch.Offsets(b, &in_off, &out_off);
+      if (!is_addto) {
+        std::memcpy(out + out_off, in + in_off, row * sizeof(DType));
+      } else {
+        for (index_t k = 0; k < row; ++k)
+          out[out_off + k] += in[in_off + k];
+      }
+    }
+    return;
+  }
+  // tiles of the rows of input axis axes[last] by the columns of input axis last
+  const int q        = PermuteInnerPos(p);
+  const index_t rows = p.shape[p.axes[last]];
+  const index_t cols = p.shape[last];
+  const PermuteBatch batch(p, q, last);
+  index_t in_row_stride = 1, out_col_stride = 1;
+  for (int j = p.axes[last] + 1; j < p.ndim; ++j)
+    in_row_stride *= p.shape[j];
+  for (int i = q + 1; i < p.ndim; ++i)
+    out_col_stride *= p.shape[p.axes[i]];
+  const index_t row_tiles = (rows + kPermuteTile - 1) / kPermuteTile;
+  const index_t col_tiles = (cols + kPermuteTile - 1) / kPermuteTile;
+  const index_t num_tiles = batch.size * row_tiles * col_tiles;
+#pragma omp parallel for num_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount())
+  for (index_t t = 0; t < num_tiles; ++t) {
+    const index_t b  = t / (row_tiles * col_tiles);
+    const index_t r0 = (t / col_tiles) % row_tiles * kPermuteTile;
+    const index_t c0 = t % col_tiles * kPermuteTile;
+    const index_t r1 = std::min(r0 + kPermuteTile, rows);
+    const index_t c1 = std::min(c0 + kPermuteTile, cols);
+    index_t in_off, out_off;
+    batch.Offsets(b, &in_off, &out_off);
+    for (index_t c = c0; c < c1; ++c) {
+      const DType* src = in + in_off + c;
+      DType* dst       = out + out_off + c * out_col_stride;
+      for (index_t r = r0; r < r1; ++r) {
+        if (!is_addto) {
+          dst[r] = src[r * in_row_stride];
+        } else {
+          dst[r] += src[r * in_row_stride];
+        }
+      }
+    }
+  }
+}
+
+/*! \brief defined in permute_op-inl.cuh */
+template <typename DType, bool is_addto>
+void PermuteGPU(const PermuteParams& p, const DType* in, DType* out, mshadow::Stream<gpu>* s);
+
+template <bool is_addto, typename DType>
+inline void PermuteImpl(mshadow::Stream<cpu>* s,
+                        const PermuteParams& p,
+                        const DType* in,
+                        DType* out) {
+  PermuteCPU<DType, is_addto>(p, in, out);
+}
+
+template <bool is_addto, typename DType>
+inline void PermuteImpl(mshadow::Stream<gpu>* s,
+                        const PermuteParams& p,
+                        const DType* in,
+                        DType* out) {
+  PermuteGPU<DType, is_addto>(p, in, out, s);
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_TENSOR_PERMUTE_OP_INL_H_
@@ -28,6 +28,7 @@
 #include <mshadow/tensor.h>
 #include <vector>
 #include <type_traits>
+#include "../../common/utils.h"
 
 namespace mxnet {
 
@@ -82,12 +83,13 @@ inline void SortByKey(mshadow::Tensor<cpu, 1, KDType> keys,
     keys_vec[i]   = keys[i];
     values_vec[i] = values[i];
   }
+  const int nthreads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
   if (is_ascend) {
-    std::stable_sort(idx.begin(), idx.end(), [&keys_vec](size_t i1, size_t i2) {
+    common::ParallelStableSort(idx.begin(), idx.end(), nthreads, [&keys_vec](size_t i1, size_t i2) {
       return keys_vec[i1] < keys_vec[i2];
     });
   } else {
-    std::stable_sort(idx.begin(), idx.end(), [&keys_vec](size_t i1, size_t i2) {
+    common::ParallelStableSort(idx.begin(), idx.end(), nthreads, [&keys_vec](size_t i1, size_t i2) {
       return keys_vec[i1] > keys_vec[i2];
     });
   }
@@ -26,6 +26,8 @@
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/runtime/c_runtime_api.h>
+#include <dmlc/parameter.h>
+#include <fstream>
 #include <string>
 #include <vector>
 #include "op_module.h"
@@ -45,61 +47,110 @@ void TVMOpModule::Load(const std::string& filepath) {
   *module_ptr_  = module;
 }
 
+void TVMOpModule::LoadTuned(const std::string& filepath) {
+  static const PackedFunc* f_load = Registry::Get("runtime.ModuleLoadFromFile");
+  Module module                   = (*f_load)(filepath, "");
+  std::lock_guard<std::mutex> lock(tuned_mutex_);
+  if (tuned_ptr_ == nullptr) {
+    tuned_ptr_ = std::make_shared<Module>(module);
+  } else {
+    tuned_ptr_->Import(module);
+  }
+  // the calls without a tuned kernel so far may have one now
+  tuned_funcs_.clear();
+}
+
 void TVMOpModule::Import(const TVMOpModule& module) {
   CHECK(module_ptr_ != nullptr) << "module_ptr_ is not initialized.";
   std::lock_guard<std::mutex> lock(mutex_);
   module_ptr_->Import(*(module.module_ptr_));
 }
 
+const char* DTypeName(int type_flag) {
+  switch (type_flag) {
+    case mshadow::kFloat32:
+      return "float32";
+    case mshadow::kFloat64:
+      return "float64";
+    case mshadow::kFloat16:
+      return "float16";
+    case mshadow::kUint8:
+      return "uint8";
+    case mshadow::kUint16:
+      return "uint16";
+    case mshadow::kUint32:
+      return "uint32";
+    case mshadow::kUint64:
+      return "uint64";
+    case mshadow::kInt16:
+      return "int16";
+    case mshadow::kInt32:
+      return "int32";
+    case mshadow::kInt8:
+      return "int8";
+    case mshadow::kInt64:
+      return "int64";
+    case mshadow::kBool:
+      return "bool";
+    default:
+      LOG(FATAL) << "Unknown dtype " << type_flag;
+  }
+  return nullptr;
+}
+
+// name of the generic kernel of an operator for the dtypes and the ndims of its arguments
+std::string FunctionName(const std::string& op_name, const std::vector<mxnet::TBlob>& args) {
+  std::ostringstream func_name;
+  func_name << op_name;
+  for (const auto& arg : args) {
+    func_name << DTypeName(arg.type_flag_) << "_" << arg.shape_.ndim();
+  }
+  return func_name.str();
+}
+
 PackedFunc GetFunction(const std::shared_ptr<Module>& module,
                        const std::string& op_name,
                        const std::vector<mxnet::TBlob>& args) {
-  std::ostringstream func_name;
-  func_name << op_name;
+  return module->GetFunction(FunctionName(op_name, args), false);
+}
+
+PackedFunc TVMOpModule::GetTunedFunction(const std::string& func_name,
+                                         const mxnet::OpContext& ctx,
+                                         const std::vector<mxnet::TBlob>& args) const {
+  static const std::string tune_log = dmlc::GetEnv("MXNET_TVM_OP_TUNE_LOG", std::string());
+  std::lock_guard<std::mutex> lock(tuned_mutex_);
+  if (tuned_ptr_ == nullptr && tune_log.empty())
+    return PackedFunc();
+  // the tuned kernel of the generic kernel name followed by the shapes of the arguments
+  const std::string generic_name = FunctionName(func_name, args);
+  std::ostringstream name;
+  name << generic_name << "shape";
   for (const auto& arg : args) {
-    switch (arg.type_flag_) {
-      case mshadow::kFloat32:
-        func_name << "float32";
-        break;
-      case mshadow::kFloat64:
-        func_name << "float64";
-        break;
-      case mshadow::kFloat16:
-        func_name << "float16";
-        break;
-      case mshadow::kUint8:
-        func_name << "uint8";
-        break;
-      case mshadow::kUint16:
-        func_name << "uint16";
-        break;
-      case mshadow::kUint32:
-        func_name << "uint32";
-        break;
-      case mshadow::kUint64:
-        func_name << "uint64";
-        break;
-      case mshadow::kInt16:
-        func_name << "int16";
-        break;
-      case mshadow::kInt32:
-        func_name << "int32";
-        break;
-      case mshadow::kInt8:
-        func_name << "int8";
-        break;
-      case mshadow::kInt64:
-        func_name << "int64";
-        break;
-      case mshadow::kBool:
-        func_name << "bool";
-        break;
-      default:
-        LOG(FATAL) << "Unknown dtype " << arg.type_flag_;
+    name << "_";
+    for (int i = 0; i < arg.shape_.ndim(); ++i)
+      name << (i > 0 ? "x" : "") << arg.shape_[i];
+  }
+  auto it = tuned_funcs_.find(name.str());
+  if (it == tuned_funcs_.end()) {
+    PackedFunc func;
+    if (tuned_ptr_ != nullptr)
+      func = tuned_ptr_->GetFunction(name.str(), true);
+    if (func == nullptr && !tune_log.empty()) {
+      std::ofstream log(tune_log, std::ios::app);
+      log << "{\"func\": \"" << generic_name << "\", \"device\": \""
+          << (ctx.run_ctx.ctx.dev_mask() == mxnet::Context::kGPU ? "gpu" : "cpu")
+          << "\", \"shapes\": [";
+      for (size_t j = 0; j < args.size(); ++j) {
+        log << (j > 0 ? ", [" : "[");
+        for (int i = 0; i < args[j].shape_.ndim(); ++i)
+          log << (i > 0 ? ", " : "") << args[j].shape_[i];
+        log << "]";
+      }
+      log << "]}\n";
     }
-    func_name << "_" << arg.shape_.ndim();
+    it = tuned_funcs_.emplace(name.str(), std::make_shared<PackedFunc>(func)).first;
   }
-  return module->GetFunction(func_name.str(), false);
+  return *it->second;
 }
 
 void TVMOpModule::Call(const std::string& func_name,
@@ -126,7 +177,10 @@ void TVMOpModule::Call(const std::string& func_name,
     TVMSetStream(dev_type, dev_id, stream);
   }
 #endif
-  GetFunction(module_ptr_, func_name, args).CallPacked(tvm_args, &rv);
+  PackedFunc func = GetTunedFunction(func_name, ctx, args);
+  if (func == nullptr)
+    func = GetFunction(module_ptr_, func_name, args);
+  func.CallPacked(tvm_args, &rv);
 #if MXNET_USE_CUDA
   if (dev_type == kDLGPU) {
     TVMSetStream(dev_type, dev_id, nullptr);
@@ -148,7 +202,10 @@ void TVMOpModule::CallEx(const std::string& func_name,
     TVMSetStream(dev_type, dev_id, stream);
   }
 #endif
-  GetFunction(module_ptr_, func_name, tblobs).CallPacked(tvm_args, &rv);
+  PackedFunc func = GetTunedFunction(func_name, ctx, tblobs);
+  if (func == nullptr)
+    func = GetFunction(module_ptr_, func_name, tblobs);
+  func.CallPacked(tvm_args, &rv);
 #if MXNET_USE_CUDA
   if (dev_type == kDLGPU) {
     TVMSetStream(dev_type, dev_id, nullptr);
@@ -28,8 +28,10 @@
 #if MXNET_USE_TVM_OP
 #include <mxnet/base.h>
 #include <mxnet/op_attr_types.h>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <map>
 
@@ -38,11 +40,19 @@ namespace runtime {
 
 class TVMArgs;
 class Module;
+class PackedFunc;
 class TVMOpModule {
  public:
   // Load TVM operators binary
   void Load(const std::string& filepath);
 
+  /*!
+   * \brief Load kernels specialized and tuned for the shapes of their arguments, which are called
+   * in place of the generic kernel of an operator for those shapes.
+   * \param filepath library built by contrib/tvmop/tune.py
+   */
+  void LoadTuned(const std::string& filepath);
+
   void Import(const TVMOpModule& module);
 
   void Call(const std::string& func_name,
@@ -70,8 +80,20 @@ class TVMOpModule {
   }
 
  private:
+  /*!
+   * \brief The tuned kernel of a call, an empty function when there is none. With
+   * MXNET_TVM_OP_TUNE_LOG set, the calls without one are logged once as tuning candidates.
+   */
+  PackedFunc GetTunedFunction(const std::string& func_name,
+                              const mxnet::OpContext& ctx,
+                              const std::vector<mxnet::TBlob>& args) const;
+
   std::mutex mutex_;
   std::shared_ptr<Module> module_ptr_;
+  // the kernels of the name and shapes of a call, looked up once
+  mutable std::mutex tuned_mutex_;
+  std::shared_ptr<Module> tuned_ptr_;
+  mutable std::unordered_map<std::string, std::shared_ptr<PackedFunc>> tuned_funcs_;
 };
 
 class OtherOptionEntity {
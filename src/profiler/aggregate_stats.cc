@@ -23,7 +23,11 @@
  */
 #include <dmlc/base.h>
 #include <dmlc/logging.h>
+#include <dmlc/parameter.h>
 #include <mxnet/base.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <thread>
 #include <iomanip>
@@ -46,6 +50,93 @@ inline float ByteToKilobyte(const DType byte) {
   return static_cast<float>(static_cast<double>(byte) / 1000);
 }
 
+/*!
+ * \brief Achieved throughput of an operator against the roofline of its device. The peaks of
+ *  each device type are given by MXNET_PROFILER_{CPU,GPU}_PEAK_{GFLOPS,GBPS}, 0 if unknown.
+ */
+struct Roofline {
+  explicit Roofline(const AggregateStats::StatData& data) {
+    const bool is_gpu          = data.dev_type_ == Context::kGPU;
+    static const double peak[] = {
+        dmlc::GetEnv("MXNET_PROFILER_CPU_PEAK_GFLOPS", 0.0),
+        dmlc::GetEnv("MXNET_PROFILER_CPU_PEAK_GBPS", 0.0),
+        dmlc::GetEnv("MXNET_PROFILER_GPU_PEAK_GFLOPS", 0.0),
+        dmlc::GetEnv("MXNET_PROFILER_GPU_PEAK_GBPS", 0.0),
+    };
+    const double peak_gflops = peak[is_gpu ? 2 : 0];
+    const double peak_gbps   = peak[is_gpu ? 3 : 1];
+    // the time in us is the unit of GFLOP/s and GB/s scaled by 1e3
+    const double us = static_cast<double>(data.cost_aggregate_);
+    gflops_         = us > 0 ? data.total_flops_ / us / 1e3 : 0;
+    gbps_           = us > 0 ? data.total_bytes_ / us / 1e3 : 0;
+    // the roofline bound is the larger of the compute and the memory time at peak rate
+    const double compute_us = peak_gflops > 0 ? data.total_flops_ / peak_gflops / 1e3 : 0;
+    const double memory_us  = peak_gbps > 0 ? data.total_bytes_ / peak_gbps / 1e3 : 0;
+    if (us > 0 && (compute_us > 0 || memory_us > 0)) {
+      percent_ = 100 * std::max(compute_us, memory_us) / us;
+      bound_   = compute_us >= memory_us ? "compute" : "memory";
+    }
+  }
+  double gflops_ = 0;
+  double gbps_   = 0;
+  /*! \brief percentage of the roofline bound reached, negative if no peak is known */
+  double percent_ = -1;
+  const char* bound_ = "-";
+};
+
+inline bool HasCost(const AggregateStats::StatData& data) {
+  return data.cost_aggregate_ > 0;
+}
+
+/*!
+ * \brief Rates derived from the hardware counters of an operator. A counter the hardware does
+ *  not provide leaves its rates negative.
+ */
+struct HardwareRates {
+  explicit HardwareRates(const AggregateStats::StatData& data) {
+    using HC              = HardwareCounters;
+    const HC::Values& hw  = data.hw_counters_;
+    const double us       = static_cast<double>(data.hw_aggregate_);
+    const auto available  = [&hw](int counter) { return !std::isnan(hw[counter]); };
+    if (available(HC::kCycles) && available(HC::kInstructions) && hw[HC::kCycles] > 0) {
+      ipc_ = hw[HC::kInstructions] / hw[HC::kCycles];
+    }
+    if (available(HC::kInstructions) && available(HC::kLLCMisses) && hw[HC::kInstructions] > 0) {
+      llc_mpki_ = 1e3 * hw[HC::kLLCMisses] / hw[HC::kInstructions];
+    }
+    if (available(HC::kFPInstructions) && us > 0) {
+      fp_ginst_ = hw[HC::kFPInstructions] / us / 1e3;
+    }
+    if (hw[HC::kKernels] > 0 && hw[HC::kKernelTime] > 0) {
+      kernel_ms_ = hw[HC::kKernelTime] / 1e6 / data.hw_count_;
+      occupancy_ = 100 * hw[HC::kOccupancyTime] / hw[HC::kKernelTime];
+    }
+  }
+  double ipc_       = -1;
+  double llc_mpki_  = -1;
+  double fp_ginst_  = -1;
+  /*! \brief average time of the GPU kernels of an execution */
+  double kernel_ms_ = -1;
+  /*! \brief theoretical occupancy of the kernels, weighted by their time */
+  double occupancy_ = -1;
+
+  static constexpr int kNumRates = 5;
+  double operator[](int i) const {
+    const double rates[kNumRates] = {ipc_, llc_mpki_, fp_ginst_, kernel_ms_, occupancy_};
+    return rates[i];
+  }
+};
+
+/*! \brief column names of the hardware rates in the table and keys in the json dump */
+const char* const kHardwareRateNames[HardwareRates::kNumRates] = {
+    "IPC", "LLC MPKI", "FP GInst/s", "Kernel (ms)", "Occupancy (%)"};
+const char* const kHardwareRateKeys[HardwareRates::kNumRates] = {
+    "IPC", "LLCMPKI", "FPGINSTPS", "KernelTime", "Occupancy"};
+
+inline bool HasHardwareCounters(const AggregateStats::StatData& data) {
+  return data.hw_count_ > 0;
+}
+
 inline std::priority_queue<pi> BuildHeap(
     const std::unordered_map<std::string, AggregateStats::StatData>& map,
     int sort_by,
@@ -109,13 +200,41 @@ void AggregateStats::DumpTable(std::ostream& os, int sort_by, int ascending) {
        << (is_memory ? "" : "Time (ms)") << (is_memory ? "" : " ") << std::setw(16) << std::right
        << (is_memory ? "Min Use  (kB)" : "Min Time (ms)") << " " << std::setw(16) << std::right
        << (is_memory ? "Max Use  (kB)" : "Max Time (ms)") << " " << std::setw(16) << std::right
-       << (is_memory ? "Avg Use  (kB)" : "Avg Time (ms)") << std::endl;
+       << (is_memory ? "Avg Use  (kB)" : "Avg Time (ms)");
+    const bool has_cost = std::any_of(
+        mm.begin(), mm.end(), [](const auto& it) { return HasCost(it.second); });
+    if (has_cost) {
+      os << " " << std::setw(12) << std::right << "GFLOP/s"
+         << " " << std::setw(12) << std::right << "GB/s"
+         << " " << std::setw(12) << std::right << "Roofline (%)"
+         << " " << std::setw(8) << std::right << "Bound";
+    }
+    const bool has_hw = std::any_of(
+        mm.begin(), mm.end(), [](const auto& it) { return HasHardwareCounters(it.second); });
+    if (has_hw) {
+      for (const char* column : kHardwareRateNames) {
+        os << " " << std::setw(13) << std::right << column;
+      }
+    }
+    os << std::endl;
     os << std::setw(25) << std::left << "----" << std::setw(16) << std::right << "-----------"
        << " " << (is_memory ? std::setw(0) : std::setw(16)) << std::right
        << (is_memory ? "" : "---------") << (is_memory ? "" : " ") << std::setw(16) << std::right
        << "-------------"
        << " " << std::setw(16) << std::right << "-------------"
-       << " " << std::setw(16) << std::right << "-------------" << std::endl;
+       << " " << std::setw(16) << std::right << "-------------";
+    if (has_cost) {
+      os << " " << std::setw(12) << std::right << "-------"
+         << " " << std::setw(12) << std::right << "----"
+         << " " << std::setw(12) << std::right << "------------"
+         << " " << std::setw(8) << std::right << "-----";
+    }
+    if (has_hw) {
+      for (const char* column : kHardwareRateNames) {
+        os << " " << std::setw(13) << std::right << std::string(strlen(column), '-');
+      }
+    }
+    os << std::endl;
     auto heap = BuildHeap(mm, sort_by, ascending);
     while (!heap.empty()) {
       const std::string& name = heap.top().second;
@@ -134,6 +253,31 @@ void AggregateStats::DumpTable(std::ostream& os, int sort_by, int ascending) {
            << (data.type_ == AggregateStats::StatData::kCounter ?
                    ByteToKilobyte((data.max_aggregate_ - data.min_aggregate_) / 2) :
                    MicroToMilli(static_cast<double>(data.total_aggregate_) / data.total_count_));
+        if (has_cost && HasCost(data)) {
+          const Roofline roofline(data);
+          os << " " << std::setw(12) << std::setprecision(2) << roofline.gflops_ << " "
+             << std::setw(12) << roofline.gbps_ << " " << std::setw(12);
+          if (roofline.percent_ >= 0)
+            os << roofline.percent_;
+          else
+            os << "-";
+          os << " " << std::setw(8) << roofline.bound_;
+        } else if (has_cost) {
+          os << " " << std::setw(12) << "-"
+             << " " << std::setw(12) << "-"
+             << " " << std::setw(12) << "-"
+             << " " << std::setw(8) << "-";
+        }
+        if (has_hw) {
+          const HardwareRates rates(data);
+          for (int i = 0; i < HardwareRates::kNumRates; ++i) {
+            os << " " << std::setw(13) << std::setprecision(2);
+            if (HasHardwareCounters(data) && rates[i] >= 0)
+              os << rates[i];
+            else
+              os << "-";
+          }
+        }
         os << std::endl;
       }
       heap.pop();
@@ -183,9 +327,31 @@ void AggregateStats::DumpJson(std::ostream& os, int sort_by, int ascending) {
             << "                \"Avg\": " << std::setprecision(4)
             << (data.type_ == AggregateStats::StatData::kCounter ?
                     ByteToKilobyte((data.max_aggregate_ - data.min_aggregate_) / 2) :
-                    MicroToMilli(static_cast<double>(data.total_aggregate_) / data.total_count_))
-            << std::endl
-            << "            }" << std::endl;
+                    MicroToMilli(static_cast<double>(data.total_aggregate_) / data.total_count_));
+        if (HasCost(data)) {
+          const Roofline roofline(data);
+          *ss << "," << std::endl
+              << "                \"GFLOPS\": " << std::setprecision(4) << roofline.gflops_ << ","
+              << std::endl
+              << "                \"GBPS\": " << std::setprecision(4) << roofline.gbps_;
+          if (roofline.percent_ >= 0) {
+            *ss << "," << std::endl
+                << "                \"Roofline\": " << std::setprecision(4) << roofline.percent_
+                << "," << std::endl
+                << "                \"Bound\": \"" << roofline.bound_ << "\"";
+          }
+        }
+        if (HasHardwareCounters(data)) {
+          const HardwareRates rates(data);
+          for (int i = 0; i < HardwareRates::kNumRates; ++i) {
+            if (rates[i] >= 0) {
+              *ss << "," << std::endl
+                  << "                \"" << kHardwareRateKeys[i] << "\": " << std::setprecision(4)
+                  << rates[i];
+            }
+          }
+        }
+        *ss << std::endl << "            }" << std::endl;
       }
       heap.pop();
     }
@@ -200,7 +366,14 @@ void AggregateStats::DumpJson(std::ostream& os, int sort_by, int ascending) {
      << "," << std::endl
      << "    \"Unit\": {" << std::endl
      << R"(        "Time": "ms",)" << std::endl
-     << R"(        "Memory": "kB")" << std::endl
+     << R"(        "Memory": "kB",)" << std::endl
+     << R"(        "GFLOPS": "GFLOP/s",)" << std::endl
+     << R"(        "GBPS": "GB/s",)" << std::endl
+     << R"(        "Roofline": "%",)" << std::endl
+     << R"(        "LLCMPKI": "misses per 1000 instructions",)" << std::endl
+     << R"(        "FPGINSTPS": "GInst/s",)" << std::endl
+     << R"(        "KernelTime": "ms",)" << std::endl
+     << R"(        "Occupancy": "%")" << std::endl
      << "    }" << std::endl
      << "}" << std::endl
      << std::flush;
@@ -25,6 +25,7 @@
 #include <cstdint>
 #include <ostream>
 #include <mutex>
+#include "./hw_counters.h"
 #include "./profiler.h"
 
 namespace mxnet {
@@ -45,6 +46,18 @@ class AggregateStats {
     uint64_t total_aggregate_ = 0;
     uint64_t max_aggregate_   = 0;
     uint64_t min_aggregate_   = INT_MAX;
+    /*! \brief work reported by the executions of an operator with an FOpCost */
+    double total_flops_ = 0;
+    double total_bytes_ = 0;
+    /*! \brief total duration of the executions that reported their work */
+    uint64_t cost_aggregate_ = 0;
+    /*! \brief device type of the last execution that reported its work */
+    int dev_type_ = 0;
+    /*! \brief hardware counters summed over the executions that sampled them */
+    HardwareCounters::Values hw_counters_{};
+    /*! \brief number and total duration of the executions that sampled hardware counters */
+    size_t hw_count_       = 0;
+    uint64_t hw_aggregate_ = 0;
   };
 
   /*!
@@ -0,0 +1,105 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file data_profiler.h
+ * \brief spans of the stages of the input pipeline in the "data" domain of the trace
+ */
+#ifndef MXNET_PROFILER_DATA_PROFILER_H_
+#define MXNET_PROFILER_DATA_PROFILER_H_
+
+#include <optional>
+#include "./profiler.h"
+
+namespace mxnet {
+namespace profiler {
+
+/*!
+ * \brief Span of a stage of the input pipeline (read, decode, augment, normalize, batchify,
+ *  prefetch wait) on the calling thread, recorded while the profiler runs.
+ *
+ *  Spans that do work also count the thread as busy in the "busy threads" counter of the
+ *  domain, so the trace shows the occupancy of the loader threads next to the operators.
+ *  Nested spans count the thread once.
+ */
+class DataSpan {
+ public:
+  /*!
+   * \param stage name of the stage, must outlive the span
+   * \param busy false for spans that wait, such as the consumer waiting on the prefetcher
+   */
+  explicit DataSpan(const char* stage, bool busy = true) {
+    if (Profiler::Get()->GetState() != Profiler::kRunning) {
+      return;
+    }
+    task_.emplace(stage, Domain());
+    task_->start();
+    if (busy) {
+      counted_ = true;
+      if (Depth()++ == 0) {
+        busy_ = true;
+        ++BusyThreads();
+      }
+    }
+  }
+
+  ~DataSpan() {
+    if (!task_) {
+      return;
+    }
+    if (busy_) {
+      --BusyThreads();
+    }
+    if (counted_) {
+      --Depth();
+    }
+    task_->stop();
+  }
+
+  DataSpan(const DataSpan&) = delete;
+  DataSpan& operator=(const DataSpan&) = delete;
+
+  /*! \brief domain of the input pipeline spans */
+  static ProfileDomain* Domain() {
+    static ProfileDomain domain("data");
+    return &domain;
+  }
+
+ private:
+  /*! \brief number of threads inside a busy span */
+  static ProfileCounter& BusyThreads() {
+    static ProfileCounter counter("busy threads", Domain());
+    return counter;
+  }
+  /*! \brief busy spans open on this thread */
+  static int& Depth() {
+    static thread_local int depth = 0;
+    return depth;
+  }
+
+  std::optional<ProfileTask> task_;
+  /*! \brief whether this span is counted in the depth of the thread */
+  bool counted_ = false;
+  /*! \brief whether this span counted the thread as busy, only the outermost one does */
+  bool busy_ = false;
+};
+
+}  // namespace profiler
+}  // namespace mxnet
+#endif  // MXNET_PROFILER_DATA_PROFILER_H_
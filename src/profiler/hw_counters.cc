@@ -0,0 +1,378 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file hw_counters.cc
+ * \brief per-operator hardware counters
+ */
+#include "./hw_counters.h"
+
+#include <dmlc/parameter.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifndef MXNET_USE_CUPTI
+#define MXNET_USE_CUPTI 0
+#endif
+
+#if MXNET_USE_CUDA && MXNET_USE_CUPTI
+#include <cuda_runtime.h>
+#include <cupti.h>
+#endif
+
+#include "../common/utils.h"
+
+namespace mxnet {
+namespace profiler {
+
+namespace {
+
+#if defined(__linux__)
+/*!
+ * \brief perf_event group counting the user space events of the calling thread, opened on
+ *  first use. The events the PMU does not support are left out of the group.
+ */
+class PerfEventGroup {
+ public:
+  /*! \return the group of the calling thread, nullptr if perf_event is not available */
+  static PerfEventGroup* Get() {
+    static thread_local PerfEventGroup group;
+    return group.leader_ >= 0 ? &group : nullptr;
+  }
+
+  ~PerfEventGroup() {
+    for (int fd : fds_) {
+      close(fd);
+    }
+  }
+
+  /*!
+   * \brief Read the counts of the group
+   * \param counts the counts, indexed by HardwareCounters::Counter
+   * \return whether the read succeeded
+   */
+  bool Read(std::array<uint64_t, HardwareCounters::kKernels>* counts) const {
+    // PERF_FORMAT_GROUP: number of events, then their values in the order they were opened
+    uint64_t buf[1 + HardwareCounters::kKernels];
+    const ssize_t size = read(leader_, buf, sizeof(buf));
+    if (size < static_cast<ssize_t>(sizeof(uint64_t) * (1 + events_.size())) ||
+        buf[0] != events_.size()) {
+      return false;
+    }
+    counts->fill(0);
+    for (size_t i = 0; i < events_.size(); ++i) {
+      (*counts)[events_[i]] = buf[1 + i];
+    }
+    return true;
+  }
+
+  /*! \return whether the group counts the event */
+  bool Counts(int counter) const {
+    return std::find(events_.begin(), events_.end(), counter) != events_.end();
+  }
+
+ private:
+  PerfEventGroup() {
+    Open(HardwareCounters::kCycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    if (leader_ < 0) {
+      common::LogOnce(
+          "perf_event_open failed, CPU hardware counters are disabled. "
+          "Check /proc/sys/kernel/perf_event_paranoid.");
+      return;
+    }
+    Open(HardwareCounters::kInstructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    Open(HardwareCounters::kLLCMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    // the floating point instructions have no generic event, e.g. 0xc7 with a umask of the
+    // FP_ARITH_INST_RETIRED subevents on Intel
+    static const uint64_t fp_event =
+        std::strtoull(dmlc::GetEnv("MXNET_PROFILER_FP_EVENT", std::string()).c_str(), nullptr, 0);
+    if (fp_event != 0) {
+      Open(HardwareCounters::kFPInstructions, PERF_TYPE_RAW, fp_event);
+    }
+  }
+
+  void Open(HardwareCounters::Counter counter, uint32_t type, uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = type;
+    attr.config         = config;
+    attr.read_format    = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    const int fd        = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, leader_, 0));
+    if (fd < 0) {
+      return;
+    }
+    if (leader_ < 0) {
+      leader_ = fd;
+    }
+    fds_.push_back(fd);
+    events_.push_back(counter);
+  }
+
+  int leader_ = -1;
+  std::vector<int> fds_;
+  std::vector<int> events_;
+};
+#endif  // defined(__linux__)
+
+#if MXNET_USE_CUDA && MXNET_USE_CUPTI
+/*!
+ * \brief CUPTI activity of the kernels, attributed to the external correlation ids pushed by
+ *  the operators launching them.
+ */
+class KernelActivity {
+ public:
+  /*! \return the activity, nullptr if CUPTI could not enable it */
+  static KernelActivity* Get() {
+    KernelActivity* activity = Instance();
+    return activity->enabled_ ? activity : nullptr;
+  }
+
+  /*! \brief Push a new external correlation id for the kernels the calling thread launches */
+  uint64_t Push() {
+    static std::atomic<uint64_t> next_id(1);
+    // ids of executions that did not stop on this thread are still on its stack
+    while (pushed_ > 0) {
+      Pop();
+    }
+    const uint64_t id = next_id++;
+    if (cuptiActivityPushExternalCorrelationId(CUPTI_EXTERNAL_CORRELATION_KIND_CUSTOM0, id) !=
+        CUPTI_SUCCESS) {
+      return 0;
+    }
+    ++pushed_;
+    return id;
+  }
+
+  /*! \brief Pop the external correlation id of the calling thread */
+  void Pop() {
+    uint64_t id;
+    cuptiActivityPopExternalCorrelationId(CUPTI_EXTERNAL_CORRELATION_KIND_CUSTOM0, &id);
+    --pushed_;
+  }
+
+  /*!
+   * \brief Wait for the kernels launched under id and add their activity to values
+   */
+  void Take(uint64_t id, HardwareCounters::Values* values) {
+    cudaDeviceSynchronize();
+    cuptiActivityFlushAll(CUPTI_ACTIVITY_FLAG_FLUSH_FORCED);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = activity_.find(id);
+    if (it == activity_.end()) {
+      return;
+    }
+    for (int i = HardwareCounters::kKernels; i < HardwareCounters::kNumCounters; ++i) {
+      (*values)[i] += it->second[i];
+    }
+    activity_.erase(it);
+  }
+
+ private:
+  /*! \brief kernel activity not yet matched with its external correlation id */
+  struct Kernel {
+    uint64_t time;
+    double occupancy;
+  };
+
+  static KernelActivity* Instance() {
+    static KernelActivity activity;
+    return &activity;
+  }
+
+  KernelActivity() {
+    int num_devices = 0;
+    if (cudaGetDeviceCount(&num_devices) == cudaSuccess) {
+      props_.resize(num_devices);
+      for (int i = 0; i < num_devices; ++i) {
+        cudaGetDeviceProperties(&props_[i], i);
+      }
+    }
+    enabled_ = num_devices > 0 &&
+               cuptiActivityRegisterCallbacks(BufferRequested, BufferCompleted) == CUPTI_SUCCESS &&
+               cuptiActivityEnable(CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL) == CUPTI_SUCCESS &&
+               cuptiActivityEnable(CUPTI_ACTIVITY_KIND_EXTERNAL_CORRELATION) == CUPTI_SUCCESS;
+    if (!enabled_) {
+      common::LogOnce("CUPTI kernel activity is not available, GPU hardware counters are disabled");
+    }
+  }
+
+  static void CUPTIAPI BufferRequested(uint8_t** buffer, size_t* size, size_t* max_num_records) {
+    constexpr size_t kBufferSize = 1 << 20;
+    *size                        = kBufferSize;
+    *buffer                      = static_cast<uint8_t*>(std::aligned_alloc(8, kBufferSize));
+    *max_num_records             = 0;
+  }
+
+  static void CUPTIAPI BufferCompleted(CUcontext context,
+                                       uint32_t stream_id,
+                                       uint8_t* buffer,
+                                       size_t size,
+                                       size_t valid_size) {
+    Instance()->Parse(buffer, valid_size);
+    std::free(buffer);
+  }
+
+  void Parse(uint8_t* buffer, size_t valid_size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CUpti_Activity* record = nullptr;
+    while (cuptiActivityGetNextRecord(buffer, valid_size, &record) == CUPTI_SUCCESS) {
+      if (record->kind == CUPTI_ACTIVITY_KIND_EXTERNAL_CORRELATION) {
+        const auto* external = reinterpret_cast<CUpti_ActivityExternalCorrelation*>(record);
+        externals_[external->correlationId] = external->externalId;
+      } else if (record->kind == CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL) {
+        const auto* kernel = reinterpret_cast<CUpti_ActivityKernel4*>(record);
+        kernels_[kernel->correlationId] = {kernel->end - kernel->start, Occupancy(*kernel)};
+      }
+    }
+    // the records of a launch and of its kernel may come in different buffers
+    for (auto it = kernels_.begin(); it != kernels_.end();) {
+      auto external = externals_.find(it->first);
+      if (external == externals_.end()) {
+        ++it;
+        continue;
+      }
+      HardwareCounters::Values& values = activity_[external->second];
+      values[HardwareCounters::kKernels] += 1;
+      values[HardwareCounters::kKernelTime] += it->second.time;
+      values[HardwareCounters::kOccupancyTime] += it->second.occupancy * it->second.time;
+      externals_.erase(external);
+      it = kernels_.erase(it);
+    }
+    // kernels launched outside of the profiled operators never find their id
+    constexpr size_t kMaxUnmatched = 1 << 16;
+    if (kernels_.size() > kMaxUnmatched || externals_.size() > kMaxUnmatched) {
+      kernels_.clear();
+      externals_.clear();
+    }
+  }
+
+  /*!
+   * \brief Theoretical occupancy of a kernel: the active warps per multiprocessor allowed by
+   *  its block size, registers and shared memory, over the maximum. Allocation granularities
+   *  are ignored.
+   */
+  double Occupancy(const CUpti_ActivityKernel4& kernel) const {
+    if (kernel.deviceId >= props_.size()) {
+      return 0;
+    }
+    const cudaDeviceProp& prop = props_[kernel.deviceId];
+    const int threads          = kernel.blockX * kernel.blockY * kernel.blockZ;
+    const int warps            = (threads + prop.warpSize - 1) / prop.warpSize;
+    const int max_warps        = prop.maxThreadsPerMultiProcessor / prop.warpSize;
+    if (warps == 0 || max_warps == 0) {
+      return 0;
+    }
+#if CUDART_VERSION >= 11000
+    int blocks = std::min(prop.maxBlocksPerMultiProcessor, max_warps / warps);
+#else
+    int blocks = max_warps / warps;
+#endif
+    if (kernel.registersPerThread > 0) {
+      blocks = std::min(
+          blocks, prop.regsPerMultiprocessor / (kernel.registersPerThread * warps * prop.warpSize));
+    }
+    const int shared_memory = kernel.staticSharedMemory + kernel.dynamicSharedMemory;
+    if (shared_memory > 0) {
+      blocks = std::min(blocks, static_cast<int>(prop.sharedMemPerMultiprocessor / shared_memory));
+    }
+    return static_cast<double>(blocks * warps) / max_warps;
+  }
+
+  bool enabled_ = false;
+  std::vector<cudaDeviceProp> props_;
+  std::mutex mutex_;
+  /*! \brief external correlation id of the launches, by correlation id */
+  std::unordered_map<uint32_t, uint64_t> externals_;
+  /*! \brief kernels waiting for their launch record, by correlation id */
+  std::unordered_map<uint32_t, Kernel> kernels_;
+  /*! \brief kernel activity, by external correlation id */
+  std::unordered_map<uint64_t, HardwareCounters::Values> activity_;
+  /*! \brief number of ids pushed by the calling thread */
+  static thread_local int pushed_;
+};
+
+thread_local int KernelActivity::pushed_ = 0;
+#endif  // MXNET_USE_CUDA && MXNET_USE_CUPTI
+
+}  // namespace
+
+HardwareCounters::Scope::Scope(Context::DeviceType dev_type)
+    : thread_(std::this_thread::get_id()) {
+#if defined(__linux__)
+  if (const PerfEventGroup* group = PerfEventGroup::Get()) {
+    cpu_ = group->Read(&cpu_start_);
+  }
+#endif
+#if MXNET_USE_CUDA && MXNET_USE_CUPTI
+  if (dev_type == Context::kGPU) {
+    if (KernelActivity* activity = KernelActivity::Get()) {
+      kernels_id_ = activity->Push();
+    }
+  }
+#endif
+}
+
+bool HardwareCounters::Scope::Stop(Values* values) {
+  if (std::this_thread::get_id() != thread_) {
+    return false;
+  }
+  bool counted = false;
+  values->fill(0);
+  std::fill(values->begin(), values->begin() + kKernels, std::numeric_limits<double>::quiet_NaN());
+#if defined(__linux__)
+  std::array<uint64_t, kKernels> cpu_stop;
+  const PerfEventGroup* group = cpu_ ? PerfEventGroup::Get() : nullptr;
+  if (group && group->Read(&cpu_stop)) {
+    for (int i = 0; i < kKernels; ++i) {
+      (*values)[i] = group->Counts(i) ? static_cast<double>(cpu_stop[i] - cpu_start_[i]) :
+                                        std::numeric_limits<double>::quiet_NaN();
+    }
+    counted = true;
+  }
+#endif
+#if MXNET_USE_CUDA && MXNET_USE_CUPTI
+  if (kernels_id_ != 0) {
+    KernelActivity* activity = KernelActivity::Get();
+    activity->Pop();
+    activity->Take(kernels_id_, values);
+    counted = true;
+  }
+#endif
+  return counted;
+}
+
+}  // namespace profiler
+}  // namespace mxnet
@@ -0,0 +1,85 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file hw_counters.h
+ * \brief per-operator hardware counters: perf_event groups on the CPU thread running an
+ *  operator, CUPTI kernel activity for the GPU kernels it launches
+ */
+#ifndef MXNET_PROFILER_HW_COUNTERS_H_
+#define MXNET_PROFILER_HW_COUNTERS_H_
+
+#include <mxnet/base.h>
+#include <array>
+#include <cstdint>
+#include <thread>
+
+namespace mxnet {
+namespace profiler {
+
+class HardwareCounters {
+ public:
+  enum Counter {
+    /*! \brief CPU cycles of the thread running the operator */
+    kCycles,
+    /*! \brief instructions retired */
+    kInstructions,
+    /*! \brief last level cache misses */
+    kLLCMisses,
+    /*! \brief floating point instructions, counted by the raw event MXNET_PROFILER_FP_EVENT */
+    kFPInstructions,
+    /*! \brief GPU kernels launched */
+    kKernels,
+    /*! \brief time the kernels ran on the GPU, in ns */
+    kKernelTime,
+    /*! \brief theoretical occupancy of the kernels weighted by their time, in ns */
+    kOccupancyTime,
+    kNumCounters
+  };
+  using Values = std::array<double, kNumCounters>;
+
+  /*!
+   * \brief Counts the events of one operator execution, from its construction to Stop on the
+   *  same thread. The counts of the CPU thread cover the operator function only, not the
+   *  OpenMP threads it forks; the GPU kernels are attributed through a CUPTI external
+   *  correlation id, and Stop waits for them to complete.
+   */
+  class Scope {
+   public:
+    explicit Scope(Context::DeviceType dev_type);
+    /*!
+     * \brief Stop counting
+     * \param values the counts, only set if true is returned
+     * \return false if nothing was counted, e.g. the operator completed on another thread or
+     *  the counters are not available
+     */
+    bool Stop(Values* values);
+
+   private:
+    std::thread::id thread_;
+    bool cpu_ = false;
+    std::array<uint64_t, kKernels> cpu_start_{};
+    /*! \brief CUPTI external correlation id of the kernels, 0 if they are not counted */
+    uint64_t kernels_id_ = 0;
+  };
+};
+
+}  // namespace profiler
+}  // namespace mxnet
+#endif  // MXNET_PROFILER_HW_COUNTERS_H_
@@ -0,0 +1,148 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file metrics.cc
+ * \brief implements the metrics registry and its OpenMetrics output
+ */
+#include <iomanip>
+#include "./metrics.h"
+
+namespace mxnet {
+namespace profiler {
+
+namespace {
+
+/*! \brief the labels of a series as written after the metric name, empty if there are none */
+std::string FormatLabels(const MetricLabels& labels) {
+  if (labels.empty()) {
+    return std::string();
+  }
+  std::string out = "{";
+  for (size_t i = 0; i < labels.size(); ++i) {
+    if (i)
+      out += ',';
+    out += labels[i].first;
+    out += "=\"";
+    for (const char c : labels[i].second) {
+      if (c == '\\' || c == '"') {
+        out += '\\';
+        out += c;
+      } else if (c == '\n') {
+        out += "\\n";
+      } else {
+        out += c;
+      }
+    }
+    out += '"';
+  }
+  out += '}';
+  return out;
+}
+
+ProfileDomain* MetricsDomain() {
+  static ProfileDomain domain("Metrics");
+  return &domain;
+}
+
+}  // namespace
+
+void MetricsWriter::Add(const std::string& name,
+                        const char* type,
+                        const std::string& help,
+                        const MetricLabels& labels,
+                        double value) {
+  Family& family = families_[name];
+  if (family.type_.empty()) {
+    family.type_ = type;
+    family.help_ = help;
+  } else {
+    CHECK_EQ(family.type_, type) << "Metric " << name << " is reported with two types";
+  }
+  // counter samples carry the _total suffix, the family does not
+  const std::string sample = family.type_ == "counter" ? name + "_total" : name;
+  family.samples_.emplace_back(sample + FormatLabels(labels), value);
+}
+
+MetricCounter::MetricCounter(std::string name, std::string help, const MetricLabels& labels)
+    : name_(std::move(name)), help_(std::move(help)), labels_(labels) {
+  const std::string series = name_ + FormatLabels(labels_);
+  profile_counter_         = std::make_unique<ProfileCounter>(series.c_str(), MetricsDomain());
+}
+
+Metrics* Metrics::Get() {
+  // never destroyed, storage pools and engines unregister from it at exit
+  static Metrics* inst = new Metrics();
+  return inst;
+}
+
+MetricCounter* Metrics::GetCounter(const std::string& name,
+                                   const std::string& help,
+                                   const MetricLabels& labels) {
+  const std::string series = name + FormatLabels(labels);
+  std::lock_guard<std::mutex> lk(m_);
+  auto& counter = counters_[series];
+  if (!counter) {
+    counter = std::make_unique<MetricCounter>(name, help, labels);
+  }
+  return counter.get();
+}
+
+uint64_t Metrics::AddCollector(Collector collector) {
+  std::lock_guard<std::mutex> lk(m_);
+  const uint64_t id = next_collector_id_++;
+  collectors_.emplace(id, std::move(collector));
+  return id;
+}
+
+void Metrics::RemoveCollector(uint64_t id) {
+  std::lock_guard<std::mutex> lk(m_);
+  collectors_.erase(id);
+}
+
+void Metrics::WriteOpenMetrics(std::ostream& os) {
+  MetricsWriter writer;
+  {
+    std::lock_guard<std::mutex> lk(m_);
+    for (const auto& counter : counters_) {
+      const MetricCounter& c = *counter.second;
+      writer.Counter(c.name_, c.help_, c.labels_, static_cast<double>(c.value()));
+    }
+    for (const auto& collector : collectors_) {
+      collector.second(&writer);
+    }
+  }
+  std::ios state(nullptr);
+  state.copyfmt(os);
+  os << std::setprecision(17);
+  for (const auto& family : writer.families_) {
+    os << "# TYPE " << family.first << " " << family.second.type_ << "\n";
+    if (!family.second.help_.empty()) {
+      os << "# HELP " << family.first << " " << family.second.help_ << "\n";
+    }
+    for (const auto& sample : family.second.samples_) {
+      os << sample.first << " " << sample.second << "\n";
+    }
+  }
+  os << "# EOF\n";
+  os.copyfmt(state);
+}
+
+}  // namespace profiler
+}  // namespace mxnet
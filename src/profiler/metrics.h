@@ -0,0 +1,156 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file metrics.h
+ * \brief live operational metrics of the engine, storage, kvstore and data iterators
+ */
+#ifndef MXNET_PROFILER_METRICS_H_
+#define MXNET_PROFILER_METRICS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "./profiler.h"
+
+namespace mxnet {
+namespace profiler {
+
+/*! \brief label names and values of one series of a metric */
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+/*!
+ * \brief Receives the current values of the metrics owned by a collector
+ */
+class MetricsWriter {
+ public:
+  /*! \brief add a sample of a gauge, a value that can go up and down */
+  void Gauge(const std::string& name,
+             const std::string& help,
+             const MetricLabels& labels,
+             double value) {
+    Add(name, "gauge", help, labels, value);
+  }
+  /*! \brief add a sample of a counter, a total that only goes up */
+  void Counter(const std::string& name,
+               const std::string& help,
+               const MetricLabels& labels,
+               double value) {
+    Add(name, "counter", help, labels, value);
+  }
+
+ private:
+  friend class Metrics;
+  struct Family {
+    std::string type_;
+    std::string help_;
+    std::vector<std::pair<std::string, double>> samples_;
+  };
+
+  void Add(const std::string& name,
+           const char* type,
+           const std::string& help,
+           const MetricLabels& labels,
+           double value);
+
+  /*! \brief families by name, so that the output is grouped and sorted */
+  std::map<std::string, Family> families_;
+};
+
+/*!
+ * \brief Counter that is always updated, unlike ProfileCounter which records an event per
+ *  update. While the profiler runs, each update is forwarded to a ProfileCounter as well,
+ *  so the counter also shows up in the trace.
+ */
+class MetricCounter {
+ public:
+  MetricCounter(std::string name, std::string help, const MetricLabels& labels);
+
+  /*! \brief add v to the counter */
+  void Add(uint64_t v) {
+    const uint64_t value = value_.fetch_add(v, std::memory_order_relaxed) + v;
+    if (Profiler::Get()->GetState() == Profiler::kRunning) {
+      *profile_counter_ = value;
+    }
+  }
+  uint64_t value() const {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  friend class Metrics;
+  const std::string name_;
+  const std::string help_;
+  const MetricLabels labels_;
+  std::atomic<uint64_t> value_{0};
+  std::unique_ptr<ProfileCounter> profile_counter_;
+};
+
+/*!
+ * \brief Registry of the live metrics of the process. Push metrics are MetricCounters updated
+ *  where the events happen. Pull metrics are read by collectors, functions registered by the
+ *  owners of the values (engine queues, storage pools) that are only called for a snapshot.
+ *
+ *  The snapshot is written in the OpenMetrics text format, see MXGetMetrics.
+ */
+class Metrics {
+ public:
+  using Collector = std::function<void(MetricsWriter*)>;
+
+  /*! \brief Get the metrics singleton */
+  static Metrics* Get();
+
+  /*!
+   * \brief get or create the counter of a series, the pointer stays valid for the whole
+   *  lifetime of the process
+   */
+  MetricCounter* GetCounter(const std::string& name,
+                            const std::string& help,
+                            const MetricLabels& labels = MetricLabels());
+
+  /*!
+   * \brief register a collector
+   * \return id to remove it with, before anything it reads is destroyed
+   */
+  uint64_t AddCollector(Collector collector);
+  void RemoveCollector(uint64_t id);
+
+  /*! \brief write the current value of every metric in the OpenMetrics text format */
+  void WriteOpenMetrics(std::ostream& os);
+
+ private:
+  Metrics() = default;
+
+  /*! \brief guards counters_ and collectors_, collectors run under it */
+  std::mutex m_;
+  std::map<std::string, std::unique_ptr<MetricCounter>> counters_;
+  std::map<uint64_t, Collector> collectors_;
+  uint64_t next_collector_id_ = 0;
+};
+
+}  // namespace profiler
+}  // namespace mxnet
+#endif  // MXNET_PROFILER_METRICS_H_
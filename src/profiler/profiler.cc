@@ -127,11 +127,15 @@ void Profiler::SetConfig(int mode,
                          std::string output_filename,
                          bool continuous_dump,
                          float dump_period,
-                         bool aggregate_stats) {
+                         bool aggregate_stats,
+                         bool dependencies,
+                         bool hw_counters) {
   CHECK(!continuous_dump || dump_period > 0);
   std::lock_guard<std::recursive_mutex> lock{this->m_};
-  this->mode_     = mode;
-  this->filename_ = output_filename;
+  this->mode_         = mode;
+  this->filename_     = output_filename;
+  this->dependencies_ = dependencies;
+  this->hw_counters_  = hw_counters;
   // Remove the output file to start
   if (!this->filename_.empty()) {
     ::unlink(this->filename_.c_str());
@@ -32,8 +32,10 @@
 #include <mutex>
 #include <memory>
 #include <array>
+#include <utility>
 #include "./vtune.h"
 #include "./aggregate_stats.h"
+#include "./hw_counters.h"
 #include "../common/cuda/nvtx.h"
 #include "../common/utils.h"
 
@@ -277,12 +279,17 @@ class Profiler {
    * \param output_filename profile output file name
    * \param continuous_dump true if profile information should be periodically dumped
    * \param dump_period Period (in seconds) of profile info dumping
+   * \param aggregate_stats whether to maintain aggregate stats
+   * \param dependencies whether to record the variables each operator reads and writes
+   * \param hw_counters whether operators sample hardware counters into the aggregate stats
    */
   void SetConfig(int mode,
                  std::string output_filename,
                  bool continuous_dump,
                  float dump_period,
-                 bool aggregate_stats);
+                 bool aggregate_stats,
+                 bool dependencies = false,
+                 bool hw_counters  = false);
 
   /*! \return mode of profiler */
   inline int GetMode() const {
@@ -394,6 +401,22 @@ class Profiler {
     return aggregate_stats_.get() != nullptr;
   }
 
+  /*!
+   * \brief Whether the dependencies of the operators are recorded in the trace
+   * \return true if profiled operators record the variables they read and write
+   */
+  inline bool DependenciesEnabled() const {
+    return dependencies_;
+  }
+
+  /*!
+   * \brief Whether the operators sample hardware counters into the aggregate stats
+   * \return true if hardware counters are sampled
+   */
+  inline bool HardwareCountersEnabled() const {
+    return hw_counters_ && AggregateEnabled();
+  }
+
   /*!
    * \brief Whether aggregate stats are currently being recorded
    * \return true if aggregate stats are currently being recorded
@@ -481,6 +504,10 @@ class Profiler {
   /*! \brief Maintain in-memory aggregate stats for print output.
    *  \warning This has a negative performance impact */
   std::shared_ptr<AggregateStats> aggregate_stats_ = nullptr;
+  /*! \brief Whether profiled operators record their variable dependencies */
+  volatile bool dependencies_ = false;
+  /*! \brief Whether profiled operators sample hardware counters */
+  volatile bool hw_counters_ = false;
   /*! \brief Asynchronous operation thread lifecycle control object */
   std::shared_ptr<dmlc::ThreadGroup> thread_group_ = std::make_shared<dmlc::ThreadGroup>();
   /* !\brief pids */
@@ -1170,6 +1197,15 @@ struct ProfileOperator : public ProfileEvent {
     }
   };
 
+  /*!
+   * \brief Engine variables read and written by an operator, as (variable id, version) pairs.
+   *  The version of a read is the one it sees, the version of a write is the one it produces.
+   */
+  struct Dependencies {
+    std::vector<std::pair<uint64_t, size_t>> reads_;
+    std::vector<std::pair<uint64_t, size_t>> writes_;
+  };
+
   /*!
    * \brief Constructor
    * \param name Name of the operator
@@ -1200,6 +1236,9 @@ struct ProfileOperator : public ProfileEvent {
     if (profiling_) {
       ProfileEvent::start();
       as_task_.start();
+      if (Profiler::Get()->HardwareCountersEnabled()) {
+        hw_counters_ = std::make_unique<HardwareCounters::Scope>(dev_type);
+      }
     }
   }
   /*!
@@ -1207,10 +1246,38 @@ struct ProfileOperator : public ProfileEvent {
    */
   void stop() override {
     if (profiling_) {
+      if (hw_counters_) {
+        has_hw_values_ = hw_counters_->Stop(&hw_values_);
+        hw_counters_.reset();
+      }
       as_task_.stop();
       ProfileEvent::stop();
     }
   }
+  /*!
+   * \brief Record the variable dependencies of the operator in its trace event
+   * \param dependencies the dependencies, owned by the operator afterwards
+   */
+  void SetDependencies(Dependencies* dependencies) {
+    dependencies_.reset(dependencies);
+  }
+  /*!
+   * \brief Add work done by the operator, reported by its FOpCost
+   * \param flops floating point operations
+   * \param bytes bytes moved to and from memory
+   */
+  void AddCost(double flops, double bytes) {
+    flops_ += flops;
+    bytes_ += bytes;
+  }
+  /*!
+   * \brief The operator profiled by the calling thread, set by the engine while it runs the
+   *  operator function and only when aggregate statistics are collected
+   */
+  static ProfileOperator*& Current() {
+    static thread_local ProfileOperator* current = nullptr;
+    return current;
+  }
 
   /*!
    * \brief Operation execution statistics
@@ -1229,10 +1296,14 @@ struct ProfileOperator : public ProfileEvent {
                        uint32_t dev_id,
                        uint64_t start_time,
                        uint64_t stop_time,
-                       const Attributes* attributes)
+                       const Attributes* attributes,
+                       const Dependencies* dependencies = nullptr)
         : DurationStat(ProfileStat::kDurationBegin, ProfileStat::kDurationEnd),
           dev_type_(dev_type),
           dev_id_(dev_id) {
+      if (dependencies) {
+        dependencies_ = std::make_unique<Dependencies>(*dependencies);
+      }
       name_.set(name);
       if (attributes) {
         name_.append(attributes->to_string().c_str());
@@ -1245,10 +1316,60 @@ struct ProfileOperator : public ProfileEvent {
       items_[kStart].timestamp_ = start_time;
       items_[kStop].timestamp_  = stop_time;
     }
+    /*!
+     * \brief Emit the dependencies as arguments of the begin event
+     * \param os Output stream to write data to
+     * \param idx Sub-even index (index into items_) to write
+     */
+    void EmitExtra(std::ostream* os, size_t idx) override {
+      DurationStat::EmitExtra(os, idx);
+      if (idx == kStart && dependencies_) {
+        *os << "        \"args\": { \"reads\": ";
+        EmitVars(os, dependencies_->reads_);
+        *os << ", \"writes\": ";
+        EmitVars(os, dependencies_->writes_);
+        *os << " },\n";
+      }
+    }
     /*! \brief device type: CPU: 1, GPU: 2, CPUPinned: 3 */
     mxnet::Context::DeviceType dev_type_;
     /*! \brief device id */
     uint32_t dev_id_;
+    /*! \brief Optional variable dependencies */
+    std::unique_ptr<Dependencies> dependencies_;
+    /*! \brief floating point operations done, 0 if the operator reports no cost */
+    double flops_ = 0;
+    /*! \brief bytes moved to and from memory */
+    double bytes_ = 0;
+    /*! \brief hardware counters of the execution, if it sampled them */
+    bool has_hw_values_ = false;
+    HardwareCounters::Values hw_values_{};
+
+    void SaveAggregate(AggregateStats::StatData* data) const override {
+      DurationStat::SaveAggregate(data);
+      if (data && (flops_ > 0 || bytes_ > 0)) {
+        data->total_flops_ += flops_;
+        data->total_bytes_ += bytes_;
+        data->cost_aggregate_ += items_[kStop].timestamp_ - items_[kStart].timestamp_;
+        data->dev_type_ = dev_type_;
+      }
+      if (data && has_hw_values_) {
+        for (size_t i = 0; i < hw_values_.size(); ++i) {
+          data->hw_counters_[i] += hw_values_[i];
+        }
+        data->hw_count_ += 1;
+        data->hw_aggregate_ += items_[kStop].timestamp_ - items_[kStart].timestamp_;
+      }
+    }
+
+   private:
+    static void EmitVars(std::ostream* os, const std::vector<std::pair<uint64_t, size_t>>& vars) {
+      *os << "[";
+      for (size_t i = 0; i < vars.size(); ++i) {
+        *os << (i ? ", [" : "[") << vars[i].first << ", " << vars[i].second << "]";
+      }
+      *os << "]";
+    }
   };
 
  private:
@@ -1256,13 +1377,20 @@ struct ProfileOperator : public ProfileEvent {
    * \brief Send this object's statistical datapoint to the profiler
    */
   void SendStat() override {
-    Profiler::Get()->AddNewProfileStat<OprExecStat>([](OprExecStat* stat) {},
+    Profiler::Get()->AddNewProfileStat<OprExecStat>(
+        [this](OprExecStat* stat) {
+          stat->flops_         = flops_;
+          stat->bytes_         = bytes_;
+          stat->has_hw_values_ = has_hw_values_;
+          stat->hw_values_     = hw_values_;
+        },
                                                     name_.c_str(),
                                                     dev_type_,
                                                     dev_id_,
                                                     start_time_,
                                                     ProfileStat::NowInMicrosec(),
-                                                    attributes_.get());
+                                                    attributes_.get(),
+                                                    dependencies_.get());
   }
   /*!
    * \brief Check if this operator is no longer profiled
@@ -1290,6 +1418,15 @@ struct ProfileOperator : public ProfileEvent {
   static ProfileDomain domain_;
   /*! \brief Optional operator attributes */
   std::unique_ptr<Attributes> attributes_;
+  /*! \brief Optional variable dependencies */
+  std::unique_ptr<Dependencies> dependencies_;
+  /*! \brief work reported by the operator */
+  double flops_ = 0;
+  double bytes_ = 0;
+  /*! \brief hardware counters of the running execution */
+  std::unique_ptr<HardwareCounters::Scope> hw_counters_;
+  bool has_hw_values_ = false;
+  HardwareCounters::Values hw_values_{};
   /*! \brief Whether to profile or not */
   const bool profiling_;
 };
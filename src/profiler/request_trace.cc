@@ -0,0 +1,262 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file request_trace.cc
+ * \brief implements the request tracer and its OTLP/JSON output
+ */
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include "./request_trace.h"
+
+namespace mxnet {
+namespace profiler {
+
+namespace {
+
+inline uint64_t SplitMix64(uint64_t x) {
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+/*! \brief ids seeded by the start time of the process, so that two processes differ */
+uint64_t NextRandom() {
+  static std::atomic<uint64_t> state{RequestTrace::NowInNanosec()};
+  uint64_t id;
+  do {
+    id = SplitMix64(state.fetch_add(0x9E3779B97F4A7C15ULL, std::memory_order_relaxed));
+  } while (id == 0);
+  return id;
+}
+
+std::string Hex(uint64_t value) {
+  char buf[17];
+  snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(value));  // NOLINT(*)
+  return buf;
+}
+
+uint64_t ParseHex(const std::string& hex) {
+  uint64_t value = 0;
+  for (const char c : hex) {
+    int digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      digit = c - 'A' + 10;
+    } else {
+      LOG(FATAL) << "Invalid trace id " << hex << ", expected hex digits";
+      return 0;
+    }
+    value = value << 4 | digit;
+  }
+  return value;
+}
+
+std::string Escape(const std::string& s) {
+  std::string out;
+  out.reserve(s.size());
+  for (const char c : s) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buf[7];
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      out += buf;
+    } else {
+      out += c;
+    }
+  }
+  return out;
+}
+
+void WriteIntAttribute(std::ostream& os, const char* key, uint64_t value, bool first = false) {
+  os << (first ? "" : ", ") << "{\"key\": \"" << key << "\", \"value\": {\"intValue\": \""
+     << value << "\"}}";
+}
+
+}  // namespace
+
+RequestTrace::RequestTrace(std::string name, uint64_t trace_id_high, uint64_t trace_id_low)
+    : name_(std::move(name)),
+      trace_id_high_(trace_id_high),
+      trace_id_low_(trace_id_low),
+      root_span_id_(NewSpanId()),
+      start_(NowInNanosec()) {}
+
+uint64_t RequestTrace::NewSpanId() {
+  return NextRandom();
+}
+
+void RequestTrace::AddSpan(Span span) {
+  std::lock_guard<std::mutex> lk(m_);
+  spans_.push_back(std::move(span));
+}
+
+std::shared_ptr<RequestTrace>& RequestTrace::Current() {
+  static thread_local std::shared_ptr<RequestTrace> trace;
+  return trace;
+}
+
+uint64_t& RequestTrace::CurrentSpan() {
+  static thread_local uint64_t span = 0;
+  return span;
+}
+
+RequestTrace::Scope::Scope(const char* name, SpanKind kind)
+    : trace_(name != nullptr ? Current() : nullptr), name_(name), kind_(kind) {
+  if (trace_ == nullptr) {
+    return;
+  }
+  span_id_       = NewSpanId();
+  parent_id_     = CurrentSpan();
+  CurrentSpan()  = span_id_;
+  start_         = NowInNanosec();
+}
+
+RequestTrace::Scope::~Scope() {
+  if (trace_ == nullptr) {
+    return;
+  }
+  CurrentSpan() = parent_id_;
+  Span span;
+  span.name_      = name_;
+  span.kind_      = kind_;
+  span.span_id_   = span_id_;
+  span.parent_id_ = parent_id_;
+  span.start_     = start_;
+  span.end_       = NowInNanosec();
+  trace_->AddSpan(std::move(span));
+}
+
+RequestTracer* RequestTracer::Get() {
+  // never destroyed, engine threads may still add spans while static objects go away at exit
+  static RequestTracer* inst = new RequestTracer();
+  return inst;
+}
+
+RequestTracer::RequestTracer()
+    : capacity_(std::max(1, dmlc::GetEnv("MXNET_REQUEST_TRACE_BUFFER", 1024))) {}
+
+void RequestTracer::Begin(const std::string& name, const std::string& trace_id) {
+  std::shared_ptr<RequestTrace>& current = RequestTrace::Current();
+  CHECK(current == nullptr) << "Request " << current->name_
+                            << " is still set on this thread, end it first";
+  uint64_t high, low;
+  if (trace_id.empty()) {
+    high = NextRandom();
+    low  = NextRandom();
+  } else {
+    CHECK_EQ(trace_id.size(), 32U) << "Invalid trace id " << trace_id
+                                   << ", expected 32 hex digits";
+    high = ParseHex(trace_id.substr(0, 16));
+    low  = ParseHex(trace_id.substr(16));
+  }
+  current                     = std::make_shared<RequestTrace>(name, high, low);
+  RequestTrace::CurrentSpan() = current->root_span_id_;
+}
+
+void RequestTracer::End() {
+  std::shared_ptr<RequestTrace> trace = std::move(RequestTrace::Current());
+  RequestTrace::Current()             = nullptr;
+  RequestTrace::CurrentSpan()         = 0;
+  if (trace == nullptr) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lk(trace->m_);
+    trace->end_ = RequestTrace::NowInNanosec();
+  }
+  std::lock_guard<std::mutex> lk(m_);
+  finished_.push_back(std::move(trace));
+  while (finished_.size() > capacity_) {
+    finished_.pop_front();
+  }
+}
+
+void RequestTracer::DumpJson(std::ostream& os, bool reset) {
+  std::deque<std::shared_ptr<RequestTrace>> traces;
+  {
+    std::lock_guard<std::mutex> lk(m_);
+    if (reset) {
+      traces.swap(finished_);
+    } else {
+      traces = finished_;
+    }
+  }
+  os << "{\"resourceSpans\": [{\"resource\": {\"attributes\": [{\"key\": \"service.name\", "
+     << "\"value\": {\"stringValue\": \"mxnet\"}}]}, \"scopeSpans\": [{\"scope\": {\"name\": "
+     << "\"mxnet.request_trace\"}, \"spans\": [";
+  bool first_span = true;
+  for (const auto& trace : traces) {
+    std::lock_guard<std::mutex> lk(trace->m_);
+    const std::string trace_id = Hex(trace->trace_id_high_) + Hex(trace->trace_id_low_);
+    // the root span sums up where the time of the request went
+    uint64_t totals[4] = {0, 0, 0, 0};
+    uint64_t queue = 0, dispatch = 0, num_operators = 0;
+    for (const auto& span : trace->spans_) {
+      totals[span.kind_] += span.end_ - span.start_;
+      if (span.kind_ == RequestTrace::kOperator) {
+        queue += span.queue_;
+        dispatch += span.dispatch_;
+        ++num_operators;
+      }
+    }
+    auto write_span = [&](const std::string& name,
+                          uint64_t span_id,
+                          uint64_t parent_id,
+                          uint64_t start,
+                          uint64_t end) {
+      os << (first_span ? "" : ", ") << "{\"traceId\": \"" << trace_id << "\", \"spanId\": \""
+         << Hex(span_id) << "\", \"parentSpanId\": \"" << (parent_id ? Hex(parent_id) : "")
+         << "\", \"name\": \"" << Escape(name) << "\", \"kind\": 1, \"startTimeUnixNano\": \""
+         << start << "\", \"endTimeUnixNano\": \"" << end << "\", \"attributes\": [";
+      first_span = false;
+    };
+    write_span(trace->name_, trace->root_span_id_, 0, trace->start_, trace->end_);
+    WriteIntAttribute(os, "mxnet.host_ns", totals[RequestTrace::kHost], true);
+    WriteIntAttribute(os, "mxnet.queue_ns", queue);
+    WriteIntAttribute(os, "mxnet.dispatch_ns", dispatch);
+    WriteIntAttribute(os, "mxnet.compute_ns", totals[RequestTrace::kOperator]);
+    WriteIntAttribute(os, "mxnet.sync_ns", totals[RequestTrace::kSync]);
+    WriteIntAttribute(os, "mxnet.operators", num_operators);
+    os << "]}";
+    for (const auto& span : trace->spans_) {
+      write_span(span.name_, span.span_id_, span.parent_id_, span.start_, span.end_);
+      if (span.kind_ == RequestTrace::kOperator) {
+        os << "{\"key\": \"mxnet.device\", \"value\": {\"stringValue\": \"" << span.device_
+           << "\"}}";
+        WriteIntAttribute(os, "mxnet.queue_ns", span.queue_);
+        WriteIntAttribute(os, "mxnet.dispatch_ns", span.dispatch_);
+      }
+      os << "]}";
+    }
+  }
+  os << "]}]}]}" << std::endl;
+}
+
+}  // namespace profiler
+}  // namespace mxnet
@@ -0,0 +1,154 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file request_trace.h
+ * \brief request-scoped latency tracing, exported as OpenTelemetry spans
+ */
+#ifndef MXNET_PROFILER_REQUEST_TRACE_H_
+#define MXNET_PROFILER_REQUEST_TRACE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mxnet {
+namespace profiler {
+
+/*!
+ * \brief Trace of one request, such as one inference call of a server. The request is set on
+ *  the calling thread by RequestTracer::Begin; the operators pushed to the engine while it is
+ *  set keep a reference to it and add their spans when they complete, on whatever thread.
+ *
+ *  Independent of the Profiler: nothing is recorded for threads with no request set.
+ */
+class RequestTrace {
+ public:
+  /*! \brief span kinds, they sum up the latency of the request in the exported attributes */
+  enum SpanKind { kRequest, kHost, kOperator, kSync };
+
+  /*! \brief a finished span, times in nanoseconds since the unix epoch */
+  struct Span {
+    std::string name_;
+    SpanKind kind_;
+    uint64_t span_id_;
+    uint64_t parent_id_;
+    uint64_t start_;
+    uint64_t end_;
+    /*! \brief for operators, time waiting for the dependencies and for a worker */
+    uint64_t queue_ = 0;
+    uint64_t dispatch_ = 0;
+    /*! \brief for operators, the device it ran on */
+    std::string device_;
+  };
+
+  RequestTrace(std::string name, uint64_t trace_id_high, uint64_t trace_id_low);
+
+  /*! \brief wall clock time in nanoseconds since the unix epoch */
+  static inline uint64_t NowInNanosec() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+  }
+
+  /*! \brief a new span id, unique within the process */
+  static uint64_t NewSpanId();
+
+  void AddSpan(Span span);
+
+  /*! \brief trace of the request set on the calling thread, null if there is none */
+  static std::shared_ptr<RequestTrace>& Current();
+  /*! \brief the innermost open span of the calling thread, the parent of new spans */
+  static uint64_t& CurrentSpan();
+
+  /*!
+   * \brief RAII span on the calling thread, spans started while it is open are its
+   *  children. Does nothing when no request is set or the name is null.
+   */
+  class Scope {
+   public:
+    Scope(const char* name, SpanKind kind);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    std::shared_ptr<RequestTrace> trace_;
+    const char* name_;
+    SpanKind kind_;
+    uint64_t span_id_;
+    uint64_t parent_id_;
+    uint64_t start_;
+  };
+
+ private:
+  friend class RequestTracer;
+
+  const std::string name_;
+  const uint64_t trace_id_high_;
+  const uint64_t trace_id_low_;
+  /*! \brief id of the root span, parent of the spans with no other open span */
+  const uint64_t root_span_id_;
+  const uint64_t start_;
+  uint64_t end_ = 0;
+  /*! \brief guards spans_ and end_, spans are added by the engine workers */
+  std::mutex m_;
+  std::vector<Span> spans_;
+};
+
+/*!
+ * \brief Keeps the last finished request traces, at most MXNET_REQUEST_TRACE_BUFFER of them,
+ *  and writes them in the OTLP/JSON format of OpenTelemetry.
+ */
+class RequestTracer {
+ public:
+  static RequestTracer* Get();
+
+  /*!
+   * \brief set a request on the calling thread
+   * \param name name of the root span
+   * \param trace_id 32 hex digits to join the trace of a caller, empty for a new trace id
+   */
+  void Begin(const std::string& name, const std::string& trace_id);
+  /*! \brief end the request of the calling thread */
+  void End();
+
+  /*!
+   * \brief write the finished requests as an OTLP/JSON ExportTraceServiceRequest
+   * \param reset whether to drop the written requests
+   */
+  void DumpJson(std::ostream& os, bool reset);
+
+ private:
+  RequestTracer();
+
+  size_t capacity_;
+  std::mutex m_;
+  std::deque<std::shared_ptr<RequestTrace>> finished_;
+};
+
+}  // namespace profiler
+}  // namespace mxnet
+#endif  // MXNET_PROFILER_REQUEST_TRACE_H_
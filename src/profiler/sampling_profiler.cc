@@ -0,0 +1,197 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sampling_profiler.cc
+ * \brief implements the sampling profiler
+ */
+#include <dmlc/parameter.h>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <utility>
+#include "./sampling_profiler.h"
+
+namespace mxnet {
+namespace profiler {
+
+namespace {
+
+inline int BucketIndex(uint64_t value) {
+  if (value < LatencyHistogram::kSubBuckets) {
+    return static_cast<int>(value);
+  }
+  int exponent = 3;
+  while (exponent < 63 && (value >> (exponent + 1)) != 0) {
+    ++exponent;
+  }
+  const int sub = static_cast<int>((value >> (exponent - 3)) & (LatencyHistogram::kSubBuckets - 1));
+  return (exponent - 2) * LatencyHistogram::kSubBuckets + sub;
+}
+
+inline uint64_t BucketUpperBound(int index) {
+  if (index < LatencyHistogram::kSubBuckets) {
+    return index;
+  }
+  const int exponent = index / LatencyHistogram::kSubBuckets + 2;
+  const uint64_t sub = index % LatencyHistogram::kSubBuckets;
+  return ((LatencyHistogram::kSubBuckets + sub + 1) << (exponent - 3)) - 1;
+}
+
+inline double MicroToMilli(uint64_t micro) {
+  return static_cast<double>(micro) / 1000.0;
+}
+
+}  // namespace
+
+void LatencyHistogram::Add(uint64_t value) {
+  ++count_;
+  total_ += value;
+  min_ = std::min(min_, value);
+  max_ = std::max(max_, value);
+  ++buckets_[BucketIndex(value)];
+}
+
+uint64_t LatencyHistogram::Quantile(double q) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  const uint64_t target =
+      std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count_))));
+  uint64_t seen = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    seen += buckets_[i];
+    if (seen >= target) {
+      return std::min(BucketUpperBound(i), max_);
+    }
+  }
+  return max_;
+}
+
+SamplingProfiler* SamplingProfiler::Get() {
+  // never destroyed, engine threads may still record while static objects go away at exit
+  static SamplingProfiler* inst = new SamplingProfiler();
+  return inst;
+}
+
+SamplingProfiler::SamplingProfiler()
+    : ring_size_(std::max(1, dmlc::GetEnv("MXNET_PROFILER_SAMPLE_RING_SIZE", 1024))) {
+  sample_rate_.store(std::max(0, dmlc::GetEnv("MXNET_PROFILER_SAMPLE_RATE", 0)));
+}
+
+SamplingProfiler::Ring* SamplingProfiler::LocalRing() {
+  static thread_local std::shared_ptr<Ring> ring;
+  if (!ring) {
+    ring = std::make_shared<Ring>(ring_size_);
+    std::lock_guard<std::mutex> lk(m_);
+    rings_.push_back(ring);
+  }
+  return ring.get();
+}
+
+void SamplingProfiler::Record(const std::string& name, uint64_t start_time, uint64_t stop_time) {
+  Ring* ring        = LocalRing();
+  const size_t size = ring->samples_.size();
+  const size_t head = ring->head_.load(std::memory_order_relaxed);
+  const size_t used = head - ring->tail_.load(std::memory_order_acquire);
+  if (used >= size) {
+    ring->dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  Sample& sample = ring->samples_[head % size];
+  sample.name_.set(name.c_str());
+  sample.duration_ = stop_time > start_time ? stop_time - start_time : 0;
+  ring->head_.store(head + 1, std::memory_order_release);
+  // aggregate once the ring is half full, unless a reader is draining it already
+  if (2 * (used + 1) >= size) {
+    std::unique_lock<std::mutex> lk(m_, std::try_to_lock);
+    if (lk.owns_lock()) {
+      Drain();
+    }
+  }
+}
+
+void SamplingProfiler::Drain() {
+  for (auto it = rings_.begin(); it != rings_.end();) {
+    Ring* ring        = it->get();
+    const size_t size = ring->samples_.size();
+    const size_t head = ring->head_.load(std::memory_order_acquire);
+    size_t tail       = ring->tail_.load(std::memory_order_relaxed);
+    for (; tail != head; ++tail) {
+      const Sample& sample = ring->samples_[tail % size];
+      stats_[sample.name_.c_str()].Add(sample.duration_);
+    }
+    ring->tail_.store(tail, std::memory_order_release);
+    dropped_ += ring->dropped_.exchange(0, std::memory_order_relaxed);
+    // nobody else holds the ring once its thread has exited
+    if (it->use_count() == 1) {
+      it = rings_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void SamplingProfiler::DumpJson(std::ostream& os, bool reset) {
+  std::ios state(nullptr);
+  state.copyfmt(os);
+  std::lock_guard<std::mutex> lk(m_);
+  Drain();
+  std::vector<std::pair<std::string, const LatencyHistogram*>> sorted;
+  sorted.reserve(stats_.size());
+  for (const auto& stat : stats_) {
+    sorted.emplace_back(stat.first, &stat.second);
+  }
+  std::sort(sorted.begin(), sorted.end());
+  os << "{" << std::endl
+     << "    \"Sample Rate\": " << GetSampleRate() << "," << std::endl
+     << "    \"Dropped\": " << dropped_ << "," << std::endl
+     << "    \"Time\": {" << std::endl
+     << "        \"operator\": {" << std::endl;
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    const LatencyHistogram& data = *sorted[i].second;
+    if (i)
+      os << "            ," << std::endl;
+    os << "            \"" << sorted[i].first << "\": {" << std::endl
+       << "                \"Count\": " << data.count_ << "," << std::endl
+       << std::fixed << std::setprecision(4)
+       << "                \"Total\": " << MicroToMilli(data.total_) << "," << std::endl
+       << "                \"Min\": " << MicroToMilli(data.min_) << "," << std::endl
+       << "                \"Max\": " << MicroToMilli(data.max_) << "," << std::endl
+       << "                \"Avg\": " << MicroToMilli(data.total_) / data.count_ << ","
+       << std::endl
+       << "                \"P50\": " << MicroToMilli(data.Quantile(0.5)) << "," << std::endl
+       << "                \"P90\": " << MicroToMilli(data.Quantile(0.9)) << "," << std::endl
+       << "                \"P99\": " << MicroToMilli(data.Quantile(0.99)) << std::endl
+       << "            }" << std::endl;
+  }
+  os << "        }" << std::endl << "    }," << std::endl
+     << "    \"Unit\": {" << std::endl
+     << "        \"Time\": \"ms\"" << std::endl
+     << "    }" << std::endl
+     << "}" << std::endl;
+  os.copyfmt(state);
+  if (reset) {
+    stats_.clear();
+    dropped_ = 0;
+  }
+}
+
+}  // namespace profiler
+}  // namespace mxnet
@@ -0,0 +1,143 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sampling_profiler.h
+ * \brief low-overhead operator latency sampling that can stay enabled in production
+ */
+#ifndef MXNET_PROFILER_SAMPLING_PROFILER_H_
+#define MXNET_PROFILER_SAMPLING_PROFILER_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "./profiler.h"
+
+namespace mxnet {
+namespace profiler {
+
+/*!
+ * \brief Latency histogram of one operator with buckets of about 12% relative width,
+ *  exact below 8 microseconds
+ */
+struct LatencyHistogram {
+  static constexpr int kSubBuckets = 8;
+  static constexpr int kNumBuckets = (64 - 2) * kSubBuckets;
+
+  void Add(uint64_t value);
+  /*! \brief upper bound of the bucket holding the q-quantile of the samples */
+  uint64_t Quantile(double q) const;
+
+  uint64_t count_ = 0;
+  uint64_t total_ = 0;
+  uint64_t min_   = UINT64_MAX;
+  uint64_t max_   = 0;
+  std::array<uint64_t, kNumBuckets> buckets_{};
+};
+
+/*!
+ * \brief Samples one in N operator executions of each thread of the engine. The duration of a
+ *  sample goes to a fixed-size ring buffer of the thread that completes the operator, with no
+ *  lock or allocation. The rings are drained into per-operator histograms when they fill up
+ *  and whenever the statistics are read, so memory stays bounded however long it runs.
+ *
+ *  Enabled by MXNET_PROFILER_SAMPLE_RATE or SetSampleRate(), independent of the Profiler state.
+ */
+class SamplingProfiler {
+ public:
+  /*! \brief Get the sampling profiler singleton */
+  static SamplingProfiler* Get();
+
+  /*! \brief set the rate N of one sample per N operator executions, 0 turns sampling off */
+  void SetSampleRate(uint32_t rate) {
+    sample_rate_.store(rate, std::memory_order_relaxed);
+  }
+  uint32_t GetSampleRate() const {
+    return sample_rate_.load(std::memory_order_relaxed);
+  }
+
+  /*! \brief whether the calling thread should time its next operator execution */
+  inline bool ShouldSample() {
+    const uint32_t rate = sample_rate_.load(std::memory_order_relaxed);
+    if (rate == 0) {
+      return false;
+    }
+    static thread_local uint32_t countdown = 0;
+    if (countdown == 0 || countdown > rate) {
+      countdown = rate;
+    }
+    return --countdown == 0;
+  }
+
+  /*!
+   * \brief record the execution of an operator
+   * \param name operator name
+   * \param start_time start timestamp in microseconds
+   * \param stop_time stop timestamp in microseconds
+   */
+  void Record(const std::string& name, uint64_t start_time, uint64_t stop_time);
+
+  /*!
+   * \brief write the per-operator statistics of the samples so far in json format
+   * \param reset whether to clear the statistics afterwards
+   */
+  void DumpJson(std::ostream& os, bool reset);
+
+ private:
+  struct Sample {
+    profile_stat_string name_;
+    uint64_t duration_;
+  };
+  /*! \brief single-producer single-consumer ring of the samples of one thread */
+  struct Ring {
+    explicit Ring(size_t size) : samples_(size) {}
+    std::vector<Sample> samples_;
+    /*! \brief written by the owning thread only */
+    std::atomic<size_t> head_{0};
+    /*! \brief written by the thread draining the ring under m_ only */
+    std::atomic<size_t> tail_{0};
+    /*! \brief samples lost because the ring was full */
+    std::atomic<uint64_t> dropped_{0};
+  };
+
+  SamplingProfiler();
+  /*! \brief the ring of the calling thread, registered on first use */
+  Ring* LocalRing();
+  /*! \brief move the samples of all rings into stats_, requires m_ */
+  void Drain();
+
+  std::atomic<uint32_t> sample_rate_{0};
+  /*! \brief number of samples each thread can hold between drains */
+  size_t ring_size_;
+  /*! \brief guards rings_, stats_ and dropped_ */
+  std::mutex m_;
+  std::vector<std::shared_ptr<Ring>> rings_;
+  std::unordered_map<std::string, LatencyHistogram> stats_;
+  uint64_t dropped_ = 0;
+};
+
+}  // namespace profiler
+}  // namespace mxnet
+#endif  // MXNET_PROFILER_SAMPLING_PROFILER_H_
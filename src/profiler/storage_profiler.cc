@@ -21,6 +21,7 @@
 #if MXNET_USE_NVML
 #include <nvml.h>
 #endif  // MXNET_USE_NVML
+#include <algorithm>
 #include <fstream>
 #include <map>
 #include <regex>
@@ -34,6 +35,181 @@
 namespace mxnet {
 namespace profiler {
 
+namespace {
+
+/*! \brief counter event with several series, stacked by the trace viewer */
+struct MemoryCounterStat : public ProfileStat {
+  explicit MemoryCounterStat(const char* name) {
+    items_[0].enabled_    = true;
+    items_[0].event_type_ = kCounter;
+    items_[0].timestamp_  = NowInMicrosec();
+    name_.set(name);
+    categories_.set("Memory Timeline");
+    enable_aggregate_ = false;
+  }
+
+  void EmitExtra(std::ostream* os, size_t idx) override {
+    ProfileStat::EmitExtra(os, idx);
+    *os << "        \"args\": { ";
+    for (size_t i = 0; i < series_.size(); ++i) {
+      *os << (i ? ", \"" : "\"") << series_[i].first << "\": " << series_[i].second;
+    }
+    *os << " },\n";
+  }
+
+  std::vector<std::pair<std::string, uint64_t>> series_;
+};
+
+inline std::string HolderName(const std::pair<std::string, bool>& key) {
+  return key.second ? key.first + " (planned)" : key.first;
+}
+
+}  // namespace
+
+MemoryTimeline* MemoryTimeline::Get() {
+  // never destroyed, storage may still be freed while static objects go away at exit
+  static MemoryTimeline* inst = new MemoryTimeline();
+  return inst;
+}
+
+void MemoryTimeline::OnAlloc(const Storage::Handle& handle, size_t cached) {
+  if (handle.size == 0 || handle.dptr == nullptr) {
+    return;
+  }
+  Profiler* prof            = Profiler::Get();
+  const size_t device       = prof->DeviceIndex(handle.ctx.dev_type, handle.ctx.dev_id);
+  const Attribution& source = Current();
+  HolderKey key(source.op_name ? source.op_name : "unattributed", source.planned);
+  std::lock_guard<std::mutex> lk(m_);
+  // an address freed while the timeline was off is still listed
+  auto it = live_.find(handle.dptr);
+  if (it != live_.end()) {
+    Release(it);
+  }
+  Device& dev              = devices_[device];
+  Holders::iterator holder = dev.holders.emplace(std::move(key), Holder()).first;
+  holder->second.bytes += handle.size;
+  ++holder->second.count;
+  live_[handle.dptr] = Allocation{device, handle.size, holder};
+  dev.in_use += handle.size;
+  dev.cached = cached;
+  if (dev.in_use > dev.peak) {
+    dev.peak         = dev.in_use;
+    dev.peak_cached  = dev.cached;
+    dev.peak_time    = ProfileStat::NowInMicrosec();
+    dev.peak_holders = dev.holders;
+  }
+  Emit(device, dev);
+}
+
+void MemoryTimeline::OnFree(const Storage::Handle& handle, size_t cached) {
+  if (handle.dptr == nullptr) {
+    return;
+  }
+  const size_t device = Profiler::Get()->DeviceIndex(handle.ctx.dev_type, handle.ctx.dev_id);
+  std::lock_guard<std::mutex> lk(m_);
+  auto it = live_.find(handle.dptr);
+  if (it != live_.end()) {
+    Release(it);
+  }
+  Device& dev = devices_[device];
+  dev.cached  = cached;
+  Emit(device, dev);
+}
+
+void MemoryTimeline::OnCached(const Context& ctx, size_t cached) {
+  const size_t device = Profiler::Get()->DeviceIndex(ctx.dev_type, ctx.dev_id);
+  std::lock_guard<std::mutex> lk(m_);
+  Device& dev = devices_[device];
+  dev.cached  = cached;
+  Emit(device, dev);
+}
+
+void MemoryTimeline::Release(std::unordered_map<void*, Allocation>::iterator it) {
+  const Allocation& alloc = it->second;
+  Device& dev             = devices_[alloc.device];
+  Holder& holder          = alloc.holder->second;
+  holder.bytes -= alloc.size;
+  --holder.count;
+  dev.in_use -= alloc.size;
+  // the holder stays, at 0, so that its series keeps going in the trace
+  live_.erase(it);
+}
+
+void MemoryTimeline::Emit(size_t device, const Device& dev) {
+  Profiler* prof           = Profiler::Get();
+  const std::string suffix = std::string(": ") + prof->DeviceName(device);
+  prof->AddNewProfileStat<MemoryCounterStat>(
+      [&dev](MemoryCounterStat* stat) {
+        stat->series_.reserve(dev.holders.size() + 1);
+        for (const auto& holder : dev.holders) {
+          stat->series_.emplace_back(HolderName(holder.first), holder.second.bytes);
+        }
+        stat->series_.emplace_back("pool cached", dev.cached);
+      },
+      ("Live Bytes by Operator" + suffix).c_str());
+  prof->AddNewProfileStat<MemoryCounterStat>(
+      [&dev](MemoryCounterStat* stat) {
+        uint64_t planned = 0;
+        for (const auto& holder : dev.holders) {
+          if (holder.first.second) {
+            planned += holder.second.bytes;
+          }
+        }
+        stat->series_ = {{"planned", planned},
+                         {"dynamic", dev.in_use - planned},
+                         {"pool cached", dev.cached}};
+      },
+      ("Live Bytes" + suffix).c_str());
+}
+
+void MemoryTimeline::DumpPeak(std::ostream& os, bool reset) {
+  Profiler* prof = Profiler::Get();
+  std::lock_guard<std::mutex> lk(m_);
+  os << "{" << std::endl << "    \"Peak\": {" << std::endl;
+  bool first_device = true;
+  for (auto& device : devices_) {
+    Device& dev = device.second;
+    std::vector<std::pair<HolderKey, Holder>> holders;
+    for (const auto& holder : dev.peak_holders) {
+      if (holder.second.bytes > 0) {
+        holders.emplace_back(holder);
+      }
+    }
+    std::sort(holders.begin(), holders.end(), [](const auto& a, const auto& b) {
+      return a.second.bytes > b.second.bytes;
+    });
+    if (!first_device)
+      os << "        ," << std::endl;
+    first_device = false;
+    os << "        \"" << prof->DeviceName(device.first) << "\": {" << std::endl
+       << "            \"Bytes\": " << dev.peak << "," << std::endl
+       << "            \"Cached\": " << dev.peak_cached << "," << std::endl
+       << "            \"Time\": " << dev.peak_time << "," << std::endl
+       << "            \"Holders\": [" << std::endl;
+    for (size_t i = 0; i < holders.size(); ++i) {
+      os << "                {\"Operator\": \"" << holders[i].first.first << "\", \"Kind\": \""
+         << (holders[i].first.second ? "planned" : "dynamic")
+         << "\", \"Bytes\": " << holders[i].second.bytes
+         << ", \"Count\": " << holders[i].second.count << "}"
+         << (i + 1 < holders.size() ? "," : "") << std::endl;
+    }
+    os << "            ]" << std::endl << "        }" << std::endl;
+    if (reset) {
+      dev.peak         = dev.in_use;
+      dev.peak_cached  = dev.cached;
+      dev.peak_time    = ProfileStat::NowInMicrosec();
+      dev.peak_holders = dev.holders;
+    }
+  }
+  os << "    }," << std::endl
+     << "    \"Unit\": {" << std::endl
+     << "        \"Bytes\": \"bytes\"," << std::endl
+     << "        \"Time\": \"us\"" << std::endl
+     << "    }" << std::endl
+     << "}" << std::endl;
+}
+
 #if MXNET_USE_CUDA
 
 GpuDeviceStorageProfiler* GpuDeviceStorageProfiler::Get() {
@@ -95,6 +271,7 @@ void GpuDeviceStorageProfiler::DumpProfile() const {
                                                             alloc_entry.second.reuse});
     gpu_dev_id_total_alloc_map[alloc_entry.second.dev_id] = 0;
   }
+  DumpPoolStats(current_pid);
   fout << "\"Attribute Name\",\"Requested Size\","
           "\"Device\",\"Actual Size\",\"Reuse?\""
        << std::endl;
@@ -148,6 +325,36 @@ void GpuDeviceStorageProfiler::DumpProfile() const {
 #endif  // MXNET_USE_NVML
 }
 
+void GpuDeviceStorageProfiler::DumpPoolStats(size_t current_pid) const {
+  std::lock_guard<std::mutex> lock(pool_stats_mutex_);
+  if (pool_stats_.empty()) {
+    return;
+  }
+  const std::string filename =
+      filename_prefix_ + "-pool-pid_" + std::to_string(current_pid) + ".csv";
+  std::ofstream fout(filename.c_str());
+  if (!fout.is_open()) {
+    return;
+  }
+  // fragmentation is the share of free pool memory that the largest free block cannot serve
+  fout << "\"Device\",\"Reserved\",\"Peak Reserved\",\"Used\",\"Free\","
+          "\"Largest Free Block\",\"Free Blocks\",\"Fragmentation\""
+       << std::endl;
+  for (const auto& dev_stats : pool_stats_) {
+    const PoolStats& stats = dev_stats.second;
+    const size_t free      = stats.reserved - stats.used;
+    const double frag      = free > 0 ? 1.0 - static_cast<double>(stats.largest_free) / free : 0.0;
+    fout << "\"" << dev_stats.first << "\","
+         << "\"" << stats.reserved << "\","
+         << "\"" << stats.peak_reserved << "\","
+         << "\"" << stats.used << "\","
+         << "\"" << free << "\","
+         << "\"" << stats.largest_free << "\","
+         << "\"" << stats.num_free_blocks << "\","
+         << "\"" << frag << "\"" << std::endl;
+  }
+}
+
 #endif  // MXNET_USE_CUDA
 
 }  // namespace profiler
@@ -21,8 +21,13 @@
 
 #include <mxnet/libinfo.h>
 #include <mxnet/storage.h>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <ostream>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 #include <thread>
 #include <unordered_map>
@@ -122,6 +127,115 @@ class DeviceStorageProfiler {
   std::vector<std::shared_ptr<profiler::ProfileCounter>> mem_counters_;
 };
 
+/*!
+ * \brief Timeline of the live bytes of every device, attributed to the operator that allocated
+ *  them and to whether the memory planner or the operator itself asked for them, next to the
+ *  bytes the pools keep cached. While the profiler runs with profile_memory, each change is
+ *  written to the trace as counter tracks, and the holders at the peak of each device are kept
+ *  for DumpPeak.
+ */
+class MemoryTimeline {
+ public:
+  /*! \brief get the memory timeline singleton */
+  static MemoryTimeline* Get();
+
+  /*! \brief whether allocations are recorded */
+  static bool IsProfiling() {
+    return Profiler::Get()->IsProfiling(Profiler::kMemory);
+  }
+
+  /*! \brief what the allocations of a thread are attributed to */
+  struct Attribution {
+    const char* op_name = nullptr;
+    bool planned        = false;
+  };
+
+  /*!
+   * \brief Attributes the allocations the calling thread makes while it is alive
+   */
+  class Scope {
+   public:
+    /*!
+     * \param op_name name of the operator, nullptr to keep the enclosing attribution
+     * \param planned whether the memory planner makes the allocations
+     */
+    Scope(const char* op_name, bool planned) {
+      if (op_name && IsProfiling()) {
+        Attribution& current = Current();
+        previous_            = current;
+        current              = {op_name, planned};
+        active_              = true;
+      }
+    }
+    ~Scope() {
+      if (active_) {
+        Current() = previous_;
+      }
+    }
+
+   private:
+    Attribution previous_;
+    bool active_ = false;
+  };
+
+  /*!
+   * \brief record an allocation
+   * \param cached bytes cached by the pool of the device afterwards
+   */
+  void OnAlloc(const Storage::Handle& handle, size_t cached);
+  /*!
+   * \brief record a deallocation
+   * \param cached bytes cached by the pool of the device afterwards
+   */
+  void OnFree(const Storage::Handle& handle, size_t cached);
+  /*! \brief record a change of the bytes cached by the pool of a device */
+  void OnCached(const Context& ctx, size_t cached);
+
+  /*!
+   * \brief write the holders of the live bytes of each device at its peak in json format
+   * \param reset whether to start the next peak from the current state
+   */
+  void DumpPeak(std::ostream& os, bool reset);
+
+ private:
+  /*! \brief live bytes of one operator, planned or not */
+  struct Holder {
+    uint64_t bytes = 0;
+    uint64_t count = 0;
+  };
+  /*! \brief operator name and whether planned */
+  using HolderKey = std::pair<std::string, bool>;
+  using Holders   = std::map<HolderKey, Holder>;
+  struct Device {
+    uint64_t in_use      = 0;
+    uint64_t cached      = 0;
+    uint64_t peak        = 0;
+    uint64_t peak_cached = 0;
+    uint64_t peak_time   = 0;
+    Holders holders;
+    Holders peak_holders;
+  };
+  struct Allocation {
+    size_t device;
+    uint64_t size;
+    Holders::iterator holder;
+  };
+
+  static Attribution& Current() {
+    static thread_local Attribution current;
+    return current;
+  }
+  /*! \brief remove a live allocation, requires m_ */
+  void Release(std::unordered_map<void*, Allocation>::iterator it);
+  /*! \brief write the counters of a device to the trace, requires m_ */
+  void Emit(size_t device, const Device& dev);
+
+  std::mutex m_;
+  std::unordered_map<void*, Allocation> live_;
+  /*! \brief by profiler device index */
+  std::map<size_t, Device> devices_;
+};
+
 #if MXNET_USE_CUDA
 
 /*!
@@ -179,6 +293,30 @@ class GpuDeviceStorageProfiler {
     }
   }
 
+  /*!
+   * \brief Record the state of a segment-based memory pool, used to report fragmentation.
+   * \param dev_id device of the pool
+   * \param reserved bytes the pool obtained from the device
+   * \param used bytes handed out to users
+   * \param largest_free size of the largest free block
+   * \param num_free_blocks number of free blocks
+   */
+  void OnPoolStats(int dev_id,
+                   size_t reserved,
+                   size_t used,
+                   size_t largest_free,
+                   size_t num_free_blocks) {
+    if (IsProfiling()) {
+      std::lock_guard<std::mutex> lock(pool_stats_mutex_);
+      PoolStats& stats      = pool_stats_[dev_id];
+      stats.reserved        = reserved;
+      stats.used            = used;
+      stats.peak_reserved   = std::max(stats.peak_reserved, reserved);
+      stats.largest_free    = largest_free;
+      stats.num_free_blocks = num_free_blocks;
+    }
+  }
+
   /*! \brief set the dumping filename */
   void SetConfig(const std::string& filename_prefix) {
     filename_prefix_ = filename_prefix;
@@ -203,6 +341,18 @@ class GpuDeviceStorageProfiler {
     bool reuse;                  // whether the allocation is a reuse
   };
   std::unordered_map<void*, AllocEntry> gpu_mem_alloc_entries_;
+  /*! \brief latest state of segment-based pools, per device */
+  struct PoolStats {
+    size_t reserved{0};
+    size_t used{0};
+    size_t peak_reserved{0};
+    size_t largest_free{0};
+    size_t num_free_blocks{0};
+  };
+  mutable std::mutex pool_stats_mutex_;
+  std::map<int, PoolStats> pool_stats_;
+  /*! \brief dump the pool states, if any pool reported them */
+  void DumpPoolStats(size_t current_pid) const;
 };
 
 #endif  // MXNET_USE_CUDA
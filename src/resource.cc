@@ -30,7 +30,9 @@
 #include <mxnet/resource.h>
 #include <limits>
 #include <atomic>
+#include <map>
 #include <memory>
+#include <utility>
 #include "./common/lazy_alloc_array.h"
 #include "./common/utils.h"
 #include "./common/cuda/utils.h"
@@ -89,6 +91,33 @@ struct SpaceAllocator {
   }
 };
 
+// the temporary spaces of the operators run by a thread, by context and stream
+class StreamSpaceArena {
+ public:
+  // the space of a stream of the calling thread, used without lock nor engine variable since
+  // the operators of a thread run one at a time, and the kernels of a stream in order
+  static SpaceAllocator* Get(const Context& ctx, const void* stream) {
+    static thread_local StreamSpaceArena arena;
+    auto it = arena.spaces_.find(std::make_pair(ctx, stream));
+    if (it == arena.spaces_.end()) {
+      it             = arena.spaces_.emplace(std::make_pair(ctx, stream), SpaceAllocator()).first;
+      it->second.ctx = ctx;
+    }
+    return &it->second;
+  }
+
+  ~StreamSpaceArena() {
+    for (auto& kv : spaces_) {
+      MSHADOW_CATCH_ERROR(kv.second.ReleaseAll());
+    }
+  }
+
+ private:
+  // keep the storage alive until the spaces of the thread are freed
+  std::shared_ptr<Storage> storage_ref_ = Storage::_GetSharedRef();
+  std::map<std::pair<Context, const void*>, SpaceAllocator> spaces_;
+};
+
 // Implements resource manager
 class ResourceManagerImpl : public ResourceManager {
  public:
@@ -97,6 +126,7 @@ class ResourceManagerImpl : public ResourceManager {
     gpu_temp_space_copy_  = dmlc::GetEnv("MXNET_GPU_TEMP_COPY", 1);
     cpu_native_rand_copy_ = dmlc::GetEnv("MXNET_CPU_PARALLEL_RAND_COPY", 1);
     gpu_native_rand_copy_ = dmlc::GetEnv("MXNET_GPU_PARALLEL_RAND_COPY", 1);
+    stream_temp_space_    = dmlc::GetEnv("MXNET_STREAM_TEMP_SPACE", false);
 #if MXNET_USE_CUDNN == 1
     gpu_cudnn_dropout_state_copy_ = dmlc::GetEnv("MXNET_GPU_CUDNN_DROPOUT_STATE_COPY", 1);
 #endif  // MXNET_USE_CUDNN == 1
@@ -191,6 +221,22 @@ class ResourceManagerImpl : public ResourceManager {
     return ret;
   }
 
+  Resource RequestOpTempSpace(Context ctx) override {
+    if (!stream_temp_space_)
+      return Request(ctx, ResourceRequest::kTempSpace);
+    std::unique_ptr<Context>& space_ctx = stream_space_ctx_[ctx];
+    if (!space_ctx) {
+      space_ctx = std::make_unique<Context>(ctx);
+    }
+    // the space is picked by the stream using it, see Resource::get_space_internal
+    Resource ret;
+    ret.req  = ResourceRequest(ResourceRequest::kTempSpace);
+    ret.var  = nullptr;
+    ret.id   = -1;
+    ret.ptr_ = space_ctx.get();
+    return ret;
+  }
+
   void SeedRandom(uint32_t seed) override {
     global_seed_ = seed;
     cpu_rand_->SeedWithDeviceID(global_seed_);
@@ -499,6 +545,10 @@ class ResourceManagerImpl : public ResourceManager {
   std::unique_ptr<ResourceRandom<cpu>> cpu_rand_;
   /*! \brief CPU temp space resources */
   std::unique_ptr<ResourceTempSpace<ResourceRequest::kTempSpace>> cpu_space_;
+  /*! \brief whether the operators get their temp space from the arenas of the streams */
+  bool stream_temp_space_;
+  /*! \brief the contexts of the temp spaces of the streams */
+  std::map<Context, std::unique_ptr<Context>> stream_space_ctx_;
   /*! \brief CPU parallel random number resources */
   std::unique_ptr<ResourceParallelRandom<cpu>> cpu_parallel_rand_;
 #if MXNET_USE_CUDA
@@ -518,11 +568,20 @@ class ResourceManagerImpl : public ResourceManager {
 };
 }  // namespace resource
 
-void* Resource::get_space_internal(size_t size, const std::string& name) const {
+void* Resource::get_space_internal(size_t size, const std::string& name, const void* stream) const {
+  // the temp space without engine variable is the one of the stream
+  if (var == nullptr) {
+    return resource::StreamSpaceArena::Get(*static_cast<Context*>(ptr_), stream)
+        ->GetSpace(size, name);
+  }
   return static_cast<resource::SpaceAllocator*>(ptr_)->GetSpace(size, name);
 }
 
 void* Resource::get_host_space_internal(size_t size) const {
+  if (var == nullptr) {
+    return resource::StreamSpaceArena::Get(*static_cast<Context*>(ptr_), nullptr)
+        ->GetHostSpace(size);
+  }
   return static_cast<resource::SpaceAllocator*>(ptr_)->GetHostSpace(size);
 }
 
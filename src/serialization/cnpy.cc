@@ -38,6 +38,14 @@
 #include <set>
 #include <stdexcept>
 #include <typeinfo>
+#include <exception>
+#include <memory>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+#include "../engine/openmp.h"
 
 namespace mxnet {
 
@@ -242,7 +250,7 @@ std::tuple<int, int, std::vector<dim_t>> parse_npy_header_descr(const std::strin
   std::smatch sm;
   std::vector<dim_t> shape;
   while (std::regex_search(shape_str, sm, num_regex)) {
-    shape.push_back(std::stoi(sm[0].str()));
+    shape.push_back(std::stoll(sm[0].str()));
     shape_str = sm.suffix().str();
   }
 
@@ -261,7 +269,146 @@ std::tuple<int, int, std::vector<dim_t>> parse_npy_header_descr(const std::strin
   return std::tuple(type_flag, fortran_order, shape);
 }
 
+size_t parse_npy_header(const char* data,
+                        size_t size,
+                        int* type_flag,
+                        std::vector<dim_t>* shape,
+                        bool* fortran_order) {
+  CHECK(size >= 10 && static_cast<uint8_t>(data[0]) == 0x93 &&
+        std::memcmp(data + 1, "NUMPY", 5) == 0)
+      << "Invalid npy data";
+  const uint8_t major_version = data[6];
+  CHECK(major_version >= 0x01 && major_version <= 0x03) << "Unsupported npy major version";
+  // the header length is little endian, 2 bytes in version 1 and 4 bytes after
+  size_t preamble   = 10;
+  size_t header_len = static_cast<uint8_t>(data[8]) | static_cast<uint8_t>(data[9]) << 8;
+  if (major_version > 0x01) {
+    CHECK_GE(size, 12U) << "Invalid npy data";
+    preamble = 12;
+    header_len |= static_cast<size_t>(static_cast<uint8_t>(data[10])) << 16 |
+                  static_cast<size_t>(static_cast<uint8_t>(data[11])) << 24;
+  }
+  CHECK_LE(preamble + header_len, size) << "Invalid npy data";
+  auto [flag, fortran, dims] =  // NOLINT
+      parse_npy_header_descr(std::string(data + preamble, header_len));
+  if (fortran_order == nullptr) {
+    CHECK(!fortran) << "npy data in Fortran order can not be used in place";
+  } else {
+    *fortran_order = fortran;
+  }
+  *type_flag = flag;
+  *shape     = dims;
+  return preamble + header_len;
+}
+
+#ifndef _WIN32
+bool map_array(const std::shared_ptr<io::MappedFile>& file,
+               size_t offset,
+               size_t size,
+               NDArray* out) {
+  int type_flag;
+  std::vector<dim_t> shape;
+  bool fortran_order;
+  const size_t header_size =
+      parse_npy_header(file->data() + offset, size, &type_flag, &shape, &fortran_order);
+  TShape tshape(shape);
+  const size_t type_size = mshadow::mshadow_sizeof(type_flag);
+  CHECK_LE(header_size + tshape.Size() * type_size, size) << "Invalid npy data";
+  if (fortran_order || (offset + header_size) % type_size != 0)
+    return false;
+  TBlob data(file->data() + offset + header_size, tshape, cpu::kDevMask, type_flag, 0);
+  *out = NDArray(data, 0, [file]() {});
+  return true;
+}
+
+// the files are written in chunks, by up to kMaxWriteThreads threads at the same time
+constexpr size_t kWriteChunkBytes = 16 << 20;
+constexpr int kMaxWriteThreads    = 8;
+
+/*! \brief write n bytes at an offset of a file, returns 0 or the errno of the failure */
+int write_at(int fd, const char* data, size_t n, size_t offset) {
+  while (n > 0) {
+    const ssize_t written = pwrite(fd, data, n, offset);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return errno;
+    }
+    data += written;
+    n -= written;
+    offset += written;
+  }
+  return 0;
+}
+
+/*!
+ * \brief stream an array of a gpu to a file chunk by chunk, the copies of the next chunks to
+ *  the host running while the previous ones are written
+ */
+void save_device_array(const std::string& fname, const NDArray& array) {
+  constexpr size_t kNumBuffers = 4;
+  const size_t type_size       = mshadow::mshadow_sizeof(array.dtype());
+  const size_t size            = array.shape().Size();
+  const size_t chunk           = std::max<size_t>(1, kWriteChunkBytes / type_size);
+  const size_t num_chunks      = (size + chunk - 1) / chunk;
+  const std::string header =
+      create_npy_header(TBlob(nullptr, array.shape(), cpu::kDevMask, array.dtype()));
+  const NDArray flat = array.Reshape(mxnet::TShape(1, size));
+
+  int fd = open(fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  CHECK_NE(fd, -1) << "Failed to open " << fname << ": " << strerror(errno);
+  std::vector<std::vector<char>> buffers(std::min(kNumBuffers, num_chunks));
+  std::vector<Engine::VarHandle> done(buffers.size());
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    buffers[i].resize(std::min(chunk, size) * type_size);
+    done[i] = Engine::Get()->NewVariable();
+  }
+  auto copy = [&](size_t k) {
+    const size_t begin = k * chunk;
+    const size_t end   = std::min(size, begin + chunk);
+    flat.Slice(begin, end).AsyncCopyToCPU(
+        buffers[k % kNumBuffers].data(), end - begin, done[k % kNumBuffers]);
+  };
+  std::exception_ptr error;
+  try {
+    int err = write_at(fd, header.data(), header.size(), 0);
+    CHECK_EQ(err, 0) << "Failed to write " << fname << ": " << strerror(err);
+    for (size_t k = 0; k < buffers.size(); ++k) {
+      copy(k);
+    }
+    for (size_t k = 0; k < num_chunks; ++k) {
+      Engine::Get()->WaitForVar(done[k % kNumBuffers]);
+      const size_t nbytes = (std::min(size, (k + 1) * chunk) - k * chunk) * type_size;
+      const size_t offset = header.size() + k * chunk * type_size;
+      err                 = write_at(fd, buffers[k % kNumBuffers].data(), nbytes, offset);
+      CHECK_EQ(err, 0) << "Failed to write " << fname << ": " << strerror(err);
+      if (k + kNumBuffers < num_chunks)
+        copy(k + kNumBuffers);
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+  // the buffers outlive the copies still running after a failure
+  for (Engine::VarHandle var : done) {
+    try {
+      Engine::Get()->WaitForVar(var);
+    } catch (...) {
+    }
+    Engine::Get()->DeleteVariable([](RunContext) {}, Context::CPU(), var);
+  }
+  close(fd);
+  if (error)
+    std::rethrow_exception(error);
+}
+#endif  // _WIN32
+
 void save_array(const std::string& fname, const NDArray& array_) {
+#ifndef _WIN32
+  if (array_.ctx().dev_mask() != cpu::kDevMask && array_.storage_type() == kDefaultStorage) {
+    save_device_array(fname, array_);
+    return;
+  }
+#endif
   NDArray array;  // a copy on cpu
   if (array_.ctx().dev_mask() != cpu::kDevMask) {
     array = array_.Copy(Context::CPU());
@@ -280,14 +427,43 @@ void save_array(const std::string& fname, const NDArray& array_) {
 
   const TBlob& blob      = array.data();
   std::string npy_header = create_npy_header(blob);
-
+  const char* data       = static_cast<const char*>(blob.dptr_);
+  const size_t nbytes    = blob.Size() * mshadow::mshadow_sizeof(blob.type_flag_);
+
+#ifndef _WIN32
+  // the chunks are written in parallel at their offsets, which keeps fast disks busy
+  int fd = open(fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  CHECK_NE(fd, -1) << "Failed to open " << fname << ": " << strerror(errno);
+  const int64_t num_chunks = (nbytes + kWriteChunkBytes - 1) / kWriteChunkBytes;
+  std::vector<int> errors(num_chunks + 1, 0);
+  errors[num_chunks] = write_at(fd, npy_header.data(), npy_header.size(), 0);
+  const int num_threads = std::max<int64_t>(1, std::min<int64_t>(kMaxWriteThreads, num_chunks));
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+  for (int64_t i = 0; i < num_chunks; ++i) {
+    const size_t begin = i * kWriteChunkBytes;
+    const size_t n     = std::min(kWriteChunkBytes, nbytes - begin);
+    errors[i]          = write_at(fd, data + begin, n, npy_header.size() + begin);
+  }
+  close(fd);
+  for (int err : errors) {
+    CHECK_EQ(err, 0) << "Failed to write " << fname << ": " << strerror(err);
+  }
+#else
   std::ofstream output(fname, std::ios::binary);
   output.write(npy_header.data(), npy_header.size());
-  output.write(static_cast<const char*>(blob.dptr_),
-               blob.Size() * mshadow::mshadow_sizeof(blob.type_flag_));
+  output.write(data, nbytes);
+#endif
 }
 
-NDArray load_array(const std::string& fname) {
+NDArray load_array(const std::string& fname, bool mapped) {
+#ifndef _WIN32
+  if (mapped) {
+    auto file = std::make_shared<io::MappedFile>(fname, false);
+    NDArray array;
+    if (map_array(file, 0, file->size(), &array))
+      return array;
+  }
+#endif
   std::ifstream strm(fname, std::ios::binary);
   strm.exceptions(std::istream::eofbit);
   strm.exceptions(std::istream::failbit);
@@ -319,59 +495,158 @@ NDArray load_array(const std::string& fname) {
 
 namespace npz {
 
-size_t npy_header_blob_read_callback(void* pOpaque, mz_uint64 file_ofs, void* pBuf, size_t n) {
-  auto [npy_header, blob] =                                                  // NOLINT
-      *static_cast<std::tuple<const std::string*, const TBlob*>*>(pOpaque);  // NOLINT
-
-  if (file_ofs < npy_header->size() && file_ofs + n < npy_header->size()) {
-    // Read n bytes from npy_header
-    const void* pSrc = static_cast<const void*>(npy_header->data() + file_ofs);
-    std::memcpy(pBuf, pSrc, n);
-  } else if (file_ofs < npy_header->size()) {
-    // Read npy_header->size() - file_ofs bytes from npy_header
-    const void* pSrc          = static_cast<const void*>(npy_header->data() + file_ofs);
-    const size_t npy_header_n = npy_header->size() - file_ofs;
-    std::memcpy(pBuf, pSrc, npy_header_n);
-
-    // Read n - (npy_header->size() - file_ofs) bytes from blob
-    void* pBuf_blob = static_cast<void*>(static_cast<char*>(pBuf) + npy_header_n);
-    std::memcpy(pBuf_blob, blob->dptr_, n - npy_header_n);
+/*! \brief a member of an archive, its npy header followed by the data of a blob if any */
+struct Member {
+  std::string name;
+  std::string header;
+  const char* data = nullptr;
+  size_t size      = 0;
+};
+
+Member blob_member(const std::string& blob_name, const TBlob& blob) {
+  Member member;
+  member.name   = blob_name + ".npy";
+  member.header = npy::create_npy_header(blob);
+  member.data   = static_cast<const char*>(blob.dptr_);
+  member.size   = blob.Size() * mshadow::mshadow_sizeof(blob.type_flag_);
+  return member;
+}
+
+size_t member_read_callback(void* pOpaque, mz_uint64 file_ofs, void* pBuf, size_t n) {
+  const Member& member = *static_cast<const Member*>(pOpaque);
+  const size_t header  = member.header.size();
+  char* dst            = static_cast<char*>(pBuf);
+  if (file_ofs < header) {
+    // Read up to header - file_ofs bytes from the header, and the rest from the data
+    const size_t header_n = std::min<size_t>(n, header - file_ofs);
+    std::memcpy(dst, member.header.data() + file_ofs, header_n);
+    std::memcpy(dst + header_n, member.data, n - header_n);
   } else {
-    // Read n bytes from blob
-    const void* pSrc =
-        static_cast<const void*>(static_cast<char*>(blob->dptr_) + file_ofs - npy_header->size());
-    std::memcpy(pBuf, pSrc, n);
+    std::memcpy(dst, member.data + file_ofs - header, n);
   }
   return n;
 }
 
-void save_blob(mz_zip_archive* archive, const std::string& blob_name, const TBlob& blob) {
-  const std::string npy_header = npy::create_npy_header(blob);
-
-  const std::string blob_name_npy = blob_name + ".npy";
-  mz_uint64 size_to_add           = npy_header.size();
-  size_to_add += blob.Size() * mshadow::mshadow_sizeof(blob.type_flag_);
-  auto callback_data = std::tuple(&npy_header, &blob);
+void add_stored_member(mz_zip_archive* archive, const Member& member) {
+  const mz_uint64 size = member.header.size() + member.size;
+  // The alignment extra field of zipalign (0xd935) pads the data of the member to 64 bytes in
+  // the file, so that mapped loading can point into it. The field follows the zip64 field which
+  // miniz adds to the local header of large members and of members at large offsets.
+  const mz_uint64 ofs = archive->m_archive_size;
+  const bool big_size = size >= MZ_UINT32_MAX;
+  const bool big_ofs  = ofs >= MZ_UINT32_MAX;
+  const size_t zip64  = big_size || big_ofs ? 4 + (big_size ? 16 : 0) + (big_ofs ? 8 : 0) : 0;
+  const size_t padding = (64 - (ofs + 30 + member.name.size() + zip64 + 6) % 64) % 64;
+  std::string extra(6 + padding, '\0');
+  extra[0] = static_cast<char>(0x35);
+  extra[1] = static_cast<char>(0xd9);
+  extra[2] = static_cast<char>(2 + padding);
+  extra[4] = static_cast<char>(64);
   CHECK(mz_zip_writer_add_read_buf_callback(archive,
-                                            blob_name_npy.data(),
-                                            npy_header_blob_read_callback,
-                                            static_cast<void*>(&callback_data),
-                                            size_to_add,
+                                            member.name.data(),
+                                            member_read_callback,
+                                            const_cast<Member*>(&member),
+                                            size,
                                             nullptr,
                                             nullptr,
                                             0,
                                             MZ_NO_COMPRESSION,
-                                            nullptr,
-                                            0,
+                                            extra.data(),
+                                            extra.size(),
                                             nullptr,
                                             0))
       << mz_zip_get_error_string(mz_zip_get_last_error(archive));
 }
 
+mz_bool append_deflated(const void* buf, int len, void* user) {
+  auto* out = static_cast<std::vector<char>*>(user);
+  out->insert(out->end(), static_cast<const char*>(buf), static_cast<const char*>(buf) + len);
+  return MZ_TRUE;
+}
+
+/*!
+ * \brief deflate the bytes [begin, end) of a member with a compressor of its own. The stream of
+ *  a chunk ends with a full flush on a byte boundary but the one of the last chunk, so that the
+ *  streams of the chunks concatenate into the stream of the member.
+ */
+bool deflate_chunk(const Member& member,
+                   size_t begin,
+                   size_t end,
+                   mz_uint flags,
+                   bool last,
+                   std::vector<char>* out) {
+  // the state of the compressor is too large for the stack
+  auto compressor = std::make_unique<tdefl_compressor>();
+  if (tdefl_init(compressor.get(), append_deflated, out, flags) != TDEFL_STATUS_OKAY)
+    return false;
+  const size_t header = member.header.size();
+  bool ok             = true;
+  if (begin < header) {
+    ok = tdefl_compress_buffer(compressor.get(),
+                               member.header.data() + begin,
+                               std::min(end, header) - begin,
+                               TDEFL_NO_FLUSH) == TDEFL_STATUS_OKAY;
+  }
+  if (ok && end > header) {
+    const char* data = member.data + std::max(begin, header) - header;
+    const size_t n   = member.data + end - header - data;
+    ok = tdefl_compress_buffer(compressor.get(), data, n, TDEFL_NO_FLUSH) == TDEFL_STATUS_OKAY;
+  }
+  const tdefl_status status =
+      tdefl_compress_buffer(compressor.get(), nullptr, 0, last ? TDEFL_FINISH : TDEFL_FULL_FLUSH);
+  return ok && status == (last ? TDEFL_STATUS_DONE : TDEFL_STATUS_OKAY);
+}
+
+void add_deflated_member(mz_zip_archive* archive, const Member& member, int level) {
+  constexpr size_t kChunkBytes = 4 << 20;
+  const mz_uint flags =
+      tdefl_create_comp_flags_from_zip_params(level, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY);
+  const size_t size        = member.header.size() + member.size;
+  const int64_t num_chunks = (size + kChunkBytes - 1) / kChunkBytes;
+  std::vector<std::vector<char>> streams(num_chunks);
+  std::vector<char> ok(num_chunks, false);
+  mz_ulong crc = MZ_CRC32_INIT;
+  // the chunks are deflated in parallel, the iteration 0 computing the crc of the member
+  const int num_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+  for (int64_t i = 0; i <= num_chunks; ++i) {
+    if (i == 0) {
+      crc = mz_crc32(crc,
+                     reinterpret_cast<const unsigned char*>(member.header.data()),
+                     member.header.size());
+      if (member.size > 0)
+        crc = mz_crc32(crc, reinterpret_cast<const unsigned char*>(member.data), member.size);
+    } else {
+      const size_t begin = (i - 1) * kChunkBytes;
+      const size_t end   = std::min(size, begin + kChunkBytes);
+      ok[i - 1] = deflate_chunk(member, begin, end, flags, i == num_chunks, &streams[i - 1]);
+    }
+  }
+  size_t deflated_size = 0;
+  for (int64_t i = 0; i < num_chunks; ++i) {
+    CHECK(ok[i]) << "Failed to deflate " << member.name;
+    deflated_size += streams[i].size();
+  }
+  std::vector<char> deflated;
+  deflated.reserve(deflated_size);
+  for (auto& stream : streams) {
+    deflated.insert(deflated.end(), stream.begin(), stream.end());
+    std::vector<char>().swap(stream);
+  }
+  CHECK(mz_zip_writer_add_mem_ex(archive,
+                                 member.name.data(),
+                                 deflated.data(),
+                                 deflated.size(),
+                                 nullptr,
+                                 0,
+                                 level | MZ_ZIP_FLAG_COMPRESSED_DATA,
+                                 size,
+                                 static_cast<mz_uint32>(crc)))
+      << mz_zip_get_error_string(mz_zip_get_last_error(archive));
+}
+
 // Save shape of sparse ndarray in to scipy compatible shape.npy with int64 data
-void save_shape_array(mz_zip_archive* archive,
-                      const std::string& blob_name,
-                      const mxnet::TShape& shape) {
+Member shape_member(const std::string& blob_name, const mxnet::TShape& shape) {
   // Special case of create_npy_header for TShape data
   std::string dict;
   dict += "{'descr': '<i8', 'fortran_order': False, 'shape': (";
@@ -417,15 +692,13 @@ void save_shape_array(mz_zip_archive* archive,
     npy += static_cast<char>((value >> 56) & 0xFF);
   }
 
-  const std::string blob_name_npy = blob_name + ".npy";
-  CHECK(mz_zip_writer_add_mem(
-      archive, blob_name_npy.data(), npy.data(), npy.size(), MZ_NO_COMPRESSION))
-      << mz_zip_get_error_string(mz_zip_get_last_error(archive));
+  Member member;
+  member.name   = blob_name + ".npy";
+  member.header = std::move(npy);
+  return member;
 }
 
-void save_format_array(mz_zip_archive* archive,
-                       const std::string& blob_name,
-                       const std::string_view& format) {
+Member format_member(const std::string& blob_name, const std::string_view& format) {
   // Special case of create_npy_header for TShape data
   std::string dict;
   dict += "{'descr': '|s";
@@ -461,52 +734,78 @@ void save_format_array(mz_zip_archive* archive,
 
   npy += format;
 
-  const std::string blob_name_npy = blob_name + ".npy";
-  CHECK(mz_zip_writer_add_mem(
-      archive, blob_name_npy.data(), npy.data(), npy.size(), MZ_NO_COMPRESSION))
-      << mz_zip_get_error_string(mz_zip_get_last_error(archive));
+  Member member;
+  member.name   = blob_name + ".npy";
+  member.header = std::move(npy);
+  return member;
 }
 
-void save_array(mz_zip_archive* archive, const std::string& array_name, const NDArray& array_) {
-  NDArray array;  // a copy on cpu
-  if (array_.ctx().dev_mask() != cpu::kDevMask) {
-    array = array_.Copy(Context::CPU());
-    array.WaitToRead();
-  } else {
-    array = array_;
+void save_arrays(mz_zip_archive* archive,
+                 const std::vector<std::string>& names,
+                 const std::vector<NDArray>& arrays,
+                 int level) {
+  CHECK_EQ(names.size(), arrays.size());
+  CHECK(level >= 0 && level <= MZ_UBER_COMPRESSION) << "Invalid compression level " << level;
+  // the copies of the arrays of the gpus to the host run ahead of the writing of the members
+  constexpr size_t kCopiesAhead = 2;
+  std::vector<NDArray> copies(arrays.size());
+  auto start_copy = [&](size_t i) {
+    copies[i] = arrays[i].ctx().dev_mask() != cpu::kDevMask ? arrays[i].Copy(Context::CPU()) :
+                                                              arrays[i];
+  };
+  for (size_t i = 0; i < std::min(kCopiesAhead, arrays.size()); ++i) {
+    start_copy(i);
+  }
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    if (i + kCopiesAhead < arrays.size())
+      start_copy(i + kCopiesAhead);
+    NDArray array = std::move(copies[i]);
     array.WaitToRead();
 #if MXNET_USE_ONEDNN == 1
     if (array.IsDNNLData()) {
       array = array.Reorder2Default();
     }
 #endif
-  }
 
-  switch (array.storage_type()) {
-    case kDefaultStorage: {
-      save_blob(archive, array_name, array.data());
-      break;
-    }
-    case kCSRStorage: {
-      save_blob(archive, array_name + "/data", array.data());
-      save_blob(archive, array_name + "/indptr", array.aux_data(csr::kIndPtr));
-      save_blob(archive, array_name + "/indices", array.aux_data(csr::kIdx));
-      save_shape_array(archive, array_name + "/shape", array.shape());
-      save_format_array(archive, array_name + "/format", "csr");
-      break;
+    const std::string& array_name = names[i];
+    std::vector<Member> members;
+    switch (array.storage_type()) {
+      case kDefaultStorage: {
+        members.push_back(blob_member(array_name, array.data()));
+        break;
+      }
+      case kCSRStorage: {
+        members.push_back(blob_member(array_name + "/data", array.data()));
+        members.push_back(blob_member(array_name + "/indptr", array.aux_data(csr::kIndPtr)));
+        members.push_back(blob_member(array_name + "/indices", array.aux_data(csr::kIdx)));
+        members.push_back(shape_member(array_name + "/shape", array.shape()));
+        members.push_back(format_member(array_name + "/format", "csr"));
+        break;
+      }
+      case kRowSparseStorage: {
+        members.push_back(blob_member(array_name + "/data", array.data()));
+        members.push_back(blob_member(array_name + "/indices", array.aux_data(rowsparse::kIdx)));
+        members.push_back(shape_member(array_name + "/shape", array.shape()));
+        members.push_back(format_member(array_name + "/format", "row_sparse"));
+        break;
+      }
+      default:
+        LOG(FATAL) << "Unknown storage type " << array.storage_type() << "encountered.";
     }
-    case kRowSparseStorage: {
-      save_blob(archive, array_name + "/data", array.data());
-      save_blob(archive, array_name + "/indices", array.aux_data(rowsparse::kIdx));
-      save_shape_array(archive, array_name + "/shape", array.shape());
-      save_format_array(archive, array_name + "/format", "row_sparse");
-      break;
+    for (const Member& member : members) {
+      if (level == 0) {
+        add_stored_member(archive, member);
+      } else {
+        add_deflated_member(archive, member, level);
+      }
     }
-    default:
-      LOG(FATAL) << "Unknown storage type " << array.storage_type() << "encountered.";
   }
 }
 
+void save_array(mz_zip_archive* archive, const std::string& array_name, const NDArray& array) {
+  save_arrays(archive, {array_name}, {array}, 0);
+}
+
 uint32_t parse_npy_header_len(mz_zip_reader_extract_iter_state* state,
                               const std::string_view& fname,
                               const std::string& zip_fname) {
@@ -534,12 +833,41 @@ uint32_t parse_npy_header_len(mz_zip_reader_extract_iter_state* state,
   return header_len;
 }
 
-std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(
-    const std::string& zip_fname) {
+#ifndef _WIN32
+/*! \brief point an array into a stored member of a mapped archive, see npy::map_array */
+bool map_member(mz_zip_archive* archive,
+                const std::shared_ptr<io::MappedFile>& file,
+                const std::string& path,
+                NDArray* out) {
+  const int index = mz_zip_reader_locate_file(archive, path.data(), nullptr, 0);
+  mz_zip_archive_file_stat stat;
+  if (index < 0 || !mz_zip_reader_file_stat(archive, index, &stat) || stat.m_method != 0 ||
+      stat.m_is_encrypted || stat.m_local_header_ofs + 30 > file->size())
+    return false;
+  // the data follows the local header, whose extra field may differ from the central one
+  const auto* local = reinterpret_cast<const uint8_t*>(file->data() + stat.m_local_header_ofs);
+  const uint32_t signature = local[0] | local[1] << 8 | local[2] << 16 | local[3] << 24;
+  const size_t name_len    = local[26] | local[27] << 8;
+  const size_t extra_len   = local[28] | local[29] << 8;
+  const size_t offset      = stat.m_local_header_ofs + 30 + name_len + extra_len;
+  if (signature != 0x04034b50 || offset + stat.m_comp_size > file->size())
+    return false;
+  return npy::map_array(file, offset, stat.m_comp_size, out);
+}
+#endif  // _WIN32
+
+std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(const std::string& zip_fname,
+                                                                      bool mapped) {
   mz_zip_archive archive{};
   CHECK(mz_zip_reader_init_file(&archive, zip_fname.data(), 0))
       << "Failed to open archive " << zip_fname << ": "
       << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
+#ifndef _WIN32
+  std::shared_ptr<io::MappedFile> mapped_file;
+  if (mapped) {
+    mapped_file = std::make_shared<io::MappedFile>(zip_fname, false);
+  }
+#endif
 
   // Collect the set of file-names per folder in the zip file. If the set of
   // file names in a folder matches the scipy.sparse.save_npz pattern, the
@@ -895,6 +1223,14 @@ std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(
       for (const std::string& fname : dircontents) {
         std::string path(dirname);
         path += fname;
+#ifndef _WIN32
+        NDArray mapped_array;
+        if (mapped_file && map_member(&archive, mapped_file, path, &mapped_array)) {
+          arrays.push_back(mapped_array);
+          return_names.emplace_back(path.substr(0, path.size() - 4));
+          continue;
+        }
+#endif
         mz_zip_reader_extract_iter_state* file =
             mz_zip_reader_extract_file_iter_new(&archive, path.data(), 0);
         CHECK(nullptr != file) << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
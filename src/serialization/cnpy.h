@@ -25,26 +25,69 @@
 #define MXNET_SERIALIZATION_CNPY_H_
 
 #include <mxnet/ndarray.h>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "miniz.h"
+#include "../io/mapped_file.h"
 
 namespace mxnet {
 
 namespace npy {
 
 void save_array(const std::string& fname, const NDArray& array);
-NDArray load_array(const std::string& fname);
+/*!
+ * \brief load an npy file
+ * \param mapped whether to point the array into a private mapping of the file, when its data
+ *  is in C order and aligned to its type
+ */
+NDArray load_array(const std::string& fname, bool mapped = false);
+/*!
+ * \brief parse the header of npy data in memory
+ * \param fortran_order set to whether the data is in Fortran order, which fails when null
+ * \return the offset of the array in data
+ */
+size_t parse_npy_header(const char* data,
+                        size_t size,
+                        int* type_flag,
+                        std::vector<dim_t>* shape,
+                        bool* fortran_order = nullptr);
+#ifndef _WIN32
+/*!
+ * \brief point an array into the npy data at an offset of a mapped file
+ * \return false, leaving out unchanged, when the data is in Fortran order or not aligned
+ */
+bool map_array(const std::shared_ptr<io::MappedFile>& file,
+               size_t offset,
+               size_t size,
+               NDArray* out);
+#endif
 
 }  // namespace npy
 
 namespace npz {
 
 void save_array(mz_zip_archive* archive, const std::string& array_name, const NDArray& array);
+/*!
+ * \brief save arrays as the members of an archive, the copies of the arrays of the gpus to the
+ *  host running ahead of the writing of the members
+ * \param level the deflate level of the members, deflated by chunks in parallel, or 0 to store
+ *  them with their data aligned to 64 bytes in the file
+ */
+void save_arrays(mz_zip_archive* archive,
+                 const std::vector<std::string>& names,
+                 const std::vector<NDArray>& arrays,
+                 int level);
 
-std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(const std::string& fname);
+/*!
+ * \brief load the arrays of an npz file
+ * \param mapped whether to point the dense arrays of the stored members into a private mapping
+ *  of the file, see npy::load_array
+ */
+std::pair<std::vector<NDArray>, std::vector<std::string>> load_arrays(const std::string& fname,
+                                                                      bool mapped = false);
 
 }  // namespace npz
 }  // namespace mxnet
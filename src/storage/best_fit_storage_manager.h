@@ -0,0 +1,333 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file best_fit_storage_manager.h
+ * \brief Storage manager that carves blocks out of large segments with best-fit search.
+ */
+#ifndef MXNET_STORAGE_BEST_FIT_STORAGE_MANAGER_H_
+#define MXNET_STORAGE_BEST_FIT_STORAGE_MANAGER_H_
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "./storage_manager.h"
+#include "./pooled_storage_manager.h"
+#include "../profiler/storage_profiler.h"
+
+namespace mxnet {
+namespace storage {
+
+/*!
+ * \brief Storage manager which, instead of rounding every request up to a bucket,
+ *  allocates large segments from the device and serves requests from them.
+ *  A request takes the smallest free block that fits (best fit); the block is split
+ *  and the remainder stays free. Freed blocks are merged with free neighbors of
+ *  the same segment, so memory released by variable-sized workloads can be
+ *  reused by requests of any size. Entirely free segments are only returned to
+ *  the device on memory pressure or ReleaseAll.
+ */
+class BestFitStorageManager final : public StorageManager {
+ public:
+  explicit BestFitStorageManager(const Context& ctx, int num_gpu_device) {
+    const char* dev_type = "CPU";
+    switch (dev_type_ = ctx.dev_type) {
+#if MXNET_USE_CUDA
+      case Context::kGPU:
+        contextHelper_ = std::make_unique<ContextHelperGPU>();
+        dev_type       = "GPU";
+        break;
+      case Context::kCPUPinned:
+        if (num_gpu_device > 0) {
+          contextHelper_ = std::make_unique<ContextHelperPinned>();
+          dev_type_      = Context::kGPU;
+          dev_type       = "CPU_PINNED";
+          break;
+        }
+#else
+      case Context::kCPUPinned:
+#endif
+        dev_type_ = Context::kCPU;
+      default:
+        contextHelper_ = std::make_unique<ContextHelperCPU>();
+        break;
+    }
+    contextHelper_->set_initilal_context(ctx);
+    const std::string prefix = std::string("MXNET_") + dev_type;
+    segment_size_ = dmlc::GetEnv((prefix + "_MEM_POOL_SEGMENT_SIZE").c_str(), size_t{32} << 20);
+    CHECK_GE(segment_size_, kAlignment) << prefix << "_MEM_POOL_SEGMENT_SIZE is too small";
+    const size_t reserve     = dmlc::GetEnv(env_var_name(dev_type, pool_reserve).c_str(), 5);
+    const size_t total       = std::get<1>(contextHelper_->getMemoryInfo());
+    memory_allocation_limit_ = total * reserve / 100;
+  }
+  ~BestFitStorageManager() override {
+    ReleaseAll();
+  }
+
+  void Alloc(Storage::Handle* handle, bool failsafe) override;
+  void Free(Storage::Handle handle) override {
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    FreeNoLock(handle);
+  }
+  void DirectFree(Storage::Handle handle) override {
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    Block* block = FreeNoLock(handle);
+    if (block != nullptr && block->prev == nullptr && block->next == nullptr) {
+      ReleaseSegmentNoLock(block);
+    }
+  }
+  void ReleaseAll() override {
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    ReleaseAllNoLock();
+  }
+  size_t CachedBytes() override {
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    return reserved_memory_ - used_memory_;
+  }
+
+ private:
+  /*! \brief granularity of block sizes and offsets */
+  static constexpr size_t kAlignment = 512;
+  /*! \brief contiguous piece of a segment, either allocated or free */
+  struct Block {
+    char* ptr;
+    size_t size;
+    bool free;
+    /*! \brief neighbors in the same segment, ordered by address */
+    Block* prev;
+    Block* next;
+    /*! \brief events of the last users of every byte of a free block */
+    Storage::SyncObj sync_obj;
+  };
+  /*! \brief orders free blocks by size, then address, for best-fit lookup */
+  struct BlockLess {
+    bool operator()(const Block* a, const Block* b) const {
+      return a->size != b->size ? a->size < b->size : a->ptr < b->ptr;
+    }
+  };
+
+  static inline size_t RoundUp(size_t x, size_t multiple) {
+    return (x + multiple - 1) / multiple * multiple;
+  }
+  static inline void MergeSyncObj(Storage::SyncObj* dst, const Storage::SyncObj& src) {
+#if MXNET_USE_CUDA
+    dst->events.insert(dst->events.end(), src.events.begin(), src.events.end());
+    dst->event_streams.insert(
+        dst->event_streams.end(), src.event_streams.begin(), src.event_streams.end());
+#endif
+  }
+
+  /*! \brief find and split a free block, nullptr if none is large enough */
+  Block* TakeBestFit(size_t size) {
+    Block key{nullptr, size, true, nullptr, nullptr, {}};
+    auto it = free_blocks_.lower_bound(&key);
+    if (it == free_blocks_.end())
+      return nullptr;
+    Block* block = *it;
+    free_blocks_.erase(it);
+    if (block->size - size >= kAlignment) {
+      auto* rest = new Block{
+          block->ptr + size, block->size - size, true, block, block->next, block->sync_obj};
+      if (block->next)
+        block->next->prev = rest;
+      block->next = rest;
+      block->size = size;
+      free_blocks_.insert(rest);
+    }
+    block->free = false;
+    return block;
+  }
+
+  Block* FreeNoLock(const Storage::Handle& handle) {
+    auto it = allocated_.find(handle.dptr);
+    if (it == allocated_.end()) {
+      LOG(WARNING) << "Freeing memory not allocated by this storage manager";
+      return nullptr;
+    }
+    Block* block = it->second;
+    allocated_.erase(it);
+    used_memory_ -= block->size;
+    block->free     = true;
+    block->sync_obj = handle.sync_obj;
+    SET_GPU_PROFILER(profilerGPU, contextHelper_);
+    GPU_PROFILER_ON_FREE(profilerGPU, handle.dptr);
+    // coalesce with free neighbors
+    if (block->prev && block->prev->free) {
+      Block* prev = block->prev;
+      free_blocks_.erase(prev);
+      prev->size += block->size;
+      prev->next = block->next;
+      if (block->next)
+        block->next->prev = prev;
+      MergeSyncObj(&prev->sync_obj, block->sync_obj);
+      delete block;
+      block = prev;
+    }
+    if (block->next && block->next->free) {
+      Block* next = block->next;
+      free_blocks_.erase(next);
+      block->size += next->size;
+      block->next = next->next;
+      if (next->next)
+        next->next->prev = block;
+      MergeSyncObj(&block->sync_obj, next->sync_obj);
+      delete next;
+    }
+    free_blocks_.insert(block);
+    ReportStats();
+    return block;
+  }
+
+  /*! \brief return an entirely free segment to the device */
+  void ReleaseSegmentNoLock(Block* block) {
+#if MXNET_USE_CUDA
+    for (auto ev : block->sync_obj.events) {
+      auto valid_ev = ev.lock();
+      if (valid_ev) {
+        MSHADOW_CUDA_CALL(cudaEventSynchronize(*valid_ev));
+      }
+    }
+#endif
+    free_blocks_.erase(block);
+    contextHelper_->Free(block->ptr);
+    reserved_memory_ -= block->size;
+    delete block;
+  }
+
+  void ReleaseAllNoLock() {
+    SET_DEVICE(device_store, contextHelper_, contextHelper_->initilal_context(), true);
+    std::vector<Block*> segments;
+    for (Block* block : free_blocks_) {
+      if (block->prev == nullptr && block->next == nullptr)
+        segments.push_back(block);
+    }
+    for (Block* block : segments) {
+      ReleaseSegmentNoLock(block);
+    }
+    UNSET_DEVICE(device_store);
+    ReportStats();
+  }
+
+  bool MemoryIsAvailable(size_t size) const {
+    const auto free = contextHelper_->freeMemorySize();
+    return free > size && memory_allocation_limit_ <= free - size;
+  }
+
+  /*! \brief publish reserved, used and largest free sizes to the storage profiler */
+  void ReportStats() const {
+#if MXNET_USE_CUDA
+    SET_GPU_PROFILER(profilerGPU, contextHelper_);
+    if (profilerGPU) {
+      const size_t largest = free_blocks_.empty() ? 0 : (*free_blocks_.rbegin())->size;
+      profilerGPU->OnPoolStats(contextHelper_->initilal_context().dev_id,
+                               reserved_memory_,
+                               used_memory_,
+                               largest,
+                               free_blocks_.size());
+    }
+#endif
+  }
+
+  Context::DeviceType dev_type_;
+  std::unique_ptr<ContextHelper> contextHelper_;
+  /*! \brief minimum size of a segment requested from the device */
+  size_t segment_size_;
+  /*! \brief amount of device memory that is never allocated */
+  size_t memory_allocation_limit_ = 0;
+  /*! \brief bytes obtained from the device */
+  size_t reserved_memory_ = 0;
+  /*! \brief bytes handed out to users */
+  size_t used_memory_ = 0;
+  std::set<Block*, BlockLess> free_blocks_;
+  std::unordered_map<void*, Block*> allocated_;
+  DISALLOW_COPY_AND_ASSIGN(BestFitStorageManager);
+};  // class BestFitStorageManager
+
+inline void BestFitStorageManager::Alloc(Storage::Handle* handle, bool failsafe) {
+  std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+  const size_t size = RoundUp(handle->size, kAlignment);
+  Block* block      = TakeBestFit(size);
+#if MXNET_USE_CUDA
+  const bool reuse = block != nullptr;
+#endif
+  if (block == nullptr) {
+    SET_DEVICE(device_store, contextHelper_, handle->ctx, true);
+    // small requests share a segment, large ones get a segment of their own
+    const size_t seg_size = size > segment_size_ ? RoundUp(size, 2 << 20) : segment_size_;
+    if (!MemoryIsAvailable(seg_size))
+      ReleaseAllNoLock();
+    void* ret = nullptr;
+    auto e    = contextHelper_->Malloc(&ret, seg_size);
+    if (e) {
+      ReleaseAllNoLock();
+      e = contextHelper_->Malloc(&ret, seg_size);
+    }
+    UNSET_DEVICE(device_store);
+    if (e) {
+#if MXNET_USE_CUDA
+      if (dev_type_ == Context::kGPU)
+        cudaGetLastError();
+#endif
+      handle->dptr = nullptr;
+      if (failsafe)
+        return;
+      LOG(FATAL) << "Memory allocation failed for segment of " << seg_size << " bytes, "
+                 << reserved_memory_ << " bytes reserved and " << used_memory_ << " bytes used";
+    }
+    reserved_memory_ += seg_size;
+    block = new Block{static_cast<char*>(ret), seg_size, true, nullptr, nullptr, {}};
+    free_blocks_.insert(block);
+    block = TakeBestFit(size);
+  }
+  used_memory_ += block->size;
+  allocated_[block->ptr] = block;
+  handle->dptr           = block->ptr;
+#if MXNET_USE_CUDA
+  if (reuse && dev_type_ == Context::kGPU) {
+    handle->sync_obj      = block->sync_obj;
+    const bool defer_sync = handle->stream_ordered && handle->sync_obj.event_streams.size() ==
+                                                          handle->sync_obj.events.size();
+    if (!defer_sync) {
+      for (auto ev : handle->sync_obj.events) {
+        auto valid_ev = ev.lock();
+        if (valid_ev) {
+          MSHADOW_CUDA_CALL(cudaEventSynchronize(*valid_ev));
+        }
+      }
+      handle->sync_obj = Storage::SyncObj();
+    }
+  }
+  SET_GPU_PROFILER(profilerGPU, contextHelper_);
+  if (profilerGPU)
+    profilerGPU->OnAlloc(*handle, block->size, reuse);
+#endif
+  block->sync_obj = Storage::SyncObj();
+  ReportStats();
+}
+
+}  // namespace storage
+}  // namespace mxnet
+
+#endif  // MXNET_STORAGE_BEST_FIT_STORAGE_MANAGER_H_
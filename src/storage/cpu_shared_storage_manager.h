@@ -26,26 +26,43 @@
 #include <sys/mman.h>
 #include <sys/fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #else
 #include <Windows.h>
 #include <process.h>
 #endif  // _WIN32
 
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include <limits>
+#include <map>
+#include <utility>
+#include <vector>
 #include "./storage_manager.h"
 
 namespace mxnet {
 namespace storage {
 /*!
  * \brief Storage manager for cpu shared memory
+ *
+ *  Outside of Windows, the allocations of at most MXNET_CPU_SHARED_MEM_POOL_SIZE MB are blocks
+ *  of large segments which each process maps once and sub-allocates. The other processes map
+ *  a segment the first time they receive one of its blocks and keep it mapped, so passing a
+ *  block only passes its offset. The count in the header of a block is shared between the
+ *  processes: the process owning the segment recycles a block it freed once the count shows
+ *  that the others did too.
  */
 class CPUSharedStorageManager final : public StorageManager {
  public:
   /*!
    * \brief Default constructor.
    */
-  CPUSharedStorageManager() : rand_gen_(std::random_device()()) {}
+  CPUSharedStorageManager() : rand_gen_(std::random_device()()) {
+#ifndef _WIN32
+    pid_ = getpid();
+#endif
+  }
   /*!
    * \brief Default destructor.
    */
@@ -55,6 +72,10 @@ class CPUSharedStorageManager final : public StorageManager {
     }
 #ifdef _WIN32
     CheckAndRealFree();
+#else
+    for (auto& kv : segments_) {
+      UnmapSegment(&kv.second);
+    }
 #endif
   }
 
@@ -90,6 +111,54 @@ class CPUSharedStorageManager final : public StorageManager {
 #ifdef _WIN32
   std::unordered_map<void*, Storage::Handle> is_free_;
   std::unordered_map<void*, HANDLE> map_handle_map_;
+#else
+  /*! \brief the alignment of the blocks in the pooled segments, and the offset of the first */
+  static constexpr size_t block_alignment_ = 64;
+  /*! \brief the segments of the other processes kept mapped while none of their blocks is used */
+  static constexpr int max_idle_segments_ = 16;
+  /*!
+   * \brief A pooled segment mapped by this process: one it owns and sub-allocates, or one of
+   *  another process holding blocks received from it.
+   */
+  struct Segment {
+    char* ptr{nullptr};
+    size_t size{0};
+    // the descriptor of the segment on linux, -1 elsewhere
+    int fd{-1};
+    // the id of the segment in the shared handles of its blocks
+    int shared_id{-1};
+    // the key finding the segment of a received block
+    std::pair<int64_t, int64_t> key;
+    bool owned{false};
+    // the handles of this process to blocks of the segment
+    int refs{0};
+    // the free blocks of an owned segment, their size by their offset
+    std::map<size_t, size_t> free_blocks;
+  };
+
+  /*! \brief the process the segments were mapped by, which a forked child is not */
+  int pid_;
+  /*! \brief the size of the pooled segments */
+  const size_t segment_size_ = dmlc::GetEnv("MXNET_CPU_SHARED_MEM_POOL_SIZE", size_t(128)) << 20;
+  /*! \brief the mapped segments, by their address */
+  std::map<char*, Segment> segments_;
+  /*! \brief the address of the mapped segments, by their key */
+  std::map<std::pair<int64_t, int64_t>, char*> segment_of_key_;
+  /*! \brief the blocks freed by this process that other processes may still use */
+  std::vector<Storage::Handle> pending_;
+
+  bool AllocPooled(Storage::Handle* handle);
+  void ImportPooled(Storage::Handle* handle);
+  void FreePooled(const Storage::Handle& handle);
+  Segment* SegmentOf(const void* dptr);
+  void ReleaseBlock(Segment* segment, size_t offset, size_t size);
+  void RecyclePending();
+  void ForgetInheritedSegments();
+  void UnmapSegment(Segment* segment);
+
+  size_t BlockSize(const Storage::Handle& handle) const {
+    return (handle.size + alignment_ + block_alignment_ - 1) / block_alignment_ * block_alignment_;
+  }
 #endif
 
   void FreeImpl(const Storage::Handle& handle);
@@ -107,6 +176,22 @@ class CPUSharedStorageManager final : public StorageManager {
 
 void CPUSharedStorageManager::Alloc(Storage::Handle* handle, bool /* failsafe */) {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
+#ifndef _WIN32
+  if (getpid() != pid_)
+    ForgetInheritedSegments();
+  if (handle->shared_id == -1 && handle->shared_pid == -1) {
+    if (AllocPooled(handle)) {
+      pool_[handle->dptr] = *handle;
+      return;
+    }
+  } else if (handle->shared_offset != 0) {
+    ImportPooled(handle);
+    pool_[handle->dptr] = *handle;
+    return;
+  }
+#else
+  CHECK_EQ(handle->shared_offset, 0) << "Pooled shared memory is not supported on Windows";
+#endif  // _WIN32
   std::uniform_int_distribution<> dis(0, std::numeric_limits<int>::max());
   int fid = -1;
   std::string filename;
@@ -197,6 +282,12 @@ void CPUSharedStorageManager::Alloc(Storage::Handle* handle, bool /* failsafe */
 }
 
 void CPUSharedStorageManager::FreeImpl(const Storage::Handle& handle) {
+#ifndef _WIN32
+  if (handle.shared_offset != 0) {
+    FreePooled(handle);
+    return;
+  }
+#endif  // _WIN32
   int count = DecrementRefCount(handle);
   CHECK_GE(count, 0);
 #ifdef _WIN32
@@ -220,6 +311,232 @@ void CPUSharedStorageManager::FreeImpl(const Storage::Handle& handle) {
 #endif  // _WIN32
 }
 
+#ifndef _WIN32
+bool CPUSharedStorageManager::AllocPooled(Storage::Handle* handle) {
+  const size_t size = BlockSize(*handle);
+  if (size + block_alignment_ > segment_size_)
+    return false;
+  RecyclePending();
+  Segment* segment = nullptr;
+  size_t offset    = 0;
+  // the first free block large enough, in the segments by address
+  for (auto& kv : segments_) {
+    if (!kv.second.owned)
+      continue;
+    for (const auto& block : kv.second.free_blocks) {
+      if (block.second >= size) {
+        segment = &kv.second;
+        offset  = block.first;
+        break;
+      }
+    }
+    if (segment != nullptr)
+      break;
+  }
+  if (segment == nullptr) {
+    std::uniform_int_distribution<> dis(0, std::numeric_limits<int>::max());
+    std::string filename;
+    int shared_id = -1;
+    int fid       = -1;
+    for (int i = 0; i < 10; ++i) {
+      shared_id = dis(rand_gen_);
+      filename  = SharedHandleToString(pid_, shared_id);
+      fid       = shm_open(filename.c_str(), O_EXCL | O_CREAT | O_RDWR, 0666);
+      if (fid != -1)
+        break;
+    }
+    if (fid == -1)
+      LOG(FATAL) << "Failed to open shared memory. shm_open failed with error " << strerror(errno);
+    CHECK_EQ(ftruncate(fid, segment_size_), 0);
+    void* ptr = mmap(nullptr, segment_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fid, 0);
+    CHECK_NE(ptr, MAP_FAILED) << "Failed to map shared memory. mmap failed with error "
+                              << strerror(errno);
+    Segment new_segment;
+    new_segment.ptr   = static_cast<char*>(ptr);
+    new_segment.size  = segment_size_;
+    new_segment.owned = true;
+    new_segment.free_blocks.emplace(block_alignment_, segment_size_ - block_alignment_);
+#ifdef __linux__
+    // the processes receiving the descriptor find the segment by its inode
+    struct stat st;
+    CHECK_EQ(fstat(fid, &st), 0);
+    CHECK_EQ(shm_unlink(filename.c_str()), 0)
+        << "Failed to unlink shared memory. shm_unlink failed with error " << strerror(errno);
+    new_segment.fd        = fid;
+    new_segment.shared_id = fid;
+    new_segment.key       = {static_cast<int64_t>(st.st_dev), static_cast<int64_t>(st.st_ino)};
+#else
+    CHECK_EQ(close(fid), 0) << "Failed to close shared memory. close failed with error "
+                            << strerror(errno);
+    new_segment.shared_id = shared_id;
+    new_segment.key       = {pid_, shared_id};
+#endif  // __linux__
+    segment_of_key_[new_segment.key] = new_segment.ptr;
+    segment = &(segments_[new_segment.ptr] = std::move(new_segment));
+    offset  = block_alignment_;
+  }
+  const size_t free_size = segment->free_blocks[offset];
+  segment->free_blocks.erase(offset);
+  if (free_size > size)
+    segment->free_blocks.emplace(offset + size, free_size - size);
+  ++segment->refs;
+  new (segment->ptr + offset) std::atomic<int>(1);
+  handle->shared_pid    = pid_;
+  handle->shared_id     = segment->shared_id;
+  handle->shared_offset = offset;
+  handle->dptr          = segment->ptr + offset + alignment_;
+  return true;
+}
+
+void CPUSharedStorageManager::ImportPooled(Storage::Handle* handle) {
+  std::pair<int64_t, int64_t> key;
+#ifdef __linux__
+  // the descriptor received with the block, duplicated for this process
+  const int fid = handle->shared_id;
+  struct stat st;
+  CHECK_EQ(fstat(fid, &st), 0) << "Invalid file descriptor from shared array.";
+  key = {static_cast<int64_t>(st.st_dev), static_cast<int64_t>(st.st_ino)};
+#else
+  key = {handle->shared_pid, handle->shared_id};
+#endif  // __linux__
+  auto it = segment_of_key_.find(key);
+  Segment* segment;
+  if (it != segment_of_key_.end()) {
+    segment = &segments_.at(it->second);
+#ifdef __linux__
+    if (fid != segment->fd) {
+      CHECK_EQ(close(fid), 0) << "Failed to close shared memory. close failed with error "
+                              << strerror(errno);
+    }
+#endif  // __linux__
+  } else {
+    Segment new_segment;
+#ifdef __linux__
+    new_segment.fd        = fid;
+    new_segment.shared_id = fid;
+#else
+    const std::string filename = SharedHandleToString(handle->shared_pid, handle->shared_id);
+    const int fid              = shm_open(filename.c_str(), O_RDWR, 0666);
+    CHECK_NE(fid, -1) << "Failed to open shared memory. shm_open failed with error "
+                      << strerror(errno);
+    struct stat st;
+    CHECK_EQ(fstat(fid, &st), 0);
+    new_segment.shared_id = handle->shared_id;
+#endif  // __linux__
+    new_segment.size = st.st_size;
+    void* ptr        = mmap(nullptr, new_segment.size, PROT_READ | PROT_WRITE, MAP_SHARED, fid, 0);
+    CHECK_NE(ptr, MAP_FAILED) << "Failed to map shared memory. mmap failed with error "
+                              << strerror(errno);
+#ifndef __linux__
+    CHECK_EQ(close(fid), 0) << "Failed to close shared memory. close failed with error "
+                            << strerror(errno);
+#endif  // __linux__
+    new_segment.ptr      = static_cast<char*>(ptr);
+    new_segment.key      = key;
+    segment_of_key_[key] = new_segment.ptr;
+    segment              = &(segments_[new_segment.ptr] = std::move(new_segment));
+  }
+  CHECK_LE(handle->shared_offset + BlockSize(*handle), segment->size)
+      << "The shared array is out of its shared memory segment.";
+  ++segment->refs;
+  handle->shared_id = segment->shared_id;
+  handle->dptr      = segment->ptr + handle->shared_offset + alignment_;
+}
+
+void CPUSharedStorageManager::FreePooled(const Storage::Handle& handle) {
+  if (getpid() != pid_)
+    ForgetInheritedSegments();
+  Segment* segment = SegmentOf(handle.dptr);
+  // the blocks inherited from the parent process are left to it
+  if (segment == nullptr)
+    return;
+  const int count = DecrementRefCount(handle);
+  CHECK_GE(count, 0);
+  --segment->refs;
+  if (segment->owned) {
+    if (count == 0) {
+      ReleaseBlock(segment, handle.shared_offset, BlockSize(handle));
+    } else {
+      pending_.push_back(handle);
+    }
+    return;
+  }
+  if (segment->refs > 0)
+    return;
+  int idle = 0;
+  for (const auto& kv : segments_) {
+    idle += !kv.second.owned && kv.second.refs == 0;
+  }
+  if (idle > max_idle_segments_) {
+    char* ptr = segment->ptr;
+    UnmapSegment(segment);
+    segment_of_key_.erase(segment->key);
+    segments_.erase(ptr);
+  }
+}
+
+CPUSharedStorageManager::Segment* CPUSharedStorageManager::SegmentOf(const void* dptr) {
+  auto it = segments_.upper_bound(static_cast<char*>(const_cast<void*>(dptr)));
+  if (it == segments_.begin())
+    return nullptr;
+  --it;
+  return static_cast<const char*>(dptr) < it->first + it->second.size ? &it->second : nullptr;
+}
+
+void CPUSharedStorageManager::ReleaseBlock(Segment* segment, size_t offset, size_t size) {
+  auto& blocks = segment->free_blocks;
+  auto next    = blocks.lower_bound(offset);
+  // merge the block with the free blocks around it
+  if (next != blocks.end() && offset + size == next->first) {
+    size += next->second;
+    next = blocks.erase(next);
+  }
+  if (next != blocks.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == offset) {
+      prev->second += size;
+      return;
+    }
+  }
+  blocks.emplace_hint(next, offset, size);
+}
+
+void CPUSharedStorageManager::RecyclePending() {
+  auto end = std::remove_if(pending_.begin(), pending_.end(), [this](const Storage::Handle& h) {
+    auto* counter =
+        reinterpret_cast<std::atomic<int>*>(static_cast<char*>(h.dptr) - alignment_);
+    if (counter->load() != 0)
+      return false;
+    ReleaseBlock(SegmentOf(h.dptr), h.shared_offset, BlockSize(h));
+    return true;
+  });
+  pending_.erase(end, pending_.end());
+}
+
+void CPUSharedStorageManager::ForgetInheritedSegments() {
+  // the mappings are kept for the arrays inherited from the parent, which keeps the segments
+  segments_.clear();
+  segment_of_key_.clear();
+  pending_.clear();
+  pid_ = getpid();
+}
+
+void CPUSharedStorageManager::UnmapSegment(Segment* segment) {
+  CHECK_EQ(munmap(segment->ptr, segment->size), 0)
+      << "Failed to unmap shared memory. munmap failed with error " << strerror(errno);
+#ifdef __linux__
+  CHECK_EQ(close(segment->fd), 0) << "Failed to close shared memory. close failed with error "
+                                  << strerror(errno);
+#else
+  if (segment->owned) {
+    auto filename = SharedHandleToString(pid_, segment->shared_id);
+    CHECK_EQ(shm_unlink(filename.c_str()), 0)
+        << "Failed to unlink shared memory. shm_unlink failed with error " << strerror(errno);
+  }
+#endif  // __linux__
+}
+#endif  // _WIN32
+
 #ifdef _WIN32
 inline void CPUSharedStorageManager::CheckAndRealFree() {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
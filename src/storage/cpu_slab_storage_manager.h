@@ -0,0 +1,302 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cpu_slab_storage_manager.h
+ * \brief Size-class slab allocator with per-thread caches for CPU memory.
+ */
+#ifndef MXNET_STORAGE_CPU_SLAB_STORAGE_MANAGER_H_
+#define MXNET_STORAGE_CPU_SLAB_STORAGE_MANAGER_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "./storage_manager.h"
+
+namespace mxnet {
+namespace storage {
+
+/*!
+ * \brief Storage shared by all threads for one slab storage manager.
+ *  Free blocks of each size class are kept in batches on a lock-free stack,
+ *  threads move whole batches between their cache and the depot.
+ */
+class CPUSlabDepot {
+ public:
+  /*! \brief log2 of the smallest block, also the alignment of every block */
+  static constexpr size_t kMinClassLog2 = 6;
+  /*! \brief log2 of the largest block served from slabs */
+  static constexpr size_t kMaxClassLog2 = 20;
+  static constexpr size_t kNumClasses   = kMaxClassLog2 - kMinClassLog2 + 1;
+  /*! \brief target number of bytes moved per batch */
+  static constexpr size_t kBatchBytes = 1 << 18;
+  /*! \brief upper bound of blocks per batch */
+  static constexpr size_t kMaxBatchBlocks = 64;
+
+  /*! \brief header written into every free block */
+  struct FreeBlock {
+    FreeBlock* next;
+    /*! \brief only valid for the first block of a batch in the depot */
+    FreeBlock* next_batch;
+  };
+
+  CPUSlabDepot() = default;
+  ~CPUSlabDepot() {
+    for (void* slab : slabs_) {
+      common::AlignedMemFree(slab);
+    }
+  }
+
+  /*! \return size class of an allocation, kNumClasses if served directly */
+  static inline size_t SizeClass(size_t size) {
+    const size_t log2 = std::max(static_cast<size_t>(common::ilog2ul(size - 1)), kMinClassLog2);
+    return log2 > kMaxClassLog2 ? kNumClasses : log2 - kMinClassLog2;
+  }
+  static inline size_t BlockSize(size_t size_class) {
+    return size_t{1} << (size_class + kMinClassLog2);
+  }
+  static inline size_t BatchBlocks(size_t size_class) {
+    return std::min(std::max(kBatchBytes / BlockSize(size_class), size_t{1}), kMaxBatchBlocks);
+  }
+
+  /*!
+   * \brief Get a null-terminated batch of free blocks of a size class.
+   * \return nullptr if out of memory.
+   */
+  FreeBlock* PopBatch(size_t size_class) {
+    auto& head  = depot_[size_class];
+    uint64_t ol = head.load(std::memory_order_acquire);
+    while (Unpack(ol) != nullptr) {
+      // blocks are never returned to the system while the depot lives,
+      // so reading next_batch of a block popped concurrently is safe; the tag avoids ABA
+      uint64_t nw = Pack(Unpack(ol)->next_batch, ol);
+      if (head.compare_exchange_weak(ol, nw, std::memory_order_acq_rel)) {
+        return Unpack(ol);
+      }
+    }
+    return NewSlab(size_class);
+  }
+
+  /*! \brief Give a null-terminated batch of free blocks back to the depot */
+  void PushBatch(size_t size_class, FreeBlock* batch) {
+    auto& head  = depot_[size_class];
+    uint64_t ol = head.load(std::memory_order_relaxed);
+    uint64_t nw;
+    do {
+      batch->next_batch = Unpack(ol);
+      nw                = Pack(batch, ol);
+    } while (!head.compare_exchange_weak(ol, nw, std::memory_order_acq_rel));
+  }
+
+  /*! \return total bytes of slab memory obtained from the system */
+  size_t SlabBytes() const {
+    return slab_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  /*!
+   * \brief Stack heads are a pointer in the low kTagShift bits and a
+   *  modification counter in the high bits, so a single-word CAS suffices.
+   */
+  static constexpr int kTagShift     = 48;
+  static constexpr uint64_t kPtrMask = (uint64_t{1} << kTagShift) - 1;
+  static inline FreeBlock* Unpack(uint64_t head) {
+    return reinterpret_cast<FreeBlock*>(static_cast<uintptr_t>(head & kPtrMask));
+  }
+  static inline uint64_t Pack(FreeBlock* ptr, uint64_t prev_head) {
+    const uint64_t tag = (prev_head >> kTagShift) + 1;
+    return (static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr)) & kPtrMask) |
+           (tag << kTagShift);
+  }
+
+  FreeBlock* NewSlab(size_t size_class) {
+    const size_t block = BlockSize(size_class);
+    const size_t count = BatchBlocks(size_class);
+    void* slab         = nullptr;
+    if (!common::AlignedMemAlloc(&slab, block * count, std::max(block, size_t{4096}))) {
+      return nullptr;
+    }
+    {
+      std::lock_guard<std::mutex> lock(slab_mutex_);
+      slabs_.push_back(slab);
+    }
+    slab_bytes_.fetch_add(block * count, std::memory_order_relaxed);
+    auto* base = static_cast<char*>(slab);
+    for (size_t i = 0; i < count; ++i) {
+      auto* blk = reinterpret_cast<FreeBlock*>(base + i * block);
+      blk->next = i + 1 < count ? reinterpret_cast<FreeBlock*>(base + (i + 1) * block) : nullptr;
+    }
+    return reinterpret_cast<FreeBlock*>(base);
+  }
+
+  std::array<std::atomic<uint64_t>, kNumClasses> depot_{};
+  std::atomic<size_t> slab_bytes_{0};
+  /*! \brief protects slabs_, only taken when a new slab is carved */
+  std::mutex slab_mutex_;
+  std::vector<void*> slabs_;
+  DISALLOW_COPY_AND_ASSIGN(CPUSlabDepot);
+};
+
+/*!
+ * \brief CPU storage manager that serves small and medium allocations from
+ *  power-of-2 size classes. Each thread keeps a cache of free blocks per class,
+ *  so the common path takes no lock at all. Allocations larger than
+ *  2^kMaxClassLog2 bytes go directly to the system.
+ *  Every block is aligned to at least 64 bytes, as required by oneDNN and intgemm.
+ */
+class CPUSlabStorageManager final : public StorageManager {
+ public:
+  CPUSlabStorageManager() : depot_(std::make_shared<CPUSlabDepot>()) {}
+  ~CPUSlabStorageManager() override = default;
+
+  void Alloc(Storage::Handle* handle, bool failsafe) override {
+    const size_t size_class = CPUSlabDepot::SizeClass(handle->size);
+    if (size_class == CPUSlabDepot::kNumClasses) {
+      if (!common::AlignedMemAlloc(&handle->dptr, handle->size, kAlignment)) {
+        handle->dptr = nullptr;
+        if (!failsafe)
+          LOG(FATAL) << "Failed to allocate CPU Memory";
+      }
+      return;
+    }
+    ClassCache* cache = LocalCache(size_class);
+    if (cache == nullptr) {
+      // thread is shutting down, bypass the cache
+      CPUSlabDepot::FreeBlock* batch = depot_->PopBatch(size_class);
+      if (batch != nullptr && batch->next != nullptr)
+        depot_->PushBatch(size_class, batch->next);
+      handle->dptr = batch;
+    } else {
+      if (cache->head == nullptr) {
+        // batches flushed by exiting threads can have any length, so count them
+        cache->head = depot_->PopBatch(size_class);
+        cache->size = 0;
+        for (auto* blk = cache->head; blk != nullptr; blk = blk->next) {
+          ++cache->size;
+        }
+      }
+      handle->dptr = cache->head;
+      if (cache->head != nullptr) {
+        cache->head = cache->head->next;
+        --cache->size;
+      }
+    }
+    if (handle->dptr == nullptr && !failsafe)
+      LOG(FATAL) << "Failed to allocate CPU Memory";
+  }
+
+  void Free(Storage::Handle handle) override {
+    const size_t size_class = CPUSlabDepot::SizeClass(handle.size);
+    if (size_class == CPUSlabDepot::kNumClasses) {
+      common::AlignedMemFree(handle.dptr);
+      return;
+    }
+    auto* blk         = static_cast<CPUSlabDepot::FreeBlock*>(handle.dptr);
+    ClassCache* cache = LocalCache(size_class);
+    if (cache == nullptr) {
+      blk->next = nullptr;
+      depot_->PushBatch(size_class, blk);
+      return;
+    }
+    blk->next   = cache->head;
+    cache->head = blk;
+    const size_t batch = CPUSlabDepot::BatchBlocks(size_class);
+    if (++cache->size >= 2 * batch) {
+      // keep one batch locally and give the other one back
+      CPUSlabDepot::FreeBlock* tail = cache->head;
+      for (size_t i = 1; i < batch; ++i) {
+        tail = tail->next;
+      }
+      depot_->PushBatch(size_class, tail->next);
+      tail->next  = nullptr;
+      cache->size = batch;
+    }
+  }
+
+  void DirectFree(Storage::Handle handle) override {
+    // slabs are only released as a whole, so small blocks just go back to the pool
+    Free(handle);
+  }
+
+ private:
+  /*! \brief free list of one size class in a thread cache */
+  struct ClassCache {
+    CPUSlabDepot::FreeBlock* head{nullptr};
+    size_t size{0};
+  };
+  /*! \brief caches of one thread for one depot */
+  struct DepotCache {
+    std::shared_ptr<CPUSlabDepot> depot;
+    std::array<ClassCache, CPUSlabDepot::kNumClasses> classes;
+  };
+  /*! \brief all caches of one thread, flushed back to their depots on thread exit */
+  struct ThreadCaches {
+    explicit ThreadCaches(bool* destroyed) : destroyed_(destroyed) {}
+    ~ThreadCaches() {
+      for (auto& dc : caches) {
+        for (size_t c = 0; c < CPUSlabDepot::kNumClasses; ++c) {
+          if (dc.classes[c].head != nullptr)
+            dc.depot->PushBatch(c, dc.classes[c].head);
+        }
+      }
+      *destroyed_ = true;
+    }
+    std::vector<DepotCache> caches;
+
+   private:
+    bool* destroyed_;
+  };
+
+  ClassCache* LocalCache(size_t size_class) {
+    // trivially destructible, so it stays valid while other thread locals are destroyed
+    static thread_local bool destroyed = false;
+    if (destroyed)
+      return nullptr;
+    static thread_local ThreadCaches thread_caches(&destroyed);
+    for (auto& dc : thread_caches.caches) {
+      if (dc.depot == depot_)
+        return &dc.classes[size_class];
+    }
+    thread_caches.caches.emplace_back();
+    thread_caches.caches.back().depot = depot_;
+    return &thread_caches.caches.back().classes[size_class];
+  }
+
+#if MXNET_USE_ONEDNN == 1 || MXNET_USE_INTGEMM == 1
+  static constexpr size_t kAlignment = kDNNLAlign;
+#else
+  static constexpr size_t kAlignment = 16;
+#endif
+  static_assert(kAlignment <= (size_t{1} << CPUSlabDepot::kMinClassLog2),
+                "slab blocks must satisfy the CPU storage alignment");
+
+  /*! \brief shared with the thread caches, which may outlive this manager */
+  std::shared_ptr<CPUSlabDepot> depot_;
+  DISALLOW_COPY_AND_ASSIGN(CPUSlabStorageManager);
+};  // class CPUSlabStorageManager
+
+}  // namespace storage
+}  // namespace mxnet
+
+#endif  // MXNET_STORAGE_CPU_SLAB_STORAGE_MANAGER_H_
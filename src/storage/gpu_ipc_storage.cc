@@ -0,0 +1,107 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file gpu_ipc_storage.cc
+ * \brief implementation of the GPU memory shared between processes
+ */
+#include <mxnet/storage.h>
+#include <cstring>
+#include "./gpu_ipc_storage.h"
+#include "../common/cuda/utils.h"
+#include "../profiler/storage_profiler.h"
+#include "./gpu_device_storage.h"
+
+namespace mxnet {
+namespace storage {
+
+GPUIpcStorage* GPUIpcStorage::Get() {
+  static GPUIpcStorage storage;
+  return &storage;
+}
+
+#if MXNET_USE_CUDA
+static_assert(sizeof(cudaIpcMemHandle_t) == kGPUIpcHandleSize,
+              "Unexpected size of the CUDA IPC memory handles");
+
+void GPUIpcStorage::Export(const NDArray& arr, char* handle) {
+  CHECK_EQ(arr.ctx().dev_mask(), gpu::kDevMask) << "Only the arrays on a GPU can be exported";
+  CHECK_EQ(arr.storage_type(), kDefaultStorage) << "Only the dense arrays can be exported";
+  Storage::Handle shandle;
+  shandle.ctx  = arr.ctx();
+  shandle.size = arr.shape().Size() * mshadow::mshadow_sizeof(arr.dtype());
+  GPUDeviceStorage::Alloc(&shandle);
+  const int dev_id = arr.ctx().dev_id;
+  NDArray copy(TBlob(shandle.dptr, arr.shape(), gpu::kDevMask, arr.dtype(), dev_id),
+               dev_id,
+               [shandle]() { GPUDeviceStorage::Free(shandle); });
+  CopyFromTo(arr, &copy);
+  copy.WaitToRead();
+  cudaIpcMemHandle_t ipc_handle;
+  {
+    mxnet::common::cuda::DeviceStore device_store(dev_id);
+    CUDA_CALL(cudaIpcGetMemHandle(&ipc_handle, shandle.dptr));
+  }
+  std::memcpy(handle, &ipc_handle, kGPUIpcHandleSize);
+  std::lock_guard<std::mutex> lock(mutex_);
+  exported_.emplace(std::string(handle, kGPUIpcHandleSize), copy);
+}
+
+void GPUIpcStorage::Release(const char* handle) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CHECK(exported_.erase(std::string(handle, kGPUIpcHandleSize)))
+      << "The CUDA IPC handle was not exported by this process";
+}
+
+NDArray GPUIpcStorage::Import(const char* handle,
+                              const mxnet::TShape& shape,
+                              int dtype,
+                              int dev_id) {
+  cudaIpcMemHandle_t ipc_handle;
+  std::memcpy(&ipc_handle, handle, kGPUIpcHandleSize);
+  void* dptr;
+  {
+    mxnet::common::cuda::DeviceStore device_store(dev_id);
+    CUDA_CALL(cudaIpcOpenMemHandle(&dptr, ipc_handle, cudaIpcMemLazyEnablePeerAccess));
+  }
+  return NDArray(TBlob(dptr, shape, gpu::kDevMask, dtype, dev_id), dev_id, [dptr, dev_id]() {
+    mxnet::common::cuda::DeviceStore device_store(dev_id);
+    CUDA_CALL(cudaIpcCloseMemHandle(dptr));
+  });
+}
+#else
+void GPUIpcStorage::Export(const NDArray& arr, char* handle) {
+  LOG(FATAL) << "Compile with USE_CUDA=1 to share GPU memory between processes.";
+}
+
+void GPUIpcStorage::Release(const char* handle) {
+  LOG(FATAL) << "Compile with USE_CUDA=1 to share GPU memory between processes.";
+}
+
+NDArray GPUIpcStorage::Import(const char* handle,
+                              const mxnet::TShape& shape,
+                              int dtype,
+                              int dev_id) {
+  LOG(FATAL) << "Compile with USE_CUDA=1 to share GPU memory between processes.";
+  return NDArray();
+}
+#endif  // MXNET_USE_CUDA
+
+}  // namespace storage
+}  // namespace mxnet
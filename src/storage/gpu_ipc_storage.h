@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file gpu_ipc_storage.h
+ * \brief GPU memory shared between processes through CUDA IPC, the GPU counterpart of the CPU
+ *        shared memory of CPUSharedStorageManager.
+ */
+#ifndef MXNET_STORAGE_GPU_IPC_STORAGE_H_
+#define MXNET_STORAGE_GPU_IPC_STORAGE_H_
+
+#include <mxnet/ndarray.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace mxnet {
+namespace storage {
+
+/*! \brief bytes of a CUDA IPC memory handle */
+constexpr size_t kGPUIpcHandleSize = 64;
+
+/*!
+ * \brief Exports the arrays of a process holding them, e.g. a sidecar keeping the parameters of
+ *        the served models, to the processes mapping them without reading them again.
+ *        An exported array is a copy in an allocation of its own, since the handles of CUDA IPC
+ *        are given for whole allocations and the arrays of the pools share theirs.
+ */
+class GPUIpcStorage {
+ public:
+  static GPUIpcStorage* Get();
+  /*!
+   * \brief Exports a copy of a GPU array, kept until the handle is released.
+   * \param arr the array, on a GPU
+   * \param handle the kGPUIpcHandleSize bytes of the handle of the copy
+   */
+  void Export(const NDArray& arr, char* handle);
+  /*! \brief frees the copy of an exported handle, the processes mapping it must be done */
+  void Release(const char* handle);
+  /*!
+   * \brief Maps an array exported by another process. The array is read only, and is valid
+   *        until the exporting process releases it.
+   */
+  static NDArray Import(const char* handle, const mxnet::TShape& shape, int dtype, int dev_id);
+
+ private:
+  std::mutex mutex_;
+  /*! \brief the exported copies by their handles */
+  std::unordered_map<std::string, NDArray> exported_;
+};
+
+}  // namespace storage
+}  // namespace mxnet
+#endif  // MXNET_STORAGE_GPU_IPC_STORAGE_H_
@@ -0,0 +1,232 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file pinned_ring_storage_manager.h
+ * \brief Ring buffer allocator for pinned host memory.
+ */
+#ifndef MXNET_STORAGE_PINNED_RING_STORAGE_MANAGER_H_
+#define MXNET_STORAGE_PINNED_RING_STORAGE_MANAGER_H_
+
+#if MXNET_USE_CUDA
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "./storage_manager.h"
+#include "./pinned_memory_storage.h"
+
+namespace mxnet {
+namespace storage {
+
+/*!
+ * \brief Storage manager for pinned host memory that serves allocations from
+ *  one pinned arena, registered once, used as a ring buffer. Input pipelines
+ *  allocate and free staging batches in roughly FIFO order, so the space of the
+ *  oldest batches is reclaimed and pinned pages are recycled without calling
+ *  cudaHostAlloc or cudaFreeHost.
+ *
+ *  A freed block is only reclaimed once the events of its last users have
+ *  completed, so a batch can be freed as soon as its asynchronous host-to-device
+ *  copy was enqueued on a copy stream. Requests that do not fit in the ring
+ *  fall back to individually pinned buffers, which are cached by size.
+ *  The manager has its own lock and does not take the global storage mutex.
+ */
+class PinnedRingStorageManager final : public StorageManager {
+ public:
+  PinnedRingStorageManager() {
+    ring_size_ = RoundUp(
+        dmlc::GetEnv("MXNET_CPU_PINNED_MEM_POOL_RING_SIZE", size_t{64} << 20), kAlignment);
+  }
+  ~PinnedRingStorageManager() override {
+    ReleaseAll();
+    if (arena_.dptr != nullptr)
+      PinnedMemoryStorage::Free(arena_);
+  }
+
+  void Alloc(Storage::Handle* handle, bool failsafe) override {
+    const size_t size = RoundUp(handle->size, kAlignment);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (arena_.dptr == nullptr) {
+      arena_.ctx  = handle->ctx;
+      arena_.size = ring_size_;
+      PinnedMemoryStorage::Alloc(&arena_, failsafe);
+      if (arena_.dptr == nullptr)
+        ring_size_ = 0;
+    }
+    handle->dptr = size <= ring_size_ ? AllocFromRing(size) : nullptr;
+    if (handle->dptr == nullptr)
+      AllocOverflow(handle, size, failsafe);
+  }
+
+  void Free(Storage::Handle handle) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = blocks_.find(handle.dptr);
+    if (it != blocks_.end()) {
+      it->second->freed    = true;
+      it->second->sync_obj = std::move(handle.sync_obj);
+      blocks_.erase(it);
+      Reclaim(false);
+    } else {
+      overflow_cache_[RoundUp(handle.size, kAlignment)].emplace_back(handle.dptr,
+                                                                     std::move(handle.sync_obj));
+    }
+  }
+
+  void DirectFree(Storage::Handle handle) override {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (blocks_.count(handle.dptr)) {
+      lock.unlock();
+      // ring space is reclaimed in order anyway
+      Free(handle);
+      return;
+    }
+    lock.unlock();
+    Sync(handle.sync_obj);
+    PinnedMemoryStorage::Free(handle);
+  }
+
+  void ReleaseAll() override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& kv : overflow_cache_) {
+      for (auto& buf : kv.second) {
+        Storage::Handle h;
+        h.dptr = buf.first;
+        h.size = kv.first;
+        h.ctx  = arena_.ctx;
+        Sync(buf.second);
+        PinnedMemoryStorage::Free(h);
+      }
+    }
+    overflow_cache_.clear();
+  }
+
+ private:
+  /*! \brief granularity of block sizes and offsets */
+  static constexpr size_t kAlignment = 256;
+  /*! \brief an allocation in the ring, kept in allocation order */
+  struct Block {
+    size_t offset;
+    size_t size;
+    bool freed;
+    /*! \brief events of the last users, valid once freed */
+    Storage::SyncObj sync_obj;
+  };
+
+  static inline size_t RoundUp(size_t x, size_t multiple) {
+    return (x + multiple - 1) / multiple * multiple;
+  }
+  /*! \return whether all events of a sync object have completed */
+  static bool Completed(const Storage::SyncObj& sync_obj) {
+    for (const auto& ev : sync_obj.events) {
+      if (auto valid_ev = ev.lock()) {
+        if (cudaEventQuery(*valid_ev) == cudaErrorNotReady)
+          return false;
+      }
+    }
+    return true;
+  }
+  static void Sync(const Storage::SyncObj& sync_obj) {
+    for (const auto& ev : sync_obj.events) {
+      if (auto valid_ev = ev.lock()) {
+        MSHADOW_CUDA_CALL(cudaEventSynchronize(*valid_ev));
+      }
+    }
+  }
+  /*!
+   * \brief pop the oldest blocks that are freed and no longer used by the device
+   * \param blocking whether to wait for the events of the oldest freed block
+   */
+  void Reclaim(bool blocking) {
+    while (!ring_.empty() && ring_.front().freed) {
+      if (blocking) {
+        Sync(ring_.front().sync_obj);
+      } else if (!Completed(ring_.front().sync_obj)) {
+        break;
+      }
+      ring_.pop_front();
+    }
+    if (ring_.empty())
+      head_ = 0;
+  }
+  /*! \return offset of a free range of the ring, or ring_size_ if none */
+  size_t FindSpace(size_t size) const {
+    if (ring_.empty())
+      return 0;
+    const size_t tail = ring_.front().offset;
+    if (head_ > tail) {
+      // used space is [tail, head_), free space at the end and before tail
+      if (ring_size_ - head_ >= size)
+        return head_;
+      return size <= tail ? 0 : ring_size_;
+    }
+    // wrapped around, used space is [tail, end) and [0, head_)
+    return tail - head_ >= size ? head_ : ring_size_;
+  }
+  void* AllocFromRing(size_t size) {
+    Reclaim(false);
+    size_t offset = FindSpace(size);
+    // freed blocks in front may only wait for their events
+    while (offset == ring_size_ && !ring_.empty() && ring_.front().freed) {
+      Reclaim(true);
+      offset = FindSpace(size);
+    }
+    if (offset == ring_size_)
+      return nullptr;
+    ring_.push_back(Block{offset, size, false, {}});
+    head_     = offset + size;
+    void* ptr = static_cast<char*>(arena_.dptr) + offset;
+    blocks_.emplace(ptr, &ring_.back());
+    return ptr;
+  }
+  void AllocOverflow(Storage::Handle* handle, size_t size, bool failsafe) {
+    auto it = overflow_cache_.find(size);
+    if (it != overflow_cache_.end() && !it->second.empty()) {
+      handle->dptr = it->second.back().first;
+      Sync(it->second.back().second);
+      it->second.pop_back();
+      return;
+    }
+    Storage::Handle h = *handle;
+    h.size            = size;
+    PinnedMemoryStorage::Alloc(&h, failsafe);
+    handle->dptr = h.dptr;
+  }
+
+  std::mutex mutex_;
+  /*! \brief the pinned memory serving the ring */
+  Storage::Handle arena_;
+  size_t ring_size_;
+  /*! \brief offset where the next block is placed */
+  size_t head_{0};
+  /*! \brief blocks in allocation order, references stay valid on push_back and pop_front */
+  std::deque<Block> ring_;
+  /*! \brief blocks in use by their address */
+  std::unordered_map<void*, Block*> blocks_;
+  /*! \brief free pinned buffers outside of the ring, by size */
+  std::unordered_map<size_t, std::vector<std::pair<void*, Storage::SyncObj>>> overflow_cache_;
+  DISALLOW_COPY_AND_ASSIGN(PinnedRingStorageManager);
+};  // class PinnedRingStorageManager
+
+}  // namespace storage
+}  // namespace mxnet
+
+#endif  // MXNET_USE_CUDA
+#endif  // MXNET_STORAGE_PINNED_RING_STORAGE_MANAGER_H_
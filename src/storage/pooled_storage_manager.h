@@ -28,9 +28,11 @@
 #include <vector>
 #include <algorithm>
 #include <mutex>
+#include <sstream>
 #include <tuple>
 #include <utility>
 #include "./storage_manager.h"
+#include "../profiler/metrics.h"
 #include "../profiler/storage_profiler.h"
 
 namespace mxnet {
@@ -118,11 +120,14 @@ class PooledStorageManager : public StorageManager, public BucketingStrategy, pu
       const size_t total       = std::get<1>(contextHelper_->getMemoryInfo());
       memory_allocation_limit_ = total * reserve / 100;
     }
+    metrics_collector_ = profiler::Metrics::Get()->AddCollector(
+        [this, ctx](profiler::MetricsWriter* writer) { WriteMetrics(ctx, writer); });
   }
   /*!
    * \brief Default destructor.
    */
   ~PooledStorageManager() override {
+    profiler::Metrics::Get()->RemoveCollector(metrics_collector_);
     ReleaseAll();
   }
 
@@ -132,6 +137,7 @@ class PooledStorageManager : public StorageManager, public BucketingStrategy, pu
     std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
     StoringMethod::InsertInCache(
         BucketingStrategy::get_bucket(handle.size), handle.dptr, handle.sync_obj);
+    cached_memory_ += BucketingStrategy::RoundAllocSize(handle.size);
   }
 
   void DirectFree(Storage::Handle handle) override {
@@ -149,13 +155,33 @@ class PooledStorageManager : public StorageManager, public BucketingStrategy, pu
     ReleaseAllNoLock();
   }
 
+  size_t CachedBytes() override {
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    return cached_memory_;
+  }
+
  private:
   void ReleaseAllNoLock(bool set_device = true) {
     SET_DEVICE(device_store, contextHelper_, contextHelper_->initilal_context(), set_device);
     used_memory_ -= StoringMethod::ReleaseAllNoLock(contextHelper_.get(), this);
+    cached_memory_ = 0;
     UNSET_DEVICE(device_store);
   }
 
+  void WriteMetrics(const Context& ctx, profiler::MetricsWriter* writer) {
+    std::ostringstream device;
+    device << ctx;
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    writer->Gauge("mxnet_storage_used_bytes",
+                  "Bytes of a memory pool handed out to arrays.",
+                  {{"device", device.str()}},
+                  used_memory_ - cached_memory_);
+    writer->Gauge("mxnet_storage_cached_bytes",
+                  "Bytes of a memory pool freed by arrays and kept for reuse.",
+                  {{"device", device.str()}},
+                  cached_memory_);
+  }
+
   bool MemoryIsAvailable(size_t roundSize) const {
     const auto free = contextHelper_->freeMemorySize();
     return free > roundSize && memory_allocation_limit_ <= free - roundSize;
@@ -163,8 +189,12 @@ class PooledStorageManager : public StorageManager, public BucketingStrategy, pu
 
   // device type of used context
   Context::DeviceType dev_type_;
-  // used memory
+  // memory allocated from the device, in use or cached
   size_t used_memory_ = 0;
+  // memory in the pool waiting to be reused
+  size_t cached_memory_ = 0;
+  // id of the collector reporting the pool sizes to the metrics
+  uint64_t metrics_collector_ = 0;
   // minimum amount of memory, which will never be allocated
   size_t memory_allocation_limit_ = 0;
   // Pointer to the Helper, supporting some context-specific operations in GPU/CPU/CPUPinned context
@@ -224,15 +254,23 @@ void PooledStorageManager<BucketingStrategy, StoringMethod>::Alloc(Storage::Hand
     if (dev_type_ == Context::kGPU) {
       handle->sync_obj = ptr_syncobj.second;
 #if MXNET_USE_CUDA
-      for (auto ev : handle->sync_obj.events) {
-        auto valid_ev = ev.lock();
-        if (valid_ev) {
-          MSHADOW_CUDA_CALL(cudaEventSynchronize(*valid_ev));
+      // In stream-ordered mode the caller turns the events into device-side waits,
+      // which is only possible when we know the stream each event was recorded on.
+      const bool defer_sync = handle->stream_ordered && handle->sync_obj.event_streams.size() ==
+                                                            handle->sync_obj.events.size();
+      if (!defer_sync) {
+        for (auto ev : handle->sync_obj.events) {
+          auto valid_ev = ev.lock();
+          if (valid_ev) {
+            MSHADOW_CUDA_CALL(cudaEventSynchronize(*valid_ev));
+          }
         }
+        handle->sync_obj = Storage::SyncObj();
       }
 #endif
     }
     reuse_pool->pop_back();
+    cached_memory_ -= BucketingStrategy::RoundAllocSizeForBucket(bucket_id);
   }
 #if MXNET_USE_CUDA
   SET_GPU_PROFILER(profilerGPU, contextHelper_);
@@ -21,10 +21,13 @@
 #include "./storage_manager.h"
 #include "./naive_storage_manager.h"
 #include "./pooled_storage_manager.h"
+#include "./best_fit_storage_manager.h"
 #include "./cpu_shared_storage_manager.h"
+#include "./cpu_slab_storage_manager.h"
 #include "./cpu_device_storage.h"
 #include "./gpu_device_storage.h"
 #include "./pinned_memory_storage.h"
+#include "./pinned_ring_storage_manager.h"
 #include "../common/lazy_alloc_array.h"
 #include "../profiler/storage_profiler.h"
 
@@ -38,7 +41,10 @@ class StorageImpl : public Storage {
   void Free(Handle handle) override;
   void DirectFree(Handle handle) override;
   void ReleaseAll(Context ctx) override {
-    storage_manager(ctx)->ReleaseAll();
+    auto manager = storage_manager(ctx);
+    manager->ReleaseAll();
+    if (profiler::MemoryTimeline::IsProfiling())
+      profiler::MemoryTimeline::Get()->OnCached(ctx, manager->CachedBytes());
   }
 
   void SharedIncrementRefCount(Handle handle) override;
@@ -77,6 +83,23 @@ StorageManager* CreateStorageManager(const Context& ctx,
     ptr = new PooledStorageManager<RoundPower2, VectorContainer>(ctx, num_gpu_device);
   } else if (*pStrategy == "Naive") {
     ptr = new PooledStorageManager<RoundMultiple, UnorderedMapContainer>(ctx, num_gpu_device);
+  } else if (*pStrategy == "BestFit") {
+    ptr = new BestFitStorageManager(ctx, num_gpu_device);
+  } else if (*pStrategy == "Slab") {
+    if (ctx.dev_type == Context::kCPU || num_gpu_device == 0) {
+      ptr = new CPUSlabStorageManager();
+    } else {
+      LOG(FATAL) << "Memory pool strategy Slab is only available for CPU memory, check "
+                 << env_var;
+    }
+  } else if (*pStrategy == "Ring") {
+#if MXNET_USE_CUDA
+    if (ctx.dev_type == Context::kCPUPinned && num_gpu_device > 0)
+      ptr = new PinnedRingStorageManager();
+#endif
+    if (ptr == nullptr)
+      LOG(FATAL) << "Memory pool strategy Ring is only available for pinned CPU memory, check "
+                 << env_var;
   } else if (*pStrategy == "Unpooled") {
     if (ctx.dev_type == Context::kCPU || num_gpu_device == 0)
       ptr = new NaiveStorageManager<CPUDeviceStorage>();
@@ -205,8 +228,11 @@ void StorageImpl::Alloc(Storage::Handle* handle, bool failsafe) {
   });
 
   manager->Alloc(handle, failsafe);
-  if (!failsafe || handle->dptr != nullptr)
+  if (!failsafe || handle->dptr != nullptr) {
     profiler_.OnAlloc(*handle);
+    if (profiler::MemoryTimeline::IsProfiling())
+      profiler::MemoryTimeline::Get()->OnAlloc(*handle, manager->CachedBytes());
+  }
 }
 
 void StorageImpl::Free(Storage::Handle handle) {
@@ -215,8 +241,11 @@ void StorageImpl::Free(Storage::Handle handle) {
   if (handle.dptr == nullptr)
     return;
 
-  storage_manager(handle.ctx)->Free(handle);
+  auto manager = storage_manager(handle.ctx);
+  manager->Free(handle);
   profiler_.OnFree(handle);
+  if (profiler::MemoryTimeline::IsProfiling())
+    profiler::MemoryTimeline::Get()->OnFree(handle, manager->CachedBytes());
 }
 
 void StorageImpl::DirectFree(Storage::Handle handle) {
@@ -225,8 +254,11 @@ void StorageImpl::DirectFree(Storage::Handle handle) {
   if (handle.dptr == nullptr)
     return;
 
-  storage_manager(handle.ctx)->DirectFree(handle);
+  auto manager = storage_manager(handle.ctx);
+  manager->DirectFree(handle);
   profiler_.OnFree(handle);
+  if (profiler::MemoryTimeline::IsProfiling())
+    profiler::MemoryTimeline::Get()->OnFree(handle, manager->CachedBytes());
 }
 
 void StorageImpl::SharedIncrementRefCount(Storage::Handle handle) {
@@ -60,6 +60,12 @@ class StorageManager {
    * For non-pool memory managers this has no effect.
    */
   virtual void ReleaseAll() {}
+  /*!
+   * \brief Bytes freed by users and kept by a pool storage manager for reuse, 0 otherwise
+   */
+  virtual size_t CachedBytes() {
+    return 0;
+  }
   /*!
    * \brief Destructor.
    */
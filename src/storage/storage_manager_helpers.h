@@ -42,6 +42,7 @@ typedef mxnet::common::cuda::DeviceStore CudaDeviceStore;
 #endif  // _WIN32
 
 #include <tuple>
+#include "../common/numa.h"
 #include "../common/utils.h"
 
 namespace mxnet {
@@ -122,6 +123,11 @@ class ContextHelperCPU : public ContextHelper {
 
   int Malloc(void** ppNtr, size_t size) const override {
     bool success = mxnet::common::AlignedMemAlloc(ppNtr, size, alignment_);
+    if (success && initilal_context().dev_type == Context::kCPU) {
+      // with MXNET_CPU_NUMA=1, memory of cpu(n) is placed on NUMA node n
+      const int node = common::NumaTopology::Get()->NodeOfDevice(initilal_context().dev_id);
+      common::NumaBindMemory(*ppNtr, size, node);
+    }
     return success ? 0 : -1;
   }
 
@@ -0,0 +1,301 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file engine_perf_test.cc
+ * \brief microbenchmarks of the engine overhead: pushes, dependency tracking,
+ *  waits and bulking, with operations that do no work.
+ *
+ *  Run with --perf for the full sizes and --csv for machine-readable output, e.g.
+ *  mxnet_unit_tests --gtest_filter='EnginePerf.*' --perf --csv
+ */
+#include <dmlc/logging.h>
+#include <gtest/gtest.h>
+#include <mxnet/engine.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../src/engine/engine_impl.h"
+#include "../include/test_util.h"
+
+namespace {
+
+using mxnet::Context;
+using mxnet::Engine;
+using mxnet::RunContext;
+using Clock = std::chrono::steady_clock;
+
+double ElapsedUs(Clock::time_point start, Clock::time_point end = Clock::now()) {
+  return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+/*! \brief all engine types, created once and shared by the benchmarks */
+const std::vector<std::pair<std::string, Engine*>>& Engines() {
+  static const std::vector<std::pair<std::string, Engine*>> engines = {
+      {"NaiveEngine", mxnet::engine::CreateNaiveEngine()},
+      {"ThreadedEnginePooled", mxnet::engine::CreateThreadedEnginePooled()},
+      {"ThreadedEnginePerDevice", mxnet::engine::CreateThreadedEnginePerDevice()},
+      {"ThreadedEngineWorkStealing", mxnet::engine::CreateThreadedEngineWorkStealing()}};
+  return engines;
+}
+
+/*! \brief number of operations of each benchmark */
+int NumOps() {
+  return mxnet::test::performance_run ? 100000 : mxnet::test::quick_test ? 1000 : 10000;
+}
+
+void Report(const std::string& benchmark,
+            const std::string& engine,
+            const std::string& metric,
+            double value,
+            const char* unit) {
+  if (mxnet::test::csv) {
+    printf("%s,%s,%s,%.4f,%s\n", benchmark.c_str(), engine.c_str(), metric.c_str(), value, unit);
+  } else {
+    LOG(INFO) << benchmark << "\t" << engine << "\t" << metric << ": " << value << " " << unit;
+  }
+}
+
+/*! \brief median and 99th percentile of latency samples */
+void ReportLatency(const std::string& benchmark,
+                   const std::string& engine,
+                   std::vector<double>* samples) {
+  std::sort(samples->begin(), samples->end());
+  Report(benchmark, engine, "p50", (*samples)[samples->size() / 2], "us");
+  Report(benchmark, engine, "p99", (*samples)[samples->size() * 99 / 100], "us");
+}
+
+std::vector<Engine::VarHandle> NewVariables(Engine* engine, size_t n) {
+  std::vector<Engine::VarHandle> vars(n);
+  for (auto& var : vars) {
+    var = engine->NewVariable();
+  }
+  return vars;
+}
+
+void DeleteVariables(Engine* engine, const std::vector<Engine::VarHandle>& vars) {
+  for (auto var : vars) {
+    engine->DeleteVariable([](RunContext) {}, Context::CPU(), var);
+  }
+  engine->WaitForAll();
+}
+
+/*! \brief push an operation that does nothing but count its runs */
+void PushNoop(Engine* engine,
+              std::atomic<int>* counter,
+              std::vector<Engine::VarHandle> const& const_vars,
+              std::vector<Engine::VarHandle> const& mutable_vars) {
+  engine->PushAsync(
+      [counter](RunContext, Engine::CallbackOnStart on_start, Engine::CallbackOnComplete cb) {
+        on_start();
+        counter->fetch_add(1, std::memory_order_relaxed);
+        cb();
+      },
+      Context::CPU(),
+      const_vars,
+      mutable_vars);
+}
+
+}  // namespace
+
+/*!
+ * \brief independent operations: the rate at which the host pushes them, which is what
+ *  the engine costs the Python thread, and the rate at which they complete.
+ */
+TEST(EnginePerf, PushThroughput) {
+  const int num_ops = NumOps();
+  for (const auto& entry : Engines()) {
+    Engine* engine = entry.second;
+    auto vars      = NewVariables(engine, 64);
+    std::atomic<int> counter{0};
+    const auto start = Clock::now();
+    for (int i = 0; i < num_ops; ++i) {
+      PushNoop(engine, &counter, {}, {vars[i % vars.size()]});
+    }
+    const double push_us = ElapsedUs(start);
+    engine->WaitForAll();
+    const double total_us = ElapsedUs(start);
+    EXPECT_EQ(counter.load(), num_ops);
+    Report("PushThroughput", entry.first, "push rate", num_ops / push_us, "Mops/s");
+    Report("PushThroughput", entry.first, "completion rate", num_ops / total_us, "Mops/s");
+    Report("PushThroughput", entry.first, "per op", total_us / num_ops, "us");
+    DeleteVariables(engine, vars);
+  }
+}
+
+/*!
+ * \brief latency of a single operation on an idle engine, from the push to its start on the
+ *  worker and from the push to the return of WaitForVar.
+ */
+TEST(EnginePerf, PushLatency) {
+  const int num_ops = NumOps() / 10;
+  for (const auto& entry : Engines()) {
+    Engine* engine = entry.second;
+    auto var       = engine->NewVariable();
+    std::vector<double> to_start, round_trip;
+    to_start.reserve(num_ops);
+    round_trip.reserve(num_ops);
+    for (int i = 0; i < num_ops; ++i) {
+      Clock::time_point started;
+      const auto start = Clock::now();
+      engine->PushAsync(
+          [&started](RunContext, Engine::CallbackOnStart on_start, Engine::CallbackOnComplete cb) {
+            on_start();
+            started = Clock::now();
+            cb();
+          },
+          Context::CPU(),
+          {},
+          {var});
+      engine->WaitForVar(var);
+      round_trip.push_back(ElapsedUs(start));
+      to_start.push_back(ElapsedUs(start, started));
+    }
+    ReportLatency("PushLatency push to start", entry.first, &to_start);
+    ReportLatency("PushLatency push to wait return", entry.first, &round_trip);
+    DeleteVariables(engine, {var});
+  }
+}
+
+/*!
+ * \brief a chain of operations mutating the same variable, so that every completion has
+ *  to dispatch the next one: the cost of the dependency resolution per link.
+ */
+TEST(EnginePerf, DependencyChain) {
+  const int num_ops = NumOps();
+  for (const auto& entry : Engines()) {
+    Engine* engine = entry.second;
+    auto vars      = NewVariables(engine, 2);
+    std::atomic<int> counter{0};
+    const auto start = Clock::now();
+    for (int i = 0; i < num_ops; ++i) {
+      // alternate reads and writes so that both kinds of dependencies are resolved
+      if (i % 2) {
+        PushNoop(engine, &counter, {vars[0]}, {vars[1]});
+      } else {
+        PushNoop(engine, &counter, {vars[1]}, {vars[0]});
+      }
+    }
+    engine->WaitForAll();
+    const double total_us = ElapsedUs(start);
+    EXPECT_EQ(counter.load(), num_ops);
+    Report("DependencyChain", entry.first, "per link", total_us / num_ops, "us");
+    DeleteVariables(engine, vars);
+  }
+}
+
+/*!
+ * \brief fan-out, one writer followed by many readers of its output, and fan-in, many
+ *  writers followed by one reader of all their outputs.
+ */
+TEST(EnginePerf, FanInFanOut) {
+  const int width      = 32;
+  const int num_rounds = std::max(NumOps() / (width + 1), 1);
+  for (const auto& entry : Engines()) {
+    Engine* engine = entry.second;
+    auto source    = NewVariables(engine, 1);
+    auto outputs   = NewVariables(engine, width);
+    std::atomic<int> counter{0};
+
+    auto start = Clock::now();
+    for (int round = 0; round < num_rounds; ++round) {
+      PushNoop(engine, &counter, {}, source);
+      for (int i = 0; i < width; ++i) {
+        PushNoop(engine, &counter, source, {outputs[i]});
+      }
+    }
+    engine->WaitForAll();
+    Report("FanOut", entry.first, "per round", ElapsedUs(start) / num_rounds, "us");
+
+    start = Clock::now();
+    for (int round = 0; round < num_rounds; ++round) {
+      for (int i = 0; i < width; ++i) {
+        PushNoop(engine, &counter, {}, {outputs[i]});
+      }
+      PushNoop(engine, &counter, outputs, source);
+    }
+    engine->WaitForAll();
+    Report("FanIn", entry.first, "per round", ElapsedUs(start) / num_rounds, "us");
+    EXPECT_EQ(counter.load(), 2 * num_rounds * (width + 1));
+
+    DeleteVariables(engine, source);
+    DeleteVariables(engine, outputs);
+  }
+}
+
+/*!
+ * \brief WaitForVar on a variable with nothing pending, the cost paid by every
+ *  synchronous read of an array that is ready.
+ */
+TEST(EnginePerf, WaitForVarReady) {
+  const int num_waits = NumOps();
+  for (const auto& entry : Engines()) {
+    Engine* engine = entry.second;
+    auto var       = engine->NewVariable();
+    std::vector<double> samples;
+    samples.reserve(num_waits);
+    for (int i = 0; i < num_waits; ++i) {
+      const auto start = Clock::now();
+      engine->WaitForVar(var);
+      samples.push_back(ElapsedUs(start));
+    }
+    ReportLatency("WaitForVarReady", entry.first, &samples);
+    DeleteVariables(engine, {var});
+  }
+}
+
+/*!
+ * \brief synchronous operations pushed with and without bulking, bulked operations are
+ *  executed as one engine operation.
+ */
+TEST(EnginePerf, BulkExecution) {
+  const int num_ops = NumOps();
+  for (const auto& entry : Engines()) {
+    Engine* engine = entry.second;
+    auto vars      = NewVariables(engine, 64);
+    for (const int bulk_size : {0, 16, 64}) {
+      std::atomic<int> counter{0};
+      const int old_bulk_size = engine->set_bulk_size(bulk_size);
+      const auto start        = Clock::now();
+      for (int i = 0; i < num_ops; ++i) {
+        engine->PushSync(
+            [&counter](RunContext) { counter.fetch_add(1, std::memory_order_relaxed); },
+            Context::CPU(),
+            {},
+            {vars[i % vars.size()]});
+      }
+      engine->set_bulk_size(old_bulk_size);
+      engine->WaitForAll();
+      const double total_us = ElapsedUs(start);
+      EXPECT_EQ(counter.load(), num_ops);
+      Report("BulkExecution bulk size " + std::to_string(bulk_size),
+             entry.first,
+             "per op",
+             total_us / num_ops,
+             "us");
+    }
+    DeleteVariables(engine, vars);
+  }
+}
@@ -0,0 +1,92 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file parallel_for_test.cc
+ * \brief Tests of the parallel loops of the CPU operators
+ */
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../../src/engine/parallel_for.h"
+
+using mxnet::engine::ParallelFor;
+using mxnet::engine::ParallelRuntime;
+
+TEST(ParallelFor, CoversRangeOnce) {
+  for (const int64_t n : {1, 7, 64, 1000, 12345}) {
+    std::vector<std::atomic<int>> visits(n);
+    ParallelFor(3, 3 + n, 1, 4, [&](const int64_t b, const int64_t e) {
+      EXPECT_LT(b, e);
+      for (int64_t i = b; i < e; ++i) {
+        ++visits[i - 3];
+      }
+    });
+    for (const auto& v : visits) {
+      EXPECT_EQ(v.load(), 1);
+    }
+  }
+}
+
+TEST(ParallelFor, SerialBelowGrainAndWhenNested) {
+  int calls = 0;
+  ParallelFor(0, 100, 100, 4, [&](const int64_t b, const int64_t e) {
+    EXPECT_EQ(b, 0);
+    EXPECT_EQ(e, 100);
+    ++calls;
+  });
+  EXPECT_EQ(calls, 1);
+  EXPECT_FALSE(ParallelRuntime::InParallelRegion());
+
+  std::atomic<int> nested{0};
+  ParallelFor(0, 64, 1, 4, [&](const int64_t b, const int64_t e) {
+    ParallelFor(0, 10, 1, 4, [&](const int64_t nb, const int64_t ne) {
+      EXPECT_EQ(nb, 0);
+      EXPECT_EQ(ne, 10);
+      ++nested;
+    });
+  });
+  EXPECT_GE(nested.load(), 1);
+}
+
+TEST(ParallelFor, ConcurrentCallers) {
+  std::vector<std::thread> callers;
+  std::vector<int64_t> sums(4, 0);
+  for (int c = 0; c < 4; ++c) {
+    callers.emplace_back([c, &sums]() {
+      std::atomic<int64_t> sum{0};
+      ParallelFor(0, 10000, 16, 4, [&](const int64_t b, const int64_t e) {
+        int64_t local = 0;
+        for (int64_t i = b; i < e; ++i) {
+          local += i;
+        }
+        sum += local;
+      });
+      sums[c] = sum.load();
+    });
+  }
+  for (auto& caller : callers) {
+    caller.join();
+  }
+  for (const int64_t sum : sums) {
+    EXPECT_EQ(sum, int64_t{10000} * 9999 / 2);
+  }
+}
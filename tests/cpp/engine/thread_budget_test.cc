@@ -0,0 +1,64 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file thread_budget_test.cc
+ * \brief Tests of the partition of the cores among engine workers, OMP teams and data loaders
+ */
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "../../src/engine/thread_budget.h"
+
+using mxnet::engine::ThreadBudget;
+
+TEST(ThreadBudget, Partition) {
+  ThreadBudget budget({0, 1, 2, 3, 4, 5, 6, 7}, 2, 0);
+  EXPECT_TRUE(budget.enabled());
+  EXPECT_EQ(budget.compute_cpus(), std::vector<int>({0, 1, 2, 3, 4, 5}));
+  EXPECT_EQ(budget.loader_cpus(), std::vector<int>({6, 7}));
+  EXPECT_EQ(budget.EngineWorkers(1), 1);
+  EXPECT_EQ(budget.EngineWorkers(16), 6);
+
+  // a single CPU is shared by everyone
+  ThreadBudget single({3}, 2, 0);
+  EXPECT_EQ(single.compute_cpus(), std::vector<int>({3}));
+  EXPECT_EQ(single.loader_cpus(), std::vector<int>({3}));
+}
+
+TEST(ThreadBudget, LoaderThreads) {
+  ThreadBudget budget({0, 1, 2, 3, 4, 5, 6, 7}, 3, 0);
+  EXPECT_EQ(budget.AcquireLoaderThreads(2), 2);
+  EXPECT_EQ(budget.AcquireLoaderThreads(4), 1);
+  // every loader gets a thread even once the loader cores are taken
+  EXPECT_EQ(budget.AcquireLoaderThreads(4), 1);
+  budget.ReleaseLoaderThreads(1);
+  budget.ReleaseLoaderThreads(2);
+  EXPECT_EQ(budget.AcquireLoaderThreads(4), 2);
+}
+
+TEST(ThreadBudget, OMPTeamSize) {
+  ThreadBudget budget({0, 1, 2, 3, 4, 5, 6, 7}, 0, 0);
+  EXPECT_EQ(budget.OMPTeamSize(1), 8);
+  EXPECT_EQ(budget.OMPTeamSize(3), 2);
+  EXPECT_EQ(budget.OMPTeamSize(16), 1);
+  ThreadBudget capped({0, 1, 2, 3, 4, 5, 6, 7}, 0, 4);
+  EXPECT_EQ(capped.OMPTeamSize(1), 4);
+  EXPECT_EQ(capped.OMPTeamSize(4), 2);
+}
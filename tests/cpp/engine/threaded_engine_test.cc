@@ -37,6 +37,7 @@
 #include <random>
 
 #include "../src/engine/engine_impl.h"
+#include "../src/engine/scheduling_queue.h"
 #include "../include/test_util.h"
 
 /**
@@ -135,12 +136,16 @@ double EvaluateWorkloads(const std::vector<Workload>& workloads,
 }
 
 TEST(Engine, start_stop) {
-  const int num_engine = 3;
+  const int num_engine = 4;
   std::vector<mxnet::Engine*> engine(num_engine);
   engine[0]                 = mxnet::engine::CreateNaiveEngine();
   engine[1]                 = mxnet::engine::CreateThreadedEnginePooled();
   engine[2]                 = mxnet::engine::CreateThreadedEnginePerDevice();
-  std::string type_names[3] = {"NaiveEngine", "ThreadedEnginePooled", "ThreadedEnginePerDevice"};
+  engine[3]                 = mxnet::engine::CreateThreadedEngineWorkStealing();
+  std::string type_names[4] = {"NaiveEngine",
+                               "ThreadedEnginePooled",
+                               "ThreadedEnginePerDevice",
+                               "ThreadedEngineWorkStealing"};
 
   for (int i = 0; i < num_engine; ++i) {
     LOG(INFO) << "Stopping: " << type_names[i];
@@ -154,7 +159,7 @@ TEST(Engine, start_stop) {
 TEST(Engine, RandSumExpr) {
   std::vector<Workload> workloads;
   int num_repeat       = 5;
-  const int num_engine = 4;
+  const int num_engine = 5;
 
   std::vector<double> t(num_engine, 0.0);
   std::vector<mxnet::Engine*> engine(num_engine);
@@ -163,6 +168,7 @@ TEST(Engine, RandSumExpr) {
   engine[1] = mxnet::engine::CreateNaiveEngine();
   engine[2] = mxnet::engine::CreateThreadedEnginePooled();
   engine[3] = mxnet::engine::CreateThreadedEnginePerDevice();
+  engine[4] = mxnet::engine::CreateThreadedEngineWorkStealing();
 
   for (int repeat = 0; repeat < num_repeat; ++repeat) {
     srand(time(nullptr) + repeat);
@@ -185,6 +191,7 @@ TEST(Engine, RandSumExpr) {
   LOG(INFO) << "NaiveEngine\t\t" << t[1] << " sec";
   LOG(INFO) << "ThreadedEnginePooled\t" << t[2] << " sec";
   LOG(INFO) << "ThreadedEnginePerDevice\t" << t[3] << " sec";
+  LOG(INFO) << "ThreadedEngineWorkStealing\t" << t[4] << " sec";
 }
 
 void Foo(mxnet::RunContext, int i) {
@@ -567,6 +574,95 @@ TEST(Engine, VarVersion) {
   }
 }
 
+TEST(Engine, CaptureReplay) {
+  std::vector<mxnet::Engine*> engines = {mxnet::engine::CreateThreadedEnginePooled(),
+                                         mxnet::engine::CreateThreadedEnginePerDevice()};
+  for (auto engine : engines) {
+    auto a = engine->NewVariable();
+    auto b = engine->NewVariable();
+    auto c = engine->NewVariable();
+    std::atomic<int> va{0}, vb{0}, vc{0};
+    engine->BeginCapture();
+    // a += 1; b = 2 * a; c = a + b; a += c
+    engine->PushSync([&](mxnet::RunContext) { va += 1; }, mxnet::Context{}, {}, {a});
+    engine->PushSync([&](mxnet::RunContext) { vb = 2 * va; }, mxnet::Context{}, {a}, {b});
+    engine->PushSync([&](mxnet::RunContext) { vc = va + vb; }, mxnet::Context{}, {a, b}, {c});
+    engine->PushSync([&](mxnet::RunContext) { va += vc; }, mxnet::Context{}, {c}, {a});
+    auto graph = engine->EndCapture();
+    ASSERT_NE(graph, nullptr);
+    engine->WaitForAll();
+    EXPECT_EQ(va.load(), 4);
+    for (int i = 0; i < 3; ++i) {
+      engine->Replay(graph);
+    }
+    engine->WaitForVar(a);
+    EXPECT_EQ(va.load(), 340);
+    EXPECT_EQ(vb.load(), 170);
+    EXPECT_EQ(vc.load(), 255);
+    EXPECT_EQ(a->version(), 5U);
+    engine->DeleteGraph(graph);
+
+    // deleting a variable used by the captured operations invalidates the capture
+    auto tmp = engine->NewVariable();
+    engine->BeginCapture();
+    engine->PushSync([](mxnet::RunContext) {}, mxnet::Context{}, {}, {tmp});
+    engine->DeleteVariable([](mxnet::RunContext) {}, mxnet::Context{}, tmp);
+    EXPECT_EQ(engine->EndCapture(), nullptr);
+
+    for (auto var : {a, b, c}) {
+      engine->DeleteVariable([](mxnet::RunContext) {}, mxnet::Context{}, var);
+    }
+    engine->WaitForAll();
+  }
+}
+
+TEST(Engine, SchedulingQueue) {
+  auto pop_all = [](mxnet::engine::SchedulingQueue<int>* queue) {
+    std::vector<int> order;
+    for (int item; queue->Size() > 0;) {
+      queue->Pop(&item);
+      order.push_back(item);
+    }
+    return order;
+  };
+  {
+    unsetenv("MXNET_ENGINE_PRIORITY_SCHEDULING");
+    mxnet::engine::SchedulingQueue<int> queue;
+    queue.Push(0, 0);
+    queue.Push(1, 5);
+    queue.PushFront(2);
+    EXPECT_EQ(pop_all(&queue), std::vector<int>({2, 0, 1}));
+  }
+  setenv("MXNET_ENGINE_PRIORITY_SCHEDULING", "1", 1);
+  {
+    mxnet::engine::SchedulingQueue<int> queue;
+    queue.Push(0, 0);
+    queue.Push(1, 5);
+    queue.Push(2, 0);
+    queue.PushFront(3);
+    queue.Push(4, 5);
+    EXPECT_EQ(pop_all(&queue), std::vector<int>({3, 1, 4, 0, 2}));
+  }
+  {
+    // with aging every push raises the relative priority of waiting tasks by one
+    setenv("MXNET_ENGINE_PRIORITY_AGING", "1", 1);
+    mxnet::engine::SchedulingQueue<int> queue;
+    queue.Push(0, 0);
+    queue.Push(1, 1);
+    queue.Push(2, 1);
+    queue.Push(3, 4);
+    EXPECT_EQ(pop_all(&queue), std::vector<int>({3, 0, 1, 2}));
+    unsetenv("MXNET_ENGINE_PRIORITY_AGING");
+  }
+  {
+    mxnet::engine::SchedulingQueue<int> queue;
+    queue.SignalForKill();
+    int item;
+    EXPECT_FALSE(queue.Pop(&item));
+  }
+  unsetenv("MXNET_ENGINE_PRIORITY_SCHEDULING");
+}
+
 #ifdef _OPENMP
 
 struct TestSaveAndRestoreOMPState {
@@ -26,6 +26,7 @@
 
 #include <gtest/gtest.h>
 #include <mxnet/base.h>
+#include <numeric>
 #include <mxnet/kvstore.h>
 #include "../src/kvstore/gpu_topology.h"
 
@@ -602,4 +603,41 @@ TEST(GpuTopology, TestKernighanLin2) {
       << ".";
 }
 
+TEST(GpuTopology, TestScaleP2PWeight) {
+  // GPU 0 and 1 share a fast link, the others are slower, and 2 - 3 is unused
+  std::vector<float> W         = {0, 3, 2, 2, 3, 0, 2, 2, 2, 2, 0, 0, 2, 2, 0, 0};
+  std::vector<float> bandwidth = {0, 90, 20, 20, 110, 0, 20, 20, 20, 20, 0, 50, 20, 20, 50, 0};
+  float weight_sum             = std::accumulate(W.begin(), W.end(), 0.f);
+  mxnet::kvstore::ScaleP2PWeight(bandwidth, 4, &W);
+  EXPECT_FLOAT_EQ(std::accumulate(W.begin(), W.end(), 0.f), weight_sum);
+  EXPECT_FLOAT_EQ(W[0 * 4 + 1], W[1 * 4 + 0]);
+  EXPECT_FLOAT_EQ(W[0 * 4 + 1], 5 * W[0 * 4 + 2]);
+  EXPECT_FLOAT_EQ(W[2 * 4 + 3], 0.f);
+  EXPECT_FLOAT_EQ(W[1 * 4 + 1], 0.f);
+}
+
+TEST(GpuTopology, TestComputeNumStripes) {
+  // arrays above the bound are striped over all the trees
+  EXPECT_EQ(mxnet::kvstore::ComputeNumStripes(2000, 100, 4, 1000, 100), 4);
+  // below, by the stripe size
+  EXPECT_EQ(mxnet::kvstore::ComputeNumStripes(250, 100, 4, 1000, 100), 2);
+  EXPECT_EQ(mxnet::kvstore::ComputeNumStripes(50, 100, 4, 1000, 100), 1);
+  EXPECT_EQ(mxnet::kvstore::ComputeNumStripes(500, 100, 4, 1000, 0), 1);
+  // every stripe has at least two rows
+  EXPECT_EQ(mxnet::kvstore::ComputeNumStripes(2000, 5, 4, 1000, 100), 2);
+  EXPECT_EQ(mxnet::kvstore::ComputeNumStripes(2000, 1, 4, 1000, 100), 1);
+}
+
+TEST(GpuTopology, TestSelectTrees) {
+  std::vector<size_t> load(4, 0);
+  std::vector<int> roots;
+  mxnet::kvstore::SelectTrees(400, 2, &load, &roots);
+  ASSERT_EQ(roots, std::vector<int>({0, 1}));
+  mxnet::kvstore::SelectTrees(100, 1, &load, &roots);
+  ASSERT_EQ(roots, std::vector<int>({2}));
+  mxnet::kvstore::SelectTrees(300, 3, &load, &roots);
+  ASSERT_EQ(roots, std::vector<int>({3, 2, 0}));
+  ASSERT_EQ(load, std::vector<size_t>({300, 200, 200, 100}));
+}
+
 #endif  // MXNET_USE_CUDA
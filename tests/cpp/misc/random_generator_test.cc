@@ -0,0 +1,76 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <mxnet/random_generator.h>
+#include <vector>
+
+using namespace mxnet::common::random;
+
+/*
+ * Test the known answer of Philox-4x32-10 for a zero key and counter
+ */
+TEST(Philox4x32Test, KnownAnswer) {
+  uint32_t out[Philox4x32::kBatchSize];
+  Philox4x32::Generate(0, 0, 0, out);
+  EXPECT_EQ(out[0], 0x6627e8d5U);
+  EXPECT_EQ(out[1], 0xe169c58dU);
+  EXPECT_EQ(out[2], 0xbc57ac4cU);
+  EXPECT_EQ(out[3], 0x9b00dbd8U);
+}
+
+/*
+ * Test that the lanes of a batch are the blocks of consecutive counters
+ */
+TEST(Philox4x32Test, Lanes) {
+  uint32_t batch[Philox4x32::kBatchSize], block[Philox4x32::kBatchSize];
+  Philox4x32::Generate(42, 7, 100, batch);
+  for (int l = 0; l < Philox4x32::kLanes; ++l) {
+    Philox4x32::Generate(42, 7, 100 + l, block);
+    for (int i = 0; i < 4; ++i)
+      EXPECT_EQ(batch[4 * l + i], block[i]);
+  }
+}
+
+/*
+ * Test that the numbers of a state continue over its uses, and restart with the seed
+ */
+TEST(RandGeneratorTest, CpuStatesContinue) {
+  RandGenerator<mxnet::cpu, float> gen;
+  RandGenerator<mxnet::cpu, float>::AllocState(&gen);
+  gen.Seed(nullptr, 17);
+  std::vector<float> first;
+  for (int use = 0; use < 2; ++use) {
+    RandGenerator<mxnet::cpu, float>::Impl impl(&gen, 3);
+    for (int i = 0; i < 100; ++i) {
+      const float x = impl.uniform();
+      EXPECT_GE(x, 0.0f);
+      EXPECT_LT(x, 1.0f);
+      first.push_back(x);
+    }
+  }
+  EXPECT_NE(first[0], first[100]);
+  gen.Seed(nullptr, 17);
+  {
+    RandGenerator<mxnet::cpu, float>::Impl impl(&gen, 3);
+    for (int i = 0; i < 100; ++i)
+      EXPECT_EQ(impl.uniform(), first[i]);
+  }
+  RandGenerator<mxnet::cpu, float>::FreeState(&gen);
+}
@@ -0,0 +1,45 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include "../../src/initialize.h"
+
+using mxnet::LibraryInitializer;
+
+/*
+ * Test that the startup phases are recorded in order with their durations
+ */
+TEST(StartupProfile, RecordsPhases) {
+  LibraryInitializer* init = LibraryInitializer::Get();
+  init->record_library_loaded();
+  init->record_library_loaded();
+  const auto start = std::chrono::steady_clock::now() - std::chrono::milliseconds(5);
+  init->record_startup_phase("test phase", start);
+  const auto phases = init->startup_phases();
+  ASSERT_FALSE(phases.empty());
+  EXPECT_EQ(phases.back().first, "test phase");
+  EXPECT_GE(phases.back().second, 5.0);
+  int loaded = 0;
+  for (const auto& phase : phases) {
+    loaded += phase.first == "library load";
+  }
+  EXPECT_EQ(loaded, 1);
+}
@@ -39,6 +39,33 @@ TEST(OMP_TUNING, ShowAllTunedOps) {
   }
 }
 
+/*!
+ * \brief Tuning results saved to a cache file are loaded with the same host key only
+ */
+TEST(OMP_TUNING, CacheRoundTrip) {
+  const std::string path = "operator_tuning_cache_test.txt";
+  const std::string name = "mxnet::op::mxnet_op::tuned_op<mxnet::op::mshadow_op::sqrt, float>";
+  mxnet::op::tune::TuningCache saved("test host");
+  saved.Store(name, 1234);
+  saved.Store("omp_overhead_ns", 5678);
+  ASSERT_TRUE(saved.Save(path));
+
+  mxnet::op::tune::TuningCache loaded("test host");
+  ASSERT_TRUE(loaded.Load(path));
+  int64_t value = 0;
+  EXPECT_TRUE(loaded.Lookup(name, &value));
+  EXPECT_EQ(value, 1234);
+  EXPECT_TRUE(loaded.Lookup("omp_overhead_ns", &value));
+  EXPECT_EQ(value, 5678);
+  EXPECT_FALSE(loaded.Lookup("mxnet::op::mxnet_op::tuned_op<mxnet::op::mshadow_op::exp, float>",
+                             &value));
+
+  mxnet::op::tune::TuningCache other_host("other host");
+  EXPECT_FALSE(other_host.Load(path));
+  EXPECT_FALSE(other_host.Lookup(name, &value));
+  std::remove(path.c_str());
+}
+
 using kwargs_t = test::op::kwargs_t;
 
 static std::vector<mxnet::ShapeVector> tuning_shapes() {
@@ -25,7 +25,12 @@
 #include <mxnet/storage.h>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
 #include "test_util.h"
+#include "../../src/storage/best_fit_storage_manager.h"
+#include "../../src/storage/cpu_slab_storage_manager.h"
 
 TEST(Storage, Basic_CPU) {
   constexpr size_t kSize = 1024;
@@ -68,6 +73,60 @@ TEST(Storage, CPU_MemAlign) {
   }
 }
 
+TEST(Storage, CPU_Slab) {
+  mxnet::storage::CPUSlabStorageManager manager;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&manager, t]() {
+      std::vector<mxnet::Storage::Handle> handles;
+      for (int repeat = 0; repeat < 10; ++repeat) {
+        for (size_t i = 1; i < 200; ++i) {
+          mxnet::Storage::Handle handle;
+          // mix of slab sizes and one allocation above the largest size class
+          handle.size = i == 1 ? (4 << 20) : (i * 37 * (t + 1)) % 5000 + 1;
+          manager.Alloc(&handle, false);
+          ASSERT_NE(handle.dptr, nullptr);
+          EXPECT_EQ(reinterpret_cast<intptr_t>(handle.dptr) % 64, 0);
+          std::memset(handle.dptr, t, handle.size);
+          handles.push_back(handle);
+        }
+        for (auto& handle : handles) {
+          manager.Free(handle);
+        }
+        handles.clear();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(Storage, CPU_BestFit) {
+  mxnet::storage::BestFitStorageManager manager(mxnet::Context::CPU(0), 0);
+  std::vector<mxnet::Storage::Handle> handles(3);
+  for (size_t i = 0; i < handles.size(); ++i) {
+    handles[i].size = 1000 * (i + 1);
+    handles[i].ctx  = mxnet::Context::CPU(0);
+    manager.Alloc(&handles[i], false);
+    ASSERT_NE(handles[i].dptr, nullptr);
+  }
+  // blocks are carved from the same segment one after another
+  EXPECT_EQ(static_cast<char*>(handles[1].dptr) - static_cast<char*>(handles[0].dptr), 1024);
+  EXPECT_EQ(static_cast<char*>(handles[2].dptr) - static_cast<char*>(handles[1].dptr), 2048);
+  // freeing two neighbors coalesces them, so a larger request fits in their place
+  manager.Free(handles[0]);
+  manager.Free(handles[1]);
+  mxnet::Storage::Handle merged;
+  merged.size = 3000;
+  merged.ctx  = mxnet::Context::CPU(0);
+  manager.Alloc(&merged, false);
+  EXPECT_EQ(merged.dptr, handles[0].dptr);
+  manager.Free(merged);
+  manager.Free(handles[2]);
+  manager.ReleaseAll();
+}
+
 #if MXNET_USE_CUDA
 TEST(Storage_GPU, Basic_GPU) {
   if (mxnet::test::unitTestsWithCuda) {
@@ -87,6 +87,25 @@ def test_broadcast():
     check_broadcast(kv, init_test_keys_device_big, big_shape, device=True)
     print('worker ' + str(my_rank) + ' is initialized')
 
+def test_update():
+    # run last, the updater is kept by the kvstore; with MXNET_KVSTORE_SHARD_OPTIMIZER=1 each
+    # worker updates its shard of the keys, (3, 3) is not divisible by the number of workers
+    num_gpus = 2
+    rate = 2
+    update_shape = (3, 3)
+    kv.set_optimizer(mx.optimizer.create('test', rescale_grad=rate))
+    kv.init('600', mx.nd.ones(update_shape))
+    kv.init('601', mx.nd.ones(big_shape))
+    for i in range(3):
+        scale = my_rank + 1
+        num = (my_num_workers + 1) * my_num_workers * num_gpus / 2 * rate * (i + 1) + 1
+        for key, cur_shape in [('600', update_shape), ('601', big_shape)]:
+            arrs = [mx.nd.ones(cur_shape, ctx=mx.gpu(j)) * scale for j in range(num_gpus)]
+            kv.pushpull(key, arrs)
+            for arr in arrs:
+                check_diff_to_scalar(arr, num, my_rank)
+    print('worker ' + str(my_rank) + ' is updated')
+
 def test_type():
     assert kv.type == args.name
 
@@ -94,3 +113,5 @@ if __name__ == "__main__":
     test_type()
     test_broadcast()
     test_pushpull()
+    if 'nccl' in args.name:
+        test_update()
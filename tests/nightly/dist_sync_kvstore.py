@@ -21,6 +21,8 @@
 import sys
 sys.path.insert(0, "../../python/")
 import argparse
+import os
+import time
 import mxnet as mx
 import numpy as np
 import numpy.random as rnd
@@ -61,6 +63,8 @@ compr_keys_shapes = [('1000', shape), ('1200', irregular_shape),('1300', big_sha
 compr_init_keys_shapes = [('1001', shape), ('1201', irregular_shape),('1301', big_shape)]
 compr_random_keys_shapes = [('1002', shape),('1202', irregular_shape),('1302', big_shape)]
 
+ckpt_keys = ['2000', '2001', '2002']
+
 rate = 2
 
 kv = mx.kv.create('dist_sync')
@@ -531,6 +535,34 @@ def test_gluon_trainer_sparse_step():
     check_trainer_sparse_step()
     print('worker ' + str(my_rank) + ' passed test_gluon_trainer_sparse_step')
 
+def test_server_checkpoint():
+    prefix = 'dist_sync_kvstore_ckpt'
+    kv.init(ckpt_keys, [mx.nd.ones(shape)] * len(ckpt_keys))
+    kv.save_server_checkpoint(prefix)
+    # the snapshot is taken before later updates
+    kv.push(ckpt_keys, [mx.nd.ones(shape) * 2] * len(ckpt_keys))
+    val = mx.nd.zeros(shape)
+    kv.pull(ckpt_keys[0], out=val)
+    check_diff(val, 2 * nworker)
+    kv._barrier()
+    if my_rank == 0:
+        saved = {}
+        for i in range(int(os.environ['DMLC_NUM_SERVER'])):
+            fname = '%s-server%d.params' % (prefix, i)
+            # the servers write in the background
+            for _ in range(60):
+                try:
+                    saved.update(mx.nd.load(fname))
+                    break
+                except mx.base.MXNetError:
+                    time.sleep(1)
+            else:
+                raise RuntimeError('checkpoint ' + fname + ' was not written')
+        assert len(saved) == len(ckpt_keys), saved.keys()
+        for v in saved.values():
+            check_diff(v, 1)
+    print('worker ' + str(my_rank) + ' passed test_server_checkpoint')
+
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(description='test distributed kvstore in dist_sync mode')
     parser.add_argument('--nrepeat', type=int, default=7)
@@ -546,6 +578,8 @@ if __name__ == "__main__":
         test_gluon_trainer_sparse_step()
     elif opt.type == 'invalid_cpu':
         test_invalid_operations()
+    elif opt.type == 'checkpoint_cpu':
+        test_server_checkpoint()
     elif opt.type == 'init_gpu':
         test_sync_init(opt.gpu)
     elif opt.type == 'default_cpu':
@@ -27,6 +27,7 @@ test_kvstore() {
         "-n 4 --launcher local python3 dist_device_sync_kvstore.py"
         "-n 4 --launcher local python3 dist_device_sync_kvstore_custom.py"
         "--p3 -n 4 --launcher local python3 dist_device_sync_kvstore_custom.py"
+        "-n 2 --launcher local python3 dist_device_sync_kvstore_custom.py --name=dist_sync_nccl"
         "-n 4 --launcher local python3 dist_sync_kvstore.py --type=init_gpu"
     )
 
@@ -36,6 +37,27 @@ test_kvstore() {
             return $?
         fi
     done
+
+    # all workers of the local launcher share one machine and one leader
+    MXNET_KVSTORE_HIERARCHICAL=1 python3 ../../tools/launch.py -n 4 --launcher local \
+        python3 dist_device_sync_kvstore.py
+    if [ $? -ne 0 ]; then
+        return $?
+    fi
+
+    # small chunks so that the arrays are split and scheduled in parts
+    MXNET_KVSTORE_SCHEDULE_CHUNK_SIZE=4096 python3 ../../tools/launch.py -n 4 --launcher local \
+        python3 dist_device_sync_kvstore.py
+    if [ $? -ne 0 ]; then
+        return $?
+    fi
+
+    # every worker updates its shard of the weights and gathers the others
+    MXNET_KVSTORE_SHARD_OPTIMIZER=1 python3 ../../tools/launch.py -n 2 --launcher local \
+        python3 dist_device_sync_kvstore_custom.py --name=dist_sync_nccl
+    if [ $? -ne 0 ]; then
+        return $?
+    fi
 }
 
 test_horovod() {
@@ -293,6 +293,40 @@ def test_compress_kvstore(kv_type, compression='2bit', threshold=0.5):
         check_neg(kv, -1*threshold, rate, curval)
     check_compr_random(kv, threshold)
 
+def test_topk_powersgd_kvstore(kv_type):
+    print(kv_type + ' with topk and powersgd compression')
+    rate = 2
+    shape = (8, 8)
+    # topk sends the value of largest magnitude of every 4 values
+    kv = mx.kv.create(kv_type)
+    kv.set_gradient_compression({'type': 'topk', 'ratio': 0.25})
+    kv.set_optimizer(mx.optimizer.create('test', learning_rate=-rate))
+    kv.init(21, mx.nd.zeros(shape))
+    # values are sent as half precision
+    grad = np.random.uniform(-1, 1, shape).astype(np.float16).astype(np.float32)
+    kv.push(21, [mx.nd.array(grad, mx.gpu(g)) for g in range(nworker)])
+    out = [mx.nd.zeros(shape, mx.gpu(g)) for g in range(nworker)]
+    kv.pull(21, out=out)
+    chunks = grad.reshape(-1, 4)
+    rows = np.arange(chunks.shape[0])
+    top = np.argmax(np.abs(chunks), axis=1)
+    exp = np.zeros_like(chunks)
+    exp[rows, top] = chunks[rows, top]
+    for o in out:
+        assert_almost_equal(o.asnumpy(), exp.reshape(shape) * rate * nworker)
+
+    # a rank 1 block is recovered by one step of power iteration
+    kv = mx.kv.create(kv_type)
+    kv.set_gradient_compression({'type': 'powersgd', 'rank': 1, 'block_size': 8})
+    kv.set_optimizer(mx.optimizer.create('test', learning_rate=-rate))
+    kv.init(23, mx.nd.zeros(shape))
+    grad = np.outer(np.random.uniform(1, 2, 8), np.random.uniform(1, 2, 8)).astype(np.float32)
+    kv.push(23, [mx.nd.array(grad, mx.gpu(g)) for g in range(nworker)])
+    out = [mx.nd.zeros(shape, mx.gpu(g)) for g in range(nworker)]
+    kv.pull(23, out=out)
+    for o in out:
+        assert_almost_equal(o.asnumpy(), grad * rate * nworker, rtol=1e-4, atol=1e-4)
+
 ## group keys interface
 def test_group_kvstore(kv_type, stype):
     print(kv_type)
@@ -338,6 +372,7 @@ if __name__ == "__main__":
     test_compress_kvstore('local_allreduce_device', '1bit', 0)
     test_compress_kvstore('local_allreduce_device', '1bit', .5)
     test_compress_kvstore('local_allreduce_device', '2bit', .5)
+    test_topk_powersgd_kvstore('local_allreduce_device')
     for stype in stypes:
         test_group_kvstore('local_update_cpu', stype)
         test_group_kvstore('local_allreduce_cpu', stype)
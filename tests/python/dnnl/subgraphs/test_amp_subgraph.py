@@ -229,6 +229,29 @@ def test_amp_fuse_with_branch():
   check_amp_fuse(net, [data_example], exp_sym)
 
 
+def test_amp_remove_fp32_cast_pair():
+  data = mx.sym.Variable('data')
+  weight = [mx.symbol.Variable('weight{}'.format(i)) for i in range(2)]
+  bias = [mx.symbol.Variable('bias{}'.format(i)) for i in range(2)]
+  lp16_op_1 = mx.sym.FullyConnected(mx.sym.amp_cast(data, dtype=AMP_DTYPE), weight[0], bias[0],
+                                    num_hidden=16)
+  f32_amp_cast = mx.sym.amp_cast(lp16_op_1, dtype='float32')
+  lp16_op_2 = mx.sym.FullyConnected(mx.sym.amp_cast(f32_amp_cast, dtype=AMP_DTYPE), weight[1],
+                                    bias[1], num_hidden=16)
+
+  #  lp16_op_1 ---> f32_amp_cast ---> lp16_amp_cast ---> lp16_op_2
+  #                          ||
+  #                          \/
+  #          lp16_op_1 ---> lp16_amp_cast ---> lp16_op_2
+  exp_sym = mx.sym.FullyConnected(mx.sym.amp_cast(lp16_op_1, dtype=AMP_DTYPE), weight[1], bias[1],
+                                  num_hidden=16)
+  same_graph_structure(lp16_op_2.get_backend_symbol(AMP_SG_PASS_NAME), exp_sym, True)
+
+  # the float32 cast is kept when it has other consumers
+  sym = mx.sym.Group([lp16_op_2, mx.sym.softmax(f32_amp_cast)])
+  same_graph_structure(sym.get_backend_symbol(AMP_SG_PASS_NAME), sym, True)
+
+
 def test_amp_excluding_after_graph_pass():
   class TestNet(nn.HybridBlock):
     def __init__(self):
@@ -15,6 +15,7 @@
 # specific language governing permissions and limitations
 # under the License.
 
+import json
 import mxnet as mx
 import pytest
 from subgraph_common import check_fusion, check_neg_fusion, check_neg_fusion_quantized, check_quantize
@@ -250,6 +251,85 @@ def test_fc_int8_and_fp32_outputs(data_shape, flatten):
   check_fusion(net, data_shape, attrs, check_quantization=flatten)
 
 
+@mx.util.use_np
+@pytest.mark.parametrize('quantize_granularity', ['tensor-wise', 'channel-wise'])
+@pytest.mark.parametrize('use_bias', [True, False])
+@pytest.mark.parametrize('relu', [True, False])
+def test_fc_dynamic_quantize(quantize_granularity, use_bias, relu):
+  class FC(nn.HybridBlock):
+    def __init__(self, **kwargs):
+      super(FC, self).__init__(**kwargs)
+      self.fc = nn.Dense(units=64, use_bias=use_bias, activation='relu' if relu else None)
+
+    def forward(self, x):
+      return self.fc(x)
+
+  data_shape = (4, 32)
+  net = FC()
+  net.initialize()
+  net.hybridize()
+  net(mx.np.zeros(data_shape))
+  qnet = quantization.quantize_net(net, quantized_dtype='auto', calib_mode='dynamic',
+                                   data_shapes=[data_shape],
+                                   quantize_granularity=quantize_granularity)
+  qsym, _ = qnet.export(None)
+  fc_nodes = [node for node in json.loads(qsym.tojson())['nodes']
+              if node['op'] == '_sg_onednn_fully_connected']
+  assert len(fc_nodes) == 1
+  assert fc_nodes[0]['attrs']['dynamic_quantize'] == 'True'
+  assert fc_nodes[0]['attrs']['enabled_float_output'] == 'float32'
+
+  # the range of the data changes between batches, without recalibration
+  for data_range in [1.0, 20.0, 0.05]:
+    data = mx.np.random.uniform(-data_range, data_range, size=data_shape)
+    ref_out = net(data)
+    quantized_out = qnet(data)
+    max_range = mx.np.max(mx.np.abs(ref_out)).item()
+    assert_almost_equal_with_err(quantized_out.asnumpy(), ref_out.asnumpy(),
+                                 rtol=0.1, atol=0.1 * max_range, etol=0.2)
+
+
+@mx.util.use_np
+@pytest.mark.parametrize('calib_mode', ['naive', 'none'])
+@pytest.mark.parametrize('use_bias', [True, False])
+@pytest.mark.parametrize('relu', [True, False])
+def test_fc_group_wise_quantize(calib_mode, use_bias, relu):
+  class FC(nn.HybridBlock):
+    def __init__(self, **kwargs):
+      super(FC, self).__init__(**kwargs)
+      self.fc = nn.Dense(units=16, use_bias=use_bias, activation='relu' if relu else None)
+
+    def forward(self, x):
+      return self.fc(x)
+
+  data_shape = (4, 32)
+  net = FC()
+  net.initialize()
+  net.hybridize()
+  net(mx.np.zeros(data_shape))
+  # groups of input features with ranges far apart, which one scale per channel cannot follow
+  weight = mx.np.random.uniform(-1.0, 1.0, size=(16, 32))
+  weight[:, :8] *= 50.0
+  net.fc.weight.set_data(weight)
+
+  data = mx.np.random.uniform(-1.0, 1.0, size=data_shape)
+  calib_data = mx.gluon.data.DataLoader(mx.gluon.data.ArrayDataset(data), batch_size=4)
+  qnet = quantization.quantize_net(net, quantized_dtype='auto', calib_mode=calib_mode,
+                                   calib_data=calib_data, quantize_granularity='group-wise',
+                                   weight_group_size=8)
+  qsym, _ = qnet.export(None)
+  fc_nodes = [node for node in json.loads(qsym.tojson())['nodes']
+              if node['op'] == '_sg_onednn_fully_connected']
+  assert len(fc_nodes) == 1
+  assert fc_nodes[0]['attrs']['weight_group_size'] == '8'
+
+  ref_out = net(data)
+  quantized_out = qnet(data)
+  max_range = mx.np.max(mx.np.abs(ref_out)).item()
+  assert_almost_equal_with_err(quantized_out.asnumpy(), ref_out.asnumpy(),
+                               rtol=0.1, atol=0.1 * max_range, etol=0.2)
+
+
 @mx.util.use_np
 @pytest.mark.parametrize('identity_node', ['dropout', 'copy'])
 def test_fc_identity_eltwise(identity_node):
@@ -16,6 +16,7 @@
 # under the License.
 
 import copy
+import json
 import mxnet as mx
 import numpy as np
 import pytest
@@ -27,11 +28,17 @@ import math
 
 
 class MultiHeadAttention(nn.HybridBlock):
-  def __init__(self, units, num_heads, batch_size=-1, seq_length=-1, dtype='float32', negative_case=False, no_split_case = False, **kwargs):
+  def __init__(self, units, num_heads, batch_size=-1, seq_length=-1, dtype='float32', negative_case=False, no_split_case = False,
+               num_kv_heads=None, **kwargs):
       super(MultiHeadAttention, self).__init__(**kwargs)
       self._units = units
       self._num_heads = num_heads
-      self._fc = nn.Dense(in_units=self._units, units=3*self._units, flatten=False, dtype=dtype)
+      # in grouped-query attention each key and value head is shared by several query heads
+      self._num_kv_heads = num_kv_heads or num_heads
+      kv_units = self._units // self._num_heads * self._num_kv_heads
+      self._sections = 3 if kv_units == self._units else [self._units, self._units + kv_units]
+      self._fc = nn.Dense(in_units=self._units, units=self._units + 2*kv_units, flatten=False,
+                          dtype=dtype)
       self._scale = math.sqrt(self._units // self._num_heads)
       self.negative_case = negative_case
       self.no_split_case = no_split_case
@@ -40,15 +47,18 @@ class MultiHeadAttention(nn.HybridBlock):
 
   def forward(self, x, mask):
       out = self._fc(x)
-      query, key, value = mx.np.split(out, 3, axis=-1)
+      query, key, value = mx.np.split(out, self._sections, axis=-1)
       if self.no_split_case:
         key = mx.np.concat((key, key), axis = 1)
         value = mx.np.concat((value, value), axis = 1)
       query = mx.np.reshape(query, (-2, -2, self._num_heads, -1))
       if self.negative_case:
         query = query * 2
-      key = mx.np.reshape(key, (-2, -2, self._num_heads, -1))
-      value = mx.np.reshape(value, (-2, -2, self._num_heads, -1))
+      key = mx.np.reshape(key, (-2, -2, self._num_kv_heads, -1))
+      value = mx.np.reshape(value, (-2, -2, self._num_kv_heads, -1))
+      if self._num_kv_heads != self._num_heads:
+        key = mx.np.repeat(key, self._num_heads // self._num_kv_heads, axis=2)
+        value = mx.np.repeat(value, self._num_heads // self._num_kv_heads, axis=2)
       scores = mx.npx.batch_dot(mx.np.swapaxes(query, 1, 2), mx.np.swapaxes(key, 1, 2),
                                 transpose_b=True)
       mask = mx.np.expand_dims(mask, axis=1).astype(np.bool)
@@ -66,7 +76,17 @@ class MultiHeadAttention(nn.HybridBlock):
 @pytest.mark.parametrize('num_heads', [4, 8])
 @pytest.mark.parametrize('split', [True, False])
 def test_self_attention(batch_size, seq_length, units, num_heads, split):
-  net = MultiHeadAttention(units, num_heads, no_split_case=not split)
+  check_self_attention(batch_size, seq_length, units, num_heads, split)
+
+@use_np
+@pytest.mark.parametrize('batch_size', [1, 32])
+@pytest.mark.parametrize('num_heads,num_kv_heads', [(8, 2), (4, 1)])
+@pytest.mark.parametrize('split', [True, False])
+def test_self_attention_grouped(batch_size, num_heads, num_kv_heads, split):
+  check_self_attention(batch_size, 124, 256, num_heads, split, num_kv_heads)
+
+def check_self_attention(batch_size, seq_length, units, num_heads, split, num_kv_heads=None):
+  net = MultiHeadAttention(units, num_heads, no_split_case=not split, num_kv_heads=num_kv_heads)
   in_data = mx.np.random.uniform(size=[batch_size, seq_length, units], dtype='float32')
   if (split):
     mask = mx.np.random.uniform(low=0, high=2, size=[batch_size, seq_length, seq_length], dtype='int32')
@@ -186,3 +206,42 @@ def test_batch_dot(batch_size, seq_length, units, num_heads):
   max_range = np.max(ref_out.asnumpy())
   atol = 0.1 * max(abs(min_range), abs(max_range))
   assert_almost_equal_with_err(qout.asnumpy(), ref_out.asnumpy(), rtol=0.1, atol=atol, etol=0.1)
+
+@use_np
+@pytest.mark.parametrize('batch_size', [1, 8])
+@pytest.mark.parametrize('seq_length', [64, 124])
+@pytest.mark.parametrize('split', [True, False])
+def test_self_attention_fused_softmax(batch_size, seq_length, split):
+  units, num_heads = 256, 4
+  net = MultiHeadAttention(units, num_heads, no_split_case=not split)
+  in_data = mx.np.random.uniform(size=[batch_size, seq_length, units], dtype='float32')
+  key_length = seq_length if split else seq_length * 2
+  mask = mx.np.random.uniform(low=0, high=2, size=[batch_size, seq_length, key_length], dtype='int32')
+  # a fully masked row gives zeros
+  mask[:, 0, :] = 0
+
+  net.initialize()
+  net.hybridize()
+  ref_out = net(in_data, mask)
+
+  calib_data = mx.gluon.data.DataLoader(mx.gluon.data.ArrayDataset(in_data, mask), batch_size=batch_size)
+  qnet = mx.contrib.quant.quantize_net(net, quantized_dtype='auto',
+                                       calib_data=calib_data,
+                                       calib_mode='naive',
+                                       num_calib_batches=1,
+                                       ctx=mx.cpu())
+  qsym, _ = qnet.export(None)
+  nodes = json.loads(qsym.tojson())['nodes']
+  qk_op = '_sg_onednn_selfatt_qk_split' if split else '_sg_onednn_selfatt_qk'
+  qk_nodes = [node for node in nodes if node['op'] == qk_op]
+  assert len(qk_nodes) == 1
+  assert qk_nodes[0]['attrs']['with_masked_softmax'] == 'True'
+  # the scores stay quantized from the qk matmul to the valatt matmul
+  assert not [node for node in nodes if node['op'] == 'masked_softmax']
+
+  qout = qnet(in_data, mask)
+  mx.nd.waitall()
+  min_range = np.min(ref_out.asnumpy())
+  max_range = np.max(ref_out.asnumpy())
+  atol = 0.1 * max(abs(min_range), abs(max_range))
+  assert_almost_equal_with_err(qout.asnumpy(), ref_out.asnumpy(), rtol=0.1, atol=atol, etol=0.2)
@@ -687,3 +687,38 @@ def test_rnn():
 
     for sl, ss, bs, in_s in itertools.product(SEQ_LENGTH, STATE_SIZE, BATCH_SIZE, INPUT_SIZE): 
         batch_check(sl, ss, bs, in_s)
+
+
+def test_dispatch_tuner(tmpdir):
+    import subprocess
+    cache = os.path.join(str(tmpdir), 'dispatch_cache.txt')
+    script = '''
+import numpy as np
+import mxnet as mx
+x = mx.nd.array(np.arange(2 * 3 * 5 * 5).reshape(2, 3, 5, 5) % 7)
+w = mx.nd.array(np.arange(4 * 3 * 3 * 3).reshape(4, 3, 3, 3) % 5)
+conv = mx.nd.Convolution(x, w, kernel=(3, 3), num_filter=4, no_bias=True)
+fc = mx.nd.FullyConnected(x, mx.nd.ones((8, 75)), num_hidden=8, no_bias=True)
+np.save(r'{}', np.concatenate([conv.asnumpy().ravel(), fc.asnumpy().ravel()]))
+'''
+    results = []
+    for run in range(2):
+        out = os.path.join(str(tmpdir), 'out{}.npy'.format(run))
+        env = dict(os.environ, MXNET_ONEDNN_DISPATCH_TUNE='1', MXNET_ONEDNN_DISPATCH_CACHE=cache)
+        subprocess.check_call([sys.executable, '-c', script.format(out)], env=env)
+        results.append(np.load(out))
+        with open(cache) as f:
+            entries = [line.split('\t') for line in f.read().splitlines()]
+        # the second run reads the winners of the first one instead of tuning again
+        assert len(entries) == 2
+        assert any('Convolution' in key for key, _ in entries)
+        assert any('FullyConnected' in key for key, _ in entries)
+        assert all(impl in ('0', '1') for _, impl in entries)
+    x = np.arange(2 * 3 * 5 * 5).reshape(2, 3, 5, 5) % 7
+    w = np.arange(4 * 3 * 3 * 3).reshape(4, 3, 3, 3) % 5
+    ref = mx.nd.Convolution(mx.nd.array(x), mx.nd.array(w), kernel=(3, 3), num_filter=4,
+                            no_bias=True)
+    ref_fc = mx.nd.FullyConnected(mx.nd.array(x), mx.nd.ones((8, 75)), num_hidden=8, no_bias=True)
+    expected = np.concatenate([ref.asnumpy().ravel(), ref_fc.asnumpy().ravel()])
+    for result in results:
+        assert_almost_equal(result, expected)
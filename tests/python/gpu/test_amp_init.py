@@ -108,11 +108,60 @@ class PoolConv(nn.HybridBlock):
         return y * 2
 
 
+class ResidualConv(nn.HybridBlock):
+    def __init__(self, ndim, **kwargs):
+        super().__init__(**kwargs)
+        self.conv0 = CONV[ndim](10, 3, padding=1)
+        self.conv1 = CONV[ndim](10, 3, padding=1)
+
+    def forward(self, x):
+        y = mx.npx.relu(self.conv0(x))
+        y = mx.npx.dropout(y, p=0.)
+        z = self.conv1(y) + y
+        return self.conv1(z)
+
+
+class ConcatConv(nn.HybridBlock):
+    def __init__(self, ndim, **kwargs):
+        super().__init__(**kwargs)
+        self.conv0 = CONV[ndim](6, 3, padding=1)
+        self.conv1 = CONV[ndim](4, 3, padding=1)
+        self.conv2 = CONV[ndim](10, 3)
+
+    def forward(self, x):
+        y = mx.np.concatenate([self.conv0(x), self.conv1(x)], axis=1)
+        y = mx.npx.activation(y, act_type='sigmoid')
+        return self.conv2(y)
+
+
+class UpSamplingConv(nn.HybridBlock):
+    def __init__(self, ndim, **kwargs):
+        super().__init__(**kwargs)
+        self.conv0 = CONV[ndim](6, 3)
+        self.conv1 = CONV[ndim](10, 3)
+
+    def forward(self, x):
+        y = self.conv0(x)
+        y = mx.npx.upsampling(y, y, scale=2, sample_type='nearest', num_args=2,
+                              multi_input_mode='sum')
+        return self.conv1(y)
+
+
 @pytest.mark.skipif(not mx.runtime.Features().is_enabled('CUDNN'),
                     reason='Channel-last layouts are only supported with cuDNN.')
 @pytest.mark.parametrize('ndim', [1, 2, 3])
-@pytest.mark.parametrize('model', [Conv, ConvBN, PoolConv])
+@pytest.mark.parametrize('model', [Conv, ConvBN, PoolConv, ResidualConv, ConcatConv])
 def test_optimize_layout(np_shape_array, amp_init, model, ndim):
+    check_optimize_layout(model, ndim)
+
+
+@pytest.mark.skipif(not mx.runtime.Features().is_enabled('CUDNN'),
+                    reason='Channel-last layouts are only supported with cuDNN.')
+def test_optimize_layout_upsampling(np_shape_array, amp_init):
+    check_optimize_layout(UpSamplingConv, 2)
+
+
+def check_optimize_layout(model, ndim):
     m = model(ndim)
     m.initialize(ctx=mx.gpu())
     m.hybridize()
@@ -60,5 +60,26 @@ def test_device_pushpull():
                 check_dense_pushpull('device')
 
 
+@pytest.mark.skipif(mx.device.num_gpus() < 2, reason="test_device_pushpull_tree_stripes needs at least 2 GPUs")
+def test_device_pushpull_tree_stripes():
+    # striping medium sized keys over several trees, with calibrated link weights
+    with environment({'MXNET_KVSTORE_USETREE': '1',
+                      'MXNET_KVSTORE_TREE_STRIPE_SIZE': '100',
+                      'MXNET_KVSTORE_TREE_CALIBRATE_MB': '1'}):
+        n_gpus = min(num_gpus, 4)
+        kv_device = mx.kv.create('device')
+        tree_shapes = [(10,), (1000,), (64, 100), (3, 500)]
+        for key, shape in enumerate(tree_shapes):
+            kv_device.init(key, mx.nd.zeros(shape, mx.gpu(0)))
+        for key, shape in enumerate(tree_shapes):
+            arr_list = [mx.nd.ones(shape, mx.gpu(x)) * (x + 1) for x in range(n_gpus)]
+            res = [mx.nd.zeros(shape, mx.gpu(x)) for x in range(n_gpus)]
+            kv_device.push(key, arr_list)
+            kv_device.pull(key, res)
+            expected = n_gpus * (n_gpus + 1) / 2
+            for x in range(n_gpus):
+                assert np.all(res[x].asnumpy() == expected)
+
+
 if __name__ == '__main__':
     test_device_pushpull()
@@ -273,6 +273,21 @@ def test_fusion_compiler_cache():
     if num_gpus > 1:
         check_fused_symbol(a+b, ctx=mx.gpu(1), a=arr1, b=arr2)
 
+def test_fusion_disk_cache(tmpdir):
+    a = mx.sym.Variable('a')
+    b = mx.sym.Variable('b')
+    shape = rand_shape_2d()
+    arr1 = mx.random.uniform(shape=shape)
+    arr2 = mx.random.uniform(shape=shape)
+    cache_dir = str(tmpdir)
+    # An op chain no other test fuses, so its kernels are not compiled yet
+    with environment('MXNET_RTC_CACHE_DIR', cache_dir):
+        check_fused_symbol(mx.sym.arcsinh(mx.sym.radians(a)) * mx.sym.log1p(b),
+                           ctx=mx.gpu(0), a=arr1, b=arr2)
+    cached = [f for f in os.listdir(cache_dir) if f.endswith('.rtc')]
+    assert len(cached) > 0
+    assert all(os.path.getsize(os.path.join(cache_dir, f)) > 0 for f in cached)
+
 @use_np
 def test_fusion_boolean_inputs():
     from mxnet.gluon import HybridBlock
@@ -373,7 +373,7 @@ def test_global_norm_clip_multi_device():
         assert_almost_equal(x4, _np.ones((7, 4)) / 9)
 
 
-def _check_batchnorm_result(input, num_devices=1, cuda=False):
+def _check_batchnorm_result(input, num_devices=1, cuda=False, comm='shared'):
     from mxnet.gluon.utils import split_and_load
     def _find_bn(module):
         if isinstance(module, (mx.gluon.nn.BatchNorm, mx.gluon.nn.SyncBatchNorm)):
@@ -401,7 +401,7 @@ def _check_batchnorm_result(input, num_devices=1, cuda=False):
 
     nch = input.shape[1]
     bn1 = mx.gluon.nn.BatchNorm(in_channels=nch)
-    bn2 = mx.gluon.nn.SyncBatchNorm(in_channels=nch, num_devices=num_devices)
+    bn2 = mx.gluon.nn.SyncBatchNorm(in_channels=nch, num_devices=num_devices, comm=comm)
 
     bn1.initialize(device=device_list[0])
     bn2.initialize(device=device_list)
@@ -410,7 +410,7 @@ def _check_batchnorm_result(input, num_devices=1, cuda=False):
     #_syncParameters(_find_bn(bn1), _find_bn(bn2), device_list[0])
 
     input1.attach_grad()
-    inputs2 = split_and_load(input2, device_list, batch_axis=0)
+    inputs2 = split_and_load(input2, device_list, batch_axis=0, even_split=False)
     for xi in inputs2:
         xi.attach_grad()
 
@@ -452,6 +452,21 @@ def test_sync_batchnorm():
         _check_batchnorm_result(mx.np.random.uniform(size=(4, 1, 4, 4)),
                                 num_devices=ndev, cuda=True)
 
+def _test_sync_batchnorm_nccl(seed):
+    mx.npx.set_np()
+    ndev = mx.device.num_gpus()
+    mx.gluon.nn.SyncBatchNorm.init_nccl(mx.kv.create('device'), [mx.gpu(i) for i in range(ndev)])
+    # batches of different sizes on the GPUs
+    with random_seed(seed):
+        for _ in range(5):
+            _check_batchnorm_result(mx.np.random.uniform(size=(2 * ndev + 1, 3, 4, 4)),
+                                    num_devices=ndev, cuda=True, comm='nccl')
+
+@pytest.mark.skipif(not mx.runtime.Features().is_enabled('NCCL'), reason='requires NCCL')
+def test_sync_batchnorm_nccl():
+    # the NCCL group is set up once per process
+    run_in_spawned_process(_test_sync_batchnorm_nccl, {})
+
 def test_symbol_block_fp16(tmpdir):
     # Test case to verify if initializing the SymbolBlock from a model with params
     # other than fp32 param dtype.
@@ -704,3 +719,71 @@ def test_cuda_graphs():
                     if p1.grad_req != 'null':
                         assert_almost_equal(p1.grad(), p2.grad())
             mx.npx.waitall()
+
+@mx.util.use_np
+def test_cuda_graphs_shape_cache():
+    net = mx.gluon.nn.HybridSequential()
+    net.add(mx.gluon.nn.Dense(16, activation='tanh'), mx.gluon.nn.Dense(4))
+    netg = mx.gluon.nn.HybridSequential()
+    netg.add(mx.gluon.nn.Dense(16, activation='tanh'), mx.gluon.nn.Dense(4))
+    device = mx.gpu(0)
+    net.initialize(device=device)
+    netg.initialize(device=device)
+    net(mx.np.ones((2, 8), device=device))
+    netg(mx.np.ones((2, 8), device=device))
+    for p1, p2 in zip(net.collect_params().values(), netg.collect_params().values()):
+        p2.set_data(p1.data())
+
+    with environment({'MXNET_ENABLE_CUDA_GRAPHS': '1',
+                      'MXNET_CUDA_GRAPHS_SHAPE_CACHE_MB': '64',
+                      'MXNET_USE_FUSION': '0'}):
+        netg.hybridize(static_alloc=True, static_shape=True)
+        # alternate between shapes, so that the graphs of each one are replayed
+        for batch in [3, 5, 3, 5, 7, 3, 5, 7]:
+            x = mx.np.random.uniform(size=(batch, 8), device=device)
+            xg = x.copy()
+            x.attach_grad()
+            xg.attach_grad()
+            with mx.autograd.record():
+                out = net(x)
+            out.backward()
+            with mx.autograd.record():
+                outg = netg(xg)
+            outg.backward()
+            assert_almost_equal(out, outg)
+            assert_almost_equal(x.grad, xg.grad)
+            for p1, p2 in zip(net.collect_params().values(), netg.collect_params().values()):
+                assert_almost_equal(p1.grad(), p2.grad())
+        mx.npx.waitall()
+
+
+def test_cached_op_offload():
+    x = mx.sym.Variable('x')
+    w = mx.sym.Variable('w')
+    y = mx.sym.FullyConnected(x, w, num_hidden=256, no_bias=True)
+    y = mx.sym.sigmoid(mx.sym.tanh(mx.sym.relu(y) * 2) + 1)
+    y = mx.sym.FullyConnected(y, w, num_hidden=256, no_bias=True)
+    x_np = _np.random.uniform(-1, 1, (512, 256))
+    w_np = _np.random.uniform(-1, 1, (256, 256))
+
+    def run(flags, retain_graph=False):
+        exe = mx.ndarray.CachedOp(y, flags)
+        xs = [mx.nd.array(x_np, ctx=mx.gpu(0)), mx.nd.array(w_np, ctx=mx.gpu(0))]
+        for a in xs:
+            a.attach_grad()
+        with mx.autograd.record():
+            out = exe(*xs, default_device=mx.gpu(0))
+        out.backward(retain_graph=retain_graph)
+        if retain_graph:
+            out.backward()
+        return out.asnumpy(), [a.grad.asnumpy() for a in xs]
+
+    out, grads = run([])
+    for prefetch in [0, 1, 4]:
+        for retain_graph in [False, True]:
+            # the activations of 512x256 floats exceed a budget of 1MB, and are offloaded
+            r_out, r_grads = run([('offload_budget', 1), ('offload_prefetch', prefetch)],
+                                 retain_graph)
+            assert_almost_equal(r_out, out)
+            for g, r_g in zip(grads, r_grads):
+                assert_almost_equal(r_g, g)
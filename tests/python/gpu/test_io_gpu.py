@@ -0,0 +1,89 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+import os
+import mxnet as mx
+import numpy as np
+import pytest
+from mxnet.test_utils import get_cifar10, assert_almost_equal
+
+
+@pytest.mark.skipif(not mx.runtime.Features().is_enabled('NVJPEG'),
+                    reason='MXNet is not built with nvJPEG')
+@pytest.mark.parametrize('dtype', ['float32', 'uint8'])
+def test_ImageRecordIter_decode_gpu(tmpdir, dtype):
+    path = str(tmpdir)
+    get_cifar10(path)
+    kwargs = dict(
+        path_imgrec=os.path.join(path, 'cifar', 'test.rec'),
+        data_shape=(3, 28, 28),
+        batch_size=64,
+        mean_r=125.3, mean_g=123.0, mean_b=113.9,
+        std_r=63.0, std_g=62.1, std_b=66.7,
+        dtype=dtype,
+        device_id=0)
+    cpu_iter = mx.io.ImageRecordIter(**kwargs)
+    gpu_iter = mx.io.ImageRecordIter(decode_device='gpu', **kwargs)
+    # the center crops sample whole pixels, so the batches only differ by the JPEG decoders
+    atol = 0.1 if dtype == 'float32' else 4
+    num_batches = 0
+    for cpu_batch, gpu_batch in zip(cpu_iter, gpu_iter):
+        assert gpu_batch.data[0].context == mx.gpu(0)
+        assert gpu_batch.pad == cpu_batch.pad
+        assert_almost_equal(gpu_batch.label[0], cpu_batch.label[0])
+        assert_almost_equal(gpu_batch.data[0].asnumpy().astype('float32'),
+                            cpu_batch.data[0].asnumpy().astype('float32'), rtol=0, atol=atol)
+        num_batches += 1
+    assert num_batches == (10000 + 63) // 64
+
+
+@pytest.mark.skipif(not mx.runtime.Features().is_enabled('NVJPEG'),
+                    reason='MXNet is not built with nvJPEG')
+@pytest.mark.parametrize('mirror', [0, 1])
+def test_ImageDetRecordIter_decode_gpu(tmpdir, mirror):
+    path = str(tmpdir)
+    get_cifar10(path)
+    # images with 1 to 3 objects, labelled as header_width, object_width, [id, box] x N
+    reader = mx.recordio.MXRecordIO(os.path.join(path, 'cifar', 'test.rec'), 'r')
+    det_path = os.path.join(path, 'det.rec')
+    writer = mx.recordio.MXRecordIO(det_path, 'w')
+    for i in range(200):
+        _, img = mx.recordio.unpack(reader.read())
+        label = np.array([2, 5] + [i, 0.1, 0.2, 0.6, 0.7] * (i % 3 + 1), dtype=np.float32)
+        writer.write(mx.recordio.pack(mx.recordio.IRHeader(0, label, i, 0), img))
+    writer.close()
+    reader.close()
+
+    kwargs = dict(path_imgrec=det_path, data_shape=(3, 28, 28), batch_size=32,
+                  rand_mirror_prob=mirror, mean_r=125.3, mean_g=123.0, mean_b=113.9,
+                  std_r=63.0, std_g=62.1, std_b=66.7, device_id=0, label_ragged=True)
+    cpu_iter = mx.io.ImageDetRecordIter(**kwargs)
+    gpu_iter = mx.io.ImageDetRecordIter(decode_device='gpu', **kwargs)
+    num_batches = 0
+    for _, _ in zip(cpu_iter, gpu_iter):
+        cpu_items = [x.asnumpy() for x in cpu_iter.getitems()]
+        gpu_data, gpu_values, gpu_offsets = gpu_iter.getitems()
+        assert gpu_data.context == mx.gpu(0)
+        assert_almost_equal(gpu_offsets.asnumpy(), cpu_items[2])
+        assert_almost_equal(gpu_values.asnumpy(), cpu_items[1])
+        if mirror:
+            # the boxes are mirrored with the images
+            assert_almost_equal(gpu_values.asnumpy()[3:5], np.array([0.4, 0.2]))
+        # both resize bilinearly, the batches only differ by the decoders and rounding
+        assert_almost_equal(gpu_data.asnumpy(), cpu_items[0], rtol=0, atol=0.1)
+        num_batches += 1
+    assert num_batches == (200 + 31) // 32
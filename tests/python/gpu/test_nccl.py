@@ -19,6 +19,7 @@ import mxnet as mx
 import numpy as np
 import os
 import pytest
+from mxnet.test_utils import environment
 
 shapes = [(10), (100), (1000), (10000), (100000), (2,2), (2,3,4,5,6,7,8)]
 keys = [1,2,3,4,5,6,7]
@@ -49,5 +50,30 @@ def test_nccl_pushpull():
 
     print ("Passed")
 
+@pytest.mark.skip(reason="Test requires NCCL library installed and enabled during build")
+def test_nccl_pushpull_bucketed():
+    # small keys of two data types are packed into buckets, the large one is not
+    bucket_shapes = [(3,), (10, 10), (1000,), (7, 5), (200000,), (16,)]
+    dtypes = ['float32', 'float16', 'float32', 'float16', 'float32', 'float32']
+    with environment('MXNET_KVSTORE_NCCL_BUCKET_SIZE', str(64 * 1024)):
+        kv_nccl = mx.kv.create('nccl')
+    n_gpus = max(gpus)
+    keys = [str(i) for i in range(len(bucket_shapes))]
+    for key, shape, dtype in zip(keys, bucket_shapes, dtypes):
+        kv_nccl.init(key, mx.nd.zeros(shape, mx.gpu(0), dtype=dtype))
+    for step in range(2):
+        vals = [[mx.nd.ones(shape, mx.gpu(x), dtype=dtype) * (x + k + step)
+                 for x in range(n_gpus)]
+                for k, (shape, dtype) in enumerate(zip(bucket_shapes, dtypes))]
+        res = [[mx.nd.zeros(shape, mx.gpu(x), dtype=dtype) for x in range(n_gpus)]
+               for shape, dtype in zip(bucket_shapes, dtypes)]
+        kv_nccl.push(keys, vals)
+        kv_nccl.pull(keys, out=res)
+        for k in range(len(keys)):
+            expected = sum(x + k + step for x in range(n_gpus))
+            for x in range(n_gpus):
+                assert np.all(res[k][x].asnumpy() == expected)
+
 if __name__ == '__main__':
     test_nccl_pushpull()
+    test_nccl_pushpull_bucketed()
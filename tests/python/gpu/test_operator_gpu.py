@@ -659,6 +659,34 @@ def test_convolution_multiple_streams():
             print('Finished engine {} with {} streams.'.format(engine, num_streams), file=sys.stderr)
 
 
+def _branches_with_stream_pool(seed):
+    with random_seed(seed):
+        # independent towers reading the same input, then merged, as in an Inception block
+        x_np = np.random.uniform(-1, 1, size=(4, 8, 16, 16)).astype(np.float32)
+        ws = [np.random.uniform(-1, 1, size=(8, 8, 3, 3)).astype(np.float32) for _ in range(4)]
+        results = []
+        for ctx in [mx.cpu(), mx.gpu(0)]:
+            x = mx.nd.array(x_np, ctx=ctx)
+            towers = []
+            for w in ws:
+                y = x
+                for _ in range(3):
+                    y = mx.nd.Convolution(y, mx.nd.array(w, ctx=ctx), kernel=(3, 3), pad=(1, 1),
+                                          num_filter=8, no_bias=True)
+                    y = mx.nd.relu(y) * 0.1
+                towers.append(y)
+            results.append(mx.nd.concat(*towers, dim=1).asnumpy())
+        assert_allclose(results[0], results[1], rtol=1e-3, atol=1e-4)
+
+
+@pytest.mark.serial
+def test_gpu_worker_stream_pool():
+    for pool_size in ['1', '4']:
+        for engine in ['ThreadedEnginePerDevice', 'ThreadedEnginePerDeviceAsync']:
+            run_in_spawned_process(_branches_with_stream_pool,
+                {'MXNET_GPU_WORKER_STREAM_POOL_SIZE' : pool_size, 'MXNET_ENGINE_TYPE' : engine})
+
+
 # This test is designed to expose an issue with cudnn v7.1.4 algo find() when invoked with large c.
 # Algos returned by find() can fail to run with grad_req='add' (wgrad kernel beta parameter == 1.0f).
 @pytest.mark.serial
@@ -933,6 +961,11 @@ def test_spatial_transformer_with_type():
                                     transform_type="affine", sampler_type="bilinear", cudnn_off=False)
     check_consistency(sym, ctx_list)
     check_consistency(sym, ctx_list, grad_req="add")
+    sym = mx.sym.SpatialTransformer(data=data, loc=loc, target_shape=(4, 4),
+                                    transform_type="affine", sampler_type="bilinear", cudnn_off=True)
+    ctx_list = [{'ctx': mx.gpu(0), 'data': (32, 3, 12, 12), 'type_dict': {'data': np.float16}},
+                {'ctx': mx.cpu(0), 'data': (32, 3, 12, 12), 'type_dict': {'data': np.float16}}]
+    check_consistency(sym, ctx_list)
 
 def test_pooling_with_type2():
     # While the float32 and float64 output is reliably consistent, float16 departs occasionally.
@@ -1749,6 +1782,98 @@ def test_deformable_convolution_options():
     check_consistency(sym, ctx_list, scale=0.1, rtol=tol, atol=tol)
 
 
+def test_deformable_convolution_multiple_tiles():
+    tol = {np.dtype(np.float32): 1e-1,
+           np.dtype(np.float64): 1e-3}
+    # more output channels, pixels and reduction rows than a tile of the implicit GEMM, with groups
+    shapes = {'deformable_conv_data': (2, 8, 11, 11),
+              'deformable_conv_offset': (2, 36, 11, 11)}
+    ctx_list = [dict(ctx=ctx, type_dict={'deformable_conv_data': dtype,
+                                         'deformable_conv_offset': dtype}, **shapes)
+                for ctx in [mx.gpu(0), mx.cpu(0)] for dtype in [np.float64, np.float32]]
+    sym = mx.sym.npx.deformable_convolution(num_filter=72, kernel=(3,3), pad=(1,1), num_group=2,
+                                            num_deformable_group=2, name='deformable_conv')
+    check_consistency(sym, ctx_list, scale=0.1, rtol=tol, atol=tol)
+
+
+@pytest.mark.parametrize('position_sensitive', [False, True])
+def test_roi_align_fp16_and_deterministic(position_sensitive):
+    pooled_size = (3, 4)
+    C = 2 * pooled_size[0] * pooled_size[1] if position_sensitive else 8
+    data = mx.nd.random.uniform(-1, 1, (3, C, 20, 24), ctx=mx.gpu(0))
+    xy = mx.nd.random.uniform(-10, 150, (40, 2), ctx=mx.gpu(0))
+    wh = mx.nd.random.uniform(0, 120, (40, 2), ctx=mx.gpu(0))
+    batch_ind = mx.nd.array(np.random.randint(-1, 3, size=(40, 1)), ctx=mx.gpu(0))
+    # integer coordinates, exact in float16
+    rois = mx.nd.concat(batch_ind, xy, xy + wh, dim=1).round()
+
+    def forward_backward(dtype, deterministic):
+        x = data.astype(dtype)
+        x.attach_grad()
+        with environment('MXNET_ENFORCE_DETERMINISM', deterministic):
+            with mx.autograd.record():
+                y = mx.nd.contrib.ROIAlign(x, rois.astype(dtype), pooled_size=pooled_size,
+                                           spatial_scale=0.125, sample_ratio=-1,
+                                           position_sensitive=position_sensitive)
+            y.backward(mx.nd.ones_like(y))
+        return y.asnumpy().astype(np.float32), x.grad.asnumpy().astype(np.float32)
+
+    out, grad = forward_backward('float32', '0')
+    det_out, det_grad = forward_backward('float32', '1')
+    assert_almost_equal(det_out, out)
+    assert_almost_equal(det_grad, grad, rtol=1e-4, atol=1e-5)
+    # the deterministic backward is identical across runs
+    assert same(forward_backward('float32', '1')[1], det_grad)
+    for deterministic in ['0', '1']:
+        out16, grad16 = forward_backward('float16', deterministic)
+        assert_almost_equal(out16, out, rtol=1e-2, atol=1e-2)
+        assert_almost_equal(grad16, grad, rtol=1e-2, atol=1e-2)
+
+
+@pytest.mark.parametrize('deterministic', ['0', '1'])
+@pytest.mark.parametrize('dtype', ['float16', 'float32'])
+def test_scatter_add_deterministic(deterministic, dtype):
+    ctx = mx.gpu(0)
+    rtol, atol = (1e-2, 5e-2) if dtype == 'float16' else (1e-5, 1e-5)
+    # many indices per row take the sorted path even without MXNET_ENFORCE_DETERMINISM
+    for num_rows, num_idx in [(5, 400), (60, 30)]:
+        idx = np.random.randint(0, num_rows, size=(num_idx,))
+        val = np.random.uniform(-1, 1, size=(num_idx, 7)).astype(dtype)
+        expected = np.zeros((num_rows, 7), dtype=np.float64)
+        np.add.at(expected, idx, val.astype(np.float64))
+        last = np.zeros((num_rows, 7), dtype=dtype)
+        for i, row in enumerate(idx):
+            last[row] = val[i]
+
+        def index_add():
+            a = mx.np.zeros((num_rows, 7), dtype=dtype, device=ctx)
+            ind = mx.np.array(idx, dtype='int32', device=ctx)
+            return mx.npx.index_add(a, ind, mx.np.array(val, device=ctx)).asnumpy()
+
+        def grad_of(op):
+            x = mx.nd.zeros((num_rows, 7), dtype=dtype, ctx=ctx)
+            x.attach_grad()
+            with mx.autograd.record():
+                y = op(x)
+            y.backward(mx.nd.array(val, dtype=dtype, ctx=ctx))
+            return x.grad.asnumpy()
+
+        with environment('MXNET_ENFORCE_DETERMINISM', deterministic):
+            out = index_add()
+            assert_almost_equal(out, expected, rtol=rtol, atol=atol)
+            if deterministic == '1':
+                assert same(index_add(), out)
+            nd_idx = mx.nd.array(idx, ctx=ctx)
+            gather_grad = grad_of(lambda x: mx.nd.gather_nd(x, nd_idx.reshape((1, -1))))
+            assert_almost_equal(gather_grad, expected, rtol=rtol, atol=atol)
+            take_grad = grad_of(lambda x: mx.nd.take(x, nd_idx))
+            assert_almost_equal(take_grad, expected, rtol=rtol, atol=atol)
+            scattered = mx.nd.scatter_nd(mx.nd.array(val, dtype=dtype, ctx=ctx),
+                                         nd_idx.reshape((1, -1)), shape=(num_rows, 7)).asnumpy()
+            if deterministic == '1':
+                assert same(scattered, last)
+
+
 def check_rnn_layer(layer):
     layer.initialize(ctx=[mx.cpu(0), mx.gpu(0)])
     with mx.gpu(0):
@@ -2219,3 +2344,87 @@ def test_split_v2_fwd(dtype):
     data = mx.sym.Variable("data")
     sym = mx.sym.split_v2(data, indices_or_sections=indices, axis=axis)
     check_symbolic_forward(sym, {"data": mx_data}, np_out, rtol=1e-3, atol=1e-5)
+
+@pytest.mark.parametrize('dtype,shape,axis', [
+    ('float32', (4, 8, 5, 5), 1),
+    ('float16', (4, 5, 5, 8), 3),
+])
+def test_batch_norm_add_relu(dtype, shape, axis):
+    ctx = mx.gpu(0)
+    nch = shape[axis]
+    x = mx.nd.random.uniform(-1, 1, shape=shape, ctx=ctx, dtype=dtype)
+    z = mx.nd.random.uniform(-1, 1, shape=shape, ctx=ctx, dtype=dtype)
+    gamma = mx.nd.random.uniform(0.5, 1.5, shape=(nch,), ctx=ctx)
+    beta = mx.nd.random.uniform(-0.5, 0.5, shape=(nch,), ctx=ctx)
+    dy = mx.nd.random.uniform(-1, 1, shape=shape, ctx=ctx, dtype=dtype)
+
+    def run(fused):
+        mean = mx.nd.zeros((nch,), ctx=ctx)
+        var = mx.nd.ones((nch,), ctx=ctx)
+        args = [a.copy() for a in (x, gamma, beta, z)]
+        for a in args:
+            a.attach_grad()
+        with autograd.record():
+            if fused:
+                out = mx.nd.contrib.BatchNormAddRelu(args[0], args[1], args[2], mean, var, args[3],
+                                                     fix_gamma=False, axis=axis)
+            else:
+                bn = mx.nd.BatchNorm(args[0], args[1], args[2], mean, var,
+                                     fix_gamma=False, axis=axis)
+                out = mx.nd.relu(bn + args[3])
+        out.backward(dy)
+        return [out, mean, var] + [a.grad for a in args]
+
+    rtol, atol = (1e-2, 1e-2) if dtype == 'float16' else (1e-4, 1e-4)
+    for fused, unfused in zip(run(True), run(False)):
+        assert_almost_equal(fused, unfused, rtol=rtol, atol=atol)
+
+
+@mx.util.use_np
+def test_cudnn_subgraph_conv_bn_add_relu():
+    class ResidualTail(mx.gluon.HybridBlock):
+        def __init__(self):
+            super(ResidualTail, self).__init__()
+            self.conv = mx.gluon.nn.Conv2D(8, 3, padding=1, use_bias=False)
+            self.bn = mx.gluon.nn.BatchNorm()
+
+        def forward(self, x, z):
+            return mx.npx.relu(self.bn(self.conv(x)) + z)
+
+    net = ResidualTail()
+    net.initialize(device=mx.gpu(0))
+    x = mx.np.random.uniform(-1, 1, size=(2, 8, 6, 6), device=mx.gpu(0))
+    z = mx.np.random.uniform(-1, 1, size=(2, 8, 6, 6), device=mx.gpu(0))
+    net(x, z)
+    net.bn.running_mean.set_data(mx.np.random.uniform(-0.5, 0.5, size=(8,), device=mx.gpu(0)))
+    net.bn.running_var.set_data(mx.np.random.uniform(0.5, 1.5, size=(8,), device=mx.gpu(0)))
+    net.hybridize()
+    ref = net(x, z)
+    net.hybridize(backend='CUDNN')
+    out = net(x, z)
+    assert_almost_equal(out, ref, rtol=1e-4, atol=1e-4)
+
+
+def _export_cuda_ipc_worker(queue, done):
+    w = mx.nd.array(np.arange(12).reshape(3, 4), ctx=mx.gpu(0), dtype='float32')
+    exported = mx.nd.export_cuda_ipc({'w': w})
+    queue.put(exported)
+    done.wait()
+    mx.nd.release_cuda_ipc(exported)
+
+
+def test_cuda_ipc_parameters():
+    ctx = mp.get_context('spawn')
+    queue, done = ctx.Queue(), ctx.Event()
+    sidecar = ctx.Process(target=_export_cuda_ipc_worker, args=(queue, done))
+    sidecar.start()
+    try:
+        arrays = mx.nd.import_cuda_ipc(queue.get(timeout=120))
+        assert arrays['w'].context == mx.gpu(0)
+        assert_almost_equal(arrays['w'], np.arange(12).reshape(3, 4))
+        del arrays
+        mx.nd.waitall()
+    finally:
+        done.set()
+        sidecar.join()
+    assert sidecar.exitcode == 0
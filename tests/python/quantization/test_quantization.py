@@ -18,6 +18,7 @@
 """Some of the tests using CUDNN require a special GPU instruction called dp4a.
 Ref: http://images.nvidia.com/content/pdf/tesla/184457-Tesla-P4-Datasheet-NV-Final-Letter-Web.pdf
 """
+import json
 import os
 import mxnet as mx
 import numpy as onp
@@ -1448,6 +1449,56 @@ def test_quantization_net_with_different_data_inputs_options():
 
 
 
+@mx.util.use_np
+def test_quantize_aware_training():
+    if is_test_for_native_cpu():
+        print('skipped testing test_quantize_aware_training for native cpu since it is not supported yet')
+        return
+    elif is_test_for_gpu():
+        print('skipped testing test_quantize_aware_training for gpu since it is not supported yet')
+        return
+
+    net = FP32Net()
+    net.initialize()
+    data_shape = (8, 3, 16, 16)
+    data = mx.np.random.uniform(size=data_shape)
+    # moving statistics for the folded BatchNorm
+    with mx.autograd.record():
+        net(data)
+    ref = net(data)
+
+    for quantize_granularity in ['tensor-wise', 'channel-wise']:
+        qat_net = mx.contrib.quant.quantize_aware_net(net, data,
+                                                      quantize_granularity=quantize_granularity)
+        sym, _ = qat_net.export(None)
+        ops = [node['op'] for node in json.loads(sym.tojson())['nodes']]
+        assert 'BatchNorm' not in ops
+        assert ops.count('_contrib_fake_quantize') == 4
+        assert_almost_equal(qat_net(data), ref, rtol=1e-2, atol=1e-2)
+
+        trainer = mx.gluon.Trainer(qat_net.collect_params(), 'sgd', {'learning_rate': 0.01})
+        label = mx.np.random.uniform(size=ref.shape)
+        with mx.autograd.record():
+            loss = (qat_net(data) * label).sum()
+        loss.backward()
+        trainer.step(data_shape[0])
+        scales = [v for k, v in qat_net.collect_params().items() if k.endswith('_scale')]
+        assert len(scales) == 4 and all(v.grad() is not None for v in scales)
+
+        qat_out = qat_net(data)
+        # no calibration data, the thresholds are the trained scales
+        quantized_net = mx.contrib.quant.quantize_net(qat_net, calib_mode='qat',
+                                                      quantize_granularity=quantize_granularity,
+                                                      data_shapes=[data_shape],
+                                                      device=mx.current_device())
+        qsym, _ = quantized_net.export(None)
+        for node in json.loads(qsym.tojson())['nodes']:
+            assert node['op'] != '_contrib_fake_quantize'
+            if node['op'] == '_contrib_quantize_v2':
+                assert 'min_calib_range' in node['attrs']
+        assert_almost_equal(quantized_net(data), qat_out, rtol=1e-2, atol=1e-2)
+
+
 def test_optimal_threshold_adversarial_case():
     # The worst case for the optimal_threshold function is when the values are concentrated
     # at one edge: [0, 0, ..., 1000]. (histogram)
@@ -1492,6 +1543,60 @@ def test_get_optimal_thresholds():
         assert_almost_equal(onp.array([min_max_dict['layer1'][1]]), expected_threshold, rtol=1e-2, atol=1e-4)
 
 
+def test_calib_histogram():
+    num_bins = 101
+    th = 3.
+    data = [mx.nd.random.normal(shape=(8, 3, 23, 23)) for _ in range(3)]
+    hist = mx.nd.zeros((num_bins,))
+    for arr in data:
+        mx.nd.contrib.calib_histogram(arr, hist, max_range=th, out=hist)
+    arr = onp.concatenate([a.asnumpy().ravel() for a in data])
+    expected, _ = onp.histogram(arr, bins=num_bins, range=(-th, th))
+    # values on the edges of the bins may be counted in the neighbouring bin
+    assert onp.abs(hist.asnumpy() - expected).sum() <= 1e-3 * expected.sum()
+    assert hist.asnumpy().sum() == expected.sum()
+
+
+def test_get_optimal_thresholds_multiple_layers():
+    # layers searched in one call get the thresholds they get when searched alone
+    hist_dict = {}
+    for name, (low, high) in [('layer1', (-3., 5.)), ('layer2', (0., 2.)), ('layer3', (-1., 1.))]:
+        arr = onp.random.uniform(low=low, high=high, size=(8, 3, 23, 23))
+        min_range, max_range = onp.min(arr), onp.max(arr)
+        th = max(abs(min_range), abs(max_range))
+        hist, hist_edges = onp.histogram(arr, bins=8001, range=(-th, th))
+        hist_dict[name] = (hist, hist_edges, min_range, max_range, th)
+    for dtype in ['int8', 'auto']:
+        expected = {}
+        for name, hist_data in hist_dict.items():
+            _, _, th, _ = mx.contrib.quant._LayerHistogramCollector.get_optimal_threshold(hist_data, dtype)
+            expected[name] = float(th[0])
+        min_max_dict = mx.contrib.quant._LayerHistogramCollector.get_optimal_thresholds(dict(hist_dict), dtype)
+        for name, th in expected.items():
+            assert abs(min_max_dict[name][1] - th) < 1e-5
+        assert min_max_dict['layer2'][0] == (0 if dtype == 'auto' else -min_max_dict['layer2'][1])
+
+
+def test_layer_histogram_collector():
+    collector = mx.contrib.quant._LayerHistogramCollector(quantized_dtype='int8', num_bins=8001,
+                                                          include_layers=['layer1'])
+    data = [mx.nd.random.uniform(low=-4., high=2., shape=(4, 16, 8, 8)) for _ in range(2)]
+    for i in range(collector.num_passes):
+        if i > 0:
+            collector.next_pass()
+        for arr in data:
+            collector.collect('layer1', 'op', arr)
+            collector.collect('layer2', 'op', arr)
+    min_max_dict = collector.post_collect()
+    assert list(min_max_dict.keys()) == ['layer1']
+    arr = onp.concatenate([a.asnumpy() for a in data])
+    th = onp.abs(arr).max()
+    hist, hist_edges = onp.histogram(arr, bins=8001, range=(-th, th))
+    _, _, expected, _ = mx.contrib.quant._LayerHistogramCollector.get_optimal_threshold(
+        (hist, hist_edges, arr.min(), arr.max(), th), 'int8')
+    assert_almost_equal(onp.array([min_max_dict['layer1'][1]]), expected, rtol=1e-3, atol=1e-3)
+
+
 @use_np
 def test_rnn_quantization():
     data_low = -1
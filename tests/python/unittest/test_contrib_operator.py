@@ -23,8 +23,10 @@ import random
 import itertools
 from numpy.testing import assert_allclose, assert_array_equal
 from mxnet.test_utils import *
+from mxnet.base import MXNetError
 from common import assert_raises_cudnn_not_satisfied, xfail_when_nonstandard_decimal_separator
 import unittest
+import pytest
 
 def test_box_nms_op():
     def test_box_nms_forward(data, expected, thresh=0.5, valid=0, topk=-1, coord=2, score=1, cid=0, bid=-1,
@@ -454,6 +456,297 @@ def test_dynamic_reshape():
     for test_case in test_cases:
         dynamic_reshape_testcases(*test_case)
 
+@pytest.mark.parametrize('mode', ['sum', 'mean'])
+@pytest.mark.parametrize('use_weights', [False, True])
+@pytest.mark.parametrize('sparse_grad', [False, True])
+def test_embedding_bag(mode, use_weights, sparse_grad):
+    in_dim, out_dim = 50, 7
+    bag_sizes = np.random.randint(0, 6, size=20)
+    offsets = np.concatenate([[0], np.cumsum(bag_sizes)]).astype(np.int64)
+    data = np.random.randint(0, in_dim, size=offsets[-1])
+    weight = np.random.uniform(-1, 1, size=(in_dim, out_dim))
+    per_sample_weights = np.random.uniform(-1, 1, size=data.shape)
+    ograd = np.random.uniform(-1, 1, size=(len(bag_sizes), out_dim))
+    # reference: the embeddings of all indices, reduced over each bag
+    scale = per_sample_weights if use_weights else np.ones(data.shape)
+    if mode == 'mean':
+        scale = scale / np.repeat(np.maximum(bag_sizes, 1), bag_sizes)
+    bag_of = np.repeat(np.arange(len(bag_sizes)), bag_sizes)
+    expected = np.zeros((len(bag_sizes), out_dim))
+    np.add.at(expected, bag_of, scale[:, None] * weight[data])
+    expected_grad = np.zeros((in_dim, out_dim))
+    np.add.at(expected_grad, data, scale[:, None] * ograd[bag_of])
+    expected_weights_grad = (weight[data] * ograd[bag_of]).sum(axis=1)
+    if mode == 'mean':
+        expected_weights_grad /= np.repeat(np.maximum(bag_sizes, 1), bag_sizes)
+
+    mx_data = mx.nd.array(data)
+    mx_offsets = mx.nd.array(offsets, dtype='int64')
+    mx_weight = mx.nd.array(weight)
+    mx_weight.attach_grad(stype='row_sparse' if sparse_grad else 'default')
+    inputs = [mx_data, mx_offsets, mx_weight]
+    if use_weights:
+        mx_per_sample_weights = mx.nd.array(per_sample_weights)
+        mx_per_sample_weights.attach_grad()
+        inputs.append(mx_per_sample_weights)
+    with mx.autograd.record():
+        out = mx.nd.contrib.embedding_bag(*inputs, input_dim=in_dim, output_dim=out_dim,
+                                          mode=mode, use_weights=use_weights,
+                                          sparse_grad=sparse_grad)
+    out.backward(mx.nd.array(ograd))
+    assert_almost_equal(out, expected, rtol=1e-4, atol=1e-5)
+    grad = mx_weight.grad
+    if sparse_grad:
+        assert grad.stype == 'row_sparse'
+        assert_almost_equal(grad.indices.asnumpy(), np.unique(data))
+    assert_almost_equal(grad.asnumpy(), expected_grad, rtol=1e-4, atol=1e-5)
+    if use_weights:
+        assert_almost_equal(mx_per_sample_weights.grad, expected_weights_grad,
+                            rtol=1e-4, atol=1e-5)
+
+@pytest.mark.parametrize('causal', [False, True])
+@pytest.mark.parametrize('use_mask', [False, True])
+def test_sdp_attention(causal, use_mask):
+    batch, heads, q_len, kv_len, dim, v_dim = 2, 3, 37, 83, 11, 7
+    query = np.random.uniform(-1, 1, size=(batch, heads, q_len, dim))
+    key = np.random.uniform(-1, 1, size=(batch, heads, kv_len, dim))
+    value = np.random.uniform(-1, 1, size=(batch, heads, kv_len, v_dim))
+    ograd = np.random.uniform(-1, 1, size=(batch, heads, q_len, v_dim))
+    mask = (np.random.uniform(size=(batch, q_len, kv_len)) > 0.3).astype(np.float32)
+    # the last query attends to no key
+    mask[:, -1, :] = 0
+    visible = np.ones((batch, 1, q_len, kv_len), dtype=bool)
+    if causal:
+        visible &= np.tril(np.ones((q_len, kv_len), dtype=bool))
+    if use_mask:
+        visible &= mask[:, None] != 0
+    # reference: the materialized softmax, with the rows that see no key set to zero
+    scale = 1 / np.sqrt(dim)
+    scores = np.where(visible, scale * np.matmul(query, key.swapaxes(-1, -2)), -np.inf)
+    row_max = np.max(scores, axis=-1, keepdims=True)
+    weights = np.exp(scores - np.where(np.isinf(row_max), 0, row_max))
+    weights = weights / np.maximum(weights.sum(axis=-1, keepdims=True), 1e-30)
+    expected = np.matmul(weights, value)
+    dweights = np.matmul(ograd, value.swapaxes(-1, -2))
+    dscores = weights * (dweights - (dweights * weights).sum(axis=-1, keepdims=True))
+    expected_grads = [scale * np.matmul(dscores, key),
+                      scale * np.matmul(dscores.swapaxes(-1, -2), query),
+                      np.matmul(weights.swapaxes(-1, -2), ograd)]
+
+    inputs = [mx.nd.array(x) for x in (query, key, value)]
+    for x in inputs:
+        x.attach_grad()
+    if use_mask:
+        inputs.append(mx.nd.array(mask))
+    with mx.autograd.record():
+        out = mx.nd.contrib.sdp_attention(*inputs, causal=causal, use_mask=use_mask)
+    out.backward(mx.nd.array(ograd))
+    assert_almost_equal(out, expected, rtol=1e-4, atol=1e-5)
+    for x, expected_grad in zip(inputs, expected_grads):
+        assert_almost_equal(x.grad, expected_grad, rtol=1e-4, atol=1e-5)
+
+def test_sdp_attention_dropout():
+    batch, heads, q_len, kv_len, dim, v_dim = 2, 2, 20, 30, 8, 4
+    query = mx.nd.random.uniform(-1, 1, shape=(batch, heads, q_len, dim))
+    key = mx.nd.random.uniform(-1, 1, shape=(batch, heads, kv_len, dim))
+    value = mx.nd.ones((batch, heads, kv_len, v_dim))
+    value.attach_grad()
+    # no dropout outside of training
+    expected = mx.nd.contrib.sdp_attention(query, key, value)
+    assert_almost_equal(mx.nd.contrib.sdp_attention(query, key, value, dropout=0.5), expected)
+    with mx.autograd.record():
+        out = mx.nd.contrib.sdp_attention(query, key, value, dropout=0.5)
+    out.backward(mx.nd.ones_like(out))
+    assert not np.allclose(out.asnumpy(), expected.asnumpy())
+    # with ones as values each output is the sum of the kept weights of its query, the backward
+    # has to recompute the same dropout for the value gradient to sum to the same total
+    assert_almost_equal(value.grad.sum(), out.sum(), rtol=1e-4, atol=1e-4)
+
+def test_paged_attention():
+    num_blocks, heads, block_size, dim, v_dim, max_blocks = 12, 2, 4, 5, 3, 4
+    key_cache = mx.nd.zeros((num_blocks, heads, block_size, dim))
+    value_cache = mx.nd.zeros((num_blocks, heads, block_size, v_dim))
+    # the blocks of both sequences are interleaved and out of order
+    block_table = np.array([[7, 2, 9, 0], [3, 11, 5, 8]], dtype=np.int32)
+    keys = np.random.uniform(-1, 1, size=(2, heads, 0, dim))
+    values = np.random.uniform(-1, 1, size=(2, heads, 0, v_dim))
+
+    def check(query, seq_lens):
+        tokens = query.shape[2]
+        out = mx.nd.contrib.paged_attention(mx.nd.array(query), key_cache, value_cache,
+                                            mx.nd.array(block_table, dtype='int32'),
+                                            mx.nd.array(seq_lens, dtype='int32'))
+        for b, seq_len in enumerate(seq_lens):
+            for t in range(tokens):
+                visible = seq_len - tokens + t + 1
+                scores = np.einsum('hd,hkd->hk', query[b, :, t], keys[b, :, :visible])
+                weights = np.exp(scores / np.sqrt(dim))
+                weights /= weights.sum(axis=-1, keepdims=True)
+                expected = np.einsum('hk,hkv->hv', weights, values[b, :, :visible])
+                assert_almost_equal(out[b, :, t], expected, rtol=1e-4, atol=1e-5)
+
+    def append(new_keys, new_values, positions):
+        mx.nd.contrib.append_kv(key_cache, value_cache, mx.nd.array(new_keys),
+                                mx.nd.array(new_values), mx.nd.array(block_table, dtype='int32'),
+                                mx.nd.array(positions, dtype='int32'))
+
+    # a prefill of 3 tokens, then decoding one token at a time across block boundaries
+    for step, tokens in enumerate([3, 1, 1, 1, 1, 1, 1]):
+        new_keys = np.random.uniform(-1, 1, size=(2, heads, tokens, dim))
+        new_values = np.random.uniform(-1, 1, size=(2, heads, tokens, v_dim))
+        positions = np.array([keys.shape[2]] * 2)
+        append(new_keys, new_values, positions)
+        keys = np.concatenate([keys, new_keys], axis=2)
+        values = np.concatenate([values, new_values], axis=2)
+        check(np.random.uniform(-1, 1, size=(2, heads, tokens, dim)), positions + tokens)
+
+    # the second sequence finishes, a new request reuses its blocks from position 0
+    block_table[1] = [5, 8, 3, 11]
+    new_keys = np.random.uniform(-1, 1, size=(2, heads, 2, dim))
+    new_values = np.random.uniform(-1, 1, size=(2, heads, 2, v_dim))
+    append(new_keys, new_values, np.array([keys.shape[2], 0]))
+    keys = np.concatenate([keys, new_keys], axis=2)
+    values = np.concatenate([values, new_values], axis=2)
+    keys[1, :, :2], values[1, :, :2] = new_keys[1], new_values[1]
+    check(np.random.uniform(-1, 1, size=(2, heads, 1, dim)), np.array([keys.shape[2], 2]))
+
+    # positions outside of the block table are rejected
+    def append_past_table():
+        append(new_keys, new_values, np.array([15, 0]))
+        mx.nd.waitall()
+    assert_raises(MXNetError, append_past_table)
+
+@pytest.mark.parametrize('num_bits', [8, 4])
+@pytest.mark.parametrize('scale_dtype', ['float32', 'float16'])
+@pytest.mark.parametrize('rows', [1, 3, 20])
+@pytest.mark.parametrize('no_bias', [False, True])
+def test_weight_only_fully_connected(num_bits, scale_dtype, rows, no_bias):
+    num_hidden, in_features, group_size = 24, 64, 16
+    weight = np.random.uniform(-1, 1, size=(num_hidden, in_features)).astype(np.float32)
+    # groups with ranges far apart
+    weight[:, :group_size] *= 20
+    data = np.random.uniform(-1, 1, size=(rows, in_features)).astype(np.float32)
+    bias = np.random.uniform(-1, 1, size=(num_hidden,)).astype(np.float32)
+
+    qweight, scale = mx.nd.contrib.weight_only_quantize(mx.nd.array(weight), num_bits=num_bits,
+                                                        group_size=group_size,
+                                                        scale_dtype=scale_dtype)
+    assert qweight.dtype == (np.uint8 if num_bits == 4 else np.int8)
+    assert qweight.shape == (num_hidden, in_features * num_bits // 8)
+    assert scale.shape == (num_hidden, in_features // group_size)
+    assert scale.dtype == np.dtype(scale_dtype)
+
+    # reference: the weight dequantized in numpy
+    q = qweight.asnumpy()
+    if num_bits == 4:
+        q = np.stack([q & 0xF, q >> 4], axis=-1).reshape(num_hidden, in_features).astype(np.int32) - 8
+    qmax = 2 ** (num_bits - 1) - 1
+    assert np.abs(q).max() <= qmax
+    dequantized = q * np.repeat(scale.asnumpy().astype(np.float32), group_size, axis=1)
+    assert_almost_equal(dequantized, weight, rtol=0, atol=np.abs(weight).max() / qmax)
+    expected = np.dot(data, dequantized.T) + (0 if no_bias else bias)
+
+    inputs = [mx.nd.array(data), qweight, scale]
+    if not no_bias:
+        inputs.append(mx.nd.array(bias))
+    out = mx.nd.contrib.weight_only_fully_connected(*inputs, num_hidden=num_hidden,
+                                                    no_bias=no_bias, num_bits=num_bits,
+                                                    group_size=group_size)
+    assert_almost_equal(out, expected, rtol=1e-4, atol=1e-4)
+
+def _fp8_values(fp8_format):
+    mantissa_bits, min_exp, max_exp, max_value = \
+        (3, -6, 8, 448.) if fp8_format == 'e4m3' else (2, -14, 15, 57344.)
+    steps = 2 ** mantissa_bits
+    values = [m * 2. ** (min_exp - mantissa_bits) for m in range(steps)]
+    values += [(1 + m / steps) * 2. ** e for e in range(min_exp, max_exp + 1) for m in range(steps)]
+    values = np.array([v for v in values if v <= max_value])
+    return np.concatenate([-values[:0:-1], values])
+
+
+@pytest.mark.parametrize('fp8_format', ['e4m3', 'e5m2'])
+@pytest.mark.parametrize('dtype', ['float32', 'float16'])
+def test_fp8_cast(fp8_format, dtype):
+    grid = _fp8_values(fp8_format)
+    scale = 4.
+    data = np.random.uniform(-1.5, 1.5, size=(64, 32)) * grid.max() / scale
+    data[0, :3] = [0, grid.max(), -1e9]
+    data = data.astype(dtype)
+    x = mx.nd.array(data, dtype=dtype)
+    x.attach_grad()
+    with mx.autograd.record():
+        out, amax = mx.nd.contrib.fp8_cast(x, mx.nd.array([scale]), fp8_format=fp8_format)
+    out.backward(mx.nd.ones_like(out))
+    assert out.dtype == np.dtype(dtype)
+    assert_almost_equal(amax, np.abs(data.astype(np.float32)).max(keepdims=True).reshape(1))
+    scaled = np.clip(data.astype(np.float32) * scale, grid[0], grid[-1])
+    expected = grid[np.abs(scaled[..., None] - grid).argmin(axis=-1)] / scale
+    assert_almost_equal(out, expected.astype(dtype), rtol=1e-3, atol=0)
+    # representable values are kept, saturated values are the largest of the format
+    assert out[0, 0] == 0 and out[0, 1] == grid.max() / scale and out[0, 2] == -grid.max() / scale
+    assert_almost_equal(x.grad, np.ones(data.shape, dtype=dtype))
+
+
+def test_fp8_scale_update():
+    history = mx.nd.zeros((4,))
+    scale = mx.nd.ones((1,))
+    for amax in [2., 8., 1., float('inf'), 4., 0.5, 0.5]:
+        mx.nd.contrib.fp8_scale_update(mx.nd.array([amax]), history, scale, fp8_format='e4m3',
+                                       margin=1, out=scale)
+    # the non-finite amax is skipped, 8 and 2 fell out of the history
+    assert_almost_equal(history, np.array([0.5, 0.5, 4., 1.]))
+    assert_almost_equal(scale, np.array([448. / 4. / 2.]))
+
+    scaler = mx.amp.FP8DelayedScaler(fp8_format='e5m2', amax_history_len=2,
+                                     amax_compute_algo='most_recent')
+    scaler.cast(mx.nd.array([1., -16.]))
+    scaler.update()
+    assert_almost_equal(scaler.scale, np.array([57344. / 16.]))
+    out = scaler.cast(mx.nd.array([1., -16.]))
+    assert_almost_equal(out, np.array([1., -16.]))
+
+@pytest.mark.parametrize('quantized_dtype', ['int8', 'uint8'])
+@pytest.mark.parametrize('axis', [None, 1])
+def test_fake_quantize(quantized_dtype, axis):
+    qmin, qmax = (-127, 127) if quantized_dtype == 'int8' else (0, 255)
+    data = np.random.uniform(-2, 2, size=(4, 3, 5)).astype(np.float32)
+    scale = np.array([0.01] if axis is None else [0.01, 0.005, 0.02], dtype=np.float32)
+    s = scale if axis is None else scale.reshape((1, 3, 1))
+    ograd = np.random.uniform(-1, 1, size=data.shape).astype(np.float32)
+    x, sc = mx.nd.array(data), mx.nd.array(scale)
+    x.attach_grad()
+    sc.attach_grad()
+    with mx.autograd.record():
+        out = mx.nd.contrib.fake_quantize(x, sc, quantized_dtype=quantized_dtype, axis=axis)
+    out.backward(mx.nd.array(ograd))
+    v = data / s
+    q = np.clip(np.rint(v), qmin, qmax)
+    assert_almost_equal(out, q * s, rtol=1e-5, atol=1e-6)
+    inside = (v >= qmin) & (v <= qmax)
+    assert_almost_equal(x.grad, ograd * inside)
+    # learned step size gradient of the scale
+    terms = ograd * np.where(inside, q - v, q)
+    sum_axes = (0, 1, 2) if axis is None else (0, 2)
+    assert_almost_equal(sc.grad, terms.sum(axis=sum_axes).reshape(scale.shape),
+                        rtol=1e-4, atol=1e-4)
+
+@pytest.mark.parametrize('shape', [(3, 8), (5, 7), (2, 3, 4, 12), (1, 1)])
+def test_fft(shape):
+    data = np.random.normal(size=shape).astype(np.float32)
+    ograd = np.random.normal(size=shape[:-1] + (2 * shape[-1],)).astype(np.float32)
+    x = mx.nd.array(data)
+    x.attach_grad()
+    with mx.autograd.record():
+        out = mx.nd.contrib.fft(x)
+    out.backward(mx.nd.array(ograd))
+    ref = np.fft.fft(data.astype(np.float64), axis=-1)
+    expected = np.stack([ref.real, ref.imag], axis=-1).reshape(out.shape)
+    assert_almost_equal(out, expected, rtol=1e-4, atol=1e-4)
+    # the gradient is the real part of the unnormalized inverse transform
+    ograd_complex = ograd[..., 0::2] + 1j * ograd[..., 1::2]
+    expected_grad = np.fft.ifft(ograd_complex, axis=-1).real * shape[-1]
+    assert_almost_equal(x.grad, expected_grad, rtol=1e-4, atol=1e-4)
+
 if __name__ == '__main__':
     import nose
     nose.runmodule()
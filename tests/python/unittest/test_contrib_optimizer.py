@@ -234,3 +234,66 @@ def test_adamw():
 @pytest.mark.serial
 def test_adabelief():
     _AdaBeliefTestHelper()()
+
+
+def _indexed_update_ref(name, weight, grad, states, kwargs):
+    """numpy reference of the indexed updates on the summed gradient rows of weight"""
+    lr, wd = kwargs['lr'], kwargs.get('wd', 0.)
+    grad = grad * kwargs.get('rescale_grad', 1.)
+    if kwargs.get('clip_gradient', -1.) >= 0:
+        grad = np.clip(grad, -kwargs['clip_gradient'], kwargs['clip_gradient'])
+    if name == 'adam':
+        grad = grad + wd * weight
+        mean, var = states
+        mean[:] = 0.9 * mean + 0.1 * grad
+        var[:] = 0.999 * var + 0.001 * grad ** 2
+        return weight - lr * mean / (np.sqrt(var) + 1e-8)
+    if name == 'adamw':
+        mean, var = states
+        mean[:] = 0.9 * mean + 0.1 * grad
+        var[:] = 0.999 * var + 0.001 * grad ** 2
+        return weight - kwargs['eta'] * (lr * mean / (np.sqrt(var) + 1e-8) + wd * weight)
+    if name == 'ftrl':
+        z, n = states
+        z[:] += grad - (np.sqrt(n + grad ** 2) - np.sqrt(n)) * weight / lr
+        n[:] += grad ** 2
+        d = (np.sign(z) * 0.01 - z) * (np.abs(z) > 0.01)
+        return d / ((1. + np.sqrt(n)) / lr + wd)
+    grad = grad + wd * weight
+    history, = states
+    history[:] += grad ** 2
+    return weight - lr * grad / (np.sqrt(history) + 1e-7)
+
+
+@pytest.mark.parametrize('name,num_states,kwargs', [
+    ('adam', 2, {'lr': 0.1, 'wd': 0.01}),
+    ('adamw', 2, {'lr': 0.1, 'wd': 0.01, 'eta': 0.5}),
+    ('ftrl', 2, {'lr': 0.1, 'wd': 0.01}),
+    ('adagrad', 1, {'lr': 0.1, 'wd': 0.01}),
+    ('adam', 2, {'lr': 0.1, 'rescale_grad': 0.5, 'clip_gradient': 0.2}),
+])
+def test_indexed_update(name, num_states, kwargs):
+    num_rows, row_shape = 10, (2, 3)
+    # unsorted ids with duplicates and rows that are not updated
+    ids = np.array([7, 2, 7, 0, 2, 7, 5], dtype=np.int64)
+    weight = np.random.uniform(-1, 1, (num_rows,) + row_shape).astype(np.float32)
+    grad = np.random.uniform(-1, 1, (len(ids),) + row_shape).astype(np.float32)
+    states = [np.random.uniform(0, 1, weight.shape).astype(np.float32)
+              for _ in range(num_states)]
+
+    mx_weight = mx.nd.array(weight)
+    mx_states = [mx.nd.array(state) for state in states]
+    update = getattr(mx.nd.contrib, f'indexed_{name}_update')
+    update(mx_weight, mx.nd.array(grad), *mx_states, mx.nd.array(ids, dtype=ids.dtype),
+           out=mx_weight, **kwargs)
+
+    weight_ref = weight.copy()
+    for row in np.unique(ids):
+        row_states = [state[row] for state in states]
+        weight_ref[row] = _indexed_update_ref(name, weight[row], grad[ids == row].sum(axis=0),
+                                              row_states, kwargs)
+        for state, row_state in zip(states, row_states):
+            state[row] = row_state
+    assert_almost_equal(mx_weight.asnumpy(), weight_ref, rtol=1e-4, atol=1e-5)
+    for mx_state, state in zip(mx_states, states):
+        assert_almost_equal(mx_state.asnumpy(), state, rtol=1e-4, atol=1e-5)
@@ -240,3 +240,78 @@ def test_adjacency():
     assert_array_equal(adj.indices, g.indices)
     assert_array_equal(adj.data, mx.nd.ones(shape=g.indices.shape))
 
+
+def gspmm_np(indptr, indices, edata, ufeat, ograd, op, reducer):
+    out = np.zeros((len(indptr) - 1, ufeat.shape[1]), dtype=np.float32)
+    dufeat = np.zeros_like(ufeat)
+    dedata = np.zeros_like(edata)
+    for i in range(len(indptr) - 1):
+        edges = np.arange(indptr[i], indptr[i + 1])
+        if len(edges) == 0:
+            continue
+        u = ufeat[indices[edges]]
+        e = edata[edges][:, None]
+        msg = {'copy_lhs': u, 'mul': u * e, 'add': u + e}[op]
+        dmsg_du = e if op == 'mul' else np.ones_like(e)
+        dmsg_de = u if op == 'mul' else np.ones_like(u)
+        if reducer == 'max':
+            weight = (np.arange(len(edges))[:, None] == msg.argmax(axis=0)).astype(np.float32)
+            out[i] = msg.max(axis=0)
+        else:
+            weight = np.ones_like(msg) / (len(edges) if reducer == 'mean' else 1)
+            out[i] = (msg * weight).sum(axis=0)
+        np.add.at(dufeat, indices[edges], weight * dmsg_du * ograd[i])
+        if op != 'copy_lhs':
+            dedata[edges] = (weight * dmsg_de * ograd[i]).sum(axis=1)
+    return out, dufeat, dedata
+
+def test_gspmm():
+    shape = (20, 30)
+    for op, reducer in itertools.product(['copy_lhs', 'mul', 'add'], ['sum', 'max', 'mean']):
+        g = rand_ndarray(shape, stype='csr', density=0.2)
+        ufeat = mx.nd.random.uniform(shape=(shape[1], 4))
+        ograd = mx.nd.random.uniform(shape=(shape[0], 4))
+        g.attach_grad(stype='csr')
+        ufeat.attach_grad()
+        with mx.autograd.record():
+            out = mx.nd.contrib.dgl_gspmm(g, ufeat, op=op, reducer=reducer)
+        out.backward(ograd)
+        out_np, dufeat_np, dedata_np = gspmm_np(g.indptr.asnumpy(), g.indices.asnumpy(),
+                                                g.data.asnumpy(), ufeat.asnumpy(),
+                                                ograd.asnumpy(), op, reducer)
+        assert out.stype == 'default'
+        assert_almost_equal(out.asnumpy(), out_np, rtol=1e-5, atol=1e-5)
+        assert_almost_equal(ufeat.grad.asnumpy(), dufeat_np, rtol=1e-5, atol=1e-5)
+        dgraph = sp.sparse.csr_matrix((dedata_np, g.indices.asnumpy(), g.indptr.asnumpy()),
+                                      shape=shape)
+        assert g.grad.stype == 'csr'
+        assert_almost_equal(g.grad.asnumpy(), dgraph.toarray(), rtol=1e-5, atol=1e-5)
+
+def test_gsddmm():
+    shape = (20, 30)
+    for op, dim in [('dot', 4), ('add', 1), ('mul', 1)]:
+        g = rand_ndarray(shape, stype='csr', density=0.2)
+        lhs = mx.nd.random.uniform(shape=(shape[0], dim))
+        rhs = mx.nd.random.uniform(shape=(shape[1], dim))
+        lhs.attach_grad()
+        rhs.attach_grad()
+        with mx.autograd.record():
+            out = mx.nd.contrib.dgl_gsddmm(g, lhs, rhs, op=op)
+        indptr_np, indices_np = g.indptr.asnumpy(), g.indices.asnumpy()
+        rows = np.repeat(np.arange(shape[0]), np.diff(indptr_np))
+        l, r = lhs.asnumpy()[rows], rhs.asnumpy()[indices_np]
+        out_np = {'dot': (l * r).sum(axis=1), 'add': (l + r)[:, 0], 'mul': (l * r)[:, 0]}[op]
+        assert out.stype == 'csr'
+        assert_array_equal(out.indptr, g.indptr)
+        assert_array_equal(out.indices, g.indices)
+        assert_almost_equal(out.data.asnumpy(), out_np, rtol=1e-5, atol=1e-5)
+
+        ograd = mx.nd.random.uniform(shape=shape)
+        out.backward(ograd)
+        og = ograd.asnumpy()[rows, indices_np][:, None]
+        dlhs_np = np.zeros(lhs.shape, dtype=np.float32)
+        drhs_np = np.zeros(rhs.shape, dtype=np.float32)
+        np.add.at(dlhs_np, rows, og * (np.ones_like(r) if op == 'add' else r))
+        np.add.at(drhs_np, indices_np, og * (np.ones_like(l) if op == 'add' else l))
+        assert_almost_equal(lhs.grad.asnumpy(), dlhs_np, rtol=1e-5, atol=1e-5)
+        assert_almost_equal(rhs.grad.asnumpy(), drhs_np, rtol=1e-5, atol=1e-5)
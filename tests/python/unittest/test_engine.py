@@ -69,3 +69,27 @@ def test_engine_openmp_after_fork():
             print("Child omp max threads: {}".format(omp_max_threads))
             assert omp_max_threads == 1
 
+
+def test_stream_temp_space():
+    # the resource manager of a thread reads the variable when the thread first uses it
+    import threading
+    data = [mx.nd.random.uniform(shape=(64, 128)) for _ in range(8)]
+    expected = [mx.nd.sort(x, axis=1).asnumpy() for x in data]
+    net = mx.gluon.nn.HybridSequential()
+    net.add(mx.gluon.nn.Dense(16))
+    net.initialize()
+    net.hybridize()
+    expected_net = net(data[0]).asnumpy()
+    results = {}
+    def run():
+        # the sorts use temporary space without depending on each other
+        outs = [mx.nd.sort(x, axis=1) for x in data]
+        results['sort'] = [out.asnumpy() for out in outs]
+        results['net'] = net(data[0]).asnumpy()
+    with environment('MXNET_STREAM_TEMP_SPACE', '1'):
+        thread = threading.Thread(target=run)
+        thread.start()
+        thread.join()
+    for out, ref in zip(results['sort'], expected):
+        mx.test_utils.assert_almost_equal(out, ref)
+    mx.test_utils.assert_almost_equal(results['net'], expected_net)
@@ -160,6 +160,285 @@ def test_cached_op_init():
     check_init(True, False)
     check_init(True, True)
 
+def test_cached_op_recompute():
+    x = mx.sym.Variable('x')
+    w = mx.sym.Variable('w')
+    y = mx.sym.FullyConnected(x, w, num_hidden=256, no_bias=True)
+    y = mx.sym.sigmoid(mx.sym.tanh(mx.sym.relu(y) * 2) + 1)
+    y = mx.sym.FullyConnected(y, w, num_hidden=256, no_bias=True)
+    x_np = np.random.uniform(-1, 1, (512, 256))
+    w_np = np.random.uniform(-1, 1, (256, 256))
+
+    def run(flags):
+        exe = mx.ndarray.CachedOp(y, flags)
+        xs = [mx.nd.array(x_np), mx.nd.array(w_np)]
+        for a in xs:
+            a.attach_grad()
+        with mx.autograd.record():
+            out = exe(*xs, default_device=mx.cpu())
+        out.backward()
+        return out.asnumpy(), [a.grad.asnumpy() for a in xs]
+
+    out, grads = run([])
+    for static_alloc in [False, True]:
+        r_out, r_grads = run([('static_alloc', static_alloc), ('recompute_budget', 1)])
+        assert_almost_equal(r_out, out)
+        for g, r_g in zip(grads, r_grads):
+            assert_almost_equal(r_g, g)
+
+def test_cached_op_compress_activations():
+    x = mx.sym.Variable('x')
+    w = mx.sym.Variable('w')
+    y = mx.sym.FullyConnected(x, w, num_hidden=256, no_bias=True)
+    y = mx.sym.sigmoid(mx.sym.tanh(mx.sym.relu(y) * 2) + 1)
+    y = mx.sym.FullyConnected(y, w, num_hidden=256, no_bias=True)
+    x_np = np.random.uniform(-1, 1, (512, 256))
+    w_np = np.random.uniform(-1, 1, (256, 256))
+
+    def run(flags, retain_graph=False):
+        exe = mx.ndarray.CachedOp(y, flags)
+        xs = [mx.nd.array(x_np), mx.nd.array(w_np)]
+        for a in xs:
+            a.attach_grad()
+        with mx.autograd.record():
+            out = exe(*xs, default_device=mx.cpu())
+        out.backward(retain_graph=retain_graph)
+        if retain_graph:
+            out.backward()
+        return out.asnumpy(), [a.grad.asnumpy() for a in xs]
+
+    out, grads = run([])
+    for retain_graph in [False, True]:
+        # the output of relu is only read by its backward, which the bitmask leaves exact
+        r_out, r_grads = run([('compress_activations', 'relu')], retain_graph)
+        assert_almost_equal(r_out, out)
+        for g, r_g in zip(grads, r_grads):
+            assert_almost_equal(r_g, g)
+    for mode, rtol, atol in [('float16', 1e-2, 1e-1), ('int8', 5e-2, 5e-1)]:
+        r_out, r_grads = run([('compress_activations', mode)])
+        assert_almost_equal(r_out, out)
+        for g, r_g in zip(grads, r_grads):
+            assert_almost_equal(r_g, g, rtol=rtol, atol=atol)
+
+def test_cached_op_prefetch_params(tmpdir):
+    x = mx.sym.Variable('x')
+    w1 = mx.sym.Variable('w1')
+    w2 = mx.sym.Variable('w2')
+    y = mx.sym.FullyConnected(x, w1, num_hidden=64, no_bias=True)
+    y = mx.sym.FullyConnected(mx.sym.relu(y), w2, num_hidden=16, no_bias=True)
+    fname = str(tmpdir.join('params'))
+    mx.nd.save(fname, {'w1': mx.nd.random.uniform(shape=(64, 32)),
+                       'w2': mx.nd.random.uniform(shape=(16, 64))})
+    x_nd = mx.nd.random.uniform(shape=(8, 32))
+
+    def run(flags, mmap):
+        params = mx.nd.load(fname, mmap=mmap)
+        exe = mx.ndarray.CachedOp(y, flags)
+        return exe(x_nd, params['w1'], params['w2'], default_device=mx.cpu()).asnumpy()
+
+    expected = run([], False)
+    for mmap in [False, True]:
+        for flags in [[('prefetch_params', True)],
+                      [('prefetch_params', True), ('data_indices', (0,)),
+                       ('param_indices', (1, 2))]]:
+            assert_almost_equal(run(flags, mmap), expected)
+
+def test_cached_op_plan_cache():
+    x = mx.sym.Variable('x')
+    w = mx.sym.Variable('w')
+    y = mx.sym.FullyConnected(x, w, num_hidden=8, no_bias=True)
+    y = mx.sym.relu(y) + mx.sym.sum(x)
+    w_np = np.random.uniform(-1, 1, (8, 4))
+    batches = [3, 5, 3, 7, 16, 5, 1, 3]
+
+    def run(flags):
+        exe = mx.ndarray.CachedOp(y, flags)
+        outs = []
+        for b in batches:
+            x_nd = mx.nd.array(np.arange(b * 4).reshape(b, 4) / 10.0)
+            outs.append(exe(x_nd, mx.nd.array(w_np), default_device=mx.cpu()).asnumpy())
+        return outs
+
+    expected = run([])
+    for static_alloc in [False, True]:
+        for buckets in [None, (4, 8)]:
+            flags = [('static_alloc', static_alloc), ('plan_cache_size', 2),
+                     ('data_indices', (0,)), ('param_indices', (1,))]
+            if buckets is not None:
+                flags.append(('shape_buckets', buckets))
+            for out, ref in zip(run(flags), expected):
+                assert_almost_equal(out, ref)
+
+def test_cached_op_incremental_shape():
+    x = mx.sym.Variable('x')
+    w = mx.sym.Variable('w')
+    b = mx.sym.Variable('b')
+    # the branch of w and b does not depend on the batch size of x
+    wb = mx.sym.tanh(w) * 2 + mx.sym.reshape(b, shape=(1, -1))
+    h = mx.sym.dot(x, wb, transpose_b=True)
+    y = mx.sym.Group([mx.sym.reshape(mx.sym.relu(h), shape=(-1,)) + mx.sym.sum(x),
+                      mx.sym.sum(wb, axis=0)])
+    w_np = np.random.uniform(-1, 1, (8, 4))
+    b_np = np.random.uniform(-1, 1, (4,))
+
+    def call(exe, batch):
+        x_nd = mx.nd.array(np.arange(batch * 4).reshape(batch, 4) / 10.0)
+        w_nd = mx.nd.array(w_np)
+        w_nd.attach_grad()
+        with mx.autograd.record():
+            outs = exe(x_nd, w_nd, mx.nd.array(b_np), default_device=mx.cpu())
+        outs[0].backward()
+        return [o.asnumpy() for o in outs] + [w_nd.grad.asnumpy()]
+
+    for static_alloc in [False, True]:
+        flags = [('static_alloc', static_alloc)]
+        exe = mx.ndarray.CachedOp(y, flags)
+        for batch in [3, 5, 3, 7, 1]:
+            expected = call(mx.ndarray.CachedOp(y, flags), batch)
+            for out, ref in zip(call(exe, batch), expected):
+                assert out.shape == ref.shape
+                assert_almost_equal(out, ref)
+
+def test_cached_op_cpu_fusion():
+    a = mx.sym.Variable('a')
+    b = mx.sym.Variable('b')
+    c = mx.sym.Variable('c')
+    # GELU and LSTM cell gates, large enough to span several tiles
+    gelu = 0.5 * a * (1 + mx.sym.tanh(0.79788456 * (a + 0.044715 * a * a * a)))
+    cell = mx.sym.sigmoid(a) * c + mx.sym.sigmoid(b) * mx.sym.tanh(a + b)
+    hidden = mx.sym.sigmoid(a - b) * mx.sym.tanh(cell)
+    sym = mx.sym.Group([gelu, hidden, mx.sym.relu(b) + mx.sym.exp(c)])
+    shape = (64, 1031)
+    data = {name: mx.nd.random.uniform(-2, 2, shape) for name in ['a', 'b', 'c']}
+    for grad_req in ['write', 'add']:
+        results = []
+        for fusion in ['0', '1']:
+            with environment('MXNET_USE_FUSION_CPU', fusion):
+                exe = sym._simple_bind(mx.cpu(), grad_req=grad_req, a=shape, b=shape, c=shape)
+            outs = exe.forward(is_train=True, **data)
+            exe.backward([mx.nd.ones(shape)] * len(outs))
+            results.append([o.asnumpy() for o in outs] +
+                           [g.asnumpy() for g in exe.grad_arrays])
+        for fused, ref in zip(results[1], results[0]):
+            assert_almost_equal(fused, ref, rtol=1e-5, atol=1e-6)
+
+def test_cached_op_static_arena():
+    x = mx.sym.Variable('x')
+    w = mx.sym.Variable('w')
+    h = mx.sym.FullyConnected(x, w, num_hidden=8, no_bias=True)
+    y = mx.sym.sigmoid(h) * mx.sym.relu(h) + mx.sym.sum(x)
+    w_np = np.random.uniform(-1, 1, (8, 4))
+
+    def run(flags):
+        exe = mx.ndarray.CachedOp(y, flags)
+        outs = []
+        for b in [3, 3, 5, 3]:
+            x_nd = mx.nd.array(np.arange(b * 4).reshape(b, 4) / 10.0)
+            outs.append(exe(x_nd, mx.nd.array(w_np), default_device=mx.cpu()).asnumpy())
+        return outs
+
+    expected = run([])
+    for static_shape in [False, True]:
+        flags = [('static_alloc', True), ('static_shape', static_shape), ('static_arena', True),
+                 ('data_indices', (0,)), ('param_indices', (1,))]
+        for out, ref in zip(run(flags), expected):
+            assert_almost_equal(out, ref)
+
+def test_cached_op_memory_group():
+    x = mx.sym.Variable('x')
+    w = mx.sym.Variable('w')
+    h = mx.sym.FullyConnected(x, w, num_hidden=8, no_bias=True)
+    models = [mx.sym.sigmoid(h) * mx.sym.relu(h), mx.sym.tanh(h) + mx.sym.sum(x)]
+    w_np = np.random.uniform(-1, 1, (8, 4))
+    x_nd = mx.nd.array(np.random.uniform(-1, 1, (3, 4)))
+
+    def run(flags):
+        exes = [mx.ndarray.CachedOp(y, flags) for y in models]
+        return [[exe(x_nd, mx.nd.array(w_np), default_device=mx.cpu()).asnumpy() for exe in exes]
+                for _ in range(2)]
+
+    expected = run([])
+    flags = [('static_alloc', True), ('static_shape', True), ('memory_group', 'test'),
+             ('data_indices', (0,)), ('param_indices', (1,))]
+    for outs, refs in zip(run(flags), expected):
+        for out, ref in zip(outs, refs):
+            assert_almost_equal(out, ref)
+
+def test_cached_op_thread_safe_concurrent():
+    import threading
+    x = mx.sym.Variable('x')
+    w = mx.sym.Variable('w')
+    y = mx.sym.relu(mx.sym.FullyConnected(x, w, num_hidden=16, no_bias=True)) * 2
+    w_nd = mx.nd.array(np.random.uniform(-1, 1, (16, 8)))
+    inputs = [mx.nd.array(np.random.uniform(-1, 1, (4, 8))) for _ in range(4)]
+    w_np = w_nd.asnumpy()
+    expected = [np.maximum(np.dot(i.asnumpy(), w_np.T), 0) * 2 for i in inputs]
+    for static_alloc in [False, True]:
+        flags = [('static_alloc', static_alloc), ('static_shape', static_alloc),
+                 ('num_concurrent_states', 2),
+                 ('data_indices', (0,)), ('param_indices', (1,))]
+        exe = mx.ndarray.CachedOp(y, flags, thread_safe=True)
+        results = [None] * len(inputs)
+        errors = []
+
+        def run(i):
+            try:
+                for _ in range(5):
+                    results[i] = exe(inputs[i], w_nd, default_device=mx.cpu()).asnumpy()
+            except Exception as e:  # pylint: disable=broad-except
+                errors.append(e)
+
+        threads = [threading.Thread(target=run, args=(i,)) for i in range(len(inputs))]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        assert not errors, errors
+        for out, ref in zip(results, expected):
+            assert_almost_equal(out, ref, rtol=1e-5, atol=1e-6)
+
+def test_cached_op_batcher():
+    import ctypes
+    from mxnet.base import _LIB, check_call, c_str_array, c_handle_array, NDArrayHandle, py_str
+    x = mx.sym.Variable('x')
+    w = mx.sym.Variable('w')
+    y = mx.sym.relu(mx.sym.FullyConnected(x, w, num_hidden=16, no_bias=True))
+    w_nd = mx.nd.array(np.random.uniform(-1, 1, (16, 8)))
+    inputs = [mx.nd.array(np.random.uniform(-1, 1, (1, 8))) for _ in range(11)]
+    expected = [np.maximum(np.dot(i.asnumpy(), w_nd.asnumpy().T), 0) for i in inputs]
+    callback_type = ctypes.CFUNCTYPE(None, ctypes.c_int, ctypes.POINTER(NDArrayHandle),
+                                     ctypes.c_char_p, ctypes.c_void_p)
+    for buckets in ['()', '(1,3,4)']:
+        results = {}
+        errors = []
+
+        def on_done(num_outputs, outputs, error, request):
+            if error:
+                errors.append(py_str(error))
+                return
+            handles = [NDArrayHandle(outputs[i]) for i in range(num_outputs)]
+            # a null callback handle arrives as None
+            results[request or 0] = [mx.nd.NDArray(h) for h in handles]
+
+        callback = callback_type(on_done)
+        flags = {'max_batch_size': '4', 'batch_buckets': buckets, 'max_delay_us': '2000',
+                 'data_indices': '(0,)', 'param_indices': '(1,)'}
+        handle = ctypes.c_void_p()
+        check_call(_LIB.MXCachedOpBatcherCreate(
+            y.handle, len(flags), c_str_array(list(flags.keys())),
+            c_str_array(list(flags.values())), 1, c_handle_array([w_nd]),
+            ctypes.c_int(1), ctypes.c_int(0), ctypes.byref(handle)))
+        for i, data in enumerate(inputs):
+            check_call(_LIB.MXCachedOpBatcherSubmit(
+                handle, 1, c_handle_array([data]), callback, ctypes.c_void_p(i)))
+        # freeing the batcher runs the pending requests
+        check_call(_LIB.MXCachedOpBatcherFree(handle))
+        assert not errors, errors
+        assert sorted(results.keys()) == list(range(len(inputs)))
+        for i, ref in enumerate(expected):
+            assert results[i][0].shape == (1, 16)
+            assert_almost_equal(results[i][0].asnumpy(), ref, rtol=1e-5, atol=1e-6)
+
 def test_elemwise_add_grad():
     json = "{\"nodes\": [{\"op\":\"null\",\"name\":\".Inputs.Input1\",\"inputs\":[]},{\"op\":\"null\",\"name\":\".Inputs.Input2\",\"inputs\":[]},{\"op\":\"elemwise_add\",\"name\":\".$0\",\"inputs\":[[0,0,0],[1,0,0]]},{\"op\":\"_copy\",\"name\":\".Outputs.Output\",\"inputs\":[[2,0,0]]}],\"arg_nodes\":[0,1],\"heads\":[[3,0,0]]}"
     sym = mx.symbol.fromjson(json)
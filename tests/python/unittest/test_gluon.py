@@ -23,7 +23,7 @@ from mxnet import gluon
 from mxnet import init
 from mxnet.gluon import nn
 from mxnet.base import py_str, MXNetError
-from mxnet.test_utils import assert_almost_equal, default_device, assert_allclose
+from mxnet.test_utils import assert_almost_equal, default_device, assert_allclose, environment
 from mxnet.util import is_np_array
 from mxnet.ndarray.ndarray import _STORAGE_TYPE_STR_TO_ID
 from mxnet.test_utils import use_np
@@ -1051,6 +1051,55 @@ def test_import():
     assert lines[2] == ')'
 
 
+@use_np
+def test_warmup(tmpdir):
+    tmpfile = os.path.join(str(tmpdir), 'net')
+    net = gluon.nn.HybridSequential()
+    net.add(gluon.nn.Conv2D(4, 3), gluon.nn.Dense(2))
+    net.initialize()
+    net.hybridize(static_alloc=True)
+    shapes = [(1, 3, 8, 8), (2, 3, 8, 8)]
+    assert net.warmup(shapes) is net
+
+    net.export(tmpfile, warmup_shapes=shapes)
+    with open(tmpfile + '-warmup.json') as f:
+        assert json.load(f)['shapes'] == [list(shape) for shape in shapes]
+    net2 = gluon.SymbolBlock.imports(tmpfile + '-symbol.json', ['data'], tmpfile + '-0000.params')
+    net2.warmup(tmpfile + '-warmup.json')
+    data = mx.np.random.normal(size=(2, 3, 8, 8))
+    assert_almost_equal(net(data).asnumpy(), net2(data).asnumpy())
+
+    with pytest.raises(ValueError):
+        net.warmup([[(1, 3, 8, 8)]], dtype=['float32', 'float32'])
+
+
+@use_np
+def test_export_compiled(tmpdir):
+    path = os.path.join(str(tmpdir), 'net.mxc')
+    rtc_cache = os.path.join(str(tmpdir), 'rtc')
+    os.makedirs(rtc_cache)
+    with open(os.path.join(rtc_cache, 'kernel.rtc'), 'wb') as f:
+        f.write(b'kernel')
+    net = gluon.nn.HybridSequential()
+    net.add(gluon.nn.Conv2D(4, 3), gluon.nn.Dense(2))
+    net.initialize()
+    net.hybridize(static_alloc=True, static_shape=True)
+    data = mx.np.random.normal(size=(2, 3, 8, 8))
+    out = net(data)
+    with environment('MXNET_RTC_CACHE_DIR', rtc_cache):
+        net.export_compiled(path, warmup_shapes=[(2, 3, 8, 8)])
+    assert os.path.isfile(os.path.join(path, 'cache', 'rtc', 'kernel.rtc'))
+    with open(os.path.join(path, 'manifest.json')) as f:
+        manifest = json.load(f)
+    assert manifest['inputs'] == ['data']
+    assert manifest['flags']['static_alloc'] and manifest['flags']['static_shape']
+
+    with environment('MXNET_RTC_CACHE_DIR', None):
+        net2 = gluon.SymbolBlock.imports_compiled(path)
+        assert os.environ['MXNET_RTC_CACHE_DIR'] == os.path.join(path, 'cache', 'rtc')
+    assert_almost_equal(out.asnumpy(), net2(data).asnumpy())
+
+
 def test_hybrid_stale_cache():
     net = mx.gluon.nn.HybridSequential()
     net.add(mx.gluon.nn.Dense(10, weight_initializer='zeros', bias_initializer='ones', flatten=False))
@@ -1521,6 +1570,45 @@ def test_hybrid_static_memory_switching(static_alloc, static_shape):
         y.backward()
     mx.npx.waitall()
 
+
+@pytest.mark.parametrize('static_alloc', [False, True])
+@pytest.mark.parametrize('batch', [1, 3])
+def test_hybrid_concat_split_slices(static_alloc, batch):
+    # with a batch of one the planner writes the branches in place in the concat
+    # and makes the outputs of the split views of its input
+    class Net(gluon.HybridBlock):
+        def __init__(self):
+            super(Net, self).__init__()
+            self.branches = nn.HybridSequential()
+            for units in [4, 6, 2]:
+                self.branches.add(nn.Dense(units, flatten=False))
+
+        def forward(self, x):
+            y = mx.np.concatenate([mx.npx.relu(b(x)) for b in self.branches], axis=-1)
+            a, b, c = mx.np.split(y * 2, [4, 10], axis=-1)
+            return mx.np.concatenate([mx.np.tanh(a), mx.np.exp(b), c + 1], axis=-1)
+
+    x = mx.np.random.uniform(size=(batch, 5))
+    x.attach_grad()
+    net = Net()
+    net.initialize()
+
+    def run():
+        with mx.autograd.record():
+            y = net(x)
+            y.backward(mx.np.arange(y.size).reshape(y.shape))
+        grads = {k: v.grad().asnumpy() for k, v in net.collect_params().items()}
+        return y.asnumpy(), x.grad.asnumpy(), grads
+
+    y1, dx1, grads1 = run()
+    net.hybridize(static_alloc=static_alloc)
+    for _ in range(2):
+        y2, dx2, grads2 = run()
+        assert_almost_equal(y1, y2, rtol=1e-5, atol=1e-6)
+        assert_almost_equal(dx1, dx2, rtol=1e-5, atol=1e-6)
+        for key in grads1:
+            assert_almost_equal(grads1[key], grads2[key], rtol=1e-5, atol=1e-6)
+
 def test_hook():
     global hook_call_count
     hook_call_count = 0
@@ -293,6 +293,36 @@ def test_cut_subgraph_while_loop():
     assert_almost_equal(res1.asnumpy(), res2.asnumpy(), rtol=1e-3, atol=1e-3)
 
 
+@mx.util.use_np
+def test_compiled_loops():
+    class TestLayer(gluon.HybridBlock):
+        def __init__(self, compiled):
+            super(TestLayer, self).__init__()
+            self.compiled = compiled
+        def forward(self, data, state):
+            out1, states1 = mx.npx.foreach(
+                lambda x, s: (x * s[0] + 1, [s[0] + x]), data, [state], compiled=self.compiled)
+            out2, states2 = mx.npx.while_loop(
+                cond=lambda i, s: i < 4,
+                func=lambda i, s: (s * 2, (i + 1, s + i)),
+                loop_vars=(mx.np.zeros((1, )), states1[0]),
+                max_iterations=6,
+                compiled=self.compiled,
+            )
+            return out1, out2[0], states2[1]
+    data = mx.np.random.uniform(size=(5, 3))
+    state = mx.np.random.uniform(size=(3, ))
+    for hybridize in [False, True]:
+        results = []
+        for compiled in [False, True]:
+            layer = TestLayer(compiled)
+            if hybridize:
+                layer.hybridize()
+            results.append(layer(data, state))
+        for expected, actual in zip(*results):
+            assert_almost_equal(expected.asnumpy(), actual.asnumpy())
+
+
 @mx.util.use_np
 def test_cut_subgraph_cond():
     class TestLayer(gluon.HybridBlock):
@@ -87,6 +87,34 @@ def test_recordimage_dataset_handle(prepare_record):
         assert x.shape[0] == 1 and x.shape[3] == 3
         assert y.item() == i
 
+@pytest.mark.skipif(platform.system() == 'Windows', reason='use_mmap is not supported on Windows')
+def test_recordfile_dataset_mmap(prepare_record, tmpdir):
+    recfile = prepare_record
+    read = gluon.data.RecordFileDataset(recfile).__mx_handle__()
+    mapped = gluon.data.RecordFileDataset(recfile, use_mmap=True).__mx_handle__()
+    assert len(mapped) == len(read)
+    for i in range(len(read)):
+        mx.test_utils.assert_almost_equal(mapped[i], read[i])
+
+    # records holding the magic number are split by the writer and joined by the dataset
+    magic = np.array([0xced7230a], dtype=np.uint32).tobytes()
+    contents = [magic, b'a' + magic + b'bc' + magic, b'\x00' * 7]
+    idx_file, rec_file = str(tmpdir.join('split.idx')), str(tmpdir.join('split.rec'))
+    record = mx.recordio.MXIndexedRecordIO(idx_file, rec_file, 'w')
+    for i, content in enumerate(contents):
+        record.write_idx(i, content)
+    record.close()
+    mapped = gluon.data.RecordFileDataset(rec_file, use_mmap=True).__mx_handle__()
+    for i, content in enumerate(contents):
+        assert mapped[i].asnumpy().tobytes() == content
+
+    loader = gluon.data.DataLoader(
+        gluon.data.vision.ImageRecordDataset(recfile, use_mmap=True), 1, num_workers=2,
+        try_nopython=True)
+    for i, (x, y) in enumerate(loader):
+        assert x.shape[0] == 1 and x.shape[3] == 3
+        assert y.asscalar() == i
+
 def _dataset_transform_fn(x, y):
     """Named transform function since lambda function cannot be pickled."""
     return x, y
@@ -132,6 +160,30 @@ def test_sampler():
     rand_batch_keep = gluon.data.BatchSampler(rand_sampler, 3, 'keep')
     assert sorted(sum(list(rand_batch_keep), [])) == list(range(10))
 
+def test_sharded_block_sampler():
+    from mxnet.gluon.data._internal import MXSampler
+    kwargs = dict(length=1000, num_parts=3, block_size=16, window_size=64, seed=5, batch_size=10)
+
+    def passes(part_index, num_passes=2):
+        sampler = MXSampler('ShardedBlockSampler', part_index=part_index, **kwargs)
+        return [[int(i) for i in sum(list(sampler), [])] for _ in range(num_passes)]
+
+    parts = [passes(p) for p in range(3)]
+    for epoch in range(2):
+        indices = [part[epoch] for part in parts]
+        # all the parts have ceil(1000 / 3) indices and together cover the sequence
+        assert [len(i) for i in indices] == [334] * 3
+        assert sorted(set(sum(indices, []))) == list(range(1000))
+        # a window spans a few blocks only
+        for i in indices:
+            for w in range(0, len(i), 64):
+                assert len(set(j // 16 for j in i[w:w + 64])) <= 64 // 16 + 3
+    # the orders only depend on the seed, the epoch and the part
+    assert passes(1) == parts[1]
+    assert parts[1][0] != parts[1][1]
+    resumed = MXSampler('ShardedBlockSampler', part_index=1, epoch=1, **kwargs)
+    assert [int(i) for i in sum(list(resumed), [])] == parts[1][1]
+
 def test_datasets(tmpdir):
     p = tmpdir.mkdir("test_datasets")
     assert len(gluon.data.vision.MNIST(root=str(p.join('mnist')))) == 60000
@@ -156,6 +208,32 @@ def test_datasets_handles(tmpdir):
     assert len(gluon.data.vision.CIFAR100(root=str(p.join('cifar100')), fine_label=True).__mx_handle__()) == 50000
     assert len(gluon.data.vision.CIFAR100(root=str(p.join('cifar100')), train=False).__mx_handle__()) == 10000
 
+def test_columnar_dataset(tmpdir):
+    from types import SimpleNamespace
+    rng = np.random.RandomState(0)
+    dense = rng.uniform(size=(50, 6)).astype('float32')
+    sparse = np.zeros((50, 8), dtype='float32')
+    sparse[np.arange(50), np.arange(50) % 8] = np.arange(50)
+    labels = np.arange(50, dtype='int32')
+    path = str(tmpdir.join('columnar'))
+    mx.io.save_columnar(path, {
+        'dense': dense, 'label': labels,
+        'sparse': SimpleNamespace(data=np.arange(50, dtype='float32'), indices=np.arange(50) % 8,
+                                  indptr=np.arange(51), shape=sparse.shape)})
+    dataset = gluon.data.ColumnarDataset(path, ['dense', 'sparse', 'label'])
+    hd = dataset.__mx_handle__()
+    assert len(dataset) == len(hd) == 50
+    for idx in [0, 17, 49]:
+        for item in [dataset[idx], hd[idx]]:
+            mx.test_utils.assert_almost_equal(item[0], dense[idx])
+            mx.test_utils.assert_almost_equal(item[1], sparse[idx])
+            assert int(item[2]) == idx
+    loader = gluon.data.DataLoader(dataset, batch_size=16, try_nopython=True)
+    for i, (data, values, label) in enumerate(loader):
+        mx.test_utils.assert_almost_equal(data.asnumpy(), dense[i * 16:(i + 1) * 16])
+        mx.test_utils.assert_almost_equal(values.asnumpy(), sparse[i * 16:(i + 1) * 16])
+        mx.test_utils.assert_almost_equal(label.asnumpy(), labels[i * 16:(i + 1) * 16])
+
 def test_image_folder_dataset(prepare_record):
     dataset = gluon.data.vision.ImageFolderDataset(os.path.dirname(prepare_record))
     assert dataset.synsets == ['test_images']
@@ -237,6 +315,30 @@ def test_multi_worker():
             assert (batch.asnumpy() == i).all()
 
 
+@pytest.mark.garbage_expected
+def test_multi_worker_shared_mem_recycle():
+    # the batches are blocks of pooled shared memory segments, which the workers recycle once the
+    # batches they sent are freed, while earlier batches are still held
+    data = _Dataset()
+    loader = gluon.data.DataLoader(data, batch_size=2, num_workers=2)
+    for _ in range(3):
+        held = []
+        for i, batch in enumerate(loader):
+            assert (batch.asnumpy() == np.array([[2 * i] * 10, [2 * i + 1] * 10])).all()
+            if i % 10 == 0:
+                held.append((i, batch))
+        for i, batch in held:
+            assert (batch.asnumpy()[:, 0] == [2 * i, 2 * i + 1]).all()
+
+
+def test_shared_mem_roundtrip():
+    a = mx.nd.arange(12, ctx=mx.Context('cpu_shared', 0)).reshape((3, 4))
+    b = mx.nd.NDArray(mx.nd.ndarray._new_from_shared_mem(*a._to_shared_mem()))
+    assert (a.asnumpy() == b.asnumpy()).all()
+    b[:] = 1
+    assert (a.asnumpy() == 1).all()
+
+
 def test_multi_worker_shape():
     for thread_pool in [True, False]:
         batch_size = 1024
@@ -553,6 +655,87 @@ def test_mx_data_loader_nopython():
     for _ in dl1:
         pass
 
+@pytest.mark.parametrize('num_workers,num_batchify_workers,queue_depth',
+                         [(1, 1, 1), (4, 3, 2), (4, 2, 6)])
+def test_mx_data_loader_pipeline(num_workers, num_batchify_workers, queue_depth):
+    from mxnet.gluon.data.dataloader import _MXThreadedDataLoader, _check_mx_loader_capability
+    X = np.arange(103 * 2, dtype='float32').reshape(103, 2)
+    batch_sampler = gluon.data.BatchSampler(gluon.data.SequentialSampler(len(X)), 8, 'keep')
+    use_mx_iter, mx_iter_args = _check_mx_loader_capability(
+        gluon.data.SimpleDataset(X), batch_sampler, gluon.data.batchify.Stack())
+    assert use_mx_iter
+    loader = _MXThreadedDataLoader(num_workers=num_workers,
+                                   num_batchify_workers=num_batchify_workers,
+                                   queue_depth=queue_depth, **mx_iter_args)
+    # batches come out in the order of the sampler, also after a reset in the middle of an epoch
+    _ = next(iter(loader))
+    loader._iter.reset()
+    for _ in range(2):
+        batches = [batch.asnumpy() for batch in loader]
+        assert [len(b) for b in batches] == [8] * 12 + [7]
+        assert mx.test_utils.almost_equal(np.concatenate(batches), X)
+
+@pytest.mark.parametrize('prefetch', [1, 3])
+def test_mx_data_loader_recycled_buffers(prefetch):
+    from mxnet.gluon.data.dataloader import _MXThreadedDataLoader, _check_mx_loader_capability
+    X = np.arange(23 * 3, dtype='float32').reshape(23, 3)
+    batch_sampler = gluon.data.BatchSampler(gluon.data.SequentialSampler(len(X)), 5, 'keep')
+    use_mx_iter, mx_iter_args = _check_mx_loader_capability(
+        gluon.data.SimpleDataset(X), batch_sampler, gluon.data.batchify.Stack())
+    assert use_mx_iter
+    loader = _MXThreadedDataLoader(num_workers=2, prefetch=prefetch, **mx_iter_args)
+    # the arrays of consumed batches are batchified into again, also for the smaller last batch
+    for _ in range(3):
+        batches = [batch.asnumpy() for batch in loader]
+        assert [len(b) for b in batches] == [5] * 4 + [3]
+        assert mx.test_utils.almost_equal(np.concatenate(batches), X)
+
+def test_mx_data_loader_pinned_batchify():
+    from mxnet.gluon.data.dataloader import _MXThreadedDataLoader, _check_mx_loader_capability
+    X = np.arange(23 * 3, dtype='float32').reshape(23, 3)
+    batch_sampler = gluon.data.BatchSampler(gluon.data.SequentialSampler(len(X)), 5, 'keep')
+    use_mx_iter, mx_iter_args = _check_mx_loader_capability(
+        gluon.data.SimpleDataset(X), batch_sampler, gluon.data.batchify.Stack())
+    assert use_mx_iter
+    loader = _MXThreadedDataLoader(num_workers=2, pin_memory=True, **mx_iter_args)
+    # the batches are batchified into pinned memory, the prefetcher returns them as they are
+    for _ in range(2):
+        batches = list(loader)
+        assert all(batch.context == context.cpu_pinned(0) for batch in batches)
+        assert mx.test_utils.almost_equal(np.concatenate([b.asnumpy() for b in batches]), X)
+
+def test_mx_data_loader_profiler_spans():
+    import json
+    from mxnet import profiler
+    from mxnet.gluon.data.dataloader import _MXThreadedDataLoader, _check_mx_loader_capability
+    X = np.arange(23 * 3, dtype='float32').reshape(23, 3)
+    batch_sampler = gluon.data.BatchSampler(gluon.data.SequentialSampler(len(X)), 5, 'keep')
+    use_mx_iter, mx_iter_args = _check_mx_loader_capability(
+        gluon.data.SimpleDataset(X), batch_sampler, gluon.data.batchify.Stack())
+    assert use_mx_iter
+    profiler.set_config(profile_all=True, aggregate_stats=True, continuous_dump=False,
+                        filename='test_mx_data_loader_profiler_spans.json')
+    profiler.dumps(reset=True)
+    profiler.set_state('run')
+    loader = _MXThreadedDataLoader(num_workers=2, **mx_iter_args)
+    batches = [batch.asnumpy() for batch in loader]
+    profiler.set_state('stop')
+    assert len(batches) == 5
+    stats = json.loads(profiler.dumps(format='json', reset=True))
+    data = stats['Time']['data']
+    assert data['read']['Count'] == len(X)
+    assert data['batchify']['Count'] >= 5
+    assert 'prefetch wait' in data
+
+def test_batchify_pad_many_samples():
+    rng = np.random.RandomState(0)
+    samples = [rng.randint(0, 100, size=(rng.randint(1, 50), 2)) for _ in range(1000)]
+    bf = mx.gluon.data.batchify.Pad(val=-1)
+    d = bf(samples)
+    e = bf.__mx_handle__()(samples)
+    assert d.shape == e.shape
+    assert mx.test_utils.almost_equal(d.asnumpy(), e.asnumpy())
+
 def test_batchify_stack():
     a = np.array([[1, 2, 3, 4], [5, 6, 7, 8]])
     b = np.array([[5, 6, 7, 8], [1, 2, 3, 4]])
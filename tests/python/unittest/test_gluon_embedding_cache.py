@@ -0,0 +1,73 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+
+import mxnet as mx
+import numpy as onp
+import pytest
+from mxnet import autograd, gluon
+from mxnet.gluon.contrib.embedding_cache import CachedEmbedding
+from mxnet.test_utils import assert_almost_equal, use_np
+
+
+def _table(emb):
+    return emb.weight.data(mx.cpu()).asnumpy()
+
+
+@use_np
+@pytest.mark.parametrize('policy,evicted', [('lru', 0), ('lfu', 2)])
+def test_cached_embedding_eviction(policy, evicted):
+    emb = CachedEmbedding(10, 3, 3, mx.cpu(), policy=policy)
+    emb.initialize()
+    table = _table(emb)
+    batches = [[0, 1, 2], [0], [0], [1], [1], [2], [3]]
+    for batch in batches:
+        out = emb(mx.np.array(batch, dtype='int32'))
+        assert_almost_equal(out.asnumpy(), table[batch])
+    assert set(emb._row_of_slot.tolist()) == {0, 1, 2, 3} - {evicted}
+    assert emb.hits == 5 and emb.misses == 4
+    # the evicted row is fetched again from the table
+    out = emb(mx.np.array([[evicted, 3], [3, 3]]))
+    assert_almost_equal(out.asnumpy(), table[[[evicted, 3], [3, 3]]])
+    with pytest.raises(ValueError):
+        emb(mx.np.array([4, 5, 6, 7]))
+
+
+@use_np
+@pytest.mark.parametrize('policy', ['lru', 'lfu'])
+def test_cached_embedding_training(policy):
+    vocab, dim, cache_size = 20, 4, 6
+    emb = CachedEmbedding(vocab, dim, cache_size, mx.cpu(), policy=policy)
+    emb.initialize()
+    ref = gluon.nn.Embedding(vocab, dim)
+    ref.initialize()
+    ref.weight.set_data(mx.np.array(_table(emb)))
+    trainer = gluon.Trainer([emb.cache], 'sgd', {'learning_rate': 0.5})
+    ref_trainer = gluon.Trainer(ref.collect_params(), 'sgd', {'learning_rate': 0.5})
+    rng = onp.random.RandomState(0)
+    for _ in range(12):
+        rows = rng.choice(vocab, size=5, replace=False)
+        x = mx.np.array(rng.choice(rows, size=(2, 4)))
+        for block, block_trainer in [(emb, trainer), (ref, ref_trainer)]:
+            with autograd.record():
+                loss = (block(x) ** 2).sum()
+            loss.backward()
+            block_trainer.step(1)
+    # the updated rows reach the table when evicted or flushed
+    emb.flush()
+    assert_almost_equal(_table(emb), ref.weight.data().asnumpy(), rtol=1e-5, atol=1e-6)
+    assert 0 < emb.hit_rate < 1
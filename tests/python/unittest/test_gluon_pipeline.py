@@ -0,0 +1,81 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+import mxnet as mx
+import numpy as onp
+import pytest
+from mxnet import gluon
+from mxnet.gluon import nn
+from mxnet.gluon.contrib.pipeline import PipelineParallel, partition_stages, profile_costs
+from mxnet.test_utils import assert_almost_equal, use_np
+
+
+def test_partition_stages():
+    assert partition_stages([1, 2, 3, 4, 5, 6], 3) == [(0, 3), (3, 5), (5, 6)]
+    assert partition_stages([5, 1, 1, 1, 1, 5], 2) == [(0, 3), (3, 6)]
+    assert partition_stages([1, 1], 2) == [(0, 1), (1, 2)]
+    with pytest.raises(ValueError):
+        partition_stages([1, 1], 3)
+
+
+def _make_net():
+    net = nn.HybridSequential()
+    net.add(nn.Dense(8, activation='relu'), nn.Dense(8, activation='tanh'),
+            nn.Dense(6, activation='relu'), nn.Dense(3))
+    net.initialize(mx.init.Xavier(), device=mx.cpu(0))
+    return net
+
+
+@use_np
+def test_profile_costs():
+    net = _make_net()
+    costs = profile_costs([net[i] for i in range(len(net))], mx.np.ones((4, 5)))
+    assert len(costs) == len(net)
+    assert all(cost >= 0 for cost in costs)
+
+
+@use_np
+@pytest.mark.parametrize('schedule', ['1f1b', 'gpipe'])
+@pytest.mark.parametrize('num_micro_batches', [1, 3])
+def test_pipeline_parallel(schedule, num_micro_batches):
+    net = _make_net()
+    data = mx.np.random.uniform(size=(6, 5))
+    label = mx.np.random.uniform(size=(6, 3))
+    loss = gluon.loss.L2Loss()
+
+    with mx.autograd.record():
+        ref_loss = loss(net(data), label)
+    ref_loss.backward()
+    ref_grads = {name: param.grad().asnumpy() for name, param in net.collect_params().items()}
+
+    devices = [mx.cpu(0), mx.cpu(1), mx.cpu(2)]
+    pipeline = PipelineParallel.from_sequential(
+        net, devices, loss, num_micro_batches=num_micro_batches, schedule=schedule,
+        costs=[1, 1, 2, 2])
+    assert [len(stage) for stage in pipeline.stages] == [2, 1, 1]
+    for _ in range(2):
+        losses = pipeline.forward_backward(data, label)
+        assert len(losses) == num_micro_batches
+        assert_almost_equal(onp.concatenate([l.asnumpy() for l in losses]),
+                            ref_loss.asnumpy(), rtol=1e-5, atol=1e-6)
+        # the stages share the parameters of net, now on the devices of their stages
+        for name, param in net.collect_params().items():
+            assert_almost_equal(param.list_grad()[0].asnumpy(), ref_grads[name],
+                                rtol=1e-5, atol=1e-6)
+
+    trainer = gluon.Trainer(pipeline.collect_params(), 'sgd', {'learning_rate': 0.1})
+    trainer.step(data.shape[0])
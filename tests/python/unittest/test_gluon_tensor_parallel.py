@@ -0,0 +1,94 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+
+import mxnet as mx
+import numpy as onp
+import pytest
+from mxnet.gluon.contrib.tensor_parallel import (ColumnParallelDense, RowParallelDense,
+                                                  VocabParallelEmbedding)
+from mxnet.test_utils import assert_almost_equal, use_np
+
+devices = [mx.cpu(0), mx.cpu(1)]
+
+
+def _shard_weights(layer):
+    return [shard.weight.data().asnumpy() for shard in layer._shards]
+
+
+def _shard_grads(layer):
+    return [shard.weight.grad().asnumpy() for shard in layer._shards]
+
+
+@use_np
+def test_column_row_parallel_dense():
+    col = ColumnParallelDense(8, 5, devices, activation='relu', gather_output=False)
+    row = RowParallelDense(3, 8, devices, input_is_parallel=True, bias_initializer='ones')
+    col.initialize()
+    row.initialize()
+    assert [shard.weight.list_device() for shard in col._shards] == [[d] for d in devices]
+
+    x = mx.np.random.uniform(size=(4, 5))
+    with mx.autograd.record():
+        hidden = col(x)
+        out = row(hidden)
+    out.backward()
+    assert [h.device for h in hidden] == devices
+
+    w1 = onp.concatenate(_shard_weights(col), axis=0)
+    b1 = onp.concatenate([shard.bias.data().asnumpy() for shard in col._shards])
+    w2 = onp.concatenate(_shard_weights(row), axis=1)
+    h = onp.maximum(x.asnumpy().dot(w1.T) + b1, 0)
+    assert_almost_equal(out.asnumpy(), h.dot(w2.T) + 1, rtol=1e-5, atol=1e-6)
+    # gradients of the weight shards are those of the full weights
+    dh = onp.ones((4, 3)).dot(w2) * (h > 0)
+    assert_almost_equal(onp.concatenate(_shard_grads(row), axis=1),
+                        onp.ones((4, 3)).T.dot(h), rtol=1e-5, atol=1e-5)
+    assert_almost_equal(onp.concatenate(_shard_grads(col), axis=0),
+                        dh.T.dot(x.asnumpy()), rtol=1e-5, atol=1e-5)
+
+
+@use_np
+def test_column_parallel_dense_gather():
+    col = ColumnParallelDense(6, 4, devices, use_bias=False)
+    col.initialize()
+    row = RowParallelDense(2, 6, devices)
+    row.initialize()
+    x = mx.np.random.uniform(size=(3, 4))
+    y = col(x)
+    assert y.shape == (3, 6) and y.device == x.device
+    w1 = onp.concatenate(_shard_weights(col), axis=0)
+    assert_almost_equal(y.asnumpy(), x.asnumpy().dot(w1.T), rtol=1e-5, atol=1e-6)
+    w2 = onp.concatenate(_shard_weights(row), axis=1)
+    assert_almost_equal(row(y).asnumpy(), y.asnumpy().dot(w2.T), rtol=1e-5, atol=1e-6)
+    with pytest.raises(ValueError):
+        ColumnParallelDense(5, 4, devices)
+
+
+@use_np
+def test_vocab_parallel_embedding():
+    emb = VocabParallelEmbedding(10, 3, devices)
+    emb.initialize()
+    x = mx.np.array([[0, 4, 5], [9, 5, 1]])
+    with mx.autograd.record():
+        out = emb(x)
+    out.backward()
+    weight = onp.concatenate(_shard_weights(emb), axis=0)
+    assert_almost_equal(out.asnumpy(), weight[x.asnumpy().astype('int64')])
+    counts = onp.bincount(x.asnumpy().astype('int64').ravel(), minlength=10)
+    grad = onp.concatenate(_shard_grads(emb), axis=0)
+    assert_almost_equal(grad, onp.repeat(counts[:, None], 3, axis=1).astype(grad.dtype))
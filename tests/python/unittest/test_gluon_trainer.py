@@ -351,3 +351,140 @@ def test_trainer_share_parameters():
 
     assert((shared_params[0] == shared_params[1]).all())
 
+
+
+@mx.util.use_np
+@pytest.mark.parametrize('optimizer,optimizer_params', [
+    ('sgd', {'learning_rate': 0.1}),
+    ('sgd', {'learning_rate': 0.1, 'momentum': 0.9, 'clip_gradient': 0.5}),
+    ('nag', {'learning_rate': 0.1, 'momentum': 0.9}),
+    ('adam', {'learning_rate': 0.01, 'wd': 0.01}),
+    ('rmsprop', {'learning_rate': 0.01}),
+    ('rmsprop', {'learning_rate': 0.01, 'centered': True, 'clip_weights': 1.0}),
+    ('ftml', {'learning_rate': 0.01}),
+    ('adagrad', {'learning_rate': 0.1, 'rescale_grad': 0.5}),
+])
+def test_trainer_flat_update(optimizer, optimizer_params):
+    def make_net():
+        net = nn.HybridSequential()
+        net.add(nn.Dense(8, in_units=4, activation='relu'),
+                nn.Dense(3, in_units=8))
+        net.initialize(mx.init.Uniform(), force_reinit=True)
+        return net
+
+    mx.np.random.seed(0)
+    net = make_net()
+    flat_net = make_net()
+    for param, flat_param in zip(net.collect_params().values(),
+                                 flat_net.collect_params().values()):
+        flat_param.set_data(param.data())
+    flat_net.collect_params()['1.weight'].lr_mult = 0.5
+    net.collect_params()['1.weight'].lr_mult = 0.5
+
+    trainer = gluon.Trainer(net.collect_params(), optimizer, dict(optimizer_params))
+    flat_trainer = gluon.Trainer(flat_net.collect_params(), optimizer,
+                                 dict(optimizer_params, flat_update=True))
+    for _ in range(3):
+        data = mx.np.random.uniform(size=(5, 4))
+        for n, t in [(net, trainer), (flat_net, flat_trainer)]:
+            with mx.autograd.record():
+                loss = (n(data) ** 2).sum()
+            loss.backward()
+            t.step(5)
+    assert len(flat_trainer._flat_groups[0]) == 1
+    for param, flat_param in zip(net.collect_params().values(),
+                                 flat_net.collect_params().values()):
+        assert_almost_equal(param.data(), flat_param.data(), rtol=1e-5, atol=1e-6)
+
+
+@mx.util.use_np
+def test_trainer_flat_update_save_load():
+    net = nn.Dense(4, in_units=3)
+    net.initialize(mx.init.One())
+    trainer = gluon.Trainer(net.collect_params(), 'adam',
+                            {'learning_rate': 0.1, 'flat_update': True})
+    data = mx.np.ones((2, 3))
+    for _ in range(2):
+        with mx.autograd.record():
+            loss = net(data).sum()
+        loss.backward()
+        trainer.step(1)
+    mean, _ = trainer._updaters[0].states[0]
+    assert mean.shape == net.weight.shape
+    trainer.save_states('test_trainer_flat_update_save_load.states')
+    weight = net.weight.data().copy()
+    trainer.load_states('test_trainer_flat_update_save_load.states')
+    with mx.autograd.record():
+        loss = net(data).sum()
+    loss.backward()
+    trainer.step(1)
+    assert not (net.weight.data() == weight).all()
+    # the loaded states are copied into a new flat state
+    flat_state, views = list(trainer._updaters[0].flat_states.values())[0]
+    assert trainer._updaters[0].states[0][0] is views[0][0]
+    os.remove('test_trainer_flat_update_save_load.states')
+
+def test_trainer_clip_global_norm():
+    x = gluon.Parameter('x', shape=(4,))
+    y = gluon.Parameter('y', shape=(2, 3))
+    x.initialize(ctx=mx.cpu(0), init='zeros')
+    y.initialize(ctx=mx.cpu(0), init='zeros')
+    trainer = gluon.Trainer([x, y], 'sgd', {'learning_rate': 1.0, 'wd': 0.},
+                            clip_global_norm=1.0)
+
+    def step(x_grad, y_grad):
+        with mx.autograd.record():
+            loss = (x.data() * x_grad).sum() + (y.data() * y_grad).sum()
+        loss.backward()
+        trainer.step(1)
+
+    step(3, 4)
+    norm = np.sqrt(4 * 9 + 6 * 16)
+    x_ref, y_ref = -3 * np.ones((4,)) / norm, -4 * np.ones((2, 3)) / norm
+    assert_almost_equal(x.data().asnumpy(), x_ref, rtol=1e-5, atol=1e-6)
+    assert_almost_equal(y.data().asnumpy(), y_ref, rtol=1e-5, atol=1e-6)
+    # gradients within the norm are not clipped
+    step(0.1, 0.2)
+    x_ref, y_ref = x_ref - 0.1, y_ref - 0.2
+    assert_almost_equal(x.data().asnumpy(), x_ref, rtol=1e-5, atol=1e-6)
+    assert_almost_equal(y.data().asnumpy(), y_ref, rtol=1e-5, atol=1e-6)
+    # non-finite gradients skip the update
+    with pytest.warns(UserWarning):
+        step(np.inf, 1)
+    assert_almost_equal(x.data().asnumpy(), x_ref, rtol=1e-5, atol=1e-6)
+    assert_almost_equal(y.data().asnumpy(), y_ref, rtol=1e-5, atol=1e-6)
+
+    with pytest.raises(ValueError):
+        gluon.Trainer([x, y], 'sgd', update_on_kvstore=True, clip_global_norm=1.0)
+
+@pytest.mark.parametrize('hybridize', [False, True])
+def test_trainer_fp32_grad_accumulation(hybridize):
+    class Scale(gluon.HybridBlock):
+        def __init__(self):
+            super(Scale, self).__init__()
+            self.weight = gluon.Parameter('weight', shape=(4,), dtype='float16',
+                                          grad_req='add', grad_dtype='float32')
+
+        def forward(self, x):
+            return (self.weight.data() * x).sum()
+
+    net = Scale()
+    net.initialize(ctx=mx.cpu(0), init='ones')
+    if hybridize:
+        net.hybridize()
+    assert net.weight.grad().dtype == np.float32
+    trainer = gluon.Trainer(net.collect_params(), 'sgd',
+                            {'learning_rate': 1.0, 'multi_precision': True})
+
+    x = mx.nd.array([0.1, 0.2, 0.3, 0.4], dtype='float16')
+    num_micro_batches = 3
+    for _ in range(num_micro_batches):
+        with mx.autograd.record():
+            loss = net(x)
+        loss.backward()
+    grad_ref = num_micro_batches * x.asnumpy().astype(np.float32)
+    assert_almost_equal(net.weight.grad().asnumpy(), grad_ref, rtol=1e-6, atol=1e-7)
+    trainer.step(1)
+    assert net.weight.data().dtype == np.float16
+    assert_almost_equal(net.weight.data().asnumpy().astype(np.float32), 1 - grad_ref,
+                        rtol=1e-3, atol=1e-3)
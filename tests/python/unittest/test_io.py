@@ -107,6 +107,83 @@ def test_inter_methods_in_augmenter(inter_method, cifar10):
     for _ in dataiter:
         pass
 
+@pytest.mark.parametrize('resize,random_resized_crop', [(-1, False), (16, False), (20, True)])
+def test_fused_decode_crop(cifar10, resize, random_resized_crop):
+    def batches(fused):
+        with environment('MXNET_IMAGE_FUSED_DECODE', str(int(fused))):
+            dataiter = mx.io.ImageRecordIter(
+                path_imgrec=os.path.join(cifar10, 'cifar', 'test.rec'),
+                data_shape=(3, 14, 14),
+                batch_size=100,
+                resize=resize,
+                random_resized_crop=random_resized_crop,
+                max_aspect_ratio=0.25,
+                min_random_area=0.5,
+                seed_aug=0,
+                dtype='uint8',
+                preprocess_threads=1)
+            return [(b.data[0].asnumpy().astype('float32'), b.label[0].asnumpy())
+                    for _, b in zip(range(5), dataiter)]
+    # the crops are the same, only the scaling of the decoder differs
+    for (data, label), (fused_data, fused_label) in zip(batches(False), batches(True)):
+        assert_almost_equal(fused_label, label)
+        assert np.abs(fused_data - data).mean() < 8
+
+def test_ImageRecordIter_read_shards(cifar10, tmpdir):
+    # 1000 images labelled by their index in 5 shards of 200 images
+    reader = mx.recordio.MXRecordIO(os.path.join(cifar10, 'cifar', 'test.rec'), 'r')
+    shard_dir = tmpdir.mkdir('shards')
+    for s in range(5):
+        writer = mx.recordio.MXRecordIO(str(shard_dir.join('part-%d.rec' % s)), 'w')
+        for i in range(s * 200, (s + 1) * 200):
+            _, img = mx.recordio.unpack(reader.read())
+            writer.write(mx.recordio.pack(mx.recordio.IRHeader(0, float(i), i, 0), img))
+        writer.close()
+    reader.close()
+
+    def labels(path, part_index, num_parts):
+        dataiter = mx.io.ImageRecordIter(path_imgrec=path, read_shards=True, shuffle=True,
+                                         shuffle_buffer=64, num_range_reads=3,
+                                         part_index=part_index, num_parts=num_parts,
+                                         data_shape=(3, 28, 28), batch_size=50, round_batch=False)
+        return [int(label) for batch in dataiter for label in batch.label[0].asnumpy()]
+
+    # the parts read disjoint shards, which together hold all the images once
+    parts = [labels(str(shard_dir), i, 2) for i in range(2)]
+    assert sorted(parts[0] + parts[1]) == list(range(1000))
+    assert sorted(len(part) for part in parts) == [400, 600]
+    # records are shuffled beyond the order in the shards
+    assert parts[0] != sorted(parts[0])
+    paths = ';'.join(str(shard_dir.join('part-%d.rec' % s)) for s in range(5))
+    assert sorted(labels(paths, 0, 1)) == list(range(1000))
+
+def test_ImageDetRecordIter_label_ragged(cifar10, tmpdir):
+    # images with 1 to 3 objects, labelled as header_width, object_width, [id, box] x N
+    reader = mx.recordio.MXRecordIO(os.path.join(cifar10, 'cifar', 'test.rec'), 'r')
+    path = str(tmpdir.join('det.rec'))
+    writer = mx.recordio.MXRecordIO(path, 'w')
+    for i in range(100):
+        _, img = mx.recordio.unpack(reader.read())
+        label = np.array([2, 5] + [i, 0.1, 0.2, 0.6, 0.7] * (i % 3 + 1), dtype=np.float32)
+        writer.write(mx.recordio.pack(mx.recordio.IRHeader(0, label, i, 0), img))
+    writer.close()
+    reader.close()
+
+    kwargs = dict(path_imgrec=path, data_shape=(3, 28, 28), batch_size=16)
+    padded = mx.io.ImageDetRecordIter(**kwargs)
+    ragged = mx.io.ImageDetRecordIter(label_ragged=True, **kwargs)
+    num_batches = 0
+    for padded_batch, _ in zip(padded, ragged):
+        data, values, offsets = ragged.getitems()
+        values, offsets = values.asnumpy(), offsets.asnumpy().astype('int64')
+        assert offsets[0] == 0 and offsets[-1] == values.size
+        assert_almost_equal(data, padded_batch.data[0])
+        # the padded labels start with the shape of the image and the width of the label
+        for j, row in enumerate(padded_batch.label[0].asnumpy()):
+            assert_almost_equal(values[offsets[j]:offsets[j + 1]], row[4:4 + int(row[3])])
+        num_batches += 1
+    assert num_batches == (100 + 15) // 16
+
 def test_image_iter_exception(cifar10):
     with pytest.raises(MXNetError):
         dataiter = mx.io.ImageRecordIter(
@@ -409,6 +486,95 @@ def test_LibSVMIter(tmpdir):
     assertRaises(MXNetError, check_libSVMIter_exception)
 
 
+def test_LibSVMIter_parallel_parse(tmpdir):
+    # enough rows for every parsing thread to get a piece of the chunk
+    num_rows, num_cols, batch_size = 20000, 50, 64
+    rng = np.random.RandomState(0)
+    dense = rng.uniform(-10, 10, (num_rows, num_cols)).astype('float32')
+    dense[rng.uniform(size=dense.shape) < 0.8] = 0
+    labels = rng.randint(0, 10, num_rows).astype('float32')
+    data_path = os.path.join(str(tmpdir), 'data.t')
+    with open(data_path, 'w') as fout:
+        for label, row in zip(labels, dense):
+            features = ' '.join('{}:{!r}'.format(i, float(v)) for i, v in enumerate(row) if v != 0)
+            fout.write('{:g} {}\n'.format(label, features))
+    data_train = mx.io.LibSVMIter(data_libsvm=data_path, data_shape=(num_cols, ),
+                                  batch_size=batch_size, preprocess_threads=4)
+    # the last batch is filled with the first rows
+    num_batches = (num_rows + batch_size - 1) // batch_size
+    num_padd = num_batches * batch_size - num_rows
+    expected_data = np.concatenate([dense, dense[:num_padd]])
+    expected_label = np.concatenate([labels, labels[:num_padd]])
+    for i, batch in enumerate(data_train):
+        batch.data[0].check_format(True)
+        rows = slice(i * batch_size, (i + 1) * batch_size)
+        assert_almost_equal(batch.data[0].asnumpy(), expected_data[rows])
+        assert_almost_equal(batch.label[0].asnumpy(), expected_label[rows])
+        assert batch.pad == (num_padd if i == num_batches - 1 else 0)
+    assert i == num_batches - 1
+
+
+def test_CSVIter_number_formats(tmpdir):
+    data_path = os.path.join(str(tmpdir), 'data.csv')
+    with open(data_path, 'w') as fout:
+        fout.write('1,-2.5,+3e2, 4.25E-1\r\n')
+        fout.write('0.000125,1.5e+3,,-0\n')
+        fout.write('\n')
+        fout.write('12345678901234567890,1e-30,.5,7.\n')
+    data_train = mx.io.CSVIter(data_csv=data_path, data_shape=(4, ), batch_size=3)
+    expected = np.array([[1, -2.5, 300, 0.425], [0.000125, 1500, 0, 0],
+                         [12345678901234567890, 1e-30, 0.5, 7]], dtype='float32')
+    batch = next(iter(data_train))
+    assert_almost_equal(batch.data[0].asnumpy(), expected)
+
+
+def _csr_arrays(dense):
+    from types import SimpleNamespace
+    rows, cols = np.nonzero(dense)
+    indptr = np.concatenate([[0], np.cumsum(np.bincount(rows, minlength=dense.shape[0]))])
+    return SimpleNamespace(data=dense[rows, cols], indices=cols, indptr=indptr, shape=dense.shape)
+
+
+@pytest.mark.parametrize('round_batch', [True, False])
+def test_ColumnarIter(tmpdir, round_batch):
+    num_rows, batch_size = 105, 10
+    rng = np.random.RandomState(0)
+    dense = rng.uniform(size=(num_rows, 3, 4)).astype('float32')
+    sparse = rng.uniform(size=(num_rows, 20)).astype('float32')
+    sparse[sparse < 0.7] = 0
+    labels = np.arange(num_rows, dtype='int64')
+    path = str(tmpdir.join('columnar'))
+    mx.io.save_columnar(path, {'dense': dense, 'sparse': _csr_arrays(sparse), 'label': labels})
+
+    for column, expected in [('dense', dense), ('sparse', sparse)]:
+        data_iter = mx.io.ColumnarIter(path=path, data_column=column, label_column='label',
+                                       batch_size=batch_size, round_batch=round_batch,
+                                       shuffle=True, seed=1)
+        for _ in range(2):
+            seen = []
+            for batch in data_iter:
+                data = batch.data[0]
+                if column == 'sparse':
+                    assert data.stype == 'csr'
+                    data.check_format(True)
+                label = batch.label[0].asnumpy()
+                num_valid = batch_size - batch.pad
+                rows = label[:num_valid]
+                assert_almost_equal(data.asnumpy()[:num_valid], expected[rows])
+                assert_almost_equal(batch.index[:num_valid], rows)
+                if batch.pad:
+                    padded = data.asnumpy()[num_valid:]
+                    assert_almost_equal(padded, expected[:batch.pad] if round_batch
+                                        else np.zeros_like(padded))
+                seen.extend(rows)
+            assert sorted(seen) == list(range(num_rows))
+            data_iter.reset()
+
+    data_iter = mx.io.ColumnarIter(path=path, data_column='dense', batch_size=batch_size)
+    batch = data_iter.next()
+    assert_almost_equal(batch.label[0].asnumpy(), np.zeros((batch_size, )))
+
+
 def test_DataBatch():
     from mxnet.io import DataBatch
     import re
@@ -572,3 +738,26 @@ def test_ImageRecordIter_seed_augmentation(cifar10):
         seed_aug=seed_aug)
 
     assert_dataiter_items_equals(dataiter1, dataiter2)
+
+    # check whether the augmentations depend on the number of threads
+    def make_dataiter(preprocess_threads):
+        return mx.io.ImageRecordIter(
+            path_imgrec=os.path.join(cifar10, 'cifar', 'train.rec'),
+            shuffle=False,
+            data_shape=(3, 28, 28),
+            batch_size=3,
+            rand_crop=True,
+            rand_mirror=True,
+            max_rotate_angle=10,
+            random_h=10,
+            preprocess_threads=preprocess_threads,
+            seed_aug=seed_aug)
+
+    assert_dataiter_items_equals(make_dataiter(1), make_dataiter(4))
+
+    # check whether each epoch draws new augmentations
+    dataiter1 = make_dataiter(4)
+    first_epoch = [batch.data[0].asnumpy() for batch in dataiter1]
+    dataiter1.reset()
+    second_epoch = [batch.data[0].asnumpy() for batch in dataiter1]
+    assert any(not np.array_equal(data1, data2) for data1, data2 in zip(first_epoch, second_epoch))
@@ -17,10 +17,11 @@
 
 # pylint: skip-file
 import mxnet as mx
+import numpy as np
 import os
 import sys
 from common import with_environment
-from mxnet.test_utils import environment
+from mxnet.test_utils import environment, assert_almost_equal
 
 num_hidden = 4096
 
@@ -76,3 +77,29 @@ def test_fc():
     z = mx.sym.Activation(y, act_type='tanh', name='z')
     z = mx.sym.FullyConnected(z, num_hidden=num_hidden)
     exec = z._simple_bind(mx.cpu(), 'write', x=(num_hidden,))
+
+
+def test_shared_weight_unrolled_grad():
+    # h_0 →→→ FC →→→ tanh →→→ + →→→ h_1 ...
+    #  ↓      ↑w             ↑
+    #  →→→→→→→→→→ sigmoid →→→→
+    # The same weight is shared by all the unrolled steps.
+    x = mx.sym.Variable("x")
+    w = mx.sym.Variable("w")
+    hidden, num_steps = 16, 32
+    h = x
+    for i in range(num_steps):
+        fc = mx.sym.FullyConnected(h, w, num_hidden=hidden, no_bias=True, name=f"fc{i}")
+        h = mx.sym.Activation(fc, act_type='tanh') + mx.sym.sigmoid(h)
+    loss = mx.sym.sum(h)
+    x_np = np.random.uniform(-1, 1, (4, hidden))
+    w_np = np.random.uniform(-0.5, 0.5, (hidden, hidden))
+    grads = []
+    for memory_opt in ['0', '1']:
+        with environment('MXNET_MEMORY_OPT', memory_opt):
+            exe = loss._simple_bind(mx.cpu(), 'write', x=x_np.shape, w=w_np.shape)
+        exe.forward(is_train=True, x=mx.nd.array(x_np), w=mx.nd.array(w_np))
+        exe.backward()
+        grads.append([g.asnumpy() for g in exe.grad_arrays])
+    for mirrored, ref in zip(grads[1], grads[0]):
+        assert_almost_equal(mirrored, ref, rtol=1e-5, atol=1e-6)
@@ -19,6 +19,7 @@ import mxnet as mx
 import numpy as np
 from distutils.version import LooseVersion
 from itertools import permutations, combinations_with_replacement
+import json
 import os
 import pickle as pkl
 import random
@@ -194,6 +195,20 @@ def test_ndarray_elementwisesum():
     assert same(res.asnumpy(), ones.asnumpy()*15)
 
 
+def test_ndarray_repeated_attrs():
+    # the imperative calls reuse the attributes parsed for the same operator, inputs and dict
+    x = mx.nd.array(np.arange(6).reshape((2, 3)))
+    for _ in range(3):
+        assert same(mx.nd.sum(x, axis=0).asnumpy(), np.array([3, 5, 7]))
+        assert same(mx.nd.sum(x, axis=1).asnumpy(), np.array([3, 12]))
+        assert same(mx.nd.sum(x, axis=1, keepdims=True).asnumpy(), np.array([[3], [12]]))
+        # the number of inputs is an attribute of add_n
+        assert same(mx.nd.add_n(x, x).asnumpy(), x.asnumpy() * 2)
+        assert same(mx.nd.add_n(x, x, x).asnumpy(), x.asnumpy() * 3)
+        assert mx.nd.full((2, 2), 5).shape == (2, 2)
+        assert mx.nd.full((2, 3), 5).shape == (2, 3)
+
+
 def test_ndarray_negate():
     npy = np.random.uniform(-10, 10, (2,3,4))
     arr = mx.nd.array(npy)
@@ -424,6 +439,65 @@ def test_ndarray_saveload(save_fn):
     os.remove(fname)
 
 
+@pytest.mark.parametrize('num_shards', [1, 3])
+def test_ndarray_save_load_sharded(tmp_path, num_shards):
+    dirname = str(tmp_path / 'ckpt')
+    dmap = {'a': mx.nd.array(np.random.uniform(size=(5, 7))),
+            'b': mx.nd.array(np.arange(10), dtype='int64'),
+            'c': mx.nd.array(np.random.uniform(size=(3,)), dtype='float16'),
+            'empty': mx.nd.zeros((0, 4))}
+    mx.nd.save_sharded(dirname, dmap, num_shards=num_shards, num_threads=2)
+    assert os.path.exists(os.path.join(dirname, 'index.json'))
+    ckpt = mx.nd.load_sharded(dirname)
+    assert sorted(ckpt) == sorted(dmap)
+    for k, x in dmap.items():
+        y = ckpt[k]
+        assert y.dtype == x.dtype and y.shape == x.shape
+        assert_array_equal(y.asnumpy(), x.asnumpy())
+    # the tensors start at aligned offsets of their shards
+    with open(os.path.join(dirname, 'index.json')) as f:
+        index = json.load(f)
+    assert all(t['offset'] % 4096 == 0 for t in index['tensors'].values())
+    # in-place updates of a mapped array leave the checkpoint intact
+    a = ckpt['a']
+    a[:] = 0
+    assert_array_equal(mx.nd.load_sharded(dirname)['a'].asnumpy(), dmap['a'].asnumpy())
+
+    data = [mx.nd.ones((2, 2)), mx.nd.arange(6)]
+    mx.nd.save_sharded(dirname + '_list', data, num_shards=num_shards)
+    data2 = mx.nd.load_sharded(dirname + '_list', ctx=mx.cpu(), lazy=False)
+    assert isinstance(data2, list) and len(data2) == 2
+    for x, y in zip(data, data2):
+        assert_array_equal(y.asnumpy(), x.asnumpy())
+
+
+def test_ndarray_load_mmap(tmp_path):
+    fname = str(tmp_path / 'data.params')
+    dmap = {'a': mx.nd.array(np.random.uniform(size=(5, 7))),
+            'b': mx.nd.array(np.arange(10), dtype='int64'),
+            'c': mx.nd.array(np.random.uniform(size=(3,)), dtype='float16'),
+            'sparse': mx.nd.array(np.eye(4)).tostype('csr')}
+    mx.nd.save(fname, dmap)
+    loaded = mx.nd.load(fname, mmap=True)
+    assert sorted(loaded) == sorted(dmap)
+    for k, x in dmap.items():
+        y = loaded[k]
+        assert y.dtype == x.dtype and y.shape == x.shape and y.stype == x.stype
+        assert_array_equal(y.asnumpy(), x.asnumpy())
+    # writes go to private copies of the mapped pages
+    loaded['a'][:] = 0
+    loaded['a'].wait_to_read()
+    assert_array_equal(mx.nd.load(fname)['a'].asnumpy(), dmap['a'].asnumpy())
+
+    data = [mx.nd.ones((2, 2)), mx.nd.zeros((0, 3))]
+    mx.nd.save(fname, data)
+    data2 = mx.nd.load(fname, mmap=True)
+    assert isinstance(data2, list) and len(data2) == 2
+    for x, y in zip(data, data2):
+        assert y.shape == x.shape
+        assert_array_equal(y.asnumpy(), x.asnumpy())
+
+
 @mx.util.use_np
 def test_ndarray_load_fortran_order(tmp_path):
     arr = np.arange(20).reshape((2, 10)).T
@@ -494,6 +568,70 @@ def test_buffer_load():
 
 
 @pytest.mark.serial
+def test_ndarray_view_dependency():
+    buf = mx.nd.zeros((8, 100))
+    buf.wait_to_read()
+    expected = np.zeros((8, 100), dtype=np.float32)
+    # the writes to disjoint rows are ordered with the operations on the whole buffer
+    rows = [buf[i] for i in range(8)]
+    for i, row in enumerate(rows):
+        row[:] = i + 1
+        row *= 2
+        expected[i] = (i + 1) * 2
+    assert same(buf.asnumpy(), expected)
+    buf += 1
+    expected += 1
+    assert same(rows[3].asnumpy(), expected[3])
+    # views of a view and views overlapping other views
+    rows[5][10:20] = -1
+    buf[2:4][:] *= 3
+    expected[5, 10:20] = -1
+    expected[2:4] *= 3
+    assert same(buf.asnumpy(), expected)
+    # a view created after a write to the whole buffer waits for it
+    buf[:] = 7
+    assert same(buf[6].asnumpy(), np.full((100,), 7, dtype=np.float32))
+    # a copy from the whole buffer into one of its rows
+    mx.nd.sum(buf, axis=0, out=rows[0])
+    assert same(rows[0].asnumpy(), np.full((100,), 56, dtype=np.float32))
+
+def test_ndarray_asnumpy_async():
+    x = mx.nd.random.uniform(shape=(4, 5))
+    y = x * 2
+    copy = y.asnumpy_async()
+    assert same(copy.result(), y.asnumpy())
+    # into a given buffer, ordered after the later writes to the array only
+    out = np.empty((4, 5), dtype=np.float32)
+    y += 1
+    copy = y.asnumpy_async(out=out)
+    y[:] = 0
+    assert copy.result() is out
+    assert same(out, x.asnumpy() * 2 + 1)
+    ints = mx.nd.arange(6, dtype='int32').reshape((2, 3))
+    assert same(ints.asnumpy_async().result(), np.arange(6, dtype=np.int32).reshape((2, 3)))
+    # a handle dropped before its copy is done
+    for _ in range(4):
+        y.asnumpy_async()
+    assertRaises(ValueError, y.asnumpy_async, np.empty((5, 4), dtype=np.float32))
+    assertRaises(ValueError, y.asnumpy_async, np.empty((4, 5), dtype=np.float64))
+    assertRaises(ValueError, y.asnumpy_async, np.empty((5, 4), dtype=np.float32).T)
+
+def test_ndarray_small_data():
+    # the arrays at and around the size of the blocks of the pool of small data
+    for dtype in ['float32', 'float64', 'int8', 'int32']:
+        for size in [1, 15, 16, 17, 64]:
+            arrays = [mx.nd.full((size,), i, dtype=dtype) for i in range(32)]
+            total = arrays[0].copy()
+            for arr in arrays[1:]:
+                total += arr
+            del arrays
+            expected = np.full((size,), sum(range(32)), dtype=dtype)
+            assert same(total.asnumpy(), expected)
+    x = mx.nd.array([1, 2, 3])
+    y = x.reshape((3, 1)) * x.reshape((1, 3))
+    assert same(y.asnumpy(), np.outer([1, 2, 3], [1, 2, 3]).astype(np.float32))
+    assert same(mx.nd.array(y.shape).asnumpy(), np.array([3, 3], dtype=np.float32))
+
 def test_ndarray_slice():
     shape = (10,)
     A = mx.nd.array(np.random.uniform(-10, 10, shape))
@@ -1818,6 +1956,64 @@ def test_dlpack():
             assert_almost_equal(a_np, d)
             assert_almost_equal(a_np, e)
 
+def test_deduplicate():
+    import ctypes
+    from mxnet.base import _LIB, check_call
+
+    def data_ptr(arr):
+        ptr = ctypes.c_void_p()
+        check_call(_LIB.MXNDArrayGetData(arr.handle, ctypes.byref(ptr)))
+        return ptr.value
+
+    w = np.random.uniform(size=(4, 5)).astype(np.float32)
+    a, b, c = mx.nd.deduplicate([mx.nd.array(w), mx.nd.array(w), mx.nd.array(w + 1)])
+    d = mx.nd.deduplicate({'w': mx.nd.array(w.astype(np.float16))})['w']
+    assert data_ptr(a) == data_ptr(b)
+    assert data_ptr(a) != data_ptr(c)
+    assert d.dtype == np.float16 and data_ptr(d) != data_ptr(a)
+    del a
+    assert_almost_equal(b, w)
+    assert_almost_equal(c, w + 1)
+    assert_almost_equal(d, w.astype(np.float16))
+
+def test_cached_op_dlpack():
+    import ctypes
+    from mxnet.base import _LIB, check_call
+    from mxnet.dlpack import DLContext, DLDataType, DLTensor, DLManagedTensor, DeleterFunc
+    released = []
+
+    @DeleterFunc
+    def deleter(dl_managed_tensor):
+        released.append(dl_managed_tensor.contents.manager_ctx)
+
+    shapes = []
+    def make_tensor(array, tag):
+        shapes.append(array.ctypes.shape_as(ctypes.c_int64))
+        t = DLManagedTensor()
+        t.dl_tensor = DLTensor(array.ctypes.data_as(ctypes.c_void_p), DLContext(1, 0), array.ndim,
+                               DLDataType(*DLDataType.TYPE_MAP[str(array.dtype)]), shapes[-1],
+                               None, 0)
+        t.manager_ctx = tag
+        t.deleter = deleter
+        return t
+
+    a = mx.sym.var('a')
+    b = mx.sym.var('b')
+    op = mx.nd.CachedOp((a + b) * 2)
+    x = np.random.uniform(size=(3, 4)).astype(np.float32)
+    y = np.random.uniform(size=(3, 4)).astype(np.float32)
+    out = np.zeros((3, 4), dtype=np.float32)
+    tensors = [make_tensor(x, 1), make_tensor(y, 2), make_tensor(out, 3)]
+    inputs = (ctypes.c_void_p * 2)(ctypes.addressof(tensors[0]), ctypes.addressof(tensors[1]))
+    outputs = (ctypes.c_void_p * 1)(ctypes.addressof(tensors[2]))
+    check_call(_LIB.MXInvokeCachedOpDLPack(op.handle, 2, inputs, 1, outputs, 1, 0,
+                                           ctypes.c_bool(True)))
+    # the output is written in place, and the tensors are released once the engine is done
+    assert_almost_equal(out, (x + y) * 2)
+    mx.nd.waitall()
+    assert sorted(released) == [1, 2, 3]
+
+
 def test_ndarray_is_inf():
     random_dimensions = np.random.randint(2, 5)
     random_shape = [np.random.randint(2, 5) for i in range(random_dimensions)]
@@ -2024,6 +2220,28 @@ def test_update_ops_mutation_failed_seed():
     _test_update_ops_mutation_impl()
 
 
+def test_imperative_dispatch_cache():
+    # the same calls repeated, interleaved with calls of other shapes, types and attributes
+    for _ in range(3):
+        for shape, dtype in [((2, 3), 'float32'), ((4,), 'float64'), ((2, 3), 'float16')]:
+            a_np = np.random.uniform(-1, 1, shape).astype(dtype)
+            a = mx.nd.array(a_np, dtype=dtype)
+            assert_almost_equal((a + a).asnumpy(), a_np + a_np)
+            assert_almost_equal(mx.nd.clip(a, -0.5, 0.5).asnumpy(), np.clip(a_np, -0.5, 0.5))
+            assert_almost_equal(mx.nd.clip(a, 0, 0.25).asnumpy(), np.clip(a_np, 0, 0.25))
+            assert_almost_equal(a.sum(axis=0).asnumpy(), a_np.sum(axis=0), rtol=1e-2, atol=1e-2)
+            out = mx.nd.zeros(shape, dtype=dtype)
+            mx.nd.relu(a, out=out)
+            assert_almost_equal(out.asnumpy(), np.maximum(a_np, 0))
+            # preallocated outputs of the wrong shape are still rejected
+            with pytest.raises(mx.MXNetError):
+                mx.nd.relu(a, out=mx.nd.zeros((7,), dtype=dtype))
+    csr = mx.nd.array(np.eye(3)).tostype('csr')
+    for _ in range(2):
+        assert (csr * 2).stype == 'csr'
+        assert_almost_equal((csr * 2).asnumpy(), np.eye(3) * 2)
+
+
 def test_large_int_rounding():
     large_integer = 50000001
 
@@ -92,6 +92,55 @@ def test_normalize():
     assertRaises(MXNetError, normalize_transformer, invalid_data_in)
 
 
+@use_np
+def test_to_tensor_normalize():
+    mean, std = (0.485, 0.456, 0.406), (0.229, 0.224, 0.225)
+    for shape, axes in [((30, 40, 3), (2, 0, 1)), ((2, 30, 40, 3), (0, 3, 1, 2))]:
+        data_in = np.random.uniform(0, 255, shape).astype(dtype=np.uint8)
+        expected = transforms.Normalize(mean, std)(transforms.ToTensor()(data_in))
+        out = transforms.ToTensorNormalize(mean, std)(data_in)
+        assert out.dtype == _np.float32
+        assert_almost_equal(out.asnumpy(), expected.asnumpy(), rtol=1e-5, atol=1e-5)
+        ref = (_np.transpose(data_in.asnumpy(), axes) / 255.0 -
+               _np.array(mean).reshape(3, 1, 1)) / _np.array(std).reshape(3, 1, 1)
+        assert_almost_equal(out.asnumpy(), ref, rtol=1e-5, atol=1e-5)
+
+    # Compose fuses ToTensor followed by Normalize
+    composed = transforms.Compose([transforms.ToTensor(), transforms.Normalize(mean, std)])
+    assert len(composed) == 1
+    assert_almost_equal(composed(data_in).asnumpy(), expected.asnumpy(), rtol=1e-5, atol=1e-5)
+
+
+@use_np
+def test_color_jitter_chain():
+    data_in = np.random.uniform(0, 255, (30, 40, 3)).astype(dtype=np.uint8)
+    img = data_in.asnumpy().astype(_np.float32)
+    gray = img.dot(_np.array([0.299, 0.587, 0.114], dtype=_np.float32))
+
+    out = npx.image.random_brightness(data_in, min_factor=0.5, max_factor=0.5)
+    assert same(out.asnumpy(), (img * 0.5).astype(_np.uint8))
+
+    # a saturation factor of 0 leaves the gray level in all channels
+    out = npx.image.random_saturation(data_in, min_factor=0, max_factor=0)
+    assert_almost_equal(out.asnumpy(), _np.repeat(gray[:, :, None], 3, axis=2), rtol=0, atol=1)
+
+    # a contrast factor of 0 leaves the mean gray level everywhere
+    out = npx.image.random_contrast(data_in, min_factor=0, max_factor=0)
+    assert_almost_equal(out.asnumpy(), _np.full(img.shape, gray.mean()), rtol=0, atol=1)
+
+    # shifting the hue by no turn or by a full turn leaves the image
+    for shift in [0, 1]:
+        out = npx.image.random_hue(data_in, min_factor=shift, max_factor=shift)
+        assert_almost_equal(out.asnumpy(), img, rtol=0, atol=1)
+
+    # Compose fuses RandomColorJitter followed by RandomLighting
+    composed = transforms.Compose([transforms.RandomColorJitter(0.4, 0.4, 0.4, 0.1),
+                                   transforms.RandomLighting(0.1)])
+    assert len(composed) == 1
+    out = composed(data_in)
+    assert out.shape == data_in.shape and out.dtype == data_in.dtype
+
+
 @use_np
 def test_resize():
     def _test_resize_with_diff_type(dtype):
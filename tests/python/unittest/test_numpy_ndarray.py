@@ -1005,6 +1005,41 @@ def test_np_save_load_large_ndarrays(load_fn, tmp_path):
                            else arr_loaded, weight)
 
 
+@use_np
+@pytest.mark.parametrize('load_fn', [_np.load, npx.load])
+def test_np_savez_compressed(load_fn, tmp_path):
+    # a member larger than a deflated chunk, and empty and scalar ones
+    arrays = {'weight': np.arange(3 * 1024 * 1024, dtype='float32').reshape((1024, -1)) % 7,
+              'empty': np.zeros((0, 3)), 'scalar': np.array(5, dtype='int64')}
+    fname = str(tmp_path / 'params.npz')
+    npx.savez_compressed(fname, level=1, **arrays)
+    assert os.path.getsize(fname) < arrays['weight'].size
+    loaded = load_fn(fname)
+    for k, v in arrays.items():
+        assert _np.array_equal(loaded[k].asnumpy() if load_fn is npx.load else loaded[k],
+                               v.asnumpy())
+
+
+@use_np
+def test_np_load_mapped(tmp_path):
+    weight = np.arange(4096, dtype='float32').reshape((64, 64))
+    bias = np.arange(7, dtype='int8')
+    for fname, save_fn in [('params.npy', lambda f: npx.save(f, weight)),
+                           ('params.npz', lambda f: npx.savez(f, weight=weight, bias=bias))]:
+        fname = str(tmp_path / fname)
+        save_fn(fname)
+        loaded = npx.load(fname, mmap=True)
+        if isinstance(loaded, dict):
+            assert _np.array_equal(loaded['bias'].asnumpy(), bias.asnumpy())
+            loaded = loaded['weight']
+        assert _np.array_equal(loaded.asnumpy(), weight.asnumpy())
+        # the mapping is private, changes of the arrays never reach the file
+        loaded[:] = 0
+        stored = _np.load(fname)
+        stored = stored['weight'] if fname.endswith('.npz') else stored
+        assert _np.array_equal(stored, weight.asnumpy())
+
+
 @use_np
 @pytest.mark.serial
 @pytest.mark.parametrize('load_fn', [_np.load, npx.load])
@@ -8298,6 +8298,31 @@ def test_np_nonzero():
                 assert_almost_equal(mx_out.asnumpy(), np_out, rtol, atol)
 
 
+@use_np
+@pytest.mark.parametrize('shape', [(), (5,), (2, 3, 4), (1, 0)])
+@pytest.mark.parametrize('hybridize', [False, True])
+def test_np_nonzero_padded(shape, hybridize):
+    class TestNonzeroPadded(HybridBlock):
+        def forward(self, x):
+            return npx.nonzero_padded(x)
+
+    block = TestNonzeroPadded()
+    if hybridize:
+        block.hybridize(static_alloc=True, static_shape=True)
+    x = np.array(onp.random.randint(0, 2, size=shape), dtype='float32')
+    if len(shape) == 0:
+        expected = onp.zeros((int(x.item() != 0), 1))
+    else:
+        expected = onp.transpose(onp.nonzero(x.asnumpy()))
+    out, valid_num = block(x)
+    assert out.shape == (x.size, max(x.ndim, 1))
+    assert valid_num.shape == (1,) and valid_num.dtype == onp.int64
+    num = int(valid_num.item())
+    assert num == expected.shape[0]
+    assert_almost_equal(out.asnumpy()[:num], expected)
+    assert (out.asnumpy()[num:] == 0).all()
+
+
 @use_np
 def test_np_unique():
     class TestUnique(HybridBlock):
@@ -8357,6 +8382,175 @@ def test_np_unique():
                         assert_almost_equal(mx_out[i].asnumpy(), np_out[i], rtol=1e-3, atol=1e-5)
 
 
+@use_np
+@pytest.mark.parametrize('shape', [(5,), (5, 4), (2, 3, 4), (0,)])
+@pytest.mark.parametrize('dtype', ['float32', 'int32', 'int64'])
+@pytest.mark.parametrize('hybridize', [False, True])
+def test_np_unique_padded(shape, dtype, hybridize):
+    class TestUniquePadded(HybridBlock):
+        def forward(self, a):
+            return npx.unique_padded(a, return_index=True, return_inverse=True, return_counts=True)
+
+    block = TestUniquePadded()
+    if hybridize:
+        block.hybridize(static_alloc=True, static_shape=True)
+    x = np.array(onp.random.randint(-3, 3, size=shape), dtype=dtype)
+    values, index, inverse, counts = onp.unique(x.asnumpy(), return_index=True,
+                                                return_inverse=True, return_counts=True)
+    out = block(x)
+    assert len(out) == 5
+    for o in out[:-1]:
+        assert o.shape == (x.size,)
+    num = int(out[-1].item())
+    assert num == values.size
+    for o, expected in zip(out[:-1], [values, index, None, counts]):
+        if expected is not None:
+            assert_almost_equal(o.asnumpy()[:num], expected)
+            assert (o.asnumpy()[num:] == 0).all()
+    assert_almost_equal(out[2].asnumpy(), inverse.reshape(-1))
+
+
+@use_np
+@pytest.mark.parametrize('hybridize', [False, True])
+def test_np_boolean_mask_padded(hybridize):
+    class TestBooleanMaskPadded(HybridBlock):
+        def forward(self, data, index):
+            return npx.boolean_mask_padded(data, index)
+
+    block = TestBooleanMaskPadded()
+    if hybridize:
+        block.hybridize(static_alloc=True, static_shape=True)
+    data = np.random.uniform(size=(6, 3))
+    index = np.array([0, 1, 1, 0, 1, 0], dtype='bool')
+    data.attach_grad()
+    with mx.autograd.record():
+        out, valid_num = block(data, index)
+        loss = (out * np.arange(18).reshape(6, 3)).sum()
+    loss.backward()
+    assert out.shape == data.shape
+    assert int(valid_num.item()) == 3
+    expected = data.asnumpy()[index.asnumpy()]
+    assert_almost_equal(out.asnumpy()[:3], expected)
+    assert (out.asnumpy()[3:] == 0).all()
+    expected_grad = onp.zeros((6, 3))
+    expected_grad[index.asnumpy()] = onp.arange(9).reshape(3, 3)
+    assert_almost_equal(data.grad.asnumpy(), expected_grad)
+
+
+@use_np
+@pytest.mark.parametrize('axis', [0, 1])
+def test_np_sequence_pack(axis):
+    max_length, lengths = 4, [4, 0, 2]
+    shape = (max_length, 3, 2) if axis == 0 else (3, max_length, 2)
+    data = np.random.uniform(size=shape, dtype='float64')
+    data.attach_grad()
+    padded = data.asnumpy() if axis == 0 else data.asnumpy().transpose(1, 0, 2)
+    expected = onp.concatenate([padded[:n, b] for b, n in enumerate(lengths)])
+    weight = onp.random.uniform(size=expected.shape)
+    with mx.autograd.record():
+        packed, offsets = npx.sequence_pack(data, np.array(lengths), axis=axis)
+        loss = (packed * np.array(weight)).sum()
+    loss.backward()
+    assert offsets.dtype == onp.int64
+    assert_almost_equal(offsets.asnumpy(), onp.array([0, 4, 4, 6]))
+    assert_almost_equal(packed.asnumpy(), expected)
+    mask = onp.zeros(shape)
+    for b, n in enumerate(lengths):
+        if axis == 0:
+            mask[:n, b] = 1
+        else:
+            mask[b, :n] = 1
+    unpacked = npx.sequence_unpack(packed, offsets, max_length=max_length, axis=axis)
+    assert_almost_equal(unpacked.asnumpy(), data.asnumpy() * mask)
+    assert_almost_equal(data.grad.asnumpy(), npx.sequence_unpack(
+        np.array(weight), offsets, max_length=max_length, axis=axis).asnumpy())
+
+    # unpacking to a shorter length truncates, and gives no gradient to the dropped tokens
+    packed.attach_grad()
+    with mx.autograd.record():
+        first = npx.sequence_unpack(packed, offsets, max_length=1, axis=axis)
+    first.backward()
+    assert first.shape == ((1, 3, 2) if axis == 0 else (3, 1, 2))
+    nonempty = (onp.array(lengths) > 0)[:, None]
+    assert_almost_equal(first.asnumpy().reshape(3, 2), padded[0] * nonempty)
+    expected_grad = onp.zeros(expected.shape)
+    expected_grad[[0, 4]] = 1
+    assert_almost_equal(packed.grad.asnumpy(), expected_grad)
+
+
+@use_np
+def test_np_packed_sequence_last_reverse():
+    offsets = np.array([0, 3, 3, 5], dtype='int32')
+    data = np.random.uniform(size=(5, 2), dtype='float64')
+    data.attach_grad()
+    with mx.autograd.record():
+        last = npx.packed_sequence_last(data, offsets)
+        loss = (last * np.array([[1., 2.], [3., 4.], [5., 6.]])).sum()
+    loss.backward()
+    x = data.asnumpy()
+    assert_almost_equal(last.asnumpy(), onp.stack([x[2], onp.zeros(2), x[4]]))
+    expected_grad = onp.zeros((5, 2))
+    expected_grad[2], expected_grad[4] = [1, 2], [5, 6]
+    assert_almost_equal(data.grad.asnumpy(), expected_grad)
+
+    weight = onp.arange(10.).reshape(5, 2)
+    with mx.autograd.record():
+        reverse = npx.packed_sequence_reverse(data, offsets)
+        loss = (reverse * np.array(weight)).sum()
+    loss.backward()
+    order = [2, 1, 0, 4, 3]
+    assert_almost_equal(reverse.asnumpy(), x[order])
+    assert_almost_equal(data.grad.asnumpy(), weight[order])
+
+
+@use_np
+@pytest.mark.parametrize('causal', [False, True])
+@pytest.mark.parametrize('hybridize', [False, True])
+def test_np_packed_attention(causal, hybridize):
+    class TestPackedAttention(HybridBlock):
+        def forward(self, query, key, value, offsets):
+            return npx.packed_attention(query, key, value, offsets, num_heads=2, causal=causal)
+
+    # head_dim 40 spans two chunks of accumulated dimensions
+    num_heads, head_dim, lengths = 2, 40, [3, 0, 5, 1]
+    offsets = onp.concatenate([[0], onp.cumsum(lengths)])
+    total = int(offsets[-1])
+    scale = 1 / onp.sqrt(head_dim)
+
+    def reference(query, key, value):
+        outs = []
+        for start, end in zip(offsets[:-1].tolist(), offsets[1:].tolist()):
+            if start == end:
+                continue
+            split = [x[start:end].reshape(end - start, num_heads, head_dim).transpose(1, 0, 2)
+                     for x in (query, key, value)]
+            scores = np.matmul(split[0], split[1].transpose(0, 2, 1)) * scale
+            if causal:
+                mask = onp.triu(onp.ones((end - start, end - start)), 1) * 1e9
+                scores = scores - np.array(mask, dtype='float64')
+            out = np.matmul(npx.softmax(scores, axis=-1), split[2])
+            outs.append(out.transpose(1, 0, 2).reshape(end - start, num_heads * head_dim))
+        return np.concatenate(outs, axis=0)
+
+    block = TestPackedAttention()
+    if hybridize:
+        block.hybridize()
+    inputs = [np.random.normal(size=(total, num_heads * head_dim), dtype='float64')
+              for _ in range(3)]
+    weight = np.random.normal(size=(total, num_heads * head_dim), dtype='float64')
+    grads = []
+    for fn in (lambda q, k, v: block(q, k, v, np.array(offsets)), reference):
+        for x in inputs:
+            x.attach_grad()
+        with mx.autograd.record():
+            out = fn(*inputs)
+            loss = (out * weight).sum()
+        loss.backward()
+        grads.append([out.asnumpy()] + [x.grad.asnumpy() for x in inputs])
+    for actual, expected in zip(*grads):
+        assert_almost_equal(actual, expected, rtol=1e-5, atol=1e-6)
+
+
 @use_np
 @pytest.mark.parametrize('shape,index,inverse,counts', [
     ((), True, True, True),
@@ -8999,6 +9193,10 @@ def test_np_einsum():
     configs = [
         (('ij,jk,kl->il'), [(2, 2), (2, 5), (5, 2)]),
         (('ea,fb,abcd,gc,hd->efgh'), [(5, 5), (5, 5), (5, 5, 5, 5), (5, 5), (5, 5)]),
+        # batched GEMM with and without transposes
+        (('bij,bjk->bik'), [(3, 4, 5), (3, 5, 2)]),
+        (('bqhd,bhkd->bhqk'), [(2, 4, 3, 5), (2, 3, 6, 5)]),
+        (('bij,bjk,bkl->bli'), [(2, 3, 4), (2, 4, 5), (2, 5, 3)]),
     ]
     dtypes = ['int32', 'float32', 'float64']
     for hybridize in [False, True]:
@@ -9548,6 +9746,27 @@ def test_np_percentile():
         assert_almost_equal(mx_out.asnumpy(), np_out, atol=atol, rtol=rtol)
 
 
+@use_np
+@pytest.mark.parametrize('interpolation', ['linear', 'lower', 'higher', 'nearest', 'midpoint'])
+def test_np_large_sort_unique_percentile(interpolation):
+    # large enough to be sorted by several threads, with many ties
+    x = onp.random.randint(-1000, 1000, size=(100000,)).astype(onp.float32)
+    a = np.array(x)
+    assert_almost_equal(np.sort(a).asnumpy(), onp.sort(x))
+    assert_almost_equal(np.argsort(a).asnumpy(), onp.argsort(x, kind='stable'))
+    mx_out = np.unique(a, return_index=True, return_inverse=True, return_counts=True)
+    np_out = onp.unique(x, return_index=True, return_inverse=True, return_counts=True)
+    for mx_o, np_o in zip(mx_out, np_out):
+        assert_almost_equal(mx_o.asnumpy(), np_o.reshape(-1))
+    assert_almost_equal(np.unique(a).asnumpy(), onp.unique(x))
+    # selected by rows, and fully sorted for many percentiles
+    x = onp.random.uniform(-10.0, 10.0, size=(3, 50001))
+    for q in [onp.array([0., 12.5, 50., 100.]), onp.linspace(0., 100., 33)]:
+        mx_out = np.percentile(np.array(x), np.array(q), axis=1, interpolation=interpolation)
+        np_out = onp.percentile(x, q, axis=1, interpolation=interpolation)
+        assert_almost_equal(mx_out.asnumpy(), np_out, rtol=1e-5, atol=1e-5)
+
+
 @use_np
 def test_np_diff():
     def np_diff_backward(ograd, n, axis):
@@ -10552,6 +10771,31 @@ def test_np_bincount():
         assert_almost_equal(mx_out.asnumpy(), np_out, rtol=rtol, atol=atol)
 
 
+@use_np
+@pytest.mark.parametrize('bins', [1, 7, 100, 20000])
+def test_np_histogram_bincount_many_elements(bins):
+    # enough elements per bin for the accumulation into local histograms
+    size = 200000
+    data_np = onp.random.randint(0, bins, size=size).astype('int64')
+    weights_np = onp.random.uniform(-1, 1, size=size).astype('float64')
+    data, weights = np.array(data_np), np.array(weights_np)
+    assert_almost_equal(np.bincount(data).asnumpy(), onp.bincount(data_np))
+    assert_almost_equal(np.bincount(data, weights).asnumpy(), onp.bincount(data_np, weights_np),
+                        rtol=1e-7, atol=1e-9)
+    values_np = onp.random.uniform(-1, 11, size=size).astype('float32')
+    values = np.array(values_np)
+    mx_hist, mx_edges = np.histogram(values, bins=bins, range=(0, 10))
+    np_hist, np_edges = onp.histogram(values_np, bins=bins, range=(0, 10))
+    assert_almost_equal(mx_edges.asnumpy(), np_edges, rtol=1e-5, atol=1e-5)
+    # the elements at the edges of the bins may round either way
+    assert onp.abs(mx_hist.asnumpy() - np_hist).sum() <= 2 * bins
+    assert mx_hist.asnumpy().sum() == np_hist.sum()
+    edges_np = onp.sort(onp.random.uniform(0, 10, size=min(bins, 50) + 1)).astype('float32')
+    mx_hist, _ = np.histogram(values, bins=np.array(edges_np))
+    np_hist, _ = onp.histogram(values_np, bins=edges_np)
+    assert_almost_equal(mx_hist.asnumpy(), np_hist)
+
+
 @use_np
 @pytest.mark.skip(reason='Test hangs. Tracked in #18144')
 def test_np_empty_like():
@@ -11801,3 +12045,36 @@ def test_np_standard_binary_funcs(func, func2, promoted, dtypes, ref_grad_a, ref
                 assert_almost_equal(mx_out.asnumpy(), np_out.astype(mx_out.dtype), rtol=rtol, atol=atol,
                                     use_broadcast=False, equal_nan=True)
 
+
+
+@use_np
+def test_np_lazy_evaluation():
+    a_np = onp.random.uniform(0.5, 1.5, (3, 4)).astype('float32')
+    b_np = onp.random.uniform(0.5, 1.5, (3, 4)).astype('float32')
+    c_np = onp.random.uniform(0.5, 1.5, (4,)).astype('float32')
+    a, b, c = np.array(a_np), np.array(b_np), np.array(c_np)
+    with npx.lazy():
+        assert npx.is_lazy()
+        d = a * b + c
+        e = np.exp(np.sqrt(d) - 1) * 2
+        # an intermediate still referenced is computed along with the array read
+        f = d / 2
+        g = np.tanh(f) + np.square(f)
+        assert_almost_equal(g.asnumpy(), onp.tanh((a_np * b_np + c_np) / 2) +
+                            onp.square((a_np * b_np + c_np) / 2), rtol=1e-5, atol=1e-6)
+        assert_almost_equal(f.asnumpy(), (a_np * b_np + c_np) / 2, rtol=1e-5, atol=1e-6)
+        h = a - 1
+        # writing to an array computes the operators pending on it first
+        a += 1
+        i = a * 3
+    assert not npx.is_lazy()
+    assert_almost_equal(d.asnumpy(), a_np * b_np + c_np, rtol=1e-5, atol=1e-6)
+    assert_almost_equal(e.asnumpy(), onp.exp(onp.sqrt(a_np * b_np + c_np) - 1) * 2,
+                        rtol=1e-5, atol=1e-6)
+    assert_almost_equal(h.asnumpy(), a_np - 1, rtol=1e-5, atol=1e-6)
+    assert_almost_equal(a.asnumpy(), a_np + 1, rtol=1e-5, atol=1e-6)
+    assert_almost_equal(i.asnumpy(), (a_np + 1) * 3, rtol=1e-5, atol=1e-6)
+    # operators without an elementwise description run eagerly within the scope
+    with npx.lazy():
+        j = np.dot(np.exp(a), b.T) + 1
+    assert_almost_equal(j.asnumpy(), onp.dot(onp.exp(a_np + 1), b_np.T) + 1, rtol=1e-4, atol=1e-5)
@@ -1779,6 +1779,60 @@ def test_convolution_grouping():
                 assert_almost_equal(arr1, arr2)
 
 
+def np_conv2d_nchw(x, w, stride, pad, num_group):
+    n, c, h, wid = x.shape
+    f, cg, kh, kw = w.shape
+    xp = np.pad(x, ((0, 0), (0, 0), (pad[0], pad[0]), (pad[1], pad[1])))
+    oh = (h + 2 * pad[0] - kh) // stride[0] + 1
+    ow = (wid + 2 * pad[1] - kw) // stride[1] + 1
+    out = np.zeros((n, f, oh, ow))
+    fg = f // num_group
+    for g in range(num_group):
+        for i in range(kh):
+            for j in range(kw):
+                win = xp[:, g * cg:(g + 1) * cg,
+                         i:i + stride[0] * (oh - 1) + 1:stride[0],
+                         j:j + stride[1] * (ow - 1) + 1:stride[1]]
+                out[:, g * fg:(g + 1) * fg] += np.einsum('nchw,fc->nfhw', win,
+                                                         w[g * fg:(g + 1) * fg, :, i, j])
+    return out
+
+
+@pytest.mark.parametrize('shape,num_filter,num_group,pad', [
+    ((2, 16, 9, 7), 24, 1, (1, 1)),
+    ((1, 16, 6, 5), 16, 2, (0, 2)),
+    ((3, 8, 4, 4), 8, 1, (2, 0)),
+])
+def test_convolution_3x3_stride_1(shape, num_filter, num_group, pad):
+    # the shapes of 3x3 convolutions that CPU builds without oneDNN compute with Winograd
+    x = np.random.normal(size=shape).astype(np.float32)
+    w = np.random.normal(size=(num_filter, shape[1] // num_group, 3, 3)).astype(np.float32)
+    b = np.random.normal(size=(num_filter,)).astype(np.float32)
+    out = mx.nd.Convolution(mx.nd.array(x), mx.nd.array(w), mx.nd.array(b), kernel=(3, 3),
+                            pad=pad, num_filter=num_filter, num_group=num_group)
+    expected = np_conv2d_nchw(x, w, (1, 1), pad, num_group) + b.reshape(1, -1, 1, 1)
+    assert_almost_equal(out, expected, rtol=1e-4, atol=1e-4)
+
+
+@pytest.mark.parametrize('kernel,stride,pad,num_group', [
+    ((3, 3), (1, 1), (1, 1), 1),
+    ((3, 2), (2, 1), (1, 0), 2),
+    ((1, 1), (1, 1), (0, 0), 1),
+    ((1, 1), (1, 1), (0, 0), 2),
+])
+def test_convolution_nhwc_inference(kernel, stride, pad, num_group):
+    shape, num_filter = (2, 7, 9, 6), 8
+    x = np.random.normal(size=shape).astype(np.float32)
+    w = np.random.normal(size=(num_filter,) + kernel + (shape[3] // num_group,)).astype(np.float32)
+    b = np.random.normal(size=(num_filter,)).astype(np.float32)
+    out = mx.nd.Convolution(mx.nd.array(x), mx.nd.array(w), mx.nd.array(b), kernel=kernel,
+                            stride=stride, pad=pad, num_filter=num_filter, num_group=num_group,
+                            layout='NHWC')
+    expected = np_conv2d_nchw(x.transpose(0, 3, 1, 2), w.transpose(0, 3, 1, 2), stride, pad,
+                              num_group) + b.reshape(1, -1, 1, 1)
+    assert_almost_equal(out, expected.transpose(0, 2, 3, 1), rtol=1e-4, atol=1e-4)
+
+
 @pytest.mark.skip(reason="Flaky test https://github.com/apache/incubator-mxnet/issues/14052")
 def test_depthwise_convolution():
     for dim in [1,2]:
@@ -2571,6 +2625,22 @@ def test_reduce():
                           mx.symbol.norm, test_exclude=False, test_none_axis=test_none)
 
 
+
+@pytest.mark.parametrize('shape,axis', [
+    ((4099, 3), 0), ((4099, 3), 1), ((3, 5001), 1), ((2, 1031, 9), (0, 2)),
+    ((7, 600, 13), 1), ((6, 5, 4, 3), (1, 3)), ((1 << 20,), None)])
+def test_reduce_tiled(shape, axis):
+    # long reductions over inner and outer axes, into few and many outputs
+    data = np.random.uniform(-1, 1, size=shape).astype(np.float32)
+    for name in ['sum', 'mean', 'max', 'min', 'norm']:
+        if name == 'norm':
+            expected = np.sqrt(np.sum(np.square(data.astype(np.float64)), axis=axis))
+            out = mx.nd.norm(mx.nd.array(data), axis=axis)
+        else:
+            expected = getattr(np, name)(data.astype(np.float64), axis=axis)
+            out = getattr(mx.nd, name)(mx.nd.array(data), axis=axis)
+        assert_almost_equal(out, expected.astype(np.float32), rtol=1e-4, atol=1e-4)
+
 def test_broadcast():
     sample_num = 200
     for _ in range(sample_num):
@@ -2652,6 +2722,28 @@ def test_pseudo2dtranspose():
                 assert_allclose(np.transpose(x.asnumpy(), axes=axes), y.asnumpy())
 
 
+@pytest.mark.serial
+@pytest.mark.parametrize('dt', ['int8', 'half', 'float32', 'float64'])
+@pytest.mark.parametrize('dims,axes', [
+    ((4, 33, 35, 8), (0, 2, 1, 3)),
+    ((3, 35, 5, 33), (3, 1, 0, 2)),
+    ((2, 3, 37, 1, 34), (4, 2, 3, 0, 1)),
+    ((2, 3, 2, 3, 2, 3, 2, 3, 2), (8, 6, 4, 2, 0, 1, 3, 5, 7)),
+])
+def test_permute_transpose(dt, dims, axes):
+    x_np = np.random.uniform(-10, 10, size=dims).astype(dt)
+    x = mx.nd.array(x_np, dtype=dt)
+    y = mx.nd.transpose(x, axes=axes)
+    assert_allclose(np.transpose(x_np, axes=axes), y.asnumpy())
+    # the gradient permutes back, adding to the existing one
+    x.attach_grad(grad_req='add')
+    x.grad[:] = 1
+    with mx.autograd.record():
+        y = mx.nd.transpose(x, axes=axes)
+    y.backward(mx.nd.array(np.transpose(x_np, axes=axes), dtype=dt))
+    assert_allclose(x_np + 1, x.grad.asnumpy())
+
+
 @pytest.mark.serial
 def test_big_transpose():
     n = [1]
@@ -2932,6 +3024,36 @@ def test_stn_valid_sampling():
     ) + target_shape))
 
 
+def test_stn_fused_grid_sampling():
+    # the fused grid generation must agree with GridGenerator followed by BilinearSampler,
+    # both for a batch of many small outputs and for non-square shapes
+    ctx = default_device()
+    for n, c, src_shape, target_shape in [(32, 3, (12, 12), (4, 4)), (2, 5, (9, 13), (7, 5))]:
+        data_np = np.random.normal(size=(n, c) + src_shape)
+        loc_np = np.tile([1., 0., 0., 0., 1., 0.], (n, 1)) + np.random.uniform(-0.3, 0.3, (n, 6))
+        out_grad_np = np.random.normal(size=(n, c) + target_shape)
+        results = {}
+        for impl, dtype in [('fused', 'float64'), ('reference', 'float64'), ('fused', 'float16')]:
+            data = mx.nd.array(data_np, ctx=ctx, dtype=dtype)
+            loc = mx.nd.array(loc_np, ctx=ctx, dtype=dtype)
+            data.attach_grad()
+            loc.attach_grad()
+            with mx.autograd.record():
+                if impl == 'fused':
+                    out = mx.nd.SpatialTransformer(data, loc, target_shape=target_shape,
+                                                   transform_type='affine', sampler_type='bilinear')
+                else:
+                    grid = mx.nd.GridGenerator(loc, transform_type='affine', target_shape=target_shape)
+                    out = mx.nd.BilinearSampler(data, grid)
+            out.backward(mx.nd.array(out_grad_np, ctx=ctx, dtype=dtype))
+            results[(impl, dtype)] = [x.asnumpy().astype(np.float64)
+                                      for x in (out, data.grad, loc.grad)]
+        for fused, ref in zip(results[('fused', 'float64')], results[('reference', 'float64')]):
+            assert_almost_equal(fused, ref, rtol=1e-5, atol=1e-7)
+        for fused, ref in zip(results[('fused', 'float16')], results[('reference', 'float64')]):
+            assert_almost_equal(fused, ref, rtol=5e-2, atol=5e-2)
+
+
 def test_dot():
     ctx = default_device()
     dtypes = ['float32', 'float64']
@@ -3593,6 +3715,71 @@ def test_layer_norm(enforce_safe_acc, dtype, forward_check_eps, backward_check_e
                                               finite_grad_check=finite_grad_check)
 
 
+@pytest.mark.parametrize('shape,num_groups', [
+    ((3, 4, 5), 2), ((2, 6, 7, 3), 3), ((5, 8, 33), 8), ((1, 2, 1), 1)
+])
+@pytest.mark.parametrize('dtype', [np.float32, np.float64])
+def test_norm_large_mean(shape, num_groups, dtype):
+    # The CPU kernels compute the moments in one pass; a large common offset checks that
+    # the variance is not formed as E[x^2] - E[x]^2.
+    eps = 1e-3
+    np_data = (np.random.normal(0, 1, shape) + 1000).astype(dtype)
+    ograd = np.random.normal(0, 1, shape).astype(dtype)
+    channels = shape[1]
+    gamma = np.random.uniform(-1, 1, (channels,)).astype(dtype)
+    beta = np.random.uniform(-1, 1, (channels,)).astype(dtype)
+
+    def np_norm(data, dy, axes, param_shape):
+        mean = data.mean(axis=axes, keepdims=True)
+        std = np.sqrt(data.var(axis=axes, keepdims=True) + eps)
+        xhat = (data - mean) / std
+        out = xhat * gamma.reshape(param_shape) + beta.reshape(param_shape)
+        g = dy.reshape(data.shape) * gamma.reshape(param_shape)
+        dx = (g - g.mean(axis=axes, keepdims=True) -
+              xhat * (g * xhat).mean(axis=axes, keepdims=True)) / std
+        return out, dx
+
+    x = mx.nd.array(np_data, dtype=dtype)
+    g = mx.nd.array(gamma, dtype=dtype)
+    b = mx.nd.array(beta, dtype=dtype)
+    for name in ['GroupNorm', 'InstanceNorm', 'LayerNorm']:
+        if name == 'GroupNorm':
+            grouped = np_data.astype(np.float64).reshape(
+                (shape[0], num_groups, channels // num_groups, -1))
+            np_out, np_dx = np_norm(grouped, ograd, (2, 3),
+                                    (1, num_groups, channels // num_groups, 1))
+            sym = mx.sym.GroupNorm(mx.sym.var('data'), mx.sym.var('gamma'), mx.sym.var('beta'),
+                                   num_groups=num_groups, eps=eps)
+        elif name == 'InstanceNorm':
+            if dtype != np.float32:
+                continue
+            flat = np_data.astype(np.float64).reshape((shape[0], channels, -1))
+            np_out, np_dx = np_norm(flat, ograd, (2,), (1, channels, 1))
+            sym = mx.sym.InstanceNorm(mx.sym.var('data'), mx.sym.var('gamma'),
+                                      mx.sym.var('beta'), eps=eps)
+        else:
+            moved = np.moveaxis(np_data.astype(np.float64), 1, -1)
+            np_out, np_dx = np_norm(moved, np.moveaxis(ograd, 1, -1), (-1,), (channels,))
+            np_out, np_dx = np.moveaxis(np_out, -1, 1), np.moveaxis(np_dx, -1, 1)
+            sym = mx.sym.LayerNorm(mx.sym.var('data'), mx.sym.var('gamma'), mx.sym.var('beta'),
+                                   axis=1, eps=eps)
+            # Exercise the axis=-1 kernels on the transposed layout as well.
+            x_last = mx.nd.array(np.moveaxis(np_data, 1, -1), dtype=dtype)
+            x_last.attach_grad()
+            with mx.autograd.record():
+                out_last = mx.nd.LayerNorm(x_last, g, b, axis=-1, eps=eps)
+            out_last.backward(mx.nd.array(np.moveaxis(ograd, 1, -1), dtype=dtype))
+            assert_almost_equal(out_last, np.moveaxis(np_out, 1, -1), rtol=1e-3, atol=1e-3)
+            assert_almost_equal(x_last.grad, np.moveaxis(np_dx, 1, -1), rtol=1e-2, atol=1e-2)
+        check_symbolic_forward(sym, [x, g, b], [np_out.reshape(shape)],
+                               rtol=1e-3, atol=1e-3, dtype=dtype)
+        exe = sym._simple_bind(default_device(), data=shape, gamma=(channels,), beta=(channels,),
+                               type_dict={'data': dtype, 'gamma': dtype, 'beta': dtype})
+        exe.forward(is_train=True, data=x, gamma=g, beta=b)
+        exe.backward([mx.nd.array(ograd, dtype=dtype)])
+        assert_almost_equal(exe.grad_dict['data'], np_dx.reshape(shape), rtol=1e-2, atol=1e-2)
+
+
 # Numpy Implementation of Sequence Ops
 def sequence_last_numpy(array, lengths, axis):
     # create new array of dims [batch, seqlen, ...]
@@ -4164,6 +4351,26 @@ def test_order():
                     is_ascend=True)])
 
 
+@pytest.mark.parametrize('shape,axis,k', [((3, 300000), -1, 10), ((2, 100000, 2), 1, 7),
+                                          ((1, 1000000), -1, 5)])
+@pytest.mark.parametrize('is_ascend', [False, True])
+def test_topk_select_large_rows(shape, axis, k, is_ascend):
+    # values with many ties, which come out by lower index first
+    dat = np.random.randint(0, 1000, size=shape).astype('float32')
+    order = np.argsort(dat if is_ascend else -dat, axis=axis, kind='stable')
+    indices = np.take(order, np.arange(k), axis=axis)
+    values = np.take_along_axis(dat, indices, axis=axis)
+    data = mx.nd.array(dat, ctx=mx.cpu())
+    out_values, out_indices = mx.nd.topk(data, axis=axis, k=k, ret_typ='both',
+                                         is_ascend=is_ascend, dtype='int64')
+    assert_almost_equal(out_values.asnumpy(), values)
+    assert_almost_equal(out_indices.asnumpy(), indices)
+    mask = mx.nd.topk(data, axis=axis, k=k, ret_typ='mask', is_ascend=is_ascend)
+    expected_mask = np.zeros(shape, dtype='float32')
+    np.put_along_axis(expected_mask, indices, 1, axis=axis)
+    assert_almost_equal(mask.asnumpy(), expected_mask)
+
+
 def test_blockgrad():
     a = mx.sym.Variable('a')
     b = mx.sym.BlockGrad(a)
@@ -4489,6 +4696,26 @@ def test_all_finite():
     assert sym_output[0] == 1
 
 
+@pytest.mark.parametrize('dtype', ['float16', 'float32', 'float64'])
+@pytest.mark.parametrize('max_norm', [-1., 1., 1e6])
+def test_multi_global_norm(dtype, max_norm):
+    shapes = [(3, 4), (7,), (2, 3, 5)]
+    arrays = [np.random.uniform(-1, 1, shape).astype(dtype) for shape in shapes]
+    scale = 0.5
+    norm, rescale = mx.nd.multi_global_norm(*[mx.nd.array(a, dtype=dtype) for a in arrays],
+                                            num_arrays=len(arrays), scale=scale,
+                                            max_norm=max_norm)
+    ref_norm = np.sqrt(sum(((a.astype('float32') * scale) ** 2).sum() for a in arrays))
+    ref_rescale = scale * min(1., max_norm / (ref_norm + 1e-8)) if max_norm > 0 else scale
+    assert_almost_equal(norm.asnumpy(), np.array([ref_norm]), rtol=1e-3, atol=1e-5)
+    assert_almost_equal(rescale.asnumpy(), np.array([ref_rescale]), rtol=1e-3, atol=1e-5)
+    # a non-finite element is the overflow of the whole group
+    arrays[1][2] = np.inf
+    norm, _ = mx.nd.multi_global_norm(*[mx.nd.array(a, dtype=dtype) for a in arrays],
+                                      num_arrays=len(arrays), scale=scale, max_norm=max_norm)
+    assert not np.isfinite(norm.asnumpy()[0])
+
+
 def test_repeat():
     def test_repeat_forward():
         ndim_max = 6 # max number of dims of the ndarray
@@ -5333,6 +5560,58 @@ def test_ctc_loss_grad():
         for label in ['first', 'last']:
             check_ctc_loss_grad(label, contrib=contrib)
 
+def test_ctc_loss_variable_lengths():
+    def ctc_nll(log_probs, labels, blank):
+        # forward variables of the labels with blanks, in log space
+        ext = [blank]
+        for l in labels:
+            ext += [l, blank]
+        S = len(ext)
+        alpha = np.full(S, -np.inf)
+        alpha[0] = log_probs[0, blank]
+        if S > 1:
+            alpha[1] = log_probs[0, ext[1]]
+        for t in range(1, log_probs.shape[0]):
+            prev = alpha.copy()
+            for s in range(S):
+                terms = [prev[s]]
+                if s >= 1:
+                    terms.append(prev[s - 1])
+                if s >= 2 and ext[s] != blank and ext[s] != ext[s - 2]:
+                    terms.append(prev[s - 2])
+                alpha[s] = np.logaddexp.reduce(terms) + log_probs[t, ext[s]]
+        return -np.logaddexp.reduce(alpha[-2:] if S > 1 else alpha[-1:])
+
+    rng = np.random.RandomState(0)
+    seq_len, batch_size, alphabet_size = 60, 7, 12
+    data = rng.normal(0, 2, size=(seq_len, batch_size, alphabet_size)).astype(np.float32)
+    data_lengths = rng.randint(20, seq_len + 1, size=batch_size)
+    data_lengths[0] = seq_len
+    label_lengths = rng.randint(1, 12, size=batch_size)
+    labels = np.zeros((batch_size, 11), dtype=np.int32)
+    for b in range(batch_size):
+        seq = rng.randint(1, alphabet_size, size=label_lengths[b])
+        seq[1::3] = seq[0::3][:len(seq[1::3])]  # some labels repeat the one before them
+        labels[b, :label_lengths[b]] = seq
+    log_probs = data - np.log(np.exp(data).sum(axis=2, keepdims=True))
+    expected = np.array([ctc_nll(log_probs[:data_lengths[b], b], labels[b, :label_lengths[b]], 0)
+                         for b in range(batch_size)], dtype=np.float32)
+
+    with default_device():
+        x = mx.nd.array(data)
+        x.attach_grad()
+        with mx.autograd.record():
+            loss = mx.nd.ctc_loss(x, mx.nd.array(labels), mx.nd.array(data_lengths),
+                                  mx.nd.array(label_lengths), use_data_lengths=True,
+                                  use_label_lengths=True, blank_label='first')
+        loss.backward()
+    assert_almost_equal(loss, expected, rtol=1e-4, atol=1e-4)
+    grad = x.grad.asnumpy()
+    # the gradient w.r.t. the activations of each frame sums to zero, and is zero past the data
+    assert_almost_equal(grad.sum(axis=2), np.zeros((seq_len, batch_size)), atol=1e-4)
+    for b in range(batch_size):
+        assert np.all(grad[data_lengths[b]:, b] == 0)
+
 def test_quantization_op():
     min0 = mx.nd.array([0.0])
     max0 = mx.nd.array([1.0])
@@ -5729,6 +6008,38 @@ def test_custom_op_fork():
         assert not p.is_alive() and p.exitcode == 0
 
 
+def test_custom_op_run_on_engine():
+    class ScaleOP(mx.operator.CustomOp):
+        def forward(self, is_train, req, in_data, out_data, aux):
+            self.assign(out_data[0], req[0], in_data[0] * 2)
+        def backward(self, req, out_grad, in_data, out_data, in_grad, aux):
+            self.assign(in_grad[0], req[0], out_grad[0] * 2)
+
+    @mx.operator.register("ScaleOnEngineOP")
+    class ScaleOPProp(mx.operator.CustomOpProp):
+        def __init__(self):
+            super(ScaleOPProp, self).__init__(need_top_grad=True, run_on_engine=True)
+        def list_arguments(self):
+            return ['data']
+        def list_outputs(self):
+            return ['output']
+        def infer_shape(self, in_shape):
+            return in_shape, [in_shape[0]]
+        def create_operator(self, ctx, shapes, dtypes):
+            return ScaleOP()
+
+    x = mx.nd.array(np.random.uniform(size=(3, 4)))
+    x.attach_grad()
+    with mx.autograd.record():
+        # chained calls run while earlier ones are still pending on the engine
+        y = x
+        for _ in range(5):
+            y = mx.nd.Custom(y, op_type='ScaleOnEngineOP')
+    y.backward()
+    assert_almost_equal(y, x.asnumpy() * 32)
+    assert_almost_equal(x.grad, np.full((3, 4), 32))
+
+
 def _build_dot_custom(fun_forward, name):
     class Dot(mx.operator.CustomOp):
         def __init__(self):
@@ -6636,6 +6947,53 @@ def test_laop_6():
     check_fw(test_logabsdet, [a], [r2])
     check_grad(test_logabsdet, [a])
 
+# sizes around the limit of the small matrix kernels of the batched operators
+@pytest.mark.parametrize('n', [1, 3, 16, 17])
+@pytest.mark.parametrize('lower', [True, False])
+def test_laop_small_batch(n, lower):
+    dtype = np.float64
+    batch = 50
+    g = np.random.uniform(-1, 1, size=(batch, n, n))
+    a = np.matmul(g, np.swapaxes(g, 1, 2)) + n * np.eye(n)
+    l = np.linalg.cholesky(a)
+    factor = l if lower else np.swapaxes(l, 1, 2)
+    ia = np.linalg.inv(a)
+
+    # test potrf and potri
+    out = mx.nd.linalg.potrf(mx.nd.array(a, dtype=dtype), lower=lower).asnumpy()
+    assert_almost_equal(out, factor, rtol=1e-7, atol=1e-9)
+    out = mx.nd.linalg.potri(mx.nd.array(factor, dtype=dtype), lower=lower).asnumpy()
+    assert_almost_equal(out, ia, rtol=1e-7, atol=1e-9)
+
+    # test trsm on both sides of the matrices, transposed or not
+    b = np.random.uniform(-1, 1, size=(batch, n, 4))
+    for transpose in [False, True]:
+        op = np.swapaxes(factor, 1, 2) if transpose else factor
+        out = mx.nd.linalg.trsm(mx.nd.array(factor, dtype=dtype), mx.nd.array(b, dtype=dtype),
+                                transpose=transpose, rightside=False, lower=lower,
+                                alpha=2.).asnumpy()
+        assert_almost_equal(out, 2 * np.linalg.solve(op, b), rtol=1e-7, atol=1e-9)
+        bt = np.swapaxes(b, 1, 2)
+        out = mx.nd.linalg.trsm(mx.nd.array(factor, dtype=dtype), mx.nd.array(bt, dtype=dtype),
+                                transpose=transpose, rightside=True, lower=lower,
+                                alpha=2.).asnumpy()
+        assert_almost_equal(out, 2 * np.matmul(bt, np.linalg.inv(op)), rtol=1e-7, atol=1e-9)
+
+    # test inverse, det and slogdet of matrices needing row interchanges
+    out = mx.nd.linalg.inverse(mx.nd.array(g, dtype=dtype)).asnumpy()
+    assert_almost_equal(out, np.linalg.inv(g), rtol=1e-5, atol=1e-7)
+    out = mx.nd.linalg.det(mx.nd.array(g, dtype=dtype)).asnumpy()
+    assert_almost_equal(out, np.linalg.det(g), rtol=1e-7, atol=1e-9)
+    sign, logabsdet = mx.nd.linalg.slogdet(mx.nd.array(g, dtype=dtype))
+    ref_sign, ref_logabsdet = np.linalg.slogdet(g)
+    assert_almost_equal(sign.asnumpy(), ref_sign)
+    assert_almost_equal(logabsdet.asnumpy(), ref_logabsdet, rtol=1e-7, atol=1e-9)
+
+    # test the gradient of det through the inverse of the factorization
+    data = mx.symbol.Variable('data')
+    check_numeric_gradient(mx.sym.linalg.det(data), [g[:3]], numeric_eps=1e-6,
+                           rtol=1e-4, atol=1e-6, dtype=dtype)
+
 def test_stack():
     for _ in range(100):
         ndim = random.randint(1, 5)
@@ -6773,6 +7131,17 @@ def test_dropout():
         b.backward()
         assert_almost_equal(a.grad.asnumpy(), mx.nd.ones_like(b).asnumpy())
 
+    def check_dropout_grad(ratio, shape, dtype, cudnn_off=True):
+        # the gradient follows the kept elements, also for a size which is not a multiple of 8
+        a = mx.random.uniform(low=1, high=2, shape=shape, dtype=dtype)
+        a.attach_grad()
+        ograd = mx.random.uniform(shape=shape, dtype=dtype)
+        with mx.autograd.record():
+            b = mx.nd.Dropout(a, p=ratio, cudnn_off=cudnn_off)
+        b.backward(ograd)
+        kept = (b.asnumpy() != 0).astype(dtype)
+        assert_almost_equal(a.grad.asnumpy(), ograd.asnumpy() * kept / (1 - ratio))
+
     shape = (100, 100)
     check_dropout_ratio(0.5, shape)
     check_dropout_ratio(0.0, shape)
@@ -6792,6 +7161,10 @@ def test_dropout():
     check_passthrough(0.0, shape, cudnn_off=False)
     check_passthrough(1.0, shape, cudnn_off=False)
 
+    for dtype in ['float16', 'float32', 'float64']:
+        check_dropout_grad(0.5, (7, 13), dtype)
+        check_dropout_grad(0.25, (3, 1001), dtype, cudnn_off=False)
+
     nshape = (10, 10, 10, 10)
     with mx.autograd.train_mode():
         check_dropout_axes(0.25, nshape, axes = (0,))
@@ -7357,6 +7730,52 @@ def test_adaptive_avg_pool_op():
         for j in range(1, 11):
             check_adaptive_avg_pool_op(shape, i, j)
 
+@pytest.mark.parametrize('output_size', [(1, 1), (2, 5), (5, 2), (3, 4)])
+def test_adaptive_avg_pool_grad(output_size):
+    # the sizes dividing the input are computed as regular average pooling
+    x = mx.nd.random.uniform(shape=(2, 3, 10, 8))
+    x.attach_grad()
+    with mx.autograd.record():
+        y = mx.nd.contrib.AdaptiveAvgPooling2D(x, output_size=output_size)
+    dy = mx.nd.random.uniform(shape=y.shape)
+    y.backward(dy)
+    dx = np.zeros(x.shape)
+    for oh in range(output_size[0]):
+        h0, h1 = (oh * 10) // output_size[0], -((-(oh + 1) * 10) // output_size[0])
+        for ow in range(output_size[1]):
+            w0, w1 = (ow * 8) // output_size[1], -((-(ow + 1) * 8) // output_size[1])
+            dx[:, :, h0:h1, w0:w1] += \
+                dy.asnumpy()[:, :, oh:oh + 1, ow:ow + 1] / ((h1 - h0) * (w1 - w0))
+    assert_almost_equal(x.grad.asnumpy(), dx, rtol=1e-5, atol=1e-6)
+
+@pytest.mark.parametrize('layout', ['NCHW', 'NHWC'])
+@pytest.mark.parametrize('pool_type', ['max', 'avg', 'sum', 'lp'])
+@pytest.mark.parametrize('channels', [3, 70])
+def test_global_pooling_layouts(layout, pool_type, channels):
+    shape = (2, channels, 5, 6) if layout == 'NCHW' else (2, 5, 6, channels)
+    axes = (2, 3) if layout == 'NCHW' else (1, 2)
+    x = mx.nd.random.uniform(0.1, 1, shape=shape)
+    x.attach_grad()
+    with mx.autograd.record():
+        y = mx.nd.Pooling(x, kernel=(5, 6), global_pool=True, pool_type=pool_type,
+                          p_value=2, layout=layout)
+    xn = x.asnumpy()
+    if pool_type == 'max':
+        expected = xn.max(axis=axes, keepdims=True)
+    elif pool_type == 'avg':
+        expected = xn.mean(axis=axes, keepdims=True)
+    elif pool_type == 'sum':
+        expected = xn.sum(axis=axes, keepdims=True)
+    else:
+        expected = np.sqrt((xn * xn).sum(axis=axes, keepdims=True))
+    assert_almost_equal(y.asnumpy(), expected, rtol=1e-5, atol=1e-6)
+    if pool_type in ['avg', 'sum']:
+        dy = mx.nd.random.uniform(shape=y.shape)
+        y.backward(dy)
+        scale = 1.0 / 30 if pool_type == 'avg' else 1.0
+        assert_almost_equal(x.grad.asnumpy(), np.broadcast_to(dy.asnumpy() * scale, shape),
+                            rtol=1e-5, atol=1e-6)
+
 def test_bilinear_resize_op():
     def py_bilinear_resize(x, outputHeight, outputWidth):
         batch, channel, inputHeight, inputWidth = x.shape
@@ -7546,6 +7965,38 @@ def test_bilinear_resize_op():
     check_bilinear_resize_modes_op(shape_1, shape_1=shape_0, mode='like')
     check_bilinear_resize_align_corners_op()
 
+@pytest.mark.parametrize('dtype', ['float32', 'float16'])
+@pytest.mark.parametrize('channels', [1, 3, 8])
+@pytest.mark.parametrize('align_corners', [True, False])
+@pytest.mark.parametrize('out_size', [(5, 5), (13, 17), (20, 24)])
+def test_bilinear_resize_nhwc(dtype, channels, align_corners, out_size):
+    height, width = out_size
+    x = mx.nd.random.uniform(shape=(2, channels, 10, 12), dtype=dtype)
+    x_nhwc = x.transpose((0, 2, 3, 1))
+    out_grad = mx.nd.random.uniform(shape=(2, channels, height, width), dtype=dtype)
+    x.attach_grad()
+    x_nhwc.attach_grad()
+    with mx.autograd.record():
+        y = mx.nd.contrib.BilinearResize2D(x, height=height, width=width,
+                                           align_corners=align_corners)
+        y_nhwc = mx.nd.contrib.BilinearResize2D(x_nhwc, height=height, width=width,
+                                                align_corners=align_corners, layout='NHWC')
+    y.backward(out_grad)
+    y_nhwc.backward(out_grad.transpose((0, 2, 3, 1)))
+    assert y_nhwc.shape == (2, height, width, channels)
+    rtol, atol = (1e-3, 1e-3) if dtype == 'float16' else (1e-5, 1e-6)
+    assert_almost_equal(y_nhwc.transpose((0, 3, 1, 2)), y, rtol=rtol, atol=atol)
+    assert_almost_equal(x_nhwc.grad.transpose((0, 3, 1, 2)), x.grad, rtol=rtol, atol=atol)
+    # the gradient accumulates in float32 whatever the type of the data
+    data32 = x.astype('float32')
+    data32.attach_grad()
+    with mx.autograd.record():
+        y32 = mx.nd.contrib.BilinearResize2D(data32, height=height, width=width,
+                                             align_corners=align_corners)
+    y32.backward(out_grad.astype('float32'))
+    assert_almost_equal(x.grad.astype('float32'), data32.grad, rtol=rtol, atol=atol)
+
+
 def test_multi_proposal_op():
     # paramters
     feature_stride = 16
@@ -8442,6 +8893,42 @@ def test_softmax_cross_entropy():
     check_symbolic_forward(sym, {'data' : np_data, 'label' : np_label}, [np.array([f_sm_ce(np_sm, np_one_hot_label)])], rtol=1e-3, atol=1e-5)
 
 
+@pytest.mark.parametrize('no_bias', [False, True])
+def test_linear_cross_entropy(no_bias):
+    rng = np.random.RandomState(0)
+    batch_size, seq_len, hidden, num_classes = 3, 4, 16, 53
+    x = rng.normal(size=(batch_size, seq_len, hidden)).astype(np.float32)
+    w = rng.normal(size=(num_classes, hidden)).astype(np.float32)
+    b = rng.normal(size=(num_classes,)).astype(np.float32)
+    label = rng.randint(0, num_classes, size=(batch_size, seq_len))
+    label[1, 2] = -1
+    ograd = rng.uniform(0.5, 1.5, size=(batch_size, seq_len)).astype(np.float32)
+
+    logits = np.dot(x, w.T) + (0 if no_bias else b)
+    logits -= logits.max(axis=-1, keepdims=True)
+    log_probs = logits - np.log(np.exp(logits).sum(axis=-1, keepdims=True))
+    keep = label != -1
+    one_hot = np.eye(num_classes)[np.where(keep, label, 0)]
+    expected = np.where(keep, -(log_probs * one_hot).sum(axis=-1), 0)
+    dlogits = (np.exp(log_probs) - one_hot) * (ograd * keep)[..., None]
+
+    # a chunk that does not divide the vocabulary, and one that holds all of it
+    for chunk_size in [7, 4096]:
+        args = [mx.nd.array(x), mx.nd.array(w)] + ([] if no_bias else [mx.nd.array(b)])
+        for arg in args:
+            arg.attach_grad()
+        with mx.autograd.record():
+            loss = mx.nd.linear_cross_entropy(*(args + [mx.nd.array(label)]), no_bias=no_bias,
+                                              chunk_size=chunk_size)
+        loss.backward(mx.nd.array(ograd))
+        assert_almost_equal(loss, expected, rtol=1e-4, atol=1e-4)
+        assert_almost_equal(args[0].grad, np.dot(dlogits, w), rtol=1e-4, atol=1e-4)
+        assert_almost_equal(args[1].grad, np.einsum('bsv,bsh->vh', dlogits, x),
+                            rtol=1e-4, atol=1e-4)
+        if not no_bias:
+            assert_almost_equal(args[2].grad, dlogits.sum(axis=(0, 1)), rtol=1e-4, atol=1e-4)
+
+
 def test_split_v2():
     dim = random.randint(2, 6)
     shape = rand_shape_nd(dim)
@@ -8792,6 +9279,20 @@ def test_add_n():
     assert_almost_equal(rslt.asnumpy(), add_n_rslt.asnumpy(), atol=1e-5)
 
 
+@pytest.mark.parametrize('dtype', ['float32', 'float16', 'int32'])
+@pytest.mark.parametrize('num_inputs', [1, 7, 32, 40, 70])
+def test_add_n_many_inputs(dtype, num_inputs):
+    # more inputs than a pass of the kernel and more elements than a block of the accumulation
+    shape = (3, 7001)
+    data_np = [np.random.randint(-8, 8, size=shape).astype(dtype) for _ in range(num_inputs)]
+    data = [mx.nd.array(d, dtype=dtype) for d in data_np]
+    expected = np.sum(np.stack(data_np).astype(np.float64), axis=0)
+    assert_almost_equal(mx.nd.add_n(*data).asnumpy(), expected.astype(dtype))
+    # the output is one of the inputs
+    out = mx.nd.add_n(*data, out=data[-1])
+    assert_almost_equal(out.asnumpy(), expected.astype(dtype))
+
+
 def test_get_all_registered_operators():
     ops = get_all_registered_operators()
     assert isinstance(ops, list)
@@ -9053,6 +9554,55 @@ def test_multihead_attention_selfatt():
     for dtype in dtypes:
         check_multihead_attention_selfatt(dtype=dtype)
 
+
+@pytest.mark.parametrize('num_heads,kv_heads', [(4, 2), (3, 1), (2, 2)])
+def test_multihead_attention_selfatt_grouped(num_heads, kv_heads):
+    qkv_length = 7  # length of a sequence
+    batch_size = 2
+    head_dim = 5
+    group_size = num_heads // kv_heads
+    qkv_dim = kv_heads * (group_size + 2) * head_dim
+
+    def to_batches(proj):
+        # (seq_length, batch_size, heads, head_dim) -> (batch_size * heads, seq_length, head_dim)
+        proj = mx.nd.transpose(proj, axes=(1, 2, 0, 3))
+        return mx.nd.reshape(proj, shape=(-1, 0, 0), reverse=True)
+
+    def grouped(qkv):
+        att = mx.nd.contrib.interleaved_matmul_selfatt_qk(qkv, heads=num_heads, kv_heads=kv_heads)
+        out = mx.nd.contrib.interleaved_matmul_selfatt_valatt(
+            qkv, mx.nd.softmax(att, axis=-1), heads=num_heads, kv_heads=kv_heads)
+        return att, out
+
+    def repeated(qkv):
+        # each group holds its queries followed by its key and its value
+        tmp = mx.nd.reshape(qkv, shape=(0, 0, kv_heads, group_size + 2, -1))
+        q = mx.nd.slice_axis(tmp, axis=3, begin=0, end=group_size)
+        k = mx.nd.slice_axis(tmp, axis=3, begin=group_size, end=group_size + 1)
+        v = mx.nd.slice_axis(tmp, axis=3, begin=group_size + 1, end=group_size + 2)
+        q = to_batches(mx.nd.reshape(q, shape=(0, 0, -3, 0)))
+        k = to_batches(mx.nd.repeat(mx.nd.reshape(k, shape=(0, 0, -3, 0)), group_size, axis=2))
+        v = to_batches(mx.nd.repeat(mx.nd.reshape(v, shape=(0, 0, -3, 0)), group_size, axis=2))
+        att = mx.nd.batch_dot(mx.nd.contrib.div_sqrt_dim(q), k, transpose_b=True)
+        out = mx.nd.batch_dot(mx.nd.softmax(att, axis=-1), v)
+        out = mx.nd.reshape(out, shape=(-1, num_heads, 0, 0), reverse=True)
+        out = mx.nd.transpose(out, axes=(2, 0, 1, 3))
+        return att, mx.nd.reshape(out, shape=(0, 0, -1))
+
+    qkv = mx.nd.random.uniform(shape=(qkv_length, batch_size, qkv_dim))
+    att_grad = mx.nd.random.uniform(shape=(batch_size * num_heads, qkv_length, qkv_length))
+    out_grad = mx.nd.random.uniform(shape=(qkv_length, batch_size, num_heads * head_dim))
+    results = []
+    for fn in [grouped, repeated]:
+        x = qkv.copy()
+        x.attach_grad()
+        with mx.autograd.record():
+            att, out = fn(x)
+        mx.autograd.backward([att, out], [att_grad, out_grad])
+        results.append((att.asnumpy(), out.asnumpy(), x.grad.asnumpy()))
+    for opti, orig in zip(*results):
+        assert_allclose(opti, orig, rtol=1e-4, atol=1e-5)
+
 def check_multihead_attention_encdec(dtype):
     def convert_weight(F, k_weight, v_weight, num_heads):
         k_weight = F.reshape(k_weight, shape=(num_heads, -1, 0), reverse=True)
@@ -9472,6 +10022,30 @@ def test_broadcast_ops_on_misaligned_input_oneside(dtype, lead_dim, both_ways):
     mx.nd.waitall()
     assert_almost_equal(f, expected)
 
+@pytest.mark.parametrize('dtype', ['float32', 'float64', 'int32'])
+@pytest.mark.parametrize('shape,small_shape', [
+    ((7, 33), (1,)),           # scalar-like
+    ((5, 4, 33), (4, 33)),     # row vector
+    ((5, 4, 33), (5, 4, 1)),   # column vector
+    ((3, 1000), (3, 1)),       # column vector with long rows
+    ((4, 1, 6), (1, 5, 1)),    # neither
+])
+@pytest.mark.parametrize('swap', [False, True])
+def test_broadcast_ops_patterns(dtype, shape, small_shape, swap):
+    a = np.random.randint(-10, 10, size=shape).astype(dtype)
+    b = np.random.randint(1, 10, size=small_shape).astype(dtype)
+    if swap:
+        a, b = b, a
+    am = mx.nd.array(a, dtype=dtype)
+    bm = mx.nd.array(b, dtype=dtype)
+    assert_almost_equal(mx.nd.broadcast_sub(am, bm), a - b)
+    assert_almost_equal(mx.nd.broadcast_mul(am, bm), a * b)
+    assert_almost_equal(mx.nd.broadcast_maximum(am, bm), np.maximum(a, b))
+    if dtype != 'float64':
+        # mixed types
+        cm = am.as_np_ndarray() - bm.as_np_ndarray().astype('float64')
+        assert_almost_equal(cm, a.astype('float64') - b.astype('float64'))
+
 
 def test_sldwin_selfatten_operators():
     def gen_sliding_window_mask_full(batch_size, num_heads, seq_length, w, symmetric, d):
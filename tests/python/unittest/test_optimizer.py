@@ -923,6 +923,55 @@ def test_adamW():
                               opt2(use_fused_step=True, **kwarg), shapes, dtype,
                               rtol=1e-3, atol=2e-3)
 
+@pytest.mark.parametrize('opt_kwargs', [{'optimizer': 'sgd', 'momentum': 0.9, 'wd': 0.01},
+                                        {'optimizer': 'sgd', 'clip_gradient': 0.5},
+                                        {'optimizer': 'adamW', 'wd': 0.01}])
+@pytest.mark.parametrize('rounding', ['multi_precision', 'stochastic_rounding'])
+@pytest.mark.parametrize('fp32_grads', [False, True])
+def test_bf16_fused_update(opt_kwargs, rounding, fp32_grads):
+    from mxnet.amp.amp import bfloat16
+    grad_dtype = np.float32 if fp32_grads else bfloat16
+    opt_kwargs = dict(opt_kwargs)
+    name = opt_kwargs.pop('optimizer')
+    shapes = [(33,), (4, 20)]
+    opt = mx.optimizer.create(name, learning_rate=0.05, aggregate_num=4,
+                              **{rounding: True}, **opt_kwargs)
+    ref_opt = mx.optimizer.create(name, learning_rate=0.05, use_fused_step=False, **opt_kwargs)
+    updater = mx.optimizer.get_updater(opt)
+    ref_updater = mx.optimizer.get_updater(ref_opt)
+    weights = [mx.nd.random.uniform(-1, 1, shape).astype(bfloat16) for shape in shapes]
+    ref_weights = [w.astype('float32') for w in weights]
+    for _ in range(3):
+        grads = [mx.nd.random.uniform(-1, 1, shape).astype(bfloat16) for shape in shapes]
+        updater(list(range(len(shapes))), [g.astype(grad_dtype) for g in grads], weights)
+        ref_updater(list(range(len(shapes))), [g.astype('float32') for g in grads],
+                    ref_weights)
+    for i, (w, ref_w) in enumerate(zip(weights, ref_weights)):
+        assert w.dtype == bfloat16
+        assert_almost_equal(w.astype('float32'), ref_w, rtol=2e-2, atol=2e-2)
+        if rounding == 'multi_precision':
+            # the master copy follows the float32 update and is rounded to nearest into the
+            # weight, within half the relative spacing 2^-7 of the bfloat16 values
+            weight32 = updater.states[i][0]
+            assert_almost_equal(weight32, ref_w, rtol=1e-5, atol=1e-6)
+            assert_almost_equal(w.astype('float32'), weight32, rtol=2**-8, atol=1e-30)
+        else:
+            assert updater.states[i][0] is None
+
+
+def test_bf16_stochastic_rounding_unbiased():
+    from mxnet.amp.amp import bfloat16
+    # updates of 1e-3 are below half the spacing 2^-7 of the bfloat16 values around 1, so
+    # that rounding them to nearest would leave the weights at 1
+    opt = mx.optimizer.SGD(learning_rate=1e-3, stochastic_rounding=True)
+    updater = mx.optimizer.get_updater(opt)
+    weight = mx.nd.ones((4096,)).astype(bfloat16)
+    grad = mx.nd.ones((4096,)).astype(bfloat16)
+    for _ in range(100):
+        updater(0, grad, weight)
+    assert abs(weight.astype('float32').mean().asscalar() - 0.9) < 0.01
+
+
 def test_adabelief():
     opt1 = mx.optimizer.AdaBelief
     opt2 = mx.optimizer.AdaBelief
@@ -281,6 +281,186 @@ def test_aggregate_stats_sorting():
     profiler.set_state('stop')
 
 
+def test_aggregate_stats_op_cost():
+    file_name = 'test_aggregate_stats_op_cost.json'
+    enable_profiler(file_name, run=True, continuous_dump=False, aggregate_stats=True)
+    profiler.dumps(reset=True)
+    a = mx.nd.ones((256, 128))
+    w = mx.nd.ones((128, 128))
+    b = mx.nd.dot(a, a, transpose_b=True)
+    c = mx.nd.FullyConnected(a, w, num_hidden=128, no_bias=True)
+    d = mx.nd.relu(c)
+    mx.nd.waitall()
+    profiler.set_state('stop')
+    target_dict = json.loads(profiler.dumps(format='json', reset=True))
+    ops = target_dict['Time']['operator']
+    for name in ['dot', 'FullyConnected', 'relu']:
+        assert ops[name]['GFLOPS'] > 0
+        assert ops[name]['GBPS'] > 0
+    assert target_dict['Unit']['GFLOPS'] == 'GFLOP/s'
+
+
+def test_aggregate_stats_hw_counters():
+    file_name = 'test_aggregate_stats_hw_counters.json'
+    profiler.set_config(profile_imperative=True, aggregate_stats=True, profile_hw_counters=True,
+                        filename=file_name, continuous_dump=False)
+    profiler.set_state('run')
+    profiler.dumps(reset=True)
+    a = mx.nd.ones((256, 256))
+    b = mx.nd.dot(a, a)
+    c = mx.nd.relu(b)
+    mx.nd.waitall()
+    profiler.set_state('stop')
+    table = profiler.dumps()
+    target_dict = json.loads(profiler.dumps(format='json', reset=True))
+    # restore the default config for the other tests
+    profiler.set_config(profile_hw_counters=False, aggregate_stats=False, filename='profile.json')
+    ops = target_dict['Time']['operator']
+    assert 'dot' in ops and 'relu' in ops
+    # the counters are only there if perf_event is permitted, so only their rates are checked
+    if 'IPC' in ops['dot']:
+        assert 'IPC' in table
+        assert ops['dot']['IPC'] > 0
+    assert target_dict['Unit']['Occupancy'] == '%'
+
+
+def test_memory_timeline():
+    file_name = 'test_memory_timeline.json'
+    profiler.set_config(profile_imperative=True, profile_memory=True,
+                        filename=file_name, continuous_dump=False)
+    profiler.set_state('run')
+    profiler.memory_peak_snapshot(reset=True)
+    a = mx.nd.ones((1024, 1024))
+    b = mx.nd.relu(a)
+    mx.nd.waitall()
+    snapshot = profiler.memory_peak_snapshot()
+    profiler.set_state('stop')
+    assert snapshot['Unit']['Bytes'] == 'bytes'
+    holders = [h for device in snapshot['Peak'].values() for h in device['Holders']]
+    relu = [h for h in holders if h['Operator'] == 'relu']
+    assert relu and relu[0]['Kind'] == 'dynamic'
+    assert relu[0]['Bytes'] >= 1024 * 1024 * 4
+    for device in snapshot['Peak'].values():
+        assert device['Bytes'] >= sum(h['Bytes'] for h in device['Holders'])
+    profiler.dump(True)
+
+
+def test_request_trace():
+    net = nn.Dense(16, in_units=8)
+    net.initialize()
+    net.hybridize()
+    x = mx.np.ones((4, 8))
+    net(x).wait_to_read()
+    profiler.request_traces(reset=True)
+    trace_id = '0af7651916cd43dd8448eb211c80319c'
+    with profiler.request_trace('predict', trace_id=trace_id) as traced_id:
+        net(x).wait_to_read()
+    assert traced_id == trace_id
+    # outside of a request nothing is traced
+    net(x).wait_to_read()
+    traces = profiler.request_traces(reset=True)
+    spans = traces['resourceSpans'][0]['scopeSpans'][0]['spans']
+    assert all(span['traceId'] == trace_id for span in spans)
+    root = [span for span in spans if span['name'] == 'predict']
+    assert len(root) == 1 and root[0]['parentSpanId'] == ''
+    forward = [span for span in spans if span['name'] == 'CachedOp::Forward']
+    assert len(forward) == 1 and forward[0]['parentSpanId'] == root[0]['spanId']
+    ops = [span for span in spans
+           if any(attr['key'] == 'mxnet.device' for attr in span['attributes'])]
+    assert ops
+    span_ids = {span['spanId'] for span in spans}
+    assert all(span['parentSpanId'] in span_ids for span in ops)
+    attrs = {attr['key']: int(attr['value']['intValue']) for attr in root[0]['attributes']}
+    assert attrs['mxnet.operators'] == len(ops)
+    assert attrs['mxnet.compute_ns'] > 0
+    assert not profiler.request_traces()['resourceSpans'][0]['scopeSpans'][0]['spans']
+
+
+def test_profile_dependencies():
+    import sys
+    sys.path.insert(0, os.path.join(os.path.dirname(__file__), '../../../tools/profile'))
+    import critical_path
+
+    file_name = 'test_profile_dependencies.json'
+    profiler.set_config(profile_imperative=True, profile_dependencies=True,
+                        filename=file_name, continuous_dump=False)
+    profiler.set_state('run')
+    a = mx.nd.ones((64, 64))
+    b = mx.nd.dot(a, a)
+    c = mx.nd.relu(b)
+    c.wait_to_read()
+    profiler.set_state('stop')
+    profiler.dump(True)
+    # restore the default config for the other tests
+    profiler.set_config(profile_dependencies=False, filename='profile.json')
+
+    events = critical_path.load_trace(file_name)
+    ops, _ = critical_path.parse_ops(events)
+    by_name = {op.name: op for op in ops}
+    assert 'dot' in by_name and 'relu' in by_name
+    # relu reads the version of b that dot wrote
+    assert set(by_name['dot'].writes) & set(by_name['relu'].reads)
+    result = critical_path.analyze(events)
+    assert result['has_dependencies']
+    assert result['critical_path']
+    assert result['potential_speedup'] >= 1.0
+
+
+def test_sampled_stats():
+    profiler.sampled_stats(reset=True)
+    profiler.set_sample_rate(1)
+    try:
+        inp = mx.nd.zeros(shape=(100, 100))
+        for _ in range(20):
+            inp = mx.nd.sqrt(inp + 1)
+        mx.nd.waitall()
+        stats = profiler.sampled_stats(reset=True)
+    finally:
+        profiler.set_sample_rate(0)
+    assert stats['Sample Rate'] == 1
+    ops = stats['Time']['operator']
+    assert 'sqrt' in ops and '_plus_scalar' in ops
+    for name in ['sqrt', '_plus_scalar']:
+        op = ops[name]
+        assert op['Count'] == 20
+        assert op['Min'] <= op['P50'] <= op['P90'] <= op['P99'] <= op['Max']
+    assert profiler.sampled_stats()['Time']['operator'] == {}
+
+
+def test_metrics():
+    def samples(text):
+        values = {}
+        for line in text.splitlines():
+            if not line.startswith('#'):
+                name, value = line.rsplit(' ', 1)
+                values[name] = float(value)
+        return values
+
+    kv = mx.kv.create('local')
+    kv.init(3, mx.nd.zeros((10, 10)))
+    before = samples(profiler.metrics())
+    kv.push(3, mx.nd.ones((10, 10)))
+    kv.pull(3, out=mx.nd.zeros((10, 10)))
+    mx.nd.waitall()
+    text = profiler.metrics()
+    assert text.endswith('# EOF\n')
+    after = samples(text)
+    assert after['mxnet_engine_pending_ops'] >= 0
+    assert any(name.startswith('mxnet_storage_used_bytes{') for name in after)
+    for direction in ['push', 'pull']:
+        series = 'mxnet_kvstore_bytes_total{store="local",direction="%s",group="0-15"}' % direction
+        assert after[series] - before.get(series, 0) == 400
+
+    server = profiler.start_metrics_server(0, '127.0.0.1')
+    try:
+        from urllib.request import urlopen
+        with urlopen('http://127.0.0.1:%d/metrics' % server.server_address[1]) as response:
+            assert response.read().decode('utf-8').endswith('# EOF\n')
+    finally:
+        server.shutdown()
+        server.server_close()
+
+
 @pytest.mark.skip(reason='https://github.com/apache/incubator-mxnet/issues/18564')
 def test_aggregate_duplication():
     file_name = 'test_aggregate_duplication.json'
@@ -597,6 +597,30 @@ def test_sample_categorical(dtype, x):
             real_dx[int(y[i][j])] += 5.0 / rprob[j]
         assert_almost_equal(real_dx, dx[i, :], rtol=1e-4, atol=1e-5)
 
+@pytest.mark.parametrize('dtype', ['int32', 'int64'])
+@pytest.mark.serial
+def test_sample_alias(dtype):
+    x = np.array([[0, 1, 2, 3, 4], [4, 3, 2, 1, 0], [1, 1, 1, 1, 1]], dtype='float32')
+    prob, alias = mx.nd._internal._sample_alias_table(mx.nd.array(x))
+    prob = prob.asnumpy()
+    alias = alias.asnumpy()
+    # an outcome is drawn with its own probability and the rest of those aliasing it
+    for i in range(x.shape[0]):
+        assert np.all(prob[i] >= 0) and np.all(prob[i] <= 1)
+        mass = prob[i].copy()
+        for k in range(x.shape[1]):
+            mass[alias[i, k]] += 1 - prob[i, k]
+        assert_almost_equal(mass / x.shape[1], x[i] / x[i].sum(), atol=1e-5)
+    samples = 10000
+    y = mx.nd._internal._sample_alias(mx.nd.array(prob), mx.nd.array(alias, dtype='int32'),
+                                      shape=samples, dtype=dtype)
+    assert y.shape == (x.shape[0], samples)
+    assert np.dtype(dtype) == y.dtype
+    y = y.asnumpy()
+    for i in range(x.shape[0]):
+        freq = np.bincount(y[i], minlength=5) / np.float32(samples)
+        assert_almost_equal(freq, x[i] / x[i].sum(), rtol=0.20, atol=1e-1)
+
 # Test the generators with the chi-square testing
 @pytest.mark.serial
 def test_normal_generator():
@@ -893,20 +917,20 @@ def test_random_seed():
 
 @pytest.mark.serial
 def test_unique_zipfian_generator():
-    ctx = mx.context.current_context()
-    if ctx.device_type == 'cpu':
-        num_sampled = 8192
-        range_max = 793472
-        batch_size = 4
-        op = mx.nd._internal._sample_unique_zipfian
-        classes, num_trials = op(range_max, shape=(batch_size, num_sampled))
-        for i in range(batch_size):
-            num_trial = num_trials[i].asscalar()
-            # test uniqueness
-            assert np.unique(classes[i].asnumpy()).size == num_sampled
-            # test num trials. reference count obtained from pytorch implementation
-            assert num_trial > 14500
-            assert num_trial < 17000
+    num_sampled = 8192
+    range_max = 793472
+    batch_size = 4
+    op = mx.nd._internal._sample_unique_zipfian
+    classes, num_trials = op(range_max, shape=(batch_size, num_sampled))
+    for i in range(batch_size):
+        num_trial = num_trials[i].asscalar()
+        # test uniqueness
+        assert np.unique(classes[i].asnumpy()).size == num_sampled
+        assert classes[i].min().asscalar() >= 0
+        assert classes[i].max().asscalar() < range_max
+        # test num trials. reference count obtained from pytorch implementation
+        assert num_trial > 14500
+        assert num_trial < 17000
 
 @pytest.mark.serial
 def test_zipfian_generator():
@@ -711,6 +711,39 @@ def test_create_row_sparse():
                 assert_exception(mx.nd.sparse.row_sparse_array, ValueError, arg1, tuple(shape))
 
 
+def test_create_bsr():
+    def rand_block_sparse(num_block_rows, num_block_cols, block_shape, density):
+        mask = rnd.uniform(size=(num_block_rows, num_block_cols)) < density
+        mask = np.kron(mask, np.ones(block_shape))
+        return (rnd.uniform(1, 2, size=mask.shape) * mask).astype(np.float32)
+
+    for block_shape in [(1, 1), (2, 3), (4, 4)]:
+        for density in [0, 0.3, 1]:
+            dns = rand_block_sparse(5, 7, block_shape, density)
+            bsr = mx.nd.array(dns).tostype('bsr', block_shape=block_shape)
+            assert bsr.stype == 'bsr'
+            assert bsr.block_shape == block_shape
+            expected = spsp.bsr_matrix(dns, blocksize=block_shape)
+            expected.eliminate_zeros()
+            assert same(bsr.indptr.asnumpy(), expected.indptr)
+            assert same(bsr.indices.asnumpy(), expected.indices)
+            assert same(bsr.data.asnumpy(), expected.data)
+            assert same(bsr.asnumpy(), dns)
+            # create from the definition and from scipy
+            created = mx.nd.sparse.bsr_matrix((bsr.data, bsr.indices, bsr.indptr), shape=dns.shape)
+            assert created.block_shape == block_shape
+            assert same(created.asnumpy(), dns)
+            assert same(mx.nd.sparse.bsr_matrix(expected).asnumpy(), dns)
+            # copy keeps the block shape
+            copied = mx.nd.sparse.zeros('bsr', dns.shape)
+            bsr.copyto(copied)
+            assert copied.block_shape == block_shape
+            assert same(copied.asnumpy(), dns)
+            assert same(bsr.tostype('bsr').asnumpy(), dns)
+    # the shape must be a multiple of the block shape
+    assertRaises(mx.base.MXNetError, mx.nd.ones((5, 4)).tostype, 'bsr', block_shape=(2, 2))
+
+
 
 def test_create_sparse_nd_infer_shape():
     def check_create_csr_infer_shape(shape, density, dtype):
@@ -1243,6 +1243,12 @@ def test_cast_storage_ex():
             # test gpu block  kernel
             check_cast_storage((dim0, rnd.randint(512, 1024)), d, 'default', 'row_sparse',
                                check_numeric_grad=False)
+        # test the parallel prefix sum and the row chunks of the cpu kernels
+        check_cast_storage((20000, 3), d, 'default', 'csr', check_numeric_grad=False)
+        check_cast_storage((20000, 3), d, 'default', 'row_sparse', check_numeric_grad=False)
+        # test the vectorized zero test with a partial block
+        check_cast_storage((5, 150), d, 'default', 'csr', check_numeric_grad=False)
+        check_cast_storage((5, 150), d, 'default', 'row_sparse', check_numeric_grad=False)
 
 
 @pytest.mark.serial
@@ -1376,6 +1382,25 @@ def test_sparse_dot():
     test_sparse_dot_zero_output(rand_shape_2d(50, 200), True, 40)
 
 @pytest.mark.serial
+def test_sparse_dot_bsr():
+    def check_dot_bsr_dns(num_block_rows, num_block_cols, block_shape, num_cols, density):
+        mask = rnd.uniform(size=(num_block_rows, num_block_cols)) < density
+        lhs_np = rnd.uniform(-1, 1, size=(num_block_rows * block_shape[0],
+                                          num_block_cols * block_shape[1]))
+        lhs_np *= np.kron(mask, np.ones(block_shape))
+        rhs_np = rnd.uniform(-1, 1, size=(lhs_np.shape[1], num_cols))
+        lhs = mx.nd.array(lhs_np).tostype('bsr', block_shape=block_shape)
+        rhs = mx.nd.array(rhs_np)
+        out = mx.nd.dot(lhs, rhs)
+        assert out.stype == 'default'
+        assert_almost_equal(out.asnumpy(), np.dot(lhs_np, rhs_np), rtol=1e-3, atol=1e-4)
+
+    for block_shape in [(1, 1), (2, 2), (4, 8)]:
+        for density in [0, 0.2, 1]:
+            check_dot_bsr_dns(rnd.randint(1, 10), rnd.randint(1, 10), block_shape,
+                              rnd.randint(1, 40), density)
+
+
 def test_sparse_dot_determinism():
     def check_dot_determinism(lhs_stype, rhs_stype, lhs_density, rhs_density, transpose_a, transpose_b, forward_stype):
         lhs_row = rnd.randint(50, 100)
@@ -1790,6 +1815,28 @@ def test_sparse_embedding():
     for sparse_grad in sparse_grads:
         check_sparse_embedding(in_dim, out_dim, batch, densities, sparse_grad)
 
+def test_sparse_embedding_repeated_indices():
+    ''' test the row sparse gradient of embedding with repeated indices and a large vocabulary '''
+    in_dim, out_dim = 1000000, 4
+    for dtype in ['int32', 'int64']:
+        # frequent and rare rows, far apart in the vocabulary
+        np_data = np.random.zipf(1.5, size=(64, 50)) * 7919 % in_dim
+        data = mx.nd.array(np_data, dtype=dtype)
+        weight = mx.nd.random.uniform(shape=(in_dim, out_dim))
+        weight.attach_grad(stype='row_sparse')
+        ograd = mx.nd.random.uniform(-1, 1, shape=np_data.shape + (out_dim,))
+        with mx.autograd.record():
+            out = mx.nd.Embedding(data, weight, input_dim=in_dim, output_dim=out_dim,
+                                  sparse_grad=True)
+        out.backward(ograd)
+        grad = weight.grad
+        assert grad.stype == 'row_sparse'
+        rows = np.unique(np_data)
+        expected = np.zeros((in_dim, out_dim), dtype=np.float32)
+        np.add.at(expected, np_data.reshape(-1), ograd.asnumpy().reshape(-1, out_dim))
+        assert_almost_equal(grad.indices.asnumpy(), rows)
+        assert_almost_equal(grad.data.asnumpy(), expected[rows], rtol=1e-4, atol=1e-4)
+
 def test_sparse_broadcast_add_sub():
     def check_broadcast_add(mx_lhs, mx_rhs, np_lhs, np_rhs, dtype):
         assert_almost_equal(mx.nd.sparse.add(mx_lhs, mx_rhs).asnumpy(), np.add(np_lhs, np_rhs), atol=1e-4)
@@ -1816,25 +1863,59 @@ def test_sparse_broadcast_add_sub():
 
 def test_sparse_broadcast_mul_div():
     def check_broadcast_mul(mx_lhs, mx_rhs, np_lhs, np_rhs, dtype):
-        assert_almost_equal(mx.nd.sparse.multiply(mx_lhs, mx_rhs).asnumpy(), np.multiply(np_lhs, np_rhs), atol=1e-4)
+        out = mx.nd.sparse.multiply(mx_lhs, mx_rhs)
+        assert out.stype == mx_lhs.stype
+        assert_almost_equal(out.asnumpy(), np.multiply(np_lhs, np_rhs), atol=1e-4)
     def check_broadcast_div(mx_lhs, mx_rhs, np_lhs, np_rhs, dtype):
-        assert_almost_equal(mx.nd.sparse.divide(mx_lhs, mx_rhs).asnumpy(), np.divide(np_lhs, np_rhs), atol=1e-4)
-    stype = 'csr'
+        out = mx.nd.sparse.divide(mx_lhs, mx_rhs)
+        assert out.stype == mx_lhs.stype
+        assert_almost_equal(out.asnumpy(), np.divide(np_lhs, np_rhs), atol=1e-4)
     shape = rand_shape_2d()
     num_rows = shape[0]
     num_cols = shape[1]
-    for density in [0.1 * i for i in range(10)]:
-        mx_lhs = rand_ndarray(shape, stype, density)
-        np_lhs = mx_lhs.asnumpy()
-        mx_rhs_row_2D = rand_ndarray((1, num_cols), 'default')
-        mx_rhs_row_1D = mx_rhs_row_2D.reshape((num_cols))
-        mx_rhs_col = rand_ndarray((num_rows, 1), 'default')
-        mx_rhs_scalar_2D = rand_ndarray((1, 1), 'default')
-        mx_rhs_scalar_1D = mx_rhs_scalar_2D.reshape((1, ))
-        for mx_rhs in [mx_rhs_row_2D, mx_rhs_row_1D, mx_rhs_col, mx_rhs_scalar_2D, mx_rhs_scalar_1D]:
-            np_rhs = mx_rhs.asnumpy()
-            check_broadcast_mul(mx_lhs, mx_rhs, np_lhs, np_rhs, np.float32)
-            check_broadcast_div(mx_lhs, mx_rhs, np_lhs, np_rhs, np.float32)
+    for stype in ['csr', 'row_sparse']:
+        for density in [0.1 * i for i in range(10)]:
+            mx_lhs = rand_ndarray(shape, stype, density)
+            np_lhs = mx_lhs.asnumpy()
+            mx_rhs_row_2D = rand_ndarray((1, num_cols), 'default')
+            mx_rhs_row_1D = mx_rhs_row_2D.reshape((num_cols))
+            mx_rhs_col = rand_ndarray((num_rows, 1), 'default')
+            mx_rhs_scalar_2D = rand_ndarray((1, 1), 'default')
+            mx_rhs_scalar_1D = mx_rhs_scalar_2D.reshape((1, ))
+            for mx_rhs in [mx_rhs_row_2D, mx_rhs_row_1D, mx_rhs_col, mx_rhs_scalar_2D, mx_rhs_scalar_1D]:
+                np_rhs = mx_rhs.asnumpy()
+                check_broadcast_mul(mx_lhs, mx_rhs, np_lhs, np_rhs, np.float32)
+                check_broadcast_div(mx_lhs, mx_rhs, np_lhs, np_rhs, np.float32)
+
+def test_sparse_clip_dense_output():
+    # the zeros are clipped to a non-zero value, so the output is dense
+    shape = rand_shape_2d()
+    for stype in ['csr', 'row_sparse']:
+        for a_min, a_max in [(0.2, 0.8), (-0.8, -0.2)]:
+            for density in [0, 0.3, 1]:
+                data = rand_ndarray(shape, stype, density)
+                out = mx.nd.clip(data, a_min, a_max)
+                assert out.stype == 'default'
+                assert_almost_equal(out.asnumpy(), np.clip(data.asnumpy(), a_min, a_max))
+
+def test_storage_fallback_audit():
+    prev = mx.util.set_storage_fallback_audit(True)
+    try:
+        mx.util.storage_fallback_audit(reset=True)
+        data = rand_ndarray((4, 5), 'row_sparse', 0.5)
+        mx.nd.broadcast_add(data, mx.nd.ones((1, 5))).wait_to_read()
+        table = mx.util.storage_fallback_audit(reset=True)
+        rows = [row.split() for row in table.splitlines() if row.startswith('broadcast_add ')]
+        assert len(rows) == 1
+        # operator, conversion, device, count and bytes of the dense array
+        assert ' '.join(rows[0][1:4]) == 'row_sparse -> default'
+        assert int(rows[0][-2]) == 1
+        assert int(rows[0][-1]) == 4 * 5 * 4
+        # the operators with a kernel for the storage types are not recorded
+        mx.nd.broadcast_mul(data, mx.nd.ones((1, 5))).wait_to_read()
+        assert 'broadcast_mul' not in mx.util.storage_fallback_audit()
+    finally:
+        mx.util.set_storage_fallback_audit(prev)
 
 def test_batchnorm_fallback():
     # same test as test_operator.test_batchnorm_training, but tests fallback logic of batchnorm
@@ -1923,6 +2004,27 @@ def test_dnnl_sparse():
     almost_equal(res1, fc_res.asnumpy())
 
 @pytest.mark.serial
+def test_sparse_nd_where_rsp():
+    for shape, cond_shape in [((5, 4), (5, 4)), ((5, 4), (5,)), ((6,), (6,))]:
+        cond_np = np.random.randint(0, 2, cond_shape).astype('float32')
+        cond_np[0] = 0
+        x_np = np.random.uniform(1, 6, shape)
+        y_np = np.random.uniform(7, 11, shape)
+        grad_np = np.random.uniform(20, 30, shape)
+        mask = cond_np.reshape(cond_shape + (1,) * (len(shape) - len(cond_shape))) != 0
+        cond = mx.nd.array(cond_np).tostype('row_sparse')
+        x = mx.nd.array(x_np)
+        y = mx.nd.array(y_np)
+        x.attach_grad()
+        y.attach_grad()
+        with mx.autograd.record():
+            out = mx.nd.where(cond, x, y)
+        out.backward(mx.nd.array(grad_np))
+        assert out.stype == 'default'
+        assert_almost_equal(out.asnumpy(), np.where(mask, x_np, y_np))
+        assert_almost_equal(x.grad.asnumpy(), np.where(mask, grad_np, 0))
+        assert_almost_equal(y.grad.asnumpy(), np.where(mask, 0, grad_np))
+
 def test_sparse_nd_where():
     def get_forward_expected_output(condition, x, y):
         original_shape = x.shape
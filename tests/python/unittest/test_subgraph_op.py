@@ -17,6 +17,7 @@
 
 import os
 import sys
+import json
 import ctypes
 import mxnet as mx
 from mxnet.base import SymbolHandle, check_call, _LIB, mx_uint, c_str_array, c_str, mx_real_t
@@ -102,6 +103,17 @@ def network_structure_8():
     ret = ret1 - ret2
     return (ret, ['data'], [(1,)])
 
+def network_structure_9():
+    # in this graph, the subgraph nodes form a cycle with a ladder of external diamonds,
+    # which has exponentially many paths between them
+    data = mx.sym.Variable('data', shape=(1,))
+    ret1 = mx.sym.sin(data)
+    ret2 = ret1
+    for _ in range(20):
+        ret2 = mx.sym.cos(ret2) * mx.sym.tan(ret2)
+    ret = ret1 + ret2
+    return (ret, ['data'], [(1,)])
+
 def get_graphs():
     return [
             (network_structure_1(), ['Convolution']),
@@ -120,7 +132,8 @@ def get_graphs():
             (network_structure_6(), [mx.sym.Convolution.__name__]),
             (network_structure_6(), [mx.sym.sin.__name__, mx.sym.Convolution.__name__]),
             (network_structure_7(), ['sin', 'elemwise_add', '_plus', '_Plus']),
-            (network_structure_8(), ['sin', 'elemwise_add'])
+            (network_structure_8(), ['sin', 'elemwise_add']),
+            (network_structure_9(), ['sin', 'elemwise_add', '_plus', '_Plus'])
             ]
 
 @pytest.mark.parametrize('subgraph_backend', ['default', 'default_v2'])
@@ -526,6 +539,67 @@ def test_subgraph_backend_gluon_ext2(tmpdir):
         assert_almost_equal(mx.np.abs(outputs1[i] - outputs2[i]).sum().asnumpy(), onp.zeros(shape=(1,)))
 
 
+@pytest.mark.parametrize('flatten', [True, False])
+def test_subgraph_horizontal_fusion(flatten):
+    data = mx.sym.var('data', shape=(2, 3, 8, 8))
+    act = mx.sym.relu(data)
+    heads = [mx.sym.FullyConnected(act, num_hidden=n, flatten=flatten, name='fc%d' % i)
+             for i, n in enumerate([4, 6, 5])]
+    convs = [mx.sym.Convolution(act, kernel=(3, 3), pad=(1, 1), num_filter=n, name='conv%d' % i)
+             for i, n in enumerate([2, 3])]
+    # different kernel, not merged with the others
+    other = mx.sym.Convolution(act, kernel=(1, 1), num_filter=2, name='conv_other')
+    sym = mx.sym.Group(heads + convs + [other])
+
+    arg_shapes, _, _ = sym.infer_shape(data=(2, 3, 8, 8))
+    arg_dict = {name: mx.nd.random.uniform(-1, 1, shape)
+                for name, shape in zip(sym.list_arguments(), arg_shapes)}
+    part_sym = sym.optimize_for('horizontal_fusion')
+    assert '_horizontal_fusion_CachedOp' in part_sym.tojson()
+
+    exe1 = sym._bind(ctx=mx.current_context(), args=arg_dict, grad_req='null')
+    exe2 = part_sym._bind(ctx=mx.current_context(), args=arg_dict, grad_req='null')
+    exe1.forward()
+    exe2.forward()
+    assert len(exe1.outputs) == len(exe2.outputs)
+    for out1, out2 in zip(exe1.outputs, exe2.outputs):
+        assert out1.shape == out2.shape
+        assert_almost_equal(out1, out2, rtol=1e-5, atol=1e-6)
+
+
+@pytest.mark.parametrize('fix_gamma', [True, False])
+def test_constant_folding(fix_gamma):
+    data = mx.sym.var('data')
+    weight = mx.sym.var('weight')
+    # the weight is stored transposed, its transpose is folded
+    conv = mx.sym.Convolution(data, weight=mx.sym.transpose(weight, axes=(1, 0, 2, 3)),
+                              kernel=(3, 3), num_filter=4, no_bias=True, name='conv')
+    bn = mx.sym.BatchNorm(conv, fix_gamma=fix_gamma, eps=1e-3, name='bn')
+    fc = mx.sym.FullyConnected(mx.sym.relu(bn), num_hidden=5, name='fc')
+    sym = mx.sym.BatchNorm(fc, fix_gamma=fix_gamma, name='bn_fc')
+
+    arg_shapes, _, aux_shapes = sym.infer_shape(data=(2, 3, 6, 6), weight=(3, 4, 3, 3))
+    args = {name: mx.nd.random.uniform(-1, 1, shape)
+            for name, shape in zip(sym.list_arguments(), arg_shapes) if name != 'data'}
+    aux = {name: mx.nd.random.uniform(0.5, 1.5, shape)
+           for name, shape in zip(sym.list_auxiliary_states(), aux_shapes)}
+    x = mx.nd.random.uniform(-1, 1, (2, 3, 6, 6))
+
+    exe1 = sym._bind(ctx=mx.current_context(), args=dict(args, data=x), aux_states=aux,
+                     grad_req='null')
+    exe1.forward(is_train=False)
+
+    part_args, part_aux = dict(args), dict(aux)
+    part_sym = sym.optimize_for('ConstantFolding', part_args, part_aux)
+    ops = [node['op'] for node in json.loads(part_sym.tojson())['nodes']]
+    assert 'BatchNorm' not in ops and 'transpose' not in ops
+    assert ops.count('Convolution') == 1 and ops.count('FullyConnected') == 1
+    exe2 = part_sym._bind(ctx=mx.current_context(), args=dict(part_args, data=x),
+                          aux_states=part_aux, grad_req='null')
+    exe2.forward(is_train=False)
+    assert_almost_equal(exe1.outputs[0], exe2.outputs[0], rtol=1e-4, atol=1e-5)
+
+
 if __name__ == "__main__":
     import datetime
     tmpdir = datetime.datetime.now().strftime('mylogfile_%H_%M_%S_%f_%d_%m_%Y.log')
@@ -0,0 +1,284 @@
+#!/usr/bin/env python3
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Critical path and idle time analysis of an MXNet profiler trace.
+
+Record the trace with the variable dependencies of the operators::
+
+    mx.profiler.set_config(profile_all=True, profile_dependencies=True,
+                           filename='profile.json')
+    mx.profiler.set_state('run')
+    ...
+    mx.profiler.set_state('stop')
+    mx.profiler.dump()
+
+then run ``python critical_path.py profile.json``. The report has
+
+- the critical path: the chain of operators, each one started by the end of the previous
+  one, that ends with the last operator of the trace, for a data dependency or because it
+  waited for the worker thread,
+- the idle gaps of each device and what each one waited for: an operator on another
+  device, a copy, a kvstore operation, or the host if nothing in the trace explains it,
+- the potential speedup from overlapping: the span of the trace over the larger of the
+  busy time of the critical path and the busy time of the busiest device, which no
+  schedule of the same operators can beat.
+"""
+import argparse
+import bisect
+import collections
+import json
+
+Op = collections.namedtuple('Op', ['index', 'name', 'device', 'thread', 'start', 'end',
+                                   'reads', 'writes'])
+
+
+def load_trace(filename):
+    """Load the trace events of a profile, also one still being dumped continuously."""
+    with open(filename) as f:
+        text = f.read()
+    try:
+        return json.loads(text)['traceEvents']
+    except ValueError:
+        # a continuous dump is only closed by the last dump
+        return json.loads(text.rstrip().rstrip(',') + '\n]}')['traceEvents']
+
+
+def parse_ops(events):
+    """Pair the begin and end events of the operators of a trace.
+
+    Returns the operators ordered by start time and the names of the devices by pid.
+    """
+    devices = {}
+    open_events = collections.defaultdict(list)
+    ops = []
+    for ev in events:
+        if ev.get('ph') == 'M' and ev.get('name') == 'process_name':
+            devices[ev['pid']] = ev['args']['name']
+        elif ev.get('cat') == 'operator' and ev.get('ph') in ('B', 'E'):
+            key = (ev['pid'], ev['tid'], ev['name'])
+            if ev['ph'] == 'B':
+                open_events[key].append(ev)
+            elif open_events[key]:
+                begin = open_events[key].pop()
+                args = begin.get('args', {})
+                ops.append((begin['ts'], ev['ts'], begin['name'], begin['pid'], begin['tid'],
+                            args.get('reads', []), args.get('writes', [])))
+    ops.sort(key=lambda op: (op[0], op[1]))
+    return [Op(i, name, devices.get(pid, str(pid)), tid, start, end,
+               [tuple(v) for v in reads], [tuple(v) for v in writes])
+            for i, (start, end, name, pid, tid, reads, writes) in enumerate(ops)], devices
+
+
+def dependencies(ops):
+    """The operators each operator had to wait for, through the engine variables.
+
+    A read of version k of a variable waits for the write that produced it, a write of version
+    k for the write of version k - 1 and for the reads of version k - 1.
+    """
+    writer = {}
+    readers = collections.defaultdict(list)
+    for op in ops:
+        for var in op.writes:
+            writer[var] = op.index
+        for var in op.reads:
+            readers[var].append(op.index)
+    deps = [set() for _ in ops]
+    for op in ops:
+        for var in op.reads:
+            if var in writer:
+                deps[op.index].add(writer[var])
+        for var_id, version in op.writes:
+            previous = (var_id, version - 1)
+            if previous in writer:
+                deps[op.index].add(writer[previous])
+            deps[op.index].update(readers.get(previous, []))
+        deps[op.index].discard(op.index)
+    return deps
+
+
+def previous_on_thread(ops):
+    """The operator each operator followed on its worker thread, None for the first one."""
+    last = {}
+    previous = [None] * len(ops)
+    for op in sorted(ops, key=lambda op: op.end):
+        key = (op.device, op.thread)
+        if key in last:
+            previous[op.index] = last[key]
+        last[key] = op.index
+    return previous
+
+
+def _binding(op, ops, deps, previous):
+    """The operator whose end allowed op to start and whether it is a data dependency."""
+    best, best_end, is_data = None, None, False
+    for d in deps[op.index]:
+        if ops[d].end <= op.start and (best_end is None or ops[d].end > best_end):
+            best, best_end, is_data = d, ops[d].end, True
+    p = previous[op.index]
+    if p is not None and ops[p].end <= op.start and (best_end is None or ops[p].end > best_end):
+        best, is_data = p, False
+    return best, is_data
+
+
+def critical_path(ops, deps, previous):
+    """The chain of operators that determines the end of the trace, first operator first."""
+    if not ops:
+        return []
+    current = max(ops, key=lambda op: op.end).index
+    path = [(current, None)]
+    while True:
+        binding, is_data = _binding(ops[current], ops, deps, previous)
+        if binding is None:
+            break
+        path[-1] = (current, 'data' if is_data else 'thread')
+        path.append((binding, None))
+        current = binding
+    path.reverse()
+    return path
+
+
+def busy_intervals(ops):
+    """Merged busy intervals of each device."""
+    by_device = collections.defaultdict(list)
+    for op in ops:
+        by_device[op.device].append((op.start, op.end))
+    merged = {}
+    for device, intervals in by_device.items():
+        intervals.sort()
+        out = [list(intervals[0])]
+        for start, end in intervals[1:]:
+            if start <= out[-1][1]:
+                out[-1][1] = max(out[-1][1], end)
+            else:
+                out.append([start, end])
+        merged[device] = out
+    return merged
+
+
+def classify(op):
+    """What kind of work an operator is, to name the cause of an idle gap."""
+    name = op.name.lower()
+    if 'kvstore' in name:
+        return 'kvstore'
+    if 'copy' in name:
+        return 'copy'
+    return 'compute'
+
+
+def idle_gaps(ops, deps, busy):
+    """The idle gaps of each device with the operator that ended them and what it waited for."""
+    starts = collections.defaultdict(list)
+    for op in ops:
+        starts[op.device].append((op.start, op.index))
+    for device_starts in starts.values():
+        device_starts.sort()
+    gaps = []
+    for device, intervals in busy.items():
+        for (_, gap_start), (gap_end, _) in zip(intervals, intervals[1:]):
+            device_starts = starts[device]
+            i = bisect.bisect_left(device_starts, (gap_end, -1))
+            op = ops[device_starts[i][1]]
+            waited = [ops[d] for d in deps[op.index] if gap_start < ops[d].end <= op.start]
+            if waited:
+                last = max(waited, key=lambda d: d.end)
+                kind = classify(last)
+                cause = '%s %s on %s' % (kind, last.name, last.device)
+            else:
+                last, cause = None, 'host'
+            gaps.append({'device': device, 'start': gap_start, 'duration': gap_end - gap_start,
+                         'next_op': op.name, 'cause': cause,
+                         'cause_kind': classify(last) if last else 'host'})
+    gaps.sort(key=lambda gap: -gap['duration'])
+    return gaps
+
+
+def analyze(events):
+    """Critical path, idle gaps and speedup bound of the operators of a trace."""
+    ops, _ = parse_ops(events)
+    if not ops:
+        return {'num_ops': 0, 'span': 0, 'critical_path': [], 'critical_path_busy': 0,
+                'device_busy': {}, 'idle_gaps': [], 'idle_by_cause': {},
+                'has_dependencies': False, 'potential_speedup': 1.0}
+    deps = dependencies(ops)
+    previous = previous_on_thread(ops)
+    path = critical_path(ops, deps, previous)
+    busy = busy_intervals(ops)
+    gaps = idle_gaps(ops, deps, busy)
+    span = max(op.end for op in ops) - min(op.start for op in ops)
+    path_busy = sum(ops[i].end - ops[i].start for i, _ in path)
+    device_busy = {device: sum(end - start for start, end in intervals)
+                   for device, intervals in busy.items()}
+    bound = max([path_busy] + list(device_busy.values()))
+    idle_by_cause = collections.Counter()
+    for gap in gaps:
+        idle_by_cause[(gap['device'], gap['cause_kind'])] += gap['duration']
+    return {
+        'num_ops': len(ops),
+        'span': span,
+        'critical_path': [{'name': ops[i].name, 'device': ops[i].device,
+                           'start': ops[i].start, 'duration': ops[i].end - ops[i].start,
+                           'after': edge} for i, edge in path],
+        'critical_path_busy': path_busy,
+        'device_busy': device_busy,
+        'idle_gaps': gaps,
+        'idle_by_cause': {'%s/%s' % key: value for key, value in idle_by_cause.items()},
+        'has_dependencies': any(op.reads or op.writes for op in ops),
+        'potential_speedup': span / bound if bound > 0 else 1.0,
+    }
+
+
+def print_report(result, top):
+    """Print the analysis in a human readable form, times in ms."""
+    ms = lambda us: us / 1000.0
+    if not result['has_dependencies']:
+        print('warning: the trace has no dependencies, record it with '
+              'profile_dependencies=True; only the worker thread order is used')
+    print('%d operators over %.3f ms' % (result['num_ops'], ms(result['span'])))
+    print('\ncritical path: %d operators, %.3f ms busy'
+          % (len(result['critical_path']), ms(result['critical_path_busy'])))
+    for step in result['critical_path'][-top:]:
+        print('  %10.3f ms  %-40s %-12s %s' % (ms(step['duration']), step['name'],
+                                               step['device'], step['after'] or ''))
+    print('\nbusy and idle time per device:')
+    for device, busy in sorted(result['device_busy'].items()):
+        print('  %-12s busy %10.3f ms' % (device, ms(busy)))
+    for key, idle in sorted(result['idle_by_cause'].items(), key=lambda item: -item[1]):
+        print('  %-24s idle %10.3f ms' % (key, ms(idle)))
+    print('\nlongest idle gaps:')
+    for gap in result['idle_gaps'][:top]:
+        print('  %10.3f ms  %-12s before %-30s waiting on %s'
+              % (ms(gap['duration']), gap['device'], gap['next_op'], gap['cause']))
+    print('\npotential speedup from overlapping: %.2fx' % result['potential_speedup'])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('profile', help='profile json written by mx.profiler.dump()')
+    parser.add_argument('--top', type=int, default=10,
+                        help='number of critical path steps and idle gaps to print')
+    parser.add_argument('--json', action='store_true', help='print the analysis as json')
+    args = parser.parse_args()
+    result = analyze(load_trace(args.profile))
+    if args.json:
+        print(json.dumps(result, indent=2))
+    else:
+        print_report(result, args.top)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Produce the operator tuning cache of this host, for example when building a fleet image.
+
+MXNet times its tuned CPU kernels when the library is loaded, to decide when to
+parallelize them with OMP. With ``MXNET_OPERATOR_TUNING_CACHE_DIR`` set, the results are
+saved to a file of that directory, one per host key (CPU model and number of tuning
+cores), and later process starts load them instead of timing again. This tool measures
+everything again and writes the files::
+
+    python tools/tune_operators.py --cache-dir /opt/mxnet/tuning --cores 4,8,16
+
+then run the workers with ``MXNET_OPERATOR_TUNING_CACHE_DIR=/opt/mxnet/tuning`` and the
+matching ``MXNET_USE_NUM_CORES_OPERATOR_TUNING``.
+"""
+import argparse
+import glob
+import os
+import subprocess
+import sys
+
+
+def tune(cache_dir, cores=None, verbose=False):
+    """Tune in a fresh process, the tuning runs while the library is loaded."""
+    env = dict(os.environ)
+    env['MXNET_OPERATOR_TUNING_CACHE_DIR'] = cache_dir
+    env['MXNET_OPERATOR_TUNING_CACHE_REFRESH'] = '1'
+    if cores is not None:
+        env['MXNET_USE_NUM_CORES_OPERATOR_TUNING'] = str(cores)
+    if verbose:
+        env['MXNET_VERBOSE_TUNING_INFO'] = '1'
+    subprocess.check_call([sys.executable, '-c', 'import mxnet'], env=env)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Produce the MXNet operator tuning cache')
+    parser.add_argument('--cache-dir', type=str, required=True,
+                        help='Directory of the cache files, MXNET_OPERATOR_TUNING_CACHE_DIR '
+                             'of the workers')
+    parser.add_argument('--cores', type=str, default='',
+                        help='Comma separated MXNET_USE_NUM_CORES_OPERATOR_TUNING values to tune '
+                             'for. By default, the default number of cores of this host')
+    parser.add_argument('--verbose', action='store_true', help='Log the tuning details')
+    args = parser.parse_args()
+
+    os.makedirs(args.cache_dir, exist_ok=True)
+    cores = [int(c) for c in args.cores.split(',') if c] or [None]
+    for c in cores:
+        tune(args.cache_dir, c, args.verbose)
+    for path in sorted(glob.glob(os.path.join(args.cache_dir, 'operator_tuning_*.txt'))):
+        with open(path) as f:
+            f.readline()
+            print(f'{path}: {f.readline().strip()}')
+
+
+if __name__ == '__main__':
+    main()